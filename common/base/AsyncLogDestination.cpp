@@ -0,0 +1,267 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * AsyncLogDestination.cpp
+ * A LogDestination that writes from a background thread.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * The queue is a bounded multi-producer, single-consumer version of the
+ * queue used by the DmxFramePool. Each slot holds a copy of the line, so
+ * queueing a line doesn't allocate.
+ */
+
+#include <signal.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#include "ola/AsyncLogDestination.h"
+#include "ola/ExportMap.h"
+
+namespace ola {
+
+using ola::thread::MutexLocker;
+using std::string;
+
+namespace {
+size_t RoundUpToPowerOfTwo(unsigned int value) {
+  size_t size = 2;
+  while (size < value) {
+    size <<= 1;
+  }
+  return size;
+}
+}  // namespace
+
+
+void *AsyncLogDestination::WriterThread::Run() {
+#ifndef _WIN32
+  // Leave signals to the other threads.
+  sigset_t signals;
+  sigfillset(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+#endif  // _WIN32
+  m_parent->WriterLoop();
+  return NULL;
+}
+
+
+AsyncLogDestination::AsyncLogDestination(LogDestination *destination,
+                                         unsigned int queue_size)
+    : m_destination(destination),
+      m_slots(NULL),
+      m_mask(RoundUpToPowerOfTwo(queue_size) - 1),
+      m_enqueue_pos(0),
+      m_dequeue_pos(0),
+      m_written(0),
+      m_dropped(0),
+      m_drop_counter(NULL),
+      m_writer_waiting(0),
+      m_running(false),
+      m_stop(false),
+      m_writer(this) {
+  m_slots = new Slot[m_mask + 1];
+  for (size_t i = 0; i <= m_mask; i++) {
+    m_slots[i].sequence = i;
+  }
+}
+
+
+AsyncLogDestination::~AsyncLogDestination() {
+  if (m_running) {
+    {
+      MutexLocker locker(&m_mutex);
+      m_stop = true;
+      m_work_available.Signal();
+    }
+    m_writer.Join();
+    m_running = false;
+  }
+
+  // Write anything that was queued after the writer checked for the last
+  // time.
+  while (WriteNext()) {}
+  delete[] m_slots;
+}
+
+
+bool AsyncLogDestination::Init() {
+  if (m_running) {
+    return true;
+  }
+  // Don't use OLA_WARN here, this may be the log destination.
+  if (!m_writer.Start()) {
+    return false;
+  }
+  __atomic_store_n(&m_running, true, __ATOMIC_RELEASE);
+  return true;
+}
+
+
+void AsyncLogDestination::Write(log_level level, const string &log_line) {
+  if (!__atomic_load_n(&m_running, __ATOMIC_ACQUIRE)) {
+    m_destination->Write(level, log_line);
+    return;
+  }
+
+  if (level == OLA_LOG_FATAL) {
+    Flush();
+    m_destination->Write(level, log_line);
+    return;
+  }
+
+  if (!Push(level, log_line)) {
+    __atomic_add_fetch(&m_dropped, 1, __ATOMIC_RELAXED);
+    ShardedCounter *counter = __atomic_load_n(&m_drop_counter,
+                                              __ATOMIC_ACQUIRE);
+    if (counter) {
+      counter->Increment();
+    }
+    return;
+  }
+  WakeWriter();
+}
+
+
+void AsyncLogDestination::Flush() {
+  if (!__atomic_load_n(&m_running, __ATOMIC_ACQUIRE)) {
+    return;
+  }
+
+  // Lines that have been claimed but not yet published are still waited for,
+  // since the writer is woken again once they're published.
+  const size_t target = __atomic_load_n(&m_enqueue_pos, __ATOMIC_ACQUIRE);
+  MutexLocker locker(&m_mutex);
+  while (__atomic_load_n(&m_written, __ATOMIC_ACQUIRE) < target) {
+    __atomic_store_n(&m_writer_waiting, 0, __ATOMIC_SEQ_CST);
+    m_work_available.Signal();
+    m_drained.Wait(&m_mutex);
+  }
+}
+
+
+uint64_t AsyncLogDestination::Dropped() const {
+  return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+}
+
+
+void AsyncLogDestination::SetDropCounter(ShardedCounter *counter) {
+  if (counter) {
+    counter->Add(Dropped());
+  }
+  __atomic_store_n(&m_drop_counter, counter, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Copy a line into the next free slot.
+ * @returns false if the queue is full.
+ */
+bool AsyncLogDestination::Push(log_level level, const string &log_line) {
+  Slot *slot;
+  size_t pos = __atomic_load_n(&m_enqueue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    slot = &m_slots[pos & m_mask];
+    size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) -
+                     static_cast<ptrdiff_t>(pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&m_enqueue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = __atomic_load_n(&m_enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+
+  const size_t length = std::min(log_line.size(),
+                                 static_cast<size_t>(MAX_LINE_LENGTH));
+  memcpy(slot->line, log_line.data(), length);
+  if (length < log_line.size()) {
+    slot->line[length - 1] = '\n';
+  }
+  slot->length = static_cast<unsigned int>(length);
+  slot->level = level;
+  __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+
+/*
+ * Write the oldest line, this must only be called by one thread at a time.
+ * @returns false if the queue was empty.
+ */
+bool AsyncLogDestination::WriteNext() {
+  Slot *slot = &m_slots[m_dequeue_pos & m_mask];
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) !=
+      m_dequeue_pos + 1) {
+    return false;
+  }
+
+  // Copy the line out, so the slot can be reused while we're writing.
+  const string line(slot->line, slot->length);
+  const log_level level = slot->level;
+  __atomic_store_n(&slot->sequence, m_dequeue_pos + m_mask + 1,
+                   __ATOMIC_RELEASE);
+  m_dequeue_pos++;
+
+  m_destination->Write(level, line);
+  __atomic_add_fetch(&m_written, 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+
+void AsyncLogDestination::WriterLoop() {
+  while (true) {
+    while (WriteNext()) {}
+
+    MutexLocker locker(&m_mutex);
+    m_drained.Broadcast();
+    // We set m_writer_waiting before checking the queue, and a producer
+    // publishes a line before checking m_writer_waiting, so either we see
+    // the line, or the producer sees we're waiting and signals us.
+    __atomic_store_n(&m_writer_waiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const Slot *slot = &m_slots[m_dequeue_pos & m_mask];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) ==
+        m_dequeue_pos + 1) {
+      __atomic_store_n(&m_writer_waiting, 0, __ATOMIC_SEQ_CST);
+      continue;
+    }
+    if (m_stop) {
+      return;
+    }
+    m_work_available.Wait(&m_mutex);
+    __atomic_store_n(&m_writer_waiting, 0, __ATOMIC_SEQ_CST);
+  }
+}
+
+
+/*
+ * Wake the writer if it's waiting. Once one producer has done this, the rest
+ * don't need to until the writer waits again.
+ */
+void AsyncLogDestination::WakeWriter() {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&m_writer_waiting, __ATOMIC_RELAXED) &&
+      __atomic_exchange_n(&m_writer_waiting, 0, __ATOMIC_SEQ_CST)) {
+    MutexLocker locker(&m_mutex);
+    m_work_available.Signal();
+  }
+}
+}  // namespace ola
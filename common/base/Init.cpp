@@ -46,6 +46,7 @@
 #define VC_EXTRALEAN
 #include <ola/win/CleanWinSock2.h>
 #else
+#include <sys/mman.h>
 #include <sys/resource.h>
 #endif  // _WIN32
 #include <unistd.h>
@@ -63,6 +64,7 @@
 
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <string>
 
 // Scheduling options.
@@ -70,6 +72,11 @@ DEFINE_string(scheduler_policy, "",
               "The thread scheduling policy, one of {fifo, rr}.");
 DEFINE_uint16(scheduler_priority, 0,
               "The thread priority, only used if --scheduler-policy is set.");
+DEFINE_string(thread_placement, "",
+              "The CPUs and scheduling of threads by name, e.g. "
+              "'http=3;main=0-1:fifo:10'. See the man page for the format.");
+DEFINE_default_bool(lock_memory, false,
+                    "Lock the process's memory so it can't be paged out.");
 
 namespace {
 
@@ -174,6 +181,46 @@ bool SetThreadScheduling() {
 #endif  // HAVE_DECL_RLIMIT_RTTIME
   return true;
 }
+
+/*
+ * Set the placements from --thread-placement & apply the one for the main
+ * thread.
+ */
+bool SetThreadPlacement() {
+  std::map<string, ola::thread::Thread::Placement> placements;
+  if (!ola::thread::StringToThreadPlacements(FLAGS_thread_placement.str(),
+                                             &placements)) {
+    OLA_FATAL << "Invalid --thread-placement " << FLAGS_thread_placement;
+    return false;
+  }
+
+  std::map<string, ola::thread::Thread::Placement>::const_iterator iter =
+      placements.begin();
+  for (; iter != placements.end(); ++iter) {
+    ola::thread::Thread::SetPlacement(iter->first, iter->second);
+  }
+  return ola::thread::Thread::PlaceCurrentThread("main");
+}
+
+/*
+ * Lock our memory if --lock-memory was given.
+ */
+bool LockMemory() {
+  if (!FLAGS_lock_memory) {
+    return true;
+  }
+#ifdef _WIN32
+  OLA_WARN << "--lock-memory isn't supported on this platform";
+  return false;
+#else
+  if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+    OLA_FATAL << "mlockall failed: " << strerror(errno);
+    return false;
+  }
+  OLA_INFO << "Locked memory";
+  return true;
+#endif  // _WIN32
+}
 }  // namespace
 
 namespace ola {
@@ -196,8 +243,11 @@ bool ServerInit(int argc, char *argv[], ExportMap *export_map) {
 
   if (export_map) {
     InitExportMap(argc, argv, export_map);
+    ExportLoggingVariables(export_map);
   }
-  return SetThreadScheduling() && NetworkInit();
+  StartAsyncLogging();
+  return SetThreadScheduling() && SetThreadPlacement() && LockMemory() &&
+      NetworkInit();
 }
 
 bool ServerInit(int *argc,
@@ -230,7 +280,9 @@ bool AppInit(int *argc,
   if (!InstallSEGVHandler()) {
     return false;
   }
-  return SetThreadScheduling() && NetworkInit();
+  StartAsyncLogging();
+  return SetThreadScheduling() && SetThreadPlacement() && LockMemory() &&
+      NetworkInit();
 }
 
 #ifdef _WIN32
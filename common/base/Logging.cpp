@@ -42,6 +42,8 @@
 
 #include <iostream>
 #include <string>
+#include "ola/AsyncLogDestination.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
 
@@ -49,6 +51,9 @@
 DEFINE_s_int8(log_level, l, ola::OLA_LOG_WARN, "Set the logging level 0 .. 4.");
 /**@private*/
 DEFINE_default_bool(syslog, false, "Send to syslog rather than stderr.");
+/**@private*/
+DEFINE_default_bool(async_logging, false,
+                    "Write log messages from a background thread.");
 
 namespace ola {
 
@@ -61,6 +66,11 @@ using std::string;
  */
 LogDestination *log_target = NULL;
 
+/**
+ * @brief log_target if it's an AsyncLogDestination, otherwise NULL.
+ */
+AsyncLogDestination *async_log_target = NULL;
+
 log_level logging_level = OLA_LOG_WARN;
 /**@endcond*/
 
@@ -111,7 +121,34 @@ bool InitLoggingFromFlags() {
       break;
   }
 
-  return InitLogging(log_level, output);
+  if (!InitLogging(log_level, output)) {
+    return false;
+  }
+
+  if (FLAGS_async_logging && log_target) {
+    // The thread is started by StartAsyncLogging(), until then the lines are
+    // written synchronously.
+    AsyncLogDestination *destination = new AsyncLogDestination(log_target);
+    log_target = NULL;
+    InitLogging(log_level, destination);
+  }
+  return true;
+}
+
+
+void StartAsyncLogging() {
+  if (async_log_target && !async_log_target->Init()) {
+    // This still works, the lines are just written synchronously.
+    OLA_WARN << "Failed to start the logging thread";
+  }
+}
+
+
+void ExportLoggingVariables(ExportMap *export_map) {
+  if (async_log_target) {
+    async_log_target->SetDropCounter(
+        export_map->GetShardedCounterVar("log-lines-dropped"));
+  }
 }
 
 
@@ -140,10 +177,11 @@ bool InitLogging(log_level level, log_output output) {
 
 void InitLogging(log_level level, LogDestination *destination) {
   SetLogLevel(level);
-  if (log_target) {
-    delete log_target;
-  }
+  LogDestination *old_target = log_target;
   log_target = destination;
+  async_log_target = dynamic_cast<AsyncLogDestination*>(destination);
+  // If this is an AsyncLogDestination, deleting it writes the queued lines.
+  delete old_target;
 }
 
 /**@}*/
@@ -154,7 +192,7 @@ LogLine::LogLine(const char *file,
   m_level(level),
   m_stream(ostringstream::out) {
     m_stream << file << ":" << line << ": ";
-    m_prefix_length = m_stream.str().length();
+    m_prefix_length = static_cast<unsigned int>(m_stream.tellp());
 }
 
 LogLine::~LogLine() {
@@ -162,7 +200,7 @@ LogLine::~LogLine() {
 }
 
 void LogLine::Write() {
-  if (m_stream.str().length() == m_prefix_length)
+  if (static_cast<unsigned int>(m_stream.tellp()) == m_prefix_length)
     return;
 
   if (m_level > logging_level)
@@ -20,18 +20,23 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <deque>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "ola/AsyncLogDestination.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Mutex.h"
 
 
 using std::deque;
 using std::vector;
 using std::string;
+using ola::AsyncLogDestination;
 using ola::IncrementLogLevel;
 using ola::log_level;
 
@@ -39,10 +44,14 @@ using ola::log_level;
 class LoggingTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(LoggingTest);
   CPPUNIT_TEST(testLogging);
+  CPPUNIT_TEST(testAsyncLogging);
+  CPPUNIT_TEST(testAsyncLoggingOverflow);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testLogging();
+    void testAsyncLogging();
+    void testAsyncLoggingOverflow();
 };
 
 
@@ -56,6 +65,34 @@ class MockLogDestination: public ola::LogDestination {
 };
 
 
+/*
+ * Records the lines, and can be blocked to fill up the queue of an
+ * AsyncLogDestination.
+ */
+class RecordingLogDestination: public ola::LogDestination {
+ public:
+    explicit RecordingLogDestination(ola::thread::Mutex *block)
+        : m_block(block) {
+    }
+
+    void Write(log_level level, const string &log_line) {
+      ola::thread::MutexLocker block_locker(m_block);
+      ola::thread::MutexLocker locker(&m_mutex);
+      m_log_lines.push_back(std::pair<log_level, string>(level, log_line));
+    }
+
+    vector<std::pair<log_level, string> > Lines() {
+      ola::thread::MutexLocker locker(&m_mutex);
+      return m_log_lines;
+    }
+
+ private:
+    ola::thread::Mutex *m_block;
+    ola::thread::Mutex m_mutex;
+    vector<std::pair<log_level, string> > m_log_lines;
+};
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(LoggingTest);
 
 
@@ -124,3 +161,84 @@ void LoggingTest::testLogging() {
   OLA_FATAL << "fatal";
   OLA_ASSERT_EQ(destination->LinesRemaining(), 0);
 }
+
+
+/*
+ * Check the AsyncLogDestination writes lines in order.
+ */
+void LoggingTest::testAsyncLogging() {
+  ola::thread::Mutex block;
+  RecordingLogDestination *recorder = new RecordingLogDestination(&block);
+  AsyncLogDestination destination(recorder, 16);
+
+  // Before Init(), lines are written synchronously.
+  destination.Write(ola::OLA_LOG_INFO, "first\n");
+  OLA_ASSERT_EQ((size_t) 1, recorder->Lines().size());
+
+  OLA_ASSERT_TRUE(destination.Init());
+  OLA_ASSERT_TRUE(destination.Init());
+  for (unsigned int i = 0; i < 100; i++) {
+    std::ostringstream str;
+    str << i << "\n";
+    destination.Write(ola::OLA_LOG_WARN, str.str());
+    if (i % 10 == 0) {
+      destination.Flush();
+    }
+  }
+  destination.Write(ola::OLA_LOG_DEBUG, string(1000, 'x'));
+  destination.Flush();
+
+  vector<std::pair<log_level, string> > lines = recorder->Lines();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), destination.Dropped());
+  OLA_ASSERT_EQ((size_t) 102, lines.size());
+  OLA_ASSERT_EQ(string("first\n"), lines[0].second);
+  for (unsigned int i = 0; i < 100; i++) {
+    std::ostringstream str;
+    str << i << "\n";
+    OLA_ASSERT_EQ(ola::OLA_LOG_WARN, lines[i + 1].first);
+    OLA_ASSERT_EQ(str.str(), lines[i + 1].second);
+  }
+
+  // Long lines are truncated.
+  const string &truncated = lines[101].second;
+  OLA_ASSERT_EQ(ola::OLA_LOG_DEBUG, lines[101].first);
+  OLA_ASSERT_EQ(static_cast<size_t>(AsyncLogDestination::MAX_LINE_LENGTH),
+                truncated.size());
+  OLA_ASSERT_EQ('\n', truncated[truncated.size() - 1]);
+}
+
+
+/*
+ * Check lines are dropped rather than blocking when the queue is full.
+ */
+void LoggingTest::testAsyncLoggingOverflow() {
+  ola::thread::Mutex block;
+  RecordingLogDestination *recorder = new RecordingLogDestination(&block);
+  AsyncLogDestination destination(recorder, 4);
+  OLA_ASSERT_TRUE(destination.Init());
+
+  ola::ShardedCounter counter("log-lines-dropped");
+  {
+    // The writer can take at most one line before it blocks, leaving room
+    // for 4 more.
+    ola::thread::MutexLocker locker(&block);
+    for (unsigned int i = 0; i < 10; i++) {
+      destination.Write(ola::OLA_LOG_INFO, "line\n");
+      if (i == 6) {
+        destination.SetDropCounter(&counter);
+      }
+    }
+    OLA_ASSERT_TRUE(destination.Dropped() >= 5);
+    OLA_ASSERT_EQ(destination.Dropped(), counter.Get());
+  }
+
+  destination.Flush();
+  OLA_ASSERT_EQ(static_cast<size_t>(10 - destination.Dropped()),
+                recorder->Lines().size());
+
+  // Once the queue has drained, lines are accepted again.
+  destination.Write(ola::OLA_LOG_INFO, "line\n");
+  destination.Flush();
+  OLA_ASSERT_EQ(static_cast<size_t>(11 - destination.Dropped()),
+                recorder->Lines().size());
+}
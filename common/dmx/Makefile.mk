@@ -1,11 +1,65 @@
 # LIBRARIES
 ##################################################
-common_libolacommon_la_SOURCES += common/dmx/RunLengthEncoder.cpp
+common_libolacommon_la_SOURCES += \
+    common/dmx/PixelProcessor.cpp \
+    common/dmx/ReceiveStats.cpp \
+    common/dmx/RunLengthEncoder.cpp \
+    common/dmx/SharedDmxRegion.cpp \
+    common/dmx/SharedDmxRegion.h \
+    common/dmx/SlotKernels.cpp \
+    common/dmx/SlotKernels.h \
+    common/dmx/StreamFrame.cpp \
+    common/dmx/StreamFrame.h \
+    common/dmx/TrackedDmxBuffer.cpp
+
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/dmx/run_length_benchmark \
+                   common/dmx/slot_kernels_benchmark
+
+common_dmx_run_length_benchmark_SOURCES = \
+    common/dmx/run_length_benchmark.cpp
+common_dmx_run_length_benchmark_LDADD = common/libolacommon.la
+
+common_dmx_slot_kernels_benchmark_SOURCES = \
+    common/dmx/slot_kernels_benchmark.cpp
+common_dmx_slot_kernels_benchmark_LDADD = common/libolacommon.la
 
 # TESTS
 ##################################################
-test_programs += common/dmx/RunLengthEncoderTester
+test_programs += common/dmx/PixelProcessorTester \
+                 common/dmx/ReceiveStatsTester \
+                 common/dmx/RunLengthEncoderTester \
+                 common/dmx/SharedDmxRegionTester \
+                 common/dmx/SlotKernelsTester \
+                 common/dmx/StreamFrameTester \
+                 common/dmx/TrackedDmxBufferTester
+
+common_dmx_PixelProcessorTester_SOURCES = common/dmx/PixelProcessorTest.cpp
+common_dmx_PixelProcessorTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_PixelProcessorTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_ReceiveStatsTester_SOURCES = common/dmx/ReceiveStatsTest.cpp
+common_dmx_ReceiveStatsTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_ReceiveStatsTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_dmx_RunLengthEncoderTester_SOURCES = common/dmx/RunLengthEncoderTest.cpp
 common_dmx_RunLengthEncoderTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_dmx_RunLengthEncoderTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_SharedDmxRegionTester_SOURCES = common/dmx/SharedDmxRegionTest.cpp
+common_dmx_SharedDmxRegionTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_SharedDmxRegionTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_SlotKernelsTester_SOURCES = common/dmx/SlotKernelsTest.cpp
+common_dmx_SlotKernelsTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_SlotKernelsTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_StreamFrameTester_SOURCES = common/dmx/StreamFrameTest.cpp
+common_dmx_StreamFrameTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_StreamFrameTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_TrackedDmxBufferTester_SOURCES = \
+    common/dmx/TrackedDmxBufferTest.cpp
+common_dmx_TrackedDmxBufferTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_TrackedDmxBufferTester_LDADD = $(COMMON_TESTING_LIBS)
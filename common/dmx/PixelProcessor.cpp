@@ -0,0 +1,212 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PixelProcessor.cpp
+ * Gamma, white balance, color order & dithering for RGB pixel outputs.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ola/StringUtils.h>
+#include <ola/dmx/PixelProcessor.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// The largest value in the dither tables. This leaves room to add the
+// carried error without overflowing.
+const unsigned int MAX_DITHER_VALUE = 0xff00;
+const double MAX_GAMMA = 5.0;
+const char COLOR_NAMES[] = "RGB";
+
+bool StringToDouble(const string &input, double *output) {
+  if (input.empty()) {
+    return false;
+  }
+  char *end;
+  double value = strtod(input.c_str(), &end);
+  if (*end || isnan(value) || isinf(value)) {
+    return false;
+  }
+  *output = value;
+  return true;
+}
+
+vector<string> BuildOptionNames() {
+  vector<string> names;
+  names.push_back("gamma");
+  names.push_back("white-balance");
+  names.push_back("color-order");
+  names.push_back("dither");
+  return names;
+}
+}  // namespace
+
+const unsigned int PixelProcessor::SLOTS_PER_PIXEL;
+
+PixelProcessor::PixelProcessor(const Options &options)
+    : m_options(options),
+      m_identity(IsIdentity(options)) {
+  for (unsigned int slot = 0; slot < SLOTS_PER_PIXEL; slot++) {
+    const unsigned int color = m_options.color_order[slot];
+    for (unsigned int value = 0; value < LUT_SIZE; value++) {
+      double level = (Transfer(color, value / 255.0) / 65535.0);
+      unsigned int scaled = static_cast<unsigned int>(
+          level * MAX_DITHER_VALUE + 0.5);
+      scaled = std::min(scaled, MAX_DITHER_VALUE);
+      m_dither_lut[slot][value] = scaled;
+      m_lut[slot][value] = (scaled + 0x80) >> 8;
+    }
+  }
+}
+
+void PixelProcessor::Process(const uint8_t *input, unsigned int pixels,
+                             uint8_t *output) {
+  const uint8_t order0 = m_options.color_order[0];
+  const uint8_t order1 = m_options.color_order[1];
+  const uint8_t order2 = m_options.color_order[2];
+
+  if (!m_options.dither) {
+    for (unsigned int i = 0; i < pixels; i++) {
+      const uint8_t *in = input + SLOTS_PER_PIXEL * i;
+      uint8_t *out = output + SLOTS_PER_PIXEL * i;
+      // Read all the colors first, since input & output may be the same.
+      uint8_t first = in[order0];
+      uint8_t second = in[order1];
+      uint8_t third = in[order2];
+      out[0] = m_lut[0][first];
+      out[1] = m_lut[1][second];
+      out[2] = m_lut[2][third];
+    }
+    return;
+  }
+
+  if (m_residuals.size() < SLOTS_PER_PIXEL * pixels) {
+    m_residuals.resize(SLOTS_PER_PIXEL * pixels, 0);
+  }
+  uint8_t *residuals = &m_residuals[0];
+  for (unsigned int i = 0; i < pixels; i++) {
+    const uint8_t *in = input + SLOTS_PER_PIXEL * i;
+    uint8_t *out = output + SLOTS_PER_PIXEL * i;
+    uint8_t *residual = residuals + SLOTS_PER_PIXEL * i;
+    unsigned int first = m_dither_lut[0][in[order0]] + residual[0];
+    unsigned int second = m_dither_lut[1][in[order1]] + residual[1];
+    unsigned int third = m_dither_lut[2][in[order2]] + residual[2];
+    out[0] = first >> 8;
+    out[1] = second >> 8;
+    out[2] = third >> 8;
+    residual[0] = first & 0xff;
+    residual[1] = second & 0xff;
+    residual[2] = third & 0xff;
+  }
+}
+
+void PixelProcessor::ResetDither() {
+  std::fill(m_residuals.begin(), m_residuals.end(), 0);
+}
+
+uint16_t PixelProcessor::Transfer(unsigned int color, double level) const {
+  if (color >= SLOTS_PER_PIXEL) {
+    return 0;
+  }
+  level = std::max(0.0, std::min(1.0, level));
+  double output = pow(level, m_options.gamma) *
+      m_options.white_balance[color] * 0xffff;
+  return static_cast<uint16_t>(std::min(output + 0.5, 65535.0));
+}
+
+const vector<string> &PixelProcessor::OptionNames() {
+  static const vector<string> names = BuildOptionNames();
+  return names;
+}
+
+bool PixelProcessor::SetOption(const string &name,
+                               const string &value,
+                               Options *options) {
+  if (value.empty()) {
+    return true;
+  }
+
+  if (name == "gamma") {
+    double gamma;
+    if (!StringToDouble(value, &gamma) || gamma <= 0.0 ||
+        gamma > MAX_GAMMA) {
+      return false;
+    }
+    options->gamma = gamma;
+  } else if (name == "white-balance") {
+    vector<string> tokens;
+    StringSplit(value, &tokens, ",");
+    if (tokens.size() != SLOTS_PER_PIXEL) {
+      return false;
+    }
+    double scale[SLOTS_PER_PIXEL];
+    for (unsigned int i = 0; i < SLOTS_PER_PIXEL; i++) {
+      if (!StringToDouble(tokens[i], &scale[i]) || scale[i] < 0.0 ||
+          scale[i] > 1.0) {
+        return false;
+      }
+    }
+    std::copy(scale, scale + SLOTS_PER_PIXEL, options->white_balance);
+  } else if (name == "color-order") {
+    if (value.size() != SLOTS_PER_PIXEL) {
+      return false;
+    }
+    uint8_t order[SLOTS_PER_PIXEL];
+    bool seen[SLOTS_PER_PIXEL] = {false, false, false};
+    for (unsigned int i = 0; i < SLOTS_PER_PIXEL; i++) {
+      const char *color = strchr(COLOR_NAMES, toupper(value[i]));
+      if (!color || !*color) {
+        return false;
+      }
+      order[i] = color - COLOR_NAMES;
+      if (seen[order[i]]) {
+        return false;
+      }
+      seen[order[i]] = true;
+    }
+    std::copy(order, order + SLOTS_PER_PIXEL, options->color_order);
+  } else if (name == "dither") {
+    return StringToBool(value, &options->dither);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool PixelProcessor::IsIdentity(const Options &options) {
+  if (options.gamma != 1.0) {
+    return false;
+  }
+  for (unsigned int i = 0; i < SLOTS_PER_PIXEL; i++) {
+    if (options.white_balance[i] != 1.0 || options.color_order[i] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace dmx
+}  // namespace ola
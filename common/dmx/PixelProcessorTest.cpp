@@ -0,0 +1,184 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PixelProcessorTest.cpp
+ * Test fixture for the PixelProcessor class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+#include "ola/dmx/PixelProcessor.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::dmx::PixelProcessor;
+
+class PixelProcessorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PixelProcessorTest);
+  CPPUNIT_TEST(testIdentity);
+  CPPUNIT_TEST(testColorOrder);
+  CPPUNIT_TEST(testGammaAndWhiteBalance);
+  CPPUNIT_TEST(testDither);
+  CPPUNIT_TEST(testSetOption);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testIdentity();
+    void testColorOrder();
+    void testGammaAndWhiteBalance();
+    void testDither();
+    void testSetOption();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelProcessorTest);
+
+
+/*
+ * The default options shouldn't change the data, with or without dithering.
+ */
+void PixelProcessorTest::testIdentity() {
+  uint8_t input[256 * 3];
+  for (unsigned int i = 0; i < sizeof(input); i++) {
+    input[i] = i / 3;
+  }
+
+  PixelProcessor::Options options;
+  for (unsigned int dither = 0; dither < 2; dither++) {
+    options.dither = dither;
+    PixelProcessor processor(options);
+    OLA_ASSERT_TRUE(processor.IsIdentity());
+
+    for (unsigned int frame = 0; frame < 3; frame++) {
+      uint8_t output[sizeof(input)];
+      processor.Process(input, 256, output);
+      OLA_ASSERT_DATA_EQUALS(input, sizeof(input), output, sizeof(output));
+    }
+  }
+}
+
+
+void PixelProcessorTest::testColorOrder() {
+  PixelProcessor::Options options;
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("color-order", "GRB", &options));
+  PixelProcessor processor(options);
+  OLA_ASSERT_FALSE(processor.IsIdentity());
+
+  uint8_t data[] = {1, 2, 3, 4, 5, 6, 7};
+  const uint8_t expected[] = {2, 1, 3, 5, 4, 6, 7};
+  // in place, the last slot isn't part of a pixel.
+  processor.Process(data, 2, data);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), data, sizeof(data));
+
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("color-order", "bgr", &options));
+  PixelProcessor bgr_processor(options);
+  uint8_t output[3];
+  bgr_processor.Process(data, 1, output);
+  const uint8_t bgr_expected[] = {3, 1, 2};
+  OLA_ASSERT_DATA_EQUALS(bgr_expected, sizeof(bgr_expected), output,
+                         sizeof(output));
+}
+
+
+void PixelProcessorTest::testGammaAndWhiteBalance() {
+  PixelProcessor::Options options;
+  options.gamma = 2.0;
+  options.white_balance[2] = 0.5;
+  PixelProcessor processor(options);
+  OLA_ASSERT_FALSE(processor.IsIdentity());
+
+  const uint8_t input[] = {0, 0, 0, 255, 255, 255, 128, 128, 128};
+  uint8_t output[sizeof(input)];
+  processor.Process(input, 3, output);
+  // (128 / 255) ^ 2 * 255 = 64.25
+  const uint8_t expected[] = {0, 0, 0, 255, 255, 128, 64, 64, 32};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), output, sizeof(output));
+
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0xffff), processor.Transfer(0, 1.0));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8000), processor.Transfer(2, 1.0));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x4000), processor.Transfer(1, 0.5));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0), processor.Transfer(3, 1.0));
+}
+
+
+/*
+ * With dithering, the average output over a number of frames should match
+ * the fractional value.
+ */
+void PixelProcessorTest::testDither() {
+  PixelProcessor::Options options;
+  options.gamma = 2.0;
+  options.dither = true;
+  PixelProcessor processor(options);
+
+  // (20 / 255) ^ 2 * 255 = 1.57
+  const uint8_t input[] = {20, 20, 20};
+  const unsigned int frames = 256;
+  unsigned int total = 0;
+  bool saw_one = false, saw_two = false;
+  for (unsigned int i = 0; i < frames; i++) {
+    uint8_t output[3];
+    processor.Process(input, 1, output);
+    OLA_ASSERT_EQ(output[0], output[1]);
+    saw_one |= output[0] == 1;
+    saw_two |= output[0] == 2;
+    total += output[0];
+  }
+  OLA_ASSERT_TRUE(saw_one);
+  OLA_ASSERT_TRUE(saw_two);
+  // 1.57 * 256 = 401.6
+  OLA_ASSERT_TRUE(total >= 400 && total <= 403);
+
+  // Full scale is never exceeded.
+  const uint8_t full[] = {255, 255, 255};
+  for (unsigned int i = 0; i < frames; i++) {
+    uint8_t output[3];
+    processor.Process(full, 1, output);
+    OLA_ASSERT_EQ(static_cast<uint8_t>(255), output[0]);
+  }
+}
+
+
+void PixelProcessorTest::testSetOption() {
+  PixelProcessor::Options options;
+  OLA_ASSERT_EQ(static_cast<size_t>(4), PixelProcessor::OptionNames().size());
+
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("gamma", "2.2", &options));
+  OLA_ASSERT_EQ(2.2, options.gamma);
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("gamma", "0", &options));
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("gamma", "2.2x", &options));
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("gamma", "", &options));
+  OLA_ASSERT_EQ(2.2, options.gamma);
+
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("white-balance", "1,0.5,0.25",
+                                            &options));
+  OLA_ASSERT_EQ(0.5, options.white_balance[1]);
+  OLA_ASSERT_EQ(0.25, options.white_balance[2]);
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("white-balance", "1,0.5",
+                                             &options));
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("white-balance", "1,0.5,2",
+                                             &options));
+
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("color-order", "RGBW",
+                                             &options));
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("color-order", "RRB", &options));
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("color-order", "RGX", &options));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), options.color_order[2]);
+
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("dither", "true", &options));
+  OLA_ASSERT_TRUE(options.dither);
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("dither", "maybe", &options));
+  OLA_ASSERT_FALSE(PixelProcessor::SetOption("brightness", "1", &options));
+}
@@ -0,0 +1,178 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ReceiveStats.cpp
+ * Statistics for DMX data received from the network.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <string.h>
+#include "ola/dmx/ReceiveStats.h"
+
+namespace ola {
+namespace dmx {
+
+namespace {
+// There is only ever one writer, so a relaxed load / store is enough to stop
+// readers from seeing a torn value.
+inline uint32_t Load(const uint32_t *value) {
+  return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+inline void Store(uint32_t *value, uint32_t new_value) {
+  __atomic_store_n(value, new_value, __ATOMIC_RELAXED);
+}
+
+inline void Increment(uint32_t *value, uint32_t delta = 1) {
+  Store(value, *value + delta);
+}
+}  // namespace
+
+const int ReceiveStats::OUT_OF_ORDER;
+const unsigned int ReceiveStats::JITTER_BUCKETS;
+const int8_t ReceiveStats::SEQUENCE_DIFF_THRESHOLD;
+
+const unsigned int ReceiveStats::JITTER_LIMITS_MS[] = {
+  1, 2, 5, 10, 20, 50, 100
+};
+
+ReceiveStats::ReceiveStats()
+    : m_packets(0),
+      m_sequence_gaps(0),
+      m_out_of_order(0),
+      m_jitter_us(0),
+      m_last_seen_s(0),
+      m_last_seen_us(0),
+      m_last_interval(-1),
+      m_last_sequence(0),
+      m_have_sequence(false) {
+  memset(m_jitter_counts, 0, sizeof(m_jitter_counts));
+}
+
+ReceiveStats::ReceiveStats(const ReceiveStats &other)
+    : m_last_interval(-1),
+      m_last_sequence(0),
+      m_have_sequence(false) {
+  CopyCounters(other);
+}
+
+ReceiveStats& ReceiveStats::operator=(const ReceiveStats &other) {
+  if (this != &other) {
+    CopyCounters(other);
+    m_last_arrival = TimeStamp();
+    m_last_interval = -1;
+    m_have_sequence = false;
+  }
+  return *this;
+}
+
+int ReceiveStats::CheckSequence(uint8_t sequence, bool skips_zero) {
+  if (!m_have_sequence) {
+    m_have_sequence = true;
+    m_last_sequence = sequence;
+    return 0;
+  }
+
+  int diff = static_cast<int8_t>(sequence - m_last_sequence);
+  if (skips_zero && diff > 0 && sequence < m_last_sequence) {
+    diff--;
+  }
+
+  if (diff <= 0 && diff > SEQUENCE_DIFF_THRESHOLD) {
+    return OUT_OF_ORDER;
+  }
+
+  m_last_sequence = sequence;
+  return diff > 1 ? diff - 1 : 0;
+}
+
+void ReceiveStats::PacketReceived(const TimeStamp &now, int missed) {
+  Increment(&m_packets);
+  if (missed == OUT_OF_ORDER) {
+    Increment(&m_out_of_order);
+  } else if (missed > 0) {
+    Increment(&m_sequence_gaps, missed);
+  }
+
+  if (m_last_arrival.IsSet()) {
+    int64_t interval = (now - m_last_arrival).AsInt();
+    if (m_last_interval >= 0) {
+      int64_t delta = interval - m_last_interval;
+      if (delta < 0) {
+        delta = -delta;
+      }
+
+      unsigned int bucket = 0;
+      while (bucket < JITTER_BUCKETS - 1 &&
+             delta >= JITTER_LIMITS_MS[bucket] * 1000) {
+        bucket++;
+      }
+      Increment(&m_jitter_counts[bucket]);
+
+      int64_t jitter = m_jitter_us;
+      jitter += (delta - jitter) / 16;
+      Store(&m_jitter_us, static_cast<uint32_t>(jitter));
+    }
+    m_last_interval = interval;
+  }
+  m_last_arrival = now;
+  Store(&m_last_seen_s, static_cast<uint32_t>(now.Seconds()));
+  Store(&m_last_seen_us, static_cast<uint32_t>(now.MicroSeconds()));
+}
+
+uint32_t ReceiveStats::Packets() const {
+  return Load(&m_packets);
+}
+
+uint32_t ReceiveStats::SequenceGaps() const {
+  return Load(&m_sequence_gaps);
+}
+
+uint32_t ReceiveStats::OutOfOrder() const {
+  return Load(&m_out_of_order);
+}
+
+TimeStamp ReceiveStats::LastSeen() const {
+  struct timeval tv;
+  tv.tv_sec = Load(&m_last_seen_s);
+  tv.tv_usec = Load(&m_last_seen_us);
+  return TimeStamp(tv);
+}
+
+uint32_t ReceiveStats::JitterMicroSeconds() const {
+  return Load(&m_jitter_us);
+}
+
+uint32_t ReceiveStats::JitterCount(unsigned int bucket) const {
+  return bucket < JITTER_BUCKETS ? Load(&m_jitter_counts[bucket]) : 0;
+}
+
+unsigned int ReceiveStats::JitterBucketLimit(unsigned int bucket) {
+  return bucket < JITTER_BUCKETS - 1 ? JITTER_LIMITS_MS[bucket] : 0;
+}
+
+void ReceiveStats::CopyCounters(const ReceiveStats &other) {
+  m_packets = other.Packets();
+  m_sequence_gaps = other.SequenceGaps();
+  m_out_of_order = other.OutOfOrder();
+  m_jitter_us = other.JitterMicroSeconds();
+  m_last_seen_s = Load(&other.m_last_seen_s);
+  m_last_seen_us = Load(&other.m_last_seen_us);
+  for (unsigned int i = 0; i < JITTER_BUCKETS; i++) {
+    m_jitter_counts[i] = other.JitterCount(i);
+  }
+}
+}  // namespace dmx
+}  // namespace ola
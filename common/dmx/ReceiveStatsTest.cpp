@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ReceiveStatsTest.cpp
+ * Test fixture for the ReceiveStats class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Clock.h"
+#include "ola/dmx/ReceiveStats.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::ReceiveStats;
+
+class ReceiveStatsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ReceiveStatsTest);
+  CPPUNIT_TEST(testSequence);
+  CPPUNIT_TEST(testSkipsZero);
+  CPPUNIT_TEST(testJitter);
+  CPPUNIT_TEST(testCopy);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testSequence();
+    void testSkipsZero();
+    void testJitter();
+    void testCopy();
+
+ private:
+    void Receive(ReceiveStats *stats, uint8_t sequence, bool skips_zero) {
+      m_now += TimeInterval(0, 25000);
+      stats->PacketReceived(m_now,
+                            stats->CheckSequence(sequence, skips_zero));
+    }
+
+    TimeStamp m_now;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReceiveStatsTest);
+
+
+/*
+ * Check that gaps and out of order packets are counted.
+ */
+void ReceiveStatsTest::testSequence() {
+  ReceiveStats stats;
+  OLA_ASSERT_EQ(0u, stats.Packets());
+  OLA_ASSERT_FALSE(stats.LastSeen().IsSet());
+
+  Receive(&stats, 10, false);
+  Receive(&stats, 11, false);
+  OLA_ASSERT_EQ(2u, stats.Packets());
+  OLA_ASSERT_EQ(0u, stats.SequenceGaps());
+  OLA_ASSERT_EQ(m_now, stats.LastSeen());
+
+  // two packets lost
+  Receive(&stats, 14, false);
+  OLA_ASSERT_EQ(2u, stats.SequenceGaps());
+  OLA_ASSERT_EQ(0u, stats.OutOfOrder());
+
+  // a late packet and a duplicate
+  Receive(&stats, 12, false);
+  Receive(&stats, 14, false);
+  OLA_ASSERT_EQ(2u, stats.OutOfOrder());
+
+  // the sequence continues from 14, wrapping around
+  OLA_ASSERT_EQ(0, stats.CheckSequence(15));
+  OLA_ASSERT_EQ(ReceiveStats::OUT_OF_ORDER, stats.CheckSequence(15));
+  stats = ReceiveStats();
+  OLA_ASSERT_EQ(0, stats.CheckSequence(255));
+  OLA_ASSERT_EQ(0, stats.CheckSequence(0));
+  OLA_ASSERT_EQ(1, stats.CheckSequence(2));
+
+  // a large jump backwards is a restart
+  OLA_ASSERT_EQ(0, stats.CheckSequence(200));
+  OLA_ASSERT_EQ(0, stats.CheckSequence(201));
+}
+
+
+/*
+ * Check Art-Net style sequence numbers, which skip 0.
+ */
+void ReceiveStatsTest::testSkipsZero() {
+  ReceiveStats stats;
+  Receive(&stats, 254, true);
+  Receive(&stats, 255, true);
+  Receive(&stats, 1, true);
+  OLA_ASSERT_EQ(0u, stats.SequenceGaps());
+
+  Receive(&stats, 3, true);
+  OLA_ASSERT_EQ(1u, stats.SequenceGaps());
+
+  // lose 255 and 1
+  Receive(&stats, 254, true);
+  OLA_ASSERT_EQ(1u, stats.OutOfOrder());
+  stats = ReceiveStats();
+  Receive(&stats, 254, true);
+  Receive(&stats, 2, true);
+  OLA_ASSERT_EQ(2u, stats.SequenceGaps());
+  OLA_ASSERT_EQ(0u, stats.OutOfOrder());
+}
+
+
+/*
+ * Check the jitter histogram.
+ */
+void ReceiveStatsTest::testJitter() {
+  OLA_ASSERT_EQ(1u, ReceiveStats::JitterBucketLimit(0));
+  OLA_ASSERT_EQ(0u, ReceiveStats::JitterBucketLimit(
+        ReceiveStats::JITTER_BUCKETS - 1));
+
+  ReceiveStats stats;
+  TimeStamp now;
+  now += TimeInterval(10, 0);
+  stats.PacketReceived(now);
+  now += TimeInterval(0, 25000);
+  stats.PacketReceived(now);
+  // The first two packets don't have a previous interval
+  for (unsigned int i = 0; i < ReceiveStats::JITTER_BUCKETS; i++) {
+    OLA_ASSERT_EQ(0u, stats.JitterCount(i));
+  }
+
+  now += TimeInterval(0, 25000);
+  stats.PacketReceived(now);
+  OLA_ASSERT_EQ(1u, stats.JitterCount(0));
+  OLA_ASSERT_EQ(0u, stats.JitterMicroSeconds());
+
+  // 3ms late
+  now += TimeInterval(0, 28000);
+  stats.PacketReceived(now);
+  OLA_ASSERT_EQ(1u, stats.JitterCount(2));
+  OLA_ASSERT_EQ(187u, stats.JitterMicroSeconds());
+
+  // 200ms late
+  now += TimeInterval(0, 228000);
+  stats.PacketReceived(now);
+  OLA_ASSERT_EQ(1u, stats.JitterCount(ReceiveStats::JITTER_BUCKETS - 1));
+  OLA_ASSERT_EQ(5u, stats.Packets());
+  OLA_ASSERT_EQ(0u, stats.SequenceGaps());
+}
+
+
+/*
+ * Check that copies only take the counters.
+ */
+void ReceiveStatsTest::testCopy() {
+  ReceiveStats stats;
+  Receive(&stats, 1, false);
+  Receive(&stats, 3, false);
+
+  ReceiveStats copy(stats);
+  OLA_ASSERT_EQ(2u, copy.Packets());
+  OLA_ASSERT_EQ(1u, copy.SequenceGaps());
+  OLA_ASSERT_EQ(m_now, copy.LastSeen());
+  OLA_ASSERT_EQ(0, copy.CheckSequence(1));
+}
@@ -19,102 +19,164 @@
  */
 
 #include <string.h>
+#include <ola/Constants.h>
 #include <ola/dmx/RunLengthEncoder.h>
+#include <algorithm>
+
+#include "common/dmx/SlotKernels.h"
 
 namespace ola {
 namespace dmx {
 
+const unsigned int RunLengthEncoder::MAX_SEGMENT_LENGTH;
+
 bool RunLengthEncoder::Encode(const DmxBuffer &src,
                               uint8_t *data,
                               unsigned int *data_size) {
-  unsigned int src_size = src.Size();
+  return EncodeSlots(src.GetRaw(), src.Size(), data, data_size);
+}
+
+bool RunLengthEncoder::Decode(unsigned int start_channel,
+                              const uint8_t *src_data,
+                              unsigned int length,
+                              DmxBuffer *dst) {
+  uint8_t frame[DMX_UNIVERSE_SIZE];
+  unsigned int frame_size = DMX_UNIVERSE_SIZE;
+  if (!DecodeSlots(src_data, length, frame, &frame_size)) {
+    return false;
+  }
+  if (!frame_size) {
+    return true;
+  }
+  // Pads the output to a full frame if it was empty.
+  return dst->SetRange(start_channel, frame, frame_size);
+}
+
+bool RunLengthEncoder::EncodeDelta(const DmxBuffer &base,
+                                   const DmxBuffer &src,
+                                   uint8_t *data,
+                                   unsigned int *size) {
+  uint8_t delta[DMX_UNIVERSE_SIZE];
+  unsigned int delta_size = src.Size();
+  src.Get(delta, &delta_size);
+
+  const uint8_t *base_data = base.GetRaw();
+  unsigned int base_size = std::min(base.Size(), delta_size);
+  for (unsigned int i = 0; i < base_size; i++) {
+    delta[i] ^= base_data[i];
+  }
+  return EncodeSlots(delta, delta_size, data, size);
+}
+
+bool RunLengthEncoder::DecodeDelta(const DmxBuffer &base,
+                                   const uint8_t *src_data,
+                                   unsigned int length,
+                                   DmxBuffer *dst) {
+  // We can't use Decode() here since it pads the output to a full frame.
+  uint8_t frame[DMX_UNIVERSE_SIZE];
+  unsigned int frame_size = DMX_UNIVERSE_SIZE;
+  if (!DecodeSlots(src_data, length, frame, &frame_size)) {
+    return false;
+  }
+
+  const uint8_t *base_data = base.GetRaw();
+  unsigned int base_size = std::min(base.Size(), frame_size);
+  for (unsigned int i = 0; i < base_size; i++) {
+    frame[i] ^= base_data[i];
+  }
+  return dst->Set(frame, frame_size);
+}
+
+/*
+ * Runs of 3 or more slots are sent as a repeat segment, everything else as
+ * literal segments. The run detection uses the slot kernels, so on most CPUs
+ * it checks 16 or 32 slots at a time.
+ */
+bool RunLengthEncoder::EncodeSlots(const uint8_t *src,
+                                   unsigned int src_size,
+                                   uint8_t *data,
+                                   unsigned int *data_size) {
   unsigned int dst_size = *data_size;
   unsigned int &dst_index = *data_size;
   dst_index = 0;
 
-  unsigned int i;
-  for (i = 0; i < src_size && dst_index < dst_size;) {
-    // j points to the first non-repeating value
-    unsigned int j = i + 1;
-    while (j < src_size && src.Get(i) == src.Get(j) && j - i < 0x7f) {
-      j++;
-    }
+  unsigned int i = 0;
+  while (i < src_size && dst_index < dst_size) {
+    unsigned int run = SlotRunLength(
+        src + i, std::min(src_size - i, MAX_SEGMENT_LENGTH));
 
-    // if the number of repeats is more than 2
-    // don't encode only two repeats,
-    if (j - i > 2) {
-      // if room left in dst buffer
-      if (dst_size - dst_index > 1) {
-        data[dst_index++] = (REPEAT_FLAG | (j - i));
-        data[dst_index++] = src.Get(i);
-      } else {
-        // else return what we have done so far
+    // don't encode only two repeats
+    if (run > 2) {
+      if (dst_size - dst_index < 2) {
+        // return what we have done so far
         return false;
       }
-      i = j;
+      data[dst_index++] = REPEAT_FLAG | run;
+      data[dst_index++] = src[i];
+      i += run;
+      continue;
+    }
 
+    // This value doesn't repeat more than twice, the literal segment runs up
+    // to the start of the next run, or the maximum segment length.
+    unsigned int search_size = std::min(src_size - i - 1,
+                                        MAX_SEGMENT_LENGTH + 1);
+    unsigned int next_run = FirstSlotRun(src + i + 1, search_size);
+    unsigned int segment_length;
+    if (next_run + 2 < search_size) {
+      segment_length = next_run + 1;
     } else {
-      // this value doesn't repeat more than twice
-      // find out where the next repeat starts
-
-      // postcondition: j is one more than the last value we want to send
-      for (j = i + 1; j < src_size - 2 && j - i < 0x7f; j++) {
-        // at the end  of the array
-        if (j == src_size - 2) {
-          j = src_size;
-          break;
-        }
-
-        // if we're found a repeat of 3 or more stop here
-        if (src.Get(j) == src.Get(j+1) && src.Get(j) == src.Get(j+2))
-          break;
-      }
-      if (j >= src_size - 2)
-        j = src_size;
-
-      // if we have enough room left for all the values
-      if (dst_index + j - i < dst_size) {
-        data[dst_index++] = j - i;
-        memcpy(&data[dst_index], src.GetRaw() + i, j-i);
-        dst_index += j - i;
-        i = j;
+      segment_length = std::min(src_size - i, MAX_SEGMENT_LENGTH);
+    }
 
+    if (dst_index + segment_length < dst_size) {
+      data[dst_index++] = segment_length;
+      memcpy(&data[dst_index], src + i, segment_length);
+      dst_index += segment_length;
+      i += segment_length;
+    } else if (dst_size - dst_index > 1) {
       // see how much data we can get in
-      } else if (dst_size - dst_index > 1) {
-        unsigned int l = dst_size - dst_index -1;
-        data[dst_index++] = l;
-        memcpy(&data[dst_index], src.GetRaw() + i, l);
-        dst_index += l;
-        return false;
-      } else {
-        return false;
-      }
+      unsigned int l = dst_size - dst_index - 1;
+      data[dst_index++] = l;
+      memcpy(&data[dst_index], src + i, l);
+      dst_index += l;
+      return false;
+    } else {
+      return false;
     }
   }
-
-  if (i < src_size)
-    return false;
-  else
-    return true;
+  return i >= src_size;
 }
 
-bool RunLengthEncoder::Decode(unsigned int start_channel,
-                              const uint8_t *src_data,
-                              unsigned int length,
-                              DmxBuffer *dst) {
-  int destination_index = start_channel;
+/*
+ * Decode segments into frame.
+ * @param[in,out] frame_size the size of frame, set to the number of slots
+ *   decoded.
+ * @returns false if the data was truncated or too large for the frame.
+ */
+bool RunLengthEncoder::DecodeSlots(const uint8_t *data,
+                                   unsigned int length,
+                                   uint8_t *frame,
+                                   unsigned int *frame_size) {
+  const unsigned int max_size = *frame_size;
+  unsigned int &size = *frame_size;
+  size = 0;
 
   for (unsigned int i = 0; i < length;) {
-    unsigned int segment_length = src_data[i] & (~REPEAT_FLAG);
-    if (src_data[i] & REPEAT_FLAG) {
-      i++;
-      dst->SetRangeToValue(destination_index, src_data[i++], segment_length);
+    unsigned int segment_length = data[i] & (~REPEAT_FLAG);
+    bool repeat = data[i++] & REPEAT_FLAG;
+    if (size + segment_length > max_size ||
+        i + (repeat ? 1 : segment_length) > length) {
+      return false;
+    }
+
+    if (repeat) {
+      memset(frame + size, data[i++], segment_length);
     } else {
-      i++;
-      dst->SetRange(destination_index, src_data + i, segment_length);
+      memcpy(frame + size, data + i, segment_length);
       i += segment_length;
     }
-    destination_index += segment_length;
+    size += segment_length;
   }
   return true;
 }
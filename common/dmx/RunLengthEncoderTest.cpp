@@ -35,13 +35,17 @@ class RunLengthEncoderTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RunLengthEncoderTest);
   CPPUNIT_TEST(testEncode);
   CPPUNIT_TEST(testEncode2);
+  CPPUNIT_TEST(testEncodeShortRuns);
   CPPUNIT_TEST(testEncodeDecode);
+  CPPUNIT_TEST(testDelta);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testEncode();
     void testEncode2();
+    void testEncodeShortRuns();
     void testEncodeDecode();
+    void testDelta();
     void setUp();
     void tearDown();
  private:
@@ -136,6 +140,38 @@ void RunLengthEncoderTest::testEncode2() {
 }
 
 
+/*
+ * Check that short frames and long runs of distinct values are encoded
+ * correctly.
+ */
+void RunLengthEncoderTest::testEncodeShortRuns() {
+  const uint8_t TEST_DATA[] = {7};
+  const uint8_t EXPECTED_DATA[] = {1, 7};
+  checkEncode(DmxBuffer(TEST_DATA, sizeof(TEST_DATA)),
+              ola::DMX_UNIVERSE_SIZE, true, EXPECTED_DATA,
+              sizeof(EXPECTED_DATA));
+
+  const uint8_t TEST_DATA2[] = {7, 8};
+  const uint8_t EXPECTED_DATA2[] = {2, 7, 8};
+  checkEncode(DmxBuffer(TEST_DATA2, sizeof(TEST_DATA2)),
+              ola::DMX_UNIVERSE_SIZE, true, EXPECTED_DATA2,
+              sizeof(EXPECTED_DATA2));
+
+  // 128 distinct values must be split into two segments.
+  uint8_t data[128];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  DmxBuffer buffer(data, sizeof(data));
+  unsigned int dst_size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_TRUE(m_encoder.Encode(buffer, m_dst, &dst_size));
+  OLA_ASSERT_EQ(130u, dst_size);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0x7f), m_dst[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), m_dst[128]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(127), m_dst[129]);
+}
+
+
 /*
  * Call Encode then Decode and check the results
  */
@@ -168,4 +204,71 @@ void RunLengthEncoderTest::testEncodeDecode() {
   checkEncodeDecode(TEST_DATA, sizeof(TEST_DATA));
   checkEncodeDecode(TEST_DATA2, sizeof(TEST_DATA2));
   checkEncodeDecode(TEST_DATA3, sizeof(TEST_DATA3));
+
+  // A full frame with runs longer than a segment, and runs that straddle the
+  // blocks the run detection works on.
+  uint8_t frame[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < sizeof(frame); i++) {
+    frame[i] = i < 300 ? 0 : (i / 3) & 0xff;
+  }
+  DmxBuffer src(frame, sizeof(frame));
+  DmxBuffer dst;
+  unsigned int dst_size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_TRUE(m_encoder.Encode(src, m_dst, &dst_size));
+  OLA_ASSERT_TRUE(m_encoder.Decode(0, m_dst, dst_size, &dst));
+  OLA_ASSERT_DMX_EQUALS(src, dst);
+
+  // Truncated data is rejected.
+  const uint8_t TRUNCATED[] = {4, 1, 2};
+  OLA_ASSERT_FALSE(m_encoder.Decode(0, TRUNCATED, sizeof(TRUNCATED), &dst));
+}
+
+
+/*
+ * Check that EncodeDelta / DecodeDelta work.
+ */
+void RunLengthEncoderTest::testDelta() {
+  DmxBuffer base;
+  base.Blackout();
+  DmxBuffer frame(base);
+  frame.SetChannel(10, 255);
+  frame.SetChannel(11, 128);
+
+  // Two changed slots in a full universe fit in a few bytes.
+  unsigned int size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_TRUE(m_encoder.EncodeDelta(base, frame, m_dst, &size));
+  const uint8_t EXPECTED_DATA[] = {0x8a, 0, 2, 255, 128, 0xff, 0, 0xff, 0,
+                                   0xff, 0, 0xf7, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_DATA, sizeof(EXPECTED_DATA), m_dst, size);
+
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(m_encoder.DecodeDelta(base, m_dst, size, &output));
+  OLA_ASSERT_TRUE(frame == output);
+
+  // A base that's shorter than the frame.
+  const uint8_t SHORT_DATA[] = {1, 2, 3};
+  const uint8_t LONG_DATA[] = {1, 2, 4, 5, 6};
+  DmxBuffer short_base(SHORT_DATA, sizeof(SHORT_DATA));
+  DmxBuffer long_frame(LONG_DATA, sizeof(LONG_DATA));
+  size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_TRUE(m_encoder.EncodeDelta(short_base, long_frame, m_dst, &size));
+  OLA_ASSERT_TRUE(m_encoder.DecodeDelta(short_base, m_dst, size, &output));
+  OLA_ASSERT_TRUE(long_frame == output);
+
+  // and a frame that's shorter than the base.
+  size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_TRUE(m_encoder.EncodeDelta(long_frame, short_base, m_dst, &size));
+  OLA_ASSERT_TRUE(m_encoder.DecodeDelta(long_frame, m_dst, size, &output));
+  OLA_ASSERT_TRUE(short_base == output);
+
+  // Malformed deltas are rejected.
+  const uint8_t TRUNCATED[] = {4, 1, 2};
+  OLA_ASSERT_FALSE(m_encoder.DecodeDelta(base, TRUNCATED, sizeof(TRUNCATED),
+                                         &output));
+  const uint8_t TRUNCATED_REPEAT[] = {0x84};
+  OLA_ASSERT_FALSE(m_encoder.DecodeDelta(base, TRUNCATED_REPEAT,
+                                         sizeof(TRUNCATED_REPEAT), &output));
+  const uint8_t TOO_LONG[] = {0xff, 0, 0xff, 0, 0xff, 0, 0xff, 0, 0xff, 0};
+  OLA_ASSERT_FALSE(m_encoder.DecodeDelta(base, TOO_LONG, sizeof(TOO_LONG),
+                                         &output));
 }
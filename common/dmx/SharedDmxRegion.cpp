@@ -0,0 +1,429 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegion.cpp
+ * A shared memory region used to pass DMX data between olad and local
+ * clients.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * The slots use the sequence lock described in Boehm's "Can Seqlocks Get
+ * Along With Programming Language Memory Models?". The writer makes the
+ * sequence number odd, updates the slot and then makes it even again. A reader
+ * copies the slot out and only uses the copy if the sequence number was even
+ * and unchanged across the copy.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_SHM_OPEN
+#include <sys/mman.h>
+#endif  // HAVE_SHM_OPEN
+
+#include <algorithm>
+#include <string>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+
+namespace ola {
+namespace dmx {
+
+using std::string;
+
+namespace {
+const uint32_t REGION_MAGIC = 0x4f4c4153;  // OLAS
+const uint32_t REGION_VERSION = 1;
+// The number of times a reader retries before giving up. If the writer died
+// mid-write the slot stays locked, so we can't spin forever.
+const unsigned int MAX_READ_ATTEMPTS = 100;
+}  // namespace
+
+struct SharedDmxRegion::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t input_slots;
+  uint32_t output_slots;
+  uint32_t slot_size;
+  uint32_t open;
+  uint8_t reserved[40];
+};
+
+struct SharedDmxRegion::Slot {
+  uint32_t sequence;
+  uint32_t owner;  // the client's pid for input slots, 1 for output slots
+  uint32_t universe;
+  uint32_t last_read;  // only used by output slots
+  uint16_t length;
+  uint8_t priority;
+  uint8_t padding;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  uint8_t reserved[44];  // pad to a multiple of the cache line size
+};
+
+
+namespace {
+
+template <typename SlotType>
+void BeginWrite(SlotType *slot) {
+  uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+template <typename SlotType>
+void EndWrite(SlotType *slot) {
+  uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+template <typename SlotType>
+void WriteFrame(SlotType *slot, uint8_t priority, const DmxBuffer &buffer) {
+  unsigned int length = std::min(buffer.Size(),
+                                 static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  slot->priority = priority;
+  slot->length = static_cast<uint16_t>(length);
+  memcpy(slot->data, buffer.GetRaw(), length);
+}
+
+/*
+ * Copy a slot out, returns false if the read couldn't complete.
+ */
+template <typename SlotType>
+bool ReadSlot(const SlotType *slot, uint32_t *owner, uint32_t *universe,
+              SharedDmxRegion::Frame *frame) {
+  for (unsigned int i = 0; i < MAX_READ_ATTEMPTS; i++) {
+    uint32_t start = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (start & 1) {
+      continue;
+    }
+    *owner = slot->owner;
+    *universe = slot->universe;
+    frame->priority = slot->priority;
+    frame->length = std::min(slot->length,
+                             static_cast<uint16_t>(DMX_UNIVERSE_SIZE));
+    memcpy(frame->data, slot->data, frame->length);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == start) {
+      // Each write increments the sequence twice.
+      frame->sequence = start / 2;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+
+SharedDmxRegion::SharedDmxRegion(const string &name, bool creator,
+                                 void *memory, size_t size)
+    : m_name(name),
+      m_creator(creator),
+      m_memory(memory),
+      m_size(size) {
+  uint8_t *base = reinterpret_cast<uint8_t*>(memory);
+  m_header = reinterpret_cast<Header*>(base);
+  m_input_slots = reinterpret_cast<Slot*>(base + sizeof(Header));
+  m_output_slots = m_input_slots + INPUT_SLOTS;
+}
+
+SharedDmxRegion::~SharedDmxRegion() {
+#ifdef HAVE_SHM_OPEN
+  if (m_creator) {
+    __atomic_store_n(&m_header->open, 0, __ATOMIC_RELEASE);
+  }
+  munmap(m_memory, m_size);
+  if (m_creator) {
+    shm_unlink(m_name.c_str());
+  }
+#endif  // HAVE_SHM_OPEN
+}
+
+SharedDmxRegion *SharedDmxRegion::Create(const string &name) {
+#ifdef HAVE_SHM_OPEN
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+  if (fd < 0) {
+    OLA_WARN << "shm_open(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  // Clients can already send DMX to olad over the RPC socket, so allow
+  // anyone who can reach that to use the region as well.
+  fchmod(fd, 0666);
+
+  size_t size = RegionSize();
+  if (ftruncate(fd, size) < 0) {
+    OLA_WARN << "Failed to size " << name << ": " << strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "Failed to map " << name << ": " << strerror(errno);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+
+  // ftruncate() zeroed the memory, so all slots start out unused.
+  SharedDmxRegion *region = new SharedDmxRegion(name, true, memory, size);
+  Header *header = region->m_header;
+  header->magic = REGION_MAGIC;
+  header->version = REGION_VERSION;
+  header->input_slots = INPUT_SLOTS;
+  header->output_slots = OUTPUT_SLOTS;
+  header->slot_size = sizeof(Slot);
+  __atomic_store_n(&header->open, 1, __ATOMIC_RELEASE);
+  return region;
+#else
+  OLA_WARN << "Shared memory isn't supported on this platform, can't create "
+           << name;
+  return NULL;
+#endif  // HAVE_SHM_OPEN
+}
+
+SharedDmxRegion *SharedDmxRegion::Open(const string &name) {
+#ifdef HAVE_SHM_OPEN
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    OLA_INFO << "shm_open(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  size_t size = RegionSize();
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) < 0 ||
+      static_cast<size_t>(stat_buf.st_size) < size) {
+    OLA_WARN << name << " is too small";
+    close(fd);
+    return NULL;
+  }
+
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "Failed to map " << name << ": " << strerror(errno);
+    return NULL;
+  }
+
+  const Header *header = reinterpret_cast<const Header*>(memory);
+  if (!__atomic_load_n(&header->open, __ATOMIC_ACQUIRE) ||
+      header->magic != REGION_MAGIC ||
+      header->version != REGION_VERSION ||
+      header->input_slots != INPUT_SLOTS ||
+      header->output_slots != OUTPUT_SLOTS ||
+      header->slot_size != sizeof(Slot)) {
+    OLA_WARN << name << " isn't a compatible DMX region";
+    munmap(memory, size);
+    return NULL;
+  }
+  return new SharedDmxRegion(name, false, memory, size);
+#else
+  OLA_INFO << "Shared memory isn't supported on this platform, can't open "
+           << name;
+  return NULL;
+#endif  // HAVE_SHM_OPEN
+}
+
+string SharedDmxRegion::NameForPort(uint16_t port) {
+  return "/ola-dmx-" + IntToString(port);
+}
+
+bool SharedDmxRegion::IsOpen() const {
+  return __atomic_load_n(&m_header->open, __ATOMIC_ACQUIRE);
+}
+
+int SharedDmxRegion::ClaimInputSlot(uint32_t owner) {
+  if (!owner) {
+    return -1;
+  }
+
+  for (unsigned int i = 0; i < INPUT_SLOTS; i++) {
+    uint32_t unused = 0;
+    if (__atomic_compare_exchange_n(&m_input_slots[i].owner, &unused, owner,
+                                    false, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_RELAXED)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint32_t SharedDmxRegion::InputSlotOwner(unsigned int slot) const {
+  if (slot >= INPUT_SLOTS) {
+    return 0;
+  }
+  return __atomic_load_n(&m_input_slots[slot].owner, __ATOMIC_ACQUIRE);
+}
+
+void SharedDmxRegion::ReleaseInputSlot(unsigned int slot) {
+  if (slot >= INPUT_SLOTS) {
+    return;
+  }
+  Slot *input = &m_input_slots[slot];
+  BeginWrite(input);
+  input->universe = 0;
+  input->length = 0;
+  EndWrite(input);
+  __atomic_store_n(&input->owner, 0, __ATOMIC_RELEASE);
+}
+
+bool SharedDmxRegion::WriteInput(unsigned int slot,
+                                 unsigned int universe,
+                                 uint8_t priority,
+                                 const DmxBuffer &buffer) {
+  if (slot >= INPUT_SLOTS) {
+    return false;
+  }
+  Slot *input = &m_input_slots[slot];
+  BeginWrite(input);
+  input->universe = universe;
+  WriteFrame(input, priority, buffer);
+  EndWrite(input);
+  return true;
+}
+
+bool SharedDmxRegion::ReadInput(unsigned int slot,
+                                unsigned int *universe,
+                                uint8_t *priority,
+                                DmxBuffer *buffer) const {
+  if (slot >= INPUT_SLOTS) {
+    return false;
+  }
+  uint32_t owner, slot_universe;
+  Frame frame;
+  if (!ReadSlot(&m_input_slots[slot], &owner, &slot_universe, &frame) ||
+      !owner) {
+    return false;
+  }
+  *universe = slot_universe;
+  *priority = frame.priority;
+  buffer->Set(frame.data, frame.length);
+  return true;
+}
+
+int SharedDmxRegion::AssignOutputSlot(unsigned int universe, uint32_t now) {
+  for (unsigned int i = 0; i < OUTPUT_SLOTS; i++) {
+    Slot *output = &m_output_slots[i];
+    if (__atomic_load_n(&output->owner, __ATOMIC_RELAXED)) {
+      continue;
+    }
+    BeginWrite(output);
+    output->universe = universe;
+    output->length = 0;
+    output->priority = 0;
+    __atomic_store_n(&output->last_read, now, __ATOMIC_RELAXED);
+    __atomic_store_n(&output->owner, 1, __ATOMIC_RELAXED);
+    EndWrite(output);
+    return i;
+  }
+  return -1;
+}
+
+void SharedDmxRegion::ReleaseOutputSlot(unsigned int slot) {
+  if (slot >= OUTPUT_SLOTS) {
+    return;
+  }
+  Slot *output = &m_output_slots[slot];
+  BeginWrite(output);
+  __atomic_store_n(&output->owner, 0, __ATOMIC_RELAXED);
+  output->length = 0;
+  EndWrite(output);
+}
+
+int SharedDmxRegion::FindOutputSlot(unsigned int universe) const {
+  for (unsigned int i = 0; i < OUTPUT_SLOTS; i++) {
+    const Slot *output = &m_output_slots[i];
+    if (__atomic_load_n(&output->owner, __ATOMIC_ACQUIRE) &&
+        output->universe == universe) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool SharedDmxRegion::WriteOutput(unsigned int slot,
+                                  uint8_t priority,
+                                  const DmxBuffer &buffer) {
+  if (slot >= OUTPUT_SLOTS) {
+    return false;
+  }
+  Slot *output = &m_output_slots[slot];
+  BeginWrite(output);
+  WriteFrame(output, priority, buffer);
+  EndWrite(output);
+  return true;
+}
+
+bool SharedDmxRegion::ReadOutput(unsigned int slot,
+                                 unsigned int universe,
+                                 uint32_t now,
+                                 uint8_t *priority,
+                                 DmxBuffer *buffer) {
+  Frame frame;
+  if (!ReadOutput(slot, universe, now, &frame)) {
+    return false;
+  }
+  *priority = frame.priority;
+  buffer->Set(frame.data, frame.length);
+  return true;
+}
+
+bool SharedDmxRegion::ReadOutput(unsigned int slot,
+                                 unsigned int universe,
+                                 uint32_t now,
+                                 Frame *frame) {
+  if (slot >= OUTPUT_SLOTS) {
+    return false;
+  }
+  Slot *output = &m_output_slots[slot];
+  uint32_t owner, slot_universe;
+  if (!ReadSlot(output, &owner, &slot_universe, frame) || !owner ||
+      slot_universe != universe) {
+    return false;
+  }
+
+  // Only touch the cache line if the time has changed.
+  if (__atomic_load_n(&output->last_read, __ATOMIC_RELAXED) != now) {
+    __atomic_store_n(&output->last_read, now, __ATOMIC_RELAXED);
+  }
+  return true;
+}
+
+uint32_t SharedDmxRegion::OutputSlotLastRead(unsigned int slot) const {
+  if (slot >= OUTPUT_SLOTS) {
+    return 0;
+  }
+  return __atomic_load_n(&m_output_slots[slot].last_read, __ATOMIC_RELAXED);
+}
+
+size_t SharedDmxRegion::RegionSize() {
+  return sizeof(Header) + (INPUT_SLOTS + OUTPUT_SLOTS) * sizeof(Slot);
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,259 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegion.h
+ * A shared memory region used to pass DMX data between olad and local
+ * clients.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_DMX_SHAREDDMXREGION_H_
+#define COMMON_DMX_SHAREDDMXREGION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A shared memory region holding DMX frames.
+ *
+ * olad creates the region and clients on the same host map it. The region
+ * contains two tables of slots, each holding a single frame of DMX data:
+ *  - Input slots, which are claimed by a client and written to, to send DMX
+ *    data to olad.
+ *  - Output slots, which olad assigns to a universe and writes the merged
+ *    data for that universe into.
+ *
+ * Each slot has a single writer, and is protected by a sequence lock so that
+ * readers never block the writer. A reader that races with the writer retries
+ * the read.
+ *
+ * The region only carries data. Clients use a Doorbell datagram to tell olad
+ * that an input slot has changed, or that they'd like a universe to be
+ * published to an output slot.
+ */
+class SharedDmxRegion {
+ public:
+  enum { INPUT_SLOTS = 64 };
+  enum { OUTPUT_SLOTS = 64 };
+
+  /**
+   * @brief The types of Doorbell message.
+   */
+  typedef enum {
+    DOORBELL_INPUT_UPDATED = 1,  /**< value is the input slot */
+    DOORBELL_INPUT_RELEASED = 2,  /**< value is the input slot */
+    DOORBELL_SUBSCRIBE = 3,  /**< value is the universe id */
+  } DoorbellType;
+
+  /**
+   * @brief The datagram sent from the client to olad.
+   *
+   * This only ever crosses the loopback interface, so it's in host order.
+   */
+  typedef struct {
+    uint32_t type;
+    uint32_t value;
+  } Doorbell;
+
+  /**
+   * @brief A frame copied out of a slot.
+   */
+  typedef struct {
+    /**
+     * @brief Changes each time the slot is written, so a reader can tell if
+     * it has already seen the frame.
+     */
+    uint32_t sequence;
+    uint8_t priority;
+    unsigned int length;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+  } Frame;
+
+  ~SharedDmxRegion();
+
+  /**
+   * @brief Create a new region, replacing any existing region with the same
+   *   name. This is called by olad.
+   * @param name the name of the region.
+   * @returns a new SharedDmxRegion or NULL if it couldn't be created.
+   */
+  static SharedDmxRegion *Create(const std::string &name);
+
+  /**
+   * @brief Map an existing region. This is called by clients.
+   * @param name the name of the region.
+   * @returns a new SharedDmxRegion or NULL if the region doesn't exist or
+   *   isn't compatible.
+   */
+  static SharedDmxRegion *Open(const std::string &name);
+
+  /**
+   * @brief The name of the region for the olad instance listening on an RPC
+   *   port.
+   */
+  static std::string NameForPort(uint16_t port);
+
+  /**
+   * @brief Check if the region is still being served.
+   * @returns false once the creator has closed the region.
+   */
+  bool IsOpen() const;
+
+  /**
+   * @brief Input slots, written by clients and read by olad.
+   * @{
+   */
+
+  /**
+   * @brief Claim an unused input slot.
+   * @param owner the pid of the owning process, this must not be 0.
+   * @returns the slot index or -1 if all slots are in use.
+   */
+  int ClaimInputSlot(uint32_t owner);
+
+  /**
+   * @brief Return the owner of an input slot, or 0 if the slot is unused.
+   */
+  uint32_t InputSlotOwner(unsigned int slot) const;
+
+  /**
+   * @brief Mark an input slot as unused. This is called by olad.
+   */
+  void ReleaseInputSlot(unsigned int slot);
+
+  /**
+   * @brief Write a frame into an input slot.
+   * @returns false if the slot index was invalid.
+   */
+  bool WriteInput(unsigned int slot,
+                  unsigned int universe,
+                  uint8_t priority,
+                  const DmxBuffer &buffer);
+
+  /**
+   * @brief Read the frame in an input slot.
+   * @returns false if the slot index was invalid, the slot isn't owned or the
+   *   read couldn't complete.
+   */
+  bool ReadInput(unsigned int slot,
+                 unsigned int *universe,
+                 uint8_t *priority,
+                 DmxBuffer *buffer) const;
+  /**
+   * @}
+   */
+
+  /**
+   * @brief Output slots, written by olad and read by clients.
+   * @{
+   */
+
+  /**
+   * @brief Assign an unused output slot to a universe. This is called by
+   *   olad.
+   * @param universe the universe to assign the slot to.
+   * @param now the current time in seconds, used as the initial read time.
+   * @returns the slot index or -1 if all slots are in use.
+   */
+  int AssignOutputSlot(unsigned int universe, uint32_t now);
+
+  /**
+   * @brief Mark an output slot as unused. This is called by olad.
+   */
+  void ReleaseOutputSlot(unsigned int slot);
+
+  /**
+   * @brief Find the output slot assigned to a universe.
+   * @returns the slot index or -1 if the universe isn't being published.
+   */
+  int FindOutputSlot(unsigned int universe) const;
+
+  /**
+   * @brief Write a frame to an output slot. This is called by olad.
+   * @returns false if the slot index was invalid.
+   */
+  bool WriteOutput(unsigned int slot,
+                   uint8_t priority,
+                   const DmxBuffer &buffer);
+
+  /**
+   * @brief Read the frame from an output slot.
+   * @param slot the slot to read.
+   * @param universe the universe the slot is expected to hold.
+   * @param now the current time in seconds, this is recorded so olad knows
+   *   the slot is still in use.
+   * @param[out] priority the priority of the data.
+   * @param[out] buffer the DMX data.
+   * @returns false if the slot no longer holds the universe or the read
+   *   couldn't complete.
+   */
+  bool ReadOutput(unsigned int slot,
+                  unsigned int universe,
+                  uint32_t now,
+                  uint8_t *priority,
+                  DmxBuffer *buffer);
+
+  /**
+   * @brief Read the frame from an output slot, without allocating.
+   * @param slot the slot to read.
+   * @param universe the universe the slot is expected to hold.
+   * @param now the current time in seconds, this is recorded so olad knows
+   *   the slot is still in use.
+   * @param[out] frame the frame.
+   * @returns false if the slot no longer holds the universe or the read
+   *   couldn't complete.
+   */
+  bool ReadOutput(unsigned int slot,
+                  unsigned int universe,
+                  uint32_t now,
+                  Frame *frame);
+
+  /**
+   * @brief The time, in seconds, that a client last read an output slot.
+   */
+  uint32_t OutputSlotLastRead(unsigned int slot) const;
+  /**
+   * @}
+   */
+
+ private:
+  struct Header;
+  struct Slot;
+
+  std::string m_name;
+  bool m_creator;
+  void *m_memory;
+  size_t m_size;
+  Header *m_header;
+  Slot *m_input_slots;
+  Slot *m_output_slots;
+
+  SharedDmxRegion(const std::string &name, bool creator, void *memory,
+                  size_t size);
+
+  static size_t RegionSize();
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxRegion);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_SHAREDDMXREGION_H_
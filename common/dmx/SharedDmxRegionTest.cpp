@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegionTest.cpp
+ * Test fixture for the SharedDmxRegion class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/DmxBuffer.h"
+#include "ola/StringUtils.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::SharedDmxRegion;
+using std::auto_ptr;
+using std::string;
+
+class SharedDmxRegionTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SharedDmxRegionTest);
+  CPPUNIT_TEST(testOpen);
+  CPPUNIT_TEST(testInput);
+  CPPUNIT_TEST(testOutput);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void tearDown();
+    void testOpen();
+    void testInput();
+    void testOutput();
+
+ private:
+    string m_name;
+    auto_ptr<SharedDmxRegion> m_server;
+    auto_ptr<SharedDmxRegion> m_client;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedDmxRegionTest);
+
+
+void SharedDmxRegionTest::setUp() {
+  m_name = "/ola-dmx-test-" + ola::IntToString(getpid());
+  m_server.reset(SharedDmxRegion::Create(m_name));
+  OLA_ASSERT_NOT_NULL(m_server.get());
+  m_client.reset(SharedDmxRegion::Open(m_name));
+  OLA_ASSERT_NOT_NULL(m_client.get());
+}
+
+
+void SharedDmxRegionTest::tearDown() {
+  m_client.reset();
+  m_server.reset();
+}
+
+
+/*
+ * Check that regions are only opened while they're being served.
+ */
+void SharedDmxRegionTest::testOpen() {
+  OLA_ASSERT_EQ(string("/ola-dmx-9010"), SharedDmxRegion::NameForPort(9010));
+  OLA_ASSERT_NULL(SharedDmxRegion::Open(m_name + "-missing"));
+
+  OLA_ASSERT_TRUE(m_client->IsOpen());
+  m_server.reset();
+  OLA_ASSERT_FALSE(m_client->IsOpen());
+  OLA_ASSERT_NULL(SharedDmxRegion::Open(m_name));
+}
+
+
+/*
+ * Check that a client can pass data to the server.
+ */
+void SharedDmxRegionTest::testInput() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5");
+  unsigned int universe;
+  uint8_t priority;
+  DmxBuffer output;
+
+  OLA_ASSERT_EQ(-1, m_client->ClaimInputSlot(0));
+  int slot = m_client->ClaimInputSlot(1234);
+  OLA_ASSERT_EQ(0, slot);
+  OLA_ASSERT_EQ(1, m_client->ClaimInputSlot(5678));
+  OLA_ASSERT_EQ(1234u, m_server->InputSlotOwner(slot));
+
+  OLA_ASSERT_TRUE(m_client->WriteInput(slot, 7, 120, buffer));
+  OLA_ASSERT_TRUE(m_server->ReadInput(slot, &universe, &priority, &output));
+  OLA_ASSERT_EQ(7u, universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), priority);
+  OLA_ASSERT_DMX_EQUALS(buffer, output);
+
+  OLA_ASSERT_FALSE(m_client->WriteInput(SharedDmxRegion::INPUT_SLOTS, 7, 100,
+                                        buffer));
+
+  // Once released the slot can't be read and is reused.
+  m_server->ReleaseInputSlot(slot);
+  OLA_ASSERT_EQ(0u, m_server->InputSlotOwner(slot));
+  OLA_ASSERT_FALSE(m_server->ReadInput(slot, &universe, &priority, &output));
+  OLA_ASSERT_EQ(slot, m_client->ClaimInputSlot(1234));
+
+  // Check we run out of slots.
+  for (unsigned int i = 2; i < SharedDmxRegion::INPUT_SLOTS; i++) {
+    OLA_ASSERT_EQ(static_cast<int>(i), m_client->ClaimInputSlot(1234));
+  }
+  OLA_ASSERT_EQ(-1, m_client->ClaimInputSlot(1234));
+}
+
+
+/*
+ * Check that the server can publish data to a client.
+ */
+void SharedDmxRegionTest::testOutput() {
+  DmxBuffer buffer;
+  buffer.SetFromString("10,20,30");
+  uint8_t priority;
+  DmxBuffer output;
+
+  OLA_ASSERT_EQ(-1, m_client->FindOutputSlot(3));
+  int slot = m_server->AssignOutputSlot(3, 100);
+  OLA_ASSERT_EQ(0, slot);
+  OLA_ASSERT_EQ(slot, m_client->FindOutputSlot(3));
+  OLA_ASSERT_EQ(-1, m_client->FindOutputSlot(4));
+  OLA_ASSERT_EQ(100u, m_server->OutputSlotLastRead(slot));
+
+  // No data yet
+  OLA_ASSERT_TRUE(m_client->ReadOutput(slot, 3, 100, &priority, &output));
+  OLA_ASSERT_EQ(0u, output.Size());
+
+  OLA_ASSERT_TRUE(m_server->WriteOutput(slot, 150, buffer));
+  OLA_ASSERT_TRUE(m_client->ReadOutput(slot, 3, 105, &priority, &output));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), priority);
+  OLA_ASSERT_DMX_EQUALS(buffer, output);
+  OLA_ASSERT_EQ(105u, m_server->OutputSlotLastRead(slot));
+
+  // Reading the wrong universe fails
+  OLA_ASSERT_FALSE(m_client->ReadOutput(slot, 4, 105, &priority, &output));
+
+  // Read into a frame, the sequence only changes when the slot is written.
+  SharedDmxRegion::Frame frame;
+  OLA_ASSERT_TRUE(m_client->ReadOutput(slot, 3, 105, &frame));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), frame.priority);
+  OLA_ASSERT_DATA_EQUALS(buffer.GetRaw(), buffer.Size(), frame.data,
+                         frame.length);
+  const uint32_t sequence = frame.sequence;
+  OLA_ASSERT_TRUE(m_client->ReadOutput(slot, 3, 105, &frame));
+  OLA_ASSERT_EQ(sequence, frame.sequence);
+  OLA_ASSERT_TRUE(m_server->WriteOutput(slot, 150, buffer));
+  OLA_ASSERT_TRUE(m_client->ReadOutput(slot, 3, 105, &frame));
+  OLA_ASSERT_EQ(sequence + 1, frame.sequence);
+  OLA_ASSERT_FALSE(m_client->ReadOutput(slot, 4, 105, &frame));
+
+  m_server->ReleaseOutputSlot(slot);
+  OLA_ASSERT_EQ(-1, m_client->FindOutputSlot(3));
+  OLA_ASSERT_FALSE(m_client->ReadOutput(slot, 3, 105, &priority, &output));
+}
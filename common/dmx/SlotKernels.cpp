@@ -0,0 +1,823 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SlotKernels.cpp
+ * Vectorized operations on blocks of DMX slot data.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * The x86 kernels are built with function level target attributes, so we
+ * don't need to compile the whole library with -mavx2. The implementation is
+ * picked at runtime based on what the CPU supports.
+ *
+ * NEON is part of the baseline for AArch64, and on 32 bit ARM it's only
+ * available if the compiler was told the target has it (-mfpu=neon), so on
+ * ARM the NEON kernels are selected at compile time.
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "common/dmx/SlotKernels.h"
+#include "ola/dmx/SourcePriorities.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OLA_SLOT_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OLA_SLOT_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif  // x86 or NEON
+
+namespace ola {
+namespace dmx {
+
+namespace {
+
+typedef struct {
+  SlotKernelImpl impl;
+  void (*slot_max)(uint8_t *dst, const uint8_t *src, unsigned int length);
+  void (*priority_merge)(uint8_t *dst, uint8_t *dst_priorities,
+                         const uint8_t *src, const uint8_t *src_priorities,
+                         unsigned int length);
+  void (*lerp)(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+               unsigned int weight, unsigned int length);
+  void (*masked_copy)(uint8_t *dst, const uint8_t *src,
+                      const uint8_t *mask, unsigned int length);
+  bool (*slots_equal)(const uint8_t *a, const uint8_t *b,
+                      unsigned int length);
+  unsigned int (*first_differing_slot)(const uint8_t *a, const uint8_t *b,
+                                       unsigned int length);
+  unsigned int (*differing_slots)(const uint8_t *a, const uint8_t *b,
+                                  unsigned int length);
+  unsigned int (*run_length)(const uint8_t *data, unsigned int length);
+  unsigned int (*first_run)(const uint8_t *data, unsigned int length);
+} KernelTable;
+
+// Scalar implementations, these are also used to handle the tail of the
+// vectorized versions.
+void ScalarMax(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  for (unsigned int i = 0; i < length; i++) {
+    dst[i] = std::max(dst[i], src[i]);
+  }
+}
+
+void ScalarPriorityMerge(uint8_t *dst, uint8_t *dst_priorities,
+                         const uint8_t *src, const uint8_t *src_priorities,
+                         unsigned int length) {
+  for (unsigned int i = 0; i < length; i++) {
+    if (src_priorities[i] > dst_priorities[i]) {
+      dst[i] = src[i];
+      dst_priorities[i] = src_priorities[i];
+    } else if (src_priorities[i] == dst_priorities[i] &&
+               src_priorities[i] != SLOT_PRIORITY_NOT_SOURCED) {
+      dst[i] = std::max(dst[i], src[i]);
+    }
+  }
+}
+
+void ScalarLerp(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+                unsigned int weight, unsigned int length) {
+  const unsigned int start_weight = SLOT_LERP_MAX_WEIGHT - weight;
+  for (unsigned int i = 0; i < length; i++) {
+    dst[i] = (start[i] * start_weight + end[i] * weight + 128) >> 8;
+  }
+}
+
+void ScalarMaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                      unsigned int length) {
+  for (unsigned int i = 0; i < length; i++) {
+    dst[i] = (dst[i] & ~mask[i]) | (src[i] & mask[i]);
+  }
+}
+
+bool ScalarEqual(const uint8_t *a, const uint8_t *b, unsigned int length) {
+  return 0 == memcmp(a, b, length);
+}
+
+unsigned int ScalarFirstDifference(const uint8_t *a, const uint8_t *b,
+                                   unsigned int length) {
+  unsigned int i = 0;
+  while (i < length && a[i] == b[i]) {
+    i++;
+  }
+  return i;
+}
+
+unsigned int ScalarDifferences(const uint8_t *a, const uint8_t *b,
+                               unsigned int length) {
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < length; i++) {
+    count += a[i] != b[i];
+  }
+  return count;
+}
+
+unsigned int ScalarRunLength(const uint8_t *data, unsigned int length,
+                             uint8_t value) {
+  unsigned int i = 0;
+  while (i < length && data[i] == value) {
+    i++;
+  }
+  return i;
+}
+
+unsigned int ScalarRunLength(const uint8_t *data, unsigned int length) {
+  return length ? ScalarRunLength(data, length, data[0]) : 0;
+}
+
+unsigned int ScalarFirstRun(const uint8_t *data, unsigned int length) {
+  for (unsigned int i = 0; i + 2 < length; i++) {
+    if (data[i] == data[i + 1] && data[i] == data[i + 2]) {
+      return i;
+    }
+  }
+  return length;
+}
+
+const KernelTable kScalarKernels = {
+  SLOT_KERNELS_SCALAR,
+  ScalarMax,
+  ScalarPriorityMerge,
+  ScalarLerp,
+  ScalarMaskedCopy,
+  ScalarEqual,
+  ScalarFirstDifference,
+  ScalarDifferences,
+  ScalarRunLength,
+  ScalarFirstRun,
+};
+
+#ifdef OLA_SLOT_KERNELS_X86
+__attribute__((target("sse2")))
+void SSE2Max(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(d, s));
+  }
+  ScalarMax(dst + i, src + i, length - i);
+}
+
+/*
+ * Returns the lanes of a where the mask is set, and the lanes of b otherwise.
+ */
+__attribute__((target("sse2")))
+inline __m128i SSE2Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/*
+ * SSE2 doesn't have an unsigned compare, so the slots where the existing
+ * priority is at least as high are found with max(sp, dp) == dp.
+ */
+__attribute__((target("sse2")))
+void SSE2PriorityMerge(uint8_t *dst, uint8_t *dst_priorities,
+                       const uint8_t *src, const uint8_t *src_priorities,
+                       unsigned int length) {
+  const __m128i zero = _mm_setzero_si128();
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i dp = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(dst_priorities + i));
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i sp = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src_priorities + i));
+
+    __m128i max_priority = _mm_max_epu8(sp, dp);
+    __m128i keep = _mm_cmpeq_epi8(max_priority, dp);
+    __m128i tie = _mm_andnot_si128(_mm_cmpeq_epi8(sp, zero),
+                                   _mm_cmpeq_epi8(sp, dp));
+    __m128i result = SSE2Select(tie, _mm_max_epu8(d, s), d);
+    result = SSE2Select(keep, result, s);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_priorities + i),
+                     max_priority);
+  }
+  ScalarPriorityMerge(dst + i, dst_priorities + i, src + i,
+                      src_priorities + i, length - i);
+}
+
+/*
+ * Interpolate 8 slots that have been widened to 16 bits. The largest sum is
+ * 255 * 256 + 128, so it doesn't overflow.
+ */
+__attribute__((target("sse2")))
+inline __m128i SSE2LerpHalf(__m128i s, __m128i e, __m128i start_weight,
+                            __m128i weight) {
+  __m128i sum = _mm_add_epi16(_mm_mullo_epi16(s, start_weight),
+                              _mm_mullo_epi16(e, weight));
+  return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+}
+
+__attribute__((target("sse2")))
+void SSE2Lerp(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+              unsigned int weight, unsigned int length) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i w = _mm_set1_epi16(weight);
+  const __m128i sw = _mm_set1_epi16(SLOT_LERP_MAX_WEIGHT - weight);
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start + i));
+    __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(end + i));
+    __m128i lo = SSE2LerpHalf(_mm_unpacklo_epi8(s, zero),
+                              _mm_unpacklo_epi8(e, zero), sw, w);
+    __m128i hi = SSE2LerpHalf(_mm_unpackhi_epi8(s, zero),
+                              _mm_unpackhi_epi8(e, zero), sw, w);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+  ScalarLerp(dst + i, start + i, end + i, weight, length - i);
+}
+
+__attribute__((target("sse2")))
+void SSE2MaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                    unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     SSE2Select(m, s, d));
+  }
+  ScalarMaskedCopy(dst + i, src + i, mask + i, length - i);
+}
+
+__attribute__((target("sse2")))
+unsigned int SSE2FirstDifference(const uint8_t *a, const uint8_t *b,
+                                 unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xffff;
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ScalarFirstDifference(a + i, b + i, length - i);
+}
+
+__attribute__((target("sse2")))
+unsigned int SSE2Differences(const uint8_t *a, const uint8_t *b,
+                             unsigned int length) {
+  unsigned int count = 0;
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xffff;
+    count += __builtin_popcount(mask);
+  }
+  return count + ScalarDifferences(a + i, b + i, length - i);
+}
+
+__attribute__((target("sse2")))
+bool SSE2Equal(const uint8_t *a, const uint8_t *b, unsigned int length) {
+  return SSE2FirstDifference(a, b, length) == length;
+}
+
+__attribute__((target("sse2")))
+unsigned int SSE2RunLength(const uint8_t *data, unsigned int length,
+                           uint8_t value) {
+  const __m128i values = _mm_set1_epi8(static_cast<char>(value));
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, values)) ^ 0xffff;
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ScalarRunLength(data + i, length - i, value);
+}
+
+__attribute__((target("sse2")))
+unsigned int SSE2RunLength(const uint8_t *data, unsigned int length) {
+  return length ? SSE2RunLength(data, length, data[0]) : 0;
+}
+
+/*
+ * Compare each slot with the next two, the offset loads mean we can only
+ * check up to length - 18 in the vector loop.
+ */
+__attribute__((target("sse2")))
+unsigned int SSE2FirstRun(const uint8_t *data, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 18 <= length; i += 16) {
+    __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i x1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(data + i + 1));
+    __m128i x2 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(data + i + 2));
+    unsigned int mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(x0, x1), _mm_cmpeq_epi8(x1, x2)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ScalarFirstRun(data + i, length - i);
+}
+
+__attribute__((target("avx2")))
+void AVX2Max(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_max_epu8(d, s));
+  }
+  SSE2Max(dst + i, src + i, length - i);
+}
+
+__attribute__((target("avx2")))
+void AVX2PriorityMerge(uint8_t *dst, uint8_t *dst_priorities,
+                       const uint8_t *src, const uint8_t *src_priorities,
+                       unsigned int length) {
+  const __m256i zero = _mm256_setzero_si256();
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i dp = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(dst_priorities + i));
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i sp = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(src_priorities + i));
+
+    __m256i max_priority = _mm256_max_epu8(sp, dp);
+    __m256i keep = _mm256_cmpeq_epi8(max_priority, dp);
+    __m256i tie = _mm256_andnot_si256(_mm256_cmpeq_epi8(sp, zero),
+                                      _mm256_cmpeq_epi8(sp, dp));
+    __m256i result = _mm256_blendv_epi8(d, _mm256_max_epu8(d, s), tie);
+    result = _mm256_blendv_epi8(s, result, keep);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst_priorities + i),
+                        max_priority);
+  }
+  SSE2PriorityMerge(dst + i, dst_priorities + i, src + i, src_priorities + i,
+                    length - i);
+}
+
+__attribute__((target("avx2")))
+inline __m256i AVX2LerpHalf(__m256i s, __m256i e, __m256i start_weight,
+                            __m256i weight) {
+  __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(s, start_weight),
+                                 _mm256_mullo_epi16(e, weight));
+  return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(128)), 8);
+}
+
+/*
+ * The unpack and pack instructions both work within each 128 bit lane, so the
+ * slots end up back in the right order.
+ */
+__attribute__((target("avx2")))
+void AVX2Lerp(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+              unsigned int weight, unsigned int length) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i w = _mm256_set1_epi16(weight);
+  const __m256i sw = _mm256_set1_epi16(SLOT_LERP_MAX_WEIGHT - weight);
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i s = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(start + i));
+    __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(end + i));
+    __m256i lo = AVX2LerpHalf(_mm256_unpacklo_epi8(s, zero),
+                              _mm256_unpacklo_epi8(e, zero), sw, w);
+    __m256i hi = AVX2LerpHalf(_mm256_unpackhi_epi8(s, zero),
+                              _mm256_unpackhi_epi8(e, zero), sw, w);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  SSE2Lerp(dst + i, start + i, end + i, weight, length - i);
+}
+
+__attribute__((target("avx2")))
+void AVX2MaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                    unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i m = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(mask + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_or_si256(_mm256_andnot_si256(m, d),
+                                        _mm256_and_si256(m, s)));
+  }
+  SSE2MaskedCopy(dst + i, src + i, mask + i, length - i);
+}
+
+__attribute__((target("avx2")))
+unsigned int AVX2FirstDifference(const uint8_t *a, const uint8_t *b,
+                                 unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    uint32_t mask = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + SSE2FirstDifference(a + i, b + i, length - i);
+}
+
+__attribute__((target("avx2")))
+unsigned int AVX2Differences(const uint8_t *a, const uint8_t *b,
+                             unsigned int length) {
+  unsigned int count = 0;
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    uint32_t mask = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    count += __builtin_popcount(mask);
+  }
+  return count + SSE2Differences(a + i, b + i, length - i);
+}
+
+__attribute__((target("avx2")))
+bool AVX2Equal(const uint8_t *a, const uint8_t *b, unsigned int length) {
+  return AVX2FirstDifference(a, b, length) == length;
+}
+
+__attribute__((target("avx2")))
+unsigned int AVX2RunLength(const uint8_t *data, unsigned int length) {
+  if (!length) {
+    return 0;
+  }
+  const __m256i value = _mm256_set1_epi8(static_cast<char>(data[0]));
+  unsigned int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    uint32_t mask = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, value)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + SSE2RunLength(data + i, length - i, data[0]);
+}
+
+__attribute__((target("avx2")))
+unsigned int AVX2FirstRun(const uint8_t *data, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 34 <= length; i += 32) {
+    __m256i x0 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i));
+    __m256i x1 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i + 1));
+    __m256i x2 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i + 2));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(x0, x1),
+                         _mm256_cmpeq_epi8(x1, x2))));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + SSE2FirstRun(data + i, length - i);
+}
+
+const KernelTable kSSE2Kernels = {
+  SLOT_KERNELS_SSE2,
+  SSE2Max,
+  SSE2PriorityMerge,
+  SSE2Lerp,
+  SSE2MaskedCopy,
+  SSE2Equal,
+  SSE2FirstDifference,
+  SSE2Differences,
+  SSE2RunLength,
+  SSE2FirstRun,
+};
+
+const KernelTable kAVX2Kernels = {
+  SLOT_KERNELS_AVX2,
+  AVX2Max,
+  AVX2PriorityMerge,
+  AVX2Lerp,
+  AVX2MaskedCopy,
+  AVX2Equal,
+  AVX2FirstDifference,
+  AVX2Differences,
+  AVX2RunLength,
+  AVX2FirstRun,
+};
+#endif  // OLA_SLOT_KERNELS_X86
+
+#ifdef OLA_SLOT_KERNELS_NEON
+void NEONMax(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+  }
+  ScalarMax(dst + i, src + i, length - i);
+}
+
+void NEONPriorityMerge(uint8_t *dst, uint8_t *dst_priorities,
+                       const uint8_t *src, const uint8_t *src_priorities,
+                       unsigned int length) {
+  const uint8x16_t zero = vdupq_n_u8(0);
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    uint8x16_t d = vld1q_u8(dst + i);
+    uint8x16_t dp = vld1q_u8(dst_priorities + i);
+    uint8x16_t s = vld1q_u8(src + i);
+    uint8x16_t sp = vld1q_u8(src_priorities + i);
+
+    uint8x16_t tie = vbicq_u8(vceqq_u8(sp, dp), vceqq_u8(sp, zero));
+    uint8x16_t result = vbslq_u8(tie, vmaxq_u8(d, s), d);
+    result = vbslq_u8(vcgtq_u8(sp, dp), s, result);
+    vst1q_u8(dst + i, result);
+    vst1q_u8(dst_priorities + i, vmaxq_u8(sp, dp));
+  }
+  ScalarPriorityMerge(dst + i, dst_priorities + i, src + i,
+                      src_priorities + i, length - i);
+}
+
+void NEONLerp(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+              unsigned int weight, unsigned int length) {
+  const uint16x8_t w = vdupq_n_u16(weight);
+  const uint16x8_t sw = vdupq_n_u16(SLOT_LERP_MAX_WEIGHT - weight);
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    uint8x16_t s = vld1q_u8(start + i);
+    uint8x16_t e = vld1q_u8(end + i);
+    uint16x8_t lo = vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(s)), sw),
+                              vmovl_u8(vget_low_u8(e)), w);
+    uint16x8_t hi = vmlaq_u16(vmulq_u16(vmovl_u8(vget_high_u8(s)), sw),
+                              vmovl_u8(vget_high_u8(e)), w);
+    // vrshrn adds 128 before the shift.
+    vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+  }
+  ScalarLerp(dst + i, start + i, end + i, weight, length - i);
+}
+
+void NEONMaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                    unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    vst1q_u8(dst + i, vbslq_u8(vld1q_u8(mask + i), vld1q_u8(src + i),
+                               vld1q_u8(dst + i)));
+  }
+  ScalarMaskedCopy(dst + i, src + i, mask + i, length - i);
+}
+
+/*
+ * Returns true if all 16 lanes of the comparison result are set.
+ */
+inline bool AllLanesSet(uint8x16_t v) {
+#if defined(__aarch64__)
+  return vminvq_u8(v) == 0xff;
+#else
+  uint8x8_t m = vand_u8(vget_low_u8(v), vget_high_u8(v));
+  m = vpmin_u8(m, m);
+  m = vpmin_u8(m, m);
+  m = vpmin_u8(m, m);
+  return vget_lane_u8(m, 0) == 0xff;
+#endif  // __aarch64__
+}
+
+unsigned int NEONFirstDifference(const uint8_t *a, const uint8_t *b,
+                                 unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    if (!AllLanesSet(vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i)))) {
+      // The difference is within this block.
+      return i + ScalarFirstDifference(a + i, b + i, 16);
+    }
+  }
+  return i + ScalarFirstDifference(a + i, b + i, length - i);
+}
+
+unsigned int NEONDifferences(const uint8_t *a, const uint8_t *b,
+                             unsigned int length) {
+  unsigned int count = 0;
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    // Each lane is 1 if the slots differ, 0 otherwise.
+    uint8x16_t diff = vshrq_n_u8(
+        vmvnq_u8(vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i))), 7);
+#if defined(__aarch64__)
+    count += vaddvq_u8(diff);
+#else
+    uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(diff)));
+    count += vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1);
+#endif  // __aarch64__
+  }
+  return count + ScalarDifferences(a + i, b + i, length - i);
+}
+
+bool NEONEqual(const uint8_t *a, const uint8_t *b, unsigned int length) {
+  return NEONFirstDifference(a, b, length) == length;
+}
+
+unsigned int NEONRunLength(const uint8_t *data, unsigned int length) {
+  if (!length) {
+    return 0;
+  }
+  const uint8x16_t value = vdupq_n_u8(data[0]);
+  unsigned int i = 0;
+  for (; i + 16 <= length; i += 16) {
+    if (!AllLanesSet(vceqq_u8(vld1q_u8(data + i), value))) {
+      return i + ScalarRunLength(data + i, 16, data[0]);
+    }
+  }
+  return i + ScalarRunLength(data + i, length - i, data[0]);
+}
+
+/*
+ * Returns true if any of the 16 lanes are set.
+ */
+inline bool AnyLaneSet(uint8x16_t v) {
+#if defined(__aarch64__)
+  return vmaxvq_u8(v) != 0;
+#else
+  uint8x8_t m = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+  m = vpmax_u8(m, m);
+  m = vpmax_u8(m, m);
+  m = vpmax_u8(m, m);
+  return vget_lane_u8(m, 0) != 0;
+#endif  // __aarch64__
+}
+
+unsigned int NEONFirstRun(const uint8_t *data, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + 18 <= length; i += 16) {
+    uint8x16_t x0 = vld1q_u8(data + i);
+    uint8x16_t x1 = vld1q_u8(data + i + 1);
+    uint8x16_t x2 = vld1q_u8(data + i + 2);
+    if (AnyLaneSet(vandq_u8(vceqq_u8(x0, x1), vceqq_u8(x1, x2)))) {
+      // The run starts within this block.
+      return i + ScalarFirstRun(data + i, 18);
+    }
+  }
+  return i + ScalarFirstRun(data + i, length - i);
+}
+
+const KernelTable kNEONKernels = {
+  SLOT_KERNELS_NEON,
+  NEONMax,
+  NEONPriorityMerge,
+  NEONLerp,
+  NEONMaskedCopy,
+  NEONEqual,
+  NEONFirstDifference,
+  NEONDifferences,
+  NEONRunLength,
+  NEONFirstRun,
+};
+#endif  // OLA_SLOT_KERNELS_NEON
+
+const KernelTable *TableFor(SlotKernelImpl impl) {
+  switch (impl) {
+    case SLOT_KERNELS_SCALAR:
+      return &kScalarKernels;
+#ifdef OLA_SLOT_KERNELS_X86
+    case SLOT_KERNELS_SSE2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2") ? &kSSE2Kernels : NULL;
+    case SLOT_KERNELS_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? &kAVX2Kernels : NULL;
+#endif  // OLA_SLOT_KERNELS_X86
+#ifdef OLA_SLOT_KERNELS_NEON
+    case SLOT_KERNELS_NEON:
+      return &kNEONKernels;
+#endif  // OLA_SLOT_KERNELS_NEON
+    default:
+      return NULL;
+  }
+}
+
+const KernelTable *DetectKernels() {
+  const SlotKernelImpl preferred[] = {
+    SLOT_KERNELS_AVX2,
+    SLOT_KERNELS_SSE2,
+    SLOT_KERNELS_NEON,
+  };
+  for (unsigned int i = 0; i < sizeof(preferred) / sizeof(preferred[0]);
+       i++) {
+    const KernelTable *table = TableFor(preferred[i]);
+    if (table) {
+      return table;
+    }
+  }
+  return &kScalarKernels;
+}
+
+// This is read from any thread that merges or compares DMX data, so it's only
+// accessed with the __atomic builtins.
+const KernelTable *active_kernels = NULL;
+
+inline const KernelTable *Kernels() {
+  const KernelTable *table = __atomic_load_n(&active_kernels,
+                                             __ATOMIC_ACQUIRE);
+  if (!table) {
+    // Threads racing here detect the same table. Don't overwrite a table set
+    // by SetSlotKernels() in the meantime though.
+    table = DetectKernels();
+    const KernelTable *expected = NULL;
+    if (!__atomic_compare_exchange_n(&active_kernels, &expected, table, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      table = expected;
+    }
+  }
+  return table;
+}
+}  // namespace
+
+void SlotMax(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  Kernels()->slot_max(dst, src, length);
+}
+
+void SlotPriorityMerge(uint8_t *dst, uint8_t *dst_priorities,
+                       const uint8_t *src, const uint8_t *src_priorities,
+                       unsigned int length) {
+  Kernels()->priority_merge(dst, dst_priorities, src, src_priorities, length);
+}
+
+void SlotLerp(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+              unsigned int weight, unsigned int length) {
+  weight = std::min(weight, SLOT_LERP_MAX_WEIGHT);
+  Kernels()->lerp(dst, start, end, weight, length);
+}
+
+void SlotMaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                    unsigned int length) {
+  Kernels()->masked_copy(dst, src, mask, length);
+}
+
+bool SlotsEqual(const uint8_t *a, const uint8_t *b, unsigned int length) {
+  return Kernels()->slots_equal(a, b, length);
+}
+
+unsigned int FirstDifferingSlot(const uint8_t *a, const uint8_t *b,
+                                unsigned int length) {
+  return Kernels()->first_differing_slot(a, b, length);
+}
+
+unsigned int DifferingSlots(const uint8_t *a, const uint8_t *b,
+                            unsigned int length) {
+  return Kernels()->differing_slots(a, b, length);
+}
+
+unsigned int SlotRunLength(const uint8_t *data, unsigned int length) {
+  return Kernels()->run_length(data, length);
+}
+
+unsigned int FirstSlotRun(const uint8_t *data, unsigned int length) {
+  return Kernels()->first_run(data, length);
+}
+
+bool SlotKernelsSupported(SlotKernelImpl impl) {
+  return TableFor(impl) != NULL;
+}
+
+SlotKernelImpl ActiveSlotKernels() {
+  return Kernels()->impl;
+}
+
+bool SetSlotKernels(SlotKernelImpl impl) {
+  const KernelTable *table = TableFor(impl);
+  if (!table) {
+    return false;
+  }
+  __atomic_store_n(&active_kernels, table, __ATOMIC_RELEASE);
+  return true;
+}
+
+const char *SlotKernelName(SlotKernelImpl impl) {
+  switch (impl) {
+    case SLOT_KERNELS_SCALAR:
+      return "scalar";
+    case SLOT_KERNELS_SSE2:
+      return "sse2";
+    case SLOT_KERNELS_AVX2:
+      return "avx2";
+    case SLOT_KERNELS_NEON:
+      return "neon";
+    default:
+      return "unknown";
+  }
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,172 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SlotKernels.h
+ * Vectorized operations on blocks of DMX slot data.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_DMX_SLOTKERNELS_H_
+#define COMMON_DMX_SLOTKERNELS_H_
+
+#include <stdint.h>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief The implementations of the slot kernels.
+ */
+typedef enum {
+  SLOT_KERNELS_SCALAR,  /**< Plain C++ loops */
+  SLOT_KERNELS_SSE2,  /**< x86 SSE2 */
+  SLOT_KERNELS_AVX2,  /**< x86 AVX2 */
+  SLOT_KERNELS_NEON,  /**< ARM NEON */
+} SlotKernelImpl;
+
+/**
+ * @brief Element-wise max of two blocks of slot data.
+ * @param dst the data to merge into, dst[i] = max(dst[i], src[i])
+ * @param src the data to merge from
+ * @param length the number of slots to merge
+ */
+void SlotMax(uint8_t *dst, const uint8_t *src, unsigned int length);
+
+/**
+ * @brief Merge a block of slot data using a priority for each slot.
+ *
+ * For each slot, the source with the higher priority wins. If the priorities
+ * are the same the values are HTP merged. Slots with a priority of
+ * SLOT_PRIORITY_NOT_SOURCED are ignored.
+ * @param dst the data to merge into.
+ * @param dst_priorities the priorities of the data in dst, these are updated
+ *   with the priority of the winning source.
+ * @param src the data to merge from.
+ * @param src_priorities the priorities of the data in src.
+ * @param length the number of slots to merge.
+ */
+void SlotPriorityMerge(uint8_t *dst, uint8_t *dst_priorities,
+                       const uint8_t *src, const uint8_t *src_priorities,
+                       unsigned int length);
+
+/**
+ * @brief The largest weight that can be passed to SlotLerp().
+ */
+static const unsigned int SLOT_LERP_MAX_WEIGHT = 256;
+
+/**
+ * @brief Interpolate between two blocks of slot data.
+ *
+ * dst[i] = (start[i] * (256 - weight) + end[i] * weight + 128) / 256
+ * @param dst the block to write the result to, this may be start or end.
+ * @param start the data at a weight of 0.
+ * @param end the data at a weight of SLOT_LERP_MAX_WEIGHT.
+ * @param weight the position between start and end, from 0 to
+ *   SLOT_LERP_MAX_WEIGHT.
+ * @param length the number of slots to interpolate.
+ */
+void SlotLerp(uint8_t *dst, const uint8_t *start, const uint8_t *end,
+              unsigned int weight, unsigned int length);
+
+/**
+ * @brief Copy the slots selected by a mask from one block of data to another.
+ *
+ * dst[i] = (dst[i] & ~mask[i]) | (src[i] & mask[i])
+ * @param dst the data to copy into.
+ * @param src the data to copy from.
+ * @param mask 0xff for the slots to copy from src, 0 for the slots to leave.
+ * @param length the number of slots.
+ */
+void SlotMaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                    unsigned int length);
+
+/**
+ * @brief Check if two blocks of slot data are the same.
+ * @param a the first block of data
+ * @param b the second block of data
+ * @param length the number of slots to compare
+ * @returns true if the data matches, false otherwise.
+ */
+bool SlotsEqual(const uint8_t *a, const uint8_t *b, unsigned int length);
+
+/**
+ * @brief Find the first slot that differs between two blocks of data.
+ * @param a the first block of data
+ * @param b the second block of data
+ * @param length the number of slots to compare
+ * @returns the index of the first slot that differs, or length if the data
+ *   matches.
+ */
+unsigned int FirstDifferingSlot(const uint8_t *a, const uint8_t *b,
+                                unsigned int length);
+
+/**
+ * @brief Count the slots that differ between two blocks of data.
+ * @param a the first block of data
+ * @param b the second block of data
+ * @param length the number of slots to compare
+ * @returns the number of slots where a[i] != b[i].
+ */
+unsigned int DifferingSlots(const uint8_t *a, const uint8_t *b,
+                            unsigned int length);
+
+/**
+ * @brief Count the slots at the start of a block that match the first one.
+ * @param data the block of data
+ * @param length the number of slots to check
+ * @returns the length of the run at the start of data, 0 if length is 0.
+ */
+unsigned int SlotRunLength(const uint8_t *data, unsigned int length);
+
+/**
+ * @brief Find the first run of three or more identical slots.
+ * @param data the block of data
+ * @param length the number of slots to check
+ * @returns the index of the first slot of the run, or length if there isn't
+ *   one.
+ */
+unsigned int FirstSlotRun(const uint8_t *data, unsigned int length);
+
+/**
+ * @brief Check if an implementation can be used on this CPU.
+ */
+bool SlotKernelsSupported(SlotKernelImpl impl);
+
+/**
+ * @brief Return the implementation currently in use.
+ *
+ * The default is picked the first time the kernels are used, based on the
+ * features of the CPU we're running on.
+ */
+SlotKernelImpl ActiveSlotKernels();
+
+/**
+ * @brief Force a particular implementation.
+ *
+ * This is used by the tests & benchmarks. It's safe to call while other
+ * threads are using the kernels, calls already in progress finish with the
+ * previous implementation.
+ * @returns true if the implementation was selected, false if it isn't
+ *   supported on this CPU.
+ */
+bool SetSlotKernels(SlotKernelImpl impl);
+
+/**
+ * @brief Return the name of an implementation, e.g. "sse2".
+ */
+const char *SlotKernelName(SlotKernelImpl impl);
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_SLOTKERNELS_H_
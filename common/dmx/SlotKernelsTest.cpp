@@ -0,0 +1,457 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SlotKernelsTest.cpp
+ * Test fixture for the slot kernels.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#include "common/dmx/SlotKernels.h"
+#include "ola/Constants.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::dmx::DifferingSlots;
+using ola::dmx::FirstDifferingSlot;
+using ola::dmx::FirstSlotRun;
+using ola::dmx::SlotKernelImpl;
+using ola::dmx::SlotLerp;
+using ola::dmx::SlotMaskedCopy;
+using ola::dmx::SlotMax;
+using ola::dmx::SlotPriorityMerge;
+using ola::dmx::SlotRunLength;
+using ola::dmx::SlotsEqual;
+
+class SlotKernelsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SlotKernelsTest);
+  CPPUNIT_TEST(testMax);
+  CPPUNIT_TEST(testPriorityMerge);
+  CPPUNIT_TEST(testLerp);
+  CPPUNIT_TEST(testMaskedCopy);
+  CPPUNIT_TEST(testEqual);
+  CPPUNIT_TEST(testFirstDifference);
+  CPPUNIT_TEST(testDifferingSlots);
+  CPPUNIT_TEST(testRunLength);
+  CPPUNIT_TEST(testFirstRun);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void tearDown();
+    void testMax();
+    void testPriorityMerge();
+    void testLerp();
+    void testMaskedCopy();
+    void testEqual();
+    void testFirstDifference();
+    void testDifferingSlots();
+    void testRunLength();
+    void testFirstRun();
+
+ private:
+    // One extra slot so we can test unaligned access.
+    uint8_t m_a[ola::DMX_UNIVERSE_SIZE + 1];
+    uint8_t m_b[ola::DMX_UNIVERSE_SIZE + 1];
+    SlotKernelImpl m_original_impl;
+
+    void CheckMax(SlotKernelImpl impl);
+    void CheckPriorityMerge(SlotKernelImpl impl);
+    void CheckLerp(SlotKernelImpl impl);
+    void CheckMaskedCopy(SlotKernelImpl impl);
+    void CheckEqual(SlotKernelImpl impl);
+    void CheckFirstDifference(SlotKernelImpl impl);
+    void CheckDifferingSlots(SlotKernelImpl impl);
+    void CheckRunLength(SlotKernelImpl impl);
+    void CheckFirstRun(SlotKernelImpl impl);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SlotKernelsTest);
+
+static const SlotKernelImpl IMPLS[] = {
+  ola::dmx::SLOT_KERNELS_SCALAR,
+  ola::dmx::SLOT_KERNELS_SSE2,
+  ola::dmx::SLOT_KERNELS_AVX2,
+  ola::dmx::SLOT_KERNELS_NEON,
+};
+
+
+void SlotKernelsTest::setUp() {
+  m_original_impl = ola::dmx::ActiveSlotKernels();
+  for (unsigned int i = 0; i < sizeof(m_a); i++) {
+    m_a[i] = (i * 7) & 0xff;
+    m_b[i] = (i * 13 + 5) & 0xff;
+  }
+}
+
+
+void SlotKernelsTest::tearDown() {
+  ola::dmx::SetSlotKernels(m_original_impl);
+}
+
+
+/*
+ * Check the element-wise max works for all lengths & alignments.
+ */
+void SlotKernelsTest::testMax() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckMax(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check the priority merge works for all lengths & alignments.
+ */
+void SlotKernelsTest::testPriorityMerge() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckPriorityMerge(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check the interpolation works for all lengths, alignments & weights.
+ */
+void SlotKernelsTest::testLerp() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckLerp(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check the masked copy works for all lengths & alignments.
+ */
+void SlotKernelsTest::testMaskedCopy() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckMaskedCopy(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check the equality test works for all lengths & alignments.
+ */
+void SlotKernelsTest::testEqual() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckEqual(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check we find the first difference for all positions.
+ */
+void SlotKernelsTest::testFirstDifference() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckFirstDifference(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check we count the differing slots for all lengths.
+ */
+void SlotKernelsTest::testDifferingSlots() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckDifferingSlots(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check we find the end of a run for all positions.
+ */
+void SlotKernelsTest::testRunLength() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckRunLength(IMPLS[i]);
+    }
+  }
+}
+
+
+/*
+ * Check we find the start of a run for all positions.
+ */
+void SlotKernelsTest::testFirstRun() {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (ola::dmx::SetSlotKernels(IMPLS[i])) {
+      CheckFirstRun(IMPLS[i]);
+    }
+  }
+}
+
+
+void SlotKernelsTest::CheckMax(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+         length++) {
+      uint8_t dst[ola::DMX_UNIVERSE_SIZE + 1];
+      memcpy(dst, m_a, sizeof(dst));
+      SlotMax(dst + offset, m_b + offset, length);
+
+      for (unsigned int i = 0; i < sizeof(dst); i++) {
+        uint8_t expected = m_a[i];
+        if (i >= offset && i < offset + length) {
+          expected = std::max(m_a[i], m_b[i]);
+        }
+        OLA_ASSERT_EQ_MSG(expected, dst[i], name);
+      }
+    }
+  }
+}
+
+
+void SlotKernelsTest::CheckPriorityMerge(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  // The patterns repeat at different rates, so we get every combination of
+  // higher, lower, equal and unsourced slots.
+  uint8_t a_priorities[ola::DMX_UNIVERSE_SIZE + 1];
+  uint8_t b_priorities[ola::DMX_UNIVERSE_SIZE + 1];
+  for (unsigned int i = 0; i < sizeof(a_priorities); i++) {
+    a_priorities[i] = (i % 5) * 50;
+    b_priorities[i] = (i % 3) * 100;
+  }
+
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+         length++) {
+      uint8_t dst[ola::DMX_UNIVERSE_SIZE + 1];
+      uint8_t dst_priorities[ola::DMX_UNIVERSE_SIZE + 1];
+      memcpy(dst, m_a, sizeof(dst));
+      memcpy(dst_priorities, a_priorities, sizeof(dst_priorities));
+      SlotPriorityMerge(dst + offset, dst_priorities + offset, m_b + offset,
+                        b_priorities + offset, length);
+
+      for (unsigned int i = 0; i < sizeof(dst); i++) {
+        uint8_t expected = m_a[i];
+        uint8_t expected_priority = a_priorities[i];
+        if (i >= offset && i < offset + length) {
+          if (b_priorities[i] > a_priorities[i]) {
+            expected = m_b[i];
+            expected_priority = b_priorities[i];
+          } else if (b_priorities[i] == a_priorities[i] &&
+                     b_priorities[i] != 0) {
+            expected = std::max(m_a[i], m_b[i]);
+          }
+        }
+        OLA_ASSERT_EQ_MSG(expected, dst[i], name);
+        OLA_ASSERT_EQ_MSG(expected_priority, dst_priorities[i], name);
+      }
+    }
+  }
+}
+
+
+void SlotKernelsTest::CheckLerp(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  const unsigned int weights[] = {0, 1, 64, 127, 128, 200, 255, 256};
+  for (unsigned int w = 0; w < sizeof(weights) / sizeof(weights[0]); w++) {
+    const unsigned int weight = weights[w];
+    for (unsigned int offset = 0; offset < 2; offset++) {
+      for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+           length += 7) {
+        uint8_t dst[ola::DMX_UNIVERSE_SIZE + 1];
+        memset(dst, 0x55, sizeof(dst));
+        SlotLerp(dst + offset, m_a + offset, m_b + offset, weight, length);
+
+        for (unsigned int i = 0; i < sizeof(dst); i++) {
+          uint8_t expected = 0x55;
+          if (i >= offset && i < offset + length) {
+            expected = (m_a[i] * (256 - weight) + m_b[i] * weight + 128) / 256;
+          }
+          OLA_ASSERT_EQ_MSG(expected, dst[i], name);
+        }
+      }
+    }
+  }
+
+  // The result can be written over the start data.
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  memcpy(data, m_a, sizeof(data));
+  SlotLerp(data, data, m_b, ola::dmx::SLOT_LERP_MAX_WEIGHT, sizeof(data));
+  OLA_ASSERT_DATA_EQUALS(m_b, sizeof(data), data, sizeof(data));
+}
+
+
+void SlotKernelsTest::CheckMaskedCopy(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  uint8_t mask[ola::DMX_UNIVERSE_SIZE + 1];
+  for (unsigned int i = 0; i < sizeof(mask); i++) {
+    mask[i] = (i % 3 == 0 || (i / 40) % 2) ? 0xff : 0;
+  }
+
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+         length += 7) {
+      uint8_t dst[ola::DMX_UNIVERSE_SIZE + 1];
+      memcpy(dst, m_a, sizeof(dst));
+      SlotMaskedCopy(dst + offset, m_b + offset, mask + offset, length);
+
+      for (unsigned int i = 0; i < sizeof(dst); i++) {
+        uint8_t expected = m_a[i];
+        if (i >= offset && i < offset + length && mask[i]) {
+          expected = m_b[i];
+        }
+        OLA_ASSERT_EQ_MSG(expected, dst[i], name);
+      }
+    }
+  }
+}
+
+
+void SlotKernelsTest::CheckEqual(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  uint8_t copy[ola::DMX_UNIVERSE_SIZE + 1];
+  memcpy(copy, m_a, sizeof(copy));
+
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+         length++) {
+      OLA_ASSERT_TRUE_MSG(SlotsEqual(m_a + offset, copy + offset, length),
+                          name);
+    }
+  }
+
+  // change the last slot
+  copy[ola::DMX_UNIVERSE_SIZE]++;
+  OLA_ASSERT_FALSE_MSG(SlotsEqual(m_a + 1, copy + 1, ola::DMX_UNIVERSE_SIZE),
+                       name);
+  OLA_ASSERT_TRUE_MSG(SlotsEqual(m_a, copy, ola::DMX_UNIVERSE_SIZE), name);
+}
+
+
+void SlotKernelsTest::CheckFirstDifference(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  const unsigned int size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_EQ_MSG(size, FirstDifferingSlot(m_a, m_a, size), name);
+  OLA_ASSERT_EQ_MSG(0u, FirstDifferingSlot(m_a, m_a, 0), name);
+
+  uint8_t copy[ola::DMX_UNIVERSE_SIZE + 1];
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    for (unsigned int slot = 0; slot < size; slot++) {
+      memcpy(copy, m_a, sizeof(copy));
+      copy[offset + slot] ^= 0x80;
+      if (slot + 1 < size) {
+        // a second difference after the first shouldn't matter
+        copy[offset + size - 1] ^= 0x01;
+      }
+
+      OLA_ASSERT_EQ_MSG(slot,
+                        FirstDifferingSlot(m_a + offset, copy + offset, size),
+                        name);
+      OLA_ASSERT_EQ_MSG(slot,
+                        FirstDifferingSlot(m_a + offset, copy + offset,
+                                           slot + 1),
+                        name);
+      OLA_ASSERT_EQ_MSG(slot,
+                        FirstDifferingSlot(m_a + offset, copy + offset, slot),
+                        name);
+    }
+  }
+}
+
+
+void SlotKernelsTest::CheckDifferingSlots(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  const unsigned int size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_EQ_MSG(0u, DifferingSlots(m_a, m_a, size), name);
+  OLA_ASSERT_EQ_MSG(0u, DifferingSlots(m_a, m_b, 0), name);
+
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    unsigned int expected = 0;
+    for (unsigned int length = 0; length <= size; length++) {
+      OLA_ASSERT_EQ_MSG(expected,
+                        DifferingSlots(m_a + offset, m_b + offset, length),
+                        name);
+      if (length < size && m_a[offset + length] != m_b[offset + length]) {
+        expected++;
+      }
+    }
+  }
+
+  uint8_t copy[ola::DMX_UNIVERSE_SIZE + 1];
+  memcpy(copy, m_a, sizeof(copy));
+  copy[0] ^= 0x01;
+  copy[17] ^= 0x01;
+  copy[size - 1] ^= 0x01;
+  OLA_ASSERT_EQ_MSG(3u, DifferingSlots(m_a, copy, size), name);
+}
+
+
+void SlotKernelsTest::CheckRunLength(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  const unsigned int size = ola::DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_EQ_MSG(0u, SlotRunLength(m_a, 0), name);
+
+  uint8_t data[ola::DMX_UNIVERSE_SIZE + 1];
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    memset(data, 0x55, sizeof(data));
+    OLA_ASSERT_EQ_MSG(size, SlotRunLength(data + offset, size), name);
+
+    for (unsigned int run = 1; run < size; run++) {
+      memset(data, 0x55, sizeof(data));
+      data[offset + run] = 0xaa;
+      OLA_ASSERT_EQ_MSG(run, SlotRunLength(data + offset, size), name);
+      OLA_ASSERT_EQ_MSG(run, SlotRunLength(data + offset, run), name);
+    }
+  }
+}
+
+
+void SlotKernelsTest::CheckFirstRun(SlotKernelImpl impl) {
+  const std::string name = ola::dmx::SlotKernelName(impl);
+  const unsigned int size = ola::DMX_UNIVERSE_SIZE;
+
+  // m_a doesn't have any repeated slots.
+  OLA_ASSERT_EQ_MSG(size, FirstSlotRun(m_a, size), name);
+  OLA_ASSERT_EQ_MSG(0u, FirstSlotRun(m_a, 0), name);
+
+  uint8_t data[ola::DMX_UNIVERSE_SIZE + 1];
+  for (unsigned int offset = 0; offset < 2; offset++) {
+    for (unsigned int slot = 0; slot + 2 < size; slot++) {
+      memcpy(data, m_a, sizeof(data));
+      data[offset + slot + 1] = data[offset + slot];
+      data[offset + slot + 2] = data[offset + slot];
+
+      OLA_ASSERT_EQ_MSG(slot, FirstSlotRun(data + offset, size), name);
+      OLA_ASSERT_EQ_MSG(slot, FirstSlotRun(data + offset, slot + 3), name);
+      // a run that's cut off isn't a run
+      OLA_ASSERT_EQ_MSG(slot + 2, FirstSlotRun(data + offset, slot + 2),
+                        name);
+    }
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StreamFrame.cpp
+ * The datagrams used to stream DMX data to olad over UDP.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "common/dmx/StreamFrame.h"
+
+#include <string.h>
+
+namespace ola {
+namespace dmx {
+
+namespace {
+uint8_t *WriteUInt32(uint32_t value, uint8_t *ptr) {
+  *ptr++ = static_cast<uint8_t>(value >> 24);
+  *ptr++ = static_cast<uint8_t>(value >> 16);
+  *ptr++ = static_cast<uint8_t>(value >> 8);
+  *ptr++ = static_cast<uint8_t>(value);
+  return ptr;
+}
+
+uint32_t ReadUInt32(const uint8_t *ptr) {
+  return (static_cast<uint32_t>(ptr[0]) << 24) |
+         (static_cast<uint32_t>(ptr[1]) << 16) |
+         (static_cast<uint32_t>(ptr[2]) << 8) |
+         static_cast<uint32_t>(ptr[3]);
+}
+}  // namespace
+
+unsigned int StreamFrame::Pack(uint8_t *buffer, unsigned int size) const {
+  if (length > DMX_UNIVERSE_SIZE || size < HEADER_SIZE + length) {
+    return 0;
+  }
+
+  uint8_t *ptr = buffer;
+  *ptr++ = VERSION;
+  *ptr++ = priority;
+  *ptr++ = static_cast<uint8_t>(length >> 8);
+  *ptr++ = static_cast<uint8_t>(length);
+  ptr = WriteUInt32(static_cast<uint32_t>(token >> 32), ptr);
+  ptr = WriteUInt32(static_cast<uint32_t>(token), ptr);
+  ptr = WriteUInt32(universe, ptr);
+  ptr = WriteUInt32(sequence, ptr);
+  if (length) {
+    memcpy(ptr, data, length);
+  }
+  return HEADER_SIZE + length;
+}
+
+bool StreamFrame::Unpack(const uint8_t *buffer, unsigned int size) {
+  if (size < HEADER_SIZE || buffer[0] != VERSION) {
+    return false;
+  }
+
+  const unsigned int data_length = (buffer[2] << 8) | buffer[3];
+  if (data_length > DMX_UNIVERSE_SIZE ||
+      size != HEADER_SIZE + data_length) {
+    return false;
+  }
+
+  priority = buffer[1];
+  length = data_length;
+  token = (static_cast<uint64_t>(ReadUInt32(buffer + 4)) << 32) |
+          ReadUInt32(buffer + 8);
+  universe = ReadUInt32(buffer + 12);
+  sequence = ReadUInt32(buffer + 16);
+  data = buffer + HEADER_SIZE;
+  return true;
+}
+}  // namespace dmx
+}  // namespace ola
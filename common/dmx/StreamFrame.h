@@ -0,0 +1,102 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StreamFrame.h
+ * The datagrams used to stream DMX data to olad over UDP.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_DMX_STREAMFRAME_H_
+#define COMMON_DMX_STREAMFRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ola/Constants.h"
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A frame of DMX data sent to olad in a UDP datagram.
+ *
+ * A client is given a token by olad over the RPC channel, and then sends one
+ * datagram per universe frame, with the token. Each universe has its own
+ * sequence number, so olad can drop frames that arrive after a newer one.
+ *
+ * The datagram is laid out as follows, in network byte order:
+ *  - version, 1 byte.
+ *  - priority, 1 byte.
+ *  - the length of the DMX data, 2 bytes.
+ *  - token, 8 bytes.
+ *  - universe, 4 bytes.
+ *  - sequence, 4 bytes.
+ *  - the DMX data.
+ */
+class StreamFrame {
+ public:
+  enum { VERSION = 1 };
+  enum { HEADER_SIZE = 20 };
+  enum { MAX_SIZE = HEADER_SIZE + DMX_UNIVERSE_SIZE };
+
+  StreamFrame()
+      : token(0),
+        universe(0),
+        sequence(0),
+        priority(0),
+        length(0),
+        data(NULL) {
+  }
+
+  uint64_t token;
+  uint32_t universe;
+  uint32_t sequence;
+  uint8_t priority;
+  unsigned int length;
+  /**
+   * @brief The DMX data, this isn't owned by the frame.
+   */
+  const uint8_t *data;
+
+  /**
+   * @brief Write the frame into a buffer.
+   * @param buffer the buffer to write to.
+   * @param size the size of the buffer.
+   * @returns the size of the datagram, or 0 if the buffer is too small or the
+   *   frame has more than DMX_UNIVERSE_SIZE slots.
+   */
+  unsigned int Pack(uint8_t *buffer, unsigned int size) const;
+
+  /**
+   * @brief Read a frame from a datagram.
+   * @param buffer the datagram.
+   * @param size the size of the datagram.
+   * @returns false if the datagram isn't a valid frame. On success, data
+   *   points into buffer.
+   */
+  bool Unpack(const uint8_t *buffer, unsigned int size);
+
+  /**
+   * @brief Check if a sequence number is after another one, allowing for
+   *   wrap around.
+   * @param sequence the sequence number of a frame that just arrived.
+   * @param last_sequence the sequence number of the last frame accepted.
+   */
+  static bool IsNewer(uint32_t sequence, uint32_t last_sequence) {
+    return static_cast<int32_t>(sequence - last_sequence) > 0;
+  }
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_STREAMFRAME_H_
@@ -0,0 +1,135 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StreamFrameTest.cpp
+ * Test fixture for the StreamFrame class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+
+#include "common/dmx/StreamFrame.h"
+#include "ola/Constants.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::dmx::StreamFrame;
+
+class StreamFrameTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(StreamFrameTest);
+  CPPUNIT_TEST(testPackUnpack);
+  CPPUNIT_TEST(testInvalidFrames);
+  CPPUNIT_TEST(testSequence);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testPackUnpack();
+    void testInvalidFrames();
+    void testSequence();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StreamFrameTest);
+
+
+/*
+ * Check a frame survives the round trip.
+ */
+void StreamFrameTest::testPackUnpack() {
+  const uint8_t dmx[] = {0, 1, 2, 255};
+  StreamFrame frame;
+  frame.token = 0x0102030405060708ULL;
+  frame.universe = 0x10000;
+  frame.sequence = 42;
+  frame.priority = 120;
+  frame.length = sizeof(dmx);
+  frame.data = dmx;
+
+  uint8_t buffer[StreamFrame::MAX_SIZE];
+  const unsigned int size = frame.Pack(buffer, sizeof(buffer));
+  const uint8_t expected[] = {
+    1, 120, 0, 4,
+    1, 2, 3, 4, 5, 6, 7, 8,
+    0, 1, 0, 0,
+    0, 0, 0, 42,
+    0, 1, 2, 255
+  };
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), buffer, size);
+
+  StreamFrame output;
+  OLA_ASSERT_TRUE(output.Unpack(buffer, size));
+  OLA_ASSERT_EQ(frame.token, output.token);
+  OLA_ASSERT_EQ(frame.universe, output.universe);
+  OLA_ASSERT_EQ(frame.sequence, output.sequence);
+  OLA_ASSERT_EQ(frame.priority, output.priority);
+  OLA_ASSERT_DATA_EQUALS(dmx, sizeof(dmx), output.data, output.length);
+
+  // A full universe fits.
+  uint8_t full[ola::DMX_UNIVERSE_SIZE] = {0};
+  frame.length = sizeof(full);
+  frame.data = full;
+  OLA_ASSERT_EQ(static_cast<unsigned int>(StreamFrame::MAX_SIZE),
+                frame.Pack(buffer, sizeof(buffer)));
+  OLA_ASSERT_TRUE(output.Unpack(buffer, StreamFrame::MAX_SIZE));
+  OLA_ASSERT_EQ(static_cast<unsigned int>(ola::DMX_UNIVERSE_SIZE),
+                output.length);
+}
+
+
+/*
+ * Check invalid datagrams are rejected.
+ */
+void StreamFrameTest::testInvalidFrames() {
+  const uint8_t dmx[] = {1, 2, 3};
+  StreamFrame frame;
+  frame.token = 1;
+  frame.length = sizeof(dmx);
+  frame.data = dmx;
+
+  uint8_t buffer[StreamFrame::MAX_SIZE + 1];
+  // Too small to hold the frame.
+  OLA_ASSERT_EQ(0u, frame.Pack(buffer, StreamFrame::HEADER_SIZE + 2));
+  const unsigned int size = frame.Pack(buffer, sizeof(buffer));
+  OLA_ASSERT_EQ(StreamFrame::HEADER_SIZE + 3u, size);
+
+  StreamFrame output;
+  OLA_ASSERT_FALSE(output.Unpack(buffer, StreamFrame::HEADER_SIZE - 1));
+  // Truncated and padded datagrams.
+  OLA_ASSERT_FALSE(output.Unpack(buffer, size - 1));
+  OLA_ASSERT_FALSE(output.Unpack(buffer, size + 1));
+
+  buffer[0] = 2;
+  OLA_ASSERT_FALSE(output.Unpack(buffer, size));
+  buffer[0] = StreamFrame::VERSION;
+  OLA_ASSERT_TRUE(output.Unpack(buffer, size));
+
+  // More than a universe of data.
+  frame.length = ola::DMX_UNIVERSE_SIZE + 1;
+  OLA_ASSERT_EQ(0u, frame.Pack(buffer, sizeof(buffer)));
+}
+
+
+/*
+ * Check the sequence numbers wrap around.
+ */
+void StreamFrameTest::testSequence() {
+  OLA_ASSERT_TRUE(StreamFrame::IsNewer(2, 1));
+  OLA_ASSERT_FALSE(StreamFrame::IsNewer(1, 1));
+  OLA_ASSERT_FALSE(StreamFrame::IsNewer(1, 2));
+  OLA_ASSERT_TRUE(StreamFrame::IsNewer(0, 0xffffffff));
+  OLA_ASSERT_TRUE(StreamFrame::IsNewer(5, 0xfffffff0));
+  OLA_ASSERT_FALSE(StreamFrame::IsNewer(0xfffffff0, 5));
+}
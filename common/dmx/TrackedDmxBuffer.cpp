@@ -0,0 +1,240 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TrackedDmxBuffer.cpp
+ * A DmxBuffer that records which slots change.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "common/dmx/SlotKernels.h"
+#include "ola/Constants.h"
+#include "ola/dmx/TrackedDmxBuffer.h"
+
+namespace ola {
+namespace dmx {
+
+using std::max;
+using std::min;
+
+namespace {
+const unsigned int MAX_SLOTS = DMX_UNIVERSE_SIZE;
+}  // namespace
+
+const unsigned int TrackedDmxBuffer::HISTORY_SIZE;
+
+void SlotRange::Extend(const SlotRange &other) {
+  if (other.Empty()) {
+    return;
+  }
+  if (Empty()) {
+    *this = other;
+    return;
+  }
+  first = min(first, other.first);
+  end = max(end, other.end);
+}
+
+
+TrackedDmxBuffer::TrackedDmxBuffer()
+    : m_generation(0) {
+}
+
+
+TrackedDmxBuffer::TrackedDmxBuffer(const DmxBuffer &data)
+    : m_buffer(data),
+      m_generation(0) {
+}
+
+
+SlotRange TrackedDmxBuffer::ChangesSince(uint32_t generation) const {
+  // This handles the generation wrapping.
+  const uint32_t age = m_generation - generation;
+  if (age == 0) {
+    return SlotRange();
+  }
+  if (age > HISTORY_SIZE) {
+    return SlotRange(0, DMX_UNIVERSE_SIZE);
+  }
+
+  SlotRange range;
+  for (uint32_t i = 0; i < age; i++) {
+    range.Extend(m_history[(m_generation - i) % HISTORY_SIZE]);
+  }
+  return range;
+}
+
+
+bool TrackedDmxBuffer::Set(const DmxBuffer &data) {
+  const SlotRange range = DifferingRange(m_buffer.GetRaw(), Size(),
+                                         data.GetRaw(), data.Size());
+  if (!m_buffer.Set(data)) {
+    return false;
+  }
+  Record(range);
+  return true;
+}
+
+
+bool TrackedDmxBuffer::Set(const uint8_t *data, unsigned int length) {
+  if (!data) {
+    return false;
+  }
+  length = min(length, MAX_SLOTS);
+  const SlotRange range = DifferingRange(m_buffer.GetRaw(), Size(), data,
+                                         length);
+  if (!m_buffer.Set(data, length)) {
+    return false;
+  }
+  Record(range);
+  return true;
+}
+
+
+bool TrackedDmxBuffer::SetRange(unsigned int offset, const uint8_t *data,
+                                unsigned int length) {
+  const unsigned int old_size = Size();
+  const unsigned int end = offset + min(length, MAX_SLOTS);
+  uint8_t before[DMX_UNIVERSE_SIZE];
+  Snapshot(offset, end, before);
+  if (!m_buffer.SetRange(offset, data, length)) {
+    return false;
+  }
+  Compare(old_size, before, offset, end);
+  return true;
+}
+
+
+bool TrackedDmxBuffer::SetRangeToValue(unsigned int offset, uint8_t value,
+                                       unsigned int length) {
+  const unsigned int old_size = Size();
+  const unsigned int end = offset + min(length, MAX_SLOTS);
+  uint8_t before[DMX_UNIVERSE_SIZE];
+  Snapshot(offset, end, before);
+  if (!m_buffer.SetRangeToValue(offset, value, length)) {
+    return false;
+  }
+  Compare(old_size, before, offset, end);
+  return true;
+}
+
+
+void TrackedDmxBuffer::SetChannel(unsigned int channel, uint8_t data) {
+  const unsigned int old_size = Size();
+  uint8_t before[DMX_UNIVERSE_SIZE];
+  Snapshot(channel, channel + 1, before);
+  m_buffer.SetChannel(channel, data);
+  Compare(old_size, before, channel, channel + 1);
+}
+
+
+bool TrackedDmxBuffer::HTPMerge(const DmxBuffer &other) {
+  const unsigned int old_size = Size();
+  uint8_t before[DMX_UNIVERSE_SIZE];
+  Snapshot(0, DMX_UNIVERSE_SIZE, before);
+  if (!m_buffer.HTPMerge(other)) {
+    return false;
+  }
+  Compare(old_size, before, 0, DMX_UNIVERSE_SIZE);
+  return true;
+}
+
+
+bool TrackedDmxBuffer::Blackout() {
+  const unsigned int old_size = Size();
+  uint8_t before[DMX_UNIVERSE_SIZE];
+  Snapshot(0, DMX_UNIVERSE_SIZE, before);
+  if (!m_buffer.Blackout()) {
+    return false;
+  }
+  Compare(old_size, before, 0, DMX_UNIVERSE_SIZE);
+  return true;
+}
+
+
+void TrackedDmxBuffer::Reset() {
+  const unsigned int old_size = Size();
+  m_buffer.Reset();
+  Compare(old_size, NULL, 0, 0);
+}
+
+
+SlotRange TrackedDmxBuffer::DifferingRange(const uint8_t *a,
+                                           unsigned int a_length,
+                                           const uint8_t *b,
+                                           unsigned int b_length) {
+  const unsigned int common = min(a_length, b_length);
+  const unsigned int first = common ? FirstDifferingSlot(a, b, common) : 0;
+  unsigned int end = max(a_length, b_length);
+  if (end == common) {
+    if (first == common) {
+      return SlotRange();
+    }
+    while (end > first && a[end - 1] == b[end - 1]) {
+      end--;
+    }
+  }
+  return SlotRange(first, end);
+}
+
+
+/*
+ * Copy the slots between first and end, before they're changed.
+ */
+void TrackedDmxBuffer::Snapshot(unsigned int first, unsigned int end,
+                                uint8_t *data) const {
+  end = min(end, Size());
+  if (first < end) {
+    memcpy(data + first, m_buffer.GetRaw() + first, end - first);
+  }
+}
+
+
+/*
+ * Record the slots that changed after a write.
+ * @param old_size the size before the write.
+ * @param before the data from Snapshot().
+ * @param first the first slot the write could have changed.
+ * @param end the slot after the last one the write could have changed.
+ */
+void TrackedDmxBuffer::Compare(unsigned int old_size, const uint8_t *before,
+                               unsigned int first, unsigned int end) {
+  const unsigned int new_size = Size();
+  SlotRange range;
+  const unsigned int common_end = min(end, min(old_size, new_size));
+  if (first < common_end) {
+    range = DifferingRange(before + first, common_end - first,
+                           m_buffer.GetRaw() + first, common_end - first);
+    range.first += first;
+    range.end += first;
+  }
+  if (old_size != new_size) {
+    range.Extend(SlotRange(min(old_size, new_size), max(old_size, new_size)));
+  }
+  Record(range);
+}
+
+
+void TrackedDmxBuffer::Record(const SlotRange &range) {
+  if (range.Empty()) {
+    return;
+  }
+  m_generation++;
+  m_history[m_generation % HISTORY_SIZE] = range;
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,272 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TrackedDmxBufferTest.cpp
+ * Test fixture for the TrackedDmxBuffer class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/TrackedDmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::SlotRange;
+using ola::dmx::TrackedDmxBuffer;
+
+class TrackedDmxBufferTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TrackedDmxBufferTest);
+  CPPUNIT_TEST(testDifferingRange);
+  CPPUNIT_TEST(testSet);
+  CPPUNIT_TEST(testSetRange);
+  CPPUNIT_TEST(testSetChannel);
+  CPPUNIT_TEST(testHTPMerge);
+  CPPUNIT_TEST(testSizeChanges);
+  CPPUNIT_TEST(testHistory);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testDifferingRange();
+    void testSet();
+    void testSetRange();
+    void testSetChannel();
+    void testHTPMerge();
+    void testSizeChanges();
+    void testHistory();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TrackedDmxBufferTest);
+
+
+/*
+ * Check DifferingRange().
+ */
+void TrackedDmxBufferTest::testDifferingRange() {
+  const uint8_t a[] = {1, 2, 3, 4, 5, 6};
+  const uint8_t b[] = {1, 2, 9, 4, 9, 6};
+
+  OLA_ASSERT_TRUE(TrackedDmxBuffer::DifferingRange(a, 0, b, 0).Empty());
+  OLA_ASSERT_TRUE(TrackedDmxBuffer::DifferingRange(a, 2, b, 2).Empty());
+  OLA_ASSERT_TRUE(TrackedDmxBuffer::DifferingRange(a, 6, a, 6).Empty());
+  OLA_ASSERT_EQ(SlotRange(2, 5),
+                TrackedDmxBuffer::DifferingRange(a, 6, b, 6));
+  OLA_ASSERT_EQ(SlotRange(2, 3),
+                TrackedDmxBuffer::DifferingRange(a, 4, b, 4));
+
+  // different lengths
+  OLA_ASSERT_EQ(SlotRange(2, 6),
+                TrackedDmxBuffer::DifferingRange(a, 2, b, 6));
+  OLA_ASSERT_EQ(SlotRange(2, 6),
+                TrackedDmxBuffer::DifferingRange(a, 6, b, 3));
+  OLA_ASSERT_EQ(SlotRange(0, 6),
+                TrackedDmxBuffer::DifferingRange(NULL, 0, b, 6));
+}
+
+
+/*
+ * Check Set() only bumps the generation when the data changes.
+ */
+void TrackedDmxBufferTest::testSet() {
+  const uint8_t data[] = {1, 2, 3, 4, 5, 6};
+  const uint8_t other[] = {1, 2, 3, 7, 5, 6};
+
+  TrackedDmxBuffer buffer;
+  OLA_ASSERT_EQ(0u, buffer.Generation());
+  OLA_ASSERT_FALSE(buffer.ChangedSince(0));
+  OLA_ASSERT_TRUE(buffer.ChangesSince(0).Empty());
+
+  OLA_ASSERT_TRUE(buffer.Set(data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, buffer.Generation());
+  OLA_ASSERT_TRUE(buffer.ChangedSince(0));
+  OLA_ASSERT_EQ(SlotRange(0, 6), buffer.ChangesSince(0));
+  OLA_ASSERT_TRUE(buffer.ChangesSince(1).Empty());
+
+  // the same data doesn't count as a change
+  OLA_ASSERT_TRUE(buffer.Set(data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, buffer.Generation());
+  OLA_ASSERT_TRUE(buffer.Set(DmxBuffer(data, sizeof(data))));
+  OLA_ASSERT_EQ(1u, buffer.Generation());
+
+  OLA_ASSERT_TRUE(buffer.Set(DmxBuffer(other, sizeof(other))));
+  OLA_ASSERT_EQ(2u, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(3, 4), buffer.ChangesSince(1));
+  OLA_ASSERT_EQ(SlotRange(0, 6), buffer.ChangesSince(0));
+  OLA_ASSERT_TRUE(buffer.Buffer() == DmxBuffer(other, sizeof(other)));
+
+  OLA_ASSERT_FALSE(buffer.Set(NULL, 0));
+  OLA_ASSERT_EQ(2u, buffer.Generation());
+}
+
+
+/*
+ * Check SetRange(), SetRangeToValue() and Blackout().
+ */
+void TrackedDmxBufferTest::testSetRange() {
+  const uint8_t data[] = {10, 11, 12, 13};
+  const uint8_t update[] = {11, 99, 13};
+
+  TrackedDmxBuffer buffer;
+  OLA_ASSERT_TRUE(buffer.Set(data, sizeof(data)));
+  const uint32_t generation = buffer.Generation();
+
+  // only the middle slot actually changes
+  OLA_ASSERT_TRUE(buffer.SetRange(1, update, sizeof(update)));
+  OLA_ASSERT_EQ(generation + 1, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(2, 3), buffer.ChangesSince(generation));
+
+  // no change
+  OLA_ASSERT_TRUE(buffer.SetRange(1, update, sizeof(update)));
+  OLA_ASSERT_EQ(generation + 1, buffer.Generation());
+
+  // an invalid offset
+  OLA_ASSERT_FALSE(buffer.SetRange(10, update, sizeof(update)));
+  OLA_ASSERT_EQ(generation + 1, buffer.Generation());
+
+  OLA_ASSERT_TRUE(buffer.SetRangeToValue(0, 11, 2));
+  OLA_ASSERT_EQ(generation + 2, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(0, 1), buffer.ChangesSince(generation + 1));
+  OLA_ASSERT_EQ(SlotRange(0, 3), buffer.ChangesSince(generation));
+
+  // a blackout changes the size, so everything after slot 3 changes too
+  OLA_ASSERT_TRUE(buffer.Blackout());
+  OLA_ASSERT_EQ(generation + 3, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(0, ola::DMX_UNIVERSE_SIZE),
+                buffer.ChangesSince(generation + 2));
+  OLA_ASSERT_EQ(ola::DMX_UNIVERSE_SIZE, buffer.Size());
+
+  OLA_ASSERT_TRUE(buffer.Blackout());
+  OLA_ASSERT_EQ(generation + 3, buffer.Generation());
+}
+
+
+/*
+ * Check SetChannel().
+ */
+void TrackedDmxBufferTest::testSetChannel() {
+  TrackedDmxBuffer buffer;
+  OLA_ASSERT_TRUE(buffer.Blackout());
+  const uint32_t generation = buffer.Generation();
+
+  buffer.SetChannel(100, 0);
+  OLA_ASSERT_EQ(generation, buffer.Generation());
+
+  buffer.SetChannel(100, 255);
+  OLA_ASSERT_EQ(generation + 1, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(100, 101), buffer.ChangesSince(generation));
+
+  buffer.SetChannel(20, 255);
+  OLA_ASSERT_EQ(generation + 2, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(20, 21), buffer.ChangesSince(generation + 1));
+  OLA_ASSERT_EQ(SlotRange(20, 101), buffer.ChangesSince(generation));
+
+  // out of range
+  buffer.SetChannel(ola::DMX_UNIVERSE_SIZE, 255);
+  OLA_ASSERT_EQ(generation + 2, buffer.Generation());
+}
+
+
+/*
+ * Check HTPMerge().
+ */
+void TrackedDmxBufferTest::testHTPMerge() {
+  const uint8_t data[] = {10, 20, 30, 40};
+  const uint8_t merge[] = {5, 25, 30, 5};
+
+  TrackedDmxBuffer buffer;
+  OLA_ASSERT_TRUE(buffer.Set(data, sizeof(data)));
+  const uint32_t generation = buffer.Generation();
+
+  OLA_ASSERT_TRUE(buffer.HTPMerge(DmxBuffer(merge, sizeof(merge))));
+  OLA_ASSERT_EQ(generation + 1, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(1, 2), buffer.ChangesSince(generation));
+  OLA_ASSERT_EQ(25, buffer.Buffer().Get(1));
+
+  // merging again doesn't change anything
+  OLA_ASSERT_TRUE(buffer.HTPMerge(DmxBuffer(merge, sizeof(merge))));
+  OLA_ASSERT_EQ(generation + 1, buffer.Generation());
+
+  // a longer buffer extends the data
+  const uint8_t longer[] = {0, 0, 0, 0, 0, 7};
+  OLA_ASSERT_TRUE(buffer.HTPMerge(DmxBuffer(longer, sizeof(longer))));
+  OLA_ASSERT_EQ(generation + 2, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(4, 6), buffer.ChangesSince(generation + 1));
+}
+
+
+/*
+ * Check that changes in size are tracked.
+ */
+void TrackedDmxBufferTest::testSizeChanges() {
+  const uint8_t data[] = {1, 2, 3, 4, 5, 6};
+
+  TrackedDmxBuffer buffer(DmxBuffer(data, sizeof(data)));
+  OLA_ASSERT_EQ(0u, buffer.Generation());
+  OLA_ASSERT_EQ(6u, buffer.Size());
+
+  // shrink
+  OLA_ASSERT_TRUE(buffer.Set(data, 4));
+  OLA_ASSERT_EQ(1u, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(4, 6), buffer.ChangesSince(0));
+
+  // grow
+  OLA_ASSERT_TRUE(buffer.Set(data, sizeof(data)));
+  OLA_ASSERT_EQ(2u, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(4, 6), buffer.ChangesSince(1));
+
+  // SetRange past the end grows the buffer
+  const uint8_t tail[] = {6, 7, 8};
+  OLA_ASSERT_TRUE(buffer.SetRange(5, tail, sizeof(tail)));
+  OLA_ASSERT_EQ(3u, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(6, 8), buffer.ChangesSince(2));
+
+  buffer.Reset();
+  OLA_ASSERT_EQ(4u, buffer.Generation());
+  OLA_ASSERT_EQ(0u, buffer.Size());
+  OLA_ASSERT_EQ(SlotRange(0, 8), buffer.ChangesSince(3));
+
+  buffer.Reset();
+  OLA_ASSERT_EQ(4u, buffer.Generation());
+}
+
+
+/*
+ * Check that asking about generations older than the history returns
+ * everything.
+ */
+void TrackedDmxBufferTest::testHistory() {
+  TrackedDmxBuffer buffer;
+  OLA_ASSERT_TRUE(buffer.Blackout());
+  const uint32_t start = buffer.Generation();
+
+  for (unsigned int i = 0; i < TrackedDmxBuffer::HISTORY_SIZE; i++) {
+    buffer.SetChannel(i * 2, 1);
+  }
+  OLA_ASSERT_EQ(start + TrackedDmxBuffer::HISTORY_SIZE, buffer.Generation());
+  OLA_ASSERT_EQ(SlotRange(0, 2 * TrackedDmxBuffer::HISTORY_SIZE - 1),
+                buffer.ChangesSince(start));
+  OLA_ASSERT_EQ(SlotRange(2 * TrackedDmxBuffer::HISTORY_SIZE - 2,
+                          2 * TrackedDmxBuffer::HISTORY_SIZE - 1),
+                buffer.ChangesSince(buffer.Generation() - 1));
+
+  buffer.SetChannel(100, 1);
+  OLA_ASSERT_EQ(SlotRange(2, 101), buffer.ChangesSince(start + 1));
+  OLA_ASSERT_EQ(SlotRange(0, ola::DMX_UNIVERSE_SIZE),
+                buffer.ChangesSince(start));
+}
@@ -0,0 +1,144 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * run_length_benchmark.cpp
+ * Compare the run length encoder with each of the slot kernel implementations.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+
+#include "common/dmx/SlotKernels.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/dmx/RunLengthEncoder.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::RunLengthEncoder;
+using ola::dmx::SlotKernelImpl;
+using std::cout;
+using std::endl;
+
+DEFINE_s_uint32(iterations, i, 200000, "The number of iterations per test");
+
+// Stops the compiler from optimizing the loops away.
+static volatile unsigned int sink;
+
+/**
+ * The frames we test with.
+ */
+typedef enum {
+  FRAME_MOSTLY_ZERO,  // a few fixtures on, the rest of the universe dark
+  FRAME_RAMP,  // no repeated slots, e.g. a pixel gradient
+  FRAME_FULL,  // everything at full
+} FrameType;
+
+void BuildFrame(FrameType type, DmxBuffer *buffer) {
+  uint8_t frame[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    switch (type) {
+      case FRAME_MOSTLY_ZERO:
+        frame[i] = (i % 64 < 6) ? (i * 37) & 0xff : 0;
+        break;
+      case FRAME_RAMP:
+        frame[i] = i & 0xff;
+        break;
+      case FRAME_FULL:
+        frame[i] = 255;
+        break;
+    }
+  }
+  buffer->Set(frame, sizeof(frame));
+}
+
+/**
+ * Encode, or decode, a frame FLAGS_iterations times and return the time per
+ * frame in ns.
+ */
+double RunTest(FrameType type, bool decode) {
+  DmxBuffer frame;
+  BuildFrame(type, &frame);
+
+  RunLengthEncoder encoder;
+  // Encoding can expand the data by one byte every 127 slots.
+  uint8_t encoded[ola::DMX_UNIVERSE_SIZE + 8];
+  unsigned int encoded_size = sizeof(encoded);
+  encoder.Encode(frame, encoded, &encoded_size);
+
+  DmxBuffer output;
+  Clock clock;
+  TimeStamp start, end;
+  const unsigned int iterations = FLAGS_iterations;
+  unsigned int result = 0;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < iterations; i++) {
+    if (decode) {
+      encoder.Decode(0, encoded, encoded_size, &output);
+      result += output.Get(i % ola::DMX_UNIVERSE_SIZE);
+    } else {
+      unsigned int size = sizeof(encoded);
+      encoder.Encode(frame, encoded, &size);
+      result += size;
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+  sink = result;
+
+  TimeInterval duration = end - start;
+  return duration.AsInt() * 1000.0 / iterations;
+}
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark run length encoding of typical DMX frames.");
+
+  const SlotKernelImpl impls[] = {
+    ola::dmx::SLOT_KERNELS_SCALAR,
+    ola::dmx::SLOT_KERNELS_SSE2,
+    ola::dmx::SLOT_KERNELS_AVX2,
+    ola::dmx::SLOT_KERNELS_NEON,
+  };
+  const FrameType frames[] = {FRAME_MOSTLY_ZERO, FRAME_RAMP, FRAME_FULL};
+  const char *frame_names[] = {"zeros", "ramp", "full"};
+
+  cout << "Default implementation: "
+       << ola::dmx::SlotKernelName(ola::dmx::ActiveSlotKernels()) << endl;
+  cout << std::setw(8) << "kernel" << std::setw(8) << "frame"
+       << std::setw(14) << "encode (ns)" << std::setw(14) << "decode (ns)"
+       << endl;
+
+  for (unsigned int i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+    if (!ola::dmx::SetSlotKernels(impls[i])) {
+      continue;
+    }
+    for (unsigned int j = 0; j < sizeof(frames) / sizeof(frames[0]); j++) {
+      cout << std::setw(8) << ola::dmx::SlotKernelName(impls[i])
+           << std::setw(8) << frame_names[j]
+           << std::fixed << std::setprecision(1)
+           << std::setw(14) << RunTest(frames[j], false)
+           << std::setw(14) << RunTest(frames[j], true) << endl;
+    }
+  }
+  return 0;
+}
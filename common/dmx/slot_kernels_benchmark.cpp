@@ -0,0 +1,121 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * slot_kernels_benchmark.cpp
+ * Compare the performance of the slot kernel implementations.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <iomanip>
+#include <iostream>
+
+#include "common/dmx/SlotKernels.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::SlotKernelImpl;
+using std::cout;
+using std::endl;
+
+DEFINE_s_uint32(iterations, i, 1000000, "The number of iterations per test");
+
+typedef enum {
+  TEST_MAX,
+  TEST_EQUAL,
+  TEST_FIRST_DIFFERENCE,
+} TestType;
+
+// Stops the compiler from optimizing the loops away.
+static volatile unsigned int sink;
+
+/**
+ * Run a kernel FLAGS_iterations times and return the time per call in ns.
+ */
+double RunTest(TestType type) {
+  uint8_t a[ola::DMX_UNIVERSE_SIZE];
+  uint8_t b[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    a[i] = i & 0xff;
+    b[i] = 255 - a[i];
+  }
+
+  // Put the difference at the end, since that's the worst case.
+  uint8_t c[ola::DMX_UNIVERSE_SIZE];
+  memcpy(c, a, sizeof(c));
+  c[ola::DMX_UNIVERSE_SIZE - 1]++;
+
+  Clock clock;
+  TimeStamp start, end;
+  const unsigned int iterations = FLAGS_iterations;
+  unsigned int result = 0;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < iterations; i++) {
+    switch (type) {
+      case TEST_MAX:
+        ola::dmx::SlotMax(a, b, ola::DMX_UNIVERSE_SIZE);
+        result += a[i % ola::DMX_UNIVERSE_SIZE];
+        break;
+      case TEST_EQUAL:
+        result += ola::dmx::SlotsEqual(a, c, ola::DMX_UNIVERSE_SIZE);
+        break;
+      case TEST_FIRST_DIFFERENCE:
+        result += ola::dmx::FirstDifferingSlot(a, c, ola::DMX_UNIVERSE_SIZE);
+        break;
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+  sink = result;
+
+  TimeInterval duration = end - start;
+  return duration.AsInt() * 1000.0 / iterations;
+}
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark the DMX slot kernels on this CPU.");
+
+  const SlotKernelImpl impls[] = {
+    ola::dmx::SLOT_KERNELS_SCALAR,
+    ola::dmx::SLOT_KERNELS_SSE2,
+    ola::dmx::SLOT_KERNELS_AVX2,
+    ola::dmx::SLOT_KERNELS_NEON,
+  };
+
+  cout << "Default implementation: "
+       << ola::dmx::SlotKernelName(ola::dmx::ActiveSlotKernels()) << endl;
+  cout << std::setw(8) << "kernel" << std::setw(12) << "max (ns)"
+       << std::setw(12) << "equal (ns)" << std::setw(12) << "diff (ns)"
+       << endl;
+
+  for (unsigned int i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+    if (!ola::dmx::SetSlotKernels(impls[i])) {
+      continue;
+    }
+    cout << std::setw(8) << ola::dmx::SlotKernelName(impls[i])
+         << std::fixed << std::setprecision(1)
+         << std::setw(12) << RunTest(TEST_MAX)
+         << std::setw(12) << RunTest(TEST_EQUAL)
+         << std::setw(12) << RunTest(TEST_FIRST_DIFFERENCE) << endl;
+  }
+  return 0;
+}
@@ -21,10 +21,12 @@
 #include <algorithm>
 #include <string>
 #include <map>
+#include <utility>
 #include <vector>
 #include <iostream>
 #include "ola/ExportMap.h"
 #include "ola/StringUtils.h"
+#include "ola/base/Array.h"
 #include "ola/stl/STLUtils.h"
 
 namespace ola {
@@ -34,6 +36,294 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
+using ola::dmx::ReceiveStats;
+using ola::thread::MutexLocker;
+
+namespace {
+
+unsigned int next_shard = 0;
+__thread unsigned int thread_shard = 0;
+__thread bool thread_shard_assigned = false;
+
+/*
+ * Threads are assigned shards in turn the first time they use a counter.
+ */
+unsigned int ShardIndex() {
+  if (!thread_shard_assigned) {
+    thread_shard = __atomic_fetch_add(&next_shard, 1, __ATOMIC_RELAXED) %
+                   ShardedCounter::SHARDS;
+    thread_shard_assigned = true;
+  }
+  return thread_shard;
+}
+
+/*
+ * Convert a string into something that can be used as a metric or label name.
+ */
+string SanitizeName(const string &name) {
+  string output(name);
+  for (string::iterator iter = output.begin(); iter != output.end(); ++iter) {
+    char c = *iter;
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9') || c == '_')) {
+      *iter = '_';
+    }
+  }
+  return output;
+}
+
+string MetricName(const string &name) {
+  return "ola_" + SanitizeName(name);
+}
+
+string LabelName(const string &label) {
+  if (label.empty()) {
+    return "key";
+  }
+  string output = SanitizeName(label);
+  if (output[0] >= '0' && output[0] <= '9') {
+    output.insert(0, "_");
+  }
+  return output;
+}
+
+string EscapeLabelValue(const string &value) {
+  string output;
+  output.reserve(value.size());
+  for (string::const_iterator iter = value.begin(); iter != value.end();
+       ++iter) {
+    if (*iter == '\\') {
+      output.append("\\\\");
+    } else if (*iter == '"') {
+      output.append("\\\"");
+    } else if (*iter == '\n') {
+      output.append("\\n");
+    } else {
+      output.push_back(*iter);
+    }
+  }
+  return output;
+}
+
+void WriteType(std::ostream *output, const string &metric,
+               const string &type) {
+  *output << "# TYPE " << metric << " " << type << "\n";
+}
+
+template<typename Type>
+void WriteMapMetrics(std::ostream *output, const string &type,
+                     const map<string, Type*> &variables) {
+  typename map<string, Type*>::const_iterator iter = variables.begin();
+  for (; iter != variables.end(); ++iter) {
+    const string metric = MetricName(iter->first);
+    const string label = LabelName(iter->second->Label());
+    WriteType(output, metric, type);
+    typename Type::const_iterator value_iter = iter->second->Begin();
+    for (; value_iter != iter->second->End(); ++value_iter) {
+      *output << metric << "{" << label << "=\""
+              << EscapeLabelValue(value_iter->first) << "\"} "
+              << value_iter->second << "\n";
+    }
+  }
+}
+}  // namespace
+
+
+ShardedCounter::ShardedCounter(const string &name)
+    : BaseVariable(name) {
+  for (unsigned int i = 0; i < SHARDS; i++) {
+    m_shards[i].value = 0;
+  }
+}
+
+
+void ShardedCounter::Add(uint64_t value) {
+  __atomic_add_fetch(&m_shards[ShardIndex()].value, value, __ATOMIC_RELAXED);
+}
+
+
+uint64_t ShardedCounter::Get() const {
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < SHARDS; i++) {
+    total += __atomic_load_n(&m_shards[i].value, __ATOMIC_RELAXED);
+  }
+  return total;
+}
+
+
+void ShardedCounter::Reset() {
+  for (unsigned int i = 0; i < SHARDS; i++) {
+    __atomic_store_n(&m_shards[i].value, 0, __ATOMIC_RELAXED);
+  }
+}
+
+
+const string ShardedCounter::Value() const {
+  ostringstream out;
+  out << Get();
+  return out.str();
+}
+
+
+ShardedCounterMap::~ShardedCounterMap() {
+  STLDeleteValues(&m_counters);
+}
+
+
+ShardedCounter *ShardedCounterMap::Get(const string &key) {
+  MutexLocker locker(&m_mutex);
+  CounterMap::iterator iter = m_counters.find(key);
+  if (iter == m_counters.end()) {
+    iter = m_counters.insert(
+        CounterMap::value_type(key, new ShardedCounter(key))).first;
+  }
+  return iter->second;
+}
+
+
+void ShardedCounterMap::Snapshot(
+    vector<std::pair<string, uint64_t> > *values) const {
+  MutexLocker locker(&m_mutex);
+  CounterMap::const_iterator iter = m_counters.begin();
+  for (; iter != m_counters.end(); ++iter) {
+    values->push_back(std::make_pair(iter->first, iter->second->Get()));
+  }
+}
+
+
+/*
+ * The form is:
+ *   var_name  map:label key1:value1 key2:value2
+ */
+const string ShardedCounterMap::Value() const {
+  vector<std::pair<string, uint64_t> > values;
+  Snapshot(&values);
+
+  ostringstream value;
+  value << "map:" << m_label;
+  vector<std::pair<string, uint64_t> >::const_iterator iter;
+  for (iter = values.begin(); iter != values.end(); ++iter) {
+    value << " " << iter->first << ":" << iter->second;
+  }
+  return value.str();
+}
+
+
+Histogram::Histogram(const string &name, const vector<uint64_t> &bounds)
+    : BaseVariable(name),
+      m_bounds(bounds),
+      m_counts(bounds.size() + 1, 0),
+      m_sum(0) {
+}
+
+
+void Histogram::Record(uint64_t value) {
+  size_t bucket = std::lower_bound(m_bounds.begin(), m_bounds.end(), value) -
+                  m_bounds.begin();
+  __atomic_add_fetch(&m_counts[bucket], 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&m_sum, value, __ATOMIC_RELAXED);
+}
+
+
+void Histogram::Buckets(vector<uint64_t> *counts) const {
+  counts->reserve(m_counts.size());
+  for (unsigned int i = 0; i < m_counts.size(); i++) {
+    counts->push_back(__atomic_load_n(&m_counts[i], __ATOMIC_RELAXED));
+  }
+}
+
+
+uint64_t Histogram::Count() const {
+  uint64_t count = 0;
+  for (unsigned int i = 0; i < m_counts.size(); i++) {
+    count += __atomic_load_n(&m_counts[i], __ATOMIC_RELAXED);
+  }
+  return count;
+}
+
+
+uint64_t Histogram::Sum() const {
+  return __atomic_load_n(&m_sum, __ATOMIC_RELAXED);
+}
+
+
+void Histogram::Reset() {
+  for (unsigned int i = 0; i < m_counts.size(); i++) {
+    __atomic_store_n(&m_counts[i], 0, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&m_sum, 0, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * The form is:
+ *   var_name  count=3 sum=250 le_100:2 le_200:1 le_inf:0
+ */
+const string Histogram::Value() const {
+  vector<uint64_t> counts;
+  Buckets(&counts);
+
+  ostringstream value;
+  value << "count=" << Count() << " sum=" << Sum();
+  for (unsigned int i = 0; i < m_bounds.size(); i++) {
+    value << " le_" << m_bounds[i] << ":" << counts[i];
+  }
+  value << " le_inf:" << counts.back();
+  return value.str();
+}
+
+
+vector<uint64_t> Histogram::DefaultLatencyBounds() {
+  static const uint64_t bounds[] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+    250000, 500000, 1000000
+  };
+  return vector<uint64_t>(bounds, bounds + arraysize(bounds));
+}
+
+ReceiveStats *ReceiveStatsMap::Get(const string &key) {
+  MutexLocker locker(&m_mutex);
+  return &m_stats[key];
+}
+
+
+void ReceiveStatsMap::Remove(const string &key) {
+  MutexLocker locker(&m_mutex);
+  m_stats.erase(key);
+}
+
+
+void ReceiveStatsMap::Snapshot(
+    vector<std::pair<string, ReceiveStats> > *stats) const {
+  MutexLocker locker(&m_mutex);
+  StatsMap::const_iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    stats->push_back(*iter);
+  }
+}
+
+
+/*
+ * The form is:
+ *   var_name  map:label key1:"packets=1 gaps=0 out_of_order=0 jitter_us=0"
+ */
+const string ReceiveStatsMap::Value() const {
+  vector<std::pair<string, ReceiveStats> > stats;
+  Snapshot(&stats);
+
+  ostringstream value;
+  value << "map:" << m_label;
+  vector<std::pair<string, ReceiveStats> >::const_iterator iter;
+  for (iter = stats.begin(); iter != stats.end(); ++iter) {
+    value << " " << iter->first << ":\"packets=" << iter->second.Packets()
+          << " gaps=" << iter->second.SequenceGaps()
+          << " out_of_order=" << iter->second.OutOfOrder()
+          << " jitter_us=" << iter->second.JitterMicroSeconds() << "\"";
+  }
+  return value.str();
+}
+
+
 ExportMap::~ExportMap() {
   STLDeleteValues(&m_bool_variables);
   STLDeleteValues(&m_counter_variables);
@@ -42,6 +332,10 @@ ExportMap::~ExportMap() {
   STLDeleteValues(&m_str_map_variables);
   STLDeleteValues(&m_string_variables);
   STLDeleteValues(&m_uint_map_variables);
+  STLDeleteValues(&m_receive_stats_variables);
+  STLDeleteValues(&m_sharded_counter_variables);
+  STLDeleteValues(&m_sharded_counter_map_variables);
+  STLDeleteValues(&m_histogram_variables);
 }
 
 BoolVariable *ExportMap::GetBoolVar(const string &name) {
@@ -94,11 +388,72 @@ UIntMap *ExportMap::GetUIntMapVar(const string &name, const string &label) {
 }
 
 
+/*
+ * Lookup or create a receive stats variable
+ * @param name the name of the variable
+ * @param label the label to use for the keys (optional)
+ * @return a ReceiveStatsMap
+ */
+ReceiveStatsMap *ExportMap::GetReceiveStatsMapVar(const string &name,
+                                                  const string &label) {
+  return GetMapVar(&m_receive_stats_variables, name, label);
+}
+
+
+/*
+ * Lookup or create a sharded counter
+ * @param name the name of the variable
+ * @return a ShardedCounter
+ */
+ShardedCounter *ExportMap::GetShardedCounterVar(const string &name) {
+  return GetVar(&m_sharded_counter_variables, name);
+}
+
+
+/*
+ * Lookup or create a map of sharded counters
+ * @param name the name of the variable
+ * @param label the label to use for the keys (optional)
+ * @return a ShardedCounterMap
+ */
+ShardedCounterMap *ExportMap::GetShardedCounterMapVar(const string &name,
+                                                      const string &label) {
+  return GetMapVar(&m_sharded_counter_map_variables, name, label);
+}
+
+
+Histogram *ExportMap::GetHistogramVar(const string &name) {
+  return GetHistogramVar(name, Histogram::DefaultLatencyBounds());
+}
+
+
+Histogram *ExportMap::GetHistogramVar(const string &name,
+                                      const vector<uint64_t> &bounds) {
+  MutexLocker locker(&m_variables_mutex);
+  map<string, Histogram*>::iterator iter = m_histogram_variables.find(name);
+  if (iter == m_histogram_variables.end()) {
+    Histogram *var = new Histogram(name, bounds);
+    m_histogram_variables[name] = var;
+    return var;
+  }
+  return iter->second;
+}
+
+
+vector<ReceiveStatsMap*> ExportMap::ReceiveStatsVariables() const {
+  MutexLocker locker(&m_variables_mutex);
+  vector<ReceiveStatsMap*> variables;
+  STLValues(m_receive_stats_variables, &variables);
+  return variables;
+}
+
+
 /*
  * Return a list of all variables.
  * @return a vector of all variables.
  */
 vector<BaseVariable*> ExportMap::AllVariables() const {
+  MutexLocker locker(&m_variables_mutex);
   vector<BaseVariable*> variables;
   STLValues(m_bool_variables, &variables);
   STLValues(m_counter_variables, &variables);
@@ -107,14 +462,135 @@ vector<BaseVariable*> ExportMap::AllVariables() const {
   STLValues(m_str_map_variables, &variables);
   STLValues(m_string_variables, &variables);
   STLValues(m_uint_map_variables, &variables);
+  STLValues(m_receive_stats_variables, &variables);
+  STLValues(m_sharded_counter_variables, &variables);
+  STLValues(m_sharded_counter_map_variables, &variables);
+  STLValues(m_histogram_variables, &variables);
 
   sort(variables.begin(), variables.end(), VariableLessThan());
   return variables;
 }
 
 
+void ExportMap::WriteMetrics(std::ostream *output) const {
+  MutexLocker locker(&m_variables_mutex);
+  map<string, BoolVariable*>::const_iterator bool_iter =
+      m_bool_variables.begin();
+  for (; bool_iter != m_bool_variables.end(); ++bool_iter) {
+    const string metric = MetricName(bool_iter->first);
+    WriteType(output, metric, "gauge");
+    *output << metric << " " << bool_iter->second->Value() << "\n";
+  }
+
+  map<string, IntegerVariable*>::const_iterator int_iter =
+      m_int_variables.begin();
+  for (; int_iter != m_int_variables.end(); ++int_iter) {
+    const string metric = MetricName(int_iter->first);
+    WriteType(output, metric, "gauge");
+    *output << metric << " " << int_iter->second->Get() << "\n";
+  }
+
+  map<string, CounterVariable*>::const_iterator counter_iter =
+      m_counter_variables.begin();
+  for (; counter_iter != m_counter_variables.end(); ++counter_iter) {
+    const string metric = MetricName(counter_iter->first);
+    WriteType(output, metric, "counter");
+    *output << metric << " " << counter_iter->second->Get() << "\n";
+  }
+
+  map<string, ShardedCounter*>::const_iterator sharded_iter =
+      m_sharded_counter_variables.begin();
+  for (; sharded_iter != m_sharded_counter_variables.end(); ++sharded_iter) {
+    const string metric = MetricName(sharded_iter->first);
+    WriteType(output, metric, "counter");
+    *output << metric << " " << sharded_iter->second->Get() << "\n";
+  }
+
+  // The int maps hold a mix of counts and levels, so they're exported as
+  // gauges.
+  WriteMapMetrics(output, "gauge", m_int_map_variables);
+  WriteMapMetrics(output, "gauge", m_uint_map_variables);
+
+  map<string, ShardedCounterMap*>::const_iterator sharded_map_iter =
+      m_sharded_counter_map_variables.begin();
+  for (; sharded_map_iter != m_sharded_counter_map_variables.end();
+       ++sharded_map_iter) {
+    const string metric = MetricName(sharded_map_iter->first);
+    const string label = LabelName(sharded_map_iter->second->Label());
+    vector<std::pair<string, uint64_t> > values;
+    sharded_map_iter->second->Snapshot(&values);
+
+    WriteType(output, metric, "counter");
+    vector<std::pair<string, uint64_t> >::const_iterator iter;
+    for (iter = values.begin(); iter != values.end(); ++iter) {
+      *output << metric << "{" << label << "=\""
+              << EscapeLabelValue(iter->first) << "\"} " << iter->second
+              << "\n";
+    }
+  }
+
+  map<string, ReceiveStatsMap*>::const_iterator stats_iter =
+      m_receive_stats_variables.begin();
+  for (; stats_iter != m_receive_stats_variables.end(); ++stats_iter) {
+    const string metric = MetricName(stats_iter->first);
+    const string label = LabelName(stats_iter->second->Label());
+    vector<std::pair<string, ReceiveStats> > stats;
+    stats_iter->second->Snapshot(&stats);
+
+    static const char *const suffixes[] = {
+      "_packets", "_sequence_gaps", "_out_of_order", "_jitter_us"
+    };
+    for (unsigned int i = 0; i < arraysize(suffixes); i++) {
+      WriteType(output, metric + suffixes[i], i == 3 ? "gauge" : "counter");
+      vector<std::pair<string, ReceiveStats> >::const_iterator iter;
+      for (iter = stats.begin(); iter != stats.end(); ++iter) {
+        uint32_t value = 0;
+        switch (i) {
+          case 0:
+            value = iter->second.Packets();
+            break;
+          case 1:
+            value = iter->second.SequenceGaps();
+            break;
+          case 2:
+            value = iter->second.OutOfOrder();
+            break;
+          default:
+            value = iter->second.JitterMicroSeconds();
+        }
+        *output << metric << suffixes[i] << "{" << label << "=\""
+                << EscapeLabelValue(iter->first) << "\"} " << value << "\n";
+      }
+    }
+  }
+
+  map<string, Histogram*>::const_iterator histogram_iter =
+      m_histogram_variables.begin();
+  for (; histogram_iter != m_histogram_variables.end(); ++histogram_iter) {
+    const string metric = MetricName(histogram_iter->first);
+    const Histogram *histogram = histogram_iter->second;
+    vector<uint64_t> counts;
+    histogram->Buckets(&counts);
+
+    // Prometheus buckets are cumulative.
+    WriteType(output, metric, "histogram");
+    uint64_t total = 0;
+    for (unsigned int i = 0; i < histogram->Bounds().size(); i++) {
+      total += counts[i];
+      *output << metric << "_bucket{le=\"" << histogram->Bounds()[i] << "\"} "
+              << total << "\n";
+    }
+    total += counts.back();
+    *output << metric << "_bucket{le=\"+Inf\"} " << total << "\n";
+    *output << metric << "_sum " << histogram->Sum() << "\n";
+    *output << metric << "_count " << total << "\n";
+  }
+}
+
+
 template<typename Type>
 Type *ExportMap::GetVar(map<string, Type*> *var_map, const string &name) {
+  MutexLocker locker(&m_variables_mutex);
   typename map<string, Type*>::iterator iter;
   iter = var_map->find(name);
 
@@ -131,6 +607,7 @@ template<typename Type>
 Type *ExportMap::GetMapVar(map<string, Type*> *var_map,
                            const string &name,
                            const string &label) {
+  MutexLocker locker(&m_variables_mutex);
   typename map<string, Type*>::iterator iter;
   iter = var_map->find(name);
 
@@ -19,18 +19,29 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "ola/Clock.h"
 #include "ola/ExportMap.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
 
 using ola::BaseVariable;
 using ola::BoolVariable;
 using ola::CounterVariable;
 using ola::ExportMap;
+using ola::Histogram;
 using ola::IntMap;
 using ola::IntegerVariable;
+using ola::ReceiveStatsMap;
+using ola::ShardedCounter;
+using ola::ShardedCounterMap;
+using ola::TimeStamp;
+using ola::dmx::ReceiveStats;
 using ola::StringMap;
 using ola::StringVariable;
 using std::string;
@@ -45,7 +56,12 @@ class ExportMapTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testBoolVariable);
   CPPUNIT_TEST(testStringMapVariable);
   CPPUNIT_TEST(testIntMapVariable);
+  CPPUNIT_TEST(testReceiveStatsMap);
+  CPPUNIT_TEST(testShardedCounter);
+  CPPUNIT_TEST(testShardedCounterMap);
+  CPPUNIT_TEST(testHistogram);
   CPPUNIT_TEST(testExportMap);
+  CPPUNIT_TEST(testWriteMetrics);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -55,10 +71,42 @@ class ExportMapTest: public CppUnit::TestFixture {
     void testBoolVariable();
     void testStringMapVariable();
     void testIntMapVariable();
+    void testReceiveStatsMap();
+    void testShardedCounter();
+    void testShardedCounterMap();
+    void testHistogram();
     void testExportMap();
+    void testWriteMetrics();
 };
 
 
+namespace {
+/*
+ * Increments a counter from another thread.
+ */
+class IncrementThread: public ola::thread::Thread {
+ public:
+  IncrementThread(ShardedCounter *counter, unsigned int count)
+      : Thread(),
+        m_counter(counter),
+        m_count(count) {
+  }
+
+ protected:
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      m_counter->Increment();
+    }
+    return NULL;
+  }
+
+ private:
+  ShardedCounter *m_counter;
+  const unsigned int m_count;
+};
+}  // namespace
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(ExportMapTest);
 
 
@@ -213,6 +261,123 @@ void ExportMapTest::testIntMapVariable() {
   OLA_ASSERT_EQ(var.Value(), string("map:count key1:1"));
 }
 
+/*
+ * Check that the ReceiveStatsMap works correctly.
+ */
+void ExportMapTest::testReceiveStatsMap() {
+  ReceiveStatsMap var("stats", "universe");
+  OLA_ASSERT_EQ(string("map:universe"), var.Value());
+
+  ReceiveStats *stats = var.Get("1");
+  OLA_ASSERT_EQ(stats, var.Get("1"));
+  var.Get("2");
+  TimeStamp now;
+  stats->PacketReceived(now, 0);
+  stats->PacketReceived(now, 3);
+  OLA_ASSERT_EQ(
+      string("map:universe 1:\"packets=2 gaps=3 out_of_order=0 jitter_us=0\" "
+             "2:\"packets=0 gaps=0 out_of_order=0 jitter_us=0\""),
+      var.Value());
+
+  vector<std::pair<string, ReceiveStats> > snapshot;
+  var.Snapshot(&snapshot);
+  OLA_ASSERT_EQ((size_t) 2, snapshot.size());
+  OLA_ASSERT_EQ(string("1"), snapshot[0].first);
+  OLA_ASSERT_EQ(2u, snapshot[0].second.Packets());
+
+  var.Remove("1");
+  var.Remove("3");
+  snapshot.clear();
+  var.Snapshot(&snapshot);
+  OLA_ASSERT_EQ((size_t) 1, snapshot.size());
+  OLA_ASSERT_EQ(string("2"), snapshot[0].first);
+}
+
+/*
+ * Check the ShardedCounter works correctly.
+ */
+void ExportMapTest::testShardedCounter() {
+  ShardedCounter var("foo");
+  OLA_ASSERT_EQ(string("foo"), var.Name());
+  OLA_ASSERT_EQ(string("0"), var.Value());
+
+  var.Increment();
+  var.Add(9);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), var.Get());
+  OLA_ASSERT_EQ(string("10"), var.Value());
+  var.Reset();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), var.Get());
+
+  // Increments from many threads are all counted.
+  vector<IncrementThread*> threads;
+  for (unsigned int i = 0; i < 4; i++) {
+    threads.push_back(new IncrementThread(&var, 10000));
+    OLA_ASSERT_TRUE(threads.back()->Start());
+  }
+  vector<IncrementThread*>::iterator iter = threads.begin();
+  for (; iter != threads.end(); ++iter) {
+    (*iter)->Join();
+  }
+  ola::STLDeleteElements(&threads);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(40000), var.Get());
+}
+
+
+/*
+ * Check the ShardedCounterMap works correctly.
+ */
+void ExportMapTest::testShardedCounterMap() {
+  ShardedCounterMap var("foo", "universe");
+  OLA_ASSERT_EQ(string("universe"), var.Label());
+  OLA_ASSERT_EQ(string("map:universe"), var.Value());
+
+  ShardedCounter *counter = var.Get("1");
+  OLA_ASSERT_EQ(counter, var.Get("1"));
+  counter->Add(3);
+  var.Get("2")->Increment();
+  OLA_ASSERT_EQ(string("map:universe 1:3 2:1"), var.Value());
+
+  vector<std::pair<string, uint64_t> > values;
+  var.Snapshot(&values);
+  OLA_ASSERT_EQ((size_t) 2, values.size());
+  OLA_ASSERT_EQ(string("2"), values[1].first);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), values[1].second);
+}
+
+
+/*
+ * Check the Histogram works correctly.
+ */
+void ExportMapTest::testHistogram() {
+  vector<uint64_t> bounds;
+  bounds.push_back(10);
+  bounds.push_back(100);
+  Histogram var("latency", bounds);
+  OLA_ASSERT_EQ(string("count=0 sum=0 le_10:0 le_100:0 le_inf:0"),
+                var.Value());
+
+  var.Record(0);
+  var.Record(10);
+  var.Record(11);
+  var.Record(1000);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), var.Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1021), var.Sum());
+
+  vector<uint64_t> counts;
+  var.Buckets(&counts);
+  OLA_ASSERT_EQ((size_t) 3, counts.size());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counts[0]);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), counts[1]);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), counts[2]);
+  OLA_ASSERT_EQ(string("count=4 sum=1021 le_10:2 le_100:1 le_inf:1"),
+                var.Value());
+
+  var.Reset();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), var.Count());
+  OLA_ASSERT_FALSE(Histogram::DefaultLatencyBounds().empty());
+}
+
+
 /*
  * Check the export map works correctly.
  */
@@ -238,6 +403,62 @@ void ExportMapTest::testExportMap() {
   OLA_ASSERT_EQ(map_var->Name(), map_var_name);
   OLA_ASSERT_EQ(map_var->Label(), map_var_label);
 
+  ReceiveStatsMap *stats_var = map.GetReceiveStatsMapVar("stats_var");
+  OLA_ASSERT_EQ(stats_var, map.GetReceiveStatsMapVar("stats_var"));
+  OLA_ASSERT_EQ((size_t) 1, map.ReceiveStatsVariables().size());
+
   vector<BaseVariable*> variables = map.AllVariables();
-  OLA_ASSERT_EQ(variables.size(), (size_t) 4);
+  OLA_ASSERT_EQ(variables.size(), (size_t) 5);
+
+  ShardedCounter *counter = map.GetShardedCounterVar("counter");
+  OLA_ASSERT_EQ(counter, map.GetShardedCounterVar("counter"));
+  ShardedCounterMap *counter_map = map.GetShardedCounterMapVar("counter_map",
+                                                               "port");
+  OLA_ASSERT_EQ(counter_map, map.GetShardedCounterMapVar("counter_map"));
+  OLA_ASSERT_EQ(string("port"), counter_map->Label());
+  Histogram *histogram = map.GetHistogramVar("histogram");
+  OLA_ASSERT_EQ(histogram, map.GetHistogramVar("histogram"));
+  OLA_ASSERT_EQ(Histogram::DefaultLatencyBounds().size(),
+                histogram->Bounds().size());
+  OLA_ASSERT_EQ((size_t) 8, map.AllVariables().size());
+}
+
+
+/*
+ * Check the Prometheus output.
+ */
+void ExportMapTest::testWriteMetrics() {
+  ExportMap map;
+  map.GetStringVar("str-var")->Set("skipped");
+  map.GetIntegerVar("int-var")->Set(-2);
+  map.GetShardedCounterVar("rpc-sent")->Add(5);
+  (*map.GetUIntMapVar("drops", "universe"))["1"] = 3;
+  map.GetShardedCounterMapVar("frames")->Get("a\"b")->Increment();
+
+  vector<uint64_t> bounds;
+  bounds.push_back(10);
+  bounds.push_back(100);
+  Histogram *histogram = map.GetHistogramVar("latency", bounds);
+  histogram->Record(5);
+  histogram->Record(50);
+  histogram->Record(500);
+
+  std::ostringstream output;
+  map.WriteMetrics(&output);
+  OLA_ASSERT_EQ(
+      string("# TYPE ola_int_var gauge\n"
+             "ola_int_var -2\n"
+             "# TYPE ola_rpc_sent counter\n"
+             "ola_rpc_sent 5\n"
+             "# TYPE ola_drops gauge\n"
+             "ola_drops{universe=\"1\"} 3\n"
+             "# TYPE ola_frames counter\n"
+             "ola_frames{key=\"a\\\"b\"} 1\n"
+             "# TYPE ola_latency histogram\n"
+             "ola_latency_bucket{le=\"10\"} 1\n"
+             "ola_latency_bucket{le=\"100\"} 2\n"
+             "ola_latency_bucket{le=\"+Inf\"} 3\n"
+             "ola_latency_sum 555\n"
+             "ola_latency_count 3\n"),
+      output.str());
 }
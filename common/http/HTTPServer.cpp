@@ -23,21 +23,33 @@
 #endif  // HAVE_CONFIG_H
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif  // HAVE_LIBZ
 #include <ola/Logging.h>
+#include <ola/StringUtils.h>
 #include <ola/base/Macro.h>
 #include <ola/file/Util.h>
 #include <ola/http/HTTPServer.h>
 #include <ola/io/Descriptor.h>
+#include <ola/stl/STLUtils.h>
+#include <ola/thread/Mutex.h>
 #include <ola/web/Json.h>
-#include <ola/web/JsonWriter.h>
+#include <ola/web/JsonStreamWriter.h>
 
 #ifdef _WIN32
 #include <ola/win/CleanWinSock2.h>
 #endif  // _WIN32
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <sstream>
 #include <set>
 #include <string>
 #include <utility>
@@ -61,6 +73,7 @@ class UnmanagedSocketDescriptor : public ola::io::UnmanagedFileDescriptor {
 };
 #endif  // _WIN32
 
+using std::auto_ptr;
 using std::ifstream;
 using std::map;
 using std::pair;
@@ -68,8 +81,9 @@ using std::set;
 using std::string;
 using std::vector;
 using ola::io::UnmanagedFileDescriptor;
+using ola::thread::MutexLocker;
+using ola::web::JsonStreamWriter;
 using ola::web::JsonValue;
-using ola::web::JsonWriter;
 
 const char HTTPServer::CONTENT_TYPE_PLAIN[] = "text/plain";
 const char HTTPServer::CONTENT_TYPE_HTML[] = "text/html";
@@ -81,6 +95,97 @@ const char HTTPServer::CONTENT_TYPE_JS[] = "text/javascript";
 const char HTTPServer::CONTENT_TYPE_OCT[] = "application/octet-stream";
 const char HTTPServer::CONTENT_TYPE_JSON[] = "application/json";
 const char HTTPServer::CONTENT_TYPE_XML[] = "application/xml";
+const char HTTPServer::CONTENT_TYPE_EVENT_STREAM[] = "text/event-stream";
+
+namespace {
+
+// Files & responses smaller than this aren't worth compressing.
+const size_t MIN_GZIP_SIZE = 256;
+
+const char GZIP_ENCODING[] = "gzip";
+const char DEFLATE_ENCODING[] = "deflate";
+
+// The largest block libmicrohttpd reads from an event stream at once.
+const size_t EVENT_STREAM_BLOCK_SIZE = 4096;
+
+/*
+ * Check if an Accept-Encoding header allows a content coding.
+ * @param accept_encoding the value of the header.
+ * @param coding the coding, in lower case.
+ */
+bool AcceptsEncoding(const string &accept_encoding, const string &coding) {
+  vector<string> codings;
+  StringSplit(accept_encoding, &codings, ",");
+  vector<string>::iterator iter = codings.begin();
+  for (; iter != codings.end(); ++iter) {
+    vector<string> params;
+    StringSplit(*iter, &params, ";");
+    StringTrim(&params[0]);
+    ToLower(&params[0]);
+    if (params[0] != coding) {
+      continue;
+    }
+
+    // A q-value of 0 means the coding isn't acceptable.
+    for (unsigned int i = 1; i < params.size(); i++) {
+      StringTrim(&params[i]);
+      if (params[i].size() > 2 && (params[i][0] == 'q' || params[i][0] == 'Q')
+          && params[i][1] == '=') {
+        return strtod(params[i].c_str() + 2, NULL) > 0;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Format a time as an HTTP date, e.g. Sun, 06 Nov 1994 08:49:37 GMT.
+ */
+string FormatHTTPDate(time_t time) {
+  struct tm tm_time;
+#ifdef _WIN32
+  tm_time = *gmtime(&time);  // NOLINT(runtime/threadsafe_fn)
+#else
+  gmtime_r(&time, &tm_time);
+#endif  // _WIN32
+  char output[40];
+  strftime(output, sizeof(output), "%a, %d %b %Y %H:%M:%S GMT", &tm_time);
+  return output;
+}
+
+#ifdef HAVE_LIBZ
+/*
+ * Compress data.
+ * @param data the data to compress.
+ * @param gzip true to use the gzip format, false to use the zlib format,
+ *   which HTTP calls deflate.
+ * @param level the zlib compression level.
+ * @param[out] output the compressed data.
+ * @returns true if the data was compressed, false otherwise.
+ */
+bool CompressData(const string &data, bool gzip, int level, string *output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // Adding 16 to the window bits writes a gzip header & trailer.
+  if (deflateInit2(&stream, level, Z_DEFLATED,
+                   gzip ? 16 + MAX_WBITS : MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  output->resize(deflateBound(&stream, data.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = output->size();
+  int ret = deflate(&stream, Z_FINISH);
+  output->resize(stream.total_out);
+  deflateEnd(&stream);
+  return ret == Z_STREAM_END;
+}
+#endif  // HAVE_LIBZ
+}  // namespace
 
 /**
  * @brief Called by MHD_get_connection_values to add headers to a request
@@ -161,8 +266,9 @@ static MHD_RESULT HandleRequest(void *http_server_ptr,
   request = static_cast<HTTPRequest*>(*ptr);
 
   if (request->InFlight()) {
-    // don't dispatch more than once
-    return MHD_YES;
+    // don't dispatch more than once, but send the response if the
+    // connection was resumed.
+    return static_cast<MHD_RESULT>(request->QueuePendingResponse());
   }
 
   if (request->Method() == MHD_HTTP_METHOD_GET) {
@@ -218,7 +324,9 @@ HTTPRequest::HTTPRequest(const string &url,
   m_version(version),
   m_connection(connection),
   m_processor(NULL),
-  m_in_flight(false) {
+  m_in_flight(false),
+  m_pending_response(NULL),
+  m_pending_status_code(MHD_HTTP_OK) {
 }
 
 
@@ -247,6 +355,9 @@ HTTPRequest::~HTTPRequest() {
   if (m_processor) {
     MHD_destroy_post_processor(m_processor);
   }
+  if (m_pending_response) {
+    MHD_destroy_response(m_pending_response);
+  }
 }
 
 
@@ -280,6 +391,37 @@ void HTTPRequest::AddPostParameter(const string &key, const string &value) {
 }
 
 
+/**
+ * @brief Store the response for a suspended connection.
+ * @param status_code the HTTP status code
+ * @param response the response, ownership is transferred.
+ */
+void HTTPRequest::SetPendingResponse(unsigned int status_code,
+                                     struct MHD_Response *response) {
+  if (m_pending_response) {
+    MHD_destroy_response(m_pending_response);
+  }
+  m_pending_status_code = status_code;
+  m_pending_response = response;
+}
+
+
+/**
+ * @brief Queue the response stored with SetPendingResponse().
+ * @return MHD_YES if there was no response, or it was queued.
+ */
+int HTTPRequest::QueuePendingResponse() {
+  if (!m_pending_response) {
+    return MHD_YES;
+  }
+  int ret = MHD_queue_response(m_connection, m_pending_status_code,
+                               m_pending_response);
+  MHD_destroy_response(m_pending_response);
+  m_pending_response = NULL;
+  return ret;
+}
+
+
 /**
  * @brief Process post data
  */
@@ -359,6 +501,31 @@ const string HTTPRequest::GetPostParameter(const string &key) const {
 }
 
 
+/**
+ * @brief Create a new response.
+ * @param connection the connection the request arrived on, may be NULL.
+ */
+HTTPResponse::HTTPResponse(struct MHD_Connection *connection)
+    : m_connection(connection),
+      m_status_code(MHD_HTTP_OK),
+      m_suspended_request(NULL),
+      m_not_modified(false) {
+  if (!connection) {
+    return;
+  }
+
+  const char *value = MHD_lookup_connection_value(
+      connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+  m_accept_encoding = value ? value : "";
+  value = MHD_lookup_connection_value(connection, MHD_HEADER_KIND,
+                                      MHD_HTTP_HEADER_IF_NONE_MATCH);
+  m_if_none_match = value ? value : "";
+  value = MHD_lookup_connection_value(connection, MHD_HEADER_KIND,
+                                      MHD_HTTP_HEADER_IF_MODIFIED_SINCE);
+  m_if_modified_since = value ? value : "";
+}
+
+
 /**
  * @brief Set the content-type header
  * @param type the content type
@@ -390,6 +557,41 @@ void HTTPResponse::SetAccessControlAllowOriginAll() {
 #endif  // MHD_HTTP_HEADER_ACCESS_CONTROL_ALLOW_ORIGIN
 }
 
+/**
+ * @brief Set the validators used to revalidate a cached response.
+ * @param etag the entity tag, including the quotes.
+ * @param last_modified the time the content last changed.
+ * @return true if the client's copy is current, in which case Send() returns
+ *   a 304 without the body.
+ *
+ * The browser is told to check with us each time, so polls of a resource
+ * which hasn't changed are cheap.
+ */
+bool HTTPResponse::SetValidators(const string &etag, time_t last_modified) {
+  const string date = FormatHTTPDate(last_modified);
+  SetHeader(MHD_HTTP_HEADER_ETAG, etag);
+  SetHeader(MHD_HTTP_HEADER_LAST_MODIFIED, date);
+  SetNoCache();
+
+  m_not_modified = false;
+  if (!m_if_none_match.empty()) {
+    // If-None-Match takes precedence over If-Modified-Since.
+    vector<string> tags;
+    StringSplit(m_if_none_match, &tags, ",");
+    vector<string>::iterator iter = tags.begin();
+    for (; iter != tags.end() && !m_not_modified; ++iter) {
+      StringTrim(&(*iter));
+      m_not_modified = (*iter == etag || *iter == "*");
+    }
+  } else {
+    // Browsers send back the date we sent them, so there's no need to parse
+    // it.
+    m_not_modified = m_if_modified_since == date;
+  }
+  return m_not_modified;
+}
+
+
 /**
  * @brief Set a header in the response
  * @param key the header name
@@ -407,44 +609,232 @@ void HTTPResponse::SetHeader(const string &key, const string &value) {
  * @return true on success, false on error
  */
 int HTTPResponse::SendJson(const JsonValue &json) {
-  SetAccessControlAllowOriginAll();
-  const string output = JsonWriter::AsString(json);
-  struct MHD_Response *response = HTTPServer::BuildResponse(
-      static_cast<void*>(const_cast<char*>(output.data())),
-      output.length());
-  HeadersMultiMap::const_iterator iter;
-  for (iter = m_headers.begin(); iter != m_headers.end(); ++iter) {
-    MHD_add_response_header(response,
-                            iter->first.c_str(),
-                            iter->second.c_str());
-  }
-  int ret = MHD_queue_response(m_connection, m_status_code, response);
-  MHD_destroy_response(response);
-  return ret;
+  JsonStreamWriter writer(&m_data);
+  writer.Value(json);
+  return Send();
 }
 
 
 /**
  * @brief Send the HTTP response
  * @return true on success, false on error
+ *
+ * If the client accepts it, the body is compressed.
  */
 int HTTPResponse::Send() {
   SetAccessControlAllowOriginAll();
+  if (m_not_modified) {
+    m_status_code = MHD_HTTP_NOT_MODIFIED;
+    m_data.clear();
+  }
+
+  const string *body = &m_data;
+#ifdef HAVE_LIBZ
+  string compressed;
+  if (m_data.size() >= MIN_GZIP_SIZE) {
+    const bool gzip = AcceptsEncoding(m_accept_encoding, GZIP_ENCODING);
+    // These are generated for each request, so favor speed over size.
+    if ((gzip || AcceptsEncoding(m_accept_encoding, DEFLATE_ENCODING)) &&
+        CompressData(m_data, gzip, Z_BEST_SPEED, &compressed) &&
+        compressed.size() < m_data.size()) {
+      body = &compressed;
+      SetHeader(MHD_HTTP_HEADER_CONTENT_ENCODING,
+                gzip ? GZIP_ENCODING : DEFLATE_ENCODING);
+    }
+    SetHeader(MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+  }
+#endif  // HAVE_LIBZ
+
   HeadersMultiMap::const_iterator iter;
   struct MHD_Response *response = HTTPServer::BuildResponse(
-      static_cast<void*>(const_cast<char*>(m_data.data())),
-      m_data.length());
+      static_cast<void*>(const_cast<char*>(body->data())),
+      body->length());
   for (iter = m_headers.begin(); iter != m_headers.end(); ++iter) {
     MHD_add_response_header(response,
                             iter->first.c_str(),
                             iter->second.c_str());
   }
+  return QueueResponse(response);
+}
+
+
+/**
+ * @brief Queue a libmicrohttpd response with this response's status code.
+ * @param response the response to queue, ownership is transferred.
+ * @return true on success, false on error
+ *
+ * If the connection was suspended, this may be called from any thread. The
+ * response is stored and queued once the connection has been resumed.
+ */
+int HTTPResponse::QueueResponse(struct MHD_Response *response) {
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+  if (m_suspended_request) {
+    m_suspended_request->SetPendingResponse(m_status_code, response);
+    m_suspended_request = NULL;
+    MHD_resume_connection(m_connection);
+    return MHD_YES;
+  }
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
   int ret = MHD_queue_response(m_connection, m_status_code, response);
   MHD_destroy_response(response);
   return ret;
 }
 
 
+HTTPEventStream::HTTPEventStream(struct MHD_Connection *connection)
+    : m_connection(connection),
+      m_suspended(false),
+      m_closed(false),
+      m_client_closed(false),
+      // One for the owner and one for libmicrohttpd.
+      m_references(2) {
+}
+
+
+/**
+ * @brief Send an event.
+ * @param event the event type, may be empty.
+ * @param data the event data, each line is sent as a data field.
+ * @return false if the client has gone away or the stream was closed.
+ */
+bool HTTPEventStream::SendEvent(const string &event, const string &data) {
+  string message;
+  if (!event.empty()) {
+    message.append("event: ");
+    message.append(event);
+    message.push_back('\n');
+  }
+
+  vector<string> lines;
+  StringSplit(data, &lines, "\n");
+  vector<string>::const_iterator iter = lines.begin();
+  for (; iter != lines.end(); ++iter) {
+    message.append("data: ");
+    message.append(*iter);
+    message.push_back('\n');
+  }
+  message.push_back('\n');
+  return Append(message);
+}
+
+
+/**
+ * @brief Send a comment, this is ignored by the client but can be used to
+ * check the connection is still open.
+ */
+bool HTTPEventStream::SendComment(const string &comment) {
+  return Append(": " + comment + "\n\n");
+}
+
+
+unsigned int HTTPEventStream::QueuedBytes() const {
+  MutexLocker locker(&m_mutex);
+  return m_queue.size();
+}
+
+
+bool HTTPEventStream::ClientClosed() const {
+  MutexLocker locker(&m_mutex);
+  return m_client_closed;
+}
+
+
+/**
+ * @brief End the stream once the queued events have been sent.
+ */
+void HTTPEventStream::Close() {
+  {
+    MutexLocker locker(&m_mutex);
+    m_closed = true;
+    Resume();
+  }
+  Release();
+}
+
+
+bool HTTPEventStream::Append(const string &data) {
+  MutexLocker locker(&m_mutex);
+  if (m_closed || m_client_closed) {
+    return false;
+  }
+  m_queue.append(data);
+  Resume();
+  return true;
+}
+
+
+/*
+ * Resume the connection if it's waiting for data, m_mutex must be held.
+ */
+void HTTPEventStream::Resume() {
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+  if (m_suspended && !m_client_closed) {
+    MHD_resume_connection(m_connection);
+    m_suspended = false;
+  }
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
+}
+
+
+/*
+ * Called by libmicrohttpd when it's ready for more data. If there isn't any,
+ * the connection is suspended until an event is sent.
+ */
+ssize_t HTTPEventStream::Read(char *buffer, size_t max) {
+  MutexLocker locker(&m_mutex);
+  if (m_queue.empty()) {
+    if (m_closed) {
+      return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+    MHD_suspend_connection(m_connection);
+    m_suspended = true;
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
+    return 0;
+  }
+
+  size_t size = std::min(max, m_queue.size());
+  memcpy(buffer, m_queue.data(), size);
+  m_queue.erase(0, size);
+  return size;
+}
+
+
+void HTTPEventStream::Release() {
+  bool last_reference;
+  {
+    MutexLocker locker(&m_mutex);
+    last_reference = --m_references == 0;
+  }
+  if (last_reference) {
+    delete this;
+  }
+}
+
+
+ssize_t HTTPEventStream::ReadCallback(void *stream,
+                                      OLA_UNUSED uint64_t position,
+                                      char *buffer,
+                                      size_t max) {
+  return static_cast<HTTPEventStream*>(stream)->Read(buffer, max);
+}
+
+
+/*
+ * Called by libmicrohttpd once it's finished with the connection.
+ */
+void HTTPEventStream::FreeCallback(void *stream) {
+  HTTPEventStream *event_stream = static_cast<HTTPEventStream*>(stream);
+  {
+    MutexLocker locker(&event_stream->m_mutex);
+    event_stream->m_client_closed = true;
+    event_stream->m_suspended = false;
+    event_stream->m_queue.clear();
+  }
+  event_stream->Release();
+}
+
+
 /**
  * @brief Setup the HTTP server.
  * @param options the configuration options for the server
@@ -454,7 +844,18 @@ HTTPServer::HTTPServer(const HTTPServerOptions &options)
       m_httpd(NULL),
       m_default_handler(NULL),
       m_port(options.port),
-      m_data_dir(options.data_dir) {
+      m_data_dir(options.data_dir),
+      m_thread_pool_size(options.thread_pool_size),
+      m_cache_static_content(options.cache_static_content),
+      m_connection_memory_limit(options.connection_memory_limit),
+      m_connection_limit(options.connection_limit) {
+#ifndef HAVE_MHD_SUSPEND_CONNECTION
+  if (m_thread_pool_size) {
+    OLA_WARN << "This version of libmicrohttpd can't suspend connections, "
+             << "not using a thread pool";
+    m_thread_pool_size = 0;
+  }
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
   ola::io::SelectServer::Options ss_options;
   // See issue #761. epoll/kqueue can't be used with the current
   // implementation.
@@ -484,6 +885,7 @@ HTTPServer::~HTTPServer() {
   }
 
   m_handlers.clear();
+  STLDeleteValues(&m_file_cache);
 }
 
 
@@ -497,7 +899,55 @@ bool HTTPServer::Init() {
     return false;
   }
 
-  m_httpd = MHD_start_daemon(MHD_NO_FLAG,
+  // The optional limits, terminated by MHD_OPTION_END.
+  struct MHD_OptionItem limits[3];
+  unsigned int limit_count = 0;
+  if (m_connection_memory_limit) {
+    limits[limit_count].option = MHD_OPTION_CONNECTION_MEMORY_LIMIT;
+    limits[limit_count].value = m_connection_memory_limit;
+    limits[limit_count].ptr_value = NULL;
+    limit_count++;
+  }
+  if (m_connection_limit) {
+    limits[limit_count].option = MHD_OPTION_CONNECTION_LIMIT;
+    limits[limit_count].value = m_connection_limit;
+    limits[limit_count].ptr_value = NULL;
+    limit_count++;
+  }
+  limits[limit_count].option = MHD_OPTION_END;
+  limits[limit_count].value = 0;
+  limits[limit_count].ptr_value = NULL;
+
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+  if (m_thread_pool_size) {
+    m_httpd = MHD_start_daemon(
+        MHD_USE_SELECT_INTERNALLY | MHD_USE_SUSPEND_RESUME,
+        m_port,
+        NULL,
+        NULL,
+        &HandleRequest,
+        this,
+        MHD_OPTION_THREAD_POOL_SIZE, m_thread_pool_size,
+        MHD_OPTION_NOTIFY_COMPLETED,
+        RequestCompleted,
+        NULL,
+        MHD_OPTION_ARRAY, limits,
+        MHD_OPTION_END);
+    if (m_httpd) {
+      OLA_INFO << "Using " << m_thread_pool_size << " HTTP threads";
+    }
+    return m_httpd ? true : false;
+  }
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
+
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+  // Event streams suspend their connection while they wait for data.
+  unsigned int flags = MHD_USE_SUSPEND_RESUME;
+#else
+  unsigned int flags = MHD_NO_FLAG;
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
+
+  m_httpd = MHD_start_daemon(flags,
                              m_port,
                              NULL,
                              NULL,
@@ -506,6 +956,7 @@ bool HTTPServer::Init() {
                              MHD_OPTION_NOTIFY_COMPLETED,
                              RequestCompleted,
                              NULL,
+                             MHD_OPTION_ARRAY, limits,
                              MHD_OPTION_END);
 
   if (m_httpd) {
@@ -643,28 +1094,51 @@ void HTTPServer::UpdateSockets() {
 
 /**
  * @brief Call the appropriate handler.
+ *
+ * When using a thread pool this is called on one of the libmicrohttpd
+ * threads. Static files are served straight away, handlers are queued to run
+ * on the HTTP server's thread.
  */
-int HTTPServer::DispatchRequest(const HTTPRequest *request,
+int HTTPServer::DispatchRequest(HTTPRequest *request,
                                 HTTPResponse *response) {
-  map<string, BaseHTTPCallback*>::iterator iter =
-    m_handlers.find(request->Url());
+  map<string, static_file_info>::const_iterator file_iter =
+      m_static_content.find(request->Url());
 
-  if (iter != m_handlers.end()) {
-    return iter->second->Run(request, response);
+  BaseHTTPCallback *handler = STLFindOrNull(m_handlers, request->Url());
+  if (!handler && file_iter != m_static_content.end()) {
+    return ServeStaticContent(&(file_iter->second), request, response);
   }
 
-  map<string, static_file_info>::iterator file_iter =
-      m_static_content.find(request->Url());
+  if (!handler) {
+    handler = m_default_handler;
+  }
 
-  if (file_iter != m_static_content.end()) {
-    return ServeStaticContent(&(file_iter->second), response);
+  if (!handler) {
+    return ServeNotFound(response);
   }
 
-  if (m_default_handler) {
-    return m_default_handler->Run(request, response);
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+  if (m_thread_pool_size) {
+    MHD_suspend_connection(response->Connection());
+    response->SetSuspendedRequest(request);
+    m_select_server->Execute(
+        NewSingleCallback(this, &HTTPServer::DeferredRunHandler, handler,
+                          static_cast<const HTTPRequest*>(request),
+                          response));
+    return MHD_YES;
   }
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
+  return handler->Run(request, response);
+}
 
-  return ServeNotFound(response);
+
+/**
+ * @brief Run a handler on the HTTP server's thread.
+ */
+void HTTPServer::DeferredRunHandler(BaseHTTPCallback *handler,
+                                    const HTTPRequest *request,
+                                    HTTPResponse *response) {
+  handler->Run(request, response);
 }
 
 
@@ -810,40 +1284,68 @@ int HTTPServer::ServeStaticContent(const std::string &path,
   static_file_info file_info;
   file_info.file_path = path;
   file_info.content_type = content_type;
-  return ServeStaticContent(&file_info, response);
+  return ServeStaticContent(&file_info, NULL, response);
+}
+
+
+/**
+ * @brief Start a stream of server-sent events.
+ * @param response the response to use, this is deleted.
+ * @returns the new stream, which must be closed with
+ *   HTTPEventStream::Close(), or NULL if streams aren't supported.
+ */
+HTTPEventStream *HTTPServer::StartEventStream(HTTPResponse *response) {
+#ifdef HAVE_MHD_SUSPEND_CONNECTION
+  HTTPEventStream *stream = new HTTPEventStream(response->Connection());
+  struct MHD_Response *mhd_response = MHD_create_response_from_callback(
+      MHD_SIZE_UNKNOWN,
+      EVENT_STREAM_BLOCK_SIZE,
+      &HTTPEventStream::ReadCallback,
+      stream,
+      &HTTPEventStream::FreeCallback);
+  if (!mhd_response) {
+    delete stream;
+    ServeError(response, "Failed to create the event stream");
+    return NULL;
+  }
+
+  MHD_add_response_header(mhd_response, MHD_HTTP_HEADER_CONTENT_TYPE,
+                          CONTENT_TYPE_EVENT_STREAM);
+  MHD_add_response_header(mhd_response, MHD_HTTP_HEADER_CACHE_CONTROL,
+                          "no-cache");
+  // If this fails, libmicrohttpd runs the FreeCallback and the stream
+  // reports that the client has closed.
+  response->QueueResponse(mhd_response);
+  delete response;
+  return stream;
+#else
+  ServeError(response,
+             "This version of libmicrohttpd doesn't support event streams");
+  return NULL;
+#endif  // HAVE_MHD_SUSPEND_CONNECTION
 }
 
 
 /**
  * @brief Serve static content.
  * @param file_info details on the file to server
+ * @param request the request, may be NULL.
  * @param response the response to use
  */
-int HTTPServer::ServeStaticContent(static_file_info *file_info,
+int HTTPServer::ServeStaticContent(const static_file_info *file_info,
+                                   const HTTPRequest *request,
                                    HTTPResponse *response) {
-  char *data;
-  unsigned int length;
-  string file_path = m_data_dir;
-  file_path.push_back(ola::file::PATH_SEPARATOR);
-  file_path.append(file_info->file_path);
-  ifstream i_stream(file_path.c_str(), ifstream::binary);
+  if (m_cache_static_content) {
+    return ServeCachedContent(file_info, request, response);
+  }
 
-  if (!i_stream.is_open()) {
-    OLA_WARN << "Missing file: " << file_path;
+  string data;
+  if (!ReadFile(file_info->file_path, &data)) {
     return ServeNotFound(response);
   }
 
-  i_stream.seekg(0, std::ios::end);
-  length = i_stream.tellg();
-  i_stream.seekg(0, std::ios::beg);
-
-  data = static_cast<char*>(malloc(length));
-
-  i_stream.read(data, length);
-  i_stream.close();
-
-  struct MHD_Response *mhd_response = BuildResponse(static_cast<void*>(data),
-                                                    length);
+  struct MHD_Response *mhd_response = BuildResponse(
+      static_cast<void*>(const_cast<char*>(data.data())), data.size());
 
   if (!file_info->content_type.empty()) {
     MHD_add_response_header(mhd_response,
@@ -851,14 +1353,130 @@ int HTTPServer::ServeStaticContent(static_file_info *file_info,
                             file_info->content_type.c_str());
   }
 
-  int ret = MHD_queue_response(response->Connection(),
-                               MHD_HTTP_OK,
-                               mhd_response);
-  MHD_destroy_response(mhd_response);
+  int ret = response->QueueResponse(mhd_response);
   delete response;
   return ret;
 }
 
+
+/**
+ * @brief Serve static content from the cache.
+ *
+ * The gzipped copy is sent if the client accepts it, and a 304 is returned if
+ * the client already has the file.
+ */
+int HTTPServer::ServeCachedContent(const static_file_info *file_info,
+                                   const HTTPRequest *request,
+                                   HTTPResponse *response) {
+  const cached_file *file = GetCachedFile(file_info->file_path);
+  if (!file) {
+    return ServeNotFound(response);
+  }
+
+  struct MHD_Response *mhd_response;
+  if (request &&
+      request->GetHeader(MHD_HTTP_HEADER_IF_NONE_MATCH) == file->etag) {
+    response->SetStatus(MHD_HTTP_NOT_MODIFIED);
+    mhd_response = BuildResponse(NULL, 0);
+  } else {
+    bool use_gzip = (
+        request && !file->gzipped_data.empty() &&
+        AcceptsEncoding(request->GetHeader(MHD_HTTP_HEADER_ACCEPT_ENCODING),
+                        GZIP_ENCODING));
+
+    mhd_response = BuildPersistentResponse(
+        use_gzip ? file->gzipped_data : file->data);
+    if (use_gzip) {
+      MHD_add_response_header(mhd_response, MHD_HTTP_HEADER_CONTENT_ENCODING,
+                              GZIP_ENCODING);
+    }
+    if (!file_info->content_type.empty()) {
+      MHD_add_response_header(mhd_response,
+                              MHD_HTTP_HEADER_CONTENT_TYPE,
+                              file_info->content_type.c_str());
+    }
+  }
+
+  if (!file->gzipped_data.empty()) {
+    MHD_add_response_header(mhd_response, MHD_HTTP_HEADER_VARY,
+                            MHD_HTTP_HEADER_ACCEPT_ENCODING);
+  }
+  MHD_add_response_header(mhd_response, MHD_HTTP_HEADER_ETAG,
+                          file->etag.c_str());
+  // The files can change when olad is upgraded, so make the browser check.
+  MHD_add_response_header(mhd_response, MHD_HTTP_HEADER_CACHE_CONTROL,
+                          "no-cache");
+
+  int ret = response->QueueResponse(mhd_response);
+  delete response;
+  return ret;
+}
+
+
+/**
+ * @brief Get a file from the cache, reading it from disk if required.
+ * @param file_path the path to the file, relative to the data dir.
+ * @returns the cached file, or NULL if the file couldn't be read.
+ */
+const HTTPServer::cached_file *HTTPServer::GetCachedFile(
+    const string &file_path) {
+  MutexLocker locker(&m_file_cache_mutex);
+  cached_file *file = STLFindOrNull(m_file_cache, file_path);
+  if (file) {
+    return file;
+  }
+
+  auto_ptr<cached_file> new_file(new cached_file());
+  if (!ReadFile(file_path, &new_file->data)) {
+    return NULL;
+  }
+  new_file->etag = BuildETag(new_file->data);
+
+#ifdef HAVE_LIBZ
+  if (new_file->data.size() >= MIN_GZIP_SIZE) {
+    if (!CompressData(new_file->data, true, Z_BEST_COMPRESSION,
+                      &new_file->gzipped_data) ||
+        new_file->gzipped_data.size() >= new_file->data.size()) {
+      new_file->gzipped_data.clear();
+    }
+  }
+#endif  // HAVE_LIBZ
+
+  file = new_file.release();
+  m_file_cache[file_path] = file;
+  return file;
+}
+
+
+/**
+ * @brief Read a file from the data dir.
+ * @param file_path the path to the file, relative to the data dir.
+ * @param[out] data the contents of the file.
+ * @returns true if the file was read, false otherwise.
+ */
+bool HTTPServer::ReadFile(const string &file_path, string *data) const {
+  string full_path = m_data_dir;
+  full_path.push_back(ola::file::PATH_SEPARATOR);
+  full_path.append(file_path);
+  ifstream i_stream(full_path.c_str(), ifstream::binary);
+
+  if (!i_stream.is_open()) {
+    OLA_WARN << "Missing file: " << full_path;
+    return false;
+  }
+
+  i_stream.seekg(0, std::ios::end);
+  std::streampos length = i_stream.tellg();
+  i_stream.seekg(0, std::ios::beg);
+
+  data->resize(length);
+  if (length > 0) {
+    i_stream.read(&(*data)[0], length);
+  }
+  i_stream.close();
+  return true;
+}
+
 void HTTPServer::InsertSocket(bool is_readable, bool is_writeable, int fd) {
 #ifdef _WIN32
   UnmanagedSocketDescriptor *socket = new UnmanagedSocketDescriptor(fd);
@@ -896,6 +1514,24 @@ void HTTPServer::FreeSocket(DescriptorState *state) {
 }
 
 
+/**
+ * @brief Build an ETag for some content.
+ * @param data the content.
+ * @returns the ETag, made from the size and a FNV-1a hash of the content.
+ */
+string HTTPServer::BuildETag(const string &data) {
+  uint32_t hash = 2166136261u;
+  for (string::const_iterator iter = data.begin(); iter != data.end();
+       ++iter) {
+    hash ^= static_cast<uint8_t>(*iter);
+    hash *= 16777619u;
+  }
+  std::ostringstream str;
+  str << "\"" << std::hex << data.size() << "-" << hash << "\"";
+  return str.str();
+}
+
+
 struct MHD_Response *HTTPServer::BuildResponse(void *data, size_t size) {
 #ifdef HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
   return MHD_create_response_from_buffer(size, data, MHD_RESPMEM_MUST_COPY);
@@ -903,5 +1539,20 @@ struct MHD_Response *HTTPServer::BuildResponse(void *data, size_t size) {
   return MHD_create_response_from_data(size, data, MHD_NO, MHD_YES);
 #endif  // HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
 }
+
+
+/**
+ * @brief Build a response that refers to the data rather than copying it.
+ * @param data the response body, this must outlive the response.
+ */
+struct MHD_Response *HTTPServer::BuildPersistentResponse(const string &data) {
+  void *ptr = static_cast<void*>(const_cast<char*>(data.data()));
+#ifdef HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
+  return MHD_create_response_from_buffer(data.size(), ptr,
+                                         MHD_RESPMEM_PERSISTENT);
+#else
+  return MHD_create_response_from_data(data.size(), ptr, MHD_NO, MHD_NO);
+#endif  // HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
+}
 }  // namespace http
 }  // namespace ola
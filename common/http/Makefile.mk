@@ -5,5 +5,5 @@ noinst_LTLIBRARIES += common/http/libolahttp.la
 common_http_libolahttp_la_SOURCES = \
     common/http/HTTPServer.cpp \
     common/http/OlaHTTPServer.cpp
-common_http_libolahttp_la_LIBADD = $(libmicrohttpd_LIBS)
+common_http_libolahttp_la_LIBADD = $(libmicrohttpd_LIBS) $(ZLIB_LIBS)
 endif
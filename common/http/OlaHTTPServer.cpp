@@ -37,6 +37,8 @@ using std::vector;
 
 const char OlaHTTPServer::K_DATA_DIR_VAR[] = "http_data_dir";
 const char OlaHTTPServer::K_UPTIME_VAR[] = "uptime-in-ms";
+const char OlaHTTPServer::K_METRICS_CONTENT_TYPE[] =
+    "text/plain; version=0.0.4";
 
 /**
  * Create a new OlaHTTPServer.
@@ -49,6 +51,7 @@ OlaHTTPServer::OlaHTTPServer(const HTTPServer::HTTPServerOptions &options,
       m_server(options) {
   RegisterHandler("/debug", &OlaHTTPServer::DisplayDebug);
   RegisterHandler("/help", &OlaHTTPServer::DisplayHandlers);
+  RegisterHandler("/metrics", &OlaHTTPServer::DisplayMetrics);
 
   StringVariable *data_dir_var = export_map->GetStringVar(K_DATA_DIR_VAR);
   data_dir_var->Set(m_server.DataDir());
@@ -93,6 +96,27 @@ int OlaHTTPServer::DisplayDebug(const HTTPRequest*,
 }
 
 
+/**
+ * Display the contents of the ExportMap in the Prometheus text format.
+ */
+int OlaHTTPServer::DisplayMetrics(const HTTPRequest*,
+                                  HTTPResponse *raw_response) {
+  auto_ptr<HTTPResponse> response(raw_response);
+  ola::TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  ola::TimeInterval diff = now - m_start_time;
+
+  ostringstream str;
+  str << "# TYPE ola_uptime_ms counter\n";
+  str << "ola_uptime_ms " << diff.InMilliSeconds() << "\n";
+  m_export_map->WriteMetrics(&str);
+
+  response->SetContentType(K_METRICS_CONTENT_TYPE);
+  response->Append(str.str());
+  return response->Send();
+}
+
+
 /**
  * Display a list of registered handlers
  */
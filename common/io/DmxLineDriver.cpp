@@ -0,0 +1,280 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxLineDriver.cpp
+ * Generates DMX512 / RDM frames on a UART with an RS-485 transceiver.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/io/DmxLineDriver.h"
+#include "ola/io/ExtendedSerial.h"
+#include "ola/io/IOUtils.h"
+#include "ola/thread/FrameTimer.h"
+
+namespace ola {
+namespace io {
+
+using ola::thread::FrameTimer;
+using std::string;
+
+DmxLineDriver::DmxLineDriver(const string &path, const Options &options)
+    : m_path(path),
+      m_options(options),
+      m_fd(-1) {
+}
+
+DmxLineDriver::~DmxLineDriver() {
+  Close();
+}
+
+bool DmxLineDriver::Open() {
+  if (IsOpen()) {
+    return true;
+  }
+
+  int oflag = (m_options.enable_receive ? O_RDWR : O_WRONLY) | O_NOCTTY;
+  if (!ola::io::Open(m_path, oflag, &m_fd)) {
+    m_fd = -1;
+    return false;
+  }
+
+  struct termios tios;
+  if (tcgetattr(m_fd, &tios) < 0) {
+    OLA_WARN << "Failed to get port settings for " << m_path << ": "
+             << strerror(errno);
+    Close();
+    return false;
+  }
+
+  cfmakeraw(&tios);
+  tios.c_cflag |= CLOCAL | CS8 | CSTOPB;
+  tios.c_cflag &= ~(PARENB | CRTSCTS);
+  if (m_options.enable_receive) {
+    tios.c_cflag |= CREAD;
+  }
+  // Reads return as soon as there is data, we use poll() for the timeouts.
+  tios.c_cc[VMIN] = 0;
+  tios.c_cc[VTIME] = 0;
+
+  if (tcsetattr(m_fd, TCSANOW, &tios) < 0) {
+    OLA_WARN << "Failed to set port settings for " << m_path << ": "
+             << strerror(errno);
+    Close();
+    return false;
+  }
+
+  if (!LinuxHelper::SetBaud(m_fd, DMX_BAUD_RATE)) {
+    OLA_WARN << "Failed to set " << m_path << " to 250k";
+    Close();
+    return false;
+  }
+
+  if (m_options.rs485 &&
+      !LinuxHelper::SetRS485(m_fd, true, m_options.rts_delay_before_send,
+                             m_options.rts_delay_after_send)) {
+    Close();
+    return false;
+  }
+
+  // Release the line, it idles at mark.
+  ioctl(m_fd, TIOCCBRK, NULL);
+  return true;
+}
+
+bool DmxLineDriver::Close() {
+  if (!IsOpen()) {
+    return true;
+  }
+
+  bool ok = true;
+  if (close(m_fd) < 0) {
+    OLA_WARN << "Failed to close " << m_path << ": " << strerror(errno);
+    ok = false;
+  }
+  m_fd = -1;
+  return ok;
+}
+
+bool DmxLineDriver::SendFrame(const uint8_t *data, unsigned int length) {
+  if (!IsOpen()) {
+    return false;
+  }
+
+  // Anything left over from the last frame, including our own echo on a
+  // half duplex line, isn't part of the next response.
+  if (m_options.enable_receive) {
+    tcflush(m_fd, TCIFLUSH);
+  }
+
+  if (!SendBreak()) {
+    return false;
+  }
+
+  if (!WriteAll(data, length)) {
+    return false;
+  }
+
+  // Wait until the last stop bit has gone, so the caller knows the line is
+  // free and the turnaround time is measured from the right point.
+  if (tcdrain(m_fd) < 0) {
+    OLA_WARN << "tcdrain failed on " << m_path << ": " << strerror(errno);
+    return false;
+  }
+  m_clock.CurrentMonotonicTime(&m_last_frame_end);
+
+  if (m_options.enable_receive) {
+    tcflush(m_fd, TCIFLUSH);
+  }
+  return true;
+}
+
+bool DmxLineDriver::SendDmx(const DmxBuffer &buffer) {
+  uint8_t frame[DMX_UNIVERSE_SIZE + 1];
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  frame[0] = DMX512_START_CODE;
+  buffer.Get(frame + 1, &length);
+  return SendFrame(frame, length + 1);
+}
+
+bool DmxLineDriver::ReceiveFrame(uint8_t *data, unsigned int *length,
+                                 const TimeInterval &timeout,
+                                 TimeInterval *turnaround) {
+  const unsigned int size = *length;
+  *length = 0;
+  if (!IsOpen() || !m_options.enable_receive || size == 0) {
+    return false;
+  }
+
+  if (!WaitForData(timeout)) {
+    return false;
+  }
+
+  if (turnaround) {
+    TimeStamp now;
+    m_clock.CurrentMonotonicTime(&now);
+    *turnaround = now - m_last_frame_end;
+  }
+
+  const TimeInterval inter_slot_timeout(INTER_SLOT_TIMEOUT_US);
+  while (*length < size) {
+    ssize_t r = read(m_fd, data + *length, size - *length);
+    if (r < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      OLA_WARN << "Read from " << m_path << " failed: " << strerror(errno);
+      break;
+    }
+    *length += r;
+    if (*length == size || !WaitForData(inter_slot_timeout)) {
+      break;
+    }
+  }
+
+  // A break arrives as a single 0.
+  if (*length > 1 && data[0] == 0) {
+    memmove(data, data + 1, *length - 1);
+    (*length)--;
+  }
+  return *length > 0;
+}
+
+bool DmxLineDriver::SendBreak() {
+  if (tcdrain(m_fd) < 0) {
+    OLA_WARN << "tcdrain failed on " << m_path << ": " << strerror(errno);
+    return false;
+  }
+
+  if (m_options.break_mode == BREAK_BAUD) {
+    const uint8_t zero = 0;
+    if (!LinuxHelper::SetBaud(m_fd, BREAK_BAUD_RATE, true)) {
+      return false;
+    }
+    bool ok = WriteAll(&zero, sizeof(zero)) && tcdrain(m_fd) == 0;
+    if (!LinuxHelper::SetBaud(m_fd, DMX_BAUD_RATE, true)) {
+      return false;
+    }
+    return ok;
+  }
+
+  if (ioctl(m_fd, TIOCSBRK, NULL) < 0) {
+    OLA_WARN << "Failed to set break on " << m_path << ": "
+             << strerror(errno);
+    return false;
+  }
+  FrameTimer::SleepFor(TimeInterval(
+      static_cast<int64_t>(m_options.break_time)));
+  if (ioctl(m_fd, TIOCCBRK, NULL) < 0) {
+    OLA_WARN << "Failed to clear break on " << m_path << ": "
+             << strerror(errno);
+    return false;
+  }
+  FrameTimer::SleepFor(TimeInterval(
+      static_cast<int64_t>(m_options.mab_time)));
+  return true;
+}
+
+bool DmxLineDriver::WriteAll(const uint8_t *data, unsigned int length) {
+  unsigned int offset = 0;
+  while (offset < length) {
+    ssize_t r = write(m_fd, data + offset, length - offset);
+    if (r < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      OLA_WARN << "Write to " << m_path << " failed: " << strerror(errno);
+      return false;
+    }
+    offset += r;
+  }
+  return true;
+}
+
+bool DmxLineDriver::WaitForData(const TimeInterval &timeout) {
+  struct pollfd poll_fd;
+  poll_fd.fd = m_fd;
+  poll_fd.events = POLLIN;
+  poll_fd.revents = 0;
+
+  // poll() only has ms resolution, round up so short timeouts aren't 0.
+  int timeout_ms = static_cast<int>((timeout.AsInt() + 999) / 1000);
+  int r;
+  do {
+    r = poll(&poll_fd, 1, timeout_ms);
+  } while (r < 0 && errno == EINTR);
+
+  if (r < 0) {
+    OLA_WARN << "poll() on " << m_path << " failed: " << strerror(errno);
+    return false;
+  }
+  return r > 0 && (poll_fd.revents & POLLIN);
+}
+}  // namespace io
+}  // namespace ola
@@ -20,54 +20,89 @@
 
 #include "common/io/EPoller.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/epoll.h>
 
 #include <algorithm>
-#include <queue>
+#include <new>
 #include <string>
-#include <utility>
 
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/base/Macro.h"
 #include "ola/io/Descriptor.h"
-#include "ola/stl/STLUtils.h"
+#include "common/io/LoopProfiler.h"
 
 namespace ola {
 namespace io {
 
-using std::pair;
-
 /*
- * Represents a FD
+ * Represents a FD. Each one fills a cache line.
  */
 class EPollData {
  public:
   EPollData()
       : events(0),
+        generation(0),
         read_descriptor(NULL),
         write_descriptor(NULL),
         connected_descriptor(NULL),
         delete_connected_on_close(false) {
   }
 
+  /*
+   * Called when the fd is removed from the epoll set. Bumping the generation
+   * means any events that are still pending for the old descriptors are
+   * ignored, even if the fd is reused.
+   */
   void Reset() {
     events = 0;
+    generation++;
     read_descriptor = NULL;
     write_descriptor = NULL;
     connected_descriptor = NULL;
     delete_connected_on_close = false;
   }
 
+  /*
+   * The events to register with epoll. We only use edge triggering when
+   * there is no write descriptor, since PerformWrite() may not fill the
+   * socket buffer.
+   */
+  uint32_t EPollEvents() const {
+    if (read_descriptor && read_descriptor->EdgeTriggered() &&
+        !(events & EPOLLOUT)) {
+      return events | EPOLLET;
+    }
+    return events;
+  }
+
+  /*
+   * The user data for the epoll event.
+   */
+  uint64_t Tag(int fd) const {
+    return (static_cast<uint64_t>(generation) << 32) |
+           static_cast<uint32_t>(fd);
+  }
+
   uint32_t events;
+  uint32_t generation;
   ReadFileDescriptor *read_descriptor;
   WriteFileDescriptor *write_descriptor;
   ConnectedDescriptor *connected_descriptor;
   bool delete_connected_on_close;
+
+ private:
+  static const unsigned int CACHE_LINE_SIZE = 64;
+
+  uint8_t padding[CACHE_LINE_SIZE - 2 * sizeof(uint32_t) -
+                  3 * sizeof(void*) - sizeof(bool)];
 };
 
+STATIC_ASSERT(sizeof(EPollData) == 64);
+
 namespace {
 
 /*
@@ -76,8 +111,8 @@ namespace {
  */
 bool AddEvent(int epoll_fd, int fd, EPollData *descriptor) {
   epoll_event event;
-  event.events = descriptor->events;
-  event.data.ptr = descriptor;
+  event.events = descriptor->EPollEvents();
+  event.data.u64 = descriptor->Tag(fd);
 
   OLA_DEBUG << "EPOLL_CTL_ADD " << fd << ", events " << std::hex
             << event.events << ", descriptor: " << descriptor;
@@ -95,8 +130,8 @@ bool AddEvent(int epoll_fd, int fd, EPollData *descriptor) {
  */
 bool UpdateEvent(int epoll_fd, int fd, EPollData *descriptor) {
   epoll_event event;
-  event.events = descriptor->events;
-  event.data.ptr = descriptor;
+  event.events = descriptor->EPollEvents();
+  event.data.u64 = descriptor->Tag(fd);
 
   OLA_DEBUG << "EPOLL_CTL_MOD " << fd << ", events " << std::hex
             << event.events << ", descriptor: " << descriptor;
@@ -121,12 +156,29 @@ bool RemoveEvent(int epoll_fd, int fd) {
   }
   return true;
 }
+
+/*
+ * Return the descriptor used to identify an EPollData to the LoopProfiler.
+ */
+const void *ProfileKey(const EPollData *data, int *fd) {
+  if (data->read_descriptor) {
+    *fd = ToFD(data->read_descriptor->ReadDescriptor());
+    return data->read_descriptor;
+  } else if (data->connected_descriptor) {
+    *fd = ToFD(data->connected_descriptor->ReadDescriptor());
+    return data->connected_descriptor;
+  } else if (data->write_descriptor) {
+    *fd = ToFD(data->write_descriptor->WriteDescriptor());
+    return data->write_descriptor;
+  }
+  return data;
+}
 }  // namespace
 
 /**
  * @brief The maximum number of events to return in one epoll cycle
  */
-const int EPoller::MAX_EVENTS = 10;
+const int EPoller::MAX_EVENTS = 256;
 
 
 /**
@@ -135,16 +187,19 @@ const int EPoller::MAX_EVENTS = 10;
 const int EPoller::READ_FLAGS = EPOLLIN | EPOLLRDHUP;
 
 /**
- * @brief The number of pre-allocated EPollData to have.
+ * @brief Each page of the descriptor table covers 2 ^ PAGE_BITS fds.
  */
-const unsigned int EPoller::MAX_FREE_DESCRIPTORS = 10;
+const unsigned int EPoller::PAGE_BITS = 6;
 
 EPoller::EPoller(ExportMap *export_map, Clock* clock)
     : m_export_map(export_map),
       m_loop_iterations(NULL),
       m_loop_time(NULL),
+      m_profiler(NULL),
+      m_ready_count(0),
       m_epoll_fd(INVALID_DESCRIPTOR),
       m_clock(clock) {
+  m_events.resize(MAX_EVENTS);
   if (m_export_map) {
     m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
     m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
@@ -161,26 +216,21 @@ EPoller::~EPoller() {
     close(m_epoll_fd);
   }
 
-  {
-    DescriptorMap::iterator iter = m_descriptor_map.begin();
-    for (; iter != m_descriptor_map.end(); ++iter) {
-      if (iter->second->delete_connected_on_close) {
-        delete iter->second->connected_descriptor;
-      }
-      delete iter->second;
+  const unsigned int page_size = 1 << PAGE_BITS;
+  std::vector<EPollData*>::iterator iter = m_pages.begin();
+  for (; iter != m_pages.end(); ++iter) {
+    if (!*iter) {
+      continue;
     }
-  }
-
-
-  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
-  for (; iter != m_orphaned_descriptors.end(); ++iter) {
-    if ((*iter)->delete_connected_on_close) {
-      delete (*iter)->connected_descriptor;
+    for (unsigned int i = 0; i < page_size; i++) {
+      EPollData *epoll_data = &(*iter)[i];
+      if (epoll_data->events && epoll_data->delete_connected_on_close) {
+        delete epoll_data->connected_descriptor;
+      }
+      epoll_data->~EPollData();
     }
-    delete *iter;
+    free(*iter);
   }
-
-  STLDeleteElements(&m_free_descriptors);
 }
 
 bool EPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
@@ -193,22 +243,20 @@ bool EPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
     return false;
   }
 
-  pair<EPollData*, bool> result = LookupOrCreateDescriptor(
-      descriptor->ReadDescriptor());
-  if (result.first->events & READ_FLAGS) {
-    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
-             << " already in read set";
+  const int fd = descriptor->ReadDescriptor();
+  EPollData *epoll_data = LookupOrCreateDescriptor(fd);
+  if (!epoll_data) {
     return false;
   }
-
-  result.first->events |= READ_FLAGS;
-  result.first->read_descriptor = descriptor;
-
-  if (result.second) {
-    return AddEvent(m_epoll_fd, descriptor->ReadDescriptor(), result.first);
-  } else {
-    return UpdateEvent(m_epoll_fd, descriptor->ReadDescriptor(), result.first);
+  if (epoll_data->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << fd << " already in read set";
+    return false;
   }
+
+  const bool new_descriptor = epoll_data->events == 0;
+  epoll_data->events |= READ_FLAGS;
+  epoll_data->read_descriptor = descriptor;
+  return Register(fd, epoll_data, new_descriptor);
 }
 
 bool EPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
@@ -222,24 +270,21 @@ bool EPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
     return false;
   }
 
-  pair<EPollData*, bool> result = LookupOrCreateDescriptor(
-      descriptor->ReadDescriptor());
-
-  if (result.first->events & READ_FLAGS) {
-    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
-             << " already in read set";
+  const int fd = descriptor->ReadDescriptor();
+  EPollData *epoll_data = LookupOrCreateDescriptor(fd);
+  if (!epoll_data) {
     return false;
   }
-
-  result.first->events |= READ_FLAGS;
-  result.first->connected_descriptor = descriptor;
-  result.first->delete_connected_on_close = delete_on_close;
-
-  if (result.second) {
-    return AddEvent(m_epoll_fd, descriptor->ReadDescriptor(), result.first);
-  } else {
-    return UpdateEvent(m_epoll_fd, descriptor->ReadDescriptor(), result.first);
+  if (epoll_data->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << fd << " already in read set";
+    return false;
   }
+
+  const bool new_descriptor = epoll_data->events == 0;
+  epoll_data->events |= READ_FLAGS;
+  epoll_data->connected_descriptor = descriptor;
+  epoll_data->delete_connected_on_close = delete_on_close;
+  return Register(fd, epoll_data, new_descriptor);
 }
 
 bool EPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
@@ -260,24 +305,20 @@ bool EPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
     return false;
   }
 
-  pair<EPollData*, bool> result = LookupOrCreateDescriptor(
-      descriptor->WriteDescriptor());
-
-  if (result.first->events & EPOLLOUT) {
-    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
-             << " already in write set";
+  const int fd = descriptor->WriteDescriptor();
+  EPollData *epoll_data = LookupOrCreateDescriptor(fd);
+  if (!epoll_data) {
     return false;
   }
-
-  result.first->events |= EPOLLOUT;
-  result.first->write_descriptor = descriptor;
-
-  if (result.second) {
-    return AddEvent(m_epoll_fd, descriptor->WriteDescriptor(), result.first);
-  } else {
-    return UpdateEvent(m_epoll_fd, descriptor->WriteDescriptor(),
-                       result.first);
+  if (epoll_data->events & EPOLLOUT) {
+    OLA_WARN << "Descriptor " << fd << " already in write set";
+    return false;
   }
+
+  const bool new_descriptor = epoll_data->events == 0;
+  epoll_data->events |= EPOLLOUT;
+  epoll_data->write_descriptor = descriptor;
+  return Register(fd, epoll_data, new_descriptor);
 }
 
 bool EPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
@@ -290,31 +331,36 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
     return false;
   }
 
-  epoll_event events[MAX_EVENTS];
   TimeInterval sleep_interval = poll_interval;
-  TimeStamp now;
-  m_clock->CurrentMonotonicTime(&now);
+  // Update the wake up time before running the timeouts, so they see the
+  // current time.
+  const TimeStamp last_wake_up = m_wake_up_time;
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
 
-  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(
+      &m_wake_up_time);
   if (!next_event_in.IsZero()) {
     sleep_interval = std::min(next_event_in, sleep_interval);
   }
 
   // take care of stats accounting
-  if (m_wake_up_time.IsSet()) {
-    TimeInterval loop_time = now - m_wake_up_time;
+  if (last_wake_up.IsSet()) {
+    TimeInterval loop_time = m_wake_up_time - last_wake_up;
     OLA_DEBUG << "ss process time was " << loop_time.ToString();
     if (m_loop_time)
       (*m_loop_time) += loop_time.AsInt();
     if (m_loop_iterations)
       (*m_loop_iterations)++;
+    if (m_profiler)
+      m_profiler->LoopDone(loop_time);
   }
 
   int ms_to_sleep = sleep_interval.InMilliSeconds();
   // If we haven't been asked to wait as part of the poll interval, then don't
   // wait in the epoll to allow for fast streaming
-  int ready = epoll_wait(m_epoll_fd, reinterpret_cast<epoll_event*>(&events),
-                         MAX_EVENTS, ms_to_sleep ? ms_to_sleep : 0);
+  int ready = epoll_wait(m_epoll_fd, &m_events[0], MAX_EVENTS,
+                         ms_to_sleep ? ms_to_sleep : 0);
+  m_ready_count = ready > 0 ? ready : 0;
 
   if (ready == 0) {
     m_clock->CurrentMonotonicTime(&m_wake_up_time);
@@ -330,23 +376,27 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
   m_clock->CurrentMonotonicTime(&m_wake_up_time);
 
   for (int i = 0; i < ready; i++) {
-    EPollData *descriptor = reinterpret_cast<EPollData*>(
-        events[i].data.ptr);
-    CheckDescriptor(&events[i], descriptor);
-  }
+    // A callback earlier in this batch may have removed the descriptor, in
+    // which case the generation won't match.
+    EPollData *descriptor = LookupDescriptor(
+        static_cast<int>(m_events[i].data.u64 & 0xffffffff));
+    if (!descriptor || !descriptor->events ||
+        descriptor->generation != m_events[i].data.u64 >> 32) {
+      continue;
+    }
 
-  // Now that we're out of the callback phase, clean up descriptors that were
-  // removed.
-  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
-  for (; iter != m_orphaned_descriptors.end(); ++iter) {
-    if (m_free_descriptors.size() == MAX_FREE_DESCRIPTORS) {
-      delete *iter;
+    if (m_profiler) {
+      // The descriptor may be removed by the handler, so find the key first.
+      int fd = -1;
+      const void *key = ProfileKey(descriptor, &fd);
+      TimeStamp start;
+      m_profiler->Start(&start);
+      CheckDescriptor(&m_events[i], descriptor);
+      m_profiler->DescriptorDone(key, fd, start);
     } else {
-      (*iter)->Reset();
-      m_free_descriptors.push_back(*iter);
+      CheckDescriptor(&m_events[i], descriptor);
     }
   }
-  m_orphaned_descriptors.clear();
 
   m_clock->CurrentMonotonicTime(&m_wake_up_time);
   timeout_manager->ExecuteTimeouts(&m_wake_up_time);
@@ -361,29 +411,32 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
  */
 void EPoller::CheckDescriptor(struct epoll_event *event,
                               EPollData *epoll_data) {
+  // If a callback removes the descriptor, the generation changes and we stop.
+  const uint32_t generation = epoll_data->generation;
+
   if (event->events & (EPOLLHUP | EPOLLRDHUP)) {
     if (epoll_data->read_descriptor) {
       epoll_data->read_descriptor->PerformRead();
     } else if (epoll_data->write_descriptor) {
       epoll_data->write_descriptor->PerformWrite();
     } else if (epoll_data->connected_descriptor) {
+      ConnectedDescriptor *descriptor = epoll_data->connected_descriptor;
       ConnectedDescriptor::OnCloseCallback *on_close =
-          epoll_data->connected_descriptor->TransferOnClose();
+          descriptor->TransferOnClose();
       if (on_close)
         on_close->Run();
 
-      // At this point the descriptor may be sitting in the orphan list if the
-      // OnClose handler called into RemoveReadDescriptor()
-      if (epoll_data->delete_connected_on_close &&
-          epoll_data->connected_descriptor) {
-        bool removed = RemoveDescriptor(
-            epoll_data->connected_descriptor->ReadDescriptor(), READ_FLAGS,
-            false);
+      // The OnClose handler may have called RemoveReadDescriptor(), in which
+      // case the descriptor is no longer ours to delete.
+      if (epoll_data->generation == generation &&
+          epoll_data->connected_descriptor == descriptor &&
+          epoll_data->delete_connected_on_close) {
+        bool removed = RemoveDescriptor(descriptor->ReadDescriptor(),
+                                        READ_FLAGS, false);
         if (removed && m_export_map) {
           (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
         }
-        delete epoll_data->connected_descriptor;
-        epoll_data->connected_descriptor = NULL;
+        delete descriptor;
       }
     } else {
       OLA_FATAL << "HUP event for " << epoll_data
@@ -400,29 +453,65 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
     }
   }
 
-  if (event->events & EPOLLOUT) {
+  if ((event->events & EPOLLOUT) && epoll_data->generation == generation) {
     // epoll_data->write_descriptor may be null here if this descriptor was
-    // removed between when kevent returned and now.
+    // removed between when epoll_wait returned and now.
     if (epoll_data->write_descriptor) {
       epoll_data->write_descriptor->PerformWrite();
     }
   }
 }
 
-std::pair<EPollData*, bool> EPoller::LookupOrCreateDescriptor(int fd) {
-  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
-      DescriptorMap::value_type(fd, NULL));
-  bool new_descriptor = result.second;
+/*
+ * Return the EPollData for an fd, or NULL if the page hasn't been allocated.
+ */
+EPollData *EPoller::LookupDescriptor(int fd) const {
+  const unsigned int page = static_cast<unsigned int>(fd) >> PAGE_BITS;
+  if (fd < 0 || page >= m_pages.size() || !m_pages[page]) {
+    return NULL;
+  }
+  return &m_pages[page][fd & ((1 << PAGE_BITS) - 1)];
+}
+
+/*
+ * Return the EPollData for an fd, allocating the page if required.
+ */
+EPollData *EPoller::LookupOrCreateDescriptor(int fd) {
+  const unsigned int page = static_cast<unsigned int>(fd) >> PAGE_BITS;
+  if (page >= m_pages.size()) {
+    m_pages.resize(page + 1, NULL);
+  }
+
+  if (!m_pages[page]) {
+    const unsigned int page_size = 1 << PAGE_BITS;
+    void *memory = NULL;
+    if (posix_memalign(&memory, sizeof(EPollData),
+                       page_size * sizeof(EPollData))) {
+      OLA_WARN << "Failed to allocate descriptor table for " << fd;
+      return NULL;
+    }
+    EPollData *descriptors = static_cast<EPollData*>(memory);
+    for (unsigned int i = 0; i < page_size; i++) {
+      new (&descriptors[i]) EPollData();
+    }
+    m_pages[page] = descriptors;
+  }
+  return &m_pages[page][fd & ((1 << PAGE_BITS) - 1)];
+}
 
+/*
+ * Add or update the fd in the epoll set.
+ */
+bool EPoller::Register(int fd, EPollData *epoll_data, bool new_descriptor) {
   if (new_descriptor) {
-    if (m_free_descriptors.empty()) {
-      result.first->second = new EPollData();
-    } else {
-      result.first->second = m_free_descriptors.back();
-      m_free_descriptors.pop_back();
+    if (!AddEvent(m_epoll_fd, fd, epoll_data)) {
+      epoll_data->Reset();
+      return false;
     }
+    return true;
+  } else {
+    return UpdateEvent(m_epoll_fd, fd, epoll_data);
   }
-  return std::make_pair(result.first->second, new_descriptor);
 }
 
 bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
@@ -431,8 +520,8 @@ bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
     return false;
   }
 
-  EPollData *epoll_data = STLFindOrNull(m_descriptor_map, fd);
-  if (!epoll_data) {
+  EPollData *epoll_data = LookupDescriptor(fd);
+  if (!epoll_data || !epoll_data->events) {
     if (warn_on_missing) {
       OLA_WARN << "Couldn't find EPollData for " << fd;
     }
@@ -450,8 +539,7 @@ bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
 
   if (epoll_data->events == 0) {
     RemoveEvent(m_epoll_fd, fd);
-    m_orphaned_descriptors.push_back(
-        STLLookupAndRemovePtr(&m_descriptor_map, fd));
+    epoll_data->Reset();
   } else {
     return UpdateEvent(m_epoll_fd, fd, epoll_data);
   }
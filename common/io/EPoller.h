@@ -27,10 +27,9 @@
 #include <ola/io/Descriptor.h>
 #include <sys/epoll.h>
 
-#include <map>
-#include <set>
+#include <stdint.h>
+
 #include <string>
-#include <utility>
 #include <vector>
 
 #include "common/io/PollerInterface.h"
@@ -47,6 +46,11 @@ class EPollData;
  *
  * epoll() is more efficient than select() but only newer Linux systems support
  * it.
+ *
+ * The state for each file descriptor is kept in a table indexed by the fd, so
+ * adding and removing descriptors doesn't allocate once the table has grown
+ * to cover the fds in use. Read descriptors that are edge triggered, and
+ * don't share their fd with a write descriptor, are registered with EPOLLET.
  */
 class EPoller : public PollerInterface {
  public :
@@ -73,34 +77,34 @@ class EPoller : public PollerInterface {
   bool Poll(TimeoutManager *timeout_manager,
             const TimeInterval &poll_interval);
 
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
+  unsigned int ReadyCount() const { return m_ready_count; }
+
  private:
-  typedef std::map<int, EPollData*> DescriptorMap;
-  typedef std::vector<EPollData*> DescriptorList;
-
-  DescriptorMap m_descriptor_map;
-
-  // EPoller is re-enterant. Remove may be called while we hold a pointer to an
-  // EPollData. To avoid deleting data out from underneath ourselves, we
-  // instead move the removed descriptors to this list and then clean them up
-  // outside the callback loop.
-  DescriptorList m_orphaned_descriptors;
-  // A list of pre-allocated descriptors we can use.
-  DescriptorList m_free_descriptors;
+  // The table is split into pages, which are allocated as they're needed and
+  // never move, so an EPollData pointer remains valid until we're destroyed.
+  std::vector<EPollData*> m_pages;
+  std::vector<struct epoll_event> m_events;
   ExportMap *m_export_map;
   CounterVariable *m_loop_iterations;
   CounterVariable *m_loop_time;
+  LoopProfiler *m_profiler;
+  unsigned int m_ready_count;
   int m_epoll_fd;
   Clock *m_clock;
   TimeStamp m_wake_up_time;
 
-  std::pair<EPollData*, bool> LookupOrCreateDescriptor(int fd);
+  EPollData *LookupDescriptor(int fd) const;
+  EPollData *LookupOrCreateDescriptor(int fd);
+  bool Register(int fd, EPollData *descriptor, bool new_descriptor);
 
   bool RemoveDescriptor(int fd, int event, bool warn_on_missing);
   void CheckDescriptor(struct epoll_event *event, EPollData *descriptor);
 
   static const int MAX_EVENTS;
   static const int READ_FLAGS;
-  static const unsigned int MAX_FREE_DESCRIPTORS;
+  static const unsigned int PAGE_BITS;
 
   DISALLOW_COPY_AND_ASSIGN(EPoller);
 };
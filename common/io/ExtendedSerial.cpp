@@ -25,6 +25,7 @@
 #include <config.h>
 #endif  // HAVE_CONFIG_H
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -62,17 +63,23 @@
 #include <asm/termios.h>
 #endif  // HAVE_ASM_TERMIOS_H
 
+#ifdef HAVE_LINUX_SERIAL_H
+#include <linux/serial.h>
+#endif  // HAVE_LINUX_SERIAL_H
+
 #include <ola/Logging.h>
 
 namespace ola {
 namespace io {
 
 bool LinuxHelper::SetDmxBaud(int fd) {
+  return SetBaud(fd, 250000);
+}
+
+bool LinuxHelper::SetBaud(int fd, unsigned int rate, bool quiet) {
 #if (defined(HAVE_STROPTS_H) || \
      (defined(HAVE_SYS_IOCTL_H) && defined(HAVE_ASM_TERMBITS_H))) && \
     defined(HAVE_TERMIOS2)
-  static const int rate = 250000;
-
   struct termios2 tio;  // linux-specific terminal stuff
 
   if (ioctl(fd, TCGETS2, &tio) < 0) {
@@ -89,7 +96,7 @@ bool LinuxHelper::SetDmxBaud(int fd) {
     return false;
   }
 
-  if (LogLevel() >= OLA_LOG_INFO) {
+  if (!quiet && LogLevel() >= OLA_LOG_INFO) {
     if (ioctl(fd, TCGETS2, &tio) < 0) {
        OLA_INFO << "Error getting altered settings from port";
     } else {
@@ -109,9 +116,40 @@ bool LinuxHelper::SetDmxBaud(int fd) {
            << "termios2";
   return false;
   (void) fd;
+  (void) rate;
+  (void) quiet;
 #endif  // (defined(HAVE_STROPTS_H) ||
 //  (defined(HAVE_SYS_IOCTL_H) && defined(HAVE_ASM_TERMBITS_H))) &&
 // defined(HAVE_TERMIOS2)
 }
+
+bool LinuxHelper::SetRS485(int fd, bool enable,
+                           unsigned int delay_before_send,
+                           unsigned int delay_after_send) {
+#if defined(HAVE_LINUX_SERIAL_H) && defined(TIOCSRS485)
+  struct serial_rs485 rs485;
+  memset(&rs485, 0, sizeof(rs485));
+  if (enable) {
+    rs485.flags = SER_RS485_ENABLED | SER_RS485_RTS_ON_SEND;
+    rs485.delay_rts_before_send = delay_before_send;
+    rs485.delay_rts_after_send = delay_after_send;
+  }
+
+  if (ioctl(fd, TIOCSRS485, &rs485) < 0) {
+    OLA_WARN << "Failed to set RS-485 mode on " << fd << ": "
+             << strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  if (enable) {
+    OLA_WARN << "RS-485 direction control isn't supported on this platform";
+  }
+  return !enable;
+  (void) fd;
+  (void) delay_before_send;
+  (void) delay_after_send;
+#endif  // defined(HAVE_LINUX_SERIAL_H) && defined(TIOCSRS485)
+}
 }  // namespace io
 }  // namespace ola
@@ -0,0 +1,700 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.cpp
+ * A Poller which uses io_uring
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "common/io/IOUringPoller.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace io {
+
+using std::pair;
+
+/*
+ * Represents a FD
+ */
+class IOUringData {
+ public:
+  IOUringData()
+      : events(0),
+        armed_events(0),
+        removed(false),
+        cancel_pending(false),
+        read_descriptor(NULL),
+        write_descriptor(NULL),
+        connected_descriptor(NULL),
+        delete_connected_on_close(false) {
+  }
+
+  int fd;
+  uint32_t events;  // the events we want
+  uint32_t armed_events;  // the events of the outstanding request, if any
+  bool removed;
+  bool cancel_pending;  // the poll request still needs to be cancelled
+  ReadFileDescriptor *read_descriptor;
+  WriteFileDescriptor *write_descriptor;
+  ConnectedDescriptor *connected_descriptor;
+  bool delete_connected_on_close;
+};
+
+namespace {
+
+/*
+ * The kernel expects the poll mask in little endian order.
+ */
+uint32_t PollMask(uint32_t events) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+  return (events << 16) | (events >> 16);
+#else
+  return events;
+#endif  // __BYTE_ORDER
+}
+
+uint64_t UserData(IOUringData *data) {
+  return reinterpret_cast<uintptr_t>(data);
+}
+
+// Completions for requests with no user data are ignored.
+const uint64_t NO_USER_DATA = 0;
+}  // namespace
+
+/**
+ * @brief The number of submission queue entries.
+ */
+const unsigned int IOUringPoller::RING_ENTRIES = 256;
+
+/**
+ * @brief the poll flags used for read descriptors.
+ */
+const uint32_t IOUringPoller::READ_FLAGS = POLLIN | POLLRDHUP;
+
+/**
+ * @brief the poll flags used for write descriptors.
+ */
+const uint32_t IOUringPoller::WRITE_FLAGS = POLLOUT;
+
+IOUringPoller::IOUringPoller(ExportMap *export_map, Clock* clock)
+    : m_export_map(export_map),
+      m_loop_iterations(NULL),
+      m_loop_time(NULL),
+      m_clock(clock),
+      m_ring_fd(INVALID_DESCRIPTOR),
+      m_sq_ring(MAP_FAILED),
+      m_sq_ring_size(0),
+      m_cq_ring(MAP_FAILED),
+      m_cq_ring_size(0),
+      m_sqes(NULL),
+      m_sqes_size(0),
+      m_sq_head(NULL),
+      m_sq_tail(NULL),
+      m_sq_mask(NULL),
+      m_sq_array(NULL),
+      m_sq_entries(0),
+      m_cq_head(NULL),
+      m_cq_tail(NULL),
+      m_cq_mask(NULL),
+      m_cqes(NULL) {
+  if (m_export_map) {
+    m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
+    m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+  }
+}
+
+IOUringPoller::~IOUringPoller() {
+  // Closing the ring cancels any outstanding requests.
+  CleanupRing();
+
+  {
+    DescriptorMap::iterator iter = m_descriptor_map.begin();
+    for (; iter != m_descriptor_map.end(); ++iter) {
+      if (iter->second->delete_connected_on_close) {
+        delete iter->second->connected_descriptor;
+      }
+      delete iter->second;
+    }
+  }
+
+  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
+  for (; iter != m_orphaned_descriptors.end(); ++iter) {
+    if ((*iter)->delete_connected_on_close) {
+      delete (*iter)->connected_descriptor;
+    }
+    delete *iter;
+  }
+}
+
+bool IOUringPoller::Init() {
+  if (m_ring_fd != INVALID_DESCRIPTOR) {
+    return true;
+  }
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+  if (fd < 0) {
+    OLA_WARN << "io_uring_setup failed: " << strerror(errno);
+    return false;
+  }
+  m_ring_fd = fd;
+
+  if (fcntl(m_ring_fd, F_SETFD, FD_CLOEXEC) < 0) {
+    OLA_WARN << "Failed to set FD_CLOEXEC on the io_uring: "
+             << strerror(errno);
+  }
+
+  if (!(params.features & IORING_FEAT_EXT_ARG)) {
+    OLA_WARN << "io_uring doesn't support IORING_ENTER_EXT_ARG, Linux 5.11 "
+             << "or later is required";
+    CleanupRing();
+    return false;
+  }
+
+  m_sq_ring_size = params.sq_off.array +
+                   params.sq_entries * sizeof(unsigned int);
+  m_cq_ring_size = params.cq_off.cqes +
+                   params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    m_sq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+    m_cq_ring_size = 0;
+  }
+
+  m_sq_ring = mmap(NULL, m_sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+  if (m_sq_ring == MAP_FAILED) {
+    OLA_WARN << "Failed to map the io_uring submission queue: "
+             << strerror(errno);
+    CleanupRing();
+    return false;
+  }
+
+  void *cq_ring = m_sq_ring;
+  if (m_cq_ring_size) {
+    m_cq_ring = mmap(NULL, m_cq_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+    if (m_cq_ring == MAP_FAILED) {
+      OLA_WARN << "Failed to map the io_uring completion queue: "
+               << strerror(errno);
+      CleanupRing();
+      return false;
+    }
+    cq_ring = m_cq_ring;
+  }
+
+  m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void *sqes = mmap(NULL, m_sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    OLA_WARN << "Failed to map the io_uring submission entries: "
+             << strerror(errno);
+    CleanupRing();
+    return false;
+  }
+  m_sqes = reinterpret_cast<struct io_uring_sqe*>(sqes);
+
+  uint8_t *sq = reinterpret_cast<uint8_t*>(m_sq_ring);
+  m_sq_head = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+  m_sq_tail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+  m_sq_mask = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+  m_sq_array = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+  m_sq_entries = params.sq_entries;
+
+  uint8_t *cq = reinterpret_cast<uint8_t*>(cq_ring);
+  m_cq_head = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+  m_cq_tail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+  m_cq_mask = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+  m_cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+  m_completions.reserve(params.cq_entries);
+  return true;
+}
+
+bool IOUringPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+  if (result.first->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->events |= READ_FLAGS;
+  result.first->read_descriptor = descriptor;
+  return UpdatePoll(result.first);
+}
+
+bool IOUringPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
+                                      bool delete_on_close) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+
+  if (result.first->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->events |= READ_FLAGS;
+  result.first->connected_descriptor = descriptor;
+  result.first->delete_connected_on_close = delete_on_close;
+  return UpdatePoll(result.first);
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "AddWriteDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->WriteDescriptor());
+
+  if (result.first->events & WRITE_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
+             << " already in write set";
+    return false;
+  }
+
+  result.first->events |= WRITE_FLAGS;
+  result.first->write_descriptor = descriptor;
+  return UpdatePoll(result.first);
+}
+
+bool IOUringPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->WriteDescriptor(), WRITE_FLAGS, true);
+}
+
+bool IOUringPoller::Poll(TimeoutManager *timeout_manager,
+                         const TimeInterval &poll_interval) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  TimeInterval sleep_interval = poll_interval;
+  // Update the wake up time before running the timeouts, so they see the
+  // current time.
+  const TimeStamp last_wake_up = m_wake_up_time;
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
+
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(
+      &m_wake_up_time);
+  if (!next_event_in.IsZero()) {
+    sleep_interval = std::min(next_event_in, sleep_interval);
+  }
+
+  // take care of stats accounting
+  if (last_wake_up.IsSet()) {
+    TimeInterval loop_time = m_wake_up_time - last_wake_up;
+    OLA_DEBUG << "ss process time was " << loop_time.ToString();
+    if (m_loop_time)
+      (*m_loop_time) += loop_time.AsInt();
+    if (m_loop_iterations)
+      (*m_loop_iterations)++;
+  }
+
+  // If we haven't been asked to wait as part of the poll interval, then don't
+  // wait to allow for fast streaming
+  bool wait = sleep_interval.InMilliSeconds() != 0;
+  if (!Submit(wait ? 1 : 0, &sleep_interval)) {
+    return false;
+  }
+
+  ReapCompletions();
+  CancelPendingPolls();
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
+
+  if (m_completions.empty()) {
+    timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+    return true;
+  }
+
+  std::vector<struct io_uring_cqe>::const_iterator cqe_iter =
+      m_completions.begin();
+  for (; cqe_iter != m_completions.end(); ++cqe_iter) {
+    if (cqe_iter->user_data == NO_USER_DATA) {
+      continue;
+    }
+
+    IOUringData *data = reinterpret_cast<IOUringData*>(
+        static_cast<uintptr_t>(cqe_iter->user_data));
+    data->armed_events = 0;
+    if (data->removed) {
+      continue;
+    }
+
+    if (cqe_iter->res < 0) {
+      OLA_WARN << "io_uring poll for " << data->fd << " failed: "
+               << strerror(-cqe_iter->res);
+      continue;
+    }
+
+    m_rearm_descriptors.push_back(data);
+    CheckDescriptor(cqe_iter->res, data);
+  }
+
+  // Re-arm the descriptors we serviced, the requests are sent on the next
+  // call to Poll().
+  DescriptorList::iterator iter = m_rearm_descriptors.begin();
+  for (; iter != m_rearm_descriptors.end(); ++iter) {
+    if (!(*iter)->removed) {
+      UpdatePoll(*iter);
+    }
+  }
+  m_rearm_descriptors.clear();
+
+  // Now that we're out of the callback phase, clean up descriptors that were
+  // removed and have no requests outstanding.
+  iter = m_orphaned_descriptors.begin();
+  while (iter != m_orphaned_descriptors.end()) {
+    if ((*iter)->armed_events || (*iter)->cancel_pending) {
+      ++iter;
+    } else {
+      delete *iter;
+      iter = m_orphaned_descriptors.erase(iter);
+    }
+  }
+
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
+  timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+  return true;
+}
+
+
+/*
+ * Check the events for a descriptor:
+ *  - Execute the callback for descriptors with data
+ *  - Execute OnClose if a remote end closed the connection
+ */
+void IOUringPoller::CheckDescriptor(uint32_t events, IOUringData *data) {
+  if (events & (POLLHUP | POLLRDHUP)) {
+    if (data->read_descriptor) {
+      data->read_descriptor->PerformRead();
+    } else if (data->write_descriptor) {
+      data->write_descriptor->PerformWrite();
+    } else if (data->connected_descriptor) {
+      ConnectedDescriptor::OnCloseCallback *on_close =
+          data->connected_descriptor->TransferOnClose();
+      if (on_close)
+        on_close->Run();
+
+      // At this point the descriptor may be sitting in the orphan list if the
+      // OnClose handler called into RemoveReadDescriptor()
+      if (data->delete_connected_on_close && data->connected_descriptor) {
+        bool removed = RemoveDescriptor(
+            data->connected_descriptor->ReadDescriptor(), READ_FLAGS, false);
+        if (removed && m_export_map) {
+          (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
+        }
+        delete data->connected_descriptor;
+        data->connected_descriptor = NULL;
+      }
+    } else {
+      OLA_FATAL << "HUP event for " << data
+                << " but no write or connected descriptor found!";
+    }
+    return;
+  }
+
+  if (events & POLLIN) {
+    if (data->read_descriptor) {
+      data->read_descriptor->PerformRead();
+    } else if (data->connected_descriptor) {
+      data->connected_descriptor->PerformRead();
+    }
+  }
+
+  if (events & POLLOUT) {
+    // data->write_descriptor may be null here if this descriptor was removed
+    // by the read callback.
+    if (data->write_descriptor) {
+      data->write_descriptor->PerformWrite();
+    }
+  }
+}
+
+std::pair<IOUringData*, bool> IOUringPoller::LookupOrCreateDescriptor(
+    int fd) {
+  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
+      DescriptorMap::value_type(fd, NULL));
+  bool new_descriptor = result.second;
+
+  if (new_descriptor) {
+    result.first->second = new IOUringData();
+    result.first->second->fd = fd;
+  }
+  return std::make_pair(result.first->second, new_descriptor);
+}
+
+/*
+ * Queue a request so the outstanding poll matches the events we want.
+ */
+bool IOUringPoller::UpdatePoll(IOUringData *data) {
+  if (data->armed_events == data->events) {
+    return true;
+  }
+
+  struct io_uring_sqe *sqe = GetSQE();
+  if (!sqe) {
+    return false;
+  }
+
+  if (data->armed_events) {
+    // Update the events of the outstanding poll. If it's already completed
+    // this fails, and we'll re-arm once the completion is handled.
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->addr = UserData(data);
+    sqe->len = IORING_POLL_UPDATE_EVENTS;
+    sqe->user_data = NO_USER_DATA;
+  } else {
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = data->fd;
+    sqe->user_data = UserData(data);
+  }
+  sqe->poll32_events = PollMask(data->events);
+  data->armed_events = data->events;
+  return true;
+}
+
+bool IOUringPoller::RemoveDescriptor(int fd, uint32_t events,
+                                     bool warn_on_missing) {
+  if (fd == INVALID_DESCRIPTOR) {
+    OLA_WARN << "Attempt to remove an invalid file descriptor";
+    return false;
+  }
+
+  IOUringData *data = STLFindOrNull(m_descriptor_map, fd);
+  if (!data) {
+    if (warn_on_missing) {
+      OLA_WARN << "Couldn't find IOUringData for " << fd;
+    }
+    return false;
+  }
+
+  data->events &= (~events);
+
+  if (events & WRITE_FLAGS) {
+    data->write_descriptor = NULL;
+  } else if (events & POLLIN) {
+    data->read_descriptor = NULL;
+    data->connected_descriptor = NULL;
+  }
+
+  if (data->events) {
+    return UpdatePoll(data);
+  }
+
+  data->removed = true;
+  m_orphaned_descriptors.push_back(
+      STLLookupAndRemovePtr(&m_descriptor_map, fd));
+
+  if (data->armed_events) {
+    // The poll request holds a reference to the file, so cancel it right
+    // away rather than waiting for the next call to Poll().
+    if (CancelPoll(data)) {
+      Submit(0, NULL);
+    } else {
+      // The submission queue is full, try again once the completions have
+      // been reaped.
+      data->cancel_pending = true;
+      m_pending_cancels.push_back(data);
+    }
+  }
+  return true;
+}
+
+/*
+ * Queue a request to cancel the outstanding poll for a descriptor.
+ * @returns false if the submission queue is full.
+ */
+bool IOUringPoller::CancelPoll(IOUringData *data) {
+  struct io_uring_sqe *sqe = GetSQE();
+  if (!sqe) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->addr = UserData(data);
+  sqe->user_data = NO_USER_DATA;
+  return true;
+}
+
+/*
+ * Queue the cancels that didn't fit in the submission queue when the
+ * descriptor was removed. They're sent with the next batch of requests.
+ */
+void IOUringPoller::CancelPendingPolls() {
+  DescriptorList::iterator iter = m_pending_cancels.begin();
+  for (; iter != m_pending_cancels.end(); ++iter) {
+    IOUringData *data = *iter;
+    // The poll may have completed in the meantime, then there's nothing to
+    // cancel.
+    if (data->armed_events && !CancelPoll(data)) {
+      break;
+    }
+    data->cancel_pending = false;
+  }
+  m_pending_cancels.erase(m_pending_cancels.begin(), iter);
+}
+
+/*
+ * Get the next free submission queue entry, or NULL if the queue is full.
+ */
+struct io_uring_sqe *IOUringPoller::GetSQE() {
+  unsigned int tail = *m_sq_tail;
+  if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) == m_sq_entries) {
+    // Flush what we have so far.
+    Submit(0, NULL);
+    if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) == m_sq_entries) {
+      OLA_WARN << "io_uring submission queue is full";
+      return NULL;
+    }
+  }
+
+  unsigned int index = tail & *m_sq_mask;
+  struct io_uring_sqe *sqe = &m_sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  m_sq_array[index] = index;
+  __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+  return sqe;
+}
+
+/*
+ * Submit any queued requests, and optionally wait for completions.
+ * @param wait_for the number of completions to wait for
+ * @param timeout the maximum time to wait, if wait_for is non-0.
+ */
+bool IOUringPoller::Submit(unsigned int wait_for,
+                           const TimeInterval *timeout) {
+  unsigned int to_submit = *m_sq_tail -
+      __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+  if (!to_submit && !wait_for) {
+    return true;
+  }
+
+  unsigned int flags = 0;
+  struct io_uring_getevents_arg arg;
+  struct __kernel_timespec ts;
+  memset(&arg, 0, sizeof(arg));
+  if (wait_for) {
+    flags |= IORING_ENTER_GETEVENTS;
+    if (timeout) {
+      ts.tv_sec = timeout->Seconds();
+      ts.tv_nsec = static_cast<int64_t>(timeout->MicroSeconds()) *
+                   ONE_THOUSAND;
+      arg.ts = reinterpret_cast<uintptr_t>(&ts);
+      flags |= IORING_ENTER_EXT_ARG;
+    }
+  }
+
+  int r = syscall(__NR_io_uring_enter, m_ring_fd, to_submit, wait_for, flags,
+                  (flags & IORING_ENTER_EXT_ARG) ? &arg : NULL,
+                  sizeof(arg));
+  if (r < 0) {
+    switch (errno) {
+      case ETIME:
+      case EINTR:
+      case EAGAIN:
+      case EBUSY:
+        return true;
+      default:
+        OLA_WARN << "io_uring_enter() error, " << strerror(errno);
+        return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Copy the completions into m_completions. Callbacks may add new requests so
+ * we release the entries before running them.
+ */
+void IOUringPoller::ReapCompletions() {
+  m_completions.clear();
+  unsigned int head = *m_cq_head;
+  unsigned int tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    m_completions.push_back(m_cqes[head & *m_cq_mask]);
+  }
+  __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+}
+
+void IOUringPoller::CleanupRing() {
+  if (m_sqes) {
+    munmap(m_sqes, m_sqes_size);
+    m_sqes = NULL;
+  }
+  if (m_cq_ring != MAP_FAILED) {
+    munmap(m_cq_ring, m_cq_ring_size);
+    m_cq_ring = MAP_FAILED;
+  }
+  if (m_sq_ring != MAP_FAILED) {
+    munmap(m_sq_ring, m_sq_ring_size);
+    m_sq_ring = MAP_FAILED;
+  }
+  if (m_ring_fd != INVALID_DESCRIPTOR) {
+    close(m_ring_fd);
+    m_ring_fd = INVALID_DESCRIPTOR;
+  }
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,148 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.h
+ * A Poller which uses io_uring
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_IO_IOURINGPOLLER_H_
+#define COMMON_IO_IOURINGPOLLER_H_
+
+#include <linux/io_uring.h>
+#include <ola/base/Macro.h>
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/io/Descriptor.h>
+#include <stdint.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/TimeoutManager.h"
+
+namespace ola {
+namespace io {
+
+class IOUringData;
+
+/**
+ * @class IOUringPoller
+ * @brief An implementation of PollerInterface that uses io_uring.
+ *
+ * Each descriptor has a single poll request outstanding on the ring. Adding,
+ * removing and re-arming descriptors only queues submission entries, they're
+ * all sent to the kernel by the same io_uring_enter() call that waits for
+ * events, so a loop iteration costs one system call no matter how many
+ * descriptors are active.
+ *
+ * Poll requests are one-shot and re-armed after the descriptor has been
+ * serviced. Multishot polls are edge triggered, which doesn't work for
+ * handlers that only read one datagram per PerformRead() call.
+ *
+ * This requires Linux 5.11 or later, Init() will fail on older kernels.
+ */
+class IOUringPoller : public PollerInterface {
+ public :
+  /**
+   * @brief Create a new IOUringPoller.
+   * @param export_map the ExportMap to use
+   * @param clock the Clock to use
+   */
+  IOUringPoller(ExportMap *export_map, Clock *clock);
+
+  ~IOUringPoller();
+
+  /**
+   * @brief Set up the ring.
+   * @returns true if io_uring is available, false otherwise.
+   */
+  bool Init();
+
+  bool AddReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool AddReadDescriptor(class ConnectedDescriptor *descriptor,
+                         bool delete_on_close);
+  bool RemoveReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool RemoveReadDescriptor(class ConnectedDescriptor *descriptor);
+
+  bool AddWriteDescriptor(class WriteFileDescriptor *descriptor);
+  bool RemoveWriteDescriptor(class WriteFileDescriptor *descriptor);
+
+  const TimeStamp *WakeUpTime() const { return &m_wake_up_time; }
+
+  bool Poll(TimeoutManager *timeout_manager,
+            const TimeInterval &poll_interval);
+
+ private:
+  typedef std::map<int, IOUringData*> DescriptorMap;
+  typedef std::vector<IOUringData*> DescriptorList;
+
+  DescriptorMap m_descriptor_map;
+
+  // Descriptors that have been removed. We can't delete them until the kernel
+  // has completed the poll request that refers to them.
+  DescriptorList m_orphaned_descriptors;
+  // Descriptors which need their poll request re-armed.
+  DescriptorList m_rearm_descriptors;
+  // Removed descriptors whose poll request couldn't be cancelled because the
+  // submission queue was full.
+  DescriptorList m_pending_cancels;
+  ExportMap *m_export_map;
+  CounterVariable *m_loop_iterations;
+  CounterVariable *m_loop_time;
+  Clock *m_clock;
+  TimeStamp m_wake_up_time;
+
+  int m_ring_fd;
+  void *m_sq_ring;
+  size_t m_sq_ring_size;
+  void *m_cq_ring;
+  size_t m_cq_ring_size;
+  struct io_uring_sqe *m_sqes;
+  size_t m_sqes_size;
+  unsigned int *m_sq_head;
+  unsigned int *m_sq_tail;
+  unsigned int *m_sq_mask;
+  unsigned int *m_sq_array;
+  unsigned int m_sq_entries;
+  unsigned int *m_cq_head;
+  unsigned int *m_cq_tail;
+  unsigned int *m_cq_mask;
+  struct io_uring_cqe *m_cqes;
+  std::vector<struct io_uring_cqe> m_completions;
+
+  std::pair<IOUringData*, bool> LookupOrCreateDescriptor(int fd);
+  bool UpdatePoll(IOUringData *data);
+  bool RemoveDescriptor(int fd, uint32_t events, bool warn_on_missing);
+  bool CancelPoll(IOUringData *data);
+  void CancelPendingPolls();
+  void CheckDescriptor(uint32_t events, IOUringData *data);
+
+  struct io_uring_sqe *GetSQE();
+  bool Submit(unsigned int wait_for, const TimeInterval *timeout);
+  void ReapCompletions();
+  void CleanupRing();
+
+  static const unsigned int RING_ENTRIES;
+  static const uint32_t READ_FLAGS;
+  static const uint32_t WRITE_FLAGS;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringPoller);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_IOURINGPOLLER_H_
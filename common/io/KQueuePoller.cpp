@@ -77,9 +77,14 @@ class KQueueData {
 };
 
 /**
- * @brief The maximum number of events to return in one epoll cycle
+ * @brief The initial number of events to return in one kevent cycle.
  */
-const int KQueuePoller::MAX_EVENTS = 10;
+const unsigned int KQueuePoller::MIN_EVENTS = 16;
+
+/**
+ * @brief The limit on the number of events to return in one kevent cycle.
+ */
+const unsigned int KQueuePoller::MAX_EVENTS = 1024;
 
 /**
  * @brief The number of pre-allocated KQueueData to have.
@@ -91,13 +96,14 @@ KQueuePoller::KQueuePoller(ExportMap *export_map, Clock* clock)
       m_loop_iterations(NULL),
       m_loop_time(NULL),
       m_kqueue_fd(INVALID_DESCRIPTOR),
-      m_next_change_entry(0),
       m_clock(clock) {
   if (m_export_map) {
     m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
     m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
   }
 
+  m_events.resize(MIN_EVENTS);
+
   m_kqueue_fd = kqueue();
   if (m_kqueue_fd < 0) {
     OLA_FATAL << "Failed to create new kqueue";
@@ -152,8 +158,9 @@ bool KQueuePoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
 
   kqueue_data->enable_read = true;
   kqueue_data->read_descriptor = descriptor;
-  return ApplyChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD,
-                     kqueue_data, false);
+  QueueChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD,
+              kqueue_data);
+  return true;
 }
 
 bool KQueuePoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
@@ -181,8 +188,9 @@ bool KQueuePoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
   kqueue_data->enable_read = true;
   kqueue_data->connected_descriptor = descriptor;
   kqueue_data->delete_connected_on_close = delete_on_close;
-  return ApplyChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD,
-                     kqueue_data, false);
+  QueueChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD,
+              kqueue_data);
+  return true;
 }
 
 bool KQueuePoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
@@ -215,8 +223,9 @@ bool KQueuePoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
 
   kqueue_data->enable_write = true;
   kqueue_data->write_descriptor = descriptor;
-  return ApplyChange(descriptor->WriteDescriptor(), EVFILT_WRITE, EV_ADD,
-                     kqueue_data, false);
+  QueueChange(descriptor->WriteDescriptor(), EVFILT_WRITE, EV_ADD,
+              kqueue_data);
+  return true;
 }
 
 bool KQueuePoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
@@ -229,20 +238,21 @@ bool KQueuePoller::Poll(TimeoutManager *timeout_manager,
     return false;
   }
 
-  struct kevent events[MAX_EVENTS];
-
   TimeInterval sleep_interval = poll_interval;
-  TimeStamp now;
-  m_clock->CurrentMonotonicTime(&now);
+  // Update the wake up time before running the timeouts, so they see the
+  // current time.
+  const TimeStamp last_wake_up = m_wake_up_time;
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
 
-  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(
+      &m_wake_up_time);
   if (!next_event_in.IsZero()) {
     sleep_interval = std::min(next_event_in, sleep_interval);
   }
 
   // take care of stats accounting
-  if (m_wake_up_time.IsSet()) {
-    TimeInterval loop_time = now - m_wake_up_time;
+  if (last_wake_up.IsSet()) {
+    TimeInterval loop_time = m_wake_up_time - last_wake_up;
     OLA_DEBUG << "ss process time was " << loop_time.ToString();
     if (m_loop_time)
       (*m_loop_time) += loop_time.AsInt();
@@ -255,10 +265,10 @@ bool KQueuePoller::Poll(TimeoutManager *timeout_manager,
   sleep_time.tv_nsec = sleep_interval.MicroSeconds() * 1000;
 
   int ready = kevent(
-      m_kqueue_fd, reinterpret_cast<struct kevent*>(m_change_set),
-      m_next_change_entry, events, MAX_EVENTS, &sleep_time);
+      m_kqueue_fd, m_changes.empty() ? NULL : &m_changes[0], m_changes.size(),
+      &m_events[0], m_events.size(), &sleep_time);
 
-  m_next_change_entry = 0;
+  m_changes.clear();
 
   if (ready == 0) {
     m_clock->CurrentMonotonicTime(&m_wake_up_time);
@@ -274,14 +284,29 @@ bool KQueuePoller::Poll(TimeoutManager *timeout_manager,
   m_clock->CurrentMonotonicTime(&m_wake_up_time);
 
   for (int i = 0; i < ready; i++) {
-    if (events[i].flags & EV_ERROR) {
-      OLA_WARN << "Error from kqueue on fd: " << events[i].ident << ": "
-               << strerror(events[i].data);
+    struct kevent *event = &m_events[i];
+    if (event->flags & EV_ERROR) {
+      // Changes are deferred, so the descriptor may have been closed, which
+      // removes it from the kqueue, before the change was submitted.
+      if (event->data == ENOENT || event->data == EBADF) {
+        OLA_DEBUG << "Stale kqueue change for fd: " << event->ident << ": "
+                  << strerror(event->data);
+      } else {
+        OLA_WARN << "Error from kqueue on fd: " << event->ident << ": "
+                 << strerror(event->data);
+      }
     } else {
-      CheckDescriptor(&events[i]);
+      CheckDescriptor(event);
     }
   }
 
+  if (static_cast<unsigned int>(ready) == m_events.size() &&
+      m_events.size() < MAX_EVENTS) {
+    // There may be more events waiting, make room for them next time.
+    m_events.resize(std::min(2 * m_events.size(),
+                             static_cast<size_t>(MAX_EVENTS)));
+  }
+
   // Now that we're out of the callback phase, clean up descriptors that were
   // removed.
   DescriptorList::iterator iter = m_orphaned_descriptors.begin();
@@ -377,26 +402,19 @@ std::pair<KQueueData*, bool> KQueuePoller::LookupOrCreateDescriptor(
   return std::make_pair(result.first->second, new_descriptor);
 }
 
-bool KQueuePoller::ApplyChange(int fd, int16_t filter, uint16_t flags,
-                               KQueueData *descriptor,
-                               bool apply_immediately) {
+/*
+ * Queue a change, it's submitted with the next call to kevent().
+ */
+void KQueuePoller::QueueChange(int fd, int16_t filter, uint16_t flags,
+                               KQueueData *descriptor) {
+  struct kevent change;
 #ifdef __NetBSD__
-  EV_SET(&m_change_set[m_next_change_entry++], fd, filter, flags, 0, 0,
+  EV_SET(&change, fd, filter, flags, 0, 0,
          reinterpret_cast<intptr_t>(descriptor));
 #else
-  EV_SET(&m_change_set[m_next_change_entry++], fd, filter, flags, 0, 0,
-         descriptor);
+  EV_SET(&change, fd, filter, flags, 0, 0, descriptor);
 #endif  // __NetBSD__
-
-  if (m_next_change_entry == CHANGE_SET_SIZE || apply_immediately) {
-    int r = kevent(m_kqueue_fd, m_change_set, m_next_change_entry, NULL, 0,
-                   NULL);
-    if (r < 0) {
-      OLA_WARN << "Failed to apply kqueue changes: " << strerror(errno);
-    }
-    m_next_change_entry = 0;
-  }
-  return true;
+  m_changes.push_back(change);
 }
 
 bool KQueuePoller::RemoveDescriptor(int fd, int16_t filter) {
@@ -428,7 +446,7 @@ bool KQueuePoller::RemoveDescriptor(int fd, int16_t filter) {
   }
 
   if (remove_from_kevent) {
-    ApplyChange(fd, filter, EV_DELETE, NULL, true);
+    QueueChange(fd, filter, EV_DELETE, NULL);
   }
 
   if (!kqueue_data->enable_read && !kqueue_data->enable_write) {
@@ -74,8 +74,6 @@ class KQueuePoller : public PollerInterface {
             const TimeInterval &poll_interval);
 
  private:
-  enum { CHANGE_SET_SIZE = 10 };
-
   typedef std::map<int, KQueueData*> DescriptorMap;
   typedef std::vector<KQueueData*> DescriptorList;
 
@@ -93,19 +91,23 @@ class KQueuePoller : public PollerInterface {
   CounterVariable *m_loop_time;
   int m_kqueue_fd;
 
-  struct kevent m_change_set[CHANGE_SET_SIZE];
-  unsigned int m_next_change_entry;
+  // Changes are queued up and submitted with the next call to kevent(), so a
+  // loop iteration costs one syscall however many descriptors changed.
+  std::vector<struct kevent> m_changes;
+  // Grows if kevent() fills it.
+  std::vector<struct kevent> m_events;
 
   Clock *m_clock;
   TimeStamp m_wake_up_time;
 
   void CheckDescriptor(struct kevent *event);
   std::pair<KQueueData*, bool> LookupOrCreateDescriptor(int fd);
-  bool ApplyChange(int fd, int16_t filter, uint16_t flags,
-                   KQueueData *kqueue_data, bool apply_immediately);
+  void QueueChange(int fd, int16_t filter, uint16_t flags,
+                   KQueueData *kqueue_data);
   bool RemoveDescriptor(int fd, int16_t filter);
 
-  static const int MAX_EVENTS;
+  static const unsigned int MIN_EVENTS;
+  static const unsigned int MAX_EVENTS;
   static const unsigned int MAX_FREE_DESCRIPTORS;
 
   DISALLOW_COPY_AND_ASSIGN(KQueuePoller);
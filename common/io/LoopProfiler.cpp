@@ -0,0 +1,223 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfiler.cpp
+ * Records how long the event loop and its handlers take.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/io/LoopProfiler.h"
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/strings/Format.h"
+
+namespace ola {
+namespace io {
+
+using std::string;
+using std::vector;
+
+const char LoopProfiler::K_HANDLER_TIME_VAR[] = "ss-handler-time-us";
+const char LoopProfiler::K_LOOP_TIME_VAR[] = "ss-loop-time-us";
+const char LoopProfiler::K_OVER_BUDGET_VAR[] = "ss-handlers-over-budget";
+const char LoopProfiler::K_SLOWEST_HANDLERS_VAR[] = "ss-slowest-handlers";
+const char LoopProfiler::TIMEOUT_NAME[] = "timeout";
+
+namespace {
+bool SlowerThan(const LoopProfiler::HandlerStats &a,
+                const LoopProfiler::HandlerStats &b) {
+  return a.max_us > b.max_us;
+}
+}  // namespace
+
+LoopProfiler::LoopProfiler(ExportMap *export_map, Clock *clock,
+                           const TimeInterval &budget)
+    : m_clock(clock),
+      m_heartbeat(NULL),
+      m_budget_us(budget.AsInt()),
+      m_loop_time(NULL),
+      m_handler_time(NULL),
+      m_over_budget(NULL),
+      m_slowest_handlers(NULL) {
+  if (export_map) {
+    m_loop_time = export_map->GetHistogramVar(K_LOOP_TIME_VAR);
+    m_handler_time = export_map->GetHistogramVar(K_HANDLER_TIME_VAR);
+    m_over_budget = export_map->GetShardedCounterVar(K_OVER_BUDGET_VAR);
+    m_slowest_handlers = export_map->GetStringMapVar(K_SLOWEST_HANDLERS_VAR,
+                                                     "handler");
+  }
+}
+
+
+LoopProfiler::~LoopProfiler() {
+  STLDeleteValues(&m_stats);
+}
+
+
+void LoopProfiler::SetName(const void *handler, const string &name) {
+  m_names[handler] = name;
+  m_handlers.erase(handler);
+}
+
+
+void LoopProfiler::Forget(const void *handler) {
+  m_names.erase(handler);
+  m_handlers.erase(handler);
+}
+
+
+void LoopProfiler::DescriptorDone(const void *descriptor, int fd,
+                                  const TimeStamp &start) {
+  HandlerMap::iterator iter = m_handlers.find(descriptor);
+  HandlerStats *stats;
+  if (iter == m_handlers.end()) {
+    stats = LookupStats(descriptor, "fd:" + ola::strings::IntToString(fd));
+  } else {
+    stats = iter->second;
+  }
+  Record(stats, start);
+}
+
+
+void LoopProfiler::TimeoutDone(const void *timeout, const TimeStamp &start) {
+  HandlerMap::iterator iter = m_handlers.find(timeout);
+  HandlerStats *stats;
+  if (iter == m_handlers.end()) {
+    stats = LookupStats(timeout, TIMEOUT_NAME);
+  } else {
+    stats = iter->second;
+  }
+  Record(stats, start);
+}
+
+
+void LoopProfiler::LoopDone(const TimeInterval &loop_time) {
+  if (m_loop_time) {
+    m_loop_time->Record(loop_time.AsInt());
+  }
+
+  if (!m_slowest_handlers) {
+    return;
+  }
+
+  // Sorting the handlers is relatively expensive, so only do it once a
+  // second.
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  if (m_last_export.IsSet() && now - m_last_export < TimeInterval(1, 0)) {
+    return;
+  }
+  m_last_export = now;
+  ExportSlowestHandlers();
+}
+
+
+void LoopProfiler::SlowestHandlers(unsigned int limit,
+                                   vector<HandlerStats> *stats) const {
+  vector<HandlerStats> all_stats;
+  all_stats.reserve(m_stats.size());
+  StatsMap::const_iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    all_stats.push_back(*iter->second);
+  }
+
+  const unsigned int count = std::min(
+      limit, static_cast<unsigned int>(all_stats.size()));
+  std::partial_sort(all_stats.begin(), all_stats.begin() + count,
+                    all_stats.end(), SlowerThan);
+  stats->assign(all_stats.begin(), all_stats.begin() + count);
+}
+
+
+/*
+ * Find the stats for a handler that isn't in m_handlers.
+ */
+LoopProfiler::HandlerStats *LoopProfiler::LookupStats(
+    const void *handler,
+    const string &default_name) {
+  NameMap::const_iterator name_iter = m_names.find(handler);
+  const string &name = name_iter == m_names.end() ? default_name :
+                       name_iter->second;
+
+  StatsMap::iterator iter = m_stats.find(name);
+  if (iter == m_stats.end()) {
+    HandlerStats *stats = new HandlerStats();
+    stats->name = name;
+    iter = m_stats.insert(StatsMap::value_type(name, stats)).first;
+  }
+  m_handlers[handler] = iter->second;
+  return iter->second;
+}
+
+
+void LoopProfiler::Record(HandlerStats *stats, const TimeStamp &start) {
+  TimeStamp end;
+  m_clock->CurrentMonotonicTime(&end);
+  const int64_t elapsed = (end - start).AsInt();
+  const uint64_t duration = elapsed > 0 ? elapsed : 0;
+  if (m_heartbeat) {
+    m_heartbeat->End(stats->name);
+  }
+
+  stats->count++;
+  stats->total_us += duration;
+  stats->max_us = std::max(stats->max_us, duration);
+  if (m_handler_time) {
+    m_handler_time->Record(duration);
+  }
+
+  if (m_budget_us && duration > m_budget_us) {
+    if (!stats->over_budget) {
+      OLA_WARN << "Event handler " << stats->name << " took " << duration
+               << "us, the budget is " << m_budget_us << "us";
+    }
+    stats->over_budget++;
+    if (m_over_budget) {
+      m_over_budget->Increment();
+    }
+  }
+}
+
+
+/*
+ * Update ss-slowest-handlers.
+ */
+void LoopProfiler::ExportSlowestHandlers() {
+  vector<HandlerStats> slowest;
+  SlowestHandlers(SLOWEST_HANDLERS, &slowest);
+
+  vector<string>::const_iterator name_iter = m_exported_names.begin();
+  for (; name_iter != m_exported_names.end(); ++name_iter) {
+    m_slowest_handlers->Remove(*name_iter);
+  }
+  m_exported_names.clear();
+
+  vector<HandlerStats>::const_iterator iter = slowest.begin();
+  for (; iter != slowest.end(); ++iter) {
+    std::ostringstream str;
+    str << "count=" << iter->count << " mean_us="
+        << (iter->count ? iter->total_us / iter->count : 0) << " max_us="
+        << iter->max_us << " over_budget=" << iter->over_budget;
+    m_slowest_handlers->Set(iter->name, str.str());
+    m_exported_names.push_back(iter->name);
+  }
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,187 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfiler.h
+ * Records how long the event loop and its handlers take.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_IO_LOOPPROFILER_H_
+#define COMMON_IO_LOOPPROFILER_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/util/StallWatchdog.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace io {
+
+/**
+ * @brief Records how long each iteration of the event loop takes, and how
+ * long each descriptor and timeout handler runs for.
+ *
+ * Handlers are identified by the descriptor pointer or the timeout_id. They
+ * can be given a name with SetName(), otherwise descriptors are named by
+ * their file descriptor and timeouts are grouped together. The time is
+ * accumulated per name, so the stats outlive the handler.
+ *
+ * Handlers that run for longer than the budget are counted, and logged the
+ * first time it happens.
+ *
+ * With an ExportMap, the following are exported:
+ *  - ss-loop-time-us, a histogram of the time spent handling events in each
+ *    iteration of the loop.
+ *  - ss-handler-time-us, a histogram of the time taken by each handler.
+ *  - ss-handlers-over-budget, the number of times a handler exceeded the
+ *    budget.
+ *  - ss-slowest-handlers, the handlers with the longest maximum run time.
+ *
+ * With a Heartbeat, each handler is a section of the heartbeat, so the
+ * StallWatchdog can report handlers that stall.
+ *
+ * This isn't thread safe, it should only be used from the SelectServer
+ * thread.
+ */
+class LoopProfiler {
+ public:
+  struct HandlerStats {
+   public:
+    HandlerStats()
+        : count(0),
+          total_us(0),
+          max_us(0),
+          over_budget(0) {
+    }
+
+    std::string name;
+    uint64_t count;
+    uint64_t total_us;
+    uint64_t max_us;
+    uint64_t over_budget;
+  };
+
+  /**
+   * @brief Create a new LoopProfiler.
+   * @param export_map the ExportMap to use, may be NULL.
+   * @param clock the Clock to use.
+   * @param budget handlers that take longer than this are reported.
+   */
+  LoopProfiler(ExportMap *export_map, Clock *clock,
+               const TimeInterval &budget);
+  ~LoopProfiler();
+
+  /**
+   * @brief Name a handler.
+   * @param handler the descriptor or timeout_id.
+   * @param name the name to record the time under.
+   */
+  void SetName(const void *handler, const std::string &name);
+
+  /**
+   * @brief Called when a handler is removed, since the pointer may be reused.
+   */
+  void Forget(const void *handler);
+
+  /**
+   * @brief Mark each handler as a section of a Heartbeat.
+   * @param heartbeat the Heartbeat to use, ownership is not transferred. May
+   *   be NULL.
+   */
+  void SetHeartbeat(Heartbeat *heartbeat) { m_heartbeat = heartbeat; }
+
+  /**
+   * @brief Get the time a handler starts.
+   */
+  void Start(TimeStamp *start) const {
+    m_clock->CurrentMonotonicTime(start);
+    if (m_heartbeat) {
+      m_heartbeat->Begin(*start);
+    }
+  }
+
+  /**
+   * @brief Record the time taken by a descriptor's handler.
+   * @param descriptor the descriptor.
+   * @param fd the file descriptor, used as the name if there isn't one.
+   * @param start the time from Start().
+   */
+  void DescriptorDone(const void *descriptor, int fd, const TimeStamp &start);
+
+  /**
+   * @brief Record the time taken by a timeout.
+   * @param timeout the timeout_id.
+   * @param start the time from Start().
+   */
+  void TimeoutDone(const void *timeout, const TimeStamp &start);
+
+  /**
+   * @brief Record the time spent handling events in an iteration of the loop.
+   */
+  void LoopDone(const TimeInterval &loop_time);
+
+  /**
+   * @brief Get the handlers with the longest maximum run time.
+   * @param limit the maximum number of handlers to return.
+   * @param[out] stats the handlers, slowest first.
+   */
+  void SlowestHandlers(unsigned int limit,
+                       std::vector<HandlerStats> *stats) const;
+
+  /**
+   * @brief The number of handlers shown in ss-slowest-handlers.
+   */
+  static const unsigned int SLOWEST_HANDLERS = 10;
+
+ private:
+  typedef std::map<std::string, HandlerStats*> StatsMap;
+  typedef std::map<const void*, HandlerStats*> HandlerMap;
+  typedef std::map<const void*, std::string> NameMap;
+
+  Clock *m_clock;
+  Heartbeat *m_heartbeat;
+  const uint64_t m_budget_us;
+  StatsMap m_stats;
+  HandlerMap m_handlers;
+  NameMap m_names;
+  TimeStamp m_last_export;
+  std::vector<std::string> m_exported_names;
+
+  Histogram *m_loop_time;
+  Histogram *m_handler_time;
+  ShardedCounter *m_over_budget;
+  StringMap *m_slowest_handlers;
+
+  HandlerStats *LookupStats(const void *handler,
+                            const std::string &default_name);
+  void Record(HandlerStats *stats, const TimeStamp &start);
+  void ExportSlowestHandlers();
+
+  static const char K_HANDLER_TIME_VAR[];
+  static const char K_LOOP_TIME_VAR[];
+  static const char K_OVER_BUDGET_VAR[];
+  static const char K_SLOWEST_HANDLERS_VAR[];
+  static const char TIMEOUT_NAME[];
+
+  DISALLOW_COPY_AND_ASSIGN(LoopProfiler);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_LOOPPROFILER_H_
@@ -7,14 +7,19 @@ common_libolacommon_la_SOURCES += \
     common/io/IOQueue.cpp \
     common/io/IOStack.cpp \
     common/io/IOUtils.cpp \
+    common/io/LoopProfiler.cpp \
+    common/io/LoopProfiler.h \
     common/io/NonBlockingSender.cpp \
     common/io/PollerInterface.cpp \
     common/io/PollerInterface.h \
     common/io/SelectServer.cpp \
     common/io/Serial.cpp \
     common/io/StdinHandler.cpp \
+    common/io/ThreadSafeMemoryBlockPool.cpp \
     common/io/TimeoutManager.cpp \
-    common/io/TimeoutManager.h
+    common/io/TimeoutManager.h \
+    common/io/WakeUpDescriptor.cpp \
+    common/io/WakeUpDescriptor.h
 
 if USING_WIN32
 common_libolacommon_la_SOURCES += \
@@ -22,6 +27,9 @@ common_libolacommon_la_SOURCES += \
     common/io/WindowsPoller.h
 else
 common_libolacommon_la_SOURCES += \
+    common/io/DmxLineDriver.cpp \
+    common/io/PollPoller.cpp \
+    common/io/PollPoller.h \
     common/io/SelectPoller.cpp \
     common/io/SelectPoller.h
 endif
@@ -32,12 +40,26 @@ common_libolacommon_la_SOURCES += \
     common/io/EPoller.cpp
 endif
 
+if HAVE_IO_URING
+common_libolacommon_la_SOURCES += \
+    common/io/IOUringPoller.h \
+    common/io/IOUringPoller.cpp
+endif
+
 if HAVE_KQUEUE
 common_libolacommon_la_SOURCES += \
     common/io/KQueuePoller.h \
     common/io/KQueuePoller.cpp
 endif
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/io/timeout_manager_benchmark
+
+common_io_timeout_manager_benchmark_SOURCES = \
+    common/io/timeout_manager_benchmark.cpp
+common_io_timeout_manager_benchmark_LDADD = common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -47,6 +69,7 @@ test_programs += \
     common/io/MemoryBlockTester \
     common/io/SelectServerTester \
     common/io/StreamTester \
+    common/io/ThreadSafeMemoryBlockPoolTester \
     common/io/TimeoutManagerTester
 
 common_io_IOQueueTester_SOURCES = common/io/IOQueueTest.cpp
@@ -67,9 +90,17 @@ common_io_MemoryBlockTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_io_SelectServerTester_SOURCES = common/io/SelectServerTest.cpp \
                                        common/io/SelectServerThreadTest.cpp
+if !USING_WIN32
+common_io_SelectServerTester_SOURCES += common/io/PollPollerTest.cpp
+endif
 common_io_SelectServerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_SelectServerTester_LDADD = $(COMMON_TESTING_LIBS)
 
+common_io_ThreadSafeMemoryBlockPoolTester_SOURCES = \
+    common/io/ThreadSafeMemoryBlockPoolTest.cpp
+common_io_ThreadSafeMemoryBlockPoolTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_io_ThreadSafeMemoryBlockPoolTester_LDADD = $(COMMON_TESTING_LIBS)
+
 common_io_TimeoutManagerTester_SOURCES = common/io/TimeoutManagerTest.cpp
 common_io_TimeoutManagerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_TimeoutManagerTester_LDADD = $(COMMON_TESTING_LIBS)
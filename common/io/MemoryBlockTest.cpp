@@ -18,6 +18,7 @@
  * Copyright (C) 2012 Simon Newton
  */
 
+#include <string.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
 #include <iostream>
@@ -34,11 +35,13 @@ class MemoryBlockTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(MemoryBlockTest);
   CPPUNIT_TEST(testAppend);
   CPPUNIT_TEST(testPrepend);
+  CPPUNIT_TEST(testExtend);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testAppend();
   void testPrepend();
+  void testExtend();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(MemoryBlockTest);
@@ -120,3 +123,26 @@ void MemoryBlockTest::testPrepend() {
   // now that all data is removed, the block should reset
   OLA_ASSERT_EQ(100u, block.Remaining());
 }
+
+/*
+ * Check that data written to the free space can be added to the block.
+ */
+void MemoryBlockTest::testExtend() {
+  unsigned int size = 10;
+  uint8_t *data = new uint8_t[size];
+  MemoryBlock block(data, size);
+  OLA_ASSERT_EQ(data, block.FreeSpace());
+
+  const uint8_t data1[] = {1, 2, 3, 4};
+  memcpy(block.FreeSpace(), data1, arraysize(data1));
+  OLA_ASSERT_EQ(4u, block.Extend(arraysize(data1)));
+  OLA_ASSERT_EQ(4u, block.Size());
+  OLA_ASSERT_EQ(6u, block.Remaining());
+  OLA_ASSERT_EQ(data + 4, block.FreeSpace());
+  OLA_ASSERT_DATA_EQUALS(data1, arraysize(data1), block.Data(), block.Size());
+
+  // try to extend past the end of the block
+  OLA_ASSERT_EQ(6u, block.Extend(8));
+  OLA_ASSERT_EQ(size, block.Size());
+  OLA_ASSERT_EQ(0u, block.Remaining());
+}
@@ -21,6 +21,7 @@
 #include "ola/io/IOQueue.h"
 #include "ola/io/IOStack.h"
 #include "ola/io/NonBlockingSender.h"
+#include "ola/stl/STLUtils.h"
 
 namespace ola {
 namespace io {
@@ -33,6 +34,7 @@ NonBlockingSender::NonBlockingSender(ola::io::ConnectedDescriptor *descriptor,
                                      unsigned int max_buffer_size)
   : m_descriptor(descriptor),
     m_ss(ss),
+    m_memory_pool(memory_pool),
     m_output_buffer(memory_pool),
     m_associated(false),
     m_max_buffer_size(max_buffer_size) {
@@ -45,12 +47,26 @@ NonBlockingSender::~NonBlockingSender() {
     m_ss->RemoveWriteDescriptor(m_descriptor);
   }
   m_descriptor->SetOnWritable(NULL);
+  STLDeleteValues(&m_latest_messages);
 }
 
 bool NonBlockingSender::LimitReached() const {
   return m_output_buffer.Size() >= m_max_buffer_size;
 }
 
+bool NonBlockingSender::Empty() const {
+  if (!m_output_buffer.Empty()) {
+    return false;
+  }
+  LatestMessages::const_iterator iter = m_latest_messages.begin();
+  for (; iter != m_latest_messages.end(); ++iter) {
+    if (!iter->second->Empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool NonBlockingSender::SendMessage(ola::io::IOStack *stack) {
   if (LimitReached()) {
     return false;
@@ -71,12 +87,31 @@ bool NonBlockingSender::SendMessage(IOQueue *queue) {
   return true;
 }
 
+void NonBlockingSender::SendLatestMessage(unsigned int key, IOQueue *queue) {
+  IOQueue *&message = m_latest_messages[key];
+  if (message) {
+    message->Clear();
+  } else {
+    message = new IOQueue(m_memory_pool);
+  }
+  message->AppendMove(queue);
+  AssociateIfRequired();
+}
+
 /*
  * Called when the descriptor is writeable, this does the actual write() call.
+ * Everything that's ready goes out in a single scatter / gather write.
  */
 void NonBlockingSender::PerformWrite() {
+  if (!LimitReached()) {
+    LatestMessages::iterator iter = m_latest_messages.begin();
+    for (; iter != m_latest_messages.end(); ++iter) {
+      m_output_buffer.AppendMove(iter->second);
+    }
+  }
+
   m_descriptor->Send(&m_output_buffer);
-  if (m_output_buffer.Empty() && m_associated) {
+  if (Empty() && m_associated) {
     m_ss->RemoveWriteDescriptor(m_descriptor);
     m_associated = false;
   }
@@ -86,7 +121,7 @@ void NonBlockingSender::PerformWrite() {
  * Associate our descriptor with the SelectServer if we have data to send.
  */
 void NonBlockingSender::AssociateIfRequired() {
-  if (m_output_buffer.Empty()) {
+  if (m_associated || Empty()) {
     return;
   }
   m_ss->AddWriteDescriptor(m_descriptor);
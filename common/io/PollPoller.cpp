@@ -0,0 +1,396 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PollPoller.cpp
+ * A Poller which uses poll()
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "common/io/PollPoller.h"
+
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "common/io/LoopProfiler.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace io {
+
+namespace {
+// The events that mean a read descriptor needs attention.
+const int16_t READ_EVENTS = POLLIN | POLLHUP | POLLERR | POLLNVAL;
+// The events that mean a write descriptor needs attention.
+const int16_t WRITE_EVENTS = POLLOUT | POLLHUP | POLLERR | POLLNVAL;
+}  // namespace
+
+PollPoller::PollPoller(ExportMap *export_map, Clock* clock)
+    : m_export_map(export_map),
+      m_loop_iterations(NULL),
+      m_loop_time(NULL),
+      m_profiler(NULL),
+      m_ready_count(0),
+      m_clock(clock),
+      m_removed_count(0) {
+  if (m_export_map) {
+    m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
+    m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+  }
+}
+
+PollPoller::~PollPoller() {
+  for (unsigned int i = 0; i < m_poll_data.size(); i++) {
+    if (m_poll_fds[i].fd >= 0 && m_poll_data[i].delete_connected_on_close) {
+      delete m_poll_data[i].connected_descriptor;
+    }
+  }
+}
+
+bool PollPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  unsigned int index = LookupOrCreateIndex(descriptor->ReadDescriptor());
+  if (m_poll_fds[index].events & POLLIN) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  m_poll_fds[index].events |= POLLIN;
+  m_poll_data[index].read_descriptor = descriptor;
+  return true;
+}
+
+bool PollPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
+                                   bool delete_on_close) {
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  unsigned int index = LookupOrCreateIndex(descriptor->ReadDescriptor());
+  if (m_poll_fds[index].events & POLLIN) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  m_poll_fds[index].events |= POLLIN;
+  m_poll_data[index].connected_descriptor = descriptor;
+  m_poll_data[index].delete_connected_on_close = delete_on_close;
+  return true;
+}
+
+bool PollPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "Removing an invalid ReadDescriptor";
+    return false;
+  }
+  return RemoveEvent(descriptor->ReadDescriptor(), POLLIN);
+}
+
+bool PollPoller::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "Removing an invalid ConnectedDescriptor";
+    return false;
+  }
+  return RemoveEvent(descriptor->ReadDescriptor(), POLLIN);
+}
+
+bool PollPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "AddWriteDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  unsigned int index = LookupOrCreateIndex(descriptor->WriteDescriptor());
+  if (m_poll_fds[index].events & POLLOUT) {
+    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
+             << " already in write set";
+    return false;
+  }
+
+  m_poll_fds[index].events |= POLLOUT;
+  m_poll_data[index].write_descriptor = descriptor;
+  return true;
+}
+
+bool PollPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "Removing an invalid WriteDescriptor";
+    return false;
+  }
+  return RemoveEvent(descriptor->WriteDescriptor(), POLLOUT);
+}
+
+bool PollPoller::Poll(TimeoutManager *timeout_manager,
+                      const TimeInterval &poll_interval) {
+  TimeInterval sleep_interval = poll_interval;
+  // Update the wake up time before running the timeouts, so they see the
+  // current time.
+  const TimeStamp last_wake_up = m_wake_up_time;
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
+
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(
+      &m_wake_up_time);
+  if (!next_event_in.IsZero()) {
+    sleep_interval = std::min(next_event_in, sleep_interval);
+  }
+
+  // take care of stats accounting
+  if (last_wake_up.IsSet()) {
+    TimeInterval loop_time = m_wake_up_time - last_wake_up;
+    OLA_DEBUG << "ss process time was " << loop_time.ToString();
+    if (m_loop_time)
+      (*m_loop_time) += loop_time.AsInt();
+    if (m_loop_iterations)
+      (*m_loop_iterations)++;
+    if (m_profiler)
+      m_profiler->LoopDone(loop_time);
+  }
+
+  // Nothing can hold an index into the arrays at this point.
+  Compact();
+
+  // poll() only has millisecond resolution. Round up, otherwise we'd spin
+  // until the next timeout is due.
+  int sleep_ms = static_cast<int>((sleep_interval.AsInt() + 999) / 1000);
+  int ready = poll(m_poll_fds.empty() ? NULL : &m_poll_fds[0],
+                   m_poll_fds.size(), sleep_ms);
+  m_ready_count = ready > 0 ? ready : 0;
+
+  if (ready == 0) {
+    m_clock->CurrentMonotonicTime(&m_wake_up_time);
+    timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+    return true;
+  } else if (ready == -1) {
+    if (errno == EINTR)
+      return true;
+    OLA_WARN << "poll() error, " << strerror(errno);
+    return false;
+  }
+
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
+
+  // Entries added by the callbacks go on the end and won't have any revents
+  // set, so we only need to check up to the current size. We can stop once
+  // all the ready descriptors have been handled.
+  const unsigned int poll_fd_count = m_poll_fds.size();
+  for (unsigned int i = 0; i < poll_fd_count && ready > 0; i++) {
+    if (m_poll_fds[i].revents) {
+      ready--;
+      CheckDescriptor(i);
+    }
+  }
+
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
+  timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+  return true;
+}
+
+/*
+ * Return the index of the entry for a FD, adding a new entry if there isn't
+ * one.
+ */
+unsigned int PollPoller::LookupOrCreateIndex(int fd) {
+  std::pair<IndexMap::iterator, bool> result = m_fd_index.insert(
+      IndexMap::value_type(fd, m_poll_fds.size()));
+  if (result.second) {
+    struct pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = 0;
+    poll_fd.revents = 0;
+    m_poll_fds.push_back(poll_fd);
+
+    poll_data_t poll_data = {NULL, NULL, NULL, false};
+    m_poll_data.push_back(poll_data);
+  }
+  return result.first->second;
+}
+
+/*
+ * Stop watching a FD for an event. If there are no more events for the FD,
+ * the entry is removed.
+ */
+bool PollPoller::RemoveEvent(int fd, int16_t event) {
+  const unsigned int *index = STLFind(&m_fd_index, fd);
+  if (!index || !(m_poll_fds[*index].events & event)) {
+    return false;
+  }
+
+  poll_data_t *poll_data = &m_poll_data[*index];
+  if (event == POLLIN) {
+    poll_data->read_descriptor = NULL;
+    poll_data->connected_descriptor = NULL;
+    poll_data->delete_connected_on_close = false;
+  } else {
+    poll_data->write_descriptor = NULL;
+  }
+
+  m_poll_fds[*index].events &= ~event;
+  if (!m_poll_fds[*index].events) {
+    RemoveIndex(*index);
+  }
+  return true;
+}
+
+/*
+ * Mark an entry as removed. The fd is set to -1 so poll() ignores it, until
+ * it's removed by Compact().
+ */
+void PollPoller::RemoveIndex(unsigned int index) {
+  m_fd_index.erase(m_poll_fds[index].fd);
+  m_poll_fds[index].fd = -1;
+  m_poll_fds[index].events = 0;
+  m_removed_count++;
+}
+
+/*
+ * Remove the entries marked by RemoveIndex(), by moving the last entry into
+ * their place.
+ *
+ * This must not be called while the callbacks are running, since it changes
+ * the indices.
+ */
+void PollPoller::Compact() {
+  unsigned int i = 0;
+  while (m_removed_count && i < m_poll_fds.size()) {
+    if (m_poll_fds[i].fd >= 0) {
+      i++;
+      continue;
+    }
+
+    m_poll_fds[i] = m_poll_fds.back();
+    m_poll_data[i] = m_poll_data.back();
+    m_poll_fds.pop_back();
+    m_poll_data.pop_back();
+    m_removed_count--;
+    if (i < m_poll_fds.size() && m_poll_fds[i].fd >= 0) {
+      m_fd_index[m_poll_fds[i].fd] = i;
+    }
+  }
+}
+
+/*
+ * Run the callbacks for an entry that poll() returned events for.
+ *
+ * The callbacks may add or remove descriptors. That's safe since new entries
+ * are appended & removed ones are only marked, but m_poll_data may be
+ * reallocated so we can't hold a reference to the entry.
+ */
+void PollPoller::CheckDescriptor(unsigned int index) {
+  const int fd = m_poll_fds[index].fd;
+  const int16_t revents = m_poll_fds[index].revents;
+
+  if (revents & READ_EVENTS) {
+    ReadFileDescriptor *read_descriptor = m_poll_data[index].read_descriptor;
+    ConnectedDescriptor *connected_descriptor =
+        m_poll_data[index].connected_descriptor;
+
+    if (read_descriptor) {
+      if (revents & POLLNVAL) {
+        // The descriptor was probably closed without removing it from the
+        // select server
+        if (m_export_map) {
+          (*m_export_map->GetIntegerVar(K_READ_DESCRIPTOR_VAR))--;
+        }
+        RemoveEvent(fd, POLLIN);
+        OLA_WARN << "Removed a inactive descriptor from the select server";
+      } else {
+        TimeStamp start;
+        if (m_profiler) {
+          m_profiler->Start(&start);
+        }
+        read_descriptor->PerformRead();
+        if (m_profiler) {
+          m_profiler->DescriptorDone(read_descriptor, fd, start);
+        }
+      }
+    } else if (connected_descriptor) {
+      TimeStamp start;
+      if (m_profiler) {
+        m_profiler->Start(&start);
+      }
+      if ((revents & POLLNVAL) ||
+          !connected_descriptor->ValidReadDescriptor() ||
+          connected_descriptor->IsClosed()) {
+        CloseConnectedDescriptor(index);
+      } else {
+        connected_descriptor->PerformRead();
+      }
+      if (m_profiler) {
+        m_profiler->DescriptorDone(connected_descriptor, fd, start);
+      }
+    }
+  }
+
+  // The read callbacks may have removed the write descriptor.
+  WriteFileDescriptor *write_descriptor = m_poll_data[index].write_descriptor;
+  if ((revents & WRITE_EVENTS) && write_descriptor) {
+    if (revents & POLLNVAL) {
+      // The descriptor was probably closed without removing it from the select
+      // server
+      if (m_export_map) {
+        (*m_export_map->GetIntegerVar(K_WRITE_DESCRIPTOR_VAR))--;
+      }
+      RemoveEvent(fd, POLLOUT);
+      OLA_WARN << "Removed a disconnected descriptor from the select server";
+    } else {
+      TimeStamp start;
+      if (m_profiler) {
+        m_profiler->Start(&start);
+      }
+      write_descriptor->PerformWrite();
+      if (m_profiler) {
+        m_profiler->DescriptorDone(write_descriptor, fd, start);
+      }
+    }
+  }
+}
+
+/*
+ * Remove a ConnectedDescriptor that the remote end closed, and run the on
+ * close handler.
+ */
+void PollPoller::CloseConnectedDescriptor(unsigned int index) {
+  ConnectedDescriptor *descriptor = m_poll_data[index].connected_descriptor;
+  bool delete_on_close = m_poll_data[index].delete_connected_on_close;
+  ConnectedDescriptor::OnCloseCallback *on_close =
+      descriptor->TransferOnClose();
+
+  RemoveEvent(m_poll_fds[index].fd, POLLIN);
+  if (m_export_map) {
+    (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
+  }
+
+  if (on_close)
+    on_close->Run();
+
+  if (delete_on_close)
+    delete descriptor;
+}
+}  // namespace io
+}  // namespace ola
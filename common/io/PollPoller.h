@@ -0,0 +1,117 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PollPoller.h
+ * A Poller which uses poll()
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_IO_POLLPOLLER_H_
+#define COMMON_IO_POLLPOLLER_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <poll.h>
+
+#include <map>
+#include <vector>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/TimeoutManager.h"
+
+namespace ola {
+namespace io {
+
+/**
+ * @class PollPoller
+ * @brief An implementation of PollerInterface that uses poll().
+ *
+ * Unlike select(), poll() isn't limited to FD_SETSIZE descriptors. The array
+ * of pollfd structures is kept between calls and updated as descriptors are
+ * added & removed, rather than being rebuilt on each iteration of the loop.
+ *
+ * This is used on systems that don't have epoll() or kqueue().
+ */
+class PollPoller : public PollerInterface {
+ public :
+  /**
+   * @brief Create a new PollPoller.
+   * @param export_map the ExportMap to use
+   * @param clock the Clock to use
+   */
+  PollPoller(ExportMap *export_map, Clock *clock);
+
+  ~PollPoller();
+
+  bool AddReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool AddReadDescriptor(class ConnectedDescriptor *descriptor,
+                         bool delete_on_close);
+  bool RemoveReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool RemoveReadDescriptor(class ConnectedDescriptor *descriptor);
+
+  bool AddWriteDescriptor(class WriteFileDescriptor *descriptor);
+  bool RemoveWriteDescriptor(class WriteFileDescriptor *descriptor);
+
+  const TimeStamp *WakeUpTime() const { return &m_wake_up_time; }
+
+  bool Poll(TimeoutManager *timeout_manager,
+            const TimeInterval &poll_interval);
+
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
+  unsigned int ReadyCount() const { return m_ready_count; }
+
+ private:
+  // The descriptors for a FD. There is one of these for each entry in
+  // m_poll_fds, at the same index.
+  typedef struct {
+    ReadFileDescriptor *read_descriptor;
+    WriteFileDescriptor *write_descriptor;
+    ConnectedDescriptor *connected_descriptor;
+    bool delete_connected_on_close;
+  } poll_data_t;
+
+  typedef std::map<int, unsigned int> IndexMap;
+
+  ExportMap *m_export_map;
+  CounterVariable *m_loop_iterations;
+  CounterVariable *m_loop_time;
+  LoopProfiler *m_profiler;
+  unsigned int m_ready_count;
+  Clock *m_clock;
+  TimeStamp m_wake_up_time;
+
+  // Callbacks may add & remove descriptors while we're iterating over these,
+  // so removed entries have their fd set to -1, which poll() ignores. They're
+  // compacted away at the start of the next call to Poll().
+  std::vector<struct pollfd> m_poll_fds;
+  std::vector<poll_data_t> m_poll_data;
+  IndexMap m_fd_index;  // FD to the index in m_poll_fds
+  unsigned int m_removed_count;
+
+  unsigned int LookupOrCreateIndex(int fd);
+  bool RemoveEvent(int fd, int16_t event);
+  void RemoveIndex(unsigned int index);
+  void Compact();
+  void CheckDescriptor(unsigned int index);
+  void CloseConnectedDescriptor(unsigned int index);
+
+  DISALLOW_COPY_AND_ASSIGN(PollPoller);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_POLLPOLLER_H_
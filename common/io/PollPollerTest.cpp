@@ -0,0 +1,251 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PollPollerTest.cpp
+ * Test fixture for the PollPoller.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * SelectServerTest.cpp covers the general reentrancy cases with whichever
+ * poller the platform uses. These tests check the bookkeeping of the
+ * persistent pollfd array.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "common/io/PollPoller.h"
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/io/Descriptor.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::io::ConnectedDescriptor;
+using ola::io::LoopbackDescriptor;
+using ola::io::PollPoller;
+using ola::io::TimeoutManager;
+using std::auto_ptr;
+using std::map;
+using std::vector;
+
+class PollPollerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PollPollerTest);
+  CPPUNIT_TEST(testReadAndWrite);
+  CPPUNIT_TEST(testRemoteEndClose);
+  CPPUNIT_TEST(testRemoveWhenReadable);
+  CPPUNIT_TEST(testManyDescriptors);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+  void testReadAndWrite();
+  void testRemoteEndClose();
+  void testRemoveWhenReadable();
+  void testManyDescriptors();
+
+  void ReadData(LoopbackDescriptor *descriptor) {
+    uint8_t data[10];
+    unsigned int size;
+    descriptor->Receive(data, sizeof(data), size);
+    m_reads[descriptor]++;
+  }
+
+  void ReadAndRemove(LoopbackDescriptor *descriptor,
+                     LoopbackDescriptor *other) {
+    ReadData(descriptor);
+    OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(other));
+  }
+
+  void Writable() { m_writes++; }
+
+  void Closed(ConnectedDescriptor *descriptor) {
+    m_closes++;
+    // The poller has already removed it.
+    OLA_ASSERT_FALSE(m_poller->RemoveReadDescriptor(descriptor));
+  }
+
+ private:
+  Clock m_clock;
+  auto_ptr<TimeoutManager> m_timeout_manager;
+  auto_ptr<PollPoller> m_poller;
+  map<LoopbackDescriptor*, unsigned int> m_reads;
+  unsigned int m_writes;
+  unsigned int m_closes;
+
+  void Poll() {
+    OLA_ASSERT_TRUE(m_poller->Poll(m_timeout_manager.get(),
+                                   TimeInterval(0, 100000)));
+  }
+
+  void SendTo(LoopbackDescriptor *descriptor) {
+    const uint8_t data[] = {1, 2, 3};
+    descriptor->Send(data, sizeof(data));
+  }
+
+  unsigned int Reads(LoopbackDescriptor *descriptor) {
+    const unsigned int *reads = ola::STLFind(&m_reads, descriptor);
+    return reads ? *reads : 0;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PollPollerTest);
+
+void PollPollerTest::setUp() {
+  m_timeout_manager.reset(new TimeoutManager(NULL, &m_clock));
+  m_poller.reset(new PollPoller(NULL, &m_clock));
+  m_writes = 0;
+  m_closes = 0;
+}
+
+void PollPollerTest::tearDown() {
+  m_poller.reset();
+  m_timeout_manager.reset();
+}
+
+/*
+ * Check read & write events are delivered, and stop once removed.
+ */
+void PollPollerTest::testReadAndWrite() {
+  LoopbackDescriptor loopback;
+  loopback.Init();
+  loopback.SetOnData(
+      NewCallback(this, &PollPollerTest::ReadData, &loopback));
+  loopback.SetOnWritable(NewCallback(this, &PollPollerTest::Writable));
+
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+  OLA_ASSERT_FALSE(m_poller->AddReadDescriptor(&loopback, false));
+  OLA_ASSERT_TRUE(m_poller->AddWriteDescriptor(&loopback));
+  OLA_ASSERT_FALSE(m_poller->AddWriteDescriptor(&loopback));
+
+  Poll();
+  OLA_ASSERT_EQ(0u, Reads(&loopback));
+  OLA_ASSERT_EQ(1u, m_writes);
+
+  SendTo(&loopback);
+  Poll();
+  OLA_ASSERT_EQ(1u, Reads(&loopback));
+  OLA_ASSERT_EQ(2u, m_writes);
+
+  OLA_ASSERT_TRUE(m_poller->RemoveWriteDescriptor(&loopback));
+  OLA_ASSERT_FALSE(m_poller->RemoveWriteDescriptor(&loopback));
+  SendTo(&loopback);
+  Poll();
+  OLA_ASSERT_EQ(2u, Reads(&loopback));
+  OLA_ASSERT_EQ(2u, m_writes);
+
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&loopback));
+  OLA_ASSERT_FALSE(m_poller->RemoveReadDescriptor(&loopback));
+  SendTo(&loopback);
+  Poll();
+  OLA_ASSERT_EQ(2u, Reads(&loopback));
+}
+
+/*
+ * Check the on close handler runs when the remote end closes, and that
+ * descriptors are deleted if requested.
+ */
+void PollPollerTest::testRemoteEndClose() {
+  LoopbackDescriptor loopback;
+  loopback.Init();
+  loopback.SetOnClose(NewSingleCallback(
+      this, &PollPollerTest::Closed,
+      static_cast<ConnectedDescriptor*>(&loopback)));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+
+  LoopbackDescriptor *deleted = new LoopbackDescriptor();
+  deleted->Init();
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(deleted, true));
+
+  loopback.CloseClient();
+  deleted->CloseClient();
+  Poll();
+  OLA_ASSERT_EQ(1u, m_closes);
+
+  // The fd can be added again.
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&loopback));
+}
+
+/*
+ * Check that a descriptor removed by another's callback isn't run, even if
+ * it was ready.
+ */
+void PollPollerTest::testRemoveWhenReadable() {
+  LoopbackDescriptor first, second;
+  first.Init();
+  second.Init();
+  first.SetOnData(
+      NewCallback(this, &PollPollerTest::ReadAndRemove, &first, &second));
+  second.SetOnData(
+      NewCallback(this, &PollPollerTest::ReadData, &second));
+
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&first, false));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&second, false));
+
+  SendTo(&first);
+  SendTo(&second);
+  Poll();
+  OLA_ASSERT_EQ(1u, Reads(&first));
+  OLA_ASSERT_EQ(0u, Reads(&second));
+
+  // Once added back, the pending data is read.
+  first.SetOnData(NewCallback(this, &PollPollerTest::ReadData, &first));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&second, false));
+  Poll();
+  OLA_ASSERT_EQ(1u, Reads(&first));
+  OLA_ASSERT_EQ(1u, Reads(&second));
+}
+
+/*
+ * Check the entries are tracked correctly as descriptors are removed from the
+ * middle of the array.
+ */
+void PollPollerTest::testManyDescriptors() {
+  const unsigned int DESCRIPTOR_COUNT = 50;
+  vector<LoopbackDescriptor*> descriptors;
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i++) {
+    LoopbackDescriptor *descriptor = new LoopbackDescriptor();
+    descriptor->Init();
+    descriptor->SetOnData(
+        NewCallback(this, &PollPollerTest::ReadData, descriptor));
+    OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(descriptor, false));
+    descriptors.push_back(descriptor);
+  }
+
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i += 3) {
+    OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(descriptors[i]));
+  }
+
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i++) {
+    SendTo(descriptors[i]);
+  }
+  Poll();
+
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i++) {
+    OLA_ASSERT_EQ(i % 3 ? 1u : 0u, Reads(descriptors[i]));
+    if (i % 3) {
+      OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(descriptors[i]));
+    }
+  }
+  ola::STLDeleteElements(&descriptors);
+}
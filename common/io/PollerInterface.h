@@ -29,6 +29,8 @@
 namespace ola {
 namespace io {
 
+class LoopProfiler;
+
 /**
  * @class PollerInterface
  * @brief The interface for the Poller classes.
@@ -140,6 +142,24 @@ class PollerInterface {
   virtual bool Poll(TimeoutManager *timeout_manager,
                     const TimeInterval &poll_interval) = 0;
 
+  /**
+   * @brief Record the time taken by the descriptor handlers.
+   * @param profiler the LoopProfiler to use, ownership is not transferred. May
+   *   be NULL to turn off profiling.
+   *
+   * Pollers that don't support profiling ignore this.
+   */
+  virtual void SetProfiler(LoopProfiler *profiler) { (void) profiler; }
+
+  /**
+   * @brief The number of descriptors that were ready in the last call to
+   *   Poll().
+   *
+   * This is used to stop spinning once an event arrives. Pollers that don't
+   * count the ready descriptors return 0.
+   */
+  virtual unsigned int ReadyCount() const { return 0; }
+
   static const char K_READ_DESCRIPTOR_VAR[];
   static const char K_WRITE_DESCRIPTOR_VAR[];
   static const char K_CONNECTED_DESCRIPTORS_VAR[];
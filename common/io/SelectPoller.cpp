@@ -38,6 +38,7 @@
 #include "ola/Logging.h"
 #include "ola/base/Macro.h"
 #include "ola/io/Descriptor.h"
+#include "common/io/LoopProfiler.h"
 #include "ola/stl/STLUtils.h"
 
 namespace ola {
@@ -101,6 +102,7 @@ SelectPoller::SelectPoller(ExportMap *export_map, Clock* clock)
     : m_export_map(export_map),
       m_loop_iterations(NULL),
       m_loop_time(NULL),
+      m_profiler(NULL),
       m_clock(clock) {
   if (m_export_map) {
     m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
@@ -203,16 +205,19 @@ bool SelectPoller::Poll(TimeoutManager *timeout_manager,
                         const TimeInterval &poll_interval) {
   int maxsd;
   fd_set r_fds, w_fds;
-  TimeStamp now;
   TimeInterval sleep_interval = poll_interval;
   struct timeval tv;
 
   maxsd = 0;
   FD_ZERO(&r_fds);
   FD_ZERO(&w_fds);
-  m_clock->CurrentMonotonicTime(&now);
+  // Update the wake up time before running the timeouts, so they see the
+  // current time.
+  const TimeStamp last_wake_up = m_wake_up_time;
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
 
-  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(
+      &m_wake_up_time);
   if (!next_event_in.IsZero()) {
     sleep_interval = std::min(next_event_in, sleep_interval);
   }
@@ -228,13 +233,15 @@ bool SelectPoller::Poll(TimeoutManager *timeout_manager,
   }
 
   // take care of stats accounting
-  if (m_wake_up_time.IsSet()) {
-    TimeInterval loop_time = now - m_wake_up_time;
+  if (last_wake_up.IsSet()) {
+    TimeInterval loop_time = m_wake_up_time - last_wake_up;
     OLA_DEBUG << "ss process time was " << loop_time.ToString();
     if (m_loop_time)
       (*m_loop_time) += loop_time.AsInt();
     if (m_loop_iterations)
       (*m_loop_iterations)++;
+    if (m_profiler)
+      m_profiler->LoopDone(loop_time);
   }
 
   sleep_interval.AsTimeval(&tv);
@@ -369,7 +376,15 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
   ReadDescriptorMap::iterator iter = m_read_descriptors.begin();
   for (; iter != m_read_descriptors.end(); ++iter) {
     if (iter->second && FD_ISSET(iter->second->ReadDescriptor(), r_set)) {
-      iter->second->PerformRead();
+      if (m_profiler) {
+        const ReadFileDescriptor *descriptor = iter->second;
+        TimeStamp start;
+        m_profiler->Start(&start);
+        iter->second->PerformRead();
+        m_profiler->DescriptorDone(descriptor, iter->first, start);
+      } else {
+        iter->second->PerformRead();
+      }
     }
   }
 
@@ -382,6 +397,10 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
 
     connected_descriptor_t *cd = con_iter->second;
     ConnectedDescriptor *descriptor = cd->descriptor;
+    TimeStamp start;
+    if (m_profiler) {
+      m_profiler->Start(&start);
+    }
 
     bool closed = false;
     if (!descriptor->ValidReadDescriptor()) {
@@ -411,6 +430,10 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
       if (delete_on_close)
         delete descriptor;
     }
+
+    if (m_profiler) {
+      m_profiler->DescriptorDone(descriptor, con_iter->first, start);
+    }
   }
 
   // Check the write sockets. These may have changed since the start of the
@@ -419,7 +442,15 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
   for (; write_iter != m_write_descriptors.end(); write_iter++) {
     if (write_iter->second &&
         FD_ISSET(write_iter->second->WriteDescriptor(), w_set)) {
-      write_iter->second->PerformWrite();
+      if (m_profiler) {
+        const WriteFileDescriptor *descriptor = write_iter->second;
+        TimeStamp start;
+        m_profiler->Start(&start);
+        write_iter->second->PerformWrite();
+        m_profiler->DescriptorDone(descriptor, write_iter->first, start);
+      } else {
+        write_iter->second->PerformWrite();
+      }
     }
   }
 }
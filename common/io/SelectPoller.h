@@ -65,6 +65,8 @@ class SelectPoller : public PollerInterface {
   bool Poll(TimeoutManager *timeout_manager,
             const TimeInterval &poll_interval);
 
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
  private:
   typedef struct {
     ConnectedDescriptor *descriptor;
@@ -78,6 +80,7 @@ class SelectPoller : public PollerInterface {
   ExportMap *m_export_map;
   CounterVariable *m_loop_iterations;
   CounterVariable *m_loop_time;
+  LoopProfiler *m_profiler;
   Clock *m_clock;
   TimeStamp m_wake_up_time;
 
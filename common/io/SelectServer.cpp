@@ -24,16 +24,22 @@
 #include <ola/win/CleanWinSock2.h>
 #else
 #include <sys/select.h>
+#include <sys/socket.h>
 #endif  // _WIN32
 
 #if HAVE_CONFIG_H
 #include <config.h>
 #endif  // HAVE_CONFIG_H
 
+#ifdef HAVE_SYS_PRCTL_H
+#include <sys/prctl.h>
+#endif  // HAVE_SYS_PRCTL_H
+
 #include <string.h>
 #include <errno.h>
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -44,20 +50,51 @@
 #include "ola/base/Flags.h"
 
 
+#include "common/io/PollPoller.h"
 #include "common/io/SelectPoller.h"
 #endif  // _WIN32
 
+#include "common/io/LoopProfiler.h"
+#include "common/io/WakeUpDescriptor.h"
 #include "ola/io/Descriptor.h"
 #include "ola/Logging.h"
 #include "ola/network/Socket.h"
 #include "ola/stl/STLUtils.h"
 
+#ifndef _WIN32
+DEFINE_default_bool(use_timer_wheel, false,
+                    "Use a timer wheel rather than a heap for timeouts");
+DEFINE_default_bool(profile_event_loop, false,
+                    "Record the time taken by each event handler");
+DEFINE_uint32(event_handler_budget_us,
+              ola::io::SelectServer::DEFAULT_HANDLER_BUDGET_US,
+              "When profiling, warn about event handlers that take longer "
+              "than this");
+DEFINE_uint32(busy_poll_us, 0,
+              "Spin for this many microseconds before blocking in the event "
+              "loop, 0 always blocks");
+#ifdef __APPLE__
+// poll() on macOS doesn't work with devices, which rules out serial widgets.
+DEFINE_default_bool(use_poll, false,
+                    "Use poll() rather than select()");
+#else
+DEFINE_default_bool(use_poll, true,
+                    "Disable the use of poll(), revert to select()");
+#endif  // __APPLE__
+#endif  // _WIN32
+
 #ifdef HAVE_EPOLL
 #include "common/io/EPoller.h"
 DEFINE_default_bool(use_epoll, true,
                     "Disable the use of epoll(), revert to select()");
 #endif  // HAVE_EPOLL
 
+#ifdef HAVE_IO_URING
+#include "common/io/IOUringPoller.h"
+DEFINE_default_bool(use_io_uring, false,
+                    "Use io_uring rather than epoll(), if it's available");
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_KQUEUE
 #include "common/io/KQueuePoller.h"
 DEFINE_default_bool(use_kqueue, false,
@@ -71,6 +108,7 @@ using ola::Callback0;
 using ola::ExportMap;
 using ola::thread::timeout_id;
 using std::max;
+using std::string;
 
 const TimeStamp SelectServer::empty_time;
 
@@ -80,6 +118,9 @@ SelectServer::SelectServer(ExportMap *export_map,
       m_terminate(false),
       m_is_running(false),
       m_poll_interval(POLL_INTERVAL_SECOND, POLL_INTERVAL_USECOND),
+      m_spin_events(NULL),
+      m_block_events(NULL),
+      m_spin_time(NULL),
       m_clock(clock),
       m_free_clock(false) {
   Options options;
@@ -91,6 +132,9 @@ SelectServer::SelectServer(const Options &options)
       m_terminate(false),
       m_is_running(false),
       m_poll_interval(POLL_INTERVAL_SECOND, POLL_INTERVAL_USECOND),
+      m_spin_events(NULL),
+      m_block_events(NULL),
+      m_spin_time(NULL),
       m_clock(options.clock),
       m_free_clock(false) {
   Init(options);
@@ -131,12 +175,33 @@ void SelectServer::Run() {
 
   m_is_running = true;
   m_terminate = false;
+
+#if defined(HAVE_SYS_PRCTL_H) && defined(PR_SET_TIMERSLACK)
+  // The default slack of 50us would swamp the spin, so ask for the minimum
+  // and put it back on the way out.
+  int timer_slack = -1;
+  if (!m_busy_poll.IsZero()) {
+    timer_slack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    if (prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0) < 0) {
+      OLA_WARN << "Failed to set the timer slack: " << strerror(errno);
+    }
+  }
+#endif  // HAVE_SYS_PRCTL_H && PR_SET_TIMERSLACK
+
   while (!m_terminate) {
     // false indicates an error in CheckForEvents();
-    if (!CheckForEvents(m_poll_interval)) {
+    if (!(m_busy_poll.IsZero() ? CheckForEvents(m_poll_interval) :
+          BusyPoll())) {
       break;
     }
   }
+
+#if defined(HAVE_SYS_PRCTL_H) && defined(PR_SET_TIMERSLACK)
+  if (timer_slack > 0) {
+    unsigned long slack = timer_slack;  // NOLINT(runtime/int)
+    prctl(PR_SET_TIMERSLACK, slack, 0, 0, 0);
+  }
+#endif  // HAVE_SYS_PRCTL_H && PR_SET_TIMERSLACK
   m_is_running = false;
 }
 
@@ -155,6 +220,9 @@ bool SelectServer::AddReadDescriptor(ReadFileDescriptor *descriptor) {
   if (added && m_export_map) {
     (*m_export_map->GetIntegerVar(PollerInterface::K_READ_DESCRIPTOR_VAR))++;
   }
+  if (added && !m_busy_poll.IsZero()) {
+    EnableBusyPoll(descriptor->ReadDescriptor());
+  }
   return added;
 }
 
@@ -165,6 +233,9 @@ bool SelectServer::AddReadDescriptor(ConnectedDescriptor *descriptor,
     (*m_export_map->GetIntegerVar(
         PollerInterface::K_CONNECTED_DESCRIPTORS_VAR))++;
   }
+  if (added && !m_busy_poll.IsZero()) {
+    EnableBusyPoll(descriptor->ReadDescriptor());
+  }
   return added;
 }
 
@@ -179,6 +250,9 @@ void SelectServer::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
     (*m_export_map->GetIntegerVar(
         PollerInterface::K_READ_DESCRIPTOR_VAR))--;
   }
+  if (removed && m_profiler.get()) {
+    m_profiler->Forget(descriptor);
+  }
 }
 
 void SelectServer::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
@@ -192,6 +266,9 @@ void SelectServer::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
     (*m_export_map->GetIntegerVar(
         PollerInterface::K_CONNECTED_DESCRIPTORS_VAR))--;
   }
+  if (removed && m_profiler.get()) {
+    m_profiler->Forget(descriptor);
+  }
 }
 
 bool SelectServer::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
@@ -212,6 +289,9 @@ void SelectServer::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
   if (removed && m_export_map) {
     (*m_export_map->GetIntegerVar(PollerInterface::K_WRITE_DESCRIPTOR_VAR))--;
   }
+  if (removed && m_profiler.get()) {
+    m_profiler->Forget(descriptor);
+  }
 }
 
 timeout_id SelectServer::RegisterRepeatingTimeout(
@@ -251,34 +331,42 @@ void SelectServer::RunInLoop(Callback0<void> *callback) {
 }
 
 void SelectServer::Execute(ola::BaseCallback0<void> *callback) {
-  {
-    ola::thread::MutexLocker locker(&m_incoming_mutex);
-    m_incoming_callbacks.push_back(callback);
-  }
+  m_incoming_callbacks.Push(callback);
 
   // kick select(), we do this even if we're in the same thread as select() is
   // called. If we don't do this there is a race condition because a callback
   // may be added just prior to select(). Without this kick, select() will
   // sleep for the poll_interval before executing the callback.
-  uint8_t wake_up = 'a';
-  m_incoming_descriptor.Send(&wake_up, sizeof(wake_up));
+  // The kick is a no-op if there is already a wake up pending.
+  m_wake_up_descriptor->WakeUp();
 }
 
 
 void SelectServer::DrainCallbacks() {
   Callbacks callbacks_to_run;
-  while (true) {
-    {
-      ola::thread::MutexLocker locker(&m_incoming_mutex);
-      if (m_incoming_callbacks.empty()) {
-        return;
-      }
-      callbacks_to_run.swap(m_incoming_callbacks);
-    }
+  while (PopCallbacks(&callbacks_to_run)) {
     RunCallbacks(&callbacks_to_run);
   }
 }
 
+void SelectServer::SetHandlerName(const void *handler, const string &name) {
+  if (m_profiler.get()) {
+    m_profiler->SetName(handler, name);
+  }
+}
+
+void SelectServer::SetHeartbeat(ola::Heartbeat *heartbeat) {
+  if (heartbeat && !m_profiler.get()) {
+    m_profiler.reset(new LoopProfiler(
+        m_export_map, m_clock, TimeInterval(0, DEFAULT_HANDLER_BUDGET_US)));
+    m_poller->SetProfiler(m_profiler.get());
+    m_timeout_manager->SetProfiler(m_profiler.get());
+  }
+  if (m_profiler.get()) {
+    m_profiler->SetHeartbeat(heartbeat);
+  }
+}
+
 void SelectServer::Init(const Options &options) {
   if (!m_clock) {
     m_clock = new Clock;
@@ -291,18 +379,43 @@ void SelectServer::Init(const Options &options) {
     m_export_map->GetIntegerVar(PollerInterface::K_CONNECTED_DESCRIPTORS_VAR);
   }
 
-  m_timeout_manager.reset(new TimeoutManager(m_export_map, m_clock));
+#ifdef _WIN32
+  bool use_timer_wheel = options.use_timer_wheel;
+#else
+  bool use_timer_wheel = FLAGS_use_timer_wheel || options.use_timer_wheel;
+#endif  // _WIN32
+  m_timeout_manager.reset(new TimeoutManager(m_export_map, m_clock,
+                                             use_timer_wheel));
 #ifdef _WIN32
   m_poller.reset(new WindowsPoller(m_export_map, m_clock));
   (void) options;
 #else
 
+#ifdef HAVE_IO_URING
+  bool using_io_uring = false;
+  if ((FLAGS_use_io_uring || options.use_io_uring) && !options.force_select) {
+    std::auto_ptr<IOUringPoller> poller(
+        new IOUringPoller(m_export_map, m_clock));
+    if (poller->Init()) {
+      m_poller.reset(poller.release());
+      using_io_uring = true;
+    } else {
+      OLA_WARN << "io_uring isn't available, falling back";
+    }
+  }
+  if (m_export_map) {
+    m_export_map->GetBoolVar("using-io-uring")->Set(using_io_uring);
+  }
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_EPOLL
-  if (FLAGS_use_epoll && !options.force_select) {
+  bool using_epoll = false;
+  if (FLAGS_use_epoll && !m_poller.get() && !options.force_select) {
     m_poller.reset(new EPoller(m_export_map, m_clock));
+    using_epoll = true;
   }
   if (m_export_map) {
-    m_export_map->GetBoolVar("using-epoll")->Set(FLAGS_use_epoll);
+    m_export_map->GetBoolVar("using-epoll")->Set(using_epoll);
   }
 #endif  // HAVE_EPOLL
 
@@ -317,20 +430,58 @@ void SelectServer::Init(const Options &options) {
   }
 #endif  // HAVE_KQUEUE
 
+  // poll() doesn't have select()'s FD_SETSIZE limit, so prefer it.
+  bool using_poll = false;
+  if (FLAGS_use_poll && !m_poller.get() && !options.force_select) {
+    m_poller.reset(new PollPoller(m_export_map, m_clock));
+    using_poll = true;
+  }
+  if (m_export_map) {
+    m_export_map->GetBoolVar("using-poll")->Set(using_poll);
+  }
+
   // Default to the SelectPoller
   if (!m_poller.get()) {
     m_poller.reset(new SelectPoller(m_export_map, m_clock));
   }
 #endif  // _WIN32
 
+#ifdef _WIN32
+  bool profile_handlers = options.profile_handlers;
+  TimeInterval handler_budget = options.handler_budget;
+#else
+  bool profile_handlers = FLAGS_profile_event_loop || options.profile_handlers;
+  TimeInterval handler_budget = options.profile_handlers ?
+      options.handler_budget :
+      TimeInterval(static_cast<int64_t>(FLAGS_event_handler_budget_us));
+#endif  // _WIN32
+  if (profile_handlers) {
+    m_profiler.reset(new LoopProfiler(m_export_map, m_clock, handler_budget));
+    m_poller->SetProfiler(m_profiler.get());
+    m_timeout_manager->SetProfiler(m_profiler.get());
+  }
+
+#ifdef _WIN32
+  m_busy_poll = options.busy_poll;
+#else
+  m_busy_poll = options.busy_poll.IsZero() ?
+      TimeInterval(static_cast<int64_t>(FLAGS_busy_poll_us)) :
+      options.busy_poll;
+#endif  // _WIN32
+  if (!m_busy_poll.IsZero() && m_export_map) {
+    m_spin_events = m_export_map->GetCounterVar("ss-busy-poll-spin-events");
+    m_block_events = m_export_map->GetCounterVar("ss-busy-poll-block-events");
+    m_spin_time = m_export_map->GetCounterVar("ss-busy-poll-spin-time-us");
+  }
+
   // TODO(simon): this should really be in an Init() method that returns a
   // bool.
-  if (!m_incoming_descriptor.Init()) {
-    OLA_FATAL << "Failed to init LoopbackDescriptor, Execute() won't work!";
+  m_wake_up_descriptor.reset(WakeUpDescriptor::New());
+  if (!m_wake_up_descriptor->Init(
+        ola::NewCallback(this, &SelectServer::DrainAndExecute))) {
+    OLA_FATAL << "Failed to init WakeUpDescriptor, Execute() won't work!";
   }
-  m_incoming_descriptor.SetOnData(
-      ola::NewCallback(this, &SelectServer::DrainAndExecute));
-  AddReadDescriptor(&m_incoming_descriptor);
+  m_wake_up_descriptor->AddTo(m_poller.get());
 }
 
 /*
@@ -354,27 +505,102 @@ bool SelectServer::CheckForEvents(const TimeInterval &poll_interval) {
   return m_poller->Poll(m_timeout_manager.get(), default_poll_interval);
 }
 
-void SelectServer::DrainAndExecute() {
-  while (m_incoming_descriptor.DataRemaining()) {
-    // try to get everything in one read
-    uint8_t message[100];
-    unsigned int size;
-    m_incoming_descriptor.Receive(reinterpret_cast<uint8_t*>(&message),
-                                  sizeof(message), size);
+/*
+ * Poll without blocking until an event arrives or the spin budget runs out,
+ * then block as usual.
+ * @return false on error, true on success.
+ */
+bool SelectServer::BusyPoll() {
+  TimeStamp start, now;
+  m_clock->CurrentMonotonicTime(&start);
+  const TimeStamp deadline = start + m_busy_poll;
+  now = start;
+
+  bool found_event = false;
+  while (!m_terminate && now < deadline) {
+    if (!CheckForEvents(TimeInterval(0, 0))) {
+      return false;
+    }
+    m_clock->CurrentMonotonicTime(&now);
+    if (m_poller->ReadyCount()) {
+      found_event = true;
+      break;
+    }
   }
 
-  // We can't hold the mutex while we execute the callback, so instead we swap
-  // out the vector under a lock, release the lock and then run all the
-  // callbacks.
-  Callbacks callbacks_to_run;
-  {
-    thread::MutexLocker lock(&m_incoming_mutex);
-    callbacks_to_run.swap(m_incoming_callbacks);
+  if (m_spin_time) {
+    (*m_spin_time) += static_cast<unsigned int>((now - start).AsInt());
+  }
+  if (found_event) {
+    if (m_spin_events) {
+      (*m_spin_events)++;
+    }
+    return true;
+  }
+  if (m_terminate) {
+    return true;
   }
 
+  if (!CheckForEvents(m_poll_interval)) {
+    return false;
+  }
+  if (m_poller->ReadyCount() && m_block_events) {
+    (*m_block_events)++;
+  }
+  return true;
+}
+
+/*
+ * Ask the kernel to busy poll the network device when reading from a socket.
+ * Descriptors that aren't sockets are ignored.
+ */
+void SelectServer::EnableBusyPoll(const DescriptorHandle &handle) {
+#if !defined(_WIN32) && defined(SO_BUSY_POLL)
+  const int fd = ToFD(handle);
+  int busy_poll_us = static_cast<int>(m_busy_poll.AsInt());
+  if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us,
+                 sizeof(busy_poll_us)) < 0) {
+    if (errno != ENOTSOCK) {
+      // Raising the value above net.core.busy_read needs CAP_NET_ADMIN.
+      OLA_DEBUG << "Failed to set SO_BUSY_POLL on " << fd << ": "
+                << strerror(errno);
+    }
+    return;
+  }
+#ifdef SO_PREFER_BUSY_POLL
+  int prefer = 1;
+  if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer,
+                 sizeof(prefer)) < 0) {
+    OLA_DEBUG << "Failed to set SO_PREFER_BUSY_POLL on " << fd << ": "
+              << strerror(errno);
+  }
+#endif  // SO_PREFER_BUSY_POLL
+#else
+  (void) handle;
+#endif  // !_WIN32 && SO_BUSY_POLL
+}
+
+void SelectServer::DrainAndExecute() {
+  // Take everything that's queued before running any of the callbacks, so a
+  // callback that calls Execute() runs on the next wake up rather than this
+  // one.
+  Callbacks callbacks_to_run;
+  PopCallbacks(&callbacks_to_run);
   RunCallbacks(&callbacks_to_run);
 }
 
+/*
+ * Move the queued callbacks into a vector.
+ * @returns true if any callbacks were removed from the queue.
+ */
+bool SelectServer::PopCallbacks(Callbacks *callbacks) {
+  ola::BaseCallback0<void> *callback;
+  while (m_incoming_callbacks.Pop(&callback)) {
+    callbacks->push_back(callback);
+  }
+  return !callbacks->empty();
+}
+
 void SelectServer::RunCallbacks(Callbacks *callbacks) {
   Callbacks::iterator iter = callbacks->begin();
   for (; iter != callbacks->end(); ++iter) {
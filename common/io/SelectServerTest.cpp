@@ -41,10 +41,12 @@
 #include "ola/network/Socket.h"
 #include "ola/testing/TestUtils.h"
 
+using ola::CounterVariable;
 using ola::ExportMap;
 using ola::IntegerVariable;
 using ola::NewCallback;
 using ola::NewSingleCallback;
+using ola::TimeInterval;
 using ola::TimeStamp;
 using ola::io::ConnectedDescriptor;
 using ola::io::LoopbackDescriptor;
@@ -52,6 +54,9 @@ using ola::io::PollerInterface;
 using ola::io::SelectServer;
 using ola::io::UnixSocket;
 using ola::io::WriteFileDescriptor;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
 using ola::network::UDPSocket;
 using std::auto_ptr;
 using std::set;
@@ -90,11 +95,14 @@ class SelectServerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRemoveOthersWhenWriteable);
 #ifndef _WIN32
   CPPUNIT_TEST(testReadWriteInteraction);
+  CPPUNIT_TEST(testEdgeTriggered);
 #endif  // !_WIN32
+  CPPUNIT_TEST(testReplaceDescriptorWhenReadable);
   CPPUNIT_TEST(testShutdownWithActiveDescriptors);
   CPPUNIT_TEST(testTimeout);
   CPPUNIT_TEST(testOffByOneTimeout);
   CPPUNIT_TEST(testLoopCallbacks);
+  CPPUNIT_TEST(testBusyPoll);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -111,10 +119,13 @@ class SelectServerTest: public CppUnit::TestFixture {
   void testRemoveOthersWhenReadable();
   void testRemoveOthersWhenWriteable();
   void testReadWriteInteraction();
+  void testEdgeTriggered();
+  void testReplaceDescriptorWhenReadable();
   void testShutdownWithActiveDescriptors();
   void testTimeout();
   void testOffByOneTimeout();
   void testLoopCallbacks();
+  void testBusyPoll();
 
   void FatalTimeout() {
     OLA_FAIL("Fatal Timeout");
@@ -187,9 +198,44 @@ class SelectServerTest: public CppUnit::TestFixture {
 
   void IncrementLoopCounter() { m_loop_counter++; }
 
+  // Read datagrams until the socket is empty.
+  void DrainSocket(UDPSocket *socket) {
+    uint8_t data[4][10];
+    UDPDatagram datagrams[4];
+    unsigned int received;
+    do {
+      for (unsigned int i = 0; i < arraysize(datagrams); i++) {
+        datagrams[i].buffer.iov_base = data[i];
+        datagrams[i].buffer.iov_len = sizeof(data[i]);
+      }
+      received = socket->RecvMultiple(datagrams, arraysize(datagrams));
+      m_read_counter += received;
+    } while (received == arraysize(datagrams));
+  }
+
+  /*
+   * Remove and close the other socket, and open a replacement that will
+   * probably get the same fd.
+   */
+  void ReplaceOtherSocket(UDPSocket *socket, UDPSocket *other,
+                          UDPSocket *replacement) {
+    DrainSocket(socket);
+    m_ss->RemoveReadDescriptor(other);
+    other->Close();
+    OLA_ASSERT_TRUE(replacement->Init());
+    replacement->SetOnData(
+        NewCallback(this, &SelectServerTest::UnexpectedRead));
+    OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(replacement));
+  }
+
+  void UnexpectedRead() {
+    OLA_FAIL("Read called for the wrong descriptor");
+  }
+
  private:
   unsigned int m_timeout_counter;
   unsigned int m_loop_counter;
+  unsigned int m_read_counter;
   ExportMap m_map;
   IntegerVariable *connected_read_descriptor_count;
   IntegerVariable *read_descriptor_count;
@@ -211,6 +257,7 @@ void SelectServerTest::setUp() {
   m_ss = new SelectServer(&m_map);
   m_timeout_counter = 0;
   m_loop_counter = 0;
+  m_read_counter = 0;
 
 #if _WIN32
   WSADATA wsa_data;
@@ -231,7 +278,7 @@ void SelectServerTest::tearDown() {
  * Confirm we can't add invalid descriptors to the SelectServer
  */
 void SelectServerTest::testAddInvalidDescriptor() {
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());  // internal socket
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -242,7 +289,7 @@ void SelectServerTest::testAddInvalidDescriptor() {
   m_ss->RemoveReadDescriptor(&bad_socket);
   m_ss->RemoveWriteDescriptor(&bad_socket);
 
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 }
@@ -251,7 +298,7 @@ void SelectServerTest::testAddInvalidDescriptor() {
  * Confirm we can't add the same descriptor twice.
  */
 void SelectServerTest::testDoubleAddAndRemove() {
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());  // internal socket
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -259,22 +306,22 @@ void SelectServerTest::testDoubleAddAndRemove() {
   loopback.Init();
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
   OLA_ASSERT_TRUE(m_ss->AddWriteDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, write_descriptor_count->Get());
 
   m_ss->RemoveReadDescriptor(&loopback);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, write_descriptor_count->Get());
 
   m_ss->RemoveWriteDescriptor(&loopback);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -289,7 +336,7 @@ void SelectServerTest::testDoubleAddAndRemove() {
  * export map is updated.
  */
 void SelectServerTest::testAddRemoveReadDescriptor() {
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -297,7 +344,7 @@ void SelectServerTest::testAddRemoveReadDescriptor() {
   loopback.Init();
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -305,18 +352,18 @@ void SelectServerTest::testAddRemoveReadDescriptor() {
   UDPSocket udp_socket;
   OLA_ASSERT_TRUE(udp_socket.Init());
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&udp_socket));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
   // Check remove works
   m_ss->RemoveReadDescriptor(&loopback);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
   m_ss->RemoveReadDescriptor(&udp_socket);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 }
@@ -336,14 +383,14 @@ void SelectServerTest::testRemoteEndClose() {
       read_set, write_set, delete_set));
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
   // now the Write end closes
   loopback.CloseClient();
 
   m_ss->Run();
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -359,14 +406,14 @@ void SelectServerTest::testRemoteEndCloseWithDelete() {
       this, &SelectServerTest::Terminate));
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback, true));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
   // Now the Write end closes
   loopback->CloseClient();
 
   m_ss->Run();
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -386,14 +433,14 @@ void SelectServerTest::testRemoteEndCloseWithRemoveAndDelete() {
 
   // Ownership is transferred.
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback, true));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
   // Close the write end of the descriptor.
   loopback->CloseClient();
 
   m_ss->Run();
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -421,7 +468,7 @@ void SelectServerTest::testRemoveWriteWhenOtherReadable() {
 
   m_ss->Run();
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -442,7 +489,7 @@ void SelectServerTest::testRemoveWriteWhenReadable() {
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback));
   OLA_ASSERT_TRUE(m_ss->AddWriteDescriptor(loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, write_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
@@ -452,7 +499,7 @@ void SelectServerTest::testRemoveWriteWhenReadable() {
 
   m_ss->Run();
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -481,13 +528,13 @@ void SelectServerTest::testRemoveOthersWhenReadable() {
       read_set, write_set, delete_set));
 
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(4, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(3, connected_read_descriptor_count->Get());
 
   loopback2.CloseClient();
   m_ss->Run();
 
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -521,12 +568,12 @@ void SelectServerTest::testRemoveOthersWhenWriteable() {
       this, &SelectServerTest::NullHandler));
 
   OLA_ASSERT_EQ(3, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
 
   m_ss->Run();
 
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -550,7 +597,77 @@ void SelectServerTest::testReadWriteInteraction() {
       100, ola::NewSingleCallback(this, &SelectServerTest::FatalTimeout));
   m_ss->Run();
   m_ss->RemoveReadDescriptor(&socket);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, read_descriptor_count->Get());
+}
+
+/*
+ * Check edge triggered descriptors are notified each time new data arrives.
+ */
+void SelectServerTest::testEdgeTriggered() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&address));
+  socket.SetOnData(
+      NewCallback(this, &SelectServerTest::DrainSocket, &socket));
+  socket.SetEdgeTriggered(true);
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&socket));
+
+  const uint8_t data[] = {1, 2, 3};
+  for (unsigned int i = 0; i < 6; i++) {
+    socket.SendTo(data, sizeof(data), address);
+  }
+  m_ss->RunOnce(TimeInterval(0, 100000));
+  OLA_ASSERT_EQ(6u, m_read_counter);
+
+  socket.SendTo(data, sizeof(data), address);
+  m_ss->RunOnce(TimeInterval(0, 100000));
+  OLA_ASSERT_EQ(7u, m_read_counter);
+
+  m_ss->RemoveReadDescriptor(&socket);
+  OLA_ASSERT_EQ(0, read_descriptor_count->Get());
+}
+
+/*
+ * Check that events for a descriptor that's removed during a callback aren't
+ * delivered to a new descriptor that reuses the fd.
+ */
+void SelectServerTest::testReplaceDescriptorWhenReadable() {
+  UDPSocket socket1, socket2, replacement;
+  IPV4SocketAddress address1, address2;
+  OLA_ASSERT_TRUE(socket1.Init());
+  OLA_ASSERT_TRUE(socket2.Init());
+  OLA_ASSERT_TRUE(socket1.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT_TRUE(socket2.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT_TRUE(socket1.GetSocketAddress(&address1));
+  OLA_ASSERT_TRUE(socket2.GetSocketAddress(&address2));
+
+  // Whichever socket is handled first replaces the other.
+  socket1.SetOnData(NewCallback(this, &SelectServerTest::ReplaceOtherSocket,
+                                &socket1, &socket2, &replacement));
+  socket2.SetOnData(NewCallback(this, &SelectServerTest::ReplaceOtherSocket,
+                                &socket2, &socket1, &replacement));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&socket1));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&socket2));
+
+  const uint8_t data[] = {1, 2, 3};
+  socket1.SendTo(data, sizeof(data), address1);
+  socket2.SendTo(data, sizeof(data), address2);
+  m_ss->RunOnce(TimeInterval(0, 100000));
+  OLA_ASSERT_EQ(1u, m_read_counter);
+  OLA_ASSERT_EQ(2, read_descriptor_count->Get());
+
+  m_ss->RemoveReadDescriptor(&replacement);
+  if (socket1.ValidReadDescriptor()) {
+    m_ss->RemoveReadDescriptor(&socket1);
+  } else {
+    m_ss->RemoveReadDescriptor(&socket2);
+  }
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -660,3 +777,39 @@ void SelectServerTest::testLoopCallbacks() {
   // we should have at least 5 calls to IncrementLoopCounter
   OLA_ASSERT_TRUE(m_loop_counter >= 5);
 }
+
+/*
+ * Check that the busy poll mode handles events and records the stats.
+ */
+void SelectServerTest::testBusyPoll() {
+  delete m_ss;
+  SelectServer::Options options;
+  options.export_map = &m_map;
+  options.busy_poll = TimeInterval(0, 5000);
+  m_ss = new SelectServer(options);
+
+  // Data that's waiting is found by the spin.
+  LoopbackDescriptor *loopback = new LoopbackDescriptor();
+  loopback->Init();
+  loopback->SetOnData(
+      NewCallback(this, &SelectServerTest::ReadDataAndRemove,
+                  static_cast<ConnectedDescriptor*>(loopback)));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback));
+  uint8_t data[] = {0x55};
+  OLA_ASSERT_EQ(1u, loopback->Send(data, sizeof(data)));
+  ola::thread::timeout_id timeout = m_ss->RegisterSingleTimeout(
+      1000, NewSingleCallback(this, &SelectServerTest::FatalTimeout));
+  m_ss->Run();
+  m_ss->RemoveTimeout(timeout);
+
+  CounterVariable *spin_events = m_map.GetCounterVar(
+      "ss-busy-poll-spin-events");
+  OLA_ASSERT_TRUE(spin_events->Get() >= 1);
+
+  // Timeouts still run once the spin gives up and blocks.
+  m_ss->RegisterSingleTimeout(
+      20, NewSingleCallback(this, &SelectServerTest::Terminate));
+  m_ss->Run();
+  OLA_ASSERT_TRUE(
+      m_map.GetCounterVar("ss-busy-poll-spin-time-us")->Get() >= 5000);
+}
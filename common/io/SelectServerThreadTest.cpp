@@ -31,6 +31,8 @@
 // to be after WinSock2.h, hence this order
 #include "ola/thread/Thread.h"
 
+#include <vector>
+
 using ola::io::SelectServer;
 using ola::network::UDPSocket;
 using ola::thread::ThreadId;
@@ -66,18 +68,77 @@ class TestThread: public ola::thread::Thread {
 };
 
 
+/*
+ * Counts callbacks and terminates the SelectServer once all have run.
+ */
+class CallbackCounter {
+ public:
+    CallbackCounter(SelectServer *ss, unsigned int expected)
+        : m_ss(ss),
+          m_expected(expected),
+          m_count(0) {
+    }
+
+    void Increment() {
+      m_count++;
+      if (m_count == m_expected) {
+        m_ss->Terminate();
+      }
+    }
+
+    unsigned int Count() const { return m_count; }
+
+ private:
+    SelectServer *m_ss;
+    const unsigned int m_expected;
+    unsigned int m_count;
+};
+
+
+/*
+ * Calls Execute() many times in a row.
+ */
+class BurstThread: public ola::thread::Thread {
+ public:
+    BurstThread(SelectServer *ss, CallbackCounter *counter,
+                unsigned int count)
+        : m_ss(ss),
+          m_counter(counter),
+          m_count(count) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 0; i < m_count; i++) {
+        m_ss->Execute(
+            ola::NewSingleCallback(m_counter, &CallbackCounter::Increment));
+      }
+      return NULL;
+    }
+
+ private:
+    SelectServer *m_ss;
+    CallbackCounter *m_counter;
+    unsigned int m_count;
+};
+
+
 class SelectServerThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SelectServerThreadTest);
   CPPUNIT_TEST(testSameThreadCallback);
   CPPUNIT_TEST(testDifferentThreadCallback);
+  CPPUNIT_TEST(testManyThreadCallbacks);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testSameThreadCallback();
   void testDifferentThreadCallback();
+  void testManyThreadCallbacks();
 
  private:
   SelectServer m_ss;
+
+  static const unsigned int THREAD_COUNT = 4;
+  static const unsigned int CALLBACKS_PER_THREAD = 1000;
 };
 
 
@@ -108,3 +169,27 @@ void SelectServerThreadTest::testDifferentThreadCallback() {
   test_thread.Join();
   OLA_ASSERT_TRUE(test_thread.CallbackRun());
 }
+
+
+/*
+ * Check that bursts of callbacks from many threads all run in the
+ * SelectServer thread.
+ */
+void SelectServerThreadTest::testManyThreadCallbacks() {
+  CallbackCounter counter(&m_ss, THREAD_COUNT * CALLBACKS_PER_THREAD);
+
+  std::vector<BurstThread*> threads;
+  for (unsigned int i = 0; i < THREAD_COUNT; i++) {
+    threads.push_back(
+        new BurstThread(&m_ss, &counter, CALLBACKS_PER_THREAD));
+    threads.back()->Start();
+  }
+  m_ss.Run();
+
+  std::vector<BurstThread*>::iterator iter = threads.begin();
+  for (; iter != threads.end(); ++iter) {
+    (*iter)->Join();
+    delete *iter;
+  }
+  OLA_ASSERT_EQ(THREAD_COUNT * CALLBACKS_PER_THREAD, counter.Count());
+}
@@ -0,0 +1,256 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ThreadSafeMemoryBlockPool.cpp
+ * A MemoryBlockPool that can be shared between threads.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * This uses the magazine and depot design from Bonwick's "Magazines and
+ * Vmem" paper. The counters are updated with atomics so the stats can be read
+ * from any thread, everything else in the depot is protected by the mutex.
+ */
+
+#include <pthread.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/io/ThreadSafeMemoryBlockPool.h"
+
+namespace ola {
+namespace io {
+
+using ola::thread::MutexLocker;
+using std::set;
+using std::vector;
+
+ThreadSafeMemoryBlockPool::ThreadSafeMemoryBlockPool(const Options &options)
+    : MemoryBlockPool(options.block_size),
+      m_options(options),
+      m_blocks_allocated(0),
+      m_free_blocks(0),
+      m_heap_allocations(0),
+      m_blocks_discarded(0) {
+  if (pthread_key_create(&m_cache_key, FlushThreadCache)) {
+    OLA_FATAL << "Failed to create the thread key for a memory pool";
+  }
+}
+
+
+ThreadSafeMemoryBlockPool::~ThreadSafeMemoryBlockPool() {
+  // After this, exiting threads won't call FlushThreadCache().
+  pthread_key_delete(m_cache_key);
+
+  set<ThreadCache*>::iterator cache_iter = m_caches.begin();
+  for (; cache_iter != m_caches.end(); ++cache_iter) {
+    m_full_magazines.push_back((*cache_iter)->loaded);
+    m_full_magazines.push_back((*cache_iter)->previous);
+    delete *cache_iter;
+  }
+  m_caches.clear();
+
+  vector<Magazine*>::iterator iter = m_full_magazines.begin();
+  for (; iter != m_full_magazines.end(); ++iter) {
+    DeleteBlocks(*iter, 0);
+    delete *iter;
+  }
+  for (iter = m_empty_magazines.begin(); iter != m_empty_magazines.end();
+       ++iter) {
+    delete *iter;
+  }
+}
+
+
+MemoryBlock *ThreadSafeMemoryBlockPool::Allocate() {
+  ThreadCache *cache = GetThreadCache();
+  if (cache->loaded->empty()) {
+    std::swap(cache->loaded, cache->previous);
+  }
+
+  if (cache->loaded->empty()) {
+    MutexLocker locker(&m_mutex);
+    if (!m_full_magazines.empty()) {
+      m_empty_magazines.push_back(cache->loaded);
+      cache->loaded = m_full_magazines.back();
+      m_full_magazines.pop_back();
+    }
+  }
+
+  if (!cache->loaded->empty()) {
+    MemoryBlock *block = cache->loaded->back();
+    cache->loaded->pop_back();
+    __atomic_sub_fetch(&m_free_blocks, 1, __ATOMIC_RELAXED);
+    return block;
+  }
+
+  uint8_t *data = new uint8_t[m_options.block_size];
+  __atomic_add_fetch(&m_blocks_allocated, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&m_heap_allocations, 1, __ATOMIC_RELAXED);
+  return new MemoryBlock(data, m_options.block_size);
+}
+
+
+void ThreadSafeMemoryBlockPool::Release(MemoryBlock *block) {
+  if (!block) {
+    return;
+  }
+
+  if (m_options.max_free_bytes &&
+      (static_cast<size_t>(FreeBlocks()) + 1) * m_options.block_size >
+      m_options.max_free_bytes) {
+    DeleteBlock(block);
+    __atomic_add_fetch(&m_blocks_discarded, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  ThreadCache *cache = GetThreadCache();
+  if (cache->loaded->size() >= m_options.magazine_size) {
+    std::swap(cache->loaded, cache->previous);
+  }
+
+  if (cache->loaded->size() >= m_options.magazine_size) {
+    MutexLocker locker(&m_mutex);
+    m_full_magazines.push_back(cache->loaded);
+    cache->loaded = NewMagazine();
+  }
+
+  cache->loaded->push_back(block);
+  __atomic_add_fetch(&m_free_blocks, 1, __ATOMIC_RELAXED);
+}
+
+
+unsigned int ThreadSafeMemoryBlockPool::FreeBlocks() const {
+  return __atomic_load_n(&m_free_blocks, __ATOMIC_RELAXED);
+}
+
+
+void ThreadSafeMemoryBlockPool::Purge(unsigned int remaining) {
+  ThreadCache *cache = static_cast<ThreadCache*>(
+      pthread_getspecific(m_cache_key));
+
+  MutexLocker locker(&m_mutex);
+  while (!m_full_magazines.empty() && FreeBlocks() > remaining) {
+    Magazine *magazine = m_full_magazines.back();
+    DeleteBlocks(magazine, remaining);
+    if (!magazine->empty()) {
+      break;
+    }
+    m_full_magazines.pop_back();
+    m_empty_magazines.push_back(magazine);
+  }
+
+  // Keep the blocks in this thread's magazines for as long as possible.
+  if (cache) {
+    DeleteBlocks(cache->previous, remaining);
+    DeleteBlocks(cache->loaded, remaining);
+  }
+}
+
+
+unsigned int ThreadSafeMemoryBlockPool::BlocksAllocated() const {
+  return __atomic_load_n(&m_blocks_allocated, __ATOMIC_RELAXED);
+}
+
+
+uint64_t ThreadSafeMemoryBlockPool::HeapAllocations() const {
+  return __atomic_load_n(&m_heap_allocations, __ATOMIC_RELAXED);
+}
+
+
+uint64_t ThreadSafeMemoryBlockPool::BlocksDiscarded() const {
+  return __atomic_load_n(&m_blocks_discarded, __ATOMIC_RELAXED);
+}
+
+
+ThreadSafeMemoryBlockPool::ThreadCache*
+    ThreadSafeMemoryBlockPool::GetThreadCache() {
+  ThreadCache *cache = static_cast<ThreadCache*>(
+      pthread_getspecific(m_cache_key));
+  if (cache) {
+    return cache;
+  }
+
+  cache = new ThreadCache();
+  cache->pool = this;
+  {
+    MutexLocker locker(&m_mutex);
+    cache->loaded = NewMagazine();
+    cache->previous = NewMagazine();
+    m_caches.insert(cache);
+  }
+  pthread_setspecific(m_cache_key, cache);
+  return cache;
+}
+
+
+/*
+ * Get an empty magazine, m_mutex must be held.
+ */
+ThreadSafeMemoryBlockPool::Magazine *ThreadSafeMemoryBlockPool::NewMagazine() {
+  if (!m_empty_magazines.empty()) {
+    Magazine *magazine = m_empty_magazines.back();
+    m_empty_magazines.pop_back();
+    return magazine;
+  }
+  Magazine *magazine = new Magazine();
+  magazine->reserve(m_options.magazine_size);
+  return magazine;
+}
+
+
+/*
+ * Delete blocks from a magazine until there are only remaining free blocks in
+ * the pool.
+ */
+void ThreadSafeMemoryBlockPool::DeleteBlocks(Magazine *magazine,
+                                             unsigned int remaining) {
+  while (!magazine->empty() && FreeBlocks() > remaining) {
+    DeleteBlock(magazine->back());
+    magazine->pop_back();
+    __atomic_sub_fetch(&m_free_blocks, 1, __ATOMIC_RELAXED);
+  }
+}
+
+
+void ThreadSafeMemoryBlockPool::DeleteBlock(MemoryBlock *block) {
+  delete block;
+  __atomic_sub_fetch(&m_blocks_allocated, 1, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * Called when a thread exits, this moves the thread's free blocks to the
+ * depot.
+ */
+void ThreadSafeMemoryBlockPool::FlushThreadCache(void *data) {
+  ThreadCache *cache = static_cast<ThreadCache*>(data);
+  ThreadSafeMemoryBlockPool *pool = cache->pool;
+
+  MutexLocker locker(&pool->m_mutex);
+  Magazine *magazines[] = {cache->loaded, cache->previous};
+  for (unsigned int i = 0; i < arraysize(magazines); i++) {
+    if (magazines[i]->empty()) {
+      pool->m_empty_magazines.push_back(magazines[i]);
+    } else {
+      pool->m_full_magazines.push_back(magazines[i]);
+    }
+  }
+  pool->m_caches.erase(cache);
+  delete cache;
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,262 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ThreadSafeMemoryBlockPoolTest.cpp
+ * Test fixture for the ThreadSafeMemoryBlockPool class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <set>
+#include <vector>
+
+#include "ola/io/MemoryBlock.h"
+#include "ola/io/ThreadSafeMemoryBlockPool.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
+
+using ola::io::MemoryBlock;
+using ola::io::ThreadSafeMemoryBlockPool;
+using std::set;
+using std::vector;
+
+class ThreadSafeMemoryBlockPoolTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ThreadSafeMemoryBlockPoolTest);
+  CPPUNIT_TEST(testAllocateRelease);
+  CPPUNIT_TEST(testDepot);
+  CPPUNIT_TEST(testFreeLimit);
+  CPPUNIT_TEST(testPurge);
+  CPPUNIT_TEST(testMultipleThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testAllocateRelease();
+    void testDepot();
+    void testFreeLimit();
+    void testPurge();
+    void testMultipleThreads();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadSafeMemoryBlockPoolTest);
+
+
+/*
+ * Allocates blocks, and optionally releases them.
+ */
+class AllocateThread: public ola::thread::Thread {
+ public:
+  AllocateThread(ThreadSafeMemoryBlockPool *pool, unsigned int count,
+                 bool release)
+      : Thread(),
+        m_pool(pool),
+        m_count(count),
+        m_release(release) {
+  }
+
+  const vector<MemoryBlock*> &Blocks() const { return m_blocks; }
+
+ protected:
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      m_blocks.push_back(m_pool->Allocate());
+    }
+    if (m_release) {
+      vector<MemoryBlock*>::iterator iter = m_blocks.begin();
+      for (; iter != m_blocks.end(); ++iter) {
+        m_pool->Release(*iter);
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  ThreadSafeMemoryBlockPool *m_pool;
+  const unsigned int m_count;
+  const bool m_release;
+  vector<MemoryBlock*> m_blocks;
+};
+
+
+/*
+ * Check that released blocks are handed out again.
+ */
+void ThreadSafeMemoryBlockPoolTest::testAllocateRelease() {
+  ThreadSafeMemoryBlockPool::Options options;
+  options.block_size = ThreadSafeMemoryBlockPool::DMX_BLOCK_SIZE;
+  ThreadSafeMemoryBlockPool pool(options);
+  OLA_ASSERT_EQ(ThreadSafeMemoryBlockPool::DMX_BLOCK_SIZE, pool.BlockSize());
+
+  MemoryBlock *block1 = pool.Allocate();
+  MemoryBlock *block2 = pool.Allocate();
+  OLA_ASSERT_NOT_NULL(block1);
+  OLA_ASSERT_NOT_NULL(block2);
+  OLA_ASSERT_NE(block1, block2);
+  OLA_ASSERT_EQ(ThreadSafeMemoryBlockPool::DMX_BLOCK_SIZE,
+                block1->Capacity());
+  OLA_ASSERT_EQ(2u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), pool.HeapAllocations());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+
+  pool.Release(block1);
+  pool.Release(block2);
+  OLA_ASSERT_EQ(2u, pool.FreeBlocks());
+
+  // Blocks come from the magazine, most recently released first.
+  OLA_ASSERT_EQ(block2, pool.Allocate());
+  OLA_ASSERT_EQ(block1, pool.Allocate());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), pool.HeapAllocations());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+
+  pool.Release(block1);
+  pool.Release(block2);
+  pool.Release(NULL);
+  OLA_ASSERT_EQ(2u, pool.FreeBlocks());
+}
+
+
+/*
+ * Check that blocks go via the depot once a thread's magazines are full.
+ */
+void ThreadSafeMemoryBlockPoolTest::testDepot() {
+  ThreadSafeMemoryBlockPool::Options options;
+  options.magazine_size = 2;
+  ThreadSafeMemoryBlockPool pool(options);
+
+  vector<MemoryBlock*> blocks;
+  for (unsigned int i = 0; i < 10; i++) {
+    blocks.push_back(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), pool.HeapAllocations());
+
+  vector<MemoryBlock*>::iterator iter = blocks.begin();
+  for (; iter != blocks.end(); ++iter) {
+    pool.Release(*iter);
+  }
+  OLA_ASSERT_EQ(10u, pool.FreeBlocks());
+
+  set<MemoryBlock*> reused;
+  for (unsigned int i = 0; i < 10; i++) {
+    reused.insert(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(10), reused.size());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), pool.HeapAllocations());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+
+  set<MemoryBlock*>::iterator reused_iter = reused.begin();
+  for (; reused_iter != reused.end(); ++reused_iter) {
+    pool.Release(*reused_iter);
+  }
+}
+
+
+/*
+ * Check that the pool doesn't keep more than max_free_bytes of free blocks.
+ */
+void ThreadSafeMemoryBlockPoolTest::testFreeLimit() {
+  ThreadSafeMemoryBlockPool::Options options;
+  options.block_size = ThreadSafeMemoryBlockPool::MTU_BLOCK_SIZE;
+  options.max_free_bytes = 2 * ThreadSafeMemoryBlockPool::MTU_BLOCK_SIZE;
+  ThreadSafeMemoryBlockPool pool(options);
+
+  vector<MemoryBlock*> blocks;
+  for (unsigned int i = 0; i < 4; i++) {
+    blocks.push_back(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(4u, pool.BlocksAllocated());
+
+  vector<MemoryBlock*>::iterator iter = blocks.begin();
+  for (; iter != blocks.end(); ++iter) {
+    pool.Release(*iter);
+  }
+  OLA_ASSERT_EQ(2u, pool.FreeBlocks());
+  OLA_ASSERT_EQ(2u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), pool.BlocksDiscarded());
+}
+
+
+/*
+ * Check Purge() frees blocks from the depot and this thread's magazines.
+ */
+void ThreadSafeMemoryBlockPoolTest::testPurge() {
+  ThreadSafeMemoryBlockPool::Options options;
+  options.block_size = ThreadSafeMemoryBlockPool::RDM_BLOCK_SIZE;
+  options.magazine_size = 2;
+  ThreadSafeMemoryBlockPool pool(options);
+
+  vector<MemoryBlock*> blocks;
+  for (unsigned int i = 0; i < 9; i++) {
+    blocks.push_back(pool.Allocate());
+  }
+  vector<MemoryBlock*>::iterator iter = blocks.begin();
+  for (; iter != blocks.end(); ++iter) {
+    pool.Release(*iter);
+  }
+  OLA_ASSERT_EQ(9u, pool.FreeBlocks());
+
+  pool.Purge(3);
+  OLA_ASSERT_EQ(3u, pool.FreeBlocks());
+  OLA_ASSERT_EQ(3u, pool.BlocksAllocated());
+
+  pool.Purge();
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+  OLA_ASSERT_EQ(0u, pool.BlocksAllocated());
+}
+
+
+/*
+ * Check blocks can be allocated in one thread and released in another, and
+ * that a thread's blocks are returned to the depot when it exits.
+ */
+void ThreadSafeMemoryBlockPoolTest::testMultipleThreads() {
+  ThreadSafeMemoryBlockPool::Options options;
+  options.magazine_size = 4;
+  ThreadSafeMemoryBlockPool pool(options);
+
+  AllocateThread allocate_thread(&pool, 20, false);
+  OLA_ASSERT_TRUE(allocate_thread.Start());
+  OLA_ASSERT_TRUE(allocate_thread.Join());
+  OLA_ASSERT_EQ(20u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+
+  // Release the blocks in this thread.
+  vector<MemoryBlock*>::const_iterator iter =
+      allocate_thread.Blocks().begin();
+  for (; iter != allocate_thread.Blocks().end(); ++iter) {
+    pool.Release(*iter);
+  }
+  OLA_ASSERT_EQ(20u, pool.FreeBlocks());
+
+  // This thread's magazines hold 8 blocks, so another thread can use the
+  // other 12.
+  AllocateThread reuse_thread(&pool, 12, true);
+  OLA_ASSERT_TRUE(reuse_thread.Start());
+  OLA_ASSERT_TRUE(reuse_thread.Join());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(20), pool.HeapAllocations());
+  OLA_ASSERT_EQ(20u, pool.FreeBlocks());
+
+  // The second thread has exited, so all the blocks are available here.
+  set<MemoryBlock*> blocks;
+  for (unsigned int i = 0; i < 20; i++) {
+    blocks.insert(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(20), blocks.size());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(20), pool.HeapAllocations());
+
+  set<MemoryBlock*>::iterator block_iter = blocks.begin();
+  for (; block_iter != blocks.end(); ++block_iter) {
+    pool.Release(*block_iter);
+  }
+}
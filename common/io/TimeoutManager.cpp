@@ -18,11 +18,14 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <string.h>
+#include <algorithm>
 #include <queue>
 #include <set>
 #include <vector>
 
 #include "ola/Logging.h"
+#include "common/io/LoopProfiler.h"
 #include "common/io/TimeoutManager.h"
 
 namespace ola {
@@ -37,12 +40,20 @@ using ola::thread::INVALID_TIMEOUT;
 using ola::thread::timeout_id;
 
 TimeoutManager::TimeoutManager(ExportMap *export_map,
-                               Clock *clock)
+                               Clock *clock,
+                               bool use_timer_wheel)
     : m_export_map(export_map),
-      m_clock(clock) {
+      m_clock(clock),
+      m_use_timer_wheel(use_timer_wheel),
+      m_profiler(NULL),
+      m_current_tick(0),
+      m_wheel_event_count(0) {
   if (m_export_map) {
     m_export_map->GetIntegerVar(K_TIMER_VAR);
   }
+  m_clock->CurrentMonotonicTime(&m_wheel_origin);
+  memset(m_wheel, 0, sizeof(m_wheel));
+  memset(m_occupied, 0, sizeof(m_occupied));
 }
 
 TimeoutManager::~TimeoutManager() {
@@ -52,6 +63,20 @@ TimeoutManager::~TimeoutManager() {
     delete m_events.top();
     m_events.pop();
   }
+
+  for (unsigned int i = 0; i <= WHEEL_SLOTS; i++) {
+    Event *event = m_wheel[i];
+    while (event) {
+      Event *next = event->next;
+      delete event;
+      event = next;
+    }
+  }
+
+  std::vector<Event*>::iterator iter = m_free_events.begin();
+  for (; iter != m_free_events.end(); ++iter) {
+    delete *iter;
+  }
 }
 
 timeout_id TimeoutManager::RegisterRepeatingTimeout(
@@ -60,12 +85,7 @@ timeout_id TimeoutManager::RegisterRepeatingTimeout(
   if (!closure)
     return INVALID_TIMEOUT;
 
-  if (m_export_map)
-    (*m_export_map->GetIntegerVar(K_TIMER_VAR))++;
-
-  Event *event = new RepeatingEvent(interval, m_clock, closure);
-  m_events.push(event);
-  return event;
+  return NewEvent(interval, NULL, closure);
 }
 
 timeout_id TimeoutManager::RegisterSingleTimeout(
@@ -74,25 +94,160 @@ timeout_id TimeoutManager::RegisterSingleTimeout(
   if (!closure)
     return INVALID_TIMEOUT;
 
-  if (m_export_map)
-    (*m_export_map->GetIntegerVar(K_TIMER_VAR))++;
-
-  Event *event = new SingleEvent(interval, m_clock, closure);
-  m_events.push(event);
-  return event;
+  return NewEvent(interval, closure, NULL);
 }
 
 void TimeoutManager::CancelTimeout(timeout_id id) {
-  // TODO(simon): just mark the timeouts as cancelled rather than using a
-  // remove set.
   if (id == INVALID_TIMEOUT)
     return;
 
+  Event *event = LookupEvent(id);
+  if (!event) {
+    // The timeout has already run or been cancelled.
+    return;
+  }
+
+  if (m_use_timer_wheel) {
+    switch (event->state) {
+      case Event::SCHEDULED:
+        WheelUnlink(event);
+        FreeEvent(event);
+        break;
+      case Event::RUNNING:
+        // The event is being run, it'll be freed once the callback returns.
+        event->state = Event::CANCELLED;
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+
+  // TODO(simon): just mark the timeouts as cancelled rather than using a
+  // remove set.
   if (!m_removed_timeouts.insert(id).second)
     OLA_WARN << "timeout " << id << " already in remove set";
 }
 
 TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
+  if (m_use_timer_wheel) {
+    return ExecuteWheelTimeouts(now);
+  } else {
+    return ExecuteHeapTimeouts(now);
+  }
+}
+
+timeout_id TimeoutManager::NewEvent(
+    const TimeInterval &interval,
+    ola::BaseCallback0<void> *single_closure,
+    ola::BaseCallback0<bool> *repeating_closure) {
+  if (m_export_map)
+    (*m_export_map->GetIntegerVar(K_TIMER_VAR))++;
+
+  Event *event;
+  if (m_free_events.empty()) {
+    event = new Event();
+  } else {
+    event = m_free_events.back();
+    m_free_events.pop_back();
+  }
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  event->Reset(interval, now, single_closure, repeating_closure);
+  event->state = Event::SCHEDULED;
+  event->id = AllocateId(event);
+
+  if (m_use_timer_wheel) {
+    m_wheel_event_count++;
+    WheelInsert(event);
+  } else {
+    m_events.push(event);
+  }
+  return event->id;
+}
+
+void TimeoutManager::FreeEvent(Event *event) {
+  if (m_export_map)
+    (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
+
+  if (m_use_timer_wheel) {
+    m_wheel_event_count--;
+  } else {
+    // The event may have cancelled itself while it was running.
+    m_removed_timeouts.erase(event->id);
+  }
+
+  if (m_profiler)
+    m_profiler->Forget(event->id);
+
+  ReleaseId(event);
+
+  event->ClearClosures();
+  event->state = Event::FREE;
+  if (m_free_events.size() < MAX_FREE_EVENTS) {
+    m_free_events.push_back(event);
+  } else {
+    delete event;
+  }
+}
+
+timeout_id TimeoutManager::AllocateId(Event *event) {
+  unsigned int index;
+  if (m_free_ids.empty()) {
+    index = m_ids.size();
+    IdEntry entry = {event, 0};
+    m_ids.push_back(entry);
+  } else {
+    index = m_free_ids.front();
+    m_free_ids.pop_front();
+    m_ids[index].event = event;
+  }
+  uintptr_t id = (m_ids[index].generation << ID_INDEX_BITS) | (index + 1);
+  return reinterpret_cast<timeout_id>(id);
+}
+
+void TimeoutManager::ReleaseId(Event *event) {
+  unsigned int index = (reinterpret_cast<uintptr_t>(event->id) &
+                        ID_INDEX_MASK) - 1;
+  IdEntry &entry = m_ids[index];
+  entry.event = NULL;
+  entry.generation = (entry.generation + 1) &
+      (~static_cast<uintptr_t>(0) >> ID_INDEX_BITS);
+  m_free_ids.push_back(index);
+  event->id = INVALID_TIMEOUT;
+}
+
+/*
+ * Find the event for an id.
+ * @returns the event, or NULL if the id has already been released.
+ */
+TimeoutManager::Event *TimeoutManager::LookupEvent(timeout_id id) const {
+  uintptr_t value = reinterpret_cast<uintptr_t>(id);
+  uintptr_t index = (value & ID_INDEX_MASK) - 1;
+  if (index >= m_ids.size())
+    return NULL;
+  const IdEntry &entry = m_ids[index];
+  if (!entry.event || entry.generation != value >> ID_INDEX_BITS)
+    return NULL;
+  return entry.event;
+}
+
+/*
+ * Run an event, timing it if there is a profiler.
+ */
+bool TimeoutManager::TriggerEvent(Event *event) {
+  if (!m_profiler)
+    return event->Trigger();
+
+  TimeStamp start;
+  m_profiler->Start(&start);
+  bool run_again = event->Trigger();
+  m_profiler->TimeoutDone(event->id, start);
+  return run_again;
+}
+
+TimeInterval TimeoutManager::ExecuteHeapTimeouts(TimeStamp *now) {
   Event *e;
   if (m_events.empty())
     return TimeInterval();
@@ -102,21 +257,17 @@ TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
     m_events.pop();
 
     // if this was removed, skip it
-    if (m_removed_timeouts.erase(e)) {
-      delete e;
-      if (m_export_map)
-        (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
+    if (m_removed_timeouts.erase(e->id)) {
+      FreeEvent(e);
       continue;
     }
 
-    if (e->Trigger()) {
+    if (TriggerEvent(e)) {
       // true implies we need to run this again
       e->UpdateTime(*now);
       m_events.push(e);
     } else {
-      delete e;
-      if (m_export_map)
-        (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
+      FreeEvent(e);
     }
     m_clock->CurrentMonotonicTime(now);
   }
@@ -126,5 +277,208 @@ TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
   else
     return m_events.top()->NextTime() - *now;
 }
+
+TimeInterval TimeoutManager::ExecuteWheelTimeouts(TimeStamp *now) {
+  uint64_t now_tick = TickFor(*now);
+  uint64_t next_tick;
+  while (m_current_tick <= now_tick) {
+    if (!NextWheelTick(&next_tick) || next_tick > now_tick) {
+      // Nothing is due, jump straight to the current time.
+      m_current_tick = now_tick + 1;
+      break;
+    }
+    m_current_tick = next_tick;
+    RunTick(next_tick, now);
+    now_tick = TickFor(*now);
+  }
+
+  if (!NextWheelTick(&next_tick))
+    return TimeInterval();
+  return (m_wheel_origin + TimeInterval(
+      static_cast<int64_t>(next_tick * ONE_THOUSAND))) - *now;
+}
+
+/*
+ * Convert a time to the number of ticks since the wheel was created.
+ */
+uint64_t TimeoutManager::TickFor(const TimeStamp &time) const {
+  if (time <= m_wheel_origin)
+    return 0;
+  return static_cast<uint64_t>((time - m_wheel_origin).AsInt()) /
+         ONE_THOUSAND;
+}
+
+/*
+ * Add an event to the wheel. Events that are already due are added to the
+ * current tick.
+ */
+void TimeoutManager::WheelInsert(Event *event) {
+  uint64_t tick = std::max(TickFor(event->NextTime()), m_current_tick);
+  uint64_t delta = tick - m_current_tick;
+
+  if (delta < LEVEL0_SLOTS) {
+    AddToSlot(event, tick & (LEVEL0_SLOTS - 1));
+    return;
+  }
+
+  unsigned int level = 1;
+  for (; level < WHEEL_LEVELS; level++) {
+    if (delta < (static_cast<uint64_t>(1) << (LevelShift(level) +
+                                              LEVEL_BITS))) {
+      break;
+    }
+  }
+
+  if (level == WHEEL_LEVELS) {
+    // Beyond the end of the wheel, park it in the furthest slot.
+    level = WHEEL_LEVELS - 1;
+    tick = m_current_tick +
+        (static_cast<uint64_t>(1) << (LevelShift(level) + LEVEL_BITS)) - 1;
+  }
+  AddToSlot(event, LevelOffset(level) +
+                   ((tick >> LevelShift(level)) & (LEVEL_SLOTS - 1)));
+}
+
+void TimeoutManager::AddToSlot(Event *event, unsigned int slot) {
+  event->slot = slot;
+  event->prev = NULL;
+  event->next = m_wheel[slot];
+  if (event->next)
+    event->next->prev = event;
+  m_wheel[slot] = event;
+  if (slot != EXPIRING_SLOT)
+    m_occupied[slot / 64] |= static_cast<uint64_t>(1) << (slot % 64);
+}
+
+void TimeoutManager::WheelUnlink(Event *event) {
+  if (event->prev) {
+    event->prev->next = event->next;
+  } else {
+    m_wheel[event->slot] = event->next;
+  }
+  if (event->next)
+    event->next->prev = event->prev;
+  event->prev = NULL;
+  event->next = NULL;
+
+  unsigned int slot = event->slot;
+  if (slot != EXPIRING_SLOT && !m_wheel[slot])
+    m_occupied[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+}
+
+/*
+ * Move the events in a higher level slot down to the lower levels.
+ */
+void TimeoutManager::Cascade(unsigned int level, uint64_t tick) {
+  unsigned int slot = LevelOffset(level) +
+                      ((tick >> LevelShift(level)) & (LEVEL_SLOTS - 1));
+  Event *event = m_wheel[slot];
+  m_wheel[slot] = NULL;
+  m_occupied[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+
+  while (event) {
+    Event *next = event->next;
+    WheelInsert(event);
+    event = next;
+  }
+}
+
+/*
+ * Run all the expired events for a tick. m_current_tick must be equal to
+ * tick. If this is the current tick, events that haven't expired yet are
+ * moved to the next one.
+ */
+void TimeoutManager::RunTick(uint64_t tick, TimeStamp *now) {
+  for (unsigned int level = WHEEL_LEVELS - 1; level > 0; level--) {
+    uint64_t mask = (static_cast<uint64_t>(1) << LevelShift(level)) - 1;
+    if ((tick & mask) == 0)
+      Cascade(level, tick);
+  }
+
+  // Move the events to the expiring list, so events registered by the
+  // callbacks end up in the future, even if they land in this slot.
+  unsigned int slot = tick & (LEVEL0_SLOTS - 1);
+  m_wheel[EXPIRING_SLOT] = m_wheel[slot];
+  m_wheel[slot] = NULL;
+  m_occupied[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+  for (Event *event = m_wheel[EXPIRING_SLOT]; event; event = event->next)
+    event->slot = EXPIRING_SLOT;
+  m_current_tick = tick + 1;
+
+  Event *event;
+  while ((event = m_wheel[EXPIRING_SLOT])) {
+    WheelUnlink(event);
+    if (event->NextTime() > *now) {
+      WheelInsert(event);
+      continue;
+    }
+
+    event->state = Event::RUNNING;
+    bool run_again = TriggerEvent(event);
+    if (run_again && event->state == Event::RUNNING) {
+      event->state = Event::SCHEDULED;
+      event->UpdateTime(*now);
+      WheelInsert(event);
+    } else {
+      FreeEvent(event);
+    }
+    m_clock->CurrentMonotonicTime(now);
+  }
+}
+
+/*
+ * Find the earliest tick that has work to do. For the higher levels this is
+ * the tick that the slot will cascade, which may be before the events in it
+ * expire.
+ * @returns false if the wheel is empty.
+ */
+bool TimeoutManager::NextWheelTick(uint64_t *tick) const {
+  if (!m_wheel_event_count)
+    return false;
+
+  bool found = false;
+  int offset = FirstOccupied(0, m_current_tick & (LEVEL0_SLOTS - 1));
+  if (offset >= 0) {
+    *tick = m_current_tick + offset;
+    found = true;
+  }
+
+  for (unsigned int level = 1; level < WHEEL_LEVELS; level++) {
+    unsigned int shift = LevelShift(level);
+    uint64_t group = (m_current_tick + (static_cast<uint64_t>(1) << shift) -
+                      1) >> shift;
+    offset = FirstOccupied(level, group & (LEVEL_SLOTS - 1));
+    if (offset >= 0) {
+      uint64_t cascade_tick = (group + offset) << shift;
+      if (!found || cascade_tick < *tick) {
+        *tick = cascade_tick;
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+/*
+ * Returns the distance from start to the first occupied slot in a level, or
+ * -1 if the level is empty.
+ */
+int TimeoutManager::FirstOccupied(unsigned int level,
+                                  unsigned int start) const {
+  // Each level starts on a word boundary.
+  const uint64_t *bitmap = m_occupied + LevelOffset(level) / 64;
+  unsigned int slots = LevelSlots(level);
+  unsigned int offset = 0;
+  while (offset < slots) {
+    unsigned int index = (start + offset) & (slots - 1);
+    uint64_t word = bitmap[index / 64] >> (index % 64);
+    if (word) {
+      offset += __builtin_ctzll(word);
+      return offset < slots ? static_cast<int>(offset) : -1;
+    }
+    offset += 64 - index % 64;
+  }
+  return -1;
+}
 }  // namespace io
 }  // namespace ola
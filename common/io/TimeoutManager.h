@@ -21,6 +21,8 @@
 #ifndef COMMON_IO_TIMEOUTMANAGER_H_
 #define COMMON_IO_TIMEOUTMANAGER_H_
 
+#include <stdint.h>
+#include <deque>
 #include <queue>
 #include <set>
 #include <vector>
@@ -34,6 +36,7 @@
 namespace ola {
 namespace io {
 
+class LoopProfiler;
 
 /**
  * @class TimeoutManager
@@ -41,6 +44,16 @@ namespace io {
  *
  * The TimeoutManager allows Callbacks to trigger at some point in the future.
  * Callbacks can be invoked once, or periodically.
+ *
+ * Timeouts are either kept in a binary heap, or in a hierarchical timer wheel.
+ * The heap has O(log n) registration and leaves cancelled timeouts in the
+ * queue until they expire. The wheel has O(1) registration and cancellation,
+ * but timeouts may run up to a millisecond late.
+ *
+ * In both cases the Event objects are recycled, so registering a timeout
+ * doesn't normally allocate, apart from the Callback itself. The timeout_id
+ * includes a generation number, so cancelling a timeout that has already run
+ * doesn't affect a later timeout that reuses the Event.
  */
 class TimeoutManager {
  public :
@@ -48,8 +61,10 @@ class TimeoutManager {
    * @brief Create a new TimeoutManager.
    * @param export_map an ExportMap to update
    * @param clock the Clock to use.
+   * @param use_timer_wheel use a timer wheel rather than a heap.
    */
-  TimeoutManager(ola::ExportMap *export_map, Clock *clock);
+  TimeoutManager(ola::ExportMap *export_map, Clock *clock,
+                 bool use_timer_wheel = false);
 
   ~TimeoutManager();
 
@@ -85,11 +100,12 @@ class TimeoutManager {
 
   /**
    * @brief Check if there are any events in the queue.
-   * Events remain in the queue even if they have been cancelled.
+   * When using the heap, events remain in the queue even if they have been
+   * cancelled.
    * @returns true if there are events pending, false otherwise.
    */
   bool EventsPending() const {
-    return !m_events.empty();
+    return m_use_timer_wheel ? m_wheel_event_count > 0 : !m_events.empty();
   }
 
   /**
@@ -100,82 +116,94 @@ class TimeoutManager {
    */
   TimeInterval ExecuteTimeouts(TimeStamp *now);
 
+  /**
+   * @brief Record the time taken by each timeout.
+   * @param profiler the LoopProfiler to use, ownership is not transferred. May
+   *   be NULL to turn off profiling.
+   */
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
   static const char K_TIMER_VAR[];
 
  private :
+  /*
+   * A single or repeating event. Events are pooled, so rather than
+   * subclassing, an event holds one of the two callback types.
+   */
   class Event {
    public:
-    explicit Event(const TimeInterval &interval, const Clock *clock)
-        : m_interval(interval) {
-      TimeStamp now;
-      clock->CurrentMonotonicTime(&now);
-      m_next = now + m_interval;
+    Event()
+        : id(ola::thread::INVALID_TIMEOUT),
+          prev(NULL),
+          next(NULL),
+          slot(0),
+          state(FREE),
+          m_single_closure(NULL),
+          m_repeating_closure(NULL) {
     }
-    virtual ~Event() {}
-    virtual bool Trigger() = 0;
 
-    void UpdateTime(const TimeStamp &now) {
-      m_next = now + m_interval;
-    }
-
-    TimeStamp NextTime() const { return m_next; }
+    ~Event() { ClearClosures(); }
 
-   private:
-    TimeInterval m_interval;
-    TimeStamp m_next;
-  };
-
-  // An event that only happens once
-  class SingleEvent: public Event {
-   public:
-    SingleEvent(const TimeInterval &interval,
-                const Clock *clock,
-                ola::BaseCallback0<void> *closure):
-      Event(interval, clock),
-      m_closure(closure) {
-    }
-
-    virtual ~SingleEvent() {
-      if (m_closure)
-        delete m_closure;
+    void Reset(const TimeInterval &interval,
+               const TimeStamp &now,
+               ola::BaseCallback0<void> *single_closure,
+               ola::BaseCallback0<bool> *repeating_closure) {
+      m_interval = interval;
+      m_next = now + m_interval;
+      m_single_closure = single_closure;
+      m_repeating_closure = repeating_closure;
     }
 
+    // Returns true if the event should be run again.
     bool Trigger() {
-      if (m_closure) {
-        m_closure->Run();
-        // it's deleted itself at this point
-        m_closure = NULL;
+      if (m_single_closure) {
+        ola::BaseCallback0<void> *closure = m_single_closure;
+        // it deletes itself when run
+        m_single_closure = NULL;
+        closure->Run();
+        return false;
+      }
+      if (m_repeating_closure) {
+        return m_repeating_closure->Run();
       }
       return false;
     }
 
-   private:
-     ola::BaseCallback0<void> *m_closure;
-  };
-
-  /*
-   * An event that occurs more than once. The closure can return false to
-   * indicate that it should not be called again.
-   */
-  class RepeatingEvent: public Event {
-   public:
-    RepeatingEvent(const TimeInterval &interval,
-                   const Clock *clock,
-                   ola::BaseCallback0<bool> *closure):
-      Event(interval, clock),
-      m_closure(closure) {
-    }
-    ~RepeatingEvent() {
-      delete m_closure;
+    void ClearClosures() {
+      delete m_single_closure;
+      m_single_closure = NULL;
+      delete m_repeating_closure;
+      m_repeating_closure = NULL;
     }
-    bool Trigger() {
-      if (!m_closure)
-        return false;
-      return m_closure->Run();
+
+    void UpdateTime(const TimeStamp &now) {
+      m_next = now + m_interval;
     }
 
+    TimeStamp NextTime() const { return m_next; }
+
+    typedef enum {
+      FREE,
+      SCHEDULED,
+      RUNNING,
+      CANCELLED,
+    } State;
+
+    ola::thread::timeout_id id;
+
+    // These are only used by the timer wheel.
+    Event *prev;
+    Event *next;
+    unsigned int slot;
+    State state;
+
    private:
-    ola::BaseCallback0<bool> *m_closure;
+    TimeInterval m_interval;
+    TimeStamp m_next;
+    ola::BaseCallback0<void> *m_single_closure;
+    ola::BaseCallback0<bool> *m_repeating_closure;
+
+    DISALLOW_COPY_AND_ASSIGN(Event);
   };
 
   struct ltevent {
@@ -187,12 +215,95 @@ class TimeoutManager {
   typedef std::priority_queue<Event*, std::vector<Event*>, ltevent>
       event_queue_t;
 
+  /*
+   * An entry in the id table. The generation is incremented each time the
+   * entry is released, so ids from earlier uses no longer match.
+   */
+  struct IdEntry {
+    Event *event;
+    uintptr_t generation;
+  };
+
+  /*
+   * The low bits of a timeout_id are the index into the id table plus one,
+   * so an id is never NULL, the high bits are the generation.
+   */
+  static const unsigned int ID_INDEX_BITS = sizeof(uintptr_t) > 4 ? 32 : 20;
+  static const uintptr_t ID_INDEX_MASK =
+      (static_cast<uintptr_t>(1) << ID_INDEX_BITS) - 1;
+
+  /*
+   * The wheel has a 1ms tick. The first level has 256 slots, the others have
+   * 64 slots each, which covers about 18 hours. Events further out than that
+   * are parked in the last level and re-inserted when it cascades.
+   */
+  static const unsigned int WHEEL_LEVELS = 4;
+  static const unsigned int LEVEL0_BITS = 8;
+  static const unsigned int LEVEL_BITS = 6;
+  static const unsigned int LEVEL0_SLOTS = 1 << LEVEL0_BITS;
+  static const unsigned int LEVEL_SLOTS = 1 << LEVEL_BITS;
+  static const unsigned int WHEEL_SLOTS =
+      LEVEL0_SLOTS + (WHEEL_LEVELS - 1) * LEVEL_SLOTS;
+  // A pseudo slot that holds the events being run.
+  static const unsigned int EXPIRING_SLOT = WHEEL_SLOTS;
+  static const unsigned int BITMAP_WORDS = (WHEEL_SLOTS + 63) / 64;
+  static const unsigned int MAX_FREE_EVENTS = 1024;
+
   ola::ExportMap *m_export_map;
   Clock *m_clock;
+  const bool m_use_timer_wheel;
+  LoopProfiler *m_profiler;
 
   event_queue_t m_events;
   std::set<ola::thread::timeout_id> m_removed_timeouts;
 
+  std::vector<Event*> m_free_events;
+  std::vector<IdEntry> m_ids;
+  // Free entries are reused in FIFO order, so a generation takes as long as
+  // possible to wrap.
+  std::deque<unsigned int> m_free_ids;
+
+  TimeStamp m_wheel_origin;
+  // All ticks less than this have been processed.
+  uint64_t m_current_tick;
+  unsigned int m_wheel_event_count;
+  Event *m_wheel[WHEEL_SLOTS + 1];
+  uint64_t m_occupied[BITMAP_WORDS];
+
+  ola::thread::timeout_id NewEvent(
+      const TimeInterval &interval,
+      ola::BaseCallback0<void> *single_closure,
+      ola::BaseCallback0<bool> *repeating_closure);
+  void FreeEvent(Event *event);
+  ola::thread::timeout_id AllocateId(Event *event);
+  void ReleaseId(Event *event);
+  Event *LookupEvent(ola::thread::timeout_id id) const;
+  bool TriggerEvent(Event *event);
+
+  TimeInterval ExecuteHeapTimeouts(TimeStamp *now);
+  TimeInterval ExecuteWheelTimeouts(TimeStamp *now);
+
+  uint64_t TickFor(const TimeStamp &time) const;
+  void WheelInsert(Event *event);
+  void WheelUnlink(Event *event);
+  void AddToSlot(Event *event, unsigned int slot);
+  void Cascade(unsigned int level, uint64_t tick);
+  void RunTick(uint64_t tick, TimeStamp *now);
+  bool NextWheelTick(uint64_t *tick) const;
+  int FirstOccupied(unsigned int level, unsigned int start) const;
+
+  static unsigned int LevelShift(unsigned int level) {
+    return level ? LEVEL0_BITS + (level - 1) * LEVEL_BITS : 0;
+  }
+
+  static unsigned int LevelOffset(unsigned int level) {
+    return level ? LEVEL0_SLOTS + (level - 1) * LEVEL_SLOTS : 0;
+  }
+
+  static unsigned int LevelSlots(unsigned int level) {
+    return level ? LEVEL_SLOTS : LEVEL0_SLOTS;
+  }
+
   DISALLOW_COPY_AND_ASSIGN(TimeoutManager);
 };
 }  // namespace io
@@ -21,7 +21,10 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <map>
+#include <string>
+#include <vector>
 
+#include "common/io/LoopProfiler.h"
 #include "common/io/TimeoutManager.h"
 #include "ola/Callback.h"
 #include "ola/Clock.h"
@@ -35,8 +38,11 @@ using ola::NewSingleCallback;
 using ola::NewCallback;
 using ola::TimeInterval;
 using ola::TimeStamp;
+using ola::io::LoopProfiler;
 using ola::io::TimeoutManager;
 using ola::thread::timeout_id;
+using std::string;
+using std::vector;
 
 class TimeoutManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(TimeoutManagerTest);
@@ -44,13 +50,19 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRepeatingTimeouts);
   CPPUNIT_TEST(testAbortedRepeatingTimeouts);
   CPPUNIT_TEST(testPendingEventShutdown);
+  CPPUNIT_TEST(testStaleCancel);
+  CPPUNIT_TEST(testProfiler);
   CPPUNIT_TEST_SUITE_END();
 
  public:
+    virtual ~TimeoutManagerTest() {}
+
     void testSingleTimeouts();
     void testRepeatingTimeouts();
     void testAbortedRepeatingTimeouts();
     void testPendingEventShutdown();
+    void testStaleCancel();
+    void testProfiler();
 
     void HandleEvent(unsigned int event_id) {
       m_event_counters[event_id]++;
@@ -67,24 +79,58 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
       return m_event_counters[event_id] < 2;
     }
 
+    // Simulate a handler that takes some time to run.
+    void HandleSlowEvent(MockClock *clock, unsigned int usec) {
+      clock->AdvanceTime(0, usec);
+    }
+
     unsigned int GetEventCounter(unsigned int event_id) {
       return m_event_counters[event_id];
     }
 
- private:
+ protected:
     ExportMap m_map;
     std::map<unsigned int, unsigned int> m_event_counters;
+
+    virtual bool UseTimerWheel() const { return false; }
+};
+
+
+/*
+ * Run the same tests against the timer wheel, along with some tests for the
+ * cases that only apply to the wheel.
+ */
+class TimerWheelTest: public TimeoutManagerTest {
+  CPPUNIT_TEST_SUB_SUITE(TimerWheelTest, TimeoutManagerTest);
+  CPPUNIT_TEST(testCascade);
+  CPPUNIT_TEST(testLongTimeouts);
+  CPPUNIT_TEST(testCancelFromCallback);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testCascade();
+    void testLongTimeouts();
+    void testCancelFromCallback();
+
+    void CancelTimeout(TimeoutManager *timeout_manager, timeout_id *id) {
+      timeout_manager->CancelTimeout(*id);
+      m_event_counters[0]++;
+    }
+
+ protected:
+    bool UseTimerWheel() const { return true; }
 };
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TimeoutManagerTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
 
 /*
  * Check RegisterSingleTimeout works.
  */
 void TimeoutManagerTest::testSingleTimeouts() {
   MockClock clock;
-  TimeoutManager timeout_manager(&m_map, &clock);
+  TimeoutManager timeout_manager(&m_map, &clock, UseTimerWheel());
 
   OLA_ASSERT_FALSE(timeout_manager.EventsPending());
 
@@ -138,7 +184,7 @@ void TimeoutManagerTest::testSingleTimeouts() {
  */
 void TimeoutManagerTest::testRepeatingTimeouts() {
   MockClock clock;
-  TimeoutManager timeout_manager(&m_map, &clock);
+  TimeoutManager timeout_manager(&m_map, &clock, UseTimerWheel());
 
   OLA_ASSERT_FALSE(timeout_manager.EventsPending());
 
@@ -192,7 +238,7 @@ void TimeoutManagerTest::testRepeatingTimeouts() {
  */
 void TimeoutManagerTest::testAbortedRepeatingTimeouts() {
   MockClock clock;
-  TimeoutManager timeout_manager(&m_map, &clock);
+  TimeoutManager timeout_manager(&m_map, &clock, UseTimerWheel());
 
   OLA_ASSERT_FALSE(timeout_manager.EventsPending());
 
@@ -224,7 +270,7 @@ void TimeoutManagerTest::testAbortedRepeatingTimeouts() {
  */
 void TimeoutManagerTest::testPendingEventShutdown() {
   MockClock clock;
-  TimeoutManager timeout_manager(&m_map, &clock);
+  TimeoutManager timeout_manager(&m_map, &clock, UseTimerWheel());
 
   OLA_ASSERT_FALSE(timeout_manager.EventsPending());
 
@@ -241,3 +287,260 @@ void TimeoutManagerTest::testPendingEventShutdown() {
 
   OLA_ASSERT_TRUE(timeout_manager.EventsPending());
 }
+
+
+/*
+ * Check cancelling a timeout which has already run doesn't cancel a later
+ * timeout, even if it reuses the same event.
+ */
+void TimeoutManagerTest::testStaleCancel() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock, UseTimerWheel());
+
+  TimeInterval timeout_interval(0, 10000);
+  timeout_id id1 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleEvent, 1u));
+
+  TimeStamp now;
+  clock.AdvanceTime(0, 10000);
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, GetEventCounter(1));
+
+  timeout_id id2 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleEvent, 2u));
+  OLA_ASSERT_NE(id1, id2);
+  timeout_manager.CancelTimeout(id1);
+  timeout_id id3 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleEvent, 3u));
+  timeout_manager.CancelTimeout(id3);
+
+  clock.AdvanceTime(0, 10000);
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, GetEventCounter(2));
+  OLA_ASSERT_EQ(0u, GetEventCounter(3));
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+  OLA_ASSERT_EQ(0, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  // Both ids are stale now.
+  timeout_manager.CancelTimeout(id2);
+  timeout_manager.CancelTimeout(id3);
+  timeout_id id4 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleEvent, 4u));
+  timeout_manager.CancelTimeout(id2);
+  timeout_manager.CancelTimeout(id3);
+  clock.AdvanceTime(0, 10000);
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, GetEventCounter(4));
+  OLA_ASSERT_NE(ola::thread::INVALID_TIMEOUT, id4);
+}
+
+
+/*
+ * Check the time taken by timeouts is recorded.
+ */
+void TimeoutManagerTest::testProfiler() {
+  MockClock clock;
+  ExportMap export_map;
+  LoopProfiler profiler(&export_map, &clock, TimeInterval(0, 5000));
+  TimeoutManager timeout_manager(&m_map, &clock, UseTimerWheel());
+  timeout_manager.SetProfiler(&profiler);
+
+  TimeInterval timeout_interval(1, 0);
+  timeout_id slow_id = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleSlowEvent, &clock,
+                        10000u));
+  profiler.SetName(slow_id, "slow");
+  timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleSlowEvent, &clock,
+                        1000u));
+
+  // The wheel may run timeouts up to a millisecond late.
+  clock.AdvanceTime(1, 2000);
+  TimeStamp now;
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+
+  vector<LoopProfiler::HandlerStats> stats;
+  profiler.SlowestHandlers(LoopProfiler::SLOWEST_HANDLERS, &stats);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), stats.size());
+  OLA_ASSERT_EQ(string("slow"), stats[0].name);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats[0].count);
+  // MockClock follows the real clock as well, so allow for that.
+  OLA_ASSERT_TRUE(stats[0].max_us >= 10000);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats[0].over_budget);
+  OLA_ASSERT_EQ(string("timeout"), stats[1].name);
+  OLA_ASSERT_TRUE(stats[1].max_us >= 1000);
+  OLA_ASSERT_TRUE(stats[1].max_us < 5000);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats[1].over_budget);
+
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2),
+                export_map.GetHistogramVar("ss-handler-time-us")->Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                export_map.GetShardedCounterVar(
+                    "ss-handlers-over-budget")->Get());
+
+  // The name is dropped once the timeout has run, so a new timeout that
+  // reuses the event isn't recorded as slow.
+  timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleSlowEvent, &clock,
+                        10u));
+  clock.AdvanceTime(1, 2000);
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+
+  profiler.SlowestHandlers(LoopProfiler::SLOWEST_HANDLERS, &stats);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats[0].count);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats[1].count);
+
+  profiler.LoopDone(TimeInterval(0, 12000));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                export_map.GetHistogramVar("ss-loop-time-us")->Count());
+  ola::StringMap *slowest = export_map.GetStringMapVar(
+      "ss-slowest-handlers");
+  const string slow_stats = (*slowest)["slow"];
+  OLA_ASSERT_EQ(static_cast<size_t>(0), slow_stats.find("count=1 mean_us="));
+  OLA_ASSERT_NE(string::npos, slow_stats.find(" over_budget=1"));
+}
+
+
+/*
+ * Check timeouts in the higher levels of the wheel fire at the right time,
+ * and in order.
+ */
+void TimerWheelTest::testCascade() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock, true);
+
+  // These land in different levels of the wheel.
+  const unsigned int delays_ms[] = {5, 300, 20000, 1500000};
+  const unsigned int count = sizeof(delays_ms) / sizeof(delays_ms[0]);
+  for (unsigned int i = 0; i < count; i++) {
+    timeout_manager.RegisterSingleTimeout(
+        TimeInterval(static_cast<int64_t>(delays_ms[i]) * 1000),
+        NewSingleCallback(static_cast<TimeoutManagerTest*>(this),
+                          &TimeoutManagerTest::HandleEvent, i));
+  }
+
+  TimeStamp now;
+  unsigned int elapsed_ms = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    // Step to just before the timeout, following the returned interval.
+    while (true) {
+      clock.CurrentMonotonicTime(&now);
+      TimeInterval next = timeout_manager.ExecuteTimeouts(&now);
+      OLA_ASSERT_FALSE(next.IsZero());
+      unsigned int next_ms = static_cast<unsigned int>(
+          (next.AsInt() + 999) / 1000);
+      if (elapsed_ms + next_ms >= delays_ms[i]) {
+        break;
+      }
+      clock.AdvanceTime(TimeInterval(static_cast<int64_t>(next_ms) * 1000));
+      elapsed_ms += next_ms;
+    }
+    OLA_ASSERT_EQ(0u, GetEventCounter(i));
+
+    // The MockClock follows the real clock, so leave some margin.
+    clock.AdvanceTime(TimeInterval(
+        static_cast<int64_t>(delays_ms[i] - elapsed_ms) * 1000 - 500));
+    clock.CurrentMonotonicTime(&now);
+    timeout_manager.ExecuteTimeouts(&now);
+    OLA_ASSERT_EQ(0u, GetEventCounter(i));
+
+    clock.AdvanceTime(0, 500);
+    clock.CurrentMonotonicTime(&now);
+    timeout_manager.ExecuteTimeouts(&now);
+    OLA_ASSERT_EQ(1u, GetEventCounter(i));
+    if (i + 1 < count) {
+      OLA_ASSERT_EQ(0u, GetEventCounter(i + 1));
+    }
+    elapsed_ms = delays_ms[i];
+  }
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+}
+
+
+/*
+ * Check timeouts beyond the end of the wheel.
+ */
+void TimerWheelTest::testLongTimeouts() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock, true);
+
+  // Two days
+  timeout_manager.RegisterSingleTimeout(
+      TimeInterval(2 * 24 * 60 * 60, 0),
+      NewSingleCallback(static_cast<TimeoutManagerTest*>(this),
+                        &TimeoutManagerTest::HandleEvent, 1u));
+
+  TimeStamp now;
+  for (unsigned int hour = 0; hour < 47; hour++) {
+    clock.AdvanceTime(60 * 60, 0);
+    clock.CurrentMonotonicTime(&now);
+    timeout_manager.ExecuteTimeouts(&now);
+  }
+  OLA_ASSERT_EQ(0u, GetEventCounter(1));
+  OLA_ASSERT_TRUE(timeout_manager.EventsPending());
+
+  clock.AdvanceTime(59 * 60 + 59, 0);
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(0u, GetEventCounter(1));
+
+  clock.AdvanceTime(1, 0);
+  clock.CurrentMonotonicTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, GetEventCounter(1));
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+}
+
+
+/*
+ * Check a callback can cancel another timeout that expires at the same time.
+ */
+void TimerWheelTest::testCancelFromCallback() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock, true);
+
+  TimeInterval timeout_interval(0, 10000);
+  timeout_id id1 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(static_cast<TimeoutManagerTest*>(this),
+                        &TimeoutManagerTest::HandleEvent, 1u));
+  timeout_id id2 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(static_cast<TimeoutManagerTest*>(this),
+                        &TimeoutManagerTest::HandleEvent, 2u));
+
+  // The most recently registered event runs first, so this cancels both.
+  timeout_id cancel_ids[] = {id1, id2};
+  timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimerWheelTest::CancelTimeout,
+                        &timeout_manager, &cancel_ids[0]));
+  timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimerWheelTest::CancelTimeout,
+                        &timeout_manager, &cancel_ids[1]));
+  OLA_ASSERT_EQ(4, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  TimeStamp now;
+  clock.AdvanceTime(0, 10000);
+  clock.CurrentMonotonicTime(&now);
+  TimeInterval next = timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_TRUE(next.IsZero());
+  OLA_ASSERT_EQ(2u, GetEventCounter(0));
+  OLA_ASSERT_EQ(0u, GetEventCounter(1));
+  OLA_ASSERT_EQ(0u, GetEventCounter(2));
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+  OLA_ASSERT_EQ(0, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+}
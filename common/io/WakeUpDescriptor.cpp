@@ -0,0 +1,147 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WakeUpDescriptor.cpp
+ * Wake a SelectServer from another thread.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif  // HAVE_SYS_EVENTFD_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/WakeUpDescriptor.h"
+#include "ola/Logging.h"
+#include "ola/io/Descriptor.h"
+
+namespace ola {
+namespace io {
+
+#ifdef HAVE_SYS_EVENTFD_H
+/*
+ * An eventfd holds a counter, so however many times it's signalled a single
+ * read() clears it.
+ */
+class EventFDWakeUpDescriptor: public WakeUpDescriptor,
+                               public ReadFileDescriptor {
+ public:
+  EventFDWakeUpDescriptor() : m_fd(INVALID_DESCRIPTOR) {}
+
+  ~EventFDWakeUpDescriptor() {
+    if (m_fd != INVALID_DESCRIPTOR) {
+      close(m_fd);
+    }
+  }
+
+  bool Init(ola::Callback0<void> *on_wake_up) {
+    m_on_wake_up.reset(on_wake_up);
+    m_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_fd < 0) {
+      OLA_WARN << "eventfd() failed: " << strerror(errno);
+      m_fd = INVALID_DESCRIPTOR;
+      return false;
+    }
+    return true;
+  }
+
+  bool AddTo(PollerInterface *poller) {
+    return poller->AddReadDescriptor(this);
+  }
+
+  DescriptorHandle ReadDescriptor() const { return m_fd; }
+
+  void PerformRead() {
+    uint64_t counter;
+    if (read(m_fd, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+      OLA_WARN << "Failed to read from eventfd: " << strerror(errno);
+    }
+    WokenUp();
+  }
+
+ protected:
+  void Signal() {
+    const uint64_t increment = 1;
+    if (write(m_fd, &increment, sizeof(increment)) < 0) {
+      OLA_WARN << "Failed to write to eventfd: " << strerror(errno);
+    }
+  }
+
+ private:
+  int m_fd;
+};
+#endif  // HAVE_SYS_EVENTFD_H
+
+
+/*
+ * The portable version, which writes a byte to a pipe.
+ */
+class LoopbackWakeUpDescriptor: public WakeUpDescriptor {
+ public:
+  LoopbackWakeUpDescriptor() {}
+
+  bool Init(ola::Callback0<void> *on_wake_up) {
+    m_on_wake_up.reset(on_wake_up);
+    if (!m_descriptor.Init()) {
+      return false;
+    }
+    m_descriptor.SetOnData(
+        ola::NewCallback(this, &LoopbackWakeUpDescriptor::DataReady));
+    return true;
+  }
+
+  bool AddTo(PollerInterface *poller) {
+    return poller->AddReadDescriptor(&m_descriptor, false);
+  }
+
+ protected:
+  void Signal() {
+    uint8_t wake_up = 'a';
+    m_descriptor.Send(&wake_up, sizeof(wake_up));
+  }
+
+ private:
+  LoopbackDescriptor m_descriptor;
+
+  void DataReady() {
+    while (m_descriptor.DataRemaining()) {
+      // try to get everything in one read
+      uint8_t message[100];
+      unsigned int size;
+      m_descriptor.Receive(message, sizeof(message), size);
+    }
+    WokenUp();
+  }
+};
+
+
+WakeUpDescriptor *WakeUpDescriptor::New() {
+#ifdef HAVE_SYS_EVENTFD_H
+  return new EventFDWakeUpDescriptor();
+#else
+  return new LoopbackWakeUpDescriptor();
+#endif  // HAVE_SYS_EVENTFD_H
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,110 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WakeUpDescriptor.h
+ * Wake a SelectServer from another thread.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_IO_WAKEUPDESCRIPTOR_H_
+#define COMMON_IO_WAKEUPDESCRIPTOR_H_
+
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+namespace io {
+
+class PollerInterface;
+
+/**
+ * @brief Wakes up a SelectServer from any thread.
+ *
+ * Wake ups are coalesced: once WakeUp() has signalled the descriptor, further
+ * calls are no-ops until the SelectServer thread has handled the wake up. A
+ * burst of WakeUp() calls results in a single write and a single read.
+ *
+ * The pending flag is cleared before the callback runs, so any WakeUp() that
+ * didn't signal the descriptor is guaranteed to have happened before the
+ * callback, and anything it published is visible to the callback.
+ *
+ * Where eventfd() is available it's used, otherwise we fall back to a
+ * LoopbackDescriptor.
+ */
+class WakeUpDescriptor {
+ public:
+  virtual ~WakeUpDescriptor() {}
+
+  /**
+   * @brief Setup the descriptor.
+   * @param on_wake_up the callback to run in the SelectServer thread, after
+   *   a wake up. Ownership is transferred.
+   * @returns true if the descriptor was setup, false otherwise.
+   */
+  virtual bool Init(ola::Callback0<void> *on_wake_up) = 0;
+
+  /**
+   * @brief Add the descriptor to a poller.
+   *
+   * The descriptor is added to the poller directly, so it doesn't show up in
+   * the SelectServer's descriptor counts.
+   */
+  virtual bool AddTo(PollerInterface *poller) = 0;
+
+  /**
+   * @brief Wake up the SelectServer, this can be called from any thread.
+   */
+  void WakeUp() {
+    if (__atomic_exchange_n(&m_pending, 1, __ATOMIC_SEQ_CST) == 0) {
+      Signal();
+    }
+  }
+
+  /**
+   * @brief Create a new WakeUpDescriptor for this platform.
+   */
+  static WakeUpDescriptor *New();
+
+ protected:
+  WakeUpDescriptor() : m_pending(0) {}
+
+  /**
+   * @brief Clear the pending flag and run the callback.
+   *
+   * Called by the implementations once the descriptor has been drained.
+   */
+  void WokenUp() {
+    // This needs to be a read-modify-write so that it synchronizes with the
+    // exchange in any WakeUp() call that saw the flag set.
+    __atomic_exchange_n(&m_pending, 0, __ATOMIC_SEQ_CST);
+    if (m_on_wake_up.get()) {
+      m_on_wake_up->Run();
+    }
+  }
+
+  virtual void Signal() = 0;
+
+  std::auto_ptr<ola::Callback0<void> > m_on_wake_up;
+
+ private:
+  int m_pending;
+
+  DISALLOW_COPY_AND_ASSIGN(WakeUpDescriptor);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_WAKEUPDESCRIPTOR_H_
@@ -287,17 +287,20 @@ void CancelIOs(vector<PollData*>* data) {
 bool WindowsPoller::Poll(TimeoutManager *timeout_manager,
                          const TimeInterval &poll_interval) {
   TimeInterval sleep_interval = poll_interval;
-  TimeStamp now;
-  m_clock->CurrentMonotonicTime(&now);
+  // Update the wake up time before running the timeouts, so they see the
+  // current time.
+  const TimeStamp last_wake_up = m_wake_up_time;
+  m_clock->CurrentMonotonicTime(&m_wake_up_time);
 
-  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(
+      &m_wake_up_time);
   if (!next_event_in.IsZero()) {
     sleep_interval = std::min(next_event_in, sleep_interval);
   }
 
   // take care of stats accounting
-  if (m_wake_up_time.IsSet()) {
-    TimeInterval loop_time = now - m_wake_up_time;
+  if (last_wake_up.IsSet()) {
+    TimeInterval loop_time = m_wake_up_time - last_wake_up;
     OLA_DEBUG << "ss process time was " << loop_time.ToString();
     if (m_loop_time)
       (*m_loop_time) += loop_time.AsInt();
@@ -0,0 +1,106 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * timeout_manager_benchmark.cpp
+ * Compare the heap and timer wheel implementations of the TimeoutManager.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::MockClock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::TimeoutManager;
+using ola::thread::timeout_id;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(timers, t, 10000, "The number of outstanding timers");
+DEFINE_s_uint32(iterations, i, 1000000,
+                "The number of register / cancel operations per test");
+
+static unsigned int fired = 0;
+
+void Nop() {
+  fired++;
+}
+
+/**
+ * Simulate RDM style request timeouts. There are always FLAGS_timers timers
+ * outstanding, each operation cancels the oldest one and registers a new one,
+ * and the clock moves forward 1ms every 100 operations.
+ * @returns the time per operation in ns.
+ */
+double RunTest(bool use_timer_wheel) {
+  MockClock mock_clock;
+  TimeoutManager timeout_manager(NULL, &mock_clock, use_timer_wheel);
+  const unsigned int timers = FLAGS_timers;
+  const unsigned int iterations = FLAGS_iterations;
+  const TimeInterval timeout(2, 0);
+
+  vector<timeout_id> ids(timers);
+  for (unsigned int i = 0; i < timers; i++) {
+    ids[i] = timeout_manager.RegisterSingleTimeout(
+        timeout, ola::NewSingleCallback(Nop));
+  }
+
+  Clock clock;
+  TimeStamp start, end, now;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < iterations; i++) {
+    unsigned int index = i % timers;
+    timeout_manager.CancelTimeout(ids[index]);
+    ids[index] = timeout_manager.RegisterSingleTimeout(
+        timeout, ola::NewSingleCallback(Nop));
+    if (i % 100 == 0) {
+      mock_clock.AdvanceTime(0, 1000);
+      mock_clock.CurrentMonotonicTime(&now);
+      timeout_manager.ExecuteTimeouts(&now);
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+
+  TimeInterval duration = end - start;
+  return duration.AsInt() * 1000.0 / iterations;
+}
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark the TimeoutManager implementations.");
+
+  cout << FLAGS_timers << " outstanding timers" << endl;
+  cout << std::setw(8) << "impl" << std::setw(12) << "op (ns)" << endl;
+  cout << std::setw(8) << "heap" << std::fixed << std::setprecision(1)
+       << std::setw(12) << RunTest(false) << endl;
+  cout << std::setw(8) << "wheel" << std::fixed << std::setprecision(1)
+       << std::setw(12) << RunTest(true) << endl;
+  if (fired) {
+    cout << fired << " timers fired" << endl;
+  }
+  return 0;
+}
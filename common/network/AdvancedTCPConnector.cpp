@@ -20,32 +20,47 @@
 #include <ola/Callback.h>
 #include <ola/Logging.h>
 #include <ola/io/SelectServerInterface.h>
+#include <ola/math/Random.h>
 #include <ola/network/AdvancedTCPConnector.h>
 #include <ola/network/TCPConnector.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
 
 
 namespace ola {
 namespace network {
 
 using std::pair;
+using std::vector;
 
 AdvancedTCPConnector::AdvancedTCPConnector(
     ola::io::SelectServerInterface *ss,
     TCPSocketFactoryInterface *socket_factory,
-    const ola::TimeInterval &connection_timeout)
+    const ola::TimeInterval &connection_timeout,
+    const Options &options)
     : m_socket_factory(socket_factory),
       m_ss(ss),
       m_connector(ss),
-      m_connection_timeout(connection_timeout) {
+      m_connection_timeout(connection_timeout),
+      m_options(options),
+      m_retry_timeout(ola::thread::INVALID_TIMEOUT),
+      m_starting_connects(false) {
 }
 
 AdvancedTCPConnector::~AdvancedTCPConnector() {
+  // Nothing should be started while we cancel the pending connects.
+  m_waiting.clear();
   ConnectionMap::iterator iter = m_connections.begin();
   for (; iter != m_connections.end(); ++iter) {
-    AbortConnection(iter->second);
+    iter->second->waiting = false;
+    AbortConnection(iter->first, iter->second);
     delete iter->second;
   }
   m_connections.clear();
+  m_retry_queue.clear();
+  if (m_retry_timeout != ola::thread::INVALID_TIMEOUT)
+    m_ss->RemoveTimeout(m_retry_timeout);
 }
 
 
@@ -61,10 +76,11 @@ void AdvancedTCPConnector::AddEndpoint(const IPV4SocketAddress &endpoint,
   ConnectionInfo *state = new ConnectionInfo;
   state->state = paused ? PAUSED : DISCONNECTED;
   state->failed_attempts = 0;
-  state->retry_timeout = ola::thread::INVALID_TIMEOUT;
   state->connection_id = 0;
   state->policy = backoff_policy;
   state->reconnect = true;
+  state->hot = false;
+  state->waiting = false;
 
   m_connections[key] = state;
 
@@ -78,7 +94,7 @@ void AdvancedTCPConnector::RemoveEndpoint(const IPV4SocketAddress &endpoint) {
   if (iter == m_connections.end())
     return;
 
-  AbortConnection(iter->second);
+  AbortConnection(iter->first, iter->second);
   delete iter->second;
   m_connections.erase(iter);
 }
@@ -104,22 +120,21 @@ void AdvancedTCPConnector::Disconnect(const IPV4SocketAddress &endpoint,
   if (iter == m_connections.end())
     return;
 
-  if (iter->second->state != CONNECTED)
+  ConnectionInfo *info = iter->second;
+  if (info->state != CONNECTED)
     return;
 
-  iter->second->failed_attempts = 0;
+  info->failed_attempts = 0;
 
   if (pause) {
-    iter->second->state = PAUSED;
+    info->state = PAUSED;
+  } else if (info->hot) {
+    info->state = DISCONNECTED;
+    AttemptConnection(iter->first, info);
   } else {
     // schedule a retry as if this endpoint failed once
-    iter->second->state = DISCONNECTED;
-    iter->second->retry_timeout = m_ss->RegisterSingleTimeout(
-        iter->second->policy->BackOffTime(1),
-        ola::NewSingleCallback(
-          this,
-          &AdvancedTCPConnector::RetryTimeout,
-          iter->first));
+    info->state = DISCONNECTED;
+    ScheduleRetry(iter->first, info, BackOffTime(info, 1));
   }
 }
 
@@ -135,32 +150,110 @@ void AdvancedTCPConnector::Resume(const IPV4SocketAddress &endpoint) {
   }
 }
 
+void AdvancedTCPConnector::SetHot(const IPV4SocketAddress &endpoint,
+                                  bool hot) {
+  IPPortPair key(endpoint.Host(), endpoint.Port());
+  ConnectionMap::iterator iter = m_connections.find(key);
+  if (iter == m_connections.end())
+    return;
+
+  ConnectionInfo *info = iter->second;
+  if (info->hot == hot)
+    return;
+  info->hot = hot;
+
+  if (hot && info->waiting) {
+    // move it to the front of the queue
+    m_waiting.erase(std::remove(m_waiting.begin(), m_waiting.end(), key),
+                    m_waiting.end());
+    m_waiting.push_front(key);
+  }
+}
+
+void AdvancedTCPConnector::GetStats(ConnectionStats *stats) const {
+  *stats = m_stats;
+  stats->waiting = m_waiting.size();
+}
+
 /**
  * Schedule the re-try attempt for this connection
  */
 void AdvancedTCPConnector::ScheduleRetry(const IPPortPair &key,
-                                         ConnectionInfo *info) {
-  info->retry_timeout = m_ss->RegisterSingleTimeout(
-      info->policy->BackOffTime(info->failed_attempts),
-      ola::NewSingleCallback(
-        this,
-        &AdvancedTCPConnector::RetryTimeout,
-        key));
+                                         ConnectionInfo *info,
+                                         const TimeInterval &delay) {
+  info->retry_time = *m_ss->WakeUpTime() + delay;
+  m_retry_queue.insert(std::make_pair(info->retry_time, key));
+  UpdateRetryTimeout();
 }
 
+/**
+ * Remove this connection from the retry queue.
+ */
+void AdvancedTCPConnector::CancelRetry(const IPPortPair &key,
+                                       ConnectionInfo *info) {
+  if (!info->retry_time.IsSet())
+    return;
+
+  m_retry_queue.erase(std::make_pair(info->retry_time, key));
+  info->retry_time = TimeStamp();
+  UpdateRetryTimeout();
+}
 
 /**
- * Called when it's time to retry
+ * Make sure the retry timer fires when the first retry is due.
  */
-void AdvancedTCPConnector::RetryTimeout(IPPortPair key) {
-  ConnectionMap::iterator iter = m_connections.find(key);
-  if (iter == m_connections.end()) {
-    OLA_FATAL << "Re-connect timer expired but unable to find state entry for "
-      << key.first << ":" << key.second;
+void AdvancedTCPConnector::UpdateRetryTimeout() {
+  if (m_retry_timeout != ola::thread::INVALID_TIMEOUT) {
+    if (!m_retry_queue.empty() &&
+        m_retry_queue.begin()->first == m_retry_timeout_time) {
+      return;
+    }
+    m_ss->RemoveTimeout(m_retry_timeout);
+    m_retry_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  if (m_retry_queue.empty())
     return;
+
+  m_retry_timeout_time = m_retry_queue.begin()->first;
+  const TimeStamp *now = m_ss->WakeUpTime();
+  TimeInterval delay;
+  if (m_retry_timeout_time > *now)
+    delay = m_retry_timeout_time - *now;
+  m_retry_timeout = m_ss->RegisterSingleTimeout(
+      delay,
+      ola::NewSingleCallback(this, &AdvancedTCPConnector::RetryTimeout));
+}
+
+
+/**
+ * Called when it's time to retry one or more connections.
+ */
+void AdvancedTCPConnector::RetryTimeout() {
+  m_retry_timeout = ola::thread::INVALID_TIMEOUT;
+
+  // Collect the retries first, since a connect can fail straight away and
+  // schedule another retry.
+  const TimeStamp now = *m_ss->WakeUpTime();
+  vector<IPPortPair> due;
+  RetryQueue::iterator iter = m_retry_queue.begin();
+  while (iter != m_retry_queue.end() && iter->first <= now) {
+    due.push_back(iter->second);
+    m_retry_queue.erase(iter++);
   }
-  iter->second->retry_timeout = ola::thread::INVALID_TIMEOUT;
-  AttemptConnection(key, iter->second);
+
+  vector<IPPortPair>::const_iterator due_iter = due.begin();
+  for (; due_iter != due.end(); ++due_iter) {
+    ConnectionMap::iterator conn_iter = m_connections.find(*due_iter);
+    if (conn_iter == m_connections.end()) {
+      OLA_FATAL << "Re-connect timer expired but unable to find state entry "
+        << "for " << due_iter->first << ":" << due_iter->second;
+      continue;
+    }
+    conn_iter->second->retry_time = TimeStamp();
+    AttemptConnection(conn_iter->first, conn_iter->second);
+  }
+  UpdateRetryTimeout();
 }
 
 
@@ -173,10 +266,12 @@ void AdvancedTCPConnector::ConnectionResult(IPPortPair key, int fd, int) {
       key.second;
   }
 
+  m_stats.pending--;
   ConnectionMap::iterator iter = m_connections.find(key);
   if (iter == m_connections.end()) {
     OLA_FATAL << "Unable to find state for " << key.first << ":" <<
       key.second << ", leaking sockets";
+    StartWaitingConnections();
     return;
   }
   ConnectionInfo *info = iter->second;
@@ -184,23 +279,52 @@ void AdvancedTCPConnector::ConnectionResult(IPPortPair key, int fd, int) {
   info->connection_id = 0;
   if (fd != -1) {
     // ok
+    m_stats.successes++;
     info->state = CONNECTED;
     m_socket_factory->NewTCPSocket(fd);
   } else {
     // error
     info->failed_attempts++;
     if (info->reconnect) {
-      ScheduleRetry(key, info);
+      m_stats.failures++;
+      ScheduleRetry(key, info, BackOffTime(info, info->failed_attempts));
     }
   }
+  StartWaitingConnections();
 }
 
 
 /**
- * Initiate a connection to this ip:port pair
+ * Initiate a connection to this ip:port pair, or queue it if there are
+ * already too many connects in progress.
  */
 void AdvancedTCPConnector::AttemptConnection(const IPPortPair &key,
                                              ConnectionInfo *state) {
+  if (state->waiting)
+    return;
+
+  if (m_waiting.empty() && HaveConnectSlot()) {
+    StartConnection(key, state);
+    return;
+  }
+
+  state->waiting = true;
+  if (state->hot) {
+    m_waiting.push_front(key);
+  } else {
+    m_waiting.push_back(key);
+  }
+}
+
+
+/**
+ * Start the TCP connect for this ip:port pair.
+ */
+void AdvancedTCPConnector::StartConnection(const IPPortPair &key,
+                                           ConnectionInfo *state) {
+  m_stats.attempts++;
+  m_stats.pending++;
+  state->reconnect = true;
   state->connection_id = m_connector.Connect(
       IPV4SocketAddress(key.first, key.second),
       m_connection_timeout,
@@ -210,18 +334,70 @@ void AdvancedTCPConnector::AttemptConnection(const IPPortPair &key,
 }
 
 
+/**
+ * Start the connects that were waiting for a free slot.
+ */
+void AdvancedTCPConnector::StartWaitingConnections() {
+  // A connect may complete straight away, which calls back into here.
+  if (m_starting_connects)
+    return;
+  m_starting_connects = true;
+
+  while (!m_waiting.empty() && HaveConnectSlot()) {
+    IPPortPair key = m_waiting.front();
+    m_waiting.pop_front();
+    ConnectionMap::iterator iter = m_connections.find(key);
+    if (iter == m_connections.end())
+      continue;
+    iter->second->waiting = false;
+    StartConnection(key, iter->second);
+  }
+  m_starting_connects = false;
+}
+
+
+bool AdvancedTCPConnector::HaveConnectSlot() const {
+  return (m_options.max_pending_connects == 0 ||
+          m_stats.pending < m_options.max_pending_connects);
+}
+
+
 /**
  * Abort and clean up a pending connection
+ * @param key the ip:port pair of the connection.
  * @param state the ConnectionInfo to cleanup.
  */
-void AdvancedTCPConnector::AbortConnection(ConnectionInfo *state) {
+void AdvancedTCPConnector::AbortConnection(const IPPortPair &key,
+                                           ConnectionInfo *state) {
+  if (state->waiting) {
+    m_waiting.erase(std::remove(m_waiting.begin(), m_waiting.end(), key),
+                    m_waiting.end());
+    state->waiting = false;
+  }
+  CancelRetry(key, state);
   if (state->connection_id) {
     state->reconnect = false;
     if (!m_connector.Cancel(state->connection_id))
       OLA_WARN << "Failed to cancel connection " << state->connection_id;
   }
-  if (state->retry_timeout != ola::thread::INVALID_TIMEOUT)
-    m_ss->RemoveTimeout(state->retry_timeout);
+}
+
+
+/**
+ * Return the time to wait before the next attempt, with jitter applied.
+ */
+TimeInterval AdvancedTCPConnector::BackOffTime(
+    const ConnectionInfo *info,
+    unsigned int failed_attempts) const {
+  TimeInterval delay = info->policy->BackOffTime(failed_attempts);
+  if (m_options.jitter_percent == 0)
+    return delay;
+
+  unsigned int jitter = std::min(m_options.jitter_percent, 100u);
+  int64_t usec = delay.AsInt();
+  int64_t reduction = usec * ola::math::Random(0, static_cast<int>(jitter)) /
+                      100;
+  return TimeInterval(usec - reduction);
 }
 }  // namespace network
 }  // namespace ola
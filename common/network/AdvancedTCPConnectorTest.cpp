@@ -61,6 +61,8 @@ class AdvancedTCPConnectorTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testPause);
   CPPUNIT_TEST(testBackoff);
   CPPUNIT_TEST(testEarlyDestruction);
+  CPPUNIT_TEST(testConnectLimit);
+  CPPUNIT_TEST(testHotEndpoint);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -76,6 +78,8 @@ class AdvancedTCPConnectorTest: public CppUnit::TestFixture {
   void testPause();
   void testBackoff();
   void testEarlyDestruction();
+  void testConnectLimit();
+  void testHotEndpoint();
 
   // timing out indicates something went wrong
   void Timeout() {
@@ -332,6 +336,134 @@ void AdvancedTCPConnectorTest::testEarlyDestruction() {
   }
 }
 
+
+/*
+ * Test that the number of connects in progress is limited.
+ */
+void AdvancedTCPConnectorTest::testConnectLimit() {
+  m_ss->RemoveTimeout(m_timeout_id);
+  m_timeout_id = ola::thread::INVALID_TIMEOUT;
+
+  AdvancedTCPConnector::Options options;
+  options.max_pending_connects = 1;
+  options.jitter_percent = 50;
+  AdvancedTCPConnector connector(
+      m_ss,
+      m_tcp_socket_factory.get(),
+      TimeInterval(0, CONNECT_TIMEOUT_IN_MS * 1000),
+      options);
+
+  LinearBackoffPolicy policy(TimeInterval(5, 0), TimeInterval(30, 0));
+  IPV4SocketAddress targets[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    uint16_t port = ReservePort();
+    OLA_ASSERT_NE(0, port);
+    targets[i] = IPV4SocketAddress(m_localhost, port);
+    connector.AddEndpoint(targets[i], &policy);
+  }
+  OLA_ASSERT_EQ(3u, connector.EndpointCount());
+
+  // The connects may fail straight away depending on the platform, so we
+  // only check that no more than one is ever in progress.
+  AdvancedTCPConnector::ConnectionStats stats;
+  for (unsigned int i = 0; i < 4; i++) {
+    connector.GetStats(&stats);
+    OLA_ASSERT_LTE(stats.pending, 1u);
+    OLA_ASSERT_EQ(stats.attempts, stats.pending + stats.failures);
+    m_clock.AdvanceTime(0, 490000);
+    m_ss->RunOnce(TimeInterval(0, 200000));
+  }
+
+  // every endpoint has now failed once, and no retry is due yet.
+  connector.GetStats(&stats);
+  OLA_ASSERT_EQ(0u, stats.pending);
+  OLA_ASSERT_EQ(0u, stats.waiting);
+  OLA_ASSERT_EQ(3u, stats.attempts);
+  OLA_ASSERT_EQ(3u, stats.failures);
+  OLA_ASSERT_EQ(0u, stats.successes);
+  for (unsigned int i = 0; i < 3; i++) {
+    ConfirmState(OLA_SOURCELINE(), connector, targets[i],
+                 AdvancedTCPConnector::DISCONNECTED, 1);
+  }
+
+  // with jitter, the retries happen between 2.5 and 5s after the failures.
+  for (unsigned int i = 0; i < 12; i++) {
+    m_clock.AdvanceTime(0, 490000);
+    m_ss->RunOnce(TimeInterval(0, 200000));
+    connector.GetStats(&stats);
+    OLA_ASSERT_LTE(stats.pending, 1u);
+  }
+  for (unsigned int i = 0; i < 3; i++) {
+    ConfirmState(OLA_SOURCELINE(), connector, targets[i],
+                 AdvancedTCPConnector::DISCONNECTED, 2);
+  }
+  connector.GetStats(&stats);
+  OLA_ASSERT_EQ(6u, stats.attempts);
+  OLA_ASSERT_EQ(6u, stats.failures);
+
+  for (unsigned int i = 0; i < 3; i++) {
+    connector.RemoveEndpoint(targets[i]);
+  }
+  OLA_ASSERT_EQ(0u, connector.EndpointCount());
+}
+
+
+/*
+ * Test that a hot endpoint is reconnected straight away.
+ */
+void AdvancedTCPConnectorTest::testHotEndpoint() {
+  ola::network::TCPSocketFactory socket_factory(
+      ola::NewCallback(this, &AdvancedTCPConnectorTest::AcceptedConnection));
+  TCPAcceptingSocket listening_socket(&socket_factory);
+  SetupListeningSocket(&listening_socket);
+
+  AdvancedTCPConnector connector(
+      m_ss,
+      m_tcp_socket_factory.get(),
+      TimeInterval(0, CONNECT_TIMEOUT_IN_MS * 1000));
+
+  LinearBackoffPolicy policy(TimeInterval(5, 0), TimeInterval(30, 0));
+  connector.AddEndpoint(m_server_address, &policy);
+  connector.SetHot(m_server_address, true);
+
+  AdvancedTCPConnector::ConnectionState state;
+  unsigned int failed_attempts;
+  connector.GetEndpointState(m_server_address, &state, &failed_attempts);
+  if (state == AdvancedTCPConnector::DISCONNECTED) {
+    m_ss->Run();
+  }
+  ConfirmState(OLA_SOURCELINE(), connector, m_server_address,
+               AdvancedTCPConnector::CONNECTED, 0);
+  OLA_ASSERT_NOT_NULL(m_connected_socket);
+  TCPSocket *first_socket = m_connected_socket;
+  m_connected_socket = NULL;
+  first_socket->Close();
+  delete first_socket;
+
+  // a new connect should start without waiting for the backoff time.
+  connector.Disconnect(m_server_address);
+  AdvancedTCPConnector::ConnectionStats stats;
+  connector.GetStats(&stats);
+  OLA_ASSERT_EQ(2u, stats.attempts);
+  OLA_ASSERT_EQ(0u, stats.failures);
+
+  connector.GetEndpointState(m_server_address, &state, &failed_attempts);
+  if (state == AdvancedTCPConnector::DISCONNECTED) {
+    m_ss->Run();
+  }
+  ConfirmState(OLA_SOURCELINE(), connector, m_server_address,
+               AdvancedTCPConnector::CONNECTED, 0);
+  OLA_ASSERT_NOT_NULL(m_connected_socket);
+  m_connected_socket->Close();
+  delete m_connected_socket;
+  connector.GetStats(&stats);
+  OLA_ASSERT_EQ(2u, stats.successes);
+
+  connector.Disconnect(m_server_address, true);
+  connector.RemoveEndpoint(m_server_address);
+  m_ss->RemoveReadDescriptor(&listening_socket);
+}
+
 /**
  * Confirm the state & failed attempts matches what we expected
  */
@@ -17,6 +17,7 @@
  * Copyright (C) 2012 Simon Newton
  */
 
+#include <vector>
 #include "ola/Logging.h"
 #include "ola/network/HealthCheckedConnection.h"
 #include "ola/thread/SchedulerInterface.h"
@@ -24,17 +25,117 @@
 namespace ola {
 namespace network {
 
+using std::vector;
+
+const unsigned int HeartbeatScheduler::DEFAULT_SWEEP_INTERVAL_MS;
+
+HeartbeatScheduler::HeartbeatScheduler(
+  ola::thread::SchedulerInterface *scheduler,
+  const ola::Clock *clock,
+  unsigned int sweep_interval_ms)
+    : m_scheduler(scheduler),
+      m_clock(clock),
+      m_sweep_interval_ms(sweep_interval_ms),
+      m_sweep_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+
+HeartbeatScheduler::~HeartbeatScheduler() {
+  if (!m_connections.empty())
+    OLA_WARN << m_connections.size() << " connections still registered";
+  if (m_sweep_timeout != ola::thread::INVALID_TIMEOUT)
+    m_scheduler->RemoveTimeout(m_sweep_timeout);
+}
+
+
+void HeartbeatScheduler::AddConnection(HealthCheckedConnection *connection) {
+  m_connections.insert(connection);
+  if (m_sweep_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_sweep_timeout = m_scheduler->RegisterRepeatingTimeout(
+      m_sweep_interval_ms,
+      NewCallback(this, &HeartbeatScheduler::Sweep));
+  }
+}
+
+
+/**
+ * The sweep timer is left running, it'll cancel itself if there are no
+ * connections on the next sweep.
+ */
+void HeartbeatScheduler::RemoveConnection(
+    HealthCheckedConnection *connection) {
+  m_connections.erase(connection);
+}
+
+
+/**
+ * Send the heartbeats that are due, and time out the connections that have
+ * missed their deadline.
+ */
+bool HeartbeatScheduler::Sweep() {
+  if (m_connections.empty()) {
+    m_sweep_timeout = ola::thread::INVALID_TIMEOUT;
+    return false;
+  }
+
+  TimeStamp now;
+  Now(&now);
+
+  // Sending a heartbeat or timing out may remove connections, so work from a
+  // copy and skip the ones that have gone.
+  const vector<HealthCheckedConnection*> connections(m_connections.begin(),
+                                                     m_connections.end());
+  vector<HealthCheckedConnection*>::const_iterator iter = connections.begin();
+  for (; iter != connections.end(); ++iter) {
+    HealthCheckedConnection *connection = *iter;
+    if (m_connections.find(connection) == m_connections.end())
+      continue;
+
+    if (!connection->m_receive_paused &&
+        now >= connection->m_receive_deadline) {
+      connection->m_receive_paused = true;
+      connection->HeartbeatTimeout();
+      continue;
+    }
+
+    if (now >= connection->m_next_heartbeat) {
+      connection->m_next_heartbeat = now + connection->m_heartbeat_interval;
+      connection->SendHeartbeat();
+    }
+  }
+  return true;
+}
+
+
 HealthCheckedConnection::HealthCheckedConnection(
   ola::thread::SchedulerInterface *scheduler,
   const ola::TimeInterval timeout_interval)
     : m_scheduler(scheduler),
       m_heartbeat_interval(timeout_interval),
       m_send_timeout_id(ola::thread::INVALID_TIMEOUT),
-      m_receive_timeout_id(ola::thread::INVALID_TIMEOUT) {
+      m_receive_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_heartbeat_scheduler(NULL),
+      m_receive_paused(true) {
+}
+
+
+HealthCheckedConnection::HealthCheckedConnection(
+  HeartbeatScheduler *heartbeat_scheduler,
+  const ola::TimeInterval timeout_interval)
+    : m_scheduler(NULL),
+      m_heartbeat_interval(timeout_interval),
+      m_send_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_receive_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_heartbeat_scheduler(heartbeat_scheduler),
+      m_receive_paused(true) {
 }
 
 
 HealthCheckedConnection::~HealthCheckedConnection() {
+  if (m_heartbeat_scheduler) {
+    m_heartbeat_scheduler->RemoveConnection(this);
+    return;
+  }
   if (m_send_timeout_id != ola::thread::INVALID_TIMEOUT)
     m_scheduler->RemoveTimeout(m_send_timeout_id);
   if (m_receive_timeout_id != ola::thread::INVALID_TIMEOUT)
@@ -57,6 +158,12 @@ bool HealthCheckedConnection::Setup() {
  * Reset the send timer
  */
 void HealthCheckedConnection::HeartbeatSent() {
+  if (m_heartbeat_scheduler) {
+    m_heartbeat_scheduler->Now(&m_next_heartbeat);
+    m_next_heartbeat += m_heartbeat_interval;
+    m_heartbeat_scheduler->AddConnection(this);
+    return;
+  }
   if (m_send_timeout_id != ola::thread::INVALID_TIMEOUT)
     m_scheduler->RemoveTimeout(m_send_timeout_id);
   m_send_timeout_id = m_scheduler->RegisterRepeatingTimeout(
@@ -69,6 +176,13 @@ void HealthCheckedConnection::HeartbeatSent() {
  * Reset the RX timer
  */
 void HealthCheckedConnection::HeartbeatReceived() {
+  if (m_heartbeat_scheduler) {
+    if (!m_receive_paused) {
+      m_heartbeat_scheduler->Now(&m_receive_deadline);
+      m_receive_deadline += ReceiveTimeout();
+    }
+    return;
+  }
   m_scheduler->RemoveTimeout(m_receive_timeout_id);
   UpdateReceiveTimer();
 }
@@ -78,6 +192,10 @@ void HealthCheckedConnection::HeartbeatReceived() {
  * Pause the receive timer
  */
 void HealthCheckedConnection::PauseTimer() {
+  if (m_heartbeat_scheduler) {
+    m_receive_paused = true;
+    return;
+  }
   if (m_receive_timeout_id != ola::thread::INVALID_TIMEOUT) {
     m_scheduler->RemoveTimeout(m_receive_timeout_id);
     m_receive_timeout_id = ola::thread::INVALID_TIMEOUT;
@@ -89,6 +207,15 @@ void HealthCheckedConnection::PauseTimer() {
  * Resume the receive timer
  */
 void HealthCheckedConnection::ResumeTimer() {
+  if (m_heartbeat_scheduler) {
+    if (m_receive_paused) {
+      m_receive_paused = false;
+      m_heartbeat_scheduler->Now(&m_receive_deadline);
+      m_receive_deadline += ReceiveTimeout();
+      m_heartbeat_scheduler->AddConnection(this);
+    }
+    return;
+  }
   if (m_receive_timeout_id == ola::thread::INVALID_TIMEOUT)
     UpdateReceiveTimer();
 }
@@ -101,14 +228,16 @@ bool HealthCheckedConnection::SendNextHeartbeat() {
 
 
 void HealthCheckedConnection::UpdateReceiveTimer() {
-  TimeInterval timeout_interval(static_cast<int>(
-        2.5 * m_heartbeat_interval.AsInt()));
   m_receive_timeout_id = m_scheduler->RegisterSingleTimeout(
-    timeout_interval,
+    ReceiveTimeout(),
     NewSingleCallback(
       this, &HealthCheckedConnection::InternalHeartbeatTimeout));
 }
 
+TimeInterval HealthCheckedConnection::ReceiveTimeout() const {
+  return TimeInterval(static_cast<int>(2.5 * m_heartbeat_interval.AsInt()));
+}
+
 void HealthCheckedConnection::InternalHeartbeatTimeout() {
   m_receive_timeout_id = ola::thread::INVALID_TIMEOUT;
   HeartbeatTimeout();
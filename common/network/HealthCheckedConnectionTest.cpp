@@ -34,6 +34,7 @@ using ola::NewCallback;
 using ola::NewSingleCallback;
 using ola::TimeInterval;
 using ola::network::HealthCheckedConnection;
+using ola::network::HeartbeatScheduler;
 using ola::io::LoopbackDescriptor;
 using ola::io::SelectServer;
 
@@ -69,6 +70,22 @@ class MockHealthCheckedConnection: public HealthCheckedConnection {
           m_clock(clock) {
     }
 
+    MockHealthCheckedConnection(ola::io::ConnectedDescriptor *descriptor,
+                                SelectServer *scheduler,
+                                HeartbeatScheduler *heartbeat_scheduler,
+                                const ola::TimeInterval timeout_interval,
+                                const Options &options,
+                                MockClock *clock)
+        : HealthCheckedConnection(heartbeat_scheduler, timeout_interval),
+          m_descriptor(descriptor),
+          m_ss(scheduler),
+          m_options(options),
+          m_next_heartbeat(0),
+          m_expected_heartbeat(0),
+          m_channel_ok(true),
+          m_clock(clock) {
+    }
+
     void SendHeartbeat() {
       if (m_options.send_every == 0 ||
           m_next_heartbeat % m_options.send_every == 0) {
@@ -115,6 +132,7 @@ class HealthCheckedConnectionTest: public CppUnit::TestFixture {
     HealthCheckedConnectionTest()
         : CppUnit::TestFixture(),
           m_ss(NULL, &m_clock),
+          m_heartbeat_scheduler(&m_ss, &m_clock, SWEEP_INTERVAL_MS),
           heartbeat_interval(0, 200000) {
     }
 
@@ -123,6 +141,9 @@ class HealthCheckedConnectionTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testChannelWithPacketLoss);
   CPPUNIT_TEST(testChannelWithHeavyPacketLoss);
   CPPUNIT_TEST(testPauseAndResume);
+  CPPUNIT_TEST(testSharedScheduler);
+  CPPUNIT_TEST(testSharedSchedulerWithPacketLoss);
+  CPPUNIT_TEST(testSharedSchedulerPauseAndResume);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -132,6 +153,9 @@ class HealthCheckedConnectionTest: public CppUnit::TestFixture {
     void testChannelWithPacketLoss();
     void testChannelWithHeavyPacketLoss();
     void testPauseAndResume();
+    void testSharedScheduler();
+    void testSharedSchedulerWithPacketLoss();
+    void testSharedSchedulerPauseAndResume();
 
     void PauseReading(MockHealthCheckedConnection *connection) {
       connection->PauseTimer();
@@ -146,9 +170,12 @@ class HealthCheckedConnectionTest: public CppUnit::TestFixture {
  private:
     MockClock m_clock;
     SelectServer m_ss;
+    HeartbeatScheduler m_heartbeat_scheduler;
     LoopbackDescriptor socket;
     TimeInterval heartbeat_interval;
     MockHealthCheckedConnection::Options options;
+
+    static const unsigned int SWEEP_INTERVAL_MS = 10;
 };
 
 
@@ -257,3 +284,87 @@ void HealthCheckedConnectionTest::testPauseAndResume() {
   m_ss.Run();
   OLA_ASSERT_TRUE(connection.ChannelOk());
 }
+
+
+/*
+ * Check that a channel using a HeartbeatScheduler stays up when all heartbeats
+ * are received.
+ */
+void HealthCheckedConnectionTest::testSharedScheduler() {
+  options.validate_heartbeat = true;
+  MockHealthCheckedConnection connection(&socket,
+                                         &m_ss,
+                                         &m_heartbeat_scheduler,
+                                         heartbeat_interval,
+                                         options,
+                                         &m_clock);
+
+  socket.SetOnData(
+      NewCallback(&connection, &MockHealthCheckedConnection::ReadData));
+  m_ss.AddReadDescriptor(&socket);
+  connection.Setup();
+  OLA_ASSERT_EQ(1u, m_heartbeat_scheduler.ConnectionCount());
+
+  m_ss.Run();
+  OLA_ASSERT_TRUE(connection.ChannelOk());
+}
+
+
+/**
+ * Check a channel using a HeartbeatScheduler goes down when too many
+ * heartbeats are lost.
+ */
+void HealthCheckedConnectionTest::testSharedSchedulerWithPacketLoss() {
+  options.send_every = 3;
+  options.abort_on_failure = false;
+  MockHealthCheckedConnection connection(&socket,
+                                         &m_ss,
+                                         &m_heartbeat_scheduler,
+                                         heartbeat_interval,
+                                         options,
+                                         &m_clock);
+
+  socket.SetOnData(
+      NewCallback(&connection, &MockHealthCheckedConnection::ReadData));
+  m_ss.AddReadDescriptor(&socket);
+  connection.Setup();
+
+  m_ss.Run();
+  OLA_ASSERT_FALSE(connection.ChannelOk());
+}
+
+
+/**
+ * Check pausing a channel using a HeartbeatScheduler doesn't mark it as bad,
+ * and that the scheduler forgets the connection once it's gone.
+ */
+void HealthCheckedConnectionTest::testSharedSchedulerPauseAndResume() {
+  {
+    MockHealthCheckedConnection connection(&socket,
+                                           &m_ss,
+                                           &m_heartbeat_scheduler,
+                                           heartbeat_interval,
+                                           options,
+                                           &m_clock);
+    socket.SetOnData(
+        NewCallback(&connection, &MockHealthCheckedConnection::ReadData));
+    m_ss.AddReadDescriptor(&socket);
+    connection.Setup();
+
+    m_ss.RegisterSingleTimeout(
+        TimeInterval(1, 0),
+        NewSingleCallback(this,
+                          &HealthCheckedConnectionTest::PauseReading,
+                          &connection));
+    m_ss.RegisterSingleTimeout(
+        TimeInterval(3, 0),
+        NewSingleCallback(this,
+                          &HealthCheckedConnectionTest::ResumeReading,
+                          &connection));
+
+    m_ss.Run();
+    OLA_ASSERT_TRUE(connection.ChannelOk());
+    m_ss.RemoveReadDescriptor(&socket);
+  }
+  OLA_ASSERT_EQ(0u, m_heartbeat_scheduler.ConnectionCount());
+}
@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InterfaceMonitor.cpp
+ * Notifies listeners when the network interfaces on the system change.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <unistd.h>
+#include "common/network/NetworkUtilsInternal.h"
+#include "ola/Logging.h"
+#include "ola/network/InterfaceMonitor.h"
+
+namespace ola {
+namespace network {
+
+const unsigned int InterfaceMonitor::SETTLE_TIME_MS = 500;
+
+InterfaceMonitor::InterfaceMonitor(ola::io::SelectServerInterface *ss)
+    : m_ss(ss),
+      m_settle_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+InterfaceMonitor::~InterfaceMonitor() {
+  if (m_settle_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_settle_timeout);
+  }
+  if (m_descriptor.get()) {
+    m_ss->RemoveReadDescriptor(m_descriptor.get());
+    close(ola::io::ToFD(m_descriptor->ReadDescriptor()));
+  }
+}
+
+bool InterfaceMonitor::Init() {
+  if (m_descriptor.get()) {
+    return true;
+  }
+
+  int sd = OpenInterfaceEventSocket();
+  if (sd < 0) {
+    OLA_INFO << "Interface change events aren't supported on this platform";
+    return false;
+  }
+
+  m_descriptor.reset(new ola::io::UnmanagedFileDescriptor(sd));
+  m_descriptor->SetOnData(
+      NewCallback(this, &InterfaceMonitor::EventsReady));
+  if (!m_ss->AddReadDescriptor(m_descriptor.get())) {
+    m_descriptor.reset();
+    close(sd);
+    return false;
+  }
+  return true;
+}
+
+void InterfaceMonitor::AddListener(Callback0<void> *listener) {
+  m_listeners.insert(listener);
+}
+
+void InterfaceMonitor::RemoveListener(Callback0<void> *listener) {
+  m_listeners.erase(listener);
+}
+
+/*
+ * Called when the kernel has events for us. We (re)start the settle timer
+ * rather than notifying straight away.
+ */
+void InterfaceMonitor::EventsReady() {
+  if (!DrainInterfaceEvents(
+          ola::io::ToFD(m_descriptor->ReadDescriptor()))) {
+    return;
+  }
+
+  if (m_settle_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_settle_timeout);
+  }
+  m_settle_timeout = m_ss->RegisterSingleTimeout(
+      SETTLE_TIME_MS,
+      NewSingleCallback(this, &InterfaceMonitor::RunListeners));
+}
+
+void InterfaceMonitor::RunListeners() {
+  m_settle_timeout = ola::thread::INVALID_TIMEOUT;
+  OLA_INFO << "Network interfaces changed";
+
+  // Take a copy, a listener may remove itself.
+  ListenerSet listeners = m_listeners;
+  ListenerSet::iterator iter = listeners.begin();
+  for (; iter != listeners.end(); ++iter) {
+    if (m_listeners.find(*iter) != m_listeners.end()) {
+      (*iter)->Run();
+    }
+  }
+}
+}  // namespace network
+}  // namespace ola
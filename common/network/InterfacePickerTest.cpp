@@ -46,12 +46,14 @@ class InterfacePickerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(InterfacePickerTest);
   CPPUNIT_TEST(testGetInterfaces);
   CPPUNIT_TEST(testGetLoopbackInterfaces);
+  CPPUNIT_TEST(testRepeatedGetInterfaces);
   CPPUNIT_TEST(testChooseInterface);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testGetInterfaces();
     void testGetLoopbackInterfaces();
+    void testRepeatedGetInterfaces();
     void testChooseInterface();
 };
 
@@ -108,6 +110,31 @@ void InterfacePickerTest::testGetLoopbackInterfaces() {
 }
 
 
+/*
+ * Check that repeated calls, which may be served from the cache, agree and
+ * that loopback interfaces are filtered out when asked.
+ */
+void InterfacePickerTest::testRepeatedGetInterfaces() {
+  auto_ptr<InterfacePicker> picker(InterfacePicker::NewPicker());
+  vector<Interface> all_interfaces = picker->GetInterfaces(true);
+  OLA_ASSERT_VECTOR_EQ(all_interfaces, picker->GetInterfaces(true));
+
+  auto_ptr<InterfacePicker> other_picker(InterfacePicker::NewPicker());
+  OLA_ASSERT_VECTOR_EQ(all_interfaces, other_picker->GetInterfaces(true));
+
+  vector<Interface> interfaces = picker->GetInterfaces(false);
+  vector<Interface> expected;
+  vector<Interface>::const_iterator iter = all_interfaces.begin();
+  for (; iter != all_interfaces.end(); ++iter) {
+    OLA_ASSERT_NE(string(""), iter->name);
+    if (!iter->loopback) {
+      expected.push_back(*iter);
+    }
+  }
+  OLA_ASSERT_VECTOR_EQ(expected, interfaces);
+}
+
+
 void InterfacePickerTest::testChooseInterface() {
   vector<Interface> interfaces;
   FakeInterfacePicker picker(interfaces);
@@ -7,6 +7,7 @@ common_libolacommon_la_SOURCES += \
     common/network/IPV4Address.cpp \
     common/network/IPV6Address.cpp \
     common/network/Interface.cpp \
+    common/network/InterfaceMonitor.cpp \
     common/network/InterfacePicker.cpp \
     common/network/MACAddress.cpp \
     common/network/NetworkUtils.cpp \
@@ -17,7 +18,10 @@ common_libolacommon_la_SOURCES += \
     common/network/SocketHelper.cpp \
     common/network/SocketHelper.h \
     common/network/TCPConnector.cpp \
-    common/network/TCPSocket.cpp
+    common/network/TCPSocket.cpp \
+    common/network/TransmitPacer.cpp \
+    common/network/UDPPacketBuilder.cpp \
+    common/network/UnixDomainSocket.cpp
 
 common_libolacommon_la_LIBADD += $(RESOLV_LIBS)
 
@@ -51,7 +55,8 @@ common_network_NetworkTester_SOURCES = \
     common/network/MACAddressTest.cpp \
     common/network/NetworkUtilsTest.cpp \
     common/network/SocketAddressTest.cpp \
-    common/network/SocketTest.cpp
+    common/network/SocketTest.cpp \
+    common/network/TransmitPacerTest.cpp
 common_network_NetworkTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_network_NetworkTester_LDADD = $(COMMON_TESTING_LIBS)
 
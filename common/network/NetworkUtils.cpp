@@ -62,6 +62,9 @@ typedef uint32_t in_addr_t;
 #include <endian.h>
 #endif  // HAVE_ENDIAN_H
 #include <errno.h>
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif  // HAVE_FCNTL_H
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
@@ -601,6 +604,62 @@ static bool GetDefaultRouteWithNetlink(int32_t *if_index,
 }
 #endif  // USE_SYSCTL_FOR_DEFAULT_ROUTE
 
+int OpenInterfaceEventSocket() {
+#ifdef USE_NETLINK_FOR_DEFAULT_ROUTE
+  int sd = socket(PF_ROUTE, SOCK_DGRAM, NETLINK_ROUTE);
+  if (sd < 0) {
+    OLA_WARN << "Could not create Netlink socket " << strerror(errno);
+    return -1;
+  }
+
+  int flags = fcntl(sd, F_GETFL, 0);
+  if (flags < 0 || fcntl(sd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    OLA_WARN << "Could not make Netlink socket non-blocking "
+             << strerror(errno);
+    close(sd);
+    return -1;
+  }
+
+  struct sockaddr_nl addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+  if (bind(sd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    OLA_WARN << "Could not bind Netlink socket " << strerror(errno);
+    close(sd);
+    return -1;
+  }
+  return sd;
+#else
+  return -1;
+#endif  // USE_NETLINK_FOR_DEFAULT_ROUTE
+}
+
+bool DrainInterfaceEvents(int sd) {
+#ifdef USE_NETLINK_FOR_DEFAULT_ROUTE
+  const unsigned int BUFSIZE = 8192;
+  uint8_t msg[BUFSIZE];
+  bool changed = false;
+  while (true) {
+    ssize_t len = recv(sd, msg, BUFSIZE, MSG_DONTWAIT);
+    if (len > 0) {
+      changed = true;
+    } else if (len < 0 && errno == EINTR) {
+      continue;
+    } else if (len < 0 && errno == ENOBUFS) {
+      // The kernel dropped events, assume something changed.
+      changed = true;
+    } else {
+      break;
+    }
+  }
+  return changed;
+#else
+  (void) sd;
+  return false;
+#endif  // USE_NETLINK_FOR_DEFAULT_ROUTE
+}
+
 bool DefaultRoute(int32_t *if_index, IPV4Address *default_gateway) {
   *default_gateway = IPV4Address();
   *if_index = Interface::DEFAULT_INDEX;
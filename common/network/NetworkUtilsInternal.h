@@ -44,6 +44,21 @@ namespace network {
  */
 unsigned int SockAddrLen(const struct sockaddr &sa);
 
+/**
+ * @brief Open a socket that receives interface & address change events.
+ * @returns a non-blocking descriptor, or -1 if this platform doesn't support
+ *   interface events.
+ */
+int OpenInterfaceEventSocket();
+
+/**
+ * @brief Read all pending events from an interface event socket.
+ * @param sd the descriptor returned by OpenInterfaceEventSocket().
+ * @returns true if at least one event was read, or events may have been
+ *   dropped.
+ */
+bool DrainInterfaceEvents(int sd);
+
 }  // namespace network
 }  // namespace ola
 #endif  // COMMON_NETWORK_NETWORKUTILSINTERNAL_H_
@@ -28,9 +28,11 @@
 #include <vector>
 
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/WireLayout.h"
 #include "ola/Logging.h"
 #include "ola/testing/TestUtils.h"
 
+using ola::network::BigEndian;
 using ola::network::FQDN;
 using ola::network::DomainNameFromFQDN;
 using ola::network::Hostname;
@@ -38,6 +40,7 @@ using ola::network::HostnameFromFQDN;
 using ola::network::HostToLittleEndian;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
+using ola::network::LittleEndian;
 using ola::network::LittleEndianToHost;
 using ola::network::NameServers;
 using ola::network::DefaultRoute;
@@ -50,6 +53,7 @@ class NetworkUtilsTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(NetworkUtilsTest);
   CPPUNIT_TEST(testToFromNetwork);
   CPPUNIT_TEST(testToFromLittleEndian);
+  CPPUNIT_TEST(testWireFields);
   CPPUNIT_TEST(testNameProcessing);
   CPPUNIT_TEST(testNameServers);
   CPPUNIT_TEST(testDefaultRoute);
@@ -60,6 +64,7 @@ class NetworkUtilsTest: public CppUnit::TestFixture {
     void tearDown();
     void testToFromNetwork();
     void testToFromLittleEndian();
+    void testWireFields();
     void testNameProcessing();
     void testNameServers();
     void testDefaultRoute();
@@ -130,6 +135,38 @@ void NetworkUtilsTest::testToFromLittleEndian() {
 }
 
 
+PACK(
+struct test_packet_s {
+  uint8_t type;
+  BigEndian<uint16_t> length;
+  LittleEndian<uint32_t> id;
+});
+
+WIRE_SIZE_ASSERT(test_packet_s, 7);
+WIRE_OFFSET_ASSERT(test_packet_s, id, 3);
+
+/*
+ * Check the endian tagged fields are laid out in the right order
+ */
+void NetworkUtilsTest::testWireFields() {
+  test_packet_s packet;
+  packet.type = 1;
+  packet.length.Set(0x0203);
+  packet.id.Set(0x07060504);
+
+  const uint8_t expected[] = {1, 2, 3, 4, 5, 6, 7};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                         reinterpret_cast<uint8_t*>(&packet), sizeof(packet));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x0203), packet.length.Get());
+  OLA_ASSERT_EQ(static_cast<uint32_t>(0x07060504), packet.id.Get());
+
+  packet.length.Set(0xfffe);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0xfffe), packet.length.Get());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xff), packet.length.bytes[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xfe), packet.length.bytes[1]);
+}
+
+
 /*
  * Check that name processing works
  */
@@ -59,6 +59,7 @@
 #include "ola/network/MACAddress.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/network/SocketCloser.h"
+#include "ola/thread/Mutex.h"
 
 namespace ola {
 namespace network {
@@ -66,11 +67,82 @@ namespace network {
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * The interface table is shared by all pickers in the process. It's only
+ * trusted while we have an interface event socket to tell us when it goes
+ * stale, otherwise every call queries the kernel.
+ */
+class InterfaceCache {
+ public:
+  InterfaceCache() : m_event_sd(-1), m_opened(false), m_valid(false) {}
+
+  ola::thread::Mutex mutex;
+
+  bool Valid() {
+    if (!m_opened) {
+      m_opened = true;
+      m_event_sd = OpenInterfaceEventSocket();
+    }
+    if (m_event_sd < 0) {
+      return false;
+    }
+    if (DrainInterfaceEvents(m_event_sd)) {
+      m_valid = false;
+    }
+    return m_valid;
+  }
+
+  const vector<Interface> &Interfaces() const { return m_interfaces; }
+
+  void Update(const vector<Interface> &interfaces) {
+    m_interfaces = interfaces;
+    // Don't cache an empty table, it's usually a transient state at boot.
+    m_valid = m_event_sd >= 0 && !interfaces.empty();
+  }
+
+ private:
+  int m_event_sd;
+  bool m_opened;
+  bool m_valid;
+  vector<Interface> m_interfaces;
+};
+
+InterfaceCache interface_cache;
+}  // namespace
+
 /*
  * Return a vector of interfaces on the system.
  */
 vector<Interface> PosixInterfacePicker::GetInterfaces(
     bool include_loopback) const {
+  ola::thread::MutexLocker locker(&interface_cache.mutex);
+  if (!interface_cache.Valid()) {
+    interface_cache.Update(QueryInterfaces(true));
+  }
+
+  if (include_loopback) {
+    return interface_cache.Interfaces();
+  }
+
+  vector<Interface> interfaces;
+  vector<Interface>::const_iterator iter =
+      interface_cache.Interfaces().begin();
+  for (; iter != interface_cache.Interfaces().end(); ++iter) {
+    if (!iter->loopback) {
+      interfaces.push_back(*iter);
+    }
+  }
+  return interfaces;
+}
+
+
+/*
+ * Query the kernel for the interfaces on the system.
+ */
+vector<Interface> PosixInterfacePicker::QueryInterfaces(
+    bool include_loopback) const {
   vector<Interface> interfaces;
 
 #ifdef HAVE_SOCKADDR_DL_STRUCT
@@ -28,7 +28,11 @@ namespace network {
 
 
 /*
- * The InterfacePicker for posix systems
+ * The InterfacePicker for posix systems.
+ *
+ * Where the platform supports interface events (netlink on Linux) the
+ * interface table is cached and only refreshed after the kernel reports a
+ * change.
  */
 class PosixInterfacePicker: public InterfacePicker {
  public:
@@ -38,6 +42,7 @@ class PosixInterfacePicker: public InterfacePicker {
     static const unsigned int INITIAL_IFACE_COUNT = 10;
     static const unsigned int IFACE_COUNT_INC = 5;
     unsigned int GetIfReqSize(const char *data) const;
+    std::vector<Interface> QueryInterfaces(bool include_loopback) const;
 };
 }  // namespace network
 }  // namespace ola
@@ -48,9 +48,15 @@
 #include <netinet/in.h>
 #endif  // HAVE_NETINET_IN_H
 
+#ifdef SO_MEMINFO
+#include <linux/sock_diag.h>
+#endif  // SO_MEMINFO
+
+#include <algorithm>
 #include <string>
 
 #include "common/network/SocketHelper.h"
+#include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/network/TCPSocketFactory.h"
@@ -76,6 +82,43 @@ bool ReceiveFrom(int fd, uint8_t *buffer, ssize_t *data_read,
   return true;
 }
 
+#ifdef HAVE_RECVMMSG
+// The space for the ancillary data of each received datagram.
+union ReceiveControl {
+  struct cmsghdr align;
+  char data[CMSG_SPACE(sizeof(struct timespec))];
+};
+
+/*
+ * Copy the kernel receive timestamps into the datagrams. The kernel uses the
+ * real time clock, so convert them to the monotonic clock.
+ */
+void SetReceiveTimestamps(struct mmsghdr *messages, UDPDatagram *datagrams,
+                          int count) {
+  TimeStamp real_now, monotonic_now;
+  Clock clock;
+  clock.CurrentRealTime(&real_now);
+  clock.CurrentMonotonicTime(&monotonic_now);
+
+  for (int i = 0; i < count; i++) {
+    struct msghdr *header = &messages[i].msg_hdr;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(header); cmsg;
+         cmsg = CMSG_NXTHDR(header, cmsg)) {
+#ifdef SCM_TIMESTAMPNS
+      if (cmsg->cmsg_level == SOL_SOCKET &&
+          cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        struct timespec arrival;
+        memcpy(&arrival, CMSG_DATA(cmsg), sizeof(arrival));
+        TimeStamp arrival_time(arrival);
+        // Guard against the real time clock stepping backwards.
+        datagrams[i].timestamp = arrival_time < real_now ?
+            monotonic_now - (real_now - arrival_time) : monotonic_now;
+      }
+#endif  // SCM_TIMESTAMPNS
+    }
+  }
+}
+#endif  // HAVE_RECVMMSG
 }  // namespace
 
 // UDPSocket
@@ -233,50 +276,59 @@ ssize_t UDPSocket::SendTo(ola::io::IOVecInterface *data,
 
 ssize_t UDPSocket::SendTo(ola::io::IOVecInterface *data,
                           const IPV4SocketAddress &dest) const {
-  if (!ValidWriteDescriptor())
-    return 0;
-
-  struct sockaddr_in destination;
-  if (!dest.ToSockAddr(reinterpret_cast<sockaddr*>(&destination),
-                       sizeof(destination))) {
-    return 0;
-  }
-
   int io_len;
   const struct ola::io::IOVec *iov = data->AsIOVec(&io_len);
 
   if (iov == NULL)
     return 0;
 
-#ifdef _WIN32
-  ssize_t bytes_sent = 0;
+  ssize_t bytes_sent = SendTo(iov, io_len, dest);
+  data->FreeIOVec(iov);
 
-  for (int buffer = 0; buffer < io_len; ++buffer) {
-    bytes_sent += SendTo(reinterpret_cast<uint8_t*>(iov[buffer].iov_base),
-        iov[buffer].iov_len, dest);
+  if (bytes_sent > 0) {
+    data->Pop(bytes_sent);
   }
+  return bytes_sent;
+}
 
+ssize_t UDPSocket::SendTo(const ola::io::IOVec *iov,
+                          unsigned int iov_count,
+                          const IPV4SocketAddress &dest) const {
+  if (!ValidWriteDescriptor())
+    return 0;
+
+#ifdef _WIN32
+  // Copy the blocks, so they're sent as a single datagram.
+  std::string packet;
+  for (unsigned int i = 0; i < iov_count; ++i) {
+    packet.append(reinterpret_cast<const char*>(iov[i].iov_base),
+                  iov[i].iov_len);
+  }
+  return SendTo(reinterpret_cast<const uint8_t*>(packet.data()),
+                packet.size(), dest);
 #else
+  struct sockaddr_in destination;
+  if (!dest.ToSockAddr(reinterpret_cast<sockaddr*>(&destination),
+                       sizeof(destination))) {
+    return 0;
+  }
+
   struct msghdr message;
   message.msg_name = &destination;
   message.msg_namelen = sizeof(destination);
   message.msg_iov = reinterpret_cast<iovec*>(const_cast<io::IOVec*>(iov));
-  message.msg_iovlen = io_len;
+  message.msg_iovlen = iov_count;
   message.msg_control = NULL;
   message.msg_controllen = 0;
   message.msg_flags = 0;
 
   ssize_t bytes_sent = sendmsg(WriteDescriptor(), &message, 0);
-#endif  // _WIN32
-  data->FreeIOVec(iov);
-
   if (bytes_sent < 0) {
     OLA_INFO << "Failed to send on " << WriteDescriptor() << ": to "
              << dest << " : " <<  strerror(errno);
-  } else {
-    data->Pop(bytes_sent);
   }
   return bytes_sent;
+#endif  // _WIN32
 }
 
 bool UDPSocket::RecvFrom(uint8_t *buffer, ssize_t *data_read) const {
@@ -342,6 +394,154 @@ bool UDPSocket::RecvFrom(uint8_t *buffer,
   return ok;
 }
 
+const unsigned int UDPSocket::MAX_BATCH_SIZE;
+
+unsigned int UDPSocket::RecvMultiple(UDPDatagram *datagrams,
+                                     unsigned int count) {
+  if (!ValidReadDescriptor())
+    return 0;
+
+  unsigned int received = 0;
+#ifdef HAVE_RECVMMSG
+  struct mmsghdr messages[MAX_BATCH_SIZE];
+  struct sockaddr_in sources[MAX_BATCH_SIZE];
+  ReceiveControl controls[MAX_BATCH_SIZE];
+
+  while (received < count) {
+    unsigned int batch_size = std::min(count - received, MAX_BATCH_SIZE);
+    UDPDatagram *batch = datagrams + received;
+    for (unsigned int i = 0; i < batch_size; i++) {
+      struct msghdr *header = &messages[i].msg_hdr;
+      memset(header, 0, sizeof(*header));
+      header->msg_name = &sources[i];
+      header->msg_namelen = sizeof(sources[i]);
+      header->msg_iov = reinterpret_cast<iovec*>(&batch[i].buffer);
+      header->msg_iovlen = 1;
+      if (m_receive_timestamps) {
+        header->msg_control = controls[i].data;
+        header->msg_controllen = sizeof(controls[i].data);
+      }
+    }
+
+    int r = recvmmsg(m_handle, messages, batch_size, MSG_DONTWAIT, NULL);
+    if (r < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        OLA_WARN << "recvmmsg fd: " << m_handle << " failed: "
+                 << strerror(errno);
+      }
+      break;
+    }
+
+    for (int i = 0; i < r; i++) {
+      batch[i].buffer.iov_len = messages[i].msg_len;
+      batch[i].address = IPV4SocketAddress(
+          IPV4Address(sources[i].sin_addr.s_addr),
+          NetworkToHost(sources[i].sin_port));
+      batch[i].timestamp = TimeStamp();
+    }
+    if (m_receive_timestamps) {
+      SetReceiveTimestamps(messages, batch, r);
+    }
+    received += r;
+    if (static_cast<unsigned int>(r) < batch_size)
+      break;  // the socket has been drained
+  }
+#else
+  for (; received < count; received++) {
+    UDPDatagram *datagram = datagrams + received;
+    struct sockaddr_in source;
+    socklen_t source_size = sizeof(source);
+#ifdef _WIN32
+    // We can't do a non-blocking read, so only take the datagram we know is
+    // available.
+    if (received)
+      break;
+    ssize_t r = recvfrom(
+        m_handle.m_handle.m_fd,
+        reinterpret_cast<char*>(datagram->buffer.iov_base),
+        datagram->buffer.iov_len, 0,
+        reinterpret_cast<struct sockaddr*>(&source), &source_size);
+#else
+    ssize_t r = recvfrom(
+        m_handle,
+        reinterpret_cast<char*>(datagram->buffer.iov_base),
+        datagram->buffer.iov_len, MSG_DONTWAIT,
+        reinterpret_cast<struct sockaddr*>(&source), &source_size);
+#endif  // _WIN32
+    if (r < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        OLA_WARN << "recvfrom failed: " << strerror(errno);
+      }
+      break;
+    }
+    datagram->buffer.iov_len = r;
+    datagram->address = IPV4SocketAddress(IPV4Address(source.sin_addr.s_addr),
+                                          NetworkToHost(source.sin_port));
+    datagram->timestamp = TimeStamp();
+  }
+#endif  // HAVE_RECVMMSG
+  return received;
+}
+
+unsigned int UDPSocket::SendMultiple(const UDPDatagram *datagrams,
+                                     unsigned int count) const {
+  if (!ValidWriteDescriptor())
+    return 0;
+
+  unsigned int sent = 0;
+#ifdef HAVE_SENDMMSG
+  struct mmsghdr messages[MAX_BATCH_SIZE];
+  struct sockaddr_in destinations[MAX_BATCH_SIZE];
+
+  while (sent < count) {
+    unsigned int batch_size = std::min(count - sent, MAX_BATCH_SIZE);
+    const UDPDatagram *batch = datagrams + sent;
+    for (unsigned int i = 0; i < batch_size; i++) {
+      struct msghdr *header = &messages[i].msg_hdr;
+      memset(header, 0, sizeof(*header));
+      if (!batch[i].address.ToSockAddr(
+              reinterpret_cast<sockaddr*>(&destinations[i]),
+              sizeof(destinations[i]))) {
+        return sent;
+      }
+      header->msg_name = &destinations[i];
+      header->msg_namelen = sizeof(destinations[i]);
+      if (batch[i].iov) {
+        header->msg_iov = reinterpret_cast<iovec*>(
+            const_cast<io::IOVec*>(batch[i].iov));
+        header->msg_iovlen = batch[i].iov_count;
+      } else {
+        header->msg_iov = reinterpret_cast<iovec*>(
+            const_cast<io::IOVec*>(&batch[i].buffer));
+        header->msg_iovlen = 1;
+      }
+    }
+
+    int r = sendmmsg(m_handle, messages, batch_size, 0);
+    if (r <= 0) {
+      OLA_INFO << "sendmmsg failed: " << batch[0].address << " : "
+               << strerror(errno);
+      break;
+    }
+    sent += r;
+  }
+#else
+  for (; sent < count; sent++) {
+    const UDPDatagram &datagram = datagrams[sent];
+    const io::IOVec *iov = datagram.iov ? datagram.iov : &datagram.buffer;
+    const unsigned int iov_count = datagram.iov ? datagram.iov_count : 1;
+    size_t size = 0;
+    for (unsigned int i = 0; i < iov_count; i++) {
+      size += iov[i].iov_len;
+    }
+    ssize_t r = SendTo(iov, iov_count, datagram.address);
+    if (r < 0 || static_cast<size_t>(r) != size)
+      break;
+  }
+#endif  // HAVE_SENDMMSG
+  return sent;
+}
+
 bool UDPSocket::EnableBroadcast() {
   if (m_handle == ola::io::INVALID_DESCRIPTOR)
     return false;
@@ -464,5 +664,138 @@ bool UDPSocket::SetTos(uint8_t tos) {
   }
   return true;
 }
+
+bool UDPSocket::EnableReceiveTimestamps() {
+#if defined(HAVE_RECVMMSG) && defined(SO_TIMESTAMPNS)
+  int value = 1;
+  if (setsockopt(m_handle, SOL_SOCKET, SO_TIMESTAMPNS,
+                 reinterpret_cast<char*>(&value), sizeof(value)) < 0) {
+    OLA_WARN << "Failed to set SO_TIMESTAMPNS for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+  m_receive_timestamps = true;
+  return true;
+#else
+  return false;
+#endif  // defined(HAVE_RECVMMSG) && defined(SO_TIMESTAMPNS)
+}
+
+bool UDPSocket::SetMulticastAll(bool enable) {
+#ifdef IP_MULTICAST_ALL
+  int value = enable;
+  if (setsockopt(m_handle, IPPROTO_IP, IP_MULTICAST_ALL,
+                 reinterpret_cast<char*>(&value), sizeof(value)) < 0) {
+    OLA_WARN << "Failed to set IP_MULTICAST_ALL for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  (void) enable;
+  return false;
+#endif  // IP_MULTICAST_ALL
+}
+
+bool UDPSocket::JoinMulticastSource(const IPV4Address &iface,
+                                    const IPV4Address &group,
+                                    const IPV4Address &source,
+                                    bool multicast_loop) {
+#ifdef IP_ADD_SOURCE_MEMBERSHIP
+  if (!SetSourceMembership(IP_ADD_SOURCE_MEMBERSHIP, iface, group, source)) {
+    OLA_WARN << "Failed to join multicast group " << group << " for source "
+             << source << ": " << strerror(errno);
+    return false;
+  }
+
+  if (!multicast_loop) {
+    char loop = 0;
+#ifdef _WIN32
+    int ok = setsockopt(m_handle.m_handle.m_fd, IPPROTO_IP, IP_MULTICAST_LOOP,
+                        &loop, sizeof(loop));
+#else
+    int ok = setsockopt(m_handle, IPPROTO_IP, IP_MULTICAST_LOOP, &loop,
+                        sizeof(loop));
+#endif  // _WIN32
+    if (ok < 0) {
+      OLA_WARN << "Failed to disable looping for " << m_handle << ": "
+               << strerror(errno);
+      return false;
+    }
+  }
+  return true;
+#else
+  (void) iface;
+  (void) group;
+  (void) source;
+  (void) multicast_loop;
+  OLA_WARN << "Source specific multicast isn't supported";
+  return false;
+#endif  // IP_ADD_SOURCE_MEMBERSHIP
+}
+
+bool UDPSocket::LeaveMulticastSource(const IPV4Address &iface,
+                                     const IPV4Address &group,
+                                     const IPV4Address &source) {
+#ifdef IP_DROP_SOURCE_MEMBERSHIP
+  if (!SetSourceMembership(IP_DROP_SOURCE_MEMBERSHIP, iface, group, source)) {
+    OLA_WARN << "Failed to leave multicast group " << group << " for source "
+             << source << ": " << strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  (void) iface;
+  (void) group;
+  (void) source;
+  return false;
+#endif  // IP_DROP_SOURCE_MEMBERSHIP
+}
+
+bool UDPSocket::ReceiveDropCount(uint32_t *drops) const {
+#ifdef SO_MEMINFO
+  uint32_t meminfo[SK_MEMINFO_VARS];
+  socklen_t length = sizeof(meminfo);
+  if (getsockopt(m_handle, SOL_SOCKET, SO_MEMINFO, meminfo, &length) < 0 ||
+      length <= SK_MEMINFO_DROPS * sizeof(uint32_t)) {
+    return false;
+  }
+  *drops = meminfo[SK_MEMINFO_DROPS];
+  return true;
+#else
+  (void) drops;
+  return false;
+#endif  // SO_MEMINFO
+}
+
+bool UDPSocket::SetSourceMembership(int option,
+                                    const IPV4Address &iface,
+                                    const IPV4Address &group,
+                                    const IPV4Address &source) {
+#ifdef IP_ADD_SOURCE_MEMBERSHIP
+  struct ip_mreq_source mreq;
+  memset(&mreq, 0, sizeof(mreq));
+  mreq.imr_interface.s_addr = iface.AsInt();
+  mreq.imr_multiaddr.s_addr = group.AsInt();
+  mreq.imr_sourceaddr.s_addr = source.AsInt();
+
+#ifdef _WIN32
+  int ok = setsockopt(m_handle.m_handle.m_fd,
+#else
+  int ok = setsockopt(m_handle,
+#endif  // _WIN32
+                      IPPROTO_IP,
+                      option,
+                      reinterpret_cast<char*>(&mreq),
+                      sizeof(mreq));
+  return ok == 0;
+#else
+  (void) option;
+  (void) iface;
+  (void) group;
+  (void) source;
+  return false;
+#endif  // IP_ADD_SOURCE_MEMBERSHIP
+}
 }  // namespace network
 }  // namespace ola
@@ -21,10 +21,14 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 #include <string>
 
 #include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/io/Descriptor.h"
 #include "ola/io/IOQueue.h"
 #include "ola/io/SelectServer.h"
@@ -32,9 +36,12 @@
 #include "ola/network/NetworkUtils.h"
 #include "ola/network/Socket.h"
 #include "ola/network/TCPSocketFactory.h"
+#include "ola/network/UDPPacketBuilder.h"
+#include "ola/network/UnixDomainSocket.h"
 #include "ola/testing/TestUtils.h"
 
 
+using ola::DmxBuffer;
 using ola::io::ConnectedDescriptor;
 using ola::io::IOQueue;
 using ola::io::SelectServer;
@@ -43,7 +50,11 @@ using ola::network::GenericSocketAddress;
 using ola::network::IPV4SocketAddress;
 using ola::network::TCPAcceptingSocket;
 using ola::network::TCPSocket;
+using ola::network::UDPDatagram;
+using ola::network::UDPPacketBuilder;
 using ola::network::UDPSocket;
+using ola::network::UnixDomainAcceptingSocket;
+using ola::network::UnixDomainSocket;
 using std::string;
 
 static const unsigned char test_cstring[] = "Foo";
@@ -56,6 +67,12 @@ class SocketTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTCPSocketServerClose);
   CPPUNIT_TEST(testUDPSocket);
   CPPUNIT_TEST(testIOQueueUDPSend);
+  CPPUNIT_TEST(testUDPBatch);
+  CPPUNIT_TEST(testUDPPacketBuilder);
+  CPPUNIT_TEST(testUDPReceiveTimestamps);
+#ifndef _WIN32
+  CPPUNIT_TEST(testUnixDomainSocket);
+#endif  // !_WIN32
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +82,10 @@ class SocketTest: public CppUnit::TestFixture {
     void testTCPSocketServerClose();
     void testUDPSocket();
     void testIOQueueUDPSend();
+    void testUDPBatch();
+    void testUDPPacketBuilder();
+    void testUDPReceiveTimestamps();
+    void testUnixDomainSocket();
 
     // timing out indicates something went wrong
     void Timeout() {
@@ -80,6 +101,7 @@ class SocketTest: public CppUnit::TestFixture {
     void ReceiveSendAndClose(ConnectedDescriptor *socket);
     void NewConnectionSend(TCPSocket *socket);
     void NewConnectionSendAndClose(TCPSocket *socket);
+    void NewUnixConnectionSend(UnixDomainSocket *socket);
     void UDPReceiveAndTerminate(UDPSocket *socket);
     void UDPReceiveAndSend(UDPSocket *socket);
 
@@ -279,6 +301,192 @@ void SocketTest::testIOQueueUDPSend() {
 }
 
 
+/*
+ * Test sending and receiving multiple datagrams at once.
+ */
+void SocketTest::testUDPBatch() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+  OLA_ASSERT_TRUE(client_socket.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress client_address;
+  OLA_ASSERT_TRUE(client_socket.GetSocketAddress(&client_address));
+
+  // Nothing to read yet
+  uint8_t buffers[4][10];
+  UDPDatagram datagrams[4];
+  for (unsigned int i = 0; i < 4; i++) {
+    datagrams[i].buffer.iov_base = buffers[i];
+    datagrams[i].buffer.iov_len = sizeof(buffers[i]);
+  }
+  OLA_ASSERT_EQ(0u, socket.RecvMultiple(datagrams, 4));
+
+  uint8_t payloads[3][3] = {{1}, {2, 2}, {3, 3, 3}};
+  UDPDatagram outgoing[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    outgoing[i].buffer.iov_base = payloads[i];
+    outgoing[i].buffer.iov_len = i + 1;
+    outgoing[i].address = local_address;
+  }
+  OLA_ASSERT_EQ(3u, client_socket.SendMultiple(outgoing, 3));
+
+  OLA_ASSERT_EQ(3u, socket.RecvMultiple(datagrams, 4));
+  for (unsigned int i = 0; i < 3; i++) {
+    OLA_ASSERT_EQ(client_address, datagrams[i].address);
+    OLA_ASSERT_DATA_EQUALS(payloads[i], i + 1,
+                           reinterpret_cast<uint8_t*>(
+                               datagrams[i].buffer.iov_base),
+                           datagrams[i].buffer.iov_len);
+  }
+
+  // The socket has been drained
+  for (unsigned int i = 0; i < 4; i++) {
+    datagrams[i].buffer.iov_len = sizeof(buffers[i]);
+  }
+  OLA_ASSERT_EQ(0u, socket.RecvMultiple(datagrams, 4));
+}
+
+
+/*
+ * Check packets built from a number of blocks are sent as a single datagram.
+ */
+void SocketTest::testUDPPacketBuilder() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+
+  const uint8_t header[] = {'h', 'd', 'r'};
+  DmxBuffer dmx;
+  dmx.SetFromString("1,2,3");
+
+  UDPPacketBuilder packet;
+  OLA_ASSERT_TRUE(packet.Append(header, sizeof(header)));
+  OLA_ASSERT_TRUE(packet.AppendDMX(dmx));
+  OLA_ASSERT_TRUE(packet.AppendPadding(2));
+  OLA_ASSERT_FALSE(packet.AppendPadding(UDPPacketBuilder::MAX_PADDING + 1));
+  OLA_ASSERT_EQ(3u, packet.BlockCount());
+  OLA_ASSERT_EQ(8u, packet.Size());
+
+  const uint8_t expected[] = {'h', 'd', 'r', 1, 2, 3, 0, 0};
+  OLA_ASSERT_TRUE(packet.SendTo(&client_socket, local_address));
+
+  uint8_t buffers[2][10];
+  UDPDatagram datagrams[2];
+  for (unsigned int i = 0; i < 2; i++) {
+    datagrams[i].buffer.iov_base = buffers[i];
+    datagrams[i].buffer.iov_len = sizeof(buffers[i]);
+  }
+  OLA_ASSERT_EQ(1u, socket.RecvMultiple(datagrams, 2));
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), buffers[0],
+                         datagrams[0].buffer.iov_len);
+
+  // Now send the same packet with SendMultiple()
+  UDPDatagram outgoing[2];
+  packet.ToDatagram(local_address, &outgoing[0]);
+  packet.ToDatagram(local_address, &outgoing[1]);
+  OLA_ASSERT_EQ(2u, client_socket.SendMultiple(outgoing, 2));
+
+  datagrams[0].buffer.iov_len = sizeof(buffers[0]);
+  OLA_ASSERT_EQ(2u, socket.RecvMultiple(datagrams, 2));
+  for (unsigned int i = 0; i < 2; i++) {
+    OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), buffers[i],
+                           datagrams[i].buffer.iov_len);
+  }
+}
+
+
+/*
+ * Check the receive timestamps are in the monotonic time base.
+ */
+void SocketTest::testUDPReceiveTimestamps() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+  if (!socket.EnableReceiveTimestamps()) {
+    OLA_INFO << "Receive timestamps aren't supported, skipping test";
+    return;
+  }
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+
+  ola::Clock clock;
+  ola::TimeStamp before, after;
+  clock.CurrentMonotonicTime(&before);
+  uint8_t payload[] = {1, 2, 3};
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(payload)),
+                client_socket.SendTo(payload, sizeof(payload),
+                                     local_address));
+
+  uint8_t buffer[10];
+  UDPDatagram datagram;
+  datagram.buffer.iov_base = buffer;
+  datagram.buffer.iov_len = sizeof(buffer);
+  OLA_ASSERT_EQ(1u, socket.RecvMultiple(&datagram, 1));
+  clock.CurrentMonotonicTime(&after);
+
+  OLA_ASSERT_TRUE(datagram.timestamp.IsSet());
+  // Allow for the conversion between clocks.
+  ola::TimeInterval slack(0, 10000);
+  OLA_ASSERT_TRUE(datagram.timestamp + slack >= before);
+  OLA_ASSERT_TRUE(datagram.timestamp <= after + slack);
+}
+
+
+/*
+ * Test unix domain sockets work correctly.
+ * The client connects and the server checks the credentials and sends some
+ * data. The client checks the data matches and then closes the connection.
+ */
+void SocketTest::testUnixDomainSocket() {
+  const string path = "/tmp/ola-socket-test-" + ola::IntToString(getpid());
+  ola::network::UnixDomainSocketFactory socket_factory(
+      ola::NewCallback(this, &SocketTest::NewUnixConnectionSend));
+  UnixDomainAcceptingSocket socket(&socket_factory);
+  OLA_ASSERT_TRUE(socket.Listen(path));
+  OLA_ASSERT_FALSE(socket.Listen(path));
+  OLA_ASSERT_EQ(path, socket.Path());
+
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&socket));
+
+  UnixDomainSocket *client_socket = UnixDomainSocket::Connect(path);
+  OLA_ASSERT_NOT_NULL(client_socket);
+  client_socket->SetOnData(ola::NewCallback(
+        this, &SocketTest::ReceiveAndClose,
+        static_cast<ConnectedDescriptor*>(client_socket)));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(client_socket));
+  m_ss->Run();
+  m_ss->RemoveReadDescriptor(&socket);
+  m_ss->RemoveReadDescriptor(client_socket);
+  delete client_socket;
+
+  // The path is in use, so a second socket can't take it over.
+  UnixDomainAcceptingSocket other_socket(&socket_factory);
+  OLA_ASSERT_FALSE(other_socket.Listen(path));
+
+  // Closing the socket removes the path.
+  socket.Close();
+  OLA_ASSERT_EQ(-1, access(path.c_str(), F_OK));
+  OLA_ASSERT_NULL(UnixDomainSocket::Connect(path));
+}
+
+
 /*
  * Receive some data and close the socket
  */
@@ -372,6 +580,27 @@ void SocketTest::NewConnectionSendAndClose(TCPSocket *new_socket) {
 }
 
 
+/*
+ * Accept a new unix domain connection, check the credentials and send some
+ * test data.
+ */
+void SocketTest::NewUnixConnectionSend(UnixDomainSocket *new_socket) {
+  OLA_ASSERT_NOT_NULL(new_socket);
+  uid_t uid;
+  gid_t gid;
+  OLA_ASSERT_TRUE(new_socket->GetPeerCredentials(&uid, &gid));
+  OLA_ASSERT_EQ(getuid(), uid);
+  OLA_ASSERT_EQ(getgid(), gid);
+  ssize_t bytes_sent = new_socket->Send(
+      static_cast<const uint8_t*>(test_cstring),
+      sizeof(test_cstring));
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(test_cstring)), bytes_sent);
+  new_socket->SetOnClose(ola::NewSingleCallback(this,
+                                               &SocketTest::TerminateOnClose));
+  m_ss->AddReadDescriptor(new_socket, true);
+}
+
+
 /*
  * Receive some data and check it.
  */
@@ -0,0 +1,276 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TransmitPacer.cpp
+ * Spreads bursts of UDP packets out over time.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "ola/network/TransmitPacer.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace network {
+
+using ola::io::IOVec;
+using ola::thread::INVALID_TIMEOUT;
+using std::deque;
+using std::string;
+
+const TimeInterval TransmitPacer::TICK(0, 1000);
+const unsigned int TransmitPacer::DEFAULT_MAX_QUEUE_DEPTH;
+const unsigned int TransmitPacer::MAX_BATCH_SIZE;
+const unsigned int TransmitPacer::MIN_BUCKET_SIZE;
+
+TransmitPacer::TransmitPacer(ola::thread::SchedulerInterface *scheduler,
+                             const Clock *clock,
+                             const Options &options)
+    : m_scheduler(scheduler),
+      m_clock(clock),
+      m_window(options.window),
+      m_rate_limit(options.rate_limit),
+      m_max_queue_depth(std::max(options.max_queue_depth, 1u)),
+      // Allow up to 10ms worth of data to be sent at once.
+      m_bucket_size(std::max(options.rate_limit / 100, MIN_BUCKET_SIZE)),
+      m_timeout_id(INVALID_TIMEOUT),
+      m_packets_sent(0),
+      m_packets_dropped(0),
+      m_queue_depth_var(NULL),
+      m_sent_var(NULL),
+      m_dropped_var(NULL),
+      m_latency_var(NULL) {
+  m_datagrams.reserve(MAX_BATCH_SIZE);
+  if (options.export_map) {
+    m_queue_depth_var = options.export_map->GetIntegerVar(
+        "tx-pacer-queue-depth");
+    m_sent_var = options.export_map->GetCounterVar("tx-pacer-packets");
+    m_dropped_var = options.export_map->GetCounterVar("tx-pacer-dropped");
+    m_latency_var = options.export_map->GetIntegerVar("tx-pacer-latency-us");
+  }
+}
+
+TransmitPacer::~TransmitPacer() {
+  if (m_timeout_id != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout_id);
+  }
+  STLDeleteValues(&m_queues);
+}
+
+void TransmitPacer::Send(const UDPSocketInterface *socket,
+                         const IPV4Address &iface,
+                         const UDPDatagram *datagrams,
+                         unsigned int count) {
+  if (!count) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  InterfaceQueue *queue = STLFindOrNull(m_queues, iface);
+  if (!queue) {
+    queue = new InterfaceQueue();
+    queue->tokens = m_bucket_size;
+    queue->last_refill = now;
+    m_queues[iface] = queue;
+  }
+  queue->deadline = now + m_window;
+
+  for (unsigned int i = 0; i < count; i++) {
+    if (queue->packets.size() >= m_max_queue_depth) {
+      queue->packets.pop_front();
+      m_packets_dropped++;
+      if (m_dropped_var) {
+        (*m_dropped_var)++;
+      }
+    }
+
+    const UDPDatagram &datagram = datagrams[i];
+    queue->packets.push_back(QueuedPacket());
+    QueuedPacket &packet = queue->packets.back();
+    packet.socket = socket;
+    packet.destination = datagram.address;
+    packet.queued = now;
+    if (datagram.iov) {
+      for (unsigned int j = 0; j < datagram.iov_count; j++) {
+        packet.data.append(
+            reinterpret_cast<const char*>(datagram.iov[j].iov_base),
+            datagram.iov[j].iov_len);
+      }
+    } else {
+      packet.data.assign(
+          reinterpret_cast<const char*>(datagram.buffer.iov_base),
+          datagram.buffer.iov_len);
+    }
+  }
+  UpdateQueueDepth();
+
+  if (m_timeout_id == INVALID_TIMEOUT) {
+    m_timeout_id = m_scheduler->RegisterRepeatingTimeout(
+        TICK, NewCallback(this, &TransmitPacer::Tick));
+  }
+}
+
+void TransmitPacer::Flush(const UDPSocketInterface *socket) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  InterfaceQueues::iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    deque<QueuedPacket> &packets = iter->second->packets;
+    deque<QueuedPacket> flushed, remaining;
+    deque<QueuedPacket>::iterator packet_iter = packets.begin();
+    for (; packet_iter != packets.end(); ++packet_iter) {
+      if (packet_iter->socket == socket) {
+        flushed.push_back(*packet_iter);
+      } else {
+        remaining.push_back(*packet_iter);
+      }
+    }
+    packets.swap(remaining);
+
+    while (!flushed.empty()) {
+      unsigned int count = std::min(
+          static_cast<unsigned int>(flushed.size()), MAX_BATCH_SIZE);
+      SendPackets(flushed, count, now);
+      flushed.erase(flushed.begin(), flushed.begin() + count);
+    }
+  }
+  UpdateQueueDepth();
+}
+
+unsigned int TransmitPacer::QueueDepth() const {
+  unsigned int depth = 0;
+  InterfaceQueues::const_iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    depth += iter->second->packets.size();
+  }
+  return depth;
+}
+
+/*
+ * Called every TICK while there are packets queued.
+ */
+bool TransmitPacer::Tick() {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  bool pending = false;
+  InterfaceQueues::iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    InterfaceQueue *queue = iter->second;
+    if (m_rate_limit) {
+      Refill(queue, now);
+    }
+    if (queue->packets.empty()) {
+      continue;
+    }
+
+    // Spread what's left over the ticks remaining in the window.
+    unsigned int quota = queue->packets.size();
+    if (now < queue->deadline) {
+      unsigned int ticks = 1 + (queue->deadline - now).AsInt() / TICK.AsInt();
+      quota = (quota + ticks - 1) / ticks;
+    }
+    SendFromQueue(queue, quota, now);
+    pending |= !queue->packets.empty();
+  }
+  UpdateQueueDepth();
+
+  if (!pending) {
+    m_timeout_id = INVALID_TIMEOUT;
+  }
+  return pending;
+}
+
+void TransmitPacer::Refill(InterfaceQueue *queue, const TimeStamp &now) {
+  int64_t elapsed = (now - queue->last_refill).AsInt();
+  queue->last_refill = now;
+  queue->tokens = std::min(
+      queue->tokens + static_cast<int64_t>(m_rate_limit) * elapsed / 1000000,
+      m_bucket_size);
+}
+
+void TransmitPacer::SendFromQueue(InterfaceQueue *queue, unsigned int quota,
+                                  const TimeStamp &now) {
+  deque<QueuedPacket> &packets = queue->packets;
+  while (quota && !packets.empty()) {
+    // Find the run of packets for the same socket.
+    const UDPSocketInterface *socket = packets.front().socket;
+    const unsigned int limit = std::min(quota, MAX_BATCH_SIZE);
+    unsigned int count = 0;
+    while (count < limit && count < packets.size() &&
+           packets[count].socket == socket &&
+           (!m_rate_limit || queue->tokens > 0)) {
+      queue->tokens -= packets[count].data.size();
+      count++;
+    }
+
+    if (!count) {
+      // Out of tokens.
+      return;
+    }
+
+    SendPackets(packets, count, now);
+    quota -= count;
+    packets.erase(packets.begin(), packets.begin() + count);
+  }
+}
+
+/*
+ * Send the first count packets, which must all be for the same socket.
+ */
+void TransmitPacer::SendPackets(const deque<QueuedPacket> &packets,
+                                unsigned int count,
+                                const TimeStamp &now) {
+  m_datagrams.resize(count);
+  for (unsigned int i = 0; i < count; i++) {
+    const QueuedPacket &packet = packets[i];
+    UDPDatagram &datagram = m_datagrams[i];
+    datagram.buffer.iov_base = const_cast<char*>(packet.data.data());
+    datagram.buffer.iov_len = packet.data.size();
+    datagram.address = packet.destination;
+  }
+
+  unsigned int sent = packets.front().socket->SendMultiple(&m_datagrams[0],
+                                                           count);
+  if (sent != count) {
+    OLA_INFO << "Only sent " << sent << " of " << count << " paced packets";
+  }
+
+  m_last_latency = now - packets[count - 1].queued;
+  m_packets_sent += sent;
+  if (m_sent_var) {
+    (*m_sent_var) += sent;
+  }
+  if (m_latency_var) {
+    m_latency_var->Set(m_last_latency.AsInt());
+  }
+}
+
+void TransmitPacer::UpdateQueueDepth() {
+  if (m_queue_depth_var) {
+    m_queue_depth_var->Set(QueueDepth());
+  }
+}
+}  // namespace network
+}  // namespace ola
@@ -0,0 +1,396 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TransmitPacerTest.cpp
+ * Test fixture for the TransmitPacer class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Array.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/network/TransmitPacer.h"
+#include "ola/testing/MockUDPSocket.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/SchedulerInterface.h"
+
+using ola::Callback0;
+using ola::ExportMap;
+using ola::SingleUseCallback0;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::TransmitPacer;
+using ola::network::UDPDatagram;
+using ola::testing::MockUDPSocket;
+using ola::testing::SocketVerifier;
+using ola::thread::timeout_id;
+using std::auto_ptr;
+
+/**
+ * A clock that only moves when it's told to.
+ */
+class FakeClock : public ola::Clock {
+ public:
+  FakeClock() {}
+
+  void CurrentMonotonicTime(TimeStamp *timestamp) const { *timestamp = m_now; }
+  void AdvanceTime(const TimeInterval &interval) { m_now += interval; }
+  void AdvanceTime(int32_t sec, int32_t usec) {
+    m_now += TimeInterval(sec, usec);
+  }
+
+ private:
+  TimeStamp m_now;
+};
+
+
+/**
+ * A scheduler that holds a single repeating timeout, which the test runs by
+ * calling Tick().
+ */
+class MockScheduler : public ola::thread::SchedulerInterface {
+ public:
+  MockScheduler() : m_registrations(0) {}
+  ~MockScheduler() {}
+
+  timeout_id RegisterRepeatingTimeout(unsigned int,
+                                      Callback0<bool> *callback) {
+    return Register(callback);
+  }
+
+  timeout_id RegisterRepeatingTimeout(const TimeInterval &,
+                                      Callback0<bool> *callback) {
+    return Register(callback);
+  }
+
+  timeout_id RegisterSingleTimeout(unsigned int,
+                                   SingleUseCallback0<void> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  timeout_id RegisterSingleTimeout(const TimeInterval &,
+                                   SingleUseCallback0<void> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  void RemoveTimeout(timeout_id) {
+    m_callback.reset();
+  }
+
+  bool Pending() const { return m_callback.get() != NULL; }
+  unsigned int Registrations() const { return m_registrations; }
+
+  void Tick() {
+    OLA_ASSERT_TRUE(Pending());
+    if (!m_callback->Run()) {
+      m_callback.reset();
+    }
+  }
+
+ private:
+  auto_ptr<Callback0<bool> > m_callback;
+  unsigned int m_registrations;
+
+  timeout_id Register(Callback0<bool> *callback) {
+    OLA_ASSERT_FALSE(Pending());
+    m_callback.reset(callback);
+    m_registrations++;
+    return this;
+  }
+};
+
+
+class TransmitPacerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TransmitPacerTest);
+  CPPUNIT_TEST(testSend);
+  CPPUNIT_TEST(testWindow);
+  CPPUNIT_TEST(testRateLimit);
+  CPPUNIT_TEST(testInterfaces);
+  CPPUNIT_TEST(testOverflow);
+  CPPUNIT_TEST(testFlush);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    TransmitPacerTest()
+        : m_iface1(IPV4Address::FromStringOrDie("10.0.0.1")),
+          m_iface2(IPV4Address::FromStringOrDie("10.0.1.1")),
+          m_destination(IPV4Address::FromStringOrDie("239.255.0.1"), 5568) {
+      memset(m_data, 0, sizeof(m_data));
+    }
+
+    void testSend();
+    void testWindow();
+    void testRateLimit();
+    void testInterfaces();
+    void testOverflow();
+    void testFlush();
+
+ private:
+    MockScheduler m_scheduler;
+    FakeClock m_clock;
+    MockUDPSocket m_socket;
+    const IPV4Address m_iface1;
+    const IPV4Address m_iface2;
+    const IPV4SocketAddress m_destination;
+    uint8_t m_data[500];
+
+    void Queue(TransmitPacer *pacer, const IPV4Address &iface,
+               unsigned int count, unsigned int size = 100,
+               const MockUDPSocket *socket = NULL) {
+      UDPDatagram datagram;
+      datagram.buffer.iov_base = m_data;
+      datagram.buffer.iov_len = size;
+      datagram.address = m_destination;
+      for (unsigned int i = 0; i < count; i++) {
+        pacer->Send(socket ? socket : &m_socket, iface, &datagram, 1);
+      }
+    }
+
+    void Tick() {
+      m_scheduler.Tick();
+      m_clock.AdvanceTime(TransmitPacer::TICK);
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TransmitPacerTest);
+
+
+/*
+ * Check that packets are sent in order, without a window.
+ */
+void TransmitPacerTest::testSend() {
+  ExportMap export_map;
+  TransmitPacer::Options options;
+  options.export_map = &export_map;
+  TransmitPacer pacer(&m_scheduler, &m_clock, options);
+
+  const uint8_t packet1[] = {1, 2, 3};
+  const uint8_t packet2[] = {4, 5};
+  const uint8_t packet3[] = {6, 7, 8, 9};
+  UDPDatagram datagrams[2];
+  datagrams[0].buffer.iov_base = const_cast<uint8_t*>(packet1);
+  datagrams[0].buffer.iov_len = sizeof(packet1);
+  datagrams[0].address = m_destination;
+  // The second datagram is gathered from blocks.
+  ola::io::IOVec blocks[2];
+  blocks[0].iov_base = const_cast<uint8_t*>(packet2);
+  blocks[0].iov_len = sizeof(packet2);
+  blocks[1].iov_base = const_cast<uint8_t*>(packet3);
+  blocks[1].iov_len = sizeof(packet3);
+  datagrams[1].iov = blocks;
+  datagrams[1].iov_count = 2;
+  datagrams[1].address = m_destination;
+
+  pacer.Send(&m_socket, m_iface1, datagrams, 2);
+  OLA_ASSERT_EQ(2u, pacer.QueueDepth());
+  OLA_ASSERT_EQ(0u, pacer.PacketsSent());
+  OLA_ASSERT_TRUE(m_scheduler.Pending());
+
+  // The data was copied.
+  const uint8_t expected[] = {4, 5, 6, 7, 8, 9};
+  memset(const_cast<uint8_t*>(packet2), 0, sizeof(packet2));
+  memset(const_cast<uint8_t*>(packet3), 0, sizeof(packet3));
+
+  {
+    SocketVerifier verifier(&m_socket);
+    m_socket.AddExpectedData(packet1, sizeof(packet1), m_destination.Host(),
+                             m_destination.Port());
+    m_socket.AddExpectedData(expected, sizeof(expected), m_destination.Host(),
+                             m_destination.Port());
+    m_clock.AdvanceTime(0, 2000);
+    m_scheduler.Tick();
+  }
+
+  OLA_ASSERT_EQ(0u, pacer.QueueDepth());
+  OLA_ASSERT_EQ(2u, pacer.PacketsSent());
+  OLA_ASSERT_EQ(TimeInterval(0, 2000), pacer.LastLatency());
+  OLA_ASSERT_FALSE(m_scheduler.Pending());
+  OLA_ASSERT_EQ(2u, export_map.GetCounterVar("tx-pacer-packets")->Get());
+  OLA_ASSERT_EQ(2000,
+                export_map.GetIntegerVar("tx-pacer-latency-us")->Get());
+  OLA_ASSERT_EQ(0, export_map.GetIntegerVar("tx-pacer-queue-depth")->Get());
+}
+
+
+/*
+ * Check that packets are spread over the window.
+ */
+void TransmitPacerTest::testWindow() {
+  TransmitPacer::Options options;
+  options.window = TimeInterval(0, 10000);
+  TransmitPacer pacer(&m_scheduler, &m_clock, options);
+  m_socket.SetDiscardMode(true);
+
+  Queue(&pacer, m_iface1, 22);
+  OLA_ASSERT_EQ(22u, pacer.QueueDepth());
+
+  // There are 11 ticks left in the window, so 2 packets are sent each tick.
+  for (unsigned int i = 1; i <= 11; i++) {
+    Tick();
+    OLA_ASSERT_EQ(2 * i, pacer.PacketsSent());
+  }
+  OLA_ASSERT_EQ(0u, pacer.QueueDepth());
+  OLA_ASSERT_FALSE(m_scheduler.Pending());
+
+  // A new frame, 5 ms into which another frame arrives.
+  Queue(&pacer, m_iface1, 11);
+  for (unsigned int i = 0; i < 5; i++) {
+    Tick();
+  }
+  OLA_ASSERT_EQ(27u, pacer.PacketsSent());
+  OLA_ASSERT_EQ(6u, pacer.QueueDepth());
+  Queue(&pacer, m_iface1, 16);
+  Tick();
+  OLA_ASSERT_EQ(29u, pacer.PacketsSent());
+
+  // If the window is missed, everything is sent.
+  m_clock.AdvanceTime(0, 20000);
+  m_scheduler.Tick();
+  OLA_ASSERT_EQ(0u, pacer.QueueDepth());
+  OLA_ASSERT_EQ(49u, pacer.PacketsSent());
+  OLA_ASSERT_EQ(2u, m_scheduler.Registrations());
+}
+
+
+/*
+ * Check the rate limit.
+ */
+void TransmitPacerTest::testRateLimit() {
+  TransmitPacer::Options options;
+  // 200 bytes per ms, the bucket holds 2000 bytes.
+  options.rate_limit = 200000;
+  TransmitPacer pacer(&m_scheduler, &m_clock, options);
+  m_socket.SetDiscardMode(true);
+
+  Queue(&pacer, m_iface1, 10, 400);
+
+  // The bucket starts full, and a packet is sent as long as there are some
+  // tokens left.
+  const unsigned int expected[] = {5, 6, 6, 7, 7, 8, 8, 9, 9, 10};
+  for (unsigned int i = 0; i < arraysize(expected); i++) {
+    Tick();
+    OLA_ASSERT_EQ(expected[i], pacer.PacketsSent());
+  }
+  OLA_ASSERT_FALSE(m_scheduler.Pending());
+
+  // After a pause the bucket is full again, but doesn't overflow.
+  m_clock.AdvanceTime(1, 0);
+  Queue(&pacer, m_iface1, 10, 400);
+  Tick();
+  OLA_ASSERT_EQ(15u, pacer.PacketsSent());
+}
+
+
+/*
+ * Check that each interface is paced on its own.
+ */
+void TransmitPacerTest::testInterfaces() {
+  TransmitPacer::Options options;
+  options.window = TimeInterval(0, 1000);
+  TransmitPacer pacer(&m_scheduler, &m_clock, options);
+  m_socket.SetDiscardMode(true);
+  MockUDPSocket socket2;
+  socket2.SetDiscardMode(true);
+
+  Queue(&pacer, m_iface1, 4);
+  Queue(&pacer, m_iface2, 8, 100, &socket2);
+  OLA_ASSERT_EQ(12u, pacer.QueueDepth());
+
+  Tick();
+  OLA_ASSERT_EQ(6u, pacer.PacketsSent());
+  Tick();
+  OLA_ASSERT_EQ(12u, pacer.PacketsSent());
+  OLA_ASSERT_FALSE(m_scheduler.Pending());
+}
+
+
+/*
+ * Check that the oldest packets are dropped once a queue is full.
+ */
+void TransmitPacerTest::testOverflow() {
+  ExportMap export_map;
+  TransmitPacer::Options options;
+  options.max_queue_depth = 2;
+  options.export_map = &export_map;
+  TransmitPacer pacer(&m_scheduler, &m_clock, options);
+
+  UDPDatagram datagrams[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    m_data[i] = i;
+    datagrams[i].buffer.iov_base = m_data + i;
+    datagrams[i].buffer.iov_len = 1;
+    datagrams[i].address = m_destination;
+  }
+  pacer.Send(&m_socket, m_iface1, datagrams, 3);
+  OLA_ASSERT_EQ(2u, pacer.QueueDepth());
+  OLA_ASSERT_EQ(1u, pacer.PacketsDropped());
+  OLA_ASSERT_EQ(1u, export_map.GetCounterVar("tx-pacer-dropped")->Get());
+  OLA_ASSERT_EQ(2, export_map.GetIntegerVar("tx-pacer-queue-depth")->Get());
+
+  SocketVerifier verifier(&m_socket);
+  const uint8_t expected1[] = {1};
+  const uint8_t expected2[] = {2};
+  m_socket.AddExpectedData(expected1, sizeof(expected1), m_destination.Host(),
+                           m_destination.Port());
+  m_socket.AddExpectedData(expected2, sizeof(expected2), m_destination.Host(),
+                           m_destination.Port());
+  Tick();
+}
+
+
+/*
+ * Check that Flush() sends the packets for a socket.
+ */
+void TransmitPacerTest::testFlush() {
+  TransmitPacer::Options options;
+  TransmitPacer pacer(&m_scheduler, &m_clock, options);
+  m_socket.SetDiscardMode(true);
+
+  {
+    MockUDPSocket socket2;
+    socket2.SetDiscardMode(true);
+    Queue(&pacer, m_iface1, 2);
+    Queue(&pacer, m_iface1, 3, 100, &socket2);
+    Queue(&pacer, m_iface1, 2);
+    OLA_ASSERT_EQ(7u, pacer.QueueDepth());
+    pacer.Flush(&socket2);
+    OLA_ASSERT_EQ(3u, pacer.PacketsSent());
+  }
+  OLA_ASSERT_EQ(4u, pacer.QueueDepth());
+
+  Tick();
+  OLA_ASSERT_EQ(7u, pacer.PacketsSent());
+  OLA_ASSERT_FALSE(m_scheduler.Pending());
+
+  // Once everything is flushed the timer stops on the next tick.
+  Queue(&pacer, m_iface1, 2);
+  pacer.Flush(&m_socket);
+  OLA_ASSERT_EQ(9u, pacer.PacketsSent());
+  Tick();
+  OLA_ASSERT_FALSE(m_scheduler.Pending());
+}
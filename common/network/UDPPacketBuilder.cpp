@@ -0,0 +1,66 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UDPPacketBuilder.cpp
+ * Builds a UDP packet from blocks of memory, without copying them.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "ola/Logging.h"
+#include "ola/network/UDPPacketBuilder.h"
+
+namespace ola {
+namespace network {
+
+namespace {
+const uint8_t ZEROS[UDPPacketBuilder::MAX_PADDING] = {0};
+}  // namespace
+
+bool UDPPacketBuilder::Append(const void *data, unsigned int length) {
+  if (!length) {
+    return true;
+  }
+  if (m_block_count == MAX_BLOCKS) {
+    OLA_WARN << "UDP packet has too many blocks";
+    return false;
+  }
+  m_blocks[m_block_count].iov_base = const_cast<void*>(data);
+  m_blocks[m_block_count].iov_len = length;
+  m_block_count++;
+  m_size += length;
+  return true;
+}
+
+
+bool UDPPacketBuilder::AppendPadding(unsigned int length) {
+  if (length > MAX_PADDING) {
+    OLA_WARN << "UDP packet padding of " << length << " is too large";
+    return false;
+  }
+  return Append(ZEROS, length);
+}
+
+
+bool UDPPacketBuilder::SendTo(const UDPSocketInterface *socket,
+                              const IPV4SocketAddress &destination) const {
+  ssize_t bytes_sent = socket->SendTo(m_blocks, m_block_count, destination);
+  if (bytes_sent != static_cast<ssize_t>(m_size)) {
+    OLA_INFO << "Only sent " << bytes_sent << " of " << m_size;
+    return false;
+  }
+  return true;
+}
+}  // namespace network
+}  // namespace ola
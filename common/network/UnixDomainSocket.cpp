@@ -0,0 +1,322 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UnixDomainSocket.cpp
+ * Implementation of the unix domain socket classes
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif  // !_WIN32
+
+#include <string>
+
+#include "ola/Logging.h"
+#include "ola/io/Descriptor.h"
+#include "ola/network/SocketCloser.h"
+#include "ola/network/TCPSocketFactory.h"
+#include "ola/network/UnixDomainSocket.h"
+
+namespace ola {
+namespace network {
+
+using std::string;
+
+#ifndef _WIN32
+namespace {
+
+bool IsAbstract(const string &path) {
+  return !path.empty() && path[0] == '@';
+}
+
+/*
+ * Fill in a sockaddr_un for the path.
+ */
+bool PathToSockAddr(const string &path, struct sockaddr_un *address,
+                    socklen_t *length) {
+  if (path.empty() || path.size() >= sizeof(address->sun_path)) {
+    OLA_WARN << "Invalid unix domain socket path: " << path;
+    return false;
+  }
+
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  memcpy(address->sun_path, path.data(), path.size());
+  if (IsAbstract(path)) {
+    // Abstract names aren't NULL terminated, the length defines the name.
+    address->sun_path[0] = 0;
+    *length = offsetof(struct sockaddr_un, sun_path) + path.size();
+  } else {
+    *length = offsetof(struct sockaddr_un, sun_path) + path.size() + 1;
+  }
+  return true;
+}
+
+/*
+ * Create a socket and connect it to path.
+ * @returns the socket descriptor, or -1 if the connect failed.
+ */
+int ConnectToPath(const string &path, bool log_errors) {
+  struct sockaddr_un address;
+  socklen_t length;
+  if (!PathToSockAddr(path, &address, &length)) {
+    return -1;
+  }
+
+  int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sd < 0) {
+    OLA_WARN << "socket() failed, " << strerror(errno);
+    return -1;
+  }
+
+  SocketCloser closer(sd);
+  if (connect(sd, reinterpret_cast<struct sockaddr*>(&address), length)) {
+    if (log_errors) {
+      OLA_WARN << "connect(" << path << "): " << strerror(errno);
+    }
+    return -1;
+  }
+  return closer.Release();
+}
+}  // namespace
+#endif  // !_WIN32
+
+
+// UnixDomainSocket
+// ------------------------------------------------
+
+UnixDomainSocket::UnixDomainSocket(int sd) {
+#ifdef _WIN32
+  m_handle.m_handle.m_fd = sd;
+  m_handle.m_type = ola::io::SOCKET_DESCRIPTOR;
+#else
+  m_handle = sd;
+#endif  // _WIN32
+  SetNoSigPipe(m_handle);
+}
+
+/*
+ * Close this UnixDomainSocket
+ */
+bool UnixDomainSocket::Close() {
+#ifndef _WIN32
+  if (m_handle != ola::io::INVALID_DESCRIPTOR) {
+    close(m_handle);
+    m_handle = ola::io::INVALID_DESCRIPTOR;
+  }
+#endif  // !_WIN32
+  return true;
+}
+
+/*
+ * Get the uid & gid of the peer.
+ * @returns false if the credentials couldn't be determined.
+ */
+bool UnixDomainSocket::GetPeerCredentials(uid_t *uid, gid_t *gid) const {
+#if defined(SO_PEERCRED)
+  struct ucred credentials;
+  socklen_t length = sizeof(credentials);
+  if (getsockopt(m_handle, SOL_SOCKET, SO_PEERCRED, &credentials, &length)) {
+    OLA_WARN << "getsockopt(SO_PEERCRED) failed, " << strerror(errno);
+    return false;
+  }
+  *uid = credentials.uid;
+  *gid = credentials.gid;
+  return true;
+#elif defined(HAVE_GETPEEREID)
+  if (getpeereid(m_handle, uid, gid)) {
+    OLA_WARN << "getpeereid() failed, " << strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  OLA_WARN << "Peer credentials aren't supported on this platform";
+  (void) uid;
+  (void) gid;
+  return false;
+#endif  // SO_PEERCRED
+}
+
+/*
+ * Connect to the unix domain socket at path.
+ * @returns a new UnixDomainSocket or NULL if the connect failed.
+ */
+UnixDomainSocket* UnixDomainSocket::Connect(const string &path) {
+#ifdef _WIN32
+  OLA_WARN << "Unix domain sockets aren't supported on Windows";
+  (void) path;
+  return NULL;
+#else
+  int sd = ConnectToPath(path, true);
+  if (sd < 0) {
+    return NULL;
+  }
+  UnixDomainSocket *socket = new UnixDomainSocket(sd);
+  socket->SetReadNonBlocking();
+  return socket;
+#endif  // _WIN32
+}
+
+
+// UnixDomainAcceptingSocket
+// ------------------------------------------------
+
+UnixDomainAcceptingSocket::UnixDomainAcceptingSocket(
+    TCPSocketFactoryInterface *factory)
+    : ReadFileDescriptor(),
+      m_handle(ola::io::INVALID_DESCRIPTOR),
+      m_factory(factory) {
+}
+
+UnixDomainAcceptingSocket::~UnixDomainAcceptingSocket() {
+  Close();
+}
+
+/*
+ * Start listening
+ * @param path the path to listen on. If a socket already exists at path, and
+ *   nothing is listening on it, it's removed.
+ * @param backlog the backlog
+ * @return true if it succeeded, false otherwise
+ */
+bool UnixDomainAcceptingSocket::Listen(const string &path, int backlog) {
+#ifdef _WIN32
+  OLA_WARN << "Unix domain sockets aren't supported on Windows";
+  (void) path;
+  (void) backlog;
+  return false;
+#else
+  if (m_handle != ola::io::INVALID_DESCRIPTOR)
+    return false;
+
+  struct sockaddr_un address;
+  socklen_t length;
+  if (!PathToSockAddr(path, &address, &length)) {
+    return false;
+  }
+
+  if (!IsAbstract(path)) {
+    // Remove a stale socket left behind by a process that exited, but not
+    // one that's still in use.
+    int sd = ConnectToPath(path, false);
+    if (sd >= 0) {
+      close(sd);
+      OLA_WARN << path << " is already in use";
+      return false;
+    }
+    if (unlink(path.c_str()) && errno != ENOENT) {
+      OLA_WARN << "Failed to remove " << path << ", " << strerror(errno);
+      return false;
+    }
+  }
+
+  int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sd < 0) {
+    OLA_WARN << "socket() failed: " << strerror(errno);
+    return false;
+  }
+
+  SocketCloser closer(sd);
+
+  if (!ola::io::ConnectedDescriptor::SetNonBlocking(sd)) {
+    OLA_WARN << "Failed to mark unix accept socket as non-blocking";
+    return false;
+  }
+
+  if (bind(sd, reinterpret_cast<struct sockaddr*>(&address), length) == -1) {
+    OLA_WARN << "bind to " << path << " failed, " << strerror(errno);
+    return false;
+  }
+
+  if (listen(sd, backlog)) {
+    OLA_WARN << "listen on " << path << " failed, " << strerror(errno);
+    if (!IsAbstract(path)) {
+      unlink(path.c_str());
+    }
+    return false;
+  }
+  m_handle = closer.Release();
+  m_path = path;
+  return true;
+#endif  // _WIN32
+}
+
+/*
+ * Stop listening, close this socket and remove the path.
+ * @return true if close succeeded, false otherwise
+ */
+bool UnixDomainAcceptingSocket::Close() {
+  bool ret = true;
+#ifndef _WIN32
+  if (m_handle != ola::io::INVALID_DESCRIPTOR) {
+    if (close(m_handle)) {
+      OLA_WARN << "close() failed " << strerror(errno);
+      ret = false;
+    }
+    if (!IsAbstract(m_path)) {
+      unlink(m_path.c_str());
+    }
+  }
+#endif  // !_WIN32
+  m_handle = ola::io::INVALID_DESCRIPTOR;
+  m_path.clear();
+  return ret;
+}
+
+/*
+ * Accept new connections
+ */
+void UnixDomainAcceptingSocket::PerformRead() {
+#ifndef _WIN32
+  if (m_handle == ola::io::INVALID_DESCRIPTOR)
+    return;
+
+  while (1) {
+    int sd = accept(m_handle, NULL, NULL);
+    if (sd < 0) {
+      if (errno == EWOULDBLOCK) {
+        return;
+      }
+
+      OLA_WARN << "accept() failed, " << strerror(errno);
+      return;
+    }
+
+    if (m_factory) {
+      // The callback takes ownership of the new socket descriptor
+      // coverity[RESOURCE_LEAK]
+      m_factory->NewTCPSocket(sd);
+    } else {
+      OLA_WARN << "Accepted new unix domain connection but no factory "
+               << "registered";
+      close(sd);
+    }
+  }
+#endif  // !_WIN32
+}
+}  // namespace network
+}  // namespace ola
@@ -0,0 +1,377 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CachingRDMAPIImpl.cpp
+ * An RDMAPIImplInterface that caches responses for static parameters.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/rdm/CachingRDMAPIImpl.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace rdm {
+
+using std::string;
+using std::vector;
+
+const TimeInterval CachingRDMAPIImpl::STATIC_PARAMETER_TTL(600, 0);
+const TimeInterval CachingRDMAPIImpl::SETTABLE_PARAMETER_TTL(10, 0);
+const unsigned int CachingRDMAPIImpl::MAX_ENTRIES = 10000;
+
+CachingRDMAPIImpl::RequestKey::RequestKey(unsigned int universe,
+                                          const UID &uid,
+                                          uint16_t sub_device,
+                                          uint16_t pid,
+                                          const uint8_t *data,
+                                          unsigned int data_length)
+    : universe(universe),
+      uid(uid),
+      sub_device(sub_device),
+      pid(pid) {
+  if (data && data_length) {
+    this->data.assign(reinterpret_cast<const char*>(data), data_length);
+  }
+}
+
+bool CachingRDMAPIImpl::RequestKey::operator<(const RequestKey &other) const {
+  if (universe != other.universe) {
+    return universe < other.universe;
+  }
+  if (uid != other.uid) {
+    return uid < other.uid;
+  }
+  if (pid != other.pid) {
+    return pid < other.pid;
+  }
+  if (sub_device != other.sub_device) {
+    return sub_device < other.sub_device;
+  }
+  return data < other.data;
+}
+
+void CachingRDMAPIImpl::Waiter::Run(const ResponseStatus &status,
+                                    uint16_t pid,
+                                    const string &data) const {
+  if (callback) {
+    callback->Run(status, data);
+  } else {
+    pid_callback->Run(status, pid, data);
+  }
+}
+
+void CachingRDMAPIImpl::Waiter::Delete() const {
+  delete callback;
+  delete pid_callback;
+}
+
+CachingRDMAPIImpl::CachingRDMAPIImpl(RDMAPIImplInterface *impl,
+                                     ola::thread::ExecutorInterface *executor,
+                                     Clock *clock)
+    : m_impl(impl),
+      m_executor(executor),
+      m_clock(clock),
+      m_hits(0),
+      m_misses(0),
+      m_coalesced(0) {
+  if (!m_clock) {
+    m_our_clock.reset(new Clock());
+    m_clock = m_our_clock.get();
+  }
+
+  const uint16_t static_pids[] = {
+    PID_CURVE_DESCRIPTION,
+    PID_DEFAULT_SLOT_VALUE,
+    PID_DEVICE_MODEL_DESCRIPTION,
+    PID_DMX_PERSONALITY_DESCRIPTION,
+    PID_LANGUAGE_CAPABILITIES,
+    PID_MANUFACTURER_LABEL,
+    PID_MODULATION_FREQUENCY_DESCRIPTION,
+    PID_OUTPUT_RESPONSE_TIME_DESCRIPTION,
+    PID_PARAMETER_DESCRIPTION,
+    PID_PRODUCT_DETAIL_ID_LIST,
+    PID_SELF_TEST_DESCRIPTION,
+    PID_SENSOR_DEFINITION,
+    PID_SLOT_DESCRIPTION,
+    PID_SLOT_INFO,
+    PID_SOFTWARE_VERSION_LABEL,
+    PID_STATUS_ID_DESCRIPTION,
+    PID_SUPPORTED_PARAMETERS,
+    PID_BOOT_SOFTWARE_VERSION_ID,
+    PID_BOOT_SOFTWARE_VERSION_LABEL,
+  };
+  for (unsigned int i = 0; i < arraysize(static_pids); i++) {
+    m_ttls[static_pids[i]] = STATIC_PARAMETER_TTL;
+  }
+
+  // DEVICE_INFO includes the start address and personality, which can be
+  // changed by other controllers.
+  const uint16_t settable_pids[] = {
+    PID_DEVICE_INFO,
+    PID_DEVICE_LABEL,
+    PID_DIMMER_INFO,
+    PID_DMX_PERSONALITY,
+  };
+  for (unsigned int i = 0; i < arraysize(settable_pids); i++) {
+    m_ttls[settable_pids[i]] = SETTABLE_PARAMETER_TTL;
+  }
+}
+
+CachingRDMAPIImpl::~CachingRDMAPIImpl() {
+  PendingMap::iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    vector<Waiter>::const_iterator waiter = iter->second->waiters.begin();
+    for (; waiter != iter->second->waiters.end(); ++waiter) {
+      waiter->Delete();
+    }
+  }
+  STLDeleteValues(&m_pending);
+}
+
+bool CachingRDMAPIImpl::RDMGet(rdm_callback *callback,
+                               unsigned int universe,
+                               const UID &uid,
+                               uint16_t sub_device,
+                               uint16_t pid,
+                               const uint8_t *data,
+                               unsigned int data_length) {
+  Waiter waiter;
+  waiter.callback = callback;
+  return Get(waiter, universe, uid, sub_device, pid, data, data_length);
+}
+
+bool CachingRDMAPIImpl::RDMGet(rdm_pid_callback *callback,
+                               unsigned int universe,
+                               const UID &uid,
+                               uint16_t sub_device,
+                               uint16_t pid,
+                               const uint8_t *data,
+                               unsigned int data_length) {
+  Waiter waiter;
+  waiter.pid_callback = callback;
+  return Get(waiter, universe, uid, sub_device, pid, data, data_length);
+}
+
+bool CachingRDMAPIImpl::RDMSet(rdm_callback *callback,
+                               unsigned int universe,
+                               const UID &uid,
+                               uint16_t sub_device,
+                               uint16_t pid,
+                               const uint8_t *data,
+                               unsigned int data_length) {
+  if (uid.IsBroadcast()) {
+    Invalidate(universe);
+  } else {
+    Invalidate(universe, uid);
+  }
+  return m_impl->RDMSet(
+      NewSingleCallback(this, &CachingRDMAPIImpl::HandleResponse, universe,
+                        uid, callback),
+      universe, uid, sub_device, pid, data, data_length);
+}
+
+void CachingRDMAPIImpl::SetTTL(uint16_t pid, const TimeInterval &ttl) {
+  if (ttl == TimeInterval()) {
+    m_ttls.erase(pid);
+  } else {
+    m_ttls[pid] = ttl;
+  }
+}
+
+void CachingRDMAPIImpl::Invalidate(unsigned int universe, const UID &uid) {
+  InvalidateIf(&universe, &uid);
+}
+
+void CachingRDMAPIImpl::Invalidate(unsigned int universe) {
+  InvalidateIf(&universe, NULL);
+}
+
+void CachingRDMAPIImpl::InvalidateAll() {
+  InvalidateIf(NULL, NULL);
+}
+
+bool CachingRDMAPIImpl::Get(const Waiter &waiter,
+                            unsigned int universe,
+                            const UID &uid,
+                            uint16_t sub_device,
+                            uint16_t pid,
+                            const uint8_t *data,
+                            unsigned int data_length) {
+  if (pid == PID_QUEUED_MESSAGE || pid == PID_STATUS_MESSAGES) {
+    // Something on the device has changed.
+    Invalidate(universe, uid);
+  }
+
+  if (uid.IsBroadcast() || !STLContains(m_ttls, pid)) {
+    if (waiter.callback) {
+      return m_impl->RDMGet(
+          NewSingleCallback(this, &CachingRDMAPIImpl::HandleResponse,
+                            universe, uid, waiter.callback),
+          universe, uid, sub_device, pid, data, data_length);
+    } else {
+      return m_impl->RDMGet(
+          NewSingleCallback(this, &CachingRDMAPIImpl::HandleResponseWithPid,
+                            universe, uid, waiter.pid_callback),
+          universe, uid, sub_device, pid, data, data_length);
+    }
+  }
+
+  const RequestKey key(universe, uid, sub_device, pid, data, data_length);
+  Cache::iterator cache_iter = m_cache.find(key);
+  if (cache_iter != m_cache.end()) {
+    TimeStamp now;
+    m_clock->CurrentCoarseMonotonicTime(&now);
+    if (now < cache_iter->second.expiry) {
+      m_hits++;
+      m_executor->Execute(NewSingleCallback(
+          &CachingRDMAPIImpl::RunCachedResponse, waiter,
+          cache_iter->second.status, pid, cache_iter->second.data));
+      return true;
+    }
+    m_cache.erase(cache_iter);
+  }
+
+  PendingRequest *pending = STLFindOrNull(m_pending, key);
+  if (pending) {
+    m_coalesced++;
+    pending->waiters.push_back(waiter);
+    return true;
+  }
+
+  m_misses++;
+  pending = new PendingRequest();
+  pending->waiters.push_back(waiter);
+  STLReplace(&m_pending, key, pending);
+  bool ok = m_impl->RDMGet(
+      NewSingleCallback(this, &CachingRDMAPIImpl::HandleGetResponse, key),
+      universe, uid, sub_device, pid, data, data_length);
+  if (!ok) {
+    // The callback is owned by us, same as if it had been passed to m_impl.
+    waiter.Delete();
+    STLRemoveAndDelete(&m_pending, key);
+  }
+  return ok;
+}
+
+void CachingRDMAPIImpl::HandleGetResponse(RequestKey key,
+                                          const ResponseStatus &status,
+                                          uint16_t pid,
+                                          const string &data) {
+  PendingRequest *pending = STLFindOrNull(m_pending, key);
+  if (!pending) {
+    OLA_WARN << "Missing pending request for PID 0x" << std::hex << key.pid;
+    return;
+  }
+  m_pending.erase(key);
+
+  if (status.message_count) {
+    Invalidate(key.universe, key.uid);
+  } else if (status.WasAcked() && pid == key.pid && !pending->invalidated) {
+    Store(key, status, data);
+  }
+
+  vector<Waiter>::const_iterator iter = pending->waiters.begin();
+  for (; iter != pending->waiters.end(); ++iter) {
+    iter->Run(status, pid, data);
+  }
+  delete pending;
+}
+
+void CachingRDMAPIImpl::HandleResponse(unsigned int universe,
+                                       UID uid,
+                                       rdm_callback *callback,
+                                       const ResponseStatus &status,
+                                       const string &data) {
+  if (status.message_count) {
+    Invalidate(universe, uid);
+  }
+  callback->Run(status, data);
+}
+
+void CachingRDMAPIImpl::HandleResponseWithPid(unsigned int universe,
+                                              UID uid,
+                                              rdm_pid_callback *callback,
+                                              const ResponseStatus &status,
+                                              uint16_t pid,
+                                              const string &data) {
+  if (status.message_count) {
+    Invalidate(universe, uid);
+  }
+  callback->Run(status, pid, data);
+}
+
+void CachingRDMAPIImpl::InvalidateIf(const unsigned int *universe,
+                                     const UID *uid) {
+  Cache::iterator iter = m_cache.begin();
+  while (iter != m_cache.end()) {
+    if ((!universe || iter->first.universe == *universe) &&
+        (!uid || iter->first.uid == *uid)) {
+      m_cache.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+
+  PendingMap::iterator pending_iter = m_pending.begin();
+  for (; pending_iter != m_pending.end(); ++pending_iter) {
+    if ((!universe || pending_iter->first.universe == *universe) &&
+        (!uid || pending_iter->first.uid == *uid)) {
+      pending_iter->second->invalidated = true;
+    }
+  }
+}
+
+void CachingRDMAPIImpl::Store(const RequestKey &key,
+                              const ResponseStatus &status,
+                              const string &data) {
+  TimeStamp now;
+  m_clock->CurrentCoarseMonotonicTime(&now);
+  if (m_cache.size() >= MAX_ENTRIES) {
+    Cache::iterator iter = m_cache.begin();
+    while (iter != m_cache.end()) {
+      if (iter->second.expiry <= now) {
+        m_cache.erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+    if (m_cache.size() >= MAX_ENTRIES) {
+      OLA_INFO << "RDM response cache is full, flushing it";
+      m_cache.clear();
+    }
+  }
+
+  CacheEntry &entry = m_cache[key];
+  entry.status = status;
+  entry.data = data;
+  entry.expiry = now + m_ttls[key.pid];
+}
+
+void CachingRDMAPIImpl::RunCachedResponse(Waiter waiter,
+                                          ResponseStatus status,
+                                          uint16_t pid,
+                                          string data) {
+  waiter.Run(status, pid, data);
+}
+}  // namespace rdm
+}  // namespace ola
@@ -0,0 +1,384 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CachingRDMAPIImplTest.cpp
+ * Test fixture for the CachingRDMAPIImpl class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/rdm/CachingRDMAPIImpl.h"
+#include "ola/rdm/RDMAPIImplInterface.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/ExecutorInterface.h"
+
+using ola::MockClock;
+using ola::NewSingleCallback;
+using ola::rdm::CachingRDMAPIImpl;
+using ola::rdm::RDMAPIImplInterface;
+using ola::rdm::ResponseStatus;
+using ola::rdm::UID;
+using std::deque;
+using std::string;
+using std::vector;
+
+/**
+ * Records requests so the test can respond to them later.
+ */
+class DeferredRDMAPIImpl: public RDMAPIImplInterface {
+ public:
+  struct Request {
+    bool is_set;
+    UID uid;
+    uint16_t pid;
+    rdm_callback *callback;
+    rdm_pid_callback *pid_callback;
+  };
+
+  DeferredRDMAPIImpl() : m_fail(false) {}
+  ~DeferredRDMAPIImpl() {
+    deque<Request>::iterator iter = m_requests.begin();
+    for (; iter != m_requests.end(); ++iter) {
+      delete iter->callback;
+      delete iter->pid_callback;
+    }
+  }
+
+  bool RDMGet(rdm_callback *callback,
+              unsigned int,
+              const UID &uid,
+              uint16_t,
+              uint16_t pid,
+              const uint8_t*,
+              unsigned int) {
+    return Add(false, uid, pid, callback, NULL);
+  }
+
+  bool RDMGet(rdm_pid_callback *callback,
+              unsigned int,
+              const UID &uid,
+              uint16_t,
+              uint16_t pid,
+              const uint8_t*,
+              unsigned int) {
+    return Add(false, uid, pid, NULL, callback);
+  }
+
+  bool RDMSet(rdm_callback *callback,
+              unsigned int,
+              const UID &uid,
+              uint16_t,
+              uint16_t pid,
+              const uint8_t*,
+              unsigned int) {
+    return Add(true, uid, pid, callback, NULL);
+  }
+
+  unsigned int Outstanding() const { return m_requests.size(); }
+  void SetFail(bool fail) { m_fail = fail; }
+
+  // Respond to the oldest request.
+  void Respond(uint8_t response_type, const string &data,
+               uint8_t message_count = 0) {
+    Request request = m_requests.front();
+    m_requests.pop_front();
+    ResponseStatus status;
+    status.response_code = ola::rdm::RDM_COMPLETED_OK;
+    status.response_type = response_type;
+    status.message_count = message_count;
+    status.m_param = 0;
+    status.set_command = request.is_set;
+    status.pid_value = request.pid;
+    if (request.callback) {
+      request.callback->Run(status, data);
+    } else {
+      request.pid_callback->Run(status, request.pid, data);
+    }
+  }
+
+ private:
+  deque<Request> m_requests;
+  bool m_fail;
+
+  bool Add(bool is_set, const UID &uid, uint16_t pid,
+           rdm_callback *callback, rdm_pid_callback *pid_callback) {
+    if (m_fail) {
+      delete callback;
+      delete pid_callback;
+      return false;
+    }
+    Request request = {is_set, uid, pid, callback, pid_callback};
+    m_requests.push_back(request);
+    return true;
+  }
+};
+
+
+class MockExecutor: public ola::thread::ExecutorInterface {
+ public:
+  ~MockExecutor() { DrainCallbacks(); }
+
+  void Execute(ola::BaseCallback0<void> *callback) {
+    m_callbacks.push_back(callback);
+  }
+
+  void DrainCallbacks() {
+    while (!m_callbacks.empty()) {
+      ola::BaseCallback0<void> *callback = m_callbacks.front();
+      m_callbacks.pop_front();
+      callback->Run();
+    }
+  }
+
+  unsigned int Pending() const { return m_callbacks.size(); }
+
+ private:
+  deque<ola::BaseCallback0<void>*> m_callbacks;
+};
+
+
+class CachingRDMAPIImplTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(CachingRDMAPIImplTest);
+  CPPUNIT_TEST(testCacheHit);
+  CPPUNIT_TEST(testCoalescing);
+  CPPUNIT_TEST(testExpiry);
+  CPPUNIT_TEST(testInvalidation);
+  CPPUNIT_TEST(testUncachedResponses);
+  CPPUNIT_TEST(testPassThrough);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  CachingRDMAPIImplTest()
+      : m_uid(0x7a70, 1),
+        m_other_uid(0x7a70, 2) {
+  }
+
+  void setUp() {
+    m_responses.clear();
+    m_cache.reset(new CachingRDMAPIImpl(&m_impl, &m_executor, &m_clock));
+  }
+
+  void tearDown() {
+    m_executor.DrainCallbacks();
+    m_cache.reset();
+  }
+
+  void testCacheHit();
+  void testCoalescing();
+  void testExpiry();
+  void testInvalidation();
+  void testUncachedResponses();
+  void testPassThrough();
+
+ private:
+  DeferredRDMAPIImpl m_impl;
+  MockExecutor m_executor;
+  MockClock m_clock;
+  std::auto_ptr<CachingRDMAPIImpl> m_cache;
+  const UID m_uid;
+  const UID m_other_uid;
+  vector<string> m_responses;
+
+  bool Get(const UID &uid, uint16_t pid) {
+    return m_cache->RDMGet(
+        NewSingleCallback(this, &CachingRDMAPIImplTest::HandleResponse),
+        1, uid, ola::rdm::ROOT_RDM_DEVICE, pid);
+  }
+
+  bool GetWithPid(const UID &uid, uint16_t pid) {
+    return m_cache->RDMGet(
+        NewSingleCallback(this, &CachingRDMAPIImplTest::HandlePidResponse,
+                          pid),
+        1, uid, ola::rdm::ROOT_RDM_DEVICE, pid);
+  }
+
+  void HandleResponse(const ResponseStatus &, const string &data) {
+    m_responses.push_back(data);
+  }
+
+  void HandlePidResponse(uint16_t expected_pid,
+                         const ResponseStatus &,
+                         uint16_t pid,
+                         const string &data) {
+    OLA_ASSERT_EQ(expected_pid, pid);
+    m_responses.push_back(data);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CachingRDMAPIImplTest);
+
+
+/*
+ * Check that a second GET for a static PID is answered from the cache.
+ */
+void CachingRDMAPIImplTest::testCacheHit() {
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK, "Open Lighting");
+  OLA_ASSERT_EQ((size_t) 1, m_responses.size());
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+
+  OLA_ASSERT_TRUE(GetWithPid(m_uid, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_EQ(0u, m_impl.Outstanding());
+  // The response isn't delivered from within RDMGet.
+  OLA_ASSERT_EQ((size_t) 1, m_responses.size());
+  m_executor.DrainCallbacks();
+  OLA_ASSERT_EQ((size_t) 2, m_responses.size());
+  OLA_ASSERT_EQ(string("Open Lighting"), m_responses[1]);
+  OLA_ASSERT_EQ(1u, m_cache->Hits());
+  OLA_ASSERT_EQ(1u, m_cache->Misses());
+
+  // Other UIDs are separate.
+  OLA_ASSERT_TRUE(Get(m_other_uid, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK, "Other");
+  OLA_ASSERT_EQ(2u, m_cache->Size());
+}
+
+/*
+ * Check that concurrent GETs share a single request.
+ */
+void CachingRDMAPIImplTest::testCoalescing() {
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_SUPPORTED_PARAMETERS));
+  OLA_ASSERT_TRUE(GetWithPid(m_uid, ola::rdm::PID_SUPPORTED_PARAMETERS));
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_SUPPORTED_PARAMETERS));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  OLA_ASSERT_EQ(2u, m_cache->Coalesced());
+
+  m_impl.Respond(ola::rdm::RDM_ACK, "pids");
+  OLA_ASSERT_EQ((size_t) 3, m_responses.size());
+  OLA_ASSERT_EQ(0u, m_executor.Pending());
+
+  // A failed send leaves nothing behind.
+  m_impl.SetFail(true);
+  OLA_ASSERT_FALSE(Get(m_uid, ola::rdm::PID_DEVICE_MODEL_DESCRIPTION));
+  m_impl.SetFail(false);
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_MODEL_DESCRIPTION));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK, "model");
+  OLA_ASSERT_EQ((size_t) 4, m_responses.size());
+}
+
+/*
+ * Check that responses expire.
+ */
+void CachingRDMAPIImplTest::testExpiry() {
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_INFO));
+  m_impl.Respond(ola::rdm::RDM_ACK, "info");
+
+  m_clock.AdvanceTime(CachingRDMAPIImpl::SETTABLE_PARAMETER_TTL.Seconds() - 1,
+                      0);
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_EQ(0u, m_impl.Outstanding());
+
+  m_clock.AdvanceTime(1, 0);
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK, "info");
+
+  // Disable caching for the PID.
+  m_cache->SetTTL(ola::rdm::PID_DEVICE_INFO, ola::TimeInterval());
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK, "info");
+}
+
+/*
+ * Check the cache is invalidated.
+ */
+void CachingRDMAPIImplTest::testInvalidation() {
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_LABEL));
+  m_impl.Respond(ola::rdm::RDM_ACK, "label");
+  OLA_ASSERT_TRUE(Get(m_other_uid, ola::rdm::PID_DEVICE_LABEL));
+  m_impl.Respond(ola::rdm::RDM_ACK, "label");
+  OLA_ASSERT_EQ(2u, m_cache->Size());
+
+  // A SET drops the responses for that UID.
+  OLA_ASSERT_TRUE(m_cache->RDMSet(
+      NewSingleCallback(this, &CachingRDMAPIImplTest::HandleResponse),
+      1, m_uid, ola::rdm::ROOT_RDM_DEVICE, ola::rdm::PID_DEVICE_LABEL));
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+  m_impl.Respond(ola::rdm::RDM_ACK, "");
+
+  // So does a response with queued messages.
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_LABEL));
+  m_impl.Respond(ola::rdm::RDM_ACK, "label", 2);
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DEVICE_LABEL));
+  m_impl.Respond(ola::rdm::RDM_ACK, "label");
+  OLA_ASSERT_EQ(2u, m_cache->Size());
+
+  // A response that arrives after the cache was invalidated isn't stored.
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_MANUFACTURER_LABEL));
+  m_cache->Invalidate(1, m_uid);
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+  m_impl.Respond(ola::rdm::RDM_ACK, "manufacturer");
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+
+  m_cache->Invalidate(2);
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+  m_cache->Invalidate(1);
+  OLA_ASSERT_EQ(0u, m_cache->Size());
+}
+
+/*
+ * Check that only ACKs are cached.
+ */
+void CachingRDMAPIImplTest::testUncachedResponses() {
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_SOFTWARE_VERSION_LABEL));
+  m_impl.Respond(ola::rdm::RDM_NACK_REASON, "");
+  OLA_ASSERT_EQ(0u, m_cache->Size());
+
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_SOFTWARE_VERSION_LABEL));
+  OLA_ASSERT_EQ(1u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK_TIMER, "");
+  OLA_ASSERT_EQ(0u, m_cache->Size());
+  OLA_ASSERT_EQ((size_t) 2, m_responses.size());
+}
+
+/*
+ * Check that other requests are passed through.
+ */
+void CachingRDMAPIImplTest::testPassThrough() {
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DMX_START_ADDRESS));
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_DMX_START_ADDRESS));
+  OLA_ASSERT_EQ(2u, m_impl.Outstanding());
+  m_impl.Respond(ola::rdm::RDM_ACK, "");
+  m_impl.Respond(ola::rdm::RDM_ACK, "");
+  OLA_ASSERT_EQ(0u, m_cache->Size());
+  OLA_ASSERT_EQ((size_t) 2, m_responses.size());
+
+  const UID broadcast = UID::AllDevices();
+  OLA_ASSERT_TRUE(Get(broadcast, ola::rdm::PID_MANUFACTURER_LABEL));
+  m_impl.Respond(ola::rdm::RDM_ACK, "");
+  OLA_ASSERT_EQ(0u, m_cache->Size());
+
+  // Fetching queued messages invalidates the UID.
+  OLA_ASSERT_TRUE(Get(m_uid, ola::rdm::PID_MANUFACTURER_LABEL));
+  m_impl.Respond(ola::rdm::RDM_ACK, "manufacturer");
+  OLA_ASSERT_EQ(1u, m_cache->Size());
+  OLA_ASSERT_TRUE(GetWithPid(m_uid, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_EQ(0u, m_cache->Size());
+  m_impl.Respond(ola::rdm::RDM_ACK, "");
+}
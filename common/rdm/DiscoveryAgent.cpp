@@ -18,6 +18,9 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <algorithm>
+#include <vector>
+
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/rdm/DiscoveryAgent.h"
@@ -67,6 +70,11 @@ void DiscoveryAgent::Abort() {
   }
 }
 
+void DiscoveryAgent::SetProgressCallback(
+    DiscoveryProgressCallback *callback) {
+  m_progress_callback.reset(callback);
+}
+
 void DiscoveryAgent::StartFullDiscovery(
     DiscoveryCompleteCallback *on_complete) {
   InitDiscovery(on_complete, false);
@@ -103,15 +111,22 @@ void DiscoveryAgent::InitDiscovery(
     FreeCurrentRange();
   }
 
+  m_expected_uids.clear();
   if (incremental) {
     UIDSet::Iterator iter = m_uids.Begin();
     for (; iter != m_uids.End(); ++iter) {
       m_uids_to_mute.push(*iter);
     }
   } else {
+    // The known responders aren't muted, so they'll collide again.
+    m_expected_uids.assign(m_uids.Begin(), m_uids.End());
     m_uids.Clear();
   }
 
+  m_progress = DiscoveryProgress();
+  m_progress.incremental = incremental;
+  m_progress.uids_to_mute = m_uids_to_mute.size();
+
   m_bad_uids.Clear();
   m_split_uids.Clear();
   m_tree_corrupt = false;
@@ -167,7 +182,10 @@ void DiscoveryAgent::IncrementalMuteComplete(bool status) {
     OLA_WARN << "Unable to mute " << m_muting_uid << ", device has gone";
   } else {
     OLA_DEBUG << "Muted " << m_muting_uid;
+    m_progress.uids_found++;
   }
+  m_progress.uids_to_mute = m_uids_to_mute.size();
+  ReportProgress();
   MaybeMuteNextDevice();
 }
 
@@ -201,15 +219,46 @@ void DiscoveryAgent::SendDiscovery() {
     }
     FreeCurrentRange();
     SendDiscovery();
+  } else if (range->attempt == 1 && range->uids_discovered == 0 &&
+             CollisionExpected(*range)) {
+    // This is the first time we've visited this branch, and there were
+    // multiple responders in it last time. Skip straight to the split.
+    OLA_DEBUG << "Expecting a collision for " << range->lower << " - "
+              << range->upper;
+    m_progress.branches_skipped++;
+    HandleCollision();
   } else {
     OLA_DEBUG << "DUB " << range->lower << " - " << range->upper
               << ", attempt " << range->attempt << ", uids found: "
               << range->uids_discovered << ", failures " << range->failures
               << ", corrupted " << range->branch_corrupt;
+    m_progress.branches_sent++;
     m_target->Branch(range->lower, range->upper, m_branch_callback.get());
   }
 }
 
+/*
+ * Check if more than one of the UIDs from the previous run is within a range.
+ */
+bool DiscoveryAgent::CollisionExpected(const UIDRange &range) const {
+  std::vector<UID>::const_iterator iter = std::lower_bound(
+      m_expected_uids.begin(), m_expected_uids.end(), range.lower);
+  if (iter == m_expected_uids.end() || *iter > range.upper) {
+    return false;
+  }
+  ++iter;
+  return iter != m_expected_uids.end() && *iter <= range.upper;
+}
+
+/*
+ * Run the progress callback, if there is one.
+ */
+void DiscoveryAgent::ReportProgress() {
+  if (m_progress_callback.get()) {
+    m_progress_callback->Run(m_progress);
+  }
+}
+
 /*
  * Handle a DUB response (inc. timeouts).
  * @param data the raw response, excluding the start code
@@ -217,6 +266,7 @@ void DiscoveryAgent::SendDiscovery() {
  */
 void DiscoveryAgent::BranchComplete(const uint8_t *data, unsigned int length) {
   OLA_INFO << "BranchComplete, got " << length;
+  ReportProgress();
   if (length == 0) {
     // timeout
     if (!m_uid_ranges.empty()) {
@@ -347,6 +397,8 @@ void DiscoveryAgent::BranchMuteComplete(bool status) {
   if (status) {
     m_uids.AddUID(m_muting_uid);
     m_uid_ranges.top()->uids_discovered++;
+    m_progress.uids_found++;
+    ReportProgress();
   } else {
     // failed to mute, if we haven't reached the limit try it again
     if (m_mute_attempts < MAX_MUTE_ATTEMPTS) {
@@ -378,6 +430,7 @@ void DiscoveryAgent::HandleCollision() {
     return;
   }
 
+  m_progress.branches_split++;
   // work out the mid point
   uint64_t mid = (lower_uid.ToUInt64() + upper_uid.ToUInt64()) / 2;
   UID mid_uid(mid);
@@ -51,6 +51,7 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testNonMutingResponder);
   CPPUNIT_TEST(testFlakeyResponder);
   CPPUNIT_TEST(testProxy);
+  CPPUNIT_TEST(testRepeatedFullDiscovery);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -69,9 +70,15 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
     void testNonMutingResponder();
     void testFlakeyResponder();
     void testProxy();
+    void testRepeatedFullDiscovery();
+
+    void RecordProgress(const DiscoveryAgent::DiscoveryProgress &progress) {
+      m_progress = progress;
+    }
 
  private:
     bool m_callback_run;
+    DiscoveryAgent::DiscoveryProgress m_progress;
 
     void DiscoverySuccessful(const UIDSet *expected,
                              bool successful,
@@ -479,3 +486,81 @@ void DiscoveryAgentTest::testProxy() {
   OLA_ASSERT_TRUE(m_callback_run);
   m_callback_run = false;
 }
+
+
+/**
+ * Check that a second full discovery uses the results of the first to avoid
+ * collisions, and still finds responders that have been added.
+ */
+void DiscoveryAgentTest::testRepeatedFullDiscovery() {
+  UIDSet uids;
+  ResponderList responders;
+  for (unsigned int i = 0; i < 64; i++) {
+    uids.AddUID(UID(0x7a70 + (i % 4), 0x1000 + i * 7919));
+  }
+  PopulateResponderListFromUIDs(uids, &responders);
+  MockDiscoveryTarget target(responders);
+
+  DiscoveryAgent agent(&target);
+  agent.SetProgressCallback(
+      ola::NewCallback(this, &DiscoveryAgentTest::RecordProgress));
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  const unsigned int first_branch_count = target.BranchCallCount();
+  OLA_ASSERT_FALSE(m_progress.incremental);
+  OLA_ASSERT_EQ(uids.Size(), m_progress.uids_found);
+  OLA_ASSERT_EQ(first_branch_count, m_progress.branches_sent);
+  OLA_ASSERT_EQ(0u, m_progress.branches_skipped);
+
+  // The second run knows where the responders are.
+  m_callback_run = false;
+  target.ResetCounters();
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  OLA_ASSERT_EQ(uids.Size(), m_progress.uids_found);
+  OLA_ASSERT_GT(m_progress.branches_skipped, 0u);
+  OLA_ASSERT_LT(target.BranchCallCount(), first_branch_count);
+  OLA_INFO << "First run took " << first_branch_count << " DUBs, second took "
+           << target.BranchCallCount();
+
+  // Remove some responders, and add some between the existing ones.
+  UIDSet::Iterator iter = uids.Begin();
+  UIDSet new_uids;
+  for (unsigned int i = 0; iter != uids.End(); ++iter, i++) {
+    if (i % 3 == 0) {
+      target.RemoveResponder(*iter);
+    } else {
+      new_uids.AddUID(*iter);
+    }
+    if (i % 5 == 0) {
+      UID uid(iter->ManufacturerId(), iter->DeviceId() + 1);
+      target.AddResponder(new MockResponder(uid));
+      new_uids.AddUID(uid);
+    }
+  }
+
+  m_callback_run = false;
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&new_uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+
+  // Incremental discovery mutes the known responders.
+  m_callback_run = false;
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&new_uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  OLA_ASSERT_TRUE(m_progress.incremental);
+  OLA_ASSERT_EQ(new_uids.Size(), m_progress.uids_found);
+  OLA_ASSERT_EQ(0u, m_progress.uids_to_mute);
+  OLA_ASSERT_EQ(1u, m_progress.branches_sent);
+}
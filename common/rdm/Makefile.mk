@@ -7,6 +7,7 @@ built_sources += \
 common_libolacommon_la_SOURCES += \
     common/rdm/AckTimerResponder.cpp \
     common/rdm/AdvancedDimmerResponder.cpp \
+    common/rdm/CachingRDMAPIImpl.cpp \
     common/rdm/CommandPrinter.cpp \
     common/rdm/DescriptorConsistencyChecker.cpp \
     common/rdm/DescriptorConsistencyChecker.h \
@@ -21,6 +22,7 @@ common_libolacommon_la_SOURCES += \
     common/rdm/GroupSizeCalculator.cpp \
     common/rdm/GroupSizeCalculator.h \
     common/rdm/MessageDeserializer.cpp \
+    common/rdm/MessagePlan.cpp \
     common/rdm/MessageSerializer.cpp \
     common/rdm/MovingLightResponder.cpp \
     common/rdm/NetworkManager.cpp \
@@ -35,6 +37,7 @@ common_libolacommon_la_SOURCES += \
     common/rdm/RDMAPI.cpp \
     common/rdm/RDMCommand.cpp \
     common/rdm/RDMCommandSerializer.cpp \
+    common/rdm/RDMCommandView.cpp \
     common/rdm/RDMFrame.cpp \
     common/rdm/RDMHelper.cpp \
     common/rdm/RDMReply.cpp \
@@ -107,6 +110,7 @@ common_rdm_RDMMessageTester_SOURCES = \
     common/rdm/GroupSizeCalculatorTest.cpp \
     common/rdm/MessageSerializerTest.cpp \
     common/rdm/MessageDeserializerTest.cpp \
+    common/rdm/MessagePlanTest.cpp \
     common/rdm/RDMMessageInterationTest.cpp \
     common/rdm/StringMessageBuilderTest.cpp \
     common/rdm/VariableFieldSizeCalculatorTest.cpp
@@ -114,12 +118,14 @@ common_rdm_RDMMessageTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
 common_rdm_RDMMessageTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_rdm_RDMAPITester_SOURCES = \
+    common/rdm/CachingRDMAPIImplTest.cpp \
     common/rdm/RDMAPITest.cpp
 common_rdm_RDMAPITester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_rdm_RDMAPITester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_rdm_RDMCommandTester_SOURCES = \
     common/rdm/RDMCommandTest.cpp \
+    common/rdm/RDMCommandViewTest.cpp \
     common/rdm/TestHelper.h
 common_rdm_RDMCommandTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_rdm_RDMCommandTester_LDADD = $(COMMON_TESTING_LIBS)
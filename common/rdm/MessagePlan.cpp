@@ -0,0 +1,540 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessagePlan.cpp
+ * Pack and unpack messages without building a Message tree.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/StringUtils.h>
+#include <ola/messaging/Descriptor.h>
+#include <ola/messaging/DescriptorVisitor.h>
+#include <ola/network/NetworkUtils.h>
+#include <ola/rdm/MessagePlan.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rdm {
+
+using ola::messaging::BoolFieldDescriptor;
+using ola::messaging::Descriptor;
+using ola::messaging::FieldDescriptor;
+using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::IPV4FieldDescriptor;
+using ola::messaging::IntegerFieldDescriptor;
+using ola::messaging::MACFieldDescriptor;
+using ola::messaging::StringFieldDescriptor;
+using ola::messaging::UIDFieldDescriptor;
+using ola::network::IPV4Address;
+using ola::network::MACAddress;
+using std::string;
+
+const unsigned int MessagePlan::NO_VARIABLE_OP = static_cast<unsigned int>(-1);
+
+namespace {
+
+template <typename int_type>
+int_type ReadInt(const uint8_t *data, bool little_endian) {
+  int_type value;
+  memcpy(reinterpret_cast<uint8_t*>(&value), data, sizeof(int_type));
+  if (little_endian) {
+    return ola::network::LittleEndianToHost(value);
+  } else {
+    return ola::network::NetworkToHost(value);
+  }
+}
+
+template <typename int_type>
+void WriteInt(int_type value, bool little_endian, uint8_t *data) {
+  if (little_endian) {
+    value = ola::network::HostToLittleEndian(value);
+  } else {
+    value = ola::network::HostToNetwork(value);
+  }
+  memcpy(data, reinterpret_cast<uint8_t*>(&value), sizeof(int_type));
+}
+
+template <typename int_type>
+bool PackInt(const FieldDescriptor *field, bool little_endian,
+             MessageSourceInterface *source, uint8_t *data) {
+  int_type value;
+  if (!source->Get(
+        static_cast<const IntegerFieldDescriptor<int_type>*>(field),
+        &value)) {
+    return false;
+  }
+  WriteInt(value, little_endian, data);
+  return true;
+}
+}  // namespace
+
+
+/**
+ * Walks a descriptor and builds the ops for a MessagePlan.
+ */
+class MessagePlanCompiler: public ola::messaging::FieldDescriptorVisitor {
+ public:
+  explicit MessagePlanCompiler(MessagePlan *plan)
+      : m_plan(plan),
+        m_offset(0),
+        m_depth(0),
+        m_ok(true) {
+  }
+
+  bool Compile(const Descriptor *descriptor) {
+    for (unsigned int i = 0; i < descriptor->FieldCount(); ++i) {
+      descriptor->GetField(i)->Accept(this);
+    }
+    m_plan->m_fixed_size = m_offset;
+    return m_ok;
+  }
+
+  // we handle descending into groups ourself
+  bool Descend() const { return false; }
+
+  void Visit(const BoolFieldDescriptor *descriptor) {
+    AddOp(MessagePlan::BOOL_OP, descriptor);
+  }
+
+  void Visit(const IPV4FieldDescriptor *descriptor) {
+    AddOp(MessagePlan::IPV4_OP, descriptor);
+  }
+
+  void Visit(const MACFieldDescriptor *descriptor) {
+    AddOp(MessagePlan::MAC_OP, descriptor);
+  }
+
+  void Visit(const UIDFieldDescriptor *descriptor) {
+    AddOp(MessagePlan::UID_OP, descriptor);
+  }
+
+  void Visit(const StringFieldDescriptor *descriptor) {
+    if (descriptor->FixedSize()) {
+      AddOp(MessagePlan::STRING_OP, descriptor);
+    } else if (CanAddVariableField()) {
+      AddVariableOp(NewOp(MessagePlan::STRING_OP, descriptor));
+    }
+  }
+
+  void Visit(const IntegerFieldDescriptor<uint8_t> *descriptor) {
+    AddOp(MessagePlan::UINT8_OP, descriptor, descriptor->IsLittleEndian());
+  }
+
+  void Visit(const IntegerFieldDescriptor<uint16_t> *descriptor) {
+    AddOp(MessagePlan::UINT16_OP, descriptor, descriptor->IsLittleEndian());
+  }
+
+  void Visit(const IntegerFieldDescriptor<uint32_t> *descriptor) {
+    AddOp(MessagePlan::UINT32_OP, descriptor, descriptor->IsLittleEndian());
+  }
+
+  void Visit(const IntegerFieldDescriptor<int8_t> *descriptor) {
+    AddOp(MessagePlan::INT8_OP, descriptor, descriptor->IsLittleEndian());
+  }
+
+  void Visit(const IntegerFieldDescriptor<int16_t> *descriptor) {
+    AddOp(MessagePlan::INT16_OP, descriptor, descriptor->IsLittleEndian());
+  }
+
+  void Visit(const IntegerFieldDescriptor<int32_t> *descriptor) {
+    AddOp(MessagePlan::INT32_OP, descriptor, descriptor->IsLittleEndian());
+  }
+
+  void Visit(const FieldDescriptorGroup *descriptor) {
+    // Blocks must be a fixed size, otherwise we can't find the boundaries.
+    if (!descriptor->FixedBlockSize()) {
+      m_ok = false;
+      return;
+    }
+    const bool variable = !descriptor->FixedBlockCount();
+    if (variable && (!CanAddVariableField() || !descriptor->BlockSize())) {
+      m_ok = false;
+      return;
+    }
+
+    MessagePlan::Op op = NewOp(MessagePlan::GROUP_OP, descriptor);
+    op.size = descriptor->BlockSize();
+    op.block_count = descriptor->MinBlocks();
+    const unsigned int index = m_plan->m_ops.size();
+    m_plan->m_ops.push_back(op);
+
+    const unsigned int saved_offset = m_offset;
+    m_offset = 0;
+    m_depth++;
+    for (unsigned int i = 0; i < descriptor->FieldCount(); ++i) {
+      descriptor->GetField(i)->Accept(this);
+    }
+    m_depth--;
+    m_offset = saved_offset;
+    m_plan->m_ops[index].child_ops = m_plan->m_ops.size() - index - 1;
+
+    if (variable) {
+      m_plan->m_variable_op = index;
+    } else {
+      m_offset += descriptor->BlockSize() * descriptor->MinBlocks();
+    }
+  }
+
+  void PostVisit(const FieldDescriptorGroup*) {}
+
+ private:
+  MessagePlan *m_plan;
+  unsigned int m_offset;
+  unsigned int m_depth;
+  bool m_ok;
+
+  MessagePlan::Op NewOp(MessagePlan::OpCode code,
+                        const FieldDescriptor *descriptor,
+                        bool little_endian = false) {
+    MessagePlan::Op op;
+    op.code = code;
+    op.descriptor = descriptor;
+    op.offset = m_offset;
+    op.size = descriptor->MaxSize();
+    op.little_endian = little_endian;
+    op.follows_variable = (
+        m_depth == 0 && m_plan->m_variable_op != MessagePlan::NO_VARIABLE_OP);
+    op.block_count = 0;
+    op.child_ops = 0;
+    return op;
+  }
+
+  void AddOp(MessagePlan::OpCode code,
+             const FieldDescriptor *descriptor,
+             bool little_endian = false) {
+    MessagePlan::Op op = NewOp(code, descriptor, little_endian);
+    m_plan->m_ops.push_back(op);
+    m_offset += op.size;
+  }
+
+  // The variable field doesn't advance the offset, the fields after it are
+  // adjusted at runtime.
+  void AddVariableOp(const MessagePlan::Op &op) {
+    m_plan->m_variable_op = m_plan->m_ops.size();
+    m_plan->m_ops.push_back(op);
+  }
+
+  bool CanAddVariableField() {
+    if (m_depth || m_plan->m_variable_op != MessagePlan::NO_VARIABLE_OP) {
+      m_ok = false;
+    }
+    return m_ok;
+  }
+};
+
+
+MessagePlan::MessagePlan()
+    : m_fixed_size(0),
+      m_variable_op(NO_VARIABLE_OP) {
+}
+
+
+MessagePlan *MessagePlan::Compile(const Descriptor *descriptor) {
+  std::auto_ptr<MessagePlan> plan(new MessagePlan());
+  MessagePlanCompiler compiler(plan.get());
+  if (!compiler.Compile(descriptor)) {
+    return NULL;
+  }
+  return plan.release();
+}
+
+
+bool MessagePlan::Unpack(const uint8_t *data,
+                         unsigned int length,
+                         MessageSinkInterface *sink) const {
+  if ((!data && length) || length < m_fixed_size) {
+    return false;
+  }
+
+  const unsigned int variable_size = length - m_fixed_size;
+  unsigned int variable_count = 0;
+  if (m_variable_op == NO_VARIABLE_OP) {
+    if (variable_size) {
+      return false;
+    }
+  } else {
+    const Op &op = m_ops[m_variable_op];
+    if (op.code == STRING_OP) {
+      const StringFieldDescriptor *descriptor =
+          static_cast<const StringFieldDescriptor*>(op.descriptor);
+      if (variable_size < descriptor->MinSize() ||
+          variable_size > descriptor->MaxSize()) {
+        return false;
+      }
+    } else {
+      const FieldDescriptorGroup *descriptor =
+          static_cast<const FieldDescriptorGroup*>(op.descriptor);
+      if (variable_size % op.size) {
+        return false;
+      }
+      variable_count = variable_size / op.size;
+      if (variable_count < descriptor->MinBlocks() ||
+          (descriptor->MaxBlocks() != FieldDescriptorGroup::UNLIMITED_BLOCKS &&
+           variable_count >
+             static_cast<unsigned int>(descriptor->MaxBlocks()))) {
+        return false;
+      }
+    }
+  }
+
+  string scratch;
+  UnpackOps(0, m_ops.size(), data, variable_size, variable_count, sink,
+            &scratch);
+  return true;
+}
+
+
+bool MessagePlan::Pack(MessageSourceInterface *source,
+                       uint8_t *data,
+                       unsigned int *length) const {
+  if (*length < m_fixed_size) {
+    return false;
+  }
+
+  unsigned int variable_size = 0;
+  if (!PackOps(0, m_ops.size(), source, data, *length, &variable_size)) {
+    return false;
+  }
+  *length = m_fixed_size + variable_size;
+  return true;
+}
+
+
+/*
+ * Run the ops in [first, last). data points to the start of the message, or
+ * the current block.
+ */
+void MessagePlan::UnpackOps(unsigned int first, unsigned int last,
+                            const uint8_t *data,
+                            unsigned int variable_size,
+                            unsigned int variable_count,
+                            MessageSinkInterface *sink,
+                            string *scratch) const {
+  for (unsigned int i = first; i < last; i++) {
+    const Op &op = m_ops[i];
+    const uint8_t *ptr = (
+        data + op.offset + (op.follows_variable ? variable_size : 0));
+
+    switch (op.code) {
+      case BOOL_OP:
+        sink->Visit(static_cast<const BoolFieldDescriptor*>(op.descriptor),
+                    *ptr != 0);
+        break;
+      case IPV4_OP:
+        {
+          uint32_t address;
+          memcpy(&address, ptr, sizeof(address));
+          sink->Visit(static_cast<const IPV4FieldDescriptor*>(op.descriptor),
+                      IPV4Address(address));
+        }
+        break;
+      case MAC_OP:
+        sink->Visit(static_cast<const MACFieldDescriptor*>(op.descriptor),
+                    MACAddress(ptr));
+        break;
+      case UID_OP:
+        sink->Visit(static_cast<const UIDFieldDescriptor*>(op.descriptor),
+                    UID(ptr));
+        break;
+      case STRING_OP:
+        scratch->assign(reinterpret_cast<const char*>(ptr),
+                        i == m_variable_op ? variable_size : op.size);
+        ShortenString(scratch);
+        sink->Visit(static_cast<const StringFieldDescriptor*>(op.descriptor),
+                    *scratch);
+        break;
+      case UINT8_OP:
+        sink->Visit(
+            static_cast<const IntegerFieldDescriptor<uint8_t>*>(op.descriptor),
+            ReadInt<uint8_t>(ptr, op.little_endian));
+        break;
+      case UINT16_OP:
+        sink->Visit(
+            static_cast<const IntegerFieldDescriptor<uint16_t>*>(
+              op.descriptor),
+            ReadInt<uint16_t>(ptr, op.little_endian));
+        break;
+      case UINT32_OP:
+        sink->Visit(
+            static_cast<const IntegerFieldDescriptor<uint32_t>*>(
+              op.descriptor),
+            ReadInt<uint32_t>(ptr, op.little_endian));
+        break;
+      case INT8_OP:
+        sink->Visit(
+            static_cast<const IntegerFieldDescriptor<int8_t>*>(op.descriptor),
+            ReadInt<int8_t>(ptr, op.little_endian));
+        break;
+      case INT16_OP:
+        sink->Visit(
+            static_cast<const IntegerFieldDescriptor<int16_t>*>(op.descriptor),
+            ReadInt<int16_t>(ptr, op.little_endian));
+        break;
+      case INT32_OP:
+        sink->Visit(
+            static_cast<const IntegerFieldDescriptor<int32_t>*>(op.descriptor),
+            ReadInt<int32_t>(ptr, op.little_endian));
+        break;
+      case GROUP_OP:
+        {
+          const FieldDescriptorGroup *group =
+              static_cast<const FieldDescriptorGroup*>(op.descriptor);
+          const unsigned int blocks = (
+              i == m_variable_op ? variable_count : op.block_count);
+          for (unsigned int block = 0; block < blocks; block++) {
+            sink->StartBlock(group);
+            UnpackOps(i + 1, i + 1 + op.child_ops, ptr + block * op.size, 0, 0,
+                      sink, scratch);
+            sink->EndBlock(group);
+          }
+          i += op.child_ops;
+        }
+        break;
+    }
+  }
+}
+
+
+/*
+ * Run the ops in [first, last). The capacity is checked before the fixed and
+ * variable fields are written, so individual fields don't need checks.
+ */
+bool MessagePlan::PackOps(unsigned int first, unsigned int last,
+                          MessageSourceInterface *source,
+                          uint8_t *data,
+                          unsigned int capacity,
+                          unsigned int *variable_size) const {
+  for (unsigned int i = first; i < last; i++) {
+    const Op &op = m_ops[i];
+    uint8_t *ptr = (
+        data + op.offset + (op.follows_variable ? *variable_size : 0));
+    bool ok = true;
+
+    switch (op.code) {
+      case BOOL_OP:
+        {
+          bool value = false;
+          ok = source->Get(static_cast<const BoolFieldDescriptor*>(
+              op.descriptor), &value);
+          *ptr = value;
+        }
+        break;
+      case IPV4_OP:
+        {
+          IPV4Address value;
+          ok = source->Get(static_cast<const IPV4FieldDescriptor*>(
+              op.descriptor), &value);
+          uint32_t address = value.AsInt();
+          memcpy(ptr, &address, sizeof(address));
+        }
+        break;
+      case MAC_OP:
+        {
+          MACAddress value;
+          ok = source->Get(static_cast<const MACFieldDescriptor*>(
+              op.descriptor), &value);
+          value.Pack(ptr, op.size);
+        }
+        break;
+      case UID_OP:
+        {
+          UID value(0, 0);
+          ok = source->Get(static_cast<const UIDFieldDescriptor*>(
+              op.descriptor), &value);
+          value.Pack(ptr, op.size);
+        }
+        break;
+      case STRING_OP:
+        {
+          const StringFieldDescriptor *descriptor =
+              static_cast<const StringFieldDescriptor*>(op.descriptor);
+          string value;
+          if (!source->Get(descriptor, &value)) {
+            return false;
+          }
+          const unsigned int size = std::min(
+              static_cast<unsigned int>(value.size()), descriptor->MaxSize());
+          const unsigned int used_size = std::max(size,
+                                                  descriptor->MinSize());
+          if (i == m_variable_op) {
+            if (m_fixed_size + used_size > capacity) {
+              return false;
+            }
+            *variable_size = used_size;
+          }
+          memcpy(ptr, value.data(), size);
+          memset(ptr + size, 0, used_size - size);
+        }
+        break;
+      case UINT8_OP:
+        ok = PackInt<uint8_t>(op.descriptor, op.little_endian, source, ptr);
+        break;
+      case UINT16_OP:
+        ok = PackInt<uint16_t>(op.descriptor, op.little_endian, source, ptr);
+        break;
+      case UINT32_OP:
+        ok = PackInt<uint32_t>(op.descriptor, op.little_endian, source, ptr);
+        break;
+      case INT8_OP:
+        ok = PackInt<int8_t>(op.descriptor, op.little_endian, source, ptr);
+        break;
+      case INT16_OP:
+        ok = PackInt<int16_t>(op.descriptor, op.little_endian, source, ptr);
+        break;
+      case INT32_OP:
+        ok = PackInt<int32_t>(op.descriptor, op.little_endian, source, ptr);
+        break;
+      case GROUP_OP:
+        {
+          const FieldDescriptorGroup *group =
+              static_cast<const FieldDescriptorGroup*>(op.descriptor);
+          unsigned int blocks = op.block_count;
+          if (i == m_variable_op) {
+            if (!source->GetBlockCount(group, &blocks)) {
+              return false;
+            }
+            if (blocks < group->MinBlocks() ||
+                (group->MaxBlocks() != FieldDescriptorGroup::UNLIMITED_BLOCKS &&
+                 blocks > static_cast<unsigned int>(group->MaxBlocks())) ||
+                m_fixed_size + blocks * op.size > capacity) {
+              return false;
+            }
+            *variable_size = blocks * op.size;
+          }
+          for (unsigned int block = 0; block < blocks; block++) {
+            source->StartBlock(group);
+            unsigned int unused = 0;
+            if (!PackOps(i + 1, i + 1 + op.child_ops, source,
+                         ptr + block * op.size, op.size, &unused)) {
+              return false;
+            }
+            source->EndBlock(group);
+          }
+          i += op.child_ops;
+        }
+        break;
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace rdm
+}  // namespace ola
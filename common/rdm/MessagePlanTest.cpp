@@ -0,0 +1,590 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessagePlanTest.cpp
+ * Test fixture for the MessagePlan class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/messaging/Descriptor.h"
+#include "ola/messaging/Message.h"
+#include "ola/messaging/MessagePrinter.h"
+#include "ola/rdm/MessageDeserializer.h"
+#include "ola/rdm/MessagePlan.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::messaging::BoolFieldDescriptor;
+using ola::messaging::Descriptor;
+using ola::messaging::FieldDescriptor;
+using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::GenericMessagePrinter;
+using ola::messaging::IPV4FieldDescriptor;
+using ola::messaging::Int16FieldDescriptor;
+using ola::messaging::Int32FieldDescriptor;
+using ola::messaging::Int8FieldDescriptor;
+using ola::messaging::MACFieldDescriptor;
+using ola::messaging::Message;
+using ola::messaging::MessageFieldInterface;
+using ola::messaging::StringFieldDescriptor;
+using ola::messaging::UIDFieldDescriptor;
+using ola::messaging::UInt16FieldDescriptor;
+using ola::messaging::UInt32FieldDescriptor;
+using ola::messaging::UInt8FieldDescriptor;
+using ola::network::IPV4Address;
+using ola::network::MACAddress;
+using ola::rdm::MessageDeserializer;
+using ola::rdm::MessagePlan;
+using ola::rdm::UID;
+using std::auto_ptr;
+using std::deque;
+using std::map;
+using std::string;
+using std::vector;
+
+
+/**
+ * Builds a Message from the unpacked fields, so the result can be compared
+ * with the MessageDeserializer.
+ */
+class MessageBuildingSink: public ola::rdm::MessageSinkInterface {
+ public:
+  MessageBuildingSink() { m_stack.push_back(FieldVector()); }
+  ~MessageBuildingSink() {
+    for (unsigned int i = 0; i < m_stack.size(); i++) {
+      for (unsigned int j = 0; j < m_stack[i].size(); j++) {
+        delete m_stack[i][j];
+      }
+    }
+  }
+
+  const Message *GetMessage() {
+    const Message *message = new Message(m_stack.back());
+    m_stack.back().clear();
+    return message;
+  }
+
+  void Visit(const BoolFieldDescriptor *descriptor, bool value) {
+    Add(new ola::messaging::BoolMessageField(descriptor, value));
+  }
+  void Visit(const IPV4FieldDescriptor *descriptor,
+             const IPV4Address &value) {
+    Add(new ola::messaging::IPV4MessageField(descriptor, value));
+  }
+  void Visit(const MACFieldDescriptor *descriptor, const MACAddress &value) {
+    Add(new ola::messaging::MACMessageField(descriptor, value));
+  }
+  void Visit(const UIDFieldDescriptor *descriptor, const UID &value) {
+    Add(new ola::messaging::UIDMessageField(descriptor, value));
+  }
+  void Visit(const StringFieldDescriptor *descriptor, const string &value) {
+    Add(new ola::messaging::StringMessageField(descriptor, value));
+  }
+  void Visit(const UInt8FieldDescriptor *descriptor, uint8_t value) {
+    Add(new ola::messaging::UInt8MessageField(descriptor, value));
+  }
+  void Visit(const UInt16FieldDescriptor *descriptor, uint16_t value) {
+    Add(new ola::messaging::UInt16MessageField(descriptor, value));
+  }
+  void Visit(const UInt32FieldDescriptor *descriptor, uint32_t value) {
+    Add(new ola::messaging::UInt32MessageField(descriptor, value));
+  }
+  void Visit(const Int8FieldDescriptor *descriptor, int8_t value) {
+    Add(new ola::messaging::Int8MessageField(descriptor, value));
+  }
+  void Visit(const Int16FieldDescriptor *descriptor, int16_t value) {
+    Add(new ola::messaging::Int16MessageField(descriptor, value));
+  }
+  void Visit(const Int32FieldDescriptor *descriptor, int32_t value) {
+    Add(new ola::messaging::Int32MessageField(descriptor, value));
+  }
+
+  void StartBlock(const FieldDescriptorGroup*) {
+    m_stack.push_back(FieldVector());
+  }
+
+  void EndBlock(const FieldDescriptorGroup *descriptor) {
+    const MessageFieldInterface *group =
+        new ola::messaging::GroupMessageField(descriptor, m_stack.back());
+    m_stack.pop_back();
+    Add(group);
+  }
+
+ private:
+  typedef vector<const MessageFieldInterface*> FieldVector;
+  vector<FieldVector> m_stack;
+
+  void Add(const MessageFieldInterface *field) {
+    m_stack.back().push_back(field);
+  }
+};
+
+
+/**
+ * Records the unpacked values so they can be packed again.
+ */
+class RecordingSink: public ola::rdm::MessageSinkInterface,
+                     public ola::rdm::MessageSourceInterface {
+ public:
+  RecordingSink() : m_depth(0) {}
+
+  // Sink methods
+  void Visit(const BoolFieldDescriptor*, bool value) {
+    Field field;
+    field.uint_value = value;
+    m_fields.push_back(field);
+  }
+  void Visit(const IPV4FieldDescriptor*, const IPV4Address &value) {
+    Field field;
+    field.ip = value;
+    m_fields.push_back(field);
+  }
+  void Visit(const MACFieldDescriptor*, const MACAddress &value) {
+    Field field;
+    field.mac = value;
+    m_fields.push_back(field);
+  }
+  void Visit(const UIDFieldDescriptor*, const UID &value) {
+    Field field;
+    field.uid = value;
+    m_fields.push_back(field);
+  }
+  void Visit(const StringFieldDescriptor*, const string &value) {
+    Field field;
+    field.str = value;
+    m_fields.push_back(field);
+  }
+  void Visit(const UInt8FieldDescriptor*, uint8_t value) { AddUInt(value); }
+  void Visit(const UInt16FieldDescriptor*, uint16_t value) { AddUInt(value); }
+  void Visit(const UInt32FieldDescriptor*, uint32_t value) { AddUInt(value); }
+  void Visit(const Int8FieldDescriptor*, int8_t value) { AddInt(value); }
+  void Visit(const Int16FieldDescriptor*, int16_t value) { AddInt(value); }
+  void Visit(const Int32FieldDescriptor*, int32_t value) { AddInt(value); }
+
+  void StartBlock(const FieldDescriptorGroup *descriptor) {
+    // Only top level groups can vary in size.
+    if (m_depth++ == 0) {
+      m_block_counts[descriptor]++;
+    }
+  }
+  void EndBlock(const FieldDescriptorGroup*) { m_depth--; }
+
+  // Source methods
+  bool Get(const BoolFieldDescriptor*, bool *value) {
+    *value = Next().uint_value;
+    return true;
+  }
+  bool Get(const IPV4FieldDescriptor*, IPV4Address *value) {
+    *value = Next().ip;
+    return true;
+  }
+  bool Get(const MACFieldDescriptor*, MACAddress *value) {
+    *value = Next().mac;
+    return true;
+  }
+  bool Get(const UIDFieldDescriptor*, UID *value) {
+    *value = Next().uid;
+    return true;
+  }
+  bool Get(const StringFieldDescriptor*, string *value) {
+    *value = Next().str;
+    return true;
+  }
+  bool Get(const UInt8FieldDescriptor*, uint8_t *value) {
+    *value = Next().uint_value;
+    return true;
+  }
+  bool Get(const UInt16FieldDescriptor*, uint16_t *value) {
+    *value = Next().uint_value;
+    return true;
+  }
+  bool Get(const UInt32FieldDescriptor*, uint32_t *value) {
+    *value = Next().uint_value;
+    return true;
+  }
+  bool Get(const Int8FieldDescriptor*, int8_t *value) {
+    *value = Next().int_value;
+    return true;
+  }
+  bool Get(const Int16FieldDescriptor*, int16_t *value) {
+    *value = Next().int_value;
+    return true;
+  }
+  bool Get(const Int32FieldDescriptor*, int32_t *value) {
+    *value = Next().int_value;
+    return true;
+  }
+  bool GetBlockCount(const FieldDescriptorGroup *descriptor,
+                     unsigned int *count) {
+    *count = m_block_counts[descriptor];
+    return true;
+  }
+
+  unsigned int Remaining() const { return m_fields.size(); }
+
+ private:
+  struct Field {
+    Field() : uint_value(0), int_value(0), uid(0, 0) {}
+
+    uint32_t uint_value;
+    int32_t int_value;
+    string str;
+    IPV4Address ip;
+    MACAddress mac;
+    UID uid;
+  };
+
+  deque<Field> m_fields;
+  unsigned int m_depth;
+  map<const FieldDescriptorGroup*, unsigned int> m_block_counts;
+
+  void AddUInt(uint32_t value) {
+    Field field;
+    field.uint_value = value;
+    m_fields.push_back(field);
+  }
+
+  void AddInt(int32_t value) {
+    Field field;
+    field.int_value = value;
+    m_fields.push_back(field);
+  }
+
+  Field Next() {
+    Field field = m_fields.front();
+    m_fields.pop_front();
+    return field;
+  }
+};
+
+
+class MessagePlanTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MessagePlanTest);
+  CPPUNIT_TEST(testUnsupportedDescriptors);
+  CPPUNIT_TEST(testSimple);
+  CPPUNIT_TEST(testAddresses);
+  CPPUNIT_TEST(testVariableString);
+  CPPUNIT_TEST(testVariableGroup);
+  CPPUNIT_TEST(testNestedFixedGroups);
+  CPPUNIT_TEST(testPackLimits);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testUnsupportedDescriptors();
+  void testSimple();
+  void testAddresses();
+  void testVariableString();
+  void testVariableGroup();
+  void testNestedFixedGroups();
+  void testPackLimits();
+
+ private:
+  MessageDeserializer m_deserializer;
+  GenericMessagePrinter m_printer;
+
+  void CheckMatchesDeserializer(const Descriptor *descriptor,
+                                const uint8_t *data,
+                                unsigned int length);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessagePlanTest);
+
+
+/*
+ * Check the plan unpacks the same as the MessageDeserializer, and that
+ * packing the unpacked values gives back the original data.
+ */
+void MessagePlanTest::CheckMatchesDeserializer(const Descriptor *descriptor,
+                                               const uint8_t *data,
+                                               unsigned int length) {
+  auto_ptr<MessagePlan> plan(MessagePlan::Compile(descriptor));
+  OLA_ASSERT_NOT_NULL(plan.get());
+
+  auto_ptr<const Message> expected(
+      m_deserializer.InflateMessage(descriptor, data, length));
+
+  MessageBuildingSink sink;
+  const bool ok = plan->Unpack(data, length, &sink);
+  OLA_ASSERT_EQ(expected.get() != NULL, ok);
+  if (!ok) {
+    return;
+  }
+  auto_ptr<const Message> message(sink.GetMessage());
+  OLA_ASSERT_EQ(m_printer.AsString(expected.get()),
+                m_printer.AsString(message.get()));
+
+  RecordingSink recorder;
+  OLA_ASSERT_TRUE(plan->Unpack(data, length, &recorder));
+  uint8_t output[256];
+  unsigned int output_length = sizeof(output);
+  OLA_ASSERT_TRUE(plan->Pack(&recorder, output, &output_length));
+  OLA_ASSERT_EQ(0u, recorder.Remaining());
+  OLA_ASSERT_DATA_EQUALS(data, length, output, output_length);
+}
+
+
+/**
+ * Check that descriptors the MessageDeserializer can't handle are rejected.
+ */
+void MessagePlanTest::testUnsupportedDescriptors() {
+  // two variable sized fields
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new StringFieldDescriptor("string1", 0, 32));
+  fields.push_back(new StringFieldDescriptor("string2", 0, 32));
+  Descriptor two_strings("Two Strings", fields);
+  OLA_ASSERT_NULL(MessagePlan::Compile(&two_strings));
+
+  // a variable sized group within a group
+  vector<const FieldDescriptor*> inner_fields;
+  inner_fields.push_back(new UInt8FieldDescriptor("uint8"));
+  vector<const FieldDescriptor*> outer_fields;
+  outer_fields.push_back(new FieldDescriptorGroup("inner", inner_fields, 0, 2));
+  fields.clear();
+  fields.push_back(new FieldDescriptorGroup("outer", outer_fields, 0, 2));
+  Descriptor nested("Nested", fields);
+  OLA_ASSERT_NULL(MessagePlan::Compile(&nested));
+
+  // a group containing a variable length string
+  vector<const FieldDescriptor*> string_group;
+  string_group.push_back(new StringFieldDescriptor("string", 0, 32));
+  fields.clear();
+  fields.push_back(new FieldDescriptorGroup("group", string_group, 1, 1));
+  Descriptor group_with_string("Group with string", fields);
+  OLA_ASSERT_NULL(MessagePlan::Compile(&group_with_string));
+
+  // empty descriptors are fine
+  fields.clear();
+  Descriptor empty("Empty", fields);
+  auto_ptr<MessagePlan> plan(MessagePlan::Compile(&empty));
+  OLA_ASSERT_NOT_NULL(plan.get());
+  OLA_ASSERT_EQ(0u, plan->OpCount());
+  OLA_ASSERT_FALSE(plan->VariableSize());
+  CheckMatchesDeserializer(&empty, NULL, 0);
+  const uint8_t data[] = {0};
+  CheckMatchesDeserializer(&empty, data, sizeof(data));
+}
+
+
+/**
+ * Check integers and bools.
+ */
+void MessagePlanTest::testSimple() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new BoolFieldDescriptor("bool"));
+  fields.push_back(new UInt8FieldDescriptor("uint8"));
+  fields.push_back(new Int8FieldDescriptor("int8"));
+  fields.push_back(new UInt16FieldDescriptor("uint16"));
+  fields.push_back(new Int16FieldDescriptor("int16", true));
+  fields.push_back(new UInt32FieldDescriptor("uint32", true));
+  fields.push_back(new Int32FieldDescriptor("int32"));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  const uint8_t data[] = {
+    1, 10, 246, 1, 0x2c, 0xfe, 10,
+    1, 2, 3, 4, 0xfe, 6, 7, 8};
+
+  auto_ptr<MessagePlan> plan(MessagePlan::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(plan.get());
+  OLA_ASSERT_EQ(7u, plan->OpCount());
+  OLA_ASSERT_EQ(static_cast<unsigned int>(sizeof(data)), plan->FixedSize());
+  OLA_ASSERT_FALSE(plan->VariableSize());
+
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data));
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data) - 1);
+  CheckMatchesDeserializer(&descriptor, data, 0);
+}
+
+
+/**
+ * Check IPv4, MAC and UID fields.
+ */
+void MessagePlanTest::testAddresses() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new IPV4FieldDescriptor("ip"));
+  fields.push_back(new MACFieldDescriptor("mac"));
+  fields.push_back(new UIDFieldDescriptor("uid"));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  const uint8_t data[] = {
+    10, 0, 0, 1,
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab,
+    0x70, 0x7a, 0, 0, 0, 1};
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data));
+}
+
+
+/**
+ * Check a variable length string, with fields either side of it.
+ */
+void MessagePlanTest::testVariableString() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new UInt16FieldDescriptor("before"));
+  fields.push_back(new StringFieldDescriptor("fixed", 4, 4));
+  fields.push_back(new StringFieldDescriptor("variable", 2, 8));
+  fields.push_back(new UInt16FieldDescriptor("after"));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  auto_ptr<MessagePlan> plan(MessagePlan::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(plan.get());
+  OLA_ASSERT_EQ(8u, plan->FixedSize());
+  OLA_ASSERT_TRUE(plan->VariableSize());
+
+  const uint8_t data[] = {
+    0, 1, 'a', 'b', 'c', 'd',
+    'o', 'p', 'e', 'n', 'l', 'i', 'g', 'h',
+    0x12, 0x34};
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data));
+
+  // shorter strings
+  const uint8_t short_data[] = {
+    0, 1, 'a', 'b', 'c', 'd', 'o', 'p', 'e', 0x12, 0x34};
+  CheckMatchesDeserializer(&descriptor, short_data, sizeof(short_data));
+
+  // too short and too long
+  CheckMatchesDeserializer(&descriptor, data, 9);
+  const uint8_t long_data[17] = {0};
+  CheckMatchesDeserializer(&descriptor, long_data, sizeof(long_data));
+}
+
+
+/**
+ * Check a group with a variable number of blocks.
+ */
+void MessagePlanTest::testVariableGroup() {
+  vector<const FieldDescriptor*> group_fields;
+  group_fields.push_back(new BoolFieldDescriptor("bool"));
+  group_fields.push_back(new UInt16FieldDescriptor("uint16"));
+
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new UInt8FieldDescriptor("count"));
+  fields.push_back(new FieldDescriptorGroup("group", group_fields, 1, 3));
+  fields.push_back(new Int8FieldDescriptor("trailer"));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  auto_ptr<MessagePlan> plan(MessagePlan::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(plan.get());
+  OLA_ASSERT_EQ(5u, plan->OpCount());
+  OLA_ASSERT_EQ(2u, plan->FixedSize());
+
+  const uint8_t data[] = {
+    3, 0, 0, 10, 1, 1, 0, 0, 2, 0, 0xff};
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data));
+
+  // no blocks is too few, 4 is too many, and partial blocks are rejected
+  const uint8_t no_blocks[] = {0, 0xff};
+  CheckMatchesDeserializer(&descriptor, no_blocks, sizeof(no_blocks));
+  const uint8_t four_blocks[14] = {4};
+  CheckMatchesDeserializer(&descriptor, four_blocks, sizeof(four_blocks));
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data) - 1);
+}
+
+
+/**
+ * Check fixed size groups, nested inside a variable group.
+ */
+void MessagePlanTest::testNestedFixedGroups() {
+  vector<const FieldDescriptor*> inner_fields;
+  inner_fields.push_back(new UInt8FieldDescriptor("uint8"));
+  inner_fields.push_back(new BoolFieldDescriptor("bool"));
+
+  vector<const FieldDescriptor*> outer_fields;
+  outer_fields.push_back(new UInt16FieldDescriptor("id"));
+  outer_fields.push_back(new FieldDescriptorGroup("inner", inner_fields, 2, 2));
+
+  vector<const FieldDescriptor*> fixed_fields;
+  fixed_fields.push_back(new UInt8FieldDescriptor("uint8"));
+  fixed_fields.push_back(new BoolFieldDescriptor("bool"));
+
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new FieldDescriptorGroup("fixed", fixed_fields, 1, 1));
+  fields.push_back(new FieldDescriptorGroup(
+      "outer", outer_fields, 0, FieldDescriptorGroup::UNLIMITED_BLOCKS));
+  Descriptor descriptor("Test Descriptor", fields);
+
+  const uint8_t data[] = {
+    7, 1,
+    0, 1, 10, 0, 11, 1,
+    0, 2, 20, 1, 21, 0};
+  CheckMatchesDeserializer(&descriptor, data, sizeof(data));
+  CheckMatchesDeserializer(&descriptor, data, 2);
+  CheckMatchesDeserializer(&descriptor, data, 8);
+  CheckMatchesDeserializer(&descriptor, data, 9);
+}
+
+
+/**
+ * Check that Pack respects the buffer size and the block limits.
+ */
+void MessagePlanTest::testPackLimits() {
+  vector<const FieldDescriptor*> group_fields;
+  group_fields.push_back(new UInt8FieldDescriptor("uint8"));
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new UInt16FieldDescriptor("uint16"));
+  fields.push_back(new FieldDescriptorGroup("group", group_fields, 0, 4));
+  Descriptor descriptor("Test Descriptor", fields);
+  auto_ptr<MessagePlan> plan(MessagePlan::Compile(&descriptor));
+  OLA_ASSERT_NOT_NULL(plan.get());
+
+  const uint8_t data[] = {1, 2, 3, 4, 5};
+
+  RecordingSink recorder;
+  OLA_ASSERT_TRUE(plan->Unpack(data, sizeof(data), &recorder));
+  uint8_t output[sizeof(data)];
+  unsigned int output_length = sizeof(output) - 1;
+  OLA_ASSERT_FALSE(plan->Pack(&recorder, output, &output_length));
+
+  RecordingSink recorder2;
+  OLA_ASSERT_TRUE(plan->Unpack(data, sizeof(data), &recorder2));
+  output_length = sizeof(output);
+  OLA_ASSERT_TRUE(plan->Pack(&recorder2, output, &output_length));
+  OLA_ASSERT_DATA_EQUALS(data, sizeof(data), output, output_length);
+
+  // strings are truncated & padded as with the MessageSerializer
+  fields.clear();
+  fields.push_back(new StringFieldDescriptor("string", 4, 6));
+  Descriptor string_descriptor("String Descriptor", fields);
+  plan.reset(MessagePlan::Compile(&string_descriptor));
+  OLA_ASSERT_NOT_NULL(plan.get());
+
+  const uint8_t long_string[] = {'a', 'b', 'c', 'd', 'e', 'f'};
+  RecordingSink recorder3;
+  OLA_ASSERT_TRUE(plan->Unpack(long_string, sizeof(long_string), &recorder3));
+  output_length = sizeof(output);
+  OLA_ASSERT_FALSE(plan->Pack(&recorder3, output, &output_length));
+  uint8_t large_output[10];
+  RecordingSink recorder4;
+  OLA_ASSERT_TRUE(plan->Unpack(long_string, sizeof(long_string), &recorder4));
+  output_length = sizeof(large_output);
+  OLA_ASSERT_TRUE(plan->Pack(&recorder4, large_output, &output_length));
+  OLA_ASSERT_DATA_EQUALS(long_string, sizeof(long_string), large_output,
+                         output_length);
+
+  const uint8_t short_string[] = {'a', 'b', 0, 0};
+  RecordingSink recorder5;
+  OLA_ASSERT_TRUE(plan->Unpack(short_string, sizeof(short_string),
+                               &recorder5));
+  output_length = sizeof(large_output);
+  OLA_ASSERT_TRUE(plan->Pack(&recorder5, large_output, &output_length));
+  OLA_ASSERT_DATA_EQUALS(short_string, sizeof(short_string), large_output,
+                         output_length);
+}
@@ -23,6 +23,8 @@
 
 #include "common/rdm/PidStoreLoader.h"
 #include "ola/StringUtils.h"
+#include "ola/base/Env.h"
+#include "ola/file/Util.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/stl/STLUtils.h"
@@ -120,7 +122,7 @@ const RootPidStore *RootPidStore::LoadFromDirectory(
   if (directory.empty()) {
     data_source = DataLocation();
   }
-  return loader.LoadFromDirectory(data_source, validate);
+  return loader.LoadFromDirectory(data_source, validate, CacheLocation());
 }
 
 const string RootPidStore::DataLocation() {
@@ -128,6 +130,18 @@ const string RootPidStore::DataLocation() {
   return PID_DATA_DIR;
 }
 
+const string RootPidStore::CacheLocation() {
+  string directory;
+  if (ola::GetEnv("XDG_CACHE_HOME", &directory) && !directory.empty()) {
+    return ola::file::JoinPaths(directory, "ola");
+  }
+  if (ola::GetEnv("HOME", &directory) && !directory.empty()) {
+    return ola::file::JoinPaths(ola::file::JoinPaths(directory, ".cache"),
+                                "ola");
+  }
+  return "";
+}
+
 PidStore::PidStore(const vector<const PidDescriptor*> &pids) {
   vector<const PidDescriptor*>::const_iterator iter = pids.begin();
   for (; iter != pids.end(); ++iter) {
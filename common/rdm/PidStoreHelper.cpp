@@ -41,6 +41,18 @@ PidStoreHelper::PidStoreHelper(const string &pid_location,
     : m_pid_location(pid_location.empty() ? RootPidStore::DataLocation() :
                      pid_location),
       m_root_store(NULL),
+      m_owns_store(true),
+      m_message_printer(initial_indent) {
+}
+
+
+/**
+ * @brief Set up a new PidStoreHelper object using an existing store.
+ */
+PidStoreHelper::PidStoreHelper(const RootPidStore *root_store,
+                               unsigned int initial_indent)
+    : m_root_store(root_store),
+      m_owns_store(false),
       m_message_printer(initial_indent) {
 }
 
@@ -49,7 +61,7 @@ PidStoreHelper::PidStoreHelper(const string &pid_location,
  * @brief Clean up
  */
 PidStoreHelper::~PidStoreHelper() {
-  if (m_root_store) {
+  if (m_owns_store && m_root_store) {
     delete m_root_store;
   }
 }
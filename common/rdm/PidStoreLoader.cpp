@@ -18,10 +18,25 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include <errno.h>
+#include <fcntl.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif  // HAVE_MMAP
+
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <set>
 #include <sstream>
 #include <string>
@@ -52,10 +67,54 @@ using std::vector;
 const char PidStoreLoader::OVERRIDE_FILE_NAME[] = "overrides.proto";
 const char PidStoreLoader::MANUFACTURER_NAMES_FILE_NAME[] =
     "manufacturer_names.proto";
+const char PidStoreLoader::CACHE_MAGIC[] = "OLAPIDS1";
 const uint16_t PidStoreLoader::ESTA_MANUFACTURER_ID = 0;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MIN = 0x8000;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MAX = 0xffe0;
 
+namespace {
+
+/*
+ * The cache for each directory has a different name, so one cache directory
+ * can hold the caches for more than one PID data directory.
+ */
+string CacheFileName(const string &directory) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  string::const_iterator iter = directory.begin();
+  for (; iter != directory.end(); ++iter) {
+    hash ^= static_cast<uint8_t>(*iter);
+    hash *= 16777619u;
+  }
+  std::ostringstream str;
+  str << "pids-" << std::hex << std::setfill('0') << std::setw(8) << hash
+      << ".cache";
+  return str.str();
+}
+
+/*
+ * Create a directory, and any missing parents.
+ */
+bool MakeDirectories(const string &directory) {
+#ifdef _WIN32
+  (void) directory;
+  return false;
+#else
+  struct stat dir_stat;
+  if (stat(directory.c_str(), &dir_stat) == 0) {
+    return S_ISDIR(dir_stat.st_mode);
+  }
+
+  size_t separator = directory.find_last_of(ola::file::PATH_SEPARATOR);
+  if (separator != string::npos && separator > 0 &&
+      !MakeDirectories(directory.substr(0, separator))) {
+    return false;
+  }
+  return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif  // _WIN32
+}
+}  // namespace
+
 const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
                                                  bool validate) {
   std::ifstream proto_file(file.data());
@@ -72,71 +131,36 @@ const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
 
 const RootPidStore *PidStoreLoader::LoadFromDirectory(
     const string &directory,
-    bool validate) {
-  vector<string> files;
-
-  string override_file;
-  string manufacturer_names_file;
-  vector<string> all_files;
-  if (!ola::file::ListDirectory(directory, &all_files)) {
-    OLA_WARN << "Failed to list files in " << directory;
-    return NULL;
-  }
-  if (all_files.empty()) {
-    OLA_WARN << "Didn't find any files in " << directory;
-    return NULL;
-  }
-  vector<string>::const_iterator file_iter = all_files.begin();
-  for (; file_iter != all_files.end(); ++file_iter) {
-    if (ola::file::FilenameFromPath(*file_iter) == OVERRIDE_FILE_NAME) {
-      override_file = *file_iter;
-    } else if (ola::file::FilenameFromPath(*file_iter) ==
-               MANUFACTURER_NAMES_FILE_NAME) {
-      manufacturer_names_file = *file_iter;
-    } else if (StringEndsWith(*file_iter, ".proto")) {
-      files.push_back(*file_iter);
-    }
-  }
-  if (files.empty() && override_file.empty()) {
-    OLA_WARN << "Didn't find any files to load in " << directory;
+    bool validate,
+    const string &cache_directory) {
+  ola::rdm::pid::CachedPidStore contents;
+  if (!StatFiles(directory, &contents)) {
     return NULL;
   }
 
-  ola::rdm::pid::PidStore pid_store_pb;
-  vector<string>::const_iterator iter = files.begin();
-  for (; iter != files.end(); ++iter) {
-    std::ifstream proto_file(iter->data());
-    if (!proto_file.is_open()) {
-      OLA_WARN << "Failed to open " << *iter << ": " << strerror(errno);
-      return NULL;
-    }
-
-    google::protobuf::io::IstreamInputStream input_stream(&proto_file);
-    bool ok = google::protobuf::TextFormat::Merge(&input_stream,
-                                                  &pid_store_pb);
-    proto_file.close();
-
-    if (!ok) {
-      OLA_WARN << "Failed to load " << *iter;
-      return NULL;
+  string cache_file;
+  if (!cache_directory.empty()) {
+    cache_file = ola::file::JoinPaths(cache_directory,
+                                      CacheFileName(directory));
+    ola::rdm::pid::CachedPidStore cached;
+    if (ReadCache(cache_file, contents, &cached)) {
+      OLA_DEBUG << "Using cached PID data from " << cache_file;
+      return BuildStore(cached.pids(), cached.overrides(),
+                        cached.manufacturer_names(), validate);
     }
   }
 
-  ola::rdm::pid::PidStore override_pb;
-  if (!override_file.empty()) {
-    if (!ReadFile(override_file, &override_pb)) {
-      return NULL;
-    }
+  if (!ReadDirectory(directory, &contents)) {
+    return NULL;
   }
 
-  ola::rdm::pid::PidStore manufacturer_names_pb;
-  if (!manufacturer_names_file.empty()) {
-    if (!ReadFile(manufacturer_names_file, &manufacturer_names_pb)) {
-      return NULL;
-    }
+  const RootPidStore *store = BuildStore(
+      contents.pids(), contents.overrides(), contents.manufacturer_names(),
+      validate);
+  if (store && !cache_file.empty()) {
+    WriteCache(cache_directory, cache_file, contents);
   }
-
-  return BuildStore(pid_store_pb, override_pb, manufacturer_names_pb, validate);
+  return store;
 }
 
 const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
@@ -170,6 +194,209 @@ bool PidStoreLoader::ReadFile(const std::string &file_path,
   return ok;
 }
 
+/*
+ * @brief Find the files to load from a directory, and record their sizes and
+ * modification times.
+ *
+ * The override and manufacturer names files are always last, so the order of
+ * the files doesn't depend on the order the directory is listed in.
+ */
+bool PidStoreLoader::StatFiles(const string &directory,
+                               ola::rdm::pid::CachedPidStore *contents) {
+  vector<string> all_files;
+  if (!ola::file::ListDirectory(directory, &all_files)) {
+    OLA_WARN << "Failed to list files in " << directory;
+    return false;
+  }
+  if (all_files.empty()) {
+    OLA_WARN << "Didn't find any files in " << directory;
+    return false;
+  }
+
+  vector<string> files;
+  string override_file;
+  string manufacturer_names_file;
+  vector<string>::const_iterator file_iter = all_files.begin();
+  for (; file_iter != all_files.end(); ++file_iter) {
+    const string file_name = ola::file::FilenameFromPath(*file_iter);
+    if (file_name == OVERRIDE_FILE_NAME) {
+      override_file = file_name;
+    } else if (file_name == MANUFACTURER_NAMES_FILE_NAME) {
+      manufacturer_names_file = file_name;
+    } else if (StringEndsWith(file_name, ".proto")) {
+      files.push_back(file_name);
+    }
+  }
+  if (files.empty() && override_file.empty()) {
+    OLA_WARN << "Didn't find any files to load in " << directory;
+    return false;
+  }
+
+  std::sort(files.begin(), files.end());
+  if (!override_file.empty()) {
+    files.push_back(override_file);
+  }
+  if (!manufacturer_names_file.empty()) {
+    files.push_back(manufacturer_names_file);
+  }
+
+  contents->set_directory(directory);
+  vector<string>::const_iterator iter = files.begin();
+  for (; iter != files.end(); ++iter) {
+    const string path = ola::file::JoinPaths(directory, *iter);
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat)) {
+      OLA_WARN << "Failed to stat " << path << ": " << strerror(errno);
+      return false;
+    }
+    ola::rdm::pid::CachedFile *file = contents->add_file();
+    file->set_name(*iter);
+    file->set_mtime(file_stat.st_mtime);
+    file->set_size(file_stat.st_size);
+  }
+  return true;
+}
+
+/*
+ * @brief Parse the files found by StatFiles().
+ */
+bool PidStoreLoader::ReadDirectory(const string &directory,
+                                   ola::rdm::pid::CachedPidStore *contents) {
+  for (int i = 0; i < contents->file_size(); ++i) {
+    const string &file_name = contents->file(i).name();
+    const string path = ola::file::JoinPaths(directory, file_name);
+
+    ola::rdm::pid::PidStore *proto = contents->mutable_pids();
+    if (file_name == OVERRIDE_FILE_NAME) {
+      proto = contents->mutable_overrides();
+    } else if (file_name == MANUFACTURER_NAMES_FILE_NAME) {
+      proto = contents->mutable_manufacturer_names();
+    }
+
+    if (!ReadFile(path, proto)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * @brief Read a cache file.
+ * @param cache_file the path to the cache file.
+ * @param expected the files the cache should have been built from.
+ * @param[out] contents the cached data.
+ * @returns true if the cache file exists and is up to date.
+ */
+bool PidStoreLoader::ReadCache(const string &cache_file,
+                               const ola::rdm::pid::CachedPidStore &expected,
+                               ola::rdm::pid::CachedPidStore *contents) {
+  const size_t magic_size = sizeof(CACHE_MAGIC) - 1;
+  bool ok = false;
+
+#ifdef HAVE_MMAP
+  int fd = open(cache_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) || file_stat.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  const size_t size = file_stat.st_size;
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    OLA_WARN << "Failed to map " << cache_file << ": " << strerror(errno);
+    return false;
+  }
+
+  const char *input = static_cast<const char*>(data);
+  ok = (size > magic_size && memcmp(input, CACHE_MAGIC, magic_size) == 0 &&
+        contents->ParsePartialFromArray(input + magic_size,
+                                        size - magic_size));
+  munmap(data, size);
+#else
+  std::ifstream cache(cache_file.c_str(), std::ios::in | std::ios::binary);
+  if (!cache.is_open()) {
+    return false;
+  }
+  std::ostringstream data;
+  data << cache.rdbuf();
+  const string input = data.str();
+  ok = (input.size() > magic_size &&
+        input.compare(0, magic_size, CACHE_MAGIC) == 0 &&
+        contents->ParsePartialFromArray(input.data() + magic_size,
+                                        input.size() - magic_size));
+#endif  // HAVE_MMAP
+
+  if (!ok) {
+    OLA_INFO << "Ignoring invalid PID cache " << cache_file;
+    return false;
+  }
+
+  if (contents->directory() != expected.directory() ||
+      contents->file_size() != expected.file_size()) {
+    return false;
+  }
+  for (int i = 0; i < expected.file_size(); ++i) {
+    const ola::rdm::pid::CachedFile &file = contents->file(i);
+    const ola::rdm::pid::CachedFile &expected_file = expected.file(i);
+    if (file.name() != expected_file.name() ||
+        file.mtime() != expected_file.mtime() ||
+        file.size() != expected_file.size()) {
+      OLA_DEBUG << "PID cache " << cache_file << " is out of date";
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * @brief Write a cache file.
+ *
+ * Failures aren't fatal, the PID data will be read from the text files next
+ * time.
+ */
+void PidStoreLoader::WriteCache(
+    const string &cache_directory,
+    const string &cache_file,
+    const ola::rdm::pid::CachedPidStore &contents) {
+  if (!MakeDirectories(cache_directory)) {
+    OLA_INFO << "Failed to create " << cache_directory << ": "
+             << strerror(errno);
+    return;
+  }
+
+  string data(CACHE_MAGIC, sizeof(CACHE_MAGIC) - 1);
+  if (!contents.AppendPartialToString(&data)) {
+    return;
+  }
+
+  // Write to a temporary file and rename it, so another process loading the
+  // PIDs never sees a partial file.
+  std::ostringstream temp_file;
+  temp_file << cache_file << "." << getpid();
+  std::ofstream out(temp_file.str().c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    OLA_INFO << "Failed to open " << temp_file.str() << ": "
+             << strerror(errno);
+    return;
+  }
+  out.write(data.data(), data.size());
+  out.close();
+
+  if (out.fail() || rename(temp_file.str().c_str(), cache_file.c_str())) {
+    OLA_INFO << "Failed to write " << cache_file;
+    unlink(temp_file.str().c_str());
+    return;
+  }
+  OLA_DEBUG << "Wrote PID cache " << cache_file;
+}
+
 /*
  * Build the RootPidStore from a protocol buffer.
  */
@@ -57,12 +57,17 @@ class PidStoreLoader {
    * @param directory the directory to load files from.
    * @param validate set to true if we should perform validation of the
    *   contents.
+   * @param cache_directory if not empty, the parsed files are cached in this
+   *   directory. Later loads of the same directory use the cache, until one
+   *   of the files is added, removed or modified.
    * @returns A pointer to a new RootPidStore or NULL if loading failed.
    *
    * This is an all-or-nothing load. Any error with cause us to abort the load.
    */
-  const RootPidStore *LoadFromDirectory(const std::string &directory,
-                                        bool validate = true);
+  const RootPidStore *LoadFromDirectory(
+      const std::string &directory,
+      bool validate = true,
+      const std::string &cache_directory = "");
 
   /**
    * @brief Load Pid information from a stream
@@ -82,6 +87,16 @@ class PidStoreLoader {
 
   bool ReadFile(const std::string &file_path,
                 ola::rdm::pid::PidStore *proto);
+  bool ReadDirectory(const std::string &directory,
+                     ola::rdm::pid::CachedPidStore *contents);
+  bool StatFiles(const std::string &directory,
+                 ola::rdm::pid::CachedPidStore *contents);
+  bool ReadCache(const std::string &cache_file,
+                 const ola::rdm::pid::CachedPidStore &expected,
+                 ola::rdm::pid::CachedPidStore *contents);
+  void WriteCache(const std::string &cache_directory,
+                  const std::string &cache_file,
+                  const ola::rdm::pid::CachedPidStore &contents);
 
   const RootPidStore *BuildStore(
       const ola::rdm::pid::PidStore &store_pb,
@@ -130,6 +145,7 @@ class PidStoreLoader {
 
   static const char OVERRIDE_FILE_NAME[];
   static const char MANUFACTURER_NAMES_FILE_NAME[];
+  static const char CACHE_MAGIC[];
   static const uint16_t ESTA_MANUFACTURER_ID;
   static const uint16_t MANUFACTURER_PID_MIN;
   static const uint16_t MANUFACTURER_PID_MAX;
@@ -19,7 +19,13 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -28,6 +34,7 @@
 #include "common/rdm/PidStoreLoader.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/file/Util.h"
 #include "ola/messaging/Descriptor.h"
 #include "ola/messaging/SchemaPrinter.h"
 #include "ola/rdm/PidStore.h"
@@ -56,6 +63,7 @@ class PidStoreTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testPidStoreLoad);
   CPPUNIT_TEST(testPidStoreFileLoad);
   CPPUNIT_TEST(testPidStoreDirectoryLoad);
+  CPPUNIT_TEST(testPidStoreCachedDirectoryLoad);
   CPPUNIT_TEST(testPidStoreLoadMissingFile);
   CPPUNIT_TEST(testPidStoreLoadDuplicateManufacturer);
   CPPUNIT_TEST(testPidStoreLoadDuplicateValue);
@@ -70,6 +78,7 @@ class PidStoreTest: public CppUnit::TestFixture {
   void testPidStoreLoad();
   void testPidStoreFileLoad();
   void testPidStoreDirectoryLoad();
+  void testPidStoreCachedDirectoryLoad();
   void testPidStoreLoadMissingFile();
   void testPidStoreLoadDuplicateManufacturer();
   void testPidStoreLoadDuplicateValue();
@@ -84,6 +93,12 @@ class PidStoreTest: public CppUnit::TestFixture {
     path.append(filename);
     return path;
   }
+
+  void CopyFile(const string &from, const string &to) {
+    std::ifstream in(from.c_str(), std::ios::in | std::ios::binary);
+    std::ofstream out(to.c_str(), std::ios::out | std::ios::binary);
+    out << in.rdbuf();
+  }
 };
 
 
@@ -443,6 +458,98 @@ void PidStoreTest::testPidStoreDirectoryLoad() {
 }
 
 
+/**
+ * Check that loading a directory with a cache works, and that the cache is
+ * rebuilt when the files change.
+ */
+void PidStoreTest::testPidStoreCachedDirectoryLoad() {
+  char temp_dir[] = "/tmp/ola-pid-test-XXXXXX";
+  OLA_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+  const string data_dir = string(temp_dir) + "/pids";
+  const string cache_dir = string(temp_dir) + "/cache";
+  OLA_ASSERT_EQ(0, mkdir(data_dir.c_str(), 0755));
+
+  const char *files[] = {
+    "manufacturer_names.proto",
+    "overrides.proto",
+    "pids1.proto",
+    "pids2.proto",
+  };
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    CopyFile(GetTestDataFile(string("pids/") + files[i]),
+             data_dir + "/" + files[i]);
+  }
+
+  // The first load writes the cache.
+  PidStoreLoader loader;
+  auto_ptr<const RootPidStore> root_store(
+      loader.LoadFromDirectory(data_dir, true, cache_dir));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_EQ(6u, root_store->EstaStore()->PidCount());
+
+  vector<string> cache_files;
+  OLA_ASSERT_TRUE(
+      ola::file::FindMatchingFiles(cache_dir, "pids-", &cache_files));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), cache_files.size());
+
+  // Replace a file with junk of the same size and modification time. The
+  // load still works since the cache is used.
+  const string pids2 = data_dir + "/pids2.proto";
+  struct stat file_stat;
+  OLA_ASSERT_EQ(0, stat(pids2.c_str(), &file_stat));
+  {
+    std::ofstream out(pids2.c_str(), std::ios::out | std::ios::trunc);
+    out << string(file_stat.st_size, '!');
+  }
+  struct utimbuf times;
+  times.actime = file_stat.st_atime;
+  times.modtime = file_stat.st_mtime;
+  OLA_ASSERT_EQ(0, utime(pids2.c_str(), &times));
+
+  root_store.reset(loader.LoadFromDirectory(data_dir, true, cache_dir));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1302986774), root_store->Version());
+  OLA_ASSERT_EQ(6u, root_store->EstaStore()->PidCount());
+  OLA_ASSERT_NOT_NULL(root_store->GetDescriptor("COMMS_STATUS"));
+
+  // Without the cache the junk is read.
+  OLA_ASSERT_NULL(loader.LoadFromDirectory(data_dir));
+  CopyFile(GetTestDataFile("pids/pids2.proto"), pids2);
+
+  // Removing the overrides invalidates the cache, so SERIAL_NUMBER is back.
+  OLA_ASSERT_EQ(0, unlink((data_dir + "/overrides.proto").c_str()));
+  root_store.reset(loader.LoadFromDirectory(data_dir, true, cache_dir));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  const PidStore *open_lighting_store =
+    root_store->ManufacturerStore(ola::OPEN_LIGHTING_ESTA_CODE);
+  OLA_ASSERT_NOT_NULL(open_lighting_store);
+  OLA_ASSERT_NOT_NULL(open_lighting_store->LookupPID("SERIAL_NUMBER"));
+  OLA_ASSERT_NULL(open_lighting_store->LookupPID("FOO_BAR"));
+
+  // A corrupt cache is ignored, and then replaced.
+  cache_files.clear();
+  OLA_ASSERT_TRUE(
+      ola::file::FindMatchingFiles(cache_dir, "pids-", &cache_files));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), cache_files.size());
+  {
+    std::ofstream out(cache_files[0].c_str(), std::ios::out | std::ios::trunc);
+    out << "OLAPIDS1 not a protobuf";
+  }
+  root_store.reset(loader.LoadFromDirectory(data_dir, true, cache_dir));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_NOT_NULL(
+      root_store->GetDescriptor("SERIAL_NUMBER", ola::OPEN_LIGHTING_ESTA_CODE));
+
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    unlink((data_dir + "/" + files[i]).c_str());
+  }
+  unlink(cache_files[0].c_str());
+  rmdir(data_dir.c_str());
+  rmdir(cache_dir.c_str());
+  rmdir(temp_dir);
+}
+
+
 /**
  * Check that loading a missing file fails.
  */
@@ -19,6 +19,8 @@
  */
 
 #include <string.h>
+#include <algorithm>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,6 +31,7 @@
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
 
 namespace ola {
 namespace rdm {
@@ -43,17 +46,16 @@ using std::vector;
 
 /*
  * A new QueueingRDMController. This takes another controller as a argument,
- * and ensures that we only send one request at a time.
+ * and limits the number of requests sent to it at once.
  */
 QueueingRDMController::QueueingRDMController(
     RDMControllerInterface *controller,
-    unsigned int max_queue_size)
+    unsigned int max_queue_size,
+    unsigned int max_outstanding_requests)
   : m_controller(controller),
     m_max_queue_size(max_queue_size),
-    m_rdm_request_pending(false),
-    m_active(true),
-    m_callback(ola::NewCallback(this,
-                                &QueueingRDMController::HandleRDMResponse)) {
+    m_max_outstanding_requests(std::max(max_outstanding_requests, 1u)),
+    m_active(true) {
 }
 
 
@@ -62,13 +64,24 @@ QueueingRDMController::QueueingRDMController(
  */
 QueueingRDMController::~QueueingRDMController() {
   // delete all outstanding requests
+  InFlightMap::iterator iter = m_in_flight.begin();
+  for (; iter != m_in_flight.end(); ++iter) {
+    outstanding_rdm_request &outstanding_request = iter->second->outstanding;
+    if (outstanding_request.on_complete) {
+      RunRDMCallback(outstanding_request.on_complete, RDM_FAILED_TO_SEND);
+    }
+    delete outstanding_request.request;
+    delete iter->second;
+  }
+  m_in_flight.clear();
+
   while (!m_pending_requests.empty()) {
     outstanding_rdm_request outstanding_request = m_pending_requests.front();
     if (outstanding_request.on_complete) {
       RunRDMCallback(outstanding_request.on_complete, RDM_FAILED_TO_SEND);
     }
     delete outstanding_request.request;
-    m_pending_requests.pop();
+    m_pending_requests.pop_front();
   }
 }
 
@@ -86,7 +99,7 @@ void QueueingRDMController::Pause() {
  */
 void QueueingRDMController::Resume() {
   m_active = true;
-  MaybeSendRDMRequest();
+  TakeNextAction();
 }
 
 
@@ -95,7 +108,7 @@ void QueueingRDMController::Resume() {
  */
 void QueueingRDMController::SendRDMRequest(RDMRequest *request,
                                            RDMCallback *on_complete) {
-  if (m_pending_requests.size() >= m_max_queue_size) {
+  if (m_pending_requests.size() + m_in_flight.size() >= m_max_queue_size) {
     OLA_WARN << "RDM Queue is full, dropping request";
     if (on_complete) {
       RunRDMCallback(on_complete, RDM_FAILED_TO_SEND);
@@ -107,7 +120,7 @@ void QueueingRDMController::SendRDMRequest(RDMRequest *request,
   outstanding_rdm_request outstanding_request;
   outstanding_request.request = request;
   outstanding_request.on_complete = on_complete;
-  m_pending_requests.push(outstanding_request);
+  m_pending_requests.push_back(outstanding_request);
   TakeNextAction();
 }
 
@@ -127,105 +140,136 @@ void QueueingRDMController::TakeNextAction() {
  * This method runs before we decide to send another request and allows sub
  * classes (like the DiscoverableQueueingRDMController) to insert other actions
  * into the queue.
- * @returns true if some other action is running, false otherwise.
+ * @returns true if some other action is running, or no more requests can be
+ *   sent, false otherwise.
  */
 bool QueueingRDMController::CheckForBlockingCondition() {
-  return !m_active || m_rdm_request_pending;
+  if (!m_active || m_in_flight.size() >= m_max_outstanding_requests) {
+    return true;
+  }
+  // A broadcast request is always sent on its own.
+  return (!m_in_flight.empty() &&
+          m_in_flight.begin()->first.IsBroadcast());
 }
 
 
 /*
- * If we're not paused, send the next request.
+ * Send the first request that can be sent now.
+ *
+ * A request can't be sent if there is already a request in flight for the
+ * same UID, or an earlier request for the UID is still queued. Nothing
+ * overtakes a queued broadcast request.
  */
 void QueueingRDMController::MaybeSendRDMRequest() {
-  if (m_pending_requests.empty())
+  std::set<UID> blocked_uids;
+  std::deque<outstanding_rdm_request>::iterator iter =
+      m_pending_requests.begin();
+  for (; iter != m_pending_requests.end(); ++iter) {
+    const UID &destination = iter->request->DestinationUID();
+    if (destination.IsBroadcast()) {
+      if (m_in_flight.empty()) {
+        break;
+      }
+      return;
+    }
+    if (!STLContains(m_in_flight, destination) &&
+        !STLContains(blocked_uids, destination)) {
+      break;
+    }
+    blocked_uids.insert(destination);
+  }
+
+  if (iter == m_pending_requests.end()) {
     return;
+  }
 
-  m_rdm_request_pending = true;
-  DispatchNextRequest();
+  InFlightRequest *in_flight = new InFlightRequest();
+  in_flight->outstanding = *iter;
+  m_pending_requests.erase(iter);
+  m_in_flight[in_flight->outstanding.request->DestinationUID()] = in_flight;
+  DispatchRequest(in_flight);
+
+  // Fill any remaining slots.
+  TakeNextAction();
 }
 
 
 /*
- * Send the next RDM request.
+ * Send a request to the underlying controller.
  */
-void QueueingRDMController::DispatchNextRequest() {
-  outstanding_rdm_request outstanding_request = m_pending_requests.front();
+void QueueingRDMController::DispatchRequest(InFlightRequest *in_flight) {
   // We have to make a copy here because we pass ownership of the request to
   // the underlying controller.
   // We need to have the original request because we use it if we receive an
   // ACK_OVERFLOW.
-  m_controller->SendRDMRequest(outstanding_request.request->Duplicate(),
-                               m_callback.get());
+  // Each request gets its own callback, so the reply is matched to the
+  // request even if the replies arrive out of order.
+  m_controller->SendRDMRequest(
+      in_flight->outstanding.request->Duplicate(),
+      NewSingleCallback(this, &QueueingRDMController::HandleRDMResponse,
+                        in_flight));
 }
 
 
 /*
  * Handle the response to a RemoteGet command
  */
-void QueueingRDMController::HandleRDMResponse(RDMReply *reply) {
-  m_rdm_request_pending = false;
-
-  if (m_pending_requests.empty()) {
-    OLA_FATAL << "Received a response but the queue was empty!";
-    return;
-  }
-
+void QueueingRDMController::HandleRDMResponse(InFlightRequest *in_flight,
+                                              RDMReply *reply) {
   bool was_ack_overflow = reply->StatusCode() == RDM_COMPLETED_OK &&
                           reply->Response() &&
                           reply->Response()->ResponseType() == ACK_OVERFLOW;
   // Check for ACK_OVERFLOW
-  if (m_response.get()) {
+  if (in_flight->response.get()) {
     if (reply->StatusCode() != RDM_COMPLETED_OK || reply->Response() == NULL) {
       // We failed part way through an ACK_OVERFLOW
-      m_frames.insert(m_frames.end(), reply->Frames().begin(),
-                      reply->Frames().end());
-      RDMReply new_reply(reply->StatusCode(), NULL, m_frames);
-      RunCallback(&new_reply);
-      m_response.reset();
-      m_frames.clear();
+      in_flight->frames.insert(in_flight->frames.end(),
+                               reply->Frames().begin(),
+                               reply->Frames().end());
+      RDMReply new_reply(reply->StatusCode(), NULL, in_flight->frames);
+      RunCallback(in_flight, &new_reply);
       TakeNextAction();
     } else {
       // Combine the data.
-      m_response.reset(RDMResponse::CombineResponses(
-          m_response.get(), reply->Response()));
-      m_frames.insert(m_frames.end(), reply->Frames().begin(),
-                      reply->Frames().end());
+      in_flight->response.reset(RDMResponse::CombineResponses(
+          in_flight->response.get(), reply->Response()));
+      in_flight->frames.insert(in_flight->frames.end(),
+                               reply->Frames().begin(),
+                               reply->Frames().end());
 
-      if (!m_response.get()) {
+      if (!in_flight->response.get()) {
         // The response was invalid
-        RDMReply new_reply(RDM_INVALID_RESPONSE, NULL, m_frames);
-        RunCallback(&new_reply);
-        m_frames.clear();
+        RDMReply new_reply(RDM_INVALID_RESPONSE, NULL, in_flight->frames);
+        RunCallback(in_flight, &new_reply);
         TakeNextAction();
       } else if (reply->Response()->ResponseType() != ACK_OVERFLOW) {
-        RDMReply new_reply(RDM_COMPLETED_OK, m_response.release(), m_frames);
-        RunCallback(&new_reply);
-        m_response.reset();
-        m_frames.clear();
+        RDMReply new_reply(RDM_COMPLETED_OK, in_flight->response.release(),
+                           in_flight->frames);
+        RunCallback(in_flight, &new_reply);
         TakeNextAction();
       } else {
-        DispatchNextRequest();
+        DispatchRequest(in_flight);
       }
       return;
     }
   } else if (was_ack_overflow) {
     // We're in an ACK_OVERFLOW sequence.
-    m_frames.clear();
-    m_response.reset(reply->Response()->Duplicate());
-    m_frames.insert(m_frames.end(), reply->Frames().begin(),
-                    reply->Frames().end());
-    DispatchNextRequest();
+    in_flight->response.reset(reply->Response()->Duplicate());
+    in_flight->frames.insert(in_flight->frames.end(), reply->Frames().begin(),
+                             reply->Frames().end());
+    DispatchRequest(in_flight);
   } else {
     // Just pass the RDMReply on.
-    RunCallback(reply);
+    RunCallback(in_flight, reply);
     TakeNextAction();
   }
 }
 
-void QueueingRDMController::RunCallback(RDMReply *reply) {
-  outstanding_rdm_request outstanding_request = m_pending_requests.front();
-  m_pending_requests.pop();
+void QueueingRDMController::RunCallback(InFlightRequest *in_flight,
+                                        RDMReply *reply) {
+  outstanding_rdm_request outstanding_request = in_flight->outstanding;
+  m_in_flight.erase(outstanding_request.request->DestinationUID());
+  delete in_flight;
   if (outstanding_request.on_complete) {
     outstanding_request.on_complete->Run(reply);
   }
@@ -238,8 +282,10 @@ void QueueingRDMController::RunCallback(RDMReply *reply) {
  */
 DiscoverableQueueingRDMController::DiscoverableQueueingRDMController(
         DiscoverableRDMControllerInterface *controller,
-        unsigned int max_queue_size)
-    : QueueingRDMController(controller, max_queue_size),
+        unsigned int max_queue_size,
+        unsigned int max_outstanding_requests)
+    : QueueingRDMController(controller, max_queue_size,
+                            max_outstanding_requests),
       m_discoverable_controller(controller) {
 }
 
@@ -272,10 +318,13 @@ void DiscoverableQueueingRDMController::TakeNextAction() {
     return;
 
   // prioritize discovery above RDM requests
-  if (!m_pending_discovery_callbacks.empty())
-    StartRDMDiscovery();
-  else
+  if (!m_pending_discovery_callbacks.empty()) {
+    // Discovery has to wait for the requests in flight to complete.
+    if (!RequestsInFlight())
+      StartRDMDiscovery();
+  } else {
     MaybeSendRDMRequest();
+  }
 }
 
 
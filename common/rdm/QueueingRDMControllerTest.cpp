@@ -84,6 +84,8 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testMultipleDiscovery);
   CPPUNIT_TEST(testReentrantDiscovery);
   CPPUNIT_TEST(testRequestAndDiscovery);
+  CPPUNIT_TEST(testPipelinedRequests);
+  CPPUNIT_TEST(testPipelinedDiscovery);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -102,11 +104,18 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
   void testMultipleDiscovery();
   void testReentrantDiscovery();
   void testRequestAndDiscovery();
+  void testPipelinedRequests();
+  void testPipelinedDiscovery();
 
   void VerifyResponse(RDMReply *expected_reply, RDMReply *reply) {
     OLA_ASSERT_EQ(*expected_reply, *reply);
   }
 
+  void RecordResponse(unsigned int id, RDMReply *reply) {
+    OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, reply->StatusCode());
+    m_completed.push_back(id);
+  }
+
   void VerifyDiscoveryComplete(UIDSet *expected_uids, const UIDSet &uids) {
     OLA_ASSERT_EQ(*expected_uids, uids);
     m_discovery_complete_count++;
@@ -121,6 +130,7 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
   UID m_source;
   UID m_destination;
   int m_discovery_complete_count;
+  vector<unsigned int> m_completed;
 
   static const uint8_t MOCK_FRAME_DATA[];
   static const uint8_t MOCK_FRAME_DATA2[];
@@ -851,3 +861,213 @@ void QueueingRDMControllerTest::testRequestAndDiscovery() {
   OLA_ASSERT_TRUE(m_discovery_complete_count);
   mock_controller.Verify();
 }
+
+
+/**
+ * A controller which can have many requests in flight. The replies are sent
+ * when the test calls Reply().
+ */
+class PipelinedRDMController
+    : public ola::rdm::DiscoverableRDMControllerInterface {
+ public:
+    PipelinedRDMController() : m_discovery_callback(NULL) {}
+
+    ~PipelinedRDMController() {
+      vector<SentRequest>::iterator iter = m_sent.begin();
+      for (; iter != m_sent.end(); ++iter) {
+        delete iter->request;
+      }
+    }
+
+    void SendRDMRequest(RDMRequest *request, RDMCallback *on_complete) {
+      SentRequest sent = {request, on_complete};
+      m_sent.push_back(sent);
+    }
+
+    void RunFullDiscovery(RDMDiscoveryCallback *callback) {
+      OLA_ASSERT_FALSE(m_discovery_callback);
+      m_discovery_callback = callback;
+    }
+
+    void RunIncrementalDiscovery(RDMDiscoveryCallback *callback) {
+      RunFullDiscovery(callback);
+    }
+
+    // The destinations of the requests in flight, in the order they were
+    // sent.
+    vector<UID> InFlight() const {
+      vector<UID> uids;
+      vector<SentRequest>::const_iterator iter = m_sent.begin();
+      for (; iter != m_sent.end(); ++iter) {
+        uids.push_back(iter->request->DestinationUID());
+      }
+      return uids;
+    }
+
+    bool DiscoveryRunning() const { return m_discovery_callback; }
+
+    void Reply(const UID &uid) {
+      vector<SentRequest>::iterator iter = m_sent.begin();
+      for (; iter != m_sent.end(); ++iter) {
+        if (iter->request->DestinationUID() == uid) {
+          break;
+        }
+      }
+      OLA_ASSERT_TRUE(iter != m_sent.end());
+      SentRequest sent = *iter;
+      m_sent.erase(iter);
+
+      RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                     NewGetResponse(uid, sent.request->SourceUID()));
+      delete sent.request;
+      sent.on_complete->Run(&reply);
+    }
+
+    void CompleteDiscovery() {
+      RDMDiscoveryCallback *callback = m_discovery_callback;
+      m_discovery_callback = NULL;
+      callback->Run(UIDSet());
+    }
+
+ private:
+    typedef struct {
+      RDMRequest *request;
+      RDMCallback *on_complete;
+    } SentRequest;
+
+    vector<SentRequest> m_sent;
+    RDMDiscoveryCallback *m_discovery_callback;
+};
+
+
+/**
+ * Check that requests to different responders are pipelined, and that the
+ * requests to a single responder stay in order.
+ */
+void QueueingRDMControllerTest::testPipelinedRequests() {
+  PipelinedRDMController mock_controller;
+  ola::rdm::QueueingRDMController controller(&mock_controller, 10, 3);
+
+  const UID uid_a(1, 10);
+  const UID uid_b(1, 11);
+  const UID uid_c(1, 12);
+  const UID uid_d(1, 13);
+  const UID uid_e(1, 14);
+  const UID broadcast = UID::AllDevices();
+
+  const UID destinations[] = {uid_a, uid_a, uid_b, uid_c, uid_d};
+  for (unsigned int i = 0; i < arraysize(destinations); i++) {
+    controller.SendRDMRequest(
+        NewGetRequest(m_source, destinations[i]),
+        ola::NewSingleCallback(this,
+                               &QueueingRDMControllerTest::RecordResponse,
+                               i));
+  }
+
+  // The second request to A waits behind the first one, D waits for a slot.
+  vector<UID> expected;
+  expected.push_back(uid_a);
+  expected.push_back(uid_b);
+  expected.push_back(uid_c);
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+
+  // The replies can arrive in any order.
+  mock_controller.Reply(uid_c);
+  expected.pop_back();
+  expected.push_back(uid_d);
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+
+  mock_controller.Reply(uid_a);
+  expected.erase(expected.begin());
+  expected.push_back(uid_a);
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+
+  // A broadcast waits for everything in flight, and nothing overtakes it.
+  controller.SendRDMRequest(
+      NewGetRequest(m_source, broadcast),
+      ola::NewSingleCallback(this, &QueueingRDMControllerTest::RecordResponse,
+                             5u));
+  controller.SendRDMRequest(
+      NewGetRequest(m_source, uid_e),
+      ola::NewSingleCallback(this, &QueueingRDMControllerTest::RecordResponse,
+                             6u));
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+
+  mock_controller.Reply(uid_b);
+  mock_controller.Reply(uid_d);
+  mock_controller.Reply(uid_a);
+  expected.clear();
+  expected.push_back(broadcast);
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+
+  mock_controller.Reply(broadcast);
+  expected.clear();
+  expected.push_back(uid_e);
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+  mock_controller.Reply(uid_e);
+
+  const unsigned int expected_order[] = {3, 0, 2, 4, 1, 5, 6};
+  OLA_ASSERT_TRUE(
+      vector<unsigned int>(expected_order,
+                           expected_order + arraysize(expected_order)) ==
+      m_completed);
+}
+
+
+/**
+ * Check that discovery waits for the requests in flight to complete, and
+ * holds back any new requests.
+ */
+void QueueingRDMControllerTest::testPipelinedDiscovery() {
+  PipelinedRDMController mock_controller;
+  ola::rdm::DiscoverableQueueingRDMController controller(&mock_controller, 10,
+                                                         2);
+  const UID uid_a(1, 10);
+  const UID uid_b(1, 11);
+  const UID uid_c(1, 12);
+
+  controller.SendRDMRequest(
+      NewGetRequest(m_source, uid_a),
+      ola::NewSingleCallback(this, &QueueingRDMControllerTest::RecordResponse,
+                             0u));
+
+  UIDSet uids;
+  controller.RunFullDiscovery(
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyDiscoveryComplete,
+          &uids));
+  controller.SendRDMRequest(
+      NewGetRequest(m_source, uid_b),
+      ola::NewSingleCallback(this, &QueueingRDMControllerTest::RecordResponse,
+                             1u));
+
+  // B isn't sent, even though there's a free slot.
+  OLA_ASSERT_EQ(static_cast<size_t>(1), mock_controller.InFlight().size());
+  OLA_ASSERT_FALSE(mock_controller.DiscoveryRunning());
+
+  mock_controller.Reply(uid_a);
+  OLA_ASSERT_TRUE(mock_controller.DiscoveryRunning());
+  OLA_ASSERT_TRUE(mock_controller.InFlight().empty());
+
+  controller.SendRDMRequest(
+      NewGetRequest(m_source, uid_c),
+      ola::NewSingleCallback(this, &QueueingRDMControllerTest::RecordResponse,
+                             2u));
+  OLA_ASSERT_TRUE(mock_controller.InFlight().empty());
+
+  mock_controller.CompleteDiscovery();
+  OLA_ASSERT_EQ(1, m_discovery_complete_count);
+  vector<UID> expected;
+  expected.push_back(uid_b);
+  expected.push_back(uid_c);
+  OLA_ASSERT_TRUE(expected == mock_controller.InFlight());
+
+  mock_controller.Reply(uid_c);
+  mock_controller.Reply(uid_b);
+  const unsigned int expected_order[] = {0, 2, 1};
+  OLA_ASSERT_TRUE(
+      vector<unsigned int>(expected_order,
+                           expected_order + arraysize(expected_order)) ==
+      m_completed);
+}
@@ -46,6 +46,117 @@ using ola::SingleUseCallback4;
 using ola::network::HostToNetwork;
 using ola::network::NetworkToHost;
 
+namespace {
+
+/*
+ * Tracks the state of a batch of GETs. This deletes itself once all the
+ * requests have completed.
+ */
+class ParameterBatch {
+ public:
+  ParameterBatch(RDMAPIImplInterface *impl,
+                 const vector<ParameterRequest> &requests,
+                 unsigned int max_in_flight_per_universe,
+                 RDMAPI::ParameterBatchCallback *callback)
+      : m_impl(impl),
+        m_max_in_flight(std::max(1u, max_in_flight_per_universe)),
+        m_callback(callback),
+        m_remaining(requests.size()),
+        m_send_depth(0) {
+    m_responses.reserve(requests.size());
+    for (unsigned int i = 0; i < requests.size(); i++) {
+      m_responses.push_back(ParameterResponse(requests[i]));
+      m_universes[requests[i].universe].pending.push_back(i);
+    }
+  }
+
+  void Start() {
+    map<unsigned int, UniverseState>::iterator iter = m_universes.begin();
+    for (; iter != m_universes.end(); ++iter) {
+      SendRequests(&iter->second);
+    }
+    MaybeComplete();
+  }
+
+ private:
+  struct UniverseState {
+    UniverseState() : next(0), in_flight(0) {}
+
+    vector<unsigned int> pending;
+    unsigned int next;
+    unsigned int in_flight;
+  };
+
+  RDMAPIImplInterface *m_impl;
+  const unsigned int m_max_in_flight;
+  RDMAPI::ParameterBatchCallback *m_callback;
+  vector<ParameterResponse> m_responses;
+  map<unsigned int, UniverseState> m_universes;
+  unsigned int m_remaining;
+  // Non-zero while we're sending, since the impl may run the callback
+  // before RDMGet() returns.
+  unsigned int m_send_depth;
+
+  void SendRequests(UniverseState *state) {
+    m_send_depth++;
+    while (state->in_flight < m_max_in_flight &&
+           state->next < state->pending.size()) {
+      unsigned int index = state->pending[state->next++];
+      const ParameterRequest &request = m_responses[index].request;
+
+      string error;
+      if (request.uid.IsBroadcast()) {
+        error = "Cannot send to broadcast address";
+      } else if (request.sub_device > 0x0200) {
+        error = "Sub device must be <= 0x0200";
+      }
+
+      if (error.empty()) {
+        state->in_flight++;
+        RDMAPIImplInterface::rdm_callback *cb = NewSingleCallback(
+            this, &ParameterBatch::HandleResponse, state, index);
+        if (!m_impl->RDMGet(
+                cb, request.universe, request.uid, request.sub_device,
+                request.pid,
+                reinterpret_cast<const uint8_t*>(request.data.data()),
+                request.data.size())) {
+          state->in_flight--;
+          error = "Unable to send RDM command";
+        }
+      }
+
+      if (!error.empty()) {
+        m_responses[index].status.error = error;
+        m_remaining--;
+      }
+    }
+    m_send_depth--;
+  }
+
+  void HandleResponse(UniverseState *state,
+                      unsigned int index,
+                      const ResponseStatus &status,
+                      const string &data) {
+    m_responses[index].status = status;
+    m_responses[index].data = data;
+    state->in_flight--;
+    m_remaining--;
+    SendRequests(state);
+    MaybeComplete();
+  }
+
+  void MaybeComplete() {
+    if (m_send_depth || m_remaining) {
+      return;
+    }
+    m_callback->Run(m_responses);
+    delete this;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ParameterBatch);
+};
+}  // namespace
+
 
 /*
  * @brief Return the number of queues messages for a UID. Note that this is
@@ -62,6 +173,34 @@ uint8_t RDMAPI::OutstandingMessagesCount(const UID &uid) {
 }
 
 
+/*
+ * @brief GET a list of parameters, and run the callback once they've all
+ * completed.
+ * @param requests the parameters to fetch.
+ * @param max_in_flight_per_universe the maximum number of outstanding requests
+ *   for each universe. Universes are independent, so requests to different
+ *   universes proceed in parallel.
+ * @param callback the callback to run, this is passed a ParameterResponse for
+ *   each request, in the same order as the requests.
+ * @param error a pointer to a string which is set if an error occurs
+ * @return false if an error occurred, true otherwise
+ *
+ * Requests that can't be sent have the error field of the ResponseStatus set.
+ */
+bool RDMAPI::GetParameters(const vector<ParameterRequest> &requests,
+                           unsigned int max_in_flight_per_universe,
+                           ParameterBatchCallback *callback,
+                           string *error) {
+  if (CheckCallback(error, callback))
+    return false;
+
+  ParameterBatch *batch = new ParameterBatch(
+      m_impl, requests, max_in_flight_per_universe, callback);
+  batch->Start();
+  return true;
+}
+
+
 /*
  * @brief Fetch a count of the proxied devices
  * @param universe the universe to perform the call on
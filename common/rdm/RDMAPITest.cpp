@@ -35,6 +35,8 @@
 
 using ola::NewSingleCallback;
 using ola::network::HostToNetwork;
+using ola::rdm::ParameterRequest;
+using ola::rdm::ParameterResponse;
 using ola::rdm::RDMAPI;
 using ola::rdm::ResponseStatus;
 using ola::rdm::ResponseStatus;
@@ -98,18 +100,21 @@ class MockRDMAPIImpl: public ola::rdm::RDMAPIImplInterface {
       OLA_ASSERT_EQ(result->sub_device, sub_device);
       OLA_ASSERT_EQ(result->pid, pid);
 
-      (void) data;
-      (void) data_length;
+      if (result->data) {
+        OLA_ASSERT_EQ(result->data_length, data_length);
+        OLA_ASSERT_EQ(0, memcmp(result->data, data, data_length));
+      }
 
       ResponseStatus status;
       status.response_code = uid.IsBroadcast() ? ola::rdm::RDM_WAS_BROADCAST:
         ola::rdm::RDM_COMPLETED_OK;
       status.response_type = ola::rdm::RDM_ACK;
       status.message_count = 0;
+      // pop first, the callback may send another request
+      m_get_expected.pop_front();
       callback->Run(status, result->return_data);
 
       delete result;
-      m_get_expected.pop_front();
       return true;
     }
 
@@ -227,6 +232,7 @@ class RDMAPITest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRDMInformation);
   CPPUNIT_TEST(testProductInformation);
   CPPUNIT_TEST(testDmxSetup);
+  CPPUNIT_TEST(testGetParameters);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -243,6 +249,7 @@ class RDMAPITest: public CppUnit::TestFixture {
     void testRDMInformation();
     void testProductInformation();
     void testDmxSetup();
+    void testGetParameters();
     void setUp() {}
     void tearDown();
 
@@ -402,6 +409,11 @@ class RDMAPITest: public CppUnit::TestFixture {
       CheckResponseStatus(status);
       OLA_ASSERT_EQ(static_cast<uint16_t>(44), start_address);
     }
+
+    void StoreParameters(vector<ParameterResponse> *output,
+                         const vector<ParameterResponse> &responses) {
+      *output = responses;
+    }
 };
 
 const char RDMAPITest::BROADCAST_ERROR[] = "Cannot send to broadcast address";
@@ -1105,3 +1117,90 @@ void RDMAPITest::testDmxSetup() {
     &error));
   CheckForDeviceRangeBcastError(&error);
 }
+
+
+/*
+ * Check that batched GETs work.
+ */
+void RDMAPITest::testGetParameters() {
+  string error;
+  vector<ParameterResponse> responses;
+
+  // an empty batch completes immediately
+  vector<ParameterRequest> requests;
+  OLA_ASSERT_TRUE(m_api.GetParameters(
+      requests, 2,
+      NewSingleCallback(this, &RDMAPITest::StoreParameters, &responses),
+      &error));
+  OLA_ASSERT_TRUE(responses.empty());
+
+  OLA_ASSERT_FALSE(m_api.GetParameters(requests, 2, NULL, &error));
+  OLA_ASSERT_FALSE(error.empty());
+  error.clear();
+
+  requests.push_back(ParameterRequest(UNIVERSE, m_uid,
+                                      ola::rdm::ROOT_RDM_DEVICE,
+                                      ola::rdm::PID_DEVICE_LABEL));
+  requests.push_back(ParameterRequest(UNIVERSE, m_bcast_uid,
+                                      ola::rdm::ROOT_RDM_DEVICE,
+                                      ola::rdm::PID_DEVICE_LABEL));
+  requests.push_back(ParameterRequest(UNIVERSE, m_uid, 0x0201,
+                                      ola::rdm::PID_DEVICE_LABEL));
+  requests.push_back(ParameterRequest(UNIVERSE + 1, m_test_uid1, 1,
+                                      ola::rdm::PID_DMX_START_ADDRESS));
+  requests.push_back(ParameterRequest(UNIVERSE, m_test_uid2,
+                                      ola::rdm::ROOT_RDM_DEVICE,
+                                      ola::rdm::PID_SOFTWARE_VERSION_LABEL));
+
+  // requests are sent in order for each universe
+  m_impl.AddExpectedGet("label", UNIVERSE, m_uid, ola::rdm::ROOT_RDM_DEVICE,
+                        ola::rdm::PID_DEVICE_LABEL);
+  m_impl.AddExpectedGet("version", UNIVERSE, m_test_uid2,
+                        ola::rdm::ROOT_RDM_DEVICE,
+                        ola::rdm::PID_SOFTWARE_VERSION_LABEL);
+  m_impl.AddExpectedGet("ab", UNIVERSE + 1, m_test_uid1, 1,
+                        ola::rdm::PID_DMX_START_ADDRESS);
+
+  OLA_ASSERT_TRUE(m_api.GetParameters(
+      requests, 1,
+      NewSingleCallback(this, &RDMAPITest::StoreParameters, &responses),
+      &error));
+  OLA_ASSERT_TRUE(error.empty());
+
+  // the responses are in the same order as the requests
+  OLA_ASSERT_EQ(static_cast<size_t>(5), responses.size());
+  for (unsigned int i = 0; i < responses.size(); i++) {
+    OLA_ASSERT_EQ(requests[i].universe, responses[i].request.universe);
+    OLA_ASSERT_EQ(requests[i].uid, responses[i].request.uid);
+    OLA_ASSERT_EQ(requests[i].sub_device, responses[i].request.sub_device);
+    OLA_ASSERT_EQ(requests[i].pid, responses[i].request.pid);
+  }
+
+  OLA_ASSERT_TRUE(responses[0].status.WasAcked());
+  OLA_ASSERT_EQ(string("label"), responses[0].data);
+  OLA_ASSERT_EQ(string(BROADCAST_ERROR), responses[1].status.error);
+  OLA_ASSERT_EQ(string(DEVICE_RANGE_ERROR), responses[2].status.error);
+  OLA_ASSERT_TRUE(responses[3].status.WasAcked());
+  OLA_ASSERT_EQ(string("ab"), responses[3].data);
+  OLA_ASSERT_TRUE(responses[4].status.WasAcked());
+  OLA_ASSERT_EQ(string("version"), responses[4].data);
+
+  // parameter data is sent with the GET
+  requests.clear();
+  responses.clear();
+  uint8_t personality = 2;
+  requests.push_back(ParameterRequest(
+      UNIVERSE, m_uid, ola::rdm::ROOT_RDM_DEVICE,
+      ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+      string(reinterpret_cast<char*>(&personality), sizeof(personality))));
+  m_impl.AddExpectedGet("mode 2", UNIVERSE, m_uid, ola::rdm::ROOT_RDM_DEVICE,
+                        ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+                        &personality, sizeof(personality));
+  OLA_ASSERT_TRUE(m_api.GetParameters(
+      requests, 2,
+      NewSingleCallback(this, &RDMAPITest::StoreParameters, &responses),
+      &error));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), responses.size());
+  OLA_ASSERT_EQ(string(1, 2), responses[0].request.data);
+  OLA_ASSERT_EQ(string("mode 2"), responses[0].data);
+}
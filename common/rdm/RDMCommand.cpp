@@ -215,6 +215,12 @@ RDMStatusCode RDMCommand::VerifyData(const uint8_t *data,
   }
 
   unsigned int message_length = command_header->message_length;
+  if (message_length < sizeof(RDMCommandHeader) + 1) {
+    OLA_WARN << "RDM message length " << message_length
+             << " is smaller than the header";
+    return RDM_PACKET_LENGTH_MISMATCH;
+  }
+
   if (length < message_length + 1) {
     OLA_WARN << "RDM message is too small, needs to be "
              << message_length + 1 << ", was " << length;
@@ -0,0 +1,195 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RDMCommandView.cpp
+ * A read only view of an RDM message in a buffer.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "ola/rdm/RDMCommandView.h"
+
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMFrame.h"
+#include "ola/rdm/RDMPacket.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/util/Utils.h"
+
+namespace ola {
+namespace rdm {
+
+using ola::utils::JoinUInt8;
+
+RDMStatusCode RDMCommandView::Parse(const uint8_t *data,
+                                    unsigned int length) {
+  Reset();
+
+  if (!data) {
+    return RDM_INVALID_RESPONSE;
+  }
+
+  if (length < sizeof(RDMCommandHeader)) {
+    return RDM_PACKET_TOO_SHORT;
+  }
+
+  // RDMCommandHeader is made up of uint8_t's so there are no alignment
+  // requirements.
+  const RDMCommandHeader *header =
+      reinterpret_cast<const RDMCommandHeader*>(data);
+
+  if (header->sub_start_code != SUB_START_CODE) {
+    return RDM_WRONG_SUB_START_CODE;
+  }
+
+  // The message length includes the start code but not the checksum.
+  unsigned int message_length = header->message_length;
+  if (message_length < sizeof(RDMCommandHeader) + 1 ||
+      length < message_length + 1) {
+    return RDM_PACKET_LENGTH_MISMATCH;
+  }
+
+  uint16_t checksum = RDMCommand::CalculateChecksum(data, message_length - 1);
+  if (JoinUInt8(data[message_length - 1], data[message_length]) != checksum) {
+    return RDM_CHECKSUM_INCORRECT;
+  }
+
+  if (header->param_data_length >
+      message_length - sizeof(RDMCommandHeader) - 1) {
+    return RDM_PARAM_LENGTH_MISMATCH;
+  }
+
+  m_data = data;
+  m_header = header;
+  return RDM_COMPLETED_OK;
+}
+
+RDMStatusCode RDMCommandView::Parse(const RDMFrame &frame) {
+  Reset();
+  if (frame.data.empty()) {
+    return RDM_PACKET_TOO_SHORT;
+  }
+  if (frame.data[0] != START_CODE) {
+    return RDM_INVALID_RESPONSE;
+  }
+  return Parse(frame.data.data() + 1, frame.data.size() - 1);
+}
+
+bool RDMCommandView::IsRequest() const {
+  switch (m_header->command_class) {
+    case RDMCommand::GET_COMMAND:
+    case RDMCommand::SET_COMMAND:
+    case RDMCommand::DISCOVER_COMMAND:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool RDMCommandView::IsResponse() const {
+  switch (m_header->command_class) {
+    case RDMCommand::GET_COMMAND_RESPONSE:
+    case RDMCommand::SET_COMMAND_RESPONSE:
+    case RDMCommand::DISCOVER_COMMAND_RESPONSE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool RDMCommandView::IsDUB() const {
+  return (m_header->command_class == RDMCommand::DISCOVER_COMMAND &&
+          ParamId() == PID_DISC_UNIQUE_BRANCH);
+}
+
+RDMStatusCode RDMCommandView::VerifyResponse(
+    const RDMRequest *request) const {
+  if (request) {
+    if (request->SourceUID() != DestinationUID()) {
+      return RDM_DEST_UID_MISMATCH;
+    }
+
+    if (request->DestinationUID() != SourceUID()) {
+      return RDM_SRC_UID_MISMATCH;
+    }
+
+    if (request->TransactionNumber() != TransactionNumber()) {
+      return RDM_TRANSACTION_MISMATCH;
+    }
+
+    // Ignore the sub device if the request was for all sub devices or
+    // QUEUED_MESSAGE.
+    if (request->SubDevice() != SubDevice() &&
+        request->SubDevice() != ALL_RDM_SUBDEVICES &&
+        request->ParamId() != PID_QUEUED_MESSAGE) {
+      return RDM_SUB_DEVICE_MISMATCH;
+    }
+
+    RDMCommand::RDMCommandClass command_class = CommandClass();
+    switch (request->CommandClass()) {
+      case RDMCommand::GET_COMMAND:
+        if (command_class != RDMCommand::GET_COMMAND_RESPONSE &&
+            request->ParamId() != PID_QUEUED_MESSAGE) {
+          return RDM_COMMAND_CLASS_MISMATCH;
+        }
+        break;
+      case RDMCommand::SET_COMMAND:
+        if (command_class != RDMCommand::SET_COMMAND_RESPONSE) {
+          return RDM_COMMAND_CLASS_MISMATCH;
+        }
+        break;
+      case RDMCommand::DISCOVER_COMMAND:
+        if (command_class != RDMCommand::DISCOVER_COMMAND_RESPONSE) {
+          return RDM_COMMAND_CLASS_MISMATCH;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (PortIdResponseType() > ACK_OVERFLOW) {
+    return RDM_INVALID_RESPONSE_TYPE;
+  }
+
+  if (!IsResponse()) {
+    return RDM_INVALID_COMMAND_CLASS;
+  }
+  return RDM_COMPLETED_OK;
+}
+
+RDMRequest *RDMCommandView::ToRequest() const {
+  if (!IsValid() || !IsRequest()) {
+    return NULL;
+  }
+  return RDMRequest::InflateFromData(m_data, MessageLength() + 1);
+}
+
+RDMResponse *RDMCommandView::ToResponse() const {
+  if (!IsValid() || !IsResponse()) {
+    return NULL;
+  }
+  RDMStatusCode status_code;
+  return RDMResponse::InflateFromData(m_data, MessageLength() + 1,
+                                      &status_code);
+}
+
+RDMCommand *RDMCommandView::ToCommand() const {
+  if (!IsValid()) {
+    return NULL;
+  }
+  return RDMCommand::Inflate(m_data, MessageLength() + 1);
+}
+}  // namespace rdm
+}  // namespace ola
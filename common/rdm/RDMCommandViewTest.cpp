@@ -0,0 +1,365 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RDMCommandViewTest.cpp
+ * Test fixture for the RDMCommandView class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/base/Array.h"
+#include "ola/io/ByteString.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMCommandSerializer.h"
+#include "ola/rdm/RDMCommandView.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMFrame.h"
+#include "ola/rdm/RDMPacket.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/rdm/UID.h"
+#include "ola/util/Utils.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::io::ByteString;
+using ola::rdm::RDMCommand;
+using ola::rdm::RDMCommandSerializer;
+using ola::rdm::RDMCommandView;
+using ola::rdm::RDMDiscoveryRequest;
+using ola::rdm::RDMFrame;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using ola::utils::SplitUInt16;
+using std::auto_ptr;
+
+namespace {
+/*
+ * Recalculate the checksum of a packed message.
+ */
+void SetChecksum(ByteString *data) {
+  unsigned int checksum = ola::rdm::START_CODE;
+  for (unsigned int i = 0 ; i < data->size() - 2; i++) {
+    checksum += (*data)[i];
+  }
+  SplitUInt16(checksum, &data->at(data->size() - 2),
+              &data->at(data->size() - 1));
+}
+}  // namespace
+
+
+class RDMCommandViewTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMCommandViewTest);
+  CPPUNIT_TEST(testRequest);
+  CPPUNIT_TEST(testFrame);
+  CPPUNIT_TEST(testResponse);
+  CPPUNIT_TEST(testDiscovery);
+  CPPUNIT_TEST(testInvalidData);
+  CPPUNIT_TEST(testVerifyResponse);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMCommandViewTest()
+      : m_source(1, 2),
+        m_destination(3, 4) {
+  }
+
+  void testRequest();
+  void testFrame();
+  void testResponse();
+  void testDiscovery();
+  void testInvalidData();
+  void testVerifyResponse();
+
+ private:
+  UID m_source;
+  UID m_destination;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMCommandViewTest);
+
+
+/*
+ * Check a view of a request.
+ */
+void RDMCommandViewTest::testRequest() {
+  const uint8_t param_data[] = {0xa5, 0xa5, 0xa5, 0xa5};
+  RDMSetRequest request(m_source, m_destination, 1, 2, 10, 296, param_data,
+                        sizeof(param_data));
+  ByteString data;
+  OLA_ASSERT_TRUE(RDMCommandSerializer::Pack(request, &data));
+
+  RDMCommandView view;
+  OLA_ASSERT_FALSE(view.IsValid());
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_TRUE(view.IsValid());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::SUB_START_CODE),
+                view.SubStartCode());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(28), view.MessageLength());
+  OLA_ASSERT_EQ(m_source, view.SourceUID());
+  OLA_ASSERT_EQ(m_destination, view.DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), view.TransactionNumber());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), view.PortIdResponseType());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), view.MessageCount());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(10), view.SubDevice());
+  OLA_ASSERT_EQ(RDMCommand::SET_COMMAND, view.CommandClass());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(296), view.ParamId());
+  OLA_ASSERT_TRUE(view.IsRequest());
+  OLA_ASSERT_FALSE(view.IsResponse());
+  OLA_ASSERT_FALSE(view.IsDUB());
+
+  // The param data isn't copied.
+  OLA_ASSERT_EQ(data.data() + sizeof(ola::rdm::RDMCommandHeader),
+                view.ParamData());
+  OLA_ASSERT_DATA_EQUALS(param_data, sizeof(param_data),
+                         view.ParamData(), view.ParamDataSize());
+
+  auto_ptr<RDMRequest> owned(view.ToRequest());
+  OLA_ASSERT_NOT_NULL(owned.get());
+  OLA_ASSERT_TRUE(request == *owned);
+
+  auto_ptr<RDMCommand> command(view.ToCommand());
+  OLA_ASSERT_NOT_NULL(command.get());
+  OLA_ASSERT_EQ(RDMCommand::SET_COMMAND, command->CommandClass());
+
+  OLA_ASSERT_NULL(view.ToResponse());
+  OLA_ASSERT_EQ(ola::rdm::RDM_INVALID_COMMAND_CLASS,
+                view.VerifyResponse(NULL));
+
+  view.Reset();
+  OLA_ASSERT_FALSE(view.IsValid());
+  OLA_ASSERT_NULL(view.ToRequest());
+  OLA_ASSERT_NULL(view.ToCommand());
+}
+
+
+/*
+ * Check parsing an RDMFrame.
+ */
+void RDMCommandViewTest::testFrame() {
+  RDMGetRequest request(m_source, m_destination, 0, 1, 0, 296, NULL, 0);
+  ByteString data;
+  OLA_ASSERT_TRUE(RDMCommandSerializer::PackWithStartCode(request, &data));
+
+  RDMFrame frame(data);
+  RDMCommandView view;
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.Parse(frame));
+  OLA_ASSERT_EQ(RDMCommand::GET_COMMAND, view.CommandClass());
+  OLA_ASSERT_EQ(0u, view.ParamDataSize());
+  OLA_ASSERT_EQ(frame.data.data() + 1 + sizeof(ola::rdm::RDMCommandHeader),
+                view.ParamData());
+
+  // Wrong start code
+  frame.data[0] = 0xcd;
+  OLA_ASSERT_EQ(ola::rdm::RDM_INVALID_RESPONSE, view.Parse(frame));
+  OLA_ASSERT_FALSE(view.IsValid());
+
+  RDMFrame empty_frame(NULL, 0);
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_TOO_SHORT, view.Parse(empty_frame));
+}
+
+
+/*
+ * Check a view of a response.
+ */
+void RDMCommandViewTest::testResponse() {
+  RDMGetRequest request(m_source, m_destination, 5, 1, 0, 296, NULL, 0);
+  const uint8_t param_data[] = {0x12, 0x34};
+  auto_ptr<RDMResponse> response(
+      GetResponseFromData(&request, param_data, sizeof(param_data)));
+
+  ByteString data;
+  OLA_ASSERT_TRUE(RDMCommandSerializer::Pack(*response, &data));
+
+  RDMCommandView view;
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_TRUE(view.IsResponse());
+  OLA_ASSERT_FALSE(view.IsRequest());
+  OLA_ASSERT_EQ(RDMCommand::GET_COMMAND_RESPONSE, view.CommandClass());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::RDM_ACK),
+                view.PortIdResponseType());
+  OLA_ASSERT_DATA_EQUALS(param_data, sizeof(param_data),
+                         view.ParamData(), view.ParamDataSize());
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.VerifyResponse(NULL));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.VerifyResponse(&request));
+
+  OLA_ASSERT_NULL(view.ToRequest());
+  auto_ptr<RDMResponse> owned(view.ToResponse());
+  OLA_ASSERT_NOT_NULL(owned.get());
+  OLA_ASSERT_TRUE(*response == *owned);
+
+  // An invalid response type can't be converted.
+  data[15] = 0x04;
+  SetChecksum(&data);
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_EQ(ola::rdm::RDM_INVALID_RESPONSE_TYPE,
+                view.VerifyResponse(NULL));
+  OLA_ASSERT_NULL(view.ToResponse());
+}
+
+
+/*
+ * Check DUB detection.
+ */
+void RDMCommandViewTest::testDiscovery() {
+  auto_ptr<RDMDiscoveryRequest> request(
+      NewDiscoveryUniqueBranchRequest(m_source, UID(0, 0), UID::AllDevices(),
+                                      1));
+  ByteString data;
+  OLA_ASSERT_TRUE(RDMCommandSerializer::Pack(*request, &data));
+
+  RDMCommandView view;
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_TRUE(view.IsRequest());
+  OLA_ASSERT_TRUE(view.IsDUB());
+
+  auto_ptr<RDMRequest> owned(view.ToRequest());
+  OLA_ASSERT_NOT_NULL(owned.get());
+  OLA_ASSERT_TRUE(owned->IsDUB());
+
+  auto_ptr<RDMDiscoveryRequest> mute(
+      NewMuteRequest(m_source, m_destination, 2));
+  data.clear();
+  OLA_ASSERT_TRUE(RDMCommandSerializer::Pack(*mute, &data));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_TRUE(view.IsRequest());
+  OLA_ASSERT_FALSE(view.IsDUB());
+}
+
+
+/*
+ * Check that invalid data is rejected.
+ */
+void RDMCommandViewTest::testInvalidData() {
+  RDMCommandView view;
+  OLA_ASSERT_EQ(ola::rdm::RDM_INVALID_RESPONSE, view.Parse(NULL, 0));
+
+  const uint8_t param_data[] = {0x01, 0x02, 0x03};
+  RDMSetRequest request(m_source, m_destination, 1, 1, 0, 296, param_data,
+                        sizeof(param_data));
+  ByteString good_data;
+  OLA_ASSERT_TRUE(RDMCommandSerializer::Pack(request, &good_data));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(good_data.data(), good_data.size()));
+
+  // Too short to hold the header.
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_TOO_SHORT,
+                view.Parse(good_data.data(),
+                           sizeof(ola::rdm::RDMCommandHeader) - 1));
+  OLA_ASSERT_FALSE(view.IsValid());
+
+  // Truncated checksum.
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_LENGTH_MISMATCH,
+                view.Parse(good_data.data(), good_data.size() - 1));
+
+  // Wrong sub start code.
+  ByteString data = good_data;
+  data[0] = 0x02;
+  SetChecksum(&data);
+  OLA_ASSERT_EQ(ola::rdm::RDM_WRONG_SUB_START_CODE,
+                view.Parse(data.data(), data.size()));
+
+  // Bad checksum.
+  data = good_data;
+  data[data.size() - 1]++;
+  OLA_ASSERT_EQ(ola::rdm::RDM_CHECKSUM_INCORRECT,
+                view.Parse(data.data(), data.size()));
+
+  // A message length smaller than the header, or 0, which would otherwise
+  // underflow the checksum calculation.
+  data = good_data;
+  data[1] = 0;
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_LENGTH_MISMATCH,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_NULL(RDMCommand::Inflate(data.data(), data.size()));
+  data[1] = sizeof(ola::rdm::RDMCommandHeader);
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_LENGTH_MISMATCH,
+                view.Parse(data.data(), data.size()));
+
+  // Param data length that overruns the message.
+  data = good_data;
+  data[22] = sizeof(param_data) + 1;
+  SetChecksum(&data);
+  OLA_ASSERT_EQ(ola::rdm::RDM_PARAM_LENGTH_MISMATCH,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_FALSE(view.IsValid());
+
+  // Trailing data after the checksum is ignored.
+  data = good_data;
+  data.push_back(0xff);
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                view.Parse(data.data(), data.size()));
+  OLA_ASSERT_EQ(static_cast<unsigned int>(sizeof(param_data)),
+                view.ParamDataSize());
+}
+
+
+/*
+ * Check VerifyResponse() agrees with RDMResponse::InflateFromData().
+ */
+void RDMCommandViewTest::testVerifyResponse() {
+  RDMGetRequest request(m_source, m_destination, 5, 1, 2, 296, NULL, 0);
+  RDMSetRequest set_request(m_source, m_destination, 5, 1, 2, 296, NULL, 0);
+  RDMGetRequest all_sub_devices(m_source, m_destination, 5, 1,
+                                ola::rdm::ALL_RDM_SUBDEVICES, 296, NULL, 0);
+
+  struct {
+    const RDMRequest *request;
+    UID source;
+    UID destination;
+    uint8_t transaction_number;
+    uint16_t sub_device;
+    ola::rdm::RDMStatusCode expected;
+  } tests[] = {
+    {&request, m_destination, m_source, 5, 2, ola::rdm::RDM_COMPLETED_OK},
+    {&request, m_destination, UID(9, 9), 5, 2,
+     ola::rdm::RDM_DEST_UID_MISMATCH},
+    {&request, UID(9, 9), m_source, 5, 2, ola::rdm::RDM_SRC_UID_MISMATCH},
+    {&request, m_destination, m_source, 6, 2,
+     ola::rdm::RDM_TRANSACTION_MISMATCH},
+    {&request, m_destination, m_source, 5, 3,
+     ola::rdm::RDM_SUB_DEVICE_MISMATCH},
+    {&all_sub_devices, m_destination, m_source, 5, 3,
+     ola::rdm::RDM_COMPLETED_OK},
+    {&set_request, m_destination, m_source, 5, 2,
+     ola::rdm::RDM_COMMAND_CLASS_MISMATCH},
+  };
+
+  for (unsigned int i = 0; i < arraysize(tests); i++) {
+    ola::rdm::RDMGetResponse response(
+        tests[i].source, tests[i].destination, tests[i].transaction_number,
+        ola::rdm::RDM_ACK, 0, tests[i].sub_device, 296, NULL, 0);
+    ByteString data;
+    OLA_ASSERT_TRUE(RDMCommandSerializer::Pack(response, &data));
+
+    RDMCommandView view;
+    OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK,
+                  view.Parse(data.data(), data.size()));
+    OLA_ASSERT_EQ(tests[i].expected, view.VerifyResponse(tests[i].request));
+
+    ola::rdm::RDMStatusCode status_code;
+    auto_ptr<RDMResponse> inflated(RDMResponse::InflateFromData(
+        data.data(), data.size(), &status_code, tests[i].request));
+    OLA_ASSERT_EQ(tests[i].expected, status_code);
+  }
+}
@@ -19,16 +19,24 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <iterator>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
 #include "ola/testing/TestUtils.h"
 
 
+using std::set;
 using std::string;
+using std::vector;
 using ola::rdm::UID;
+using ola::rdm::UIDHash;
 using ola::rdm::UIDSet;
 
 class UIDTest: public CppUnit::TestFixture {
@@ -37,8 +45,10 @@ class UIDTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testUIDInequalities);
   CPPUNIT_TEST(testUIDSet);
   CPPUNIT_TEST(testUIDSetUnion);
+  CPPUNIT_TEST(testUIDSetOperations);
   CPPUNIT_TEST(testUIDParse);
   CPPUNIT_TEST(testDirectedToUID);
+  CPPUNIT_TEST(testUIDHash);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -46,8 +56,10 @@ class UIDTest: public CppUnit::TestFixture {
     void testUIDInequalities();
     void testUIDSet();
     void testUIDSetUnion();
+    void testUIDSetOperations();
     void testUIDParse();
     void testDirectedToUID();
+    void testUIDHash();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(UIDTest);
@@ -313,6 +325,76 @@ void UIDTest::testUIDSetUnion() {
 }
 
 
+/*
+ * Check the UIDSet against a std::set, using UIDs added in a random order.
+ */
+void UIDTest::testUIDSetOperations() {
+  srandom(42);
+  set<UID> expected1, expected2;
+  UIDSet set1, set2;
+  for (unsigned int i = 0; i < 500; i++) {
+    // Use a small range of values so there are duplicates, and UIDs where
+    // only the manufacturer differs.
+    UID uid(random() % 4, random() % 300);
+    expected1.insert(uid);
+    set1.AddUID(uid);
+
+    UID uid2(random() % 4, random() % 300);
+    expected2.insert(uid2);
+    set2.AddUID(uid2);
+  }
+  for (unsigned int i = 0; i < 100; i++) {
+    UID uid(random() % 4, random() % 300);
+    expected1.erase(uid);
+    set1.RemoveUID(uid);
+  }
+
+  OLA_ASSERT_EQ(static_cast<unsigned int>(expected1.size()), set1.Size());
+  OLA_ASSERT_TRUE(std::equal(expected1.begin(), expected1.end(),
+                             set1.Begin()));
+  for (uint32_t i = 0; i < 300; i++) {
+    UID uid(2, i);
+    OLA_ASSERT_EQ(expected1.find(uid) != expected1.end(), set1.Contains(uid));
+  }
+
+  vector<UID> expected;
+  std::set_union(expected1.begin(), expected1.end(),
+                 expected2.begin(), expected2.end(),
+                 std::back_inserter(expected));
+  UIDSet result = set1.Union(set2);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(expected.size()), result.Size());
+  OLA_ASSERT_TRUE(std::equal(expected.begin(), expected.end(),
+                             result.Begin()));
+
+  expected.clear();
+  std::set_difference(expected1.begin(), expected1.end(),
+                      expected2.begin(), expected2.end(),
+                      std::back_inserter(expected));
+  result = set1.SetDifference(set2);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(expected.size()), result.Size());
+  OLA_ASSERT_TRUE(std::equal(expected.begin(), expected.end(),
+                             result.Begin()));
+
+  expected.clear();
+  std::set_intersection(expected1.begin(), expected1.end(),
+                        expected2.begin(), expected2.end(),
+                        std::back_inserter(expected));
+  result = set1.Intersection(set2);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(expected.size()), result.Size());
+  OLA_ASSERT_TRUE(std::equal(expected.begin(), expected.end(),
+                             result.Begin()));
+
+  // Binary data that's out of order, with a duplicate.
+  uint8_t raw[] = {0, 3, 0, 0, 0, 4, 0, 1, 0, 0, 0, 2, 0, 3, 0, 0, 0, 4,
+                   0, 2, 0, 0, 0, 10};
+  unsigned int data_size = sizeof(raw);
+  UIDSet unpacked(raw, &data_size);
+  OLA_ASSERT_EQ(24u, data_size);
+  OLA_ASSERT_EQ(string("0001:00000002,0002:0000000a,0003:00000004"),
+                unpacked.ToString());
+}
+
+
 /*
  * Test UID parsing
  */
@@ -383,3 +465,20 @@ void UIDTest::testDirectedToUID() {
   UID other_vendorcast_uid_2 = UID::VendorcastAddress(other_manufacturer_uid);
   OLA_ASSERT_FALSE(other_vendorcast_uid_2.DirectedToUID(device_uid));
 }
+
+
+/*
+ * Check equal UIDs hash the same, and sequential UIDs don't collide.
+ */
+void UIDTest::testUIDHash() {
+  UIDHash hasher;
+  OLA_ASSERT_EQ(hasher(UID(0x7a70, 1)), hasher(UID(0x7a70, 1)));
+  OLA_ASSERT_EQ(UID(0x7a70, 1).Hash(), hasher(UID(0x7a70, 1)));
+
+  set<size_t> hashes;
+  for (uint32_t i = 0; i < 1000; i++) {
+    hashes.insert(hasher(UID(0x7a70, i)));
+  }
+  hashes.insert(hasher(UID(0x7a71, 0)));
+  OLA_ASSERT_EQ(static_cast<size_t>(1001), hashes.size());
+}
@@ -25,6 +25,10 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <algorithm>
 #include <string>
 
 #include "common/rpc/Rpc.pb.h"
@@ -35,6 +39,9 @@
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
+#include "ola/base/Macro.h"
+#include "ola/io/IOVecInterface.h"
+#include "ola/io/MemoryBlock.h"
 #include "ola/stl/STLUtils.h"
 
 namespace ola {
@@ -43,6 +50,15 @@ namespace rpc {
 using google::protobuf::Message;
 using google::protobuf::MethodDescriptor;
 using google::protobuf::ServiceDescriptor;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::io::ZeroCopyInputStream;
+using google::protobuf::io::ZeroCopyOutputStream;
+using google::protobuf::internal::WireFormatLite;
+using ola::io::IOQueue;
+using ola::io::IOVec;
+using ola::io::MemoryBlock;
+using ola::io::MemoryBlockPool;
 using std::auto_ptr;
 using std::string;
 
@@ -52,35 +68,374 @@ const char RpcChannel::K_RPC_SENT_ERROR_VAR[] = "rpc-send-errors";
 const char RpcChannel::K_RPC_SENT_VAR[] = "rpc-sent";
 const char RpcChannel::STREAMING_NO_RESPONSE[] = "STREAMING_NO_RESPONSE";
 
-const char *RpcChannel::K_RPC_VARIABLES[] = {
-  K_RPC_RECEIVED_VAR,
-  K_RPC_SENT_ERROR_VAR,
-  K_RPC_SENT_VAR,
+namespace {
+
+// The keys used in the rpc-received-type variable.
+const struct {
+  Type type;
+  const char *name;
+} RECEIVED_TYPE_NAMES[] = {
+  {REQUEST, "request"},
+  {RESPONSE, "response"},
+  {RESPONSE_CANCEL, "cancelled"},
+  {RESPONSE_FAILED, "failed"},
+  {RESPONSE_NOT_IMPLEMENTED, "not-implemented"},
+  {STREAM_REQUEST, "stream_request"},
+  {STREAM_CREDIT, "stream_credit"},
+  {METHOD_IDS, "method_ids"},
 };
 
+// The tags of the RpcMessage fields, see Rpc.proto
+const uint32_t TYPE_TAG = (1 << 3) | WireFormatLite::WIRETYPE_VARINT;
+const uint32_t ID_TAG = (2 << 3) | WireFormatLite::WIRETYPE_VARINT;
+const uint32_t NAME_TAG = (3 << 3) | WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+const uint32_t BUFFER_TAG =
+    (4 << 3) | WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+const uint32_t METHOD_ID_TAG = (5 << 3) | WireFormatLite::WIRETYPE_VARINT;
+const uint32_t METHOD_TABLE_TAG = (6 << 3) | WireFormatLite::WIRETYPE_VARINT;
+
+/*
+ * The serialized size of a message. ByteSize() is deprecated in newer versions
+ * of protobuf.
+ */
+size_t SerializedSize(const Message &message) {
+#if GOOGLE_PROTOBUF_VERSION < 3006000
+  return message.ByteSize();
+#else
+  return message.ByteSizeLong();
+#endif  // GOOGLE_PROTOBUF_VERSION
+}
+
+/*
+ * Hash the names & types of a service's methods. Both ends need to agree on
+ * this before method ids are used in place of names. This is FNV-1a.
+ */
+uint32_t HashMethodTable(const ServiceDescriptor *service) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor *method = service->method(i);
+    const string *parts[] = {
+      &method->name(),
+      &method->input_type()->full_name(),
+      &method->output_type()->full_name(),
+    };
+    for (unsigned int j = 0; j < arraysize(parts); j++) {
+      // Include the terminating NULL so the parts can't run together.
+      const char *c = parts[j]->c_str();
+      do {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+      } while (*c++);
+    }
+  }
+  return hash;
+}
+
+/*
+ * Allocate a block from the pool, with all of its space free.
+ */
+MemoryBlock *AllocateEmptyBlock(MemoryBlockPool *pool) {
+  MemoryBlock *block = pool->Allocate();
+  if (block) {
+    // Blocks returned by IOQueue::Clear() may still contain data.
+    block->PopFront(block->Size());
+  }
+  return block;
+}
+
+/*
+ * A ZeroCopyOutputStream which serializes into blocks from a MemoryBlockPool,
+ * and appends them to an IOQueue.
+ */
+class BlockOutputStream: public ZeroCopyOutputStream {
+ public:
+  BlockOutputStream(IOQueue *queue, MemoryBlockPool *pool)
+      : m_queue(queue),
+        m_pool(pool),
+        m_block(NULL),
+        m_unused(0),
+        m_byte_count(0) {
+  }
+
+  ~BlockOutputStream() { AppendBlock(); }
+
+  bool Next(void **data, int *size) {
+    AppendBlock();
+    m_block = AllocateEmptyBlock(m_pool);
+    if (!m_block) {
+      return false;
+    }
+    *data = m_block->FreeSpace();
+    *size = m_block->Remaining();
+    m_unused = 0;
+    m_byte_count += *size;
+    return true;
+  }
+
+  void BackUp(int count) {
+    m_unused = count;
+    m_byte_count -= count;
+  }
+
+  google::protobuf::int64 ByteCount() const { return m_byte_count; }
+
+ private:
+  IOQueue *m_queue;
+  MemoryBlockPool *m_pool;
+  MemoryBlock *m_block;  // the block returned by the last call to Next()
+  unsigned int m_unused;
+  google::protobuf::int64 m_byte_count;
+
+  void AppendBlock() {
+    if (!m_block) {
+      return;
+    }
+    m_block->Extend(m_block->Remaining() - m_unused);
+    if (m_block->Empty()) {
+      m_pool->Release(m_block);
+    } else {
+      m_queue->AppendBlock(m_block);
+    }
+    m_block = NULL;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(BlockOutputStream);
+};
+
+
+/*
+ * A ZeroCopyInputStream which reads up to size bytes from an array of IOVecs.
+ */
+class IOVecInputStream: public ZeroCopyInputStream {
+ public:
+  IOVecInputStream(const IOVec *iov, int iov_count, unsigned int size)
+      : m_iov(iov),
+        m_iov_count(iov_count),
+        m_index(0),
+        m_offset(0),
+        m_remaining(size),
+        m_byte_count(0) {
+  }
+
+  bool Next(const void **data, int *size) {
+    while (m_index < m_iov_count && m_offset == m_iov[m_index].iov_len) {
+      m_index++;
+      m_offset = 0;
+    }
+    if (m_index == m_iov_count || m_remaining == 0) {
+      return false;
+    }
+
+    unsigned int length = std::min(
+        static_cast<unsigned int>(m_iov[m_index].iov_len - m_offset),
+        m_remaining);
+    *data = static_cast<const uint8_t*>(m_iov[m_index].iov_base) + m_offset;
+    *size = length;
+    m_offset += length;
+    m_remaining -= length;
+    m_byte_count += length;
+    return true;
+  }
+
+  // The count is never more than the size returned by the last Next().
+  void BackUp(int count) {
+    m_offset -= count;
+    m_remaining += count;
+    m_byte_count -= count;
+  }
+
+  bool Skip(int count) {
+    const void *data;
+    int size;
+    while (count > 0) {
+      if (!Next(&data, &size)) {
+        return false;
+      }
+      if (size > count) {
+        BackUp(size - count);
+        return true;
+      }
+      count -= size;
+    }
+    return true;
+  }
+
+  google::protobuf::int64 ByteCount() const { return m_byte_count; }
+
+ private:
+  const IOVec *m_iov;
+  const int m_iov_count;
+  int m_index;
+  size_t m_offset;  // the offset into the current IOVec
+  unsigned int m_remaining;
+  google::protobuf::int64 m_byte_count;
+
+  DISALLOW_COPY_AND_ASSIGN(IOVecInputStream);
+};
+}  // namespace
+
+
+/*
+ * An RpcMessage which is parsed in place from the received data. The buffer
+ * field isn't copied, ParseBuffer() parses it straight into the request or
+ * response.
+ */
+class IncomingMessage {
+ public:
+  IncomingMessage(const IOVec *iov, int iov_count, unsigned int size)
+      : m_iov(iov),
+        m_iov_count(iov_count),
+        m_size(size),
+        m_has_type(false),
+        m_type(REQUEST),
+        m_id(0),
+        m_has_name(false),
+        m_has_method_id(false),
+        m_method_id(0),
+        m_has_method_table(false),
+        m_method_table(0),
+        m_buffer_offset(0),
+        m_buffer_size(0) {
+  }
+
+  bool Parse();
+
+  Type type() const { return m_type; }
+  uint32_t id() const { return m_id; }
+  bool has_name() const { return m_has_name; }
+  const string &name() const { return m_name; }
+  bool has_method_id() const { return m_has_method_id; }
+  uint32_t method_id() const { return m_method_id; }
+  bool has_method_table() const { return m_has_method_table; }
+  uint32_t method_table() const { return m_method_table; }
+
+  bool ParseBuffer(Message *message) const;
+  string Buffer() const;
+
+ private:
+  const IOVec *m_iov;
+  const int m_iov_count;
+  const unsigned int m_size;
+  bool m_has_type;
+  Type m_type;
+  uint32_t m_id;
+  bool m_has_name;
+  string m_name;
+  bool m_has_method_id;
+  uint32_t m_method_id;
+  bool m_has_method_table;
+  uint32_t m_method_table;
+  unsigned int m_buffer_offset;
+  unsigned int m_buffer_size;
+
+  DISALLOW_COPY_AND_ASSIGN(IncomingMessage);
+};
+
+
+/*
+ * Parse the fields, apart from the buffer.
+ * @returns false if the message is malformed.
+ */
+bool IncomingMessage::Parse() {
+  IOVecInputStream stream(m_iov, m_iov_count, m_size);
+  CodedInputStream input(&stream);
+  uint32_t tag, value;
+  while ((tag = input.ReadTag()) != 0) {
+    switch (tag) {
+      case TYPE_TAG:
+        if (!input.ReadVarint32(&value)) {
+          return false;
+        }
+        m_type = static_cast<Type>(value);
+        m_has_type = true;
+        break;
+      case ID_TAG:
+        if (!input.ReadVarint32(&m_id)) {
+          return false;
+        }
+        break;
+      case NAME_TAG:
+        if (!(input.ReadVarint32(&value) &&
+              input.ReadString(&m_name, value))) {
+          return false;
+        }
+        m_has_name = true;
+        break;
+      case METHOD_ID_TAG:
+        if (!input.ReadVarint32(&m_method_id)) {
+          return false;
+        }
+        m_has_method_id = true;
+        break;
+      case METHOD_TABLE_TAG:
+        if (!input.ReadVarint32(&m_method_table)) {
+          return false;
+        }
+        m_has_method_table = true;
+        break;
+      case BUFFER_TAG:
+        if (!input.ReadVarint32(&m_buffer_size)) {
+          return false;
+        }
+        m_buffer_offset = input.CurrentPosition();
+        if (!input.Skip(m_buffer_size)) {
+          return false;
+        }
+        break;
+      default:
+        if (!WireFormatLite::SkipField(&input, tag)) {
+          return false;
+        }
+    }
+  }
+  return input.ConsumedEntireMessage() && m_has_type;
+}
+
+
+/*
+ * Parse the buffer field into a protobuf.
+ */
+bool IncomingMessage::ParseBuffer(Message *message) const {
+  IOVecInputStream stream(m_iov, m_iov_count,
+                          m_buffer_offset + m_buffer_size);
+  return (stream.Skip(m_buffer_offset) &&
+          message->ParseFromZeroCopyStream(&stream));
+}
+
+
+/*
+ * Return a copy of the buffer field.
+ */
+string IncomingMessage::Buffer() const {
+  string buffer;
+  IOVecInputStream stream(m_iov, m_iov_count,
+                          m_buffer_offset + m_buffer_size);
+  if (stream.Skip(m_buffer_offset)) {
+    CodedInputStream input(&stream);
+    input.ReadString(&buffer, m_buffer_size);
+  }
+  return buffer;
+}
+
+
 class OutstandingRequest {
   /*
-   * These are requests on the server end that haven't completed yet.
+   * These are requests on the server end that haven't completed yet. They're
+   * reused once complete, so the controller is reset for each request.
    */
  public:
-  OutstandingRequest(int id,
-                     RpcSession *session,
-                     google::protobuf::Message *response)
-      : id(id),
-        controller(new RpcController(session)),
-        response(response) {
+  explicit OutstandingRequest(RpcSession *session)
+      : id(0),
+        controller(session),
+        response(NULL) {
   }
   ~OutstandingRequest() {
-    if (controller) {
-      delete controller;
-    }
     if (response) {
       delete response;
     }
   }
 
   int id;
-  RpcController *controller;
+  RpcController controller;
   google::protobuf::Message *response;
 };
 
@@ -109,93 +464,127 @@ class OutstandingResponse {
 RpcChannel::RpcChannel(
     RpcService *service,
     ola::io::ConnectedDescriptor *descriptor,
-    ExportMap *export_map)
+    ExportMap *export_map,
+    ola::io::SelectServerInterface *ss)
     : m_session(new RpcSession(this)),
       m_service(service),
       m_descriptor(descriptor),
-      m_buffer(NULL),
-      m_buffer_size(0),
+      m_input(&m_memory_pool),
       m_expected_size(0),
-      m_current_size(0),
       m_export_map(export_map),
-      m_recv_type_map(NULL) {
+      m_received_var(NULL),
+      m_send_error_var(NULL),
+      m_sent_var(NULL),
+      m_stream_window(0),
+      m_stream_credit_owed(0),
+      m_stream_flow_control(false),
+      m_stream_credits(0),
+      m_method_ids_accepted(false),
+      m_accepted_method_table(0),
+      m_method_ids_granted(false),
+      m_table_service(NULL),
+      m_method_table(0),
+      m_stream_controller(new RpcController(m_session.get())) {
   if (descriptor) {
     descriptor->SetOnData(
         ola::NewCallback(this, &RpcChannel::DescriptorReady));
     descriptor->SetOnClose(
         ola::NewSingleCallback(this, &RpcChannel::HandleChannelClose));
+    if (ss) {
+      m_sender.reset(new ola::io::NonBlockingSender(
+          descriptor, ss, &m_memory_pool, MAX_BUFFER_SIZE));
+    }
   }
 
   if (m_export_map) {
-    for (unsigned int i = 0; i < arraysize(K_RPC_VARIABLES); ++i) {
-      m_export_map->GetCounterVar(string(K_RPC_VARIABLES[i]));
+    // Lookup the counters once, so the per message cost is just an
+    // increment.
+    m_received_var = m_export_map->GetShardedCounterVar(K_RPC_RECEIVED_VAR);
+    m_send_error_var = m_export_map->GetShardedCounterVar(
+        K_RPC_SENT_ERROR_VAR);
+    m_sent_var = m_export_map->GetShardedCounterVar(K_RPC_SENT_VAR);
+
+    ShardedCounterMap *type_map = m_export_map->GetShardedCounterMapVar(
+        K_RPC_RECEIVED_TYPE_VAR, "type");
+    m_recv_type_vars.assign(METHOD_IDS + 1, NULL);
+    for (unsigned int i = 0; i < arraysize(RECEIVED_TYPE_NAMES); ++i) {
+      m_recv_type_vars[RECEIVED_TYPE_NAMES[i].type] = type_map->Get(
+          RECEIVED_TYPE_NAMES[i].name);
     }
-    m_recv_type_map = m_export_map->GetUIntMapVar(K_RPC_RECEIVED_TYPE_VAR,
-                                                  "type");
   }
 }
 
 RpcChannel::~RpcChannel() {
-  free(m_buffer);
+  STLDeleteValues(&m_request_messages);
+  STLDeleteValues(&m_spare_responses);
+  STLDeleteElements(&m_free_requests);
 }
 
 void RpcChannel::DescriptorReady() {
-  if (!m_expected_size) {
-    // this is a new msg
-    unsigned int version;
-    if (ReadHeader(&version, &m_expected_size) < 0)
-      return;
-
-    if (!m_expected_size)
-      return;
+  if (!(m_descriptor && ReceiveData())) {
+    return;
+  }
 
-    if (version != PROTOCOL_VERSION) {
-      OLA_WARN << "protocol mismatch " << version << " != " <<
-        PROTOCOL_VERSION;
-      return;
+  // Handle all the complete messages we have.
+  while (m_descriptor) {
+    if (!m_expected_size) {
+      // this is a new msg
+      if (m_input.Size() < sizeof(uint32_t)) {
+        break;
+      }
+
+      unsigned int version;
+      ReadHeader(&version, &m_expected_size);
+      if (version != PROTOCOL_VERSION) {
+        OLA_WARN << "protocol mismatch " << version << " != " <<
+          PROTOCOL_VERSION;
+        CloseDescriptor();
+        return;
+      }
+
+      if (m_expected_size > MAX_BUFFER_SIZE) {
+        OLA_WARN << "Incoming message size " << m_expected_size
+                  << " is larger than MAX_BUFFER_SIZE: " << MAX_BUFFER_SIZE;
+        CloseDescriptor();
+        return;
+      }
+
+      if (!m_expected_size) {
+        continue;
+      }
     }
 
-    if (m_expected_size > MAX_BUFFER_SIZE) {
-      OLA_WARN << "Incoming message size " << m_expected_size
-                << " is larger than MAX_BUFFER_SIZE: " << MAX_BUFFER_SIZE;
-      m_descriptor->Close();
-      return;
+    if (m_input.Size() < m_expected_size) {
+      break;
     }
 
-    m_current_size = 0;
-    m_buffer_size = AllocateMsgBuffer(m_expected_size);
-
-    if (m_buffer_size < m_expected_size) {
-      OLA_WARN << "buffer size too small: " << m_buffer_size << " < " <<
-        m_expected_size;
+    // we've got all of this message so parse it.
+    bool ok = HandleNewMsg(m_expected_size);
+    m_input.Pop(m_expected_size);
+    m_expected_size = 0;
+    if (!ok && m_descriptor) {
+      // this probably means we've messed the framing up, close the channel
+      OLA_WARN << "Errors detected on RPC channel, closing";
+      CloseDescriptor();
       return;
     }
   }
 
-  if (!m_descriptor) {
-    return;
+  if (m_descriptor) {
+    ReturnStreamCredit();
   }
+}
 
-  unsigned int data_read;
-  if (m_descriptor->Receive(m_buffer + m_current_size,
-                            m_expected_size - m_current_size,
-                            data_read) < 0) {
-    OLA_WARN << "something went wrong in descriptor recv\n";
+void RpcChannel::SetStreamWindow(unsigned int window) {
+  unsigned int previous_window = m_stream_window;
+  if (previous_window && !window) {
+    OLA_WARN << "Can't remove the stream window once it's been granted";
     return;
   }
-
-  m_current_size += data_read;
-
-  if (m_current_size == m_expected_size) {
-    // we've got all of this message so parse it.
-    if (!HandleNewMsg(m_buffer, m_expected_size)) {
-      // this probably means we've messed the framing up, close the channel
-      OLA_WARN << "Errors detected on RPC channel, closing";
-      m_descriptor->Close();
-    }
-    m_expected_size = 0;
+  m_stream_window = window;
+  if (window > previous_window) {
+    SendStreamCredit(window - previous_window);
   }
-  return;
 }
 
 void RpcChannel::SetChannelCloseHandler(CloseCallback *callback) {
@@ -207,8 +596,6 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
                             const Message *request,
                             Message *reply,
                             SingleUseCallback0<void> *done) {
-  // TODO(simonn): reduce the number of copies here
-  string output;
   RpcMessage message;
   bool is_streaming = false;
 
@@ -225,14 +612,21 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
 
   message.set_type(is_streaming ? STREAM_REQUEST : REQUEST);
   message.set_id(m_sequence.Next());
-  message.set_name(method->name());
-
-  request->SerializeToString(&output);
-  message.set_buffer(output);
-  bool r = SendMsg(&message);
+  message.set_method_id(method->index());
+  // Until the peer accepts method ids, send the name as well.
+  uint32_t method_table = ClientMethodTable(method->service());
+  if (!(m_method_ids_accepted && method_table == m_accepted_method_table)) {
+    message.set_name(method->name());
+    message.set_method_table(method_table);
+  }
+  bool r = SendMsg(&message, request);
 
-  if (is_streaming)
+  if (is_streaming) {
+    if (m_stream_credits) {
+      m_stream_credits--;
+    }
     return;
+  }
 
   if (!r) {
     // Send failed, call the handler now.
@@ -257,19 +651,16 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
 }
 
 void RpcChannel::RequestComplete(OutstandingRequest *request) {
-  string output;
   RpcMessage message;
 
-  if (request->controller->Failed()) {
+  if (request->controller.Failed()) {
     SendRequestFailed(request);
     return;
   }
 
   message.set_type(RESPONSE);
   message.set_id(request->id);
-  request->response->SerializeToString(&output);
-  message.set_buffer(output);
-  SendMsg(&message);
+  SendMsg(&message, request->response);
   DeleteOutstandingRequest(request);
 }
 
@@ -282,155 +673,182 @@ RpcSession *RpcChannel::Session() {
 
 /*
  * Write an RpcMessage to the write descriptor.
+ * @param msg the RpcMessage to send
+ * @param buffer if not NULL, this is serialized as the buffer field of msg.
+ *   This avoids serializing it to a string first.
  */
-bool RpcChannel::SendMsg(RpcMessage *msg) {
+bool RpcChannel::SendMsg(RpcMessage *msg, const Message *buffer) {
   if (!(m_descriptor && m_descriptor->ValidReadDescriptor())) {
     OLA_WARN << "RPC descriptor closed, not sending messages";
     return false;
   }
 
-  uint32_t header;
-  // reserve the first 4 bytes for the header
-  string output(sizeof(header), 0);
-  msg->AppendToString(&output);
-  int length = output.size();
+  size_t length = SerializedSize(*msg);
+  size_t buffer_length = 0;
+  if (buffer) {
+    buffer_length = SerializedSize(*buffer);
+    length += (CodedOutputStream::VarintSize32(BUFFER_TAG) +
+               CodedOutputStream::VarintSize64(buffer_length) +
+               buffer_length);
+  }
 
+  if (length > RpcHeader::MAX_SIZE) {
+    OLA_WARN << "RPC message of " << length << " bytes is too large to send";
+    return false;
+  }
+
+  uint32_t header;
   RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION,
-                                length - sizeof(header));
-  output.replace(
-      0, sizeof(header),
-      reinterpret_cast<const char*>(&header), sizeof(header));
+                          static_cast<unsigned int>(length));
+
+  // Serialize directly into blocks from the pool, these are then written
+  // with a single writev().
+  IOQueue output(&m_memory_pool);
+  {
+    BlockOutputStream stream(&output, &m_memory_pool);
+    CodedOutputStream coded_output(&stream);
+    coded_output.WriteRaw(&header, sizeof(header));
+    msg->SerializeWithCachedSizes(&coded_output);
+    if (buffer) {
+      coded_output.WriteTag(BUFFER_TAG);
+      coded_output.WriteVarint32(static_cast<uint32_t>(buffer_length));
+      buffer->SerializeWithCachedSizes(&coded_output);
+    }
+  }
 
-  ssize_t ret = m_descriptor->Send(
-      reinterpret_cast<const uint8_t*>(output.data()), length);
+  bool ok = output.Size() == sizeof(header) + length;
+  if (ok) {
+    if (m_sender.get()) {
+      // If nothing is queued, write what we can now rather than waiting for
+      // the SelectServer to run. Anything left over is queued.
+      if (m_sender->Empty()) {
+        m_descriptor->Send(&output);
+      }
+      ok = output.Empty() || m_sender->SendMessage(&output);
+    } else {
+      m_descriptor->Send(&output);
+      ok = output.Empty();
+    }
+  }
 
-  if (ret != length) {
+  if (!ok) {
     OLA_WARN << "Failed to send full RPC message, closing channel";
 
-    if (m_export_map) {
-      (*m_export_map->GetCounterVar(K_RPC_SENT_ERROR_VAR))++;
+    if (m_send_error_var) {
+      m_send_error_var->Increment();
     }
 
     // At this point there is no point using the descriptor since framing has
     // probably been messed up.
     // TODO(simon): consider if it's worth leaving the descriptor open for
     // reading.
+    m_sender.reset();
     m_descriptor = NULL;
 
     HandleChannelClose();
     return false;
   }
 
-  if (m_export_map) {
-    (*m_export_map->GetCounterVar(K_RPC_SENT_VAR))++;
+  if (m_sent_var) {
+    m_sent_var->Increment();
   }
   return true;
 }
 
 
 /*
- * Allocate an incoming message buffer
- * @param size the size of the new buffer to allocate
- * @returns the size of the new buffer
+ * Read data from the descriptor directly into a block from the pool.
+ * @returns false if the read failed.
  */
-int RpcChannel::AllocateMsgBuffer(unsigned int size) {
-  unsigned int requested_size = size;
-  uint8_t *new_buffer;
-
-  if (size < m_buffer_size)
-    return size;
-
-  if (m_buffer_size == 0 && size < INITIAL_BUFFER_SIZE)
-    requested_size = INITIAL_BUFFER_SIZE;
-
-  if (requested_size > MAX_BUFFER_SIZE) {
-    OLA_WARN << "Incoming message size " << requested_size
-              << " is larger than MAX_BUFFER_SIZE: " << MAX_BUFFER_SIZE;
-    return m_buffer_size;
+bool RpcChannel::ReceiveData() {
+  MemoryBlock *block = AllocateEmptyBlock(&m_memory_pool);
+  if (!block) {
+    OLA_WARN << "Failed to allocate a block for the RPC data";
+    return false;
   }
 
-  new_buffer = static_cast<uint8_t*>(realloc(m_buffer, requested_size));
-  if (!new_buffer)
-    return m_buffer_size;
+  unsigned int data_read;
+  if (m_descriptor->Receive(block->FreeSpace(), block->Remaining(),
+                            data_read) < 0) {
+    OLA_WARN << "something went wrong in descriptor recv";
+    m_memory_pool.Release(block);
+    return false;
+  }
 
-  m_buffer = new_buffer;
-  m_buffer_size = requested_size;
-  return requested_size;
+  block->Extend(data_read);
+  if (block->Empty()) {
+    m_memory_pool.Release(block);
+  } else {
+    m_input.AppendBlock(block);
+  }
+  return true;
 }
 
 
 /*
- * Read 4 bytes and decode the header fields.
- * @returns: -1 if there is no data is available, version and size are 0
+ * Read 4 bytes from the input queue and decode the header fields.
  */
-int RpcChannel::ReadHeader(unsigned int *version,
-                                 unsigned int *size) const {
+void RpcChannel::ReadHeader(unsigned int *version, unsigned int *size) {
   uint32_t header;
-  unsigned int data_read = 0;
-  *version = *size = 0;
-
-  if (m_descriptor->Receive(reinterpret_cast<uint8_t*>(&header),
-                            sizeof(header), data_read)) {
-    OLA_WARN << "read header error: " << strerror(errno);
-    return -1;
-  }
-
-  if (!data_read)
-    return 0;
-
+  m_input.Read(reinterpret_cast<uint8_t*>(&header), sizeof(header));
   RpcHeader::DecodeHeader(header, version, size);
-  return 0;
 }
 
 
 /*
- * Parse a new message and handle it.
+ * Parse the message at the front of the input queue and handle it.
  */
-bool RpcChannel::HandleNewMsg(uint8_t *data, unsigned int size) {
-  RpcMessage msg;
-  if (!msg.ParseFromArray(data, size)) {
+bool RpcChannel::HandleNewMsg(unsigned int size) {
+  int iov_count;
+  const IOVec *iov = m_input.AsIOVec(&iov_count);
+  IncomingMessage msg(iov, iov_count, size);
+  if (!msg.Parse()) {
     OLA_WARN << "Failed to parse RPC";
+    ola::io::IOVecInterface::FreeIOVec(iov);
     return false;
   }
 
-  if (m_export_map)
-    (*m_export_map->GetCounterVar(K_RPC_RECEIVED_VAR))++;
+  if (m_received_var) {
+    m_received_var->Increment();
+    unsigned int type = msg.type();
+    if (type < m_recv_type_vars.size() && m_recv_type_vars[type]) {
+      m_recv_type_vars[type]->Increment();
+    }
+  }
 
   switch (msg.type()) {
     case REQUEST:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["request"]++;
       HandleRequest(&msg);
       break;
     case RESPONSE:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["response"]++;
       HandleResponse(&msg);
       break;
     case RESPONSE_CANCEL:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["cancelled"]++;
       HandleCanceledResponse(&msg);
       break;
     case RESPONSE_FAILED:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["failed"]++;
       HandleFailedResponse(&msg);
       break;
     case RESPONSE_NOT_IMPLEMENTED:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["not-implemented"]++;
       HandleNotImplemented(&msg);
       break;
     case STREAM_REQUEST:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["stream_request"]++;
+      if (m_stream_window) {
+        m_stream_credit_owed++;
+      }
       HandleStreamRequest(&msg);
       break;
+    case STREAM_CREDIT:
+      HandleStreamCredit(&msg);
+      break;
+    case METHOD_IDS:
+      HandleMethodIds(&msg);
+      break;
     default:
       OLA_WARN << "not sure of msg type " << msg.type();
       break;
   }
+  ola::io::IOVecInterface::FreeIOVec(iov);
   return true;
 }
 
@@ -438,39 +856,27 @@ bool RpcChannel::HandleNewMsg(uint8_t *data, unsigned int size) {
 /*
  * Handle a new RPC method call.
  */
-void RpcChannel::HandleRequest(RpcMessage *msg) {
+void RpcChannel::HandleRequest(IncomingMessage *msg) {
   if (!m_service) {
     OLA_WARN << "no service registered";
     return;
   }
 
-  const ServiceDescriptor *service = m_service->GetDescriptor();
-  if (!service) {
-    OLA_WARN << "failed to get service descriptor";
-    return;
-  }
-  const MethodDescriptor *method = service->FindMethodByName(msg->name());
+  const MethodDescriptor *method = LookupMethod(*msg);
   if (!method) {
     OLA_WARN << "failed to get method descriptor";
     SendNotImplemented(msg->id());
     return;
   }
 
-  Message* request_pb = m_service->GetRequestPrototype(method).New();
-  Message* response_pb = m_service->GetResponsePrototype(method).New();
-
-  if (!request_pb || !response_pb) {
-    OLA_WARN << "failed to get request or response objects";
-    return;
-  }
-
-  if (!request_pb->ParseFromString(msg->buffer())) {
+  Message *request_pb = RequestMessage(method);
+  if (!msg->ParseBuffer(request_pb)) {
     OLA_WARN << "parsing of request pb failed";
     return;
   }
 
-  OutstandingRequest *request = new OutstandingRequest(
-      msg->id(), m_session.get(), response_pb);
+  OutstandingRequest *request = NewOutstandingRequest(msg->id(),
+                                                      NewResponse(method));
 
   if (m_requests.find(msg->id()) != m_requests.end()) {
     OLA_WARN << "dup sequence number for request " << msg->id();
@@ -480,27 +886,21 @@ void RpcChannel::HandleRequest(RpcMessage *msg) {
   m_requests[msg->id()] = request;
   SingleUseCallback0<void> *callback = NewSingleCallback(
       this, &RpcChannel::RequestComplete, request);
-  m_service->CallMethod(method, request->controller, request_pb, response_pb,
-                        callback);
-  delete request_pb;
+  m_service->CallMethod(method, &request->controller, request_pb,
+                        request->response, callback);
 }
 
 
 /*
  * Handle a streaming RPC call. This doesn't return any response to the client.
  */
-void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
+void RpcChannel::HandleStreamRequest(IncomingMessage *msg) {
   if (!m_service) {
     OLA_WARN << "no service registered";
     return;
   }
 
-  const ServiceDescriptor *service = m_service->GetDescriptor();
-  if (!service) {
-    OLA_WARN << "failed to get service descriptor";
-    return;
-  }
-  const MethodDescriptor *method = service->FindMethodByName(msg->name());
+  const MethodDescriptor *method = LookupMethod(*msg);
   if (!method) {
     OLA_WARN << "failed to get method descriptor";
     SendNotImplemented(msg->id());
@@ -513,21 +913,59 @@ void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
     return;
   }
 
-  Message* request_pb = m_service->GetRequestPrototype(method).New();
-
-  if (!request_pb) {
-    OLA_WARN << "failed to get request or response objects";
+  Message *request_pb = RequestMessage(method);
+  if (!msg->ParseBuffer(request_pb)) {
+    OLA_WARN << "parsing of request pb failed";
     return;
   }
 
-  if (!request_pb->ParseFromString(msg->buffer())) {
-    OLA_WARN << "parsing of request pb failed";
-    return;
+  m_stream_controller->Reset();
+  m_service->CallMethod(method, m_stream_controller.get(), request_pb, NULL,
+                        NULL);
+}
+
+
+/*
+ * Find the method for a request. Requests from peers that haven't been told
+ * to use method ids carry the name, which is checked against the id.
+ */
+const MethodDescriptor *RpcChannel::LookupMethod(const IncomingMessage &msg) {
+  if (!msg.has_name()) {
+    if (!(msg.has_method_id() && m_method_ids_granted)) {
+      return NULL;
+    }
+    return m_service->FindMethodById(msg.method_id());
+  }
+
+  const MethodDescriptor *method = NULL;
+  if (msg.has_method_id()) {
+    method = m_service->FindMethodById(msg.method_id());
   }
 
-  RpcController controller(m_session.get());
-  m_service->CallMethod(method, &controller, request_pb, NULL, NULL);
-  delete request_pb;
+  if (!(method && method->name() == msg.name())) {
+    const ServiceDescriptor *service = m_service->GetDescriptor();
+    if (!service) {
+      OLA_WARN << "failed to get service descriptor";
+      return NULL;
+    }
+    method = service->FindMethodByName(msg.name());
+  } else if (msg.has_method_table() && !m_method_ids_granted &&
+             msg.method_table() == HashMethodTable(method->service())) {
+    GrantMethodIds(msg.method_table());
+  }
+  return method;
+}
+
+
+/*
+ * Return the hash of the methods for a service we're calling.
+ */
+uint32_t RpcChannel::ClientMethodTable(const ServiceDescriptor *service) {
+  if (service != m_table_service) {
+    m_table_service = service;
+    m_method_table = HashMethodTable(service);
+  }
+  return m_method_table;
 }
 
 
@@ -539,7 +977,7 @@ void RpcChannel::SendRequestFailed(OutstandingRequest *request) {
   RpcMessage message;
   message.set_type(RESPONSE_FAILED);
   message.set_id(request->id);
-  message.set_buffer(request->controller->ErrorText());
+  message.set_buffer(request->controller.ErrorText());
   SendMsg(&message);
   DeleteOutstandingRequest(request);
 }
@@ -557,10 +995,110 @@ void RpcChannel::SendNotImplemented(int msg_id) {
 
 
 /*
- * Cleanup an outstanding request after the response has been returned
+ * Allow the peer to send more stream requests.
+ */
+void RpcChannel::SendStreamCredit(unsigned int credit) {
+  RpcMessage message;
+  message.set_type(STREAM_CREDIT);
+  message.set_id(credit);
+  SendMsg(&message);
+}
+
+
+/*
+ * Return the credit for the stream requests we've handled. This is batched so
+ * we don't send a message for every request.
+ */
+void RpcChannel::ReturnStreamCredit() {
+  if (!m_stream_window ||
+      m_stream_credit_owed < (m_stream_window + 1) / 2) {
+    return;
+  }
+  unsigned int credit = m_stream_credit_owed;
+  m_stream_credit_owed = 0;
+  SendStreamCredit(credit);
+}
+
+
+/*
+ * Tell the peer it can send requests with just the method id.
+ */
+void RpcChannel::GrantMethodIds(uint32_t method_table) {
+  RpcMessage message;
+  message.set_type(METHOD_IDS);
+  message.set_id(method_table);
+  if (SendMsg(&message)) {
+    m_method_ids_granted = true;
+  }
+}
+
+
+/*
+ * Return the message to parse a request for this method into. Services must
+ * not hold on to the request once CallMethod() returns, so one message of
+ * each type is enough.
+ */
+Message *RpcChannel::RequestMessage(const MethodDescriptor *method) {
+  const Message &prototype = m_service->GetRequestPrototype(method);
+  Message *&message = m_request_messages[prototype.GetDescriptor()];
+  if (!message) {
+    message = prototype.New();
+  }
+  return message;
+}
+
+
+/*
+ * Return an empty response message for this method, reusing a spare one if we
+ * have it.
+ */
+Message *RpcChannel::NewResponse(const MethodDescriptor *method) {
+  const Message &prototype = m_service->GetResponsePrototype(method);
+  Message *response = STLLookupAndRemovePtr(&m_spare_responses,
+                                            prototype.GetDescriptor());
+  return response ? response : prototype.New();
+}
+
+
+/*
+ * Get an OutstandingRequest from the free list, or create a new one.
+ */
+OutstandingRequest *RpcChannel::NewOutstandingRequest(int id,
+                                                      Message *response) {
+  OutstandingRequest *request;
+  if (m_free_requests.empty()) {
+    request = new OutstandingRequest(m_session.get());
+  } else {
+    request = m_free_requests.back();
+    m_free_requests.pop_back();
+    request->controller.Reset();
+  }
+  request->id = id;
+  request->response = response;
+  return request;
+}
+
+
+/*
+ * Cleanup an outstanding request after the response has been returned. The
+ * request and response are kept for reuse.
  */
 void RpcChannel::DeleteOutstandingRequest(OutstandingRequest *request) {
-  STLRemoveAndDelete(&m_requests, request->id);
+  STLRemove(&m_requests, request->id);
+
+  Message *response = request->response;
+  request->response = NULL;
+  response->Clear();
+  if (!STLInsertIfNotPresent(&m_spare_responses, response->GetDescriptor(),
+                             response)) {
+    delete response;
+  }
+
+  if (m_free_requests.size() < MAX_FREE_REQUESTS) {
+    m_free_requests.push_back(request);
+  } else {
+    delete request;
+  }
 }
 
 
@@ -568,11 +1106,11 @@ void RpcChannel::DeleteOutstandingRequest(OutstandingRequest *request) {
 /*
  * Handle a RPC response by invoking the callback.
  */
-void RpcChannel::HandleResponse(RpcMessage *msg) {
+void RpcChannel::HandleResponse(IncomingMessage *msg) {
   auto_ptr<OutstandingResponse> response(
       STLLookupAndRemovePtr(&m_responses, msg->id()));
   if (response.get()) {
-    if (!response->reply->ParseFromString(msg->buffer())) {
+    if (!msg->ParseBuffer(response->reply)) {
       OLA_WARN << "Failed to parse response proto for "
                << response->reply->GetTypeName();
     }
@@ -581,14 +1119,32 @@ void RpcChannel::HandleResponse(RpcMessage *msg) {
 }
 
 
+/*
+ * Handle more credit from the peer.
+ */
+void RpcChannel::HandleStreamCredit(IncomingMessage *msg) {
+  m_stream_flow_control = true;
+  m_stream_credits += msg->id();
+}
+
+
+/*
+ * The peer has accepted method ids for a service.
+ */
+void RpcChannel::HandleMethodIds(IncomingMessage *msg) {
+  m_method_ids_accepted = true;
+  m_accepted_method_table = msg->id();
+}
+
+
 /*
  * Handle a RPC response by invoking the callback.
  */
-void RpcChannel::HandleFailedResponse(RpcMessage *msg) {
+void RpcChannel::HandleFailedResponse(IncomingMessage *msg) {
   auto_ptr<OutstandingResponse> response(
       STLLookupAndRemovePtr(&m_responses, msg->id()));
   if (response.get()) {
-    response->controller->SetFailed(msg->buffer());
+    response->controller->SetFailed(msg->Buffer());
     response->callback->Run();
   }
 }
@@ -597,12 +1153,12 @@ void RpcChannel::HandleFailedResponse(RpcMessage *msg) {
 /*
  * Handle a RPC response by invoking the callback.
  */
-void RpcChannel::HandleCanceledResponse(RpcMessage *msg) {
+void RpcChannel::HandleCanceledResponse(IncomingMessage *msg) {
   OLA_INFO << "Received a canceled response";
   auto_ptr<OutstandingResponse> response(
       STLLookupAndRemovePtr(&m_responses, msg->id()));
   if (response.get()) {
-    response->controller->SetFailed(msg->buffer());
+    response->controller->SetFailed(msg->Buffer());
     response->callback->Run();
   }
 }
@@ -611,7 +1167,7 @@ void RpcChannel::HandleCanceledResponse(RpcMessage *msg) {
 /*
  * Handle a NOT_IMPLEMENTED by invoking the callback.
  */
-void RpcChannel::HandleNotImplemented(RpcMessage *msg) {
+void RpcChannel::HandleNotImplemented(IncomingMessage *msg) {
   OLA_INFO << "Received a non-implemented response";
   auto_ptr<OutstandingResponse> response(
       STLLookupAndRemovePtr(&m_responses, msg->id()));
@@ -621,6 +1177,15 @@ void RpcChannel::HandleNotImplemented(RpcMessage *msg) {
   }
 }
 
+/*
+ * Close the descriptor, any queued data is discarded.
+ */
+void RpcChannel::CloseDescriptor() {
+  m_sender.reset();
+  m_input.Clear();
+  m_descriptor->Close();
+}
+
 /*
  * Invoke the Channel close handler/
  */
@@ -29,8 +29,14 @@
 #include <google/protobuf/service.h>
 #include <ola/Callback.h>
 #include <ola/io/Descriptor.h>
+#include <ola/io/IOQueue.h>
+#include <ola/io/MemoryBlockPool.h>
+#include <ola/io/NonBlockingSender.h>
+#include <ola/io/SelectServerInterface.h>
 #include <ola/util/SequenceNumber.h>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "ola/ExportMap.h"
 
@@ -39,6 +45,7 @@
 namespace ola {
 namespace rpc {
 
+class IncomingMessage;
 class RpcMessage;
 class RpcService;
 
@@ -47,6 +54,10 @@ class RpcService;
  * server.
  * This implementation runs over a ConnectedDescriptor which means it can be
  * used over TCP or pipes.
+ *
+ * Messages are serialized into, and parsed from, MemoryBlocks. If a
+ * SelectServer is provided, a NonBlockingSender is used so that messages are
+ * buffered rather than dropped when the descriptor's send buffer is full.
  */
 class RpcChannel {
  public :
@@ -66,10 +77,14 @@ class RpcChannel {
      *   caller is responsible for registering the descriptor with the
      *   SelectServer. Ownership of the descriptor is not transferred.
      * @param export_map the ExportMap to use for stats
+     * @param ss the SelectServer the descriptor is registered with. If
+     *   provided, data that can't be written immediately is queued until the
+     *   descriptor is writable. Ownership is not transferred.
      */
     RpcChannel(RpcService *service,
                ola::io::ConnectedDescriptor *descriptor,
-               ExportMap *export_map = NULL);
+               ExportMap *export_map = NULL,
+               ola::io::SelectServerInterface *ss = NULL);
 
     /**
      * @brief Destructor
@@ -90,6 +105,45 @@ class RpcChannel {
      */
     bool PendingRPCs() const { return !m_requests.empty(); }
 
+    /**
+     * @brief Limit the number of stream requests the peer may have in flight.
+     * @param window the maximum number of stream requests the peer can send
+     *   before it has to wait for more credit. 0, the default, means
+     *   unlimited. Once a window has been granted it can't be removed.
+     *
+     * The window is granted to the peer immediately. As stream requests are
+     * handled, credit is returned to the peer in batches, so the number of
+     * stream requests queued on the descriptor never exceeds the window.
+     * Increasing the window grants the extra credit straight away, reducing
+     * it doesn't revoke credit the peer already holds.
+     */
+    void SetStreamWindow(unsigned int window);
+
+    /**
+     * @brief Check if the peer will accept another stream request.
+     * @returns true if a stream request can be sent without exceeding the
+     *   window granted by the peer. This is always true if the peer hasn't
+     *   granted a window.
+     *
+     * Stream requests sent while the window is closed are still written to
+     * the descriptor, callers that care about latency should check this first
+     * and hold back or coalesce the data.
+     */
+    bool StreamWindowOpen() const {
+      return !m_stream_flow_control || m_stream_credits > 0;
+    }
+
+    /**
+     * @brief Check if requests are sent with just the method id.
+     * @returns true once the peer has agreed to accept method ids in place of
+     *   method names.
+     *
+     * Requests carry the method name, id and a hash of the service's methods
+     * until the peer replies with a matching hash. Peers which don't
+     * understand method ids ignore them, so they keep receiving names.
+     */
+    bool UsingMethodIds() const { return m_method_ids_accepted; }
+
     /**
      * @brief Called when new data arrives on the descriptor.
      */
@@ -138,6 +192,8 @@ class RpcChannel {
  private:
     typedef HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingResponse*>
       ResponseMap;
+    typedef std::map<const google::protobuf::Descriptor*,
+                     google::protobuf::Message*> MessageMap;
 
     std::auto_ptr<RpcSession> m_session;
     RpcService *m_service;  // service to dispatch requests to
@@ -145,43 +201,89 @@ class RpcChannel {
     // the descriptor to read/write to.
     class ola::io::ConnectedDescriptor *m_descriptor;
     SequenceNumber<uint32_t> m_sequence;
-    uint8_t *m_buffer;  // buffer for incoming msgs
-    unsigned int m_buffer_size;  // size of the buffer
-    unsigned int m_expected_size;  // the total size of the current msg
-    unsigned int m_current_size;  // the amount of data read for the current msg
+    // The pool must outlive the queues that use it.
+    ola::io::MemoryBlockPool m_memory_pool;
+    ola::io::IOQueue m_input;  // data received but not yet handled
+    std::auto_ptr<ola::io::NonBlockingSender> m_sender;  // may be NULL
+    unsigned int m_expected_size;  // the size of the current msg, 0 if unknown
     HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingRequest*> m_requests;
     ResponseMap m_responses;
     ExportMap *m_export_map;
-    UIntMap *m_recv_type_map;
+    ShardedCounter *m_received_var;
+    ShardedCounter *m_send_error_var;
+    ShardedCounter *m_sent_var;
+    // indexed by message type, entries may be NULL
+    std::vector<ShardedCounter*> m_recv_type_vars;
+    // server end, the window granted to the peer & the credit we owe it.
+    unsigned int m_stream_window;
+    unsigned int m_stream_credit_owed;
+    // client end, true once the peer has granted a window.
+    bool m_stream_flow_control;
+    unsigned int m_stream_credits;
+    // client end, the method table the peer accepted ids for.
+    bool m_method_ids_accepted;
+    uint32_t m_accepted_method_table;
+    // server end, true once the peer has been told to use method ids.
+    bool m_method_ids_granted;
+    // client end, the last service we computed the method table for.
+    const google::protobuf::ServiceDescriptor *m_table_service;
+    uint32_t m_method_table;
+    // server end, these are reused so that handling a request doesn't
+    // allocate. The request messages are keyed by type, and are parsed into
+    // for each call. There is at most one spare response of each type.
+    MessageMap m_request_messages;
+    MessageMap m_spare_responses;
+    std::vector<class OutstandingRequest*> m_free_requests;
+    std::auto_ptr<class RpcController> m_stream_controller;
 
-    bool SendMsg(RpcMessage *msg);
-    int AllocateMsgBuffer(unsigned int size);
-    int ReadHeader(unsigned int *version, unsigned int *size) const;
-    bool HandleNewMsg(uint8_t *buffer, unsigned int size);
-    void HandleRequest(RpcMessage *msg);
-    void HandleStreamRequest(RpcMessage *msg);
+    bool SendMsg(RpcMessage *msg,
+                 const google::protobuf::Message *buffer = NULL);
+    bool ReceiveData();
+    void ReadHeader(unsigned int *version, unsigned int *size);
+    bool HandleNewMsg(unsigned int size);
+    void HandleRequest(IncomingMessage *msg);
+    void HandleStreamRequest(IncomingMessage *msg);
+    void HandleStreamCredit(IncomingMessage *msg);
+    const google::protobuf::MethodDescriptor *LookupMethod(
+        const IncomingMessage &msg);
+    uint32_t ClientMethodTable(
+        const google::protobuf::ServiceDescriptor *service);
 
     // server end
     void SendRequestFailed(class OutstandingRequest *request);
     void SendNotImplemented(int msg_id);
+    void SendStreamCredit(unsigned int credit);
+    void GrantMethodIds(uint32_t method_table);
+    void ReturnStreamCredit();
+    google::protobuf::Message *RequestMessage(
+        const google::protobuf::MethodDescriptor *method);
+    google::protobuf::Message *NewResponse(
+        const google::protobuf::MethodDescriptor *method);
+    class OutstandingRequest *NewOutstandingRequest(
+        int id,
+        google::protobuf::Message *response);
     void DeleteOutstandingRequest(class OutstandingRequest *request);
 
     // client end
-    void HandleResponse(RpcMessage *msg);
-    void HandleFailedResponse(RpcMessage *msg);
-    void HandleCanceledResponse(RpcMessage *msg);
-    void HandleNotImplemented(RpcMessage *msg);
+    void HandleResponse(IncomingMessage *msg);
+    void HandleFailedResponse(IncomingMessage *msg);
+    void HandleCanceledResponse(IncomingMessage *msg);
+    void HandleNotImplemented(IncomingMessage *msg);
+    void HandleMethodIds(IncomingMessage *msg);
 
+    void CloseDescriptor();
     void HandleChannelClose();
 
     static const char K_RPC_RECEIVED_TYPE_VAR[];
     static const char K_RPC_RECEIVED_VAR[];
     static const char K_RPC_SENT_ERROR_VAR[];
     static const char K_RPC_SENT_VAR[];
-    static const char *K_RPC_VARIABLES[];
     static const char STREAMING_NO_RESPONSE[];
-    static const unsigned int INITIAL_BUFFER_SIZE = 1 << 11;  // 2k
+    // The largest message we'll accept, this is also the limit for the
+    // NonBlockingSender.
     static const unsigned int MAX_BUFFER_SIZE = 1 << 20;  // 1M
+    // The number of completed OutstandingRequests to keep for reuse.
+    static const unsigned int MAX_FREE_REQUESTS = 16;
 };
 }  // namespace rpc
 }  // namespace ola
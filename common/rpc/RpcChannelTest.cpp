@@ -51,16 +51,24 @@ using std::string;
 class RpcChannelTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RpcChannelTest);
   CPPUNIT_TEST(testEcho);
+  CPPUNIT_TEST(testLargeEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+  CPPUNIT_TEST(testStreamWindow);
+  CPPUNIT_TEST(testMethodIds);
+  CPPUNIT_TEST(testRequestReuse);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void setUp();
   void tearDown();
   void testEcho();
+  void testLargeEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testStreamWindow();
+  void testMethodIds();
+  void testRequestReuse();
   void EchoComplete();
   void FailedEchoComplete();
 
@@ -84,12 +92,16 @@ void RpcChannelTest::setUp() {
   m_socket->Init();
 
   m_service.reset(new TestServiceImpl(&m_ss));
-  m_channel.reset(new RpcChannel(m_service.get(), m_socket.get()));
+  m_channel.reset(new RpcChannel(m_service.get(), m_socket.get(), NULL,
+                                 &m_ss));
   m_ss.AddReadDescriptor(m_socket.get());
   m_stub.reset(new TestService_Stub(m_channel.get()));
 }
 
 void RpcChannelTest::tearDown() {
+  // The channel's sender uses the socket, so delete it first.
+  m_stub.reset();
+  m_channel.reset();
   m_ss.RemoveReadDescriptor(m_socket.get());
 }
 
@@ -118,6 +130,20 @@ void RpcChannelTest::testEcho() {
   m_ss.Run();
 }
 
+/*
+ * Check that messages larger than a MemoryBlock are sent & received.
+ */
+void RpcChannelTest::testLargeEcho() {
+  m_request.set_data(string(10000, 'x'));
+  m_request.set_session_ptr(0);
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &RpcChannelTest::EchoComplete));
+
+  m_ss.Run();
+}
+
 /*
  * Check that method that fail return correctly
  */
@@ -139,3 +165,89 @@ void RpcChannelTest::testStreamRequest() {
   m_stub->Stream(NULL, &m_request, NULL, NULL);
   m_ss.Run();
 }
+
+/*
+ * Check the stream window is granted, used and returned.
+ */
+void RpcChannelTest::testStreamWindow() {
+  // The channel is talking to itself, so it's both the client and server.
+  OLA_ASSERT_TRUE(m_channel->StreamWindowOpen());
+  m_channel->SetStreamWindow(2);
+  m_ss.RunOnce();
+  OLA_ASSERT_TRUE(m_channel->StreamWindowOpen());
+
+  m_request.set_data("foo");
+  m_stub->Stream(NULL, &m_request, NULL, NULL);
+  OLA_ASSERT_TRUE(m_channel->StreamWindowOpen());
+  m_stub->Stream(NULL, &m_request, NULL, NULL);
+  OLA_ASSERT_FALSE(m_channel->StreamWindowOpen());
+
+  // Handle the requests, which returns the credit.
+  for (unsigned int i = 0; i < 5 && !m_channel->StreamWindowOpen(); i++) {
+    m_ss.RunOnce();
+  }
+  OLA_ASSERT_TRUE(m_channel->StreamWindowOpen());
+}
+
+/*
+ * Check the channel switches to method ids, and requests still work after.
+ */
+void RpcChannelTest::testMethodIds() {
+  // The channel is talking to itself, so it's both the client and server.
+  OLA_ASSERT_FALSE(m_channel->UsingMethodIds());
+
+  m_request.set_data("foo");
+  m_request.set_session_ptr(0);
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &RpcChannelTest::EchoComplete));
+  m_ss.Run();
+  // METHOD_IDS is sent before the response.
+  OLA_ASSERT_TRUE(m_channel->UsingMethodIds());
+
+  // Now the requests only carry the method id.
+  m_controller.Reset();
+  m_reply.Clear();
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &RpcChannelTest::EchoComplete));
+  m_ss.Run();
+
+  m_stub->Stream(NULL, &m_request, NULL, NULL);
+  m_ss.Run();
+}
+
+/*
+ * Check the state of a request doesn't carry over to the next one, since the
+ * server end reuses the controller and messages.
+ */
+void RpcChannelTest::testRequestReuse() {
+  m_request.set_data(string(1000, 'x'));
+  m_request.set_session_ptr(0);
+  m_stub->FailedEcho(
+      &m_controller,
+      &m_request,
+      &m_reply,
+      NewSingleCallback(this, &RpcChannelTest::FailedEchoComplete));
+  m_ss.Run();
+
+  m_controller.Reset();
+  m_reply.Clear();
+  m_request.set_data("foo");
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &RpcChannelTest::EchoComplete));
+  m_ss.Run();
+
+  m_controller.Reset();
+  m_reply.Clear();
+  m_request.set_data("bar");
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &RpcChannelTest::EchoComplete));
+  m_ss.Run();
+}
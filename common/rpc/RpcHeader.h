@@ -50,6 +50,11 @@ class RpcHeader {
       *size = header & SIZE_MASK;
     }
 
+    /**
+     * The largest size that can be encoded in a header.
+     */
+    static const unsigned int MAX_SIZE = 0x0fffffff;
+
  private:
     static const unsigned int VERSION_MASK = 0xf0000000;
     static const unsigned int SIZE_MASK = 0x0fffffff;
@@ -22,6 +22,7 @@
 
 #include <ola/ExportMap.h>
 #include <ola/Logging.h>
+#include <ola/base/Credentials.h>
 #include <ola/network/SocketAddress.h>
 #include <ola/network/TCPSocket.h>
 #include <ola/rpc/RpcSessionHandler.h>
@@ -38,6 +39,8 @@ using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::TCPAcceptingSocket;
 using ola::network::TCPSocket;
+using ola::network::UnixDomainAcceptingSocket;
+using ola::network::UnixDomainSocket;
 
 namespace {
 void CleanupChannel(RpcChannel *channel,
@@ -49,6 +52,7 @@ void CleanupChannel(RpcChannel *channel,
 
 const char RpcServer::K_CLIENT_VAR[] = "clients-connected";
 const char RpcServer::K_RPC_PORT_VAR[] = "rpc-port";
+const char RpcServer::K_RPC_SOCKET_VAR[] = "rpc-socket";
 
 RpcServer::RpcServer(ola::io::SelectServerInterface *ss,
                      RpcService *service,
@@ -59,7 +63,9 @@ RpcServer::RpcServer(ola::io::SelectServerInterface *ss,
       m_session_handler(session_handler),
       m_options(options),
       m_tcp_socket_factory(
-          ola::NewCallback(this, &RpcServer::NewTCPConnection)) {
+          ola::NewCallback(this, &RpcServer::NewTCPConnection)),
+      m_unix_socket_factory(
+          ola::NewCallback(this, &RpcServer::NewUnixConnection)) {
   if (m_options.export_map) {
     m_options.export_map->GetIntegerVar(K_CLIENT_VAR);
   }
@@ -81,6 +87,9 @@ RpcServer::~RpcServer() {
   if (m_accepting_socket.get() && m_accepting_socket->ValidReadDescriptor()) {
     m_ss->RemoveReadDescriptor(m_accepting_socket.get());
   }
+  if (m_unix_accepting_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_unix_accepting_socket.get());
+  }
 }
 
 bool RpcServer::Init() {
@@ -115,7 +124,7 @@ bool RpcServer::Init() {
   }
 
   m_accepting_socket.reset(accepting_socket.release());
-  return true;
+  return m_options.socket_path.empty() || ListenOnUnixSocket();
 }
 
 GenericSocketAddress RpcServer::ListenAddress() {
@@ -126,10 +135,8 @@ GenericSocketAddress RpcServer::ListenAddress() {
 }
 
 bool RpcServer::AddClient(ConnectedDescriptor *descriptor) {
-  // If RpcChannel had a pointer to the SelectServer to use, we could hand off
-  // ownership of the socket here.
   RpcChannel *channel = new RpcChannel(m_service, descriptor,
-                                       m_options.export_map);
+                                       m_options.export_map, m_ss);
 
   if (m_session_handler) {
     m_session_handler->NewClient(channel->Session());
@@ -144,7 +151,33 @@ bool RpcServer::AddClient(ConnectedDescriptor *descriptor) {
 
   m_ss->AddReadDescriptor(descriptor);
   m_connected_sockets.insert(descriptor);
+  channel->SetStreamWindow(m_options.stream_window);
+
+  return true;
+}
+
+/*
+ * Start listening on the unix domain socket.
+ */
+bool RpcServer::ListenOnUnixSocket() {
+  auto_ptr<UnixDomainAcceptingSocket> accepting_socket(
+      new UnixDomainAcceptingSocket(&m_unix_socket_factory));
+  if (!accepting_socket->Listen(m_options.socket_path)) {
+    OLA_FATAL << "Could not listen on the RPC socket "
+              << m_options.socket_path;
+    return false;
+  }
+
+  if (!m_ss->AddReadDescriptor(accepting_socket.get())) {
+    OLA_WARN << "Failed to add RPC unix socket to SelectServer";
+    return false;
+  }
 
+  if (m_options.export_map) {
+    m_options.export_map->GetStringVar(K_RPC_SOCKET_VAR)->Set(
+        m_options.socket_path);
+  }
+  m_unix_accepting_socket.reset(accepting_socket.release());
   return true;
 }
 
@@ -156,6 +189,32 @@ void RpcServer::NewTCPConnection(TCPSocket *socket) {
   AddClient(socket);
 }
 
+/*
+ * Check the credentials of a new unix domain socket client.
+ */
+void RpcServer::NewUnixConnection(UnixDomainSocket *socket) {
+  if (!socket)
+    return;
+
+  if (!m_options.socket_allow_other_users) {
+    uid_t uid, our_uid;
+    gid_t gid;
+    if (!(socket->GetPeerCredentials(&uid, &gid) && GetEUID(&our_uid))) {
+      OLA_WARN << "Unable to check the credentials of the RPC client, "
+               << "closing";
+      delete socket;
+      return;
+    }
+
+    if (uid != our_uid && uid != 0) {
+      OLA_WARN << "Rejecting RPC client with uid " << uid;
+      delete socket;
+      return;
+    }
+  }
+  AddClient(socket);
+}
+
 void RpcServer::ChannelClosed(ConnectedDescriptor *descriptor,
                               RpcSession *session) {
   if (m_session_handler) {
@@ -24,9 +24,11 @@
 #include <stdint.h>
 #include <ola/io/SelectServerInterface.h>
 #include <ola/network/TCPSocketFactory.h>
+#include <ola/network/UnixDomainSocket.h>
 
 #include <set>
 #include <memory>
+#include <string>
 
 namespace ola {
 
@@ -38,7 +40,7 @@ namespace rpc {
  * @brief An RPC server.
  *
  * The RPCServer starts listening on 127.0.0.0:[listen_port] for new client
- * connections. After accepting a new client connection it calls
+ * connections, and optionally on a unix domain socket. After accepting a new client connection it calls
  * RpcSessionHandlerInterface::NewClient() on the session_handler. For each RPC
  * it then invokes the correct method from the RpcService object.
  *
@@ -72,10 +74,40 @@ class RpcServer {
      */
     ola::network::TCPAcceptingSocket *listen_socket;
 
+    /**
+     * @brief The number of stream requests each client may have in flight.
+     *
+     * Clients that honor the window hold back stream requests until earlier
+     * ones have been handled, which bounds the latency when the server is
+     * overloaded. 0 means unlimited.
+     */
+    unsigned int stream_window;
+
+    /**
+     * @brief The path of a unix domain socket to listen on, in addition to
+     * TCP.
+     *
+     * Clients on the same host can use this to avoid the overhead of the
+     * loopback TCP stack. Paths starting with '@' are in the Linux abstract
+     * namespace. If empty, no unix domain socket is used.
+     */
+    std::string socket_path;
+
+    /**
+     * @brief Accept unix domain socket connections from other users.
+     *
+     * If false, only processes running as the same user as the server, or as
+     * root, may connect to socket_path. The peer's credentials are checked
+     * when the connection is accepted.
+     */
+    bool socket_allow_other_users;
+
     Options()
       : listen_port(0),
         export_map(NULL),
-        listen_socket(NULL) {
+        listen_socket(NULL),
+        stream_window(0),
+        socket_allow_other_users(false) {
     }
   };
 
@@ -122,15 +154,21 @@ class RpcServer {
   const Options m_options;
 
   ola::network::TCPSocketFactory m_tcp_socket_factory;
+  ola::network::UnixDomainSocketFactory m_unix_socket_factory;
   std::auto_ptr<ola::network::TCPAcceptingSocket> m_accepting_socket;
+  std::auto_ptr<ola::network::UnixDomainAcceptingSocket>
+      m_unix_accepting_socket;
   ClientDescriptors m_connected_sockets;
 
+  bool ListenOnUnixSocket();
   void NewTCPConnection(ola::network::TCPSocket *socket);
+  void NewUnixConnection(ola::network::UnixDomainSocket *socket);
   void ChannelClosed(ola::io::ConnectedDescriptor *socket,
                      class RpcSession *session);
 
   static const char K_CLIENT_VAR[];
   static const char K_RPC_PORT_VAR[];
+  static const char K_RPC_SOCKET_VAR[];
 };
 }  // namespace rpc
 }  // namespace ola
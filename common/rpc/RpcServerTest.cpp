@@ -18,13 +18,16 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#include <unistd.h>
 #include <memory>
+#include <string>
 
 #include "common/rpc/RpcServer.h"
 #include "common/rpc/RpcSession.h"
 #include "common/rpc/TestService.h"
 #include "common/rpc/TestServiceService.pb.h"
 #include "ola/io/SelectServer.h"
+#include "ola/StringUtils.h"
 #include "ola/rpc/RpcSessionHandler.h"
 #include "ola/testing/TestUtils.h"
 
@@ -32,6 +35,7 @@ using ola::io::SelectServer;
 using ola::rpc::RpcSession;
 using ola::rpc::RpcServer;
 using std::auto_ptr;
+using std::string;
 
 class RpcServerTest: public CppUnit::TestFixture,
                      public ola::rpc::RpcSessionHandlerInterface {
@@ -39,12 +43,16 @@ class RpcServerTest: public CppUnit::TestFixture,
   CPPUNIT_TEST(testEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+#ifndef _WIN32
+  CPPUNIT_TEST(testUnixSocketEcho);
+#endif  // !_WIN32
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testUnixSocketEcho();
 
   void setUp();
 
@@ -91,3 +99,15 @@ void RpcServerTest::testFailedEcho() {
 void RpcServerTest::testStreamRequest() {
   m_client->StreamMessage();
 }
+
+void RpcServerTest::testUnixSocketEcho() {
+  RpcServer::Options options;
+  options.socket_path = "/tmp/ola-rpc-test-" + ola::IntToString(getpid());
+  auto_ptr<RpcServer> server(
+      new RpcServer(&m_ss, m_service.get(), this, options));
+  OLA_ASSERT_TRUE(server->Init());
+
+  TestClient client(&m_ss, options.socket_path);
+  OLA_ASSERT_TRUE(client.Init());
+  client.CallEcho(&ptr_data);
+}
@@ -53,6 +53,11 @@ class RpcService {
         const google::protobuf::MethodDescriptor *method) const = 0;
     virtual const google::protobuf::Message& GetResponsePrototype(
         const google::protobuf::MethodDescriptor *method) const = 0;
+
+    // Return the method with the given id, or NULL if the id isn't valid.
+    // The id is the index of the method in the service.
+    virtual const google::protobuf::MethodDescriptor* FindMethodById(
+        unsigned int method_id) = 0;
 };
 }  // namespace rpc
 }  // namespace ola
@@ -40,6 +40,7 @@ using ola::rpc::STREAMING_NO_RESPONSE;
 using ola::rpc::TestService_Stub;
 using ola::network::TCPSocket;
 using ola::network::GenericSocketAddress;
+using ola::network::UnixDomainSocket;
 using std::string;
 
 const char TestClient::kTestData[] = "foo";
@@ -83,12 +84,21 @@ TestClient::TestClient(SelectServer *ss,
       m_server_addr(server_addr) {
 }
 
+TestClient::TestClient(SelectServer *ss, const string &socket_path)
+    : m_ss(ss),
+      m_socket_path(socket_path) {
+}
+
 TestClient::~TestClient() {
   m_ss->RemoveReadDescriptor(m_socket.get());
 }
 
 bool TestClient::Init() {
-  m_socket.reset(TCPSocket::Connect(m_server_addr));
+  if (m_socket_path.empty()) {
+    m_socket.reset(TCPSocket::Connect(m_server_addr));
+  } else {
+    m_socket.reset(UnixDomainSocket::Connect(m_socket_path));
+  }
   OLA_ASSERT_NOT_NULL(m_socket.get());
 
   m_channel.reset(new RpcChannel(NULL, m_socket.get()));
@@ -20,7 +20,9 @@
 
 #include "ola/strings/Format.h"
 
+#include <string.h>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 
@@ -32,15 +34,51 @@ using std::ostringstream;
 using std::string;
 
 string IntToString(int i) {
-  ostringstream str;
-  str << i;
-  return str.str();
+  char output[MAX_UINT_DIGITS + 1];
+  char *ptr = output;
+  unsigned int magnitude = static_cast<unsigned int>(i);
+  if (i < 0) {
+    *ptr++ = '-';
+    magnitude = 0u - magnitude;
+  }
+  return string(output, FormatUInt(magnitude, ptr));
 }
 
 string IntToString(unsigned int i) {
-  ostringstream str;
-  str << i;
-  return str.str();
+  char output[MAX_UINT_DIGITS];
+  return string(output, FormatUInt(i, output));
+}
+
+char *FormatUInt(unsigned int i, char *output) {
+  // Build the digits from the right, then copy them into place.
+  char digits[MAX_UINT_DIGITS];
+  char *const digits_end = digits + MAX_UINT_DIGITS;
+  char *ptr = digits_end;
+  do {
+    *--ptr = static_cast<char>('0' + i % 10);
+    i /= 10;
+  } while (i);
+  const unsigned int length = digits_end - ptr;
+  memcpy(output, ptr, length);
+  return output + length;
+}
+
+const char *ParseUInt(const char *begin, const char *end,
+                      unsigned int *output) {
+  const unsigned int max = std::numeric_limits<unsigned int>::max();
+  unsigned int value = 0;
+  const char *ptr = begin;
+  for (; ptr != end && *ptr >= '0' && *ptr <= '9'; ptr++) {
+    const unsigned int digit = *ptr - '0';
+    if (value > (max - digit) / 10) {
+      return begin;
+    }
+    value = value * 10 + digit;
+  }
+  if (ptr != begin) {
+    *output = value;
+  }
+  return ptr;
 }
 
 void FormatData(std::ostream *out,
@@ -43,6 +43,7 @@ using ola::io::IOVecInterface;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
 
 MockUDPSocket::MockUDPSocket()
     : ola::network::UDPSocketInterface(),
@@ -133,21 +134,30 @@ ssize_t MockUDPSocket::SendTo(IOVecInterface *data,
     return 0;
   }
 
+  ssize_t data_sent = SendTo(iov, io_len,
+                             IPV4SocketAddress(ip_address, port));
+  data->Pop(data_sent);
+  data->FreeIOVec(iov);
+  return data_sent;
+}
+
+
+ssize_t MockUDPSocket::SendTo(const IOVec *iov,
+                              unsigned int iov_count,
+                              const IPV4SocketAddress &dest) const {
   unsigned int data_size = 0;
-  for (int i = 0; i < io_len; i++) {
+  for (unsigned int i = 0; i < iov_count; i++) {
     data_size += iov[i].iov_len;
   }
 
   uint8_t *raw_data = new uint8_t[data_size];
   unsigned int offset = 0;
-  for (int i = 0; i < io_len; i++) {
+  for (unsigned int i = 0; i < iov_count; i++) {
     memcpy(raw_data + offset, iov[i].iov_base, iov[i].iov_len);
     offset += iov[i].iov_len;
   }
 
-  data->Pop(data_size);
-  data->FreeIOVec(iov);
-  ssize_t data_sent = SendTo(raw_data, data_size, ip_address, port);
+  ssize_t data_sent = SendTo(raw_data, data_size, dest);
   delete[] raw_data;
   return data_sent;
 }
@@ -206,6 +216,35 @@ bool MockUDPSocket::RecvFrom(
 }
 
 
+unsigned int MockUDPSocket::RecvMultiple(UDPDatagram *datagrams,
+                                         unsigned int count) {
+  unsigned int received = 0;
+  for (; received < count && !m_received_data.empty(); received++) {
+    UDPDatagram *datagram = datagrams + received;
+    ssize_t size = datagram->buffer.iov_len;
+    RecvFrom(reinterpret_cast<uint8_t*>(datagram->buffer.iov_base), &size,
+             &datagram->address);
+    datagram->buffer.iov_len = size;
+    datagram->timestamp = ola::TimeStamp();
+  }
+  return received;
+}
+
+
+unsigned int MockUDPSocket::SendMultiple(const UDPDatagram *datagrams,
+                                         unsigned int count) const {
+  for (unsigned int i = 0; i < count; i++) {
+    if (datagrams[i].iov) {
+      SendTo(datagrams[i].iov, datagrams[i].iov_count, datagrams[i].address);
+    } else {
+      SendTo(reinterpret_cast<const uint8_t*>(datagrams[i].buffer.iov_base),
+             datagrams[i].buffer.iov_len, datagrams[i].address);
+    }
+  }
+  return count;
+}
+
+
 bool MockUDPSocket::EnableBroadcast() {
   m_broadcast_set = true;
   return true;
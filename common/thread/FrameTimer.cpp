@@ -0,0 +1,171 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FrameTimer.cpp
+ * Paces an output thread on absolute frame deadlines.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+
+#include "ola/thread/FrameTimer.h"
+
+namespace ola {
+namespace thread {
+
+namespace {
+// There is only ever one writer, so a relaxed load / store is enough to stop
+// readers from seeing a torn value.
+inline uint32_t Load(const uint32_t *value) {
+  return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+inline void Store(uint32_t *value, uint32_t new_value) {
+  __atomic_store_n(value, new_value, __ATOMIC_RELAXED);
+}
+}  // namespace
+
+FrameTimingStats::FrameTimingStats()
+    : m_frames(0),
+      m_missed_frames(0),
+      m_overruns(0),
+      m_jitter_us(0),
+      m_max_jitter_us(0) {
+}
+
+void FrameTimingStats::FrameStarted(const TimeInterval &lateness) {
+  int64_t delta = lateness.AsInt();
+  if (delta < 0) {
+    delta = 0;
+  }
+  Store(&m_frames, m_frames + 1);
+
+  int64_t jitter = m_jitter_us;
+  jitter += (delta - jitter) / 16;
+  Store(&m_jitter_us, static_cast<uint32_t>(jitter));
+  if (delta > m_max_jitter_us) {
+    Store(&m_max_jitter_us, static_cast<uint32_t>(delta));
+  }
+}
+
+void FrameTimingStats::FramesMissed(unsigned int count) {
+  Store(&m_missed_frames, m_missed_frames + count);
+}
+
+void FrameTimingStats::FrameOverran() {
+  Store(&m_overruns, m_overruns + 1);
+}
+
+uint32_t FrameTimingStats::Frames() const {
+  return Load(&m_frames);
+}
+
+uint32_t FrameTimingStats::MissedFrames() const {
+  return Load(&m_missed_frames);
+}
+
+uint32_t FrameTimingStats::Overruns() const {
+  return Load(&m_overruns);
+}
+
+uint32_t FrameTimingStats::JitterMicroSeconds() const {
+  return Load(&m_jitter_us);
+}
+
+uint32_t FrameTimingStats::MaxJitterMicroSeconds() const {
+  return Load(&m_max_jitter_us);
+}
+
+std::string FrameTimingStats::ToString() const {
+  std::ostringstream str;
+  str << "frames " << Frames() << ", missed " << MissedFrames()
+      << ", overruns " << Overruns() << ", jitter " << JitterMicroSeconds()
+      << "us, max " << MaxJitterMicroSeconds() << "us";
+  return str.str();
+}
+
+
+FrameTimer::FrameTimer(const TimeInterval &frame_time)
+    : m_frame_time(frame_time) {
+}
+
+void FrameTimer::Start() {
+  m_clock.CurrentMonotonicTime(&m_deadline);
+}
+
+void FrameTimer::WaitForNextFrame() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  if (!m_deadline.IsSet()) {
+    m_deadline = now;
+  }
+
+  TimeStamp next = m_deadline + m_frame_time;
+  const int64_t frame_time = m_frame_time.AsInt();
+  if (now > next) {
+    m_stats.FrameOverran();
+    if (frame_time > 0) {
+      // Skip any deadlines we've missed completely, but stay in phase.
+      unsigned int missed = (now - next).AsInt() / frame_time;
+      if (missed) {
+        next += m_frame_time * missed;
+        m_stats.FramesMissed(missed);
+      }
+    }
+  }
+
+  if (now < next) {
+    SleepUntil(m_clock, next);
+    m_clock.CurrentMonotonicTime(&now);
+  }
+  m_stats.FrameStarted(now - next);
+  m_deadline = next;
+}
+
+void FrameTimer::SleepFor(const TimeInterval &duration) {
+  Clock clock;
+  TimeStamp now;
+  clock.CurrentMonotonicTime(&now);
+  SleepUntil(clock, now + duration);
+}
+
+void FrameTimer::SleepUntil(const Clock &clock, const TimeStamp &deadline) {
+#if defined(HAVE_CLOCK_NANOSLEEP) && defined(CLOCK_MONOTONIC)
+  (void) clock;
+  struct timespec ts;
+  ts.tv_sec = deadline.Seconds();
+  ts.tv_nsec = deadline.MicroSeconds() * 1000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+  }
+#else
+  TimeStamp now;
+  clock.CurrentMonotonicTime(&now);
+  while (now < deadline) {
+    usleep((deadline - now).AsInt());
+    clock.CurrentMonotonicTime(&now);
+  }
+#endif  // defined(HAVE_CLOCK_NANOSLEEP) && defined(CLOCK_MONOTONIC)
+}
+}  // namespace thread
+}  // namespace ola
@@ -19,8 +19,11 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <string>
 
+#include "ola/Callback.h"
 #include "ola/Logging.h"
+#include "ola/thread/ExecutorThread.h"
 #include "ola/thread/Future.h"
 #include "ola/thread/Thread.h"
 #include "ola/testing/TestUtils.h"
@@ -29,19 +32,29 @@
 using ola::thread::ConditionVariable;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
+using ola::thread::ExecutorThread;
 using ola::thread::Future;
+using ola::thread::Thread;
+using ola::thread::ThreadId;
+using std::string;
 
 class FutureTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(FutureTest);
   CPPUNIT_TEST(testSingleThreadedFuture);
   CPPUNIT_TEST(testSingleThreadedVoidFuture);
   CPPUNIT_TEST(testMultithreadedFuture);
+  CPPUNIT_TEST(testThen);
+  CPPUNIT_TEST(testVoidThen);
+  CPPUNIT_TEST(testThenOnExecutor);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testSingleThreadedFuture();
     void testSingleThreadedVoidFuture();
     void testMultithreadedFuture();
+    void testThen();
+    void testVoidThen();
+    void testThenOnExecutor();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(FutureTest);
@@ -67,6 +80,33 @@ class AdderThread: public ola::thread::Thread {
     Future<int> *future;
 };
 
+namespace {
+int Double(const int &value) {
+  return value * 2;
+}
+
+string Describe(const int &value) {
+  return value > 10 ? "big" : "small";
+}
+
+void Record(int *output, const int &value) {
+  *output = value;
+}
+
+void Increment(int *counter) {
+  (*counter)++;
+}
+
+int Answer() {
+  return 42;
+}
+
+ThreadId CurrentThread(const int&) {
+  return Thread::Self();
+}
+}  // namespace
+
+
 /*
  * Check that single threaded Future functionality works.
  */
@@ -132,4 +172,86 @@ void FutureTest::testMultithreadedFuture() {
   OLA_ASSERT_FALSE(f1.IsComplete());
   thread.Run();
   OLA_ASSERT_EQ(8, f1.Get());
+
+  // Get() blocks until the value is set by another thread.
+  Future<int> f2;
+  AdderThread other_thread(4, 6, &f2);
+  OLA_ASSERT_TRUE(other_thread.Start());
+  OLA_ASSERT_EQ(10, f2.Get());
+  other_thread.Join();
+}
+
+
+/*
+ * Check continuations run, in order, when the Future is set.
+ */
+void FutureTest::testThen() {
+  Future<int> f1;
+  int recorded = 0;
+  Future<int> doubled = f1.Then(ola::NewSingleCallback(Double));
+  Future<string> described = doubled.Then(ola::NewSingleCallback(Describe));
+  Future<void> done = doubled.Then(ola::NewSingleCallback(Record, &recorded));
+  OLA_ASSERT_FALSE(doubled.IsComplete());
+  OLA_ASSERT_FALSE(done.IsComplete());
+
+  f1.Set(7);
+  OLA_ASSERT_TRUE(doubled.IsComplete());
+  OLA_ASSERT_EQ(14, doubled.Get());
+  OLA_ASSERT_EQ(string("big"), described.Get());
+  OLA_ASSERT_TRUE(done.IsComplete());
+  OLA_ASSERT_EQ(14, recorded);
+
+  // A continuation added to a completed Future runs immediately.
+  Future<int> quadrupled = doubled.Then(ola::NewSingleCallback(Double));
+  OLA_ASSERT_TRUE(quadrupled.IsComplete());
+  OLA_ASSERT_EQ(28, quadrupled.Get());
+
+  // The continuations of a Future that's never set are deleted with it.
+  Future<int> result;
+  {
+    Future<int> never_set;
+    result = never_set.Then(ola::NewSingleCallback(Double));
+  }
+  OLA_ASSERT_FALSE(result.IsComplete());
+}
+
+
+/*
+ * Check continuations of a Future<void>.
+ */
+void FutureTest::testVoidThen() {
+  Future<void> f1;
+  int counter = 0;
+  Future<void> incremented = f1.Then(ola::NewSingleCallback(Increment,
+                                                            &counter));
+  Future<int> answer = f1.Then(ola::NewSingleCallback(Answer));
+  OLA_ASSERT_EQ(0, counter);
+
+  f1.Set();
+  OLA_ASSERT_TRUE(incremented.IsComplete());
+  OLA_ASSERT_EQ(1, counter);
+  OLA_ASSERT_EQ(42, answer.Get());
+}
+
+
+/*
+ * Check continuations can be run on an executor.
+ */
+void FutureTest::testThenOnExecutor() {
+  ExecutorThread executor((Thread::Options()));
+  OLA_ASSERT_TRUE(executor.Start());
+
+  Future<int> f1;
+  Future<ThreadId> thread_id = f1.Then(
+      &executor, ola::NewSingleCallback(CurrentThread));
+  Future<int> doubled = f1.Then(&executor, ola::NewSingleCallback(Double));
+  f1.Set(3);
+  OLA_ASSERT_EQ(6, doubled.Get());
+  OLA_ASSERT_FALSE(pthread_equal(Thread::Self(), thread_id.Get()));
+
+  // Completed Futures still pass the callback to the executor.
+  Future<int> quadrupled = doubled.Then(&executor,
+                                        ola::NewSingleCallback(Double));
+  OLA_ASSERT_EQ(12, quadrupled.Get());
+  executor.Stop();
 }
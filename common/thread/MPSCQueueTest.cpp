@@ -0,0 +1,132 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MPSCQueueTest.cpp
+ * Test fixture for the MPSCQueue class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/thread/MPSCQueue.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::MPSCQueue;
+using std::string;
+using std::vector;
+
+class MPSCQueueTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MPSCQueueTest);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testThreaded);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testPushPop();
+    void testThreaded();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MPSCQueueTest);
+
+
+class ProducerThread: public ola::thread::Thread {
+ public:
+    ProducerThread(MPSCQueue<unsigned int> *queue, unsigned int id,
+                   unsigned int count)
+        : Thread(),
+          m_queue(queue),
+          m_id(id),
+          m_count(count) {
+    }
+
+    void *Run() {
+      // The top byte holds the producer id, the rest is the sequence number
+      for (unsigned int i = 1; i <= m_count; i++) {
+        m_queue->Push((m_id << 24) | i);
+      }
+      return NULL;
+    }
+
+ private:
+    MPSCQueue<unsigned int> *m_queue;
+    const unsigned int m_id;
+    const unsigned int m_count;
+};
+
+
+/*
+ * Check the basic Push / Pop behaviour.
+ */
+void MPSCQueueTest::testPushPop() {
+  MPSCQueue<string> queue;
+
+  string item;
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+
+  queue.Push("one");
+  queue.Push("two");
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("one"), item);
+  queue.Push("three");
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("two"), item);
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("three"), item);
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+
+  // Items left in the queue are freed by the destructor.
+  queue.Push("four");
+  queue.Push("five");
+}
+
+
+/*
+ * Check that items from many producers arrive, in order for each producer.
+ */
+void MPSCQueueTest::testThreaded() {
+  const unsigned int producer_count = 4;
+  const unsigned int count = 50000;
+  MPSCQueue<unsigned int> queue;
+
+  vector<ProducerThread*> producers;
+  for (unsigned int i = 0; i < producer_count; i++) {
+    producers.push_back(new ProducerThread(&queue, i, count));
+  }
+  for (unsigned int i = 0; i < producer_count; i++) {
+    OLA_ASSERT_TRUE(producers[i]->Start());
+  }
+
+  vector<unsigned int> expected(producer_count, 1);
+  unsigned int received = 0;
+  unsigned int item;
+  while (received < producer_count * count) {
+    if (queue.Pop(&item)) {
+      unsigned int id = item >> 24;
+      OLA_ASSERT_LT(id, producer_count);
+      OLA_ASSERT_EQ(expected[id], item & 0xffffff);
+      expected[id]++;
+      received++;
+    }
+  }
+
+  for (unsigned int i = 0; i < producer_count; i++) {
+    OLA_ASSERT_TRUE(producers[i]->Join());
+    delete producers[i];
+  }
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+}
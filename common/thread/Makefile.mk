@@ -3,22 +3,29 @@
 common_libolacommon_la_SOURCES += \
     common/thread/ConsumerThread.cpp \
     common/thread/ExecutorThread.cpp \
+    common/thread/FrameTimer.cpp \
     common/thread/Mutex.cpp \
     common/thread/PeriodicThread.cpp \
     common/thread/SignalThread.cpp \
     common/thread/Thread.cpp \
     common/thread/ThreadPool.cpp \
-    common/thread/Utils.cpp
+    common/thread/Utils.cpp \
+    common/thread/WorkStealingPool.cpp
 
 # TESTS
 ##################################################
 test_programs += common/thread/ExecutorThreadTester \
                  common/thread/ThreadTester \
-                 common/thread/FutureTester
+                 common/thread/FutureTester \
+                 common/thread/MPSCQueueTester \
+                 common/thread/SPSCQueueTester \
+                 common/thread/TripleBufferTester
 
 common_thread_ThreadTester_SOURCES = \
+    common/thread/PeriodicThreadTest.cpp \
     common/thread/ThreadPoolTest.cpp \
-    common/thread/ThreadTest.cpp
+    common/thread/ThreadTest.cpp \
+    common/thread/WorkStealingPoolTest.cpp
 common_thread_ThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_thread_ThreadTester_LDADD = $(COMMON_TESTING_LIBS)
 
@@ -30,3 +37,15 @@ common_thread_ExecutorThreadTester_SOURCES = \
     common/thread/ExecutorThreadTest.cpp
 common_thread_ExecutorThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_thread_ExecutorThreadTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_thread_MPSCQueueTester_SOURCES = common/thread/MPSCQueueTest.cpp
+common_thread_MPSCQueueTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_thread_MPSCQueueTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_thread_SPSCQueueTester_SOURCES = common/thread/SPSCQueueTest.cpp
+common_thread_SPSCQueueTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_thread_SPSCQueueTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_thread_TripleBufferTester_SOURCES = common/thread/TripleBufferTest.cpp
+common_thread_TripleBufferTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_thread_TripleBufferTester_LDADD = $(COMMON_TESTING_LIBS)
@@ -30,10 +30,12 @@ namespace thread {
 
 PeriodicThread::PeriodicThread(const TimeInterval &delay,
                                PeriodicCallback *callback,
-                               const Options &options)
+                               const Options &options,
+                               OverrunPolicy policy)
     : Thread(options),
       m_delay(delay),
       m_callback(callback),
+      m_policy(policy),
       m_terminate(false) {
   if (m_callback) {
     Start();
@@ -51,37 +53,63 @@ void PeriodicThread::Stop() {
 
 void *PeriodicThread::Run() {
   Clock clock;
-  TimeStamp last_run_at;
-
-  // Real time is used here because it gets passed into pthread_cond_timedwait
-  // which expects an absolute time
-  clock.CurrentRealTime(&last_run_at);
+  TimeStamp deadline;
+  clock.CurrentMonotonicTime(&deadline);
+  m_stats.FrameStarted(TimeInterval());
   if (!m_callback->Run()) {
     return NULL;
   }
 
+  const int64_t delay = m_delay.AsInt();
   while (true) {
-    {
-      MutexLocker lock(&m_mutex);
-      if (m_terminate) {
-        return NULL;
-      }
-      if (m_condition.TimedWait(&m_mutex, last_run_at + m_delay)) {
-        // Either m_terminate is true, or a spurious wake up
-        if (m_terminate) {
-          return NULL;
-        }
-        continue;
+    // The next deadline is relative to the last one, not to when the callback
+    // finished.
+    deadline += m_delay;
+
+    TimeStamp now;
+    clock.CurrentMonotonicTime(&now);
+    if (now > deadline) {
+      m_stats.FrameOverran();
+      if (m_policy == SKIP_MISSED_RUNS && delay > 0) {
+        // Round up, so we wait for the first deadline that hasn't passed.
+        unsigned int missed = ((now - deadline).AsInt() + delay - 1) / delay;
+        deadline += m_delay * missed;
+        m_stats.FramesMissed(missed);
       }
     }
-    // Real time is used here again to maintain clock consistency with the
-    // previous call to CurrentRealTime()
-    clock.CurrentRealTime(&last_run_at);
+
+    if (!WaitUntil(clock, deadline)) {
+      return NULL;
+    }
+    clock.CurrentMonotonicTime(&now);
+    m_stats.FrameStarted(now - deadline);
     if (!m_callback->Run()) {
       return NULL;
     }
   }
   return NULL;
 }
+
+/*
+ * Wait until the monotonic deadline.
+ * @returns false if the thread was stopped, true otherwise.
+ */
+bool PeriodicThread::WaitUntil(const Clock &clock, const TimeStamp &deadline) {
+  MutexLocker lock(&m_mutex);
+  while (!m_terminate) {
+    TimeStamp now;
+    clock.CurrentMonotonicTime(&now);
+    if (now >= deadline) {
+      return true;
+    }
+    // pthread_cond_timedwait expects an absolute real time, so convert the
+    // remaining time. Doing this on each wait means a step in the real time
+    // only affects a single wait.
+    TimeStamp wake_up_time;
+    clock.CurrentRealTime(&wake_up_time);
+    m_condition.TimedWait(&m_mutex, wake_up_time + (deadline - now));
+  }
+  return false;
+}
 }  // namespace thread
 }  // namespace ola
@@ -0,0 +1,173 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PeriodicThreadTest.cpp
+ * Test fixture for the PeriodicThread class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/PeriodicThread.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::NewCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::ConditionVariable;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using ola::thread::PeriodicThread;
+
+
+class PeriodicThreadTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PeriodicThreadTest);
+  CPPUNIT_TEST(testFixedRate);
+  CPPUNIT_TEST(testSkipMissedRuns);
+  CPPUNIT_TEST(testCatchUp);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testFixedRate();
+  void testSkipMissedRuns();
+  void testCatchUp();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PeriodicThreadTest);
+
+namespace {
+/*
+ * Counts the runs, and stops the thread after a number of them.
+ */
+class RunCounter {
+ public:
+  RunCounter(unsigned int runs, unsigned int first_run_us,
+             unsigned int run_us)
+      : m_runs(runs),
+        m_first_run_us(first_run_us),
+        m_run_us(run_us),
+        m_count(0) {
+  }
+
+  bool Run() {
+    usleep(m_count ? m_run_us : m_first_run_us);
+    MutexLocker lock(&m_mutex);
+    m_count++;
+    if (m_count == m_runs) {
+      m_condition.Signal();
+      return false;
+    }
+    return true;
+  }
+
+  void WaitForRuns() {
+    MutexLocker lock(&m_mutex);
+    while (m_count < m_runs) {
+      m_condition.Wait(&m_mutex);
+    }
+  }
+
+ private:
+  const unsigned int m_runs;
+  const unsigned int m_first_run_us;
+  const unsigned int m_run_us;
+  unsigned int m_count;
+  Mutex m_mutex;
+  ConditionVariable m_condition;
+};
+}  // namespace
+
+
+/*
+ * Check the time the callback takes doesn't add to the period.
+ */
+void PeriodicThreadTest::testFixedRate() {
+  Clock clock;
+  TimeStamp start, end;
+  // Each run takes most of the period, if the period was measured from the end
+  // of the callback, 20 runs would take 180ms.
+  RunCounter counter(20, 4000, 4000);
+  std::auto_ptr<PeriodicThread::PeriodicCallback> callback(
+      NewCallback(&counter, &RunCounter::Run));
+
+  clock.CurrentMonotonicTime(&start);
+  PeriodicThread thread(TimeInterval(0, 5000), callback.get());
+  counter.WaitForRuns();
+  clock.CurrentMonotonicTime(&end);
+  thread.Stop();
+
+  OLA_ASSERT_EQ(20u, thread.Stats().Frames());
+  OLA_ASSERT_EQ(0u, thread.Stats().MissedFrames());
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 95000));
+  OLA_ASSERT_TRUE(end - start < TimeInterval(0, 150000));
+}
+
+
+/*
+ * Check deadlines that have passed are skipped by default.
+ */
+void PeriodicThreadTest::testSkipMissedRuns() {
+  Clock clock;
+  TimeStamp start, end;
+  // The first run takes 3.5 periods.
+  RunCounter counter(3, 35000, 0);
+  std::auto_ptr<PeriodicThread::PeriodicCallback> callback(
+      NewCallback(&counter, &RunCounter::Run));
+
+  clock.CurrentMonotonicTime(&start);
+  PeriodicThread thread(TimeInterval(0, 10000), callback.get());
+  counter.WaitForRuns();
+  clock.CurrentMonotonicTime(&end);
+  thread.Stop();
+
+  // The 10, 20 & 30ms deadlines are skipped, the next runs are at 40 & 50ms.
+  OLA_ASSERT_EQ(3u, thread.Stats().Frames());
+  OLA_ASSERT_TRUE(thread.Stats().Overruns() >= 1u);
+  OLA_ASSERT_TRUE(thread.Stats().MissedFrames() >= 3u);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 50000));
+}
+
+
+/*
+ * Check the CATCH_UP policy runs the callback for each missed deadline.
+ */
+void PeriodicThreadTest::testCatchUp() {
+  Clock clock;
+  TimeStamp start, end;
+  RunCounter counter(5, 35000, 0);
+  std::auto_ptr<PeriodicThread::PeriodicCallback> callback(
+      NewCallback(&counter, &RunCounter::Run));
+
+  clock.CurrentMonotonicTime(&start);
+  PeriodicThread thread(TimeInterval(0, 10000), callback.get(),
+                        ola::thread::Thread::Options(),
+                        PeriodicThread::CATCH_UP);
+  counter.WaitForRuns();
+  clock.CurrentMonotonicTime(&end);
+  thread.Stop();
+
+  // The runs for the 10, 20 & 30ms deadlines happen back to back, the last
+  // run is at 40ms.
+  OLA_ASSERT_EQ(5u, thread.Stats().Frames());
+  OLA_ASSERT_EQ(0u, thread.Stats().MissedFrames());
+  OLA_ASSERT_TRUE(thread.Stats().Overruns() >= 1u);
+  OLA_ASSERT_TRUE(end - start < TimeInterval(0, 60000));
+}
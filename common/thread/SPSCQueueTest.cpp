@@ -0,0 +1,136 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SPSCQueueTest.cpp
+ * Test fixture for the SPSCQueue class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/thread/SPSCQueue.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::SPSCQueue;
+using std::string;
+
+class SPSCQueueTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPSCQueueTest);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testWrapAround);
+  CPPUNIT_TEST(testThreaded);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testPushPop();
+    void testWrapAround();
+    void testThreaded();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPSCQueueTest);
+
+
+class ProducerThread: public ola::thread::Thread {
+ public:
+    ProducerThread(SPSCQueue<unsigned int> *queue, unsigned int count)
+        : Thread(),
+          m_queue(queue),
+          m_count(count) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 1; i <= m_count; i++) {
+        while (!m_queue->Push(i)) {}
+      }
+      return NULL;
+    }
+
+ private:
+    SPSCQueue<unsigned int> *m_queue;
+    const unsigned int m_count;
+};
+
+
+/*
+ * Check the basic Push / Pop behaviour.
+ */
+void SPSCQueueTest::testPushPop() {
+  SPSCQueue<string> queue(3);
+  OLA_ASSERT_EQ(static_cast<size_t>(4), queue.Capacity());
+  OLA_ASSERT_TRUE(queue.Empty());
+
+  string item;
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+
+  OLA_ASSERT_TRUE(queue.Push("one"));
+  OLA_ASSERT_TRUE(queue.Push("two"));
+  OLA_ASSERT_TRUE(queue.Push("three"));
+  OLA_ASSERT_TRUE(queue.Push("four"));
+  OLA_ASSERT_FALSE(queue.Push("five"));
+  OLA_ASSERT_FALSE(queue.Empty());
+
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("one"), item);
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("two"), item);
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("three"), item);
+  OLA_ASSERT_TRUE(queue.Pop(&item));
+  OLA_ASSERT_EQ(string("four"), item);
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+  OLA_ASSERT_TRUE(queue.Empty());
+}
+
+
+/*
+ * Check the indices wrap correctly.
+ */
+void SPSCQueueTest::testWrapAround() {
+  SPSCQueue<unsigned int> queue(4);
+  unsigned int item;
+  for (unsigned int i = 0; i < 100; i++) {
+    OLA_ASSERT_TRUE(queue.Push(i));
+    OLA_ASSERT_TRUE(queue.Push(i + 1000));
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i, item);
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i + 1000, item);
+  }
+  OLA_ASSERT_TRUE(queue.Empty());
+}
+
+
+/*
+ * Check that items pass between threads in order.
+ */
+void SPSCQueueTest::testThreaded() {
+  const unsigned int count = 100000;
+  SPSCQueue<unsigned int> queue(64);
+  ProducerThread producer(&queue, count);
+  OLA_ASSERT_TRUE(producer.Start());
+
+  unsigned int expected = 1;
+  unsigned int item;
+  while (expected <= count) {
+    if (queue.Pop(&item)) {
+      OLA_ASSERT_EQ(expected, item);
+      expected++;
+    }
+  }
+  OLA_ASSERT_TRUE(producer.Join());
+  OLA_ASSERT_TRUE(queue.Empty());
+}
@@ -37,14 +37,24 @@
 #endif  // HAVE_PTHREAD_NP_H
 
 
+#include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/thread/Thread.h"
 #include "ola/thread/Utils.h"
 
 namespace  {
 
+using ola::thread::Mutex;
+using ola::thread::Thread;
+using std::map;
+using std::string;
+
 /*
  * Called by the new thread
  */
@@ -52,6 +62,38 @@ void *StartThread(void *d) {
   ola::thread::Thread *thread = static_cast<ola::thread::Thread*>(d);
   return thread->_InternalRun();
 }
+
+// The placements from Thread::SetPlacement() & the effective placement of
+// each running thread, both protected by placement_mutex.
+Mutex placement_mutex;
+map<string, Thread::Placement> placements;
+map<string, string> effective_placements;
+
+/*
+ * Record the placement of the calling thread.
+ * @returns the key the placement was recorded under.
+ */
+string RecordPlacement(const string &name) {
+  int policy;
+  struct sched_param param;
+  pthread_getschedparam(pthread_self(), &policy, &param);
+
+  std::ostringstream str;
+  str << "policy=" << ola::thread::PolicyToString(policy)
+      << " priority=" << param.sched_priority;
+  std::vector<unsigned int> cpus;
+  if (ola::thread::GetThreadAffinity(pthread_self(), &cpus)) {
+    str << " cpus=" << ola::thread::CPUListToString(cpus);
+  }
+
+  ola::thread::MutexLocker locker(&placement_mutex);
+  string key = name;
+  for (unsigned int i = 2; ola::STLContains(effective_placements, key); i++) {
+    key = name + "-" + ola::IntToString(i);
+  }
+  effective_placements[key] = str.str();
+  return key;
+}
 }  // namespace
 
 namespace ola {
@@ -59,6 +101,46 @@ namespace thread {
 
 using std::string;
 
+void Thread::SetPlacement(const string &name, const Placement &placement) {
+  MutexLocker locker(&placement_mutex);
+  placements[name] = placement;
+}
+
+void Thread::ClearPlacements() {
+  MutexLocker locker(&placement_mutex);
+  placements.clear();
+}
+
+bool Thread::PlaceCurrentThread(const string &name) {
+  Placement placement;
+  bool found = false;
+  {
+    MutexLocker locker(&placement_mutex);
+    const Placement *configured = STLFind(&placements, name);
+    if (configured) {
+      placement = *configured;
+      found = true;
+    }
+  }
+
+  bool ok = true;
+  if (found && placement.set_scheduling) {
+    struct sched_param param;
+    param.sched_priority = placement.priority;
+    ok &= SetSchedParam(pthread_self(), placement.policy, param);
+  }
+  if (found && !placement.cpus.empty()) {
+    ok &= SetThreadAffinity(pthread_self(), placement.cpus);
+  }
+  RecordPlacement(name);
+  return ok;
+}
+
+void Thread::EffectivePlacements(map<string, string> *placements) {
+  MutexLocker locker(&placement_mutex);
+  *placements = effective_placements;
+}
+
 Thread::Options::Options(const std::string &name)
   : name(name),
     inheritsched(PTHREAD_EXPLICIT_SCHED) {
@@ -102,6 +184,20 @@ bool Thread::Start() {
 }
 
 bool Thread::FastStart() {
+  {
+    MutexLocker locker(&placement_mutex);
+    const Placement *placement = STLFind(&placements, m_options.name);
+    if (placement) {
+      if (placement->set_scheduling) {
+        m_options.policy = placement->policy;
+        m_options.priority = placement->priority;
+      }
+      if (!placement->cpus.empty()) {
+        m_options.cpus = placement->cpus;
+      }
+    }
+  }
+
   pthread_attr_t attrs;
   pthread_attr_init(&attrs);
 
@@ -199,12 +295,20 @@ void *Thread::_InternalRun() {
 
   OLA_INFO << "Thread " << Name() << ", policy " << PolicyToString(policy)
            << ", priority " << param.sched_priority;
+  if (!m_options.cpus.empty()) {
+    SetThreadAffinity(pthread_self(), m_options.cpus);
+  }
+  m_placement_key = RecordPlacement(Name());
   {
     MutexLocker locker(&m_mutex);
     m_running = true;
   }
   m_condition.Signal();
-  return Run();
+  void *ret = Run();
+
+  MutexLocker locker(&placement_mutex);
+  effective_placements.erase(m_placement_key);
+  return ret;
 }
 }  // namespace thread
 }  // namespace ola
@@ -29,8 +29,12 @@
 #include <sys/resource.h>
 #endif  // _WIN32
 #include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/system/Limits.h"
 #include "ola/testing/TestUtils.h"
 #include "ola/thread/Thread.h"
@@ -41,6 +45,9 @@ using ola::thread::ConditionVariable;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using ola::thread::Thread;
+using std::map;
+using std::string;
+using std::vector;
 
 // A struct containing the scheduling parameters.
 struct SchedulingParams {
@@ -110,12 +117,18 @@ class ThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testThread);
   CPPUNIT_TEST(testSchedulingOptions);
   CPPUNIT_TEST(testConditionVariable);
+  CPPUNIT_TEST(testCPUList);
+  CPPUNIT_TEST(testThreadPlacements);
+  CPPUNIT_TEST(testEffectivePlacements);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testThread();
   void testConditionVariable();
   void testSchedulingOptions();
+  void testCPUList();
+  void testThreadPlacements();
+  void testEffectivePlacements();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ThreadTest);
@@ -269,3 +282,138 @@ void ThreadTest::testConditionVariable() {
 
   thread.Join();
 }
+
+
+/*
+ * Check the CPU lists are parsed & formatted correctly.
+ */
+void ThreadTest::testCPUList() {
+  vector<unsigned int> cpus;
+  OLA_ASSERT_TRUE(ola::thread::StringToCPUList("", &cpus));
+  OLA_ASSERT_TRUE(cpus.empty());
+  OLA_ASSERT_EQ(string(""), ola::thread::CPUListToString(cpus));
+
+  OLA_ASSERT_TRUE(ola::thread::StringToCPUList("3", &cpus));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), cpus.size());
+  OLA_ASSERT_EQ(3u, cpus[0]);
+  OLA_ASSERT_EQ(string("3"), ola::thread::CPUListToString(cpus));
+
+  OLA_ASSERT_TRUE(ola::thread::StringToCPUList("5,0,2-3,3", &cpus));
+  OLA_ASSERT_EQ(static_cast<size_t>(4), cpus.size());
+  OLA_ASSERT_EQ(0u, cpus[0]);
+  OLA_ASSERT_EQ(2u, cpus[1]);
+  OLA_ASSERT_EQ(3u, cpus[2]);
+  OLA_ASSERT_EQ(5u, cpus[3]);
+  OLA_ASSERT_EQ(string("0,2-3,5"), ola::thread::CPUListToString(cpus));
+
+  OLA_ASSERT_FALSE(ola::thread::StringToCPUList("a", &cpus));
+  OLA_ASSERT_FALSE(ola::thread::StringToCPUList("1,", &cpus));
+  OLA_ASSERT_FALSE(ola::thread::StringToCPUList("3-1", &cpus));
+  OLA_ASSERT_FALSE(ola::thread::StringToCPUList("-1", &cpus));
+  OLA_ASSERT_FALSE(ola::thread::StringToCPUList("0-4294967295", &cpus));
+}
+
+/*
+ * Check the --thread-placement format is parsed correctly.
+ */
+void ThreadTest::testThreadPlacements() {
+  map<string, Thread::Placement> placements;
+  OLA_ASSERT_TRUE(ola::thread::StringToThreadPlacements("", &placements));
+  OLA_ASSERT_TRUE(placements.empty());
+
+  OLA_ASSERT_TRUE(ola::thread::StringToThreadPlacements(
+      "http=3; main=0-1:fifo:10;usbpro-detector=:other:0", &placements));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), placements.size());
+
+  const Thread::Placement &http = placements["http"];
+  OLA_ASSERT_EQ(string("3"), ola::thread::CPUListToString(http.cpus));
+  OLA_ASSERT_FALSE(http.set_scheduling);
+
+  const Thread::Placement &main = placements["main"];
+  OLA_ASSERT_EQ(string("0-1"), ola::thread::CPUListToString(main.cpus));
+  OLA_ASSERT_TRUE(main.set_scheduling);
+  OLA_ASSERT_EQ(static_cast<int>(SCHED_FIFO), main.policy);
+  OLA_ASSERT_EQ(10, main.priority);
+
+  const Thread::Placement &detector = placements["usbpro-detector"];
+  OLA_ASSERT_TRUE(detector.cpus.empty());
+  OLA_ASSERT_TRUE(detector.set_scheduling);
+  OLA_ASSERT_EQ(static_cast<int>(SCHED_OTHER), detector.policy);
+
+  OLA_ASSERT_FALSE(ola::thread::StringToThreadPlacements("http", &placements));
+  OLA_ASSERT_FALSE(ola::thread::StringToThreadPlacements("=1", &placements));
+  OLA_ASSERT_FALSE(
+      ola::thread::StringToThreadPlacements("http=x", &placements));
+  OLA_ASSERT_FALSE(
+      ola::thread::StringToThreadPlacements("http=1:fifo", &placements));
+  OLA_ASSERT_FALSE(
+      ola::thread::StringToThreadPlacements("http=1:idle:1", &placements));
+}
+
+// A thread that runs until it's told to stop.
+class BlockingThread: public Thread {
+ public:
+  BlockingThread()
+      : Thread(Options("blocking")),
+        m_started(false),
+        m_stop(false) {
+  }
+
+  void *Run() {
+    MutexLocker locker(&m_mutex);
+    m_started = true;
+    m_condition.Signal();
+    while (!m_stop) {
+      m_condition.Wait(&m_mutex);
+    }
+    return NULL;
+  }
+
+  void WaitUntilStarted() {
+    MutexLocker locker(&m_mutex);
+    while (!m_started) {
+      m_condition.Wait(&m_mutex);
+    }
+  }
+
+  void Stop() {
+    {
+      MutexLocker locker(&m_mutex);
+      m_stop = true;
+      m_condition.Signal();
+    }
+    Join();
+  }
+
+ private:
+  bool m_started;
+  bool m_stop;
+  Mutex m_mutex;
+  ConditionVariable m_condition;
+};
+
+/*
+ * Check that running threads appear in the effective placements.
+ */
+void ThreadTest::testEffectivePlacements() {
+  map<string, string> placements;
+  Thread::EffectivePlacements(&placements);
+  OLA_ASSERT_FALSE(ola::STLContains(placements, "blocking"));
+
+  BlockingThread thread1, thread2;
+  thread1.Start();
+  thread1.WaitUntilStarted();
+  thread2.Start();
+  thread2.WaitUntilStarted();
+
+  Thread::EffectivePlacements(&placements);
+  OLA_ASSERT_TRUE(ola::STLContains(placements, "blocking"));
+  OLA_ASSERT_TRUE(ola::STLContains(placements, "blocking-2"));
+  OLA_ASSERT_EQ(string::size_type(0), placements["blocking"].find("policy="));
+
+  thread1.Stop();
+  thread2.Stop();
+  Thread::EffectivePlacements(&placements);
+  OLA_ASSERT_FALSE(ola::STLContains(placements, "blocking"));
+  OLA_ASSERT_FALSE(ola::STLContains(placements, "blocking-2"));
+}
@@ -0,0 +1,124 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TripleBufferTest.cpp
+ * Test fixture for the TripleBuffer class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::TripleBuffer;
+using std::string;
+
+class TripleBufferTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TripleBufferTest);
+  CPPUNIT_TEST(testWriteUpdate);
+  CPPUNIT_TEST(testBackPublish);
+  CPPUNIT_TEST(testThreaded);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testWriteUpdate();
+    void testBackPublish();
+    void testThreaded();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TripleBufferTest);
+
+
+class WriterThread: public ola::thread::Thread {
+ public:
+    WriterThread(TripleBuffer<unsigned int> *buffer, unsigned int count)
+        : Thread(),
+          m_buffer(buffer),
+          m_count(count) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 1; i <= m_count; i++) {
+        m_buffer->Write(i);
+      }
+      return NULL;
+    }
+
+ private:
+    TripleBuffer<unsigned int> *m_buffer;
+    const unsigned int m_count;
+};
+
+
+/*
+ * Check the reader sees the latest value written.
+ */
+void TripleBufferTest::testWriteUpdate() {
+  TripleBuffer<string> buffer;
+  OLA_ASSERT_FALSE(buffer.Update());
+  OLA_ASSERT_EQ(string(""), buffer.Front());
+
+  buffer.Write("one");
+  OLA_ASSERT_TRUE(buffer.Update());
+  OLA_ASSERT_EQ(string("one"), buffer.Front());
+  OLA_ASSERT_FALSE(buffer.Update());
+  OLA_ASSERT_EQ(string("one"), buffer.Front());
+
+  // Intermediate values are dropped.
+  buffer.Write("two");
+  buffer.Write("three");
+  buffer.Write("four");
+  OLA_ASSERT_TRUE(buffer.Update());
+  OLA_ASSERT_EQ(string("four"), buffer.Front());
+  OLA_ASSERT_FALSE(buffer.Update());
+}
+
+
+/*
+ * Check values can be built in place.
+ */
+void TripleBufferTest::testBackPublish() {
+  TripleBuffer<string> buffer;
+  for (unsigned int i = 0; i < 10; i++) {
+    buffer.Back().assign(i + 1, 'x');
+    buffer.Publish();
+    OLA_ASSERT_TRUE(buffer.Update());
+    OLA_ASSERT_EQ(string(i + 1, 'x'), buffer.Front());
+  }
+}
+
+
+/*
+ * Check the reader never goes backwards when the writer is another thread.
+ */
+void TripleBufferTest::testThreaded() {
+  const unsigned int count = 100000;
+  TripleBuffer<unsigned int> buffer;
+  WriterThread writer(&buffer, count);
+  OLA_ASSERT_TRUE(writer.Start());
+
+  unsigned int last = 0;
+  while (last < count) {
+    if (buffer.Update()) {
+      OLA_ASSERT_TRUE(buffer.Front() > last);
+      last = buffer.Front();
+    }
+  }
+  OLA_ASSERT_TRUE(writer.Join());
+  OLA_ASSERT_FALSE(buffer.Update());
+}
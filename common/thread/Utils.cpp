@@ -31,14 +31,25 @@
 #define WIN32_LEAN_AND_MEAN
 #endif  // _WIN32
 #include <pthread.h>
+#include <sched.h>
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
 namespace thread {
 
+namespace {
+// Guards against lists like 0-4294967295, this matches glibc's CPU_SETSIZE.
+const unsigned int MAX_CPUS = 1024;
+}  // namespace
+
 std::string PolicyToString(int policy) {
   switch (policy) {
     case SCHED_FIFO:
@@ -66,5 +77,188 @@ bool SetSchedParam(pthread_t thread, int policy,
   }
   return true;
 }
+
+bool SetThreadAffinity(pthread_t thread, unsigned int cpu) {
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  if (cpu >= CPU_SETSIZE) {
+    OLA_WARN << "Invalid CPU " << cpu;
+    return false;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  int r = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+  if (r != 0) {
+    OLA_WARN << "Unable to set the affinity of thread " << thread
+             << " to CPU " << cpu << ": " << strerror(r);
+    return false;
+  }
+  return true;
+#else
+  OLA_WARN << "Thread affinity isn't supported on this platform";
+  (void) thread;
+  (void) cpu;
+  return false;
+#endif  // HAVE_PTHREAD_SETAFFINITY_NP
+}
+
+bool SetThreadAffinity(pthread_t thread,
+                       const std::vector<unsigned int> &cpus) {
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  std::vector<unsigned int>::const_iterator iter = cpus.begin();
+  for (; iter != cpus.end(); ++iter) {
+    if (*iter >= CPU_SETSIZE) {
+      OLA_WARN << "Invalid CPU " << *iter;
+      return false;
+    }
+    CPU_SET(*iter, &cpu_set);
+  }
+  int r = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+  if (r != 0) {
+    OLA_WARN << "Unable to set the affinity of thread " << thread
+             << " to CPUs " << CPUListToString(cpus) << ": " << strerror(r);
+    return false;
+  }
+  return true;
+#else
+  OLA_WARN << "Thread affinity isn't supported on this platform";
+  (void) thread;
+  (void) cpus;
+  return false;
+#endif  // HAVE_PTHREAD_SETAFFINITY_NP
+}
+
+bool GetThreadAffinity(pthread_t thread, std::vector<unsigned int> *cpus) {
+  cpus->clear();
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (pthread_getaffinity_np(thread, sizeof(cpu_set), &cpu_set) != 0) {
+    return false;
+  }
+  for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &cpu_set)) {
+      cpus->push_back(cpu);
+    }
+  }
+  return true;
+#else
+  (void) thread;
+  return false;
+#endif  // HAVE_PTHREAD_SETAFFINITY_NP
+}
+
+bool StringToPolicy(const std::string &name, int *policy) {
+  std::string lower_name = name;
+  ToLower(&lower_name);
+  if (lower_name == "fifo") {
+    *policy = SCHED_FIFO;
+  } else if (lower_name == "rr") {
+    *policy = SCHED_RR;
+  } else if (lower_name == "other") {
+    *policy = SCHED_OTHER;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool StringToCPUList(const std::string &str, std::vector<unsigned int> *cpus) {
+  cpus->clear();
+  if (str.empty()) {
+    return true;
+  }
+
+  std::vector<std::string> ranges;
+  StringSplit(str, &ranges, ",");
+  std::vector<std::string>::const_iterator iter = ranges.begin();
+  for (; iter != ranges.end(); ++iter) {
+    const std::string::size_type dash = iter->find('-');
+    unsigned int first, last;
+    if (dash == std::string::npos) {
+      if (!StringToInt(*iter, &first, true)) {
+        return false;
+      }
+      last = first;
+    } else if (!StringToInt(iter->substr(0, dash), &first, true) ||
+               !StringToInt(iter->substr(dash + 1), &last, true) ||
+               last < first) {
+      return false;
+    }
+    if (last >= MAX_CPUS) {
+      return false;
+    }
+    for (unsigned int cpu = first; cpu <= last; cpu++) {
+      cpus->push_back(cpu);
+    }
+  }
+  std::sort(cpus->begin(), cpus->end());
+  cpus->erase(std::unique(cpus->begin(), cpus->end()), cpus->end());
+  return true;
+}
+
+std::string CPUListToString(const std::vector<unsigned int> &cpus) {
+  std::ostringstream str;
+  std::vector<unsigned int>::const_iterator iter = cpus.begin();
+  while (iter != cpus.end()) {
+    std::vector<unsigned int>::const_iterator last = iter;
+    while (last + 1 != cpus.end() && *(last + 1) == *last + 1) {
+      ++last;
+    }
+    if (iter != cpus.begin()) {
+      str << ",";
+    }
+    str << *iter;
+    if (last != iter) {
+      str << "-" << *last;
+    }
+    iter = last + 1;
+  }
+  return str.str();
+}
+
+bool StringToThreadPlacements(
+    const std::string &str,
+    std::map<std::string, Thread::Placement> *placements) {
+  placements->clear();
+  std::vector<std::string> entries;
+  StringSplit(str, &entries, ";");
+  std::vector<std::string>::iterator iter = entries.begin();
+  for (; iter != entries.end(); ++iter) {
+    StringTrim(&*iter);
+    if (iter->empty()) {
+      continue;
+    }
+
+    const std::string::size_type equals = iter->find('=');
+    if (equals == std::string::npos || equals == 0) {
+      OLA_WARN << "Invalid thread placement " << *iter;
+      return false;
+    }
+
+    std::vector<std::string> fields;
+    StringSplit(iter->substr(equals + 1), &fields, ":");
+    Thread::Placement placement;
+    if (!StringToCPUList(fields[0], &placement.cpus)) {
+      OLA_WARN << "Invalid CPUs in thread placement " << *iter;
+      return false;
+    }
+    if (fields.size() == 3) {
+      placement.set_scheduling = true;
+      if (!StringToPolicy(fields[1], &placement.policy) ||
+          !StringToInt(fields[2], &placement.priority, true)) {
+        OLA_WARN << "Invalid scheduling in thread placement " << *iter;
+        return false;
+      }
+    } else if (fields.size() != 1) {
+      OLA_WARN << "Invalid thread placement " << *iter;
+      return false;
+    }
+    (*placements)[iter->substr(0, equals)] = placement;
+  }
+  return true;
+}
 }  // namespace thread
 }  // namespace ola
@@ -0,0 +1,324 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingPool.cpp
+ * A thread pool where each worker has its own queue.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/thread/Thread.h"
+#include "ola/thread/Utils.h"
+#include "ola/thread/WorkStealingPool.h"
+
+namespace ola {
+namespace thread {
+
+using std::vector;
+
+/*
+ * A worker thread, and the deque of callbacks it owns.
+ */
+class WorkStealingPool::Worker: public Thread {
+ public:
+  Worker(WorkStealingPool *pool, const Thread::Options &options,
+         unsigned int index, int cpu)
+      : Thread(options),
+        index(index),
+        m_pool(pool),
+        m_cpu(cpu) {
+  }
+
+  const unsigned int index;
+
+  // The owner pushes and pops at the back, thieves take from the front.
+  std::deque<Action> actions;
+  Mutex mutex;  // protects actions
+
+ protected:
+  void *Run() {
+    if (m_cpu >= 0) {
+      SetThreadAffinity(Thread::Self(), static_cast<unsigned int>(m_cpu));
+    }
+    m_pool->WorkerLoop(this);
+    return NULL;
+  }
+
+ private:
+  WorkStealingPool *m_pool;
+  const int m_cpu;
+};
+
+
+/*
+ * Tracks the blocks of a ParallelFor() call.
+ */
+struct WorkStealingPool::RangeState {
+ public:
+  RangeState(RangeCallback *callback, int blocks)
+      : callback(callback),
+        remaining(blocks) {
+  }
+
+  RangeCallback *callback;
+  int remaining;  // modified with mutex held
+  Mutex mutex;
+  ConditionVariable done;
+};
+
+
+WorkStealingPool::WorkStealingPool(const Options &options)
+    : m_options(options),
+      m_started(false),
+      m_shutdown(false),
+      m_pending(0),
+      m_idle(0),
+      m_next_worker(0) {
+  // There is always at least one deque, even if there are no threads to
+  // service it.
+  const unsigned int worker_count = std::max(options.thread_count, 1u);
+  for (unsigned int i = 0; i < worker_count; i++) {
+    int cpu = -1;
+    if (!options.cpus.empty()) {
+      cpu = static_cast<int>(options.cpus[i % options.cpus.size()]);
+    }
+    m_workers.push_back(new Worker(this, options.thread_options, i, cpu));
+  }
+}
+
+
+WorkStealingPool::~WorkStealingPool() {
+  StopWorkers();
+  DrainCallbacks();
+  STLDeleteElements(&m_workers);
+}
+
+
+bool WorkStealingPool::Init() {
+  if (m_started) {
+    OLA_WARN << "WorkStealingPool already started";
+    return false;
+  }
+  if (m_options.thread_count == 0) {
+    OLA_WARN << "WorkStealingPool created with no threads";
+    return false;
+  }
+
+  m_started = true;
+  vector<Worker*>::iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    if (!(*iter)->Start()) {
+      OLA_WARN << "Failed to start worker thread, aborting "
+               << "WorkStealingPool::Init()";
+      StopWorkers();
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void WorkStealingPool::JoinAll() {
+  StopWorkers();
+}
+
+
+void WorkStealingPool::Execute(ola::BaseCallback0<void> *callback) {
+  Worker *worker = CurrentWorker();
+  if (worker) {
+    MutexLocker locker(&worker->mutex);
+    worker->actions.push_back(callback);
+  } else {
+    unsigned int index = __atomic_fetch_add(&m_next_worker, 1,
+                                            __ATOMIC_RELAXED);
+    worker = m_workers[index % m_workers.size()];
+    MutexLocker locker(&worker->mutex);
+    worker->actions.push_back(callback);
+  }
+
+  // A worker increments m_idle before it checks m_pending, and we increment
+  // m_pending before we check m_idle, so at least one of us sees the other.
+  __atomic_add_fetch(&m_pending, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&m_idle, __ATOMIC_SEQ_CST) > 0) {
+    MutexLocker locker(&m_idle_mutex);
+    m_work_available.Signal();
+  }
+}
+
+
+void WorkStealingPool::DrainCallbacks() {
+  Action action;
+  while (TakeAction(CurrentWorker(), &action)) {
+    action->Run();
+  }
+}
+
+
+void WorkStealingPool::ParallelFor(unsigned int begin,
+                                   unsigned int end,
+                                   unsigned int grain,
+                                   RangeCallback *callback) {
+  std::auto_ptr<RangeCallback> range_callback(callback);
+  if (begin >= end) {
+    return;
+  }
+  if (grain == 0) {
+    grain = 1;
+  }
+
+  const unsigned int size = end - begin;
+  const unsigned int blocks = size / grain + (size % grain ? 1 : 0);
+  RangeState state(callback, static_cast<int>(blocks));
+
+  unsigned int block_start = begin;
+  while (block_start < end) {
+    unsigned int block_end = end - block_start > grain ?
+        block_start + grain : end;
+    Execute(NewSingleCallback(this, &WorkStealingPool::RunRange, &state,
+                              block_start, block_end));
+    block_start = block_end;
+  }
+
+  // Help out until there is nothing left to take, then wait for the blocks
+  // that are running in other threads.
+  Worker *self = CurrentWorker();
+  Action action;
+  while (__atomic_load_n(&state.remaining, __ATOMIC_ACQUIRE) > 0 &&
+         TakeAction(self, &action)) {
+    action->Run();
+  }
+
+  MutexLocker locker(&state.mutex);
+  while (__atomic_load_n(&state.remaining, __ATOMIC_ACQUIRE) > 0) {
+    state.done.Wait(&state.mutex);
+  }
+}
+
+
+void WorkStealingPool::WorkerLoop(Worker *self) {
+  while (true) {
+    Action action;
+    if (TakeAction(self, &action)) {
+      action->Run();
+      continue;
+    }
+
+    MutexLocker locker(&m_idle_mutex);
+    __atomic_add_fetch(&m_idle, 1, __ATOMIC_SEQ_CST);
+    while (!m_shutdown && !HasPending()) {
+      m_work_available.Wait(&m_idle_mutex);
+    }
+    __atomic_sub_fetch(&m_idle, 1, __ATOMIC_SEQ_CST);
+    if (m_shutdown && !HasPending()) {
+      return;
+    }
+  }
+}
+
+
+/*
+ * Take the newest action from our own deque, or the oldest action from
+ * another worker.
+ * @param self the calling worker, or NULL if called from outside the pool.
+ */
+bool WorkStealingPool::TakeAction(Worker *self, Action *action) {
+  if (self) {
+    MutexLocker locker(&self->mutex);
+    if (!self->actions.empty()) {
+      *action = self->actions.back();
+      self->actions.pop_back();
+      __atomic_sub_fetch(&m_pending, 1, __ATOMIC_SEQ_CST);
+      return true;
+    }
+  }
+
+  // Start with the next worker along, so the thieves don't all hit the first
+  // deque.
+  const unsigned int worker_count = ThreadCount();
+  const unsigned int start = self ? self->index + 1 : 0;
+  for (unsigned int i = 0; i < worker_count; i++) {
+    Worker *victim = m_workers[(start + i) % worker_count];
+    if (victim == self) {
+      continue;
+    }
+    MutexLocker locker(&victim->mutex);
+    if (!victim->actions.empty()) {
+      *action = victim->actions.front();
+      victim->actions.pop_front();
+      __atomic_sub_fetch(&m_pending, 1, __ATOMIC_SEQ_CST);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * Return the worker for the calling thread, or NULL if this isn't a worker.
+ */
+WorkStealingPool::Worker *WorkStealingPool::CurrentWorker() const {
+  if (!m_started) {
+    return NULL;
+  }
+  ThreadId self = Thread::Self();
+  vector<Worker*>::const_iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    if (pthread_equal((*iter)->Id(), self)) {
+      return *iter;
+    }
+  }
+  return NULL;
+}
+
+
+void WorkStealingPool::RunRange(RangeState *state, unsigned int begin,
+                                unsigned int end) {
+  state->callback->Run(begin, end);
+  // The caller may return as soon as remaining reaches 0, so this must be the
+  // last time state is touched.
+  MutexLocker locker(&state->mutex);
+  if (__atomic_sub_fetch(&state->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+    state->done.Signal();
+  }
+}
+
+
+void WorkStealingPool::StopWorkers() {
+  if (!m_started) {
+    return;
+  }
+
+  {
+    MutexLocker locker(&m_idle_mutex);
+    m_shutdown = true;
+    m_work_available.Broadcast();
+  }
+
+  vector<Worker*>::iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    if ((*iter)->IsRunning()) {
+      (*iter)->Join();
+    }
+  }
+  m_started = false;
+}
+}  // namespace thread
+}  // namespace ola
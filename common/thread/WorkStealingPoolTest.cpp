@@ -0,0 +1,201 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * WorkStealingPoolTest.cpp
+ * Test fixture for the WorkStealingPool class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/thread/Future.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "ola/thread/WorkStealingPool.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::Future;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using ola::thread::WorkStealingPool;
+using std::vector;
+
+class WorkStealingPoolTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(WorkStealingPoolTest);
+  CPPUNIT_TEST(testExecute);
+  CPPUNIT_TEST(testNestedExecute);
+  CPPUNIT_TEST(testFuture);
+  CPPUNIT_TEST(testParallelFor);
+  CPPUNIT_TEST(testParallelForNotStarted);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testExecute();
+  void testNestedExecute();
+  void testFuture();
+  void testParallelFor();
+  void testParallelForNotStarted();
+
+  void setUp() {
+    m_counter = 0;
+  }
+
+ private:
+  unsigned int m_counter;
+  Mutex m_mutex;
+  vector<unsigned int> m_visits;
+
+  void IncrementCounter() {
+    MutexLocker locker(&m_mutex);
+    m_counter++;
+  }
+
+  void AddChildren(WorkStealingPool *pool, unsigned int children) {
+    for (unsigned int i = 0; i < children; i++) {
+      pool->Execute(ola::NewSingleCallback(
+          this, &WorkStealingPoolTest::IncrementCounter));
+    }
+    IncrementCounter();
+  }
+
+  void Visit(unsigned int begin, unsigned int end) {
+    MutexLocker locker(&m_mutex);
+    for (unsigned int i = begin; i < end; i++) {
+      m_visits[i]++;
+    }
+  }
+
+  void CheckVisits(unsigned int begin, unsigned int end);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(WorkStealingPoolTest);
+
+namespace {
+void SetFuture(Future<void> *future) {
+  future->Set();
+}
+}  // namespace
+
+
+/**
+ * Check callbacks added from outside the pool are all run.
+ */
+void WorkStealingPoolTest::testExecute() {
+  WorkStealingPool::Options options;
+  options.thread_count = 4;
+  WorkStealingPool pool(options);
+  OLA_ASSERT_TRUE(pool.Init());
+  OLA_ASSERT_FALSE(pool.Init());
+  OLA_ASSERT_EQ(4u, pool.ThreadCount());
+
+  for (unsigned int i = 0; i < 1000; i++) {
+    pool.Execute(
+        ola::NewSingleCallback(this, &WorkStealingPoolTest::IncrementCounter));
+  }
+  pool.JoinAll();
+  OLA_ASSERT_EQ(1000u, m_counter);
+}
+
+
+/**
+ * Check callbacks added from within the pool are run.
+ */
+void WorkStealingPoolTest::testNestedExecute() {
+  WorkStealingPool::Options options;
+  options.thread_count = 3;
+  WorkStealingPool pool(options);
+  OLA_ASSERT_TRUE(pool.Init());
+
+  for (unsigned int i = 0; i < 100; i++) {
+    pool.Execute(ola::NewSingleCallback(
+        this, &WorkStealingPoolTest::AddChildren, &pool, 10u));
+  }
+  pool.JoinAll();
+  OLA_ASSERT_EQ(1100u, m_counter);
+}
+
+
+/**
+ * Check the pool works as an ExecutorInterface.
+ */
+void WorkStealingPoolTest::testFuture() {
+  WorkStealingPool::Options options;
+  WorkStealingPool pool(options);
+  OLA_ASSERT_TRUE(pool.Init());
+
+  ola::thread::ExecutorInterface *executor = &pool;
+  Future<void> future;
+  executor->Execute(ola::NewSingleCallback(SetFuture, &future));
+  future.Get();
+  OLA_ASSERT_TRUE(future.IsComplete());
+}
+
+
+/**
+ * Check ParallelFor() visits each item exactly once.
+ */
+void WorkStealingPoolTest::testParallelFor() {
+  WorkStealingPool::Options options;
+  options.thread_count = 4;
+  WorkStealingPool pool(options);
+  OLA_ASSERT_TRUE(pool.Init());
+
+  m_visits.assign(1000, 0);
+  pool.ParallelFor(0, 1000, 16,
+                   ola::NewCallback(this, &WorkStealingPoolTest::Visit));
+  CheckVisits(0, 1000);
+
+  // A range that isn't a multiple of the grain, and a zero grain.
+  m_visits.assign(1000, 0);
+  pool.ParallelFor(5, 998, 7,
+                   ola::NewCallback(this, &WorkStealingPoolTest::Visit));
+  CheckVisits(5, 998);
+
+  m_visits.assign(1000, 0);
+  pool.ParallelFor(10, 20, 0,
+                   ola::NewCallback(this, &WorkStealingPoolTest::Visit));
+  CheckVisits(10, 20);
+
+  // An empty range
+  m_visits.assign(1000, 0);
+  pool.ParallelFor(20, 20, 4,
+                   ola::NewCallback(this, &WorkStealingPoolTest::Visit));
+  CheckVisits(0, 0);
+}
+
+
+/**
+ * Check ParallelFor() runs everything in the calling thread if the pool hasn't
+ * been started.
+ */
+void WorkStealingPoolTest::testParallelForNotStarted() {
+  WorkStealingPool::Options options;
+  WorkStealingPool pool(options);
+
+  m_visits.assign(100, 0);
+  pool.ParallelFor(0, 100, 8,
+                   ola::NewCallback(this, &WorkStealingPoolTest::Visit));
+  CheckVisits(0, 100);
+}
+
+
+void WorkStealingPoolTest::CheckVisits(unsigned int begin, unsigned int end) {
+  for (unsigned int i = 0; i < m_visits.size(); i++) {
+    OLA_ASSERT_EQ(i >= begin && i < end ? 1u : 0u, m_visits[i]);
+  }
+}
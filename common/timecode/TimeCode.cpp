@@ -33,6 +33,10 @@ using std::setw;
 using std::setfill;
 using std::string;
 
+const uint32_t TimeCode::DROPPED_FRAMES;
+const uint32_t TimeCode::DF_FRAMES_PER_MINUTE;
+const uint32_t TimeCode::DF_FRAMES_PER_TEN_MINUTES;
+
 
 TimeCode::TimeCode(const TimeCode &other)
     : m_type(other.m_type),
@@ -73,6 +77,58 @@ bool TimeCode::IsValid() const {
   return false;
 }
 
+uint32_t TimeCode::FrameCount() const {
+  const uint32_t minutes = m_hours * 60 + m_minutes;
+  uint32_t frame_count = (minutes * 60 + m_seconds) *
+                         NominalFrameRate(m_type) + m_frames;
+  if (m_type == TIMECODE_DF) {
+    frame_count -= DROPPED_FRAMES * (minutes - minutes / 10);
+  }
+  return frame_count;
+}
+
+TimeCode TimeCode::FromFrameCount(TimeCodeType type, uint32_t frame_count) {
+  frame_count %= FramesPerDay(type);
+  if (type == TIMECODE_DF) {
+    // Add back the frame numbers that were skipped.
+    const uint32_t tens = frame_count / DF_FRAMES_PER_TEN_MINUTES;
+    const uint32_t remainder = frame_count % DF_FRAMES_PER_TEN_MINUTES;
+    frame_count += 9 * DROPPED_FRAMES * tens;
+    if (remainder > DROPPED_FRAMES) {
+      frame_count += DROPPED_FRAMES *
+          ((remainder - DROPPED_FRAMES) / DF_FRAMES_PER_MINUTE);
+    }
+  }
+
+  const uint8_t rate = NominalFrameRate(type);
+  const uint8_t frames = frame_count % rate;
+  frame_count /= rate;
+  const uint8_t seconds = frame_count % 60;
+  frame_count /= 60;
+  const uint8_t minutes = frame_count % 60;
+  return TimeCode(type, frame_count / 60, minutes, seconds, frames);
+}
+
+uint8_t TimeCode::NominalFrameRate(TimeCodeType type) {
+  switch (type) {
+    case TIMECODE_FILM:
+      return 24;
+    case TIMECODE_EBU:
+      return 25;
+    case TIMECODE_DF:
+    case TIMECODE_SMPTE:
+      return 30;
+  }
+  return 30;
+}
+
+uint32_t TimeCode::FramesPerDay(TimeCodeType type) {
+  if (type == TIMECODE_DF) {
+    return DF_FRAMES_PER_TEN_MINUTES * 6 * 24;
+  }
+  return NominalFrameRate(type) * 60 * 60 * 24;
+}
+
 string TimeCode::AsString() const {
   std::ostringstream str;
   str << setw(2) << setfill('0') << static_cast<int>(m_hours) << ":"
@@ -39,11 +39,15 @@ class TimeCodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(TimeCodeTest);
   CPPUNIT_TEST(testTimeCode);
   CPPUNIT_TEST(testIsValid);
+  CPPUNIT_TEST(testFrameCount);
+  CPPUNIT_TEST(testDropFrame);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testTimeCode();
     void testIsValid();
+    void testFrameCount();
+    void testDropFrame();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TimeCodeTest);
@@ -97,3 +101,57 @@ void TimeCodeTest::testIsValid() {
   TimeCode t4(TIMECODE_SMPTE, 0, 0, 0, 30);
   OLA_ASSERT_FALSE(t4.IsValid());
 }
+
+/**
+ * Test converting to and from frame counts.
+ */
+void TimeCodeTest::testFrameCount() {
+  TimeCode t1(TIMECODE_FILM, 0, 0, 1, 2);
+  OLA_ASSERT_EQ(static_cast<uint32_t>(26), t1.FrameCount());
+  OLA_ASSERT_EQ(t1, TimeCode::FromFrameCount(TIMECODE_FILM, 26));
+
+  TimeCode t2(TIMECODE_EBU, 1, 2, 3, 4);
+  OLA_ASSERT_EQ(static_cast<uint32_t>(93079), t2.FrameCount());
+  OLA_ASSERT_EQ(t2, TimeCode::FromFrameCount(TIMECODE_EBU, 93079));
+
+  TimeCode t3(TIMECODE_SMPTE, 23, 59, 59, 29);
+  OLA_ASSERT_EQ(TimeCode::FramesPerDay(TIMECODE_SMPTE) - 1, t3.FrameCount());
+
+  // Frame counts wrap at 24 hours.
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_SMPTE, 0, 0, 0, 0),
+                TimeCode::FromFrameCount(
+                    TIMECODE_SMPTE, TimeCode::FramesPerDay(TIMECODE_SMPTE)));
+  OLA_ASSERT_EQ(static_cast<uint32_t>(2160000),
+                TimeCode::FramesPerDay(TIMECODE_EBU));
+}
+
+/**
+ * Test drop frame timecode skips the right frame numbers.
+ */
+void TimeCodeTest::testDropFrame() {
+  OLA_ASSERT_EQ(static_cast<uint32_t>(2589408),
+                TimeCode::FramesPerDay(TIMECODE_DF));
+
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 0, 59, 29),
+                TimeCode::FromFrameCount(TIMECODE_DF, 1799));
+  // 00:01:00:00 and 00:01:00:01 are skipped.
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 1, 0, 2),
+                TimeCode::FromFrameCount(TIMECODE_DF, 1800));
+  OLA_ASSERT_EQ(static_cast<uint32_t>(1800),
+                TimeCode(TIMECODE_DF, 0, 1, 0, 2).FrameCount());
+
+  // But not at every tenth minute.
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 9, 59, 29),
+                TimeCode::FromFrameCount(TIMECODE_DF, 17981));
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 10, 0, 0),
+                TimeCode::FromFrameCount(TIMECODE_DF, 17982));
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 11, 0, 2),
+                TimeCode::FromFrameCount(TIMECODE_DF, 17982 + 1800));
+
+  // Every frame count maps back to itself.
+  for (uint32_t i = 0; i < TimeCode::FramesPerDay(TIMECODE_DF); i += 7) {
+    TimeCode timecode = TimeCode::FromFrameCount(TIMECODE_DF, i);
+    OLA_ASSERT_TRUE(timecode.IsValid());
+    OLA_ASSERT_EQ(i, timecode.FrameCount());
+  }
+}
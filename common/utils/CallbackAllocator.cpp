@@ -0,0 +1,250 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocator.cpp
+ * Recycles the memory used by callbacks.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * Each thread keeps a short free list of blocks for each size class, which
+ * doesn't need any synchronization. When a thread's list is full or empty it
+ * falls back to a shared bounded multi-producer, multi-consumer queue for that
+ * size class, the same design as the DmxFramePool, and then to the heap.
+ *
+ * The shared queues let blocks move between threads, since callbacks are
+ * often created in one thread and run in another.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <new>
+
+#include "ola/CallbackAllocator.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+namespace {
+
+// Sizes are rounded up to a multiple of this.
+const size_t SIZE_CLASS_STEP = 16;
+const size_t SIZE_CLASSES = CallbackAllocator::MAX_POOLED_SIZE /
+                            SIZE_CLASS_STEP;
+// The number of free blocks to keep for each size class, in each thread and
+// in the shared lists.
+const unsigned int THREAD_CACHE_SIZE = 64;
+const size_t FREE_LIST_SIZE = 256;
+
+unsigned int heap_allocations = 0;
+
+/*
+ * A bounded, lock free queue of free blocks.
+ */
+class FreeList {
+ public:
+  FreeList()
+      : m_enqueue_pos(0),
+        m_dequeue_pos(0) {
+    for (size_t i = 0; i < FREE_LIST_SIZE; i++) {
+      m_cells[i].sequence = i;
+      m_cells[i].block = NULL;
+    }
+  }
+
+  bool Push(void *block);
+  void *Pop();
+
+ private:
+  typedef struct {
+    size_t sequence;
+    void *block;
+  } Cell;
+
+  static const size_t MASK = FREE_LIST_SIZE - 1;
+
+  Cell m_cells[FREE_LIST_SIZE];
+  size_t m_enqueue_pos;
+  size_t m_dequeue_pos;
+
+  DISALLOW_COPY_AND_ASSIGN(FreeList);
+};
+
+
+bool FreeList::Push(void *block) {
+  Cell *cell;
+  size_t pos = __atomic_load_n(&m_enqueue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    cell = &m_cells[pos & MASK];
+    size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) -
+                     static_cast<ptrdiff_t>(pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&m_enqueue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = __atomic_load_n(&m_enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  cell->block = block;
+  __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+
+void *FreeList::Pop() {
+  Cell *cell;
+  size_t pos = __atomic_load_n(&m_dequeue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    cell = &m_cells[pos & MASK];
+    size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) -
+                     static_cast<ptrdiff_t>(pos + 1);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&m_dequeue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return NULL;  // empty
+    } else {
+      pos = __atomic_load_n(&m_dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  void *block = cell->block;
+  __atomic_store_n(&cell->sequence, pos + MASK + 1, __ATOMIC_RELEASE);
+  return block;
+}
+
+
+/*
+ * The free lists are never deleted, so callbacks can be freed during static
+ * destruction.
+ */
+FreeList *FreeLists() {
+  static FreeList *free_lists = new FreeList[SIZE_CLASSES];
+  return free_lists;
+}
+
+size_t SizeClass(size_t size) {
+  return (size + SIZE_CLASS_STEP - 1) / SIZE_CLASS_STEP - 1;
+}
+
+
+/*
+ * The free blocks for a single thread. Each free block holds a pointer to the
+ * next one.
+ */
+struct ThreadCache {
+  void *heads[SIZE_CLASSES];
+  unsigned int counts[SIZE_CLASSES];
+  bool registered;
+};
+
+__thread ThreadCache thread_cache;
+
+pthread_key_t cache_key;
+pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Called when a thread exits, this hands the blocks to the shared lists.
+ */
+void FlushCache(void *data) {
+  ThreadCache *cache = static_cast<ThreadCache*>(data);
+  for (size_t i = 0; i < SIZE_CLASSES; i++) {
+    while (cache->heads[i]) {
+      void *block = cache->heads[i];
+      cache->heads[i] = *static_cast<void**>(block);
+      if (!FreeLists()[i].Push(block)) {
+        ::operator delete(block);
+      }
+    }
+    cache->counts[i] = 0;
+  }
+  // If more callbacks are freed as the thread exits, register again so this
+  // is called for another round.
+  cache->registered = false;
+}
+
+void CreateCacheKey() {
+  pthread_key_create(&cache_key, FlushCache);
+}
+
+ThreadCache *GetThreadCache() {
+  ThreadCache *cache = &thread_cache;
+  if (!cache->registered) {
+    pthread_once(&cache_key_once, CreateCacheKey);
+    pthread_setspecific(cache_key, cache);
+    cache->registered = true;
+  }
+  return cache;
+}
+}  // namespace
+
+
+void *CallbackAllocator::Allocate(size_t size) {
+  if (size == 0 || size > MAX_POOLED_SIZE) {
+    return ::operator new(size);
+  }
+
+  size_t size_class = SizeClass(size);
+  ThreadCache *cache = GetThreadCache();
+  void *block = cache->heads[size_class];
+  if (block) {
+    cache->heads[size_class] = *static_cast<void**>(block);
+    cache->counts[size_class]--;
+    return block;
+  }
+
+  block = FreeLists()[size_class].Pop();
+  if (!block) {
+    block = ::operator new((size_class + 1) * SIZE_CLASS_STEP);
+    __atomic_add_fetch(&heap_allocations, 1, __ATOMIC_RELAXED);
+  }
+  return block;
+}
+
+
+void CallbackAllocator::Free(void *ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+
+  if (size == 0 || size > MAX_POOLED_SIZE) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  size_t size_class = SizeClass(size);
+  ThreadCache *cache = GetThreadCache();
+  if (cache->counts[size_class] < THREAD_CACHE_SIZE) {
+    *static_cast<void**>(ptr) = cache->heads[size_class];
+    cache->heads[size_class] = ptr;
+    cache->counts[size_class]++;
+    return;
+  }
+
+  if (!FreeLists()[size_class].Push(ptr)) {
+    ::operator delete(ptr);
+  }
+}
+
+
+unsigned int CallbackAllocator::HeapAllocations() {
+  return __atomic_load_n(&heap_allocations, __ATOMIC_RELAXED);
+}
+}  // namespace ola
@@ -22,6 +22,9 @@
 #include <string>
 
 #include "ola/Callback.h"
+#include "ola/CallbackAllocator.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
 #include "ola/testing/TestUtils.h"
 
 
@@ -34,6 +37,8 @@ class CallbackTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testFunctionCallbacks1);
   CPPUNIT_TEST(testMethodCallbacks1);
   CPPUNIT_TEST(testMethodCallbacks2);
+  CPPUNIT_TEST(testAllocator);
+  CPPUNIT_TEST(testAllocatorBenchmark);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -43,6 +48,8 @@ class CallbackTest: public CppUnit::TestFixture {
     void testMethodCallbacks1();
     void testMethodCallbacks2();
     void testMethodCallbacks4();
+    void testAllocator();
+    void testAllocatorBenchmark();
 
     void Method0() {}
     bool BoolMethod0() { return true; }
@@ -108,10 +115,12 @@ const char CallbackTest::TEST_CHAR_VALUE = 'c';
 const char CallbackTest::TEST_STRING_VALUE[] = "foo";
 CPPUNIT_TEST_SUITE_REGISTRATION(CallbackTest);
 
+using ola::BaseCallback0;
 using ola::BaseCallback1;
 using ola::BaseCallback2;
 using ola::BaseCallback4;
 using ola::Callback0;
+using ola::CallbackAllocator;
 using ola::NewCallback;
 using ola::NewCallback;
 using ola::NewSingleCallback;
@@ -551,3 +560,52 @@ void CallbackTest::testMethodCallbacks4() {
                          TEST_STRING_VALUE));
   delete c4;
 }
+
+
+/*
+ * Check the memory for callbacks is reused.
+ */
+void CallbackTest::testAllocator() {
+  BaseCallback0<void> *c1 = NewSingleCallback(this, &CallbackTest::Method0);
+  void *first = c1;
+  c1->Run();
+
+  unsigned int heap_allocations = CallbackAllocator::HeapAllocations();
+  BaseCallback0<void> *c2 = NewSingleCallback(this, &CallbackTest::Method0);
+  OLA_ASSERT_EQ(first, static_cast<void*>(c2));
+  OLA_ASSERT_EQ(heap_allocations, CallbackAllocator::HeapAllocations());
+  c2->Run();
+
+  // Allocations that are too large for the pool come from the heap.
+  void *block = CallbackAllocator::Allocate(
+      CallbackAllocator::MAX_POOLED_SIZE + 1);
+  OLA_ASSERT_NOT_NULL(block);
+  CallbackAllocator::Free(block, CallbackAllocator::MAX_POOLED_SIZE + 1);
+  CallbackAllocator::Free(NULL, 0);
+}
+
+
+/*
+ * Create and run many single use callbacks, and check that once the pool is
+ * warm they don't touch the heap.
+ */
+void CallbackTest::testAllocatorBenchmark() {
+  const unsigned int ITERATIONS = 1000000;
+  // Warm up the pool.
+  NewSingleCallback(this, &CallbackTest::Method1, TEST_INT_VALUE)->Run();
+
+  unsigned int heap_allocations = CallbackAllocator::HeapAllocations();
+  ola::Clock clock;
+  ola::TimeStamp start, end;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    NewSingleCallback(this, &CallbackTest::Method1, TEST_INT_VALUE)->Run();
+  }
+  clock.CurrentMonotonicTime(&end);
+  OLA_ASSERT_EQ(heap_allocations, CallbackAllocator::HeapAllocations());
+
+  OLA_INFO << "Created and ran " << ITERATIONS << " single use callbacks in "
+           << (end - start) << ", "
+           << (end - start).AsInt() * 1000.0 / ITERATIONS
+           << " ns per callback";
+}
@@ -277,6 +277,16 @@ void Clock::CurrentMonotonicTime(TimeStamp *timestamp) const {
 #endif
 }
 
+void Clock::CurrentCoarseMonotonicTime(TimeStamp *timestamp) const {
+#ifdef CLOCK_MONOTONIC_COARSE
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  *timestamp = ts;
+#else
+  CurrentMonotonicTime(timestamp);
+#endif
+}
+
 void Clock::CurrentRealTime(TimeStamp *timestamp) const {
   struct timeval tv;
   gettimeofday(&tv, NULL);
@@ -308,6 +318,10 @@ void MockClock::CurrentMonotonicTime(TimeStamp* timestamp) const {
 #endif
 }
 
+void MockClock::CurrentCoarseMonotonicTime(TimeStamp* timestamp) const {
+  CurrentMonotonicTime(timestamp);
+}
+
 void MockClock::CurrentRealTime(TimeStamp* timestamp) const {
   struct timeval tv;
   gettimeofday(&tv, NULL);
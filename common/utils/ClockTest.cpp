@@ -37,6 +37,7 @@ class ClockTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTimeInterval);
   CPPUNIT_TEST(testTimeIntervalMultiplication);
   CPPUNIT_TEST(testClockMonotonic);
+  CPPUNIT_TEST(testClockCoarseMonotonic);
   CPPUNIT_TEST(testClockRealTime);
   CPPUNIT_TEST(testClockCurrentTime);
   CPPUNIT_TEST(testMockClockMonotonic);
@@ -49,6 +50,7 @@ class ClockTest: public CppUnit::TestFixture {
     void testTimeInterval();
     void testTimeIntervalMultiplication();
     void testClockMonotonic();
+    void testClockCoarseMonotonic();
     void testClockRealTime();
     void testClockCurrentTime();
     void testMockClockMonotonic();
@@ -200,6 +202,28 @@ void ClockTest::testClockMonotonic() {
   OLA_ASSERT_LT(first, second);
 }
 
+/**
+ * @brief Test the coarse monotonic clock
+ */
+void ClockTest::testClockCoarseMonotonic() {
+  Clock clock;
+  TimeStamp first;
+  clock.CurrentCoarseMonotonicTime(&first);
+#ifdef _WIN32
+  Sleep(1000);
+#else
+  sleep(1);
+#endif  // _WIN32
+
+  TimeStamp second, precise;
+  clock.CurrentCoarseMonotonicTime(&second);
+  clock.CurrentMonotonicTime(&precise);
+  OLA_ASSERT_LT(first, second);
+  // The coarse clock may lag behind, but shouldn't be ahead.
+  OLA_ASSERT_TRUE(second <= precise);
+  OLA_ASSERT_LT(precise - second, TimeInterval(0, 100000));
+}
+
 /**
  * @brief Test the real time clock
  */
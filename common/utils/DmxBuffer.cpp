@@ -27,22 +27,23 @@
  * @file DmxBuffer.cpp
  */
 
+#include <ctype.h>
 #include <string.h>
 #include <algorithm>
 #include <iostream>
 #include <string>
-#include <vector>
+#include "common/dmx/SlotKernels.h"
+#include "common/utils/DmxFramePool.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
-#include "ola/StringUtils.h"
+#include "ola/strings/Format.h"
 
 namespace ola {
 
 using std::min;
 using std::max;
 using std::string;
-using std::vector;
 
 DmxBuffer::DmxBuffer()
     : m_ref_count(NULL),
@@ -101,7 +102,7 @@ DmxBuffer& DmxBuffer::operator=(const DmxBuffer &other) {
 bool DmxBuffer::operator==(const DmxBuffer &other) const {
   return (m_length == other.m_length &&
           (m_data == other.m_data ||
-           0 == memcmp(m_data, other.m_data, m_length)));
+           ola::dmx::SlotsEqual(m_data, other.m_data, m_length)));
 }
 
 
@@ -121,9 +122,7 @@ bool DmxBuffer::HTPMerge(const DmxBuffer &other) {
                                   other.m_length);
   unsigned int merge_length = min(m_length, other.m_length);
 
-  for (unsigned int i = 0; i < merge_length; i++) {
-    m_data[i] = max(m_data[i], other.m_data[i]);
-  }
+  ola::dmx::SlotMax(m_data, other.m_data, merge_length);
 
   if (other_length > m_length) {
     memcpy(m_data + merge_length, other.m_data + merge_length,
@@ -161,24 +160,46 @@ bool DmxBuffer::Set(const DmxBuffer &other) {
 
 
 bool DmxBuffer::SetFromString(const string &input) {
-  unsigned int i = 0;
-  vector<string> dmx_values;
-  vector<string>::const_iterator iter;
+  return SetFromString(input.data(), input.size());
+}
 
+
+bool DmxBuffer::SetFromString(const char *input, unsigned int length) {
   if (m_copy_on_write)
     CleanupMemory();
   if (!m_data)
     if (!Init())
       return false;
 
-  if (input.empty()) {
+  if (!length) {
     m_length = 0;
     return true;
   }
-  StringSplit(input, &dmx_values, ",");
-  for (iter = dmx_values.begin();
-      iter != dmx_values.end() && i < DMX_UNIVERSE_SIZE; ++iter, ++i) {
-    m_data[i] = atoi(iter->data());
+
+  const char *ptr = input;
+  const char *end = input + length;
+  unsigned int i = 0;
+  while (i < DMX_UNIVERSE_SIZE) {
+    // Each value is parsed the way atoi() would, and truncated to 8 bits.
+    while (ptr != end && isspace(static_cast<unsigned char>(*ptr))) {
+      ptr++;
+    }
+    bool negative = false;
+    if (ptr != end && (*ptr == '-' || *ptr == '+')) {
+      negative = *ptr++ == '-';
+    }
+    uint8_t value = 0;
+    for (; ptr != end && *ptr >= '0' && *ptr <= '9'; ptr++) {
+      value = static_cast<uint8_t>(value * 10 + (*ptr - '0'));
+    }
+    m_data[i++] = negative ? static_cast<uint8_t>(-value) : value;
+
+    const char *comma = static_cast<const char*>(
+        memchr(ptr, ',', end - ptr));
+    if (!comma) {
+      break;
+    }
+    ptr = comma + 1;
   }
   m_length = i;
   return true;
@@ -314,29 +335,38 @@ void DmxBuffer::Reset() {
 
 
 string DmxBuffer::ToString() const {
-  if (!m_data) {
-    return "";
+  string output;
+  ToString(&output);
+  return output;
+}
+
+
+void DmxBuffer::ToString(string *output) const {
+  output->clear();
+  if (!m_data || !m_length) {
+    return;
   }
 
-  // TODO(Peter): Change to the uint8_t version of StringJoin
-  std::ostringstream str;
-  for (unsigned int i = 0; i < Size(); i++) {
-    if (i) {
-      str << ",";
-    }
-    str << static_cast<int>(m_data[i]);
+  // Each slot is at most 3 digits and a comma.
+  char buffer[DMX_UNIVERSE_SIZE * 4];
+  char *ptr = buffer;
+  for (unsigned int i = 0; i < m_length; i++) {
+    ptr = ola::strings::FormatUInt(m_data[i], ptr);
+    *ptr++ = ',';
   }
-  return str.str();
+  output->assign(buffer, ptr - buffer - 1);
 }
 
 
 /*
- * Allocate memory
+ * Allocate memory, this takes a frame from the pool so it doesn't normally
+ * touch the heap.
  * @return true on success, otherwise raises an exception
  */
 bool DmxBuffer::Init() {
-  m_data = new uint8_t[DMX_UNIVERSE_SIZE];
-  m_ref_count = new unsigned int;
+  DmxFrame *frame = DmxFramePool::Instance()->Allocate();
+  m_data = frame->data;
+  m_ref_count = &frame->ref_count;
   m_length = 0;
   *m_ref_count = 1;
   return true;
@@ -390,8 +420,7 @@ void DmxBuffer::CleanupMemory() {
   if (m_ref_count && m_data) {
     (*m_ref_count)--;
     if (!*m_ref_count) {
-      delete[] m_data;
-      delete m_ref_count;
+      DmxFramePool::Instance()->Release(DmxFrame::FromRefCount(m_ref_count));
     }
     m_data = NULL;
     m_ref_count = NULL;
@@ -337,6 +337,27 @@ void DmxBufferTest::testStringToDmx() {
   input = "";
   uint8_t expected7[] = {};
   runStringToDmx(input, DmxBuffer(expected7, sizeof(expected7)));
+
+  input = "-1,+2,3x,4";
+  uint8_t expected8[] = {255, 2, 3, 4};
+  runStringToDmx(input, DmxBuffer(expected8, sizeof(expected8)));
+
+  // The data doesn't need to be NULL terminated
+  DmxBuffer buffer;
+  const char data[] = {'1', ',', '2', '0', ',', '3', '9'};
+  OLA_ASSERT_TRUE(buffer.SetFromString(data, sizeof(data) - 1));
+  uint8_t expected9[] = {1, 20, 3};
+  OLA_ASSERT_DMX_EQUALS(DmxBuffer(expected9, sizeof(expected9)), buffer);
+
+  // Values past the end of the universe are ignored
+  input = "";
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE + 2; i++) {
+    input.append("7,");
+  }
+  OLA_ASSERT_TRUE(buffer.SetFromString(input));
+  OLA_ASSERT_EQ(ola::DMX_UNIVERSE_SIZE, buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(7),
+                buffer.Get(ola::DMX_UNIVERSE_SIZE - 1));
 }
 
 
@@ -530,4 +551,14 @@ void DmxBufferTest::testToString() {
   ostringstream str;
   str << buffer;
   OLA_ASSERT_EQ(string("1,2,3,4"), str.str());
+
+  // Existing contents are replaced
+  string output("foo");
+  buffer.SetFromString("0,10,100");
+  buffer.ToString(&output);
+  OLA_ASSERT_EQ(string("0,10,100"), output);
+
+  buffer.Reset();
+  buffer.ToString(&output);
+  OLA_ASSERT_EQ(string(""), output);
 }
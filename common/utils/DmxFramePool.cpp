@@ -0,0 +1,133 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFramePool.cpp
+ * A lock free pool of fixed size DMX frames.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * The free list is a bounded multi-producer, multi-consumer queue, based on
+ * the design by Dmitry Vyukov. Each cell carries a sequence number, which
+ * avoids the ABA problem a linked free list would have.
+ */
+
+#include "common/utils/DmxFramePool.h"
+
+namespace ola {
+
+DmxFramePool::DmxFramePool(unsigned int capacity)
+    : m_cells(NULL),
+      m_mask(0),
+      m_enqueue_pos(0),
+      m_dequeue_pos(0),
+      m_heap_allocations(0) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  m_mask = size - 1;
+  m_cells = new Cell[size];
+  for (size_t i = 0; i < size; i++) {
+    m_cells[i].sequence = i;
+    m_cells[i].frame = NULL;
+  }
+}
+
+
+DmxFramePool::~DmxFramePool() {
+  DmxFrame *frame;
+  while ((frame = Pop())) {
+    delete frame;
+  }
+  delete[] m_cells;
+}
+
+
+DmxFrame *DmxFramePool::Allocate() {
+  DmxFrame *frame = Pop();
+  if (!frame) {
+    frame = new DmxFrame;
+    __atomic_add_fetch(&m_heap_allocations, 1, __ATOMIC_RELAXED);
+  }
+  return frame;
+}
+
+
+void DmxFramePool::Release(DmxFrame *frame) {
+  if (!Push(frame)) {
+    delete frame;
+  }
+}
+
+
+unsigned int DmxFramePool::HeapAllocations() const {
+  return __atomic_load_n(&m_heap_allocations, __ATOMIC_RELAXED);
+}
+
+
+DmxFramePool *DmxFramePool::Instance() {
+  static DmxFramePool *pool = new DmxFramePool();
+  return pool;
+}
+
+
+bool DmxFramePool::Push(DmxFrame *frame) {
+  Cell *cell;
+  size_t pos = __atomic_load_n(&m_enqueue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    cell = &m_cells[pos & m_mask];
+    size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) -
+                     static_cast<ptrdiff_t>(pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&m_enqueue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = __atomic_load_n(&m_enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  cell->frame = frame;
+  __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+
+DmxFrame *DmxFramePool::Pop() {
+  Cell *cell;
+  size_t pos = __atomic_load_n(&m_dequeue_pos, __ATOMIC_RELAXED);
+  while (true) {
+    cell = &m_cells[pos & m_mask];
+    size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) -
+                     static_cast<ptrdiff_t>(pos + 1);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&m_dequeue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return NULL;  // empty
+    } else {
+      pos = __atomic_load_n(&m_dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  DmxFrame *frame = cell->frame;
+  __atomic_store_n(&cell->sequence, pos + m_mask + 1, __ATOMIC_RELEASE);
+  return frame;
+}
+}  // namespace ola
@@ -0,0 +1,116 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFramePool.h
+ * A lock free pool of fixed size DMX frames.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef COMMON_UTILS_DMXFRAMEPOOL_H_
+#define COMMON_UTILS_DMXFRAMEPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ola/Constants.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief The storage behind a DmxBuffer.
+ *
+ * The reference count is shared between all the DmxBuffers that point to this
+ * frame.
+ */
+struct DmxFrame {
+  unsigned int ref_count;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+
+  /**
+   * @brief Get the frame from a pointer to its ref_count member.
+   */
+  static DmxFrame *FromRefCount(unsigned int *ref_count) {
+    return reinterpret_cast<DmxFrame*>(
+        reinterpret_cast<uint8_t*>(ref_count) - offsetof(DmxFrame, ref_count));
+  }
+};
+
+
+/**
+ * @brief A pool of DmxFrames.
+ *
+ * Frames that are released are kept on a bounded, lock free queue so they can
+ * be handed out again without going through the heap. Frames can be released
+ * from a different thread to the one that allocated them.
+ *
+ * If the pool is empty a new frame is allocated, if it's full the released
+ * frame is deleted.
+ */
+class DmxFramePool {
+ public:
+  /**
+   * @brief Create a new pool.
+   * @param capacity the maximum number of free frames to keep. This is
+   *   rounded up to a power of two.
+   */
+  explicit DmxFramePool(unsigned int capacity = DEFAULT_CAPACITY);
+  ~DmxFramePool();
+
+  /**
+   * @brief Get a frame from the pool.
+   * @returns a new frame, the contents are undefined.
+   */
+  DmxFrame *Allocate();
+
+  /**
+   * @brief Return a frame to the pool.
+   * @param frame the frame to return.
+   */
+  void Release(DmxFrame *frame);
+
+  /**
+   * @brief The number of frames that had to be allocated from the heap.
+   */
+  unsigned int HeapAllocations() const;
+
+  /**
+   * @brief The pool used by DmxBuffer.
+   *
+   * This is never deleted, so DmxBuffers with static storage duration are
+   * safe to use.
+   */
+  static DmxFramePool *Instance();
+
+  static const unsigned int DEFAULT_CAPACITY = 256;
+
+ private:
+  typedef struct {
+    size_t sequence;
+    DmxFrame *frame;
+  } Cell;
+
+  Cell *m_cells;
+  size_t m_mask;
+  size_t m_enqueue_pos;
+  size_t m_dequeue_pos;
+  unsigned int m_heap_allocations;
+
+  bool Push(DmxFrame *frame);
+  DmxFrame *Pop();
+
+  DISALLOW_COPY_AND_ASSIGN(DmxFramePool);
+};
+}  // namespace ola
+#endif  // COMMON_UTILS_DMXFRAMEPOOL_H_
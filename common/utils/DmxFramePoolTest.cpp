@@ -0,0 +1,132 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFramePoolTest.cpp
+ * Test fixture for the DmxFramePool class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <set>
+#include <vector>
+
+#include "common/utils/DmxFramePool.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::DmxFrame;
+using ola::DmxFramePool;
+using std::set;
+using std::vector;
+
+class DmxFramePoolTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DmxFramePoolTest);
+  CPPUNIT_TEST(testAllocateRelease);
+  CPPUNIT_TEST(testOverflow);
+  CPPUNIT_TEST(testDmxBufferReuse);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testAllocateRelease();
+    void testOverflow();
+    void testDmxBufferReuse();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DmxFramePoolTest);
+
+
+/*
+ * Check that released frames are handed out again.
+ */
+void DmxFramePoolTest::testAllocateRelease() {
+  DmxFramePool pool(4);
+  OLA_ASSERT_EQ(0u, pool.HeapAllocations());
+
+  DmxFrame *frame1 = pool.Allocate();
+  DmxFrame *frame2 = pool.Allocate();
+  OLA_ASSERT_NOT_NULL(frame1);
+  OLA_ASSERT_NOT_NULL(frame2);
+  OLA_ASSERT_NE(frame1, frame2);
+  OLA_ASSERT_EQ(2u, pool.HeapAllocations());
+  OLA_ASSERT_EQ(frame1, DmxFrame::FromRefCount(&frame1->ref_count));
+
+  pool.Release(frame1);
+  pool.Release(frame2);
+
+  // both frames should come from the pool
+  DmxFrame *frame3 = pool.Allocate();
+  DmxFrame *frame4 = pool.Allocate();
+  OLA_ASSERT_EQ(2u, pool.HeapAllocations());
+  OLA_ASSERT_EQ(frame1, frame3);
+  OLA_ASSERT_EQ(frame2, frame4);
+
+  pool.Release(frame3);
+  pool.Release(frame4);
+}
+
+
+/*
+ * Check that frames are freed once the pool is full.
+ */
+void DmxFramePoolTest::testOverflow() {
+  DmxFramePool pool(4);
+  vector<DmxFrame*> frames;
+  for (unsigned int i = 0; i < 10; i++) {
+    frames.push_back(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(10u, pool.HeapAllocations());
+
+  // only the first 4 are kept
+  vector<DmxFrame*>::iterator iter = frames.begin();
+  for (; iter != frames.end(); ++iter) {
+    pool.Release(*iter);
+  }
+
+  set<DmxFrame*> reused;
+  for (unsigned int i = 0; i < 4; i++) {
+    reused.insert(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(10u, pool.HeapAllocations());
+  OLA_ASSERT_EQ(static_cast<size_t>(4), reused.size());
+
+  pool.Allocate();
+  OLA_ASSERT_EQ(11u, pool.HeapAllocations());
+}
+
+
+/*
+ * Check that DmxBuffers recycle their memory through the shared pool.
+ */
+void DmxFramePoolTest::testDmxBufferReuse() {
+  DmxFramePool *pool = DmxFramePool::Instance();
+  {
+    // Make sure there is at least one free frame
+    DmxBuffer buffer;
+    buffer.Blackout();
+  }
+
+  const unsigned int allocations = pool->HeapAllocations();
+  for (unsigned int i = 0; i < 100; i++) {
+    DmxBuffer buffer;
+    buffer.SetChannel(0, i);
+    DmxBuffer copy(buffer);
+    copy.SetChannel(1, i);
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i), copy.Get(0));
+  }
+  // One extra frame is needed for the copy.
+  OLA_ASSERT_LTE(pool->HeapAllocations(), allocations + 1);
+}
@@ -2,12 +2,24 @@
 ################################################
 common_libolacommon_la_SOURCES += \
     common/utils/ActionQueue.cpp \
+    common/utils/CallbackAllocator.cpp \
     common/utils/Clock.cpp \
     common/utils/DmxBuffer.cpp \
+    common/utils/DmxFramePool.cpp \
+    common/utils/DmxFramePool.h \
+    common/utils/StallWatchdog.cpp \
     common/utils/StringUtils.cpp \
     common/utils/TokenBucket.cpp \
     common/utils/Watchdog.cpp
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/utils/dmx_text_benchmark
+
+common_utils_dmx_text_benchmark_SOURCES = \
+    common/utils/dmx_text_benchmark.cpp
+common_utils_dmx_text_benchmark_LDADD = common/libolacommon.la
+
 # TESTS
 ################################################
 test_programs += common/utils/UtilsTester
@@ -18,7 +30,9 @@ common_utils_UtilsTester_SOURCES = \
     common/utils/CallbackTest.cpp \
     common/utils/ClockTest.cpp \
     common/utils/DmxBufferTest.cpp \
+    common/utils/DmxFramePoolTest.cpp \
     common/utils/MultiCallbackTest.cpp \
+    common/utils/StallWatchdogTest.cpp \
     common/utils/StringUtilsTest.cpp \
     common/utils/TokenBucketTest.cpp \
     common/utils/UtilsTest.cpp \
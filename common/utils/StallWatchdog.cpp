@@ -0,0 +1,361 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StallWatchdog.cpp
+ * Detects threads that stall & records what they were doing.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif  // HAVE_EXECINFO_H
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/util/StallWatchdog.h"
+
+namespace ola {
+
+using ola::thread::MutexLocker;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The registered heartbeats, and the number of StallWatchdogs.
+ola::thread::Mutex registry_mutex;
+vector<Heartbeat*> heartbeats;  // GUARDED_BY(registry_mutex)
+unsigned int watchdog_count = 0;  // GUARDED_BY(registry_mutex)
+
+int64_t ToMicroSeconds(const TimeStamp &timestamp) {
+  return static_cast<int64_t>(timestamp.Seconds()) * 1000000 +
+         timestamp.MicroSeconds();
+}
+
+#ifdef HAVE_EXECINFO_H
+// The backtrace of the stalled thread. The watchdog only captures one at a
+// time, while holding the registry mutex.
+const int MAX_FRAMES = 64;
+void *captured_frames[MAX_FRAMES];
+int captured_size = 0;
+int capture_done = 0;
+
+/*
+ * Runs on the stalled thread. backtrace() is safe here once it's been called
+ * before, which CaptureBacktrace() makes sure of.
+ */
+void CaptureHandler(int signo) {
+  (void) signo;
+  captured_size = backtrace(captured_frames, MAX_FRAMES);
+  __atomic_store_n(&capture_done, 1, __ATOMIC_RELEASE);
+}
+
+bool InstallCaptureHandler() {
+  // The first call to backtrace() may allocate memory while loading the
+  // unwinder, so get that out of the way.
+  void *frames[1];
+  backtrace(frames, 1);
+
+  struct sigaction action;
+  action.sa_handler = CaptureHandler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  if (sigaction(SIGUSR2, &action, NULL) < 0) {
+    OLA_WARN << "Failed to install the SIGUSR2 handler";
+    return false;
+  }
+  return true;
+}
+#endif  // HAVE_EXECINFO_H
+}  // namespace
+
+
+Heartbeat::Heartbeat(const string &name, Clock *clock)
+    : m_name(name),
+      m_clock(clock ? clock : &m_system_clock),
+      m_depth(0),
+      m_has_thread(false),
+      m_started_us(0),
+      m_stalled_at(0),
+      m_stall_ended(false),
+      m_stall_us(0) {
+  MutexLocker lock(&registry_mutex);
+  heartbeats.push_back(this);
+}
+
+Heartbeat::~Heartbeat() {
+  MutexLocker lock(&registry_mutex);
+  vector<Heartbeat*>::iterator iter = std::find(heartbeats.begin(),
+                                                heartbeats.end(), this);
+  if (iter != heartbeats.end()) {
+    heartbeats.erase(iter);
+  }
+}
+
+void Heartbeat::Begin() {
+  if (m_depth) {
+    m_depth++;
+    return;
+  }
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  Begin(now);
+}
+
+void Heartbeat::Begin(const TimeStamp &now) {
+  if (m_depth++) {
+    return;
+  }
+  if (!m_has_thread) {
+    m_thread = pthread_self();
+    m_has_thread = true;
+  }
+  __atomic_store_n(&m_started_us, std::max(ToMicroSeconds(now),
+                                           static_cast<int64_t>(1)),
+                   __ATOMIC_RELEASE);
+}
+
+void Heartbeat::End(const string &activity) {
+  if (!m_depth || --m_depth) {
+    return;
+  }
+  int64_t started = __atomic_load_n(&m_started_us, __ATOMIC_RELAXED);
+  __atomic_store_n(&m_started_us, 0, __ATOMIC_RELEASE);
+
+  // Only claim the stall if it was for this section.
+  int64_t expected = started;
+  if (__atomic_load_n(&m_stalled_at, __ATOMIC_ACQUIRE) == started &&
+      __atomic_compare_exchange_n(&m_stalled_at, &expected, 0, false,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    StallEnded(started, activity);
+  }
+}
+
+void Heartbeat::StallEnded(int64_t started_us, const string &activity) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  MutexLocker lock(&registry_mutex);
+  m_stall_ended = true;
+  m_stall_us = ToMicroSeconds(now) - started_us;
+  m_stall_activity = activity;
+}
+
+
+const char StallWatchdog::K_STALL_COUNT_VAR[] = "stall-count";
+const char StallWatchdog::K_STALL_MAX_VAR[] = "stall-max-ms";
+const char StallWatchdog::K_STALL_LAST_VAR[] = "stall-last";
+const int64_t StallWatchdog::MIN_CHECK_INTERVAL_US;
+
+StallWatchdog::StallWatchdog(const Options &options,
+                             ExportMap *export_map,
+                             Clock *clock)
+    : Thread(Thread::Options("stall-watchdog")),
+      m_threshold_us(options.threshold.AsInt()),
+      m_check_interval(std::max(options.threshold.AsInt() / 4,
+                                MIN_CHECK_INTERVAL_US)),
+      m_capture_backtraces(options.capture_backtraces),
+      m_clock(clock ? clock : &m_system_clock),
+      m_term(false),
+      m_stall_count(NULL),
+      m_stall_max(NULL),
+      m_stall_last(NULL) {
+  if (export_map) {
+    m_stall_count = export_map->GetUIntMapVar(K_STALL_COUNT_VAR, "thread");
+    m_stall_max = export_map->GetUIntMapVar(K_STALL_MAX_VAR, "thread");
+    m_stall_last = export_map->GetStringMapVar(K_STALL_LAST_VAR, "thread");
+  }
+
+#ifdef HAVE_EXECINFO_H
+  if (m_capture_backtraces) {
+    InstallCaptureHandler();
+  }
+#endif  // HAVE_EXECINFO_H
+
+  MutexLocker lock(&registry_mutex);
+  watchdog_count++;
+}
+
+StallWatchdog::~StallWatchdog() {
+  Stop();
+  MutexLocker lock(&registry_mutex);
+  watchdog_count--;
+}
+
+void StallWatchdog::Stop() {
+  if (!IsRunning()) {
+    return;
+  }
+  {
+    MutexLocker lock(&m_term_mutex);
+    m_term = true;
+  }
+  m_term_cond.Signal();
+  Join();
+}
+
+void StallWatchdog::Check() {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  const int64_t now_us = ToMicroSeconds(now);
+
+  MutexLocker lock(&registry_mutex);
+  vector<Heartbeat*>::iterator iter = heartbeats.begin();
+  for (; iter != heartbeats.end(); ++iter) {
+    Heartbeat *heartbeat = *iter;
+    int64_t started = __atomic_load_n(&heartbeat->m_started_us,
+                                      __ATOMIC_ACQUIRE);
+    int64_t stalled_at = __atomic_load_n(&heartbeat->m_stalled_at,
+                                         __ATOMIC_ACQUIRE);
+
+    // If the section ended just before we flagged it, End() won't have
+    // claimed the stall, so do it here. We don't know how long it took.
+    if (stalled_at && stalled_at != started &&
+        __atomic_compare_exchange_n(&heartbeat->m_stalled_at, &stalled_at, 0,
+                                    false, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_ACQUIRE)) {
+      heartbeat->m_stall_ended = true;
+      heartbeat->m_stall_us = now_us - stalled_at;
+      heartbeat->m_stall_activity.clear();
+      stalled_at = 0;
+    }
+
+    if (heartbeat->m_stall_ended) {
+      ReportStallEnd(heartbeat);
+    }
+
+    if (started && !stalled_at && now_us - started >= m_threshold_us) {
+      __atomic_store_n(&heartbeat->m_stalled_at, started, __ATOMIC_RELEASE);
+      StallStarted(heartbeat, now_us - started);
+    }
+  }
+}
+
+bool StallWatchdog::Enabled() {
+  MutexLocker lock(&registry_mutex);
+  return watchdog_count > 0;
+}
+
+void *StallWatchdog::Run() {
+  Clock clock;
+  while (true) {
+    // Use real time here because wake_up is passed to pthread_cond_timedwait
+    TimeStamp wake_up;
+    clock.CurrentRealTime(&wake_up);
+    wake_up += m_check_interval;
+
+    {
+      MutexLocker lock(&m_term_mutex);
+      if (m_term) {
+        break;
+      }
+      m_term_cond.TimedWait(&m_term_mutex, wake_up);
+      if (m_term) {
+        break;
+      }
+    }
+    Check();
+  }
+  return NULL;
+}
+
+/*
+ * Called with the registry mutex held.
+ */
+void StallWatchdog::StallStarted(Heartbeat *heartbeat, int64_t elapsed_us) {
+  OLA_WARN << heartbeat->Name() << " has stalled, it's been busy for "
+           << elapsed_us / 1000 << "ms";
+  if (m_stall_count) {
+    m_stall_count->Increment(heartbeat->Name());
+  }
+  if (m_capture_backtraces) {
+    LogBacktrace(*heartbeat);
+  }
+}
+
+/*
+ * Called with the registry mutex held.
+ */
+void StallWatchdog::ReportStallEnd(Heartbeat *heartbeat) {
+  heartbeat->m_stall_ended = false;
+  const unsigned int stall_ms = heartbeat->m_stall_us / 1000;
+  std::ostringstream str;
+  str << stall_ms << "ms";
+  if (!heartbeat->m_stall_activity.empty()) {
+    str << " in " << heartbeat->m_stall_activity;
+  }
+
+  OLA_WARN << heartbeat->Name() << " recovered after stalling for "
+           << str.str();
+  if (m_stall_max) {
+    unsigned int &max = (*m_stall_max)[heartbeat->Name()];
+    max = std::max(max, stall_ms);
+  }
+  if (m_stall_last) {
+    m_stall_last->Set(heartbeat->Name(), str.str());
+  }
+}
+
+/*
+ * Called with the registry mutex held, which means the heartbeat's thread
+ * can't exit while we signal it.
+ */
+void StallWatchdog::LogBacktrace(const Heartbeat &heartbeat) {
+#ifdef HAVE_EXECINFO_H
+  static const unsigned int WAIT_US = 1000;
+  static const unsigned int MAX_WAITS = 100;
+
+  __atomic_store_n(&capture_done, 0, __ATOMIC_RELEASE);
+  if (pthread_kill(heartbeat.m_thread, SIGUSR2)) {
+    OLA_WARN << "Failed to signal " << heartbeat.Name();
+    return;
+  }
+
+  unsigned int waits = 0;
+  while (!__atomic_load_n(&capture_done, __ATOMIC_ACQUIRE)) {
+    if (++waits > MAX_WAITS) {
+      OLA_WARN << "Timed out waiting for the backtrace of "
+               << heartbeat.Name();
+      return;
+    }
+    usleep(WAIT_US);
+  }
+
+  char **symbols = backtrace_symbols(captured_frames, captured_size);
+  if (!symbols) {
+    return;
+  }
+  // The first two frames are the signal handler & the signal trampoline.
+  for (int i = 2; i < captured_size; i++) {
+    OLA_WARN << "  " << heartbeat.Name() << " #" << i - 2 << " "
+             << symbols[i];
+  }
+  free(symbols);
+#else
+  (void) heartbeat;
+#endif  // HAVE_EXECINFO_H
+}
+}  // namespace ola
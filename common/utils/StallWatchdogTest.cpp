@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StallWatchdogTest.cpp
+ * Test fixture for the StallWatchdog class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/util/StallWatchdog.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::ExportMap;
+using ola::Heartbeat;
+using ola::MockClock;
+using ola::StallWatchdog;
+using ola::TimeInterval;
+using std::string;
+
+class StallWatchdogTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(StallWatchdogTest);
+  CPPUNIT_TEST(testNoStall);
+  CPPUNIT_TEST(testStall);
+  CPPUNIT_TEST(testNestedSections);
+  CPPUNIT_TEST(testEnabled);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testNoStall();
+  void testStall();
+  void testNestedSections();
+  void testEnabled();
+
+  void setUp() {
+    m_options.threshold = TimeInterval(1, 0);
+    m_options.capture_backtraces = false;
+  }
+
+ private:
+  StallWatchdog::Options m_options;
+  MockClock m_clock;
+  ExportMap m_export_map;
+
+  unsigned int StallCount(const string &name) {
+    return (*m_export_map.GetUIntMapVar("stall-count"))[name];
+  }
+
+  unsigned int MaxStall(const string &name) {
+    return (*m_export_map.GetUIntMapVar("stall-max-ms"))[name];
+  }
+
+  string LastStall(const string &name) {
+    return (*m_export_map.GetStringMapVar("stall-last"))[name];
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StallWatchdogTest);
+
+/*
+ * Check that idle time & short sections aren't reported.
+ */
+void StallWatchdogTest::testNoStall() {
+  StallWatchdog watchdog(m_options, &m_export_map, &m_clock);
+  Heartbeat heartbeat("test", &m_clock);
+
+  // Idle for a long time.
+  m_clock.AdvanceTime(10, 0);
+  watchdog.Check();
+  OLA_ASSERT_EQ(0u, StallCount("test"));
+
+  for (unsigned int i = 0; i < 10; i++) {
+    heartbeat.Begin();
+    m_clock.AdvanceTime(0, 500000);
+    watchdog.Check();
+    heartbeat.End("handler");
+    watchdog.Check();
+  }
+  OLA_ASSERT_EQ(0u, StallCount("test"));
+  OLA_ASSERT_EQ(0u, MaxStall("test"));
+}
+
+/*
+ * Check a stall is counted once, and the duration & activity are recorded
+ * once it ends.
+ */
+void StallWatchdogTest::testStall() {
+  m_options.capture_backtraces = true;
+  StallWatchdog watchdog(m_options, &m_export_map, &m_clock);
+  Heartbeat heartbeat("test", &m_clock);
+
+  heartbeat.Begin();
+  m_clock.AdvanceTime(1, 500000);
+  watchdog.Check();
+  OLA_ASSERT_EQ(1u, StallCount("test"));
+
+  m_clock.AdvanceTime(1, 0);
+  watchdog.Check();
+  OLA_ASSERT_EQ(1u, StallCount("test"));
+  OLA_ASSERT_EQ(0u, MaxStall("test"));
+
+  heartbeat.End("slow-handler");
+  watchdog.Check();
+  OLA_ASSERT_EQ(1u, StallCount("test"));
+  OLA_ASSERT_EQ(2500u, MaxStall("test"));
+  OLA_ASSERT_EQ(string("2500ms in slow-handler"), LastStall("test"));
+
+  // A shorter stall doesn't change the max.
+  heartbeat.Begin();
+  m_clock.AdvanceTime(1, 200000);
+  watchdog.Check();
+  heartbeat.End();
+  watchdog.Check();
+  OLA_ASSERT_EQ(2u, StallCount("test"));
+  OLA_ASSERT_EQ(2500u, MaxStall("test"));
+  OLA_ASSERT_EQ(string("1200ms"), LastStall("test"));
+}
+
+/*
+ * Check that only the outermost section is timed.
+ */
+void StallWatchdogTest::testNestedSections() {
+  StallWatchdog watchdog(m_options, &m_export_map, &m_clock);
+  Heartbeat heartbeat("test", &m_clock);
+
+  heartbeat.Begin();
+  m_clock.AdvanceTime(0, 600000);
+  heartbeat.Begin();
+  heartbeat.End("inner");
+  m_clock.AdvanceTime(0, 600000);
+  watchdog.Check();
+  OLA_ASSERT_EQ(1u, StallCount("test"));
+
+  heartbeat.End("outer");
+  watchdog.Check();
+  OLA_ASSERT_EQ(string("1200ms in outer"), LastStall("test"));
+
+  // An unmatched End() is ignored.
+  heartbeat.End();
+  m_clock.AdvanceTime(5, 0);
+  watchdog.Check();
+  OLA_ASSERT_EQ(1u, StallCount("test"));
+}
+
+/*
+ * Check Enabled() tracks the watchdogs.
+ */
+void StallWatchdogTest::testEnabled() {
+  OLA_ASSERT_FALSE(StallWatchdog::Enabled());
+  {
+    StallWatchdog watchdog(m_options, NULL, &m_clock);
+    OLA_ASSERT_TRUE(StallWatchdog::Enabled());
+    OLA_ASSERT_TRUE(watchdog.Start());
+    watchdog.Stop();
+    OLA_ASSERT_FALSE(watchdog.IsRunning());
+  }
+  OLA_ASSERT_FALSE(StallWatchdog::Enabled());
+}
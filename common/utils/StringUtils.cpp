@@ -156,6 +156,20 @@ bool StringToInt(const string &value, unsigned int *output, bool strict) {
   if (value.empty()) {
     return false;
   }
+
+  // Most input is just digits, which we can parse without strtoll().
+  const char *begin = value.data();
+  const char *end = begin + value.size();
+  unsigned int v;
+  const char *digits_end = ola::strings::ParseUInt(begin, end, &v);
+  if (digits_end != begin) {
+    if (strict && digits_end != end) {
+      return false;
+    }
+    *output = v;
+    return true;
+  }
+
   char *end_ptr;
   errno = 0;
   long long l = strtoll(value.data(), &end_ptr, 10);  // NOLINT(runtime/int)
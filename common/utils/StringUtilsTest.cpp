@@ -53,6 +53,8 @@ using ola::StripPrefix;
 using ola::StripSuffix;
 using ola::ToLower;
 using ola::ToUpper;
+using ola::strings::FormatUInt;
+using ola::strings::ParseUInt;
 using ola::strings::ToHex;
 using std::ostringstream;
 using std::string;
@@ -68,6 +70,8 @@ class StringUtilsTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testStripPrefix);
   CPPUNIT_TEST(testStripSuffix);
   CPPUNIT_TEST(testIntToString);
+  CPPUNIT_TEST(testFormatUInt);
+  CPPUNIT_TEST(testParseUInt);
   CPPUNIT_TEST(testIntToHexString);
   CPPUNIT_TEST(testEscape);
   CPPUNIT_TEST(testEncodeString);
@@ -106,6 +110,8 @@ class StringUtilsTest: public CppUnit::TestFixture {
     void testStripPrefix();
     void testStripSuffix();
     void testIntToString();
+    void testFormatUInt();
+    void testParseUInt();
     void testIntToHexString();
     void testEscape();
     void testEncodeString();
@@ -336,6 +342,57 @@ void StringUtilsTest::testIntToString() {
   OLA_ASSERT_EQ(string("-1234"), IntToString(-1234));
   unsigned int i = 42;
   OLA_ASSERT_EQ(string("42"), IntToString(i));
+  OLA_ASSERT_EQ(string("4294967295"), IntToString(4294967295u));
+  OLA_ASSERT_EQ(string("-2147483648"), IntToString(INT32_MIN));
+}
+
+
+/*
+ * test the FormatUInt function.
+ */
+void StringUtilsTest::testFormatUInt() {
+  char output[ola::strings::MAX_UINT_DIGITS];
+  char *end = FormatUInt(0, output);
+  OLA_ASSERT_EQ(string("0"), string(output, end));
+  end = FormatUInt(255, output);
+  OLA_ASSERT_EQ(string("255"), string(output, end));
+  end = FormatUInt(4294967295u, output);
+  OLA_ASSERT_EQ(string("4294967295"), string(output, end));
+}
+
+
+/*
+ * test the ParseUInt function.
+ */
+void StringUtilsTest::testParseUInt() {
+  unsigned int value = 42;
+  string input = "";
+  const char *begin = input.data();
+  OLA_ASSERT_EQ(begin, ParseUInt(begin, begin, &value));
+  OLA_ASSERT_EQ(42u, value);
+
+  input = "123,45";
+  begin = input.data();
+  OLA_ASSERT_EQ(begin + 3, ParseUInt(begin, begin + input.size(), &value));
+  OLA_ASSERT_EQ(123u, value);
+  // only parse the range we're given
+  OLA_ASSERT_EQ(begin + 2, ParseUInt(begin, begin + 2, &value));
+  OLA_ASSERT_EQ(12u, value);
+
+  input = "4294967295";
+  begin = input.data();
+  OLA_ASSERT_EQ(begin + 10, ParseUInt(begin, begin + input.size(), &value));
+  OLA_ASSERT_EQ(4294967295u, value);
+
+  // whitespace, signs, non-digits & values that are too large are rejected
+  const char *invalid[] = {" 1", "+1", "-1", "a", "4294967296"};
+  for (unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    value = 42;
+    input = invalid[i];
+    begin = input.data();
+    OLA_ASSERT_EQ(begin, ParseUInt(begin, begin + input.size(), &value));
+    OLA_ASSERT_EQ(42u, value);
+  }
 }
 
 
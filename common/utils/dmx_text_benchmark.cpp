@@ -0,0 +1,161 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ * dmx_text_benchmark.cpp
+ * Benchmark the text form of DMX data, as used by the /set_dmx handler.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(iterations, i, 100000, "The number of iterations per test");
+
+// Stops the compiler from optimizing the loops away.
+static volatile unsigned int sink;
+
+/*
+ * The old implementation of DmxBuffer::SetFromString(), for comparison.
+ */
+void LegacySetFromString(const string &input, DmxBuffer *buffer) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  vector<string> dmx_values;
+  ola::StringSplit(input, &dmx_values, ",");
+  unsigned int i = 0;
+  vector<string>::const_iterator iter = dmx_values.begin();
+  for (; iter != dmx_values.end() && i < ola::DMX_UNIVERSE_SIZE;
+       ++iter, ++i) {
+    data[i] = atoi(iter->data());
+  }
+  buffer->Set(data, i);
+}
+
+/*
+ * The old implementation of DmxBuffer::ToString(), for comparison.
+ */
+string LegacyToString(const DmxBuffer &buffer) {
+  std::ostringstream str;
+  for (unsigned int i = 0; i < buffer.Size(); i++) {
+    if (i) {
+      str << ",";
+    }
+    str << static_cast<int>(buffer.Get(i));
+  }
+  return str.str();
+}
+
+/**
+ * The tests we run.
+ */
+typedef enum {
+  TEST_SET_DMX,  // the universe & data params of a /set_dmx POST
+  TEST_TO_STRING,  // format a frame, e.g. a line of a show file
+} TestType;
+
+/**
+ * Run a test FLAGS_iterations times and return the time per frame in ns.
+ */
+double RunTest(TestType type, bool legacy, const DmxBuffer &frame) {
+  const string universe_param = "12";
+  const string data_param = frame.ToString();
+
+  DmxBuffer buffer;
+  string output;
+  Clock clock;
+  TimeStamp start, end;
+  const unsigned int iterations = FLAGS_iterations;
+  unsigned int result = 0;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < iterations; i++) {
+    if (type == TEST_SET_DMX) {
+      unsigned int universe = 0;
+      ola::StringToInt(universe_param, &universe);
+      if (legacy) {
+        LegacySetFromString(data_param, &buffer);
+      } else {
+        buffer.SetFromString(data_param);
+      }
+      result += universe + buffer.Size();
+    } else {
+      if (legacy) {
+        output = LegacyToString(frame);
+      } else {
+        frame.ToString(&output);
+      }
+      result += output.size();
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+  sink = result;
+
+  TimeInterval duration = end - start;
+  return duration.AsInt() * 1000.0 / iterations;
+}
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark parsing & formatting DMX data as text.");
+
+  uint8_t ramp[ola::DMX_UNIVERSE_SIZE];
+  uint8_t mostly_zero[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    ramp[i] = i & 0xff;
+    mostly_zero[i] = (i % 64 < 6) ? (i * 37) & 0xff : 0;
+  }
+  const DmxBuffer frames[] = {
+    DmxBuffer(mostly_zero, sizeof(mostly_zero)),
+    DmxBuffer(ramp, sizeof(ramp)),
+    DmxBuffer(ramp, 24),
+  };
+  const char *frame_names[] = {"zeros", "ramp", "short"};
+
+  cout << std::setw(8) << "frame" << std::setw(16) << "set_dmx (ns)"
+       << std::setw(16) << "legacy (ns)" << std::setw(16) << "format (ns)"
+       << std::setw(16) << "legacy (ns)" << endl;
+
+  for (unsigned int i = 0; i < sizeof(frames) / sizeof(frames[0]); i++) {
+    cout << std::setw(8) << frame_names[i]
+         << std::fixed << std::setprecision(1)
+         << std::setw(16) << RunTest(TEST_SET_DMX, false, frames[i])
+         << std::setw(16) << RunTest(TEST_SET_DMX, true, frames[i])
+         << std::setw(16) << RunTest(TEST_TO_STRING, false, frames[i])
+         << std::setw(16) << RunTest(TEST_TO_STRING, true, frames[i])
+         << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,960 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CompiledSchema.cpp
+ * A JSON schema flattened into a form that's fast to validate against.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/stl/STLUtils.h"
+#include "ola/web/CompiledSchema.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonSchema.h"
+#include "ola/web/JsonTypes.h"
+
+namespace ola {
+namespace web {
+
+using std::auto_ptr;
+using std::map;
+using std::string;
+using std::vector;
+
+const CompiledSchema::Index CompiledSchema::NO_INDEX = 0xffffffff;
+
+namespace {
+
+// The kinds of value, a node has a mask of the kinds it accepts.
+enum {
+  KIND_NULL = 1 << 0,
+  KIND_BOOL = 1 << 1,
+  KIND_INTEGER = 1 << 2,
+  KIND_DOUBLE = 1 << 3,
+  KIND_STRING = 1 << 4,
+  KIND_ARRAY = 1 << 5,
+  KIND_OBJECT = 1 << 6,
+  KIND_RAW = 1 << 7,
+  KIND_ANY = 0xff,
+};
+
+typedef map<string, const JsonValue*> Keywords;
+
+/*
+ * Collect the properties of an object into a map.
+ */
+class KeywordCollector : public JsonObjectPropertyVisitor {
+ public:
+  explicit KeywordCollector(Keywords *keywords) : m_keywords(keywords) {}
+
+  void VisitProperty(const string &property, const JsonValue &value) {
+    (*m_keywords)[property] = &value;
+  }
+
+ private:
+  Keywords *m_keywords;
+};
+}  // namespace
+
+
+/*
+ * A JsonValue, with the type resolved.
+ */
+struct CompiledSchema::Value {
+  Value()
+      : kind(0),
+        json(NULL),
+        str(NULL),
+        number(NULL),
+        array(NULL),
+        object(NULL),
+        bool_value(false),
+        integer(0) {
+  }
+
+  uint32_t kind;
+  const JsonValue *json;
+  const JsonString *str;
+  const JsonNumber *number;
+  const JsonArray *array;
+  const JsonObject *object;
+  bool bool_value;
+  int64_t integer;
+};
+
+/*
+ * The state for a single call to IsValid().
+ */
+struct CompiledSchema::Context {
+  // A stack of the properties seen in each object that's being checked.
+  vector<uint64_t> seen;
+};
+
+/*
+ * Resolve the type of a JsonValue.
+ */
+class CompiledSchema::Classifier : public JsonValueConstVisitorInterface {
+ public:
+  explicit Classifier(Value *value) : m_value(value) {}
+
+  void Visit(const JsonString &value) {
+    Set(KIND_STRING, value);
+    m_value->str = &value;
+  }
+
+  void Visit(const JsonBool &value) {
+    Set(KIND_BOOL, value);
+    m_value->bool_value = value.Value();
+  }
+
+  void Visit(const JsonNull &value) {
+    Set(KIND_NULL, value);
+  }
+
+  void Visit(const JsonRawValue &value) {
+    Set(KIND_RAW, value);
+  }
+
+  void Visit(const JsonObject &value) {
+    Set(KIND_OBJECT, value);
+    m_value->object = &value;
+  }
+
+  void Visit(const JsonArray &value) {
+    Set(KIND_ARRAY, value);
+    m_value->array = &value;
+  }
+
+  void Visit(const JsonUInt &value) {
+    SetNumber(KIND_INTEGER, value);
+    m_value->integer = value.Value();
+  }
+
+  void Visit(const JsonUInt64 &value) {
+    SetNumber(KIND_INTEGER, value);
+    m_value->integer = static_cast<int64_t>(value.Value());
+  }
+
+  void Visit(const JsonInt &value) {
+    SetNumber(KIND_INTEGER, value);
+    m_value->integer = value.Value();
+  }
+
+  void Visit(const JsonInt64 &value) {
+    SetNumber(KIND_INTEGER, value);
+    m_value->integer = value.Value();
+  }
+
+  void Visit(const JsonDouble &value) {
+    SetNumber(KIND_DOUBLE, value);
+  }
+
+ private:
+  Value *m_value;
+
+  void Set(uint32_t kind, const JsonValue &value) {
+    m_value->kind = kind;
+    m_value->json = &value;
+  }
+
+  void SetNumber(uint32_t kind, const JsonNumber &value) {
+    Set(kind, value);
+    m_value->number = &value;
+  }
+};
+
+
+/*
+ * Checks each property of an object.
+ */
+class CompiledSchema::PropertyChecker : public JsonObjectPropertyVisitor {
+ public:
+  PropertyChecker(const CompiledSchema *schema, const ObjectRules &rules,
+                  bool track_seen, size_t seen_offset, Context *context)
+      : m_schema(schema),
+        m_rules(rules),
+        m_track_seen(track_seen),
+        m_seen_offset(seen_offset),
+        m_context(context),
+        m_is_valid(true) {
+  }
+
+  bool IsValid() const { return m_is_valid; }
+
+  void VisitProperty(const string &property, const JsonValue &value) {
+    if (!m_is_valid) {
+      return;
+    }
+
+    Index name = NO_INDEX;
+    if (m_track_seen || m_rules.property_count) {
+      name = m_schema->LookupName(property);
+    }
+    if (m_track_seen && name != NO_INDEX) {
+      m_context->seen[m_seen_offset + name / 64] |= (1ull << (name % 64));
+    }
+
+    Index node = m_rules.additional_node;
+    if (name != NO_INDEX && m_rules.property_count) {
+      const Property *begin = &m_schema->m_properties[m_rules.first_property];
+      const Property *end = begin + m_rules.property_count;
+      const Property *iter = std::lower_bound(begin, end, name, NameLessThan);
+      if (iter != end && iter->name == name) {
+        node = iter->node;
+      }
+    }
+
+    if (node != NO_INDEX) {
+      m_is_valid = m_schema->Validate(node, value, m_context);
+    } else if (m_rules.reject_additional) {
+      m_is_valid = false;
+    }
+  }
+
+ private:
+  const CompiledSchema *m_schema;
+  const ObjectRules &m_rules;
+  const bool m_track_seen;
+  const size_t m_seen_offset;
+  Context *m_context;
+  bool m_is_valid;
+
+  static bool NameLessThan(const Property &property, Index name) {
+    return property.name < name;
+  }
+};
+
+
+/*
+ * Builds a CompiledSchema from the JSON representation of a schema.
+ */
+class CompiledSchema::Compiler {
+ public:
+  explicit Compiler(CompiledSchema *schema) : m_schema(schema) {}
+
+  void Compile(const JsonObject &root);
+
+ private:
+  CompiledSchema *m_schema;
+  Keywords m_definitions;
+  map<string, Index> m_definition_nodes;
+  // The sets of names that become bitsets once all the names are known.
+  vector<vector<Index> > m_name_sets;
+
+  Index CompileSchema(const JsonValue &json);
+  void CompileInto(Index index, const JsonValue &json);
+  Index CompileDefinition(const string &name);
+  void AddNumberOps(const Keywords &keywords, vector<Op> *ops);
+  void AddEnumOp(const Keywords &keywords, vector<Op> *ops);
+  void AddObjectOps(const Keywords &keywords, vector<Op> *ops);
+  void AddArrayOps(const Keywords &keywords, vector<Op> *ops);
+  Index CompileList(const JsonValue &json);
+  Index AddNameSet(const JsonArray &array);
+  Index Intern(const string &name);
+  Index AddConstant(const JsonValue &value);
+  void BuildBitsets();
+
+  static void AddOp(vector<Op> *ops, Opcode code, Index arg = 0,
+                    Index count = 0);
+  static bool GetUInt(const Keywords &keywords, const string &keyword,
+                      Index *value);
+  static const JsonValue *Find(const Keywords &keywords,
+                               const string &keyword);
+  static Value Classify(const JsonValue &json);
+  static bool PropertyLessThan(const Property &a, const Property &b);
+};
+
+void CompiledSchema::Compiler::Compile(const JsonObject &root) {
+  Keywords keywords;
+  KeywordCollector collector(&keywords);
+  root.VisitProperties(&collector);
+
+  const JsonValue *definitions = Find(keywords, "definitions");
+  if (definitions) {
+    Value value = Classify(*definitions);
+    if (value.object) {
+      KeywordCollector definition_collector(&m_definitions);
+      value.object->VisitProperties(&definition_collector);
+    }
+  }
+
+  m_schema->m_root = CompileSchema(root);
+  BuildBitsets();
+}
+
+CompiledSchema::Index CompiledSchema::Compiler::CompileSchema(
+    const JsonValue &json) {
+  Value value = Classify(json);
+  if (value.object) {
+    Keywords keywords;
+    KeywordCollector collector(&keywords);
+    value.object->VisitProperties(&collector);
+    const JsonValue *ref = Find(keywords, "$ref");
+    if (ref) {
+      // References resolve to the definition's node directly.
+      Value ref_value = Classify(*ref);
+      if (ref_value.str &&
+          STLContains(m_definitions, ref_value.str->Value())) {
+        return CompileDefinition(ref_value.str->Value());
+      }
+    }
+  }
+
+  Index index = m_schema->m_nodes.size();
+  m_schema->m_nodes.push_back(Node());
+  CompileInto(index, json);
+  return index;
+}
+
+/*
+ * Compile a definition. The node is reserved before the definition is
+ * compiled, so definitions can refer to themselves.
+ */
+CompiledSchema::Index CompiledSchema::Compiler::CompileDefinition(
+    const string &name) {
+  map<string, Index>::const_iterator iter = m_definition_nodes.find(name);
+  if (iter != m_definition_nodes.end()) {
+    return iter->second;
+  }
+
+  Index index = m_schema->m_nodes.size();
+  m_schema->m_nodes.push_back(Node());
+  m_definition_nodes[name] = index;
+  CompileInto(index, *m_definitions[name]);
+  return index;
+}
+
+/*
+ * This follows SchemaParseContext::GetValidator(). Only the keywords that the
+ * validators check are compiled, e.g. objects and arrays don't check enums.
+ */
+void CompiledSchema::Compiler::CompileInto(Index index,
+                                           const JsonValue &json) {
+  // Ops are collected here, since compiling the child schemas adds ops too.
+  vector<Op> ops;
+  uint32_t kinds = KIND_ANY;
+
+  Keywords keywords;
+  Value value = Classify(json);
+  if (value.object) {
+    KeywordCollector collector(&keywords);
+    value.object->VisitProperties(&collector);
+  }
+
+  const JsonValue *ref = Find(keywords, "$ref");
+  const JsonValue *type_value = Find(keywords, "type");
+  JsonType type = JSON_UNDEFINED;
+  if (type_value) {
+    Value type_str = Classify(*type_value);
+    if (type_str.str) {
+      type = StringToJsonType(type_str.str->Value());
+    }
+  }
+
+  if (ref) {
+    Value ref_value = Classify(*ref);
+    if (ref_value.str &&
+        STLContains(m_definitions, ref_value.str->Value())) {
+      Index list = m_schema->m_node_lists.size();
+      m_schema->m_node_lists.push_back(
+          CompileDefinition(ref_value.str->Value()));
+      AddOp(&ops, OP_ALL_OF, list, 1);
+    } else {
+      // Unresolved references never match.
+      AddOp(&ops, OP_FAIL);
+    }
+  } else {
+    switch (type) {
+      case JSON_ARRAY:
+        kinds = KIND_ARRAY;
+        AddArrayOps(keywords, &ops);
+        break;
+      case JSON_BOOLEAN:
+        kinds = KIND_BOOL;
+        AddEnumOp(keywords, &ops);
+        break;
+      case JSON_INTEGER:
+        kinds = KIND_INTEGER;
+        AddNumberOps(keywords, &ops);
+        AddEnumOp(keywords, &ops);
+        break;
+      case JSON_NULL:
+        kinds = KIND_NULL;
+        AddEnumOp(keywords, &ops);
+        break;
+      case JSON_NUMBER:
+        kinds = KIND_INTEGER | KIND_DOUBLE;
+        AddNumberOps(keywords, &ops);
+        AddEnumOp(keywords, &ops);
+        break;
+      case JSON_OBJECT:
+        kinds = KIND_OBJECT;
+        AddObjectOps(keywords, &ops);
+        break;
+      case JSON_STRING:
+        {
+          kinds = KIND_STRING;
+          Index length;
+          if (GetUInt(keywords, "minLength", &length)) {
+            AddOp(&ops, OP_MIN_LENGTH, length);
+          }
+          if (GetUInt(keywords, "maxLength", &length)) {
+            AddOp(&ops, OP_MAX_LENGTH, length);
+          }
+          AddEnumOp(keywords, &ops);
+        }
+        break;
+      case JSON_UNDEFINED:
+        {
+          const JsonValue *child;
+          if ((child = Find(keywords, "allOf"))) {
+            AddOp(&ops, OP_ALL_OF, CompileList(*child),
+                  Classify(*child).array->Size());
+          } else if ((child = Find(keywords, "anyOf"))) {
+            AddOp(&ops, OP_ANY_OF, CompileList(*child),
+                  Classify(*child).array->Size());
+          } else if ((child = Find(keywords, "oneOf"))) {
+            AddOp(&ops, OP_ONE_OF, CompileList(*child),
+                  Classify(*child).array->Size());
+          } else if ((child = Find(keywords, "not"))) {
+            AddOp(&ops, OP_NOT, CompileSchema(*child));
+          }
+        }
+        break;
+    }
+  }
+
+  Node &node = m_schema->m_nodes[index];
+  node.kinds = kinds;
+  node.first_op = m_schema->m_ops.size();
+  node.op_count = ops.size();
+  m_schema->m_ops.insert(m_schema->m_ops.end(), ops.begin(), ops.end());
+}
+
+void CompiledSchema::Compiler::AddNumberOps(const Keywords &keywords,
+                                            vector<Op> *ops) {
+  const JsonValue *limit = Find(keywords, "minimum");
+  if (limit) {
+    const JsonValue *exclusive = Find(keywords, "exclusiveMinimum");
+    bool is_exclusive = exclusive && Classify(*exclusive).bool_value;
+    AddOp(ops, is_exclusive ? OP_EXCLUSIVE_MINIMUM : OP_MINIMUM,
+          AddConstant(*limit));
+  }
+
+  limit = Find(keywords, "maximum");
+  if (limit) {
+    const JsonValue *exclusive = Find(keywords, "exclusiveMaximum");
+    bool is_exclusive = exclusive && Classify(*exclusive).bool_value;
+    AddOp(ops, is_exclusive ? OP_EXCLUSIVE_MAXIMUM : OP_MAXIMUM,
+          AddConstant(*limit));
+  }
+
+  const JsonValue *multiple_of = Find(keywords, "multipleOf");
+  if (multiple_of) {
+    AddOp(ops, OP_MULTIPLE_OF, AddConstant(*multiple_of));
+  }
+}
+
+void CompiledSchema::Compiler::AddEnumOp(const Keywords &keywords,
+                                         vector<Op> *ops) {
+  const JsonValue *enums = Find(keywords, "enum");
+  if (!enums) {
+    return;
+  }
+  const JsonArray *array = Classify(*enums).array;
+  if (!array || array->Size() == 0) {
+    return;
+  }
+
+  Index first = m_schema->m_constants.size();
+  for (unsigned int i = 0; i < array->Size(); i++) {
+    AddConstant(*array->ElementAt(i));
+  }
+  AddOp(ops, OP_ENUM, first, array->Size());
+}
+
+void CompiledSchema::Compiler::AddObjectOps(const Keywords &keywords,
+                                            vector<Op> *ops) {
+  Index count;
+  if (GetUInt(keywords, "minProperties", &count) && count > 0) {
+    AddOp(ops, OP_MIN_PROPERTIES, count);
+  }
+  // The ObjectValidator treats a maximum of 0 as no limit.
+  if (GetUInt(keywords, "maxProperties", &count) && count > 0) {
+    AddOp(ops, OP_MAX_PROPERTIES, count);
+  }
+
+  ObjectRules rules;
+  rules.additional_node = NO_INDEX;
+  rules.reject_additional = false;
+  rules.required = NO_INDEX;
+
+  vector<Property> properties;
+  const JsonValue *json = Find(keywords, "properties");
+  if (json && Classify(*json).object) {
+    Keywords property_schemas;
+    KeywordCollector collector(&property_schemas);
+    Classify(*json).object->VisitProperties(&collector);
+    Keywords::const_iterator iter = property_schemas.begin();
+    for (; iter != property_schemas.end(); ++iter) {
+      Property property = {Intern(iter->first), CompileSchema(*iter->second)};
+      properties.push_back(property);
+    }
+  }
+
+  json = Find(keywords, "additionalProperties");
+  if (json) {
+    Value value = Classify(*json);
+    if (value.kind == KIND_BOOL) {
+      rules.reject_additional = !value.bool_value;
+    } else {
+      rules.additional_node = CompileSchema(*json);
+    }
+  }
+
+  json = Find(keywords, "required");
+  if (json && Classify(*json).array) {
+    rules.required = AddNameSet(*Classify(*json).array);
+  }
+
+  vector<PropertyDependency> property_dependencies;
+  vector<Property> schema_dependencies;
+  json = Find(keywords, "dependencies");
+  if (json && Classify(*json).object) {
+    Keywords dependencies;
+    KeywordCollector collector(&dependencies);
+    Classify(*json).object->VisitProperties(&collector);
+    Keywords::const_iterator iter = dependencies.begin();
+    for (; iter != dependencies.end(); ++iter) {
+      Value dependency = Classify(*iter->second);
+      if (dependency.array) {
+        PropertyDependency property_dependency = {
+          Intern(iter->first), AddNameSet(*dependency.array)};
+        property_dependencies.push_back(property_dependency);
+      } else {
+        Property schema_dependency = {
+          Intern(iter->first), CompileSchema(*iter->second)};
+        schema_dependencies.push_back(schema_dependency);
+      }
+    }
+  }
+
+  if (properties.empty() && rules.additional_node == NO_INDEX &&
+      !rules.reject_additional && rules.required == NO_INDEX &&
+      property_dependencies.empty() && schema_dependencies.empty()) {
+    return;
+  }
+
+  std::sort(properties.begin(), properties.end(), PropertyLessThan);
+  rules.first_property = m_schema->m_properties.size();
+  rules.property_count = properties.size();
+  m_schema->m_properties.insert(m_schema->m_properties.end(),
+                                properties.begin(), properties.end());
+
+  rules.first_property_dependency =
+      m_schema->m_property_dependencies.size();
+  rules.property_dependency_count = property_dependencies.size();
+  m_schema->m_property_dependencies.insert(
+      m_schema->m_property_dependencies.end(),
+      property_dependencies.begin(), property_dependencies.end());
+
+  rules.first_schema_dependency = m_schema->m_properties.size();
+  rules.schema_dependency_count = schema_dependencies.size();
+  m_schema->m_properties.insert(m_schema->m_properties.end(),
+                                schema_dependencies.begin(),
+                                schema_dependencies.end());
+
+  AddOp(ops, OP_OBJECT, m_schema->m_objects.size());
+  m_schema->m_objects.push_back(rules);
+}
+
+/*
+ * This follows ArrayValidator::ConstructElementValidator().
+ */
+void CompiledSchema::Compiler::AddArrayOps(const Keywords &keywords,
+                                           vector<Op> *ops) {
+  Index count;
+  if (GetUInt(keywords, "minItems", &count) && count > 0) {
+    AddOp(ops, OP_MIN_ITEMS, count);
+  }
+  // The ArrayValidator treats a maximum of 0 as no limit.
+  if (GetUInt(keywords, "maxItems", &count) && count > 0) {
+    AddOp(ops, OP_MAX_ITEMS, count);
+  }
+
+  const JsonValue *items = Find(keywords, "items");
+  if (items) {
+    ArrayRules rules;
+    rules.first_tuple_node = 0;
+    rules.tuple_size = 0;
+    rules.additional_node = NO_INDEX;
+    rules.reject_additional = false;
+
+    const JsonArray *tuple = Classify(*items).array;
+    if (tuple) {
+      rules.first_tuple_node = CompileList(*items);
+      rules.tuple_size = tuple->Size();
+
+      const JsonValue *additional = Find(keywords, "additionalItems");
+      if (additional) {
+        Value value = Classify(*additional);
+        if (value.kind == KIND_BOOL) {
+          rules.reject_additional = !value.bool_value;
+        } else {
+          rules.additional_node = CompileSchema(*additional);
+        }
+      }
+    } else {
+      rules.additional_node = CompileSchema(*items);
+    }
+    AddOp(ops, OP_ITEMS, m_schema->m_arrays.size());
+    m_schema->m_arrays.push_back(rules);
+  }
+
+  const JsonValue *unique = Find(keywords, "uniqueItems");
+  if (unique && Classify(*unique).bool_value) {
+    AddOp(ops, OP_UNIQUE_ITEMS);
+  }
+}
+
+/*
+ * Compile an array of schemas.
+ * @returns the index of the first node in m_node_lists.
+ */
+CompiledSchema::Index CompiledSchema::Compiler::CompileList(
+    const JsonValue &json) {
+  const JsonArray *array = Classify(json).array;
+  vector<Index> nodes;
+  for (unsigned int i = 0; array && i < array->Size(); i++) {
+    nodes.push_back(CompileSchema(*array->ElementAt(i)));
+  }
+  Index first = m_schema->m_node_lists.size();
+  m_schema->m_node_lists.insert(m_schema->m_node_lists.end(),
+                                nodes.begin(), nodes.end());
+  return first;
+}
+
+CompiledSchema::Index CompiledSchema::Compiler::AddNameSet(
+    const JsonArray &array) {
+  vector<Index> names;
+  for (unsigned int i = 0; i < array.Size(); i++) {
+    Value value = Classify(*array.ElementAt(i));
+    if (value.str) {
+      names.push_back(Intern(value.str->Value()));
+    }
+  }
+  m_name_sets.push_back(names);
+  return m_name_sets.size() - 1;
+}
+
+CompiledSchema::Index CompiledSchema::Compiler::Intern(const string &name) {
+  Index index = m_schema->m_names.size();
+  return m_schema->m_names.insert(std::make_pair(name, index)).first->second;
+}
+
+CompiledSchema::Index CompiledSchema::Compiler::AddConstant(
+    const JsonValue &value) {
+  m_schema->m_constants.push_back(value.Clone());
+  return m_schema->m_constants.size() - 1;
+}
+
+void CompiledSchema::Compiler::BuildBitsets() {
+  m_schema->m_bitset_words = (m_schema->m_names.size() + 63) / 64;
+  m_schema->m_bitsets.assign(
+      m_name_sets.size() * m_schema->m_bitset_words, 0);
+  for (unsigned int i = 0; i < m_name_sets.size(); i++) {
+    uint64_t *bitset = &m_schema->m_bitsets[i * m_schema->m_bitset_words];
+    vector<Index>::const_iterator iter = m_name_sets[i].begin();
+    for (; iter != m_name_sets[i].end(); ++iter) {
+      bitset[*iter / 64] |= (1ull << (*iter % 64));
+    }
+  }
+}
+
+void CompiledSchema::Compiler::AddOp(vector<Op> *ops, Opcode code,
+                                     Index arg, Index count) {
+  Op op = {code, arg, count};
+  ops->push_back(op);
+}
+
+bool CompiledSchema::Compiler::GetUInt(const Keywords &keywords,
+                                       const string &keyword,
+                                       Index *value) {
+  const JsonValue *json = Find(keywords, keyword);
+  if (!json) {
+    return false;
+  }
+  Value number = Classify(*json);
+  if (number.kind != KIND_INTEGER || number.integer < 0) {
+    return false;
+  }
+  *value = static_cast<Index>(number.integer);
+  return true;
+}
+
+const JsonValue *CompiledSchema::Compiler::Find(const Keywords &keywords,
+                                                const string &keyword) {
+  return STLFindOrNull(keywords, keyword);
+}
+
+CompiledSchema::Value CompiledSchema::Compiler::Classify(
+    const JsonValue &json) {
+  Value value;
+  Classifier classifier(&value);
+  json.Accept(&classifier);
+  return value;
+}
+
+bool CompiledSchema::Compiler::PropertyLessThan(const Property &a,
+                                                const Property &b) {
+  return a.name < b.name;
+}
+
+
+// CompiledSchema
+// -----------------------------------------------------------------------------
+CompiledSchema::CompiledSchema()
+    : m_bitset_words(0),
+      m_root(0) {
+}
+
+CompiledSchema::~CompiledSchema() {
+  STLDeleteElements(&m_constants);
+}
+
+bool CompiledSchema::IsValid(const JsonValue &value) const {
+  Context context;
+  return Validate(m_root, value, &context);
+}
+
+CompiledSchema* CompiledSchema::Compile(const JsonSchema &schema) {
+  auto_ptr<const JsonObject> json(schema.AsJson());
+  CompiledSchema *compiled = new CompiledSchema();
+  Compiler compiler(compiled);
+  compiler.Compile(*json);
+  return compiled;
+}
+
+CompiledSchema* CompiledSchema::FromString(const string &schema_string,
+                                           string *error) {
+  auto_ptr<JsonSchema> schema(JsonSchema::FromString(schema_string, error));
+  if (!schema.get()) {
+    return NULL;
+  }
+  return Compile(*schema);
+}
+
+bool CompiledSchema::Validate(Index node_index, const JsonValue &json,
+                              Context *context) const {
+  Value value;
+  Classifier classifier(&value);
+  json.Accept(&classifier);
+  return RunNode(m_nodes[node_index], value, context);
+}
+
+bool CompiledSchema::RunNode(const Node &node, const Value &value,
+                             Context *context) const {
+  if (!(node.kinds & value.kind)) {
+    return false;
+  }
+  if (node.op_count == 0) {
+    return true;
+  }
+
+  const Op *op = &m_ops[0] + node.first_op;
+  const Op *end = op + node.op_count;
+  for (; op != end; ++op) {
+    if (!RunOp(*op, value, context)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CompiledSchema::RunOp(const Op &op, const Value &value,
+                           Context *context) const {
+  switch (op.code) {
+    case OP_MIN_LENGTH:
+      return value.str->Value().size() >= op.arg;
+    case OP_MAX_LENGTH:
+      return value.str->Value().size() <= op.arg;
+    case OP_MINIMUM:
+      return *value.number >=
+          *static_cast<const JsonNumber*>(m_constants[op.arg]);
+    case OP_EXCLUSIVE_MINIMUM:
+      return *value.number >
+          *static_cast<const JsonNumber*>(m_constants[op.arg]);
+    case OP_MAXIMUM:
+      return *value.number <=
+          *static_cast<const JsonNumber*>(m_constants[op.arg]);
+    case OP_EXCLUSIVE_MAXIMUM:
+      return *value.number <
+          *static_cast<const JsonNumber*>(m_constants[op.arg]);
+    case OP_MULTIPLE_OF:
+      return value.number->MultipleOf(
+          *static_cast<const JsonNumber*>(m_constants[op.arg]));
+    case OP_ENUM:
+      for (Index i = op.arg; i < op.arg + op.count; i++) {
+        if (*m_constants[i] == *value.json) {
+          return true;
+        }
+      }
+      return false;
+    case OP_MIN_PROPERTIES:
+      return value.object->Size() >= op.arg;
+    case OP_MAX_PROPERTIES:
+      return value.object->Size() <= op.arg;
+    case OP_OBJECT:
+      return CheckObject(m_objects[op.arg], *value.object, context);
+    case OP_MIN_ITEMS:
+      return value.array->Size() >= op.arg;
+    case OP_MAX_ITEMS:
+      return value.array->Size() <= op.arg;
+    case OP_ITEMS:
+      return CheckArray(m_arrays[op.arg], *value.array, context);
+    case OP_UNIQUE_ITEMS:
+      for (unsigned int i = 0; i < value.array->Size(); i++) {
+        for (unsigned int j = 0; j < i; j++) {
+          if (*value.array->ElementAt(i) == *value.array->ElementAt(j)) {
+            return false;
+          }
+        }
+      }
+      return true;
+    case OP_ALL_OF:
+      for (Index i = op.arg; i < op.arg + op.count; i++) {
+        if (!RunNode(m_nodes[m_node_lists[i]], value, context)) {
+          return false;
+        }
+      }
+      return true;
+    case OP_ANY_OF:
+      for (Index i = op.arg; i < op.arg + op.count; i++) {
+        if (RunNode(m_nodes[m_node_lists[i]], value, context)) {
+          return true;
+        }
+      }
+      return false;
+    case OP_ONE_OF:
+      {
+        bool matched = false;
+        for (Index i = op.arg; i < op.arg + op.count; i++) {
+          if (RunNode(m_nodes[m_node_lists[i]], value, context)) {
+            if (matched) {
+              return false;
+            }
+            matched = true;
+          }
+        }
+        return matched;
+      }
+    case OP_NOT:
+      return !RunNode(m_nodes[op.arg], value, context);
+    case OP_FAIL:
+      return false;
+  }
+  return false;
+}
+
+bool CompiledSchema::CheckObject(const ObjectRules &rules,
+                                 const JsonObject &object,
+                                 Context *context) const {
+  const bool track_seen = (rules.required != NO_INDEX ||
+                           rules.property_dependency_count ||
+                           rules.schema_dependency_count);
+  // Nested objects push their own bitsets, so use an offset rather than a
+  // pointer.
+  const size_t offset = context->seen.size();
+  if (track_seen) {
+    context->seen.resize(offset + m_bitset_words, 0);
+  }
+
+  PropertyChecker checker(this, rules, track_seen, offset, context);
+  object.VisitProperties(&checker);
+  bool is_valid = checker.IsValid();
+
+  if (is_valid && rules.required != NO_INDEX) {
+    is_valid = IsSubset(rules.required, *context, offset);
+  }
+
+  for (Index i = 0; is_valid && i < rules.property_dependency_count; i++) {
+    const PropertyDependency &dependency =
+        m_property_dependencies[rules.first_property_dependency + i];
+    if (IsSeen(dependency.name, *context, offset)) {
+      is_valid = IsSubset(dependency.bitset, *context, offset);
+    }
+  }
+
+  for (Index i = 0; is_valid && i < rules.schema_dependency_count; i++) {
+    const Property &dependency =
+        m_properties[rules.first_schema_dependency + i];
+    if (IsSeen(dependency.name, *context, offset)) {
+      is_valid = Validate(dependency.node, object, context);
+    }
+  }
+
+  context->seen.resize(offset);
+  return is_valid;
+}
+
+bool CompiledSchema::CheckArray(const ArrayRules &rules,
+                                const JsonArray &array,
+                                Context *context) const {
+  for (unsigned int i = 0; i < array.Size(); i++) {
+    Index node = rules.additional_node;
+    if (i < rules.tuple_size) {
+      node = m_node_lists[rules.first_tuple_node + i];
+    } else if (rules.reject_additional) {
+      return false;
+    }
+
+    if (node != NO_INDEX && !Validate(node, *array.ElementAt(i), context)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CompiledSchema::IsSeen(Index name, const Context &context,
+                            size_t offset) const {
+  return context.seen[offset + name / 64] & (1ull << (name % 64));
+}
+
+/*
+ * Check all the names in the bitset have been seen.
+ */
+bool CompiledSchema::IsSubset(Index bitset, const Context &context,
+                              size_t offset) const {
+  const uint64_t *names = &m_bitsets[bitset * m_bitset_words];
+  for (unsigned int i = 0; i < m_bitset_words; i++) {
+    if (names[i] & ~context.seen[offset + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CompiledSchema::Index CompiledSchema::LookupName(const string &name) const {
+  map<string, Index>::const_iterator iter = m_names.find(name);
+  return iter == m_names.end() ? NO_INDEX : iter->second;
+}
+}  // namespace web
+}  // namespace ola
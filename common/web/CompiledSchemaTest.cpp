@@ -0,0 +1,346 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CompiledSchemaTest.cpp
+ * Unittest for the CompiledSchema.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/file/Util.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/web/CompiledSchema.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonParser.h"
+#include "ola/web/JsonSchema.h"
+#include "ola/web/JsonWriter.h"
+
+using ola::web::CompiledSchema;
+using ola::web::JsonParser;
+using ola::web::JsonSchema;
+using ola::web::JsonValue;
+using ola::web::JsonWriter;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+class CompiledSchemaTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(CompiledSchemaTest);
+  CPPUNIT_TEST(testTypes);
+  CPPUNIT_TEST(testObjects);
+  CPPUNIT_TEST(testArrays);
+  CPPUNIT_TEST(testReferences);
+  CPPUNIT_TEST(testMatchesJsonSchema);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testTypes();
+  void testObjects();
+  void testArrays();
+  void testReferences();
+  void testMatchesJsonSchema();
+
+ private:
+  vector<JsonValue*> m_values;
+
+  bool IsValid(const string &schema, const string &value);
+  void CheckSameResult(const string &schema);
+  void ReadSchemas(const string &filename, vector<string> *schemas);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CompiledSchemaTest);
+
+/*
+ * The values to check each schema against.
+ */
+void CompiledSchemaTest::setUp() {
+  const char *values[] = {
+    "null",
+    "true",
+    "false",
+    "0",
+    "1",
+    "-1",
+    "3",
+    "10",
+    "100",
+    "1.5",
+    "-2.5",
+    "4294967296",
+    "-4294967296",
+    "\"\"",
+    "\"a\"",
+    "\"foo\"",
+    "\"bar\"",
+    "\"a long string\"",
+    "[]",
+    "[1]",
+    "[1, 1]",
+    "[1, \"a\"]",
+    "[\"a\", \"b\", \"c\", \"d\"]",
+    "[[]]",
+    "[{}]",
+    "[true, null, 1.5]",
+    "{}",
+    "{\"a\": 1}",
+    "{\"a\": \"x\", \"b\": 2}",
+    "{\"name\": \"simon\"}",
+    "{\"name\": \"simon\", \"age\": 3}",
+    "{\"name\": \"simon\", \"age\": 3, \"extra\": true}",
+    "{\"foo\": 1, \"bar\": 2, \"baz\": 3}",
+    "{\"foo\": [1, 2]}",
+    "{\"type\": \"string\"}",
+    "{\"type\": \"object\", \"properties\": {}}",
+    "{\"minimum\": 1, \"exclusiveMinimum\": true}",
+  };
+
+  for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    string error;
+    JsonValue *value = JsonParser::Parse(values[i], &error);
+    OLA_ASSERT_NOT_NULL(value);
+    m_values.push_back(value);
+  }
+}
+
+void CompiledSchemaTest::tearDown() {
+  ola::STLDeleteElements(&m_values);
+}
+
+bool CompiledSchemaTest::IsValid(const string &schema_str,
+                                 const string &value_str) {
+  string error;
+  auto_ptr<CompiledSchema> schema(
+      CompiledSchema::FromString(schema_str, &error));
+  OLA_ASSERT_NOT_NULL(schema.get());
+  auto_ptr<JsonValue> value(JsonParser::Parse(value_str, &error));
+  OLA_ASSERT_NOT_NULL(value.get());
+  return schema->IsValid(*value);
+}
+
+/*
+ * Check the CompiledSchema gives the same result as the JsonSchema for all
+ * of the values.
+ */
+void CompiledSchemaTest::CheckSameResult(const string &schema_str) {
+  string error;
+  auto_ptr<JsonSchema> schema(JsonSchema::FromString(schema_str, &error));
+  OLA_ASSERT_TRUE_MSG(schema.get() != NULL, schema_str);
+  auto_ptr<CompiledSchema> compiled(CompiledSchema::Compile(*schema));
+  OLA_ASSERT_NOT_NULL(compiled.get());
+
+  vector<JsonValue*>::const_iterator iter = m_values.begin();
+  for (; iter != m_values.end(); ++iter) {
+    OLA_ASSERT_EQ_MSG(schema->IsValid(**iter), compiled->IsValid(**iter),
+                      schema_str + " with " +
+                      JsonWriter::AsString(**iter));
+  }
+}
+
+/*
+ * Read the positive test cases from one of the schema test files.
+ */
+void CompiledSchemaTest::ReadSchemas(const string &filename,
+                                     vector<string> *schemas) {
+  string file_path;
+  file_path.append(TEST_SRC_DIR);
+  file_path.push_back(ola::file::PATH_SEPARATOR);
+  file_path.append("common");
+  file_path.push_back(ola::file::PATH_SEPARATOR);
+  file_path.append("web");
+  file_path.push_back(ola::file::PATH_SEPARATOR);
+  file_path.append("testdata");
+  file_path.push_back(ola::file::PATH_SEPARATOR);
+  file_path.append(filename);
+
+  std::ifstream in(file_path.data(), std::ios::in);
+  OLA_ASSERT_TRUE_MSG(in.is_open(), file_path);
+
+  bool positive = false;
+  string schema;
+  string line;
+  while (getline(in, line)) {
+    line.erase(line.find_last_not_of("\r") + 1);
+    if (line.compare(0, 2, "//") == 0) {
+      continue;
+    } else if (line == "=== POSITIVE ===" || line == "=== NEGATIVE ===" ||
+               line == "--------") {
+      if (positive && !schema.empty()) {
+        schemas->push_back(schema);
+      }
+      schema.clear();
+      positive = (line == "=== POSITIVE ===");
+    } else {
+      schema.append(line);
+      schema.push_back('\n');
+    }
+  }
+  if (positive && !schema.empty()) {
+    schemas->push_back(schema);
+  }
+}
+
+void CompiledSchemaTest::testTypes() {
+  OLA_ASSERT_TRUE(IsValid("{}", "[1, 2]"));
+  OLA_ASSERT_TRUE(IsValid("{\"type\": \"integer\"}", "-4294967296"));
+  OLA_ASSERT_FALSE(IsValid("{\"type\": \"integer\"}", "1.5"));
+  OLA_ASSERT_TRUE(IsValid("{\"type\": \"number\"}", "1.5"));
+  OLA_ASSERT_FALSE(IsValid("{\"type\": \"number\"}", "\"1.5\""));
+
+  const string number = "{\"type\": \"number\", \"minimum\": 1, "
+      "\"maximum\": 10, \"exclusiveMaximum\": true}";
+  OLA_ASSERT_TRUE(IsValid(number, "1"));
+  OLA_ASSERT_TRUE(IsValid(number, "9.5"));
+  OLA_ASSERT_FALSE(IsValid(number, "10"));
+  OLA_ASSERT_FALSE(IsValid(number, "0.5"));
+  OLA_ASSERT_TRUE(IsValid("{\"type\": \"integer\", \"multipleOf\": 3}", "9"));
+  OLA_ASSERT_FALSE(IsValid("{\"type\": \"integer\", \"multipleOf\": 3}",
+                           "10"));
+
+  const string str = "{\"type\": \"string\", \"minLength\": 1, "
+      "\"maxLength\": 3, \"enum\": [\"foo\", \"a\", \"long\"]}";
+  OLA_ASSERT_TRUE(IsValid(str, "\"foo\""));
+  OLA_ASSERT_FALSE(IsValid(str, "\"bar\""));
+  OLA_ASSERT_FALSE(IsValid(str, "\"long\""));
+  OLA_ASSERT_FALSE(IsValid(str, "\"\""));
+
+  const string one_of = "{\"oneOf\": [{\"type\": \"integer\"}, "
+      "{\"type\": \"number\"}]}";
+  OLA_ASSERT_TRUE(IsValid(one_of, "1.5"));
+  OLA_ASSERT_FALSE(IsValid(one_of, "1"));
+  OLA_ASSERT_TRUE(IsValid("{\"not\": {\"type\": \"null\"}}", "1"));
+  OLA_ASSERT_FALSE(IsValid("{\"not\": {\"type\": \"null\"}}", "null"));
+}
+
+void CompiledSchemaTest::testObjects() {
+  const string schema =
+      "{\"type\": \"object\", \"required\": [\"name\"], "
+      "\"properties\": {\"name\": {\"type\": \"string\"}, "
+      "\"age\": {\"type\": \"integer\"}}, "
+      "\"additionalProperties\": false, "
+      "\"dependencies\": {\"age\": [\"name\"]}}";
+  OLA_ASSERT_TRUE(IsValid(schema, "{\"name\": \"simon\"}"));
+  OLA_ASSERT_TRUE(IsValid(schema, "{\"name\": \"simon\", \"age\": 3}"));
+  OLA_ASSERT_FALSE(IsValid(schema, "{\"age\": 3}"));
+  OLA_ASSERT_FALSE(IsValid(schema, "{\"name\": 1}"));
+  OLA_ASSERT_FALSE(IsValid(schema,
+                           "{\"name\": \"simon\", \"extra\": true}"));
+
+  // Nested objects each track the properties they've seen.
+  const string nested =
+      "{\"type\": \"object\", \"required\": [\"a\", \"b\"], "
+      "\"additionalProperties\": {\"type\": \"object\", "
+      "\"required\": [\"c\"]}}";
+  OLA_ASSERT_TRUE(IsValid(nested, "{\"a\": {\"c\": 1}, \"b\": {\"c\": 2}}"));
+  OLA_ASSERT_FALSE(IsValid(nested, "{\"a\": {\"c\": 1}, \"b\": {}}"));
+  OLA_ASSERT_FALSE(IsValid(nested, "{\"a\": {\"c\": 1}}"));
+
+  const string schema_dependency =
+      "{\"type\": \"object\", \"dependencies\": {\"a\": "
+      "{\"type\": \"object\", \"minProperties\": 2}}}";
+  OLA_ASSERT_TRUE(IsValid(schema_dependency, "{\"b\": 1}"));
+  OLA_ASSERT_FALSE(IsValid(schema_dependency, "{\"a\": 1}"));
+  OLA_ASSERT_TRUE(IsValid(schema_dependency, "{\"a\": 1, \"b\": 1}"));
+}
+
+void CompiledSchemaTest::testArrays() {
+  const string tuple =
+      "{\"type\": \"array\", \"items\": [{\"type\": \"integer\"}, "
+      "{\"type\": \"string\"}], \"additionalItems\": false}";
+  OLA_ASSERT_TRUE(IsValid(tuple, "[1, \"a\"]"));
+  OLA_ASSERT_TRUE(IsValid(tuple, "[1]"));
+  OLA_ASSERT_FALSE(IsValid(tuple, "[\"a\"]"));
+  OLA_ASSERT_FALSE(IsValid(tuple, "[1, \"a\", 2]"));
+
+  const string items =
+      "{\"type\": \"array\", \"items\": {\"type\": \"integer\"}, "
+      "\"minItems\": 1, \"maxItems\": 2, \"uniqueItems\": true}";
+  OLA_ASSERT_TRUE(IsValid(items, "[1, 2]"));
+  OLA_ASSERT_FALSE(IsValid(items, "[]"));
+  OLA_ASSERT_FALSE(IsValid(items, "[1, 2, 3]"));
+  OLA_ASSERT_FALSE(IsValid(items, "[1, 1]"));
+  OLA_ASSERT_FALSE(IsValid(items, "[1, \"a\"]"));
+}
+
+void CompiledSchemaTest::testReferences() {
+  const string schema =
+      "{\"definitions\": {\"count\": {\"type\": \"integer\", "
+      "\"minimum\": 0}, \"list\": {\"type\": \"array\", "
+      "\"items\": {\"$ref\": \"list\"}}}, "
+      "\"type\": \"object\", \"properties\": {"
+      "\"count\": {\"$ref\": \"count\"}, \"list\": {\"$ref\": \"list\"}, "
+      "\"missing\": {\"$ref\": \"#/definitions/missing\"}}}";
+  OLA_ASSERT_TRUE(IsValid(schema, "{\"count\": 1}"));
+  OLA_ASSERT_FALSE(IsValid(schema, "{\"count\": -1}"));
+  OLA_ASSERT_TRUE(IsValid(schema, "{\"list\": [[], [[]]]}"));
+  OLA_ASSERT_FALSE(IsValid(schema, "{\"list\": [[1]]}"));
+  OLA_ASSERT_FALSE(IsValid(schema, "{\"missing\": 1}"));
+  CheckSameResult(schema);
+}
+
+/*
+ * Compare the CompiledSchema with the JsonSchema, for every schema in the
+ * test data.
+ */
+void CompiledSchemaTest::testMatchesJsonSchema() {
+  const char *files[] = {
+    "allof.test",
+    "anyof.test",
+    "arrays.test",
+    "basic-keywords.test",
+    "definitions.test",
+    "integers.test",
+    "misc.test",
+    "not.test",
+    "objects.test",
+    "oneof.test",
+    "schema.json",
+    "strings.test",
+    "type.test",
+  };
+
+  unsigned int schema_count = 0;
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    vector<string> schemas;
+    ReadSchemas(files[i], &schemas);
+    vector<string>::const_iterator iter = schemas.begin();
+    for (; iter != schemas.end(); ++iter) {
+      CheckSameResult(*iter);
+      schema_count++;
+    }
+  }
+  OLA_ASSERT_GT(schema_count, 50u);
+
+  CheckSameResult(
+      "{\"type\": \"object\", \"maxProperties\": 0, \"minProperties\": 1}");
+  CheckSameResult(
+      "{\"type\": \"object\", \"additionalProperties\": {\"type\": "
+      "\"integer\"}, \"properties\": {\"name\": {}}}");
+  CheckSameResult(
+      "{\"type\": \"array\", \"items\": [{}], \"additionalItems\": "
+      "{\"type\": \"string\"}}");
+  CheckSameResult("{\"type\": \"string\", \"maxLength\": 0}");
+  CheckSameResult("{\"enum\": [1, \"foo\"]}");
+  CheckSameResult("{\"anyOf\": [{\"type\": \"string\"}, "
+                  "{\"type\": \"array\", \"maxItems\": 1}]}");
+}
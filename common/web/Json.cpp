@@ -640,6 +640,16 @@ bool JsonObject::Remove(const string &key) {
   return STLRemoveAndDelete(&m_members, key);
 }
 
+JsonValue* JsonObject::ReleaseValue(const string &key) {
+  MemberMap::iterator iter = m_members.find(key);
+  if (iter == m_members.end()) {
+    return NULL;
+  }
+  JsonValue *value = iter->second;
+  m_members.erase(iter);
+  return value;
+}
+
 bool JsonObject::ReplaceValue(const string &key, JsonValue *value) {
   MemberMap::iterator iter = m_members.find(key);
   if (iter == m_members.end()) {
@@ -737,6 +747,16 @@ bool JsonArray::RemoveElementAt(uint32_t index) {
   return false;
 }
 
+JsonValue* JsonArray::ReleaseElementAt(uint32_t index) {
+  if (index < m_values.size()) {
+    ValuesVector::iterator iter = m_values.begin() + index;
+    JsonValue *value = *iter;
+    m_values.erase(iter);
+    return value;
+  }
+  return NULL;
+}
+
 bool JsonArray::ReplaceElementAt(uint32_t index, JsonValue *value) {
   if (index < m_values.size()) {
     ValuesVector::iterator iter = m_values.begin() + index;
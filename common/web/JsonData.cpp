@@ -39,18 +39,17 @@ bool JsonData::SetValue(JsonValue *value) {
 }
 
 bool JsonData::Apply(const JsonPatchSet &patch) {
-  JsonValue *new_value = NULL;
-  if (m_value.get()) {
-    new_value = m_value->Clone();
-  }
-
-  // now apply the patch
-  bool ok = patch.Apply(&new_value) && IsValid(new_value);
+  // The patch is applied in place, if it fails or the result doesn't match the
+  // schema the changes are undone.
+  JsonValue *value = m_value.release();
+  JsonPatchTransaction transaction(&value);
+  bool ok = patch.Apply(&transaction) && IsValid(value);
   if (ok) {
-    m_value.reset(new_value);
+    transaction.Commit();
   } else {
-    delete new_value;
+    transaction.Rollback();
   }
+  m_value.reset(value);
   return ok;
 }
 
@@ -0,0 +1,413 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonDocument.cpp
+ * A read only JSON tree, allocated from a single arena.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonDocument.h"
+#include "ola/web/JsonLexer.h"
+
+namespace ola {
+namespace web {
+
+using std::string;
+
+namespace {
+
+JsonNode::Type ContainerType(bool is_object) {
+  return is_object ? JsonNode::OBJECT_NODE : JsonNode::ARRAY_NODE;
+}
+}  // namespace
+
+// JsonArena
+// ------------------------------------------------
+
+JsonArena::~JsonArena() {
+  std::vector<char*>::iterator iter = m_blocks.begin();
+  for (; iter != m_blocks.end(); ++iter) {
+    delete[] *iter;
+  }
+}
+
+void *JsonArena::Allocate(size_t size) {
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  if (size > m_remaining) {
+    // Large allocations get a block of their own, so we don't waste the rest
+    // of the current block.
+    if (size > BLOCK_SIZE / 4) {
+      char *block = new char[size];
+      m_blocks.push_back(block);
+      m_size += size;
+      return block;
+    }
+    m_current = new char[BLOCK_SIZE];
+    m_blocks.push_back(m_current);
+    m_size += BLOCK_SIZE;
+    m_remaining = BLOCK_SIZE;
+  }
+  void *ptr = m_current;
+  m_current += size;
+  m_remaining -= size;
+  return ptr;
+}
+
+const char *JsonArena::CopyString(const char *data, size_t length) {
+  char *str = static_cast<char*>(Allocate(length + 1));
+  memcpy(str, data, length);
+  str[length] = 0;
+  return str;
+}
+
+
+// JsonNode
+// ------------------------------------------------
+
+double JsonNode::DoubleValue() const {
+  switch (m_type) {
+    case UINT_NODE:
+      return m_value.uint_value;
+    case INT_NODE:
+      return m_value.int_value;
+    case UINT64_NODE:
+      return static_cast<double>(m_value.uint64_value);
+    case INT64_NODE:
+      return static_cast<double>(m_value.int64_value);
+    case DOUBLE_NODE:
+      return m_value.double_value->value;
+    default:
+      return 0;
+  }
+}
+
+bool JsonNode::StringEquals(const string &value) const {
+  return (m_type == STRING_NODE && value.size() == m_size &&
+          memcmp(value.data(), m_value.string_value, m_size) == 0);
+}
+
+const JsonNode *JsonNode::Lookup(const string &key) const {
+  if (m_type != OBJECT_NODE) {
+    return NULL;
+  }
+  for (uint32_t i = m_size; i > 0; i--) {
+    const JsonMember &member = m_value.members[i - 1];
+    if (member.key.StringEquals(key)) {
+      return &member.value;
+    }
+  }
+  return NULL;
+}
+
+JsonValue *JsonNode::ToJsonValue() const {
+  if (m_type == ARRAY_NODE) {
+    JsonArray *array = new JsonArray();
+    PopulateArray(array);
+    return array;
+  } else if (m_type == OBJECT_NODE) {
+    JsonObject *object = new JsonObject();
+    PopulateObject(object);
+    return object;
+  }
+  return NewScalarValue();
+}
+
+/*
+ * Nested containers are added with AppendArray() / AppendObject() and
+ * AddArray() / AddObject() so the result matches what JsonParser builds.
+ */
+void JsonNode::AddToArray(JsonArray *array) const {
+  if (m_type == ARRAY_NODE) {
+    PopulateArray(array->AppendArray());
+  } else if (m_type == OBJECT_NODE) {
+    PopulateObject(array->AppendObject());
+  } else {
+    array->Append(NewScalarValue());
+  }
+}
+
+void JsonNode::AddToObject(const string &key, JsonObject *object) const {
+  if (m_type == ARRAY_NODE) {
+    PopulateArray(object->AddArray(key));
+  } else if (m_type == OBJECT_NODE) {
+    PopulateObject(object->AddObject(key));
+  } else {
+    object->AddValue(key, NewScalarValue());
+  }
+}
+
+void JsonNode::PopulateArray(JsonArray *array) const {
+  for (uint32_t i = 0; i < m_size; i++) {
+    m_value.elements[i].AddToArray(array);
+  }
+}
+
+void JsonNode::PopulateObject(JsonObject *object) const {
+  for (uint32_t i = 0; i < m_size; i++) {
+    const JsonMember &member = m_value.members[i];
+    member.value.AddToObject(member.key.StringValue(), object);
+  }
+}
+
+JsonValue *JsonNode::NewScalarValue() const {
+  switch (m_type) {
+    case BOOL_NODE:
+      return new JsonBool(m_value.bool_value);
+    case UINT_NODE:
+      return new JsonUInt(m_value.uint_value);
+    case INT_NODE:
+      return new JsonInt(m_value.int_value);
+    case UINT64_NODE:
+      return new JsonUInt64(m_value.uint64_value);
+    case INT64_NODE:
+      return new JsonInt64(m_value.int64_value);
+    case DOUBLE_NODE:
+      if (m_value.double_value->has_representation) {
+        return new JsonDouble(m_value.double_value->representation);
+      }
+      return new JsonDouble(m_value.double_value->value);
+    case STRING_NODE:
+      return new JsonString(StringValue());
+    default:
+      return new JsonNull();
+  }
+}
+
+
+// JsonDocument
+// ------------------------------------------------
+
+JsonDocument::JsonDocument()
+    : JsonParserInterface(),
+      m_input(NULL),
+      m_input_size(0),
+      m_parsed(false) {
+  m_root.m_type = JsonNode::NULL_NODE;
+  m_root.m_size = 0;
+  m_root.m_value.uint64_value = 0;
+}
+
+bool JsonDocument::Parse(const string &input, string *error) {
+  if (m_parsed) {
+    *error = "Document has already been parsed";
+    return false;
+  }
+  m_parsed = true;
+
+  // Copy the input once, strings without escapes will point into the copy.
+  m_input = m_arena.CopyString(input.data(), input.size());
+  m_input_size = input.size();
+
+  if (JsonLexer::Parse(m_input, this) && m_error.empty()) {
+    return true;
+  }
+  *error = m_error;
+  m_root.m_type = JsonNode::NULL_NODE;
+  m_root.m_size = 0;
+  return false;
+}
+
+void JsonDocument::Begin() {
+  m_error.clear();
+  m_pending.clear();
+  m_containers.clear();
+}
+
+void JsonDocument::End() {
+  if (!m_containers.empty()) {
+    OLA_WARN << "Json container stack is not empty";
+  }
+}
+
+void JsonDocument::String(const string &value) {
+  StringView(value.data(), value.size());
+}
+
+void JsonDocument::StringView(const char *data, size_t length) {
+  AddNode(MakeString(data, length));
+}
+
+void JsonDocument::Number(uint32_t value) {
+  JsonNode node;
+  node.m_type = JsonNode::UINT_NODE;
+  node.m_size = 0;
+  node.m_value.uint_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Number(int32_t value) {
+  JsonNode node;
+  node.m_type = JsonNode::INT_NODE;
+  node.m_size = 0;
+  node.m_value.int_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Number(uint64_t value) {
+  JsonNode node;
+  node.m_type = JsonNode::UINT64_NODE;
+  node.m_size = 0;
+  node.m_value.uint64_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Number(int64_t value) {
+  JsonNode node;
+  node.m_type = JsonNode::INT64_NODE;
+  node.m_size = 0;
+  node.m_value.int64_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Number(const JsonDouble::DoubleRepresentation &rep) {
+  JsonNode::Double *value = static_cast<JsonNode::Double*>(
+      m_arena.Allocate(sizeof(JsonNode::Double)));
+  JsonDouble::AsDouble(rep, &value->value);
+  value->has_representation = true;
+  value->representation = rep;
+
+  JsonNode node;
+  node.m_type = JsonNode::DOUBLE_NODE;
+  node.m_size = 0;
+  node.m_value.double_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Number(double d) {
+  JsonNode::Double *value = static_cast<JsonNode::Double*>(
+      m_arena.Allocate(sizeof(JsonNode::Double)));
+  value->value = d;
+  value->has_representation = false;
+
+  JsonNode node;
+  node.m_type = JsonNode::DOUBLE_NODE;
+  node.m_size = 0;
+  node.m_value.double_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Bool(bool value) {
+  JsonNode node;
+  node.m_type = JsonNode::BOOL_NODE;
+  node.m_size = 0;
+  node.m_value.uint64_value = 0;
+  node.m_value.bool_value = value;
+  AddNode(node);
+}
+
+void JsonDocument::Null() {
+  JsonNode node;
+  node.m_type = JsonNode::NULL_NODE;
+  node.m_size = 0;
+  node.m_value.uint64_value = 0;
+  AddNode(node);
+}
+
+void JsonDocument::OpenArray() {
+  Container container = {false, m_pending.size()};
+  m_containers.push_back(container);
+}
+
+void JsonDocument::CloseArray() {
+  CloseContainer(false);
+}
+
+void JsonDocument::OpenObject() {
+  Container container = {true, m_pending.size()};
+  m_containers.push_back(container);
+}
+
+void JsonDocument::ObjectKey(const string &key) {
+  ObjectKeyView(key.data(), key.size());
+}
+
+void JsonDocument::ObjectKeyView(const char *data, size_t length) {
+  m_pending.push_back(MakeString(data, length));
+}
+
+void JsonDocument::CloseObject() {
+  CloseContainer(true);
+}
+
+void JsonDocument::SetError(const string &error) {
+  m_error = error;
+}
+
+void JsonDocument::AddNode(const JsonNode &node) {
+  if (m_containers.empty()) {
+    m_root = node;
+  } else {
+    m_pending.push_back(node);
+  }
+}
+
+/*
+ * Create a string node. If the data isn't part of the input, it points to
+ * the lexer's scratch buffer, so it needs to be copied.
+ */
+JsonNode JsonDocument::MakeString(const char *data, size_t length) {
+  JsonNode node;
+  node.m_type = JsonNode::STRING_NODE;
+  node.m_size = length;
+  if (data >= m_input && data + length <= m_input + m_input_size) {
+    node.m_value.string_value = data;
+  } else {
+    node.m_value.string_value = m_arena.CopyString(data, length);
+  }
+  return node;
+}
+
+/*
+ * Move the children of the innermost container into the arena, and add the
+ * container to its parent.
+ */
+void JsonDocument::CloseContainer(bool is_object) {
+  if (m_containers.empty() || m_containers.back().is_object != is_object) {
+    OLA_WARN << "Mismatched Close" << (is_object ? "Object" : "Array")
+             << "()";
+    m_error = "Internal error";
+    return;
+  }
+
+  size_t start = m_containers.back().start;
+  m_containers.pop_back();
+  size_t count = m_pending.size() - start;
+
+  JsonNode node;
+  node.m_type = ContainerType(is_object);
+  node.m_size = is_object ? count / 2 : count;
+  node.m_value.elements = NULL;
+  if (count) {
+    JsonNode *children = static_cast<JsonNode*>(
+        m_arena.Allocate(count * sizeof(JsonNode)));
+    memcpy(children, &m_pending[start], count * sizeof(JsonNode));
+    if (is_object) {
+      // Keys and values alternate, which is the layout of JsonMember.
+      node.m_value.members = reinterpret_cast<const JsonMember*>(children);
+    } else {
+      node.m_value.elements = children;
+    }
+    m_pending.resize(start);
+  }
+  AddNode(node);
+}
+}  // namespace web
+}  // namespace ola
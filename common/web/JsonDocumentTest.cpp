@@ -0,0 +1,246 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonDocumentTest.cpp
+ * Unittest for the JsonDocument.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/StringUtils.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonDocument.h"
+#include "ola/web/JsonParser.h"
+#include "ola/web/JsonWriter.h"
+
+using ola::web::JsonDocument;
+using ola::web::JsonMember;
+using ola::web::JsonNode;
+using ola::web::JsonParser;
+using ola::web::JsonValue;
+using ola::web::JsonWriter;
+using std::auto_ptr;
+using std::string;
+
+class JsonDocumentTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(JsonDocumentTest);
+  CPPUNIT_TEST(testScalars);
+  CPPUNIT_TEST(testStrings);
+  CPPUNIT_TEST(testContainers);
+  CPPUNIT_TEST(testToJsonValue);
+  CPPUNIT_TEST(testLargeDocument);
+  CPPUNIT_TEST(testErrors);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testScalars();
+  void testStrings();
+  void testContainers();
+  void testToJsonValue();
+  void testLargeDocument();
+  void testErrors();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonDocumentTest);
+
+
+/*
+ * Check the scalar values.
+ */
+void JsonDocumentTest::testScalars() {
+  string error;
+  JsonDocument document;
+  OLA_ASSERT_TRUE(document.Parse(
+      "[null, true, false, 1, -1, 4294967296, -4294967296, 1.5, \"foo\"]",
+      &error));
+
+  const JsonNode &root = document.Root();
+  OLA_ASSERT_EQ(JsonNode::ARRAY_NODE, root.GetType());
+  OLA_ASSERT_EQ(9u, root.Size());
+  OLA_ASSERT_TRUE(root.ElementAt(0).IsNull());
+  OLA_ASSERT_EQ(JsonNode::BOOL_NODE, root.ElementAt(1).GetType());
+  OLA_ASSERT_TRUE(root.ElementAt(1).BoolValue());
+  OLA_ASSERT_FALSE(root.ElementAt(2).BoolValue());
+  OLA_ASSERT_EQ(JsonNode::UINT_NODE, root.ElementAt(3).GetType());
+  OLA_ASSERT_EQ(1u, root.ElementAt(3).UIntValue());
+  OLA_ASSERT_EQ(JsonNode::INT_NODE, root.ElementAt(4).GetType());
+  OLA_ASSERT_EQ(-1, root.ElementAt(4).IntValue());
+  OLA_ASSERT_EQ(JsonNode::UINT64_NODE, root.ElementAt(5).GetType());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4294967296ull),
+                root.ElementAt(5).UInt64Value());
+  OLA_ASSERT_EQ(JsonNode::INT64_NODE, root.ElementAt(6).GetType());
+  OLA_ASSERT_EQ(static_cast<int64_t>(-4294967296ll),
+                root.ElementAt(6).Int64Value());
+  OLA_ASSERT_EQ(JsonNode::DOUBLE_NODE, root.ElementAt(7).GetType());
+  OLA_ASSERT_EQ(1.5, root.ElementAt(7).DoubleValue());
+  OLA_ASSERT_EQ(-1.0, root.ElementAt(4).DoubleValue());
+  OLA_ASSERT_TRUE(root.ElementAt(8).IsString());
+  OLA_ASSERT_EQ(string("foo"), root.ElementAt(8).StringValue());
+
+  // A bare value is also valid.
+  JsonDocument scalar;
+  OLA_ASSERT_TRUE(scalar.Parse(" 42 ", &error));
+  OLA_ASSERT_EQ(42u, scalar.Root().UIntValue());
+}
+
+
+/*
+ * Check strings, with and without escapes.
+ */
+void JsonDocumentTest::testStrings() {
+  string error;
+  JsonDocument document;
+  OLA_ASSERT_TRUE(document.Parse(
+      "[\"\", \"plain\", \"a\\\"b\", \"tab\\there\", \"\\\\\"]", &error));
+
+  const JsonNode &root = document.Root();
+  OLA_ASSERT_EQ(5u, root.Size());
+  OLA_ASSERT_EQ(0u, root.ElementAt(0).StringSize());
+  OLA_ASSERT_EQ(string("plain"), root.ElementAt(1).StringValue());
+  OLA_ASSERT_TRUE(root.ElementAt(1).StringEquals("plain"));
+  OLA_ASSERT_FALSE(root.ElementAt(1).StringEquals("plai"));
+  OLA_ASSERT_EQ(string("a\"b"), root.ElementAt(2).StringValue());
+  OLA_ASSERT_EQ(string("tab\there"), root.ElementAt(3).StringValue());
+  OLA_ASSERT_EQ(string("\\"), root.ElementAt(4).StringValue());
+}
+
+
+/*
+ * Check arrays and objects.
+ */
+void JsonDocumentTest::testContainers() {
+  string error;
+  JsonDocument document;
+  OLA_ASSERT_TRUE(document.Parse(
+      "{\"name\": \"simon\", \"pets\": [{\"name\": \"rover\"}, []],"
+      " \"empty\": {}, \"name\": \"simon2\"}",
+      &error));
+
+  const JsonNode &root = document.Root();
+  OLA_ASSERT_TRUE(root.IsObject());
+  OLA_ASSERT_EQ(4u, root.Size());
+
+  // Members are in the order they appeared.
+  const JsonMember &first = root.MemberAt(0);
+  OLA_ASSERT_EQ(string("name"), first.key.StringValue());
+  OLA_ASSERT_EQ(string("simon"), first.value.StringValue());
+
+  // Lookup returns the last match.
+  const JsonNode *name = root.Lookup("name");
+  OLA_ASSERT_NOT_NULL(name);
+  OLA_ASSERT_EQ(string("simon2"), name->StringValue());
+  OLA_ASSERT_NULL(root.Lookup("age"));
+  OLA_ASSERT_NULL(first.value.Lookup("name"));
+
+  const JsonNode *pets = root.Lookup("pets");
+  OLA_ASSERT_NOT_NULL(pets);
+  OLA_ASSERT_TRUE(pets->IsArray());
+  OLA_ASSERT_EQ(2u, pets->Size());
+  const JsonNode *pet_name = pets->ElementAt(0).Lookup("name");
+  OLA_ASSERT_NOT_NULL(pet_name);
+  OLA_ASSERT_EQ(string("rover"), pet_name->StringValue());
+  OLA_ASSERT_TRUE(pets->ElementAt(1).IsArray());
+  OLA_ASSERT_EQ(0u, pets->ElementAt(1).Size());
+
+  const JsonNode *empty = root.Lookup("empty");
+  OLA_ASSERT_NOT_NULL(empty);
+  OLA_ASSERT_TRUE(empty->IsObject());
+  OLA_ASSERT_EQ(0u, empty->Size());
+}
+
+
+/*
+ * Check that converting to JsonValues matches the output of the JsonParser.
+ */
+void JsonDocumentTest::testToJsonValue() {
+  const string input =
+      "{\"age\": 10, \"lucky numbers\": [2, 5, -1.25e2, 1.5], "
+      "\"name\": \"si\\\"mon\", \"pets\": [{\"name\": \"rover\", "
+      "\"tags\": []}, {}], \"big\": 18446744073709551615, "
+      "\"alive\": true, \"spouse\": null}";
+
+  string error;
+  auto_ptr<JsonValue> expected(JsonParser::Parse(input, &error));
+  OLA_ASSERT_NOT_NULL(expected.get());
+
+  JsonDocument document;
+  OLA_ASSERT_TRUE(document.Parse(input, &error));
+  auto_ptr<JsonValue> value(document.Root().ToJsonValue());
+  OLA_ASSERT_NOT_NULL(value.get());
+  OLA_ASSERT_TRUE(*expected == *value);
+  OLA_ASSERT_EQ(JsonWriter::AsString(*expected),
+                JsonWriter::AsString(*value));
+}
+
+
+/*
+ * Check a document that spans more than one arena block.
+ */
+void JsonDocumentTest::testLargeDocument() {
+  string input = "[";
+  for (unsigned int i = 0; i < 5000; i++) {
+    if (i) {
+      input.append(", ");
+    }
+    input.append("{\"id\": ");
+    input.append(ola::IntToString(i));
+    input.append(", \"label\": \"port\\t");
+    input.append(ola::IntToString(i));
+    input.append("\"}");
+  }
+  input.append("]");
+
+  string error;
+  JsonDocument document;
+  OLA_ASSERT_TRUE(document.Parse(input, &error));
+  OLA_ASSERT_GT(document.ArenaSize(), input.size());
+
+  const JsonNode &root = document.Root();
+  OLA_ASSERT_EQ(5000u, root.Size());
+  for (unsigned int i = 0; i < root.Size(); i++) {
+    const JsonNode *id = root.ElementAt(i).Lookup("id");
+    OLA_ASSERT_NOT_NULL(id);
+    OLA_ASSERT_EQ(i, id->UIntValue());
+    const JsonNode *label = root.ElementAt(i).Lookup("label");
+    OLA_ASSERT_NOT_NULL(label);
+    OLA_ASSERT_EQ("port\t" + ola::IntToString(i), label->StringValue());
+  }
+}
+
+
+/*
+ * Check invalid input.
+ */
+void JsonDocumentTest::testErrors() {
+  string error;
+  JsonDocument document;
+  OLA_ASSERT_FALSE(document.Parse("[1, 2", &error));
+  OLA_ASSERT_FALSE(error.empty());
+  OLA_ASSERT_TRUE(document.Root().IsNull());
+
+  JsonDocument unterminated;
+  OLA_ASSERT_FALSE(unterminated.Parse("{\"foo", &error));
+
+  JsonDocument empty;
+  OLA_ASSERT_FALSE(empty.Parse("", &error));
+
+  JsonDocument twice;
+  OLA_ASSERT_TRUE(twice.Parse("[]", &error));
+  OLA_ASSERT_FALSE(twice.Parse("[]", &error));
+}
@@ -64,25 +64,42 @@ static bool TrimWhitespace(const char **input) {
  * @brief Extract a string token from the input.
  * @param input A pointer to a pointer with the data. This should point to the
  * first character after the quote (") character.
- * @param str A string object to store the extracted string.
+ * @param data set to the start of the extracted string.
+ * @param length set to the length of the extracted string.
+ * @param scratch a buffer for strings that contain escape sequences.
  * @param parser the JsonParserInterface to pass tokens to.
  * @returns true if the string was extracted correctly, false otherwise.
+ *
+ * If the string doesn't contain any escape sequences, data points into the
+ * input, otherwise the unescaped string is built in scratch.
  */
-static bool ParseString(const char **input, string* str,
+static bool ParseString(const char **input, const char **data,
+                        size_t *length, string *scratch,
                         JsonParserInterface *parser) {
+  scratch->clear();
+  const char *start = *input;
   while (true) {
     size_t size = strcspn(*input, "\"\\");
     char c = (*input)[size];
     if (c == 0) {
       parser->SetError("Unterminated string");
-      str->clear();
       return false;
     }
 
-    str->append(*input, size);
+    if (c == '"' && *input == start) {
+      // The common case, no escape sequences.
+      *data = start;
+      *length = size;
+      *input += size + 1;
+      return true;
+    }
+
+    scratch->append(*input, size);
     *input += size + 1;
 
     if (c == '"') {
+      *data = scratch->data();
+      *length = scratch->size();
       return true;
     }
 
@@ -120,7 +137,7 @@ static bool ParseString(const char **input, string* str,
           parser->SetError("Invalid string escape sequence");
           return false;
       }
-      str->push_back(append_char);
+      scratch->push_back(append_char);
       (*input)++;
     }
   }
@@ -327,11 +344,13 @@ static bool ParseObject(const char **input, JsonParserInterface *parser) {
     }
     (*input)++;
 
-    string key;
-    if (!ParseString(input, &key, parser)) {
+    const char *key;
+    size_t key_length;
+    string scratch;
+    if (!ParseString(input, &key, &key_length, &scratch, parser)) {
       return false;
     }
-    parser->ObjectKey(key);
+    parser->ObjectKeyView(key, key_length);
 
     if (!TrimWhitespace(input)) {
       parser->SetError("Missing : after key");
@@ -382,9 +401,11 @@ static bool ParseTrimmedInput(const char **input,
 
   if (**input == '"') {
     (*input)++;
-    string str;
-    if (ParseString(input, &str, parser)) {
-      parser->String(str);
+    const char *str;
+    size_t length;
+    string scratch;
+    if (ParseString(input, &str, &length, &scratch, parser)) {
+      parser->StringView(str, length);
       return true;
     }
     return false;
@@ -433,13 +454,12 @@ bool JsonLexer::Parse(const string &input,
                       JsonParserInterface *parser) {
   // TODO(simon): Do we need to convert to unicode here? I think this may be
   // an issue on Windows. Consider mbstowcs.
-  // Copying the input sucks though, so we should use input.c_str() if we can.
-  char* input_data = new char[input.size() + 1];
-  strncpy(input_data, input.c_str(), input.size() + 1);
+  // c_str() is NULL terminated, so the lexer can run over it directly.
+  return ParseRaw(input.c_str(), parser);
+}
 
-  bool result = ParseRaw(input_data, parser);
-  delete[] input_data;
-  return result;
+bool JsonLexer::Parse(const char *input, JsonParserInterface *parser) {
+  return ParseRaw(input, parser);
 }
 }  // namespace web
 }  // namespace ola
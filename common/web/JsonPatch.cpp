@@ -19,6 +19,7 @@
  */
 #include "ola/web/JsonPatch.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -35,40 +36,39 @@ using std::string;
 
 namespace {
 
-string LastToken(const JsonPointer &pointer) {
-  return pointer.TokenAt(pointer.TokenCount() - 2);
-}
-
-JsonValue *GetParent(JsonValue *value, const JsonPointer &pointer) {
-  JsonPointer parent_pointer(pointer);
-  parent_pointer.Pop();
-  return value->LookupElement(parent_pointer);
-}
-
 /**
  * Most ops have an if-object-then, else-if-array-then clause. This puts all
  * the grunt work in a single method
  */
 class ObjectOrArrayAction {
  public:
+  explicit ObjectOrArrayAction(JsonPatchTransaction *transaction)
+      : m_transaction(transaction) {
+  }
   virtual ~ObjectOrArrayAction() {}
 
-  bool TakeActionOn(JsonValue *value, const JsonPointer &target);
+  bool TakeActionOn(const JsonPatchPath &target);
 
   // Implement these with the specific actions
   virtual bool Object(JsonObject *object, const string &key) = 0;
   virtual bool ArrayIndex(JsonArray *array, uint32_t index) = 0;
   // Called when the index is '-'
   virtual bool ArrayLast(JsonArray *array) = 0;
+
+ protected:
+  JsonPatchTransaction *m_transaction;
 };
 
-bool ObjectOrArrayAction::TakeActionOn(JsonValue *value,
-                                       const JsonPointer &target) {
-  JsonValue *parent = GetParent(value, target);
+bool ObjectOrArrayAction::TakeActionOn(const JsonPatchPath &target) {
+  JsonValue *root = m_transaction->Root();
+  if (!root) {
+    return false;
+  }
+  JsonValue *parent = root->LookupElement(target.Parent());
   if (!parent) {
     return false;
   }
-  const string key = LastToken(target);
+  const string &key = target.Key();
 
   JsonObject *object = ObjectCast(parent);
   if (object) {
@@ -92,223 +92,389 @@ bool ObjectOrArrayAction::TakeActionOn(JsonValue *value,
 
 class AddAction : public ObjectOrArrayAction {
  public:
-  explicit AddAction(const JsonValue *value_to_clone)
-      : m_value(value_to_clone) {}
+  AddAction(JsonPatchTransaction *transaction, JsonValue *value)
+      : ObjectOrArrayAction(transaction),
+        m_value(value) {}
 
   bool Object(JsonObject *object, const string &key) {
-    object->AddValue(key, m_value->Clone());
+    m_transaction->SetMember(object, key, m_value);
     return true;
   }
 
   bool ArrayIndex(JsonArray *array, uint32_t index) {
-    return array->InsertElementAt(index, m_value->Clone());
+    return (index < array->Size() &&
+            m_transaction->InsertElement(array, index, m_value));
   }
 
   bool ArrayLast(JsonArray *array) {
-    array->AppendValue(m_value->Clone());
-    return true;
+    return m_transaction->InsertElement(array, array->Size(), m_value);
   }
 
  private:
-  const JsonValue *m_value;
+  JsonValue *m_value;
 };
 
 class RemoveAction : public ObjectOrArrayAction {
  public:
+  explicit RemoveAction(JsonPatchTransaction *transaction)
+      : ObjectOrArrayAction(transaction),
+        m_removed(NULL) {
+  }
+
   bool Object(JsonObject *object, const string &key) {
-    return object->Remove(key);
+    m_removed = m_transaction->RemoveMember(object, key);
+    return m_removed != NULL;
   }
 
   bool ArrayIndex(JsonArray *array, uint32_t index) {
-    return array->RemoveElementAt(index);
+    m_removed = m_transaction->RemoveElement(array, index);
+    return m_removed != NULL;
   }
 
   bool ArrayLast(JsonArray *array) {
     if (array->IsEmpty()) {
       return false;
     }
-
-    array->RemoveElementAt(array->Size() - 1);
-    return true;
+    return ArrayIndex(array, array->Size() - 1);
   }
+
+  // The value that was removed, it's owned by the transaction.
+  JsonValue *Removed() const { return m_removed; }
+
+ private:
+  JsonValue *m_removed;
 };
 
 class ReplaceAction : public ObjectOrArrayAction {
  public:
-  explicit ReplaceAction(const JsonValue *value) : m_value(value) {}
+  ReplaceAction(JsonPatchTransaction *transaction, JsonValue *value)
+      : ObjectOrArrayAction(transaction),
+        m_value(value) {
+  }
 
   bool Object(JsonObject *object, const string &key) {
-    return object->ReplaceValue(key, m_value->Clone());
+    return m_transaction->ReplaceMember(object, key, m_value);
   }
 
   bool ArrayIndex(JsonArray *array, uint32_t index) {
-    return array->ReplaceElementAt(index, m_value->Clone());
+    return m_transaction->ReplaceElement(array, index, m_value);
   }
 
   bool ArrayLast(JsonArray *array) {
     if (array->IsEmpty()) {
       return false;
     }
-
-    array->ReplaceElementAt(array->Size() - 1, m_value->Clone());
-    return true;
+    return ArrayIndex(array, array->Size() - 1);
   }
+
  private:
-  const JsonValue *m_value;
+  JsonValue *m_value;
 };
 
-bool AddOp(const JsonPointer &target, JsonValue **root,
-           const JsonValue *value_to_clone) {
-  if (!target.IsValid()) {
-    return false;
-  }
-
-  if (target.TokenCount() == 1) {
+/*
+ * Add a value, ownership of the value is transferred if this returns true.
+ */
+bool AddValue(const JsonPatchPath &target, JsonPatchTransaction *transaction,
+              JsonValue *value) {
+  if (target.IsRoot()) {
     // Add also operates as replace as per the spec.
-    // Make a copy before we delete, since the value_to_clone may be within the
-    // root.
-    JsonValue *new_value = value_to_clone ? value_to_clone->Clone() : NULL;
-    if (*root) {
-      delete *root;
-    }
-    *root = new_value;
+    transaction->SetRoot(value);
     return true;
   }
 
   // If we're not operating on the root, NULLs aren't allowed.
-  if (*root == NULL || value_to_clone == NULL) {
+  if (value == NULL) {
+    return false;
+  }
+
+  AddAction action(transaction, value);
+  return action.TakeActionOn(target);
+}
+
+bool AddOp(const JsonPatchPath &target, JsonPatchTransaction *transaction,
+           const JsonValue *value_to_clone) {
+  if (!target.IsValid()) {
     return false;
   }
 
-  AddAction action(value_to_clone);
-  return action.TakeActionOn(*root, target);
+  // The value_to_clone may be within the root, but it isn't deleted until the
+  // transaction is committed.
+  JsonValue *new_value = value_to_clone ? value_to_clone->Clone() : NULL;
+  if (!AddValue(target, transaction, new_value)) {
+    delete new_value;
+    return false;
+  }
+  return true;
+}
+
+void InsertOrAppend(JsonArray *array, uint32_t index, JsonValue *value) {
+  if (index == array->Size()) {
+    array->AppendValue(value);
+  } else {
+    array->InsertElementAt(index, value);
+  }
 }
 
+// Tracks whether a value is part of the document, before & after the changes.
+struct Presence {
+  Presence() : before(0), after(0) {}
+  int before;
+  int after;
+};
 }  // namespace
 
-bool JsonPatchAddOp::Apply(JsonValue **value) const {
-  return AddOp(m_pointer, value, m_value.get());
+JsonPatchPath::JsonPatchPath(const JsonPointer &pointer)
+    : m_pointer(pointer),
+      m_parent(pointer) {
+  if (!IsRoot()) {
+    m_key = m_pointer.TokenAt(m_pointer.TokenCount() - 2);
+    m_parent.Pop();
+  }
+}
+
+JsonPatchTransaction::JsonPatchTransaction(JsonValue **root)
+    : m_root(root) {
+}
+
+JsonPatchTransaction::~JsonPatchTransaction() {
+  Rollback();
+}
+
+void JsonPatchTransaction::Commit() {
+  Finish(true);
+}
+
+void JsonPatchTransaction::Rollback() {
+  Changes::reverse_iterator iter = m_changes.rbegin();
+  for (; iter != m_changes.rend(); ++iter) {
+    Undo(*iter);
+  }
+  Finish(false);
+}
+
+void JsonPatchTransaction::SetRoot(JsonValue *value) {
+  Change change = {NULL, NULL, "", 0, *m_root, value};
+  m_changes.push_back(change);
+  *m_root = value;
 }
 
-bool JsonPatchRemoveOp::Apply(JsonValue **value) const {
-  if (!m_pointer.IsValid()) {
+void JsonPatchTransaction::SetMember(JsonObject *object, const string &key,
+                                     JsonValue *value) {
+  Change change = {object, NULL, key, 0, object->ReleaseValue(key), value};
+  m_changes.push_back(change);
+  object->AddValue(key, value);
+}
+
+bool JsonPatchTransaction::ReplaceMember(JsonObject *object, const string &key,
+                                         JsonValue *value) {
+  JsonValue *old_value = object->ReleaseValue(key);
+  if (!old_value) {
     return false;
   }
+  Change change = {object, NULL, key, 0, old_value, value};
+  m_changes.push_back(change);
+  object->AddValue(key, value);
+  return true;
+}
 
-  if (m_pointer.TokenCount() == 1) {
-    delete *value;
-    *value = NULL;
-    return true;
+JsonValue *JsonPatchTransaction::RemoveMember(JsonObject *object,
+                                              const string &key) {
+  JsonValue *old_value = object->ReleaseValue(key);
+  if (old_value) {
+    Change change = {object, NULL, key, 0, old_value, NULL};
+    m_changes.push_back(change);
   }
+  return old_value;
+}
 
-  if (*value == NULL) {
+bool JsonPatchTransaction::InsertElement(JsonArray *array, uint32_t index,
+                                         JsonValue *value) {
+  if (index > array->Size()) {
     return false;
   }
-
-  RemoveAction action;
-  return action.TakeActionOn(*value, m_pointer);
+  Change change = {NULL, array, "", index, NULL, value};
+  m_changes.push_back(change);
+  InsertOrAppend(array, index, value);
+  return true;
 }
 
-bool JsonPatchReplaceOp::Apply(JsonValue **value) const {
-  if (!m_pointer.IsValid()) {
+bool JsonPatchTransaction::ReplaceElement(JsonArray *array, uint32_t index,
+                                          JsonValue *value) {
+  JsonValue *old_value = array->ReleaseElementAt(index);
+  if (!old_value) {
     return false;
   }
+  Change change = {NULL, array, "", index, old_value, value};
+  m_changes.push_back(change);
+  InsertOrAppend(array, index, value);
+  return true;
+}
 
-  if (m_pointer.TokenCount() == 1) {
-    delete *value;
-    *value = m_value.get() ? m_value->Clone() : NULL;
-    return true;
+JsonValue *JsonPatchTransaction::RemoveElement(JsonArray *array,
+                                               uint32_t index) {
+  JsonValue *old_value = array->ReleaseElementAt(index);
+  if (old_value) {
+    Change change = {NULL, array, "", index, old_value, NULL};
+    m_changes.push_back(change);
   }
+  return old_value;
+}
 
-  // If we're not operating on the root, NULLs aren't allowed.
-  if (*value == NULL || m_value.get() == NULL) {
-    return false;
+void JsonPatchTransaction::Undo(const Change &change) {
+  if (change.object) {
+    if (change.inserted) {
+      change.object->ReleaseValue(change.key);
+    }
+    if (change.removed) {
+      change.object->AddValue(change.key, change.removed);
+    }
+  } else if (change.array) {
+    if (change.inserted) {
+      change.array->ReleaseElementAt(change.index);
+    }
+    if (change.removed) {
+      InsertOrAppend(change.array, change.index, change.removed);
+    }
+  } else {
+    *m_root = change.removed;
+  }
+}
+
+/*
+ * Delete the values that are no longer part of the document.
+ *
+ * A value may be removed & added again, by a move, so work out if each value
+ * was in the document to start with, and if it is now.
+ */
+void JsonPatchTransaction::Finish(bool committed) {
+  typedef std::map<JsonValue*, Presence> PresenceMap;
+  PresenceMap values;
+
+  Changes::const_iterator iter = m_changes.begin();
+  for (; iter != m_changes.end(); ++iter) {
+    if (iter->removed) {
+      PresenceMap::iterator value = values.find(iter->removed);
+      if (value == values.end()) {
+        // The first change was a removal, so it was in the document.
+        value = values.insert(
+            PresenceMap::value_type(iter->removed, Presence())).first;
+        value->second.before = value->second.after = 1;
+      }
+      value->second.after--;
+    }
+    if (iter->inserted) {
+      values[iter->inserted].after++;
+    }
+  }
+  m_changes.clear();
+
+  PresenceMap::iterator value = values.begin();
+  for (; value != values.end(); ++value) {
+    if ((committed ? value->second.after : value->second.before) == 0) {
+      delete value->first;
+    }
   }
+}
 
-  ReplaceAction action(m_value.get());
-  return action.TakeActionOn(*value, m_pointer);
+bool JsonPatchAddOp::Apply(JsonPatchTransaction *transaction) const {
+  return AddOp(m_path, transaction, m_value.get());
 }
 
-bool JsonPatchMoveOp::Apply(JsonValue **value) const {
-  if (!m_to.IsValid() || !m_from.IsValid()) {
+bool JsonPatchRemoveOp::Apply(JsonPatchTransaction *transaction) const {
+  if (!m_path.IsValid()) {
     return false;
   }
 
-  if (m_from == m_to) {
+  if (m_path.IsRoot()) {
+    transaction->SetRoot(NULL);
     return true;
   }
 
-  if (m_from.IsPrefixOf(m_to)) {
+  RemoveAction action(transaction);
+  return action.TakeActionOn(m_path);
+}
+
+bool JsonPatchReplaceOp::Apply(JsonPatchTransaction *transaction) const {
+  if (!m_path.IsValid()) {
     return false;
   }
 
-  JsonValue *src_parent = GetParent(*value, m_from);
-  if (!src_parent) {
+  if (m_path.IsRoot()) {
+    transaction->SetRoot(m_value.get() ? m_value->Clone() : NULL);
+    return true;
+  }
+
+  // If we're not operating on the root, NULLs aren't allowed.
+  if (m_value.get() == NULL) {
     return false;
   }
 
-  const string last_token = LastToken(m_from);
-  JsonPointer child_ptr("/" + last_token);
-  JsonValue *source = src_parent->LookupElement(child_ptr);
-  if (!source) {
+  JsonValue *new_value = m_value->Clone();
+  ReplaceAction action(transaction, new_value);
+  if (!action.TakeActionOn(m_path)) {
+    delete new_value;
     return false;
   }
+  return true;
+}
 
-  if (!AddOp(m_to, value, source)) {
+bool JsonPatchMoveOp::Apply(JsonPatchTransaction *transaction) const {
+  if (!m_to.IsValid() || !m_from.IsValid()) {
     return false;
   }
 
-  if (m_to.IsPrefixOf(m_from)) {
-    // At this point the original has already been destroyed during the Add
+  if (m_from.Pointer() == m_to.Pointer()) {
     return true;
   }
 
-  RemoveAction action;
-  if (!action.TakeActionOn(src_parent, child_ptr)) {
-    OLA_WARN << "Remove-after-move returned false!";
+  if (m_from.Pointer().IsPrefixOf(m_to.Pointer())) {
+    return false;
   }
-  return true;
+
+  // As per the spec, this is a remove followed by an add of the same value.
+  // The value is detached rather than copied, so the cost doesn't depend on
+  // its size.
+  RemoveAction remove(transaction);
+  if (!remove.TakeActionOn(m_from)) {
+    return false;
+  }
+  return AddValue(m_to, transaction, remove.Removed());
 }
 
-bool JsonPatchCopyOp::Apply(JsonValue **value) const {
+bool JsonPatchCopyOp::Apply(JsonPatchTransaction *transaction) const {
   if (!m_to.IsValid() || !m_from.IsValid()) {
     return false;
   }
 
-  if (m_from == m_to) {
+  if (m_from.Pointer() == m_to.Pointer()) {
     return true;
   }
 
-  if (*value == NULL) {
+  JsonValue *root = transaction->Root();
+  if (root == NULL) {
     return false;
   }
 
-  JsonValue *src_parent = GetParent(*value, m_from);
-  if (!src_parent) {
-    return false;
-  }
-
-  const string last_token = LastToken(m_from);
-  JsonPointer child_ptr("/" + last_token);
-  JsonValue *source = src_parent->LookupElement(child_ptr);
+  JsonValue *source = root->LookupElement(m_from.Pointer());
   if (!source) {
     return false;
   }
 
-  return AddOp(m_to, value, source);
+  return AddOp(m_to, transaction, source);
 }
 
-bool JsonPatchTestOp::Apply(JsonValue **value) const {
-  if (!m_pointer.IsValid()) {
+bool JsonPatchTestOp::Apply(JsonPatchTransaction *transaction) const {
+  if (!m_path.IsValid()) {
     return false;
   }
 
-  if (*value == NULL) {
-    return m_pointer.TokenCount() == 1 && m_value.get() == NULL;
+  JsonValue *root = transaction->Root();
+  if (root == NULL) {
+    return m_path.IsRoot() && m_value.get() == NULL;
   }
 
-  JsonValue *target = (*value)->LookupElement(m_pointer);
-  if (!target) {
+  JsonValue *target = root->LookupElement(m_path.Pointer());
+  if (!target || !m_value.get()) {
     return false;
   }
   return *target == *m_value.get();
@@ -323,9 +489,19 @@ void JsonPatchSet::AddOp(JsonPatchOp *op) {
 }
 
 bool JsonPatchSet::Apply(JsonValue **value) const {
+  JsonPatchTransaction transaction(value);
+  if (!Apply(&transaction)) {
+    transaction.Rollback();
+    return false;
+  }
+  transaction.Commit();
+  return true;
+}
+
+bool JsonPatchSet::Apply(JsonPatchTransaction *transaction) const {
   PatchOps::const_iterator iter = m_patch_ops.begin();
   for (; iter != m_patch_ops.end(); ++iter) {
-    if (!(*iter)->Apply(value)) {
+    if (!(*iter)->Apply(transaction)) {
       return false;
     }
   }
@@ -0,0 +1,255 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonStreamWriter.cpp
+ * Write JSON text without building a tree of JsonValues.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <sstream>
+#include <string>
+#include "ola/StringUtils.h"
+#include "ola/web/JsonStreamWriter.h"
+
+namespace ola {
+namespace web {
+
+using std::ostringstream;
+using std::string;
+
+void JsonStreamWriter::StartObject() {
+  BeforeValue(true);
+  OpenObject();
+}
+
+void JsonStreamWriter::EndObject() {
+  if (m_scopes.empty()) {
+    return;
+  }
+
+  if (m_scopes.back().count) {
+    m_indent -= DEFAULT_INDENT;
+    NewLine();
+  }
+  m_scopes.pop_back();
+  m_output->push_back('}');
+}
+
+void JsonStreamWriter::StartArray() {
+  BeforeValue(true);
+  OpenArray(false, false);
+}
+
+void JsonStreamWriter::EndArray() {
+  if (m_scopes.empty()) {
+    return;
+  }
+
+  const Scope &scope = m_scopes.back();
+  if (scope.complex) {
+    if (scope.count == 0) {
+      OpenComplexArray();
+    }
+    m_indent -= DEFAULT_INDENT;
+    NewLine();
+  }
+  m_scopes.pop_back();
+  m_output->push_back(']');
+}
+
+void JsonStreamWriter::Key(const string &key) {
+  if (!m_scopes.empty()) {
+    Scope &scope = m_scopes.back();
+    if (scope.count == 0) {
+      m_indent += DEFAULT_INDENT;
+      m_output->push_back('\n');
+    } else {
+      m_output->append(",\n");
+    }
+    scope.count++;
+  }
+  m_output->append(m_indent, ' ');
+  m_output->push_back('"');
+  m_output->append(EscapeString(key));
+  m_output->append("\": ");
+}
+
+void JsonStreamWriter::Value(const string &value) {
+  BeforeValue(false);
+  m_output->push_back('"');
+  m_output->append(EscapeString(EncodeString(value)));
+  m_output->push_back('"');
+}
+
+void JsonStreamWriter::Value(const char *value) {
+  Value(string(value));
+}
+
+void JsonStreamWriter::Value(bool value) {
+  BeforeValue(false);
+  m_output->append(value ? "true" : "false");
+}
+
+void JsonStreamWriter::Value(unsigned int value) {
+  BeforeValue(false);
+  m_output->append(IntToString(value));
+}
+
+void JsonStreamWriter::Value(int value) {
+  BeforeValue(false);
+  m_output->append(IntToString(value));
+}
+
+void JsonStreamWriter::Value(uint64_t value) {
+  BeforeValue(false);
+  ostringstream str;
+  str << value;
+  m_output->append(str.str());
+}
+
+void JsonStreamWriter::Value(int64_t value) {
+  BeforeValue(false);
+  ostringstream str;
+  str << value;
+  m_output->append(str.str());
+}
+
+void JsonStreamWriter::Value(double value) {
+  BeforeValue(false);
+  m_output->append(JsonDouble(value).ToString());
+}
+
+void JsonStreamWriter::Null() {
+  BeforeValue(false);
+  m_output->append("null");
+}
+
+void JsonStreamWriter::RawValue(const string &value) {
+  BeforeValue(false);
+  m_output->append(value);
+}
+
+void JsonStreamWriter::Value(const JsonValue &value) {
+  value.Accept(this);
+}
+
+/*
+ * Write the separator before a value. Property values follow a Key(), which
+ * has already written the separator.
+ * @param complex true if the value is an object or array.
+ */
+void JsonStreamWriter::BeforeValue(bool complex) {
+  if (m_scopes.empty() || m_scopes.back().is_object) {
+    return;
+  }
+
+  Scope &scope = m_scopes.back();
+  if (scope.count == 0) {
+    if (!scope.complex_known) {
+      scope.complex = complex;
+      scope.complex_known = true;
+    }
+    if (scope.complex) {
+      OpenComplexArray();
+    }
+  } else if (scope.complex) {
+    m_output->push_back(',');
+    NewLine();
+  } else {
+    m_output->append(", ");
+  }
+  scope.count++;
+}
+
+void JsonStreamWriter::OpenObject() {
+  m_output->push_back('{');
+  m_scopes.push_back(Scope(true, true, false));
+}
+
+void JsonStreamWriter::OpenArray(bool complex_known, bool complex) {
+  m_output->push_back('[');
+  m_scopes.push_back(Scope(false, complex_known, complex));
+}
+
+void JsonStreamWriter::OpenComplexArray() {
+  m_indent += DEFAULT_INDENT;
+  NewLine();
+}
+
+void JsonStreamWriter::NewLine() {
+  m_output->push_back('\n');
+  m_output->append(m_indent, ' ');
+}
+
+void JsonStreamWriter::Visit(const JsonString &value) {
+  Value(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonBool &value) {
+  Value(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonNull &) {
+  Null();
+}
+
+void JsonStreamWriter::Visit(const JsonRawValue &value) {
+  RawValue(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonObject &value) {
+  BeforeValue(!value.IsEmpty());
+  OpenObject();
+  value.VisitProperties(this);
+  EndObject();
+}
+
+void JsonStreamWriter::Visit(const JsonArray &value) {
+  BeforeValue(!value.IsEmpty());
+  OpenArray(true, value.IsComplexType());
+  for (unsigned int i = 0; i < value.Size(); i++) {
+    value.ElementAt(i)->Accept(this);
+  }
+  EndArray();
+}
+
+void JsonStreamWriter::Visit(const JsonUInt &value) {
+  Value(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonUInt64 &value) {
+  Value(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonInt &value) {
+  Value(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonInt64 &value) {
+  Value(value.Value());
+}
+
+void JsonStreamWriter::Visit(const JsonDouble &value) {
+  BeforeValue(false);
+  m_output->append(value.ToString());
+}
+
+void JsonStreamWriter::VisitProperty(const string &property,
+                                     const JsonValue &value) {
+  Key(property);
+  value.Accept(this);
+}
+}  // namespace web
+}  // namespace ola
@@ -0,0 +1,208 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonStreamWriterTest.cpp
+ * Unittest for the JsonStreamWriter.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/testing/TestUtils.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonStreamWriter.h"
+#include "ola/web/JsonWriter.h"
+
+using ola::web::JsonArray;
+using ola::web::JsonObject;
+using ola::web::JsonStreamWriter;
+using ola::web::JsonWriter;
+using std::string;
+
+class JsonStreamWriterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(JsonStreamWriterTest);
+  CPPUNIT_TEST(testValues);
+  CPPUNIT_TEST(testArrays);
+  CPPUNIT_TEST(testObjects);
+  CPPUNIT_TEST(testJsonValues);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testValues();
+  void testArrays();
+  void testObjects();
+  void testJsonValues();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonStreamWriterTest);
+
+
+/*
+ * Check the scalar values.
+ */
+void JsonStreamWriterTest::testValues() {
+  string output;
+  JsonStreamWriter writer(&output);
+  writer.StartArray();
+  writer.Null();
+  writer.Value(true);
+  writer.Value(1u);
+  writer.Value(-10);
+  writer.Value(static_cast<uint64_t>(8589934592ull));
+  writer.Value(static_cast<int64_t>(-8589934592ll));
+  writer.Value(2.5);
+  writer.Value("foo\"bar");
+  writer.RawValue("{}");
+  writer.EndArray();
+
+  OLA_ASSERT_EQ(
+      string("[null, true, 1, -10, 8589934592, -8589934592, 2.5, "
+             "\"foo\\\"bar\", {}]"),
+      output);
+}
+
+
+/*
+ * Check arrays are formatted like the JsonWriter.
+ */
+void JsonStreamWriterTest::testArrays() {
+  string output;
+  JsonStreamWriter writer(&output);
+  writer.StartArray();
+  writer.EndArray();
+  OLA_ASSERT_EQ(string("[]"), output);
+
+  output.clear();
+  writer.StartArray();
+  writer.StartObject();
+  writer.Add("id", 1);
+  writer.EndObject();
+  writer.StartArray();
+  writer.Value(1);
+  writer.Value(2);
+  writer.EndArray();
+  writer.EndArray();
+
+  JsonArray array;
+  array.AppendObject()->Add("id", 1);
+  JsonArray *inner = array.AppendArray();
+  inner->Append(1);
+  inner->Append(2);
+  OLA_ASSERT_EQ(JsonWriter::AsString(array), output);
+}
+
+
+/*
+ * Check objects are formatted like the JsonWriter.
+ */
+void JsonStreamWriterTest::testObjects() {
+  string output;
+  JsonStreamWriter writer(&output);
+  writer.StartObject();
+  writer.EndObject();
+  OLA_ASSERT_EQ(string("{}"), output);
+
+  // Add the keys in sorted order, since that's what JsonObject does.
+  output.clear();
+  writer.StartObject();
+  writer.Add("age", 10);
+  writer.Key("empty");
+  writer.StartObject();
+  writer.EndObject();
+  writer.Key("lucky numbers");
+  writer.StartArray();
+  writer.Value(2);
+  writer.Value(5);
+  writer.EndArray();
+  writer.Add("male", true);
+  writer.Add("name", "simon");
+  writer.Key("pets");
+  writer.StartArray();
+  writer.StartObject();
+  writer.Add("name", "rover");
+  writer.EndObject();
+  writer.StartObject();
+  writer.Add("name", "felix");
+  writer.EndObject();
+  writer.EndArray();
+  writer.Key("uids");
+  writer.StartArray();
+  writer.EndArray();
+  writer.EndObject();
+
+  JsonObject object;
+  object.Add("age", 10);
+  object.AddObject("empty");
+  JsonArray *array = object.AddArray("lucky numbers");
+  array->Append(2);
+  array->Append(5);
+  object.Add("male", true);
+  object.Add("name", "simon");
+  JsonArray *pets = object.AddArray("pets");
+  pets->AppendObject()->Add("name", "rover");
+  pets->AppendObject()->Add("name", "felix");
+  object.AddArray("uids");
+  OLA_ASSERT_EQ(JsonWriter::AsString(object), output);
+}
+
+
+/*
+ * Check writing trees of JsonValues.
+ */
+void JsonStreamWriterTest::testJsonValues() {
+  JsonObject object;
+  object.Add("age", 10);
+  object.Add("name", "simon");
+  object.AddRaw("raw", "[1]");
+  JsonArray *array = object.AddArray("items");
+  JsonObject *item = array->AppendObject();
+  item->Add("type", "string");
+  item->Add("value", 1.5);
+  array->AppendObject();
+  array->AppendArray();
+  object.AddArray("empty");
+
+  string output;
+  JsonStreamWriter writer(&output);
+  writer.Value(object);
+  OLA_ASSERT_EQ(JsonWriter::AsString(object), output);
+
+  // And as part of a streamed document.
+  output.clear();
+  writer.StartObject();
+  writer.Add("count", 1);
+  writer.Key("values");
+  writer.StartArray();
+  writer.Value(object);
+  writer.EndArray();
+  writer.EndObject();
+
+  JsonObject outer;
+  outer.Add("count", 1);
+  JsonArray *values = outer.AddArray("values");
+  JsonObject *copy = values->AppendObject();
+  copy->Add("age", 10);
+  copy->Add("name", "simon");
+  copy->AddRaw("raw", "[1]");
+  JsonArray *copy_array = copy->AddArray("items");
+  JsonObject *copy_item = copy_array->AppendObject();
+  copy_item->Add("type", "string");
+  copy_item->Add("value", 1.5);
+  copy_array->AppendObject();
+  copy_array->AppendArray();
+  copy->AddArray("empty");
+  OLA_ASSERT_EQ(JsonWriter::AsString(outer), output);
+}
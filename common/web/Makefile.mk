@@ -17,8 +17,10 @@ dist_noinst_DATA += \
 ################################################
 noinst_LTLIBRARIES += common/web/libolaweb.la
 common_web_libolaweb_la_SOURCES = \
+    common/web/CompiledSchema.cpp \
     common/web/Json.cpp \
     common/web/JsonData.cpp \
+    common/web/JsonDocument.cpp \
     common/web/JsonLexer.cpp \
     common/web/JsonParser.cpp \
     common/web/JsonPatch.cpp \
@@ -26,6 +28,7 @@ common_web_libolaweb_la_SOURCES = \
     common/web/JsonPointer.cpp \
     common/web/JsonSchema.cpp \
     common/web/JsonSections.cpp \
+    common/web/JsonStreamWriter.cpp \
     common/web/JsonTypes.cpp \
     common/web/JsonWriter.cpp \
     common/web/PointerTracker.cpp \
@@ -44,11 +47,29 @@ if USING_WIN32
 common_web_libolaweb_la_LIBADD = common/libolacommon.la
 endif
 
+# PROGRAMS
+################################################
+noinst_PROGRAMS += common/web/json_parser_benchmark \
+                   common/web/json_schema_benchmark
+
+common_web_json_parser_benchmark_SOURCES = \
+    common/web/json_parser_benchmark.cpp
+common_web_json_parser_benchmark_LDADD = common/web/libolaweb.la \
+                                         common/libolacommon.la
+
+common_web_json_schema_benchmark_SOURCES = \
+    common/web/json_schema_benchmark.cpp
+common_web_json_schema_benchmark_LDADD = common/web/libolaweb.la \
+                                         common/libolacommon.la
+
 # TESTS
 ################################################
 # Patch test names are abbreviated to prevent Windows' UAC from blocking them.
 test_programs += \
+    common/web/CompiledSchemaTester \
     common/web/JsonTester \
+    common/web/JsonDocumentTester \
+    common/web/JsonStreamWriterTester \
     common/web/ParserTester \
     common/web/PtchParserTester \
     common/web/PtchTester \
@@ -61,10 +82,23 @@ test_programs += \
 COMMON_WEB_TEST_LDADD = $(COMMON_TESTING_LIBS) \
                         common/web/libolaweb.la
 
+common_web_CompiledSchemaTester_SOURCES = common/web/CompiledSchemaTest.cpp
+common_web_CompiledSchemaTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_web_CompiledSchemaTester_LDADD = $(COMMON_WEB_TEST_LDADD)
+
 common_web_JsonTester_SOURCES = common/web/JsonTest.cpp
 common_web_JsonTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_web_JsonTester_LDADD = $(COMMON_WEB_TEST_LDADD)
 
+common_web_JsonDocumentTester_SOURCES = common/web/JsonDocumentTest.cpp
+common_web_JsonDocumentTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_web_JsonDocumentTester_LDADD = $(COMMON_WEB_TEST_LDADD)
+
+common_web_JsonStreamWriterTester_SOURCES = \
+    common/web/JsonStreamWriterTest.cpp
+common_web_JsonStreamWriterTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_web_JsonStreamWriterTester_LDADD = $(COMMON_WEB_TEST_LDADD)
+
 common_web_ParserTester_SOURCES = common/web/ParserTest.cpp
 common_web_ParserTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_web_ParserTester_LDADD = $(COMMON_WEB_TEST_LDADD)
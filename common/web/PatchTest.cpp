@@ -60,6 +60,7 @@ class JsonPatchTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testMoveOp);
   CPPUNIT_TEST(testTestOp);
   CPPUNIT_TEST(testAtomicUpdates);
+  CPPUNIT_TEST(testMoveDoesNotCopy);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -70,6 +71,7 @@ class JsonPatchTest: public CppUnit::TestFixture {
   void testMoveOp();
   void testTestOp();
   void testAtomicUpdates();
+  void testMoveDoesNotCopy();
 
  private:
   void CheckValuesMatch(const std::string &, const JsonValue *actual);
@@ -951,4 +953,81 @@ void JsonPatchTest::testAtomicUpdates() {
       " \"object\": {\"bat\": 1}, \"array\": [1,2,3] }",
       text.Value());
   }
+
+  // Every kind of change is undone if a later operation fails.
+  {
+    JsonPatchSet patch;
+    patch.AddOp(new JsonPatchMoveOp(
+          JsonPointer("/array/0"), JsonPointer("/object/first")));
+    patch.AddOp(new JsonPatchRemoveOp(JsonPointer("/array/-")));
+    patch.AddOp(new JsonPatchAddOp(JsonPointer("/array/0"), new JsonInt(7)));
+    patch.AddOp(new JsonPatchCopyOp(
+          JsonPointer("/object"), JsonPointer("/copy")));
+    patch.AddOp(new JsonPatchAddOp(
+          JsonPointer("/copy/extra"), new JsonNull()));
+    patch.AddOp(new JsonPatchRemoveOp(JsonPointer("/foo")));
+    patch.AddOp(new JsonPatchMoveOp(
+          JsonPointer("/object"), JsonPointer("")));
+    patch.AddOp(new JsonPatchTestOp(JsonPointer("/first"), new JsonInt(2)));
+    OLA_ASSERT_FALSE(text.Apply(patch));
+
+    CheckValuesMatch(
+      "{\"foo\": \"bar\", \"baz\": true, "
+      " \"object\": {\"bat\": 1}, \"array\": [1,2,3] }",
+      text.Value());
+  }
+
+  // And applied if they all succeed.
+  {
+    JsonPatchSet patch;
+    patch.AddOp(new JsonPatchMoveOp(
+          JsonPointer("/array/0"), JsonPointer("/object/first")));
+    patch.AddOp(new JsonPatchRemoveOp(JsonPointer("/array/-")));
+    patch.AddOp(new JsonPatchAddOp(JsonPointer("/array/0"), new JsonInt(7)));
+    patch.AddOp(new JsonPatchCopyOp(
+          JsonPointer("/object"), JsonPointer("/copy")));
+    patch.AddOp(new JsonPatchAddOp(
+          JsonPointer("/copy/extra"), new JsonNull()));
+    patch.AddOp(new JsonPatchRemoveOp(JsonPointer("/foo")));
+    patch.AddOp(new JsonPatchTestOp(JsonPointer("/object/first"),
+                                    new JsonInt(1)));
+    OLA_ASSERT_TRUE(text.Apply(patch));
+
+    CheckValuesMatch(
+      "{\"baz\": true, \"object\": {\"bat\": 1, \"first\": 1}, "
+      " \"copy\": {\"bat\": 1, \"first\": 1, \"extra\": null}, "
+      " \"array\": [7, 2] }",
+      text.Value());
+  }
+
+  // The patch set can also be applied to a value directly.
+  {
+    string error;
+    auto_ptr<JsonValue> value(JsonParser::Parse("{\"a\": [1]}", &error));
+    JsonValue *root = value.release();
+    JsonPatchSet patch;
+    patch.AddOp(new JsonPatchRemoveOp(JsonPointer("/a/0")));
+    patch.AddOp(new JsonPatchRemoveOp(JsonPointer("/a/0")));
+    OLA_ASSERT_FALSE(patch.Apply(&root));
+    value.reset(root);
+    CheckValuesMatch("{\"a\": [1]}", value.get());
+  }
+}
+
+void JsonPatchTest::testMoveDoesNotCopy() {
+  JsonObject *root = new JsonObject();
+  JsonObject *child = root->AddObject("a/b");
+  child->Add("bat", 1);
+  JsonData text(root);
+
+  // The key needs to be escaped.
+  JsonPatchSet patch;
+  patch.AddOp(new JsonPatchMoveOp(JsonPointer("/a~1b"), JsonPointer("/c~0")));
+  OLA_ASSERT_TRUE(text.Apply(patch));
+  CheckValuesMatch("{\"c~\": {\"bat\": 1}}", text.Value());
+
+  // The same object is now at the new location.
+  JsonValue *value = const_cast<JsonValue*>(text.Value());
+  OLA_ASSERT_EQ(static_cast<JsonValue*>(child),
+                value->LookupElement(JsonPointer("/c~0")));
 }
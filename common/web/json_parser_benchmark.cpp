@@ -0,0 +1,198 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * json_parser_benchmark.cpp
+ * Compare the performance of JsonParser and JsonDocument.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/file/Util.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonDocument.h"
+#include "ola/web/JsonParser.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::web::JsonDocument;
+using ola::web::JsonParser;
+using ola::web::JsonValue;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_string(testdata, "common/web/testdata",
+              "The directory containing the JSON test data");
+DEFINE_s_uint32(iterations, i, 200, "The number of passes over the corpus");
+
+// Stops the compiler from optimizing the loops away.
+static volatile size_t sink;
+
+/*
+ * Read the JSON documents from a test file. Documents are separated by
+ * === POSITIVE ===, === NEGATIVE === or -------- lines.
+ */
+void ReadDocuments(const string &filename, vector<string> *documents) {
+  const string path = FLAGS_testdata.str() + ola::file::PATH_SEPARATOR +
+                      filename;
+  std::ifstream in(path.c_str(), std::ios::in);
+  if (!in.is_open()) {
+    OLA_WARN << "Failed to open " << path;
+    return;
+  }
+
+  string document;
+  string line;
+  while (getline(in, line)) {
+    line.erase(line.find_last_not_of("\r") + 1);
+    if (line.compare(0, 2, "//") == 0) {
+      continue;
+    } else if (line == "=== POSITIVE ===" || line == "=== NEGATIVE ===" ||
+               line == "--------") {
+      if (!document.empty()) {
+        documents->push_back(document);
+      }
+      document.clear();
+    } else {
+      document.append(line);
+      document.push_back('\n');
+    }
+  }
+  if (!document.empty()) {
+    documents->push_back(document);
+  }
+}
+
+/**
+ * Parse the documents FLAGS_iterations times and return the time per
+ * document in us.
+ */
+double RunTest(const vector<string> &documents, bool use_document) {
+  Clock clock;
+  TimeStamp start, end;
+  size_t result = 0;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    vector<string>::const_iterator iter = documents.begin();
+    for (; iter != documents.end(); ++iter) {
+      string error;
+      if (use_document) {
+        JsonDocument document;
+        result += document.Parse(*iter, &error);
+      } else {
+        auto_ptr<JsonValue> value(JsonParser::Parse(*iter, &error));
+        result += value.get() != NULL;
+      }
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+  sink = result;
+
+  TimeInterval duration = end - start;
+  return static_cast<double>(duration.AsInt()) /
+      (FLAGS_iterations * documents.size());
+}
+
+void Report(const string &name, const vector<string> &documents) {
+  size_t bytes = 0;
+  vector<string>::const_iterator iter = documents.begin();
+  for (; iter != documents.end(); ++iter) {
+    bytes += iter->size();
+  }
+
+  cout << std::setw(8) << name << std::setw(8) << documents.size()
+       << std::setw(12) << bytes << std::fixed << std::setprecision(2)
+       << std::setw(14) << RunTest(documents, false)
+       << std::setw(16) << RunTest(documents, true) << endl;
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark the JSON parsers using the schema test data.");
+
+  const char *files[] = {
+    "allof.test",
+    "anyof.test",
+    "arrays.test",
+    "basic-keywords.test",
+    "definitions.test",
+    "integers.test",
+    "misc.test",
+    "not.test",
+    "objects.test",
+    "oneof.test",
+    "strings.test",
+    "type.test",
+  };
+
+  vector<string> corpus;
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    vector<string> documents;
+    ReadDocuments(files[i], &documents);
+
+    // Only keep the valid documents.
+    vector<string>::const_iterator iter = documents.begin();
+    for (; iter != documents.end(); ++iter) {
+      string error;
+      auto_ptr<JsonValue> value(JsonParser::Parse(*iter, &error));
+      if (value.get()) {
+        corpus.push_back(*iter);
+      }
+    }
+  }
+
+  vector<string> schema;
+  ReadDocuments("schema.json", &schema);
+
+  if (corpus.empty() || schema.empty()) {
+    OLA_WARN << "No test data found in " << FLAGS_testdata.str();
+    return 1;
+  }
+
+  // One large document, made from all the small ones.
+  string combined = "[";
+  for (unsigned int i = 0; i < 20; i++) {
+    vector<string>::const_iterator iter = corpus.begin();
+    for (; iter != corpus.end(); ++iter) {
+      if (combined.size() > 1) {
+        combined.append(",\n");
+      }
+      combined.append(*iter);
+    }
+  }
+  combined.append("]");
+  vector<string> large(1, combined);
+
+  cout << std::setw(8) << "input" << std::setw(8) << "docs"
+       << std::setw(12) << "bytes" << std::setw(14) << "parser (us)"
+       << std::setw(16) << "document (us)" << endl;
+  Report("corpus", corpus);
+  Report("schema", schema);
+  Report("large", large);
+  return 0;
+}
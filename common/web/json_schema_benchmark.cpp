@@ -0,0 +1,190 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * json_schema_benchmark.cpp
+ * Compare the performance of JsonSchema and CompiledSchema.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/file/Util.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/web/CompiledSchema.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonParser.h"
+#include "ola/web/JsonSchema.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::web::CompiledSchema;
+using ola::web::JsonParser;
+using ola::web::JsonSchema;
+using ola::web::JsonValue;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_string(testdata, "common/web/testdata",
+              "The directory containing the JSON test data");
+DEFINE_s_uint32(iterations, i, 200, "The number of passes over the corpus");
+
+// Stops the compiler from optimizing the loops away.
+static volatile unsigned int sink;
+
+/*
+ * Read the JSON documents from a test file. Documents are separated by
+ * === POSITIVE ===, === NEGATIVE === or -------- lines.
+ */
+void ReadDocuments(const string &filename, vector<string> *documents) {
+  const string path = FLAGS_testdata.str() + ola::file::PATH_SEPARATOR +
+                      filename;
+  std::ifstream in(path.c_str(), std::ios::in);
+  if (!in.is_open()) {
+    OLA_WARN << "Failed to open " << path;
+    return;
+  }
+
+  string document;
+  string line;
+  while (getline(in, line)) {
+    line.erase(line.find_last_not_of("\r") + 1);
+    if (line.compare(0, 2, "//") == 0) {
+      continue;
+    } else if (line == "=== POSITIVE ===" || line == "=== NEGATIVE ===" ||
+               line == "--------") {
+      if (!document.empty()) {
+        documents->push_back(document);
+      }
+      document.clear();
+    } else {
+      document.append(line);
+      document.push_back('\n');
+    }
+  }
+  if (!document.empty()) {
+    documents->push_back(document);
+  }
+}
+
+/**
+ * Validate the values FLAGS_iterations times and return the time per
+ * value in us.
+ */
+template <typename Schema>
+double RunTest(Schema *schema, const vector<JsonValue*> &values,
+               unsigned int *valid) {
+  Clock clock;
+  TimeStamp start, end;
+  unsigned int result = 0;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    vector<JsonValue*>::const_iterator iter = values.begin();
+    for (; iter != values.end(); ++iter) {
+      result += schema->IsValid(**iter);
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+  sink = result;
+  *valid = result / FLAGS_iterations;
+
+  TimeInterval duration = end - start;
+  return static_cast<double>(duration.AsInt()) /
+      (FLAGS_iterations * values.size());
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark schema validation, by checking the schema test "
+               "data against the JSON meta schema.");
+
+  const char *files[] = {
+    "allof.test",
+    "anyof.test",
+    "arrays.test",
+    "basic-keywords.test",
+    "definitions.test",
+    "integers.test",
+    "misc.test",
+    "not.test",
+    "objects.test",
+    "oneof.test",
+    "strings.test",
+    "type.test",
+  };
+
+  vector<JsonValue*> values;
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    vector<string> documents;
+    ReadDocuments(files[i], &documents);
+
+    vector<string>::const_iterator iter = documents.begin();
+    for (; iter != documents.end(); ++iter) {
+      string error;
+      JsonValue *value = JsonParser::Parse(*iter, &error);
+      if (value) {
+        values.push_back(value);
+      }
+    }
+  }
+
+  vector<string> schema_documents;
+  ReadDocuments("schema.json", &schema_documents);
+
+  if (values.empty() || schema_documents.empty()) {
+    OLA_WARN << "No test data found in " << FLAGS_testdata.str();
+    ola::STLDeleteElements(&values);
+    return 1;
+  }
+
+  string error;
+  auto_ptr<JsonSchema> schema(
+      JsonSchema::FromString(schema_documents[0], &error));
+  if (!schema.get()) {
+    OLA_WARN << "Invalid schema: " << error;
+    ola::STLDeleteElements(&values);
+    return 1;
+  }
+  auto_ptr<CompiledSchema> compiled(CompiledSchema::Compile(*schema));
+
+  unsigned int schema_valid, compiled_valid;
+  double schema_time = RunTest(schema.get(), values, &schema_valid);
+  double compiled_time = RunTest(compiled.get(), values, &compiled_valid);
+
+  cout << values.size() << " documents, " << compiled->NodeCount()
+       << " compiled nodes" << endl;
+  cout << std::setw(10) << "validator" << std::setw(8) << "valid"
+       << std::setw(12) << "time (us)" << endl;
+  cout << std::fixed << std::setprecision(2);
+  cout << std::setw(10) << "schema" << std::setw(8) << schema_valid
+       << std::setw(12) << schema_time << endl;
+  cout << std::setw(10) << "compiled" << std::setw(8) << compiled_valid
+       << std::setw(12) << compiled_time << endl;
+
+  ola::STLDeleteElements(&values);
+  return schema_valid == compiled_valid ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ArtNetTimeCodeReceiver.cpp
+ * Listens for Art-Net timecode packets.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <string.h>
+#include <ola/Callback.h>
+#include <ola/Logging.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/timecode/TimeCode.h>
+#include <ola/timecode/TimeCodeEnums.h>
+
+#include "examples/ArtNetTimeCodeReceiver.h"
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::timecode::TimeCode;
+
+const uint16_t ArtNetTimeCodeReceiver::ARTNET_PORT;
+const uint16_t ArtNetTimeCodeReceiver::OP_TIMECODE;
+const char ArtNetTimeCodeReceiver::ARTNET_ID[] = "Art-Net";
+
+namespace {
+// The offsets of the fields in an ArtTimeCode packet.
+enum {
+  OPCODE_OFFSET = 8,
+  FRAMES_OFFSET = 14,
+  SECONDS_OFFSET = 15,
+  MINUTES_OFFSET = 16,
+  HOURS_OFFSET = 17,
+  TYPE_OFFSET = 18,
+  TIMECODE_PACKET_SIZE = 19,
+};
+}  // namespace
+
+ArtNetTimeCodeReceiver::ArtNetTimeCodeReceiver(
+    ola::io::SelectServerInterface *ss,
+    TimeCodeCallback *callback)
+    : m_ss(ss),
+      m_callback(callback),
+      m_started(false) {
+}
+
+
+ArtNetTimeCodeReceiver::~ArtNetTimeCodeReceiver() {
+  if (m_started) {
+    m_ss->RemoveReadDescriptor(&m_socket);
+  }
+  m_socket.Close();
+}
+
+
+/**
+ * Start listening for timecode.
+ * @returns true if the socket was set up, false otherwise.
+ */
+bool ArtNetTimeCodeReceiver::Start() {
+  if (!m_socket.Init()) {
+    return false;
+  }
+  if (!m_socket.Bind(IPV4SocketAddress(IPV4Address::WildCard(),
+                                       ARTNET_PORT))) {
+    return false;
+  }
+  m_socket.SetOnData(
+      ola::NewCallback(this, &ArtNetTimeCodeReceiver::ReceivePacket));
+  m_started = m_ss->AddReadDescriptor(&m_socket);
+  return m_started;
+}
+
+
+void ArtNetTimeCodeReceiver::ReceivePacket() {
+  uint8_t packet[TIMECODE_PACKET_SIZE];
+  ssize_t size = sizeof(packet);
+  if (!m_socket.RecvFrom(packet, &size)) {
+    return;
+  }
+
+  // The opcode is little endian.
+  if (size < TIMECODE_PACKET_SIZE ||
+      memcmp(packet, ARTNET_ID, sizeof(ARTNET_ID)) ||
+      (packet[OPCODE_OFFSET] | (packet[OPCODE_OFFSET + 1] << 8)) !=
+      OP_TIMECODE) {
+    return;
+  }
+
+  TimeCode timecode(
+      static_cast<ola::timecode::TimeCodeType>(packet[TYPE_OFFSET]),
+      packet[HOURS_OFFSET], packet[MINUTES_OFFSET],
+      packet[SECONDS_OFFSET], packet[FRAMES_OFFSET]);
+  if (!timecode.IsValid()) {
+    OLA_DEBUG << "Ignoring invalid timecode " << timecode;
+    return;
+  }
+  m_callback->Run(timecode);
+}
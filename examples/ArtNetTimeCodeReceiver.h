@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ArtNetTimeCodeReceiver.h
+ * Listens for Art-Net timecode packets.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/Callback.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/network/Socket.h>
+#include <ola/timecode/TimeCode.h>
+#include <stdint.h>
+
+#include <memory>
+
+#ifndef EXAMPLES_ARTNETTIMECODERECEIVER_H_
+#define EXAMPLES_ARTNETTIMECODERECEIVER_H_
+
+/**
+ * Listens for ArtTimeCode packets and runs a callback for each valid
+ * timecode.
+ *
+ * The socket is bound with SO_REUSEADDR, so this can run on the same host as
+ * an olad with the Art-Net plugin enabled.
+ */
+class ArtNetTimeCodeReceiver {
+ public:
+  typedef ola::Callback1<void, const ola::timecode::TimeCode&>
+      TimeCodeCallback;
+
+  /**
+   * @brief Create a new ArtNetTimeCodeReceiver.
+   * @param ss the SelectServer to use.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  ArtNetTimeCodeReceiver(ola::io::SelectServerInterface *ss,
+                         TimeCodeCallback *callback);
+  ~ArtNetTimeCodeReceiver();
+
+  bool Start();
+
+ private:
+  ola::io::SelectServerInterface *m_ss;
+  std::auto_ptr<TimeCodeCallback> m_callback;
+  ola::network::UDPSocket m_socket;
+  bool m_started;
+
+  void ReceivePacket();
+
+  static const uint16_t ARTNET_PORT = 6454;
+  static const uint16_t OP_TIMECODE = 0x9700;
+  static const char ARTNET_ID[];
+};
+#endif  // EXAMPLES_ARTNETTIMECODERECEIVER_H_
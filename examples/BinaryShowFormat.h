@@ -0,0 +1,98 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowFormat.h
+ * The layout of binary show files.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * A binary show file starts with an 8 byte magic value and a 4 byte version.
+ * This is followed by records, each of which is:
+ *   type (uint8), delay in ms since the previous frame (uint32),
+ *   universe (uint32), frame size (uint16), then the payload.
+ *
+ * The payload of a FULL or KEYFRAME record is the frame data. The payload of
+ * a DELTA record is a run count (uint16) and for each run the offset (uint16),
+ * the length (uint16) and the slot values; the slots that aren't in a run are
+ * the same as the previous frame for the universe, or zero if the frame grew.
+ *
+ * Every keyframe interval, a block of KEYFRAME records holds the state of
+ * each universe. These aren't played, they allow playback to start from the
+ * keyframe rather than the start of the file.
+ *
+ * The file ends with the keyframe index and the footer. Each index entry is
+ * the time of the keyframe in ms (uint64) and the file offset of the block
+ * (uint64). The footer is the offset of the index (uint64), the number of
+ * index entries (uint32), the wait after the last frame (uint32, or
+ * NO_FINAL_WAIT if the show ends with the last frame) and an 8 byte magic
+ * value. If a recording is interrupted, the footer is missing and
+ * the file is read without an index.
+ *
+ * All integers are big endian.
+ */
+
+#ifndef EXAMPLES_BINARYSHOWFORMAT_H_
+#define EXAMPLES_BINARYSHOWFORMAT_H_
+
+#include <stdint.h>
+
+namespace binary_show {
+
+static const char FILE_MAGIC[] = "OLASHOWB";
+static const char FOOTER_MAGIC[] = "OLASHOWI";
+static const unsigned int MAGIC_SIZE = 8;
+static const uint32_t FORMAT_VERSION = 1;
+static const unsigned int HEADER_SIZE = MAGIC_SIZE + 4;
+static const unsigned int RECORD_HEADER_SIZE = 11;
+static const unsigned int RUN_HEADER_SIZE = 4;
+static const unsigned int INDEX_ENTRY_SIZE = 16;
+static const unsigned int FOOTER_SIZE = 16 + MAGIC_SIZE;
+static const uint32_t NO_FINAL_WAIT = 0xffffffff;
+
+typedef enum {
+  FULL_RECORD = 1,
+  DELTA_RECORD = 2,
+  KEYFRAME_RECORD = 3,
+} RecordType;
+
+inline void WriteUInt16(uint16_t value, uint8_t *output) {
+  output[0] = static_cast<uint8_t>(value >> 8);
+  output[1] = static_cast<uint8_t>(value);
+}
+
+inline void WriteUInt32(uint32_t value, uint8_t *output) {
+  WriteUInt16(static_cast<uint16_t>(value >> 16), output);
+  WriteUInt16(static_cast<uint16_t>(value), output + 2);
+}
+
+inline void WriteUInt64(uint64_t value, uint8_t *output) {
+  WriteUInt32(static_cast<uint32_t>(value >> 32), output);
+  WriteUInt32(static_cast<uint32_t>(value), output + 4);
+}
+
+inline uint16_t ReadUInt16(const uint8_t *input) {
+  return static_cast<uint16_t>((input[0] << 8) | input[1]);
+}
+
+inline uint32_t ReadUInt32(const uint8_t *input) {
+  return (static_cast<uint32_t>(ReadUInt16(input)) << 16) |
+         ReadUInt16(input + 2);
+}
+
+inline uint64_t ReadUInt64(const uint8_t *input) {
+  return (static_cast<uint64_t>(ReadUInt32(input)) << 32) |
+         ReadUInt32(input + 4);
+}
+}  // namespace binary_show
+#endif  // EXAMPLES_BINARYSHOWFORMAT_H_
@@ -0,0 +1,439 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowLoader.cpp
+ * Reads binary show files.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // _WIN32
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+#include "examples/BinaryShowLoader.h"
+
+using ola::DmxBuffer;
+using std::string;
+using std::vector;
+
+
+BinaryShowLoader::BinaryShowLoader(const string &filename)
+    : m_filename(filename),
+      m_data(NULL),
+      m_size(0),
+      m_mapping(NULL),
+      m_records_end(0),
+      m_index_size(0),
+      m_final_wait(binary_show::NO_FINAL_WAIT),
+      m_offset(binary_show::HEADER_SIZE),
+      m_record_number(0) {
+}
+
+
+BinaryShowLoader::~BinaryShowLoader() {
+  UnmapFile();
+}
+
+
+/**
+ * Check if a file is a binary show file.
+ */
+bool BinaryShowLoader::IsBinaryShow(const string &filename) {
+  std::ifstream show_file(filename.data(), std::ios::in | std::ios::binary);
+  char magic[binary_show::MAGIC_SIZE];
+  if (!show_file.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return memcmp(magic, binary_show::FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+
+/**
+ * Load the show file.
+ * @returns true if the file is a valid binary show, false otherwise.
+ */
+bool BinaryShowLoader::Load() {
+  if (!MapFile()) {
+    return false;
+  }
+
+  if (m_size < binary_show::HEADER_SIZE ||
+      memcmp(m_data, binary_show::FILE_MAGIC, binary_show::MAGIC_SIZE)) {
+    OLA_WARN << "Invalid binary show file " << m_filename;
+    return false;
+  }
+
+  uint32_t version = binary_show::ReadUInt32(m_data +
+                                             binary_show::MAGIC_SIZE);
+  if (version != binary_show::FORMAT_VERSION) {
+    OLA_WARN << m_filename << " has an unknown version " << version;
+    return false;
+  }
+
+  ReadFooter();
+  Reset();
+  return true;
+}
+
+
+/**
+ * Reset to the start of the show
+ */
+void BinaryShowLoader::Reset() {
+  m_offset = binary_show::HEADER_SIZE;
+  m_record_number = 0;
+  m_universes.clear();
+}
+
+
+/**
+ * Read the next show file entry
+ * @param entry a ShowEntry to fill with data
+ */
+ShowLoader::State BinaryShowLoader::NextEntry(ShowEntry *entry) {
+  Record record;
+  do {
+    ShowLoader::State state = ParseRecord(m_offset, &record);
+    if (state != ShowLoader::OK) {
+      return state;
+    }
+    m_record_number++;
+    if (!ApplyRecord(record, &m_universes)) {
+      return ShowLoader::INVALID_LINE;
+    }
+    m_offset = record.end;
+  } while (record.type == binary_show::KEYFRAME_RECORD);
+
+  entry->universe = record.universe;
+  entry->buffer = m_universes[record.universe];
+
+  ShowLoader::State state = NextDelay(&entry->next_wait);
+  if (state == ShowLoader::END_OF_FILE) {
+    // Match the text format, where a trailing wait is followed by an empty
+    // entry.
+    if (m_final_wait == binary_show::NO_FINAL_WAIT) {
+      entry->next_wait = 0;
+      return ShowLoader::END_OF_FILE;
+    }
+    entry->next_wait = m_final_wait;
+    return ShowLoader::OK;
+  }
+  return state;
+}
+
+
+/**
+ * Move to the last keyframe at or before seek_time, if that's after the
+ * current position.
+ * @param seek_time the time in ms to seek to.
+ * @param[in,out] position the current time in ms, this is updated to the time
+ *   of the keyframe.
+ * @param[out] snapshot the state of each universe at the keyframe.
+ * @returns true if the loader moved to a keyframe, false otherwise.
+ */
+bool BinaryShowLoader::SkipToKeyframe(uint64_t seek_time,
+                                      uint64_t *position,
+                                      vector<ShowEntry> *snapshot) {
+  // Find the first keyframe after the seek time.
+  unsigned int low = 0;
+  unsigned int high = m_index_size;
+  while (low < high) {
+    unsigned int middle = low + (high - low) / 2;
+    if (IndexValue(middle, 0) <= seek_time) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  if (low == 0) {
+    return false;
+  }
+  const uint64_t keyframe_time = IndexValue(low - 1, 0);
+  uint64_t offset = IndexValue(low - 1, 1);
+  if (keyframe_time <= *position || offset < binary_show::HEADER_SIZE) {
+    return false;
+  }
+
+  UniverseMap universes;
+  Record record;
+  while (ParseRecord(offset, &record) == ShowLoader::OK &&
+         record.type == binary_show::KEYFRAME_RECORD) {
+    if (!ApplyRecord(record, &universes)) {
+      return false;
+    }
+    offset = record.end;
+  }
+
+  m_universes.swap(universes);
+  m_offset = offset;
+  *position = keyframe_time;
+
+  snapshot->clear();
+  UniverseMap::const_iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    ShowEntry entry;
+    entry.universe = iter->first;
+    entry.buffer = iter->second;
+    entry.next_wait = 0;
+    snapshot->push_back(entry);
+  }
+  return true;
+}
+
+
+bool BinaryShowLoader::MapFile() {
+#ifdef _WIN32
+  std::ifstream show_file(m_filename.data(), std::ios::in | std::ios::binary);
+  if (!show_file.is_open()) {
+    OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
+    return false;
+  }
+  m_contents.assign(std::istreambuf_iterator<char>(show_file),
+                    std::istreambuf_iterator<char>());
+  m_data = reinterpret_cast<const uint8_t*>(m_contents.data());
+  m_size = m_contents.size();
+  return true;
+#else
+  int fd = open(m_filename.data(), O_RDONLY);
+  if (fd < 0) {
+    OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat)) {
+    OLA_FATAL << "Can't stat " << m_filename << ": " << strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  m_size = file_stat.st_size;
+  if (m_size) {
+    m_mapping = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m_mapping == MAP_FAILED) {
+      OLA_FATAL << "Can't map " << m_filename << ": " << strerror(errno);
+      m_mapping = NULL;
+      m_size = 0;
+      close(fd);
+      return false;
+    }
+    m_data = reinterpret_cast<const uint8_t*>(m_mapping);
+  }
+  close(fd);
+  return true;
+#endif  // _WIN32
+}
+
+
+void BinaryShowLoader::UnmapFile() {
+#ifndef _WIN32
+  if (m_mapping) {
+    munmap(m_mapping, m_size);
+    m_mapping = NULL;
+  }
+#endif  // _WIN32
+  m_data = NULL;
+  m_size = 0;
+}
+
+
+/*
+ * Read the footer. If it's missing, for example because the recording was
+ * interrupted, the records run to the end of the file and there's no index.
+ */
+void BinaryShowLoader::ReadFooter() {
+  m_records_end = m_size;
+  m_index_size = 0;
+  m_final_wait = binary_show::NO_FINAL_WAIT;
+
+  if (m_size < binary_show::HEADER_SIZE + binary_show::FOOTER_SIZE) {
+    return;
+  }
+  const uint8_t *footer = m_data + m_size - binary_show::FOOTER_SIZE;
+  if (memcmp(footer + 16, binary_show::FOOTER_MAGIC,
+             binary_show::MAGIC_SIZE)) {
+    OLA_WARN << m_filename << " has no index, seeking will be slow";
+    return;
+  }
+
+  uint64_t index_offset = binary_show::ReadUInt64(footer);
+  uint32_t index_size = binary_show::ReadUInt32(footer + 8);
+  if (index_offset < binary_show::HEADER_SIZE ||
+      index_offset + static_cast<uint64_t>(index_size) *
+          binary_show::INDEX_ENTRY_SIZE !=
+      m_size - binary_show::FOOTER_SIZE) {
+    OLA_WARN << m_filename << " has an invalid index";
+    return;
+  }
+  m_records_end = index_offset;
+  m_index_size = index_size;
+  m_final_wait = binary_show::ReadUInt32(footer + 12);
+}
+
+
+/*
+ * Parse the record at offset.
+ */
+ShowLoader::State BinaryShowLoader::ParseRecord(uint64_t offset,
+                                                Record *record) const {
+  if (offset >= m_records_end) {
+    return ShowLoader::END_OF_FILE;
+  }
+
+  // A partial record at the end of a file without an index is from an
+  // interrupted recording.
+  const ShowLoader::State truncated = (
+      m_records_end == m_size ? ShowLoader::END_OF_FILE :
+      ShowLoader::INVALID_LINE);
+  if (offset + binary_show::RECORD_HEADER_SIZE > m_records_end) {
+    return truncated;
+  }
+
+  const uint8_t *data = m_data + offset;
+  record->type = data[0];
+  record->delay = binary_show::ReadUInt32(data + 1);
+  record->universe = binary_show::ReadUInt32(data + 5);
+  record->size = binary_show::ReadUInt16(data + 9);
+  record->payload = data + binary_show::RECORD_HEADER_SIZE;
+  uint64_t end = offset + binary_show::RECORD_HEADER_SIZE;
+
+  if (record->size > ola::DMX_UNIVERSE_SIZE) {
+    OLA_WARN << "Record " << m_record_number + 1 << " is too large: "
+             << record->size;
+    return ShowLoader::INVALID_LINE;
+  }
+
+  switch (record->type) {
+    case binary_show::FULL_RECORD:
+    case binary_show::KEYFRAME_RECORD:
+      end += record->size;
+      break;
+    case binary_show::DELTA_RECORD:
+      {
+        if (end + 2 > m_records_end) {
+          return truncated;
+        }
+        unsigned int run_count = binary_show::ReadUInt16(m_data + end);
+        end += 2;
+        for (unsigned int i = 0; i < run_count; i++) {
+          if (end + binary_show::RUN_HEADER_SIZE > m_records_end) {
+            return truncated;
+          }
+          unsigned int run_offset = binary_show::ReadUInt16(m_data + end);
+          unsigned int run_length = binary_show::ReadUInt16(m_data + end + 2);
+          if (run_offset + run_length > record->size) {
+            OLA_WARN << "Record " << m_record_number + 1
+                     << " has an invalid run";
+            return ShowLoader::INVALID_LINE;
+          }
+          end += binary_show::RUN_HEADER_SIZE + run_length;
+        }
+      }
+      break;
+    default:
+      OLA_WARN << "Record " << m_record_number + 1 << " has unknown type "
+               << static_cast<int>(record->type);
+      return ShowLoader::INVALID_LINE;
+  }
+
+  if (end > m_records_end) {
+    return truncated;
+  }
+  record->end = end;
+  return ShowLoader::OK;
+}
+
+
+/*
+ * Update the universe data from a record.
+ */
+bool BinaryShowLoader::ApplyRecord(const Record &record,
+                                   UniverseMap *universes) const {
+  if (record.type != binary_show::DELTA_RECORD) {
+    (*universes)[record.universe].Set(record.payload, record.size);
+    return true;
+  }
+
+  UniverseMap::iterator iter = universes->find(record.universe);
+  if (iter == universes->end()) {
+    OLA_WARN << "Record " << m_record_number << " is a delta for universe "
+             << record.universe << " which has no data";
+    return false;
+  }
+
+  uint8_t slots[ola::DMX_UNIVERSE_SIZE];
+  memset(slots, 0, sizeof(slots));
+  unsigned int length = record.size;
+  iter->second.Get(slots, &length);
+
+  const uint8_t *run = record.payload + 2;
+  unsigned int run_count = binary_show::ReadUInt16(record.payload);
+  for (unsigned int i = 0; i < run_count; i++) {
+    unsigned int run_offset = binary_show::ReadUInt16(run);
+    unsigned int run_length = binary_show::ReadUInt16(run + 2);
+    memcpy(slots + run_offset, run + binary_show::RUN_HEADER_SIZE,
+           run_length);
+    run += binary_show::RUN_HEADER_SIZE + run_length;
+  }
+  iter->second.Set(slots, record.size);
+  return true;
+}
+
+
+/*
+ * Get the delay of the next frame, skipping any keyframe records.
+ */
+ShowLoader::State BinaryShowLoader::NextDelay(unsigned int *delay) const {
+  uint64_t offset = m_offset;
+  Record record;
+  while (true) {
+    ShowLoader::State state = ParseRecord(offset, &record);
+    if (state != ShowLoader::OK) {
+      return state;
+    }
+    if (record.type != binary_show::KEYFRAME_RECORD) {
+      *delay = record.delay;
+      return ShowLoader::OK;
+    }
+    offset = record.end;
+  }
+}
+
+
+/*
+ * Get the time (field 0) or the offset (field 1) of an index entry.
+ */
+uint64_t BinaryShowLoader::IndexValue(unsigned int entry,
+                                      unsigned int field) const {
+  return binary_show::ReadUInt64(
+      m_data + m_records_end + entry * binary_show::INDEX_ENTRY_SIZE +
+      field * 8);
+}
@@ -0,0 +1,87 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowLoader.h
+ * Reads binary show files.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/DmxBuffer.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "examples/ShowLoader.h"
+
+#ifndef EXAMPLES_BINARYSHOWLOADER_H_
+#define EXAMPLES_BINARYSHOWLOADER_H_
+
+/**
+ * Reads a binary show file, see BinaryShowFormat.h.
+ *
+ * The file is memory mapped, and the keyframe index is used to seek without
+ * reading the frames before the seek point.
+ */
+class BinaryShowLoader {
+ public:
+  explicit BinaryShowLoader(const std::string &filename);
+  ~BinaryShowLoader();
+
+  static bool IsBinaryShow(const std::string &filename);
+
+  bool Load();
+  void Reset();
+  unsigned int GetCurrentRecordNumber() const { return m_record_number; }
+
+  ShowLoader::State NextEntry(ShowEntry *entry);
+  bool SkipToKeyframe(uint64_t seek_time,
+                      uint64_t *position,
+                      std::vector<ShowEntry> *snapshot);
+
+ private:
+  typedef struct {
+    uint8_t type;
+    unsigned int delay;
+    unsigned int universe;
+    unsigned int size;
+    const uint8_t *payload;
+    uint64_t end;
+  } Record;
+
+  typedef std::map<unsigned int, ola::DmxBuffer> UniverseMap;
+
+  const std::string m_filename;
+  const uint8_t *m_data;
+  uint64_t m_size;
+  void *m_mapping;
+  std::string m_contents;
+  uint64_t m_records_end;
+  unsigned int m_index_size;
+  unsigned int m_final_wait;
+  uint64_t m_offset;
+  unsigned int m_record_number;
+  UniverseMap m_universes;
+
+  bool MapFile();
+  void UnmapFile();
+  void ReadFooter();
+  ShowLoader::State ParseRecord(uint64_t offset, Record *record) const;
+  bool ApplyRecord(const Record &record, UniverseMap *universes) const;
+  ShowLoader::State NextDelay(unsigned int *delay) const;
+  uint64_t IndexValue(unsigned int entry, unsigned int field) const;
+};
+#endif  // EXAMPLES_BINARYSHOWLOADER_H_
@@ -0,0 +1,258 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowSaver.cpp
+ * Writes show data to a binary show file.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+#include "examples/BinaryShowSaver.h"
+
+using ola::DmxBuffer;
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+/*
+ * Check if a slot differs from the previous frame. Slots past the end of the
+ * previous frame are compared to zero.
+ */
+bool SlotChanged(const DmxBuffer &previous, const DmxBuffer &data,
+                 unsigned int slot) {
+  uint8_t old_value = slot < previous.Size() ? previous.Get(slot) : 0;
+  return data.Get(slot) != old_value;
+}
+}  // namespace
+
+const unsigned int BinaryShowSaver::DEFAULT_KEYFRAME_INTERVAL;
+
+BinaryShowSaver::BinaryShowSaver(const string &filename,
+                                 unsigned int keyframe_interval)
+    : m_filename(filename),
+      m_keyframe_interval(keyframe_interval),
+      m_offset(0),
+      m_time(0),
+      m_last_keyframe(0) {
+}
+
+
+BinaryShowSaver::~BinaryShowSaver() {
+  Close();
+}
+
+
+/**
+ * Open the show file for writing.
+ * @returns true if we could open the file, false otherwise.
+ */
+bool BinaryShowSaver::Open() {
+  m_show_file.open(m_filename.data(), std::ios::out | std::ios::binary);
+  if (!m_show_file.is_open()) {
+    OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
+    return false;
+  }
+
+  uint8_t header[binary_show::HEADER_SIZE];
+  memcpy(header, binary_show::FILE_MAGIC, binary_show::MAGIC_SIZE);
+  binary_show::WriteUInt32(binary_show::FORMAT_VERSION,
+                           header + binary_show::MAGIC_SIZE);
+  return Write(string(reinterpret_cast<char*>(header), sizeof(header)));
+}
+
+
+/**
+ * Flush any buffered records to the file.
+ */
+void BinaryShowSaver::Flush() {
+  if (m_show_file.is_open()) {
+    m_show_file.flush();
+  }
+}
+
+
+/**
+ * Write the index and close the show file.
+ * @param final_wait the time in ms to wait after the last frame, or
+ *   NO_FINAL_WAIT if the show ends with the last frame.
+ */
+bool BinaryShowSaver::Close(unsigned int final_wait) {
+  if (!m_show_file.is_open()) {
+    return true;
+  }
+
+  const uint64_t index_offset = m_offset;
+  string output;
+  uint8_t entry[binary_show::INDEX_ENTRY_SIZE];
+  vector<IndexEntry>::const_iterator iter = m_index.begin();
+  for (; iter != m_index.end(); ++iter) {
+    binary_show::WriteUInt64(iter->time, entry);
+    binary_show::WriteUInt64(iter->offset, entry + 8);
+    output.append(reinterpret_cast<char*>(entry), sizeof(entry));
+  }
+
+  uint8_t footer[binary_show::FOOTER_SIZE];
+  binary_show::WriteUInt64(index_offset, footer);
+  binary_show::WriteUInt32(m_index.size(), footer + 8);
+  binary_show::WriteUInt32(final_wait, footer + 12);
+  memcpy(footer + 16, binary_show::FOOTER_MAGIC, binary_show::MAGIC_SIZE);
+  output.append(reinterpret_cast<char*>(footer), sizeof(footer));
+
+  bool ok = Write(output);
+  m_show_file.close();
+  m_index.clear();
+  m_universes.clear();
+  return ok;
+}
+
+
+/**
+ * Write a new frame
+ * @param delay the time in ms since the previous frame.
+ * @param universe the universe the frame is for.
+ * @param data the DMX data.
+ */
+bool BinaryShowSaver::NewFrame(unsigned int delay,
+                               unsigned int universe,
+                               const DmxBuffer &data) {
+  m_time += delay;
+  if (!m_universes.empty() &&
+      m_time - m_last_keyframe >= m_keyframe_interval) {
+    if (!WriteKeyframe()) {
+      return false;
+    }
+  }
+
+  map<unsigned int, DmxBuffer>::iterator iter = m_universes.find(universe);
+  if (iter == m_universes.end()) {
+    BuildRecord(binary_show::FULL_RECORD, delay, universe, DmxBuffer(), data);
+    m_universes[universe] = data;
+  } else {
+    BuildRecord(binary_show::DELTA_RECORD, delay, universe, iter->second,
+                data);
+    iter->second = data;
+  }
+  return Write(m_record);
+}
+
+
+/**
+ * Write the state of every universe, and add it to the index.
+ */
+bool BinaryShowSaver::WriteKeyframe() {
+  IndexEntry entry = {m_time, m_offset};
+  m_index.push_back(entry);
+  m_last_keyframe = m_time;
+
+  map<unsigned int, DmxBuffer>::const_iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    BuildRecord(binary_show::KEYFRAME_RECORD, 0, iter->first, DmxBuffer(),
+                iter->second);
+    if (!Write(m_record)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Build a record in m_record. A delta record is only used if it's smaller
+ * than the full frame.
+ */
+void BinaryShowSaver::BuildRecord(uint8_t type,
+                                  unsigned int delay,
+                                  unsigned int universe,
+                                  const DmxBuffer &previous,
+                                  const DmxBuffer &data) {
+  const unsigned int size = data.Size();
+  m_record.clear();
+
+  if (type == binary_show::DELTA_RECORD) {
+    // Runs that are closer than a run header are joined.
+    uint8_t buffer[ola::DMX_UNIVERSE_SIZE];
+    string runs;
+    uint16_t run_count = 0;
+    unsigned int i = 0;
+    while (i < size) {
+      if (!SlotChanged(previous, data, i)) {
+        i++;
+        continue;
+      }
+      unsigned int start = i;
+      unsigned int end = i + 1;
+      unsigned int same = 0;
+      for (i = end; i < size && same < binary_show::RUN_HEADER_SIZE; i++) {
+        if (SlotChanged(previous, data, i)) {
+          end = i + 1;
+          same = 0;
+        } else {
+          same++;
+        }
+      }
+      i = end;
+      binary_show::WriteUInt16(start, buffer);
+      binary_show::WriteUInt16(end - start, buffer + 2);
+      runs.append(reinterpret_cast<char*>(buffer), 4);
+      runs.append(reinterpret_cast<const char*>(data.GetRaw() + start),
+                  end - start);
+      run_count++;
+    }
+
+    if (runs.size() + 2 < size) {
+      uint8_t header[binary_show::RECORD_HEADER_SIZE + 2];
+      header[0] = binary_show::DELTA_RECORD;
+      binary_show::WriteUInt32(delay, header + 1);
+      binary_show::WriteUInt32(universe, header + 5);
+      binary_show::WriteUInt16(size, header + 9);
+      binary_show::WriteUInt16(run_count, header + 11);
+      m_record.append(reinterpret_cast<char*>(header), sizeof(header));
+      m_record.append(runs);
+      return;
+    }
+    type = binary_show::FULL_RECORD;
+  }
+
+  uint8_t header[binary_show::RECORD_HEADER_SIZE];
+  header[0] = type;
+  binary_show::WriteUInt32(delay, header + 1);
+  binary_show::WriteUInt32(universe, header + 5);
+  binary_show::WriteUInt16(size, header + 9);
+  m_record.append(reinterpret_cast<char*>(header), sizeof(header));
+  m_record.append(reinterpret_cast<const char*>(data.GetRaw()), size);
+}
+
+
+bool BinaryShowSaver::Write(const string &data) {
+  m_show_file.write(data.data(), data.size());
+  if (!m_show_file.good()) {
+    OLA_WARN << "Failed to write to " << m_filename << ": "
+             << strerror(errno);
+    return false;
+  }
+  m_offset += data.size();
+  return true;
+}
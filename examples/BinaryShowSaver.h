@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowSaver.h
+ * Writes show data to a binary show file.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/DmxBuffer.h>
+#include <stdint.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+
+#ifndef EXAMPLES_BINARYSHOWSAVER_H_
+#define EXAMPLES_BINARYSHOWSAVER_H_
+
+/**
+ * Write show data to a binary show file, see BinaryShowFormat.h.
+ */
+class BinaryShowSaver {
+ public:
+  explicit BinaryShowSaver(
+      const std::string &filename,
+      unsigned int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+  ~BinaryShowSaver();
+
+  bool Open();
+  bool Close(unsigned int final_wait = binary_show::NO_FINAL_WAIT);
+  void Flush();
+
+  bool NewFrame(unsigned int delay,
+                unsigned int universe,
+                const ola::DmxBuffer &data);
+
+  // The default time in ms between keyframes.
+  static const unsigned int DEFAULT_KEYFRAME_INTERVAL = 5000;
+
+ private:
+  typedef struct {
+    uint64_t time;
+    uint64_t offset;
+  } IndexEntry;
+
+  const std::string m_filename;
+  const unsigned int m_keyframe_interval;
+  std::ofstream m_show_file;
+  uint64_t m_offset;
+  uint64_t m_time;
+  uint64_t m_last_keyframe;
+  std::map<unsigned int, ola::DmxBuffer> m_universes;
+  std::vector<IndexEntry> m_index;
+  std::string m_record;
+
+  bool WriteKeyframe();
+  void BuildRecord(uint8_t type,
+                   unsigned int delay,
+                   unsigned int universe,
+                   const ola::DmxBuffer &previous,
+                   const ola::DmxBuffer &data);
+  bool Write(const std::string &data);
+};
+#endif  // EXAMPLES_BINARYSHOWSAVER_H_
@@ -72,6 +72,13 @@ examples_ola_rdm_discover_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 examples_ola_recorder_SOURCES = \
     examples/ola-recorder.cpp \
+    examples/ArtNetTimeCodeReceiver.h \
+    examples/ArtNetTimeCodeReceiver.cpp \
+    examples/BinaryShowFormat.h \
+    examples/BinaryShowLoader.h \
+    examples/BinaryShowLoader.cpp \
+    examples/BinaryShowSaver.h \
+    examples/BinaryShowSaver.cpp \
     examples/ShowLoader.h \
     examples/ShowLoader.cpp \
     examples/ShowPlayer.h \
@@ -79,7 +86,9 @@ examples_ola_recorder_SOURCES = \
     examples/ShowRecorder.h \
     examples/ShowRecorder.cpp \
     examples/ShowSaver.h \
-    examples/ShowSaver.cpp
+    examples/ShowSaver.cpp \
+    examples/ShowWriterThread.h \
+    examples/ShowWriterThread.cpp
 examples_ola_recorder_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 examples_ola_timecode_SOURCES = examples/ola-timecode.cpp
@@ -102,11 +111,26 @@ examples_ola_dmxmonitor_LDADD = $(EXAMPLE_COMMON_LIBS) -lncurses
 endif
 endif
 
-noinst_PROGRAMS += examples/ola_throughput examples/ola_latency
+noinst_PROGRAMS += examples/ola_bench examples/ola_throughput \
+                   examples/ola_latency examples/show_benchmark
+examples_ola_bench_SOURCES = examples/ola-bench.cpp
+examples_ola_bench_LDADD = common/web/libolaweb.la $(EXAMPLE_COMMON_LIBS)
 examples_ola_throughput_SOURCES = examples/ola-throughput.cpp
 examples_ola_throughput_LDADD = $(EXAMPLE_COMMON_LIBS)
 examples_ola_latency_SOURCES = examples/ola-latency.cpp
 examples_ola_latency_LDADD = $(EXAMPLE_COMMON_LIBS)
+examples_show_benchmark_SOURCES = \
+    examples/show-benchmark.cpp \
+    examples/BinaryShowFormat.h \
+    examples/BinaryShowLoader.h \
+    examples/BinaryShowLoader.cpp \
+    examples/BinaryShowSaver.h \
+    examples/BinaryShowSaver.cpp \
+    examples/ShowLoader.h \
+    examples/ShowLoader.cpp \
+    examples/ShowSaver.h \
+    examples/ShowSaver.cpp
+examples_show_benchmark_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 if USING_WIN32
 # rename this program, otherwise UAC will block it
@@ -141,11 +165,20 @@ EXTRA_DIST += \
 
 # TESTS
 ##################################################
-test_scripts += examples/RecorderVerifyTest.sh
+test_scripts += examples/RecorderVerifyTest.sh \
+                examples/RecorderConvertTest.sh
 
 examples/RecorderVerifyTest.sh: examples/Makefile.mk
 	echo "for FILE in ${srcdir}/examples/testdata/dos_line_endings ${srcdir}/examples/testdata/multiple_unis ${srcdir}/examples/testdata/partial_frames ${srcdir}/examples/testdata/single_uni ${srcdir}/examples/testdata/trailing_timeout; do echo \"Checking \$$FILE\"; ${top_builddir}/examples/ola_recorder${EXEEXT} --verify \$$FILE; STATUS=\$$?; if [ \$$STATUS -ne 0 ]; then echo \"FAIL: \$$FILE caused ola_recorder to exit with status \$$STATUS\"; exit \$$STATUS; fi; done; exit 0" > examples/RecorderVerifyTest.sh
 	chmod +x examples/RecorderVerifyTest.sh
 
-CLEANFILES += examples/RecorderVerifyTest.sh
+examples/RecorderConvertTest.sh: examples/Makefile.mk
+	echo "for FILE in ${srcdir}/examples/testdata/dos_line_endings ${srcdir}/examples/testdata/multiple_unis ${srcdir}/examples/testdata/partial_frames ${srcdir}/examples/testdata/single_uni ${srcdir}/examples/testdata/trailing_timeout; do echo \"Checking \$$FILE\"; BINARY=examples/RecorderConvertTest.show; ${top_builddir}/examples/ola_recorder${EXEEXT} --convert \$$FILE --output \$$BINARY || exit 1; ${top_builddir}/examples/ola_recorder${EXEEXT} --verify \$$FILE > \$$BINARY.text || exit 1; ${top_builddir}/examples/ola_recorder${EXEEXT} --verify \$$BINARY > \$$BINARY.binary || exit 1; if ! diff \$$BINARY.text \$$BINARY.binary; then echo \"FAIL: the converted \$$FILE doesn't match\"; exit 1; fi; done; exit 0" > examples/RecorderConvertTest.sh
+	chmod +x examples/RecorderConvertTest.sh
+
+CLEANFILES += examples/RecorderVerifyTest.sh \
+              examples/RecorderConvertTest.sh \
+              examples/RecorderConvertTest.show \
+              examples/RecorderConvertTest.show.binary \
+              examples/RecorderConvertTest.show.text
 endif
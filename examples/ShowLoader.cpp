@@ -35,6 +35,7 @@
 #include <string>
 #include <vector>
 
+#include "examples/BinaryShowLoader.h"
 #include "examples/ShowLoader.h"
 
 using std::vector;
@@ -62,6 +63,11 @@ ShowLoader::~ShowLoader() {
  * @returns true if we could open the file, false otherwise.
  */
 bool ShowLoader::Load() {
+  if (BinaryShowLoader::IsBinaryShow(m_filename)) {
+    m_binary_loader.reset(new BinaryShowLoader(m_filename));
+    return m_binary_loader->Load();
+  }
+
   m_show_file.open(m_filename.data());
   if (!m_show_file.is_open()) {
     OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
@@ -83,6 +89,10 @@ bool ShowLoader::Load() {
  * Reset to the start of the show
  */
 void ShowLoader::Reset() {
+  if (m_binary_loader.get()) {
+    m_binary_loader->Reset();
+    return;
+  }
   m_show_file.clear();
   m_show_file.seekg(0, std::ios::beg);
   // skip over the first line
@@ -95,10 +105,33 @@ void ShowLoader::Reset() {
  * @brief Get most recent line number read (1-indexed)
  */
 unsigned int ShowLoader::GetCurrentLineNumber() const {
+  if (m_binary_loader.get()) {
+    return m_binary_loader->GetCurrentRecordNumber();
+  }
   return m_line;
 }
 
 
+/**
+ * @brief Skip ahead to the last keyframe before @p seek_time.
+ *
+ * Only binary show files have keyframes.
+ * @param seek_time the time in ms to seek to.
+ * @param[in,out] position the current time in ms, this is updated to the time
+ *   of the keyframe.
+ * @param[out] snapshot the state of each universe at the keyframe.
+ * @returns true if the loader moved to a keyframe, false otherwise.
+ */
+bool ShowLoader::SkipToKeyframe(uint64_t seek_time,
+                                uint64_t *position,
+                                vector<ShowEntry> *snapshot) {
+  if (!m_binary_loader.get()) {
+    return false;
+  }
+  return m_binary_loader->SkipToKeyframe(seek_time, position, snapshot);
+}
+
+
 /**
  * Get the next time offset
  * @param timeout a pointer to the timeout in ms
@@ -132,20 +165,26 @@ ShowLoader::State ShowLoader::NextFrame(unsigned int *universe,
     return END_OF_FILE;
   }
 
-  vector<string> inputs;
-  ola::StringSplit(line, &inputs);
-
-  if (inputs.size() != 2) {
+  // The line is "<universe> <data>", parse it in place rather than splitting
+  // it into strings.
+  const string::size_type separator = line.find(' ');
+  if (separator == string::npos ||
+      line.find(' ', separator + 1) != string::npos) {
     OLA_WARN << "Line " << m_line << " invalid: " << line;
     return INVALID_LINE;
   }
 
-  if (!ola::StringToInt(inputs[0], universe, true)) {
+  const char *begin = line.data();
+  if (separator == 0 ||
+      ola::strings::ParseUInt(begin, begin + separator, universe) !=
+          begin + separator) {
     OLA_WARN << "Line " << m_line << " invalid: " << line;
     return INVALID_LINE;
   }
 
-  return (data->SetFromString(inputs[1]) ? OK : INVALID_LINE);
+  return (data->SetFromString(begin + separator + 1,
+                              line.size() - separator - 1) ?
+          OK : INVALID_LINE);
 }
 
 
@@ -154,6 +193,10 @@ ShowLoader::State ShowLoader::NextFrame(unsigned int *universe,
  * @param entry a ShowEntry to fill with data
  */
 ShowLoader::State ShowLoader::NextEntry(ShowEntry *entry) {
+  if (m_binary_loader.get()) {
+    return m_binary_loader->NextEntry(entry);
+  }
+
   State state = NextFrame(&entry->universe, &entry->buffer);
   if (state != OK) {
     return state;
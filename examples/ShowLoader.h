@@ -19,9 +19,12 @@
  */
 
 #include <ola/DmxBuffer.h>
+#include <stdint.h>
 
 #include <string>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #ifndef EXAMPLES_SHOWLOADER_H_
 #define EXAMPLES_SHOWLOADER_H_
@@ -36,7 +39,8 @@ struct ShowEntry {
 };
 
 /**
- * Loads a show file and reads the DMX data.
+ * Loads a show file and reads the DMX data. Both text and binary show files
+ * can be read.
  */
 class ShowLoader {
  public:
@@ -54,11 +58,17 @@ class ShowLoader {
   unsigned int GetCurrentLineNumber() const;
 
   State NextEntry(ShowEntry *entry);
+  bool SkipToKeyframe(uint64_t seek_time,
+                      uint64_t *position,
+                      std::vector<ShowEntry> *snapshot);
+
+  bool IsBinary() const { return m_binary_loader.get() != NULL; }
 
  private:
   const std::string m_filename;
   std::ifstream m_show_file;
   unsigned int m_line;
+  std::auto_ptr<class BinaryShowLoader> m_binary_loader;
 
   static const char OLA_SHOW_HEADER[];
 
@@ -25,24 +25,62 @@
 
 #include <errno.h>
 #include <string.h>
+#include <algorithm>
 #include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
 #include <ola/base/SysExits.h>
-#include <ola/client/ClientWrapper.h>
-#include <ola/client/OlaClient.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/timecode/TimeCode.h>
+#include <ola/timecode/TimeCodeEnums.h>
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <map>
 #include <vector>
 
+#include "examples/ArtNetTimeCodeReceiver.h"
 #include "examples/ShowPlayer.h"
 
 using std::vector;
 using std::string;
 using std::map;
 using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::client::StreamingClient;
+using ola::timecode::TimeCode;
+
+namespace {
+// Timecode that's closer than this to the playback position is followed by
+// adjusting the start time, otherwise playback seeks to the timecode.
+const int64_t MAX_TIMECODE_ADJUSTMENT_MS = 200;
+
+/*
+ * Convert a timecode to the time in ms.
+ */
+uint64_t TimeCodeToMilliSeconds(const TimeCode &timecode) {
+  unsigned int fps = 30;
+  switch (timecode.Type()) {
+    case ola::timecode::TIMECODE_FILM:
+      fps = 24;
+      break;
+    case ola::timecode::TIMECODE_EBU:
+      fps = 25;
+      break;
+    case ola::timecode::TIMECODE_DF:
+    case ola::timecode::TIMECODE_SMPTE:
+      fps = 30;
+      break;
+  }
+  uint64_t seconds = (timecode.Hours() * 60 + timecode.Minutes()) * 60 +
+                     timecode.Seconds();
+  return seconds * 1000 + timecode.Frames() * 1000 / fps;
+}
+}  // namespace
+
+const unsigned int ShowPlayer::LATE_THRESHOLD_MS;
 
 
 ShowPlayer::ShowPlayer(const string &filename)
@@ -55,6 +93,8 @@ ShowPlayer::ShowPlayer(const string &filename)
       m_playback_pos(0),
       m_run_time(0),
       m_simulate(false),
+      m_anchor_position(0),
+      m_next_timeout(ola::thread::INVALID_TIMEOUT),
       m_next_task(TASK_LOOP),
       m_status(ola::EXIT_SOFTWARE) {
 }
@@ -76,6 +116,13 @@ int ShowPlayer::Init(const bool simulate) {
 }
 
 
+bool ShowPlayer::LockToArtNetTimeCode() {
+  m_timecode_receiver.reset(new ArtNetTimeCodeReceiver(
+      &m_ss, ola::NewCallback(this, &ShowPlayer::NewTimeCode)));
+  return m_timecode_receiver->Start();
+}
+
+
 int ShowPlayer::Playback(unsigned int iterations,
                          uint64_t duration,
                          uint64_t delay,
@@ -89,16 +136,15 @@ int ShowPlayer::Playback(unsigned int iterations,
   m_status = ola::EXIT_SOFTWARE;
 
   if (!m_simulate) {
-    ola::io::SelectServer *ss = m_client.GetSelectServer();
     if (duration != 0) {
-      ss->RegisterSingleTimeout(
+      m_ss.RegisterSingleTimeout(
           duration * 1000,
-          ola::NewSingleCallback(ss, &ola::io::SelectServer::Terminate));
+          ola::NewSingleCallback(&m_ss, &ola::io::SelectServer::Terminate));
     }
     if ((SeekTo(m_start) != ShowLoader::OK)) {
       return ola::EXIT_DATAERR;
     }
-    ss->Run();
+    m_ss.Run();
   } else {
     // Never infinite loop when simulating
     if (iterations == 0 && duration == 0) {
@@ -139,7 +185,9 @@ int ShowPlayer::Playback(unsigned int iterations,
  * Restart playback from start point
  */
 void ShowPlayer::Loop() {
-  ShowLoader::State state = SeekTo(m_start);
+  m_next_timeout = ola::thread::INVALID_TIMEOUT;
+  ShowLoader::State state = SeekTo(m_start,
+                                   m_loop_time.IsSet() ? &m_loop_time : NULL);
 
   switch (state) {
     // Success conditions
@@ -162,8 +210,11 @@ void ShowPlayer::Loop() {
 /**
  * Seek to @p seek_time in the show file
  * @param seek_time the time (in milliseconds) to seek to
+ * @param start_time when @p seek_time should be played, or NULL to play it
+ *   now.
  */
-ShowLoader::State ShowPlayer::SeekTo(uint64_t seek_time) {
+ShowLoader::State ShowPlayer::SeekTo(uint64_t seek_time,
+                                     const TimeStamp *start_time) {
   // Seeking to a time before the playhead's position requires moving from the
   // beginning of the file.  This could be optimized more if this happens
   // frequently.
@@ -174,8 +225,19 @@ ShowLoader::State ShowPlayer::SeekTo(uint64_t seek_time) {
     m_playback_pos = 0;
   }
 
-  // Keep reading through the show file until desired time is reached.
+  // If the show file has an index, jump to the closest keyframe.
   map<unsigned int, ShowEntry> entries;
+  vector<ShowEntry> snapshot;
+  if (m_loader.SkipToKeyframe(seek_time, &m_playback_pos, &snapshot)) {
+    vector<ShowEntry>::const_iterator iter = snapshot.begin();
+    for (; iter != snapshot.end(); ++iter) {
+      if (iter->buffer.Size() > 0) {
+        entries[iter->universe] = *iter;
+      }
+    }
+  }
+
+  // Keep reading through the show file until desired time is reached.
   uint64_t playhead_time = m_playback_pos;
   ShowLoader::State state;
   bool found = false;
@@ -221,8 +283,17 @@ ShowLoader::State ShowPlayer::SeekTo(uint64_t seek_time) {
   // Send data in the state it would be in at the given time
   map<unsigned int, ShowEntry>::iterator entry_it;
   for (entry_it = entries.begin(); entry_it != entries.end(); ++entry_it) {
-    SendFrame(entry_it->second);
+    QueueFrame(entry_it->second);
   }
+  SendFrames();
+
+  if (start_time) {
+    m_anchor_time = *start_time;
+  } else {
+    m_clock.CurrentMonotonicTime(&m_anchor_time);
+  }
+  m_anchor_position = seek_time;
+
   // Adjust the timeout to handle landing in the middle of the entry's timeout
   RegisterNextTimeout(playhead_time-seek_time);
 
@@ -231,11 +302,30 @@ ShowLoader::State ShowPlayer::SeekTo(uint64_t seek_time) {
 
 
 /**
- * Send the next frame in the show file
+ * Send the next frame in the show file, along with any frames for other
+ * universes with the same timestamp.
  */
 void ShowPlayer::SendNextFrame() {
+  m_next_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!m_simulate) {
+    const int64_t lateness = -MicroSecondsUntil(m_playback_pos);
+    m_lateness.sends++;
+    if (lateness > 0) {
+      m_lateness.total_lateness += lateness;
+      m_lateness.max_lateness = std::max(m_lateness.max_lateness, lateness);
+      if (lateness > LATE_THRESHOLD_MS * 1000) {
+        m_lateness.late_sends++;
+      }
+    }
+  }
+
   ShowEntry entry;
   ShowLoader::State state = m_loader.NextEntry(&entry);
+  while (state == ShowLoader::OK && entry.next_wait == 0) {
+    QueueFrame(entry);
+    entry = ShowEntry();
+    state = m_loader.NextEntry(&entry);
+  }
 
   if (state == ShowLoader::OK) {
     m_status = ola::EXIT_OK;
@@ -245,11 +335,13 @@ void ShowPlayer::SendNextFrame() {
     // At EOF or at user-requested stopping point
     if (m_stop == 0 || m_playback_pos == m_stop) {
       // Send the last frame before looping/exiting
-      SendFrame(entry);
+      QueueFrame(entry);
     }
+    SendFrames();
     HandleEndOfShow();
     return;
   } else if (state == ShowLoader::INVALID_LINE) {
+    SendFrames();
     HandleInvalidLine();
     return;
   } else {
@@ -267,7 +359,8 @@ void ShowPlayer::SendNextFrame() {
  */
 void ShowPlayer::SendEntry(const ShowEntry &entry) {
   // Send DMX data
-  SendFrame(entry);
+  QueueFrame(entry);
+  SendFrames();
   m_playback_pos += entry.next_wait;
 
   // Set when next to send data
@@ -277,36 +370,104 @@ void ShowPlayer::SendEntry(const ShowEntry &entry) {
 
 /**
  * Send the next frame in @p timeout milliseconds
+ *
+ * The timeout is calculated from the start time rather than the current time,
+ * so any delay in running this doesn't carry over to the following frames.
  */
 void ShowPlayer::RegisterNextTimeout(const unsigned int timeout) {
   m_run_time += timeout;
   m_next_task = TASK_NEXT_FRAME;
   if (!m_simulate) {
-    OLA_DEBUG << "Registering timeout for " << timeout << "ms";
-    m_client.GetSelectServer()->RegisterSingleTimeout(
-        timeout,
+    const int64_t delay = std::max(MicroSecondsUntil(m_playback_pos),
+                                   static_cast<int64_t>(0));
+    OLA_DEBUG << "Registering timeout for " << delay << "us";
+    m_next_timeout = m_ss.RegisterSingleTimeout(
+        TimeInterval(delay),
         ola::NewSingleCallback(this, &ShowPlayer::SendNextFrame));
   }
 }
 
 
 /**
- * Send data contained in @p entry
+ * Get the time until @p show_time should be played, this is negative if it's
+ * in the past.
+ */
+int64_t ShowPlayer::MicroSecondsUntil(uint64_t show_time) const {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  const int64_t offset = (static_cast<int64_t>(show_time) -
+                          static_cast<int64_t>(m_anchor_position)) * 1000;
+  return offset - (now - m_anchor_time).AsInt();
+}
+
+
+/**
+ * Add the data contained in @p entry to the next batch
  */
-void ShowPlayer::SendFrame(const ShowEntry &entry) {
+void ShowPlayer::QueueFrame(const ShowEntry &entry) {
   if (entry.buffer.Size() == 0) {
     return;
   }
   if (!m_simulate) {
     OLA_DEBUG << "Universe: " << entry.universe << ": "
               << entry.buffer.ToString();
-    ola::client::SendDMXArgs args;
-    m_client.GetClient()->SendDMX(entry.universe, entry.buffer, args);
+    m_batch.push_back(
+        StreamingClient::UniverseData(entry.universe, entry.buffer));
   }
   m_frame_count[entry.universe]++;
 }
 
 
+/**
+ * Send the batch of frames
+ */
+void ShowPlayer::SendFrames() {
+  if (m_batch.empty()) {
+    return;
+  }
+  if (!m_client.SendDmxBatch(m_batch)) {
+    OLA_WARN << "Failed to send DMX data";
+  }
+  m_batch.clear();
+}
+
+
+/**
+ * Follow the timecode.
+ */
+void ShowPlayer::NewTimeCode(const TimeCode &timecode) {
+  if (m_next_task != TASK_NEXT_FRAME) {
+    // Waiting to loop, or stopped.
+    return;
+  }
+
+  const uint64_t show_time = TimeCodeToMilliSeconds(timecode);
+  if (show_time < m_start || (m_stop > 0 && show_time > m_stop)) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  const int64_t position = static_cast<int64_t>(m_anchor_position) +
+                           (now - m_anchor_time).InMilliSeconds();
+  const int64_t difference = static_cast<int64_t>(show_time) - position;
+  if (difference <= MAX_TIMECODE_ADJUSTMENT_MS &&
+      difference >= -MAX_TIMECODE_ADJUSTMENT_MS) {
+    // Adjust the start time; this applies from the next frame.
+    m_anchor_time = now;
+    m_anchor_position = show_time;
+    return;
+  }
+
+  OLA_INFO << "Seeking to timecode " << timecode;
+  m_ss.RemoveTimeout(m_next_timeout);
+  m_next_timeout = ola::thread::INVALID_TIMEOUT;
+  if (SeekTo(show_time) != ShowLoader::OK) {
+    HandleEndOfShow();
+  }
+}
+
+
 /**
  * Handle the case where we reach the end of file
  */
@@ -337,8 +498,14 @@ void ShowPlayer::HandleEndOfShow() {
                << m_iteration_remaining << " iteration(s) remain "
                << "-----";
       OLA_INFO << "----- Waiting " << loop_delay << " ms before looping -----";
-      m_client.GetSelectServer()->RegisterSingleTimeout(
-          loop_delay,
+      // The next iteration starts relative to the end of this one.
+      const int64_t delay = std::max(
+          MicroSecondsUntil(m_playback_pos + loop_delay),
+          static_cast<int64_t>(0));
+      m_clock.CurrentMonotonicTime(&m_loop_time);
+      m_loop_time += TimeInterval(delay);
+      m_next_timeout = m_ss.RegisterSingleTimeout(
+          TimeInterval(delay),
           ola::NewSingleCallback(this, &ShowPlayer::Loop));
     }
     return;
@@ -365,6 +532,6 @@ void ShowPlayer::StopPlayback(const int exit_status) {
   m_next_task = TASK_COMPLETE;
   m_status = exit_status;
   if (!m_simulate) {
-    m_client.GetSelectServer()->Terminate();
+    m_ss.Terminate();
   }
 }
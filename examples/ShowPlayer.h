@@ -18,20 +18,51 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
-#include <ola/client/ClientWrapper.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/io/SelectServer.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <ola/timecode/TimeCode.h>
+#include <stdint.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <fstream>
+#include <vector>
 
 #include "examples/ShowLoader.h"
 
 #ifndef EXAMPLES_SHOWPLAYER_H_
 #define EXAMPLES_SHOWPLAYER_H_
 
+/**
+ * @brief How late the frames were sent during playback.
+ */
+struct PlaybackLateness {
+  PlaybackLateness()
+      : sends(0),
+        late_sends(0),
+        total_lateness(0),
+        max_lateness(0) {
+  }
+
+  uint64_t sends;
+  // The sends that were more than ShowPlayer::LATE_THRESHOLD_MS late.
+  uint64_t late_sends;
+  // In microseconds.
+  int64_t total_lateness;
+  int64_t max_lateness;
+};
+
 /**
  * @brief A class which plays back recorded show files.
+ *
+ * Frames are scheduled against a fixed start time, rather than relative to
+ * the previous frame, so timer latency doesn't accumulate over a long show.
+ * Frames for different universes with the same timestamp are sent as a
+ * single batch.
  */
 class ShowPlayer {
  public:
@@ -50,6 +81,16 @@ class ShowPlayer {
    */
   int Init(bool simulate = false);
 
+  /**
+   * @brief Follow the Art-Net timecode received on this host.
+   *
+   * Small differences from the timecode are corrected by adjusting the start
+   * time, larger ones cause playback to seek to the timecode. If the
+   * timecode stops, playback continues from the last position.
+   * @return true if the timecode receiver was set up.
+   */
+  bool LockToArtNetTimeCode();
+
   /**
    * @brief Playback the show
    * @param iterations the number of iterations of the show to play.
@@ -77,8 +118,17 @@ class ShowPlayer {
   }
 
 
+  const PlaybackLateness &GetLateness() const {
+    return m_lateness;
+  }
+
+  // A send later than this is counted as late.
+  static const unsigned int LATE_THRESHOLD_MS = 5;
+
  private:
-  ola::client::OlaClientWrapper m_client;
+  ola::io::SelectServer m_ss;
+  ola::client::StreamingClient m_client;
+  ola::Clock m_clock;
   ShowLoader m_loader;
   bool m_infinite_loop;
   unsigned int m_iteration_remaining;
@@ -90,6 +140,15 @@ class ShowPlayer {
   std::map<unsigned int, uint64_t> m_frame_count;
   bool m_simulate;
 
+  // The show time m_anchor_position (in ms) is played at m_anchor_time.
+  ola::TimeStamp m_anchor_time;
+  uint64_t m_anchor_position;
+  ola::TimeStamp m_loop_time;
+  ola::thread::timeout_id m_next_timeout;
+  std::vector<ola::client::StreamingClient::UniverseData> m_batch;
+  PlaybackLateness m_lateness;
+  std::auto_ptr<class ArtNetTimeCodeReceiver> m_timecode_receiver;
+
   /** Used for tracking simulation progress */
   typedef enum {
     TASK_COMPLETE,
@@ -100,11 +159,15 @@ class ShowPlayer {
   int m_status;
 
   void Loop();
-  ShowLoader::State SeekTo(uint64_t seek_time);
+  ShowLoader::State SeekTo(uint64_t seek_time,
+                           const ola::TimeStamp *start_time = NULL);
   void SendNextFrame();
   void SendEntry(const ShowEntry &entry);
   void RegisterNextTimeout(unsigned int timeout);
-  void SendFrame(const ShowEntry &entry);
+  int64_t MicroSecondsUntil(uint64_t show_time) const;
+  void QueueFrame(const ShowEntry &entry);
+  void SendFrames();
+  void NewTimeCode(const ola::timecode::TimeCode &timecode);
   void HandleEndOfShow();
   void HandleInvalidLine();
   void StopPlayback(int exit_status);
@@ -47,10 +47,12 @@ using std::vector;
 
 
 ShowRecorder::ShowRecorder(const string &filename,
-                           const vector<unsigned int> &universes)
-    : m_saver(filename),
-      m_universes(universes),
-      m_frame_count(0) {
+                           const vector<unsigned int> &universes,
+                           bool binary,
+                           bool skip_unchanged)
+    : m_saver(filename, binary),
+      m_writer(&m_saver, skip_unchanged),
+      m_universes(universes) {
 }
 
 
@@ -71,6 +73,11 @@ int ShowRecorder::Init() {
     return ola::EXIT_CANTCREAT;
   }
 
+  if (!m_writer.Start()) {
+    OLA_FATAL << "Failed to start the writer thread";
+    return ola::EXIT_OSERR;
+  }
+
   m_client.GetClient()->SetDMXCallback(
       ola::NewCallback(this, &ShowRecorder::NewFrame));
 
@@ -91,6 +98,11 @@ int ShowRecorder::Init() {
  */
 int ShowRecorder::Record() {
   m_client.GetSelectServer()->Run();
+
+  ola::TimeStamp end_time;
+  m_clock.CurrentMonotonicTime(&end_time);
+  m_writer.Stop();
+  m_saver.Close(&end_time);
   return ola::EXIT_OK;
 }
 
@@ -110,8 +122,7 @@ void ShowRecorder::NewFrame(const ola::client::DMXMetadata &meta,
                             const ola::DmxBuffer &data) {
   ola::TimeStamp now;
   m_clock.CurrentMonotonicTime(&now);
-  m_saver.NewFrame(now, meta.universe, data);
-  m_frame_count++;
+  m_writer.NewFrame(now, meta.universe, data);
 }
 
 
@@ -27,31 +27,40 @@
 #include <vector>
 
 #include "examples/ShowSaver.h"
+#include "examples/ShowWriterThread.h"
 
 #ifndef EXAMPLES_SHOWRECORDER_H_
 #define EXAMPLES_SHOWRECORDER_H_
 
 /**
- * The show player class
+ * The show recorder class
+ *
+ * Frames are captured on the client's thread and written to the file by a
+ * ShowWriterThread.
  */
 class ShowRecorder {
  public:
   ShowRecorder(const std::string &filename,
-               const std::vector<unsigned int> &universes);
+               const std::vector<unsigned int> &universes,
+               bool binary = false,
+               bool skip_unchanged = true);
   ~ShowRecorder();
 
   int Init();
   int Record();
   void Stop();
 
-  uint64_t FrameCount() const { return m_frame_count; }
+  // These are only valid once Record() returns.
+  uint64_t FrameCount() const { return m_writer.WrittenFrames(); }
+  uint64_t SkippedFrames() const { return m_writer.SkippedFrames(); }
+  uint64_t DroppedFrames() const { return m_writer.DroppedFrames(); }
 
  private:
   ola::client::OlaClientWrapper m_client;
   ShowSaver m_saver;
+  ShowWriterThread m_writer;
   std::vector<unsigned int> m_universes;
   ola::Clock m_clock;
-  uint64_t m_frame_count;
 
   void NewFrame(const ola::client::DMXMetadata &meta,
                 const ola::DmxBuffer &data);
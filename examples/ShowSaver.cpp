@@ -31,6 +31,7 @@
 #include <iostream>
 #include <string>
 
+#include "examples/BinaryShowSaver.h"
 #include "examples/ShowSaver.h"
 
 using std::string;
@@ -40,8 +41,9 @@ using std::endl;
 
 const char ShowSaver::OLA_SHOW_HEADER[] = "OLA Show";
 
-ShowSaver::ShowSaver(const string &filename)
-    : m_filename(filename) {
+ShowSaver::ShowSaver(const string &filename, bool binary)
+    : m_filename(filename),
+      m_binary_saver(binary ? new BinaryShowSaver(filename) : NULL) {
 }
 
 
@@ -55,6 +57,10 @@ ShowSaver::~ShowSaver() {
  * @returns true if we could open the file, false otherwise.
  */
 bool ShowSaver::Open() {
+  if (m_binary_saver.get()) {
+    return m_binary_saver->Open();
+  }
+
   m_show_file.open(m_filename.data());
   if (!m_show_file.is_open()) {
     OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
@@ -69,11 +75,37 @@ bool ShowSaver::Open() {
 
 /**
  * Close the show file
+ * @param end_time if not NULL, the time the recording ended. The last frame is
+ *   held until then on playback.
  */
-void ShowSaver::Close() {
+void ShowSaver::Close(const ola::TimeStamp *end_time) {
+  unsigned int final_wait = binary_show::NO_FINAL_WAIT;
+  if (end_time && m_last_frame.IsSet() && *end_time > m_last_frame) {
+    final_wait = (*end_time - m_last_frame).InMilliSeconds();
+  }
+
+  if (m_binary_saver.get()) {
+    m_binary_saver->Close(final_wait);
+  }
   if (m_show_file.is_open()) {
+    if (final_wait != binary_show::NO_FINAL_WAIT) {
+      m_show_file << final_wait << endl;
+    }
     m_show_file.close();
   }
+  m_last_frame = ola::TimeStamp();
+}
+
+
+/**
+ * Flush any buffered frames to the file.
+ */
+void ShowSaver::Flush() {
+  if (m_binary_saver.get()) {
+    m_binary_saver->Flush();
+  } else if (m_show_file.is_open()) {
+    m_show_file.flush();
+  }
 }
 
 
@@ -84,6 +116,15 @@ bool ShowSaver::NewFrame(const ola::TimeStamp &arrival_time,
                          unsigned int universe,
                          const ola::DmxBuffer &data) {
   // TODO(simon): add much better error handling here
+  if (m_binary_saver.get()) {
+    unsigned int delay = 0;
+    if (m_last_frame.IsSet()) {
+      delay = (arrival_time - m_last_frame).InMilliSeconds();
+    }
+    m_last_frame = arrival_time;
+    return m_binary_saver->NewFrame(delay, universe, data);
+  }
+
   if (m_last_frame.IsSet()) {
     // this is not the first frame so write the delay in ms
     const ola::TimeInterval delta = arrival_time - m_last_frame;
@@ -91,6 +132,7 @@ bool ShowSaver::NewFrame(const ola::TimeStamp &arrival_time,
     m_show_file << delta.InMilliSeconds() << endl;
   }
   m_last_frame = arrival_time;
-  m_show_file << universe << " " << data.ToString() << endl;
+  data.ToString(&m_frame_text);
+  m_show_file << universe << " " << m_frame_text << endl;
   return true;
 }
@@ -23,20 +23,22 @@
 
 #include <string>
 #include <fstream>
+#include <memory>
 
 #ifndef EXAMPLES_SHOWSAVER_H_
 #define EXAMPLES_SHOWSAVER_H_
 
 /**
- * Write show data to a file.
+ * Write show data to a file, in either the text or the binary format.
  */
 class ShowSaver {
  public:
-  explicit ShowSaver(const std::string &filename);
+  explicit ShowSaver(const std::string &filename, bool binary = false);
   ~ShowSaver();
 
   bool Open();
-  void Close();
+  void Close(const ola::TimeStamp *end_time = NULL);
+  void Flush();
 
   bool NewFrame(const ola::TimeStamp &arrival_time,
                 unsigned int universe,
@@ -46,6 +48,8 @@ class ShowSaver {
   const std::string m_filename;
   std::ofstream m_show_file;
   ola::TimeStamp m_last_frame;
+  std::string m_frame_text;  // re-used to avoid allocating for each frame
+  std::auto_ptr<class BinaryShowSaver> m_binary_saver;
 
   static const char OLA_SHOW_HEADER[];
 };
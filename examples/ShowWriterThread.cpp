@@ -0,0 +1,145 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ShowWriterThread.cpp
+ * Writes captured frames to a show file from a separate thread.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/thread/Mutex.h>
+
+#include "examples/ShowWriterThread.h"
+
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::MutexLocker;
+
+const unsigned int ShowWriterThread::DEFAULT_QUEUE_SIZE;
+const unsigned int ShowWriterThread::WRITE_INTERVAL_MS;
+
+ShowWriterThread::ShowWriterThread(ShowSaver *saver,
+                                   bool skip_unchanged,
+                                   unsigned int queue_size)
+    : Thread(Thread::Options("show-writer")),
+      m_saver(saver),
+      m_skip_unchanged(skip_unchanged),
+      m_queue(queue_size),
+      m_terminate(false),
+      m_skipped_frames(0),
+      m_dropped_frames(0),
+      m_written_frames(0) {
+}
+
+
+ShowWriterThread::~ShowWriterThread() {
+  Stop();
+}
+
+
+bool ShowWriterThread::Start() {
+  return Thread::Start();
+}
+
+
+/**
+ * Stop the thread, this writes any frames that are still queued.
+ */
+void ShowWriterThread::Stop() {
+  if (!IsRunning()) {
+    return;
+  }
+  {
+    MutexLocker lock(&m_mutex);
+    m_terminate = true;
+  }
+  m_condition.Signal();
+  Join();
+}
+
+
+bool ShowWriterThread::NewFrame(const TimeStamp &arrival_time,
+                                unsigned int universe,
+                                const DmxBuffer &data) {
+  if (m_skip_unchanged) {
+    std::map<unsigned int, DmxBuffer>::const_iterator iter =
+        m_last_frames.find(universe);
+    if (iter != m_last_frames.end() && iter->second == data) {
+      m_skipped_frames++;
+      return true;
+    }
+  }
+
+  m_frame.arrival_time = arrival_time;
+  m_frame.universe = universe;
+  m_frame.size = sizeof(m_frame.data);
+  data.Get(m_frame.data, &m_frame.size);
+  if (!m_queue.Push(m_frame)) {
+    m_dropped_frames++;
+    return false;
+  }
+
+  if (m_skip_unchanged) {
+    // Only remember frames that were queued, so a dropped change isn't
+    // skipped when it's received again.
+    m_last_frames[universe].Set(data);
+  }
+  return true;
+}
+
+
+void *ShowWriterThread::Run() {
+  bool terminate = false;
+  while (!terminate) {
+    {
+      MutexLocker lock(&m_mutex);
+      if (!m_terminate) {
+        // TimedWait() expects an absolute real time.
+        TimeStamp wake_up_time;
+        m_clock.CurrentRealTime(&wake_up_time);
+        wake_up_time += TimeInterval(WRITE_INTERVAL_MS * 1000);
+        m_condition.TimedWait(&m_mutex, wake_up_time);
+      }
+      terminate = m_terminate;
+    }
+    WriteFrames();
+  }
+  return NULL;
+}
+
+
+/**
+ * Write all the queued frames, then flush the file.
+ */
+void ShowWriterThread::WriteFrames() {
+  bool wrote_frames = false;
+  while (m_queue.Pop(&m_write_frame)) {
+    m_write_buffer.Set(m_write_frame.data, m_write_frame.size);
+    if (!m_saver->NewFrame(m_write_frame.arrival_time,
+                           m_write_frame.universe,
+                           m_write_buffer)) {
+      OLA_WARN << "Failed to write frame for universe "
+               << m_write_frame.universe;
+    }
+    m_written_frames++;
+    wrote_frames = true;
+  }
+  if (wrote_frames) {
+    m_saver->Flush();
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ShowWriterThread.h
+ * Writes captured frames to a show file from a separate thread.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/SPSCQueue.h>
+#include <ola/thread/Thread.h>
+#include <stdint.h>
+
+#include <map>
+
+#include "examples/ShowSaver.h"
+
+#ifndef EXAMPLES_SHOWWRITERTHREAD_H_
+#define EXAMPLES_SHOWWRITERTHREAD_H_
+
+/**
+ * @brief Write frames to a ShowSaver from a separate thread.
+ *
+ * The capture thread copies each frame into a lock-free ring with NewFrame(),
+ * so it never waits on the disk. The writer thread empties the ring every
+ * WRITE_INTERVAL_MS and flushes the file once per batch. If the ring is full
+ * the frame is dropped and counted.
+ *
+ * Frames that are identical to the last frame captured for the universe can
+ * be skipped, since playback holds the last value anyway.
+ */
+class ShowWriterThread : private ola::thread::Thread {
+ public:
+  ShowWriterThread(ShowSaver *saver,
+                   bool skip_unchanged,
+                   unsigned int queue_size = DEFAULT_QUEUE_SIZE);
+  ~ShowWriterThread();
+
+  bool Start();
+  void Stop();
+
+  /**
+   * @brief Queue a frame to be written, this must only be called from the
+   *   capture thread.
+   * @returns false if the frame was dropped.
+   */
+  bool NewFrame(const ola::TimeStamp &arrival_time,
+                unsigned int universe,
+                const ola::DmxBuffer &data);
+
+  // These must only be called once the thread has been stopped.
+  uint64_t WrittenFrames() const { return m_written_frames; }
+  uint64_t SkippedFrames() const { return m_skipped_frames; }
+  uint64_t DroppedFrames() const { return m_dropped_frames; }
+
+  // Enough for 100 universes at 44Hz for a little over 3 seconds.
+  static const unsigned int DEFAULT_QUEUE_SIZE = 16384;
+  static const unsigned int WRITE_INTERVAL_MS = 100;
+
+ protected:
+  void *Run();
+
+ private:
+  typedef struct {
+    ola::TimeStamp arrival_time;
+    unsigned int universe;
+    unsigned int size;
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  } CapturedFrame;
+
+  ShowSaver *m_saver;
+  const bool m_skip_unchanged;
+  ola::thread::SPSCQueue<CapturedFrame> m_queue;
+  ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_condition;
+  bool m_terminate;
+  ola::Clock m_clock;
+
+  // Only used by the capture thread.
+  std::map<unsigned int, ola::DmxBuffer> m_last_frames;
+  CapturedFrame m_frame;
+  uint64_t m_skipped_frames;
+  uint64_t m_dropped_frames;
+
+  // Only used by the writer thread.
+  CapturedFrame m_write_frame;
+  ola::DmxBuffer m_write_buffer;
+  uint64_t m_written_frames;
+
+  void WriteFrames();
+
+  DISALLOW_COPY_AND_ASSIGN(ShowWriterThread);
+};
+#endif  // EXAMPLES_SHOWWRITERTHREAD_H_
@@ -0,0 +1,728 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ola-bench.cpp
+ * Load test olad with many universes and measure the end to end latency.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/StringUtils.h>
+#include <ola/acn/ACNPort.h>
+#include <ola/base/Flags.h>
+#include <ola/base/Init.h>
+#include <ola/base/Macro.h>
+#include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/client/OlaClient.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/io/SelectServer.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/NetworkUtils.h>
+#include <ola/network/Socket.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/stl/STLUtils.h>
+#include <ola/web/Json.h>
+#include <ola/web/JsonWriter.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::client::DMXMetadata;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::client::SendDMXArgs;
+using ola::client::StreamingClient;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
+using ola::web::JsonArray;
+using ola::web::JsonObject;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_uint32(universes, 4, "The number of universes to send.");
+DEFINE_uint32(start_universe, 1, "The first universe to send.");
+DEFINE_uint32(rate, 44, "The number of frames per second for each universe.");
+DEFINE_uint32(duration, 10, "How long to send for, in seconds.");
+DEFINE_uint16(slots, ola::DMX_UNIVERSE_SIZE,
+              "The number of slots in each frame.");
+DEFINE_string(transports, "streaming",
+              "A comma separated list of the transports to send with, from "
+              "streaming, client, artnet and e131. The universes are shared "
+              "between them in turn.");
+DEFINE_string(target, "127.0.0.1",
+              "The IP address to send Art-Net and E1.31 to. olad must have "
+              "an input port for the universe patched to each OLA universe.");
+DEFINE_uint32(olad_pid, 0,
+              "The pid of olad, used to report its CPU time. Linux only.");
+DEFINE_default_bool(json, false, "Print the results as JSON.");
+
+namespace {
+
+/*
+ * The start of each frame holds a sequence number followed by the time it
+ * was sent, in microseconds. Both are big endian.
+ */
+enum {
+  SEQUENCE_OFFSET = 0,
+  TIMESTAMP_OFFSET = 4,
+  HEADER_SIZE = 12,
+};
+
+// How long to wait for the last frames to arrive.
+const unsigned int DRAIN_TIME_MS = 1000;
+
+void PackUInt32(uint32_t value, uint8_t *data) {
+  for (int i = 3; i >= 0; i--) {
+    data[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+void PackUInt64(uint64_t value, uint8_t *data) {
+  for (int i = 7; i >= 0; i--) {
+    data[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+uint64_t UnpackUInt(const uint8_t *data, unsigned int size) {
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < size; i++) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+/*
+ * Read the CPU time used by a process from /proc.
+ * @returns true if the time was read, false otherwise.
+ */
+bool ReadProcessCPUTime(unsigned int pid, double *seconds) {
+  std::ifstream stat_file(
+      ("/proc/" + ola::strings::IntToString(pid) + "/stat").c_str());
+  string stats;
+  if (!std::getline(stat_file, stats)) {
+    return false;
+  }
+  // The command name may contain spaces, so start after the closing bracket.
+  string::size_type start = stats.rfind(')');
+  if (start == string::npos) {
+    return false;
+  }
+  vector<string> fields;
+  ola::StringSplit(stats.substr(start + 2), &fields, " ");
+  // utime and stime are fields 14 & 15 of the file, so 12 & 13 here.
+  unsigned int utime, stime;
+  if (fields.size() < 14 ||
+      !ola::StringToInt(fields[11], &utime) ||
+      !ola::StringToInt(fields[12], &stime)) {
+    return false;
+  }
+  long ticks_per_second = sysconf(_SC_CLK_TCK);  // NOLINT(runtime/int)
+  *seconds = static_cast<double>(utime + stime) / ticks_per_second;
+  return true;
+}
+}  // namespace
+
+
+/**
+ * A way of sending DMX data to olad.
+ */
+class Transport {
+ public:
+  virtual ~Transport() {}
+
+  virtual string Name() const = 0;
+  virtual bool Setup() = 0;
+  virtual bool Send(unsigned int universe, const DmxBuffer &data) = 0;
+};
+
+
+/**
+ * Send with the StreamingClient.
+ */
+class StreamingTransport : public Transport {
+ public:
+  StreamingTransport() : m_client(StreamingClient::Options()) {}
+
+  string Name() const { return "streaming"; }
+  bool Setup() { return m_client.Setup(); }
+
+  bool Send(unsigned int universe, const DmxBuffer &data) {
+    return m_client.SendDmx(universe, data);
+  }
+
+ private:
+  StreamingClient m_client;
+};
+
+
+/**
+ * Send with the full client, using the same connection the data is received
+ * on.
+ */
+class ClientTransport : public Transport {
+ public:
+  explicit ClientTransport(ola::client::OlaClient *client)
+      : m_client(client) {
+  }
+
+  string Name() const { return "client"; }
+  bool Setup() { return true; }
+
+  bool Send(unsigned int universe, const DmxBuffer &data) {
+    m_client->SendDMX(universe, data, SendDMXArgs());
+    return true;
+  }
+
+ private:
+  ola::client::OlaClient *m_client;
+};
+
+
+/**
+ * The base class for the transports that send UDP packets to olad's input
+ * ports.
+ */
+class UDPTransport : public Transport {
+ public:
+  UDPTransport(const IPV4Address &target, uint16_t port)
+      : m_target(target, port) {
+  }
+
+  bool Setup() { return m_socket.Init(); }
+
+  bool Send(unsigned int universe, const DmxBuffer &data) {
+    unsigned int size = BuildPacket(universe, data, m_packet, sizeof(m_packet));
+    ssize_t sent = m_socket.SendTo(m_packet, size, m_target);
+    return sent == static_cast<ssize_t>(size);
+  }
+
+ protected:
+  // The sequence number for each universe.
+  std::map<unsigned int, uint8_t> m_sequence_numbers;
+
+  virtual unsigned int BuildPacket(unsigned int universe,
+                                   const DmxBuffer &data,
+                                   uint8_t *packet,
+                                   unsigned int packet_size) = 0;
+
+ private:
+  const IPV4SocketAddress m_target;
+  UDPSocket m_socket;
+  uint8_t m_packet[ola::DMX_UNIVERSE_SIZE + 128];
+};
+
+
+/**
+ * Send ArtDmx packets. The OLA universe is used as the Art-Net port address.
+ */
+class ArtNetTransport : public UDPTransport {
+ public:
+  explicit ArtNetTransport(const IPV4Address &target)
+      : UDPTransport(target, ARTNET_PORT) {
+  }
+
+  string Name() const { return "artnet"; }
+
+ protected:
+  unsigned int BuildPacket(unsigned int universe,
+                           const DmxBuffer &data,
+                           uint8_t *packet,
+                           unsigned int packet_size);
+
+ private:
+  static const uint16_t ARTNET_PORT = 6454;
+  static const uint16_t OP_DMX = 0x5000;
+  static const uint16_t PROTOCOL_VERSION = 14;
+  static const unsigned int HEADER_SIZE = 18;
+};
+
+
+unsigned int ArtNetTransport::BuildPacket(unsigned int universe,
+                                          const DmxBuffer &data,
+                                          uint8_t *packet,
+                                          unsigned int packet_size) {
+  unsigned int length = packet_size - HEADER_SIZE;
+  data.Get(packet + HEADER_SIZE, &length);
+  // The length must be even.
+  if (length % 2) {
+    packet[HEADER_SIZE + length++] = 0;
+  }
+
+  memcpy(packet, "Art-Net", 8);
+  packet[8] = OP_DMX & 0xff;
+  packet[9] = OP_DMX >> 8;
+  packet[10] = PROTOCOL_VERSION >> 8;
+  packet[11] = PROTOCOL_VERSION & 0xff;
+  packet[12] = ++m_sequence_numbers[universe];
+  packet[13] = 0;
+  packet[14] = universe & 0xff;
+  packet[15] = (universe >> 8) & 0x7f;
+  packet[16] = length >> 8;
+  packet[17] = length & 0xff;
+  return HEADER_SIZE + length;
+}
+
+
+/**
+ * Send E1.31 data packets.
+ */
+class E131Transport : public UDPTransport {
+ public:
+  explicit E131Transport(const IPV4Address &target)
+      : UDPTransport(target, ola::acn::ACN_PORT) {
+  }
+
+  string Name() const { return "e131"; }
+
+ protected:
+  unsigned int BuildPacket(unsigned int universe,
+                           const DmxBuffer &data,
+                           uint8_t *packet,
+                           unsigned int packet_size);
+
+ private:
+  static const unsigned int HEADER_SIZE = 126;
+  static const uint8_t PRIORITY = 100;
+
+  static void SetFlagsAndLength(uint8_t *ptr, unsigned int length) {
+    ptr[0] = 0x70 | ((length >> 8) & 0x0f);
+    ptr[1] = length & 0xff;
+  }
+};
+
+
+unsigned int E131Transport::BuildPacket(unsigned int universe,
+                                        const DmxBuffer &data,
+                                        uint8_t *packet,
+                                        unsigned int packet_size) {
+  unsigned int length = packet_size - HEADER_SIZE;
+  data.Get(packet + HEADER_SIZE, &length);
+  unsigned int size = HEADER_SIZE + length;
+
+  memset(packet, 0, HEADER_SIZE);
+  // Root layer
+  packet[1] = 0x10;
+  memcpy(packet + 4, "ASC-E1.17", 9);
+  SetFlagsAndLength(packet + 16, size - 16);
+  packet[21] = 0x04;
+  memcpy(packet + 22, "ola-bench", 9);  // the CID
+  // Framing layer
+  SetFlagsAndLength(packet + 38, size - 38);
+  packet[43] = 0x02;
+  memcpy(packet + 44, "ola-bench", 9);  // the source name
+  packet[108] = PRIORITY;
+  packet[111] = ++m_sequence_numbers[universe];
+  packet[113] = universe >> 8;
+  packet[114] = universe & 0xff;
+  // DMP layer
+  SetFlagsAndLength(packet + 115, size - 115);
+  packet[117] = 0x02;
+  packet[118] = 0xa1;
+  packet[122] = 0x01;
+  packet[123] = (length + 1) >> 8;
+  packet[124] = (length + 1) & 0xff;
+  packet[125] = ola::DMX512_START_CODE;
+  return size;
+}
+
+
+/**
+ * The results for one transport.
+ */
+class TransportStats {
+ public:
+  TransportStats()
+      : sent(0),
+        received(0),
+        send_errors(0),
+        duplicates(0),
+        m_sorted(false) {
+  }
+
+  uint64_t sent;
+  uint64_t received;
+  uint64_t send_errors;
+  uint64_t duplicates;
+  vector<uint32_t> latencies;  // in microseconds
+
+  uint32_t Percentile(double percentile) {
+    if (latencies.empty()) {
+      return 0;
+    }
+    if (!m_sorted) {
+      std::sort(latencies.begin(), latencies.end());
+      m_sorted = true;
+    }
+    size_t index = static_cast<size_t>(percentile / 100 * latencies.size());
+    return latencies[std::min(index, latencies.size() - 1)];
+  }
+
+ private:
+  bool m_sorted;
+};
+
+
+/**
+ * Sends frames on each universe and measures how long they take to come
+ * back.
+ */
+class Bench {
+ public:
+  Bench()
+      : m_send_timeout(ola::thread::INVALID_TIMEOUT),
+        m_start_cpu(0),
+        m_end_cpu(0),
+        m_olad_start_cpu(0),
+        m_olad_end_cpu(0),
+        m_have_olad_cpu(false) {
+  }
+
+  ~Bench() {
+    ola::STLDeleteElements(&m_transports);
+  }
+
+  bool Setup(const vector<string> &transport_names,
+             const IPV4Address &target);
+  void Run();
+  void PrintResults();
+  void PrintJson();
+
+ private:
+  struct UniverseState {
+    Transport *transport;
+    TransportStats *stats;
+    uint32_t next_sequence;
+    uint32_t last_received;
+  };
+  typedef std::map<unsigned int, UniverseState> UniverseMap;
+
+  OlaClientWrapper m_wrapper;
+  ola::Clock m_clock;
+  vector<Transport*> m_transports;
+  std::map<string, TransportStats> m_stats;
+  UniverseMap m_universes;
+  DmxBuffer m_buffer;
+  ola::thread::timeout_id m_send_timeout;
+  TimeStamp m_start_time;
+  TimeStamp m_end_time;
+  clock_t m_start_cpu;
+  clock_t m_end_cpu;
+  double m_olad_start_cpu;
+  double m_olad_end_cpu;
+  bool m_have_olad_cpu;
+
+  bool SendFrames();
+  void StopSending();
+  void NewDmx(const DMXMetadata &metadata, const DmxBuffer &data);
+  void RegisterComplete(const Result &result);
+  uint64_t TotalSent() const;
+
+  DISALLOW_COPY_AND_ASSIGN(Bench);
+};
+
+
+bool Bench::Setup(const vector<string> &transport_names,
+                  const IPV4Address &target) {
+  if (!m_wrapper.Setup()) {
+    OLA_FATAL << "Failed to connect to olad";
+    return false;
+  }
+
+  vector<string>::const_iterator iter = transport_names.begin();
+  for (; iter != transport_names.end(); ++iter) {
+    Transport *transport = NULL;
+    if (*iter == "streaming") {
+      transport = new StreamingTransport();
+    } else if (*iter == "client") {
+      transport = new ClientTransport(m_wrapper.GetClient());
+    } else if (*iter == "artnet") {
+      transport = new ArtNetTransport(target);
+    } else if (*iter == "e131") {
+      transport = new E131Transport(target);
+    } else {
+      OLA_FATAL << "Unknown transport " << *iter;
+      return false;
+    }
+    m_transports.push_back(transport);
+    if (!transport->Setup()) {
+      OLA_FATAL << "Failed to set up the " << *iter << " transport";
+      return false;
+    }
+  }
+
+  m_wrapper.GetClient()->SetDMXCallback(
+      ola::NewCallback(this, &Bench::NewDmx));
+  for (unsigned int i = 0; i < FLAGS_universes; i++) {
+    unsigned int universe = FLAGS_start_universe + i;
+    UniverseState &state = m_universes[universe];
+    state.transport = m_transports[i % m_transports.size()];
+    state.stats = &m_stats[state.transport->Name()];
+    state.next_sequence = 1;
+    state.last_received = 0;
+    m_wrapper.GetClient()->RegisterUniverse(
+        universe, ola::client::REGISTER,
+        ola::NewSingleCallback(this, &Bench::RegisterComplete));
+  }
+
+  m_buffer.SetRangeToValue(0, 0, FLAGS_slots);
+  return true;
+}
+
+
+void Bench::Run() {
+  ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+  m_send_timeout = ss->RegisterRepeatingTimeout(
+      TimeInterval(1000000 / FLAGS_rate),
+      ola::NewCallback(this, &Bench::SendFrames));
+  ss->RegisterSingleTimeout(
+      FLAGS_duration * 1000,
+      ola::NewSingleCallback(this, &Bench::StopSending));
+
+  if (FLAGS_olad_pid) {
+    m_have_olad_cpu = ReadProcessCPUTime(FLAGS_olad_pid, &m_olad_start_cpu);
+    if (!m_have_olad_cpu) {
+      OLA_WARN << "Can't read the CPU time for pid " << FLAGS_olad_pid;
+    }
+  }
+  m_start_cpu = clock();
+  m_clock.CurrentMonotonicTime(&m_start_time);
+  ss->Run();
+}
+
+
+/*
+ * Send a frame on every universe.
+ */
+bool Bench::SendFrames() {
+  uint8_t header[HEADER_SIZE];
+  UniverseMap::iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    UniverseState &state = iter->second;
+    TimeStamp now;
+    m_clock.CurrentMonotonicTime(&now);
+    PackUInt32(state.next_sequence, header + SEQUENCE_OFFSET);
+    PackUInt64((now - TimeStamp()).AsInt(),
+               header + TIMESTAMP_OFFSET);
+    m_buffer.SetRange(0, header, HEADER_SIZE);
+
+    if (state.transport->Send(iter->first, m_buffer)) {
+      state.next_sequence++;
+      state.stats->sent++;
+    } else {
+      state.stats->send_errors++;
+    }
+  }
+  return true;
+}
+
+
+void Bench::StopSending() {
+  ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+  ss->RemoveTimeout(m_send_timeout);
+  m_send_timeout = ola::thread::INVALID_TIMEOUT;
+
+  m_end_cpu = clock();
+  m_clock.CurrentMonotonicTime(&m_end_time);
+  if (m_have_olad_cpu) {
+    m_have_olad_cpu = ReadProcessCPUTime(FLAGS_olad_pid, &m_olad_end_cpu);
+  }
+  ss->RegisterSingleTimeout(
+      DRAIN_TIME_MS,
+      ola::NewSingleCallback(ss, &ola::io::SelectServer::Terminate));
+}
+
+
+void Bench::NewDmx(const DMXMetadata &metadata, const DmxBuffer &data) {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+
+  UniverseState *state = ola::STLFind(&m_universes, metadata.universe);
+  if (!state || data.Size() < HEADER_SIZE) {
+    return;
+  }
+
+  uint8_t header[HEADER_SIZE];
+  unsigned int size = HEADER_SIZE;
+  data.Get(header, &size);
+  uint32_t sequence = UnpackUInt(header + SEQUENCE_OFFSET, 4);
+  int64_t sent_time = UnpackUInt(header + TIMESTAMP_OFFSET, 8);
+
+  if (sequence == 0 || sequence >= state->next_sequence) {
+    // Not one of ours.
+    return;
+  }
+  if (sequence <= state->last_received) {
+    state->stats->duplicates++;
+    return;
+  }
+  state->last_received = sequence;
+  state->stats->received++;
+  int64_t latency = (now - TimeStamp()).AsInt() - sent_time;
+  state->stats->latencies.push_back(latency > 0 ? latency : 0);
+}
+
+
+void Bench::RegisterComplete(const Result &result) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to register universe: " << result.Error();
+  }
+}
+
+
+uint64_t Bench::TotalSent() const {
+  uint64_t sent = 0;
+  std::map<string, TransportStats>::const_iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    sent += iter->second.sent;
+  }
+  return sent;
+}
+
+
+void Bench::PrintResults() {
+  double elapsed = (m_end_time - m_start_time).AsInt() / 1000000.0;
+  uint64_t sent = TotalSent();
+
+  cout << "Sent " << sent << " frames on " << m_universes.size()
+       << " universes in " << elapsed << "s" << endl;
+  std::map<string, TransportStats>::iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    TransportStats &stats = iter->second;
+    cout << iter->first << ": sent " << stats.sent << ", received "
+         << stats.received << ", lost " << stats.sent - stats.received
+         << ", send errors " << stats.send_errors << ", duplicates "
+         << stats.duplicates << endl;
+    cout << "  latency (us): p50 " << stats.Percentile(50) << ", p90 "
+         << stats.Percentile(90) << ", p99 " << stats.Percentile(99)
+         << ", p99.9 " << stats.Percentile(99.9) << ", max "
+         << stats.Percentile(100) << endl;
+  }
+
+  if (sent) {
+    double cpu = static_cast<double>(m_end_cpu - m_start_cpu) /
+                 CLOCKS_PER_SEC;
+    cout << "ola_bench CPU per frame: " << cpu * 1000000 / sent << " us"
+         << endl;
+    if (m_have_olad_cpu) {
+      cout << "olad CPU per frame: "
+           << (m_olad_end_cpu - m_olad_start_cpu) * 1000000 / sent << " us"
+           << endl;
+    }
+  }
+}
+
+
+void Bench::PrintJson() {
+  JsonObject json;
+  json.Add("universes", static_cast<unsigned int>(m_universes.size()));
+  json.Add("rate", static_cast<unsigned int>(FLAGS_rate));
+  json.Add("slots", static_cast<unsigned int>(FLAGS_slots));
+  json.Add("duration",
+           (m_end_time - m_start_time).AsInt() / 1000000.0);
+
+  uint64_t sent = TotalSent();
+  if (sent) {
+    json.Add("bench_cpu_us_per_frame",
+             static_cast<double>(m_end_cpu - m_start_cpu) * 1000000 /
+             CLOCKS_PER_SEC / sent);
+    if (m_have_olad_cpu) {
+      json.Add("olad_cpu_us_per_frame",
+               (m_olad_end_cpu - m_olad_start_cpu) * 1000000 / sent);
+    }
+  }
+
+  JsonArray *transports = json.AddArray("transports");
+  std::map<string, TransportStats>::iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    TransportStats &stats = iter->second;
+    JsonObject *transport = transports->AppendObject();
+    transport->Add("name", iter->first);
+    transport->Add("sent", static_cast<unsigned int>(stats.sent));
+    transport->Add("received", static_cast<unsigned int>(stats.received));
+    transport->Add("lost",
+                   static_cast<unsigned int>(stats.sent - stats.received));
+    transport->Add("send_errors",
+                   static_cast<unsigned int>(stats.send_errors));
+    transport->Add("duplicates", static_cast<unsigned int>(stats.duplicates));
+    transport->Add("latency_p50_us", stats.Percentile(50));
+    transport->Add("latency_p90_us", stats.Percentile(90));
+    transport->Add("latency_p99_us", stats.Percentile(99));
+    transport->Add("latency_p999_us", stats.Percentile(99.9));
+    transport->Add("latency_max_us", stats.Percentile(100));
+  }
+  ola::web::JsonWriter::Write(&cout, json);
+  cout << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Send DMX data on many universes and measure how long it "
+               "takes olad to send it back.");
+
+  if (!FLAGS_universes || !FLAGS_rate || !FLAGS_duration) {
+    OLA_FATAL << "--universes, --rate and --duration must be non-0";
+    exit(ola::EXIT_USAGE);
+  }
+  if (FLAGS_slots < HEADER_SIZE || FLAGS_slots > ola::DMX_UNIVERSE_SIZE) {
+    OLA_FATAL << "--slots must be between " << HEADER_SIZE << " and "
+              << ola::DMX_UNIVERSE_SIZE;
+    exit(ola::EXIT_USAGE);
+  }
+
+  IPV4Address target;
+  if (!IPV4Address::FromString(FLAGS_target, &target)) {
+    OLA_FATAL << "Invalid target " << FLAGS_target;
+    exit(ola::EXIT_USAGE);
+  }
+
+  vector<string> transports;
+  ola::StringSplit(FLAGS_transports, &transports, ",");
+
+  Bench bench;
+  if (!bench.Setup(transports, target)) {
+    exit(ola::EXIT_UNAVAILABLE);
+  }
+  bench.Run();
+
+  if (FLAGS_json) {
+    bench.PrintJson();
+  } else {
+    bench.PrintResults();
+  }
+  return ola::EXIT_OK;
+}
@@ -55,24 +55,38 @@
 #include <ola/base/SysExits.h>
 #include <ola/client/ClientWrapper.h>
 #include <ola/client/OlaClient.h>
+#include <ola/dmx/TrackedDmxBuffer.h>
 #include <ola/io/SelectServer.h>
 
-#include <string>
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <string>
+#include <vector>
 
 using ola::Clock;
 using ola::DmxBuffer;
 using ola::client::OlaClient;
 using ola::client::OlaClientWrapper;
 using ola::client::Result;
+using ola::client::UniverseStats;
+using ola::dmx::SlotRange;
+using ola::dmx::TrackedDmxBuffer;
 using ola::TimeInterval;
 using ola::TimeStamp;
 using ola::io::SelectServer;
 using std::string;
+using std::vector;
 
 static const unsigned int DEFAULT_UNIVERSE = 0;
+static const unsigned int DEFAULT_REFRESH_RATE = 20;
 static const unsigned char CHANNEL_DISPLAY_WIDTH = 4;
 static const unsigned char ROWS_PER_CHANNEL_ROW = 2;
+static const unsigned int STATS_INTERVAL_MS = 1000;
+static const unsigned int MAX_SPARKLINE_LENGTH = 60;
+// Activity levels for the sparklines, lowest first.
+static const char SPARKLINE_CHARS[] = " .:-=+*#%@";
 
 /* color names used */
 enum {
@@ -96,6 +110,8 @@ enum {
 
 typedef struct {
   unsigned int universe;
+  unsigned int refresh_rate;
+  bool overview;
   bool help;        // help
 } options;
 
@@ -116,14 +132,20 @@ static int palette[MAXCOLOR];
  */
 class DmxMonitor {
  public:
-    explicit DmxMonitor(unsigned int universe)
+    DmxMonitor(unsigned int universe, unsigned int refresh_rate,
+               bool overview)
         : m_universe(universe),
+          m_refresh_rate(refresh_rate ? refresh_rate : DEFAULT_REFRESH_RATE),
           m_counter(0),
           m_palette_number(0),
           m_stdin_descriptor(STDIN_FILENO),
           m_window(NULL),
           m_data_loss_window(NULL),
-          m_channels_offset(true) {
+          m_channels_offset(true),
+          m_overview(overview),
+          m_drawn_generation(0),
+          m_new_data(false),
+          m_full_redraw(true) {
     }
 
     ~DmxMonitor() {
@@ -144,7 +166,31 @@ class DmxMonitor {
     void TerminalResized();
 
  private:
+    // What we know about a universe in the overview.
+    struct UniverseActivity {
+      uint64_t input_frames;
+      uint64_t output_frames;
+      unsigned int input_rate;
+      unsigned int output_rate;
+      unsigned int changed_slots;
+      unsigned int source_count;
+      bool has_input;
+      std::deque<unsigned int> history;  // input rates, oldest first
+
+      UniverseActivity()
+          : input_frames(0),
+            output_frames(0),
+            input_rate(0),
+            output_rate(0),
+            changed_slots(0),
+            source_count(0),
+            has_input(false) {
+      }
+    };
+    typedef std::map<unsigned int, UniverseActivity> ActivityMap;
+
     unsigned int m_universe;
+    const unsigned int m_refresh_rate;
     unsigned int m_counter;
     int m_palette_number;
     ola::io::UnmanagedFileDescriptor m_stdin_descriptor;
@@ -152,14 +198,32 @@ class DmxMonitor {
     WINDOW *m_window;
     WINDOW *m_data_loss_window;
     bool m_channels_offset;  // start from channel 1 rather than 0;
+    bool m_overview;  // show all universes rather than the slot values
     OlaClientWrapper m_client;
-    DmxBuffer m_buffer;
-
+    TrackedDmxBuffer m_buffer;
+    // The generation of m_buffer that's on screen.
+    uint32_t m_drawn_generation;
+    // True if the data arrived since the last refresh, for the spinner.
+    bool m_new_data;
+    // True if all the values need to be redrawn.
+    bool m_full_redraw;
+    ActivityMap m_activity;
+    TimeStamp m_last_stats;
+
+    bool RefreshScreen();
     void DrawScreen(bool include_values = true);
     void Mask();
     void Values();
+    void DrawValues(const SlotRange &range);
+    void DrawValue(unsigned int channel);
     void ChangePalette(int p);
     void CalcScreenGeometry();
+    void ToggleOverview();
+    bool FetchStats();
+    void StatsReceived(const Result &result,
+                       const vector<UniverseStats> &stats);
+    void DrawOverview();
+    void RemoveDataLossWindow();
 };
 
 
@@ -175,10 +239,12 @@ bool DmxMonitor::Init() {
 
   OlaClient *client = m_client.GetClient();
   client->SetDMXCallback(ola::NewCallback(this, &DmxMonitor::NewDmx));
-  client->RegisterUniverse(
-      m_universe,
-      ola::client::REGISTER,
-      ola::NewSingleCallback(this, &DmxMonitor::RegisterComplete));
+  if (!m_overview) {
+    client->RegisterUniverse(
+        m_universe,
+        ola::client::REGISTER,
+        ola::NewSingleCallback(this, &DmxMonitor::RegisterComplete));
+  }
 
   /* init curses */
   m_window = initscr();
@@ -199,11 +265,24 @@ bool DmxMonitor::Init() {
   m_client.GetSelectServer()->RegisterRepeatingTimeout(
       500,
       ola::NewCallback(this, &DmxMonitor::CheckDataLoss));
+  // The screen is redrawn at a fixed rate, no matter how fast the DMX
+  // arrives. Values that change in between are never sent to the terminal.
+  m_client.GetSelectServer()->RegisterRepeatingTimeout(
+      std::max(1u, 1000 / m_refresh_rate),
+      ola::NewCallback(this, &DmxMonitor::RefreshScreen));
+  m_client.GetSelectServer()->RegisterRepeatingTimeout(
+      STATS_INTERVAL_MS,
+      ola::NewCallback(this, &DmxMonitor::FetchStats));
   CalcScreenGeometry();
   ChangePalette(m_palette_number);
 
   m_buffer.Blackout();
-  DrawScreen();
+  if (m_overview) {
+    FetchStats();
+    DrawOverview();
+  } else {
+    DrawScreen();
+  }
   return true;
 }
 
@@ -213,16 +292,29 @@ bool DmxMonitor::Init() {
  */
 void DmxMonitor::NewDmx(OLA_UNUSED const ola::client::DMXMetadata &meta,
                         const DmxBuffer &buffer) {
+  if (m_overview) {
+    return;
+  }
   m_buffer.Set(buffer);
+  m_new_data = true;
+
+  Clock clock;
+  clock.CurrentMonotonicTime(&m_last_data);
+}
+
 
-  if (m_data_loss_window) {
-    // delete the window
-    wborder(m_data_loss_window, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
-    wrefresh(m_data_loss_window);
-    delwin(m_data_loss_window);
-    m_data_loss_window = NULL;
-    Mask();
+/*
+ * Called at the refresh rate, this draws the slots that changed since the
+ * last refresh.
+ */
+bool DmxMonitor::RefreshScreen() {
+  if (m_overview || !m_new_data) {
+    return true;
   }
+  m_new_data = false;
+
+  RemoveDataLossWindow();
+  (void) attrset(palette[HEADLINE]);
   move(0, COLS - 1);  // NOLINT(build/include_what_you_use) This is ncurses.h's
   switch (m_counter % 4) {
     case 0:
@@ -240,10 +332,13 @@ void DmxMonitor::NewDmx(OLA_UNUSED const ola::client::DMXMetadata &meta,
   }
   m_counter++;
 
-  Clock clock;
-  clock.CurrentMonotonicTime(&m_last_data);
-  Values();
+  if (m_full_redraw) {
+    Values();
+  } else {
+    DrawValues(m_buffer.ChangesSince(m_drawn_generation));
+  }
   refresh();
+  return true;
 }
 
 
@@ -261,6 +356,27 @@ void DmxMonitor::RegisterComplete(const Result &result) {
 void DmxMonitor::StdinReady() {
   int c = wgetch(m_window);
 
+  if (m_overview) {
+    switch (c) {
+      case 'O':
+      case 'o':
+        ToggleOverview();
+        break;
+      case 'P':
+      case 'p':
+        ChangePalette(++m_palette_number);
+        DrawOverview();
+        break;
+      case 'Q':
+      case 'q':
+        m_client.GetSelectServer()->Terminate();
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+
   switch (c) {
     case KEY_HOME:
       current_channel = 0;
@@ -345,6 +461,11 @@ void DmxMonitor::StdinReady() {
       DrawScreen(false);
       break;
 
+    case 'O':
+    case 'o':
+      ToggleOverview();
+      break;
+
     case 'P':
     case 'p':
       ChangePalette(++m_palette_number);
@@ -366,7 +487,7 @@ void DmxMonitor::StdinReady() {
  * TODO(simon): move to the ola server
  */
 bool DmxMonitor::CheckDataLoss() {
-  if (m_last_data.IsSet()) {
+  if (!m_overview && m_last_data.IsSet()) {
     TimeStamp now;
     Clock clock;
     clock.CurrentMonotonicTime(&now);
@@ -400,7 +521,11 @@ void DmxMonitor::TerminalResized() {
 
   resizeterm(size.ws_row, size.ws_col);
   CalcScreenGeometry();
-  DrawScreen();
+  if (m_overview) {
+    DrawOverview();
+  } else {
+    DrawScreen();
+  }
 }
 
 
@@ -418,6 +543,20 @@ void DmxMonitor::DrawScreen(bool include_values) {
 }
 
 
+void DmxMonitor::RemoveDataLossWindow() {
+  if (!m_data_loss_window) {
+    return;
+  }
+  wborder(m_data_loss_window, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
+  wrefresh(m_data_loss_window);
+  delwin(m_data_loss_window);
+  m_data_loss_window = NULL;
+  Mask();
+  // The window covered some of the values.
+  m_full_redraw = true;
+}
+
+
 /* display the channels numbers */
 void DmxMonitor::Mask() {
   unsigned int i = 0, x, y;
@@ -466,76 +605,241 @@ void DmxMonitor::Mask() {
  * Update the screen with new values
  */
 void DmxMonitor::Values() {
-  int i = 0, x, y, z = first_channel;
+  DrawValues(SlotRange(first_channel,
+                       first_channel + channels_per_screen));
+  m_full_redraw = false;
+}
 
-  /* values */
-  for (y = ROWS_PER_CHANNEL_ROW;
-       y < LINES && z < ola::DMX_UNIVERSE_SIZE &&
-       i < static_cast<int>(channels_per_screen);
-       y += ROWS_PER_CHANNEL_ROW) {
-    move(y, 0);  // NOLINT(build/include_what_you_use) This is ncurses.h's move
-    for (x = 0;
-         x < static_cast<int>(channels_per_line) &&
-         z < ola::DMX_UNIVERSE_SIZE &&
-         i < static_cast<int>(channels_per_screen);
-         x++, z++, i++) {
-      const int d = m_buffer.Get(z);
+
+/*
+ * Draw the values of the channels in a range that are on the screen.
+ */
+void DmxMonitor::DrawValues(const SlotRange &range) {
+  const unsigned int last_on_screen = std::min(
+      static_cast<unsigned int>(ola::DMX_UNIVERSE_SIZE),
+      first_channel + channels_per_screen);
+  const unsigned int first = std::max(range.first,
+                                      static_cast<unsigned int>(first_channel));
+  const unsigned int end = std::min(range.end, last_on_screen);
+  for (unsigned int channel = first; channel < end; channel++) {
+    DrawValue(channel);
+  }
+  m_drawn_generation = m_buffer.Generation();
+}
+
+
+/*
+ * Draw the value of a single channel.
+ */
+void DmxMonitor::DrawValue(unsigned int channel) {
+  const unsigned int index = channel - first_channel;
+  const int y = ROWS_PER_CHANNEL_ROW +
+      (index / channels_per_line) * ROWS_PER_CHANNEL_ROW;
+  if (y >= LINES) {
+    return;
+  }
+  move(y,  // NOLINT(build/include_what_you_use) This is ncurses.h's move
+       (index % channels_per_line) * CHANNEL_DISPLAY_WIDTH);
+
+  const int z = channel;
+  const int d = m_buffer.Buffer().Get(z);
+  switch (d) {
+    case ola::DMX_MIN_SLOT_VALUE:
+      (void) attrset(palette[ZERO]);
+      break;
+    case ola::DMX_MAX_SLOT_VALUE:
+      (void) attrset(palette[FULL]);
+      break;
+    default:
+      (void) attrset(palette[NORM]);
+  }
+  if (static_cast<int>(z) == current_channel)
+    attron(A_REVERSE);
+  switch (display_mode) {
+    case DISP_MODE_HEX:
+      if (d == 0) {
+        if (static_cast<int>(m_buffer.Size()) <= z) {
+          addstr("--- ");
+        } else {
+          addstr("    ");
+        }
+      } else {
+        printw(" %02x ", d);
+      }
+      break;
+    case DISP_MODE_DEC:
+      if (d == 0) {
+        if (static_cast<int>(m_buffer.Size()) <= z) {
+          addstr("--- ");
+        } else {
+          addstr("    ");
+        }
+      } else if (d < 100) {
+        printw(" %02d ", d);
+      } else {
+        printw("%03d ", d);
+      }
+      break;
+    case DISP_MODE_DMX:
+    default:
       switch (d) {
         case ola::DMX_MIN_SLOT_VALUE:
-          (void) attrset(palette[ZERO]);
-          break;
-        case ola::DMX_MAX_SLOT_VALUE:
-          (void) attrset(palette[FULL]);
-          break;
-        default:
-          (void) attrset(palette[NORM]);
-      }
-      if (static_cast<int>(z) == current_channel)
-        attron(A_REVERSE);
-      switch (display_mode) {
-        case DISP_MODE_HEX:
-          if (d == 0) {
-            if (static_cast<int>(m_buffer.Size()) <= z) {
-              addstr("--- ");
-            } else {
-              addstr("    ");
-            }
+          if (static_cast<int>(m_buffer.Size()) <= z) {
+            addstr("--- ");
           } else {
-            printw(" %02x ", d);
+            addstr("    ");
           }
           break;
-        case DISP_MODE_DEC:
-          if (d == 0) {
-            if (static_cast<int>(m_buffer.Size()) <= z) {
-              addstr("--- ");
-            } else {
-              addstr("    ");
-            }
-          } else if (d < 100) {
-            printw(" %02d ", d);
-          } else {
-            printw("%03d ", d);
-          }
+        case ola::DMX_MAX_SLOT_VALUE:
+          addstr(" FL ");
           break;
-        case DISP_MODE_DMX:
         default:
-          switch (d) {
-            case ola::DMX_MIN_SLOT_VALUE:
-              if (static_cast<int>(m_buffer.Size()) <= z) {
-                addstr("--- ");
-              } else {
-                addstr("    ");
-              }
-              break;
-            case ola::DMX_MAX_SLOT_VALUE:
-              addstr(" FL ");
-              break;
-            default:
-              printw(" %02d ", (d * 100) / ola::DMX_MAX_SLOT_VALUE);
-          }
+          printw(" %02d ", (d * 100) / ola::DMX_MAX_SLOT_VALUE);
       }
+  }
+}
+
+
+/*
+ * Switch between the slot values of one universe and the overview of all
+ * universes. The overview is built from the universe stats, so we stop
+ * receiving the DMX data while it's shown.
+ */
+void DmxMonitor::ToggleOverview() {
+  m_overview = !m_overview;
+  OlaClient *client = m_client.GetClient();
+  client->RegisterUniverse(
+      m_universe,
+      m_overview ? ola::client::UNREGISTER : ola::client::REGISTER,
+      ola::NewSingleCallback(this, &DmxMonitor::RegisterComplete));
+
+  if (m_overview) {
+    RemoveDataLossWindow();
+    m_activity.clear();
+    FetchStats();
+    DrawOverview();
+  } else {
+    m_last_data = TimeStamp();
+    DrawScreen();
+  }
+}
+
+
+bool DmxMonitor::FetchStats() {
+  if (m_overview) {
+    m_client.GetClient()->FetchUniverseStats(
+        ola::NewSingleCallback(this, &DmxMonitor::StatsReceived));
+  }
+  return true;
+}
+
+
+/*
+ * Called when the universe stats arrive, update the rates & sparklines.
+ */
+void DmxMonitor::StatsReceived(const Result &result,
+                               const vector<UniverseStats> &stats) {
+  if (!m_overview) {
+    return;
+  }
+  if (!result.Success()) {
+    std::cerr << "Fetching the universe stats failed with " << result.Error()
+              << std::endl;
+    m_client.GetSelectServer()->Terminate();
+    return;
+  }
+
+  TimeStamp now;
+  Clock clock;
+  clock.CurrentMonotonicTime(&now);
+  const int64_t elapsed_ms = m_last_stats.IsSet() ?
+      (now - m_last_stats).InMilliSeconds() : 0;
+  m_last_stats = now;
+
+  ActivityMap activity;
+  vector<UniverseStats>::const_iterator iter = stats.begin();
+  for (; iter != stats.end(); ++iter) {
+    UniverseActivity &universe = activity[iter->universe];
+    ActivityMap::iterator old = m_activity.find(iter->universe);
+    if (old != m_activity.end()) {
+      universe.history.swap(old->second.history);
+      if (elapsed_ms > 0) {
+        universe.input_rate = static_cast<unsigned int>(
+            (iter->input_frames - old->second.input_frames) * 1000 /
+            elapsed_ms);
+        universe.output_rate = static_cast<unsigned int>(
+            (iter->output_frames - old->second.output_frames) * 1000 /
+            elapsed_ms);
+      }
+    }
+    universe.input_frames = iter->input_frames;
+    universe.output_frames = iter->output_frames;
+    universe.changed_slots = iter->last_changed_slots;
+    universe.source_count = iter->source_count;
+    universe.has_input = iter->has_input;
+
+    universe.history.push_back(universe.input_rate);
+    while (universe.history.size() > MAX_SPARKLINE_LENGTH) {
+      universe.history.pop_front();
     }
   }
+  m_activity.swap(activity);
+  DrawOverview();
+}
+
+
+/*
+ * Draw the rates and activity of all universes.
+ */
+void DmxMonitor::DrawOverview() {
+  erase();
+
+  (void) attrset(palette[HEADLINE]);
+  move(0, 0);  // NOLINT(build/include_what_you_use) This is ncurses.h's move
+  for (int x = 0; x < COLS; x++)
+    addch(' ');
+  mvprintw(0, 0, "Universes: %u", static_cast<unsigned int>(m_activity.size()));
+
+  (void) attrset(palette[CHANNEL]);
+  mvprintw(1, 0, "%-10s %6s %6s %7s %4s  %s", "Universe", "In/s", "Out/s",
+           "Changed", "Srcs", "Input activity");
+
+  const int sparkline_x = 40;
+  const unsigned int sparkline_length = COLS > sparkline_x ?
+      std::min(MAX_SPARKLINE_LENGTH,
+               static_cast<unsigned int>(COLS - sparkline_x)) :
+      0;
+  const unsigned int levels = sizeof(SPARKLINE_CHARS) - 2;
+
+  int y = 2;
+  ActivityMap::const_iterator iter = m_activity.begin();
+  for (; iter != m_activity.end() && y < LINES; ++iter, ++y) {
+    const UniverseActivity &universe = iter->second;
+    (void) attrset(palette[universe.has_input ? NORM : ZERO]);
+    if (iter->first == m_universe)
+      attron(A_REVERSE);
+    mvprintw(y, 0, "%-10u %6u %6u %7u %4u  ", iter->first,
+             universe.input_rate, universe.output_rate, universe.changed_slots,
+             universe.source_count);
+
+    unsigned int peak = 1;
+    std::deque<unsigned int>::const_iterator rate = universe.history.begin();
+    for (; rate != universe.history.end(); ++rate) {
+      peak = std::max(peak, *rate);
+    }
+    // Show the most recent samples that fit.
+    const unsigned int skip = universe.history.size() > sparkline_length ?
+        universe.history.size() - sparkline_length : 0;
+    for (rate = universe.history.begin() + skip;
+         rate != universe.history.end(); ++rate) {
+      unsigned int level = *rate * levels / peak;
+      if (*rate && !level) {
+        level = 1;
+      }
+      addch(SPARKLINE_CHARS[level]);
+    }
+  }
+  refresh();
 }
 
 
@@ -645,18 +949,22 @@ void cleanup() {
 void ParseOptions(int argc, char *argv[], options *opts) {
   static struct option long_options[] = {
       {"help", no_argument, 0, 'h'},
+      {"overview", no_argument, 0, 'o'},
+      {"refresh-rate", required_argument, 0, 'r'},
       {"universe", required_argument, 0, 'u'},
       {0, 0, 0, 0}
     };
 
   opts->universe = DEFAULT_UNIVERSE;
+  opts->refresh_rate = DEFAULT_REFRESH_RATE;
+  opts->overview = false;
   opts->help = false;
 
   int c;
   int option_index = 0;
 
   while (1) {
-    c = getopt_long(argc, argv, "hu:", long_options, &option_index);
+    c = getopt_long(argc, argv, "hor:u:", long_options, &option_index);
 
     if (c == -1)
       break;
@@ -667,6 +975,12 @@ void ParseOptions(int argc, char *argv[], options *opts) {
       case 'h':
         opts->help = true;
         break;
+      case 'o':
+        opts->overview = true;
+        break;
+      case 'r':
+        opts->refresh_rate = strtoul(optarg, NULL, 0);
+        break;
       case 'u':
         opts->universe = strtoul(optarg, NULL, 0);
         break;
@@ -688,6 +1002,9 @@ void DisplayHelpAndExit(char arg[]) {
   "Monitor the values on a DMX512 universe.\n"
   "\n"
   "  -h, --help                   Display this help message and exit.\n"
+  "  -o, --overview               Start with the overview of all universes.\n"
+  "  -r, --refresh-rate <fps>     The maximum screen refresh rate (defaults "
+  "to " << DEFAULT_REFRESH_RATE << ").\n"
   "  -u, --universe <universe_id> Id of universe to monitor (defaults to "
   << DEFAULT_UNIVERSE << ").\n"
   << std::endl;
@@ -712,7 +1029,8 @@ int main(int argc, char *argv[]) {
     DisplayHelpAndExit(argv[0]);
   }
 
-  dmx_monitor = new DmxMonitor(opts.universe);
+  dmx_monitor = new DmxMonitor(opts.universe, opts.refresh_rate,
+                               opts.overview);
   if (!dmx_monitor->Init())
     return 1;
 
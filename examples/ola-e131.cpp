@@ -23,15 +23,18 @@
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
+#include <ola/StringUtils.h>
 #include <plugins/e131/messages/E131ConfigMessages.pb.h>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "examples/OlaConfigurator.h"
 
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::string;
+using std::vector;
 
 DECLARE_int32(device);
 DEFINE_s_uint32(port_id, p, 0, "Id of the port to control");
@@ -39,6 +42,11 @@ DEFINE_s_default_bool(input, i, false,
                       "Set an input port, otherwise set an output port.");
 DEFINE_bool(preview_mode, false, "Set the preview mode bit on|off");
 DEFINE_default_bool(discovery, false, "Get the discovery state");
+DEFINE_uint16(universe, 0, "The universe to set the source filter for");
+DEFINE_string(sources, "",
+              "Comma separated list of the sources to receive --universe "
+              "from, empty to receive from any source");
+DEFINE_default_bool(source_filters, false, "Get the source filters");
 
 /*
  * A class that configures E131 devices
@@ -52,6 +60,8 @@ class E131Configurator: public OlaConfigurator {
  private:
   void DisplayOptions(const ola::plugin::e131::PortInfoReply &reply);
   void DisplaySourceList(const ola::plugin::e131::SourceListReply &reply);
+  void DisplaySourceFilters(
+      const ola::plugin::e131::SourceFilterReply &reply);
 };
 
 
@@ -86,6 +96,13 @@ void E131Configurator::HandleConfigResponse(const string &reply,
         cout << "Missing source_list field in reply" << endl;
       }
       break;
+    case ola::plugin::e131::Reply::E131_SOURCE_FILTER:
+      if (reply_pb.has_source_filter()) {
+        DisplaySourceFilters(reply_pb.source_filter());
+      } else {
+        cout << "Missing source_filter field in reply" << endl;
+      }
+      break;
     default:
       cout << "Invalid response type" << endl;
   }
@@ -112,6 +129,26 @@ void E131Configurator::SendConfigRequest() {
       cout << "Please specify a port number" << endl;
       request.set_type(ola::plugin::e131::Request::E131_PORT_INFO);
     }
+  } else if (FLAGS_sources.present()) {
+    if (FLAGS_universe.present()) {
+      request.set_type(ola::plugin::e131::Request::E131_SOURCE_FILTER);
+      ola::plugin::e131::SourceFilterRequest *filter_request =
+          request.mutable_source_filter();
+      filter_request->set_universe(FLAGS_universe);
+      vector<string> sources;
+      ola::StringSplit(FLAGS_sources.str(), &sources, ",");
+      vector<string>::const_iterator iter = sources.begin();
+      for (; iter != sources.end(); ++iter) {
+        if (!iter->empty()) {
+          filter_request->add_source(*iter);
+        }
+      }
+    } else {
+      cout << "Please specify a universe" << endl;
+      request.set_type(ola::plugin::e131::Request::E131_SOURCE_FILTER);
+    }
+  } else if (FLAGS_source_filters) {
+    request.set_type(ola::plugin::e131::Request::E131_SOURCE_FILTER);
   } else if (FLAGS_discovery) {
     request.set_type(ola::plugin::e131::Request::E131_SOURCES_LIST);
     ola::plugin::e131::SourceListRequest *source_list_request =
@@ -163,6 +200,23 @@ void E131Configurator::DisplaySourceList(
   }
 }
 
+void E131Configurator::DisplaySourceFilters(
+    const ola::plugin::e131::SourceFilterReply &reply) {
+  if (reply.filter_size() == 0) {
+    cout << "All universes are received from any source" << endl;
+    return;
+  }
+
+  for (int i = 0; i < reply.filter_size(); i++) {
+    const ola::plugin::e131::SourceFilter &filter = reply.filter(i);
+    cout << "Universe " << filter.universe() << ":";
+    for (int j = 0; j < filter.source_size(); j++) {
+      cout << " " << filter.source(j);
+    }
+    cout << endl;
+  }
+}
+
 /*
  * The main function
  */
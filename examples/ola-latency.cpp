@@ -26,9 +26,15 @@
 #include <ola/OlaClientWrapper.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/network/TCPSocket.h>
+#include <ola/strings/Format.h>
 #include <ola/thread/SignalThread.h>
 
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 
 using ola::DmxBuffer;
@@ -36,6 +42,9 @@ using ola::NewSingleCallback;
 using ola::OlaCallbackClientWrapper;
 using ola::TimeStamp;
 using ola::TimeInterval;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::TCPSocket;
 using std::cout;
 using std::endl;
 using std::string;
@@ -44,6 +53,10 @@ DEFINE_s_uint32(universe, u, 1, "The universe to receive data for");
 DEFINE_default_bool(send_dmx, false, "Use SendDmx messages, default is GetDmx");
 DEFINE_s_uint32(count, c, 0,
     "Exit after this many RPCs, default: infinite (0)");
+DEFINE_default_bool(dwell_stats, false,
+    "Print how long input data waited in olad before it was sent, this needs "
+    "a plugin with receive timestamps enabled");
+DEFINE_uint16(http_port, 9090, "The port olad's web server is listening on");
 
 class Tracker {
  public:
@@ -146,6 +159,51 @@ void Tracker::StartSignalThread() {
   }
 }
 
+/*
+ * Fetch the dwell time histogram for the universe from olad's /debug page.
+ */
+void PrintDwellTimes() {
+  IPV4SocketAddress address(IPV4Address::Loopback(), FLAGS_http_port);
+  std::auto_ptr<TCPSocket> socket(TCPSocket::Connect(address));
+  if (!socket.get()) {
+    OLA_WARN << "Failed to connect to " << address;
+    return;
+  }
+
+  const string request = "GET /debug HTTP/1.0\r\n\r\n";
+  socket->Send(reinterpret_cast<const uint8_t*>(request.data()),
+               request.size());
+
+  string response;
+  uint8_t buffer[1024];
+  unsigned int data_read;
+  while (socket->Receive(buffer, sizeof(buffer), data_read) == 0 &&
+         data_read) {
+    response.append(reinterpret_cast<char*>(buffer), data_read);
+  }
+  socket->Close();
+
+  // Lines look like: universe-dwell-time-1ms: map: 1:10 2:0
+  const string prefix = "universe-dwell-time-";
+  const string key = " " + ola::strings::IntToString(FLAGS_universe) + ":";
+  std::istringstream lines(response);
+  string line;
+  cout << "Dwell time for universe " << FLAGS_universe << endl;
+  while (std::getline(lines, line)) {
+    if (line.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    string::size_type name_end = line.find(':');
+    string::size_type value = line.find(key);
+    if (name_end == string::npos || value == string::npos) {
+      continue;
+    }
+    value += key.size();
+    cout << "  " << line.substr(prefix.size(), name_end - prefix.size())
+         << ": " << line.substr(value, line.find(' ', value) - value) << endl;
+  }
+}
+
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "[options]",
                "Measure the latency of RPCs to olad.");
@@ -157,5 +215,8 @@ int main(int argc, char *argv[]) {
   }
 
   tracker.Start();
+  if (FLAGS_dwell_stats) {
+    PrintDwellTimes();
+  }
   return 0;
 }
@@ -25,11 +25,13 @@
 #include <ola/StringUtils.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
+#include <ola/client/ClientRDMAPIShim.h>
 #include <ola/client/ClientWrapper.h>
 #include <ola/client/OlaClient.h>
 #include <ola/file/Util.h>
 #include <ola/network/NetworkUtils.h>
 #include <ola/rdm/PidStoreHelper.h>
+#include <ola/rdm/RDMAPI.h>
 #include <ola/rdm/RDMAPIImplInterface.h>
 #include <ola/rdm/RDMEnums.h>
 #include <ola/rdm/RDMHelper.h>
@@ -67,6 +69,7 @@ typedef struct {
   vector<string> args;  // extra args
   string cmd;  // argv[0]
   bool display_frames;  // print raw frames.
+  bool batch;  // GET each of the args
 } options;
 
 
@@ -75,6 +78,7 @@ typedef struct {
  */
 void ParseOptions(int argc, char *argv[], options *opts) {
   const int FRAME_OPTION_VALUE = 256;
+  const int BATCH_OPTION_VALUE = 257;
 
   opts->cmd = argv[0];
   string cmd_name = ola::file::FilenameFromPathOrPath(opts->cmd);
@@ -95,6 +99,7 @@ void ParseOptions(int argc, char *argv[], options *opts) {
   opts->uid = NULL;
   opts->sub_device = 0;
   opts->display_frames = false;
+  opts->batch = false;
 
   if (cmd_name == "ola_rdm_set") {
     opts->set_mode = true;
@@ -108,6 +113,7 @@ void ParseOptions(int argc, char *argv[], options *opts) {
       {"list-pids", no_argument, 0, 'l'},
       {"universe", required_argument, 0, 'u'},
       {"frames", no_argument, 0, FRAME_OPTION_VALUE},
+      {"batch", no_argument, 0, BATCH_OPTION_VALUE},
       {"uid", required_argument, &uid_set, 1},
       {0, 0, 0, 0}
     };
@@ -143,6 +149,9 @@ void ParseOptions(int argc, char *argv[], options *opts) {
       case FRAME_OPTION_VALUE:
         opts->display_frames = true;
         break;
+      case BATCH_OPTION_VALUE:
+        opts->batch = true;
+        break;
       default:
         break;
     }
@@ -164,6 +173,8 @@ void DisplayGetPidHelp(const options &opts) {
   "Get the value of a PID for a device.\n"
   "Use '" << opts.cmd << " --list-pids' to get a list of applicable PIDs.\n"
   "\n"
+  "  --batch                   get each of the PIDs given, which must not\n"
+  "                            take any arguments.\n"
   "  --frames                  display the raw RDM frames if available.\n"
   "  --uid <uid>               the UID of the device to control.\n"
   "  -d, --sub-device <device> target a particular sub device (default is 0)\n"
@@ -247,6 +258,11 @@ class RDMController {
                             bool is_set,
                             const vector<string> &inputs);
 
+  int PerformBatchAndWait(unsigned int universe,
+                          const UID &uid,
+                          uint16_t sub_device,
+                          const vector<string> &pid_names);
+
   void HandleResponse(const ola::client::Result &result,
                       const ola::client::RDMMetadata &metadata,
                       const ola::rdm::RDMResponse *response);
@@ -270,10 +286,15 @@ class RDMController {
   };
 
   const bool m_show_frames;
+  // olad decodes responses with the default PID store, if another store was
+  // specified we decode them ourselves.
+  const bool m_server_decode;
   ola::client::OlaClientWrapper m_ola_client;
   PidStoreHelper m_pid_helper;
   PendingRequest m_pending_request;
 
+  const PidDescriptor *LookupPid(const string &pid_name, const UID &uid);
+  void HandleBatchResponse(const vector<ola::rdm::ParameterResponse> &results);
   void FetchQueuedMessage();
   void PrintRemainingMessages(uint8_t message_count);
   void HandleAckResponse(uint16_t manufacturer_id,
@@ -286,6 +307,7 @@ class RDMController {
 
 RDMController::RDMController(string pid_location, bool show_frames)
     : m_show_frames(show_frames),
+      m_server_decode(pid_location.empty()),
       m_pid_helper(pid_location) {
 }
 
@@ -348,13 +370,18 @@ void RDMController::HandleResponse(const ola::client::Result &result,
   } else if (response->ResponseType() == ola::rdm::RDM_ACK) {
     if (response->ParamId() == m_pending_request.pid_value ||
         m_pending_request.pid_value == ola::rdm::PID_QUEUED_MESSAGE) {
-      HandleAckResponse(
-          m_pending_request.uid->ManufacturerId(),
-          response->CommandClass() ==
-              ola::rdm::RDMCommand::SET_COMMAND_RESPONSE,
-          response->ParamId(),
-          response->ParamData(),
-          response->ParamDataSize());
+      if (!metadata.pid_name.empty()) {
+        // olad has already decoded the response.
+        cout << metadata.decoded_data;
+      } else {
+        HandleAckResponse(
+            m_pending_request.uid->ManufacturerId(),
+            response->CommandClass() ==
+                ola::rdm::RDMCommand::SET_COMMAND_RESPONSE,
+            response->ParamId(),
+            response->ParamData(),
+            response->ParamDataSize());
+      }
     } else {
       // we got something other than an empty status message, this means there
       // there are probably more messages to fetch
@@ -432,23 +459,8 @@ int RDMController::PerformRequestAndWait(unsigned int universe,
                                          const string &pid_name,
                                          bool is_set,
                                          const vector<string> &inputs) {
-  // get the pid descriptor
-  const ola::rdm::PidDescriptor *pid_descriptor = m_pid_helper.GetDescriptor(
-      pid_name,
-      uid.ManufacturerId());
-
-  uint16_t pid_value;
-  if (!pid_descriptor &&
-      (ola::PrefixedHexStringToInt(pid_name, &pid_value) ||
-       ola::StringToInt(pid_name, &pid_value))) {
-    pid_descriptor = m_pid_helper.GetDescriptor(
-        pid_value,
-        uid.ManufacturerId());
-  }
-
+  const PidDescriptor *pid_descriptor = LookupPid(pid_name, uid);
   if (!pid_descriptor) {
-    cout << "Unknown PID: " << pid_name << endl;
-    cout << "Use --list-pids to list the available PIDs." << endl;
     return ola::EXIT_USAGE;
   }
 
@@ -489,6 +501,7 @@ int RDMController::PerformRequestAndWait(unsigned int universe,
   if (m_show_frames) {
     args.include_raw_frames = true;
   }
+  args.decode_response = m_server_decode;
 
   if (is_set) {
     m_ola_client.GetClient()->RDMSet(
@@ -515,6 +528,119 @@ int RDMController::PerformRequestAndWait(unsigned int universe,
 }
 
 
+/**
+ * GET a list of PIDs, none of which take any arguments.
+ */
+int RDMController::PerformBatchAndWait(unsigned int universe,
+                                       const UID &uid,
+                                       uint16_t sub_device,
+                                       const vector<string> &pid_names) {
+  vector<ola::rdm::ParameterRequest> requests;
+  vector<string>::const_iterator iter = pid_names.begin();
+  for (; iter != pid_names.end(); ++iter) {
+    const PidDescriptor *pid_descriptor = LookupPid(*iter, uid);
+    if (!pid_descriptor) {
+      return ola::EXIT_USAGE;
+    }
+
+    const ola::messaging::Descriptor *descriptor =
+        pid_descriptor->GetRequest();
+    if (!descriptor) {
+      cout << "GET command not supported for " << *iter << endl;
+      return ola::EXIT_USAGE;
+    }
+    if (descriptor->FieldCount()) {
+      cout << *iter << " requires arguments and can't be used with --batch"
+           << endl;
+      return ola::EXIT_USAGE;
+    }
+    requests.push_back(ola::rdm::ParameterRequest(
+        universe, uid, sub_device, pid_descriptor->Value()));
+  }
+
+  m_pending_request.universe = universe;
+  m_pending_request.uid = &uid;
+  m_pending_request.sub_device = sub_device;
+
+  ola::client::ClientRDMAPIShim shim(m_ola_client.GetClient());
+  ola::rdm::RDMAPI api(&shim);
+  string error;
+  if (!api.GetParameters(
+        requests, requests.size(),
+        ola::NewSingleCallback(this, &RDMController::HandleBatchResponse),
+        &error)) {
+    cerr << "Error: " << error << endl;
+    return ola::EXIT_SOFTWARE;
+  }
+
+  m_ola_client.GetSelectServer()->Run();
+  return ola::EXIT_OK;
+}
+
+
+/**
+ * Print the results of a batch.
+ */
+void RDMController::HandleBatchResponse(
+    const vector<ola::rdm::ParameterResponse> &results) {
+  vector<ola::rdm::ParameterResponse>::const_iterator iter = results.begin();
+  for (; iter != results.end(); ++iter) {
+    const ola::rdm::ResponseStatus &status = iter->status;
+    const PidDescriptor *pid_descriptor = m_pid_helper.GetDescriptor(
+        iter->request.pid, iter->request.uid.ManufacturerId());
+    cout << "------- " << pid_descriptor->Name() << " -------" << endl;
+
+    if (!status.error.empty()) {
+      cerr << "Error: " << status.error << endl;
+    } else if (status.response_code != ola::rdm::RDM_COMPLETED_OK) {
+      cerr << "Error: "
+           << ola::rdm::StatusCodeToString(status.response_code) << endl;
+    } else if (status.response_type == ola::rdm::RDM_ACK) {
+      HandleAckResponse(
+          iter->request.uid.ManufacturerId(), false, iter->request.pid,
+          reinterpret_cast<const uint8_t*>(iter->data.data()),
+          iter->data.size());
+    } else if (status.response_type == ola::rdm::RDM_NACK_REASON) {
+      cout << "Request NACKed: "
+           << ola::rdm::NackReasonToString(status.NackReason()) << endl;
+    } else if (status.response_type == ola::rdm::RDM_ACK_TIMER) {
+      // Batches don't follow up ACK_TIMERs, that's left to the caller.
+      cout << "Request ACK_TIMER'ed for " << status.AckTimer() << "ms" << endl;
+    } else {
+      cout << "Unknown RDM response type "
+           << ola::strings::ToHex(status.response_type) << endl;
+    }
+  }
+  m_ola_client.GetSelectServer()->Terminate();
+}
+
+
+/**
+ * Find the PidDescriptor for a PID name or value.
+ */
+const PidDescriptor *RDMController::LookupPid(const string &pid_name,
+                                              const UID &uid) {
+  const PidDescriptor *pid_descriptor = m_pid_helper.GetDescriptor(
+      pid_name,
+      uid.ManufacturerId());
+
+  uint16_t pid_value;
+  if (!pid_descriptor &&
+      (ola::PrefixedHexStringToInt(pid_name, &pid_value) ||
+       ola::StringToInt(pid_name, &pid_value))) {
+    pid_descriptor = m_pid_helper.GetDescriptor(
+        pid_value,
+        uid.ManufacturerId());
+  }
+
+  if (!pid_descriptor) {
+    cout << "Unknown PID: " << pid_name << endl;
+    cout << "Use --list-pids to list the available PIDs." << endl;
+  }
+  return pid_descriptor;
+}
+
+
 /**
  * Called after the ack timer expires. This resends the request.
  */
@@ -522,6 +648,7 @@ void RDMController::FetchQueuedMessage() {
   uint8_t status_type = 4;
   ola::client::SendRDMArgs args(
       ola::NewSingleCallback(this, &RDMController::HandleResponse));
+  args.decode_response = m_server_decode;
 
   m_ola_client.GetClient()->RDMGet(
     m_pending_request.universe,
@@ -634,6 +761,13 @@ int main(int argc, char *argv[]) {
     exit(ola::EXIT_UNAVAILABLE);
   }
 
+  if (opts.batch && !opts.set_mode) {
+    return controller.PerformBatchAndWait(opts.universe,
+                                          dest_uid,
+                                          opts.sub_device,
+                                          opts.args);
+  }
+
   // split out rdm message params from the pid name
   vector<string> inputs(opts.args.size() - 1);
   vector<string>::iterator args_iter = opts.args.begin();
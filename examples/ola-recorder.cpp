@@ -25,13 +25,16 @@
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
 #include <signal.h>
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "examples/BinaryShowSaver.h"
 #include "examples/ShowPlayer.h"
 #include "examples/ShowLoader.h"
 #include "examples/ShowRecorder.h"
@@ -50,10 +53,23 @@ using std::string;
 DEFINE_s_string(playback, p, "", "The show file to playback.");
 DEFINE_s_string(record, r, "", "The show file to record data to.");
 DEFINE_string(verify, "", "The show file to verify.");
+DEFINE_default_bool(binary, false,
+                    "Record to the binary show format, which is smaller and "
+                    "faster to seek in.");
+DEFINE_string(convert, "",
+              "The text show file to convert to the binary format.");
+DEFINE_s_string(output, o, "", "The file to write the converted show to.");
+DEFINE_default_bool(history, false,
+                    "Save the frame history olad holds for the universes to "
+                    "the binary show file given by --output. olad must be run "
+                    "with --frame-history-size.");
 DEFINE_default_bool(verify_playback, true,
                     "Don't verify show file before playback");
 DEFINE_s_string(universes, u, "",
                 "A comma separated list of universes to record");
+DEFINE_default_bool(skip_unchanged, true,
+                    "Record frames that are the same as the last frame for "
+                    "the universe.");
 DEFINE_s_uint32(delay, d, 0, "The delay in ms between successive iterations.");
 DEFINE_uint32(duration, 0, "Total playback time (seconds); the program will "
                            "close after this time has elapsed. This "
@@ -68,6 +84,9 @@ DEFINE_uint32(stop, 0,
               "Time (milliseconds) in show file to stop playback at. If "
               "the show file is shorter, the last look will be held until the "
               "stop point.");
+DEFINE_default_bool(artnet_timecode, false,
+                    "Follow the Art-Net timecode received on this host during "
+                    "playback.");
 
 
 void TerminateRecorder(ShowRecorder *recorder) {
@@ -76,16 +95,15 @@ void TerminateRecorder(ShowRecorder *recorder) {
 
 
 /**
- * Record a show
+ * Parse the list of universes given with -u, this exits if it's not valid.
  */
-int RecordShow() {
+void ParseUniverses(vector<unsigned int> *universes) {
   if (FLAGS_universes.str().empty()) {
     OLA_FATAL << "No universes specified, use -u";
     exit(ola::EXIT_USAGE);
   }
 
   vector<string> universe_strs;
-  vector<unsigned int> universes;
   ola::StringSplit(FLAGS_universes.str(), &universe_strs, ",");
   vector<string>::const_iterator iter = universe_strs.begin();
   for (; iter != universe_strs.end(); ++iter) {
@@ -94,10 +112,20 @@ int RecordShow() {
       OLA_FATAL << *iter << " isn't a valid universe number";
       exit(ola::EXIT_USAGE);
     }
-    universes.push_back(universe);
+    universes->push_back(universe);
   }
+}
+
 
-  ShowRecorder show_recorder(FLAGS_record.str(), universes);
+/**
+ * Record a show
+ */
+int RecordShow() {
+  vector<unsigned int> universes;
+  ParseUniverses(&universes);
+
+  ShowRecorder show_recorder(FLAGS_record.str(), universes, FLAGS_binary,
+                             FLAGS_skip_unchanged);
   int status = show_recorder.Init();
   if (status)
     return status;
@@ -114,7 +142,181 @@ int RecordShow() {
     }
     show_recorder.Record();
   }
-  cout << "Saved " << show_recorder.FrameCount() << " frames" << endl;
+  cout << "Saved " << show_recorder.FrameCount() << " frames";
+  if (FLAGS_skip_unchanged) {
+    cout << ", skipped " << show_recorder.SkippedFrames() << " unchanged";
+  }
+  cout << endl;
+  if (show_recorder.DroppedFrames()) {
+    OLA_WARN << "Dropped " << show_recorder.DroppedFrames()
+             << " frames because the disk couldn't keep up";
+  }
+  return ola::EXIT_OK;
+}
+
+
+/**
+ * Convert a text show file to the binary format
+ */
+int ConvertShow() {
+  if (FLAGS_output.str().empty()) {
+    OLA_FATAL << "No output file specified, use --output";
+    return ola::EXIT_USAGE;
+  }
+
+  ShowLoader loader(FLAGS_convert.str());
+  if (!loader.Load()) {
+    return ola::EXIT_NOINPUT;
+  }
+  if (loader.IsBinary()) {
+    OLA_FATAL << FLAGS_convert.str() << " is already a binary show file";
+    return ola::EXIT_DATAERR;
+  }
+
+  BinaryShowSaver saver(FLAGS_output.str());
+  if (!saver.Open()) {
+    return ola::EXIT_CANTCREAT;
+  }
+
+  unsigned int delay = 0;
+  unsigned int final_wait = binary_show::NO_FINAL_WAIT;
+  uint64_t frames = 0;
+  while (true) {
+    ShowEntry entry;
+    ShowLoader::State state = loader.NextEntry(&entry);
+    if (state == ShowLoader::INVALID_LINE) {
+      OLA_FATAL << "Invalid data at line " << loader.GetCurrentLineNumber();
+      return ola::EXIT_DATAERR;
+    }
+
+    if (state == ShowLoader::END_OF_FILE && entry.buffer.Size() == 0) {
+      // The file ended with a wait.
+      final_wait = delay;
+      break;
+    }
+    if (!saver.NewFrame(delay, entry.universe, entry.buffer)) {
+      return ola::EXIT_IOERR;
+    }
+    frames++;
+    delay = entry.next_wait;
+    if (state == ShowLoader::END_OF_FILE) {
+      break;
+    }
+  }
+
+  if (!saver.Close(final_wait)) {
+    return ola::EXIT_IOERR;
+  }
+  cout << "Converted " << frames << " frames" << endl;
+  return ola::EXIT_OK;
+}
+
+
+/**
+ * The frames fetched from olad's frame history.
+ */
+typedef struct {
+  ola::io::SelectServer *ss;
+  unsigned int pending;
+  bool failed;
+  map<unsigned int, vector<ola::client::HistoryFrame> > universes;
+} HistoryState;
+
+/**
+ * A frame in the show, the universes are interleaved by age.
+ */
+typedef struct {
+  uint64_t age_us;
+  unsigned int universe;
+  const ola::DmxBuffer *data;
+} HistoryEntry;
+
+bool OlderThan(const HistoryEntry &a, const HistoryEntry &b) {
+  return a.age_us > b.age_us;
+}
+
+void HistoryFetched(HistoryState *state, unsigned int universe,
+                    const ola::client::Result &result,
+                    const vector<ola::client::HistoryFrame> &frames) {
+  if (result.Success()) {
+    state->universes[universe] = frames;
+  } else {
+    OLA_WARN << "Failed to fetch the history of universe " << universe
+             << ": " << result.Error();
+    state->failed = true;
+  }
+  if (--state->pending == 0) {
+    state->ss->Terminate();
+  }
+}
+
+
+/**
+ * Save the frame history olad holds to a binary show file
+ */
+int SaveHistory() {
+  if (FLAGS_output.str().empty()) {
+    OLA_FATAL << "No output file specified, use --output";
+    return ola::EXIT_USAGE;
+  }
+  vector<unsigned int> universes;
+  ParseUniverses(&universes);
+
+  ola::client::OlaClientWrapper client;
+  if (!client.Setup()) {
+    OLA_FATAL << "Failed to connect to olad";
+    return ola::EXIT_UNAVAILABLE;
+  }
+
+  HistoryState state;
+  state.ss = client.GetSelectServer();
+  state.pending = universes.size();
+  state.failed = false;
+  vector<unsigned int>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    client.GetClient()->FetchFrameHistory(
+        *iter, 0, 0, ola::NewSingleCallback(HistoryFetched, &state, *iter));
+  }
+  client.GetSelectServer()->Run();
+  if (state.failed) {
+    return ola::EXIT_UNAVAILABLE;
+  }
+
+  vector<HistoryEntry> entries;
+  map<unsigned int, vector<ola::client::HistoryFrame> >::const_iterator
+      uni_iter = state.universes.begin();
+  for (; uni_iter != state.universes.end(); ++uni_iter) {
+    vector<ola::client::HistoryFrame>::const_iterator frame_iter =
+        uni_iter->second.begin();
+    for (; frame_iter != uni_iter->second.end(); ++frame_iter) {
+      HistoryEntry entry = {frame_iter->age_us, uni_iter->first,
+                            &frame_iter->data};
+      entries.push_back(entry);
+    }
+  }
+  // Each universe's frames are already oldest first, this keeps them in order.
+  std::stable_sort(entries.begin(), entries.end(), OlderThan);
+
+  BinaryShowSaver saver(FLAGS_output.str());
+  if (!saver.Open()) {
+    return ola::EXIT_CANTCREAT;
+  }
+
+  uint64_t last_ms = entries.empty() ? 0 : entries[0].age_us / 1000;
+  vector<HistoryEntry>::const_iterator entry_iter = entries.begin();
+  for (; entry_iter != entries.end(); ++entry_iter) {
+    const uint64_t age_ms = entry_iter->age_us / 1000;
+    if (!saver.NewFrame(static_cast<unsigned int>(last_ms - age_ms),
+                        entry_iter->universe, *entry_iter->data)) {
+      return ola::EXIT_IOERR;
+    }
+    last_ms = age_ms;
+  }
+
+  if (!saver.Close()) {
+    return ola::EXIT_IOERR;
+  }
+  cout << "Saved " << entries.size() << " frames" << endl;
   return ola::EXIT_OK;
 }
 
@@ -218,12 +420,25 @@ int PlaybackShow() {
   // Begin playback
   ShowPlayer player(filename);
   int status = player.Init();
+  if (status == ola::EXIT_OK && FLAGS_artnet_timecode &&
+      !player.LockToArtNetTimeCode()) {
+    status = ola::EXIT_UNAVAILABLE;
+  }
   if (status == ola::EXIT_OK) {
     status = player.Playback(FLAGS_iterations,
                              FLAGS_duration,
                              FLAGS_delay,
                              FLAGS_start,
                              FLAGS_stop);
+
+    const PlaybackLateness &lateness = player.GetLateness();
+    if (lateness.sends) {
+      OLA_INFO << "Sent " << lateness.sends << " frame(s), mean lateness "
+               << lateness.total_lateness / lateness.sends / 1000.0
+               << " ms, max lateness " << lateness.max_lateness / 1000.0
+               << " ms, " << lateness.late_sends << " more than "
+               << ShowPlayer::LATE_THRESHOLD_MS << " ms late";
+    }
   }
   return status;
 }
@@ -235,7 +450,8 @@ int PlaybackShow() {
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv,
                "[--record <file> --universes <universe_list>] [--playback "
-               "<file>] [--verify <file>]",
+               "<file>] [--verify <file>] [--convert <file> --output <file>] "
+               "[--history --universes <universe_list> --output <file>]",
                "Record a series of universes, or playback a previously "
                "recorded show.");
 
@@ -248,11 +464,16 @@ int main(int argc, char *argv[]) {
     return PlaybackShow();
   } else if (!FLAGS_record.str().empty()) {
     return RecordShow();
+  } else if (!FLAGS_convert.str().empty()) {
+    return ConvertShow();
+  } else if (FLAGS_history) {
+    return SaveHistory();
   } else if (!FLAGS_verify.str().empty()) {
     const int verified = VerifyShow(FLAGS_verify.str(), &cout);
     return verified;
   } else {
-    OLA_FATAL << "One of --record or --playback or --verify must be provided";
+    OLA_FATAL << "One of --record, --playback, --verify, --convert or "
+                 "--history must be provided";
     ola::DisplayUsage();
   }
   return ola::EXIT_OK;
@@ -23,6 +23,7 @@
 #include <unistd.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
+#include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <ola/StreamingClient.h>
@@ -38,6 +39,59 @@ using ola::StreamingClient;
 
 DEFINE_s_uint32(universe, u, 1, "The universe to send data on");
 DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
+DEFINE_s_uint32(count, c, 0,
+                "Send this many frames as fast as possible, then print the "
+                "throughput and exit.");
+DEFINE_string(socket, "",
+              "Connect to olad using this unix domain socket rather than TCP. "
+              "See olad's --rpc-socket option.");
+DEFINE_default_bool(compare, false,
+                    "With --count and --socket, measure the throughput over "
+                    "both TCP and the unix domain socket.");
+
+/*
+ * Send FLAGS_count frames as fast as possible.
+ * @returns the number of frames per second, or 0 if the send failed.
+ */
+double MeasureThroughput(const StreamingClient::Options &options) {
+  StreamingClient ola_client(options);
+  if (!ola_client.Setup()) {
+    OLA_FATAL << "Setup failed";
+    return 0;
+  }
+
+  ola::DmxBuffer buffer;
+  buffer.Blackout();
+
+  ola::Clock clock;
+  ola::TimeStamp start, end;
+  clock.CurrentMonotonicTime(&start);
+  for (unsigned int i = 0; i < FLAGS_count; i++) {
+    // Change the data each frame so olad can't skip the merge.
+    buffer.SetChannel(0, i & 0xff);
+    if (!ola_client.SendDmx(FLAGS_universe, buffer)) {
+      cout << "Send DMX failed" << endl;
+      return 0;
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+
+  int64_t elapsed_us = (end - start).AsInt();
+  return elapsed_us ? FLAGS_count * 1000000.0 / elapsed_us : 0;
+}
+
+/*
+ * Measure the throughput and print the result.
+ */
+bool RunTest(const StreamingClient::Options &options, const string &label) {
+  double rate = MeasureThroughput(options);
+  if (rate == 0) {
+    return false;
+  }
+  cout << label << ": " << FLAGS_count << " frames, " << rate
+       << " frames/s" << endl;
+  return true;
+}
 
 /*
  * Main
@@ -45,7 +99,29 @@ DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "[options]", "Send DMX512 data to OLA.");
 
-  StreamingClient ola_client;
+  StreamingClient::Options options;
+  options.server_socket = FLAGS_socket.str();
+
+  if (FLAGS_count) {
+    if (FLAGS_compare) {
+      if (options.server_socket.empty()) {
+        OLA_FATAL << "--compare requires --socket";
+        exit(1);
+      }
+      StreamingClient::Options tcp_options;
+      tcp_options.auto_start = false;
+      if (!(RunTest(tcp_options, "TCP") &&
+            RunTest(options, "Unix socket " + options.server_socket))) {
+        exit(1);
+      }
+    } else if (!RunTest(options, options.server_socket.empty() ? "TCP" :
+                        "Unix socket " + options.server_socket)) {
+      exit(1);
+    }
+    return 0;
+  }
+
+  StreamingClient ola_client(options);
   if (!ola_client.Setup()) {
     OLA_FATAL << "Setup failed";
     exit(1);
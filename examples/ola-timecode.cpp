@@ -44,6 +44,12 @@ using std::string;
 using std::vector;
 
 DEFINE_s_string(format, f, "SMPTE", "One of FILM, EBU, DF, SMPTE (default).");
+DEFINE_s_default_bool(run, r, false,
+                      "Have olad generate TimeCode, starting from time_code.");
+DEFINE_default_bool(chase, false,
+                    "Have olad chase the TimeCode sent to it, filling in the "
+                    "frames between updates.");
+DEFINE_default_bool(stop, false, "Stop the TimeCode generator in olad.");
 
 /**
  * Called on when we return from sending timecode data.
@@ -63,11 +69,36 @@ int main(int argc, char *argv[]) {
   ola::AppInit(
       &argc,
       argv,
-      "[options] <time_code>",
+      "[options] [time_code]",
       "Send TimeCode data to OLA. time_code is in the form: \n"
-          "Hours:Minutes:Seconds:Frames");
+          "Hours:Minutes:Seconds:Frames\n"
+          "With --run, olad generates TimeCode from time_code onwards.");
   ola::client::OlaClientWrapper ola_client;
 
+  if (FLAGS_run + FLAGS_chase + FLAGS_stop > 1) {
+    cerr << "Only one of --run, --chase and --stop can be used" << endl;
+    exit(ola::EXIT_USAGE);
+  }
+
+  if (FLAGS_chase || FLAGS_stop) {
+    if (argc != 1) {
+      ola::DisplayUsageAndExit();
+    }
+    if (!ola_client.Setup()) {
+      OLA_FATAL << "Setup failed";
+      exit(ola::EXIT_UNAVAILABLE);
+    }
+    ola::client::SetCallback *callback = ola::NewSingleCallback(
+        &TimeCodeDone, ola_client.GetSelectServer());
+    if (FLAGS_chase) {
+      ola_client.GetClient()->ChaseTimeCode(callback);
+    } else {
+      ola_client.GetClient()->StopTimeCodeGenerator(callback);
+    }
+    ola_client.GetSelectServer()->Run();
+    return ola::EXIT_OK;
+  }
+
   if (argc != 2)
     ola::DisplayUsageAndExit();
 
@@ -125,9 +156,13 @@ int main(int argc, char *argv[]) {
     exit(ola::EXIT_UNAVAILABLE);
   }
 
-  ola_client.GetClient()->SendTimeCode(
-      timecode,
-      ola::NewSingleCallback(&TimeCodeDone, ola_client.GetSelectServer()));
+  ola::client::SetCallback *callback = ola::NewSingleCallback(
+      &TimeCodeDone, ola_client.GetSelectServer());
+  if (FLAGS_run) {
+    ola_client.GetClient()->StartTimeCodeGenerator(timecode, callback);
+  } else {
+    ola_client.GetClient()->SendTimeCode(timecode, callback);
+  }
 
   ola_client.GetSelectServer()->Run();
   return ola::EXIT_OK;
@@ -22,169 +22,119 @@
 #include <signal.h>
 #include <stdlib.h>
 
+#include <ola/Callback.h>
 #include <ola/Clock.h>
-#include <ola/Constants.h>
-#include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
-#include <ola/OlaCallbackClient.h>
-#include <ola/OlaClientWrapper.h>
 #include <ola/StringUtils.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/client/OlaClient.h>
+#include <ola/io/SelectServer.h>
 #include <ola/io/StdinHandler.h>
 
 #include <iostream>
 #include <iomanip>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
-using ola::DmxBuffer;
-using ola::OlaCallbackClientWrapper;
 using ola::StringToInt;
 using ola::TimeInterval;
 using ola::TimeStamp;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::client::UniverseStats;
 using ola::io::SelectServer;
 using std::cerr;
 using std::cout;
 using std::endl;
+using std::fixed;
+using std::setprecision;
 using std::setw;
 using std::string;
 using std::vector;
 
+DEFINE_uint32(interval, 0,
+              "Print the stats every interval seconds, 0 to only print them "
+              "when p is pressed.");
 
+/*
+ * olad keeps the frame counters for each universe, so we only need to fetch
+ * them. The rates are worked out from the change in the counters since the
+ * stats were last reset.
+ */
 class UniverseTracker {
  public:
-    UniverseTracker(OlaCallbackClientWrapper *wrapper,
-                    const vector<unsigned int> &universes);
+    UniverseTracker(OlaClientWrapper *wrapper,
+                    const std::set<unsigned int> &universes);
     ~UniverseTracker() {}
 
     bool Run();
     void Stop() { m_wrapper->GetSelectServer()->Terminate(); }
-    void PrintStats();
-    void ResetStats();
 
  protected:
     void Input(int c);
 
  private:
-    struct UniverseStats {
-     public:
-      uint16_t shortest_frame;
-      uint16_t longest_frame;
-      uint64_t frame_count;
-      uint64_t frame_changes;
-      DmxBuffer frame_data;
-
-      UniverseStats() { Reset(); }
-
-      void Reset() {
-        shortest_frame = ola::DMX_UNIVERSE_SIZE + 1,
-        longest_frame = 0;
-        frame_count = 0;
-        frame_changes = 0;
-      }
-    };
+    typedef enum {
+      RESET_STATS,
+      PRINT_STATS,
+      PRINT_STATS_AND_QUIT,
+    } StatsAction;
 
     typedef std::map<unsigned int, UniverseStats> UniverseStatsMap;
-    UniverseStatsMap m_stats;
+
+    const std::set<unsigned int> m_universes;
+    UniverseStatsMap m_baseline;
     ola::TimeStamp m_start_time;
-    OlaCallbackClientWrapper *m_wrapper;
+    OlaClientWrapper *m_wrapper;
     ola::io::StdinHandler m_stdin_handler;
     ola::Clock m_clock;
 
-    void UniverseData(unsigned int universe, const DmxBuffer &dmx,
-                      const string &error);
-    void RegisterComplete(const string &error);
+    void FetchStats(StatsAction action);
+    bool PeriodicPrint();
+    void StatsReceived(StatsAction action,
+                       const Result &result,
+                       const vector<UniverseStats> &stats);
+    void ResetStats(const vector<UniverseStats> &stats);
+    void PrintStats(const vector<UniverseStats> &stats);
 };
 
 
-UniverseTracker::UniverseTracker(OlaCallbackClientWrapper *wrapper,
-                                 const vector<unsigned int> &universes)
-    : m_wrapper(wrapper),
+UniverseTracker::UniverseTracker(OlaClientWrapper *wrapper,
+                                 const std::set<unsigned int> &universes)
+    : m_universes(universes),
+      m_wrapper(wrapper),
       m_stdin_handler(wrapper->GetSelectServer(),
                       ola::NewCallback(this, &UniverseTracker::Input)) {
-  // set callback
-  m_wrapper->GetClient()->SetDmxCallback(
-      ola::NewCallback(this, &UniverseTracker::UniverseData));
-
-  vector<unsigned int>::const_iterator iter = universes.begin();
-  for (; iter != universes.end(); ++iter) {
-    struct UniverseStats stats;
-    m_stats[*iter] = stats;
-
-    // register here
-    m_wrapper->GetClient()->RegisterUniverse(
-      *iter,
-      ola::REGISTER,
-      ola::NewSingleCallback(this, &UniverseTracker::RegisterComplete));
-  }
 }
 
 
 bool UniverseTracker::Run() {
-  m_clock.CurrentMonotonicTime(&m_start_time);
+  FetchStats(RESET_STATS);
+  if (FLAGS_interval) {
+    m_wrapper->GetSelectServer()->RegisterRepeatingTimeout(
+        FLAGS_interval * 1000,
+        ola::NewCallback(this, &UniverseTracker::PeriodicPrint));
+  }
   m_wrapper->GetSelectServer()->Run();
   return true;
 }
 
 
-void UniverseTracker::PrintStats() {
-  UniverseStatsMap::iterator iter = m_stats.begin();
-  TimeStamp now;
-  m_clock.CurrentMonotonicTime(&now);
-
-  TimeInterval interval = now - m_start_time;
-  OLA_INFO << "Time delta was " << interval;
-
-  for (; iter != m_stats.end(); ++iter) {
-    const UniverseStats stats = iter->second;
-
-    float fps = 0.0;
-    if (interval.Seconds() > 0)
-      fps = static_cast<float>(stats.frame_count) / interval.Seconds();
-
-    cout << "Universe " << iter->first << endl;
-    cout << "  Frames Received: " << stats.frame_count <<
-      ", Frames/sec: " << fps << endl;
-    cout << "  Frame changes: " << stats.frame_changes << endl;
-    cout << "  Smallest Frame: ";
-    if (stats.shortest_frame == ola::DMX_UNIVERSE_SIZE + 1)
-      cout << "N/A";
-    else
-      cout << stats.shortest_frame;
-    cout << ", Largest Frame: ";
-    if (stats.longest_frame == 0)
-      cout << "N/A";
-    else
-      cout << stats.longest_frame;
-    cout << endl;
-    cout << "------------------------------" << endl;
-  }
-}
-
-
-void UniverseTracker::ResetStats() {
-  m_clock.CurrentMonotonicTime(&m_start_time);
-
-  UniverseStatsMap::iterator iter = m_stats.begin();
-  for (; iter != m_stats.end(); ++iter) {
-    iter->second.Reset();
-  }
-  cout << "Reset counters" << endl;
-}
-
 void UniverseTracker::Input(int c) {
   switch (c) {
     case 'q':
-      m_wrapper->GetSelectServer()->Terminate();
+      FetchStats(PRINT_STATS_AND_QUIT);
       break;
     case 'p':
-      PrintStats();
+      FetchStats(PRINT_STATS);
       break;
     case 'r':
-      ResetStats();
+      FetchStats(RESET_STATS);
       break;
     default:
       break;
@@ -192,43 +142,98 @@ void UniverseTracker::Input(int c) {
 }
 
 
-void UniverseTracker::UniverseData(unsigned int universe, const DmxBuffer &dmx,
-                                   const string &error) {
-  if (!error.empty()) {
-    OLA_WARN << error;
-    return;
+void UniverseTracker::FetchStats(StatsAction action) {
+  m_wrapper->GetClient()->FetchUniverseStats(
+      ola::NewSingleCallback(this, &UniverseTracker::StatsReceived, action));
+}
+
+
+bool UniverseTracker::PeriodicPrint() {
+  FetchStats(PRINT_STATS);
+  return true;
+}
+
+
+void UniverseTracker::StatsReceived(StatsAction action,
+                                    const Result &result,
+                                    const vector<UniverseStats> &stats) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to fetch the universe stats: " << result.Error();
+  } else if (action == RESET_STATS) {
+    ResetStats(stats);
+  } else {
+    PrintStats(stats);
   }
 
-  UniverseStatsMap::iterator iter = m_stats.find(universe);
-  if (iter == m_stats.end()) {
-    OLA_WARN << "Received data for unknown universe " << universe;
-    return;
+  if (action == PRINT_STATS_AND_QUIT) {
+    Stop();
   }
+}
 
-  if (dmx.Size() < iter->second.shortest_frame)
-    iter->second.shortest_frame = dmx.Size();
 
-  if (dmx.Size() > iter->second.longest_frame)
-    iter->second.longest_frame = dmx.Size();
+void UniverseTracker::ResetStats(const vector<UniverseStats> &stats) {
+  m_clock.CurrentMonotonicTime(&m_start_time);
+  m_baseline.clear();
+  vector<UniverseStats>::const_iterator iter = stats.begin();
+  for (; iter != stats.end(); ++iter) {
+    m_baseline[iter->universe] = *iter;
+  }
+  cout << "Reset counters" << endl;
+}
 
-  iter->second.frame_count++;
 
-  DmxBuffer &last_dmx = iter->second.frame_data;
-  if (last_dmx.Size() == 0) {
-    // this is the first frame
-    last_dmx.Set(dmx);
-  } else {
-    if (last_dmx.Size() != dmx.Size() || last_dmx != dmx) {
-      // the frame changed
-      iter->second.frame_changes++;
-      last_dmx.Set(dmx);
+void UniverseTracker::PrintStats(const vector<UniverseStats> &stats) {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  TimeInterval interval = now - m_start_time;
+  OLA_INFO << "Time delta was " << interval;
+  const double seconds = interval.AsInt() / 1000000.0;
+
+  cout << setw(10) << "Universe" << setw(10) << "Input/s" << setw(10)
+       << "Output/s" << setw(14) << "Slots/Frame" << setw(9) << "Sources"
+       << setw(8) << "Active" << setw(12) << "Merge (us)" << setw(16)
+       << "Last Input (ms)" << endl;
+
+  vector<UniverseStats>::const_iterator iter = stats.begin();
+  for (; iter != stats.end(); ++iter) {
+    if (!m_universes.empty() && !m_universes.count(iter->universe)) {
+      continue;
+    }
+
+    // A universe created after the reset starts from 0.
+    UniverseStats baseline;
+    UniverseStatsMap::const_iterator baseline_iter =
+        m_baseline.find(iter->universe);
+    if (baseline_iter != m_baseline.end()) {
+      baseline = baseline_iter->second;
     }
-  }
-}
 
-void UniverseTracker::RegisterComplete(const string &error) {
-  if (!error.empty())
-    OLA_WARN << "Register command failed with " << errno;
+    const uint64_t input_frames = iter->input_frames - baseline.input_frames;
+    const uint64_t output_frames =
+        iter->output_frames - baseline.output_frames;
+    const uint64_t changed_slots =
+        iter->changed_slots - baseline.changed_slots;
+    const uint64_t merge_time = iter->merge_time_us - baseline.merge_time_us;
+
+    cout << fixed << setprecision(1) << setw(10) << iter->universe
+         << setw(10) << (seconds > 0 ? input_frames / seconds : 0.0)
+         << setw(10) << (seconds > 0 ? output_frames / seconds : 0.0)
+         << setw(14)
+         << (output_frames ? static_cast<double>(changed_slots) / output_frames
+                           : 0.0)
+         << setw(9) << iter->source_count
+         << setw(8) << iter->active_sources
+         << setw(12)
+         << (input_frames ? static_cast<double>(merge_time) / input_frames
+                          : 0.0)
+         << setw(16);
+    if (iter->has_input) {
+      cout << iter->ms_since_input;
+    } else {
+      cout << "N/A";
+    }
+    cout << endl;
+  }
 }
 
 
@@ -250,24 +255,20 @@ int main(int argc, char *argv[]) {
   ola::AppInit(
       &argc,
       argv,
-      "[options] <universe1> <universe2> ...",
-      "Watch one or more universes and produce stats on DMX frame rates.");
+      "[options] [universe1] [universe2] ...",
+      "Produce stats on DMX frame rates for some or all universes.");
 
-  vector<unsigned int> universes;
+  std::set<unsigned int> universes;
   for (int i = 1; i < argc; i++) {
     unsigned int universe;
     if (!StringToInt(argv[i], &universe, true)) {
       cerr << "Invalid Universe " << argv[i] << endl;
       exit(ola::EXIT_USAGE);
     }
-    universes.push_back(universe);
-  }
-
-  if (universes.size() <= 0) {
-    ola::DisplayUsageAndExit();
+    universes.insert(universe);
   }
 
-  ola::OlaCallbackClientWrapper ola_client;
+  OlaClientWrapper ola_client;
   if (!ola_client.Setup()) {
     OLA_FATAL << "Setup failed";
     exit(ola::EXIT_UNAVAILABLE);
@@ -278,10 +279,7 @@ int main(int argc, char *argv[]) {
   ola::InstallSignal(SIGINT, InteruptSignal);
   cout << "Actions:" << endl;
   cout << "  p - Print stats" << endl;
-  cout << "  q - Quit" << endl;
+  cout << "  q - Print stats & quit" << endl;
   cout << "  r - Reset stats" << endl;
-  bool r = tracker.Run();
-  if (r)
-    tracker.PrintStats();
-  return r;
+  return tracker.Run() ? ola::EXIT_OK : ola::EXIT_SOFTWARE;
 }
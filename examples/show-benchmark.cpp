@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ * show-benchmark.cpp
+ * Measure how quickly show files can be written & read.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/base/Flags.h>
+#include <ola/base/Init.h>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "examples/ShowLoader.h"
+#include "examples/ShowSaver.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_string(file, "show-benchmark.show",
+              "The show file to write, this is removed when we're done.");
+DEFINE_s_uint32(frames, f, 20000, "The number of frames in the show");
+DEFINE_s_uint32(universes, u, 4, "The number of universes in the show");
+
+// Stops the compiler from optimizing the loops away.
+static volatile unsigned int sink;
+
+/*
+ * Write the show file, and return the time per frame in ns.
+ */
+double WriteShow(bool binary) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  DmxBuffer buffer;
+  ShowSaver saver(FLAGS_file.str(), binary);
+  if (!saver.Open()) {
+    return 0;
+  }
+
+  Clock clock;
+  TimeStamp start, end, frame_time;
+  clock.CurrentMonotonicTime(&start);
+  frame_time = start;
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    // A chase, so most of the slots change between frames.
+    for (unsigned int j = 0; j < ola::DMX_UNIVERSE_SIZE; j++) {
+      data[j] = (i + j) & 0xff;
+    }
+    buffer.Set(data, sizeof(data));
+    frame_time += TimeInterval(0, 25000);
+    saver.NewFrame(frame_time, 1 + i % FLAGS_universes, buffer);
+  }
+  saver.Close();
+  clock.CurrentMonotonicTime(&end);
+
+  TimeInterval duration = end - start;
+  return duration.AsInt() * 1000.0 / FLAGS_frames;
+}
+
+/*
+ * Read the show file back, and return the time per frame in ns.
+ */
+double ReadShow() {
+  ShowLoader loader(FLAGS_file.str());
+  if (!loader.Load()) {
+    return 0;
+  }
+
+  Clock clock;
+  TimeStamp start, end;
+  ShowEntry entry;
+  unsigned int frames = 0;
+  unsigned int result = 0;
+  clock.CurrentMonotonicTime(&start);
+  while (true) {
+    ShowLoader::State state = loader.NextEntry(&entry);
+    if (state == ShowLoader::INVALID_LINE) {
+      OLA_WARN << "Invalid show file at line "
+               << loader.GetCurrentLineNumber();
+      return 0;
+    }
+    frames++;
+    result += entry.buffer.Get(0) + entry.universe;
+    if (state == ShowLoader::END_OF_FILE) {
+      break;
+    }
+  }
+  clock.CurrentMonotonicTime(&end);
+  sink = result;
+
+  TimeInterval duration = end - start;
+  return duration.AsInt() * 1000.0 / frames;
+}
+
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark writing and reading text & binary show files.");
+
+  if (!FLAGS_frames || !FLAGS_universes) {
+    OLA_FATAL << "--frames and --universes must be greater than 0";
+    return 1;
+  }
+
+  cout << std::setw(8) << "format" << std::setw(16) << "write (ns)"
+       << std::setw(16) << "read (ns)" << endl;
+  const bool formats[] = {false, true};
+  for (unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    cout << std::setw(8) << (formats[i] ? "binary" : "text")
+         << std::fixed << std::setprecision(1)
+         << std::setw(16) << WriteShow(formats[i])
+         << std::setw(16) << ReadShow() << endl;
+  }
+  unlink(FLAGS_file.str().c_str());
+  return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * AsyncLogDestination.h
+ * A LogDestination that writes from a background thread.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup logging
+ * @{
+ * @file AsyncLogDestination.h
+ * @brief A LogDestination that writes from a background thread.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_ASYNCLOGDESTINATION_H_
+#define INCLUDE_OLA_ASYNCLOGDESTINATION_H_
+
+#include <ola/Logging.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/Thread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+namespace ola {
+
+class ShardedCounter;
+
+/**
+ * @addtogroup logging
+ * @{
+ */
+
+/**
+ * @brief A LogDestination that hands lines to a background thread.
+ *
+ * Writing to stderr or syslog can block, and when it does, so does the thread
+ * that's logging. This copies each line into a bounded, lock free queue, and
+ * a writer thread passes them on to the wrapped destination.
+ *
+ * If the queue is full the line is dropped and counted, rather than blocking
+ * the caller. Lines longer than MAX_LINE_LENGTH are truncated. Fatal lines
+ * are written synchronously, after the queue has been flushed, so they aren't
+ * lost if the program exits.
+ *
+ * @examplepara
+ * @code
+ *   ola::AsyncLogDestination *destination = new ola::AsyncLogDestination(
+ *       new ola::StdErrorLogDestination());
+ *   destination->Init();
+ *   ola::InitLogging(ola::OLA_LOG_INFO, destination);
+ * @endcode
+ */
+class AsyncLogDestination: public LogDestination {
+ public:
+  /**
+   * @brief Create a new AsyncLogDestination.
+   * @param destination the destination to write to, ownership is
+   *   transferred.
+   * @param queue_size the number of lines that can be queued, this is rounded
+   *   up to a power of two.
+   */
+  explicit AsyncLogDestination(LogDestination *destination,
+                               unsigned int queue_size = DEFAULT_QUEUE_SIZE);
+
+  /**
+   * @brief Destructor.
+   *
+   * This writes any queued lines and stops the writer thread.
+   */
+  ~AsyncLogDestination();
+
+  /**
+   * @brief Start the writer thread, if it isn't already running.
+   * @returns true if the thread is running, false otherwise. Until this is
+   *   called, lines are written synchronously.
+   */
+  bool Init();
+
+  /**
+   * @brief Queue a line to be written.
+   */
+  void Write(log_level level, const std::string &log_line);
+
+  /**
+   * @brief Block until all the lines queued so far have been written.
+   */
+  void Flush();
+
+  /**
+   * @brief The number of lines dropped because the queue was full.
+   */
+  uint64_t Dropped() const;
+
+  /**
+   * @brief Count dropped lines in an exported variable as well.
+   * @param counter the counter to increment, ownership is not transferred.
+   *   The lines dropped so far are added to it.
+   */
+  void SetDropCounter(ShardedCounter *counter);
+
+  /**
+   * @brief The default number of lines that can be queued.
+   */
+  static const unsigned int DEFAULT_QUEUE_SIZE = 1024;
+
+  /**
+   * @brief The longest line that can be queued, including the newline.
+   */
+  static const unsigned int MAX_LINE_LENGTH = 512;
+
+ private:
+  typedef struct {
+    size_t sequence;
+    log_level level;
+    unsigned int length;
+    char line[MAX_LINE_LENGTH];
+  } Slot;
+
+  class WriterThread: public ola::thread::Thread {
+   public:
+    explicit WriterThread(AsyncLogDestination *parent)
+        : Thread(Thread::Options("ola-log")),
+          m_parent(parent) {
+    }
+
+   protected:
+    void *Run();
+
+   private:
+    AsyncLogDestination *m_parent;
+  };
+
+  std::auto_ptr<LogDestination> m_destination;
+  Slot *m_slots;
+  const size_t m_mask;
+  size_t m_enqueue_pos;
+  size_t m_dequeue_pos;  // only used by the writer thread
+  size_t m_written;
+  uint64_t m_dropped;
+  ShardedCounter *m_drop_counter;
+
+  int m_writer_waiting;
+  bool m_running;
+  bool m_stop;  // protected by m_mutex
+  ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_work_available;
+  ola::thread::ConditionVariable m_drained;
+  WriterThread m_writer;
+
+  bool Push(log_level level, const std::string &log_line);
+  bool WriteNext();
+  void WriterLoop();
+  void WakeWriter();
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogDestination);
+};
+
+/**
+ * @}
+ */
+}  // namespace ola
+#endif  // INCLUDE_OLA_ASYNCLOGDESTINATION_H_
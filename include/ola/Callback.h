@@ -36,6 +36,9 @@
  * Callbacks are used throughout OLA to reduce the coupling between classes
  * and make for more modular code.
  *
+ * The memory for callbacks is recycled by the CallbackAllocator, so creating
+ * and running a single use callback doesn't normally touch the heap.
+ *
  * Avoid creating Callbacks by directly calling the constructor. Instead use
  * the NewSingleCallback() and NewCallback() helper methods.
  *
@@ -105,6 +108,8 @@
 #ifndef INCLUDE_OLA_CALLBACK_H_
 #define INCLUDE_OLA_CALLBACK_H_
 
+#include <ola/CallbackAllocator.h>
+
 namespace ola {
 
 /**
@@ -116,7 +121,7 @@ namespace ola {
  * @brief The base class for all 0 argument callbacks.
  */
 template <typename ReturnType>
-class BaseCallback0 {
+class BaseCallback0: public PooledCallback {
  public:
   virtual ~BaseCallback0() {}
   virtual ReturnType Run() = 0;
@@ -979,7 +984,7 @@ inline Callback0<ReturnType>* NewCallback(
  * @brief The base class for all 1 argument callbacks.
  */
 template <typename ReturnType, typename Arg0>
-class BaseCallback1 {
+class BaseCallback1: public PooledCallback {
  public:
   virtual ~BaseCallback1() {}
   virtual ReturnType Run(Arg0 arg0) = 0;
@@ -1882,7 +1887,7 @@ inline Callback1<ReturnType, Arg0>* NewCallback(
  * @brief The base class for all 2 argument callbacks.
  */
 template <typename ReturnType, typename Arg0, typename Arg1>
-class BaseCallback2 {
+class BaseCallback2: public PooledCallback {
  public:
   virtual ~BaseCallback2() {}
   virtual ReturnType Run(Arg0 arg0, Arg1 arg1) = 0;
@@ -2825,7 +2830,7 @@ inline Callback2<ReturnType, Arg0, Arg1>* NewCallback(
  * @brief The base class for all 3 argument callbacks.
  */
 template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2>
-class BaseCallback3 {
+class BaseCallback3: public PooledCallback {
  public:
   virtual ~BaseCallback3() {}
   virtual ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2) = 0;
@@ -3808,7 +3813,7 @@ inline Callback3<ReturnType, Arg0, Arg1, Arg2>* NewCallback(
  * @brief The base class for all 4 argument callbacks.
  */
 template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2, typename Arg3>  // NOLINT(whitespace/line_length)
-class BaseCallback4 {
+class BaseCallback4: public PooledCallback {
  public:
   virtual ~BaseCallback4() {}
   virtual ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) = 0;
@@ -0,0 +1,107 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocator.h
+ * Recycles the memory used by callbacks.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup callbacks
+ * @{
+ * @file CallbackAllocator.h
+ * @brief Recycles the memory used by callbacks.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_CALLBACKALLOCATOR_H_
+#define INCLUDE_OLA_CALLBACKALLOCATOR_H_
+
+#include <stddef.h>
+
+namespace ola {
+
+/**
+ * @addtogroup callbacks
+ * @{
+ */
+
+/**
+ * @brief Recycles the memory used by callbacks.
+ *
+ * Single use callbacks are created and destroyed for every timeout, RPC and
+ * RDM request. Rather than going to the heap each time, the memory for
+ * callbacks up to MAX_POOLED_SIZE bytes is kept on a free list for each size
+ * class and handed out again.
+ *
+ * Each thread keeps a small cache of free blocks, backed by a bounded, lock
+ * free list that's shared between threads, so a callback can be created in
+ * one thread and deleted in another. If the free lists are empty the memory
+ * comes from the heap, if they're full the memory is returned to the heap.
+ */
+class CallbackAllocator {
+ public:
+  /**
+   * @brief Allocate memory for a callback.
+   * @param size the size of the callback object.
+   */
+  static void *Allocate(size_t size);
+
+  /**
+   * @brief Free memory returned by Allocate().
+   * @param ptr the memory to free, may be NULL.
+   * @param size the size passed to Allocate().
+   */
+  static void Free(void *ptr, size_t size);
+
+  /**
+   * @brief The number of times a free list was empty, and the memory had to
+   *   come from the heap.
+   */
+  static unsigned int HeapAllocations();
+
+  /**
+   * @brief Callbacks larger than this always come from the heap.
+   */
+  static const size_t MAX_POOLED_SIZE = 128;
+};
+
+
+/**
+ * @brief The base class of all callbacks.
+ *
+ * This routes new and delete for every callback through the
+ * CallbackAllocator.
+ */
+class PooledCallback {
+ public:
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Free(ptr, size);
+  }
+
+ protected:
+  PooledCallback() {}
+  ~PooledCallback() {}
+};
+
+/**
+ * @}
+ */
+}  // namespace ola
+#endif  // INCLUDE_OLA_CALLBACKALLOCATOR_H_
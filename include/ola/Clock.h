@@ -260,6 +260,22 @@ class Clock {
    */
   virtual void CurrentMonotonicTime(TimeStamp* timestamp) const;
 
+  /**
+   * @brief Sets timestamp to the current monotonic time, with a lower
+   * resolution.
+   *
+   * Where the system has a coarse monotonic clock, this is much cheaper than
+   * CurrentMonotonicTime, but only has a resolution of a few milliseconds.
+   * It's suitable for expiring things that last for seconds. Otherwise it's
+   * the same as CurrentMonotonicTime.
+   *
+   * Code running in the SelectServer thread should prefer
+   * SelectServerInterface::WakeUpTime, which doesn't read the clock at all.
+   * @sa Clock::CurrentMonotonicTime
+   * @param[out] timestamp A TimeStamp pointer
+   */
+  virtual void CurrentCoarseMonotonicTime(TimeStamp* timestamp) const;
+
   /**
    * @brief Sets timestamp to the current real time.
    *
@@ -299,6 +315,7 @@ class MockClock: public Clock {
   void AdvanceTime(int32_t sec, int32_t usec);
 
   void CurrentMonotonicTime(TimeStamp *timestamp) const;
+  void CurrentCoarseMonotonicTime(TimeStamp *timestamp) const;
   void CurrentRealTime(TimeStamp *timestamp) const;
   void CurrentTime(TimeStamp *timestamp) const;
 
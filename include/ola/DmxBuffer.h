@@ -165,6 +165,20 @@ class DmxBuffer {
      */
     bool SetFromString(const std::string &data);
 
+    /**
+     * @brief Set values from a comma separated list of values.
+     * @param data the characters to parse, this doesn't need to be NULL
+     *   terminated.
+     * @param length the number of characters in data.
+     * @return true if the set was successful and false if it failed
+     * @sa SetFromString(const std::string&)
+     *
+     * This parses the values in place, so callers which already have the data
+     * in a buffer, e.g. a line of a show file, don't need to copy it into a
+     * string first.
+     */
+    bool SetFromString(const char *data, unsigned int length);
+
     /**
      * @brief Set a Range of data to a single value. Calling this on an
      * uninitialized buffer will call Blackout() first. Attempted to set data
@@ -264,6 +278,14 @@ class DmxBuffer {
      */
     std::string ToString() const;
 
+    /**
+     * @brief Convert the DmxBuffer to a human readable representation.
+     * @param output the string to write to, any existing contents are
+     *   replaced. Re-using the same string avoids allocating memory each time.
+     * @sa ToString()
+     */
+    void ToString(std::string *output) const;
+
  private:
     bool Init();
     bool DuplicateIfNeeded();
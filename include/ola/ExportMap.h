@@ -32,12 +32,17 @@
 
 #include <ola/base/Macro.h>
 #include <ola/StringUtils.h>
+#include <ola/dmx/ReceiveStats.h>
+#include <ola/thread/Mutex.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <functional>
+#include <ostream>
 #include <map>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ola {
@@ -201,6 +206,8 @@ class CounterVariable: public BaseVariable {
 template<typename Type>
 class MapVariable: public BaseVariable {
  public:
+  typedef typename std::map<std::string, Type>::const_iterator const_iterator;
+
   MapVariable(const std::string &name, const std::string &label)
       : BaseVariable(name),
         m_label(label) {}
@@ -212,6 +219,9 @@ class MapVariable: public BaseVariable {
   const std::string Value() const;
   const std::string Label() const { return m_label; }
 
+  const_iterator Begin() const { return m_variables.begin(); }
+  const_iterator End() const { return m_variables.end(); }
+
  protected:
   std::map<std::string, Type> m_variables;
 
@@ -316,10 +326,234 @@ inline const std::string MapVariable<std::string>::Value() const {
 
 
 
+/**
+ * @brief A map of ReceiveStats, keyed by universe or source.
+ *
+ * Unlike the other variables, this can be read from a different thread to the
+ * one updating the statistics. Entries are only removed by Remove(), which
+ * should be called by the thread updating the statistics once a source has
+ * timed out.
+ */
+class ReceiveStatsMap: public BaseVariable {
+ public:
+  ReceiveStatsMap(const std::string &name, const std::string &label)
+      : BaseVariable(name),
+        m_label(label) {}
+  ~ReceiveStatsMap() {}
+
+  /**
+   * @brief Lookup or create the statistics for a key.
+   * @param key the universe or source.
+   * @returns a pointer to the ReceiveStats, which is valid until the key is
+   *   removed.
+   */
+  dmx::ReceiveStats *Get(const std::string &key);
+
+  /**
+   * @brief Remove the statistics for a key.
+   * @param key the universe or source.
+   *
+   * Any pointer returned by Get() for the key is invalid after this.
+   */
+  void Remove(const std::string &key);
+
+  /**
+   * @brief Copy the current statistics.
+   * @param[out] stats the key and statistics for each entry.
+   */
+  void Snapshot(
+      std::vector<std::pair<std::string, dmx::ReceiveStats> > *stats) const;
+
+  const std::string Value() const;
+  const std::string Label() const { return m_label; }
+
+ private:
+  typedef std::map<std::string, dmx::ReceiveStats> StatsMap;
+
+  StatsMap m_stats;
+  std::string m_label;
+  mutable ola::thread::Mutex m_mutex;
+};
+
+
+/**
+ * @brief A counter that can be incremented from any thread.
+ *
+ * The count is split across a number of shards, each on its own cache line.
+ * A thread always increments the same shard, so threads don't contend for the
+ * same memory, and the shards are summed when the value is read.
+ *
+ * The pointer returned by ExportMap::GetShardedCounterVar() can be kept and
+ * used as a handle, which avoids the name lookup for each increment.
+ */
+class ShardedCounter: public BaseVariable {
+ public:
+  explicit ShardedCounter(const std::string &name);
+  ~ShardedCounter() {}
+
+  /**
+   * @brief Add one to the counter.
+   */
+  void Increment() { Add(1); }
+
+  /**
+   * @brief Add to the counter.
+   * @param value the amount to add.
+   */
+  void Add(uint64_t value);
+
+  /**
+   * @brief Return the sum of all the shards.
+   */
+  uint64_t Get() const;
+
+  /**
+   * @brief Reset the counter to 0.
+   *
+   * Increments made while this is running may be lost.
+   */
+  void Reset();
+
+  const std::string Value() const;
+
+  /**
+   * @brief The number of shards.
+   */
+  static const unsigned int SHARDS = 16;
+
+ private:
+  static const unsigned int CACHE_LINE_SIZE = 64;
+
+  typedef struct {
+    uint64_t value;
+    uint8_t padding[CACHE_LINE_SIZE - sizeof(uint64_t)];
+  } Shard;
+
+  Shard m_shards[SHARDS];
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedCounter);
+};
+
+
+/**
+ * @brief A map of ShardedCounters, keyed by universe, port or similar.
+ *
+ * Get() returns a pointer that's valid for the lifetime of the map, so the
+ * lookup can be done once, e.g. when a universe is created, rather than on
+ * each increment. Entries are never removed.
+ */
+class ShardedCounterMap: public BaseVariable {
+ public:
+  ShardedCounterMap(const std::string &name, const std::string &label)
+      : BaseVariable(name),
+        m_label(label) {}
+  ~ShardedCounterMap();
+
+  /**
+   * @brief Lookup or create the counter for a key.
+   * @param key the key
+   * @returns a pointer to the counter, which is valid for the lifetime of the
+   *   map.
+   */
+  ShardedCounter *Get(const std::string &key);
+
+  /**
+   * @brief Copy the current values.
+   * @param[out] values the key and value for each entry, sorted by key.
+   */
+  void Snapshot(std::vector<std::pair<std::string, uint64_t> > *values) const;
+
+  const std::string Value() const;
+  const std::string Label() const { return m_label; }
+
+ private:
+  typedef std::map<std::string, ShardedCounter*> CounterMap;
+
+  CounterMap m_counters;
+  std::string m_label;
+  mutable ola::thread::Mutex m_mutex;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedCounterMap);
+};
+
+
+/**
+ * @brief A histogram with fixed buckets.
+ *
+ * Each bucket counts the values less than or equal to its upper bound, that
+ * weren't counted by a lower bucket. Values larger than the last bound go
+ * into an overflow bucket. Record() can be called from any thread.
+ *
+ * This is typically used for latencies in microseconds, see
+ * DefaultLatencyBounds().
+ */
+class Histogram: public BaseVariable {
+ public:
+  /**
+   * @brief Create a new Histogram.
+   * @param name the variable name.
+   * @param bounds the upper bound of each bucket, in increasing order.
+   */
+  Histogram(const std::string &name, const std::vector<uint64_t> &bounds);
+  ~Histogram() {}
+
+  /**
+   * @brief Add a value to the histogram.
+   * @param value the value to add.
+   */
+  void Record(uint64_t value);
+
+  /**
+   * @brief The upper bounds of the buckets.
+   */
+  const std::vector<uint64_t> &Bounds() const { return m_bounds; }
+
+  /**
+   * @brief Copy the bucket counts.
+   * @param[out] counts the count for each bucket, followed by the count of
+   *   the overflow bucket.
+   */
+  void Buckets(std::vector<uint64_t> *counts) const;
+
+  /**
+   * @brief The number of values recorded.
+   */
+  uint64_t Count() const;
+
+  /**
+   * @brief The sum of the values recorded.
+   */
+  uint64_t Sum() const;
+
+  /**
+   * @brief Reset all the buckets to 0.
+   */
+  void Reset();
+
+  const std::string Value() const;
+
+  /**
+   * @brief Bounds suitable for latencies, from 10us to 1s.
+   */
+  static std::vector<uint64_t> DefaultLatencyBounds();
+
+ private:
+  const std::vector<uint64_t> m_bounds;
+  std::vector<uint64_t> m_counts;
+  uint64_t m_sum;
+
+  DISALLOW_COPY_AND_ASSIGN(Histogram);
+};
+
 
 /**
  * @brief A container for the exported variables.
  *
+ * Variables can be created from any thread, for example by plugins that are
+ * started on their own thread. Once created, the ShardedCounter,
+ * ShardedCounterMap, Histogram and ReceiveStatsMap variables can be updated
+ * from any thread, the other variables must only be used from a single
+ * thread.
  */
 class ExportMap {
  public:
@@ -372,12 +606,74 @@ class ExportMap {
   UIntMap *GetUIntMapVar(const std::string &name,
                          const std::string &label = "");
 
+  /**
+   * @brief Lookup or create a ReceiveStatsMap.
+   * @param name the name of this variable.
+   * @param label the label to use for the keys.
+   * @return a pointer to the ReceiveStatsMap.
+   */
+  ReceiveStatsMap *GetReceiveStatsMapVar(const std::string &name,
+                                         const std::string &label = "");
+
+  /**
+   * @brief Lookup or create a ShardedCounter.
+   * @param name the name of this variable.
+   * @return a pointer to the ShardedCounter, which is valid for the lifetime
+   *   of the ExportMap.
+   */
+  ShardedCounter *GetShardedCounterVar(const std::string &name);
+
+  /**
+   * @brief Lookup or create a ShardedCounterMap.
+   * @param name the name of this variable.
+   * @param label the label to use for the keys.
+   * @return a pointer to the ShardedCounterMap, which is valid for the
+   *   lifetime of the ExportMap.
+   */
+  ShardedCounterMap *GetShardedCounterMapVar(const std::string &name,
+                                             const std::string &label = "");
+
+  /**
+   * @brief Lookup or create a Histogram with the default latency buckets.
+   * @param name the name of this variable.
+   * @return a pointer to the Histogram, which is valid for the lifetime of the
+   *   ExportMap.
+   */
+  Histogram *GetHistogramVar(const std::string &name);
+
+  /**
+   * @brief Lookup or create a Histogram.
+   * @param name the name of this variable.
+   * @param bounds the upper bound of each bucket, this is ignored if the
+   *   histogram already exists.
+   * @return a pointer to the Histogram, which is valid for the lifetime of the
+   *   ExportMap.
+   */
+  Histogram *GetHistogramVar(const std::string &name,
+                             const std::vector<uint64_t> &bounds);
+
+  /**
+   * @brief Fetch all the ReceiveStatsMap variables.
+   * @returns a vector of ReceiveStatsMap variables, sorted by name.
+   */
+  std::vector<ReceiveStatsMap*> ReceiveStatsVariables() const;
+
   /**
    * @brief Fetch a list of all known variables.
    * @returns a vector of all variables.
    */
   std::vector<BaseVariable*> AllVariables() const;
 
+  /**
+   * @brief Write the numeric variables in the Prometheus text format.
+   * @param output the stream to write to.
+   *
+   * Each metric name is the variable name prefixed with ola_, with any
+   * characters that aren't allowed replaced by an underscore. String
+   * variables are skipped.
+   */
+  void WriteMetrics(std::ostream *output) const;
+
  private :
   template<typename Type>
   Type *GetVar(std::map<std::string, Type*> *var_map,
@@ -396,6 +692,12 @@ class ExportMap {
   std::map<std::string, StringMap*> m_str_map_variables;
   std::map<std::string, IntMap*> m_int_map_variables;
   std::map<std::string, UIntMap*> m_uint_map_variables;
+  std::map<std::string, ReceiveStatsMap*> m_receive_stats_variables;
+  std::map<std::string, ShardedCounter*> m_sharded_counter_variables;
+  std::map<std::string, ShardedCounterMap*> m_sharded_counter_map_variables;
+  std::map<std::string, Histogram*> m_histogram_variables;
+  // Protects the maps above, not the variables themselves.
+  mutable ola::thread::Mutex m_variables_mutex;
 
   DISALLOW_COPY_AND_ASSIGN(ExportMap);
 };
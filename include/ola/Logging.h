@@ -92,6 +92,8 @@
 
 namespace ola {
 
+class ExportMap;
+
 /**
  * @brief The OLA log levels.
  * This controls the verbosity of logging. Each level also includes those below
@@ -274,6 +276,24 @@ bool InitLogging(log_level level, log_output output);
  * @param destination the LogDestination to use.
  */
 void InitLogging(log_level level, LogDestination *destination);
+
+/**
+ * @brief Start the thread used by the --async-logging flag.
+ *
+ * This is separate from InitLoggingFromFlags() so that servers can log
+ * before they daemonise. It's called by ServerInit() and AppInit(), and does
+ * nothing if the flag wasn't set or the thread is already running.
+ */
+void StartAsyncLogging();
+
+/**
+ * @brief Export the logging statistics.
+ * @param export_map the ExportMap to add the variables to.
+ *
+ * If the log destination is an AsyncLogDestination, the number of dropped
+ * lines is exported as log-lines-dropped.
+ */
+void ExportLoggingVariables(ExportMap *export_map);
 /***/
 }  // namespace ola
 /**@}*/
@@ -27,8 +27,10 @@ dist_noinst_SCRIPTS += \
 
 pkginclude_HEADERS += \
     include/ola/ActionQueue.h \
+    include/ola/AsyncLogDestination.h \
     include/ola/BaseTypes.h \
     include/ola/Callback.h \
+    include/ola/CallbackAllocator.h \
     include/ola/CallbackRunner.h \
     include/ola/Clock.h \
     include/ola/Constants.h \
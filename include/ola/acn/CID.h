@@ -14,8 +14,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  *
  * CID.h
- * The CID class, this just wraps a CIDImpl so we don't need to include all the
- *   UUID headers.
+ * The CID class, this uses a CIDImpl to generate and format CIDs so we don't
+ *   need to include all the UUID headers.
  * Copyright (C) 2007 Simon Newton
  */
 
@@ -42,6 +42,9 @@ namespace acn {
  * @{
  * @class CID
  * @brief The ACN component identifier.
+ *
+ * The CID is held by value, so copying or comparing one doesn't allocate.
+ * The UUID library is only used to generate, parse and format CIDs.
  * @}
  */
 class CID {
@@ -114,6 +117,11 @@ class CID {
    */
   bool operator<(const CID& c1) const;
 
+  /**
+   * @brief Return a hash of the CID, for use with hash maps.
+   */
+  size_t Hash() const;
+
   /**
    * @brief Generate a new CID
    */
@@ -133,11 +141,18 @@ class CID {
   static CID FromString(const std::string &cid);
 
  private:
-  class CIDImpl *m_impl;
+  uint8_t m_data[CID_LENGTH];
 
   // Takes ownership;
   explicit CID(class CIDImpl *impl);
 };
+
+/**
+ * @brief A hash functor for CIDs, for use with hash maps.
+ */
+struct CIDHash {
+  size_t operator()(const CID &cid) const { return cid.Hash(); }
+};
 }  // namespace acn
 }  // namespace ola
 
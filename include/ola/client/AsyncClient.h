@@ -0,0 +1,273 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * AsyncClient.h
+ * A thread safe client that returns Futures.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+/**
+ * @file
+ * @brief A thread safe OLA client that returns Futures rather than running
+ * callbacks.
+ */
+
+#ifndef INCLUDE_OLA_CLIENT_ASYNCCLIENT_H_
+#define INCLUDE_OLA_CLIENT_ASYNCCLIENT_H_
+
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/dmx/SourcePriorities.h>
+#include <ola/io/Descriptor.h>
+#include <ola/rdm/RDMResponseCodes.h>
+#include <ola/rdm/UID.h>
+#include <ola/thread/Future.h>
+#include <ola/thread/MPSCQueue.h>
+#include <ola/thread/Thread.h>
+
+#include <memory>
+#include <set>
+#include <string>
+
+namespace ola {
+
+namespace io { class SelectServer; }
+
+namespace client {
+
+class OlaClient;
+
+/**
+ * @brief The result of an AsyncClient call.
+ */
+struct AsyncResult {
+  /**
+   * @brief The error, or the empty string if the call succeeded.
+   */
+  std::string error;
+
+  bool Success() const { return error.empty(); }
+};
+
+/**
+ * @brief The result of AsyncClient::FetchDMX().
+ */
+struct AsyncDMXResult: public AsyncResult {
+  uint8_t priority;  /**< @brief the priority of the data */
+  DmxBuffer data;  /**< @brief the DMX512 data */
+
+  AsyncDMXResult() : priority(0) {}
+};
+
+/**
+ * @brief The result of AsyncClient::RDMGet() and AsyncClient::RDMSet().
+ */
+struct AsyncRDMResult: public AsyncResult {
+  /**
+   * @brief The OLA response code, only RDM_COMPLETED_OK means there is a
+   * response.
+   */
+  ola::rdm::rdm_response_code response_code;
+  uint8_t response_type;  /**< @brief ACK, ACK_TIMER, NACK etc. */
+  uint16_t pid;  /**< @brief the PID of the response */
+  std::string param_data;  /**< @brief the parameter data of the response */
+
+  AsyncRDMResult()
+      : response_code(ola::rdm::RDM_FAILED_TO_SEND),
+        response_type(0),
+        pid(0) {
+  }
+};
+
+/**
+ * @class AsyncClient ola/client/AsyncClient.h
+ * @brief An OLA client that can be used from any thread.
+ *
+ * The AsyncClient runs an OlaClient and its SelectServer in an internal
+ * thread. Requests are passed to that thread through a lock free queue, so
+ * application threads, for example render threads, never block on the
+ * client. Methods that produce a result return a Future, which can be polled
+ * with IsComplete(), waited on with Get(), or passed to Then() to run a
+ * callback, optionally on an executor such as a WorkStealingPool, once the
+ * result arrives.
+ *
+ * @examplepara
+ * @code
+ *   ola::client::AsyncClient client;
+ *   if (!client.Setup()) { ... }
+ *   client.StreamDMX(1, buffer);
+ *   ola::thread::Future<AsyncRDMResult> f = client.RDMGet(1, uid, 0, pid);
+ *   ...
+ *   if (f.IsComplete() && f.Get().Success()) { ... }
+ * @endcode
+ */
+class AsyncClient: private ola::thread::Thread {
+ public:
+  /**
+   * @brief Controls the options for the AsyncClient class.
+   */
+  class Options {
+   public:
+    Options()
+        : auto_start(true),
+          server_port(OLA_DEFAULT_PORT) {
+    }
+
+    /**
+     * If true, the client will automatically start olad if it's not
+     * already running.
+     */
+    bool auto_start;
+
+    /**
+     * The RPC port olad is listening on.
+     */
+    uint16_t server_port;
+  };
+
+  explicit AsyncClient(const Options &options = Options());
+
+  /**
+   * @brief Destructor, this calls Stop().
+   */
+  ~AsyncClient();
+
+  /**
+   * @brief Connect to olad and start the client thread.
+   * @returns true if the client started, false otherwise.
+   */
+  bool Setup();
+
+  /**
+   * @brief Stop the client thread and close the connection to olad.
+   *
+   * Futures for requests that haven't completed are completed with an error.
+   * This must not be called from a thread that's waiting on a Future.
+   */
+  void Stop();
+
+  /**
+   * @brief Send DMX data and wait for olad to acknowledge it.
+   * @param universe the universe to send to.
+   * @param data the DMX512 data.
+   * @param priority the priority of the data.
+   * @returns a Future that's completed once olad has acknowledged the data.
+   */
+  ola::thread::Future<AsyncResult> SendDMX(
+      unsigned int universe,
+      const DmxBuffer &data,
+      uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT);
+
+  /**
+   * @brief Send DMX data without an acknowledgement.
+   * @param universe the universe to send to.
+   * @param data the DMX512 data.
+   * @param priority the priority of the data.
+   * @returns false if the client isn't running, true otherwise.
+   *
+   * This avoids the cost of a Future, and is the best option for sending
+   * frames at a high rate.
+   */
+  bool StreamDMX(unsigned int universe,
+                 const DmxBuffer &data,
+                 uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT);
+
+  /**
+   * @brief Fetch the latest DMX data for a universe.
+   * @param universe the universe to fetch.
+   */
+  ola::thread::Future<AsyncDMXResult> FetchDMX(unsigned int universe);
+
+  /**
+   * @brief Send an RDM Get Command.
+   * @param universe the universe to send the command on
+   * @param uid the UID to send the command to
+   * @param sub_device the sub device index
+   * @param pid the PID to address
+   * @param data the optional data to send
+   * @param data_length the length of the data
+   */
+  ola::thread::Future<AsyncRDMResult> RDMGet(
+      unsigned int universe,
+      const ola::rdm::UID &uid,
+      uint16_t sub_device,
+      uint16_t pid,
+      const uint8_t *data = NULL,
+      unsigned int data_length = 0);
+
+  /**
+   * @brief Send an RDM Set Command.
+   * @param universe the universe to send the command on
+   * @param uid the UID to send the command to
+   * @param sub_device the sub device index
+   * @param pid the PID to address
+   * @param data the optional data to send
+   * @param data_length the length of the data
+   */
+  ola::thread::Future<AsyncRDMResult> RDMSet(
+      unsigned int universe,
+      const ola::rdm::UID &uid,
+      uint16_t sub_device,
+      uint16_t pid,
+      const uint8_t *data = NULL,
+      unsigned int data_length = 0);
+
+  /**
+   * @internal
+   * @brief The base class for requests passed to the client thread.
+   */
+  class Request {
+   public:
+    virtual ~Request() {}
+
+    /**
+     * @brief Called in the client thread to send the request.
+     */
+    virtual void Send(AsyncClient *client, OlaClient *ola_client) = 0;
+
+    /**
+     * @brief Complete the request with an error.
+     */
+    virtual void Fail(const std::string &error) = 0;
+  };
+
+  /**
+   * @internal
+   * @brief Called by a Request once it's complete.
+   */
+  void RequestComplete(Request *request);
+
+ private:
+  const Options m_options;
+  std::auto_ptr<ola::io::ConnectedDescriptor> m_socket;
+  std::auto_ptr<ola::io::SelectServer> m_ss;
+  std::auto_ptr<OlaClient> m_client;
+  ola::io::LoopbackDescriptor m_wake_up;
+  ola::thread::MPSCQueue<Request*> m_queue;
+  bool m_running;  // only changed while the client thread isn't running
+  bool m_wake_up_pending;  // accessed atomically
+  // Requests that have been sent, only used by the client thread.
+  std::set<Request*> m_outstanding;
+
+  void *Run();
+  void Submit(Request *request);
+  void ProcessQueue();
+  void FailAll(const std::string &error);
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncClient);
+};
+}  // namespace client
+}  // namespace ola
+#endif  // INCLUDE_OLA_CLIENT_ASYNCCLIENT_H_
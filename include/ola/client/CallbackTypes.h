@@ -106,6 +106,24 @@ typedef SingleUseCallback2<void, const Result&, const std::vector<OlaUniverse>&>
 typedef SingleUseCallback2<void, const Result&, const OlaUniverse&>
     UniverseInfoCallback;
 
+/**
+ * @brief Invoked when OlaClient::FetchUniverseStats() completes.
+ * @param result the Result of the API call.
+ * @param stats a vector of UniverseStats, one for each universe.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<UniverseStats>&>
+    UniverseStatsCallback;
+
+/**
+ * @brief Invoked when OlaClient::FetchDiscoveredServices() completes.
+ * @param result the Result of the API call.
+ * @param services the services olad has found.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<DiscoveredService>&>
+    DiscoveredServicesCallback;
+
 /**
  * @brief Invoked when OlaClient::ConfigureDevice() completes.
  * @param result the Result of the API call.
@@ -141,6 +159,47 @@ typedef SingleUseCallback3<void, const Result&, const DMXMetadata&,
 typedef Callback2<void, const DMXMetadata&, const DmxBuffer&>
     RepeatableDMXCallback;
 
+/**
+ * @brief Called with a view of DMX data, without copying it.
+ * @param frame the DMXFrameView, which is only valid while the callback runs.
+ */
+typedef Callback1<void, const DMXFrameView&> RepeatableDMXViewCallback;
+
+/**
+ * @brief Called once when OlaClient::FetchRDMPolledValues() completes.
+ * @param result the Result of the API call.
+ * @param values the latest values polled from the devices on the universe.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<RDMPolledValue>&>
+    RDMPolledValuesCallback;
+
+/**
+ * @brief Called once when OlaClient::FetchFrameHistory() completes.
+ * @param result the Result of the API call.
+ * @param frames the frames the universe sent, oldest first.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<HistoryFrame>&>
+    FrameHistoryCallback;
+
+/**
+ * @brief Called once when OlaClient::FetchRDMResponderStats() completes.
+ * @param result the Result of the API call.
+ * @param stats the stats for each responder on the universe.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<RDMResponderStats>&>
+    RDMResponderStatsCallback;
+
+/**
+ * @brief Called when polled RDM values change.
+ * @param universe the universe the devices are on.
+ * @param values the values that changed.
+ */
+typedef Callback2<void, unsigned int, const std::vector<RDMPolledValue>&>
+    RepeatableRDMPolledValuesCallback;
+
 /**
  * @brief Called when a RDM request completes.
  * Used with OlaClient::RDMGet() and OlaClient::RDMSet().
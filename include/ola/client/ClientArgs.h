@@ -22,7 +22,11 @@
 #define INCLUDE_OLA_CLIENT_CLIENTARGS_H_
 
 #include <ola/client/CallbackTypes.h>
+#include <ola/client/ClientTypes.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 /**
  * @file
@@ -96,6 +100,45 @@ struct SendDMXArgs {
   }
 };
 
+/**
+ * @brief Arguments passed to the RegisterUniverse() method.
+ *
+ * These limit the DMX data olad sends for the universe. With the defaults
+ * every frame is sent in full.
+ */
+struct RegisterArgs {
+  /**
+   * @brief The first slot to receive, defaults to 0.
+   */
+  unsigned int slot_offset;
+  /**
+   * @brief The number of slots to receive, starting at slot_offset. Defaults
+   * to 0, which means all slots up to the end of the frame.
+   */
+  unsigned int slot_count;
+  /**
+   * @brief The maximum number of frames per second to receive. Frames that
+   * arrive faster are coalesced, so the latest data is always delivered.
+   * Defaults to 0, which means no limit.
+   */
+  unsigned int max_rate;
+  /**
+   * @brief Only receive frames where the selected slots changed. Defaults to
+   * false.
+   */
+  bool changes_only;
+
+  /**
+   * @brief Create a new RegisterArgs object
+   */
+  RegisterArgs()
+      : slot_offset(0),
+        slot_count(0),
+        max_rate(0),
+        changes_only(false) {
+  }
+};
+
 /**
  * @brief Arguments used with OlaClient::RDMGet() and OlaClient::RDMSet()
  * methods.
@@ -111,9 +154,235 @@ struct SendRDMArgs {
    */
   bool include_raw_frames;
 
+  /**
+   * @brief Set to true to have olad decode the parameter data of an ACK
+   * using its PID store.
+   *
+   * If the data could be decoded, RDMMetadata::pid_name and
+   * RDMMetadata::decoded_data are set. This saves the client from loading the
+   * PID store.
+   */
+  bool decode_response;
+
   explicit SendRDMArgs(RDMCallback *_callback)
     : callback(_callback),
-      include_raw_frames(false) {
+      include_raw_frames(false),
+      decode_response(false) {
+  }
+};
+
+/**
+ * @brief A set of configuration changes, used with
+ * OlaClient::ConfigureBatch().
+ *
+ * The changes are applied together, if any of them fail none are applied.
+ */
+struct ConfigBatch {
+  /**
+   * @brief A port to patch or unpatch, see OlaClient::Patch().
+   */
+  struct PortPatch {
+    unsigned int device_alias;
+    unsigned int port;
+    PortDirection port_direction;
+    PatchAction action;
+    unsigned int universe;
+  };
+
+  /**
+   * @brief The priority of a port. The value is ignored if inherit is true.
+   */
+  struct PortPriority {
+    unsigned int device_alias;
+    unsigned int port;
+    PortDirection port_direction;
+    bool inherit;
+    uint8_t value;
+  };
+
+  /**
+   * @brief The merge mode of a universe.
+   */
+  struct UniverseMergeMode {
+    unsigned int universe;
+    OlaUniverse::merge_mode mode;
+  };
+
+  /**
+   * @brief The name of a universe.
+   */
+  struct UniverseName {
+    unsigned int universe;
+    std::string name;
+  };
+
+  std::vector<PortPatch> patches;
+  std::vector<PortPriority> priorities;
+  std::vector<UniverseMergeMode> merge_modes;
+  std::vector<UniverseName> names;
+
+  /**
+   * @brief Patch or unpatch a port from a universe.
+   */
+  void Patch(unsigned int device_alias, unsigned int port,
+             PortDirection port_direction, PatchAction action,
+             unsigned int universe) {
+    PortPatch patch = {device_alias, port, port_direction, action, universe};
+    patches.push_back(patch);
+  }
+
+  /**
+   * @brief Set the priority for a port to inherit mode.
+   */
+  void SetPortPriorityInherit(unsigned int device_alias, unsigned int port,
+                              PortDirection port_direction) {
+    PortPriority priority = {device_alias, port, port_direction, true, 0};
+    priorities.push_back(priority);
+  }
+
+  /**
+   * @brief Set the priority for a port to override mode.
+   */
+  void SetPortPriorityOverride(unsigned int device_alias, unsigned int port,
+                               PortDirection port_direction, uint8_t value) {
+    PortPriority priority = {device_alias, port, port_direction, false,
+                             value};
+    priorities.push_back(priority);
+  }
+
+  /**
+   * @brief Set the merge mode of a universe.
+   */
+  void SetUniverseMergeMode(unsigned int universe,
+                            OlaUniverse::merge_mode mode) {
+    UniverseMergeMode merge_mode = {universe, mode};
+    merge_modes.push_back(merge_mode);
+  }
+
+  /**
+   * @brief Set the name of a universe.
+   */
+  void SetUniverseName(unsigned int universe, const std::string &name) {
+    UniverseName universe_name = {universe, name};
+    names.push_back(universe_name);
+  }
+};
+
+/**
+ * @brief Virtual universes to set up and remove, used with
+ * OlaClient::ConfigureVirtualUniverses().
+ *
+ * A virtual universe is built from ranges of slots in other universes. If
+ * any of the virtual universes are invalid, none of the changes are applied.
+ */
+struct VirtualUniverseBatch {
+  /**
+   * @brief A range of slots copied from a source universe.
+   */
+  struct Mapping {
+    unsigned int source_universe;
+    unsigned int source_offset;
+    unsigned int offset;  // the first slot in the virtual universe
+    unsigned int length;
+  };
+
+  /**
+   * @brief A virtual universe and the slots it's built from.
+   */
+  struct VirtualUniverse {
+    unsigned int universe;
+    uint8_t priority;
+    std::vector<Mapping> mappings;
+  };
+
+  std::vector<VirtualUniverse> universes;
+  std::vector<unsigned int> removals;
+
+  /**
+   * @brief Add a virtual universe, this replaces an existing one.
+   * @returns the virtual universe, so mappings can be added with AddMapping().
+   */
+  VirtualUniverse *AddUniverse(
+      unsigned int universe,
+      uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT) {
+    VirtualUniverse virtual_universe;
+    virtual_universe.universe = universe;
+    virtual_universe.priority = priority;
+    universes.push_back(virtual_universe);
+    return &universes.back();
+  }
+
+  /**
+   * @brief Copy slots from a source universe into a virtual universe.
+   * @param universe the virtual universe from AddUniverse(). This is only
+   *   valid until the next call to AddUniverse().
+   * @param source_universe the universe to copy from.
+   * @param source_offset the first slot to copy, from 0.
+   * @param offset the slot in the virtual universe to copy to, from 0.
+   * @param length the number of slots to copy.
+   */
+  static void AddMapping(VirtualUniverse *universe,
+                         unsigned int source_universe,
+                         unsigned int source_offset,
+                         unsigned int offset,
+                         unsigned int length) {
+    Mapping mapping = {source_universe, source_offset, offset, length};
+    universe->mappings.push_back(mapping);
+  }
+
+  /**
+   * @brief Remove a virtual universe.
+   */
+  void RemoveUniverse(unsigned int universe) {
+    removals.push_back(universe);
+  }
+};
+
+/**
+ * @brief How a fade progresses over time, used with FadeArgs.
+ */
+enum FadeCurve {
+  FADE_LINEAR,  /**< A constant rate */
+  FADE_EASE_IN,  /**< Start slowly */
+  FADE_EASE_OUT,  /**< End slowly */
+  FADE_EASE_IN_OUT,  /**< Start and end slowly */
+};
+
+/**
+ * @brief Arguments passed to the OlaClient::StartFade() method.
+ */
+struct FadeArgs {
+  /**
+   * @brief The length of the fade in ms, 0 jumps straight to the data.
+   */
+  unsigned int duration;
+  /**
+   * @brief The curve of the fade, defaults to FADE_LINEAR.
+   */
+  FadeCurve curve;
+  /**
+   * @brief The priority of the data, defaults to
+   * ola::dmx::SOURCE_PRIORITY_DEFAULT.
+   */
+  uint8_t priority;
+  /**
+   * @brief The first slot of each pair of slots that hold a 16 bit value.
+   * These are faded as one value.
+   */
+  std::vector<unsigned int> fine_channels;
+  /**
+   * @brief the Callback to run upon completion.
+   */
+  SetCallback *callback;
+
+  /**
+   * @brief Create a new FadeArgs object
+   */
+  FadeArgs(unsigned int _duration, SetCallback *_callback)
+      : duration(_duration),
+        curve(FADE_LINEAR),
+        priority(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+        callback(_callback) {
   }
 };
 }  // namespace client
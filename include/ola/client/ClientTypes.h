@@ -21,12 +21,16 @@
 #ifndef INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 #define INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 
+#include <ola/DmxBuffer.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <ola/network/IPV4Address.h>
 #include <ola/rdm/RDMFrame.h>
 #include <ola/rdm/RDMResponseCodes.h>
+#include <ola/rdm/UID.h>
 
 #include <olad/PortConstants.h>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -305,6 +309,159 @@ class OlaUniverse {
   unsigned int m_rdm_device_count;
 };
 
+/**
+ * @brief The frame counters olad keeps for a universe.
+ *
+ * The counters only ever increase, the rate is found by comparing two sets
+ * of stats.
+ */
+struct UniverseStats {
+  unsigned int universe;
+  uint64_t input_frames;  /**< Updates from ports & source clients */
+  uint64_t output_frames;  /**< Frames sent to the ports & sink clients */
+  uint64_t changed_slots;  /**< Slots that changed, over all output frames */
+  unsigned int last_changed_slots;  /**< Slots changed in the last frame */
+  unsigned int source_count;  /**< Input ports & source clients */
+  unsigned int active_sources;  /**< Sources at the active priority */
+  uint64_t merge_time_us;  /**< Time spent merging, over all input frames */
+  bool has_input;  /**< False if the universe hasn't had any input */
+  unsigned int ms_since_input;
+  bool has_output;  /**< False if the universe hasn't had any output */
+  unsigned int ms_since_output;
+
+  UniverseStats()
+      : universe(0),
+        input_frames(0),
+        output_frames(0),
+        changed_slots(0),
+        last_changed_slots(0),
+        source_count(0),
+        active_sources(0),
+        merge_time_us(0),
+        has_input(false),
+        ms_since_input(0),
+        has_output(false),
+        ms_since_output(0) {
+  }
+};
+
+/**
+ * @brief A DNS-SD service that olad has found.
+ */
+struct DiscoveredService {
+  std::string name;  /**< The instance name */
+  std::string type;  /**< The service type that was requested */
+  std::string domain;
+  std::string host;  /**< The host name the service is on */
+  /**
+   * @brief The address of the host, or the wildcard address if olad doesn't
+   * know it.
+   */
+  ola::network::IPV4Address address;
+  uint16_t port;
+  int if_index;  /**< The interface olad found the service on */
+  std::map<std::string, std::string> txt_data;
+
+  DiscoveredService()
+      : port(0),
+        if_index(0) {
+  }
+};
+
+/**
+ * @brief A sensor or status value that olad polled from a RDM device.
+ */
+struct RDMPolledValue {
+  ola::rdm::UID uid;  /**< The device the value is from */
+  uint16_t sub_device;
+  /**
+   * @brief The PID of the value, one of SENSOR_VALUE, STATUS_MESSAGES or the
+   * PID of a queued message.
+   */
+  uint16_t param_id;
+  bool has_index;  /**< True for SENSOR_VALUE */
+  uint8_t index;  /**< The sensor number, if has_index is true */
+  std::string data;  /**< The parameter data of the response */
+
+  RDMPolledValue()
+      : uid(0, 0),
+        sub_device(0),
+        param_id(0),
+        has_index(false),
+        index(0) {
+  }
+};
+
+/**
+ * @brief The latency & reliability of a RDM responder, as seen by olad.
+ */
+struct RDMResponderStats {
+  /**
+   * @brief The number of responses with a latency in a range.
+   */
+  struct LatencyBucket {
+    unsigned int limit_ms;  /**< The upper limit, 0 for no limit */
+    unsigned int count;
+
+    LatencyBucket() : limit_ms(0), count(0) {}
+  };
+
+  ola::rdm::UID uid;  /**< The responder */
+  unsigned int requests;
+  unsigned int acks;
+  unsigned int ack_timers;
+  unsigned int nacks;
+  unsigned int timeouts;
+  unsigned int failures;  /**< Failures other than timeouts */
+  /**
+   * @brief The number of requests since the responder last answered.
+   */
+  unsigned int consecutive_failures;
+  std::map<uint16_t, unsigned int> nack_reasons;  /**< Reason to count */
+  std::vector<LatencyBucket> latency;  /**< The latency histogram */
+  /**
+   * @brief The latency of the responses, in microseconds. These are 0 if
+   * there haven't been any responses.
+   */
+  uint64_t min_latency_us;
+  uint64_t max_latency_us;
+  uint64_t mean_latency_us;
+
+  RDMResponderStats()
+      : uid(0, 0),
+        requests(0),
+        acks(0),
+        ack_timers(0),
+        nacks(0),
+        timeouts(0),
+        failures(0),
+        consecutive_failures(0),
+        min_latency_us(0),
+        max_latency_us(0),
+        mean_latency_us(0) {
+  }
+};
+
+/**
+ * @brief A frame from the history olad keeps of the frames each universe
+ * sends.
+ */
+struct HistoryFrame {
+  uint64_t age_us;  /**< How long ago the frame was sent, in microseconds */
+  uint8_t priority;  /**< The priority of the frame */
+  /**
+   * @brief What caused the frame, either port:<port id>, client:<uid> or empty
+   * if it's not known.
+   */
+  std::string source;
+  DmxBuffer data;  /**< The DMX data */
+
+  HistoryFrame()
+      : age_us(0),
+        priority(0) {
+  }
+};
+
 /**
  * @brief Metadata that accompanies DMX packets
  */
@@ -326,6 +483,50 @@ struct DMXMetadata {
 };
 
 
+/**
+ * @brief A DMX frame that refers to the client's receive buffer, rather than
+ * holding a copy of the data.
+ *
+ * The data is only valid while the callback the view was passed to is
+ * running. Applications that need to keep the data must copy it.
+ */
+struct DMXFrameView {
+  /**
+   * @brief The DMX data.
+   */
+  const uint8_t *data;
+  /**
+   * @brief The number of slots in data.
+   */
+  unsigned int length;
+  /**
+   * @brief The universe the DMX frame is for.
+   */
+  unsigned int universe;
+  /**
+   * @brief The priority of the DMX frame.
+   */
+  uint8_t priority;
+  /**
+   * @brief Identifies the frame.
+   *
+   * For frames pushed by olad this increases by one with each frame received
+   * for the universe. For frames read from shared memory this changes each
+   * time olad writes the universe, so a read that returns a frame that was
+   * already seen has the same sequence.
+   */
+  uint32_t sequence;
+
+  DMXFrameView()
+      : data(NULL),
+        length(0),
+        universe(0),
+        priority(0),
+        sequence(0) {
+  }
+};
+
+
 /**
  * @brief Metadata that accompanies RDM Responses.
  */
@@ -340,6 +541,19 @@ struct RDMMetadata {
    */
   std::vector<ola::rdm::RDMFrame> frames;
 
+  /**
+   * @brief The name of the PID, set if SendRDMArgs::decode_response was true
+   * and olad was able to decode the response.
+   */
+  std::string pid_name;
+
+  /**
+   * @brief The human readable form of the parameter data, set if
+   * SendRDMArgs::decode_response was true and olad was able to decode the
+   * response.
+   */
+  std::string decoded_data;
+
   /**
    * @brief Construct a new RDMMetadata object.
    * The default response code is RDM_FAILED_TO_SEND.
@@ -67,6 +67,20 @@ class BaseClientWrapper {
    */
   void SetCloseCallback(CloseCallback *callback);
 
+  /**
+   * @brief Reconnect to olad if the client socket is closed.
+   *
+   * This is off by default. When enabled the close callback isn't run,
+   * instead the wrapper tries to reconnect, backing off from 50ms up to a
+   * second between attempts. Once reconnected, the universes registered with
+   * RegisterUniverse() and the last frame sent to each universe are restored.
+   * olad isn't auto started when reconnecting.
+   * @param auto_reconnect true to reconnect, false to run the close callback.
+   */
+  void SetAutoReconnect(bool auto_reconnect) {
+    m_auto_reconnect = auto_reconnect;
+  }
+
   /**
    * @brief Get the SelectServer used by this client.
    * @returns A pointer to a SelectServer, ownership isn't transferred.
@@ -97,10 +111,19 @@ class BaseClientWrapper {
  private:
   ola::io::SelectServer m_ss;
   std::auto_ptr<CloseCallback> m_close_callback;
+  bool m_auto_reconnect;
+  unsigned int m_reconnect_delay;  // in ms
+
+  void ScheduleReconnect();
+  void Reconnect();
 
   virtual void CreateClient() = 0;
   virtual bool StartupClient() = 0;
-  virtual void InitSocket() = 0;
+  virtual bool ReconnectClient() = 0;
+  virtual void InitSocket(bool auto_start) = 0;
+
+  static const unsigned int MIN_RECONNECT_DELAY = 50;
+  static const unsigned int MAX_RECONNECT_DELAY = 1000;
 };
 
 
@@ -139,8 +162,18 @@ class GenericClientWrapper: public BaseClientWrapper {
     return ok;
   }
 
-  void InitSocket() {
-    if (m_auto_start) {
+  bool ReconnectClient() {
+    if (!m_client->Reconnect(m_socket.get())) {
+      return false;
+    }
+    m_client->SetCloseHandler(
+      ola::NewSingleCallback(static_cast<BaseClientWrapper*>(this),
+                             &BaseClientWrapper::SocketClosed));
+    return true;
+  }
+
+  void InitSocket(bool auto_start) {
+    if (auto_start) {
       m_socket.reset(ola::client::ConnectToServer(OLA_DEFAULT_PORT));
     } else {
       m_socket.reset(ola::network::TCPSocket::Connect(
@@ -1,5 +1,6 @@
 olaclientincludedir = $(pkgincludedir)/client/
 olaclientinclude_HEADERS = \
+    include/ola/client/AsyncClient.h \
     include/ola/client/CallbackTypes.h \
     include/ola/client/ClientArgs.h \
     include/ola/client/ClientRDMAPIShim.h \
@@ -21,6 +21,7 @@
 #ifndef INCLUDE_OLA_CLIENT_OLACLIENT_H_
 #define INCLUDE_OLA_CLIENT_OLACLIENT_H_
 
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/client/CallbackTypes.h>
 #include <ola/client/ClientArgs.h>
@@ -59,6 +60,17 @@ class OlaClient {
    */
   bool Stop();
 
+  /**
+   * @brief Reconnect to olad after the connection was closed.
+   *
+   * The universes registered with RegisterUniverse() are registered again and
+   * the last frame sent to each universe is sent again. The close handler
+   * must be set again after this.
+   * @param descriptor the new connection to olad, ownership isn't transferred.
+   * @returns true on success, false on failure
+   */
+  bool Reconnect(ola::io::ConnectedDescriptor *descriptor);
+
   /**
    * @brief Set the close handler.
    */
@@ -73,6 +85,26 @@ class OlaClient {
    */
   void SetDMXCallback(RepeatableDMXCallback *callback);
 
+  /**
+   * @brief Set the callback to be run with a view of new DMX data.
+   *
+   * This avoids copying the data for each frame. The view is only valid while
+   * the callback runs. If both this and SetDMXCallback() are used, this
+   * callback runs first.
+   * @param callback the callback to run upon receiving new DMX data.
+   */
+  void SetDMXViewCallback(RepeatableDMXViewCallback *callback);
+
+  /**
+   * @brief Set the callback to be run when polled RDM values change.
+   *
+   * The callback will be run when the values olad polls from the RDM devices
+   * change, for universes that have been registered with
+   * RegisterForRDMPolledValues().
+   * @param callback the callback to run when the values change.
+   */
+  void SetRDMPolledValuesCallback(RepeatableRDMPolledValuesCallback *callback);
+
   /**
    * @brief Trigger a plugin reload.
    * @param callback the SetCallback to invoke upon completion.
@@ -189,6 +221,26 @@ class OlaClient {
   void FetchUniverseInfo(unsigned int universe,
                          UniverseInfoCallback *callback);
 
+  /**
+   * @brief Fetch the frame counters for all universes.
+   *
+   * This is cheap for olad to answer, so it can be polled.
+   * @param callback the UniverseStatsCallback to invoke upon completion.
+   */
+  void FetchUniverseStats(UniverseStatsCallback *callback);
+
+  /**
+   * @brief Fetch the DNS-SD services of a type that olad has found.
+   *
+   * olad answers from its cache, so this doesn't wait for the network. The
+   * first request for a type that olad isn't already browsing for (see the
+   * --dns-sd-browse flag) starts browsing and returns no services.
+   * @param type the service type, e.g. _http._tcp
+   * @param callback the DiscoveredServicesCallback to invoke upon completion.
+   */
+  void FetchDiscoveredServices(const std::string &type,
+                               DiscoveredServicesCallback *callback);
+
   /**
    * @brief Set the name of a universe.
    * @param universe the id of the universe
@@ -225,6 +277,50 @@ class OlaClient {
              unsigned int universe,
              SetCallback *callback);
 
+  /**
+   * @brief Apply a set of patch, priority, merge mode and name changes.
+   *
+   * The changes are applied together, if any of them fail none are applied.
+   * Each universe that changes is merged and sent to its ports once.
+   * @param batch the changes to apply.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ConfigureBatch(const ConfigBatch &batch, SetCallback *callback);
+
+  /**
+   * @brief Set up and remove virtual universes.
+   *
+   * A virtual universe is built in olad from ranges of slots in other
+   * universes. The changes are applied together, if any of them are invalid
+   * none are applied.
+   * @param batch the virtual universes to set up and remove.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ConfigureVirtualUniverses(const VirtualUniverseBatch &batch,
+                                 SetCallback *callback);
+
+  /**
+   * @brief Fade a universe to new data.
+   *
+   * olad renders the steps of the fade at the rate of the universe's output
+   * ports, so there's no need to stream the steps. A new fade starts from the
+   * current point of the last one. Once the fade completes, the data is held
+   * until ReleaseFade() is called.
+   * @param universe the universe to fade.
+   * @param data the DmxBuffer to fade to.
+   * @param args the FadeArgs to use for this call.
+   */
+  void StartFade(unsigned int universe,
+                 const DmxBuffer &data,
+                 const FadeArgs &args);
+
+  /**
+   * @brief Stop fading a universe, and remove the fade's data from it.
+   * @param universe the universe to release.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ReleaseFade(unsigned int universe, SetCallback *callback);
+
   /**
    * @brief Register our interest in a universe.
    *
@@ -238,6 +334,19 @@ class OlaClient {
                         RegisterAction register_action,
                         SetCallback *callback);
 
+  /**
+   * @brief Register our interest in a universe, limiting the data received.
+   * @param universe the id of the universe to register for.
+   * @param register_action the action (register or unregister)
+   * @param args the RegisterArgs to use, these replace the arguments of
+   *   any earlier registration for the universe.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterUniverse(unsigned int universe,
+                        RegisterAction register_action,
+                        const RegisterArgs &args,
+                        SetCallback *callback);
+
   /**
    * @brief Send DMX data.
    * @param universe the universe to send to.
@@ -255,6 +364,95 @@ class OlaClient {
    */
   void FetchDMX(unsigned int universe, DMXCallback *callback);
 
+  /**
+   * @brief Register our interest in the values olad polls from the RDM
+   * devices on a universe.
+   *
+   * olad must be run with --rdm-poll-interval. The callback set by
+   * SetRDMPolledValuesCallback() will be called when the sensor values,
+   * status messages or queued messages change.
+   * @param universe the id of the universe to register for.
+   * @param register_action the action (register or unregister)
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterForRDMPolledValues(unsigned int universe,
+                                  RegisterAction register_action,
+                                  SetCallback *callback);
+
+  /**
+   * @brief Fetch the latest values olad has polled from the RDM devices on a
+   * universe.
+   * @param universe the universe id to get the values for.
+   * @param callback the RDMPolledValuesCallback to invoke upon completion.
+   */
+  void FetchRDMPolledValues(unsigned int universe,
+                            RDMPolledValuesCallback *callback);
+
+  /**
+   * @brief Fetch the latency & reliability stats olad has recorded for the
+   *   RDM responders on a universe.
+   * @param universe the universe id to get the stats for.
+   * @param callback the RDMResponderStatsCallback to invoke upon completion.
+   */
+  void FetchRDMResponderStats(unsigned int universe,
+                              RDMResponderStatsCallback *callback);
+
+  /**
+   * @brief Fetch the frames olad has recently sent for a universe.
+   *
+   * olad must be run with --frame-history-size. Only frames that differ from
+   * the previous one are kept.
+   * @param universe the universe id to get the frames for.
+   * @param max_age_ms only fetch the frames sent in the last max_age_ms, 0
+   *   fetches the whole history.
+   * @param max_frames the maximum number of frames to fetch, the most recent
+   *   ones are returned. 0 means no limit.
+   * @param callback the FrameHistoryCallback to invoke upon completion.
+   */
+  void FetchFrameHistory(unsigned int universe,
+                         unsigned int max_age_ms,
+                         unsigned int max_frames,
+                         FrameHistoryCallback *callback);
+
+  /**
+   * @brief Use shared memory to pass DMX data to and from a local olad.
+   * @param server_port the RPC port olad is listening on.
+   * @returns true if olad is publishing DMX data using shared memory, false
+   *   otherwise.
+   *
+   * Once enabled, calls to SendDMX() without a callback write the data into
+   * shared memory, and ReadSharedDMX() can be used to read universes.
+   */
+  bool EnableSharedMemory(uint16_t server_port = OLA_DEFAULT_PORT);
+
+  /**
+   * @brief Read the latest DMX data for a universe from shared memory.
+   * @param universe the universe id to get data for.
+   * @param[out] data the DMX data.
+   * @returns true if the data was read, false if shared memory isn't enabled
+   *   or olad hasn't started publishing the universe yet.
+   *
+   * Unlike FetchDMX() this doesn't make an RPC call. The first read of a
+   * universe asks olad to publish it, so it'll return false until olad has
+   * done so.
+   */
+  bool ReadSharedDMX(unsigned int universe, DmxBuffer *data);
+
+  /**
+   * @brief Read the latest DMX data for a universe from shared memory and
+   * pass a view of it to a callback.
+   * @param universe the universe id to get data for.
+   * @param callback run with the frame before this method returns. Ownership
+   *   is not transferred.
+   * @returns true if the data was read, in which case the callback was run.
+   *
+   * This doesn't allocate. The DMXFrameView::sequence only changes when olad
+   * writes new data for the universe, which lets a polling reader skip frames
+   * it has already seen.
+   */
+  bool ReadSharedDMX(unsigned int universe,
+                     RepeatableDMXViewCallback *callback);
+
   /**
    * @brief Trigger discovery for a universe.
    * @param universe the universe id to run discovery on.
@@ -316,6 +514,33 @@ class OlaClient {
   void SendTimeCode(const ola::timecode::TimeCode &timecode,
                     SetCallback *callback);
 
+  /**
+   * @brief Start the timecode generator in olad.
+   * @param start the first frame to send, this also sets the frame rate.
+   * @param callback the SetCallback to invoke when the request completes.
+   *
+   * olad sends a frame of timecode to the ports at the frame rate until
+   * StopTimeCodeGenerator() is called.
+   */
+  void StartTimeCodeGenerator(const ola::timecode::TimeCode &start,
+                              SetCallback *callback);
+
+  /**
+   * @brief Have the timecode generator in olad chase the timecode sent with
+   *   SendTimeCode().
+   * @param callback the SetCallback to invoke when the request completes.
+   *
+   * olad locks to the timecode it's sent and fills in the frames in between,
+   * so the timecode only needs to be sent occasionally.
+   */
+  void ChaseTimeCode(SetCallback *callback);
+
+  /**
+   * @brief Stop the timecode generator in olad.
+   * @param callback the SetCallback to invoke when the request completes.
+   */
+  void StopTimeCodeGenerator(SetCallback *callback);
+
  private:
   std::auto_ptr<class OlaClientCore> m_core;
 
@@ -28,20 +28,43 @@
 #include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/base/Macro.h>
+#include <ola/dmx/RunLengthEncoder.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <ola/io/Descriptor.h>
+#include <ola/thread/MPSCQueue.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/SPSCQueue.h>
+#include <ola/thread/SchedulerInterface.h>
+
+#include <map>
+#include <string>
+#include <vector>
 
 namespace ola {
 
-namespace io { class SelectServer; }
-namespace network { class TCPSocket; }
-namespace proto { class OlaServerService_Stub; }
+namespace io {
+class ConnectedDescriptor;
+class SelectServer;
+}
+namespace proto {
+class DmxData;
+class OlaServerService_Stub;
+class UDPStreamReply;
+}
 namespace rpc {
 class RpcChannel;
+class RpcController;
 class RpcSession;
 }
+namespace thread {
+class CallbackThread;
+}
 
 namespace client {
 
+class SharedDmxClient;
+class UDPStreamSender;
+
 /**
  * @class StreamingClientInterface ola/client/StreamingClient.h
  * @brief The interface for the StreamingClient class.
@@ -84,6 +107,15 @@ class StreamingClientInterface {
  * acknowledgement. It's best suited to simple clients which only ever send
  * DMX512 data.
  *
+ * If olad limits the number of updates in flight and falls behind, updates
+ * are held back rather than queued on the socket. A held back update is
+ * replaced by newer data for the same universe, and the latest data for each
+ * universe is sent as a single batch by the first call after olad has caught
+ * up.
+ *
+ * StreamingClient isn't thread safe unless the threaded option is set, see
+ * Options::threaded.
+ *
  * @snippet streaming_client.cpp Tutorial Example
  */
 class StreamingClient : public StreamingClientInterface {
@@ -97,7 +129,16 @@ class StreamingClient : public StreamingClientInterface {
      * Create a new options structure with the default options. This
      * includes automatically starting olad if it's not already running.
      */
-    Options() : auto_start(true), server_port(OLA_DEFAULT_PORT) {}
+    Options()
+        : auto_start(true),
+          server_port(OLA_DEFAULT_PORT),
+          use_shared_memory(false),
+          use_udp(false),
+          delta_encoding(false),
+          threaded(false),
+          sender_queue_size(16),
+          auto_reconnect(false) {
+    }
 
     /**
      * If true, the client will automatically start olad if it's not
@@ -109,6 +150,147 @@ class StreamingClient : public StreamingClientInterface {
      * The RPC port olad is listening on.
      */
     uint16_t server_port;
+
+    /**
+     * If true, and olad is running on the same host with shared memory
+     * enabled, DMX data is passed to olad using shared memory rather than the
+     * RPC socket. If shared memory isn't available the RPC socket is used.
+     */
+    bool use_shared_memory;
+
+    /**
+     * If true, and olad has UDP streaming enabled, DMX data is sent to olad
+     * in UDP datagrams and the RPC socket is only used for control messages.
+     * UDP frames aren't acknowledged, a lost frame is replaced by the next one
+     * and olad drops frames that arrive out of order. If olad doesn't support
+     * UDP streaming the RPC socket is used. Shared memory is preferred if
+     * both are set.
+     */
+    bool use_udp;
+
+    /**
+     * The IPv4 address of the host olad is running on. If empty, the local
+     * machine is used. If set, auto_start and use_shared_memory are
+     * ignored.
+     */
+    std::string server_address;
+
+    /**
+     * The path of the unix domain socket olad is listening on, see olad's
+     * --rpc-socket option. If set, this is used instead of the TCP port,
+     * which avoids the overhead of the TCP stack. auto_start is ignored.
+     */
+    std::string server_socket;
+
+    /**
+     * If true, only the slots that changed since the last frame for a
+     * universe are sent. This reduces the data sent for large universes
+     * where few slots change per frame. olad must support delta frames,
+     * older versions of olad will discard the data.
+     */
+    bool delta_encoding;
+
+    /**
+     * If true, the data is written to olad by a thread the client owns.
+     * SendDmx(), SendDMX() and SendDmxBatch() may then be called from any
+     * thread, they queue the data and return without waiting on the socket.
+     * Threads that send often should use their own Sender, see NewSender().
+     *
+     * The I/O thread sends the latest queued data for each universe as a
+     * single batch, so a universe should only be sent to from one thread.
+     * Setup(), Stop() and NewSender() must not be called concurrently with
+     * each other.
+     */
+    bool threaded;
+
+    /**
+     * The number of frames each Sender can queue before Sender::SendDmx()
+     * fails.
+     */
+    unsigned int sender_queue_size;
+
+    /**
+     * If true, the client reconnects to olad if the connection is closed,
+     * for example when olad is restarted. The delay between attempts starts
+     * short and backs off up to a second. While the client is reconnecting,
+     * sends succeed and the latest frame for each universe is kept. Once the
+     * client has reconnected the latest frame for each universe is sent
+     * again, so olad picks up where it left off. auto_start isn't used when
+     * reconnecting.
+     */
+    bool auto_reconnect;
+  };
+
+  /**
+   * @brief The data for a single universe, used with SendDmxBatch().
+   */
+  class UniverseData {
+   public:
+    UniverseData(unsigned int universe,
+                 const DmxBuffer &data,
+                 uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT)
+        : universe(universe),
+          priority(priority),
+          data(data) {
+    }
+
+    unsigned int universe;  /**< @brief the universe to send to */
+    uint8_t priority;  /**< @brief the priority of the data */
+    DmxBuffer data;  /**< @brief the DMX512 data */
+  };
+
+ private:
+  /*
+   * A copy of a frame, queued for the I/O thread. DmxBuffer isn't safe to
+   * share between threads, so the data is copied.
+   */
+  class QueuedFrame {
+   public:
+    QueuedFrame() : universe(0), priority(0), size(0) {}
+    QueuedFrame(unsigned int universe, uint8_t priority,
+                const DmxBuffer &buffer);
+
+    unsigned int universe;
+    uint8_t priority;
+    unsigned int size;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+  };
+
+ public:
+  /**
+   * @brief A handle used by a single thread to send DMX512 data when the
+   * client is threaded.
+   *
+   * Each Sender has a lock free queue which is read by the client's I/O
+   * thread, so sending never blocks or contends with other threads. A Sender
+   * must only be used by one thread at a time. Senders are owned by the
+   * StreamingClient and remain valid until it's destroyed.
+   */
+  class Sender {
+   public:
+    /**
+     * @brief Queue DMX512 data to be sent.
+     * @param universe the universe to send to.
+     * @param data the DMX512 data.
+     * @param priority the priority of the data.
+     * @returns false if the client isn't running, or the queue is full
+     *   because the I/O thread has fallen behind. The data is dropped.
+     */
+    bool SendDmx(unsigned int universe,
+                 const DmxBuffer &data,
+                 uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT);
+
+   private:
+    Sender(StreamingClient *client, unsigned int queue_size)
+        : m_client(client),
+          m_queue(queue_size) {
+    }
+
+    StreamingClient *m_client;
+    ola::thread::SPSCQueue<QueuedFrame> m_queue;
+
+    friend class StreamingClient;
+    DISALLOW_COPY_AND_ASSIGN(Sender);
   };
 
   /**
@@ -150,7 +332,8 @@ class StreamingClient : public StreamingClientInterface {
    * @param universe the universe to send on.
    * @param data the DMX512 data.
    * @returns true if sent successfully, false if the connection to the server
-   *   has been closed.
+   *   has been closed. If auto_reconnect is set this returns true while the
+   *   client is reconnecting, the data is sent once it has reconnected.
    */
   bool SendDmx(unsigned int universe, const DmxBuffer &data);
 
@@ -164,18 +347,111 @@ class StreamingClient : public StreamingClientInterface {
                const DmxBuffer &data,
                const SendArgs &args);
 
+  /**
+   * @brief Send DMX data for a number of universes in a single message.
+   * @param batch the data to send.
+   * @returns true if sent successfully, false if the connection to the server
+   *   has been closed.
+   *
+   * olad applies all the data in the batch before merging, so each universe
+   * is merged and output once per batch. This is much cheaper than calling
+   * SendDMX() for each universe when driving many universes.
+   */
+  bool SendDmxBatch(const std::vector<UniverseData> &batch);
+
+  /**
+   * @brief Create a new Sender, this requires the threaded option.
+   * @returns a Sender owned by the StreamingClient, or NULL if the client
+   *   isn't threaded.
+   */
+  Sender *NewSender();
+
   void ChannelClosed(ola::rpc::RpcSession *session);
 
  private:
   bool m_auto_start;
   uint16_t m_server_port;
-  ola::network::TCPSocket *m_socket;
+  bool m_use_shared_memory;
+  bool m_use_udp;
+  std::string m_server_address;
+  std::string m_server_socket;
+  bool m_delta_encoding;
+  bool m_threaded;
+  unsigned int m_sender_queue_size;
+  ola::io::ConnectedDescriptor *m_socket;
   ola::io::SelectServer *m_ss;
   class ola::rpc::RpcChannel *m_channel;
   class ola::proto::OlaServerService_Stub *m_stub;
+  SharedDmxClient *m_shared_dmx;
+  UDPStreamSender *m_udp_sender;
+  // Used while the OpenUDPStream RPC is outstanding.
+  ola::rpc::RpcController *m_udp_controller;
+  ola::proto::UDPStreamReply *m_udp_reply;
   bool m_socket_closed;
+  // The latest held back data for each universe.
+  std::map<unsigned int, UniverseData> m_pending;
 
+  // Used when auto_reconnect is set.
+  bool m_auto_reconnect;
+  unsigned int m_reconnect_delay;  // in ms
+  ola::thread::timeout_id m_reconnect_timeout;
+  // The latest data sent to each universe, this is sent again on reconnect.
+  std::map<unsigned int, UniverseData> m_last_frames;
+
+  class SentFrame {
+   public:
+    SentFrame() : deltas(0) {}
+
+    DmxBuffer data;
+    unsigned int deltas;  // the number of deltas since the last full frame
+  };
+
+  // The last frame sent over RPC for each universe, used for delta encoding.
+  std::map<unsigned int, SentFrame> m_sent_frames;
+  ola::dmx::RunLengthEncoder m_encoder;
+
+  // Used when threaded.
+  ola::thread::CallbackThread *m_io_thread;
+  ola::io::LoopbackDescriptor m_wake_up;
+  bool m_io_running;  // accessed atomically
+  bool m_io_stopping;  // accessed atomically
+  bool m_wake_up_pending;  // accessed atomically
+  ola::thread::MPSCQueue<QueuedFrame> m_queue;
+  ola::thread::Mutex m_sender_mutex;
+  std::vector<Sender*> m_senders;  // protected by m_sender_mutex
+
+  bool Connect(bool auto_start);
+  void Disconnect();
+  void UDPStreamOpened();
+  bool SendUDP(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+  void ScheduleReconnect();
+  void Reconnect();
+  void KeepFrame(unsigned int universe, uint8_t priority,
+                 const DmxBuffer &data);
   bool Send(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+  bool CheckConnection();
+  void HoldBack(unsigned int universe, uint8_t priority,
+                const DmxBuffer &data);
+  bool SendPending();
+  void SetData(ola::proto::DmxData *message, unsigned int universe,
+               const DmxBuffer &data);
+  bool SendFrames(const std::vector<UniverseData> &batch);
+  bool ConnectionClosed();
+  bool StartIOThread();
+  void StopIOThread();
+  bool Queue(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+  void WakeUp();
+  void DrainQueues();
+  void FlushPending();
+
+  // Streamed data isn't acknowledged, so send a full frame periodically in
+  // case olad dropped one.
+  static const unsigned int MAX_DELTAS = 40;
+
+  // The bounds of the delay between reconnect attempts, in ms. The delay
+  // doubles after each failed attempt.
+  static const unsigned int MIN_RECONNECT_DELAY = 50;
+  static const unsigned int MAX_RECONNECT_DELAY = 1000;
 
   DISALLOW_COPY_AND_ASSIGN(StreamingClient);
 };
@@ -1,4 +1,7 @@
 oladmxincludedir = $(pkgincludedir)/dmx/
 oladmxinclude_HEADERS = \
+    include/ola/dmx/PixelProcessor.h \
+    include/ola/dmx/ReceiveStats.h \
     include/ola/dmx/RunLengthEncoder.h \
-    include/ola/dmx/SourcePriorities.h
+    include/ola/dmx/SourcePriorities.h \
+    include/ola/dmx/TrackedDmxBuffer.h
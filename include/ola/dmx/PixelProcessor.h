@@ -0,0 +1,173 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PixelProcessor.h
+ * Gamma, white balance, color order & dithering for RGB pixel outputs.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @file PixelProcessor.h
+ * @brief Post-processing of RGB pixel data before it's sent to a device.
+ */
+
+#ifndef INCLUDE_OLA_DMX_PIXELPROCESSOR_H_
+#define INCLUDE_OLA_DMX_PIXELPROCESSOR_H_
+
+#include <stdint.h>
+#include <ola/base/Macro.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief Applies gamma, white balance, color order and temporal dithering to
+ * RGB pixel data.
+ *
+ * The gamma curve and white balance are combined into a lookup table for
+ * each color when the processor is created, so processing a frame is a
+ * single pass with a table lookup per slot.
+ *
+ * With dithering enabled, the lookup tables hold 8.8 fixed point values and
+ * the fractional part left over for each slot is carried into the next
+ * frame. At typical pixel refresh rates this gives a perceived depth much
+ * greater than 8 bits, which helps most at low levels where a gamma curve
+ * maps many input values to the same output value. Since the carried error
+ * is per slot, each output needs its own processor.
+ *
+ * Pixel outputs are configured through their plugin preferences, the keys
+ * are the plugin specific prefix followed by one of the names returned by
+ * OptionNames(). See SetOption() for the format of each.
+ */
+class PixelProcessor {
+ public:
+  /**
+   * @brief The number of slots in an RGB pixel.
+   */
+  static const unsigned int SLOTS_PER_PIXEL = 3;
+
+  struct Options {
+   public:
+    Options()
+        : gamma(1.0),
+          dither(false) {
+      for (unsigned int i = 0; i < SLOTS_PER_PIXEL; i++) {
+        white_balance[i] = 1.0;
+        color_order[i] = i;
+      }
+    }
+
+    /**
+     * @brief The gamma exponent, 1.0 is linear.
+     */
+    double gamma;
+
+    /**
+     * @brief The scale applied to red, green & blue, between 0.0 and 1.0.
+     */
+    double white_balance[SLOTS_PER_PIXEL];
+
+    /**
+     * @brief The input color (0 = red, 1 = green, 2 = blue) for each output
+     * slot of a pixel.
+     */
+    uint8_t color_order[SLOTS_PER_PIXEL];
+
+    /**
+     * @brief Enable temporal dithering.
+     */
+    bool dither;
+  };
+
+  /**
+   * @brief Create a new PixelProcessor.
+   * @param options the Options to use, these must be valid.
+   */
+  explicit PixelProcessor(const Options &options);
+
+  /**
+   * @brief Check if processing leaves the data unchanged.
+   *
+   * Callers can use this to skip the processor entirely.
+   */
+  bool IsIdentity() const { return m_identity; }
+
+  /**
+   * @brief Process RGB pixels.
+   * @param input the RGB data, SLOTS_PER_PIXEL * pixels bytes.
+   * @param pixels the number of pixels to process.
+   * @param output the processed data, SLOTS_PER_PIXEL * pixels bytes. This
+   *   may be the same as input.
+   */
+  void Process(const uint8_t *input, unsigned int pixels, uint8_t *output);
+
+  /**
+   * @brief Reset the error carried between frames when dithering.
+   */
+  void ResetDither();
+
+  /**
+   * @brief Return the transfer function for a color.
+   *
+   * This is used for devices which do their own gamma correction.
+   * @param color the input color, 0 = red, 1 = green, 2 = blue.
+   * @param level the input level, between 0.0 and 1.0.
+   * @returns the output level, between 0 and 0xffff.
+   */
+  uint16_t Transfer(unsigned int color, double level) const;
+
+  /**
+   * @brief The names of the options accepted by SetOption().
+   */
+  static const std::vector<std::string> &OptionNames();
+
+  /**
+   * @brief Set an option from a string.
+   *
+   * The options are:
+   *  - gamma, the gamma exponent, e.g. "2.2".
+   *  - white-balance, the red, green & blue scale, e.g. "1.0,0.85,0.7".
+   *  - color-order, the order the colors are sent in, e.g. "GRB".
+   *  - dither, "true" or "false".
+   *
+   * An empty value leaves the option unchanged.
+   * @param name the name of the option.
+   * @param value the value to set.
+   * @param options the Options to update.
+   * @returns true if the name and value were valid, false otherwise.
+   */
+  static bool SetOption(const std::string &name,
+                        const std::string &value,
+                        Options *options);
+
+ private:
+  enum { LUT_SIZE = 256 };
+
+  const Options m_options;
+  const bool m_identity;
+  // The tables are in output slot order.
+  uint8_t m_lut[SLOTS_PER_PIXEL][LUT_SIZE];
+  uint16_t m_dither_lut[SLOTS_PER_PIXEL][LUT_SIZE];
+  std::vector<uint8_t> m_residuals;
+
+  static bool IsIdentity(const Options &options);
+
+  DISALLOW_COPY_AND_ASSIGN(PixelProcessor);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_PIXELPROCESSOR_H_
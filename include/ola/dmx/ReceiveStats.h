@@ -0,0 +1,141 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ReceiveStats.h
+ * Statistics for DMX data received from the network.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @file ReceiveStats.h
+ * @brief Track packet counts, sequence gaps and jitter for received DMX.
+ */
+
+#ifndef INCLUDE_OLA_DMX_RECEIVESTATS_H_
+#define INCLUDE_OLA_DMX_RECEIVESTATS_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief Receive statistics for a universe or a single source.
+ *
+ * The statistics are updated by the thread that receives the packets and may
+ * be read from any other thread. The counters are written with relaxed
+ * atomic stores, so updating them doesn't take a lock or allocate memory.
+ */
+class ReceiveStats {
+ public:
+  ReceiveStats();
+
+  /**
+   * @brief Copy the counters from another ReceiveStats.
+   *
+   * This is safe to call while the other object is being updated. The copy
+   * doesn't carry over the sequence number or arrival time tracking.
+   */
+  ReceiveStats(const ReceiveStats &other);
+  ReceiveStats& operator=(const ReceiveStats &other);
+
+  /**
+   * @brief Check the sequence number of a packet against the last one.
+   * @param sequence the sequence number from the packet.
+   * @param skips_zero true if the sequence numbers wrap from 255 to 1, which
+   *   is what Art-Net does.
+   * @returns the number of packets that were missed before this one, or
+   *   OUT_OF_ORDER if this is a duplicate or older than the previous packet.
+   */
+  int CheckSequence(uint8_t sequence, bool skips_zero = false);
+
+  /**
+   * @brief Record that a packet was received.
+   * @param now the time the packet arrived.
+   * @param missed the value returned by CheckSequence(), or 0 if the protocol
+   *   doesn't use sequence numbers.
+   */
+  void PacketReceived(const TimeStamp &now, int missed = 0);
+
+  /**
+   * @brief The number of packets received.
+   */
+  uint32_t Packets() const;
+
+  /**
+   * @brief The number of packets that were missed, based on the sequence
+   *   numbers.
+   */
+  uint32_t SequenceGaps() const;
+
+  /**
+   * @brief The number of packets that were duplicates or arrived out of order.
+   */
+  uint32_t OutOfOrder() const;
+
+  /**
+   * @brief The time the last packet arrived, this isn't set if no packets have
+   *   been received.
+   */
+  TimeStamp LastSeen() const;
+
+  /**
+   * @brief The smoothed inter-arrival jitter, see RFC 3550.
+   */
+  uint32_t JitterMicroSeconds() const;
+
+  /**
+   * @brief The number of packets in a bucket of the jitter histogram.
+   * @param bucket the bucket, between 0 and JITTER_BUCKETS - 1.
+   */
+  uint32_t JitterCount(unsigned int bucket) const;
+
+  /**
+   * @brief The upper limit of a jitter histogram bucket.
+   * @param bucket the bucket, between 0 and JITTER_BUCKETS - 1.
+   * @returns the limit in milliseconds, or 0 for the last bucket, which
+   *   doesn't have a limit.
+   */
+  static unsigned int JitterBucketLimit(unsigned int bucket);
+
+  static const int OUT_OF_ORDER = -1;
+  static const unsigned int JITTER_BUCKETS = 8;
+
+ private:
+  // These are read from other threads.
+  uint32_t m_packets;
+  uint32_t m_sequence_gaps;
+  uint32_t m_out_of_order;
+  uint32_t m_jitter_us;
+  uint32_t m_last_seen_s;
+  uint32_t m_last_seen_us;
+  uint32_t m_jitter_counts[JITTER_BUCKETS];
+
+  // These are only used by the receiving thread.
+  TimeStamp m_last_arrival;
+  int64_t m_last_interval;
+  uint8_t m_last_sequence;
+  bool m_have_sequence;
+
+  void CopyCounters(const ReceiveStats &other);
+
+  static const unsigned int JITTER_LIMITS_MS[JITTER_BUCKETS - 1];
+  // Packets older than this are assumed to be a restart of the sequence.
+  static const int8_t SEQUENCE_DIFF_THRESHOLD = -20;
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_RECEIVESTATS_H_
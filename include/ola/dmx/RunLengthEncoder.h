@@ -66,8 +66,50 @@ class RunLengthEncoder {
               unsigned int length,
               DmxBuffer *output);
 
+  /**
+   * Encode the difference between two DMX frames. The frames are XOR'ed
+   * together, which leaves zeros in the unchanged slots, and the result is run
+   * length encoded.
+   * @param[in] base the previous frame. If base is shorter than src, the
+   * missing slots are treated as 0.
+   * @param[in] src the DmxBuffer to encode.
+   * @param[out] data where to store the encoded data
+   * @param[in,out] size the size of the data segment, set to the amount of
+   * data encoded.
+   * @return true if we encoded all data, false if we ran out of space
+   */
+  bool EncodeDelta(const DmxBuffer &base,
+                   const DmxBuffer &src,
+                   uint8_t *data,
+                   unsigned int *size);
+
+  /**
+   * Decode a frame produced by EncodeDelta().
+   * @param[in] base the frame the delta was encoded against.
+   * @param[in] data the encoded delta.
+   * @param[in] length the length of the encoded delta.
+   * @param[out] output the DmxBuffer to store the frame in. The size of the
+   * output matches the frame passed to EncodeDelta().
+   * @returns true if decoding was successful, false if the data was
+   * malformed.
+   */
+  bool DecodeDelta(const DmxBuffer &base,
+                   const uint8_t *data,
+                   unsigned int length,
+                   DmxBuffer *output);
+
  private:
   static const uint8_t REPEAT_FLAG = 0x80;
+  static const unsigned int MAX_SEGMENT_LENGTH = 0x7f;
+
+  static bool EncodeSlots(const uint8_t *src,
+                          unsigned int src_size,
+                          uint8_t *data,
+                          unsigned int *size);
+  static bool DecodeSlots(const uint8_t *data,
+                          unsigned int length,
+                          uint8_t *frame,
+                          unsigned int *frame_size);
 };
 }  // namespace dmx
 }  // namespace ola
@@ -45,6 +45,19 @@ static const uint8_t SOURCE_PRIORITY_DEFAULT = 100;
  */
 static const uint8_t SOURCE_PRIORITY_MAX = 200;
 
+/**
+ * @brief The start code used to carry a priority for each slot.
+ *
+ * This isn't part of the E1.31 standard, but many consoles send it. A source
+ * sends its slot priorities in a separate packet alongside the DMX data.
+ */
+static const uint8_t SLOT_PRIORITY_START_CODE = 0xdd;
+
+/**
+ * @brief A slot priority of 0 means the source isn't controlling that slot.
+ */
+static const uint8_t SLOT_PRIORITY_NOT_SOURCED = 0;
+
 }  // namespace dmx
 }  // namespace ola
 #endif  // INCLUDE_OLA_DMX_SOURCEPRIORITIES_H_
@@ -0,0 +1,151 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TrackedDmxBuffer.h
+ * A DmxBuffer that records which slots change.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @file TrackedDmxBuffer.h
+ * @brief A DmxBuffer that records which slots change, so consumers don't
+ * need to compare whole frames.
+ */
+
+#ifndef INCLUDE_OLA_DMX_TRACKEDDMXBUFFER_H_
+#define INCLUDE_OLA_DMX_TRACKEDDMXBUFFER_H_
+
+#include <stdint.h>
+#include <ola/DmxBuffer.h>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A range of slots, from first up to but not including end.
+ */
+struct SlotRange {
+  unsigned int first;
+  unsigned int end;
+
+  SlotRange() : first(0), end(0) {}
+  SlotRange(unsigned int _first, unsigned int _end)
+      : first(_first),
+        end(_end) {
+  }
+
+  bool Empty() const { return first >= end; }
+  unsigned int Length() const { return Empty() ? 0 : end - first; }
+
+  /**
+   * @brief Extend this range to cover another one.
+   */
+  void Extend(const SlotRange &other);
+
+  bool operator==(const SlotRange &other) const {
+    return (Empty() && other.Empty()) ||
+           (first == other.first && end == other.end);
+  }
+};
+
+/**
+ * @brief A DmxBuffer that records which slots change.
+ *
+ * Each write that changes at least one slot increments the generation, and
+ * records the range of slots that changed. A consumer remembers the
+ * generation it last saw, and ChangesSince() returns the slots that have
+ * changed after that, so only those need to be processed or sent. Writes
+ * that don't change any slots don't increment the generation.
+ *
+ * A change in size counts as a change to the slots between the old and new
+ * sizes.
+ *
+ * The last HISTORY_SIZE changes are kept. If a consumer asks about an older
+ * generation, ChangesSince() returns every slot.
+ */
+class TrackedDmxBuffer {
+ public:
+  TrackedDmxBuffer();
+  explicit TrackedDmxBuffer(const DmxBuffer &data);
+
+  /**
+   * @brief The current data.
+   */
+  const DmxBuffer &Buffer() const { return m_buffer; }
+
+  unsigned int Size() const { return m_buffer.Size(); }
+
+  /**
+   * @brief The generation of the data, this starts at 0.
+   */
+  uint32_t Generation() const { return m_generation; }
+
+  /**
+   * @brief The slots that have changed since a generation.
+   * @param generation a value previously returned by Generation().
+   * @returns a range covering all the slots that changed. This may include
+   *   slots that didn't change.
+   */
+  SlotRange ChangesSince(uint32_t generation) const;
+
+  /**
+   * @brief Returns true if any slots changed since a generation.
+   */
+  bool ChangedSince(uint32_t generation) const {
+    return generation != m_generation;
+  }
+
+  /**
+   * @name Writes
+   * These behave like the DmxBuffer methods of the same name.
+   * @{
+   */
+  bool Set(const DmxBuffer &data);
+  bool Set(const uint8_t *data, unsigned int length);
+  bool SetRange(unsigned int offset, const uint8_t *data,
+                unsigned int length);
+  bool SetRangeToValue(unsigned int offset, uint8_t value,
+                       unsigned int length);
+  void SetChannel(unsigned int channel, uint8_t data);
+  bool HTPMerge(const DmxBuffer &other);
+  bool Blackout();
+  void Reset();
+  /** @} */
+
+  /**
+   * @brief Find the range of slots that differ between two blocks of data.
+   *
+   * Slots past the end of the shorter block are counted as different.
+   */
+  static SlotRange DifferingRange(const uint8_t *a, unsigned int a_length,
+                                  const uint8_t *b, unsigned int b_length);
+
+  static const unsigned int HISTORY_SIZE = 16;
+
+ private:
+  DmxBuffer m_buffer;
+  uint32_t m_generation;
+  // The range changed by each generation, indexed by generation %
+  // HISTORY_SIZE.
+  SlotRange m_history[HISTORY_SIZE];
+
+  void Snapshot(unsigned int first, unsigned int end, uint8_t *data) const;
+  void Compare(unsigned int old_size, const uint8_t *before,
+               unsigned int first, unsigned int end);
+  void Record(const SlotRange &range);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_TRACKEDDMXBUFFER_H_
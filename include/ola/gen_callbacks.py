@@ -70,6 +70,9 @@ USA
    * Callbacks are used throughout OLA to reduce the coupling between classes
    * and make for more modular code.
    *
+   * The memory for callbacks is recycled by the CallbackAllocator, so creating
+   * and running a single use callback doesn't normally touch the heap.
+   *
    * Avoid creating Callbacks by directly calling the constructor. Instead use
    * the NewSingleCallback() and NewCallback() helper methods.
    *
@@ -139,6 +142,8 @@ USA
   #ifndef INCLUDE_OLA_CALLBACK_H_
   #define INCLUDE_OLA_CALLBACK_H_
 
+  #include <ola/CallbackAllocator.h>
+
   namespace ola {
 
   /**
@@ -177,7 +182,7 @@ def GenerateBase(number_of_args):
    */""" % number_of_args))
   PrintLongLine('template <typename ReturnType%s%s>' %
                 (optional_comma, typenames))
-  print('class BaseCallback%d {' % number_of_args)
+  print('class BaseCallback%d: public PooledCallback {' % number_of_args)
   print(' public:')
   print('  virtual ~BaseCallback%d() {}' % number_of_args)
   PrintLongLine('  virtual ReturnType Run(%s) = 0;' % arg_list)
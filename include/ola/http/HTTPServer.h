@@ -26,12 +26,14 @@
 #include <ola/base/Macro.h>
 #include <ola/io/Descriptor.h>
 #include <ola/io/SelectServer.h>
+#include <ola/thread/Mutex.h>
 #include <ola/thread/Thread.h>
 #include <ola/web/Json.h>
 // 0.4.6 of microhttp doesn't include stdarg so we do it here.
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <ola/win/CleanWinSock2.h>
@@ -87,6 +89,12 @@ class HTTPRequest {
   bool InFlight() const { return m_in_flight; }
   void SetInFlight() { m_in_flight = true; }
 
+  // Used when the connection is suspended while a handler runs on the HTTP
+  // server's thread.
+  void SetPendingResponse(unsigned int status_code,
+                          struct MHD_Response *response);
+  int QueuePendingResponse();
+
  private:
   std::string m_url;
   std::string m_method;
@@ -96,6 +104,8 @@ class HTTPRequest {
   std::map<std::string, std::string> m_post_params;
   struct MHD_PostProcessor *m_processor;
   bool m_in_flight;
+  struct MHD_Response *m_pending_response;
+  unsigned int m_pending_status_code;
 
   static const unsigned int K_POST_BUFFER_SIZE = 1024;
 
@@ -108,30 +118,92 @@ class HTTPRequest {
  */
 class HTTPResponse {
  public:
-  explicit HTTPResponse(struct MHD_Connection *connection):
-    m_connection(connection),
-    m_status_code(MHD_HTTP_OK) {}
+  explicit HTTPResponse(struct MHD_Connection *connection);
 
   void Append(const std::string &data) { m_data.append(data); }
+  // The body of the response, large JSON responses are written here with a
+  // JsonStreamWriter and then sent with Send().
+  std::string *MutableData() { return &m_data; }
   void SetContentType(const std::string &type);
   void SetHeader(const std::string &key, const std::string &value);
   void SetStatus(unsigned int status) { m_status_code = status; }
   void SetNoCache();
   void SetAccessControlAllowOriginAll();
+  // Set the ETag & Last-Modified validators. Returns true if the client
+  // already has this version, in which case Send() sends a 304 without the
+  // body, so there's no need to build it.
+  bool SetValidators(const std::string &etag, time_t last_modified);
   int SendJson(const ola::web::JsonValue &json);
   int Send();
+  int QueueResponse(struct MHD_Response *response);
   struct MHD_Connection *Connection() const { return m_connection; }
+  // Set when the request's connection was suspended, the response is then
+  // handed back to libmicrohttpd when the connection is resumed.
+  void SetSuspendedRequest(HTTPRequest *request) {
+    m_suspended_request = request;
+  }
  private:
   std::string m_data;
   struct MHD_Connection *m_connection;
   typedef std::multimap<std::string, std::string> HeadersMultiMap;
   HeadersMultiMap m_headers;
   unsigned int m_status_code;
+  HTTPRequest *m_suspended_request;
+  // From the request, these are read when the response is created since
+  // the response may be sent from another thread.
+  std::string m_accept_encoding;
+  std::string m_if_none_match;
+  std::string m_if_modified_since;
+  bool m_not_modified;
 
   DISALLOW_COPY_AND_ASSIGN(HTTPResponse);
 };
 
 
+/*
+ * A stream of server-sent events, see HTTPServer::StartEventStream().
+ *
+ * Events can be sent from any thread. The stream is deleted once the owner
+ * has called Close() and libmicrohttpd has finished with the connection.
+ */
+class HTTPEventStream {
+ public:
+  // Returns false if the client has gone away or the stream was closed.
+  bool SendEvent(const std::string &event, const std::string &data);
+  bool SendComment(const std::string &comment);
+  // The number of bytes waiting to be sent to the client.
+  unsigned int QueuedBytes() const;
+  bool ClientClosed() const;
+  // Finish the stream, the stream must not be used after this.
+  void Close();
+
+ private:
+  explicit HTTPEventStream(struct MHD_Connection *connection);
+  ~HTTPEventStream() {}
+
+  struct MHD_Connection *m_connection;
+  mutable ola::thread::Mutex m_mutex;
+  std::string m_queue;
+  bool m_suspended;
+  bool m_closed;
+  bool m_client_closed;
+  unsigned int m_references;
+
+  bool Append(const std::string &data);
+  void Resume();
+  ssize_t Read(char *buffer, size_t max);
+  void Release();
+
+  static ssize_t ReadCallback(void *stream, uint64_t position, char *buffer,
+                              size_t max);
+  static void FreeCallback(void *stream);
+
+  friend class HTTPServer;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPEventStream);
+};
+
+
 /**
  * @addtogroup http_server
  * @{
@@ -141,6 +213,11 @@ class HTTPResponse {
  * This is a simple HTTP Server built around libmicrohttpd. It runs in a
  * separate thread.
  *
+ * If thread_pool_size is set, libmicrohttpd uses its own pool of threads to
+ * read requests and serve static files. The handlers are still run on the
+ * HTTP server's thread; the connection is suspended while the request waits
+ * in the SelectServer's queue.
+ *
  * @examplepara
  * @code
  *   HTTPServer::HTTPServerOptions options;
@@ -164,10 +241,25 @@ class HTTPServer: public ola::thread::Thread {
     uint16_t port;
     // The root for content served with ServeStaticContent();
     std::string data_dir;
+    // The number of libmicrohttpd threads, 0 means the connections are
+    // handled on the HTTP server's thread.
+    unsigned int thread_pool_size;
+    // Keep static files in memory, along with a gzipped copy and an ETag.
+    bool cache_static_content;
+    // The memory libmicrohttpd allocates for each connection, 0 uses
+    // libmicrohttpd's default.
+    unsigned int connection_memory_limit;
+    // The maximum number of concurrent connections, 0 uses libmicrohttpd's
+    // default.
+    unsigned int connection_limit;
 
     HTTPServerOptions()
       : port(0),
-        data_dir("") {
+        data_dir(""),
+        thread_pool_size(0),
+        cache_static_content(false),
+        connection_memory_limit(0),
+        connection_limit(0) {
     }
   };
 
@@ -184,7 +276,7 @@ class HTTPServer: public ola::thread::Thread {
    */
   void HandleHTTPIO() {}
 
-  int DispatchRequest(const HTTPRequest *request, HTTPResponse *response);
+  int DispatchRequest(HTTPRequest *request, HTTPResponse *response);
 
   // Register a callback handler.
   bool RegisterHandler(const std::string &path, BaseHTTPCallback *handler);
@@ -211,6 +303,9 @@ class HTTPServer: public ola::thread::Thread {
                          const std::string &content_type,
                          HTTPResponse *response);
 
+  // Start a stream of server-sent events.
+  HTTPEventStream *StartEventStream(HTTPResponse *response);
+
   static const char CONTENT_TYPE_PLAIN[];
   static const char CONTENT_TYPE_HTML[];
   static const char CONTENT_TYPE_GIF[];
@@ -221,11 +316,14 @@ class HTTPServer: public ola::thread::Thread {
   static const char CONTENT_TYPE_OCT[];
   static const char CONTENT_TYPE_XML[];
   static const char CONTENT_TYPE_JSON[];
+  static const char CONTENT_TYPE_EVENT_STREAM[];
 
   // Expose the SelectServer
   ola::io::SelectServer *SelectServer() { return m_select_server.get(); }
 
   static struct MHD_Response *BuildResponse(void *data, size_t size);
+  static struct MHD_Response *BuildPersistentResponse(const std::string &data);
+  static std::string BuildETag(const std::string &data);
 
  private :
   typedef struct {
@@ -254,6 +352,14 @@ class HTTPServer: public ola::thread::Thread {
 
   typedef std::set<DescriptorState*, Descriptor_lt> SocketSet;
 
+  typedef struct {
+    std::string data;
+    std::string gzipped_data;  // empty if gzip isn't available or smaller
+    std::string etag;
+  } cached_file;
+
+  typedef std::map<std::string, cached_file*> FileCache;
+
   struct MHD_Daemon *m_httpd;
   std::auto_ptr<ola::io::SelectServer> m_select_server;
   SocketSet m_sockets;
@@ -263,9 +369,25 @@ class HTTPServer: public ola::thread::Thread {
   BaseHTTPCallback *m_default_handler;
   unsigned int m_port;
   std::string m_data_dir;
-
-  int ServeStaticContent(static_file_info *file_info,
+  unsigned int m_thread_pool_size;
+  bool m_cache_static_content;
+  unsigned int m_connection_memory_limit;
+  unsigned int m_connection_limit;
+  // Entries are never modified once they are added.
+  FileCache m_file_cache;
+  ola::thread::Mutex m_file_cache_mutex;
+
+  int ServeStaticContent(const static_file_info *file_info,
+                         const HTTPRequest *request,
+                         HTTPResponse *response);
+  int ServeCachedContent(const static_file_info *file_info,
+                         const HTTPRequest *request,
                          HTTPResponse *response);
+  const cached_file *GetCachedFile(const std::string &file_path);
+  bool ReadFile(const std::string &file_path, std::string *data) const;
+  void DeferredRunHandler(BaseHTTPCallback *handler,
+                          const HTTPRequest *request,
+                          HTTPResponse *response);
 
   void InsertSocket(bool is_readable, bool is_writeable, int fd);
   void FreeSocket(DescriptorState *state);
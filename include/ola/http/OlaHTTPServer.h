@@ -62,6 +62,7 @@ class OlaHTTPServer {
  private:
     static const char K_DATA_DIR_VAR[];
     static const char K_UPTIME_VAR[];
+    static const char K_METRICS_CONTENT_TYPE[];
 
     inline void RegisterHandler(
         const std::string &path,
@@ -78,6 +79,7 @@ class OlaHTTPServer {
 
     int DisplayDebug(const HTTPRequest *request, HTTPResponse *response);
     int DisplayHandlers(const HTTPRequest *request, HTTPResponse *response);
+    int DisplayMetrics(const HTTPRequest *request, HTTPResponse *response);
 
     DISALLOW_COPY_AND_ASSIGN(OlaHTTPServer);
 };
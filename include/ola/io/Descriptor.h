@@ -161,6 +161,17 @@ class ReadFileDescriptor {
    * This is usually called by the SelectServer.
    */
   virtual void PerformRead() = 0;
+
+  /**
+   * @brief Check if this descriptor can use edge triggered notifications.
+   * @returns true if PerformRead() always reads until the descriptor would
+   *   block.
+   *
+   * Pollers that support it, only notify edge triggered descriptors when new
+   * data arrives, rather than on every iteration of the loop while there is
+   * data waiting. Pollers that don't support it ignore this.
+   */
+  virtual bool EdgeTriggered() const { return false; }
 };
 
 
@@ -200,7 +211,11 @@ class WriteFileDescriptor {
 class BidirectionalFileDescriptor: public ReadFileDescriptor,
                                    public WriteFileDescriptor {
  public :
-  BidirectionalFileDescriptor(): m_on_read(NULL), m_on_write(NULL) {}
+  BidirectionalFileDescriptor()
+      : m_on_read(NULL),
+        m_on_write(NULL),
+        m_edge_triggered(false) {
+  }
 
   virtual ~BidirectionalFileDescriptor() {
     if (m_on_read)
@@ -232,12 +247,26 @@ class BidirectionalFileDescriptor: public ReadFileDescriptor,
     m_on_write = on_write;
   }
 
+  /**
+   * @brief Use edge triggered notifications for this descriptor.
+   * @param edge_triggered true if the on_read callback always reads until the
+   *   descriptor would block. If it doesn't, data may be left unread.
+   *
+   * This must be called before the descriptor is added to the SelectServer.
+   */
+  void SetEdgeTriggered(bool edge_triggered) {
+    m_edge_triggered = edge_triggered;
+  }
+
+  bool EdgeTriggered() const { return m_edge_triggered; }
+
   void PerformRead();
   void PerformWrite();
 
  private:
   ola::Callback0<void> *m_on_read;
   ola::Callback0<void> *m_on_write;
+  bool m_edge_triggered;
 };
 
 
@@ -0,0 +1,155 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxLineDriver.h
+ * Generates DMX512 / RDM frames on a UART with an RS-485 transceiver.
+ */
+
+#ifndef INCLUDE_OLA_IO_DMXLINEDRIVER_H_
+#define INCLUDE_OLA_IO_DMXLINEDRIVER_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <string>
+
+namespace ola {
+namespace io {
+
+/**
+ * @brief Drives a DMX512 line from a serial port.
+ *
+ * The driver produces the break, mark after break and slot data for each
+ * frame, and can optionally read the response to an RDM request. It's
+ * blocking and is meant to be used from a dedicated output thread.
+ */
+class DmxLineDriver {
+ public:
+  /**
+   * @brief How the break is generated.
+   */
+  enum BreakMode {
+    /**
+     * Assert the break with TIOCSBRK and time the break and MAB with
+     * absolute sleeps.
+     */
+    BREAK_IOCTL,
+    /**
+     * Drop the baud rate and send a single 0, so the UART itself times the
+     * break and MAB. This avoids two sleeps per frame but costs two baud
+     * rate changes, which some drivers handle slowly.
+     */
+    BREAK_BAUD,
+  };
+
+  struct Options {
+    BreakMode break_mode;
+    /** @brief The break time in microseconds, for BREAK_IOCTL. */
+    unsigned int break_time;
+    /** @brief The mark after break in microseconds, for BREAK_IOCTL. */
+    unsigned int mab_time;
+    /** @brief Use the kernel's RS-485 direction control. */
+    bool rs485;
+    /** @brief RTS delays in ms, if rs485 is true. */
+    unsigned int rts_delay_before_send;
+    unsigned int rts_delay_after_send;
+    /** @brief Open the port for reading as well, this is required for RDM. */
+    bool enable_receive;
+
+    Options()
+        : break_mode(BREAK_IOCTL),
+          break_time(DEFAULT_BREAK_TIME),
+          mab_time(DEFAULT_MAB_TIME),
+          rs485(false),
+          rts_delay_before_send(0),
+          rts_delay_after_send(0),
+          enable_receive(false) {
+    }
+  };
+
+  DmxLineDriver(const std::string &path, const Options &options);
+  ~DmxLineDriver();
+
+  const std::string &Path() const { return m_path; }
+
+  /**
+   * @brief Open and configure the port for 250k, 8N2.
+   */
+  bool Open();
+
+  bool Close();
+
+  bool IsOpen() const { return m_fd >= 0; }
+
+  /**
+   * @brief Send a frame.
+   * @param data the frame, including the start code.
+   * @param length the length of data.
+   * @returns true if the frame was sent.
+   *
+   * This returns once the last slot has left the UART, so the next frame, or
+   * an RDM response, can follow immediately.
+   */
+  bool SendFrame(const uint8_t *data, unsigned int length);
+
+  /**
+   * @brief Send a DMX512 frame with the null start code.
+   */
+  bool SendDmx(const DmxBuffer &buffer);
+
+  /**
+   * @brief Receive a frame, e.g. an RDM response.
+   * @param data the buffer to read into.
+   * @param[in,out] length the size of data, set to the number of bytes
+   *   received.
+   * @param timeout how long to wait for the first byte.
+   * @param[out] turnaround the time between the end of the last frame we
+   *   sent and the arrival of the first byte of the response, may be NULL.
+   * @returns true if any data was received.
+   *
+   * The frame ends when the line is idle for longer than the maximum RDM
+   * inter-slot time. A break is read as a leading 0, which is removed.
+   */
+  bool ReceiveFrame(uint8_t *data, unsigned int *length,
+                    const TimeInterval &timeout,
+                    TimeInterval *turnaround);
+
+  static const unsigned int DEFAULT_BREAK_TIME = 176;
+  static const unsigned int DEFAULT_MAB_TIME = 16;
+
+ private:
+  const std::string m_path;
+  const Options m_options;
+  int m_fd;
+  Clock m_clock;
+  TimeStamp m_last_frame_end;
+
+  bool SendBreak();
+  bool WriteAll(const uint8_t *data, unsigned int length);
+  bool WaitForData(const TimeInterval &timeout);
+
+  // 9 low bits at 50k is a 180us break, the two stop bits a 40us MAB. Both
+  // are within the E1.20 limits for a controller.
+  static const unsigned int BREAK_BAUD_RATE = 50000;
+  static const unsigned int DMX_BAUD_RATE = 250000;
+  // E1.20 allows 2.1ms between slots of a response.
+  static const int64_t INTER_SLOT_TIMEOUT_US = 2100;
+
+  DISALLOW_COPY_AND_ASSIGN(DmxLineDriver);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // INCLUDE_OLA_IO_DMXLINEDRIVER_H_
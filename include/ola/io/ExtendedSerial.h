@@ -39,6 +39,30 @@ class LinuxHelper {
    * speed selection mechanism from the Linux kernel.
    */
   static bool SetDmxBaud(int fd);
+
+  /**
+   * Set the baud rate of the serial port to an arbitrary value, using the
+   * same mechanism as SetDmxBaud().
+   * @param fd the serial port.
+   * @param rate the baud rate.
+   * @param quiet if true, don't log the resulting speeds. This is for callers
+   *   that switch speed on every frame.
+   */
+  static bool SetBaud(int fd, unsigned int rate, bool quiet = false);
+
+  /**
+   * Enable or disable the kernel's RS-485 direction control. The driver then
+   * asserts RTS while transmitting, so the transceiver is only driven while
+   * data is being sent.
+   * @param fd the serial port.
+   * @param enable true to enable RS-485 mode.
+   * @param delay_before_send the delay in ms between asserting RTS and the
+   *   first bit.
+   * @param delay_after_send the delay in ms between the last bit and
+   *   releasing RTS.
+   */
+  static bool SetRS485(int fd, bool enable, unsigned int delay_before_send,
+                       unsigned int delay_after_send);
 };
 }  // namespace io
 }  // namespace ola
@@ -3,6 +3,7 @@ olaioinclude_HEADERS = \
     include/ola/io/BigEndianStream.h \
     include/ola/io/ByteString.h \
     include/ola/io/Descriptor.h \
+    include/ola/io/DmxLineDriver.h \
     include/ola/io/ExtendedSerial.h \
     include/ola/io/IOQueue.h \
     include/ola/io/IOStack.h \
@@ -19,4 +20,5 @@ olaioinclude_HEADERS = \
     include/ola/io/SelectServer.h \
     include/ola/io/SelectServerInterface.h \
     include/ola/io/Serial.h \
-    include/ola/io/StdinHandler.h
+    include/ola/io/StdinHandler.h \
+    include/ola/io/ThreadSafeMemoryBlockPool.h
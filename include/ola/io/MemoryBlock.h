@@ -106,6 +106,28 @@ class MemoryBlock {
      */
     uint8_t *Data() const { return m_first; }
 
+    /**
+     * @brief Provides a pointer to the free space at the end of the block.
+     * @returns a pointer to the first byte after the valid data in this block.
+     *
+     * This allows data to be read or serialized directly into the block. Once
+     * the data has been written, call Extend() to add it to the block.
+     */
+    uint8_t *FreeSpace() const { return m_last; }
+
+    /**
+     * @brief Add data written to FreeSpace() to this block.
+     * @param length the length of the data written.
+     * @returns the number of bytes added, which will be less than length if
+     * the block is now full.
+     */
+    unsigned int Extend(unsigned int length) {
+      unsigned int bytes_to_add = std::min(
+          length, static_cast<unsigned int>(m_data_end - m_last));
+      m_last += bytes_to_add;
+      return bytes_to_add;
+    }
+
     /**
      * @brief Append data to this block.
      * @param data the data to append.
@@ -29,7 +29,8 @@ namespace ola {
 namespace io {
 
 /**
- * @brief MemoryBlockPool. This class is not thread safe.
+ * @brief MemoryBlockPool. This class is not thread safe, see
+ * ThreadSafeMemoryBlockPool for a pool that can be shared between threads.
  * @param block_size the size of blocks to use.
  */
 class MemoryBlockPool {
@@ -38,13 +39,13 @@ class MemoryBlockPool {
         : m_block_size(block_size),
           m_blocks_allocated(0) {
     }
-    ~MemoryBlockPool() {
+    virtual ~MemoryBlockPool() {
       Purge();
     }
 
     // Allocate a new MemoryBlock from the pool. May return NULL if allocation
     // fails.
-    MemoryBlock *Allocate() {
+    virtual MemoryBlock *Allocate() {
       if (m_free_blocks.empty()) {
         uint8_t* data = new uint8_t[m_block_size];
         OLA_DEBUG << "new block allocated at @" << reinterpret_cast<int*>(data);
@@ -62,12 +63,12 @@ class MemoryBlockPool {
     }
 
     // Release a MemoryBlock back to the pool.
-    void Release(MemoryBlock *block) {
+    virtual void Release(MemoryBlock *block) {
       m_free_blocks.push(block);
     }
 
     // Returns the number of free blocks in the pool.
-    unsigned int FreeBlocks() const {
+    virtual unsigned int FreeBlocks() const {
       return static_cast<unsigned int>(m_free_blocks.size());
     }
 
@@ -77,7 +78,7 @@ class MemoryBlockPool {
     }
 
     // Delete all but remaining free blocks.
-    void Purge(unsigned int remaining) {
+    virtual void Purge(unsigned int remaining) {
       while (m_free_blocks.size() != remaining) {
         MemoryBlock *block = m_free_blocks.front();
         m_blocks_allocated--;
@@ -86,11 +87,21 @@ class MemoryBlockPool {
       }
     }
 
-    unsigned int BlocksAllocated() const { return m_blocks_allocated; }
+    virtual unsigned int BlocksAllocated() const {
+      return m_blocks_allocated;
+    }
 
     // default to 1k blocks
     static const unsigned int DEFAULT_BLOCK_SIZE = 1024;
 
+    // Block sizes for common uses.
+    // A DMX frame, including the start code.
+    static const unsigned int DMX_BLOCK_SIZE = 513;
+    // The largest RDM frame, including the start code and checksum.
+    static const unsigned int RDM_BLOCK_SIZE = 257;
+    // An Ethernet MTU sized packet.
+    static const unsigned int MTU_BLOCK_SIZE = 1500;
+
  private:
     std::queue<MemoryBlock*> m_free_blocks;
     const unsigned int m_block_size;
@@ -35,6 +35,7 @@
 #include <ola/io/MemoryBlockPool.h>
 #include <ola/io/OutputBuffer.h>
 #include <ola/io/SelectServerInterface.h>
+#include <map>
 
 namespace ola {
 namespace io {
@@ -53,6 +54,13 @@ namespace io {
  * exceeded, calls to SendMessage() will return false. The limit is a soft
  * limit however, a call to SendMessage() may cause the buffer to exceed the
  * internal limit, provided the limit has not already been reached.
+ *
+ * Messages where only the most recent one matters, like DMX frames, can be
+ * sent with SendLatestMessage(). These are held separately, one per key, and
+ * a newer message replaces an older one that hasn't been written yet. They
+ * are moved to the internal buffer when the descriptor is writable, provided
+ * the buffer is below the limit, so a stalled descriptor holds at most one
+ * message per key rather than a growing backlog.
  */
 class NonBlockingSender {
  public:
@@ -83,6 +91,12 @@ class NonBlockingSender {
    */
   bool LimitReached() const;
 
+  /**
+   * @brief Check if there is any data waiting to be written.
+   * @return true if the internal buffer is empty, false otherwise.
+   */
+  bool Empty() const;
+
   /**
    * @brief Send the contents of an IOStack on the ConnectedDescriptor.
    * @param stack the IOStack to send. All data in this stack will be sent and
@@ -101,6 +115,17 @@ class NonBlockingSender {
    */
   bool SendMessage(IOQueue *queue);
 
+  /**
+   * @brief Send a message, replacing any unsent message with the same key.
+   * @param key identifies the stream of messages, e.g. the DMX label of a port.
+   * @param queue the IOQueue to send. All data in this queue will be sent and
+   *   the queue will be emptied.
+   *
+   * Messages sent with SendMessage() keep their order relative to each other,
+   * but not relative to messages sent with SendLatestMessage().
+   */
+  void SendLatestMessage(unsigned int key, IOQueue *queue);
+
   /**
    * @brief The default max internal buffer size.
    *
@@ -115,10 +140,14 @@ class NonBlockingSender {
  private:
   ola::io::ConnectedDescriptor *m_descriptor;
   ola::io::SelectServerInterface *m_ss;
+  ola::io::MemoryBlockPool *m_memory_pool;
   ola::io::IOQueue m_output_buffer;
   bool m_associated;
   unsigned int m_max_buffer_size;
 
+  typedef std::map<unsigned int, IOQueue*> LatestMessages;
+  LatestMessages m_latest_messages;
+
   void PerformWrite();
   void AssociateIfRequired();
 
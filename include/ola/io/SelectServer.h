@@ -27,10 +27,13 @@
 #include <ola/io/Descriptor.h>
 #include <ola/io/SelectServerInterface.h>
 #include <ola/network/Socket.h>
+#include <ola/thread/MPSCQueue.h>
 #include <ola/thread/Thread.h>
+#include <ola/util/StallWatchdog.h>
 
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 class SelectServerTest;
@@ -66,16 +69,68 @@ class SelectServer: public SelectServerInterface {
    public:
     Options()
         : force_select(false),
+          use_io_uring(false),
+          use_timer_wheel(false),
+          profile_handlers(false),
+          handler_budget(0, DEFAULT_HANDLER_BUDGET_US),
+          busy_poll(0, 0),
           export_map(NULL),
           clock(NULL) {
     }
 
     /**
      * @brief Fall back to the select() implementation even if the flags are
-     * set for kqueue/epoll.
+     * set for kqueue/epoll/poll.
      */
     bool force_select;
 
+    /**
+     * @brief Use io_uring if it's available, rather than epoll.
+     *
+     * If io_uring isn't supported by the kernel we fall back to the other
+     * implementations.
+     */
+    bool use_io_uring;
+
+    /**
+     * @brief Use a timer wheel rather than a heap for the timeouts.
+     *
+     * This makes registering and cancelling timeouts O(1), which helps when
+     * there are thousands of them, but timeouts may run up to a millisecond
+     * late.
+     */
+    bool use_timer_wheel;
+
+    /**
+     * @brief Record the time taken by each iteration of the loop, and by each
+     * descriptor and timeout handler.
+     *
+     * The results are exported as ss-loop-time-us, ss-handler-time-us,
+     * ss-handlers-over-budget and ss-slowest-handlers.
+     */
+    bool profile_handlers;
+
+    /**
+     * @brief When profiling, handlers that take longer than this are logged
+     * and counted. Zero disables the check.
+     */
+    TimeInterval handler_budget;
+
+    /**
+     * @brief Spin with non-blocking polls for up to this long before
+     * blocking. Zero, the default, always blocks.
+     *
+     * This trades CPU time for latency, and is only worthwhile if the thread
+     * has a core to itself. The spin restarts each time it finds an event.
+     * While Run() is spinning the thread's timer slack is reduced, and
+     * sockets are asked to busy poll the network device for the same time.
+     *
+     * The number of events found while spinning and while blocked, and the
+     * time spent spinning, are exported as ss-busy-poll-spin-events,
+     * ss-busy-poll-block-events and ss-busy-poll-spin-time-us.
+     */
+    TimeInterval busy_poll;
+
     /**
      * @brief The export map to use.
      */
@@ -187,10 +242,45 @@ class SelectServer: public SelectServerInterface {
    */
   void RunInLoop(ola::Callback0<void> *callback);
 
+  /**
+   * @brief Execute a callback in the SelectServer thread.
+   * @param callback the Callback to execute. Ownership is transferred to the
+   *   SelectServer.
+   *
+   * This can be called from any thread, it doesn't take a lock. A burst of
+   * calls results in a single wake up of the SelectServer.
+   */
   void Execute(ola::BaseCallback0<void> *callback);
 
   void DrainCallbacks();
 
+  /**
+   * @brief Name a descriptor or timeout, for the profiling stats.
+   * @param handler the descriptor, or the timeout_id.
+   * @param name the name to record the handler's time under.
+   *
+   * This does nothing unless profiling is enabled, see
+   * Options::profile_handlers.
+   */
+  void SetHandlerName(const void *handler, const std::string &name);
+
+  /**
+   * @brief Supervise the handlers with a Heartbeat.
+   * @param heartbeat the Heartbeat to mark each handler with, ownership is not
+   *   transferred. NULL stops using the current one.
+   *
+   * Each handler is a section of the Heartbeat, and if one stalls it's
+   * reported along with the handler's name. This turns on profiling, see
+   * Options::profile_handlers. It must be called from the thread that runs
+   * the SelectServer.
+   */
+  void SetHeartbeat(ola::Heartbeat *heartbeat);
+
+  /**
+   * @brief The default handler budget, in microseconds.
+   */
+  static const unsigned int DEFAULT_HANDLER_BUDGET_US = 10000;
+
  private:
   typedef std::vector<ola::BaseCallback0<void>*> Callbacks;
   typedef std::set<ola::Callback0<void>*> LoopClosureSet;
@@ -198,19 +288,27 @@ class SelectServer: public SelectServerInterface {
   ExportMap *m_export_map;
   bool m_terminate, m_is_running;
   TimeInterval m_poll_interval;
+  TimeInterval m_busy_poll;
+  CounterVariable *m_spin_events;
+  CounterVariable *m_block_events;
+  CounterVariable *m_spin_time;
+  // This must outlive the TimeoutManager and the poller.
+  std::auto_ptr<class LoopProfiler> m_profiler;
   std::auto_ptr<class TimeoutManager> m_timeout_manager;
   std::auto_ptr<class PollerInterface> m_poller;
 
   Clock *m_clock;
   bool m_free_clock;
   LoopClosureSet m_loop_callbacks;
-  Callbacks m_incoming_callbacks;
-  ola::thread::Mutex m_incoming_mutex;
-  LoopbackDescriptor m_incoming_descriptor;
+  ola::thread::MPSCQueue<ola::BaseCallback0<void>*> m_incoming_callbacks;
+  std::auto_ptr<class WakeUpDescriptor> m_wake_up_descriptor;
 
   void Init(const Options &options);
   bool CheckForEvents(const TimeInterval &poll_interval);
+  bool BusyPoll();
+  void EnableBusyPoll(const DescriptorHandle &handle);
   void DrainAndExecute();
+  bool PopCallbacks(Callbacks *callbacks);
   void RunCallbacks(Callbacks *callbacks);
   void SetTerminate() { m_terminate = true; }
 
@@ -129,6 +129,11 @@ class SelectServerInterface: public ola::thread::SchedulingExecutorInterface {
    *
    * If running within the same thread as the SelectServer, this is a efficient
    * way to get the current time.
+   *
+   * The time is updated once each time the SelectServer wakes up, before the
+   * timeouts run, so it lags the real time by however long the earlier
+   * handlers in this iteration took. The pointer remains valid for the
+   * lifetime of the SelectServer.
    */
   virtual const TimeStamp *WakeUpTime() const = 0;
 };
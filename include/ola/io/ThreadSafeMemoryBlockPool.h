@@ -0,0 +1,160 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ThreadSafeMemoryBlockPool.h
+ * A MemoryBlockPool that can be shared between threads.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_IO_THREADSAFEMEMORYBLOCKPOOL_H_
+#define INCLUDE_OLA_IO_THREADSAFEMEMORYBLOCKPOOL_H_
+
+#include <ola/base/Macro.h>
+#include <ola/io/MemoryBlock.h>
+#include <ola/io/MemoryBlockPool.h>
+#include <ola/thread/Mutex.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <set>
+#include <vector>
+
+namespace ola {
+namespace io {
+
+/**
+ * @brief A MemoryBlockPool that can be shared between threads.
+ *
+ * Blocks can be allocated in one thread and released in another, so an
+ * IOQueue can be filled by one thread and drained by another without the
+ * blocks going back to the heap.
+ *
+ * Each thread keeps two magazines, small stacks of free blocks, which are
+ * used without locking. When both are empty, or both are full, the thread
+ * swaps a magazine with the shared depot, which is protected by a mutex.
+ *
+ * To stop the pool growing without bound, once the free blocks reach
+ * Options::max_free_bytes, released blocks are returned to the heap.
+ *
+ * The pool must outlive any thread that uses it. Purge() only frees the
+ * blocks in the depot and the calling thread's magazines.
+ */
+class ThreadSafeMemoryBlockPool: public MemoryBlockPool {
+ public:
+  struct Options {
+   public:
+    /**
+     * @brief The size of the blocks, see the *_BLOCK_SIZE constants in
+     * MemoryBlockPool.
+     */
+    unsigned int block_size;
+
+    /**
+     * @brief The number of blocks in each magazine.
+     */
+    unsigned int magazine_size;
+
+    /**
+     * @brief The maximum number of bytes kept in free blocks, 0 means no
+     * limit.
+     */
+    size_t max_free_bytes;
+
+    Options()
+        : block_size(DEFAULT_BLOCK_SIZE),
+          magazine_size(DEFAULT_MAGAZINE_SIZE),
+          max_free_bytes(DEFAULT_MAX_FREE_BYTES) {
+    }
+  };
+
+  /**
+   * @brief Create a new ThreadSafeMemoryBlockPool.
+   * @param options the Options for the pool.
+   */
+  explicit ThreadSafeMemoryBlockPool(const Options &options = Options());
+
+  /**
+   * @brief Destructor, this frees all the free blocks.
+   */
+  ~ThreadSafeMemoryBlockPool();
+
+  MemoryBlock *Allocate();
+  void Release(MemoryBlock *block);
+  unsigned int FreeBlocks() const;
+  using MemoryBlockPool::Purge;
+  void Purge(unsigned int remaining);
+  unsigned int BlocksAllocated() const;
+
+  /**
+   * @brief The size of the blocks in this pool.
+   */
+  unsigned int BlockSize() const { return m_options.block_size; }
+
+  /**
+   * @brief The number of blocks that had to be allocated from the heap.
+   */
+  uint64_t HeapAllocations() const;
+
+  /**
+   * @brief The number of released blocks that were returned to the heap
+   * because of the max_free_bytes limit.
+   */
+  uint64_t BlocksDiscarded() const;
+
+  /**
+   * @brief The default number of blocks in each magazine.
+   */
+  static const unsigned int DEFAULT_MAGAZINE_SIZE = 32;
+
+  /**
+   * @brief The default limit on free blocks, 4MB.
+   */
+  static const size_t DEFAULT_MAX_FREE_BYTES = 4 * 1024 * 1024;
+
+ private:
+  typedef std::vector<MemoryBlock*> Magazine;
+
+  struct ThreadCache {
+    ThreadSafeMemoryBlockPool *pool;
+    Magazine *loaded;
+    Magazine *previous;
+  };
+
+  const Options m_options;
+  pthread_key_t m_cache_key;
+
+  unsigned int m_blocks_allocated;
+  unsigned int m_free_blocks;
+  uint64_t m_heap_allocations;
+  uint64_t m_blocks_discarded;
+
+  // Protects the fields below.
+  ola::thread::Mutex m_mutex;
+  std::vector<Magazine*> m_full_magazines;
+  std::vector<Magazine*> m_empty_magazines;
+  std::set<ThreadCache*> m_caches;
+
+  ThreadCache *GetThreadCache();
+  Magazine *NewMagazine();
+  void DeleteBlocks(Magazine *magazine, unsigned int remaining);
+  void DeleteBlock(MemoryBlock *block);
+
+  static void FlushThreadCache(void *data);
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadSafeMemoryBlockPool);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // INCLUDE_OLA_IO_THREADSAFEMEMORYBLOCKPOOL_H_
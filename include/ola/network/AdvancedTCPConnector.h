@@ -28,7 +28,9 @@
 #include <ola/network/TCPConnector.h>
 #include <ola/network/TCPSocketFactory.h>
 #include <ola/util/Backoff.h>
+#include <deque>
 #include <map>
+#include <set>
 #include <utility>
 
 namespace ola {
@@ -40,22 +42,74 @@ namespace network {
  * The AdvancedTCPConnector attempts to open connections to a endpoint. If
  * the connection fails it will retry according to a given BackOffPolicy.
  *
+ * All the retries share a single timer. The backoff times can be randomized
+ * and the number of connects in progress can be limited, so that when many
+ * endpoints fail at once (e.g. a switch reboots) they don't all reconnect at
+ * the same instant. Endpoints which are waiting for a free connect slot are
+ * served in order, with hot endpoints going first.
+ *
  * Limitations:
  *  - This class only supports a single connection per IP:Port.
- *  - This class should work fine for a small number of TCP connections (100 or
- *    so). It'll need to be re-written if we want to support 1000s.
  */
 class AdvancedTCPConnector {
  public:
+  /**
+   * @brief Options for the AdvancedTCPConnector.
+   */
+  struct Options {
+    /**
+     * @brief The most connects that may be in progress at once, 0 means no
+     * limit.
+     */
+    unsigned int max_pending_connects;
+
+    /**
+     * @brief How much of each backoff time is randomized, as a percentage.
+     *
+     * A retry is scheduled between (100 - jitter_percent)% and 100% of the
+     * time given by the BackOffPolicy.
+     */
+    unsigned int jitter_percent;
+
+    Options()
+        : max_pending_connects(0),
+          jitter_percent(0) {
+    }
+  };
+
+  /**
+   * @brief Counters for the connects made by an AdvancedTCPConnector.
+   */
+  struct ConnectionStats {
+    unsigned int attempts;  /**< The number of connects started */
+    unsigned int successes;  /**< The number of connects that succeeded */
+    unsigned int failures;  /**< The number of connects that failed */
+    unsigned int pending;  /**< The number of connects in progress */
+    /**
+     * @brief The number of endpoints waiting for a connect slot.
+     */
+    unsigned int waiting;
+
+    ConnectionStats()
+        : attempts(0),
+          successes(0),
+          failures(0),
+          pending(0),
+          waiting(0) {
+    }
+  };
+
   /**
    * @brief Create a new AdvancedTCPConnector
    * @param ss the SelectServerInterface to use for scheduling
    * @param socket_factory the factory to use for creating new sockets
    * @param connection_timeout the timeout for TCP connects.
+   * @param options the Options to use.
    */
   AdvancedTCPConnector(ola::io::SelectServerInterface *ss,
                        TCPSocketFactoryInterface *socket_factory,
-                       const ola::TimeInterval &connection_timeout);
+                       const ola::TimeInterval &connection_timeout,
+                       const Options &options = Options());
 
   ~AdvancedTCPConnector();
 
@@ -120,30 +174,68 @@ class AdvancedTCPConnector {
    */
   void Resume(const IPV4SocketAddress &endpoint);
 
+  /**
+   * @brief Mark an endpoint as hot, or not.
+   *
+   * A hot endpoint is reconnected straight away when it's disconnected,
+   * rather than after the first backoff time, and it goes ahead of the other
+   * endpoints waiting for a connect slot.
+   * @param endpoint the IPV4SocketAddress to change.
+   * @param hot true if the endpoint is hot.
+   */
+  void SetHot(const IPV4SocketAddress &endpoint, bool hot);
+
+  /**
+   * @brief Get the counters for the connects made so far.
+   * @param[out] stats the ConnectionStats to populate.
+   */
+  void GetStats(ConnectionStats *stats) const;
+
  private:
+  typedef std::pair<IPV4Address, uint16_t> IPPortPair;
+
   typedef struct {
     ConnectionState state;
     unsigned int failed_attempts;
-    ola::thread::timeout_id retry_timeout;
+    // Set while the endpoint is in the retry queue.
+    TimeStamp retry_time;
     TCPConnector::TCPConnectionID connection_id;
     BackOffPolicy *policy;
     bool reconnect;
+    bool hot;
+    // True while the endpoint is waiting for a connect slot.
+    bool waiting;
   } ConnectionInfo;
 
-  typedef std::pair<IPV4Address, uint16_t> IPPortPair;
   typedef std::map<IPPortPair, ConnectionInfo*> ConnectionMap;
+  typedef std::set<std::pair<TimeStamp, IPPortPair> > RetryQueue;
 
   TCPSocketFactoryInterface *m_socket_factory;
   ola::io::SelectServerInterface *m_ss;
   TCPConnector m_connector;
   const ola::TimeInterval m_connection_timeout;
+  const Options m_options;
   ConnectionMap m_connections;
-
-  void ScheduleRetry(const IPPortPair &key, ConnectionInfo *info);
-  void RetryTimeout(IPPortPair key);
+  RetryQueue m_retry_queue;
+  ola::thread::timeout_id m_retry_timeout;
+  TimeStamp m_retry_timeout_time;
+  std::deque<IPPortPair> m_waiting;
+  ConnectionStats m_stats;
+  bool m_starting_connects;
+
+  void ScheduleRetry(const IPPortPair &key, ConnectionInfo *info,
+                     const TimeInterval &delay);
+  void CancelRetry(const IPPortPair &key, ConnectionInfo *info);
+  void UpdateRetryTimeout();
+  void RetryTimeout();
   void ConnectionResult(IPPortPair key, int fd, int error);
   void AttemptConnection(const IPPortPair &key, ConnectionInfo *state);
-  void AbortConnection(ConnectionInfo *state);
+  void StartConnection(const IPPortPair &key, ConnectionInfo *state);
+  void StartWaitingConnections();
+  bool HaveConnectSlot() const;
+  void AbortConnection(const IPPortPair &key, ConnectionInfo *state);
+  TimeInterval BackOffTime(const ConnectionInfo *info,
+                           unsigned int failed_attempts) const;
 
   DISALLOW_COPY_AND_ASSIGN(AdvancedTCPConnector);
 };
@@ -37,6 +37,13 @@
  *  - Some protocols may want to piggyback heartbeats on other messages, or
  *  even count any message as a heartbeat. When such a message is received, be
  *  sure to call HeartbeatReceived() which will update the timer.
+ *
+ * By default each connection registers its own timers, and the rx timer is
+ * re-registered for every heartbeat received. Servers with many connections
+ * should create a HeartbeatScheduler and pass it to the connections instead.
+ * Each connection then only records when the next heartbeat is due, and a
+ * single periodic sweep sends the heartbeats and checks the deadlines for all
+ * of them.
  */
 
 #ifndef INCLUDE_OLA_NETWORK_HEALTHCHECKEDCONNECTION_H_
@@ -46,10 +53,61 @@
 #include <ola/Clock.h>
 #include <ola/base/Macro.h>
 #include <ola/thread/SchedulerInterface.h>
+#include <set>
 
 namespace ola {
 namespace network {
 
+class HealthCheckedConnection;
+
+/**
+ * Runs the heartbeats for a group of HealthCheckedConnections from a single
+ * repeating timer. Heartbeats are sent, and timeouts detected, up to one
+ * sweep interval late.
+ *
+ * The HeartbeatScheduler must outlive the connections that use it.
+ */
+class HeartbeatScheduler {
+ public:
+    /**
+     * Create a new HeartbeatScheduler.
+     * @param scheduler the scheduler used to run the sweep.
+     * @param clock the clock to read the time from. This should be the same
+     *   clock the scheduler uses.
+     * @param sweep_interval_ms how often to check the connections.
+     */
+    HeartbeatScheduler(ola::thread::SchedulerInterface *scheduler,
+                       const ola::Clock *clock,
+                       unsigned int sweep_interval_ms =
+                         DEFAULT_SWEEP_INTERVAL_MS);
+    ~HeartbeatScheduler();
+
+    /**
+     * Return the number of connections using this scheduler.
+     */
+    unsigned int ConnectionCount() const { return m_connections.size(); }
+
+    static const unsigned int DEFAULT_SWEEP_INTERVAL_MS = 100;
+
+ private:
+    typedef std::set<HealthCheckedConnection*> ConnectionSet;
+
+    ola::thread::SchedulerInterface *m_scheduler;
+    const ola::Clock *m_clock;
+    const unsigned int m_sweep_interval_ms;
+    ola::thread::timeout_id m_sweep_timeout;
+    ConnectionSet m_connections;
+
+    void AddConnection(HealthCheckedConnection *connection);
+    void RemoveConnection(HealthCheckedConnection *connection);
+    void Now(TimeStamp *now) const { m_clock->CurrentMonotonicTime(now); }
+    bool Sweep();
+
+    friend class HealthCheckedConnection;
+
+    DISALLOW_COPY_AND_ASSIGN(HeartbeatScheduler);
+};
+
 /**
  * An class that provides health checking for a connection.
  * The subclasses implement the SendHeartbeat and HeartbeatTimeout methods.
@@ -58,6 +116,13 @@ class HealthCheckedConnection {
  public:
     HealthCheckedConnection(ola::thread::SchedulerInterface *scheduler,
                             const ola::TimeInterval timeout_interval);
+
+    /**
+     * Create a connection that uses a shared HeartbeatScheduler rather than
+     * its own timers.
+     */
+    HealthCheckedConnection(HeartbeatScheduler *heartbeat_scheduler,
+                            const ola::TimeInterval timeout_interval);
     virtual ~HealthCheckedConnection();
 
     /**
@@ -109,9 +174,18 @@ class HealthCheckedConnection {
     ola::thread::timeout_id m_send_timeout_id;
     ola::thread::timeout_id m_receive_timeout_id;
 
+    // Only used with a HeartbeatScheduler.
+    HeartbeatScheduler *m_heartbeat_scheduler;
+    ola::TimeStamp m_next_heartbeat;
+    ola::TimeStamp m_receive_deadline;
+    bool m_receive_paused;
+
     bool SendNextHeartbeat();
     void UpdateReceiveTimer();
     void InternalHeartbeatTimeout();
+    ola::TimeInterval ReceiveTimeout() const;
+
+    friend class HeartbeatScheduler;
 
     DISALLOW_COPY_AND_ASSIGN(HealthCheckedConnection);
 };
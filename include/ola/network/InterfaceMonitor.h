@@ -0,0 +1,97 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InterfaceMonitor.h
+ * Notifies listeners when the network interfaces on the system change.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_INTERFACEMONITOR_H_
+#define INCLUDE_OLA_NETWORK_INTERFACEMONITOR_H_
+
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <memory>
+#include <set>
+
+namespace ola {
+namespace network {
+
+/**
+ * @addtogroup network
+ * @{
+ */
+
+/**
+ * @brief Watches for interfaces being added, removed or re-addressed.
+ *
+ * The kernel reports changes on a netlink socket. Changes usually arrive in
+ * bursts (link up, then the address, then the routes), so the listeners are
+ * run once, after the interfaces have been quiet for a short time.
+ *
+ * Once a listener has run, InterfacePicker::GetInterfaces() returns the new
+ * interface table.
+ */
+class InterfaceMonitor {
+ public:
+  /**
+   * @brief Create a new InterfaceMonitor.
+   * @param ss the SelectServer to use to watch for changes.
+   */
+  explicit InterfaceMonitor(ola::io::SelectServerInterface *ss);
+  ~InterfaceMonitor();
+
+  /**
+   * @brief Start watching for changes.
+   * @returns false if this platform doesn't report interface changes.
+   */
+  bool Init();
+
+  /**
+   * @brief Add a listener to be run when the interfaces change.
+   * @param listener the callback to run, ownership is not transferred.
+   */
+  void AddListener(Callback0<void> *listener);
+
+  /**
+   * @brief Remove a previously added listener.
+   * @param listener the callback to remove.
+   */
+  void RemoveListener(Callback0<void> *listener);
+
+  static const unsigned int SETTLE_TIME_MS;
+
+ private:
+  typedef std::set<Callback0<void>*> ListenerSet;
+
+  ola::io::SelectServerInterface *m_ss;
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_descriptor;
+  ola::thread::timeout_id m_settle_timeout;
+  ListenerSet m_listeners;
+
+  void EventsReady();
+  void RunListeners();
+
+  DISALLOW_COPY_AND_ASSIGN(InterfaceMonitor);
+};
+/**
+ * @}
+ */
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_INTERFACEMONITOR_H_
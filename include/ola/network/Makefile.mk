@@ -5,6 +5,7 @@ olanetworkinclude_HEADERS = \
     include/ola/network/IPV4Address.h \
     include/ola/network/IPV6Address.h \
     include/ola/network/Interface.h \
+    include/ola/network/InterfaceMonitor.h \
     include/ola/network/InterfacePicker.h \
     include/ola/network/MACAddress.h \
     include/ola/network/NetworkUtils.h \
@@ -13,4 +14,8 @@ olanetworkinclude_HEADERS = \
     include/ola/network/SocketCloser.h \
     include/ola/network/TCPConnector.h \
     include/ola/network/TCPSocket.h \
-    include/ola/network/TCPSocketFactory.h
+    include/ola/network/TCPSocketFactory.h \
+    include/ola/network/TransmitPacer.h \
+    include/ola/network/UDPPacketBuilder.h \
+    include/ola/network/UnixDomainSocket.h \
+    include/ola/network/WireLayout.h
@@ -30,15 +30,62 @@
 #include <ola/network/SocketAddress.h>
 
 #include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/base/Macro.h>
 #include <ola/io/Descriptor.h>
 #include <ola/io/IOQueue.h>
+#include <ola/io/IOVecInterface.h>
 #include <ola/network/IPV4Address.h>
 #include <string>
 
 namespace ola {
 namespace network {
 
+/**
+ * @brief A datagram used with the batched send & receive methods.
+ */
+struct UDPDatagram {
+  UDPDatagram()
+      : iov(NULL),
+        iov_count(0) {
+  }
+
+  /**
+   * @brief The datagram's data.
+   *
+   * When receiving, iov_len is the size of the buffer and is updated with the
+   * size of the datagram.
+   */
+  ola::io::IOVec buffer;
+
+  /**
+   * @brief When sending, if this is set the datagram is gathered from these
+   * blocks, and buffer is ignored. This isn't used when receiving.
+   */
+  const ola::io::IOVec *iov;
+
+  /**
+   * @brief The number of blocks in iov.
+   */
+  unsigned int iov_count;
+
+  /**
+   * @brief The source of the datagram when receiving, or the destination when
+   * sending.
+   */
+  IPV4SocketAddress address;
+
+  /**
+   * @brief When receiving, the time the kernel received the datagram, using
+   * the monotonic clock.
+   *
+   * This is only set if receive timestamps have been enabled with
+   * EnableReceiveTimestamps() and the platform supports them.
+   */
+  TimeStamp timestamp;
+};
+
+
 /**
  * @brief The interface for UDPSockets.
  *
@@ -135,6 +182,20 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
   virtual ssize_t SendTo(ola::io::IOVecInterface *data,
                          const IPV4SocketAddress &dest) const = 0;
 
+  /**
+   * @brief Send a datagram gathered from a number of blocks.
+   * @param iov the blocks to send.
+   * @param iov_count the number of blocks.
+   * @param dest the destination to send to.
+   * @return the number of bytes sent.
+   *
+   * The blocks are sent as a single datagram, using sendmsg() where it's
+   * available, so they don't need to be copied into a single buffer first.
+   */
+  virtual ssize_t SendTo(const ola::io::IOVec *iov,
+                         unsigned int iov_count,
+                         const IPV4SocketAddress &dest) const = 0;
+
   /**
    * @brief Receive data
    * @param buffer the buffer to store the data
@@ -188,6 +249,30 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
                         ssize_t *data_read,
                         IPV4SocketAddress *source) = 0;
 
+  /**
+   * @brief Receive up to count datagrams without blocking.
+   * @param datagrams an array of datagrams to fill. The buffer of each must
+   *   point to the caller supplied memory.
+   * @param count the number of datagrams in the array.
+   * @returns the number of datagrams received, which may be 0.
+   *
+   * This uses recvmmsg() where it's available, so a socket can be drained
+   * with a single system call.
+   */
+  virtual unsigned int RecvMultiple(UDPDatagram *datagrams,
+                                    unsigned int count) = 0;
+
+  /**
+   * @brief Send a number of datagrams.
+   * @param datagrams the datagrams to send.
+   * @param count the number of datagrams in the array.
+   * @returns the number of datagrams sent.
+   *
+   * This uses sendmmsg() where it's available.
+   */
+  virtual unsigned int SendMultiple(const UDPDatagram *datagrams,
+                                    unsigned int count) const = 0;
+
   /**
    * @brief Enable broadcasting for this socket.
    * @return true if it worked, false otherwise
@@ -227,6 +312,16 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
    */
   virtual bool SetTos(uint8_t tos) = 0;
 
+  /**
+   * @brief Record the time each datagram is received by the kernel.
+   * @return true if it worked, false otherwise or if the platform doesn't
+   *   support this.
+   *
+   * Once this is enabled RecvMultiple() sets the timestamp of each
+   * UDPDatagram.
+   */
+  virtual bool EnableReceiveTimestamps() = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(UDPSocketInterface);
 };
@@ -240,7 +335,8 @@ class UDPSocket: public UDPSocketInterface {
   UDPSocket()
       : UDPSocketInterface(),
         m_handle(ola::io::INVALID_DESCRIPTOR),
-        m_bound_to_port(false) {}
+        m_bound_to_port(false),
+        m_receive_timestamps(false) {}
   ~UDPSocket() { Close(); }
   bool Init();
   bool Bind(const IPV4SocketAddress &endpoint);
@@ -262,6 +358,9 @@ class UDPSocket: public UDPSocketInterface {
                  unsigned short port) const;
   ssize_t SendTo(ola::io::IOVecInterface *data,
                  const IPV4SocketAddress &dest) const;
+  ssize_t SendTo(const ola::io::IOVec *iov,
+                 unsigned int iov_count,
+                 const IPV4SocketAddress &dest) const;
 
   bool RecvFrom(uint8_t *buffer, ssize_t *data_read) const;
   bool RecvFrom(uint8_t *buffer,
@@ -276,6 +375,10 @@ class UDPSocket: public UDPSocketInterface {
                 ssize_t *data_read,
                 IPV4SocketAddress *source);
 
+  unsigned int RecvMultiple(UDPDatagram *datagrams, unsigned int count);
+  unsigned int SendMultiple(const UDPDatagram *datagrams,
+                            unsigned int count) const;
+
   bool EnableBroadcast();
   bool SetMulticastInterface(const IPV4Address &iface);
   bool JoinMulticast(const IPV4Address &iface,
@@ -285,10 +388,77 @@ class UDPSocket: public UDPSocketInterface {
                       const IPV4Address &group);
 
   bool SetTos(uint8_t tos);
+  bool EnableReceiveTimestamps();
+
+  /**
+   * @brief Control if this socket receives multicast data for groups that
+   *   only other sockets have joined.
+   * @param enable false to only receive data for the groups this socket has
+   *   joined.
+   * @return true if it worked, false otherwise or if the platform doesn't
+   *   support this.
+   *
+   * On Linux a socket bound to the wildcard address receives the data for
+   * every group joined on the host, which defeats spreading groups across
+   * sockets.
+   */
+  bool SetMulticastAll(bool enable);
+
+  /**
+   * @brief Join a multicast group, only receiving data from one source.
+   * @param iface the address of the interface to use.
+   * @param group the address of the group to join.
+   * @param source the address of the source to receive from.
+   * @param multicast_loop enable multicast loop
+   * @return true if it worked, false otherwise or if the platform doesn't
+   *   support source specific multicast.
+   *
+   * This can be called for each source that should be received. The sources
+   * are filtered by the kernel, and with IGMPv3 snooping by the switches, so
+   * data from other sources never reaches the socket. A group can't be
+   * joined with both JoinMulticast() and JoinMulticastSource() on the same
+   * socket.
+   */
+  bool JoinMulticastSource(const IPV4Address &iface,
+                           const IPV4Address &group,
+                           const IPV4Address &source,
+                           bool multicast_loop = false);
+
+  /**
+   * @brief Stop receiving data from a source joined with
+   *   JoinMulticastSource().
+   * @param iface the address of the interface to use.
+   * @param group the address of the group.
+   * @param source the address of the source.
+   * @return true if it worked, false otherwise. The group is left once the
+   *   last source has been removed.
+   */
+  bool LeaveMulticastSource(const IPV4Address &iface,
+                            const IPV4Address &group,
+                            const IPV4Address &source);
+
+  /**
+   * @brief Get the number of datagrams the kernel has dropped because the
+   *   receive buffer for this socket was full.
+   * @param[out] drops the number of dropped datagrams.
+   * @return true if it worked, false otherwise or if the platform doesn't
+   *   support this.
+   */
+  bool ReceiveDropCount(uint32_t *drops) const;
 
  private:
   ola::io::DescriptorHandle m_handle;
   bool m_bound_to_port;
+  bool m_receive_timestamps;
+
+  bool SetSourceMembership(int option,
+                           const IPV4Address &iface,
+                           const IPV4Address &group,
+                           const IPV4Address &source);
+
+  // The maximum number of datagrams passed to a single recvmmsg() or
+  // sendmmsg() call.
+  static const unsigned int MAX_BATCH_SIZE = 64;
 
   DISALLOW_COPY_AND_ASSIGN(UDPSocket);
 };
@@ -0,0 +1,205 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TransmitPacer.h
+ * Spreads bursts of UDP packets out over time.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_TRANSMITPACER_H_
+#define INCLUDE_OLA_NETWORK_TRANSMITPACER_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/Socket.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace network {
+
+/**
+ * @brief Spreads bursts of UDP packets out over time.
+ *
+ * When a large number of universes are sent at once, all the packets leave
+ * the host back to back. On a busy network these microbursts can overflow
+ * the buffers in switches and cheap nodes, and packets are lost.
+ *
+ * The pacer queues the packets for each interface and drains the queues from
+ * a timer that fires every millisecond. The packets queued for an interface
+ * are spread evenly so that they have all been sent by the end of the window,
+ * and an optional rate limit caps the number of bytes sent per second on
+ * each interface. Consecutive packets for the same socket are sent with a
+ * single SendMultiple() call.
+ *
+ * The packets for each interface are sent in the order they were queued, so
+ * a sync packet queued after the data for a frame is sent after the data.
+ *
+ * This isn't thread safe, it must be used from the thread that runs the
+ * scheduler.
+ */
+class TransmitPacer {
+ public:
+  struct Options {
+    Options()
+        : window(0),
+          rate_limit(0),
+          max_queue_depth(DEFAULT_MAX_QUEUE_DEPTH),
+          export_map(NULL) {
+    }
+
+    /**
+     * @brief The time to spread the packets queued for an interface over.
+     */
+    TimeInterval window;
+
+    /**
+     * @brief The maximum number of bytes per second to send on each
+     * interface, 0 means no limit.
+     */
+    unsigned int rate_limit;
+
+    /**
+     * @brief The number of packets that can be queued for an interface. Once
+     * this is reached the oldest packets are dropped.
+     */
+    unsigned int max_queue_depth;
+
+    /**
+     * @brief If set, the pacer's statistics are exported here.
+     */
+    ExportMap *export_map;
+  };
+
+  /**
+   * @brief Create a new TransmitPacer.
+   * @param scheduler the scheduler to use for the transmit timer.
+   * @param clock the clock to use.
+   * @param options the Options for the pacer.
+   */
+  TransmitPacer(ola::thread::SchedulerInterface *scheduler,
+                const Clock *clock,
+                const Options &options);
+  ~TransmitPacer();
+
+  /**
+   * @brief Queue datagrams for transmission.
+   * @param socket the socket to send the datagrams on.
+   * @param iface the address of the interface the socket sends on, packets
+   *   are paced per interface.
+   * @param datagrams the datagrams to send. The data is copied so it doesn't
+   *   need to remain valid once this returns.
+   * @param count the number of datagrams.
+   */
+  void Send(const UDPSocketInterface *socket,
+            const IPV4Address &iface,
+            const UDPDatagram *datagrams,
+            unsigned int count);
+
+  /**
+   * @brief Immediately send any packets queued for a socket.
+   *
+   * This must be called before a socket that has been passed to Send() is
+   * closed or deleted.
+   */
+  void Flush(const UDPSocketInterface *socket);
+
+  /**
+   * @brief The number of packets waiting to be sent.
+   */
+  unsigned int QueueDepth() const;
+
+  /**
+   * @brief The number of packets that have been sent.
+   */
+  unsigned int PacketsSent() const { return m_packets_sent; }
+
+  /**
+   * @brief The number of packets dropped because a queue was full.
+   */
+  unsigned int PacketsDropped() const { return m_packets_dropped; }
+
+  /**
+   * @brief The time the last packet sent was queued for.
+   */
+  TimeInterval LastLatency() const { return m_last_latency; }
+
+  /**
+   * @brief The interval between transmit timer events.
+   */
+  static const TimeInterval TICK;
+
+  static const unsigned int DEFAULT_MAX_QUEUE_DEPTH = 4096;
+
+ private:
+  struct QueuedPacket {
+    const UDPSocketInterface *socket;
+    IPV4SocketAddress destination;
+    std::string data;
+    TimeStamp queued;
+  };
+
+  struct InterfaceQueue {
+    std::deque<QueuedPacket> packets;
+    TimeStamp deadline;
+    // The token bucket used for the rate limit, this may go negative.
+    int64_t tokens;
+    TimeStamp last_refill;
+  };
+
+  typedef std::map<IPV4Address, InterfaceQueue*> InterfaceQueues;
+
+  ola::thread::SchedulerInterface *m_scheduler;
+  const Clock *m_clock;
+  const TimeInterval m_window;
+  const unsigned int m_rate_limit;
+  const unsigned int m_max_queue_depth;
+  const int64_t m_bucket_size;
+  InterfaceQueues m_queues;
+  std::vector<UDPDatagram> m_datagrams;
+  ola::thread::timeout_id m_timeout_id;
+  unsigned int m_packets_sent;
+  unsigned int m_packets_dropped;
+  TimeInterval m_last_latency;
+  IntegerVariable *m_queue_depth_var;
+  CounterVariable *m_sent_var;
+  CounterVariable *m_dropped_var;
+  IntegerVariable *m_latency_var;
+
+  bool Tick();
+  void Refill(InterfaceQueue *queue, const TimeStamp &now);
+  void SendFromQueue(InterfaceQueue *queue, unsigned int quota,
+                     const TimeStamp &now);
+  void SendPackets(const std::deque<QueuedPacket> &packets,
+                   unsigned int count,
+                   const TimeStamp &now);
+  void UpdateQueueDepth();
+
+  static const unsigned int MAX_BATCH_SIZE = 32;
+  static const unsigned int MIN_BUCKET_SIZE = 1500;
+
+  DISALLOW_COPY_AND_ASSIGN(TransmitPacer);
+};
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_TRANSMITPACER_H_
@@ -0,0 +1,149 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UDPPacketBuilder.h
+ * Builds a UDP packet from blocks of memory, without copying them.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_UDPPACKETBUILDER_H_
+#define INCLUDE_OLA_NETWORK_UDPPACKETBUILDER_H_
+
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/io/IOVecInterface.h>
+#include <ola/network/Socket.h>
+#include <ola/network/SocketAddress.h>
+#include <stdint.h>
+
+namespace ola {
+namespace network {
+
+/**
+ * @brief Builds a UDP packet from blocks of memory, without copying them.
+ *
+ * Protocol nodes usually pack the header into a struct and the DMX data is
+ * referenced where it is, so the DMX data isn't copied before it's sent. The
+ * packet is sent with a single sendmsg() call.
+ *
+ * The blocks are not copied, so they must remain valid until the packet has
+ * been sent.
+ *
+ * @examplepara
+ * @code
+ *   UDPPacketBuilder packet;
+ *   packet.Append(&header, sizeof(header));
+ *   packet.AppendDMX(buffer);
+ *   packet.AppendPadding(1);
+ *   packet.SendTo(socket, destination);
+ * @endcode
+ */
+class UDPPacketBuilder {
+ public:
+  UDPPacketBuilder()
+      : m_block_count(0),
+        m_size(0) {
+  }
+
+  /**
+   * @brief Remove all the blocks.
+   */
+  void Clear() {
+    m_block_count = 0;
+    m_size = 0;
+  }
+
+  /**
+   * @brief Append a block of memory.
+   * @param data the data to append, this isn't copied.
+   * @param length the length of the data.
+   * @returns false if there are already MAX_BLOCKS blocks.
+   */
+  bool Append(const void *data, unsigned int length);
+
+  /**
+   * @brief Append the data from a DmxBuffer.
+   * @param buffer the DmxBuffer, it must not be modified until the packet
+   *   has been sent.
+   * @returns false if there are already MAX_BLOCKS blocks.
+   */
+  bool AppendDMX(const DmxBuffer &buffer) {
+    return Append(buffer.GetRaw(), buffer.Size());
+  }
+
+  /**
+   * @brief Append zeros.
+   * @param length the number of zeros, at most MAX_PADDING.
+   * @returns false if there are already MAX_BLOCKS blocks, or the length is
+   *   too large.
+   */
+  bool AppendPadding(unsigned int length);
+
+  /**
+   * @brief The size of the packet.
+   */
+  unsigned int Size() const { return m_size; }
+
+  /**
+   * @brief The blocks, suitable for sendmsg().
+   */
+  const ola::io::IOVec *Blocks() const { return m_blocks; }
+
+  /**
+   * @brief The number of blocks.
+   */
+  unsigned int BlockCount() const { return m_block_count; }
+
+  /**
+   * @brief Fill in a UDPDatagram to send this packet with SendMultiple().
+   * @param destination the destination of the packet.
+   * @param[out] datagram the datagram to fill in.
+   */
+  void ToDatagram(const IPV4SocketAddress &destination,
+                  UDPDatagram *datagram) const {
+    datagram->iov = m_blocks;
+    datagram->iov_count = m_block_count;
+    datagram->address = destination;
+  }
+
+  /**
+   * @brief Send the packet.
+   * @param socket the socket to send on.
+   * @param destination the destination of the packet.
+   * @returns true if the entire packet was sent, false otherwise.
+   */
+  bool SendTo(const UDPSocketInterface *socket,
+              const IPV4SocketAddress &destination) const;
+
+  /**
+   * @brief The maximum number of blocks in a packet.
+   */
+  static const unsigned int MAX_BLOCKS = 8;
+
+  /**
+   * @brief The largest amount of padding that can be added at once.
+   */
+  static const unsigned int MAX_PADDING = 512;
+
+ private:
+  ola::io::IOVec m_blocks[MAX_BLOCKS];
+  unsigned int m_block_count;
+  unsigned int m_size;
+
+  DISALLOW_COPY_AND_ASSIGN(UDPPacketBuilder);
+};
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_UDPPACKETBUILDER_H_
@@ -0,0 +1,99 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UnixDomainSocket.h
+ * Stream sockets for clients on the same host.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * UnixDomainSocket represents a connection to a named unix domain socket,
+ * UnixDomainAcceptingSocket listens for new connections.
+ *
+ * Paths that start with '@' are in the Linux abstract namespace, they don't
+ * appear in the filesystem and are removed when the listening socket is
+ * closed.
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_UNIXDOMAINSOCKET_H_
+#define INCLUDE_OLA_NETWORK_UNIXDOMAINSOCKET_H_
+
+#include <sys/types.h>
+
+#include <ola/base/Credentials.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <ola/network/TCPSocketFactory.h>
+
+#include <string>
+
+namespace ola {
+namespace network {
+
+/*
+ * A connected unix domain stream socket.
+ */
+class UnixDomainSocket: public ola::io::ConnectedDescriptor {
+ public:
+  explicit UnixDomainSocket(int sd);
+
+  ~UnixDomainSocket() { Close(); }
+
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_handle; }
+  ola::io::DescriptorHandle WriteDescriptor() const { return m_handle; }
+  bool Close();
+
+  /*
+   * Get the credentials of the process at the other end of the socket, these
+   * are the credentials at the time the connection was made.
+   */
+  bool GetPeerCredentials(uid_t *uid, gid_t *gid) const;
+
+  static UnixDomainSocket* Connect(const std::string &path);
+
+ protected:
+  bool IsSocket() const { return true; }
+
+ private:
+  ola::io::DescriptorHandle m_handle;
+
+  DISALLOW_COPY_AND_ASSIGN(UnixDomainSocket);
+};
+
+
+/*
+ * A unix domain accepting socket. New connections are passed to the factory.
+ */
+class UnixDomainAcceptingSocket: public ola::io::ReadFileDescriptor {
+ public:
+  explicit UnixDomainAcceptingSocket(class TCPSocketFactoryInterface *factory);
+  ~UnixDomainAcceptingSocket();
+  bool Listen(const std::string &path, int backlog = 10);
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_handle; }
+  bool Close();
+  void PerformRead();
+
+  const std::string& Path() const { return m_path; }
+
+ private:
+  ola::io::DescriptorHandle m_handle;
+  class TCPSocketFactoryInterface *m_factory;
+  std::string m_path;
+
+  DISALLOW_COPY_AND_ASSIGN(UnixDomainAcceptingSocket);
+};
+
+typedef GenericTCPSocketFactory<UnixDomainSocket> UnixDomainSocketFactory;
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_UNIXDOMAINSOCKET_H_
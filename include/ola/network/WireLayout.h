@@ -0,0 +1,128 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ * WireLayout.h
+ * Endian tagged fields & layout checks for packed protocol structs.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_WIRELAYOUT_H_
+#define INCLUDE_OLA_NETWORK_WIRELAYOUT_H_
+
+#include <ola/base/Macro.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ola {
+namespace network {
+
+/**
+ * @brief A big endian (network byte order) field in a packed protocol struct.
+ *
+ * The value is stored as bytes, so the field has an alignment of 1 and can be
+ * read & written wherever it sits in a PACKed struct. The byte order is part
+ * of the type, so a value can't be sent without being converted, or be
+ * converted twice.
+ *
+ * This has no constructors, so it can be used in the unions the plugins use
+ * for their packets.
+ *
+ * @examplepara
+ * @code
+ *   PACK(
+ *   struct header_s {
+ *     BigEndian<uint16_t> version;
+ *     LittleEndian<uint16_t> op_code;
+ *   });
+ *
+ *   header.version.Set(14);
+ *   if (header.version.Get() != 14) { ... }
+ * @endcode
+ */
+template <typename T>
+struct BigEndian {
+  uint8_t bytes[sizeof(T)];
+
+  /**
+   * @brief Return the value in host byte order.
+   */
+  T Get() const {
+    T value = 0;
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+      value = static_cast<T>((value << 8) | bytes[i]);
+    }
+    return value;
+  }
+
+  /**
+   * @brief Set the value.
+   * @param value the value, in host byte order.
+   */
+  void Set(T value) {
+    for (unsigned int i = sizeof(T); i > 0; i--) {
+      bytes[i - 1] = static_cast<uint8_t>(value & 0xff);
+      value = static_cast<T>(value >> 8);
+    }
+  }
+};
+
+/**
+ * @brief A little endian field in a packed protocol struct.
+ * @sa BigEndian
+ */
+template <typename T>
+struct LittleEndian {
+  uint8_t bytes[sizeof(T)];
+
+  /**
+   * @brief Return the value in host byte order.
+   */
+  T Get() const {
+    T value = 0;
+    for (unsigned int i = sizeof(T); i > 0; i--) {
+      value = static_cast<T>((value << 8) | bytes[i - 1]);
+    }
+    return value;
+  }
+
+  /**
+   * @brief Set the value.
+   * @param value the value, in host byte order.
+   */
+  void Set(T value) {
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+      bytes[i] = static_cast<uint8_t>(value & 0xff);
+      value = static_cast<T>(value >> 8);
+    }
+  }
+};
+
+/**
+ * @brief Check at compile time that a packet struct is the size the protocol
+ *   says it is.
+ *
+ * A struct that isn't packed, or a field with the wrong type, breaks the
+ * build rather than the packets on the wire.
+ */
+#define WIRE_SIZE_ASSERT(type, size) STATIC_ASSERT(sizeof(type) == (size))
+
+/**
+ * @brief Check at compile time that a field is at the offset the protocol
+ *   says it is.
+ */
+#define WIRE_OFFSET_ASSERT(type, field, offset) \
+  STATIC_ASSERT(offsetof(type, field) == (offset))
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_WIRELAYOUT_H_
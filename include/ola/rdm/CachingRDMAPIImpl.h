@@ -0,0 +1,244 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CachingRDMAPIImpl.h
+ * An RDMAPIImplInterface that caches responses for static parameters.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup rdm_api
+ * @{
+ * @file CachingRDMAPIImpl.h
+ * @brief An RDMAPIImplInterface that caches responses for static parameters.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_RDM_CACHINGRDMAPIIMPL_H_
+#define INCLUDE_OLA_RDM_CACHINGRDMAPIIMPL_H_
+
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <ola/rdm/RDMAPIImplInterface.h>
+#include <ola/rdm/UID.h>
+#include <ola/thread/ExecutorInterface.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @addtogroup rdm_api
+ * @{
+ */
+
+/**
+ * @brief Caches the GET responses for parameters that rarely change.
+ *
+ * This wraps another RDMAPIImplInterface. GETs for PIDs with a TTL are
+ * answered from the cache while the response is fresh, and concurrent GETs
+ * for the same parameter share a single request. Everything else is passed
+ * through.
+ *
+ * Only ACKs are cached. The cached responses for a UID are dropped when:
+ *  - a SET is sent to the UID,
+ *  - a response from the UID indicates it has queued messages,
+ *  - QUEUED_MESSAGE or STATUS_MESSAGES is requested from the UID, or
+ *  - Invalidate() is called, which should be done after discovery.
+ *
+ * Responses from the cache are delivered using the executor, so callbacks
+ * are never run from within RDMGet(). Since the cache is an
+ * RDMAPIImplInterface, several RDMAPI objects can share it.
+ *
+ * This class isn't thread safe, all calls and responses should happen on
+ * the executor's thread.
+ */
+class CachingRDMAPIImpl: public RDMAPIImplInterface {
+ public:
+  /**
+   * @brief Create a new CachingRDMAPIImpl.
+   * @param impl the RDMAPIImplInterface to send requests with. Ownership is
+   *   not transferred.
+   * @param executor used to run callbacks for cached responses.
+   * @param clock the clock to use, or NULL to use a new Clock.
+   */
+  CachingRDMAPIImpl(RDMAPIImplInterface *impl,
+                    ola::thread::ExecutorInterface *executor,
+                    Clock *clock = NULL);
+  ~CachingRDMAPIImpl();
+
+  bool RDMGet(rdm_callback *callback,
+              unsigned int universe,
+              const UID &uid,
+              uint16_t sub_device,
+              uint16_t pid,
+              const uint8_t *data = NULL,
+              unsigned int data_length = 0);
+
+  bool RDMGet(rdm_pid_callback *callback,
+              unsigned int universe,
+              const UID &uid,
+              uint16_t sub_device,
+              uint16_t pid,
+              const uint8_t *data = NULL,
+              unsigned int data_length = 0);
+
+  bool RDMSet(rdm_callback *callback,
+              unsigned int universe,
+              const UID &uid,
+              uint16_t sub_device,
+              uint16_t pid,
+              const uint8_t *data = NULL,
+              unsigned int data_length = 0);
+
+  /**
+   * @brief Set how long to cache the responses for a PID.
+   * @param pid the PID.
+   * @param ttl the time to cache responses for, a zero interval disables
+   *   caching for the PID.
+   */
+  void SetTTL(uint16_t pid, const TimeInterval &ttl);
+
+  /**
+   * @brief Drop all cached responses from a UID.
+   */
+  void Invalidate(unsigned int universe, const UID &uid);
+
+  /**
+   * @brief Drop all cached responses for a universe.
+   */
+  void Invalidate(unsigned int universe);
+
+  /**
+   * @brief Drop all cached responses.
+   */
+  void InvalidateAll();
+
+  /**
+   * @brief The number of responses in the cache.
+   */
+  unsigned int Size() const { return m_cache.size(); }
+
+  /**
+   * @brief The number of GETs answered from the cache.
+   */
+  unsigned int Hits() const { return m_hits; }
+
+  /**
+   * @brief The number of GETs that were sent on.
+   */
+  unsigned int Misses() const { return m_misses; }
+
+  /**
+   * @brief The number of GETs that shared a request already in flight.
+   */
+  unsigned int Coalesced() const { return m_coalesced; }
+
+  /**
+   * @brief The default TTL for parameters that don't change.
+   */
+  static const TimeInterval STATIC_PARAMETER_TTL;
+
+  /**
+   * @brief The default TTL for parameters that may be changed by other
+   * controllers.
+   */
+  static const TimeInterval SETTABLE_PARAMETER_TTL;
+
+ private:
+  struct RequestKey {
+    unsigned int universe;
+    UID uid;
+    uint16_t sub_device;
+    uint16_t pid;
+    std::string data;
+
+    RequestKey(unsigned int universe, const UID &uid, uint16_t sub_device,
+               uint16_t pid, const uint8_t *data, unsigned int data_length);
+
+    bool operator<(const RequestKey &other) const;
+  };
+
+  // Exactly one of the callbacks is set.
+  struct Waiter {
+    rdm_callback *callback;
+    rdm_pid_callback *pid_callback;
+
+    Waiter() : callback(NULL), pid_callback(NULL) {}
+    void Run(const ResponseStatus &status, uint16_t pid,
+             const std::string &data) const;
+    void Delete() const;
+  };
+
+  struct PendingRequest {
+    std::vector<Waiter> waiters;
+    // Set if the cache was invalidated while the request was in flight.
+    bool invalidated;
+
+    PendingRequest() : invalidated(false) {}
+  };
+
+  struct CacheEntry {
+    ResponseStatus status;
+    std::string data;
+    TimeStamp expiry;
+  };
+
+  typedef std::map<RequestKey, CacheEntry> Cache;
+  typedef std::map<RequestKey, PendingRequest*> PendingMap;
+  typedef std::map<uint16_t, TimeInterval> TTLMap;
+
+  RDMAPIImplInterface *m_impl;
+  ola::thread::ExecutorInterface *m_executor;
+  Clock *m_clock;
+  std::auto_ptr<Clock> m_our_clock;
+  Cache m_cache;
+  PendingMap m_pending;
+  TTLMap m_ttls;
+  unsigned int m_hits;
+  unsigned int m_misses;
+  unsigned int m_coalesced;
+
+  bool Get(const Waiter &waiter, unsigned int universe, const UID &uid,
+           uint16_t sub_device, uint16_t pid, const uint8_t *data,
+           unsigned int data_length);
+  void HandleGetResponse(RequestKey key, const ResponseStatus &status,
+                         uint16_t pid, const std::string &data);
+  void HandleResponse(unsigned int universe, UID uid, rdm_callback *callback,
+                      const ResponseStatus &status, const std::string &data);
+  void HandleResponseWithPid(unsigned int universe, UID uid,
+                             rdm_pid_callback *callback,
+                             const ResponseStatus &status,
+                             uint16_t pid,
+                             const std::string &data);
+  void InvalidateIf(const unsigned int *universe, const UID *uid);
+  void Store(const RequestKey &key, const ResponseStatus &status,
+             const std::string &data);
+
+  static void RunCachedResponse(Waiter waiter, ResponseStatus status,
+                                uint16_t pid, std::string data);
+
+  static const unsigned int MAX_ENTRIES;
+
+  DISALLOW_COPY_AND_ASSIGN(CachingRDMAPIImpl);
+};
+/**@}*/
+}  // namespace rdm
+}  // namespace ola
+#endif  // INCLUDE_OLA_RDM_CACHINGRDMAPIIMPL_H_
@@ -36,6 +36,7 @@
 #include <queue>
 #include <stack>
 #include <utility>
+#include <vector>
 
 namespace ola {
 namespace rdm {
@@ -131,6 +132,12 @@ class DiscoveryTargetInterface {
  * MAX_MUTE_ATTEMPTS times) and branches that contain responders which continue
  * to respond once muted. The latter causes a branch to be marked as corrupt,
  * which prevents us from looping forever.
+ *
+ * Full discovery uses the UIDs found by the previous run to skip DUBs that
+ * are certain to collide. If a branch contains more than one previously
+ * discovered UID, it's split straight away rather than sending the DUB. If
+ * some of those responders have since gone, the halves are still searched so
+ * nothing is missed.
  */
 class DiscoveryAgent {
  public:
@@ -148,6 +155,41 @@ class DiscoveryAgent {
   typedef ola::SingleUseCallback2<void, bool, const UIDSet&>
     DiscoveryCompleteCallback;
 
+  /**
+   * @brief The progress of the current discovery operation.
+   */
+  struct DiscoveryProgress {
+    DiscoveryProgress()
+        : incremental(false),
+          uids_found(0),
+          uids_to_mute(0),
+          branches_sent(0),
+          branches_split(0),
+          branches_skipped(0) {
+    }
+
+    bool incremental;  // true if this is incremental discovery
+    unsigned int uids_found;  // responders found or confirmed so far
+    unsigned int uids_to_mute;  // previously discovered UIDs still to mute
+    unsigned int branches_sent;  // the number of DUB requests sent
+    unsigned int branches_split;  // the number of times a branch was split
+    // The number of DUBs skipped because they would have collided.
+    unsigned int branches_skipped;
+  };
+
+  /**
+   * @brief The callback run as discovery progresses.
+   */
+  typedef ola::Callback1<void, const DiscoveryProgress&>
+    DiscoveryProgressCallback;
+
+  /**
+   * @brief Set the callback run as discovery progresses.
+   * @param callback the callback to run after each mute and DUB, ownership
+   *   is transferred. May be NULL.
+   */
+  void SetProgressCallback(DiscoveryProgressCallback *callback);
+
   /**
    * @brief Cancel any in-progress discovery operation.
    * If a discovery operation is running, this will result in the callback
@@ -201,6 +243,11 @@ class DiscoveryAgent {
   DiscoveryCompleteCallback *m_on_complete;
   // uids to mute during incremental discovery
   std::queue<UID> m_uids_to_mute;
+  // The uids from the previous run, used to predict collisions during full
+  // discovery. This is sorted.
+  std::vector<UID> m_expected_uids;
+  DiscoveryProgress m_progress;
+  std::auto_ptr<DiscoveryProgressCallback> m_progress_callback;
   // Callbacks used by the DiscoveryTarget
   std::auto_ptr<DiscoveryTargetInterface::UnMuteDeviceCallback>
       m_unmute_callback;
@@ -224,6 +271,8 @@ class DiscoveryAgent {
   void MaybeMuteNextDevice();
   void IncrementalMuteComplete(bool status);
   void SendDiscovery();
+  bool CollisionExpected(const UIDRange &range) const;
+  void ReportProgress();
 
   void BranchComplete(const uint8_t *data, unsigned int length);
   void BranchMuteComplete(bool status);
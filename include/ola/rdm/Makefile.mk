@@ -5,6 +5,7 @@ dist_noinst_SCRIPTS += include/ola/rdm/make_rdm_codes.sh
 olardminclude_HEADERS = \
     include/ola/rdm/AckTimerResponder.h \
     include/ola/rdm/AdvancedDimmerResponder.h \
+    include/ola/rdm/CachingRDMAPIImpl.h \
     include/ola/rdm/CommandPrinter.h \
     include/ola/rdm/DimmerResponder.h \
     include/ola/rdm/DimmerRootDevice.h \
@@ -12,6 +13,7 @@ olardminclude_HEADERS = \
     include/ola/rdm/DiscoveryAgent.h \
     include/ola/rdm/DummyResponder.h \
     include/ola/rdm/MessageDeserializer.h \
+    include/ola/rdm/MessagePlan.h \
     include/ola/rdm/MessageSerializer.h \
     include/ola/rdm/MovingLightResponder.h \
     include/ola/rdm/NetworkManagerInterface.h \
@@ -24,6 +26,7 @@ olardminclude_HEADERS = \
     include/ola/rdm/RDMAPIImplInterface.h \
     include/ola/rdm/RDMCommand.h \
     include/ola/rdm/RDMCommandSerializer.h \
+    include/ola/rdm/RDMCommandView.h \
     include/ola/rdm/RDMControllerAdaptor.h \
     include/ola/rdm/RDMControllerInterface.h \
     include/ola/rdm/RDMEnums.h \
@@ -0,0 +1,250 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessagePlan.h
+ * Pack and unpack messages without building a Message tree.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ * @file MessagePlan.h
+ * @brief Pack and unpack messages without building a Message tree.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_RDM_MESSAGEPLAN_H_
+#define INCLUDE_OLA_RDM_MESSAGEPLAN_H_
+
+#include <ola/base/Macro.h>
+#include <ola/messaging/Descriptor.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/MACAddress.h>
+#include <ola/rdm/UID.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @brief Receives the fields of a message as it's unpacked.
+ *
+ * Fields are delivered in the order they appear in the message. Each
+ * repetition of a group is bracketed by StartBlock() / EndBlock().
+ */
+class MessageSinkInterface {
+ public:
+  virtual ~MessageSinkInterface() {}
+
+  virtual void Visit(const ola::messaging::BoolFieldDescriptor*,
+                     bool value) = 0;
+  virtual void Visit(const ola::messaging::IPV4FieldDescriptor*,
+                     const ola::network::IPV4Address &value) = 0;
+  virtual void Visit(const ola::messaging::MACFieldDescriptor*,
+                     const ola::network::MACAddress &value) = 0;
+  virtual void Visit(const ola::messaging::UIDFieldDescriptor*,
+                     const UID &value) = 0;
+  virtual void Visit(const ola::messaging::StringFieldDescriptor*,
+                     const std::string &value) = 0;
+  virtual void Visit(const ola::messaging::UInt8FieldDescriptor*,
+                     uint8_t value) = 0;
+  virtual void Visit(const ola::messaging::UInt16FieldDescriptor*,
+                     uint16_t value) = 0;
+  virtual void Visit(const ola::messaging::UInt32FieldDescriptor*,
+                     uint32_t value) = 0;
+  virtual void Visit(const ola::messaging::Int8FieldDescriptor*,
+                     int8_t value) = 0;
+  virtual void Visit(const ola::messaging::Int16FieldDescriptor*,
+                     int16_t value) = 0;
+  virtual void Visit(const ola::messaging::Int32FieldDescriptor*,
+                     int32_t value) = 0;
+  virtual void StartBlock(const ola::messaging::FieldDescriptorGroup*) = 0;
+  virtual void EndBlock(const ola::messaging::FieldDescriptorGroup*) = 0;
+};
+
+
+/**
+ * @brief Provides the fields of a message as it's packed.
+ *
+ * Fields are requested in the order they appear in the message. Returning
+ * false aborts the pack.
+ */
+class MessageSourceInterface {
+ public:
+  virtual ~MessageSourceInterface() {}
+
+  virtual bool Get(const ola::messaging::BoolFieldDescriptor*,
+                   bool *value) = 0;
+  virtual bool Get(const ola::messaging::IPV4FieldDescriptor*,
+                   ola::network::IPV4Address *value) = 0;
+  virtual bool Get(const ola::messaging::MACFieldDescriptor*,
+                   ola::network::MACAddress *value) = 0;
+  virtual bool Get(const ola::messaging::UIDFieldDescriptor*,
+                   UID *value) = 0;
+  virtual bool Get(const ola::messaging::StringFieldDescriptor*,
+                   std::string *value) = 0;
+  virtual bool Get(const ola::messaging::UInt8FieldDescriptor*,
+                   uint8_t *value) = 0;
+  virtual bool Get(const ola::messaging::UInt16FieldDescriptor*,
+                   uint16_t *value) = 0;
+  virtual bool Get(const ola::messaging::UInt32FieldDescriptor*,
+                   uint32_t *value) = 0;
+  virtual bool Get(const ola::messaging::Int8FieldDescriptor*,
+                   int8_t *value) = 0;
+  virtual bool Get(const ola::messaging::Int16FieldDescriptor*,
+                   int16_t *value) = 0;
+  virtual bool Get(const ola::messaging::Int32FieldDescriptor*,
+                   int32_t *value) = 0;
+
+  /**
+   * @brief Return the number of blocks for a group.
+   *
+   * This is only called for groups with a variable number of blocks.
+   */
+  virtual bool GetBlockCount(const ola::messaging::FieldDescriptorGroup*,
+                             unsigned int *count) = 0;
+  virtual void StartBlock(const ola::messaging::FieldDescriptorGroup*) = 0;
+  virtual void EndBlock(const ola::messaging::FieldDescriptorGroup*) = 0;
+};
+
+
+/**
+ * @brief A Descriptor compiled into a flat list of ops.
+ *
+ * MessageSerializer and MessageDeserializer walk the descriptor for each
+ * message and go via a Message tree. A MessagePlan does the walk once, and
+ * records the offset of each field within its block. Packing and unpacking
+ * is then a loop over the ops, moving values directly between the raw data
+ * and a source / sink.
+ *
+ * The same descriptors are supported as with MessageDeserializer, that is at
+ * most one variable sized field (a string or a group with a variable number
+ * of fixed size blocks) at the top level. Fields that follow the variable
+ * field have their offset adjusted by its size.
+ *
+ * A MessagePlan holds pointers to the fields in the descriptor, the
+ * descriptor must outlive the plan. Plans are immutable once compiled, so
+ * can be shared between threads.
+ */
+class MessagePlan {
+ public:
+  /**
+   * @brief Compile a plan for a descriptor.
+   * @param descriptor the Descriptor to compile.
+   * @returns a new MessagePlan, or NULL if the descriptor isn't supported.
+   */
+  static MessagePlan *Compile(const ola::messaging::Descriptor *descriptor);
+
+  /**
+   * @brief Unpack a message.
+   * @param data the raw message data.
+   * @param length the length of the data.
+   * @param sink the sink to pass the fields to.
+   * @returns false if the data doesn't match the descriptor, in which case
+   *   no fields are passed to the sink.
+   */
+  bool Unpack(const uint8_t *data, unsigned int length,
+              MessageSinkInterface *sink) const;
+
+  /**
+   * @brief Pack a message.
+   * @param source the source of the field values.
+   * @param data the buffer to pack into.
+   * @param length the size of the buffer, set to the size of the message on
+   *   return.
+   * @returns false if the source failed or the buffer was too small.
+   */
+  bool Pack(MessageSourceInterface *source,
+            uint8_t *data,
+            unsigned int *length) const;
+
+  /**
+   * @brief The size of the message, excluding any variable sized field.
+   */
+  unsigned int FixedSize() const { return m_fixed_size; }
+
+  /**
+   * @brief True if the message size varies.
+   */
+  bool VariableSize() const { return m_variable_op != NO_VARIABLE_OP; }
+
+  /**
+   * @brief The number of ops in the plan.
+   */
+  unsigned int OpCount() const { return m_ops.size(); }
+
+ private:
+  typedef enum {
+    BOOL_OP,
+    IPV4_OP,
+    MAC_OP,
+    UID_OP,
+    STRING_OP,
+    UINT8_OP,
+    UINT16_OP,
+    UINT32_OP,
+    INT8_OP,
+    INT16_OP,
+    INT32_OP,
+    GROUP_OP,
+  } OpCode;
+
+  struct Op {
+    OpCode code;
+    const ola::messaging::FieldDescriptor *descriptor;
+    // The offset from the start of the enclosing block, or the message for
+    // top level fields.
+    unsigned int offset;
+    // The size of the field, for groups the size of one block.
+    unsigned int size;
+    bool little_endian;
+    // True for top level fields after the variable sized field.
+    bool follows_variable;
+    // For groups, the number of blocks if it's fixed and the number of ops
+    // that make up a block.
+    unsigned int block_count;
+    unsigned int child_ops;
+  };
+
+  typedef std::vector<Op> Ops;
+
+  Ops m_ops;
+  unsigned int m_fixed_size;
+  unsigned int m_variable_op;
+
+  MessagePlan();
+
+  void UnpackOps(unsigned int first, unsigned int last,
+                 const uint8_t *data, unsigned int variable_size,
+                 unsigned int variable_count,
+                 MessageSinkInterface *sink,
+                 std::string *scratch) const;
+  bool PackOps(unsigned int first, unsigned int last,
+               MessageSourceInterface *source,
+               uint8_t *data, unsigned int capacity,
+               unsigned int *variable_size) const;
+
+  static const unsigned int NO_VARIABLE_OP;
+
+  friend class MessagePlanCompiler;
+
+  DISALLOW_COPY_AND_ASSIGN(MessagePlan);
+};
+}  // namespace rdm
+}  // namespace ola
+#endif  // INCLUDE_OLA_RDM_MESSAGEPLAN_H_
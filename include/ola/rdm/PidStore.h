@@ -158,6 +158,10 @@ class RootPidStore {
    * empty, the installed location will be used.
    * @param validate whether to perform validation on the data. Validation can
    * be turned off for faster load times.
+   *
+   * The parsed PID data is cached in CacheLocation(), which saves parsing the
+   * text files the next time the same directory is loaded. The cache is
+   * rebuilt if any of the files in the directory change.
    */
   static const RootPidStore *LoadFromDirectory(const std::string &directory,
                                                bool validate = true);
@@ -168,6 +172,13 @@ class RootPidStore {
    */
   static const std::string DataLocation();
 
+  /**
+   * @brief Returns the directory used to cache the parsed PID data.
+   * @returns $XDG_CACHE_HOME/ola or $HOME/.cache/ola, or an empty string if
+   *   neither is set.
+   */
+  static const std::string CacheLocation();
+
  private:
   std::auto_ptr<const PidStore> m_esta_store;
   ManufacturerMap m_manufacturer_store;
@@ -51,6 +51,15 @@ class PidStoreHelper {
  public:
     explicit PidStoreHelper(const std::string &pid_location,
                             unsigned int initial_indent = 0);
+
+    /**
+     * @brief Create a PidStoreHelper that uses an already loaded store.
+     * @param root_store the store to use, ownership is not transferred. Init()
+     *   doesn't need to be called.
+     * @param initial_indent the indent to use when printing messages.
+     */
+    explicit PidStoreHelper(const RootPidStore *root_store,
+                            unsigned int initial_indent = 0);
     ~PidStoreHelper();
 
     bool Init();
@@ -95,6 +104,7 @@ class PidStoreHelper {
  private:
     const std::string m_pid_location;
     const RootPidStore *m_root_store;
+    const bool m_owns_store;
     StringMessageBuilder m_string_builder;
     MessageSerializer m_serializer;
     MessageDeserializer m_deserializer;
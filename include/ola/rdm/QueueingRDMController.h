@@ -22,15 +22,18 @@
  * @addtogroup rdm_controller
  * @{
  * @file QueueingRDMController.h
- * @brief An RDM Controller that queues messages and only sends a single message
- * at a time.
+ * @brief An RDM Controller that queues messages and limits the number sent at
+ * once.
  * @}
  */
 #ifndef INCLUDE_OLA_RDM_QUEUEINGRDMCONTROLLER_H_
 #define INCLUDE_OLA_RDM_QUEUEINGRDMCONTROLLER_H_
 
 #include <ola/rdm/RDMControllerInterface.h>
-#include <queue>
+#include <ola/rdm/UID.h>
+#include <deque>
+#include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -39,13 +42,22 @@ namespace ola {
 namespace rdm {
 
 /*
- * A RDM controller that only sends a single request at a time. This also
- * handles timing out messages that we don't get a response for.
+ * A RDM controller that queues requests and sends them to the underlying
+ * controller. This also handles ACK_OVERFLOW responses.
+ *
+ * By default only a single request is sent at a time. If the underlying
+ * controller can have more than one request in flight, for example if the
+ * requests are carried over a network, max_outstanding_requests allows up to
+ * that many requests to be outstanding at once. Each outstanding request is
+ * for a different UID, so requests to a single responder are still sent, and
+ * complete, in the order they were queued. Broadcast and vendorcast requests
+ * are always sent on their own.
  */
 class QueueingRDMController: public RDMControllerInterface {
  public:
     QueueingRDMController(RDMControllerInterface *controller,
-                          unsigned int max_queue_size);
+                          unsigned int max_queue_size,
+                          unsigned int max_outstanding_requests = 1);
     ~QueueingRDMController();
 
     void Pause();
@@ -60,22 +72,31 @@ class QueueingRDMController: public RDMControllerInterface {
       RDMCallback *on_complete;
     } outstanding_rdm_request;
 
+    // A request that has been sent to the underlying controller.
+    struct InFlightRequest {
+      outstanding_rdm_request outstanding;
+      // Used to combine the responses in an ACK_OVERFLOW sequence.
+      std::auto_ptr<ola::rdm::RDMResponse> response;
+      std::vector<RDMFrame> frames;
+    };
+
+    typedef std::map<UID, InFlightRequest*> InFlightMap;
+
     RDMControllerInterface *m_controller;
     unsigned int m_max_queue_size;
-    std::queue<outstanding_rdm_request> m_pending_requests;
-    bool m_rdm_request_pending;  // true if a request is in progress
+    unsigned int m_max_outstanding_requests;
+    std::deque<outstanding_rdm_request> m_pending_requests;
+    InFlightMap m_in_flight;  // the requests in progress, by destination
     bool m_active;  // true if the controller is active
-    std::auto_ptr<RDMCallback> m_callback;
-    std::auto_ptr<ola::rdm::RDMResponse> m_response;
-    std::vector<RDMFrame> m_frames;
 
     virtual void TakeNextAction();
     virtual bool CheckForBlockingCondition();
+    bool RequestsInFlight() const { return !m_in_flight.empty(); }
     void MaybeSendRDMRequest();
-    void DispatchNextRequest();
+    void DispatchRequest(InFlightRequest *in_flight);
 
-    void HandleRDMResponse(RDMReply *reply);
-    void RunCallback(RDMReply *reply);
+    void HandleRDMResponse(InFlightRequest *in_flight, RDMReply *reply);
+    void RunCallback(InFlightRequest *in_flight, RDMReply *reply);
 };
 
 
@@ -89,7 +110,8 @@ class DiscoverableQueueingRDMController: public QueueingRDMController {
  public:
     DiscoverableQueueingRDMController(
         DiscoverableRDMControllerInterface *controller,
-        unsigned int max_queue_size);
+        unsigned int max_queue_size,
+        unsigned int max_outstanding_requests = 1);
 
     ~DiscoverableQueueingRDMController() {}
 
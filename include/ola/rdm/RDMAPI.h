@@ -311,6 +311,64 @@ class QueuedMessageHandler {
 };
 
 
+/*
+ * A single GET in a batch, see RDMAPI::GetParameters(). The data is sent as
+ * the parameter data of the GET, e.g. the index for the *_DESCRIPTION PIDs.
+ */
+struct ParameterRequest {
+ public:
+  ParameterRequest(unsigned int universe,
+                   const UID &uid,
+                   uint16_t sub_device,
+                   uint16_t pid)
+      : universe(universe),
+        uid(uid),
+        sub_device(sub_device),
+        pid(pid) {
+  }
+
+  ParameterRequest(unsigned int universe,
+                   const UID &uid,
+                   uint16_t sub_device,
+                   uint16_t pid,
+                   const std::string &data)
+      : universe(universe),
+        uid(uid),
+        sub_device(sub_device),
+        pid(pid),
+        data(data) {
+  }
+
+  unsigned int universe;
+  UID uid;
+  uint16_t sub_device;
+  uint16_t pid;
+  std::string data;
+};
+
+
+/*
+ * The result of a single GET in a batch. The data is the raw parameter data,
+ * it can be unpacked with the matching _Handle* method.
+ */
+struct ParameterResponse {
+ public:
+  explicit ParameterResponse(const ParameterRequest &request)
+      : request(request) {
+    status.response_code = RDM_FAILED_TO_SEND;
+    status.response_type = 0;
+    status.message_count = 0;
+    status.m_param = 0;
+    status.set_command = false;
+    status.pid_value = request.pid;
+  }
+
+  ParameterRequest request;
+  ResponseStatus status;
+  std::string data;
+};
+
+
 /*
  * The high level RDM API.
  */
@@ -321,9 +379,19 @@ class RDMAPI {
     }
     ~RDMAPI() {}
 
+    typedef ola::SingleUseCallback1<void,
+                                    const std::vector<ParameterResponse>&>
+        ParameterBatchCallback;
+
     // This is used to check for queued messages
     uint8_t OutstandingMessagesCount(const UID &uid);
 
+    // Batch methods
+    bool GetParameters(const std::vector<ParameterRequest> &requests,
+                       unsigned int max_in_flight_per_universe,
+                       ParameterBatchCallback *callback,
+                       std::string *error);
+
     // Proxy methods
     bool GetProxiedDeviceCount(
         unsigned int universe,
@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RDMCommandView.h
+ * A read only view of an RDM message in a buffer.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ * @file RDMCommandView.h
+ * @brief A read only view of an RDM message in a buffer.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_RDM_RDMCOMMANDVIEW_H_
+#define INCLUDE_OLA_RDM_RDMCOMMANDVIEW_H_
+
+#include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMFrame.h>
+#include <ola/rdm/RDMPacket.h>
+#include <ola/rdm/RDMResponseCodes.h>
+#include <ola/rdm/UID.h>
+#include <ola/util/Utils.h>
+#include <stdint.h>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ */
+
+/**
+ * @brief A view of an RDM message in a buffer.
+ *
+ * Unlike RDMCommand::Inflate(), Parse() doesn't copy anything. The fields are
+ * read straight from the buffer, so the buffer must outlive the view and not
+ * change while it's in use. If the command needs to be kept, use
+ * ToRequest(), ToResponse() or ToCommand() to make an owned copy.
+ *
+ * Parse() performs the same checks as RDMCommand::Inflate(), but doesn't log
+ * invalid data, which makes it suitable for sniffers and other code that sees
+ * a lot of traffic.
+ */
+class RDMCommandView {
+ public:
+  RDMCommandView() : m_data(NULL), m_header(NULL) {}
+
+  /**
+   * @brief Parse RDM data.
+   * @param data the RDM data, excluding the start code.
+   * @param length the length of the data.
+   * @returns RDM_COMPLETED_OK if the data is valid, otherwise the error. If
+   *   the data is invalid, the view is reset.
+   */
+  RDMStatusCode Parse(const uint8_t *data, unsigned int length);
+
+  /**
+   * @brief Parse the data from an RDMFrame.
+   * @param frame the RDMFrame, which includes the start code.
+   * @returns RDM_COMPLETED_OK if the frame is valid, otherwise the error.
+   */
+  RDMStatusCode Parse(const RDMFrame &frame);
+
+  /**
+   * @brief Reset the view.
+   */
+  void Reset() {
+    m_data = NULL;
+    m_header = NULL;
+  }
+
+  /**
+   * @brief True if the view holds a valid message.
+   */
+  bool IsValid() const { return m_header != NULL; }
+
+  /**
+   * @name Accessors
+   * These must only be called if IsValid() is true.
+   * @{
+   */
+  uint8_t SubStartCode() const { return m_header->sub_start_code; }
+  uint8_t MessageLength() const { return m_header->message_length; }
+  UID SourceUID() const { return UID(m_header->source_uid); }
+  UID DestinationUID() const { return UID(m_header->destination_uid); }
+  uint8_t TransactionNumber() const { return m_header->transaction_number; }
+  uint8_t PortIdResponseType() const { return m_header->port_id; }
+  uint8_t MessageCount() const { return m_header->message_count; }
+
+  uint16_t SubDevice() const {
+    return ola::utils::JoinUInt8(m_header->sub_device[0],
+                                 m_header->sub_device[1]);
+  }
+
+  RDMCommand::RDMCommandClass CommandClass() const {
+    return RDMCommand::ConvertCommandClass(m_header->command_class);
+  }
+
+  uint16_t ParamId() const {
+    return ola::utils::JoinUInt8(m_header->param_id[0],
+                                 m_header->param_id[1]);
+  }
+
+  unsigned int ParamDataSize() const { return m_header->param_data_length; }
+  const uint8_t *ParamData() const { return m_data + sizeof(*m_header); }
+  /** @} */
+
+  /**
+   * @brief True if this is a GET, SET or DISCOVER request.
+   */
+  bool IsRequest() const;
+
+  /**
+   * @brief True if this is a GET, SET or DISCOVER response.
+   */
+  bool IsResponse() const;
+
+  /**
+   * @brief True if this is a DISC_UNIQUE_BRANCH request.
+   */
+  bool IsDUB() const;
+
+  /**
+   * @brief Check this response matches a request.
+   * @param request the request that was sent, may be NULL in which case only
+   *   the response type is checked.
+   * @returns RDM_COMPLETED_OK if it matches, otherwise the reason it doesn't.
+   *
+   * This performs the same checks as RDMResponse::InflateFromData().
+   */
+  RDMStatusCode VerifyResponse(const RDMRequest *request) const;
+
+  /**
+   * @brief Create an RDMRequest from the view.
+   * @returns a new RDMRequest, or NULL if this isn't a request.
+   */
+  RDMRequest *ToRequest() const;
+
+  /**
+   * @brief Create an RDMResponse from the view.
+   * @returns a new RDMResponse, or NULL if this isn't a valid response.
+   */
+  RDMResponse *ToResponse() const;
+
+  /**
+   * @brief Create an RDMCommand from the view.
+   * @returns a new RDMCommand, or NULL if the command class is invalid.
+   */
+  RDMCommand *ToCommand() const;
+
+ private:
+  const uint8_t *m_data;
+  const RDMCommandHeader *m_header;
+};
+/** @} */
+}  // namespace rdm
+}  // namespace ola
+#endif  // INCLUDE_OLA_RDM_RDMCOMMANDVIEW_H_
@@ -212,6 +212,16 @@ class UID {
       return ((static_cast<uint64_t>(m_uid.esta_id) << 32) + m_uid.device_id);
     }
 
+    /**
+     * @brief Return a hash of the UID, for use with hash maps.
+     */
+    size_t Hash() const {
+      // Device ids are often sequential, so mix the bits before they're
+      // used to pick a bucket.
+      uint64_t hash = ToUInt64() * 0x9e3779b97f4a7c15ULL;
+      return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
     /**
      * @brief Convert a UID to a human readable string.
      * @returns a string in the form XXXX:YYYYYYYY.
@@ -325,6 +335,13 @@ class UID {
       return a < b ? -1 : 1;
     }
 };
+
+/**
+ * @brief A hash functor for UIDs, for use with hash maps.
+ */
+struct UIDHash {
+  size_t operator()(const UID &uid) const { return uid.Hash(); }
+};
 }  // namespace rdm
 }  // namespace ola
 #endif  // INCLUDE_OLA_RDM_UID_H_
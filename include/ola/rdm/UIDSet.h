@@ -32,8 +32,10 @@
 #include <ola/rdm/UID.h>
 #include <algorithm>
 #include <iomanip>
-#include <set>
+#include <iterator>
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace ola {
 namespace rdm {
@@ -43,6 +45,14 @@ namespace rdm {
  * @{
  * @class UIDSet
  * @brief Represents a set of RDM UIDs.
+ *
+ * The UIDs are held in a sorted vector, so iteration is in UID order and
+ * lookups are a binary search. The set operations are linear merges.
+ * Adding UIDs in ascending order is constant time; adding them in other
+ * orders is linear in the size of the set, which is fine for the sizes of
+ * RDM networks.
+ *
+ * Unlike a std::set, adding or removing a UID invalidates the iterators.
  * @}
  */
 class UIDSet {
@@ -50,7 +60,7 @@ class UIDSet {
     /**
      * @brief the Iterator for a UIDSets
      */
-    typedef std::set<UID>::const_iterator Iterator;
+    typedef std::vector<UID>::const_iterator Iterator;
 
     /**
      * @brief Construct an empty set
@@ -73,10 +83,19 @@ class UIDSet {
      */
     explicit UIDSet(const uint8_t *data, unsigned int *length) {
       unsigned int used_length = 0;
+      m_uids.reserve(*length / UID::LENGTH);
+      bool sorted = true;
       while ((*length - used_length) >= UID::LENGTH) {
-        m_uids.insert(UID(data + used_length));
+        UID uid(data + used_length);
+        sorted &= m_uids.empty() || Less(m_uids.back(), uid);
+        m_uids.push_back(uid);
         used_length += UID::LENGTH;
       }
+      if (!sorted) {
+        std::sort(m_uids.begin(), m_uids.end(), Less);
+        m_uids.erase(std::unique(m_uids.begin(), m_uids.end()),
+                     m_uids.end());
+      }
       *length = used_length;
     }
 
@@ -113,12 +132,28 @@ class UIDSet {
       return m_uids.empty();
     }
 
+    /**
+     * @brief Reserve space for a number of UIDs.
+     * @param size the number of UIDs the set is expected to hold.
+     */
+    void Reserve(unsigned int size) {
+      m_uids.reserve(size);
+    }
+
     /**
      * @brief Add a UID to the set.
      * @param uid the UID to add.
      */
     void AddUID(const UID &uid) {
-      m_uids.insert(uid);
+      if (m_uids.empty() || Less(m_uids.back(), uid)) {
+        m_uids.push_back(uid);
+        return;
+      }
+      std::vector<UID>::iterator iter = std::lower_bound(
+          m_uids.begin(), m_uids.end(), uid, Less);
+      if (*iter != uid) {
+        m_uids.insert(iter, uid);
+      }
     }
 
     /**
@@ -126,7 +161,11 @@ class UIDSet {
      * @param uid the UID to remove.
      */
     void RemoveUID(const UID &uid) {
-      m_uids.erase(uid);
+      std::vector<UID>::iterator iter = std::lower_bound(
+          m_uids.begin(), m_uids.end(), uid, Less);
+      if (iter != m_uids.end() && *iter == uid) {
+        m_uids.erase(iter);
+      }
     }
 
     /**
@@ -135,7 +174,7 @@ class UIDSet {
      * @return true if the set contains this UID.
      */
     bool Contains(const UID &uid) const {
-      return m_uids.find(uid) != m_uids.end();
+      return std::binary_search(m_uids.begin(), m_uids.end(), uid, Less);
     }
 
     /**
@@ -143,14 +182,27 @@ class UIDSet {
      * @param other the UIDSet to perform the union with.
      * @return the union of the two UIDSets.
      */
-    UIDSet Union(const UIDSet &other) {
-      std::set<UID> result;
-      set_union(m_uids.begin(),
-                m_uids.end(),
-                other.Begin(),
-                other.End(),
-                inserter(result, result.begin()));
-      return UIDSet(result);
+    UIDSet Union(const UIDSet &other) const {
+      UIDSet result;
+      result.m_uids.reserve(m_uids.size() + other.m_uids.size());
+      std::set_union(m_uids.begin(), m_uids.end(),
+                     other.m_uids.begin(), other.m_uids.end(),
+                     std::back_inserter(result.m_uids), Less);
+      return result;
+    }
+
+    /**
+     * @brief Return the UIDs that are in both this set and another UIDSet.
+     * @param other the UIDSet to perform the intersection with.
+     * @return the intersection of the two UIDSets.
+     */
+    UIDSet Intersection(const UIDSet &other) const {
+      UIDSet result;
+      result.m_uids.reserve(std::min(m_uids.size(), other.m_uids.size()));
+      std::set_intersection(m_uids.begin(), m_uids.end(),
+                            other.m_uids.begin(), other.m_uids.end(),
+                            std::back_inserter(result.m_uids), Less);
+      return result;
     }
 
     /**
@@ -172,14 +224,13 @@ class UIDSet {
      * @param other the UIDSet to subtract from this set.
      * @return the difference between this UIDSet and other.
      */
-    UIDSet SetDifference(const UIDSet &other) {
-      std::set<UID> difference;
-      std::set_difference(m_uids.begin(),
-                          m_uids.end(),
-                          other.m_uids.begin(),
-                          other.m_uids.end(),
-                          std::inserter(difference, difference.begin()));
-      return UIDSet(difference);
+    UIDSet SetDifference(const UIDSet &other) const {
+      UIDSet difference;
+      difference.m_uids.reserve(m_uids.size());
+      std::set_difference(m_uids.begin(), m_uids.end(),
+                          other.m_uids.begin(), other.m_uids.end(),
+                          std::back_inserter(difference.m_uids), Less);
+      return difference;
     }
 
     /**
@@ -204,7 +255,7 @@ class UIDSet {
      */
     std::string ToString() const {
       std::ostringstream str;
-      std::set<UID>::const_iterator iter;
+      Iterator iter;
       for (iter = m_uids.begin(); iter != m_uids.end(); ++iter) {
         if (iter != m_uids.begin())
           str << ",";
@@ -234,7 +285,7 @@ class UIDSet {
         return false;
       }
       uint8_t *ptr = buffer;
-      std::set<UID>::const_iterator iter;
+      Iterator iter;
       for (iter = m_uids.begin(); iter != m_uids.end(); ++iter) {
         iter->Pack(ptr, UID::UID_SIZE);
         ptr += UID::UID_SIZE;
@@ -243,10 +294,13 @@ class UIDSet {
     }
 
  private:
-    std::set<UID> m_uids;
+    // Sorted, with no duplicates.
+    std::vector<UID> m_uids;
 
-    explicit UIDSet(const std::set<UID> uids) {
-      m_uids = uids;
+    // Compare the 48 bit values, which is a single integer comparison rather
+    // than the two UID::operator< does.
+    static bool Less(const UID &a, const UID &b) {
+      return a.ToUInt64() < b.ToUInt64();
     }
 };
 }  // namespace rdm
@@ -52,6 +52,39 @@ std::string IntToString(int i);
  */
 std::string IntToString(unsigned int i);
 
+/**
+ * @brief The maximum number of characters written by FormatUInt().
+ */
+static const unsigned int MAX_UINT_DIGITS = 10;
+
+/**
+ * @brief Write the decimal representation of an unsigned int.
+ *
+ * This is the equivalent of std::to_chars; it doesn't allocate memory or
+ * depend on the locale.
+ * @param i the unsigned int to convert
+ * @param output the buffer to write to, which must have space for at least
+ *   MAX_UINT_DIGITS characters. The output isn't NULL terminated.
+ * @return a pointer to one past the last character written.
+ */
+char *FormatUInt(unsigned int i, char *output);
+
+/**
+ * @brief Parse an unsigned decimal number from a range of characters.
+ *
+ * This is the equivalent of std::from_chars. Leading whitespace and signs
+ * aren't accepted, parsing stops at the first character that isn't a digit.
+ * @param begin the first character to parse
+ * @param end one past the last character to parse
+ * @param[out] output set to the value parsed. This is only modified if a
+ *   value was parsed.
+ * @return a pointer to the first character that wasn't parsed. If there
+ *   aren't any digits, or the value doesn't fit in an unsigned int, begin is
+ *   returned.
+ */
+const char *ParseUInt(const char *begin, const char *end,
+                      unsigned int *output);
+
 /**
  * @brief Convert a value to a hex string.
  *
@@ -79,6 +79,9 @@ class MockUDPSocket: public ola::network::UDPSocketInterface {
                  const ola::network::IPV4SocketAddress &dest) const {
     return SendTo(data, dest.Host(), dest.Port());
   }
+  ssize_t SendTo(const ola::io::IOVec *iov,
+                 unsigned int iov_count,
+                 const ola::network::IPV4SocketAddress &dest) const;
 
   bool RecvFrom(uint8_t *buffer, ssize_t *data_read) const;
   bool RecvFrom(
@@ -93,6 +96,10 @@ class MockUDPSocket: public ola::network::UDPSocketInterface {
   bool RecvFrom(uint8_t *buffer,
                 ssize_t *data_read,
                 ola::network::IPV4SocketAddress *source);
+  unsigned int RecvMultiple(ola::network::UDPDatagram *datagrams,
+                            unsigned int count);
+  unsigned int SendMultiple(const ola::network::UDPDatagram *datagrams,
+                            unsigned int count) const;
   bool EnableBroadcast();
   bool SetMulticastInterface(const ola::network::IPV4Address &iface);
   bool JoinMulticast(const ola::network::IPV4Address &iface,
@@ -102,6 +109,7 @@ class MockUDPSocket: public ola::network::UDPSocketInterface {
                       const ola::network::IPV4Address &group);
 
   bool SetTos(uint8_t tos);
+  bool EnableReceiveTimestamps() { return false; }
 
   void SetDiscardMode(bool discard_mode) { m_discard_mode = discard_mode; }
 
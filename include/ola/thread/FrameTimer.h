@@ -0,0 +1,161 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FrameTimer.h
+ * Paces an output thread on absolute frame deadlines.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @file FrameTimer.h
+ * @brief Frame pacing and timing statistics for output threads.
+ */
+
+#ifndef INCLUDE_OLA_THREAD_FRAMETIMER_H_
+#define INCLUDE_OLA_THREAD_FRAMETIMER_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <string>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Timing statistics for a thread that sends frames at a fixed rate.
+ *
+ * The statistics are updated by the output thread and may be read from any
+ * other thread. Like ola::dmx::ReceiveStats, the counters are written with
+ * relaxed atomic stores.
+ */
+class FrameTimingStats {
+ public:
+  FrameTimingStats();
+
+  /**
+   * @brief Record the start of a frame.
+   * @param lateness how long after the deadline the frame started.
+   */
+  void FrameStarted(const TimeInterval &lateness);
+
+  /**
+   * @brief Record frames that were skipped because the thread fell behind.
+   * @param count the number of frames skipped.
+   */
+  void FramesMissed(unsigned int count);
+
+  /**
+   * @brief Record that the previous frame ran past the next frame's deadline.
+   */
+  void FrameOverran();
+
+  /**
+   * @brief The number of frames started.
+   */
+  uint32_t Frames() const;
+
+  /**
+   * @brief The number of frames skipped.
+   */
+  uint32_t MissedFrames() const;
+
+  /**
+   * @brief The number of frames that ran past the next frame's deadline.
+   */
+  uint32_t Overruns() const;
+
+  /**
+   * @brief The smoothed lateness of the frame starts, in microseconds.
+   */
+  uint32_t JitterMicroSeconds() const;
+
+  /**
+   * @brief The largest lateness seen, in microseconds.
+   */
+  uint32_t MaxJitterMicroSeconds() const;
+
+  /**
+   * @brief A human readable summary.
+   */
+  std::string ToString() const;
+
+ private:
+  uint32_t m_frames;
+  uint32_t m_missed_frames;
+  uint32_t m_overruns;
+  uint32_t m_jitter_us;
+  uint32_t m_max_jitter_us;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameTimingStats);
+};
+
+
+/**
+ * @brief Paces a loop to a fixed frame rate.
+ *
+ * Each frame is scheduled relative to the previous deadline rather than the
+ * time the previous frame finished, so the time spent sending doesn't add to
+ * the frame time and scheduling delays don't accumulate. Where available the
+ * thread sleeps with clock_nanosleep() on an absolute CLOCK_MONOTONIC
+ * deadline.
+ *
+ * If the thread falls more than a frame behind, the missed deadlines are
+ * skipped rather than sending a burst of frames to catch up.
+ */
+class FrameTimer {
+ public:
+  /**
+   * @brief Create a new FrameTimer.
+   * @param frame_time the time between the start of each frame.
+   */
+  explicit FrameTimer(const TimeInterval &frame_time);
+
+  /**
+   * @brief Start a new sequence of frames, the first frame starts now.
+   */
+  void Start();
+
+  /**
+   * @brief Sleep until the start of the next frame.
+   */
+  void WaitForNextFrame();
+
+  /**
+   * @brief The timing statistics, these can be read from any thread.
+   */
+  const FrameTimingStats &Stats() const { return m_stats; }
+
+  /**
+   * @brief Sleep for a short interval, e.g. a DMX break.
+   *
+   * This uses an absolute deadline so a signal doesn't extend the sleep.
+   * @param duration the time to sleep for.
+   */
+  static void SleepFor(const TimeInterval &duration);
+
+ private:
+  const TimeInterval m_frame_time;
+  Clock m_clock;
+  TimeStamp m_deadline;
+  FrameTimingStats m_stats;
+
+  static void SleepUntil(const Clock &clock, const TimeStamp &deadline);
+
+  DISALLOW_COPY_AND_ASSIGN(FrameTimer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_FRAMETIMER_H_
@@ -21,13 +21,26 @@
 #ifndef INCLUDE_OLA_THREAD_FUTURE_H_
 #define INCLUDE_OLA_THREAD_FUTURE_H_
 
+#include <ola/Callback.h>
+#include <ola/thread/ExecutorInterface.h>
 #include <ola/thread/FuturePrivate.h>
+#include <stddef.h>
 
 namespace ola {
 namespace thread {
 
 /**
- * A Future object
+ * A Future object.
+ *
+ * Get() blocks until the value is available. Rather than blocking, Then()
+ * can be used to run a callback with the value once it's set. Then() returns
+ * a Future for the callback's result, so continuations can be chained.
+ *
+ * @code
+ *   int Double(const int &value) { return value * 2; }
+ *
+ *   Future<int> result = future.Then(&pool, ola::NewSingleCallback(Double));
+ * @endcode
  */
 template <typename T>
 class Future {
@@ -44,8 +57,8 @@ class Future {
 
     Future& operator=(const Future<T> &other) {
       if (this != &other) {
-        m_impl->DeRef();
         other.m_impl->Ref();
+        m_impl->DeRef();
         m_impl = other.m_impl;
       }
       return *this;
@@ -63,8 +76,36 @@ class Future {
       m_impl->Set(t);
     }
 
+    /**
+     * Run a callback with the value, once it's available.
+     * @param executor the executor to run the callback on, or NULL to run it
+     *   in the thread that calls Set(). If the Future is already complete
+     *   and there's no executor, the callback is run immediately.
+     * @param callback the callback to run, ownership is transferred.
+     * @returns a Future which is set to the result of the callback.
+     */
+    template <typename R>
+    Future<R> Then(ExecutorInterface *executor,
+                   SingleUseCallback1<R, const T&> *callback) {
+      Future<R> result;
+      m_impl->AddContinuation(
+          new FutureThen<T, R, SingleUseCallback1<R, const T&> >(
+              executor, callback, result.m_impl));
+      return result;
+    }
+
+    /**
+     * Run a callback with the value in the thread that calls Set().
+     */
+    template <typename R>
+    Future<R> Then(SingleUseCallback1<R, const T&> *callback) {
+      return Then(NULL, callback);
+    }
+
  private:
     class FutureImpl<T> *m_impl;
+
+    template <typename> friend class Future;
 };
 
 /**
@@ -73,7 +114,7 @@ class Future {
 template <>
 class Future<void> {
  public:
-    Future() : m_impl(new FutureImpl<void>()) {}
+    Future() : m_impl(new FutureImpl<FutureVoid>()) {}
 
     ~Future() {
       m_impl->DeRef();
@@ -85,8 +126,8 @@ class Future<void> {
 
     Future& operator=(const Future<void> &other) {
       if (this != &other) {
-        m_impl->DeRef();
         other.m_impl->Ref();
+        m_impl->DeRef();
         m_impl = other.m_impl;
       }
       return *this;
@@ -101,11 +142,38 @@ class Future<void> {
     }
 
     void Set() {
-      m_impl->Set();
+      m_impl->Set(FutureVoid());
+    }
+
+    /**
+     * Run a callback once the Future is complete.
+     * @param executor the executor to run the callback on, or NULL to run it
+     *   in the thread that calls Set().
+     * @param callback the callback to run, ownership is transferred.
+     * @returns a Future which is set to the result of the callback.
+     */
+    template <typename R>
+    Future<R> Then(ExecutorInterface *executor,
+                   SingleUseCallback0<R> *callback) {
+      Future<R> result;
+      m_impl->AddContinuation(
+          new FutureThen<FutureVoid, R, SingleUseCallback0<R> >(
+              executor, callback, result.m_impl));
+      return result;
+    }
+
+    /**
+     * Run a callback in the thread that calls Set().
+     */
+    template <typename R>
+    Future<R> Then(SingleUseCallback0<R> *callback) {
+      return Then(NULL, callback);
     }
 
  private:
-    class FutureImpl<void> *m_impl;
+    class FutureImpl<FutureVoid> *m_impl;
+
+    template <typename> friend class Future;
 };
 }  // namespace thread
 }  // namespace ola
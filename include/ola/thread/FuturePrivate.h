@@ -21,138 +21,273 @@
 #ifndef INCLUDE_OLA_THREAD_FUTUREPRIVATE_H_
 #define INCLUDE_OLA_THREAD_FUTUREPRIVATE_H_
 
+#include <ola/Callback.h>
 #include <ola/Logging.h>
 #include <ola/base/Macro.h>
+#include <ola/thread/ExecutorInterface.h>
 #include <ola/thread/Mutex.h>
+#include <stddef.h>
 
 namespace ola {
 namespace thread {
 
+/**
+ * The value held by a Future<void>.
+ */
+struct FutureVoid {};
+
+/**
+ * Maps the type of a Future to the type its FutureImpl holds.
+ */
+template <typename T>
+struct FutureValue {
+  typedef T Type;
+};
+
+template <>
+struct FutureValue<void> {
+  typedef FutureVoid Type;
+};
+
+/**
+ * Something to run once a Future's value is available. Continuations are
+ * kept in a singly linked list until then.
+ */
+template <typename T>
+class FutureContinuation {
+ public:
+  FutureContinuation() : next(NULL) {}
+  virtual ~FutureContinuation() {}
+
+  /**
+   * Called exactly once, with the value of the Future. Heap allocated
+   * continuations delete themselves.
+   */
+  virtual void Run(const T &value) = 0;
+
+  FutureContinuation<T> *next;
+};
+
+/**
+ * The state shared between copies of a Future.
+ *
+ * There's no lock, the state lives in m_head. While the Future is pending
+ * it's the list of continuations, which are pushed with a compare & swap.
+ * Set() stores the value and then swaps in a marker, which publishes the value
+ * and hands the list to the setter, which runs it.
+ *
+ * Get() only blocks if the value isn't available yet, in which case it adds a
+ * continuation that wakes it up. The mutex and condition variable for that
+ * live on the waiting thread's stack.
+ */
 template <typename T>
 class FutureImpl {
  public:
+  typedef FutureContinuation<T> Continuation;
+
   FutureImpl()
       : m_ref_count(1),
         m_is_set(false),
+        m_head(NULL),
         m_value() {
   }
 
-  void Ref() {
-    {
-      MutexLocker l(&m_mutex);
-      m_ref_count++;
+  ~FutureImpl() {
+    // If the Future was never set, the continuations were never run.
+    Continuation *continuation = m_head;
+    while (continuation && continuation != Completed()) {
+      Continuation *next = continuation->next;
+      delete continuation;
+      continuation = next;
     }
   }
 
+  void Ref() {
+    __atomic_add_fetch(&m_ref_count, 1, __ATOMIC_RELAXED);
+  }
+
   void DeRef() {
-    unsigned int ref_count = 0;
-    {
-      MutexLocker l(&m_mutex);
-      ref_count = --m_ref_count;
-    }
-    if (ref_count == 0) {
+    if (__atomic_sub_fetch(&m_ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
       delete this;
     }
   }
 
   bool IsComplete() const {
-    MutexLocker l(&m_mutex);
-    return m_is_set;
+    return __atomic_load_n(&m_head, __ATOMIC_ACQUIRE) == Completed();
   }
 
   const T& Get() const {
-    MutexLocker l(&m_mutex);
-    if (m_is_set) {
-      return m_value;
+    if (!IsComplete()) {
+      Waiter waiter;
+      AddContinuation(&waiter);
+      waiter.Wait();
     }
-    m_condition.Wait(&m_mutex);
     return m_value;
   }
 
   void Set(const T &t) {
-    {
-      MutexLocker l(&m_mutex);
-      if (m_is_set) {
-        OLA_FATAL << "Double call to FutureImpl::Set()";
+    if (__atomic_exchange_n(&m_is_set, true, __ATOMIC_RELAXED)) {
+      OLA_FATAL << "Double call to FutureImpl::Set()";
+      return;
+    }
+    m_value = t;
+    Continuation *continuation = __atomic_exchange_n(
+        &m_head, Completed(), __ATOMIC_ACQ_REL);
+
+    // The list is newest first, reverse it so continuations run in the order
+    // they were added.
+    Continuation *ordered = NULL;
+    while (continuation) {
+      Continuation *next = continuation->next;
+      continuation->next = ordered;
+      ordered = continuation;
+      continuation = next;
+    }
+
+    while (ordered) {
+      // The continuation may be deleted by Run().
+      Continuation *next = ordered->next;
+      ordered->Run(m_value);
+      ordered = next;
+    }
+  }
+
+  /**
+   * Run a continuation once the value is available. If it already is, the
+   * continuation is run immediately.
+   */
+  void AddContinuation(Continuation *continuation) const {
+    Continuation *head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    while (head != Completed()) {
+      continuation->next = head;
+      if (__atomic_compare_exchange_n(&m_head, &head, continuation, true,
+                                      __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
         return;
       }
-      m_is_set = true;
-      m_value = t;
     }
-    m_condition.Broadcast();
+    continuation->Run(m_value);
   }
 
  private:
-  mutable Mutex m_mutex;
-  mutable ConditionVariable m_condition;
+  class Waiter: public Continuation {
+   public:
+    Waiter() : m_done(false) {}
+
+    void Run(const T&) {
+      MutexLocker l(&m_mutex);
+      m_done = true;
+      m_condition.Signal();
+    }
+
+    void Wait() {
+      MutexLocker l(&m_mutex);
+      while (!m_done) {
+        m_condition.Wait(&m_mutex);
+      }
+    }
+
+   private:
+    Mutex m_mutex;
+    ConditionVariable m_condition;
+    bool m_done;
+  };
+
   unsigned int m_ref_count;
   bool m_is_set;
+  mutable Continuation *m_head;
   T m_value;
 
+  // m_head points to the FutureImpl itself once the value is available.
+  Continuation *Completed() const {
+    return reinterpret_cast<Continuation*>(const_cast<FutureImpl<T>*>(this));
+  }
+
   DISALLOW_COPY_AND_ASSIGN(FutureImpl<T>);
 };
 
 /**
- * The void specialization
+ * Runs the callback passed to Then() and completes the Future it returned.
  */
-template <>
-class FutureImpl<void> {
- public:
-  FutureImpl()
-      : m_ref_count(1),
-        m_is_set(false) {
+template <typename T, typename R>
+struct FutureCall {
+  static void Run(SingleUseCallback1<R, const T&> *callback, const T &value,
+                  FutureImpl<R> *result) {
+    result->Set(callback->Run(value));
   }
 
-  void Ref() {
-    {
-      MutexLocker l(&m_mutex);
-      m_ref_count++;
-    }
+  static void Run(SingleUseCallback0<R> *callback, const T&,
+                  FutureImpl<R> *result) {
+    result->Set(callback->Run());
   }
+};
 
-  void DeRef() {
-    unsigned int ref_count = 0;
-    {
-      MutexLocker l(&m_mutex);
-      ref_count = --m_ref_count;
-    }
-    if (ref_count == 0) {
-      delete this;
-    }
+template <typename T>
+struct FutureCall<T, void> {
+  static void Run(SingleUseCallback1<void, const T&> *callback,
+                  const T &value, FutureImpl<FutureVoid> *result) {
+    callback->Run(value);
+    result->Set(FutureVoid());
   }
 
-  bool IsComplete() const {
-    MutexLocker l(&m_mutex);
-    return m_is_set;
+  static void Run(SingleUseCallback0<void> *callback, const T&,
+                  FutureImpl<FutureVoid> *result) {
+    callback->Run();
+    result->Set(FutureVoid());
   }
+};
 
-  void Get() const {
-    MutexLocker l(&m_mutex);
-    if (m_is_set) {
-      return;
-    }
-    m_condition.Wait(&m_mutex);
+/**
+ * The continuation added by Then(). If there's an executor, the callback is
+ * passed to it, otherwise it's run by the thread that completes the Future.
+ */
+template <typename T, typename R, typename CallbackType>
+class FutureThen: public FutureContinuation<T> {
+ public:
+  typedef FutureImpl<typename FutureValue<R>::Type> ResultImpl;
+
+  FutureThen(ExecutorInterface *executor,
+             CallbackType *callback,
+             ResultImpl *result)
+      : m_executor(executor),
+        m_callback(callback),
+        m_result(result),
+        m_value() {
+    m_result->Ref();
   }
 
-  void Set() {
-    {
-      MutexLocker l(&m_mutex);
-      if (m_is_set) {
-        OLA_FATAL << "Double call to FutureImpl::Set()";
-        return;
-      }
-      m_is_set = true;
+  ~FutureThen() {
+    delete m_callback;
+    m_result->DeRef();
+  }
+
+  void Run(const T &value) {
+    if (m_executor) {
+      m_value = value;
+      m_executor->Execute(
+          NewSingleCallback(this, &FutureThen<T, R, CallbackType>::RunQueued));
+    } else {
+      Complete(value);
     }
-    m_condition.Broadcast();
   }
 
  private:
-  mutable Mutex m_mutex;
-  mutable ConditionVariable m_condition;
-  unsigned int m_ref_count;
-  bool m_is_set;
+  ExecutorInterface *m_executor;
+  CallbackType *m_callback;
+  ResultImpl *m_result;
+  T m_value;
+
+  void RunQueued() {
+    Complete(m_value);
+  }
+
+  void Complete(const T &value) {
+    CallbackType *callback = m_callback;
+    m_callback = NULL;
+    FutureCall<T, R>::Run(callback, value, m_result);
+    delete this;
+  }
 
-  DISALLOW_COPY_AND_ASSIGN(FutureImpl<void>);
+  DISALLOW_COPY_AND_ASSIGN(FutureThen);
 };
 
 }  // namespace thread
@@ -0,0 +1,109 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MPSCQueue.h
+ * An unbounded, lock free, multiple producer, single consumer queue.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_THREAD_MPSCQUEUE_H_
+#define INCLUDE_OLA_THREAD_MPSCQUEUE_H_
+
+#include <ola/base/Macro.h>
+#include <stddef.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A queue that any number of threads can add items to without taking
+ * a lock.
+ *
+ * Any thread may call Push(), exactly one thread may call Pop(). Each item is
+ * stored in a node that's allocated by Push(), the producers swap the new node
+ * in as the head of the list with a single atomic exchange.
+ *
+ * Pop() may briefly return false while a producer is part way through
+ * Push(). Once Push() has returned, the item is visible to the consumer.
+ *
+ * T must be default constructible and assignable.
+ */
+template <typename T>
+class MPSCQueue {
+ public:
+  MPSCQueue()
+      : m_head(&m_stub),
+        m_tail(&m_stub) {
+  }
+
+  ~MPSCQueue() {
+    T item;
+    while (Pop(&item)) {}
+    if (m_tail != &m_stub) {
+      delete m_tail;
+    }
+  }
+
+  /**
+   * @brief Add an item to the queue. This can be called from any thread.
+   * @param item the item to add.
+   */
+  void Push(const T &item) {
+    Node *node = new Node(item);
+    Node *previous = __atomic_exchange_n(&m_head, node, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&previous->next, node, __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief Remove an item from the queue, this must only be called by the
+   *   consumer.
+   * @param[out] item the item that was removed.
+   * @returns false if the queue was empty, true otherwise.
+   */
+  bool Pop(T *item) {
+    Node *tail = m_tail;
+    Node *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (!next) {
+      return false;
+    }
+    // next becomes the new stub node, so take the value out of it.
+    *item = next->value;
+    next->value = T();
+    m_tail = next;
+    if (tail != &m_stub) {
+      delete tail;
+    }
+    return true;
+  }
+
+ private:
+  class Node {
+   public:
+    Node() : value(), next(NULL) {}
+    explicit Node(const T &item) : value(item), next(NULL) {}
+
+    T value;
+    Node *next;
+  };
+
+  Node m_stub;
+  Node *m_head;  // written by the producers
+  Node *m_tail;  // only used by the consumer
+
+  DISALLOW_COPY_AND_ASSIGN(MPSCQueue);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_MPSCQUEUE_H_
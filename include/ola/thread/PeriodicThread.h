@@ -23,6 +23,7 @@
 
 #include <ola/Callback.h>
 #include <ola/base/Macro.h>
+#include <ola/thread/FrameTimer.h>
 #include <ola/thread/Thread.h>
 #include <ola/Clock.h>
 
@@ -33,6 +34,11 @@ namespace thread {
 
 /**
  * @brief A thread which executes a Callback.
+ *
+ * The callback is run at fixed deadlines, each one period after the last, so
+ * the time the callback takes and any scheduling delays don't cause the rate
+ * to drift. The deadlines use the monotonic clock, so changes to the system
+ * time don't affect them either.
  */
 class PeriodicThread : private Thread {
  public:
@@ -43,18 +49,37 @@ class PeriodicThread : private Thread {
    */
   typedef Callback0<bool> PeriodicCallback;
 
+  /**
+   * @brief What to do when the callback runs past one or more deadlines.
+   */
+  enum OverrunPolicy {
+    /**
+     * Drop the deadlines that have passed and run at the next one that's
+     * still in phase. This is the best choice for output threads, where a
+     * burst of stale frames is worse than a missed one.
+     */
+    SKIP_MISSED_RUNS,
+    /**
+     * Run the callback once for each deadline that has passed, back to back,
+     * until the thread has caught up.
+     */
+    CATCH_UP
+  };
+
   /**
    * Create a new PeriodicThread.
-   * @param delay The delay between invoking the callback.
+   * @param delay The time between the start of each run of the callback.
    * @param callback the callback to run in the new thread.
    * @param options the thread's options.
+   * @param policy what to do if the callback runs past the next deadline.
    *
    * The thread will start running and immediately run the callback. This may
    * happen before the constructor returns.
    */
   explicit PeriodicThread(const TimeInterval &delay,
                           PeriodicCallback *callback,
-                          const Options &options = Options());
+                          const Options &options = Options(),
+                          OverrunPolicy policy = SKIP_MISSED_RUNS);
 
   /**
    * @brief Stop the PeriodicThread.
@@ -63,17 +88,29 @@ class PeriodicThread : private Thread {
    */
   void Stop();
 
+  /**
+   * @brief The timing statistics for the callback runs.
+   *
+   * The jitter is how late each run started compared to its deadline. These
+   * can be read from any thread.
+   */
+  const FrameTimingStats &Stats() const { return m_stats; }
+
  protected:
   void *Run();
 
  private:
   TimeInterval m_delay;
   PeriodicCallback *m_callback;
+  const OverrunPolicy m_policy;
+  FrameTimingStats m_stats;
 
   bool m_terminate;
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_condition;
 
+  bool WaitUntil(const Clock &clock, const TimeStamp &deadline);
+
   DISALLOW_COPY_AND_ASSIGN(PeriodicThread);
 };
 }  // namespace thread
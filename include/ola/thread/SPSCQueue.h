@@ -0,0 +1,133 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SPSCQueue.h
+ * A bounded, lock free, single producer, single consumer queue.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+#define INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+
+#include <ola/base/Macro.h>
+#include <stddef.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A bounded queue that can be used to pass items from one thread to
+ * another without taking a lock.
+ *
+ * Exactly one thread may call Push() and exactly one (possibly different)
+ * thread may call Pop(). The items are stored in a ring and copied in and out,
+ * so T must be default constructible and assignable. Popped slots are reset to
+ * T() so any resources held by the item are released by the consumer.
+ *
+ * The head and tail indices are kept on separate cache lines to avoid false
+ * sharing between the producer and consumer.
+ */
+template <typename T>
+class SPSCQueue {
+ public:
+  /**
+   * @brief Create a new queue.
+   * @param capacity the maximum number of items in the queue. This is rounded
+   *   up to a power of two.
+   */
+  explicit SPSCQueue(unsigned int capacity)
+      : m_items(NULL),
+        m_mask(0),
+        m_head(0),
+        m_tail(0) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    m_mask = size - 1;
+    m_items = new T[size];
+  }
+
+  ~SPSCQueue() {
+    delete[] m_items;
+  }
+
+  /**
+   * @brief The number of items the queue can hold.
+   */
+  size_t Capacity() const { return m_mask + 1; }
+
+  /**
+   * @brief Add an item to the queue, this must only be called by the producer.
+   * @param item the item to add.
+   * @returns false if the queue was full, true otherwise.
+   */
+  bool Push(const T &item) {
+    size_t tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    if (tail - head > m_mask) {
+      return false;
+    }
+    m_items[tail & m_mask] = item;
+    __atomic_store_n(&m_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * @brief Remove an item from the queue, this must only be called by the
+   *   consumer.
+   * @param[out] item the item that was removed.
+   * @returns false if the queue was empty, true otherwise.
+   */
+  bool Pop(T *item) {
+    size_t head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      return false;
+    }
+    T &slot = m_items[head & m_mask];
+    *item = slot;
+    slot = T();
+    __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * @brief Check if the queue is empty.
+   *
+   * This can be called from either thread, but the answer may be out of date
+   * by the time it's returned.
+   */
+  bool Empty() const {
+    return (__atomic_load_n(&m_head, __ATOMIC_ACQUIRE) ==
+            __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE));
+  }
+
+ private:
+  enum { CACHE_LINE_SIZE = 64 };
+
+  T *m_items;
+  size_t m_mask;
+  char m_pad0[CACHE_LINE_SIZE];
+  size_t m_head;  // only written by the consumer
+  char m_pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+  size_t m_tail;  // only written by the producer
+  char m_pad2[CACHE_LINE_SIZE - sizeof(size_t)];
+
+  DISALLOW_COPY_AND_ASSIGN(SPSCQueue);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_SPSCQUEUE_H_
@@ -31,7 +31,9 @@
 #include <ola/base/Macro.h>
 #include <ola/thread/Mutex.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 #if defined(_WIN32) && defined(__GNUC__)
 inline std::ostream& operator<<(std::ostream &stream,
@@ -87,6 +89,13 @@ class Thread {
      */
     int inheritsched;
 
+    /**
+     * @brief The CPUs the thread may run on, starting from 0.
+     *
+     * Empty, the default, allows the thread to run on any CPU.
+     */
+    std::vector<unsigned int> cpus;
+
     /**
      * @brief Create new thread Options.
      * @param name the name of the thread.
@@ -94,6 +103,62 @@ class Thread {
     explicit Options(const std::string &name = "");
   };
 
+  /**
+   * @brief Overrides the options of the threads with a particular name.
+   *
+   * These are usually set from the --thread-placement flag, so threads can be
+   * kept away from the cores used by other software on the same host.
+   */
+  struct Placement {
+   public:
+    /**
+     * @brief The CPUs to run on, empty leaves the CPUs from the Options.
+     */
+    std::vector<unsigned int> cpus;
+
+    /**
+     * @brief If true, policy and priority replace those from the Options.
+     */
+    bool set_scheduling;
+    int policy;
+    int priority;
+
+    Placement() : set_scheduling(false), policy(0), priority(0) {}
+  };
+
+  /**
+   * @brief Set the placement for the threads with a name.
+   * @param name the name of the threads, "main" is the main thread.
+   * @param placement the placement, this applies to threads started after
+   *   the call.
+   */
+  static void SetPlacement(const std::string &name,
+                           const Placement &placement);
+
+  /**
+   * @brief Remove all the placements set with SetPlacement().
+   */
+  static void ClearPlacements();
+
+  /**
+   * @brief Apply the placement for a name to the calling thread.
+   * @param name the name to look up the placement with.
+   * @returns false if the placement couldn't be applied.
+   *
+   * This is used for threads not started with this class, like the main
+   * thread. The effective placement is recorded under the name.
+   */
+  static bool PlaceCurrentThread(const std::string &name);
+
+  /**
+   * @brief Get the effective placement of the running threads.
+   * @param[out] placements a map of thread name to a description of the
+   *   scheduling policy, priority and CPUs of the thread. If more than one
+   *   thread has the same name, the later ones have -2, -3 etc. appended.
+   */
+  static void EffectivePlacements(
+      std::map<std::string, std::string> *placements);
+
   /**
    * @brief Create a new thread with the specified thread options.
    * @param options the thread's options
@@ -181,6 +246,7 @@ class Thread {
   Options m_options;
   Mutex m_mutex;  // protects m_running
   ConditionVariable m_condition;  // use to wait for the thread to start
+  std::string m_placement_key;  // the key in the effective placements
 
   DISALLOW_COPY_AND_ASSIGN(Thread);
 };
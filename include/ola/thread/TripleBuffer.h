@@ -0,0 +1,123 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TripleBuffer.h
+ * A lock free slot holding the latest value written by another thread.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_THREAD_TRIPLEBUFFER_H_
+#define INCLUDE_OLA_THREAD_TRIPLEBUFFER_H_
+
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Pass the latest value from one thread to another without taking a
+ * lock.
+ *
+ * Unlike SPSCQueue, intermediate values are dropped, so the reader always
+ * sees the most recent value and the writer never waits. This suits output
+ * threads which send the current frame at a fixed rate.
+ *
+ * There are three slots: the writer owns one, the reader owns one and the
+ * third holds the last value published. Write() and Update() swap their own
+ * slot with the shared one using a single atomic exchange.
+ *
+ * Exactly one thread may call Write() and exactly one (possibly different)
+ * thread may call Update() and Front().
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer()
+      : m_back(0),
+        m_middle(1),
+        m_front(2) {
+  }
+
+  /**
+   * @brief Publish a new value, this must only be called by the writer.
+   * @param value the value to publish.
+   */
+  void Write(const T &value) {
+    Back() = value;
+    Publish();
+  }
+
+  /**
+   * @brief The slot owned by the writer.
+   *
+   * This allows the writer to fill in the next value in place, e.g. when
+   * T::operator= would share state with the source. Call Publish() once the
+   * value is complete.
+   */
+  T &Back() { return m_slots[m_back]; }
+
+  /**
+   * @brief Publish the value in Back(), this must only be called by the
+   *   writer.
+   */
+  void Publish() {
+    unsigned int old = __atomic_exchange_n(&m_middle, m_back | NEW_VALUE,
+                                           __ATOMIC_ACQ_REL);
+    m_back = old & INDEX_MASK;
+  }
+
+  /**
+   * @brief Pick up the latest value, this must only be called by the reader.
+   * @returns true if a new value was written since the last call, in which
+   *   case Front() now returns it.
+   */
+  bool Update() {
+    if (!(__atomic_load_n(&m_middle, __ATOMIC_RELAXED) & NEW_VALUE)) {
+      return false;
+    }
+    unsigned int old = __atomic_exchange_n(&m_middle, m_front,
+                                           __ATOMIC_ACQ_REL);
+    m_front = old & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * @brief The value picked up by the last call to Update(). This is a
+   *   default constructed T until the first value is written.
+   */
+  T &Front() { return m_slots[m_front]; }
+  const T &Front() const { return m_slots[m_front]; }
+
+ private:
+  enum {
+    CACHE_LINE_SIZE = 64,
+    INDEX_MASK = 0x3,
+    NEW_VALUE = 0x4,
+  };
+
+  T m_slots[3];
+  char m_pad0[CACHE_LINE_SIZE];
+  unsigned int m_back;  // only used by the writer
+  char m_pad1[CACHE_LINE_SIZE - sizeof(unsigned int)];
+  unsigned int m_middle;  // the shared slot, plus the NEW_VALUE flag
+  char m_pad2[CACHE_LINE_SIZE - sizeof(unsigned int)];
+  unsigned int m_front;  // only used by the reader
+  char m_pad3[CACHE_LINE_SIZE - sizeof(unsigned int)];
+
+  DISALLOW_COPY_AND_ASSIGN(TripleBuffer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_TRIPLEBUFFER_H_
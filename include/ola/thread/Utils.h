@@ -28,7 +28,10 @@
 #define WIN32_LEAN_AND_MEAN
 #endif  // _WIN32
 #include <pthread.h>
+#include <ola/thread/Thread.h>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace ola {
 namespace thread {
@@ -50,6 +53,69 @@ std::string PolicyToString(int policy);
 bool SetSchedParam(pthread_t thread, int policy,
                    const struct sched_param &param);
 
+/**
+ * @brief Restrict a thread to a single CPU.
+ * @param thread The thread id.
+ * @param cpu the CPU to run on, starting from 0.
+ * @returns True if the call succeeded, false if it failed or thread affinity
+ *   isn't supported on this platform.
+ */
+bool SetThreadAffinity(pthread_t thread, unsigned int cpu);
+
+/**
+ * @brief Restrict a thread to a set of CPUs.
+ * @param thread The thread id.
+ * @param cpus the CPUs to run on, starting from 0.
+ * @returns True if the call succeeded, false if it failed or thread affinity
+ *   isn't supported on this platform.
+ */
+bool SetThreadAffinity(pthread_t thread, const std::vector<unsigned int> &cpus);
+
+/**
+ * @brief Get the CPUs a thread may run on.
+ * @param thread The thread id.
+ * @param[out] cpus the CPUs the thread may run on, in ascending order.
+ * @returns True if the call succeeded, false if it failed or thread affinity
+ *   isn't supported on this platform.
+ */
+bool GetThreadAffinity(pthread_t thread, std::vector<unsigned int> *cpus);
+
+/**
+ * @brief Convert a policy name, one of fifo, rr or other, to a policy.
+ * @param name the name of the policy, this is case insensitive.
+ * @param[out] policy the scheduling policy.
+ * @returns true if the name was valid, false otherwise.
+ */
+bool StringToPolicy(const std::string &name, int *policy);
+
+/**
+ * @brief Parse a list of CPUs, e.g. "0,2-3".
+ * @param str the list of CPUs and inclusive ranges of CPUs, comma separated.
+ * @param[out] cpus the CPUs, in ascending order without duplicates.
+ * @returns true if the list was valid, false otherwise.
+ */
+bool StringToCPUList(const std::string &str, std::vector<unsigned int> *cpus);
+
+/**
+ * @brief Format a list of CPUs, the inverse of StringToCPUList().
+ * @param cpus the CPUs, in ascending order.
+ * @returns the CPUs with consecutive runs shown as ranges, e.g. "0,2-3".
+ */
+std::string CPUListToString(const std::vector<unsigned int> &cpus);
+
+/**
+ * @brief Parse the placements for a set of named threads.
+ * @param str the placements, separated by semicolons. Each one is of the form
+ *   name=cpus[:policy:priority], where cpus is a list for StringToCPUList()
+ *   and may be empty, and policy is a name for StringToPolicy(). For example
+ *   "http=3;main=0-1:fifo:10".
+ * @param[out] placements a map of thread name to placement.
+ * @returns true if the placements were valid, false otherwise.
+ */
+bool StringToThreadPlacements(
+    const std::string &str,
+    std::map<std::string, Thread::Placement> *placements);
+
 }  // namespace thread
 }  // namespace ola
 #endif  // INCLUDE_OLA_THREAD_UTILS_H_
@@ -0,0 +1,180 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingPool.h
+ * A thread pool where each worker has its own queue.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_THREAD_WORKSTEALINGPOOL_H_
+#define INCLUDE_OLA_THREAD_WORKSTEALINGPOOL_H_
+
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/ExecutorInterface.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/Thread.h>
+#include <vector>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A thread pool where each worker thread has its own queue.
+ *
+ * Unlike ThreadPool, which shares a single queue between all threads, each
+ * worker here owns a deque. Callbacks added from outside the pool are spread
+ * across the workers, callbacks added by a worker go onto its own deque. A
+ * worker runs the newest item from its own deque, and when that's empty it
+ * steals the oldest item from another worker.
+ *
+ * Since callbacks can run on any worker, the ordering guarantee of
+ * ExecutorInterface only holds when the pool has a single thread.
+ *
+ * @examplepara
+ * @code
+ *   WorkStealingPool::Options options;
+ *   options.thread_count = 4;
+ *   WorkStealingPool pool(options);
+ *   pool.Init();
+ *
+ *   // Process the universes in blocks of 16, this blocks until done.
+ *   pool.ParallelFor(0, universes.size(), 16,
+ *                    NewCallback(this, &Merger::MergeUniverses));
+ * @endcode
+ */
+class WorkStealingPool: public ExecutorInterface {
+ public:
+  typedef ola::BaseCallback0<void>* Action;
+
+  /**
+   * @brief Called with a [begin, end) range by ParallelFor().
+   */
+  typedef ola::Callback2<void, unsigned int, unsigned int> RangeCallback;
+
+  struct Options {
+   public:
+    /**
+     * @brief The number of worker threads.
+     */
+    unsigned int thread_count;
+
+    /**
+     * @brief The CPUs to pin the workers to.
+     *
+     * Worker n is pinned to cpus[n % cpus.size()]. If empty, the workers
+     * aren't pinned.
+     */
+    std::vector<unsigned int> cpus;
+
+    /**
+     * @brief The options used for each worker thread.
+     */
+    Thread::Options thread_options;
+
+    Options()
+        : thread_count(2),
+          thread_options("ola-pool") {
+    }
+  };
+
+  explicit WorkStealingPool(const Options &options);
+
+  /**
+   * @brief Destructor.
+   *
+   * This stops the worker threads and runs any remaining callbacks.
+   */
+  ~WorkStealingPool();
+
+  /**
+   * @brief Start the worker threads.
+   * @returns true if all the threads started, false otherwise.
+   */
+  bool Init();
+
+  /**
+   * @brief Wait for the queued callbacks to run and then stop the workers.
+   */
+  void JoinAll();
+
+  /**
+   * @brief Queue a callback to be run by one of the workers.
+   * @param callback the callback to run, ownership is transferred.
+   *
+   * This can be called from any thread.
+   */
+  void Execute(ola::BaseCallback0<void> *callback);
+
+  /**
+   * @brief Run queued callbacks in the calling thread until none are left.
+   *
+   * Callbacks that the workers have already started may still be running
+   * when this returns.
+   */
+  void DrainCallbacks();
+
+  /**
+   * @brief Split a range into blocks and process them in parallel.
+   * @param begin the start of the range.
+   * @param end one past the end of the range.
+   * @param grain the maximum size of each block.
+   * @param callback the callback to run for each block, ownership is
+   *   transferred. This is run from many threads at once.
+   *
+   * This blocks until all the blocks have been processed. The calling thread
+   * processes blocks too, so this can be called from a worker, and from a
+   * pool that hasn't been started.
+   */
+  void ParallelFor(unsigned int begin, unsigned int end, unsigned int grain,
+                   RangeCallback *callback);
+
+  /**
+   * @brief The number of worker threads.
+   */
+  unsigned int ThreadCount() const {
+    return static_cast<unsigned int>(m_workers.size());
+  }
+
+ private:
+  class Worker;
+  struct RangeState;
+
+  const Options m_options;
+  std::vector<Worker*> m_workers;
+  bool m_started;
+  bool m_shutdown;  // protected by m_idle_mutex
+  int m_pending;  // the number of queued callbacks
+  int m_idle;  // the number of waiting workers
+  unsigned int m_next_worker;
+
+  Mutex m_idle_mutex;
+  ConditionVariable m_work_available;
+
+  bool HasPending() const {
+    return __atomic_load_n(&m_pending, __ATOMIC_SEQ_CST) > 0;
+  }
+
+  void WorkerLoop(Worker *self);
+  bool TakeAction(Worker *self, Action *action);
+  Worker *CurrentWorker() const;
+  void RunRange(RangeState *state, unsigned int begin, unsigned int end);
+  void StopWorkers();
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingPool);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_WORKSTEALINGPOOL_H_
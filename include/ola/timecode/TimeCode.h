@@ -46,6 +46,32 @@ class TimeCode {
 
     bool IsValid() const;
 
+    /**
+     * @brief The number of frames since 00:00:00:00.
+     *
+     * For drop frame timecode the frame numbers that are skipped aren't
+     * counted, so this is the number of frames that have actually elapsed.
+     */
+    uint32_t FrameCount() const;
+
+    /**
+     * @brief Build a TimeCode from a count of frames since 00:00:00:00.
+     * @param type the type of timecode.
+     * @param frame_count the number of frames, this wraps at 24 hours.
+     */
+    static TimeCode FromFrameCount(TimeCodeType type, uint32_t frame_count);
+
+    /**
+     * @brief The number of frames in each second of timecode. This is 30 for
+     *   drop frame timecode, even though it runs at 29.97fps.
+     */
+    static uint8_t NominalFrameRate(TimeCodeType type);
+
+    /**
+     * @brief The number of frames in 24 hours of timecode.
+     */
+    static uint32_t FramesPerDay(TimeCodeType type);
+
     TimeCodeType Type() const { return m_type; }
     uint8_t Hours() const { return m_hours; }
     uint8_t Minutes() const { return m_minutes; }
@@ -68,6 +94,11 @@ class TimeCode {
     static const uint8_t MAX_HOURS = 23;
     static const uint8_t MAX_MINUTES = 59;
     static const uint8_t MAX_SECONDS = 59;
+    // Drop frame skips two frame numbers at the start of each minute, except
+    // for every tenth minute.
+    static const uint32_t DROPPED_FRAMES = 2;
+    static const uint32_t DF_FRAMES_PER_MINUTE = 1798;
+    static const uint32_t DF_FRAMES_PER_TEN_MINUTES = 17982;
 };
 }  // namespace timecode
 }  // namespace ola
@@ -3,5 +3,6 @@ olautilinclude_HEADERS = \
     include/ola/util/Backoff.h \
     include/ola/util/Deleter.h \
     include/ola/util/SequenceNumber.h \
+    include/ola/util/StallWatchdog.h \
     include/ola/util/Utils.h \
     include/ola/util/Watchdog.h
@@ -0,0 +1,217 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StallWatchdog.h
+ * Detects threads that stall & records what they were doing.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLA_UTIL_STALLWATCHDOG_H_
+#define INCLUDE_OLA_UTIL_STALLWATCHDOG_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/Thread.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+
+namespace ola {
+
+/**
+ * @brief Marks the sections of a thread's work that the StallWatchdog
+ * supervises.
+ *
+ * A thread calls Begin() before a unit of work, such as running an event
+ * handler or sending a DMX frame, and End() once it's done. Time spent outside
+ * of a section, e.g. waiting for events, doesn't count, so threads that are
+ * idle for long periods aren't reported.
+ *
+ * Begin() and End() are cheap, and must only be called from a single thread.
+ * Sections may be nested, only the outermost one is timed.
+ *
+ * Heartbeats register themselves when they're created, and can be used
+ * whether or not there is a StallWatchdog running.
+ */
+class Heartbeat {
+ public:
+  /**
+   * @brief Create a new Heartbeat.
+   * @param name the name the stalls are reported under, usually the name of
+   *   the thread.
+   * @param clock the clock to use, ownership is not transferred. If NULL the
+   *   system clock is used.
+   */
+  explicit Heartbeat(const std::string &name, Clock *clock = NULL);
+  ~Heartbeat();
+
+  const std::string &Name() const { return m_name; }
+
+  /**
+   * @brief Start a section of work.
+   */
+  void Begin();
+
+  /**
+   * @brief Start a section of work.
+   * @param now the current monotonic time, to save reading the clock again.
+   */
+  void Begin(const TimeStamp &now);
+
+  /**
+   * @brief End a section of work.
+   * @param activity what the section was doing, e.g. the name of the event
+   *   handler. This is only used if the section stalled.
+   */
+  void End(const std::string &activity = "");
+
+ private:
+  const std::string m_name;
+  Clock m_system_clock;
+  Clock *m_clock;
+
+  // Only used by the thread calling Begin() & End().
+  unsigned int m_depth;
+  bool m_has_thread;
+
+  // Set by the first Begin(), this is published by the store to m_started_us.
+  pthread_t m_thread;
+
+  // The monotonic time the current section started in microseconds, or 0 if
+  // the thread isn't in a section. Accessed with atomics.
+  int64_t m_started_us;
+
+  // The value of m_started_us when the StallWatchdog decided the section had
+  // stalled, 0 otherwise. Accessed with atomics.
+  int64_t m_stalled_at;
+
+  // Set once a stalled section ends, guarded by the registry mutex.
+  bool m_stall_ended;
+  int64_t m_stall_us;
+  std::string m_stall_activity;
+
+  void StallEnded(int64_t started_us, const std::string &activity);
+
+  friend class StallWatchdog;
+
+  DISALLOW_COPY_AND_ASSIGN(Heartbeat);
+};
+
+
+/**
+ * @brief Reports the Heartbeats that have been in a section for too long.
+ *
+ * The watchdog runs on its own thread, and checks each Heartbeat at a
+ * quarter of the threshold. When a section exceeds the threshold the stall is
+ * logged along with a backtrace of the stalled thread, captured by sending it
+ * SIGUSR2. Once the section ends, the duration of the stall and the activity
+ * passed to Heartbeat::End() are logged.
+ *
+ * With an ExportMap, the following are exported, by heartbeat name:
+ *  - stall-count, the number of stalls.
+ *  - stall-max-ms, the longest stall.
+ *  - stall-last, the duration & activity of the most recent stall.
+ *
+ * Heartbeats with the same name share the same stats. Only one StallWatchdog
+ * should exist at a time.
+ */
+class StallWatchdog: public ola::thread::Thread {
+ public:
+  struct Options {
+   public:
+    /**
+     * @brief Sections that run for longer than this are reported.
+     */
+    TimeInterval threshold;
+
+    /**
+     * @brief Capture a backtrace of stalled threads.
+     *
+     * This installs a handler for SIGUSR2. The signal interrupts any system
+     * call the stalled thread is blocked in that isn't restarted, such as
+     * nanosleep().
+     */
+    bool capture_backtraces;
+
+    Options()
+        : threshold(1, 0),
+          capture_backtraces(true) {
+    }
+  };
+
+  /**
+   * @brief Create a new StallWatchdog.
+   * @param options the Options to use.
+   * @param export_map the ExportMap to use, may be NULL.
+   * @param clock the clock to use, ownership is not transferred. If NULL the
+   *   system clock is used.
+   */
+  StallWatchdog(const Options &options, ExportMap *export_map,
+                Clock *clock = NULL);
+  ~StallWatchdog();
+
+  /**
+   * @brief Stop the watchdog thread.
+   */
+  void Stop();
+
+  /**
+   * @brief Check the heartbeats once.
+   *
+   * This is called periodically by the watchdog thread, and can be called
+   * directly when the thread isn't running.
+   */
+  void Check();
+
+  /**
+   * @brief Check if there is a StallWatchdog.
+   *
+   * Code that only creates Heartbeats when they'll be supervised, because
+   * doing so has a cost, uses this.
+   */
+  static bool Enabled();
+
+ protected:
+  void *Run();
+
+ private:
+  const int64_t m_threshold_us;
+  const TimeInterval m_check_interval;
+  const bool m_capture_backtraces;
+  Clock m_system_clock;
+  Clock *m_clock;
+  bool m_term;  // GUARDED_BY(m_term_mutex)
+  ola::thread::Mutex m_term_mutex;
+  ola::thread::ConditionVariable m_term_cond;
+
+  UIntMap *m_stall_count;
+  UIntMap *m_stall_max;
+  StringMap *m_stall_last;
+
+  void StallStarted(Heartbeat *heartbeat, int64_t elapsed_us);
+  void ReportStallEnd(Heartbeat *heartbeat);
+  void LogBacktrace(const Heartbeat &heartbeat);
+
+  static const char K_STALL_COUNT_VAR[];
+  static const char K_STALL_MAX_VAR[];
+  static const char K_STALL_LAST_VAR[];
+  static const int64_t MIN_CHECK_INTERVAL_US = 10000;
+
+  DISALLOW_COPY_AND_ASSIGN(StallWatchdog);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLA_UTIL_STALLWATCHDOG_H_
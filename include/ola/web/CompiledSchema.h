@@ -0,0 +1,215 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CompiledSchema.h
+ * A JSON schema flattened into a form that's fast to validate against.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup json
+ * @{
+ * @file CompiledSchema.h
+ * @brief A JSON schema flattened into a form that's fast to validate against.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_WEB_COMPILEDSCHEMA_H_
+#define INCLUDE_OLA_WEB_COMPILEDSCHEMA_H_
+
+#include <ola/base/Macro.h>
+#include <ola/web/Json.h>
+#include <ola/web/JsonSchema.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace web {
+
+/**
+ * @addtogroup json
+ * @{
+ */
+
+/**
+ * @brief A JsonSchema compiled into a flat table of checks.
+ *
+ * A JsonSchema validates by walking a tree of validators, which involves a
+ * virtual call for every validator and string lookups for every object
+ * property. A CompiledSchema is built once from a JsonSchema. Each schema
+ * becomes a node with a mask of the allowed value types and a run of
+ * opcodes. Property names are interned, so the required and dependent
+ * properties of an object are checked with bitsets.
+ *
+ * The result of IsValid() is the same as JsonSchema::IsValid(). Unlike a
+ * JsonSchema, a CompiledSchema isn't modified during validation, so it can
+ * be shared between threads.
+ *
+ * @code
+ *   auto_ptr<CompiledSchema> schema(CompiledSchema::FromString(text, &error));
+ *   if (schema.get() && schema->IsValid(*value)) {
+ *     ...
+ *   }
+ * @endcode
+ */
+class CompiledSchema {
+ public:
+  ~CompiledSchema();
+
+  /**
+   * @brief Validate a JsonValue against this schema.
+   */
+  bool IsValid(const JsonValue &value) const;
+
+  /**
+   * @brief The number of schema nodes.
+   */
+  unsigned int NodeCount() const { return m_nodes.size(); }
+
+  /**
+   * @brief Compile a JsonSchema.
+   * @returns a new CompiledSchema, ownership is transferred to the caller.
+   */
+  static CompiledSchema* Compile(const JsonSchema &schema);
+
+  /**
+   * @brief Parse and compile a schema.
+   * @returns A CompiledSchema, or NULL if the string wasn't a valid schema.
+   */
+  static CompiledSchema* FromString(const std::string &schema_string,
+                                    std::string *error);
+
+ private:
+  typedef uint32_t Index;
+
+  enum Opcode {
+    OP_MIN_LENGTH,
+    OP_MAX_LENGTH,
+    OP_MINIMUM,
+    OP_EXCLUSIVE_MINIMUM,
+    OP_MAXIMUM,
+    OP_EXCLUSIVE_MAXIMUM,
+    OP_MULTIPLE_OF,
+    OP_ENUM,
+    OP_MIN_PROPERTIES,
+    OP_MAX_PROPERTIES,
+    OP_OBJECT,
+    OP_MIN_ITEMS,
+    OP_MAX_ITEMS,
+    OP_ITEMS,
+    OP_UNIQUE_ITEMS,
+    OP_ALL_OF,
+    OP_ANY_OF,
+    OP_ONE_OF,
+    OP_NOT,
+    OP_FAIL,
+  };
+
+  struct Op {
+    Opcode code;
+    // The meaning of the arguments depends on the opcode. They're either
+    // numbers, or indices into one of the tables below.
+    Index arg;
+    Index count;
+  };
+
+  // A schema, this matches values whose type is in the kind mask, and which
+  // pass all of the ops.
+  struct Node {
+    uint32_t kinds;
+    Index first_op;
+    Index op_count;
+  };
+
+  struct Property {
+    Index name;
+    Index node;
+  };
+
+  struct PropertyDependency {
+    Index name;
+    Index bitset;
+  };
+
+  struct ObjectRules {
+    // The property schemas, in m_properties and sorted by name.
+    Index first_property;
+    Index property_count;
+    Index additional_node;
+    bool reject_additional;
+    // The bitset of required names, or NO_INDEX.
+    Index required;
+    Index first_property_dependency;
+    Index property_dependency_count;
+    // Also in m_properties. If the named property is present, the whole
+    // object is checked against the node.
+    Index first_schema_dependency;
+    Index schema_dependency_count;
+  };
+
+  struct ArrayRules {
+    // If the tuple is empty, all elements are checked against the additional
+    // node.
+    Index first_tuple_node;
+    Index tuple_size;
+    Index additional_node;
+    bool reject_additional;
+  };
+
+  struct Value;
+  struct Context;
+  class Classifier;
+  class PropertyChecker;
+  class Compiler;
+
+  std::vector<Node> m_nodes;
+  std::vector<Op> m_ops;
+  std::vector<Index> m_node_lists;
+  std::vector<ObjectRules> m_objects;
+  std::vector<ArrayRules> m_arrays;
+  std::vector<Property> m_properties;
+  std::vector<PropertyDependency> m_property_dependencies;
+  std::vector<uint64_t> m_bitsets;
+  // The number of uint64_t words in each bitset.
+  unsigned int m_bitset_words;
+  std::map<std::string, Index> m_names;
+  std::vector<const JsonValue*> m_constants;
+  Index m_root;
+
+  CompiledSchema();
+
+  bool Validate(Index node_index, const JsonValue &json,
+                Context *context) const;
+  bool RunNode(const Node &node, const Value &value, Context *context) const;
+  bool RunOp(const Op &op, const Value &value, Context *context) const;
+  bool CheckObject(const ObjectRules &rules, const JsonObject &object,
+                   Context *context) const;
+  bool CheckArray(const ArrayRules &rules, const JsonArray &array,
+                  Context *context) const;
+  bool IsSeen(Index name, const Context &context, size_t offset) const;
+  bool IsSubset(Index bitset, const Context &context, size_t offset) const;
+  Index LookupName(const std::string &name) const;
+
+  static const Index NO_INDEX;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledSchema);
+};
+/**@}*/
+}  // namespace web
+}  // namespace ola
+#endif  // INCLUDE_OLA_WEB_COMPILEDSCHEMA_H_
@@ -986,6 +986,14 @@ class JsonObject: public JsonValue {
    */
   bool Remove(const std::string &key);
 
+  /**
+   * @brief Remove the JsonValue with the specified key, without deleting it.
+   * @param key the key to remove
+   * @returns the value, ownership is transferred, or NULL if the key didn't
+   *   exist.
+   */
+  JsonValue* ReleaseValue(const std::string &key);
+
   /**
    * @brief Replace the key with the supplied JsonValue.
    * @param key the key to add.
@@ -1151,6 +1159,14 @@ class JsonArray: public JsonValue {
    */
   bool RemoveElementAt(uint32_t index);
 
+  /**
+   * @brief Remove the JsonValue at the specified index, without deleting it.
+   * @param index the index of the value to remove
+   * @returns the value, ownership is transferred, or NULL if the index is
+   *   outside the current array.
+   */
+  JsonValue* ReleaseElementAt(uint32_t index);
+
   /**
    * @brief Replace the JsonValue at the specified index.
    * @param index the index of the value to replace.
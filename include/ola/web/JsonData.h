@@ -62,7 +62,7 @@ class JsonData {
    * @param schema The schema to validate this data against. Ownership is not
    *   transferred.
    */
-  JsonData(const JsonValue *value,
+  JsonData(JsonValue *value,
            ValidatorInterface *schema = NULL)
       : m_value(value),
         m_schema(schema) {
@@ -94,7 +94,7 @@ class JsonData {
   const ValidatorInterface* GetSchema() const { return m_schema; }
 
  private:
-  std::auto_ptr<const JsonValue> m_value;
+  std::auto_ptr<JsonValue> m_value;
   ValidatorInterface *m_schema;
 
   bool IsValid(const JsonValue *value);
@@ -0,0 +1,338 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonDocument.h
+ * A read only JSON tree, allocated from a single arena.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup json
+ * @{
+ * @file JsonDocument.h
+ * @brief A read only JSON tree, allocated from a single arena.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_WEB_JSONDOCUMENT_H_
+#define INCLUDE_OLA_WEB_JSONDOCUMENT_H_
+
+#include <ola/base/Macro.h>
+#include <ola/web/Json.h>
+#include <ola/web/JsonLexer.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace web {
+
+/**
+ * @addtogroup json
+ * @{
+ */
+
+/**
+ * @brief A bump allocator.
+ *
+ * Memory is carved out of large blocks, and is only freed when the arena is
+ * destroyed.
+ */
+class JsonArena {
+ public:
+  JsonArena()
+      : m_current(NULL),
+        m_remaining(0),
+        m_size(0) {
+  }
+
+  ~JsonArena();
+
+  /**
+   * @brief Allocate memory from the arena.
+   * @param size the number of bytes to allocate.
+   * @returns a pointer, aligned to 8 bytes, which is valid for the lifetime
+   *   of the arena.
+   */
+  void *Allocate(size_t size);
+
+  /**
+   * @brief Copy a string into the arena.
+   * @returns a pointer to the NULL terminated copy.
+   */
+  const char *CopyString(const char *data, size_t length);
+
+  /**
+   * @brief The total number of bytes allocated from the system.
+   */
+  size_t Size() const { return m_size; }
+
+ private:
+  std::vector<char*> m_blocks;
+  char *m_current;
+  size_t m_remaining;
+  size_t m_size;
+
+  static const size_t BLOCK_SIZE = 16384;
+  static const size_t ALIGNMENT = 8;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonArena);
+};
+
+
+struct JsonMember;
+
+/**
+ * @brief A node in a JsonDocument.
+ *
+ * Nodes are small, plain structures. Strings, and the children of arrays
+ * and objects, are stored in the JsonDocument's arena, so a node is only
+ * valid for the lifetime of the document that owns it.
+ */
+class JsonNode {
+ public:
+  enum Type {
+    NULL_NODE,
+    BOOL_NODE,
+    UINT_NODE,
+    INT_NODE,
+    UINT64_NODE,
+    INT64_NODE,
+    DOUBLE_NODE,
+    STRING_NODE,
+    ARRAY_NODE,
+    OBJECT_NODE,
+  };
+
+  /**
+   * @brief A parsed double, both the value and the representation.
+   */
+  struct Double {
+    double value;
+    bool has_representation;
+    JsonDouble::DoubleRepresentation representation;
+  };
+
+  Type GetType() const { return static_cast<Type>(m_type); }
+
+  bool IsNull() const { return m_type == NULL_NODE; }
+  bool IsString() const { return m_type == STRING_NODE; }
+  bool IsArray() const { return m_type == ARRAY_NODE; }
+  bool IsObject() const { return m_type == OBJECT_NODE; }
+
+  /**
+   * @brief Check if this node holds a number.
+   */
+  bool IsNumber() const {
+    return m_type >= UINT_NODE && m_type <= DOUBLE_NODE;
+  }
+
+  bool BoolValue() const { return m_value.bool_value; }
+  uint32_t UIntValue() const { return m_value.uint_value; }
+  int32_t IntValue() const { return m_value.int_value; }
+  uint64_t UInt64Value() const { return m_value.uint64_value; }
+  int64_t Int64Value() const { return m_value.int64_value; }
+
+  /**
+   * @brief Return the value of any number node as a double.
+   */
+  double DoubleValue() const;
+
+  /**
+   * @brief The string data.
+   * @note This is not NULL terminated, use StringSize() for the length.
+   */
+  const char *StringData() const { return m_value.string_value; }
+
+  /**
+   * @brief The length of the string, which may contain embedded NULLs.
+   */
+  uint32_t StringSize() const { return m_size; }
+
+  /**
+   * @brief Return a copy of the string.
+   */
+  std::string StringValue() const {
+    return std::string(m_value.string_value, m_size);
+  }
+
+  /**
+   * @brief Compare a string node with a string, without copying.
+   */
+  bool StringEquals(const std::string &value) const;
+
+  /**
+   * @brief The number of elements in an array, or members in an object.
+   */
+  uint32_t Size() const { return m_size; }
+
+  /**
+   * @brief Return an element of an array.
+   * @param i the index, which must be less than Size().
+   */
+  const JsonNode &ElementAt(uint32_t i) const {
+    return m_value.elements[i];
+  }
+
+  /**
+   * @brief Return a member of an object.
+   * @param i the index, which must be less than Size(). Members are in the
+   *   order they appeared in the input.
+   */
+  inline const JsonMember &MemberAt(uint32_t i) const;
+
+  /**
+   * @brief Lookup the value of a key in an object.
+   * @returns the value, or NULL if the key wasn't found. If a key appears
+   *   more than once the last value is returned, to match JsonObject.
+   */
+  const JsonNode *Lookup(const std::string &key) const;
+
+  /**
+   * @brief Convert this node, and its children, to a tree of JsonValues.
+   * @returns a new JsonValue, ownership is transferred to the caller.
+   *
+   * This is useful for passing part of a document to code that takes a
+   * JsonValue, like the JsonSchema validators.
+   */
+  JsonValue *ToJsonValue() const;
+
+ private:
+  uint32_t m_type;
+  uint32_t m_size;
+  union {
+    bool bool_value;
+    uint32_t uint_value;
+    int32_t int_value;
+    uint64_t uint64_value;
+    int64_t int64_value;
+    const Double *double_value;
+    const char *string_value;
+    const JsonNode *elements;
+    const JsonMember *members;
+  } m_value;
+
+  void AddToArray(JsonArray *array) const;
+  void AddToObject(const std::string &key, JsonObject *object) const;
+  void PopulateArray(JsonArray *array) const;
+  void PopulateObject(JsonObject *object) const;
+  JsonValue *NewScalarValue() const;
+
+  friend class JsonDocument;
+};
+
+
+/**
+ * @brief A key / value pair in an object.
+ */
+struct JsonMember {
+  JsonNode key;  // always a STRING_NODE.
+  JsonNode value;
+};
+
+const JsonMember &JsonNode::MemberAt(uint32_t i) const {
+  return m_value.members[i];
+}
+
+
+/**
+ * @brief A read only JSON document.
+ *
+ * Unlike JsonParser, which creates a heap allocated JsonValue for every
+ * value, a JsonDocument allocates the nodes, and a copy of the input, from a
+ * single arena. Strings without escape sequences point into the copy of the
+ * input, so they're never copied again.
+ *
+ * @code
+ *   JsonDocument document;
+ *   string error;
+ *   if (document.Parse(input, &error)) {
+ *     const JsonNode *name = document.Root().Lookup("name");
+ *   }
+ * @endcode
+ */
+class JsonDocument : private JsonParserInterface {
+ public:
+  JsonDocument();
+
+  /**
+   * @brief Parse text into this document.
+   * @param input the JSON text.
+   * @param error set to the reason parsing failed.
+   * @returns true if the input was valid JSON, false otherwise.
+   *
+   * A document can only be parsed once.
+   */
+  bool Parse(const std::string &input, std::string *error);
+
+  /**
+   * @brief The root node. This is a NULL_NODE until Parse() succeeds.
+   */
+  const JsonNode &Root() const { return m_root; }
+
+  /**
+   * @brief The number of bytes used by the document.
+   */
+  size_t ArenaSize() const { return m_arena.Size(); }
+
+ private:
+  struct Container {
+    bool is_object;
+    // The index of the container's first child in m_pending.
+    size_t start;
+  };
+
+  JsonArena m_arena;
+  JsonNode m_root;
+  const char *m_input;
+  size_t m_input_size;
+  std::string m_error;
+  bool m_parsed;
+  // The children of the open containers. When a container is closed, its
+  // children are copied into the arena.
+  std::vector<JsonNode> m_pending;
+  std::vector<Container> m_containers;
+
+  void Begin();
+  void End();
+  void String(const std::string &value);
+  void StringView(const char *data, size_t length);
+  void Number(uint32_t value);
+  void Number(int32_t value);
+  void Number(uint64_t value);
+  void Number(int64_t value);
+  void Number(const JsonDouble::DoubleRepresentation &rep);
+  void Number(double value);
+  void Bool(bool value);
+  void Null();
+  void OpenArray();
+  void CloseArray();
+  void OpenObject();
+  void ObjectKey(const std::string &key);
+  void ObjectKeyView(const char *data, size_t length);
+  void CloseObject();
+  void SetError(const std::string &error);
+
+  void AddNode(const JsonNode &node);
+  JsonNode MakeString(const char *data, size_t length);
+  void CloseContainer(bool is_object);
+
+  DISALLOW_COPY_AND_ASSIGN(JsonDocument);
+};
+/**@}*/
+}  // namespace web
+}  // namespace ola
+#endif  // INCLUDE_OLA_WEB_JSONDOCUMENT_H_
@@ -34,6 +34,7 @@
 #define INCLUDE_OLA_WEB_JSONLEXER_H_
 
 #include <ola/web/Json.h>
+#include <stddef.h>
 #include <string>
 
 namespace ola {
@@ -61,6 +62,14 @@ class JsonLexer {
    */
   static bool Parse(const std::string &input,
                     class JsonParserInterface *handler);
+
+  /**
+   * @brief Parse a NULL terminated string containing JSON data.
+   * @param input the input string
+   * @param handler the JsonParserInterface to pass tokens to.
+   * @return true if parsing was successful, false otherwise.
+   */
+  static bool Parse(const char *input, class JsonParserInterface *handler);
 };
 
 /**
@@ -90,6 +99,19 @@ class JsonParserInterface {
    */
   virtual void String(const std::string &value) = 0;
 
+  /**
+   * @brief Called when a string is encountered, without copying it.
+   * @param data the string data. This points into the input if the string
+   *   didn't contain escape sequences, otherwise to a temporary buffer. It's
+   *   only valid for the duration of the call.
+   * @param length the length of the string.
+   *
+   * The default implementation passes a copy to String().
+   */
+  virtual void StringView(const char *data, size_t length) {
+    String(std::string(data, length));
+  }
+
   /**
    * @brief Called when a uint32_t is encountered.
    */
@@ -159,6 +181,16 @@ class JsonParserInterface {
    */
   virtual void ObjectKey(const std::string &key) = 0;
 
+  /**
+   * @brief Called when a new key is encountered, without copying it.
+   *
+   * The data is valid for the duration of the call, see StringView(). The
+   * default implementation passes a copy to ObjectKey().
+   */
+  virtual void ObjectKeyView(const char *data, size_t length) {
+    ObjectKey(std::string(data, length));
+  }
+
   /**
    * @brief Called when an object completes.
    */
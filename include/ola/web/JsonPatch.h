@@ -32,6 +32,7 @@
 #include <ola/base/Macro.h>
 #include <ola/web/Json.h>
 #include <ola/web/JsonPointer.h>
+#include <stdint.h>
 #include <memory>
 #include <string>
 #include <vector>
@@ -47,19 +48,142 @@ namespace web {
 class JsonPatchSet;
 
 /**
- * @brief A class to serialize a JSONValue to text.
+ * @brief The path a patch operation acts on.
+ *
+ * The pointer to the parent and the final token are split out once, when the
+ * operation is created, so applying the operation only has to look up the
+ * parent.
+ */
+class JsonPatchPath {
+ public:
+  explicit JsonPatchPath(const JsonPointer &pointer);
+
+  bool IsValid() const { return m_pointer.IsValid(); }
+
+  /**
+   * @brief True if the path refers to the whole document.
+   */
+  bool IsRoot() const { return m_pointer.TokenCount() == 1; }
+
+  const JsonPointer &Pointer() const { return m_pointer; }
+  const JsonPointer &Parent() const { return m_parent; }
+
+  /**
+   * @brief The un-escaped final token, the object key or array index.
+   */
+  const std::string &Key() const { return m_key; }
+
+ private:
+  const JsonPointer m_pointer;
+  JsonPointer m_parent;
+  std::string m_key;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonPatchPath);
+};
+
+/**
+ * @brief Changes a JsonValue in place, in a way that can be undone.
+ *
+ * Values that are removed or replaced aren't deleted until Commit(), so
+ * Rollback() can put them back. The cost of either is proportional to the
+ * number of changes, not the size of the document.
+ *
+ * If neither Commit() nor Rollback() is called, the changes are rolled back
+ * when the transaction is destroyed.
+ */
+class JsonPatchTransaction {
+ public:
+  /**
+   * @brief Create a new transaction.
+   * @param root the value to change. The value may be replaced or set to NULL
+   *   by the changes.
+   */
+  explicit JsonPatchTransaction(JsonValue **root);
+  ~JsonPatchTransaction();
+
+  JsonValue *Root() { return *m_root; }
+
+  /**
+   * @brief Keep the changes, and delete any values that were removed.
+   */
+  void Commit();
+
+  /**
+   * @brief Undo the changes, and delete any values that were added.
+   */
+  void Rollback();
+
+  /**
+   * @name Changes
+   * Unless noted otherwise, ownership of the value is transferred if the
+   * change succeeds. If it doesn't, the value isn't touched.
+   * @{
+   */
+  void SetRoot(JsonValue *value);
+  void SetMember(JsonObject *object, const std::string &key, JsonValue *value);
+  bool ReplaceMember(JsonObject *object, const std::string &key,
+                     JsonValue *value);
+
+  /**
+   * @brief Remove a member from an object.
+   * @returns the removed value, or NULL if the key didn't exist. The value is
+   *   owned by the transaction, and may be added elsewhere in the document.
+   */
+  JsonValue *RemoveMember(JsonObject *object, const std::string &key);
+
+  /**
+   * @brief Insert an element, if the index is the size of the array the
+   *   value is appended.
+   */
+  bool InsertElement(JsonArray *array, uint32_t index, JsonValue *value);
+  bool ReplaceElement(JsonArray *array, uint32_t index, JsonValue *value);
+
+  /**
+   * @brief Remove an element from an array.
+   * @returns the removed value, or NULL if the index was out of range. The
+   *   value is owned by the transaction, and may be added elsewhere in the
+   *   document.
+   */
+  JsonValue *RemoveElement(JsonArray *array, uint32_t index);
+  /** @} */
+
+ private:
+  struct Change {
+    JsonObject *object;
+    JsonArray *array;
+    std::string key;
+    uint32_t index;
+    JsonValue *removed;
+    JsonValue *inserted;
+  };
+
+  typedef std::vector<Change> Changes;
+
+  JsonValue **m_root;
+  Changes m_changes;
+
+  void Undo(const Change &change);
+  void Finish(bool committed);
+
+  DISALLOW_COPY_AND_ASSIGN(JsonPatchTransaction);
+};
+
+/**
+ * @brief A single operation in a JSON patch.
  */
 class JsonPatchOp {
  public:
   virtual ~JsonPatchOp() {}
 
   /**
-   * @brief Apply the patch operation to the value.
-   * @param value A pointer to a JsonValue object. This may be modified,
-   * replaced or deleted entirely by the patch operation.
-   * @returns True if the patch was successfully applied, false otherwise.
+   * @brief Apply the patch operation.
+   * @param transaction The transaction to make the changes in. The root value
+   * may be modified, replaced or deleted entirely by the patch operation.
+   * @returns True if the patch was successfully applied, false otherwise. If
+   * false is returned some changes may have been made, the caller should
+   * roll back the transaction.
    */
-  virtual bool Apply(JsonValue **value) const = 0;
+  virtual bool Apply(JsonPatchTransaction *transaction) const = 0;
 };
 
 /**
@@ -73,14 +197,14 @@ class JsonPatchAddOp : public JsonPatchOp {
    * @param value the value to add, ownership is transferred.
    */
   JsonPatchAddOp(const JsonPointer &path, const JsonValue *value)
-      : m_pointer(path),
+      : m_path(path),
         m_value(value) {
   }
 
-  bool Apply(JsonValue **value) const;
+  bool Apply(JsonPatchTransaction *transaction) const;
 
  private:
-  JsonPointer m_pointer;
+  const JsonPatchPath m_path;
   std::auto_ptr<const JsonValue> m_value;
 
   DISALLOW_COPY_AND_ASSIGN(JsonPatchAddOp);
@@ -96,13 +220,13 @@ class JsonPatchRemoveOp : public JsonPatchOp {
    * @param path The path to remove.
    */
   explicit JsonPatchRemoveOp(const JsonPointer &path)
-      : m_pointer(path) {
+      : m_path(path) {
   }
 
-  bool Apply(JsonValue **value) const;
+  bool Apply(JsonPatchTransaction *transaction) const;
 
  private:
-  const JsonPointer m_pointer;
+  const JsonPatchPath m_path;
 
   DISALLOW_COPY_AND_ASSIGN(JsonPatchRemoveOp);
 };
@@ -118,14 +242,14 @@ class JsonPatchReplaceOp : public JsonPatchOp {
    * @param value The value to replace with, ownership is transferred.
    */
   JsonPatchReplaceOp(const JsonPointer &path, const JsonValue *value)
-      : m_pointer(path),
+      : m_path(path),
         m_value(value) {
   }
 
-  bool Apply(JsonValue **value) const;
+  bool Apply(JsonPatchTransaction *transaction) const;
 
  private:
-  const JsonPointer m_pointer;
+  const JsonPatchPath m_path;
   std::auto_ptr<const JsonValue> m_value;
 
   DISALLOW_COPY_AND_ASSIGN(JsonPatchReplaceOp);
@@ -133,6 +257,9 @@ class JsonPatchReplaceOp : public JsonPatchOp {
 
 /**
  * @brief Move a value from one location to another.
+ *
+ * The value is detached from its old location and added at the new one, it's
+ * not copied.
  */
 class JsonPatchMoveOp : public JsonPatchOp {
  public:
@@ -146,11 +273,11 @@ class JsonPatchMoveOp : public JsonPatchOp {
         m_to(to) {
   }
 
-  bool Apply(JsonValue **value) const;
+  bool Apply(JsonPatchTransaction *transaction) const;
 
  private:
-  JsonPointer m_from;
-  JsonPointer m_to;
+  const JsonPatchPath m_from;
+  const JsonPatchPath m_to;
 
   DISALLOW_COPY_AND_ASSIGN(JsonPatchMoveOp);
 };
@@ -170,11 +297,11 @@ class JsonPatchCopyOp : public JsonPatchOp {
       m_to(to) {
   }
 
-  bool Apply(JsonValue **value) const;
+  bool Apply(JsonPatchTransaction *transaction) const;
 
  private:
-  JsonPointer m_from;
-  JsonPointer m_to;
+  const JsonPatchPath m_from;
+  const JsonPatchPath m_to;
 
   DISALLOW_COPY_AND_ASSIGN(JsonPatchCopyOp);
 };
@@ -185,14 +312,14 @@ class JsonPatchCopyOp : public JsonPatchOp {
 class JsonPatchTestOp : public JsonPatchOp {
  public:
   JsonPatchTestOp(const JsonPointer &path, const JsonValue *value)
-      : m_pointer(path),
+      : m_path(path),
         m_value(value) {
   }
 
-  bool Apply(JsonValue **value) const;
+  bool Apply(JsonPatchTransaction *transaction) const;
 
  private:
-  JsonPointer m_pointer;
+  const JsonPatchPath m_path;
   std::auto_ptr<const JsonValue> m_value;
 
   DISALLOW_COPY_AND_ASSIGN(JsonPatchTestOp);
@@ -216,10 +343,18 @@ class JsonPatchSet {
   /**
    * @brief Apply this patch set to a value.
    *
+   * Either all of the operations are applied, or the value is left unchanged.
    * Don't call this directly, instead use JsonData::Apply().
    */
   bool Apply(JsonValue **value) const;
 
+  /**
+   * @brief Apply this patch set within a transaction.
+   * @returns true if all the operations were applied. If false is returned,
+   *   the transaction should be rolled back.
+   */
+  bool Apply(JsonPatchTransaction *transaction) const;
+
   bool Empty() const { return m_patch_ops.empty(); }
 
  private:
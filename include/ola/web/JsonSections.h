@@ -210,6 +210,7 @@ class JsonSection {
 
     void AddItem(const GenericItem *item);
     std::string AsString() const;
+    void Write(class JsonStreamWriter *writer) const;
 
  private:
     bool m_allow_refresh;
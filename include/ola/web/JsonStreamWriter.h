@@ -0,0 +1,196 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonStreamWriter.h
+ * Write JSON text without building a tree of JsonValues.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+/**
+ * @addtogroup json
+ * @{
+ * @file JsonStreamWriter.h
+ * @brief Write JSON text without building a tree of JsonValues.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_WEB_JSONSTREAMWRITER_H_
+#define INCLUDE_OLA_WEB_JSONSTREAMWRITER_H_
+
+#include <ola/base/Macro.h>
+#include <ola/web/Json.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace web {
+
+/**
+ * @addtogroup json
+ * @{
+ */
+
+/**
+ * @brief Write JSON text directly to a string as the values are produced.
+ *
+ * This avoids allocating a JsonValue for every node, which matters for large
+ * documents. The output is formatted the same way as JsonWriter, except that
+ * object properties are written in the order they're added, and an array is
+ * laid out one element per line if its first element is an object or array.
+ *
+ * @code
+ *   JsonStreamWriter writer(&output);
+ *   writer.StartObject();
+ *   writer.Add("id", 1);
+ *   writer.Key("uids");
+ *   writer.StartArray();
+ *   writer.Value("7a70:00000001");
+ *   writer.EndArray();
+ *   writer.EndObject();
+ * @endcode
+ *
+ * The caller is responsible for producing well formed JSON, i.e. each
+ * property value must be preceded by a call to Key(), and each StartObject()
+ * or StartArray() must be matched by an EndObject() or EndArray().
+ */
+class JsonStreamWriter : private JsonValueConstVisitorInterface,
+                                 JsonObjectPropertyVisitor {
+ public:
+  /**
+   * @brief Create a new JsonStreamWriter.
+   * @param output the string to append to, ownership is not transferred.
+   */
+  explicit JsonStreamWriter(std::string *output)
+      : m_output(output),
+        m_indent(0) {
+  }
+
+  void StartObject();
+  void EndObject();
+  void StartArray();
+  void EndArray();
+
+  /**
+   * @brief Write the name of the next property in the current object.
+   */
+  void Key(const std::string &key);
+
+  void Value(const std::string &value);
+  void Value(const char *value);
+  void Value(bool value);
+  void Value(unsigned int value);
+  void Value(int value);
+  void Value(uint64_t value);
+  void Value(int64_t value);
+  void Value(double value);
+  void Null();
+
+  /**
+   * @brief Write a string that's already valid JSON.
+   */
+  void RawValue(const std::string &value);
+
+  /**
+   * @brief Write a tree of JsonValues.
+   *
+   * This is useful when part of a document comes from code that builds a
+   * JsonObject.
+   */
+  void Value(const JsonValue &value);
+
+  /**
+   * @brief Add a property to the current object.
+   */
+  void Add(const std::string &key, const std::string &value) {
+    Key(key);
+    Value(value);
+  }
+
+  void Add(const std::string &key, const char *value) {
+    Key(key);
+    Value(value);
+  }
+
+  void Add(const std::string &key, unsigned int value) {
+    Key(key);
+    Value(value);
+  }
+
+  void Add(const std::string &key, int value) {
+    Key(key);
+    Value(value);
+  }
+
+  void Add(const std::string &key, double value) {
+    Key(key);
+    Value(value);
+  }
+
+  void Add(const std::string &key, bool value) {
+    Key(key);
+    Value(value);
+  }
+
+ private:
+  class Scope {
+   public:
+    Scope(bool is_object, bool complex_known, bool complex)
+        : is_object(is_object),
+          complex_known(complex_known),
+          complex(complex),
+          count(0) {
+    }
+
+    bool is_object;
+    // For arrays, true if the elements are written one per line. Unless the
+    // array came from a JsonArray, this is decided by the first element.
+    bool complex_known;
+    bool complex;
+    unsigned int count;
+  };
+
+  std::string *m_output;
+  unsigned int m_indent;
+  std::vector<Scope> m_scopes;
+
+  void BeforeValue(bool complex);
+  void OpenObject();
+  void OpenArray(bool complex_known, bool complex);
+  void OpenComplexArray();
+  void NewLine();
+
+  void Visit(const JsonString &value);
+  void Visit(const JsonBool &value);
+  void Visit(const JsonNull &value);
+  void Visit(const JsonRawValue &value);
+  void Visit(const JsonObject &value);
+  void Visit(const JsonArray &value);
+  void Visit(const JsonUInt &value);
+  void Visit(const JsonUInt64 &value);
+  void Visit(const JsonInt &value);
+  void Visit(const JsonInt64 &value);
+  void Visit(const JsonDouble &value);
+
+  void VisitProperty(const std::string &property, const JsonValue &value);
+
+  static const unsigned int DEFAULT_INDENT = 2;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonStreamWriter);
+};
+/**@}*/
+}  // namespace web
+}  // namespace ola
+#endif  // INCLUDE_OLA_WEB_JSONSTREAMWRITER_H_
@@ -1,7 +1,9 @@
 olawebincludedir = $(pkgincludedir)/web/
 olawebinclude_HEADERS = \
+    include/ola/web/CompiledSchema.h \
     include/ola/web/Json.h \
     include/ola/web/JsonData.h \
+    include/ola/web/JsonDocument.h \
     include/ola/web/JsonLexer.h \
     include/ola/web/JsonParser.h \
     include/ola/web/JsonPatch.h \
@@ -9,6 +11,7 @@ olawebinclude_HEADERS = \
     include/ola/web/JsonPointer.h \
     include/ola/web/JsonSchema.h \
     include/ola/web/JsonSections.h \
+    include/ola/web/JsonStreamWriter.h \
     include/ola/web/JsonTypes.h \
     include/ola/web/JsonWriter.h \
     include/ola/web/OptionalItem.h
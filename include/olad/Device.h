@@ -37,6 +37,7 @@ class RpcController;
 namespace ola {
 
 class AbstractPlugin;
+class PluginThread;
 
 /**
  * @brief The interface for a Device
@@ -86,6 +87,12 @@ class AbstractDevice {
                          const std::string &request,
                          std::string *response,
                          ConfigureCallback *done) = 0;
+
+  /**
+   * @brief The PluginThread this device runs on.
+   * @returns the PluginThread or NULL if the device runs on the main thread.
+   */
+  virtual PluginThread *GetPluginThread() const { return NULL; }
 };
 
 
@@ -104,6 +111,7 @@ class Device: public AbstractDevice {
 
   AbstractPlugin *Owner() const { return m_owner; }
   std::string UniqueId() const;
+  PluginThread *GetPluginThread() const { return m_plugin_thread; }
 
   /**
    * @brief The device ID
@@ -154,6 +162,7 @@ class Device: public AbstractDevice {
 
   bool m_enabled;
   AbstractPlugin *m_owner;  // which plugin owns this device
+  PluginThread *m_plugin_thread;  // the thread the device was created on
   std::string m_name;  // device name
   mutable std::string m_unique_id;  // device id
   input_port_map m_input_ports;
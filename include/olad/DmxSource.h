@@ -16,6 +16,7 @@
  * DmxSource.h
  * Interface for the DmxSource class.
  * A DmxSource contains a DmxSource as well as a priority & timestamp.
+ * Sources may also carry a priority for each slot.
  * Copyright (C) 2005 Simon Newton
  */
 
@@ -49,8 +50,19 @@ class DmxSource {
         m_priority(priority) {
     }
 
+    DmxSource(const DmxBuffer &buffer,
+              const TimeStamp &timestamp,
+              uint8_t priority,
+              const DmxBuffer &slot_priorities):
+        m_buffer(buffer),
+        m_slot_priorities(slot_priorities),
+        m_timestamp(timestamp),
+        m_priority(priority) {
+    }
+
     DmxSource(const DmxSource &other) {
       m_buffer = other.m_buffer;
+      m_slot_priorities = other.m_slot_priorities;
       m_timestamp = other.m_timestamp;
       m_priority = other.m_priority;
     }
@@ -62,6 +74,7 @@ class DmxSource {
     DmxSource& operator=(const DmxSource& other) {
       if (this != &other) {
         m_buffer = other.m_buffer;
+        m_slot_priorities = other.m_slot_priorities;
         m_timestamp = other.m_timestamp;
         m_priority = other.m_priority;
       }
@@ -73,6 +86,7 @@ class DmxSource {
      */
     bool operator==(const DmxSource &other) const {
       return (m_buffer == other.m_buffer &&
+              m_slot_priorities == other.m_slot_priorities &&
               m_timestamp == other.m_timestamp &&
               m_priority == other.m_priority);
     }
@@ -86,6 +100,28 @@ class DmxSource {
       m_buffer = buffer;
       m_timestamp = timestamp;
       m_priority = priority;
+      if (m_slot_priorities.Size()) {
+        m_slot_priorities = DmxBuffer();
+      }
+    }
+
+    /*
+     * Update the DmxSource with new data and a priority for each slot
+     */
+    void UpdateData(const DmxBuffer &buffer, const TimeStamp &timestamp,
+                    uint8_t priority, const DmxBuffer &slot_priorities) {
+      m_buffer = buffer;
+      m_slot_priorities = slot_priorities;
+      m_timestamp = timestamp;
+      m_priority = priority;
+    }
+
+    /*
+     * Mark the source as having received data, without changing the data.
+     * This keeps the source active.
+     */
+    void Refresh(const TimeStamp &timestamp) {
+      m_timestamp = timestamp;
     }
 
 
@@ -123,8 +159,21 @@ class DmxSource {
      */
     uint8_t Priority() const { return m_priority; }
 
+    /*
+     * Get the priority for each slot. This is empty if the source only has a
+     * universe priority. Slots past the end of the buffer have a priority of
+     * ola::dmx::SLOT_PRIORITY_NOT_SOURCED.
+     */
+    const DmxBuffer &SlotPriorities() const { return m_slot_priorities; }
+
+    /*
+     * Check if this source has a priority for each slot
+     */
+    bool HasSlotPriorities() const { return m_slot_priorities.Size() != 0; }
+
  private:
     DmxBuffer m_buffer;
+    DmxBuffer m_slot_priorities;
     TimeStamp m_timestamp;
     uint8_t m_priority;
 
@@ -1,8 +1,10 @@
 oladinclude_HEADERS = \
     include/olad/Device.h \
     include/olad/DmxSource.h \
+    include/olad/PixelMap.h \
     include/olad/Plugin.h \
     include/olad/PluginAdaptor.h \
+    include/olad/PluginModule.h \
     include/olad/Port.h \
     include/olad/PortBroker.h \
     include/olad/PortConstants.h \
@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelMap.h
+ * Assemble the data from many universes into a single frame.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_PIXELMAP_H_
+#define INCLUDE_OLAD_PIXELMAP_H_
+
+#include <stdint.h>
+#include <ola/Callback.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <olad/Port.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ola {
+
+/**
+ * @brief Assembles the DMX data of several universes into one frame.
+ *
+ * Outputs that drive a large pixel surface over one link, e.g. an SPI strip or
+ * an OPC channel, want a single frame rather than an update for each universe.
+ * A PixelMap is split into segments, one per universe, each of which is
+ * written by a PixelMapOutputPort.
+ *
+ * The frame is committed once every patched segment has been updated, so a
+ * source sending all the universes for a frame results in a single write. If
+ * a frame timeout is set, a partial frame is committed once the timeout
+ * expires, so a stalled universe doesn't hold up the rest of the surface.
+ */
+class PixelMap {
+ public:
+  /**
+   * @brief Run when a frame is committed, with the frame data and length.
+   */
+  typedef Callback2<void, const uint8_t*, unsigned int> FrameCallback;
+
+  struct Options {
+    /** @brief The number of segments / universes. */
+    unsigned int segments;
+    /**
+     * @brief The number of slots taken from each universe. 510 keeps RGB
+     * pixels from straddling universes.
+     */
+    unsigned int slots_per_segment;
+    /**
+     * @brief How long to wait, in ms, for the rest of a frame once the first
+     * segment has been updated. 0 means wait forever.
+     */
+    unsigned int frame_timeout;
+
+    Options()
+        : segments(1),
+          slots_per_segment(DEFAULT_SLOTS_PER_SEGMENT),
+          frame_timeout(DEFAULT_FRAME_TIMEOUT) {
+    }
+  };
+
+  /**
+   * @brief Create a new PixelMap.
+   * @param scheduler the scheduler to use for the frame timeout, may be NULL
+   *   if frame_timeout is 0.
+   * @param options the Options for the map.
+   * @param callback run each time a frame is committed, ownership is
+   *   transferred.
+   */
+  PixelMap(ola::thread::SchedulerInterface *scheduler,
+           const Options &options,
+           FrameCallback *callback);
+  ~PixelMap();
+
+  unsigned int Segments() const { return m_options.segments; }
+  unsigned int SlotsPerSegment() const { return m_options.slots_per_segment; }
+  unsigned int FrameSize() const { return m_frame.size(); }
+
+  /**
+   * @brief Mark a segment as active or not.
+   *
+   * Only active segments are waited on before a frame is committed. Segments
+   * are inactive until their port is patched.
+   */
+  void SetActive(unsigned int segment, bool active);
+
+  /**
+   * @brief Update the data for a segment.
+   * @returns false if the segment is out of range.
+   */
+  bool Update(unsigned int segment, const DmxBuffer &buffer);
+
+  /**
+   * @brief Commit the frame now, even if some segments haven't been updated.
+   */
+  void Commit();
+
+ private:
+  const Options m_options;
+  ola::thread::SchedulerInterface *m_scheduler;
+  std::auto_ptr<FrameCallback> m_callback;
+  std::vector<uint8_t> m_frame;
+  std::vector<bool> m_active;
+  std::vector<bool> m_updated;
+  unsigned int m_active_count;
+  unsigned int m_updated_count;
+  ola::thread::timeout_id m_timeout_id;
+
+  void FrameTimeout();
+  void CancelTimeout();
+
+  static const unsigned int DEFAULT_SLOTS_PER_SEGMENT = 510;
+  static const unsigned int DEFAULT_FRAME_TIMEOUT = 25;
+
+  DISALLOW_COPY_AND_ASSIGN(PixelMap);
+};
+
+
+/**
+ * @brief An OutputPort that writes to a segment of a PixelMap.
+ */
+class PixelMapOutputPort: public BasicOutputPort {
+ public:
+  /**
+   * @brief Create a new PixelMapOutputPort.
+   * @param parent the device this port belongs to.
+   * @param port_id the id of the port.
+   * @param pixel_map the PixelMap to write to, ownership is not transferred.
+   * @param segment the segment of the map this port writes.
+   */
+  PixelMapOutputPort(AbstractDevice *parent,
+                     unsigned int port_id,
+                     PixelMap *pixel_map,
+                     unsigned int segment);
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
+
+  void PostSetUniverse(Universe *old_universe, Universe *new_universe);
+
+  std::string Description() const;
+
+ private:
+  PixelMap* const m_pixel_map;
+  const unsigned int m_segment;
+
+  DISALLOW_COPY_AND_ASSIGN(PixelMapOutputPort);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_PIXELMAP_H_
@@ -45,6 +45,13 @@ class AbstractPlugin {
    */
   virtual bool LoadPreferences() = 0;
 
+  /**
+   * @brief Re-read the preferences for a plugin.
+   * @return true if the preferences have changed since they were loaded, in
+   *   which case the plugin needs to be restarted to use them.
+   */
+  virtual bool ReloadPreferences() = 0;
+
   /**
    * @brief The location for preferences.
    *
@@ -102,6 +109,14 @@ class AbstractPlugin {
 
   virtual void ConflictsWith(std::set<ola_plugin_id> *conflict_set) const = 0;
 
+  /**
+   * @brief Check if this plugin can be run on its own PluginThread.
+   * @return true if the plugin only uses the PluginAdaptor for I/O and
+   *   timers, doesn't start threads of its own and only registers devices from
+   *   Start() and Stop().
+   */
+  virtual bool SupportsThreading() const { return false; }
+
   // used to sort plugins
   virtual bool operator<(const AbstractPlugin &other) const = 0;
 };
@@ -126,6 +141,7 @@ class Plugin: public AbstractPlugin {
   virtual ~Plugin() {}
 
   bool LoadPreferences();
+  bool ReloadPreferences();
   std::string PreferenceConfigLocation() const;
   bool IsEnabled() const;
   void SetEnabledState(bool enable);
@@ -32,6 +32,7 @@
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
 #include <ola/io/SelectServerInterface.h>
+#include <ola/network/TransmitPacer.h>
 #include <olad/OlaServer.h>
 
 #include <string>
@@ -48,13 +49,16 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
    * @param preferences_factory pointer to the PreferencesFactory object
    * @param port_broker pointer to the PortBroker object
    * @param instance_name the instance name of this OlaServer
+   * @param transmit_pacer the TransmitPacer to use for network output, may
+   *   be NULL.
    */
   PluginAdaptor(class DeviceManager *device_manager,
                 ola::io::SelectServerInterface *select_server,
                 ExportMap *export_map,
                 class PreferencesFactory *preferences_factory,
                 class PortBrokerInterface *port_broker,
-                const std::string *instance_name);
+                const std::string *instance_name,
+                ola::network::TransmitPacer *transmit_pacer = NULL);
 
   // The following methods are part of the SelectServerInterface
   bool AddReadDescriptor(ola::io::ReadFileDescriptor *descriptor);
@@ -106,6 +110,10 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
    * @brief Register a device
    * @param device the device to register
    * @return true on success, false on error
+   *
+   * If the plugin is being started on its own thread without blocking the
+   * main thread, the device is registered once Start() returns and this
+   * always returns true.
    */
   bool RegisterDevice(class AbstractDevice *device) const;
 
@@ -125,6 +133,15 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
     return m_port_broker;
   }
 
+  /**
+   * @brief Return the TransmitPacer that network output plugins should send
+   *   with.
+   * @returns the TransmitPacer, or NULL if pacing is disabled. The pacer
+   *   runs on the main thread, so this is always NULL for plugins running on
+   *   their own thread.
+   */
+  ola::network::TransmitPacer *GetTransmitPacer() const;
+
   void DrainCallbacks();
 
  private:
@@ -134,6 +151,18 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
   class PreferencesFactory *m_preferences_factory;
   class PortBrokerInterface *m_port_broker;
   const std::string *m_instance_name;
+  ola::network::TransmitPacer *m_transmit_pacer;
+
+  /*
+   * The SelectServer for the calling thread. This is the PluginThread's
+   * SelectServer if the plugin is running on one.
+   */
+  ola::io::SelectServerInterface *SelectServer() const;
+
+  /*
+   * Returns true if it's safe to call into the DeviceManager.
+   */
+  bool CanAccessCore() const;
 
   DISALLOW_COPY_AND_ASSIGN(PluginAdaptor);
 };
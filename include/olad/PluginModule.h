@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginModule.h
+ * The entry points of a plugin that's built as a loadable module.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef INCLUDE_OLAD_PLUGINMODULE_H_
+#define INCLUDE_OLAD_PLUGINMODULE_H_
+
+#include <olad/Plugin.h>
+
+/**
+ * @brief The version of the plugin module interface.
+ *
+ * This is incremented whenever a change to AbstractPlugin, Plugin or
+ * PluginAdaptor means that a module built against an older version can't be
+ * used.
+ */
+#define OLA_PLUGIN_ABI_VERSION 1
+
+/**
+ * @brief The symbol that returns the ABI version of a module.
+ */
+#define OLA_PLUGIN_ABI_VERSION_SYMBOL "ola_plugin_abi_version"
+
+/**
+ * @brief The symbol that creates the plugin in a module.
+ */
+#define OLA_PLUGIN_CREATE_SYMBOL "ola_plugin_create"
+
+extern "C" {
+  typedef unsigned int ola_plugin_abi_version_t();
+  typedef ola::AbstractPlugin *ola_plugin_create_t(
+      ola::PluginAdaptor *plugin_adaptor);
+}
+
+/**
+ * @brief Export the entry points for a plugin module.
+ * @param plugin_class the plugin class, the constructor must take a
+ *   PluginAdaptor*.
+ *
+ * This should be used once in a module, outside any namespace.
+ *
+ * @examplepara
+ * @code
+ *   OLA_PLUGIN_MODULE(ola::plugin::dummy::DummyPlugin)
+ * @endcode
+ */
+#define OLA_PLUGIN_MODULE(plugin_class) \
+  extern "C" unsigned int ola_plugin_abi_version() { \
+    return OLA_PLUGIN_ABI_VERSION; \
+  } \
+  extern "C" ola::AbstractPlugin *ola_plugin_create( \
+      ola::PluginAdaptor *plugin_adaptor) { \
+    return new plugin_class(plugin_adaptor); \
+  }
+
+#endif  // INCLUDE_OLAD_PLUGINMODULE_H_
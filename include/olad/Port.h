@@ -29,8 +29,10 @@
 #include <olad/DmxSource.h>
 #include <olad/PluginAdaptor.h>
 #include <olad/PortConstants.h>
+#include <olad/TokenBucket.h>
 #include <olad/Universe.h>
 
+#include <memory>
 #include <string>
 
 namespace ola {
@@ -177,6 +179,12 @@ class OutputPort: public Port, ola::rdm::DiscoverableRDMControllerInterface {
    */
   virtual void UniverseNameChanged(const std::string &new_name) = 0;
 
+  /**
+   * @brief The maximum number of frames per second this port sends.
+   * @return the rate, or 0 if there's no limit.
+   */
+  virtual unsigned int MaxFrameRate() const = 0;
+
   // Methods from DiscoverableRDMControllerInterface
   // Ownership of the request object is transferred
   virtual void SendRDMRequest(ola::rdm::RDMRequest *request,
@@ -220,8 +228,23 @@ class BasicInputPort: public InputPort {
    * @brief Called when there is new data for this port
    */
   void DmxChanged();
+
+  /**
+   * @brief Called when there is new data for this port.
+   * @param received the time the data arrived, on the same clock as
+   *   PluginAdaptor::WakeUpTime().
+   */
+  void DmxChangedAt(const TimeStamp &received);
   const DmxSource &SourceData() const { return m_dmx_source; }
 
+  /**
+   * @brief Update the data for this port and notify the universe.
+   * @param source the new data.
+   *
+   * This is used to pass data from a PluginThread to the main thread.
+   */
+  void UpdateSource(const DmxSource &source);
+
   // RDM methods, the child class provides HandleRDMResponse
   /**
    * @brief Handle an RDM Request on this port.
@@ -250,6 +273,9 @@ class BasicInputPort: public InputPort {
     return ola::dmx::SOURCE_PRIORITY_MIN;
   }
 
+  // Get the inherited slot priorities, or NULL if the port doesn't have any.
+  virtual const DmxBuffer *InheritedSlotPriorities() const { return NULL; }
+
   // override this to cancel the SetUniverse operation.
   virtual bool PreSetUniverse(Universe *, Universe *) { return true; }
 
@@ -271,6 +297,21 @@ class BasicInputPort: public InputPort {
   DmxSource m_dmx_source;
   const PluginAdaptor *m_plugin_adaptor;
   bool m_supports_rdm;
+  // Frames received & how many of those matched the previous frame.
+  ShardedCounter *m_frames_var;
+  ShardedCounter *m_unchanged_frames_var;
+
+  static const char K_INPUT_FRAMES_VAR[];
+  static const char K_INPUT_UNCHANGED_FRAMES_VAR[];
+
+  bool RefreshIfUnchanged(const DmxBuffer &buffer,
+                          const TimeStamp &received,
+                          uint8_t priority,
+                          const DmxBuffer *slot_priorities);
+  void SendRDMRequestToBroker(ola::rdm::RDMRequest *request,
+                              ola::rdm::RDMCallback *callback);
+  void RunRDMDiscovery(ola::rdm::RDMDiscoveryCallback *on_complete,
+                       bool full);
 
   DISALLOW_COPY_AND_ASSIGN(BasicInputPort);
 };
@@ -324,6 +365,8 @@ class BasicOutputPort: public OutputPort {
   virtual void RunIncrementalDiscovery(
       ola::rdm::RDMDiscoveryCallback *on_complete);
 
+  virtual unsigned int MaxFrameRate() const { return 0; }
+
   // TimeCode
   virtual bool SupportsTimeCode() const { return false; }
 
@@ -359,10 +402,67 @@ class BasicOutputPort: public OutputPort {
   AbstractDevice *m_device;
   bool m_supports_rdm;
 
+  void NewUIDList(ola::rdm::UIDSet *uids);
+
   DISALLOW_COPY_AND_ASSIGN(BasicOutputPort);
 };
 
 
+/**
+ * @brief An OutputPort that limits the rate it sends frames at.
+ *
+ * Some receivers can't keep up with the rate olad can produce frames at. This
+ * paces the frames with a TokenBucket. Frames that arrive too soon are held,
+ * a newer frame replaces any held one, and the held frame is sent once the
+ * rate allows, so the last frame of a burst is never lost.
+ *
+ * Subclasses implement SendDMX() rather than WriteDMX().
+ */
+class RateLimitedOutputPort: public BasicOutputPort {
+ public:
+  /**
+   * @brief Create a new RateLimitedOutputPort.
+   * @param parent the device this port belongs to.
+   * @param port_id the id of the port.
+   * @param ss the SelectServerInterface to use for the time and the flush
+   *   timeout, normally the PluginAdaptor.
+   * @param max_frame_rate the maximum frames per second, 0 means no limit.
+   */
+  RateLimitedOutputPort(AbstractDevice *parent,
+                        unsigned int port_id,
+                        ola::io::SelectServerInterface *ss,
+                        unsigned int max_frame_rate,
+                        bool start_rdm_discovery_on_patch = false,
+                        bool supports_rdm = false);
+  virtual ~RateLimitedOutputPort();
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
+
+  virtual unsigned int MaxFrameRate() const { return m_max_frame_rate; }
+
+ protected:
+  /**
+   * @brief Send a frame, this is called at most max_frame_rate times a
+   * second.
+   */
+  virtual bool SendDMX(const DmxBuffer &buffer, uint8_t priority) = 0;
+
+ private:
+  ola::io::SelectServerInterface *m_ss;
+  const unsigned int m_max_frame_rate;
+  std::auto_ptr<TokenBucket> m_bucket;
+  DmxBuffer m_pending_buffer;
+  uint8_t m_pending_priority;
+  bool m_pending;
+  ola::thread::timeout_id m_flush_timeout;
+
+  void ScheduleFlush();
+  void Flush();
+
+  DISALLOW_COPY_AND_ASSIGN(RateLimitedOutputPort);
+};
+
+
 /**
  * @brief This allows switching based on Port type.
  */
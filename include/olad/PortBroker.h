@@ -30,13 +30,15 @@
 #include <ola/Callback.h>
 #include <olad/Universe.h>
 #include <olad/Port.h>
-#include <set>
+#include <memory>
 #include <string>
-#include <utility>
 #include <vector>
 
 namespace ola {
 
+class PendingRequest;
+template <typename Owner> class PendingRequestTracker;
+
 class PortBrokerInterface {
  public:
     PortBrokerInterface() {}
@@ -52,25 +54,29 @@ class PortBrokerInterface {
 
 class PortBroker: public PortBrokerInterface {
  public:
-    PortBroker() {}
-    ~PortBroker() {}
+    PortBroker();
+    ~PortBroker();
 
     void AddPort(const Port *port);
     void RemovePort(const Port *port);
 
+    /**
+     * @brief The number of RDM calls in flight for a port.
+     */
+    unsigned int PendingRequests(const Port *port) const;
+
     void SendRDMRequest(const Port *port,
                         Universe *universe,
                         ola::rdm::RDMRequest *request,
                         ola::rdm::RDMCallback *callback);
 
  private:
-    typedef std::pair<std::string, const Port*> port_key;
-
-    void RequestComplete(port_key key,
-                         ola::rdm::RDMCallback *callback,
-                         ola::rdm::RDMReply *reply);
+    // These may run after the broker is destroyed.
+    static void RequestComplete(PendingRequest *pending_request,
+                                ola::rdm::RDMCallback *callback,
+                                ola::rdm::RDMReply *reply);
 
-    std::set<port_key> m_ports;
+    std::auto_ptr<PendingRequestTracker<Port> > m_ports;
 
     DISALLOW_COPY_AND_ASSIGN(PortBroker);
 };
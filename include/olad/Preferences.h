@@ -29,6 +29,8 @@
 // to be after WinSock2.h, hence this order
 #include <ola/thread/Thread.h>
 
+#include <time.h>
+
 #include <map>
 #include <vector>
 #include <set>
@@ -184,6 +186,14 @@ class Preferences {
    */
   virtual void Clear() = 0;
 
+  /**
+   * @brief Reload the preferences from storage, replacing the values in
+   *   memory.
+   * @returns true if the values changed, false if they're the same or the
+   *   preferences couldn't be reloaded.
+   */
+  virtual bool Reload() { return false; }
+
   /**
    * @brief The location of where these preferences are stored.
    * @return the location
@@ -453,23 +463,63 @@ class MemoryPreferencesFactory: public PreferencesFactory {
 
 
 /**
- * The thread that saves preferences
+ * @brief The preferences read from a snapshot file.
+ *
+ * A snapshot holds the contents of all the ola-*.conf files, so they can be
+ * loaded at startup with a single read.
+ */
+struct PreferencesSnapshot {
+  typedef std::multimap<std::string, std::string> PreferencesMap;
+  // Keyed by the name of the config file, e.g. ola-artnet.conf
+  typedef std::map<std::string, PreferencesMap> FileMap;
+
+  PreferencesSnapshot() : modified(0) {}
+
+  FileMap files;
+  time_t modified;
+};
+
+
+/**
+ * The thread that saves preferences.
+ *
+ * Saves are coalesced, if a file is saved again before it's been written only
+ * the latest contents are written. Files are written to a temporary file and
+ * then renamed so a partial file is never left behind.
  */
 class FilePreferenceSaverThread: public ola::thread::Thread {
  public:
   typedef std::multimap<std::string, std::string> PreferencesMap;
-  FilePreferenceSaverThread();
+
+  /**
+   * @brief Create a new FilePreferenceSaverThread.
+   * @param save_delay_ms how long to wait after a save is requested before
+   *   writing the files.
+   */
+  explicit FilePreferenceSaverThread(
+      unsigned int save_delay_ms = DEFAULT_SAVE_DELAY_MS);
 
   void SavePreferences(const std::string &filename,
                        const PreferencesMap &preferences);
 
+  /**
+   * @brief Also write all the preferences to a single snapshot file.
+   * @param filename the snapshot file.
+   * @param snapshot the existing snapshot, these entries are kept until they
+   *   are replaced.
+   *
+   * This must be called before the thread is started.
+   */
+  void EnableSnapshot(const std::string &filename,
+                      const PreferencesSnapshot &snapshot);
+
   /**
    * Called by the new thread.
    */
   void *Run();
 
   /**
-   * Stop the saving thread
+   * Stop the saving thread, any pending saves are written first.
    */
   bool Join(void *ptr = NULL);
 
@@ -480,8 +530,21 @@ class FilePreferenceSaverThread: public ola::thread::Thread {
    */
   void Synchronize();
 
+  static const unsigned int DEFAULT_SAVE_DELAY_MS = 500;
+
  private:
+  typedef std::map<std::string, PreferencesMap> FileMap;
+
   ola::io::SelectServer m_ss;
+  const unsigned int m_save_delay_ms;
+  ola::thread::Mutex m_mutex;
+  FileMap m_pending;  // protected by m_mutex
+  bool m_save_scheduled;  // protected by m_mutex
+  std::string m_snapshot_file;
+  PreferencesSnapshot::FileMap m_snapshot;
+
+  void ScheduleSave();
+  void WritePending();
 
   /**
    * Notify the blocked thread we're done
@@ -496,15 +559,27 @@ class FilePreferenceSaverThread: public ola::thread::Thread {
  */
 class FileBackedPreferences: public MemoryPreferences {
  public:
+  /**
+   * @brief Create a new FileBackedPreferences.
+   * @param directory the directory the config file is in.
+   * @param name the name of the preferences.
+   * @param saver_thread the thread used to save the preferences.
+   * @param snapshot if not NULL, Load() uses the entry from this snapshot,
+   *   unless the config file has been modified since the snapshot was
+   *   written.
+   */
   explicit FileBackedPreferences(const std::string &directory,
                                  const std::string &name,
-                                 FilePreferenceSaverThread *saver_thread)
+                                 FilePreferenceSaverThread *saver_thread,
+                                 const PreferencesSnapshot *snapshot = NULL)
       : MemoryPreferences(name),
         m_directory(directory),
-        m_saver_thread(saver_thread) {}
+        m_saver_thread(saver_thread),
+        m_snapshot(snapshot) {}
 
   virtual bool Load();
   virtual bool Save() const;
+  virtual bool Reload();
 
   /**
    * @brief Load these preferences from a file
@@ -517,8 +592,10 @@ class FileBackedPreferences: public MemoryPreferences {
  private:
   const std::string m_directory;
   FilePreferenceSaverThread *m_saver_thread;
+  const PreferencesSnapshot *m_snapshot;
 
   bool ChangeDir() const;
+  bool LoadFromSnapshot();
 
   /**
    * Return the name of the file used to save the preferences
@@ -531,10 +608,14 @@ class FileBackedPreferences: public MemoryPreferences {
 
 class FileBackedPreferencesFactory: public PreferencesFactory {
  public:
-  explicit FileBackedPreferencesFactory(const std::string &directory)
-      : m_directory(directory) {
-    m_saver_thread.Start();
-  }
+  /**
+   * @brief Create a new FileBackedPreferencesFactory.
+   * @param directory the directory to store the config files in.
+   * @param use_snapshot if true, all the preferences are also written to a
+   *   single snapshot file, which is used to load the preferences at startup.
+   */
+  explicit FileBackedPreferencesFactory(const std::string &directory,
+                                        bool use_snapshot = false);
 
   ~FileBackedPreferencesFactory() {
     m_saver_thread.Join();
@@ -542,12 +623,17 @@ class FileBackedPreferencesFactory: public PreferencesFactory {
 
   virtual std::string ConfigLocation() const { return m_directory; }
 
+  static const char SNAPSHOT_FILE[];
+
  private:
   const std::string m_directory;
+  const bool m_use_snapshot;
+  PreferencesSnapshot m_snapshot;
   FilePreferenceSaverThread m_saver_thread;
 
   FileBackedPreferences *Create(const std::string &name) {
-    return new FileBackedPreferences(m_directory, name, &m_saver_thread);
+    return new FileBackedPreferences(m_directory, name, &m_saver_thread,
+                                     m_use_snapshot ? &m_snapshot : NULL);
   }
 };
 }  // namespace ola
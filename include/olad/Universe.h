@@ -29,9 +29,11 @@
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/rdm/UID.h>
 #include <ola/rdm/UIDSet.h>
+#include <ola/thread/SchedulerInterface.h>
 #include <ola/util/SequenceNumber.h>
 #include <olad/DmxSource.h>
 
+#include <memory>
 #include <set>
 #include <map>
 #include <vector>
@@ -40,8 +42,13 @@
 namespace ola {
 
 class Client;
+class DiscoveryScheduler;
+class FrameClock;
+class FrameHistory;
 class InputPort;
+class InputTrace;
 class OutputPort;
+class RDMResponderStats;
 
 class Universe: public ola::rdm::RDMControllerInterface {
  public:
@@ -50,6 +57,48 @@ class Universe: public ola::rdm::RDMControllerInterface {
       MERGE_LTP
     };
 
+    /**
+     * The UIDs on each output port, keyed by the port's unique id.
+     */
+    typedef std::map<std::string, ola::rdm::UIDSet> PortUIDMap;
+
+    /**
+     * Counters for the data flowing through the universe. These are updated
+     * as frames are merged & sent, so reading them is cheap.
+     */
+    typedef struct {
+      uint64_t input_frames;  // updates from ports & source clients
+      uint64_t output_frames;  // frames sent to the output ports & sinks
+      uint64_t changed_slots;  // slots that changed, over all output frames
+      unsigned int last_changed_slots;  // slots changed in the last frame
+      unsigned int active_sources;  // sources at the active priority
+      uint64_t merge_time_us;  // total time spent merging the sources
+      TimeStamp last_input_time;  // monotonic
+      TimeStamp last_output_time;  // monotonic
+    } Stats;
+
+    /**
+     * Limits the updates sent to a sink client. The defaults send every frame
+     * in full.
+     */
+    struct SinkOptions {
+      unsigned int slot_offset;  // the first slot to send
+      unsigned int slot_count;  // 0 sends all the slots after slot_offset
+      unsigned int max_rate;  // updates per second, 0 for no limit
+      bool changes_only;  // skip updates if the slots haven't changed
+
+      SinkOptions()
+          : slot_offset(0),
+            slot_count(0),
+            max_rate(0),
+            changes_only(false) {
+      }
+
+      bool IsDefault() const {
+        return !(slot_offset || slot_count || max_rate || changes_only);
+      }
+    };
+
     Universe(unsigned int uid, class UniverseStore *store,
              ExportMap *export_map,
              Clock *clock);
@@ -78,10 +127,59 @@ class Universe: public ola::rdm::RDMControllerInterface {
       return m_last_discovery_time;
     }
 
+    /**
+     * @brief Get the number of RDM requests sent on this universe.
+     *
+     * This wraps, it's used to tell if there have been any requests since it
+     * was last checked.
+     */
+    unsigned int RDMRequestCount() const { return m_rdm_request_count; }
+
+    /**
+     * @brief Get the latency & reliability stats for the responders on this
+     *   universe.
+     *
+     * The outcome of each unicast request sent with SendRDMRequest() is
+     * recorded, until the responder is no longer discovered.
+     */
+    const RDMResponderStats &RDMStats() const { return *m_rdm_stats; }
+
     // Used to adjust the properties
     void SetName(const std::string &name);
     void SetMergeMode(merge_mode merge_mode);
 
+    /**
+     * @brief Set a merge profile, which LTP merges some slots and HTP merges
+     * the rest.
+     *
+     * This lets fixtures which mix intensity channels with position & colour
+     * channels be merged without a separate merging client. While a profile
+     * is set, it's used instead of the MergeMode().
+     * @param ltp_slots the slots, starting from 0, which take their value
+     *   from the newest source. The other slots are HTP merged. If this is
+     *   empty, the profile is removed.
+     */
+    void SetLTPSlots(const std::vector<unsigned int> &ltp_slots);
+
+    /**
+     * @brief Get the slots which are LTP merged by the merge profile.
+     * @param[out] ltp_slots the LTP slots, in order. This is empty if there
+     *   isn't a profile.
+     */
+    void LTPSlots(std::vector<unsigned int> *ltp_slots) const;
+
+    bool HasMergeProfile() const { return m_ltp_mask.Size() != 0; }
+
+    /**
+     * @brief Merge all the sources again and send the result to the ports and
+     * clients.
+     *
+     * This is used once the ports or merge mode of the universe have changed,
+     * so the output reflects the new configuration without waiting for new
+     * data.
+     */
+    void Remerge();
+
     /**
      * Set the time between periodic RDM discovery operations.
      */
@@ -89,10 +187,108 @@ class Universe: public ola::rdm::RDMControllerInterface {
       m_rdm_discovery_interval = discovery_interval;
     }
 
+    /**
+     * @brief Set the scheduler used to delay output.
+     *
+     * Without a scheduler, the output rate limit and coalescing window are
+     * ignored and every change is sent immediately.
+     * @param scheduler the scheduler to use, ownership is not transferred.
+     */
+    void SetOutputScheduler(ola::thread::SchedulerInterface *scheduler) {
+      m_scheduler = scheduler;
+    }
+
+    /**
+     * @brief Use a cached time when checking if sources have timed out.
+     *
+     * Merging happens for every frame, so rather than reading the clock each
+     * time this can use the time the SelectServer woke up.
+     * @param wake_up_time the time to use, usually from
+     *   SelectServerInterface::WakeUpTime(). If NULL, the clock is used.
+     */
+    void SetWakeUpTime(const TimeStamp *wake_up_time) {
+      m_wake_up_time = wake_up_time;
+    }
+
+    /**
+     * @brief Set the scheduler used to run RDM discovery on the output ports.
+     *
+     * Without a scheduler, discovery starts on all ports immediately.
+     * @param scheduler the scheduler to use, ownership is not transferred.
+     */
+    void SetDiscoveryScheduler(DiscoveryScheduler *scheduler) {
+      m_discovery_scheduler = scheduler;
+    }
+
+    /**
+     * @brief Limit the rate at which frames are sent to the output ports and
+     * sink clients.
+     * @param frames_per_second the maximum output rate, 0 means no limit.
+     */
+    void SetMaxOutputRate(unsigned int frames_per_second);
+    unsigned int MaxOutputRate() const { return m_max_output_rate; }
+
+    /**
+     * @brief Set the time to wait for further changes before sending a frame.
+     *
+     * All changes received within the window are sent as a single frame.
+     * @param window the coalescing window, a zero interval disables it.
+     */
+    void SetCoalescingWindow(const TimeInterval &window) {
+      m_coalescing_window = window;
+    }
+    const TimeInterval& CoalescingWindow() const {
+      return m_coalescing_window;
+    }
+
+    /**
+     * @brief Send frames on the ticks of a FrameClock.
+     *
+     * While a clock is set, the output rate limit and coalescing window are
+     * ignored, the clock sets the rate. A pending frame is sent immediately
+     * when the clock is changed.
+     * @param frame_clock the clock to use, ownership is not transferred. NULL
+     *   sends each frame as it changes.
+     */
+    void SetFrameClock(FrameClock *frame_clock);
+    FrameClock *GetFrameClock() const { return m_frame_clock; }
+
+    /**
+     * @brief Called by the FrameClock on each tick that we have a frame
+     *   pending for.
+     */
+    void SendFrameOnTick();
+
+    /**
+     * @brief Record the frames this universe sends.
+     * @param frame_history the FrameHistory to add the frames to, ownership
+     *   is not transferred. May be NULL.
+     */
+    void SetFrameHistory(FrameHistory *frame_history) {
+      m_frame_history = frame_history;
+    }
+
+    /**
+     * @brief Record the updates this universe receives.
+     * @param input_trace the InputTrace to write the updates to, ownership
+     *   is not transferred. May be NULL.
+     */
+    void SetInputTrace(InputTrace *input_trace) {
+      m_input_trace = input_trace;
+    }
+
     // Each universe has a DMXBuffer
     bool SetDMX(const DmxBuffer &buffer);
     const DmxBuffer &GetDMX() const { return m_buffer; }
 
+    /*
+     * The priority of each slot in the merged data. This is empty unless one
+     * of the active sources has slot priorities.
+     */
+    const DmxBuffer &SlotPriorities() const { return m_slot_priorities; }
+
+    const Stats &GetStats() const { return m_stats; }
+
     // These are the ports we need to notify when data changes
     bool AddPort(InputPort *port);
     bool AddPort(OutputPort *port);
@@ -112,13 +308,36 @@ class Universe: public ola::rdm::RDMControllerInterface {
     unsigned int SourceClientCount() const { return m_source_clients.size(); }
 
     // Sink clients are those that we need to send data
-    bool AddSinkClient(Client *client);
+    /**
+     * @brief Add a sink client.
+     * @param client the client to send the frames to.
+     * @param options limits the updates sent to the client. If the client is
+     *   already a sink, its options are replaced.
+     * @returns true if the client was added, false if it was already a sink.
+     */
+    bool AddSinkClient(Client *client,
+                       const SinkOptions &options = SinkOptions());
     bool RemoveSinkClient(Client *client);
     bool ContainsSinkClient(Client *client) const;
     unsigned int SinkClientCount() const { return m_sink_clients.size(); }
 
+    /**
+     * @brief Check if this universe has any source or sink clients.
+     */
+    bool HasClients() const {
+      return !(m_source_clients.empty() && m_sink_clients.empty());
+    }
+
     // These are called when new data arrives on a port/client
     bool PortDataChanged(InputPort *port);
+    /**
+     * @brief Called when a port received the same data as last time.
+     *
+     * The port has already refreshed the timestamp of its source. The merge
+     * is skipped if the last merge used this port and the other sources it
+     * used are still active, otherwise this is the same as PortDataChanged().
+     */
+    bool PortDataRefreshed(InputPort *port);
     bool SourceClientDataChanged(Client *client);
 
     // This is can be called periodically to clean stale clients
@@ -135,22 +354,53 @@ class Universe: public ola::rdm::RDMControllerInterface {
     unsigned int UIDCount() const;
     uint8_t GetRDMTransactionNumber();
 
+    /**
+     * @brief Restore the state the universe had before olad was restarted.
+     *
+     * The DMX data is sent to each output port as it's added, until a source
+     * sends new data. The UIDs for a port are used until discovery on the
+     * port completes, and an incremental discovery is run when the port is
+     * added to check they are still there.
+     * @param buffer the last DMX data for the universe.
+     * @param port_uids the UIDs on each output port.
+     */
+    void RestoreState(const DmxBuffer &buffer, const PortUIDMap &port_uids);
+
+    /**
+     * @brief Get the UIDs on each output port.
+     *
+     * This includes restored UIDs for ports that haven't been added yet.
+     * @param[out] port_uids the map to add the UIDs to.
+     */
+    void GetPortUIDs(PortUIDMap *port_uids) const;
+
     bool operator==(const Universe &other) {
       return m_universe_id == other.UniverseId();
     }
 
     static const char K_FPS_VAR[];
+    static const char K_COALESCED_FRAMES_VAR[];
     static const char K_MERGE_HTP_STR[];
     static const char K_MERGE_LTP_STR[];
     static const char K_UNIVERSE_INPUT_PORT_VAR[];
     static const char K_UNIVERSE_MODE_VAR[];
     static const char K_UNIVERSE_NAME_VAR[];
+    static const char K_UNIVERSE_OUTPUT_RATE_VAR[];
     static const char K_UNIVERSE_OUTPUT_PORT_VAR[];
+    static const char K_UNIVERSE_RDM_DISCOVERY_TIME_VAR[];
     static const char K_UNIVERSE_RDM_REQUESTS[];
     static const char K_UNIVERSE_SINK_CLIENTS_VAR[];
     static const char K_UNIVERSE_SOURCE_CLIENTS_VAR[];
     static const char K_UNIVERSE_UID_COUNT_VAR[];
 
+    /**
+     * The number of buckets in the dwell time histogram. The dwell time is
+     * how long data from an input port waits before it's written to the
+     * output ports & clients.
+     */
+    static const unsigned int K_DWELL_TIME_BUCKETS = 9;
+    static const char *K_DWELL_TIME_VARS[K_DWELL_TIME_BUCKETS];
+
  private:
     typedef struct {
       unsigned int expected_count;
@@ -160,45 +410,141 @@ class Universe: public ola::rdm::RDMControllerInterface {
       std::vector<rdm::RDMFrame> frames;
     } broadcast_request_tracker;
 
-    typedef std::map<Client*, bool> SourceClientMap;
+    /**
+     * A source client. The data is owned by the client and is NULL until the
+     * client sends data for this universe.
+     */
+    typedef struct {
+      Client *client;
+      const DmxSource *source;
+      bool stale;  // true if it hasn't sent data since the last clean
+    } source_client;
 
-    std::string m_universe_name;
+    typedef std::vector<source_client> SourceClientList;
+
+    /**
+     * A source that took part in the last merge, and the data it held at the
+     * time. The owner is either an InputPort or a Client.
+     */
+    typedef struct {
+      const void *owner;
+      DmxSource source;
+    } merge_source;
+
+    typedef std::vector<merge_source> MergeSourceList;
+
+    // The sink clients with non default SinkOptions.
+    struct FilteredSink;
+    typedef std::map<Client*, FilteredSink*> FilteredSinkMap;
+
+    // The state used for every merge & output frame is kept together, and
+    // in vectors rather than node based containers, so merging walks as few
+    // cache lines as possible.
+    std::vector<InputPort*> m_input_ports;
+    SourceClientList m_source_clients;
+    std::vector<OutputPort*> m_output_ports;
+    std::vector<Client*> m_sink_clients;  // clients that require updates
+    FilteredSinkMap m_filtered_sinks;
+    // The sources used to build m_buffer, kept between calls to MergeAll() so
+    // we only need to re-merge the slots that changed.
+    MergeSourceList m_merge_sources;
+    MergeSourceList m_active_sources;  // scratch space, reused by MergeAll()
+    DmxBuffer m_buffer;
     unsigned int m_universe_id;
-    std::string m_universe_id_str;
     uint8_t m_active_priority;
     enum merge_mode m_merge_mode;  // merge mode
-    std::vector<InputPort*> m_input_ports;
-    std::vector<OutputPort*> m_output_ports;
-    std::set<Client*> m_sink_clients;  // clients that require updates
-    /**
-     * Tracks current source clients and whether or not they are stale.
-     * true == stale and can be removed, false == active is to be kept
-     */
-    SourceClientMap m_source_clients;
+    Clock *m_clock;
+    const TimeStamp *m_wake_up_time;
+
+    std::string m_universe_name;
+    std::string m_universe_id_str;
     class UniverseStore *m_universe_store;
-    DmxBuffer m_buffer;
     ExportMap *m_export_map;
     std::map<ola::rdm::UID, OutputPort*> m_output_uids;
-    Clock *m_clock;
     TimeInterval m_rdm_discovery_interval;
     TimeStamp m_last_discovery_time;
+    unsigned int m_rdm_request_count;
+    std::auto_ptr<RDMResponderStats> m_rdm_stats;
     ola::SequenceNumber<uint8_t> m_transaction_number_sequence;
+    DmxBuffer m_merge_buffer;  // scratch space for full HTP merges
+    DmxBuffer m_slot_priorities;
+    // 0xff for each slot which the merge profile LTP merges, 0 for the slots
+    // it HTP merges. This is empty if there isn't a profile.
+    DmxBuffer m_ltp_mask;
+    TimeStamp m_last_update_time;
+    ola::thread::SchedulerInterface *m_scheduler;
+    DiscoveryScheduler *m_discovery_scheduler;
+    unsigned int m_max_output_rate;
+    TimeInterval m_coalescing_window;
+    ola::thread::timeout_id m_output_timeout;  // set if a frame is pending
+    FrameClock *m_frame_clock;
+    bool m_frame_clock_pending;  // true if we're waiting for a tick
+    FrameHistory *m_frame_history;
+    InputTrace *m_input_trace;
+    // The source that caused the last merge, only set if there's a history.
+    std::string m_last_source;
+    TimeStamp m_last_output_time;
+    // The last frame sent, used to count the changed slots.
+    DmxBuffer m_last_output;
+    Stats m_stats;
+    // When the oldest input port data that hasn't been written yet arrived.
+    TimeStamp m_pending_input_time;
+    // True while m_buffer holds restored data that no source has replaced.
+    bool m_restored_dmx;
+    // Restored UIDs for the ports which haven't been added or discovered yet.
+    PortUIDMap m_restored_uids;
+    // The list of universes with clients, this is maintained by the
+    // UniverseStore.
+    Universe *m_prev_with_clients;
+    Universe *m_next_with_clients;
+
+    static const TimeInterval K_UNCHANGED_REFRESH_INTERVAL;
+    static const unsigned int K_DWELL_TIME_LIMITS_US[K_DWELL_TIME_BUCKETS - 1];
 
     void HandleBroadcastAck(broadcast_request_tracker *tracker,
                             ola::rdm::RDMReply *reply);
     void HandleBroadcastDiscovery(broadcast_request_tracker *tracker,
                                   ola::rdm::RDMReply *reply);
+    void HandleUnicastResponse(ola::rdm::UID uid,
+                               TimeStamp start_time,
+                               ola::rdm::RDMCallback *callback,
+                               ola::rdm::RDMReply *reply);
     bool UpdateDependants();
+    void FlushPendingOutput();
+    void WriteToDependants();
+    void SendToFilteredSink(Client *client, FilteredSink *sink);
+    void DeliverToFilteredSink(Client *client, FilteredSink *sink,
+                               const TimeStamp &now);
+    void FlushFilteredSink(Client *client);
+    void RemoveFilteredSink(Client *client);
     void UpdateName();
     void UpdateMode();
-    void HTPMergeSources(const std::vector<DmxSource> &sources);
+    bool HTPMergeSources(const MergeSourceList &sources);
+    bool SlotPriorityMergeSources(const MergeSourceList &sources);
+    bool ProfileMergeSources(const MergeSourceList &sources);
+    void AddAllActiveSources(const TimeStamp &now);
+    bool HTPMergeChangedSlots(const MergeSourceList &sources,
+                              const void *changed_owner,
+                              bool *output_changed);
     bool MergeAll(const InputPort *port, const Client *client);
+    bool TimedMergeAll(const InputPort *port, const Client *client);
+    SourceClientList::iterator FindSourceClient(const Client *client);
+    const DmxSource *ClientSource(source_client *entry);
+    void AddActiveSource(const void *owner, const DmxSource &source,
+                         const TimeStamp &now, bool is_changed_source,
+                         bool *changed_source_is_active,
+                         bool *have_slot_priorities);
     void PortDiscoveryComplete(BaseCallback0<void> *on_complete,
                                OutputPort *output_port,
                                const ola::rdm::UIDSet &uids);
-    void DiscoveryComplete(ola::rdm::RDMDiscoveryCallback *on_complete);
+    void DiscoveryComplete(ola::rdm::RDMDiscoveryCallback *on_complete,
+                           TimeStamp start_time);
+    void RestoredPortDiscoveryComplete(OutputPort *output_port,
+                                       const ola::rdm::UIDSet &uids);
 
     void SafeIncrement(const std::string &name);
+    void RecordDwellTime();
+    void UpdateOutputStats();
     void SafeDecrement(const std::string &name);
 
     template<class PortClass>
@@ -214,6 +560,8 @@ class Universe: public ola::rdm::RDMControllerInterface {
     bool GenericContainsPort(PortClass *port,
                              const std::vector<PortClass*> &ports) const;
 
+    friend class UniverseStore;
+
     DISALLOW_COPY_AND_ASSIGN(Universe);
 };
 }  // namespace ola
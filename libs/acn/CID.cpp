@@ -14,11 +14,13 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  *
  * CID.cpp
- * CID class, passes everything through to CIDImpl.
+ * CID class, generating, parsing and formatting are passed through to CIDImpl.
  * Copyright (C) 2007 Simon Newton
  */
 
 #include <ola/acn/CID.h>
+#include <string.h>
+#include <memory>
 #include <string>
 #include "libs/acn/CIDImpl.h"
 
@@ -27,31 +29,43 @@ namespace acn {
 
 using std::string;
 
-CID::CID() : m_impl(new CIDImpl()) {}
-
-CID::CID(const CID& other) : m_impl(new CIDImpl(*other.m_impl)) {}
+CID::CID() {
+  memset(m_data, 0, CID_LENGTH);
+}
 
-CID::CID(CIDImpl *impl) : m_impl(impl) {}
+CID::CID(const CID& other) {
+  memcpy(m_data, other.m_data, CID_LENGTH);
+}
 
-CID::~CID() {
-  delete m_impl;
+CID::CID(CIDImpl *impl) {
+  std::auto_ptr<CIDImpl> cid(impl);
+  cid->Pack(m_data);
 }
 
+CID::~CID() {}
+
 bool CID::IsNil() const {
-  return m_impl->IsNil();
+  for (unsigned int i = 0; i < CID_LENGTH; i++) {
+    if (m_data[i]) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void CID::Pack(uint8_t *buffer) const {
-  return m_impl->Pack(buffer);
+  memcpy(buffer, m_data, CID_LENGTH);
 }
 
 CID& CID::operator=(const CID& other) {
-  *m_impl = *other.m_impl;
+  if (this != &other) {
+    memcpy(m_data, other.m_data, CID_LENGTH);
+  }
   return *this;
 }
 
 bool CID::operator==(const CID& other) const {
-  return (*m_impl == *other.m_impl);
+  return memcmp(m_data, other.m_data, CID_LENGTH) == 0;
 }
 
 bool CID::operator!=(const CID& c1) const {
@@ -59,15 +73,27 @@ bool CID::operator!=(const CID& c1) const {
 }
 
 bool CID::operator<(const CID& c1) const {
-  return *m_impl < *c1.m_impl;
+  return memcmp(m_data, c1.m_data, CID_LENGTH) < 0;
 }
 
 string CID::ToString() const {
-  return m_impl->ToString();
+  std::auto_ptr<CIDImpl> cid(CIDImpl::FromData(m_data));
+  return cid->ToString();
 }
 
 void CID::Write(ola::io::OutputBufferInterface *output) const {
-  m_impl->Write(output);
+  output->Write(m_data, CID_LENGTH);
+}
+
+size_t CID::Hash() const {
+  // CIDs are mostly random, so mixing the four words is enough.
+  uint32_t words[CID_LENGTH / sizeof(uint32_t)];
+  memcpy(words, m_data, CID_LENGTH);
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < CID_LENGTH / sizeof(uint32_t); i++) {
+    hash = (hash ^ words[i]) * 16777619u;
+  }
+  return hash ^ (hash >> 15);
 }
 
 
@@ -77,7 +103,9 @@ CID CID::Generate() {
 
 
 CID CID::FromData(const uint8_t *data) {
-  return CID(CIDImpl::FromData(data));
+  CID cid;
+  memcpy(cid.m_data, data, CID_LENGTH);
+  return cid;
 }
 
 
@@ -41,6 +41,7 @@ class CIDTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testToString);
   CPPUNIT_TEST(testFromString);
   CPPUNIT_TEST(testToOutputBuffer);
+  CPPUNIT_TEST(testHashAndOrder);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -50,6 +51,7 @@ class CIDTest: public CppUnit::TestFixture {
     void testToString();
     void testFromString();
     void testToOutputBuffer();
+    void testHashAndOrder();
  private:
     static const uint8_t TEST_DATA[];
 };
@@ -141,3 +143,29 @@ void CIDTest::testToOutputBuffer() {
 
   OLA_ASSERT_DATA_EQUALS(TEST_DATA, sizeof(TEST_DATA), cid_data, size);
 }
+
+
+/**
+ * Check equal CIDs hash the same, and that the order matches the binary form.
+ */
+void CIDTest::testHashAndOrder() {
+  CID cid1 = CID::FromData(TEST_DATA);
+  CID cid2 = CID::FromString("00010203-0405-0607-0809-0A0B0C0D0E0F");
+  ola::acn::CIDHash hasher;
+  OLA_ASSERT_EQ(hasher(cid1), hasher(cid2));
+  OLA_ASSERT_EQ(cid1.Hash(), cid2.Hash());
+
+  uint8_t data[CID::CID_LENGTH];
+  memcpy(data, TEST_DATA, sizeof(data));
+  data[CID::CID_LENGTH - 1]++;
+  CID cid3 = CID::FromData(data);
+  OLA_ASSERT_NE(cid1.Hash(), cid3.Hash());
+  OLA_ASSERT_TRUE(cid1 < cid3);
+  OLA_ASSERT_FALSE(cid3 < cid1);
+
+  data[0] = 0xff;
+  CID cid4 = CID::FromData(data);
+  OLA_ASSERT_TRUE(cid3 < cid4);
+  OLA_ASSERT_FALSE(cid4 < cid3);
+  OLA_ASSERT_FALSE(cid1 < cid2);
+}
@@ -18,12 +18,19 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <string.h>
 #include <sys/time.h>
 #include <algorithm>
-#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
+#include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/network/NetworkUtils.h"
+#include "common/dmx/SlotKernels.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/DMPHeader.h"
 #include "libs/acn/DMPPDU.h"
@@ -33,8 +40,9 @@ namespace acn {
 
 using ola::Callback0;
 using ola::acn::CID;
+using ola::dmx::ReceiveStats;
 using ola::io::OutputStream;
-using std::map;
+using ola::network::NetworkToHost;
 using std::pair;
 using std::vector;
 
@@ -84,13 +92,6 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     return true;
   }
 
-  if (e131_header.Priority() > MAX_E131_PRIORITY) {
-    OLA_INFO << "Priority " << static_cast<int>(e131_header.Priority())
-             << " is greater than the max priority ("
-             << static_cast<int>(MAX_E131_PRIORITY) << "), ignoring data";
-    return true;
-  }
-
   unsigned int available_length = pdu_len;
   std::auto_ptr<const BaseDMPAddress> address(
       DecodeAddress(dmp_header.Size(),
@@ -110,63 +111,264 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
   }
 
   unsigned int length_remaining = pdu_len - available_length;
+  unsigned int channels = std::min(length_remaining, address->Number());
+  const uint8_t *slots = data + available_length;
+  unsigned int slot_count = 0;
   int start_code = -1;
   if (e131_header.UsingRev2()) {
     start_code = static_cast<int>(address->Start());
+    slot_count = channels;
   } else if (length_remaining && address->Number()) {
-    start_code = *(data + available_length);
+    start_code = *slots;
+    slots++;
+    slot_count = channels - 1;
+  }
+
+  uint8_t cid[CID::CID_LENGTH];
+  headers.GetRootHeader().GetCid().Pack(cid);
+  frame_header header;
+  header.cid = cid;
+  header.universe = e131_header.Universe();
+  header.priority = e131_header.Priority();
+  header.sequence = e131_header.Sequence();
+  header.terminated = e131_header.StreamTerminated();
+  header.sync_address = e131_header.SyncAddress();
+  HandleFrame(&universe_iter->second, header, start_code, slots, slot_count);
+  return true;
+}
+
+
+/*
+ * The fast path for E1.31 data packets. This only accepts the layout that
+ * senders use in practice: a root PDU containing a single data PDU, which
+ * contains a single DMP set property message for a range of slots starting
+ * at 0. Anything else goes through the inflators.
+ */
+bool DMPE131Inflator::HandleDataPacket(const uint8_t *data,
+                                       unsigned int length) {
+  if (length <= FAST_PATH_PROPERTY_OFFSET ||
+      length > FAST_PATH_PROPERTY_OFFSET + DMX_UNIVERSE_SIZE + 1) {
+    return false;
+  }
+
+  const uint8_t *framing = data + FAST_PATH_FRAMING_OFFSET;
+  const uint8_t *dmp = data + FAST_PATH_DMP_OFFSET;
+  const unsigned int property_count = length - FAST_PATH_PROPERTY_OFFSET;
+  if (!CheckFlagsAndLength(data, length) ||
+      ReadUInt32(data + 2) != ola::acn::VECTOR_ROOT_E131 ||
+      !CheckFlagsAndLength(framing, length - FAST_PATH_FRAMING_OFFSET) ||
+      ReadUInt32(framing + 2) != ola::acn::VECTOR_E131_DATA ||
+      !CheckFlagsAndLength(dmp, length - FAST_PATH_DMP_OFFSET) ||
+      dmp[2] != ola::acn::DMP_SET_PROPERTY_VECTOR ||
+      dmp[3] != FAST_PATH_DMP_HEADER ||
+      ReadUInt16(dmp + 4) != 0 ||
+      ReadUInt16(dmp + 6) != 1 ||
+      ReadUInt16(dmp + 8) != property_count) {
+    return false;
+  }
+
+  // From here on the packet is handled the same way the inflators would.
+  E131Header::e131_pdu_header raw_header;
+  memcpy(&raw_header, framing + 2 + 4, sizeof(raw_header));
+
+  if ((raw_header.options & E131Header::PREVIEW_DATA_MASK) &&
+      m_ignore_preview) {
+    OLA_DEBUG << "Ignoring preview data";
+    return true;
+  }
+
+  frame_header header;
+  header.cid = data + 2 + 4;
+  header.universe = NetworkToHost(raw_header.universe);
+  header.priority = raw_header.priority;
+  header.sequence = raw_header.sequence;
+  header.terminated =
+      raw_header.options & E131Header::STREAM_TERMINATED_MASK;
+  header.sync_address = NetworkToHost(raw_header.sync_address);
+
+  UniverseHandlers::iterator universe_iter = m_handlers.find(header.universe);
+  if (universe_iter == m_handlers.end()) {
+    return true;
   }
 
+  const uint8_t *properties = data + FAST_PATH_PROPERTY_OFFSET;
+  HandleFrame(&universe_iter->second, header, properties[0], properties + 1,
+              property_count - 1);
+  return true;
+}
+
+
+/*
+ * Handle the slot data for a universe once it's been extracted from the PDUs.
+ * @param universe_data the universe_handler struct for this universe.
+ * @param header the values from the root and framing layers.
+ * @param start_code the start code, or -1 if there wasn't one.
+ * @param slots the slot data, not including the start code.
+ * @param slot_count the number of slots.
+ */
+void DMPE131Inflator::HandleFrame(universe_handler *universe_data,
+                                  const frame_header &header,
+                                  int start_code,
+                                  const uint8_t *slots,
+                                  unsigned int slot_count) {
+  if (header.priority > MAX_E131_PRIORITY) {
+    OLA_INFO << "Priority " << static_cast<int>(header.priority)
+             << " is greater than the max priority ("
+             << static_cast<int>(MAX_E131_PRIORITY) << "), ignoring data";
+    return;
+  }
+
+  const bool slot_priority_frame = (
+      start_code == ola::dmx::SLOT_PRIORITY_START_CODE && !header.terminated);
+
   // The only time we want to continue processing a non-0 start code is if it
-  // contains a Terminate message.
-  if (start_code && !e131_header.StreamTerminated()) {
+  // contains a Terminate message or slot priorities.
+  if (start_code && !header.terminated && !slot_priority_frame) {
     OLA_INFO << "Skipping packet with non-0 start code: " << start_code;
-    return true;
+    return;
+  }
+
+  if (slot_priority_frame && !universe_data->per_slot) {
+    OLA_INFO << "Using slot priorities for universe " << header.universe;
+    universe_data->per_slot = true;
+    universe_data->merge_required = true;
   }
 
-  DmxBuffer *target_buffer;
-  if (!TrackSourceIfRequired(&universe_iter->second, headers,
-                             &target_buffer)) {
+  ola::TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  dmx_source *source;
+  if (!TrackSourceIfRequired(universe_data, header, now, &source)) {
     // no need to continue processing
-    return true;
+    return;
+  }
+
+  // Only hold the data once we know the sync packets are getting through,
+  // otherwise the universe would never update. Terminations are passed on
+  // straight away, since the source won't be sending any more syncs.
+  uint16_t sync_address = 0;
+  if (header.sync_address && !header.terminated &&
+      SyncActive(header.sync_address, now)) {
+    sync_address = header.sync_address;
+  }
+  if (sync_address != universe_data->sync_address) {
+    universe_data->sync_address = sync_address;
+    universe_data->held = false;
+    universe_data->merge_required = true;
   }
 
   // Reaching here means that we actually have new data and we should merge.
-  if (target_buffer && start_code == 0) {
-    unsigned int channels = std::min(length_remaining, address->Number());
-    if (e131_header.UsingRev2()) {
-      target_buffer->Set(data + available_length, channels);
-    } else {
-      target_buffer->Set(data + available_length + 1, channels - 1);
+  bool merged = false;
+  if (source && slot_priority_frame) {
+    source->slot_priorities.Set(slots, slot_count);
+    source->slot_priorities_received = now;
+    universe_data->merge_required = true;
+  } else if (source && start_code == 0) {
+    if (source->slot_priorities.Size() &&
+        now > source->slot_priorities_received + EXPIRY_INTERVAL) {
+      OLA_INFO << "CID " << source->cid.ToString()
+               << " stopped sending slot priorities";
+      source->slot_priorities.Reset();
+      universe_data->merge_required = true;
+    }
+
+    // If nothing else has changed we only need to merge this source's data.
+    if (!universe_data->merge_required &&
+        !universe_data->per_slot &&
+        universe_data->sources.size() > 1 &&
+        source->buffer.Size() == slot_count) {
+      MergeSlots(universe_data, source->buffer, slots, slot_count);
+      merged = true;
     }
+    source->buffer.Set(slots, slot_count);
   }
 
-  if (universe_iter->second.priority) {
-    *universe_iter->second.priority = universe_iter->second.active_priority;
-  }
-
-  // merge the sources
-  switch (universe_iter->second.sources.size()) {
-    case 0:
-      universe_iter->second.buffer->Reset();
-      break;
-    case 1:
-      universe_iter->second.buffer->Set(
-          universe_iter->second.sources[0].buffer);
-      universe_iter->second.closure->Run();
-      break;
-    default:
-      // HTP Merge
-      universe_iter->second.buffer->Reset();
-      std::vector<dmx_source>::const_iterator source_iter =
-          universe_iter->second.sources.begin();
-      for (; source_iter != universe_iter->second.sources.end();
-           ++source_iter) {
-        universe_iter->second.buffer->HTPMerge(source_iter->buffer);
-      }
-      universe_iter->second.closure->Run();
+  if (universe_data->sources.empty()) {
+    if (universe_data->priority) {
+      *universe_data->priority = universe_data->active_priority;
+    }
+    universe_data->buffer->Reset();
+    if (universe_data->slot_priorities) {
+      universe_data->slot_priorities->Reset();
+    }
+    universe_data->held_data.Reset();
+    universe_data->held = false;
+    universe_data->merge_required = false;
+    universe_data->per_slot = false;
+    return;
   }
-  return true;
+
+  if (!merged) {
+    MergeSources(universe_data);
+  }
+
+  if (universe_data->sync_address) {
+    universe_data->held = true;
+    return;
+  }
+
+  if (universe_data->priority) {
+    *universe_data->priority = universe_data->active_priority;
+  }
+  universe_data->closure->Run();
+}
+
+
+/*
+ * Release the held data for all universes waiting on this sync address.
+ */
+void DMPE131Inflator::HandleSync(uint16_t sync_address) {
+  ola::TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  m_sync_times[sync_address] = now;
+
+  UniverseHandlers::iterator iter = m_handlers.begin();
+  for (; iter != m_handlers.end(); ++iter) {
+    universe_handler &universe_data = iter->second;
+    if (!universe_data.held || universe_data.sync_address != sync_address) {
+      continue;
+    }
+
+    universe_data.held = false;
+    universe_data.buffer->Set(universe_data.held_data);
+    if (universe_data.priority) {
+      *universe_data.priority = universe_data.active_priority;
+    }
+    universe_data.closure->Run();
+  }
+}
+
+
+/*
+ * Check if we've seen a sync packet for this address recently.
+ */
+bool DMPE131Inflator::SyncActive(uint16_t sync_address,
+                                 const TimeStamp &now) const {
+  SyncTimes::const_iterator iter = m_sync_times.find(sync_address);
+  return iter != m_sync_times.end() && now < iter->second + EXPIRY_INTERVAL;
+}
+
+
+/*
+ * Check a two byte flags and length field.
+ */
+bool DMPE131Inflator::CheckFlagsAndLength(const uint8_t *data,
+                                          unsigned int length) {
+  return (data[0] & 0xf0) == FAST_PATH_FLAGS &&
+         ((data[0] & BaseInflator::LENGTH_MASK) << 8 | data[1]) == length;
+}
+
+
+uint16_t DMPE131Inflator::ReadUInt16(const uint8_t *data) {
+  uint16_t value;
+  memcpy(&value, data, sizeof(value));
+  return NetworkToHost(value);
+}
+
+
+uint32_t DMPE131Inflator::ReadUInt32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return NetworkToHost(value);
 }
 
 
@@ -180,7 +382,8 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
 bool DMPE131Inflator::SetHandler(uint16_t universe,
                                  ola::DmxBuffer *buffer,
                                  uint8_t *priority,
-                                 ola::Callback0<void> *closure) {
+                                 ola::Callback0<void> *closure,
+                                 ola::DmxBuffer *slot_priorities) {
   if (!closure || !buffer) {
     return false;
   }
@@ -189,16 +392,25 @@ bool DMPE131Inflator::SetHandler(uint16_t universe,
 
   if (iter == m_handlers.end()) {
     universe_handler handler;
+    handler.universe = universe;
     handler.buffer = buffer;
     handler.closure = closure;
     handler.active_priority = 0;
     handler.priority = priority;
+    handler.slot_priorities = slot_priorities;
+    handler.per_slot = false;
+    handler.merge_required = true;
+    handler.sync_address = 0;
+    handler.held = false;
+    handler.stats = m_stats ? m_stats->Get(IntToString(universe)) : NULL;
     m_handlers[universe] = handler;
   } else {
     Callback0<void> *old_closure = iter->second.closure;
     iter->second.closure = closure;
     iter->second.buffer = buffer;
     iter->second.priority = priority;
+    iter->second.slot_priorities = slot_priorities;
+    iter->second.merge_required = true;
     delete old_closure;
   }
   return true;
@@ -215,6 +427,10 @@ bool DMPE131Inflator::RemoveHandler(uint16_t universe) {
 
   if (iter != m_handlers.end()) {
     Callback0<void> *old_closure = iter->second.closure;
+    ClearSources(&iter->second);
+    if (iter->second.stats) {
+      m_stats->Remove(IntToString(universe));
+    }
     m_handlers.erase(iter);
     delete old_closure;
     return true;
@@ -234,6 +450,63 @@ void DMPE131Inflator::RegisteredUniverses(vector<uint16_t> *universes) {
   for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
     universes->push_back(iter->first);
   }
+  std::sort(universes->begin(), universes->end());
+}
+
+
+/*
+ * Start recording receive statistics.
+ */
+void DMPE131Inflator::SetReceiveStats(ola::ReceiveStatsMap *stats) {
+  m_stats = stats;
+  UniverseHandlers::iterator iter = m_handlers.begin();
+  for (; iter != m_handlers.end(); ++iter) {
+    iter->second.stats = m_stats ? m_stats->Get(IntToString(iter->first)) :
+                                   NULL;
+    SourceMap::iterator source_iter = iter->second.sources.begin();
+    for (; source_iter != iter->second.sources.end(); ++source_iter) {
+      source_iter->second.stats = SourceStats(iter->first,
+                                              source_iter->second.cid);
+    }
+  }
+}
+
+
+/*
+ * Get the statistics for a source, this is only called when a source is added
+ * so it's fine to build the key here.
+ */
+ReceiveStats *DMPE131Inflator::SourceStats(uint16_t universe,
+                                           const CID &cid) {
+  if (!m_stats) {
+    return NULL;
+  }
+  return m_stats->Get(IntToString(universe) + "/" + cid.ToString());
+}
+
+
+/*
+ * Stop tracking a source, this drops the statistics for the source so they
+ * don't build up as sources come and go.
+ */
+void DMPE131Inflator::RemoveSource(universe_handler *universe_data,
+                                   SourceMap::iterator iter) {
+  if (iter->second.stats) {
+    m_stats->Remove(IntToString(universe_data->universe) + "/" +
+                    iter->second.cid.ToString());
+  }
+  universe_data->sources.erase(iter);
+}
+
+
+/*
+ * Stop tracking all the sources for a universe.
+ */
+void DMPE131Inflator::ClearSources(universe_handler *universe_data) {
+  SourceMap &sources = universe_data->sources;
+  while (!sources.empty()) {
+    RemoveSource(universe_data, sources.begin());
+  }
 }
 
 
@@ -242,111 +515,134 @@ void DMPE131Inflator::RegisteredUniverses(vector<uint16_t> *universes) {
  * This takes care of tracking all sources for a universe at the active
  * priority.
  * @param universe_data the universe_handler struct for this universe,
- * @param HeaderSet the set of headers in this packet
- * @param buffer, if set to a non-NULL pointer, the caller should copy the data
- * in the buffer.
+ * @param header the values from the root and framing layers.
+ * @param now the current time.
+ * @param tracked_source, if set to a non-NULL pointer, the caller should copy
+ * the data to the source.
  * @returns true if we should remerge the data, false otherwise.
  */
 bool DMPE131Inflator::TrackSourceIfRequired(
     universe_handler *universe_data,
-    const HeaderSet &headers,
-    DmxBuffer **buffer) {
+    const frame_header &header,
+    const TimeStamp &now,
+    dmx_source **tracked_source) {
 
-  *buffer = NULL;  // default the buffer to NULL
-  ola::TimeStamp now;
-  m_clock.CurrentMonotonicTime(&now);
-  const E131Header &e131_header = headers.GetE131Header();
-  uint8_t priority = e131_header.Priority();
-  vector<dmx_source> &sources = universe_data->sources;
-  vector<dmx_source>::iterator iter = sources.begin();
+  *tracked_source = NULL;  // default the source to NULL
+  uint8_t priority = header.priority;
+  SourceMap &sources = universe_data->sources;
+  const CID key = CID::FromData(header.cid);
 
-  while (iter != sources.end()) {
-    if (iter->cid != headers.GetRootHeader().GetCid()) {
-      TimeStamp expiry_time = iter->last_heard_from + EXPIRY_INTERVAL;
-      if (now > expiry_time) {
-        OLA_INFO << "source " << iter->cid.ToString() << " has expired";
-        iter = sources.erase(iter);
-        continue;
-      }
-    }
-    iter++;
+  if (now > universe_data->next_expiry) {
+    ExpireSources(universe_data, key, now);
   }
 
   if (sources.empty()) {
     universe_data->active_priority = 0;
   }
 
-  for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    if (iter->cid == headers.GetRootHeader().GetCid()) {
-      break;
-    }
-  }
+  SourceMap::iterator iter = sources.find(key);
 
   if (iter == sources.end()) {
     // This is an untracked source
-    if (e131_header.StreamTerminated() ||
-        priority < universe_data->active_priority) {
+    if (universe_data->stats) {
+      universe_data->stats->PacketReceived(now);
+    }
+
+    if (header.terminated ||
+        (!universe_data->per_slot &&
+         priority < universe_data->active_priority)) {
       return false;
     }
 
-    if (priority > universe_data->active_priority) {
-      OLA_INFO << "Raising priority for universe " << e131_header.Universe()
+    if (!universe_data->per_slot &&
+        priority > universe_data->active_priority) {
+      OLA_INFO << "Raising priority for universe " << header.universe
                << " from " << static_cast<int>(universe_data->active_priority)
                << " to " << static_cast<int>(priority);
-      sources.clear();
+      ClearSources(universe_data);
       universe_data->active_priority = priority;
     }
 
-    if (sources.size() == MAX_MERGE_SOURCES) {
+    if (sources.size() >= m_max_sources) {
       // TODO(simon): flag this in the export map
       OLA_WARN << "Max merge sources reached for universe "
-               << e131_header.Universe() << ", "
-               << headers.GetRootHeader().GetCid().ToString()
+               << header.universe << ", "
+               << CID::FromData(header.cid).ToString()
                << " won't be tracked";
         return false;
     } else {
-      OLA_INFO << "Added new E1.31 source: "
-               << headers.GetRootHeader().GetCid().ToString();
       dmx_source new_source;
-      new_source.cid = headers.GetRootHeader().GetCid();
-      new_source.sequence = e131_header.Sequence();
+      new_source.cid = key;
+      new_source.sequence = header.sequence;
+      new_source.priority = priority;
       new_source.last_heard_from = now;
-      iter = sources.insert(sources.end(), new_source);
-      *buffer = &iter->buffer;
+      new_source.stats = SourceStats(header.universe, new_source.cid);
+      if (new_source.stats) {
+        new_source.stats->PacketReceived(now);
+      }
+      OLA_INFO << "Added new E1.31 source: " << new_source.cid.ToString();
+      iter = sources.insert(std::make_pair(key, new_source)).first;
+      if (sources.size() == 1) {
+        universe_data->next_expiry = now + EXPIRY_INTERVAL;
+      }
+      universe_data->merge_required = true;
+      *tracked_source = &iter->second;
       return true;
     }
 
   } else {
     // We already know about this one, check the seq #
-    int8_t seq_diff = static_cast<int8_t>(e131_header.Sequence() -
-                                          iter->sequence);
-    if (seq_diff <= 0 && seq_diff > SEQUENCE_DIFF_THRESHOLD) {
+    dmx_source &source = iter->second;
+    int8_t seq_diff = static_cast<int8_t>(header.sequence - source.sequence);
+    if (seq_diff == 0) {
+      // A copy of the last frame, which arrives when a source sends on
+      // redundant networks. Drop it before it's counted or merged.
+      return false;
+    }
+    bool out_of_order = seq_diff <= 0 && seq_diff > SEQUENCE_DIFF_THRESHOLD;
+    int missed = out_of_order ? ReceiveStats::OUT_OF_ORDER :
+                                std::max(seq_diff - 1, 0);
+    if (source.stats) {
+      source.stats->PacketReceived(now, missed);
+    }
+    if (universe_data->stats) {
+      universe_data->stats->PacketReceived(now, missed);
+    }
+
+    if (out_of_order) {
       OLA_INFO << "Old packet received, ignoring, this # "
-               << static_cast<int>(e131_header.Sequence()) << ", last "
-               << static_cast<int>(iter->sequence);
+               << static_cast<int>(header.sequence) << ", last "
+               << static_cast<int>(source.sequence);
       return false;
     }
-    iter->sequence = e131_header.Sequence();
+    source.sequence = header.sequence;
 
-    if (e131_header.StreamTerminated()) {
-      OLA_INFO << "CID " << headers.GetRootHeader().GetCid().ToString()
+    if (header.terminated) {
+      OLA_INFO << "CID " << source.cid.ToString()
                << " sent a termination for universe "
-               << e131_header.Universe();
-      sources.erase(iter);
+               << header.universe;
+      RemoveSource(universe_data, iter);
       if (sources.empty()) {
         universe_data->active_priority = 0;
       }
       // We need to trigger a merge here else the buffer will be stale, we keep
       // the buffer as NULL though so we don't use the data.
+      universe_data->merge_required = true;
       return true;
     }
 
-    iter->last_heard_from = now;
-    if (priority < universe_data->active_priority) {
+    source.last_heard_from = now;
+    if (universe_data->per_slot) {
+      // The merge sorts out which source wins each slot.
+      if (priority != source.priority) {
+        universe_data->merge_required = true;
+      }
+    } else if (priority < universe_data->active_priority) {
       if (sources.size() == 1) {
         universe_data->active_priority = priority;
       } else {
-        sources.erase(iter);
+        RemoveSource(universe_data, iter);
+        universe_data->merge_required = true;
         return true;
       }
     } else if (priority > universe_data->active_priority) {
@@ -354,14 +650,187 @@ bool DMPE131Inflator::TrackSourceIfRequired(
       universe_data->active_priority = priority;
       if (sources.size() != 1) {
         // clear all sources other than this one
-        dmx_source this_source = *iter;
-        sources.clear();
-        iter = sources.insert(sources.end(), this_source);
+        dmx_source this_source = source;
+        source.stats = NULL;
+        ClearSources(universe_data);
+        iter = sources.insert(std::make_pair(key, this_source)).first;
+        universe_data->merge_required = true;
       }
     }
-    *buffer = &iter->buffer;
+    iter->second.priority = priority;
+    *tracked_source = &iter->second;
     return true;
   }
 }
+
+
+/*
+ * Remove any sources we haven't heard from recently.
+ * @param universe_data the universe_handler struct for this universe.
+ * @param current_source the source of the packet being handled, this is never
+ *   expired.
+ * @param now the current time.
+ */
+void DMPE131Inflator::ExpireSources(universe_handler *universe_data,
+                                    const CID &current_source,
+                                    const TimeStamp &now) {
+  TimeStamp next_expiry = now + EXPIRY_INTERVAL;
+  SourceMap &sources = universe_data->sources;
+  SourceMap::iterator iter = sources.begin();
+  while (iter != sources.end()) {
+    TimeStamp expiry_time = iter->second.last_heard_from + EXPIRY_INTERVAL;
+    if (now > expiry_time && iter->first != current_source) {
+      OLA_INFO << "source " << iter->second.cid.ToString() << " has expired";
+      RemoveSource(universe_data, iter++);
+      universe_data->merge_required = true;
+      continue;
+    }
+    if (expiry_time < next_expiry) {
+      next_expiry = expiry_time;
+    }
+    ++iter;
+  }
+  universe_data->next_expiry = next_expiry;
+}
+
+
+/*
+ * Rebuild the merged buffer for a universe from all the sources.
+ */
+void DMPE131Inflator::MergeSources(universe_handler *universe_data) {
+  universe_data->merge_required = false;
+  if (universe_data->per_slot && SlotPriorityMerge(universe_data)) {
+    return;
+  }
+  if (universe_data->slot_priorities &&
+      universe_data->slot_priorities->Size()) {
+    universe_data->slot_priorities->Reset();
+  }
+
+  DmxBuffer *merged = MergeTarget(universe_data);
+  SourceMap &sources = universe_data->sources;
+  if (sources.size() == 1) {
+    merged->Set(sources.begin()->second.buffer);
+    return;
+  }
+
+  // HTP Merge
+  merged->Reset();
+  SourceMap::const_iterator iter = sources.begin();
+  for (; iter != sources.end(); ++iter) {
+    merged->HTPMerge(iter->second.buffer);
+  }
+}
+
+
+/*
+ * Merge the sources using the priority of each slot. For each slot the source
+ * with the highest priority wins, and sources with the same priority are HTP
+ * merged. Sources without slot priorities use their universe priority for
+ * every slot.
+ * @param universe_data the universe_handler struct for this universe.
+ * @returns false if none of the sources have slot priorities any more. The
+ *   sources below the highest universe priority are dropped and the caller
+ *   should do a normal merge.
+ */
+bool DMPE131Inflator::SlotPriorityMerge(universe_handler *universe_data) {
+  SourceMap &sources = universe_data->sources;
+  uint8_t max_priority = 0;
+  bool have_slot_priorities = false;
+  SourceMap::iterator iter = sources.begin();
+  for (; iter != sources.end(); ++iter) {
+    max_priority = std::max(max_priority, iter->second.priority);
+    if (iter->second.slot_priorities.Size()) {
+      have_slot_priorities = true;
+    }
+  }
+  universe_data->active_priority = max_priority;
+
+  if (!have_slot_priorities) {
+    universe_data->per_slot = false;
+    iter = sources.begin();
+    while (iter != sources.end()) {
+      if (iter->second.priority < max_priority) {
+        RemoveSource(universe_data, iter++);
+      } else {
+        ++iter;
+      }
+    }
+    return false;
+  }
+
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  uint8_t priorities[DMX_UNIVERSE_SIZE];
+  uint8_t source_priorities[DMX_UNIVERSE_SIZE];
+  memset(data, DMX_MIN_SLOT_VALUE, sizeof(data));
+  memset(priorities, ola::dmx::SLOT_PRIORITY_NOT_SOURCED, sizeof(priorities));
+  unsigned int size = 0;
+
+  for (iter = sources.begin(); iter != sources.end(); ++iter) {
+    const dmx_source &source = iter->second;
+    const unsigned int length = source.buffer.Size();
+    size = std::max(size, length);
+
+    const uint8_t *slot_priorities = source_priorities;
+    if (source.slot_priorities.Size() >= length) {
+      slot_priorities = source.slot_priorities.GetRaw();
+    } else if (source.slot_priorities.Size()) {
+      unsigned int priority_count = length;
+      source.slot_priorities.Get(source_priorities, &priority_count);
+      memset(source_priorities + priority_count,
+             ola::dmx::SLOT_PRIORITY_NOT_SOURCED, length - priority_count);
+    } else {
+      // A slot priority of 0 means the slot isn't sourced, so the lowest
+      // universe priority becomes 1.
+      memset(source_priorities,
+             std::max(source.priority, static_cast<uint8_t>(1)), length);
+    }
+    ola::dmx::SlotPriorityMerge(data, priorities, source.buffer.GetRaw(),
+                                slot_priorities, length);
+  }
+
+  MergeTarget(universe_data)->Set(data, size);
+  if (universe_data->slot_priorities) {
+    universe_data->slot_priorities->Set(priorities, size);
+  }
+  return true;
+}
+
+
+/*
+ * Update the merged buffer with the new data from one source. This only
+ * looks at the other sources for slots where this source was (one of) the
+ * highest and the value has dropped.
+ * @param universe_data the universe_handler struct for this universe.
+ * @param old_data the previous data from the source, this must be the same
+ *   length as the new data.
+ * @param slots the new data.
+ * @param slot_count the number of slots.
+ */
+void DMPE131Inflator::MergeSlots(universe_handler *universe_data,
+                                 const DmxBuffer &old_data,
+                                 const uint8_t *slots,
+                                 unsigned int slot_count) {
+  DmxBuffer *merged = MergeTarget(universe_data);
+  const SourceMap &sources = universe_data->sources;
+  const uint8_t *old_slots = old_data.GetRaw();
+
+  for (unsigned int i = 0; i < slot_count; i++) {
+    uint8_t current = merged->Get(i);
+    if (slots[i] > current) {
+      merged->SetChannel(i, slots[i]);
+    } else if (slots[i] < current && old_slots[i] == current) {
+      uint8_t value = slots[i];
+      SourceMap::const_iterator iter = sources.begin();
+      for (; iter != sources.end(); ++iter) {
+        const DmxBuffer &buffer = iter->second.buffer;
+        if (&buffer != &old_data && buffer.Size() > i) {
+          value = std::max(value, buffer.Get(i));
+        }
+      }
+      merged->SetChannel(i, value);
+    }
+  }
+}
 }  // namespace acn
 }  // namespace ola
@@ -22,12 +22,22 @@
 #ifndef LIBS_ACN_DMPE131INFLATOR_H_
 #define LIBS_ACN_DMPE131INFLATOR_H_
 
-#include <map>
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <stddef.h>
+#include <string.h>
 #include <vector>
+#include HASH_MAP_H
 #include "ola/Clock.h"
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/acn/CID.h"
+#include "ola/dmx/ReceiveStats.h"
 #include "libs/acn/DMPInflator.h"
+#include "libs/acn/E131Header.h"
 
 namespace ola {
 namespace acn {
@@ -36,18 +46,74 @@ class DMPE131Inflator: public DMPInflator {
   friend class DMPE131InflatorTest;
 
  public:
-  explicit DMPE131Inflator(bool ignore_preview):
+  /**
+   * @brief Create a new DMPE131Inflator.
+   * @param ignore_preview true to ignore preview data.
+   * @param max_sources the max number of sources to track and merge for each
+   *   universe.
+   */
+  explicit DMPE131Inflator(
+      bool ignore_preview,
+      unsigned int max_sources = DEFAULT_MAX_MERGE_SOURCES):
     DMPInflator(),
-    m_ignore_preview(ignore_preview) {
+    m_ignore_preview(ignore_preview),
+    m_max_sources(max_sources),
+    m_stats(NULL) {
   }
   ~DMPE131Inflator();
 
+  /**
+   * @brief Set the handler for a universe.
+   * @param universe the universe to register the handler for.
+   * @param buffer the DmxBuffer to copy the merged data to.
+   * @param priority the priority of the merged data, may be NULL.
+   * @param handler the Callback0 to call when there is data for this universe.
+   *   Ownership is transferred.
+   * @param slot_priorities the priority of each slot in the merged data, may
+   *   be NULL. This is empty unless a source is sending slot priorities.
+   */
   bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
-                  uint8_t *priority, ola::Callback0<void> *handler);
+                  uint8_t *priority, ola::Callback0<void> *handler,
+                  ola::DmxBuffer *slot_priorities = NULL);
   bool RemoveHandler(uint16_t universe);
 
   void RegisteredUniverses(std::vector<uint16_t> *universes);
 
+  /**
+   * @brief Record receive statistics for each universe and source.
+   * @param stats the map to store the statistics in, ownership is not
+   *   transferred. The universe statistics are keyed by universe number and
+   *   the source statistics by universe/CID.
+   */
+  void SetReceiveStats(ola::ReceiveStatsMap *stats);
+
+  /**
+   * @brief Handle a complete E1.31 data packet without using the inflator
+   * chain.
+   * @param data the packet, not including the ACN preamble.
+   * @param length the length of the packet.
+   * @returns true if the packet was handled. If the packet isn't a simple E1.31
+   *   data packet this returns false and the packet should be passed to the
+   *   RootInflator instead.
+   *
+   * Nearly all the packets we receive are a single data PDU with a fixed
+   * layout, so it's much cheaper to check the fixed offsets than to decode
+   * each layer in turn.
+   */
+  bool HandleDataPacket(const uint8_t *data, unsigned int length);
+
+  /**
+   * @brief Handle an E1.31 synchronization packet.
+   * @param sync_address the universe the sync was sent on.
+   *
+   * Data for universes that use this sync address is held until the sync
+   * arrives, this releases all of them at once.
+   */
+  void HandleSync(uint16_t sync_address);
+
+  // The default max number of sources we'll track per universe.
+  static const unsigned int DEFAULT_MAX_MERGE_SOURCES = 6;
+
  protected:
   virtual bool HandlePDUData(uint32_t vector,
                              const HeaderSet &headers,
@@ -58,36 +124,119 @@ class DMPE131Inflator: public DMPInflator {
   typedef struct {
     ola::acn::CID cid;
     uint8_t sequence;
+    uint8_t priority;
     TimeStamp last_heard_from;
     DmxBuffer buffer;
+    // The last slot priorities (start code 0xdd), if the source sends them.
+    DmxBuffer slot_priorities;
+    TimeStamp slot_priorities_received;
+    ola::dmx::ReceiveStats *stats;
   } dmx_source;
 
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<ola::acn::CID, dmx_source,
+                                        ola::acn::CIDHash> SourceMap;
+
   typedef struct {
+    uint16_t universe;
     DmxBuffer *buffer;
     Callback0<void> *closure;
     uint8_t active_priority;
     uint8_t *priority;
-    std::vector<dmx_source> sources;
+    DmxBuffer *slot_priorities;
+    SourceMap sources;
+    // True while one of the sources is sending slot priorities. The sources
+    // are then tracked whatever their universe priority, since a source with
+    // a lower priority may still win some of the slots.
+    bool per_slot;
+    // None of the sources expire before this time.
+    TimeStamp next_expiry;
+    // Set when the merge target no longer holds the merge of the sources.
+    bool merge_required;
+    // The sync address we're holding data for, or 0 if the data is passed
+    // on as soon as it arrives.
+    uint16_t sync_address;
+    // The merged data waiting for a sync, this is the merge target while
+    // sync_address is set.
+    DmxBuffer held_data;
+    // True if held_data has changed since the last sync.
+    bool held;
+    ola::dmx::ReceiveStats *stats;
   } universe_handler;
 
-  typedef std::map<uint16_t, universe_handler> UniverseHandlers;
+  // The fields of the root and framing layers we care about.
+  typedef struct {
+    const uint8_t *cid;
+    uint16_t universe;
+    uint8_t priority;
+    uint8_t sequence;
+    bool terminated;
+    uint16_t sync_address;
+  } frame_header;
+
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<uint16_t, universe_handler>
+      UniverseHandlers;
+  // The last time we saw a sync packet for each sync address.
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<uint16_t, TimeStamp> SyncTimes;
 
   UniverseHandlers m_handlers;
+  SyncTimes m_sync_times;
   bool m_ignore_preview;
+  const unsigned int m_max_sources;
   ola::Clock m_clock;
+  ola::ReceiveStatsMap *m_stats;
 
+  void HandleFrame(universe_handler *universe_data,
+                   const frame_header &header,
+                   int start_code,
+                   const uint8_t *slots,
+                   unsigned int slot_count);
   bool TrackSourceIfRequired(universe_handler *universe_data,
-                             const HeaderSet &headers,
-                             DmxBuffer **buffer);
+                             const frame_header &header,
+                             const TimeStamp &now,
+                             dmx_source **source);
+  bool SyncActive(uint16_t sync_address, const TimeStamp &now) const;
+  ola::dmx::ReceiveStats *SourceStats(uint16_t universe, const CID &cid);
+  void RemoveSource(universe_handler *universe_data, SourceMap::iterator iter);
+  void ClearSources(universe_handler *universe_data);
+  void ExpireSources(universe_handler *universe_data,
+                     const ola::acn::CID &current_source,
+                     const TimeStamp &now);
+  void MergeSources(universe_handler *universe_data);
+  bool SlotPriorityMerge(universe_handler *universe_data);
+  void MergeSlots(universe_handler *universe_data,
+                  const DmxBuffer &old_data,
+                  const uint8_t *slots,
+                  unsigned int slot_count);
+
+  static DmxBuffer *MergeTarget(universe_handler *universe_data) {
+    return universe_data->sync_address ? &universe_data->held_data :
+                                         universe_data->buffer;
+  }
+
+  static bool CheckFlagsAndLength(const uint8_t *data, unsigned int length);
+  static uint16_t ReadUInt16(const uint8_t *data);
+  static uint32_t ReadUInt32(const uint8_t *data);
 
-  // The max number of sources we'll track per universe.
-  static const uint8_t MAX_MERGE_SOURCES = 6;
   // The max merge priority.
   static const uint8_t MAX_E131_PRIORITY = 200;
   // ignore packets that differ by less than this amount from the last one
   static const int8_t SEQUENCE_DIFF_THRESHOLD = -20;
-  // expire sources after 2.5s
+  // expire sources after 2.5s, this is also how long we'll wait for a sync
+  // before passing the data on without one.
   static const TimeInterval EXPIRY_INTERVAL;
+
+  // The fixed layout used by HandleDataPacket(). Each PDU starts with a two
+  // byte flags & length field, followed by the vector.
+  static const uint8_t FAST_PATH_FLAGS = 0x70;
+  // virtual, absolute, range with equal size elements, two byte addresses
+  static const uint8_t FAST_PATH_DMP_HEADER = 0xa1;
+  static const unsigned int FAST_PATH_FRAMING_OFFSET =
+      2 + 4 + ola::acn::CID::CID_LENGTH;
+  static const unsigned int FAST_PATH_DMP_OFFSET =
+      FAST_PATH_FRAMING_OFFSET + 2 + 4 + sizeof(E131Header::e131_pdu_header);
+  // The DMP header and the start, increment & count fields.
+  static const unsigned int FAST_PATH_PROPERTY_OFFSET =
+      FAST_PATH_DMP_OFFSET + 2 + 1 + 1 + 6;
 };
 }  // namespace acn
 }  // namespace ola
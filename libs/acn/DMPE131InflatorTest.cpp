@@ -0,0 +1,550 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DMPE131InflatorTest.cpp
+ * Test fixture for the DMPE131Inflator class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/acn/CID.h"
+#include "ola/dmx/ReceiveStats.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/E131ExtendedInflator.h"
+#include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/E131SyncPDU.h"
+#include "libs/acn/HeaderSet.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootInflator.h"
+#include "libs/acn/RootPDU.h"
+#include "ola/testing/TestUtils.h"
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using ola::ReceiveStatsMap;
+using ola::dmx::ReceiveStats;
+using std::string;
+using std::vector;
+
+class DMPE131InflatorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DMPE131InflatorTest);
+  CPPUNIT_TEST(testFastPath);
+  CPPUNIT_TEST(testFastPathSequence);
+  CPPUNIT_TEST(testFastPathFallback);
+  CPPUNIT_TEST(testMerge);
+  CPPUNIT_TEST(testMaxSources);
+  CPPUNIT_TEST(testSync);
+  CPPUNIT_TEST(testReceiveStats);
+  CPPUNIT_TEST(testRedundantCopies);
+  CPPUNIT_TEST(testSlotPriorities);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    DMPE131InflatorTest()
+        : m_fast_inflator(false),
+          m_slow_inflator(false),
+          m_extended_inflator(
+              NewCallback(&m_slow_inflator, &DMPE131Inflator::HandleSync)),
+          m_fast_count(0),
+          m_slow_count(0),
+          m_fast_priority(0),
+          m_slow_priority(0) {
+    }
+
+    void setUp();
+    void testFastPath();
+    void testFastPathSequence();
+    void testFastPathFallback();
+    void testMerge();
+    void testMaxSources();
+    void testSync();
+    void testReceiveStats();
+    void testRedundantCopies();
+    void testSlotPriorities();
+
+ private:
+    DMPE131Inflator m_fast_inflator;
+    DMPE131Inflator m_slow_inflator;
+    RootInflator m_root_inflator;
+    E131Inflator m_e131_inflator;
+    E131ExtendedInflator m_extended_inflator;
+    CID m_cid;
+    DmxBuffer m_fast_buffer;
+    DmxBuffer m_slow_buffer;
+    DmxBuffer m_slot_priorities;
+    unsigned int m_fast_count;
+    unsigned int m_slow_count;
+    uint8_t m_fast_priority;
+    uint8_t m_slow_priority;
+
+    void FastData() { m_fast_count++; }
+    void SlowData() { m_slow_count++; }
+    bool SendPacket(const E131PacketTemplate &packet);
+    void SendFrom(const CID &cid, uint8_t sequence, const string &data,
+                  uint8_t start_code = ola::DMX512_START_CODE);
+    void SendSync(uint16_t sync_address);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DMPE131InflatorTest);
+
+static const uint16_t UNIVERSE = 1;
+
+
+void DMPE131InflatorTest::setUp() {
+  m_cid = CID::Generate();
+  m_root_inflator.AddInflator(&m_e131_inflator);
+  m_root_inflator.AddInflator(&m_extended_inflator);
+  m_e131_inflator.AddInflator(&m_slow_inflator);
+  m_fast_inflator.SetHandler(
+      UNIVERSE, &m_fast_buffer, &m_fast_priority,
+      NewCallback(this, &DMPE131InflatorTest::FastData));
+  m_slow_inflator.SetHandler(
+      UNIVERSE, &m_slow_buffer, &m_slow_priority,
+      NewCallback(this, &DMPE131InflatorTest::SlowData),
+      &m_slot_priorities);
+}
+
+
+/*
+ * Pass a packet to the fast path, and to the inflator chain.
+ * @returns the return value of the fast path.
+ */
+bool DMPE131InflatorTest::SendPacket(const E131PacketTemplate &packet) {
+  const uint8_t *data = packet.Data() + PreamblePacker::ACN_HEADER_SIZE;
+  unsigned int length = packet.Size() - PreamblePacker::ACN_HEADER_SIZE;
+  HeaderSet headers;
+  OLA_ASSERT_EQ(length,
+                m_root_inflator.InflatePDUBlock(&headers, data, length));
+  return m_fast_inflator.HandleDataPacket(data, length);
+}
+
+
+/*
+ * Send some data from a source.
+ */
+void DMPE131InflatorTest::SendFrom(const CID &cid, uint8_t sequence,
+                                   const string &data, uint8_t start_code) {
+  DmxBuffer buffer;
+  buffer.SetFromString(data);
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(cid, "foo", UNIVERSE, false, buffer.Size()));
+  packet.Update(100, sequence, false, buffer, start_code);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+}
+
+
+/*
+ * Pass a sync packet to the inflator chain, and to the fast path inflator.
+ */
+void DMPE131InflatorTest::SendSync(uint16_t sync_address) {
+  E131SyncPDU sync_pdu(0, sync_address);
+  PDUBlock<PDU> sync_block;
+  sync_block.AddPDU(&sync_pdu);
+  RootPDU root_pdu(ola::acn::VECTOR_ROOT_E131_EXTENDED, m_cid, &sync_block);
+  PDUBlock<PDU> root_block;
+  root_block.AddPDU(&root_pdu);
+
+  uint8_t data[PreamblePacker::MAX_DATAGRAM_SIZE];
+  unsigned int length = sizeof(data);
+  OLA_ASSERT_TRUE(root_block.Pack(data, &length));
+  HeaderSet headers;
+  OLA_ASSERT_EQ(length,
+                m_root_inflator.InflatePDUBlock(&headers, data, length));
+  m_fast_inflator.HandleSync(sync_address);
+}
+
+
+/*
+ * Check the fast path produces the same result as the inflators.
+ */
+void DMPE131InflatorTest::testFastPath() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5,6,7,8");
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, false, buffer.Size()));
+
+  packet.Update(120, 0, false, buffer);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(1u, m_fast_count);
+  OLA_ASSERT_EQ(1u, m_slow_count);
+  OLA_ASSERT_DMX_EQUALS(buffer, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), m_fast_priority);
+  OLA_ASSERT_EQ(m_slow_priority, m_fast_priority);
+
+  // a full universe
+  buffer.SetRangeToValue(0, 200, DMX_UNIVERSE_SIZE);
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, false, buffer.Size()));
+  packet.Update(120, 1, false, buffer);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(2u, m_fast_count);
+  OLA_ASSERT_DMX_EQUALS(buffer, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+
+  // Priorities above 200 are ignored
+  packet.Update(201, 2, false, buffer);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(2u, m_fast_count);
+  OLA_ASSERT_EQ(2u, m_slow_count);
+
+  // Packets for other universes are handled but don't trigger the callback
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE + 1, false,
+                               buffer.Size()));
+  packet.Update(100, 3, false, buffer);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(2u, m_fast_count);
+}
+
+
+/*
+ * Check old packets are dropped by the fast path.
+ */
+void DMPE131InflatorTest::testFastPathSequence() {
+  DmxBuffer buffer1, buffer2;
+  buffer1.SetFromString("1,2,3");
+  buffer2.SetFromString("4,5,6");
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, false, 3));
+
+  packet.Update(100, 10, false, buffer1);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  packet.Update(100, 9, false, buffer2);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(1u, m_fast_count);
+  OLA_ASSERT_DMX_EQUALS(buffer1, m_fast_buffer);
+
+  packet.Update(100, 11, false, buffer2);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(2u, m_fast_count);
+  OLA_ASSERT_DMX_EQUALS(buffer2, m_fast_buffer);
+}
+
+
+/*
+ * Check that packets which don't match the fixed layout are rejected.
+ */
+void DMPE131InflatorTest::testFastPathFallback() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, false, buffer.Size()));
+  packet.Update(100, 0, false, buffer);
+
+  const uint8_t *data = packet.Data() + PreamblePacker::ACN_HEADER_SIZE;
+  unsigned int length = packet.Size() - PreamblePacker::ACN_HEADER_SIZE;
+  uint8_t copy[PreamblePacker::MAX_DATAGRAM_SIZE];
+
+  // truncated
+  OLA_ASSERT_FALSE(m_fast_inflator.HandleDataPacket(data, length - 1));
+  OLA_ASSERT_FALSE(m_fast_inflator.HandleDataPacket(data, 20));
+
+  // each of the fixed fields
+  const unsigned int offsets[] = {
+    1,  // root length
+    5,  // root vector
+    23,  // framing length
+    27,  // framing vector
+    100,  // dmp length
+    101,  // dmp vector
+    102,  // dmp header
+    104,  // first address
+    106,  // increment
+    108,  // count
+  };
+  for (unsigned int i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+    memcpy(copy, data, length);
+    copy[offsets[i]] ^= 0x01;
+    OLA_ASSERT_FALSE(m_fast_inflator.HandleDataPacket(copy, length));
+  }
+  OLA_ASSERT_EQ(0u, m_fast_count);
+
+  // but the original is accepted
+  OLA_ASSERT_TRUE(m_fast_inflator.HandleDataPacket(data, length));
+  OLA_ASSERT_EQ(1u, m_fast_count);
+
+  // rev2 packets go through the inflators
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, true, buffer.Size()));
+  packet.Update(100, 0, false, buffer);
+  OLA_ASSERT_FALSE(m_fast_inflator.HandleDataPacket(
+      packet.Data() + PreamblePacker::ACN_HEADER_SIZE,
+      packet.Size() - PreamblePacker::ACN_HEADER_SIZE));
+}
+
+
+/*
+ * Check that data from multiple sources is merged, both when a source is
+ * added and when an existing source changes.
+ */
+void DMPE131InflatorTest::testMerge() {
+  CID cid1 = CID::Generate();
+  CID cid2 = CID::Generate();
+  CID cid3 = CID::Generate();
+
+  SendFrom(cid1, 0, "10,20,30,40");
+  SendFrom(cid2, 0, "40,30,20,10");
+  SendFrom(cid3, 0, "0,0,0,0,50");
+
+  DmxBuffer expected;
+  expected.SetFromString("40,30,30,40,50");
+  OLA_ASSERT_DMX_EQUALS(expected, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+
+  // Lower the slots that cid2 was holding, the other sources take over.
+  SendFrom(cid2, 1, "5,6,20,10");
+  expected.SetFromString("10,20,30,40,50");
+  OLA_ASSERT_DMX_EQUALS(expected, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+
+  // Two sources hold slot 2 at 30 & 20, after this cid2 holds it at 20.
+  SendFrom(cid1, 1, "10,20,0,40");
+  expected.SetFromString("10,20,20,40,50");
+  OLA_ASSERT_DMX_EQUALS(expected, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+
+  // Raise some values
+  SendFrom(cid3, 1, "100,0,0,0,50");
+  expected.SetFromString("100,20,20,40,50");
+  OLA_ASSERT_DMX_EQUALS(expected, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+
+  // A change of length means a full merge
+  SendFrom(cid3, 2, "0,0");
+  expected.SetFromString("10,20,20,40");
+  OLA_ASSERT_DMX_EQUALS(expected, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+  OLA_ASSERT_EQ(m_slow_count, m_fast_count);
+}
+
+
+/*
+ * Check the max number of sources is respected.
+ */
+void DMPE131InflatorTest::testMaxSources() {
+  DMPE131Inflator inflator(false, 2);
+  DmxBuffer buffer;
+  uint8_t priority;
+  unsigned int count = 0;
+  inflator.SetHandler(UNIVERSE, &buffer, &priority,
+                      NewCallback(this, &DMPE131InflatorTest::FastData));
+
+  const CID cids[] = {CID::Generate(), CID::Generate(), CID::Generate()};
+  const char *data[] = {"1,2", "3,4", "5,6"};
+  for (unsigned int i = 0; i < 3; i++) {
+    DmxBuffer source_data;
+    source_data.SetFromString(data[i]);
+    E131PacketTemplate packet;
+    OLA_ASSERT_TRUE(packet.Build(cids[i], "foo", UNIVERSE, false, 2));
+    packet.Update(100, 0, false, source_data);
+    OLA_ASSERT_TRUE(inflator.HandleDataPacket(
+        packet.Data() + PreamblePacker::ACN_HEADER_SIZE,
+        packet.Size() - PreamblePacker::ACN_HEADER_SIZE));
+    count++;
+  }
+
+  // The third source isn't tracked
+  OLA_ASSERT_EQ(2u, m_fast_count);
+  DmxBuffer expected;
+  expected.SetFromString("3,4");
+  OLA_ASSERT_DMX_EQUALS(expected, buffer);
+  OLA_ASSERT_EQ(3u, count);
+}
+
+
+/*
+ * Check that synchronized data is held until the sync arrives.
+ */
+void DMPE131InflatorTest::testSync() {
+  const uint16_t sync_address = 500;
+  DmxBuffer buffer1, buffer2;
+  buffer1.SetFromString("1,2,3");
+  buffer2.SetFromString("4,5,6");
+
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, false, 3,
+                               sync_address));
+  packet.Update(100, 0, false, buffer1);
+
+  // Until we've seen a sync the data is passed on straight away.
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(1u, m_fast_count);
+  OLA_ASSERT_EQ(1u, m_slow_count);
+  OLA_ASSERT_DMX_EQUALS(buffer1, m_fast_buffer);
+
+  SendSync(sync_address);
+  OLA_ASSERT_EQ(1u, m_fast_count);
+
+  // Now it's held
+  packet.Update(100, 1, false, buffer2);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(1u, m_fast_count);
+  OLA_ASSERT_EQ(1u, m_slow_count);
+  OLA_ASSERT_DMX_EQUALS(buffer1, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(buffer1, m_slow_buffer);
+
+  // A sync for a different address doesn't release it.
+  SendSync(sync_address + 1);
+  OLA_ASSERT_EQ(1u, m_fast_count);
+
+  SendSync(sync_address);
+  OLA_ASSERT_EQ(2u, m_fast_count);
+  OLA_ASSERT_EQ(2u, m_slow_count);
+  OLA_ASSERT_DMX_EQUALS(buffer2, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(buffer2, m_slow_buffer);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_fast_priority);
+
+  // Nothing new to release
+  SendSync(sync_address);
+  OLA_ASSERT_EQ(2u, m_fast_count);
+
+  // Unsynchronized data is passed on straight away.
+  OLA_ASSERT_TRUE(packet.Build(m_cid, "foo", UNIVERSE, false, 3));
+  packet.Update(100, 2, false, buffer1);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+  OLA_ASSERT_EQ(3u, m_fast_count);
+  OLA_ASSERT_EQ(3u, m_slow_count);
+  OLA_ASSERT_DMX_EQUALS(buffer1, m_fast_buffer);
+  OLA_ASSERT_DMX_EQUALS(buffer1, m_slow_buffer);
+}
+
+
+/*
+ * Check the receive statistics are updated.
+ */
+void DMPE131InflatorTest::testReceiveStats() {
+  ReceiveStatsMap stats_map("stats", "universe");
+  m_fast_inflator.SetReceiveStats(&stats_map);
+
+  SendFrom(m_cid, 1, "1,2,3");
+  SendFrom(m_cid, 2, "1,2,3");
+  // two packets lost
+  SendFrom(m_cid, 5, "1,2,3");
+  // a late packet
+  SendFrom(m_cid, 3, "1,2,3");
+  OLA_ASSERT_EQ(3u, m_fast_count);
+
+  const ReceiveStats *stats = stats_map.Get("1");
+  OLA_ASSERT_EQ(4u, stats->Packets());
+  OLA_ASSERT_EQ(2u, stats->SequenceGaps());
+  OLA_ASSERT_EQ(1u, stats->OutOfOrder());
+  OLA_ASSERT_TRUE(stats->LastSeen().IsSet());
+
+  stats = stats_map.Get("1/" + m_cid.ToString());
+  OLA_ASSERT_EQ(4u, stats->Packets());
+  OLA_ASSERT_EQ(2u, stats->SequenceGaps());
+  OLA_ASSERT_EQ(1u, stats->OutOfOrder());
+
+  // the source statistics are dropped once a higher priority source takes
+  // over
+  CID cid2 = CID::Generate();
+  DmxBuffer buffer;
+  buffer.SetFromString("4,5,6");
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(cid2, "foo", UNIVERSE, false, buffer.Size()));
+  packet.Update(150, 0, false, buffer);
+  OLA_ASSERT_TRUE(SendPacket(packet));
+
+  vector<std::pair<string, ReceiveStats> > snapshot;
+  stats_map.Snapshot(&snapshot);
+  OLA_ASSERT_EQ((size_t) 2, snapshot.size());
+  OLA_ASSERT_EQ(string("1"), snapshot[0].first);
+  OLA_ASSERT_EQ(string("1/") + cid2.ToString(), snapshot[1].first);
+
+  // and the universe statistics once the handler is removed
+  OLA_ASSERT_TRUE(m_fast_inflator.RemoveHandler(UNIVERSE));
+  snapshot.clear();
+  stats_map.Snapshot(&snapshot);
+  OLA_ASSERT_TRUE(snapshot.empty());
+}
+
+
+/*
+ * Check that copies of a frame from redundant networks are dropped, and
+ * aren't counted as out of order.
+ */
+void DMPE131InflatorTest::testRedundantCopies() {
+  ReceiveStatsMap stats_map("stats", "universe");
+  m_fast_inflator.SetReceiveStats(&stats_map);
+
+  SendFrom(m_cid, 1, "1,2,3");
+  SendFrom(m_cid, 1, "1,2,3");
+  SendFrom(m_cid, 2, "4,5,6");
+  SendFrom(m_cid, 2, "4,5,6");
+  OLA_ASSERT_EQ(2u, m_fast_count);
+  OLA_ASSERT_EQ(2u, m_slow_count);
+
+  DmxBuffer expected;
+  expected.SetFromString("4,5,6");
+  OLA_ASSERT_DMX_EQUALS(expected, m_fast_buffer);
+
+  const ReceiveStats *stats = stats_map.Get("1");
+  OLA_ASSERT_EQ(2u, stats->Packets());
+  OLA_ASSERT_EQ(0u, stats->SequenceGaps());
+  OLA_ASSERT_EQ(0u, stats->OutOfOrder());
+}
+
+
+/*
+ * Check that the sources are merged slot by slot once one of them sends slot
+ * priorities.
+ */
+void DMPE131InflatorTest::testSlotPriorities() {
+  const uint8_t SLOT_PRIORITIES = ola::dmx::SLOT_PRIORITY_START_CODE;
+  CID cid1 = CID::Generate();
+  CID cid2 = CID::Generate();
+
+  SendFrom(cid1, 0, "10,20,30,40");
+  OLA_ASSERT_EQ(0u, m_slot_priorities.Size());
+
+  // Slot 0 isn't sourced by cid2, slot 1 is at a higher priority than cid1,
+  // slot 2 is at the same priority and slot 3 is lower.
+  SendFrom(cid2, 0, "0,200,100,50", SLOT_PRIORITIES);
+  SendFrom(cid2, 1, "50,60,70,80");
+  DmxBuffer expected;
+  expected.SetFromString("10,60,70,40");
+  OLA_ASSERT_DMX_EQUALS(expected, m_slow_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+  expected.SetFromString("100,200,100,100");
+  OLA_ASSERT_DMX_EQUALS(expected, m_slot_priorities);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_slow_priority);
+
+  // Changing the priorities moves the slots between the sources.
+  SendFrom(cid2, 2, "200,0,0,200", SLOT_PRIORITIES);
+  expected.SetFromString("50,20,30,80");
+  OLA_ASSERT_DMX_EQUALS(expected, m_slow_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+
+  // When cid2 stops sourcing slots, cid1 has all of them.
+  SendFrom(cid2, 3, "0,0,0,0", SLOT_PRIORITIES);
+  expected.SetFromString("10,20,30,40");
+  OLA_ASSERT_DMX_EQUALS(expected, m_slow_buffer);
+  OLA_ASSERT_DMX_EQUALS(m_slow_buffer, m_fast_buffer);
+  expected.SetFromString("100,100,100,100");
+  OLA_ASSERT_DMX_EQUALS(expected, m_slot_priorities);
+  OLA_ASSERT_EQ(m_slow_count, m_fast_count);
+}
+}  // namespace acn
+}  // namespace ola
@@ -0,0 +1,251 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131DiscoveryDirectory.cpp
+ * The set of E1.31 sources learnt from universe discovery.
+ * Copyright (C) 2014 Simon Newton
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "libs/acn/E131DiscoveryDirectory.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using std::set;
+using std::string;
+using std::vector;
+
+class E131DiscoveryDirectory::TrackedSource {
+ public:
+  TrackedSource()
+      : clean_counter(0),
+        current_sequence_number(0),
+        total_pages(0) {
+  }
+
+  IPV4Address ip_address;
+  string source_name;
+  set<uint16_t> universes;
+
+  uint8_t clean_counter;
+
+  /**
+   * Add a page.
+   * @param[out] old_universes the previous universe list, if it changed.
+   * @returns true if a complete set of pages was received and the universe
+   *   list changed.
+   */
+  bool NewPage(uint8_t page_number, uint8_t last_page,
+               uint32_t sequence_number,
+               const vector<uint16_t> &universes,
+               set<uint16_t> *old_universes);
+
+ private:
+  uint32_t current_sequence_number;
+  uint16_t total_pages;
+  set<uint8_t> received_pages;
+  set<uint16_t> new_universes;
+};
+
+bool E131DiscoveryDirectory::TrackedSource::NewPage(
+    uint8_t page_number,
+    uint8_t last_page,
+    uint32_t sequence_number,
+    const vector<uint16_t> &rx_universes,
+    set<uint16_t> *old_universes) {
+  clean_counter = 0;
+
+  // This is broken because we don't actually get a sequence number in the
+  // packet yet.
+  // TODO(simon): Get the draft updated and fix this.
+  if (sequence_number != current_sequence_number ||
+      total_pages != last_page) {
+    current_sequence_number = sequence_number;
+    total_pages = last_page;
+    received_pages.clear();
+    new_universes.clear();
+  }
+
+  received_pages.insert(page_number);
+  std::copy(rx_universes.begin(), rx_universes.end(),
+            std::inserter(new_universes, new_universes.end()));
+
+  uint8_t expected_page = 0;
+  set<uint8_t>::const_iterator iter = received_pages.begin();
+  for (; iter != received_pages.end(); ++iter) {
+    if (*iter != expected_page)
+      return false;
+
+    expected_page++;
+  }
+
+  if (expected_page != total_pages + 1) {
+    return false;
+  }
+
+  bool changed = new_universes != universes;
+  if (changed) {
+    old_universes->swap(universes);
+    universes.swap(new_universes);
+  }
+  received_pages.clear();
+  new_universes.clear();
+  total_pages = 0;
+  return changed;
+}
+
+
+E131DiscoveryDirectory::E131DiscoveryDirectory()
+    : m_generation(0),
+      m_controllers_valid(false) {
+}
+
+E131DiscoveryDirectory::~E131DiscoveryDirectory() {
+  STLDeleteValues(&m_sources);
+}
+
+void E131DiscoveryDirectory::NewPage(const acn::CID &cid,
+                                     const IPV4Address &ip_address,
+                                     const string &source_name,
+                                     uint8_t page_number,
+                                     uint8_t last_page,
+                                     uint32_t sequence_number,
+                                     const vector<uint16_t> &universes) {
+  TrackedSources::iterator iter = STLLookupOrInsertNull(&m_sources, cid);
+  if (!iter->second) {
+    iter->second = new TrackedSource();
+    iter->second->ip_address = ip_address;
+    iter->second->source_name = source_name;
+    Changed();
+  }
+
+  TrackedSource *source = iter->second;
+  if (source->ip_address != ip_address) {
+    OLA_INFO << "CID " << cid.ToString() << " changed from "
+             << source->ip_address << " to " << ip_address;
+    source->ip_address = ip_address;
+    Changed();
+  }
+  if (source->source_name != source_name) {
+    source->source_name = source_name;
+    Changed();
+  }
+
+  set<uint16_t> old_universes;
+  if (source->NewPage(page_number, last_page, sequence_number, universes,
+                      &old_universes)) {
+    UpdateUniverses(cid, old_universes, source->universes);
+    Changed();
+  }
+}
+
+void E131DiscoveryDirectory::Expire() {
+  // Delete any sources that we haven't heard from in 2 x the discovery
+  // interval.
+  TrackedSources::iterator iter = m_sources.begin();
+  while (iter != m_sources.end()) {
+    if (iter->second->clean_counter >= 2) {
+      OLA_INFO << "Removing " << iter->first.ToString()
+               << " due to inactivity";
+      UpdateUniverses(iter->first, iter->second->universes,
+                      set<uint16_t>());
+      delete iter->second;
+      m_sources.erase(iter++);
+      Changed();
+    } else {
+      iter->second->clean_counter++;
+      iter++;
+    }
+  }
+}
+
+void E131DiscoveryDirectory::GetControllers(
+    vector<KnownController> *controllers) const {
+  if (!m_controllers_valid) {
+    m_controllers.clear();
+    m_controllers.reserve(m_sources.size());
+    TrackedSources::const_iterator iter = m_sources.begin();
+    for (; iter != m_sources.end(); ++iter) {
+      m_controllers.push_back(KnownController());
+      KnownController &controller = m_controllers.back();
+
+      controller.cid = iter->first;
+      controller.ip_address = iter->second->ip_address;
+      controller.source_name = iter->second->source_name;
+      controller.universes = iter->second->universes;
+    }
+    m_controllers_valid = true;
+  }
+  controllers->insert(controllers->end(), m_controllers.begin(),
+                      m_controllers.end());
+}
+
+void E131DiscoveryDirectory::SourcesForUniverse(
+    uint16_t universe,
+    vector<acn::CID> *sources) const {
+  const set<acn::CID> *cids = STLFind(&m_universe_index, universe);
+  if (cids) {
+    sources->insert(sources->end(), cids->begin(), cids->end());
+  }
+}
+
+/*
+ * Update the universe index for a source, only the universes that differ
+ * between the old and new lists are touched.
+ */
+void E131DiscoveryDirectory::UpdateUniverses(
+    const acn::CID &cid,
+    const set<uint16_t> &old_universes,
+    const set<uint16_t> &new_universes) {
+  vector<uint16_t> removed;
+  std::set_difference(old_universes.begin(), old_universes.end(),
+                      new_universes.begin(), new_universes.end(),
+                      std::back_inserter(removed));
+  vector<uint16_t>::const_iterator iter = removed.begin();
+  for (; iter != removed.end(); ++iter) {
+    UniverseIndex::iterator index_iter = m_universe_index.find(*iter);
+    if (index_iter == m_universe_index.end()) {
+      continue;
+    }
+    index_iter->second.erase(cid);
+    if (index_iter->second.empty()) {
+      m_universe_index.erase(index_iter);
+    }
+  }
+
+  vector<uint16_t> added;
+  std::set_difference(new_universes.begin(), new_universes.end(),
+                      old_universes.begin(), old_universes.end(),
+                      std::back_inserter(added));
+  for (iter = added.begin(); iter != added.end(); ++iter) {
+    m_universe_index[*iter].insert(cid);
+  }
+}
+
+void E131DiscoveryDirectory::Changed() {
+  m_generation++;
+  m_controllers_valid = false;
+}
+}  // namespace acn
+}  // namespace ola
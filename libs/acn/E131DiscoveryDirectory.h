@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131DiscoveryDirectory.h
+ * The set of E1.31 sources learnt from universe discovery.
+ * Copyright (C) 2014 Simon Newton
+ */
+
+#ifndef LIBS_ACN_E131DISCOVERYDIRECTORY_H_
+#define LIBS_ACN_E131DISCOVERYDIRECTORY_H_
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include HASH_MAP_H
+#include "ola/acn/CID.h"
+#include "ola/base/Macro.h"
+#include "ola/network/IPV4Address.h"
+
+namespace ola {
+namespace acn {
+
+/**
+ * @brief The E1.31 sources learnt from universe discovery.
+ *
+ * Sources repeat their discovery pages every 10s, and on a large network the
+ * pages rarely change. The directory is updated incrementally: a source's
+ * universe list is only replaced, and the universe index updated, when a
+ * complete set of pages differs from what we already have.
+ *
+ * Each change bumps the generation, so a caller polling the directory can
+ * skip any work if the generation hasn't moved.
+ */
+class E131DiscoveryDirectory {
+ public:
+  struct KnownController {
+    acn::CID cid;
+    ola::network::IPV4Address ip_address;
+    std::string source_name;
+    std::set<uint16_t> universes;
+  };
+
+  E131DiscoveryDirectory();
+  ~E131DiscoveryDirectory();
+
+  /**
+   * @brief Add a discovery page from a source.
+   * @param cid the CID of the source.
+   * @param ip_address the IP address the page came from.
+   * @param source_name the name of the source.
+   * @param page_number the number of this page.
+   * @param last_page the number of the last page.
+   * @param sequence_number the page sequence number.
+   * @param universes the universes in this page.
+   */
+  void NewPage(const acn::CID &cid,
+               const ola::network::IPV4Address &ip_address,
+               const std::string &source_name,
+               uint8_t page_number,
+               uint8_t last_page,
+               uint32_t sequence_number,
+               const std::vector<uint16_t> &universes);
+
+  /**
+   * @brief Remove the sources that haven't been heard from.
+   *
+   * This should be called once per discovery interval, a source is removed
+   * if it hasn't sent a page in the last two calls.
+   */
+  void Expire();
+
+  /**
+   * @brief The generation of the directory, this changes each time a source
+   * is added, removed or modified.
+   */
+  uint32_t Generation() const { return m_generation; }
+
+  size_t SourceCount() const { return m_sources.size(); }
+
+  /**
+   * @brief Append the known controllers to a vector.
+   *
+   * The list is built from the sources when it's first requested after a
+   * change, and copied from the cache otherwise.
+   */
+  void GetControllers(std::vector<KnownController> *controllers) const;
+
+  /**
+   * @brief Get the sources that are sending a universe.
+   * @param universe the universe to look up.
+   * @param[out] sources the CIDs of the sources are appended to this.
+   */
+  void SourcesForUniverse(uint16_t universe,
+                          std::vector<acn::CID> *sources) const;
+
+ private:
+  class TrackedSource;
+
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<acn::CID, TrackedSource*,
+                                        acn::CIDHash> TrackedSources;
+  typedef std::map<uint16_t, std::set<acn::CID> > UniverseIndex;
+
+  TrackedSources m_sources;
+  UniverseIndex m_universe_index;
+  uint32_t m_generation;
+
+  mutable std::vector<KnownController> m_controllers;
+  mutable bool m_controllers_valid;
+
+  void UpdateUniverses(const acn::CID &cid,
+                       const std::set<uint16_t> &old_universes,
+                       const std::set<uint16_t> &new_universes);
+  void Changed();
+
+  DISALLOW_COPY_AND_ASSIGN(E131DiscoveryDirectory);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131DISCOVERYDIRECTORY_H_
@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131DiscoveryDirectoryTest.cpp
+ * Test fixture for the E131DiscoveryDirectory class
+ * Copyright (C) 2014 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "libs/acn/E131DiscoveryDirectory.h"
+#include "ola/acn/CID.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::acn::CID;
+using ola::acn::E131DiscoveryDirectory;
+using ola::network::IPV4Address;
+using std::string;
+using std::vector;
+
+class E131DiscoveryDirectoryTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(E131DiscoveryDirectoryTest);
+  CPPUNIT_TEST(testSinglePage);
+  CPPUNIT_TEST(testMultiplePages);
+  CPPUNIT_TEST(testExpire);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+
+  void testSinglePage();
+  void testMultiplePages();
+  void testExpire();
+
+ private:
+  CID m_cid1, m_cid2;
+  IPV4Address m_ip1, m_ip2;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(E131DiscoveryDirectoryTest);
+
+void E131DiscoveryDirectoryTest::setUp() {
+  m_cid1 = CID::Generate();
+  m_cid2 = CID::Generate();
+  OLA_ASSERT_TRUE(IPV4Address::FromString("10.0.0.1", &m_ip1));
+  OLA_ASSERT_TRUE(IPV4Address::FromString("10.0.0.2", &m_ip2));
+}
+
+
+/*
+ * Check sources that send a single page.
+ */
+void E131DiscoveryDirectoryTest::testSinglePage() {
+  E131DiscoveryDirectory directory;
+  OLA_ASSERT_EQ(static_cast<size_t>(0), directory.SourceCount());
+  uint32_t generation = directory.Generation();
+
+  vector<uint16_t> universes;
+  universes.push_back(1);
+  universes.push_back(2);
+  directory.NewPage(m_cid1, m_ip1, "console 1", 0, 0, 0, universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), directory.SourceCount());
+  OLA_ASSERT_NE(generation, directory.Generation());
+  generation = directory.Generation();
+
+  vector<E131DiscoveryDirectory::KnownController> controllers;
+  directory.GetControllers(&controllers);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), controllers.size());
+  OLA_ASSERT_TRUE(m_cid1 == controllers[0].cid);
+  OLA_ASSERT_EQ(m_ip1, controllers[0].ip_address);
+  OLA_ASSERT_EQ(string("console 1"), controllers[0].source_name);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), controllers[0].universes.size());
+
+  // The same page again doesn't change anything.
+  directory.NewPage(m_cid1, m_ip1, "console 1", 0, 0, 0, universes);
+  OLA_ASSERT_EQ(generation, directory.Generation());
+
+  // A second source, sharing universe 2.
+  vector<uint16_t> universes2;
+  universes2.push_back(2);
+  universes2.push_back(3);
+  directory.NewPage(m_cid2, m_ip2, "console 2", 0, 0, 0, universes2);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), directory.SourceCount());
+
+  vector<CID> sources;
+  directory.SourcesForUniverse(1, &sources);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), sources.size());
+  OLA_ASSERT_TRUE(m_cid1 == sources[0]);
+
+  sources.clear();
+  directory.SourcesForUniverse(2, &sources);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), sources.size());
+
+  sources.clear();
+  directory.SourcesForUniverse(4, &sources);
+  OLA_ASSERT_EMPTY(sources);
+
+  // The first source stops sending universe 1.
+  generation = directory.Generation();
+  universes.erase(universes.begin());
+  directory.NewPage(m_cid1, m_ip1, "console 1", 0, 0, 0, universes);
+  OLA_ASSERT_NE(generation, directory.Generation());
+
+  sources.clear();
+  directory.SourcesForUniverse(1, &sources);
+  OLA_ASSERT_EMPTY(sources);
+
+  // A name change is a change.
+  generation = directory.Generation();
+  directory.NewPage(m_cid1, m_ip1, "renamed", 0, 0, 0, universes);
+  OLA_ASSERT_NE(generation, directory.Generation());
+
+  controllers.clear();
+  directory.GetControllers(&controllers);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), controllers.size());
+}
+
+
+/*
+ * Check the universes are only updated once all the pages arrive.
+ */
+void E131DiscoveryDirectoryTest::testMultiplePages() {
+  E131DiscoveryDirectory directory;
+
+  vector<uint16_t> page0, page1;
+  page0.push_back(1);
+  page1.push_back(600);
+
+  directory.NewPage(m_cid1, m_ip1, "console", 0, 1, 0, page0);
+  vector<CID> sources;
+  directory.SourcesForUniverse(1, &sources);
+  OLA_ASSERT_EMPTY(sources);
+
+  uint32_t generation = directory.Generation();
+  directory.NewPage(m_cid1, m_ip1, "console", 1, 1, 0, page1);
+  OLA_ASSERT_NE(generation, directory.Generation());
+
+  directory.SourcesForUniverse(1, &sources);
+  directory.SourcesForUniverse(600, &sources);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), sources.size());
+
+  // Repeating both pages doesn't change anything.
+  generation = directory.Generation();
+  directory.NewPage(m_cid1, m_ip1, "console", 0, 1, 0, page0);
+  directory.NewPage(m_cid1, m_ip1, "console", 1, 1, 0, page1);
+  OLA_ASSERT_EQ(generation, directory.Generation());
+}
+
+
+/*
+ * Check sources are removed once they stop sending.
+ */
+void E131DiscoveryDirectoryTest::testExpire() {
+  E131DiscoveryDirectory directory;
+
+  vector<uint16_t> universes;
+  universes.push_back(1);
+  directory.NewPage(m_cid1, m_ip1, "console 1", 0, 0, 0, universes);
+  directory.NewPage(m_cid2, m_ip2, "console 2", 0, 0, 0, universes);
+
+  directory.Expire();
+  directory.Expire();
+  OLA_ASSERT_EQ(static_cast<size_t>(2), directory.SourceCount());
+
+  // Only the second source is still sending.
+  directory.NewPage(m_cid2, m_ip2, "console 2", 0, 0, 0, universes);
+  uint32_t generation = directory.Generation();
+  directory.Expire();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), directory.SourceCount());
+  OLA_ASSERT_NE(generation, directory.Generation());
+
+  vector<CID> sources;
+  directory.SourcesForUniverse(1, &sources);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), sources.size());
+  OLA_ASSERT_TRUE(m_cid2 == sources[0]);
+
+  vector<E131DiscoveryDirectory::KnownController> controllers;
+  directory.GetControllers(&controllers);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), controllers.size());
+  OLA_ASSERT_TRUE(m_cid2 == controllers[0].cid);
+}
@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131ExtendedInflator.cpp
+ * The Inflator for the E1.31 extended framing layer.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <string.h>
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/network/NetworkUtils.h"
+#include "libs/acn/E131ExtendedInflator.h"
+#include "libs/acn/E131SyncPDU.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::NetworkToHost;
+
+/*
+ * Handle an extended PDU.
+ */
+bool E131ExtendedInflator::HandlePDUData(uint32_t vector,
+                                         OLA_UNUSED const HeaderSet &headers,
+                                         const uint8_t *data,
+                                         unsigned int pdu_len) {
+  if (vector != ola::acn::VECTOR_E131_EXTENDED_SYNCHRONIZATION) {
+    OLA_DEBUG << "Ignoring E1.31 extended PDU with vector " << vector;
+    return true;
+  }
+
+  E131SyncPDU::e131_sync_header header;
+  if (pdu_len < sizeof(header)) {
+    OLA_WARN << "E1.31 sync packet is too small: " << pdu_len;
+    return true;
+  }
+  memcpy(&header, data, sizeof(header));
+
+  uint16_t sync_address = NetworkToHost(header.sync_address);
+  if (sync_address && m_sync_callback.get()) {
+    m_sync_callback->Run(sync_address);
+  }
+  return true;
+}
+}  // namespace acn
+}  // namespace ola
@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131ExtendedInflator.h
+ * Interface for the E131ExtendedInflator class.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * This handles the E1.31-2016 extended framing layer, which is used for
+ * synchronization packets.
+ */
+
+#ifndef LIBS_ACN_E131EXTENDEDINFLATOR_H_
+#define LIBS_ACN_E131EXTENDEDINFLATOR_H_
+
+#include <memory>
+#include "ola/Callback.h"
+#include "ola/acn/ACNVectors.h"
+#include "libs/acn/BaseInflator.h"
+
+namespace ola {
+namespace acn {
+
+class E131ExtendedInflator: public BaseInflator {
+ public:
+  // Called with the sync address when a sync packet arrives.
+  typedef ola::Callback1<void, uint16_t> SyncCallback;
+
+  /**
+   * @brief Create a new E131ExtendedInflator.
+   * @param sync_callback the callback to run when a sync packet is received.
+   *   Ownership is transferred.
+   */
+  explicit E131ExtendedInflator(SyncCallback *sync_callback)
+      : BaseInflator(),
+        m_sync_callback(sync_callback) {
+  }
+  ~E131ExtendedInflator() {}
+
+  uint32_t Id() const { return ola::acn::VECTOR_ROOT_E131_EXTENDED; }
+
+ protected:
+  // The extended PDUs don't share a header, each vector has its own layout.
+  bool DecodeHeader(HeaderSet *,
+                    const uint8_t *,
+                    unsigned int,
+                    unsigned int *bytes_used) {
+    *bytes_used = 0;
+    return true;
+  }
+
+  void ResetHeaderField() {}
+
+  bool HandlePDUData(uint32_t vector,
+                     const HeaderSet &headers,
+                     const uint8_t *data,
+                     unsigned int pdu_len);
+
+ private:
+  std::auto_ptr<SyncCallback> m_sync_callback;
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131EXTENDEDINFLATOR_H_
@@ -27,6 +27,8 @@
 #include <vector>
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/dmx/SourcePriorities.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/stl/STLUtils.h"
 #include "libs/acn/E131Node.h"
@@ -39,73 +41,46 @@ using ola::DmxBuffer;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::HostToNetwork;
+using ola::network::UDPSocket;
 using std::auto_ptr;
 using std::map;
 using std::string;
-using std::set;
 using std::vector;
 
-class TrackedSource {
+/*
+ * An extra socket used to receive universe data, along with the transport
+ * that reads from it.
+ */
+class ReceiveSocket {
  public:
-  TrackedSource()
-      : clean_counter(0),
-        current_sequence_number(0),
-        total_pages(0) {
+  ReceiveSocket(BaseInflator *inflator, DMPE131Inflator *dmp_inflator)
+      : transport(&socket, inflator) {
+    transport.SetFastPath(
+        NewCallback(dmp_inflator, &DMPE131Inflator::HandleDataPacket));
+    socket.SetOnData(NewCallback(&transport, &IncomingUDPTransport::Receive));
   }
 
-  IPV4Address ip_address;
-  string source_name;
-  set<uint16_t> universes;
-
-  uint8_t clean_counter;
-
-  void NewPage(uint8_t page_number, uint8_t last_page,
-               uint32_t sequence_number,
-               const vector<uint16_t> &universes);
-
- private:
-  uint32_t current_sequence_number;
-  uint16_t total_pages;
-  set<uint8_t> received_pages;
-  set<uint16_t> new_universes;
+  UDPSocket socket;
+  IncomingUDPTransport transport;
 };
 
-void TrackedSource::NewPage(uint8_t page_number, uint8_t last_page,
-                            uint32_t sequence_number,
-                            const vector<uint16_t> &rx_universes) {
-  clean_counter = 0;
-
-  // This is broken because we don't actually get a sequence number in the
-  // packet yet.
-  // TODO(simon): Get the draft updated and fix this.
-  if (sequence_number != current_sequence_number ||
-      total_pages != last_page) {
-    current_sequence_number = sequence_number;
-    total_pages = last_page;
-    received_pages.clear();
-    new_universes.clear();
+/*
+ * An additional interface used for redundant networks. The socket is only
+ * used to send, the groups are joined on the receive sockets.
+ */
+class RedundantInterface {
+ public:
+  explicit RedundantInterface(RootSender *root_sender)
+      : sender(&socket, root_sender) {
   }
 
-  received_pages.insert(page_number);
-  std::copy(rx_universes.begin(), rx_universes.end(),
-            std::inserter(new_universes, new_universes.end()));
-
-  uint8_t expected_page = 0;
-  set<uint8_t>::const_iterator iter = received_pages.begin();
-  for (; iter != received_pages.end(); ++iter) {
-    if (*iter != expected_page)
-      return;
-
-    expected_page++;
-  }
+  ola::network::Interface iface;
+  UDPSocket socket;
+  E131Sender sender;
+};
 
-  if (expected_page == total_pages + 1) {
-    universes = new_universes;
-    received_pages.clear();
-    new_universes.clear();
-    total_pages = 0;
-  }
-}
+const char E131Node::RECEIVE_DROPS_VAR[] = "e131-receive-drops";
+const char E131Node::RECEIVE_STATS_VAR[] = "e131-receive-stats";
 
 E131Node::E131Node(ola::thread::SchedulerInterface *ss,
                    const string &ip_address,
@@ -117,11 +92,21 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
       m_cid(cid),
       m_root_sender(m_cid),
       m_e131_sender(&m_socket, &m_root_sender),
-      m_dmp_inflator(options.ignore_preview),
+      m_dmp_inflator(options.ignore_preview, options.max_merge_sources),
       m_discovery_inflator(NewCallback(this, &E131Node::NewDiscoveryPage)),
+      m_extended_inflator(
+          NewCallback(&m_dmp_inflator, &DMPE131Inflator::HandleSync)),
       m_incoming_udp_transport(&m_socket, &m_root_inflator),
+      m_drop_map(NULL),
+      m_drop_count_timeout(ola::thread::INVALID_TIMEOUT),
       m_send_buffer(NULL),
-      m_discovery_timeout(ola::thread::INVALID_TIMEOUT) {
+      m_source_filters(options.source_filters),
+      m_batch_id(0),
+      m_sync_universe(options.use_rev2 ? 0 : options.sync_universe),
+      m_sync_sequence(0),
+      m_sync_timeout(ola::thread::INVALID_TIMEOUT),
+      m_discovery_timeout(ola::thread::INVALID_TIMEOUT),
+      m_discovery_pages_valid(false) {
 
 
   if (!m_options.use_rev2) {
@@ -133,9 +118,12 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
   // setup all the inflators
   m_root_inflator.AddInflator(&m_e131_inflator);
   m_root_inflator.AddInflator(&m_e131_rev2_inflator);
+  m_root_inflator.AddInflator(&m_extended_inflator);
   m_e131_inflator.AddInflator(&m_dmp_inflator);
   m_e131_inflator.AddInflator(&m_discovery_inflator);
   m_e131_rev2_inflator.AddInflator(&m_dmp_inflator);
+  m_incoming_udp_transport.SetFastPath(
+      NewCallback(&m_dmp_inflator, &DMPE131Inflator::HandleDataPacket));
 }
 
 
@@ -155,7 +143,8 @@ E131Node::~E131Node() {
   if (m_send_buffer)
     delete[] m_send_buffer;
 
-  STLDeleteValues(&m_discovered_sources);
+  STLDeleteElements(&m_receive_sockets);
+  STLDeleteElements(&m_redundant_interfaces);
 }
 
 
@@ -186,13 +175,55 @@ bool E131Node::Start() {
   m_socket.SetOnData(NewCallback(&m_incoming_udp_transport,
                                  &IncomingUDPTransport::Receive));
 
+  if (m_options.receive_sockets > 1 && m_receive_sockets.empty() &&
+      !SetupReceiveSockets()) {
+    return false;
+  }
+
+  if (m_redundant_interfaces.empty() && !SetupRedundantInterfaces()) {
+    return false;
+  }
+
+  if (m_options.use_packet_ring && !m_packet_ring.get()) {
+    SetupPacketRing();
+  }
+
+  if (m_options.transmit_pacer) {
+    m_e131_sender.SetTransmitPacer(m_options.transmit_pacer,
+                                   m_interface.ip_address);
+    RedundantInterfaces::iterator redundant_iter =
+        m_redundant_interfaces.begin();
+    for (; redundant_iter != m_redundant_interfaces.end(); ++redundant_iter) {
+      (*redundant_iter)->sender.SetTransmitPacer(
+          m_options.transmit_pacer, (*redundant_iter)->iface.ip_address);
+    }
+  }
+
+  if (m_options.export_map &&
+      m_drop_count_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_drop_map = m_options.export_map->GetShardedCounterMapVar(
+        RECEIVE_DROPS_VAR, "socket");
+    m_dmp_inflator.SetReceiveStats(
+        m_options.export_map->GetReceiveStatsMapVar(RECEIVE_STATS_VAR,
+                                                    "universe"));
+    m_drop_count_timeout = m_ss->RegisterRepeatingTimeout(
+        DROP_COUNT_INTERVAL,
+        ola::NewCallback(this, &E131Node::UpdateDropCounts));
+  }
+
+  if (m_sync_universe) {
+    // Other sources may use the same sync universe.
+    IPV4Address addr;
+    if (!m_e131_sender.UniverseIP(m_sync_universe, &addr)) {
+      return false;
+    }
+    JoinGroup(&m_socket, addr);
+  }
+
   if (m_options.enable_draft_discovery) {
     IPV4Address addr;
     m_e131_sender.UniverseIP(DISCOVERY_UNIVERSE_ID, &addr);
-
-    if (!m_socket.JoinMulticast(m_interface.ip_address, addr)) {
-      OLA_WARN << "Failed to join multicast group " << addr;
-    }
+    JoinGroup(&m_socket, addr);
 
     m_discovery_timeout = m_ss->RegisterRepeatingTimeout(
         UNIVERSE_DISCOVERY_INTERVAL,
@@ -204,6 +235,22 @@ bool E131Node::Start() {
 bool E131Node::Stop() {
   m_ss->RemoveTimeout(m_discovery_timeout);
   m_discovery_timeout = ola::thread::INVALID_TIMEOUT;
+  if (m_sync_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_sync_timeout);
+    m_sync_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+  if (m_drop_count_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_drop_count_timeout);
+    m_drop_count_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  if (m_options.transmit_pacer) {
+    m_options.transmit_pacer->Flush(&m_socket);
+    RedundantInterfaces::iterator iter = m_redundant_interfaces.begin();
+    for (; iter != m_redundant_interfaces.end(); ++iter) {
+      m_options.transmit_pacer->Flush(&(*iter)->socket);
+    }
+  }
   return true;
 }
 
@@ -215,6 +262,7 @@ bool E131Node::SetSourceName(uint16_t universe, const string &source) {
     settings->source = source;
   } else {
     iter->second.source = source;
+    iter->second.packet.Reset();
   }
   return true;
 }
@@ -237,7 +285,9 @@ bool E131Node::TerminateStream(uint16_t universe, uint8_t priority) {
   for (unsigned int i = 0; i < 3; i++) {
     SendStreamTerminated(universe, DmxBuffer(), priority);
   }
-  STLRemove(&m_tx_universes, universe);
+  if (STLRemove(&m_tx_universes, universe)) {
+    m_discovery_pages_valid = false;
+  }
   return true;
 }
 
@@ -249,11 +299,34 @@ bool E131Node::SendDMX(uint16_t universe,
 }
 
 
+bool E131Node::SendSlotPriorities(uint16_t universe,
+                                  const ola::DmxBuffer &priorities,
+                                  uint8_t priority,
+                                  bool preview) {
+  if (m_options.use_rev2) {
+    return false;
+  }
+  return SendFrame(universe, priorities, ola::dmx::SLOT_PRIORITY_START_CODE,
+                   0, priority, preview);
+}
+
+
 bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
                                          const ola::DmxBuffer &buffer,
                                          int8_t sequence_offset,
                                          uint8_t priority,
                                          bool preview) {
+  return SendFrame(universe, buffer, DMX512_START_CODE, sequence_offset,
+                   priority, preview);
+}
+
+
+bool E131Node::SendFrame(uint16_t universe,
+                         const ola::DmxBuffer &buffer,
+                         uint8_t start_code,
+                         int8_t sequence_offset,
+                         uint8_t priority,
+                         bool preview) {
   ActiveTxUniverses::iterator iter = m_tx_universes.find(universe);
   tx_universe *settings;
 
@@ -263,44 +336,98 @@ bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
     settings = &iter->second;
   }
 
-  const uint8_t *dmp_data;
-  unsigned int dmp_data_length;
+  // The headers don't change from frame to frame, so rather than packing the
+  // whole PDU stack each time we patch a pre-built packet.
+  E131PacketTemplate *packet = &settings->packet;
+  if (!packet->IsValidFor(buffer.Size()) &&
+      !packet->Build(m_cid, settings->source, universe, m_options.use_rev2,
+                     buffer.Size(), m_sync_universe)) {
+    return false;
+  }
 
-  if (m_options.use_rev2) {
-    dmp_data = buffer.GetRaw();
-    dmp_data_length = buffer.Size();
+  packet->Update(priority,
+                 static_cast<uint8_t>(settings->sequence + sequence_offset),
+                 preview, buffer, start_code);
+  bool result;
+  RedundantInterfaces::iterator redundant_iter =
+      m_redundant_interfaces.begin();
+  if (m_options.transmit_pacer) {
+    ola::network::UDPDatagram datagram;
+    datagram.buffer.iov_base = const_cast<uint8_t*>(packet->Data());
+    datagram.buffer.iov_len = packet->Size();
+    datagram.address = packet->Destination();
+    m_options.transmit_pacer->Send(&m_socket, m_interface.ip_address,
+                                   &datagram, 1);
+    for (; redundant_iter != m_redundant_interfaces.end(); ++redundant_iter) {
+      m_options.transmit_pacer->Send(&(*redundant_iter)->socket,
+                                     (*redundant_iter)->iface.ip_address,
+                                     &datagram, 1);
+    }
+    result = true;
   } else {
-    unsigned int data_size = DMX_UNIVERSE_SIZE;
-    buffer.Get(m_send_buffer + 1, &data_size);
-    dmp_data = m_send_buffer;
-    dmp_data_length = data_size + 1;
+    ssize_t sent = m_socket.SendTo(packet->Data(), packet->Size(),
+                                   packet->Destination());
+    result = sent == static_cast<ssize_t>(packet->Size());
+
+    // The same packet, including the sequence number, goes out on the
+    // redundant interfaces so receivers can drop the copies.
+    for (; redundant_iter != m_redundant_interfaces.end(); ++redundant_iter) {
+      (*redundant_iter)->socket.SendTo(packet->Data(), packet->Size(),
+                                       packet->Destination());
+    }
   }
-
-  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) dmp_data_length);
-  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(&range_addr,
-                                                     dmp_data,
-                                                     dmp_data_length);
-  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
-  ranged_chunks.push_back(range_chunk);
-  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true,
-                                                       false,
-                                                       ranged_chunks);
-
-  E131Header header(settings->source,
-                    priority,
-                    static_cast<uint8_t>(settings->sequence + sequence_offset),
-                    universe,
-                    preview,  // preview
-                    false,  // terminated
-                    m_options.use_rev2);
-
-  bool result = m_e131_sender.SendDMP(header, pdu);
   if (result && !sequence_offset)
     settings->sequence++;
-  delete pdu;
+
+  if (result) {
+    ScheduleSync();
+  }
   return result;
 }
 
+unsigned int E131Node::SendDMXBatch(const vector<DMXFrame> &frames) {
+  m_batch_id++;
+  m_batch_datagrams.clear();
+  m_batch_universes.clear();
+  unsigned int sent = 0;
+
+  vector<DMXFrame>::const_iterator frame = frames.begin();
+  for (; frame != frames.end(); ++frame) {
+    ActiveTxUniverses::iterator iter = m_tx_universes.find(frame->universe);
+    tx_universe *settings = (iter == m_tx_universes.end() ?
+        SetupOutgoingSettings(frame->universe) : &iter->second);
+
+    // The template holds one frame, send what we have before reusing it.
+    if (settings->batch_id == m_batch_id) {
+      sent += FlushBatch();
+    }
+
+    E131PacketTemplate *packet = &settings->packet;
+    if (!packet->IsValidFor(frame->buffer->Size()) &&
+        !packet->Build(m_cid, settings->source, frame->universe,
+                       m_options.use_rev2, frame->buffer->Size(),
+                       m_sync_universe)) {
+      continue;
+    }
+    packet->Update(frame->priority, settings->sequence, frame->preview,
+                   *frame->buffer);
+    settings->batch_id = m_batch_id;
+
+    ola::network::UDPDatagram datagram;
+    datagram.buffer.iov_base = const_cast<uint8_t*>(packet->Data());
+    datagram.buffer.iov_len = packet->Size();
+    datagram.address = packet->Destination();
+    m_batch_datagrams.push_back(datagram);
+    m_batch_universes.push_back(settings);
+  }
+  sent += FlushBatch();
+
+  if (sent) {
+    ScheduleSync();
+  }
+  return sent;
+}
+
 bool E131Node::SendStreamTerminated(uint16_t universe,
                                     const ola::DmxBuffer &buffer,
                                     uint8_t priority) {
@@ -338,6 +465,11 @@ bool E131Node::SendStreamTerminated(uint16_t universe,
                     false);
 
   bool result = m_e131_sender.SendDMP(header, pdu);
+  RedundantInterfaces::iterator redundant_iter =
+      m_redundant_interfaces.begin();
+  for (; redundant_iter != m_redundant_interfaces.end(); ++redundant_iter) {
+    (*redundant_iter)->sender.SendDMP(header, pdu);
+  }
   // only update if we were previously tracking this universe
   if (result && iter != m_tx_universes.end())
     iter->second.sequence++;
@@ -345,53 +477,65 @@ bool E131Node::SendStreamTerminated(uint16_t universe,
   return result;
 }
 
+bool E131Node::SendSync() {
+  if (!m_sync_universe) {
+    return false;
+  }
+  const uint8_t sequence = m_sync_sequence++;
+  RedundantInterfaces::iterator iter = m_redundant_interfaces.begin();
+  for (; iter != m_redundant_interfaces.end(); ++iter) {
+    (*iter)->sender.SendSync(m_sync_universe, sequence);
+  }
+  return m_e131_sender.SendSync(m_sync_universe, sequence);
+}
+
 bool E131Node::SetHandler(uint16_t universe,
                           DmxBuffer *buffer,
                           uint8_t *priority,
-                          Callback0<void> *closure) {
-  IPV4Address addr;
-  if (!m_e131_sender.UniverseIP(universe, &addr)) {
-    OLA_WARN << "Unable to determine multicast group for universe " <<
-      universe;
+                          Callback0<void> *closure,
+                          DmxBuffer *slot_priorities) {
+  if (!STLContains(m_joined_sources, universe) && !JoinUniverse(universe)) {
     return false;
   }
 
-  if (!m_socket.JoinMulticast(m_interface.ip_address, addr)) {
-    OLA_WARN << "Failed to join multicast group " << addr;
+  return m_dmp_inflator.SetHandler(universe, buffer, priority, closure,
+                                   slot_priorities);
+}
+
+bool E131Node::RemoveHandler(uint16_t universe) {
+  if (!LeaveUniverse(universe)) {
     return false;
   }
 
-  return m_dmp_inflator.SetHandler(universe, buffer, priority, closure);
+  return m_dmp_inflator.RemoveHandler(universe);
 }
 
-bool E131Node::RemoveHandler(uint16_t universe) {
-  IPV4Address addr;
-  if (!m_e131_sender.UniverseIP(universe, &addr)) {
-    OLA_WARN << "Unable to determine multicast group for universe " <<
-      universe;
-    return false;
+
+bool E131Node::SetSourceFilter(uint16_t universe, const SourceSet &sources) {
+  if (sources.empty()) {
+    m_source_filters.erase(universe);
+  } else {
+    m_source_filters[universe] = sources;
   }
 
-  if (!m_socket.LeaveMulticast(m_interface.ip_address, addr)) {
-    OLA_WARN << "Failed to leave multicast group " << addr;
-    return false;
+  if (!STLContains(m_joined_sources, universe)) {
+    return true;
   }
+  LeaveUniverse(universe);
+  return JoinUniverse(universe);
+}
 
-  return m_dmp_inflator.RemoveHandler(universe);
+
+void E131Node::GetReceiveSockets(vector<UDPSocket*> *sockets) {
+  ReceiveSockets::iterator iter = m_receive_sockets.begin();
+  for (; iter != m_receive_sockets.end(); ++iter) {
+    sockets->push_back(&(*iter)->socket);
+  }
 }
 
 
 void E131Node::GetKnownControllers(std::vector<KnownController> *controllers) {
-  TrackedSources::const_iterator iter = m_discovered_sources.begin();
-  for (; iter != m_discovered_sources.end(); ++iter) {
-    controllers->push_back(KnownController());
-    KnownController &controller = controllers->back();
-
-    controller.cid = iter->first;
-    controller.ip_address = iter->second->ip_address;
-    controller.source_name = iter->second->source_name;
-    controller.universes = iter->second->universes;
-  }
+  m_discovery_directory.GetControllers(controllers);
 }
 
 /*
@@ -401,89 +545,423 @@ E131Node::tx_universe *E131Node::SetupOutgoingSettings(uint16_t universe) {
   tx_universe settings;
   settings.source = m_options.source_name;
   settings.sequence = 0;
+  settings.batch_id = 0;
   ActiveTxUniverses::iterator iter =
       m_tx_universes.insert(std::make_pair(universe, settings)).first;
+  m_discovery_pages_valid = false;
   return &iter->second;
 }
 
 
-bool E131Node::PerformDiscoveryHousekeeping() {
-  // Send the Universe Discovery packets.
-  vector<uint16_t> universes;
-  STLKeys(m_tx_universes, &universes);
+/*
+ * Send the queued batch on all the interfaces.
+ * @returns the number of datagrams sent on the primary interface.
+ */
+unsigned int E131Node::FlushBatch() {
+  if (m_batch_datagrams.empty()) {
+    return 0;
+  }
 
-  uint8_t last_page = static_cast<uint8_t>(
-    universes.size() / DISCOVERY_PAGE_SIZE);
-  uint32_t sequence_number = 0;
-  for (uint8_t i = 0; i <= last_page; i++) {
-    SendDiscoveryPage(universes, i, last_page, sequence_number);
+  const unsigned int count = m_batch_datagrams.size();
+  unsigned int sent = count;
+  RedundantInterfaces::iterator iter = m_redundant_interfaces.begin();
+  if (m_options.transmit_pacer) {
+    m_options.transmit_pacer->Send(&m_socket, m_interface.ip_address,
+                                   &m_batch_datagrams[0], count);
+    for (; iter != m_redundant_interfaces.end(); ++iter) {
+      m_options.transmit_pacer->Send(&(*iter)->socket,
+                                     (*iter)->iface.ip_address,
+                                     &m_batch_datagrams[0], count);
+    }
+  } else {
+    sent = m_socket.SendMultiple(&m_batch_datagrams[0], count);
+    if (sent != count) {
+      OLA_WARN << "Only sent " << sent << " of " << count
+               << " E1.31 DMX packets";
+    }
+
+    for (; iter != m_redundant_interfaces.end(); ++iter) {
+      (*iter)->socket.SendMultiple(&m_batch_datagrams[0], count);
+    }
   }
 
-  // Delete any sources that we haven't heard from in 2 x
-  // UNIVERSE_DISCOVERY_INTERVAL.
-  TrackedSources::iterator iter = m_discovered_sources.begin();
-  while (iter != m_discovered_sources.end()) {
-    if (iter->second->clean_counter >= 2) {
-      delete iter->second;
-      OLA_INFO << "Removing " << iter->first.ToString() << " due to inactivity";
-      m_discovered_sources.erase(iter++);
-    } else {
-      iter->second->clean_counter++;
-      iter++;
+  for (unsigned int i = 0; i < sent; i++) {
+    m_batch_universes[i]->sequence++;
+  }
+  m_batch_datagrams.clear();
+  m_batch_universes.clear();
+  // Later frames for these universes can't be in the same call.
+  m_batch_id++;
+  return sent;
+}
+
+
+/*
+ * Receivers hold the data until the sync arrives. Rather than a sync per
+ * universe, we send one after all the universes in this pass are written.
+ */
+void E131Node::ScheduleSync() {
+  if (m_sync_universe && m_sync_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_sync_timeout = m_ss->RegisterSingleTimeout(
+        0, NewSingleCallback(this, &E131Node::SendScheduledSync));
+  }
+}
+
+
+void E131Node::SendScheduledSync() {
+  m_sync_timeout = ola::thread::INVALID_TIMEOUT;
+  SendSync();
+}
+
+
+/*
+ * Create the sockets used to receive universe data. The main socket still
+ * handles discovery, sync and unicast data.
+ */
+bool E131Node::SetupReceiveSockets() {
+  // Without this every socket would get the data for all the groups.
+  if (!m_socket.SetMulticastAll(false)) {
+    OLA_WARN << "Unable to limit sockets to their own multicast groups, "
+             << "using a single socket for E1.31";
+    return true;
+  }
+
+  for (unsigned int i = 0; i < m_options.receive_sockets; i++) {
+    ReceiveSocket *receive_socket = new ReceiveSocket(&m_root_inflator,
+                                                      &m_dmp_inflator);
+    m_receive_sockets.push_back(receive_socket);
+    UDPSocket *socket = &receive_socket->socket;
+    if (!socket->Init() || !socket->SetMulticastAll(false) ||
+        !socket->Bind(IPV4SocketAddress(IPV4Address::WildCard(),
+                                        m_options.port))) {
+      STLDeleteElements(&m_receive_sockets);
+      return false;
     }
   }
+  return true;
+}
+
 
+/*
+ * Create the sockets used to send on the redundant interfaces.
+ */
+bool E131Node::SetupRedundantInterfaces() {
+  if (m_options.redundant_interfaces.empty()) {
+    return true;
+  }
+
+  auto_ptr<ola::network::InterfacePicker> picker(
+    ola::network::InterfacePicker::NewPicker());
+  ola::network::InterfacePicker::Options picker_options;
+  picker_options.include_loopback = true;
+  picker_options.specific_only = true;
+
+  vector<string>::const_iterator iter =
+      m_options.redundant_interfaces.begin();
+  for (; iter != m_options.redundant_interfaces.end(); ++iter) {
+    auto_ptr<RedundantInterface> redundant(
+        new RedundantInterface(&m_root_sender));
+    if (!picker->ChooseInterface(&redundant->iface, *iter, picker_options)) {
+      OLA_WARN << "Failed to find redundant interface " << *iter;
+      STLDeleteElements(&m_redundant_interfaces);
+      return false;
+    }
+    if (redundant->iface.ip_address == m_interface.ip_address) {
+      OLA_WARN << *iter << " is the primary interface, ignoring";
+      continue;
+    }
+
+    UDPSocket *socket = &redundant->socket;
+    if (!socket->Init() || !socket->EnableBroadcast() ||
+        !socket->SetMulticastInterface(redundant->iface.ip_address)) {
+      STLDeleteElements(&m_redundant_interfaces);
+      return false;
+    }
+    socket->SetTos(m_options.dscp);
+    OLA_INFO << "E1.31 redundant interface " << redundant->iface.name
+             << " (" << redundant->iface.ip_address << ")";
+    m_redundant_interfaces.push_back(redundant.release());
+  }
   return true;
 }
 
-void E131Node::NewDiscoveryPage(
-    const HeaderSet &headers,
-    const E131DiscoveryInflator::DiscoveryPage &page) {
-  if (!m_options.enable_draft_discovery) {
+
+/*
+ * Receive on the primary & redundant interfaces using a packet ring. The
+ * sockets are still used to join the groups, but they discard what they
+ * receive.
+ */
+void E131Node::SetupPacketRing() {
+  vector<int32_t> interfaces;
+  interfaces.push_back(m_interface.index);
+  RedundantInterfaces::const_iterator iter = m_redundant_interfaces.begin();
+  for (; iter != m_redundant_interfaces.end(); ++iter) {
+    interfaces.push_back((*iter)->iface.index);
+  }
+
+  PacketRingReceiver::Options ring_options;
+  ring_options.port = m_options.port;
+  auto_ptr<PacketRingReceiver> ring(new PacketRingReceiver(
+      ring_options,
+      NewCallback(&m_incoming_udp_transport,
+                  &IncomingUDPTransport::HandleDatagram)));
+  if (!ring->Init(interfaces)) {
+    OLA_WARN << "Failed to set up the E1.31 packet ring, using sockets";
     return;
   }
 
-  TrackedSources::iterator iter = STLLookupOrInsertNull(
-      &m_discovered_sources,
-      headers.GetRootHeader().GetCid());
-  if (!iter->second) {
-    iter->second = new TrackedSource();
-    iter->second->ip_address = headers.GetTransportHeader().Source().Host();
-    iter->second->source_name = headers.GetE131Header().Source();
+  PacketRingReceiver::DiscardInput(m_socket.ReadDescriptor());
+  ReceiveSockets::iterator socket_iter = m_receive_sockets.begin();
+  for (; socket_iter != m_receive_sockets.end(); ++socket_iter) {
+    PacketRingReceiver::DiscardInput((*socket_iter)->socket.ReadDescriptor());
   }
+  m_packet_ring.reset(ring.release());
+  OLA_INFO << "Receiving E1.31 using a packet ring";
+}
 
-  TrackedSource *source = iter->second;
-  if (source->ip_address != headers.GetTransportHeader().Source().Host()) {
-    OLA_INFO << "CID " << headers.GetRootHeader().GetCid().ToString()
-             << " changed from " << source->ip_address << " to "
-             << headers.GetTransportHeader().Source().Host();
-    source->ip_address = headers.GetTransportHeader().Source().Host();
+
+/*
+ * Join a multicast group on the primary and all the redundant interfaces. If
+ * sources isn't empty, only data from those sources is received.
+ */
+bool E131Node::JoinGroup(UDPSocket *socket, const IPV4Address &group,
+                         const SourceSet &sources) {
+  bool ok = sources.empty() ?
+      socket->JoinMulticast(m_interface.ip_address, group) :
+      JoinSources(socket, m_interface.ip_address, group, sources);
+  if (!ok) {
+    OLA_WARN << "Failed to join multicast group " << group;
+    return false;
+  }
+
+  RedundantInterfaces::iterator iter = m_redundant_interfaces.begin();
+  for (; iter != m_redundant_interfaces.end(); ++iter) {
+    ok = sources.empty() ?
+        socket->JoinMulticast((*iter)->iface.ip_address, group) :
+        JoinSources(socket, (*iter)->iface.ip_address, group, sources);
+    if (!ok) {
+      OLA_WARN << "Failed to join multicast group " << group << " on "
+               << (*iter)->iface.name;
+    }
   }
-  source->source_name = headers.GetE131Header().Source();
-  source->NewPage(page.page_number, page.last_page, page.page_sequence,
-                  page.universes);
+  return true;
 }
 
-void E131Node::SendDiscoveryPage(const std::vector<uint16_t> &universes,
-                                 uint8_t this_page,
-                                 uint8_t last_page,
-                                 OLA_UNUSED uint32_t sequence_number) {
-  uint16_t in_this_page = static_cast<uint16_t>(this_page == last_page ?
-      universes.size() % DISCOVERY_PAGE_SIZE : DISCOVERY_PAGE_SIZE);
 
-  uint16_t *page_data = new uint16_t[in_this_page + 1];
-  page_data[0] = HostToNetwork(
-      static_cast<uint16_t>(this_page << 8 | last_page));
+/*
+ * Leave a multicast group on the primary and all the redundant interfaces.
+ * sources must match the ones passed to JoinGroup().
+ */
+bool E131Node::LeaveGroup(UDPSocket *socket, const IPV4Address &group,
+                          const SourceSet &sources) {
+  RedundantInterfaces::iterator iter = m_redundant_interfaces.begin();
+  for (; iter != m_redundant_interfaces.end(); ++iter) {
+    if (sources.empty()) {
+      socket->LeaveMulticast((*iter)->iface.ip_address, group);
+    } else {
+      LeaveSources(socket, (*iter)->iface.ip_address, group, sources);
+    }
+  }
+
+  if (!sources.empty()) {
+    LeaveSources(socket, m_interface.ip_address, group, sources);
+    return true;
+  }
 
-  for (unsigned int i = 0; i < in_this_page; i++) {
-    page_data[i + 1] = HostToNetwork(
-        universes[this_page * DISCOVERY_PAGE_SIZE + i]);
+  if (!socket->LeaveMulticast(m_interface.ip_address, group)) {
+    OLA_WARN << "Failed to leave multicast group " << group;
+    return false;
+  }
+  return true;
+}
+
+
+/*
+ * Join a multicast group for each of the sources on an interface. If any
+ * fail, the sources already joined are left.
+ */
+bool E131Node::JoinSources(UDPSocket *socket,
+                           const IPV4Address &iface,
+                           const IPV4Address &group,
+                           const SourceSet &sources) {
+  SourceSet::const_iterator iter = sources.begin();
+  for (; iter != sources.end(); ++iter) {
+    if (!socket->JoinMulticastSource(iface, group, *iter)) {
+      LeaveSources(socket, iface, group, SourceSet(sources.begin(), iter));
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void E131Node::LeaveSources(UDPSocket *socket,
+                            const IPV4Address &iface,
+                            const IPV4Address &group,
+                            const SourceSet &sources) {
+  SourceSet::const_iterator iter = sources.begin();
+  for (; iter != sources.end(); ++iter) {
+    socket->LeaveMulticastSource(iface, group, *iter);
+  }
+}
+
+
+/*
+ * Join the multicast group for an input universe, using the universe's source
+ * filter if it has one. If source specific multicast fails, the group is
+ * joined for all sources.
+ */
+bool E131Node::JoinUniverse(uint16_t universe) {
+  IPV4Address addr;
+  if (!m_e131_sender.UniverseIP(universe, &addr)) {
+    OLA_WARN << "Unable to determine multicast group for universe " <<
+      universe;
+    return false;
+  }
+
+  UDPSocket *socket = SocketForUniverse(universe);
+  const SourceSet *sources = STLFind(&m_source_filters, universe);
+  if (sources) {
+    if (JoinGroup(socket, addr, *sources)) {
+      m_joined_sources[universe] = *sources;
+      return true;
+    }
+    OLA_WARN << "Unable to filter the sources for universe " << universe
+             << ", receiving from all sources";
+  }
+
+  if (!JoinGroup(socket, addr)) {
+    return false;
+  }
+  m_joined_sources[universe] = SourceSet();
+  return true;
+}
+
+
+bool E131Node::LeaveUniverse(uint16_t universe) {
+  IPV4Address addr;
+  if (!m_e131_sender.UniverseIP(universe, &addr)) {
+    OLA_WARN << "Unable to determine multicast group for universe " <<
+      universe;
+    return false;
+  }
+
+  SourceSet sources;
+  STLLookupAndRemove(&m_joined_sources, universe, &sources);
+  return LeaveGroup(SocketForUniverse(universe), addr, sources);
+}
+
+
+/*
+ * Return the socket used to join the multicast group for a universe.
+ */
+UDPSocket *E131Node::SocketForUniverse(uint16_t universe) {
+  if (m_receive_sockets.empty()) {
+    return &m_socket;
+  }
+  return &m_receive_sockets[universe % m_receive_sockets.size()]->socket;
+}
+
+
+/*
+ * Copy the kernel's receive drop counts into the export map.
+ */
+bool E131Node::UpdateDropCounts() {
+  uint32_t drops;
+  if (m_socket.ReceiveDropCount(&drops)) {
+    UpdateDropCount(0, drops);
+  }
+  for (unsigned int i = 0; i < m_receive_sockets.size(); i++) {
+    if (m_receive_sockets[i]->socket.ReceiveDropCount(&drops)) {
+      UpdateDropCount(i + 1, drops);
+    }
+  }
+  if (m_packet_ring.get()) {
+    m_drop_map->Get("ring")->Add(m_packet_ring->Drops());
+  }
+  return true;
+}
+
+
+/*
+ * Add the drops since the last update to the count for a socket.
+ */
+void E131Node::UpdateDropCount(unsigned int index, uint32_t drops) {
+  if (index >= m_socket_drops.size()) {
+    m_socket_drops.resize(index + 1, 0);
+  }
+  // The kernel's counter wraps, which the unsigned subtraction handles.
+  m_drop_map->Get(IntToString(index))->Add(drops - m_socket_drops[index]);
+  m_socket_drops[index] = drops;
+}
+
+
+bool E131Node::PerformDiscoveryHousekeeping() {
+  // Send the Universe Discovery packets.
+  if (!m_discovery_pages_valid) {
+    BuildDiscoveryPages();
   }
 
   E131Header header(m_options.source_name, 0, 0, DISCOVERY_UNIVERSE_ID);
-  m_e131_sender.SendDiscoveryData(
-      header, reinterpret_cast<uint8_t*>(page_data), (in_this_page + 1) * 2);
-  delete[] page_data;
+  DiscoveryPages::const_iterator iter = m_discovery_pages.begin();
+  for (; iter != m_discovery_pages.end(); ++iter) {
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(&(*iter)[0]);
+    const unsigned int size = static_cast<unsigned int>(
+        iter->size() * sizeof(uint16_t));
+    m_e131_sender.SendDiscoveryData(header, data, size);
+
+    RedundantInterfaces::iterator redundant_iter =
+        m_redundant_interfaces.begin();
+    for (; redundant_iter != m_redundant_interfaces.end(); ++redundant_iter) {
+      (*redundant_iter)->sender.SendDiscoveryData(header, data, size);
+    }
+  }
+
+  m_discovery_directory.Expire();
+  return true;
+}
+
+void E131Node::NewDiscoveryPage(
+    const HeaderSet &headers,
+    const E131DiscoveryInflator::DiscoveryPage &page) {
+  if (!m_options.enable_draft_discovery) {
+    return;
+  }
+
+  m_discovery_directory.NewPage(
+      headers.GetRootHeader().GetCid(),
+      headers.GetTransportHeader().Source().Host(),
+      headers.GetE131Header().Source(),
+      page.page_number, page.last_page, page.page_sequence, page.universes);
+}
+
+/*
+ * Build the discovery pages from the universes we're sending. The pages are
+ * kept in network byte order, ready to send, until the universes change.
+ */
+void E131Node::BuildDiscoveryPages() {
+  vector<uint16_t> universes;
+  STLKeys(m_tx_universes, &universes);
+
+  const size_t page_count = universes.empty() ? 1 :
+      (universes.size() + DISCOVERY_PAGE_SIZE - 1) / DISCOVERY_PAGE_SIZE;
+  const uint8_t last_page = static_cast<uint8_t>(page_count - 1);
+
+  m_discovery_pages.clear();
+  m_discovery_pages.resize(page_count);
+  for (uint8_t i = 0; i <= last_page; i++) {
+    vector<uint16_t> &page = m_discovery_pages[i];
+    const size_t start = static_cast<size_t>(i) * DISCOVERY_PAGE_SIZE;
+    const size_t end = std::min(universes.size(),
+                                start + DISCOVERY_PAGE_SIZE);
+
+    page.reserve(end - start + 1);
+    page.push_back(HostToNetwork(static_cast<uint16_t>(i << 8 | last_page)));
+    for (size_t j = start; j < end; j++) {
+      page.push_back(HostToNetwork(universes[j]));
+    }
+  }
+  m_discovery_pages_valid = true;
 }
 }  // namespace acn
 }  // namespace ola
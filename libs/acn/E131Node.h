@@ -23,12 +23,14 @@
 #define LIBS_ACN_E131NODE_H_
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 #include "ola/Callback.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/acn/ACNPort.h"
 #include "ola/acn/CID.h"
 #include "ola/base/Macro.h"
@@ -36,10 +38,15 @@
 #include "ola/thread/SchedulerInterface.h"
 #include "ola/network/Interface.h"
 #include "ola/network/Socket.h"
+#include "ola/network/TransmitPacer.h"
 #include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/E131DiscoveryDirectory.h"
 #include "libs/acn/E131DiscoveryInflator.h"
+#include "libs/acn/E131ExtendedInflator.h"
 #include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131PacketTemplate.h"
 #include "libs/acn/E131Sender.h"
+#include "libs/acn/PacketRingReceiver.h"
 #include "libs/acn/RootInflator.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
@@ -49,6 +56,16 @@ namespace acn {
 
 class E131Node {
  public:
+  /**
+   * @brief The sources to receive a universe from.
+   */
+  typedef std::set<ola::network::IPV4Address> SourceSet;
+
+  /**
+   * @brief The sources to receive from, by universe.
+   */
+  typedef std::map<uint16_t, SourceSet> SourceFilters;
+
   /**
    * @brief Options for the E131Node.
    */
@@ -60,7 +77,13 @@ class E131Node {
          enable_draft_discovery(false),
          dscp(0),
          port(ola::acn::ACN_PORT),
-         source_name(ola::OLA_DEFAULT_INSTANCE_NAME) {
+         source_name(ola::OLA_DEFAULT_INSTANCE_NAME),
+         max_merge_sources(DMPE131Inflator::DEFAULT_MAX_MERGE_SOURCES),
+         sync_universe(0),
+         receive_sockets(1),
+         use_packet_ring(false),
+         export_map(NULL),
+         transmit_pacer(NULL) {
     }
 
     bool use_rev2;  /**< Use Revision 0.2 of the 2009 draft */
@@ -69,13 +92,67 @@ class E131Node {
     uint8_t dscp;  /**< The DSCP value to tag packets with */
     uint16_t port; /**< The UDP port to use, defaults to ACN_PORT */
     std::string source_name; /**< The source name to use */
+    /** The max number of sources to merge for each universe */
+    unsigned int max_merge_sources;
+    /**
+     * The universe to send E1.31-2016 sync packets on, or 0 to send
+     * unsynchronized data. This isn't used for revision 0.2.
+     */
+    uint16_t sync_universe;
+    /**
+     * The number of sockets to spread the universe multicast groups across.
+     * With 1 the same socket is used for everything.
+     */
+    unsigned int receive_sockets;
+    /**
+     * Receive using a memory mapped packet ring rather than the UDP sockets.
+     * This needs Linux and CAP_NET_RAW, if the ring can't be set up the
+     * sockets are used.
+     */
+    bool use_packet_ring;
+    /** If set, the receive drop counts for each socket are exported here */
+    ola::ExportMap *export_map;
+    /**
+     * Additional interfaces, by IP or name, to send and receive on. Each
+     * frame is packed once and sent on every interface. Copies of a frame
+     * that arrive on more than one interface are dropped before the merge.
+     */
+    std::vector<std::string> redundant_interfaces;
+    /**
+     * If set, all outgoing packets are queued with this pacer rather than
+     * being sent immediately.
+     */
+    ola::network::TransmitPacer *transmit_pacer;
+    /**
+     * The sources to receive each universe from. Universes with sources are
+     * joined with source specific multicast, so data from other sources is
+     * dropped by the kernel and IGMPv3 snooping switches. Universes without
+     * an entry receive data from any source.
+     */
+    SourceFilters source_filters;
   };
 
-  struct KnownController {
-    acn::CID cid;
-    ola::network::IPV4Address ip_address;
-    std::string source_name;
-    std::set<uint16_t> universes;
+  typedef E131DiscoveryDirectory::KnownController KnownController;
+
+  /**
+   * @brief A frame of DMX data for SendDMXBatch().
+   */
+  struct DMXFrame {
+   public:
+    DMXFrame(uint16_t universe,
+             const ola::DmxBuffer *buffer,
+             uint8_t priority = DEFAULT_PRIORITY,
+             bool preview = false)
+        : universe(universe),
+          buffer(buffer),
+          priority(priority),
+          preview(preview) {
+    }
+
+    uint16_t universe;  /**< The universe to send on */
+    const ola::DmxBuffer *buffer;  /**< The data, not owned */
+    uint8_t priority;  /**< The priority to use */
+    bool preview;  /**< True to set the preview bit */
   };
 
   /**
@@ -136,6 +213,36 @@ class E131Node {
                uint8_t priority = DEFAULT_PRIORITY,
                bool preview = false);
 
+  /**
+   * @brief Send DMX data for many universes.
+   * @param frames the frames to send.
+   * @return the number of frames sent.
+   *
+   * The frames are packed into the per-universe packet templates and passed
+   * to the kernel with as few system calls as the platform allows
+   * (sendmmsg() on Linux). If a universe appears more than once, the frames
+   * before the repeat are sent first, so the order is kept.
+   */
+  unsigned int SendDMXBatch(const std::vector<DMXFrame> &frames);
+
+  /**
+   * @brief Send the priority of each slot in a universe.
+   * @param universe the id of the universe to send
+   * @param priorities the priority of each slot, 0 means the slot isn't
+   *   sourced. This should be the same size as the DMX data.
+   * @param priority the universe priority to use
+   * @param preview set to true to turn on the preview bit
+   * @return true if it was sent successfully, false otherwise
+   *
+   * The priorities are sent with the 0xdd start code and share the sequence
+   * numbers of the DMX data. Revision 2 packets can't carry them, so this
+   * returns false if use_rev2 is set.
+   */
+  bool SendSlotPriorities(uint16_t universe,
+                          const ola::DmxBuffer &priorities,
+                          uint8_t priority = DEFAULT_PRIORITY,
+                          bool preview = false);
+
   /**
    * @brief Send some DMX data, allowing finer grained control of parameters.
    *
@@ -171,6 +278,16 @@ class E131Node {
                             const ola::DmxBuffer &buffer = DmxBuffer(),
                             uint8_t priority = DEFAULT_PRIORITY);
 
+  /**
+   * @brief Send a sync packet on the sync universe.
+   * @return true if it was sent successfully, false otherwise
+   *
+   * When a sync universe is set, SendDMX() schedules a sync to be sent once
+   * the current event has been handled, so all the universes written in the
+   * same pass are released together. This sends one straight away.
+   */
+  bool SendSync();
+
   /**
    * @brief Set the Callback to be run when we receive data for this universe.
    * @param universe the universe to register the handler for
@@ -178,9 +295,12 @@ class E131Node {
    * @param priority the priority to set.
    * @param handler the Callback to call when there is data for this universe.
    *   Ownership is transferred.
+   * @param slot_priorities the DmxBuffer to copy the slot priorities to, may
+   *   be NULL.
    */
   bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
-                  uint8_t *priority, ola::Callback0<void> *handler);
+                  uint8_t *priority, ola::Callback0<void> *handler,
+                  ola::DmxBuffer *slot_priorities = NULL);
 
   /**
    * @brief Remove the handler for a particular universe.
@@ -189,6 +309,25 @@ class E131Node {
    */
   bool RemoveHandler(uint16_t universe);
 
+  /**
+   * @brief Set the sources to receive a universe from.
+   * @param universe the universe to filter.
+   * @param sources the sources to receive from, if empty data from any
+   *   source is received.
+   * @return false if the multicast group couldn't be joined again with the
+   *   new sources.
+   *
+   * If the universe has a handler, the group is left and joined again with
+   * the new sources. If source specific multicast isn't supported, the group
+   * is joined for all sources.
+   */
+  bool SetSourceFilter(uint16_t universe, const SourceSet &sources);
+
+  /**
+   * @brief Return the sources each universe is received from.
+   */
+  const SourceFilters &GetSourceFilters() const { return m_source_filters; }
+
   /**
    * @brief Return the Interface this node is using.
    */
@@ -199,6 +338,22 @@ class E131Node {
    */
   ola::network::UDPSocket* GetSocket() { return &m_socket; }
 
+  /**
+   * @brief Return the additional sockets used to receive universe data.
+   *
+   * These are only created if receive_sockets is more than 1, they need to be
+   * added to the SelectServer as well as the socket from GetSocket().
+   */
+  void GetReceiveSockets(std::vector<ola::network::UDPSocket*> *sockets);
+
+  /**
+   * @brief Return the packet ring used to receive data.
+   *
+   * This is NULL unless use_packet_ring was set and the ring was set up. If
+   * it isn't NULL, it needs to be added to the SelectServer as well.
+   */
+  ola::io::ReadFileDescriptor *GetPacketRing() { return m_packet_ring.get(); }
+
   /**
    * @brief Return a list of known controllers.
    *
@@ -207,14 +362,29 @@ class E131Node {
    */
   void GetKnownControllers(std::vector<KnownController> *controllers);
 
+  /**
+   * @brief Return the directory of sources learnt from discovery.
+   *
+   * The directory's Generation() can be used to tell if anything changed
+   * since it was last queried.
+   */
+  const E131DiscoveryDirectory &DiscoveryDirectory() const {
+    return m_discovery_directory;
+  }
+
  private:
   struct tx_universe {
     std::string source;
     uint8_t sequence;
+    E131PacketTemplate packet;
+    // The SendDMXBatch() call this universe was last queued by.
+    unsigned int batch_id;
   };
 
   typedef std::map<uint16_t, tx_universe> ActiveTxUniverses;
-  typedef std::map<acn::CID, class TrackedSource*> TrackedSources;
+  typedef std::vector<std::vector<uint16_t> > DiscoveryPages;
+  typedef std::vector<class ReceiveSocket*> ReceiveSockets;
+  typedef std::vector<class RedundantInterface*> RedundantInterfaces;
 
   ola::thread::SchedulerInterface *m_ss;
   const Options m_options;
@@ -232,27 +402,84 @@ class E131Node {
   E131InflatorRev2 m_e131_rev2_inflator;
   DMPE131Inflator m_dmp_inflator;
   E131DiscoveryInflator m_discovery_inflator;
+  E131ExtendedInflator m_extended_inflator;
 
   IncomingUDPTransport m_incoming_udp_transport;
+  ReceiveSockets m_receive_sockets;
+  RedundantInterfaces m_redundant_interfaces;
+  std::auto_ptr<PacketRingReceiver> m_packet_ring;
+  // The last drop count read from each socket, the kernel's count is
+  // cumulative.
+  std::vector<uint32_t> m_socket_drops;
+  // This is a ShardedCounterMap since the node may run on a plugin thread.
+  ShardedCounterMap *m_drop_map;
+  ola::thread::timeout_id m_drop_count_timeout;
   ActiveTxUniverses m_tx_universes;
   uint8_t *m_send_buffer;
 
+  SourceFilters m_source_filters;
+  // The sources each input universe's group was joined with, empty if the
+  // group was joined for all sources.
+  SourceFilters m_joined_sources;
+
+  // Batch members, kept to avoid allocating on each SendDMXBatch() call.
+  unsigned int m_batch_id;
+  std::vector<ola::network::UDPDatagram> m_batch_datagrams;
+  std::vector<tx_universe*> m_batch_universes;
+
+  // Sync members
+  const uint16_t m_sync_universe;
+  uint8_t m_sync_sequence;
+  ola::thread::timeout_id m_sync_timeout;
+
   // Discovery members
   ola::thread::timeout_id m_discovery_timeout;
-  TrackedSources m_discovered_sources;
+  E131DiscoveryDirectory m_discovery_directory;
+  DiscoveryPages m_discovery_pages;
+  bool m_discovery_pages_valid;
 
   tx_universe *SetupOutgoingSettings(uint16_t universe);
+  bool SendFrame(uint16_t universe, const ola::DmxBuffer &buffer,
+                 uint8_t start_code, int8_t sequence_offset,
+                 uint8_t priority, bool preview);
+  bool SetupReceiveSockets();
+  bool SetupRedundantInterfaces();
+  void SetupPacketRing();
+  bool JoinGroup(ola::network::UDPSocket *socket,
+                 const ola::network::IPV4Address &group,
+                 const SourceSet &sources = SourceSet());
+  bool LeaveGroup(ola::network::UDPSocket *socket,
+                  const ola::network::IPV4Address &group,
+                  const SourceSet &sources = SourceSet());
+  bool JoinSources(ola::network::UDPSocket *socket,
+                   const ola::network::IPV4Address &iface,
+                   const ola::network::IPV4Address &group,
+                   const SourceSet &sources);
+  void LeaveSources(ola::network::UDPSocket *socket,
+                    const ola::network::IPV4Address &iface,
+                    const ola::network::IPV4Address &group,
+                    const SourceSet &sources);
+  bool JoinUniverse(uint16_t universe);
+  bool LeaveUniverse(uint16_t universe);
+  ola::network::UDPSocket *SocketForUniverse(uint16_t universe);
+  bool UpdateDropCounts();
+  void UpdateDropCount(unsigned int index, uint32_t drops);
+  void SendScheduledSync();
+  void ScheduleSync();
+  unsigned int FlushBatch();
 
   bool PerformDiscoveryHousekeeping();
   void NewDiscoveryPage(const HeaderSet &headers,
                         const E131DiscoveryInflator::DiscoveryPage &page);
-  void SendDiscoveryPage(const std::vector<uint16_t> &universes, uint8_t page,
-                         uint8_t last_page, uint32_t sequence_number);
+  void BuildDiscoveryPages();
 
   static const uint16_t DEFAULT_PRIORITY = 100;
   static const uint16_t UNIVERSE_DISCOVERY_INTERVAL = 10000;  // milliseconds
   static const uint16_t DISCOVERY_UNIVERSE_ID = 64214;
   static const uint16_t DISCOVERY_PAGE_SIZE = 512;
+  static const unsigned int DROP_COUNT_INTERVAL = 1000;  // milliseconds
+  static const char RECEIVE_DROPS_VAR[];
+  static const char RECEIVE_STATS_VAR[];
 
   DISALLOW_COPY_AND_ASSIGN(E131Node);
 };
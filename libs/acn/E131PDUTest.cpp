@@ -25,6 +25,7 @@
 #include "ola/network/NetworkUtils.h"
 #include "libs/acn/PDUTestCommon.h"
 #include "libs/acn/E131PDU.h"
+#include "libs/acn/E131SyncPDU.h"
 #include "ola/testing/TestUtils.h"
 
 namespace ola {
@@ -38,12 +39,14 @@ class E131PDUTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testSimpleRev2E131PDU);
   CPPUNIT_TEST(testSimpleE131PDU);
   CPPUNIT_TEST(testNestedE131PDU);
+  CPPUNIT_TEST(testSyncPDU);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testSimpleRev2E131PDU();
     void testSimpleE131PDU();
     void testNestedE131PDU();
+    void testSyncPDU();
  private:
     static const unsigned int TEST_VECTOR;
 };
@@ -157,5 +160,35 @@ void E131PDUTest::testSimpleE131PDU() {
 void E131PDUTest::testNestedE131PDU() {
   // TODO(simon): add this test
 }
+
+
+/*
+ * Test that packing a E131SyncPDU works.
+ */
+void E131PDUTest::testSyncPDU() {
+  E131SyncPDU pdu(7, 1234);
+  OLA_ASSERT_EQ(5u, pdu.HeaderSize());
+  OLA_ASSERT_EQ(0u, pdu.DataSize());
+  OLA_ASSERT_EQ(11u, pdu.Size());
+
+  uint8_t data[11];
+  unsigned int bytes_used = sizeof(data);
+  OLA_ASSERT(pdu.Pack(data, &bytes_used));
+  OLA_ASSERT_EQ(11u, bytes_used);
+
+  const uint8_t expected[] = {
+    0x70, 11,
+    0, 0, 0, 1,  // vector
+    7,  // sequence
+    0x04, 0xd2,  // sync address
+    0, 0  // reserved
+  };
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), data, bytes_used);
+
+  // test undersized buffer
+  bytes_used = sizeof(data) - 1;
+  OLA_ASSERT_FALSE(pdu.Pack(data, &bytes_used));
+  OLA_ASSERT_EQ(0u, bytes_used);
+}
 }  // namespace acn
 }  // namespace ola
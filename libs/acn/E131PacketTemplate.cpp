@@ -0,0 +1,145 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplate.cpp
+ * A pre-packed E1.31 data packet that is patched in place for each frame.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/acn/ACNPort.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/network/IPV4Address.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131PDU.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/E131Sender.h"
+#include "libs/acn/RootPDU.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using std::string;
+using std::vector;
+
+E131PacketTemplate::E131PacketTemplate()
+    : m_use_rev2(false),
+      m_slot_count(0),
+      m_size(0),
+      m_priority_offset(0),
+      m_sequence_offset(0),
+      m_options_offset(0),
+      m_slot_offset(0) {
+}
+
+bool E131PacketTemplate::Build(const ola::acn::CID &cid,
+                               const string &source,
+                               uint16_t universe,
+                               bool use_rev2,
+                               unsigned int slot_count,
+                               uint16_t sync_address) {
+  m_size = 0;
+
+  IPV4Address addr;
+  if (!E131Sender::UniverseIP(universe, &addr) ||
+      slot_count > DMX_UNIVERSE_SIZE) {
+    return false;
+  }
+
+  // The ratified standard carries the start code in the DMP data, rev2
+  // doesn't.
+  const unsigned int start_code_size = use_rev2 ? 0 : 1;
+  const unsigned int dmp_data_length = slot_count + start_code_size;
+  uint8_t dmp_data[DMX_UNIVERSE_SIZE + 1];
+  memset(dmp_data, 0, dmp_data_length);
+
+  TwoByteRangeDMPAddress range_addr(0, 1,
+                                    static_cast<uint16_t>(dmp_data_length));
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(DMPAddressData<TwoByteRangeDMPAddress>(
+      &range_addr, dmp_data, dmp_data_length));
+  const DMPPDU *dmp_pdu = NewRangeDMPSetProperty<uint16_t>(true, false,
+                                                           ranged_chunks);
+
+  E131Header header(source, 0, 0, universe, false, false, use_rev2,
+                    use_rev2 ? 0 : sync_address);
+  E131PDU e131_pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu);
+  PDUBlock<PDU> e131_block;
+  e131_block.AddPDU(&e131_pdu);
+
+  RootPDU root_pdu(use_rev2 ? ola::acn::VECTOR_ROOT_E131_REV2 :
+                              ola::acn::VECTOR_ROOT_E131,
+                   cid, &e131_block);
+  PDUBlock<PDU> root_block;
+  root_block.AddPDU(&root_pdu);
+
+  unsigned int size = PreamblePacker::MAX_DATAGRAM_SIZE -
+                      PreamblePacker::ACN_HEADER_SIZE;
+  memcpy(m_data, PreamblePacker::ACN_HEADER, PreamblePacker::ACN_HEADER_SIZE);
+  bool ok = root_block.Pack(m_data + PreamblePacker::ACN_HEADER_SIZE, &size);
+  const unsigned int header_offset = PreamblePacker::ACN_HEADER_SIZE +
+      (root_pdu.Size() - root_pdu.DataSize()) +
+      (e131_pdu.Size() - e131_pdu.HeaderSize() - e131_pdu.DataSize());
+  delete dmp_pdu;
+  if (!ok) {
+    return false;
+  }
+
+  if (use_rev2) {
+    m_priority_offset = header_offset + static_cast<unsigned int>(
+        offsetof(E131Rev2Header::e131_rev2_pdu_header, priority));
+    m_sequence_offset = header_offset + static_cast<unsigned int>(
+        offsetof(E131Rev2Header::e131_rev2_pdu_header, sequence));
+  } else {
+    m_priority_offset = header_offset + static_cast<unsigned int>(
+        offsetof(E131Header::e131_pdu_header, priority));
+    m_sequence_offset = header_offset + static_cast<unsigned int>(
+        offsetof(E131Header::e131_pdu_header, sequence));
+    m_options_offset = header_offset + static_cast<unsigned int>(
+        offsetof(E131Header::e131_pdu_header, options));
+  }
+
+  // The property data is always the last thing in the packet.
+  m_size = PreamblePacker::ACN_HEADER_SIZE + size;
+  m_slot_offset = m_size - slot_count;
+  m_slot_count = slot_count;
+  m_use_rev2 = use_rev2;
+  m_destination = IPV4SocketAddress(addr, ola::acn::ACN_PORT);
+  return true;
+}
+
+void E131PacketTemplate::Update(uint8_t priority, uint8_t sequence,
+                                bool preview, const DmxBuffer &buffer,
+                                uint8_t start_code) {
+  m_data[m_priority_offset] = priority;
+  m_data[m_sequence_offset] = sequence;
+  if (!m_use_rev2) {
+    m_data[m_options_offset] = preview ? E131Header::PREVIEW_DATA_MASK : 0;
+    m_data[m_slot_offset - 1] = start_code;
+  }
+  unsigned int length = m_slot_count;
+  buffer.Get(m_data + m_slot_offset, &length);
+}
+}  // namespace acn
+}  // namespace ola
@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplate.h
+ * A pre-packed E1.31 data packet that is patched in place for each frame.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef LIBS_ACN_E131PACKETTEMPLATE_H_
+#define LIBS_ACN_E131PACKETTEMPLATE_H_
+
+#include <stdint.h>
+#include <string>
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/CID.h"
+#include "ola/network/SocketAddress.h"
+#include "libs/acn/PreamblePacker.h"
+
+namespace ola {
+namespace acn {
+
+/**
+ * @brief A complete E1.31 data packet, including the root, framing and DMP
+ * layers, for a single universe.
+ *
+ * Everything other than the priority, sequence number, options and the slot
+ * data stays the same from one frame to the next, so the packet is packed
+ * once by Build() and then Update() patches only those fields. The template
+ * needs to be rebuilt if the source name or the number of slots changes.
+ */
+class E131PacketTemplate {
+ public:
+  E131PacketTemplate();
+
+  /**
+   * @brief Pack the template.
+   * @param cid the CID of the sender.
+   * @param source the source name.
+   * @param universe the universe the packet is for.
+   * @param use_rev2 true to use the draft (revision 2) packet format.
+   * @param slot_count the number of slots, not including the start code.
+   * @param sync_address the universe receivers should wait for a sync on, or
+   *   0 if the data isn't synchronized. This is ignored for revision 2
+   *   packets.
+   * @returns true if the template was built, false if the universe isn't
+   *   valid.
+   */
+  bool Build(const ola::acn::CID &cid,
+             const std::string &source,
+             uint16_t universe,
+             bool use_rev2,
+             unsigned int slot_count,
+             uint16_t sync_address = 0);
+
+  /**
+   * @brief Invalidate the template, the next frame will rebuild it.
+   */
+  void Reset() { m_size = 0; }
+
+  /**
+   * @brief Check if the template can be used for a frame.
+   * @param slot_count the number of slots in the frame.
+   */
+  bool IsValidFor(unsigned int slot_count) const {
+    return m_size && slot_count == m_slot_count;
+  }
+
+  /**
+   * @brief Patch the per-frame fields.
+   * @param priority the priority of the data.
+   * @param sequence the sequence number.
+   * @param preview true if this is preview data. This is ignored for
+   *   revision 2 packets, they don't have an options field.
+   * @param buffer the DMX data, this must have the same number of slots the
+   *   template was built with.
+   * @param start_code the start code. This is ignored for revision 2 packets,
+   *   which only carry null start code data.
+   */
+  void Update(uint8_t priority, uint8_t sequence, bool preview,
+              const DmxBuffer &buffer,
+              uint8_t start_code = ola::DMX512_START_CODE);
+
+  const uint8_t *Data() const { return m_data; }
+  unsigned int Size() const { return m_size; }
+  const ola::network::IPV4SocketAddress &Destination() const {
+    return m_destination;
+  }
+
+ private:
+  ola::network::IPV4SocketAddress m_destination;
+  bool m_use_rev2;
+  unsigned int m_slot_count;
+  unsigned int m_size;
+  unsigned int m_priority_offset;
+  unsigned int m_sequence_offset;
+  unsigned int m_options_offset;
+  unsigned int m_slot_offset;
+  uint8_t m_data[PreamblePacker::MAX_DATAGRAM_SIZE];
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131PACKETTEMPLATE_H_
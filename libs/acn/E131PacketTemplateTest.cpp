@@ -0,0 +1,212 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplateTest.cpp
+ * Test fixture for the E131PacketTemplate class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131PDU.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootSender.h"
+#include "libs/acn/Transport.h"
+#include "ola/testing/TestUtils.h"
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using std::string;
+using std::vector;
+
+/*
+ * A transport that packs the PDUs into a buffer.
+ */
+class PackingTransport: public OutgoingTransport {
+ public:
+    PackingTransport() : m_size(0) {}
+
+    bool Send(const PDUBlock<PDU> &pdu_block) {
+      const uint8_t *data = m_packer.Pack(pdu_block, &m_size);
+      if (!data)
+        return false;
+      memcpy(m_data, data, m_size);
+      return true;
+    }
+
+    const uint8_t *Data() const { return m_data; }
+    unsigned int Size() const { return m_size; }
+
+ private:
+    PreamblePacker m_packer;
+    uint8_t m_data[PreamblePacker::MAX_DATAGRAM_SIZE];
+    unsigned int m_size;
+};
+
+
+class E131PacketTemplateTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(E131PacketTemplateTest);
+  CPPUNIT_TEST(testPacket);
+  CPPUNIT_TEST(testRev2Packet);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testPacket();
+    void testRev2Packet();
+    void testInvalid();
+
+ private:
+    CID m_cid;
+
+    void PackWithSender(const E131Header &header, const DmxBuffer &buffer,
+                        PackingTransport *transport);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(E131PacketTemplateTest);
+
+
+void E131PacketTemplateTest::setUp() {
+  m_cid = CID::Generate();
+}
+
+
+/*
+ * Pack a frame the slow way, using the RootSender.
+ */
+void E131PacketTemplateTest::PackWithSender(const E131Header &header,
+                                            const DmxBuffer &buffer,
+                                            PackingTransport *transport) {
+  uint8_t dmp_data[DMX_UNIVERSE_SIZE + 1];
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  if (header.UsingRev2()) {
+    buffer.Get(dmp_data, &length);
+  } else {
+    dmp_data[0] = 0;
+    buffer.Get(dmp_data + 1, &length);
+    length++;
+  }
+
+  TwoByteRangeDMPAddress range_addr(0, 1, static_cast<uint16_t>(length));
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(DMPAddressData<TwoByteRangeDMPAddress>(
+      &range_addr, dmp_data, length));
+  const DMPPDU *dmp_pdu = NewRangeDMPSetProperty<uint16_t>(true, false,
+                                                           ranged_chunks);
+  E131PDU pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu);
+
+  RootSender sender(m_cid);
+  OLA_ASSERT_TRUE(sender.SendPDU(
+      header.UsingRev2() ? ola::acn::VECTOR_ROOT_E131_REV2 :
+                           ola::acn::VECTOR_ROOT_E131,
+      pdu, transport));
+  delete dmp_pdu;
+}
+
+
+/*
+ * Check the patched template matches a packet packed from scratch.
+ */
+void E131PacketTemplateTest::testPacket() {
+  const string source = "foo source";
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5,6,7,8");
+
+  E131PacketTemplate packet;
+  OLA_ASSERT_FALSE(packet.IsValidFor(buffer.Size()));
+  OLA_ASSERT_TRUE(packet.Build(m_cid, source, 6000, false, buffer.Size()));
+  OLA_ASSERT_TRUE(packet.IsValidFor(buffer.Size()));
+  OLA_ASSERT_FALSE(packet.IsValidFor(buffer.Size() + 1));
+  OLA_ASSERT_EQ(string("239.255.23.112:5568"),
+                packet.Destination().ToString());
+
+  PackingTransport transport;
+  packet.Update(100, 1, false, buffer);
+  PackWithSender(E131Header(source, 100, 1, 6000), buffer, &transport);
+  OLA_ASSERT_DATA_EQUALS(transport.Data(), transport.Size(),
+                         packet.Data(), packet.Size());
+
+  // Now change everything we can
+  buffer.SetFromString("200,199,198,197,196,195,194,193");
+  packet.Update(150, 2, true, buffer);
+  PackWithSender(E131Header(source, 150, 2, 6000, true), buffer, &transport);
+  OLA_ASSERT_DATA_EQUALS(transport.Data(), transport.Size(),
+                         packet.Data(), packet.Size());
+
+  // A full universe
+  buffer.SetRangeToValue(0, 42, DMX_UNIVERSE_SIZE);
+  OLA_ASSERT_TRUE(packet.Build(m_cid, source, 6000, false, buffer.Size()));
+  packet.Update(100, 3, false, buffer);
+  PackWithSender(E131Header(source, 100, 3, 6000), buffer, &transport);
+  OLA_ASSERT_DATA_EQUALS(transport.Data(), transport.Size(),
+                         packet.Data(), packet.Size());
+
+  packet.Reset();
+  OLA_ASSERT_FALSE(packet.IsValidFor(buffer.Size()));
+}
+
+
+/*
+ * Check that rev2 templates work.
+ */
+void E131PacketTemplateTest::testRev2Packet() {
+  const string source = "foo source";
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5,6,7,8");
+
+  E131PacketTemplate packet;
+  OLA_ASSERT_TRUE(packet.Build(m_cid, source, 1, true, buffer.Size()));
+
+  PackingTransport transport;
+  packet.Update(120, 10, false, buffer);
+  PackWithSender(E131Rev2Header(source, 120, 10, 1), buffer, &transport);
+  OLA_ASSERT_DATA_EQUALS(transport.Data(), transport.Size(),
+                         packet.Data(), packet.Size());
+
+  buffer.SetFromString("9,10,11,12,13,14,15,16");
+  packet.Update(80, 11, false, buffer);
+  PackWithSender(E131Rev2Header(source, 80, 11, 1), buffer, &transport);
+  OLA_ASSERT_DATA_EQUALS(transport.Data(), transport.Size(),
+                         packet.Data(), packet.Size());
+}
+
+
+/*
+ * Check invalid universes are rejected.
+ */
+void E131PacketTemplateTest::testInvalid() {
+  E131PacketTemplate packet;
+  OLA_ASSERT_FALSE(packet.Build(m_cid, "foo", 0, false, 10));
+  OLA_ASSERT_FALSE(packet.Build(m_cid, "foo", 0xffff, false, 10));
+  OLA_ASSERT_FALSE(packet.Build(m_cid, "foo", 1, false,
+                                DMX_UNIVERSE_SIZE + 1));
+  OLA_ASSERT_FALSE(packet.IsValidFor(10));
+}
+}  // namespace acn
+}  // namespace ola
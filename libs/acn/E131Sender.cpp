@@ -27,6 +27,7 @@
 #include "libs/acn/E131Inflator.h"
 #include "libs/acn/E131Sender.h"
 #include "libs/acn/E131PDU.h"
+#include "libs/acn/E131SyncPDU.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
 
@@ -100,6 +101,30 @@ bool E131Sender::SendDiscoveryData(const E131Header &header,
 }
 
 
+/*
+ * Send an E1.31-2016 synchronization packet.
+ * @param sync_address the universe to send the sync on.
+ * @param sequence the sequence number for the sync universe.
+ */
+bool E131Sender::SendSync(uint16_t sync_address, uint8_t sequence) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  IPV4Address addr;
+  if (!UniverseIP(sync_address, &addr)) {
+    OLA_INFO << "Could not convert universe " << sync_address << " to IP.";
+    return false;
+  }
+
+  OutgoingUDPTransport transport(&m_transport_impl, addr);
+
+  E131SyncPDU pdu(sequence, sync_address);
+  return m_root_sender->SendPDU(ola::acn::VECTOR_ROOT_E131_EXTENDED, pdu,
+                                &transport);
+}
+
+
 /*
  * Calculate the IP that corresponds to a universe.
  * @param universe the universe id
@@ -23,6 +23,7 @@
 #define LIBS_ACN_E131SENDER_H_
 
 #include "ola/network/Socket.h"
+#include "ola/network/TransmitPacer.h"
 #include "libs/acn/DMPPDU.h"
 #include "libs/acn/E131Header.h"
 #include "libs/acn/PreamblePacker.h"
@@ -43,6 +44,15 @@ class E131Sender {
   bool SendDMP(const E131Header &header, const DMPPDU *pdu);
   bool SendDiscoveryData(const E131Header &header, const uint8_t *data,
                          unsigned int data_size);
+  bool SendSync(uint16_t sync_address, uint8_t sequence);
+
+  /*
+   * Queue the packets with a TransmitPacer rather than sending them directly.
+   */
+  void SetTransmitPacer(ola::network::TransmitPacer *pacer,
+                        const ola::network::IPV4Address &iface) {
+    m_transport_impl.SetTransmitPacer(pacer, iface);
+  }
 
   static bool UniverseIP(uint16_t universe,
                          class ola::network::IPV4Address *addr);
@@ -40,8 +40,12 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/DMPInflator.h \
     libs/acn/DMPPDU.cpp \
     libs/acn/DMPPDU.h \
+    libs/acn/E131DiscoveryDirectory.cpp \
+    libs/acn/E131DiscoveryDirectory.h \
     libs/acn/E131DiscoveryInflator.cpp \
     libs/acn/E131DiscoveryInflator.h \
+    libs/acn/E131ExtendedInflator.cpp \
+    libs/acn/E131ExtendedInflator.h \
     libs/acn/E131Header.h \
     libs/acn/E131Inflator.cpp \
     libs/acn/E131Inflator.h \
@@ -49,8 +53,12 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/E131Node.h \
     libs/acn/E131PDU.cpp \
     libs/acn/E131PDU.h \
+    libs/acn/E131PacketTemplate.cpp \
+    libs/acn/E131PacketTemplate.h \
     libs/acn/E131Sender.cpp \
     libs/acn/E131Sender.h \
+    libs/acn/E131SyncPDU.cpp \
+    libs/acn/E131SyncPDU.h \
     libs/acn/E133Header.h \
     libs/acn/E133Inflator.cpp \
     libs/acn/E133Inflator.h \
@@ -64,6 +72,8 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/PDU.cpp \
     libs/acn/PDU.h \
     libs/acn/PDUTestCommon.h \
+    libs/acn/PacketRingReceiver.cpp \
+    libs/acn/PacketRingReceiver.h \
     libs/acn/PreamblePacker.cpp \
     libs/acn/PreamblePacker.h \
     libs/acn/RDMInflator.cpp \
@@ -114,10 +124,13 @@ libs_acn_E131Tester_SOURCES = \
     libs/acn/BaseInflatorTest.cpp \
     libs/acn/CIDTest.cpp \
     libs/acn/DMPAddressTest.cpp \
+    libs/acn/DMPE131InflatorTest.cpp \
     libs/acn/DMPInflatorTest.cpp \
     libs/acn/DMPPDUTest.cpp \
+    libs/acn/E131DiscoveryDirectoryTest.cpp \
     libs/acn/E131InflatorTest.cpp \
     libs/acn/E131PDUTest.cpp \
+    libs/acn/E131PacketTemplateTest.cpp \
     libs/acn/HeaderSetTest.cpp \
     libs/acn/PDUTest.cpp \
     libs/acn/RootInflatorTest.cpp \
@@ -141,6 +154,7 @@ libs_acn_E133Tester_LDADD = \
     $(COMMON_TESTING_LIBS)
 
 libs_acn_TransportTester_SOURCES = \
+    libs/acn/PacketRingReceiverTest.cpp \
     libs/acn/TCPTransportTest.cpp \
     libs/acn/UDPTransportTest.cpp
 libs_acn_TransportTester_CPPFLAGS = $(COMMON_TESTING_FLAGS)
@@ -0,0 +1,344 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PacketRingReceiver.cpp
+ * Receives E1.31 datagrams from a memory mapped packet ring.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_LINUX_IF_PACKET_H
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#endif  // HAVE_LINUX_IF_PACKET_H
+
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/NetworkUtils.h"
+#include "ola/stl/STLUtils.h"
+#include "libs/acn/PacketRingReceiver.h"
+
+// TPACKET_V3 was added in Linux 3.2.
+#if defined(HAVE_LINUX_IF_PACKET_H) && defined(TPACKET3_HDRLEN)
+#define USE_PACKET_RING 1
+#endif  // defined(HAVE_LINUX_IF_PACKET_H) && defined(TPACKET3_HDRLEN)
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::NetworkToHost;
+using std::vector;
+
+namespace {
+const unsigned int IPV4_HEADER_SIZE = 20;
+const unsigned int UDP_HEADER_SIZE = 8;
+const uint8_t IP_PROTOCOL_UDP = 17;
+// The more fragments flag and the fragment offset.
+const uint16_t IP_FRAGMENT_MASK = 0x3fff;
+// With TPACKET_V3 the frame size only needs to hold the largest packet.
+const unsigned int FRAME_SIZE = 2048;
+
+uint16_t ReadUInt16(const uint8_t *data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+}  // namespace
+
+const unsigned int PacketRingReceiver::DEFAULT_BLOCK_SIZE;
+const unsigned int PacketRingReceiver::DEFAULT_BLOCK_COUNT;
+const unsigned int PacketRingReceiver::DEFAULT_BLOCK_TIMEOUT;
+
+PacketRingReceiver::PacketRingReceiver(const Options &options,
+                                       DatagramCallback *callback)
+    : m_options(options),
+      m_callback(callback),
+      m_fd(ola::io::INVALID_DESCRIPTOR),
+      m_ring(NULL),
+      m_ring_size(0),
+      m_block_index(0) {
+}
+
+PacketRingReceiver::~PacketRingReceiver() {
+  Close();
+}
+
+#ifdef USE_PACKET_RING
+
+bool PacketRingReceiver::Init(const vector<int32_t> &interfaces) {
+  if (m_fd != ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!m_options.block_size || m_options.block_size % getpagesize() ||
+      m_options.block_size < FRAME_SIZE || !m_options.block_count) {
+    OLA_WARN << "Invalid packet ring size";
+    return false;
+  }
+
+  // The socket doesn't receive anything until it's bound, so no packets get
+  // past before the filter is attached.
+  m_fd = socket(AF_PACKET, SOCK_DGRAM, 0);
+  if (m_fd < 0) {
+    OLA_WARN << "Failed to open packet socket: " << strerror(errno);
+    m_fd = ola::io::INVALID_DESCRIPTOR;
+    return false;
+  }
+
+  int version = TPACKET_V3;
+  if (setsockopt(m_fd, SOL_PACKET, PACKET_VERSION, &version,
+                 sizeof(version))) {
+    OLA_WARN << "Failed to set TPACKET_V3: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  // For SOCK_DGRAM packet sockets the offsets are from the IP header.
+  struct sock_filter code[] = {
+    // X = IP header length
+    BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 9),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IP_PROTOCOL_UDP, 0, 5),
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 6),
+    BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, IP_FRAGMENT_MASK, 3, 0),
+    // The UDP destination port
+    BPF_STMT(BPF_LD | BPF_H | BPF_IND, 2),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, m_options.port, 0, 1),
+    BPF_STMT(BPF_RET | BPF_K, 0xffff),
+    BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  struct sock_fprog filter;
+  filter.len = sizeof(code) / sizeof(code[0]);
+  filter.filter = code;
+  if (setsockopt(m_fd, SOL_SOCKET, SO_ATTACH_FILTER, &filter,
+                 sizeof(filter))) {
+    OLA_WARN << "Failed to attach packet filter: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  struct tpacket_req3 request;
+  memset(&request, 0, sizeof(request));
+  request.tp_block_size = m_options.block_size;
+  request.tp_block_nr = m_options.block_count;
+  request.tp_frame_size = FRAME_SIZE;
+  request.tp_frame_nr = m_options.block_size / FRAME_SIZE *
+                        m_options.block_count;
+  request.tp_retire_blk_tov = m_options.block_timeout;
+  if (setsockopt(m_fd, SOL_PACKET, PACKET_RX_RING, &request,
+                 sizeof(request))) {
+    OLA_WARN << "Failed to set up the packet ring: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  m_ring_size = static_cast<size_t>(m_options.block_size) *
+                m_options.block_count;
+  void *ring = mmap(NULL, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    m_fd, 0);
+  if (ring == MAP_FAILED) {
+    OLA_WARN << "Failed to map the packet ring: " << strerror(errno);
+    m_ring_size = 0;
+    Close();
+    return false;
+  }
+  m_ring = reinterpret_cast<uint8_t*>(ring);
+  m_block_index = 0;
+
+  // Bind to the interface if there's only one, otherwise receive on all of
+  // them and check the index of each packet.
+  m_interfaces.clear();
+  struct sockaddr_ll address;
+  memset(&address, 0, sizeof(address));
+  address.sll_family = AF_PACKET;
+  address.sll_protocol = htons(ETH_P_IP);
+  if (interfaces.size() == 1) {
+    address.sll_ifindex = interfaces[0];
+  } else {
+    m_interfaces.insert(interfaces.begin(), interfaces.end());
+  }
+  if (bind(m_fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address))) {
+    OLA_WARN << "Failed to bind the packet socket: " << strerror(errno);
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void PacketRingReceiver::PerformRead() {
+  if (!m_ring) {
+    return;
+  }
+
+  while (true) {
+    uint8_t *block = m_ring + static_cast<size_t>(m_block_index) *
+                     m_options.block_size;
+    struct tpacket_block_desc *descriptor =
+        reinterpret_cast<struct tpacket_block_desc*>(block);
+    volatile uint32_t *status = &descriptor->hdr.bh1.block_status;
+    if (!(*status & TP_STATUS_USER)) {
+      return;
+    }
+    __sync_synchronize();
+
+    ProcessBlock(block);
+
+    // Hand the block back to the kernel.
+    __sync_synchronize();
+    *status = TP_STATUS_KERNEL;
+    m_block_index = (m_block_index + 1) % m_options.block_count;
+  }
+}
+
+unsigned int PacketRingReceiver::Drops() {
+  if (m_fd == ola::io::INVALID_DESCRIPTOR) {
+    return 0;
+  }
+  struct tpacket_stats_v3 stats;
+  socklen_t length = sizeof(stats);
+  if (getsockopt(m_fd, SOL_PACKET, PACKET_STATISTICS, &stats, &length)) {
+    return 0;
+  }
+  return stats.tp_drops;
+}
+
+bool PacketRingReceiver::DiscardInput(ola::io::DescriptorHandle fd) {
+  struct sock_filter code[] = {
+    BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  struct sock_fprog filter;
+  filter.len = 1;
+  filter.filter = code;
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter))) {
+    OLA_WARN << "Failed to attach discard filter: " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+void PacketRingReceiver::Close() {
+  if (m_ring) {
+    munmap(m_ring, m_ring_size);
+    m_ring = NULL;
+    m_ring_size = 0;
+  }
+  if (m_fd != ola::io::INVALID_DESCRIPTOR) {
+    close(m_fd);
+    m_fd = ola::io::INVALID_DESCRIPTOR;
+  }
+}
+
+void PacketRingReceiver::ProcessBlock(uint8_t *block) {
+  const struct tpacket_block_desc *descriptor =
+      reinterpret_cast<const struct tpacket_block_desc*>(block);
+  const uint32_t packet_count = descriptor->hdr.bh1.num_pkts;
+  const uint8_t *frame = block + descriptor->hdr.bh1.offset_to_first_pkt;
+
+  for (uint32_t i = 0; i < packet_count; i++) {
+    const struct tpacket3_hdr *header =
+        reinterpret_cast<const struct tpacket3_hdr*>(frame);
+    const struct sockaddr_ll *link = reinterpret_cast<const sockaddr_ll*>(
+        frame + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+    // Skip our own packets, and those from interfaces we don't want.
+    if (link->sll_pkttype != PACKET_OUTGOING &&
+        (m_interfaces.empty() ||
+         STLContains(m_interfaces, link->sll_ifindex))) {
+      const uint8_t *payload;
+      unsigned int payload_length;
+      IPV4SocketAddress source;
+      if (ParseDatagram(frame + header->tp_mac, header->tp_snaplen,
+                        m_options.port, &payload, &payload_length, &source)) {
+        m_callback->Run(payload, payload_length, source);
+      }
+    }
+    frame += header->tp_next_offset;
+  }
+}
+
+#else
+
+bool PacketRingReceiver::Init(const vector<int32_t>&) {
+  OLA_WARN << "Packet rings aren't supported on this platform";
+  return false;
+}
+
+void PacketRingReceiver::PerformRead() {}
+
+unsigned int PacketRingReceiver::Drops() {
+  return 0;
+}
+
+bool PacketRingReceiver::DiscardInput(ola::io::DescriptorHandle) {
+  return false;
+}
+
+void PacketRingReceiver::Close() {}
+
+void PacketRingReceiver::ProcessBlock(uint8_t*) {}
+
+#endif  // USE_PACKET_RING
+
+bool PacketRingReceiver::ParseDatagram(const uint8_t *packet,
+                                       unsigned int length,
+                                       uint16_t port,
+                                       const uint8_t **payload,
+                                       unsigned int *payload_length,
+                                       IPV4SocketAddress *source) {
+  if (length < IPV4_HEADER_SIZE || (packet[0] >> 4) != 4) {
+    return false;
+  }
+
+  const unsigned int header_length = (packet[0] & 0x0f) * 4u;
+  const unsigned int total_length = ReadUInt16(packet + 2);
+  if (header_length < IPV4_HEADER_SIZE ||
+      total_length < header_length + UDP_HEADER_SIZE ||
+      total_length > length ||
+      packet[9] != IP_PROTOCOL_UDP ||
+      ReadUInt16(packet + 6) & IP_FRAGMENT_MASK) {
+    return false;
+  }
+
+  const uint8_t *udp = packet + header_length;
+  const unsigned int udp_length = ReadUInt16(udp + 4);
+  if (ReadUInt16(udp + 2) != port ||
+      udp_length < UDP_HEADER_SIZE ||
+      udp_length > total_length - header_length) {
+    return false;
+  }
+
+  uint32_t source_ip;
+  memcpy(&source_ip, packet + 12, sizeof(source_ip));
+  *source = IPV4SocketAddress(IPV4Address(source_ip), ReadUInt16(udp));
+  *payload = udp + UDP_HEADER_SIZE;
+  *payload_length = udp_length - UDP_HEADER_SIZE;
+  return true;
+}
+}  // namespace acn
+}  // namespace ola
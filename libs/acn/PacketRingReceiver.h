@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PacketRingReceiver.h
+ * Receives E1.31 datagrams from a memory mapped packet ring.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef LIBS_ACN_PACKETRINGRECEIVER_H_
+#define LIBS_ACN_PACKETRINGRECEIVER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/acn/ACNPort.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/network/SocketAddress.h"
+
+namespace ola {
+namespace acn {
+
+/**
+ * @brief Receives E1.31 datagrams from a memory mapped packet ring.
+ *
+ * With many universes, the cost of receiving each datagram on a UDP socket
+ * limits the number of packets we can handle. This uses a Linux PACKET_MMAP
+ * (TPACKET_V3) ring instead. A BPF filter in the kernel drops everything
+ * other than unfragmented IPv4 UDP datagrams to the E1.31 port, and the
+ * kernel fills blocks of the ring with the matching packets. Each time the
+ * descriptor is readable, all the complete blocks are processed with no
+ * system calls.
+ *
+ * The multicast groups still need to be joined with a UDP socket, this only
+ * replaces the receive path.
+ *
+ * This requires CAP_NET_RAW. On other platforms Init() always fails.
+ */
+class PacketRingReceiver: public ola::io::ReadFileDescriptor {
+ public:
+  /**
+   * @brief Called with the UDP payload of each datagram and its source.
+   */
+  typedef ola::Callback3<void, const uint8_t*, ssize_t,
+                         const ola::network::IPV4SocketAddress&>
+      DatagramCallback;
+
+  struct Options {
+    Options()
+        : port(ACN_PORT),
+          block_size(DEFAULT_BLOCK_SIZE),
+          block_count(DEFAULT_BLOCK_COUNT),
+          block_timeout(DEFAULT_BLOCK_TIMEOUT) {
+    }
+
+    /** The UDP port to receive datagrams for. */
+    uint16_t port;
+    /** The size of each block in the ring, a multiple of the page size. */
+    unsigned int block_size;
+    /** The number of blocks in the ring. */
+    unsigned int block_count;
+    /**
+     * The number of milliseconds after which the kernel hands over a block
+     * that isn't full. This is the worst case latency added.
+     */
+    unsigned int block_timeout;
+  };
+
+  /**
+   * @brief Create a new PacketRingReceiver.
+   * @param options the Options to use.
+   * @param callback the callback to run for each datagram, ownership is
+   *   transferred.
+   */
+  PacketRingReceiver(const Options &options, DatagramCallback *callback);
+  ~PacketRingReceiver();
+
+  /**
+   * @brief Open the ring.
+   * @param interfaces the indices of the interfaces to receive on.
+   * @returns true if the ring was set up, false otherwise.
+   */
+  bool Init(const std::vector<int32_t> &interfaces);
+
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_fd; }
+
+  /**
+   * @brief Process all the blocks the kernel has handed over.
+   */
+  void PerformRead();
+
+  /**
+   * @brief The number of packets dropped by the kernel because the ring was
+   *   full.
+   *
+   * This reads, and so resets, the kernel's counters.
+   */
+  unsigned int Drops();
+
+  /**
+   * @brief Extract the UDP payload from an IPv4 packet.
+   * @param packet the IPv4 packet.
+   * @param length the length of the packet.
+   * @param port the expected destination port.
+   * @param[out] payload set to the start of the UDP payload.
+   * @param[out] payload_length set to the length of the UDP payload.
+   * @param[out] source set to the source of the datagram.
+   * @returns true if this was an unfragmented UDP datagram for the port,
+   *   false otherwise.
+   */
+  static bool ParseDatagram(const uint8_t *packet,
+                            unsigned int length,
+                            uint16_t port,
+                            const uint8_t **payload,
+                            unsigned int *payload_length,
+                            ola::network::IPV4SocketAddress *source);
+
+  /**
+   * @brief Make a socket discard everything it receives.
+   *
+   * This is used for the sockets that are only needed to join multicast
+   * groups, so the datagrams aren't queued there as well.
+   * @param fd the socket.
+   * @returns true if the filter was attached.
+   */
+  static bool DiscardInput(ola::io::DescriptorHandle fd);
+
+  static const unsigned int DEFAULT_BLOCK_SIZE = 1 << 18;
+  static const unsigned int DEFAULT_BLOCK_COUNT = 64;
+  static const unsigned int DEFAULT_BLOCK_TIMEOUT = 1;
+
+ private:
+  const Options m_options;
+  std::auto_ptr<DatagramCallback> m_callback;
+  ola::io::DescriptorHandle m_fd;
+  uint8_t *m_ring;
+  size_t m_ring_size;
+  unsigned int m_block_index;
+  // Only used when receiving on more than one interface.
+  std::set<int32_t> m_interfaces;
+
+  void Close();
+  void ProcessBlock(uint8_t *block);
+
+  DISALLOW_COPY_AND_ASSIGN(PacketRingReceiver);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_PACKETRINGRECEIVER_H_
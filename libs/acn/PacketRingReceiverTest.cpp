@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PacketRingReceiverTest.cpp
+ * Test fixture for the PacketRingReceiver class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/testing/TestUtils.h"
+#include "libs/acn/PacketRingReceiver.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+
+class PacketRingReceiverTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PacketRingReceiverTest);
+  CPPUNIT_TEST(testParseDatagram);
+  CPPUNIT_TEST(testParseInvalidDatagram);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testParseDatagram();
+    void testParseInvalidDatagram();
+
+ private:
+    // An IPv4 header with options, a UDP header and 4 bytes of payload.
+    uint8_t m_packet[24 + 8 + 4];
+
+    bool Parse(unsigned int length, uint16_t port = ACN_PORT) {
+      const uint8_t *payload;
+      unsigned int payload_length;
+      IPV4SocketAddress source;
+      return PacketRingReceiver::ParseDatagram(m_packet, length, port,
+                                               &payload, &payload_length,
+                                               &source);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PacketRingReceiverTest);
+
+
+void PacketRingReceiverTest::setUp() {
+  const uint8_t packet[] = {
+    0x46, 0, 0, sizeof(m_packet),  // version, IHL & total length
+    0x12, 0x34, 0x40, 0,  // id, DF
+    64, 17, 0, 0,  // TTL, UDP, checksum
+    10, 0, 0, 1,  // source
+    239, 255, 0, 1,  // destination
+    1, 1, 0, 0,  // options
+    0x12, 0x34, 0x15, 0xc0,  // source port, destination port 5568
+    0, 12, 0, 0,  // UDP length & checksum
+    1, 2, 3, 4,  // payload
+  };
+  memcpy(m_packet, packet, sizeof(m_packet));
+}
+
+
+/*
+ * Check a valid datagram is parsed.
+ */
+void PacketRingReceiverTest::testParseDatagram() {
+  const uint8_t *payload;
+  unsigned int payload_length;
+  IPV4SocketAddress source;
+  OLA_ASSERT_TRUE(PacketRingReceiver::ParseDatagram(
+      m_packet, sizeof(m_packet), ACN_PORT, &payload, &payload_length,
+      &source));
+  OLA_ASSERT_EQ(m_packet + 32, payload);
+  OLA_ASSERT_EQ(4u, payload_length);
+  OLA_ASSERT_EQ(IPV4SocketAddress(IPV4Address::FromStringOrDie("10.0.0.1"),
+                                  0x1234),
+                source);
+
+  // Trailing data, e.g. Ethernet padding, is ignored.
+  OLA_ASSERT_TRUE(PacketRingReceiver::ParseDatagram(
+      m_packet, sizeof(m_packet) + 4, ACN_PORT, &payload, &payload_length,
+      &source));
+  OLA_ASSERT_EQ(4u, payload_length);
+}
+
+
+/*
+ * Check invalid datagrams are rejected.
+ */
+void PacketRingReceiverTest::testParseInvalidDatagram() {
+  // Truncated
+  OLA_ASSERT_FALSE(Parse(0));
+  OLA_ASSERT_FALSE(Parse(19));
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet) - 1));
+
+  // Wrong port
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet), 6454));
+
+  // IPv6
+  m_packet[0] = 0x66;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+  setUp();
+
+  // Bad header length
+  m_packet[0] = 0x44;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+  setUp();
+
+  // TCP
+  m_packet[9] = 6;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+  setUp();
+
+  // Fragments
+  m_packet[6] = 0x20;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+  setUp();
+  m_packet[7] = 0x10;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+  setUp();
+
+  // UDP length too long or too short
+  m_packet[29] = 13;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+  m_packet[29] = 7;
+  OLA_ASSERT_FALSE(Parse(sizeof(m_packet)));
+}
+}  // namespace acn
+}  // namespace ola
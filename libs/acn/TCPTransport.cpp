@@ -41,25 +41,57 @@ const uint8_t ACN_HEADER[] = {
 
 const unsigned int ACN_HEADER_SIZE = sizeof(ACN_HEADER);
 
+const unsigned int StreamBufferPool::BUFFER_SIZE;
+const unsigned int StreamBufferPool::DEFAULT_MAX_FREE;
 // TODO(simon): tune this once we have an idea of what the sizes will be
-const unsigned int IncomingStreamTransport::INITIAL_SIZE = 500;
+const unsigned int IncomingStreamTransport::INITIAL_SIZE =
+    StreamBufferPool::BUFFER_SIZE;
+
+
+StreamBufferPool::~StreamBufferPool() {
+  std::vector<uint8_t*>::iterator iter = m_free_buffers.begin();
+  for (; iter != m_free_buffers.end(); ++iter) {
+    delete[] *iter;
+  }
+}
+
+
+uint8_t *StreamBufferPool::Allocate() {
+  m_buffers_in_use++;
+  if (m_free_buffers.empty()) {
+    return new uint8_t[BUFFER_SIZE];
+  }
+  uint8_t *buffer = m_free_buffers.back();
+  m_free_buffers.pop_back();
+  return buffer;
+}
+
+
+void StreamBufferPool::Release(uint8_t *buffer) {
+  m_buffers_in_use--;
+  if (m_free_buffers.size() < m_max_free) {
+    m_free_buffers.push_back(buffer);
+  } else {
+    delete[] buffer;
+  }
+}
 
 
 /**
  * Create a new IncomingStreamTransport.
- * @param inflator the inflator to call for each PDU
- * @param descriptor the descriptor to read from
- * @param source the IP and port to use in the transport header
  */
 IncomingStreamTransport::IncomingStreamTransport(
     BaseInflator *inflator,
     ola::io::ConnectedDescriptor *descriptor,
-    const ola::network::IPV4SocketAddress &source)
+    const ola::network::IPV4SocketAddress &source,
+    StreamBufferPool *buffer_pool)
     : m_transport_header(source, TransportHeader::TCP),
       m_inflator(inflator),
       m_descriptor(descriptor),
+      m_buffer_pool(buffer_pool),
       m_buffer_start(NULL),
       m_buffer_end(NULL),
+      m_data_start(NULL),
       m_data_end(NULL),
       m_block_size(0),
       m_consumed_block_size(0),
@@ -74,8 +106,7 @@ IncomingStreamTransport::IncomingStreamTransport(
  * Clean up
  */
 IncomingStreamTransport::~IncomingStreamTransport() {
-  if (m_buffer_start)
-    delete[] m_buffer_start;
+  FreeBuffer();
 }
 
 
@@ -85,16 +116,13 @@ IncomingStreamTransport::~IncomingStreamTransport() {
  * caller should close the descriptor since the data is no longer valid.
  */
 bool IncomingStreamTransport::Receive() {
-  while (true) {
-    OLA_DEBUG << "start read, outstanding bytes is " << m_outstanding_data;
-    // Read as much as we need
-    ReadRequiredData();
-
-    OLA_DEBUG << "done read, bytes outstanding is " << m_outstanding_data;
-
-    // if we still don't have enough, return
-    if (m_stream_valid == false || m_outstanding_data)
-      return m_stream_valid;
+  while (m_stream_valid) {
+    if (DataLength() < m_required_data) {
+      if (!ReadData()) {
+        break;
+      }
+      continue;
+    }
 
     OLA_DEBUG << "state is " << m_state;
 
@@ -112,9 +140,13 @@ bool IncomingStreamTransport::Receive() {
         HandlePDU();
         break;
     }
-    if (!m_stream_valid)
-      return false;
   }
+
+  if (m_stream_valid && m_buffer_pool && DataLength() == 0) {
+    // We're between PDUs, let another connection use the buffer.
+    FreeBuffer();
+  }
+  return m_stream_valid;
 }
 
 
@@ -125,8 +157,8 @@ bool IncomingStreamTransport::Receive() {
 void IncomingStreamTransport::HandlePreamble() {
   OLA_DEBUG << "in handle preamble, data len is " << DataLength();
 
-  if (memcmp(m_buffer_start, ACN_HEADER, ACN_HEADER_SIZE) != 0) {
-    ola::FormatData(&std::cout, m_buffer_start, ACN_HEADER_SIZE);
+  if (memcmp(m_data_start, ACN_HEADER, ACN_HEADER_SIZE) != 0) {
+    ola::FormatData(&std::cout, m_data_start, ACN_HEADER_SIZE);
     ola::FormatData(&std::cout, ACN_HEADER, ACN_HEADER_SIZE);
     OLA_WARN << "bad ACN header";
     m_stream_valid = false;
@@ -135,10 +167,11 @@ void IncomingStreamTransport::HandlePreamble() {
 
   // read the PDU block length
   memcpy(reinterpret_cast<void*>(&m_block_size),
-         m_buffer_start + ACN_HEADER_SIZE,
+         m_data_start + ACN_HEADER_SIZE,
          sizeof(m_block_size));
   m_block_size = ola::network::NetworkToHost(m_block_size);
   OLA_DEBUG << "pdu block size is " << m_block_size;
+  m_data_start += ACN_HEADER_SIZE + PDU_BLOCK_SIZE;
 
   if (m_block_size) {
     m_consumed_block_size = 0;
@@ -156,9 +189,9 @@ void IncomingStreamTransport::HandlePreamble() {
  */
 void IncomingStreamTransport::HandlePDUFlags() {
   OLA_DEBUG << "Reading PDU flags, data size is " << DataLength();
-  m_pdu_length_size = (*m_buffer_start  & BaseInflator::LFLAG_MASK) ?
+  m_pdu_length_size = (*m_data_start & BaseInflator::LFLAG_MASK) ?
     THREE_BYTES : TWO_BYTES;
-  m_outstanding_data += static_cast<unsigned int>(m_pdu_length_size) - 1;
+  m_required_data = static_cast<unsigned int>(m_pdu_length_size);
   OLA_DEBUG << "PDU length size is " << static_cast<int>(m_pdu_length_size) <<
     " bytes";
   m_state = WAITING_FOR_PDU_LENGTH;
@@ -172,13 +205,13 @@ void IncomingStreamTransport::HandlePDUFlags() {
 void IncomingStreamTransport::HandlePDULength() {
   if (m_pdu_length_size == THREE_BYTES) {
     m_pdu_size = (
-      m_buffer_start[2] +
-      static_cast<unsigned int>(m_buffer_start[1] << 8) +
-      static_cast<unsigned int>((m_buffer_start[0] & BaseInflator::LENGTH_MASK)
+      m_data_start[2] +
+      static_cast<unsigned int>(m_data_start[1] << 8) +
+      static_cast<unsigned int>((m_data_start[0] & BaseInflator::LENGTH_MASK)
         << 16));
   } else {
-    m_pdu_size = m_buffer_start[1] + static_cast<unsigned int>(
-        (m_buffer_start[0] & BaseInflator::LENGTH_MASK) << 8);
+    m_pdu_size = m_data_start[1] + static_cast<unsigned int>(
+        (m_data_start[0] & BaseInflator::LENGTH_MASK) << 8);
   }
   OLA_DEBUG << "PDU size is " << m_pdu_size;
 
@@ -190,9 +223,8 @@ void IncomingStreamTransport::HandlePDULength() {
     return;
   }
 
-  m_outstanding_data += (
-    m_pdu_size - static_cast<unsigned int>(m_pdu_length_size));
-  OLA_DEBUG << "Processed length, now waiting on another " << m_outstanding_data
+  m_required_data = m_pdu_size;
+  OLA_DEBUG << "Processed length, now waiting on " << m_required_data
     << " bytes";
   m_state = WAITING_FOR_PDU;
 }
@@ -206,18 +238,13 @@ void IncomingStreamTransport::HandlePDU() {
   OLA_DEBUG << "Got PDU, data length is " << DataLength() << ", expected " <<
     m_pdu_size;
 
-  if (DataLength() != m_pdu_size) {
-    OLA_WARN << "PDU size doesn't match the available data";
-    m_stream_valid = false;
-    return;
-  }
-
   HeaderSet header_set;
   header_set.SetTransportHeader(m_transport_header);
 
+  // The PDU is inflated in place, the buffer may hold more after it.
   unsigned int data_consumed = m_inflator->InflatePDUBlock(
       &header_set,
-      m_buffer_start,
+      m_data_start,
       m_pdu_size);
   OLA_DEBUG << "inflator consumed " << data_consumed << " bytes";
 
@@ -228,6 +255,7 @@ void IncomingStreamTransport::HandlePDU() {
     return;
   }
 
+  m_data_start += data_consumed;
   m_consumed_block_size += data_consumed;
 
   if (m_consumed_block_size == m_block_size) {
@@ -249,45 +277,95 @@ void IncomingStreamTransport::IncreaseBufferSize(unsigned int new_size) {
   new_size = std::max(new_size, INITIAL_SIZE);
 
   unsigned int data_length = DataLength();
-  if (!m_buffer_start)
-    data_length = 0;
 
   // allocate new buffer and copy the data over
-  uint8_t *buffer = new uint8_t[new_size];
-  if (m_buffer_start) {
-    if (data_length > 0)
-      // this moves the data to the start of the buffer if it wasn't already
-      memcpy(buffer, m_buffer_start, data_length);
-    delete[] m_buffer_start;
+  uint8_t *buffer = NULL;
+  if (m_buffer_pool && new_size == StreamBufferPool::BUFFER_SIZE) {
+    buffer = m_buffer_pool->Allocate();
+  } else {
+    buffer = new uint8_t[new_size];
   }
+  if (data_length > 0) {
+    // this moves the data to the start of the buffer if it wasn't already
+    memcpy(buffer, m_data_start, data_length);
+  }
+  FreeBuffer();
 
   m_buffer_start = buffer;
   m_buffer_end = buffer + new_size;
+  m_data_start = buffer;
   m_data_end = buffer + data_length;
 }
 
 
 /**
- * Read data until we reach the number of bytes we required or there is no more
- * data to be read
+ * Free the rx buffer, returning it to the pool if it came from there.
  */
-void IncomingStreamTransport::ReadRequiredData() {
-  if (m_outstanding_data == 0)
+void IncomingStreamTransport::FreeBuffer() {
+  if (!m_buffer_start) {
     return;
+  }
+
+  if (IsPoolBuffer()) {
+    m_buffer_pool->Release(m_buffer_start);
+  } else {
+    delete[] m_buffer_start;
+  }
+  m_buffer_start = NULL;
+  m_buffer_end = NULL;
+  m_data_start = NULL;
+  m_data_end = NULL;
+}
 
-  if (m_outstanding_data > FreeSpace())
-    IncreaseBufferSize(DataLength() + m_outstanding_data);
+
+/**
+ * Buffers larger than the pool's size are allocated on their own.
+ */
+bool IncomingStreamTransport::IsPoolBuffer() const {
+  return m_buffer_pool && BufferSize() == StreamBufferPool::BUFFER_SIZE;
+}
+
+
+/**
+ * Read as much data as will fit in the buffer, making sure there is room for
+ * at least the data required for the current stage.
+ * @returns true if data was read, false if there was nothing to read.
+ */
+bool IncomingStreamTransport::ReadData() {
+  unsigned int required = m_required_data - DataLength();
+
+  // Only the remains of a partial PDU are moved, and we wait until the end of
+  // the buffer is getting short.
+  if (DataLength() == 0 || FreeSpace() < required ||
+      FreeSpace() < BufferSize() / 4)
+    CompactBuffer();
+
+  if (required > FreeSpace())
+    IncreaseBufferSize(DataLength() + required);
 
   unsigned int data_read;
-  int ok = m_descriptor->Receive(m_data_end,
-                                 m_outstanding_data,
-                                 data_read);
+  int ok = m_descriptor->Receive(m_data_end, FreeSpace(), data_read);
 
   if (ok != 0)
     OLA_WARN << "tcp rx failed";
   OLA_DEBUG << "read " << data_read;
   m_data_end += data_read;
-  m_outstanding_data -= data_read;
+  return data_read > 0;
+}
+
+
+/**
+ * Move the unprocessed data to the start of the buffer.
+ */
+void IncomingStreamTransport::CompactBuffer() {
+  if (!m_buffer_start || m_data_start == m_buffer_start)
+    return;
+
+  unsigned int data_length = DataLength();
+  if (data_length)
+    memmove(m_buffer_start, m_data_start, data_length);
+  m_data_start = m_buffer_start;
+  m_data_end = m_buffer_start + data_length;
 }
 
 
@@ -295,9 +373,8 @@ void IncomingStreamTransport::ReadRequiredData() {
  * Enter the wait-for-preamble state
  */
 void IncomingStreamTransport::EnterWaitingForPreamble() {
-  m_data_end = m_buffer_start;
   m_state = WAITING_FOR_PREAMBLE;
-  m_outstanding_data = ACN_HEADER_SIZE + PDU_BLOCK_SIZE;
+  m_required_data = ACN_HEADER_SIZE + PDU_BLOCK_SIZE;
 }
 
 
@@ -306,9 +383,8 @@ void IncomingStreamTransport::EnterWaitingForPreamble() {
  */
 void IncomingStreamTransport::EnterWaitingForPDU() {
   m_state = WAITING_FOR_PDU_FLAGS;
-  m_data_end = m_buffer_start;
   // we need 1 byte to read the flags
-  m_outstanding_data = 1;
+  m_required_data = 1;
 }
 
 
@@ -316,13 +392,14 @@ void IncomingStreamTransport::EnterWaitingForPDU() {
  * Create a new IncomingTCPTransport
  */
 IncomingTCPTransport::IncomingTCPTransport(BaseInflator *inflator,
-                                           ola::network::TCPSocket *socket)
+                                           ola::network::TCPSocket *socket,
+                                           StreamBufferPool *buffer_pool)
     : m_transport(NULL) {
   ola::network::GenericSocketAddress address = socket->GetPeerAddress();
   if (address.Family() == AF_INET) {
     ola::network::IPV4SocketAddress v4_addr = address.V4Addr();
     m_transport.reset(
-        new IncomingStreamTransport(inflator, socket, v4_addr));
+        new IncomingStreamTransport(inflator, socket, v4_addr, buffer_pool));
   } else {
     OLA_WARN << "Invalid address for fd " << socket->ReadDescriptor();
   }
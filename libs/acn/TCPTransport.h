@@ -31,7 +31,10 @@
 #ifndef LIBS_ACN_TCPTRANSPORT_H_
 #define LIBS_ACN_TCPTRANSPORT_H_
 
+#include <stdint.h>
 #include <memory>
+#include <vector>
+#include "ola/base/Macro.h"
 #include "ola/io/OutputBuffer.h"
 #include "ola/io/OutputStream.h"
 #include "ola/io/Descriptor.h"
@@ -44,15 +47,67 @@ namespace ola {
 namespace acn {
 
 
+/**
+ * A pool of receive buffers, shared by many IncomingStreamTransports.
+ *
+ * A transport using the pool only holds a buffer while it's part way through
+ * a PDU block, so thousands of mostly idle connections need only a few
+ * buffers between them.
+ */
+class StreamBufferPool {
+ public:
+    /**
+     * @param max_free the maximum number of unused buffers to keep.
+     */
+    explicit StreamBufferPool(unsigned int max_free = DEFAULT_MAX_FREE)
+        : m_max_free(max_free),
+          m_buffers_in_use(0) {
+    }
+    ~StreamBufferPool();
+
+    /**
+     * @brief Get a buffer of BUFFER_SIZE bytes.
+     */
+    uint8_t *Allocate();
+
+    /**
+     * @brief Return a buffer from Allocate() to the pool.
+     */
+    void Release(uint8_t *buffer);
+
+    unsigned int FreeBuffers() const { return m_free_buffers.size(); }
+    unsigned int BuffersInUse() const { return m_buffers_in_use; }
+
+    static const unsigned int BUFFER_SIZE = 500;
+
+ private:
+    const unsigned int m_max_free;
+    unsigned int m_buffers_in_use;
+    std::vector<uint8_t*> m_free_buffers;
+
+    static const unsigned int DEFAULT_MAX_FREE = 64;
+
+    DISALLOW_COPY_AND_ASSIGN(StreamBufferPool);
+};
+
+
 /**
  * Read ACN messages from a stream. Generally you want to use the
  * IncomingTCPTransport directly. This class is used for testing.
  */
 class IncomingStreamTransport {
  public:
+    /**
+     * @param inflator the inflator to call for each PDU
+     * @param descriptor the descriptor to read from
+     * @param source the IP and port to use in the transport header
+     * @param buffer_pool if not NULL, the receive buffer is taken from this
+     *   pool and returned to it when the transport is idle.
+     */
     IncomingStreamTransport(class BaseInflator *inflator,
                             ola::io::ConnectedDescriptor *descriptor,
-                            const ola::network::IPV4SocketAddress &source);
+                            const ola::network::IPV4SocketAddress &source,
+                            StreamBufferPool *buffer_pool = NULL);
     ~IncomingStreamTransport();
 
     bool Receive();
@@ -74,11 +129,14 @@ class IncomingStreamTransport {
     TransportHeader m_transport_header;
     class BaseInflator *m_inflator;
     ola::io::ConnectedDescriptor *m_descriptor;
-
-    // end points to the byte after the data
-    uint8_t *m_buffer_start, *m_buffer_end, *m_data_end;
-    // the amount of data we need before we can move to the next stage
-    unsigned int m_outstanding_data;
+    StreamBufferPool *m_buffer_pool;
+
+    // We read as much as is available, so the buffer may hold several PDUs.
+    // data_start points to the first unprocessed byte and data_end to the
+    // byte after the data.
+    uint8_t *m_buffer_start, *m_buffer_end, *m_data_start, *m_data_end;
+    // the amount of data we need, from data_start, to move to the next stage
+    unsigned int m_required_data;
     // the state we're currently in
     RXState m_state;
     unsigned int m_block_size;
@@ -93,7 +151,10 @@ class IncomingStreamTransport {
     void HandlePDU();
 
     void IncreaseBufferSize(unsigned int new_size);
-    void ReadRequiredData();
+    void FreeBuffer();
+    bool IsPoolBuffer() const;
+    bool ReadData();
+    void CompactBuffer();
     void EnterWaitingForPreamble();
     void EnterWaitingForPDU();
 
@@ -106,11 +167,11 @@ class IncomingStreamTransport {
     }
 
     /**
-     * Return the amount of data in the buffer
+     * Return the amount of unprocessed data in the buffer
      */
     inline unsigned int DataLength() const {
       return m_buffer_start ?
-        static_cast<unsigned int>(m_data_end - m_buffer_start) : 0u;
+        static_cast<unsigned int>(m_data_end - m_data_start) : 0u;
     }
 
     /**
@@ -131,7 +192,8 @@ class IncomingStreamTransport {
 class IncomingTCPTransport {
  public:
     IncomingTCPTransport(class BaseInflator *inflator,
-                         ola::network::TCPSocket *socket);
+                         ola::network::TCPSocket *socket,
+                         StreamBufferPool *buffer_pool = NULL);
     ~IncomingTCPTransport() {}
 
     bool Receive() { return m_transport->Receive(); }
@@ -52,6 +52,8 @@ class TCPTransportTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testZeroLengthPDUBlock);
   CPPUNIT_TEST(testMultiplePDUs);
   CPPUNIT_TEST(testSinglePDUBlock);
+  CPPUNIT_TEST(testSplitPDUs);
+  CPPUNIT_TEST(testBufferPool);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -63,6 +65,8 @@ class TCPTransportTest: public CppUnit::TestFixture {
     void testMultiplePDUs();
     void testMultiplePDUsWithExtraData();
     void testSinglePDUBlock();
+    void testSplitPDUs();
+    void testBufferPool();
     void setUp();
     void tearDown();
 
@@ -245,6 +249,72 @@ void TCPTransportTest::testSinglePDUBlock() {
 }
 
 
+/**
+ * Send PDUs that arrive in pieces, splitting the preamble, the length and the
+ * PDU data.
+ */
+void TCPTransportTest::testSplitPDUs() {
+  IOStack packet;
+  MockPDU::PrependPDU(&packet, 1, 2);
+  MockPDU::PrependPDU(&packet, 2, 4);
+  MockPDU::PrependPDU(&packet, 3, 6);
+  PreamblePacker::AddTCPPreamble(&packet);
+  MockPDU::PrependPDU(&packet, 4, 8);
+  PreamblePacker::AddTCPPreamble(&packet);
+
+  IOQueue output;
+  packet.MoveToIOQueue(&output);
+  uint8_t data[200];
+  unsigned int size = output.Read(data, sizeof(data));
+  OLA_ASSERT_LT(size, static_cast<unsigned int>(sizeof(data)));
+
+  const unsigned int splits[] = {10, 22, 25, 31, 44, 52};
+  unsigned int offset = 0;
+  for (unsigned int i = 0; i < sizeof(splits) / sizeof(splits[0]); i++) {
+    OLA_ASSERT(m_loopback.Send(data + offset, splits[i] - offset));
+    offset = splits[i];
+    m_ss->RunOnce(TimeInterval(1, 0));
+    OLA_ASSERT(m_stream_ok);
+  }
+  OLA_ASSERT_EQ(1u, m_pdus_received);
+
+  OLA_ASSERT(m_loopback.Send(data + offset, size - offset));
+  m_ss->RunOnce(TimeInterval(1, 0));
+  m_loopback.CloseClient();
+  m_ss->RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT(m_stream_ok);
+  OLA_ASSERT_EQ(4u, m_pdus_received);
+}
+
+
+/**
+ * Check the rx buffer is returned to the pool between PDU blocks.
+ */
+void TCPTransportTest::testBufferPool() {
+  StreamBufferPool pool;
+  m_transport.reset(new IncomingStreamTransport(m_inflator.get(), &m_loopback,
+                                                m_localhost, &pool));
+
+  SendPDU(OLA_SOURCELINE());
+  SendPDUBlock(OLA_SOURCELINE());
+  m_ss->RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT(m_stream_ok);
+  OLA_ASSERT_EQ(4u, m_pdus_received);
+  OLA_ASSERT_EQ(0u, pool.BuffersInUse());
+  OLA_ASSERT_EQ(1u, pool.FreeBuffers());
+
+  SendPDU(OLA_SOURCELINE());
+  m_ss->RunOnce(TimeInterval(1, 0));
+  m_loopback.CloseClient();
+  m_ss->RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT(m_stream_ok);
+  OLA_ASSERT_EQ(5u, m_pdus_received);
+  OLA_ASSERT_EQ(0u, pool.BuffersInUse());
+  OLA_ASSERT_EQ(1u, pool.FreeBuffers());
+  m_transport.reset();
+}
+
+
 /**
  * Send empty PDU block.
  */
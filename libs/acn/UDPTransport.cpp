@@ -57,13 +57,22 @@ bool OutgoingUDPTransportImpl::Send(const PDUBlock<PDU> &pdu_block,
   if (!data)
     return false;
 
+  if (m_pacer) {
+    ola::network::UDPDatagram datagram;
+    datagram.buffer.iov_base = const_cast<uint8_t*>(data);
+    datagram.buffer.iov_len = data_size;
+    datagram.address = destination;
+    m_pacer->Send(m_socket, m_pacer_interface, &datagram, 1);
+    return true;
+  }
   return m_socket->SendTo(data, data_size, destination);
 }
 
 
 
-IncomingUDPTransport::IncomingUDPTransport(ola::network::UDPSocket *socket,
-                                           BaseInflator *inflator)
+IncomingUDPTransport::IncomingUDPTransport(
+    ola::network::UDPSocketInterface *socket,
+    BaseInflator *inflator)
     : m_socket(socket),
       m_inflator(inflator),
       m_recv_buffer(NULL) {
@@ -71,38 +80,61 @@ IncomingUDPTransport::IncomingUDPTransport(ola::network::UDPSocket *socket,
 
 
 /*
- * Called when new data arrives.
+ * Called when new data arrives. This reads all the datagrams that are
+ * waiting, up to RECV_BATCH_SIZE.
  */
 void IncomingUDPTransport::Receive() {
   if (!m_recv_buffer)
-    m_recv_buffer = new uint8_t[PreamblePacker::MAX_DATAGRAM_SIZE];
+    m_recv_buffer = new uint8_t[RECV_BATCH_SIZE *
+                                PreamblePacker::MAX_DATAGRAM_SIZE];
 
-  ssize_t size = PreamblePacker::MAX_DATAGRAM_SIZE;
-  ola::network::IPV4SocketAddress source;
+  for (unsigned int i = 0; i < RECV_BATCH_SIZE; i++) {
+    m_datagrams[i].buffer.iov_base =
+        m_recv_buffer + i * PreamblePacker::MAX_DATAGRAM_SIZE;
+    m_datagrams[i].buffer.iov_len = PreamblePacker::MAX_DATAGRAM_SIZE;
+  }
+
+  unsigned int received = m_socket->RecvMultiple(m_datagrams,
+                                                 RECV_BATCH_SIZE);
+  for (unsigned int i = 0; i < received; i++) {
+    HandleDatagram(reinterpret_cast<const uint8_t*>(
+                       m_datagrams[i].buffer.iov_base),
+                   m_datagrams[i].buffer.iov_len,
+                   m_datagrams[i].address);
+  }
+}
 
-  if (!m_socket->RecvFrom(m_recv_buffer, &size, &source))
-    return;
 
+/*
+ * Process a single datagram.
+ */
+void IncomingUDPTransport::HandleDatagram(const uint8_t *data, ssize_t size,
+                                          const IPV4SocketAddress &source) {
   unsigned int header_size = PreamblePacker::ACN_HEADER_SIZE;
   if (size < static_cast<ssize_t>(header_size)) {
     OLA_WARN << "short ACN frame, discarding";
     return;
   }
 
-  if (memcmp(m_recv_buffer, PreamblePacker::ACN_HEADER, header_size)) {
+  if (memcmp(data, PreamblePacker::ACN_HEADER, header_size)) {
     OLA_WARN << "ACN header is bad, discarding";
     return;
   }
 
+  if (m_fast_path.get() &&
+      m_fast_path->Run(data + header_size,
+                       static_cast<unsigned int>(size) - header_size)) {
+    return;
+  }
+
   HeaderSet header_set;
   TransportHeader transport_header(source, TransportHeader::UDP);
   header_set.SetTransportHeader(transport_header);
 
   m_inflator->InflatePDUBlock(
       &header_set,
-      m_recv_buffer + header_size,
+      data + header_size,
       static_cast<unsigned int>(size) - header_size);
-  return;
 }
 }  // namespace acn
 }  // namespace ola
@@ -21,10 +21,13 @@
 #ifndef LIBS_ACN_UDPTRANSPORT_H_
 #define LIBS_ACN_UDPTRANSPORT_H_
 
+#include <memory>
+#include "ola/Callback.h"
 #include "ola/acn/ACNPort.h"
 #include "ola/base/Macro.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Socket.h"
+#include "ola/network/TransmitPacer.h"
 #include "libs/acn/PDU.h"
 #include "libs/acn/PreamblePacker.h"
 #include "libs/acn/Transport.h"
@@ -65,7 +68,8 @@ class OutgoingUDPTransportImpl {
                              PreamblePacker *packer = NULL)
         : m_socket(socket),
           m_packer(packer),
-          m_free_packer(false) {
+          m_free_packer(false),
+          m_pacer(NULL) {
       if (!m_packer) {
         m_packer = new PreamblePacker();
         m_free_packer = true;
@@ -79,10 +83,22 @@ class OutgoingUDPTransportImpl {
     bool Send(const PDUBlock<PDU> &pdu_block,
               const ola::network::IPV4SocketAddress &destination);
 
+    /*
+     * Queue the packets with a TransmitPacer rather than sending them
+     * directly. The pacer copies the data.
+     */
+    void SetTransmitPacer(ola::network::TransmitPacer *pacer,
+                          const ola::network::IPV4Address &iface) {
+      m_pacer = pacer;
+      m_pacer_interface = iface;
+    }
+
  private:
     ola::network::UDPSocket *m_socket;
     PreamblePacker *m_packer;
     bool m_free_packer;
+    ola::network::TransmitPacer *m_pacer;
+    ola::network::IPV4Address m_pacer_interface;
 };
 
 
@@ -93,19 +109,52 @@ class OutgoingUDPTransportImpl {
  */
 class IncomingUDPTransport {
  public:
-    IncomingUDPTransport(ola::network::UDPSocket *socket,
+    IncomingUDPTransport(ola::network::UDPSocketInterface *socket,
                          class BaseInflator *inflator);
     ~IncomingUDPTransport() {
       if (m_recv_buffer)
         delete[] m_recv_buffer;
     }
 
+    /**
+     * @brief Called with each datagram, after the ACN preamble has been
+     *   checked.
+     *
+     * The arguments are the data following the preamble and its length. If
+     * the callback returns true the datagram has been handled and isn't passed
+     * to the inflator.
+     */
+    typedef ola::Callback2<bool, const uint8_t*, unsigned int>
+        FastPathCallback;
+
+    /**
+     * @brief Set the callback used to handle datagrams before the inflator.
+     * @param callback the FastPathCallback, ownership is transferred.
+     */
+    void SetFastPath(FastPathCallback *callback) {
+      m_fast_path.reset(callback);
+    }
+
     void Receive();
 
+    /**
+     * @brief Process a datagram that was received elsewhere.
+     * @param data the UDP payload.
+     * @param size the size of the payload.
+     * @param source the source of the datagram.
+     */
+    void HandleDatagram(const uint8_t *data, ssize_t size,
+                        const ola::network::IPV4SocketAddress &source);
+
  private:
-    ola::network::UDPSocket *m_socket;
+    // The maximum number of datagrams to read each time the socket is ready.
+    static const unsigned int RECV_BATCH_SIZE = 16;
+
+    ola::network::UDPSocketInterface *m_socket;
     class BaseInflator *m_inflator;
+    std::auto_ptr<FastPathCallback> m_fast_path;
     uint8_t *m_recv_buffer;
+    ola::network::UDPDatagram m_datagrams[RECV_BATCH_SIZE];
 };
 }  // namespace acn
 }  // namespace ola
@@ -27,6 +27,7 @@
 #include <ola/rdm/QueueingRDMController.h>
 #include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMCommandSerializer.h>
+#include <ola/rdm/RDMCommandView.h>
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/rdm/RDMPacket.h>
 #include <ola/rdm/UID.h>
@@ -217,18 +218,19 @@ void JaRulePortHandleImpl::MuteDeviceComplete(
   if (result == COMMAND_RESULT_OK &&
       return_code == RC_OK &&
       payload.size() > sizeof(GetSetTiming)) {
-    // Skip the timing data & the start code.
-    ola::rdm::RDMStatusCode status_code = rdm::RDM_INVALID_RESPONSE;
-    auto_ptr<RDMResponse> response(RDMResponse::InflateFromData(
-          payload.substr(sizeof(GetSetTiming) + 1), &status_code));
+    // Skip the timing data & the start code. We only need to look at the
+    // response, so parse it in place rather than inflating an RDMResponse.
+    ola::rdm::RDMCommandView response;
+    ola::rdm::RDMStatusCode status_code = response.Parse(
+        payload.data() + sizeof(GetSetTiming) + 1,
+        payload.size() - sizeof(GetSetTiming) - 1);
 
     // TODO(simon): I guess we could ack timer the MUTE. Handle this case
     // someday.
     muted_ok = (
         status_code == rdm::RDM_COMPLETED_OK &&
-        response.get() &&
-        response->CommandClass() == RDMCommand::DISCOVER_COMMAND_RESPONSE &&
-        response->ResponseType() == rdm::RDM_ACK);
+        response.CommandClass() == RDMCommand::DISCOVER_COMMAND_RESPONSE &&
+        response.PortIdResponseType() == rdm::RDM_ACK);
   } else {
     OLA_INFO << "Mute failed! Result: " << result << ", RC: " << return_code
              << ", payload size: " << payload.size();
@@ -23,14 +23,13 @@
 #include <ola/Callback.h>
 #include <ola/Constants.h>
 #include <ola/Logging.h>
-#include <ola/stl/STLUtils.h>
 #include <ola/strings/Format.h>
 #include <ola/thread/Mutex.h>
 #include <ola/util/Utils.h>
 
-#include <memory>
+#include <string.h>
+#include <algorithm>
 #include <string>
-#include <utility>
 
 namespace ola {
 namespace usb {
@@ -43,7 +42,6 @@ using ola::utils::JoinUInt8;
 using ola::utils::SplitUInt16;
 using std::cerr;
 using std::string;
-using std::auto_ptr;
 
 namespace {
 
@@ -60,7 +58,7 @@ __attribute__((__stdcall__))
 #endif  // _WIN32
 void OutTransferCompleteHandler(struct libusb_transfer *transfer) {
   JaRuleWidgetPort *port = static_cast<JaRuleWidgetPort*>(transfer->user_data);
-  return port->_OutTransferComplete();
+  return port->_OutTransferComplete(transfer);
 }
 
 }  // namespace
@@ -78,10 +76,18 @@ JaRuleWidgetPort::JaRuleWidgetPort(ola::thread::ExecutorInterface *executor,
       m_uid(uid),
       m_physical_port(physical_port),
       m_handle(NULL),
-      m_out_transfer(adaptor->AllocTransfer(0)),
-      m_out_in_progress(false),
       m_in_transfer(adaptor->AllocTransfer(0)),
       m_in_in_progress(false) {
+  for (unsigned int i = 0; i < COMMAND_POOL_SIZE; i++) {
+    m_free_commands.PushBack(&m_commands[i]);
+  }
+  std::fill(m_commands_by_token, m_commands_by_token + TOKEN_COUNT,
+            static_cast<PendingCommand*>(NULL));
+
+  for (unsigned int i = 0; i < MAX_IN_FLIGHT; i++) {
+    m_out_transfers[i].transfer = adaptor->AllocTransfer(0);
+    m_out_transfers[i].in_progress = false;
+  }
 }
 
 JaRuleWidgetPort::~JaRuleWidgetPort() {
@@ -92,20 +98,22 @@ JaRuleWidgetPort::~JaRuleWidgetPort() {
 
   {
     MutexLocker locker(&m_mutex);
-    if (!m_queued_commands.empty()) {
+    if (!(m_queued_dmx.Empty() && m_queued_commands.Empty())) {
       OLA_WARN << "Queued commands remain, did we forget to call "
                   "CancelTransfer()?";
     }
 
-    if (!m_pending_commands.empty()) {
+    if (!m_pending_commands.Empty()) {
       OLA_WARN << "Pending commands remain, did we forget to call "
                   "CancelTransfer()?";
     }
 
     // Cancelling may take up to a second if the endpoint has stalled. I can't
     // really see a way to speed this up.
-    if (m_out_in_progress) {
-      m_adaptor->CancelTransfer(m_out_transfer);
+    for (unsigned int i = 0; i < MAX_IN_FLIGHT; i++) {
+      if (m_out_transfers[i].in_progress) {
+        m_adaptor->CancelTransfer(m_out_transfers[i].transfer);
+      }
     }
 
     if (m_in_in_progress) {
@@ -118,11 +126,13 @@ JaRuleWidgetPort::~JaRuleWidgetPort() {
   while (transfers_pending) {
     // Spin waiting for the transfers to complete.
     MutexLocker locker(&m_mutex);
-    transfers_pending = m_out_in_progress || m_in_in_progress;
+    transfers_pending = OutTransfersInProgress() || m_in_in_progress;
   }
 
-  if (m_out_transfer) {
-    m_adaptor->FreeTransfer(m_out_transfer);
+  for (unsigned int i = 0; i < MAX_IN_FLIGHT; i++) {
+    if (m_out_transfers[i].transfer) {
+      m_adaptor->FreeTransfer(m_out_transfers[i].transfer);
+    }
   }
 
   if (m_in_transfer) {
@@ -147,39 +157,40 @@ void JaRuleWidgetPort::ReleasePort() {
 }
 
 void JaRuleWidgetPort::CancelAll() {
-  CommandQueue queued_commands;
-  PendingCommandMap pending_commands;
+  CommandList cancelled;
 
   {
     MutexLocker locker(&m_mutex);
-    queued_commands = m_queued_commands;
-    while (!m_queued_commands.empty()) {
-      m_queued_commands.pop();
+    while (!m_queued_dmx.Empty()) {
+      cancelled.PushBack(m_queued_dmx.PopFront());
+    }
+    while (!m_queued_commands.Empty()) {
+      cancelled.PushBack(m_queued_commands.PopFront());
+    }
+    while (!m_pending_commands.Empty()) {
+      PendingCommand *command = m_pending_commands.PopFront();
+      m_commands_by_token[command->token] = NULL;
+      cancelled.PushBack(command);
     }
-    pending_commands.swap(m_pending_commands);
   }
 
-  while (!queued_commands.empty()) {
-    auto_ptr<PendingCommand> command(queued_commands.front());
+  // The cancelled commands aren't on any of the shared lists, so we can run
+  // the callbacks without holding the lock.
+  for (PendingCommand *command = cancelled.Front(); command;
+       command = command->next) {
     if (command->callback) {
       command->callback->Run(COMMAND_RESULT_CANCELLED, RC_UNKNOWN, 0,
                              ByteString());
     }
-    queued_commands.pop();
-  }
-
-  PendingCommandMap::iterator iter = pending_commands.begin();
-  for (; iter != pending_commands.end(); ++iter) {
-    if (iter->second->callback) {
-      iter->second->callback->Run(COMMAND_RESULT_CANCELLED, RC_UNKNOWN, 0,
-                                  ByteString());
-      delete iter->second;
-    }
   }
 
   {
     MutexLocker locker(&m_mutex);
-    if (!(m_queued_commands.empty() && m_pending_commands.empty())) {
+    while (!cancelled.Empty()) {
+      FreeCommand(cancelled.PopFront());
+    }
+    if (!(m_queued_dmx.Empty() && m_queued_commands.Empty() &&
+          m_pending_commands.Empty())) {
       OLA_WARN << "Some commands have not been cancelled";
     }
   }
@@ -204,34 +215,15 @@ void JaRuleWidgetPort::SendCommand(
     return;
   }
 
-  // Create the payload
-  ByteString payload;
-  payload.reserve(size + MIN_RESPONSE_SIZE);
-
-  payload.push_back(SOF_IDENTIFIER);
-  payload.push_back(0);  // token, will be set on TX
-  payload.push_back(command_class & 0xff);
-  payload.push_back(command_class >> 8);
-  payload.push_back(size & 0xff);
-  payload.push_back(size >> 8);
-  payload.append(data, size);
-  payload.push_back(EOF_IDENTIFIER);
-
-  if (payload.size() % USB_PACKET_SIZE == 0)  {
-    // We need to pad the message so that the transfer completes on the
-    // Device side. We could use LIBUSB_TRANSFER_ADD_ZERO_PACKET instead but
-    // that isn't available on all platforms.
-    payload.push_back(0);
-  }
-
-  auto_ptr<PendingCommand> command(new PendingCommand(
-      command_class, callback, payload));
-
   OLA_INFO << "Adding new command " << ToHex(command_class);
 
   MutexLocker locker(&m_mutex);
 
-  if (m_queued_commands.size() > MAX_QUEUED_MESSAGES) {
+  const bool is_dmx = command_class == JARULE_CMD_TX_DMX;
+  CommandList *queue = is_dmx ? &m_queued_dmx : &m_queued_commands;
+  const unsigned int queue_limit = is_dmx ? MAX_QUEUED_DMX :
+      MAX_QUEUED_MESSAGES;
+  if (queue->Size() >= queue_limit || m_free_commands.Empty()) {
     locker.Release();
     OLA_WARN << "JaRule outbound queue is full";
     if (callback) {
@@ -240,23 +232,54 @@ void JaRuleWidgetPort::SendCommand(
     return;
   }
 
-  m_queued_commands.push(command.release());
+  PendingCommand *command = m_free_commands.PopFront();
+  command->command = command_class;
+  command->callback = callback;
+
+  // Create the payload
+  uint8_t *payload = command->payload;
+  unsigned int length = 0;
+  payload[length++] = SOF_IDENTIFIER;
+  payload[length++] = 0;  // token, will be set on TX
+  payload[length++] = command_class & 0xff;
+  payload[length++] = command_class >> 8;
+  payload[length++] = size & 0xff;
+  payload[length++] = size >> 8;
+  if (size) {
+    memcpy(payload + length, data, size);
+    length += size;
+  }
+  payload[length++] = EOF_IDENTIFIER;
+
+  if (length % USB_PACKET_SIZE == 0)  {
+    // We need to pad the message so that the transfer completes on the
+    // Device side. We could use LIBUSB_TRANSFER_ADD_ZERO_PACKET instead but
+    // that isn't available on all platforms.
+    payload[length++] = 0;
+  }
+  command->size = length;
+
+  queue->PushBack(command);
   MaybeSendCommand();
 }
 
-void JaRuleWidgetPort::_OutTransferComplete() {
+void JaRuleWidgetPort::_OutTransferComplete(libusb_transfer *transfer) {
   OLA_DEBUG << "Out Command status is "
-            << LibUsbAdaptor::ErrorCodeToString(m_in_transfer->status);
-  if (m_out_transfer->status == LIBUSB_TRANSFER_COMPLETED) {
-    if (m_out_transfer->actual_length != m_out_transfer->length) {
+            << LibUsbAdaptor::ErrorCodeToString(transfer->status);
+  if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+    if (transfer->actual_length != transfer->length) {
       // TODO(simon): Decide what to do here
-      OLA_WARN << "Only sent " << m_out_transfer->actual_length << " / "
-               << m_out_transfer->length << " bytes";
+      OLA_WARN << "Only sent " << transfer->actual_length << " / "
+               << transfer->length << " bytes";
     }
   }
 
   MutexLocker locker(&m_mutex);
-  m_out_in_progress = false;
+  for (unsigned int i = 0; i < MAX_IN_FLIGHT; i++) {
+    if (m_out_transfers[i].transfer == transfer) {
+      m_out_transfers[i].in_progress = false;
+    }
+  }
   MaybeSendCommand();
 }
 
@@ -271,71 +294,104 @@ void JaRuleWidgetPort::_InTransferComplete() {
     HandleResponse(m_in_transfer->buffer, m_in_transfer->actual_length);
   }
 
-  PendingCommandMap::iterator iter = m_pending_commands.begin();
+  // Commands are sent in order, so the oldest are at the front.
   TimeStamp time_limit;
   m_clock.CurrentMonotonicTime(&time_limit);
   time_limit -= TimeInterval(1, 0);
-  while (iter != m_pending_commands.end()) {
-    PendingCommand *command = iter->second;
-    if (command->out_time < time_limit) {
-      ScheduleCallback(command->callback, COMMAND_RESULT_TIMEOUT, RC_UNKNOWN, 0,
-                       ByteString());
-      delete command;
-      m_pending_commands.erase(iter++);
-    } else {
-      iter++;
-    }
+  while (!m_pending_commands.Empty() &&
+         m_pending_commands.Front()->out_time < time_limit) {
+    PendingCommand *command = m_pending_commands.PopFront();
+    m_commands_by_token[command->token] = NULL;
+    ScheduleCallback(command->callback, COMMAND_RESULT_TIMEOUT, RC_UNKNOWN, 0,
+                     ByteString());
+    FreeCommand(command);
   }
 
-  if (!m_pending_commands.empty()) {
+  // Responses free up slots for queued commands.
+  MaybeSendCommand();
+
+  if (!m_pending_commands.Empty() && !m_in_in_progress) {
     SubmitInTransfer();
   }
 }
 
 void JaRuleWidgetPort::MaybeSendCommand() {
-  if (m_out_in_progress ||
-      m_pending_commands.size() > MAX_IN_FLIGHT ||
-      m_queued_commands.empty()) {
-    return;
-  }
+  while (m_pending_commands.Size() < MAX_IN_FLIGHT) {
+    // DMX frames go ahead of everything else.
+    CommandList *queue = m_queued_dmx.Empty() ? &m_queued_commands :
+        &m_queued_dmx;
+    if (queue->Empty()) {
+      return;
+    }
 
-  PendingCommand *command = m_queued_commands.front();
-  m_queued_commands.pop();
+    OutTransfer *out = NULL;
+    for (unsigned int i = 0; i < MAX_IN_FLIGHT; i++) {
+      if (!m_out_transfers[i].in_progress) {
+        out = &m_out_transfers[i];
+        break;
+      }
+    }
+    if (!out) {
+      return;
+    }
 
-  uint8_t token = m_token.Next();
-  command->payload[1] = token;
-  m_adaptor->FillBulkTransfer(
-      m_out_transfer, m_usb_handle, m_endpoint_number | LIBUSB_ENDPOINT_OUT,
-      const_cast<uint8_t*>(command->payload.data()),
-      command->payload.size(), OutTransferCompleteHandler,
-      static_cast<void*>(this), ENDPOINT_TIMEOUT_MS);
+    PendingCommand *command = queue->PopFront();
+    uint8_t token = m_token.Next();
+    command->token = token;
+    command->payload[1] = token;
+
+    // The command may time out or be cancelled before the transfer
+    // completes, so the transfer gets its own copy of the data.
+    memcpy(out->buffer, command->payload, command->size);
+    m_adaptor->FillBulkTransfer(
+        out->transfer, m_usb_handle, m_endpoint_number | LIBUSB_ENDPOINT_OUT,
+        out->buffer, command->size, OutTransferCompleteHandler,
+        static_cast<void*>(this), ENDPOINT_TIMEOUT_MS);
+
+    int r = m_adaptor->SubmitTransfer(out->transfer);
+    if (r) {
+      OLA_WARN << "Failed to submit outbound transfer: "
+               << LibUsbAdaptor::ErrorCodeToString(r);
+      ScheduleCallback(command->callback, COMMAND_RESULT_SEND_ERROR,
+                       RC_UNKNOWN, 0, ByteString());
+      FreeCommand(command);
+      return;
+    }
+    out->in_progress = true;
+
+    m_clock.CurrentMonotonicTime(&command->out_time);
+    PendingCommand *old_command = m_commands_by_token[token];
+    if (old_command) {
+      // We had an old entry, cancel it.
+      m_pending_commands.Remove(old_command);
+      ScheduleCallback(old_command->callback, COMMAND_RESULT_CANCELLED,
+                       RC_UNKNOWN, 0, ByteString());
+      FreeCommand(old_command);
+    }
+    m_commands_by_token[token] = command;
+    m_pending_commands.PushBack(command);
 
-  int r = m_adaptor->SubmitTransfer(m_out_transfer);
-  if (r) {
-    OLA_WARN << "Failed to submit outbound transfer: "
-             << LibUsbAdaptor::ErrorCodeToString(r);
-    ScheduleCallback(command->callback, COMMAND_RESULT_SEND_ERROR, RC_UNKNOWN,
-                     0, ByteString());
-    delete command;
-    return;
+    if (!m_in_in_progress) {
+      SubmitInTransfer();
+    }
   }
+}
 
-  m_clock.CurrentMonotonicTime(&command->out_time);
-  std::pair<PendingCommandMap::iterator, bool> p = m_pending_commands.insert(
-      PendingCommandMap::value_type(token, command));
-  if (!p.second) {
-    // We had an old entry, cancel it.
-    ScheduleCallback(p.first->second->callback,
-                     COMMAND_RESULT_CANCELLED, RC_UNKNOWN, 0, ByteString());
-    delete p.first->second;
-    p.first->second = command;
-  }
+/*
+ * @brief Return a command to the pool.
+ */
+void JaRuleWidgetPort::FreeCommand(PendingCommand *command) {
+  command->callback = NULL;
+  m_free_commands.PushBack(command);
+}
 
-  m_out_in_progress = true;
-  if (!m_in_in_progress) {
-    SubmitInTransfer();
+bool JaRuleWidgetPort::OutTransfersInProgress() const {
+  for (unsigned int i = 0; i < MAX_IN_FLIGHT; i++) {
+    if (m_out_transfers[i].in_progress) {
+      return true;
+    }
   }
-  return;
+  return false;
 }
 
 bool JaRuleWidgetPort::SubmitInTransfer() {
@@ -404,10 +460,12 @@ void JaRuleWidgetPort::HandleResponse(const uint8_t *data, unsigned int size) {
     return;
   }
 
-  PendingCommand *command;
-  if (!STLLookupAndRemove(&m_pending_commands, token, &command)) {
+  PendingCommand *command = m_commands_by_token[token];
+  if (!command) {
     return;
   }
+  m_commands_by_token[token] = NULL;
+  m_pending_commands.Remove(command);
 
   USBCommandResult status = COMMAND_RESULT_OK;
   if (command->command != command_class) {
@@ -420,7 +478,7 @@ void JaRuleWidgetPort::HandleResponse(const uint8_t *data, unsigned int size) {
   }
   ScheduleCallback(
       command->callback, status, return_code, status_flags, payload);
-  delete command;
+  FreeCommand(command);
 }
 
 /*
@@ -455,5 +513,41 @@ void JaRuleWidgetPort::RunCallback(CommandCompleteCallback *callback,
                                    CallbackArgs args) {
   callback->Run(args.result, args.return_code, args.status_flags, args.payload);
 }
+
+void JaRuleWidgetPort::CommandList::PushBack(PendingCommand *command) {
+  command->previous = m_tail;
+  command->next = NULL;
+  if (m_tail) {
+    m_tail->next = command;
+  } else {
+    m_head = command;
+  }
+  m_tail = command;
+  m_size++;
+}
+
+JaRuleWidgetPort::PendingCommand *JaRuleWidgetPort::CommandList::PopFront() {
+  PendingCommand *command = m_head;
+  if (command) {
+    Remove(command);
+  }
+  return command;
+}
+
+void JaRuleWidgetPort::CommandList::Remove(PendingCommand *command) {
+  if (command->previous) {
+    command->previous->next = command->next;
+  } else {
+    m_head = command->next;
+  }
+  if (command->next) {
+    command->next->previous = command->previous;
+  } else {
+    m_tail = command->previous;
+  }
+  command->previous = NULL;
+  command->next = NULL;
+  m_size--;
+}
 }  // namespace usb
 }  // namespace ola
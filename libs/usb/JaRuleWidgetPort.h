@@ -28,9 +28,6 @@
 #include <ola/thread/Mutex.h>
 #include <ola/util/SequenceNumber.h>
 
-#include <map>
-#include <queue>
-
 #include "libs/usb/JaRulePortHandle.h"
 #include "libs/usb/LibUsbAdaptor.h"
 #include "libs/usb/JaRuleWidget.h"
@@ -43,6 +40,14 @@ namespace usb {
  *
  * Each port has its own libusb transfers as well as a command queue. This
  * avoids slow commands on one port blocking another.
+ *
+ * Several commands may be in flight at once, responses are matched to
+ * commands using the token. DMX frames are queued separately from other
+ * commands and are sent first, so a burst of RDM requests doesn't hold up
+ * the DMX refresh.
+ *
+ * The commands and the outbound transfers come from fixed size pools which
+ * are allocated when the port is created.
  */
 class JaRuleWidgetPort {
  public:
@@ -105,7 +110,7 @@ class JaRuleWidgetPort {
    * @brief Called by the libusb callback when the transfer completes or is
    * cancelled.
    */
-  void _OutTransferComplete();
+  void _OutTransferComplete(libusb_transfer *transfer);
 
   /**
    * @brief Called by the libusb callback when the transfer completes or is
@@ -119,6 +124,10 @@ class JaRuleWidgetPort {
   // to be safe.
   enum { IN_BUFFER_SIZE = 1024 };
   enum { OUT_BUFFER_SIZE = 1024 };
+  // The number of commands sent but not yet responded to.
+  enum { MAX_IN_FLIGHT = 3 };
+  enum { COMMAND_POOL_SIZE = 16 };
+  enum { TOKEN_COUNT = 256 };
 
   // The arguments passed to the user supplied callback.
   typedef struct {
@@ -130,22 +139,49 @@ class JaRuleWidgetPort {
 
   class PendingCommand {
    public:
-    PendingCommand(CommandClass command,
-                   CommandCompleteCallback *callback,
-                   const ola::io::ByteString &payload)
-        : command(command),
-          callback(callback),
-          payload(payload) {
+    PendingCommand()
+        : command(JARULE_CMD_RESET_DEVICE),
+          callback(NULL),
+          size(0),
+          token(0),
+          previous(NULL),
+          next(NULL) {
     }
 
     CommandClass command;
     CommandCompleteCallback *callback;
-    ola::io::ByteString payload;
+    uint8_t payload[OUT_BUFFER_SIZE];
+    unsigned int size;
+    uint8_t token;
     TimeStamp out_time;  // When this cmd was sent
+    PendingCommand *previous;
+    PendingCommand *next;
+  };
+
+  // An intrusive list of commands, this doesn't allocate.
+  class CommandList {
+   public:
+    CommandList() : m_head(NULL), m_tail(NULL), m_size(0) {}
+
+    bool Empty() const { return m_head == NULL; }
+    unsigned int Size() const { return m_size; }
+    PendingCommand *Front() const { return m_head; }
+
+    void PushBack(PendingCommand *command);
+    PendingCommand *PopFront();
+    void Remove(PendingCommand *command);
+
+   private:
+    PendingCommand *m_head;
+    PendingCommand *m_tail;
+    unsigned int m_size;
   };
 
-  typedef std::map<uint8_t, PendingCommand*> PendingCommandMap;
-  typedef std::queue<PendingCommand*> CommandQueue;
+  struct OutTransfer {
+    libusb_transfer *transfer;
+    bool in_progress;
+    uint8_t buffer[OUT_BUFFER_SIZE];
+  };
 
   ola::Clock m_clock;
   ola::thread::ExecutorInterface* const m_executor;
@@ -159,17 +195,23 @@ class JaRuleWidgetPort {
   ola::SequenceNumber<uint8_t> m_token;
 
   ola::thread::Mutex m_mutex;
-  CommandQueue m_queued_commands;  // GUARDED_BY(m_mutex);
-  PendingCommandMap m_pending_commands;  // GUARDED_BY(m_mutex);
+  PendingCommand m_commands[COMMAND_POOL_SIZE];
+  CommandList m_free_commands;  // GUARDED_BY(m_mutex);
+  CommandList m_queued_dmx;  // GUARDED_BY(m_mutex);
+  CommandList m_queued_commands;  // GUARDED_BY(m_mutex);
+  // Commands that have been sent, oldest first.
+  CommandList m_pending_commands;  // GUARDED_BY(m_mutex);
+  PendingCommand *m_commands_by_token[TOKEN_COUNT];  // GUARDED_BY(m_mutex);
 
-  libusb_transfer *m_out_transfer;  // GUARDED_BY(m_mutex);
-  bool m_out_in_progress;  // GUARDED_BY(m_mutex);
+  OutTransfer m_out_transfers[MAX_IN_FLIGHT];  // GUARDED_BY(m_mutex);
 
   uint8_t m_in_buffer[IN_BUFFER_SIZE];  // GUARDED_BY(m_mutex);
   libusb_transfer *m_in_transfer;  // GUARDED_BY(m_mutex);
   bool m_in_in_progress;  // GUARDED_BY(m_mutex);
 
   void MaybeSendCommand();  // LOCK_REQUIRED(m_mutex);
+  void FreeCommand(PendingCommand *command);  // LOCK_REQUIRED(m_mutex);
+  bool OutTransfersInProgress() const;  // LOCK_REQUIRED(m_mutex);
   bool SubmitInTransfer();  // LOCK_REQUIRED(m_mutex);
   void HandleResponse(const uint8_t *data,
                       unsigned int size);  // LOCK_REQUIRED(m_mutex);
@@ -187,8 +229,9 @@ class JaRuleWidgetPort {
   static const unsigned int MAX_PAYLOAD_SIZE = 513;
   static const unsigned int MIN_RESPONSE_SIZE = 9;
   static const unsigned int USB_PACKET_SIZE = 64;
-  static const unsigned int MAX_IN_FLIGHT = 2;
   static const unsigned int MAX_QUEUED_MESSAGES = 10;
+  // DMX frames are sent in order, so there is no point queuing many.
+  static const unsigned int MAX_QUEUED_DMX = 2;
 
   static const unsigned int ENDPOINT_TIMEOUT_MS = 1000;
 
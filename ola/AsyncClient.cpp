@@ -0,0 +1,424 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * AsyncClient.cpp
+ * A thread safe client that returns Futures.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/AutoStart.h>  // NOLINT(build/include)
+#include <ola/Callback.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/client/AsyncClient.h>
+#include <ola/client/ClientArgs.h>
+#include <ola/client/ClientTypes.h>
+#include <ola/client/OlaClient.h>
+#include <ola/client/Result.h>
+#include <ola/io/SelectServer.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/network/TCPSocket.h>
+#include <ola/rdm/RDMCommand.h>
+#include <ola/thread/Future.h>
+
+#include <set>
+#include <string>
+
+namespace ola {
+namespace client {
+
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::thread::Future;
+using std::string;
+
+namespace {
+
+/*
+ * Send DMX and complete the future when olad acknowledges it.
+ */
+class SendDMXRequest: public AsyncClient::Request {
+ public:
+  SendDMXRequest(unsigned int universe, const DmxBuffer &data,
+                 uint8_t priority, const Future<AsyncResult> &future)
+      : m_client(NULL),
+        m_universe(universe),
+        m_data(data),
+        m_priority(priority),
+        m_future(future) {
+  }
+
+  void Send(AsyncClient *client, OlaClient *ola_client) {
+    m_client = client;
+    SendDMXArgs args(NewSingleCallback(this, &SendDMXRequest::Complete));
+    args.priority = m_priority;
+    ola_client->SendDMX(m_universe, m_data, args);
+  }
+
+  void Fail(const string &error) {
+    AsyncResult result;
+    result.error = error;
+    m_future.Set(result);
+  }
+
+ private:
+  AsyncClient *m_client;
+  const unsigned int m_universe;
+  const DmxBuffer m_data;
+  const uint8_t m_priority;
+  Future<AsyncResult> m_future;
+
+  void Complete(const Result &result) {
+    AsyncResult set_result;
+    set_result.error = result.Error();
+    m_future.Set(set_result);
+    m_client->RequestComplete(this);
+  }
+};
+
+/*
+ * Send DMX without an acknowledgement.
+ */
+class StreamDMXRequest: public AsyncClient::Request {
+ public:
+  StreamDMXRequest(unsigned int universe, const DmxBuffer &data,
+                   uint8_t priority)
+      : m_universe(universe),
+        m_data(data),
+        m_priority(priority) {
+  }
+
+  void Send(AsyncClient *client, OlaClient *ola_client) {
+    SendDMXArgs args;
+    args.priority = m_priority;
+    ola_client->SendDMX(m_universe, m_data, args);
+    client->RequestComplete(this);
+  }
+
+  void Fail(const string&) {}
+
+ private:
+  const unsigned int m_universe;
+  const DmxBuffer m_data;
+  const uint8_t m_priority;
+};
+
+/*
+ * Fetch the DMX data for a universe.
+ */
+class FetchDMXRequest: public AsyncClient::Request {
+ public:
+  FetchDMXRequest(unsigned int universe,
+                  const Future<AsyncDMXResult> &future)
+      : m_client(NULL),
+        m_universe(universe),
+        m_future(future) {
+  }
+
+  void Send(AsyncClient *client, OlaClient *ola_client) {
+    m_client = client;
+    ola_client->FetchDMX(
+        m_universe, NewSingleCallback(this, &FetchDMXRequest::Complete));
+  }
+
+  void Fail(const string &error) {
+    AsyncDMXResult result;
+    result.error = error;
+    m_future.Set(result);
+  }
+
+ private:
+  AsyncClient *m_client;
+  const unsigned int m_universe;
+  Future<AsyncDMXResult> m_future;
+
+  void Complete(const Result &result, const DMXMetadata &metadata,
+                const DmxBuffer &data) {
+    AsyncDMXResult dmx_result;
+    dmx_result.error = result.Error();
+    dmx_result.priority = metadata.priority;
+    dmx_result.data = data;
+    m_future.Set(dmx_result);
+    m_client->RequestComplete(this);
+  }
+};
+
+/*
+ * Send an RDM Get or Set.
+ */
+class RDMRequest: public AsyncClient::Request {
+ public:
+  RDMRequest(bool is_set, unsigned int universe, const UID &uid,
+             uint16_t sub_device, uint16_t pid, const uint8_t *data,
+             unsigned int data_length,
+             const Future<AsyncRDMResult> &future)
+      : m_client(NULL),
+        m_is_set(is_set),
+        m_universe(universe),
+        m_uid(uid),
+        m_sub_device(sub_device),
+        m_pid(pid),
+        m_data(data ? reinterpret_cast<const char*>(data) : "",
+               data ? data_length : 0),
+        m_future(future) {
+  }
+
+  void Send(AsyncClient *client, OlaClient *ola_client) {
+    m_client = client;
+    SendRDMArgs args(NewSingleCallback(this, &RDMRequest::Complete));
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(m_data.data());
+    if (m_is_set) {
+      ola_client->RDMSet(m_universe, m_uid, m_sub_device, m_pid, data,
+                         m_data.size(), args);
+    } else {
+      ola_client->RDMGet(m_universe, m_uid, m_sub_device, m_pid, data,
+                         m_data.size(), args);
+    }
+  }
+
+  void Fail(const string &error) {
+    AsyncRDMResult result;
+    result.error = error;
+    m_future.Set(result);
+  }
+
+ private:
+  AsyncClient *m_client;
+  const bool m_is_set;
+  const unsigned int m_universe;
+  const UID m_uid;
+  const uint16_t m_sub_device;
+  const uint16_t m_pid;
+  const string m_data;
+  Future<AsyncRDMResult> m_future;
+
+  void Complete(const Result &result, const RDMMetadata &metadata,
+                const RDMResponse *response) {
+    AsyncRDMResult rdm_result;
+    rdm_result.error = result.Error();
+    rdm_result.response_code = metadata.response_code;
+    if (response) {
+      rdm_result.response_type = response->ResponseType();
+      rdm_result.pid = response->ParamId();
+      rdm_result.param_data.assign(
+          reinterpret_cast<const char*>(response->ParamData()),
+          response->ParamDataSize());
+    }
+    m_future.Set(rdm_result);
+    m_client->RequestComplete(this);
+  }
+};
+}  // namespace
+
+
+AsyncClient::AsyncClient(const Options &options)
+    : Thread(Thread::Options("ola-async-client")),
+      m_options(options),
+      m_running(false),
+      m_wake_up_pending(false) {
+}
+
+AsyncClient::~AsyncClient() {
+  Stop();
+}
+
+bool AsyncClient::Setup() {
+  if (m_running) {
+    return false;
+  }
+
+  if (m_options.auto_start) {
+    m_socket.reset(ConnectToServer(m_options.server_port));
+  } else {
+    m_socket.reset(ola::network::TCPSocket::Connect(
+        ola::network::IPV4SocketAddress(ola::network::IPV4Address::Loopback(),
+                                        m_options.server_port)));
+  }
+  if (!m_socket.get()) {
+    return false;
+  }
+
+  m_client.reset(new OlaClient(m_socket.get()));
+  if (!m_client->Setup() || !m_wake_up.Init()) {
+    m_client.reset();
+    m_socket.reset();
+    return false;
+  }
+
+  m_ss.reset(new ola::io::SelectServer());
+  m_ss->AddReadDescriptor(m_socket.get());
+  m_wake_up.SetOnData(NewCallback(this, &AsyncClient::ProcessQueue));
+  m_ss->AddReadDescriptor(&m_wake_up);
+
+  m_running = true;
+  if (!Start()) {
+    OLA_WARN << "Failed to start the client thread";
+    m_running = false;
+    m_ss.reset();
+    m_client.reset();
+    m_socket.reset();
+    m_wake_up.Close();
+    return false;
+  }
+  return true;
+}
+
+void AsyncClient::Stop() {
+  if (!m_running) {
+    return;
+  }
+
+  // A NULL request tells the client thread to exit.
+  Submit(NULL);
+  Join();
+  m_running = false;
+
+  m_ss->RemoveReadDescriptor(&m_wake_up);
+  m_ss->RemoveReadDescriptor(m_socket.get());
+  m_client->Stop();
+  m_client.reset();
+  FailAll("The client was stopped");
+  m_ss.reset();
+  m_socket.reset();
+  m_wake_up.Close();
+  m_wake_up_pending = false;
+}
+
+Future<AsyncResult> AsyncClient::SendDMX(unsigned int universe,
+                                         const DmxBuffer &data,
+                                         uint8_t priority) {
+  Future<AsyncResult> future;
+  Submit(new SendDMXRequest(universe, data, priority, future));
+  return future;
+}
+
+bool AsyncClient::StreamDMX(unsigned int universe,
+                            const DmxBuffer &data,
+                            uint8_t priority) {
+  if (!m_running) {
+    return false;
+  }
+  Submit(new StreamDMXRequest(universe, data, priority));
+  return true;
+}
+
+Future<AsyncDMXResult> AsyncClient::FetchDMX(unsigned int universe) {
+  Future<AsyncDMXResult> future;
+  Submit(new FetchDMXRequest(universe, future));
+  return future;
+}
+
+Future<AsyncRDMResult> AsyncClient::RDMGet(unsigned int universe,
+                                           const UID &uid,
+                                           uint16_t sub_device,
+                                           uint16_t pid,
+                                           const uint8_t *data,
+                                           unsigned int data_length) {
+  Future<AsyncRDMResult> future;
+  Submit(new RDMRequest(false, universe, uid, sub_device, pid, data,
+                        data_length, future));
+  return future;
+}
+
+Future<AsyncRDMResult> AsyncClient::RDMSet(unsigned int universe,
+                                           const UID &uid,
+                                           uint16_t sub_device,
+                                           uint16_t pid,
+                                           const uint8_t *data,
+                                           unsigned int data_length) {
+  Future<AsyncRDMResult> future;
+  Submit(new RDMRequest(true, universe, uid, sub_device, pid, data,
+                        data_length, future));
+  return future;
+}
+
+void AsyncClient::RequestComplete(Request *request) {
+  m_outstanding.erase(request);
+  delete request;
+}
+
+void *AsyncClient::Run() {
+  m_ss->Run();
+  return NULL;
+}
+
+/*
+ * Pass a request to the client thread. This can be called from any thread.
+ */
+void AsyncClient::Submit(Request *request) {
+  if (!m_running) {
+    if (request) {
+      request->Fail("The client isn't running");
+      delete request;
+    }
+    return;
+  }
+
+  m_queue.Push(request);
+  // Only the first request since the client thread last woke up needs to
+  // wake it.
+  if (!__atomic_exchange_n(&m_wake_up_pending, true, __ATOMIC_SEQ_CST)) {
+    uint8_t wake_up = 'a';
+    m_wake_up.Send(&wake_up, sizeof(wake_up));
+  }
+}
+
+/*
+ * Called in the client thread to send the queued requests.
+ */
+void AsyncClient::ProcessQueue() {
+  while (m_wake_up.DataRemaining()) {
+    uint8_t message[100];
+    unsigned int size;
+    m_wake_up.Receive(message, sizeof(message), size);
+  }
+  // Clear the flag before checking the queue, so a request pushed after this
+  // point wakes us again.
+  __atomic_store_n(&m_wake_up_pending, false, __ATOMIC_SEQ_CST);
+
+  Request *request;
+  while (m_queue.Pop(&request)) {
+    if (!request) {
+      m_ss->Terminate();
+      continue;
+    }
+    m_outstanding.insert(request);
+    request->Send(this, m_client.get());
+  }
+}
+
+/*
+ * Fail all requests that are queued or outstanding. Only called once the
+ * client thread has stopped.
+ */
+void AsyncClient::FailAll(const string &error) {
+  Request *request;
+  while (m_queue.Pop(&request)) {
+    if (request) {
+      m_outstanding.insert(request);
+    }
+  }
+
+  std::set<Request*>::iterator iter = m_outstanding.begin();
+  for (; iter != m_outstanding.end(); ++iter) {
+    (*iter)->Fail(error);
+    delete *iter;
+  }
+  m_outstanding.clear();
+}
+}  // namespace client
+}  // namespace ola
@@ -129,5 +129,54 @@ OlaUniverse ClientTypesFactory::UniverseFromProtobuf(
                      universe_info.rdm_devices());
 }
 
+UniverseStats ClientTypesFactory::UniverseStatsFromProtobuf(
+    const ola::proto::UniverseStats &universe_stats) {
+  UniverseStats stats;
+  stats.universe = universe_stats.universe();
+  stats.input_frames = universe_stats.input_frames();
+  stats.output_frames = universe_stats.output_frames();
+  stats.changed_slots = universe_stats.changed_slots();
+  stats.last_changed_slots = universe_stats.last_changed_slots();
+  stats.source_count = universe_stats.source_count();
+  stats.active_sources = universe_stats.active_sources();
+  stats.merge_time_us = universe_stats.merge_time_us();
+  stats.has_input = universe_stats.has_ms_since_input();
+  stats.ms_since_input = universe_stats.ms_since_input();
+  stats.has_output = universe_stats.has_ms_since_output();
+  stats.ms_since_output = universe_stats.ms_since_output();
+  return stats;
+}
+
+DiscoveredService ClientTypesFactory::DiscoveredServiceFromProtobuf(
+    const ola::proto::DiscoveredService &service_pb) {
+  DiscoveredService service;
+  service.name = service_pb.name();
+  service.type = service_pb.type();
+  service.domain = service_pb.domain();
+  service.host = service_pb.host();
+  if (service_pb.has_ip_address()) {
+    service.address = ola::network::IPV4Address(service_pb.ip_address());
+  }
+  service.port = service_pb.port();
+  service.if_index = service_pb.if_index();
+  for (int i = 0; i < service_pb.txt_size(); ++i) {
+    service.txt_data[service_pb.txt(i).key()] = service_pb.txt(i).value();
+  }
+  return service;
+}
+
+RDMPolledValue ClientTypesFactory::RDMPolledValueFromProtobuf(
+    const ola::proto::RDMPolledValue &value_pb) {
+  RDMPolledValue value;
+  value.uid = ola::rdm::UID(value_pb.uid().esta_id(),
+                            value_pb.uid().device_id());
+  value.sub_device = value_pb.sub_device();
+  value.param_id = value_pb.param_id();
+  value.has_index = value_pb.has_index();
+  value.index = value_pb.index();
+  value.data = value_pb.data();
+  return value;
+}
+
 }  // namespace client
 }  // namespace ola
@@ -43,6 +43,12 @@ class ClientTypesFactory {
       const ola::proto::DeviceInfo &device_info);
   static OlaUniverse UniverseFromProtobuf(
       const ola::proto::UniverseInfo &universe_info);
+  static UniverseStats UniverseStatsFromProtobuf(
+      const ola::proto::UniverseStats &universe_stats);
+  static DiscoveredService DiscoveredServiceFromProtobuf(
+      const ola::proto::DiscoveredService &service_pb);
+  static RDMPolledValue RDMPolledValueFromProtobuf(
+      const ola::proto::RDMPolledValue &value_pb);
 };
 
 }  // namespace client
@@ -16,6 +16,7 @@ pkginclude_HEADERS += \
 ##################################################
 lib_LTLIBRARIES += ola/libola.la
 ola_libola_la_SOURCES = \
+    ola/AsyncClient.cpp \
     ola/AutoStart.cpp \
     ola/ClientRDMAPIShim.cpp \
     ola/ClientTypesFactory.h \
@@ -26,7 +27,11 @@ ola_libola_la_SOURCES = \
     ola/OlaClientCore.h \
     ola/OlaClientCore.cpp \
     ola/OlaClientWrapper.cpp \
-    ola/StreamingClient.cpp
+    ola/SharedDmxClient.cpp \
+    ola/SharedDmxClient.h \
+    ola/StreamingClient.cpp \
+    ola/UDPStreamSender.cpp \
+    ola/UDPStreamSender.h
 ola_libola_la_CXXFLAGS = $(COMMON_PROTOBUF_CXXFLAGS)
 ola_libola_la_LDFLAGS = -version-info 1:1:0
 ola_libola_la_LIBADD = common/libolacommon.la
@@ -58,6 +58,10 @@ bool OlaCallbackClient::Stop() {
   return m_core->Stop();
 }
 
+bool OlaCallbackClient::Reconnect(ConnectedDescriptor *descriptor) {
+  return m_core->Reconnect(descriptor);
+}
+
 void OlaCallbackClient::SetCloseHandler(
     ola::SingleUseCallback0<void> *callback) {
   m_core->SetCloseHandler(callback);
@@ -82,6 +82,7 @@ class OlaCallbackClient: public ola::rdm::RDMAPIImplInterface {
 
     bool Setup();
     bool Stop();
+    bool Reconnect(ola::io::ConnectedDescriptor *descriptor);
 
     void SetCloseHandler(ola::SingleUseCallback0<void> *callback);
 
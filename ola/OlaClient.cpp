@@ -54,6 +54,10 @@ bool OlaClient::Stop() {
   return m_core->Stop();
 }
 
+bool OlaClient::Reconnect(ConnectedDescriptor *descriptor) {
+  return m_core->Reconnect(descriptor);
+}
+
 void OlaClient::SetCloseHandler(ola::SingleUseCallback0<void> *callback) {
   m_core->SetCloseHandler(callback);
 }
@@ -62,6 +66,15 @@ void OlaClient::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_core->SetDMXCallback(callback);
 }
 
+void OlaClient::SetDMXViewCallback(RepeatableDMXViewCallback *callback) {
+  m_core->SetDMXViewCallback(callback);
+}
+
+void OlaClient::SetRDMPolledValuesCallback(
+    RepeatableRDMPolledValuesCallback *callback) {
+  m_core->SetRDMPolledValuesCallback(callback);
+}
+
 void OlaClient::ReloadPlugins(SetCallback *callback) {
   m_core->ReloadPlugins(callback);
 }
@@ -131,6 +144,15 @@ void OlaClient::FetchUniverseInfo(unsigned int universe,
   m_core->FetchUniverseInfo(universe, callback);
 }
 
+void OlaClient::FetchUniverseStats(UniverseStatsCallback *callback) {
+  m_core->FetchUniverseStats(callback);
+}
+
+void OlaClient::FetchDiscoveredServices(const string &type,
+                                        DiscoveredServicesCallback *callback) {
+  m_core->FetchDiscoveredServices(type, callback);
+}
+
 void OlaClient::SetUniverseName(unsigned int universe,
                                 const string &name,
                                 SetCallback *callback) {
@@ -152,12 +174,39 @@ void OlaClient::Patch(unsigned int device_alias,
   m_core->Patch(device_alias, port, port_direction, action, universe, callback);
 }
 
+void OlaClient::ConfigureBatch(const ConfigBatch &batch,
+                               SetCallback *callback) {
+  m_core->ConfigureBatch(batch, callback);
+}
+
+void OlaClient::ConfigureVirtualUniverses(const VirtualUniverseBatch &batch,
+                                          SetCallback *callback) {
+  m_core->ConfigureVirtualUniverses(batch, callback);
+}
+
+void OlaClient::StartFade(unsigned int universe,
+                          const DmxBuffer &data,
+                          const FadeArgs &args) {
+  m_core->StartFade(universe, data, args);
+}
+
+void OlaClient::ReleaseFade(unsigned int universe, SetCallback *callback) {
+  m_core->ReleaseFade(universe, callback);
+}
+
 void OlaClient::RegisterUniverse(unsigned int universe,
                                  RegisterAction register_action,
                                  SetCallback *callback) {
   m_core->RegisterUniverse(universe, register_action, callback);
 }
 
+void OlaClient::RegisterUniverse(unsigned int universe,
+                                 RegisterAction register_action,
+                                 const RegisterArgs &args,
+                                 SetCallback *callback) {
+  m_core->RegisterUniverse(universe, register_action, args, callback);
+}
+
 void OlaClient::SendDMX(unsigned int universe,
                         const DmxBuffer &data,
                         const SendDMXArgs &args) {
@@ -168,6 +217,42 @@ void OlaClient::FetchDMX(unsigned int universe, DMXCallback *callback) {
   m_core->FetchDMX(universe, callback);
 }
 
+void OlaClient::RegisterForRDMPolledValues(unsigned int universe,
+                                           RegisterAction register_action,
+                                           SetCallback *callback) {
+  m_core->RegisterForRDMPolledValues(universe, register_action, callback);
+}
+
+void OlaClient::FetchRDMPolledValues(unsigned int universe,
+                                     RDMPolledValuesCallback *callback) {
+  m_core->FetchRDMPolledValues(universe, callback);
+}
+
+void OlaClient::FetchRDMResponderStats(unsigned int universe,
+                                       RDMResponderStatsCallback *callback) {
+  m_core->FetchRDMResponderStats(universe, callback);
+}
+
+void OlaClient::FetchFrameHistory(unsigned int universe,
+                                  unsigned int max_age_ms,
+                                  unsigned int max_frames,
+                                  FrameHistoryCallback *callback) {
+  m_core->FetchFrameHistory(universe, max_age_ms, max_frames, callback);
+}
+
+bool OlaClient::EnableSharedMemory(uint16_t server_port) {
+  return m_core->EnableSharedMemory(server_port);
+}
+
+bool OlaClient::ReadSharedDMX(unsigned int universe, DmxBuffer *data) {
+  return m_core->ReadSharedDMX(universe, data);
+}
+
+bool OlaClient::ReadSharedDMX(unsigned int universe,
+                              RepeatableDMXViewCallback *callback) {
+  return m_core->ReadSharedDMX(universe, callback);
+}
+
 void OlaClient::RunDiscovery(unsigned int universe,
                              DiscoveryType discovery_type,
                              DiscoveryCallback *callback) {
@@ -184,6 +269,19 @@ void OlaClient::SendTimeCode(const ola::timecode::TimeCode &timecode,
   m_core->SendTimeCode(timecode, callback);
 }
 
+void OlaClient::StartTimeCodeGenerator(const ola::timecode::TimeCode &start,
+                                       SetCallback *callback) {
+  m_core->StartTimeCodeGenerator(start, callback);
+}
+
+void OlaClient::ChaseTimeCode(SetCallback *callback) {
+  m_core->ChaseTimeCode(callback);
+}
+
+void OlaClient::StopTimeCodeGenerator(SetCallback *callback) {
+  m_core->StopTimeCodeGenerator(callback);
+}
+
 void OlaClient::RDMGet(unsigned int universe,
                        const ola::rdm::UID &uid,
                        uint16_t sub_device,
@@ -24,7 +24,9 @@
 #include <sys/types.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -39,6 +41,7 @@
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/RDMFrame.h"
+#include "ola/stl/STLUtils.h"
 
 namespace ola {
 namespace client {
@@ -57,6 +60,7 @@ const char OlaClientCore::NOT_CONNECTED_ERROR[] = "Not connected";
 
 OlaClientCore::OlaClientCore(ConnectedDescriptor *descriptor)
     : m_descriptor(descriptor),
+      m_shared_memory_port(0),
       m_connected(false) {
 }
 
@@ -103,10 +107,60 @@ bool OlaClientCore::Stop() {
     m_channel.reset();
     m_stub.reset();
   }
+  m_shared_dmx.reset();
+  m_shared_memory_port = 0;
+  m_received_frames.clear();
+  m_registered_universes.clear();
+  m_sent_frames.clear();
   m_connected = false;
   return 0;
 }
 
+/*
+ * Reconnect using a new descriptor. The old descriptor was closed by olad.
+ */
+bool OlaClientCore::Reconnect(ConnectedDescriptor *descriptor) {
+  m_channel.reset();
+  m_stub.reset();
+  m_shared_dmx.reset();
+  m_received_frames.clear();
+  m_connected = false;
+  m_descriptor = descriptor;
+
+  if (!Setup()) {
+    return false;
+  }
+
+  if (m_shared_memory_port && !EnableSharedMemory(m_shared_memory_port)) {
+    OLA_INFO << "Shared memory isn't available after reconnecting";
+  }
+
+  std::map<unsigned int, RegisterArgs>::const_iterator register_iter =
+      m_registered_universes.begin();
+  for (; register_iter != m_registered_universes.end(); ++register_iter) {
+    RegisterUniverse(register_iter->first, REGISTER, register_iter->second,
+                     NULL);
+  }
+  std::set<unsigned int>::const_iterator universe_iter =
+      m_rdm_poll_universes.begin();
+  for (; universe_iter != m_rdm_poll_universes.end(); ++universe_iter) {
+    RegisterForRDMPolledValues(*universe_iter, REGISTER, NULL);
+  }
+
+  std::map<unsigned int, SentFrame>::const_iterator frame_iter =
+      m_sent_frames.begin();
+  for (; frame_iter != m_sent_frames.end(); ++frame_iter) {
+    ola::proto::DmxData request;
+    request.set_universe(frame_iter->first);
+    request.set_data(frame_iter->second.data.Get());
+    request.set_priority(frame_iter->second.priority);
+    m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+  }
+  OLA_INFO << "Reconnected, restored " << m_registered_universes.size()
+           << " registrations and " << m_sent_frames.size() << " frames";
+  return true;
+}
+
 /**
  * Set the close handler.
  */
@@ -123,6 +177,15 @@ void OlaClientCore::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_dmx_callback.reset(callback);
 }
 
+void OlaClientCore::SetDMXViewCallback(RepeatableDMXViewCallback *callback) {
+  m_dmx_view_callback.reset(callback);
+}
+
+void OlaClientCore::SetRDMPolledValuesCallback(
+    RepeatableRDMPolledValuesCallback *callback) {
+  m_rdm_poll_callback.reset(callback);
+}
+
 void OlaClientCore::ReloadPlugins(SetCallback *callback) {
   ola::proto::PluginReloadRequest request;
   RpcController *controller = new RpcController();
@@ -365,6 +428,45 @@ void OlaClientCore::FetchUniverseInfo(unsigned int universe_id,
   }
 }
 
+void OlaClientCore::FetchUniverseStats(UniverseStatsCallback *callback) {
+  RpcController *controller = new RpcController();
+  ola::proto::OptionalUniverseRequest request;
+  ola::proto::UniverseStatsReply *reply = new ola::proto::UniverseStatsReply();
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleUniverseStats,
+        controller, reply, callback);
+    m_stub->GetUniverseStats(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleUniverseStats(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::FetchDiscoveredServices(
+    const string &type,
+    DiscoveredServicesCallback *callback) {
+  RpcController *controller = new RpcController();
+  ola::proto::DiscoveredServicesRequest request;
+  ola::proto::DiscoveredServicesReply *reply =
+      new ola::proto::DiscoveredServicesReply();
+
+  request.set_type(type);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleDiscoveredServices,
+        controller, reply, callback);
+    m_stub->GetDiscoveredServices(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleDiscoveredServices(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::SetUniverseName(unsigned int universe,
                                     const string &name,
                                     SetCallback *callback) {
@@ -441,9 +543,181 @@ void OlaClientCore::Patch(unsigned int device_alias,
   }
 }
 
+void OlaClientCore::ConfigureBatch(const ConfigBatch &batch,
+                                   SetCallback *callback) {
+  ola::proto::ConfigBatchRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  vector<ConfigBatch::PortPatch>::const_iterator patch_iter =
+      batch.patches.begin();
+  for (; patch_iter != batch.patches.end(); ++patch_iter) {
+    ola::proto::PatchPortRequest *patch = request.add_patch();
+    patch->set_universe(patch_iter->universe);
+    patch->set_device_alias(patch_iter->device_alias);
+    patch->set_port_id(patch_iter->port);
+    patch->set_is_output(patch_iter->port_direction == OUTPUT_PORT);
+    patch->set_action(patch_iter->action == PATCH ? ola::proto::PATCH :
+                      ola::proto::UNPATCH);
+  }
+
+  vector<ConfigBatch::PortPriority>::const_iterator priority_iter =
+      batch.priorities.begin();
+  for (; priority_iter != batch.priorities.end(); ++priority_iter) {
+    ola::proto::PortPriorityRequest *priority = request.add_priority();
+    priority->set_device_alias(priority_iter->device_alias);
+    priority->set_port_id(priority_iter->port);
+    priority->set_is_output(priority_iter->port_direction == OUTPUT_PORT);
+    if (priority_iter->inherit) {
+      priority->set_priority_mode(ola::PRIORITY_MODE_INHERIT);
+    } else {
+      priority->set_priority_mode(ola::PRIORITY_MODE_STATIC);
+      priority->set_priority(priority_iter->value);
+    }
+  }
+
+  vector<ConfigBatch::UniverseMergeMode>::const_iterator mode_iter =
+      batch.merge_modes.begin();
+  for (; mode_iter != batch.merge_modes.end(); ++mode_iter) {
+    ola::proto::MergeModeRequest *merge_mode = request.add_merge_mode();
+    merge_mode->set_universe(mode_iter->universe);
+    merge_mode->set_merge_mode(mode_iter->mode == OlaUniverse::MERGE_HTP ?
+                               ola::proto::HTP : ola::proto::LTP);
+  }
+
+  vector<ConfigBatch::UniverseName>::const_iterator name_iter =
+      batch.names.begin();
+  for (; name_iter != batch.names.end(); ++name_iter) {
+    ola::proto::UniverseNameRequest *name = request.add_name();
+    name->set_universe(name_iter->universe);
+    name->set_name(name_iter->name);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->ConfigureBatch(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::ConfigureVirtualUniverses(
+    const VirtualUniverseBatch &batch,
+    SetCallback *callback) {
+  ola::proto::VirtualUniverseRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  vector<VirtualUniverseBatch::VirtualUniverse>::const_iterator iter =
+      batch.universes.begin();
+  for (; iter != batch.universes.end(); ++iter) {
+    ola::proto::VirtualUniverse *universe = request.add_universe();
+    universe->set_universe(iter->universe);
+    universe->set_priority(iter->priority);
+    vector<VirtualUniverseBatch::Mapping>::const_iterator mapping_iter =
+        iter->mappings.begin();
+    for (; mapping_iter != iter->mappings.end(); ++mapping_iter) {
+      ola::proto::VirtualUniverseMapping *mapping = universe->add_mapping();
+      mapping->set_source_universe(mapping_iter->source_universe);
+      mapping->set_source_offset(mapping_iter->source_offset);
+      mapping->set_offset(mapping_iter->offset);
+      mapping->set_length(mapping_iter->length);
+    }
+  }
+
+  vector<unsigned int>::const_iterator removal_iter = batch.removals.begin();
+  for (; removal_iter != batch.removals.end(); ++removal_iter) {
+    request.add_remove(*removal_iter);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->ConfigureVirtualUniverses(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::StartFade(unsigned int universe,
+                              const DmxBuffer &data,
+                              const FadeArgs &args) {
+  ola::proto::FadeRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  request.set_universe(universe);
+  request.set_data(data.Get());
+  request.set_duration(args.duration);
+  request.set_priority(args.priority);
+  switch (args.curve) {
+    case FADE_EASE_IN:
+      request.set_curve(ola::proto::FADE_EASE_IN);
+      break;
+    case FADE_EASE_OUT:
+      request.set_curve(ola::proto::FADE_EASE_OUT);
+      break;
+    case FADE_EASE_IN_OUT:
+      request.set_curve(ola::proto::FADE_EASE_IN_OUT);
+      break;
+    case FADE_LINEAR:
+    default:
+      request.set_curve(ola::proto::FADE_LINEAR);
+  }
+  vector<unsigned int>::const_iterator iter = args.fine_channels.begin();
+  for (; iter != args.fine_channels.end(); ++iter) {
+    request.add_fine_channel(*iter);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, args.callback);
+    m_stub->StartFade(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, args.callback);
+  }
+}
+
+void OlaClientCore::ReleaseFade(unsigned int universe,
+                                SetCallback *callback) {
+  ola::proto::UniverseRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  request.set_universe(universe);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->ReleaseFade(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::RegisterUniverse(unsigned int universe,
                                      RegisterAction register_action,
                                      SetCallback *callback) {
+  RegisterUniverse(universe, register_action, RegisterArgs(), callback);
+}
+
+void OlaClientCore::RegisterUniverse(unsigned int universe,
+                                     RegisterAction register_action,
+                                     const RegisterArgs &args,
+                                     SetCallback *callback) {
   ola::proto::RegisterDmxRequest request;
   RpcController *controller = new RpcController();
   ola::proto::Ack *reply = new ola::proto::Ack();
@@ -453,6 +727,25 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
         ola::proto::UNREGISTER);
   request.set_universe(universe);
   request.set_action(action);
+  request.set_accept_delta(true);
+  if (args.slot_offset) {
+    request.set_slot_offset(args.slot_offset);
+  }
+  if (args.slot_count) {
+    request.set_slot_count(args.slot_count);
+  }
+  if (args.max_rate) {
+    request.set_max_rate(args.max_rate);
+  }
+  if (args.changes_only) {
+    request.set_changes_only(true);
+  }
+
+  if (register_action == REGISTER) {
+    m_registered_universes[universe] = args;
+  } else {
+    m_registered_universes.erase(universe);
+  }
 
   if (m_connected) {
     CompletionCallback *cb = ola::NewSingleCallback(
@@ -469,6 +762,15 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
 void OlaClientCore::SendDMX(unsigned int universe,
                             const DmxBuffer &data,
                             const SendDMXArgs &args) {
+  SentFrame &frame = m_sent_frames[universe];
+  frame.priority = args.priority;
+  frame.data = data;
+
+  if (!args.callback && m_connected && m_shared_dmx.get() &&
+      m_shared_dmx->SendDMX(universe, args.priority, data)) {
+    return;
+  }
+
   ola::proto::DmxData request;
   request.set_universe(universe);
   request.set_data(data.Get());
@@ -515,6 +817,136 @@ void OlaClientCore::FetchDMX(unsigned int universe,
   }
 }
 
+void OlaClientCore::RegisterForRDMPolledValues(unsigned int universe,
+                                               RegisterAction register_action,
+                                               SetCallback *callback) {
+  ola::proto::RegisterDmxRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  request.set_universe(universe);
+  request.set_action(register_action == REGISTER ? ola::proto::REGISTER :
+                     ola::proto::UNREGISTER);
+
+  if (register_action == REGISTER) {
+    m_rdm_poll_universes.insert(universe);
+  } else {
+    m_rdm_poll_universes.erase(universe);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->RegisterForRDMPolledValues(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::FetchRDMPolledValues(unsigned int universe,
+                                         RDMPolledValuesCallback *callback) {
+  ola::proto::UniverseRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::RDMPolledValues *reply = new ola::proto::RDMPolledValues();
+
+  request.set_universe(universe);
+
+  if (m_connected) {
+    CompletionCallback *cb = NewSingleCallback(
+        this,
+        &OlaClientCore::HandleRDMPolledValues,
+        controller, reply, callback);
+    m_stub->GetRDMPolledValues(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleRDMPolledValues(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::FetchRDMResponderStats(
+    unsigned int universe,
+    RDMResponderStatsCallback *callback) {
+  ola::proto::UniverseRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::RDMResponderStatsReply *reply =
+      new ola::proto::RDMResponderStatsReply();
+
+  request.set_universe(universe);
+
+  if (m_connected) {
+    CompletionCallback *cb = NewSingleCallback(
+        this,
+        &OlaClientCore::HandleRDMResponderStats,
+        controller, reply, callback);
+    m_stub->GetRDMResponderStats(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleRDMResponderStats(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::FetchFrameHistory(unsigned int universe,
+                                      unsigned int max_age_ms,
+                                      unsigned int max_frames,
+                                      FrameHistoryCallback *callback) {
+  ola::proto::FrameHistoryRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::FrameHistoryReply *reply = new ola::proto::FrameHistoryReply();
+
+  request.set_universe(universe);
+  request.set_max_age_ms(max_age_ms);
+  request.set_max_frames(max_frames);
+
+  if (m_connected) {
+    CompletionCallback *cb = NewSingleCallback(
+        this,
+        &OlaClientCore::HandleFrameHistory,
+        controller, reply, callback);
+    m_stub->GetFrameHistory(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleFrameHistory(controller, reply, callback);
+  }
+}
+
+bool OlaClientCore::EnableSharedMemory(uint16_t server_port) {
+  m_shared_memory_port = server_port;
+  m_shared_dmx.reset(new SharedDmxClient(server_port));
+  if (!m_shared_dmx->Init()) {
+    m_shared_dmx.reset();
+    return false;
+  }
+  return true;
+}
+
+bool OlaClientCore::ReadSharedDMX(unsigned int universe, DmxBuffer *data) {
+  uint8_t priority;
+  return m_shared_dmx.get() && m_shared_dmx->ReadDMX(universe, data,
+                                                     &priority);
+}
+
+bool OlaClientCore::ReadSharedDMX(unsigned int universe,
+                                  RepeatableDMXViewCallback *callback) {
+  // The region is guarded by a seqlock, so the data has to be copied out
+  // before it can be used. Copy it onto the stack rather than the heap.
+  ola::dmx::SharedDmxRegion::Frame frame;
+  if (!m_shared_dmx.get() || !m_shared_dmx->ReadDMX(universe, &frame)) {
+    return false;
+  }
+
+  DMXFrameView view;
+  view.data = frame.data;
+  view.length = frame.length;
+  view.universe = universe;
+  view.priority = frame.priority;
+  view.sequence = frame.sequence;
+  callback->Run(view);
+  return true;
+}
+
 void OlaClientCore::RunDiscovery(unsigned int universe,
                                  DiscoveryType discovery_type,
                                  DiscoveryCallback *callback) {
@@ -621,20 +1053,100 @@ void OlaClientCore::SendTimeCode(const ola::timecode::TimeCode &timecode,
   }
 }
 
-void OlaClientCore::UpdateDmxData(ola::rpc::RpcController*,
+void OlaClientCore::StartTimeCodeGenerator(
+    const ola::timecode::TimeCode &start,
+    SetCallback *callback) {
+  if (!start.IsValid()) {
+    Result result("Invalid timecode");
+    OLA_WARN << "Invalid timecode: " << start;
+    if (callback) {
+      callback->Run(result);
+    }
+    return;
+  }
+
+  ola::proto::TimeCodeGeneratorRequest request;
+  request.set_mode(ola::proto::GENERATOR_RUN);
+  ola::proto::TimeCode *timecode = request.mutable_start();
+  timecode->set_type(static_cast<ola::proto::TimeCodeType>(start.Type()));
+  timecode->set_hours(start.Hours());
+  timecode->set_minutes(start.Minutes());
+  timecode->set_seconds(start.Seconds());
+  timecode->set_frames(start.Frames());
+  ControlTimeCodeGenerator(request, callback);
+}
+
+void OlaClientCore::ChaseTimeCode(SetCallback *callback) {
+  ola::proto::TimeCodeGeneratorRequest request;
+  request.set_mode(ola::proto::GENERATOR_CHASE);
+  ControlTimeCodeGenerator(request, callback);
+}
+
+void OlaClientCore::StopTimeCodeGenerator(SetCallback *callback) {
+  ola::proto::TimeCodeGeneratorRequest request;
+  request.set_mode(ola::proto::GENERATOR_STOP);
+  ControlTimeCodeGenerator(request, callback);
+}
+
+void OlaClientCore::UpdateDmxData(ola::rpc::RpcController *controller,
                                   const ola::proto::DmxData *request,
                                   ola::proto::Ack*,
                                   CompletionCallback *done) {
+  ReceivedFrame *frame;
+  if (request->has_delta()) {
+    frame = STLFind(&m_received_frames, request->universe());
+    const string &delta = request->delta();
+    // Failing the request causes the server to send the next frame in full.
+    if (!frame ||
+        !m_encoder.DecodeDelta(
+            frame->data, reinterpret_cast<const uint8_t*>(delta.data()),
+            delta.size(), &frame->data)) {
+      m_received_frames.erase(request->universe());
+      controller->SetFailed("Missing base frame");
+      done->Run();
+      return;
+    }
+  } else {
+    frame = &m_received_frames[request->universe()];
+    frame->data.Set(request->data());
+  }
+  frame->sequence++;
+
+  uint8_t priority = 0;
+  if (request->has_priority()) {
+    priority = request->priority();
+  }
+
+  if (m_dmx_view_callback.get()) {
+    DMXFrameView view;
+    view.data = frame->data.GetRaw();
+    view.length = frame->data.Size();
+    view.universe = request->universe();
+    view.priority = priority;
+    view.sequence = frame->sequence;
+    m_dmx_view_callback->Run(view);
+  }
+
   if (m_dmx_callback.get()) {
-    DmxBuffer buffer;
-    buffer.Set(request->data());
+    DMXMetadata metadata(request->universe(), priority);
+    m_dmx_callback->Run(metadata, frame->data);
+  }
+  done->Run();
+}
 
-    uint8_t priority = 0;
-    if (request->has_priority()) {
-      priority = request->priority();
+void OlaClientCore::UpdateRDMPolledValues(
+    ola::rpc::RpcController*,
+    const ola::proto::RDMPolledValues *request,
+    ola::proto::Ack*,
+    CompletionCallback *done) {
+  if (m_rdm_poll_callback.get()) {
+    vector<RDMPolledValue> values;
+    values.reserve(request->value_size());
+    for (int i = 0; i < request->value_size(); ++i) {
+      values.push_back(
+          ClientTypesFactory::RDMPolledValueFromProtobuf(request->value(i)));
     }
-    DMXMetadata metadata(request->universe(), priority);
-    m_dmx_callback->Run(metadata, buffer);
+    m_rdm_poll_callback->Run(request->universe(), values);
   }
   done->Run();
 }
@@ -792,6 +1304,24 @@ void OlaClientCore::HandleAck(RpcController *controller_ptr,
   callback->Run(result);
 }
 
+void OlaClientCore::ControlTimeCodeGenerator(
+    const ola::proto::TimeCodeGeneratorRequest &request,
+    SetCallback *callback) {
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->ControlTimeCodeGenerator(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::HandleGeneralAck(RpcController *controller_ptr,
                                      ola::proto::Ack *reply_ptr,
                                      GeneralSetCallback *callback) {
@@ -864,6 +1394,55 @@ void OlaClientCore::HandleUniverseInfo(RpcController *controller_ptr,
   callback->Run(result, null_universe);
 }
 
+void OlaClientCore::HandleUniverseStats(
+    RpcController *controller_ptr,
+    ola::proto::UniverseStatsReply *reply_ptr,
+    UniverseStatsCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::UniverseStatsReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<UniverseStats> stats;
+
+  if (!controller->Failed()) {
+    stats.reserve(reply->universe_size());
+    for (int i = 0; i < reply->universe_size(); ++i) {
+      stats.push_back(
+          ClientTypesFactory::UniverseStatsFromProtobuf(reply->universe(i)));
+    }
+  }
+  callback->Run(result, stats);
+}
+
+void OlaClientCore::HandleDiscoveredServices(
+    RpcController *controller_ptr,
+    ola::proto::DiscoveredServicesReply *reply_ptr,
+    DiscoveredServicesCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::DiscoveredServicesReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<DiscoveredService> services;
+
+  if (!controller->Failed()) {
+    services.reserve(reply->service_size());
+    for (int i = 0; i < reply->service_size(); ++i) {
+      services.push_back(
+          ClientTypesFactory::DiscoveredServiceFromProtobuf(
+              reply->service(i)));
+    }
+  }
+  callback->Run(result, services);
+}
+
 void OlaClientCore::HandleGetDmx(RpcController *controller_ptr,
                                  ola::proto::DmxData *reply_ptr,
                                  DMXCallback *callback) {
@@ -886,6 +1465,102 @@ void OlaClientCore::HandleGetDmx(RpcController *controller_ptr,
   callback->Run(result, metadata, buffer);
 }
 
+void OlaClientCore::HandleRDMPolledValues(
+    RpcController *controller_ptr,
+    ola::proto::RDMPolledValues *reply_ptr,
+    RDMPolledValuesCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::RDMPolledValues> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<RDMPolledValue> values;
+
+  if (!controller->Failed()) {
+    values.reserve(reply->value_size());
+    for (int i = 0; i < reply->value_size(); ++i) {
+      values.push_back(
+          ClientTypesFactory::RDMPolledValueFromProtobuf(reply->value(i)));
+    }
+  }
+  callback->Run(result, values);
+}
+
+void OlaClientCore::HandleRDMResponderStats(
+    RpcController *controller_ptr,
+    ola::proto::RDMResponderStatsReply *reply_ptr,
+    RDMResponderStatsCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::RDMResponderStatsReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<RDMResponderStats> responders;
+
+  if (!controller->Failed()) {
+    responders.resize(reply->responder_size());
+    for (int i = 0; i < reply->responder_size(); ++i) {
+      const ola::proto::RDMResponderStats &stats_pb = reply->responder(i);
+      RDMResponderStats &stats = responders[i];
+      stats.uid = UID(stats_pb.uid().esta_id(), stats_pb.uid().device_id());
+      stats.requests = stats_pb.requests();
+      stats.acks = stats_pb.acks();
+      stats.ack_timers = stats_pb.ack_timers();
+      stats.nacks = stats_pb.nacks();
+      stats.timeouts = stats_pb.timeouts();
+      stats.failures = stats_pb.failures();
+      stats.consecutive_failures = stats_pb.consecutive_failures();
+      for (int j = 0; j < stats_pb.nack_reason_size(); ++j) {
+        stats.nack_reasons[stats_pb.nack_reason(j).reason()] =
+            stats_pb.nack_reason(j).count();
+      }
+      stats.latency.resize(stats_pb.latency_size());
+      for (int j = 0; j < stats_pb.latency_size(); ++j) {
+        stats.latency[j].limit_ms = stats_pb.latency(j).limit_ms();
+        stats.latency[j].count = stats_pb.latency(j).count();
+      }
+      stats.min_latency_us = stats_pb.min_latency_us();
+      stats.max_latency_us = stats_pb.max_latency_us();
+      stats.mean_latency_us = stats_pb.mean_latency_us();
+    }
+  }
+  callback->Run(result, responders);
+}
+
+void OlaClientCore::HandleFrameHistory(
+    RpcController *controller_ptr,
+    ola::proto::FrameHistoryReply *reply_ptr,
+    FrameHistoryCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::FrameHistoryReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<HistoryFrame> frames;
+
+  if (!controller->Failed()) {
+    frames.resize(reply->frame_size());
+    for (int i = 0; i < reply->frame_size(); ++i) {
+      const ola::proto::HistoryFrame &frame_pb = reply->frame(i);
+      HistoryFrame &frame = frames[i];
+      frame.age_us = frame_pb.age_us();
+      frame.priority = frame_pb.priority();
+      frame.source = frame_pb.source();
+      frame.data.Set(frame_pb.data());
+    }
+  }
+  callback->Run(result, frames);
+}
+
 void OlaClientCore::HandleUIDList(RpcController *controller_ptr,
                                   ola::proto::UIDListReply *reply_ptr,
                                   DiscoveryCallback *callback) {
@@ -937,6 +1612,8 @@ void OlaClientCore::HandleRDM(RpcController *controller_ptr,
       frame.timing.data_time = proto_frame.timing().data_time();
       metadata.frames.push_back(frame);
     }
+    metadata.pid_name = reply->pid_name();
+    metadata.decoded_data = reply->decoded_data();
   }
 
   callback->Run(result, metadata, response);
@@ -1004,6 +1681,9 @@ void OlaClientCore::SendRDMCommand(bool is_set,
   if (args.include_raw_frames) {
     request.set_include_raw_response(true);
   }
+  if (args.decode_response) {
+    request.set_decode_response(true);
+  }
 
   CompletionCallback *cb = NewSingleCallback(
       this,
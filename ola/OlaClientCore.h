@@ -21,7 +21,9 @@
 #ifndef OLA_OLACLIENTCORE_H_
 #define OLA_OLACLIENTCORE_H_
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 
 #include "common/protocol/Ola.pb.h"
@@ -30,10 +32,12 @@
 #include "common/rpc/RpcController.h"
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/SharedDmxClient.h"
 #include "ola/client/CallbackTypes.h"
 #include "ola/client/ClientArgs.h"
 #include "ola/client/ClientTypes.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/RunLengthEncoder.h"
 #include "ola/dmx/SourcePriorities.h"
 #include "ola/io/Descriptor.h"
 #include "ola/plugin_id.h"
@@ -63,6 +67,17 @@ class OlaClientCore: public ola::proto::OlaClientService {
   bool Setup();
   bool Stop();
 
+  /**
+   * @brief Reconnect to olad after the connection was closed.
+   *
+   * The universes registered with RegisterUniverse() are registered again, and
+   * the last frame sent to each universe with SendDMX() is sent again. The
+   * close handler must be set again after this.
+   * @param descriptor the new connection to olad, ownership isn't transferred.
+   * @returns true if the client was setup, false otherwise.
+   */
+  bool Reconnect(ola::io::ConnectedDescriptor *descriptor);
+
   void SetCloseHandler(ClosedCallback *callback);
 
   /**
@@ -74,6 +89,24 @@ class OlaClientCore: public ola::proto::OlaClientService {
    */
   void SetDMXCallback(RepeatableDMXCallback *callback);
 
+  /**
+   * @brief Set the callback to be run with a view of new DMX data.
+   * This is run before the callback set with SetDMXCallback(). The view
+   * points at the client's receive buffer, so no copy is made. Ownership of
+   * the callback is transferred to the OlaClientCore.
+   * @param callback the callback to run upon receiving new DMX data.
+   */
+  void SetDMXViewCallback(RepeatableDMXViewCallback *callback);
+
+  /**
+   * @brief Set the callback to be run when polled RDM values change.
+   * The callback will be run for universes that have been registered with
+   * RegisterForRDMPolledValues(). Ownership of the callback is transferred to
+   * the OlaClientCore.
+   * @param callback the callback to run when the values change.
+   */
+  void SetRDMPolledValuesCallback(RepeatableRDMPolledValuesCallback *callback);
+
   /**
    * @brief Trigger a plugin reload.
    * @param callback the SetCallback to invoke upon completion.
@@ -189,6 +222,26 @@ class OlaClientCore: public ola::proto::OlaClientService {
   void FetchUniverseInfo(unsigned int universe,
                          UniverseInfoCallback *callback);
 
+  /**
+   * @brief Fetch the frame counters for all universes.
+   *
+   * This is cheap for olad to answer, so it can be polled.
+   * @param callback the UniverseStatsCallback to invoke upon completion.
+   */
+  void FetchUniverseStats(UniverseStatsCallback *callback);
+
+  /**
+   * @brief Fetch the DNS-SD services of a type that olad has found.
+   *
+   * olad answers from its cache, so this doesn't wait for the network. The
+   * first request for a type that olad isn't already browsing for (see the
+   * --dns-sd-browse flag) starts browsing and returns no services.
+   * @param type the service type, e.g. _http._tcp
+   * @param callback the DiscoveredServicesCallback to invoke upon completion.
+   */
+  void FetchDiscoveredServices(const std::string &type,
+                               DiscoveredServicesCallback *callback);
+
   /**
    * @brief Set the name of a universe.
    * @param universe the id of the universe
@@ -225,6 +278,50 @@ class OlaClientCore: public ola::proto::OlaClientService {
              unsigned int universe,
              SetCallback *callback);
 
+  /**
+   * @brief Apply a set of patch, priority, merge mode and name changes.
+   *
+   * The changes are applied together, if any of them fail none are applied.
+   * Each universe that changes is merged and sent to its ports once.
+   * @param batch the changes to apply.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ConfigureBatch(const ConfigBatch &batch, SetCallback *callback);
+
+  /**
+   * @brief Set up and remove virtual universes.
+   *
+   * A virtual universe is built in olad from ranges of slots in other
+   * universes. The changes are applied together, if any of them are invalid
+   * none are applied.
+   * @param batch the virtual universes to set up and remove.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ConfigureVirtualUniverses(const VirtualUniverseBatch &batch,
+                                 SetCallback *callback);
+
+  /**
+   * @brief Fade a universe to new data.
+   *
+   * olad renders the steps of the fade at the rate of the universe's output
+   * ports, so there's no need to stream the steps. A new fade starts from the
+   * current point of the last one. Once the fade completes, the data is held
+   * until ReleaseFade() is called.
+   * @param universe the universe to fade.
+   * @param data the DmxBuffer to fade to.
+   * @param args the FadeArgs to use for this call.
+   */
+  void StartFade(unsigned int universe,
+                 const DmxBuffer &data,
+                 const FadeArgs &args);
+
+  /**
+   * @brief Stop fading a universe, and remove the fade's data from it.
+   * @param universe the universe to release.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ReleaseFade(unsigned int universe, SetCallback *callback);
+
   /**
    * @brief Register our interest in a universe. The callback set by
    * SetDMXCallback() will be called when new DMX data arrives.
@@ -236,6 +333,19 @@ class OlaClientCore: public ola::proto::OlaClientService {
                         RegisterAction register_action,
                         SetCallback *callback);
 
+  /**
+   * @brief Register our interest in a universe, limiting the data received.
+   * @param universe the id of the universe to register for.
+   * @param register_action the action (register or unregister)
+   * @param args the RegisterArgs to use, these replace the arguments of
+   *   any earlier registration for the universe.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterUniverse(unsigned int universe,
+                        RegisterAction register_action,
+                        const RegisterArgs &args,
+                        SetCallback *callback);
+
   /**
    * @brief Send DMX data.
    * @param universe the universe to send to.
@@ -253,6 +363,72 @@ class OlaClientCore: public ola::proto::OlaClientService {
    */
   void FetchDMX(unsigned int universe, DMXCallback *callback);
 
+  /**
+   * @brief Register our interest in the sensor & status values olad polls
+   * from the RDM devices on a universe. The callback set by
+   * SetRDMPolledValuesCallback() will be called when the values change.
+   * @param universe the id of the universe to register for.
+   * @param register_action the action (register or unregister)
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterForRDMPolledValues(unsigned int universe,
+                                  RegisterAction register_action,
+                                  SetCallback *callback);
+
+  /**
+   * @brief Fetch the latest sensor & status values olad has polled from the
+   * RDM devices on a universe.
+   * @param universe the universe id to get the values for.
+   * @param callback the RDMPolledValuesCallback to invoke upon completion.
+   */
+  void FetchRDMPolledValues(unsigned int universe,
+                            RDMPolledValuesCallback *callback);
+
+  /**
+   * @brief Fetch the latency & reliability stats olad has recorded for the
+   *   RDM responders on a universe.
+   * @param universe the universe id to get the stats for.
+   * @param callback the RDMResponderStatsCallback to invoke upon completion.
+   */
+  void FetchRDMResponderStats(unsigned int universe,
+                              RDMResponderStatsCallback *callback);
+
+  /**
+   * @brief Fetch the frames olad has recently sent for a universe.
+   * @param universe the universe id to get the frames for.
+   * @param max_age_ms only fetch the frames from the last max_age_ms, 0
+   *   fetches the whole history.
+   * @param max_frames the maximum number of frames to fetch, 0 for no limit.
+   * @param callback the FrameHistoryCallback to invoke upon completion.
+   */
+  void FetchFrameHistory(unsigned int universe,
+                         unsigned int max_age_ms,
+                         unsigned int max_frames,
+                         FrameHistoryCallback *callback);
+
+  /**
+   * @brief Use shared memory to pass DMX data to and from a local olad.
+   * @param server_port the RPC port olad is listening on.
+   * @returns true if shared memory is available.
+   */
+  bool EnableSharedMemory(uint16_t server_port);
+
+  /**
+   * @brief Read the latest DMX data for a universe from shared memory.
+   */
+  bool ReadSharedDMX(unsigned int universe, DmxBuffer *data);
+
+  /**
+   * @brief Read the latest DMX data for a universe from shared memory and
+   * pass a view of it to a callback.
+   * @param universe the universe id to get data for.
+   * @param callback run with the frame before this returns, ownership is not
+   *   transferred.
+   * @returns true if the data was read and the callback run.
+   */
+  bool ReadSharedDMX(unsigned int universe,
+                     RepeatableDMXViewCallback *callback);
+
   /**
    * @brief Trigger discovery for a universe.
    * @param universe the universe id to run discovery on.
@@ -314,6 +490,33 @@ class OlaClientCore: public ola::proto::OlaClientService {
   void SendTimeCode(const ola::timecode::TimeCode &timecode,
                     SetCallback *callback);
 
+  /**
+   * @brief Start the timecode generator in olad.
+   * @param start the first frame to send, this also sets the frame rate.
+   * @param callback the SetCallback to invoke when the request completes.
+   *
+   * olad sends a frame of timecode to the ports at the frame rate until
+   * StopTimeCodeGenerator() is called.
+   */
+  void StartTimeCodeGenerator(const ola::timecode::TimeCode &start,
+                              SetCallback *callback);
+
+  /**
+   * @brief Have the timecode generator in olad chase the timecode sent with
+   *   SendTimeCode().
+   * @param callback the SetCallback to invoke when the request completes.
+   *
+   * olad locks to the timecode it's sent and fills in the frames in between,
+   * so the timecode only needs to be sent occasionally.
+   */
+  void ChaseTimeCode(SetCallback *callback);
+
+  /**
+   * @brief Stop the timecode generator in olad.
+   * @param callback the SetCallback to invoke when the request completes.
+   */
+  void StopTimeCodeGenerator(SetCallback *callback);
+
   /**
    * @brief This is called by the channel when new DMX data arrives.
    */
@@ -322,12 +525,48 @@ class OlaClientCore: public ola::proto::OlaClientService {
                      ola::proto::Ack* response,
                      CompletionCallback* done);
 
+  /**
+   * @brief This is called by the channel when polled RDM values change.
+   */
+  void UpdateRDMPolledValues(ola::rpc::RpcController* controller,
+                             const ola::proto::RDMPolledValues* request,
+                             ola::proto::Ack* response,
+                             CompletionCallback* done);
+
  private:
   ola::io::ConnectedDescriptor *m_descriptor;
   std::auto_ptr<RepeatableDMXCallback> m_dmx_callback;
+  std::auto_ptr<RepeatableDMXViewCallback> m_dmx_view_callback;
+  std::auto_ptr<RepeatableRDMPolledValuesCallback> m_rdm_poll_callback;
   std::auto_ptr<ola::rpc::RpcChannel> m_channel;
   std::auto_ptr<ola::proto::OlaServerService_Stub> m_stub;
+  std::auto_ptr<SharedDmxClient> m_shared_dmx;
+  uint16_t m_shared_memory_port;  // 0 if EnableSharedMemory() wasn't called
   int m_connected;
+  struct ReceivedFrame {
+    DmxBuffer data;
+    uint32_t sequence;
+
+    ReceivedFrame() : sequence(0) {}
+  };
+
+  // The last frame received for each universe, used to decode deltas. Frames
+  // are decoded in place so the buffers are reused.
+  std::map<unsigned int, ReceivedFrame> m_received_frames;
+  ola::dmx::RunLengthEncoder m_encoder;
+
+  class SentFrame {
+   public:
+    SentFrame() : priority(ola::dmx::SOURCE_PRIORITY_DEFAULT) {}
+
+    uint8_t priority;
+    DmxBuffer data;
+  };
+
+  // The state that's restored by Reconnect().
+  std::map<unsigned int, RegisterArgs> m_registered_universes;
+  std::set<unsigned int> m_rdm_poll_universes;
+  std::map<unsigned int, SentFrame> m_sent_frames;
 
   void ChannelClosed(ClosedCallback *callback, ola::rpc::RpcSession *session);
 
@@ -373,6 +612,10 @@ class OlaClientCore: public ola::proto::OlaClientService {
                  ola::proto::Ack *reply,
                  SetCallback *callback);
 
+  void ControlTimeCodeGenerator(
+      const ola::proto::TimeCodeGeneratorRequest &request,
+      SetCallback *callback);
+
   /**
    * @brief Called when a Set* request completes.
    */
@@ -394,6 +637,20 @@ class OlaClientCore: public ola::proto::OlaClientService {
                           ola::proto::UniverseInfoReply *reply,
                           UniverseInfoCallback *callback);
 
+  /**
+   * @brief Called when a GetUniverseStats() request completes.
+   */
+  void HandleUniverseStats(ola::rpc::RpcController *controller,
+                           ola::proto::UniverseStatsReply *reply,
+                           UniverseStatsCallback *callback);
+
+  /**
+   * @brief Called when a GetDiscoveredServices() request completes.
+   */
+  void HandleDiscoveredServices(ola::rpc::RpcController *controller,
+                                ola::proto::DiscoveredServicesReply *reply,
+                                DiscoveredServicesCallback *callback);
+
   /**
    * @brief Called when a GetDmx() request completes.
    */
@@ -401,6 +658,27 @@ class OlaClientCore: public ola::proto::OlaClientService {
                     ola::proto::DmxData *reply,
                     DMXCallback *callback);
 
+  /**
+   * @brief Called when a GetRDMPolledValues() request completes.
+   */
+  void HandleRDMPolledValues(ola::rpc::RpcController *controller,
+                             ola::proto::RDMPolledValues *reply,
+                             RDMPolledValuesCallback *callback);
+
+  /**
+   * @brief Called when a GetRDMResponderStats() request completes.
+   */
+  void HandleRDMResponderStats(ola::rpc::RpcController *controller,
+                               ola::proto::RDMResponderStatsReply *reply,
+                               RDMResponderStatsCallback *callback);
+
+  /**
+   * @brief Called when a GetFrameHistory() request completes.
+   */
+  void HandleFrameHistory(ola::rpc::RpcController *controller,
+                          ola::proto::FrameHistoryReply *reply,
+                          FrameHistoryCallback *callback);
+
   /**
    * @brief Called when a RunDiscovery() request completes.
    */
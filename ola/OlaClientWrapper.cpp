@@ -20,6 +20,9 @@
 
 #include <ola/OlaClientWrapper.h>
 
+#include <algorithm>
+#include <memory>
+
 #include <ola/Constants.h>
 #include <ola/Logging.h>
 #include <ola/network/IPV4Address.h>
@@ -28,8 +31,13 @@
 namespace ola {
 namespace client {
 
+const unsigned int BaseClientWrapper::MIN_RECONNECT_DELAY;
+const unsigned int BaseClientWrapper::MAX_RECONNECT_DELAY;
+
 BaseClientWrapper::BaseClientWrapper()
-  : m_close_callback(NewCallback(&m_ss, &ola::io::SelectServer::Terminate)) {
+  : m_close_callback(NewCallback(&m_ss, &ola::io::SelectServer::Terminate)),
+    m_auto_reconnect(false),
+    m_reconnect_delay(MIN_RECONNECT_DELAY) {
 }
 
 BaseClientWrapper::~BaseClientWrapper() {
@@ -42,7 +50,7 @@ void BaseClientWrapper::SetCloseCallback(CloseCallback *callback) {
 
 bool BaseClientWrapper::Setup() {
   if (!m_socket.get()) {
-    InitSocket();
+    InitSocket(true);
 
     if (!m_socket.get()) {
       return false;
@@ -69,7 +77,52 @@ bool BaseClientWrapper::Cleanup() {
 
 void BaseClientWrapper::SocketClosed() {
   OLA_INFO << "Server closed the connection";
-  m_close_callback->Run();
+  if (m_auto_reconnect) {
+    m_reconnect_delay = MIN_RECONNECT_DELAY;
+    ScheduleReconnect();
+  } else {
+    m_close_callback->Run();
+  }
+}
+
+void BaseClientWrapper::ScheduleReconnect() {
+  OLA_INFO << "Reconnecting to olad in " << m_reconnect_delay << "ms";
+  m_ss.RegisterSingleTimeout(
+      m_reconnect_delay,
+      NewSingleCallback(this, &BaseClientWrapper::Reconnect));
+}
+
+void BaseClientWrapper::Reconnect() {
+  if (!m_socket.get()) {
+    // Cleanup() was called.
+    return;
+  }
+
+  // The client may still refer to the old socket, so keep it until the client
+  // has moved to the new one.
+  std::auto_ptr<ola::network::TCPSocket> old_socket(m_socket.release());
+  if (old_socket->ValidReadDescriptor()) {
+    m_ss.RemoveReadDescriptor(old_socket.get());
+  }
+
+  InitSocket(false);
+  if (m_socket.get() && !m_ss.AddReadDescriptor(m_socket.get())) {
+    m_socket.reset();
+  }
+
+  if (!m_socket.get()) {
+    m_socket.reset(old_socket.release());
+    m_reconnect_delay = std::min(2 * m_reconnect_delay, MAX_RECONNECT_DELAY);
+    ScheduleReconnect();
+    return;
+  }
+
+  if (!ReconnectClient()) {
+    OLA_WARN << "Failed to setup the client after reconnecting";
+    m_close_callback->Run();
+    return;
+  }
+  OLA_INFO << "Reconnected to olad";
 }
 }  // namespace client
 }  // namespace ola
@@ -0,0 +1,172 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxClient.cpp
+ * The client side of the shared memory DMX transport.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <unistd.h>
+
+#include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/SharedDmxClient.h"
+
+namespace ola {
+namespace client {
+
+using ola::dmx::SharedDmxRegion;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
+
+SharedDmxClient::SharedDmxClient(uint16_t server_port)
+    : m_server_port(server_port),
+      m_doorbell_address(IPV4Address::Loopback(), server_port) {
+}
+
+SharedDmxClient::~SharedDmxClient() {
+  Close();
+}
+
+bool SharedDmxClient::Init() {
+  if (m_region.get()) {
+    return false;
+  }
+
+  std::auto_ptr<SharedDmxRegion> region(
+      SharedDmxRegion::Open(SharedDmxRegion::NameForPort(m_server_port)));
+  if (!region.get()) {
+    return false;
+  }
+
+  std::auto_ptr<UDPSocket> socket(new UDPSocket());
+  if (!socket->Init()) {
+    return false;
+  }
+
+  m_region.reset(region.release());
+  m_socket.reset(socket.release());
+  return true;
+}
+
+void SharedDmxClient::Close() {
+  if (m_region.get() && m_region->IsOpen()) {
+    SlotMap::const_iterator iter = m_input_slots.begin();
+    for (; iter != m_input_slots.end(); ++iter) {
+      RingDoorbell(SharedDmxRegion::DOORBELL_INPUT_RELEASED, iter->second);
+    }
+  }
+  m_input_slots.clear();
+  m_output_slots.clear();
+  m_subscriptions.clear();
+  m_socket.reset();
+  m_region.reset();
+}
+
+bool SharedDmxClient::IsOpen() const {
+  return m_region.get() && m_region->IsOpen();
+}
+
+bool SharedDmxClient::SendDMX(unsigned int universe, uint8_t priority,
+                              const DmxBuffer &data) {
+  if (!IsOpen()) {
+    return false;
+  }
+
+  const uint32_t pid = getpid();
+  unsigned int slot;
+  SlotMap::const_iterator iter = m_input_slots.find(universe);
+  if (iter != m_input_slots.end() &&
+      m_region->InputSlotOwner(iter->second) != pid) {
+    // olad has reclaimed the slot
+    m_input_slots.erase(universe);
+    iter = m_input_slots.end();
+  }
+
+  if (iter == m_input_slots.end()) {
+    int new_slot = m_region->ClaimInputSlot(pid);
+    if (new_slot < 0) {
+      OLA_WARN << "No free shared memory slots for universe " << universe;
+      return false;
+    }
+    slot = new_slot;
+    m_input_slots[universe] = slot;
+  } else {
+    slot = iter->second;
+  }
+
+  m_region->WriteInput(slot, universe, priority, data);
+  return RingDoorbell(SharedDmxRegion::DOORBELL_INPUT_UPDATED, slot);
+}
+
+bool SharedDmxClient::ReadDMX(unsigned int universe, DmxBuffer *data,
+                              uint8_t *priority) {
+  SharedDmxRegion::Frame frame;
+  if (!ReadDMX(universe, &frame)) {
+    return false;
+  }
+  data->Set(frame.data, frame.length);
+  *priority = frame.priority;
+  return true;
+}
+
+bool SharedDmxClient::ReadDMX(unsigned int universe,
+                              SharedDmxRegion::Frame *frame) {
+  if (!IsOpen()) {
+    return false;
+  }
+
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  uint32_t seconds = static_cast<uint32_t>(now.Seconds());
+
+  SlotMap::const_iterator iter = m_output_slots.find(universe);
+  if (iter != m_output_slots.end()) {
+    if (m_region->ReadOutput(iter->second, universe, seconds, frame)) {
+      return true;
+    }
+    m_output_slots.erase(universe);
+  }
+
+  // Either this is the first read or olad has moved the universe.
+  int slot = m_region->FindOutputSlot(universe);
+  if (slot >= 0 &&
+      m_region->ReadOutput(slot, universe, seconds, frame)) {
+    m_output_slots[universe] = slot;
+    m_subscriptions.erase(universe);
+    return true;
+  }
+
+  SubscriptionMap::iterator sub_iter = m_subscriptions.find(universe);
+  if (sub_iter == m_subscriptions.end() ||
+      (now - sub_iter->second).InMilliSeconds() >=
+          static_cast<int64_t>(SUBSCRIBE_INTERVAL_MS)) {
+    RingDoorbell(SharedDmxRegion::DOORBELL_SUBSCRIBE, universe);
+    m_subscriptions[universe] = now;
+  }
+  return false;
+}
+
+bool SharedDmxClient::RingDoorbell(uint32_t type, uint32_t value) {
+  SharedDmxRegion::Doorbell doorbell;
+  doorbell.type = type;
+  doorbell.value = value;
+  ssize_t sent = m_socket->SendTo(reinterpret_cast<uint8_t*>(&doorbell),
+                                  sizeof(doorbell), m_doorbell_address);
+  return sent == static_cast<ssize_t>(sizeof(doorbell));
+}
+}  // namespace client
+}  // namespace ola
@@ -0,0 +1,132 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxClient.h
+ * The client side of the shared memory DMX transport.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLA_SHAREDDMXCLIENT_H_
+#define OLA_SHAREDDMXCLIENT_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+
+namespace ola {
+namespace client {
+
+/**
+ * @brief Sends and receives DMX data using the shared memory region published
+ * by a local olad.
+ *
+ * Sending writes the frame into an input slot and then rings olad's doorbell,
+ * which is a small UDP datagram on the loopback interface. Reading copies the
+ * latest frame out of an output slot, without involving olad at all.
+ *
+ * This is used by the StreamingClient and OlaClient classes, control messages
+ * still go over the RPC socket.
+ */
+class SharedDmxClient {
+ public:
+  /**
+   * @brief Create a new SharedDmxClient.
+   * @param server_port the RPC port of the olad instance.
+   */
+  explicit SharedDmxClient(uint16_t server_port);
+
+  /**
+   * @brief Destructor, this calls Close().
+   */
+  ~SharedDmxClient();
+
+  /**
+   * @brief Map the region.
+   * @returns false if olad isn't publishing a region.
+   */
+  bool Init();
+
+  /**
+   * @brief Release any slots held by this client and unmap the region.
+   */
+  void Close();
+
+  /**
+   * @brief Check if the region is still being served by olad.
+   */
+  bool IsOpen() const;
+
+  /**
+   * @brief Send DMX data to olad.
+   * @param universe the universe to send to.
+   * @param priority the priority of the data.
+   * @param data the DMX data.
+   * @returns false if the data couldn't be sent, for instance if all the
+   *   input slots are in use.
+   */
+  bool SendDMX(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+
+  /**
+   * @brief Read the latest DMX data for a universe.
+   * @param universe the universe to read.
+   * @param[out] data the DMX data.
+   * @param[out] priority the priority of the data.
+   * @returns false if the universe isn't available yet.
+   *
+   * The first read of a universe asks olad to start publishing it, so it'll
+   * fail until olad has processed the request. Universes that aren't read
+   * for a while are no longer published.
+   */
+  bool ReadDMX(unsigned int universe, DmxBuffer *data, uint8_t *priority);
+
+  /**
+   * @brief Read the latest DMX data for a universe into a Frame.
+   * @param universe the universe to read.
+   * @param[out] frame the frame to copy the data into.
+   * @returns false if the universe isn't available yet.
+   *
+   * This is the same as the above but doesn't allocate, the frame is usually
+   * on the caller's stack.
+   */
+  bool ReadDMX(unsigned int universe, ola::dmx::SharedDmxRegion::Frame *frame);
+
+ private:
+  typedef std::map<unsigned int, unsigned int> SlotMap;
+  typedef std::map<unsigned int, TimeStamp> SubscriptionMap;
+
+  const uint16_t m_server_port;
+  std::auto_ptr<ola::dmx::SharedDmxRegion> m_region;
+  std::auto_ptr<ola::network::UDPSocket> m_socket;
+  ola::network::IPV4SocketAddress m_doorbell_address;
+  SlotMap m_input_slots;
+  SlotMap m_output_slots;
+  SubscriptionMap m_subscriptions;
+  Clock m_clock;
+
+  bool RingDoorbell(uint32_t type, uint32_t value);
+
+  static const unsigned int SUBSCRIBE_INTERVAL_MS = 1000;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxClient);
+};
+}  // namespace client
+}  // namespace ola
+#endif  // OLA_SHAREDDMXCLIENT_H_
@@ -29,62 +29,370 @@
 #include <ola/network/IPV4Address.h>
 #include <ola/network/SocketAddress.h>
 #include <ola/network/TCPSocket.h>
+#include <ola/network/UnixDomainSocket.h>
+#include <ola/stl/STLUtils.h>
+#include <ola/thread/CallbackThread.h>
+#include <ola/thread/Mutex.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
+#include "ola/SharedDmxClient.h"
+#include "ola/UDPStreamSender.h"
 
 namespace ola {
 namespace client {
 
 using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
 using ola::network::TCPSocket;
+using ola::network::UnixDomainSocket;
 using ola::proto::OlaServerService_Stub;
 using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using ola::thread::MutexLocker;
+using std::vector;
+
+const unsigned int StreamingClient::MIN_RECONNECT_DELAY;
+const unsigned int StreamingClient::MAX_RECONNECT_DELAY;
+
+StreamingClient::QueuedFrame::QueuedFrame(unsigned int universe,
+                                          uint8_t priority,
+                                          const DmxBuffer &buffer)
+    : universe(universe),
+      priority(priority),
+      size(sizeof(data)) {
+  buffer.Get(data, &size);
+}
+
+bool StreamingClient::Sender::SendDmx(unsigned int universe,
+                                      const DmxBuffer &data,
+                                      uint8_t priority) {
+  if (!__atomic_load_n(&m_client->m_io_running, __ATOMIC_ACQUIRE))
+    return false;
+
+  if (!m_queue.Push(QueuedFrame(universe, priority, data)))
+    return false;
+  m_client->WakeUp();
+  return true;
+}
 
 StreamingClient::StreamingClient(bool auto_start)
     : m_auto_start(auto_start),
       m_server_port(OLA_DEFAULT_PORT),
+      m_use_shared_memory(false),
+      m_use_udp(false),
+      m_delta_encoding(false),
+      m_threaded(false),
+      m_sender_queue_size(0),
       m_socket(NULL),
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_shared_dmx(NULL),
+      m_udp_sender(NULL),
+      m_udp_controller(NULL),
+      m_udp_reply(NULL),
+      m_socket_closed(false),
+      m_auto_reconnect(false),
+      m_reconnect_delay(MIN_RECONNECT_DELAY),
+      m_reconnect_timeout(ola::thread::INVALID_TIMEOUT),
+      m_io_thread(NULL),
+      m_io_running(false),
+      m_io_stopping(false),
+      m_wake_up_pending(false) {
 }
 
 StreamingClient::StreamingClient(const Options &options)
     : m_auto_start(options.auto_start),
       m_server_port(options.server_port),
+      m_use_shared_memory(options.use_shared_memory),
+      m_use_udp(options.use_udp),
+      m_server_address(options.server_address),
+      m_server_socket(options.server_socket),
+      m_delta_encoding(options.delta_encoding),
+      m_threaded(options.threaded),
+      m_sender_queue_size(options.sender_queue_size),
       m_socket(NULL),
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_shared_dmx(NULL),
+      m_udp_sender(NULL),
+      m_udp_controller(NULL),
+      m_udp_reply(NULL),
+      m_socket_closed(false),
+      m_auto_reconnect(options.auto_reconnect),
+      m_reconnect_delay(MIN_RECONNECT_DELAY),
+      m_reconnect_timeout(ola::thread::INVALID_TIMEOUT),
+      m_io_thread(NULL),
+      m_io_running(false),
+      m_io_stopping(false),
+      m_wake_up_pending(false) {
 }
 
 StreamingClient::~StreamingClient() {
   Stop();
+  STLDeleteElements(&m_senders);
 }
 
 bool StreamingClient::Setup() {
-  if (m_socket || m_channel || m_stub)
+  if (m_socket || m_channel || m_stub || m_ss)
+    return false;
+
+  m_ss = new SelectServer();
+  if (!Connect(m_auto_start)) {
+    delete m_ss;
+    m_ss = NULL;
+    return false;
+  }
+
+  m_reconnect_delay = MIN_RECONNECT_DELAY;
+  if (m_threaded && !StartIOThread()) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+void StreamingClient::Stop() {
+  StopIOThread();
+
+  if (m_shared_dmx)
+    delete m_shared_dmx;
+
+  if (m_udp_sender)
+    delete m_udp_sender;
+
+  if (m_stub)
+    delete m_stub;
+
+  // The RpcChannel doesn't run outstanding callbacks when it's deleted.
+  if (m_channel)
+    delete m_channel;
+
+  delete m_udp_controller;
+  delete m_udp_reply;
+
+  if (m_ss)
+    delete m_ss;
+
+  if (m_socket)
+    delete m_socket;
+
+  m_channel = NULL;
+  m_socket = NULL;
+  m_ss = NULL;
+  m_stub = NULL;
+  m_shared_dmx = NULL;
+  m_udp_sender = NULL;
+  m_udp_controller = NULL;
+  m_udp_reply = NULL;
+  m_reconnect_timeout = ola::thread::INVALID_TIMEOUT;
+  m_pending.clear();
+  m_sent_frames.clear();
+  m_last_frames.clear();
+}
+
+bool StreamingClient::SendDmx(unsigned int universe,
+                              const DmxBuffer &data) {
+  if (m_threaded)
+    return Queue(universe, ola::dmx::SOURCE_PRIORITY_DEFAULT, data);
+  return Send(universe, ola::dmx::SOURCE_PRIORITY_DEFAULT, data);
+}
+
+bool StreamingClient::SendDMX(unsigned int universe,
+                              const DmxBuffer &data,
+                              const SendArgs &args) {
+  if (m_threaded)
+    return Queue(universe, args.priority, data);
+  return Send(universe, args.priority, data);
+}
+
+bool StreamingClient::SendDmxBatch(const vector<UniverseData> &batch) {
+  if (m_threaded) {
+    vector<UniverseData>::const_iterator iter = batch.begin();
+    for (; iter != batch.end(); ++iter) {
+      if (!Queue(iter->universe, iter->priority, iter->data))
+        return false;
+    }
+    return true;
+  }
+
+  if (!CheckConnection())
+    return false;
+  return SendFrames(batch);
+}
+
+StreamingClient::Sender *StreamingClient::NewSender() {
+  if (!m_threaded)
+    return NULL;
+
+  Sender *sender = new Sender(this, m_sender_queue_size);
+  MutexLocker locker(&m_sender_mutex);
+  m_senders.push_back(sender);
+  return sender;
+}
+
+/*
+ * Send a batch of data, or hold it back if olad hasn't caught up.
+ */
+bool StreamingClient::SendFrames(const vector<UniverseData> &batch) {
+  if (m_auto_reconnect) {
+    vector<UniverseData>::const_iterator iter = batch.begin();
+    for (; iter != batch.end(); ++iter) {
+      KeepFrame(iter->universe, iter->priority, iter->data);
+    }
+    // If we're reconnecting, the frames are sent once we've reconnected.
+    if (!m_stub || m_socket_closed)
+      return true;
+  }
+
+  bool hold_back = !m_pending.empty() || !m_channel->StreamWindowOpen();
+  ola::proto::DmxDataBatch request;
+  vector<UniverseData>::const_iterator iter = batch.begin();
+  for (; iter != batch.end(); ++iter) {
+    if (m_shared_dmx &&
+        m_shared_dmx->SendDMX(iter->universe, iter->priority, iter->data)) {
+      continue;
+    }
+    if (SendUDP(iter->universe, iter->priority, iter->data))
+      continue;
+    if (hold_back) {
+      HoldBack(iter->universe, iter->priority, iter->data);
+      continue;
+    }
+    ola::proto::DmxData *data = request.add_data();
+    SetData(data, iter->universe, iter->data);
+    data->set_priority(iter->priority);
+  }
+
+  if (hold_back)
+    return SendPending();
+
+  if (request.data_size() == 0)
+    return true;
+
+  m_stub->StreamDmxDataBatch(NULL, &request, NULL, NULL);
+
+  return !ConnectionClosed();
+}
+
+bool StreamingClient::Send(unsigned int universe, uint8_t priority,
+                           const DmxBuffer &data) {
+  if (!CheckConnection())
+    return false;
+
+  if (m_auto_reconnect) {
+    KeepFrame(universe, priority, data);
+    // If we're reconnecting, the frame is sent once we've reconnected.
+    if (!m_stub)
+      return true;
+  }
+
+  if (m_shared_dmx && m_shared_dmx->SendDMX(universe, priority, data)) {
+    return true;
+  }
+
+  if (SendUDP(universe, priority, data))
+    return true;
+
+  if (!m_pending.empty() || !m_channel->StreamWindowOpen()) {
+    HoldBack(universe, priority, data);
+    return SendPending();
+  }
+
+  ola::proto::DmxData request;
+  SetData(&request, universe, data);
+  request.set_priority(priority);
+  m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+
+  return !ConnectionClosed();
+}
+
+/*
+ * Check if the connection to the server is still open. If we're waiting to
+ * reconnect this runs the reconnect timer if it's due, and returns true.
+ */
+bool StreamingClient::CheckConnection() {
+  if (!m_stub) {
+    if (!m_auto_reconnect || !m_ss)
+      return false;
+    m_ss->RunOnce();
+    return true;
+  }
+
+  if (!m_socket->ValidReadDescriptor())
+    return false;
+
+  // We select() on the fd here to see if the remove end has closed the
+  // connection. We could skip this and rely on the EPIPE delivered by the
+  // write() below, but that introduces a race condition in the unittests.
+  m_socket_closed = false;
+  m_ss->RunOnce();
+  return !ConnectionClosed();
+}
+
+/*
+ * Check if the socket was closed. If so the client is stopped, or if we're
+ * the I/O thread, the I/O thread exits and the next call fails.
+ *
+ * If auto_reconnect is set, the connection is torn down and a reconnect is
+ * scheduled instead. This returns false in that case since the client can
+ * still be used.
+ */
+bool StreamingClient::ConnectionClosed() {
+  if (!m_socket_closed)
+    return false;
+
+  if (m_auto_reconnect) {
+    Disconnect();
+    ScheduleReconnect();
     return false;
+  }
 
-  if (m_auto_start)
+  if (m_io_thread) {
+    __atomic_store_n(&m_io_running, false, __ATOMIC_RELEASE);
+    m_ss->Terminate();
+  } else {
+    Stop();
+  }
+  return true;
+}
+
+/*
+ * Open a connection to olad, m_ss must exist.
+ */
+bool StreamingClient::Connect(bool auto_start) {
+  IPV4Address server_ip = IPV4Address::Loopback();
+  if (!m_server_address.empty() &&
+      !IPV4Address::FromString(m_server_address, &server_ip)) {
+    OLA_WARN << "Invalid server address " << m_server_address;
+    return false;
+  }
+
+  if (!m_server_socket.empty())
+    m_socket = UnixDomainSocket::Connect(m_server_socket);
+  else if (auto_start && m_server_address.empty())
     m_socket = ola::client::ConnectToServer(m_server_port);
   else
-    m_socket = TCPSocket::Connect(
-      ola::network::IPV4SocketAddress(ola::network::IPV4Address::Loopback(),
-                                      m_server_port));
+    m_socket = TCPSocket::Connect(IPV4SocketAddress(server_ip,
+                                                    m_server_port));
 
   if (!m_socket)
     return false;
 
-  m_ss = new SelectServer();
   m_ss->AddReadDescriptor(m_socket);
 
-  m_channel = new RpcChannel(NULL, m_socket);
+  m_channel = new RpcChannel(NULL, m_socket, NULL, m_ss);
 
   if (!m_channel) {
     delete m_socket;
@@ -105,66 +413,363 @@ bool StreamingClient::Setup() {
   m_channel->SetChannelCloseHandler(
       NewSingleCallback(this, &StreamingClient::ChannelClosed));
 
+  if (m_use_shared_memory && m_server_address.empty()) {
+    m_shared_dmx = new SharedDmxClient(m_server_port);
+    if (!m_shared_dmx->Init()) {
+      OLA_INFO << "Shared memory isn't available, falling back to RPC";
+      delete m_shared_dmx;
+      m_shared_dmx = NULL;
+    }
+  }
+
+  if (m_use_udp && !m_server_socket.empty()) {
+    OLA_INFO << "UDP streaming isn't used with a unix domain socket";
+  } else if (m_use_udp) {
+    // Frames go over RPC until olad replies with the port & token.
+    ola::proto::UDPStreamRequest request;
+    m_udp_controller = new RpcController();
+    m_udp_reply = new ola::proto::UDPStreamReply();
+    m_stub->OpenUDPStream(
+        m_udp_controller, &request, m_udp_reply,
+        NewSingleCallback(this, &StreamingClient::UDPStreamOpened));
+  }
   return true;
 }
 
-void StreamingClient::Stop() {
+/*
+ * Tear down the connection to olad, but leave the SelectServer & I/O thread
+ * running.
+ */
+void StreamingClient::Disconnect() {
+  if (m_shared_dmx)
+    delete m_shared_dmx;
+
+  if (m_udp_sender)
+    delete m_udp_sender;
+
   if (m_stub)
     delete m_stub;
 
   if (m_channel)
     delete m_channel;
 
-  if (m_ss)
-    delete m_ss;
+  delete m_udp_controller;
+  delete m_udp_reply;
 
-  if (m_socket)
+  if (m_socket) {
+    // The SelectServer has already removed the socket if it saw it close.
+    if (m_socket->ValidReadDescriptor())
+      m_ss->RemoveReadDescriptor(m_socket);
     delete m_socket;
+  }
 
   m_channel = NULL;
   m_socket = NULL;
-  m_ss = NULL;
   m_stub = NULL;
+  m_shared_dmx = NULL;
+  m_udp_sender = NULL;
+  m_udp_controller = NULL;
+  m_udp_reply = NULL;
+  m_socket_closed = false;
+  // The new olad won't have our frames, so deltas can't be used until we've
+  // sent a full frame again.
+  m_pending.clear();
+  m_sent_frames.clear();
 }
 
-bool StreamingClient::SendDmx(unsigned int universe,
+/*
+ * Called when olad replies to the OpenUDPStream request.
+ */
+void StreamingClient::UDPStreamOpened() {
+  if (m_udp_controller->Failed()) {
+    OLA_INFO << "UDP streaming isn't available, using RPC: "
+             << m_udp_controller->ErrorText();
+  } else {
+    IPV4Address server_ip = IPV4Address::Loopback();
+    if (!m_server_address.empty())
+      IPV4Address::FromString(m_server_address, &server_ip);
+
+    m_udp_sender = new UDPStreamSender(
+        IPV4SocketAddress(server_ip, m_udp_reply->port()),
+        m_udp_reply->token());
+    if (!m_udp_sender->Init()) {
+      OLA_INFO << "Failed to open the UDP socket, using RPC";
+      delete m_udp_sender;
+      m_udp_sender = NULL;
+    }
+  }
+
+  delete m_udp_controller;
+  delete m_udp_reply;
+  m_udp_controller = NULL;
+  m_udp_reply = NULL;
+}
+
+/*
+ * Send a frame over UDP, if it's available.
+ */
+bool StreamingClient::SendUDP(unsigned int universe, uint8_t priority,
                               const DmxBuffer &data) {
-  return Send(universe, ola::dmx::SOURCE_PRIORITY_DEFAULT, data);
+  if (!(m_udp_sender && m_udp_sender->SendDMX(universe, priority, data)))
+    return false;
+
+  // Held back RPC data is older than this frame, and olad's copy of the
+  // universe no longer matches the last frame sent over RPC, so it can't be
+  // used as the base for a delta.
+  m_pending.erase(universe);
+  m_sent_frames.erase(universe);
+  return true;
 }
 
-bool StreamingClient::SendDMX(unsigned int universe,
-                              const DmxBuffer &data,
-                              const SendArgs &args) {
-  return Send(universe, args.priority, data);
+void StreamingClient::ScheduleReconnect() {
+  if (m_reconnect_timeout != ola::thread::INVALID_TIMEOUT)
+    return;
+
+  OLA_INFO << "Reconnecting to olad in " << m_reconnect_delay << "ms";
+  m_reconnect_timeout = m_ss->RegisterSingleTimeout(
+      m_reconnect_delay,
+      NewSingleCallback(this, &StreamingClient::Reconnect));
 }
 
-bool StreamingClient::Send(unsigned int universe, uint8_t priority,
-                           const DmxBuffer &data) {
-  if (!m_stub || !m_socket->ValidReadDescriptor())
+/*
+ * Called when the reconnect timer fires. On success the latest frame for each
+ * universe is sent, otherwise we back off and try again.
+ */
+void StreamingClient::Reconnect() {
+  m_reconnect_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!Connect(false)) {
+    m_reconnect_delay = std::min(2 * m_reconnect_delay, MAX_RECONNECT_DELAY);
+    ScheduleReconnect();
+    return;
+  }
+
+  OLA_INFO << "Reconnected to olad";
+  m_reconnect_delay = MIN_RECONNECT_DELAY;
+  if (m_last_frames.empty())
+    return;
+
+  vector<UniverseData> batch;
+  batch.reserve(m_last_frames.size());
+  std::map<unsigned int, UniverseData>::const_iterator iter =
+      m_last_frames.begin();
+  for (; iter != m_last_frames.end(); ++iter) {
+    batch.push_back(iter->second);
+  }
+  SendFrames(batch);
+}
+
+/*
+ * Keep the latest frame for a universe so it can be sent on reconnect.
+ */
+void StreamingClient::KeepFrame(unsigned int universe, uint8_t priority,
+                                const DmxBuffer &data) {
+  STLReplace(&m_last_frames, universe,
+             UniverseData(universe, data, priority));
+}
+
+/*
+ * Hold back data until olad has caught up, this replaces any older data for
+ * the universe.
+ */
+void StreamingClient::HoldBack(unsigned int universe, uint8_t priority,
+                               const DmxBuffer &data) {
+  STLReplace(&m_pending, universe, UniverseData(universe, data, priority));
+}
+
+/*
+ * Send the held back data as a single batch, if olad will accept it.
+ */
+bool StreamingClient::SendPending() {
+  if (m_pending.empty() || !m_channel->StreamWindowOpen())
+    return true;
+
+  ola::proto::DmxDataBatch request;
+  std::map<unsigned int, UniverseData>::const_iterator iter =
+      m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    ola::proto::DmxData *data = request.add_data();
+    SetData(data, iter->second.universe, iter->second.data);
+    data->set_priority(iter->second.priority);
+  }
+  m_pending.clear();
+
+  m_stub->StreamDmxDataBatch(NULL, &request, NULL, NULL);
+
+  return !ConnectionClosed();
+}
+
+/*
+ * Set the universe & data for a message, using a delta if it's enabled and
+ * smaller than the full frame.
+ */
+void StreamingClient::SetData(ola::proto::DmxData *message,
+                              unsigned int universe,
+                              const DmxBuffer &data) {
+  message->set_universe(universe);
+  if (!m_delta_encoding) {
+    message->set_data(data.Get());
+    return;
+  }
+
+  SentFrame *sent = STLFind(&m_sent_frames, universe);
+  if (sent && sent->deltas < MAX_DELTAS) {
+    uint8_t delta[DMX_UNIVERSE_SIZE];
+    unsigned int delta_size = data.Size();
+    if (m_encoder.EncodeDelta(sent->data, data, delta, &delta_size) &&
+        delta_size < data.Size()) {
+      message->set_data("");
+      message->set_delta(delta, delta_size);
+      sent->data.Set(data);
+      sent->deltas++;
+      return;
+    }
+  }
+
+  message->set_data(data.Get());
+  SentFrame &frame = m_sent_frames[universe];
+  frame.data.Set(data);
+  frame.deltas = 0;
+}
+
+bool StreamingClient::StartIOThread() {
+  if (!m_wake_up.Init())
     return false;
 
-  // We select() on the fd here to see if the remove end has closed the
-  // connection. We could skip this and rely on the EPIPE delivered by the
-  // write() below, but that introduces a race condition in the unittests.
+  m_wake_up.SetOnData(NewCallback(this, &StreamingClient::DrainQueues));
+  m_ss->AddReadDescriptor(&m_wake_up);
+  // Held back data is sent once olad returns credit, which arrives on the
+  // socket rather than with a call from a producer.
+  m_ss->RunInLoop(NewCallback(this, &StreamingClient::FlushPending));
+
   m_socket_closed = false;
-  m_ss->RunOnce();
+  m_io_stopping = false;
+  m_wake_up_pending = false;
+  __atomic_store_n(&m_io_running, true, __ATOMIC_RELEASE);
+  m_io_thread = new ola::thread::CallbackThread(
+      NewSingleCallback(m_ss, &SelectServer::Run));
+  if (!m_io_thread->Start()) {
+    OLA_WARN << "Failed to start the StreamingClient I/O thread";
+    delete m_io_thread;
+    m_io_thread = NULL;
+    __atomic_store_n(&m_io_running, false, __ATOMIC_RELEASE);
+    m_ss->RemoveReadDescriptor(&m_wake_up);
+    m_wake_up.Close();
+    return false;
+  }
+  return true;
+}
 
-  if (m_socket_closed) {
-    Stop();
+void StreamingClient::StopIOThread() {
+  if (!m_io_thread)
+    return;
+
+  // The I/O thread may not have entered the SelectServer yet, so ask it to
+  // terminate itself rather than calling Terminate() from here.
+  __atomic_store_n(&m_io_running, false, __ATOMIC_RELEASE);
+  __atomic_store_n(&m_io_stopping, true, __ATOMIC_RELEASE);
+  uint8_t wake_up = 'a';
+  m_wake_up.Send(&wake_up, sizeof(wake_up));
+  m_io_thread->Join();
+  delete m_io_thread;
+  m_io_thread = NULL;
+
+  m_ss->RemoveReadDescriptor(&m_wake_up);
+  m_wake_up.Close();
+
+  // Discard anything that was queued after the I/O thread exited.
+  QueuedFrame frame;
+  while (m_queue.Pop(&frame)) {}
+  MutexLocker locker(&m_sender_mutex);
+  vector<Sender*>::iterator iter = m_senders.begin();
+  for (; iter != m_senders.end(); ++iter) {
+    while ((*iter)->m_queue.Pop(&frame)) {}
+  }
+}
+
+/*
+ * Queue data for the I/O thread. This can be called from any thread.
+ */
+bool StreamingClient::Queue(unsigned int universe, uint8_t priority,
+                            const DmxBuffer &data) {
+  if (!__atomic_load_n(&m_io_running, __ATOMIC_ACQUIRE))
     return false;
+
+  m_queue.Push(QueuedFrame(universe, priority, data));
+  WakeUp();
+  return true;
+}
+
+/*
+ * Wake the I/O thread, only the first frame queued since the I/O thread last
+ * woke up needs to do this.
+ */
+void StreamingClient::WakeUp() {
+  if (!__atomic_exchange_n(&m_wake_up_pending, true, __ATOMIC_SEQ_CST)) {
+    uint8_t wake_up = 'a';
+    m_wake_up.Send(&wake_up, sizeof(wake_up));
   }
+}
 
-  ola::proto::DmxData request;
-  request.set_universe(universe);
-  request.set_data(data.Get());
-  request.set_priority(priority);
-  m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+/*
+ * Called in the I/O thread to send the queued frames. Only the latest frame
+ * for each universe is sent.
+ */
+void StreamingClient::DrainQueues() {
+  while (m_wake_up.DataRemaining()) {
+    uint8_t message[100];
+    unsigned int size;
+    m_wake_up.Receive(message, sizeof(message), size);
+  }
+  __atomic_store_n(&m_wake_up_pending, false, __ATOMIC_SEQ_CST);
 
+  if (__atomic_load_n(&m_io_stopping, __ATOMIC_ACQUIRE)) {
+    m_ss->Terminate();
+    return;
+  }
+
+  std::map<unsigned int, UniverseData> latest;
+  QueuedFrame frame;
+  while (m_queue.Pop(&frame)) {
+    STLReplace(&latest, frame.universe,
+               UniverseData(frame.universe,
+                            DmxBuffer(frame.data, frame.size),
+                            frame.priority));
+  }
+
+  {
+    MutexLocker locker(&m_sender_mutex);
+    vector<Sender*>::iterator iter = m_senders.begin();
+    for (; iter != m_senders.end(); ++iter) {
+      while ((*iter)->m_queue.Pop(&frame)) {
+        STLReplace(&latest, frame.universe,
+                   UniverseData(frame.universe,
+                                DmxBuffer(frame.data, frame.size),
+                                frame.priority));
+      }
+    }
+  }
+
+  if (latest.empty() || (m_socket_closed && !m_auto_reconnect))
+    return;
+
+  vector<UniverseData> batch;
+  batch.reserve(latest.size());
+  std::map<unsigned int, UniverseData>::const_iterator iter = latest.begin();
+  for (; iter != latest.end(); ++iter) {
+    batch.push_back(iter->second);
+  }
+  SendFrames(batch);
+}
+
+/*
+ * Called in the I/O thread on each pass through the event loop.
+ */
+void StreamingClient::FlushPending() {
   if (m_socket_closed) {
-    Stop();
-    return false;
+    ConnectionClosed();
+  } else if (!m_pending.empty()) {
+    SendPending();
   }
-  return true;
 }
 
 void StreamingClient::ChannelClosed(OLA_UNUSED ola::rpc::RpcSession *session) {
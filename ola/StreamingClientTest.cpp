@@ -19,13 +19,16 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
 #include <string>
 #include <memory>
 
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/SharedDmxClient.h"
 #include "ola/StreamingClient.h"
 #include "ola/base/Flags.h"
+#include "ola/client/AsyncClient.h"
 #include "ola/network/SocketAddress.h"
 #include "ola/testing/TestUtils.h"
 #include "ola/thread/Thread.h"
@@ -37,6 +40,10 @@ static unsigned int TEST_UNIVERSE = 1;
 
 using ola::OlaDaemon;
 using ola::StreamingClient;
+using ola::client::AsyncClient;
+using ola::client::AsyncDMXResult;
+using ola::client::AsyncResult;
+using ola::thread::Future;
 using ola::network::GenericSocketAddress;
 using ola::thread::ConditionVariable;
 using ola::thread::Mutex;
@@ -45,12 +52,22 @@ using std::auto_ptr;
 class StreamingClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(StreamingClientTest);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testSharedMemory);
+  CPPUNIT_TEST(testDeltaEncoding);
+  CPPUNIT_TEST(testAsyncClient);
+  CPPUNIT_TEST(testThreaded);
+  CPPUNIT_TEST(testReconnect);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void setUp();
     void tearDown();
     void testSendDMX();
+    void testSharedMemory();
+    void testDeltaEncoding();
+    void testAsyncClient();
+    void testThreaded();
+    void testReconnect();
 
  private:
     class OlaServerThread *m_server_thread;
@@ -70,7 +87,7 @@ class OlaServerThread: public ola::thread::Thread {
         m_is_running(false) {
     }
     ~OlaServerThread() {}
-    bool Setup();
+    bool Setup(uint16_t rpc_port = 0);
     void *Run();
     void Terminate();
     void WaitForStart();
@@ -86,14 +103,20 @@ class OlaServerThread: public ola::thread::Thread {
 };
 
 
-bool OlaServerThread::Setup() {
-  FLAGS_rpc_port = 0;  // pick an unused port
+bool OlaServerThread::Setup(uint16_t rpc_port) {
+  FLAGS_rpc_port = rpc_port;  // 0 picks an unused port
   ola::OlaServer::Options ola_options;
   ola_options.http_enable = false;
   ola_options.http_localhost_only = false;
   ola_options.http_enable_quit = false;
   ola_options.http_port = 0;
   ola_options.http_data_dir = "";
+  ola_options.http_threads = 0;
+  ola_options.shared_memory = true;
+  ola_options.udp_streaming = false;
+  ola_options.udp_stream_port = 0;
+  ola_options.low_memory = false;
+  ola_options.stall_threshold_ms = 0;
 
   // pick an unused port
   auto_ptr<OlaDaemon> olad(new OlaDaemon(ola_options, NULL));
@@ -221,3 +244,312 @@ void StreamingClientTest::testSendDMX() {
 
   OLA_ASSERT_FALSE(ola_client.Setup());
 }
+
+
+/*
+ * Check that DMX data can be sent and received using shared memory.
+ */
+void StreamingClientTest::testSharedMemory() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+  uint16_t port = server_address.V4Addr().Port();
+
+  ola::client::SharedDmxClient reader(port);
+  OLA_ASSERT_TRUE(reader.Init());
+
+  // The first read asks the server to publish the universe.
+  ola::DmxBuffer output;
+  uint8_t priority;
+  OLA_ASSERT_FALSE(reader.ReadDMX(TEST_UNIVERSE, &output, &priority));
+  bool published = false;
+  for (unsigned int i = 0; i < 200 && !published; i++) {
+    usleep(10000);
+    published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_TRUE(published);
+
+  StreamingClient::Options options;
+  options.auto_start = false;
+  options.server_port = port;
+  options.use_shared_memory = true;
+  StreamingClient ola_client(options);
+  OLA_ASSERT_TRUE(ola_client.Setup());
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5");
+  OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+  for (unsigned int i = 0; i < 200 && output != buffer; i++) {
+    usleep(10000);
+    reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_DMX_EQUALS(buffer, output);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+                priority);
+  ola_client.Stop();
+}
+
+
+/*
+ * Check that delta encoded frames are applied by the server.
+ */
+void StreamingClientTest::testDeltaEncoding() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+  uint16_t port = server_address.V4Addr().Port();
+
+  // Use shared memory to watch the output of the universe.
+  ola::client::SharedDmxClient reader(port);
+  OLA_ASSERT_TRUE(reader.Init());
+  ola::DmxBuffer output;
+  uint8_t priority;
+  OLA_ASSERT_FALSE(reader.ReadDMX(TEST_UNIVERSE, &output, &priority));
+  bool published = false;
+  for (unsigned int i = 0; i < 200 && !published; i++) {
+    usleep(10000);
+    published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_TRUE(published);
+
+  StreamingClient::Options options;
+  options.auto_start = false;
+  options.server_port = port;
+  options.delta_encoding = true;
+  StreamingClient ola_client(options);
+  OLA_ASSERT_TRUE(ola_client.Setup());
+
+  ola::DmxBuffer buffer;
+  buffer.Blackout();
+  OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+
+  // This one is sent as a delta.
+  buffer.SetChannel(100, 255);
+  buffer.SetChannel(200, 128);
+  OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+  for (unsigned int i = 0; i < 200 && output != buffer; i++) {
+    usleep(10000);
+    reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_DMX_EQUALS(buffer, output);
+  ola_client.Stop();
+}
+
+
+/*
+ * Check the AsyncClient.
+ */
+void StreamingClientTest::testAsyncClient() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+  uint16_t port = server_address.V4Addr().Port();
+
+  AsyncClient::Options options;
+  options.auto_start = false;
+  options.server_port = port;
+  AsyncClient client(options);
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5");
+
+  // Requests fail until the client is setup.
+  Future<AsyncResult> result = client.SendDMX(TEST_UNIVERSE, buffer);
+  OLA_ASSERT_TRUE(result.IsComplete());
+  OLA_ASSERT_FALSE(result.Get().Success());
+  OLA_ASSERT_FALSE(client.StreamDMX(TEST_UNIVERSE, buffer));
+
+  OLA_ASSERT_TRUE(client.Setup());
+  OLA_ASSERT_FALSE(client.Setup());
+
+  // Reading the universe using shared memory creates it.
+  ola::client::SharedDmxClient reader(port);
+  OLA_ASSERT_TRUE(reader.Init());
+  ola::DmxBuffer output;
+  uint8_t priority;
+  bool published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  for (unsigned int i = 0; i < 200 && !published; i++) {
+    usleep(10000);
+    published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_TRUE(published);
+
+  result = client.SendDMX(TEST_UNIVERSE, buffer);
+  OLA_ASSERT_TRUE(result.Get().Success());
+
+  Future<AsyncDMXResult> dmx = client.FetchDMX(TEST_UNIVERSE);
+  OLA_ASSERT_TRUE(dmx.Get().Success());
+  OLA_ASSERT_DMX_EQUALS(buffer, dmx.Get().data);
+
+  buffer.SetChannel(0, 10);
+  OLA_ASSERT_TRUE(client.StreamDMX(TEST_UNIVERSE, buffer));
+  // Requests are sent in order, so the fetch sees the streamed data.
+  dmx = client.FetchDMX(TEST_UNIVERSE);
+  OLA_ASSERT_TRUE(dmx.Get().Success());
+  OLA_ASSERT_DMX_EQUALS(buffer, dmx.Get().data);
+
+  client.Stop();
+  result = client.SendDMX(TEST_UNIVERSE, buffer);
+  OLA_ASSERT_TRUE(result.IsComplete());
+  OLA_ASSERT_FALSE(result.Get().Success());
+}
+
+
+/*
+ * A thread which sends frames with a StreamingClient::Sender.
+ */
+class SenderThread: public ola::thread::Thread {
+ public:
+  SenderThread(StreamingClient::Sender *sender, unsigned int universe)
+      : Thread(),
+        m_sender(sender),
+        m_universe(universe),
+        m_sent(0) {
+  }
+
+  unsigned int Sent() const { return m_sent; }
+
+ protected:
+  void *Run() {
+    ola::DmxBuffer buffer;
+    buffer.Blackout();
+    for (unsigned int i = 0; i < 100; i++) {
+      buffer.SetChannel(0, i);
+      if (m_sender->SendDmx(m_universe, buffer)) {
+        m_sent++;
+      }
+      usleep(1000);
+    }
+    return NULL;
+  }
+
+ private:
+  StreamingClient::Sender *m_sender;
+  const unsigned int m_universe;
+  unsigned int m_sent;
+};
+
+
+/*
+ * Check sending from other threads with a threaded StreamingClient.
+ */
+void StreamingClientTest::testThreaded() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+  uint16_t port = server_address.V4Addr().Port();
+
+  ola::client::SharedDmxClient reader(port);
+  OLA_ASSERT_TRUE(reader.Init());
+  ola::DmxBuffer output;
+  uint8_t priority;
+  bool published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  for (unsigned int i = 0; i < 200 && !published; i++) {
+    usleep(10000);
+    published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_TRUE(published);
+
+  // Senders need a threaded client.
+  StreamingClient::Options options;
+  options.auto_start = false;
+  options.server_port = port;
+  StreamingClient unthreaded_client(options);
+  OLA_ASSERT_NULL(unthreaded_client.NewSender());
+
+  options.threaded = true;
+  StreamingClient ola_client(options);
+  StreamingClient::Sender *sender = ola_client.NewSender();
+  OLA_ASSERT_NOT_NULL(sender);
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  // Sends fail until the client is setup.
+  OLA_ASSERT_FALSE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_FALSE(sender->SendDmx(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_TRUE(ola_client.Setup());
+
+  SenderThread thread(sender, TEST_UNIVERSE);
+  OLA_ASSERT_TRUE(thread.Start());
+  thread.Join();
+  OLA_ASSERT_TRUE(thread.Sent() > 0);
+
+  // The last frame from the thread is output.
+  ola::DmxBuffer expected;
+  expected.Blackout();
+  expected.SetChannel(0, 99);
+  for (unsigned int i = 0; i < 200 && output != expected; i++) {
+    usleep(10000);
+    reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_DMX_EQUALS(expected, output);
+
+  OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+  for (unsigned int i = 0; i < 200 && output != buffer; i++) {
+    usleep(10000);
+    reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_DMX_EQUALS(buffer, output);
+
+  ola_client.Stop();
+  OLA_ASSERT_FALSE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_FALSE(sender->SendDmx(TEST_UNIVERSE, buffer));
+}
+
+
+/*
+ * Check that the client reconnects when olad is restarted, and sends the
+ * latest frame for each universe again.
+ */
+void StreamingClientTest::testReconnect() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+  uint16_t port = server_address.V4Addr().Port();
+
+  StreamingClient::Options options;
+  options.auto_start = false;
+  options.server_port = port;
+  options.auto_reconnect = true;
+  StreamingClient ola_client(options);
+  OLA_ASSERT_TRUE(ola_client.Setup());
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+
+  // Stop olad, sends still succeed while the client is reconnecting.
+  m_server_thread->Terminate();
+  m_server_thread->Join();
+  delete m_server_thread;
+  OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+
+  // Start a new olad on the same port.
+  m_server_thread = new OlaServerThread();
+  OLA_ASSERT_TRUE(m_server_thread->Setup(port));
+  m_server_thread->Start();
+  m_server_thread->WaitForStart();
+
+  ola::client::SharedDmxClient reader(port);
+  OLA_ASSERT_TRUE(reader.Init());
+  ola::DmxBuffer output;
+  uint8_t priority;
+  bool published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  for (unsigned int i = 0; i < 200 && !published; i++) {
+    usleep(10000);
+    published = reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_TRUE(published);
+
+  // Only send to another universe, the frame for TEST_UNIVERSE is sent again
+  // once the client reconnects.
+  ola::DmxBuffer other;
+  other.SetFromString("4,5,6");
+  for (unsigned int i = 0; i < 200 && output != buffer; i++) {
+    OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE + 1, other));
+    usleep(10000);
+    reader.ReadDMX(TEST_UNIVERSE, &output, &priority);
+  }
+  OLA_ASSERT_DMX_EQUALS(buffer, output);
+  ola_client.Stop();
+}
@@ -0,0 +1,76 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UDPStreamSender.cpp
+ * The client side of the UDP DMX streaming transport.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "ola/UDPStreamSender.h"
+
+#include "common/dmx/StreamFrame.h"
+#include "ola/Logging.h"
+
+namespace ola {
+namespace client {
+
+using ola::dmx::StreamFrame;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
+
+UDPStreamSender::UDPStreamSender(const IPV4SocketAddress &server,
+                                 uint64_t token)
+    : m_server(server),
+      m_token(token) {
+}
+
+bool UDPStreamSender::Init() {
+  if (m_socket.get()) {
+    return false;
+  }
+
+  std::auto_ptr<UDPSocket> socket(new UDPSocket());
+  if (!socket->Init()) {
+    return false;
+  }
+  m_socket.reset(socket.release());
+  return true;
+}
+
+bool UDPStreamSender::SendDMX(unsigned int universe, uint8_t priority,
+                              const DmxBuffer &data) {
+  if (!m_socket.get()) {
+    return false;
+  }
+
+  StreamFrame frame;
+  frame.token = m_token;
+  frame.universe = universe;
+  // The first frame for a universe has sequence number 1.
+  frame.sequence = ++m_sequences[universe];
+  frame.priority = priority;
+  frame.length = data.Size();
+  frame.data = data.GetRaw();
+
+  uint8_t buffer[StreamFrame::MAX_SIZE];
+  const unsigned int size = frame.Pack(buffer, sizeof(buffer));
+  if (!size) {
+    return false;
+  }
+  return m_socket->SendTo(buffer, size, m_server) ==
+      static_cast<ssize_t>(size);
+}
+}  // namespace client
+}  // namespace ola
@@ -0,0 +1,82 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UDPStreamSender.h
+ * The client side of the UDP DMX streaming transport.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLA_UDPSTREAMSENDER_H_
+#define OLA_UDPSTREAMSENDER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+
+namespace ola {
+namespace client {
+
+/**
+ * @brief Sends DMX data to olad over UDP.
+ *
+ * The token and port are handed out by olad over the RPC connection, see the
+ * OpenUDPStream RPC. Each frame is sent in its own datagram with a sequence
+ * number for the universe, see common/dmx/StreamFrame.h. Nothing is
+ * retransmitted, a lost frame is replaced by the next one.
+ *
+ * This is used by the StreamingClient class, control messages still go over
+ * the RPC socket.
+ */
+class UDPStreamSender {
+ public:
+  /**
+   * @brief Create a new UDPStreamSender.
+   * @param server the address of olad's UDP streaming socket.
+   * @param token the token returned by the OpenUDPStream RPC.
+   */
+  UDPStreamSender(const ola::network::IPV4SocketAddress &server,
+                  uint64_t token);
+
+  /**
+   * @brief Open the socket.
+   */
+  bool Init();
+
+  /**
+   * @brief Send DMX data to olad.
+   * @param universe the universe to send to.
+   * @param priority the priority of the data.
+   * @param data the DMX data.
+   * @returns false if the datagram couldn't be sent.
+   */
+  bool SendDMX(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+
+ private:
+  typedef std::map<unsigned int, uint32_t> SequenceMap;
+
+  const ola::network::IPV4SocketAddress m_server;
+  const uint64_t m_token;
+  std::auto_ptr<ola::network::UDPSocket> m_socket;
+  SequenceMap m_sequences;
+
+  DISALLOW_COPY_AND_ASSIGN(UDPStreamSender);
+};
+}  // namespace client
+}  // namespace ola
+#endif  // OLA_UDPSTREAMSENDER_H_
@@ -33,14 +33,18 @@
 
 #include "ola/Clock.h"
 #include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
 #include "ola/stl/STLUtils.h"
 #include "ola/StringUtils.h"
 
 namespace ola {
 
+using ola::network::IPV4Address;
 using std::string;
 using std::vector;
 
+const unsigned int AvahiDiscoveryAgent::STALE_SERVICE_TIMEOUT;
+
 static std::string MakeServiceKey(const std::string &service_name,
                                   const std::string &type) {
   return service_name + "." + type;
@@ -58,6 +62,19 @@ struct EntryGroupParams {
   }
 };
 
+/*
+ * The userdata passed to the browse_callback and resolve_callback functions.
+ */
+struct BrowseParams {
+  AvahiDiscoveryAgent *agent;
+  const string type;
+  AvahiServiceBrowser *browser;
+
+  BrowseParams(AvahiDiscoveryAgent *agent, const string &type)
+      : agent(agent), type(type), browser(NULL) {
+  }
+};
+
 namespace {
 
 /*
@@ -94,6 +111,44 @@ static void reconnect_callback(AvahiTimeout*, void *data) {
   AvahiDiscoveryAgent *agent = reinterpret_cast<AvahiDiscoveryAgent*>(data);
   agent->ReconnectTimeout();
 }
+
+/*
+ * Called when a browser finds or loses a service.
+ */
+static void browse_callback(AvahiServiceBrowser*,
+                            AvahiIfIndex interface,
+                            AvahiProtocol protocol,
+                            AvahiBrowserEvent event,
+                            const char *name,
+                            const char *type,
+                            const char *domain,
+                            AvahiLookupResultFlags,
+                            void *data) {
+  BrowseParams *params = reinterpret_cast<BrowseParams*>(data);
+  params->agent->BrowseEvent(params, interface, protocol, event, name, type,
+                             domain);
+}
+
+/*
+ * Called when a service has been resolved.
+ */
+static void resolve_callback(AvahiServiceResolver *resolver,
+                             AvahiIfIndex interface,
+                             AvahiProtocol,
+                             AvahiResolverEvent event,
+                             const char *name,
+                             const char*,
+                             const char *domain,
+                             const char *host_name,
+                             const AvahiAddress *address,
+                             uint16_t port,
+                             AvahiStringList *txt,
+                             AvahiLookupResultFlags,
+                             void *data) {
+  BrowseParams *params = reinterpret_cast<BrowseParams*>(data);
+  params->agent->ResolveEvent(params, resolver, interface, event, name, domain,
+                              host_name, address, port, txt);
+}
 }  // namespace
 
 AvahiDiscoveryAgent::ServiceEntry::ServiceEntry(
@@ -126,7 +181,8 @@ AvahiDiscoveryAgent::AvahiDiscoveryAgent()
       m_client(NULL),
       m_reconnect_timeout(NULL),
       m_backoff(new ExponentialBackoffPolicy(TimeInterval(1, 0),
-                                             TimeInterval(60, 0))) {
+                                             TimeInterval(60, 0))),
+      m_cache(&m_clock) {
 }
 
 AvahiDiscoveryAgent::~AvahiDiscoveryAgent() {
@@ -139,10 +195,13 @@ AvahiDiscoveryAgent::~AvahiDiscoveryAgent() {
 
   DeregisterAllServices();
   STLDeleteValues(&m_services);
+  StopBrowsers();
 
+  // This also frees any resolvers that are still running.
   if (m_client) {
     avahi_client_free(m_client);
   }
+  STLDeleteValues(&m_browsers);
   avahi_threaded_poll_free(m_threaded_poll);
 }
 
@@ -185,6 +244,35 @@ void AvahiDiscoveryAgent::RegisterService(const string &service_name,
   avahi_threaded_poll_unlock(m_threaded_poll);
 }
 
+bool AvahiDiscoveryAgent::BrowseServices(const string &type) {
+  if (!m_threaded_poll) {
+    return false;
+  }
+
+  bool ok = true;
+  avahi_threaded_poll_lock(m_threaded_poll);
+  if (!STLContains(m_browsers, type)) {
+    BrowseParams *params = new BrowseParams(this, type);
+    STLInsertIfNotPresent(&m_browsers, type, params);
+    m_cache.AddType(type);
+
+    // If we're not running, the browser is started when the client
+    // transitions to the running state.
+    if (m_client &&
+        avahi_client_get_state(m_client) == AVAHI_CLIENT_S_RUNNING) {
+      ok = StartBrowser(params);
+    }
+  }
+  avahi_threaded_poll_unlock(m_threaded_poll);
+  return ok;
+}
+
+bool AvahiDiscoveryAgent::GetServices(const string &type,
+                                      vector<ServiceInfo> *services) {
+  // The cache has its own lock, so we don't need to lock the poll here.
+  return m_cache.GetServices(type, services);
+}
+
 
 /*
  * This is a bit tricky because it can be called from either the main thread on
@@ -206,9 +294,14 @@ void AvahiDiscoveryAgent::ClientStateChanged(AvahiClientState state,
       // name on the network, so it's time to create our services.
       // register_stuff
       UpdateServices();
+      StartBrowsers();
       break;
     case AVAHI_CLIENT_FAILURE:
       DeregisterAllServices();
+      // The browsers will report the services again once we reconnect, until
+      // then we keep answering from the cache.
+      StopBrowsers();
+      m_cache.MarkStale(TimeInterval(STALE_SERVICE_TIMEOUT, 0));
       SetUpReconnectTimeout();
       break;
     case AVAHI_CLIENT_S_COLLISION:
@@ -271,6 +364,7 @@ void AvahiDiscoveryAgent::GroupStateChanged(const string &service_key,
 }
 
 void AvahiDiscoveryAgent::ReconnectTimeout() {
+  StopBrowsers();
   if (m_client) {
     avahi_client_free(m_client);
     m_client = NULL;
@@ -278,6 +372,79 @@ void AvahiDiscoveryAgent::ReconnectTimeout() {
   CreateNewClient();
 }
 
+void AvahiDiscoveryAgent::BrowseEvent(BrowseParams *params,
+                                      AvahiIfIndex interface,
+                                      AvahiProtocol protocol,
+                                      AvahiBrowserEvent event,
+                                      const char *name,
+                                      const char *type,
+                                      const char *domain) {
+  switch (event) {
+    case AVAHI_BROWSER_NEW:
+      // The resolver is freed in ResolveEvent.
+      if (!avahi_service_resolver_new(
+              m_client, interface, protocol, name, type, domain,
+              AVAHI_PROTO_INET, static_cast<AvahiLookupFlags>(0),
+              resolve_callback, params)) {
+        OLA_WARN << "Failed to resolve " << name << "." << type << ": "
+                 << avahi_strerror(avahi_client_errno(m_client));
+      }
+      break;
+    case AVAHI_BROWSER_REMOVE:
+      OLA_INFO << "Service " << name << "." << type << " was removed";
+      m_cache.RemoveService(params->type, name, domain, interface);
+      break;
+    case AVAHI_BROWSER_FAILURE:
+      OLA_WARN << "Browsing for " << params->type << " failed: "
+               << avahi_strerror(avahi_client_errno(m_client));
+      break;
+    case AVAHI_BROWSER_ALL_FOR_NOW:
+    case AVAHI_BROWSER_CACHE_EXHAUSTED:
+      break;
+  }
+}
+
+void AvahiDiscoveryAgent::ResolveEvent(BrowseParams *params,
+                                       AvahiServiceResolver *resolver,
+                                       AvahiIfIndex interface,
+                                       AvahiResolverEvent event,
+                                       const char *name,
+                                       const char *domain,
+                                       const char *host_name,
+                                       const AvahiAddress *address,
+                                       uint16_t port,
+                                       AvahiStringList *txt) {
+  if (event == AVAHI_RESOLVER_FOUND) {
+    ServiceInfo service;
+    service.name = name;
+    service.type = params->type;
+    service.domain = domain;
+    service.host = host_name;
+    if (address && address->proto == AVAHI_PROTO_INET) {
+      service.address = IPV4Address(address->data.ipv4.address);
+    }
+    service.port = port;
+    service.if_index = interface;
+
+    for (; txt; txt = avahi_string_list_get_next(txt)) {
+      char *key = NULL;
+      char *value = NULL;
+      if (avahi_string_list_get_pair(txt, &key, &value, NULL) == 0) {
+        service.txt_data[key] = value ? value : "";
+        avahi_free(key);
+        avahi_free(value);
+      }
+    }
+    OLA_INFO << "Resolved " << name << "." << params->type << " to "
+             << host_name << ":" << port;
+    m_cache.UpdateService(service);
+  } else {
+    OLA_WARN << "Failed to resolve " << name << "." << params->type << ": "
+             << avahi_strerror(avahi_client_errno(m_client));
+  }
+  avahi_service_resolver_free(resolver);
+}
+
 bool AvahiDiscoveryAgent::InternalRegisterService(ServiceEntry *service) {
   if (!service->params) {
     service->params = new EntryGroupParams(this, service->key());
@@ -426,6 +593,37 @@ void AvahiDiscoveryAgent::SetUpReconnectTimeout() {
   }
 }
 
+bool AvahiDiscoveryAgent::StartBrowser(BrowseParams *params) {
+  params->browser = avahi_service_browser_new(
+      m_client, AVAHI_IF_UNSPEC, AVAHI_PROTO_INET, params->type.c_str(), NULL,
+      static_cast<AvahiLookupFlags>(0), browse_callback, params);
+  if (!params->browser) {
+    OLA_WARN << "avahi_service_browser_new() failed for " << params->type
+             << ": " << avahi_strerror(avahi_client_errno(m_client));
+    return false;
+  }
+  return true;
+}
+
+void AvahiDiscoveryAgent::StartBrowsers() {
+  Browsers::iterator iter = m_browsers.begin();
+  for (; iter != m_browsers.end(); ++iter) {
+    if (!iter->second->browser) {
+      StartBrowser(iter->second);
+    }
+  }
+}
+
+void AvahiDiscoveryAgent::StopBrowsers() {
+  Browsers::iterator iter = m_browsers.begin();
+  for (; iter != m_browsers.end(); ++iter) {
+    if (iter->second->browser) {
+      avahi_service_browser_free(iter->second->browser);
+      iter->second->browser = NULL;
+    }
+  }
+}
+
 bool AvahiDiscoveryAgent::RenameAndRegister(ServiceEntry *service) {
   char *new_name_str =
       avahi_alternative_service_name(service->actual_service_name.c_str());
@@ -23,8 +23,10 @@
 
 #include <avahi-client/client.h>
 #include <avahi-common/thread-watch.h>
+#include <avahi-client/lookup.h>
 #include <avahi-client/publish.h>
 
+#include <ola/Clock.h>
 #include <ola/base/Macro.h>
 #include <ola/util/Backoff.h>
 #include <map>
@@ -32,9 +34,12 @@
 #include <vector>
 
 #include "olad/DiscoveryAgent.h"
+#include "olad/DiscoveryCache.h"
 
 namespace ola {
 
+struct BrowseParams;
+
 /**
  * @brief An implementation of DiscoveryAgentInterface that uses the Avahi
  * client library.
@@ -51,6 +56,11 @@ class AvahiDiscoveryAgent : public DiscoveryAgentInterface {
                        uint16_t port,
                        const RegisterOptions &options);
 
+  bool BrowseServices(const std::string &type);
+
+  bool GetServices(const std::string &type,
+                   std::vector<ServiceInfo> *services);
+
   /**
    * @brief Called when the Avahi client state changes
    */
@@ -68,6 +78,31 @@ class AvahiDiscoveryAgent : public DiscoveryAgentInterface {
    */
   void ReconnectTimeout();
 
+  /**
+   * @brief Called when a browser finds or loses a service.
+   */
+  void BrowseEvent(BrowseParams *params,
+                   AvahiIfIndex interface,
+                   AvahiProtocol protocol,
+                   AvahiBrowserEvent event,
+                   const char *name,
+                   const char *type,
+                   const char *domain);
+
+  /**
+   * @brief Called when a service found by a browser has been resolved.
+   */
+  void ResolveEvent(BrowseParams *params,
+                    AvahiServiceResolver *resolver,
+                    AvahiIfIndex interface,
+                    AvahiResolverEvent event,
+                    const char *name,
+                    const char *domain,
+                    const char *host_name,
+                    const AvahiAddress *address,
+                    uint16_t port,
+                    AvahiStringList *txt);
+
  private:
   // The structure used to track services.
   struct ServiceEntry : public RegisterOptions {
@@ -96,12 +131,16 @@ class AvahiDiscoveryAgent : public DiscoveryAgentInterface {
   };
 
   typedef std::map<std::string, ServiceEntry*> Services;
+  typedef std::map<std::string, BrowseParams*> Browsers;
 
   AvahiThreadedPoll *m_threaded_poll;
   AvahiClient *m_client;
   AvahiTimeout *m_reconnect_timeout;
   Services m_services;
   BackoffGenerator m_backoff;
+  Clock m_clock;
+  DiscoveryCache m_cache;
+  Browsers m_browsers;
 
   bool InternalRegisterService(ServiceEntry *service);
   void CreateNewClient();
@@ -109,10 +148,17 @@ class AvahiDiscoveryAgent : public DiscoveryAgentInterface {
   void DeregisterAllServices();
   void SetUpReconnectTimeout();
   bool RenameAndRegister(ServiceEntry *service);
+  bool StartBrowser(BrowseParams *params);
+  void StartBrowsers();
+  void StopBrowsers();
 
   static std::string ClientStateToString(AvahiClientState state);
   static std::string GroupStateToString(AvahiEntryGroupState state);
 
+  // How long the cached services are kept after we lose the connection to
+  // the daemon. This is the TTL of mDNS SRV records.
+  static const unsigned int STALE_SERVICE_TIMEOUT = 120;
+
   DISALLOW_COPY_AND_ASSIGN(AvahiDiscoveryAgent);
 };
 }  // namespace ola
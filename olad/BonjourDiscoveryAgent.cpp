@@ -27,13 +27,17 @@
 #include <ola/Callback.h>
 #include <ola/Logging.h>
 #include <ola/network/NetworkUtils.h>
+#include <ola/stl/STLUtils.h>
 #include <ola/thread/CallbackThread.h>
 
+#include <set>
 #include <string>
+#include <vector>
 
 namespace ola {
 
 using ola::network::HostToNetwork;
+using ola::network::NetworkToHost;
 using ola::thread::Thread;
 using std::auto_ptr;
 using std::string;
@@ -77,6 +81,64 @@ void DNSSDDescriptor::PerformRead() {
   }
 }
 
+/*
+ * The context passed to BrowseCallback.
+ */
+struct BrowseArgs {
+  BonjourDiscoveryAgent *agent;
+  const string type;
+
+  BrowseArgs(BonjourDiscoveryAgent *agent, const string &type)
+      : agent(agent), type(type) {
+  }
+};
+
+/*
+ * The context passed to ResolveCallback.
+ */
+struct ResolveArgs {
+  BonjourDiscoveryAgent *agent;
+  DiscoveryCache::ServiceInfo service;
+  DNSServiceRef service_ref;
+  DNSSDDescriptor *descriptor;
+  bool done;
+
+  explicit ResolveArgs(BonjourDiscoveryAgent *agent)
+      : agent(agent),
+        service_ref(NULL),
+        descriptor(NULL),
+        done(false) {
+  }
+};
+
+static void BrowseCallback(OLA_UNUSED DNSServiceRef service,
+                           DNSServiceFlags flags,
+                           uint32_t if_index,
+                           DNSServiceErrorType error_code,
+                           const char *name,
+                           const char *type,
+                           const char *domain,
+                           void *context) {
+  BrowseArgs *args = reinterpret_cast<BrowseArgs*>(context);
+  args->agent->BrowseEvent(args, flags, if_index, error_code, name, type,
+                           domain);
+}
+
+static void ResolveCallback(OLA_UNUSED DNSServiceRef service,
+                            OLA_UNUSED DNSServiceFlags flags,
+                            OLA_UNUSED uint32_t if_index,
+                            DNSServiceErrorType error_code,
+                            OLA_UNUSED const char *full_name,
+                            const char *host_target,
+                            uint16_t port,
+                            uint16_t txt_length,
+                            const unsigned char *txt_record,
+                            void *context) {
+  ResolveArgs *args = reinterpret_cast<ResolveArgs*>(context);
+  args->agent->ResolveEvent(args, error_code, host_target, port, txt_length,
+                            txt_record);
+}
+
 BonjourDiscoveryAgent::RegisterArgs::RegisterArgs(
     const string &service_name,
     const string &type,
@@ -91,7 +153,8 @@ BonjourDiscoveryAgent::RegisterArgs::RegisterArgs(
 BonjourDiscoveryAgent::BonjourDiscoveryAgent()
     : m_thread(new ola::thread::CallbackThread(
           NewSingleCallback(this, &BonjourDiscoveryAgent::RunThread),
-          Thread::Options("bonjour"))) {
+          Thread::Options("bonjour"))),
+      m_cache(&m_clock) {
 }
 
 BonjourDiscoveryAgent::~BonjourDiscoveryAgent() {
@@ -105,6 +168,15 @@ BonjourDiscoveryAgent::~BonjourDiscoveryAgent() {
     delete iter->descriptor;
     DNSServiceRefDeallocate(iter->service_ref);
   }
+
+  std::set<ResolveArgs*>::iterator resolve_iter = m_resolves.begin();
+  for (; resolve_iter != m_resolves.end(); ++resolve_iter) {
+    m_ss.RemoveReadDescriptor((*resolve_iter)->descriptor);
+    delete (*resolve_iter)->descriptor;
+    DNSServiceRefDeallocate((*resolve_iter)->service_ref);
+    delete *resolve_iter;
+  }
+  STLDeleteElements(&m_browse_args);
 }
 
 bool BonjourDiscoveryAgent::Init() {
@@ -122,6 +194,103 @@ void BonjourDiscoveryAgent::RegisterService(const string &service_name,
       &BonjourDiscoveryAgent::InternalRegisterService, args));
 }
 
+bool BonjourDiscoveryAgent::BrowseServices(const string &type) {
+  if (m_cache.AddType(type)) {
+    m_ss.Execute(NewSingleCallback(
+        this,
+        &BonjourDiscoveryAgent::InternalBrowseServices,
+        new BrowseArgs(this, type)));
+  }
+  return true;
+}
+
+bool BonjourDiscoveryAgent::GetServices(const string &type,
+                                        std::vector<ServiceInfo> *services) {
+  return m_cache.GetServices(type, services);
+}
+
+void BonjourDiscoveryAgent::BrowseEvent(BrowseArgs *args,
+                                        DNSServiceFlags flags,
+                                        uint32_t if_index,
+                                        DNSServiceErrorType error_code,
+                                        const char *name,
+                                        const char *type,
+                                        const char *domain) {
+  if (error_code != kDNSServiceErr_NoError) {
+    OLA_WARN << "DNSServiceBrowse for " << args->type << " returned error "
+             << error_code;
+    return;
+  }
+
+  if (!(flags & kDNSServiceFlagsAdd)) {
+    OLA_INFO << "Service " << name << "." << type << domain << " was removed";
+    m_cache.RemoveService(args->type, name, domain, if_index);
+    return;
+  }
+
+  ResolveArgs *resolve_args = new ResolveArgs(this);
+  resolve_args->service.name = name;
+  resolve_args->service.type = args->type;
+  resolve_args->service.domain = domain;
+  resolve_args->service.if_index = if_index;
+
+  DNSServiceErrorType error = DNSServiceResolve(
+      &resolve_args->service_ref, 0, if_index, name, type, domain,
+      &ResolveCallback, resolve_args);
+  if (error != kDNSServiceErr_NoError) {
+    OLA_WARN << "DNSServiceResolve for " << name << "." << type << domain
+             << " returned " << error;
+    delete resolve_args;
+    return;
+  }
+
+  resolve_args->descriptor = new DNSSDDescriptor(resolve_args->service_ref);
+  m_ss.AddReadDescriptor(resolve_args->descriptor);
+  m_resolves.insert(resolve_args);
+}
+
+void BonjourDiscoveryAgent::ResolveEvent(ResolveArgs *args,
+                                         DNSServiceErrorType error_code,
+                                         const char *host_target,
+                                         uint16_t port,
+                                         uint16_t txt_length,
+                                         const unsigned char *txt_record) {
+  if (args->done) {
+    return;
+  }
+
+  if (error_code == kDNSServiceErr_NoError) {
+    args->service.host = host_target;
+    args->service.port = NetworkToHost(port);
+
+    uint16_t count = TXTRecordGetCount(txt_length, txt_record);
+    for (uint16_t i = 0; i < count; i++) {
+      char key[UINT8_MAX + 1];
+      uint8_t value_length = 0;
+      const void *value = NULL;
+      error_code = TXTRecordGetItemAtIndex(txt_length, txt_record, i,
+                                           sizeof(key), key, &value_length,
+                                           &value);
+      if (error_code == kDNSServiceErr_NoError) {
+        args->service.txt_data[key] = value ?
+            string(reinterpret_cast<const char*>(value), value_length) : "";
+      }
+    }
+    OLA_INFO << "Resolved " << args->service.name << "."
+             << args->service.type << " to " << host_target << ":"
+             << args->service.port;
+    m_cache.UpdateService(args->service);
+  } else {
+    OLA_WARN << "DNSServiceResolve for " << args->service.name << "."
+             << args->service.type << " returned error " << error_code;
+  }
+
+  // We can't deallocate the ref while it's being processed, so stop the
+  // resolve once this callback has returned.
+  args->done = true;
+  m_ss.Execute(NewSingleCallback(
+      this, &BonjourDiscoveryAgent::StopResolve, args));
+}
 
 void BonjourDiscoveryAgent::InternalRegisterService(RegisterArgs *args_ptr) {
   auto_ptr<RegisterArgs> args(args_ptr);
@@ -152,6 +321,38 @@ void BonjourDiscoveryAgent::InternalRegisterService(RegisterArgs *args_ptr) {
   m_refs.push_back(ref);
 }
 
+void BonjourDiscoveryAgent::InternalBrowseServices(BrowseArgs *args) {
+  m_browse_args.push_back(args);
+
+  OLA_INFO << "Browsing for " << args->type;
+
+  ServiceRef ref;
+  DNSServiceErrorType error = DNSServiceBrowse(
+      &ref.service_ref,
+      0, kDNSServiceInterfaceIndexAny, args->type.c_str(),
+      NULL,  // use the default domains
+      &BrowseCallback,
+      args);
+
+  if (error != kDNSServiceErr_NoError) {
+    OLA_WARN << "DNSServiceBrowse returned " << error;
+    return;
+  }
+
+  ref.descriptor = new DNSSDDescriptor(ref.service_ref);
+
+  m_ss.AddReadDescriptor(ref.descriptor);
+  m_refs.push_back(ref);
+}
+
+void BonjourDiscoveryAgent::StopResolve(ResolveArgs *args) {
+  m_ss.RemoveReadDescriptor(args->descriptor);
+  delete args->descriptor;
+  DNSServiceRefDeallocate(args->service_ref);
+  m_resolves.erase(args);
+  delete args;
+}
+
 string BonjourDiscoveryAgent::BuildTxtRecord(
     const RegisterOptions::TxtData &txt_data) {
   RegisterOptions::TxtData::const_iterator iter = txt_data.begin();
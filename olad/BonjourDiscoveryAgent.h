@@ -23,20 +23,26 @@
 
 #include <dns_sd.h>
 
+#include <ola/Clock.h>
 #include <ola/base/Macro.h>
 #include <ola/io/Descriptor.h>
 #include <ola/io/SelectServer.h>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "olad/DiscoveryAgent.h"
+#include "olad/DiscoveryCache.h"
 
 namespace ola {
 namespace thread {
 class CallbackThread;
 }
 
+struct BrowseArgs;
+struct ResolveArgs;
+
 /**
  * @brief An implementation of DiscoveryAgentInterface that uses the Apple
  * dns_sd.h library.
@@ -53,6 +59,32 @@ class BonjourDiscoveryAgent : public DiscoveryAgentInterface {
                        uint16_t port,
                        const RegisterOptions &options);
 
+  bool BrowseServices(const std::string &type);
+
+  bool GetServices(const std::string &type,
+                   std::vector<ServiceInfo> *services);
+
+  /**
+   * @brief Called when a browse operation finds or loses a service.
+   */
+  void BrowseEvent(BrowseArgs *args,
+                   DNSServiceFlags flags,
+                   uint32_t if_index,
+                   DNSServiceErrorType error_code,
+                   const char *name,
+                   const char *type,
+                   const char *domain);
+
+  /**
+   * @brief Called when a service found by browsing has been resolved.
+   */
+  void ResolveEvent(ResolveArgs *args,
+                    DNSServiceErrorType error_code,
+                    const char *host_target,
+                    uint16_t port,
+                    uint16_t txt_length,
+                    const unsigned char *txt_record);
+
  private:
   struct RegisterArgs : public RegisterOptions {
     std::string service_name;
@@ -76,8 +108,14 @@ class BonjourDiscoveryAgent : public DiscoveryAgentInterface {
   ola::io::SelectServer m_ss;
   std::auto_ptr<thread::CallbackThread> m_thread;
   ServiceRefs m_refs;
+  Clock m_clock;
+  DiscoveryCache m_cache;
+  std::vector<BrowseArgs*> m_browse_args;
+  std::set<ResolveArgs*> m_resolves;
 
   void InternalRegisterService(RegisterArgs *args);
+  void InternalBrowseServices(BrowseArgs *args);
+  void StopResolve(ResolveArgs *args);
   std::string BuildTxtRecord(const RegisterOptions::TxtData &txt_data);
   void RunThread();
   DISALLOW_COPY_AND_ASSIGN(BonjourDiscoveryAgent);
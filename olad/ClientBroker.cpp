@@ -18,54 +18,51 @@
  * Copyright (C) 2010 Simon Newton
  */
 
-#include <set>
 #include <string>
 #include <vector>
 #include "ola/Logging.h"
-#include "ola/stl/STLUtils.h"
 #include "olad/ClientBroker.h"
 
 namespace ola {
 
-using std::set;
 using std::string;
 using std::vector;
 
 void ClientBroker::AddClient(const Client *client) {
-  m_clients.insert(client);
+  m_clients.AddOwner(client);
 }
 
 void ClientBroker::RemoveClient(const Client *client) {
-  m_clients.erase(client);
+  m_clients.RemoveOwner(client);
 }
 
 void ClientBroker::SendRDMRequest(const Client *client,
                                   Universe *universe,
                                   ola::rdm::RDMRequest *request,
                                   ola::rdm::RDMCallback *callback) {
-  if (!STLContains(m_clients, client)) {
+  if (!m_clients.Contains(client)) {
     OLA_WARN << "Making an RDM call but the client doesn't exist in the "
              << "broker!";
   }
 
   universe->SendRDMRequest(
       request,
-      NewSingleCallback(this, &ClientBroker::RequestComplete, client,
-                        callback));
+      NewSingleCallback(&ClientBroker::RequestComplete,
+                        m_clients.Start(client), callback));
 }
 
 void ClientBroker::RunRDMDiscovery(const Client *client,
                                    Universe *universe,
                                    bool full_discovery,
                                    ola::rdm::RDMDiscoveryCallback *callback) {
-  if (!STLContains(m_clients, client)) {
+  if (!m_clients.Contains(client)) {
     OLA_WARN << "Running RDM discovery but the client doesn't exist in the "
              << "broker!";
   }
 
   universe->RunRDMDiscovery(
-      NewSingleCallback(this, &ClientBroker::DiscoveryComplete, client,
-                        callback),
+      NewSingleCallback(&ClientBroker::DiscoveryComplete,
+                        m_clients.Start(client), callback),
       full_discovery);
 }
 
@@ -76,10 +73,10 @@ void ClientBroker::RunRDMDiscovery(const Client *client,
  * @param code the code of the RDM request
  * @param response the RDM response
  */
-void ClientBroker::RequestComplete(const Client *client,
+void ClientBroker::RequestComplete(PendingRequest *pending_request,
                                    ola::rdm::RDMCallback *callback,
                                    ola::rdm::RDMReply *reply) {
-  if (!STLContains(m_clients, client)) {
+  if (!PendingRequestTracker<Client>::Finish(pending_request)) {
     OLA_DEBUG << "Client no longer exists, cleaning up from RDM response";
     delete callback;
   } else {
@@ -88,10 +85,10 @@ void ClientBroker::RequestComplete(const Client *client,
 }
 
 void ClientBroker::DiscoveryComplete(
-    const Client *client,
+    PendingRequest *pending_request,
     ola::rdm::RDMDiscoveryCallback *callback,
     const ola::rdm::UIDSet &uids) {
-  if (!STLContains(m_clients, client)) {
+  if (!PendingRequestTracker<Client>::Finish(pending_request)) {
     OLA_DEBUG << "Client no longer exists, cleaning up from RDM discovery";
     delete callback;
   } else {
@@ -24,7 +24,6 @@
 #ifndef OLAD_CLIENTBROKER_H_
 #define OLAD_CLIENTBROKER_H_
 
-#include <set>
 #include <string>
 #include <vector>
 #include "ola/base/Macro.h"
@@ -33,6 +32,7 @@
 #include "ola/Callback.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/PendingRequestTracker.h"
 
 namespace ola {
 
@@ -63,9 +63,19 @@ class ClientBroker {
   /**
    * @brief Remove a client from the broker.
    * @param client The Client to remove.
+   *
+   * The callbacks for any calls still in flight for the client will be
+   * deleted rather than run.
    */
   void RemoveClient(const Client *client);
 
+  /**
+   * @brief The number of RDM calls in flight for a client.
+   */
+  unsigned int PendingRequests(const Client *client) const {
+    return m_clients.Outstanding(client);
+  }
+
   /**
    * @brief Make an RDM call.
    * @param client the Client responsible for making the call.
@@ -93,17 +103,16 @@ class ClientBroker {
                        ola::rdm::RDMDiscoveryCallback *callback);
 
  private:
-  typedef std::set<const Client*> client_set;
-
-  client_set m_clients;
+  PendingRequestTracker<Client> m_clients;
 
-  void RequestComplete(const Client *key,
-                       ola::rdm::RDMCallback *callback,
-                       ola::rdm::RDMReply *reply);
+  // These are static since they may run after the broker is destroyed.
+  static void RequestComplete(PendingRequest *pending_request,
+                              ola::rdm::RDMCallback *callback,
+                              ola::rdm::RDMReply *reply);
 
-  void DiscoveryComplete(const Client *key,
-                         ola::rdm::RDMDiscoveryCallback *on_complete,
-                         const ola::rdm::UIDSet &uids);
+  static void DiscoveryComplete(PendingRequest *pending_request,
+                                ola::rdm::RDMDiscoveryCallback *on_complete,
+                                const ola::rdm::UIDSet &uids);
 
   DISALLOW_COPY_AND_ASSIGN(ClientBroker);
 };
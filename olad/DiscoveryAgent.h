@@ -23,8 +23,10 @@
 
 #include <stdint.h>
 #include <ola/base/Macro.h>
+#include <ola/network/IPV4Address.h>
 #include <string>
 #include <map>
+#include <vector>
 
 namespace ola {
 
@@ -91,6 +93,49 @@ class DiscoveryAgentInterface {
                                const std::string &type,
                                uint16_t port,
                                const RegisterOptions &options) = 0;
+
+  /**
+   * @brief A service instance found by browsing.
+   */
+  struct ServiceInfo {
+    std::string name;  /**< The instance name */
+    std::string type;  /**< The service type that was browsed */
+    std::string domain;  /**< The domain the service is in */
+    std::string host;  /**< The host name the service is on */
+    /**
+     * @brief The address of the host, or the wildcard address if the
+     * implementation doesn't resolve addresses.
+     */
+    ola::network::IPV4Address address;
+    uint16_t port;  /**< The port the service is on */
+    int if_index;  /**< The interface the service was found on */
+    RegisterOptions::TxtData txt_data;   /**< The TXT record data. */
+
+    ServiceInfo()
+        : port(0),
+          if_index(RegisterOptions::ALL_INTERFACES) {
+    }
+  };
+
+  /**
+   * @brief Start browsing for a service type.
+   * @param type the service type, e.g. _http._tcp
+   * @returns true if the type is being browsed, false if browsing failed.
+   *
+   * The services that are found are cached until they leave the network, so
+   * GetServices() can answer without a network round trip. Browsing a type
+   * that is already being browsed does nothing.
+   */
+  virtual bool BrowseServices(const std::string &type) = 0;
+
+  /**
+   * @brief Get the cached services of a type.
+   * @param type the service type, as passed to BrowseServices().
+   * @param[out] services the services that have been found so far.
+   * @returns true if the type is being browsed, false otherwise.
+   */
+  virtual bool GetServices(const std::string &type,
+                           std::vector<ServiceInfo> *services) = 0;
 };
 
 /**
@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DiscoveryCache.cpp
+ * Caches the services found by DNS-SD browsing.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/DiscoveryCache.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+
+using ola::thread::MutexLocker;
+using std::string;
+using std::vector;
+
+DiscoveryCache::DiscoveryCache(const Clock *clock)
+    : m_clock(clock) {
+}
+
+bool DiscoveryCache::AddType(const string &type) {
+  MutexLocker locker(&m_mutex);
+  return STLInsertIfNotPresent(&m_types, type, ServiceMap());
+}
+
+bool DiscoveryCache::HasType(const string &type) const {
+  MutexLocker locker(&m_mutex);
+  return STLContains(m_types, type);
+}
+
+void DiscoveryCache::UpdateService(const ServiceInfo &service) {
+  MutexLocker locker(&m_mutex);
+  ServiceMap *services = STLFind(&m_types, service.type);
+  if (!services) {
+    return;
+  }
+
+  CachedService &entry = (*services)[
+      ServiceKey(service.name, service.domain, service.if_index)];
+  entry.info = service;
+  entry.expires = TimeStamp();
+}
+
+void DiscoveryCache::RemoveService(const string &type,
+                                   const string &name,
+                                   const string &domain,
+                                   int if_index) {
+  MutexLocker locker(&m_mutex);
+  ServiceMap *services = STLFind(&m_types, type);
+  if (services) {
+    services->erase(ServiceKey(name, domain, if_index));
+  }
+}
+
+void DiscoveryCache::MarkStale(const TimeInterval &timeout) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  const TimeStamp expires = now + timeout;
+
+  MutexLocker locker(&m_mutex);
+  TypeMap::iterator type_iter = m_types.begin();
+  for (; type_iter != m_types.end(); ++type_iter) {
+    ServiceMap::iterator iter = type_iter->second.begin();
+    for (; iter != type_iter->second.end(); ++iter) {
+      if (!iter->second.expires.IsSet() || expires < iter->second.expires) {
+        iter->second.expires = expires;
+      }
+    }
+  }
+}
+
+bool DiscoveryCache::GetServices(const string &type,
+                                 vector<ServiceInfo> *services) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  MutexLocker locker(&m_mutex);
+  ServiceMap *cached = STLFind(&m_types, type);
+  if (!cached) {
+    return false;
+  }
+
+  ServiceMap::iterator iter = cached->begin();
+  while (iter != cached->end()) {
+    if (iter->second.expires.IsSet() && iter->second.expires <= now) {
+      cached->erase(iter++);
+    } else {
+      services->push_back(iter->second.info);
+      ++iter;
+    }
+  }
+  return true;
+}
+
+string DiscoveryCache::ServiceKey(const string &name,
+                                  const string &domain,
+                                  int if_index) {
+  std::ostringstream str;
+  str << name << "." << domain << "%" << if_index;
+  return str.str();
+}
+}  // namespace ola
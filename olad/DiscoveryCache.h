@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DiscoveryCache.h
+ * Caches the services found by DNS-SD browsing.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_DISCOVERYCACHE_H_
+#define OLAD_DISCOVERYCACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/Mutex.h"
+#include "olad/DiscoveryAgent.h"
+
+namespace ola {
+
+/**
+ * @brief Holds the services found by the browse operations of a
+ * DiscoveryAgent.
+ *
+ * Services stay in the cache until they're removed, which happens when the
+ * DNS-SD daemon reports they've left the network. If the agent loses its
+ * connection to the daemon it calls MarkStale(), after which the services
+ * expire unless they're seen again within the timeout.
+ *
+ * The methods are thread safe, since the agents update the cache from their
+ * own thread.
+ */
+class DiscoveryCache {
+ public:
+  typedef DiscoveryAgentInterface::ServiceInfo ServiceInfo;
+
+  explicit DiscoveryCache(const Clock *clock);
+  ~DiscoveryCache() {}
+
+  /**
+   * @brief Start caching services of a type.
+   * @returns true if the type was added, false if it was already present.
+   */
+  bool AddType(const std::string &type);
+
+  /**
+   * @brief Check if services of a type are being cached.
+   */
+  bool HasType(const std::string &type) const;
+
+  /**
+   * @brief Add or refresh a service.
+   *
+   * Services of types that haven't been added are ignored.
+   */
+  void UpdateService(const ServiceInfo &service);
+
+  /**
+   * @brief Remove a service.
+   */
+  void RemoveService(const std::string &type,
+                     const std::string &name,
+                     const std::string &domain,
+                     int if_index);
+
+  /**
+   * @brief Expire all the services after timeout, unless they're updated
+   * before then.
+   */
+  void MarkStale(const TimeInterval &timeout);
+
+  /**
+   * @brief Get the cached services of a type.
+   * @returns true if the type has been added, false otherwise.
+   */
+  bool GetServices(const std::string &type,
+                   std::vector<ServiceInfo> *services);
+
+ private:
+  struct CachedService {
+    ServiceInfo info;
+    // Unset if the service doesn't expire.
+    TimeStamp expires;
+  };
+
+  // Keyed by the name, domain & interface.
+  typedef std::map<std::string, CachedService> ServiceMap;
+  typedef std::map<std::string, ServiceMap> TypeMap;
+
+  const Clock *m_clock;
+  mutable ola::thread::Mutex m_mutex;
+  TypeMap m_types;
+
+  static std::string ServiceKey(const std::string &name,
+                                const std::string &domain,
+                                int if_index);
+
+  DISALLOW_COPY_AND_ASSIGN(DiscoveryCache);
+};
+}  // namespace ola
+#endif  // OLAD_DISCOVERYCACHE_H_
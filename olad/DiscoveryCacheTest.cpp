@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DiscoveryCacheTest.cpp
+ * Test fixture for the DiscoveryCache class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "olad/DiscoveryCache.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::DiscoveryCache;
+using ola::MockClock;
+using ola::TimeInterval;
+using std::string;
+using std::vector;
+
+class DiscoveryCacheTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DiscoveryCacheTest);
+  CPPUNIT_TEST(testUpdateAndRemove);
+  CPPUNIT_TEST(testStaleServices);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testUpdateAndRemove();
+    void testStaleServices();
+
+ private:
+    MockClock m_clock;
+
+    DiscoveryCache::ServiceInfo Service(const string &name, int if_index) {
+      DiscoveryCache::ServiceInfo service;
+      service.name = name;
+      service.type = "_http._tcp";
+      service.domain = "local";
+      service.host = name + ".local";
+      service.port = 9090;
+      service.if_index = if_index;
+      return service;
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DiscoveryCacheTest);
+
+
+/*
+ * Check that services are added, refreshed and removed.
+ */
+void DiscoveryCacheTest::testUpdateAndRemove() {
+  DiscoveryCache cache(&m_clock);
+  vector<DiscoveryCache::ServiceInfo> services;
+
+  OLA_ASSERT_FALSE(cache.HasType("_http._tcp"));
+  OLA_ASSERT_FALSE(cache.GetServices("_http._tcp", &services));
+
+  // Services of unknown types are ignored.
+  cache.UpdateService(Service("foo", 1));
+  OLA_ASSERT_TRUE(cache.AddType("_http._tcp"));
+  OLA_ASSERT_FALSE(cache.AddType("_http._tcp"));
+  OLA_ASSERT_TRUE(cache.HasType("_http._tcp"));
+  OLA_ASSERT_TRUE(cache.GetServices("_http._tcp", &services));
+  OLA_ASSERT_EMPTY(services);
+
+  // The same service on two interfaces is two entries.
+  cache.UpdateService(Service("foo", 1));
+  cache.UpdateService(Service("foo", 2));
+  DiscoveryCache::ServiceInfo bar = Service("bar", 1);
+  cache.UpdateService(bar);
+  OLA_ASSERT_TRUE(cache.GetServices("_http._tcp", &services));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), services.size());
+
+  // A refresh replaces the entry.
+  bar.port = 8080;
+  bar.txt_data["path"] = "/";
+  cache.UpdateService(bar);
+  services.clear();
+  cache.GetServices("_http._tcp", &services);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), services.size());
+  OLA_ASSERT_EQ(string("bar"), services[0].name);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(8080), services[0].port);
+  OLA_ASSERT_EQ(string("/"), services[0].txt_data["path"]);
+
+  cache.RemoveService("_http._tcp", "foo", "local", 2);
+  cache.RemoveService("_http._tcp", "baz", "local", 1);
+  services.clear();
+  cache.GetServices("_http._tcp", &services);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), services.size());
+  OLA_ASSERT_EQ(string("bar"), services[0].name);
+  OLA_ASSERT_EQ(string("foo"), services[1].name);
+  OLA_ASSERT_EQ(1, services[1].if_index);
+}
+
+
+/*
+ * Check that stale services expire unless they're seen again.
+ */
+void DiscoveryCacheTest::testStaleServices() {
+  DiscoveryCache cache(&m_clock);
+  vector<DiscoveryCache::ServiceInfo> services;
+
+  cache.AddType("_http._tcp");
+  cache.UpdateService(Service("foo", 1));
+  cache.UpdateService(Service("bar", 1));
+
+  // Services don't expire until they're marked as stale.
+  m_clock.AdvanceTime(3600, 0);
+  cache.GetServices("_http._tcp", &services);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), services.size());
+
+  cache.MarkStale(TimeInterval(10, 0));
+  m_clock.AdvanceTime(5, 0);
+  cache.UpdateService(Service("bar", 1));
+
+  // A second MarkStale doesn't extend the timeout.
+  cache.MarkStale(TimeInterval(30, 0));
+  m_clock.AdvanceTime(6, 0);
+
+  services.clear();
+  cache.GetServices("_http._tcp", &services);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), services.size());
+  OLA_ASSERT_EQ(string("bar"), services[0].name);
+
+  m_clock.AdvanceTime(30, 0);
+  services.clear();
+  cache.GetServices("_http._tcp", &services);
+  OLA_ASSERT_EMPTY(services);
+}
@@ -0,0 +1,441 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxStreamHTTPModule.cpp
+ * Streams live DMX data to HTTP clients as server-sent events.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxStreamHTTPModule.h"
+#include "olad/OladHTTPServer.h"
+
+namespace ola {
+
+using ola::client::DMXMetadata;
+using ola::client::Result;
+using ola::http::HTTPEventStream;
+using ola::http::HTTPRequest;
+using ola::http::HTTPResponse;
+using ola::http::HTTPServer;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+const unsigned int DmxStreamHTTPModule::DEFAULT_RATE;
+const unsigned int DmxStreamHTTPModule::MAX_RATE;
+const unsigned int DmxStreamHTTPModule::MAX_QUEUED_BYTES;
+const unsigned int DmxStreamHTTPModule::KEEPALIVE_INTERVAL_MS;
+const char DmxStreamHTTPModule::DMX_EVENT[] = "dmx";
+
+namespace {
+
+// The size of a run header, runs separated by fewer unchanged slots than
+// this are merged.
+const unsigned int RUN_HEADER_SIZE = 4;
+
+const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void AppendUInt16(uint16_t value, string *output) {
+  output->push_back(static_cast<char>(value >> 8));
+  output->push_back(static_cast<char>(value & 0xff));
+}
+
+void AppendUInt32(uint32_t value, string *output) {
+  AppendUInt16(static_cast<uint16_t>(value >> 16), output);
+  AppendUInt16(static_cast<uint16_t>(value & 0xffff), output);
+}
+
+void SetUInt16(uint16_t value, size_t offset, string *output) {
+  (*output)[offset] = static_cast<char>(value >> 8);
+  (*output)[offset + 1] = static_cast<char>(value & 0xff);
+}
+
+string Base64Encode(const string &input) {
+  string output;
+  output.reserve((input.size() + 2) / 3 * 4);
+  for (size_t i = 0; i < input.size(); i += 3) {
+    uint32_t block = static_cast<uint8_t>(input[i]) << 16;
+    if (i + 1 < input.size()) {
+      block |= static_cast<uint8_t>(input[i + 1]) << 8;
+    }
+    if (i + 2 < input.size()) {
+      block |= static_cast<uint8_t>(input[i + 2]);
+    }
+    output.push_back(BASE64_CHARS[(block >> 18) & 0x3f]);
+    output.push_back(BASE64_CHARS[(block >> 12) & 0x3f]);
+    output.push_back(i + 1 < input.size() ? BASE64_CHARS[(block >> 6) & 0x3f]
+                                          : '=');
+    output.push_back(i + 2 < input.size() ? BASE64_CHARS[block & 0x3f] : '=');
+  }
+  return output;
+}
+}  // namespace
+
+
+DmxStreamHTTPModule::DmxStreamHTTPModule(HTTPServer *http_server,
+                                         client::OlaClient *client)
+    : m_server(http_server),
+      m_client(client),
+      m_keepalive_timeout(ola::thread::INVALID_TIMEOUT) {
+  m_client->SetDMXCallback(NewCallback(this, &DmxStreamHTTPModule::NewDmx));
+  m_server->RegisterHandler(
+      "/stream_dmx",
+      NewCallback(this, &DmxStreamHTTPModule::StreamDmx));
+}
+
+
+/*
+ * Teardown, this is called once the HTTP server's thread has stopped.
+ */
+DmxStreamHTTPModule::~DmxStreamHTTPModule() {
+  if (m_keepalive_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_server->SelectServer()->RemoveTimeout(m_keepalive_timeout);
+  }
+
+  vector<stream_client*>::iterator iter = m_stream_clients.begin();
+  for (; iter != m_stream_clients.end(); ++iter) {
+    if ((*iter)->send_timeout != ola::thread::INVALID_TIMEOUT) {
+      m_server->SelectServer()->RemoveTimeout((*iter)->send_timeout);
+    }
+    (*iter)->stream->Close();
+    delete *iter;
+  }
+  m_stream_clients.clear();
+}
+
+
+/**
+ * @brief Start streaming DMX data for one or more universes.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int DmxStreamHTTPModule::StreamDmx(const HTTPRequest *request,
+                                   HTTPResponse *response) {
+  if (request->CheckParameterExists(OladHTTPServer::HELP_PARAMETER)) {
+    return OladHTTPServer::ServeUsage(
+        response, "?u=[universe],[universe]...&rate=[events per second]");
+  }
+
+  vector<string> universe_strings;
+  StringSplit(request->GetParameter("u"), &universe_strings, ",");
+  set<unsigned int> universes;
+  vector<string>::const_iterator iter = universe_strings.begin();
+  for (; iter != universe_strings.end(); ++iter) {
+    unsigned int universe;
+    if (!StringToInt(*iter, &universe)) {
+      return OladHTTPServer::ServeHelpRedirect(response);
+    }
+    universes.insert(universe);
+  }
+  if (universes.empty()) {
+    return OladHTTPServer::ServeHelpRedirect(response);
+  }
+
+  unsigned int rate = DEFAULT_RATE;
+  if (request->CheckParameterExists("rate") &&
+      (!StringToInt(request->GetParameter("rate"), &rate) || rate == 0)) {
+    return OladHTTPServer::ServeHelpRedirect(response);
+  }
+  rate = std::min(rate, MAX_RATE);
+
+  HTTPEventStream *stream = m_server->StartEventStream(response);
+  if (!stream) {
+    return MHD_YES;
+  }
+
+  stream_client *client = new stream_client();
+  client->stream = stream;
+  client->interval = TimeInterval(
+      static_cast<int64_t>(USEC_IN_SECONDS / rate));
+  client->send_timeout = ola::thread::INVALID_TIMEOUT;
+  m_stream_clients.push_back(client);
+
+  set<unsigned int>::const_iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    const unsigned int universe = *universe_iter;
+    client->sent[universe] = DmxBuffer();
+
+    map<unsigned int, universe_state>::iterator state_iter =
+        m_universes.find(universe);
+    if (state_iter == m_universes.end()) {
+      universe_state &state = m_universes[universe];
+      state.have_data = false;
+      state.clients = 1;
+      m_client->RegisterUniverse(
+          universe, client::REGISTER,
+          NewSingleCallback(this, &DmxStreamHTTPModule::RegisterComplete));
+      m_client->FetchDMX(
+          universe,
+          NewSingleCallback(this, &DmxStreamHTTPModule::HandleFetchDmx,
+                            universe));
+    } else {
+      state_iter->second.clients++;
+      if (state_iter->second.have_data) {
+        client->dirty.insert(universe);
+      }
+    }
+  }
+
+  if (m_keepalive_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_keepalive_timeout = m_server->SelectServer()->RegisterRepeatingTimeout(
+        KEEPALIVE_INTERVAL_MS,
+        NewCallback(this, &DmxStreamHTTPModule::SendKeepalives));
+  }
+
+  if (!client->dirty.empty()) {
+    ScheduleSend(client);
+  }
+  return MHD_YES;
+}
+
+
+/**
+ * @brief Encode the changes to a universe.
+ * @param universe the universe id.
+ * @param previous the data the client already has, this is empty for the
+ *   first block.
+ * @param current the new data.
+ * @param[out] output the block is appended to this.
+ * @returns true if a block was added, false if nothing changed.
+ */
+bool DmxStreamHTTPModule::EncodeUniverse(unsigned int universe,
+                                         const DmxBuffer &previous,
+                                         const DmxBuffer &current,
+                                         string *output) {
+  const size_t start = output->size();
+  AppendUInt32(universe, output);
+  AppendUInt16(current.Size(), output);
+  const size_t run_count_offset = output->size();
+  AppendUInt16(0, output);
+
+  const uint8_t *previous_data = previous.GetRaw();
+  const uint8_t *current_data = current.GetRaw();
+  const unsigned int size = current.Size();
+  uint16_t run_count = 0;
+  unsigned int slot = 0;
+  while (slot < size) {
+    if (slot < previous.Size() && previous_data[slot] == current_data[slot]) {
+      slot++;
+      continue;
+    }
+
+    // Extend the run until there are RUN_HEADER_SIZE unchanged slots.
+    unsigned int end = slot + 1;
+    unsigned int unchanged = 0;
+    for (unsigned int i = end; i < size && unchanged < RUN_HEADER_SIZE;
+         i++) {
+      if (i < previous.Size() && previous_data[i] == current_data[i]) {
+        unchanged++;
+      } else {
+        unchanged = 0;
+        end = i + 1;
+      }
+    }
+
+    AppendUInt16(slot, output);
+    AppendUInt16(end - slot, output);
+    output->append(reinterpret_cast<const char*>(current_data + slot),
+                   end - slot);
+    run_count++;
+    slot = end;
+  }
+
+  if (!run_count && previous.Size() == size) {
+    output->resize(start);
+    return false;
+  }
+  SetUInt16(run_count, run_count_offset, output);
+  return true;
+}
+
+
+/*
+ * Called when olad pushes new data for a universe we've registered for.
+ */
+void DmxStreamHTTPModule::NewDmx(const DMXMetadata &metadata,
+                                 const DmxBuffer &buffer) {
+  UpdateUniverse(metadata.universe, buffer);
+}
+
+
+void DmxStreamHTTPModule::HandleFetchDmx(unsigned int universe,
+                                         const Result &result,
+                                         const DMXMetadata&,
+                                         const DmxBuffer &buffer) {
+  if (!result.Success()) {
+    OLA_INFO << "Failed to fetch DMX for universe " << universe << ": "
+             << result.Error();
+    return;
+  }
+  UpdateUniverse(universe, buffer);
+}
+
+
+void DmxStreamHTTPModule::UpdateUniverse(unsigned int universe,
+                                         const DmxBuffer &buffer) {
+  map<unsigned int, universe_state>::iterator state_iter =
+      m_universes.find(universe);
+  if (state_iter == m_universes.end()) {
+    return;
+  }
+  state_iter->second.data = buffer;
+  state_iter->second.have_data = true;
+
+  vector<stream_client*>::iterator iter = m_stream_clients.begin();
+  for (; iter != m_stream_clients.end(); ++iter) {
+    if (STLContains((*iter)->sent, universe)) {
+      (*iter)->dirty.insert(universe);
+      ScheduleSend(*iter);
+    }
+  }
+  RemoveClosedClients();
+}
+
+
+void DmxStreamHTTPModule::RegisterComplete(const Result &result) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to register for DMX: " << result.Error();
+  }
+}
+
+
+/*
+ * Send the pending events now, or once the client's interval has passed.
+ */
+void DmxStreamHTTPModule::ScheduleSend(stream_client *client) {
+  if (client->send_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+
+  const TimeStamp *now = m_server->SelectServer()->WakeUpTime();
+  if (*now >= client->next_send) {
+    SendEvents(client);
+  } else {
+    client->send_timeout = m_server->SelectServer()->RegisterSingleTimeout(
+        client->next_send - *now,
+        NewSingleCallback(this, &DmxStreamHTTPModule::SendTimeout, client));
+  }
+}
+
+
+void DmxStreamHTTPModule::SendTimeout(stream_client *client) {
+  client->send_timeout = ola::thread::INVALID_TIMEOUT;
+  SendEvents(client);
+  RemoveClosedClients();
+}
+
+
+void DmxStreamHTTPModule::SendEvents(stream_client *client) {
+  if (client->dirty.empty() || client->stream->ClientClosed()) {
+    return;
+  }
+
+  client->next_send = *m_server->SelectServer()->WakeUpTime() +
+                      client->interval;
+  if (client->stream->QueuedBytes() > MAX_QUEUED_BYTES) {
+    // Try again later, the client gets the latest data once it catches up.
+    ScheduleSend(client);
+    return;
+  }
+
+  string frame;
+  set<unsigned int>::const_iterator iter = client->dirty.begin();
+  for (; iter != client->dirty.end(); ++iter) {
+    const universe_state *state = STLFind(&m_universes, *iter);
+    if (!state || !state->have_data) {
+      continue;
+    }
+    DmxBuffer &sent = client->sent[*iter];
+    if (EncodeUniverse(*iter, sent, state->data, &frame)) {
+      sent = state->data;
+    }
+  }
+  client->dirty.clear();
+
+  if (!frame.empty()) {
+    client->stream->SendEvent(DMX_EVENT, Base64Encode(frame));
+  }
+}
+
+
+/*
+ * Sent regularly so we notice clients that have gone away.
+ */
+bool DmxStreamHTTPModule::SendKeepalives() {
+  vector<stream_client*>::iterator iter = m_stream_clients.begin();
+  for (; iter != m_stream_clients.end(); ++iter) {
+    (*iter)->stream->SendComment("keepalive");
+  }
+  RemoveClosedClients();
+
+  if (m_stream_clients.empty()) {
+    m_keepalive_timeout = ola::thread::INVALID_TIMEOUT;
+    return false;
+  }
+  return true;
+}
+
+
+void DmxStreamHTTPModule::RemoveClosedClients() {
+  vector<stream_client*>::iterator iter = m_stream_clients.begin();
+  while (iter != m_stream_clients.end()) {
+    if ((*iter)->stream->ClientClosed()) {
+      RemoveClient(*iter);
+      iter = m_stream_clients.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+
+/*
+ * Close a client's stream and unregister from universes no one is watching.
+ */
+void DmxStreamHTTPModule::RemoveClient(stream_client *client) {
+  if (client->send_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_server->SelectServer()->RemoveTimeout(client->send_timeout);
+  }
+  client->stream->Close();
+
+  map<unsigned int, DmxBuffer>::const_iterator iter = client->sent.begin();
+  for (; iter != client->sent.end(); ++iter) {
+    map<unsigned int, universe_state>::iterator state_iter =
+        m_universes.find(iter->first);
+    if (state_iter == m_universes.end() || --state_iter->second.clients) {
+      continue;
+    }
+    m_universes.erase(state_iter);
+    m_client->RegisterUniverse(
+        iter->first, client::UNREGISTER,
+        NewSingleCallback(this, &DmxStreamHTTPModule::RegisterComplete));
+  }
+  delete client;
+}
+}  // namespace ola
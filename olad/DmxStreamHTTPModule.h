@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxStreamHTTPModule.h
+ * Streams live DMX data to HTTP clients as server-sent events.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_DMXSTREAMHTTPMODULE_H_
+#define OLAD_DMXSTREAMHTTPMODULE_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/client/OlaClient.h"
+#include "ola/http/HTTPServer.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+/*
+ * The module that streams DMX data.
+ *
+ * A client opens /stream_dmx?u=1,2 with an EventSource. The module registers
+ * for the universes with olad, so new data is pushed to it rather than
+ * polled. Each client is sent at most rate dmx events per second. The data
+ * of an event is the base64 encoding of one or more universe blocks:
+ *
+ *   universe (uint32), size (uint16), run count (uint16), then for each run
+ *   the offset (uint16), the length (uint16) and the slot values.
+ *
+ * All integers are big endian. The first block for a universe holds every
+ * slot; after that only the slots that changed are sent. A client with a
+ * full send queue is skipped until it catches up.
+ */
+class DmxStreamHTTPModule {
+ public:
+  DmxStreamHTTPModule(ola::http::HTTPServer *http_server,
+                      ola::client::OlaClient *client);
+  ~DmxStreamHTTPModule();
+
+  int StreamDmx(const ola::http::HTTPRequest *request,
+                ola::http::HTTPResponse *response);
+
+  static bool EncodeUniverse(unsigned int universe,
+                             const DmxBuffer &previous,
+                             const DmxBuffer &current,
+                             std::string *output);
+
+  static const unsigned int DEFAULT_RATE = 20;
+  static const unsigned int MAX_RATE = 44;
+
+ private:
+  typedef struct {
+    DmxBuffer data;
+    bool have_data;
+    unsigned int clients;
+  } universe_state;
+
+  typedef struct {
+    ola::http::HTTPEventStream *stream;
+    // The data the client has for each universe it's subscribed to.
+    std::map<unsigned int, DmxBuffer> sent;
+    std::set<unsigned int> dirty;
+    TimeInterval interval;
+    TimeStamp next_send;
+    ola::thread::timeout_id send_timeout;
+  } stream_client;
+
+  ola::http::HTTPServer *m_server;
+  ola::client::OlaClient *m_client;
+  std::map<unsigned int, universe_state> m_universes;
+  std::vector<stream_client*> m_stream_clients;
+  ola::thread::timeout_id m_keepalive_timeout;
+
+  void NewDmx(const client::DMXMetadata &metadata, const DmxBuffer &buffer);
+  void HandleFetchDmx(unsigned int universe,
+                      const client::Result &result,
+                      const client::DMXMetadata &metadata,
+                      const DmxBuffer &buffer);
+  void UpdateUniverse(unsigned int universe, const DmxBuffer &buffer);
+  void RegisterComplete(const client::Result &result);
+
+  void ScheduleSend(stream_client *stream_client);
+  void SendTimeout(stream_client *stream_client);
+  void SendEvents(stream_client *stream_client);
+  bool SendKeepalives();
+  void RemoveClosedClients();
+  void RemoveClient(stream_client *stream_client);
+
+  // The queue size at which a client is skipped.
+  static const unsigned int MAX_QUEUED_BYTES = 64 * 1024;
+  static const unsigned int KEEPALIVE_INTERVAL_MS = 15000;
+  static const char DMX_EVENT[];
+
+  DISALLOW_COPY_AND_ASSIGN(DmxStreamHTTPModule);
+};
+}  // namespace ola
+#endif  // OLAD_DMXSTREAMHTTPMODULE_H_
@@ -13,6 +13,9 @@ ola_server_sources = \
     olad/ClientBroker.h \
     olad/DiscoveryAgent.cpp \
     olad/DiscoveryAgent.h \
+    olad/DiscoveryCache.cpp \
+    olad/DiscoveryCache.h \
+    olad/DmxStreamHTTPModule.h \
     olad/DynamicPluginLoader.cpp \
     olad/DynamicPluginLoader.h \
     olad/HttpServerActions.h \
@@ -22,9 +25,23 @@ ola_server_sources = \
     olad/PluginLoader.h \
     olad/PluginManager.cpp \
     olad/PluginManager.h \
-    olad/RDMHTTPModule.h
+    olad/RDMDecodeCache.cpp \
+    olad/RDMDecodeCache.h \
+    olad/RDMHTTPModule.h \
+    olad/ReplicationCodec.cpp \
+    olad/ReplicationCodec.h \
+    olad/SharedDmxServer.cpp \
+    olad/SharedDmxServer.h \
+    olad/UDPStreamServer.cpp \
+    olad/UDPStreamServer.h \
+    olad/UniverseReplicator.cpp \
+    olad/UniverseReplicator.h
 ola_server_additional_libs =
 
+if HAVE_DLOPEN
+ola_server_sources += olad/ModulePluginLoader.cpp olad/ModulePluginLoader.h
+endif
+
 if HAVE_DNSSD
 ola_server_sources += olad/BonjourDiscoveryAgent.h \
                       olad/BonjourDiscoveryAgent.cpp
@@ -36,7 +53,8 @@ ola_server_additional_libs += $(avahi_LIBS)
 endif
 
 if HAVE_LIBMICROHTTPD
-ola_server_sources += olad/HttpServerActions.cpp \
+ola_server_sources += olad/DmxStreamHTTPModule.cpp \
+                      olad/HttpServerActions.cpp \
                       olad/OladHTTPServer.cpp \
                       olad/RDMHTTPModule.cpp
 ola_server_additional_libs += common/http/libolahttp.la
@@ -83,9 +101,17 @@ COMMON_OLAD_TEST_LDADD = $(COMMON_TESTING_LIBS) $(libprotobuf_LIBS) \
                          common/libolacommon.la
 
 olad_OlaTester_SOURCES = \
+    olad/DiscoveryCacheTest.cpp \
     olad/PluginManagerTest.cpp \
-    olad/OlaServerServiceImplTest.cpp
+    olad/OlaServerServiceImplTest.cpp \
+    olad/RDMDecodeCacheTest.cpp \
+    olad/ReplicationCodecTest.cpp
 olad_OlaTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
 olad_OlaTester_LDADD = $(COMMON_OLAD_TEST_LDADD)
 
-CLEANFILES += olad/ola-output.conf
+CLEANFILES += \
+    olad/ola-coalesced.conf \
+    olad/ola-output.conf \
+    olad/ola-preferences.snapshot \
+    olad/ola-snapshot.conf \
+    olad/ola-state.bin
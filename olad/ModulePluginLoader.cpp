@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ModulePluginLoader.cpp
+ * Loads plugins that are built as loadable modules.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <dlfcn.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/file/Util.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/ModulePluginLoader.h"
+#include "olad/Plugin.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PluginModule.h"
+#include "olad/Preferences.h"
+
+namespace ola {
+
+using std::string;
+using std::vector;
+
+const char ModulePluginLoader::MODULE_PREFIX[] = "olaplugin_";
+const char ModulePluginLoader::MODULE_SUFFIX[] = ".so";
+
+ModulePluginLoader::~ModulePluginLoader() {
+  UnloadPlugins();
+}
+
+vector<AbstractPlugin*> ModulePluginLoader::LoadPlugins() {
+  if (!m_plugins.empty()) {
+    return m_plugins;
+  }
+
+  vector<string> files;
+  if (!ola::file::FindMatchingFiles(m_directory, MODULE_PREFIX, &files)) {
+    OLA_WARN << "Failed to list plugin modules in " << m_directory;
+    return m_plugins;
+  }
+
+  vector<string>::const_iterator iter = files.begin();
+  for (; iter != files.end(); ++iter) {
+    if (StringEndsWith(*iter, MODULE_SUFFIX)) {
+      LoadModule(*iter);
+    }
+  }
+  return m_plugins;
+}
+
+void ModulePluginLoader::UnloadPlugins() {
+  // The plugins must be deleted before their code is unmapped.
+  STLDeleteElements(&m_plugins);
+  vector<void*>::iterator iter = m_modules.begin();
+  for (; iter != m_modules.end(); ++iter) {
+    dlclose(*iter);
+  }
+  m_modules.clear();
+}
+
+/*
+ * Check if the plugin with the given prefix has been disabled. If the
+ * preferences don't exist yet, the module is loaded so the plugin can set the
+ * defaults.
+ */
+bool ModulePluginLoader::IsDisabled(const string &prefix) const {
+  if (!m_plugin_adaptor) {
+    return false;
+  }
+  Preferences *preferences = m_plugin_adaptor->NewPreference(prefix);
+  preferences->Load();
+  const string enabled_key = "enabled";
+  return (preferences->HasKey(enabled_key) &&
+          !preferences->GetValueAsBool(enabled_key));
+}
+
+void ModulePluginLoader::LoadModule(const string &path) {
+  string filename = ola::file::FilenameFromPath(path);
+  string prefix = filename.substr(strlen(MODULE_PREFIX));
+  prefix.erase(prefix.size() - strlen(MODULE_SUFFIX));
+  if (prefix.empty()) {
+    return;
+  }
+
+  if (IsDisabled(prefix)) {
+    OLA_INFO << "Not loading " << path << " since " << prefix
+             << " is disabled";
+    return;
+  }
+
+  void *module = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!module) {
+    OLA_WARN << "Failed to load " << path << ": " << dlerror();
+    return;
+  }
+
+  ola_plugin_abi_version_t *abi_version =
+      reinterpret_cast<ola_plugin_abi_version_t*>(
+          dlsym(module, OLA_PLUGIN_ABI_VERSION_SYMBOL));
+  ola_plugin_create_t *create = reinterpret_cast<ola_plugin_create_t*>(
+      dlsym(module, OLA_PLUGIN_CREATE_SYMBOL));
+  if (!(abi_version && create)) {
+    OLA_WARN << path << " isn't an OLA plugin module";
+    dlclose(module);
+    return;
+  }
+
+  unsigned int version = abi_version();
+  if (version != OLA_PLUGIN_ABI_VERSION) {
+    OLA_WARN << path << " was built for plugin ABI version " << version
+             << ", expected " << OLA_PLUGIN_ABI_VERSION;
+    dlclose(module);
+    return;
+  }
+
+  AbstractPlugin *plugin = create(m_plugin_adaptor);
+  if (!plugin) {
+    OLA_WARN << "Failed to create the plugin from " << path;
+    dlclose(module);
+    return;
+  }
+  OLA_INFO << "Loaded plugin module " << path;
+  m_modules.push_back(module);
+  m_plugins.push_back(plugin);
+}
+}  // namespace ola
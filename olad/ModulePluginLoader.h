@@ -0,0 +1,65 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ModulePluginLoader.h
+ * Loads plugins that are built as loadable modules.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_MODULEPLUGINLOADER_H_
+#define OLAD_MODULEPLUGINLOADER_H_
+
+#include <string>
+#include <vector>
+#include "ola/base/Macro.h"
+#include "olad/PluginLoader.h"
+
+namespace ola {
+
+/**
+ * @brief A PluginLoader which loads plugin modules from a directory.
+ *
+ * Each module is named olaplugin_<prefix>.so, where prefix is the
+ * PluginPrefix() of the plugin it contains. Before a module is opened, the
+ * preferences for the prefix are checked, and a module whose plugin has been
+ * disabled isn't opened at all. A module is only used if it was built with
+ * the same OLA_PLUGIN_ABI_VERSION as olad.
+ */
+class ModulePluginLoader: public PluginLoader {
+ public:
+  explicit ModulePluginLoader(const std::string &directory)
+      : m_directory(directory) {
+  }
+  ~ModulePluginLoader();
+
+  std::vector<class AbstractPlugin*> LoadPlugins();
+
+  void UnloadPlugins();
+
+ private:
+  const std::string m_directory;
+  std::vector<class AbstractPlugin*> m_plugins;
+  std::vector<void*> m_modules;
+
+  bool IsDisabled(const std::string &prefix) const;
+  void LoadModule(const std::string &path);
+
+  static const char MODULE_PREFIX[];
+  static const char MODULE_SUFFIX[];
+
+  DISALLOW_COPY_AND_ASSIGN(ModulePluginLoader);
+};
+}  // namespace ola
+#endif  // OLAD_MODULEPLUGINLOADER_H_
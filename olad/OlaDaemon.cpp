@@ -42,6 +42,9 @@
 #include "ola/stl/STLUtils.h"
 
 #include "olad/DynamicPluginLoader.h"
+#ifdef HAVE_DLOPEN
+#include "olad/ModulePluginLoader.h"
+#endif  // HAVE_DLOPEN
 #include "olad/OlaDaemon.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/PluginLoader.h"
@@ -50,6 +53,15 @@
 DEFINE_s_string(config_dir, c, "",
                 "The path to the config directory, defaults to ~/.ola/ " \
                 "on *nix and %LOCALAPPDATA%\\.ola\\ on Windows.");
+DEFINE_default_bool(config_snapshot, false,
+                    "Also save the preferences to a single snapshot file, "
+                    "which is used to load them at startup.");
+DEFINE_default_bool(warm_restart, false,
+                    "Save the DMX data and RDM UIDs of each universe, and "
+                    "restore them at startup.");
+DEFINE_string(plugin_dir, "",
+              "Load plugin modules from this directory. Modules take "
+              "precedence over the built in plugins.");
 
 namespace ola {
 
@@ -62,6 +74,7 @@ using std::auto_ptr;
 using std::string;
 
 const char OlaDaemon::OLA_CONFIG_DIR[] = ".ola";
+const char OlaDaemon::STATE_FILE[] = "ola-state.bin";
 const char OlaDaemon::CONFIG_DIR_KEY[] = "config-dir";
 const char OlaDaemon::UID_KEY[] = "uid";
 const char OlaDaemon::GID_KEY[] = "gid";
@@ -123,14 +136,24 @@ bool OlaDaemon::Init() {
     m_export_map->GetStringVar(CONFIG_DIR_KEY)->Set(config_dir);
   }
   auto_ptr<PreferencesFactory> preferences_factory(
-      new FileBackedPreferencesFactory(config_dir));
+      new FileBackedPreferencesFactory(config_dir, FLAGS_config_snapshot));
+
+  OlaServer::Options options = m_options;
+  if (FLAGS_warm_restart) {
+    options.state_file = ola::file::JoinPaths(config_dir, STATE_FILE);
+  }
 
   // Order is important here as we won't load the same plugin twice.
+#ifdef HAVE_DLOPEN
+  if (!FLAGS_plugin_dir.str().empty()) {
+    m_plugin_loaders.push_back(new ModulePluginLoader(FLAGS_plugin_dir));
+  }
+#endif  // HAVE_DLOPEN
   m_plugin_loaders.push_back(new DynamicPluginLoader());
 
   auto_ptr<OlaServer> server(
       new OlaServer(m_plugin_loaders,
-                    preferences_factory.get(), &m_ss, m_options,
+                    preferences_factory.get(), &m_ss, options,
                     NULL, m_export_map));
 
   bool ok = server->Init();
@@ -100,6 +100,7 @@ class OlaDaemon {
   bool InitConfigDir(const std::string &path);
 
   static const char OLA_CONFIG_DIR[];
+  static const char STATE_FILE[];
   static const char CONFIG_DIR_KEY[];
   static const char UID_KEY[];
   static const char USER_NAME_KEY[];
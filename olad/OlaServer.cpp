@@ -23,10 +23,18 @@
 #endif  // HAVE_CONFIG_H
 
 #include <errno.h>
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif  // HAVE_MALLOC_H
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
 #include <memory>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -37,12 +45,16 @@
 #include "ola/Constants.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Flags.h"
+#include "ola/dmx/SourcePriorities.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
+#include "ola/thread/Thread.h"
+#include "ola/web/JsonStreamWriter.h"
 #include "olad/ClientBroker.h"
 #include "olad/DiscoveryAgent.h"
 #include "olad/OlaServer.h"
@@ -53,11 +65,23 @@
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
+#include "olad/SharedDmxServer.h"
+#include "olad/UDPStreamServer.h"
 #include "olad/Universe.h"
+#include "olad/UniverseReplicator.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/DiscoveryScheduler.h"
+#include "olad/plugin_api/FadeEngine.h"
+#include "olad/plugin_api/FrameClock.h"
+#include "olad/plugin_api/FrameHistory.h"
+#include "olad/plugin_api/InputTrace.h"
+#include "olad/plugin_api/PluginThread.h"
 #include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/RDMPoller.h"
+#include "olad/plugin_api/TimeCodeGenerator.h"
 #include "olad/plugin_api/UniverseStore.h"
+#include "olad/plugin_api/VirtualUniverseManager.h"
 
 #ifdef HAVE_LIBMICROHTTPD
 #include "olad/OladHTTPServer.h"
@@ -65,28 +89,97 @@
 
 DEFINE_s_uint16(rpc_port, r, ola::OlaServer::DEFAULT_RPC_PORT,
                 "The port to listen for RPCs on. Defaults to 9010.");
+DEFINE_uint32(rpc_stream_window, ola::OlaServer::DEFAULT_RPC_STREAM_WINDOW,
+              "The number of streamed DMX updates a client may have in "
+              "flight, 0 means unlimited.");
+DEFINE_string(rpc_socket, "",
+              "Also listen for RPCs on this unix domain socket. Paths "
+              "starting with '@' are in the Linux abstract namespace.");
+DEFINE_default_bool(rpc_socket_allow_other_users, false,
+                    "Allow other users to connect to the RPC unix domain "
+                    "socket.");
+DEFINE_uint32(rdm_discovery_limit, ola::OlaServer::DEFAULT_RDM_DISCOVERY_LIMIT,
+              "The number of ports that may run RDM discovery at once, 0 "
+              "means unlimited.");
+DEFINE_uint32(rdm_poll_interval, 0,
+              "Poll the RDM devices on each universe for their sensors & "
+              "status, taking this many seconds per cycle. 0 disables "
+              "polling.");
+DEFINE_uint8(rdm_poll_max_priority, ola::dmx::SOURCE_PRIORITY_MAX,
+             "Don't poll the RDM devices on universes with a DMX priority "
+             "above this.");
+DEFINE_uint32(transmit_pace_window_ms, 0,
+              "Spread the network packets sent for each frame over this many "
+              "milliseconds, to avoid bursts. 0 disables pacing.");
+DEFINE_uint32(transmit_rate_limit_kbps, 0,
+              "The maximum rate of network output on each interface, in "
+              "kbit/s. 0 means unlimited.");
+DEFINE_uint16(replication_port, 0,
+              "Accept universes replicated from other olad nodes on this UDP "
+              "& TCP port. 0 disables this.");
+DEFINE_string(replication_peers, "",
+              "A comma separated list of ip:port of the olad nodes to "
+              "replicate universes to.");
+DEFINE_string(replicate_universes, "",
+              "A comma separated list of the universes to replicate to the "
+              "replication peers.");
+DEFINE_uint32(replication_keyframe_interval,
+              ola::UniverseReplicator::DEFAULT_KEYFRAME_INTERVAL,
+              "Send a complete frame at least every this many replicated "
+              "frames, the others only carry the changed slots.");
+DEFINE_uint32(frame_clock_rate, 0,
+              "Send the output of the universes that use the frame clock "
+              "together, this many times a second. 0 disables the clock.");
+DEFINE_string(frame_clock_source, "internal",
+              "What the frame clock is locked to, either internal or "
+              "timecode. When locked to timecode, the clock ticks with each "
+              "frame of timecode olad sends, and runs at the frame clock "
+              "rate if the timecode stops.");
+DEFINE_uint32(frame_history_size, 0,
+              "Keep a history of the frames sent by each universe, using up "
+              "to this many kB. 0 disables the history.");
+DEFINE_string(input_trace, "",
+              "Record the DMX data each universe receives to this file, so "
+              "it can be replayed with universe_replay.");
+DEFINE_default_bool(reload_plugins_on_interface_change, false,
+                    "Reload the plugins when a network interface is added, "
+                    "removed or re-addressed.");
 DEFINE_default_bool(register_with_dns_sd, true,
                     "Don't register the web service using DNS-SD (Bonjour).");
+DEFINE_string(dns_sd_browse, "",
+              "A comma separated list of DNS-SD service types to browse for "
+              "on startup. The services found are returned by the "
+              "GetDiscoveredServices RPC.");
 
 namespace ola {
 
 using ola::proto::OlaClientService_Stub;
+using ola::network::TransmitPacer;
 using ola::rdm::RootPidStore;
 using ola::rpc::RpcChannel;
 using ola::rpc::RpcSession;
 using ola::rpc::RpcServer;
+using ola::web::JsonStreamWriter;
 using std::auto_ptr;
+using std::map;
 using std::pair;
+using std::string;
 using std::vector;
 
 const char OlaServer::INSTANCE_NAME_KEY[] = "instance-name";
 const char OlaServer::K_INSTANCE_NAME_VAR[] = "server-instance-name";
 const char OlaServer::K_UID_VAR[] = "server-uid";
+const char OlaServer::K_THREAD_PLACEMENT_VAR[] = "thread-placement";
 const char OlaServer::SERVER_PREFERENCES[] = "server";
 const char OlaServer::UNIVERSE_PREFERENCES[] = "universe";
 // The Bonjour API expects <service>[,<sub-type>] so we use that form here.
 const char OlaServer::K_DISCOVERY_SERVICE_TYPE[] = "_http._tcp,_ola";
 const unsigned int OlaServer::K_HOUSEKEEPING_TIMEOUT_MS = 10000;
+const unsigned int OlaServer::K_MIN_RDM_DISCOVERY_INTERVAL_MS = 30000;
+// libmicrohttpd defaults to 32k per connection.
+const unsigned int OlaServer::LOW_MEMORY_HTTP_CONNECTION_MEMORY = 16 * 1024;
+const unsigned int OlaServer::LOW_MEMORY_HTTP_CONNECTIONS = 8;
+const int OlaServer::LOW_MEMORY_MALLOC_ARENAS = 1;
 
 OlaServer::OlaServer(const vector<PluginLoader*> &plugin_loaders,
                      PreferencesFactory *preferences_factory,
@@ -103,7 +196,15 @@ OlaServer::OlaServer(const vector<PluginLoader*> &plugin_loaders,
       m_default_uid(OPEN_LIGHTING_ESTA_CODE, 0),
       m_server_preferences(NULL),
       m_universe_preferences(NULL),
-      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT) {
+      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT),
+      m_state_universe_generation(0),
+      m_state_device_generation(0),
+      m_state_modified(0) {
+  TimeStamp now;
+  m_clock.CurrentRealTime(&now);
+  m_state_epoch = static_cast<uint64_t>(now.Seconds()) * USEC_IN_SECONDS +
+                  now.MicroSeconds();
+
   if (!m_export_map) {
     m_our_export_map.reset(new ExportMap());
     m_export_map = m_our_export_map.get();
@@ -123,13 +224,33 @@ OlaServer::~OlaServer() {
   // Order is important during shutdown.
   // Shutdown the RPC server first since it depends on almost everything else.
   m_rpc_server.reset();
+  m_udp_stream.reset();
+  m_shared_dmx.reset();
+  m_replicator.reset();
+  m_timecode_generator.reset();
+  // These remove their clients from the universes, so they go before the
+  // UniverseStore.
+  m_virtual_universes.reset();
+  m_fade_engine.reset();
+
+  if (m_interface_monitor.get()) {
+    m_interface_monitor->RemoveListener(m_interface_listener.get());
+    m_interface_monitor.reset();
+  }
 
   if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
     m_ss->RemoveTimeout(m_housekeeping_timeout);
   }
 
+  // Save the state while the ports are still patched.
+  if (m_universe_store.get() && !m_options.state_file.empty()) {
+    m_universe_store->SaveState(m_options.state_file);
+  }
+
   StopPlugins();
 
+  // The ports are gone, so there aren't any outstanding RDM requests.
+  m_rdm_poller.reset();
   m_broker.reset();
   m_port_broker.reset();
 
@@ -137,6 +258,10 @@ OlaServer::~OlaServer() {
     m_universe_store->DeleteAll();
     m_universe_store.reset();
   }
+  m_discovery_scheduler.reset();
+  m_frame_clock.reset();
+  m_frame_history.reset();
+  m_input_trace.reset();
 
   if (m_server_preferences) {
     m_server_preferences->Save();
@@ -148,9 +273,17 @@ OlaServer::~OlaServer() {
 
   m_port_manager.reset();
   m_plugin_adaptor.reset();
+  // The plugins have been stopped, so nothing is using the pacer now.
+  m_transmit_pacer.reset();
   m_device_manager.reset();
   m_plugin_manager.reset();
   m_service_impl.reset();
+
+  if (m_heartbeat.get()) {
+    m_ss->SetHeartbeat(NULL);
+    m_heartbeat.reset();
+  }
+  m_stall_watchdog.reset();
 }
 
 bool OlaServer::Init() {
@@ -167,10 +300,35 @@ bool OlaServer::Init() {
     return false;
   }
 
-  auto_ptr<const RootPidStore> pid_store(
-      RootPidStore::LoadFromDirectory(m_options.pid_data_dir));
-  if (!pid_store.get()) {
-    OLA_WARN << "No PID definitions loaded";
+#if defined(HAVE_MALLOC_H) && defined(__GLIBC__)
+  if (m_options.low_memory) {
+    // glibc gives each thread that allocates its own arena, which keeps hold
+    // of the memory freed in it. This has to happen before the plugins start
+    // their threads.
+    mallopt(M_ARENA_MAX, LOW_MEMORY_MALLOC_ARENAS);
+  }
+#endif  // defined(HAVE_MALLOC_H) && defined(__GLIBC__)
+
+  // This has to happen before the plugins start their threads.
+  if (m_options.stall_threshold_ms) {
+    ola::StallWatchdog::Options watchdog_options;
+    watchdog_options.threshold = TimeInterval(
+        static_cast<int64_t>(m_options.stall_threshold_ms) * 1000);
+    m_stall_watchdog.reset(
+        new ola::StallWatchdog(watchdog_options, m_export_map));
+    m_stall_watchdog->Start();
+    m_heartbeat.reset(new ola::Heartbeat("main"));
+    m_ss->SetHeartbeat(m_heartbeat.get());
+  }
+
+  auto_ptr<const RootPidStore> pid_store;
+  if (m_options.low_memory) {
+    OLA_INFO << "The PID definitions will be loaded when first used";
+  } else {
+    pid_store.reset(RootPidStore::LoadFromDirectory(m_options.pid_data_dir));
+    if (!pid_store.get()) {
+      OLA_WARN << "No PID definitions loaded";
+    }
   }
 
 #ifndef _WIN32
@@ -210,7 +368,31 @@ bool OlaServer::Init() {
   universe_preferences->Load();
 
   auto_ptr<UniverseStore> universe_store(
-      new UniverseStore(universe_preferences, m_export_map));
+      new UniverseStore(universe_preferences, m_export_map, m_ss,
+                        m_ss->WakeUpTime()));
+  if (!m_options.state_file.empty()) {
+    universe_store->LoadState(m_options.state_file);
+  }
+
+  auto_ptr<DiscoveryScheduler> discovery_scheduler(
+      new DiscoveryScheduler(m_export_map, &m_clock,
+                             FLAGS_rdm_discovery_limit));
+  universe_store->SetDiscoveryScheduler(discovery_scheduler.get());
+
+  const bool lock_to_timecode = FLAGS_frame_clock_source.str() == "timecode";
+  if (!lock_to_timecode && FLAGS_frame_clock_source.str() != "internal") {
+    OLA_WARN << "Unknown frame clock source " << FLAGS_frame_clock_source.str();
+    return false;
+  }
+
+  auto_ptr<FrameClock> frame_clock;
+  if (FLAGS_frame_clock_rate) {
+    frame_clock.reset(new FrameClock(m_ss, m_export_map));
+    if (!frame_clock->Start(FLAGS_frame_clock_rate)) {
+      return false;
+    }
+    universe_store->SetFrameClock(frame_clock.get());
+  }
 
   auto_ptr<PortBroker> port_broker(new PortBroker());
 
@@ -222,13 +404,92 @@ bool OlaServer::Init() {
   auto_ptr<DeviceManager> device_manager(
       new DeviceManager(m_preferences_factory, port_manager.get()));
 
+  auto_ptr<TransmitPacer> transmit_pacer;
+  if (FLAGS_transmit_pace_window_ms || FLAGS_transmit_rate_limit_kbps) {
+    TransmitPacer::Options pacer_options;
+    pacer_options.window = TimeInterval(
+        FLAGS_transmit_pace_window_ms / 1000,
+        (FLAGS_transmit_pace_window_ms % 1000) * 1000);
+    pacer_options.rate_limit = FLAGS_transmit_rate_limit_kbps * 125;
+    pacer_options.export_map = m_export_map;
+    transmit_pacer.reset(new TransmitPacer(m_ss, &m_clock, pacer_options));
+  }
+
   auto_ptr<PluginAdaptor> plugin_adaptor(
       new PluginAdaptor(device_manager.get(), m_ss, m_export_map,
                         m_preferences_factory, port_broker.get(),
-                        &m_instance_name));
+                        &m_instance_name, transmit_pacer.get()));
 
   auto_ptr<PluginManager> plugin_manager(
     new PluginManager(m_plugin_loaders, plugin_adaptor.get()));
+  if (!m_options.plugin_threads.empty()) {
+    plugin_manager->SetThreadedPlugins(m_ss, m_options.plugin_threads);
+  }
+
+  TimeCodeGenerator::TimeCodeCallback *timecode_callback;
+  if (frame_clock.get() && lock_to_timecode) {
+    timecode_callback = NewCallback(this, &OlaServer::SendTimeCode);
+  } else {
+    timecode_callback = NewCallback(device_manager.get(),
+                                    &DeviceManager::SendTimeCode);
+  }
+  auto_ptr<TimeCodeGenerator> timecode_generator(
+      new TimeCodeGenerator(m_ss, &m_clock, timecode_callback));
+
+  auto_ptr<VirtualUniverseManager> virtual_universes(
+      new VirtualUniverseManager(universe_store.get(), m_ss, &m_clock,
+                                 m_default_uid));
+
+  auto_ptr<FadeEngine> fade_engine(
+      new FadeEngine(universe_store.get(), m_ss, &m_clock, m_default_uid));
+
+  auto_ptr<RDMPoller> rdm_poller;
+  if (FLAGS_rdm_poll_interval) {
+    RDMPoller::Options poll_options;
+    poll_options.cycle_time = TimeInterval(FLAGS_rdm_poll_interval, 0);
+    poll_options.max_priority = FLAGS_rdm_poll_max_priority;
+    rdm_poller.reset(new RDMPoller(universe_store.get(), m_ss, m_default_uid,
+                                   poll_options));
+  }
+
+  auto_ptr<FrameHistory> frame_history;
+  if (FLAGS_frame_history_size) {
+    frame_history.reset(new FrameHistory(FLAGS_frame_history_size * 1024,
+                                         m_export_map));
+    universe_store->SetFrameHistory(frame_history.get());
+  }
+
+  auto_ptr<InputTrace> input_trace;
+  if (!FLAGS_input_trace.str().empty()) {
+    input_trace.reset(new InputTrace());
+    if (!input_trace->Open(FLAGS_input_trace.str())) {
+      return false;
+    }
+    universe_store->SetInputTrace(input_trace.get());
+  }
+
+  // Discovery
+  auto_ptr<DiscoveryAgentInterface> discovery_agent;
+  if (FLAGS_register_with_dns_sd) {
+    DiscoveryAgentFactory discovery_agent_factory;
+    discovery_agent.reset(discovery_agent_factory.New());
+    if (discovery_agent.get()) {
+      if (!discovery_agent->Init()) {
+        OLA_WARN << "Failed to Init DiscoveryAgent";
+        return false;
+      }
+
+      vector<string> browse_types;
+      StringSplit(FLAGS_dns_sd_browse.str(), &browse_types, ",");
+      vector<string>::iterator iter = browse_types.begin();
+      for (; iter != browse_types.end(); ++iter) {
+        StringTrim(&*iter);
+        if (!iter->empty()) {
+          discovery_agent->BrowseServices(*iter);
+        }
+      }
+    }
+  }
 
   auto_ptr<OlaServerServiceImpl> service_impl(new OlaServerServiceImpl(
       universe_store.get(),
@@ -237,13 +498,22 @@ bool OlaServer::Init() {
       port_manager.get(),
       broker.get(),
       m_ss->WakeUpTime(),
-      NewCallback(this, &OlaServer::ReloadPluginsInternal)));
+      NewCallback(this, &OlaServer::ReloadPluginsInternal),
+      timecode_generator.get(),
+      discovery_agent.get(),
+      virtual_universes.get(),
+      fade_engine.get(),
+      rdm_poller.get(),
+      frame_history.get()));
 
   // Initialize the RPC server.
   RpcServer::Options rpc_options;
   rpc_options.listen_socket = m_accepting_socket;
   rpc_options.listen_port = FLAGS_rpc_port;
   rpc_options.export_map = m_export_map;
+  rpc_options.stream_window = FLAGS_rpc_stream_window;
+  rpc_options.socket_path = FLAGS_rpc_socket.str();
+  rpc_options.socket_allow_other_users = FLAGS_rpc_socket_allow_other_users;
 
   auto_ptr<ola::rpc::RpcServer> rpc_server(
       new RpcServer(m_ss, service_impl.get(), this, rpc_options));
@@ -253,19 +523,6 @@ bool OlaServer::Init() {
     return false;
   }
 
-  // Discovery
-  auto_ptr<DiscoveryAgentInterface> discovery_agent;
-  if (FLAGS_register_with_dns_sd) {
-    DiscoveryAgentFactory discovery_agent_factory;
-    discovery_agent.reset(discovery_agent_factory.New());
-    if (discovery_agent.get()) {
-      if (!discovery_agent->Init()) {
-        OLA_WARN << "Failed to Init DiscoveryAgent";
-        return false;
-      }
-    }
-  }
-
   bool web_server_started = false;
 
   // Initializing the web server causes a call to NewClient. We need to have
@@ -298,15 +555,55 @@ bool OlaServer::Init() {
   // we save all the pointers and schedule the last of the callbacks.
   m_device_manager.reset(device_manager.release());
   m_discovery_agent.reset(discovery_agent.release());
+  m_discovery_scheduler.reset(discovery_scheduler.release());
+  m_fade_engine.reset(fade_engine.release());
+  m_frame_clock.reset(frame_clock.release());
+  m_frame_history.reset(frame_history.release());
+  m_input_trace.reset(input_trace.release());
   m_plugin_adaptor.reset(plugin_adaptor.release());
   m_plugin_manager.reset(plugin_manager.release());
   m_port_broker.reset(port_broker.release());
   m_port_manager.reset(port_manager.release());
+  m_rdm_poller.reset(rdm_poller.release());
   m_rpc_server.reset(rpc_server.release());
   m_service_impl.reset(service_impl.release());
+  m_timecode_generator.reset(timecode_generator.release());
+  m_transmit_pacer.reset(transmit_pacer.release());
   m_universe_store.reset(universe_store.release());
+  m_virtual_universes.reset(virtual_universes.release());
 
   UpdatePidStore(pid_store.release());
+  if (m_options.low_memory) {
+    m_service_impl->SetPidStoreLoader(
+        NewSingleCallback(this, &OlaServer::LoadPidStoreOnDemand));
+  }
+
+  if (m_options.shared_memory) {
+    auto_ptr<SharedDmxServer> shared_dmx(new SharedDmxServer(
+        m_ss, m_universe_store.get(), m_ss->WakeUpTime(), m_default_uid,
+        m_rpc_server->ListenAddress().V4Addr().Port()));
+    if (shared_dmx->Init()) {
+      m_shared_dmx.reset(shared_dmx.release());
+    } else {
+      OLA_WARN << "Failed to setup shared memory, local clients will use RPC";
+    }
+  }
+
+  if (m_options.udp_streaming) {
+    auto_ptr<UDPStreamServer> udp_stream(new UDPStreamServer(
+        m_ss, m_universe_store.get(), m_ss->WakeUpTime(), m_export_map));
+    if (udp_stream->Init(ola::network::IPV4SocketAddress(
+            ola::network::IPV4Address::WildCard(),
+            m_options.udp_stream_port))) {
+      m_udp_stream.reset(udp_stream.release());
+      m_service_impl->SetUDPStreamServer(m_udp_stream.get());
+    } else {
+      OLA_WARN << "Failed to setup UDP streaming, clients will use RPC";
+    }
+  }
+
+  StartReplication();
+  ExportThreadPlacements();
 
   if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
     m_ss->RemoveTimeout(m_housekeeping_timeout);
@@ -316,6 +613,19 @@ bool OlaServer::Init() {
       K_HOUSEKEEPING_TIMEOUT_MS,
       ola::NewCallback(this, &OlaServer::RunHousekeeping));
 
+  if (FLAGS_reload_plugins_on_interface_change) {
+    auto_ptr<ola::network::InterfaceMonitor> interface_monitor(
+        new ola::network::InterfaceMonitor(m_ss));
+    if (interface_monitor->Init()) {
+      m_interface_listener.reset(
+          NewCallback(this, &OlaServer::InterfacesChanged));
+      interface_monitor->AddListener(m_interface_listener.get());
+      m_interface_monitor.reset(interface_monitor.release());
+    } else {
+      OLA_WARN << "Unable to watch for interface changes";
+    }
+  }
+
   // The plugin load procedure can take a while so we run it in the main loop.
   m_ss->Execute(
       ola::NewSingleCallback(m_plugin_manager.get(), &PluginManager::LoadAll));
@@ -339,6 +649,19 @@ void OlaServer::ReloadPidStore() {
   m_ss->Execute(NewCallback(this, &OlaServer::UpdatePidStore, pid_store));
 }
 
+void OlaServer::FetchUniverseState(ola::thread::ExecutorInterface *executor,
+                                   const string &if_none_match,
+                                   UniverseStateCallback *callback) {
+  m_ss->Execute(NewSingleCallback(this, &OlaServer::WriteUniverseState,
+                                  executor, if_none_match, callback));
+}
+
+void OlaServer::FetchMemoryUsage(ola::thread::ExecutorInterface *executor,
+                                 MemoryUsageCallback *callback) {
+  m_ss->Execute(NewSingleCallback(this, &OlaServer::WriteMemoryUsage,
+                                  executor, callback));
+}
+
 void OlaServer::NewConnection(ola::io::ConnectedDescriptor *descriptor) {
   if (!descriptor) {
     return;
@@ -366,9 +689,15 @@ void OlaServer::ClientRemoved(RpcSession *session) {
   session->SetData(NULL);
 
   m_broker->RemoveClient(client.get());
+  if (m_udp_stream.get()) {
+    m_udp_stream->RemoveClient(client.get());
+  }
+  if (m_rdm_poller.get()) {
+    m_rdm_poller->RemoveClient(client.get());
+  }
 
   vector<Universe*> universe_list;
-  m_universe_store->GetList(&universe_list);
+  m_universe_store->GetUniversesWithClients(&universe_list);
   vector<Universe*>::iterator uni_iter;
 
   for (uni_iter = universe_list.begin();
@@ -378,31 +707,139 @@ void OlaServer::ClientRemoved(RpcSession *session) {
   }
 }
 
+/*
+ * Setup replication to & from other olad nodes, if it's been configured.
+ */
+void OlaServer::StartReplication() {
+  UniverseReplicator::Options options;
+  options.listen_port = FLAGS_replication_port;
+  options.keyframe_interval = FLAGS_replication_keyframe_interval;
+
+  vector<string> tokens;
+  StringSplit(FLAGS_replication_peers.str(), &tokens, ",");
+  vector<string>::const_iterator iter = tokens.begin();
+  for (; iter != tokens.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+    ola::network::IPV4SocketAddress peer;
+    if (ola::network::IPV4SocketAddress::FromString(*iter, &peer)) {
+      options.peers.push_back(peer);
+    } else {
+      OLA_WARN << "Invalid replication peer " << *iter;
+    }
+  }
+
+  tokens.clear();
+  StringSplit(FLAGS_replicate_universes.str(), &tokens, ",");
+  for (iter = tokens.begin(); iter != tokens.end(); ++iter) {
+    unsigned int universe_id;
+    if (StringToInt(*iter, &universe_id)) {
+      options.universes.push_back(universe_id);
+    } else if (!iter->empty()) {
+      OLA_WARN << "Invalid universe to replicate " << *iter;
+    }
+  }
+
+  if (!options.listen_port && options.peers.empty()) {
+    return;
+  }
+
+  auto_ptr<UniverseReplicator> replicator(new UniverseReplicator(
+      m_ss, m_universe_store.get(), m_ss->WakeUpTime(), m_default_uid,
+      options, m_export_map));
+  if (replicator->Init()) {
+    m_replicator.reset(replicator.release());
+  } else {
+    OLA_WARN << "Failed to setup universe replication";
+  }
+}
+
 /*
  * Run the garbage collector
  */
 bool OlaServer::RunHousekeeping() {
   OLA_DEBUG << "Garbage collecting";
   m_universe_store->GarbageCollectUniverses();
+  m_universe_store->CleanStaleSourceClients();
 
   // Give the universes an opportunity to run discovery
   vector<Universe*> universes;
   m_universe_store->GetList(&universes);
 
+  vector<Universe*> due_universes;
+  unsigned int periodic_universes = 0;
   vector<Universe*>::iterator iter = universes.begin();
   const TimeStamp *now = m_ss->WakeUpTime();
   for (; iter != universes.end(); ++iter) {
-    (*iter)->CleanStaleSourceClients();
-    if ((*iter)->IsActive() &&
-        (*iter)->RDMDiscoveryInterval().Seconds() &&
-        *now - (*iter)->LastRDMDiscovery() > (*iter)->RDMDiscoveryInterval()) {
-      // run incremental discovery
-      (*iter)->RunRDMDiscovery(NULL, false);
+    if ((*iter)->IsActive() && (*iter)->RDMDiscoveryInterval().Seconds()) {
+      periodic_universes++;
+      if (*now - (*iter)->LastRDMDiscovery() >
+          (*iter)->RDMDiscoveryInterval()) {
+        due_universes.push_back(*iter);
+      }
     }
   }
+
+  // Universes patched at the same time would otherwise run periodic discovery
+  // in lock step. Only start enough per run to cover every universe once per
+  // minimum discovery interval; the rest wait for a later run, which spreads
+  // them out.
+  const unsigned int runs_per_interval =
+      K_MIN_RDM_DISCOVERY_INTERVAL_MS / K_HOUSEKEEPING_TIMEOUT_MS;
+  const unsigned int max_starts =
+      (periodic_universes + runs_per_interval - 1) / runs_per_interval;
+  if (due_universes.size() > max_starts) {
+    std::partial_sort(due_universes.begin(),
+                      due_universes.begin() + max_starts,
+                      due_universes.end(), DiscoveredEarlier);
+    due_universes.resize(max_starts);
+  }
+
+  for (iter = due_universes.begin(); iter != due_universes.end(); ++iter) {
+    // run incremental discovery
+    (*iter)->RunRDMDiscovery(NULL, false);
+  }
+
+  if (!m_options.state_file.empty()) {
+    m_universe_store->SaveState(m_options.state_file);
+  }
+
+#if defined(HAVE_MALLOC_H) && defined(__GLIBC__)
+  if (m_options.low_memory) {
+    malloc_trim(0);
+  }
+#endif  // defined(HAVE_MALLOC_H) && defined(__GLIBC__)
+  ExportThreadPlacements();
   return true;
 }
 
+/*
+ * Copy the scheduling & CPU placement of the running threads into the export
+ * map, so they can be checked at /debug.
+ */
+void OlaServer::ExportThreadPlacements() {
+  map<string, string> placements;
+  ola::thread::Thread::EffectivePlacements(&placements);
+  StringMap *var = m_export_map->GetStringMapVar(K_THREAD_PLACEMENT_VAR,
+                                                 "thread");
+
+  map<string, string>::const_iterator iter = m_thread_placements.begin();
+  for (; iter != m_thread_placements.end(); ++iter) {
+    if (!STLContains(placements, iter->first)) {
+      var->Remove(iter->first);
+    }
+  }
+  for (iter = placements.begin(); iter != placements.end(); ++iter) {
+    var->Set(iter->first, iter->second);
+  }
+  m_thread_placements.swap(placements);
+}
+
+bool OlaServer::DiscoveredEarlier(const Universe *a, const Universe *b) {
+  return a->LastRDMDiscovery() < b->LastRDMDiscovery();
+}
+
 #ifdef HAVE_LIBMICROHTTPD
 bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
                                 const ola::network::Interface &iface) {
@@ -424,6 +861,14 @@ bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
   options.data_dir = (m_options.http_data_dir.empty() ? HTTP_DATA_DIR :
                       m_options.http_data_dir);
   options.enable_quit = m_options.http_enable_quit;
+  options.thread_pool_size = m_options.http_threads;
+  options.cache_static_content = m_options.http_threads > 0;
+  if (m_options.low_memory) {
+    options.thread_pool_size = 0;
+    options.cache_static_content = false;
+    options.connection_memory_limit = LOW_MEMORY_HTTP_CONNECTION_MEMORY;
+    options.connection_limit = LOW_MEMORY_HTTP_CONNECTIONS;
+  }
 
   auto_ptr<OladHTTPServer> httpd(
       new OladHTTPServer(m_export_map, options,
@@ -471,12 +916,263 @@ bool OlaServer::InternalNewConnection(
   }
 }
 
+/*
+ * Only the plugins with changed preferences are restarted, so the rest of the
+ * universes carry on without a blip.
+ */
 void OlaServer::ReloadPluginsInternal() {
   OLA_INFO << "Reloading plugins";
+  unsigned int changed_plugins = m_plugin_manager->ReloadChangedPlugins();
+  OLA_INFO << "Restarted " << changed_plugins << " plugin(s)";
+}
+
+/*
+ * Plugins bind to interfaces when they start, so restart all of them to pick
+ * up the new interfaces.
+ */
+void OlaServer::InterfacesChanged() {
+  OLA_INFO << "Network interfaces changed, restarting plugins";
   StopPlugins();
   m_plugin_manager->LoadAll();
 }
 
+/*
+ * Used instead of DeviceManager::SendTimeCode when the frame clock is locked
+ * to timecode.
+ */
+void OlaServer::SendTimeCode(const ola::timecode::TimeCode &timecode) {
+  m_device_manager->SendTimeCode(timecode);
+  m_frame_clock->ExternalTick();
+}
+
+namespace {
+
+typedef map<const AbstractDevice*, unsigned int> DeviceAliasMap;
+
+void RunUniverseStateCallback(OlaServer::UniverseStateCallback *callback,
+                              const OlaServer::UniverseState state) {
+  callback->Run(state);
+}
+
+void RunMemoryUsageCallback(OlaServer::MemoryUsageCallback *callback,
+                            const string output) {
+  callback->Run(output);
+}
+
+/*
+ * Write a port in the same format as the /json/universe_info handler.
+ */
+template <typename PortClass>
+void PortToJson(JsonStreamWriter *json,
+                const DeviceAliasMap &aliases,
+                const PortClass *port,
+                bool is_output) {
+  AbstractDevice *device = port->GetDevice();
+  const unsigned int *alias = STLFind(&aliases, device);
+  std::ostringstream str;
+  str << (alias ? *alias : 0) << "-" << (is_output ? "O" : "I") << "-"
+      << port->PortId();
+
+  json->StartObject();
+  json->Add("description", DispatchDescription(port));
+  json->Add("device", device ? device->Name() : "");
+  json->Add("id", str.str());
+  json->Add("is_output", is_output);
+  json->Add("supports_rdm", port->SupportsRDM());
+
+  json->Key("priority");
+  json->StartObject();
+  if (port->PriorityCapability() != CAPABILITY_NONE) {
+    bool is_static = port->GetPriorityMode() == PRIORITY_MODE_STATIC;
+    uint8_t priority = is_static ? port->GetPriority() : 0;
+    if (priority == 0) {
+      priority = dmx::SOURCE_PRIORITY_DEFAULT;
+    }
+    json->Add("current_mode", is_static ? "static" : "inherit");
+    json->Add("priority_capability",
+              (port->PriorityCapability() == CAPABILITY_STATIC ?
+               "static" : "full"));
+    json->Add("value", static_cast<unsigned int>(priority));
+  }
+  json->EndObject();
+  json->EndObject();
+}
+}  // namespace
+
+/*
+ * Runs on the main thread.
+ */
+void OlaServer::WriteUniverseState(ola::thread::ExecutorInterface *executor,
+                                   const string if_none_match,
+                                   UniverseStateCallback *callback) {
+  const uint32_t universe_generation = m_universe_store->Generation();
+  const uint32_t device_generation = m_device_manager->Generation();
+  if (!m_state_modified ||
+      universe_generation != m_state_universe_generation ||
+      device_generation != m_state_device_generation) {
+    m_state_universe_generation = universe_generation;
+    m_state_device_generation = device_generation;
+    TimeStamp now;
+    m_clock.CurrentRealTime(&now);
+    m_state_modified = now.Seconds();
+  }
+
+  UniverseState state;
+  std::ostringstream etag;
+  etag << "\"" << std::hex << m_state_epoch << "-" << universe_generation
+       << "-" << device_generation << "\"";
+  state.etag = etag.str();
+  state.last_modified = m_state_modified;
+  if (state.etag == if_none_match) {
+    // Nothing has changed, so there's no need to build the JSON.
+    executor->Execute(NewSingleCallback(&RunUniverseStateCallback, callback,
+                                        state));
+    return;
+  }
+
+  DeviceAliasMap aliases;
+  vector<device_alias_pair> devices = m_device_manager->Devices();
+  vector<device_alias_pair>::const_iterator device_iter = devices.begin();
+  for (; device_iter != devices.end(); ++device_iter) {
+    aliases[device_iter->device] = device_iter->alias;
+  }
+
+  vector<Universe*> universes;
+  m_universe_store->GetList(&universes);
+
+  JsonStreamWriter json(&state.json);
+  json.StartObject();
+  json.Key("universes");
+  json.StartArray();
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    const Universe *universe = *iter;
+    json.StartObject();
+    json.Add("id", universe->UniverseId());
+    json.Add("name", universe->Name());
+    json.Add("merge_mode",
+             universe->MergeMode() == Universe::MERGE_HTP ? "HTP" : "LTP");
+    json.Add("active_priority",
+             static_cast<unsigned int>(universe->ActivePriority()));
+    json.Add("max_output_rate", universe->MaxOutputRate());
+    json.Add("rdm_devices", universe->UIDCount());
+    json.Add("sink_clients", universe->SinkClientCount());
+    json.Add("source_clients", universe->SourceClientCount());
+
+    vector<InputPort*> input_ports;
+    universe->InputPorts(&input_ports);
+    json.Key("input_ports");
+    json.StartArray();
+    vector<InputPort*>::const_iterator input_iter = input_ports.begin();
+    for (; input_iter != input_ports.end(); ++input_iter) {
+      PortToJson(&json, aliases, *input_iter, false);
+    }
+    json.EndArray();
+
+    vector<OutputPort*> output_ports;
+    universe->OutputPorts(&output_ports);
+    json.Key("output_ports");
+    json.StartArray();
+    vector<OutputPort*>::const_iterator output_iter = output_ports.begin();
+    for (; output_iter != output_ports.end(); ++output_iter) {
+      PortToJson(&json, aliases, *output_iter, true);
+    }
+    json.EndArray();
+    json.EndObject();
+  }
+  json.EndArray();
+  json.EndObject();
+
+  executor->Execute(NewSingleCallback(&RunUniverseStateCallback, callback,
+                                      state));
+}
+
+void OlaServer::WriteMemoryUsage(ola::thread::ExecutorInterface *executor,
+                                 MemoryUsageCallback *callback) {
+  std::ostringstream str;
+  str << "low-memory: " << m_options.low_memory << "\n";
+
+  // The totals for the process, from the kernel.
+  std::ifstream status("/proc/self/status");
+  string line;
+  while (std::getline(status, line)) {
+    string name;
+    if (StringBeginsWith(line, "VmRSS:")) {
+      name = "process-rss";
+    } else if (StringBeginsWith(line, "VmHWM:")) {
+      name = "process-peak-rss";
+    } else if (StringBeginsWith(line, "VmData:")) {
+      name = "process-data";
+    } else {
+      continue;
+    }
+    string value = line.substr(line.find(':') + 1);
+    StringTrim(&value);
+    str << name << ": " << value << "\n";
+  }
+
+#if defined(HAVE_MALLOC_H) && defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 heap = mallinfo2();
+#else
+  struct mallinfo heap = mallinfo();
+#endif  // __GLIBC_PREREQ(2, 33)
+  str << "heap-in-use-bytes: " << heap.uordblks + heap.hblkhd << "\n";
+  str << "heap-free-bytes: " << heap.fordblks << "\n";
+#endif  // defined(HAVE_MALLOC_H) && defined(__GLIBC__)
+
+  // Each universe has a merged buffer, along with one for each input port
+  // and source client.
+  vector<Universe*> universes;
+  m_universe_store->GetList(&universes);
+  unsigned int ports = 0;
+  unsigned int buffers = 0;
+  unsigned int clients = 0;
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    ports += (*iter)->InputPortCount() + (*iter)->OutputPortCount();
+    clients += (*iter)->SourceClientCount() + (*iter)->SinkClientCount();
+    buffers += 1 + (*iter)->InputPortCount() + (*iter)->SourceClientCount();
+  }
+  str << "universes: " << universes.size() << "\n";
+  str << "universe-ports: " << ports << "\n";
+  str << "universe-clients: " << clients << "\n";
+  str << "universe-buffer-bytes: " << buffers * DMX_UNIVERSE_SIZE << "\n";
+  str << "devices: " << m_device_manager->DeviceCount() << "\n";
+
+  vector<BaseVariable*> variables = m_export_map->AllVariables();
+  unsigned int variable_bytes = 0;
+  vector<BaseVariable*>::const_iterator var_iter = variables.begin();
+  for (; var_iter != variables.end(); ++var_iter) {
+    variable_bytes += (*var_iter)->Name().size() +
+                      (*var_iter)->Value().size();
+  }
+  str << "export-map-variables: " << variables.size() << "\n";
+  str << "export-map-bytes: " << variable_bytes << "\n";
+
+  str << "pid-store-loaded: " << (m_pid_store.get() != NULL) << "\n";
+  str << "pid-store-esta-pids: " <<
+      (m_pid_store.get() ? m_pid_store->EstaStore()->PidCount() : 0) << "\n";
+
+  executor->Execute(NewSingleCallback(&RunMemoryUsageCallback, callback,
+                                      str.str()));
+}
+
+void OlaServer::LoadPidStoreOnDemand() {
+  if (m_pid_store.get()) {
+    // It's been loaded by /reload_pids.
+    return;
+  }
+  OLA_INFO << "Loading the PID definitions";
+  const RootPidStore *pid_store = RootPidStore::LoadFromDirectory(
+      m_options.pid_data_dir);
+  if (!pid_store) {
+    OLA_WARN << "No PID definitions loaded";
+    return;
+  }
+  UpdatePidStore(pid_store);
+}
+
 void OlaServer::UpdatePidStore(const RootPidStore *pid_store) {
   OLA_INFO << "Updated PID definitions.";
 #ifdef HAVE_LIBMICROHTTPD
@@ -484,6 +1180,9 @@ void OlaServer::UpdatePidStore(const RootPidStore *pid_store) {
     m_httpd->SetPidStore(pid_store);
   }
 #endif  // HAVE_LIBMICROHTTPD
+  if (m_service_impl.get()) {
+    m_service_impl->SetPidStore(pid_store);
+  }
 
   m_pid_store.reset(pid_store);
   OLA_INFO << "PID store is at " << m_pid_store.get();
@@ -25,18 +25,27 @@
 #include <config.h>
 #endif  // HAVE_CONFIG_H
 
+#include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/Constants.h>
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
 #include <ola/io/SelectServer.h>
+#include <ola/network/InterfaceMonitor.h>
 #include <ola/network/InterfacePicker.h>
 #include <ola/network/Socket.h>
 #include <ola/network/TCPSocketFactory.h>
+#include <ola/network/TransmitPacer.h>
 #include <ola/plugin_id.h>
 #include <ola/rdm/PidStore.h>
 #include <ola/rdm/UID.h>
 #include <ola/rpc/RpcSessionHandler.h>
+#include <ola/thread/ExecutorInterface.h>
+#include <ola/timecode/TimeCode.h>
+#include <ola/util/StallWatchdog.h>
 
+#include <stdint.h>
+#include <time.h>
 #include <map>
 #include <memory>
 #include <string>
@@ -70,8 +79,54 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
     unsigned int http_port;  /** @brief Port to run the HTTP server on */
     /** @brief Directory that contains the static content */
     std::string http_data_dir;
+    /**
+     * @brief The number of threads libmicrohttpd uses to handle connections.
+     * 0 handles the connections on the HTTP server's thread.
+     */
+    unsigned int http_threads;
     std::string network_interface;
     std::string pid_data_dir;  /** @brief Directory with the PID definitions */
+    /**
+     * @brief The plugins to run on their own threads, either "all" or a comma
+     * separated list of plugin ids. Empty runs every plugin on the main
+     * thread.
+     */
+    std::string plugin_threads;
+    /**
+     * @brief Pass DMX data to local clients using shared memory.
+     */
+    bool shared_memory;
+    /**
+     * @brief Accept DMX data from clients over UDP, see UDPStreamServer.
+     */
+    bool udp_streaming;
+    /**
+     * @brief The UDP port to accept streamed DMX data on, 0 picks a free
+     * port. Clients are told the port over RPC.
+     */
+    uint16_t udp_stream_port;
+    /**
+     * @brief The file used to save the DMX data and RDM UIDs of each
+     * universe, so they can be restored after a restart. Empty disables this.
+     */
+    std::string state_file;
+    /**
+     * @brief Reduce memory use at the expense of latency, for small systems.
+     *
+     * The PID definitions aren't loaded until a client asks for an RDM
+     * response to be decoded, the HTTP server uses a single thread with
+     * smaller connection buffers, and fewer malloc arenas are used, with free
+     * memory returned to the system during housekeeping.
+     */
+    bool low_memory;
+
+    /**
+     * @brief Report threads that are busy for longer than this, in ms.
+     *
+     * The main loop, plugin threads and output threads are supervised by a
+     * StallWatchdog. 0 disables it.
+     */
+    unsigned int stall_threshold_ms;
   };
 
   /**
@@ -105,9 +160,11 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   bool Init();
 
   /**
-   * @brief Reload all plugins.
+   * @brief Reload the plugin preferences, and restart the plugins whose
+   *   preferences have changed.
    *
-   * This method is thread safe.
+   * Port patchings are saved when a device is removed, so they're restored
+   * when the plugin is restarted. This method is thread safe.
    */
   void ReloadPlugins();
 
@@ -118,6 +175,54 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
    */
   void ReloadPidStore();
 
+  /**
+   * @brief The state of the universes, from FetchUniverseState().
+   */
+  struct UniverseState {
+    std::string etag;  // changes whenever the state does
+    time_t last_modified;
+    std::string json;  // empty if the caller's copy is current
+  };
+
+  /**
+   * @brief Called with the state of the universes.
+   */
+  typedef ola::SingleUseCallback1<void, const UniverseState&>
+      UniverseStateCallback;
+
+  /**
+   * @brief Fetch the state of every universe and the ports patched to it.
+   * @param executor the executor that runs the callback.
+   * @param if_none_match the ETag of the caller's copy, may be empty.
+   * @param callback the callback to run with the state.
+   *
+   * The state is read on the main thread, in a single pass over the
+   * universes. The ETag is built from the generations of the universes and
+   * devices, so if it matches if_none_match the JSON isn't built at all.
+   * This method is thread safe.
+   */
+  void FetchUniverseState(ola::thread::ExecutorInterface *executor,
+                          const std::string &if_none_match,
+                          UniverseStateCallback *callback);
+
+  /**
+   * @brief Called with a breakdown of the memory used by olad, one
+   * "name: value" pair per line.
+   */
+  typedef ola::SingleUseCallback1<void, const std::string&>
+      MemoryUsageCallback;
+
+  /**
+   * @brief Fetch a breakdown of the memory used by olad.
+   * @param executor the executor that runs the callback.
+   * @param callback the callback to run with the breakdown.
+   *
+   * This contains the totals for the process, along with the counts and
+   * estimated sizes of the larger structures. This method is thread safe.
+   */
+  void FetchMemoryUsage(ola::thread::ExecutorInterface *executor,
+                        MemoryUsageCallback *callback);
+
   /**
    * @brief Stop the OLA Server.
    *
@@ -162,6 +267,10 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
 
   static const unsigned int DEFAULT_RPC_PORT = OLA_DEFAULT_PORT;
 
+  static const unsigned int DEFAULT_RPC_STREAM_WINDOW = 64;
+
+  static const unsigned int DEFAULT_RDM_DISCOVERY_LIMIT = 8;
+
  private :
   struct ClientEntry {
     ola::io::ConnectedDescriptor *client_descriptor;
@@ -186,6 +295,10 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   std::auto_ptr<class PluginManager> m_plugin_manager;
   std::auto_ptr<class PluginAdaptor> m_plugin_adaptor;
   std::auto_ptr<class UniverseStore> m_universe_store;
+  std::auto_ptr<class DiscoveryScheduler> m_discovery_scheduler;
+  std::auto_ptr<class FrameClock> m_frame_clock;
+  std::auto_ptr<class FrameHistory> m_frame_history;
+  std::auto_ptr<class InputTrace> m_input_trace;
   std::auto_ptr<class PortManager> m_port_manager;
   std::auto_ptr<class OlaServerServiceImpl> m_service_impl;
   std::auto_ptr<class ClientBroker> m_broker;
@@ -193,14 +306,39 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   std::auto_ptr<const ola::rdm::RootPidStore> m_pid_store;
   std::auto_ptr<class DiscoveryAgentInterface> m_discovery_agent;
   std::auto_ptr<ola::rpc::RpcServer> m_rpc_server;
+  std::auto_ptr<class SharedDmxServer> m_shared_dmx;
+  std::auto_ptr<class UDPStreamServer> m_udp_stream;
+  std::auto_ptr<class UniverseReplicator> m_replicator;
+  std::auto_ptr<ola::StallWatchdog> m_stall_watchdog;
+  std::auto_ptr<ola::Heartbeat> m_heartbeat;
+  std::auto_ptr<class TimeCodeGenerator> m_timecode_generator;
+  std::auto_ptr<class VirtualUniverseManager> m_virtual_universes;
+  std::auto_ptr<class FadeEngine> m_fade_engine;
+  std::auto_ptr<class RDMPoller> m_rdm_poller;
+  std::auto_ptr<ola::network::InterfaceMonitor> m_interface_monitor;
+  std::auto_ptr<ola::network::TransmitPacer> m_transmit_pacer;
+  std::auto_ptr<Callback0<void> > m_interface_listener;
   class Preferences *m_server_preferences;
   class Preferences *m_universe_preferences;
   std::string m_instance_name;
 
   ola::thread::timeout_id m_housekeeping_timeout;
+  Clock m_clock;
+  // Used to build the ETag for the universe state, the epoch is when the
+  // server was created, so the tags differ across restarts.
+  uint64_t m_state_epoch;
+  uint32_t m_state_universe_generation;
+  uint32_t m_state_device_generation;
+  time_t m_state_modified;
   std::auto_ptr<OladHTTPServer_t> m_httpd;
 
+  std::map<std::string, std::string> m_thread_placements;
+
   bool RunHousekeeping();
+  void StartReplication();
+  void ExportThreadPlacements();
+  static bool DiscoveredEarlier(const class Universe *a,
+                                const class Universe *b);
 
 #ifdef HAVE_LIBMICROHTTPD
   bool StartHttpServer(ola::rpc::RpcServer *server,
@@ -213,6 +351,14 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   bool InternalNewConnection(ola::rpc::RpcServer *server,
                              ola::io::ConnectedDescriptor *descriptor);
   void ReloadPluginsInternal();
+  void InterfacesChanged();
+  void SendTimeCode(const ola::timecode::TimeCode &timecode);
+  void WriteUniverseState(ola::thread::ExecutorInterface *executor,
+                          const std::string if_none_match,
+                          UniverseStateCallback *callback);
+  void WriteMemoryUsage(ola::thread::ExecutorInterface *executor,
+                        MemoryUsageCallback *callback);
+  void LoadPidStoreOnDemand();
   /**
    * @brief Update the Pid store with the new values.
    */
@@ -222,9 +368,14 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   static const char K_INSTANCE_NAME_VAR[];
   static const char K_DISCOVERY_SERVICE_TYPE[];
   static const char K_UID_VAR[];
+  static const char K_THREAD_PLACEMENT_VAR[];
   static const char SERVER_PREFERENCES[];
   static const char UNIVERSE_PREFERENCES[];
   static const unsigned int K_HOUSEKEEPING_TIMEOUT_MS;
+  static const unsigned int K_MIN_RDM_DISCOVERY_INTERVAL_MS;
+  static const unsigned int LOW_MEMORY_HTTP_CONNECTION_MEMORY;
+  static const unsigned int LOW_MEMORY_HTTP_CONNECTIONS;
+  static const int LOW_MEMORY_MALLOC_ARENAS;
 
   DISALLOW_COPY_AND_ASSIGN(OlaServer);
 };
@@ -20,42 +20,58 @@
  */
 
 #include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
 #include "common/protocol/Ola.pb.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Callback.h"
 #include "ola/CallbackRunner.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/dmx/RunLengthEncoder.h"
+#include "ola/dmx/SourcePriorities.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/strings/Format.h"
 #include "ola/timecode/TimeCode.h"
 #include "ola/timecode/TimeCodeEnums.h"
 #include "olad/ClientBroker.h"
 #include "olad/Device.h"
+#include "olad/DiscoveryAgent.h"
 #include "olad/DmxSource.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/Plugin.h"
 #include "olad/PluginManager.h"
 #include "olad/Port.h"
+#include "olad/UDPStreamServer.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/FadeEngine.h"
+#include "olad/plugin_api/FrameHistory.h"
+#include "olad/plugin_api/PluginThread.h"
 #include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/RDMPoller.h"
+#include "olad/plugin_api/RDMResponderStats.h"
+#include "olad/plugin_api/TimeCodeGenerator.h"
 #include "olad/plugin_api/UniverseStore.h"
+#include "olad/plugin_api/VirtualUniverseManager.h"
 
 namespace ola {
 
 using ola::CallbackRunner;
 using ola::proto::Ack;
+using ola::proto::ConfigBatchRequest;
 using ola::proto::DeviceConfigReply;
 using ola::proto::DeviceConfigRequest;
 using ola::proto::DeviceInfo;
 using ola::proto::DeviceInfoReply;
 using ola::proto::DeviceInfoRequest;
 using ola::proto::DmxData;
+using ola::proto::FadeRequest;
 using ola::proto::MergeModeRequest;
 using ola::proto::OptionalUniverseRequest;
 using ola::proto::PatchPortRequest;
@@ -65,16 +81,22 @@ using ola::proto::PluginInfo;
 using ola::proto::PluginListReply;
 using ola::proto::PluginListRequest;
 using ola::proto::PortInfo;
+using ola::proto::PortPriorityRequest;
+using ola::proto::RDMPolledValues;
 using ola::proto::RegisterDmxRequest;
 using ola::proto::UniverseInfo;
 using ola::proto::UniverseInfoReply;
+using ola::proto::UniverseStats;
+using ola::proto::UniverseStatsReply;
 using ola::proto::UniverseNameRequest;
 using ola::proto::UniverseRequest;
+using ola::proto::VirtualUniverseRequest;
 using ola::rdm::RDMRequest;
 using ola::rdm::RDMResponse;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
 using ola::rpc::RpcController;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -106,6 +128,13 @@ RDMRequest::OverrideOptions RDMRequestOptionsFromProto(
   }
   return options;
 }
+
+/*
+ * The ms from then until now, or 0 if then is in the future.
+ */
+uint32_t MillisecondsSince(const TimeStamp &now, const TimeStamp &then) {
+  return now > then ? (now - then).InMilliSeconds() : 0;
+}
 }  // namespace
 
 typedef CallbackRunner<ola::rpc::RpcService::CompletionCallback> ClosureRunner;
@@ -117,14 +146,32 @@ OlaServerServiceImpl::OlaServerServiceImpl(
     PortManager *port_manager,
     ClientBroker *broker,
     const TimeStamp *wake_up_time,
-    ReloadPluginsCallback *reload_plugins_callback)
+    ReloadPluginsCallback *reload_plugins_callback,
+    TimeCodeGenerator *timecode_generator,
+    DiscoveryAgentInterface *discovery_agent,
+    VirtualUniverseManager *virtual_universes,
+    FadeEngine *fade_engine,
+    RDMPoller *rdm_poller,
+    FrameHistory *frame_history)
     : m_universe_store(universe_store),
       m_device_manager(device_manager),
       m_plugin_manager(plugin_manager),
       m_port_manager(port_manager),
       m_broker(broker),
       m_wake_up_time(wake_up_time),
-      m_reload_plugins_callback(reload_plugins_callback) {
+      m_reload_plugins_callback(reload_plugins_callback),
+      m_timecode_generator(timecode_generator),
+      m_discovery_agent(discovery_agent),
+      m_virtual_universes(virtual_universes),
+      m_fade_engine(fade_engine),
+      m_rdm_poller(rdm_poller),
+      m_frame_history(frame_history),
+      m_udp_stream_server(NULL) {
+}
+
+void OlaServerServiceImpl::SetPidStore(
+    const ola::rdm::RootPidStore *pid_store) {
+  m_rdm_decode_cache.SetPidStore(pid_store);
 }
 
 void OlaServerServiceImpl::GetDmx(
@@ -149,18 +196,32 @@ void OlaServerServiceImpl::RegisterForDmx(
     Ack*,
     ola::rpc::RpcService::CompletionCallback* done) {
   ClosureRunner runner(done);
+  Client *client = GetClient(controller);
+  if (request->action() == ola::proto::UNREGISTER) {
+    // Don't create a universe just to remove the client from it.
+    Universe *universe = m_universe_store->GetUniverse(request->universe());
+    if (universe) {
+      universe->RemoveSinkClient(client);
+    }
+    return;
+  }
+
   Universe *universe = m_universe_store->GetUniverseOrCreate(
       request->universe());
   if (!universe) {
     return MissingUniverseError(controller);
   }
 
-  Client *client = GetClient(controller);
-  if (request->action() == ola::proto::REGISTER) {
-    universe->AddSinkClient(client);
-  } else {
-    universe->RemoveSinkClient(client);
+  if (client) {
+    client->SetDeltaEncoding(request->accept_delta());
   }
+
+  Universe::SinkOptions options;
+  options.slot_offset = std::max(request->slot_offset(), 0);
+  options.slot_count = std::max(request->slot_count(), 0);
+  options.max_rate = std::max(request->max_rate(), 0);
+  options.changes_only = request->changes_only();
+  universe->AddSinkClient(client, options);
 }
 
 void OlaServerServiceImpl::UpdateDmxData(
@@ -176,7 +237,10 @@ void OlaServerServiceImpl::UpdateDmxData(
 
   Client *client = GetClient(controller);
   DmxBuffer buffer;
-  buffer.Set(request->data());
+  if (!GetClientData(client, *request, &buffer)) {
+    controller->SetFailed("Invalid delta frame");
+    return;
+  }
 
   uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
   if (request->has_priority()) {
@@ -196,27 +260,33 @@ void OlaServerServiceImpl::StreamDmxData(
     const ola::proto::DmxData* request,
     ola::proto::STREAMING_NO_RESPONSE*,
     ola::rpc::RpcService::CompletionCallback*) {
-  Universe *universe = m_universe_store->GetUniverse(request->universe());
-
-  if (!universe) {
-    return;
+  Client *client = GetClient(controller);
+  Universe *universe = StreamedDataReceived(client, *request);
+  if (universe) {
+    universe->SourceClientDataChanged(client);
   }
+}
 
+void OlaServerServiceImpl::StreamDmxDataBatch(
+    RpcController *controller,
+    const ola::proto::DmxDataBatch* request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    ola::rpc::RpcService::CompletionCallback*) {
   Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
+  vector<Universe*> universes;
+  for (int i = 0; i < request->data_size(); i++) {
+    Universe *universe = StreamedDataReceived(client, request->data(i));
+    if (universe &&
+        std::find(universes.begin(), universes.end(), universe) ==
+            universes.end()) {
+      universes.push_back(universe);
+    }
+  }
 
-  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
-  if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
+  vector<Universe*>::iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    (*iter)->SourceClientDataChanged(client);
   }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
-  universe->SourceClientDataChanged(client);
 }
 
 void OlaServerServiceImpl::SetUniverseName(
@@ -352,6 +422,435 @@ void OlaServerServiceImpl::SetPortPriority(
   }
 }
 
+void OlaServerServiceImpl::ConfigureBatch(
+    RpcController* controller,
+    const ConfigBatchRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+
+  // Check all the changes before any of them are applied.
+  vector<Port*> patch_ports;
+  set<unsigned int> patched_universes;
+  for (int i = 0; i < request->patch_size(); i++) {
+    const PatchPortRequest &patch = request->patch(i);
+    Port *port = LookupPort(controller, patch.device_alias(), patch.port_id(),
+                            patch.is_output());
+    if (!port) {
+      return;
+    }
+    patch_ports.push_back(port);
+    if (patch.action() == ola::proto::PATCH) {
+      patched_universes.insert(patch.universe());
+    }
+  }
+
+  vector<Port*> priority_ports;
+  for (int i = 0; i < request->priority_size(); i++) {
+    const PortPriorityRequest &priority = request->priority(i);
+    Port *port = LookupPort(controller, priority.device_alias(),
+                            priority.port_id(), priority.is_output());
+    if (!port) {
+      return;
+    }
+    if (priority.priority_mode() == PRIORITY_MODE_STATIC &&
+        !priority.has_priority()) {
+      OLA_INFO << "In ConfigureBatch, override mode was set but the value "
+                  "wasn't specified";
+      controller->SetFailed(
+          "Invalid SetPortPriority request, see logs for more info");
+      return;
+    }
+    priority_ports.push_back(port);
+  }
+
+  for (int i = 0; i < request->merge_mode_size(); i++) {
+    unsigned int universe_id = request->merge_mode(i).universe();
+    if (!m_universe_store->GetUniverse(universe_id) &&
+        !STLContains(patched_universes, universe_id)) {
+      return MissingUniverseError(controller);
+    }
+  }
+
+  for (int i = 0; i < request->name_size(); i++) {
+    unsigned int universe_id = request->name(i).universe();
+    if (!m_universe_store->GetUniverse(universe_id) &&
+        !STLContains(patched_universes, universe_id)) {
+      return MissingUniverseError(controller);
+    }
+  }
+
+  // Patching can still fail, e.g. if it would create a loop. If it does, the
+  // ports patched so far are restored.
+  set<unsigned int> changed_universes;
+  vector<Universe*> previous_universes;
+  for (int i = 0; i < request->patch_size(); i++) {
+    const PatchPortRequest &patch = request->patch(i);
+    Universe *previous = patch_ports[i]->GetUniverse();
+    if (previous) {
+      changed_universes.insert(previous->UniverseId());
+    }
+
+    bool is_patch = patch.action() == ola::proto::PATCH;
+    if (!SetPortPatching(patch_ports[i], patch.is_output(), is_patch,
+                         patch.universe())) {
+      for (int j = i - 1; j >= 0; j--) {
+        Universe *universe = previous_universes[j];
+        SetPortPatching(patch_ports[j], request->patch(j).is_output(),
+                        universe != NULL,
+                        universe ? universe->UniverseId() : 0);
+      }
+      controller->SetFailed("Patch port request failed");
+      return;
+    }
+    previous_universes.push_back(previous);
+    if (is_patch) {
+      changed_universes.insert(patch.universe());
+    }
+  }
+
+  for (int i = 0; i < request->priority_size(); i++) {
+    const PortPriorityRequest &priority = request->priority(i);
+    Port *port = priority_ports[i];
+    if (priority.priority_mode() == PRIORITY_MODE_STATIC) {
+      m_port_manager->SetPriorityStatic(port, priority.priority());
+    } else {
+      m_port_manager->SetPriorityInherit(port);
+    }
+    if (port->GetUniverse()) {
+      changed_universes.insert(port->GetUniverse()->UniverseId());
+    }
+  }
+
+  for (int i = 0; i < request->merge_mode_size(); i++) {
+    const MergeModeRequest &merge_mode = request->merge_mode(i);
+    Universe *universe = m_universe_store->GetUniverse(merge_mode.universe());
+    if (universe) {
+      universe->SetMergeMode(merge_mode.merge_mode() == ola::proto::HTP ?
+                             Universe::MERGE_HTP : Universe::MERGE_LTP);
+      changed_universes.insert(merge_mode.universe());
+    }
+  }
+
+  for (int i = 0; i < request->name_size(); i++) {
+    const UniverseNameRequest &name = request->name(i);
+    Universe *universe = m_universe_store->GetUniverse(name.universe());
+    if (universe) {
+      universe->SetName(name.name());
+      changed_universes.insert(name.universe());
+    }
+  }
+
+  // Each universe is merged and sent to its ports once.
+  vector<Universe*> universes;
+  set<unsigned int>::const_iterator iter = changed_universes.begin();
+  for (; iter != changed_universes.end(); ++iter) {
+    Universe *universe = m_universe_store->GetUniverse(*iter);
+    if (universe) {
+      universe->Remerge();
+      universes.push_back(universe);
+    }
+  }
+
+  // Then the preferences are written once.
+  vector<InputPort*> input_ports;
+  vector<OutputPort*> output_ports;
+  for (int i = 0; i < request->patch_size(); i++) {
+    if (request->patch(i).is_output()) {
+      output_ports.push_back(static_cast<OutputPort*>(patch_ports[i]));
+    } else {
+      input_ports.push_back(static_cast<InputPort*>(patch_ports[i]));
+    }
+  }
+  for (int i = 0; i < request->priority_size(); i++) {
+    if (request->priority(i).is_output()) {
+      output_ports.push_back(static_cast<OutputPort*>(priority_ports[i]));
+    } else {
+      input_ports.push_back(static_cast<InputPort*>(priority_ports[i]));
+    }
+  }
+  m_device_manager->SavePortSettings(input_ports, output_ports);
+  m_universe_store->SaveUniverseSettings(universes);
+}
+
+void OlaServerServiceImpl::ConfigureVirtualUniverses(
+    RpcController* controller,
+    const VirtualUniverseRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_virtual_universes) {
+    controller->SetFailed("Virtual universes aren't available");
+    return;
+  }
+
+  vector<VirtualUniverseManager::VirtualUniverse> universes;
+  for (int i = 0; i < request->universe_size(); i++) {
+    const ola::proto::VirtualUniverse &universe = request->universe(i);
+    if (universe.universe() < 0 ||
+        (universe.has_priority() &&
+         (universe.priority() < ola::dmx::SOURCE_PRIORITY_MIN ||
+          universe.priority() > ola::dmx::SOURCE_PRIORITY_MAX))) {
+      controller->SetFailed("Invalid virtual universe");
+      return;
+    }
+
+    VirtualUniverseManager::VirtualUniverse virtual_universe;
+    virtual_universe.universe = universe.universe();
+    virtual_universe.priority = universe.has_priority() ?
+        static_cast<uint8_t>(universe.priority()) :
+        ola::dmx::SOURCE_PRIORITY_DEFAULT;
+    for (int j = 0; j < universe.mapping_size(); j++) {
+      const ola::proto::VirtualUniverseMapping &mapping = universe.mapping(j);
+      if (mapping.source_universe() < 0 || mapping.source_offset() < 0 ||
+          mapping.offset() < 0 || mapping.length() < 0) {
+        controller->SetFailed("Invalid virtual universe mapping");
+        return;
+      }
+      VirtualUniverseManager::Mapping virtual_mapping = {
+        static_cast<unsigned int>(mapping.source_universe()),
+        static_cast<unsigned int>(mapping.source_offset()),
+        static_cast<unsigned int>(mapping.offset()),
+        static_cast<unsigned int>(mapping.length())};
+      virtual_universe.mappings.push_back(virtual_mapping);
+    }
+    universes.push_back(virtual_universe);
+  }
+
+  vector<unsigned int> removals;
+  for (int i = 0; i < request->remove_size(); i++) {
+    if (request->remove(i) < 0) {
+      return MissingUniverseError(controller);
+    }
+    removals.push_back(request->remove(i));
+  }
+
+  string error;
+  if (!m_virtual_universes->Configure(universes, removals, &error)) {
+    OLA_INFO << "In ConfigureVirtualUniverses, " << error;
+    controller->SetFailed(error);
+  }
+}
+
+void OlaServerServiceImpl::StartFade(
+    RpcController* controller,
+    const FadeRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_fade_engine) {
+    controller->SetFailed("Fades aren't available");
+    return;
+  }
+  if (!m_universe_store->GetUniverse(request->universe())) {
+    return MissingUniverseError(controller);
+  }
+  if (request->duration() < 0 ||
+      (request->has_priority() &&
+       (request->priority() < ola::dmx::SOURCE_PRIORITY_MIN ||
+        request->priority() > ola::dmx::SOURCE_PRIORITY_MAX))) {
+    controller->SetFailed("Invalid fade");
+    return;
+  }
+
+  FadeEngine::Fade fade;
+  fade.universe = request->universe();
+  fade.target.Set(request->data());
+  fade.duration = request->duration();
+  fade.priority = request->has_priority() ?
+      static_cast<uint8_t>(request->priority()) :
+      ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  switch (request->curve()) {
+    case ola::proto::FADE_EASE_IN:
+      fade.curve = FadeEngine::FADE_CURVE_EASE_IN;
+      break;
+    case ola::proto::FADE_EASE_OUT:
+      fade.curve = FadeEngine::FADE_CURVE_EASE_OUT;
+      break;
+    case ola::proto::FADE_EASE_IN_OUT:
+      fade.curve = FadeEngine::FADE_CURVE_EASE_IN_OUT;
+      break;
+    case ola::proto::FADE_LINEAR:
+    default:
+      fade.curve = FadeEngine::FADE_CURVE_LINEAR;
+  }
+  for (int i = 0; i < request->fine_channel_size(); i++) {
+    if (request->fine_channel(i) < 0) {
+      controller->SetFailed("Invalid fade");
+      return;
+    }
+    fade.fine_channels.push_back(request->fine_channel(i));
+  }
+
+  string error;
+  if (!m_fade_engine->StartFade(fade, &error)) {
+    OLA_INFO << "In StartFade, " << error;
+    controller->SetFailed(error);
+  }
+}
+
+void OlaServerServiceImpl::ReleaseFade(
+    RpcController* controller,
+    const UniverseRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_fade_engine) {
+    controller->SetFailed("Fades aren't available");
+    return;
+  }
+  if (!m_fade_engine->Release(request->universe())) {
+    controller->SetFailed("Universe isn't being faded");
+  }
+}
+
+void OlaServerServiceImpl::GetRDMPolledValues(
+    RpcController* controller,
+    const UniverseRequest* request,
+    RDMPolledValues* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_rdm_poller) {
+    controller->SetFailed("RDM polling isn't enabled");
+    return;
+  }
+  if (!m_universe_store->GetUniverse(request->universe())) {
+    return MissingUniverseError(controller);
+  }
+  m_rdm_poller->GetValues(request->universe(), response);
+}
+
+void OlaServerServiceImpl::RegisterForRDMPolledValues(
+    RpcController* controller,
+    const RegisterDmxRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_rdm_poller) {
+    controller->SetFailed("RDM polling isn't enabled");
+    return;
+  }
+  Client *client = GetClient(controller);
+  if (!client) {
+    controller->SetFailed("No client for this session");
+    return;
+  }
+
+  if (request->action() == ola::proto::UNREGISTER) {
+    m_rdm_poller->RemoveClient(request->universe(), client);
+  } else {
+    m_rdm_poller->AddClient(request->universe(), client);
+  }
+}
+
+void OlaServerServiceImpl::OpenUDPStream(
+    RpcController* controller,
+    const ola::proto::UDPStreamRequest*,
+    ola::proto::UDPStreamReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_udp_stream_server) {
+    controller->SetFailed("UDP streaming isn't enabled");
+    return;
+  }
+
+  uint64_t token;
+  if (!m_udp_stream_server->AddClient(GetClient(controller), &token)) {
+    controller->SetFailed("Failed to create a token");
+    return;
+  }
+  response->set_port(m_udp_stream_server->Port());
+  response->set_token(token);
+}
+
+void OlaServerServiceImpl::GetRDMResponderStats(
+    RpcController* controller,
+    const UniverseRequest* request,
+    ola::proto::RDMResponderStatsReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  Universe *universe = m_universe_store->GetUniverse(request->universe());
+  if (!universe) {
+    return MissingUniverseError(controller);
+  }
+
+  response->set_universe(request->universe());
+  const RDMResponderStats &responder_stats = universe->RDMStats();
+  UIDSet uids;
+  responder_stats.GetUIDs(&uids);
+  UIDSet::Iterator iter = uids.Begin();
+  for (; iter != uids.End(); ++iter) {
+    const RDMResponderStats::Stats *stats = responder_stats.Get(*iter);
+    ola::proto::RDMResponderStats *stats_pb = response->add_responder();
+    stats_pb->mutable_uid()->set_esta_id(iter->ManufacturerId());
+    stats_pb->mutable_uid()->set_device_id(iter->DeviceId());
+    stats_pb->set_requests(stats->requests);
+    stats_pb->set_acks(stats->acks);
+    stats_pb->set_ack_timers(stats->ack_timers);
+    stats_pb->set_nacks(stats->nacks);
+    stats_pb->set_timeouts(stats->timeouts);
+    stats_pb->set_failures(stats->failures);
+    stats_pb->set_consecutive_failures(stats->consecutive_failures);
+
+    std::map<uint16_t, unsigned int>::const_iterator nack_iter =
+        stats->nack_reasons.begin();
+    for (; nack_iter != stats->nack_reasons.end(); ++nack_iter) {
+      ola::proto::RDMNackCount *nack = stats_pb->add_nack_reason();
+      nack->set_reason(nack_iter->first);
+      nack->set_count(nack_iter->second);
+    }
+
+    for (unsigned int i = 0; i < stats->latency_buckets.size(); i++) {
+      ola::proto::RDMLatencyBucket *bucket = stats_pb->add_latency();
+      bucket->set_limit_ms(
+          i < RDMResponderStats::LATENCY_BUCKET_COUNT - 1 ?
+          RDMResponderStats::LATENCY_BUCKETS_MS[i] : 0);
+      bucket->set_count(stats->latency_buckets[i]);
+    }
+
+    if (stats->Responses()) {
+      stats_pb->set_min_latency_us(stats->min_latency.AsInt());
+      stats_pb->set_max_latency_us(stats->max_latency.AsInt());
+      stats_pb->set_mean_latency_us(
+          stats->total_latency.AsInt() / stats->Responses());
+    }
+  }
+}
+
+void OlaServerServiceImpl::GetFrameHistory(
+    RpcController* controller,
+    const ola::proto::FrameHistoryRequest* request,
+    ola::proto::FrameHistoryReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_frame_history) {
+    controller->SetFailed("The frame history isn't enabled");
+    return;
+  }
+
+  Clock clock;
+  TimeStamp now;
+  clock.CurrentMonotonicTime(&now);
+  TimeStamp since;
+  if (request->max_age_ms()) {
+    since = now - TimeInterval(
+        static_cast<int64_t>(request->max_age_ms()) * ONE_THOUSAND);
+  }
+
+  vector<FrameHistory::Frame> frames;
+  m_frame_history->GetFrames(request->universe(), since,
+                             request->max_frames(), &frames);
+  response->set_universe(request->universe());
+  vector<FrameHistory::Frame>::const_iterator iter = frames.begin();
+  for (; iter != frames.end(); ++iter) {
+    ola::proto::HistoryFrame *frame = response->add_frame();
+    frame->set_age_us((now - iter->time).AsInt());
+    frame->set_priority(iter->priority);
+    frame->set_source(iter->source);
+    frame->set_data(iter->data.Get());
+  }
+}
+
 void OlaServerServiceImpl::AddUniverse(
     const Universe * universe,
     ola::proto::UniverseInfoReply *universe_info_reply) const {
@@ -385,6 +884,32 @@ void OlaServerServiceImpl::AddUniverse(
   }
 }
 
+void OlaServerServiceImpl::AddUniverseStats(
+    const Universe *universe,
+    ola::proto::UniverseStatsReply *reply) const {
+  const Universe::Stats &stats = universe->GetStats();
+  UniverseStats *universe_stats = reply->add_universe();
+  universe_stats->set_universe(universe->UniverseId());
+  universe_stats->set_input_frames(stats.input_frames);
+  universe_stats->set_output_frames(stats.output_frames);
+  universe_stats->set_changed_slots(stats.changed_slots);
+  universe_stats->set_last_changed_slots(stats.last_changed_slots);
+  universe_stats->set_source_count(
+      universe->InputPortCount() + universe->SourceClientCount());
+  universe_stats->set_active_sources(stats.active_sources);
+  universe_stats->set_merge_time_us(stats.merge_time_us);
+
+  // The times are monotonic, as is the wake up time.
+  if (stats.last_input_time.IsSet()) {
+    universe_stats->set_ms_since_input(
+        MillisecondsSince(*m_wake_up_time, stats.last_input_time));
+  }
+  if (stats.last_output_time.IsSet()) {
+    universe_stats->set_ms_since_output(
+        MillisecondsSince(*m_wake_up_time, stats.last_output_time));
+  }
+}
+
 void OlaServerServiceImpl::GetUniverseInfo(
     RpcController* controller,
     const OptionalUniverseRequest* request,
@@ -412,6 +937,29 @@ void OlaServerServiceImpl::GetUniverseInfo(
   }
 }
 
+void OlaServerServiceImpl::GetUniverseStats(
+    RpcController* controller,
+    const OptionalUniverseRequest* request,
+    UniverseStatsReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+
+  if (request->has_universe()) {
+    Universe *universe = m_universe_store->GetUniverse(request->universe());
+    if (!universe) {
+      return MissingUniverseError(controller);
+    }
+    AddUniverseStats(universe, response);
+  } else {
+    vector<Universe*> uni_list;
+    m_universe_store->GetList(&uni_list);
+    vector<Universe*>::const_iterator iter;
+    for (iter = uni_list.begin(); iter != uni_list.end(); ++iter) {
+      AddUniverseStats(*iter, response);
+    }
+  }
+}
+
 void OlaServerServiceImpl::GetPlugins(
     RpcController*,
     const PluginListRequest*,
@@ -658,7 +1206,7 @@ void OlaServerServiceImpl::ConfigureDevice(
     return;
   }
 
-  device->Configure(controller, request->data(),
+  DispatchConfigure(device, controller, request->data(),
                     response->mutable_data(), done);
 }
 
@@ -721,37 +1269,8 @@ void OlaServerServiceImpl::RDMCommand(
   }
 
   Client *client = GetClient(controller);
-  UID source_uid = client->GetUID();
-
-  UID destination(request->uid().esta_id(),
-                  request->uid().device_id());
-
-  RDMRequest::OverrideOptions options = RDMRequestOptionsFromProto(*request);
-
-  ola::rdm::RDMRequest *rdm_request = NULL;
-  if (request->is_set()) {
-    rdm_request = new ola::rdm::RDMSetRequest(
-        source_uid,
-        destination,
-        universe->GetRDMTransactionNumber(),
-        1,  // port id
-        request->sub_device(),
-        request->param_id(),
-        reinterpret_cast<const uint8_t*>(request->data().data()),
-        request->data().size(),
-        options);
-  } else {
-    rdm_request = new ola::rdm::RDMGetRequest(
-        source_uid,
-        destination,
-        universe->GetRDMTransactionNumber(),
-        1,  // port id
-        request->sub_device(),
-        request->param_id(),
-        reinterpret_cast<const uint8_t*>(request->data().data()),
-        request->data().size(),
-        options);
-  }
+  ola::rdm::RDMRequest *rdm_request = NewRDMRequest(client, universe,
+                                                    *request);
 
   ola::rdm::RDMCallback *callback =
     NewSingleCallback(
@@ -759,11 +1278,75 @@ void OlaServerServiceImpl::RDMCommand(
         &OlaServerServiceImpl::HandleRDMResponse,
         response,
         done,
-        request->include_raw_response());
+        request->include_raw_response(),
+        request->decode_response());
 
   m_broker->SendRDMRequest(client, universe, rdm_request, callback);
 }
 
+/*
+ * Tracks the outstanding requests in a batch.
+ */
+class OlaServerServiceImpl::RDMBatchTracker {
+ public:
+  explicit RDMBatchTracker(ola::rpc::RpcService::CompletionCallback *done)
+      : outstanding(0),
+        done(done) {
+  }
+
+  unsigned int outstanding;
+  ola::rpc::RpcService::CompletionCallback *done;
+};
+
+void OlaServerServiceImpl::RDMCommandBatch(
+    RpcController* controller,
+    const ola::proto::RDMBatchRequest* request,
+    ola::proto::RDMBatchResponse* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  Client *client = GetClient(controller);
+
+  // Add all the responses first, requests can complete while we're still
+  // sending the rest of the batch.
+  for (int i = 0; i < request->request_size(); i++) {
+    response->add_response();
+  }
+
+  // The extra count stops the batch completing until all the requests have
+  // been sent.
+  RDMBatchTracker *tracker = new RDMBatchTracker(done);
+  tracker->outstanding = request->request_size() + 1;
+
+  for (int i = 0; i < request->request_size(); i++) {
+    const ola::proto::RDMRequest &rdm_request = request->request(i);
+    ola::proto::RDMResponse *rdm_response = response->mutable_response(i);
+    Universe *universe = m_universe_store->GetUniverse(
+        rdm_request.universe());
+    if (!universe) {
+      OLA_WARN << "RDM batch request for missing universe "
+               << rdm_request.universe();
+      rdm_response->set_response_code(ola::proto::RDM_FAILED_TO_SEND);
+      tracker->outstanding--;
+      continue;
+    }
+
+    ola::rdm::RDMCallback *callback = NewSingleCallback(
+        this,
+        &OlaServerServiceImpl::HandleBatchRDMResponse,
+        tracker,
+        rdm_response,
+        rdm_request.include_raw_response(),
+        rdm_request.decode_response());
+    m_broker->SendRDMRequest(client, universe,
+                             NewRDMRequest(client, universe, rdm_request),
+                             callback);
+  }
+
+  if (--tracker->outstanding == 0) {
+    delete tracker;
+    done->Run();
+  }
+}
+
 void OlaServerServiceImpl::RDMDiscoveryCommand(
     RpcController* controller,
     const ola::proto::RDMDiscoveryRequest* request,
@@ -801,7 +1384,8 @@ void OlaServerServiceImpl::RDMDiscoveryCommand(
         &OlaServerServiceImpl::HandleRDMResponse,
         response,
         done,
-        request->include_raw_response());
+        request->include_raw_response(),
+        false);
 
   m_broker->SendRDMRequest(client, universe, rdm_request, callback);
 }
@@ -830,16 +1414,143 @@ void OlaServerServiceImpl::SendTimeCode(
       request->seconds(),
       request->frames());
 
-  if (time_code.IsValid()) {
-    m_device_manager->SendTimeCode(time_code);
-  } else {
+  if (!time_code.IsValid()) {
     controller->SetFailed("Invalid TimeCode");
+  } else if (m_timecode_generator && m_timecode_generator->IsChasing()) {
+    m_timecode_generator->TimeCodeReceived(time_code);
+  } else {
+    m_device_manager->SendTimeCode(time_code);
+  }
+}
+
+void OlaServerServiceImpl::ControlTimeCodeGenerator(
+    RpcController* controller,
+    const ola::proto::TimeCodeGeneratorRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_timecode_generator) {
+    controller->SetFailed("No TimeCode generator");
+    return;
+  }
+
+  switch (request->mode()) {
+    case ola::proto::GENERATOR_STOP:
+      m_timecode_generator->Stop();
+      break;
+    case ola::proto::GENERATOR_CHASE:
+      m_timecode_generator->Chase();
+      break;
+    case ola::proto::GENERATOR_RUN: {
+      if (!request->has_start()) {
+        controller->SetFailed("Missing start TimeCode");
+        return;
+      }
+      const ola::proto::TimeCode &start = request->start();
+      ola::timecode::TimeCode time_code(
+          static_cast<ola::timecode::TimeCodeType>(start.type()),
+          start.hours(),
+          start.minutes(),
+          start.seconds(),
+          start.frames());
+      if (!time_code.IsValid()) {
+        controller->SetFailed("Invalid TimeCode");
+        return;
+      }
+      m_timecode_generator->Start(time_code);
+      break;
+    }
+    default:
+      controller->SetFailed("Unknown generator mode");
+  }
+}
+
+void OlaServerServiceImpl::GetDiscoveredServices(
+    RpcController* controller,
+    const ola::proto::DiscoveredServicesRequest* request,
+    ola::proto::DiscoveredServicesReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_discovery_agent) {
+    controller->SetFailed("DNS-SD isn't available");
+    return;
+  }
+
+  vector<DiscoveryAgentInterface::ServiceInfo> services;
+  if (!m_discovery_agent->GetServices(request->type(), &services)) {
+    if (!m_discovery_agent->BrowseServices(request->type())) {
+      controller->SetFailed("Failed to browse for " + request->type());
+      return;
+    }
+    response->set_cached(false);
+    return;
+  }
+
+  response->set_cached(true);
+  vector<DiscoveryAgentInterface::ServiceInfo>::const_iterator iter =
+      services.begin();
+  for (; iter != services.end(); ++iter) {
+    ola::proto::DiscoveredService *service = response->add_service();
+    service->set_name(iter->name);
+    service->set_type(iter->type);
+    service->set_domain(iter->domain);
+    service->set_host(iter->host);
+    if (!iter->address.IsWildcard()) {
+      service->set_ip_address(iter->address.AsInt());
+    }
+    service->set_port(iter->port);
+    service->set_if_index(iter->if_index);
+
+    DiscoveryAgentInterface::RegisterOptions::TxtData::const_iterator
+        txt_iter = iter->txt_data.begin();
+    for (; txt_iter != iter->txt_data.end(); ++txt_iter) {
+      ola::proto::TxtRecordEntry *entry = service->add_txt();
+      entry->set_key(txt_iter->first);
+      entry->set_value(txt_iter->second);
+    }
   }
 }
 
 
 // Private methods
 //-----------------------------------------------------------------------------
+/*
+ * Build the RDM Get or Set request for a proto RDMRequest.
+ */
+ola::rdm::RDMRequest *OlaServerServiceImpl::NewRDMRequest(
+    const Client *client,
+    Universe *universe,
+    const ola::proto::RDMRequest &request) {
+  UID destination(request.uid().esta_id(),
+                  request.uid().device_id());
+
+  RDMRequest::OverrideOptions options = RDMRequestOptionsFromProto(request);
+
+  if (request.is_set()) {
+    return new ola::rdm::RDMSetRequest(
+        client->GetUID(),
+        destination,
+        universe->GetRDMTransactionNumber(),
+        1,  // port id
+        request.sub_device(),
+        request.param_id(),
+        reinterpret_cast<const uint8_t*>(request.data().data()),
+        request.data().size(),
+        options);
+  } else {
+    return new ola::rdm::RDMGetRequest(
+        client->GetUID(),
+        destination,
+        universe->GetRDMTransactionNumber(),
+        1,  // port id
+        request.sub_device(),
+        request.param_id(),
+        reinterpret_cast<const uint8_t*>(request.data().data()),
+        request.data().size(),
+        options);
+  }
+}
+
 /*
  * Handle an RDM Response, this includes broadcast messages, messages that
  * timed out and normal response messages.
@@ -848,8 +1559,39 @@ void OlaServerServiceImpl::HandleRDMResponse(
     ola::proto::RDMResponse* response,
     ola::rpc::RpcService::CompletionCallback* done,
     bool include_raw_packets,
+    bool decode,
     ola::rdm::RDMReply *reply) {
   ClosureRunner runner(done);
+  SetRDMResponse(response, include_raw_packets, decode, reply);
+}
+
+/*
+ * Handle the response to one request in a batch, the reply is sent once all
+ * of the requests have completed.
+ */
+void OlaServerServiceImpl::HandleBatchRDMResponse(
+    RDMBatchTracker *tracker,
+    ola::proto::RDMResponse* response,
+    bool include_raw_packets,
+    bool decode,
+    ola::rdm::RDMReply *reply) {
+  SetRDMResponse(response, include_raw_packets, decode, reply);
+  if (--tracker->outstanding == 0) {
+    ola::rpc::RpcService::CompletionCallback *done = tracker->done;
+    delete tracker;
+    done->Run();
+  }
+}
+
+/*
+ * Copy an RDM reply into the proto response. If decode is true, the data in
+ * ACKs is decoded using the PID store.
+ */
+void OlaServerServiceImpl::SetRDMResponse(
+    ola::proto::RDMResponse* response,
+    bool include_raw_packets,
+    bool decode,
+    ola::rdm::RDMReply *reply) {
   response->set_response_code(
       static_cast<ola::proto::RDMResponseCode>(reply->StatusCode()));
 
@@ -895,6 +1637,25 @@ void OlaServerServiceImpl::HandleRDMResponse(
             reinterpret_cast<const char*>(reply->Response()->ParamData()),
             reply->Response()->ParamDataSize());
       }
+
+      if (decode &&
+          reply->Response()->ResponseType() == ola::rdm::RDM_ACK &&
+          response->command_class() != ola::proto::RDM_DISCOVERY_RESPONSE) {
+        string pid_name, decoded_data;
+        if (m_pid_store_loader.get()) {
+          m_pid_store_loader.release()->Run();
+        }
+        if (m_rdm_decode_cache.Decode(
+                reply->Response()->SourceUID().ManufacturerId(),
+                response->command_class() == ola::proto::RDM_SET_RESPONSE,
+                reply->Response()->ParamId(),
+                response->data(),
+                &pid_name,
+                &decoded_data)) {
+          response->set_pid_name(pid_name);
+          response->set_decoded_data(decoded_data);
+        }
+      }
     } else {
       // Invalid RDM Response code.
       OLA_WARN << "RDM response present, but response type is invalid, was "
@@ -937,6 +1698,67 @@ void OlaServerServiceImpl::RDMDiscoveryComplete(
 }
 
 
+/*
+ * Store streamed data against the client.
+ * @returns the universe the data is for, or NULL if it doesn't exist.
+ */
+Universe *OlaServerServiceImpl::StreamedDataReceived(
+    Client *client,
+    const ola::proto::DmxData &data) {
+  Universe *universe = m_universe_store->GetUniverse(data.universe());
+  if (!universe) {
+    return NULL;
+  }
+
+  DmxBuffer buffer;
+  if (!GetClientData(client, data, &buffer)) {
+    return NULL;
+  }
+
+  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (data.has_priority()) {
+    priority = data.priority();
+    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                        priority);
+    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                        priority);
+  }
+  DmxSource source(buffer, *m_wake_up_time, priority);
+  client->DMXReceived(data.universe(), source);
+  return universe;
+}
+
+/*
+ * Extract the frame from a DmxData message sent by a client, applying the
+ * delta if there is one.
+ * @returns false if the delta couldn't be applied.
+ */
+bool OlaServerServiceImpl::GetClientData(Client *client,
+                                         const ola::proto::DmxData &data,
+                                         DmxBuffer *buffer) {
+  if (!data.has_delta()) {
+    return buffer->Set(data.data());
+  }
+
+  // Deltas are relative to the last frame this client sent.
+  const DmxSource *source = client->FindSourceData(data.universe());
+  if (!source || !source->IsSet()) {
+    OLA_WARN << "Delta frame for universe " << data.universe()
+             << " without a base frame";
+    return false;
+  }
+
+  ola::dmx::RunLengthEncoder encoder;
+  const string &delta = data.delta();
+  if (!encoder.DecodeDelta(source->Data(),
+                           reinterpret_cast<const uint8_t*>(delta.data()),
+                           delta.size(), buffer)) {
+    OLA_WARN << "Invalid delta frame for universe " << data.universe();
+    return false;
+  }
+  return true;
+}
+
 void OlaServerServiceImpl::MissingUniverseError(RpcController* controller) {
   controller->SetFailed("Universe doesn't exist");
 }
@@ -956,6 +1778,53 @@ void OlaServerServiceImpl::MissingPortError(RpcController* controller) {
 }
 
 
+/*
+ * Find a port, setting the error if either the device or the port doesn't
+ * exist.
+ */
+Port *OlaServerServiceImpl::LookupPort(RpcController* controller,
+                                       unsigned int device_alias,
+                                       unsigned int port_id,
+                                       bool is_output) {
+  AbstractDevice *device = m_device_manager->GetDevice(device_alias);
+  if (!device) {
+    MissingDeviceError(controller);
+    return NULL;
+  }
+
+  Port *port = NULL;
+  if (is_output) {
+    port = device->GetOutputPort(port_id);
+  } else {
+    port = device->GetInputPort(port_id);
+  }
+
+  if (!port) {
+    MissingPortError(controller);
+  }
+  return port;
+}
+
+
+/*
+ * Patch or unpatch a port found with LookupPort().
+ */
+bool OlaServerServiceImpl::SetPortPatching(Port *port,
+                                           bool is_output,
+                                           bool patch,
+                                           unsigned int universe) {
+  if (is_output) {
+    OutputPort *output_port = static_cast<OutputPort*>(port);
+    return patch ? m_port_manager->PatchPort(output_port, universe) :
+                   m_port_manager->UnPatchPort(output_port);
+  } else {
+    InputPort *input_port = static_cast<InputPort*>(port);
+    return patch ? m_port_manager->PatchPort(input_port, universe) :
+                   m_port_manager->UnPatchPort(input_port);
+  }
+}
+
+
 /*
  * Add this device to the DeviceInfo response
  */
@@ -1010,7 +1879,7 @@ void OlaServerServiceImpl::PopulatePort(const PortClass &port,
                                         PortInfo *port_info) const {
   port_info->set_port_id(port.PortId());
   port_info->set_priority_capability(port.PriorityCapability());
-  port_info->set_description(port.Description());
+  port_info->set_description(DispatchDescription(&port));
 
   if (port.GetUniverse()) {
     port_info->set_active(true);
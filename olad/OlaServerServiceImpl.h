@@ -24,10 +24,12 @@
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "ola/Callback.h"
+#include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
+#include "olad/RDMDecodeCache.h"
 
 #ifndef OLAD_OLASERVERSERVICEIMPL_H_
 #define OLAD_OLASERVERSERVICEIMPL_H_
@@ -53,9 +55,17 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
    * @brief A Callback used to reload all the plugins.
    */
   typedef Callback0<void> ReloadPluginsCallback;
+  typedef SingleUseCallback0<void> PidStoreLoader;
 
   /**
    * @brief Create a new OlaServerServiceImpl.
+   *
+   * If timecode_generator is NULL, ControlTimeCodeGenerator fails. If
+   * discovery_agent is NULL, GetDiscoveredServices fails. If
+   * virtual_universes is NULL, ConfigureVirtualUniverses fails. If
+   * fade_engine is NULL, StartFade and ReleaseFade fail. If rdm_poller is
+   * NULL, GetRDMPolledValues and RegisterForRDMPolledValues fail. If
+   * frame_history is NULL, GetFrameHistory fails.
    */
   OlaServerServiceImpl(class UniverseStore *universe_store,
                        class DeviceManager *device_manager,
@@ -63,10 +73,42 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                        class PortManager *port_manager,
                        class ClientBroker *broker,
                        const class TimeStamp *wake_up_time,
-                       ReloadPluginsCallback *reload_plugins_callback);
+                       ReloadPluginsCallback *reload_plugins_callback,
+                       class TimeCodeGenerator *timecode_generator = NULL,
+                       class DiscoveryAgentInterface *discovery_agent = NULL,
+                       class VirtualUniverseManager *virtual_universes = NULL,
+                       class FadeEngine *fade_engine = NULL,
+                       class RDMPoller *rdm_poller = NULL,
+                       class FrameHistory *frame_history = NULL);
 
   ~OlaServerServiceImpl() {}
 
+  /**
+   * @brief Set the PID store used to decode RDM responses.
+   * @param pid_store the store to use, ownership is not transferred. This may
+   *   be NULL, in which case responses aren't decoded.
+   */
+  void SetPidStore(const ola::rdm::RootPidStore *pid_store);
+
+  /**
+   * @brief Set a callback to load the PID store, this is run the first time a
+   * client asks for a response to be decoded.
+   * @param loader the callback, which should call SetPidStore(). Ownership is
+   *   transferred.
+   */
+  void SetPidStoreLoader(PidStoreLoader *loader) {
+    m_pid_store_loader.reset(loader);
+  }
+
+  /**
+   * @brief Set the server that accepts DMX data over UDP.
+   * @param server the UDPStreamServer, ownership is not transferred. If this
+   *   is NULL, OpenUDPStream fails.
+   */
+  void SetUDPStreamServer(class UDPStreamServer *server) {
+    m_udp_stream_server = server;
+  }
+
   /**
    * @brief Returns the current DMX values for a particular universe.
    */
@@ -99,6 +141,17 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                      ::ola::proto::STREAMING_NO_RESPONSE* response,
                      ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Handle a batch of streaming DMX updates, no response is sent.
+   *
+   * All the data in the batch is stored before any of the universes are
+   * merged, so each universe is merged and output once per batch.
+   */
+  void StreamDmxDataBatch(ola::rpc::RpcController* controller,
+                          const ::ola::proto::DmxDataBatch* request,
+                          ::ola::proto::STREAMING_NO_RESPONSE* response,
+                          ola::rpc::RpcService::CompletionCallback* done);
+
 
   /**
    * @brief Sets the name of a universe.
@@ -132,6 +185,91 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                        ola::proto::Ack* response,
                        ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Apply a batch of patch, priority, merge mode & name changes.
+   *
+   * All the changes are checked before any are applied, and if a patch fails
+   * the ports already patched are restored. Each universe that changed is
+   * then merged and sent to its ports once, and the preferences are written
+   * once.
+   */
+  void ConfigureBatch(ola::rpc::RpcController* controller,
+                      const ola::proto::ConfigBatchRequest* request,
+                      ola::proto::Ack* response,
+                      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Set up and remove virtual universes.
+   *
+   * Nothing is changed if any of the virtual universes are invalid.
+   */
+  void ConfigureVirtualUniverses(
+      ola::rpc::RpcController* controller,
+      const ola::proto::VirtualUniverseRequest* request,
+      ola::proto::Ack* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Start a fade, olad renders the steps of the fade.
+   */
+  void StartFade(ola::rpc::RpcController* controller,
+                 const ola::proto::FadeRequest* request,
+                 ola::proto::Ack* response,
+                 ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Stop fading a universe, and remove the fade's data from it.
+   */
+  void ReleaseFade(ola::rpc::RpcController* controller,
+                   const ola::proto::UniverseRequest* request,
+                   ola::proto::Ack* response,
+                   ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Return the latest sensor & status values polled from the RDM
+   * devices on a universe.
+   */
+  void GetRDMPolledValues(ola::rpc::RpcController* controller,
+                          const ola::proto::UniverseRequest* request,
+                          ola::proto::RDMPolledValues* response,
+                          ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Register or unregister a client to be sent the polled RDM values
+   * for a universe as they change.
+   */
+  void RegisterForRDMPolledValues(
+      ola::rpc::RpcController* controller,
+      const ola::proto::RegisterDmxRequest* request,
+      ola::proto::Ack* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Return the latency & reliability stats for the RDM responders on
+   *   a universe.
+   */
+  void GetRDMResponderStats(
+      ola::rpc::RpcController* controller,
+      const ola::proto::UniverseRequest* request,
+      ola::proto::RDMResponderStatsReply* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Give the client a token it can use to stream DMX data over UDP.
+   */
+  void OpenUDPStream(ola::rpc::RpcController* controller,
+                     const ola::proto::UDPStreamRequest* request,
+                     ola::proto::UDPStreamReply* response,
+                     ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Return the frames a universe has sent recently.
+   */
+  void GetFrameHistory(ola::rpc::RpcController* controller,
+                       const ola::proto::FrameHistoryRequest* request,
+                       ola::proto::FrameHistoryReply* response,
+                       ola::rpc::RpcService::CompletionCallback* done);
+
   /**
    * @brief Returns information on the active universes.
    */
@@ -140,6 +278,14 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                        ola::proto::UniverseInfoReply* response,
                        ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Returns the frame counters for the active universes.
+   */
+  void GetUniverseStats(ola::rpc::RpcController* controller,
+                        const ola::proto::OptionalUniverseRequest* request,
+                        ola::proto::UniverseStatsReply* response,
+                        ola::rpc::RpcService::CompletionCallback* done);
+
   /**
    * @brief Return info on available plugins.
    */
@@ -232,6 +378,18 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                   ola::rpc::RpcService::CompletionCallback* done);
 
 
+  /**
+   * @brief Handle a batch of RDM Commands.
+   *
+   * The requests are all sent at once, so requests for different universes
+   * run concurrently, and requests for the same universe are queued by the
+   * ports. The reply is sent once every request has completed.
+   */
+  void RDMCommandBatch(ola::rpc::RpcController* controller,
+                       const ::ola::proto::RDMBatchRequest* request,
+                       ola::proto::RDMBatchResponse* response,
+                       ola::rpc::RpcService::CompletionCallback* done);
+
   /**
    * @brief Handle an RDM Discovery Command.
    *
@@ -259,21 +417,70 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                     ::ola::proto::Ack* response,
                     ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Start, stop or chase with the timecode generator.
+   */
+  void ControlTimeCodeGenerator(
+      ola::rpc::RpcController* controller,
+      const ::ola::proto::TimeCodeGeneratorRequest* request,
+      ::ola::proto::Ack* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Return the DNS-SD services of a type that olad has found.
+   *
+   * The reply is answered from the discovery agent's cache. If the type
+   * isn't being browsed yet, browsing starts and the reply is empty.
+   */
+  void GetDiscoveredServices(
+      ola::rpc::RpcController* controller,
+      const ::ola::proto::DiscoveredServicesRequest* request,
+      ::ola::proto::DiscoveredServicesReply* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
  private:
+  class RDMBatchTracker;
+
+  ola::rdm::RDMRequest *NewRDMRequest(const class Client *client,
+                                      Universe *universe,
+                                      const ola::proto::RDMRequest &request);
   void HandleRDMResponse(ola::proto::RDMResponse* response,
                          ola::rpc::RpcService::CompletionCallback* done,
                          bool include_raw_packets,
+                         bool decode,
                          ola::rdm::RDMReply *reply);
+  void HandleBatchRDMResponse(RDMBatchTracker *tracker,
+                              ola::proto::RDMResponse* response,
+                              bool include_raw_packets,
+                              bool decode,
+                              ola::rdm::RDMReply *reply);
+  void SetRDMResponse(ola::proto::RDMResponse* response,
+                      bool include_raw_packets,
+                      bool decode,
+                      ola::rdm::RDMReply *reply);
   void RDMDiscoveryComplete(unsigned int universe,
                             ola::rpc::RpcService::CompletionCallback* done,
                             ola::proto::UIDListReply *response,
                             const ola::rdm::UIDSet &uids);
 
+  Universe *StreamedDataReceived(class Client *client,
+                                 const ola::proto::DmxData &data);
+  bool GetClientData(class Client *client,
+                     const ola::proto::DmxData &data,
+                     class DmxBuffer *buffer);
+
   void MissingUniverseError(ola::rpc::RpcController* controller);
   void MissingPluginError(ola::rpc::RpcController* controller);
   void MissingDeviceError(ola::rpc::RpcController* controller);
   void MissingPortError(ola::rpc::RpcController* controller);
 
+  class Port *LookupPort(ola::rpc::RpcController* controller,
+                         unsigned int device_alias,
+                         unsigned int port_id,
+                         bool is_output);
+  bool SetPortPatching(class Port *port, bool is_output, bool patch,
+                       unsigned int universe);
+
   void AddPlugin(class AbstractPlugin *plugin,
                  ola::proto::PluginInfo *plugin_info) const;
   void AddDevice(class AbstractDevice *device,
@@ -281,6 +488,8 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                  ola::proto::DeviceInfoReply* response) const;
   void AddUniverse(const Universe *universe,
                    ola::proto::UniverseInfoReply *universe_info_reply) const;
+  void AddUniverseStats(const Universe *universe,
+                        ola::proto::UniverseStatsReply *reply) const;
 
   template <class PortClass>
   void PopulatePort(const PortClass &port,
@@ -297,6 +506,15 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
   class ClientBroker *m_broker;
   const class TimeStamp *m_wake_up_time;
   std::auto_ptr<ReloadPluginsCallback> m_reload_plugins_callback;
+  class TimeCodeGenerator *m_timecode_generator;
+  class DiscoveryAgentInterface *m_discovery_agent;
+  class VirtualUniverseManager *m_virtual_universes;
+  class FadeEngine *m_fade_engine;
+  class RDMPoller *m_rdm_poller;
+  class FrameHistory *m_frame_history;
+  class UDPStreamServer *m_udp_stream_server;
+  RDMDecodeCache m_rdm_decode_cache;
+  std::auto_ptr<PidStoreLoader> m_pid_store_loader;
 };
 }  // namespace ola
 #endif  // OLAD_OLASERVERSERVICEIMPL_H_
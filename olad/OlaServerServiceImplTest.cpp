@@ -33,20 +33,33 @@
 #include "ola/DmxBuffer.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
+#include "olad/ClientBroker.h"
+#include "olad/DiscoveryAgent.h"
+#include "olad/DiscoveryCache.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/PluginLoader.h"
+#include "olad/PortBroker.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/TimeCodeGenerator.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 using ola::Client;
+using ola::ClientBroker;
+using ola::DeviceManager;
 using ola::NewSingleCallback;
 using ola::SingleUseCallback0;
 using ola::DmxBuffer;
 using ola::OlaServerServiceImpl;
+using ola::PortBroker;
+using ola::PortManager;
+using ola::TimeCodeGenerator;
 using ola::Universe;
 using ola::UniverseStore;
 using ola::rpc::RpcController;
@@ -58,8 +71,14 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testGetDmx);
   CPPUNIT_TEST(testRegisterForDmx);
   CPPUNIT_TEST(testUpdateDmxData);
+  CPPUNIT_TEST(testStreamDmxDataBatch);
+  CPPUNIT_TEST(testGetUniverseStats);
   CPPUNIT_TEST(testSetUniverseName);
   CPPUNIT_TEST(testSetMergeMode);
+  CPPUNIT_TEST(testConfigureBatch);
+  CPPUNIT_TEST(testTimeCodeGenerator);
+  CPPUNIT_TEST(testGetDiscoveredServices);
+  CPPUNIT_TEST(testRDMCommandBatch);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -74,8 +93,14 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
     void testGetDmx();
     void testRegisterForDmx();
     void testUpdateDmxData();
+    void testStreamDmxDataBatch();
+    void testGetUniverseStats();
     void testSetUniverseName();
     void testSetMergeMode();
+    void testConfigureBatch();
+    void testTimeCodeGenerator();
+    void testGetDiscoveredServices();
+    void testRDMCommandBatch();
 
  private:
     ola::rdm::UID m_uid;
@@ -93,6 +118,10 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
                            int universe_id,
                            const DmxBuffer &data,
                            class UpdateDmxDataCheck *check);
+    void CallGetUniverseStats(
+        OlaServerServiceImpl *service,
+        const ola::proto::OptionalUniverseRequest &request,
+        class UniverseStatsCheck *check);
     void CallSetUniverseName(OlaServerServiceImpl *service,
                              int universe_id,
                              const string &name,
@@ -101,6 +130,16 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
                           int universe_id,
                           ola::proto::MergeMode merge_mode,
                           class SetMergeModeCheck *check);
+    void CallConfigureBatch(OlaServerServiceImpl *service,
+                            const ola::proto::ConfigBatchRequest &request,
+                            class ConfigureBatchCheck *check);
+    void CallControlTimeCodeGenerator(
+        OlaServerServiceImpl *service,
+        const ola::proto::TimeCodeGeneratorRequest &request,
+        class TimeCodeGeneratorCheck *check);
+    void CallGetDiscoveredServices(OlaServerServiceImpl *service,
+                                   const string &type,
+                                   class DiscoveredServicesCheck *check);
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OlaServerServiceImplTest);
@@ -167,6 +206,32 @@ class UpdateDmxDataCheck {
 };
 
 
+/*
+ * UniverseStatsCheck
+ */
+class UniverseStatsCheck {
+ public:
+  virtual ~UniverseStatsCheck() {}
+  virtual void Check(RpcController *controller,
+                     ola::proto::UniverseStatsReply *reply) = 0;
+};
+
+
+/*
+ * Assert the request succeeded & keep the reply.
+ */
+class UniverseStatsValidCheck: public UniverseStatsCheck {
+ public:
+  void Check(RpcController *controller,
+             ola::proto::UniverseStatsReply *reply) {
+    OLA_ASSERT_FALSE(controller->Failed());
+    m_reply.CopyFrom(*reply);
+  }
+
+  ola::proto::UniverseStatsReply m_reply;
+};
+
+
 /*
  * SetUniverseNameCheck
  */
@@ -187,6 +252,111 @@ class SetMergeModeCheck {
 };
 
 
+/*
+ * ConfigureBatchCheck
+ */
+class ConfigureBatchCheck {
+ public:
+  virtual ~ConfigureBatchCheck() {}
+  virtual void Check(RpcController *controller, ola::proto::Ack *reply) = 0;
+};
+
+
+/*
+ * Assert that the request failed with the given error.
+ */
+class ConfigureBatchFailedCheck: public ConfigureBatchCheck {
+ public:
+  explicit ConfigureBatchFailedCheck(const string &error) : m_error(error) {}
+
+  void Check(RpcController *controller, OLA_UNUSED ola::proto::Ack *r) {
+    OLA_ASSERT(controller->Failed());
+    OLA_ASSERT_EQ(m_error, controller->ErrorText());
+  }
+
+ private:
+  string m_error;
+};
+
+
+/*
+ * The ControlTimeCodeGenerator checks
+ */
+class TimeCodeGeneratorCheck {
+ public:
+  virtual ~TimeCodeGeneratorCheck() {}
+  virtual void Check(RpcController *controller, ola::proto::Ack *reply) = 0;
+};
+
+
+/*
+ * Assert that the request failed with the given error.
+ */
+class TimeCodeGeneratorFailedCheck: public TimeCodeGeneratorCheck {
+ public:
+  explicit TimeCodeGeneratorFailedCheck(const string &error)
+      : m_error(error) {
+  }
+
+  void Check(RpcController *controller, OLA_UNUSED ola::proto::Ack *r) {
+    OLA_ASSERT(controller->Failed());
+    OLA_ASSERT_EQ(m_error, controller->ErrorText());
+  }
+
+ private:
+  string m_error;
+};
+
+
+/*
+ * Records the reply to a GetDiscoveredServices call.
+ */
+class DiscoveredServicesCheck {
+ public:
+  DiscoveredServicesCheck() : called(false), failed(false) {}
+
+  void Check(RpcController *controller,
+             ola::proto::DiscoveredServicesReply *r) {
+    called = true;
+    failed = controller->Failed();
+    error = controller->ErrorText();
+    reply.CopyFrom(*r);
+  }
+
+  bool called;
+  bool failed;
+  string error;
+  ola::proto::DiscoveredServicesReply reply;
+};
+
+
+/*
+ * A DiscoveryAgent which never touches the network, the services it
+ * returns are added to the cache by the test.
+ */
+class MockDiscoveryAgent: public ola::DiscoveryAgentInterface {
+ public:
+  explicit MockDiscoveryAgent(const ola::Clock *clock) : cache(clock) {}
+
+  bool Init() { return true; }
+
+  void RegisterService(const string&, const string&, uint16_t,
+                       const RegisterOptions&) {
+  }
+
+  bool BrowseServices(const string &type) {
+    cache.AddType(type);
+    return true;
+  }
+
+  bool GetServices(const string &type, std::vector<ServiceInfo> *services) {
+    return cache.GetServices(type, services);
+  }
+
+  ola::DiscoveryCache cache;
+};
+
+
 /*
  * Assert that we got a missing universe error
  */
@@ -315,6 +485,13 @@ void OlaServerServiceImplTest::testRegisterForDmx() {
   CallRegisterForDmx(&service, universe_id, ola::proto::UNREGISTER, &ack_check);
   OLA_ASSERT_FALSE(universe->ContainsSinkClient(NULL));
   OLA_ASSERT_EQ((unsigned int) 0, universe->SinkClientCount());
+
+  // Unused universes are garbage collected, and unregistering doesn't create
+  // them again.
+  store.GarbageCollectUniverses();
+  OLA_ASSERT_EQ(0u, store.UniverseCount());
+  CallRegisterForDmx(&service, universe_id, ola::proto::UNREGISTER, &ack_check);
+  OLA_ASSERT_NULL(store.GetUniverse(universe_id));
 }
 
 
@@ -393,6 +570,133 @@ void OlaServerServiceImplTest::testUpdateDmxData() {
   OLA_ASSERT_EQ(dmx_data2, universe->GetDMX());
 }
 
+/*
+ * Check the StreamDmxDataBatch method works
+ */
+void OlaServerServiceImplTest::testStreamDmxDataBatch() {
+  UniverseStore store(NULL, NULL);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+
+  DmxBuffer dmx_data("this is a test");
+  DmxBuffer dmx_data2("different data hmm");
+  DmxBuffer dmx_data3("more data");
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  ola::proto::DmxDataBatch request;
+  ola::proto::STREAMING_NO_RESPONSE response;
+
+  // Universe 3 doesn't exist, and the second update to universe 1 wins.
+  const struct {
+    unsigned int universe;
+    const DmxBuffer *data;
+  } entries[] = {
+    {1, &dmx_data},
+    {3, &dmx_data},
+    {2, &dmx_data2},
+    {1, &dmx_data3},
+  };
+  for (unsigned int i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+    ola::proto::DmxData *data = request.add_data();
+    data->set_universe(entries[i].universe);
+    data->set_data(entries[i].data->Get());
+  }
+
+  m_clock.CurrentMonotonicTime(&time1);
+  service.StreamDmxDataBatch(&controller, &request, &response, NULL);
+  OLA_ASSERT_EQ(dmx_data3, universe1->GetDMX());
+  OLA_ASSERT_EQ(dmx_data2, universe2->GetDMX());
+  OLA_ASSERT_FALSE(store.GetUniverse(3));
+}
+
+/*
+ * Check the GetUniverseStats method works
+ */
+void OlaServerServiceImplTest::testGetUniverseStats() {
+  UniverseStore store(NULL, NULL);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+  GenericAckCheck<UpdateDmxDataCheck> ack_check;
+  DmxBuffer dmx_data("this is a test");
+  DmxBuffer dmx_data2("this is a tesT");
+
+  store.GetUniverseOrCreate(1);
+  store.GetUniverseOrCreate(2);
+  m_clock.CurrentMonotonicTime(&time1);
+  CallUpdateDmxData(&service, &client, 1, dmx_data, &ack_check);
+  CallUpdateDmxData(&service, &client, 1, dmx_data2, &ack_check);
+
+  // A single universe
+  time1 += ola::TimeInterval(1, 500000);
+  ola::proto::OptionalUniverseRequest request;
+  request.set_universe(1);
+  UniverseStatsValidCheck single_check;
+  CallGetUniverseStats(&service, request, &single_check);
+  OLA_ASSERT_EQ(1, single_check.m_reply.universe_size());
+
+  const ola::proto::UniverseStats &stats = single_check.m_reply.universe(0);
+  OLA_ASSERT_EQ(1, stats.universe());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.input_frames());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.output_frames());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(dmx_data.Size() + 1),
+                stats.changed_slots());
+  OLA_ASSERT_EQ(1u, stats.last_changed_slots());
+  OLA_ASSERT_EQ(1u, stats.source_count());
+  OLA_ASSERT_EQ(1u, stats.active_sources());
+  OLA_ASSERT_TRUE(stats.has_ms_since_input());
+  OLA_ASSERT_TRUE(stats.has_ms_since_output());
+  OLA_ASSERT_LTE(stats.ms_since_input(), 1500u);
+  OLA_ASSERT_GT(stats.ms_since_input(), 1000u);
+
+  // All universes, universe 2 hasn't had any data.
+  request.clear_universe();
+  UniverseStatsValidCheck all_check;
+  CallGetUniverseStats(&service, request, &all_check);
+  OLA_ASSERT_EQ(2, all_check.m_reply.universe_size());
+  const ola::proto::UniverseStats &idle_stats = all_check.m_reply.universe(1);
+  OLA_ASSERT_EQ(2, idle_stats.universe());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), idle_stats.input_frames());
+  OLA_ASSERT_FALSE(idle_stats.has_ms_since_input());
+  OLA_ASSERT_FALSE(idle_stats.has_ms_since_output());
+
+  // A universe that doesn't exist
+  request.set_universe(3);
+  GenericMissingUniverseCheck<UniverseStatsCheck,
+                              ola::proto::UniverseStatsReply>
+    missing_universe_check;
+  CallGetUniverseStats(&service, request, &missing_universe_check);
+}
+
+
+/*
+ * Call the GetUniverseStats method
+ * @param service the OlaServerServiceImpl to use
+ * @param request the request to send
+ * @param check the UniverseStatsCheck to run
+ */
+void OlaServerServiceImplTest::CallGetUniverseStats(
+    OlaServerServiceImpl *service,
+    const ola::proto::OptionalUniverseRequest &request,
+    UniverseStatsCheck *check) {
+  RpcController controller;
+  ola::proto::UniverseStatsReply response;
+
+  SingleUseCallback0<void> *closure = NewSingleCallback(
+      check,
+      &UniverseStatsCheck::Check,
+      &controller,
+      &response);
+  service->GetUniverseStats(&controller, &request, &response, closure);
+}
+
 /*
  * Call the UpdateDmxDataCheck method
  * @param impl the OlaServerServiceImpl to use
@@ -535,3 +839,375 @@ void OlaServerServiceImplTest::CallSetMergeMode(
   request.set_merge_mode(merge_mode);
   service->SetMergeMode(&controller, &request, &response, closure);
 }
+
+
+/*
+ * Check the ConfigureBatch method works
+ */
+void OlaServerServiceImplTest::testConfigureBatch() {
+  UniverseStore store(NULL, NULL);
+  PortBroker broker;
+  PortManager port_manager(&store, &broker);
+  DeviceManager device_manager(NULL, &port_manager);
+  OlaServerServiceImpl service(&store, &device_manager, NULL, &port_manager,
+                               NULL, NULL, NULL);
+
+  // This device doesn't allow looping
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "test device");
+  TestMockInputPort input_port(&device, 1, NULL);
+  TestMockOutputPort output_port(&device, 1);
+  device.AddPort(&input_port);
+  device.AddPort(&output_port);
+  OLA_ASSERT(device_manager.RegisterDevice(&device));
+  unsigned int alias = device_manager.GetDevice(device.UniqueId()).alias;
+
+  GenericAckCheck<ConfigureBatchCheck> ack_check;
+  ConfigureBatchFailedCheck missing_universe_check("Universe doesn't exist");
+  ConfigureBatchFailedCheck missing_device_check("Device doesn't exist");
+  ConfigureBatchFailedCheck patch_failed_check("Patch port request failed");
+
+  // Patch a port to a new universe and configure the universe
+  ola::proto::ConfigBatchRequest request;
+  ola::proto::PatchPortRequest *patch = request.add_patch();
+  patch->set_universe(1);
+  patch->set_device_alias(alias);
+  patch->set_port_id(1);
+  patch->set_action(ola::proto::PATCH);
+  patch->set_is_output(true);
+  ola::proto::PortPriorityRequest *priority = request.add_priority();
+  priority->set_device_alias(alias);
+  priority->set_is_output(false);
+  priority->set_port_id(1);
+  priority->set_priority_mode(ola::PRIORITY_MODE_STATIC);
+  priority->set_priority(150);
+  ola::proto::MergeModeRequest *merge_mode = request.add_merge_mode();
+  merge_mode->set_universe(1);
+  merge_mode->set_merge_mode(ola::proto::LTP);
+  ola::proto::UniverseNameRequest *name = request.add_name();
+  name->set_universe(1);
+  name->set_name("batch universe");
+  CallConfigureBatch(&service, request, &ack_check);
+
+  Universe *universe = store.GetUniverse(1);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_EQ(universe, output_port.GetUniverse());
+  OLA_ASSERT_EQ(string("batch universe"), universe->Name());
+  OLA_ASSERT_EQ(Universe::MERGE_LTP, universe->MergeMode());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), input_port.GetPriority());
+
+  // Nothing is applied if one of the universes doesn't exist
+  request.Clear();
+  patch = request.add_patch();
+  patch->set_universe(2);
+  patch->set_device_alias(alias);
+  patch->set_port_id(1);
+  patch->set_action(ola::proto::PATCH);
+  patch->set_is_output(true);
+  name = request.add_name();
+  name->set_universe(3);
+  name->set_name("missing universe");
+  CallConfigureBatch(&service, request, &missing_universe_check);
+  OLA_ASSERT_EQ(universe, output_port.GetUniverse());
+  OLA_ASSERT_FALSE(store.GetUniverse(3));
+
+  // or one of the devices doesn't exist
+  name->set_universe(2);
+  priority = request.add_priority();
+  priority->set_device_alias(alias + 1);
+  priority->set_is_output(true);
+  priority->set_port_id(1);
+  priority->set_priority_mode(ola::PRIORITY_MODE_INHERIT);
+  CallConfigureBatch(&service, request, &missing_device_check);
+  OLA_ASSERT_EQ(universe, output_port.GetUniverse());
+
+  // Patching the input port to the same universe as the output port creates a
+  // loop, so the output port is restored.
+  request.Clear();
+  patch = request.add_patch();
+  patch->set_universe(2);
+  patch->set_device_alias(alias);
+  patch->set_port_id(1);
+  patch->set_action(ola::proto::PATCH);
+  patch->set_is_output(true);
+  patch = request.add_patch();
+  patch->set_universe(2);
+  patch->set_device_alias(alias);
+  patch->set_port_id(1);
+  patch->set_action(ola::proto::PATCH);
+  patch->set_is_output(false);
+  CallConfigureBatch(&service, request, &patch_failed_check);
+  OLA_ASSERT(output_port.GetUniverse());
+  OLA_ASSERT_EQ(1u, output_port.GetUniverse()->UniverseId());
+  OLA_ASSERT_FALSE(input_port.GetUniverse());
+
+  device_manager.UnregisterAllDevices();
+}
+
+
+/*
+ * Call the ConfigureBatch method
+ * @param impl the OlaServerServiceImpl to use
+ * @param request the request to send
+ * @param check the ConfigureBatchCheck to use for the callback check
+*/
+void OlaServerServiceImplTest::CallConfigureBatch(
+    OlaServerServiceImpl *service,
+    const ola::proto::ConfigBatchRequest &request,
+    ConfigureBatchCheck *check) {
+  RpcSession session(NULL);
+  RpcController controller(&session);
+  ola::proto::Ack response;
+  ola::SingleUseCallback0<void> *closure = NewSingleCallback(
+      check,
+      &ConfigureBatchCheck::Check,
+      &controller,
+      &response);
+
+  service->ConfigureBatch(&controller, &request, &response, closure);
+}
+
+
+/*
+ * Check the ControlTimeCodeGenerator method works
+ */
+void OlaServerServiceImplTest::testTimeCodeGenerator() {
+  UniverseStore store(NULL, NULL);
+  PortBroker broker;
+  PortManager port_manager(&store, &broker);
+  DeviceManager device_manager(NULL, &port_manager);
+  MockScheduler scheduler;
+  TimeCodeGenerator generator(
+      &scheduler, &m_clock,
+      ola::NewCallback(&device_manager, &DeviceManager::SendTimeCode));
+
+  GenericAckCheck<TimeCodeGeneratorCheck> ack_check;
+  TimeCodeGeneratorFailedCheck no_generator_check("No TimeCode generator");
+  TimeCodeGeneratorFailedCheck missing_start_check("Missing start TimeCode");
+  TimeCodeGeneratorFailedCheck invalid_check("Invalid TimeCode");
+
+  ola::proto::TimeCodeGeneratorRequest request;
+  request.set_mode(ola::proto::GENERATOR_STOP);
+
+  // Without a generator, every request fails.
+  OlaServerServiceImpl no_generator_service(
+      &store, &device_manager, NULL, &port_manager, NULL, NULL, NULL);
+  CallControlTimeCodeGenerator(&no_generator_service, request,
+                               &no_generator_check);
+
+  OlaServerServiceImpl service(&store, &device_manager, NULL, &port_manager,
+                               NULL, NULL, NULL, &generator);
+
+  request.set_mode(ola::proto::GENERATOR_RUN);
+  CallControlTimeCodeGenerator(&service, request, &missing_start_check);
+  OLA_ASSERT_FALSE(generator.IsRunning());
+
+  ola::proto::TimeCode *start = request.mutable_start();
+  start->set_type(ola::proto::TIMECODE_EBU);
+  start->set_hours(1);
+  start->set_minutes(0);
+  start->set_seconds(0);
+  start->set_frames(25);
+  CallControlTimeCodeGenerator(&service, request, &invalid_check);
+  OLA_ASSERT_FALSE(generator.IsRunning());
+
+  start->set_frames(24);
+  CallControlTimeCodeGenerator(&service, request, &ack_check);
+  OLA_ASSERT_TRUE(generator.IsRunning());
+  OLA_ASSERT_FALSE(generator.IsChasing());
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+
+  request.Clear();
+  request.set_mode(ola::proto::GENERATOR_STOP);
+  CallControlTimeCodeGenerator(&service, request, &ack_check);
+  OLA_ASSERT_FALSE(generator.IsRunning());
+  OLA_ASSERT_EQ(0u, scheduler.PendingTimeouts());
+
+  // When chasing, SendTimeCode is passed to the generator.
+  request.set_mode(ola::proto::GENERATOR_CHASE);
+  CallControlTimeCodeGenerator(&service, request, &ack_check);
+  OLA_ASSERT_TRUE(generator.IsChasing());
+  OLA_ASSERT_FALSE(generator.IsRunning());
+
+  RpcSession session(NULL);
+  RpcController controller(&session);
+  ola::proto::TimeCode timecode;
+  timecode.set_type(ola::proto::TIMECODE_SMPTE);
+  timecode.set_hours(10);
+  timecode.set_minutes(0);
+  timecode.set_seconds(0);
+  timecode.set_frames(0);
+  ola::proto::Ack response;
+  service.SendTimeCode(
+      &controller, &timecode, &response,
+      NewSingleCallback(
+          static_cast<TimeCodeGeneratorCheck*>(&ack_check),
+          &TimeCodeGeneratorCheck::Check, &controller, &response));
+  OLA_ASSERT_TRUE(generator.IsRunning());
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+}
+
+
+/*
+ * Call the ControlTimeCodeGenerator method
+ * @param impl the OlaServerServiceImpl to use
+ * @param request the request to send
+ * @param check the TimeCodeGeneratorCheck to use for the callback check
+*/
+void OlaServerServiceImplTest::CallControlTimeCodeGenerator(
+    OlaServerServiceImpl *service,
+    const ola::proto::TimeCodeGeneratorRequest &request,
+    TimeCodeGeneratorCheck *check) {
+  RpcSession session(NULL);
+  RpcController controller(&session);
+  ola::proto::Ack response;
+  ola::SingleUseCallback0<void> *closure = NewSingleCallback(
+      check,
+      &TimeCodeGeneratorCheck::Check,
+      &controller,
+      &response);
+
+  service->ControlTimeCodeGenerator(&controller, &request, &response,
+                                    closure);
+}
+
+
+/*
+ * Check that GetDiscoveredServices answers from the agent's cache.
+ */
+void OlaServerServiceImplTest::testGetDiscoveredServices() {
+  UniverseStore store(NULL, NULL);
+  MockDiscoveryAgent agent(&m_clock);
+  const string type = "_http._tcp";
+
+  OlaServerServiceImpl no_agent_service(&store, NULL, NULL, NULL, NULL, NULL,
+                                        NULL);
+  DiscoveredServicesCheck no_agent_check;
+  CallGetDiscoveredServices(&no_agent_service, type, &no_agent_check);
+  OLA_ASSERT_TRUE(no_agent_check.called);
+  OLA_ASSERT_TRUE(no_agent_check.failed);
+  OLA_ASSERT_EQ(string("DNS-SD isn't available"), no_agent_check.error);
+
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, &agent);
+
+  // The first request starts browsing.
+  DiscoveredServicesCheck first_check;
+  CallGetDiscoveredServices(&service, type, &first_check);
+  OLA_ASSERT_FALSE(first_check.failed);
+  OLA_ASSERT_FALSE(first_check.reply.cached());
+  OLA_ASSERT_EQ(0, first_check.reply.service_size());
+  OLA_ASSERT_TRUE(agent.cache.HasType(type));
+
+  ola::DiscoveryCache::ServiceInfo info;
+  info.name = "OLA Server";
+  info.type = type;
+  info.domain = "local";
+  info.host = "ola.local";
+  info.address = ola::network::IPV4Address::FromStringOrDie("10.0.0.1");
+  info.port = 9090;
+  info.if_index = 2;
+  info.txt_data["path"] = "/";
+  agent.cache.UpdateService(info);
+
+  DiscoveredServicesCheck check;
+  CallGetDiscoveredServices(&service, type, &check);
+  OLA_ASSERT_FALSE(check.failed);
+  OLA_ASSERT_TRUE(check.reply.cached());
+  OLA_ASSERT_EQ(1, check.reply.service_size());
+  const ola::proto::DiscoveredService &service_pb = check.reply.service(0);
+  OLA_ASSERT_EQ(info.name, service_pb.name());
+  OLA_ASSERT_EQ(info.host, service_pb.host());
+  OLA_ASSERT_EQ(info.address.AsInt(), service_pb.ip_address());
+  OLA_ASSERT_EQ(9090u, service_pb.port());
+  OLA_ASSERT_EQ(2, service_pb.if_index());
+  OLA_ASSERT_EQ(1, service_pb.txt_size());
+  OLA_ASSERT_EQ(string("path"), service_pb.txt(0).key());
+  OLA_ASSERT_EQ(string("/"), service_pb.txt(0).value());
+}
+
+
+/*
+ * Call the GetDiscoveredServices method
+ * @param impl the OlaServerServiceImpl to use
+ * @param type the service type to request
+ * @param check the DiscoveredServicesCheck to use for the callback check
+*/
+void OlaServerServiceImplTest::CallGetDiscoveredServices(
+    OlaServerServiceImpl *service,
+    const string &type,
+    DiscoveredServicesCheck *check) {
+  RpcSession session(NULL);
+  RpcController controller(&session);
+  ola::proto::DiscoveredServicesRequest request;
+  request.set_type(type);
+  ola::proto::DiscoveredServicesReply response;
+  ola::SingleUseCallback0<void> *closure = NewSingleCallback(
+      check,
+      &DiscoveredServicesCheck::Check,
+      &controller,
+      &response);
+
+  service->GetDiscoveredServices(&controller, &request, &response, closure);
+}
+
+
+static void IncrementCount(unsigned int *count) {
+  (*count)++;
+}
+
+
+/*
+ * Check the RDMCommandBatch method works
+ */
+void OlaServerServiceImplTest::testRDMCommandBatch() {
+  UniverseStore store(NULL, NULL);
+  ClientBroker broker;
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, &broker, NULL, NULL);
+  store.GetUniverseOrCreate(1);
+
+  Client client(NULL, ola::rdm::UID(0x7a70, 1));
+  broker.AddClient(&client);
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+
+  // A universe without ports, a missing universe and a broadcast.
+  ola::proto::RDMBatchRequest request;
+  ola::proto::RDMRequest *rdm_request = request.add_request();
+  rdm_request->set_universe(1);
+  rdm_request->mutable_uid()->set_esta_id(0x7a70);
+  rdm_request->mutable_uid()->set_device_id(2);
+  rdm_request->set_sub_device(0);
+  rdm_request->set_param_id(ola::rdm::PID_DEVICE_INFO);
+  rdm_request->set_data("");
+  rdm_request->set_is_set(false);
+  *request.add_request() = *rdm_request;
+  request.mutable_request(1)->set_universe(2);
+  *request.add_request() = *rdm_request;
+  request.mutable_request(2)->mutable_uid()->set_device_id(0xffffffff);
+  request.mutable_request(2)->set_is_set(true);
+
+  unsigned int done_count = 0;
+  ola::proto::RDMBatchResponse response;
+  service.RDMCommandBatch(&controller, &request, &response,
+                          NewSingleCallback(IncrementCount, &done_count));
+  OLA_ASSERT_EQ(1u, done_count);
+  OLA_ASSERT_FALSE(controller.Failed());
+  OLA_ASSERT_EQ(3, response.response_size());
+  OLA_ASSERT_EQ(ola::proto::RDM_UNKNOWN_UID,
+                response.response(0).response_code());
+  OLA_ASSERT_EQ(ola::proto::RDM_FAILED_TO_SEND,
+                response.response(1).response_code());
+  OLA_ASSERT_EQ(ola::proto::RDM_WAS_BROADCAST,
+                response.response(2).response_code());
+
+  // An empty batch completes straight away.
+  request.Clear();
+  response.Clear();
+  service.RDMCommandBatch(&controller, &request, &response,
+                          NewSingleCallback(IncrementCount, &done_count));
+  OLA_ASSERT_EQ(2u, done_count);
+  OLA_ASSERT_EQ(0, response.response_size());
+  broker.RemoveClient(&client);
+}
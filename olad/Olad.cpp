@@ -63,6 +63,24 @@ DEFINE_string(pid_location, "",
               "The directory containing the PID definitions.");
 DEFINE_s_uint16(http_port, p, ola::OlaServer::DEFAULT_HTTP_PORT,
                 "The port to run the HTTP server on. Defaults to 9090.");
+DEFINE_uint16(http_threads, 0,
+              "The number of threads used to handle HTTP connections. This "
+              "also caches the static web content in memory.");
+DEFINE_string(plugin_threads, "",
+              "Run plugins on their own threads, either 'all' or a comma "
+              "separated list of plugin ids.");
+DEFINE_default_bool(shared_memory, false,
+                    "Pass DMX data to local clients using shared memory.");
+DEFINE_default_bool(udp_streaming, false,
+                    "Accept DMX data from streaming clients over UDP.");
+DEFINE_uint16(udp_stream_port, 0,
+              "The UDP port to accept streamed DMX data on, 0 picks a free "
+              "port.");
+DEFINE_default_bool(low_memory, false,
+                    "Reduce memory use, for systems with little RAM.");
+DEFINE_uint32(stall_threshold_ms, 0,
+              "Log a backtrace of threads that are busy for longer than "
+              "this, 0 disables the stall watchdog.");
 
 /**
  * This is called by the SelectServer loop to start up the SignalThread. If the
@@ -134,8 +152,15 @@ int main(int argc, char *argv[]) {
   options.http_enable_quit = FLAGS_http_quit;
   options.http_port = FLAGS_http_port;
   options.http_data_dir = FLAGS_http_data_dir.str();
+  options.http_threads = FLAGS_http_threads;
   options.network_interface = FLAGS_interface.str();
   options.pid_data_dir = FLAGS_pid_location.str();
+  options.plugin_threads = FLAGS_plugin_threads.str();
+  options.shared_memory = FLAGS_shared_memory;
+  options.udp_streaming = FLAGS_udp_streaming;
+  options.udp_stream_port = FLAGS_udp_stream_port;
+  options.low_memory = FLAGS_low_memory;
+  options.stall_threshold_ms = FLAGS_stall_threshold_ms;
 
   std::auto_ptr<OlaDaemon> olad(new OlaDaemon(options, &export_map));
   if (!olad.get()) {
@@ -20,19 +20,25 @@
 
 #include <sys/time.h>
 #include <iostream>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ola/ActionQueue.h"
 #include "ola/Callback.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/base/Version.h"
+#include "ola/dmx/ReceiveStats.h"
 #include "ola/dmx/SourcePriorities.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/rdm/RDMHelper.h"
 #include "ola/web/Json.h"
+#include "ola/web/JsonStreamWriter.h"
 #include "olad/DmxSource.h"
 #include "olad/HttpServerActions.h"
 #include "olad/OladHTTPServer.h"
@@ -47,12 +53,14 @@ using ola::client::OlaOutputPort;
 using ola::client::OlaPlugin;
 using ola::client::OlaPort;
 using ola::client::OlaUniverse;
+using ola::dmx::ReceiveStats;
 using ola::http::HTTPRequest;
 using ola::http::HTTPResponse;
 using ola::http::HTTPServer;
 using ola::io::ConnectedDescriptor;
 using ola::web::JsonArray;
 using ola::web::JsonObject;
+using ola::web::JsonStreamWriter;
 using std::cout;
 using std::endl;
 using std::ostringstream;
@@ -86,11 +94,13 @@ OladHTTPServer::OladHTTPServer(ExportMap *export_map,
       m_ola_server(ola_server),
       m_enable_quit(options.enable_quit),
       m_interface(iface),
-      m_rdm_module(&m_server, &m_client) {
+      m_rdm_module(&m_server, &m_client),
+      m_dmx_stream_module(&m_server, &m_client) {
   // The main handlers
   RegisterHandler("/quit", &OladHTTPServer::DisplayQuit);
   RegisterHandler("/reload", &OladHTTPServer::ReloadPlugins);
   RegisterHandler("/reload_pids", &OladHTTPServer::ReloadPidStore);
+  RegisterHandler("/debug/memory", &OladHTTPServer::DisplayMemoryUsage);
   RegisterHandler("/new_universe", &OladHTTPServer::CreateNewUniverse);
   RegisterHandler("/modify_universe", &OladHTTPServer::ModifyUniverse);
   RegisterHandler("/set_plugin_state", &OladHTTPServer::SetPluginState);
@@ -99,11 +109,18 @@ OladHTTPServer::OladHTTPServer(ExportMap *export_map,
 
   // json endpoints for the new UI
   RegisterHandler("/json/server_stats", &OladHTTPServer::JsonServerStats);
+  RegisterHandler("/json/universe_stats", &OladHTTPServer::JsonUniverseStats);
   RegisterHandler("/json/universe_plugin_list",
                   &OladHTTPServer::JsonUniversePluginList);
   RegisterHandler("/json/plugin_info", &OladHTTPServer::JsonPluginInfo);
   RegisterHandler("/json/get_ports", &OladHTTPServer::JsonAvailablePorts);
   RegisterHandler("/json/universe_info", &OladHTTPServer::JsonUniverseInfo);
+  RegisterHandler("/json/universe_state", &OladHTTPServer::JsonUniverseState);
+  RegisterHandler("/json/rdm_polled_values",
+                  &OladHTTPServer::JsonRDMPolledValues);
+  RegisterHandler("/json/frame_history", &OladHTTPServer::JsonFrameHistory);
+  RegisterHandler("/json/rdm_responder_stats",
+                  &OladHTTPServer::JsonRDMResponderStats);
 
   // these are the static files for the old UI
   m_server.RegisterFile("/blank.gif", HTTPServer::CONTENT_TYPE_GIF);
@@ -473,6 +490,58 @@ int OladHTTPServer::JsonServerStats(const HTTPRequest*,
 }
 
 
+/**
+ * @brief Print the receive statistics for the network inputs.
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int OladHTTPServer::JsonUniverseStats(const HTTPRequest*,
+                                      HTTPResponse *response) {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+
+  JsonObject json;
+  vector<ola::ReceiveStatsMap*> variables =
+      m_export_map->ReceiveStatsVariables();
+  vector<ola::ReceiveStatsMap*>::const_iterator iter = variables.begin();
+  for (; iter != variables.end(); ++iter) {
+    vector<std::pair<string, ReceiveStats> > snapshot;
+    (*iter)->Snapshot(&snapshot);
+
+    JsonArray *stats_json = json.AddArray((*iter)->Name());
+    vector<std::pair<string, ReceiveStats> >::const_iterator stats_iter =
+        snapshot.begin();
+    for (; stats_iter != snapshot.end(); ++stats_iter) {
+      const ReceiveStats &stats = stats_iter->second;
+      JsonObject *stats_object = stats_json->AppendObject();
+      stats_object->Add((*iter)->Label(), stats_iter->first);
+      stats_object->Add("packets", stats.Packets());
+      stats_object->Add("sequence_gaps", stats.SequenceGaps());
+      stats_object->Add("out_of_order", stats.OutOfOrder());
+      stats_object->Add("jitter_us", stats.JitterMicroSeconds());
+      if (stats.LastSeen().IsSet()) {
+        stats_object->Add(
+            "last_seen_ms",
+            static_cast<int>((now - stats.LastSeen()).InMilliSeconds()));
+      } else {
+        stats_object->Add("last_seen_ms", -1);
+      }
+
+      JsonArray *histogram = stats_object->AddArray("jitter_histogram");
+      for (unsigned int i = 0; i < ReceiveStats::JITTER_BUCKETS; i++) {
+        histogram->Append(stats.JitterCount(i));
+      }
+    }
+  }
+
+  response->SetNoCache();
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+  int r = response->SendJson(json);
+  delete response;
+  return r;
+}
+
+
 /**
  * @brief Print the list of universes / plugins as a json string
  * @param request the HTTPRequest
@@ -542,6 +611,52 @@ int OladHTTPServer::JsonUniverseInfo(OLA_UNUSED const HTTPRequest *request,
 }
 
 
+/**
+ * @brief Return every universe and the ports patched to it.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ *
+ * Unlike the other handlers, this reads the state directly from the
+ * OlaServer, so there's no RPC per universe. Clients can send the returned
+ * ETag in If-None-Match to get a 304 if nothing has changed, in which case
+ * the JSON isn't built.
+ */
+int OladHTTPServer::JsonUniverseState(const HTTPRequest *request,
+                                      HTTPResponse *response) {
+  if (request->CheckParameterExists(HELP_PARAMETER)) {
+    return ServeUsage(response, "");
+  }
+
+  m_ola_server->FetchUniverseState(
+      m_server.SelectServer(),
+      request->GetHeader(MHD_HTTP_HEADER_IF_NONE_MATCH),
+      NewSingleCallback(this,
+                        &OladHTTPServer::HandleUniverseState,
+                        response));
+  return MHD_YES;
+}
+
+
+/**
+ * @brief Return a breakdown of the memory used by olad.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int OladHTTPServer::DisplayMemoryUsage(const HTTPRequest *request,
+                                       HTTPResponse *response) {
+  if (request->CheckParameterExists(HELP_PARAMETER)) {
+    return ServeUsage(response, "");
+  }
+
+  m_ola_server->FetchMemoryUsage(
+      m_server.SelectServer(),
+      NewSingleCallback(this, &OladHTTPServer::HandleMemoryUsage, response));
+  return MHD_YES;
+}
+
+
 /**
  * @brief Return a list of unbound ports
  * @param request the HTTPRequest
@@ -744,6 +859,91 @@ int OladHTTPServer::GetDmx(const HTTPRequest *request,
 }
 
 
+/**
+ * @brief Get the values olad has polled from the RDM devices on a universe.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int OladHTTPServer::JsonRDMPolledValues(const HTTPRequest *request,
+                                        HTTPResponse *response) {
+  if (request->CheckParameterExists(HELP_PARAMETER)) {
+    return ServeUsage(response, "?u=[universe]");
+  }
+  string uni_id = request->GetParameter("u");
+  unsigned int universe_id;
+  if (!StringToInt(uni_id, &universe_id)) {
+    return ServeHelpRedirect(response);
+  }
+
+  m_client.FetchRDMPolledValues(
+      universe_id,
+      NewSingleCallback(this, &OladHTTPServer::HandleRDMPolledValues,
+                        response));
+  return MHD_YES;
+}
+
+
+/**
+ * @brief Get the latency & reliability stats for the RDM responders on a
+ * universe.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int OladHTTPServer::JsonRDMResponderStats(const HTTPRequest *request,
+                                          HTTPResponse *response) {
+  if (request->CheckParameterExists(HELP_PARAMETER)) {
+    return ServeUsage(response, "?u=[universe]");
+  }
+  unsigned int universe_id;
+  if (!StringToInt(request->GetParameter("u"), &universe_id)) {
+    return ServeHelpRedirect(response);
+  }
+
+  m_client.FetchRDMResponderStats(
+      universe_id,
+      NewSingleCallback(this, &OladHTTPServer::HandleRDMResponderStats,
+                        response));
+  return MHD_YES;
+}
+
+
+/**
+ * @brief Get the frames a universe has recently sent.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int OladHTTPServer::JsonFrameHistory(const HTTPRequest *request,
+                                     HTTPResponse *response) {
+  if (request->CheckParameterExists(HELP_PARAMETER)) {
+    return ServeUsage(response, "?u=[universe]&age=[ms]&max=[frames]");
+  }
+  unsigned int universe_id;
+  if (!StringToInt(request->GetParameter("u"), &universe_id)) {
+    return ServeHelpRedirect(response);
+  }
+
+  // Each frame is up to 512 values, so limit the response by default.
+  unsigned int max_age_ms = 0;
+  unsigned int max_frames = K_DEFAULT_HISTORY_FRAMES;
+  string value = request->GetParameter("age");
+  if (!value.empty() && !StringToInt(value, &max_age_ms)) {
+    return ServeHelpRedirect(response);
+  }
+  value = request->GetParameter("max");
+  if (!value.empty() && !StringToInt(value, &max_frames)) {
+    return ServeHelpRedirect(response);
+  }
+
+  m_client.FetchFrameHistory(
+      universe_id, max_age_ms, max_frames,
+      NewSingleCallback(this, &OladHTTPServer::HandleFrameHistory, response));
+  return MHD_YES;
+}
+
+
 /**
  * @brief Handle the set DMX command
  * @param request the HTTPRequest
@@ -801,7 +1001,7 @@ int OladHTTPServer::DisplayQuit(OLA_UNUSED const HTTPRequest *request,
 
 
 /**
- * @brief Reload all plugins
+ * @brief Reload the plugins whose preferences have changed
  * @param request the HTTPRequest
  * @param response the HTTPResponse
  * @returns MHD_NO or MHD_YES
@@ -846,58 +1046,64 @@ void OladHTTPServer::HandlePluginList(HTTPResponse *response,
     return;
   }
 
-  JsonObject *json = new JsonObject();
+  // The JSON is written straight into the response, the universes are added
+  // once they arrive.
+  JsonStreamWriter *json = new JsonStreamWriter(response->MutableData());
+  json->StartObject();
+  json->Key("plugins");
+  json->StartArray();
+  vector<OlaPlugin>::const_iterator iter;
+  for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
+    json->StartObject();
+    json->Add("active", iter->IsActive());
+    json->Add("enabled", iter->IsEnabled());
+    json->Add("id", iter->Id());
+    json->Add("name", iter->Name());
+    json->EndObject();
+  }
+  json->EndArray();
 
-  // fire off the universe request now. the main server is running in a
-  // separate thread.
   m_client.FetchUniverseList(
       NewSingleCallback(this,
                         &OladHTTPServer::HandleUniverseList,
                         response,
                         json));
-
-  JsonArray *plugins_json = json->AddArray("plugins");
-  vector<OlaPlugin>::const_iterator iter;
-  for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
-    JsonObject *plugin = plugins_json->AppendObject();
-    plugin->Add("name", iter->Name());
-    plugin->Add("id", iter->Id());
-    plugin->Add("active", iter->IsActive());
-    plugin->Add("enabled", iter->IsEnabled());
-  }
 }
 
 
 /**
  * @brief Handle the universe list callback
  * @param response the HTTPResponse that is associated with the request.
- * @param json the JsonObject to add the data to
+ * @param json the JsonStreamWriter for the response
  * @param result the result of the API call
  * @param universes the vector of OlaUniverse
  */
 void OladHTTPServer::HandleUniverseList(HTTPResponse *response,
-                                        JsonObject *json,
+                                        JsonStreamWriter *json,
                                         const client::Result &result,
                                         const vector<OlaUniverse> &universes) {
   if (result.Success()) {
-    JsonArray *universe_json = json->AddArray("universes");
-
+    json->Key("universes");
+    json->StartArray();
     vector<OlaUniverse>::const_iterator iter;
     for (iter = universes.begin(); iter != universes.end(); ++iter) {
-      JsonObject *universe = universe_json->AppendObject();
-      universe->Add("id", iter->Id());
-      universe->Add("input_ports", iter->InputPortCount());
-      universe->Add("name", iter->Name());
-      universe->Add("output_ports", iter->OutputPortCount());
-      universe->Add("rdm_devices", iter->RDMDeviceCount());
+      json->StartObject();
+      json->Add("id", iter->Id());
+      json->Add("input_ports", iter->InputPortCount());
+      json->Add("name", iter->Name());
+      json->Add("output_ports", iter->OutputPortCount());
+      json->Add("rdm_devices", iter->RDMDeviceCount());
+      json->EndObject();
     }
+    json->EndArray();
   }
+  json->EndObject();
+  delete json;
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->SendJson(*json);
+  response->Send();
   delete response;
-  delete json;
 }
 
 
@@ -979,10 +1185,15 @@ void OladHTTPServer::HandleUniverseInfo(HTTPResponse *response,
     return;
   }
 
-  JsonObject *json = new JsonObject();
+  // The JSON is written straight into the response, the ports are added once
+  // they arrive.
+  JsonStreamWriter *json = new JsonStreamWriter(response->MutableData());
+  json->StartObject();
+  json->Add("id", universe.Id());
+  json->Add("merge_mode",
+           (universe.MergeMode() == OlaUniverse::MERGE_HTP ? "HTP" : "LTP"));
+  json->Add("name", universe.Name());
 
-  // fire off the device/port request now. the main server is running in a
-  // separate thread.
   m_client.FetchDeviceInfo(
       ola::OLA_PLUGIN_ALL,
       NewSingleCallback(this,
@@ -990,54 +1201,53 @@ void OladHTTPServer::HandleUniverseInfo(HTTPResponse *response,
                         response,
                         json,
                         universe.Id()));
-
-  json->Add("id", universe.Id());
-  json->Add("name", universe.Name());
-  json->Add("merge_mode",
-           (universe.MergeMode() == OlaUniverse::MERGE_HTP ? "HTP" : "LTP"));
 }
 
 
 void OladHTTPServer::HandlePortsForUniverse(
     HTTPResponse *response,
-    JsonObject *json,
+    JsonStreamWriter *json,
     unsigned int universe_id,
     const client::Result &result,
     const vector<OlaDevice> &devices) {
   if (result.Success()) {
-    vector<OlaDevice>::const_iterator iter = devices.begin();
+    vector<OlaDevice>::const_iterator iter;
     vector<OlaInputPort>::const_iterator input_iter;
     vector<OlaOutputPort>::const_iterator output_iter;
 
-    JsonArray *output_ports_json = json->AddArray("output_ports");
-    JsonArray *input_ports_json = json->AddArray("input_ports");
-
-    for (; iter != devices.end(); ++iter) {
+    json->Key("input_ports");
+    json->StartArray();
+    for (iter = devices.begin(); iter != devices.end(); ++iter) {
       const vector<OlaInputPort> &input_ports = iter->InputPorts();
       for (input_iter = input_ports.begin(); input_iter != input_ports.end();
            ++input_iter) {
         if (input_iter->IsActive() && input_iter->Universe() == universe_id) {
-          JsonObject *obj = input_ports_json->AppendObject();
-          PortToJson(obj, *iter, *input_iter, false);
+          PortToJson(json, *iter, *input_iter, false);
         }
       }
+    }
+    json->EndArray();
 
+    json->Key("output_ports");
+    json->StartArray();
+    for (iter = devices.begin(); iter != devices.end(); ++iter) {
       const vector<OlaOutputPort> &output_ports = iter->OutputPorts();
       for (output_iter = output_ports.begin();
            output_iter != output_ports.end(); ++output_iter) {
         if (output_iter->IsActive() &&
             output_iter->Universe() == universe_id) {
-          JsonObject *obj = output_ports_json->AppendObject();
-          PortToJson(obj, *iter, *output_iter, true);
+          PortToJson(json, *iter, *output_iter, true);
         }
       }
     }
+    json->EndArray();
   }
+  json->EndObject();
+  delete json;
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->SendJson(*json);
-  delete json;
+  response->Send();
   delete response;
 }
 
@@ -1061,26 +1271,26 @@ void OladHTTPServer::HandleCandidatePorts(
   vector<OlaInputPort>::const_iterator input_iter;
   vector<OlaOutputPort>::const_iterator output_iter;
 
-  JsonArray json;
+  JsonStreamWriter json(response->MutableData());
+  json.StartArray();
   for (; iter != devices.end(); ++iter) {
     const vector<OlaInputPort> &input_ports = iter->InputPorts();
     for (input_iter = input_ports.begin(); input_iter != input_ports.end();
          ++input_iter) {
-      JsonObject *obj = json.AppendObject();
-      PortToJson(obj, *iter, *input_iter, false);
+      PortToJson(&json, *iter, *input_iter, false);
     }
 
     const vector<OlaOutputPort> &output_ports = iter->OutputPorts();
     for (output_iter = output_ports.begin();
          output_iter != output_ports.end(); ++output_iter) {
-      JsonObject *obj = json.AppendObject();
-      PortToJson(obj, *iter, *output_iter, true);
+      PortToJson(&json, *iter, *output_iter, true);
     }
   }
+  json.EndArray();
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->SendJson(json);
+  response->Send();
   delete response;
 }
 
@@ -1206,6 +1416,149 @@ void OladHTTPServer::HandleGetDmx(HTTPResponse *response,
 }
 
 
+/**
+ * @brief Send the polled RDM values as JSON.
+ */
+void OladHTTPServer::HandleRDMPolledValues(
+    HTTPResponse *response,
+    const client::Result &result,
+    const vector<client::RDMPolledValue> &values) {
+  JsonObject json;
+  json.Add("error", result.Error());
+  JsonArray *values_json = json.AddArray("values");
+  vector<client::RDMPolledValue>::const_iterator iter = values.begin();
+  for (; iter != values.end(); ++iter) {
+    JsonObject *value = values_json->AppendObject();
+    value->Add("uid", iter->uid.ToString());
+    value->Add("sub_device", iter->sub_device);
+    value->Add("pid", iter->param_id);
+    if (iter->has_index) {
+      value->Add("index", iter->index);
+    }
+    JsonArray *data = value->AddArray("data");
+    for (unsigned int i = 0; i < iter->data.size(); i++) {
+      data->Append(static_cast<uint8_t>(iter->data[i]));
+    }
+  }
+
+  response->SetNoCache();
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+  response->SendJson(json);
+  delete response;
+}
+
+
+/**
+ * @brief Send the RDM responder stats as JSON.
+ */
+void OladHTTPServer::HandleRDMResponderStats(
+    HTTPResponse *response,
+    const client::Result &result,
+    const vector<client::RDMResponderStats> &responders) {
+  JsonObject json;
+  json.Add("error", result.Error());
+  JsonArray *responders_json = json.AddArray("responders");
+  vector<client::RDMResponderStats>::const_iterator iter = responders.begin();
+  for (; iter != responders.end(); ++iter) {
+    JsonObject *stats = responders_json->AppendObject();
+    stats->Add("uid", iter->uid.ToString());
+    stats->Add("requests", iter->requests);
+    stats->Add("acks", iter->acks);
+    stats->Add("ack_timers", iter->ack_timers);
+    stats->Add("nacks", iter->nacks);
+    stats->Add("timeouts", iter->timeouts);
+    stats->Add("failures", iter->failures);
+    stats->Add("consecutive_failures", iter->consecutive_failures);
+
+    JsonArray *nacks = stats->AddArray("nack_reasons");
+    std::map<uint16_t, unsigned int>::const_iterator nack_iter =
+        iter->nack_reasons.begin();
+    for (; nack_iter != iter->nack_reasons.end(); ++nack_iter) {
+      JsonObject *nack = nacks->AppendObject();
+      nack->Add("reason", ola::rdm::NackReasonToString(nack_iter->first));
+      nack->Add("count", nack_iter->second);
+    }
+
+    JsonArray *latency = stats->AddArray("latency");
+    vector<client::RDMResponderStats::LatencyBucket>::const_iterator
+        bucket_iter = iter->latency.begin();
+    for (; bucket_iter != iter->latency.end(); ++bucket_iter) {
+      JsonObject *bucket = latency->AppendObject();
+      bucket->Add("limit_ms", bucket_iter->limit_ms);
+      bucket->Add("count", bucket_iter->count);
+    }
+    stats->Add("min_latency_us",
+               static_cast<unsigned int>(iter->min_latency_us));
+    stats->Add("max_latency_us",
+               static_cast<unsigned int>(iter->max_latency_us));
+    stats->Add("mean_latency_us",
+               static_cast<unsigned int>(iter->mean_latency_us));
+  }
+
+  response->SetNoCache();
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+  response->SendJson(json);
+  delete response;
+}
+
+
+/**
+ * @brief Send the frame history as JSON.
+ */
+void OladHTTPServer::HandleFrameHistory(
+    HTTPResponse *response,
+    const client::Result &result,
+    const vector<client::HistoryFrame> &frames) {
+  JsonObject json;
+  json.Add("error", result.Error());
+  JsonArray *frames_json = json.AddArray("frames");
+  vector<client::HistoryFrame>::const_iterator iter = frames.begin();
+  for (; iter != frames.end(); ++iter) {
+    JsonObject *frame = frames_json->AppendObject();
+    frame->Add("age_ms", static_cast<unsigned int>(iter->age_us / 1000));
+    frame->Add("priority", iter->priority);
+    frame->Add("source", iter->source);
+    JsonArray *data = frame->AddArray("data");
+    for (unsigned int i = 0; i < iter->data.Size(); i++) {
+      data->Append(iter->data.Get(i));
+    }
+  }
+
+  response->SetNoCache();
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+  response->SendJson(json);
+  delete response;
+}
+
+
+/**
+ * @brief Send the universe state, or a 304 if the client already has it.
+ * @param response the HTTPResponse
+ * @param if_none_match the If-None-Match header from the request.
+ * @param json the universe state
+ */
+void OladHTTPServer::HandleMemoryUsage(HTTPResponse *response,
+                                       const string &usage) {
+  response->SetNoCache();
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+  response->Append(usage);
+  response->Send();
+  delete response;
+}
+
+
+void OladHTTPServer::HandleUniverseState(
+    HTTPResponse *response,
+    const OlaServer::UniverseState &state) {
+  if (!response->SetValidators(state.etag, state.last_modified)) {
+    response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+    response->Append(state.json);
+  }
+  response->Send();
+  delete response;
+}
+
+
 /**
  * @brief Handle the set DMX response.
  * @param response the HTTPResponse that is associated with the request.
@@ -1225,21 +1578,23 @@ void OladHTTPServer::HandleBoolResponse(HTTPResponse *response,
 
 
 /**
- * @brief Add the json representation of this port to the ostringstream
+ * @brief Write the json representation of this port.
  */
-void OladHTTPServer::PortToJson(JsonObject *json,
+void OladHTTPServer::PortToJson(JsonStreamWriter *json,
                                 const OlaDevice &device,
                                 const OlaPort &port,
                                 bool is_output) {
   ostringstream str;
   str << device.Alias() << "-" << (is_output ? "O" : "I") << "-" << port.Id();
 
-  json->Add("device", device.Name());
+  json->StartObject();
   json->Add("description", port.Description());
+  json->Add("device", device.Name());
   json->Add("id", str.str());
   json->Add("is_output", is_output);
 
-  JsonObject *priority_json = json->AddObject("priority");
+  json->Key("priority");
+  json->StartObject();
   if (port.PriorityCapability() != CAPABILITY_NONE) {
     // This can be used as the default value for the priority input and because
     // inherit ports can return a 0 priority we shall set it to the default
@@ -1249,13 +1604,15 @@ void OladHTTPServer::PortToJson(JsonObject *json,
       // We check here because 0 is an invalid priority outside of Olad
       priority = dmx::SOURCE_PRIORITY_DEFAULT;
     }
-    priority_json->Add("value", static_cast<int>(priority));
-    priority_json->Add(
+    json->Add(
       "current_mode",
       (port.PriorityMode() == PRIORITY_MODE_INHERIT ?  "inherit" : "static"));
-    priority_json->Add("priority_capability",
+    json->Add("priority_capability",
       (port.PriorityCapability() == CAPABILITY_STATIC ? "static" : "full"));
+    json->Add("value", static_cast<int>(priority));
   }
+  json->EndObject();
+  json->EndObject();
 }
 
 
@@ -31,6 +31,9 @@
 #include "ola/http/OlaHTTPServer.h"
 #include "ola/network/Interface.h"
 #include "ola/rdm/PidStore.h"
+#include "ola/web/JsonStreamWriter.h"
+#include "olad/DmxStreamHTTPModule.h"
+#include "olad/OlaServer.h"
 #include "olad/RDMHTTPModule.h"
 
 namespace ola {
@@ -64,6 +67,8 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
 
   int JsonServerStats(const ola::http::HTTPRequest *request,
                       ola::http::HTTPResponse *response);
+  int JsonUniverseStats(const ola::http::HTTPRequest *request,
+                        ola::http::HTTPResponse *response);
   int JsonUniversePluginList(const ola::http::HTTPRequest *request,
                              ola::http::HTTPResponse *response);
   int JsonPluginInfo(const ola::http::HTTPRequest *request,
@@ -72,6 +77,10 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
                      ola::http::HTTPResponse *response);
   int JsonUniverseInfo(const ola::http::HTTPRequest *request,
                        ola::http::HTTPResponse *response);
+  int JsonUniverseState(const ola::http::HTTPRequest *request,
+                        ola::http::HTTPResponse *response);
+  int DisplayMemoryUsage(const ola::http::HTTPRequest *request,
+                         ola::http::HTTPResponse *response);
   int JsonAvailablePorts(const ola::http::HTTPRequest *request,
                          ola::http::HTTPResponse *response);
   int CreateNewUniverse(const ola::http::HTTPRequest *request,
@@ -81,6 +90,12 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
 
   int GetDmx(const ola::http::HTTPRequest *request,
              ola::http::HTTPResponse *response);
+  int JsonRDMPolledValues(const ola::http::HTTPRequest *request,
+                          ola::http::HTTPResponse *response);
+  int JsonFrameHistory(const ola::http::HTTPRequest *request,
+                       ola::http::HTTPResponse *response);
+  int JsonRDMResponderStats(const ola::http::HTTPRequest *request,
+                            ola::http::HTTPResponse *response);
   int HandleSetDmx(const ola::http::HTTPRequest *request,
                    ola::http::HTTPResponse *response);
   int DisplayQuit(const ola::http::HTTPRequest *request,
@@ -95,7 +110,7 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
                         const std::vector<client::OlaPlugin> &plugins);
 
   void HandleUniverseList(ola::http::HTTPResponse *response,
-                          ola::web::JsonObject *json,
+                          ola::web::JsonStreamWriter *json,
                           const client::Result &result,
                           const std::vector<client::OlaUniverse> &universes);
 
@@ -113,7 +128,7 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
                           const client::OlaUniverse &universe);
 
   void HandlePortsForUniverse(ola::http::HTTPResponse *response,
-                              ola::web::JsonObject *json,
+                              ola::web::JsonStreamWriter *json,
                               unsigned int universe_id,
                               const client::Result &result,
                               const std::vector<client::OlaDevice> &devices);
@@ -157,6 +172,7 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
   bool m_enable_quit;
   ola::network::Interface m_interface;
   RDMHTTPModule m_rdm_module;
+  DmxStreamHTTPModule m_dmx_stream_module;
   time_t m_start_time_t;
 
   void HandleGetDmx(ola::http::HTTPResponse *response,
@@ -164,10 +180,30 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
                     const client::DMXMetadata &metadata,
                     const DmxBuffer &buffer);
 
+  void HandleRDMPolledValues(
+      ola::http::HTTPResponse *response,
+      const client::Result &result,
+      const std::vector<client::RDMPolledValue> &values);
+
+  void HandleRDMResponderStats(
+      ola::http::HTTPResponse *response,
+      const client::Result &result,
+      const std::vector<client::RDMResponderStats> &responders);
+
+  void HandleFrameHistory(ola::http::HTTPResponse *response,
+                          const client::Result &result,
+                          const std::vector<client::HistoryFrame> &frames);
+
+  void HandleUniverseState(ola::http::HTTPResponse *response,
+                           const OlaServer::UniverseState &state);
+
+  void HandleMemoryUsage(ola::http::HTTPResponse *response,
+                         const std::string &usage);
+
   void HandleBoolResponse(ola::http::HTTPResponse *response,
                           const client::Result &result);
 
-  void PortToJson(ola::web::JsonObject *object,
+  void PortToJson(ola::web::JsonStreamWriter *json,
                   const client::OlaDevice &device,
                   const client::OlaPort &port,
                   bool is_output);
@@ -198,6 +234,7 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
   static const char HELP_REDIRECTION[];
   static const char K_BACKEND_DISCONNECTED_ERROR[];
   static const unsigned int K_UNIVERSE_NAME_LIMIT = 100;
+  static const unsigned int K_DEFAULT_HISTORY_FRAMES = 100;
   static const char K_PRIORITY_VALUE_SUFFIX[];
   static const char K_PRIORITY_MODE_SUFFIX[];
 
@@ -20,29 +20,85 @@
 
 #include "olad/PluginManager.h"
 
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
+#include "olad/Device.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/PluginLoader.h"
+#include "olad/plugin_api/PluginThread.h"
 
 namespace ola {
 
+using std::string;
 using std::vector;
 using std::set;
 
+namespace {
+const char START_TIME_VAR[] = "plugin-start-time-ms";
+}  // namespace
+
+/*
+ * A plugin being started on its own thread. This is deleted by
+ * StartComplete(), which always runs on the main thread.
+ */
+struct PluginManager::StartRequest {
+  StartRequest(PluginManager *manager, AbstractPlugin *plugin)
+      : manager(manager),
+        plugin(plugin),
+        ok(false) {
+  }
+
+  PluginManager *manager;  // NULL if the start was cancelled
+  AbstractPlugin *plugin;
+  bool ok;
+  vector<AbstractDevice*> devices;  // registered during Start()
+  TimeInterval duration;
+};
+
 PluginManager::PluginManager(const vector<PluginLoader*> &plugin_loaders,
                              class PluginAdaptor *plugin_adaptor)
     : m_plugin_loaders(plugin_loaders),
-      m_plugin_adaptor(plugin_adaptor) {
+      m_plugin_adaptor(plugin_adaptor),
+      m_main_ss(NULL),
+      m_thread_all_plugins(false) {
 }
 
 PluginManager::~PluginManager() {
   UnloadAll();
 }
 
+void PluginManager::SetThreadedPlugins(ola::io::SelectServerInterface *ss,
+                                       const string &plugins) {
+  m_main_ss = ss;
+  m_thread_all_plugins = false;
+  m_threaded_plugin_ids.clear();
+
+  if (plugins == "all") {
+    m_thread_all_plugins = true;
+    return;
+  }
+
+  vector<string> plugin_ids;
+  StringSplit(plugins, &plugin_ids, ",");
+  vector<string>::const_iterator iter = plugin_ids.begin();
+  for (; iter != plugin_ids.end(); ++iter) {
+    unsigned int plugin_id;
+    if (!StringToInt(*iter, &plugin_id)) {
+      OLA_WARN << "Invalid plugin id " << *iter;
+      continue;
+    }
+    m_threaded_plugin_ids.insert(static_cast<ola_plugin_id>(plugin_id));
+  }
+}
+
 void PluginManager::LoadAll() {
   m_enabled_plugins.clear();
 
@@ -60,7 +116,6 @@ void PluginManager::LoadAll() {
       if (!STLInsertIfNotPresent(&m_loaded_plugins, plugin->Id(), plugin)) {
         OLA_WARN << "Skipping plugin " << plugin->Name()
                  << " because it's already been loaded";
-        delete plugin;
         continue;
       }
 
@@ -77,18 +132,21 @@ void PluginManager::LoadAll() {
     }
   }
 
-  // The second pass checks for conflicts and starts each plugin
+  // The second pass checks for conflicts and starts each plugin. Plugins that
+  // run on their own thread are started in parallel.
   PluginMap::iterator plugin_iter = m_enabled_plugins.begin();
   for (; plugin_iter != m_enabled_plugins.end(); ++plugin_iter) {
-    StartIfSafe(plugin_iter->second);
+    StartInParallel(plugin_iter->second);
   }
 }
 
 void PluginManager::UnloadAll() {
   PluginMap::iterator plugin_iter = m_loaded_plugins.begin();
   for (; plugin_iter != m_loaded_plugins.end(); ++plugin_iter) {
-    plugin_iter->second->Stop();
+    StopPlugin(plugin_iter->second);
   }
+  STLDeleteValues(&m_plugin_threads);
+  m_deferred_plugins.clear();
   m_loaded_plugins.clear();
   m_active_plugins.clear();
   m_enabled_plugins.clear();
@@ -100,6 +158,36 @@ void PluginManager::UnloadAll() {
   }
 }
 
+unsigned int PluginManager::ReloadChangedPlugins() {
+  unsigned int changed_plugins = 0;
+  PluginMap::iterator iter = m_loaded_plugins.begin();
+  for (; iter != m_loaded_plugins.end(); ++iter) {
+    if (iter->second->ReloadPreferences()) {
+      OLA_INFO << "Preferences for " << iter->second->Name() << " changed";
+      RestartPlugin(iter->second);
+      changed_plugins++;
+    }
+  }
+
+  if (!changed_plugins) {
+    return 0;
+  }
+
+  // Stopping a plugin may have removed a conflict, so try the enabled plugins
+  // that aren't running.
+  StartDeferredPlugins();
+  iter = m_enabled_plugins.begin();
+  for (; iter != m_enabled_plugins.end(); ++iter) {
+    const ola_plugin_id plugin_id = iter->first;
+    if (!STLContains(m_active_plugins, plugin_id) && !IsStarting(plugin_id) &&
+        !STLContains(m_deferred_plugins, plugin_id) &&
+        !CheckForRunningConflicts(iter->second)) {
+      StartInParallel(iter->second);
+    }
+  }
+  return changed_plugins;
+}
+
 void PluginManager::Plugins(vector<AbstractPlugin*> *plugins) const {
   plugins->clear();
   STLValues(m_loaded_plugins, plugins);
@@ -123,6 +211,10 @@ bool PluginManager::IsActive(ola_plugin_id plugin_id) const {
   return STLContains(m_active_plugins, plugin_id);
 }
 
+bool PluginManager::IsStarting(ola_plugin_id plugin_id) const {
+  return STLContains(m_starting_plugins, plugin_id);
+}
+
 bool PluginManager::IsEnabled(ola_plugin_id plugin_id) const {
   return STLContains(m_enabled_plugins, plugin_id);
 }
@@ -133,8 +225,12 @@ void PluginManager::DisableAndStopPlugin(ola_plugin_id plugin_id) {
     return;
   }
 
+  STLRemove(&m_deferred_plugins, plugin_id);
   if (STLRemove(&m_active_plugins, plugin_id)) {
-    plugin->Stop();
+    StopPlugin(plugin);
+  } else if (IsStarting(plugin_id)) {
+    StopPlugin(plugin);
+    StartDeferredPlugins();
   }
 
   if (STLRemove(&m_enabled_plugins, plugin_id)) {
@@ -143,8 +239,8 @@ void PluginManager::DisableAndStopPlugin(ola_plugin_id plugin_id) {
 }
 
 bool PluginManager::EnableAndStartPlugin(ola_plugin_id plugin_id) {
-  if (STLContains(m_active_plugins, plugin_id)) {
-    // Already running, nothing to do.
+  if (STLContains(m_active_plugins, plugin_id) || IsStarting(plugin_id)) {
+    // Already running or starting, nothing to do.
     return true;
   }
 
@@ -193,7 +289,15 @@ bool PluginManager::StartIfSafe(AbstractPlugin *plugin) {
   }
 
   OLA_INFO << "Trying to start " << plugin->Name();
-  bool ok = plugin->Start();
+  Clock clock;
+  TimeStamp start_time, end_time;
+  clock.CurrentMonotonicTime(&start_time);
+  PluginThread *thread = ThreadForPlugin(plugin);
+  bool ok = thread ?
+      thread->RunAndWait(NewSingleCallback(plugin, &AbstractPlugin::Start)) :
+      plugin->Start();
+  clock.CurrentMonotonicTime(&end_time);
+  RecordStartTime(plugin, end_time - start_time);
   if (!ok) {
     OLA_WARN << "Failed to start " << plugin->Name();
   } else {
@@ -204,14 +308,210 @@ bool PluginManager::StartIfSafe(AbstractPlugin *plugin) {
 }
 
 /*
- * @brief Check if this plugin conflicts with any of the running plugins.
+ * @brief Start a plugin, without waiting for it if it runs on its own thread.
+ * @param plugin The plugin to start.
+ *
+ * If the plugin conflicts with a plugin that's still starting, it's tried
+ * again once that plugin has either started or failed.
+ */
+void PluginManager::StartInParallel(AbstractPlugin *plugin) {
+  AbstractPlugin *starting_plugin = FindConflict(plugin, m_starting_plugins);
+  if (starting_plugin) {
+    OLA_INFO << "Waiting for " << starting_plugin->Name()
+             << " to start before trying " << plugin->Name();
+    STLReplace(&m_deferred_plugins, plugin->Id(), plugin);
+    return;
+  }
+
+  PluginThread *thread = CheckForRunningConflicts(plugin) ?
+      NULL : ThreadForPlugin(plugin);
+  if (!thread) {
+    // This logs the conflict, or starts the plugin on the main thread.
+    StartIfSafe(plugin);
+    return;
+  }
+
+  OLA_INFO << "Starting " << plugin->Name() << " in parallel";
+  StartRequest *request = new StartRequest(this, plugin);
+  STLReplace(&m_starting_plugins, plugin->Id(), plugin);
+  STLReplace(&m_start_requests, plugin->Id(), request);
+  thread->Execute(NewSingleCallback(&PluginManager::StartOnThread, request));
+}
+
+/*
+ * @brief Called on the main thread once a plugin started by StartInParallel()
+ * has started or failed.
+ */
+void PluginManager::PluginStarted(const StartRequest &request) {
+  AbstractPlugin *plugin = request.plugin;
+  STLRemove(&m_starting_plugins, plugin->Id());
+  STLRemove(&m_start_requests, plugin->Id());
+  RecordStartTime(plugin, request.duration);
+
+  if (request.ok) {
+    vector<AbstractDevice*>::const_iterator iter = request.devices.begin();
+    for (; iter != request.devices.end(); ++iter) {
+      m_plugin_adaptor->RegisterDevice(*iter);
+    }
+    OLA_INFO << "Started " << plugin->Name();
+    STLReplace(&m_active_plugins, plugin->Id(), plugin);
+  } else {
+    OLA_WARN << "Failed to start " << plugin->Name();
+  }
+  StartDeferredPlugins();
+}
+
+/*
+ * @brief Try to start the plugins that were waiting for a conflicting plugin.
+ */
+void PluginManager::StartDeferredPlugins() {
+  PluginMap deferred_plugins;
+  deferred_plugins.swap(m_deferred_plugins);
+  PluginMap::iterator iter = deferred_plugins.begin();
+  for (; iter != deferred_plugins.end(); ++iter) {
+    StartInParallel(iter->second);
+  }
+}
+
+/*
+ * @brief Stop a plugin if it's running, then start it again if it's enabled.
+ */
+void PluginManager::RestartPlugin(AbstractPlugin *plugin) {
+  const ola_plugin_id plugin_id = plugin->Id();
+  STLRemove(&m_deferred_plugins, plugin_id);
+  if (STLRemove(&m_active_plugins, plugin_id) || IsStarting(plugin_id)) {
+    OLA_INFO << "Stopping " << plugin->Name();
+    StopPlugin(plugin);
+  }
+
+  if (plugin->IsEnabled()) {
+    STLReplace(&m_enabled_plugins, plugin_id, plugin);
+    StartInParallel(plugin);
+  } else {
+    STLRemove(&m_enabled_plugins, plugin_id);
+  }
+}
+
+/*
+ * @brief Forget about a plugin that was started by StartInParallel().
+ *
+ * The completion may already be queued on the main thread, it's ignored.
+ */
+void PluginManager::CancelStart(ola_plugin_id plugin_id) {
+  StartRequest *request = STLFindOrNull(m_start_requests, plugin_id);
+  if (request) {
+    request->manager = NULL;
+    STLRemove(&m_start_requests, plugin_id);
+  }
+  STLRemove(&m_starting_plugins, plugin_id);
+}
+
+void PluginManager::RecordStartTime(const AbstractPlugin *plugin,
+                                    const TimeInterval &duration) {
+  OLA_INFO << plugin->Name() << " took " << duration << " to start";
+  ExportMap *export_map = m_plugin_adaptor->GetExportMap();
+  if (export_map) {
+    export_map->GetUIntMapVar(START_TIME_VAR, "plugin")->Set(
+        plugin->Name(), duration.InMilliSeconds());
+  }
+}
+
+/*
+ * @brief Start a plugin, this is run on the plugin's thread.
+ */
+void PluginManager::StartOnThread(StartRequest *request) {
+  PluginThread *thread = PluginThread::Current();
+  Clock clock;
+  TimeStamp start_time, end_time;
+  clock.CurrentMonotonicTime(&start_time);
+
+  thread->BeginStart();
+  request->ok = request->plugin->Start();
+  thread->EndStart(&request->devices);
+
+  clock.CurrentMonotonicTime(&end_time);
+  request->duration = end_time - start_time;
+  thread->ReturnToMain(
+      NewSingleCallback(&PluginManager::StartComplete, request));
+}
+
+void PluginManager::StartComplete(StartRequest *request_ptr) {
+  std::auto_ptr<StartRequest> request(request_ptr);
+  if (request->manager) {
+    request->manager->PluginStarted(*request);
+  }
+}
+
+void PluginManager::StopPlugin(AbstractPlugin *plugin) {
+  PluginThread *thread = STLFindOrNull(m_plugin_threads, plugin->Id());
+  if (thread) {
+    // If the plugin is still starting, this waits for Start() to return.
+    thread->RunAndWait(NewSingleCallback(plugin, &AbstractPlugin::Stop));
+    thread->PluginStopped();
+  } else {
+    plugin->Stop();
+  }
+  CancelStart(plugin->Id());
+}
+
+/*
+ * @brief Get the PluginThread to run a plugin on.
+ * @param plugin The plugin to check.
+ * @returns The PluginThread, or NULL if the plugin runs on the main thread.
+ */
+PluginThread *PluginManager::ThreadForPlugin(AbstractPlugin *plugin) {
+  PluginThread *thread = STLFindOrNull(m_plugin_threads, plugin->Id());
+  if (thread) {
+    return thread;
+  }
+
+  if (!m_main_ss ||
+      !(m_thread_all_plugins ||
+        STLContains(m_threaded_plugin_ids, plugin->Id()))) {
+    return NULL;
+  }
+
+  if (!plugin->SupportsThreading()) {
+    if (!m_thread_all_plugins) {
+      OLA_WARN << plugin->Name() << " can't be run on its own thread";
+    }
+    return NULL;
+  }
+
+  thread = new PluginThread("plugin-" + IntToString(plugin->Id()), m_main_ss);
+  if (!thread->Start()) {
+    OLA_WARN << "Failed to start thread for " << plugin->Name()
+             << ", running it on the main thread";
+    delete thread;
+    return NULL;
+  }
+  OLA_INFO << "Running " << plugin->Name() << " on its own thread";
+  STLReplace(&m_plugin_threads, plugin->Id(), thread);
+  return thread;
+}
+
+/*
+ * @brief Check if this plugin conflicts with any running or starting plugins.
  * @param plugin The plugin to check
  * @returns The first conflicting plugin, or NULL if there aren't any.
  */
 AbstractPlugin* PluginManager::CheckForRunningConflicts(
     const AbstractPlugin *plugin) const {
-  PluginMap::const_iterator iter = m_active_plugins.begin();
-  for (; iter != m_active_plugins.end(); ++iter) {
+  AbstractPlugin *conflicting_plugin = FindConflict(plugin, m_active_plugins);
+  return conflicting_plugin ?
+      conflicting_plugin : FindConflict(plugin, m_starting_plugins);
+}
+
+/*
+ * @brief Check if this plugin conflicts with any of a set of plugins.
+ * @param plugin The plugin to check
+ * @param plugins The plugins to check against.
+ * @returns The first conflicting plugin, or NULL if there aren't any.
+ */
+AbstractPlugin* PluginManager::FindConflict(const AbstractPlugin *plugin,
+                                            const PluginMap &plugins) const {
+  PluginMap::const_iterator iter = plugins.begin();
+  for (; iter != plugins.end(); ++iter) {
     set<ola_plugin_id> conflict_list;
     iter->second->ConflictsWith(&conflict_list);
     if (STLContains(conflict_list, plugin->Id())) {
@@ -223,8 +523,7 @@ AbstractPlugin* PluginManager::CheckForRunningConflicts(
   plugin->ConflictsWith(&conflict_list);
   set<ola_plugin_id>::const_iterator set_iter = conflict_list.begin();
   for (; set_iter != conflict_list.end(); ++set_iter) {
-    AbstractPlugin *conflicting_plugin = STLFindOrNull(
-        m_active_plugins, *set_iter);
+    AbstractPlugin *conflicting_plugin = STLFindOrNull(plugins, *set_iter);
     if (conflicting_plugin) {
       return conflicting_plugin;
     }
@@ -22,15 +22,20 @@
 #define OLAD_PLUGINMANAGER_H_
 
 #include <map>
+#include <set>
+#include <string>
 #include <vector>
 
+#include "ola/Clock.h"
 #include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/plugin_id.h"
 
 namespace ola {
 
 class PluginLoader;
 class PluginAdaptor;
+class PluginThread;
 class AbstractPlugin;
 
 /**
@@ -48,6 +53,15 @@ class AbstractPlugin;
  *
  * Plugins are active if they weren't disabled, there were no conflicts that
  * prevented them from loading, and the call to Start() was successful.
+ *
+ * Plugins that run on their own PluginThread are started in parallel by
+ * LoadAll(), so a plugin that's slow to start doesn't hold up the others, or
+ * the main thread. If a plugin conflicts with one that's still starting, it
+ * waits until the first plugin has either started or failed. The time each
+ * plugin took to start is exported as plugin-start-time-ms.
+ *
+ * ReloadChangedPlugins() only restarts the plugins whose preferences have
+ * changed, the devices of the other plugins are left alone.
  */
 class PluginManager {
  public:
@@ -64,10 +78,23 @@ class PluginManager {
    */
   ~PluginManager();
 
+  /**
+   * @brief Run plugins on their own PluginThreads.
+   * @param ss the SelectServer of the main thread.
+   * @param plugins either "all", to run every plugin that supports it on its
+   *   own thread, or a comma separated list of plugin ids.
+   *
+   * This must be called before LoadAll().
+   */
+  void SetThreadedPlugins(ola::io::SelectServerInterface *ss,
+                          const std::string &plugins);
+
   /**
    * @brief Attempt to load all the plugins and start them.
    *
    * Some plugins may not be started due to conflicts or being disabled.
+   * Plugins that run on their own thread may still be starting when this
+   * returns, they become active once the main thread runs the completion.
    */
   void LoadAll();
 
@@ -76,6 +103,16 @@ class PluginManager {
    */
   void UnloadAll();
 
+  /**
+   * @brief Re-read the preferences of each plugin, and restart the plugins
+   *   whose preferences have changed.
+   * @returns the number of plugins that were restarted, stopped or started.
+   *
+   * Plugins that have been disabled are stopped. If that resolves a conflict,
+   * the plugin that was blocked is started.
+   */
+  unsigned int ReloadChangedPlugins();
+
   /**
    * @brief Return the list of loaded plugins.
    * @param[out] plugins the list of plugins.
@@ -110,6 +147,13 @@ class PluginManager {
    */
   bool IsActive(ola_plugin_id plugin_id) const;
 
+  /**
+   * @brief Check if a plugin is being started on its own thread.
+   * @param plugin_id the id of the plugin to check.
+   * @returns true if the plugin is starting, false otherwise.
+   */
+  bool IsStarting(ola_plugin_id plugin_id) const;
+
   /**
    * @brief Check if a plugin is enabled.
    * @param plugin_id the id of the plugin to check.
@@ -144,15 +188,39 @@ class PluginManager {
 
  private:
   typedef std::map<ola_plugin_id, AbstractPlugin*> PluginMap;
+  typedef std::map<ola_plugin_id, PluginThread*> PluginThreadMap;
+
+  struct StartRequest;
+  typedef std::map<ola_plugin_id, StartRequest*> StartRequestMap;
 
   std::vector<PluginLoader*> m_plugin_loaders;
   PluginMap m_loaded_plugins;  // plugins that are loaded
   PluginMap m_active_plugins;  // active plugins
   PluginMap m_enabled_plugins;  // enabled plugins
   PluginAdaptor *m_plugin_adaptor;
+  ola::io::SelectServerInterface *m_main_ss;
+  bool m_thread_all_plugins;
+  std::set<ola_plugin_id> m_threaded_plugin_ids;
+  PluginThreadMap m_plugin_threads;
+  PluginMap m_starting_plugins;  // plugins starting on their own thread
+  StartRequestMap m_start_requests;
+  PluginMap m_deferred_plugins;  // waiting for a conflicting plugin to start
 
   bool StartIfSafe(AbstractPlugin *plugin);
+  void StartInParallel(AbstractPlugin *plugin);
+  void PluginStarted(const StartRequest &request);
+  void StartDeferredPlugins();
+  void RestartPlugin(AbstractPlugin *plugin);
+  void CancelStart(ola_plugin_id plugin_id);
+  void RecordStartTime(const AbstractPlugin *plugin,
+                       const TimeInterval &duration);
+  static void StartOnThread(StartRequest *request);
+  static void StartComplete(StartRequest *request);
+  void StopPlugin(AbstractPlugin *plugin);
+  PluginThread *ThreadForPlugin(AbstractPlugin *plugin);
   AbstractPlugin* CheckForRunningConflicts(const AbstractPlugin *plugin) const;
+  AbstractPlugin* FindConflict(const AbstractPlugin *plugin,
+                               const PluginMap &plugins) const;
 
   DISALLOW_COPY_AND_ASSIGN(PluginManager);
 };
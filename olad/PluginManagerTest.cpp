@@ -19,16 +19,24 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <iterator>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "ola/ExportMap.h"
+#include "ola/io/SelectServer.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/PluginLoader.h"
 #include "olad/PluginManager.h"
+#include "olad/PortBroker.h"
 #include "olad/Preferences.h"
+#include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/PluginThread.h"
+#include "olad/plugin_api/PortManager.h"
 #include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
 #include "ola/testing/TestUtils.h"
 
 
@@ -44,11 +52,15 @@ class PluginManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(PluginManagerTest);
   CPPUNIT_TEST(testPluginManager);
   CPPUNIT_TEST(testConflictingPlugins);
+  CPPUNIT_TEST(testParallelStart);
+  CPPUNIT_TEST(testReloadChangedPlugins);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testPluginManager();
     void testConflictingPlugins();
+    void testParallelStart();
+    void testReloadChangedPlugins();
 
     void setUp() {
       ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
@@ -98,6 +110,87 @@ class MockLoader: public ola::PluginLoader {
 };
 
 
+/*
+ * A plugin that runs on its own thread, and registers a device when it's
+ * started.
+ */
+class ThreadedMockPlugin: public TestMockPlugin {
+ public:
+    ThreadedMockPlugin(ola::PluginAdaptor *plugin_adaptor,
+                       ola::ola_plugin_id plugin_id,
+                       const set<ola::ola_plugin_id> &conflict_set)
+      : TestMockPlugin(plugin_adaptor, plugin_id, conflict_set),
+        m_start_thread(NULL),
+        m_device(NULL) {
+    }
+
+    bool SupportsThreading() const { return true; }
+
+    bool StartHook() {
+      m_start_thread = ola::PluginThread::Current();
+      m_device = new MockDevice(this, "threaded device " + Name());
+      if (!m_plugin_adaptor->RegisterDevice(m_device)) {
+        return false;
+      }
+      return TestMockPlugin::StartHook();
+    }
+
+    bool StopHook() {
+      m_plugin_adaptor->UnregisterDevice(m_device);
+      delete m_device;
+      m_device = NULL;
+      return TestMockPlugin::StopHook();
+    }
+
+    ola::PluginThread *StartThread() const { return m_start_thread; }
+
+ private:
+    ola::PluginThread *m_start_thread;
+    MockDevice *m_device;
+};
+
+
+/*
+ * A plugin where the test controls the result of ReloadPreferences().
+ */
+class ReloadableMockPlugin: public TestMockPlugin {
+ public:
+    ReloadableMockPlugin(ola::PluginAdaptor *plugin_adaptor,
+                         ola::ola_plugin_id plugin_id,
+                         const set<ola::ola_plugin_id> &conflict_set)
+      : TestMockPlugin(plugin_adaptor, plugin_id, conflict_set),
+        m_enabled(true),
+        m_changed(false),
+        m_start_count(0) {
+    }
+
+    bool IsEnabled() const { return m_enabled; }
+
+    bool ReloadPreferences() {
+      bool changed = m_changed;
+      m_changed = false;
+      return changed;
+    }
+
+    bool StartHook() {
+      m_start_count++;
+      return TestMockPlugin::StartHook();
+    }
+
+    void ChangePreferences(bool enabled) {
+      m_enabled = enabled;
+      m_changed = true;
+    }
+
+    unsigned int StartCount() const { return m_start_count; }
+
+ private:
+    bool m_enabled;
+    bool m_changed;
+    unsigned int m_start_count;
+};
+
+
 /*
  * Check that we can load & unload plugins correctly.
  */
@@ -181,3 +274,140 @@ void PluginManagerTest::testConflictingPlugins() {
   manager.UnloadAll();
   VerifyPluginCounts(&manager, 0, 0, OLA_SOURCELINE());
 }
+
+
+/*
+ * Check that plugins on their own threads are started in parallel.
+ */
+void PluginManagerTest::testParallelStart() {
+  ola::io::SelectServer ss;
+  ola::ExportMap export_map;
+  ola::MemoryPreferencesFactory factory;
+  ola::UniverseStore store(NULL, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+  ola::DeviceManager device_manager(&factory, &port_manager);
+  ola::PluginAdaptor adaptor(&device_manager, &ss, &export_map, &factory,
+                             &broker, NULL);
+
+  // The ESP Net plugin conflicts with the Art-Net one, so it has to wait for
+  // the Art-Net plugin to start.
+  set<ola::ola_plugin_id> no_conflicts, conflict_set;
+  conflict_set.insert(ola::OLA_PLUGIN_ARTNET);
+  ThreadedMockPlugin plugin1(&adaptor, ola::OLA_PLUGIN_ARTNET, no_conflicts);
+  ThreadedMockPlugin plugin2(&adaptor, ola::OLA_PLUGIN_ESPNET, conflict_set);
+  ThreadedMockPlugin plugin3(&adaptor, ola::OLA_PLUGIN_SANDNET, no_conflicts);
+  TestMockPlugin plugin4(&adaptor, ola::OLA_PLUGIN_DUMMY);
+
+  vector<AbstractPlugin*> our_plugins;
+  our_plugins.push_back(&plugin1);
+  our_plugins.push_back(&plugin2);
+  our_plugins.push_back(&plugin3);
+  our_plugins.push_back(&plugin4);
+
+  MockLoader loader(our_plugins);
+  vector<PluginLoader*> loaders;
+  loaders.push_back(&loader);
+
+  PluginManager manager(loaders, &adaptor);
+  manager.SetThreadedPlugins(&ss, "all");
+  manager.LoadAll();
+
+  // The dummy plugin doesn't support threading so it's started straight away.
+  OLA_ASSERT_TRUE(plugin4.IsRunning());
+  OLA_ASSERT_TRUE(manager.IsStarting(ola::OLA_PLUGIN_ARTNET));
+  OLA_ASSERT_FALSE(manager.IsStarting(ola::OLA_PLUGIN_ESPNET));
+  OLA_ASSERT_TRUE(manager.IsStarting(ola::OLA_PLUGIN_SANDNET));
+  VerifyPluginCounts(&manager, 4, 1, OLA_SOURCELINE());
+
+  while (manager.IsStarting(ola::OLA_PLUGIN_ARTNET) ||
+         manager.IsStarting(ola::OLA_PLUGIN_SANDNET)) {
+    ss.RunOnce(ola::TimeInterval(0, 10000));
+  }
+
+  // The devices are registered by the main thread.
+  VerifyPluginCounts(&manager, 4, 3, OLA_SOURCELINE());
+  OLA_ASSERT_EQ(2u, device_manager.DeviceCount());
+  OLA_ASSERT_NOT_NULL(plugin1.StartThread());
+  OLA_ASSERT_NOT_NULL(plugin3.StartThread());
+  OLA_ASSERT_NE(plugin1.StartThread(), plugin3.StartThread());
+
+  // Once the Art-Net plugin was running, the ESP Net plugin was skipped.
+  OLA_ASSERT_TRUE(manager.IsActive(ola::OLA_PLUGIN_ARTNET));
+  OLA_ASSERT_FALSE(manager.IsActive(ola::OLA_PLUGIN_ESPNET));
+  OLA_ASSERT_FALSE(manager.IsStarting(ola::OLA_PLUGIN_ESPNET));
+  OLA_ASSERT_NULL(plugin2.StartThread());
+
+  ola::UIntMap *start_times = export_map.GetUIntMapVar("plugin-start-time-ms");
+  OLA_ASSERT_EQ(static_cast<ptrdiff_t>(3),
+                std::distance(start_times->Begin(), start_times->End()));
+
+  manager.UnloadAll();
+  VerifyPluginCounts(&manager, 0, 0, OLA_SOURCELINE());
+  OLA_ASSERT_EQ(0u, device_manager.DeviceCount());
+}
+
+
+/*
+ * Check that only the plugins with changed preferences are restarted.
+ */
+void PluginManagerTest::testReloadChangedPlugins() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  // The ESP Net plugin conflicts with the Art-Net one.
+  set<ola::ola_plugin_id> no_conflicts, conflict_set;
+  conflict_set.insert(ola::OLA_PLUGIN_ARTNET);
+  ReloadableMockPlugin plugin1(&adaptor, ola::OLA_PLUGIN_DUMMY, no_conflicts);
+  ReloadableMockPlugin plugin2(&adaptor, ola::OLA_PLUGIN_ARTNET,
+                               no_conflicts);
+  ReloadableMockPlugin plugin3(&adaptor, ola::OLA_PLUGIN_ESPNET,
+                               conflict_set);
+
+  vector<AbstractPlugin*> our_plugins;
+  our_plugins.push_back(&plugin1);
+  our_plugins.push_back(&plugin2);
+  our_plugins.push_back(&plugin3);
+
+  MockLoader loader(our_plugins);
+  vector<PluginLoader*> loaders;
+  loaders.push_back(&loader);
+
+  PluginManager manager(loaders, &adaptor);
+  manager.LoadAll();
+  VerifyPluginCounts(&manager, 3, 2, OLA_SOURCELINE());
+  OLA_ASSERT_FALSE(plugin3.IsRunning());
+
+  // Nothing has changed.
+  OLA_ASSERT_EQ(0u, manager.ReloadChangedPlugins());
+  OLA_ASSERT_EQ(1u, plugin1.StartCount());
+  OLA_ASSERT_EQ(1u, plugin2.StartCount());
+
+  // Only the dummy plugin is restarted.
+  plugin1.ChangePreferences(true);
+  OLA_ASSERT_EQ(1u, manager.ReloadChangedPlugins());
+  VerifyPluginCounts(&manager, 3, 2, OLA_SOURCELINE());
+  OLA_ASSERT_TRUE(plugin1.IsRunning());
+  OLA_ASSERT_EQ(2u, plugin1.StartCount());
+  OLA_ASSERT_EQ(1u, plugin2.StartCount());
+  OLA_ASSERT_EQ(0u, plugin3.StartCount());
+
+  // Disabling the Art-Net plugin lets the ESP Net plugin start.
+  plugin2.ChangePreferences(false);
+  OLA_ASSERT_EQ(1u, manager.ReloadChangedPlugins());
+  VerifyPluginCounts(&manager, 3, 2, OLA_SOURCELINE());
+  OLA_ASSERT_FALSE(plugin2.IsRunning());
+  OLA_ASSERT_FALSE(manager.IsEnabled(ola::OLA_PLUGIN_ARTNET));
+  OLA_ASSERT_TRUE(plugin3.IsRunning());
+  OLA_ASSERT_EQ(2u, plugin1.StartCount());
+
+  // Enabling it again doesn't stop the ESP Net plugin.
+  plugin2.ChangePreferences(true);
+  OLA_ASSERT_EQ(1u, manager.ReloadChangedPlugins());
+  OLA_ASSERT_FALSE(plugin2.IsRunning());
+  OLA_ASSERT_TRUE(manager.IsEnabled(ola::OLA_PLUGIN_ARTNET));
+  OLA_ASSERT_TRUE(plugin3.IsRunning());
+
+  manager.UnloadAll();
+  VerifyPluginCounts(&manager, 0, 0, OLA_SOURCELINE());
+}
@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMDecodeCache.cpp
+ * Decodes RDM responses using the PID store & caches the results.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/RDMDecodeCache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "ola/Logging.h"
+#include "ola/messaging/Descriptor.h"
+#include "ola/messaging/Message.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+
+using ola::rdm::PidDescriptor;
+using ola::rdm::PidStoreHelper;
+using ola::rdm::RootPidStore;
+using std::auto_ptr;
+using std::string;
+
+const unsigned int RDMDecodeCache::DEFAULT_MAX_SIZE;
+
+RDMDecodeCache::RDMDecodeCache(unsigned int max_size)
+    : m_max_size(max_size ? max_size : 1),
+      m_hits(0),
+      m_misses(0) {
+}
+
+void RDMDecodeCache::SetPidStore(const RootPidStore *pid_store) {
+  Clear();
+  m_helper.reset(pid_store ? new PidStoreHelper(pid_store) : NULL);
+}
+
+bool RDMDecodeCache::Decode(uint16_t manufacturer_id,
+                            bool is_set,
+                            uint16_t pid,
+                            const string &data,
+                            string *pid_name,
+                            string *decoded) {
+  if (!m_helper.get()) {
+    return false;
+  }
+
+  string key;
+  key.reserve(5 + data.size());
+  key.push_back(static_cast<char>(manufacturer_id >> 8));
+  key.push_back(static_cast<char>(manufacturer_id & 0xff));
+  key.push_back(is_set ? 1 : 0);
+  key.push_back(static_cast<char>(pid >> 8));
+  key.push_back(static_cast<char>(pid & 0xff));
+  key.append(data);
+
+  const DecodedResponse *response;
+  EntryList::iterator *entry = STLFind(&m_entries, key);
+  if (entry) {
+    m_hits++;
+    m_lru.splice(m_lru.begin(), m_lru, *entry);
+    response = &(*entry)->second;
+  } else {
+    m_misses++;
+    if (m_entries.size() >= m_max_size) {
+      m_entries.erase(m_lru.back().first);
+      m_lru.pop_back();
+    }
+    m_lru.push_front(std::make_pair(key, DecodedResponse()));
+    m_entries[key] = m_lru.begin();
+    DecodeResponse(manufacturer_id, is_set, pid, data,
+                   &m_lru.front().second);
+    response = &m_lru.front().second;
+  }
+
+  if (!response->decoded) {
+    return false;
+  }
+  *pid_name = response->pid_name;
+  *decoded = response->text;
+  return true;
+}
+
+void RDMDecodeCache::DecodeResponse(uint16_t manufacturer_id,
+                                    bool is_set,
+                                    uint16_t pid,
+                                    const string &data,
+                                    DecodedResponse *response) {
+  response->decoded = false;
+
+  const PidDescriptor *pid_descriptor = m_helper->GetDescriptor(
+      pid, manufacturer_id);
+  if (!pid_descriptor) {
+    OLA_DEBUG << "Unknown PID " << pid << ", not decoding";
+    return;
+  }
+
+  const ola::messaging::Descriptor *descriptor = is_set ?
+      pid_descriptor->SetResponse() : pid_descriptor->GetResponse();
+  if (!descriptor) {
+    return;
+  }
+
+  auto_ptr<const ola::messaging::Message> message(
+      m_helper->DeserializeMessage(
+          descriptor, reinterpret_cast<const uint8_t*>(data.data()),
+          data.size()));
+  if (!message.get()) {
+    OLA_DEBUG << "Failed to decode response to " << pid_descriptor->Name();
+    return;
+  }
+
+  response->decoded = true;
+  response->pid_name = pid_descriptor->Name();
+  response->text = m_helper->PrettyPrintMessage(manufacturer_id, is_set, pid,
+                                                message.get());
+}
+
+void RDMDecodeCache::Clear() {
+  m_entries.clear();
+  m_lru.clear();
+}
+}  // namespace ola
@@ -0,0 +1,127 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMDecodeCache.h
+ * Decodes RDM responses using the PID store & caches the results.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_RDMDECODECACHE_H_
+#define OLAD_RDMDECODECACHE_H_
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "ola/base/Macro.h"
+#include "ola/rdm/PidStore.h"
+#include "ola/rdm/PidStoreHelper.h"
+
+namespace ola {
+
+/**
+ * @brief Decodes the parameter data of RDM responses.
+ *
+ * Clients can ask olad to decode responses, which saves them from loading the
+ * PID store themselves. Devices tend to be polled for the same parameters
+ * over and over, so the decoded text is cached, keyed on the PID and the raw
+ * parameter data. Once the cache is full the least recently used entry is
+ * dropped.
+ *
+ * This isn't thread safe, it's used from the SelectServer thread.
+ */
+class RDMDecodeCache {
+ public:
+  explicit RDMDecodeCache(unsigned int max_size = DEFAULT_MAX_SIZE);
+  ~RDMDecodeCache() {}
+
+  /**
+   * @brief Set the PID store to decode with.
+   * @param pid_store the store to use, ownership is not transferred. The
+   *   store must remain valid until this is called again. May be NULL, in
+   *   which case nothing is decoded.
+   *
+   * This clears the cache.
+   */
+  void SetPidStore(const ola::rdm::RootPidStore *pid_store);
+
+  /**
+   * @brief Decode the parameter data of an ACK.
+   * @param manufacturer_id the ESTA id of the responder, used to look up
+   *   manufacturer specific PIDs.
+   * @param is_set true if this is the response to a SET.
+   * @param pid the PID of the response.
+   * @param data the parameter data.
+   * @param pid_name set to the name of the PID.
+   * @param decoded set to the human readable form of the data.
+   * @returns true if the data was decoded, false if there is no PID store,
+   *   the PID isn't known or the data doesn't match the PID's definition.
+   */
+  bool Decode(uint16_t manufacturer_id,
+              bool is_set,
+              uint16_t pid,
+              const std::string &data,
+              std::string *pid_name,
+              std::string *decoded);
+
+  /**
+   * @brief The number of entries in the cache.
+   */
+  unsigned int Size() const { return m_entries.size(); }
+
+  /**
+   * @brief The number of calls to Decode() that were served from the cache.
+   */
+  unsigned int Hits() const { return m_hits; }
+
+  /**
+   * @brief The number of calls to Decode() that had to decode the data.
+   */
+  unsigned int Misses() const { return m_misses; }
+
+  static const unsigned int DEFAULT_MAX_SIZE = 256;
+
+ private:
+  struct DecodedResponse {
+    bool decoded;
+    std::string pid_name;
+    std::string text;
+  };
+
+  // Most recently used first.
+  typedef std::list<std::pair<std::string, DecodedResponse> > EntryList;
+  typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+  const unsigned int m_max_size;
+  std::auto_ptr<ola::rdm::PidStoreHelper> m_helper;
+  EntryList m_lru;
+  EntryMap m_entries;
+  unsigned int m_hits;
+  unsigned int m_misses;
+
+  void DecodeResponse(uint16_t manufacturer_id,
+                      bool is_set,
+                      uint16_t pid,
+                      const std::string &data,
+                      DecodedResponse *response);
+  void Clear();
+
+  DISALLOW_COPY_AND_ASSIGN(RDMDecodeCache);
+};
+}  // namespace ola
+#endif  // OLAD_RDMDECODECACHE_H_
@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMDecodeCacheTest.cpp
+ * Test fixture for the RDMDecodeCache class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "common/rdm/PidStoreLoader.h"
+#include "ola/rdm/PidStore.h"
+#include "olad/RDMDecodeCache.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::RDMDecodeCache;
+using ola::rdm::RootPidStore;
+using std::auto_ptr;
+using std::string;
+
+class RDMDecodeCacheTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMDecodeCacheTest);
+  CPPUNIT_TEST(testDecode);
+  CPPUNIT_TEST(testEviction);
+  CPPUNIT_TEST(testSetPidStore);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testDecode();
+    void testEviction();
+    void testSetPidStore();
+
+    void setUp() {
+      ola::rdm::PidStoreLoader loader;
+      m_store.reset(loader.LoadFromFile(
+            TEST_SRC_DIR "/common/rdm/testdata/test_pids.proto"));
+      OLA_ASSERT_NOT_NULL(m_store.get());
+    }
+
+ private:
+    auto_ptr<const RootPidStore> m_store;
+
+    // The data for a PROXIED_DEVICE_COUNT response.
+    static string DeviceCount(uint8_t count) {
+      const char data[] = {0, static_cast<char>(count), 1};
+      return string(data, sizeof(data));
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMDecodeCacheTest);
+
+static const uint16_t ESTA_ID = 0x7a70;
+static const uint16_t PROXIED_DEVICE_COUNT = 17;
+
+
+/*
+ * Check that responses are decoded and cached.
+ */
+void RDMDecodeCacheTest::testDecode() {
+  RDMDecodeCache cache;
+  string pid_name, decoded;
+
+  // No PID store
+  OLA_ASSERT_FALSE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                                DeviceCount(2), &pid_name, &decoded));
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  cache.SetPidStore(m_store.get());
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(2), &pid_name, &decoded));
+  OLA_ASSERT_EQ(string("PROXIED_DEVICE_COUNT"), pid_name);
+  OLA_ASSERT_EQ(string("Device Count: 2\nList Changed: true\n"), decoded);
+  OLA_ASSERT_EQ(1u, cache.Size());
+  OLA_ASSERT_EQ(0u, cache.Hits());
+  OLA_ASSERT_EQ(1u, cache.Misses());
+
+  pid_name.clear();
+  decoded.clear();
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(2), &pid_name, &decoded));
+  OLA_ASSERT_EQ(string("PROXIED_DEVICE_COUNT"), pid_name);
+  OLA_ASSERT_EQ(string("Device Count: 2\nList Changed: true\n"), decoded);
+  OLA_ASSERT_EQ(1u, cache.Hits());
+
+  // Different data is a different entry.
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(3), &pid_name, &decoded));
+  OLA_ASSERT_EQ(string("Device Count: 3\nList Changed: true\n"), decoded);
+  OLA_ASSERT_EQ(2u, cache.Size());
+
+  // Data that doesn't match the definition, a SET with no response message
+  // and an unknown PID. Failures are cached too.
+  OLA_ASSERT_FALSE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                                string(1, 0), &pid_name, &decoded));
+  OLA_ASSERT_FALSE(cache.Decode(ESTA_ID, true, PROXIED_DEVICE_COUNT,
+                                "", &pid_name, &decoded));
+  OLA_ASSERT_FALSE(cache.Decode(ESTA_ID, false, 0x7fff, "", &pid_name,
+                                &decoded));
+  OLA_ASSERT_FALSE(cache.Decode(ESTA_ID, false, 0x7fff, "", &pid_name,
+                                &decoded));
+  OLA_ASSERT_EQ(5u, cache.Size());
+  OLA_ASSERT_EQ(2u, cache.Hits());
+}
+
+
+/*
+ * Check the least recently used entry is dropped once the cache is full.
+ */
+void RDMDecodeCacheTest::testEviction() {
+  RDMDecodeCache cache(2);
+  cache.SetPidStore(m_store.get());
+  string pid_name, decoded;
+
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(1), &pid_name, &decoded));
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(2), &pid_name, &decoded));
+  // Use 1 so 2 is the oldest.
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(1), &pid_name, &decoded));
+  OLA_ASSERT_EQ(1u, cache.Hits());
+
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(3), &pid_name, &decoded));
+  OLA_ASSERT_EQ(2u, cache.Size());
+
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(1), &pid_name, &decoded));
+  OLA_ASSERT_EQ(2u, cache.Hits());
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(2), &pid_name, &decoded));
+  OLA_ASSERT_EQ(2u, cache.Hits());
+  OLA_ASSERT_EQ(4u, cache.Misses());
+  OLA_ASSERT_EQ(string("Device Count: 2\nList Changed: true\n"), decoded);
+}
+
+
+/*
+ * Check that changing the PID store clears the cache.
+ */
+void RDMDecodeCacheTest::testSetPidStore() {
+  RDMDecodeCache cache;
+  cache.SetPidStore(m_store.get());
+  string pid_name, decoded;
+
+  OLA_ASSERT_TRUE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                               DeviceCount(1), &pid_name, &decoded));
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  cache.SetPidStore(NULL);
+  OLA_ASSERT_EQ(0u, cache.Size());
+  OLA_ASSERT_FALSE(cache.Decode(ESTA_ID, false, PROXIED_DEVICE_COUNT,
+                                DeviceCount(1), &pid_name, &decoded));
+}
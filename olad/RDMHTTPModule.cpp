@@ -42,6 +42,7 @@
 #include "ola/thread/Mutex.h"
 #include "ola/web/Json.h"
 #include "ola/web/JsonSections.h"
+#include "ola/web/JsonStreamWriter.h"
 #include "olad/OlaServer.h"
 #include "olad/OladHTTPServer.h"
 #include "olad/RDMHTTPModule.h"
@@ -62,6 +63,7 @@ using ola::web::HiddenItem;
 using ola::web::JsonArray;
 using ola::web::JsonObject;
 using ola::web::JsonSection;
+using ola::web::JsonStreamWriter;
 using ola::web::SelectItem;
 using ola::web::StringItem;
 using ola::web::UIntItem;
@@ -173,7 +175,8 @@ RDMHTTPModule::RDMHTTPModule(HTTPServer *http_server,
     : m_server(http_server),
       m_client(client),
       m_shim(client),
-      m_rdm_api(&m_shim),
+      m_rdm_cache(&m_shim, http_server->SelectServer()),
+      m_rdm_api(&m_rdm_cache),
       m_pid_store(NULL) {
 
   m_server->RegisterHandler(
@@ -251,6 +254,8 @@ int RDMHTTPModule::RunRDMDiscovery(const HTTPRequest *request,
   string incremental_str = request->GetParameter("incremental");
   bool incremental = incremental_str == "true";
 
+  // The user asked for the devices to be re-read.
+  m_rdm_cache.Invalidate(universe_id);
   m_client->RunDiscovery(
       universe_id,
       incremental ? client::DISCOVERY_INCREMENTAL : client::DISCOVERY_FULL,
@@ -705,6 +710,7 @@ void RDMHTTPModule::PruneUniverseList(const vector<OlaUniverse> &universes) {
   for (uid_iter = m_universe_uids.begin(); uid_iter != m_universe_uids.end();) {
     if (!uid_iter->second->active) {
       OLA_DEBUG << "removing " << uid_iter->first << " from the uid map";
+      m_rdm_cache.Invalidate(uid_iter->first);
       delete uid_iter->second;
       m_universe_uids.erase(uid_iter++);
     } else {
@@ -737,9 +743,12 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
        uid_iter != uid_state->resolved_uids.end(); ++uid_iter)
     uid_iter->second.active = false;
 
-  JsonObject json;
-  json.Add("universe", universe_id);
-  JsonArray *json_uids = json.AddArray("uids");
+  // Large universes can have thousands of UIDs, so write the JSON straight
+  // into the response.
+  JsonStreamWriter json(response->MutableData());
+  json.StartObject();
+  json.Key("uids");
+  json.StartArray();
 
   for (; iter != uids.End(); ++iter) {
     uid_iter = uid_state->resolved_uids.find(*iter);
@@ -760,17 +769,21 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
       uid_iter->second.active = true;
     }
 
-    JsonObject *json_uid = json_uids->AppendObject();
-    json_uid->Add("manufacturer_id", iter->ManufacturerId());
-    json_uid->Add("device_id", iter->DeviceId());
-    json_uid->Add("device", device);
-    json_uid->Add("manufacturer", manufacturer);
-    json_uid->Add("uid", iter->ToString());
+    json.StartObject();
+    json.Add("device", device);
+    json.Add("device_id", iter->DeviceId());
+    json.Add("manufacturer", manufacturer);
+    json.Add("manufacturer_id", iter->ManufacturerId());
+    json.Add("uid", iter->ToString());
+    json.EndObject();
   }
+  json.EndArray();
+  json.Add("universe", universe_id);
+  json.EndObject();
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->SendJson(json);
+  response->Send();
   delete response;
 
   // remove any old UIDs
@@ -778,6 +791,7 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
        uid_iter != uid_state->resolved_uids.end();) {
     if (!uid_iter->second.active) {
       OLA_INFO << "Removed UID " << uid_iter->first;
+      m_rdm_cache.Invalidate(universe_id, uid_iter->first);
       uid_state->resolved_uids.erase(uid_iter++);
     } else {
       ++uid_iter;
@@ -1370,87 +1384,79 @@ string RDMHTTPModule::GetDeviceInfo(const HTTPRequest *request,
   string error;
   device_info dev_info = {universe_id, uid, hint, "", ""};
 
-  m_rdm_api.GetSoftwareVersionLabel(
-    universe_id,
-    uid,
-    ola::rdm::ROOT_RDM_DEVICE,
-    NewSingleCallback(this,
-                      &RDMHTTPModule::GetSoftwareVersionHandler,
-                      response,
-                      dev_info),
-    &error);
+  // Fetch the labels and the device info in a single batch, rather than
+  // waiting for each response before sending the next request.
+  vector<ola::rdm::ParameterRequest> requests;
+  requests.push_back(ola::rdm::ParameterRequest(
+      universe_id, uid, ola::rdm::ROOT_RDM_DEVICE,
+      ola::rdm::PID_SOFTWARE_VERSION_LABEL));
+  if (hint.find('m') != string::npos) {
+    requests.push_back(ola::rdm::ParameterRequest(
+        universe_id, uid, ola::rdm::ROOT_RDM_DEVICE,
+        ola::rdm::PID_DEVICE_MODEL_DESCRIPTION));
+  }
+  requests.push_back(ola::rdm::ParameterRequest(
+      universe_id, uid, ola::rdm::ROOT_RDM_DEVICE,
+      ola::rdm::PID_DEVICE_INFO));
+
+  m_rdm_api.GetParameters(
+      requests,
+      requests.size(),
+      NewSingleCallback(this,
+                        &RDMHTTPModule::GetDeviceInfoBatchHandler,
+                        response,
+                        dev_info),
+      &error);
   return error;
 }
 
 
 /**
- * @brief Handle the response to a software version call.
+ * @brief Handle the responses to the device info batch.
  */
-void RDMHTTPModule::GetSoftwareVersionHandler(
+void RDMHTTPModule::GetDeviceInfoBatchHandler(
     HTTPResponse *response,
     device_info dev_info,
-    const ola::rdm::ResponseStatus &status,
-    const string &software_version) {
-  string error;
-
-  if (CheckForRDMSuccess(status)) {
-    dev_info.software_version = software_version;
-  }
-
-  if (dev_info.hint.find('m') != string::npos) {
-    m_rdm_api.GetDeviceModelDescription(
-        dev_info.universe_id,
-        dev_info.uid,
-        ola::rdm::ROOT_RDM_DEVICE,
-        NewSingleCallback(this,
-                          &RDMHTTPModule::GetDeviceModelHandler,
-                          response,
-                          dev_info),
-        &error);
-  } else {
-    m_rdm_api.GetDeviceInfo(
-        dev_info.universe_id,
-        dev_info.uid,
-        ola::rdm::ROOT_RDM_DEVICE,
-        NewSingleCallback(this,
-                          &RDMHTTPModule::GetDeviceInfoHandler,
-                          response,
-                          dev_info),
-        &error);
-  }
-
-  if (!error.empty()) {
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+    const vector<ola::rdm::ParameterResponse> &responses) {
+  vector<ola::rdm::ParameterResponse>::const_iterator iter = responses.begin();
+  for (; iter != responses.end(); ++iter) {
+    switch (iter->request.pid) {
+      case ola::rdm::PID_SOFTWARE_VERSION_LABEL:
+        m_rdm_api._HandleLabelResponse(
+            NewSingleCallback(this, &RDMHTTPModule::StoreLabel,
+                              &dev_info.software_version),
+            iter->status, iter->data);
+        break;
+      case ola::rdm::PID_DEVICE_MODEL_DESCRIPTION:
+        m_rdm_api._HandleLabelResponse(
+            NewSingleCallback(this, &RDMHTTPModule::StoreLabel,
+                              &dev_info.device_model),
+            iter->status, iter->data);
+        break;
+      case ola::rdm::PID_DEVICE_INFO:
+        // This is always the last request in the batch.
+        m_rdm_api._HandleGetDeviceDescriptor(
+            NewSingleCallback(this,
+                              &RDMHTTPModule::GetDeviceInfoHandler,
+                              response,
+                              dev_info),
+            iter->status, iter->data);
+        break;
+      default:
+        break;
+    }
   }
 }
 
 
 /**
- * @brief Handle the response to a device model call.
+ * @brief Store a label if the request was successful.
  */
-void RDMHTTPModule::GetDeviceModelHandler(
-    HTTPResponse *response,
-    device_info dev_info,
-    const ola::rdm::ResponseStatus &status,
-    const string &device_model) {
-  string error;
-
+void RDMHTTPModule::StoreLabel(string *output,
+                               const ola::rdm::ResponseStatus &status,
+                               const string &label) {
   if (CheckForRDMSuccess(status)) {
-    dev_info.device_model = device_model;
-  }
-
-  m_rdm_api.GetDeviceInfo(
-      dev_info.universe_id,
-      dev_info.uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::GetDeviceInfoHandler,
-                        response,
-                        dev_info),
-      &error);
-
-  if (!error.empty()) {
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+    *output = label;
   }
 }
 
@@ -1936,7 +1942,6 @@ string RDMHTTPModule::GetPersonalities(OLA_UNUSED const HTTPRequest *request,
   info->include_descriptions = include_descriptions || (hint == "l");
   info->return_as_section = return_as_section;
   info->active = 0;
-  info->next = 1;
   info->total = 0;
 
   m_rdm_api.GetDMXPersonality(
@@ -1971,52 +1976,67 @@ void RDMHTTPModule::GetPersonalityHandler(
   info->total = total;
 
   if (info->include_descriptions) {
-    GetNextPersonalityDescription(response, info);
+    GetPersonalityDescriptions(response, info);
   } else {
-    SendPersonalityResponse(response, info);
+    SendPersonalities(response, info);
   }
 }
 
 
 /**
- * @brief Get the description of the next dmx personality
+ * @brief Get the descriptions of all the dmx personalities.
+ *
+ * The GETs are sent as a batch, rather than waiting for each description
+ * before asking for the next one.
  */
-void RDMHTTPModule::GetNextPersonalityDescription(HTTPResponse *response,
-                                                  personality_info *info) {
+void RDMHTTPModule::GetPersonalityDescriptions(HTTPResponse *response,
+                                               personality_info *info) {
+  vector<ola::rdm::ParameterRequest> requests;
+  for (unsigned int i = 1; i <= info->total; i++) {
+    requests.push_back(ola::rdm::ParameterRequest(
+        info->universe_id, *(info->uid), ola::rdm::ROOT_RDM_DEVICE,
+        ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+        string(1, static_cast<char>(i))));
+  }
+
   string error;
-  while (info->next <= info->total) {
-    bool r = m_rdm_api.GetDMXPersonalityDescription(
-        info->universe_id,
-        *(info->uid),
-        ola::rdm::ROOT_RDM_DEVICE,
-        info->next,
+  m_rdm_api.GetParameters(
+      requests,
+      MAX_DESCRIPTIONS_IN_FLIGHT,
+      NewSingleCallback(this,
+                        &RDMHTTPModule::PersonalityDescriptionsHandler,
+                        response,
+                        info),
+      &error);
+}
+
+
+/**
+ * @brief Handle the responses to the personality description batch.
+ */
+void RDMHTTPModule::PersonalityDescriptionsHandler(
+    HTTPResponse *response,
+    personality_info *info,
+    const vector<ola::rdm::ParameterResponse> &responses) {
+  vector<ola::rdm::ParameterResponse>::const_iterator iter = responses.begin();
+  for (; iter != responses.end(); ++iter) {
+    m_rdm_api._HandleGetDMXPersonalityDescription(
         NewSingleCallback(this,
-                          &RDMHTTPModule::GetPersonalityLabelHandler,
-                          response,
+                          &RDMHTTPModule::StorePersonalityDescription,
                           info),
-        &error);
-    if (r) {
-      return;
-    }
-
-    info->next++;
-  }
-  if (info->return_as_section) {
-    SendSectionPersonalityResponse(response, info);
-  } else {
-    SendPersonalityResponse(response, info);
+        iter->status, iter->data);
   }
+  SendPersonalities(response, info);
 }
 
 
 /**
- * @brief Handle the response to a Personality label call.
+ * @brief Store the description of a personality.
  *
- * This fetches the next personality in the sequence, or sends the response if
- * we have all the info.
+ * Failed requests are stored as INVALID_PERSONALITY so the index in
+ * info->personalities matches the personality number.
  */
-void RDMHTTPModule::GetPersonalityLabelHandler(
-    HTTPResponse *response,
+void RDMHTTPModule::StorePersonalityDescription(
     personality_info *info,
     const ola::rdm::ResponseStatus &status,
     OLA_UNUSED uint8_t personality,
@@ -2031,16 +2051,18 @@ void RDMHTTPModule::GetPersonalityLabelHandler(
   }
 
   info->personalities.push_back(pair<uint32_t, string>(slots, description));
+}
 
-  if (info->next == info->total) {
-    if (info->return_as_section) {
-      SendSectionPersonalityResponse(response, info);
-    } else {
-      SendPersonalityResponse(response, info);
-    }
+
+/**
+ * @brief Send the personalities, either as a section or as plain JSON.
+ */
+void RDMHTTPModule::SendPersonalities(HTTPResponse *response,
+                                      personality_info *info) {
+  if (info->return_as_section) {
+    SendSectionPersonalityResponse(response, info);
   } else {
-    info->next++;
-    GetNextPersonalityDescription(response, info);
+    SendPersonalityResponse(response, info);
   }
 }
 
@@ -2192,52 +2214,70 @@ string RDMHTTPModule::GetSensor(const HTTPRequest *request,
     return "Invalid hint (sensor #)";
   }
 
+  // The value doesn't depend on the definition, so fetch both at once.
+  const string data(1, static_cast<char>(sensor_id));
+  vector<ola::rdm::ParameterRequest> requests;
+  requests.push_back(ola::rdm::ParameterRequest(
+      universe_id, uid, ola::rdm::ROOT_RDM_DEVICE,
+      ola::rdm::PID_SENSOR_DEFINITION, data));
+  requests.push_back(ola::rdm::ParameterRequest(
+      universe_id, uid, ola::rdm::ROOT_RDM_DEVICE,
+      ola::rdm::PID_SENSOR_VALUE, data));
+
   string error;
-  m_rdm_api.GetSensorDefinition(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      sensor_id,
+  m_rdm_api.GetParameters(
+      requests,
+      requests.size(),
       NewSingleCallback(this,
-                        &RDMHTTPModule::SensorDefinitionHandler,
-                        response,
-                        universe_id,
-                        uid,
-                        sensor_id),
+                        &RDMHTTPModule::SensorBatchHandler,
+                        response),
       &error);
   return error;
 }
 
 
 /**
- * @brief Handle the response to a sensor definition request.
+ * @brief Handle the responses to the sensor definition & value batch.
  */
-void RDMHTTPModule::SensorDefinitionHandler(
+void RDMHTTPModule::SensorBatchHandler(
     HTTPResponse *response,
-    unsigned int universe_id,
-    const UID uid,
-    uint8_t sensor_id,
+    const vector<ola::rdm::ParameterResponse> &responses) {
+  ola::rdm::SensorDescriptor *definition = NULL;
+
+  vector<ola::rdm::ParameterResponse>::const_iterator iter = responses.begin();
+  for (; iter != responses.end(); ++iter) {
+    switch (iter->request.pid) {
+      case ola::rdm::PID_SENSOR_DEFINITION:
+        m_rdm_api._HandleGetSensorDefinition(
+            NewSingleCallback(this, &RDMHTTPModule::StoreSensorDefinition,
+                              &definition),
+            iter->status, iter->data);
+        break;
+      case ola::rdm::PID_SENSOR_VALUE:
+        // This is always the last request in the batch.
+        m_rdm_api._HandleSensorValue(
+            NewSingleCallback(this,
+                              &RDMHTTPModule::SensorValueHandler,
+                              response,
+                              definition),
+            iter->status, iter->data);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+
+/**
+ * @brief Store a sensor definition if the request was successful.
+ */
+void RDMHTTPModule::StoreSensorDefinition(
+    ola::rdm::SensorDescriptor **output,
     const ola::rdm::ResponseStatus &status,
     const ola::rdm::SensorDescriptor &definition) {
-  ola::rdm::SensorDescriptor *definition_arg = NULL;
-
   if (CheckForRDMSuccess(status)) {
-    definition_arg = new ola::rdm::SensorDescriptor();
-    *definition_arg = definition;
-  }
-  string error;
-  m_rdm_api.GetSensorValue(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      sensor_id,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::SensorValueHandler,
-                        response,
-                        definition_arg),
-      &error);
-  if (!error.empty()) {
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+    *output = new ola::rdm::SensorDescriptor(definition);
   }
 }
 
@@ -3386,7 +3426,6 @@ string RDMHTTPModule::GetCurve(OLA_UNUSED const HTTPRequest *request,
   info->uid = new UID(uid);
   info->include_descriptions = include_descriptions;
   info->active = 0;
-  info->next = 1;
   info->total = 0;
 
   m_rdm_api.GetCurve(
@@ -3421,60 +3460,62 @@ void RDMHTTPModule::GetCurveHandler(
   info->total = curve_count;
 
   if (info->include_descriptions) {
-    GetNextCurveDescription(response, info);
+    GetCurveDescriptions(response, info);
   } else {
     SendCurveResponse(response, info);
   }
 }
 
 /**
- * @brief Handle the response to a curve description call and add to curve
- * info object
+ * @brief Get the descriptions of all the curves as a single batch.
  */
-void RDMHTTPModule::GetNextCurveDescription(HTTPResponse *response,
-                                            curve_info *info) {
+void RDMHTTPModule::GetCurveDescriptions(HTTPResponse *response,
+                                         curve_info *info) {
+  vector<ola::rdm::ParameterRequest> requests;
+  for (unsigned int i = 1; i <= info->total; i++) {
+    requests.push_back(ola::rdm::ParameterRequest(
+        info->universe_id, *(info->uid), ola::rdm::ROOT_RDM_DEVICE,
+        ola::rdm::PID_CURVE_DESCRIPTION, string(1, static_cast<char>(i))));
+  }
+
   string error;
-  while (info->next <= info->total) {
-    bool r = m_rdm_api.GetCurveDescription(
-        info->universe_id,
-        *(info->uid),
-        ola::rdm::ROOT_RDM_DEVICE,
-        info->next,
-        NewSingleCallback(this,
-                          &RDMHTTPModule::GetCurveDescriptionHandler,
-                          response,
-                          info),
-        &error);
-    if (r) {
-      return;
-    }
+  m_rdm_api.GetParameters(
+      requests,
+      MAX_DESCRIPTIONS_IN_FLIGHT,
+      NewSingleCallback(this,
+                        &RDMHTTPModule::CurveDescriptionsHandler,
+                        response,
+                        info),
+      &error);
+}
 
-    info->next++;
+/**
+ * @brief Handle the responses to the curve description batch.
+ */
+void RDMHTTPModule::CurveDescriptionsHandler(
+    HTTPResponse *response,
+    curve_info *info,
+    const vector<ola::rdm::ParameterResponse> &responses) {
+  vector<ola::rdm::ParameterResponse>::const_iterator iter = responses.begin();
+  for (; iter != responses.end(); ++iter) {
+    m_rdm_api._HandleGetCurveDescription(
+        NewSingleCallback(this, &RDMHTTPModule::StoreCurveDescription, info),
+        iter->status, iter->data);
   }
-
   SendCurveResponse(response, info);
 }
 
-void RDMHTTPModule::GetCurveDescriptionHandler(
-    HTTPResponse *response,
+/**
+ * @brief Store the description of a curve, failed requests are stored as an
+ * empty string.
+ */
+void RDMHTTPModule::StoreCurveDescription(
     curve_info *info,
     const ola::rdm::ResponseStatus &status,
     OLA_UNUSED uint8_t curve,
-    const string &resp_description) {
-  string description = "";
-
-  if (CheckForRDMSuccess(status)) {
-    description = resp_description;
-  }
-
-  info->curve_descriptions.push_back(description);
-
-  if (info->next == info->total) {
-    SendCurveResponse(response, info);
-  } else {
-    info->next++;
-    GetNextCurveDescription(response, info);
-  }
+    const string &description) {
+  info->curve_descriptions.push_back(
+      CheckForRDMSuccess(status) ? description : "");
 }
 
 /**
@@ -3502,6 +3543,9 @@ void RDMHTTPModule::SendCurveResponse(HTTPResponse *response,
   section.AddItem(new StringItem("Available Curves",
                                  IntToString(info->total)));
   RespondWithSection(response, section);
+
+  delete info->uid;
+  delete info;
 }
 
 /**
@@ -3866,7 +3910,8 @@ void RDMHTTPModule::RespondWithSection(HTTPResponse *response,
                                        const ola::web::JsonSection &section) {
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->Append(section.AsString());
+  JsonStreamWriter writer(response->MutableData());
+  section.Write(&writer);
   response->Send();
   delete response;
 }
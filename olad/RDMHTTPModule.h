@@ -30,6 +30,7 @@
 #include "ola/client/ClientRDMAPIShim.h"
 #include "ola/client/OlaClient.h"
 #include "ola/http/HTTPServer.h"
+#include "ola/rdm/CachingRDMAPIImpl.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMAPI.h"
 #include "ola/rdm/UID.h"
@@ -98,6 +99,8 @@ class RDMHTTPModule {
     ola::http::HTTPServer *m_server;
     ola::client::OlaClient *m_client;
     ola::client::ClientRDMAPIShim m_shim;
+    // Saves re-fetching labels, descriptions etc. each time a page is loaded.
+    ola::rdm::CachingRDMAPIImpl m_rdm_cache;
     ola::rdm::RDMAPI m_rdm_api;
     std::map<unsigned int, uid_resolution_state*> m_universe_uids;
 
@@ -130,7 +133,6 @@ class RDMHTTPModule {
       bool include_descriptions;
       bool return_as_section;
       unsigned int active;
-      unsigned int next;
       unsigned int total;
       std::vector<std::pair<uint32_t, std::string> > personalities;
     } personality_info;
@@ -140,7 +142,6 @@ class RDMHTTPModule {
       const ola::rdm::UID *uid;
       bool include_descriptions;
       unsigned int active;
-      unsigned int next;
       unsigned int total;
       std::vector<std::string> curve_descriptions;
     } curve_info;
@@ -226,15 +227,14 @@ class RDMHTTPModule {
                               unsigned int universe_id,
                               const ola::rdm::UID &uid);
 
-    void GetSoftwareVersionHandler(ola::http::HTTPResponse *response,
-                                   device_info dev_info,
-                                   const ola::rdm::ResponseStatus &status,
-                                   const std::string &software_version);
+    void GetDeviceInfoBatchHandler(
+        ola::http::HTTPResponse *response,
+        device_info dev_info,
+        const std::vector<ola::rdm::ParameterResponse> &responses);
 
-    void GetDeviceModelHandler(ola::http::HTTPResponse *response,
-                               device_info dev_info,
-                               const ola::rdm::ResponseStatus &status,
-                               const std::string &device_model);
+    void StoreLabel(std::string *output,
+                    const ola::rdm::ResponseStatus &status,
+                    const std::string &label);
 
     void GetDeviceInfoHandler(ola::http::HTTPResponse *response,
                               device_info dev_info,
@@ -340,17 +340,24 @@ class RDMHTTPModule {
         uint8_t current,
         uint8_t total);
 
-    void GetNextPersonalityDescription(ola::http::HTTPResponse *response,
-                                       personality_info *info);
+    void GetPersonalityDescriptions(ola::http::HTTPResponse *response,
+                                    personality_info *info);
 
-    void GetPersonalityLabelHandler(
+    void PersonalityDescriptionsHandler(
         ola::http::HTTPResponse *response,
+        personality_info *info,
+        const std::vector<ola::rdm::ParameterResponse> &responses);
+
+    void StorePersonalityDescription(
         personality_info *info,
         const ola::rdm::ResponseStatus &status,
         uint8_t personality,
         uint16_t slot_count,
         const std::string &label);
 
+    void SendPersonalities(ola::http::HTTPResponse *response,
+                           personality_info *info);
+
     void SendSectionPersonalityResponse(ola::http::HTTPResponse *response,
                                         personality_info *info);
 
@@ -378,12 +385,13 @@ class RDMHTTPModule {
                           unsigned int universe_id,
                           const ola::rdm::UID &uid);
 
-    void SensorDefinitionHandler(ola::http::HTTPResponse *response,
-                                 unsigned int universe_id,
-                                 const ola::rdm::UID uid,
-                                 uint8_t sensor_id,
-                                 const ola::rdm::ResponseStatus &status,
-                                 const ola::rdm::SensorDescriptor &definition);
+    void SensorBatchHandler(
+        ola::http::HTTPResponse *response,
+        const std::vector<ola::rdm::ParameterResponse> &responses);
+
+    void StoreSensorDefinition(ola::rdm::SensorDescriptor **output,
+                               const ola::rdm::ResponseStatus &status,
+                               const ola::rdm::SensorDescriptor &definition);
 
     void SensorValueHandler(ola::http::HTTPResponse *response,
                             ola::rdm::SensorDescriptor *definition,
@@ -595,14 +603,18 @@ class RDMHTTPModule {
                             uint8_t current_curve,
                             uint8_t curve_count);
 
-    void GetNextCurveDescription(ola::http::HTTPResponse *response,
-                                 curve_info *info);
+    void GetCurveDescriptions(ola::http::HTTPResponse *response,
+                              curve_info *info);
 
-    void GetCurveDescriptionHandler(ola::http::HTTPResponse *response,
-                                    curve_info *info,
-                                    const ola::rdm::ResponseStatus &status,
-                                    uint8_t curve,
-                                    const std::string &resp_description);
+    void CurveDescriptionsHandler(
+        ola::http::HTTPResponse *response,
+        curve_info *info,
+        const std::vector<ola::rdm::ParameterResponse> &responses);
+
+    void StoreCurveDescription(curve_info *info,
+                               const ola::rdm::ResponseStatus &status,
+                               uint8_t curve,
+                               const std::string &description);
 
     void SendCurveResponse(ola::http::HTTPResponse *response,
                            curve_info *info);
@@ -693,6 +705,8 @@ class RDMHTTPModule {
                     const std::string &hint = "");
 
     static const uint32_t INVALID_PERSONALITY = 0xffff;
+    // The number of *_DESCRIPTION GETs to have outstanding at once.
+    static const unsigned int MAX_DESCRIPTIONS_IN_FLIGHT = 8;
     static const char BACKEND_DISCONNECTED_ERROR[];
 
     static const char HINT_KEY[];
@@ -0,0 +1,317 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ReplicationCodec.cpp
+ * The wire format used to replicate universes between olad nodes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/ReplicationCodec.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "common/dmx/SlotKernels.h"
+
+namespace ola {
+
+using ola::dmx::FirstDifferingSlot;
+using std::string;
+using std::vector;
+
+namespace {
+
+const uint8_t FRAME_MAGIC[] = {'O', 'L', 'A', 'R'};
+const uint8_t FRAME_VERSION = 1;
+const uint8_t CONTROL_UNIVERSE = 1;
+const unsigned int CONTROL_HEADER_SIZE = 3;
+const unsigned int UNIVERSE_INFO_SIZE = 6;
+const unsigned int MAX_NAME_LENGTH = 255;
+
+void WriteUInt16(uint8_t *data, unsigned int value) {
+  data[0] = static_cast<uint8_t>(value >> 8);
+  data[1] = static_cast<uint8_t>(value);
+}
+
+void WriteUInt32(uint8_t *data, uint32_t value) {
+  data[0] = static_cast<uint8_t>(value >> 24);
+  data[1] = static_cast<uint8_t>(value >> 16);
+  data[2] = static_cast<uint8_t>(value >> 8);
+  data[3] = static_cast<uint8_t>(value);
+}
+
+unsigned int ReadUInt16(const uint8_t *data) {
+  return (data[0] << 8) | data[1];
+}
+
+uint32_t ReadUInt32(const uint8_t *data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+}  // namespace
+
+const unsigned int ReplicationEncoder::HEADER_SIZE;
+const unsigned int ReplicationEncoder::MAX_FRAME_SIZE;
+const unsigned int ReplicationEncoder::RANGE_HEADER_SIZE;
+const unsigned int ReplicationEncoder::DELTA_TOO_LARGE;
+
+ReplicationEncoder::ReplicationEncoder(unsigned int universe,
+                                       unsigned int keyframe_interval)
+    : m_universe(universe),
+      m_keyframe_interval(keyframe_interval ? keyframe_interval : 1),
+      m_next_sequence(0),
+      m_keyframe_sequence(0),
+      m_frames_since_keyframe(0),
+      m_keyframes(0),
+      m_deltas(0) {
+}
+
+unsigned int ReplicationEncoder::Encode(uint8_t priority,
+                                        const DmxBuffer &buffer,
+                                        bool force_keyframe,
+                                        uint8_t *packet) {
+  const uint32_t sequence = m_next_sequence++;
+  uint8_t *payload = packet + HEADER_SIZE;
+
+  unsigned int payload_size = 0;
+  bool keyframe = (force_keyframe || !m_keyframes ||
+                   m_frames_since_keyframe + 1 >= m_keyframe_interval ||
+                   buffer.Size() != m_keyframe.Size());
+  if (!keyframe) {
+    payload_size = EncodeDelta(buffer, payload);
+    keyframe = payload_size == DELTA_TOO_LARGE;
+  }
+
+  if (keyframe) {
+    memcpy(payload, buffer.GetRaw(), buffer.Size());
+    payload_size = buffer.Size();
+    m_keyframe = buffer;
+    m_keyframe_sequence = sequence;
+    m_frames_since_keyframe = 0;
+    m_keyframes++;
+  } else {
+    m_frames_since_keyframe++;
+    m_deltas++;
+  }
+
+  memcpy(packet, FRAME_MAGIC, sizeof(FRAME_MAGIC));
+  packet[4] = FRAME_VERSION;
+  packet[5] = static_cast<uint8_t>(
+      keyframe ? ReplicationFrameHeader::KEYFRAME :
+                 ReplicationFrameHeader::DELTA);
+  WriteUInt32(packet + 6, m_universe);
+  WriteUInt32(packet + 10, sequence);
+  WriteUInt32(packet + 14, m_keyframe_sequence);
+  packet[18] = priority;
+  WriteUInt16(packet + 19, buffer.Size());
+  return HEADER_SIZE + payload_size;
+}
+
+/*
+ * Build the list of ranges that differ from the keyframe. Ranges separated by
+ * fewer unchanged slots than a range header are joined. This stops once the
+ * delta is more than half the size of a keyframe; the keyframe is sent
+ * instead, which keeps the deltas that follow it small.
+ */
+unsigned int ReplicationEncoder::EncodeDelta(const DmxBuffer &buffer,
+                                             uint8_t *payload) const {
+  const uint8_t *data = buffer.GetRaw();
+  const uint8_t *keyframe = m_keyframe.GetRaw();
+  const unsigned int size = buffer.Size();
+
+  unsigned int payload_size = 0;
+  unsigned int offset = FirstDifferingSlot(data, keyframe, size);
+  while (offset < size) {
+    unsigned int end = offset + 1;
+    while (end < size) {
+      if (data[end] != keyframe[end]) {
+        end++;
+        continue;
+      }
+      unsigned int next = end + FirstDifferingSlot(data + end,
+                                                   keyframe + end,
+                                                   size - end);
+      if (next < size && next - end < RANGE_HEADER_SIZE) {
+        end = next + 1;
+      } else {
+        break;
+      }
+    }
+
+    const unsigned int length = end - offset;
+    if (2 * (payload_size + RANGE_HEADER_SIZE + length) > size) {
+      return DELTA_TOO_LARGE;
+    }
+    WriteUInt16(payload + payload_size, offset);
+    WriteUInt16(payload + payload_size + 2, length);
+    memcpy(payload + payload_size + RANGE_HEADER_SIZE, data + offset, length);
+    payload_size += RANGE_HEADER_SIZE + length;
+
+    if (end == size) {
+      break;
+    }
+    offset = end + FirstDifferingSlot(data + end, keyframe + end, size - end);
+  }
+  return payload_size;
+}
+
+ReplicationDecoder::ReplicationDecoder()
+    : m_have_keyframe(false),
+      m_have_sequence(false),
+      m_keyframe_sequence(0),
+      m_last_sequence(0),
+      m_lost(0) {
+}
+
+ReplicationDecoder::Result ReplicationDecoder::Decode(
+    const ReplicationFrameHeader &header,
+    const uint8_t *payload,
+    unsigned int length,
+    DmxBuffer *buffer) {
+  if (m_have_sequence) {
+    // Serial number arithmetic, so the sequence can wrap.
+    const int32_t diff = static_cast<int32_t>(header.sequence -
+                                              m_last_sequence);
+    if (diff <= 0) {
+      return FRAME_STALE;
+    }
+    m_lost += diff - 1;
+  }
+
+  if (header.type == ReplicationFrameHeader::KEYFRAME) {
+    if (length != header.slot_count) {
+      return FRAME_INVALID;
+    }
+    m_keyframe.Set(payload, length);
+    m_keyframe_sequence = header.sequence;
+    m_have_keyframe = true;
+    *buffer = m_keyframe;
+  } else {
+    if (!m_have_keyframe || header.base_sequence != m_keyframe_sequence ||
+        header.slot_count != m_keyframe.Size()) {
+      m_last_sequence = header.sequence;
+      m_have_sequence = true;
+      return FRAME_NO_KEYFRAME;
+    }
+    if (!ApplyDelta(header.slot_count, payload, length, buffer)) {
+      return FRAME_INVALID;
+    }
+  }
+  m_last_sequence = header.sequence;
+  m_have_sequence = true;
+  return FRAME_OK;
+}
+
+bool ReplicationDecoder::ApplyDelta(unsigned int slot_count,
+                                    const uint8_t *payload,
+                                    unsigned int length,
+                                    DmxBuffer *buffer) const {
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  memcpy(data, m_keyframe.GetRaw(), slot_count);
+
+  unsigned int offset = 0;
+  while (offset < length) {
+    if (length - offset < 4) {
+      return false;
+    }
+    const unsigned int start = ReadUInt16(payload + offset);
+    const unsigned int range_length = ReadUInt16(payload + offset + 2);
+    offset += 4;
+    if (start + range_length > slot_count ||
+        range_length > length - offset) {
+      return false;
+    }
+    memcpy(data + start, payload + offset, range_length);
+    offset += range_length;
+  }
+  buffer->Set(data, slot_count);
+  return true;
+}
+
+bool ParseReplicationFrame(const uint8_t *data, unsigned int length,
+                           ReplicationFrameHeader *header,
+                           const uint8_t **payload,
+                           unsigned int *payload_length) {
+  if (length < ReplicationEncoder::HEADER_SIZE ||
+      memcmp(data, FRAME_MAGIC, sizeof(FRAME_MAGIC)) ||
+      data[4] != FRAME_VERSION) {
+    return false;
+  }
+
+  switch (data[5]) {
+    case ReplicationFrameHeader::KEYFRAME:
+    case ReplicationFrameHeader::DELTA:
+      header->type = static_cast<ReplicationFrameHeader::FrameType>(data[5]);
+      break;
+    default:
+      return false;
+  }
+  header->universe = ReadUInt32(data + 6);
+  header->sequence = ReadUInt32(data + 10);
+  header->base_sequence = ReadUInt32(data + 14);
+  header->priority = data[18];
+  header->slot_count = ReadUInt16(data + 19);
+  if (header->slot_count > DMX_UNIVERSE_SIZE) {
+    return false;
+  }
+  *payload = data + ReplicationEncoder::HEADER_SIZE;
+  *payload_length = length - ReplicationEncoder::HEADER_SIZE;
+  return true;
+}
+
+void BuildReplicationUniverseInfo(const ReplicationUniverseInfo &info,
+                                  string *output) {
+  const string name = info.name.substr(0, MAX_NAME_LENGTH);
+  uint8_t header[CONTROL_HEADER_SIZE + UNIVERSE_INFO_SIZE];
+  header[0] = CONTROL_UNIVERSE;
+  WriteUInt16(header + 1,
+              UNIVERSE_INFO_SIZE + static_cast<unsigned int>(name.size()));
+  WriteUInt32(header + 3, info.universe);
+  header[7] = info.priority;
+  header[8] = info.ltp ? 1 : 0;
+  output->append(reinterpret_cast<char*>(header), sizeof(header));
+  output->append(name);
+}
+
+unsigned int ParseReplicationControl(
+    const uint8_t *data, unsigned int length,
+    vector<ReplicationUniverseInfo> *universes) {
+  unsigned int offset = 0;
+  while (length - offset >= CONTROL_HEADER_SIZE) {
+    const uint8_t *message = data + offset;
+    const unsigned int body_length = ReadUInt16(message + 1);
+    if (length - offset < CONTROL_HEADER_SIZE + body_length) {
+      break;
+    }
+    offset += CONTROL_HEADER_SIZE + body_length;
+
+    // Unknown messages are skipped, so new ones can be added later.
+    if (message[0] != CONTROL_UNIVERSE || body_length < UNIVERSE_INFO_SIZE) {
+      continue;
+    }
+    const uint8_t *body = message + CONTROL_HEADER_SIZE;
+    ReplicationUniverseInfo info;
+    info.universe = ReadUInt32(body);
+    info.priority = body[4];
+    info.ltp = body[5] != 0;
+    info.name.assign(reinterpret_cast<const char*>(body + UNIVERSE_INFO_SIZE),
+                     body_length - UNIVERSE_INFO_SIZE);
+    universes->push_back(info);
+  }
+  return offset;
+}
+}  // namespace ola
@@ -0,0 +1,218 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ReplicationCodec.h
+ * The wire format used to replicate universes between olad nodes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_REPLICATIONCODEC_H_
+#define OLAD_REPLICATIONCODEC_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/Constants.h"
+
+namespace ola {
+
+/**
+ * @brief The header of a replicated universe frame.
+ *
+ * Frames are sent over UDP. All fields are big endian:
+ * @code
+ *   magic          4  "OLAR"
+ *   version        1
+ *   type           1  KEYFRAME or DELTA
+ *   universe       4
+ *   sequence       4
+ *   base sequence  4  the keyframe a delta applies to
+ *   priority       1
+ *   slot count     2
+ * @endcode
+ *
+ * A keyframe is followed by the slot data. A delta is followed by a list of
+ * ranges, each a 2 byte offset, a 2 byte length and then the slot data.
+ * Deltas are relative to the last keyframe, not the previous frame, so
+ * losing a delta only loses that frame.
+ */
+struct ReplicationFrameHeader {
+  enum FrameType {
+    KEYFRAME = 1,
+    DELTA = 2,
+  };
+
+  FrameType type;
+  unsigned int universe;
+  uint32_t sequence;
+  uint32_t base_sequence;
+  uint8_t priority;
+  unsigned int slot_count;
+};
+
+/**
+ * @brief The state of a universe, sent over the TCP control channel.
+ *
+ * Messages on the control channel are a 1 byte type and a 2 byte length,
+ * followed by the body. A universe message is the universe id (4), the
+ * priority (1), the merge mode (1) and then the name.
+ */
+struct ReplicationUniverseInfo {
+  unsigned int universe;
+  uint8_t priority;
+  bool ltp;
+  std::string name;
+};
+
+/**
+ * @brief Encodes the frames for one replicated universe.
+ */
+class ReplicationEncoder {
+ public:
+  /**
+   * @brief Create a new encoder.
+   * @param universe the universe id.
+   * @param keyframe_interval send a keyframe at least every this many
+   *   frames.
+   */
+  ReplicationEncoder(unsigned int universe, unsigned int keyframe_interval);
+
+  /**
+   * @brief Encode a frame.
+   * @param priority the priority of the data.
+   * @param buffer the universe's data.
+   * @param force_keyframe true to send a keyframe rather than a delta.
+   * @param[out] packet the frame is written here, this must have space for
+   *   MAX_FRAME_SIZE bytes.
+   * @returns the size of the frame.
+   *
+   * A delta is used unless it would be more than half the size of a
+   * keyframe.
+   */
+  unsigned int Encode(uint8_t priority, const DmxBuffer &buffer,
+                      bool force_keyframe, uint8_t *packet);
+
+  /**
+   * @brief The number of keyframes encoded.
+   */
+  unsigned int Keyframes() const { return m_keyframes; }
+
+  /**
+   * @brief The number of deltas encoded.
+   */
+  unsigned int Deltas() const { return m_deltas; }
+
+  static const unsigned int HEADER_SIZE = 21;
+  static const unsigned int MAX_FRAME_SIZE = HEADER_SIZE +
+                                             DMX_UNIVERSE_SIZE;
+
+ private:
+  const unsigned int m_universe;
+  const unsigned int m_keyframe_interval;
+  DmxBuffer m_keyframe;
+  uint32_t m_next_sequence;
+  uint32_t m_keyframe_sequence;
+  unsigned int m_frames_since_keyframe;
+  unsigned int m_keyframes;
+  unsigned int m_deltas;
+
+  unsigned int EncodeDelta(const DmxBuffer &buffer, uint8_t *payload) const;
+
+  // The size of the offset & length before each range in a delta.
+  static const unsigned int RANGE_HEADER_SIZE = 4;
+  static const unsigned int DELTA_TOO_LARGE = 0xffffffff;
+
+  DISALLOW_COPY_AND_ASSIGN(ReplicationEncoder);
+};
+
+/**
+ * @brief Rebuilds the frames for one replicated universe from one node.
+ */
+class ReplicationDecoder {
+ public:
+  enum Result {
+    FRAME_OK,  /**< The frame was decoded */
+    FRAME_STALE,  /**< The frame is older than one already decoded */
+    FRAME_NO_KEYFRAME,  /**< The keyframe for the delta was lost */
+    FRAME_INVALID,  /**< The payload is malformed */
+  };
+
+  ReplicationDecoder();
+
+  /**
+   * @brief Decode a frame.
+   * @param header the frame's header, from ParseReplicationFrame().
+   * @param payload the data following the header.
+   * @param length the size of the payload.
+   * @param[out] buffer set to the universe's data if FRAME_OK is returned.
+   */
+  Result Decode(const ReplicationFrameHeader &header,
+                const uint8_t *payload, unsigned int length,
+                DmxBuffer *buffer);
+
+  /**
+   * @brief The number of frames that were skipped in the sequence.
+   */
+  unsigned int Lost() const { return m_lost; }
+
+ private:
+  DmxBuffer m_keyframe;
+  bool m_have_keyframe;
+  bool m_have_sequence;
+  uint32_t m_keyframe_sequence;
+  uint32_t m_last_sequence;
+  unsigned int m_lost;
+
+  bool ApplyDelta(unsigned int slot_count, const uint8_t *payload,
+                  unsigned int length, DmxBuffer *buffer) const;
+
+  DISALLOW_COPY_AND_ASSIGN(ReplicationDecoder);
+};
+
+/**
+ * @brief Parse the header of a replicated frame.
+ * @param data the datagram.
+ * @param length the size of the datagram.
+ * @param[out] header the header.
+ * @param[out] payload set to the start of the payload.
+ * @param[out] payload_length set to the size of the payload.
+ * @returns true if the header was valid, false otherwise.
+ */
+bool ParseReplicationFrame(const uint8_t *data, unsigned int length,
+                           ReplicationFrameHeader *header,
+                           const uint8_t **payload,
+                           unsigned int *payload_length);
+
+/**
+ * @brief Append a universe message for the control channel to a string.
+ */
+void BuildReplicationUniverseInfo(const ReplicationUniverseInfo &info,
+                                  std::string *output);
+
+/**
+ * @brief Parse the control messages at the start of a buffer.
+ * @param data the data received on the control channel.
+ * @param length the size of the data.
+ * @param[out] universes the universe messages are appended to this.
+ * @returns the number of bytes consumed, the remainder is a partial message.
+ */
+unsigned int ParseReplicationControl(
+    const uint8_t *data, unsigned int length,
+    std::vector<ReplicationUniverseInfo> *universes);
+}  // namespace ola
+#endif  // OLAD_REPLICATIONCODEC_H_
@@ -0,0 +1,251 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ReplicationCodecTest.cpp
+ * Test fixture for the universe replication wire format.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/DmxBuffer.h"
+#include "olad/ReplicationCodec.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::BuildReplicationUniverseInfo;
+using ola::DmxBuffer;
+using ola::ParseReplicationControl;
+using ola::ParseReplicationFrame;
+using ola::ReplicationDecoder;
+using ola::ReplicationEncoder;
+using ola::ReplicationFrameHeader;
+using ola::ReplicationUniverseInfo;
+using std::string;
+using std::vector;
+
+class ReplicationCodecTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ReplicationCodecTest);
+  CPPUNIT_TEST(testKeyframe);
+  CPPUNIT_TEST(testDelta);
+  CPPUNIT_TEST(testLoss);
+  CPPUNIT_TEST(testControl);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testKeyframe();
+    void testDelta();
+    void testLoss();
+    void testControl();
+
+ private:
+    uint8_t m_packet[ReplicationEncoder::MAX_FRAME_SIZE];
+
+    ReplicationDecoder::Result Decode(ReplicationDecoder *decoder,
+                                      unsigned int size,
+                                      DmxBuffer *buffer,
+                                      ReplicationFrameHeader *header) {
+      const uint8_t *payload;
+      unsigned int payload_length;
+      OLA_ASSERT_TRUE(ParseReplicationFrame(m_packet, size, header, &payload,
+                                            &payload_length));
+      return decoder->Decode(*header, payload, payload_length, buffer);
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReplicationCodecTest);
+
+
+/*
+ * Check the first frame is a keyframe & that it decodes.
+ */
+void ReplicationCodecTest::testKeyframe() {
+  ReplicationEncoder encoder(7, 10);
+  ReplicationDecoder decoder;
+  DmxBuffer input, output;
+  input.SetFromString("1,2,3,4,5");
+
+  unsigned int size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationEncoder::HEADER_SIZE + 5, size);
+
+  ReplicationFrameHeader header;
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+  OLA_ASSERT_EQ(ReplicationFrameHeader::KEYFRAME, header.type);
+  OLA_ASSERT_EQ(7u, header.universe);
+  OLA_ASSERT_EQ(0u, header.sequence);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), header.priority);
+  OLA_ASSERT_EQ(5u, header.slot_count);
+  OLA_ASSERT_DATA_EQUALS(input.GetRaw(), input.Size(), output.GetRaw(),
+                         output.Size());
+
+  // Corrupt & truncated frames are rejected.
+  const uint8_t *payload;
+  unsigned int payload_length;
+  OLA_ASSERT_FALSE(ParseReplicationFrame(m_packet, 10, &header, &payload,
+                                         &payload_length));
+  m_packet[0] = 'X';
+  OLA_ASSERT_FALSE(ParseReplicationFrame(m_packet, size, &header, &payload,
+                                         &payload_length));
+}
+
+
+/*
+ * Check that deltas only carry the changed slots.
+ */
+void ReplicationCodecTest::testDelta() {
+  ReplicationEncoder encoder(1, 10);
+  ReplicationDecoder decoder;
+  ReplicationFrameHeader header;
+  DmxBuffer input, output;
+  input.Blackout();
+
+  unsigned int size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+
+  // Two slots close together are sent as one range, the third separately.
+  input.SetChannel(10, 255);
+  input.SetChannel(12, 128);
+  input.SetChannel(400, 1);
+  size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationEncoder::HEADER_SIZE + 4 + 3 + 4 + 1, size);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+  OLA_ASSERT_EQ(ReplicationFrameHeader::DELTA, header.type);
+  OLA_ASSERT_EQ(0u, header.base_sequence);
+  OLA_ASSERT_TRUE(input == output);
+
+  // Deltas are relative to the keyframe, so they still carry the earlier
+  // changes.
+  input.SetChannel(12, 0);
+  size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationEncoder::HEADER_SIZE + 4 + 1 + 4 + 1, size);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+  OLA_ASSERT_TRUE(input == output);
+
+  // A change to more than half the slots is sent as a keyframe.
+  input.SetRangeToValue(0, 50, 500);
+  size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationEncoder::HEADER_SIZE + 512, size);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+  OLA_ASSERT_EQ(ReplicationFrameHeader::KEYFRAME, header.type);
+  OLA_ASSERT_TRUE(input == output);
+
+  // As is a change in size.
+  input.SetFromString("1,2,3");
+  encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(3u, encoder.Keyframes());
+  OLA_ASSERT_EQ(2u, encoder.Deltas());
+}
+
+
+/*
+ * Check how lost & reordered frames are handled.
+ */
+void ReplicationCodecTest::testLoss() {
+  ReplicationEncoder encoder(1, 4);
+  ReplicationDecoder decoder;
+  ReplicationFrameHeader header;
+  DmxBuffer input, output;
+  input.SetFromString("0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0");
+
+  unsigned int size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+
+  // Lose a delta, the next one still applies since it's relative to the
+  // keyframe.
+  input.SetChannel(1, 10);
+  encoder.Encode(100, input, false, m_packet);
+  input.SetChannel(2, 20);
+  size = encoder.Encode(100, input, false, m_packet);
+  string late(reinterpret_cast<char*>(m_packet), size);
+  input.SetChannel(3, 30);
+  size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+  OLA_ASSERT_TRUE(input == output);
+  OLA_ASSERT_EQ(2u, decoder.Lost());
+
+  // A frame that arrives late is dropped.
+  late.copy(reinterpret_cast<char*>(m_packet), late.size());
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_STALE,
+                Decode(&decoder, static_cast<unsigned int>(late.size()),
+                       &output, &header));
+
+  // Lose the keyframe, the deltas that follow can't be used until the next
+  // keyframe.
+  input.SetChannel(4, 40);
+  size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationFrameHeader::KEYFRAME,
+                static_cast<ReplicationFrameHeader::FrameType>(m_packet[5]));
+  input.SetChannel(5, 50);
+  size = encoder.Encode(100, input, false, m_packet);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_NO_KEYFRAME,
+                Decode(&decoder, size, &output, &header));
+
+  size = encoder.Encode(100, input, true, m_packet);
+  OLA_ASSERT_EQ(ReplicationDecoder::FRAME_OK,
+                Decode(&decoder, size, &output, &header));
+  OLA_ASSERT_TRUE(input == output);
+  OLA_ASSERT_EQ(3u, decoder.Lost());
+}
+
+
+/*
+ * Check the control channel messages.
+ */
+void ReplicationCodecTest::testControl() {
+  ReplicationUniverseInfo info;
+  info.universe = 70000;
+  info.priority = 150;
+  info.ltp = true;
+  info.name = "Stage Left";
+
+  string data;
+  BuildReplicationUniverseInfo(info, &data);
+  info.universe = 2;
+  info.ltp = false;
+  info.name = "";
+  BuildReplicationUniverseInfo(info, &data);
+
+  // A partial message is left for the next read.
+  vector<ReplicationUniverseInfo> universes;
+  const uint8_t *raw = reinterpret_cast<const uint8_t*>(data.data());
+  unsigned int consumed = ParseReplicationControl(
+      raw, static_cast<unsigned int>(data.size() - 1), &universes);
+  OLA_ASSERT_EQ(19u, consumed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), universes.size());
+  OLA_ASSERT_EQ(70000u, universes[0].universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), universes[0].priority);
+  OLA_ASSERT_TRUE(universes[0].ltp);
+  OLA_ASSERT_EQ(string("Stage Left"), universes[0].name);
+
+  universes.clear();
+  consumed = ParseReplicationControl(
+      raw + consumed, static_cast<unsigned int>(data.size() - consumed),
+      &universes);
+  OLA_ASSERT_EQ(9u, consumed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), universes.size());
+  OLA_ASSERT_EQ(2u, universes[0].universe);
+  OLA_ASSERT_FALSE(universes[0].ltp);
+  OLA_ASSERT_EQ(string(""), universes[0].name);
+}
@@ -0,0 +1,298 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SharedDmxServer.cpp
+ * The olad side of the shared memory DMX transport.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "olad/DmxSource.h"
+#include "olad/SharedDmxServer.h"
+#include "olad/Universe.h"
+
+namespace ola {
+
+using ola::dmx::SharedDmxRegion;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
+using ola::network::UDPSocket;
+using std::vector;
+
+SharedDmxServer::SharedDmxServer(ola::io::SelectServerInterface *ss,
+                                 UniverseStore *universe_store,
+                                 const TimeStamp *wake_up_time,
+                                 const ola::rdm::UID &uid,
+                                 uint16_t port)
+    : m_ss(ss),
+      m_universe_store(universe_store),
+      m_wake_up_time(wake_up_time),
+      m_uid(uid),
+      m_port(port),
+      m_sink(this, uid),
+      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT) {
+  for (unsigned int i = 0; i < SharedDmxRegion::INPUT_SLOTS; i++) {
+    m_inputs[i].client = NULL;
+    m_inputs[i].universe = 0;
+  }
+}
+
+SharedDmxServer::~SharedDmxServer() {
+  if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_housekeeping_timeout);
+  }
+
+  if (m_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_socket.get());
+  }
+
+  if (m_region.get()) {
+    for (unsigned int i = 0; i < SharedDmxRegion::INPUT_SLOTS; i++) {
+      ReleaseInput(i);
+    }
+    while (!m_subscriptions.empty()) {
+      Unsubscribe(m_subscriptions.begin()->first,
+                  m_subscriptions.begin()->second);
+    }
+  }
+}
+
+bool SharedDmxServer::Init() {
+  if (m_region.get()) {
+    return false;
+  }
+
+  std::auto_ptr<SharedDmxRegion> region(
+      SharedDmxRegion::Create(SharedDmxRegion::NameForPort(m_port)));
+  if (!region.get()) {
+    return false;
+  }
+
+  std::auto_ptr<UDPSocket> socket(new UDPSocket());
+  if (!socket->Init()) {
+    return false;
+  }
+  if (!socket->Bind(IPV4SocketAddress(IPV4Address::Loopback(), m_port))) {
+    OLA_WARN << "Failed to bind the shared memory doorbell to port "
+             << m_port;
+    return false;
+  }
+  socket->SetOnData(NewCallback(this, &SharedDmxServer::DoorbellReceived));
+  // DoorbellReceived() reads until the socket is empty.
+  socket->SetEdgeTriggered(true);
+  if (!m_ss->AddReadDescriptor(socket.get())) {
+    return false;
+  }
+
+  m_region.reset(region.release());
+  m_socket.reset(socket.release());
+  m_housekeeping_timeout = m_ss->RegisterRepeatingTimeout(
+      HOUSEKEEPING_INTERVAL_MS,
+      NewCallback(this, &SharedDmxServer::RunHousekeeping));
+  OLA_INFO << "Publishing DMX data to local clients using "
+           << SharedDmxRegion::NameForPort(m_port);
+  return true;
+}
+
+void SharedDmxServer::Publish(unsigned int universe_id, uint8_t priority,
+                              const DmxBuffer &buffer) {
+  SubscriptionMap::const_iterator iter = m_subscriptions.find(universe_id);
+  if (iter != m_subscriptions.end()) {
+    m_region->WriteOutput(iter->second, priority, buffer);
+  }
+}
+
+/*
+ * Drain the doorbell socket. A client streaming quickly may ring the doorbell
+ * a number of times for the same slot before we get to it, we only need to
+ * read the slot once.
+ */
+void SharedDmxServer::DoorbellReceived() {
+  SharedDmxRegion::Doorbell doorbells[DOORBELL_BATCH_SIZE];
+  UDPDatagram datagrams[DOORBELL_BATCH_SIZE];
+  bool updated[SharedDmxRegion::INPUT_SLOTS];
+  memset(updated, 0, sizeof(updated));
+
+  unsigned int received;
+  do {
+    for (unsigned int i = 0; i < DOORBELL_BATCH_SIZE; i++) {
+      datagrams[i].buffer.iov_base = &doorbells[i];
+      datagrams[i].buffer.iov_len = sizeof(doorbells[i]);
+    }
+    received = m_socket->RecvMultiple(datagrams, DOORBELL_BATCH_SIZE);
+
+    for (unsigned int i = 0; i < received; i++) {
+      if (datagrams[i].buffer.iov_len != sizeof(doorbells[i])) {
+        continue;
+      }
+      const SharedDmxRegion::Doorbell &doorbell = doorbells[i];
+      switch (doorbell.type) {
+        case SharedDmxRegion::DOORBELL_INPUT_UPDATED:
+          if (doorbell.value < SharedDmxRegion::INPUT_SLOTS) {
+            updated[doorbell.value] = true;
+          }
+          break;
+        case SharedDmxRegion::DOORBELL_INPUT_RELEASED:
+          if (doorbell.value < SharedDmxRegion::INPUT_SLOTS) {
+            updated[doorbell.value] = false;
+            ReleaseInput(doorbell.value);
+          }
+          break;
+        case SharedDmxRegion::DOORBELL_SUBSCRIBE:
+          Subscribe(doorbell.value);
+          break;
+        default:
+          OLA_INFO << "Unknown doorbell type " << doorbell.type;
+      }
+    }
+  } while (received == DOORBELL_BATCH_SIZE);
+
+  for (unsigned int i = 0; i < SharedDmxRegion::INPUT_SLOTS; i++) {
+    if (updated[i]) {
+      InputUpdated(i);
+    }
+  }
+}
+
+void SharedDmxServer::InputUpdated(unsigned int slot) {
+  unsigned int universe_id;
+  uint8_t priority;
+  DmxBuffer buffer;
+  if (!m_region->ReadInput(slot, &universe_id, &priority, &buffer)) {
+    return;
+  }
+
+  InputSource *source = &m_inputs[slot];
+  if (!source->client) {
+    source->client = new Client(NULL, m_uid);
+  } else if (source->universe != universe_id) {
+    Universe *old_universe = m_universe_store->GetUniverse(source->universe);
+    if (old_universe) {
+      old_universe->RemoveSourceClient(source->client);
+    }
+  }
+  source->universe = universe_id;
+
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (!universe) {
+    return;
+  }
+
+  priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                      priority);
+  priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                      priority);
+  DmxSource dmx_source(buffer, *m_wake_up_time, priority);
+  source->client->DMXReceived(universe_id, dmx_source);
+  universe->SourceClientDataChanged(source->client);
+}
+
+void SharedDmxServer::ReleaseInput(unsigned int slot) {
+  InputSource *source = &m_inputs[slot];
+  if (source->client) {
+    Universe *universe = m_universe_store->GetUniverse(source->universe);
+    if (universe) {
+      universe->RemoveSourceClient(source->client);
+    }
+    delete source->client;
+    source->client = NULL;
+  }
+  m_region->ReleaseInputSlot(slot);
+}
+
+void SharedDmxServer::Subscribe(unsigned int universe_id) {
+  if (m_subscriptions.find(universe_id) != m_subscriptions.end()) {
+    return;
+  }
+
+  Universe *universe = m_universe_store->GetUniverseOrCreate(universe_id);
+  if (!universe) {
+    return;
+  }
+
+  int slot = m_region->AssignOutputSlot(universe_id, Now());
+  if (slot < 0) {
+    OLA_INFO << "No free shared memory slots to publish universe "
+             << universe_id;
+    return;
+  }
+  m_subscriptions[universe_id] = slot;
+  universe->AddSinkClient(&m_sink);
+  m_region->WriteOutput(slot, universe->ActivePriority(), universe->GetDMX());
+}
+
+void SharedDmxServer::Unsubscribe(unsigned int universe_id,
+                                  unsigned int slot) {
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (universe) {
+    universe->RemoveSinkClient(&m_sink);
+  }
+  m_region->ReleaseOutputSlot(slot);
+  m_subscriptions.erase(universe_id);
+}
+
+/*
+ * Clean up after clients that have exited without releasing their slots, and
+ * stop publishing universes that no one is reading.
+ */
+bool SharedDmxServer::RunHousekeeping() {
+  for (unsigned int i = 0; i < SharedDmxRegion::INPUT_SLOTS; i++) {
+#ifndef _WIN32
+    uint32_t owner = m_region->InputSlotOwner(i);
+    if (owner && kill(static_cast<pid_t>(owner), 0) < 0 && errno == ESRCH) {
+      OLA_INFO << "Releasing shared memory slot " << i << ", process "
+               << owner << " has exited";
+      ReleaseInput(i);
+    }
+#endif  // _WIN32
+  }
+
+  uint32_t now = Now();
+  vector<std::pair<unsigned int, unsigned int> > expired;
+  SubscriptionMap::const_iterator iter = m_subscriptions.begin();
+  for (; iter != m_subscriptions.end(); ++iter) {
+    if (now - m_region->OutputSlotLastRead(iter->second) >
+        SUBSCRIPTION_TIMEOUT_S) {
+      expired.push_back(*iter);
+    }
+  }
+
+  vector<std::pair<unsigned int, unsigned int> >::const_iterator expired_iter;
+  for (expired_iter = expired.begin(); expired_iter != expired.end();
+       ++expired_iter) {
+    OLA_INFO << "No longer publishing universe " << expired_iter->first;
+    Unsubscribe(expired_iter->first, expired_iter->second);
+  }
+  return true;
+}
+
+uint32_t SharedDmxServer::Now() const {
+  TimeStamp now;
+  m_clock.CurrentCoarseMonotonicTime(&now);
+  return static_cast<uint32_t>(now.Seconds());
+}
+}  // namespace ola
@@ -0,0 +1,139 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SharedDmxServer.h
+ * The olad side of the shared memory DMX transport.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_SHAREDDMXSERVER_H_
+#define OLAD_SHAREDDMXSERVER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/Socket.h"
+#include "ola/rdm/UID.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+/**
+ * @brief Publishes universes to, and accepts DMX data from, local clients
+ * using shared memory.
+ *
+ * Clients claim input slots in the SharedDmxRegion and write frames into
+ * them, then send a doorbell datagram to the loopback address on the RPC
+ * port. Each input slot is treated as a separate source Client, so the data
+ * is merged the same way as data that arrives over the RPC socket.
+ *
+ * Clients that want to read a universe ask for it with a doorbell, and the
+ * universe's merged output is then written to an output slot each time it
+ * changes. Universes that haven't been read for a while are no longer
+ * published.
+ */
+class SharedDmxServer {
+ public:
+  /**
+   * @brief Create a new SharedDmxServer.
+   * @param ss the SelectServer to use.
+   * @param universe_store the UniverseStore.
+   * @param wake_up_time the SelectServer's wake up time, used to timestamp
+   *   incoming data.
+   * @param uid the UID to use for the source clients.
+   * @param port the RPC port, used to name the region and for the doorbell.
+   */
+  SharedDmxServer(ola::io::SelectServerInterface *ss,
+                  UniverseStore *universe_store,
+                  const TimeStamp *wake_up_time,
+                  const ola::rdm::UID &uid,
+                  uint16_t port);
+  ~SharedDmxServer();
+
+  /**
+   * @brief Create the region and start listening for doorbells.
+   */
+  bool Init();
+
+  /**
+   * @brief Write a universe's data to its output slot.
+   */
+  void Publish(unsigned int universe_id, uint8_t priority,
+               const DmxBuffer &buffer);
+
+ private:
+  /**
+   * @brief The Client that is added as a sink to published universes.
+   */
+  class SinkClient: public Client {
+   public:
+    SinkClient(SharedDmxServer *server, const ola::rdm::UID &uid)
+        : Client(NULL, uid),
+          m_server(server) {
+    }
+
+    bool SendDMX(const DmxUpdate &update) {
+      m_server->Publish(update.Universe(), update.Priority(),
+                        update.Buffer());
+      return true;
+    }
+
+   private:
+    SharedDmxServer *m_server;
+  };
+
+  typedef struct {
+    Client *client;
+    unsigned int universe;
+  } InputSource;
+
+  typedef std::map<unsigned int, unsigned int> SubscriptionMap;
+
+  ola::io::SelectServerInterface *m_ss;
+  UniverseStore *m_universe_store;
+  const TimeStamp *m_wake_up_time;
+  const ola::rdm::UID m_uid;
+  const uint16_t m_port;
+  std::auto_ptr<ola::dmx::SharedDmxRegion> m_region;
+  std::auto_ptr<ola::network::UDPSocket> m_socket;
+  SinkClient m_sink;
+  InputSource m_inputs[ola::dmx::SharedDmxRegion::INPUT_SLOTS];
+  SubscriptionMap m_subscriptions;
+  ola::thread::timeout_id m_housekeeping_timeout;
+  Clock m_clock;
+
+  void DoorbellReceived();
+  void InputUpdated(unsigned int slot);
+  void ReleaseInput(unsigned int slot);
+  void Subscribe(unsigned int universe_id);
+  void Unsubscribe(unsigned int universe_id, unsigned int slot);
+  bool RunHousekeeping();
+  uint32_t Now() const;
+
+  static const unsigned int DOORBELL_BATCH_SIZE = 64;
+  static const unsigned int HOUSEKEEPING_INTERVAL_MS = 1000;
+  // Stop publishing a universe if it hasn't been read for this long.
+  static const uint32_t SUBSCRIPTION_TIMEOUT_S = 10;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxServer);
+};
+}  // namespace ola
+#endif  // OLAD_SHAREDDMXSERVER_H_
@@ -0,0 +1,240 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UDPStreamServer.cpp
+ * Accepts DMX data streamed by clients over UDP.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/UDPStreamServer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/Universe.h"
+
+namespace ola {
+
+using ola::dmx::StreamFrame;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
+using ola::network::UDPSocket;
+using std::pair;
+using std::vector;
+
+const unsigned int UDPStreamServer::FRAME_BATCH_SIZE;
+
+UDPStreamServer::UDPStreamServer(ola::io::SelectServerInterface *ss,
+                                 UniverseStore *universe_store,
+                                 const TimeStamp *wake_up_time,
+                                 ExportMap *export_map)
+    : m_ss(ss),
+      m_universe_store(universe_store),
+      m_wake_up_time(wake_up_time),
+      m_port(0),
+      m_received_var(NULL),
+      m_stale_var(NULL),
+      m_dropped_var(NULL) {
+  if (export_map) {
+    m_received_var = export_map->GetCounterVar("udp-stream-frames-received");
+    m_stale_var = export_map->GetCounterVar("udp-stream-frames-stale");
+    m_dropped_var = export_map->GetCounterVar("udp-stream-frames-dropped");
+  }
+}
+
+UDPStreamServer::~UDPStreamServer() {
+  if (m_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_socket.get());
+  }
+}
+
+bool UDPStreamServer::Init(const IPV4SocketAddress &address) {
+  if (m_socket.get()) {
+    return false;
+  }
+
+  std::auto_ptr<UDPSocket> socket(new UDPSocket());
+  if (!socket->Init()) {
+    return false;
+  }
+  if (!socket->Bind(address)) {
+    OLA_WARN << "Failed to bind the UDP streaming socket to " << address;
+    return false;
+  }
+
+  IPV4SocketAddress local_address;
+  if (!socket->GetSocketAddress(&local_address)) {
+    return false;
+  }
+
+  socket->SetOnData(NewCallback(this, &UDPStreamServer::FramesReceived));
+  // FramesReceived() reads until the socket is empty.
+  socket->SetEdgeTriggered(true);
+  if (!m_ss->AddReadDescriptor(socket.get())) {
+    return false;
+  }
+  m_socket.reset(socket.release());
+  m_port = local_address.Port();
+  OLA_INFO << "Accepting streamed DMX data on UDP port " << m_port;
+  return true;
+}
+
+bool UDPStreamServer::AddClient(Client *client, uint64_t *token) {
+  const uint64_t *existing_token = STLFind(&m_tokens, client);
+  if (existing_token) {
+    *token = *existing_token;
+    return true;
+  }
+
+  uint64_t new_token;
+  do {
+    if (!NewToken(&new_token)) {
+      return false;
+    }
+  } while (!new_token || STLContains(m_streams, new_token));
+
+  m_streams[new_token].client = client;
+  m_tokens[client] = new_token;
+  *token = new_token;
+  return true;
+}
+
+void UDPStreamServer::RemoveClient(const Client *client) {
+  TokenMap::iterator iter = m_tokens.find(client);
+  if (iter != m_tokens.end()) {
+    m_streams.erase(iter->second);
+    m_tokens.erase(iter);
+  }
+}
+
+/*
+ * Drain the socket. The universes are only told about the new data once the
+ * socket is empty, so a backlog of frames for a universe is merged once.
+ */
+void UDPStreamServer::FramesReceived() {
+  uint8_t frames[FRAME_BATCH_SIZE][StreamFrame::MAX_SIZE];
+  UDPDatagram datagrams[FRAME_BATCH_SIZE];
+  vector<pair<Universe*, Client*> > changed;
+
+  unsigned int received;
+  do {
+    for (unsigned int i = 0; i < FRAME_BATCH_SIZE; i++) {
+      datagrams[i].buffer.iov_base = frames[i];
+      datagrams[i].buffer.iov_len = sizeof(frames[i]);
+    }
+    received = m_socket->RecvMultiple(datagrams, FRAME_BATCH_SIZE);
+    for (unsigned int i = 0; i < received; i++) {
+      Client *client;
+      Universe *universe = FrameReceived(
+          frames[i], static_cast<unsigned int>(datagrams[i].buffer.iov_len),
+          &client);
+      if (universe) {
+        pair<Universe*, Client*> entry(universe, client);
+        if (std::find(changed.begin(), changed.end(), entry) ==
+            changed.end()) {
+          changed.push_back(entry);
+        }
+      }
+    }
+  } while (received == FRAME_BATCH_SIZE);
+
+  vector<pair<Universe*, Client*> >::iterator iter = changed.begin();
+  for (; iter != changed.end(); ++iter) {
+    iter->first->SourceClientDataChanged(iter->second);
+  }
+}
+
+/*
+ * @returns the universe the data was for, or NULL if the frame was dropped.
+ */
+Universe *UDPStreamServer::FrameReceived(const uint8_t *data,
+                                         unsigned int length,
+                                         Client **client) {
+  StreamFrame frame;
+  if (!frame.Unpack(data, length)) {
+    Increment(m_dropped_var);
+    return NULL;
+  }
+
+  Stream *stream = STLFind(&m_streams, frame.token);
+  if (!stream) {
+    Increment(m_dropped_var);
+    return NULL;
+  }
+
+  SequenceMap::iterator seq_iter = stream->sequences.find(frame.universe);
+  if (seq_iter == stream->sequences.end()) {
+    stream->sequences[frame.universe] = frame.sequence;
+  } else if (StreamFrame::IsNewer(frame.sequence, seq_iter->second)) {
+    seq_iter->second = frame.sequence;
+  } else {
+    Increment(m_stale_var);
+    return NULL;
+  }
+  Increment(m_received_var);
+
+  Universe *universe = m_universe_store->GetUniverse(frame.universe);
+  if (!universe) {
+    return NULL;
+  }
+
+  uint8_t priority = std::max(
+      static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN), frame.priority);
+  priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                      priority);
+  DmxSource source(DmxBuffer(frame.data, frame.length), *m_wake_up_time,
+                   priority);
+  stream->client->DMXReceived(frame.universe, source);
+  *client = stream->client;
+  return universe;
+}
+
+/*
+ * The token is all that stops another host from sending data as this client,
+ * so it comes from the kernel's random source.
+ */
+bool UDPStreamServer::NewToken(uint64_t *token) {
+  int fd = open("/dev/urandom", O_RDONLY);
+  if (fd < 0) {
+    OLA_WARN << "Failed to open /dev/urandom: " << strerror(errno);
+    return false;
+  }
+  ssize_t bytes_read = read(fd, token, sizeof(*token));
+  close(fd);
+  if (bytes_read != static_cast<ssize_t>(sizeof(*token))) {
+    OLA_WARN << "Failed to read a token from /dev/urandom";
+    return false;
+  }
+  return true;
+}
+
+void UDPStreamServer::Increment(CounterVariable *var) {
+  if (var) {
+    (*var)++;
+  }
+}
+}  // namespace ola
@@ -0,0 +1,133 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UDPStreamServer.h
+ * Accepts DMX data streamed by clients over UDP.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_UDPSTREAMSERVER_H_
+#define OLAD_UDPSTREAMSERVER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+
+#include "common/dmx/StreamFrame.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+/**
+ * @brief Accepts DMX data from RPC clients over UDP.
+ *
+ * Streaming DMX data over the RPC connection means a single lost TCP segment
+ * holds up every frame after it, even though only the newest frame matters.
+ * Instead, a client can ask for a token over the RPC connection, and then
+ * send its frames to this socket, see StreamFrame.h. The data is applied to
+ * the Client for the RPC connection, so it's merged in the same way as data
+ * that arrives over RPC.
+ *
+ * Each universe has its own sequence number, frames that arrive after a
+ * newer frame for the same universe are dropped. The token is valid until the
+ * RPC connection closes.
+ */
+class UDPStreamServer {
+ public:
+  /**
+   * @brief Create a new UDPStreamServer.
+   * @param ss the SelectServer to use.
+   * @param universe_store the UniverseStore.
+   * @param wake_up_time the SelectServer's wake up time, used to timestamp
+   *   incoming data.
+   * @param export_map the ExportMap to use for the counters, may be NULL.
+   */
+  UDPStreamServer(ola::io::SelectServerInterface *ss,
+                  UniverseStore *universe_store,
+                  const TimeStamp *wake_up_time,
+                  ExportMap *export_map = NULL);
+  ~UDPStreamServer();
+
+  /**
+   * @brief Open the socket.
+   * @param address the address to listen on. If the port is 0 a free port
+   *   is used.
+   */
+  bool Init(const ola::network::IPV4SocketAddress &address);
+
+  /**
+   * @brief The port the socket is bound to.
+   */
+  uint16_t Port() const { return m_port; }
+
+  /**
+   * @brief Allow a client to stream data over UDP.
+   * @param client the Client for the RPC connection.
+   * @param[out] token the token the client must send with each frame. If
+   *   the client already has a token, the same token is returned.
+   * @returns false if a token couldn't be generated.
+   */
+  bool AddClient(Client *client, uint64_t *token);
+
+  /**
+   * @brief Revoke a client's token, this is called when the RPC connection
+   *   closes.
+   */
+  void RemoveClient(const Client *client);
+
+ private:
+  typedef std::map<unsigned int, uint32_t> SequenceMap;
+
+  struct Stream {
+    Stream() : client(NULL) {}
+
+    Client *client;
+    // The sequence number of the last frame accepted for each universe.
+    SequenceMap sequences;
+  };
+
+  typedef std::map<uint64_t, Stream> StreamMap;
+  typedef std::map<const Client*, uint64_t> TokenMap;
+
+  ola::io::SelectServerInterface *m_ss;
+  UniverseStore *m_universe_store;
+  const TimeStamp *m_wake_up_time;
+  std::auto_ptr<ola::network::UDPSocket> m_socket;
+  uint16_t m_port;
+  StreamMap m_streams;
+  TokenMap m_tokens;
+  CounterVariable *m_received_var;
+  CounterVariable *m_stale_var;
+  CounterVariable *m_dropped_var;
+
+  void FramesReceived();
+  Universe *FrameReceived(const uint8_t *data, unsigned int length,
+                          Client **client);
+  static bool NewToken(uint64_t *token);
+  static void Increment(CounterVariable *var);
+
+  static const unsigned int FRAME_BATCH_SIZE = 16;
+
+  DISALLOW_COPY_AND_ASSIGN(UDPStreamServer);
+};
+}  // namespace ola
+#endif  // OLAD_UDPSTREAMSERVER_H_
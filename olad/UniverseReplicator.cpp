@@ -0,0 +1,536 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseReplicator.cpp
+ * Replicates universes between olad nodes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/UniverseReplicator.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/Universe.h"
+
+namespace ola {
+
+using ola::network::GenericSocketAddress;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::TCPAcceptingSocket;
+using ola::network::TCPSocket;
+using ola::network::UDPDatagram;
+using ola::network::UDPSocket;
+using std::string;
+using std::vector;
+
+namespace {
+
+void CleanupSocket(TCPSocket *socket) {
+  delete socket;
+}
+}  // namespace
+
+const unsigned int UniverseReplicator::DEFAULT_KEYFRAME_INTERVAL;
+const unsigned int UniverseReplicator::FRAME_BATCH_SIZE;
+const unsigned int UniverseReplicator::HOUSEKEEPING_INTERVAL_MS;
+const unsigned int UniverseReplicator::RX_BUFFER_SIZE;
+const unsigned int UniverseReplicator::KEYFRAME_REFRESH_MS;
+const unsigned int UniverseReplicator::TCP_CONNECT_TIMEOUT_MS;
+
+UniverseReplicator::UniverseReplicator(ola::io::SelectServerInterface *ss,
+                                       UniverseStore *universe_store,
+                                       const TimeStamp *wake_up_time,
+                                       const ola::rdm::UID &uid,
+                                       const Options &options,
+                                       ExportMap *export_map)
+    : m_ss(ss),
+      m_universe_store(universe_store),
+      m_wake_up_time(wake_up_time),
+      m_uid(uid),
+      m_options(options),
+      m_sink(this, uid),
+      m_accept_factory(
+          NewCallback(this, &UniverseReplicator::NodeConnected)),
+      m_connect_factory(
+          NewCallback(this, &UniverseReplicator::PeerConnected)),
+      m_connector(ss, &m_connect_factory,
+                  TimeInterval(TCP_CONNECT_TIMEOUT_MS / 1000,
+                               (TCP_CONNECT_TIMEOUT_MS % 1000) * 1000)),
+      m_backoff_policy(TimeInterval(1, 0), TimeInterval(30, 0)),
+      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT),
+      m_sent_var(NULL),
+      m_received_var(NULL),
+      m_lost_var(NULL),
+      m_dropped_var(NULL) {
+  if (export_map) {
+    m_sent_var = export_map->GetCounterVar("replication-frames-sent");
+    m_received_var = export_map->GetCounterVar("replication-frames-received");
+    m_lost_var = export_map->GetCounterVar("replication-frames-lost");
+    m_dropped_var = export_map->GetCounterVar("replication-frames-dropped");
+  }
+}
+
+UniverseReplicator::~UniverseReplicator() {
+  if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_housekeeping_timeout);
+  }
+
+  PublishedUniverseMap::iterator pub_iter = m_published.begin();
+  for (; pub_iter != m_published.end(); ++pub_iter) {
+    Universe *universe = m_universe_store->GetUniverse(pub_iter->first);
+    if (universe) {
+      universe->RemoveSinkClient(&m_sink);
+    }
+  }
+  STLDeleteValues(&m_published);
+
+  while (!m_nodes.empty()) {
+    TCPSocket *socket = m_nodes.begin()->second->socket;
+    RemoveNode(m_nodes.begin()->second);
+    delete socket;
+  }
+
+  PeerSocketMap::iterator peer_iter = m_peer_sockets.begin();
+  for (; peer_iter != m_peer_sockets.end(); ++peer_iter) {
+    m_ss->RemoveReadDescriptor(peer_iter->second);
+    delete peer_iter->second;
+  }
+  m_peer_sockets.clear();
+
+  vector<IPV4SocketAddress>::const_iterator iter = m_options.peers.begin();
+  for (; iter != m_options.peers.end(); ++iter) {
+    m_connector.RemoveEndpoint(*iter);
+  }
+
+  if (m_listening_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_listening_socket.get());
+  }
+  if (m_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_socket.get());
+  }
+}
+
+bool UniverseReplicator::Init() {
+  if (m_socket.get()) {
+    return false;
+  }
+
+  std::auto_ptr<UDPSocket> socket(new UDPSocket());
+  if (!socket->Init()) {
+    return false;
+  }
+
+  std::auto_ptr<TCPAcceptingSocket> listening_socket;
+  if (m_options.listen_port) {
+    const IPV4SocketAddress listen_address(IPV4Address::WildCard(),
+                                           m_options.listen_port);
+    if (!socket->Bind(listen_address)) {
+      OLA_WARN << "Failed to bind the replication socket to "
+               << listen_address;
+      return false;
+    }
+    listening_socket.reset(new TCPAcceptingSocket(&m_accept_factory));
+    if (!listening_socket->Listen(listen_address)) {
+      return false;
+    }
+    socket->SetOnData(
+        NewCallback(this, &UniverseReplicator::FramesReceived));
+    if (!m_ss->AddReadDescriptor(socket.get()) ||
+        !m_ss->AddReadDescriptor(listening_socket.get())) {
+      m_ss->RemoveReadDescriptor(socket.get());
+      return false;
+    }
+    OLA_INFO << "Accepting replicated universes on " << listen_address;
+  }
+  m_socket.reset(socket.release());
+  m_listening_socket.reset(listening_socket.release());
+
+  if (!m_options.peers.empty()) {
+    vector<unsigned int>::const_iterator iter = m_options.universes.begin();
+    for (; iter != m_options.universes.end(); ++iter) {
+      if (STLContains(m_published, *iter)) {
+        continue;
+      }
+      Universe *universe = m_universe_store->GetUniverseOrCreate(*iter);
+      if (!universe) {
+        continue;
+      }
+      PublishedUniverse *published = new PublishedUniverse(
+          *iter, m_options.keyframe_interval);
+      published->info.name = universe->Name();
+      published->info.ltp = universe->MergeMode() == Universe::MERGE_LTP;
+      published->info.priority = universe->ActivePriority();
+      m_published[*iter] = published;
+      universe->AddSinkClient(&m_sink);
+    }
+
+    vector<IPV4SocketAddress>::const_iterator peer_iter =
+        m_options.peers.begin();
+    for (; peer_iter != m_options.peers.end(); ++peer_iter) {
+      m_connector.AddEndpoint(*peer_iter, &m_backoff_policy);
+    }
+  }
+
+  m_housekeeping_timeout = m_ss->RegisterRepeatingTimeout(
+      HOUSEKEEPING_INTERVAL_MS,
+      NewCallback(this, &UniverseReplicator::RunHousekeeping));
+  return true;
+}
+
+void UniverseReplicator::Publish(unsigned int universe_id, uint8_t priority,
+                                 const DmxBuffer &buffer) {
+  PublishedUniverse *published = STLFindOrNull(m_published, universe_id);
+  if (!published) {
+    return;
+  }
+
+  // Priority changes go out on the control channel as well, since that's
+  // reliable.
+  if (priority != published->info.priority) {
+    published->info.priority = priority;
+    PeerSocketMap::iterator iter = m_peer_sockets.begin();
+    for (; iter != m_peer_sockets.end(); ++iter) {
+      SendUniverseInfo(published->info, iter->second);
+    }
+  }
+  published->last_frame = buffer;
+  SendFrame(published, priority, buffer, false);
+}
+
+void UniverseReplicator::PeerConnected(TCPSocket *socket) {
+  GenericSocketAddress address = socket->GetPeerAddress();
+  if (address.Family() != AF_INET) {
+    delete socket;
+    return;
+  }
+  const IPV4SocketAddress peer = address.V4Addr();
+  OLA_INFO << "Replication control channel to " << peer << " is up";
+
+  socket->SetNoDelay();
+  socket->SetOnData(
+      NewCallback(this, &UniverseReplicator::PeerReadable, socket));
+  socket->SetOnClose(
+      NewSingleCallback(this, &UniverseReplicator::PeerClosed, socket));
+  m_ss->AddReadDescriptor(socket);
+  m_peer_sockets[peer] = socket;
+
+  // Send the state of every universe, then a keyframe of each so the peer
+  // doesn't have to wait for the next one.
+  PublishedUniverseMap::iterator iter = m_published.begin();
+  for (; iter != m_published.end(); ++iter) {
+    SendUniverseInfo(iter->second->info, socket);
+  }
+  for (iter = m_published.begin(); iter != m_published.end(); ++iter) {
+    if (iter->second->last_frame.Size()) {
+      SendFrame(iter->second, iter->second->info.priority,
+                iter->second->last_frame, true);
+    }
+  }
+}
+
+/*
+ * The peer doesn't send anything on the control channel, this is only used
+ * to notice when it closes.
+ */
+void UniverseReplicator::PeerReadable(TCPSocket *socket) {
+  uint8_t data[RX_BUFFER_SIZE];
+  unsigned int data_read = 0;
+  if (socket->Receive(data, sizeof(data), data_read) < 0) {
+    PeerClosed(socket);
+  }
+}
+
+void UniverseReplicator::PeerClosed(TCPSocket *socket) {
+  PeerSocketMap::iterator iter = m_peer_sockets.begin();
+  for (; iter != m_peer_sockets.end(); ++iter) {
+    if (iter->second == socket) {
+      break;
+    }
+  }
+  if (iter == m_peer_sockets.end()) {
+    return;
+  }
+
+  const IPV4SocketAddress peer = iter->first;
+  OLA_INFO << "Replication control channel to " << peer << " closed";
+  m_peer_sockets.erase(iter);
+  m_ss->RemoveReadDescriptor(socket);
+  m_ss->Execute(NewSingleCallback(&CleanupSocket, socket));
+  m_connector.Disconnect(peer);
+}
+
+void UniverseReplicator::SendFrame(PublishedUniverse *published,
+                                   uint8_t priority,
+                                   const DmxBuffer &buffer,
+                                   bool force_keyframe) {
+  uint8_t packet[ReplicationEncoder::MAX_FRAME_SIZE];
+  const unsigned int size = published->encoder.Encode(
+      priority, buffer, force_keyframe, packet);
+  m_clock.CurrentMonotonicTime(&published->last_sent);
+
+  // Frames are only sent to peers with a control channel, since the others
+  // would drop them.
+  PeerSocketMap::const_iterator iter = m_peer_sockets.begin();
+  for (; iter != m_peer_sockets.end(); ++iter) {
+    m_socket->SendTo(packet, size, iter->first);
+    Increment(m_sent_var);
+  }
+}
+
+void UniverseReplicator::SendUniverseInfo(const ReplicationUniverseInfo &info,
+                                          TCPSocket *socket) {
+  string message;
+  BuildReplicationUniverseInfo(info, &message);
+  socket->Send(reinterpret_cast<const uint8_t*>(message.data()),
+               static_cast<unsigned int>(message.size()));
+}
+
+/*
+ * Pick up name & merge mode changes, and refresh idle universes.
+ */
+bool UniverseReplicator::RunHousekeeping() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+
+  PublishedUniverseMap::iterator iter = m_published.begin();
+  for (; iter != m_published.end(); ++iter) {
+    PublishedUniverse *published = iter->second;
+    Universe *universe = m_universe_store->GetUniverse(iter->first);
+    if (universe) {
+      const bool ltp = universe->MergeMode() == Universe::MERGE_LTP;
+      if (universe->Name() != published->info.name ||
+          ltp != published->info.ltp) {
+        published->info.name = universe->Name();
+        published->info.ltp = ltp;
+        PeerSocketMap::iterator peer_iter = m_peer_sockets.begin();
+        for (; peer_iter != m_peer_sockets.end(); ++peer_iter) {
+          SendUniverseInfo(published->info, peer_iter->second);
+        }
+      }
+    }
+
+    if (published->last_frame.Size() &&
+        now - published->last_sent >=
+            TimeInterval(KEYFRAME_REFRESH_MS / 1000,
+                         (KEYFRAME_REFRESH_MS % 1000) * 1000)) {
+      SendFrame(published, published->info.priority, published->last_frame,
+                true);
+    }
+  }
+  return true;
+}
+
+void UniverseReplicator::NodeConnected(TCPSocket *socket) {
+  GenericSocketAddress address = socket->GetPeerAddress();
+  if (address.Family() != AF_INET) {
+    delete socket;
+    return;
+  }
+  const IPV4Address node_address = address.V4Addr().Host();
+
+  // A node that restarts may connect again before we notice the old
+  // connection has gone.
+  RemoteNode *old_node = STLFindOrNull(m_nodes, node_address);
+  if (old_node) {
+    TCPSocket *old_socket = old_node->socket;
+    RemoveNode(old_node);
+    delete old_socket;
+  }
+
+  OLA_INFO << "Replication node " << node_address << " connected";
+  RemoteNode *node = new RemoteNode();
+  node->socket = socket;
+  socket->SetOnData(
+      NewCallback(this, &UniverseReplicator::NodeReadable, node));
+  socket->SetOnClose(
+      NewSingleCallback(this, &UniverseReplicator::NodeClosed, node));
+  m_ss->AddReadDescriptor(socket);
+  m_nodes[node_address] = node;
+}
+
+void UniverseReplicator::NodeReadable(RemoteNode *node) {
+  unsigned int data_read = 0;
+  if (node->socket->Receive(node->rx_buffer + node->rx_offset,
+                            RX_BUFFER_SIZE - node->rx_offset,
+                            data_read) < 0) {
+    NodeClosed(node);
+    return;
+  }
+  node->rx_offset += data_read;
+
+  vector<ReplicationUniverseInfo> universes;
+  const unsigned int consumed = ParseReplicationControl(
+      node->rx_buffer, node->rx_offset, &universes);
+  if (consumed) {
+    node->rx_offset -= consumed;
+    memmove(node->rx_buffer, node->rx_buffer + consumed, node->rx_offset);
+  }
+
+  vector<ReplicationUniverseInfo>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    UniverseAnnounced(node, *iter);
+  }
+}
+
+void UniverseReplicator::NodeClosed(RemoteNode *node) {
+  TCPSocket *socket = node->socket;
+  OLA_INFO << "Replication node " << socket->GetPeerAddress()
+           << " disconnected";
+  RemoveNode(node);
+  // We're in the call stack of the socket, so delete it on the next run of
+  // the event loop.
+  m_ss->Execute(NewSingleCallback(&CleanupSocket, socket));
+}
+
+void UniverseReplicator::UniverseAnnounced(
+    RemoteNode *node,
+    const ReplicationUniverseInfo &info) {
+  Universe *universe = m_universe_store->GetUniverseOrCreate(info.universe);
+  if (!universe) {
+    return;
+  }
+
+  if (!info.name.empty()) {
+    universe->SetName(info.name);
+  }
+  universe->SetMergeMode(info.ltp ? Universe::MERGE_LTP :
+                                    Universe::MERGE_HTP);
+
+  RemoteUniverse *remote = STLFindOrNull(node->universes, info.universe);
+  if (!remote) {
+    remote = new RemoteUniverse();
+    remote->client = new Client(NULL, m_uid);
+    node->universes[info.universe] = remote;
+    return;
+  }
+
+  // Apply a priority change straight away, rather than waiting for the next
+  // frame, which may be some time if the universe is idle.
+  const DmxSource *source = remote->client->FindSourceData(info.universe);
+  if (source && source->IsSet() && source->Priority() != info.priority) {
+    ApplyFrame(remote, universe, source->Data(), info.priority);
+  }
+}
+
+void UniverseReplicator::FramesReceived() {
+  uint8_t frames[FRAME_BATCH_SIZE][ReplicationEncoder::MAX_FRAME_SIZE];
+  UDPDatagram datagrams[FRAME_BATCH_SIZE];
+
+  unsigned int received;
+  do {
+    for (unsigned int i = 0; i < FRAME_BATCH_SIZE; i++) {
+      datagrams[i].buffer.iov_base = frames[i];
+      datagrams[i].buffer.iov_len = sizeof(frames[i]);
+    }
+    received = m_socket->RecvMultiple(datagrams, FRAME_BATCH_SIZE);
+    for (unsigned int i = 0; i < received; i++) {
+      FrameReceived(datagrams[i].address.Host(), frames[i],
+                    static_cast<unsigned int>(datagrams[i].buffer.iov_len));
+    }
+  } while (received == FRAME_BATCH_SIZE);
+}
+
+void UniverseReplicator::FrameReceived(const IPV4Address &source,
+                                       const uint8_t *data,
+                                       unsigned int length) {
+  ReplicationFrameHeader header;
+  const uint8_t *payload;
+  unsigned int payload_length;
+  if (!ParseReplicationFrame(data, length, &header, &payload,
+                             &payload_length)) {
+    Increment(m_dropped_var);
+    return;
+  }
+
+  // Only accept universes announced on the node's control channel.
+  RemoteNode *node = STLFindOrNull(m_nodes, source);
+  RemoteUniverse *remote = node ?
+      STLFindOrNull(node->universes, header.universe) : NULL;
+  if (!remote) {
+    Increment(m_dropped_var);
+    return;
+  }
+
+  DmxBuffer buffer;
+  const unsigned int lost = remote->decoder.Lost();
+  ReplicationDecoder::Result result = remote->decoder.Decode(
+      header, payload, payload_length, &buffer);
+  if (m_lost_var) {
+    (*m_lost_var) += remote->decoder.Lost() - lost;
+  }
+  if (result != ReplicationDecoder::FRAME_OK) {
+    Increment(m_dropped_var);
+    return;
+  }
+  Increment(m_received_var);
+
+  Universe *universe = m_universe_store->GetUniverse(header.universe);
+  if (universe) {
+    ApplyFrame(remote, universe, buffer, header.priority);
+  }
+}
+
+void UniverseReplicator::ApplyFrame(RemoteUniverse *remote,
+                                    Universe *universe,
+                                    const DmxBuffer &buffer,
+                                    uint8_t priority) {
+  priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                      priority);
+  priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                      priority);
+  DmxSource dmx_source(buffer, *m_wake_up_time, priority);
+  remote->client->DMXReceived(universe->UniverseId(), dmx_source);
+  universe->SourceClientDataChanged(remote->client);
+}
+
+void UniverseReplicator::RemoveNode(RemoteNode *node) {
+  RemoteUniverseMap::iterator iter = node->universes.begin();
+  for (; iter != node->universes.end(); ++iter) {
+    Universe *universe = m_universe_store->GetUniverse(iter->first);
+    if (universe) {
+      universe->RemoveSourceClient(iter->second->client);
+    }
+    delete iter->second->client;
+    delete iter->second;
+  }
+
+  RemoteNodeMap::iterator node_iter = m_nodes.begin();
+  for (; node_iter != m_nodes.end(); ++node_iter) {
+    if (node_iter->second == node) {
+      m_nodes.erase(node_iter);
+      break;
+    }
+  }
+
+  m_ss->RemoveReadDescriptor(node->socket);
+  delete node;
+}
+
+void UniverseReplicator::Increment(CounterVariable *var) {
+  if (var) {
+    (*var)++;
+  }
+}
+}  // namespace ola
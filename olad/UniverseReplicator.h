@@ -0,0 +1,247 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseReplicator.h
+ * Replicates universes between olad nodes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_UNIVERSEREPLICATOR_H_
+#define OLAD_UNIVERSEREPLICATOR_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/AdvancedTCPConnector.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/network/TCPSocket.h"
+#include "ola/network/TCPSocketFactory.h"
+#include "ola/rdm/UID.h"
+#include "ola/util/Backoff.h"
+#include "olad/ReplicationCodec.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+/**
+ * @brief Replicates universes between olad nodes.
+ *
+ * The merged output of each published universe is sent to the peer nodes as
+ * delta compressed frames over UDP, see ReplicationCodec.h. Each peer also
+ * gets a TCP connection, the control channel, which carries the name, merge
+ * mode and priority of the published universes. A node only accepts frames
+ * for universes that have been announced on a control channel, and the
+ * universes are dropped when the control channel closes.
+ *
+ * On the receiving node each replicated universe is a single source Client
+ * at the priority of the publishing node's output, so the data isn't merged
+ * again on every hop. Nodes are identified by their IP address.
+ *
+ * Don't publish a universe back to the node it's replicated from, the data
+ * would loop.
+ */
+class UniverseReplicator {
+ public:
+  struct Options {
+    /**
+     * @brief The UDP & TCP port to accept replicated universes on, 0 means
+     * don't accept them.
+     */
+    uint16_t listen_port;
+
+    /**
+     * @brief The nodes to send the published universes to.
+     */
+    std::vector<ola::network::IPV4SocketAddress> peers;
+
+    /**
+     * @brief The universes to publish.
+     */
+    std::vector<unsigned int> universes;
+
+    /**
+     * @brief Send a keyframe at least every this many frames.
+     */
+    unsigned int keyframe_interval;
+
+    Options()
+        : listen_port(0),
+          keyframe_interval(DEFAULT_KEYFRAME_INTERVAL) {
+    }
+  };
+
+  /**
+   * @brief Create a new UniverseReplicator.
+   * @param ss the SelectServer to use.
+   * @param universe_store the UniverseStore.
+   * @param wake_up_time the SelectServer's wake up time, used to timestamp
+   *   incoming data.
+   * @param uid the UID to use for the source clients.
+   * @param options the Options.
+   * @param export_map the ExportMap to use for the counters, may be NULL.
+   */
+  UniverseReplicator(ola::io::SelectServerInterface *ss,
+                     UniverseStore *universe_store,
+                     const TimeStamp *wake_up_time,
+                     const ola::rdm::UID &uid,
+                     const Options &options,
+                     ExportMap *export_map = NULL);
+  ~UniverseReplicator();
+
+  /**
+   * @brief Open the sockets and start publishing.
+   */
+  bool Init();
+
+  /**
+   * @brief Send a frame of a published universe to the peers.
+   */
+  void Publish(unsigned int universe_id, uint8_t priority,
+               const DmxBuffer &buffer);
+
+  static const unsigned int DEFAULT_KEYFRAME_INTERVAL = 40;
+
+ private:
+  static const unsigned int FRAME_BATCH_SIZE = 16;
+  static const unsigned int HOUSEKEEPING_INTERVAL_MS = 1000;
+  static const unsigned int RX_BUFFER_SIZE = 1024;
+  // Resend idle universes as keyframes this often, so new & recovering nodes
+  // get the data.
+  static const unsigned int KEYFRAME_REFRESH_MS = 1000;
+  static const unsigned int TCP_CONNECT_TIMEOUT_MS = 2000;
+
+  /**
+   * @brief The Client that is added as a sink to published universes.
+   */
+  class SinkClient: public Client {
+   public:
+    SinkClient(UniverseReplicator *replicator, const ola::rdm::UID &uid)
+        : Client(NULL, uid),
+          m_replicator(replicator) {
+    }
+
+    bool SendDMX(const DmxUpdate &update) {
+      m_replicator->Publish(update.Universe(), update.Priority(),
+                            update.Buffer());
+      return true;
+    }
+
+   private:
+    UniverseReplicator *m_replicator;
+  };
+
+  struct PublishedUniverse {
+    explicit PublishedUniverse(unsigned int universe_id,
+                               unsigned int keyframe_interval)
+        : encoder(universe_id, keyframe_interval) {
+      info.universe = universe_id;
+      info.priority = 0;
+      info.ltp = false;
+    }
+
+    ReplicationEncoder encoder;
+    ReplicationUniverseInfo info;
+    DmxBuffer last_frame;
+    TimeStamp last_sent;
+  };
+
+  struct RemoteUniverse {
+    RemoteUniverse() : client(NULL) {}
+
+    Client *client;
+    ReplicationDecoder decoder;
+  };
+
+  typedef std::map<unsigned int, RemoteUniverse*> RemoteUniverseMap;
+
+  struct RemoteNode {
+    RemoteNode() : socket(NULL), rx_offset(0) {}
+
+    ola::network::TCPSocket *socket;
+    uint8_t rx_buffer[RX_BUFFER_SIZE];
+    unsigned int rx_offset;
+    RemoteUniverseMap universes;
+  };
+
+  typedef std::map<unsigned int, PublishedUniverse*> PublishedUniverseMap;
+  typedef std::map<ola::network::IPV4SocketAddress,
+                   ola::network::TCPSocket*> PeerSocketMap;
+  typedef std::map<ola::network::IPV4Address, RemoteNode*> RemoteNodeMap;
+
+  ola::io::SelectServerInterface *m_ss;
+  UniverseStore *m_universe_store;
+  const TimeStamp *m_wake_up_time;
+  const ola::rdm::UID m_uid;
+  const Options m_options;
+  SinkClient m_sink;
+  Clock m_clock;
+
+  std::auto_ptr<ola::network::UDPSocket> m_socket;
+  ola::network::TCPSocketFactory m_accept_factory;
+  ola::network::TCPSocketFactory m_connect_factory;
+  std::auto_ptr<ola::network::TCPAcceptingSocket> m_listening_socket;
+  ola::network::AdvancedTCPConnector m_connector;
+  ola::ExponentialBackoffPolicy m_backoff_policy;
+  ola::thread::timeout_id m_housekeeping_timeout;
+
+  PublishedUniverseMap m_published;
+  PeerSocketMap m_peer_sockets;
+  RemoteNodeMap m_nodes;
+
+  CounterVariable *m_sent_var;
+  CounterVariable *m_received_var;
+  CounterVariable *m_lost_var;
+  CounterVariable *m_dropped_var;
+
+  // Publishing
+  void PeerConnected(ola::network::TCPSocket *socket);
+  void PeerReadable(ola::network::TCPSocket *socket);
+  void PeerClosed(ola::network::TCPSocket *socket);
+  void SendFrame(PublishedUniverse *published, uint8_t priority,
+                 const DmxBuffer &buffer, bool force_keyframe);
+  void SendUniverseInfo(const ReplicationUniverseInfo &info,
+                        ola::network::TCPSocket *socket);
+  bool RunHousekeeping();
+
+  // Receiving
+  void NodeConnected(ola::network::TCPSocket *socket);
+  void NodeReadable(RemoteNode *node);
+  void NodeClosed(RemoteNode *node);
+  void UniverseAnnounced(RemoteNode *node,
+                         const ReplicationUniverseInfo &info);
+  void FramesReceived();
+  void FrameReceived(const ola::network::IPV4Address &source,
+                     const uint8_t *data, unsigned int length);
+  void ApplyFrame(RemoteUniverse *remote, Universe *universe,
+                  const DmxBuffer &buffer, uint8_t priority);
+  void RemoveNode(RemoteNode *node);
+
+  static void Increment(CounterVariable *var);
+
+  DISALLOW_COPY_AND_ASSIGN(UniverseReplicator);
+};
+}  // namespace ola
+#endif  // OLAD_UNIVERSEREPLICATOR_H_
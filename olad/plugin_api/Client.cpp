@@ -23,6 +23,7 @@
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "ola/Callback.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
@@ -34,54 +35,100 @@ using ola::rdm::UID;
 using ola::rpc::RpcController;
 using std::map;
 
+namespace {
+void RDMPolledValuesSent(RpcController *controller, ola::proto::Ack *ack) {
+  if (controller->Failed()) {
+    OLA_INFO << "Failed to send RDM polled values: "
+             << controller->ErrorText();
+  }
+  delete controller;
+  delete ack;
+}
+}  // namespace
+
+DmxUpdate::DmxUpdate(unsigned int universe, uint8_t priority,
+                     const DmxBuffer &buffer)
+    : m_universe(universe),
+      m_priority(priority),
+      m_buffer(buffer) {
+}
+
+DmxUpdate::~DmxUpdate() {}
+
+const ola::proto::DmxData &DmxUpdate::Message() const {
+  if (!m_message.get()) {
+    m_message.reset(new ola::proto::DmxData());
+    m_message->set_universe(m_universe);
+    m_message->set_priority(m_priority);
+    m_message->set_data(m_buffer.Get());
+  }
+  return *m_message;
+}
+
 Client::Client(ola::proto::OlaClientService_Stub *client_stub,
                const ola::rdm::UID &uid)
     : m_client_stub(client_stub),
-      m_uid(uid) {
+      m_uid(uid),
+      m_delta_encoding(false),
+      m_outstanding_updates(0) {
 }
 
 Client::~Client() {
   m_data_map.clear();
+  m_sent_frames.clear();
+  m_pending_updates.clear();
 }
 
 bool Client::SendDMX(unsigned int universe, uint8_t priority,
                      const DmxBuffer &buffer) {
+  const DmxUpdate update(universe, priority, buffer);
+  return SendDMX(update);
+}
+
+bool Client::SendDMX(const DmxUpdate &update) {
   if (!m_client_stub.get()) {
     OLA_FATAL << "client_stub is null";
     return false;
   }
 
-  RpcController *controller = new RpcController();
-  ola::proto::DmxData dmx_data;
-  ola::proto::Ack *ack = new ola::proto::Ack();
+  if (m_outstanding_updates >= MAX_OUTSTANDING_UPDATES) {
+    STLReplace(&m_pending_updates, update.Universe(),
+               PendingUpdate(update.Priority(), update.Buffer()));
+    return true;
+  }
 
-  dmx_data.set_priority(priority);
-  dmx_data.set_universe(universe);
-  dmx_data.set_data(buffer.Get());
+  // A newer update replaces any held back one.
+  m_pending_updates.erase(update.Universe());
+  SendUpdate(update.Universe(), update.Priority(), update.Buffer(),
+             &update.Message());
+  return true;
+}
 
-  m_client_stub->UpdateDmxData(
-      controller,
-      &dmx_data,
-      ack,
-      ola::NewSingleCallback(this, &ola::Client::SendDMXCallback,
-                             controller, ack));
+bool Client::SendRDMPolledValues(const ola::proto::RDMPolledValues &values) {
+  if (!m_client_stub.get()) {
+    OLA_FATAL << "client_stub is null";
+    return false;
+  }
+
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *ack = new ola::proto::Ack();
+  m_client_stub->UpdateRDMPolledValues(
+      controller, &values, ack,
+      NewSingleCallback(&RDMPolledValuesSent, controller, ack));
   return true;
 }
 
 void Client::DMXReceived(unsigned int universe, const DmxSource &source) {
-  STLReplace(&m_data_map, universe, source);
+  m_data_map[universe] = source;
 }
 
 const DmxSource Client::SourceData(unsigned int universe) const {
-  map<unsigned int, DmxSource>::const_iterator iter =
-    m_data_map.find(universe);
-
-  if (iter != m_data_map.end()) {
-    return iter->second;
-  } else {
-    DmxSource source;
-    return source;
-  }
+  const DmxSource *source = FindSourceData(universe);
+  return source ? *source : DmxSource();
+}
+
+const DmxSource *Client::FindSourceData(unsigned int universe) const {
+  return STLFind(&m_data_map, universe);
 }
 
 ola::rdm::UID Client::GetUID() const {
@@ -92,13 +139,88 @@ void Client::SetUID(const ola::rdm::UID &uid) {
   m_uid = uid;
 }
 
+/*
+ * Send an update to the client.
+ * @param shared_message if not NULL, the full frame for the update as a
+ *   DmxData message. This is used unless a delta is sent.
+ */
+void Client::SendUpdate(unsigned int universe, uint8_t priority,
+                        const DmxBuffer &buffer,
+                        const ola::proto::DmxData *shared_message) {
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *ack = new ola::proto::Ack();
+  ola::proto::DmxData dmx_data;
+
+  bool sent_delta = false;
+  if (m_delta_encoding) {
+    DmxBuffer *base = STLFind(&m_sent_frames, universe);
+    if (base) {
+      uint8_t delta[DMX_UNIVERSE_SIZE];
+      unsigned int delta_size = buffer.Size();
+      // Encode fails if the delta would be larger than the frame itself.
+      if (m_encoder.EncodeDelta(*base, buffer, delta, &delta_size) &&
+          delta_size < buffer.Size()) {
+        dmx_data.set_delta(delta, delta_size);
+        sent_delta = true;
+      }
+      base->Set(buffer);
+    } else {
+      m_sent_frames[universe] = buffer;
+    }
+  }
+
+  if (sent_delta || !shared_message) {
+    dmx_data.set_priority(priority);
+    dmx_data.set_universe(universe);
+    // data is required, so it's set to empty when sending a delta.
+    dmx_data.set_data(sent_delta ? "" : buffer.Get());
+    shared_message = &dmx_data;
+  }
+
+  m_outstanding_updates++;
+  m_client_stub->UpdateDmxData(
+      controller,
+      shared_message,
+      ack,
+      ola::NewSingleCallback(this, &ola::Client::SendDMXCallback,
+                             universe, controller, ack));
+}
+
+void Client::SetDeltaEncoding(bool enable) {
+  m_delta_encoding = enable;
+  if (!enable) {
+    m_sent_frames.clear();
+  }
+}
+
 /*
  * Called when UpdateDmxData completes.
  */
-void Client::SendDMXCallback(RpcController *controller,
+void Client::SendDMXCallback(unsigned int universe,
+                             RpcController *controller,
                              ola::proto::Ack *reply) {
+  if (controller->Failed()) {
+    // The client may have lost the frame the delta was based on, send the
+    // next frame in full.
+    m_sent_frames.erase(universe);
+  }
   delete controller;
   delete reply;
+
+  if (m_outstanding_updates) {
+    m_outstanding_updates--;
+  }
+
+  // Send the held back updates, as long as the client keeps up.
+  while (!m_pending_updates.empty() &&
+         m_outstanding_updates < MAX_OUTSTANDING_UPDATES) {
+    std::map<unsigned int, PendingUpdate>::iterator iter =
+        m_pending_updates.begin();
+    const unsigned int pending_universe = iter->first;
+    const PendingUpdate update = iter->second;
+    m_pending_updates.erase(iter);
+    SendUpdate(pending_universe, update.priority, update.buffer, NULL);
+  }
 }
 
 
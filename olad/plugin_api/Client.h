@@ -21,22 +21,61 @@
 #ifndef OLAD_PLUGIN_API_CLIENT_H_
 #define OLAD_PLUGIN_API_CLIENT_H_
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include <map>
 #include <memory>
 #include "common/rpc/RpcController.h"
+#include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/RunLengthEncoder.h"
 #include "ola/rdm/UID.h"
 #include "olad/DmxSource.h"
 
+#include HASH_MAP_H
+
 namespace ola {
 namespace proto {
 class OlaClientService_Stub;
 class Ack;
+class DmxData;
+class RDMPolledValues;
 }
 }
 
 namespace ola {
 
+/**
+ * @brief A DMX update for a universe, shared by all the sink clients.
+ *
+ * The DmxData message is built the first time it's needed, so when many
+ * clients are registered for a universe it's only built once per update.
+ */
+class DmxUpdate {
+ public:
+  DmxUpdate(unsigned int universe, uint8_t priority, const DmxBuffer &buffer);
+  ~DmxUpdate();
+
+  unsigned int Universe() const { return m_universe; }
+  uint8_t Priority() const { return m_priority; }
+  const DmxBuffer &Buffer() const { return m_buffer; }
+
+  /**
+   * @brief The update as a DmxData message.
+   */
+  const ola::proto::DmxData &Message() const;
+
+ private:
+  const unsigned int m_universe;
+  const uint8_t m_priority;
+  const DmxBuffer &m_buffer;
+  mutable std::auto_ptr<ola::proto::DmxData> m_message;
+
+  DISALLOW_COPY_AND_ASSIGN(DmxUpdate);
+};
+
 /**
  * @brief Represents a connected OLA client on the OLA server side.
  *
@@ -62,10 +101,30 @@ class Client {
    * @param universe_id the universe the DMX data belongs to
    * @param priority the priority of the DMX data
    * @param buffer the DMX data.
+   * @return true if the update was sent or queued, false otherwise
+   */
+  bool SendDMX(unsigned int universe_id, uint8_t priority,
+               const DmxBuffer &buffer);
+
+  /**
+   * @brief Push a DMX update to this client.
+   * @param update the DMX update.
+   * @return true if the update was sent or queued, false otherwise
+   *
+   * If the client hasn't acknowledged the previous updates, the update is
+   * held back until it does. Only the latest held back update for each
+   * universe is sent, so a slow client receives fewer updates rather than
+   * causing them to build up in olad.
+   */
+  virtual bool SendDMX(const DmxUpdate &update);
+
+  /**
+   * @brief Push the RDM values that olad polled, and which have changed, to
+   *   this client.
+   * @param values the changed values.
    * @return true if the update was sent, false otherwise
    */
-  virtual bool SendDMX(unsigned int universe_id, uint8_t priority,
-                       const DmxBuffer &buffer);
+  virtual bool SendRDMPolledValues(const ola::proto::RDMPolledValues &values);
 
   /**
    * @brief Called when this client sends us new data
@@ -80,6 +139,24 @@ class Client {
    */
   const DmxSource SourceData(unsigned int universe) const;
 
+  /**
+   * @brief Find the most recent DMX data received from this client.
+   * @param universe the id of the universe we're interested in
+   * @returns the data, or NULL if the client hasn't sent any data for the
+   *   universe. Once returned, the pointer remains valid, and reflects later
+   *   updates, for the life of the client.
+   */
+  const DmxSource *FindSourceData(unsigned int universe) const;
+
+  /**
+   * @brief Allow DMX updates to be sent to this client as deltas.
+   * @param enable true if the client can decode delta frames.
+   *
+   * Once enabled, only the slots that changed since the previous update for
+   * a universe are sent, provided that's smaller than the full frame.
+   */
+  void SetDeltaEncoding(bool enable);
+
   /**
    * @brief Return the UID associated with this client.
    * @returns The client's UID.
@@ -96,12 +173,41 @@ class Client {
   void SetUID(const ola::rdm::UID &uid);
 
  private:
-  void SendDMXCallback(ola::rpc::RpcController *controller,
+  class PendingUpdate {
+   public:
+    PendingUpdate(uint8_t priority, const DmxBuffer &buffer)
+        : priority(priority),
+          buffer(buffer) {
+    }
+
+    uint8_t priority;
+    DmxBuffer buffer;
+  };
+
+  // The data from this client for each universe. Entries are never removed,
+  // so the universes can hold pointers to them, see FindSourceData().
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<unsigned int, DmxSource> SourceMap;
+
+  void SendUpdate(unsigned int universe, uint8_t priority,
+                  const DmxBuffer &buffer,
+                  const ola::proto::DmxData *shared_message);
+  void SendDMXCallback(unsigned int universe,
+                       ola::rpc::RpcController *controller,
                        ola::proto::Ack *ack);
 
   std::auto_ptr<class ola::proto::OlaClientService_Stub> m_client_stub;
-  std::map<unsigned int, DmxSource> m_data_map;
+  SourceMap m_data_map;
   ola::rdm::UID m_uid;
+  bool m_delta_encoding;
+  // The last frame sent to the client for each universe.
+  std::map<unsigned int, DmxBuffer> m_sent_frames;
+  ola::dmx::RunLengthEncoder m_encoder;
+  // The number of updates the client hasn't acknowledged yet.
+  unsigned int m_outstanding_updates;
+  // The latest held back update for each universe.
+  std::map<unsigned int, PendingUpdate> m_pending_updates;
+
+  static const unsigned int MAX_OUTSTANDING_UPDATES = 4;
 
   DISALLOW_COPY_AND_ASSIGN(Client);
 };
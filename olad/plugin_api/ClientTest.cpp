@@ -20,6 +20,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
@@ -28,6 +29,7 @@
 #include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/dmx/RunLengthEncoder.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "olad/DmxSource.h"
@@ -41,18 +43,26 @@ static const char TEST_DATA2[] = "another set of test data";
 
 using ola::Client;
 using ola::DmxBuffer;
+using ola::DmxUpdate;
 using std::string;
+using std::vector;
 
 class ClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ClientTest);
   CPPUNIT_TEST(testSendDMX);
   CPPUNIT_TEST(testGetSetDMX);
+  CPPUNIT_TEST(testSendDelta);
+  CPPUNIT_TEST(testSharedUpdate);
+  CPPUNIT_TEST(testSlowClient);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   ClientTest() : m_test_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {}
   void testSendDMX();
   void testGetSetDMX();
+  void testSendDelta();
+  void testSharedUpdate();
+  void testSlowClient();
 
  private:
   ola::Clock m_clock;
@@ -87,6 +97,69 @@ void MockClientStub::UpdateDmxData(
   done->Run();
 }
 
+/*
+ * A ClientStub that records the updates it receives.
+ */
+class DeltaClientStub: public ola::proto::OlaClientService_Stub {
+ public:
+  DeltaClientStub()
+      : ola::proto::OlaClientService_Stub(NULL),
+        fail(false) {
+  }
+
+  void UpdateDmxData(ola::rpc::RpcController *controller,
+                     const ola::proto::DmxData *request,
+                     ola::proto::Ack *response,
+                     ola::rpc::RpcService::CompletionCallback *done);
+
+  bool fail;
+  ola::proto::DmxData last_update;
+};
+
+void DeltaClientStub::UpdateDmxData(
+    ola::rpc::RpcController* controller,
+    const ola::proto::DmxData *request,
+    OLA_UNUSED ola::proto::Ack *response,
+    ola::rpc::RpcService::CompletionCallback *done) {
+  last_update.CopyFrom(*request);
+  if (fail) {
+    controller->SetFailed("missing base frame");
+  }
+  done->Run();
+}
+
+/*
+ * A ClientStub that doesn't complete the updates until told to.
+ */
+class SlowClientStub: public ola::proto::OlaClientService_Stub {
+ public:
+  SlowClientStub() : ola::proto::OlaClientService_Stub(NULL) {}
+
+  void UpdateDmxData(ola::rpc::RpcController*,
+                     const ola::proto::DmxData *request,
+                     ola::proto::Ack*,
+                     ola::rpc::RpcService::CompletionCallback *done) {
+    requests.push_back(request);
+    updates.push_back(*request);
+    m_callbacks.push_back(done);
+  }
+
+  void CompleteUpdates() {
+    vector<ola::rpc::RpcService::CompletionCallback*> callbacks;
+    callbacks.swap(m_callbacks);
+    vector<ola::rpc::RpcService::CompletionCallback*>::iterator iter;
+    for (iter = callbacks.begin(); iter != callbacks.end(); ++iter) {
+      (*iter)->Run();
+    }
+  }
+
+  vector<const ola::proto::DmxData*> requests;
+  vector<ola::proto::DmxData> updates;
+
+ private:
+  vector<ola::rpc::RpcService::CompletionCallback*> m_callbacks;
+};
+
 /*
  * Check that the SendDMX method works correctly.
  */
@@ -141,4 +214,138 @@ void ClientTest::testGetSetDMX() {
   const ola::DmxSource source4 = client.SourceData(TEST_UNIVERSE2);
   OLA_ASSERT_FALSE(source4.IsSet());
   OLA_ASSERT_DMX_EQUALS(empty, source4.Data());
+
+  // the pointer from FindSourceData() tracks later updates
+  const ola::DmxSource *source5 = client.FindSourceData(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(source5);
+  OLA_ASSERT_EQ((uint8_t) 120, source5->Priority());
+  client.DMXReceived(TEST_UNIVERSE2, source);
+  source.UpdateData(buffer, timestamp, 140);
+  client.DMXReceived(TEST_UNIVERSE, source);
+  OLA_ASSERT_EQ(source5, client.FindSourceData(TEST_UNIVERSE));
+  OLA_ASSERT_EQ((uint8_t) 140, source5->Priority());
+  OLA_ASSERT_NULL(client.FindSourceData(TEST_UNIVERSE2 + 1));
+}
+
+
+/*
+ * Check that updates are sent as deltas once enabled.
+ */
+void ClientTest::testSendDelta() {
+  DeltaClientStub *stub = new DeltaClientStub();
+  Client client(stub, m_test_uid);
+  ola::dmx::RunLengthEncoder encoder;
+
+  DmxBuffer frame1;
+  frame1.Blackout();
+  DmxBuffer frame2(frame1);
+  frame2.SetChannel(100, 255);
+
+  // Deltas are off by default
+  client.SendDMX(TEST_UNIVERSE, 100, frame1);
+  client.SendDMX(TEST_UNIVERSE, 100, frame2);
+  OLA_ASSERT_FALSE(stub->last_update.has_delta());
+  OLA_ASSERT(frame2.Get() == stub->last_update.data());
+
+  // The first frame is always sent in full
+  client.SetDeltaEncoding(true);
+  client.SendDMX(TEST_UNIVERSE, 100, frame1);
+  OLA_ASSERT_FALSE(stub->last_update.has_delta());
+  OLA_ASSERT(frame1.Get() == stub->last_update.data());
+
+  client.SendDMX(TEST_UNIVERSE, 100, frame2);
+  OLA_ASSERT_TRUE(stub->last_update.has_delta());
+  OLA_ASSERT_TRUE(stub->last_update.data().empty());
+  OLA_ASSERT_LT(stub->last_update.delta().size(), 20u);
+  const string &delta = stub->last_update.delta();
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(encoder.DecodeDelta(
+      frame1, reinterpret_cast<const uint8_t*>(delta.data()), delta.size(),
+      &output));
+  OLA_ASSERT_DMX_EQUALS(frame2, output);
+
+  // Other universes have their own base frame.
+  client.SendDMX(TEST_UNIVERSE2, 100, frame2);
+  OLA_ASSERT_FALSE(stub->last_update.has_delta());
+
+  // A failed update means the next frame is sent in full.
+  stub->fail = true;
+  client.SendDMX(TEST_UNIVERSE, 100, frame1);
+  OLA_ASSERT_TRUE(stub->last_update.has_delta());
+  stub->fail = false;
+  client.SendDMX(TEST_UNIVERSE, 100, frame2);
+  OLA_ASSERT_FALSE(stub->last_update.has_delta());
+  OLA_ASSERT(frame2.Get() == stub->last_update.data());
+
+  // A frame that's entirely different is sent in full.
+  DmxBuffer frame3;
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    frame3.SetChannel(i, i);
+  }
+  client.SendDMX(TEST_UNIVERSE, 100, frame3);
+  OLA_ASSERT_FALSE(stub->last_update.has_delta());
+  OLA_ASSERT(frame3.Get() == stub->last_update.data());
+}
+
+
+/*
+ * Check that the clients share the message for an update.
+ */
+void ClientTest::testSharedUpdate() {
+  SlowClientStub *stub1 = new SlowClientStub();
+  SlowClientStub *stub2 = new SlowClientStub();
+  Client client1(stub1, m_test_uid);
+  Client client2(stub2, m_test_uid);
+
+  const DmxBuffer buffer(TEST_DATA);
+  const DmxUpdate update(TEST_UNIVERSE, 100, buffer);
+  OLA_ASSERT_TRUE(client1.SendDMX(update));
+  OLA_ASSERT_TRUE(client2.SendDMX(update));
+
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub1->requests.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub2->requests.size());
+  OLA_ASSERT_EQ(stub1->requests[0], stub2->requests[0]);
+  OLA_ASSERT_EQ(stub1->requests[0], &update.Message());
+  OLA_ASSERT_EQ(TEST_UNIVERSE,
+                static_cast<unsigned int>(update.Message().universe()));
+  OLA_ASSERT_EQ(100, update.Message().priority());
+  OLA_ASSERT(buffer.Get() == update.Message().data());
+
+  stub1->CompleteUpdates();
+  stub2->CompleteUpdates();
+}
+
+/*
+ * Check that updates to a slow client are held back and coalesced.
+ */
+void ClientTest::testSlowClient() {
+  SlowClientStub *stub = new SlowClientStub();
+  Client client(stub, m_test_uid);
+
+  DmxBuffer buffer;
+  for (unsigned int i = 0; i < 10; i++) {
+    buffer.SetChannel(0, i);
+    OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, buffer));
+    OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE2, 100, buffer));
+  }
+
+  // Only the first updates are sent until the client catches up.
+  OLA_ASSERT_EQ(static_cast<size_t>(4), stub->updates.size());
+
+  // Then only the latest update for each universe is sent.
+  stub->CompleteUpdates();
+  OLA_ASSERT_EQ(static_cast<size_t>(6), stub->updates.size());
+  OLA_ASSERT_EQ(TEST_UNIVERSE,
+                static_cast<unsigned int>(stub->updates[4].universe()));
+  OLA_ASSERT(buffer.Get() == stub->updates[4].data());
+  OLA_ASSERT_EQ(TEST_UNIVERSE2,
+                static_cast<unsigned int>(stub->updates[5].universe()));
+  OLA_ASSERT(buffer.Get() == stub->updates[5].data());
+
+  stub->CompleteUpdates();
+  OLA_ASSERT_EQ(static_cast<size_t>(6), stub->updates.size());
+
+  // Once caught up, updates are sent straight away.
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, buffer));
+  OLA_ASSERT_EQ(static_cast<size_t>(7), stub->updates.size());
 }
@@ -34,6 +34,7 @@
 #include "olad/Plugin.h"
 #include "olad/Port.h"
 #include "olad/Universe.h"
+#include "olad/plugin_api/PluginThread.h"
 
 namespace ola {
 
@@ -51,6 +52,7 @@ Device::Device(AbstractPlugin *owner, const string &name)
     : AbstractDevice(),
       m_enabled(false),
       m_owner(owner),
+      m_plugin_thread(PluginThread::Current()),
       m_name(name) {
 }
 
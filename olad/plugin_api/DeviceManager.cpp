@@ -32,6 +32,7 @@
 #include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/Port.h"
+#include "olad/plugin_api/PluginThread.h"
 #include "olad/plugin_api/PortManager.h"
 
 namespace ola {
@@ -57,7 +58,8 @@ DeviceManager::DeviceManager(PreferencesFactory *prefs_factory,
                              PortManager *port_manager)
     : m_port_preferences(NULL),
       m_port_manager(port_manager),
-      m_next_device_alias(FIRST_DEVICE_ALIAS) {
+      m_next_device_alias(FIRST_DEVICE_ALIAS),
+      m_generation(0) {
   if (prefs_factory) {
     m_port_preferences = prefs_factory->NewPreference(PORT_PREFERENCES);
     m_port_preferences->Load();
@@ -102,6 +104,7 @@ bool DeviceManager::RegisterDevice(AbstractDevice *device) {
   }
 
   STLReplace(&m_alias_map, alias, device);
+  m_generation++;
   OLA_INFO << "Installed device: " << device->Name() << ":"
            << device->UniqueId();
 
@@ -135,6 +138,7 @@ bool DeviceManager::UnregisterDevice(const string &device_id) {
   STLRemove(&m_alias_map, pair->alias);
 
   pair->device = NULL;
+  m_generation++;
   return true;
 }
 
@@ -186,15 +190,37 @@ void DeviceManager::UnregisterAllDevices() {
     iter->second.device = NULL;
   }
   m_alias_map.clear();
+  m_generation++;
 }
 
 void DeviceManager::SendTimeCode(const ola::timecode::TimeCode &timecode) {
   set<OutputPort*>::iterator iter = m_timecode_ports.begin();
   for (; iter != m_timecode_ports.end(); iter++) {
-    (*iter)->SendTimeCode(timecode);
+    DispatchSendTimeCode(*iter, timecode);
   }
 }
 
+void DeviceManager::SavePortSettings(const vector<InputPort*> &input_ports,
+                                     const vector<OutputPort*> &output_ports) {
+  if (!m_port_preferences) {
+    return;
+  }
+
+  SavePortPatchings(input_ports);
+  SavePortPatchings(output_ports);
+
+  vector<InputPort*>::const_iterator input_iter = input_ports.begin();
+  for (; input_iter != input_ports.end(); ++input_iter) {
+    SavePortPriority(**input_iter);
+  }
+
+  vector<OutputPort*>::const_iterator output_iter = output_ports.begin();
+  for (; output_iter != output_ports.end(); ++output_iter) {
+    SavePortPriority(**output_iter);
+  }
+  m_port_preferences->Save();
+}
+
 /*
  * Save the port universe patchings for a device
  * @param device the device to save the settings for
@@ -21,6 +21,7 @@
 #ifndef OLAD_PLUGIN_API_DEVICEMANAGER_H_
 #define OLAD_PLUGIN_API_DEVICEMANAGER_H_
 
+#include <stdint.h>
 #include <map>
 #include <set>
 #include <string>
@@ -128,6 +129,21 @@ class DeviceManager {
    */
   void UnregisterAllDevices();
 
+  /**
+   * @brief The generation of the devices, this is incremented when a device
+   * is registered or unregistered.
+   */
+  uint32_t Generation() const { return m_generation; }
+
+  /**
+   * @brief Save the patching and priority settings of some ports.
+   *
+   * The preferences are written once, rather than once per port.
+   * @param input_ports the input ports to save.
+   * @param output_ports the output ports to save.
+   */
+  void SavePortSettings(const std::vector<InputPort*> &input_ports,
+                        const std::vector<OutputPort*> &output_ports);
 
   /**
    * @brief Send timecode to all ports which support timecode.
@@ -149,6 +165,7 @@ class DeviceManager {
 
   unsigned int m_next_device_alias;
   std::set<class OutputPort*> m_timecode_ports;
+  uint32_t m_generation;
 
   void ReleaseDevice(const AbstractDevice *device);
   void RestoreDevicePortSettings(AbstractDevice *device);
@@ -0,0 +1,219 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DiscoveryScheduler.cpp
+ * Limits the number of ports running RDM discovery at once.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/DiscoveryScheduler.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Port.h"
+#include "olad/plugin_api/PluginThread.h"
+
+namespace ola {
+
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::UIDSet;
+using std::string;
+using std::vector;
+
+const char DiscoveryScheduler::K_DISCOVERY_DURATION_VAR[] =
+    "rdm-discovery-duration-ms";
+const char DiscoveryScheduler::K_DISCOVERY_QUEUED_VAR[] =
+    "rdm-discovery-queued";
+const char DiscoveryScheduler::K_DISCOVERY_RUNNING_VAR[] =
+    "rdm-discovery-running";
+const char DiscoveryScheduler::K_DISCOVERY_RUNS_VAR[] = "rdm-discovery-runs";
+const char DiscoveryScheduler::K_DISCOVERY_WAIT_VAR[] = "rdm-discovery-wait-ms";
+
+DiscoveryScheduler::DiscoveryScheduler(ExportMap *export_map,
+                                       Clock *clock,
+                                       unsigned int max_running)
+    : m_export_map(export_map),
+      m_clock(clock),
+      m_max_running(max_running),
+      m_running(0),
+      m_starting(false) {
+  if (m_export_map) {
+    m_export_map->GetUIntMapVar(K_DISCOVERY_DURATION_VAR, "port");
+    m_export_map->GetUIntMapVar(K_DISCOVERY_WAIT_VAR, "port");
+    m_export_map->GetCounterVar(K_DISCOVERY_RUNS_VAR);
+    UpdateCounts();
+  }
+}
+
+DiscoveryScheduler::~DiscoveryScheduler() {
+  PortStateMap::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    STLDeleteElements(&iter->second->pending_callbacks);
+    if (iter->second->running) {
+      OLA_WARN << "Discovery still running on port "
+               << iter->first->UniqueId();
+    }
+  }
+  STLDeleteValues(&m_ports);
+}
+
+void DiscoveryScheduler::RunDiscovery(OutputPort *port,
+                                      RDMDiscoveryCallback *callback,
+                                      bool full) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  if (!state) {
+    state = new PortState();
+    STLReplace(&m_ports, port, state);
+  }
+
+  state->full |= full;
+  state->pending_callbacks.push_back(callback);
+  if (!state->queued) {
+    state->queued = true;
+    m_clock->CurrentMonotonicTime(&state->queued_time);
+    if (!state->running) {
+      m_ready.push_back(port);
+    }
+  }
+  StartDiscovery();
+  UpdateCounts();
+}
+
+void DiscoveryScheduler::CancelPort(OutputPort *port) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  if (!state || !state->queued) {
+    return;
+  }
+
+  CallbackList callbacks;
+  callbacks.swap(state->pending_callbacks);
+  state->queued = false;
+  state->full = false;
+  if (!state->running) {
+    m_ready.erase(std::remove(m_ready.begin(), m_ready.end(), port),
+                  m_ready.end());
+    STLRemoveAndDelete(&m_ports, port);
+  }
+  UpdateCounts();
+  RunCallbacks(callbacks, UIDSet());
+}
+
+void DiscoveryScheduler::SetMaxRunning(unsigned int max_running) {
+  m_max_running = max_running;
+  StartDiscovery();
+  UpdateCounts();
+}
+
+/*
+ * Start discovery on as many of the ready ports as the limit allows.
+ */
+void DiscoveryScheduler::StartDiscovery() {
+  // Ports may complete discovery synchronously, in which case
+  // DiscoveryComplete() calls back into here. Let the outer call do the work
+  // so the stack doesn't grow with the number of ports.
+  if (m_starting) {
+    return;
+  }
+  m_starting = true;
+
+  while (!m_ready.empty() && (m_max_running == 0 ||
+                              m_running < m_max_running)) {
+    OutputPort *port = m_ready.front();
+    m_ready.pop_front();
+    PortState *state = m_ports[port];
+
+    state->running = true;
+    state->queued = false;
+    state->running_callbacks.swap(state->pending_callbacks);
+    bool full = state->full;
+    state->full = false;
+    m_clock->CurrentMonotonicTime(&state->start_time);
+    m_running++;
+
+    if (m_export_map) {
+      const string port_id = port->UniqueId();
+      if (!port_id.empty()) {
+        (*m_export_map->GetUIntMapVar(K_DISCOVERY_WAIT_VAR))[port_id] =
+            (state->start_time - state->queued_time).InMilliSeconds();
+      }
+      (*m_export_map->GetCounterVar(K_DISCOVERY_RUNS_VAR))++;
+    }
+
+    DispatchRDMDiscovery(
+        port,
+        NewSingleCallback(this, &DiscoveryScheduler::DiscoveryComplete, port),
+        full);
+  }
+  m_starting = false;
+}
+
+void DiscoveryScheduler::DiscoveryComplete(OutputPort *port,
+                                           const UIDSet &uids) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  if (!state || !state->running) {
+    OLA_WARN << "Discovery completed on a port that wasn't running it";
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  if (m_export_map) {
+    const string port_id = port->UniqueId();
+    if (!port_id.empty()) {
+      (*m_export_map->GetUIntMapVar(K_DISCOVERY_DURATION_VAR))[port_id] =
+          (now - state->start_time).InMilliSeconds();
+    }
+  }
+
+  CallbackList callbacks;
+  callbacks.swap(state->running_callbacks);
+  state->running = false;
+  m_running--;
+
+  if (state->queued) {
+    // Requests that arrived while discovery was running go to the back of the
+    // queue.
+    m_ready.push_back(port);
+  } else {
+    STLRemoveAndDelete(&m_ports, port);
+  }
+
+  RunCallbacks(callbacks, uids);
+  StartDiscovery();
+  UpdateCounts();
+}
+
+void DiscoveryScheduler::UpdateCounts() {
+  if (m_export_map) {
+    m_export_map->GetIntegerVar(K_DISCOVERY_RUNNING_VAR)->Set(m_running);
+    m_export_map->GetIntegerVar(K_DISCOVERY_QUEUED_VAR)->Set(m_ready.size());
+  }
+}
+
+void DiscoveryScheduler::RunCallbacks(const CallbackList &callbacks,
+                                      const UIDSet &uids) {
+  CallbackList::const_iterator iter = callbacks.begin();
+  for (; iter != callbacks.end(); ++iter) {
+    (*iter)->Run(uids);
+  }
+}
+}  // namespace ola
@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DiscoveryScheduler.h
+ * Limits the number of ports running RDM discovery at once.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_DISCOVERYSCHEDULER_H_
+#define OLAD_PLUGIN_API_DISCOVERYSCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UIDSet.h"
+
+namespace ola {
+
+class ExportMap;
+class OutputPort;
+
+/**
+ * @brief Runs RDM discovery on output ports, across all universes.
+ *
+ * Discovery requests are queued per port. At most max_running ports run
+ * discovery at once; the rest wait in the order they were requested. A port
+ * has at most one queued run, further requests for the same port are folded
+ * into it, so a port that is asked to run discovery repeatedly can't hold up
+ * the others.
+ *
+ * Ports that belong to a plugin thread run discovery on that thread, so with
+ * a limit greater than one, ports on different threads run in parallel.
+ */
+class DiscoveryScheduler {
+ public:
+  /**
+   * @brief Create a new DiscoveryScheduler.
+   * @param export_map the ExportMap to use for stats, may be NULL.
+   * @param clock the clock used to time discovery.
+   * @param max_running the maximum number of ports to run discovery on at
+   *   once, 0 means no limit.
+   */
+  DiscoveryScheduler(ExportMap *export_map, Clock *clock,
+                     unsigned int max_running = 0);
+
+  /**
+   * @brief Destructor.
+   *
+   * Callbacks for runs that haven't started are deleted without being run.
+   */
+  ~DiscoveryScheduler();
+
+  /**
+   * @brief Run discovery on a port.
+   * @param port the port to run discovery on.
+   * @param callback run when discovery completes.
+   * @param full true for full discovery, false for incremental.
+   *
+   * If the port already has a queued run, the request is merged with it and
+   * both callbacks are run with the same result. A full request upgrades a
+   * queued incremental one.
+   */
+  void RunDiscovery(OutputPort *port,
+                    ola::rdm::RDMDiscoveryCallback *callback,
+                    bool full);
+
+  /**
+   * @brief Drop the queued run for a port.
+   *
+   * Called when a port is removed from a universe. The callbacks for the
+   * queued run are run with an empty UIDSet. If discovery is already running
+   * on the port, that run completes as normal.
+   */
+  void CancelPort(OutputPort *port);
+
+  /**
+   * @brief Change the maximum number of ports that run discovery at once.
+   * @param max_running the new limit, 0 means no limit.
+   */
+  void SetMaxRunning(unsigned int max_running);
+  unsigned int MaxRunning() const { return m_max_running; }
+
+  /**
+   * @brief The number of ports currently running discovery.
+   */
+  unsigned int RunningCount() const { return m_running; }
+
+  /**
+   * @brief The number of ports waiting for a free slot.
+   *
+   * This doesn't include ports that are running discovery and have another
+   * run queued.
+   */
+  unsigned int QueuedCount() const { return m_ready.size(); }
+
+  static const char K_DISCOVERY_DURATION_VAR[];
+  static const char K_DISCOVERY_QUEUED_VAR[];
+  static const char K_DISCOVERY_RUNNING_VAR[];
+  static const char K_DISCOVERY_RUNS_VAR[];
+  static const char K_DISCOVERY_WAIT_VAR[];
+
+ private:
+  typedef std::vector<ola::rdm::RDMDiscoveryCallback*> CallbackList;
+
+  struct PortState {
+    PortState() : running(false), queued(false), full(false) {}
+
+    // True if discovery is running on the port.
+    bool running;
+    // True if the port is in m_ready.
+    bool queued;
+    // The next run.
+    bool full;
+    CallbackList pending_callbacks;
+    TimeStamp queued_time;
+    // The current run.
+    CallbackList running_callbacks;
+    TimeStamp start_time;
+  };
+
+  typedef std::map<OutputPort*, PortState*> PortStateMap;
+
+  ExportMap *m_export_map;
+  Clock *m_clock;
+  unsigned int m_max_running;
+  unsigned int m_running;
+  bool m_starting;
+  PortStateMap m_ports;
+  std::deque<OutputPort*> m_ready;
+
+  void StartDiscovery();
+  void DiscoveryComplete(OutputPort *port, const ola::rdm::UIDSet &uids);
+  void UpdateCounts();
+
+  static void RunCallbacks(const CallbackList &callbacks,
+                           const ola::rdm::UIDSet &uids);
+
+  DISALLOW_COPY_AND_ASSIGN(DiscoveryScheduler);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_DISCOVERYSCHEDULER_H_
@@ -0,0 +1,369 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DiscoverySchedulerTest.cpp
+ * Test fixture for the DiscoveryScheduler class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/DiscoveryScheduler.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::DiscoveryScheduler;
+using ola::ExportMap;
+using ola::NewSingleCallback;
+using ola::Universe;
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+using std::vector;
+
+/*
+ * An RDM port that holds on to the discovery callback until Complete() is
+ * called.
+ */
+class DeferredDiscoveryPort: public TestMockOutputPort {
+ public:
+  DeferredDiscoveryPort(unsigned int port_id, const UID &uid)
+      : TestMockOutputPort(NULL, port_id, false, true),
+        m_full_runs(0),
+        m_incremental_runs(0) {
+    m_uids.AddUID(uid);
+  }
+
+  ~DeferredDiscoveryPort() {
+    ola::STLDeleteElements(&m_callbacks);
+  }
+
+  void SendRDMRequest(ola::rdm::RDMRequest *request,
+                      ola::rdm::RDMCallback *callback) {
+    delete request;
+    RunRDMCallback(callback, ola::rdm::RDM_FAILED_TO_SEND);
+  }
+
+  void RunFullDiscovery(RDMDiscoveryCallback *on_complete) {
+    m_full_runs++;
+    m_callbacks.push_back(on_complete);
+  }
+
+  void RunIncrementalDiscovery(RDMDiscoveryCallback *on_complete) {
+    m_incremental_runs++;
+    m_callbacks.push_back(on_complete);
+  }
+
+  bool IsRunning() const { return !m_callbacks.empty(); }
+  unsigned int FullRuns() const { return m_full_runs; }
+  unsigned int IncrementalRuns() const { return m_incremental_runs; }
+
+  void Complete() {
+    OLA_ASSERT_EQ(static_cast<size_t>(1), m_callbacks.size());
+    RDMDiscoveryCallback *callback = m_callbacks.back();
+    m_callbacks.pop_back();
+    callback->Run(m_uids);
+  }
+
+ private:
+  UIDSet m_uids;
+  vector<RDMDiscoveryCallback*> m_callbacks;
+  unsigned int m_full_runs;
+  unsigned int m_incremental_runs;
+};
+
+
+class DiscoverySchedulerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DiscoverySchedulerTest);
+  CPPUNIT_TEST(testUnlimited);
+  CPPUNIT_TEST(testLimit);
+  CPPUNIT_TEST(testMergeRequests);
+  CPPUNIT_TEST(testCancelPort);
+  CPPUNIT_TEST(testSynchronousPorts);
+  CPPUNIT_TEST(testUniverse);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testUnlimited();
+  void testLimit();
+  void testMergeRequests();
+  void testCancelPort();
+  void testSynchronousPorts();
+  void testUniverse();
+
+ private:
+  Clock m_clock;
+  ExportMap m_export_map;
+  vector<DeferredDiscoveryPort*> m_ports;
+  unsigned int m_callbacks_run;
+  unsigned int m_uids_found;
+
+  RDMDiscoveryCallback *NewDiscoveryCallback() {
+    return NewSingleCallback(this, &DiscoverySchedulerTest::DiscoveryComplete);
+  }
+
+  void DiscoveryComplete(const UIDSet &uids) {
+    m_callbacks_run++;
+    m_uids_found += uids.Size();
+  }
+
+  int Running() {
+    return m_export_map.GetIntegerVar(
+        DiscoveryScheduler::K_DISCOVERY_RUNNING_VAR)->Get();
+  }
+
+  int Queued() {
+    return m_export_map.GetIntegerVar(
+        DiscoveryScheduler::K_DISCOVERY_QUEUED_VAR)->Get();
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DiscoverySchedulerTest);
+
+
+void DiscoverySchedulerTest::setUp() {
+  for (unsigned int i = 0; i < 4; i++) {
+    m_ports.push_back(new DeferredDiscoveryPort(i, UID(0x7a70, i)));
+  }
+  m_callbacks_run = 0;
+  m_uids_found = 0;
+}
+
+
+void DiscoverySchedulerTest::tearDown() {
+  ola::STLDeleteElements(&m_ports);
+}
+
+
+/*
+ * With no limit, all ports start at once.
+ */
+void DiscoverySchedulerTest::testUnlimited() {
+  DiscoveryScheduler scheduler(&m_export_map, &m_clock);
+
+  for (unsigned int i = 0; i < m_ports.size(); i++) {
+    scheduler.RunDiscovery(m_ports[i], NewDiscoveryCallback(), true);
+  }
+  OLA_ASSERT_EQ(4u, scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, scheduler.QueuedCount());
+  OLA_ASSERT_EQ(4, Running());
+
+  for (unsigned int i = 0; i < m_ports.size(); i++) {
+    OLA_ASSERT_TRUE(m_ports[i]->IsRunning());
+    m_ports[i]->Complete();
+  }
+  OLA_ASSERT_EQ(0u, scheduler.RunningCount());
+  OLA_ASSERT_EQ(4u, m_callbacks_run);
+  OLA_ASSERT_EQ(4u, m_uids_found);
+  OLA_ASSERT_EQ(4u, m_export_map.GetCounterVar(
+      DiscoveryScheduler::K_DISCOVERY_RUNS_VAR)->Get());
+}
+
+
+/*
+ * Check the limit is applied, and ports start in the order they were
+ * requested.
+ */
+void DiscoverySchedulerTest::testLimit() {
+  DiscoveryScheduler scheduler(&m_export_map, &m_clock, 2);
+
+  for (unsigned int i = 0; i < m_ports.size(); i++) {
+    scheduler.RunDiscovery(m_ports[i], NewDiscoveryCallback(), false);
+  }
+  OLA_ASSERT_EQ(2u, scheduler.RunningCount());
+  OLA_ASSERT_EQ(2u, scheduler.QueuedCount());
+  OLA_ASSERT_EQ(2, Running());
+  OLA_ASSERT_EQ(2, Queued());
+  OLA_ASSERT_TRUE(m_ports[0]->IsRunning());
+  OLA_ASSERT_TRUE(m_ports[1]->IsRunning());
+  OLA_ASSERT_FALSE(m_ports[2]->IsRunning());
+
+  // A port asking again goes behind the ones already waiting.
+  scheduler.RunDiscovery(m_ports[1], NewDiscoveryCallback(), false);
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(1u, m_callbacks_run);
+  OLA_ASSERT_TRUE(m_ports[2]->IsRunning());
+  OLA_ASSERT_FALSE(m_ports[1]->IsRunning());
+
+  m_ports[0]->Complete();
+  OLA_ASSERT_TRUE(m_ports[3]->IsRunning());
+  OLA_ASSERT_FALSE(m_ports[1]->IsRunning());
+
+  m_ports[2]->Complete();
+  OLA_ASSERT_TRUE(m_ports[1]->IsRunning());
+  OLA_ASSERT_EQ(2u, m_ports[1]->IncrementalRuns());
+
+  // Raising the limit doesn't stop anything that's running.
+  scheduler.SetMaxRunning(0);
+  m_ports[1]->Complete();
+  m_ports[3]->Complete();
+  OLA_ASSERT_EQ(5u, m_callbacks_run);
+  OLA_ASSERT_EQ(0u, scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, scheduler.QueuedCount());
+  OLA_ASSERT_EQ(0, Running());
+  OLA_ASSERT_EQ(0, Queued());
+}
+
+
+/*
+ * Requests for a port that's already queued are merged.
+ */
+void DiscoverySchedulerTest::testMergeRequests() {
+  DiscoveryScheduler scheduler(&m_export_map, &m_clock, 1);
+
+  scheduler.RunDiscovery(m_ports[0], NewDiscoveryCallback(), false);
+  scheduler.RunDiscovery(m_ports[1], NewDiscoveryCallback(), false);
+  scheduler.RunDiscovery(m_ports[1], NewDiscoveryCallback(), true);
+  scheduler.RunDiscovery(m_ports[1], NewDiscoveryCallback(), false);
+  OLA_ASSERT_EQ(1u, scheduler.QueuedCount());
+
+  m_ports[0]->Complete();
+  OLA_ASSERT_EQ(1u, m_callbacks_run);
+  OLA_ASSERT_TRUE(m_ports[1]->IsRunning());
+  OLA_ASSERT_EQ(1u, m_ports[1]->FullRuns());
+  OLA_ASSERT_EQ(0u, m_ports[1]->IncrementalRuns());
+
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(4u, m_callbacks_run);
+  OLA_ASSERT_EQ(4u, m_uids_found);
+  OLA_ASSERT_EQ(2u, m_export_map.GetCounterVar(
+      DiscoveryScheduler::K_DISCOVERY_RUNS_VAR)->Get());
+}
+
+
+/*
+ * Check cancelling the queued runs for a port.
+ */
+void DiscoverySchedulerTest::testCancelPort() {
+  DiscoveryScheduler scheduler(&m_export_map, &m_clock, 1);
+
+  scheduler.RunDiscovery(m_ports[0], NewDiscoveryCallback(), true);
+  scheduler.RunDiscovery(m_ports[1], NewDiscoveryCallback(), true);
+  scheduler.RunDiscovery(m_ports[0], NewDiscoveryCallback(), true);
+
+  // The queued run on port 1 is cancelled, the callback runs with no UIDs.
+  scheduler.CancelPort(m_ports[1]);
+  OLA_ASSERT_EQ(1u, m_callbacks_run);
+  OLA_ASSERT_EQ(0u, m_uids_found);
+  OLA_ASSERT_EQ(0u, scheduler.QueuedCount());
+
+  // Port 0 is still running, only the queued run is cancelled.
+  scheduler.CancelPort(m_ports[0]);
+  OLA_ASSERT_EQ(2u, m_callbacks_run);
+  OLA_ASSERT_EQ(0u, scheduler.QueuedCount());
+  OLA_ASSERT_TRUE(m_ports[0]->IsRunning());
+
+  m_ports[0]->Complete();
+  OLA_ASSERT_EQ(3u, m_callbacks_run);
+  OLA_ASSERT_EQ(1u, m_uids_found);
+  OLA_ASSERT_FALSE(m_ports[1]->IsRunning());
+  OLA_ASSERT_EQ(0u, scheduler.RunningCount());
+
+  // Cancelling a port with nothing queued does nothing.
+  scheduler.CancelPort(m_ports[2]);
+  OLA_ASSERT_EQ(3u, m_callbacks_run);
+}
+
+
+/*
+ * Ports that complete discovery straight away.
+ */
+void DiscoverySchedulerTest::testSynchronousPorts() {
+  DiscoveryScheduler scheduler(&m_export_map, &m_clock, 1);
+
+  UIDSet uids;
+  uids.AddUID(UID(0x7a70, 10));
+  vector<TestMockRDMOutputPort*> ports;
+  for (unsigned int i = 0; i < 100; i++) {
+    ports.push_back(new TestMockRDMOutputPort(NULL, i, &uids));
+  }
+
+  // Block the queue with a port that hasn't completed.
+  scheduler.RunDiscovery(m_ports[0], NewDiscoveryCallback(), true);
+  for (unsigned int i = 0; i < ports.size(); i++) {
+    scheduler.RunDiscovery(ports[i], NewDiscoveryCallback(), true);
+  }
+  OLA_ASSERT_EQ(100u, scheduler.QueuedCount());
+  OLA_ASSERT_EQ(0u, m_callbacks_run);
+
+  m_ports[0]->Complete();
+  OLA_ASSERT_EQ(101u, m_callbacks_run);
+  OLA_ASSERT_EQ(101u, m_uids_found);
+  OLA_ASSERT_EQ(0u, scheduler.QueuedCount());
+  OLA_ASSERT_EQ(0u, scheduler.RunningCount());
+  ola::STLDeleteElements(&ports);
+}
+
+
+/*
+ * Check a universe runs discovery through the scheduler.
+ */
+void DiscoverySchedulerTest::testUniverse() {
+  DiscoveryScheduler scheduler(&m_export_map, &m_clock, 1);
+  ola::UniverseStore store(NULL, &m_export_map);
+  store.SetDiscoveryScheduler(&scheduler);
+
+  Universe *universe = store.GetUniverseOrCreate(1);
+  OLA_ASSERT_NOT_NULL(universe);
+  for (unsigned int i = 0; i < 3; i++) {
+    universe->AddPort(m_ports[i]);
+  }
+
+  UIDSet uids;
+  universe->RunRDMDiscovery(
+      NewSingleCallback(this, &DiscoverySchedulerTest::DiscoveryComplete),
+      true);
+  OLA_ASSERT_TRUE(m_ports[0]->IsRunning());
+  OLA_ASSERT_FALSE(m_ports[1]->IsRunning());
+  OLA_ASSERT_EQ(2u, scheduler.QueuedCount());
+
+  m_ports[0]->Complete();
+  OLA_ASSERT_TRUE(m_ports[1]->IsRunning());
+
+  // Removing a port drops its queued run.
+  universe->RemovePort(m_ports[2]);
+  OLA_ASSERT_EQ(0u, scheduler.QueuedCount());
+  OLA_ASSERT_EQ(0u, m_callbacks_run);
+
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(1u, m_callbacks_run);
+  OLA_ASSERT_EQ(2u, m_uids_found);
+  universe->GetUIDs(&uids);
+  OLA_ASSERT_EQ(2u, uids.Size());
+  OLA_ASSERT_FALSE(m_ports[2]->IsRunning());
+
+  ola::UIntMap *discovery_time = m_export_map.GetUIntMapVar(
+      Universe::K_UNIVERSE_RDM_DISCOVERY_TIME_VAR);
+  OLA_ASSERT_EQ(string("map:universe 1:0"), discovery_time->Value());
+
+  universe->RemovePort(m_ports[0]);
+  universe->RemovePort(m_ports[1]);
+  store.DeleteAll();
+}
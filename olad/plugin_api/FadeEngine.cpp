@@ -0,0 +1,348 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FadeEngine.cpp
+ * Renders fades between DMX frames in olad.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/FadeEngine.h"
+
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/dmx/SlotKernels.h"
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/Port.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::thread::INVALID_TIMEOUT;
+using std::string;
+using std::vector;
+
+const unsigned int FadeEngine::DEFAULT_RENDER_RATE;
+const unsigned int FadeEngine::HOLD_REFRESH_MS;
+const uint32_t FadeEngine::PROGRESS_MAX;
+
+/*
+ * The client the fades are sent from. It's only ever a source client, so
+ * there's nothing to do with the data sent to it.
+ */
+class FadeEngine::FadeClient: public Client {
+ public:
+  explicit FadeClient(const ola::rdm::UID &uid)
+      : Client(NULL, uid) {
+  }
+
+  bool SendDMX(const DmxUpdate&) {
+    return true;
+  }
+};
+
+
+FadeEngine::FadeEngine(UniverseStore *universe_store,
+                       ola::thread::SchedulerInterface *scheduler,
+                       Clock *clock,
+                       const ola::rdm::UID &uid)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_clock(clock),
+      m_client(new FadeClient(uid)) {
+}
+
+
+FadeEngine::~FadeEngine() {
+  while (!m_fades.empty()) {
+    RemoveFade(m_fades.begin(), false);
+  }
+}
+
+
+bool FadeEngine::StartFade(const Fade &fade, string *error) {
+  if (!Validate(fade, error)) {
+    return false;
+  }
+
+  DmxBuffer start;
+  UniverseFade *state;
+  FadeMap::iterator iter = m_fades.find(fade.universe);
+  if (iter == m_fades.end()) {
+    Universe *universe = m_universe_store->GetUniverseOrCreate(
+        fade.universe);
+    if (universe) {
+      start = universe->GetDMX();
+    }
+    state = new UniverseFade();
+    state->universe = fade.universe;
+    state->render_timeout = INVALID_TIMEOUT;
+    m_fades[fade.universe] = state;
+  } else {
+    state = iter->second;
+    start = state->output;
+    if (state->render_timeout != INVALID_TIMEOUT) {
+      m_scheduler->RemoveTimeout(state->render_timeout);
+      state->render_timeout = INVALID_TIMEOUT;
+    }
+  }
+
+  // The start frame is the same size as the target, slots that we don't
+  // have data for start at 0.
+  const unsigned int size = fade.target.Size();
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  unsigned int length = size;
+  start.Get(data, &length);
+  memset(data + length, DMX_MIN_SLOT_VALUE, size - length);
+  state->start.Set(data, size);
+  state->output = state->start;
+  state->target = fade.target;
+  state->priority = fade.priority;
+  state->curve = fade.curve;
+  state->fine_channels = fade.fine_channels;
+  state->duration = TimeInterval(
+      static_cast<int64_t>(fade.duration) * ONE_THOUSAND);
+  state->fading = true;
+  m_clock->CurrentMonotonicTime(&state->start_time);
+  state->next_render = state->start_time;
+
+  OLA_DEBUG << "Fading universe " << fade.universe << " over "
+            << fade.duration << "ms";
+  Render(state);
+  return true;
+}
+
+
+bool FadeEngine::Release(unsigned int universe) {
+  FadeMap::iterator iter = m_fades.find(universe);
+  if (iter == m_fades.end()) {
+    return false;
+  }
+  RemoveFade(iter, true);
+  return true;
+}
+
+
+bool FadeEngine::IsActive(unsigned int universe) const {
+  return STLContains(m_fades, universe);
+}
+
+
+bool FadeEngine::IsFading(unsigned int universe) const {
+  FadeMap::const_iterator iter = m_fades.find(universe);
+  return iter != m_fades.end() && iter->second->fading;
+}
+
+
+bool FadeEngine::Validate(const Fade &fade, string *error) const {
+  std::ostringstream str;
+  if (fade.target.Size() == 0) {
+    str << "No data to fade universe " << fade.universe << " to";
+    *error = str.str();
+    return false;
+  }
+  if (fade.priority > ola::dmx::SOURCE_PRIORITY_MAX) {
+    str << "Invalid priority for fade of universe " << fade.universe;
+    *error = str.str();
+    return false;
+  }
+  if (fade.curve != FADE_CURVE_LINEAR && fade.curve != FADE_CURVE_EASE_IN &&
+      fade.curve != FADE_CURVE_EASE_OUT &&
+      fade.curve != FADE_CURVE_EASE_IN_OUT) {
+    str << "Invalid curve for fade of universe " << fade.universe;
+    *error = str.str();
+    return false;
+  }
+
+  vector<unsigned int> fine_channels(fade.fine_channels);
+  std::sort(fine_channels.begin(), fine_channels.end());
+  unsigned int end = 0;
+  vector<unsigned int>::const_iterator iter = fine_channels.begin();
+  for (; iter != fine_channels.end(); ++iter) {
+    if (*iter + 1 >= fade.target.Size() || *iter < end) {
+      str << "Invalid 16 bit slot " << *iter << " for fade of universe "
+          << fade.universe;
+      *error = str.str();
+      return false;
+    }
+    end = *iter + 2;
+  }
+  return true;
+}
+
+
+/*
+ * Render the next step of a fade, and schedule the one after.
+ */
+void FadeEngine::Render(UniverseFade *fade) {
+  fade->render_timeout = INVALID_TIMEOUT;
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  if (fade->fading) {
+    const TimeInterval elapsed = now - fade->start_time;
+    if (elapsed >= fade->duration) {
+      fade->output = fade->target;
+      fade->fading = false;
+      OLA_DEBUG << "Fade of universe " << fade->universe << " complete";
+    } else {
+      const uint32_t progress = static_cast<uint32_t>(
+          elapsed.AsInt() * PROGRESS_MAX / fade->duration.AsInt());
+      Interpolate(fade, ApplyCurve(fade->curve, progress));
+    }
+  }
+  Send(fade);
+  ScheduleRender(fade, now);
+}
+
+
+/*
+ * Set the output to a point between the start and the target.
+ * @param fade the fade to update.
+ * @param progress the point in the fade, from 0 to PROGRESS_MAX.
+ */
+void FadeEngine::Interpolate(UniverseFade *fade, uint32_t progress) {
+  const unsigned int size = fade->target.Size();
+  const uint8_t *start = fade->start.GetRaw();
+  const uint8_t *target = fade->target.GetRaw();
+  uint8_t data[DMX_UNIVERSE_SIZE];
+
+  // The 8 bit slots only need 8 bits of precision.
+  ola::dmx::SlotLerp(data, start, target, (progress + 0x80) >> 8, size);
+
+  vector<unsigned int>::const_iterator iter = fade->fine_channels.begin();
+  for (; iter != fade->fine_channels.end(); ++iter) {
+    const unsigned int slot = *iter;
+    const uint64_t from = (start[slot] << 8) | start[slot + 1];
+    const uint64_t to = (target[slot] << 8) | target[slot + 1];
+    const uint64_t value = (from * (PROGRESS_MAX - progress) + to * progress +
+                            PROGRESS_MAX / 2) >> 16;
+    data[slot] = static_cast<uint8_t>(value >> 8);
+    data[slot + 1] = static_cast<uint8_t>(value);
+  }
+  fade->output.Set(data, size);
+}
+
+
+/*
+ * Send the output of a fade to the universe.
+ */
+void FadeEngine::Send(UniverseFade *fade) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  m_client->DMXReceived(fade->universe,
+                        DmxSource(fade->output, now, fade->priority));
+  Universe *universe = m_universe_store->GetUniverseOrCreate(fade->universe);
+  if (universe) {
+    universe->SourceClientDataChanged(m_client.get());
+  }
+}
+
+
+/*
+ * Schedule the next render. The steps of a fade are kept on a fixed grid from
+ * the start of the fade, if we've fallen behind the missed steps are skipped.
+ */
+void FadeEngine::ScheduleRender(UniverseFade *fade, const TimeStamp &now) {
+  if (fade->fading) {
+    const TimeInterval interval = RenderInterval(fade->universe);
+    fade->next_render += interval;
+    if (fade->next_render <= now) {
+      fade->next_render = now + interval;
+    }
+  } else {
+    fade->next_render = now + TimeInterval(
+        static_cast<int64_t>(HOLD_REFRESH_MS) * ONE_THOUSAND);
+  }
+  fade->render_timeout = m_scheduler->RegisterSingleTimeout(
+      fade->next_render - now,
+      NewSingleCallback(this, &FadeEngine::Render, fade));
+}
+
+
+/*
+ * Get the time between renders for a universe.
+ */
+TimeInterval FadeEngine::RenderInterval(unsigned int universe_id) const {
+  unsigned int rate = DEFAULT_RENDER_RATE;
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (universe) {
+    vector<OutputPort*> ports;
+    universe->OutputPorts(&ports);
+    vector<OutputPort*>::const_iterator iter = ports.begin();
+    for (; iter != ports.end(); ++iter) {
+      const unsigned int port_rate = (*iter)->MaxFrameRate();
+      if (port_rate && port_rate < rate) {
+        rate = port_rate;
+      }
+    }
+  }
+  return TimeInterval(static_cast<int64_t>(USEC_IN_SECONDS / rate));
+}
+
+
+/*
+ * Remove the fade for a universe.
+ * @param iter the fade to remove
+ * @param remerge true if the universe should be merged again without the
+ *   fade's data.
+ */
+void FadeEngine::RemoveFade(FadeMap::iterator iter, bool remerge) {
+  UniverseFade *fade = iter->second;
+  m_fades.erase(iter);
+  if (fade->render_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(fade->render_timeout);
+  }
+
+  Universe *universe = m_universe_store->GetUniverse(fade->universe);
+  if (universe && universe->RemoveSourceClient(m_client.get()) && remerge &&
+      universe->IsActive()) {
+    universe->Remerge();
+  }
+  delete fade;
+}
+
+
+/*
+ * Map the linear progress of a fade to the curve.
+ */
+uint32_t FadeEngine::ApplyCurve(FadeCurve curve, uint32_t progress) {
+  const uint64_t p = progress;
+  switch (curve) {
+    case FADE_CURVE_EASE_IN:
+      return static_cast<uint32_t>((p * p) >> 16);
+    case FADE_CURVE_EASE_OUT:
+      return PROGRESS_MAX - static_cast<uint32_t>(
+          ((PROGRESS_MAX - p) * (PROGRESS_MAX - p)) >> 16);
+    case FADE_CURVE_EASE_IN_OUT:
+      // smoothstep, 3p^2 - 2p^3
+      return static_cast<uint32_t>(
+          (p * p * (3 * PROGRESS_MAX - 2 * p)) >> 32);
+    case FADE_CURVE_LINEAR:
+    default:
+      return progress;
+  }
+}
+}  // namespace ola
@@ -0,0 +1,167 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FadeEngine.h
+ * Renders fades between DMX frames in olad.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_FADEENGINE_H_
+#define OLAD_PLUGIN_API_FADEENGINE_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+/**
+ * @brief Renders fades between DMX frames.
+ *
+ * A client sends the frame to fade to, and how long the fade should take.
+ * The engine then renders the steps of the fade itself, so the client doesn't
+ * need to stream interpolated frames. The steps are timed from the start of
+ * the fade, so a late render doesn't stretch the fade.
+ *
+ * Each universe with a fade has its own render clock. It runs at the lowest
+ * MaxFrameRate() of the output ports patched to the universe, or
+ * DEFAULT_RENDER_RATE if that's lower or none of the ports set one.
+ *
+ * A fade starts from the last frame the engine rendered for the universe, so
+ * a new fade takes over smoothly from one in progress. If there isn't one, it
+ * starts from the current data in the universe. Once a fade completes the
+ * final frame is held, and resent every HOLD_REFRESH_MS so it doesn't time
+ * out, until the universe is released.
+ *
+ * The engine is merged into each universe as a source, at the priority of the
+ * fade.
+ */
+class FadeEngine {
+ public:
+  /**
+   * @brief How the fade progresses over time.
+   */
+  typedef enum {
+    FADE_CURVE_LINEAR,
+    FADE_CURVE_EASE_IN,  // starts slowly
+    FADE_CURVE_EASE_OUT,  // ends slowly
+    FADE_CURVE_EASE_IN_OUT,  // starts & ends slowly
+  } FadeCurve;
+
+  /**
+   * @brief A fade to start.
+   */
+  typedef struct {
+    unsigned int universe;
+    DmxBuffer target;
+    unsigned int duration;  // in ms, 0 jumps straight to the target
+    FadeCurve curve;
+    uint8_t priority;
+    // The first slot of each pair of slots that hold a 16 bit value. These
+    // are faded as one value, rather than as two 8 bit values.
+    std::vector<unsigned int> fine_channels;
+  } Fade;
+
+  /**
+   * @brief Create a new FadeEngine.
+   * @param universe_store the UniverseStore to find the universes in.
+   * @param scheduler the scheduler used for the render clocks.
+   * @param clock the clock used to time the fades.
+   * @param uid the UID of the client that the fades are sent from.
+   */
+  FadeEngine(class UniverseStore *universe_store,
+             ola::thread::SchedulerInterface *scheduler,
+             Clock *clock,
+             const ola::rdm::UID &uid);
+  ~FadeEngine();
+
+  /**
+   * @brief Start a fade, this replaces any fade on the universe.
+   * @param fade the fade to start.
+   * @param[out] error set to the reason if the fade was rejected.
+   * @returns true if the fade was started.
+   */
+  bool StartFade(const Fade &fade, std::string *error);
+
+  /**
+   * @brief Stop fading a universe, and remove the engine's data from it.
+   * @returns true if the engine was sending to the universe.
+   */
+  bool Release(unsigned int universe);
+
+  /**
+   * @brief Returns true if the engine is sending to the universe, either
+   * because a fade is running, or the end of one is being held.
+   */
+  bool IsActive(unsigned int universe) const;
+
+  /**
+   * @brief Returns true if a fade is running on the universe.
+   */
+  bool IsFading(unsigned int universe) const;
+
+  static const unsigned int DEFAULT_RENDER_RATE = 44;
+  static const unsigned int HOLD_REFRESH_MS = 1000;
+
+ private:
+  class FadeClient;
+
+  typedef struct {
+    unsigned int universe;
+    uint8_t priority;
+    FadeCurve curve;
+    DmxBuffer start;
+    DmxBuffer target;
+    DmxBuffer output;
+    std::vector<unsigned int> fine_channels;
+    TimeStamp start_time;
+    TimeInterval duration;
+    TimeStamp next_render;
+    bool fading;
+    ola::thread::timeout_id render_timeout;
+  } UniverseFade;
+
+  typedef std::map<unsigned int, UniverseFade*> FadeMap;
+
+  class UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  Clock *m_clock;
+  std::auto_ptr<FadeClient> m_client;
+  FadeMap m_fades;
+
+  bool Validate(const Fade &fade, std::string *error) const;
+  void Render(UniverseFade *fade);
+  void Interpolate(UniverseFade *fade, uint32_t progress);
+  void Send(UniverseFade *fade);
+  void ScheduleRender(UniverseFade *fade, const TimeStamp &now);
+  TimeInterval RenderInterval(unsigned int universe) const;
+  void RemoveFade(FadeMap::iterator iter, bool remerge);
+
+  static uint32_t ApplyCurve(FadeCurve curve, uint32_t progress);
+
+  static const uint32_t PROGRESS_MAX = 0x10000;
+
+  DISALLOW_COPY_AND_ASSIGN(FadeEngine);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_FADEENGINE_H_
@@ -0,0 +1,378 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ * FadeEngineTest.cpp
+ * Test fixture for the FadeEngine class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/rdm/UID.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/Port.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/plugin_api/FadeEngine.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::FadeEngine;
+using ola::MockClock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::rdm::UID;
+using std::string;
+
+/*
+ * A rate limited port, used to check the render rate follows the port.
+ */
+class TestRateLimitedPort: public ola::RateLimitedOutputPort {
+ public:
+  TestRateLimitedPort(ola::AbstractDevice *parent,
+                      unsigned int port_id,
+                      ola::io::SelectServerInterface *ss,
+                      unsigned int max_frame_rate)
+      : RateLimitedOutputPort(parent, port_id, ss, max_frame_rate) {
+  }
+
+  string Description() const { return ""; }
+
+ protected:
+  bool SendDMX(const DmxBuffer&, uint8_t) { return true; }
+};
+
+
+class FadeEngineTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FadeEngineTest);
+  CPPUNIT_TEST(testFade);
+  CPPUNIT_TEST(testCrossfade);
+  CPPUNIT_TEST(testCurves);
+  CPPUNIT_TEST(testFineChannels);
+  CPPUNIT_TEST(testRenderRate);
+  CPPUNIT_TEST(testRelease);
+  CPPUNIT_TEST(testValidation);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  FadeEngineTest()
+      : m_ss(&m_wake_up),
+        m_plugin_adaptor(NULL, &m_ss, NULL, NULL, NULL, NULL),
+        m_device(NULL, "foo"),
+        m_input(&m_device, 1, &m_plugin_adaptor),
+        m_output(&m_device, 2) {
+  }
+
+  void setUp();
+  void tearDown();
+  void testFade();
+  void testCrossfade();
+  void testCurves();
+  void testFineChannels();
+  void testRenderRate();
+  void testRelease();
+  void testValidation();
+
+ private:
+  TimeStamp m_wake_up;
+  MockSelectServer m_ss;
+  MockScheduler m_scheduler;
+  MockClock m_clock;
+  ola::PluginAdaptor m_plugin_adaptor;
+  MockDeviceLoopAndMulti m_device;
+  TestMockInputPort m_input;
+  TestMockOutputPort m_output;
+  ola::MemoryPreferences *m_preferences;
+  ola::UniverseStore *m_store;
+  ola::PortBroker *m_broker;
+  ola::PortManager *m_port_manager;
+  FadeEngine *m_engine;
+
+  void Advance(unsigned int ms);
+  void SendFromInput(const string &data);
+  static FadeEngine::Fade NewFade(const string &data, unsigned int duration,
+                                  FadeEngine::FadeCurve curve =
+                                      FadeEngine::FADE_CURVE_LINEAR);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FadeEngineTest);
+
+static const unsigned int UNIVERSE = 1;
+
+
+void FadeEngineTest::setUp() {
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_broker = new ola::PortBroker();
+  m_port_manager = new ola::PortManager(m_store, m_broker);
+  m_engine = new FadeEngine(m_store, &m_scheduler, &m_clock,
+                            UID(ola::OPEN_LIGHTING_ESTA_CODE, 0));
+  m_port_manager->PatchPort(&m_input, UNIVERSE);
+  m_port_manager->PatchPort(&m_output, UNIVERSE);
+}
+
+
+void FadeEngineTest::tearDown() {
+  delete m_engine;
+  m_port_manager->UnPatchPort(&m_input);
+  m_port_manager->UnPatchPort(&m_output);
+  delete m_port_manager;
+  delete m_broker;
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Move the clock forward and run the render.
+ */
+void FadeEngineTest::Advance(unsigned int ms) {
+  m_clock.AdvanceTime(0, ms * ola::ONE_THOUSAND);
+  m_scheduler.RunTimeouts();
+}
+
+
+void FadeEngineTest::SendFromInput(const string &data) {
+  DmxBuffer buffer;
+  buffer.SetFromString(data);
+  m_clock.CurrentMonotonicTime(&m_wake_up);
+  m_input.WriteDMX(buffer);
+  m_input.DmxChanged();
+}
+
+
+FadeEngine::Fade FadeEngineTest::NewFade(const string &data,
+                                         unsigned int duration,
+                                         FadeEngine::FadeCurve curve) {
+  FadeEngine::Fade fade;
+  fade.universe = UNIVERSE;
+  fade.target.SetFromString(data);
+  fade.duration = duration;
+  fade.curve = curve;
+  fade.priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  return fade;
+}
+
+
+/*
+ * Check a linear fade, and that the end of it is held.
+ */
+void FadeEngineTest::testFade() {
+  string error;
+  OLA_ASSERT_TRUE(m_engine->StartFade(NewFade("100,200,50,0", 1000), &error));
+  OLA_ASSERT_TRUE(m_engine->IsFading(UNIVERSE));
+
+  DmxBuffer expected;
+  expected.SetFromString("0,0,0,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+
+  Advance(500);
+  expected.SetFromString("50,100,25,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  Advance(250);
+  expected.SetFromString("75,150,38,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  // A late render jumps to the end.
+  Advance(400);
+  expected.SetFromString("100,200,50,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  OLA_ASSERT_FALSE(m_engine->IsFading(UNIVERSE));
+  OLA_ASSERT_TRUE(m_engine->IsActive(UNIVERSE));
+
+  // The end is held, and refreshed.
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+  OLA_ASSERT_EQ(TimeInterval(1, 0), m_scheduler.LastDelay());
+  Advance(FadeEngine::HOLD_REFRESH_MS);
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  // A fade with no duration goes straight to the target.
+  OLA_ASSERT_TRUE(m_engine->StartFade(NewFade("1,2,3", 0), &error));
+  expected.SetFromString("1,2,3");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  OLA_ASSERT_FALSE(m_engine->IsFading(UNIVERSE));
+}
+
+
+/*
+ * Check a new fade starts from the current point of the last one, and that
+ * the first fade starts from the data in the universe.
+ */
+void FadeEngineTest::testCrossfade() {
+  SendFromInput("100,100");
+  DmxBuffer expected;
+  expected.SetFromString("100,100");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  // Use a higher priority so the fade isn't HTP merged with the input.
+  FadeEngine::Fade fade = NewFade("200,0,50", 1000);
+  fade.priority = ola::dmx::SOURCE_PRIORITY_DEFAULT + 1;
+  string error;
+  OLA_ASSERT_TRUE(m_engine->StartFade(fade, &error));
+  expected.SetFromString("100,100,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  Advance(500);
+  expected.SetFromString("150,50,25");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  fade = NewFade("0,0,0", 1000);
+  fade.priority = ola::dmx::SOURCE_PRIORITY_DEFAULT + 1;
+  OLA_ASSERT_TRUE(m_engine->StartFade(fade, &error));
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+
+  Advance(500);
+  expected.SetFromString("75,25,13");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+}
+
+
+/*
+ * Check each of the curves at the half way point.
+ */
+void FadeEngineTest::testCurves() {
+  const FadeEngine::FadeCurve curves[] = {
+    FadeEngine::FADE_CURVE_LINEAR,
+    FadeEngine::FADE_CURVE_EASE_IN,
+    FadeEngine::FADE_CURVE_EASE_OUT,
+    FadeEngine::FADE_CURVE_EASE_IN_OUT,
+  };
+  const char *halfway[] = {"100", "50", "150", "100"};
+
+  for (unsigned int i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+    string error;
+    OLA_ASSERT_TRUE(m_engine->StartFade(NewFade("0", 0), &error));
+    OLA_ASSERT_TRUE(m_engine->StartFade(NewFade("200", 1000, curves[i]),
+                                        &error));
+    Advance(500);
+    DmxBuffer expected;
+    expected.SetFromString(halfway[i]);
+    OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+    Advance(500);
+    expected.SetFromString("200");
+    OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  }
+}
+
+
+/*
+ * Check that 16 bit slots are faded as one value.
+ */
+void FadeEngineTest::testFineChannels() {
+  FadeEngine::Fade fade = NewFade("1,0,1,0", 1000);
+  fade.fine_channels.push_back(0);
+  string error;
+  OLA_ASSERT_TRUE(m_engine->StartFade(fade, &error));
+
+  // The first pair goes from 0 to 256, the other two slots are faded on
+  // their own.
+  Advance(500);
+  DmxBuffer expected;
+  expected.SetFromString("0,128,1,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  Advance(500);
+  expected.SetFromString("1,0,1,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+}
+
+
+/*
+ * Check the render clock follows the rate of the output ports.
+ */
+void FadeEngineTest::testRenderRate() {
+  // The clock moves on a little between the renders, so allow some slack.
+  const int64_t slack = 5000;
+  string error;
+  OLA_ASSERT_TRUE(m_engine->StartFade(NewFade("255", 1000), &error));
+  const int64_t default_interval =
+      ola::USEC_IN_SECONDS / FadeEngine::DEFAULT_RENDER_RATE;
+  OLA_ASSERT_LTE(m_scheduler.LastDelay().AsInt(), default_interval);
+  OLA_ASSERT_GT(m_scheduler.LastDelay().AsInt(), default_interval - slack);
+
+  TestRateLimitedPort slow_port(&m_device, 3, &m_ss, 10);
+  m_port_manager->PatchPort(&slow_port, UNIVERSE);
+  m_clock.AdvanceTime(m_scheduler.LastDelay());
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_LTE(m_scheduler.LastDelay().AsInt(), 100000);
+  OLA_ASSERT_GT(m_scheduler.LastDelay().AsInt(), 100000 - slack);
+
+  // A late render doesn't move the following steps.
+  m_clock.AdvanceTime(0, 130000);
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_LTE(m_scheduler.LastDelay().AsInt(), 70000);
+  OLA_ASSERT_GT(m_scheduler.LastDelay().AsInt(), 70000 - slack);
+  m_port_manager->UnPatchPort(&slow_port);
+}
+
+
+/*
+ * Check releasing a universe removes the fade's data.
+ */
+void FadeEngineTest::testRelease() {
+  SendFromInput("10,10");
+  string error;
+  OLA_ASSERT_TRUE(m_engine->StartFade(NewFade("255,255", 0), &error));
+  DmxBuffer expected;
+  expected.SetFromString("255,255");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  OLA_ASSERT_TRUE(m_engine->Release(UNIVERSE));
+  OLA_ASSERT_FALSE(m_engine->IsActive(UNIVERSE));
+  OLA_ASSERT_EQ(0u, m_scheduler.PendingTimeouts());
+  expected.SetFromString("10,10");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  OLA_ASSERT_FALSE(m_engine->Release(UNIVERSE));
+}
+
+
+/*
+ * Check invalid fades are rejected.
+ */
+void FadeEngineTest::testValidation() {
+  string error;
+  OLA_ASSERT_FALSE(m_engine->StartFade(NewFade("", 1000), &error));
+  OLA_ASSERT_FALSE(error.empty());
+
+  FadeEngine::Fade fade = NewFade("1,2,3", 1000);
+  fade.priority = ola::dmx::SOURCE_PRIORITY_MAX + 1;
+  OLA_ASSERT_FALSE(m_engine->StartFade(fade, &error));
+
+  // The fine channel of the last slot would be past the end.
+  fade = NewFade("1,2,3", 1000);
+  fade.fine_channels.push_back(2);
+  OLA_ASSERT_FALSE(m_engine->StartFade(fade, &error));
+
+  // Overlapping pairs.
+  fade = NewFade("1,2,3", 1000);
+  fade.fine_channels.push_back(1);
+  fade.fine_channels.push_back(0);
+  OLA_ASSERT_FALSE(m_engine->StartFade(fade, &error));
+  OLA_ASSERT_FALSE(m_engine->IsActive(UNIVERSE));
+  OLA_ASSERT_EQ(0u, m_scheduler.PendingTimeouts());
+}
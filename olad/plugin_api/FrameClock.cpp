@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameClock.cpp
+ * Sends the output of several universes together on a common clock.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/FrameClock.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "olad/Universe.h"
+
+namespace ola {
+
+using std::vector;
+
+const unsigned int FrameClock::MAX_FRAME_RATE;
+const char FrameClock::K_FRAMES_VAR[] = "frame-clock-frames";
+const char FrameClock::K_TICKS_VAR[] = "frame-clock-ticks";
+
+FrameClock::FrameClock(ola::thread::SchedulerInterface *scheduler,
+                       ExportMap *export_map)
+    : m_scheduler(scheduler),
+      m_ticks_var(NULL),
+      m_frames_var(NULL),
+      m_frame_rate(0),
+      m_timeout(ola::thread::INVALID_TIMEOUT),
+      m_ticks(0) {
+  if (export_map) {
+    m_ticks_var = export_map->GetCounterVar(K_TICKS_VAR);
+    m_frames_var = export_map->GetCounterVar(K_FRAMES_VAR);
+  }
+}
+
+FrameClock::~FrameClock() {
+  StopTimer();
+  if (!m_pending.empty()) {
+    OLA_WARN << m_pending.size()
+             << " universes still waiting for the frame clock";
+  }
+}
+
+bool FrameClock::Start(unsigned int frames_per_second) {
+  if (frames_per_second == 0 || frames_per_second > MAX_FRAME_RATE) {
+    OLA_WARN << "Invalid frame clock rate " << frames_per_second
+             << ", must be between 1 and " << MAX_FRAME_RATE;
+    return false;
+  }
+  StopTimer();
+  m_frame_rate = frames_per_second;
+  StartTimer();
+  return true;
+}
+
+void FrameClock::Stop() {
+  StopTimer();
+  m_frame_rate = 0;
+}
+
+void FrameClock::ExternalTick() {
+  if (m_frame_rate) {
+    StopTimer();
+    StartTimer();
+  }
+  Tick();
+}
+
+void FrameClock::AddPendingUniverse(Universe *universe) {
+  m_pending.push_back(universe);
+}
+
+void FrameClock::RemovePendingUniverse(Universe *universe) {
+  m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), universe),
+                  m_pending.end());
+  // Don't invalidate the iteration in Tick().
+  std::replace(m_sending.begin(), m_sending.end(), universe,
+               static_cast<Universe*>(NULL));
+}
+
+void FrameClock::StartTimer() {
+  m_timeout = m_scheduler->RegisterRepeatingTimeout(
+      TimeInterval(static_cast<int64_t>(USEC_IN_SECONDS / m_frame_rate)),
+      NewCallback(this, &FrameClock::InternalTick));
+}
+
+void FrameClock::StopTimer() {
+  if (m_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout);
+    m_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+}
+
+bool FrameClock::InternalTick() {
+  Tick();
+  return true;
+}
+
+/*
+ * Send the frames of all the pending universes. Universes that change while
+ * they're being sent, e.g. from a loop back, are sent on the next tick.
+ */
+void FrameClock::Tick() {
+  m_ticks++;
+  if (m_ticks_var) {
+    (*m_ticks_var)++;
+  }
+
+  m_sending.swap(m_pending);
+  for (unsigned int i = 0; i < m_sending.size(); i++) {
+    if (m_sending[i]) {
+      m_sending[i]->SendFrameOnTick();
+      if (m_frames_var) {
+        (*m_frames_var)++;
+      }
+    }
+  }
+  m_sending.clear();
+}
+}  // namespace ola
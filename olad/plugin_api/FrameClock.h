@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameClock.h
+ * Sends the output of several universes together on a common clock.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_FRAMECLOCK_H_
+#define OLAD_PLUGIN_API_FRAMECLOCK_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class CounterVariable;
+class ExportMap;
+class Universe;
+
+/**
+ * @brief A clock that the output of universes is latched to.
+ *
+ * Normally each universe writes to its ports as soon as its data changes, so
+ * the outputs of different universes & protocols are out of phase with each
+ * other. A universe that uses a FrameClock instead holds its latest frame
+ * until the next tick, when the frames of all the pending universes are
+ * written together. Changes between ticks are coalesced into a single frame.
+ *
+ * Since the frames are all written from the same tick, the E1.31 and Art-Net
+ * sync packets the nodes send after each pass of writes also go out together.
+ *
+ * The clock either runs freely at the frame rate passed to Start(), or is
+ * locked to an external source, like timecode, by calling ExternalTick() on
+ * each edge. An external tick restarts the internal timer, so if the source
+ * goes away the clock freewheels at the frame rate.
+ */
+class FrameClock {
+ public:
+  /**
+   * @brief Create a new FrameClock.
+   * @param scheduler the scheduler used to run the internal timer.
+   * @param export_map the ExportMap to use for stats, may be NULL.
+   */
+  explicit FrameClock(ola::thread::SchedulerInterface *scheduler,
+                      ExportMap *export_map = NULL);
+
+  /**
+   * @brief Destructor.
+   *
+   * The universes using the clock must be detached first.
+   */
+  ~FrameClock();
+
+  /**
+   * @brief Start the internal timer.
+   * @param frames_per_second the tick rate, between 1 and MAX_FRAME_RATE.
+   * @returns true if the clock was started, false if the rate was invalid.
+   */
+  bool Start(unsigned int frames_per_second);
+
+  /**
+   * @brief Stop the internal timer.
+   *
+   * The clock can still be driven by ExternalTick().
+   */
+  void Stop();
+
+  /**
+   * @brief The rate of the internal timer, 0 if it's not running.
+   */
+  unsigned int FrameRate() const { return m_frame_rate; }
+
+  /**
+   * @brief Called on each edge of the external source the clock is locked to.
+   *
+   * This ticks the clock, and if the internal timer is running, restarts it
+   * so the next internal tick is a frame from now.
+   */
+  void ExternalTick();
+
+  /**
+   * @brief Send the frame of a universe on the next tick.
+   *
+   * This is called by the universe. A universe should only be added once per
+   * tick.
+   */
+  void AddPendingUniverse(Universe *universe);
+
+  /**
+   * @brief Forget about the pending frame of a universe.
+   *
+   * This is called by the universe, before it's deleted or stops using the
+   * clock.
+   */
+  void RemovePendingUniverse(Universe *universe);
+
+  /**
+   * @brief The number of universes waiting for the next tick.
+   */
+  unsigned int PendingUniverses() const { return m_pending.size(); }
+
+  /**
+   * @brief The number of times the clock has ticked.
+   */
+  uint64_t Ticks() const { return m_ticks; }
+
+  static const unsigned int MAX_FRAME_RATE = 1000;
+
+ private:
+  ola::thread::SchedulerInterface *m_scheduler;
+  CounterVariable *m_ticks_var;
+  CounterVariable *m_frames_var;
+  unsigned int m_frame_rate;
+  ola::thread::timeout_id m_timeout;
+  uint64_t m_ticks;
+  std::vector<Universe*> m_pending;
+  // The universes being sent by the current tick.
+  std::vector<Universe*> m_sending;
+
+  void StartTimer();
+  void StopTimer();
+  bool InternalTick();
+  void Tick();
+
+  static const char K_FRAMES_VAR[];
+  static const char K_TICKS_VAR[];
+
+  DISALLOW_COPY_AND_ASSIGN(FrameClock);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_FRAMECLOCK_H_
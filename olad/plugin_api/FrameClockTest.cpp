@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameClockTest.cpp
+ * Test fixture for the FrameClock class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/DmxBuffer.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/FrameClock.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::FrameClock;
+using ola::Universe;
+
+class FrameClockTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FrameClockTest);
+  CPPUNIT_TEST(testStart);
+  CPPUNIT_TEST(testTick);
+  CPPUNIT_TEST(testDetach);
+  CPPUNIT_TEST(testPreferences);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    m_buffer1.SetFromString("1,2,3");
+    m_buffer2.SetFromString("4,5,6");
+  }
+
+  void testStart();
+  void testTick();
+  void testDetach();
+  void testPreferences();
+
+ private:
+  // The MockScheduler never runs repeating timeouts, so the tests drive the
+  // clock with ExternalTick().
+  MockScheduler m_scheduler;
+  DmxBuffer m_buffer1, m_buffer2;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameClockTest);
+
+
+/*
+ * Check the frame rate is validated.
+ */
+void FrameClockTest::testStart() {
+  FrameClock clock(&m_scheduler);
+  OLA_ASSERT_EQ(0u, clock.FrameRate());
+  OLA_ASSERT_FALSE(clock.Start(0));
+  OLA_ASSERT_FALSE(clock.Start(FrameClock::MAX_FRAME_RATE + 1));
+  OLA_ASSERT_EQ(0u, clock.FrameRate());
+
+  OLA_ASSERT_TRUE(clock.Start(30));
+  OLA_ASSERT_EQ(30u, clock.FrameRate());
+  clock.Stop();
+  OLA_ASSERT_EQ(0u, clock.FrameRate());
+}
+
+
+/*
+ * Check that universes using the clock are sent together on each tick.
+ */
+void FrameClockTest::testTick() {
+  FrameClock clock(&m_scheduler);
+  ola::UniverseStore store(NULL, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+
+  MockDevice device(NULL, "foo");
+  TestMockOutputPort port1(&device, 1);
+  TestMockOutputPort port2(&device, 2);
+  port_manager.PatchPort(&port1, 1);
+  port_manager.PatchPort(&port2, 2);
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+  universe1->SetFrameClock(&clock);
+  universe2->SetFrameClock(&clock);
+  OLA_ASSERT_EQ(&clock, universe1->GetFrameClock());
+
+  // Nothing is sent until the clock ticks, and changes in the meantime are
+  // coalesced.
+  OLA_ASSERT_TRUE(universe1->SetDMX(m_buffer1));
+  OLA_ASSERT_TRUE(universe1->SetDMX(m_buffer2));
+  OLA_ASSERT_TRUE(universe2->SetDMX(m_buffer1));
+  OLA_ASSERT_EQ(0u, port1.WriteCount());
+  OLA_ASSERT_EQ(0u, port2.WriteCount());
+  OLA_ASSERT_EQ(2u, clock.PendingUniverses());
+
+  clock.ExternalTick();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), clock.Ticks());
+  OLA_ASSERT_EQ(1u, port1.WriteCount());
+  OLA_ASSERT_EQ(1u, port2.WriteCount());
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, port1.ReadDMX());
+  OLA_ASSERT_DMX_EQUALS(m_buffer1, port2.ReadDMX());
+  OLA_ASSERT_EQ(0u, clock.PendingUniverses());
+
+  // A tick with nothing pending doesn't send anything.
+  clock.ExternalTick();
+  OLA_ASSERT_EQ(1u, port1.WriteCount());
+  OLA_ASSERT_EQ(1u, port2.WriteCount());
+
+  // Only the universes that changed are sent.
+  OLA_ASSERT_TRUE(universe2->SetDMX(m_buffer2));
+  clock.ExternalTick();
+  OLA_ASSERT_EQ(1u, port1.WriteCount());
+  OLA_ASSERT_EQ(2u, port2.WriteCount());
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, port2.ReadDMX());
+}
+
+
+/*
+ * Check pending frames are handled when a universe stops using the clock.
+ */
+void FrameClockTest::testDetach() {
+  FrameClock clock(&m_scheduler);
+  ola::UniverseStore store(NULL, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+
+  MockDevice device(NULL, "foo");
+  TestMockOutputPort port(&device, 1);
+  port_manager.PatchPort(&port, 1);
+  Universe *universe = store.GetUniverseOrCreate(1);
+  universe->SetFrameClock(&clock);
+
+  // The pending frame is sent when the clock is removed.
+  OLA_ASSERT_TRUE(universe->SetDMX(m_buffer1));
+  OLA_ASSERT_EQ(0u, port.WriteCount());
+  universe->SetFrameClock(NULL);
+  OLA_ASSERT_EQ(1u, port.WriteCount());
+  OLA_ASSERT_EQ(0u, clock.PendingUniverses());
+
+  // And dropped if the universe is deleted.
+  universe->SetFrameClock(&clock);
+  OLA_ASSERT_TRUE(universe->SetDMX(m_buffer2));
+  OLA_ASSERT_EQ(1u, clock.PendingUniverses());
+  port_manager.UnPatchPort(&port);
+  store.DeleteAll();
+  OLA_ASSERT_EQ(0u, clock.PendingUniverses());
+  clock.ExternalTick();
+  OLA_ASSERT_EQ(1u, port.WriteCount());
+}
+
+
+/*
+ * Check universes opt in to the clock with a preference.
+ */
+void FrameClockTest::testPreferences() {
+  FrameClock clock(&m_scheduler);
+  ola::MemoryPreferences preferences("universe");
+  preferences.SetValue("uni_1_frame_clock", "true");
+  preferences.SetValue("uni_2_frame_clock", "false");
+  ola::UniverseStore store(&preferences, NULL);
+
+  // Universes that exist when the clock is set
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  OLA_ASSERT_NULL(universe1->GetFrameClock());
+  store.SetFrameClock(&clock);
+  OLA_ASSERT_EQ(&clock, universe1->GetFrameClock());
+
+  // And those created afterwards
+  OLA_ASSERT_NULL(store.GetUniverseOrCreate(2)->GetFrameClock());
+  OLA_ASSERT_NULL(store.GetUniverseOrCreate(3)->GetFrameClock());
+  preferences.SetValue("uni_4_frame_clock", "true");
+  OLA_ASSERT_EQ(&clock, store.GetUniverseOrCreate(4)->GetFrameClock());
+
+  store.SetFrameClock(NULL);
+  OLA_ASSERT_NULL(universe1->GetFrameClock());
+  store.DeleteAll();
+}
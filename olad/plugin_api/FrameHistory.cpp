@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameHistory.cpp
+ * Keeps a memory bounded history of the frames sent by each universe.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/FrameHistory.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+
+namespace ola {
+
+using std::string;
+using std::vector;
+
+const char FrameHistory::K_BYTES_VAR[] = "frame-history-bytes";
+const char FrameHistory::K_FRAMES_VAR[] = "frame-history-frames";
+
+FrameHistory::FrameHistory(unsigned int max_bytes, ExportMap *export_map)
+    : m_max_bytes(max_bytes),
+      m_bytes_var(NULL),
+      m_frames_var(NULL),
+      m_bytes(0) {
+  if (export_map) {
+    m_bytes_var = export_map->GetIntegerVar(K_BYTES_VAR);
+    m_frames_var = export_map->GetIntegerVar(K_FRAMES_VAR);
+  }
+}
+
+void FrameHistory::AddFrame(unsigned int universe,
+                            const TimeStamp &time,
+                            uint8_t priority,
+                            const string &source,
+                            const DmxBuffer &data) {
+  UniverseHistory &history = m_universes[universe];
+  if (history.records && priority == history.last_priority &&
+      data == history.last) {
+    return;
+  }
+
+  m_records.push_back(Record());
+  Record &record = m_records.back();
+  record.time = time;
+  record.universe = universe;
+  record.priority = priority;
+
+  uint8_t delta[DMX_UNIVERSE_SIZE];
+  unsigned int delta_size = data.Size();
+  // Encode fails if the delta would be larger than the frame itself.
+  if (history.records &&
+      m_encoder.EncodeDelta(history.last, data, delta, &delta_size)) {
+    record.full = false;
+    record.data.assign(reinterpret_cast<char*>(delta), delta_size);
+  } else {
+    record.full = true;
+    record.data.assign(reinterpret_cast<const char*>(data.GetRaw()),
+                       data.Size());
+  }
+
+  record.source = m_sources.insert(std::make_pair(source, 0)).first;
+  record.source->second++;
+
+  history.last = data;
+  history.last_priority = priority;
+  history.records++;
+  m_bytes += RecordSize(record);
+
+  while (m_bytes > m_max_bytes && !m_records.empty()) {
+    DropOldest();
+  }
+  UpdateVars();
+}
+
+void FrameHistory::GetFrames(unsigned int universe,
+                             const TimeStamp &since,
+                             unsigned int max_frames,
+                             vector<Frame> *frames) const {
+  frames->clear();
+  UniverseMap::const_iterator uni_iter = m_universes.find(universe);
+  if (uni_iter == m_universes.end()) {
+    return;
+  }
+
+  // Replay the records from the base frame.
+  DmxBuffer frame(uni_iter->second.base);
+  std::deque<Record>::const_iterator iter = m_records.begin();
+  for (; iter != m_records.end(); ++iter) {
+    if (iter->universe != universe) {
+      continue;
+    }
+    if (!ApplyRecord(*iter, &frame)) {
+      OLA_WARN << "Corrupt frame history for universe " << universe;
+      frames->clear();
+      return;
+    }
+    if (iter->time < since) {
+      continue;
+    }
+    frames->push_back(Frame());
+    Frame &output = frames->back();
+    output.time = iter->time;
+    output.priority = iter->priority;
+    output.source = iter->source->first;
+    output.data = frame;
+  }
+
+  if (max_frames && frames->size() > max_frames) {
+    frames->erase(frames->begin(),
+                  frames->begin() + (frames->size() - max_frames));
+  }
+}
+
+/*
+ * Drop the oldest record, applying it to the base frame of its universe.
+ */
+void FrameHistory::DropOldest() {
+  const Record &record = m_records.front();
+  UniverseMap::iterator uni_iter = m_universes.find(record.universe);
+  if (--uni_iter->second.records == 0) {
+    // Nothing refers to the base frame now.
+    m_universes.erase(uni_iter);
+  } else {
+    ApplyRecord(record, &uni_iter->second.base);
+  }
+
+  if (--record.source->second == 0) {
+    m_sources.erase(record.source);
+  }
+  m_bytes -= RecordSize(record);
+  m_records.pop_front();
+}
+
+void FrameHistory::UpdateVars() {
+  if (m_bytes_var) {
+    m_bytes_var->Set(m_bytes);
+  }
+  if (m_frames_var) {
+    m_frames_var->Set(m_records.size());
+  }
+}
+
+bool FrameHistory::ApplyRecord(const Record &record, DmxBuffer *frame) {
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(record.data.data());
+  if (record.full) {
+    return frame->Set(data, record.data.size());
+  }
+  ola::dmx::RunLengthEncoder encoder;
+  return encoder.DecodeDelta(*frame, data, record.data.size(), frame);
+}
+
+/*
+ * The memory used by a record, this ignores the allocator's overhead.
+ */
+unsigned int FrameHistory::RecordSize(const Record &record) {
+  return sizeof(record) + record.data.size();
+}
+}  // namespace ola
@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameHistory.h
+ * Keeps a memory bounded history of the frames sent by each universe.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_FRAMEHISTORY_H_
+#define OLAD_PLUGIN_API_FRAMEHISTORY_H_
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/dmx/RunLengthEncoder.h"
+
+namespace ola {
+
+class ExportMap;
+class IntegerVariable;
+
+/**
+ * @brief A history of the frames olad has sent, for replay & diagnostics.
+ *
+ * Each frame a universe sends is stored as the run length encoded difference
+ * from the universe's previous frame, along with the time it was sent, the
+ * priority and the source that caused it. Frames that are the same as the
+ * previous one aren't stored.
+ *
+ * The frames of all universes are kept in a single list, in the order they
+ * were sent. Once the history is larger than the memory limit, the oldest
+ * frames are dropped. Rather than keyframes, each universe keeps the frame
+ * that precedes its oldest stored frame, and the dropped frames are applied
+ * to it. A typical delta is tens of bytes, so a few MB holds minutes of
+ * history for a busy rig.
+ *
+ * This isn't thread safe, it's used from the SelectServer thread.
+ */
+class FrameHistory {
+ public:
+  /**
+   * @brief A frame from the history.
+   */
+  struct Frame {
+    TimeStamp time;  // monotonic
+    uint8_t priority;
+    std::string source;
+    DmxBuffer data;
+
+    Frame() : priority(0) {}
+  };
+
+  /**
+   * @brief Create a new FrameHistory.
+   * @param max_bytes the memory the stored frames may use.
+   * @param export_map the ExportMap to use for stats, may be NULL.
+   */
+  explicit FrameHistory(unsigned int max_bytes, ExportMap *export_map = NULL);
+  ~FrameHistory() {}
+
+  /**
+   * @brief Add a frame to the history.
+   * @param universe the universe that sent the frame.
+   * @param time when the frame was sent.
+   * @param priority the priority of the frame.
+   * @param source the source that caused the frame, e.g. an input port.
+   * @param data the frame.
+   */
+  void AddFrame(unsigned int universe,
+                const TimeStamp &time,
+                uint8_t priority,
+                const std::string &source,
+                const DmxBuffer &data);
+
+  /**
+   * @brief Get the stored frames for a universe.
+   * @param universe the universe to get the frames for.
+   * @param since only return frames sent at or after this time.
+   * @param max_frames the maximum number of frames to return, the most
+   *   recent ones are kept. 0 means no limit.
+   * @param[out] frames the frames, oldest first.
+   */
+  void GetFrames(unsigned int universe,
+                 const TimeStamp &since,
+                 unsigned int max_frames,
+                 std::vector<Frame> *frames) const;
+
+  /**
+   * @brief The number of frames stored, over all universes.
+   */
+  unsigned int FrameCount() const { return m_records.size(); }
+
+  /**
+   * @brief The memory used by the stored frames.
+   */
+  unsigned int Bytes() const { return m_bytes; }
+
+  unsigned int MaxBytes() const { return m_max_bytes; }
+
+ private:
+  // The sources are shared between the records, this holds the number of
+  // records that refer to each one.
+  typedef std::map<std::string, unsigned int> SourceMap;
+
+  struct Record {
+    TimeStamp time;
+    unsigned int universe;
+    uint8_t priority;
+    bool full;  // true if data is the frame, rather than a delta
+    SourceMap::iterator source;
+    std::string data;
+  };
+
+  struct UniverseHistory {
+    DmxBuffer base;  // the frame before the oldest record
+    DmxBuffer last;  // the most recent frame
+    uint8_t last_priority;
+    unsigned int records;
+
+    UniverseHistory() : last_priority(0), records(0) {}
+  };
+
+  typedef std::map<unsigned int, UniverseHistory> UniverseMap;
+
+  const unsigned int m_max_bytes;
+  IntegerVariable *m_bytes_var;
+  IntegerVariable *m_frames_var;
+  std::deque<Record> m_records;
+  UniverseMap m_universes;
+  SourceMap m_sources;
+  unsigned int m_bytes;
+  ola::dmx::RunLengthEncoder m_encoder;
+
+  void DropOldest();
+  void UpdateVars();
+
+  static bool ApplyRecord(const Record &record, DmxBuffer *frame);
+  static unsigned int RecordSize(const Record &record);
+
+  static const char K_BYTES_VAR[];
+  static const char K_FRAMES_VAR[];
+
+  DISALLOW_COPY_AND_ASSIGN(FrameHistory);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_FRAMEHISTORY_H_
@@ -0,0 +1,228 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameHistoryTest.cpp
+ * Test fixture for the FrameHistory class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "olad/PortBroker.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/FrameHistory.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::FrameHistory;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using std::string;
+using std::vector;
+
+class FrameHistoryTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FrameHistoryTest);
+  CPPUNIT_TEST(testAddFrame);
+  CPPUNIT_TEST(testQuery);
+  CPPUNIT_TEST(testMemoryLimit);
+  CPPUNIT_TEST(testUniverse);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    m_buffer1.SetFromString("1,2,3");
+    m_buffer2.SetFromString("1,2,4,5");
+    m_start = TimeStamp() + TimeInterval(1000, 0);
+  }
+
+  void testAddFrame();
+  void testQuery();
+  void testMemoryLimit();
+  void testUniverse();
+
+ private:
+  DmxBuffer m_buffer1, m_buffer2;
+  TimeStamp m_start;
+
+  TimeStamp Time(unsigned int ms) {
+    return m_start + TimeInterval(0, ms * 1000);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameHistoryTest);
+
+
+/*
+ * Check frames are stored and replayed.
+ */
+void FrameHistoryTest::testAddFrame() {
+  FrameHistory history(1 << 20);
+  vector<FrameHistory::Frame> frames;
+  history.GetFrames(1, TimeStamp(), 0, &frames);
+  OLA_ASSERT_TRUE(frames.empty());
+
+  history.AddFrame(1, Time(0), 100, "port:1-1-I-0", m_buffer1);
+  history.AddFrame(1, Time(25), 100, "port:1-1-I-0", m_buffer2);
+  // The same frame again isn't stored
+  history.AddFrame(1, Time(50), 100, "port:1-1-I-0", m_buffer2);
+  // But it is if the priority changed
+  history.AddFrame(1, Time(75), 150, "client:7a70:00000001", m_buffer2);
+  history.AddFrame(2, Time(80), 100, "", m_buffer2);
+  // A smaller frame
+  history.AddFrame(1, Time(100), 150, "client:7a70:00000001", m_buffer1);
+  OLA_ASSERT_EQ(5u, history.FrameCount());
+  OLA_ASSERT_TRUE(history.Bytes() > 0);
+
+  history.GetFrames(1, TimeStamp(), 0, &frames);
+  OLA_ASSERT_EQ(static_cast<size_t>(4), frames.size());
+  OLA_ASSERT_EQ(Time(0), frames[0].time);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), frames[0].priority);
+  OLA_ASSERT_EQ(string("port:1-1-I-0"), frames[0].source);
+  OLA_ASSERT_DMX_EQUALS(m_buffer1, frames[0].data);
+  OLA_ASSERT_EQ(Time(25), frames[1].time);
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, frames[1].data);
+  OLA_ASSERT_EQ(Time(75), frames[2].time);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), frames[2].priority);
+  OLA_ASSERT_EQ(string("client:7a70:00000001"), frames[2].source);
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, frames[2].data);
+  OLA_ASSERT_EQ(Time(100), frames[3].time);
+  OLA_ASSERT_DMX_EQUALS(m_buffer1, frames[3].data);
+
+  history.GetFrames(2, TimeStamp(), 0, &frames);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), frames.size());
+  OLA_ASSERT_EQ(string(""), frames[0].source);
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, frames[0].data);
+
+  history.GetFrames(3, TimeStamp(), 0, &frames);
+  OLA_ASSERT_TRUE(frames.empty());
+}
+
+
+/*
+ * Check the time and count limits when fetching frames.
+ */
+void FrameHistoryTest::testQuery() {
+  FrameHistory history(1 << 20);
+  // Each frame is a slot longer than the last.
+  const uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  DmxBuffer buffer;
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    buffer.Set(data, i + 1);
+    history.AddFrame(1, Time(i * 10), 100, "", buffer);
+  }
+
+  vector<FrameHistory::Frame> frames;
+  history.GetFrames(1, Time(65), 0, &frames);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), frames.size());
+  OLA_ASSERT_EQ(Time(70), frames[0].time);
+  OLA_ASSERT_EQ(8u, frames[0].data.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(8), frames[0].data.Get(7));
+
+  // The most recent frames are kept.
+  history.GetFrames(1, TimeStamp(), 2, &frames);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), frames.size());
+  OLA_ASSERT_EQ(Time(80), frames[0].time);
+  OLA_ASSERT_EQ(Time(90), frames[1].time);
+  OLA_ASSERT_DMX_EQUALS(buffer, frames[1].data);
+}
+
+
+/*
+ * Check the oldest frames are dropped once the history is full, and the rest
+ * are still replayed correctly.
+ */
+void FrameHistoryTest::testMemoryLimit() {
+  const unsigned int max_bytes = 4096;
+  FrameHistory history(max_bytes);
+  DmxBuffer buffer;
+  buffer.Blackout();
+  for (unsigned int i = 0; i < 1000; i++) {
+    buffer.SetChannel(i % 512, static_cast<uint8_t>(i / 3));
+    history.AddFrame(1 + i % 2, Time(i), 100, "", buffer);
+    OLA_ASSERT_TRUE(history.Bytes() <= max_bytes);
+  }
+  OLA_ASSERT_TRUE(history.FrameCount() > 0);
+  OLA_ASSERT_TRUE(history.FrameCount() < 1000);
+
+  // Rebuild what the frames should be.
+  vector<FrameHistory::Frame> frames;
+  history.GetFrames(2, TimeStamp(), 0, &frames);
+  OLA_ASSERT_FALSE(frames.empty());
+  OLA_ASSERT_EQ(Time(999), frames.back().time);
+  DmxBuffer expected;
+  expected.Blackout();
+  for (unsigned int i = 0; i < 1000; i++) {
+    expected.SetChannel(i % 512, static_cast<uint8_t>(i / 3));
+    if (i % 2 == 1 && Time(i) == frames.front().time) {
+      OLA_ASSERT_DMX_EQUALS(expected, frames.front().data);
+    }
+  }
+  OLA_ASSERT_DMX_EQUALS(expected, frames.back().data);
+
+  // A history too small for a single frame doesn't keep anything.
+  FrameHistory tiny(16);
+  tiny.AddFrame(1, Time(0), 100, "", buffer);
+  OLA_ASSERT_EQ(0u, tiny.FrameCount());
+  OLA_ASSERT_EQ(0u, tiny.Bytes());
+  tiny.GetFrames(1, TimeStamp(), 0, &frames);
+  OLA_ASSERT_TRUE(frames.empty());
+}
+
+
+/*
+ * Check universes record the frames they send.
+ */
+void FrameHistoryTest::testUniverse() {
+  FrameHistory history(1 << 20);
+  ola::UniverseStore store(NULL, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+
+  MockDevice device(NULL, "foo");
+  TestMockOutputPort port(&device, 1);
+  port_manager.PatchPort(&port, 1);
+  Universe *universe = store.GetUniverseOrCreate(1);
+  store.SetFrameHistory(&history);
+
+  OLA_ASSERT_TRUE(universe->SetDMX(m_buffer1));
+  OLA_ASSERT_TRUE(universe->SetDMX(m_buffer2));
+  // Universes created later use the history too.
+  OLA_ASSERT_TRUE(store.GetUniverseOrCreate(2)->SetDMX(m_buffer1));
+
+  vector<FrameHistory::Frame> frames;
+  history.GetFrames(1, TimeStamp(), 0, &frames);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), frames.size());
+  OLA_ASSERT_DMX_EQUALS(m_buffer1, frames[0].data);
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, frames[1].data);
+  OLA_ASSERT_FALSE(frames[1].time < frames[0].time);
+  history.GetFrames(2, TimeStamp(), 0, &frames);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), frames.size());
+
+  store.SetFrameHistory(NULL);
+  OLA_ASSERT_TRUE(universe->SetDMX(m_buffer1));
+  OLA_ASSERT_EQ(3u, history.FrameCount());
+
+  port_manager.UnPatchPort(&port);
+  store.DeleteAll();
+}
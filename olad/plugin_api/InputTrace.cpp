@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InputTrace.cpp
+ * Records the DMX data the universes receive, so it can be replayed.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/InputTrace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "olad/DmxSource.h"
+
+namespace ola {
+
+using std::string;
+using std::vector;
+
+const char InputTrace::K_PORT_TYPE[] = "port";
+const char InputTrace::K_CLIENT_TYPE[] = "client";
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+}  // namespace
+
+InputTrace::InputTrace(std::ostream *output)
+    : m_output(output),
+      m_events(0) {
+}
+
+InputTrace::~InputTrace() {
+  if (m_output) {
+    m_output->flush();
+  }
+}
+
+bool InputTrace::Open(const string &filename) {
+  std::auto_ptr<std::ofstream> file(new std::ofstream(filename.c_str()));
+  if (!file->is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+  *file << "# offset_us type source universe priority data\n";
+  m_file.reset(file.release());
+  m_output = m_file.get();
+  m_start = TimeStamp();
+  m_events = 0;
+  return true;
+}
+
+void InputTrace::Record(SourceType type,
+                        const string &source,
+                        unsigned int universe,
+                        const DmxSource &dmx) {
+  if (!m_output) {
+    return;
+  }
+
+  if (!m_start.IsSet()) {
+    m_start = dmx.Timestamp();
+  }
+
+  Event event;
+  // Ports & clients don't share a clock source, so an update can appear to
+  // arrive before the first one.
+  event.offset_us = std::max(static_cast<int64_t>(0),
+                             (dmx.Timestamp() - m_start).AsInt());
+  event.type = type;
+  event.source = source;
+  event.universe = universe;
+  event.priority = dmx.Priority();
+  event.data = dmx.Data();
+  *m_output << FormatEvent(event) << '\n';
+  m_events++;
+}
+
+string InputTrace::FormatEvent(const Event &event) {
+  std::ostringstream str;
+  str << event.offset_us << " "
+      << (event.type == CLIENT_SOURCE ? K_CLIENT_TYPE : K_PORT_TYPE) << " "
+      << event.source << " " << event.universe << " "
+      << static_cast<unsigned int>(event.priority) << " ";
+
+  if (!event.data.Size()) {
+    str << "-";
+    return str.str();
+  }
+
+  string data;
+  data.reserve(event.data.Size() * 2);
+  for (unsigned int i = 0; i < event.data.Size(); i++) {
+    const uint8_t slot = event.data.Get(i);
+    data.push_back(HEX_DIGITS[slot >> 4]);
+    data.push_back(HEX_DIGITS[slot & 0x0f]);
+  }
+  str << data;
+  return str.str();
+}
+
+bool InputTrace::ParseEvent(const string &line, Event *event) {
+  std::istringstream str(line);
+  string type, data;
+  unsigned int priority;
+  if (!(str >> event->offset_us >> type >> event->source >> event->universe
+        >> priority >> data)) {
+    return false;
+  }
+
+  if (type == K_PORT_TYPE) {
+    event->type = PORT_SOURCE;
+  } else if (type == K_CLIENT_TYPE) {
+    event->type = CLIENT_SOURCE;
+  } else {
+    return false;
+  }
+
+  if (event->offset_us < 0 || priority > 0xff) {
+    return false;
+  }
+  event->priority = priority;
+
+  if (data == "-") {
+    event->data.Reset();
+    return true;
+  }
+
+  if (data.size() % 2 || data.size() > DMX_UNIVERSE_SIZE * 2) {
+    return false;
+  }
+
+  uint8_t slots[DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < data.size() / 2; i++) {
+    const int high = HexValue(data[2 * i]);
+    const int low = HexValue(data[2 * i + 1]);
+    if (high < 0 || low < 0) {
+      return false;
+    }
+    slots[i] = (high << 4) | low;
+  }
+  event->data.Set(slots, data.size() / 2);
+  return true;
+}
+
+bool InputTrace::Load(const string &filename, vector<Event> *events) {
+  std::ifstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+
+  string line;
+  unsigned int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    Event event;
+    if (!ParseEvent(line, &event)) {
+      OLA_WARN << filename << ":" << line_number << ": invalid event";
+      return false;
+    }
+    events->push_back(event);
+  }
+  return true;
+}
+}  // namespace ola
@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InputTrace.h
+ * Records the DMX data the universes receive, so it can be replayed.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_INPUTTRACE_H_
+#define OLAD_PLUGIN_API_INPUTTRACE_H_
+
+#include <stdint.h>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+class DmxSource;
+
+/**
+ * @brief A timestamped trace of the input to the universes.
+ *
+ * Each update a universe receives, from an input port or a source client, is
+ * written as a line of text:
+ *
+ * @code
+ *   <offset us> port|client <source> <universe> <priority> <hex data>
+ * @endcode
+ *
+ * The offset is from the first update in the trace and the source is the
+ * port's unique id or the client's UID. The updates are recorded after the
+ * plugins have parsed them, so the same trace can be replayed against any
+ * build of olad with universe_replay.
+ *
+ * This isn't thread safe, it's used from the SelectServer thread.
+ */
+class InputTrace {
+ public:
+  enum SourceType {
+    PORT_SOURCE,
+    CLIENT_SOURCE
+  };
+
+  /**
+   * @brief An update read from a trace.
+   */
+  struct Event {
+    int64_t offset_us;
+    SourceType type;
+    std::string source;
+    unsigned int universe;
+    uint8_t priority;
+    DmxBuffer data;
+
+    Event()
+        : offset_us(0),
+          type(PORT_SOURCE),
+          universe(0),
+          priority(0) {
+    }
+  };
+
+  /**
+   * @brief Create a new InputTrace.
+   * @param output the stream to write to, ownership is not transferred. If
+   *   NULL, nothing is written until Open() is called.
+   */
+  explicit InputTrace(std::ostream *output = NULL);
+  ~InputTrace();
+
+  /**
+   * @brief Write the trace to a file, replacing any existing contents.
+   * @param filename the file to write to.
+   * @returns true if the file was opened, false otherwise.
+   */
+  bool Open(const std::string &filename);
+
+  /**
+   * @brief Record an update.
+   * @param type the type of the source.
+   * @param source the unique id of the port or the UID of the client.
+   * @param universe the universe the update was sent to.
+   * @param dmx the update, the timestamp is used for the offset.
+   */
+  void Record(SourceType type,
+              const std::string &source,
+              unsigned int universe,
+              const DmxSource &dmx);
+
+  /**
+   * @brief The number of updates written.
+   */
+  uint64_t EventCount() const { return m_events; }
+
+  /**
+   * @brief Format an event as a line of the trace, without the newline.
+   */
+  static std::string FormatEvent(const Event &event);
+
+  /**
+   * @brief Parse a line of a trace.
+   * @param line the line to parse.
+   * @param[out] event the parsed event.
+   * @returns true if the line was valid, false otherwise.
+   */
+  static bool ParseEvent(const std::string &line, Event *event);
+
+  /**
+   * @brief Load a trace.
+   * @param filename the file to read.
+   * @param[out] events the events from the trace, in the order they were
+   *   recorded. Blank lines & lines starting with # are skipped.
+   * @returns false if the file couldn't be read or a line was invalid.
+   */
+  static bool Load(const std::string &filename, std::vector<Event> *events);
+
+ private:
+  std::auto_ptr<std::ofstream> m_file;
+  std::ostream *m_output;
+  TimeStamp m_start;
+  uint64_t m_events;
+
+  static const char K_PORT_TYPE[];
+  static const char K_CLIENT_TYPE[];
+
+  DISALLOW_COPY_AND_ASSIGN(InputTrace);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_INPUTTRACE_H_
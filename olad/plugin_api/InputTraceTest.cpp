@@ -0,0 +1,205 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InputTraceTest.cpp
+ * Test fixture for the InputTrace class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/StringUtils.h"
+#include "ola/rdm/UID.h"
+#include "olad/DmxSource.h"
+#include "olad/PortBroker.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/InputTrace.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::DmxSource;
+using ola::InputTrace;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using std::string;
+using std::vector;
+
+class InputTraceTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(InputTraceTest);
+  CPPUNIT_TEST(testFormatAndParse);
+  CPPUNIT_TEST(testInvalidEvents);
+  CPPUNIT_TEST(testUniverse);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    m_buffer1.SetFromString("1,2,3");
+    m_buffer2.SetFromString("0,255,16");
+    m_start = TimeStamp() + TimeInterval(1000, 0);
+  }
+
+  void testFormatAndParse();
+  void testInvalidEvents();
+  void testUniverse();
+
+ private:
+  DmxBuffer m_buffer1, m_buffer2;
+  TimeStamp m_start;
+
+  TimeStamp Time(unsigned int ms) {
+    return m_start + TimeInterval(0, ms * 1000);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(InputTraceTest);
+
+
+/*
+ * Check events survive being written & read back.
+ */
+void InputTraceTest::testFormatAndParse() {
+  InputTrace::Event event;
+  event.offset_us = 1500;
+  event.type = InputTrace::CLIENT_SOURCE;
+  event.source = "7a70:00000001";
+  event.universe = 3;
+  event.priority = 150;
+  event.data = m_buffer2;
+
+  const string line = InputTrace::FormatEvent(event);
+  OLA_ASSERT_EQ(string("1500 client 7a70:00000001 3 150 00ff10"), line);
+
+  InputTrace::Event parsed;
+  OLA_ASSERT_TRUE(InputTrace::ParseEvent(line, &parsed));
+  OLA_ASSERT_EQ(event.offset_us, parsed.offset_us);
+  OLA_ASSERT_EQ(InputTrace::CLIENT_SOURCE, parsed.type);
+  OLA_ASSERT_EQ(event.source, parsed.source);
+  OLA_ASSERT_EQ(3u, parsed.universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), parsed.priority);
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, parsed.data);
+
+  // A full universe, and an empty one.
+  DmxBuffer full;
+  full.SetRangeToValue(0, 0xab, ola::DMX_UNIVERSE_SIZE);
+  event.type = InputTrace::PORT_SOURCE;
+  event.source = "1-foo-I-0";
+  event.data = full;
+  OLA_ASSERT_TRUE(InputTrace::ParseEvent(InputTrace::FormatEvent(event),
+                                         &parsed));
+  OLA_ASSERT_EQ(InputTrace::PORT_SOURCE, parsed.type);
+  OLA_ASSERT_DMX_EQUALS(full, parsed.data);
+
+  event.data.Reset();
+  OLA_ASSERT_TRUE(ola::StringEndsWith(InputTrace::FormatEvent(event), " -"));
+  OLA_ASSERT_TRUE(InputTrace::ParseEvent(InputTrace::FormatEvent(event),
+                                         &parsed));
+  OLA_ASSERT_EQ(0u, parsed.data.Size());
+}
+
+
+/*
+ * Check invalid lines are rejected.
+ */
+void InputTraceTest::testInvalidEvents() {
+  InputTrace::Event event;
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("", &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("0 port 1-foo-I-0 1 100", &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("0 widget 1-foo-I-0 1 100 00",
+                                          &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("-5 port 1-foo-I-0 1 100 00",
+                                          &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("0 port 1-foo-I-0 1 256 00",
+                                          &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("0 port 1-foo-I-0 1 100 0",
+                                          &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent("0 port 1-foo-I-0 1 100 0g",
+                                          &event));
+  OLA_ASSERT_FALSE(InputTrace::ParseEvent(
+      "0 port 1-foo-I-0 1 100 " + string(2 * ola::DMX_UNIVERSE_SIZE + 2, '0'),
+      &event));
+}
+
+
+/*
+ * Check the universes record the updates from ports & clients.
+ */
+void InputTraceTest::testUniverse() {
+  std::ostringstream output;
+  InputTrace trace(&output);
+  ola::UniverseStore store(NULL, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+
+  MockDevice device(NULL, "foo");
+  TestMockInputPort port(&device, 1, NULL);
+  port_manager.PatchPort(&port, 1);
+  store.SetInputTrace(&trace);
+
+  port.UpdateSource(DmxSource(m_buffer1, Time(10), 100));
+  // The same data again is recorded too.
+  port.UpdateSource(DmxSource(m_buffer1, Time(20), 100));
+
+  // Universes created later record their input as well.
+  ola::Client client(NULL, ola::rdm::UID(ola::OPEN_LIGHTING_ESTA_CODE, 1));
+  Universe *universe = store.GetUniverseOrCreate(2);
+  client.DMXReceived(2, DmxSource(m_buffer2, Time(35), 150));
+  OLA_ASSERT_TRUE(universe->SourceClientDataChanged(&client));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), trace.EventCount());
+
+  vector<string> lines;
+  ola::StringSplit(output.str(), &lines, "\n");
+  OLA_ASSERT_EQ(static_cast<size_t>(4), lines.size());
+
+  InputTrace::Event event;
+  OLA_ASSERT_TRUE(InputTrace::ParseEvent(lines[0], &event));
+  OLA_ASSERT_EQ(static_cast<int64_t>(0), event.offset_us);
+  OLA_ASSERT_EQ(InputTrace::PORT_SOURCE, event.type);
+  OLA_ASSERT_EQ(port.UniqueId(), event.source);
+  OLA_ASSERT_EQ(1u, event.universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), event.priority);
+  OLA_ASSERT_DMX_EQUALS(m_buffer1, event.data);
+
+  OLA_ASSERT_TRUE(InputTrace::ParseEvent(lines[1], &event));
+  OLA_ASSERT_EQ(static_cast<int64_t>(10000), event.offset_us);
+
+  OLA_ASSERT_TRUE(InputTrace::ParseEvent(lines[2], &event));
+  OLA_ASSERT_EQ(static_cast<int64_t>(25000), event.offset_us);
+  OLA_ASSERT_EQ(InputTrace::CLIENT_SOURCE, event.type);
+  OLA_ASSERT_EQ(client.GetUID().ToString(), event.source);
+  OLA_ASSERT_EQ(2u, event.universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), event.priority);
+  OLA_ASSERT_DMX_EQUALS(m_buffer2, event.data);
+  OLA_ASSERT_TRUE(lines[3].empty());
+
+  store.SetInputTrace(NULL);
+  port.UpdateSource(DmxSource(m_buffer2, Time(40), 100));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), trace.EventCount());
+
+  universe->RemoveSourceClient(&client);
+  port_manager.UnPatchPort(&port);
+  store.DeleteAll();
+}
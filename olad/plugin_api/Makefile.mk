@@ -17,17 +17,39 @@ olad_plugin_api_libolaserverplugininterface_la_SOURCES = \
     olad/plugin_api/Device.cpp \
     olad/plugin_api/DeviceManager.cpp \
     olad/plugin_api/DeviceManager.h \
+    olad/plugin_api/DiscoveryScheduler.cpp \
+    olad/plugin_api/DiscoveryScheduler.h \
     olad/plugin_api/DmxSource.cpp \
+    olad/plugin_api/FadeEngine.cpp \
+    olad/plugin_api/FadeEngine.h \
+    olad/plugin_api/FrameClock.cpp \
+    olad/plugin_api/FrameClock.h \
+    olad/plugin_api/FrameHistory.cpp \
+    olad/plugin_api/FrameHistory.h \
+    olad/plugin_api/InputTrace.cpp \
+    olad/plugin_api/InputTrace.h \
+    olad/plugin_api/PendingRequestTracker.h \
+    olad/plugin_api/PixelMap.cpp \
     olad/plugin_api/Plugin.cpp \
     olad/plugin_api/PluginAdaptor.cpp \
+    olad/plugin_api/PluginThread.cpp \
+    olad/plugin_api/PluginThread.h \
     olad/plugin_api/Port.cpp \
     olad/plugin_api/PortBroker.cpp \
     olad/plugin_api/PortManager.cpp \
     olad/plugin_api/PortManager.h \
     olad/plugin_api/Preferences.cpp \
+    olad/plugin_api/RDMPoller.cpp \
+    olad/plugin_api/RDMPoller.h \
+    olad/plugin_api/RDMResponderStats.cpp \
+    olad/plugin_api/RDMResponderStats.h \
+    olad/plugin_api/TimeCodeGenerator.cpp \
+    olad/plugin_api/TimeCodeGenerator.h \
     olad/plugin_api/Universe.cpp \
     olad/plugin_api/UniverseStore.cpp \
-    olad/plugin_api/UniverseStore.h
+    olad/plugin_api/UniverseStore.h \
+    olad/plugin_api/VirtualUniverseManager.cpp \
+    olad/plugin_api/VirtualUniverseManager.h
 olad_plugin_api_libolaserverplugininterface_la_CXXFLAGS = \
     $(COMMON_PROTOBUF_CXXFLAGS)
 olad_plugin_api_libolaserverplugininterface_la_LIBADD = \
@@ -41,8 +63,11 @@ test_programs += \
     olad/plugin_api/ClientTester \
     olad/plugin_api/DeviceTester \
     olad/plugin_api/DmxSourceTester \
+    olad/plugin_api/PendingRequestTrackerTester \
+    olad/plugin_api/PluginThreadTester \
     olad/plugin_api/PortTester \
     olad/plugin_api/PreferencesTester \
+    olad/plugin_api/TimeCodeGeneratorTester \
     olad/plugin_api/UniverseTester
 
 COMMON_OLAD_PLUGIN_API_TEST_LDADD = \
@@ -64,7 +89,19 @@ olad_plugin_api_DmxSourceTester_SOURCES = olad/plugin_api/DmxSourceTest.cpp
 olad_plugin_api_DmxSourceTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_DmxSourceTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_PortTester_SOURCES = olad/plugin_api/PortTest.cpp \
+olad_plugin_api_PendingRequestTrackerTester_SOURCES = \
+    olad/plugin_api/PendingRequestTrackerTest.cpp
+olad_plugin_api_PendingRequestTrackerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_PendingRequestTrackerTester_LDADD = \
+    $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+olad_plugin_api_PluginThreadTester_SOURCES = \
+    olad/plugin_api/PluginThreadTest.cpp
+olad_plugin_api_PluginThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_PluginThreadTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+olad_plugin_api_PortTester_SOURCES = olad/plugin_api/PixelMapTest.cpp \
+                                     olad/plugin_api/PortTest.cpp \
                                      olad/plugin_api/PortManagerTest.cpp
 olad_plugin_api_PortTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PortTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
@@ -73,6 +110,47 @@ olad_plugin_api_PreferencesTester_SOURCES = olad/plugin_api/PreferencesTest.cpp
 olad_plugin_api_PreferencesTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PreferencesTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_UniverseTester_SOURCES = olad/plugin_api/UniverseTest.cpp
-olad_plugin_api_UniverseTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_TimeCodeGeneratorTester_SOURCES = \
+    olad/plugin_api/TimeCodeGeneratorTest.cpp
+olad_plugin_api_TimeCodeGeneratorTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_TimeCodeGeneratorTester_LDADD = \
+    $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+olad_plugin_api_UniverseTester_SOURCES = \
+    olad/plugin_api/DiscoverySchedulerTest.cpp \
+    olad/plugin_api/FadeEngineTest.cpp \
+    olad/plugin_api/FrameClockTest.cpp \
+    olad/plugin_api/FrameHistoryTest.cpp \
+    olad/plugin_api/InputTraceTest.cpp \
+    olad/plugin_api/RDMPollerTest.cpp \
+    olad/plugin_api/RDMResponderStatsTest.cpp \
+    olad/plugin_api/UniverseTest.cpp \
+    olad/plugin_api/VirtualUniverseManagerTest.cpp
+olad_plugin_api_UniverseTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
 olad_plugin_api_UniverseTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+# BENCHMARKS
+##################################################
+# The benchmark & replay tool use the mock ports from TestCommon.h, so they're
+# only built with the tests. They're not run by make check.
+if BUILD_TESTS
+check_PROGRAMS += olad/plugin_api/universe_benchmark \
+                  olad/plugin_api/universe_replay
+endif
+
+olad_plugin_api_universe_benchmark_SOURCES = \
+    olad/plugin_api/universe_benchmark.cpp
+olad_plugin_api_universe_benchmark_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_universe_benchmark_LDADD = \
+    $(CPPUNIT_LIBS) \
+    $(libprotobuf_LIBS) \
+    olad/plugin_api/libolaserverplugininterface.la \
+    common/libolacommon.la
+
+olad_plugin_api_universe_replay_SOURCES = olad/plugin_api/universe_replay.cpp
+olad_plugin_api_universe_replay_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_universe_replay_LDADD = \
+    $(CPPUNIT_LIBS) \
+    $(libprotobuf_LIBS) \
+    olad/plugin_api/libolaserverplugininterface.la \
+    common/libolacommon.la
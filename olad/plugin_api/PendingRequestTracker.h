@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PendingRequestTracker.h
+ * Tracks the outstanding requests made on behalf of clients or ports.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_PENDINGREQUESTTRACKER_H_
+#define OLAD_PLUGIN_API_PENDINGREQUESTTRACKER_H_
+
+#include <map>
+#include "ola/base/Macro.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+
+/**
+ * @brief The handle for a request tracked by a PendingRequestTracker.
+ *
+ * This is opaque to callers, it's passed back to
+ * PendingRequestTracker::Finish() once the request completes.
+ */
+class PendingRequest {
+ private:
+  struct OwnerEntry {
+    PendingRequest *head;
+    unsigned int count;
+
+    OwnerEntry() : head(NULL), count(0) {}
+  };
+
+  // NULL once the owner has been removed.
+  OwnerEntry *m_owner;
+  PendingRequest *m_previous;
+  PendingRequest *m_next;
+
+  explicit PendingRequest(OwnerEntry *owner)
+      : m_owner(owner),
+        m_previous(NULL),
+        m_next(NULL) {
+  }
+
+  template <typename Owner>
+  friend class PendingRequestTracker;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingRequest);
+};
+
+
+/**
+ * @brief Tracks the outstanding requests for a set of owners.
+ *
+ * The brokers hand requests to a universe on behalf of an owner, a Client or
+ * a Port, which may go away before the request completes. Each request is
+ * given a PendingRequest handle, which is linked into a list for its owner.
+ * When the request completes, the handle says if the owner still exists
+ * without any lookups, and when an owner is removed only its own requests are
+ * touched.
+ *
+ * Because the handle is unlinked from the owner when the owner is removed, a
+ * new owner allocated at the same address won't receive the responses for the
+ * old one.
+ *
+ * Handles are freed by Finish(), which doesn't use the tracker. A request that
+ * completes after the tracker has been destroyed is treated as orphaned.
+ *
+ * This isn't thread safe.
+ */
+template <typename Owner>
+class PendingRequestTracker {
+ public:
+  PendingRequestTracker() {}
+
+  ~PendingRequestTracker() {
+    typename OwnerMap::iterator iter = m_owners.begin();
+    for (; iter != m_owners.end(); ++iter) {
+      Orphan(iter->second);
+    }
+  }
+
+  /**
+   * @brief Add an owner.
+   * @param owner the owner to add, ownership is not transferred.
+   */
+  void AddOwner(const Owner *owner) {
+    if (!STLContains(m_owners, owner)) {
+      m_owners[owner] = new PendingRequest::OwnerEntry();
+    }
+  }
+
+  /**
+   * @brief Remove an owner.
+   *
+   * The outstanding requests for the owner are orphaned, Finish() will return
+   * false for them.
+   */
+  void RemoveOwner(const Owner *owner) {
+    PendingRequest::OwnerEntry *entry = STLLookupAndRemovePtr(&m_owners,
+                                                               owner);
+    if (entry) {
+      Orphan(entry);
+    }
+  }
+
+  /**
+   * @brief Check if an owner exists.
+   */
+  bool Contains(const Owner *owner) const {
+    return STLContains(m_owners, owner);
+  }
+
+  /**
+   * @brief The number of outstanding requests for an owner.
+   */
+  unsigned int Outstanding(const Owner *owner) const {
+    PendingRequest::OwnerEntry *const *entry = STLFind(&m_owners, owner);
+    return entry ? (*entry)->count : 0;
+  }
+
+  /**
+   * @brief Start tracking a request.
+   * @param owner the owner of the request. If the owner doesn't exist the
+   *   request is orphaned from the start.
+   * @returns the handle for the request, this must be passed to Finish().
+   */
+  PendingRequest *Start(const Owner *owner) {
+    PendingRequest::OwnerEntry *entry = STLFindOrNull(m_owners, owner);
+    PendingRequest *request = new PendingRequest(entry);
+    if (entry) {
+      request->m_next = entry->head;
+      if (entry->head) {
+        entry->head->m_previous = request;
+      }
+      entry->head = request;
+      entry->count++;
+    }
+    return request;
+  }
+
+  /**
+   * @brief Stop tracking a request.
+   * @param request the handle returned by Start(). This is deleted.
+   * @returns true if the owner of the request still exists, false if it has
+   *   been removed.
+   */
+  static bool Finish(PendingRequest *request) {
+    PendingRequest::OwnerEntry *entry = request->m_owner;
+    if (entry) {
+      if (request->m_previous) {
+        request->m_previous->m_next = request->m_next;
+      } else {
+        entry->head = request->m_next;
+      }
+      if (request->m_next) {
+        request->m_next->m_previous = request->m_previous;
+      }
+      entry->count--;
+    }
+    delete request;
+    return entry != NULL;
+  }
+
+ private:
+  typedef std::map<const Owner*, PendingRequest::OwnerEntry*> OwnerMap;
+
+  OwnerMap m_owners;
+
+  static void Orphan(PendingRequest::OwnerEntry *entry) {
+    PendingRequest *request = entry->head;
+    while (request) {
+      PendingRequest *next = request->m_next;
+      request->m_owner = NULL;
+      request->m_previous = NULL;
+      request->m_next = NULL;
+      request = next;
+    }
+    delete entry;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(PendingRequestTracker);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_PENDINGREQUESTTRACKER_H_
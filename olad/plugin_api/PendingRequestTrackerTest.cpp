@@ -0,0 +1,158 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PendingRequestTrackerTest.cpp
+ * Test fixture for the PendingRequestTracker class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "olad/plugin_api/PendingRequestTracker.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::PendingRequest;
+
+class PendingRequestTrackerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PendingRequestTrackerTest);
+  CPPUNIT_TEST(testStartAndFinish);
+  CPPUNIT_TEST(testRemoveOwner);
+  CPPUNIT_TEST(testOwnerReuse);
+  CPPUNIT_TEST(testUnknownOwner);
+  CPPUNIT_TEST(testTrackerDestroyed);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testStartAndFinish();
+    void testRemoveOwner();
+    void testOwnerReuse();
+    void testUnknownOwner();
+    void testTrackerDestroyed();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PendingRequestTrackerTest);
+
+class Owner {};
+typedef ola::PendingRequestTracker<Owner> Tracker;
+
+
+/*
+ * Check that requests are tracked per owner & can finish in any order.
+ */
+void PendingRequestTrackerTest::testStartAndFinish() {
+  Tracker tracker;
+  Owner owner1, owner2;
+  tracker.AddOwner(&owner1);
+  tracker.AddOwner(&owner2);
+  OLA_ASSERT_TRUE(tracker.Contains(&owner1));
+  OLA_ASSERT_EQ(0u, tracker.Outstanding(&owner1));
+
+  PendingRequest *request1 = tracker.Start(&owner1);
+  PendingRequest *request2 = tracker.Start(&owner1);
+  PendingRequest *request3 = tracker.Start(&owner1);
+  PendingRequest *request4 = tracker.Start(&owner2);
+  OLA_ASSERT_EQ(3u, tracker.Outstanding(&owner1));
+  OLA_ASSERT_EQ(1u, tracker.Outstanding(&owner2));
+
+  // Middle, head & tail of the list.
+  OLA_ASSERT_TRUE(Tracker::Finish(request2));
+  OLA_ASSERT_EQ(2u, tracker.Outstanding(&owner1));
+  OLA_ASSERT_TRUE(Tracker::Finish(request3));
+  OLA_ASSERT_TRUE(Tracker::Finish(request1));
+  OLA_ASSERT_EQ(0u, tracker.Outstanding(&owner1));
+  OLA_ASSERT_EQ(1u, tracker.Outstanding(&owner2));
+
+  OLA_ASSERT_TRUE(Tracker::Finish(request4));
+  OLA_ASSERT_EQ(0u, tracker.Outstanding(&owner2));
+}
+
+
+/*
+ * Check that removing an owner orphans only its requests.
+ */
+void PendingRequestTrackerTest::testRemoveOwner() {
+  Tracker tracker;
+  Owner owner1, owner2;
+  tracker.AddOwner(&owner1);
+  tracker.AddOwner(&owner2);
+
+  PendingRequest *request1 = tracker.Start(&owner1);
+  PendingRequest *request2 = tracker.Start(&owner1);
+  PendingRequest *request3 = tracker.Start(&owner2);
+
+  tracker.RemoveOwner(&owner1);
+  OLA_ASSERT_FALSE(tracker.Contains(&owner1));
+  OLA_ASSERT_EQ(0u, tracker.Outstanding(&owner1));
+  OLA_ASSERT_EQ(1u, tracker.Outstanding(&owner2));
+
+  OLA_ASSERT_FALSE(Tracker::Finish(request2));
+  OLA_ASSERT_FALSE(Tracker::Finish(request1));
+  OLA_ASSERT_TRUE(Tracker::Finish(request3));
+
+  // Removing an unknown owner is a no-op.
+  tracker.RemoveOwner(&owner1);
+}
+
+
+/*
+ * Check that an owner added at the same address as a removed one doesn't get
+ * the old requests.
+ */
+void PendingRequestTrackerTest::testOwnerReuse() {
+  Tracker tracker;
+  Owner owner;
+  tracker.AddOwner(&owner);
+  PendingRequest *old_request = tracker.Start(&owner);
+  tracker.RemoveOwner(&owner);
+
+  tracker.AddOwner(&owner);
+  PendingRequest *new_request = tracker.Start(&owner);
+  OLA_ASSERT_EQ(1u, tracker.Outstanding(&owner));
+
+  OLA_ASSERT_FALSE(Tracker::Finish(old_request));
+  OLA_ASSERT_EQ(1u, tracker.Outstanding(&owner));
+  OLA_ASSERT_TRUE(Tracker::Finish(new_request));
+  OLA_ASSERT_EQ(0u, tracker.Outstanding(&owner));
+}
+
+
+/*
+ * Check that requests for an unknown owner are orphaned from the start.
+ */
+void PendingRequestTrackerTest::testUnknownOwner() {
+  Tracker tracker;
+  Owner owner;
+  PendingRequest *request = tracker.Start(&owner);
+  OLA_ASSERT_EQ(0u, tracker.Outstanding(&owner));
+  OLA_ASSERT_FALSE(Tracker::Finish(request));
+}
+
+
+/*
+ * Check that requests can finish after the tracker has been destroyed.
+ */
+void PendingRequestTrackerTest::testTrackerDestroyed() {
+  Owner owner;
+  PendingRequest *request1, *request2;
+  {
+    Tracker tracker;
+    tracker.AddOwner(&owner);
+    request1 = tracker.Start(&owner);
+    request2 = tracker.Start(&owner);
+  }
+  OLA_ASSERT_FALSE(Tracker::Finish(request1));
+  OLA_ASSERT_FALSE(Tracker::Finish(request2));
+}
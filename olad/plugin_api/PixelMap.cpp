@@ -0,0 +1,140 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelMap.cpp
+ * Assemble the data from many universes into a single frame.
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include "olad/PixelMap.h"
+
+#include <sstream>
+#include <string>
+#include "ola/Logging.h"
+
+namespace ola {
+
+using std::string;
+
+PixelMap::PixelMap(ola::thread::SchedulerInterface *scheduler,
+                   const Options &options,
+                   FrameCallback *callback)
+    : m_options(options),
+      m_scheduler(scheduler),
+      m_callback(callback),
+      m_frame(options.segments * options.slots_per_segment, 0),
+      m_active(options.segments, false),
+      m_updated(options.segments, false),
+      m_active_count(0),
+      m_updated_count(0),
+      m_timeout_id(ola::thread::INVALID_TIMEOUT) {
+}
+
+PixelMap::~PixelMap() {
+  CancelTimeout();
+}
+
+void PixelMap::SetActive(unsigned int segment, bool active) {
+  if (segment >= m_options.segments || m_active[segment] == active) {
+    return;
+  }
+
+  m_active[segment] = active;
+  if (active) {
+    m_active_count++;
+  } else {
+    m_active_count--;
+    if (m_updated[segment]) {
+      m_updated[segment] = false;
+      m_updated_count--;
+    }
+  }
+}
+
+bool PixelMap::Update(unsigned int segment, const DmxBuffer &buffer) {
+  if (segment >= m_options.segments) {
+    return false;
+  }
+
+  unsigned int length = m_options.slots_per_segment;
+  buffer.Get(&m_frame[segment * m_options.slots_per_segment], &length);
+
+  if (!m_updated[segment] && m_active[segment]) {
+    m_updated[segment] = true;
+    m_updated_count++;
+  }
+
+  if (m_updated_count >= m_active_count) {
+    Commit();
+  } else if (m_options.frame_timeout && m_scheduler &&
+             m_timeout_id == ola::thread::INVALID_TIMEOUT) {
+    m_timeout_id = m_scheduler->RegisterSingleTimeout(
+        m_options.frame_timeout,
+        NewSingleCallback(this, &PixelMap::FrameTimeout));
+  }
+  return true;
+}
+
+void PixelMap::Commit() {
+  CancelTimeout();
+  m_updated.assign(m_options.segments, false);
+  m_updated_count = 0;
+  if (m_callback.get() && !m_frame.empty()) {
+    m_callback->Run(&m_frame[0], m_frame.size());
+  }
+}
+
+void PixelMap::FrameTimeout() {
+  m_timeout_id = ola::thread::INVALID_TIMEOUT;
+  OLA_DEBUG << "Committing partial frame, " << m_updated_count << " of "
+            << m_active_count << " segments updated";
+  Commit();
+}
+
+void PixelMap::CancelTimeout() {
+  if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout_id);
+    m_timeout_id = ola::thread::INVALID_TIMEOUT;
+  }
+}
+
+
+PixelMapOutputPort::PixelMapOutputPort(AbstractDevice *parent,
+                                       unsigned int port_id,
+                                       PixelMap *pixel_map,
+                                       unsigned int segment)
+    : BasicOutputPort(parent, port_id),
+      m_pixel_map(pixel_map),
+      m_segment(segment) {
+}
+
+bool PixelMapOutputPort::WriteDMX(const DmxBuffer &buffer,
+                                  OLA_UNUSED uint8_t priority) {
+  return m_pixel_map->Update(m_segment, buffer);
+}
+
+void PixelMapOutputPort::PostSetUniverse(OLA_UNUSED Universe *old_universe,
+                                         Universe *new_universe) {
+  m_pixel_map->SetActive(m_segment, new_universe != NULL);
+}
+
+string PixelMapOutputPort::Description() const {
+  const unsigned int slots = m_pixel_map->SlotsPerSegment();
+  std::ostringstream str;
+  str << "Slots " << m_segment * slots + 1 << " - "
+      << (m_segment + 1) * slots;
+  return str.str();
+}
+}  // namespace ola
@@ -0,0 +1,128 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelMapTest.cpp
+ * Test fixture for the PixelMap class
+ * Copyright (C) 2015 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "olad/PixelMap.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::PixelMap;
+using std::string;
+
+class PixelMapTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PixelMapTest);
+  CPPUNIT_TEST(testCommit);
+  CPPUNIT_TEST(testInactiveSegments);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    PixelMapTest() : m_frame_count(0) {}
+
+    void testCommit();
+    void testInactiveSegments();
+
+ private:
+    unsigned int m_frame_count;
+    string m_frame;
+
+    PixelMap *NewMap();
+
+    void NewFrame(const uint8_t *data, unsigned int length) {
+      m_frame.assign(reinterpret_cast<const char*>(data), length);
+      m_frame_count++;
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelMapTest);
+
+
+PixelMap *PixelMapTest::NewMap() {
+  PixelMap::Options options;
+  options.segments = 3;
+  options.slots_per_segment = 2;
+  options.frame_timeout = 0;
+  return new PixelMap(NULL, options,
+                      ola::NewCallback(this, &PixelMapTest::NewFrame));
+}
+
+
+/*
+ * Check that a frame is committed once all the active segments are updated.
+ */
+void PixelMapTest::testCommit() {
+  std::auto_ptr<PixelMap> pixel_map(NewMap());
+  OLA_ASSERT_EQ(6u, pixel_map->FrameSize());
+  for (unsigned int i = 0; i < 3; i++) {
+    pixel_map->SetActive(i, true);
+  }
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT_TRUE(pixel_map->Update(1, buffer));
+  buffer.SetFromString("4");
+  OLA_ASSERT_TRUE(pixel_map->Update(0, buffer));
+  // Updating the same segment again doesn't complete the frame.
+  buffer.SetFromString("5,6");
+  OLA_ASSERT_TRUE(pixel_map->Update(0, buffer));
+  OLA_ASSERT_EQ(0u, m_frame_count);
+
+  buffer.SetFromString("7,8");
+  OLA_ASSERT_TRUE(pixel_map->Update(2, buffer));
+  OLA_ASSERT_EQ(1u, m_frame_count);
+  OLA_ASSERT_EQ(string("\x05\x06\x01\x02\x07\x08", 6), m_frame);
+
+  OLA_ASSERT_FALSE(pixel_map->Update(3, buffer));
+
+  // A forced commit sends whatever we have.
+  buffer.SetFromString("9,10");
+  OLA_ASSERT_TRUE(pixel_map->Update(1, buffer));
+  OLA_ASSERT_EQ(1u, m_frame_count);
+  pixel_map->Commit();
+  OLA_ASSERT_EQ(2u, m_frame_count);
+  OLA_ASSERT_EQ(string("\x05\x06\x09\x0a\x07\x08", 6), m_frame);
+}
+
+
+/*
+ * Check that segments which aren't patched aren't waited on.
+ */
+void PixelMapTest::testInactiveSegments() {
+  std::auto_ptr<PixelMap> pixel_map(NewMap());
+  pixel_map->SetActive(0, true);
+  pixel_map->SetActive(2, true);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2");
+  OLA_ASSERT_TRUE(pixel_map->Update(0, buffer));
+  OLA_ASSERT_EQ(0u, m_frame_count);
+  OLA_ASSERT_TRUE(pixel_map->Update(2, buffer));
+  OLA_ASSERT_EQ(1u, m_frame_count);
+
+  // Unpatching a segment completes a frame that was waiting on it.
+  OLA_ASSERT_TRUE(pixel_map->Update(0, buffer));
+  pixel_map->SetActive(2, false);
+  OLA_ASSERT_TRUE(pixel_map->Update(0, buffer));
+  OLA_ASSERT_EQ(2u, m_frame_count);
+}
@@ -63,6 +63,26 @@ bool Plugin::LoadPreferences() {
   return true;
 }
 
+bool Plugin::ReloadPreferences() {
+  if (!m_preferences || !m_preferences->Reload()) {
+    return false;
+  }
+
+  // The file may have been edited by hand, so put back any missing defaults.
+  bool save = m_preferences->SetDefaultValue(
+      ENABLED_KEY,
+      BoolValidator(),
+      DefaultMode());
+  if (save) {
+    m_preferences->Save();
+  }
+
+  if (!SetDefaultPreferences()) {
+    OLA_INFO << Name() << ", SetDefaultPreferences failed";
+  }
+  return true;
+}
+
 string Plugin::PreferenceConfigLocation() const {
   return m_preferences->ConfigLocation();
 }
@@ -21,10 +21,12 @@
 
 #include <string>
 #include "ola/Callback.h"
+#include "ola/Logging.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
 #include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/PluginThread.h"
 
 namespace ola {
 
@@ -37,87 +39,109 @@ PluginAdaptor::PluginAdaptor(DeviceManager *device_manager,
                              ExportMap *export_map,
                              PreferencesFactory *preferences_factory,
                              PortBrokerInterface *port_broker,
-                             const std::string *instance_name):
+                             const std::string *instance_name,
+                             ola::network::TransmitPacer *transmit_pacer):
   m_device_manager(device_manager),
   m_ss(select_server),
   m_export_map(export_map),
   m_preferences_factory(preferences_factory),
   m_port_broker(port_broker),
-  m_instance_name(instance_name) {
+  m_instance_name(instance_name),
+  m_transmit_pacer(transmit_pacer) {
 }
 
 bool PluginAdaptor::AddReadDescriptor(
     ola::io::ReadFileDescriptor *descriptor) {
-  return m_ss->AddReadDescriptor(descriptor);
+  return SelectServer()->AddReadDescriptor(descriptor);
 }
 
 bool PluginAdaptor::AddReadDescriptor(
     ola::io::ConnectedDescriptor *descriptor,
     bool delete_on_close) {
-  return m_ss->AddReadDescriptor(descriptor, delete_on_close);
+  return SelectServer()->AddReadDescriptor(descriptor, delete_on_close);
 }
 
 void PluginAdaptor::RemoveReadDescriptor(
     ola::io::ReadFileDescriptor *descriptor) {
-  m_ss->RemoveReadDescriptor(descriptor);
+  SelectServer()->RemoveReadDescriptor(descriptor);
 }
 
 void PluginAdaptor::RemoveReadDescriptor(
     ola::io::ConnectedDescriptor *descriptor) {
-  m_ss->RemoveReadDescriptor(descriptor);
+  SelectServer()->RemoveReadDescriptor(descriptor);
 }
 
 bool PluginAdaptor::AddWriteDescriptor(
     ola::io::WriteFileDescriptor *descriptor) {
-  return m_ss->AddWriteDescriptor(descriptor);
+  return SelectServer()->AddWriteDescriptor(descriptor);
 }
 
 void PluginAdaptor::RemoveWriteDescriptor(
     ola::io::WriteFileDescriptor *descriptor) {
-  m_ss->RemoveWriteDescriptor(descriptor);
+  SelectServer()->RemoveWriteDescriptor(descriptor);
 }
 
 timeout_id PluginAdaptor::RegisterRepeatingTimeout(
     unsigned int ms,
     Callback0<bool> *closure) {
-  return m_ss->RegisterRepeatingTimeout(ms, closure);
+  return SelectServer()->RegisterRepeatingTimeout(ms, closure);
 }
 
 timeout_id PluginAdaptor::RegisterRepeatingTimeout(
     const TimeInterval &interval,
     Callback0<bool> *closure) {
-  return m_ss->RegisterRepeatingTimeout(interval, closure);
+  return SelectServer()->RegisterRepeatingTimeout(interval, closure);
 }
 
 timeout_id PluginAdaptor::RegisterSingleTimeout(
     unsigned int ms,
     SingleUseCallback0<void> *closure) {
-  return m_ss->RegisterSingleTimeout(ms, closure);
+  return SelectServer()->RegisterSingleTimeout(ms, closure);
 }
 
 timeout_id PluginAdaptor::RegisterSingleTimeout(
     const TimeInterval &interval,
     SingleUseCallback0<void> *closure) {
-  return m_ss->RegisterSingleTimeout(interval, closure);
+  return SelectServer()->RegisterSingleTimeout(interval, closure);
 }
 
 void PluginAdaptor::RemoveTimeout(timeout_id id) {
-  m_ss->RemoveTimeout(id);
+  SelectServer()->RemoveTimeout(id);
 }
 
 void PluginAdaptor::Execute(ola::BaseCallback0<void> *closure) {
-  m_ss->Execute(closure);
+  SelectServer()->Execute(closure);
 }
 
 void PluginAdaptor::DrainCallbacks() {
-  m_ss->DrainCallbacks();
+  SelectServer()->DrainCallbacks();
 }
 
 bool PluginAdaptor::RegisterDevice(AbstractDevice *device) const {
+  PluginThread *thread = PluginThread::Current();
+  if (thread && thread->IsStarting()) {
+    // The main thread registers the device once Start() returns.
+    thread->AddStartingDevice(device);
+    return true;
+  }
+  if (!CanAccessCore()) {
+    OLA_WARN << "Devices on a plugin thread can only be registered from "
+             << "Start()";
+    return false;
+  }
   return m_device_manager->RegisterDevice(device);
 }
 
 bool PluginAdaptor::UnregisterDevice(AbstractDevice *device) const {
+  PluginThread *thread = PluginThread::Current();
+  if (thread && thread->IsStarting()) {
+    return thread->RemoveStartingDevice(device);
+  }
+  if (!CanAccessCore()) {
+    OLA_WARN << "Devices on a plugin thread can only be unregistered from "
+             << "Stop()";
+    return false;
+  }
   return m_device_manager->UnregisterDevice(device);
 }
 
@@ -126,7 +150,21 @@ Preferences *PluginAdaptor::NewPreference(const string &name) const {
 }
 
 const TimeStamp *PluginAdaptor::WakeUpTime() const {
-  return m_ss->WakeUpTime();
+  return SelectServer()->WakeUpTime();
+}
+
+SelectServerInterface *PluginAdaptor::SelectServer() const {
+  PluginThread *thread = PluginThread::Current();
+  return thread ? thread->GetSelectServer() : m_ss;
+}
+
+ola::network::TransmitPacer *PluginAdaptor::GetTransmitPacer() const {
+  return PluginThread::Current() ? NULL : m_transmit_pacer;
+}
+
+bool PluginAdaptor::CanAccessCore() const {
+  PluginThread *thread = PluginThread::Current();
+  return !thread || thread->InSynchronousCall();
 }
 
 const std::string PluginAdaptor::InstanceName() const {
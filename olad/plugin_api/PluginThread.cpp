@@ -0,0 +1,534 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThread.cpp
+ * Runs a plugin in its own thread, with its own SelectServer.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/PluginThread.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/util/StallWatchdog.h"
+
+namespace ola {
+
+using ola::io::SelectServer;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UIDSet;
+using ola::thread::Future;
+using std::auto_ptr;
+using std::string;
+
+namespace {
+
+pthread_key_t current_thread_key;
+pthread_once_t current_thread_once = PTHREAD_ONCE_INIT;
+
+void CreateCurrentThreadKey() {
+  pthread_key_create(&current_thread_key, NULL);
+}
+
+void InputBufferCopy(BasicInputPort *port, DmxSource *source) {
+  auto_ptr<DmxSource> source_ptr(source);
+  port->UpdateSource(*source);
+}
+
+void RunRDMCallbackWithReply(RDMCallback *callback, RDMReply *reply) {
+  auto_ptr<RDMReply> reply_ptr(reply);
+  callback->Run(reply);
+}
+
+void RunDiscoveryCallbackWithUIDs(RDMDiscoveryCallback *callback,
+                                  UIDSet *uids) {
+  auto_ptr<UIDSet> uids_ptr(uids);
+  callback->Run(*uids);
+}
+
+// These are run on the PluginThread.
+void SendRDMRequestOnThread(OutputPort *port,
+                            RDMRequest *request,
+                            RDMCallback *callback) {
+  port->SendRDMRequest(
+      request, PluginThread::Current()->ReturnRDMCallbackToMain(callback));
+}
+
+void RunDiscoveryOnThread(OutputPort *port,
+                          RDMDiscoveryCallback *callback,
+                          bool full) {
+  RDMDiscoveryCallback *on_complete =
+      PluginThread::Current()->ReturnDiscoveryCallbackToMain(callback);
+  if (full) {
+    port->RunFullDiscovery(on_complete);
+  } else {
+    port->RunIncrementalDiscovery(on_complete);
+  }
+}
+
+void UniverseNameChangedOnThread(OutputPort *port, const string *name) {
+  port->UniverseNameChanged(*name);
+}
+
+bool SendTimeCodeOnThread(OutputPort *port,
+                          const ola::timecode::TimeCode *timecode) {
+  return port->SendTimeCode(*timecode);
+}
+
+void DescriptionOnThread(const Port *port, string *description) {
+  *description = port->Description();
+}
+
+typedef struct {
+  AbstractDevice *device;
+  ola::rpc::RpcController *controller;
+  const string *request;
+  string *response;
+  AbstractDevice::ConfigureCallback *done;
+} ConfigureArgs;
+
+void ConfigureOnThread(ConfigureArgs *args_ptr) {
+  auto_ptr<ConfigureArgs> args(args_ptr);
+  PluginThread *thread = PluginThread::Current();
+  args->device->Configure(
+      args->controller, *args->request, args->response,
+      NewSingleCallback(thread, &PluginThread::ReturnToMain, args->done));
+}
+}  // namespace
+
+
+const unsigned int PluginThread::QUEUE_SIZE;
+
+PluginThread::PluginThread(const string &name,
+                           ola::io::SelectServerInterface *main_ss)
+    : Thread(Thread::Options(name)),
+      m_main_ss(main_ss),
+      m_output_queue(QUEUE_SIZE),
+      m_input_queue(QUEUE_SIZE),
+      m_output_pending(false),
+      m_input_pending(false),
+      m_in_sync_call(false),
+      m_generation(0),
+      m_starting(false) {
+}
+
+PluginThread::~PluginThread() {
+  Stop();
+}
+
+bool PluginThread::Start() {
+  return Thread::Start();
+}
+
+bool PluginThread::Stop() {
+  if (!IsRunning()) {
+    return false;
+  }
+  m_ss.Execute(NewSingleCallback(&m_ss, &SelectServer::Terminate));
+  return Join();
+}
+
+bool PluginThread::RunAndWait(BaseCallback0<bool> *callback) {
+  if (Current() == this) {
+    return callback->Run();
+  }
+  Future<bool> future;
+  m_ss.Execute(NewSingleCallback(this, &PluginThread::RunBoolSynchronously,
+                                 callback, &future));
+  return future.Get();
+}
+
+void PluginThread::RunAndWait(BaseCallback0<void> *callback) {
+  if (Current() == this) {
+    callback->Run();
+    return;
+  }
+  Future<void> future;
+  m_ss.Execute(NewSingleCallback(this, &PluginThread::RunVoidSynchronously,
+                                 callback, &future));
+  future.Get();
+}
+
+void PluginThread::Execute(BaseCallback0<void> *callback) {
+  m_ss.Execute(callback);
+}
+
+void PluginThread::PluginStopped() {
+  __atomic_add_fetch(&m_generation, 1, __ATOMIC_SEQ_CST);
+
+  InputFrame frame;
+  while (m_input_queue.Pop(&frame)) {}
+
+  if (IsRunning()) {
+    RunAndWait(NewSingleCallback(this, &PluginThread::DiscardOutput));
+  }
+}
+
+void PluginThread::QueueDMX(OutputPort *port,
+                            const DmxBuffer &buffer,
+                            uint8_t priority) {
+  OutputFrame frame;
+  frame.port = port;
+  frame.priority = priority;
+  frame.length = sizeof(frame.data);
+  buffer.Get(frame.data, &frame.length);
+
+  // If the plugin thread has fallen behind, this replaces any earlier frame
+  // for the port that's waiting in the overflow list.
+  m_output_queue.Push(frame);
+
+  if (!__atomic_exchange_n(&m_output_pending, true, __ATOMIC_SEQ_CST)) {
+    m_ss.Execute(NewSingleCallback(this, &PluginThread::DrainOutput));
+  }
+}
+
+bool PluginThread::InSynchronousCall() const {
+  return m_in_sync_call;
+}
+
+void PluginThread::ExecuteOnMain(BaseCallback0<void> *callback) {
+  if (InSynchronousCall()) {
+    callback->Run();
+    return;
+  }
+  m_main_ss->Execute(NewSingleCallback(this, &PluginThread::RunIfCurrent,
+                                       Generation(), callback));
+}
+
+void PluginThread::ReturnToMain(BaseCallback0<void> *callback) {
+  if (InSynchronousCall()) {
+    callback->Run();
+    return;
+  }
+  m_main_ss->Execute(callback);
+}
+
+void PluginThread::QueueInput(BasicInputPort *port,
+                              const DmxBuffer &buffer,
+                              const TimeStamp &timestamp,
+                              uint8_t priority,
+                              const DmxBuffer *slot_priorities) {
+  // The DmxBuffer reference count isn't thread safe, so these need a copy of
+  // the data as well.
+  if (slot_priorities) {
+    // Slot priorities are rare, so they don't get space in the queue.
+    DmxSource *source = new DmxSource(
+        DmxBuffer(buffer.GetRaw(), buffer.Size()), timestamp, priority,
+        DmxBuffer(slot_priorities->GetRaw(), slot_priorities->Size()));
+    if (InSynchronousCall()) {
+      InputBufferCopy(port, source);
+    } else {
+      ExecuteOnMain(NewSingleCallback(&InputBufferCopy, port, source));
+    }
+    return;
+  }
+
+  if (InSynchronousCall()) {
+    port->UpdateSource(DmxSource(DmxBuffer(buffer.GetRaw(), buffer.Size()),
+                                 timestamp, priority));
+    return;
+  }
+
+  InputFrame frame;
+  frame.port = port;
+  frame.timestamp = timestamp;
+  frame.priority = priority;
+  frame.length = sizeof(frame.data);
+  buffer.Get(frame.data, &frame.length);
+
+  m_input_queue.Push(frame);
+
+  if (!__atomic_exchange_n(&m_input_pending, true, __ATOMIC_SEQ_CST)) {
+    m_main_ss->Execute(NewSingleCallback(this, &PluginThread::DrainInput));
+  }
+}
+
+RDMCallback *PluginThread::ReturnRDMCallbackToMain(RDMCallback *callback) {
+  return NewSingleCallback(this, &PluginThread::RDMComplete, true, 0u,
+                           callback);
+}
+
+RDMDiscoveryCallback *PluginThread::ReturnDiscoveryCallbackToMain(
+    RDMDiscoveryCallback *callback) {
+  return NewSingleCallback(this, &PluginThread::DiscoveryComplete, true, 0u,
+                           callback);
+}
+
+RDMCallback *PluginThread::ReturnRDMCallbackToPlugin(RDMCallback *callback) {
+  return NewSingleCallback(this, &PluginThread::RDMComplete, false,
+                           Generation(), callback);
+}
+
+RDMDiscoveryCallback *PluginThread::ReturnDiscoveryCallbackToPlugin(
+    RDMDiscoveryCallback *callback) {
+  return NewSingleCallback(this, &PluginThread::DiscoveryComplete, false,
+                           Generation(), callback);
+}
+
+void PluginThread::BeginStart() {
+  m_starting = true;
+  m_starting_devices.clear();
+}
+
+void PluginThread::EndStart(std::vector<AbstractDevice*> *devices) {
+  m_starting = false;
+  devices->swap(m_starting_devices);
+  m_starting_devices.clear();
+}
+
+void PluginThread::AddStartingDevice(AbstractDevice *device) {
+  m_starting_devices.push_back(device);
+}
+
+bool PluginThread::RemoveStartingDevice(AbstractDevice *device) {
+  std::vector<AbstractDevice*>::iterator iter = std::find(
+      m_starting_devices.begin(), m_starting_devices.end(), device);
+  if (iter == m_starting_devices.end()) {
+    return false;
+  }
+  m_starting_devices.erase(iter);
+  return true;
+}
+
+PluginThread *PluginThread::Current() {
+  pthread_once(&current_thread_once, CreateCurrentThreadKey);
+  return reinterpret_cast<PluginThread*>(
+      pthread_getspecific(current_thread_key));
+}
+
+void *PluginThread::Run() {
+  pthread_once(&current_thread_once, CreateCurrentThreadKey);
+  pthread_setspecific(current_thread_key, this);
+  auto_ptr<ola::Heartbeat> heartbeat;
+  if (ola::StallWatchdog::Enabled()) {
+    heartbeat.reset(new ola::Heartbeat(Name()));
+    m_ss.SetHeartbeat(heartbeat.get());
+  }
+  m_ss.Run();
+  m_ss.SetHeartbeat(NULL);
+  pthread_setspecific(current_thread_key, NULL);
+  return NULL;
+}
+
+/*
+ * Run on the plugin thread.
+ */
+void PluginThread::DrainOutput() {
+  // Clear the flag first, so anything pushed after the queue is emptied
+  // schedules another drain.
+  __atomic_store_n(&m_output_pending, false, __ATOMIC_SEQ_CST);
+  OutputFrame frame;
+  while (m_output_queue.Pop(&frame)) {
+    frame.port->WriteDMX(DmxBuffer(frame.data, frame.length), frame.priority);
+  }
+}
+
+/*
+ * Run on the main thread.
+ */
+void PluginThread::DrainInput() {
+  __atomic_store_n(&m_input_pending, false, __ATOMIC_SEQ_CST);
+  InputFrame frame;
+  while (m_input_queue.Pop(&frame)) {
+    frame.port->UpdateSource(
+        DmxSource(DmxBuffer(frame.data, frame.length), frame.timestamp,
+                  frame.priority));
+  }
+}
+
+/*
+ * Run on the plugin thread.
+ */
+void PluginThread::DiscardOutput() {
+  OutputFrame frame;
+  while (m_output_queue.Pop(&frame)) {}
+}
+
+void PluginThread::RunIfCurrent(unsigned int generation,
+                                BaseCallback0<void> *callback) {
+  if (generation == Generation()) {
+    callback->Run();
+  } else {
+    delete callback;
+  }
+}
+
+unsigned int PluginThread::Generation() const {
+  return __atomic_load_n(&m_generation, __ATOMIC_SEQ_CST);
+}
+
+void PluginThread::RDMComplete(bool to_main,
+                               unsigned int generation,
+                               RDMCallback *callback,
+                               RDMReply *reply) {
+  // The reply is only valid for the duration of this call.
+  const ola::rdm::RDMResponse *response = reply->Response();
+  RDMReply *reply_copy = new RDMReply(
+      reply->StatusCode(),
+      response ? response->Duplicate() : NULL,
+      reply->Frames());
+  BaseCallback0<void> *closure = NewSingleCallback(
+      &RunRDMCallbackWithReply, callback, reply_copy);
+  if (to_main) {
+    ReturnToMain(closure);
+  } else {
+    m_ss.Execute(NewSingleCallback(this, &PluginThread::RunIfCurrent,
+                                   generation, closure));
+  }
+}
+
+void PluginThread::DiscoveryComplete(bool to_main,
+                                     unsigned int generation,
+                                     RDMDiscoveryCallback *callback,
+                                     const UIDSet &uids) {
+  BaseCallback0<void> *closure = NewSingleCallback(
+      &RunDiscoveryCallbackWithUIDs, callback, new UIDSet(uids));
+  if (to_main) {
+    ReturnToMain(closure);
+  } else {
+    m_ss.Execute(NewSingleCallback(this, &PluginThread::RunIfCurrent,
+                                   generation, closure));
+  }
+}
+
+void PluginThread::RunBoolSynchronously(BaseCallback0<bool> *callback,
+                                        Future<bool> *future) {
+  m_in_sync_call = true;
+  bool ok = callback->Run();
+  m_in_sync_call = false;
+  future->Set(ok);
+}
+
+void PluginThread::RunVoidSynchronously(BaseCallback0<void> *callback,
+                                        Future<void> *future) {
+  m_in_sync_call = true;
+  callback->Run();
+  m_in_sync_call = false;
+  future->Set();
+}
+
+
+bool DispatchWriteDMX(OutputPort *port,
+                      const DmxBuffer &buffer,
+                      uint8_t priority) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread) {
+    return port->WriteDMX(buffer, priority);
+  } else if (thread == PluginThread::Current()) {
+    // The port may keep a reference to the buffer, so give it a copy.
+    return port->WriteDMX(DmxBuffer(buffer.GetRaw(), buffer.Size()),
+                          priority);
+  }
+  thread->QueueDMX(port, buffer, priority);
+  return true;
+}
+
+void DispatchRDMRequest(OutputPort *port,
+                        RDMRequest *request,
+                        RDMCallback *callback) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread || thread == PluginThread::Current()) {
+    port->SendRDMRequest(request, callback);
+    return;
+  }
+  thread->Execute(NewSingleCallback(&SendRDMRequestOnThread, port, request,
+                                    callback));
+}
+
+void DispatchRDMDiscovery(OutputPort *port,
+                          RDMDiscoveryCallback *callback,
+                          bool full) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread || thread == PluginThread::Current()) {
+    if (full) {
+      port->RunFullDiscovery(callback);
+    } else {
+      port->RunIncrementalDiscovery(callback);
+    }
+    return;
+  }
+  thread->Execute(NewSingleCallback(&RunDiscoveryOnThread, port, callback,
+                                    full));
+}
+
+bool DispatchSetUniverse(Port *port, Universe *universe) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread) {
+    return port->SetUniverse(universe);
+  }
+  return thread->RunAndWait(
+      NewSingleCallback(port, &Port::SetUniverse, universe));
+}
+
+void DispatchUniverseNameChanged(OutputPort *port, const string &name) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread) {
+    port->UniverseNameChanged(name);
+    return;
+  }
+  thread->RunAndWait(
+      NewSingleCallback(&UniverseNameChangedOnThread, port, &name));
+}
+
+bool DispatchSendTimeCode(OutputPort *port,
+                          const ola::timecode::TimeCode &timecode) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread) {
+    return port->SendTimeCode(timecode);
+  }
+  return thread->RunAndWait(
+      NewSingleCallback(&SendTimeCodeOnThread, port, &timecode));
+}
+
+string DispatchDescription(const Port *port) {
+  PluginThread *thread = PluginThread::ForPort(port);
+  if (!thread || thread == PluginThread::Current()) {
+    return port->Description();
+  }
+  string description;
+  thread->RunAndWait(
+      NewSingleCallback(&DescriptionOnThread, port, &description));
+  return description;
+}
+
+void DispatchConfigure(AbstractDevice *device,
+                       ola::rpc::RpcController *controller,
+                       const string &request,
+                       string *response,
+                       AbstractDevice::ConfigureCallback *done) {
+  PluginThread *thread = PluginThread::ForDevice(device);
+  if (!thread) {
+    device->Configure(controller, request, response, done);
+    return;
+  }
+  ConfigureArgs *args = new ConfigureArgs;
+  args->device = device;
+  args->controller = controller;
+  args->request = &request;
+  args->response = response;
+  args->done = done;
+  thread->Execute(NewSingleCallback(&ConfigureOnThread, args));
+}
+}  // namespace ola
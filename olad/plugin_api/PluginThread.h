@@ -0,0 +1,441 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThread.h
+ * Runs a plugin in its own thread, with its own SelectServer.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_PLUGINTHREAD_H_
+#define OLAD_PLUGIN_API_PLUGINTHREAD_H_
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/Future.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/SPSCQueue.h"
+#include "ola/thread/Thread.h"
+#include "ola/timecode/TimeCode.h"
+#include "olad/Device.h"
+#include "olad/DmxSource.h"
+#include "olad/Port.h"
+
+namespace ola {
+
+/**
+ * @brief A thread with its own SelectServer that a plugin's devices and ports
+ * run on.
+ *
+ * The plugin is started and stopped on this thread, so any descriptors and
+ * timeouts it registers with the PluginAdaptor end up on this thread's
+ * SelectServer, and any Devices it creates remember which thread they belong
+ * to.
+ *
+ * The rest of olad (universes, merging, the RPC & HTTP servers) stays on the
+ * main thread. DMX data crosses between the two using single producer, single
+ * consumer queues, everything else is passed as a callback.
+ *
+ * Calls from the main thread into the plugin are made using the Dispatch*
+ * functions below, which call the port directly if it doesn't belong to a
+ * PluginThread.
+ */
+class PluginThread: public ola::thread::Thread {
+ public:
+  /**
+   * @brief Create a new PluginThread.
+   * @param name the name of the thread.
+   * @param main_ss the SelectServer of the main thread.
+   */
+  PluginThread(const std::string &name,
+               ola::io::SelectServerInterface *main_ss);
+  ~PluginThread();
+
+  /**
+   * @brief Start the thread and wait for the SelectServer to be running.
+   */
+  bool Start();
+
+  /**
+   * @brief Stop the SelectServer and join the thread.
+   */
+  bool Stop();
+
+  /**
+   * @brief The SelectServer for this thread.
+   */
+  ola::io::SelectServer *GetSelectServer() { return &m_ss; }
+
+  /**
+   * @name Methods called from the main thread.
+   * @{
+   */
+
+  /**
+   * @brief Run a callback on this thread and wait for it to complete.
+   * @param callback the callback to run, ownership is transferred.
+   * @returns the return value of the callback.
+   *
+   * While the callback is running, the main thread is blocked so calls back
+   * into the core are made directly.
+   */
+  bool RunAndWait(BaseCallback0<bool> *callback);
+
+  /**
+   * @brief Run a callback on this thread and wait for it to complete.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void RunAndWait(BaseCallback0<void> *callback);
+
+  /**
+   * @brief Run a callback on this thread.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void Execute(BaseCallback0<void> *callback);
+
+  /**
+   * @brief Called once the plugin has stopped.
+   *
+   * This discards any DMX data still in the queues, and any callbacks from
+   * the plugin that were queued with ExecuteOnMain().
+   */
+  void PluginStopped();
+
+  /**
+   * @brief Queue DMX data to be sent on a port.
+   * @param port the port to send on.
+   * @param buffer the DMX data, this is copied.
+   * @param priority the priority of the data.
+   */
+  void QueueDMX(OutputPort *port, const DmxBuffer &buffer, uint8_t priority);
+  /**
+   * @}
+   */
+
+  /**
+   * @name Methods called from this thread.
+   * @{
+   */
+
+  /**
+   * @brief Check if the main thread is blocked in RunAndWait().
+   */
+  bool InSynchronousCall() const;
+
+  /**
+   * @brief Run a callback on the main thread.
+   * @param callback the callback to run, ownership is transferred.
+   *
+   * If the main thread is blocked in RunAndWait() the callback is run
+   * immediately. Otherwise it's queued, and discarded if the plugin is stopped
+   * before the main thread gets to it. Use this for callbacks that reference
+   * the plugin's ports.
+   */
+  void ExecuteOnMain(BaseCallback0<void> *callback);
+
+  /**
+   * @brief Return a callback to the main thread.
+   * @param callback the callback to run, ownership is transferred.
+   *
+   * Unlike ExecuteOnMain(), the callback is always run. Use this for callbacks
+   * that the main thread passed in, like RDM completion handlers.
+   */
+  void ReturnToMain(BaseCallback0<void> *callback);
+
+  /**
+   * @brief Pass new DMX data from an input port to the main thread.
+   * @param port the port the data arrived on.
+   * @param buffer the DMX data, this is copied.
+   * @param timestamp the time the data arrived.
+   * @param priority the priority of the data.
+   * @param slot_priorities the priority of each slot, or NULL. This is
+   *   copied.
+   */
+  void QueueInput(BasicInputPort *port,
+                  const DmxBuffer &buffer,
+                  const TimeStamp &timestamp,
+                  uint8_t priority,
+                  const DmxBuffer *slot_priorities = NULL);
+
+  /**
+   * @brief Wrap an RDM callback from the main thread so it can be run by a
+   * port on this thread.
+   * @param callback the callback from the main thread, ownership is
+   *   transferred.
+   * @returns a callback that copies the reply and runs the original callback
+   *   on the main thread.
+   */
+  ola::rdm::RDMCallback *ReturnRDMCallbackToMain(
+      ola::rdm::RDMCallback *callback);
+
+  /**
+   * @brief Wrap a discovery callback from the main thread so it can be run by
+   * a port on this thread.
+   */
+  ola::rdm::RDMDiscoveryCallback *ReturnDiscoveryCallbackToMain(
+      ola::rdm::RDMDiscoveryCallback *callback);
+
+  /**
+   * @brief Wrap an RDM callback from a port on this thread so it can be run
+   * by the main thread.
+   * @param callback the callback from the port, ownership is transferred.
+   * @returns a callback that copies the reply and runs the original callback
+   *   on this thread. It's discarded if the plugin is stopped first.
+   */
+  ola::rdm::RDMCallback *ReturnRDMCallbackToPlugin(
+      ola::rdm::RDMCallback *callback);
+
+  /**
+   * @brief Wrap a discovery callback from a port on this thread so it can be
+   * run by the main thread.
+   */
+  ola::rdm::RDMDiscoveryCallback *ReturnDiscoveryCallbackToPlugin(
+      ola::rdm::RDMDiscoveryCallback *callback);
+
+  /**
+   * @brief Called before the plugin is started without blocking the main
+   * thread.
+   *
+   * Until EndStart() is called, devices registered by the plugin are held
+   * here, and registered by the main thread once Start() returns.
+   */
+  void BeginStart();
+
+  /**
+   * @brief Called once the plugin's Start() has returned.
+   * @param[out] devices the devices registered during Start().
+   */
+  void EndStart(std::vector<AbstractDevice*> *devices);
+
+  /**
+   * @brief Check if the plugin is being started without blocking the main
+   * thread.
+   */
+  bool IsStarting() const { return m_starting; }
+
+  /**
+   * @brief Hold a device registered during Start().
+   */
+  void AddStartingDevice(AbstractDevice *device);
+
+  /**
+   * @brief Remove a device registered earlier in Start().
+   * @returns true if the device was found, false otherwise.
+   */
+  bool RemoveStartingDevice(AbstractDevice *device);
+  /**
+   * @}
+   */
+
+  /**
+   * @brief Return the PluginThread the caller is running on.
+   * @returns the PluginThread, or NULL if called from any other thread.
+   */
+  static PluginThread *Current();
+
+  /**
+   * @brief Return the PluginThread a device belongs to.
+   * @returns the PluginThread, or NULL if the device runs on the main thread.
+   */
+  static PluginThread *ForDevice(const AbstractDevice *device) {
+    return device ? device->GetPluginThread() : NULL;
+  }
+
+  /**
+   * @brief Return the PluginThread a port belongs to.
+   * @returns the PluginThread, or NULL if the port runs on the main thread.
+   */
+  static PluginThread *ForPort(const Port *port) {
+    return ForDevice(port->GetDevice());
+  }
+
+  static const unsigned int QUEUE_SIZE = 256;
+
+ protected:
+  void *Run();
+
+ private:
+  // The frames hold a copy of the slot data rather than a DmxBuffer, since
+  // the DmxBuffer reference count isn't thread safe.
+  typedef struct {
+    OutputPort *port;
+    uint8_t priority;
+    unsigned int length;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+  } OutputFrame;
+
+  typedef struct {
+    BasicInputPort *port;
+    TimeStamp timestamp;
+    uint8_t priority;
+    unsigned int length;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+  } InputFrame;
+
+  /*
+   * Passes frames from one thread to the other. If the SPSC queue is full,
+   * the latest frame for each port is held in an overflow list, replacing any
+   * earlier frame for the port. Frames go to the overflow list until the
+   * consumer has taken it, so the frames for a port are never reordered.
+   */
+  template <typename Frame>
+  class FrameQueue {
+   public:
+    explicit FrameQueue(unsigned int size)
+        : m_queue(size),
+          m_overflowing(false) {
+    }
+
+    // Called by the producer.
+    void Push(const Frame &frame) {
+      if (!__atomic_load_n(&m_overflowing, __ATOMIC_ACQUIRE) &&
+          m_queue.Push(frame)) {
+        return;
+      }
+      ola::thread::MutexLocker locker(&m_mutex);
+      typename std::vector<Frame>::iterator iter = m_overflow.begin();
+      for (; iter != m_overflow.end(); ++iter) {
+        if (iter->port == frame.port) {
+          *iter = frame;
+          return;
+        }
+      }
+      m_overflow.push_back(frame);
+      __atomic_store_n(&m_overflowing, true, __ATOMIC_RELEASE);
+    }
+
+    // Called by the consumer.
+    bool Pop(Frame *frame) {
+      // Frames taken from the overflow list are older than anything pushed
+      // to the queue since.
+      if (m_taken.empty()) {
+        if (m_queue.Pop(frame)) {
+          return true;
+        }
+        if (!__atomic_load_n(&m_overflowing, __ATOMIC_ACQUIRE)) {
+          return false;
+        }
+        ola::thread::MutexLocker locker(&m_mutex);
+        m_taken.insert(m_taken.end(), m_overflow.begin(), m_overflow.end());
+        m_overflow.clear();
+        __atomic_store_n(&m_overflowing, false, __ATOMIC_RELEASE);
+        if (m_taken.empty()) {
+          return false;
+        }
+      }
+      *frame = m_taken.front();
+      m_taken.pop_front();
+      return true;
+    }
+
+   private:
+    ola::thread::SPSCQueue<Frame> m_queue;
+    bool m_overflowing;
+    ola::thread::Mutex m_mutex;
+    std::vector<Frame> m_overflow;  // protected by m_mutex
+    std::deque<Frame> m_taken;  // only used by the consumer
+
+    DISALLOW_COPY_AND_ASSIGN(FrameQueue);
+  };
+
+  ola::io::SelectServerInterface *m_main_ss;
+  ola::io::SelectServer m_ss;
+  FrameQueue<OutputFrame> m_output_queue;
+  FrameQueue<InputFrame> m_input_queue;
+  bool m_output_pending;
+  bool m_input_pending;
+  bool m_in_sync_call;
+  unsigned int m_generation;
+  // Only used on this thread.
+  bool m_starting;
+  std::vector<AbstractDevice*> m_starting_devices;
+
+  void DrainOutput();
+  void DrainInput();
+  void DiscardOutput();
+  void RunIfCurrent(unsigned int generation, BaseCallback0<void> *callback);
+  unsigned int Generation() const;
+
+  void RDMComplete(bool to_main,
+                   unsigned int generation,
+                   ola::rdm::RDMCallback *callback,
+                   ola::rdm::RDMReply *reply);
+  void DiscoveryComplete(bool to_main,
+                         unsigned int generation,
+                         ola::rdm::RDMDiscoveryCallback *callback,
+                         const ola::rdm::UIDSet &uids);
+
+  void RunBoolSynchronously(BaseCallback0<bool> *callback,
+                            ola::thread::Future<bool> *future);
+  void RunVoidSynchronously(BaseCallback0<void> *callback,
+                            ola::thread::Future<void> *future);
+
+  DISALLOW_COPY_AND_ASSIGN(PluginThread);
+};
+
+
+/**
+ * @name Dispatch functions
+ * @brief Used by the main thread to call into ports and devices.
+ *
+ * If the port or device belongs to a PluginThread, the call is passed to that
+ * thread, otherwise it's made directly.
+ * @{
+ */
+bool DispatchWriteDMX(OutputPort *port,
+                      const DmxBuffer &buffer,
+                      uint8_t priority);
+
+void DispatchRDMRequest(OutputPort *port,
+                        ola::rdm::RDMRequest *request,
+                        ola::rdm::RDMCallback *callback);
+
+void DispatchRDMDiscovery(OutputPort *port,
+                          ola::rdm::RDMDiscoveryCallback *callback,
+                          bool full);
+
+bool DispatchSetUniverse(Port *port, class Universe *universe);
+
+void DispatchUniverseNameChanged(OutputPort *port, const std::string &name);
+
+bool DispatchSendTimeCode(OutputPort *port,
+                          const ola::timecode::TimeCode &timecode);
+
+/**
+ * @brief Fetch the description of a port.
+ *
+ * The description may depend on state that's updated by the port, so for
+ * ports on a PluginThread it's read on that thread.
+ */
+std::string DispatchDescription(const Port *port);
+
+void DispatchConfigure(AbstractDevice *device,
+                       ola::rpc::RpcController *controller,
+                       const std::string &request,
+                       std::string *response,
+                       AbstractDevice::ConfigureCallback *done);
+/**
+ * @}
+ */
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_PLUGINTHREAD_H_
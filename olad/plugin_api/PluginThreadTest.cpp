@@ -0,0 +1,243 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThreadTest.cpp
+ * Test fixture for the PluginThread class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/PluginThread.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::NewSingleCallback;
+using ola::PluginThread;
+using ola::TimeInterval;
+using ola::Universe;
+using std::string;
+
+static const unsigned int TEST_UNIVERSE = 1;
+static const char TEST_DATA[] = "this is some test data";
+
+
+/*
+ * An output port which records the thread WriteDMX() was called on.
+ */
+class ThreadCheckingOutputPort: public TestMockOutputPort {
+ public:
+  ThreadCheckingOutputPort(ola::AbstractDevice *parent, unsigned int port_id)
+      : TestMockOutputPort(parent, port_id),
+        m_write_thread(NULL) {
+  }
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
+    m_write_thread = PluginThread::Current();
+    return TestMockOutputPort::WriteDMX(buffer, priority);
+  }
+
+  PluginThread *WriteThread() const { return m_write_thread; }
+
+  string Description() const {
+    return PluginThread::Current() ? "plugin thread" : "main thread";
+  }
+
+ private:
+  PluginThread *m_write_thread;
+};
+
+
+class PluginThreadTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PluginThreadTest);
+  CPPUNIT_TEST(testCurrent);
+  CPPUNIT_TEST(testOutput);
+  CPPUNIT_TEST(testOutputOverflow);
+  CPPUNIT_TEST(testInput);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  PluginThreadTest()
+      : m_thread("test", &m_ss),
+        m_broker(),
+        m_plugin_adaptor(NULL, &m_ss, NULL, NULL, &m_broker, NULL),
+        m_device(NULL),
+        m_input_port(NULL),
+        m_output_port(NULL) {
+  }
+
+  void setUp();
+  void tearDown();
+
+  void testCurrent();
+  void testOutput();
+  void testOutputOverflow();
+  void testInput();
+
+ private:
+  ola::io::SelectServer m_ss;
+  PluginThread m_thread;
+  ola::PortBroker m_broker;
+  ola::PluginAdaptor m_plugin_adaptor;
+  ola::MemoryPreferences *m_preferences;
+  ola::UniverseStore *m_store;
+  DmxBuffer m_buffer;
+
+  MockDevice *m_device;
+  TestMockInputPort *m_input_port;
+  ThreadCheckingOutputPort *m_output_port;
+
+  bool IsCurrent() {
+    return PluginThread::Current() == &m_thread;
+  }
+
+  void CreateDevice() {
+    m_device = new MockDevice(NULL, "test");
+    m_input_port = new TestMockInputPort(m_device, 1, &m_plugin_adaptor);
+    m_output_port = new ThreadCheckingOutputPort(m_device, 1);
+  }
+
+  void ReceiveDMX() {
+    m_input_port->WriteDMX(m_buffer);
+    m_input_port->DmxChanged();
+  }
+
+  void Noop() {}
+
+  void Block(ola::thread::Future<void> *release) {
+    release->Get();
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PluginThreadTest);
+
+
+void PluginThreadTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_buffer.Set(TEST_DATA);
+  OLA_ASSERT_TRUE(m_thread.Start());
+  m_thread.RunAndWait(NewSingleCallback(this, &PluginThreadTest::CreateDevice));
+}
+
+
+void PluginThreadTest::tearDown() {
+  m_thread.PluginStopped();
+  OLA_ASSERT_TRUE(m_thread.Stop());
+  delete m_input_port;
+  delete m_output_port;
+  delete m_device;
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Check that Current() and RunAndWait() work.
+ */
+void PluginThreadTest::testCurrent() {
+  OLA_ASSERT_NULL(PluginThread::Current());
+  OLA_ASSERT_TRUE(m_thread.RunAndWait(
+      NewSingleCallback(this, &PluginThreadTest::IsCurrent)));
+
+  // Devices remember the thread they were created on.
+  OLA_ASSERT_EQ(&m_thread, m_device->GetPluginThread());
+  OLA_ASSERT_EQ(&m_thread, PluginThread::ForPort(m_output_port));
+  MockDevice device(NULL, "main");
+  OLA_ASSERT_NULL(device.GetPluginThread());
+
+  // The description is read on the port's thread.
+  OLA_ASSERT_EQ(string("plugin thread"),
+                ola::DispatchDescription(m_output_port));
+}
+
+
+/*
+ * Check that data sent to a universe is written on the plugin thread.
+ */
+void PluginThreadTest::testOutput() {
+  ola::PortManager port_manager(m_store, &m_broker);
+  OLA_ASSERT_TRUE(port_manager.PatchPort(m_output_port, TEST_UNIVERSE));
+  Universe *universe = m_store->GetUniverse(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  OLA_ASSERT_EQ(universe, m_output_port->GetUniverse());
+
+  OLA_ASSERT_TRUE(universe->SetDMX(m_buffer));
+  // Callbacks are run in order, so once this returns the data has been
+  // written.
+  m_thread.RunAndWait(NewSingleCallback(this, &PluginThreadTest::Noop));
+  OLA_ASSERT_DMX_EQUALS(m_buffer, m_output_port->ReadDMX());
+  OLA_ASSERT_EQ(&m_thread, m_output_port->WriteThread());
+
+  OLA_ASSERT_TRUE(port_manager.UnPatchPort(m_output_port));
+  OLA_ASSERT_NULL(m_output_port->GetUniverse());
+}
+
+
+/*
+ * Check that once the queue is full, only the latest frame is kept, and it's
+ * written after the queued frames.
+ */
+void PluginThreadTest::testOutputOverflow() {
+  ola::thread::Future<void> release;
+  m_thread.Execute(
+      NewSingleCallback(this, &PluginThreadTest::Block, &release));
+
+  const unsigned int frames = PluginThread::QUEUE_SIZE + 10;
+  DmxBuffer buffer;
+  for (unsigned int i = 0; i < frames; i++) {
+    buffer.SetChannel(0, i & 0xff);
+    buffer.SetChannel(1, i >> 8);
+    m_thread.QueueDMX(m_output_port, buffer, 100);
+  }
+  release.Set();
+  m_thread.RunAndWait(NewSingleCallback(this, &PluginThreadTest::Noop));
+
+  OLA_ASSERT_DMX_EQUALS(buffer, m_output_port->ReadDMX());
+  OLA_ASSERT_EQ(PluginThread::QUEUE_SIZE + 1, m_output_port->WriteCount());
+}
+
+
+/*
+ * Check that data received on the plugin thread is passed to the universe.
+ */
+void PluginThreadTest::testInput() {
+  ola::PortManager port_manager(m_store, &m_broker);
+  OLA_ASSERT_TRUE(port_manager.PatchPort(m_input_port, TEST_UNIVERSE));
+  Universe *universe = m_store->GetUniverse(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+
+  m_thread.Execute(NewSingleCallback(this, &PluginThreadTest::ReceiveDMX));
+  for (unsigned int i = 0; i < 100 && universe->GetDMX().Size() == 0; i++) {
+    m_ss.RunOnce(TimeInterval(0, 10000));
+  }
+  OLA_ASSERT_DMX_EQUALS(m_buffer, universe->GetDMX());
+
+  OLA_ASSERT_TRUE(port_manager.UnPatchPort(m_input_port));
+}
@@ -23,11 +23,13 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/rdm/UIDSet.h"
 #include "olad/Device.h"
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
+#include "olad/plugin_api/PluginThread.h"
 
 namespace ola {
 
@@ -35,6 +37,10 @@ using std::auto_ptr;
 using std::string;
 using std::vector;
 
+const char BasicInputPort::K_INPUT_FRAMES_VAR[] = "input-port-frames";
+const char BasicInputPort::K_INPUT_UNCHANGED_FRAMES_VAR[] =
+    "input-port-unchanged-frames";
+
 BasicInputPort::BasicInputPort(AbstractDevice *parent,
                                unsigned int port_id,
                                const PluginAdaptor *plugin_adaptor,
@@ -46,7 +52,9 @@ BasicInputPort::BasicInputPort(AbstractDevice *parent,
     m_universe(NULL),
     m_device(parent),
     m_plugin_adaptor(plugin_adaptor),
-    m_supports_rdm(supports_rdm) {
+    m_supports_rdm(supports_rdm),
+    m_frames_var(NULL),
+    m_unchanged_frames_var(NULL) {
 }
 
 bool BasicInputPort::SetUniverse(Universe *new_universe) {
@@ -57,6 +65,17 @@ bool BasicInputPort::SetUniverse(Universe *new_universe) {
   if (PreSetUniverse(old_universe, new_universe)) {
     m_universe = new_universe;
     PostSetUniverse(old_universe, new_universe);
+
+    ExportMap *export_map = m_plugin_adaptor ?
+        m_plugin_adaptor->GetExportMap() : NULL;
+    if (new_universe && !m_frames_var && export_map &&
+        !UniqueId().empty()) {
+      // Lookup the counters once, since they're updated for every frame.
+      m_frames_var = export_map->GetShardedCounterMapVar(
+          K_INPUT_FRAMES_VAR, "port")->Get(UniqueId());
+      m_unchanged_frames_var = export_map->GetShardedCounterMapVar(
+          K_INPUT_UNCHANGED_FRAMES_VAR, "port")->Get(UniqueId());
+    }
     return true;
   }
   return false;
@@ -81,19 +100,110 @@ bool BasicInputPort::SetPriority(uint8_t priority) {
 }
 
 void BasicInputPort::DmxChanged() {
+  DmxChangedAt(*m_plugin_adaptor->WakeUpTime());
+}
+
+void BasicInputPort::DmxChangedAt(const TimeStamp &received) {
   if (GetUniverse()) {
     const DmxBuffer &buffer = ReadDMX();
-    uint8_t priority = (PriorityCapability() == CAPABILITY_FULL &&
-                        GetPriorityMode() == PRIORITY_MODE_INHERIT ?
-                        InheritedPriority() :
-                        GetPriority());
-    m_dmx_source.UpdateData(buffer, *m_plugin_adaptor->WakeUpTime(), priority);
+    const bool inherit = (PriorityCapability() == CAPABILITY_FULL &&
+                          GetPriorityMode() == PRIORITY_MODE_INHERIT);
+    uint8_t priority = inherit ? InheritedPriority() : GetPriority();
+    const DmxBuffer *slot_priorities = inherit ? InheritedSlotPriorities() :
+                                                 NULL;
+    if (slot_priorities && !slot_priorities->Size()) {
+      slot_priorities = NULL;
+    }
+    PluginThread *thread = PluginThread::Current();
+    if (thread) {
+      thread->QueueInput(this, buffer, received, priority, slot_priorities);
+      return;
+    }
+    if (RefreshIfUnchanged(buffer, received, priority, slot_priorities)) {
+      return;
+    }
+    if (slot_priorities) {
+      m_dmx_source.UpdateData(buffer, received, priority, *slot_priorities);
+    } else {
+      m_dmx_source.UpdateData(buffer, received, priority);
+    }
     GetUniverse()->PortDataChanged(this);
   }
 }
 
-void BasicInputPort::HandleRDMRequest(ola::rdm::RDMRequest *request_ptr,
+void BasicInputPort::UpdateSource(const DmxSource &source) {
+  if (GetUniverse()) {
+    const DmxBuffer *slot_priorities = source.HasSlotPriorities() ?
+        &source.SlotPriorities() : NULL;
+    if (RefreshIfUnchanged(source.Data(), source.Timestamp(),
+                           source.Priority(), slot_priorities)) {
+      return;
+    }
+    m_dmx_source = source;
+    GetUniverse()->PortDataChanged(this);
+  }
+}
+
+/*
+ * Many inputs, e.g. a console that's not being used, send the same frame over
+ * and over. If nothing has changed, we just need to keep the source active
+ * rather than merging the data again.
+ * @returns true if the frame was the same as the last one.
+ */
+bool BasicInputPort::RefreshIfUnchanged(const DmxBuffer &buffer,
+                                        const TimeStamp &received,
+                                        uint8_t priority,
+                                        const DmxBuffer *slot_priorities) {
+  if (m_frames_var) {
+    m_frames_var->Increment();
+  }
+
+  // If the source timed out, the universe needs to add it back.
+  if (!m_dmx_source.IsSet() || !m_dmx_source.IsActive(received) ||
+      m_dmx_source.Priority() != priority ||
+      m_dmx_source.HasSlotPriorities() != (slot_priorities != NULL) ||
+      (slot_priorities &&
+       *slot_priorities != m_dmx_source.SlotPriorities()) ||
+      buffer != m_dmx_source.Data()) {
+    return false;
+  }
+
+  if (m_unchanged_frames_var) {
+    m_unchanged_frames_var->Increment();
+  }
+  m_dmx_source.Refresh(received);
+  GetUniverse()->PortDataRefreshed(this);
+  return true;
+}
+
+void BasicInputPort::HandleRDMRequest(ola::rdm::RDMRequest *request,
                                       ola::rdm::RDMCallback *callback) {
+  PluginThread *thread = PluginThread::Current();
+  if (thread) {
+    thread->ExecuteOnMain(NewSingleCallback(
+        this, &BasicInputPort::SendRDMRequestToBroker, request,
+        thread->ReturnRDMCallbackToPlugin(callback)));
+    return;
+  }
+  SendRDMRequestToBroker(request, callback);
+}
+
+void BasicInputPort::TriggerRDMDiscovery(
+    ola::rdm::RDMDiscoveryCallback *on_complete,
+    bool full) {
+  PluginThread *thread = PluginThread::Current();
+  if (thread) {
+    thread->ExecuteOnMain(NewSingleCallback(
+        this, &BasicInputPort::RunRDMDiscovery,
+        thread->ReturnDiscoveryCallbackToPlugin(on_complete), full));
+    return;
+  }
+  RunRDMDiscovery(on_complete, full);
+}
+
+void BasicInputPort::SendRDMRequestToBroker(
+    ola::rdm::RDMRequest *request_ptr,
+    ola::rdm::RDMCallback *callback) {
   auto_ptr<ola::rdm::RDMRequest> request(request_ptr);
   if (m_universe) {
     m_plugin_adaptor->GetPortBroker()->SendRDMRequest(
@@ -106,7 +216,7 @@ void BasicInputPort::HandleRDMRequest(ola::rdm::RDMRequest *request_ptr,
   }
 }
 
-void BasicInputPort::TriggerRDMDiscovery(
+void BasicInputPort::RunRDMDiscovery(
     ola::rdm::RDMDiscoveryCallback *on_complete,
     bool full) {
   if (m_universe) {
@@ -192,11 +302,93 @@ void BasicOutputPort::RunIncrementalDiscovery(
 }
 
 void BasicOutputPort::UpdateUIDs(const ola::rdm::UIDSet &uids) {
+  PluginThread *thread = PluginThread::Current();
+  if (thread) {
+    thread->ExecuteOnMain(NewSingleCallback(
+        this, &BasicOutputPort::NewUIDList, new ola::rdm::UIDSet(uids)));
+    return;
+  }
   Universe *universe = GetUniverse();
   if (universe)
     universe->NewUIDList(this, uids);
 }
 
+void BasicOutputPort::NewUIDList(ola::rdm::UIDSet *uids_ptr) {
+  auto_ptr<ola::rdm::UIDSet> uids(uids_ptr);
+  Universe *universe = GetUniverse();
+  if (universe)
+    universe->NewUIDList(this, *uids);
+}
+
+RateLimitedOutputPort::RateLimitedOutputPort(
+    AbstractDevice *parent,
+    unsigned int port_id,
+    ola::io::SelectServerInterface *ss,
+    unsigned int max_frame_rate,
+    bool start_rdm_discovery_on_patch,
+    bool supports_rdm)
+    : BasicOutputPort(parent, port_id, start_rdm_discovery_on_patch,
+                      supports_rdm),
+      m_ss(ss),
+      m_max_frame_rate(max_frame_rate),
+      m_pending_priority(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+      m_pending(false),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
+  if (m_max_frame_rate) {
+    // A bucket size of one means there are no bursts above the rate.
+    m_bucket.reset(new TokenBucket(1, m_max_frame_rate, 1,
+                                   *m_ss->WakeUpTime()));
+  }
+}
+
+RateLimitedOutputPort::~RateLimitedOutputPort() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+  }
+}
+
+bool RateLimitedOutputPort::WriteDMX(const DmxBuffer &buffer,
+                                     uint8_t priority) {
+  if (!m_bucket.get()) {
+    return SendDMX(buffer, priority);
+  }
+
+  if (!m_pending && m_bucket->GetToken(*m_ss->WakeUpTime())) {
+    return SendDMX(buffer, priority);
+  }
+
+  // Latest frame wins, it's sent once the rate allows.
+  m_pending_buffer = buffer;
+  m_pending_priority = priority;
+  m_pending = true;
+  ScheduleFlush();
+  return true;
+}
+
+void RateLimitedOutputPort::ScheduleFlush() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  m_flush_timeout = m_ss->RegisterSingleTimeout(
+      TimeInterval(static_cast<int64_t>(USEC_IN_SECONDS / m_max_frame_rate)),
+      NewSingleCallback(this, &RateLimitedOutputPort::Flush));
+}
+
+void RateLimitedOutputPort::Flush() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!m_pending) {
+    return;
+  }
+
+  if (!m_bucket->GetToken(*m_ss->WakeUpTime())) {
+    // The timer fired a little early.
+    ScheduleFlush();
+    return;
+  }
+  m_pending = false;
+  SendDMX(m_pending_buffer, m_pending_priority);
+}
+
 template<class PortClass>
 bool IsInputPort() {
   return true;
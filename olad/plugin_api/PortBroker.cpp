@@ -18,35 +18,45 @@
  * Copyright (C) 2010 Simon Newton
  */
 
-#include <set>
 #include <string>
 #include <vector>
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "olad/PortBroker.h"
+#include "olad/plugin_api/PendingRequestTracker.h"
 
 namespace ola {
 
-using std::pair;
-using std::set;
 using std::string;
 using std::vector;
 
+PortBroker::PortBroker()
+    : m_ports(new PendingRequestTracker<Port>()) {
+}
+
+
+PortBroker::~PortBroker() {}
+
+
 /**
  * Add a port to the broker
  */
 void PortBroker::AddPort(const Port *port) {
-  port_key key(port->UniqueId(), port);
-  m_ports.insert(key);
+  m_ports->AddOwner(port);
 }
 
 
 /**
- * Remove a port from the broker
+ * Remove a port from the broker. Any RDM calls still in flight for the port
+ * will have their callbacks deleted rather than run.
  */
 void PortBroker::RemovePort(const Port *port) {
-  port_key key(port->UniqueId(), port);
-  m_ports.erase(key);
+  m_ports->RemoveOwner(port);
+}
+
+
+unsigned int PortBroker::PendingRequests(const Port *port) const {
+  return m_ports->Outstanding(port);
 }
 
 
@@ -61,33 +71,28 @@ void PortBroker::SendRDMRequest(const Port *port,
                                 Universe *universe,
                                 ola::rdm::RDMRequest *request,
                                 ola::rdm::RDMCallback *callback) {
-  port_key key(port->UniqueId(), port);
-  set<port_key>::const_iterator iter = m_ports.find(key);
-  if (iter == m_ports.end())
+  if (!m_ports->Contains(port))
     OLA_WARN <<
       "Making an RDM call but the port doesn't exist in the broker!";
 
   universe->SendRDMRequest(
       request,
-      NewSingleCallback(this,
-                        &PortBroker::RequestComplete,
-                        key,
+      NewSingleCallback(&PortBroker::RequestComplete,
+                        m_ports->Start(port),
                         callback));
 }
 
 
 /**
  * Return from an RDM call
- * @param key the port associated with this request
- * @param callback the callback to run if the key still exists
- * @param status the status of the RDM request
- * @param response the RDM response
+ * @param pending_request the handle for this request
+ * @param callback the callback to run if the port still exists
+ * @param reply the RDM reply
  */
-void PortBroker::RequestComplete(port_key key,
+void PortBroker::RequestComplete(PendingRequest *pending_request,
                                  ola::rdm::RDMCallback *callback,
                                  ola::rdm::RDMReply *reply) {
-  set<port_key>::const_iterator iter = m_ports.find(key);
-  if (iter == m_ports.end()) {
+  if (!PendingRequestTracker<Port>::Finish(pending_request)) {
     OLA_INFO << "Port no longer exists, cleaning up from RDM response";
     delete callback;
   } else {
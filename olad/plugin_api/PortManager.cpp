@@ -24,6 +24,7 @@
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "olad/Port.h"
+#include "olad/plugin_api/PluginThread.h"
 
 namespace ola {
 
@@ -53,6 +54,7 @@ bool PortManager::SetPriorityInherit(Port *port) {
 
   if (port->GetPriorityMode() != PRIORITY_MODE_INHERIT) {
     port->SetPriorityMode(PRIORITY_MODE_INHERIT);
+    PriorityChanged();
   }
 
   return true;
@@ -63,8 +65,10 @@ bool PortManager::SetPriorityStatic(Port *port, uint8_t value) {
     return true;
 
   if (port->PriorityCapability() == CAPABILITY_FULL &&
-      port->GetPriorityMode() != PRIORITY_MODE_STATIC)
+      port->GetPriorityMode() != PRIORITY_MODE_STATIC) {
     port->SetPriorityMode(PRIORITY_MODE_STATIC);
+    PriorityChanged();
+  }
 
   if (value > ola::dmx::SOURCE_PRIORITY_MAX) {
     OLA_WARN << "Priority " << static_cast<int>(value)
@@ -73,12 +77,22 @@ bool PortManager::SetPriorityStatic(Port *port, uint8_t value) {
     value = ola::dmx::SOURCE_PRIORITY_MAX;
   }
 
-  if (port->GetPriority() != value)
+  if (port->GetPriority() != value) {
     port->SetPriority(value);
+    PriorityChanged();
+  }
   return true;
 }
 
 
+void PortManager::PriorityChanged() {
+  // The port's priority is part of the universe state.
+  if (m_universe_store) {
+    m_universe_store->UniverseChanged();
+  }
+}
+
+
 template<class PortClass>
 bool PortManager::GenericPatchPort(PortClass *port,
                                    unsigned int new_universe_id) {
@@ -115,7 +129,7 @@ bool PortManager::GenericPatchPort(PortClass *port,
   if (!universe)
     return false;
 
-  if (port->SetUniverse(universe)) {
+  if (DispatchSetUniverse(port, universe)) {
     OLA_INFO << "Patched " << port->UniqueId() << " to universe " <<
       universe->UniverseId();
     m_broker->AddPort(port);
@@ -137,7 +151,7 @@ bool PortManager::GenericUnPatchPort(PortClass *port) {
   m_broker->RemovePort(port);
   if (universe) {
     universe->RemovePort(port);
-    port->SetUniverse(NULL);
+    DispatchSetUniverse(port, NULL);
     OLA_INFO << "Unpatched " << port->UniqueId() << " from uni "
       << universe->UniverseId();
   }
@@ -125,6 +125,8 @@ class PortManager {
   bool CheckOutputPortsForUniverse(const AbstractDevice *device,
                                    unsigned int universe_id) const;
 
+  void PriorityChanged();
+
   /**
    * Check for any port in a list that's bound to this universe.
    * @returns true if there is a match, false otherwise.
@@ -31,18 +31,76 @@
 
 
 using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
 using ola::TimeStamp;
 using std::string;
 
+
+/*
+ * A MockSelectServer that holds single timeouts until they're run.
+ */
+class TimeoutSelectServer: public MockSelectServer {
+ public:
+  explicit TimeoutSelectServer(const TimeStamp *wake_up)
+      : MockSelectServer(wake_up) {}
+
+  using MockSelectServer::RegisterSingleTimeout;
+
+  ola::thread::timeout_id RegisterSingleTimeout(
+      const TimeInterval &interval,
+      ola::SingleUseCallback0<void> *callback) {
+    return m_scheduler.RegisterSingleTimeout(interval, callback);
+  }
+  void RemoveTimeout(ola::thread::timeout_id id) {
+    m_scheduler.RemoveTimeout(id);
+  }
+
+  unsigned int PendingTimeouts() const {
+    return m_scheduler.PendingTimeouts();
+  }
+  void RunTimeouts() { m_scheduler.RunTimeouts(); }
+
+ private:
+  MockScheduler m_scheduler;
+};
+
+
+/*
+ * A rate limited port that records what it sends.
+ */
+class TestRateLimitedPort: public ola::RateLimitedOutputPort {
+ public:
+  TestRateLimitedPort(ola::io::SelectServerInterface *ss,
+                      unsigned int max_frame_rate)
+      : RateLimitedOutputPort(NULL, 1, ss, max_frame_rate),
+        frames_sent(0) {
+  }
+
+  string Description() const { return ""; }
+
+  unsigned int frames_sent;
+  DmxBuffer last_frame;
+
+ protected:
+  bool SendDMX(const DmxBuffer &buffer, uint8_t) {
+    frames_sent++;
+    last_frame = buffer;
+    return true;
+  }
+};
+
 class PortTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(PortTest);
   CPPUNIT_TEST(testOutputPortPriorities);
   CPPUNIT_TEST(testInputPortPriorities);
+  CPPUNIT_TEST(testRateLimitedOutputPort);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testOutputPortPriorities();
     void testInputPortPriorities();
+    void testRateLimitedOutputPort();
 
  private:
     Clock m_clock;
@@ -150,3 +208,51 @@ void PortTest::testInputPortPriorities() {
   input_port2.DmxChanged();
   OLA_ASSERT_EQ(new_priority,  universe->ActivePriority());
 }
+
+
+/*
+ * Check that a RateLimitedOutputPort paces frames, and sends the last one.
+ */
+void PortTest::testRateLimitedOutputPort() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  TimeoutSelectServer ss(&now);
+
+  // no limit
+  TestRateLimitedPort unlimited_port(&ss, 0);
+  DmxBuffer buffer("foo");
+  for (unsigned int i = 0; i < 10; i++) {
+    OLA_ASSERT_TRUE(unlimited_port.WriteDMX(buffer, 100));
+  }
+  OLA_ASSERT_EQ(10u, unlimited_port.frames_sent);
+  OLA_ASSERT_EQ(0u, ss.PendingTimeouts());
+
+  // 10 fps
+  TestRateLimitedPort port(&ss, 10);
+  OLA_ASSERT_TRUE(port.WriteDMX(DmxBuffer("a"), 100));
+  OLA_ASSERT_EQ(1u, port.frames_sent);
+
+  // The next two are too soon, the second replaces the first.
+  OLA_ASSERT_TRUE(port.WriteDMX(DmxBuffer("b"), 100));
+  OLA_ASSERT_TRUE(port.WriteDMX(DmxBuffer("c"), 100));
+  OLA_ASSERT_EQ(1u, port.frames_sent);
+  OLA_ASSERT_EQ(1u, ss.PendingTimeouts());
+
+  // If the timeout fires early, the flush is rescheduled.
+  now += TimeInterval(0, 50000);
+  ss.RunTimeouts();
+  OLA_ASSERT_EQ(1u, port.frames_sent);
+  OLA_ASSERT_EQ(1u, ss.PendingTimeouts());
+
+  now += TimeInterval(0, 50000);
+  ss.RunTimeouts();
+  OLA_ASSERT_EQ(2u, port.frames_sent);
+  OLA_ASSERT_TRUE(DmxBuffer("c") == port.last_frame);
+  OLA_ASSERT_EQ(0u, ss.PendingTimeouts());
+
+  // After a quiet period, frames are sent straight away again.
+  now += TimeInterval(1, 0);
+  OLA_ASSERT_TRUE(port.WriteDMX(DmxBuffer("d"), 100));
+  OLA_ASSERT_EQ(3u, port.frames_sent);
+  OLA_ASSERT_TRUE(DmxBuffer("d") == port.last_frame);
+}
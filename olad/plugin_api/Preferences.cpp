@@ -44,7 +44,7 @@
 #include <fstream>
 #include <list>
 #include <map>
-#include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -60,6 +60,7 @@
 namespace ola {
 
 using ola::thread::Mutex;
+using ola::thread::MutexLocker;
 using ola::thread::ConditionVariable;
 using std::ifstream;
 using std::ofstream;
@@ -69,26 +70,97 @@ using std::string;
 using std::vector;
 
 namespace {
-void SavePreferencesToFile(
-    const string *filename_ptr,
-    const FilePreferenceSaverThread::PreferencesMap *pref_map_ptr) {
-  std::auto_ptr<const string> filename(filename_ptr);
-  std::auto_ptr<const FilePreferenceSaverThread::PreferencesMap> pref_map(
-      pref_map_ptr);
+/*
+ * Write a file via a temporary file, so the file is either the old or the new
+ * version and never a partial one.
+ */
+bool WriteFileAtomically(const string &filename, const string &contents) {
+  const string temp_file = filename + ".new";
+  ofstream out(temp_file.c_str(), std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    OLA_WARN << "Could not open " << temp_file << ": " << strerror(errno);
+    return false;
+  }
+  out << contents;
+  out.close();
+
+#ifdef _WIN32
+  // rename() doesn't replace an existing file on Windows.
+  unlink(filename.c_str());
+#endif  // _WIN32
+  if (out.fail() || rename(temp_file.c_str(), filename.c_str())) {
+    OLA_WARN << "Could not write " << filename << ": " << strerror(errno);
+    unlink(temp_file.c_str());
+    return false;
+  }
+  return true;
+}
 
+void AppendPreferences(const FilePreferenceSaverThread::PreferencesMap &prefs,
+                       std::ostringstream *str) {
   FilePreferenceSaverThread::PreferencesMap::const_iterator iter;
-  ofstream pref_file(filename->data());
+  for (iter = prefs.begin(); iter != prefs.end(); ++iter) {
+    *str << iter->first << " = " << iter->second << std::endl;
+  }
+}
 
-  if (!pref_file.is_open()) {
-    OLA_WARN << "Could not open " << *filename_ptr << ": " << strerror(errno);
-    return;
+/*
+ * Parse a key = value line, returns false if the line should be skipped.
+ */
+bool ParsePreferenceLine(string line, string *key, string *value) {
+  StringTrim(&line);
+  if (line.empty() || line.at(0) == '#') {
+    return false;
   }
 
-  for (iter = pref_map->begin(); iter != pref_map->end(); ++iter) {
-    pref_file << iter->first << " = " << iter->second << std::endl;
+  vector<string> tokens;
+  StringSplit(line, &tokens, "=");
+
+  if (tokens.size() != 2) {
+    OLA_INFO << "Skipping line: " << line;
+    return false;
   }
-  pref_file.flush();
-  pref_file.close();
+
+  *key = tokens[0];
+  *value = tokens[1];
+  StringTrim(key);
+  StringTrim(value);
+  return true;
+}
+
+/*
+ * Load a snapshot file. Each config file starts with a [ola-name.conf] line,
+ * followed by the key = value lines from that file.
+ */
+bool LoadSnapshot(const string &filename, PreferencesSnapshot *snapshot) {
+  ifstream snapshot_file(filename.c_str());
+  if (!snapshot_file.is_open()) {
+    OLA_INFO << "Missing snapshot " << filename
+             << ", loading the config files instead";
+    return false;
+  }
+
+  struct stat file_stat;
+  if (stat(filename.c_str(), &file_stat)) {
+    return false;
+  }
+  snapshot->modified = file_stat.st_mtime;
+
+  PreferencesSnapshot::PreferencesMap *prefs = NULL;
+  string line, key, value;
+  while (getline(snapshot_file, line)) {
+    StringTrim(&line);
+    if (line.size() > 2 && line.at(0) == '[' &&
+        line.at(line.size() - 1) == ']') {
+      prefs = &snapshot->files[line.substr(1, line.size() - 2)];
+      prefs->clear();
+    } else if (prefs && ParsePreferenceLine(line, &key, &value)) {
+      prefs->insert(make_pair(key, value));
+    }
+  }
+  OLA_INFO << "Loaded " << snapshot->files.size()
+           << " config files from snapshot " << filename;
+  return true;
 }
 }  // namespace
 
@@ -97,6 +169,8 @@ const char BoolValidator::DISABLED[] = "false";
 
 const char FileBackedPreferences::OLA_CONFIG_PREFIX[] = "ola-";
 const char FileBackedPreferences::OLA_CONFIG_SUFFIX[] = ".conf";
+const char FileBackedPreferencesFactory::SNAPSHOT_FILE[] =
+    "ola-preferences.snapshot";
 
 // Validators
 //-----------------------------------------------------------------------------
@@ -385,8 +459,11 @@ void MemoryPreferences::SetValueAsBool(const string &key, bool value) {
 // FilePreferenceSaverThread
 //-----------------------------------------------------------------------------
 
-FilePreferenceSaverThread::FilePreferenceSaverThread()
-    : Thread(Thread::Options("pref-saver")) {
+FilePreferenceSaverThread::FilePreferenceSaverThread(
+    unsigned int save_delay_ms)
+    : Thread(Thread::Options("pref-saver")),
+      m_save_delay_ms(save_delay_ms),
+      m_save_scheduled(false) {
   // set a long poll interval so we don't spin
   m_ss.SetDefaultInterval(TimeInterval(60, 0));
 }
@@ -394,11 +471,21 @@ FilePreferenceSaverThread::FilePreferenceSaverThread()
 void FilePreferenceSaverThread::SavePreferences(
     const string &file_name,
     const PreferencesMap &preferences) {
-  const string *file_name_ptr = new string(file_name);
-  const PreferencesMap *save_map = new PreferencesMap(preferences);
-  SingleUseCallback0<void> *cb =
-      NewSingleCallback(SavePreferencesToFile, file_name_ptr, save_map);
-  m_ss.Execute(cb);
+  MutexLocker locker(&m_mutex);
+  m_pending[file_name] = preferences;
+  if (!m_save_scheduled) {
+    m_save_scheduled = true;
+    m_ss.Execute(
+        NewSingleCallback(this, &FilePreferenceSaverThread::ScheduleSave));
+  }
+}
+
+
+void FilePreferenceSaverThread::EnableSnapshot(
+    const string &filename,
+    const PreferencesSnapshot &snapshot) {
+  m_snapshot_file = filename;
+  m_snapshot = snapshot.files;
 }
 
 
@@ -410,7 +497,10 @@ void *FilePreferenceSaverThread::Run() {
 
 bool FilePreferenceSaverThread::Join(void *ptr) {
   m_ss.Terminate();
-  return Thread::Join(ptr);
+  bool ok = Thread::Join(ptr);
+  // The thread has stopped, so write anything left over from here.
+  WritePending();
+  return ok;
 }
 
 
@@ -427,9 +517,57 @@ void FilePreferenceSaverThread::Synchronize() {
 }
 
 
+/*
+ * Called in the saver thread once a save has been requested. Any further
+ * saves before the delay expires are written at the same time.
+ */
+void FilePreferenceSaverThread::ScheduleSave() {
+  m_ss.RegisterSingleTimeout(
+      m_save_delay_ms,
+      NewSingleCallback(this, &FilePreferenceSaverThread::WritePending));
+}
+
+
+void FilePreferenceSaverThread::WritePending() {
+  FileMap pending;
+  {
+    MutexLocker locker(&m_mutex);
+    pending.swap(m_pending);
+    m_save_scheduled = false;
+  }
+
+  if (pending.empty()) {
+    return;
+  }
+
+  FileMap::const_iterator iter = pending.begin();
+  for (; iter != pending.end(); ++iter) {
+    std::ostringstream str;
+    AppendPreferences(iter->second, &str);
+    WriteFileAtomically(iter->first, str.str());
+    if (!m_snapshot_file.empty()) {
+      m_snapshot[ola::file::FilenameFromPath(iter->first)] = iter->second;
+    }
+  }
+
+  if (m_snapshot_file.empty()) {
+    return;
+  }
+
+  std::ostringstream str;
+  str << "# Generated by olad, edit the ola-*.conf files instead." << std::endl;
+  for (iter = m_snapshot.begin(); iter != m_snapshot.end(); ++iter) {
+    str << "[" << iter->first << "]" << std::endl;
+    AppendPreferences(iter->second, &str);
+  }
+  WriteFileAtomically(m_snapshot_file, str.str());
+}
+
+
 void FilePreferenceSaverThread::CompleteSynchronization(
     ConditionVariable *condition,
     Mutex *mutex) {
+  WritePending();
   // calling lock here forces us to block until Wait() is called on the
   // condition_var.
   mutex->Lock();
@@ -442,6 +580,9 @@ void FilePreferenceSaverThread::CompleteSynchronization(
 //-----------------------------------------------------------------------------
 
 bool FileBackedPreferences::Load() {
+  if (m_snapshot && LoadFromSnapshot()) {
+    return true;
+  }
   return LoadFromFile(FileName());
 }
 
@@ -452,6 +593,21 @@ bool FileBackedPreferences::Save() const {
 }
 
 
+/*
+ * This always reads the file, the snapshot may be older than the changes
+ * we're looking for.
+ */
+bool FileBackedPreferences::Reload() {
+  // Wait for any pending saves, otherwise they'd look like changes.
+  m_saver_thread->Synchronize();
+  const PreferencesMap old_map = m_pref_map;
+  if (!LoadFromFile(FileName())) {
+    return false;
+  }
+  return m_pref_map != old_map;
+}
+
+
 const string FileBackedPreferences::FileName() const {
   return (m_directory + ola::file::PATH_SEPARATOR + OLA_CONFIG_PREFIX +
           m_preference_name + OLA_CONFIG_SUFFIX);
@@ -468,29 +624,52 @@ bool FileBackedPreferences::LoadFromFile(const string &filename) {
   }
 
   m_pref_map.clear();
-  string line;
+  string line, key, value;
   while (getline(pref_file, line)) {
-    StringTrim(&line);
-
-    if (line.empty() || line.at(0) == '#') {
-      continue;
+    if (ParsePreferenceLine(line, &key, &value)) {
+      m_pref_map.insert(make_pair(key, value));
     }
+  }
+  pref_file.close();
+  return true;
+}
 
-    vector<string> tokens;
-    StringSplit(line, &tokens, "=");
 
-    if (tokens.size() != 2) {
-      OLA_INFO << "Skipping line: " << line;
-      continue;
-    }
+bool FileBackedPreferences::LoadFromSnapshot() {
+  const string config_file = (string(OLA_CONFIG_PREFIX) + m_preference_name +
+                              OLA_CONFIG_SUFFIX);
+  const PreferencesSnapshot::PreferencesMap *prefs = STLFind(
+      &m_snapshot->files, config_file);
+  if (!prefs) {
+    return false;
+  }
 
-    string key = tokens[0];
-    string value = tokens[1];
-    StringTrim(&key);
-    StringTrim(&value);
-    m_pref_map.insert(make_pair(key, value));
+  // Prefer the config file if it's been edited since the snapshot was written.
+  struct stat file_stat;
+  if (stat(FileName().c_str(), &file_stat) == 0 &&
+      file_stat.st_mtime > m_snapshot->modified) {
+    OLA_INFO << FileName() << " is newer than the snapshot";
+    return false;
   }
-  pref_file.close();
+  m_pref_map = *prefs;
   return true;
 }
+
+
+// FileBackedPreferencesFactory
+//-----------------------------------------------------------------------------
+
+FileBackedPreferencesFactory::FileBackedPreferencesFactory(
+    const string &directory,
+    bool use_snapshot)
+    : m_directory(directory),
+      m_use_snapshot(use_snapshot) {
+  if (m_use_snapshot) {
+    const string snapshot_file = ola::file::JoinPaths(directory,
+                                                      SNAPSHOT_FILE);
+    LoadSnapshot(snapshot_file, &m_snapshot);
+    m_saver_thread.EnableSnapshot(snapshot_file, m_snapshot);
+  }
+  m_saver_thread.Start();
+}
 }  // namespace ola
@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
 #include <set>
 #include <string>
 #include <vector>
@@ -53,6 +54,9 @@ class PreferencesTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testFactory);
   CPPUNIT_TEST(testLoad);
   CPPUNIT_TEST(testSave);
+  CPPUNIT_TEST(testCoalescedSave);
+  CPPUNIT_TEST(testSnapshot);
+  CPPUNIT_TEST(testReload);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +69,9 @@ class PreferencesTest: public CppUnit::TestFixture {
     void testFactory();
     void testLoad();
     void testSave();
+    void testCoalescedSave();
+    void testSnapshot();
+    void testReload();
 };
 
 
@@ -413,3 +420,119 @@ void PreferencesTest::testSave() {
 
   saver_thread.Join();
 }
+
+
+/*
+ * Check that saves are coalesced until the delay expires.
+ */
+void PreferencesTest::testCoalescedSave() {
+  const string data_path = TEST_BUILD_DIR "/olad/ola-coalesced.conf";
+  unlink(data_path.c_str());
+
+  // Use a long delay so the file is only written by Synchronize().
+  ola::FilePreferenceSaverThread saver_thread(60000);
+  saver_thread.Start();
+  FileBackedPreferences preferences(TEST_BUILD_DIR "/olad", "coalesced",
+                                    &saver_thread);
+  for (unsigned int i = 0; i < 100; i++) {
+    preferences.SetValue("port", i);
+    preferences.Save();
+  }
+  OLA_ASSERT_NE(0, access(data_path.c_str(), F_OK));
+
+  saver_thread.Synchronize();
+  FileBackedPreferences input_preferences("", "input", NULL);
+  OLA_ASSERT_TRUE(input_preferences.LoadFromFile(data_path));
+  OLA_ASSERT_EQ(string("99"), input_preferences.GetValue("port"));
+
+  // Pending saves are written when the thread stops.
+  preferences.SetValue("port", "100");
+  preferences.Save();
+  saver_thread.Join();
+  OLA_ASSERT_TRUE(input_preferences.LoadFromFile(data_path));
+  OLA_ASSERT_EQ(string("100"), input_preferences.GetValue("port"));
+}
+
+
+/*
+ * Check that preferences can be loaded from a snapshot.
+ */
+void PreferencesTest::testSnapshot() {
+  const string directory = TEST_BUILD_DIR "/olad";
+  const string data_path = directory + "/ola-snapshot.conf";
+  const string snapshot_path = (
+      directory + "/" + FileBackedPreferencesFactory::SNAPSHOT_FILE);
+  unlink(data_path.c_str());
+  unlink(snapshot_path.c_str());
+
+  {
+    FileBackedPreferencesFactory factory(directory, true);
+    Preferences *preferences = factory.NewPreference("snapshot");
+    OLA_ASSERT_FALSE(preferences->Load());
+    preferences->SetValue("foo", "bar");
+    preferences->SetMultipleValue("multi", "1");
+    preferences->SetMultipleValue("multi", "2");
+    preferences->Save();
+  }
+  OLA_ASSERT_EQ(0, access(data_path.c_str(), F_OK));
+  OLA_ASSERT_EQ(0, access(snapshot_path.c_str(), F_OK));
+
+  // Without the config file, the preferences come from the snapshot.
+  unlink(data_path.c_str());
+  {
+    FileBackedPreferencesFactory factory(directory, true);
+    Preferences *preferences = factory.NewPreference("snapshot");
+    OLA_ASSERT_TRUE(preferences->Load());
+    OLA_ASSERT_EQ(string("bar"), preferences->GetValue("foo"));
+    vector<string> values = preferences->GetMultipleValue("multi");
+    OLA_ASSERT_EQ((size_t) 2, values.size());
+    OLA_ASSERT_EQ(string("1"), values.at(0));
+    OLA_ASSERT_EQ(string("2"), values.at(1));
+  }
+
+  // The snapshot isn't used unless it's enabled.
+  {
+    FileBackedPreferencesFactory factory(directory);
+    Preferences *preferences = factory.NewPreference("snapshot");
+    OLA_ASSERT_FALSE(preferences->Load());
+  }
+  unlink(snapshot_path.c_str());
+}
+
+
+/*
+ * Check that Reload() spots changes made to the file.
+ */
+void PreferencesTest::testReload() {
+  const string data_path = TEST_BUILD_DIR "/olad/ola-reload.conf";
+  unlink(data_path.c_str());
+
+  ola::FilePreferenceSaverThread saver_thread;
+  saver_thread.Start();
+  FileBackedPreferences preferences(TEST_BUILD_DIR "/olad", "reload",
+                                    &saver_thread);
+  // No file yet.
+  OLA_ASSERT_FALSE(preferences.Reload());
+
+  // Pending saves don't count as changes.
+  preferences.SetValue("ip", "10.0.0.1");
+  preferences.Save();
+  OLA_ASSERT_FALSE(preferences.Reload());
+  OLA_ASSERT_EQ(string("10.0.0.1"), preferences.GetValue("ip"));
+
+  // Edit the file behind its back.
+  FileBackedPreferences other_preferences(TEST_BUILD_DIR "/olad", "reload",
+                                          &saver_thread);
+  other_preferences.SetValue("ip", "10.0.0.2");
+  other_preferences.Save();
+  saver_thread.Synchronize();
+
+  OLA_ASSERT_TRUE(preferences.Reload());
+  OLA_ASSERT_EQ(string("10.0.0.2"), preferences.GetValue("ip"));
+  OLA_ASSERT_FALSE(preferences.Reload());
+
+  // Memory preferences have nothing to reload from.
+  MemoryPreferencesFactory factory;
+  OLA_ASSERT_FALSE(factory.NewPreference("dummy")->Reload());
+  saver_thread.Join();
+}
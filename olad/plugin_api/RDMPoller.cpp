@@ -0,0 +1,446 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPoller.cpp
+ * Polls RDM sensors & status messages from within olad.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/RDMPoller.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMHelper.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/RDMResponderStats.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using ola::thread::INVALID_TIMEOUT;
+using std::set;
+using std::string;
+using std::vector;
+
+const unsigned int RDMPoller::DEFAULT_CYCLE_TIME_S;
+const unsigned int RDMPoller::DEFAULT_IDLE_TIME_MS;
+const unsigned int RDMPoller::REFRESH_INTERVAL_MS;
+const unsigned int RDMPoller::UNRELIABLE_FAILURE_COUNT;
+
+namespace {
+// The offset of the sensor count in the DEVICE_INFO data.
+const unsigned int SENSOR_COUNT_OFFSET = 18;
+}  // namespace
+
+bool RDMPoller::ValueKey::operator<(const ValueKey &other) const {
+  if (uid != other.uid) {
+    return uid < other.uid;
+  }
+  if (sub_device != other.sub_device) {
+    return sub_device < other.sub_device;
+  }
+  if (pid != other.pid) {
+    return pid < other.pid;
+  }
+  return index < other.index;
+}
+
+RDMPoller::RDMPoller(UniverseStore *universe_store,
+                     ola::thread::SchedulerInterface *scheduler,
+                     const UID &uid,
+                     const Options &options)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_uid(uid),
+      m_options(options),
+      m_refresh_timeout(INVALID_TIMEOUT),
+      m_request_count(0) {
+  m_refresh_timeout = m_scheduler->RegisterRepeatingTimeout(
+      REFRESH_INTERVAL_MS, NewCallback(this, &RDMPoller::RunRefresh));
+  Refresh();
+}
+
+RDMPoller::~RDMPoller() {
+  if (m_refresh_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_refresh_timeout);
+  }
+
+  UniversePollMap::iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    if (iter->second->poll_timeout != INVALID_TIMEOUT) {
+      m_scheduler->RemoveTimeout(iter->second->poll_timeout);
+    }
+  }
+  STLDeleteValues(&m_universes);
+}
+
+void RDMPoller::Refresh() {
+  vector<Universe*> universes;
+  m_universe_store->GetList(&universes);
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    if (STLContains(m_universes, (*iter)->UniverseId())) {
+      continue;
+    }
+    UIDSet uids;
+    (*iter)->GetUIDs(&uids);
+    if (uids.Size()) {
+      GetOrCreatePoll((*iter)->UniverseId());
+    }
+  }
+}
+
+void RDMPoller::GetValues(unsigned int universe,
+                          ola::proto::RDMPolledValues *values) const {
+  values->set_universe(universe);
+  const UniversePoll *poll = STLFindOrNull(m_universes, universe);
+  if (!poll) {
+    return;
+  }
+
+  ValueMap::const_iterator iter = poll->values.begin();
+  for (; iter != poll->values.end(); ++iter) {
+    AddValue(iter->first, iter->second, values);
+  }
+}
+
+void RDMPoller::AddClient(unsigned int universe, Client *client) {
+  GetOrCreatePoll(universe)->clients.insert(client);
+}
+
+void RDMPoller::RemoveClient(unsigned int universe, Client *client) {
+  UniversePoll *poll = STLFindOrNull(m_universes, universe);
+  if (poll) {
+    poll->clients.erase(client);
+  }
+}
+
+void RDMPoller::RemoveClient(Client *client) {
+  UniversePollMap::iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    iter->second->clients.erase(client);
+  }
+}
+
+bool RDMPoller::RunRefresh() {
+  Refresh();
+  return true;
+}
+
+RDMPoller::UniversePoll *RDMPoller::GetOrCreatePoll(unsigned int universe) {
+  UniversePoll *poll = STLFindOrNull(m_universes, universe);
+  if (poll) {
+    return poll;
+  }
+
+  poll = new UniversePoll();
+  poll->universe = universe;
+  poll->next_item = 0;
+  poll->in_flight = false;
+  poll->request_count = 0;
+  poll->poll_timeout = INVALID_TIMEOUT;
+  m_universes[universe] = poll;
+  SchedulePoll(poll, TimeInterval());
+  return poll;
+}
+
+void RDMPoller::Poll(UniversePoll *poll) {
+  poll->poll_timeout = INVALID_TIMEOUT;
+
+  Universe *universe = m_universe_store->GetUniverse(poll->universe);
+  if (!universe) {
+    if (!MaybeRemovePoll(poll)) {
+      SchedulePoll(poll, m_options.cycle_time);
+    }
+    return;
+  }
+
+  if (poll->next_item >= poll->items.size()) {
+    // Start the next cycle, picking up any changes to the devices.
+    BuildItems(poll, universe);
+    poll->next_item = 0;
+    if (poll->items.empty()) {
+      SchedulePoll(poll, m_options.cycle_time);
+      return;
+    }
+  }
+
+  if (universe->ActivePriority() > m_options.max_priority) {
+    SchedulePoll(poll, PollInterval(poll));
+    return;
+  }
+
+  if (universe->RDMRequestCount() != poll->request_count) {
+    // Someone else is using RDM on this universe, wait for them to finish.
+    poll->request_count = universe->RDMRequestCount();
+    SchedulePoll(poll, m_options.idle_time);
+    return;
+  }
+
+  const PollItem &item = poll->items[poll->next_item++];
+  RDMGetRequest *request = new RDMGetRequest(
+      m_uid,
+      item.uid,
+      universe->GetRDMTransactionNumber(),
+      1,  // port id
+      ola::rdm::ROOT_RDM_DEVICE,
+      item.pid,
+      reinterpret_cast<const uint8_t*>(item.param_data.data()),
+      item.param_data.size());
+
+  m_request_count++;
+  poll->in_flight = true;
+  universe->SendRDMRequest(
+      request,
+      NewSingleCallback(this, &RDMPoller::RequestComplete, poll->universe,
+                        item));
+  poll->request_count = universe->RDMRequestCount();
+}
+
+void RDMPoller::SchedulePoll(UniversePoll *poll, const TimeInterval &delay) {
+  if (poll->poll_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(poll->poll_timeout);
+  }
+  poll->poll_timeout = m_scheduler->RegisterSingleTimeout(
+      delay, NewSingleCallback(this, &RDMPoller::Poll, poll));
+}
+
+void RDMPoller::BuildItems(UniversePoll *poll, const Universe *universe) {
+  UIDSet uids;
+  universe->GetUIDs(&uids);
+
+  // Forget the devices that have gone away.
+  DeviceMap::iterator device_iter = poll->devices.begin();
+  while (device_iter != poll->devices.end()) {
+    if (uids.Contains(device_iter->first)) {
+      ++device_iter;
+    } else {
+      poll->devices.erase(device_iter++);
+    }
+  }
+
+  poll->items.clear();
+  UIDSet::Iterator iter = uids.Begin();
+  for (; iter != uids.End(); ++iter) {
+    DeviceMap::iterator device = poll->devices.find(*iter);
+    if (device == poll->devices.end()) {
+      DeviceState state;
+      state.have_device_info = false;
+      state.sensor_count = 0;
+      device = poll->devices.insert(std::make_pair(*iter, state)).first;
+    }
+
+    PollItem item(*iter, ola::rdm::PID_DEVICE_INFO);
+    if (!device->second.have_device_info) {
+      poll->items.push_back(item);
+      continue;
+    }
+
+    // A device that has stopped answering is only sent one request a cycle,
+    // so it doesn't use up the time for the others.
+    const bool unreliable = (
+        universe->RDMStats().ConsecutiveFailures(*iter) >=
+        UNRELIABLE_FAILURE_COUNT);
+    const unsigned int first_item = poll->items.size();
+
+    const set<uint16_t> &unsupported = device->second.unsupported_pids;
+    const uint8_t status_type = ola::rdm::STATUS_ADVISORY;
+    item.param_data.assign(reinterpret_cast<const char*>(&status_type), 1);
+    if (!STLContains(unsupported, ola::rdm::PID_STATUS_MESSAGES)) {
+      item.pid = ola::rdm::PID_STATUS_MESSAGES;
+      poll->items.push_back(item);
+    }
+    if (!STLContains(unsupported, ola::rdm::PID_QUEUED_MESSAGE)) {
+      item.pid = ola::rdm::PID_QUEUED_MESSAGE;
+      poll->items.push_back(item);
+    }
+    if (!STLContains(unsupported, ola::rdm::PID_SENSOR_VALUE)) {
+      item.pid = ola::rdm::PID_SENSOR_VALUE;
+      for (unsigned int i = 0; i < device->second.sensor_count; i++) {
+        item.param_data.assign(1, static_cast<char>(i));
+        poll->items.push_back(item);
+      }
+    }
+    if (unreliable && poll->items.size() > first_item + 1) {
+      poll->items.erase(poll->items.begin() + first_item + 1,
+                        poll->items.end());
+    }
+  }
+}
+
+void RDMPoller::RequestComplete(unsigned int universe, PollItem item,
+                                RDMReply *reply) {
+  UniversePoll *poll = STLFindOrNull(m_universes, universe);
+  if (!poll) {
+    return;
+  }
+  poll->in_flight = false;
+
+  const RDMResponse *response = reply->Response();
+  if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK && response) {
+    switch (response->ResponseType()) {
+      case ola::rdm::RDM_ACK:
+        HandleAck(poll, item, response);
+        break;
+      case ola::rdm::RDM_NACK_REASON:
+        HandleNack(poll, item, response);
+        break;
+      default:
+        // ACK_TIMERs aren't followed up, the next cycle polls again.
+        break;
+    }
+  } else {
+    OLA_DEBUG << "RDM poll of " << item.uid << " failed: "
+              << ola::rdm::StatusCodeToString(reply->StatusCode());
+  }
+
+  if (!MaybeRemovePoll(poll)) {
+    SchedulePoll(poll, PollInterval(poll));
+  }
+}
+
+void RDMPoller::HandleAck(UniversePoll *poll, const PollItem &item,
+                          const RDMResponse *response) {
+  if (item.pid == ola::rdm::PID_DEVICE_INFO) {
+    DeviceState *device = STLFind(&poll->devices, item.uid);
+    if (device) {
+      device->have_device_info = true;
+      device->sensor_count = (
+          response->ParamDataSize() > SENSOR_COUNT_OFFSET ?
+          response->ParamData()[SENSOR_COUNT_OFFSET] : 0);
+    }
+    return;
+  }
+
+  // A QUEUED_MESSAGE may be answered with any PID, so the key comes from the
+  // response.
+  const string data(reinterpret_cast<const char*>(response->ParamData()),
+                    response->ParamDataSize());
+  int index = -1;
+  if (response->ParamId() == ola::rdm::PID_SENSOR_VALUE && !data.empty()) {
+    index = static_cast<uint8_t>(data[0]);
+  }
+  const ValueKey key(item.uid, response->SubDevice(), response->ParamId(),
+                     index);
+
+  std::pair<ValueMap::iterator, bool> result = poll->values.insert(
+      std::make_pair(key, data));
+  if (!result.second) {
+    if (result.first->second == data) {
+      return;
+    }
+    result.first->second = data;
+  }
+  NotifyClients(poll, key, data);
+}
+
+void RDMPoller::HandleNack(UniversePoll *poll, const PollItem &item,
+                           const RDMResponse *response) {
+  uint16_t reason = 0;
+  if (response->ParamDataSize() >= sizeof(reason)) {
+    reason = static_cast<uint16_t>((response->ParamData()[0] << 8) |
+                                   response->ParamData()[1]);
+  }
+  if (reason != ola::rdm::NR_UNKNOWN_PID &&
+      reason != ola::rdm::NR_UNSUPPORTED_COMMAND_CLASS) {
+    return;
+  }
+
+  DeviceState *device = STLFind(&poll->devices, item.uid);
+  if (!device) {
+    return;
+  }
+  if (item.pid == ola::rdm::PID_DEVICE_INFO) {
+    // Without DEVICE_INFO we don't know about the sensors, but we can still
+    // poll the status.
+    device->have_device_info = true;
+  } else {
+    device->unsupported_pids.insert(item.pid);
+  }
+}
+
+void RDMPoller::NotifyClients(const UniversePoll *poll, const ValueKey &key,
+                              const string &data) {
+  if (poll->clients.empty()) {
+    return;
+  }
+
+  ola::proto::RDMPolledValues values;
+  values.set_universe(poll->universe);
+  AddValue(key, data, &values);
+  set<Client*>::const_iterator iter = poll->clients.begin();
+  for (; iter != poll->clients.end(); ++iter) {
+    (*iter)->SendRDMPolledValues(values);
+  }
+}
+
+TimeInterval RDMPoller::PollInterval(const UniversePoll *poll) const {
+  if (poll->items.size() <= 1) {
+    return m_options.cycle_time;
+  }
+  return TimeInterval(
+      m_options.cycle_time.AsInt() /
+      static_cast<int64_t>(poll->items.size()));
+}
+
+/*
+ * Remove the state for a universe that has gone away, unless there are still
+ * clients registered for it.
+ */
+bool RDMPoller::MaybeRemovePoll(UniversePoll *poll) {
+  if (poll->in_flight || !poll->clients.empty() ||
+      m_universe_store->GetUniverse(poll->universe)) {
+    return false;
+  }
+
+  if (poll->poll_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(poll->poll_timeout);
+  }
+  m_universes.erase(poll->universe);
+  delete poll;
+  return true;
+}
+
+void RDMPoller::AddValue(const ValueKey &key, const string &data,
+                         ola::proto::RDMPolledValues *values) {
+  ola::proto::RDMPolledValue *value = values->add_value();
+  value->mutable_uid()->set_esta_id(key.uid.ManufacturerId());
+  value->mutable_uid()->set_device_id(key.uid.DeviceId());
+  value->set_sub_device(key.sub_device);
+  value->set_param_id(key.pid);
+  if (key.index >= 0) {
+    value->set_index(key.index);
+  }
+  value->set_data(data);
+}
+}  // namespace ola
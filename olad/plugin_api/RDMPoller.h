@@ -0,0 +1,225 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPoller.h
+ * Polls RDM sensors & status messages from within olad.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMPOLLER_H_
+#define OLAD_PLUGIN_API_RDMPOLLER_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+namespace proto {
+class RDMPolledValues;
+}
+
+class Client;
+
+/**
+ * @brief Polls the RDM devices on each universe for their sensors & status.
+ *
+ * Monitoring tools want the SENSOR_VALUE, STATUS_MESSAGES and QUEUED_MESSAGE
+ * data from every device. Rather than each of them sending their own GETs,
+ * olad polls the devices once and caches the latest values. Clients can
+ * fetch the values, or register to be sent the values that change.
+ *
+ * Each device is first asked for DEVICE_INFO, to find the number of sensors.
+ * From the next cycle on it's polled for each sensor, its status messages
+ * and its queued messages. A PID that the device NACKs as unknown isn't
+ * polled again.
+ *
+ * The GETs for a universe are spread evenly over the cycle time, with at most
+ * one outstanding at once. A device that has failed to answer the last
+ * UNRELIABLE_FAILURE_COUNT requests, going by the universe's
+ * RDMResponderStats, is only sent one GET a cycle until it answers again.
+ * Polling on a universe backs off while other RDM requests are being sent to
+ * it, and while the universe's active DMX priority is above max_priority.
+ *
+ * The poller must be deleted after the ports have been removed from the
+ * universes, so no RDM requests are outstanding.
+ */
+class RDMPoller {
+ public:
+  struct Options {
+    Options()
+        : cycle_time(DEFAULT_CYCLE_TIME_S, 0),
+          idle_time(0, DEFAULT_IDLE_TIME_MS * 1000),
+          max_priority(ola::dmx::SOURCE_PRIORITY_MAX) {
+    }
+
+    // The time to poll every parameter on a universe once.
+    TimeInterval cycle_time;
+    // Polling waits until there haven't been any other RDM requests on the
+    // universe for this long.
+    TimeInterval idle_time;
+    // Universes with an active DMX priority above this aren't polled.
+    uint8_t max_priority;
+  };
+
+  /**
+   * @brief Create a new RDMPoller.
+   * @param universe_store the UniverseStore to find the universes in.
+   * @param scheduler the scheduler used to time the polls.
+   * @param uid the UID the requests are sent from.
+   * @param options the Options to use.
+   */
+  RDMPoller(class UniverseStore *universe_store,
+            ola::thread::SchedulerInterface *scheduler,
+            const ola::rdm::UID &uid,
+            const Options &options = Options());
+  ~RDMPoller();
+
+  /**
+   * @brief Check the universes for devices that aren't being polled yet.
+   *
+   * This is run regularly, it's public for the tests.
+   */
+  void Refresh();
+
+  /**
+   * @brief Get the latest values for a universe.
+   * @param universe the universe id.
+   * @param[out] values the values.
+   */
+  void GetValues(unsigned int universe,
+                 ola::proto::RDMPolledValues *values) const;
+
+  /**
+   * @brief Send a client the values for a universe as they change.
+   * @param universe the universe id.
+   * @param client the client, ownership is not transferred.
+   */
+  void AddClient(unsigned int universe, Client *client);
+
+  /**
+   * @brief Stop sending a client the values for a universe.
+   */
+  void RemoveClient(unsigned int universe, Client *client);
+
+  /**
+   * @brief Stop sending a client the values for all universes.
+   *
+   * This must be called before the client is deleted.
+   */
+  void RemoveClient(Client *client);
+
+  /**
+   * @brief The number of RDM requests the poller has sent.
+   */
+  unsigned int RequestCount() const { return m_request_count; }
+
+  static const unsigned int DEFAULT_CYCLE_TIME_S = 10;
+  static const unsigned int DEFAULT_IDLE_TIME_MS = 200;
+  static const unsigned int REFRESH_INTERVAL_MS = 5000;
+  static const unsigned int UNRELIABLE_FAILURE_COUNT = 3;
+
+ private:
+  struct PollItem {
+    PollItem(const ola::rdm::UID &uid, uint16_t pid) : uid(uid), pid(pid) {}
+
+    ola::rdm::UID uid;
+    uint16_t pid;
+    std::string param_data;
+  };
+
+  typedef struct {
+    bool have_device_info;
+    uint8_t sensor_count;
+    // The PIDs the device NACKed as unknown.
+    std::set<uint16_t> unsupported_pids;
+  } DeviceState;
+
+  // A value is identified by the device, the sub device, the PID and for
+  // SENSOR_VALUE, the sensor number.
+  struct ValueKey {
+    ValueKey(const ola::rdm::UID &uid, uint16_t sub_device, uint16_t pid,
+             int index)
+        : uid(uid), sub_device(sub_device), pid(pid), index(index) {
+    }
+
+    ola::rdm::UID uid;
+    uint16_t sub_device;
+    uint16_t pid;
+    int index;  // -1 if there isn't one
+
+    bool operator<(const ValueKey &other) const;
+  };
+
+  typedef std::map<ola::rdm::UID, DeviceState> DeviceMap;
+  typedef std::map<ValueKey, std::string> ValueMap;
+
+  typedef struct {
+    unsigned int universe;
+    DeviceMap devices;
+    std::vector<PollItem> items;
+    unsigned int next_item;
+    bool in_flight;
+    // The RDM request count of the universe after our last request, if this
+    // changes someone else has sent a request.
+    unsigned int request_count;
+    ola::thread::timeout_id poll_timeout;
+    ValueMap values;
+    std::set<Client*> clients;
+  } UniversePoll;
+
+  typedef std::map<unsigned int, UniversePoll*> UniversePollMap;
+
+  class UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  const ola::rdm::UID m_uid;
+  const Options m_options;
+  UniversePollMap m_universes;
+  ola::thread::timeout_id m_refresh_timeout;
+  unsigned int m_request_count;
+
+  bool RunRefresh();
+  UniversePoll *GetOrCreatePoll(unsigned int universe);
+  void Poll(UniversePoll *poll);
+  void SchedulePoll(UniversePoll *poll, const TimeInterval &delay);
+  void BuildItems(UniversePoll *poll, const class Universe *universe);
+  void RequestComplete(unsigned int universe, PollItem item,
+                       ola::rdm::RDMReply *reply);
+  void HandleAck(UniversePoll *poll, const PollItem &item,
+                 const ola::rdm::RDMResponse *response);
+  void HandleNack(UniversePoll *poll, const PollItem &item,
+                  const ola::rdm::RDMResponse *response);
+  void NotifyClients(const UniversePoll *poll, const ValueKey &key,
+                     const std::string &data);
+  TimeInterval PollInterval(const UniversePoll *poll) const;
+  bool MaybeRemovePoll(UniversePoll *poll);
+
+  static void AddValue(const ValueKey &key, const std::string &data,
+                       ola::proto::RDMPolledValues *values);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMPoller);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMPOLLER_H_
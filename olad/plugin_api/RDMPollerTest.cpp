@@ -0,0 +1,387 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ * RDMPollerTest.cpp
+ * Test fixture for the RDMPoller class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "olad/DmxSource.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/RDMPoller.h"
+#include "olad/plugin_api/RDMResponderStats.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::RDMPoller;
+using ola::TimeInterval;
+using ola::Universe;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+using std::vector;
+
+static const unsigned int TEST_UNIVERSE = 1;
+
+/*
+ * A client that records the values it's sent.
+ */
+class MockPollClient: public ola::Client {
+ public:
+  MockPollClient()
+      : ola::Client(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 0)) {
+  }
+
+  bool SendRDMPolledValues(const ola::proto::RDMPolledValues &values) {
+    m_values.push_back(values);
+    return true;
+  }
+
+  vector<ola::proto::RDMPolledValues> m_values;
+};
+
+
+class RDMPollerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMPollerTest);
+  CPPUNIT_TEST(testPolling);
+  CPPUNIT_TEST(testBackOff);
+  CPPUNIT_TEST(testPriority);
+  CPPUNIT_TEST(testUnreliableDevice);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMPollerTest()
+      : m_uid(0x7a70, 1),
+        m_port(NULL, 1, &m_uids, true,
+               NewCallback(this, &RDMPollerTest::HandleRDM)),
+        m_request(NULL),
+        m_callback(NULL) {
+    m_uids.AddUID(m_uid);
+  }
+
+  void setUp();
+  void tearDown();
+  void testPolling();
+  void testBackOff();
+  void testPriority();
+  void testUnreliableDevice();
+
+ private:
+  UIDSet m_uids;
+  UID m_uid;
+  TestMockRDMOutputPort m_port;
+  MockScheduler m_scheduler;
+  ola::MemoryPreferences *m_preferences;
+  ola::UniverseStore *m_store;
+  Universe *m_universe;
+  const RDMRequest *m_request;
+  RDMCallback *m_callback;
+
+  void HandleRDM(const RDMRequest *request, RDMCallback *callback) {
+    OLA_ASSERT_NULL(m_request);
+    m_request = request;
+    m_callback = callback;
+  }
+
+  void IgnoreReply(RDMReply*) {}
+
+  uint16_t PendingPid() const {
+    OLA_ASSERT_NOT_NULL(m_request);
+    return m_request->ParamId();
+  }
+
+  void Respond(RDMResponse *response);
+  void RespondWithData(const uint8_t *data, unsigned int length);
+  void RespondWithNack(ola::rdm::rdm_nack_reason reason);
+  void Fail(ola::rdm::RDMStatusCode status_code);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMPollerTest);
+
+static const uint8_t SENSOR_0[] = {0, 0, 20, 0, 0, 0, 0, 0, 0};
+static const uint8_t SENSOR_1[] = {1, 0, 30, 0, 0, 0, 0, 0, 0};
+
+
+void RDMPollerTest::setUp() {
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(m_universe);
+  m_universe->AddPort(&m_port);
+  m_port.SetUniverse(m_universe);
+}
+
+
+void RDMPollerTest::tearDown() {
+  m_universe->RemovePort(&m_port);
+  m_port.SetUniverse(NULL);
+  delete m_store;
+  delete m_preferences;
+}
+
+
+void RDMPollerTest::Respond(RDMResponse *response) {
+  const RDMRequest *request = m_request;
+  RDMCallback *callback = m_callback;
+  m_request = NULL;
+  m_callback = NULL;
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK, response);
+  callback->Run(&reply);
+  delete request;
+}
+
+
+void RDMPollerTest::RespondWithData(const uint8_t *data,
+                                    unsigned int length) {
+  Respond(ola::rdm::GetResponseFromData(m_request, data, length));
+}
+
+
+void RDMPollerTest::RespondWithNack(ola::rdm::rdm_nack_reason reason) {
+  Respond(ola::rdm::NackWithReason(m_request, reason));
+}
+
+
+void RDMPollerTest::Fail(ola::rdm::RDMStatusCode status_code) {
+  const RDMRequest *request = m_request;
+  RDMCallback *callback = m_callback;
+  m_request = NULL;
+  m_callback = NULL;
+  RDMReply reply(status_code);
+  callback->Run(&reply);
+  delete request;
+}
+
+
+/*
+ * Check a device is polled for each of its sensors & status.
+ */
+void RDMPollerTest::testPolling() {
+  RDMPoller::Options options;
+  options.cycle_time = TimeInterval(1, 0);
+  RDMPoller poller(m_store, &m_scheduler, UID(0x7a70, 100), options);
+  MockPollClient client;
+  poller.AddClient(TEST_UNIVERSE, &client);
+
+  // The first cycle fetches DEVICE_INFO
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_DEVICE_INFO, PendingPid());
+  uint8_t device_info[19] = {0};
+  device_info[18] = 2;  // sensor count
+  RespondWithData(device_info, sizeof(device_info));
+  OLA_ASSERT_EQ(TimeInterval(1, 0), m_scheduler.LastDelay());
+
+  // The next cycle has the status, queued message & the two sensors.
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_STATUS_MESSAGES, PendingPid());
+  OLA_ASSERT_EQ(1u, m_request->ParamDataSize());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::STATUS_ADVISORY),
+                m_request->ParamData()[0]);
+  RespondWithNack(ola::rdm::NR_UNKNOWN_PID);
+  OLA_ASSERT_EQ(TimeInterval(0, 250000), m_scheduler.LastDelay());
+
+  // Queued messages are stored under the PID of the response.
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_QUEUED_MESSAGE, PendingPid());
+  Respond(ola::rdm::GetResponseWithPid(m_request,
+                                       ola::rdm::PID_STATUS_MESSAGES,
+                                       NULL, 0));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client.m_values.size());
+  OLA_ASSERT_EQ(1, client.m_values[0].value_size());
+  OLA_ASSERT_EQ(static_cast<unsigned int>(ola::rdm::PID_STATUS_MESSAGES),
+                client.m_values[0].value(0).param_id());
+
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_SENSOR_VALUE, PendingPid());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), m_request->ParamData()[0]);
+  RespondWithData(SENSOR_0, sizeof(SENSOR_0));
+
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_SENSOR_VALUE, PendingPid());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), m_request->ParamData()[0]);
+  RespondWithData(SENSOR_1, sizeof(SENSOR_1));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), client.m_values.size());
+  OLA_ASSERT_EQ(1u, client.m_values[2].value(0).index());
+  OLA_ASSERT_EQ(string(reinterpret_cast<const char*>(SENSOR_1),
+                       sizeof(SENSOR_1)),
+                client.m_values[2].value(0).data());
+
+  ola::proto::RDMPolledValues values;
+  poller.GetValues(TEST_UNIVERSE, &values);
+  OLA_ASSERT_EQ(static_cast<int>(TEST_UNIVERSE), values.universe());
+  OLA_ASSERT_EQ(3, values.value_size());
+
+  // STATUS_MESSAGES was NACKed so it's dropped from the next cycle. Values
+  // that haven't changed aren't sent to the clients.
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_QUEUED_MESSAGE, PendingPid());
+  Respond(ola::rdm::GetResponseWithPid(m_request,
+                                       ola::rdm::PID_STATUS_MESSAGES,
+                                       NULL, 0));
+  OLA_ASSERT_EQ(TimeInterval(0, 333333), m_scheduler.LastDelay());
+  OLA_ASSERT_EQ(static_cast<size_t>(3), client.m_values.size());
+
+  poller.RemoveClient(&client);
+  m_scheduler.RunTimeouts();
+  uint8_t changed_sensor[sizeof(SENSOR_0)];
+  memcpy(changed_sensor, SENSOR_0, sizeof(SENSOR_0));
+  changed_sensor[2] = 21;
+  RespondWithData(changed_sensor, sizeof(changed_sensor));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), client.m_values.size());
+  OLA_ASSERT_EQ(7u, poller.RequestCount());
+}
+
+
+/*
+ * Check polling backs off while other RDM requests are being sent.
+ */
+void RDMPollerTest::testBackOff() {
+  RDMPoller poller(m_store, &m_scheduler, UID(0x7a70, 100));
+
+  m_scheduler.RunTimeouts();
+  RespondWithNack(ola::rdm::NR_UNKNOWN_PID);
+  OLA_ASSERT_EQ(1u, poller.RequestCount());
+
+  // Another controller sends a request
+  m_universe->SendRDMRequest(
+      new ola::rdm::RDMGetRequest(UID(0x7a70, 200), m_uid, 0, 1, 0,
+                                  ola::rdm::PID_DEVICE_LABEL, NULL, 0),
+      NewSingleCallback(this, &RDMPollerTest::IgnoreReply));
+  RespondWithNack(ola::rdm::NR_UNKNOWN_PID);
+
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_NULL(m_request);
+  OLA_ASSERT_EQ(1u, poller.RequestCount());
+  OLA_ASSERT_EQ(TimeInterval(0, RDMPoller::DEFAULT_IDLE_TIME_MS * 1000),
+                m_scheduler.LastDelay());
+
+  // Once it's idle again, the polling resumes.
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_STATUS_MESSAGES, PendingPid());
+  OLA_ASSERT_EQ(2u, poller.RequestCount());
+  RespondWithNack(ola::rdm::NR_UNKNOWN_PID);
+}
+
+
+/*
+ * Check universes with a high priority source aren't polled.
+ */
+void RDMPollerTest::testPriority() {
+  RDMPoller::Options options;
+  options.max_priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  RDMPoller poller(m_store, &m_scheduler, UID(0x7a70, 100), options);
+
+  MockPollClient source;
+  ola::TimeStamp now;
+  ola::Clock clock;
+  clock.CurrentMonotonicTime(&now);
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  source.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(buffer, now, ola::dmx::SOURCE_PRIORITY_MAX));
+  m_universe->AddSourceClient(&source);
+  m_universe->SourceClientDataChanged(&source);
+
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_NULL(m_request);
+  OLA_ASSERT_EQ(0u, poller.RequestCount());
+
+  // Once the priority drops, the polling starts.
+  source.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(buffer, now, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  m_universe->SourceClientDataChanged(&source);
+  m_universe->RemoveSourceClient(&source);
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_DEVICE_INFO, PendingPid());
+  OLA_ASSERT_EQ(1u, poller.RequestCount());
+  RespondWithNack(ola::rdm::NR_UNKNOWN_PID);
+}
+
+
+/*
+ * Check a device that stops answering is only polled once a cycle.
+ */
+void RDMPollerTest::testUnreliableDevice() {
+  RDMPoller poller(m_store, &m_scheduler, UID(0x7a70, 100));
+
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_DEVICE_INFO, PendingPid());
+  uint8_t device_info[19] = {0};
+  device_info[18] = 2;  // sensor count
+  RespondWithData(device_info, sizeof(device_info));
+
+  // The cycle that was already built still polls everything.
+  for (unsigned int i = 0; i < 4; i++) {
+    m_scheduler.RunTimeouts();
+    OLA_ASSERT_NOT_NULL(m_request);
+    Fail(ola::rdm::RDM_TIMEOUT);
+  }
+
+  const ola::RDMResponderStats::Stats *stats =
+      m_universe->RDMStats().Get(m_uid);
+  OLA_ASSERT_NOT_NULL(stats);
+  OLA_ASSERT_EQ(5u, stats->requests);
+  OLA_ASSERT_EQ(1u, stats->acks);
+  OLA_ASSERT_EQ(4u, stats->timeouts);
+  OLA_ASSERT_EQ(4u, stats->consecutive_failures);
+
+  // Now each cycle only has a single request.
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_STATUS_MESSAGES, PendingPid());
+  Fail(ola::rdm::RDM_TIMEOUT);
+  OLA_ASSERT_EQ(RDMPoller::Options().cycle_time, m_scheduler.LastDelay());
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_STATUS_MESSAGES, PendingPid());
+  RespondWithData(NULL, 0);
+  OLA_ASSERT_EQ(0u, stats->consecutive_failures);
+
+  // Once it answers, the full cycle resumes.
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_STATUS_MESSAGES, PendingPid());
+  RespondWithData(NULL, 0);
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(ola::rdm::PID_QUEUED_MESSAGE, PendingPid());
+  RespondWithData(NULL, 0);
+  OLA_ASSERT_EQ(9u, poller.RequestCount());
+}
@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponderStats.cpp
+ * Records the latency & reliability of the RDM responders on a universe.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/RDMResponderStats.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "ola/base/Array.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+
+using ola::rdm::RDMReply;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+
+const unsigned int RDMResponderStats::LATENCY_BUCKETS_MS[] = {
+  1, 2, 5, 10, 20, 50, 100, 200, 500, 1000
+};
+
+// One more than the limits, for the overflow bucket.
+const unsigned int RDMResponderStats::LATENCY_BUCKET_COUNT =
+    arraysize(LATENCY_BUCKETS_MS) + 1;
+
+RDMResponderStats::Stats::Stats()
+    : requests(0),
+      acks(0),
+      ack_timers(0),
+      nacks(0),
+      timeouts(0),
+      failures(0),
+      consecutive_failures(0),
+      latency_buckets(LATENCY_BUCKET_COUNT, 0) {
+}
+
+void RDMResponderStats::RequestComplete(const UID &uid,
+                                        const TimeInterval &latency,
+                                        const RDMReply &reply) {
+  Stats &stats = m_stats[uid];
+  stats.requests++;
+
+  const RDMResponse *response = reply.Response();
+  if (reply.StatusCode() != ola::rdm::RDM_COMPLETED_OK || !response) {
+    if (reply.StatusCode() == ola::rdm::RDM_TIMEOUT) {
+      stats.timeouts++;
+    } else {
+      stats.failures++;
+    }
+    stats.consecutive_failures++;
+    return;
+  }
+
+  switch (response->ResponseType()) {
+    case ola::rdm::RDM_ACK:
+    case ola::rdm::ACK_OVERFLOW:
+      stats.acks++;
+      break;
+    case ola::rdm::RDM_ACK_TIMER:
+      stats.ack_timers++;
+      break;
+    case ola::rdm::RDM_NACK_REASON:
+      {
+        stats.nacks++;
+        uint16_t reason = 0;
+        if (response->ParamDataSize() >= sizeof(reason)) {
+          reason = static_cast<uint16_t>((response->ParamData()[0] << 8) |
+                                         response->ParamData()[1]);
+        }
+        stats.nack_reasons[reason]++;
+      }
+      break;
+    default:
+      stats.failures++;
+      stats.consecutive_failures++;
+      return;
+  }
+
+  stats.consecutive_failures = 0;
+  stats.latency_buckets[LatencyBucket(latency)]++;
+  if (stats.Responses() == 1 || latency < stats.min_latency) {
+    stats.min_latency = latency;
+  }
+  if (latency > stats.max_latency) {
+    stats.max_latency = latency;
+  }
+  stats.total_latency += latency;
+}
+
+const RDMResponderStats::Stats *RDMResponderStats::Get(const UID &uid) const {
+  return STLFind(&m_stats, uid);
+}
+
+void RDMResponderStats::GetUIDs(UIDSet *uids) const {
+  StatsMap::const_iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    uids->AddUID(iter->first);
+  }
+}
+
+TimeInterval RDMResponderStats::LatencyPercentile(
+    const UID &uid,
+    unsigned int percentile) const {
+  const Stats *stats = STLFind(&m_stats, uid);
+  if (!stats || !stats->Responses()) {
+    return TimeInterval();
+  }
+
+  // The number of responses that must be at or under the latency, rounded
+  // up.
+  const unsigned int target = std::max(
+      1u, (stats->Responses() * std::min(percentile, 100u) + 99) / 100);
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < LATENCY_BUCKET_COUNT - 1; i++) {
+    count += stats->latency_buckets[i];
+    if (count >= target) {
+      return TimeInterval(
+          static_cast<int64_t>(LATENCY_BUCKETS_MS[i]) * ONE_THOUSAND);
+    }
+  }
+  return stats->max_latency;
+}
+
+unsigned int RDMResponderStats::ConsecutiveFailures(const UID &uid) const {
+  const Stats *stats = STLFind(&m_stats, uid);
+  return stats ? stats->consecutive_failures : 0;
+}
+
+void RDMResponderStats::Retain(const UIDSet &uids) {
+  StatsMap::iterator iter = m_stats.begin();
+  while (iter != m_stats.end()) {
+    if (uids.Contains(iter->first)) {
+      ++iter;
+    } else {
+      m_stats.erase(iter++);
+    }
+  }
+}
+
+unsigned int RDMResponderStats::LatencyBucket(const TimeInterval &latency) {
+  const int64_t latency_us = latency.AsInt();
+  for (unsigned int i = 0; i < LATENCY_BUCKET_COUNT - 1; i++) {
+    if (latency_us <= static_cast<int64_t>(LATENCY_BUCKETS_MS[i]) *
+                      ONE_THOUSAND) {
+      return i;
+    }
+  }
+  return LATENCY_BUCKET_COUNT - 1;
+}
+}  // namespace ola
@@ -0,0 +1,150 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponderStats.h
+ * Records the latency & reliability of the RDM responders on a universe.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMRESPONDERSTATS_H_
+#define OLAD_PLUGIN_API_RDMRESPONDERSTATS_H_
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+
+namespace ola {
+
+/**
+ * @brief Statistics on how each RDM responder on a universe behaves.
+ *
+ * The Universe records the outcome of every unicast request it sends: the
+ * time until the response, and whether it was an ACK, an ACK_TIMER, a NACK
+ * (and the reason) or a failure such as a timeout. The latencies are kept in
+ * a histogram, so the memory used per responder is fixed.
+ *
+ * The pollers use the stats to back off from responders that stop
+ * answering, and to pick timeouts from the observed latency.
+ *
+ * This isn't thread safe, it's used from the SelectServer thread.
+ */
+class RDMResponderStats {
+ public:
+  /**
+   * @brief The stats for a single responder.
+   */
+  struct Stats {
+    unsigned int requests;
+    unsigned int acks;
+    unsigned int ack_timers;
+    unsigned int nacks;
+    unsigned int timeouts;
+    // Failures other than timeouts, e.g. checksum errors.
+    unsigned int failures;
+    // The number of requests since the last response, of any type.
+    unsigned int consecutive_failures;
+    // NACK reason code to count.
+    std::map<uint16_t, unsigned int> nack_reasons;
+    // The number of responses in each bucket of LATENCY_BUCKETS_MS.
+    std::vector<unsigned int> latency_buckets;
+    // Only responses are counted in the latency.
+    TimeInterval min_latency;
+    TimeInterval max_latency;
+    TimeInterval total_latency;
+
+    Stats();
+
+    /**
+     * @brief The number of requests that got a response.
+     */
+    unsigned int Responses() const { return acks + ack_timers + nacks; }
+  };
+
+  RDMResponderStats() {}
+  ~RDMResponderStats() {}
+
+  /**
+   * @brief Record the outcome of a request.
+   * @param uid the responder the request was sent to.
+   * @param latency the time from sending the request to the reply.
+   * @param reply the reply.
+   */
+  void RequestComplete(const ola::rdm::UID &uid,
+                       const TimeInterval &latency,
+                       const ola::rdm::RDMReply &reply);
+
+  /**
+   * @brief Get the stats for a responder.
+   * @returns the Stats or NULL if no requests have been sent to it.
+   */
+  const Stats *Get(const ola::rdm::UID &uid) const;
+
+  /**
+   * @brief Get the UIDs of the responders with stats.
+   */
+  void GetUIDs(ola::rdm::UIDSet *uids) const;
+
+  /**
+   * @brief Return an upper bound on the latency of a percentage of the
+   *   responses from a responder.
+   * @param uid the responder.
+   * @param percentile the percentage of responses, from 1 to 100.
+   * @returns the upper limit of the histogram bucket the percentile falls in,
+   *   or a zero TimeInterval if there haven't been any responses. The last
+   *   bucket has no upper limit, the maximum latency is used instead.
+   */
+  TimeInterval LatencyPercentile(const ola::rdm::UID &uid,
+                                 unsigned int percentile) const;
+
+  /**
+   * @brief The number of requests sent to a responder since it last answered.
+   */
+  unsigned int ConsecutiveFailures(const ola::rdm::UID &uid) const;
+
+  /**
+   * @brief Drop the stats for responders that are no longer present.
+   * @param uids the responders to keep.
+   */
+  void Retain(const ola::rdm::UIDSet &uids);
+
+  /**
+   * @brief The number of responders with stats.
+   */
+  unsigned int Size() const { return m_stats.size(); }
+
+  /**
+   * @brief The upper limit of each latency bucket, in milliseconds. The last
+   *   bucket holds everything above the final limit.
+   */
+  static const unsigned int LATENCY_BUCKETS_MS[];
+  static const unsigned int LATENCY_BUCKET_COUNT;
+
+ private:
+  typedef std::map<ola::rdm::UID, Stats> StatsMap;
+
+  StatsMap m_stats;
+
+  static unsigned int LatencyBucket(const TimeInterval &latency);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMResponderStats);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMRESPONDERSTATS_H_
@@ -0,0 +1,176 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponderStatsTest.cpp
+ * Test fixture for the RDMResponderStats class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Clock.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "olad/plugin_api/RDMResponderStats.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::RDMResponderStats;
+using ola::TimeInterval;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+
+class RDMResponderStatsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMResponderStatsTest);
+  CPPUNIT_TEST(testOutcomes);
+  CPPUNIT_TEST(testLatency);
+  CPPUNIT_TEST(testRetain);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMResponderStatsTest()
+      : m_uid(0x7a70, 1),
+        m_request(UID(0x7a70, 100), m_uid, 0, 1, 0,
+                  ola::rdm::PID_DEVICE_LABEL, NULL, 0) {
+  }
+
+  void testOutcomes();
+  void testLatency();
+  void testRetain();
+
+ private:
+  UID m_uid;
+  RDMGetRequest m_request;
+
+  void Ack(RDMResponderStats *stats, unsigned int latency_ms) {
+    RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                   ola::rdm::GetResponseFromData(&m_request, NULL, 0));
+    stats->RequestComplete(
+        m_uid, TimeInterval(static_cast<int64_t>(latency_ms) * 1000), reply);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMResponderStatsTest);
+
+
+/*
+ * Check each type of reply is counted.
+ */
+void RDMResponderStatsTest::testOutcomes() {
+  RDMResponderStats stats;
+  OLA_ASSERT_NULL(stats.Get(m_uid));
+  OLA_ASSERT_EQ(0u, stats.ConsecutiveFailures(m_uid));
+
+  Ack(&stats, 2);
+  RDMReply ack_timer(
+      ola::rdm::RDM_COMPLETED_OK,
+      ola::rdm::GetResponseFromData(&m_request, NULL, 0,
+                                    ola::rdm::RDM_ACK_TIMER));
+  stats.RequestComplete(m_uid, TimeInterval(0, 3000), ack_timer);
+  RDMReply nack(ola::rdm::RDM_COMPLETED_OK,
+                ola::rdm::NackWithReason(&m_request,
+                                         ola::rdm::NR_DATA_OUT_OF_RANGE));
+  stats.RequestComplete(m_uid, TimeInterval(0, 4000), nack);
+  stats.RequestComplete(m_uid, TimeInterval(0, 4000), nack);
+
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  stats.RequestComplete(m_uid, TimeInterval(0, 50000), timeout);
+  RDMReply bad_checksum(ola::rdm::RDM_CHECKSUM_INCORRECT);
+  stats.RequestComplete(m_uid, TimeInterval(0, 5000), bad_checksum);
+
+  const RDMResponderStats::Stats *uid_stats = stats.Get(m_uid);
+  OLA_ASSERT_NOT_NULL(uid_stats);
+  OLA_ASSERT_EQ(6u, uid_stats->requests);
+  OLA_ASSERT_EQ(1u, uid_stats->acks);
+  OLA_ASSERT_EQ(1u, uid_stats->ack_timers);
+  OLA_ASSERT_EQ(2u, uid_stats->nacks);
+  OLA_ASSERT_EQ(1u, uid_stats->timeouts);
+  OLA_ASSERT_EQ(1u, uid_stats->failures);
+  OLA_ASSERT_EQ(4u, uid_stats->Responses());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), uid_stats->nack_reasons.size());
+  OLA_ASSERT_EQ(
+      2u,
+      uid_stats->nack_reasons.find(ola::rdm::NR_DATA_OUT_OF_RANGE)->second);
+
+  // Failures aren't included in the latency.
+  OLA_ASSERT_EQ(TimeInterval(0, 2000), uid_stats->min_latency);
+  OLA_ASSERT_EQ(TimeInterval(0, 4000), uid_stats->max_latency);
+  OLA_ASSERT_EQ(TimeInterval(0, 13000), uid_stats->total_latency);
+
+  OLA_ASSERT_EQ(2u, stats.ConsecutiveFailures(m_uid));
+  Ack(&stats, 1);
+  OLA_ASSERT_EQ(0u, stats.ConsecutiveFailures(m_uid));
+}
+
+
+/*
+ * Check the latency histogram.
+ */
+void RDMResponderStatsTest::testLatency() {
+  RDMResponderStats stats;
+  OLA_ASSERT_EQ(TimeInterval(), stats.LatencyPercentile(m_uid, 50));
+
+  // 8 fast responses, and 2 slow ones.
+  for (unsigned int i = 0; i < 8; i++) {
+    Ack(&stats, 3);
+  }
+  Ack(&stats, 150);
+  Ack(&stats, 1500);
+
+  const RDMResponderStats::Stats *uid_stats = stats.Get(m_uid);
+  OLA_ASSERT_EQ(static_cast<size_t>(RDMResponderStats::LATENCY_BUCKET_COUNT),
+                uid_stats->latency_buckets.size());
+  OLA_ASSERT_EQ(8u, uid_stats->latency_buckets[2]);  // <= 5ms
+  OLA_ASSERT_EQ(1u, uid_stats->latency_buckets[7]);  // <= 200ms
+  OLA_ASSERT_EQ(
+      1u,
+      uid_stats->latency_buckets[RDMResponderStats::LATENCY_BUCKET_COUNT - 1]);
+
+  OLA_ASSERT_EQ(TimeInterval(0, 5000), stats.LatencyPercentile(m_uid, 50));
+  OLA_ASSERT_EQ(TimeInterval(0, 5000), stats.LatencyPercentile(m_uid, 80));
+  OLA_ASSERT_EQ(TimeInterval(0, 200000), stats.LatencyPercentile(m_uid, 90));
+  // The last bucket has no limit, so the maximum is used.
+  OLA_ASSERT_EQ(TimeInterval(1, 500000), stats.LatencyPercentile(m_uid, 99));
+}
+
+
+/*
+ * Check the stats for responders that have gone are dropped.
+ */
+void RDMResponderStatsTest::testRetain() {
+  RDMResponderStats stats;
+  const UID other_uid(0x7a70, 2);
+  Ack(&stats, 1);
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  stats.RequestComplete(other_uid, TimeInterval(0, 50000), timeout);
+  OLA_ASSERT_EQ(2u, stats.Size());
+
+  UIDSet uids;
+  uids.AddUID(other_uid);
+  stats.Retain(uids);
+  OLA_ASSERT_EQ(1u, stats.Size());
+  OLA_ASSERT_NULL(stats.Get(m_uid));
+  OLA_ASSERT_EQ(1u, stats.ConsecutiveFailures(other_uid));
+
+  UIDSet all_uids;
+  stats.GetUIDs(&all_uids);
+  OLA_ASSERT_EQ(uids, all_uids);
+}
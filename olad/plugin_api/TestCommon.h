@@ -21,6 +21,7 @@
 #ifndef OLAD_PLUGIN_API_TESTCOMMON_H_
 #define OLAD_PLUGIN_API_TESTCOMMON_H_
 #include <cppunit/extensions/HelperMacros.h>
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -30,6 +31,7 @@
 #include "ola/DmxBuffer.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/Device.h"
 #include "olad/Plugin.h"
 #include "olad/Port.h"
@@ -96,20 +98,24 @@ class TestMockOutputPort: public ola::BasicOutputPort {
                      bool start_rdm_discovery_on_patch = false,
                      bool supports_rdm = false)
       : ola::BasicOutputPort(parent, port_id, start_rdm_discovery_on_patch,
-                             supports_rdm) {
+                             supports_rdm),
+        m_write_count(0) {
   }
   ~TestMockOutputPort() {}
 
   std::string Description() const { return ""; }
   bool WriteDMX(const ola::DmxBuffer &buffer, uint8_t priority) {
     m_buffer = buffer;
+    m_write_count++;
     (void) priority;
     return true;
   }
   const ola::DmxBuffer &ReadDMX() const { return m_buffer; }
+  unsigned int WriteCount() const { return m_write_count; }
 
  private:
   ola::DmxBuffer m_buffer;
+  unsigned int m_write_count;
 };
 
 
@@ -340,4 +346,79 @@ class MockSelectServer: public ola::io::SelectServerInterface {
  private:
   const ola::TimeStamp *m_wake_up;
 };
+
+
+/*
+ * A scheduler that only runs single timeouts when asked to.
+ */
+class MockScheduler: public ola::thread::SchedulerInterface {
+ public:
+  MockScheduler() {}
+  ~MockScheduler() {
+    std::vector<ola::SingleUseCallback0<void>*>::iterator iter;
+    for (iter = m_callbacks.begin(); iter != m_callbacks.end(); ++iter) {
+      delete *iter;
+    }
+    std::vector<ola::Callback0<bool>*>::iterator repeating_iter;
+    for (repeating_iter = m_repeating_callbacks.begin();
+         repeating_iter != m_repeating_callbacks.end(); ++repeating_iter) {
+      delete *repeating_iter;
+    }
+  }
+
+  // Repeating timeouts are never run, they're deleted with the scheduler.
+  ola::thread::timeout_id RegisterRepeatingTimeout(
+      unsigned int,
+      ola::Callback0<bool> *callback) {
+    m_repeating_callbacks.push_back(callback);
+    return ola::thread::INVALID_TIMEOUT;
+  }
+  ola::thread::timeout_id RegisterRepeatingTimeout(
+      const ola::TimeInterval&,
+      ola::Callback0<bool> *callback) {
+    m_repeating_callbacks.push_back(callback);
+    return ola::thread::INVALID_TIMEOUT;
+  }
+  ola::thread::timeout_id RegisterSingleTimeout(
+      unsigned int,
+      ola::SingleUseCallback0<void> *callback) {
+    m_callbacks.push_back(callback);
+    return callback;
+  }
+  ola::thread::timeout_id RegisterSingleTimeout(
+      const ola::TimeInterval &delay,
+      ola::SingleUseCallback0<void> *callback) {
+    m_last_delay = delay;
+    m_callbacks.push_back(callback);
+    return callback;
+  }
+  void RemoveTimeout(ola::thread::timeout_id id) {
+    std::vector<ola::SingleUseCallback0<void>*>::iterator iter = std::find(
+        m_callbacks.begin(), m_callbacks.end(), id);
+    if (iter != m_callbacks.end()) {
+      delete *iter;
+      m_callbacks.erase(iter);
+    }
+  }
+
+  unsigned int PendingTimeouts() const { return m_callbacks.size(); }
+
+  // The delay of the last timeout registered with a TimeInterval.
+  const ola::TimeInterval &LastDelay() const { return m_last_delay; }
+
+  // Run all the pending timeouts
+  void RunTimeouts() {
+    std::vector<ola::SingleUseCallback0<void>*> callbacks;
+    callbacks.swap(m_callbacks);
+    std::vector<ola::SingleUseCallback0<void>*>::iterator iter;
+    for (iter = callbacks.begin(); iter != callbacks.end(); ++iter) {
+      (*iter)->Run();
+    }
+  }
+
+ private:
+  std::vector<ola::SingleUseCallback0<void>*> m_callbacks;
+  std::vector<ola::Callback0<bool>*> m_repeating_callbacks;
+  ola::TimeInterval m_last_delay;
+};
 #endif  // OLAD_PLUGIN_API_TESTCOMMON_H_
@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TimeCodeGenerator.cpp
+ * Generates timecode from the monotonic clock.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/TimeCodeGenerator.h"
+
+#include <stdint.h>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/timecode/TimeCode.h"
+#include "ola/timecode/TimeCodeEnums.h"
+
+namespace ola {
+
+using ola::thread::INVALID_TIMEOUT;
+using ola::timecode::TimeCode;
+
+namespace {
+const int64_t USEC_PER_SECOND = 1000000;
+}  // namespace
+
+const unsigned int TimeCodeGenerator::LOCK_TOLERANCE_FRAMES;
+const unsigned int TimeCodeGenerator::FREEWHEEL_MS;
+
+TimeCodeGenerator::TimeCodeGenerator(
+    ola::thread::SchedulerInterface *scheduler,
+    Clock *clock,
+    TimeCodeCallback *callback)
+    : m_scheduler(scheduler),
+      m_clock(clock),
+      m_callback(callback),
+      m_mode(STOPPED),
+      m_type(ola::timecode::TIMECODE_SMPTE),
+      m_locked(false),
+      m_origin_frame(0),
+      m_next_frame(0),
+      m_skipped_frames(0),
+      m_timeout(INVALID_TIMEOUT) {
+}
+
+TimeCodeGenerator::~TimeCodeGenerator() {
+  CancelTimeout();
+}
+
+void TimeCodeGenerator::Start(const TimeCode &start) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  m_mode = RUNNING;
+  m_locked = false;
+  OLA_INFO << "Starting timecode at " << start;
+  Locate(start, now);
+}
+
+void TimeCodeGenerator::Chase() {
+  CancelTimeout();
+  m_mode = CHASE;
+  m_locked = false;
+  OLA_INFO << "Chasing timecode";
+}
+
+void TimeCodeGenerator::Stop() {
+  CancelTimeout();
+  m_mode = STOPPED;
+  m_locked = false;
+}
+
+bool TimeCodeGenerator::IsRunning() const {
+  return m_mode == RUNNING || (m_mode == CHASE && m_locked);
+}
+
+void TimeCodeGenerator::TimeCodeReceived(const TimeCode &timecode) {
+  if (m_mode != CHASE) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  m_last_received = now;
+
+  if (m_locked && timecode.Type() == m_type) {
+    // The difference between the source and our position, allowing for the
+    // wrap at 24 hours.
+    const int64_t frames_per_day = TimeCode::FramesPerDay(m_type);
+    int64_t offset = (static_cast<int64_t>(timecode.FrameCount()) -
+                      m_origin_frame - FrameAt(now)) % frames_per_day;
+    if (offset > frames_per_day / 2) {
+      offset -= frames_per_day;
+    } else if (offset < -frames_per_day / 2) {
+      offset += frames_per_day;
+    }
+    if (offset >= -static_cast<int64_t>(LOCK_TOLERANCE_FRAMES) &&
+        offset <= static_cast<int64_t>(LOCK_TOLERANCE_FRAMES)) {
+      return;
+    }
+    OLA_INFO << "Timecode source jumped by " << offset << " frames";
+  } else {
+    OLA_INFO << "Locked to timecode source at " << timecode;
+  }
+  m_locked = true;
+  Locate(timecode, now);
+}
+
+/*
+ * Move to a new position, and send it now.
+ */
+void TimeCodeGenerator::Locate(const TimeCode &timecode, const TimeStamp &now) {
+  CancelTimeout();
+  m_type = timecode.Type();
+  m_origin = now;
+  m_origin_frame = timecode.FrameCount();
+  m_next_frame = 0;
+  SendFrame();
+}
+
+void TimeCodeGenerator::SendFrame() {
+  m_timeout = INVALID_TIMEOUT;
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+
+  if (m_mode == CHASE &&
+      now - m_last_received > TimeInterval(FREEWHEEL_MS * 1000)) {
+    OLA_INFO << "Lost the timecode source";
+    m_locked = false;
+    return;
+  }
+
+  int64_t frame = FrameAt(now);
+  if (frame > m_next_frame) {
+    m_skipped_frames += frame - m_next_frame;
+    OLA_DEBUG << "Skipped " << frame - m_next_frame << " frames of timecode";
+  } else {
+    // The timeout may run a little early.
+    frame = m_next_frame;
+  }
+
+  m_callback->Run(TimeCode::FromFrameCount(
+      m_type, static_cast<uint32_t>(
+          (m_origin_frame + frame) % TimeCode::FramesPerDay(m_type))));
+
+  m_next_frame = frame + 1;
+  TimeInterval delay = FrameTime(m_next_frame) - now;
+  if (delay < TimeInterval(0, 0)) {
+    delay = TimeInterval(0, 0);
+  }
+  m_timeout = m_scheduler->RegisterSingleTimeout(
+      delay, NewSingleCallback(this, &TimeCodeGenerator::SendFrame));
+}
+
+void TimeCodeGenerator::CancelTimeout() {
+  if (m_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout);
+    m_timeout = INVALID_TIMEOUT;
+  }
+}
+
+/*
+ * The frame, relative to the origin, that's current at a time.
+ */
+int64_t TimeCodeGenerator::FrameAt(const TimeStamp &time) const {
+  const int64_t elapsed = (time - m_origin).AsInt();
+  if (elapsed < 0) {
+    return 0;
+  }
+  return elapsed * FrameRateNumerator() /
+         (USEC_PER_SECOND * FrameRateDenominator());
+}
+
+/*
+ * The time a frame, relative to the origin, is due.
+ */
+TimeStamp TimeCodeGenerator::FrameTime(int64_t frame) const {
+  // Round up, so the frame is never sent before it's due.
+  const int64_t numerator = FrameRateNumerator();
+  const int64_t offset =
+      (frame * USEC_PER_SECOND * FrameRateDenominator() + numerator - 1) /
+      numerator;
+  return m_origin + TimeInterval(offset);
+}
+
+uint32_t TimeCodeGenerator::FrameRateNumerator() const {
+  return m_type == ola::timecode::TIMECODE_DF ?
+      30000 : TimeCode::NominalFrameRate(m_type);
+}
+
+uint32_t TimeCodeGenerator::FrameRateDenominator() const {
+  return m_type == ola::timecode::TIMECODE_DF ? 1001 : 1;
+}
+}  // namespace ola
@@ -0,0 +1,145 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TimeCodeGenerator.h
+ * Generates timecode from the monotonic clock.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_TIMECODEGENERATOR_H_
+#define OLAD_PLUGIN_API_TIMECODEGENERATOR_H_
+
+#include <stdint.h>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "ola/timecode/TimeCode.h"
+#include "ola/timecode/TimeCodeEnums.h"
+
+namespace ola {
+
+/**
+ * @brief Generates timecode in olad, so clients don't need to send a frame at
+ * a time.
+ *
+ * The time each frame is due is calculated from when the generator was
+ * started, using the exact frame rate (30000/1001 for drop frame), so a late
+ * timeout doesn't delay the frames after it. If a timeout is more than a
+ * frame late, the frames that were missed are skipped rather than sent in a
+ * burst.
+ *
+ * The generator can either run freely from a start position, or chase an
+ * incoming source. When chasing, the generator locks to the position of the
+ * incoming timecode and then fills in the frames between the updates it
+ * receives. Updates that are within LOCK_TOLERANCE_FRAMES of the generated
+ * position don't change the phase, so the jitter of the source is removed.
+ * If nothing is received for FREEWHEEL_MS the generator stops until the
+ * source returns.
+ */
+class TimeCodeGenerator {
+ public:
+  typedef Callback1<void, const ola::timecode::TimeCode&> TimeCodeCallback;
+
+  /**
+   * @brief Create a new TimeCodeGenerator.
+   * @param scheduler the scheduler used to time the frames.
+   * @param clock the clock to use.
+   * @param callback run with each frame of timecode, ownership is
+   *   transferred.
+   */
+  TimeCodeGenerator(ola::thread::SchedulerInterface *scheduler,
+                    Clock *clock,
+                    TimeCodeCallback *callback);
+  ~TimeCodeGenerator();
+
+  /**
+   * @brief Start generating timecode.
+   * @param start the first frame to send, this also sets the frame rate.
+   */
+  void Start(const ola::timecode::TimeCode &start);
+
+  /**
+   * @brief Chase the timecode passed to TimeCodeReceived().
+   */
+  void Chase();
+
+  /**
+   * @brief Stop generating timecode.
+   */
+  void Stop();
+
+  /**
+   * @brief Returns true if the generator is chasing an incoming source.
+   */
+  bool IsChasing() const { return m_mode == CHASE; }
+
+  /**
+   * @brief Returns true if frames are being generated.
+   */
+  bool IsRunning() const;
+
+  /**
+   * @brief Called when timecode is received from the source being chased.
+   *
+   * This is ignored unless the generator is chasing.
+   */
+  void TimeCodeReceived(const ola::timecode::TimeCode &timecode);
+
+  /**
+   * @brief The number of frames skipped because a timeout was late.
+   */
+  uint64_t SkippedFrames() const { return m_skipped_frames; }
+
+  static const unsigned int LOCK_TOLERANCE_FRAMES = 2;
+  static const unsigned int FREEWHEEL_MS = 2000;
+
+ private:
+  typedef enum {
+    STOPPED,
+    RUNNING,
+    CHASE
+  } generator_mode;
+
+  ola::thread::SchedulerInterface *m_scheduler;
+  Clock *m_clock;
+  std::auto_ptr<TimeCodeCallback> m_callback;
+  generator_mode m_mode;
+  ola::timecode::TimeCodeType m_type;
+  // When chasing, true if we've locked to the source.
+  bool m_locked;
+  // The time of frame 0, and the frame count it's at.
+  TimeStamp m_origin;
+  uint32_t m_origin_frame;
+  // The next frame to send, relative to m_origin.
+  int64_t m_next_frame;
+  TimeStamp m_last_received;
+  uint64_t m_skipped_frames;
+  ola::thread::timeout_id m_timeout;
+
+  void Locate(const ola::timecode::TimeCode &timecode, const TimeStamp &now);
+  void SendFrame();
+  void CancelTimeout();
+  int64_t FrameAt(const TimeStamp &time) const;
+  TimeStamp FrameTime(int64_t frame) const;
+  uint32_t FrameRateNumerator() const;
+  uint32_t FrameRateDenominator() const;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeCodeGenerator);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_TIMECODEGENERATOR_H_
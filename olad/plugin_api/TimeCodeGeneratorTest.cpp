@@ -0,0 +1,245 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TimeCodeGeneratorTest.cpp
+ * Test fixture for the TimeCodeGenerator class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/timecode/TimeCode.h"
+#include "ola/timecode/TimeCodeEnums.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/TimeCodeGenerator.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::NewCallback;
+using ola::TimeCodeGenerator;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::timecode::TIMECODE_DF;
+using ola::timecode::TIMECODE_EBU;
+using ola::timecode::TIMECODE_SMPTE;
+using ola::timecode::TimeCode;
+using std::vector;
+
+/*
+ * MockClock follows the real clock, this one only moves when it's advanced,
+ * so the frame timing can be checked exactly.
+ */
+class StoppedClock: public ola::Clock {
+ public:
+  StoppedClock() {}
+
+  void AdvanceTime(const TimeInterval &interval) { m_now += interval; }
+
+  void CurrentMonotonicTime(TimeStamp *timestamp) const {
+    *timestamp = m_now;
+  }
+
+ private:
+  TimeStamp m_now;
+};
+
+
+class TimeCodeGeneratorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TimeCodeGeneratorTest);
+  CPPUNIT_TEST(testFreeRun);
+  CPPUNIT_TEST(testDropFrame);
+  CPPUNIT_TEST(testLateTimeout);
+  CPPUNIT_TEST(testChase);
+  CPPUNIT_TEST(testStop);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    m_generator.reset(new TimeCodeGenerator(
+        &m_scheduler, &m_clock,
+        NewCallback(this, &TimeCodeGeneratorTest::NewTimeCode)));
+  }
+
+  void tearDown() {
+    m_generator.reset();
+    m_timecodes.clear();
+  }
+
+  void testFreeRun();
+  void testDropFrame();
+  void testLateTimeout();
+  void testChase();
+  void testStop();
+
+ private:
+  StoppedClock m_clock;
+  MockScheduler m_scheduler;
+  std::auto_ptr<TimeCodeGenerator> m_generator;
+  vector<TimeCode> m_timecodes;
+
+  void NewTimeCode(const TimeCode &timecode) {
+    m_timecodes.push_back(timecode);
+  }
+
+  // Advance to the next frame and run the timeout.
+  void RunNextFrame() {
+    m_clock.AdvanceTime(m_scheduler.LastDelay());
+    m_scheduler.RunTimeouts();
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimeCodeGeneratorTest);
+
+
+/*
+ * Check the generator runs from the start position.
+ */
+void TimeCodeGeneratorTest::testFreeRun() {
+  OLA_ASSERT_FALSE(m_generator->IsRunning());
+  m_generator->Start(TimeCode(TIMECODE_SMPTE, 1, 0, 0, 0));
+  OLA_ASSERT_TRUE(m_generator->IsRunning());
+
+  // The first frame is sent straight away.
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_SMPTE, 1, 0, 0, 0), m_timecodes[0]);
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+  OLA_ASSERT_EQ(TimeInterval(33334), m_scheduler.LastDelay());
+
+  RunNextFrame();
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_SMPTE, 1, 0, 0, 1), m_timecodes[1]);
+  // The delay is from the start, so the rounding doesn't accumulate.
+  OLA_ASSERT_EQ(TimeInterval(33333), m_scheduler.LastDelay());
+
+  for (unsigned int i = 0; i < 29; i++) {
+    RunNextFrame();
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(31), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_SMPTE, 1, 0, 1, 0), m_timecodes[30]);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), m_generator->SkippedFrames());
+}
+
+/*
+ * Check drop frame runs at 29.97fps and skips the right frame numbers.
+ */
+void TimeCodeGeneratorTest::testDropFrame() {
+  TimeStamp start;
+  m_clock.CurrentMonotonicTime(&start);
+
+  m_generator->Start(TimeCode(TIMECODE_DF, 0, 0, 0, 0));
+  for (unsigned int i = 0; i < 1800; i++) {
+    RunNextFrame();
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(1801), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 0, 59, 29), m_timecodes[1799]);
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_DF, 0, 1, 0, 2), m_timecodes[1800]);
+
+  // 1800 frames at 30000/1001 fps is 60.06 seconds.
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  OLA_ASSERT_EQ(TimeInterval(60060000), now - start);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), m_generator->SkippedFrames());
+}
+
+/*
+ * Check that frames are skipped if a timeout is late.
+ */
+void TimeCodeGeneratorTest::testLateTimeout() {
+  m_generator->Start(TimeCode(TIMECODE_EBU, 0, 0, 0, 0));
+  OLA_ASSERT_EQ(TimeInterval(40000), m_scheduler.LastDelay());
+
+  m_clock.AdvanceTime(TimeInterval(0, 130000));
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_EBU, 0, 0, 0, 3), m_timecodes[1]);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), m_generator->SkippedFrames());
+  // The next frame is still on time.
+  OLA_ASSERT_EQ(TimeInterval(30000), m_scheduler.LastDelay());
+}
+
+/*
+ * Check chasing an incoming source.
+ */
+void TimeCodeGeneratorTest::testChase() {
+  // This is ignored unless we're chasing.
+  m_generator->TimeCodeReceived(TimeCode(TIMECODE_EBU, 0, 0, 1, 0));
+  OLA_ASSERT_TRUE(m_timecodes.empty());
+
+  m_generator->Chase();
+  OLA_ASSERT_TRUE(m_generator->IsChasing());
+  OLA_ASSERT_FALSE(m_generator->IsRunning());
+  OLA_ASSERT_EQ(0u, m_scheduler.PendingTimeouts());
+
+  m_generator->TimeCodeReceived(TimeCode(TIMECODE_EBU, 0, 0, 10, 0));
+  OLA_ASSERT_TRUE(m_generator->IsRunning());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_EBU, 0, 0, 10, 0), m_timecodes[0]);
+
+  // The frames in between updates are filled in.
+  RunNextFrame();
+  RunNextFrame();
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_EBU, 0, 0, 10, 2), m_timecodes[2]);
+
+  // Updates close to our position don't change the phase.
+  m_clock.AdvanceTime(TimeInterval(0, 5000));
+  m_generator->TimeCodeReceived(TimeCode(TIMECODE_EBU, 0, 0, 10, 3));
+  m_generator->TimeCodeReceived(TimeCode(TIMECODE_EBU, 0, 0, 10, 1));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_timecodes.size());
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+
+  // But a jump is followed straight away.
+  m_generator->TimeCodeReceived(TimeCode(TIMECODE_EBU, 0, 1, 0, 0));
+  OLA_ASSERT_EQ(static_cast<size_t>(4), m_timecodes.size());
+  OLA_ASSERT_EQ(TimeCode(TIMECODE_EBU, 0, 1, 0, 0), m_timecodes[3]);
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+  OLA_ASSERT_EQ(TimeInterval(40000), m_scheduler.LastDelay());
+
+  // If the source stops, the generator runs on for a while then stops.
+  for (unsigned int i = 0; i < 50; i++) {
+    RunNextFrame();
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(54), m_timecodes.size());
+  OLA_ASSERT_TRUE(m_generator->IsRunning());
+  m_clock.AdvanceTime(TimeInterval(0, 1000));
+  m_scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(static_cast<size_t>(54), m_timecodes.size());
+  OLA_ASSERT_FALSE(m_generator->IsRunning());
+  OLA_ASSERT_EQ(0u, m_scheduler.PendingTimeouts());
+
+  // Until it returns.
+  m_generator->TimeCodeReceived(TimeCode(TIMECODE_EBU, 0, 2, 0, 0));
+  OLA_ASSERT_TRUE(m_generator->IsRunning());
+  OLA_ASSERT_EQ(static_cast<size_t>(55), m_timecodes.size());
+}
+
+/*
+ * Check Stop() cancels the timeout.
+ */
+void TimeCodeGeneratorTest::testStop() {
+  m_generator->Start(TimeCode(TIMECODE_SMPTE, 0, 0, 0, 0));
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+  m_generator->Stop();
+  OLA_ASSERT_FALSE(m_generator->IsRunning());
+  OLA_ASSERT_EQ(0u, m_scheduler.PendingTimeouts());
+
+  // Starting again replaces the timeout.
+  m_generator->Start(TimeCode(TIMECODE_SMPTE, 0, 0, 0, 0));
+  m_generator->Start(TimeCode(TIMECODE_SMPTE, 0, 0, 1, 0));
+  OLA_ASSERT_EQ(1u, m_scheduler.PendingTimeouts());
+}
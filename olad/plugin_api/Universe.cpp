@@ -30,16 +30,18 @@
  *   A list of sink clients, which we update whenever the DmxBuffer changes.
  */
 
+#include <string.h>
 #include <algorithm>
 #include <iterator>
 #include <map>
 #include <memory>
-#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "common/dmx/SlotKernels.h"
 #include "ola/base/Array.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/MultiCallback.h"
 #include "ola/rdm/RDMCommand.h"
@@ -49,6 +51,12 @@
 #include "olad/Port.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/DiscoveryScheduler.h"
+#include "olad/plugin_api/FrameClock.h"
+#include "olad/plugin_api/FrameHistory.h"
+#include "olad/plugin_api/InputTrace.h"
+#include "olad/plugin_api/PluginThread.h"
+#include "olad/plugin_api/RDMResponderStats.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 namespace ola {
@@ -62,22 +70,61 @@ using ola::strings::ToHex;
 using std::auto_ptr;
 using std::map;
 using std::ostringstream;
-using std::set;
 using std::string;
 using std::vector;
 
 const char Universe::K_UNIVERSE_UID_COUNT_VAR[] = "universe-uids";
 const char Universe::K_FPS_VAR[] = "universe-dmx-frames";
+const char Universe::K_COALESCED_FRAMES_VAR[] = "universe-coalesced-frames";
 const char Universe::K_MERGE_HTP_STR[] = "htp";
 const char Universe::K_MERGE_LTP_STR[] = "ltp";
 const char Universe::K_UNIVERSE_INPUT_PORT_VAR[] = "universe-input-ports";
 const char Universe::K_UNIVERSE_MODE_VAR[] = "universe-mode";
 const char Universe::K_UNIVERSE_NAME_VAR[] = "universe-name";
 const char Universe::K_UNIVERSE_OUTPUT_PORT_VAR[] = "universe-output-ports";
+const char Universe::K_UNIVERSE_OUTPUT_RATE_VAR[] = "universe-max-output-rate";
+const char Universe::K_UNIVERSE_RDM_DISCOVERY_TIME_VAR[] =
+    "universe-rdm-discovery-ms";
 const char Universe::K_UNIVERSE_RDM_REQUESTS[] = "universe-rdm-requests";
 const char Universe::K_UNIVERSE_SINK_CLIENTS_VAR[] = "universe-sink-clients";
 const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
     "universe-source-clients";
+const unsigned int Universe::K_DWELL_TIME_BUCKETS;
+const char *Universe::K_DWELL_TIME_VARS[] = {
+  "universe-dwell-time-100us",
+  "universe-dwell-time-250us",
+  "universe-dwell-time-500us",
+  "universe-dwell-time-1ms",
+  "universe-dwell-time-2.5ms",
+  "universe-dwell-time-5ms",
+  "universe-dwell-time-10ms",
+  "universe-dwell-time-25ms",
+  "universe-dwell-time-over-25ms",
+};
+const unsigned int Universe::K_DWELL_TIME_LIMITS_US[] = {
+  100, 250, 500, 1000, 2500, 5000, 10000, 25000
+};
+// Even if the merged data doesn't change, we still push it to the ports &
+// clients this often so downstream devices don't time out.
+const TimeInterval Universe::K_UNCHANGED_REFRESH_INTERVAL(1, 0);
+
+/*
+ * A sink client with non default SinkOptions.
+ */
+struct Universe::FilteredSink {
+  explicit FilteredSink(const SinkOptions &options)
+      : options(options),
+        sent(false),
+        send_timeout(ola::thread::INVALID_TIMEOUT) {
+  }
+
+  SinkOptions options;
+  DmxBuffer last_frame;  // the slots in the last update sent
+  bool sent;  // true once an update has been sent
+  TimeStamp last_send_time;  // monotonic
+  // Set if the update was held back by the rate limit.
+  ola::thread::timeout_id send_timeout;
+};
 
 /*
  * Create a new universe
@@ -88,16 +135,31 @@ const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
 Universe::Universe(unsigned int universe_id, UniverseStore *store,
                    ExportMap *export_map,
                    Clock *clock)
-    : m_universe_name(""),
-      m_universe_id(universe_id),
+    : m_universe_id(universe_id),
       m_active_priority(ola::dmx::SOURCE_PRIORITY_MIN),
       m_merge_mode(Universe::MERGE_LTP),
+      m_clock(clock),
+      m_wake_up_time(NULL),
+      m_universe_name(""),
       m_universe_store(store),
       m_export_map(export_map),
-      m_clock(clock),
       m_rdm_discovery_interval(),
       m_last_discovery_time(),
-      m_transaction_number_sequence() {
+      m_rdm_request_count(0),
+      m_rdm_stats(new RDMResponderStats()),
+      m_transaction_number_sequence(),
+      m_scheduler(NULL),
+      m_discovery_scheduler(NULL),
+      m_max_output_rate(0),
+      m_output_timeout(ola::thread::INVALID_TIMEOUT),
+      m_frame_clock(NULL),
+      m_frame_clock_pending(false),
+      m_frame_history(NULL),
+      m_input_trace(NULL),
+      m_stats(),
+      m_restored_dmx(false),
+      m_prev_with_clients(NULL),
+      m_next_with_clients(NULL) {
   ostringstream universe_id_str, universe_name_str;
   universe_id_str << universe_id;
   m_universe_id_str = universe_id_str.str();
@@ -108,9 +170,12 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
   UpdateMode();
 
   const char *vars[] = {
+    K_COALESCED_FRAMES_VAR,
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_OUTPUT_RATE_VAR,
+    K_UNIVERSE_RDM_DISCOVERY_TIME_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -121,6 +186,10 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
     for (unsigned int i = 0; i < arraysize(vars); ++i) {
       (*m_export_map->GetUIntMapVar(vars[i]))[m_universe_id_str] = 0;
     }
+    for (unsigned int i = 0; i < K_DWELL_TIME_BUCKETS; ++i) {
+      (*m_export_map->GetUIntMapVar(K_DWELL_TIME_VARS[i]))[
+          m_universe_id_str] = 0;
+    }
   }
 
   // We set the last discovery time to now, since most ports will trigger
@@ -133,15 +202,28 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
  * Delete this universe
  */
 Universe::~Universe() {
+  if (m_output_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_output_timeout);
+  }
+  while (!m_filtered_sinks.empty()) {
+    RemoveFilteredSink(m_filtered_sinks.begin()->first);
+  }
+  if (m_frame_clock_pending) {
+    m_frame_clock->RemovePendingUniverse(this);
+  }
+
   const char *string_vars[] = {
     K_UNIVERSE_NAME_VAR,
     K_UNIVERSE_MODE_VAR,
   };
 
   const char *uint_vars[] = {
+    K_COALESCED_FRAMES_VAR,
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_OUTPUT_RATE_VAR,
+    K_UNIVERSE_RDM_DISCOVERY_TIME_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -155,6 +237,10 @@ Universe::~Universe() {
     for (unsigned int i = 0; i < arraysize(uint_vars); ++i) {
       m_export_map->GetUIntMapVar(uint_vars[i])->Remove(m_universe_id_str);
     }
+    for (unsigned int i = 0; i < K_DWELL_TIME_BUCKETS; ++i) {
+      m_export_map->GetUIntMapVar(K_DWELL_TIME_VARS[i])->Remove(
+          m_universe_id_str);
+    }
   }
 }
 
@@ -166,11 +252,12 @@ Universe::~Universe() {
 void Universe::SetName(const string &name) {
   m_universe_name = name;
   UpdateName();
+  m_universe_store->UniverseChanged();
 
   // notify ports
   vector<OutputPort*>::const_iterator iter;
   for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
-    (*iter)->UniverseNameChanged(name);
+    DispatchUniverseNameChanged(*iter, name);
   }
 }
 
@@ -181,7 +268,159 @@ void Universe::SetName(const string &name) {
  */
 void Universe::SetMergeMode(enum merge_mode merge_mode) {
   m_merge_mode = merge_mode;
+  m_merge_sources.clear();
   UpdateMode();
+  m_universe_store->UniverseChanged();
+}
+
+
+/*
+ * Set the slots which the merge profile LTP merges.
+ * @param ltp_slots the LTP slots, an empty list removes the profile.
+ */
+void Universe::SetLTPSlots(const vector<unsigned int> &ltp_slots) {
+  uint8_t mask[DMX_UNIVERSE_SIZE];
+  memset(mask, 0, sizeof(mask));
+  unsigned int size = 0;
+
+  vector<unsigned int>::const_iterator iter = ltp_slots.begin();
+  for (; iter != ltp_slots.end(); ++iter) {
+    if (*iter >= DMX_UNIVERSE_SIZE) {
+      OLA_WARN << "Ignoring LTP slot " << *iter << " for universe "
+               << m_universe_id;
+      continue;
+    }
+    mask[*iter] = 0xff;
+    size = std::max(size, *iter + 1);
+  }
+
+  if (size) {
+    m_ltp_mask.Set(mask, size);
+  } else {
+    m_ltp_mask.Reset();
+  }
+  m_merge_sources.clear();
+}
+
+
+/*
+ * Get the slots which the merge profile LTP merges.
+ */
+void Universe::LTPSlots(vector<unsigned int> *ltp_slots) const {
+  ltp_slots->clear();
+  for (unsigned int i = 0; i < m_ltp_mask.Size(); i++) {
+    if (m_ltp_mask.Get(i)) {
+      ltp_slots->push_back(i);
+    }
+  }
+}
+
+
+/*
+ * Merge all the sources again and send the result to the ports & clients.
+ */
+void Universe::Remerge() {
+  const uint8_t last_priority = m_active_priority;
+  m_active_sources.clear();
+  m_active_priority = ola::dmx::SOURCE_PRIORITY_MIN;
+  TimeStamp now;
+  if (m_wake_up_time && m_wake_up_time->IsSet()) {
+    now = *m_wake_up_time;
+  } else {
+    m_clock->CurrentMonotonicTime(&now);
+  }
+  bool unused = false;
+  bool have_slot_priorities = false;
+
+  vector<InputPort*>::const_iterator iter;
+  for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
+    AddActiveSource(*iter, (*iter)->SourceData(), now, false, &unused,
+                    &have_slot_priorities);
+  }
+
+  SourceClientList::iterator client_iter;
+  for (client_iter = m_source_clients.begin();
+       client_iter != m_source_clients.end();
+       ++client_iter) {
+    const DmxSource *source = ClientSource(&*client_iter);
+    if (source) {
+      AddActiveSource(client_iter->client, *source, now, false, &unused,
+                      &have_slot_priorities);
+    }
+  }
+
+  if (!have_slot_priorities && m_slot_priorities.Size()) {
+    m_slot_priorities = DmxBuffer();
+  }
+
+  if (have_slot_priorities) {
+    AddAllActiveSources(now);
+    SlotPriorityMergeSources(m_active_sources);
+    m_merge_sources.clear();
+  } else if (m_active_sources.size() == 1) {
+    m_buffer = m_active_sources[0].source.Data();
+    m_merge_sources.swap(m_active_sources);
+  } else if (m_active_sources.empty()) {
+    // Keep the last frame, the new ports still need to be sent it.
+    m_active_priority = last_priority;
+    m_merge_sources.clear();
+  } else if (HasMergeProfile()) {
+    ProfileMergeSources(m_active_sources);
+    m_merge_sources.clear();
+  } else if (m_merge_mode == Universe::MERGE_LTP) {
+    MergeSourceList::const_iterator newest = m_active_sources.begin();
+    MergeSourceList::const_iterator source_iter = m_active_sources.begin();
+    for (; source_iter != m_active_sources.end(); source_iter++) {
+      if (newest->source.Timestamp() < source_iter->source.Timestamp()) {
+        newest = source_iter;
+      }
+    }
+    m_buffer = newest->source.Data();
+    m_merge_sources.clear();
+  } else {
+    HTPMergeSources(m_active_sources);
+    m_merge_sources.swap(m_active_sources);
+  }
+  m_active_sources.clear();
+
+  if (m_active_priority != last_priority) {
+    m_universe_store->UniverseChanged();
+  }
+  if (m_buffer.Size()) {
+    m_last_update_time = now;
+    UpdateDependants();
+  }
+}
+
+
+/*
+ * Set the maximum output rate
+ * @param frames_per_second the max rate, or 0 for no limit
+ */
+void Universe::SetMaxOutputRate(unsigned int frames_per_second) {
+  m_max_output_rate = frames_per_second;
+  if (m_export_map) {
+    (*m_export_map->GetUIntMapVar(K_UNIVERSE_OUTPUT_RATE_VAR))[
+        m_universe_id_str] = frames_per_second;
+  }
+  m_universe_store->UniverseChanged();
+}
+
+
+/*
+ * Set the clock to send frames on.
+ * @param frame_clock the clock, or NULL to send frames as they change
+ */
+void Universe::SetFrameClock(FrameClock *frame_clock) {
+  if (frame_clock == m_frame_clock) {
+    return;
+  }
+  if (m_frame_clock_pending) {
+    m_frame_clock->RemovePendingUniverse(this);
+    m_frame_clock_pending = false;
+    WriteToDependants();
+  }
+  m_frame_clock = frame_clock;
 }
 
 
@@ -199,7 +438,30 @@ bool Universe::AddPort(InputPort *port) {
  * @param port the port to add
  */
 bool Universe::AddPort(OutputPort *port) {
-  return GenericAddPort(port, &m_output_ports);
+  if (!GenericAddPort(port, &m_output_ports)) {
+    return false;
+  }
+
+  if (m_restored_dmx) {
+    DispatchWriteDMX(port, m_buffer, m_active_priority);
+  }
+
+  PortUIDMap::iterator iter = m_restored_uids.find(port->UniqueId());
+  if (iter != m_restored_uids.end()) {
+    const ola::rdm::UIDSet uids = iter->second;
+    m_restored_uids.erase(iter);
+    NewUIDList(port, uids);
+
+    // The devices may have changed while we were stopped.
+    RDMDiscoveryCallback *on_complete = NewSingleCallback(
+        this, &Universe::RestoredPortDiscoveryComplete, port);
+    if (m_discovery_scheduler) {
+      m_discovery_scheduler->RunDiscovery(port, on_complete, false);
+    } else {
+      DispatchRDMDiscovery(port, on_complete, false);
+    }
+  }
+  return true;
 }
 
 
@@ -209,6 +471,8 @@ bool Universe::AddPort(OutputPort *port) {
  * @return true if the port was removed, false if it didn't exist
  */
 bool Universe::RemovePort(InputPort *port) {
+  // The next merge can't reuse the sources from the last one.
+  m_merge_sources.clear();
   return GenericRemovePort(port, &m_input_ports);
 }
 
@@ -220,6 +484,9 @@ bool Universe::RemovePort(InputPort *port) {
  */
 bool Universe::RemovePort(OutputPort *port) {
   bool ret = GenericRemovePort(port, &m_output_ports, &m_output_uids);
+  if (m_discovery_scheduler) {
+    m_discovery_scheduler->CancelPort(port);
+  }
 
   if (m_export_map) {
     (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
@@ -279,14 +546,20 @@ void Universe::OutputPorts(vector<OutputPort*> *ports) const {
 bool Universe::AddSourceClient(Client *client) {
   // Check to see if it exists already. It doesn't make sense to have multiple
   //  clients
-  if (STLReplace(&m_source_clients, client, false)) {
+  SourceClientList::iterator iter = FindSourceClient(client);
+  if (iter != m_source_clients.end()) {
+    iter->stale = false;
     return true;
   }
 
+  source_client entry = {client, client->FindSourceData(m_universe_id), false};
+  m_source_clients.push_back(entry);
+
   OLA_INFO << "Added source client, " << client << " to universe "
            << m_universe_id;
 
   SafeIncrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
+  m_universe_store->UpdateClientList(this);
   return true;
 }
 
@@ -299,14 +572,18 @@ bool Universe::AddSourceClient(Client *client) {
  * @return true is this client was removed, false if it didn't exist
  */
 bool Universe::RemoveSourceClient(Client *client) {
-  if (!STLRemove(&m_source_clients, client)) {
+  SourceClientList::iterator iter = FindSourceClient(client);
+  if (iter == m_source_clients.end()) {
     return false;
   }
+  m_source_clients.erase(iter);
+  m_merge_sources.clear();
 
   SafeDecrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
 
   OLA_INFO << "Source client " << client << " has been removed from uni "
            << m_universe_id;
+  m_universe_store->UpdateClientList(this);
 
   if (!IsActive()) {
     m_universe_store->AddUniverseGarbageCollection(this);
@@ -321,24 +598,38 @@ bool Universe::RemoveSourceClient(Client *client) {
  * @returns true if this universe contains the client, false otherwise
  */
 bool Universe::ContainsSourceClient(Client *client) const {
-  return STLContains(m_source_clients, client);
+  SourceClientList::const_iterator iter = m_source_clients.begin();
+  for (; iter != m_source_clients.end(); ++iter) {
+    if (iter->client == client) {
+      return true;
+    }
+  }
+  return false;
 }
 
 
 /*
  * @brief Add a client as a sink for this universe
  * @param client the client to add
+ * @param options limits the updates sent to the client
  * @return true if client was added, and false if it was already a sink client
  */
-bool Universe::AddSinkClient(Client *client) {
-  if (!STLInsertIfNotPresent(&m_sink_clients, client)) {
+bool Universe::AddSinkClient(Client *client, const SinkOptions &options) {
+  RemoveFilteredSink(client);
+  if (!options.IsDefault()) {
+    m_filtered_sinks[client] = new FilteredSink(options);
+  }
+
+  if (ContainsSinkClient(client)) {
     return false;
   }
+  m_sink_clients.push_back(client);
 
   OLA_INFO << "Added sink client, " << client << " to universe "
            << m_universe_id;
 
   SafeIncrement(K_UNIVERSE_SINK_CLIENTS_VAR);
+  m_universe_store->UpdateClientList(this);
   return true;
 }
 
@@ -351,14 +642,19 @@ bool Universe::AddSinkClient(Client *client) {
  * @return true is this client was removed, false if it didn't exist
  */
 bool Universe::RemoveSinkClient(Client *client) {
-  if (!STLRemove(&m_sink_clients, client)) {
+  vector<Client*>::iterator iter = std::find(m_sink_clients.begin(),
+                                              m_sink_clients.end(), client);
+  if (iter == m_sink_clients.end()) {
     return false;
   }
+  m_sink_clients.erase(iter);
+  RemoveFilteredSink(client);
 
   SafeDecrement(K_UNIVERSE_SINK_CLIENTS_VAR);
 
   OLA_INFO << "Sink client " << client << " has been removed from uni "
            << m_universe_id;
+  m_universe_store->UpdateClientList(this);
 
   if (!IsActive()) {
     m_universe_store->AddUniverseGarbageCollection(this);
@@ -372,7 +668,8 @@ bool Universe::RemoveSinkClient(Client *client) {
  * @returns true if this universe contains the client, false otherwise
  */
 bool Universe::ContainsSinkClient(Client *client) const {
-  return STLContains(m_sink_clients, client);
+  return std::find(m_sink_clients.begin(), m_sink_clients.end(), client) !=
+      m_sink_clients.end();
 }
 
 
@@ -388,7 +685,13 @@ bool Universe::SetDMX(const DmxBuffer &buffer) {
              << UniverseId();
     return true;
   }
-  m_buffer.Set(buffer);
+  m_buffer = buffer;
+  // The buffer no longer reflects the merged sources.
+  m_merge_sources.clear();
+  m_last_source.clear();
+  if (m_slot_priorities.Size()) {
+    m_slot_priorities = DmxBuffer();
+  }
   return UpdateDependants();
 }
 
@@ -403,13 +706,58 @@ bool Universe::PortDataChanged(InputPort *port) {
              << UniverseId();
     return false;
   }
-  if (MergeAll(port, NULL)) {
+  if (m_input_trace) {
+    m_input_trace->Record(InputTrace::PORT_SOURCE, port->UniqueId(),
+                          m_universe_id, port->SourceData());
+  }
+  if (TimedMergeAll(port, NULL)) {
+    const TimeStamp &received = port->SourceData().Timestamp();
+    if (received.IsSet() && (!m_pending_input_time.IsSet() ||
+                             received < m_pending_input_time)) {
+      m_pending_input_time = received;
+    }
+    if (m_frame_history) {
+      m_last_source = "port:" + port->UniqueId();
+    }
     UpdateDependants();
   }
   return true;
 }
 
 
+/*
+ * Call this when a port that is part of this universe received the same data
+ * as last time.
+ *
+ * m_merge_sources is only kept for single source & HTP merges. For those, if
+ * the port was part of the last merge and the other sources haven't timed out
+ * the result of a merge would be the same.
+ * @param port the port that was refreshed
+ */
+bool Universe::PortDataRefreshed(InputPort *port) {
+  const TimeStamp &received = port->SourceData().Timestamp();
+  bool found = false;
+  MergeSourceList::const_iterator iter = m_merge_sources.begin();
+  for (; iter != m_merge_sources.end(); ++iter) {
+    if (iter->owner == port) {
+      found = true;
+    } else if (!iter->source.IsActive(received)) {
+      return PortDataChanged(port);
+    }
+  }
+  if (!found) {
+    return PortDataChanged(port);
+  }
+  if (m_input_trace) {
+    m_input_trace->Record(InputTrace::PORT_SOURCE, port->UniqueId(),
+                          m_universe_id, port->SourceData());
+  }
+  m_stats.input_frames++;
+  m_stats.last_input_time = received;
+  return true;
+}
+
+
 /*
  * Called to indicate that data from a client has changed
  */
@@ -419,7 +767,18 @@ bool Universe::SourceClientDataChanged(Client *client) {
   }
 
   AddSourceClient(client);   // always add since this may be the first call
-  if (MergeAll(NULL, client)) {
+  if (m_input_trace) {
+    const DmxSource *source = client->FindSourceData(m_universe_id);
+    if (source) {
+      m_input_trace->Record(InputTrace::CLIENT_SOURCE,
+                            client->GetUID().ToString(), m_universe_id,
+                            *source);
+    }
+  }
+  if (TimedMergeAll(NULL, client)) {
+    if (m_frame_history) {
+      m_last_source = "client:" + client->GetUID().ToString();
+    }
     UpdateDependants();
   }
   return true;
@@ -430,19 +789,20 @@ bool Universe::SourceClientDataChanged(Client *client) {
  * @brief Clean old source clients
  */
 void Universe::CleanStaleSourceClients() {
-  SourceClientMap::iterator iter = m_source_clients.begin();
+  SourceClientList::iterator iter = m_source_clients.begin();
   while (iter != m_source_clients.end()) {
-    if (iter->second) {
+    if (iter->stale) {
       // if stale remove it
-      m_source_clients.erase(iter++);
+      iter = m_source_clients.erase(iter);
       SafeDecrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
       OLA_INFO << "Removed Stale Client";
+      m_universe_store->UpdateClientList(this);
       if (!IsActive()) {
         m_universe_store->AddUniverseGarbageCollection(this);
       }
     } else {
-      // clear the stale flag
-      iter->second = true;
+      // set the stale flag, sending data clears it
+      iter->stale = true;
       ++iter;
     }
   }
@@ -465,6 +825,7 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
            << request->ParamDataSize();
 
   SafeIncrement(K_UNIVERSE_RDM_REQUESTS);
+  m_rdm_request_count++;
 
   if (request->DestinationUID().IsBroadcast()) {
     if (m_output_ports.empty()) {
@@ -489,13 +850,15 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
          ++port_iter) {
       // because each port deletes the request, we need to copy it here
       if (request->IsDUB()) {
-        (*port_iter)->SendRDMRequest(
+        DispatchRDMRequest(
+            *port_iter,
             request->Duplicate(),
             NewSingleCallback(this,
                               &Universe::HandleBroadcastDiscovery,
                               tracker));
       } else  {
-        (*port_iter)->SendRDMRequest(
+        DispatchRDMRequest(
+            *port_iter,
             request->Duplicate(),
             NewSingleCallback(this, &Universe::HandleBroadcastAck, tracker));
       }
@@ -509,7 +872,13 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
                << " in the output universe map, dropping request";
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
     } else {
-      iter->second->SendRDMRequest(request.release(), callback);
+      TimeStamp start_time;
+      m_clock->CurrentMonotonicTime(&start_time);
+      const UID uid = request->DestinationUID();
+      DispatchRDMRequest(
+          iter->second, request.release(),
+          NewSingleCallback(this, &Universe::HandleUnicastResponse, uid,
+                            start_time, callback));
     }
   }
 }
@@ -536,25 +905,20 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
   // the multicallback that indicates when discovery is done
   BaseCallback0<void> *discovery_complete = NewMultiCallback(
       output_ports.size(),
-      NewSingleCallback(this, &Universe::DiscoveryComplete, on_complete));
+      NewSingleCallback(this, &Universe::DiscoveryComplete, on_complete,
+                        m_last_discovery_time));
 
   // Send Discovery requests to all ports, as each of these return they'll
   // update the UID map. When all ports callbacks have run, the MultiCallback
   // will trigger, running the DiscoveryCallback.
   vector<OutputPort*>::iterator iter;
   for (iter = output_ports.begin(); iter != output_ports.end(); ++iter) {
-    if (full) {
-      (*iter)->RunFullDiscovery(
-          NewSingleCallback(this,
-                            &Universe::PortDiscoveryComplete,
-                            discovery_complete,
-                            *iter));
+    RDMDiscoveryCallback *port_complete = NewSingleCallback(
+        this, &Universe::PortDiscoveryComplete, discovery_complete, *iter);
+    if (m_discovery_scheduler) {
+      m_discovery_scheduler->RunDiscovery(*iter, port_complete, full);
     } else {
-      (*iter)->RunIncrementalDiscovery(
-          NewSingleCallback(this,
-                            &Universe::PortDiscoveryComplete,
-                            discovery_complete,
-                            *iter));
+      DispatchRDMDiscovery(*iter, port_complete, full);
     }
   }
 }
@@ -564,6 +928,12 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
  * Update the UID : port mapping with this new data
  */
 void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
+  const size_t uid_count = m_output_uids.size();
+  if (!m_restored_uids.empty()) {
+    // Discovery has run, so the restored UIDs are no longer needed.
+    m_restored_uids.erase(port->UniqueId());
+  }
+
   map<UID, OutputPort*>::iterator iter = m_output_uids.begin();
   while (iter != m_output_uids.end()) {
     if (iter->second == port && !uids.Contains(iter->first)) {
@@ -587,6 +957,13 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
     (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
         = m_output_uids.size();
   }
+  if (m_output_uids.size() != uid_count) {
+    m_universe_store->UniverseChanged();
+  }
+
+  ola::rdm::UIDSet all_uids;
+  GetUIDs(&all_uids);
+  m_rdm_stats->Retain(all_uids);
 }
 
 
@@ -608,6 +985,32 @@ unsigned int Universe::UIDCount() const {
   return m_output_uids.size();
 }
 
+/*
+ * Restore the DMX data & UIDs saved before a restart.
+ */
+void Universe::RestoreState(const DmxBuffer &buffer,
+                            const PortUIDMap &port_uids) {
+  if (buffer.Size()) {
+    m_buffer = buffer;
+    m_merge_sources.clear();
+    m_restored_dmx = true;
+  }
+  m_restored_uids = port_uids;
+}
+
+
+/*
+ * Get the UIDs for each output port, including ones we haven't seen yet.
+ */
+void Universe::GetPortUIDs(PortUIDMap *port_uids) const {
+  map<UID, OutputPort*>::const_iterator iter = m_output_uids.begin();
+  for (; iter != m_output_uids.end(); ++iter) {
+    (*port_uids)[iter->second->UniqueId()].AddUID(iter->first);
+  }
+  port_uids->insert(m_restored_uids.begin(), m_restored_uids.end());
+}
+
+
 /**
  * Return the RDM transaction number to use
  */
@@ -632,25 +1035,250 @@ bool Universe::IsActive() const {
 /*
  * Called when the dmx data for this universe changes,
  * updates everyone who needs to know (patched ports and network clients)
+ *
+ * If there is a frame clock, the frame is sent on its next tick. Otherwise if
+ * there is an output rate limit or coalescing window, the frame is sent later
+ * from the scheduler. Changes that arrive in the meantime are merged into the
+ * pending frame.
  */
 bool Universe::UpdateDependants() {
+  m_restored_dmx = false;
+  if (m_frame_clock) {
+    if (m_frame_clock_pending) {
+      SafeIncrement(K_COALESCED_FRAMES_VAR);
+    } else {
+      m_frame_clock_pending = true;
+      m_frame_clock->AddPendingUniverse(this);
+    }
+    return true;
+  }
+
+  if (!m_scheduler ||
+      (m_max_output_rate == 0 && m_coalescing_window.IsZero())) {
+    WriteToDependants();
+    return true;
+  }
+
+  if (m_output_timeout != ola::thread::INVALID_TIMEOUT) {
+    // A frame is already pending, it'll pick up the latest data when it's
+    // sent.
+    SafeIncrement(K_COALESCED_FRAMES_VAR);
+    return true;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  TimeStamp send_time = now + m_coalescing_window;
+  if (m_max_output_rate && m_last_output_time.IsSet()) {
+    TimeStamp earliest = m_last_output_time + TimeInterval(
+        static_cast<int64_t>(USEC_IN_SECONDS / m_max_output_rate));
+    send_time = std::max(send_time, earliest);
+  }
+
+  if (send_time > now) {
+    m_output_timeout = m_scheduler->RegisterSingleTimeout(
+        send_time - now,
+        NewSingleCallback(this, &Universe::FlushPendingOutput));
+    if (m_output_timeout != ola::thread::INVALID_TIMEOUT) {
+      return true;
+    }
+  }
+  WriteToDependants();
+  return true;
+}
+
+
+/*
+ * Called when the output timer fires.
+ */
+void Universe::FlushPendingOutput() {
+  m_output_timeout = ola::thread::INVALID_TIMEOUT;
+  WriteToDependants();
+}
+
+
+/*
+ * Called when the frame clock ticks.
+ */
+void Universe::SendFrameOnTick() {
+  m_frame_clock_pending = false;
+  WriteToDependants();
+}
+
+
+/*
+ * Send the current frame to all ports & clients.
+ */
+void Universe::WriteToDependants() {
   vector<OutputPort*>::const_iterator iter;
-  set<Client*>::const_iterator client_iter;
+  vector<Client*>::const_iterator client_iter;
 
   // write to all ports assigned to this universe
   for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
-    (*iter)->WriteDMX(m_buffer, m_active_priority);
+    DispatchWriteDMX(*iter, m_buffer, m_active_priority);
   }
 
-  // write to all clients
+  // write to all clients, they share the encoded update unless they've
+  // asked for a subset of the updates.
+  const DmxUpdate update(m_universe_id, m_active_priority, m_buffer);
   for (client_iter = m_sink_clients.begin();
        client_iter != m_sink_clients.end();
        ++client_iter) {
-    (*client_iter)->SendDMX(m_universe_id, m_active_priority, m_buffer);
+    FilteredSink *sink = m_filtered_sinks.empty() ? NULL :
+        STLFindOrNull(m_filtered_sinks, *client_iter);
+    if (sink) {
+      SendToFilteredSink(*client_iter, sink);
+    } else {
+      (*client_iter)->SendDMX(update);
+    }
   }
 
+  m_clock->CurrentMonotonicTime(&m_last_output_time);
+  if (m_frame_history) {
+    m_frame_history->AddFrame(m_universe_id, m_last_output_time,
+                              m_active_priority, m_last_source, m_buffer);
+  }
   SafeIncrement(K_FPS_VAR);
-  return true;
+  RecordDwellTime();
+  UpdateOutputStats();
+}
+
+
+/*
+ * Send the selected slots of the current frame to a filtered sink, subject to
+ * the rate limit.
+ */
+void Universe::SendToFilteredSink(Client *client, FilteredSink *sink) {
+  if (sink->send_timeout != ola::thread::INVALID_TIMEOUT) {
+    // An update is already pending, it'll pick up the latest data when it's
+    // sent.
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  const SinkOptions &options = sink->options;
+  if (options.max_rate && sink->sent) {
+    TimeStamp earliest = sink->last_send_time + TimeInterval(
+        static_cast<int64_t>(USEC_IN_SECONDS / options.max_rate));
+    if (earliest > now) {
+      // Without a scheduler the update is dropped, the next frame catches
+      // up.
+      if (m_scheduler) {
+        sink->send_timeout = m_scheduler->RegisterSingleTimeout(
+            earliest - now,
+            NewSingleCallback(this, &Universe::FlushFilteredSink, client));
+      }
+      return;
+    }
+  }
+  DeliverToFilteredSink(client, sink, now);
+}
+
+
+/*
+ * Send the selected slots of the current frame to a filtered sink.
+ */
+void Universe::DeliverToFilteredSink(Client *client, FilteredSink *sink,
+                                     const TimeStamp &now) {
+  const SinkOptions &options = sink->options;
+  DmxBuffer frame;
+  const unsigned int offset = std::min(options.slot_offset, m_buffer.Size());
+  unsigned int length = m_buffer.Size() - offset;
+  if (options.slot_count) {
+    length = std::min(length, options.slot_count);
+  }
+  if (offset == 0 && length == m_buffer.Size()) {
+    frame = m_buffer;
+  } else {
+    frame.Set(m_buffer.GetRaw() + offset, length);
+  }
+
+  if (options.changes_only && sink->sent && frame == sink->last_frame) {
+    return;
+  }
+
+  client->SendDMX(m_universe_id, m_active_priority, frame);
+  sink->last_frame = frame;
+  sink->last_send_time = now;
+  sink->sent = true;
+}
+
+
+/*
+ * Called when the rate limit for a filtered sink expires.
+ */
+void Universe::FlushFilteredSink(Client *client) {
+  FilteredSink *sink = STLFindOrNull(m_filtered_sinks, client);
+  if (sink) {
+    sink->send_timeout = ola::thread::INVALID_TIMEOUT;
+    TimeStamp now;
+    m_clock->CurrentMonotonicTime(&now);
+    DeliverToFilteredSink(client, sink, now);
+  }
+}
+
+
+/*
+ * Remove the SinkOptions for a client, if it has any.
+ */
+void Universe::RemoveFilteredSink(Client *client) {
+  FilteredSinkMap::iterator iter = m_filtered_sinks.find(client);
+  if (iter == m_filtered_sinks.end()) {
+    return;
+  }
+  if (iter->second->send_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(iter->second->send_timeout);
+  }
+  delete iter->second;
+  m_filtered_sinks.erase(iter);
+}
+
+
+/*
+ * Count the slots that changed since the last frame.
+ */
+void Universe::UpdateOutputStats() {
+  unsigned int changed = 0;
+  if (m_buffer.GetRaw() != m_last_output.GetRaw()) {
+    const unsigned int common = std::min(m_buffer.Size(),
+                                         m_last_output.Size());
+    changed = ola::dmx::DifferingSlots(m_buffer.GetRaw(),
+                                       m_last_output.GetRaw(), common);
+    // Slots added or removed count as changes.
+    changed += std::max(m_buffer.Size(), m_last_output.Size()) - common;
+    // This shares the data rather than copying it.
+    m_last_output = m_buffer;
+  }
+
+  m_stats.output_frames++;
+  m_stats.changed_slots += changed;
+  m_stats.last_changed_slots = changed;
+  m_stats.last_output_time = m_last_output_time;
+}
+
+
+/*
+ * Add the time the pending input port data waited to the dwell time
+ * histogram.
+ */
+void Universe::RecordDwellTime() {
+  if (!m_pending_input_time.IsSet()) {
+    return;
+  }
+
+  int64_t dwell = 0;
+  if (m_last_output_time > m_pending_input_time) {
+    dwell = (m_last_output_time - m_pending_input_time).AsInt();
+  }
+  m_pending_input_time = TimeStamp();
+
+  unsigned int bucket = 0;
+  while (bucket < K_DWELL_TIME_BUCKETS - 1 &&
+         dwell >= static_cast<int64_t>(K_DWELL_TIME_LIMITS_US[bucket])) {
+    bucket++;
+  }
+  SafeIncrement(K_DWELL_TIME_VARS[bucket]);
 }
 
 
@@ -680,16 +1308,292 @@ void Universe::UpdateMode() {
 
 
 /*
- * HTP Merge all sources (clients/ports)
+ * HTP Merge all sources (clients/ports) into m_buffer.
  * @pre sources.size >= 2
- * @param sources the list of DmxSources to merge
+ * @param sources the list of sources to merge
+ * @returns true if the data in m_buffer changed, false otherwise
  */
-void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
-  vector<DmxSource>::const_iterator iter;
-  m_buffer.Reset();
+bool Universe::HTPMergeSources(const MergeSourceList &sources) {
+  MergeSourceList::const_iterator iter;
+  m_merge_buffer.Reset();
+
+  for (iter = sources.begin(); iter != sources.end(); ++iter) {
+    m_merge_buffer.HTPMerge(iter->source.Data());
+  }
+
+  if (m_merge_buffer == m_buffer) {
+    return false;
+  }
+  m_buffer = m_merge_buffer;
+  return true;
+}
+
 
+/*
+ * Merge the sources using a priority for each slot, into m_buffer and
+ * m_slot_priorities. For each slot the source with the highest priority wins,
+ * and sources with the same priority are HTP merged. Sources without slot
+ * priorities use their universe priority for every slot.
+ * @param sources the list of sources to merge
+ * @returns true if the data or the slot priorities changed, false otherwise
+ */
+bool Universe::SlotPriorityMergeSources(const MergeSourceList &sources) {
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  uint8_t priorities[DMX_UNIVERSE_SIZE];
+  uint8_t source_priorities[DMX_UNIVERSE_SIZE];
+  memset(data, DMX_MIN_SLOT_VALUE, sizeof(data));
+  memset(priorities, ola::dmx::SLOT_PRIORITY_NOT_SOURCED, sizeof(priorities));
+  unsigned int size = 0;
+
+  MergeSourceList::const_iterator iter;
   for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    m_buffer.HTPMerge(iter->Data());
+    const DmxBuffer &buffer = iter->source.Data();
+    const unsigned int length = buffer.Size();
+    size = std::max(size, length);
+
+    const uint8_t *slot_priorities = source_priorities;
+    if (iter->source.HasSlotPriorities()) {
+      const DmxBuffer &source_slot_priorities = iter->source.SlotPriorities();
+      if (source_slot_priorities.Size() >= length) {
+        slot_priorities = source_slot_priorities.GetRaw();
+      } else {
+        unsigned int priority_count = length;
+        source_slot_priorities.Get(source_priorities, &priority_count);
+        memset(source_priorities + priority_count,
+               ola::dmx::SLOT_PRIORITY_NOT_SOURCED, length - priority_count);
+      }
+    } else {
+      // A slot priority of 0 means the slot isn't sourced, so the lowest
+      // universe priority becomes 1.
+      memset(source_priorities,
+             std::max(iter->source.Priority(), static_cast<uint8_t>(1)),
+             length);
+    }
+    ola::dmx::SlotPriorityMerge(data, priorities, buffer.GetRaw(),
+                                slot_priorities, length);
+  }
+
+  bool changed = false;
+  if (size != m_slot_priorities.Size() ||
+      !ola::dmx::SlotsEqual(priorities, m_slot_priorities.GetRaw(), size)) {
+    m_slot_priorities.Set(priorities, size);
+    changed = true;
+  }
+  if (size != m_buffer.Size() ||
+      !ola::dmx::SlotsEqual(data, m_buffer.GetRaw(), size)) {
+    m_buffer.Set(data, size);
+    changed = true;
+  }
+  return changed;
+}
+
+
+/*
+ * Merge the sources using the merge profile, into m_buffer. The LTP slots take
+ * their value from the newest source, and the other slots are HTP merged.
+ * @param sources the list of sources to merge
+ * @returns true if the data changed, false otherwise
+ */
+bool Universe::ProfileMergeSources(const MergeSourceList &sources) {
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  memset(data, DMX_MIN_SLOT_VALUE, sizeof(data));
+  unsigned int size = 0;
+
+  MergeSourceList::const_iterator newest = sources.begin();
+  MergeSourceList::const_iterator iter;
+  for (iter = sources.begin(); iter != sources.end(); ++iter) {
+    const DmxBuffer &buffer = iter->source.Data();
+    ola::dmx::SlotMax(data, buffer.GetRaw(), buffer.Size());
+    size = std::max(size, buffer.Size());
+    if (newest->source.Timestamp() < iter->source.Timestamp()) {
+      newest = iter;
+    }
+  }
+
+  // Slots past the end of the newest source keep the HTP value.
+  const DmxBuffer &latest = newest->source.Data();
+  ola::dmx::SlotMaskedCopy(data, latest.GetRaw(), m_ltp_mask.GetRaw(),
+                           std::min(latest.Size(), m_ltp_mask.Size()));
+
+  if (size == m_buffer.Size() &&
+      ola::dmx::SlotsEqual(data, m_buffer.GetRaw(), size)) {
+    return false;
+  }
+  m_buffer.Set(data, size);
+  return true;
+}
+
+
+/*
+ * Replace the active sources with every source that's active, regardless of
+ * its universe priority. This is used for slot priority merges, since a
+ * source with a low universe priority may still win some slots.
+ * @param now the current time
+ */
+void Universe::AddAllActiveSources(const TimeStamp &now) {
+  m_active_sources.clear();
+
+  vector<InputPort*>::const_iterator iter;
+  for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
+    const DmxSource &source = (*iter)->SourceData();
+    if (source.IsSet() && source.IsActive(now) && source.Data().Size()) {
+      merge_source active_source = {*iter, source};
+      m_active_sources.push_back(active_source);
+    }
+  }
+
+  SourceClientList::iterator client_iter;
+  for (client_iter = m_source_clients.begin();
+       client_iter != m_source_clients.end();
+       ++client_iter) {
+    const DmxSource *source = ClientSource(&*client_iter);
+    if (source && source->IsSet() && source->IsActive(now) &&
+        source->Data().Size()) {
+      merge_source active_source = {client_iter->client, *source};
+      m_active_sources.push_back(active_source);
+    }
+  }
+}
+
+
+/*
+ * Re-merge only the slots that changed since the last merge.
+ *
+ * This is only possible if the set of sources is the same as the last time we
+ * merged, and only the changed source has new data. Otherwise the caller
+ * needs to fall back to a full merge.
+ * @param sources the list of active sources
+ * @param changed_owner the port or client that changed
+ * @param[out] output_changed set to true if the data in m_buffer changed
+ * @returns true if the incremental merge was performed, false if a full merge
+ *   is required.
+ */
+bool Universe::HTPMergeChangedSlots(const MergeSourceList &sources,
+                                    const void *changed_owner,
+                                    bool *output_changed) {
+  if (sources.size() != m_merge_sources.size()) {
+    return false;
+  }
+
+  const DmxBuffer *new_data = NULL;
+  const DmxBuffer *old_data = NULL;
+  for (unsigned int i = 0; i < sources.size(); i++) {
+    if (sources[i].owner != m_merge_sources[i].owner) {
+      return false;
+    }
+
+    const DmxBuffer &data = sources[i].source.Data();
+    const DmxBuffer &last_data = m_merge_sources[i].source.Data();
+    if (data.Size() != last_data.Size()) {
+      return false;
+    }
+
+    if (sources[i].owner == changed_owner) {
+      new_data = &data;
+      old_data = &last_data;
+    } else if (data != last_data) {
+      return false;
+    }
+  }
+
+  if (!new_data) {
+    return false;
+  }
+
+  // Find the range of slots touched by this update.
+  const unsigned int size = new_data->Size();
+  unsigned int first = ola::dmx::FirstDifferingSlot(
+      new_data->GetRaw(), old_data->GetRaw(), size);
+
+  *output_changed = false;
+  if (first == size) {
+    return true;
+  }
+
+  unsigned int last = size - 1;
+  while (last > first && new_data->Get(last) == old_data->Get(last)) {
+    last--;
+  }
+
+  MergeSourceList::const_iterator iter;
+  for (unsigned int slot = first; slot <= last; slot++) {
+    uint8_t value = DMX_MIN_SLOT_VALUE;
+    for (iter = sources.begin(); iter != sources.end(); ++iter) {
+      value = std::max(value, iter->source.Data().Get(slot));
+    }
+    if (m_buffer.Get(slot) != value) {
+      m_buffer.SetChannel(slot, value);
+      *output_changed = true;
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Find the entry for a source client.
+ */
+Universe::SourceClientList::iterator Universe::FindSourceClient(
+    const Client *client) {
+  SourceClientList::iterator iter = m_source_clients.begin();
+  for (; iter != m_source_clients.end(); ++iter) {
+    if (iter->client == client) {
+      break;
+    }
+  }
+  return iter;
+}
+
+
+/*
+ * Return the data for a source client, or NULL if it hasn't sent any yet.
+ */
+const DmxSource *Universe::ClientSource(source_client *entry) {
+  if (!entry->source) {
+    entry->source = entry->client->FindSourceData(m_universe_id);
+  }
+  return entry->source;
+}
+
+
+/*
+ * Add a source to the list of active sources, if it's at or above the current
+ * active priority.
+ * @param owner the port or client that owns the source
+ * @param source the DmxSource
+ * @param now the current time
+ * @param is_changed_source true if this is the source that triggered the merge
+ * @param[out] changed_source_is_active set to true if the changed source is
+ *   one of the active sources.
+ * @param[out] have_slot_priorities set to true if the source is active and
+ *   has slot priorities, whatever its universe priority.
+ */
+void Universe::AddActiveSource(const void *owner,
+                               const DmxSource &source,
+                               const TimeStamp &now,
+                               bool is_changed_source,
+                               bool *changed_source_is_active,
+                               bool *have_slot_priorities) {
+  if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
+    return;
+  }
+
+  if (source.HasSlotPriorities()) {
+    *have_slot_priorities = true;
+  }
+
+  if (source.Priority() > m_active_priority) {
+    *changed_source_is_active = false;
+    m_active_sources.clear();
+    m_active_priority = source.Priority();
+  }
+
+  if (source.Priority() == m_active_priority) {
+    merge_source active_source = {owner, source};
+    m_active_sources.push_back(active_source);
+    if (is_changed_source) {
+      *changed_source_is_active = true;
+    }
   }
 }
 
@@ -698,108 +1602,156 @@ void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
  * Merge all port/client sources.
  * This does a priority based merge as documented at:
  * https://wiki.openlighting.org/index.php/OLA_Merging_Algorithms
+ *
+ * We keep the sources from the previous merge, so if the same set of sources
+ * are active we only need to re-merge the slots the changed source touched.
  * @param port the input port that changed or NULL
  * @param client the client that changed or NULL
  * @returns true if the data for this universe changed, false otherwise
  */
 bool Universe::MergeAll(const InputPort *port, const Client *client) {
-  vector<DmxSource> active_sources;
-
-  vector<InputPort*>::const_iterator iter;
-  SourceClientMap::const_iterator client_iter;
-
+  const uint8_t last_priority = m_active_priority;
+  m_active_sources.clear();
   m_active_priority = ola::dmx::SOURCE_PRIORITY_MIN;
   TimeStamp now;
-  m_clock->CurrentMonotonicTime(&now);
+  if (m_wake_up_time && m_wake_up_time->IsSet()) {
+    now = *m_wake_up_time;
+  } else {
+    m_clock->CurrentMonotonicTime(&now);
+  }
   bool changed_source_is_active = false;
+  bool have_slot_priorities = false;
 
   // Find the highest active ports
+  vector<InputPort*>::const_iterator iter;
   for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
-    DmxSource source = (*iter)->SourceData();
-    if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
-      continue;
-    }
-
-    if (source.Priority() > m_active_priority) {
-      changed_source_is_active = false;
-      active_sources.clear();
-      m_active_priority = source.Priority();
-    }
-
-    if (source.Priority() == m_active_priority) {
-      active_sources.push_back(source);
-      if (*iter == port) {
-        changed_source_is_active = true;
-      }
-    }
+    AddActiveSource(*iter, (*iter)->SourceData(), now, *iter == port,
+                    &changed_source_is_active, &have_slot_priorities);
   }
 
   // find the highest priority active clients
+  SourceClientList::iterator client_iter;
   for (client_iter = m_source_clients.begin();
        client_iter != m_source_clients.end();
        ++client_iter) {
-    const DmxSource &source = client_iter->first->SourceData(UniverseId());
-
-    if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
-      continue;
-    }
-
-    if (source.Priority() > m_active_priority) {
-      changed_source_is_active = false;
-      active_sources.clear();
-      m_active_priority = source.Priority();
-    }
-
-    if (source.Priority() == m_active_priority) {
-      active_sources.push_back(source);
-      if (client_iter->first == client) {
-        changed_source_is_active = true;
-      }
+    const DmxSource *source = ClientSource(&*client_iter);
+    if (source) {
+      AddActiveSource(client_iter->client, *source, now,
+                      client_iter->client == client,
+                      &changed_source_is_active, &have_slot_priorities);
     }
   }
+  m_stats.active_sources = m_active_sources.size();
 
-  if (active_sources.empty()) {
+  if (m_active_sources.empty()) {
     OLA_WARN << "Something changed but we didn't find any active sources "
              << " for universe " << UniverseId();
     return false;
   }
 
-  if (!changed_source_is_active) {
+  // With slot priorities, a source below the active priority can still win
+  // some of the slots.
+  if (!changed_source_is_active && !have_slot_priorities) {
     // this source didn't have any effect, skip
     return false;
   }
 
-  // only one source at the active priority
-  if (active_sources.size() == 1) {
-    m_buffer.Set(active_sources[0].Data());
-  } else {
-    // multi source merge
-    if (m_merge_mode == Universe::MERGE_LTP) {
-      vector<DmxSource>::const_iterator source_iter = active_sources.begin();
-      DmxSource changed_source;
-      if (port) {
-        changed_source = port->SourceData();
-      } else {
-        changed_source = client->SourceData(UniverseId());
-      }
+  // Once the last source with slot priorities goes away, the ports need to be
+  // told even if the data is the same.
+  const bool slot_priorities_removed = (!have_slot_priorities &&
+                                        m_slot_priorities.Size());
+  if (slot_priorities_removed) {
+    m_slot_priorities = DmxBuffer();
+  }
 
-      // check that the current port/client is newer than all other active
-      // sources
-      for (; source_iter != active_sources.end(); source_iter++) {
-        if (changed_source.Timestamp() < source_iter->Timestamp()) {
-          return false;
-        }
-      }
-      // if we made it to here this is the newest source
-      m_buffer.Set(changed_source.Data());
+  bool output_changed = true;
+  if (have_slot_priorities) {
+    AddAllActiveSources(now);
+    m_stats.active_sources = m_active_sources.size();
+    output_changed = SlotPriorityMergeSources(m_active_sources);
+    // m_buffer isn't a HTP merge of the sources, so don't keep them.
+    m_merge_sources.clear();
+  } else if (m_active_sources.size() == 1) {
+    // only one source at the active priority
+    const DmxBuffer &data = m_active_sources[0].source.Data();
+    output_changed = m_buffer != data;
+    if (output_changed) {
+      // share the source's frame rather than copying it
+      m_buffer = data;
+    }
+    m_merge_sources.swap(m_active_sources);
+  } else if (HasMergeProfile()) {
+    output_changed = ProfileMergeSources(m_active_sources);
+    // m_buffer isn't a HTP merge of the sources, so don't keep them.
+    m_merge_sources.clear();
+  } else if (m_merge_mode == Universe::MERGE_LTP) {
+    DmxSource changed_source;
+    if (port) {
+      changed_source = port->SourceData();
     } else {
-      HTPMergeSources(active_sources);
+      changed_source = client->SourceData(UniverseId());
+    }
+
+    // check that the current port/client is newer than all other active
+    // sources
+    MergeSourceList::const_iterator source_iter = m_active_sources.begin();
+    for (; source_iter != m_active_sources.end(); source_iter++) {
+      if (changed_source.Timestamp() < source_iter->source.Timestamp()) {
+        return false;
+      }
+    }
+    // if we made it to here this is the newest source
+    output_changed = m_buffer != changed_source.Data();
+    if (output_changed) {
+      m_buffer = changed_source.Data();
     }
+    // m_buffer isn't a HTP merge of the sources, so don't keep them.
+    m_merge_sources.clear();
+  } else {
+    const void *changed_owner = port ?
+        static_cast<const void*>(port) : static_cast<const void*>(client);
+    if (!HTPMergeChangedSlots(m_active_sources, changed_owner,
+                              &output_changed)) {
+      output_changed = HTPMergeSources(m_active_sources);
+    }
+    m_merge_sources.swap(m_active_sources);
+  }
+
+  m_active_sources.clear();
+  output_changed |= slot_priorities_removed;
+
+  if (m_active_priority != last_priority) {
+    m_universe_store->UniverseChanged();
+  }
+
+  if (!output_changed && m_active_priority == last_priority &&
+      now - m_last_update_time < K_UNCHANGED_REFRESH_INTERVAL) {
+    // Nothing downstream needs to know about this update.
+    return false;
   }
+  m_last_update_time = now;
   return true;
 }
 
 
+/*
+ * Merge the sources, recording the input frame & the time the merge took.
+ */
+bool Universe::TimedMergeAll(const InputPort *port, const Client *client) {
+  TimeStamp start, end;
+  m_clock->CurrentMonotonicTime(&start);
+  bool changed = MergeAll(port, client);
+  m_clock->CurrentMonotonicTime(&end);
+
+  m_stats.input_frames++;
+  m_stats.last_input_time = start;
+  if (end > start) {
+    m_stats.merge_time_us += (end - start).AsInt();
+  }
+  return changed;
+}
+
+
 /**
  * Called when discovery completes on a single ports.
  */
@@ -811,10 +1763,30 @@ void Universe::PortDiscoveryComplete(BaseCallback0<void> *on_complete,
 }
 
 
+/**
+ * Called when the discovery run after restoring a port's UIDs completes.
+ */
+void Universe::RestoredPortDiscoveryComplete(OutputPort *output_port,
+                                             const ola::rdm::UIDSet &uids) {
+  // The port may have been removed while discovery was running.
+  if (ContainsPort(output_port)) {
+    NewUIDList(output_port, uids);
+  }
+}
+
+
 /**
  * Called when discovery completes on all ports.
  */
-void Universe::DiscoveryComplete(RDMDiscoveryCallback *on_complete) {
+void Universe::DiscoveryComplete(RDMDiscoveryCallback *on_complete,
+                                 TimeStamp start_time) {
+  if (m_export_map) {
+    TimeStamp now;
+    m_clock->CurrentMonotonicTime(&now);
+    (*m_export_map->GetUIntMapVar(K_UNIVERSE_RDM_DISCOVERY_TIME_VAR))[
+        m_universe_id_str] = (now - start_time).InMilliSeconds();
+  }
+
   ola::rdm::UIDSet uids;
   GetUIDs(&uids);
   if (on_complete) {
@@ -823,6 +1795,20 @@ void Universe::DiscoveryComplete(RDMDiscoveryCallback *on_complete) {
 }
 
 
+/**
+ * Record the outcome of a unicast request, then pass the reply on.
+ */
+void Universe::HandleUnicastResponse(UID uid,
+                                     TimeStamp start_time,
+                                     ola::rdm::RDMCallback *callback,
+                                     RDMReply *reply) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  m_rdm_stats->RequestComplete(uid, now - start_time, *reply);
+  callback->Run(reply);
+}
+
+
 /**
  * Track fan-out responses for a broadcast request.
  * This increments the port counter until we reach the expected value, and
@@ -926,6 +1912,7 @@ bool Universe::GenericAddPort(PortClass *port, vector<PortClass*> *ports) {
         K_UNIVERSE_OUTPUT_PORT_VAR);
     (*map)[m_universe_id_str]++;
   }
+  m_universe_store->UniverseChanged();
   return true;
 }
 
@@ -955,6 +1942,7 @@ bool Universe::GenericRemovePort(PortClass *port,
         K_UNIVERSE_OUTPUT_PORT_VAR);
     (*map)[m_universe_id_str]--;
   }
+  m_universe_store->UniverseChanged();
 
   if (!IsActive()) {
     m_universe_store->AddUniverseGarbageCollection(this);
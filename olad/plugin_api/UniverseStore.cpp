@@ -19,8 +19,24 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include "olad/plugin_api/UniverseStore.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif  // HAVE_MMAP
+
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <sstream>
@@ -28,34 +44,62 @@
 #include <utility>
 #include <vector>
 
+#include "ola/Callback.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/Constants.h"
 #include "ola/StringUtils.h"
+#include "ola/io/BigEndianStream.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/MemoryBuffer.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/Preferences.h"
 #include "olad/Universe.h"
 
 namespace ola {
 
+using ola::rdm::UID;
 using std::pair;
 using std::set;
 using std::string;
 using std::vector;
 
 const unsigned int UniverseStore::MINIMUM_RDM_DISCOVERY_INTERVAL = 30;
+const char UniverseStore::STATE_MAGIC[] = "OLA-STATE-1\n";
+const unsigned int UniverseStore::DIRECT_LOOKUP_LIMIT;
+const unsigned int UniverseStore::GARBAGE_COLLECTION_DELAY_MS;
+const unsigned int UniverseStore::LOOKUP_PAGE_BITS;
+const unsigned int UniverseStore::LOOKUP_PAGE_SIZE;
 
 UniverseStore::UniverseStore(Preferences *preferences,
-                             ExportMap *export_map)
+                             ExportMap *export_map,
+                             ola::thread::SchedulerInterface *scheduler,
+                             const TimeStamp *wake_up_time)
     : m_preferences(preferences),
-      m_export_map(export_map) {
+      m_export_map(export_map),
+      m_scheduler(scheduler),
+      m_discovery_scheduler(NULL),
+      m_frame_clock(NULL),
+      m_frame_history(NULL),
+      m_input_trace(NULL),
+      m_lookup_table(DIRECT_LOOKUP_LIMIT / LOOKUP_PAGE_SIZE),
+      m_universes_with_clients(NULL),
+      m_gc_timeout(ola::thread::INVALID_TIMEOUT),
+      m_wake_up_time(wake_up_time),
+      m_generation(0) {
   if (export_map) {
     export_map->GetStringMapVar(Universe::K_UNIVERSE_NAME_VAR, "universe");
     export_map->GetStringMapVar(Universe::K_UNIVERSE_MODE_VAR, "universe");
 
     const char *vars[] = {
+      Universe::K_COALESCED_FRAMES_VAR,
       Universe::K_FPS_VAR,
       Universe::K_UNIVERSE_INPUT_PORT_VAR,
       Universe::K_UNIVERSE_OUTPUT_PORT_VAR,
+      Universe::K_UNIVERSE_OUTPUT_RATE_VAR,
+      Universe::K_UNIVERSE_RDM_DISCOVERY_TIME_VAR,
       Universe::K_UNIVERSE_SINK_CLIENTS_VAR,
       Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR,
       Universe::K_UNIVERSE_UID_COUNT_VAR,
@@ -71,11 +115,53 @@ UniverseStore::~UniverseStore() {
   DeleteAll();
 }
 
+void UniverseStore::SetDiscoveryScheduler(DiscoveryScheduler *scheduler) {
+  m_discovery_scheduler = scheduler;
+  UniverseMap::iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    iter->second->SetDiscoveryScheduler(scheduler);
+  }
+}
+
+void UniverseStore::SetFrameClock(FrameClock *frame_clock) {
+  m_frame_clock = frame_clock;
+  UniverseMap::iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    iter->second->SetFrameClock(
+        UsesFrameClock(iter->second) ? frame_clock : NULL);
+  }
+}
+
+void UniverseStore::SetFrameHistory(FrameHistory *frame_history) {
+  m_frame_history = frame_history;
+  UniverseMap::iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    iter->second->SetFrameHistory(frame_history);
+  }
+}
+
+void UniverseStore::SetInputTrace(InputTrace *input_trace) {
+  m_input_trace = input_trace;
+  UniverseMap::iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    iter->second->SetInputTrace(input_trace);
+  }
+}
+
 Universe *UniverseStore::GetUniverse(unsigned int universe_id) const {
+  if (universe_id < DIRECT_LOOKUP_LIMIT) {
+    const LookupPage &page = m_lookup_table[universe_id >> LOOKUP_PAGE_BITS];
+    return page.empty() ? NULL : page[universe_id & (LOOKUP_PAGE_SIZE - 1)];
+  }
   return STLFindOrNull(m_universe_map, universe_id);
 }
 
 Universe *UniverseStore::GetUniverseOrCreate(unsigned int universe_id) {
+  Universe *universe = GetUniverse(universe_id);
+  if (universe) {
+    return universe;
+  }
+
   UniverseMap::iterator iter = STLLookupOrInsertNull(
       &m_universe_map, universe_id);
 
@@ -83,9 +169,26 @@ Universe *UniverseStore::GetUniverseOrCreate(unsigned int universe_id) {
     iter->second = new Universe(universe_id, this, m_export_map, &m_clock);
 
     if (iter->second) {
+      iter->second->SetOutputScheduler(m_scheduler);
+      iter->second->SetWakeUpTime(m_wake_up_time);
+      iter->second->SetDiscoveryScheduler(m_discovery_scheduler);
+      iter->second->SetFrameHistory(m_frame_history);
+      iter->second->SetInputTrace(m_input_trace);
       if (m_preferences) {
         RestoreUniverseSettings(iter->second);
       }
+
+      UniverseStateMap::iterator state_iter = m_saved_state.find(universe_id);
+      if (state_iter != m_saved_state.end()) {
+        iter->second->RestoreState(state_iter->second.dmx,
+                                   state_iter->second.port_uids);
+        m_saved_state.erase(state_iter);
+      }
+      SetLookup(universe_id, iter->second);
+      m_generation++;
+      // Nothing is using the universe yet. If a port or client isn't added
+      // it's deleted on the next collection.
+      AddUniverseGarbageCollection(iter->second);
     } else {
       OLA_WARN << "Failed to create universe " << universe_id;
     }
@@ -97,6 +200,41 @@ void UniverseStore::GetList(vector<Universe*> *universes) const {
   STLValues(m_universe_map, universes);
 }
 
+void UniverseStore::GetUniversesWithClients(
+    vector<Universe*> *universes) const {
+  for (Universe *universe = m_universes_with_clients; universe;
+       universe = universe->m_next_with_clients) {
+    universes->push_back(universe);
+  }
+}
+
+void UniverseStore::CleanStaleSourceClients() {
+  Universe *universe = m_universes_with_clients;
+  while (universe) {
+    // This may remove the universe from the list.
+    Universe *next = universe->m_next_with_clients;
+    universe->CleanStaleSourceClients();
+    universe = next;
+  }
+}
+
+void UniverseStore::UpdateClientList(Universe *universe) {
+  const bool listed = (universe->m_prev_with_clients ||
+                       m_universes_with_clients == universe);
+  if (universe->HasClients()) {
+    if (!listed) {
+      universe->m_next_with_clients = m_universes_with_clients;
+      if (m_universes_with_clients) {
+        m_universes_with_clients->m_prev_with_clients = universe;
+      }
+      m_universes_with_clients = universe;
+    }
+  } else if (listed) {
+    RemoveFromClientList(universe);
+  }
+  m_generation++;
+}
+
 void UniverseStore::DeleteAll() {
   UniverseMap::iterator iter;
 
@@ -106,10 +244,26 @@ void UniverseStore::DeleteAll() {
   }
   m_deletion_candidates.clear();
   m_universe_map.clear();
+  m_universes_with_clients = NULL;
+  m_generation++;
+  if (m_gc_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_gc_timeout);
+    m_gc_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  vector<LookupPage>::iterator page_iter = m_lookup_table.begin();
+  for (; page_iter != m_lookup_table.end(); ++page_iter) {
+    page_iter->clear();
+  }
 }
 
 void UniverseStore::AddUniverseGarbageCollection(Universe *universe) {
   m_deletion_candidates.insert(universe);
+  if (m_scheduler && m_gc_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_gc_timeout = m_scheduler->RegisterSingleTimeout(
+        GARBAGE_COLLECTION_DELAY_MS,
+        NewSingleCallback(this, &UniverseStore::GarbageCollectTimeout));
+  }
 }
 
 void UniverseStore::GarbageCollectUniverses() {
@@ -121,12 +275,312 @@ void UniverseStore::GarbageCollectUniverses() {
     if (!(*iter)->IsActive()) {
       SaveUniverseSettings(*iter);
       m_universe_map.erase((*iter)->UniverseId());
+      SetLookup((*iter)->UniverseId(), NULL);
+      RemoveFromClientList(*iter);
       delete *iter;
+      m_generation++;
     }
   }
   m_deletion_candidates.clear();
 }
 
+void UniverseStore::GarbageCollectTimeout() {
+  m_gc_timeout = ola::thread::INVALID_TIMEOUT;
+  GarbageCollectUniverses();
+}
+
+bool UniverseStore::LoadState(const string &filename) {
+  UniverseStateMap state;
+  bool ok = false;
+
+#ifdef HAVE_MMAP
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) || file_stat.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  const size_t size = file_stat.st_size;
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    OLA_WARN << "Failed to map " << filename << ": " << strerror(errno);
+    return false;
+  }
+
+  ok = ParseState(static_cast<const uint8_t*>(data), size, &state);
+  munmap(data, size);
+#else
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::ostringstream data;
+  data << file.rdbuf();
+  const string input = data.str();
+  ok = ParseState(reinterpret_cast<const uint8_t*>(input.data()),
+                  input.size(), &state);
+#endif  // HAVE_MMAP
+
+  if (!ok) {
+    OLA_WARN << "Ignoring invalid state file " << filename;
+    return false;
+  }
+
+  OLA_INFO << "Loaded the state of " << state.size() << " universes from "
+           << filename;
+  m_saved_state.swap(state);
+  return true;
+}
+
+bool UniverseStore::SaveState(const string &filename) {
+  // Universes which haven't been created yet keep their loaded state.
+  UniverseStateMap state(m_saved_state);
+  UniverseMap::const_iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    UniverseState &universe_state = state[iter->first];
+    universe_state.dmx = iter->second->GetDMX();
+    universe_state.port_uids.clear();
+    iter->second->GetPortUIDs(&universe_state.port_uids);
+  }
+
+  string output;
+  SerializeState(state, &output);
+  if (output == m_last_state) {
+    return true;
+  }
+
+  // Write to a temporary file and rename it, so a crash while saving never
+  // leaves a partial file.
+  const string temp_file = filename + ".new";
+  std::ofstream out(temp_file.c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    OLA_WARN << "Failed to open " << temp_file << ": " << strerror(errno);
+    return false;
+  }
+  out.write(output.data(), output.size());
+  out.close();
+
+#ifdef _WIN32
+  // rename() won't replace an existing file on Windows.
+  unlink(filename.c_str());
+#endif  // _WIN32
+  if (out.fail() || rename(temp_file.c_str(), filename.c_str())) {
+    OLA_WARN << "Failed to write " << filename;
+    unlink(temp_file.c_str());
+    return false;
+  }
+  m_last_state.swap(output);
+  return true;
+}
+
+
+void UniverseStore::SetLookup(unsigned int universe_id, Universe *universe) {
+  if (universe_id >= DIRECT_LOOKUP_LIMIT) {
+    return;
+  }
+  LookupPage &page = m_lookup_table[universe_id >> LOOKUP_PAGE_BITS];
+  if (page.empty()) {
+    if (!universe) {
+      return;
+    }
+    page.resize(LOOKUP_PAGE_SIZE, NULL);
+  }
+  page[universe_id & (LOOKUP_PAGE_SIZE - 1)] = universe;
+}
+
+void UniverseStore::RemoveFromClientList(Universe *universe) {
+  if (universe->m_prev_with_clients) {
+    universe->m_prev_with_clients->m_next_with_clients =
+        universe->m_next_with_clients;
+  } else if (m_universes_with_clients == universe) {
+    m_universes_with_clients = universe->m_next_with_clients;
+  } else {
+    return;
+  }
+
+  if (universe->m_next_with_clients) {
+    universe->m_next_with_clients->m_prev_with_clients =
+        universe->m_prev_with_clients;
+  }
+  universe->m_prev_with_clients = NULL;
+  universe->m_next_with_clients = NULL;
+}
+
+
+/*
+ * Parse a list of slots like "1-16,33", the slots in the string start from 1.
+ * @param value the string to parse
+ * @param[out] slots the slots, starting from 0.
+ * @returns true if the list was valid, false otherwise.
+ */
+bool UniverseStore::ParseSlotList(const string &value,
+                                  vector<unsigned int> *slots) {
+  vector<string> ranges;
+  StringSplit(value, &ranges, ",");
+  vector<string>::const_iterator iter = ranges.begin();
+  for (; iter != ranges.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+
+    vector<string> tokens;
+    StringSplit(*iter, &tokens, "-");
+    unsigned int first, last;
+    if (tokens.size() > 2 || !StringToInt(tokens[0], &first, true)) {
+      return false;
+    }
+    if (tokens.size() == 1) {
+      last = first;
+    } else if (!StringToInt(tokens[1], &last, true)) {
+      return false;
+    }
+
+    if (first < 1 || first > last || last > DMX_UNIVERSE_SIZE) {
+      return false;
+    }
+    for (unsigned int slot = first; slot <= last; slot++) {
+      slots->push_back(slot - 1);
+    }
+  }
+  return true;
+}
+
+
+/*
+ * The opposite of ParseSlotList().
+ * @param slots the slots, starting from 0, in order.
+ */
+string UniverseStore::FormatSlotList(const vector<unsigned int> &slots) {
+  std::ostringstream str;
+  vector<unsigned int>::const_iterator iter = slots.begin();
+  while (iter != slots.end()) {
+    const unsigned int first = *iter;
+    unsigned int last = first;
+    while (++iter != slots.end() && *iter == last + 1) {
+      last++;
+    }
+
+    if (str.tellp() > 0) {
+      str << ",";
+    }
+    str << first + 1;
+    if (last != first) {
+      str << "-" << last + 1;
+    }
+  }
+  return str.str();
+}
+
+
+/*
+ * Parse the state file, the format is:
+ *   STATE_MAGIC
+ *   uint32 universe count, then for each universe:
+ *     uint32 universe id
+ *     uint16 DMX length, followed by the DMX data
+ *     uint16 port count, then for each port:
+ *       uint16 unique id length, followed by the unique id
+ *       uint16 UID count, followed by the packed UIDs
+ * All integers are big endian.
+ */
+bool UniverseStore::ParseState(const uint8_t *data, unsigned int size,
+                               UniverseStateMap *state) {
+  const unsigned int magic_size = sizeof(STATE_MAGIC) - 1;
+  if (size < magic_size || memcmp(data, STATE_MAGIC, magic_size)) {
+    return false;
+  }
+
+  ola::io::MemoryBuffer buffer(data + magic_size, size - magic_size);
+  ola::io::BigEndianInputStream stream(&buffer);
+
+  uint32_t universe_count;
+  if (!(stream >> universe_count)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < universe_count; i++) {
+    uint32_t universe_id;
+    uint16_t dmx_size, port_count;
+    string dmx;
+    if (!(stream >> universe_id) || !(stream >> dmx_size) ||
+        dmx_size > DMX_UNIVERSE_SIZE ||
+        stream.ReadString(&dmx, dmx_size) != dmx_size ||
+        !(stream >> port_count)) {
+      return false;
+    }
+
+    UniverseState &universe_state = (*state)[universe_id];
+    universe_state.dmx.Set(dmx);
+
+    for (uint16_t j = 0; j < port_count; j++) {
+      uint16_t id_size, uid_count;
+      string port_id;
+      if (!(stream >> id_size) ||
+          stream.ReadString(&port_id, id_size) != id_size ||
+          !(stream >> uid_count)) {
+        return false;
+      }
+
+      ola::rdm::UIDSet &uids = universe_state.port_uids[port_id];
+      for (uint16_t k = 0; k < uid_count; k++) {
+        string packed_uid;
+        if (stream.ReadString(&packed_uid, UID::LENGTH) != UID::LENGTH) {
+          return false;
+        }
+        uids.AddUID(UID(reinterpret_cast<const uint8_t*>(packed_uid.data())));
+      }
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Serialize the state in the format ParseState() expects.
+ */
+void UniverseStore::SerializeState(const UniverseStateMap &state,
+                                   string *output) {
+  ola::io::IOQueue queue;
+  ola::io::BigEndianOutputStream stream(&queue);
+  stream.Write(reinterpret_cast<const uint8_t*>(STATE_MAGIC),
+               sizeof(STATE_MAGIC) - 1);
+  stream << static_cast<uint32_t>(state.size());
+
+  UniverseStateMap::const_iterator iter = state.begin();
+  for (; iter != state.end(); ++iter) {
+    const DmxBuffer &dmx = iter->second.dmx;
+    stream << static_cast<uint32_t>(iter->first);
+    stream << static_cast<uint16_t>(dmx.Size());
+    stream.Write(dmx.GetRaw(), dmx.Size());
+    stream << static_cast<uint16_t>(iter->second.port_uids.size());
+
+    Universe::PortUIDMap::const_iterator port_iter =
+        iter->second.port_uids.begin();
+    for (; port_iter != iter->second.port_uids.end(); ++port_iter) {
+      const string &port_id = port_iter->first;
+      stream << static_cast<uint16_t>(port_id.size());
+      stream.Write(reinterpret_cast<const uint8_t*>(port_id.data()),
+                   port_id.size());
+      stream << static_cast<uint16_t>(port_iter->second.Size());
+
+      ola::rdm::UIDSet::Iterator uid_iter = port_iter->second.Begin();
+      for (; uid_iter != port_iter->second.End(); ++uid_iter) {
+        uint8_t packed_uid[UID::LENGTH];
+        uid_iter->Pack(packed_uid, sizeof(packed_uid));
+        stream.Write(packed_uid, sizeof(packed_uid));
+      }
+    }
+  }
+  queue.Read(output, queue.Size());
+}
+
 
 /*
  * Restore a universe's settings
@@ -159,6 +613,20 @@ bool UniverseStore::RestoreUniverseSettings(Universe *universe) const {
       universe->SetMergeMode(Universe::MERGE_LTP);
   }
 
+  // load the merge profile, as a list of the LTP slots
+  key = "uni_" + oss.str() + "_ltp_slots";
+  value = m_preferences->GetValue(key);
+
+  if (!value.empty()) {
+    vector<unsigned int> ltp_slots;
+    if (ParseSlotList(value, &ltp_slots)) {
+      universe->SetLTPSlots(ltp_slots);
+    } else {
+      OLA_WARN << "Invalid LTP slots for universe " <<
+        universe->UniverseId() << ", value was " << value;
+    }
+  }
+
   // load RDM discovery interval
   key = "uni_" + oss.str() + "_rdm_discovery_interval";
   value = m_preferences->GetValue(key);
@@ -181,21 +649,92 @@ bool UniverseStore::RestoreUniverseSettings(Universe *universe) const {
         universe->UniverseId() << ", value was " << value;
     }
   }
+
+  // load the output rate limit
+  key = "uni_" + oss.str() + "_max_output_rate";
+  value = m_preferences->GetValue(key);
+
+  if (!value.empty()) {
+    unsigned int rate;
+    if (StringToInt(value, &rate, true)) {
+      universe->SetMaxOutputRate(rate);
+    } else {
+      OLA_WARN << "Invalid max output rate for universe " <<
+        universe->UniverseId() << ", value was " << value;
+    }
+  }
+
+  // load the coalescing window, in ms
+  key = "uni_" + oss.str() + "_coalescing_window";
+  value = m_preferences->GetValue(key);
+
+  if (!value.empty()) {
+    unsigned int window;
+    if (StringToInt(value, &window, true)) {
+      universe->SetCoalescingWindow(
+          TimeInterval(static_cast<int64_t>(window) * ONE_THOUSAND));
+    } else {
+      OLA_WARN << "Invalid coalescing window for universe " <<
+        universe->UniverseId() << ", value was " << value;
+    }
+  }
+
+  if (m_frame_clock && UsesFrameClock(universe)) {
+    universe->SetFrameClock(m_frame_clock);
+  }
   return 0;
 }
 
 
+/*
+ * Check if a universe should send on the frame clock.
+ */
+bool UniverseStore::UsesFrameClock(const Universe *universe) const {
+  if (!m_preferences) {
+    return false;
+  }
+  std::ostringstream oss;
+  oss << "uni_" << std::dec << universe->UniverseId() << "_frame_clock";
+  return m_preferences->GetValueAsBool(oss.str());
+}
+
+
+void UniverseStore::SaveUniverseSettings(
+    const vector<Universe*> &universes) const {
+  if (!m_preferences) {
+    return;
+  }
+
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    WriteUniverseSettings(*iter);
+  }
+  m_preferences->Save();
+}
+
+
 /*
  * Save this universe's settings.
  * @param universe, the universe to save
  */
 bool UniverseStore::SaveUniverseSettings(Universe *universe) const {
-  string key, mode;
-  std::ostringstream oss;
-
   if (!universe || !m_preferences)
     return 0;
 
+  WriteUniverseSettings(universe);
+  m_preferences->Save();
+  return 0;
+}
+
+
+/*
+ * Set the preferences for this universe's settings, without saving them.
+ * @param universe, the universe to save
+ */
+void UniverseStore::WriteUniverseSettings(Universe *universe) const {
+  string key, mode;
+  std::ostringstream oss;
+
   oss << std::dec << universe->UniverseId();
 
   // save name
@@ -207,11 +746,17 @@ bool UniverseStore::SaveUniverseSettings(Universe *universe) const {
   mode = (universe->MergeMode() == Universe::MERGE_HTP ? "HTP" : "LTP");
   m_preferences->SetValue(key, mode);
 
-  // We don't save the RDM Discovery interval since it can only be set in the
-  // config files for now.
-
-  m_preferences->Save();
+  // save the merge profile
+  key = "uni_" + oss.str() + "_ltp_slots";
+  vector<unsigned int> ltp_slots;
+  universe->LTPSlots(&ltp_slots);
+  if (ltp_slots.empty()) {
+    m_preferences->RemoveValue(key);
+  } else {
+    m_preferences->SetValue(key, FormatSlotList(ltp_slots));
+  }
 
-  return 0;
+  // We don't save the RDM Discovery interval, the output rate or frame clock
+  // settings since they can only be set in the config files for now.
 }
 }  // namespace ola
@@ -21,16 +21,24 @@
 #ifndef OLAD_PLUGIN_API_UNIVERSESTORE_H_
 #define OLAD_PLUGIN_API_UNIVERSESTORE_H_
 
+#include <stdint.h>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/Universe.h"
 
 namespace ola {
 
+class DiscoveryScheduler;
+class FrameClock;
+class FrameHistory;
+class InputTrace;
 class Universe;
 
 /**
@@ -42,16 +50,56 @@ class UniverseStore {
    * @brief Create a new UniverseStore.
    * @param preferences The Preferences store.
    * @param export_map the ExportMap to use for stats, may be NULL.
+   * @param scheduler the scheduler used to rate limit universe output, may be
+   *   NULL.
+   * @param wake_up_time the time the scheduler's thread last woke up, used
+   *   by the universes to avoid reading the clock for every frame. May be
+   *   NULL.
    */
-  UniverseStore(class Preferences *preferences, class ExportMap *export_map);
+  UniverseStore(class Preferences *preferences, class ExportMap *export_map,
+                ola::thread::SchedulerInterface *scheduler = NULL,
+                const TimeStamp *wake_up_time = NULL);
 
   /**
    * @brief Destructor.
    */
   ~UniverseStore();
 
+  /**
+   * @brief Set the scheduler used to run RDM discovery.
+   * @param scheduler the DiscoveryScheduler to use for all universes, may be
+   *   NULL. Ownership is not transferred.
+   */
+  void SetDiscoveryScheduler(DiscoveryScheduler *scheduler);
+
+  /**
+   * @brief Set the clock used by the universes that send on a frame clock.
+   *
+   * Universes opt in with the uni_<id>_frame_clock = true preference.
+   * @param frame_clock the clock to use, may be NULL. Ownership is not
+   *   transferred.
+   */
+  void SetFrameClock(FrameClock *frame_clock);
+
+  /**
+   * @brief Set the history that all universes record their frames to.
+   * @param frame_history the history to use, may be NULL. Ownership is not
+   *   transferred.
+   */
+  void SetFrameHistory(FrameHistory *frame_history);
+
+  /**
+   * @brief Set the trace that all universes record their input to.
+   * @param input_trace the trace to use, may be NULL. Ownership is not
+   *   transferred.
+   */
+  void SetInputTrace(InputTrace *input_trace);
+
   /**
    * @brief Lookup a universe from its universe-id.
+   *
+   * This is called for every DMX update, so universe-ids below
+   * DIRECT_LOOKUP_LIMIT are found in constant time.
    * @param universe_id the universe-id of the universe.
    * @return the universe, or NULL if the universe doesn't exist.
    */
@@ -76,6 +124,45 @@ class UniverseStore {
    */
   void GetList(std::vector<Universe*> *universes) const;
 
+  /**
+   * @brief Get the universes which have source or sink clients.
+   * @param[out] universes a pointer to a vector of Universes.
+   */
+  void GetUniversesWithClients(std::vector<Universe*> *universes) const;
+
+  /**
+   * @brief Remove the stale source clients from all universes.
+   *
+   * Only the universes with clients are checked.
+   */
+  void CleanStaleSourceClients();
+
+  /**
+   * @brief Update the list of universes with clients.
+   *
+   * This is called by a Universe when its clients change, and increments the
+   * generation.
+   * @param universe the Universe which added or removed a client.
+   */
+  void UpdateClientList(Universe *universe);
+
+  /**
+   * @brief The generation of the universes.
+   *
+   * This is incremented when a universe is created or deleted, or a
+   * universe's settings, ports, clients, RDM devices or active priority
+   * change. It's used to tell if the state has changed without walking
+   * every universe. It isn't changed by DMX data.
+   */
+  uint32_t Generation() const { return m_generation; }
+
+  /**
+   * @brief Increment the generation.
+   *
+   * This is called by a Universe when its state changes.
+   */
+  void UniverseChanged() { m_generation++; }
+
   /**
    * @brief Delete all universes.
    */
@@ -83,6 +170,11 @@ class UniverseStore {
 
   /**
    * @brief Mark a universe as a candidate for garbage collection.
+   *
+   * Universes are created on demand, when a port is patched to them or a
+   * client uses them, and are candidates from the moment they are created.
+   * If there is a scheduler, the candidates are collected shortly after,
+   * rather than waiting for the next call to GarbageCollectUniverses().
    * @param universe the Universe which has no clients or ports bound.
    */
   void AddUniverseGarbageCollection(Universe *universe);
@@ -92,20 +184,94 @@ class UniverseStore {
    */
   void GarbageCollectUniverses();
 
+  /**
+   * @brief Save the name and merge mode of some universes.
+   *
+   * The preferences are written once, rather than once per universe.
+   * @param universes the universes to save.
+   */
+  void SaveUniverseSettings(const std::vector<Universe*> &universes) const;
+
+  /**
+   * @brief Load the state written by SaveState().
+   *
+   * Universes created after this start with the DMX data and RDM UIDs they
+   * had when the state was saved, see Universe::RestoreState().
+   * @param filename the file to load.
+   * @return true if the state was loaded, false if the file is missing or
+   *   invalid.
+   */
+  bool LoadState(const std::string &filename);
+
+  /**
+   * @brief Save the last DMX data and the RDM UIDs of each universe.
+   *
+   * The file is replaced atomically, and is only written if the state has
+   * changed since it was last saved.
+   * @param filename the file to write.
+   * @return true if the state was written or is unchanged, false otherwise.
+   */
+  bool SaveState(const std::string &filename);
+
  private:
   typedef std::map<unsigned int, Universe*> UniverseMap;
 
+  typedef struct {
+    DmxBuffer dmx;
+    Universe::PortUIDMap port_uids;
+  } UniverseState;
+
+  typedef std::map<unsigned int, UniverseState> UniverseStateMap;
+
+  // A page of the lookup table, this is empty until a universe in the page is
+  // created.
+  typedef std::vector<Universe*> LookupPage;
+
   Preferences *m_preferences;
   ExportMap *m_export_map;
+  ola::thread::SchedulerInterface *m_scheduler;
+  DiscoveryScheduler *m_discovery_scheduler;
+  FrameClock *m_frame_clock;
+  FrameHistory *m_frame_history;
+  InputTrace *m_input_trace;
   UniverseMap m_universe_map;
+  // Universes with ids below DIRECT_LOOKUP_LIMIT are also stored here,
+  // indexed by the upper bits of the id and then the lower bits.
+  std::vector<LookupPage> m_lookup_table;
+  Universe *m_universes_with_clients;  // the head of the list
+  ola::thread::timeout_id m_gc_timeout;
   std::set<Universe*> m_deletion_candidates;  // list of universes we may be
                                               // able to delete
   Clock m_clock;
+  const TimeStamp *m_wake_up_time;
+  // Loaded state for universes which haven't been created yet.
+  UniverseStateMap m_saved_state;
+  std::string m_last_state;  // the state as it was last saved
+  uint32_t m_generation;
 
   bool RestoreUniverseSettings(Universe *universe) const;
+  bool UsesFrameClock(const Universe *universe) const;
   bool SaveUniverseSettings(Universe *universe) const;
+  void WriteUniverseSettings(Universe *universe) const;
+  void SetLookup(unsigned int universe_id, Universe *universe);
+  void RemoveFromClientList(Universe *universe);
+  void GarbageCollectTimeout();
+
+  static bool ParseSlotList(const std::string &value,
+                            std::vector<unsigned int> *slots);
+  static std::string FormatSlotList(const std::vector<unsigned int> &slots);
+  static bool ParseState(const uint8_t *data, unsigned int size,
+                         UniverseStateMap *state);
+  static void SerializeState(const UniverseStateMap &state,
+                             std::string *output);
 
   static const unsigned int MINIMUM_RDM_DISCOVERY_INTERVAL;
+  static const unsigned int DIRECT_LOOKUP_LIMIT = 1 << 16;
+  // How long after a universe becomes unused it's deleted.
+  static const unsigned int GARBAGE_COLLECTION_DELAY_MS = 1000;
+  static const unsigned int LOOKUP_PAGE_BITS = 8;
+  static const unsigned int LOOKUP_PAGE_SIZE = 1 << LOOKUP_PAGE_BITS;
+  static const char STATE_MAGIC[];
 
   DISALLOW_COPY_AND_ASSIGN(UniverseStore);
 };
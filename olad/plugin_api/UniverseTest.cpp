@@ -27,10 +27,12 @@
 #include "ola/Constants.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMReply.h"
 #include "ola/rdm/RDMResponseCodes.h"
 #include "ola/rdm/UID.h"
+#include "ola/strings/Format.h"
 #include "olad/DmxSource.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
@@ -49,6 +51,7 @@ using ola::Clock;
 using ola::DmxBuffer;
 using ola::NewCallback;
 using ola::NewSingleCallback;
+using ola::TimeInterval;
 using ola::TimeStamp;
 using ola::Universe;
 using ola::rdm::NewDiscoveryUniqueBranchRequest;
@@ -72,12 +75,23 @@ class UniverseTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testSetGetDmx);
   CPPUNIT_TEST(testSendDmx);
   CPPUNIT_TEST(testReceiveDmx);
+  CPPUNIT_TEST(testDwellTime);
+  CPPUNIT_TEST(testUnchangedInput);
   CPPUNIT_TEST(testSourceClients);
   CPPUNIT_TEST(testSinkClients);
+  CPPUNIT_TEST(testFilteredSinkClients);
+  CPPUNIT_TEST(testUniversesWithClients);
+  CPPUNIT_TEST(testGeneration);
   CPPUNIT_TEST(testLtpMerging);
   CPPUNIT_TEST(testHtpMerging);
+  CPPUNIT_TEST(testIncrementalHtpMerging);
+  CPPUNIT_TEST(testMergeProfile);
+  CPPUNIT_TEST(testSlotPriorityMerging);
+  CPPUNIT_TEST(testStats);
+  CPPUNIT_TEST(testOutputScheduling);
   CPPUNIT_TEST(testRDMDiscovery);
   CPPUNIT_TEST(testRDMSend);
+  CPPUNIT_TEST(testRestoreState);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -87,12 +101,23 @@ class UniverseTest: public CppUnit::TestFixture {
   void testSetGetDmx();
   void testSendDmx();
   void testReceiveDmx();
+  void testDwellTime();
+  void testUnchangedInput();
   void testSourceClients();
   void testSinkClients();
+  void testFilteredSinkClients();
+  void testUniversesWithClients();
+  void testGeneration();
   void testLtpMerging();
   void testHtpMerging();
+  void testIncrementalHtpMerging();
+  void testMergeProfile();
+  void testSlotPriorityMerging();
+  void testStats();
+  void testOutputScheduling();
   void testRDMDiscovery();
   void testRDMSend();
+  void testRestoreState();
 
  private:
   ola::MemoryPreferences *m_preferences;
@@ -123,11 +148,10 @@ class MockClient: public ola::Client {
         m_dmx_set(false) {
   }
 
-  bool SendDMX(unsigned int universe_id, uint8_t priority,
-               const DmxBuffer &buffer) {
-    OLA_ASSERT_EQ(TEST_UNIVERSE, universe_id);
-    OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_MIN, priority);
-    OLA_ASSERT_EQ(string(TEST_DATA), buffer.Get());
+  bool SendDMX(const ola::DmxUpdate &update) {
+    OLA_ASSERT_EQ(TEST_UNIVERSE, update.Universe());
+    OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_MIN, update.Priority());
+    OLA_ASSERT_EQ(string(TEST_DATA), update.Buffer().Get());
     m_dmx_set = true;
     return true;
   }
@@ -135,6 +159,27 @@ class MockClient: public ola::Client {
 };
 
 
+/*
+ * A client that records the updates it's sent.
+ */
+class RecordingClient: public ola::Client {
+ public:
+  RecordingClient()
+      : ola::Client(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 0)),
+        m_updates(0) {
+  }
+
+  bool SendDMX(const ola::DmxUpdate &update) {
+    m_updates++;
+    m_last_update = update.Buffer();
+    return true;
+  }
+
+  unsigned int m_updates;
+  DmxBuffer m_last_update;
+};
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(UniverseTest);
 
 
@@ -171,6 +216,13 @@ void UniverseTest::testLifecycle() {
   OLA_ASSERT_EQ(universe_name, universe->Name());
   OLA_ASSERT_EQ(Universe::MERGE_HTP, universe->MergeMode());
 
+  vector<unsigned int> ltp_slots, slots;
+  ltp_slots.push_back(0);
+  ltp_slots.push_back(1);
+  ltp_slots.push_back(2);
+  ltp_slots.push_back(9);
+  universe->SetLTPSlots(ltp_slots);
+
   // delete it
   m_store->AddUniverseGarbageCollection(universe);
   m_store->GarbageCollectUniverses();
@@ -185,6 +237,30 @@ void UniverseTest::testLifecycle() {
   OLA_ASSERT_EQ(TEST_UNIVERSE, universe->UniverseId());
   OLA_ASSERT_EQ(universe_name, universe->Name());
   OLA_ASSERT_EQ(Universe::MERGE_HTP, universe->MergeMode());
+  universe->LTPSlots(&slots);
+  OLA_ASSERT_VECTOR_EQ(ltp_slots, slots);
+  OLA_ASSERT_EQ(string("1-3,10"), m_preferences->GetValue("uni_1_ltp_slots"));
+
+  m_store->DeleteAll();
+  OLA_ASSERT_EQ((unsigned int) 0, m_store->UniverseCount());
+
+  // a profile from the config file
+  m_preferences->SetValue("uni_1_ltp_slots", "5,1-2,,512");
+  universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe->HasMergeProfile());
+  universe->LTPSlots(&slots);
+  ltp_slots.clear();
+  ltp_slots.push_back(0);
+  ltp_slots.push_back(1);
+  ltp_slots.push_back(4);
+  ltp_slots.push_back(511);
+  OLA_ASSERT_VECTOR_EQ(ltp_slots, slots);
+
+  // and an invalid one
+  m_store->DeleteAll();
+  m_preferences->SetValue("uni_1_ltp_slots", "3-1");
+  universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_FALSE(universe->HasMergeProfile());
 
   m_store->DeleteAll();
   OLA_ASSERT_EQ((unsigned int) 0, m_store->UniverseCount());
@@ -271,6 +347,134 @@ void UniverseTest::testReceiveDmx() {
 }
 
 
+/*
+ * Check that the time input data waits before it's sent is recorded.
+ */
+void UniverseTest::testDwellTime() {
+  ola::ExportMap export_map;
+  ola::UniverseStore store(NULL, &export_map);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+
+  MockDevice device(NULL, "foo");
+  TestMockInputPort port(&device, 1, &plugin_adaptor);
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+
+  const string universe_str = ola::strings::IntToString(TEST_UNIVERSE);
+  ola::UIntMap *first_bucket = export_map.GetUIntMapVar(
+      Universe::K_DWELL_TIME_VARS[0]);
+  ola::UIntMap *last_bucket = export_map.GetUIntMapVar(
+      Universe::K_DWELL_TIME_VARS[Universe::K_DWELL_TIME_BUCKETS - 1]);
+  OLA_ASSERT_EQ(0u, (*first_bucket)[universe_str]);
+  OLA_ASSERT_EQ(0u, (*last_bucket)[universe_str]);
+
+  // data which arrived 50ms ago
+  TimeStamp received;
+  m_clock.CurrentMonotonicTime(&received);
+  received -= TimeInterval(0, 50000);
+  port.WriteDMX(m_buffer);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_EQ(1u, (*last_bucket)[universe_str]);
+
+  // a timestamp in the future counts as no time at all
+  m_clock.CurrentMonotonicTime(&received);
+  received += TimeInterval(1, 0);
+  m_buffer.SetChannel(0, 42);
+  port.WriteDMX(m_buffer);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_EQ(1u, (*first_bucket)[universe_str]);
+  OLA_ASSERT_EQ(1u, (*last_bucket)[universe_str]);
+
+  // SetDMX doesn't have an arrival time
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  unsigned int total = 0;
+  for (unsigned int i = 0; i < Universe::K_DWELL_TIME_BUCKETS; i++) {
+    total += (*export_map.GetUIntMapVar(
+        Universe::K_DWELL_TIME_VARS[i]))[universe_str];
+  }
+  OLA_ASSERT_EQ(2u, total);
+}
+
+
+/*
+ * Check that input frames which match the last one don't cause a merge.
+ */
+void UniverseTest::testUnchangedInput() {
+  ola::ExportMap export_map;
+  ola::UniverseStore store(NULL, &export_map);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, &export_map, NULL, NULL, NULL);
+
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "foo");
+  TestMockInputPort port(&device, 1, &plugin_adaptor);
+  TestMockInputPort port2(&device, 2, &plugin_adaptor);
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+
+  ola::ShardedCounterMap *frames = export_map.GetShardedCounterMapVar(
+      "input-port-frames", "port");
+  ola::ShardedCounterMap *unchanged = export_map.GetShardedCounterMapVar(
+      "input-port-unchanged-frames", "port");
+
+  TimeStamp received;
+  m_clock.CurrentMonotonicTime(&received);
+  port.WriteDMX(m_buffer);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_DMX_EQUALS(m_buffer, universe->GetDMX());
+
+  // The same frame again just refreshes the source, it's still counted as
+  // input.
+  received += TimeInterval(0, 25000);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_EQ(received, port.SourceData().Timestamp());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), universe->GetStats().input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2),
+                frames->Get(port.UniqueId())->Get());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                unchanged->Get(port.UniqueId())->Get());
+
+  // New data is merged
+  DmxBuffer buffer(m_buffer);
+  buffer.SetChannel(0, 42);
+  port.WriteDMX(buffer);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_DMX_EQUALS(buffer, universe->GetDMX());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                unchanged->Get(port.UniqueId())->Get());
+
+  // A frame that arrives after the source timed out isn't a refresh.
+  received += TimeInterval(3, 0);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                unchanged->Get(port.UniqueId())->Get());
+
+  // For LTP, re-sending the same data makes the port the latest source again
+  universe->SetMergeMode(Universe::MERGE_LTP);
+  port_manager.PatchPort(&port2, TEST_UNIVERSE);
+  received += TimeInterval(0, 25000);
+  port2.WriteDMX(m_buffer);
+  port2.DmxChangedAt(received);
+  OLA_ASSERT_DMX_EQUALS(m_buffer, universe->GetDMX());
+
+  received += TimeInterval(0, 25000);
+  port.DmxChangedAt(received);
+  OLA_ASSERT_DMX_EQUALS(buffer, universe->GetDMX());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2),
+                unchanged->Get(port.UniqueId())->Get());
+}
+
+
 /*
  * Check that we can add/remove source clients from this universes
  */
@@ -309,6 +513,144 @@ void UniverseTest::testSourceClients() {
   OLA_ASSERT_FALSE(universe->ContainsSourceClient(&client));
   OLA_ASSERT_FALSE(universe->ContainsSinkClient(&client));
   OLA_ASSERT_FALSE(universe->IsActive());
+
+  // a client added before it has sent data is merged once it does
+  universe->AddSourceClient(&client);
+  DmxBuffer client_data;
+  client_data.SetFromString("1,2,3,4");
+  TimeStamp time_stamp;
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  client.DMXReceived(TEST_UNIVERSE,
+                     ola::DmxSource(client_data, time_stamp,
+                                    ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  OLA_ASSERT(universe->SourceClientDataChanged(&client));
+  OLA_ASSERT_DMX_EQUALS(client_data, universe->GetDMX());
+
+  // and is removed once it stops sending data
+  universe->CleanStaleSourceClients();
+  OLA_ASSERT(universe->ContainsSourceClient(&client));
+  universe->CleanStaleSourceClients();
+  OLA_ASSERT_FALSE(universe->ContainsSourceClient(&client));
+  OLA_ASSERT_EQ((unsigned int) 0, universe->SourceClientCount());
+}
+
+
+/*
+ * Check the store's generation changes with the state of the universes, but
+ * not with the DMX data.
+ */
+void UniverseTest::testGeneration() {
+  uint32_t generation = m_store->Generation();
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_NE(generation, m_store->Generation());
+
+  generation = m_store->Generation();
+  universe->SetDMX(m_buffer);
+  OLA_ASSERT_EQ(generation, m_store->Generation());
+
+  universe->SetName("New Name");
+  OLA_ASSERT_NE(generation, m_store->Generation());
+  generation = m_store->Generation();
+  universe->SetMergeMode(Universe::MERGE_HTP);
+  OLA_ASSERT_NE(generation, m_store->Generation());
+  generation = m_store->Generation();
+  universe->SetMaxOutputRate(25);
+  OLA_ASSERT_NE(generation, m_store->Generation());
+
+  generation = m_store->Generation();
+  MockClient client;
+  universe->AddSourceClient(&client);
+  OLA_ASSERT_NE(generation, m_store->Generation());
+
+  // The first data from the client changes the active priority, more data at
+  // the same priority doesn't.
+  DmxBuffer client_data;
+  client_data.SetFromString("1,2,3,4");
+  TimeStamp time_stamp;
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  generation = m_store->Generation();
+  client.DMXReceived(TEST_UNIVERSE,
+                     ola::DmxSource(client_data, time_stamp,
+                                    ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  OLA_ASSERT(universe->SourceClientDataChanged(&client));
+  OLA_ASSERT_NE(generation, m_store->Generation());
+
+  generation = m_store->Generation();
+  client_data.SetFromString("5,6,7,8");
+  client.DMXReceived(TEST_UNIVERSE,
+                     ola::DmxSource(client_data, time_stamp,
+                                    ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  OLA_ASSERT(universe->SourceClientDataChanged(&client));
+  OLA_ASSERT_EQ(generation, m_store->Generation());
+
+  universe->RemoveSourceClient(&client);
+  OLA_ASSERT_NE(generation, m_store->Generation());
+
+  generation = m_store->Generation();
+  m_store->GarbageCollectUniverses();
+  OLA_ASSERT_EQ((unsigned int) 0, m_store->UniverseCount());
+  OLA_ASSERT_NE(generation, m_store->Generation());
+}
+
+
+/*
+ * Check the store tracks the universes with clients, and finds universes with
+ * large ids.
+ */
+void UniverseTest::testUniversesWithClients() {
+  const unsigned int large_universe_id = 0x12345678;
+  Universe *universe1 = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  Universe *universe2 = m_store->GetUniverseOrCreate(300);
+  Universe *universe3 = m_store->GetUniverseOrCreate(large_universe_id);
+  OLA_ASSERT_EQ(universe1, m_store->GetUniverse(TEST_UNIVERSE));
+  OLA_ASSERT_EQ(universe2, m_store->GetUniverse(300));
+  OLA_ASSERT_EQ(universe3, m_store->GetUniverse(large_universe_id));
+  OLA_ASSERT_EQ(universe3, m_store->GetUniverseOrCreate(large_universe_id));
+  OLA_ASSERT_NULL(m_store->GetUniverse(301));
+  OLA_ASSERT_EQ(3u, m_store->UniverseCount());
+
+  vector<Universe*> universes;
+  m_store->GetUniversesWithClients(&universes);
+  OLA_ASSERT_EMPTY(universes);
+
+  MockClient client1, client2;
+  universe1->AddSourceClient(&client1);
+  universe2->AddSinkClient(&client2);
+  universe3->AddSourceClient(&client2);
+  universe3->AddSinkClient(&client2);
+  m_store->GetUniversesWithClients(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), universes.size());
+
+  // A universe stays in the list until it has no clients.
+  universe3->RemoveSourceClient(&client2);
+  universes.clear();
+  m_store->GetUniversesWithClients(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), universes.size());
+
+  universe3->RemoveSinkClient(&client2);
+  universes.clear();
+  m_store->GetUniversesWithClients(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), universes.size());
+
+  // The first sweep marks the source client as stale, the second removes it.
+  m_store->CleanStaleSourceClients();
+  OLA_ASSERT_EQ(1u, universe1->SourceClientCount());
+  m_store->CleanStaleSourceClients();
+  OLA_ASSERT_EQ(0u, universe1->SourceClientCount());
+  universes.clear();
+  m_store->GetUniversesWithClients(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), universes.size());
+  OLA_ASSERT_EQ(universe2, universes[0]);
+
+  universe2->RemoveSinkClient(&client2);
+  m_store->GarbageCollectUniverses();
+  OLA_ASSERT_EQ(0u, m_store->UniverseCount());
+  OLA_ASSERT_NULL(m_store->GetUniverse(TEST_UNIVERSE));
+  OLA_ASSERT_NULL(m_store->GetUniverse(large_universe_id));
+  universes.clear();
+  m_store->GetUniversesWithClients(&universes);
+  OLA_ASSERT_EMPTY(universes);
 }
 
 
@@ -353,6 +695,87 @@ void UniverseTest::testSinkClients() {
 }
 
 
+/*
+ * Check that sink clients can limit the updates they receive.
+ */
+void UniverseTest::testFilteredSinkClients() {
+  MockScheduler scheduler;
+  ola::UniverseStore store(NULL, NULL, &scheduler);
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+
+  RecordingClient full_client, range_client, changes_client, rate_client;
+  Universe::SinkOptions options;
+  OLA_ASSERT_TRUE(options.IsDefault());
+  universe->AddSinkClient(&full_client, options);
+
+  options.slot_offset = 2;
+  options.slot_count = 2;
+  universe->AddSinkClient(&range_client, options);
+
+  options = Universe::SinkOptions();
+  options.slot_offset = 1;
+  options.changes_only = true;
+  universe->AddSinkClient(&changes_client, options);
+
+  options = Universe::SinkOptions();
+  options.max_rate = 1;
+  universe->AddSinkClient(&rate_client, options);
+  OLA_ASSERT_EQ(4u, universe->SinkClientCount());
+  // Drop the garbage collection of the new universe.
+  scheduler.RunTimeouts();
+
+  DmxBuffer buffer1, buffer2, expected;
+  buffer1.SetFromString("1,2,3,4,5");
+  buffer2.SetFromString("9,2,3,4,5");
+
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer1));
+  OLA_ASSERT_EQ(1u, full_client.m_updates);
+  OLA_ASSERT_EQ(buffer1, full_client.m_last_update);
+  OLA_ASSERT_EQ(1u, range_client.m_updates);
+  expected.SetFromString("3,4");
+  OLA_ASSERT_EQ(expected, range_client.m_last_update);
+  OLA_ASSERT_EQ(1u, changes_client.m_updates);
+  expected.SetFromString("2,3,4,5");
+  OLA_ASSERT_EQ(expected, changes_client.m_last_update);
+  OLA_ASSERT_EQ(1u, rate_client.m_updates);
+  OLA_ASSERT_EQ(0u, scheduler.PendingTimeouts());
+
+  // Slot 0 isn't selected by the changes only client, and the rate limited
+  // client is held back.
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer2));
+  OLA_ASSERT_EQ(2u, full_client.m_updates);
+  OLA_ASSERT_EQ(2u, range_client.m_updates);
+  OLA_ASSERT_EQ(1u, changes_client.m_updates);
+  OLA_ASSERT_EQ(1u, rate_client.m_updates);
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+
+  // Further frames are coalesced into the pending update.
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer1));
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer2));
+  OLA_ASSERT_EQ(1u, rate_client.m_updates);
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+  scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(2u, rate_client.m_updates);
+  OLA_ASSERT_EQ(buffer2, rate_client.m_last_update);
+
+  // Registering again replaces the options.
+  OLA_ASSERT_FALSE(universe->AddSinkClient(&range_client));
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer1));
+  OLA_ASSERT_EQ(buffer1, range_client.m_last_update);
+
+  // A pending update is cancelled when the client is removed.
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer2));
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+  OLA_ASSERT_TRUE(universe->RemoveSinkClient(&rate_client));
+  OLA_ASSERT_EQ(0u, scheduler.PendingTimeouts());
+  universe->RemoveSinkClient(&full_client);
+  universe->RemoveSinkClient(&range_client);
+  universe->RemoveSinkClient(&changes_client);
+  store.DeleteAll();
+}
+
+
 /*
  * Check that LTP merging works correctly
  */
@@ -521,6 +944,356 @@ void UniverseTest::testHtpMerging() {
 }
 
 
+/*
+ * Check that a merge profile LTP merges some slots and HTP merges the rest.
+ */
+void UniverseTest::testMergeProfile() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+  OLA_ASSERT_FALSE(universe->HasMergeProfile());
+
+  vector<unsigned int> ltp_slots, slots;
+  ltp_slots.push_back(1);
+  ltp_slots.push_back(2);
+  universe->SetLTPSlots(ltp_slots);
+  OLA_ASSERT(universe->HasMergeProfile());
+  universe->LTPSlots(&slots);
+  OLA_ASSERT_VECTOR_EQ(ltp_slots, slots);
+
+  DmxBuffer buffer1, buffer2, expected;
+  buffer1.SetFromString("100,10,200,50");
+  buffer2.SetFromString("50,20,0,60,70");
+  TimeStamp time_stamp;
+  m_clock.CurrentMonotonicTime(&time_stamp);
+
+  MockClient client1, client2;
+  client1.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(buffer1, time_stamp, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  universe->SourceClientDataChanged(&client1);
+  OLA_ASSERT_DMX_EQUALS(buffer1, universe->GetDMX());
+
+  // the second client is newer, so it wins the LTP slots
+  time_stamp += TimeInterval(0, 1000);
+  client2.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(buffer2, time_stamp, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  universe->SourceClientDataChanged(&client2);
+  expected.SetFromString("100,20,0,60,70");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+
+  // now the first client is newer
+  time_stamp += TimeInterval(0, 1000);
+  client1.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(buffer1, time_stamp, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  universe->SourceClientDataChanged(&client1);
+  expected.SetFromString("100,10,200,60,70");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+
+  // LTP slots past the end of the newest source are HTP merged
+  ltp_slots.push_back(4);
+  universe->SetLTPSlots(ltp_slots);
+  universe->Remerge();
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+
+  // removing the profile goes back to the merge mode
+  universe->SetLTPSlots(vector<unsigned int>());
+  OLA_ASSERT_FALSE(universe->HasMergeProfile());
+  universe->Remerge();
+  expected.SetFromString("100,20,200,60,70");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+
+  universe->RemoveSourceClient(&client1);
+  universe->RemoveSourceClient(&client2);
+}
+
+
+/*
+ * Check that sources with slot priorities are merged slot by slot.
+ */
+void UniverseTest::testSlotPriorityMerging() {
+  DmxBuffer port_buffer, client_buffer, slot_priorities, expected;
+  port_buffer.SetFromString("10,20,30,40");
+  client_buffer.SetFromString("50,60,70,80");
+  // Slot 0 isn't sourced by the client, slot 1 is at a higher priority than
+  // the port, slot 2 is at the same priority and slot 3 is lower.
+  slot_priorities.SetFromString("0,200,100,50");
+
+  ola::PortBroker broker;
+  ola::PortManager port_manager(m_store, &broker);
+
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  TestMockInputPort port(&device, 1, &plugin_adaptor);
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(port_buffer);
+  port.DmxChanged();
+  OLA_ASSERT_DMX_EQUALS(port_buffer, universe->GetDMX());
+  OLA_ASSERT_EQ(0u, universe->SlotPriorities().Size());
+
+  // The client's universe priority is lower than the port's, but it still
+  // wins the slots it has a higher priority for.
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  ola::DmxSource source(client_buffer, time_stamp, 50, slot_priorities);
+  MockClient input_client;
+  input_client.DMXReceived(TEST_UNIVERSE, source);
+  universe->SourceClientDataChanged(&input_client);
+
+  expected.SetFromString("10,60,70,40");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  expected.SetFromString("100,200,100,100");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->SlotPriorities());
+
+  // Once the client goes away the port has every slot again.
+  universe->RemoveSourceClient(&input_client);
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.DmxChanged();
+  OLA_ASSERT_DMX_EQUALS(port_buffer, universe->GetDMX());
+  OLA_ASSERT_EQ(0u, universe->SlotPriorities().Size());
+
+  universe->RemovePort(&port);
+  OLA_ASSERT_FALSE(universe->IsActive());
+}
+
+
+/*
+ * Check that partial updates to a HTP universe only re-merge what changed, and
+ * that we don't push unchanged data to the output ports.
+ */
+void UniverseTest::testIncrementalHtpMerging() {
+  DmxBuffer buffer1, buffer2, expected;
+  buffer1.SetFromString("1,0,0,10");
+  buffer2.SetFromString("0,255,0,5,6,7");
+
+  ola::PortBroker broker;
+  ola::PortManager port_manager(m_store, &broker);
+
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  MockDevice device2(NULL, "bar");
+  MockDevice device3(NULL, "baz");
+  TestMockInputPort port(&device, 1, &plugin_adaptor);  // input port
+  TestMockInputPort port2(&device2, 1, &plugin_adaptor);  // input port
+  TestMockOutputPort output_port(&device3, 1);
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  port_manager.PatchPort(&port2, TEST_UNIVERSE);
+  port_manager.PatchPort(&output_port, TEST_UNIVERSE);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  expected.SetFromString("1,255,0,10,6,7");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  OLA_ASSERT_DMX_EQUALS(expected, output_port.ReadDMX());
+  OLA_ASSERT_EQ(2u, output_port.WriteCount());
+
+  // change a single slot
+  buffer1.SetFromString("1,0,0,20");
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  expected.SetFromString("1,255,0,20,6,7");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  OLA_ASSERT_DMX_EQUALS(expected, output_port.ReadDMX());
+  OLA_ASSERT_EQ(3u, output_port.WriteCount());
+
+  // resending the same data shouldn't update the output port
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  OLA_ASSERT_EQ(3u, output_port.WriteCount());
+
+  // lower a slot, the merged value falls back to the other source
+  buffer1.SetFromString("0,0,0,20");
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  expected.SetFromString("0,255,0,20,6,7");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  OLA_ASSERT_DMX_EQUALS(expected, output_port.ReadDMX());
+  OLA_ASSERT_EQ(4u, output_port.WriteCount());
+
+  // a change that is masked by the other source doesn't alter the output
+  buffer1.SetFromString("0,100,0,20");
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  OLA_ASSERT_EQ(4u, output_port.WriteCount());
+
+  // changing the length requires a full merge
+  buffer1.SetFromString("0,100,0,20,0,0,9");
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  expected.SetFromString("0,255,0,20,6,7,9");
+  OLA_ASSERT_DMX_EQUALS(expected, universe->GetDMX());
+  OLA_ASSERT_DMX_EQUALS(expected, output_port.ReadDMX());
+  OLA_ASSERT_EQ(5u, output_port.WriteCount());
+
+  // clean up
+  universe->RemovePort(&port);
+  universe->RemovePort(&port2);
+  universe->RemovePort(&output_port);
+  OLA_ASSERT_FALSE(universe->IsActive());
+}
+
+
+/*
+ * Check the frame & slot counters.
+ */
+void UniverseTest::testStats() {
+  DmxBuffer buffer1, buffer2;
+  buffer1.SetFromString("1,0,0,10");
+  buffer2.SetFromString("0,255,0,5,6,7");
+
+  ola::PortBroker broker;
+  ola::PortManager port_manager(m_store, &broker);
+
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  MockDevice device2(NULL, "bar");
+  TestMockInputPort port(&device, 1, &plugin_adaptor);  // input port
+  TestMockInputPort port2(&device2, 1, &plugin_adaptor);  // input port
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  port_manager.PatchPort(&port2, TEST_UNIVERSE);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+
+  const Universe::Stats &stats = universe->GetStats();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats.output_frames);
+  OLA_ASSERT_FALSE(stats.last_input_time.IsSet());
+  OLA_ASSERT_FALSE(stats.last_output_time.IsSet());
+
+  // All the slots of the first frame are new.
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats.output_frames);
+  OLA_ASSERT_EQ(4u, stats.last_changed_slots);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), stats.changed_slots);
+  OLA_ASSERT_EQ(1u, stats.active_sources);
+  OLA_ASSERT_TRUE(stats.last_input_time.IsSet());
+  OLA_ASSERT_TRUE(stats.last_output_time.IsSet());
+
+  // The merge is 1,255,0,10,6,7 so one slot changes & two are added.
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.output_frames);
+  OLA_ASSERT_EQ(3u, stats.last_changed_slots);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(7), stats.changed_slots);
+  OLA_ASSERT_EQ(2u, stats.active_sources);
+
+  // The same data again doesn't produce a frame.
+  m_clock.CurrentMonotonicTime(&time_stamp);
+  port2.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), stats.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.output_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(7), stats.changed_slots);
+
+  // A frame set directly is counted as output, but not input.
+  DmxBuffer buffer3;
+  buffer3.SetFromString("1,255,0,10,6,8");
+  universe->SetDMX(buffer3);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), stats.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), stats.output_frames);
+  OLA_ASSERT_EQ(1u, stats.last_changed_slots);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(8), stats.changed_slots);
+}
+
+
+/**
+ * Check that the output rate limit & coalescing window batch up changes.
+ */
+void UniverseTest::testOutputScheduling() {
+  DmxBuffer buffer1, buffer2, buffer3;
+  buffer1.SetFromString("1,2,3");
+  buffer2.SetFromString("4,5,6");
+  buffer3.SetFromString("7,8,9");
+
+  MockScheduler scheduler;
+  ola::UniverseStore store(NULL, NULL, &scheduler);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+
+  MockDevice device(NULL, "foo");
+  TestMockOutputPort output_port(&device, 1);
+  port_manager.PatchPort(&output_port, TEST_UNIVERSE);
+
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+
+  // New universes are collected soon after they're created, this one is kept
+  // since a port is patched to it.
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+  scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(universe, store.GetUniverse(TEST_UNIVERSE));
+  OLA_ASSERT_EQ(0u, universe->MaxOutputRate());
+  OLA_ASSERT_TRUE(universe->CoalescingWindow().IsZero());
+
+  // with no limits, each frame is sent immediately
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer1));
+  OLA_ASSERT_EQ(1u, output_port.WriteCount());
+  OLA_ASSERT_EQ(0u, scheduler.PendingTimeouts());
+
+  // changes within the window are sent as a single frame
+  universe->SetCoalescingWindow(TimeInterval(0, 10000));
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer2));
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer3));
+  OLA_ASSERT_EQ(1u, output_port.WriteCount());
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+  scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(2u, output_port.WriteCount());
+  OLA_ASSERT_EQ(buffer3, output_port.ReadDMX());
+
+  // now use a rate limit, we just sent a frame so the next one is delayed
+  universe->SetCoalescingWindow(TimeInterval());
+  universe->SetMaxOutputRate(1);
+  OLA_ASSERT_EQ(1u, universe->MaxOutputRate());
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer1));
+  OLA_ASSERT_EQ(2u, output_port.WriteCount());
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+  scheduler.RunTimeouts();
+  OLA_ASSERT_EQ(3u, output_port.WriteCount());
+  OLA_ASSERT_EQ(buffer1, output_port.ReadDMX());
+
+  // a pending frame is cancelled if the universe is deleted
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer2));
+  OLA_ASSERT_EQ(1u, scheduler.PendingTimeouts());
+  port_manager.UnPatchPort(&output_port);
+  store.DeleteAll();
+  OLA_ASSERT_EQ(0u, scheduler.PendingTimeouts());
+}
+
+
 /**
  * Test RDM discovery for a universe/
  */
@@ -858,3 +1631,67 @@ void UniverseTest::ConfirmRDM(int line,
                     str.str());
   OLA_ASSERT_EQ_MSG(expected_response, reply->Response(), str.str());
 }
+
+
+/*
+ * Check the DMX data & UIDs are restored from a saved state.
+ */
+void UniverseTest::testRestoreState() {
+  const string state_file = TEST_BUILD_DIR "/olad/ola-state.bin";
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "test device");
+
+  UID uid1(0x7a70, 1);
+  UID uid2(0x7a70, 2);
+  UIDSet port_uids;
+  port_uids.AddUID(uid1);
+  port_uids.AddUID(uid2);
+  TestMockRDMOutputPort port(&device, 1, &port_uids);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+  universe->RunRDMDiscovery(NULL, true);
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(m_store->SaveState(state_file));
+  universe->RemovePort(&port);
+
+  // Load the state into a new store, as if olad had restarted.
+  ola::UniverseStore store(m_preferences, NULL);
+  OLA_ASSERT_FALSE(store.LoadState(TEST_BUILD_DIR "/olad/missing-state.bin"));
+  OLA_ASSERT(store.LoadState(state_file));
+  universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_DMX_EQUALS(m_buffer, universe->GetDMX());
+
+  Universe::PortUIDMap restored_uids;
+  universe->GetPortUIDs(&restored_uids);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), restored_uids.size());
+  OLA_ASSERT_EQ(port_uids, restored_uids[port.UniqueId()]);
+
+  // The restored data is sent to the port when it's added, and discovery
+  // runs to check the restored UIDs.
+  port_uids.RemoveUID(uid2);
+  TestMockRDMOutputPort restored_port(&device, 1, &port_uids);
+  universe->AddPort(&restored_port);
+  restored_port.SetUniverse(universe);
+  OLA_ASSERT_DMX_EQUALS(m_buffer, restored_port.ReadDMX());
+
+  UIDSet universe_uids;
+  universe->GetUIDs(&universe_uids);
+  OLA_ASSERT_EQ(port_uids, universe_uids);
+
+  // Once a source has sent data, the restored data isn't used.
+  DmxBuffer new_data;
+  new_data.SetFromString("1,2,3");
+  OLA_ASSERT(universe->SetDMX(new_data));
+  OLA_ASSERT_DMX_EQUALS(new_data, restored_port.ReadDMX());
+
+  TestMockOutputPort new_port(&device, 2);
+  universe->AddPort(&new_port);
+  OLA_ASSERT_EQ(0u, new_port.WriteCount());
+
+  universe->RemovePort(&restored_port);
+  universe->RemovePort(&new_port);
+}
@@ -0,0 +1,448 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * VirtualUniverseManager.cpp
+ * Builds universes from ranges of slots in other universes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "olad/plugin_api/VirtualUniverseManager.h"
+
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/dmx/TrackedDmxBuffer.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::thread::INVALID_TIMEOUT;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+bool MappingOrder(const VirtualUniverseManager::Mapping &a,
+                  const VirtualUniverseManager::Mapping &b) {
+  if (a.source_universe != b.source_universe) {
+    return a.source_universe < b.source_universe;
+  }
+  return a.source_offset < b.source_offset;
+}
+
+bool OffsetOrder(const VirtualUniverseManager::Mapping &a,
+                 const VirtualUniverseManager::Mapping &b) {
+  return a.offset < b.offset;
+}
+}  // namespace
+
+const unsigned int VirtualUniverseManager::REFRESH_INTERVAL_MS;
+
+/*
+ * The client the virtual universes use. It's a sink client of the source
+ * universes, and a source client of the virtual universes.
+ */
+class VirtualUniverseManager::VirtualUniverseClient: public Client {
+ public:
+  VirtualUniverseClient(VirtualUniverseManager *manager,
+                        const ola::rdm::UID &uid)
+      : Client(NULL, uid),
+        m_manager(manager) {
+  }
+
+  bool SendDMX(const DmxUpdate &update) {
+    m_manager->SourceChanged(update.Universe(), update.Buffer());
+    return true;
+  }
+
+ private:
+  VirtualUniverseManager *m_manager;
+};
+
+
+VirtualUniverseManager::VirtualUniverseManager(
+    UniverseStore *universe_store,
+    ola::thread::SchedulerInterface *scheduler,
+    Clock *clock,
+    const ola::rdm::UID &uid)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_clock(clock),
+      m_client(new VirtualUniverseClient(this, uid)),
+      m_refresh_timeout(INVALID_TIMEOUT) {
+}
+
+
+VirtualUniverseManager::~VirtualUniverseManager() {
+  if (m_refresh_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_refresh_timeout);
+  }
+  while (!m_outputs.empty()) {
+    RemoveOutput(m_outputs.begin()->first, false);
+  }
+}
+
+
+bool VirtualUniverseManager::Configure(
+    const vector<VirtualUniverse> &universes,
+    const vector<unsigned int> &removals,
+    string *error) {
+  if (!Validate(universes, removals, error)) {
+    return false;
+  }
+
+  vector<unsigned int>::const_iterator removal_iter = removals.begin();
+  for (; removal_iter != removals.end(); ++removal_iter) {
+    RemoveOutput(*removal_iter, true);
+  }
+
+  vector<VirtualUniverse>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    // The new mappings are sent straight away, so there's no need to
+    // remerge.
+    RemoveOutput(iter->universe, false);
+    AddOutput(*iter);
+  }
+
+  if (m_outputs.empty() && m_refresh_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_refresh_timeout);
+    m_refresh_timeout = INVALID_TIMEOUT;
+  } else if (!m_outputs.empty() && m_refresh_timeout == INVALID_TIMEOUT) {
+    m_refresh_timeout = m_scheduler->RegisterRepeatingTimeout(
+        REFRESH_INTERVAL_MS,
+        NewCallback(this, &VirtualUniverseManager::Refresh));
+  }
+  return true;
+}
+
+
+void VirtualUniverseManager::GetVirtualUniverses(
+    vector<VirtualUniverse> *universes) const {
+  OutputMap::const_iterator iter = m_outputs.begin();
+  for (; iter != m_outputs.end(); ++iter) {
+    universes->push_back(iter->second->config);
+  }
+}
+
+
+bool VirtualUniverseManager::IsVirtualUniverse(unsigned int universe) const {
+  return STLContains(m_outputs, universe);
+}
+
+
+/*
+ * Check a set of changes, using the virtual universes there would be once
+ * they're applied.
+ */
+bool VirtualUniverseManager::Validate(const vector<VirtualUniverse> &universes,
+                                      const vector<unsigned int> &removals,
+                                      string *error) const {
+  std::ostringstream str;
+  set<unsigned int> outputs;
+  set<unsigned int> sources;
+
+  vector<unsigned int>::const_iterator removal_iter = removals.begin();
+  for (; removal_iter != removals.end(); ++removal_iter) {
+    if (!STLContains(m_outputs, *removal_iter)) {
+      str << "Universe " << *removal_iter << " isn't a virtual universe";
+      *error = str.str();
+      return false;
+    }
+  }
+
+  vector<VirtualUniverse>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    if (!outputs.insert(iter->universe).second) {
+      str << "Virtual universe " << iter->universe << " is set more than once";
+      *error = str.str();
+      return false;
+    }
+    if (iter->priority > ola::dmx::SOURCE_PRIORITY_MAX) {
+      str << "Invalid priority for virtual universe " << iter->universe;
+      *error = str.str();
+      return false;
+    }
+    if (iter->mappings.empty()) {
+      str << "Virtual universe " << iter->universe << " has no mappings";
+      *error = str.str();
+      return false;
+    }
+
+    vector<Mapping> mappings(iter->mappings);
+    std::sort(mappings.begin(), mappings.end(), OffsetOrder);
+    unsigned int end = 0;
+    vector<Mapping>::const_iterator mapping = mappings.begin();
+    for (; mapping != mappings.end(); ++mapping) {
+      if (mapping->length == 0 ||
+          mapping->source_offset >= DMX_UNIVERSE_SIZE ||
+          mapping->length > DMX_UNIVERSE_SIZE - mapping->source_offset ||
+          mapping->offset >= DMX_UNIVERSE_SIZE ||
+          mapping->length > DMX_UNIVERSE_SIZE - mapping->offset) {
+        str << "Invalid slot range for virtual universe " << iter->universe;
+        *error = str.str();
+        return false;
+      }
+      if (mapping->offset < end) {
+        str << "Overlapping slot ranges in virtual universe "
+            << iter->universe;
+        *error = str.str();
+        return false;
+      }
+      end = mapping->offset + mapping->length;
+      sources.insert(mapping->source_universe);
+    }
+  }
+
+  // Add the virtual universes that aren't changed by this batch.
+  OutputMap::const_iterator output_iter = m_outputs.begin();
+  for (; output_iter != m_outputs.end(); ++output_iter) {
+    if (STLContains(outputs, output_iter->first) ||
+        std::find(removals.begin(), removals.end(), output_iter->first) !=
+        removals.end()) {
+      continue;
+    }
+    outputs.insert(output_iter->first);
+    map<unsigned int, SpanList>::const_iterator span_iter =
+        output_iter->second->spans.begin();
+    for (; span_iter != output_iter->second->spans.end(); ++span_iter) {
+      sources.insert(span_iter->first);
+    }
+  }
+
+  set<unsigned int>::const_iterator source_iter = sources.begin();
+  for (; source_iter != sources.end(); ++source_iter) {
+    if (STLContains(outputs, *source_iter)) {
+      str << "Virtual universe " << *source_iter
+          << " can't be used as a source";
+      *error = str.str();
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Remove a virtual universe.
+ * @param universe the virtual universe to remove
+ * @param remerge true if the universe should be merged again without the
+ *   virtual universe's data.
+ */
+void VirtualUniverseManager::RemoveOutput(unsigned int universe,
+                                          bool remerge) {
+  OutputMap::iterator iter = m_outputs.find(universe);
+  if (iter == m_outputs.end()) {
+    return;
+  }
+  OutputUniverse *output = iter->second;
+  m_outputs.erase(iter);
+
+  map<unsigned int, SpanList>::const_iterator span_iter =
+      output->spans.begin();
+  for (; span_iter != output->spans.end(); ++span_iter) {
+    SourceMap::iterator source_iter = m_sources.find(span_iter->first);
+    if (source_iter == m_sources.end()) {
+      continue;
+    }
+    vector<OutputUniverse*> &outputs = source_iter->second.outputs;
+    outputs.erase(std::remove(outputs.begin(), outputs.end(), output),
+                  outputs.end());
+    if (outputs.empty()) {
+      Universe *source = m_universe_store->GetUniverse(span_iter->first);
+      if (source) {
+        source->RemoveSinkClient(m_client.get());
+      }
+      m_sources.erase(source_iter);
+    }
+  }
+
+  Universe *target = m_universe_store->GetUniverse(universe);
+  if (target && target->RemoveSourceClient(m_client.get()) && remerge &&
+      target->IsActive()) {
+    target->Remerge();
+  }
+  delete output;
+}
+
+
+/*
+ * Set up a virtual universe and send the first frame.
+ */
+void VirtualUniverseManager::AddOutput(const VirtualUniverse &config) {
+  OutputUniverse *output = new OutputUniverse();
+  output->config = config;
+  Compile(output);
+  m_outputs[config.universe] = output;
+
+  map<unsigned int, SpanList>::const_iterator span_iter =
+      output->spans.begin();
+  for (; span_iter != output->spans.end(); ++span_iter) {
+    SourceUniverse &source = m_sources[span_iter->first];
+    if (source.outputs.empty()) {
+      Universe *universe = m_universe_store->GetUniverseOrCreate(
+          span_iter->first);
+      if (universe) {
+        universe->AddSinkClient(m_client.get());
+        source.data.Set(universe->GetDMX());
+      }
+    }
+    source.outputs.push_back(output);
+    CopySpans(span_iter->second, source.data.Buffer(), 0, DMX_UNIVERSE_SIZE,
+              output);
+  }
+  OLA_INFO << "Added virtual universe " << config.universe << " with "
+           << config.mappings.size() << " mappings";
+  Send(output);
+}
+
+
+/*
+ * Turn the mappings into the spans for each source universe. Mappings that
+ * are next to each other in both the source and virtual universe are joined.
+ */
+void VirtualUniverseManager::Compile(OutputUniverse *output) const {
+  vector<Mapping> mappings(output->config.mappings);
+  std::sort(mappings.begin(), mappings.end(), MappingOrder);
+
+  unsigned int size = 0;
+  vector<Mapping>::const_iterator iter = mappings.begin();
+  for (; iter != mappings.end(); ++iter) {
+    size = std::max(size, iter->offset + iter->length);
+    SpanList &spans = output->spans[iter->source_universe];
+    if (!spans.empty()) {
+      Span &last = spans.back();
+      if (last.source_offset + last.length == iter->source_offset &&
+          last.offset + last.length == iter->offset) {
+        last.length += iter->length;
+        continue;
+      }
+    }
+    Span span = {iter->source_offset, iter->offset, iter->length};
+    spans.push_back(span);
+  }
+
+  uint8_t blank[DMX_UNIVERSE_SIZE];
+  memset(blank, DMX_MIN_SLOT_VALUE, sizeof(blank));
+  output->buffer.Set(blank, size);
+}
+
+
+/*
+ * Called when the data in a source universe changes.
+ */
+void VirtualUniverseManager::SourceChanged(unsigned int universe,
+                                           const DmxBuffer &data) {
+  SourceMap::iterator iter = m_sources.find(universe);
+  if (iter == m_sources.end()) {
+    return;
+  }
+  SourceUniverse &source = iter->second;
+
+  const uint32_t generation = source.data.Generation();
+  source.data.Set(data);
+  const ola::dmx::SlotRange changed = source.data.ChangesSince(generation);
+  if (changed.Empty()) {
+    return;
+  }
+  const unsigned int first = changed.first;
+  const unsigned int last = changed.end;
+
+  vector<OutputUniverse*>::iterator output_iter = source.outputs.begin();
+  for (; output_iter != source.outputs.end(); ++output_iter) {
+    OutputUniverse *output = *output_iter;
+    const SpanList &spans = output->spans[universe];
+    if (spans.empty() ||
+        spans.front().source_offset >= last ||
+        spans.back().source_offset + spans.back().length <= first) {
+      continue;
+    }
+    CopySpans(spans, data, first, last, output);
+    Send(output);
+  }
+}
+
+
+/*
+ * Copy the part of each span between first and last. Slots past the end of
+ * the source data are set to 0.
+ */
+void VirtualUniverseManager::CopySpans(const SpanList &spans,
+                                       const DmxBuffer &data,
+                                       unsigned int first,
+                                       unsigned int last,
+                                       OutputUniverse *output) const {
+  SpanList::const_iterator iter = spans.begin();
+  for (; iter != spans.end(); ++iter) {
+    if (iter->source_offset >= last) {
+      break;
+    }
+    const unsigned int start = std::max(first, iter->source_offset);
+    const unsigned int end = std::min(last,
+                                      iter->source_offset + iter->length);
+    if (start >= end) {
+      continue;
+    }
+    const unsigned int offset = iter->offset + start - iter->source_offset;
+    const unsigned int available = data.Size() > start ?
+        std::min(end, data.Size()) - start : 0;
+    if (available) {
+      output->buffer.SetRange(offset, data.GetRaw() + start, available);
+    }
+    if (available < end - start) {
+      output->buffer.SetRangeToValue(offset + available, DMX_MIN_SLOT_VALUE,
+                                     end - start - available);
+    }
+  }
+}
+
+
+/*
+ * Send the data for a virtual universe.
+ */
+void VirtualUniverseManager::Send(OutputUniverse *output) {
+  TimeStamp now;
+  m_clock->CurrentMonotonicTime(&now);
+  const unsigned int universe_id = output->config.universe;
+  m_client->DMXReceived(
+      universe_id, DmxSource(output->buffer, now, output->config.priority));
+  Universe *universe = m_universe_store->GetUniverseOrCreate(universe_id);
+  if (universe) {
+    universe->SourceClientDataChanged(m_client.get());
+  }
+}
+
+
+bool VirtualUniverseManager::Refresh() {
+  OutputMap::iterator iter = m_outputs.begin();
+  for (; iter != m_outputs.end(); ++iter) {
+    Send(iter->second);
+  }
+  return true;
+}
+}  // namespace ola
@@ -0,0 +1,166 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * VirtualUniverseManager.h
+ * Builds universes from ranges of slots in other universes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef OLAD_PLUGIN_API_VIRTUALUNIVERSEMANAGER_H_
+#define OLAD_PLUGIN_API_VIRTUALUNIVERSEMANAGER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/dmx/TrackedDmxBuffer.h"
+#include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+/**
+ * @brief Builds virtual universes from ranges of slots in other universes.
+ *
+ * Each virtual universe is a list of mappings, which copy a range of slots
+ * from a source universe. The mappings are compiled into a list of spans for
+ * each source universe, with adjacent spans joined, so a change to a source
+ * universe only copies the spans that overlap the slots that changed.
+ *
+ * The virtual universe is merged into the universe with the same id as a
+ * source, at the priority of the virtual universe, so it can be patched to
+ * output ports like any other universe. A virtual universe can't be used as
+ * the source of another virtual universe.
+ *
+ * Sources time out if they don't send data, so the virtual universes are
+ * resent every REFRESH_INTERVAL_MS while any exist.
+ */
+class VirtualUniverseManager {
+ public:
+  /**
+   * @brief A range of slots copied from a source universe.
+   */
+  typedef struct {
+    unsigned int source_universe;
+    unsigned int source_offset;
+    unsigned int offset;  // the first slot in the virtual universe
+    unsigned int length;
+  } Mapping;
+
+  /**
+   * @brief The configuration of a virtual universe.
+   */
+  typedef struct {
+    unsigned int universe;
+    uint8_t priority;
+    std::vector<Mapping> mappings;
+  } VirtualUniverse;
+
+  /**
+   * @brief Create a new VirtualUniverseManager.
+   * @param universe_store the UniverseStore to find the universes in.
+   * @param scheduler the scheduler used to refresh the virtual universes.
+   * @param clock the clock used to timestamp the data.
+   * @param uid the UID of the client that the virtual universes send from.
+   */
+  VirtualUniverseManager(class UniverseStore *universe_store,
+                         ola::thread::SchedulerInterface *scheduler,
+                         Clock *clock,
+                         const ola::rdm::UID &uid);
+  ~VirtualUniverseManager();
+
+  /**
+   * @brief Set up and remove virtual universes.
+   * @param universes the virtual universes to set up. The mappings of an
+   *   existing virtual universe are replaced.
+   * @param removals the virtual universes to remove.
+   * @param[out] error set to the reason if the changes were rejected.
+   * @returns true if the changes were applied, false if any of them were
+   *   invalid, in which case none are applied.
+   */
+  bool Configure(const std::vector<VirtualUniverse> &universes,
+                 const std::vector<unsigned int> &removals,
+                 std::string *error);
+
+  /**
+   * @brief Get the configuration of the virtual universes.
+   */
+  void GetVirtualUniverses(std::vector<VirtualUniverse> *universes) const;
+
+  /**
+   * @brief Returns true if the universe is a virtual universe.
+   */
+  bool IsVirtualUniverse(unsigned int universe) const;
+
+  static const unsigned int REFRESH_INTERVAL_MS = 1000;
+
+ private:
+  class VirtualUniverseClient;
+
+  // A compiled mapping, the slots of one source universe to copy.
+  typedef struct {
+    unsigned int source_offset;
+    unsigned int offset;
+    unsigned int length;
+  } Span;
+
+  typedef std::vector<Span> SpanList;
+
+  typedef struct {
+    VirtualUniverse config;
+    DmxBuffer buffer;
+    // The spans for each source universe, ordered by source_offset.
+    std::map<unsigned int, SpanList> spans;
+  } OutputUniverse;
+
+  typedef struct {
+    // The data when this source universe was last seen.
+    ola::dmx::TrackedDmxBuffer data;
+    std::vector<OutputUniverse*> outputs;
+  } SourceUniverse;
+
+  typedef std::map<unsigned int, OutputUniverse*> OutputMap;
+  typedef std::map<unsigned int, SourceUniverse> SourceMap;
+
+  class UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  Clock *m_clock;
+  std::auto_ptr<VirtualUniverseClient> m_client;
+  OutputMap m_outputs;
+  SourceMap m_sources;
+  ola::thread::timeout_id m_refresh_timeout;
+
+  bool Validate(const std::vector<VirtualUniverse> &universes,
+                const std::vector<unsigned int> &removals,
+                std::string *error) const;
+  void RemoveOutput(unsigned int universe, bool remerge);
+  void AddOutput(const VirtualUniverse &config);
+  void Compile(OutputUniverse *output) const;
+  void SourceChanged(unsigned int universe, const DmxBuffer &data);
+  void CopySpans(const SpanList &spans, const DmxBuffer &data,
+                 unsigned int first, unsigned int last,
+                 OutputUniverse *output) const;
+  void Send(OutputUniverse *output);
+  bool Refresh();
+
+  DISALLOW_COPY_AND_ASSIGN(VirtualUniverseManager);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_VIRTUALUNIVERSEMANAGER_H_
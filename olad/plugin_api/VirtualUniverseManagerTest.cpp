@@ -0,0 +1,316 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * VirtualUniverseManagerTest.cpp
+ * Test fixture for the VirtualUniverseManager class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/rdm/UID.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/Port.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "olad/plugin_api/VirtualUniverseManager.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeStamp;
+using ola::Universe;
+using ola::VirtualUniverseManager;
+using ola::rdm::UID;
+using std::string;
+using std::vector;
+
+class VirtualUniverseManagerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(VirtualUniverseManagerTest);
+  CPPUNIT_TEST(testMappings);
+  CPPUNIT_TEST(testValidation);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  VirtualUniverseManagerTest()
+      : m_ss(&m_wake_up),
+        m_plugin_adaptor(NULL, &m_ss, NULL, NULL, NULL, NULL),
+        m_device(NULL, "foo"),
+        m_input1(&m_device, 1, &m_plugin_adaptor),
+        m_input2(&m_device, 2, &m_plugin_adaptor),
+        m_output(&m_device, 3) {
+  }
+
+  void setUp();
+  void tearDown();
+  void testMappings();
+  void testValidation();
+  void testRemove();
+
+ private:
+  TimeStamp m_wake_up;
+  MockSelectServer m_ss;
+  ola::PluginAdaptor m_plugin_adaptor;
+  MockDeviceLoopAndMulti m_device;
+  TestMockInputPort m_input1;
+  TestMockInputPort m_input2;
+  TestMockOutputPort m_output;
+  Clock m_clock;
+  ola::MemoryPreferences *m_preferences;
+  ola::UniverseStore *m_store;
+  ola::PortBroker *m_broker;
+  ola::PortManager *m_port_manager;
+  VirtualUniverseManager *m_manager;
+
+  void SendFrom(TestMockInputPort *port, const string &data);
+  static VirtualUniverseManager::VirtualUniverse NewVirtualUniverse(
+      unsigned int universe);
+  static void AddMapping(VirtualUniverseManager::VirtualUniverse *universe,
+                         unsigned int source_universe,
+                         unsigned int source_offset,
+                         unsigned int offset,
+                         unsigned int length);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VirtualUniverseManagerTest);
+
+static const unsigned int SOURCE_UNIVERSE1 = 1;
+static const unsigned int SOURCE_UNIVERSE2 = 2;
+static const unsigned int VIRTUAL_UNIVERSE = 10;
+
+
+void VirtualUniverseManagerTest::setUp() {
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_broker = new ola::PortBroker();
+  m_port_manager = new ola::PortManager(m_store, m_broker);
+  m_manager = new VirtualUniverseManager(
+      m_store, &m_ss, &m_clock, UID(ola::OPEN_LIGHTING_ESTA_CODE, 0));
+
+  m_port_manager->PatchPort(&m_input1, SOURCE_UNIVERSE1);
+  m_port_manager->PatchPort(&m_input2, SOURCE_UNIVERSE2);
+  m_port_manager->PatchPort(&m_output, VIRTUAL_UNIVERSE);
+}
+
+
+void VirtualUniverseManagerTest::tearDown() {
+  delete m_manager;
+  m_port_manager->UnPatchPort(&m_input1);
+  m_port_manager->UnPatchPort(&m_input2);
+  m_port_manager->UnPatchPort(&m_output);
+  delete m_port_manager;
+  delete m_broker;
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Send data from one of the input ports.
+ */
+void VirtualUniverseManagerTest::SendFrom(TestMockInputPort *port,
+                                          const string &data) {
+  DmxBuffer buffer;
+  buffer.SetFromString(data);
+  m_clock.CurrentMonotonicTime(&m_wake_up);
+  port->WriteDMX(buffer);
+  port->DmxChanged();
+}
+
+
+VirtualUniverseManager::VirtualUniverse
+    VirtualUniverseManagerTest::NewVirtualUniverse(unsigned int universe) {
+  VirtualUniverseManager::VirtualUniverse virtual_universe;
+  virtual_universe.universe = universe;
+  virtual_universe.priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  return virtual_universe;
+}
+
+
+void VirtualUniverseManagerTest::AddMapping(
+    VirtualUniverseManager::VirtualUniverse *universe,
+    unsigned int source_universe,
+    unsigned int source_offset,
+    unsigned int offset,
+    unsigned int length) {
+  VirtualUniverseManager::Mapping mapping = {
+    source_universe, source_offset, offset, length};
+  universe->mappings.push_back(mapping);
+}
+
+
+/*
+ * Check the slots are copied, and only changes to the mapped slots are sent.
+ */
+void VirtualUniverseManagerTest::testMappings() {
+  SendFrom(&m_input1, "1,2,3,4,5,6");
+
+  VirtualUniverseManager::VirtualUniverse universe =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE);
+  // These two are joined into one span.
+  AddMapping(&universe, SOURCE_UNIVERSE1, 0, 0, 2);
+  AddMapping(&universe, SOURCE_UNIVERSE1, 2, 2, 2);
+  AddMapping(&universe, SOURCE_UNIVERSE2, 4, 4, 2);
+  vector<VirtualUniverseManager::VirtualUniverse> universes;
+  universes.push_back(universe);
+  string error;
+  OLA_ASSERT_TRUE(m_manager->Configure(universes, vector<unsigned int>(),
+                                       &error));
+  OLA_ASSERT_TRUE(m_manager->IsVirtualUniverse(VIRTUAL_UNIVERSE));
+  OLA_ASSERT_FALSE(m_manager->IsVirtualUniverse(SOURCE_UNIVERSE1));
+
+  // Universe 2 doesn't have any data yet.
+  DmxBuffer expected;
+  expected.SetFromString("1,2,3,4,0,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  SendFrom(&m_input2, "10,20,30,40,50,60,70");
+  expected.SetFromString("1,2,3,4,50,60");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  unsigned int writes = m_output.WriteCount();
+
+  // Slots that aren't mapped don't cause a write.
+  SendFrom(&m_input2, "11,21,31,41,50,60,71");
+  OLA_ASSERT_EQ(writes, m_output.WriteCount());
+  SendFrom(&m_input1, "1,2,3,4,7,8");
+  OLA_ASSERT_EQ(writes, m_output.WriteCount());
+
+  SendFrom(&m_input1, "1,9,3,4,7,8");
+  expected.SetFromString("1,9,3,4,50,60");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+  OLA_ASSERT_EQ(writes + 1, m_output.WriteCount());
+
+  // Slots that are no longer sent are set to 0.
+  SendFrom(&m_input2, "10,20,30,40,50");
+  expected.SetFromString("1,9,3,4,50,0");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  vector<VirtualUniverseManager::VirtualUniverse> configured;
+  m_manager->GetVirtualUniverses(&configured);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), configured.size());
+  OLA_ASSERT_EQ(VIRTUAL_UNIVERSE, configured[0].universe);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), configured[0].mappings.size());
+}
+
+
+/*
+ * Check that invalid changes are rejected, and none of a batch is applied.
+ */
+void VirtualUniverseManagerTest::testValidation() {
+  vector<unsigned int> no_removals;
+  string error;
+
+  VirtualUniverseManager::VirtualUniverse valid =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE);
+  AddMapping(&valid, SOURCE_UNIVERSE1, 0, 0, 10);
+
+  // Overlapping slots in the virtual universe.
+  VirtualUniverseManager::VirtualUniverse overlapping =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE + 1);
+  AddMapping(&overlapping, SOURCE_UNIVERSE1, 0, 0, 10);
+  AddMapping(&overlapping, SOURCE_UNIVERSE2, 0, 9, 10);
+  vector<VirtualUniverseManager::VirtualUniverse> universes;
+  universes.push_back(valid);
+  universes.push_back(overlapping);
+  OLA_ASSERT_FALSE(m_manager->Configure(universes, no_removals, &error));
+  OLA_ASSERT_FALSE(error.empty());
+  OLA_ASSERT_FALSE(m_manager->IsVirtualUniverse(VIRTUAL_UNIVERSE));
+
+  // Past the end of the universe.
+  VirtualUniverseManager::VirtualUniverse too_long =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE + 1);
+  AddMapping(&too_long, SOURCE_UNIVERSE1, 500, 0, ola::DMX_UNIVERSE_SIZE);
+  universes.clear();
+  universes.push_back(too_long);
+  OLA_ASSERT_FALSE(m_manager->Configure(universes, no_removals, &error));
+
+  // A virtual universe can't be a source.
+  VirtualUniverseManager::VirtualUniverse chained =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE + 1);
+  AddMapping(&chained, VIRTUAL_UNIVERSE, 0, 0, 10);
+  universes.clear();
+  universes.push_back(valid);
+  universes.push_back(chained);
+  OLA_ASSERT_FALSE(m_manager->Configure(universes, no_removals, &error));
+
+  // Or its own source.
+  VirtualUniverseManager::VirtualUniverse loop =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE);
+  AddMapping(&loop, VIRTUAL_UNIVERSE, 0, 0, 10);
+  universes.clear();
+  universes.push_back(loop);
+  OLA_ASSERT_FALSE(m_manager->Configure(universes, no_removals, &error));
+
+  // Removing a universe that isn't virtual.
+  vector<unsigned int> removals;
+  removals.push_back(SOURCE_UNIVERSE1);
+  universes.clear();
+  universes.push_back(valid);
+  OLA_ASSERT_FALSE(m_manager->Configure(universes, removals, &error));
+  OLA_ASSERT_FALSE(m_manager->IsVirtualUniverse(VIRTUAL_UNIVERSE));
+
+  OLA_ASSERT_TRUE(m_manager->Configure(universes, no_removals, &error));
+  OLA_ASSERT_TRUE(m_manager->IsVirtualUniverse(VIRTUAL_UNIVERSE));
+}
+
+
+/*
+ * Check that removing a virtual universe removes the clients.
+ */
+void VirtualUniverseManagerTest::testRemove() {
+  SendFrom(&m_input1, "1,2,3,4");
+
+  VirtualUniverseManager::VirtualUniverse universe =
+      NewVirtualUniverse(VIRTUAL_UNIVERSE);
+  AddMapping(&universe, SOURCE_UNIVERSE1, 0, 2, 4);
+  vector<VirtualUniverseManager::VirtualUniverse> universes;
+  universes.push_back(universe);
+  string error;
+  OLA_ASSERT_TRUE(m_manager->Configure(universes, vector<unsigned int>(),
+                                       &error));
+
+  Universe *source = m_store->GetUniverse(SOURCE_UNIVERSE1);
+  Universe *output = m_store->GetUniverse(VIRTUAL_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(source);
+  OLA_ASSERT_NOT_NULL(output);
+  OLA_ASSERT_EQ(1u, source->SinkClientCount());
+  OLA_ASSERT_EQ(1u, output->SourceClientCount());
+  DmxBuffer expected;
+  expected.SetFromString("0,0,1,2,3,4");
+  OLA_ASSERT_DMX_EQUALS(expected, m_output.ReadDMX());
+
+  vector<unsigned int> removals;
+  removals.push_back(VIRTUAL_UNIVERSE);
+  OLA_ASSERT_TRUE(m_manager->Configure(
+      vector<VirtualUniverseManager::VirtualUniverse>(), removals, &error));
+  OLA_ASSERT_FALSE(m_manager->IsVirtualUniverse(VIRTUAL_UNIVERSE));
+  OLA_ASSERT_EQ(0u, source->SinkClientCount());
+  OLA_ASSERT_EQ(0u, output->SourceClientCount());
+
+  // Changes to the source no longer reach the output.
+  unsigned int writes = m_output.WriteCount();
+  SendFrom(&m_input1, "5,6,7,8");
+  OLA_ASSERT_EQ(writes, m_output.WriteCount());
+}
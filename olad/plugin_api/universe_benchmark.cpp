@@ -0,0 +1,593 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * universe_benchmark.cpp
+ * Measure the merge and output paths of the Universe class.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/rdm/UID.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::DmxSource;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using std::cout;
+using std::endl;
+using std::map;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(iterations, i, 200000,
+                "The number of operations to run for each benchmark");
+DEFINE_string(sources, "1,2,8,32",
+              "A comma separated list of the number of sources to merge, "
+              "and the number of dependants to send to");
+DEFINE_string(benchmarks, "",
+              "A comma separated list of the benchmarks to run, defaults to "
+              "all of them");
+DEFINE_string(baseline, "",
+              "Compare the results with the ones in this file, and exit with "
+              "an error if any benchmark is slower or allocates more");
+DEFINE_default_bool(write_baseline, false,
+                    "Write the results to the --baseline file rather than "
+                    "comparing");
+DEFINE_uint32(tolerance, 10,
+              "The percentage a benchmark can slow down by before it's "
+              "reported as a regression");
+
+#if __cplusplus >= 201103L
+#define BENCHMARK_THROW_BAD_ALLOC
+#define BENCHMARK_NO_THROW noexcept
+#else
+#define BENCHMARK_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCHMARK_NO_THROW throw()
+#endif  // __cplusplus
+
+/*
+ * Every allocation the process makes is counted, so the allocations made by
+ * each operation can be reported.
+ */
+static uint64_t allocation_count = 0;
+
+void *operator new(size_t size) BENCHMARK_THROW_BAD_ALLOC {
+  allocation_count++;
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) BENCHMARK_THROW_BAD_ALLOC {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) BENCHMARK_NO_THROW {
+  free(ptr);
+}
+
+void operator delete[](void *ptr) BENCHMARK_NO_THROW {
+  free(ptr);
+}
+
+
+static const unsigned int UNIVERSE_ID = 1;
+static const uint8_t HIGH_PRIORITY = 120;
+
+
+/**
+ * A client that drops the DMX data it's sent.
+ */
+class BenchmarkClient: public ola::Client {
+ public:
+  BenchmarkClient()
+      : ola::Client(NULL, ola::rdm::UID(ola::OPEN_LIGHTING_ESTA_CODE, 0)),
+        m_frames(0) {
+  }
+
+  bool SendDMX(const ola::DmxUpdate&) {
+    m_frames++;
+    return true;
+  }
+
+  uint64_t Frames() const { return m_frames; }
+
+ private:
+  uint64_t m_frames;
+};
+
+
+/**
+ * Build two frames for a source, which differ in every slot. Each source has
+ * its own levels so the HTP merge has work to do.
+ */
+void BuildFrames(unsigned int source, DmxBuffer *even, DmxBuffer *odd) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    data[i] = (i + source * 7) & 0xff;
+  }
+  even->Set(data, sizeof(data));
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    data[i] = ~data[i];
+  }
+  odd->Set(data, sizeof(data));
+}
+
+
+/**
+ * The objects needed by a universe with ports.
+ */
+class UniverseFixture {
+ public:
+  UniverseFixture()
+      : m_preferences("benchmark"),
+        m_store(&m_preferences, NULL),
+        m_port_manager(&m_store, &m_broker),
+        m_ss(&m_wake_up_time),
+        m_plugin_adaptor(NULL, &m_ss, NULL, NULL, NULL, NULL),
+        m_plugin(NULL, ola::OLA_PLUGIN_DUMMY),
+        m_device(&m_plugin, "benchmark") {
+    // The same time is used for every frame, so no source goes stale.
+    Clock clock;
+    clock.CurrentMonotonicTime(&m_wake_up_time);
+    m_universe = m_store.GetUniverseOrCreate(UNIVERSE_ID);
+    m_universe->SetWakeUpTime(&m_wake_up_time);
+  }
+
+  ~UniverseFixture() {
+    vector<TestMockInputPort*>::iterator input_iter = m_input_ports.begin();
+    for (; input_iter != m_input_ports.end(); ++input_iter) {
+      m_port_manager.UnPatchPort(*input_iter);
+    }
+    vector<TestMockOutputPort*>::iterator output_iter = m_output_ports.begin();
+    for (; output_iter != m_output_ports.end(); ++output_iter) {
+      m_port_manager.UnPatchPort(*output_iter);
+    }
+    vector<BenchmarkClient*>::iterator client_iter = m_clients.begin();
+    for (; client_iter != m_clients.end(); ++client_iter) {
+      m_universe->RemoveSourceClient(*client_iter);
+      m_universe->RemoveSinkClient(*client_iter);
+    }
+    ola::STLDeleteElements(&m_input_ports);
+    ola::STLDeleteElements(&m_output_ports);
+    ola::STLDeleteElements(&m_clients);
+  }
+
+  Universe *GetUniverse() { return m_universe; }
+  const TimeStamp &WakeUpTime() const { return m_wake_up_time; }
+
+  TestMockInputPort *AddInputPort(uint8_t priority) {
+    TestMockInputPort *port = new TestMockInputPort(
+        &m_device, m_input_ports.size(), &m_plugin_adaptor);
+    port->SetPriority(priority);
+    m_port_manager.PatchPort(port, UNIVERSE_ID);
+    m_input_ports.push_back(port);
+    return port;
+  }
+
+  void AddOutputPort() {
+    TestMockOutputPort *port = new TestMockOutputPort(
+        &m_device, m_output_ports.size());
+    m_port_manager.PatchPort(port, UNIVERSE_ID);
+    m_output_ports.push_back(port);
+  }
+
+  BenchmarkClient *AddClient() {
+    BenchmarkClient *client = new BenchmarkClient();
+    m_clients.push_back(client);
+    return client;
+  }
+
+ private:
+  ola::MemoryPreferences m_preferences;
+  ola::UniverseStore m_store;
+  ola::PortBroker m_broker;
+  ola::PortManager m_port_manager;
+  TimeStamp m_wake_up_time;
+  MockSelectServer m_ss;
+  ola::PluginAdaptor m_plugin_adaptor;
+  TestMockPlugin m_plugin;
+  MockDeviceLoopAndMulti m_device;
+  Universe *m_universe;
+  vector<TestMockInputPort*> m_input_ports;
+  vector<TestMockOutputPort*> m_output_ports;
+  vector<BenchmarkClient*> m_clients;
+};
+
+
+/**
+ * The base class for the benchmarks. Each benchmark sets up a universe, then
+ * runs the operation under test a number of times.
+ */
+class UniverseBenchmark {
+ public:
+  virtual ~UniverseBenchmark() {}
+
+  virtual string Name() const = 0;
+  virtual void Setup(unsigned int count) = 0;
+  virtual void Run(uint64_t operations) = 0;
+};
+
+
+/**
+ * Merge data from source clients, with Universe::SourceClientDataChanged().
+ *
+ * The sources take turns to send a new frame. In priority mode half the
+ * sources have a higher priority, so the other half are ignored.
+ */
+class ClientMergeBenchmark: public UniverseBenchmark {
+ public:
+  ClientMergeBenchmark(Universe::merge_mode mode, bool mixed_priorities)
+      : m_mode(mode),
+        m_mixed_priorities(mixed_priorities) {
+  }
+
+  string Name() const {
+    return string("client-") + ModeName(m_mode, m_mixed_priorities);
+  }
+
+  void Setup(unsigned int count) {
+    m_fixture.reset(new UniverseFixture());
+    m_fixture->GetUniverse()->SetMergeMode(m_mode);
+    m_fixture->GetUniverse()->AddSinkClient(m_fixture->AddClient());
+
+    m_sources.clear();
+    for (unsigned int i = 0; i < count; i++) {
+      Source source;
+      source.client = m_fixture->AddClient();
+      source.priority = (m_mixed_priorities && i % 2) ?
+          HIGH_PRIORITY : ola::dmx::SOURCE_PRIORITY_DEFAULT;
+      BuildFrames(i, &source.frames[0], &source.frames[1]);
+      m_sources.push_back(source);
+    }
+    // Send a frame from each source, so they're all known to the universe.
+    for (unsigned int i = 0; i < count; i++) {
+      SendFrame(i, 0);
+    }
+  }
+
+  void Run(uint64_t operations) {
+    for (uint64_t i = 0; i < operations; i++) {
+      unsigned int source = i % m_sources.size();
+      SendFrame(source, (i / m_sources.size() + 1) % 2);
+    }
+  }
+
+  static string ModeName(Universe::merge_mode mode, bool mixed_priorities) {
+    if (mixed_priorities) {
+      return "priority";
+    }
+    return mode == Universe::MERGE_HTP ? "htp" : "ltp";
+  }
+
+ private:
+  struct Source {
+    BenchmarkClient *client;
+    uint8_t priority;
+    DmxBuffer frames[2];
+  };
+
+  const Universe::merge_mode m_mode;
+  const bool m_mixed_priorities;
+  std::auto_ptr<UniverseFixture> m_fixture;
+  vector<Source> m_sources;
+
+  void SendFrame(unsigned int index, unsigned int frame) {
+    Source &source = m_sources[index];
+    DmxSource dmx_source(source.frames[frame], m_fixture->WakeUpTime(),
+                         source.priority);
+    source.client->DMXReceived(UNIVERSE_ID, dmx_source);
+    m_fixture->GetUniverse()->SourceClientDataChanged(source.client);
+  }
+};
+
+
+/**
+ * Merge data from input ports, with Universe::PortDataChanged().
+ */
+class PortMergeBenchmark: public UniverseBenchmark {
+ public:
+  PortMergeBenchmark(Universe::merge_mode mode, bool mixed_priorities)
+      : m_mode(mode),
+        m_mixed_priorities(mixed_priorities) {
+  }
+
+  string Name() const {
+    return "port-" + ClientMergeBenchmark::ModeName(m_mode,
+                                                    m_mixed_priorities);
+  }
+
+  void Setup(unsigned int count) {
+    m_fixture.reset(new UniverseFixture());
+    m_fixture->GetUniverse()->SetMergeMode(m_mode);
+    m_fixture->GetUniverse()->AddSinkClient(m_fixture->AddClient());
+
+    m_sources.clear();
+    for (unsigned int i = 0; i < count; i++) {
+      Source source;
+      source.port = m_fixture->AddInputPort(
+          (m_mixed_priorities && i % 2) ?
+          HIGH_PRIORITY : ola::dmx::SOURCE_PRIORITY_DEFAULT);
+      BuildFrames(i, &source.frames[0], &source.frames[1]);
+      m_sources.push_back(source);
+    }
+    for (unsigned int i = 0; i < count; i++) {
+      SendFrame(i, 0);
+    }
+  }
+
+  void Run(uint64_t operations) {
+    for (uint64_t i = 0; i < operations; i++) {
+      unsigned int source = i % m_sources.size();
+      SendFrame(source, (i / m_sources.size() + 1) % 2);
+    }
+  }
+
+ private:
+  struct Source {
+    TestMockInputPort *port;
+    DmxBuffer frames[2];
+  };
+
+  const Universe::merge_mode m_mode;
+  const bool m_mixed_priorities;
+  std::auto_ptr<UniverseFixture> m_fixture;
+  vector<Source> m_sources;
+
+  void SendFrame(unsigned int index, unsigned int frame) {
+    Source &source = m_sources[index];
+    source.port->WriteDMX(source.frames[frame]);
+    // This calls Universe::PortDataChanged()
+    source.port->DmxChanged();
+  }
+};
+
+
+/**
+ * Send a new frame to the output ports and sink clients. This is the cost of
+ * Universe::UpdateDependants() as the number of dependants grows.
+ */
+class FanOutBenchmark: public UniverseBenchmark {
+ public:
+  string Name() const { return "fan-out"; }
+
+  void Setup(unsigned int count) {
+    m_fixture.reset(new UniverseFixture());
+    Universe *universe = m_fixture->GetUniverse();
+    for (unsigned int i = 0; i < count; i++) {
+      m_fixture->AddOutputPort();
+      universe->AddSinkClient(m_fixture->AddClient());
+    }
+    BuildFrames(0, &m_frames[0], &m_frames[1]);
+  }
+
+  void Run(uint64_t operations) {
+    Universe *universe = m_fixture->GetUniverse();
+    for (uint64_t i = 0; i < operations; i++) {
+      universe->SetDMX(m_frames[i % 2]);
+    }
+  }
+
+ private:
+  std::auto_ptr<UniverseFixture> m_fixture;
+  DmxBuffer m_frames[2];
+};
+
+
+struct Result {
+  double ns_per_op;
+  double allocations_per_op;
+};
+
+typedef map<string, Result> Results;
+
+/*
+ * Run a benchmark, after a short warm up.
+ */
+Result RunBenchmark(UniverseBenchmark *benchmark) {
+  benchmark->Run(std::min(static_cast<uint64_t>(FLAGS_iterations),
+                          static_cast<uint64_t>(1000)));
+
+  Clock clock;
+  TimeStamp start, end;
+  const uint64_t allocations = allocation_count;
+  clock.CurrentMonotonicTime(&start);
+  benchmark->Run(FLAGS_iterations);
+  clock.CurrentMonotonicTime(&end);
+
+  Result result;
+  const TimeInterval duration = end - start;
+  result.ns_per_op = duration.AsInt() * 1000.0 / FLAGS_iterations;
+  result.allocations_per_op =
+      static_cast<double>(allocation_count - allocations) / FLAGS_iterations;
+  return result;
+}
+
+bool WriteBaseline(const string &filename, const Results &results) {
+  std::ofstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+  file << "# benchmark ns/op allocations/op" << endl;
+  file << std::fixed << std::setprecision(2);
+  for (Results::const_iterator iter = results.begin(); iter != results.end();
+       ++iter) {
+    file << iter->first << " " << iter->second.ns_per_op << " "
+         << iter->second.allocations_per_op << endl;
+  }
+  return true;
+}
+
+/*
+ * Compare the results with a baseline.
+ * @returns false if there was a regression, or the baseline couldn't be read.
+ */
+bool CheckBaseline(const string &filename, const Results &results) {
+  std::ifstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+
+  bool ok = true;
+  string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream str(line);
+    string name;
+    double ns_per_op, allocations_per_op;
+    if (!(str >> name >> ns_per_op >> allocations_per_op)) {
+      OLA_WARN << "Invalid baseline line: " << line;
+      ok = false;
+      continue;
+    }
+
+    const Result *result = ola::STLFind(&results, name);
+    if (!result) {
+      continue;
+    }
+
+    const double limit = ns_per_op * (100 + FLAGS_tolerance) / 100;
+    if (result->ns_per_op > limit) {
+      cout << name << ": " << result->ns_per_op << " ns/op, the baseline is "
+           << ns_per_op << endl;
+      ok = false;
+    }
+    // Allocations don't depend on the machine, so any increase is reported.
+    if (result->allocations_per_op > allocations_per_op + 0.01) {
+      cout << name << ": " << result->allocations_per_op
+           << " allocations/op, the baseline is " << allocations_per_op
+           << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the merge and output paths of a universe, and report "
+               "the time and allocations per operation.");
+
+  if (!FLAGS_iterations) {
+    OLA_FATAL << "--iterations must be non-0";
+    return 1;
+  }
+
+  vector<string> selected;
+  if (!FLAGS_benchmarks.str().empty()) {
+    ola::StringSplit(FLAGS_benchmarks.str(), &selected, ",");
+  }
+
+  vector<string> source_strings;
+  vector<unsigned int> source_counts;
+  ola::StringSplit(FLAGS_sources.str(), &source_strings, ",");
+  vector<string>::const_iterator count_iter = source_strings.begin();
+  for (; count_iter != source_strings.end(); ++count_iter) {
+    unsigned int count;
+    if (!ola::StringToInt(*count_iter, &count) || !count) {
+      OLA_FATAL << "Invalid source count " << *count_iter;
+      return 1;
+    }
+    source_counts.push_back(count);
+  }
+
+  vector<UniverseBenchmark*> benchmarks;
+  benchmarks.push_back(new ClientMergeBenchmark(Universe::MERGE_HTP, false));
+  benchmarks.push_back(new ClientMergeBenchmark(Universe::MERGE_LTP, false));
+  benchmarks.push_back(new ClientMergeBenchmark(Universe::MERGE_HTP, true));
+  benchmarks.push_back(new PortMergeBenchmark(Universe::MERGE_HTP, false));
+  benchmarks.push_back(new PortMergeBenchmark(Universe::MERGE_LTP, false));
+  benchmarks.push_back(new PortMergeBenchmark(Universe::MERGE_HTP, true));
+  benchmarks.push_back(new FanOutBenchmark());
+
+  cout << std::setw(16) << "benchmark" << std::setw(8) << "count"
+       << std::setw(12) << "ns/op" << std::setw(14) << "ops/s"
+       << std::setw(12) << "allocs/op" << endl;
+
+  Results results;
+  vector<UniverseBenchmark*>::iterator iter = benchmarks.begin();
+  for (; iter != benchmarks.end(); ++iter) {
+    UniverseBenchmark *benchmark = *iter;
+    if (!selected.empty() &&
+        std::find(selected.begin(), selected.end(), benchmark->Name()) ==
+            selected.end()) {
+      continue;
+    }
+
+    vector<unsigned int>::const_iterator count = source_counts.begin();
+    for (; count != source_counts.end(); ++count) {
+      benchmark->Setup(*count);
+      const Result result = RunBenchmark(benchmark);
+      results[benchmark->Name() + "/" + ola::strings::IntToString(*count)] =
+          result;
+      cout << std::setw(16) << benchmark->Name()
+           << std::setw(8) << *count
+           << std::fixed << std::setprecision(1)
+           << std::setw(12) << result.ns_per_op
+           << std::setprecision(0)
+           << std::setw(14) << (result.ns_per_op ? 1e9 / result.ns_per_op : 0)
+           << std::setprecision(2)
+           << std::setw(12) << result.allocations_per_op << endl;
+    }
+  }
+  ola::STLDeleteElements(&benchmarks);
+
+  if (!FLAGS_baseline.str().empty()) {
+    if (FLAGS_write_baseline) {
+      return WriteBaseline(FLAGS_baseline.str(), results) ? 0 : 1;
+    }
+    return CheckBaseline(FLAGS_baseline.str(), results) ? 0 : 1;
+  }
+  return 0;
+}
@@ -0,0 +1,496 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * universe_replay.cpp
+ * Replay a trace recorded with olad --input-trace through the universes.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <stdint.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/UID.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/InputTrace.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Clock;
+using ola::DmxSource;
+using ola::InputTrace;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using std::cout;
+using std::endl;
+using std::map;
+using std::string;
+using std::vector;
+
+DEFINE_uint32(speed, 1,
+              "Replay the trace this many times faster than it was recorded. "
+              "0 replays it as fast as possible");
+DEFINE_string(merge_mode, "htp", "The merge mode of the universes, htp or ltp");
+DEFINE_uint32(max_output_rate, 0,
+              "Limit the frames each universe sends per second, 0 means no "
+              "limit");
+DEFINE_string(baseline, "",
+              "Compare the results with the ones in this file, and exit with "
+              "an error if any of them regressed");
+DEFINE_default_bool(write_baseline, false,
+                    "Write the results to the --baseline file rather than "
+                    "comparing");
+DEFINE_uint32(tolerance, 10,
+              "The percentage the latency & CPU time can increase by before "
+              "it's reported as a regression");
+
+
+/**
+ * A source client that drops the DMX data it's sent.
+ */
+class ReplayClient: public ola::Client {
+ public:
+  explicit ReplayClient(const ola::rdm::UID &uid)
+      : ola::Client(NULL, uid) {
+  }
+
+  bool SendDMX(const ola::DmxUpdate&) { return true; }
+};
+
+
+typedef map<string, double> Results;
+
+/**
+ * Replays the events of a trace through a UniverseStore.
+ *
+ * Input ports are created for the ports in the trace, and clients for the
+ * clients. Each universe has an output port. The time the sources see is the
+ * time from the trace, so the merge results don't depend on how fast the
+ * trace is replayed.
+ */
+class TraceReplayer {
+ public:
+  TraceReplayer(const vector<InputTrace::Event> &events, unsigned int speed)
+      : m_events(events),
+        m_speed(speed),
+        m_preferences("replay"),
+        m_store(&m_preferences, &m_export_map, &m_ss, &m_trace_time),
+        m_port_manager(&m_store, &m_broker),
+        m_plugin_adaptor(NULL, &m_ss, NULL, NULL, NULL, NULL),
+        m_plugin(NULL, ola::OLA_PLUGIN_DUMMY),
+        m_device(&m_plugin, "replay"),
+        m_next_event(0),
+        m_next_port_id(0) {
+  }
+
+  ~TraceReplayer();
+
+  bool Setup(Universe::merge_mode merge_mode, unsigned int max_output_rate);
+  void Run();
+  void GetResults(Results *results);
+
+ private:
+  typedef map<string, TestMockInputPort*> PortMap;
+  typedef map<string, ReplayClient*> ClientMap;
+
+  const vector<InputTrace::Event> &m_events;
+  const unsigned int m_speed;
+  ola::ExportMap m_export_map;
+  ola::io::SelectServer m_ss;
+  ola::MemoryPreferences m_preferences;
+  TimeStamp m_trace_time;
+  ola::UniverseStore m_store;
+  ola::PortBroker m_broker;
+  ola::PortManager m_port_manager;
+  ola::PluginAdaptor m_plugin_adaptor;
+  TestMockPlugin m_plugin;
+  MockDeviceLoopAndMulti m_device;
+  Clock m_clock;
+  TimeStamp m_start;
+  PortMap m_input_ports;
+  ClientMap m_clients;
+  vector<TestMockOutputPort*> m_output_ports;
+  vector<int64_t> m_latencies;
+  unsigned int m_next_event;
+  unsigned int m_next_port_id;
+  struct rusage m_start_usage;
+  struct rusage m_end_usage;
+
+  TimeStamp DueTime(const InputTrace::Event &event) const;
+  void ScheduleNext();
+  void DispatchDue();
+  void Dispatch(const InputTrace::Event &event);
+  static string PortKey(const InputTrace::Event &event);
+  static int64_t CPUTime(const struct rusage &usage);
+};
+
+
+TraceReplayer::~TraceReplayer() {
+  PortMap::iterator port_iter = m_input_ports.begin();
+  for (; port_iter != m_input_ports.end(); ++port_iter) {
+    m_port_manager.UnPatchPort(port_iter->second);
+  }
+  vector<TestMockOutputPort*>::iterator output_iter = m_output_ports.begin();
+  for (; output_iter != m_output_ports.end(); ++output_iter) {
+    m_port_manager.UnPatchPort(*output_iter);
+  }
+  ClientMap::iterator client_iter = m_clients.begin();
+  for (; client_iter != m_clients.end(); ++client_iter) {
+    vector<Universe*> universes;
+    m_store.GetList(&universes);
+    vector<Universe*>::iterator iter = universes.begin();
+    for (; iter != universes.end(); ++iter) {
+      (*iter)->RemoveSourceClient(client_iter->second);
+    }
+  }
+  m_store.DeleteAll();
+  ola::STLDeleteValues(&m_input_ports);
+  ola::STLDeleteValues(&m_clients);
+  ola::STLDeleteElements(&m_output_ports);
+}
+
+
+/*
+ * Create the ports & clients the trace needs.
+ */
+bool TraceReplayer::Setup(Universe::merge_mode merge_mode,
+                          unsigned int max_output_rate) {
+  vector<InputTrace::Event>::const_iterator iter = m_events.begin();
+  for (; iter != m_events.end(); ++iter) {
+    Universe *universe = m_store.GetUniverse(iter->universe);
+    if (!universe) {
+      universe = m_store.GetUniverseOrCreate(iter->universe);
+      if (!universe) {
+        OLA_WARN << "Failed to create universe " << iter->universe;
+        return false;
+      }
+      universe->SetMergeMode(merge_mode);
+      universe->SetMaxOutputRate(max_output_rate);
+      TestMockOutputPort *port = new TestMockOutputPort(&m_device,
+                                                        m_next_port_id++);
+      m_output_ports.push_back(port);
+      m_port_manager.PatchPort(port, iter->universe);
+    }
+
+    if (iter->type == InputTrace::PORT_SOURCE) {
+      const string key = PortKey(*iter);
+      if (!ola::STLContains(m_input_ports, key)) {
+        TestMockInputPort *port = new TestMockInputPort(
+            &m_device, m_next_port_id++, &m_plugin_adaptor);
+        m_input_ports[key] = port;
+        m_port_manager.PatchPort(port, iter->universe);
+      }
+    } else if (!ola::STLContains(m_clients, iter->source)) {
+      std::auto_ptr<ola::rdm::UID> uid(
+          ola::rdm::UID::FromString(iter->source));
+      if (!uid.get()) {
+        OLA_WARN << "Invalid client UID " << iter->source;
+        return false;
+      }
+      m_clients[iter->source] = new ReplayClient(*uid);
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Replay all the events.
+ */
+void TraceReplayer::Run() {
+  m_latencies.clear();
+  m_latencies.reserve(m_events.size());
+  m_next_event = 0;
+
+  getrusage(RUSAGE_SELF, &m_start_usage);
+  m_clock.CurrentMonotonicTime(&m_start);
+  if (m_speed) {
+    ScheduleNext();
+    m_ss.Run();
+  } else {
+    for (; m_next_event < m_events.size(); m_next_event++) {
+      Dispatch(m_events[m_next_event]);
+    }
+  }
+  getrusage(RUSAGE_SELF, &m_end_usage);
+}
+
+
+void TraceReplayer::GetResults(Results *results) {
+  uint64_t inputs = 0, outputs = 0, merge_us = 0;
+  vector<Universe*> universes;
+  m_store.GetList(&universes);
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    const Universe::Stats &stats = (*iter)->GetStats();
+    inputs += stats.input_frames;
+    outputs += stats.output_frames;
+    merge_us += stats.merge_time_us;
+  }
+
+  uint64_t coalesced = 0;
+  const ola::UIntMap *coalesced_var = m_export_map.GetUIntMapVar(
+      Universe::K_COALESCED_FRAMES_VAR);
+  ola::UIntMap::const_iterator var_iter = coalesced_var->Begin();
+  for (; var_iter != coalesced_var->End(); ++var_iter) {
+    coalesced += var_iter->second;
+  }
+
+  const int64_t cpu_us = CPUTime(m_end_usage) - CPUTime(m_start_usage);
+
+  (*results)["events"] = m_events.size();
+  (*results)["inputs"] = inputs;
+  (*results)["outputs"] = outputs;
+  (*results)["coalesced"] = coalesced;
+  (*results)["merge_ms"] = merge_us / 1000.0;
+  (*results)["cpu_ms"] = cpu_us / 1000.0;
+
+  if (!m_latencies.empty()) {
+    vector<int64_t> latencies(m_latencies);
+    std::sort(latencies.begin(), latencies.end());
+    (*results)["latency_p50_us"] = latencies[latencies.size() / 2];
+    (*results)["latency_p99_us"] = latencies[latencies.size() * 99 / 100];
+    (*results)["latency_max_us"] = latencies.back();
+  }
+}
+
+
+/*
+ * The time an event should be dispatched.
+ */
+TimeStamp TraceReplayer::DueTime(const InputTrace::Event &event) const {
+  return m_start + TimeInterval(event.offset_us / m_speed);
+}
+
+
+/*
+ * Wait until the next event is due.
+ */
+void TraceReplayer::ScheduleNext() {
+  if (m_next_event >= m_events.size()) {
+    m_ss.Terminate();
+    return;
+  }
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  const TimeStamp due = DueTime(m_events[m_next_event]);
+  m_ss.RegisterSingleTimeout(
+      due > now ? due - now : TimeInterval(),
+      ola::NewSingleCallback(this, &TraceReplayer::DispatchDue));
+}
+
+
+/*
+ * Dispatch the events that are due. How late each one is shows how long the
+ * universes are holding up the loop.
+ */
+void TraceReplayer::DispatchDue() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  while (m_next_event < m_events.size()) {
+    const InputTrace::Event &event = m_events[m_next_event];
+    const TimeStamp due = DueTime(event);
+    if (due > now) {
+      break;
+    }
+    m_latencies.push_back((now - due).AsInt());
+    Dispatch(event);
+    m_next_event++;
+    m_clock.CurrentMonotonicTime(&now);
+  }
+  ScheduleNext();
+}
+
+
+void TraceReplayer::Dispatch(const InputTrace::Event &event) {
+  m_trace_time = m_start + TimeInterval(event.offset_us);
+  const DmxSource source(event.data, m_trace_time, event.priority);
+
+  if (event.type == InputTrace::PORT_SOURCE) {
+    TestMockInputPort *port = ola::STLFindOrNull(m_input_ports,
+                                                 PortKey(event));
+    // This calls Universe::PortDataChanged()
+    port->UpdateSource(source);
+  } else {
+    ReplayClient *client = ola::STLFindOrNull(m_clients, event.source);
+    client->DMXReceived(event.universe, source);
+    m_store.GetUniverse(event.universe)->SourceClientDataChanged(client);
+  }
+}
+
+
+/*
+ * A port is only patched to one universe, so if a port in the trace was
+ * repatched, the replay uses a port for each universe.
+ */
+string TraceReplayer::PortKey(const InputTrace::Event &event) {
+  return event.source + "/" + ola::strings::IntToString(event.universe);
+}
+
+
+/*
+ * The user & system time in a rusage, in microseconds.
+ */
+int64_t TraceReplayer::CPUTime(const struct rusage &usage) {
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+
+void PrintResults(const Results &results) {
+  cout << std::fixed << std::setprecision(2);
+  for (Results::const_iterator iter = results.begin(); iter != results.end();
+       ++iter) {
+    cout << std::setw(16) << iter->first << std::setw(16) << iter->second
+         << endl;
+  }
+}
+
+bool WriteBaseline(const string &filename, const Results &results) {
+  std::ofstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+  file << "# metric value" << endl;
+  file << std::fixed << std::setprecision(2);
+  for (Results::const_iterator iter = results.begin(); iter != results.end();
+       ++iter) {
+    file << iter->first << " " << iter->second << endl;
+  }
+  return true;
+}
+
+/*
+ * Compare the results with a baseline.
+ * @returns false if there was a regression, or the baseline couldn't be read.
+ */
+bool CheckBaseline(const string &filename, const Results &results) {
+  std::ifstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+
+  bool ok = true;
+  string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream str(line);
+    string name;
+    double value;
+    if (!(str >> name >> value)) {
+      OLA_WARN << "Invalid baseline line: " << line;
+      ok = false;
+      continue;
+    }
+
+    const double *result = ola::STLFind(&results, name);
+    if (!result) {
+      continue;
+    }
+
+    // The counts only depend on the trace, so any change is reported.
+    const bool is_time = ola::StringEndsWith(name, "_ms") ||
+                         ola::StringEndsWith(name, "_us");
+    const double limit = is_time ? value * (100 + FLAGS_tolerance) / 100 :
+                                   value;
+    if (is_time ? *result > limit : *result != limit) {
+      cout << name << ": " << *result << ", the baseline is " << value
+           << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options] <trace>",
+               "Replay a trace recorded with olad --input-trace through the "
+               "universes, and report the latency, merges, output frames and "
+               "CPU time.");
+
+  if (argc != 2) {
+    ola::DisplayUsageAndExit();
+  }
+
+  Universe::merge_mode merge_mode;
+  if (FLAGS_merge_mode.str() == "htp") {
+    merge_mode = Universe::MERGE_HTP;
+  } else if (FLAGS_merge_mode.str() == "ltp") {
+    merge_mode = Universe::MERGE_LTP;
+  } else {
+    OLA_FATAL << "Invalid merge mode " << FLAGS_merge_mode.str();
+    return 1;
+  }
+
+  vector<InputTrace::Event> events;
+  if (!InputTrace::Load(argv[1], &events)) {
+    return 1;
+  }
+  if (events.empty()) {
+    OLA_FATAL << argv[1] << " doesn't contain any events";
+    return 1;
+  }
+
+  TraceReplayer replayer(events, FLAGS_speed);
+  if (!replayer.Setup(merge_mode, FLAGS_max_output_rate)) {
+    return 1;
+  }
+  replayer.Run();
+
+  Results results;
+  replayer.GetResults(&results);
+  PrintResults(results);
+
+  if (!FLAGS_baseline.str().empty()) {
+    if (FLAGS_write_baseline) {
+      return WriteBaseline(FLAGS_baseline.str(), results) ? 0 : 1;
+    }
+    return CheckBaseline(FLAGS_baseline.str(), results) ? 0 : 1;
+  }
+  return 0;
+}
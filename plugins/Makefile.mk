@@ -28,3 +28,41 @@ include plugins/uartdmx/Makefile.mk
 endif
 
 dist_noinst_SCRIPTS += plugins/convert_README_to_header.sh
+
+# PROGRAMS
+##################################################
+if !USING_WIN32
+noinst_PROGRAMS += plugins/parser_benchmark
+
+plugins_parser_benchmark_SOURCES = plugins/parser_benchmark.cpp
+plugins_parser_benchmark_CXXFLAGS = $(COMMON_CXXFLAGS)
+plugins_parser_benchmark_LDADD = common/libolacommon.la \
+                                 libs/acn/libolae131core.la
+
+if USE_ARTNET
+plugins_parser_benchmark_LDADD += plugins/artnet/libolaartnetnode.la
+endif
+
+if USE_ESPNET
+plugins_parser_benchmark_SOURCES += \
+    plugins/espnet/EspNetNode.cpp \
+    plugins/espnet/RunLengthDecoder.cpp
+endif
+
+if USE_KINET
+plugins_parser_benchmark_LDADD += plugins/kinet/libolakinetnode.la
+endif
+
+if USE_OPENPIXELCONTROL
+plugins_parser_benchmark_LDADD += plugins/openpixelcontrol/libolaopc.la
+endif
+
+if USE_OSC
+plugins_parser_benchmark_CXXFLAGS += $(liblo_CFLAGS)
+plugins_parser_benchmark_LDADD += plugins/osc/libolaoscnode.la
+endif
+
+if USE_SHOWNET
+plugins_parser_benchmark_SOURCES += plugins/shownet/ShowNetNode.cpp
+endif
+endif
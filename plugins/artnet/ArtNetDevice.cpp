@@ -58,6 +58,8 @@ using std::vector;
 
 const char ArtNetDevice::K_ALWAYS_BROADCAST_KEY[] = "always_broadcast";
 const char ArtNetDevice::K_DEVICE_NAME[] = "Art-Net";
+const char ArtNetDevice::K_EXTENDED_ADDRESSING_KEY[] = "extended_addressing";
+const char ArtNetDevice::K_INPUT_PORT_KEY[] = "input_ports";
 const char ArtNetDevice::K_IP_KEY[] = "ip";
 const char ArtNetDevice::K_LIMITED_BROADCAST_KEY[] = "use_limited_broadcast";
 const char ArtNetDevice::K_LONG_NAME_KEY[] = "long_name";
@@ -66,9 +68,13 @@ const char ArtNetDevice::K_NET_KEY[] = "net";
 const char ArtNetDevice::K_OUTPUT_PORT_KEY[] = "output_ports";
 const char ArtNetDevice::K_SHORT_NAME_KEY[] = "short_name";
 const char ArtNetDevice::K_SUBNET_KEY[] = "subnet";
+const char ArtNetDevice::K_USE_ART_SYNC_KEY[] = "use_art_sync";
+const char ArtNetDevice::K_RECEIVE_TIMESTAMPS_KEY[] = "receive_timestamps";
 const unsigned int ArtNetDevice::K_ARTNET_NET = 0;
 const unsigned int ArtNetDevice::K_ARTNET_SUBNET = 0;
+const unsigned int ArtNetDevice::K_DEFAULT_INPUT_PORT_COUNT = 4;
 const unsigned int ArtNetDevice::K_DEFAULT_OUTPUT_PORT_COUNT = 4;
+const unsigned int ArtNetDevice::K_MAX_PORT_COUNT = 1024;
 
 ArtNetDevice::ArtNetDevice(AbstractPlugin *owner,
                            ola::Preferences *preferences,
@@ -104,10 +110,22 @@ bool ArtNetDevice::StartHook() {
       K_ALWAYS_BROADCAST_KEY);
   node_options.use_limited_broadcast_address = m_preferences->GetValueAsBool(
       K_LIMITED_BROADCAST_KEY);
+  node_options.use_art_sync = m_preferences->GetValueAsBool(
+      K_USE_ART_SYNC_KEY);
+  node_options.use_receive_timestamps = m_preferences->GetValueAsBool(
+      K_RECEIVE_TIMESTAMPS_KEY);
   // OLA Output ports are Art-Net input ports
   node_options.input_port_count = StringToIntOrDefault(
       m_preferences->GetValue(K_OUTPUT_PORT_KEY),
       K_DEFAULT_OUTPUT_PORT_COUNT);
+  // OLA Input ports are Art-Net output ports
+  node_options.output_port_count = StringToIntOrDefault(
+      m_preferences->GetValue(K_INPUT_PORT_KEY),
+      K_DEFAULT_INPUT_PORT_COUNT);
+  node_options.export_map = m_plugin_adaptor->GetExportMap();
+  node_options.transmit_pacer = m_plugin_adaptor->GetTransmitPacer();
+  bool extended_addressing = m_preferences->GetValueAsBool(
+      K_EXTENDED_ADDRESSING_KEY);
 
   m_node = new ArtNetNode(iface, m_plugin_adaptor, node_options);
   m_node->SetNetAddress(net);
@@ -116,11 +134,12 @@ bool ArtNetDevice::StartHook() {
   m_node->SetLongName(m_preferences->GetValue(K_LONG_NAME_KEY));
 
   for (unsigned int i = 0; i < node_options.input_port_count; i++) {
-    AddPort(new ArtNetOutputPort(this, i, m_node));
+    AddPort(new ArtNetOutputPort(this, i, m_node, extended_addressing));
   }
 
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    AddPort(new ArtNetInputPort(this, i, m_plugin_adaptor, m_node));
+  for (unsigned int i = 0; i < node_options.output_port_count; i++) {
+    AddPort(new ArtNetInputPort(this, i, m_plugin_adaptor, m_node,
+                                extended_addressing));
   }
 
   if (!m_node->Start()) {
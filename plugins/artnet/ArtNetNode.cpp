@@ -18,6 +18,10 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include <string.h>
 #include <algorithm>
 #include <map>
@@ -26,13 +30,17 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include HASH_MAP_H
 
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Array.h"
+#include "ola/math/Random.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/network/SocketAddress.h"
+#include "ola/network/UDPPacketBuilder.h"
 #include "ola/rdm/RDMCommandSerializer.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/stl/STLUtils.h"
@@ -47,12 +55,12 @@ namespace artnet {
 
 using ola::Callback0;
 using ola::Callback1;
-using ola::network::HostToLittleEndian;
-using ola::network::HostToNetwork;
+using ola::dmx::ReceiveStats;
+using ola::network::BigEndian;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
-using ola::network::LittleEndianToHost;
-using ola::network::NetworkToHost;
+using ola::network::UDPDatagram;
+using ola::network::UDPPacketBuilder;
 using ola::network::UDPSocket;
 using ola::rdm::RDMCallback;
 using ola::rdm::RDMCommand;
@@ -75,23 +83,155 @@ using std::vector;
 
 
 const char ArtNetNodeImpl::ARTNET_ID[] = "Art-Net";
+const char ArtNetNodeImpl::RECEIVE_STATS_VAR[] = "artnet-receive-stats";
 
 
 // UID to the IP Address it came from, and the number of times since we last
 // saw it in an ArtTod message.
 typedef map<UID, std::pair<IPV4Address, uint8_t> > uid_map;
 
+// The last TOD we received from a gateway. Gateways repeat their TOD often,
+// and large ones split it across many ArtTodData blocks, so we remember a
+// checksum of each block and only walk the UIDs when a block changes.
+struct GatewayTod {
+  struct Block {
+    uint32_t checksum;
+    vector<UID> uids;
+  };
+
+  GatewayTod() : uid_total(0), needs_prune(true) {}
+
+  uint16_t uid_total;
+  map<uint8_t, Block> blocks;
+  // true if the blocks have changed since we last removed the UIDs that
+  // dropped out of this gateway's TOD.
+  bool needs_prune;
+};
+
+typedef map<IPV4Address, GatewayTod> gateway_tod_map;
+
+/*
+ * FNV-1a over the UIDs in an ArtTodData packet.
+ */
+static uint32_t TodChecksum(const artnet_toddata_t &packet,
+                            unsigned int uid_count) {
+  uint32_t hash = 2166136261u;
+  const uint8_t *data = &packet.tod[0][0];
+  const uint8_t *end = data + uid_count * UID::UID_SIZE;
+  for (; data != end; data++) {
+    hash = (hash ^ *data) * 16777619u;
+  }
+  return hash;
+}
+
+/*
+ * The nodes listening to an input port's universe. The addresses are kept in
+ * sorted order alongside a matching array of datagrams, so sending doesn't
+ * need to build the destination list each time.
+ */
+class ArtNetNodeImpl::SubscriberList {
+ public:
+  SubscriberList() {}
+
+  size_t Size() const { return m_addresses.size(); }
+  bool Empty() const { return m_addresses.empty(); }
+
+  void Clear() {
+    m_addresses.clear();
+    m_last_heard.clear();
+    m_datagrams.clear();
+    m_index.clear();
+  }
+
+  // Add a node, or update the time we last heard from it. Nodes reply to
+  // every ArtPoll, so updating a known node is the common case and only
+  // needs a lookup in the index.
+  void Update(const IPV4Address &address, const TimeStamp &now) {
+    const size_t *known = STLFind(&m_index, address.AsInt());
+    if (known) {
+      m_last_heard[*known] = now;
+      return;
+    }
+
+    vector<IPV4Address>::iterator iter = std::lower_bound(
+        m_addresses.begin(), m_addresses.end(), address);
+    size_t offset = iter - m_addresses.begin();
+    UDPDatagram datagram;
+    datagram.address = IPV4SocketAddress(address, ARTNET_PORT);
+    m_addresses.insert(iter, address);
+    m_last_heard.insert(m_last_heard.begin() + offset, now);
+    m_datagrams.insert(m_datagrams.begin() + offset, datagram);
+    RebuildIndex();
+  }
+
+  // Remove nodes we haven't heard from since threshold.
+  void Expire(const TimeStamp &threshold) {
+    size_t kept = 0;
+    for (size_t i = 0; i < m_addresses.size(); i++) {
+      if (m_last_heard[i] < threshold) {
+        continue;
+      }
+      if (kept != i) {
+        m_addresses[kept] = m_addresses[i];
+        m_last_heard[kept] = m_last_heard[i];
+        m_datagrams[kept] = m_datagrams[i];
+      }
+      kept++;
+    }
+    if (kept != m_addresses.size()) {
+      m_addresses.resize(kept);
+      m_last_heard.resize(kept);
+      m_datagrams.resize(kept);
+      RebuildIndex();
+    }
+  }
+
+  const vector<IPV4Address> &Addresses() const { return m_addresses; }
+
+  // Append a datagram containing data for each node.
+  void AppendDatagrams(const UDPPacketBuilder &packet,
+                       vector<UDPDatagram> *datagrams) {
+    vector<UDPDatagram>::iterator iter = m_datagrams.begin();
+    for (; iter != m_datagrams.end(); ++iter) {
+      iter->iov = packet.Blocks();
+      iter->iov_count = packet.BlockCount();
+    }
+    datagrams->insert(datagrams->end(), m_datagrams.begin(),
+                      m_datagrams.end());
+  }
+
+ private:
+  // Maps an IP address to its offset in the vectors.
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<uint32_t, size_t> AddressIndex;
+
+  vector<IPV4Address> m_addresses;
+  vector<TimeStamp> m_last_heard;
+  vector<UDPDatagram> m_datagrams;
+  AddressIndex m_index;
+
+  void RebuildIndex() {
+    m_index.clear();
+    for (size_t i = 0; i < m_addresses.size(); i++) {
+      m_index[m_addresses[i].AsInt()] = i;
+    }
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SubscriberList);
+};
+
 // Input ports are ones that send data using Art-Net
 class ArtNetNodeImpl::InputPort {
  public:
   InputPort()
       : enabled(false),
         sequence_number(0),
+        dmx_pending(false),
         discovery_callback(NULL),
         discovery_timeout(ola::thread::INVALID_TIMEOUT),
         rdm_request_callback(NULL),
         pending_request(NULL),
         rdm_send_timeout(ola::thread::INVALID_TIMEOUT),
+        m_net_address(0),
         m_port_address(0),
         m_tod_callback(NULL) {
   }
@@ -105,13 +245,25 @@ class ArtNetNodeImpl::InputPort {
     }
 
     m_port_address = ((m_port_address & 0xf0) | universe_address);
-    uids.clear();
-    subscribed_nodes.clear();
+    ClearUIDs();
+    subscribers.Clear();
     return true;
   }
 
   void ClearSubscribedNodes() {
-    subscribed_nodes.clear();
+    subscribers.Clear();
+  }
+
+  // Returns true if the address changed.
+  bool SetPortAddress(uint8_t port_address) {
+    if (m_port_address == port_address) {
+      return false;
+    }
+
+    m_port_address = port_address;
+    ClearUIDs();
+    subscribers.Clear();
+    return true;
   }
 
   // Returns true if the address changed.
@@ -122,8 +274,8 @@ class ArtNetNodeImpl::InputPort {
     }
 
     m_port_address = subnet_address | (m_port_address & 0x0f);
-    uids.clear();
-    subscribed_nodes.clear();
+    ClearUIDs();
+    subscribers.Clear();
     return true;
   }
 
@@ -133,6 +285,19 @@ class ArtNetNodeImpl::InputPort {
     return m_port_address;
   }
 
+  void SetNetAddress(uint8_t net_address) {
+    m_net_address = net_address;
+  }
+
+  uint8_t NetAddress() const {
+    return m_net_address;
+  }
+
+  // The 15-bit Port-Address, this includes the net.
+  uint16_t FullPortAddress() const {
+    return MakePortAddress(m_net_address, m_port_address);
+  }
+
   void SetTodCallback(RDMDiscoveryCallback *callback) {
     m_tod_callback.reset(callback);
   }
@@ -151,6 +316,11 @@ class ArtNetNodeImpl::InputPort {
     }
   }
 
+  void ClearUIDs() {
+    uids.clear();
+    gateway_tods.clear();
+  }
+
   void IncrementUIDCounts() {
     for (uid_map::iterator iter = uids.begin(); iter != uids.end(); ++iter) {
       iter->second.second++;
@@ -159,8 +329,16 @@ class ArtNetNodeImpl::InputPort {
 
   bool enabled;
   uint8_t sequence_number;
-  map<IPV4Address, TimeStamp> subscribed_nodes;
+  // The last ArtDmx packet built for this port, and if it's waiting to be
+  // flushed. Only the header is stored in dmx_packet, the DMX data is sent
+  // from dmx_data, which shares the frame with the caller's DmxBuffer.
+  artnet_packet dmx_packet;
+  DmxBuffer dmx_data;
+  UDPPacketBuilder dmx_builder;
+  bool dmx_pending;
+  SubscriberList subscribers;
   uid_map uids;  // used to keep track of the UIDs
+  gateway_tod_map gateway_tods;
   // NULL if discovery isn't running, otherwise the callback to run when it
   // finishes
   RDMDiscoveryCallback *discovery_callback;
@@ -177,6 +355,7 @@ class ArtNetNodeImpl::InputPort {
   ola::thread::timeout_id rdm_send_timeout;
 
  private:
+  uint8_t m_net_address;
   uint8_t m_port_address;
   // The callback to run if we receive an TOD and the discovery process
   // isn't running
@@ -199,6 +378,7 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
                                ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_net_address(0),
+      m_subnet_address(0),
       m_send_reply_on_change(true),
       m_short_name(""),
       m_long_name(""),
@@ -207,9 +387,20 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
       m_ss(ss),
       m_always_broadcast(options.always_broadcast),
       m_use_limited_broadcast_address(options.use_limited_broadcast_address),
+      m_use_art_sync(options.use_art_sync),
+      m_use_receive_timestamps(options.use_receive_timestamps),
+      m_transmit_pacer(options.transmit_pacer),
+      m_poll_reply_jitter_ms(options.poll_reply_jitter_ms),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT),
+      m_expiry_timeout(ola::thread::INVALID_TIMEOUT),
+      m_poll_reply_timeout(ola::thread::INVALID_TIMEOUT),
       m_in_configuration_mode(false),
       m_artpoll_required(false),
       m_artpollreply_required(false),
+      m_input_port_table(PORT_ADDRESS_COUNT, 0),
+      m_output_ports(options.output_port_count),
+      m_output_port_table(PORT_ADDRESS_COUNT, 0),
+      m_receive_stats(NULL),
       m_interface(iface),
       m_socket(socket) {
 
@@ -217,42 +408,58 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
     m_socket.reset(new UDPSocket());
   }
 
+  if (options.export_map) {
+    m_receive_stats = options.export_map->GetReceiveStatsMapVar(
+        RECEIVE_STATS_VAR, "port_address");
+  }
+
   for (unsigned int i = 0; i < options.input_port_count; i++) {
     m_input_ports.push_back(new InputPort());
   }
+  UpdatePortIndex();
 
   // reset all the port structures
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    m_output_ports[i].universe_address = 0;
-    m_output_ports[i].sequence_number = 0;
-    m_output_ports[i].enabled = false;
-    m_output_ports[i].is_merging = false;
-    m_output_ports[i].merge_mode = ARTNET_MERGE_HTP;
-    m_output_ports[i].buffer = NULL;
-    m_output_ports[i].on_data = NULL;
-    m_output_ports[i].on_discover = NULL;
-    m_output_ports[i].on_flush = NULL;
-    m_output_ports[i].on_rdm_request = NULL;
+  for (OutputPorts::iterator port = m_output_ports.begin();
+       port != m_output_ports.end(); ++port) {
+    port->net_address = 0;
+    port->universe_address = 0;
+    port->sequence_number = 0;
+    port->enabled = false;
+    port->is_merging = false;
+    port->sync_pending = false;
+    port->next_port = 0;
+    port->stats = NULL;
+    port->merge_mode = ARTNET_MERGE_HTP;
+    port->buffer = NULL;
+    port->on_data = NULL;
+    port->on_discover = NULL;
+    port->on_flush = NULL;
+    port->on_rdm_request = NULL;
   }
 }
 
 ArtNetNodeImpl::~ArtNetNodeImpl() {
   Stop();
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+  }
+
   STLDeleteElements(&m_input_ports);
 
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    if (m_output_ports[i].on_data) {
-      delete m_output_ports[i].on_data;
+  for (OutputPorts::iterator port = m_output_ports.begin();
+       port != m_output_ports.end(); ++port) {
+    if (port->on_data) {
+      delete port->on_data;
     }
-    if (m_output_ports[i].on_discover) {
-      delete m_output_ports[i].on_discover;
+    if (port->on_discover) {
+      delete port->on_discover;
     }
-    if (m_output_ports[i].on_flush) {
-      delete m_output_ports[i].on_flush;
+    if (port->on_flush) {
+      delete port->on_flush;
     }
-    if (m_output_ports[i].on_rdm_request) {
-      delete m_output_ports[i].on_rdm_request;
+    if (port->on_rdm_request) {
+      delete port->on_rdm_request;
     }
   }
 }
@@ -262,6 +469,9 @@ bool ArtNetNodeImpl::Start() {
     return false;
   }
 
+  m_expiry_timeout = m_ss->RegisterRepeatingTimeout(
+      SUBSCRIBER_EXPIRY_INTERVAL_MS,
+      NewCallback(this, &ArtNetNodeImpl::ExpireSubscribers));
   m_running = true;
   return true;
 }
@@ -302,6 +512,24 @@ bool ArtNetNodeImpl::Stop() {
     }
   }
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  if (m_expiry_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_expiry_timeout);
+    m_expiry_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  if (m_poll_reply_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_poll_reply_timeout);
+    m_poll_reply_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  if (m_transmit_pacer) {
+    m_transmit_pacer->Flush(m_socket.get());
+  }
   m_ss->RemoveReadDescriptor(m_socket.get());
 
   m_running = false;
@@ -367,8 +595,15 @@ bool ArtNetNodeImpl::SetNetAddress(uint8_t net_address) {
   vector<InputPort*>::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
     input_ports_enabled |= (*iter)->enabled;
+    (*iter)->SetNetAddress(net_address);
     (*iter)->ClearSubscribedNodes();
   }
+  for (OutputPorts::iterator port = m_output_ports.begin();
+       port != m_output_ports.end(); ++port) {
+    port->net_address = net_address;
+  }
+  UpdatePortIndex();
+  UpdateOutputPortTable();
 
   if (input_ports_enabled) {
     SendPollIfAllowed();
@@ -385,51 +620,63 @@ bool ArtNetNodeImpl::SetSubnetAddress(uint8_t subnet_address) {
     input_ports_enabled |= (*iter)->enabled;
     changed |= (*iter)->SetSubNetAddress(subnet_address);
   }
+  if (changed) {
+    UpdatePortIndex();
+  }
 
   if (input_ports_enabled && changed) {
     SendPollIfAllowed();
   }
 
   // set for all output ports.
-  uint8_t old_address = m_output_ports[0].universe_address >> 4;
-  if (old_address == subnet_address && !changed) {
-    return true;
-  }
-
+  m_subnet_address = subnet_address & 0x0f;
   subnet_address = subnet_address << 4;
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    m_output_ports[i].universe_address = subnet_address |
-        (m_output_ports[i].universe_address & 0x0f);
+  for (OutputPorts::iterator port = m_output_ports.begin();
+       port != m_output_ports.end(); ++port) {
+    uint8_t universe_address = subnet_address | (port->universe_address & 0x0f);
+    if (universe_address != port->universe_address) {
+      port->universe_address = universe_address;
+      changed = true;
+    }
   }
 
+  if (!changed) {
+    return true;
+  }
+  UpdateOutputPortTable();
   return SendPollReplyIfRequired();
 }
 
-uint8_t ArtNetNodeImpl::InputPortCount() const {
+uint16_t ArtNetNodeImpl::InputPortCount() const {
   return m_input_ports.size();
 }
 
-bool ArtNetNodeImpl::SetInputPortUniverse(uint8_t port_id,
+bool ArtNetNodeImpl::SetInputPortUniverse(uint16_t port_id,
                                           uint8_t universe_id) {
   InputPort *port = GetInputPort(port_id);
   if (!port) {
     return false;
   }
 
+  bool was_enabled = port->enabled;
   port->enabled = true;
-  if (port->SetUniverseAddress(universe_id)) {
+  bool changed = port->SetUniverseAddress(universe_id);
+  if (changed || !was_enabled) {
+    UpdatePortIndex();
+  }
+  if (changed) {
     SendPollIfAllowed();
     return SendPollReplyIfRequired();
   }
   return true;
 }
 
-uint8_t ArtNetNodeImpl::GetInputPortUniverse(uint8_t port_id) const {
+uint8_t ArtNetNodeImpl::GetInputPortUniverse(uint16_t port_id) const {
   const InputPort *port = GetInputPort(port_id);
   return port ? port->PortAddress() : 0;
 }
 
-void ArtNetNodeImpl::DisableInputPort(uint8_t port_id) {
+void ArtNetNodeImpl::DisableInputPort(uint16_t port_id) {
   InputPort *port = GetInputPort(port_id);
   bool was_enabled = false;
   if (port) {
@@ -438,16 +685,17 @@ void ArtNetNodeImpl::DisableInputPort(uint8_t port_id) {
   }
 
   if (was_enabled) {
+    UpdatePortIndex();
     SendPollReplyIfRequired();
   }
 }
 
-bool ArtNetNodeImpl::InputPortState(uint8_t port_id) const {
+bool ArtNetNodeImpl::InputPortState(uint16_t port_id) const {
   const InputPort *port = GetInputPort(port_id);
   return port ? port->enabled : false;
 }
 
-bool ArtNetNodeImpl::SetOutputPortUniverse(uint8_t port_id,
+bool ArtNetNodeImpl::SetOutputPortUniverse(uint16_t port_id,
                                            uint8_t universe_id) {
   OutputPort *port = GetOutputPort(port_id);
   if (!port) {
@@ -461,15 +709,16 @@ bool ArtNetNodeImpl::SetOutputPortUniverse(uint8_t port_id,
   port->universe_address = (
       (universe_id & 0x0f) | (port->universe_address & 0xf0));
   port->enabled = true;
+  UpdateOutputPortTable();
   return SendPollReplyIfRequired();
 }
 
-uint8_t ArtNetNodeImpl::GetOutputPortUniverse(uint8_t port_id) {
+uint8_t ArtNetNodeImpl::GetOutputPortUniverse(uint16_t port_id) {
   OutputPort *port = GetOutputPort(port_id);
   return port ? port->universe_address : 0;
 }
 
-void ArtNetNodeImpl::DisableOutputPort(uint8_t port_id) {
+void ArtNetNodeImpl::DisableOutputPort(uint16_t port_id) {
   OutputPort *port = GetOutputPort(port_id);
   if (!port) {
     return;
@@ -478,16 +727,78 @@ void ArtNetNodeImpl::DisableOutputPort(uint8_t port_id) {
   bool was_enabled = port->enabled;
   port->enabled = false;
   if (was_enabled) {
+    UpdateOutputPortTable();
     SendPollReplyIfRequired();
   }
 }
 
-bool ArtNetNodeImpl::OutputPortState(uint8_t port_id) const {
+bool ArtNetNodeImpl::OutputPortState(uint16_t port_id) const {
   const OutputPort *port = GetOutputPort(port_id);
   return port ? port->enabled : false;
 }
 
-bool ArtNetNodeImpl::SetMergeMode(uint8_t port_id,
+bool ArtNetNodeImpl::SetInputPortAddress(uint16_t port_id,
+                                         uint16_t port_address) {
+  InputPort *port = GetInputPort(port_id);
+  if (!port) {
+    return false;
+  }
+
+  uint8_t net_address = (port_address >> 8) & 0x7f;
+  bool was_enabled = port->enabled;
+  bool changed = port->NetAddress() != net_address;
+  port->enabled = true;
+  port->SetNetAddress(net_address);
+  changed |= port->SetPortAddress(port_address & 0xff);
+  if (changed) {
+    port->ClearSubscribedNodes();
+  }
+  if (changed || !was_enabled) {
+    UpdatePortIndex();
+  }
+  if (changed) {
+    SendPollIfAllowed();
+    return SendPollReplyIfRequired();
+  }
+  return true;
+}
+
+uint16_t ArtNetNodeImpl::GetInputPortAddress(uint16_t port_id) const {
+  const InputPort *port = GetInputPort(port_id);
+  return port ? port->FullPortAddress() : 0;
+}
+
+uint16_t ArtNetNodeImpl::OutputPortCount() const {
+  return m_output_ports.size();
+}
+
+bool ArtNetNodeImpl::SetOutputPortAddress(uint16_t port_id,
+                                          uint16_t port_address) {
+  OutputPort *port = GetOutputPort(port_id);
+  if (!port) {
+    return false;
+  }
+
+  uint8_t net_address = (port_address >> 8) & 0x7f;
+  uint8_t universe_address = port_address & 0xff;
+  if (port->enabled && port->net_address == net_address &&
+      port->universe_address == universe_address) {
+    return true;
+  }
+
+  port->net_address = net_address;
+  port->universe_address = universe_address;
+  port->enabled = true;
+  UpdateOutputPortTable();
+  return SendPollReplyIfRequired();
+}
+
+uint16_t ArtNetNodeImpl::GetOutputPortAddress(uint16_t port_id) const {
+  const OutputPort *port = GetOutputPort(port_id);
+  return port ? MakePortAddress(port->net_address, port->universe_address) : 0;
+}
+
+bool ArtNetNodeImpl::SetMergeMode(uint16_t port_id,
                                   artnet_merge_mode merge_mode) {
   OutputPort *port = GetOutputPort(port_id);
   if (!port) {
@@ -517,7 +828,7 @@ bool ArtNetNodeImpl::SendPoll() {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_POLL);
   memset(&packet.data.poll, 0, sizeof(packet.data.poll));
-  packet.data.poll.version = HostToNetwork(ARTNET_VERSION);
+  packet.data.poll.version.Set(ARTNET_VERSION);
   // send PollReplies when something changes
   packet.data.poll.talk_to_me = 0x02;
   unsigned int size = sizeof(packet.data.poll);
@@ -525,7 +836,7 @@ bool ArtNetNodeImpl::SendPoll() {
   return SendPacket(packet, size, m_interface.bcast_address);
 }
 
-bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
+bool ArtNetNodeImpl::SendDMX(uint16_t port_id, const DmxBuffer &buffer) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtDMX");
   if (!port) {
     return false;
@@ -536,71 +847,58 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
     return true;
   }
 
-  artnet_packet packet;
+  artnet_packet &packet = port->dmx_packet;
   PopulatePacketHeader(&packet, ARTNET_DMX);
-  memset(&packet.data.dmx, 0, sizeof(packet.data.dmx));
+  memset(&packet.data.dmx, 0, sizeof(packet.data.dmx) - DMX_UNIVERSE_SIZE);
 
-  packet.data.poll.version = HostToNetwork(ARTNET_VERSION);
+  packet.data.dmx.version.Set(ARTNET_VERSION);
   packet.data.dmx.sequence = port->sequence_number;
   packet.data.dmx.physical = port_id;
   packet.data.dmx.universe = port->PortAddress();
-  packet.data.dmx.net = m_net_address;
-
-  unsigned int buffer_size = buffer.Size();
-  buffer.Get(packet.data.dmx.data, &buffer_size);
-
-  // the dmx frame size needs to be a multiple of two, correct here if needed
-  if (buffer_size % 2) {
-    packet.data.dmx.data[buffer_size] = 0;
-    buffer_size++;
-  }
-  packet.data.dmx.length[0] = buffer_size >> 8;
-  packet.data.dmx.length[1] = buffer_size & 0xff;
-
-  unsigned int size = sizeof(packet.data.dmx) - DMX_UNIVERSE_SIZE + buffer_size;
-
-  bool sent_ok = false;
-  if (port->subscribed_nodes.size() >= m_broadcast_threshold ||
-      m_always_broadcast) {
-    sent_ok = SendPacket(
-        packet,
-        size,
-        m_use_limited_broadcast_address ?
-        IPV4Address::Broadcast() :
-        m_interface.bcast_address);
-    port->sequence_number++;
-  } else {
-    map<IPV4Address, TimeStamp>::iterator iter = port->subscribed_nodes.begin();
-    TimeStamp last_heard_threshold = (
-        *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
-    while (iter != port->subscribed_nodes.end()) {
-      // if this node has timed out, remove it from the set
-      if (iter->second < last_heard_threshold) {
-        port->subscribed_nodes.erase(iter++);
-        continue;
-      }
-      sent_ok |= SendPacket(packet, size, iter->first);
-      ++iter;
+  packet.data.dmx.net = port->NetAddress();
+
+  // the dmx frame size needs to be a multiple of two, pad here if needed
+  const unsigned int buffer_size = buffer.Size();
+  const unsigned int padding = buffer_size % 2;
+  packet.data.dmx.length[0] = (buffer_size + padding) >> 8;
+  packet.data.dmx.length[1] = (buffer_size + padding) & 0xff;
+
+  port->dmx_data = buffer;
+  port->dmx_builder.Clear();
+  port->dmx_builder.Append(
+      &packet,
+      sizeof(packet.id) + sizeof(packet.op_code) + sizeof(packet.data.dmx) -
+      DMX_UNIVERSE_SIZE);
+  port->dmx_builder.AppendDMX(port->dmx_data);
+  port->dmx_builder.AppendPadding(padding);
+
+  if (m_use_art_sync) {
+    // Wait until the end of this pass of the event loop, other ports may be
+    // updated as well.
+    port->dmx_pending = true;
+    if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+      m_flush_timeout = m_ss->RegisterSingleTimeout(
+          0, NewSingleCallback(this, &ArtNetNodeImpl::FlushDMX));
     }
+    return true;
+  }
 
-    if (port->subscribed_nodes.empty()) {
-      OLA_DEBUG << "Suppressing data transmit due to no active nodes for "
-                   "universe "
-                << static_cast<int>(port->PortAddress());
-      sent_ok = true;
-    } else {
-      // We sent at least one packet, increment the sequence number
-      port->sequence_number++;
-    }
+  vector<UDPDatagram> datagrams;
+  if (!AppendDMXDatagrams(port, &datagrams)) {
+    OLA_DEBUG << "Suppressing data transmit due to no active nodes for "
+                 "universe "
+              << static_cast<int>(port->PortAddress());
+    return true;
   }
 
+  bool sent_ok = SendDatagrams(datagrams) > 0;
   if (!sent_ok) {
     OLA_WARN << "Failed to send Art-Net DMX packet";
   }
   return sent_ok;
 }
 
-void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
+void ArtNetNodeImpl::RunFullDiscovery(uint16_t port_id,
                                       RDMDiscoveryCallback *callback) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtTodControl");
   if (!port) {
@@ -617,8 +915,8 @@ void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_TODCONTROL);
   memset(&packet.data.tod_control, 0, sizeof(packet.data.tod_control));
-  packet.data.tod_control.version = HostToNetwork(ARTNET_VERSION);
-  packet.data.tod_control.net = m_net_address;
+  packet.data.tod_control.version.Set(ARTNET_VERSION);
+  packet.data.tod_control.net = port->NetAddress();
   packet.data.tod_control.command = TOD_FLUSH_COMMAND;
   packet.data.tod_control.address = port->PortAddress();
   unsigned int size = sizeof(packet.data.tod_control);
@@ -628,7 +926,7 @@ void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
 }
 
 void ArtNetNodeImpl::RunIncrementalDiscovery(
-    uint8_t port_id,
+    uint16_t port_id,
     RDMDiscoveryCallback *callback) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtTodRequest");
   if (!port) {
@@ -646,8 +944,8 @@ void ArtNetNodeImpl::RunIncrementalDiscovery(
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_TODREQUEST);
   memset(&packet.data.tod_request, 0, sizeof(packet.data.tod_request));
-  packet.data.tod_request.version = HostToNetwork(ARTNET_VERSION);
-  packet.data.tod_request.net = m_net_address;
+  packet.data.tod_request.version.Set(ARTNET_VERSION);
+  packet.data.tod_request.net = port->NetAddress();
   packet.data.tod_request.address_count = 1;  // only one universe address
   packet.data.tod_request.addresses[0] = port->PortAddress();
   unsigned int size = sizeof(packet.data.tod_request);
@@ -656,7 +954,7 @@ void ArtNetNodeImpl::RunIncrementalDiscovery(
   }
 }
 
-void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
+void ArtNetNodeImpl::SendRDMRequest(uint16_t port_id,
                                     RDMRequest *request_ptr,
                                     RDMCallback *on_complete) {
   auto_ptr<RDMRequest> request(request_ptr);
@@ -693,7 +991,7 @@ void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
   port->pending_request = request.release();
   bool r = SendRDMCommand(*port->pending_request,
                           port->rdm_ip_destination,
-                          port->PortAddress());
+                          port->FullPortAddress());
 
   if (r && !uid_destination.IsBroadcast()) {
     port->rdm_send_timeout = m_ss->RegisterSingleTimeout(
@@ -711,7 +1009,7 @@ void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
 }
 
 bool ArtNetNodeImpl::SetUnsolicitedUIDSetHandler(
-    uint8_t port_id,
+    uint16_t port_id,
     ola::Callback1<void, const ola::rdm::UIDSet&> *tod_callback) {
   InputPort *port = GetInputPort(port_id);
   if (port) {
@@ -721,25 +1019,19 @@ bool ArtNetNodeImpl::SetUnsolicitedUIDSetHandler(
 }
 
 void ArtNetNodeImpl::GetSubscribedNodes(
-    uint8_t port_id,
+    uint16_t port_id,
     vector<IPV4Address> *node_addresses) {
   InputPort *port = GetInputPort(port_id);
   if (!port) {
     return;
   }
 
-  map<IPV4Address, TimeStamp> &subscribed_nodes = port->subscribed_nodes;
-  map<IPV4Address, TimeStamp>::const_iterator iter = subscribed_nodes.begin();
-  for (; iter != subscribed_nodes.end(); ++iter) {
-    TimeStamp last_heard_threshold = (
-        *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
-    if (iter->second >= last_heard_threshold) {
-      node_addresses->push_back(iter->first);
-    }
-  }
+  const vector<IPV4Address> &addresses = port->subscribers.Addresses();
+  node_addresses->insert(node_addresses->end(), addresses.begin(),
+                         addresses.end());
 }
 
-bool ArtNetNodeImpl::SetDMXHandler(uint8_t port_id,
+bool ArtNetNodeImpl::SetDMXHandler(uint16_t port_id,
                                    DmxBuffer *buffer,
                                    Callback0<void> *on_data) {
   OutputPort *port = GetOutputPort(port_id);
@@ -755,7 +1047,7 @@ bool ArtNetNodeImpl::SetDMXHandler(uint8_t port_id,
   return true;
 }
 
-bool ArtNetNodeImpl::SendTod(uint8_t port_id, const UIDSet &uid_set) {
+bool ArtNetNodeImpl::SendTod(uint16_t port_id, const UIDSet &uid_set) {
   OutputPort *port = GetEnabledOutputPort(port_id, "ArtTodData");
   if (!port) {
     return false;
@@ -765,14 +1057,14 @@ bool ArtNetNodeImpl::SendTod(uint8_t port_id, const UIDSet &uid_set) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_TODDATA);
   memset(&packet.data.tod_data, 0, sizeof(packet.data.tod_data));
-  packet.data.tod_data.version = HostToNetwork(ARTNET_VERSION);
+  packet.data.tod_data.version.Set(ARTNET_VERSION);
   packet.data.tod_data.rdm_version = RDM_VERSION;
   packet.data.tod_data.port = 1 + port_id;
-  packet.data.tod_request.net = m_net_address;
+  packet.data.tod_data.net = port->net_address;
   packet.data.tod_data.address = port->universe_address;
   uint16_t uids = std::min(uid_set.Size(),
                            (unsigned int) MAX_UIDS_PER_UNIVERSE);
-  packet.data.tod_data.uid_total = HostToNetwork(uids);
+  packet.data.tod_data.uid_total.Set(uids);
   packet.data.tod_data.uid_count = ARTNET_MAX_UID_COUNT;
 
   uint8_t (*ptr)[ola::rdm::UID::UID_SIZE] = packet.data.tod_data.tod;
@@ -806,7 +1098,7 @@ bool ArtNetNodeImpl::SendTod(uint8_t port_id, const UIDSet &uid_set) {
 }
 
 bool ArtNetNodeImpl::SetOutputPortRDMHandlers(
-    uint8_t port_id,
+    uint16_t port_id,
     ola::Callback0<void> *on_discover,
     ola::Callback0<void> *on_flush,
     ola::Callback2<void, RDMRequest*, RDMCallback*> *on_rdm_request) {
@@ -834,7 +1126,7 @@ bool ArtNetNodeImpl::SendTimeCode(const ola::timecode::TimeCode &timecode) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_TIME_CODE);
   memset(&packet.data.timecode, 0, sizeof(packet.data.timecode));
-  packet.data.timecode.version = HostToNetwork(ARTNET_VERSION);
+  packet.data.timecode.version.Set(ARTNET_VERSION);
 
   packet.data.timecode.frames = timecode.Frames();
   packet.data.timecode.seconds = timecode.Seconds();
@@ -851,17 +1143,21 @@ bool ArtNetNodeImpl::SendTimeCode(const ola::timecode::TimeCode &timecode) {
 }
 
 void ArtNetNodeImpl::SocketReady() {
-  artnet_packet packet;
-  ssize_t packet_size = sizeof(packet);
-  ola::network::IPV4SocketAddress source;
+  artnet_packet packets[RECV_BATCH_SIZE];
+  ola::network::UDPDatagram datagrams[RECV_BATCH_SIZE];
 
-  if (!m_socket->RecvFrom(reinterpret_cast<uint8_t*>(&packet),
-                          &packet_size,
-                          &source)) {
-    return;
+  for (unsigned int i = 0; i < RECV_BATCH_SIZE; i++) {
+    datagrams[i].buffer.iov_base = &packets[i];
+    datagrams[i].buffer.iov_len = sizeof(packets[i]);
   }
 
-  HandlePacket(source.Host(), packet, packet_size);
+  unsigned int received = m_socket->RecvMultiple(datagrams, RECV_BATCH_SIZE);
+  for (unsigned int i = 0; i < received; i++) {
+    m_receive_time = datagrams[i].timestamp.IsSet() ?
+        datagrams[i].timestamp : *m_ss->WakeUpTime();
+    HandlePacket(datagrams[i].address.Host(), packets[i],
+                 datagrams[i].buffer.iov_len);
+  }
 }
 
 bool ArtNetNodeImpl::SendPollIfAllowed() {
@@ -878,11 +1174,17 @@ bool ArtNetNodeImpl::SendPollIfAllowed() {
 }
 
 bool ArtNetNodeImpl::SendPollReplyIfRequired() {
+  m_poll_replies.clear();
   if (m_running && m_send_reply_on_change) {
     if (m_in_configuration_mode) {
       m_artpollreply_required = true;
     } else {
       m_unsolicited_replies++;
+      // This is broadcast, so it also answers any pending ArtPolls.
+      if (m_poll_reply_timeout != ola::thread::INVALID_TIMEOUT) {
+        m_ss->RemoveTimeout(m_poll_reply_timeout);
+        m_poll_reply_timeout = ola::thread::INVALID_TIMEOUT;
+      }
       return SendPollReply(m_interface.bcast_address);
     }
   }
@@ -890,60 +1192,143 @@ bool ArtNetNodeImpl::SendPollReplyIfRequired() {
 }
 
 bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
+  if (m_poll_replies.empty()) {
+    BuildPollReplies();
+  }
+
+  bool ok = true;
+  vector<artnet_packet>::const_iterator iter = m_poll_replies.begin();
+  for (; iter != m_poll_replies.end(); ++iter) {
+    ok &= SendPacket(*iter, sizeof(iter->data.reply), destination);
+  }
+  if (!ok) {
+    OLA_INFO << "Failed to send ArtPollReply";
+  }
+  return ok;
+}
+
+void ArtNetNodeImpl::SendPendingPollReply() {
+  m_poll_reply_timeout = ola::thread::INVALID_TIMEOUT;
+  SendPollReply(m_interface.bcast_address);
+}
+
+void ArtNetNodeImpl::BuildPollReplies() {
   artnet_packet packet;
+  PopulatePollReply(&packet.data.reply);
   PopulatePacketHeader(&packet, ARTNET_REPLY);
-  memset(&packet.data.reply, 0, sizeof(packet.data.reply));
-
-  m_interface.ip_address.Get(packet.data.reply.ip);
-  packet.data.reply.port = HostToLittleEndian(ARTNET_PORT);
-  packet.data.reply.net_address = m_net_address;
-  packet.data.reply.subnet_address = m_output_ports[0].universe_address >> 4;
-  packet.data.reply.oem = HostToNetwork(OEM_CODE);
-  packet.data.reply.status1 = 0xd2;  // normal indicators, rdm enabled
-  packet.data.reply.esta_id = HostToLittleEndian(OPEN_LIGHTING_ESTA_CODE);
-  strings::StrNCopy(packet.data.reply.short_name,
-                    m_short_name.data());
-  strings::StrNCopy(packet.data.reply.long_name,
-                    m_long_name.data());
+
+  if (!UseBindIndex()) {
+    packet.data.reply.number_ports[1] = ARTNET_MAX_PORTS;
+    for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
+      InputPort *iport = GetInputPort(i, false);
+      packet.data.reply.port_types[i] = iport ? 0xc0 : 0x80;
+      packet.data.reply.good_input[i] = iport && iport->enabled ? 0x0 : 0x8;
+      packet.data.reply.sw_in[i] = iport ? iport->PortAddress() : 0;
+
+      packet.data.reply.good_output[i] = (
+          (m_output_ports[i].enabled ? 0x80 : 0x00) |
+          (m_output_ports[i].merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
+          (m_output_ports[i].is_merging ? 0x8 : 0x0));
+      packet.data.reply.sw_out[i] = m_output_ports[i].universe_address;
+    }
+    m_poll_replies.push_back(packet);
+    return;
+  }
+
+  // Art-Net 4 style, one reply per port. The BindIndex tells the controller
+  // which replies belong together.
+  uint8_t bind_index = 1;
+  packet.data.reply.number_ports[1] = 1;
+  InputPorts::const_iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    packet.data.reply.bind_index = bind_index++;
+    packet.data.reply.net_address = (*iter)->NetAddress();
+    packet.data.reply.subnet_address = (*iter)->PortAddress() >> 4;
+    packet.data.reply.port_types[0] = 0x40;
+    packet.data.reply.good_input[0] = (*iter)->enabled ? 0x0 : 0x8;
+    packet.data.reply.sw_in[0] = (*iter)->PortAddress();
+    packet.data.reply.good_output[0] = 0;
+    packet.data.reply.sw_out[0] = 0;
+    m_poll_replies.push_back(packet);
+  }
+
+  OutputPorts::const_iterator port = m_output_ports.begin();
+  for (; port != m_output_ports.end(); ++port) {
+    packet.data.reply.bind_index = bind_index++;
+    packet.data.reply.net_address = port->net_address;
+    packet.data.reply.subnet_address = port->universe_address >> 4;
+    packet.data.reply.port_types[0] = 0x80;
+    packet.data.reply.good_input[0] = 0x8;
+    packet.data.reply.sw_in[0] = 0;
+    packet.data.reply.good_output[0] = (
+        (port->enabled ? 0x80 : 0x00) |
+        (port->merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
+        (port->is_merging ? 0x8 : 0x0));
+    packet.data.reply.sw_out[0] = port->universe_address;
+    m_poll_replies.push_back(packet);
+  }
+}
+
+void ArtNetNodeImpl::PopulatePollReply(artnet_reply_t *reply) {
+  memset(reply, 0, sizeof(*reply));
+
+  m_interface.ip_address.Get(reply->ip);
+  reply->port.Set(ARTNET_PORT);
+  reply->net_address = m_net_address;
+  reply->subnet_address = m_subnet_address;
+  reply->oem.Set(OEM_CODE);
+  reply->status1 = 0xd2;  // normal indicators, rdm enabled
+  reply->esta_id.Set(OPEN_LIGHTING_ESTA_CODE);
+  strings::StrNCopy(reply->short_name, m_short_name.data());
+  strings::StrNCopy(reply->long_name, m_long_name.data());
 
   std::ostringstream str;
   str << "#0001 [" << m_unsolicited_replies << "] OLA";
-  CopyToFixedLengthBuffer(str.str(), packet.data.reply.node_report,
-                          arraysize(packet.data.reply.node_report));
-  packet.data.reply.number_ports[1] = ARTNET_MAX_PORTS;
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    InputPort *iport = GetInputPort(i, false);
-    packet.data.reply.port_types[i] = iport ? 0xc0 : 0x80;
-    packet.data.reply.good_input[i] = iport && iport->enabled ? 0x0 : 0x8;
-    packet.data.reply.sw_in[i] = iport ? iport->PortAddress() : 0;
-
-    packet.data.reply.good_output[i] = (
-        (m_output_ports[i].enabled ? 0x80 : 0x00) |
-        (m_output_ports[i].merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
-        (m_output_ports[i].is_merging ? 0x8 : 0x0));
-    packet.data.reply.sw_out[i] = m_output_ports[i].universe_address;
-  }
-  packet.data.reply.style = NODE_CODE;
-  m_interface.hw_address.Get(packet.data.reply.mac);
-  m_interface.ip_address.Get(packet.data.reply.bind_ip);
+  CopyToFixedLengthBuffer(str.str(), reply->node_report,
+                          arraysize(reply->node_report));
+  reply->style = NODE_CODE;
+  m_interface.hw_address.Get(reply->mac);
+  m_interface.ip_address.Get(reply->bind_ip);
   // maybe set status2 here if the web UI is enabled
-  packet.data.reply.status2 = 0x08;  // node supports 15 bit port addresses
-  if (!SendPacket(packet, sizeof(packet.data.reply), destination)) {
-    OLA_INFO << "Failed to send ArtPollReply";
-    return false;
+  reply->status2 = 0x08;  // node supports 15 bit port addresses
+}
+
+/*
+ * A single ArtPollReply can only describe four ports in one net and sub-net.
+ */
+bool ArtNetNodeImpl::UseBindIndex() const {
+  if (m_input_ports.size() > ARTNET_MAX_PORTS ||
+      m_output_ports.size() != ARTNET_MAX_PORTS) {
+    return true;
   }
-  return true;
+
+  InputPorts::const_iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    if ((*iter)->NetAddress() != m_net_address ||
+        ((*iter)->PortAddress() >> 4) != m_subnet_address) {
+      return true;
+    }
+  }
+
+  OutputPorts::const_iterator port = m_output_ports.begin();
+  for (; port != m_output_ports.end(); ++port) {
+    if (port->net_address != m_net_address ||
+        (port->universe_address >> 4) != m_subnet_address) {
+      return true;
+    }
+  }
+  return false;
 }
 
 bool ArtNetNodeImpl::SendIPReply(const IPV4Address &destination) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_REPLY);
   memset(&packet.data.ip_reply, 0, sizeof(packet.data.ip_reply));
-  packet.data.ip_reply.version = HostToNetwork(ARTNET_VERSION);
+  packet.data.ip_reply.version.Set(ARTNET_VERSION);
 
   m_interface.ip_address.Get(packet.data.ip_reply.ip);
   m_interface.subnet_mask.Get(packet.data.ip_reply.subnet);
-  packet.data.ip_reply.port = HostToLittleEndian(ARTNET_PORT);
+  packet.data.ip_reply.port.Set(ARTNET_PORT);
 
   if (!SendPacket(packet, sizeof(packet.data.ip_reply), destination)) {
     OLA_INFO << "Failed to send ArtIpProgReply";
@@ -962,7 +1347,7 @@ void ArtNetNodeImpl::HandlePacket(const IPV4Address &source_address,
     return;
   }
 
-  switch (LittleEndianToHost(packet.op_code)) {
+  switch (packet.op_code.Get()) {
     case ARTNET_POLL:
       HandlePollPacket(source_address,
                        packet.data.poll,
@@ -1004,8 +1389,9 @@ void ArtNetNodeImpl::HandlePacket(const IPV4Address &source_address,
                       packet_size - header_size);
       break;
     case ARTNET_SYNC:
-      // TODO(Someone): Implement me, not currently implemented.
-      OLA_DEBUG << "ArtSync input not currently supported";
+      HandleSyncPacket(source_address,
+                       packet.data.sync,
+                       packet_size - header_size);
       break;
     case ARTNET_RDM_SUB:
       // TODO(Someone): Implement me, not currently implemented.
@@ -1017,7 +1403,7 @@ void ArtNetNodeImpl::HandlePacket(const IPV4Address &source_address,
       break;
     default:
       OLA_INFO << "Art-Net got unknown packet " << std::hex
-               << LittleEndianToHost(packet.op_code);
+               << packet.op_code.Get();
   }
 }
 
@@ -1036,9 +1422,20 @@ void ArtNetNodeImpl::HandlePollPacket(const IPV4Address &source_address,
   }
 
   m_send_reply_on_change = packet.talk_to_me & 0x02;
-  // It's unclear if this should be broadcast or unicast, stick with broadcast
-  SendPollReply(m_interface.bcast_address);
-  (void) source_address;
+
+  // It's unclear if this should be broadcast or unicast, stick with
+  // broadcast. Since it's broadcast, one reply answers every controller that
+  // polls before it's sent.
+  if (m_poll_reply_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  if (!m_poll_reply_jitter_ms) {
+    SendPollReply(m_interface.bcast_address);
+    return;
+  }
+  m_poll_reply_timeout = m_ss->RegisterSingleTimeout(
+      ola::math::Random(1, m_poll_reply_jitter_ms),
+      NewSingleCallback(this, &ArtNetNodeImpl::SendPendingPollReply));
 }
 
 void ArtNetNodeImpl::HandleReplyPacket(const IPV4Address &source_address,
@@ -1061,27 +1458,54 @@ void ArtNetNodeImpl::HandleReplyPacket(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net_address != m_net_address) {
-    OLA_DEBUG << "Received ArtPollReply for net "
-              << static_cast<int>(packet.net_address)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
 
   // Update the subscribed nodes list
+  if (m_port_index.empty()) {
+    return;
+  }
   unsigned int port_limit = std::min((uint8_t) ARTNET_MAX_PORTS,
                                      packet.number_ports[1]);
   for (unsigned int i = 0; i < port_limit; i++) {
     if (packet.port_types[i] & 0x80) {
       // port is of type output
-      uint8_t universe_id = packet.sw_out[i];
-      InputPorts::iterator iter = m_input_ports.begin();
-      for (; iter != m_input_ports.end(); ++iter) {
-        if ((*iter)->enabled && (*iter)->PortAddress() == universe_id) {
-          STLReplace(&(*iter)->subscribed_nodes, source_address,
-                     *m_ss->WakeUpTime());
-        }
+      uint16_t port_address = MakePortAddress(packet.net_address,
+                                              packet.sw_out[i]);
+      PortIndex::const_iterator iter = FirstInputPort(port_address);
+      for (; iter != m_port_index.end() && iter->first == port_address;
+           ++iter) {
+        iter->second->subscribers.Update(source_address, *m_ss->WakeUpTime());
+      }
+    }
+  }
+}
+
+void ArtNetNodeImpl::HandleSyncPacket(const IPV4Address &source_address,
+                                      const artnet_sync_t &packet,
+                                      unsigned int packet_size) {
+  // We'll see our own ArtSyncs, don't let them hold the data from other
+  // controllers.
+  if (m_interface.ip_address == source_address) {
+    return;
+  }
+
+  if (!CheckPacketSize(source_address,
+                       "ArtSync",
+                       packet_size,
+                       sizeof(packet))) {
+    return;
+  }
+
+  if (!CheckPacketVersion(source_address, "ArtSync", packet.version)) {
+    return;
+  }
+
+  m_last_sync = *m_ss->WakeUpTime();
+  for (OutputPorts::iterator port = m_output_ports.begin();
+       port != m_output_ports.end(); ++port) {
+    if (port->sync_pending) {
+      port->sync_pending = false;
+      if (port->enabled && port->on_data) {
+        port->on_data->Run();
       }
     }
   }
@@ -1103,30 +1527,30 @@ void ArtNetNodeImpl::HandleDataPacket(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtDmx for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
 
-  uint16_t universe_id = LittleEndianToHost(packet.universe);
+  // The universe field is only 8 bits wide, the net is sent separately.
+  uint16_t port_address = MakePortAddress(packet.net, packet.universe);
   uint16_t data_size = std::min(
       (unsigned int) ((packet.length[0] << 8) + packet.length[1]),
       packet_size - header_size);
 
-  for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-    if (m_output_ports[port_id].enabled &&
-        m_output_ports[port_id].universe_address == universe_id &&
-        m_output_ports[port_id].on_data &&
-        m_output_ports[port_id].buffer) {
+  uint16_t port_id = m_output_port_table[port_address];
+  if (port_id && m_receive_stats) {
+    UpdateReceiveStats(&m_output_ports[port_id - 1], port_address,
+                       source_address, packet.sequence);
+  }
+
+  while (port_id) {
+    OutputPort *port = &m_output_ports[port_id - 1];
+    if (port->on_data && port->buffer) {
       // update this port, doing a merge if necessary
       DMXSource source;
       source.address = source_address;
-      source.timestamp = *m_ss->WakeUpTime();
+      source.timestamp = m_receive_time;
       source.buffer.Set(packet.data, data_size);
-      UpdatePortFromSource(&m_output_ports[port_id], source);
+      UpdatePortFromSource(port, source);
     }
+    port_id = port->next_port;
   }
 }
 
@@ -1143,13 +1567,6 @@ void ArtNetNodeImpl::HandleTodRequest(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodRequest for net "
-              << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
 
   if (packet.command) {
     OLA_INFO << "ArtTodRequest received but command field was "
@@ -1165,18 +1582,18 @@ void ArtNetNodeImpl::HandleTodRequest(const IPV4Address &source_address,
       static_cast<unsigned int>(ARTNET_MAX_RDM_ADDRESS_COUNT),
       addresses);
 
-  bool handler_called[ARTNET_MAX_PORTS];
-  memset(handler_called, 0, sizeof(handler_called));
+  vector<bool> handler_called(m_output_ports.size(), false);
 
   for (unsigned int i = 0; i < addresses; i++) {
-    for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-      if (m_output_ports[port_id].enabled &&
-          m_output_ports[port_id].universe_address == packet.addresses[i] &&
-          m_output_ports[port_id].on_discover &&
-          !handler_called[port_id]) {
-        m_output_ports[port_id].on_discover->Run();
-        handler_called[port_id] = true;
+    uint16_t port_id = m_output_port_table[
+        MakePortAddress(packet.net, packet.addresses[i])];
+    while (port_id) {
+      OutputPort *port = &m_output_ports[port_id - 1];
+      if (port->on_discover && !handler_called[port_id - 1]) {
+        port->on_discover->Run();
+        handler_called[port_id - 1] = true;
       }
+      port_id = port->next_port;
     }
   }
 }
@@ -1200,12 +1617,6 @@ void ArtNetNodeImpl::HandleTodData(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodData for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
 
   if (packet.command_response) {
     OLA_WARN << "Command response " << ToHex(packet.command_response)
@@ -1213,11 +1624,10 @@ void ArtNetNodeImpl::HandleTodData(const IPV4Address &source_address,
     return;
   }
 
-  InputPorts::iterator iter = m_input_ports.begin();
-  for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
-      UpdatePortFromTodPacket(*iter, source_address, packet, packet_size);
-    }
+  uint16_t port_address = MakePortAddress(packet.net, packet.address);
+  PortIndex::const_iterator iter = FirstInputPort(port_address);
+  for (; iter != m_port_index.end() && iter->first == port_address; ++iter) {
+    UpdatePortFromTodPacket(iter->second, source_address, packet, packet_size);
   }
 }
 
@@ -1233,24 +1643,19 @@ void ArtNetNodeImpl::HandleTodControl(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodControl for net "
-              << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
 
   if (packet.command != TOD_FLUSH_COMMAND) {
     return;
   }
 
-  for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-    if (m_output_ports[port_id].enabled &&
-        m_output_ports[port_id].universe_address == packet.address &&
-        m_output_ports[port_id].on_flush) {
-      m_output_ports[port_id].on_flush->Run();
+  uint16_t port_id = m_output_port_table[
+      MakePortAddress(packet.net, packet.address)];
+  while (port_id) {
+    OutputPort *port = &m_output_ports[port_id - 1];
+    if (port->on_flush) {
+      port->on_flush->Run();
     }
+    port_id = port->next_port;
   }
 }
 
@@ -1277,64 +1682,60 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtRDM for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
 
   unsigned int rdm_length = packet_size - header_size;
   if (!rdm_length) {
     return;
   }
 
+  uint16_t port_address = MakePortAddress(packet.net, packet.address);
+
   // look for the port that this was sent to, once we know the port we can try
   // to parse the message
-  for (uint8_t port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-    if (m_output_ports[port_id].enabled &&
-        m_output_ports[port_id].universe_address == packet.address &&
-        m_output_ports[port_id].on_rdm_request) {
+  uint16_t port_id = m_output_port_table[port_address];
+  while (port_id) {
+    OutputPort *port = &m_output_ports[port_id - 1];
+    if (port->on_rdm_request) {
       RDMRequest *request = RDMRequest::InflateFromData(packet.data,
                                                         rdm_length);
 
       if (request) {
-        m_output_ports[port_id].on_rdm_request->Run(
+        port->on_rdm_request->Run(
             request,
             NewSingleCallback(this,
                               &ArtNetNodeImpl::RDMRequestCompletion,
                               source_address,
-                              port_id,
-                              m_output_ports[port_id].universe_address));
+                              static_cast<uint16_t>(port_id - 1),
+                              port_address));
       }
     }
+    port_id = port->next_port;
   }
 
   // The Art-Net packet does not include the RDM start code. Prepend that.
   RDMFrame rdm_response(packet.data, rdm_length, RDMFrame::Options(true));
 
-  InputPorts::iterator iter = m_input_ports.begin();
-  for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
-      HandleRDMResponse(*iter, rdm_response, source_address);
-    }
+  PortIndex::const_iterator iter = FirstInputPort(port_address);
+  for (; iter != m_port_index.end() && iter->first == port_address; ++iter) {
+    HandleRDMResponse(iter->second, rdm_response, source_address);
   }
 }
 
 void ArtNetNodeImpl::RDMRequestCompletion(
     IPV4Address destination,
-    uint8_t port_id,
-    uint8_t universe_address,
+    uint16_t port_id,
+    uint16_t port_address,
     RDMReply *reply) {
   OutputPort *port = GetEnabledOutputPort(port_id, "ArtRDM");
   if (!port) {
     return;
   }
 
-  if (port->universe_address == universe_address) {
+  if (MakePortAddress(port->net_address, port->universe_address) ==
+      port_address) {
     if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK) {
       // TODO(simon): handle fragmenation here
-      SendRDMCommand(*reply->Response(), destination, universe_address);
+      SendRDMCommand(*reply->Response(), destination, port_address);
     } else if (reply->StatusCode() == ola::rdm::RDM_UNKNOWN_UID) {
       // call the on discovery handler, which will send a new TOD and
       // hopefully update the remote controller
@@ -1448,13 +1849,168 @@ void ArtNetNodeImpl::PopulatePacketHeader(artnet_packet *packet,
                                           uint16_t op_code) {
   CopyToFixedLengthBuffer(ARTNET_ID, reinterpret_cast<char*>(packet->id),
                           arraysize(packet->id));
-  packet->op_code = HostToLittleEndian(op_code);
+  packet->op_code.Set(op_code);
+}
+
+bool ArtNetNodeImpl::AppendDMXDatagrams(InputPort *port,
+                                        vector<UDPDatagram> *datagrams) {
+  if (port->subscribers.Size() >= m_broadcast_threshold ||
+      m_always_broadcast) {
+    UDPDatagram datagram;
+    port->dmx_builder.ToDatagram(
+        IPV4SocketAddress(m_use_limited_broadcast_address ?
+                          IPV4Address::Broadcast() :
+                          m_interface.bcast_address,
+                          ARTNET_PORT),
+        &datagram);
+    datagrams->push_back(datagram);
+    port->sequence_number++;
+    return true;
+  }
+
+  if (port->subscribers.Empty()) {
+    return false;
+  }
+  port->subscribers.AppendDatagrams(port->dmx_builder, datagrams);
+  port->sequence_number++;
+  return true;
+}
+
+void ArtNetNodeImpl::UpdatePortIndex() {
+  m_poll_replies.clear();
+  PortIndex::const_iterator old_iter = m_port_index.begin();
+  for (; old_iter != m_port_index.end(); ++old_iter) {
+    m_input_port_table[old_iter->first] = 0;
+  }
+
+  m_port_index.clear();
+  InputPorts::iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    if ((*iter)->enabled) {
+      m_port_index.push_back(
+          PortIndexEntry((*iter)->FullPortAddress(), *iter));
+    }
+  }
+  std::stable_sort(m_port_index.begin(), m_port_index.end(),
+                   PortAddressLessThan);
+
+  for (unsigned int i = m_port_index.size(); i > 0; i--) {
+    m_input_port_table[m_port_index[i - 1].first] = i;
+  }
+}
+
+ArtNetNodeImpl::PortIndex::const_iterator ArtNetNodeImpl::FirstInputPort(
+    uint16_t port_address) const {
+  const uint16_t entry = port_address < PORT_ADDRESS_COUNT ?
+      m_input_port_table[port_address] : 0;
+  return entry ? m_port_index.begin() + (entry - 1) : m_port_index.end();
+}
+
+/*
+ * Each entry in the table holds the first enabled output port (plus one) for
+ * that Port-Address, the remaining ports are chained through next_port.
+ */
+void ArtNetNodeImpl::UpdateOutputPortTable() {
+  m_poll_replies.clear();
+  std::fill(m_output_port_table.begin(), m_output_port_table.end(), 0);
+  for (unsigned int i = m_output_ports.size(); i > 0; i--) {
+    OutputPort *port = &m_output_ports[i - 1];
+    if (!port->enabled) {
+      continue;
+    }
+    uint16_t port_address = MakePortAddress(port->net_address,
+                                            port->universe_address);
+    port->next_port = m_output_port_table[port_address];
+    m_output_port_table[port_address] = i;
+    if (m_receive_stats) {
+      port->stats = m_receive_stats->Get(IntToString(port_address));
+    }
+  }
+}
+
+bool ArtNetNodeImpl::ExpireSubscribers() {
+  TimeStamp last_heard_threshold = (
+      *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
+  InputPorts::iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    (*iter)->subscribers.Expire(last_heard_threshold);
+  }
+
+  SourceStatsMap::iterator stats_iter = m_source_stats.begin();
+  while (stats_iter != m_source_stats.end()) {
+    if (stats_iter->second.last_heard < last_heard_threshold) {
+      m_receive_stats->Remove(SourceStatsKey(stats_iter->first));
+      m_source_stats.erase(stats_iter++);
+    } else {
+      ++stats_iter;
+    }
+  }
+  return true;
+}
+
+bool ArtNetNodeImpl::PortAddressLessThan(const PortIndexEntry &a,
+                                         const PortIndexEntry &b) {
+  return a.first < b.first;
+}
+
+void ArtNetNodeImpl::FlushDMX() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+
+  vector<UDPDatagram> datagrams;
+  InputPorts::iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    InputPort *port = *iter;
+    if (port->dmx_pending) {
+      port->dmx_pending = false;
+      if (port->enabled) {
+        AppendDMXDatagrams(port, &datagrams);
+      }
+    }
+  }
+
+  if (datagrams.empty()) {
+    return;
+  }
+
+  unsigned int sent = SendDatagrams(datagrams);
+  if (sent != datagrams.size()) {
+    OLA_WARN << "Only sent " << sent << " of " << datagrams.size()
+             << " Art-Net DMX packets";
+  }
+  SendSync();
+}
+
+bool ArtNetNodeImpl::SendSync() {
+  artnet_packet packet;
+  PopulatePacketHeader(&packet, ARTNET_SYNC);
+  memset(&packet.data.sync, 0, sizeof(packet.data.sync));
+  packet.data.sync.version.Set(ARTNET_VERSION);
+  return SendPacket(packet,
+                    sizeof(packet.data.sync),
+                    m_use_limited_broadcast_address ?
+                    IPV4Address::Broadcast() :
+                    m_interface.bcast_address);
+}
+
+bool ArtNetNodeImpl::SyncActive() const {
+  return (m_last_sync.IsSet() &&
+          *m_ss->WakeUpTime() < m_last_sync + TimeInterval(SYNC_TIMEOUT, 0));
 }
 
 bool ArtNetNodeImpl::SendPacket(const artnet_packet &packet,
                                 unsigned int size,
                                 const IPV4Address &ip_destination) {
   size += sizeof(packet.id) + sizeof(packet.op_code);
+  if (m_transmit_pacer) {
+    UDPDatagram datagram;
+    datagram.buffer.iov_base = const_cast<artnet_packet*>(&packet);
+    datagram.buffer.iov_len = size;
+    datagram.address = IPV4SocketAddress(ip_destination, ARTNET_PORT);
+    m_transmit_pacer->Send(m_socket.get(), m_interface.ip_address, &datagram,
+                           1);
+    return true;
+  }
+
   unsigned int bytes_sent = m_socket->SendTo(
       reinterpret_cast<const uint8_t*>(&packet),
       size,
@@ -1467,6 +2023,16 @@ bool ArtNetNodeImpl::SendPacket(const artnet_packet &packet,
   return true;
 }
 
+unsigned int ArtNetNodeImpl::SendDatagrams(
+    const vector<UDPDatagram> &datagrams) {
+  if (m_transmit_pacer) {
+    m_transmit_pacer->Send(m_socket.get(), m_interface.ip_address,
+                           &datagrams[0], datagrams.size());
+    return datagrams.size();
+  }
+  return m_socket->SendMultiple(&datagrams[0], datagrams.size());
+}
+
 void ArtNetNodeImpl::TimeoutRDMRequest(InputPort *port) {
   OLA_INFO << "RDM Request timed out.";
   port->rdm_send_timeout = ola::thread::INVALID_TIMEOUT;
@@ -1479,14 +2045,14 @@ void ArtNetNodeImpl::TimeoutRDMRequest(InputPort *port) {
 
 bool ArtNetNodeImpl::SendRDMCommand(const RDMCommand &command,
                                     const IPV4Address &destination,
-                                    uint8_t universe) {
+                                    uint16_t port_address) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_RDM);
   memset(&packet.data.rdm, 0, sizeof(packet.data.rdm));
-  packet.data.rdm.version = HostToNetwork(ARTNET_VERSION);
+  packet.data.rdm.version.Set(ARTNET_VERSION);
   packet.data.rdm.rdm_version = RDM_VERSION;
-  packet.data.rdm.net = m_net_address;
-  packet.data.rdm.address = universe;
+  packet.data.rdm.net = port_address >> 8;
+  packet.data.rdm.address = port_address & 0xff;
   unsigned int rdm_size = ARTNET_MAX_RDM_DATA;
   if (!RDMCommandSerializer::Pack(command, packet.data.rdm.data, &rdm_size)) {
     OLA_WARN << "Failed to construct RDM command";
@@ -1537,7 +2103,10 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
       return;
     }
     if (active_sources == 0) {
-      port->is_merging = false;
+      if (port->is_merging) {
+        port->is_merging = false;
+        m_poll_replies.clear();
+      }
     } else {
       OLA_INFO << "Entered merge mode for universe "
                << static_cast<int>(port->universe_address);
@@ -1545,8 +2114,9 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
       SendPollReplyIfRequired();
     }
     source_slot = first_empty_slot;
-  } else if (active_sources == 1) {
+  } else if (active_sources == 1 && port->is_merging) {
     port->is_merging = false;
+    m_poll_replies.clear();
   }
 
   port->sources[source_slot] = source;
@@ -1569,15 +2139,47 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
       }
     }
   }
-  port->on_data->Run();
+
+  // ArtSync is ignored while merging, as per the spec.
+  if (SyncActive() && !port->is_merging) {
+    port->sync_pending = true;
+  } else {
+    port->sync_pending = false;
+    port->on_data->Run();
+  }
+}
+
+void ArtNetNodeImpl::UpdateReceiveStats(OutputPort *port,
+                                        uint16_t port_address,
+                                        const IPV4Address &source_address,
+                                        uint8_t sequence) {
+  const TimeStamp &now = m_receive_time;
+  const pair<uint16_t, IPV4Address> key(port_address, source_address);
+  SourceStatsMap::iterator iter = m_source_stats.find(key);
+  if (iter == m_source_stats.end()) {
+    SourceStats source_stats;
+    source_stats.stats = m_receive_stats->Get(SourceStatsKey(key));
+    iter = m_source_stats.insert(std::make_pair(key, source_stats)).first;
+  }
+  iter->second.last_heard = *m_ss->WakeUpTime();
+
+  // A sequence number of 0 means the sender doesn't use them.
+  ReceiveStats *stats = iter->second.stats;
+  int missed = sequence ? stats->CheckSequence(sequence, true) : 0;
+  stats->PacketReceived(now, missed);
+  port->stats->PacketReceived(now, missed);
+}
+
+string ArtNetNodeImpl::SourceStatsKey(const SourceStatsMap::key_type &key) {
+  return IntToString(key.first) + "/" + key.second.ToString();
 }
 
 bool ArtNetNodeImpl::CheckPacketVersion(const IPV4Address &source_address,
                                         const string &packet_type,
-                                        uint16_t version) {
-  if (NetworkToHost(version) != ARTNET_VERSION) {
+                                        const BigEndian<uint16_t> &version) {
+  if (version.Get() != ARTNET_VERSION) {
     OLA_INFO << packet_type << " version mismatch, was "
-             << NetworkToHost(version) << " from " << source_address;
+             << version.Get() << " from " << source_address;
     return false;
   }
   return true;
@@ -1596,7 +2198,7 @@ bool ArtNetNodeImpl::CheckPacketSize(const IPV4Address &source_address,
   return true;
 }
 
-ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(uint8_t port_id,
+ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(uint16_t port_id,
                                                         bool warn) {
   if (port_id >= m_input_ports.size()) {
     if (warn) {
@@ -1609,7 +2211,7 @@ ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(uint8_t port_id,
 }
 
 const ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(
-    uint8_t port_id) const {
+    uint16_t port_id) const {
   if (port_id >= m_input_ports.size()) {
     OLA_WARN << "Port index out of bounds: "
              << static_cast<int>(port_id) << " >= " << m_input_ports.size();
@@ -1619,7 +2221,7 @@ const ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(
 }
 
 ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetEnabledInputPort(
-    uint8_t port_id,
+    uint16_t port_id,
     const string &action) {
   if (!m_running) {
     return NULL;
@@ -1633,27 +2235,27 @@ ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetEnabledInputPort(
   return ok ? port : NULL;
 }
 
-ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetOutputPort(uint8_t port_id) {
-  if (port_id >= ARTNET_MAX_PORTS) {
+ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetOutputPort(uint16_t port_id) {
+  if (port_id >= m_output_ports.size()) {
     OLA_WARN << "Port index out of bounds: "
-             << static_cast<int>(port_id) << " >= " << ARTNET_MAX_PORTS;
+             << static_cast<int>(port_id) << " >= " << m_output_ports.size();
     return NULL;
   }
   return &m_output_ports[port_id];
 }
 
 const ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetOutputPort(
-    uint8_t port_id) const {
-  if (port_id >= ARTNET_MAX_PORTS) {
+    uint16_t port_id) const {
+  if (port_id >= m_output_ports.size()) {
     OLA_WARN << "Port index out of bounds: "
-             << static_cast<int>(port_id) << " >= " << ARTNET_MAX_PORTS;
+             << static_cast<int>(port_id) << " >= " << m_output_ports.size();
     return NULL;
   }
   return &m_output_ports[port_id];
 }
 
 ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetEnabledOutputPort(
-    uint8_t port_id,
+    uint16_t port_id,
     const string &action) {
   if (!m_running) {
     return NULL;
@@ -1683,6 +2285,11 @@ bool ArtNetNodeImpl::InitNetwork() {
     return false;
   }
 
+  if (m_use_receive_timestamps && !m_socket->EnableReceiveTimestamps()) {
+    OLA_WARN << "Receive timestamps aren't supported, using the event loop "
+                "time instead";
+  }
+
   m_socket->SetOnData(NewCallback(this, &ArtNetNodeImpl::SocketReady));
   m_ss->AddReadDescriptor(m_socket.get());
   return true;
@@ -1698,36 +2305,89 @@ void ArtNetNodeImpl::UpdatePortFromTodPacket(InputPort *port,
 
   OLA_DEBUG << "Got TOD data packet with " << uid_count << " UIDs";
   uid_map &port_uids = port->uids;
-  UIDSet uid_set;
-
-  for (unsigned int i = 0; i < uid_count; i++) {
-    UID uid(packet.tod[i]);
-    uid_set.AddUID(uid);
-    uid_map::iterator iter = port_uids.find(uid);
-    if (iter == port_uids.end()) {
-      port_uids[uid] = std::pair<IPV4Address, uint8_t>(source_address, 0);
-    } else {
-      if (iter->second.first != source_address) {
-        OLA_WARN << "UID " << uid << " changed from "
-                 << iter->second.first << " to " << source_address;
-        iter->second.first = source_address;
+  GatewayTod &tod = port->gateway_tods[source_address];
+  if (tod.uid_total != packet.uid_total.Get()) {
+    // The gateway's TOD has changed size, the blocks we have are stale.
+    tod.blocks.clear();
+    tod.uid_total = packet.uid_total.Get();
+    tod.needs_prune = true;
+  }
+
+  const uint32_t checksum = TodChecksum(packet, uid_count);
+  map<uint8_t, GatewayTod::Block>::iterator block_iter =
+      tod.blocks.find(packet.block_count);
+  bool uids_changed = false;
+
+  if (block_iter != tod.blocks.end() &&
+      block_iter->second.checksum == checksum &&
+      block_iter->second.uids.size() == uid_count) {
+    // A repeat of a block we've already seen, just reset the missed counts.
+    vector<UID>::const_iterator uid_iter = block_iter->second.uids.begin();
+    for (; uid_iter != block_iter->second.uids.end(); ++uid_iter) {
+      uid_map::iterator iter = port_uids.find(*uid_iter);
+      if (iter != port_uids.end() && iter->second.first == source_address) {
+        iter->second.second = 0;
+      }
+    }
+  } else {
+    GatewayTod::Block &block = tod.blocks[packet.block_count];
+    block.checksum = checksum;
+    block.uids.clear();
+    block.uids.reserve(uid_count);
+    tod.needs_prune = true;
+
+    for (unsigned int i = 0; i < uid_count; i++) {
+      UID uid(packet.tod[i]);
+      block.uids.push_back(uid);
+      uid_map::iterator iter = port_uids.find(uid);
+      if (iter == port_uids.end()) {
+        port_uids[uid] = std::pair<IPV4Address, uint8_t>(source_address, 0);
+        uids_changed = true;
+      } else {
+        if (iter->second.first != source_address) {
+          OLA_WARN << "UID " << uid << " changed from "
+                   << iter->second.first << " to " << source_address;
+          // The old gateway's cached TOD no longer matches the UID map.
+          port->gateway_tods.erase(iter->second.first);
+          iter->second.first = source_address;
+          uids_changed = true;
+        }
+        iter->second.second = 0;
       }
-      iter->second.second = 0;
     }
   }
 
-  // If this is the one and only block from this node, we can remove all uids
-  // that don't appear in it.
+  // Once we have all the blocks from this node, we can remove all uids
+  // that don't appear in them. Blocks may be dropped, so until then we rely
+  // on the RDM_MISSED_TODDATA_LIMIT to clean up.
   // There is a bug in Art-Net nodes where sometimes UidCount > UidTotal.
-  if (uid_count >= NetworkToHost(packet.uid_total)) {
-    uid_map::iterator iter = port_uids.begin();
-    while (iter != port_uids.end()) {
-      if (iter->second.first == source_address &&
-          !uid_set.Contains(iter->first)) {
-        port_uids.erase(iter++);
-      } else {
-        ++iter;
+  unsigned int cached_uids = 0;
+  map<uint8_t, GatewayTod::Block>::const_iterator cached_iter =
+      tod.blocks.begin();
+  for (; cached_iter != tod.blocks.end(); ++cached_iter) {
+    cached_uids += cached_iter->second.uids.size();
+  }
+
+  if (cached_uids >= tod.uid_total) {
+    if (tod.needs_prune) {
+      set<UID> gateway_uids;
+      for (cached_iter = tod.blocks.begin(); cached_iter != tod.blocks.end();
+           ++cached_iter) {
+        gateway_uids.insert(cached_iter->second.uids.begin(),
+                            cached_iter->second.uids.end());
       }
+
+      uid_map::iterator iter = port_uids.begin();
+      while (iter != port_uids.end()) {
+        if (iter->second.first == source_address &&
+            !STLContains(gateway_uids, iter->first)) {
+          port_uids.erase(iter++);
+          uids_changed = true;
+        } else {
+          ++iter;
+        }
+      }
+      tod.needs_prune = false;
     }
 
     // mark this node as complete
@@ -1742,14 +2402,9 @@ void ArtNetNodeImpl::UpdatePortFromTodPacket(InputPort *port,
     }
   }
 
-  // Removing uids from multi-block messages is much harder as you need to
-  // consider dropped packets. For the moment we rely on the
-  // RDM_MISSED_TODDATA_LIMIT to clean these up.
-  // TODO(simon): figure this out sometime
-
   // if we're not in the middle of a discovery process, send an unsolicited
-  // update if we have a callback
-  if (!port->discovery_callback)
+  // update if we have a callback and the set of UIDs has changed.
+  if (!port->discovery_callback && uids_changed)
     port->RunTodCallback();
 }
 
@@ -1770,10 +2425,8 @@ bool ArtNetNodeImpl::StartDiscoveryProcess(InputPort *port,
   // these nodes. If ArtTod packets arrive after discovery completes, we'll
   // call the unsolicited handler
   port->discovery_node_set.clear();
-  map<IPV4Address, TimeStamp>::const_iterator node_iter =
-      port->subscribed_nodes.begin();
-  for (; node_iter != port->subscribed_nodes.end(); node_iter++)
-    port->discovery_node_set.insert(node_iter->first);
+  const vector<IPV4Address> &addresses = port->subscribers.Addresses();
+  port->discovery_node_set.insert(addresses.begin(), addresses.end());
 
   port->discovery_timeout = m_ss->RegisterSingleTimeout(
       RDM_TOD_TIMEOUT_MS,
@@ -1791,6 +2444,8 @@ void ArtNetNodeImpl::ReleaseDiscoveryLock(InputPort *port) {
   uid_map::iterator iter = port->uids.begin();
   while (iter != port->uids.end()) {
     if (iter->second.second == RDM_MISSED_TODDATA_LIMIT) {
+      // Make sure the next TOD from this gateway is processed in full.
+      port->gateway_tods.erase(iter->second.first);
       port->uids.erase(iter++);
     } else {
       ++iter;
@@ -1820,7 +2475,7 @@ ArtNetNode::~ArtNetNode() {
   STLDeleteElements(&m_wrappers);
 }
 
-void ArtNetNode::RunFullDiscovery(uint8_t port_id,
+void ArtNetNode::RunFullDiscovery(uint16_t port_id,
                                   RDMDiscoveryCallback *callback) {
   if (!CheckInputPortId(port_id)) {
     ola::rdm::UIDSet uids;
@@ -1830,7 +2485,7 @@ void ArtNetNode::RunFullDiscovery(uint8_t port_id,
   }
 }
 
-void ArtNetNode::RunIncrementalDiscovery(uint8_t port_id,
+void ArtNetNode::RunIncrementalDiscovery(uint16_t port_id,
                                          RDMDiscoveryCallback *callback) {
   if (!CheckInputPortId(port_id)) {
     ola::rdm::UIDSet uids;
@@ -1840,7 +2495,7 @@ void ArtNetNode::RunIncrementalDiscovery(uint8_t port_id,
   }
 }
 
-void ArtNetNode::SendRDMRequest(uint8_t port_id, RDMRequest *request,
+void ArtNetNode::SendRDMRequest(uint16_t port_id, RDMRequest *request,
                                 RDMCallback *on_complete) {
   if (!CheckInputPortId(port_id)) {
     RunRDMCallback(on_complete, ola::rdm::RDM_FAILED_TO_SEND);
@@ -1850,7 +2505,7 @@ void ArtNetNode::SendRDMRequest(uint8_t port_id, RDMRequest *request,
   }
 }
 
-bool ArtNetNode::CheckInputPortId(uint8_t port_id) {
+bool ArtNetNode::CheckInputPortId(uint16_t port_id) {
   if (port_id >= m_controllers.size()) {
     OLA_WARN << "Port index out of bounds: " << static_cast<int>(port_id)
              << " >= " << m_controllers.size();
@@ -30,10 +30,13 @@
 #include "ola/Callback.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/dmx/ReceiveStats.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Interface.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/Socket.h"
+#include "ola/network/TransmitPacer.h"
 #include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMFrame.h"
@@ -69,14 +72,37 @@ class ArtNetNodeOptions {
         use_limited_broadcast_address(false),
         rdm_queue_size(20),
         broadcast_threshold(30),
-        input_port_count(4) {
+        input_port_count(4),
+        output_port_count(ARTNET_MAX_PORTS),
+        use_art_sync(false),
+        use_receive_timestamps(false),
+        poll_reply_jitter_ms(1000),
+        export_map(NULL),
+        transmit_pacer(NULL) {
   }
 
   bool always_broadcast;
   bool use_limited_broadcast_address;
   unsigned int rdm_queue_size;
   unsigned int broadcast_threshold;
-  uint8_t input_port_count;
+  uint16_t input_port_count;
+  uint16_t output_port_count;
+  // Batch the ArtDmx packets sent in each event loop pass and follow them
+  // with an ArtSync.
+  bool use_art_sync;
+  // Ask the kernel to timestamp incoming packets, so LastReceiveTime() is the
+  // time the packet arrived rather than when the event loop woke up.
+  bool use_receive_timestamps;
+  // Replies to ArtPolls are delayed by a random time, between 1 and this many
+  // ms, so a large number of nodes don't all reply at once. ArtPolls that arrive
+  // while a reply is pending share it. 0 replies straight away.
+  unsigned int poll_reply_jitter_ms;
+  // If set, receive statistics for each output port and source are stored
+  // here.
+  ola::ExportMap *export_map;
+  // If set, outgoing packets are queued with this pacer rather than being
+  // sent immediately.
+  ola::network::TransmitPacer *transmit_pacer;
 };
 
 
@@ -162,20 +188,18 @@ class ArtNetNodeImpl {
    * @param subnet_address the Art-Net 'subnet' address, 4 bits.
    */
   bool SetSubnetAddress(uint8_t subnet_address);
-  uint8_t SubnetAddress() const {
-    return m_output_ports[0].universe_address >> 4;
-  }
+  uint8_t SubnetAddress() const { return m_subnet_address; }
 
   /**
    * Get the number of input ports
    * @returns the number of input ports
    */
-  uint8_t InputPortCount() const;
+  uint16_t InputPortCount() const;
 
   /**
    * Set the universe address of an input port
    */
-  bool SetInputPortUniverse(uint8_t port_id, uint8_t universe_id);
+  bool SetInputPortUniverse(uint16_t port_id, uint8_t universe_id);
 
   /**
    * @brief Get an input port universe address
@@ -185,13 +209,13 @@ class ArtNetNodeImpl {
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
    * @return The universe address for the port. Invalid port_ids return 0.
    */
-  uint8_t GetInputPortUniverse(uint8_t port_id) const;
+  uint8_t GetInputPortUniverse(uint16_t port_id) const;
 
   /**
    * @brief Disable an input port.
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
    */
-  void DisableInputPort(uint8_t port_id);
+  void DisableInputPort(uint16_t port_id);
 
   /**
    * @brief Check the state of an input port
@@ -199,27 +223,27 @@ class ArtNetNodeImpl {
    * @return the state (enabled or disabled) of an input port. An invalid
    * port_id returns false.
    */
-  bool InputPortState(uint8_t port_id) const;
+  bool InputPortState(uint16_t port_id) const;
 
   /**
    * @brief Set the universe for an output port.
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
    * @param universe_id the new universe id.
    */
-  bool SetOutputPortUniverse(uint8_t port_id, uint8_t universe_id);
+  bool SetOutputPortUniverse(uint16_t port_id, uint8_t universe_id);
 
   /**
    * Return the current universe address for an output port
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
    * @return the universe address for the port
    */
-  uint8_t GetOutputPortUniverse(uint8_t port_id);
+  uint8_t GetOutputPortUniverse(uint16_t port_id);
 
   /**
    * @brief Disable an output port.
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
    */
-  void DisableOutputPort(uint8_t port_id);
+  void DisableOutputPort(uint16_t port_id);
 
   /**
    * @brief Check the state of an output port
@@ -227,7 +251,47 @@ class ArtNetNodeImpl {
    * @return the state (enabled or disabled) of an output port. An invalid
    * port_id returns false.
    */
-  bool OutputPortState(uint8_t port_id) const;
+  bool OutputPortState(uint16_t port_id) const;
+
+  /**
+   * Get the number of output ports
+   * @returns the number of output ports
+   */
+  uint16_t OutputPortCount() const;
+
+  /**
+   * @brief Set the 15 bit Port-Address of an input port.
+   *
+   * Unlike SetInputPortUniverse(), this sets the Net and Sub-Net of the port
+   * as well, which allows each port to use any address in the Art-Net 4
+   * address space.
+   * @param port_id a port id between 0 and InputPortCount() - 1
+   * @param port_address the Port-Address, the Net is in bits 14-8, the Sub-Net
+   * in bits 7-4 and the Universe in bits 3-0.
+   */
+  bool SetInputPortAddress(uint16_t port_id, uint16_t port_address);
+
+  /**
+   * @brief Get the 15 bit Port-Address of an input port
+   * @param port_id a port id between 0 and InputPortCount() - 1
+   * @return The Port-Address for the port. Invalid port_ids return 0.
+   */
+  uint16_t GetInputPortAddress(uint16_t port_id) const;
+
+  /**
+   * @brief Set the 15 bit Port-Address of an output port.
+   * @param port_id a port id between 0 and OutputPortCount() - 1
+   * @param port_address the Port-Address
+   * @sa SetInputPortAddress
+   */
+  bool SetOutputPortAddress(uint16_t port_id, uint16_t port_address);
+
+  /**
+   * @brief Get the 15 bit Port-Address of an output port
+   * @param port_id a port id between 0 and OutputPortCount() - 1
+   * @return The Port-Address for the port. Invalid port_ids return 0.
+   */
+  uint16_t GetOutputPortAddress(uint16_t port_id) const;
 
   void SetBroadcastThreshold(unsigned int threshold) {
     m_broadcast_threshold = threshold;
@@ -238,7 +302,7 @@ class ArtNetNodeImpl {
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
    * @param merge_mode the artnet_merge_mode
    */
-  bool SetMergeMode(uint8_t port_id, artnet_merge_mode merge_mode);
+  bool SetMergeMode(uint16_t port_id, artnet_merge_mode merge_mode);
 
   /**
    * @brief Send an ArtPoll if any of the ports are sending data
@@ -253,8 +317,12 @@ class ArtNetNodeImpl {
    * @param port_id port to send on
    * @param buffer the DMX data
    * @return true if it was sent successfully, false otherwise
+   *
+   * If use_art_sync is set, the packet is queued and sent, along with those
+   * for any other ports updated during this pass of the event loop, followed
+   * by a single ArtSync.
    */
-  bool SendDMX(uint8_t port_id, const ola::DmxBuffer &buffer);
+  bool SendDMX(uint16_t port_id, const ola::DmxBuffer &buffer);
 
   /**
    * @brief Flush the TOD and force a full discovery.
@@ -264,7 +332,7 @@ class ArtNetNodeImpl {
    * @param port_id port to discover on
    * @param callback the RDMDiscoveryCallback to run when discovery completes
    */
-  void RunFullDiscovery(uint8_t port_id,
+  void RunFullDiscovery(uint16_t port_id,
                         ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
@@ -276,7 +344,7 @@ class ArtNetNodeImpl {
    * @param port_id port to send on
    * @param callback the RDMDiscoveryCallback to run when discovery completes
    */
-  void RunIncrementalDiscovery(uint8_t port_id,
+  void RunIncrementalDiscovery(uint16_t port_id,
                                ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
@@ -291,18 +359,19 @@ class ArtNetNodeImpl {
    * Because this is wrapped in the QueueingRDMController this will only be
    * called one-at-a-time (per port)
    */
-  void SendRDMRequest(uint8_t port_id,
+  void SendRDMRequest(uint16_t port_id,
                       ola::rdm::RDMRequest *request,
                       ola::rdm::RDMCallback *on_complete);
 
   /**
    * @brief Set the RDM handlers for an Input port
    * @param port_id the id of the port to set the handlers for
-   * @param on_tod the callback to be invoked when a ArtTod message is
-   * received, and the RDM process isn't running.
+   * @param on_tod the callback to be invoked when a ArtTod message changes
+   * the set of UIDs, and the RDM process isn't running. Repeated ArtTod
+   * messages with the same UIDs don't run the callback.
    */
   bool SetUnsolicitedUIDSetHandler(
-      uint8_t port_id,
+      uint16_t port_id,
       ola::Callback1<void, const ola::rdm::UIDSet&> *on_tod);
 
   /**
@@ -314,7 +383,7 @@ class ArtNetNodeImpl {
    * @param[out] node_addresses a vector of nodes listening to the port
    */
   void GetSubscribedNodes(
-      uint8_t port_id,
+      uint16_t port_id,
       std::vector<ola::network::IPV4Address> *node_addresses);
 
   // The following apply to Output Ports (those which receive data);
@@ -325,22 +394,30 @@ class ArtNetNodeImpl {
    * @param handler the Callback0 to call when there is data for this universe.
    * Ownership of the closure is transferred to the node.
    */
-  bool SetDMXHandler(uint8_t port_id,
+  bool SetDMXHandler(uint16_t port_id,
                      DmxBuffer *buffer,
                      ola::Callback0<void> *handler);
 
+  /**
+   * @brief The time the packet being handled arrived.
+   *
+   * This is valid while a DMX handler is running, it's on the same clock as
+   * SelectServerInterface::WakeUpTime().
+   */
+  const TimeStamp &LastReceiveTime() const { return m_receive_time; }
+
   /**
    * @brief Send an set of UIDs in one of more ArtTod packets
    * @param port_id the id of the port to send on
    * @param uid_set the UIDSet to send
    */
-  bool SendTod(uint8_t port_id, const ola::rdm::UIDSet &uid_set);
+  bool SendTod(uint16_t port_id, const ola::rdm::UIDSet &uid_set);
 
   /**
    * @brief Set the RDM handlers for an Output port
    */
   bool SetOutputPortRDMHandlers(
-      uint8_t port_id,
+      uint16_t port_id,
       ola::Callback0<void> *on_discover,
       ola::Callback0<void> *on_flush,
       ola::Callback2<void,
@@ -354,7 +431,11 @@ class ArtNetNodeImpl {
 
  private:
   class InputPort;
+  class SubscriberList;
   typedef std::vector<InputPort*> InputPorts;
+  // The enabled input ports, sorted by Port-Address.
+  typedef std::pair<uint16_t, InputPort*> PortIndexEntry;
+  typedef std::vector<PortIndexEntry> PortIndex;
 
   // map a uid to a IP address and the number of times we've missed a
   // response.
@@ -371,11 +452,20 @@ class ArtNetNodeImpl {
 
   // Output Ports receive Art-Net data
   struct OutputPort {
-    uint8_t universe_address;
+    uint8_t net_address;
+    uint8_t universe_address;  // the Sub-Net and Universe
     uint8_t sequence_number;
     bool enabled;
     artnet_merge_mode merge_mode;
     bool is_merging;
+    // true if we're holding data until the next ArtSync
+    bool sync_pending;
+    // The port_id + 1 of the next enabled port with the same Port-Address, or
+    // 0 if this is the last one.
+    uint16_t next_port;
+    // The statistics for this port's Port-Address, these are shared by all
+    // ports using the address.
+    ola::dmx::ReceiveStats *stats;
     DMXSource sources[MAX_MERGE_SOURCES];
     DmxBuffer *buffer;
     std::map<ola::rdm::UID, ola::network::IPV4Address> uid_map;
@@ -387,8 +477,19 @@ class ArtNetNodeImpl {
                    ola::rdm::RDMCallback*> *on_rdm_request;
   };
 
+  typedef std::vector<OutputPort> OutputPorts;
+  // The receive statistics for each Port-Address & source, and when we last
+  // heard from the source.
+  struct SourceStats {
+    ola::dmx::ReceiveStats *stats;
+    TimeStamp last_heard;
+  };
+  typedef std::map<std::pair<uint16_t, ola::network::IPV4Address>,
+                   SourceStats> SourceStatsMap;
+
   bool m_running;
   uint8_t m_net_address;  // this is the 'net' portion of the Art-Net address
+  uint8_t m_subnet_address;
   bool m_send_reply_on_change;
   std::string m_short_name;
   std::string m_long_name;
@@ -397,6 +498,20 @@ class ArtNetNodeImpl {
   ola::io::SelectServerInterface *m_ss;
   bool m_always_broadcast;
   bool m_use_limited_broadcast_address;
+  bool m_use_art_sync;
+  bool m_use_receive_timestamps;
+  ola::network::TransmitPacer *m_transmit_pacer;
+  unsigned int m_poll_reply_jitter_ms;
+  // The time the packet we're handling arrived.
+  TimeStamp m_receive_time;
+  // The timeout used to flush the queued ArtDmx packets.
+  ola::thread::timeout_id m_flush_timeout;
+  // The timeout used to expire subscribed nodes.
+  ola::thread::timeout_id m_expiry_timeout;
+  // The timeout used to send a reply to ArtPolls.
+  ola::thread::timeout_id m_poll_reply_timeout;
+  // When we last received an ArtSync.
+  TimeStamp m_last_sync;
 
   // The following keep track of "Configuration mode"
   bool m_in_configuration_mode;
@@ -404,12 +519,26 @@ class ArtNetNodeImpl {
   bool m_artpollreply_required;
 
   InputPorts m_input_ports;
-  OutputPort m_output_ports[ARTNET_MAX_PORTS];
+  PortIndex m_port_index;
+  // Indexed by Port-Address, this holds the offset + 1 of the first entry in
+  // m_port_index for the address, or 0 if there isn't one.
+  std::vector<uint16_t> m_input_port_table;
+  OutputPorts m_output_ports;
+  // Indexed by Port-Address, this holds the port_id + 1 of the first enabled
+  // output port using the address, or 0 if there isn't one.
+  std::vector<uint16_t> m_output_port_table;
+  ola::ReceiveStatsMap *m_receive_stats;
+  SourceStatsMap m_source_stats;
+  // The ArtPollReply packets. These are built when they're first needed and
+  // cleared whenever anything they contain changes.
+  std::vector<artnet_packet> m_poll_replies;
   ola::network::Interface m_interface;
   std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
 
   /**
-   * @brief Called when there is data on this socket
+   * @brief Called when there is data on this socket.
+   *
+   * This reads up to RECV_BATCH_SIZE packets.
    */
   void SocketReady();
 
@@ -425,15 +554,40 @@ class ArtNetNodeImpl {
    * true.
    *
    * If we're in configuration mode, this sets m_artpollreply_required
-   * instead of sending.
+   * instead of sending. This is called whenever the configuration changes,
+   * so it also clears m_poll_replies.
    */
   bool SendPollReplyIfRequired();
 
   /**
    * @brief Send an ArtPollReply message
+   *
+   * If the ports don't fit in a single ArtPollReply, this sends one reply per
+   * port, using the BindIndex, as per Art-Net 4.
    */
   bool SendPollReply(const ola::network::IPV4Address &destination);
 
+  /**
+   * @brief Send the reply to the ArtPolls received since the last one.
+   */
+  void SendPendingPollReply();
+
+  /**
+   * @brief Build the ArtPollReply packets in m_poll_replies.
+   */
+  void BuildPollReplies();
+
+  /**
+   * @brief Fill in the fields of an ArtPollReply that don't depend on the
+   * ports.
+   */
+  void PopulatePollReply(artnet_reply_t *reply);
+
+  /**
+   * @brief Check if we need to send one ArtPollReply per port.
+   */
+  bool UseBindIndex() const;
+
   /**
    * @brief Send an IPProgReply
    */
@@ -460,6 +614,13 @@ class ArtNetNodeImpl {
                          const artnet_reply_t &packet,
                          unsigned int packet_size);
 
+  /**
+   * @brief Handle an ArtSync packet, this releases any held DMX data.
+   */
+  void HandleSyncPacket(const ola::network::IPV4Address &source_address,
+                        const artnet_sync_t &packet,
+                        unsigned int packet_size);
+
   /**
    * @brief Handle a DMX Data packet, this takes care of the merging
    */
@@ -499,8 +660,8 @@ class ArtNetNodeImpl {
    * @brief Handle the completion of a request for an Output port
    */
   void RDMRequestCompletion(ola::network::IPV4Address destination,
-                            uint8_t port_id,
-                            uint8_t universe_address,
+                            uint16_t port_id,
+                            uint16_t port_address,
                             ola::rdm::RDMReply *reply);
 
   /**
@@ -524,6 +685,65 @@ class ArtNetNodeImpl {
                        const artnet_ip_prog_t &packet,
                        unsigned int packet_size);
 
+  /**
+   * @brief Add the datagrams required to send a port's ArtDmx packet.
+   * @param port the InputPort to send.
+   * @param datagrams the vector to append the datagrams to.
+   * @returns false if there are no nodes listening for the port's universe.
+   */
+  bool AppendDMXDatagrams(InputPort *port,
+                          std::vector<ola::network::UDPDatagram> *datagrams);
+
+  /**
+   * @brief Rebuild m_port_index, this must be called whenever an input port's
+   * address or state changes.
+   */
+  void UpdatePortIndex();
+
+  /**
+   * @brief Find the first entry in m_port_index for a Port-Address.
+   */
+  PortIndex::const_iterator FirstInputPort(uint16_t port_address) const;
+
+  /**
+   * @brief Rebuild m_output_port_table, this must be called whenever an
+   * output port's address or state changes.
+   */
+  void UpdateOutputPortTable();
+
+  /**
+   * @brief Build the 15 bit Port-Address from the Net and Sub-Net / Universe.
+   */
+  static uint16_t MakePortAddress(uint8_t net_address,
+                                  uint8_t universe_address) {
+    return static_cast<uint16_t>(((net_address & 0x7f) << 8) |
+                                 universe_address);
+  }
+
+  /**
+   * @brief Remove subscribed nodes, and the receive statistics for sources,
+   *   we haven't heard from in NODE_TIMEOUT.
+   */
+  bool ExpireSubscribers();
+
+  static bool PortAddressLessThan(const PortIndexEntry &a,
+                                  const PortIndexEntry &b);
+
+  /**
+   * @brief Send the queued ArtDmx packets, followed by an ArtSync.
+   */
+  void FlushDMX();
+
+  /**
+   * @brief Send an ArtSync
+   */
+  bool SendSync();
+
+  /**
+   * @brief Check if we've received an ArtSync recently.
+   */
+  bool SyncActive() const;
+
   /**
    * @brief Fill in the header for a packet
    */
@@ -539,6 +759,13 @@ class ArtNetNodeImpl {
                   unsigned int size,
                   const ola::network::IPV4Address &destination);
 
+  /**
+   * @brief Send datagrams, using the TransmitPacer if there is one.
+   * @returns the number of datagrams sent or queued.
+   */
+  unsigned int SendDatagrams(
+      const std::vector<ola::network::UDPDatagram> &datagrams);
+
   /**
    * @brief Timeout a pending RDM request
    * @param port the id of the port to timeout.
@@ -550,19 +777,36 @@ class ArtNetNodeImpl {
    */
   bool SendRDMCommand(const ola::rdm::RDMCommand &command,
                       const ola::network::IPV4Address &destination,
-                      uint8_t universe);
+                      uint16_t port_address);
 
   /**
    * @brief Update a port from a source, merging if necessary
    */
   void UpdatePortFromSource(OutputPort *port, const DMXSource &source);
 
+  /**
+   * @brief Update the receive statistics for an ArtDmx packet.
+   * @param port the first output port using the Port-Address.
+   * @param port_address the Port-Address the packet was sent to.
+   * @param source_address the IP address of the sender.
+   * @param sequence the sequence number from the packet.
+   */
+  void UpdateReceiveStats(OutputPort *port,
+                          uint16_t port_address,
+                          const ola::network::IPV4Address &source_address,
+                          uint8_t sequence);
+
+  /**
+   * @brief The key in the ReceiveStatsMap for a Port-Address & source.
+   */
+  static std::string SourceStatsKey(const SourceStatsMap::key_type &key);
+
   /**
    * @brief Check the version number of a incoming packet
    */
   bool CheckPacketVersion(const ola::network::IPV4Address &source_address,
                           const std::string &packet_type,
-                          uint16_t version);
+                          const ola::network::BigEndian<uint16_t> &version);
 
   /**
    * @brief Check the size of an incoming packet
@@ -576,35 +820,38 @@ class ArtNetNodeImpl {
   /**
    * @brief Lookup an InputPort by id, if the id is invalid, we return NULL.
    */
-  InputPort *GetInputPort(uint8_t port_id, bool warn = true);
+  InputPort *GetInputPort(uint16_t port_id, bool warn = true);
 
   /**
    * @brief A const version of GetInputPort();
    */
-  const InputPort *GetInputPort(uint8_t port_id) const;
+  const InputPort *GetInputPort(uint16_t port_id) const;
 
   /**
    * @brief Similar to GetInputPort, but this also confirms the port is enabled.
    */
-  InputPort *GetEnabledInputPort(uint8_t port_id, const std::string &action);
+  InputPort *GetEnabledInputPort(uint16_t port_id, const std::string &action);
 
   /**
    * @brief Lookup an OutputPort by id, if the id is invalid, we return NULL.
    */
-  OutputPort *GetOutputPort(uint8_t port_id);
+  OutputPort *GetOutputPort(uint16_t port_id);
 
   /**
    * @brief A const version of GetOutputPort();
    */
-  const OutputPort *GetOutputPort(uint8_t port_id) const;
+  const OutputPort *GetOutputPort(uint16_t port_id) const;
 
   /**
    * @brief Similar to GetOutputPort, but this also confirms the port is enabled.
    */
-  OutputPort *GetEnabledOutputPort(uint8_t port_id, const std::string &action);
+  OutputPort *GetEnabledOutputPort(uint16_t port_id, const std::string &action);
 
   /**
    * @brief Update a port with a new TOD list
+   *
+   * Blocks that match the last TOD from the gateway only reset the missed
+   * counts of the UIDs they contain.
    */
   void UpdatePortFromTodPacket(InputPort *port,
                                const ola::network::IPV4Address &source_address,
@@ -631,6 +878,7 @@ class ArtNetNodeImpl {
   bool InitNetwork();
 
   static const char ARTNET_ID[];
+  static const char RECEIVE_STATS_VAR[];
   static const uint16_t ARTNET_PORT = 6454;
   static const uint16_t OEM_CODE = 0x0431;
   static const uint16_t ARTNET_VERSION = 14;
@@ -638,11 +886,15 @@ class ArtNetNodeImpl {
   // node as dead. This is set to 3x the POLL_INTERVAL in ArtNetDevice.
   static const uint8_t NODE_CODE = 0x00;
   static const uint16_t MAX_UIDS_PER_UNIVERSE = 0xffff;
+  // The number of addresses in the 15 bit Port-Address space.
+  static const unsigned int PORT_ADDRESS_COUNT = 0x8000;
   static const uint8_t RDM_VERSION = 0x01;  // v1.0 standard baby!
   static const uint8_t TOD_FLUSH_COMMAND = 0x01;
   static const unsigned int MERGE_TIMEOUT = 10;  // As per the spec
   // seconds after which a node is marked as inactive for the dmx merging
   static const unsigned int NODE_TIMEOUT = 31;
+  // mseconds between checks for inactive nodes
+  static const unsigned int SUBSCRIBER_EXPIRY_INTERVAL_MS = 1000;
   // mseconds we wait for a TodData packet before declaring a node missing
   static const unsigned int RDM_TOD_TIMEOUT_MS = 4000;
   // Number of missed TODs before we decide a UID has gone
@@ -652,6 +904,11 @@ class ArtNetNodeImpl {
   static const unsigned int RDM_REQUEST_QUEUE_LIMIT = 100;
   // How long to wait for a response to an RDM Request
   static const unsigned int RDM_REQUEST_TIMEOUT_MS = 2000;
+  // The maximum number of packets to read each time the socket is ready.
+  static const unsigned int RECV_BATCH_SIZE = 8;
+  // Return to immediate output if we don't receive an ArtSync for this many
+  // seconds. As per the spec.
+  static const unsigned int SYNC_TIMEOUT = 4;
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNodeImpl);
 };
@@ -664,7 +921,7 @@ class ArtNetNodeImpl {
 class ArtNetNodeImplRDMWrapper
     : public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-  ArtNetNodeImplRDMWrapper(ArtNetNodeImpl *impl, uint8_t port_id):
+  ArtNetNodeImplRDMWrapper(ArtNetNodeImpl *impl, uint16_t port_id):
       m_impl(impl),
       m_port_id(port_id) {
   }
@@ -685,7 +942,7 @@ class ArtNetNodeImplRDMWrapper
 
  private:
   ArtNetNodeImpl *m_impl;
-  uint8_t m_port_id;
+  uint16_t m_port_id;
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNodeImplRDMWrapper);
 };
@@ -735,41 +992,58 @@ class ArtNetNode {
     return m_impl.SubnetAddress();
   }
 
-  uint8_t InputPortCount() const {
+  uint16_t InputPortCount() const {
     return m_impl.InputPortCount();
   }
 
-  bool SetInputPortUniverse(uint8_t port_id, uint8_t universe_id) {
+  bool SetInputPortUniverse(uint16_t port_id, uint8_t universe_id) {
     return m_impl.SetInputPortUniverse(port_id, universe_id);
   }
-  uint8_t GetInputPortUniverse(uint8_t port_id) const {
+  uint8_t GetInputPortUniverse(uint16_t port_id) const {
     return m_impl.GetInputPortUniverse(port_id);
   }
-  void DisableInputPort(uint8_t port_id) {
+  void DisableInputPort(uint16_t port_id) {
     m_impl.DisableInputPort(port_id);
   }
-  bool InputPortState(uint8_t port_id) const {
+  bool InputPortState(uint16_t port_id) const {
     return m_impl.InputPortState(port_id);
   }
 
-  bool SetOutputPortUniverse(uint8_t port_id, uint8_t universe_id) {
+  bool SetOutputPortUniverse(uint16_t port_id, uint8_t universe_id) {
     return m_impl.SetOutputPortUniverse(port_id, universe_id);
   }
-  uint8_t GetOutputPortUniverse(uint8_t port_id) {
+  uint8_t GetOutputPortUniverse(uint16_t port_id) {
     return m_impl.GetOutputPortUniverse(port_id);
   }
-  void DisableOutputPort(uint8_t port_id) {
+  void DisableOutputPort(uint16_t port_id) {
     m_impl.DisableOutputPort(port_id);
   }
-  bool OutputPortState(uint8_t port_id) const {
+  bool OutputPortState(uint16_t port_id) const {
     return m_impl.OutputPortState(port_id);
   }
 
+  uint16_t OutputPortCount() const {
+    return m_impl.OutputPortCount();
+  }
+
+  bool SetInputPortAddress(uint16_t port_id, uint16_t port_address) {
+    return m_impl.SetInputPortAddress(port_id, port_address);
+  }
+  uint16_t GetInputPortAddress(uint16_t port_id) const {
+    return m_impl.GetInputPortAddress(port_id);
+  }
+  bool SetOutputPortAddress(uint16_t port_id, uint16_t port_address) {
+    return m_impl.SetOutputPortAddress(port_id, port_address);
+  }
+  uint16_t GetOutputPortAddress(uint16_t port_id) const {
+    return m_impl.GetOutputPortAddress(port_id);
+  }
+
   void SetBroadcastThreshold(unsigned int threshold) {
     m_impl.SetBroadcastThreshold(threshold);
   }
 
-  bool SetMergeMode(uint8_t port_id, artnet_merge_mode merge_mode) {
+  bool SetMergeMode(uint16_t port_id, artnet_merge_mode merge_mode) {
     return m_impl.SetMergeMode(port_id, merge_mode);
   }
 
@@ -779,26 +1053,26 @@ class ArtNetNode {
   }
 
   // The following apply to Input Ports (those which send data)
-  bool SendDMX(uint8_t port_id, const ola::DmxBuffer &buffer) {
+  bool SendDMX(uint16_t port_id, const ola::DmxBuffer &buffer) {
     return m_impl.SendDMX(port_id, buffer);
   }
 
   /**
    * @brief Trigger full discovery for a port
    */
-  void RunFullDiscovery(uint8_t port_id,
+  void RunFullDiscovery(uint16_t port_id,
                         ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
    * @brief Trigger incremental discovery for a port.
    */
-  void RunIncrementalDiscovery(uint8_t port_id,
+  void RunIncrementalDiscovery(uint16_t port_id,
                                ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
    * @brief Send a RDM request by passing it though the Queuing Controller
    */
-  void SendRDMRequest(uint8_t port_id,
+  void SendRDMRequest(uint16_t port_id,
                       ola::rdm::RDMRequest *request,
                       ola::rdm::RDMCallback *on_complete);
 
@@ -807,27 +1081,30 @@ class ArtNetNode {
    * process isn't running.
    */
   bool SetUnsolicitedUIDSetHandler(
-      uint8_t port_id,
+      uint16_t port_id,
       ola::Callback1<void, const ola::rdm::UIDSet&> *on_tod) {
     return m_impl.SetUnsolicitedUIDSetHandler(port_id, on_tod);
   }
   void GetSubscribedNodes(
-      uint8_t port_id,
+      uint16_t port_id,
       std::vector<ola::network::IPV4Address> *node_addresses) {
     m_impl.GetSubscribedNodes(port_id, node_addresses);
   }
 
   // The following apply to Output Ports (those which receive data);
-  bool SetDMXHandler(uint8_t port_id,
+  bool SetDMXHandler(uint16_t port_id,
                      DmxBuffer *buffer,
                      ola::Callback0<void> *handler) {
     return m_impl.SetDMXHandler(port_id, buffer, handler);
   }
-  bool SendTod(uint8_t port_id, const ola::rdm::UIDSet &uid_set) {
+  const TimeStamp &LastReceiveTime() const {
+    return m_impl.LastReceiveTime();
+  }
+  bool SendTod(uint16_t port_id, const ola::rdm::UIDSet &uid_set) {
     return m_impl.SendTod(port_id, uid_set);
   }
   bool SetOutputPortRDMHandlers(
-      uint8_t port_id,
+      uint16_t port_id,
       ola::Callback0<void> *on_discover,
       ola::Callback0<void> *on_flush,
       ola::Callback2<void,
@@ -853,7 +1130,7 @@ class ArtNetNode {
    * @brief Check that the port_id is a valid input port.
    * @return true if the port id is valid, false otherwise
    */
-  bool CheckInputPortId(uint8_t port_id);
+  bool CheckInputPortId(uint16_t port_id);
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNode);
 };
@@ -26,6 +26,7 @@
 
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/IPV4Address.h"
@@ -47,6 +48,9 @@
 
 
 using ola::DmxBuffer;
+using ola::ExportMap;
+using ola::ReceiveStatsMap;
+using ola::dmx::ReceiveStats;
 using ola::network::IPV4Address;
 using ola::network::Interface;
 using ola::network::MACAddress;
@@ -72,13 +76,17 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ArtNetNodeTest);
   CPPUNIT_TEST(testBasicBehaviour);
   CPPUNIT_TEST(testConfigurationMode);
+  CPPUNIT_TEST(testPollReply);
   CPPUNIT_TEST(testExtendedInputPorts);
+  CPPUNIT_TEST(testExtendedAddressing);
   CPPUNIT_TEST(testBroadcastSendDMX);
   CPPUNIT_TEST(testBroadcastSendDMXZeroUniverse);
   CPPUNIT_TEST(testLimitedBroadcastDMX);
   CPPUNIT_TEST(testNonBroadcastSendDMX);
+  CPPUNIT_TEST(testSyncSendDMX);
   CPPUNIT_TEST(testReceiveDMX);
   CPPUNIT_TEST(testReceiveDMXZeroUniverse);
+  CPPUNIT_TEST(testReceiveSync);
   CPPUNIT_TEST(testHTPMerge);
   CPPUNIT_TEST(testLTPMerge);
   CPPUNIT_TEST(testControllerDiscovery);
@@ -113,13 +121,17 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
 
   void testBasicBehaviour();
   void testConfigurationMode();
+  void testPollReply();
   void testExtendedInputPorts();
+  void testExtendedAddressing();
   void testBroadcastSendDMX();
   void testBroadcastSendDMXZeroUniverse();
   void testLimitedBroadcastDMX();
   void testNonBroadcastSendDMX();
+  void testSyncSendDMX();
   void testReceiveDMX();
   void testReceiveDMXZeroUniverse();
+  void testReceiveSync();
   void testHTPMerge();
   void testLTPMerge();
   void testControllerDiscovery();
@@ -271,6 +283,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   static const uint8_t POLL_MESSAGE[];
   static const uint8_t POLL_REPLY_MESSAGE[];
   static const uint8_t TOD_CONTROL[];
+  static const uint8_t SYNC_MESSAGE[];
   static const uint16_t ARTNET_PORT = 6454;
 };
 
@@ -335,6 +348,13 @@ const uint8_t ArtNetNodeTest::TOD_CONTROL[] = {
   0x23
 };
 
+const uint8_t ArtNetNodeTest::SYNC_MESSAGE[] = {
+  'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+  0x00, 0x52,
+  0x0, 14,
+  0, 0  // aux
+};
+
 void ArtNetNodeTest::setUp() {
   ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
   ola::network::InterfaceBuilder interface_builder;
@@ -378,7 +398,7 @@ void ArtNetNodeTest::testBasicBehaviour() {
   OLA_ASSERT(m_socket->CheckNetworkParamsMatch(true, true, 6454, true));
 
   // check port states
-  OLA_ASSERT_EQ((uint8_t) 4, node.InputPortCount());
+  OLA_ASSERT_EQ((uint16_t) 4, node.InputPortCount());
   OLA_ASSERT_FALSE(node.InputPortState(0));
   OLA_ASSERT_FALSE(node.InputPortState(1));
   OLA_ASSERT_FALSE(node.InputPortState(2));
@@ -417,6 +437,66 @@ void ArtNetNodeTest::testBasicBehaviour() {
 }
 
 
+/**
+ * Check that replies to ArtPolls are delayed, and shared by the ArtPolls that
+ * arrive before the reply is sent.
+ */
+void ArtNetNodeTest::testPollReply() {
+  ArtNetNodeOptions node_options;
+  node_options.poll_reply_jitter_ms = 500;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  node.SetShortName("Short Name");
+  node.SetLongName("This is the very long name");
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  node.SetOutputPortUniverse(0, 3);
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+
+  // Nothing is sent until the reply is due.
+  {
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip);
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip2);
+  }
+
+  {
+    SocketVerifier verifier(m_socket);
+    ExpectedBroadcast(POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    m_clock.AdvanceTime(0, 501000);
+    ss.RunOnce();
+  }
+
+  // The next ArtPoll gets a reply of its own.
+  {
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip3);
+    ExpectedBroadcast(POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    m_clock.AdvanceTime(0, 501000);
+    ss.RunOnce();
+  }
+
+  // A change to the configuration sends a new reply straight away, which
+  // answers the pending ArtPoll.
+  uint8_t poll_reply_message[sizeof(POLL_REPLY_MESSAGE)];
+  memcpy(poll_reply_message, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+  poll_reply_message[115] = '1';  // node report
+  poll_reply_message[183] = 0x80;  // good output
+  poll_reply_message[191] = 0x24;  // swout
+  {
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip);
+    ExpectedBroadcast(poll_reply_message, sizeof(poll_reply_message));
+    OLA_ASSERT(node.SetOutputPortUniverse(1, 4));
+    m_socket->Verify();
+    m_clock.AdvanceTime(0, 501000);
+    ss.RunOnce();
+  }
+  OLA_ASSERT(node.Stop());
+}
+
+
 /**
  * Check that configuration mode works correctly.
  */
@@ -603,7 +683,7 @@ void ArtNetNodeTest::testExtendedInputPorts() {
   ss.RemoveReadDescriptor(m_socket);
   m_socket->Verify();
 
-  OLA_ASSERT_EQ((uint8_t) 8, node.InputPortCount());
+  OLA_ASSERT_EQ((uint16_t) 8, node.InputPortCount());
   OLA_ASSERT_FALSE(node.InputPortState(0));
   OLA_ASSERT_FALSE(node.InputPortState(1));
   OLA_ASSERT_FALSE(node.InputPortState(2));
@@ -629,6 +709,123 @@ void ArtNetNodeTest::testExtendedInputPorts() {
 }
 
 
+/**
+ * Check ports can use any Port-Address, independent of the node's net and
+ * sub-net.
+ */
+void ArtNetNodeTest::testExtendedAddressing() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.always_broadcast = true;
+  node_options.input_port_count = 2;
+  node_options.output_port_count = 8;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+
+  OLA_ASSERT_EQ((uint16_t) 8, node.OutputPortCount());
+  OLA_ASSERT(node.SetOutputPortAddress(0, 0x1234));
+  OLA_ASSERT(node.SetOutputPortAddress(3, 0x1234));
+  OLA_ASSERT(node.SetOutputPortAddress(7, 0x7fff));
+  OLA_ASSERT_FALSE(node.SetOutputPortAddress(8, 0x0001));
+  OLA_ASSERT(node.SetInputPortAddress(1, 0x0523));
+  OLA_ASSERT_EQ((uint16_t) 0x1234, node.GetOutputPortAddress(3));
+  OLA_ASSERT_EQ((uint16_t) 0x7fff, node.GetOutputPortAddress(7));
+  OLA_ASSERT_EQ((uint16_t) 0x0523, node.GetInputPortAddress(1));
+  OLA_ASSERT_FALSE(node.OutputPortState(1));
+
+  DmxBuffer buffers[3];
+  node.SetDMXHandler(0, &buffers[0],
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+  node.SetDMXHandler(3, &buffers[1],
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+  node.SetDMXHandler(7, &buffers[2],
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  // both ports on 0x1234 get the data
+  {
+    uint8_t DMX_MESSAGE[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      1,  // physical port
+      0x34, 0x12,  // subnet & net address
+      0, 4,  // dmx length
+      1, 2, 3, 4
+    };
+
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("1,2,3,4"), buffers[0].ToString());
+    OLA_ASSERT_EQ(string("1,2,3,4"), buffers[1].ToString());
+    OLA_ASSERT_EQ(0u, buffers[2].Size());
+  }
+
+  {
+    uint8_t DMX_MESSAGE[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      1,  // physical port
+      0xff, 0x7f,  // subnet & net address
+      0, 2,  // dmx length
+      9, 8
+    };
+
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_EQ(string("1,2,3,4"), buffers[0].ToString());
+    OLA_ASSERT_EQ(string("9,8"), buffers[2].ToString());
+  }
+
+  // a different net is ignored
+  {
+    uint8_t DMX_MESSAGE[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      1,  // physical port
+      0x34, 0x13,  // subnet & net address
+      0, 2,  // dmx length
+      5, 5
+    };
+
+    SocketVerifier verifier(m_socket);
+    m_got_dmx = false;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+    OLA_ASSERT_EQ(string("1,2,3,4"), buffers[0].ToString());
+  }
+
+  // DMX sent from the input port uses the port's net
+  {
+    SocketVerifier verifier(m_socket);
+    const uint8_t DMX_MESSAGE[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      1,  // physical port
+      0x23, 5,  // subnet & net address
+      0, 2,  // dmx length
+      7, 6
+    };
+    ExpectedBroadcast(DMX_MESSAGE, sizeof(DMX_MESSAGE));
+
+    DmxBuffer dmx;
+    dmx.SetFromString("7,6");
+    OLA_ASSERT(node.SendDMX(1, dmx));
+  }
+}
+
+
 /**
  * Check sending DMX using broadcast works.
  */
@@ -1017,6 +1214,95 @@ void ArtNetNodeTest::testNonBroadcastSendDMX() {
     ExpectedBroadcast(DMX_MESSAGE3, sizeof(DMX_MESSAGE3));
     OLA_ASSERT(node.SendDMX(m_port_id, dmx));
   }
+
+  // the nodes are removed once they haven't been heard from for 31s
+  {
+    SocketVerifier verifier(m_socket);
+    m_clock.AdvanceTime(30, 0);
+    ss.RunOnce();
+    node_addresses.clear();
+    node.GetSubscribedNodes(m_port_id, &node_addresses);
+    OLA_ASSERT_EQ(static_cast<size_t>(2), node_addresses.size());
+
+    // the expiry check runs every second
+    m_clock.AdvanceTime(2, 0);
+    ss.RunOnce();
+    m_clock.AdvanceTime(1, 0);
+    ss.RunOnce();
+    node_addresses.clear();
+    node.GetSubscribedNodes(m_port_id, &node_addresses);
+    OLA_ASSERT_EQ(static_cast<size_t>(0), node_addresses.size());
+
+    // and nothing is sent
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+  }
+}
+
+/**
+ * Check that ArtDmx packets are batched and followed by an ArtSync.
+ */
+void ArtNetNodeTest::testSyncSendDMX() {
+  m_socket->SetDiscardMode(true);
+
+  ArtNetNodeOptions node_options;
+  node_options.always_broadcast = true;
+  node_options.use_art_sync = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+  node.SetInputPortUniverse(0, 2);
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  const uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    0,  // physical port
+    0x22, 4,  // subnet & net address
+    0, 4,  // dmx length
+    9, 8, 7, 6
+  };
+  const uint8_t DMX_MESSAGE2[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+
+  // nothing is sent until the event loop runs
+  {
+    SocketVerifier verifier(m_socket);
+    DmxBuffer dmx;
+    dmx.SetFromString("1,1,1,1,1,1");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    dmx.SetFromString("0,1,2,3,4,5");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    dmx.SetFromString("9,8,7,6");
+    OLA_ASSERT(node.SendDMX(0, dmx));
+  }
+
+  // only the latest frame for each port is sent, followed by a single ArtSync
+  {
+    SocketVerifier verifier(m_socket);
+    ExpectedBroadcast(DMX_MESSAGE, sizeof(DMX_MESSAGE));
+    ExpectedBroadcast(DMX_MESSAGE2, sizeof(DMX_MESSAGE2));
+    ExpectedBroadcast(SYNC_MESSAGE, sizeof(SYNC_MESSAGE));
+    ss.RunOnce();
+  }
+
+  // nothing else is pending
+  {
+    SocketVerifier verifier(m_socket);
+    ss.RunOnce();
+  }
 }
 
 /**
@@ -1024,7 +1310,9 @@ void ArtNetNodeTest::testNonBroadcastSendDMX() {
  */
 void ArtNetNodeTest::testReceiveDMX() {
   m_socket->SetDiscardMode(true);
+  ExportMap export_map;
   ArtNetNodeOptions node_options;
+  node_options.export_map = &export_map;
   ArtNetNode node(iface, &ss, node_options, m_socket);
   SetupOutputPort(&node);
   DmxBuffer input_buffer;
@@ -1091,6 +1379,32 @@ void ArtNetNodeTest::testReceiveDMX() {
     OLA_ASSERT(m_got_dmx);
     OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
   }
+
+  // skip two sequence numbers
+  {
+    SocketVerifier verifier(m_socket);
+    DMX_MESSAGE[12] = 5;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+  }
+
+  // The first packet had a sequence number of 0, so it isn't checked.
+  ReceiveStatsMap *stats_map = export_map.GetReceiveStatsMapVar(
+      "artnet-receive-stats");
+  const ReceiveStats *stats = stats_map->Get("1059");
+  OLA_ASSERT_EQ(4u, stats->Packets());
+  OLA_ASSERT_EQ(2u, stats->SequenceGaps());
+  OLA_ASSERT_EQ(0u, stats->OutOfOrder());
+  stats = stats_map->Get("1059/" + peer_ip.ToString());
+  OLA_ASSERT_EQ(4u, stats->Packets());
+  OLA_ASSERT_EQ(2u, stats->SequenceGaps());
+
+  // the source statistics are dropped once we stop hearing from the source
+  m_clock.AdvanceTime(32, 0);
+  ss.RunOnce();
+  vector<std::pair<string, ReceiveStats> > snapshot;
+  stats_map->Snapshot(&snapshot);
+  OLA_ASSERT_EQ((size_t) 1, snapshot.size());
+  OLA_ASSERT_EQ(string("1059"), snapshot[0].first);
 }
 
 /**
@@ -1166,6 +1480,78 @@ void ArtNetNodeTest::testReceiveDMXZeroUniverse() {
   }
 }
 
+/**
+ * Check that ArtSync holds received data until the next sync.
+ */
+void ArtNetNodeTest::testReceiveSync() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupOutputPort(&node);
+  DmxBuffer input_buffer;
+  node.SetDMXHandler(m_port_id,
+                     &input_buffer,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+
+  // our own ArtSyncs don't change anything
+  {
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), iface.ip_address);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
+  }
+
+  // once we've seen an ArtSync, data is held until the next one
+  {
+    SocketVerifier verifier(m_socket);
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+
+    m_got_dmx = false;
+    DMX_MESSAGE[12] = 1;
+    DMX_MESSAGE[18] = 10;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("10,1,2,3,4,5"), input_buffer.ToString());
+
+    // a sync without new data doesn't trigger an update
+    m_got_dmx = false;
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+  }
+
+  // if the ArtSyncs stop for more than 4s, data is output immediately
+  {
+    SocketVerifier verifier(m_socket);
+    m_clock.AdvanceTime(5, 0);
+
+    DMX_MESSAGE[12] = 2;
+    DMX_MESSAGE[18] = 20;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("20,1,2,3,4,5"), input_buffer.ToString());
+  }
+}
+
 /**
  * Check that merging works
  */
@@ -1823,6 +2209,97 @@ void ArtNetNodeTest::testUnsolicitedTod() {
     UIDSet uids;
     UID uid1(0x7a70, 0);
     uids.AddUID(uid1);
+    OLA_ASSERT_EQ(uids, m_uids);
+
+    // the same tod again doesn't run the callback
+    m_discovery_done = false;
+    ReceiveFromPeer(art_tod, sizeof(art_tod), peer_ip);
+    OLA_ASSERT_FALSE(m_discovery_done);
+  }
+
+  // receive a tod split across two blocks
+  {
+    SocketVerifier verifier(m_socket);
+    const uint8_t art_tod1[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x81,
+      0x0, 14,
+      1,  // rdm standard
+      1,  // first port
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // full tod
+      0x23,  // universe address
+      0, 3,  // uid total
+      0,  // block count
+      2,  // uid count
+      0x7a, 0x70, 0, 0, 0, 0,
+      0x7a, 0x70, 0, 0, 0, 1,
+    };
+    const uint8_t art_tod2[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x81,
+      0x0, 14,
+      1,  // rdm standard
+      1,  // first port
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // full tod
+      0x23,  // universe address
+      0, 3,  // uid total
+      1,  // block count
+      1,  // uid count
+      0x7a, 0x70, 0, 0, 0, 2,
+    };
+
+    m_discovery_done = false;
+    ReceiveFromPeer(art_tod1, sizeof(art_tod1), peer_ip);
+    OLA_ASSERT(m_discovery_done);
+    m_discovery_done = false;
+    ReceiveFromPeer(art_tod2, sizeof(art_tod2), peer_ip);
+    OLA_ASSERT(m_discovery_done);
+
+    UIDSet uids;
+    uids.AddUID(UID(0x7a70, 0));
+    uids.AddUID(UID(0x7a70, 1));
+    uids.AddUID(UID(0x7a70, 2));
+    OLA_ASSERT_EQ(uids, m_uids);
+
+    // repeats of either block don't run the callback
+    m_discovery_done = false;
+    ReceiveFromPeer(art_tod1, sizeof(art_tod1), peer_ip);
+    ReceiveFromPeer(art_tod2, sizeof(art_tod2), peer_ip);
+    ReceiveFromPeer(art_tod1, sizeof(art_tod1), peer_ip);
+    OLA_ASSERT_FALSE(m_discovery_done);
+  }
+
+  // a smaller tod removes the missing UIDs
+  {
+    SocketVerifier verifier(m_socket);
+    const uint8_t art_tod[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x81,
+      0x0, 14,
+      1,  // rdm standard
+      1,  // first port
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // full tod
+      0x23,  // universe address
+      0, 2,  // uid total
+      0,  // block count
+      2,  // uid count
+      0x7a, 0x70, 0, 0, 0, 0,
+      0x7a, 0x70, 0, 0, 0, 2,
+    };
+
+    ReceiveFromPeer(art_tod, sizeof(art_tod), peer_ip);
+    OLA_ASSERT(m_discovery_done);
+
+    UIDSet uids;
+    uids.AddUID(UID(0x7a70, 0));
+    uids.AddUID(UID(0x7a70, 2));
+    OLA_ASSERT_EQ(uids, m_uids);
   }
 }
 
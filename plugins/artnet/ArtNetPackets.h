@@ -26,6 +26,7 @@
 #include "ola/network/IPV4Address.h"
 #include "ola/network/MACAddress.h"
 #include "ola/network/Interface.h"
+#include "ola/network/WireLayout.h"
 
 
 #ifndef ARTNET_PORT_COUNT
@@ -68,7 +69,7 @@ typedef enum artnet_packet_type_e {
 
 PACK(
 struct artnet_poll_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t talk_to_me;
   uint8_t priority;
 });
@@ -78,14 +79,14 @@ typedef struct artnet_poll_s artnet_poll_t;
 PACK(
 struct artnet_reply_s {
   uint8_t  ip[ola::network::IPV4Address::LENGTH];
-  uint16_t port;
-  uint16_t version;
+  ola::network::LittleEndian<uint16_t> port;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t  net_address;
   uint8_t  subnet_address;
-  uint16_t oem;
+  ola::network::BigEndian<uint16_t> oem;
   uint8_t  ubea;
   uint8_t  status1;
-  uint16_t esta_id;
+  ola::network::LittleEndian<uint16_t> esta_id;
   char  short_name[ARTNET_SHORT_NAME_LENGTH];
   char  long_name[ARTNET_LONG_NAME_LENGTH];
   char  node_report[ARTNET_REPORT_LENGTH];
@@ -113,7 +114,7 @@ typedef struct artnet_reply_s artnet_reply_t;
 
 PACK(
 struct artnet_timecode_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t  filler;
   uint8_t  filler2;
   uint8_t  frames;
@@ -127,7 +128,7 @@ typedef struct artnet_timecode_s artnet_timecode_t;
 
 PACK(
 struct artnet_dmx_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t  sequence;
   uint8_t  physical;
   uint8_t  universe;
@@ -138,9 +139,18 @@ struct artnet_dmx_s {
 
 typedef struct artnet_dmx_s artnet_dmx_t;
 
+PACK(
+struct artnet_sync_s {
+  ola::network::BigEndian<uint16_t> version;
+  uint8_t  aux1;
+  uint8_t  aux2;
+});
+
+typedef struct artnet_sync_s artnet_sync_t;
+
 PACK(
 struct artnet_todrequest_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t  filler1;
   uint8_t  filler2;
   uint8_t  spare1;
@@ -160,7 +170,7 @@ typedef struct artnet_todrequest_s artnet_todrequest_t;
 
 PACK(
 struct artnet_toddata_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t  rdm_version;
   uint8_t  port;
   uint8_t  spare1;
@@ -173,7 +183,7 @@ struct artnet_toddata_s {
   uint8_t  net;
   uint8_t  command_response;
   uint8_t  address;
-  uint16_t  uid_total;
+  ola::network::BigEndian<uint16_t> uid_total;
   uint8_t  block_count;
   uint8_t  uid_count;
   uint8_t  tod[ARTNET_MAX_UID_COUNT][ola::rdm::UID::UID_SIZE];
@@ -183,7 +193,7 @@ typedef struct artnet_toddata_s artnet_toddata_t;
 
 PACK(
 struct artnet_todcontrol_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t  filler1;
   uint8_t  filler2;
   uint8_t  spare1;
@@ -202,7 +212,7 @@ typedef struct artnet_todcontrol_s artnet_todcontrol_t;
 
 PACK(
 struct artnet_rdm_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint8_t rdm_version;
   uint8_t filler2;
   uint8_t spare1;
@@ -222,13 +232,13 @@ typedef struct artnet_rdm_s artnet_rdm_t;
 
 PACK(
 struct artnet_ip_prog_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint16_t filler;
   uint8_t command;
   uint8_t filler1;
   uint8_t ip[ola::network::IPV4Address::LENGTH];
   uint8_t subnet[ola::network::IPV4Address::LENGTH];
-  uint16_t port;
+  ola::network::LittleEndian<uint16_t> port;
   uint8_t spare[8];
 });
 
@@ -236,13 +246,13 @@ typedef struct artnet_ip_prog_s artnet_ip_prog_t;
 
 PACK(
 struct artnet_ip_reply_s {
-  uint16_t version;
+  ola::network::BigEndian<uint16_t> version;
   uint16_t filler;
   uint8_t command;
   uint8_t filler1;
   uint8_t ip[ola::network::IPV4Address::LENGTH];
   uint8_t subnet[ola::network::IPV4Address::LENGTH];
-  uint16_t port;
+  ola::network::LittleEndian<uint16_t> port;
   uint8_t spare[8];
 });
 
@@ -251,12 +261,13 @@ typedef struct artnet_ip_reply_s artnet_ip_reply_t;
 // union of all Art-Net packets
 typedef struct {
   uint8_t id[8];
-  uint16_t op_code;
+  ola::network::LittleEndian<uint16_t> op_code;
   union {
     artnet_poll_t poll;
     artnet_reply_t reply;
     artnet_timecode_t timecode;
     artnet_dmx_t dmx;
+    artnet_sync_t sync;
     artnet_todrequest_t tod_request;
     artnet_toddata_t tod_data;
     artnet_todcontrol_t tod_control;
@@ -265,6 +276,25 @@ typedef struct {
     artnet_ip_reply_t ip_reply;
   } data;
 } artnet_packet;
+
+// Check the layouts match the Art-Net spec.
+WIRE_SIZE_ASSERT(artnet_poll_t, 4);
+WIRE_SIZE_ASSERT(artnet_reply_t, 209 + 5 * ARTNET_MAX_PORTS);
+WIRE_OFFSET_ASSERT(artnet_reply_t, esta_id, 14);
+WIRE_OFFSET_ASSERT(artnet_reply_t, number_ports, 162);
+WIRE_SIZE_ASSERT(artnet_timecode_t, 9);
+WIRE_SIZE_ASSERT(artnet_dmx_t, 8 + DMX_UNIVERSE_SIZE);
+WIRE_SIZE_ASSERT(artnet_sync_t, 4);
+WIRE_SIZE_ASSERT(artnet_todrequest_t, 14 + ARTNET_MAX_RDM_ADDRESS_COUNT);
+WIRE_OFFSET_ASSERT(artnet_toddata_t, uid_total, 14);
+WIRE_SIZE_ASSERT(artnet_toddata_t,
+                 18 + ARTNET_MAX_UID_COUNT * ola::rdm::UID::UID_SIZE);
+WIRE_SIZE_ASSERT(artnet_todcontrol_t, 14);
+WIRE_SIZE_ASSERT(artnet_rdm_t, 14 + ARTNET_MAX_RDM_DATA);
+WIRE_SIZE_ASSERT(artnet_ip_prog_t, 24);
+WIRE_SIZE_ASSERT(artnet_ip_reply_t, 24);
+WIRE_OFFSET_ASSERT(artnet_packet, op_code, 8);
+WIRE_OFFSET_ASSERT(artnet_packet, data, 10);
 }  // namespace artnet
 }  // namespace plugin
 }  // namespace ola
@@ -99,8 +99,16 @@ bool ArtNetPlugin::SetDefaultPreferences() {
                                          ArtNetDevice::K_ARTNET_SUBNET);
   save |= m_preferences->SetDefaultValue(
       ArtNetDevice::K_OUTPUT_PORT_KEY,
-      UIntValidator(0, 16),
+      UIntValidator(0, ArtNetDevice::K_MAX_PORT_COUNT),
       ArtNetDevice::K_DEFAULT_OUTPUT_PORT_COUNT);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_INPUT_PORT_KEY,
+      UIntValidator(0, ArtNetDevice::K_MAX_PORT_COUNT),
+      ArtNetDevice::K_DEFAULT_INPUT_PORT_COUNT);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_EXTENDED_ADDRESSING_KEY,
+      BoolValidator(),
+      false);
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_ALWAYS_BROADCAST_KEY,
                                          BoolValidator(),
                                          false);
@@ -110,6 +118,13 @@ bool ArtNetPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_LOOPBACK_KEY,
                                          BoolValidator(),
                                          false);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_USE_ART_SYNC_KEY,
+                                         BoolValidator(),
+                                         false);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_RECEIVE_TIMESTAMPS_KEY,
+      BoolValidator(),
+      false);
 
   if (save) {
     m_preferences->Save();
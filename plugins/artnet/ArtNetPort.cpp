@@ -37,11 +37,22 @@ using std::vector;
 
 namespace {
 static const uint8_t ARTNET_UNIVERSE_COUNT = 16;
+static const unsigned int ARTNET_PORT_ADDRESS_COUNT = 0x8000;
+
+string PortAddressToString(uint16_t port_address) {
+  std::ostringstream str;
+  str << "Art-Net Universe " << (port_address >> 8) << ":"
+      << ((port_address >> 4) & 0x0f) << ":" << (port_address & 0x0f);
+  return str.str();
+}
 };  // namespace
 
 void ArtNetInputPort::PostSetUniverse(Universe *old_universe,
                                       Universe *new_universe) {
-  if (new_universe) {
+  if (new_universe && m_use_port_address) {
+    m_node->SetOutputPortAddress(
+        PortId(), new_universe->UniverseId() % ARTNET_PORT_ADDRESS_COUNT);
+  } else if (new_universe) {
     m_node->SetOutputPortUniverse(
         PortId(), new_universe->UniverseId() % ARTNET_UNIVERSE_COUNT);
   } else {
@@ -52,8 +63,7 @@ void ArtNetInputPort::PostSetUniverse(Universe *old_universe,
     m_node->SetDMXHandler(
         PortId(),
         &m_buffer,
-        NewCallback(static_cast<ola::BasicInputPort*>(this),
-                    &ArtNetInputPort::DmxChanged));
+        NewCallback(this, &ArtNetInputPort::DataReceived));
     m_node->SetOutputPortRDMHandlers(
         PortId(),
         NewCallback(
@@ -77,6 +87,10 @@ void ArtNetInputPort::PostSetUniverse(Universe *old_universe,
   }
 }
 
+void ArtNetInputPort::DataReceived() {
+  DmxChangedAt(m_node->LastReceiveTime());
+}
+
 void ArtNetInputPort::RespondWithTod() {
   ola::rdm::UIDSet uids;
   if (GetUniverse()) {
@@ -91,12 +105,7 @@ string ArtNetInputPort::Description() const {
     return "";
   }
 
-  std::ostringstream str;
-  str << "Art-Net Universe "
-      << static_cast<int>(m_node->NetAddress()) << ":"
-      << static_cast<int>(m_node->SubnetAddress()) << ":"
-      << static_cast<int>(m_node->GetOutputPortUniverse(PortId()));
-  return str.str();
+  return PortAddressToString(m_node->GetOutputPortAddress(PortId()));
 }
 
 void ArtNetInputPort::SendTODWithUIDs(const ola::rdm::UIDSet &uids) {
@@ -110,7 +119,7 @@ void ArtNetInputPort::TriggerDiscovery() {
 
 bool ArtNetOutputPort::WriteDMX(const DmxBuffer &buffer,
                                 OLA_UNUSED uint8_t priority) {
-  if (PortId() >= ARTNET_MAX_PORTS) {
+  if (PortId() >= m_node->InputPortCount()) {
     OLA_WARN << "Invalid Art-Net port id " << PortId();
     return false;
   }
@@ -146,7 +155,10 @@ void ArtNetOutputPort::RunIncrementalDiscovery(
 
 void ArtNetOutputPort::PostSetUniverse(Universe *old_universe,
                                        Universe *new_universe) {
-  if (new_universe) {
+  if (new_universe && m_use_port_address) {
+    m_node->SetInputPortAddress(
+        PortId(), new_universe->UniverseId() % ARTNET_PORT_ADDRESS_COUNT);
+  } else if (new_universe) {
     m_node->SetInputPortUniverse(
         PortId(), new_universe->UniverseId() % ARTNET_UNIVERSE_COUNT);
   } else {
@@ -169,12 +181,7 @@ string ArtNetOutputPort::Description() const {
     return "";
   }
 
-  std::ostringstream str;
-  str << "Art-Net Universe "
-      << static_cast<int>(m_node->NetAddress()) << ":"
-      << static_cast<int>(m_node->SubnetAddress()) << ":"
-      << static_cast<int>(m_node->GetInputPortUniverse(PortId()));
-  return str.str();
+  return PortAddressToString(m_node->GetInputPortAddress(PortId()));
 }
 }  // namespace artnet
 }  // namespace plugin
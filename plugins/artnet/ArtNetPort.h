@@ -36,9 +36,11 @@ class ArtNetInputPort: public BasicInputPort {
   ArtNetInputPort(ArtNetDevice *parent,
                   unsigned int port_id,
                   class PluginAdaptor *plugin_adaptor,
-                  ArtNetNode *node)
+                  ArtNetNode *node,
+                  bool use_port_address = false)
       : BasicInputPort(parent, port_id, plugin_adaptor, true),
-        m_node(node) {}
+        m_node(node),
+        m_use_port_address(use_port_address) {}
 
   const DmxBuffer &ReadDMX() const { return m_buffer; }
 
@@ -57,6 +59,8 @@ class ArtNetInputPort: public BasicInputPort {
  private:
   DmxBuffer m_buffer;
   ArtNetNode *m_node;
+  // Map the OLA universe onto the full 15-bit Port-Address
+  bool m_use_port_address;
 
   /**
    * Send a list of UIDs in a TOD
@@ -67,15 +71,22 @@ class ArtNetInputPort: public BasicInputPort {
    * Run the RDM discovery routine
    */
   void TriggerDiscovery();
+
+  /**
+   * Called when the node has new data for this port.
+   */
+  void DataReceived();
 };
 
 class ArtNetOutputPort: public BasicOutputPort {
  public:
   ArtNetOutputPort(ArtNetDevice *device,
                    unsigned int port_id,
-                   ArtNetNode *node)
+                   ArtNetNode *node,
+                   bool use_port_address = false)
       : BasicOutputPort(device, port_id, true, true),
-        m_node(node) {}
+        m_node(node),
+        m_use_port_address(use_port_address) {}
 
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
 
@@ -114,6 +125,7 @@ class ArtNetOutputPort: public BasicOutputPort {
 
  private:
   ArtNetNode *m_node;
+  bool m_use_port_address;
 };
 }  // namespace artnet
 }  // namespace plugin
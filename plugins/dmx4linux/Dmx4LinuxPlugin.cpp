@@ -182,6 +182,7 @@ bool Dmx4LinuxPlugin::SetupDescriptors() {
       return false;
     }
     m_out_descriptor = new Dmx4LinuxSocket(fd);
+    m_writer = new Dmx4LinuxWriter(m_plugin_adaptor, m_out_descriptor);
 
     fd = open(m_in_dev.c_str(), O_RDONLY | O_NONBLOCK);
     if (fd < 0) {
@@ -205,6 +206,11 @@ int Dmx4LinuxPlugin::CleanupDescriptors() {
     m_in_descriptor = NULL;
   }
 
+  if (m_writer) {
+    delete m_writer;
+    m_writer = NULL;
+  }
+
   if (m_out_descriptor) {
     delete m_out_descriptor;
     m_out_descriptor = NULL;
@@ -244,7 +250,7 @@ bool Dmx4LinuxPlugin::SetupDevice(string family, int d4l_uni, int dir) {
     dev->AddPort(port);
   } else {
     Dmx4LinuxOutputPort *port = new Dmx4LinuxOutputPort(dev,
-                                                        m_out_descriptor,
+                                                        m_writer,
                                                         d4l_uni);
     dev->AddPort(port);
   }
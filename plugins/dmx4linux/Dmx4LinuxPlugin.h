@@ -29,6 +29,7 @@
 #include "ola/plugin_id.h"
 #include "plugins/dmx4linux/Dmx4LinuxPort.h"
 #include "plugins/dmx4linux/Dmx4LinuxSocket.h"
+#include "plugins/dmx4linux/Dmx4LinuxWriter.h"
 
 namespace ola {
 namespace plugin {
@@ -42,6 +43,7 @@ class Dmx4LinuxPlugin: public ola::Plugin {
       Plugin(plugin_adaptor),
       m_in_descriptor(NULL),
       m_out_descriptor(NULL),
+      m_writer(NULL),
       m_in_devices_count(0),
       m_in_buffer(NULL) {}
     ~Dmx4LinuxPlugin();
@@ -69,6 +71,7 @@ class Dmx4LinuxPlugin: public ola::Plugin {
     string m_in_dev;   // path to the dmx input device
     Dmx4LinuxSocket *m_in_descriptor;
     Dmx4LinuxSocket *m_out_descriptor;
+    Dmx4LinuxWriter *m_writer;  // batches the writes to m_out_descriptor
     int m_in_devices_count;  // number of input devices
     uint8_t *m_in_buffer;  // input buffer
 
@@ -18,8 +18,6 @@
  * Copyright (C) 2006 Simon Newton
  */
 
-#include <string.h>
-#include <errno.h>
 #include <ola/Constants.h>
 #include <ola/Logging.h>
 
@@ -33,18 +31,7 @@ namespace dmx4linux {
 
 bool Dmx4LinuxOutputPort::WriteDMX(const DmxBuffer &buffer,
                                    uint8_t priority) {
-  int offset = DMX_UNIVERSE_SIZE * m_d4l_universe;
-  if (lseek(m_socket->WriteDescriptor(), offset, SEEK_SET) == offset) {
-    ssize_t r = m_socket->Send(buffer.GetRaw(), buffer.Size());
-    if ((uint) r != buffer.Size()) {
-      OLA_WARN << "only wrote " << r << "/" << buffer.Size() << " bytes: " <<
-        strerror(errno);
-      return false;
-    }
-  } else {
-    OLA_WARN << "failed to seek: " << strerror(errno);
-    return false;
-  }
+  m_writer->Write(m_d4l_universe, buffer);
   return true;
 }
 
@@ -25,7 +25,7 @@
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "plugins/dmx4linux/Dmx4LinuxDevice.h"
-#include "plugins/dmx4linux/Dmx4LinuxSocket.h"
+#include "plugins/dmx4linux/Dmx4LinuxWriter.h"
 
 namespace ola {
 namespace plugin {
@@ -39,10 +39,10 @@ namespace dmx4linux {
 class Dmx4LinuxOutputPort: public BasicOutputPort {
  public:
   Dmx4LinuxOutputPort(Dmx4LinuxDevice *parent,
-                      Dmx4LinuxSocket *socket,
+                      Dmx4LinuxWriter *writer,
                       int d4l_universe)
     : BasicOutputPort(parent, 0),
-      m_socket(socket),
+      m_writer(writer),
       m_d4l_universe(d4l_universe) {
   }
 
@@ -50,7 +50,7 @@ class Dmx4LinuxOutputPort: public BasicOutputPort {
   string Description() const { return ""; }
 
  private:
-  Dmx4LinuxSocket *m_socket;
+  Dmx4LinuxWriter *m_writer;
   int m_d4l_universe;  // dmx4linux universe that this maps to
 };
 
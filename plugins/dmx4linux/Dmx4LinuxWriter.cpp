@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Dmx4LinuxWriter.cpp
+ * Batches the writes to the dmx4linux output device.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "plugins/dmx4linux/Dmx4LinuxWriter.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+
+namespace ola {
+namespace plugin {
+namespace dmx4linux {
+
+using std::vector;
+
+Dmx4LinuxWriter::Dmx4LinuxWriter(ola::thread::SchedulerInterface *scheduler,
+                                 Dmx4LinuxSocket *socket)
+    : m_scheduler(scheduler),
+      m_socket(socket),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+Dmx4LinuxWriter::~Dmx4LinuxWriter() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_flush_timeout);
+  }
+}
+
+void Dmx4LinuxWriter::Write(unsigned int d4l_universe,
+                            const DmxBuffer &buffer) {
+  m_pending[d4l_universe] = buffer;
+  if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+    // Wait until the end of this pass of the event loop, other universes may
+    // be updated as well.
+    m_flush_timeout = m_scheduler->RegisterSingleTimeout(
+        0, NewSingleCallback(this, &Dmx4LinuxWriter::ScheduledFlush));
+  }
+}
+
+bool Dmx4LinuxWriter::Flush() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  // A run continues while the universes are consecutive and the frames fill
+  // the universe, a short frame would leave a gap in the device.
+  bool ok = true;
+  PendingFrames::const_iterator start = m_pending.begin();
+  while (start != m_pending.end()) {
+    PendingFrames::const_iterator end = start;
+    PendingFrames::const_iterator last = end++;
+    while (end != m_pending.end() && end->first == last->first + 1 &&
+           last->second.Size() == DMX_UNIVERSE_SIZE) {
+      last = end++;
+    }
+    ok &= WriteRun(start, end);
+    start = end;
+  }
+  m_pending.clear();
+  return ok;
+}
+
+void Dmx4LinuxWriter::ScheduledFlush() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  Flush();
+}
+
+bool Dmx4LinuxWriter::WriteRun(PendingFrames::const_iterator start,
+                               PendingFrames::const_iterator end) {
+  vector<struct iovec> iov;
+  size_t length = 0;
+  for (PendingFrames::const_iterator iter = start; iter != end; ++iter) {
+    struct iovec entry;
+    entry.iov_base = const_cast<uint8_t*>(iter->second.GetRaw());
+    entry.iov_len = iter->second.Size();
+    iov.push_back(entry);
+    length += entry.iov_len;
+  }
+
+  off_t offset = static_cast<off_t>(DMX_UNIVERSE_SIZE) * start->first;
+  ssize_t r = pwritev(m_socket->WriteDescriptor(), &iov[0], iov.size(),
+                      offset);
+  if (r < 0 || static_cast<size_t>(r) != length) {
+    OLA_WARN << "only wrote " << r << "/" << length << " bytes at offset "
+             << offset << ": " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+}  // namespace dmx4linux
+}  // namespace plugin
+}  // namespace ola
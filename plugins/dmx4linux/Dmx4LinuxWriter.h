@@ -0,0 +1,80 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Dmx4LinuxWriter.h
+ * Batches the writes to the dmx4linux output device.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef PLUGINS_DMX4LINUX_DMX4LINUXWRITER_H_
+#define PLUGINS_DMX4LINUX_DMX4LINUXWRITER_H_
+
+#include <map>
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "plugins/dmx4linux/Dmx4LinuxSocket.h"
+
+namespace ola {
+namespace plugin {
+namespace dmx4linux {
+
+/*
+ * All the dmx4linux universes share one output device, each universe is at
+ * an offset of 512 * universe. Rather than seeking & writing as each universe
+ * is updated, the frames are held until the end of the current pass of the
+ * event loop. Universes that are next to each other in the device are then
+ * written with a single pwritev() call.
+ */
+class Dmx4LinuxWriter {
+ public:
+  /*
+   * @param scheduler the scheduler to use for the flush timeout.
+   * @param socket the output device, ownership is not transferred.
+   */
+  Dmx4LinuxWriter(ola::thread::SchedulerInterface *scheduler,
+                  Dmx4LinuxSocket *socket);
+  ~Dmx4LinuxWriter();
+
+  /*
+   * Queue a frame for a universe, this replaces any frame for the universe
+   * that hasn't been written yet.
+   */
+  void Write(unsigned int d4l_universe, const DmxBuffer &buffer);
+
+  /*
+   * Write all the queued frames now.
+   * @returns false if any of the writes failed.
+   */
+  bool Flush();
+
+ private:
+  typedef std::map<unsigned int, DmxBuffer> PendingFrames;
+
+  ola::thread::SchedulerInterface *m_scheduler;
+  Dmx4LinuxSocket *m_socket;
+  PendingFrames m_pending;
+  ola::thread::timeout_id m_flush_timeout;
+
+  void ScheduledFlush();
+  bool WriteRun(PendingFrames::const_iterator start,
+                PendingFrames::const_iterator end);
+
+  DISALLOW_COPY_AND_ASSIGN(Dmx4LinuxWriter);
+};
+}  // namespace dmx4linux
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_DMX4LINUX_DMX4LINUXWRITER_H_
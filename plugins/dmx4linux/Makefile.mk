@@ -17,7 +17,9 @@ plugins_dmx4linux_liboladmx4linux_la_SOURCES = \
     plugins/dmx4linux/Dmx4LinuxPlugin.h \
     plugins/dmx4linux/Dmx4LinuxPort.cpp \
     plugins/dmx4linux/Dmx4LinuxPort.h \
-    plugins/dmx4linux/Dmx4LinuxSocket.h
+    plugins/dmx4linux/Dmx4LinuxSocket.h \
+    plugins/dmx4linux/Dmx4LinuxWriter.cpp \
+    plugins/dmx4linux/Dmx4LinuxWriter.h
 plugins_dmx4linux_liboladmx4linux_la_LIBADD = \
     common/libolacommon.la \
     olad/plugin_api/libolaserverplugininterface.la
@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <set>
 #include <string>
 
 #include "ola/StringUtils.h"
@@ -29,6 +30,7 @@
 #include "plugins/dummy/DummyPort.h"
 #include "plugins/dummy/DummyPlugin.h"
 #include "plugins/dummy/DummyPluginDescription.h"
+#include "plugins/dummy/ResponderFarm.h"
 
 namespace ola {
 namespace plugin {
@@ -42,10 +44,18 @@ const uint8_t DummyPlugin::DEFAULT_DEVICE_COUNT = 1;
 // 0 for now, since the web UI doesn't handle it.
 const uint8_t DummyPlugin::DEFAULT_ACK_TIMER_DEVICE_COUNT = 0;
 const uint16_t DummyPlugin::DEFAULT_SUBDEVICE_COUNT = 4;
+const unsigned int DummyPlugin::DEFAULT_FARM_WORKER_THREADS = 2;
+const unsigned int DummyPlugin::DEFAULT_FARM_MAX_LATENCY = 1000;
 const char DummyPlugin::DEVICE_NAME[] = "Dummy Device";
 const char DummyPlugin::DIMMER_COUNT_KEY[] = "dimmer_count";
 const char DummyPlugin::DIMMER_SUBDEVICE_COUNT_KEY[] = "dimmer_subdevice_count";
 const char DummyPlugin::DUMMY_DEVICE_COUNT_KEY[] = "dummy_device_count";
+const char DummyPlugin::FARM_COUNT_KEY[] = "farm_responder_count";
+const char DummyPlugin::FARM_LATENCY_DISTRIBUTION_KEY[] =
+    "farm_latency_distribution";
+const char DummyPlugin::FARM_LATENCY_KEY[] = "farm_latency_ms";
+const char DummyPlugin::FARM_MAX_LATENCY_KEY[] = "farm_max_latency_ms";
+const char DummyPlugin::FARM_WORKER_THREADS_KEY[] = "farm_worker_threads";
 const char DummyPlugin::MOVING_LIGHT_COUNT_KEY[] = "moving_light_count";
 const char DummyPlugin::NETWORK_COUNT_KEY[] = "network_device_count";
 const char DummyPlugin::PLUGIN_NAME[] = "Dummy";
@@ -100,6 +110,33 @@ bool DummyPlugin::StartHook() {
     options.number_of_network_responders = DEFAULT_DEVICE_COUNT;
   }
 
+  if (!StringToInt(m_preferences->GetValue(FARM_COUNT_KEY),
+                   &options.number_of_farm_responders)) {
+    options.number_of_farm_responders = 0;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(FARM_WORKER_THREADS_KEY),
+                   &options.farm_options.worker_threads)) {
+    options.farm_options.worker_threads = DEFAULT_FARM_WORKER_THREADS;
+  }
+
+  if (!ResponderFarm::StringToLatencyDistribution(
+          m_preferences->GetValue(FARM_LATENCY_DISTRIBUTION_KEY),
+          &options.farm_options.latency_distribution)) {
+    options.farm_options.latency_distribution = ResponderFarm::FIXED_LATENCY;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(FARM_LATENCY_KEY),
+                   &options.farm_options.latency_ms)) {
+    options.farm_options.latency_ms = 0;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(FARM_MAX_LATENCY_KEY),
+                   &options.farm_options.max_latency_ms)) {
+    options.farm_options.max_latency_ms = DEFAULT_FARM_MAX_LATENCY;
+  }
+  options.select_server = m_plugin_adaptor;
+
   std::auto_ptr<DummyDevice> device(
       new DummyDevice(this, DEVICE_NAME, options));
   if (!device->Start()) {
@@ -173,6 +210,30 @@ bool DummyPlugin::SetDefaultPreferences() {
                                          IntValidator(0, 254),
                                          DEFAULT_DEVICE_COUNT);
 
+  save |= m_preferences->SetDefaultValue(FARM_COUNT_KEY,
+                                         UIntValidator(0, 65280),
+                                         0u);
+
+  save |= m_preferences->SetDefaultValue(FARM_WORKER_THREADS_KEY,
+                                         UIntValidator(1, 64),
+                                         DEFAULT_FARM_WORKER_THREADS);
+
+  std::set<string> distributions;
+  distributions.insert("fixed");
+  distributions.insert("uniform");
+  distributions.insert("exponential");
+  save |= m_preferences->SetDefaultValue(FARM_LATENCY_DISTRIBUTION_KEY,
+                                         SetValidator<string>(distributions),
+                                         "fixed");
+
+  save |= m_preferences->SetDefaultValue(FARM_LATENCY_KEY,
+                                         UIntValidator(0, 60000),
+                                         0u);
+
+  save |= m_preferences->SetDefaultValue(FARM_MAX_LATENCY_KEY,
+                                         UIntValidator(0, 60000),
+                                         DEFAULT_FARM_MAX_LATENCY);
+
   if (save) {
     m_preferences->Save();
   }
@@ -103,6 +103,10 @@ DummyPort::DummyPort(DummyDevice *parent,
       &m_responders, &allocator, options.number_of_sensor_responders);
   AddResponders<ola::rdm::NetworkResponder>(
       &m_responders, &allocator, options.number_of_network_responders);
+
+  if (options.number_of_farm_responders) {
+    AddFarmResponders(options);
+  }
 }
 
 
@@ -161,6 +165,46 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
 }
 
 
+/*
+ * Create the ResponderFarm and the responders that run on it.
+ */
+void DummyPort::AddFarmResponders(const Options &options) {
+  if (!options.select_server) {
+    OLA_WARN << "No SelectServer provided, not creating the responder farm";
+    return;
+  }
+
+  unsigned int count = options.number_of_farm_responders;
+  if (count > kMaxFarmResponders) {
+    OLA_WARN << "Limiting the responder farm to " << kMaxFarmResponders
+             << " responders";
+    count = kMaxFarmResponders;
+  }
+
+  m_farm.reset(new ResponderFarm(options.select_server,
+                                 options.farm_options));
+
+  UID first_uid(OPEN_LIGHTING_ESTA_CODE, DummyPort::kFarmStartAddress);
+  ola::rdm::UIDAllocator allocator(first_uid);
+  for (unsigned int i = 0; i < count; i++) {
+    auto_ptr<UID> uid(allocator.AllocateNext());
+    if (!uid.get()) {
+      OLA_WARN << "Insufficient UIDs to create the responder farm";
+      break;
+    }
+    DummyResponder *responder = new DummyResponder(*uid);
+    if (i == 0) {
+      ResponderFarm::PrimeResponder(responder, *uid);
+    }
+    STLReplaceAndDelete(&m_responders, *uid, m_farm->AddResponder(responder));
+  }
+
+  if (!m_farm->Start()) {
+    OLA_WARN << "Failed to start the responder farm";
+  }
+}
+
+
 void DummyPort::RunDiscovery(RDMDiscoveryCallback *callback) {
   ola::rdm::UIDSet uid_set;
   for (ResponderMap::iterator i = m_responders.begin();
@@ -190,6 +234,10 @@ void DummyPort::HandleBroadcastAck(broadcast_request_tracker *tracker,
 
 
 DummyPort::~DummyPort() {
+  // The farm responders must not be deleted while the workers are running.
+  if (m_farm.get()) {
+    m_farm->Stop();
+  }
   STLDeleteValues(&m_responders);
 }
 }  // namespace dummy
@@ -22,15 +22,18 @@
 #define PLUGINS_DUMMY_DUMMYPORT_H_
 
 #include <stdint.h>
+#include <memory>
 #include <string>
 #include <map>
 #include <vector>
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/UID.h"
 #include "olad/Port.h"
+#include "plugins/dummy/ResponderFarm.h"
 
 namespace ola {
 namespace plugin {
@@ -48,7 +51,9 @@ class DummyPort: public BasicOutputPort {
           number_of_ack_timer_responders(0),
           number_of_advanced_dimmers(1),
           number_of_sensor_responders(1),
-          number_of_network_responders(1) {
+          number_of_network_responders(1),
+          number_of_farm_responders(0),
+          select_server(NULL) {
     }
 
     uint8_t number_of_dimmers;
@@ -59,6 +64,18 @@ class DummyPort: public BasicOutputPort {
     uint8_t number_of_advanced_dimmers;
     uint8_t number_of_sensor_responders;
     uint8_t number_of_network_responders;
+
+    /**
+     * @brief The number of responders to run on the ResponderFarm.
+     */
+    unsigned int number_of_farm_responders;
+    ResponderFarm::Options farm_options;
+
+    /**
+     * @brief The SelectServer, required if number_of_farm_responders is
+     *   non-0.
+     */
+    ola::io::SelectServerInterface *select_server;
   };
 
 
@@ -97,6 +114,9 @@ class DummyPort: public BasicOutputPort {
 
   DmxBuffer m_buffer;
   ResponderMap m_responders;
+  std::auto_ptr<ResponderFarm> m_farm;
+
+  void AddFarmResponders(const Options &options);
 
   void RunDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void HandleBroadcastAck(broadcast_request_tracker *tracker,
@@ -105,6 +125,10 @@ class DummyPort: public BasicOutputPort {
   // See https://wiki.openlighting.org/index.php/Open_Lighting_Allocations
   // Do not change.
   static const unsigned int kStartAddress = 0xffffff00;
+  // The farm is only used for load testing, so it takes the block below the
+  // regular dummy responders.
+  static const unsigned int kFarmStartAddress = 0xfffe0000;
+  static const unsigned int kMaxFarmResponders = 0xff00;
 };
 }  // namespace dummy
 }  // namespace plugin
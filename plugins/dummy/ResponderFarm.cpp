@@ -0,0 +1,295 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ResponderFarm.cpp
+ * Runs a large number of software RDM responders on worker threads.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/math/Random.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/stl/STLUtils.h"
+#include "plugins/dummy/ResponderFarm.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMControllerInterface;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using ola::thread::ExecutorThread;
+using ola::thread::MutexLocker;
+using std::auto_ptr;
+using std::string;
+
+namespace {
+void DiscardReply(RDMReply*) {}
+}  // namespace
+
+/**
+ * @brief The RDMControllerInterface handed out by AddResponder().
+ */
+class ResponderFarm::FarmResponder : public RDMControllerInterface {
+ public:
+  FarmResponder(ResponderFarm *farm,
+                unsigned int worker,
+                RDMControllerInterface *responder)
+      : m_farm(farm),
+        m_worker(worker),
+        m_responder(responder) {
+  }
+
+  void SendRDMRequest(RDMRequest *request, RDMCallback *callback) {
+    m_farm->Dispatch(m_worker, m_responder.get(), request, callback);
+  }
+
+ private:
+  ResponderFarm *m_farm;
+  const unsigned int m_worker;
+  auto_ptr<RDMControllerInterface> m_responder;
+
+  DISALLOW_COPY_AND_ASSIGN(FarmResponder);
+};
+
+ResponderFarm::ResponderFarm(ola::io::SelectServerInterface *ss,
+                             const Options &options)
+    : m_ss(ss),
+      m_options(options),
+      m_responder_count(0),
+      m_running(false) {
+  unsigned int worker_threads = std::max(1u, m_options.worker_threads);
+  for (unsigned int i = 0; i < worker_threads; i++) {
+    m_workers.push_back(new ExecutorThread(
+        ola::thread::Thread::Options("dummy-farm-" + IntToString(i))));
+  }
+}
+
+ResponderFarm::~ResponderFarm() {
+  Stop();
+  STLDeleteElements(&m_workers);
+}
+
+bool ResponderFarm::Start() {
+  if (m_running) {
+    return false;
+  }
+
+  if (!m_loopback.Init()) {
+    OLA_WARN << "Failed to init the responder farm's LoopbackDescriptor";
+    return false;
+  }
+  m_loopback.SetOnData(NewCallback(this, &ResponderFarm::DeliverReplies));
+  m_ss->AddReadDescriptor(&m_loopback);
+
+  for (Workers::iterator iter = m_workers.begin(); iter != m_workers.end();
+       ++iter) {
+    (*iter)->Start();
+  }
+  m_running = true;
+  OLA_INFO << "Started responder farm with " << m_responder_count
+           << " responders on " << m_workers.size() << " threads";
+  return true;
+}
+
+void ResponderFarm::Stop() {
+  if (!m_running) {
+    return;
+  }
+
+  // This runs any queued requests in this thread.
+  for (Workers::iterator iter = m_workers.begin(); iter != m_workers.end();
+       ++iter) {
+    (*iter)->Stop();
+  }
+  m_running = false;
+
+  m_ss->RemoveReadDescriptor(&m_loopback);
+  m_loopback.Close();
+
+  CompletedRequests completed;
+  {
+    MutexLocker locker(&m_completed_mutex);
+    completed.swap(m_completed);
+  }
+  for (CompletedRequests::iterator iter = completed.begin();
+       iter != completed.end(); ++iter) {
+    delete iter->reply;
+    RunRDMCallback(iter->callback, ola::rdm::RDM_TIMEOUT);
+  }
+
+  DelayedReplies delayed_replies;
+  delayed_replies.swap(m_delayed_replies);
+  for (DelayedReplies::iterator iter = delayed_replies.begin();
+       iter != delayed_replies.end(); ++iter) {
+    m_ss->RemoveTimeout((*iter)->timeout_id);
+    delete (*iter)->reply;
+    RunRDMCallback((*iter)->callback, ola::rdm::RDM_TIMEOUT);
+    delete *iter;
+  }
+}
+
+RDMControllerInterface *ResponderFarm::AddResponder(
+    RDMControllerInterface *responder) {
+  unsigned int worker = m_responder_count++ % m_workers.size();
+  return new FarmResponder(this, worker, responder);
+}
+
+void ResponderFarm::PrimeResponder(RDMControllerInterface *responder,
+                                   const UID &uid) {
+  UID source(0, 0);
+  responder->SendRDMRequest(
+      new ola::rdm::RDMGetRequest(source, uid, 0, 1, ola::rdm::ROOT_RDM_DEVICE,
+                                  ola::rdm::PID_DEVICE_INFO, NULL, 0),
+      NewSingleCallback(&DiscardReply));
+}
+
+bool ResponderFarm::StringToLatencyDistribution(
+    const string &input,
+    LatencyDistribution *distribution) {
+  if (input == "fixed") {
+    *distribution = FIXED_LATENCY;
+  } else if (input == "uniform") {
+    *distribution = UNIFORM_LATENCY;
+  } else if (input == "exponential") {
+    *distribution = EXPONENTIAL_LATENCY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void ResponderFarm::Dispatch(unsigned int worker,
+                             RDMControllerInterface *responder,
+                             RDMRequest *request,
+                             RDMCallback *callback) {
+  if (!m_running) {
+    delete request;
+    RunRDMCallback(callback, ola::rdm::RDM_FAILED_TO_SEND);
+    return;
+  }
+  m_workers[worker]->Execute(NewSingleCallback(
+      this, &ResponderFarm::HandleRequest, responder, request, callback));
+}
+
+/*
+ * Called in a worker thread.
+ */
+void ResponderFarm::HandleRequest(RDMControllerInterface *responder,
+                                  RDMRequest *request,
+                                  RDMCallback *callback) {
+  responder->SendRDMRequest(
+      request,
+      NewSingleCallback(this, &ResponderFarm::RequestComplete, callback));
+}
+
+/*
+ * Called in a worker thread. The reply is only valid for the duration of the
+ * call, so we make a copy to pass back to the SelectServer thread.
+ */
+void ResponderFarm::RequestComplete(RDMCallback *callback, RDMReply *reply) {
+  CompletedRequest completed = {
+    callback,
+    new RDMReply(reply->StatusCode(),
+                 reply->Response() ? reply->Response()->Duplicate() : NULL,
+                 reply->Frames())
+  };
+
+  bool was_empty;
+  {
+    MutexLocker locker(&m_completed_mutex);
+    was_empty = m_completed.empty();
+    m_completed.push_back(completed);
+  }
+  if (was_empty) {
+    uint8_t wake_up = 'a';
+    m_loopback.Send(&wake_up, sizeof(wake_up));
+  }
+}
+
+void ResponderFarm::DeliverReplies() {
+  while (m_loopback.DataRemaining()) {
+    uint8_t message[100];
+    unsigned int size;
+    m_loopback.Receive(message, sizeof(message), size);
+  }
+
+  CompletedRequests completed;
+  {
+    MutexLocker locker(&m_completed_mutex);
+    completed.swap(m_completed);
+  }
+
+  for (CompletedRequests::iterator iter = completed.begin();
+       iter != completed.end(); ++iter) {
+    unsigned int latency = ChooseLatency();
+    if (latency == 0) {
+      iter->callback->Run(iter->reply);
+      delete iter->reply;
+    } else {
+      DelayedReply *delayed_reply = new DelayedReply();
+      delayed_reply->callback = iter->callback;
+      delayed_reply->reply = iter->reply;
+      delayed_reply->timeout_id = m_ss->RegisterSingleTimeout(
+          latency,
+          NewSingleCallback(this, &ResponderFarm::DelayedReplyTimeout,
+                            delayed_reply));
+      m_delayed_replies.insert(delayed_reply);
+    }
+  }
+}
+
+void ResponderFarm::DelayedReplyTimeout(DelayedReply *delayed_reply) {
+  m_delayed_replies.erase(delayed_reply);
+  delayed_reply->callback->Run(delayed_reply->reply);
+  delete delayed_reply->reply;
+  delete delayed_reply;
+}
+
+unsigned int ResponderFarm::ChooseLatency() const {
+  unsigned int latency = 0;
+  switch (m_options.latency_distribution) {
+    case FIXED_LATENCY:
+      latency = m_options.latency_ms;
+      break;
+    case UNIFORM_LATENCY:
+      latency = ola::math::Random(0, 2 * m_options.latency_ms);
+      break;
+    case EXPONENTIAL_LATENCY:
+      {
+        // Avoid 0 since log(0) is undefined.
+        double sample = ola::math::Random(1, RANDOM_RESOLUTION) /
+            static_cast<double>(RANDOM_RESOLUTION);
+        latency = static_cast<unsigned int>(
+            -log(sample) * m_options.latency_ms);
+      }
+      break;
+  }
+  return std::min(latency, m_options.max_latency_ms);
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,209 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ResponderFarm.h
+ * Runs a large number of software RDM responders on worker threads.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef PLUGINS_DUMMY_RESPONDERFARM_H_
+#define PLUGINS_DUMMY_RESPONDERFARM_H_
+
+#include <set>
+#include <string>
+#include <vector>
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/thread/ExecutorThread.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+/**
+ * @brief Runs software responders on a pool of worker threads.
+ *
+ * This is used for load testing, where we want more responders than can be
+ * comfortably handled on the main thread. Each responder is pinned to a
+ * single worker, so the responders themselves don't need to be thread safe.
+ * Replies are passed back to the SelectServer thread, delayed according to
+ * the latency distribution, and the RDMCallbacks are always run there.
+ *
+ * The software responders share their PID tables and personalities between
+ * all instances of a type. These are created on first use, which isn't
+ * thread safe, so a responder of each type should handle a request on the
+ * main thread before Start() is called. See PrimeResponder().
+ */
+class ResponderFarm {
+ public:
+  typedef enum {
+    FIXED_LATENCY,
+    UNIFORM_LATENCY,
+    EXPONENTIAL_LATENCY,
+  } LatencyDistribution;
+
+  struct Options {
+   public:
+    Options()
+        : worker_threads(2),
+          latency_distribution(FIXED_LATENCY),
+          latency_ms(0),
+          max_latency_ms(1000) {
+    }
+
+    /**
+     * @brief The number of worker threads.
+     */
+    unsigned int worker_threads;
+
+    /**
+     * @brief How response latencies are chosen.
+     *
+     * FIXED_LATENCY always uses latency_ms, UNIFORM_LATENCY picks a value
+     * between 0 and 2 * latency_ms and EXPONENTIAL_LATENCY uses an
+     * exponential distribution with a mean of latency_ms.
+     */
+    LatencyDistribution latency_distribution;
+    unsigned int latency_ms;
+
+    /**
+     * @brief The upper bound on the latency of a response.
+     */
+    unsigned int max_latency_ms;
+  };
+
+  /**
+   * @brief Create a new ResponderFarm.
+   * @param ss the SelectServer to run the RDMCallbacks on.
+   * @param options the Options for the farm.
+   */
+  ResponderFarm(ola::io::SelectServerInterface *ss, const Options &options);
+
+  /**
+   * @brief Destructor, this calls Stop().
+   */
+  ~ResponderFarm();
+
+  /**
+   * @brief Start the worker threads.
+   */
+  bool Start();
+
+  /**
+   * @brief Stop the worker threads.
+   *
+   * Any requests that have been handled but not yet replied to have their
+   * callbacks run with RDM_TIMEOUT. Once this returns it's safe to delete the
+   * responders.
+   */
+  void Stop();
+
+  /**
+   * @brief Add a responder to the farm.
+   * @param responder the responder, ownership is transferred.
+   * @returns an RDMControllerInterface which passes requests to the responder
+   *   on a worker thread. The caller owns the returned object, which must not
+   *   be deleted until the farm has been stopped.
+   */
+  ola::rdm::RDMControllerInterface *AddResponder(
+      ola::rdm::RDMControllerInterface *responder);
+
+  /**
+   * @brief The number of responders in the farm.
+   */
+  unsigned int ResponderCount() const { return m_responder_count; }
+
+  /**
+   * @brief The number of replies waiting for their latency to expire.
+   */
+  unsigned int DelayedReplyCount() const { return m_delayed_replies.size(); }
+
+  /**
+   * @brief Send a request to a responder and discard the reply.
+   *
+   * This runs in the calling thread and makes sure any state shared between
+   * responders of the same type has been created.
+   */
+  static void PrimeResponder(ola::rdm::RDMControllerInterface *responder,
+                             const ola::rdm::UID &uid);
+
+  /**
+   * @brief Convert a string to a LatencyDistribution.
+   * @param input one of "fixed", "uniform" or "exponential".
+   * @param distribution the LatencyDistribution to set.
+   * @returns true if the input was valid, false otherwise.
+   */
+  static bool StringToLatencyDistribution(
+      const std::string &input,
+      LatencyDistribution *distribution);
+
+ private:
+  class FarmResponder;
+
+  struct CompletedRequest {
+    ola::rdm::RDMCallback *callback;
+    ola::rdm::RDMReply *reply;
+  };
+
+  struct DelayedReply {
+    ola::rdm::RDMCallback *callback;
+    ola::rdm::RDMReply *reply;
+    ola::thread::timeout_id timeout_id;
+  };
+
+  typedef std::vector<ola::thread::ExecutorThread*> Workers;
+  typedef std::vector<CompletedRequest> CompletedRequests;
+  typedef std::set<DelayedReply*> DelayedReplies;
+
+  ola::io::SelectServerInterface *m_ss;
+  const Options m_options;
+  Workers m_workers;
+  unsigned int m_responder_count;
+  bool m_running;
+
+  // Shared with the worker threads.
+  ola::thread::Mutex m_completed_mutex;
+  CompletedRequests m_completed;
+  ola::io::LoopbackDescriptor m_loopback;
+
+  // Only accessed on the SelectServer thread.
+  DelayedReplies m_delayed_replies;
+
+  void Dispatch(unsigned int worker,
+                ola::rdm::RDMControllerInterface *responder,
+                ola::rdm::RDMRequest *request,
+                ola::rdm::RDMCallback *callback);
+  void HandleRequest(ola::rdm::RDMControllerInterface *responder,
+                     ola::rdm::RDMRequest *request,
+                     ola::rdm::RDMCallback *callback);
+  void RequestComplete(ola::rdm::RDMCallback *callback,
+                       ola::rdm::RDMReply *reply);
+  void DeliverReplies();
+  void DelayedReplyTimeout(DelayedReply *delayed_reply);
+  unsigned int ChooseLatency() const;
+
+  static const int RANDOM_RESOLUTION = 10000;
+
+  DISALLOW_COPY_AND_ASSIGN(ResponderFarm);
+};
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_DUMMY_RESPONDERFARM_H_
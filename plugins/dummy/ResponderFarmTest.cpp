@@ -0,0 +1,254 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ResponderFarmTest.cpp
+ * Test fixture for the ResponderFarm class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/DummyResponder.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/dummy/ResponderFarm.h"
+
+using ola::Clock;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::SelectServer;
+using ola::plugin::dummy::ResponderFarm;
+using ola::rdm::DummyResponder;
+using ola::rdm::RDMControllerInterface;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::UID;
+using std::vector;
+
+class ResponderFarmTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ResponderFarmTest);
+  CPPUNIT_TEST(testRequests);
+  CPPUNIT_TEST(testLatency);
+  CPPUNIT_TEST(testStopWithDelayedReplies);
+  CPPUNIT_TEST(testNotRunning);
+  CPPUNIT_TEST(testLatencyDistribution);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  ResponderFarmTest()
+      : m_source(1, 2) {
+  }
+
+  void setUp();
+  void tearDown();
+
+  void testRequests();
+  void testLatency();
+  void testStopWithDelayedReplies();
+  void testNotRunning();
+  void testLatencyDistribution();
+
+ private:
+  typedef vector<RDMControllerInterface*> Responders;
+
+  UID m_source;
+  SelectServer m_ss;
+  Responders m_responders;
+  vector<UID> m_replies;
+  vector<ola::rdm::RDMStatusCode> m_status_codes;
+  unsigned int m_expected_replies;
+
+  void AddResponders(ResponderFarm *farm, unsigned int count);
+  void SendRequest(unsigned int index);
+  void HandleReply(RDMReply *reply);
+  bool CheckForDelayedReply(const ResponderFarm *farm);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponderFarmTest);
+
+void ResponderFarmTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_replies.clear();
+  m_status_codes.clear();
+  m_expected_replies = 0;
+  // Guard against the test hanging.
+  m_ss.RegisterSingleTimeout(
+      5000, NewSingleCallback(&m_ss, &SelectServer::Terminate));
+}
+
+void ResponderFarmTest::tearDown() {
+  ola::STLDeleteElements(&m_responders);
+}
+
+void ResponderFarmTest::AddResponders(ResponderFarm *farm,
+                                      unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    UID uid(ola::OPEN_LIGHTING_ESTA_CODE, 0xfffe0000 + i);
+    DummyResponder *responder = new DummyResponder(uid);
+    if (i == 0) {
+      ResponderFarm::PrimeResponder(responder, uid);
+    }
+    m_responders.push_back(farm->AddResponder(responder));
+  }
+}
+
+void ResponderFarmTest::SendRequest(unsigned int index) {
+  UID uid(ola::OPEN_LIGHTING_ESTA_CODE, 0xfffe0000 + index);
+  m_responders[index]->SendRDMRequest(
+      new RDMGetRequest(m_source, uid, 0, 1, ola::rdm::ROOT_RDM_DEVICE,
+                        ola::rdm::PID_DEVICE_INFO, NULL, 0),
+      NewSingleCallback(this, &ResponderFarmTest::HandleReply));
+}
+
+void ResponderFarmTest::HandleReply(RDMReply *reply) {
+  m_status_codes.push_back(reply->StatusCode());
+  if (reply->Response()) {
+    m_replies.push_back(reply->Response()->SourceUID());
+  }
+  if (m_status_codes.size() == m_expected_replies) {
+    m_ss.Terminate();
+  }
+}
+
+bool ResponderFarmTest::CheckForDelayedReply(const ResponderFarm *farm) {
+  if (farm->DelayedReplyCount()) {
+    m_ss.Terminate();
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Check requests are handled and the replies run on the SelectServer thread.
+ */
+void ResponderFarmTest::testRequests() {
+  ResponderFarm::Options options;
+  options.worker_threads = 3;
+  ResponderFarm farm(&m_ss, options);
+  AddResponders(&farm, 10);
+  OLA_ASSERT_EQ(10u, farm.ResponderCount());
+  OLA_ASSERT_TRUE(farm.Start());
+
+  m_expected_replies = 10;
+  for (unsigned int i = 0; i < m_responders.size(); i++) {
+    SendRequest(i);
+  }
+  m_ss.Run();
+
+  OLA_ASSERT_EQ(static_cast<size_t>(10), m_status_codes.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(10), m_replies.size());
+  for (unsigned int i = 0; i < m_status_codes.size(); i++) {
+    OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, m_status_codes[i]);
+  }
+  // Every responder replied.
+  std::sort(m_replies.begin(), m_replies.end());
+  for (unsigned int i = 0; i < m_replies.size(); i++) {
+    OLA_ASSERT_EQ(UID(ola::OPEN_LIGHTING_ESTA_CODE, 0xfffe0000 + i),
+                  m_replies[i]);
+  }
+  farm.Stop();
+}
+
+/*
+ * Check replies are delayed.
+ */
+void ResponderFarmTest::testLatency() {
+  ResponderFarm::Options options;
+  options.latency_ms = 50;
+  ResponderFarm farm(&m_ss, options);
+  AddResponders(&farm, 1);
+  OLA_ASSERT_TRUE(farm.Start());
+
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentMonotonicTime(&start);
+  m_expected_replies = 1;
+  SendRequest(0);
+  m_ss.Run();
+  clock.CurrentMonotonicTime(&end);
+
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_status_codes.size());
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, m_status_codes[0]);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 50000));
+  OLA_ASSERT_EQ(0u, farm.DelayedReplyCount());
+}
+
+/*
+ * Check that stopping the farm runs the callbacks for delayed replies.
+ */
+void ResponderFarmTest::testStopWithDelayedReplies() {
+  ResponderFarm::Options options;
+  options.latency_ms = 60000;
+  options.max_latency_ms = 60000;
+  ResponderFarm farm(&m_ss, options);
+  AddResponders(&farm, 1);
+  OLA_ASSERT_TRUE(farm.Start());
+
+  m_expected_replies = 1;
+  SendRequest(0);
+  m_ss.RegisterRepeatingTimeout(
+      5,
+      NewCallback(this, &ResponderFarmTest::CheckForDelayedReply,
+                  static_cast<const ResponderFarm*>(&farm)));
+  m_ss.Run();
+  OLA_ASSERT_EQ(1u, farm.DelayedReplyCount());
+  OLA_ASSERT_TRUE(m_status_codes.empty());
+
+  farm.Stop();
+  OLA_ASSERT_EQ(0u, farm.DelayedReplyCount());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_status_codes.size());
+  OLA_ASSERT_EQ(ola::rdm::RDM_TIMEOUT, m_status_codes[0]);
+}
+
+/*
+ * Check requests fail if the farm isn't running.
+ */
+void ResponderFarmTest::testNotRunning() {
+  ResponderFarm farm(&m_ss, ResponderFarm::Options());
+  AddResponders(&farm, 1);
+
+  SendRequest(0);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_status_codes.size());
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_status_codes[0]);
+}
+
+void ResponderFarmTest::testLatencyDistribution() {
+  ResponderFarm::LatencyDistribution distribution;
+  OLA_ASSERT_TRUE(ResponderFarm::StringToLatencyDistribution(
+      "fixed", &distribution));
+  OLA_ASSERT_EQ(ResponderFarm::FIXED_LATENCY, distribution);
+  OLA_ASSERT_TRUE(ResponderFarm::StringToLatencyDistribution(
+      "uniform", &distribution));
+  OLA_ASSERT_EQ(ResponderFarm::UNIFORM_LATENCY, distribution);
+  OLA_ASSERT_TRUE(ResponderFarm::StringToLatencyDistribution(
+      "exponential", &distribution));
+  OLA_ASSERT_EQ(ResponderFarm::EXPONENTIAL_LATENCY, distribution);
+  OLA_ASSERT_FALSE(ResponderFarm::StringToLatencyDistribution(
+      "normal", &distribution));
+}
@@ -31,6 +31,7 @@
 #include "common/rpc/RpcController.h"
 #include "ola/CallbackRunner.h"
 #include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
@@ -46,6 +47,7 @@ namespace e131 {
 const char E131Device::DEVICE_NAME[] = "E1.31 (DMX over ACN)";
 
 using ola::acn::E131Node;
+using ola::network::IPV4Address;
 using ola::rpc::RpcController;
 using std::ostringstream;
 using std::set;
@@ -64,7 +66,8 @@ E131Device::E131Device(Plugin *owner,
       m_plugin_adaptor(plugin_adaptor),
       m_options(options),
       m_ip_addr(ip_addr),
-      m_cid(cid) {
+      m_cid(cid),
+      m_source_list_generation(0) {
 }
 
 
@@ -99,6 +102,15 @@ bool E131Device::StartHook() {
   }
 
   m_plugin_adaptor->AddReadDescriptor(m_node->GetSocket());
+  vector<ola::network::UDPSocket*> sockets;
+  m_node->GetReceiveSockets(&sockets);
+  vector<ola::network::UDPSocket*>::iterator iter = sockets.begin();
+  for (; iter != sockets.end(); ++iter) {
+    m_plugin_adaptor->AddReadDescriptor(*iter);
+  }
+  if (m_node->GetPacketRing()) {
+    m_plugin_adaptor->AddReadDescriptor(m_node->GetPacketRing());
+  }
   return true;
 }
 
@@ -108,6 +120,15 @@ bool E131Device::StartHook() {
  */
 void E131Device::PrePortStop() {
   m_plugin_adaptor->RemoveReadDescriptor(m_node->GetSocket());
+  vector<ola::network::UDPSocket*> sockets;
+  m_node->GetReceiveSockets(&sockets);
+  vector<ola::network::UDPSocket*>::iterator iter = sockets.begin();
+  for (; iter != sockets.end(); ++iter) {
+    m_plugin_adaptor->RemoveReadDescriptor(*iter);
+  }
+  if (m_node->GetPacketRing()) {
+    m_plugin_adaptor->RemoveReadDescriptor(m_node->GetPacketRing());
+  }
 }
 
 
@@ -117,6 +138,7 @@ void E131Device::PrePortStop() {
 void E131Device::PostPortStop() {
   m_node->Stop();
   m_node.reset();
+  m_source_list_reply.clear();
 }
 
 
@@ -148,6 +170,9 @@ void E131Device::Configure(RpcController *controller,
     case ola::plugin::e131::Request::E131_SOURCES_LIST:
       HandleSourceListRequest(&request_pb, response);
       break;
+    case ola::plugin::e131::Request::E131_SOURCE_FILTER:
+      HandleSourceFilter(controller, &request_pb, response);
+      break;
     default:
       controller->SetFailed("Invalid Request");
   }
@@ -212,6 +237,14 @@ void E131Device::HandleSourceListRequest(const Request *request,
                                          string *response) {
   typedef std::vector<E131Node::KnownController> KnownControllerList;
   (void) request;
+
+  // The web UI polls this, only rebuild the reply if the sources changed.
+  if (m_options.enable_draft_discovery && !m_source_list_reply.empty() &&
+      m_node->DiscoveryDirectory().Generation() == m_source_list_generation) {
+    *response = m_source_list_reply;
+    return;
+  }
+
   ola::plugin::e131::Reply reply;
   reply.set_type(ola::plugin::e131::Reply::E131_SOURCES_LIST);
   ola::plugin::e131::SourceListReply *sources_reply =
@@ -222,6 +255,7 @@ void E131Device::HandleSourceListRequest(const Request *request,
   } else {
     sources_reply->set_unsupported(false);
     KnownControllerList controllers;
+    m_source_list_generation = m_node->DiscoveryDirectory().Generation();
     m_node->GetKnownControllers(&controllers);
 
     KnownControllerList::const_iterator iter = controllers.begin();
@@ -239,6 +273,58 @@ void E131Device::HandleSourceListRequest(const Request *request,
   }
 
   reply.SerializeToString(response);
+  if (m_options.enable_draft_discovery) {
+    m_source_list_reply = *response;
+  }
+}
+
+/*
+ * Set the source filter for a universe, and return all the filters.
+ */
+void E131Device::HandleSourceFilter(RpcController *controller,
+                                    const Request *request,
+                                    string *response) {
+  if (request->has_source_filter()) {
+    const ola::plugin::e131::SourceFilterRequest &filter_request =
+        request->source_filter();
+    // 63999 is the highest E1.31 universe.
+    if (filter_request.universe() < 1 || filter_request.universe() > 63999) {
+      controller->SetFailed("Invalid universe");
+      return;
+    }
+
+    E131Node::SourceSet sources;
+    for (int i = 0; i < filter_request.source_size(); i++) {
+      IPV4Address source;
+      if (!IPV4Address::FromString(filter_request.source(i), &source)) {
+        controller->SetFailed("Invalid source " + filter_request.source(i));
+        return;
+      }
+      sources.insert(source);
+    }
+
+    if (!m_node->SetSourceFilter(filter_request.universe(), sources)) {
+      controller->SetFailed("Failed to join the multicast group");
+      return;
+    }
+  }
+
+  ola::plugin::e131::Reply reply;
+  reply.set_type(ola::plugin::e131::Reply::E131_SOURCE_FILTER);
+  ola::plugin::e131::SourceFilterReply *filter_reply =
+      reply.mutable_source_filter();
+
+  const E131Node::SourceFilters &filters = m_node->GetSourceFilters();
+  E131Node::SourceFilters::const_iterator iter = filters.begin();
+  for (; iter != filters.end(); ++iter) {
+    ola::plugin::e131::SourceFilter *filter = filter_reply->add_filter();
+    filter->set_universe(iter->first);
+    E131Node::SourceSet::const_iterator source_iter = iter->second.begin();
+    for (; source_iter != iter->second.end(); ++source_iter) {
+      filter->add_source(source_iter->ToString());
+    }
+  }
+  reply.SerializeToString(response);
 }
 
 E131InputPort *E131Device::GetE131InputPort(unsigned int port_id) {
@@ -76,12 +76,18 @@ class E131Device: public ola::Device {
   std::vector<E131OutputPort*> m_output_ports;
   std::string m_ip_addr;
   ola::acn::CID m_cid;
+  // The last source list reply, rebuilt when the discovery directory changes.
+  std::string m_source_list_reply;
+  uint32_t m_source_list_generation;
 
   void HandlePreviewMode(const ola::plugin::e131::Request *request,
                          std::string *response);
   void HandlePortStatusRequest(std::string *response);
   void HandleSourceListRequest(const ola::plugin::e131::Request *request,
                                std::string *response);
+  void HandleSourceFilter(ola::rpc::RpcController *controller,
+                          const ola::plugin::e131::Request *request,
+                          std::string *response);
 
   E131InputPort *GetE131InputPort(unsigned int port_id);
   E131OutputPort *GetE131OutputPort(unsigned int port_id);
@@ -20,8 +20,10 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/StringUtils.h"
 #include "ola/acn/CID.h"
@@ -45,13 +47,19 @@ const char E131Plugin::DRAFT_DISCOVERY_KEY[] = "draft_discovery";
 const char E131Plugin::IGNORE_PREVIEW_DATA_KEY[] = "ignore_preview";
 const char E131Plugin::INPUT_PORT_COUNT_KEY[] = "input_ports";
 const char E131Plugin::IP_KEY[] = "ip";
+const char E131Plugin::MAX_MERGE_SOURCES_KEY[] = "max_merge_sources";
 const char E131Plugin::OUTPUT_PORT_COUNT_KEY[] = "output_ports";
+const char E131Plugin::PACKET_RING_KEY[] = "packet_ring";
 const char E131Plugin::PLUGIN_NAME[] = "E1.31 (sACN)";
 const char E131Plugin::PLUGIN_PREFIX[] = "e131";
 const char E131Plugin::PREPEND_HOSTNAME_KEY[] = "prepend_hostname";
+const char E131Plugin::RECEIVE_SOCKETS_KEY[] = "receive_sockets";
+const char E131Plugin::REDUNDANT_IP_KEY[] = "redundant_ip";
 const char E131Plugin::REVISION_0_2[] = "0.2";
 const char E131Plugin::REVISION_0_46[] = "0.46";
 const char E131Plugin::REVISION_KEY[] = "revision";
+const char E131Plugin::SOURCE_FILTER_KEY[] = "source_filter";
+const char E131Plugin::SYNC_UNIVERSE_KEY[] = "sync_universe";
 const unsigned int E131Plugin::DEFAULT_PORT_COUNT = 5;
 
 
@@ -86,6 +94,38 @@ bool E131Plugin::StartHook() {
     options.dscp = dscp << 2;
   }
 
+  if (!StringToInt(m_preferences->GetValue(MAX_MERGE_SOURCES_KEY),
+                   &options.max_merge_sources)) {
+    OLA_WARN << "Invalid value for max_merge_sources";
+  }
+
+  if (!StringToInt(m_preferences->GetValue(RECEIVE_SOCKETS_KEY),
+                   &options.receive_sockets)) {
+    OLA_WARN << "Invalid value for receive_sockets";
+  }
+  options.use_packet_ring = m_preferences->GetValueAsBool(PACKET_RING_KEY);
+  options.export_map = m_plugin_adaptor->GetExportMap();
+  options.transmit_pacer = m_plugin_adaptor->GetTransmitPacer();
+
+  StringSplit(m_preferences->GetValue(REDUNDANT_IP_KEY),
+              &options.redundant_interfaces, ",");
+  std::vector<string>::iterator iter = options.redundant_interfaces.begin();
+  while (iter != options.redundant_interfaces.end()) {
+    StringTrim(&(*iter));
+    if (iter->empty()) {
+      iter = options.redundant_interfaces.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  if (!StringToInt(m_preferences->GetValue(SYNC_UNIVERSE_KEY),
+                   &options.sync_universe)) {
+    OLA_WARN << "Invalid value for sync_universe";
+  }
+
+  ParseSourceFilters(&options.source_filters);
+
   if (!StringToInt(m_preferences->GetValue(INPUT_PORT_COUNT_KEY),
                    &options.input_ports)) {
     OLA_WARN << "Invalid value for input_ports";
@@ -108,6 +148,47 @@ bool E131Plugin::StartHook() {
 }
 
 
+/*
+ * Parse the source_filter values, each of which is
+ * <universe>:<ip>[,<ip>...].
+ */
+void E131Plugin::ParseSourceFilters(
+    ola::acn::E131Node::SourceFilters *filters) {
+  std::vector<string> values = m_preferences->GetMultipleValue(
+      SOURCE_FILTER_KEY);
+  std::vector<string>::const_iterator iter = values.begin();
+  for (; iter != values.end(); ++iter) {
+    std::vector<string> tokens;
+    StringSplit(*iter, &tokens, ":");
+    uint16_t universe;
+    if (tokens.size() != 2 || !StringToInt(tokens[0], &universe) ||
+        universe == 0) {
+      OLA_WARN << "Invalid source_filter " << *iter;
+      continue;
+    }
+
+    std::vector<string> sources;
+    StringSplit(tokens[1], &sources, ",");
+    ola::acn::E131Node::SourceSet source_set;
+    std::vector<string>::iterator source_iter = sources.begin();
+    for (; source_iter != sources.end(); ++source_iter) {
+      StringTrim(&(*source_iter));
+      ola::network::IPV4Address source;
+      if (!ola::network::IPV4Address::FromString(*source_iter, &source)) {
+        OLA_WARN << "Invalid source " << *source_iter << " for universe "
+                 << universe;
+        continue;
+      }
+      source_set.insert(source);
+    }
+
+    if (!source_set.empty()) {
+      (*filters)[universe].insert(source_set.begin(), source_set.end());
+    }
+  }
+}
+
+
 /*
  * Stop the plugin
  * @return true on success, false on failure
@@ -175,11 +256,29 @@ bool E131Plugin::SetDefaultPreferences() {
 
   save |= m_preferences->SetDefaultValue(IP_KEY, StringValidator(true), "");
 
+  save |= m_preferences->SetDefaultValue(
+      MAX_MERGE_SOURCES_KEY,
+      UIntValidator(1, MAX_MERGE_SOURCES_LIMIT),
+      ola::acn::DMPE131Inflator::DEFAULT_MAX_MERGE_SOURCES);
+
+  save |= m_preferences->SetDefaultValue(
+      PACKET_RING_KEY,
+      BoolValidator(),
+      false);
+
   save |= m_preferences->SetDefaultValue(
       PREPEND_HOSTNAME_KEY,
       BoolValidator(),
       true);
 
+  save |= m_preferences->SetDefaultValue(
+      RECEIVE_SOCKETS_KEY,
+      UIntValidator(1, RECEIVE_SOCKETS_LIMIT),
+      1u);
+
+  save |= m_preferences->SetDefaultValue(REDUNDANT_IP_KEY,
+                                        StringValidator(true), "");
+
   std::set<string> revision_values;
   revision_values.insert(REVISION_0_2);
   revision_values.insert(REVISION_0_46);
@@ -189,6 +288,12 @@ bool E131Plugin::SetDefaultPreferences() {
       SetValidator<string>(revision_values),
       REVISION_0_46);
 
+  // 0 disables sync, 63999 is the highest E1.31 universe.
+  save |= m_preferences->SetDefaultValue(
+      SYNC_UNIVERSE_KEY,
+      UIntValidator(0, 63999),
+      0u);
+
   if (save) {
     m_preferences->Save();
   }
@@ -22,6 +22,7 @@
 #define PLUGINS_E131_E131PLUGIN_H_
 
 #include <string>
+#include "libs/acn/E131Node.h"
 #include "olad/Plugin.h"
 #include "ola/plugin_id.h"
 
@@ -42,11 +43,13 @@ class E131Plugin: public ola::Plugin {
     ola_plugin_id Id() const { return OLA_PLUGIN_E131; }
     std::string Description() const;
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreading() const { return true; }
 
  private:
     bool StartHook();
     bool StopHook();
     bool SetDefaultPreferences();
+    void ParseSourceFilters(ola::acn::E131Node::SourceFilters *filters);
 
     E131Device *m_device;
     static const char CID_KEY[];
@@ -57,13 +60,21 @@ class E131Plugin: public ola::Plugin {
     static const char IGNORE_PREVIEW_DATA_KEY[];
     static const char INPUT_PORT_COUNT_KEY[];
     static const char IP_KEY[];
+    static const char MAX_MERGE_SOURCES_KEY[];
+    static const unsigned int MAX_MERGE_SOURCES_LIMIT = 64;
     static const char OUTPUT_PORT_COUNT_KEY[];
+    static const char PACKET_RING_KEY[];
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char PREPEND_HOSTNAME_KEY[];
+    static const char RECEIVE_SOCKETS_KEY[];
+    static const unsigned int RECEIVE_SOCKETS_LIMIT = 16;
+    static const char REDUNDANT_IP_KEY[];
     static const char REVISION_0_2[];
     static const char REVISION_0_46[];
     static const char REVISION_KEY[];
+    static const char SOURCE_FILTER_KEY[];
+    static const char SYNC_UNIVERSE_KEY[];
 };
 }  // namespace e131
 }  // namespace plugin
@@ -18,8 +18,10 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <algorithm>
 #include <string>
 #include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
 #include "olad/Universe.h"
 #include "plugins/e131/E131Port.h"
 #include "plugins/e131/E131Device.h"
@@ -65,9 +67,12 @@ void E131InputPort::PostSetUniverse(Universe *old_universe,
         new_universe->UniverseId(),
         &m_buffer,
         &m_priority,
-        NewCallback<E131InputPort, void>(this, &E131InputPort::DmxChanged));
+        NewCallback<E131InputPort, void>(this, &E131InputPort::DmxChanged),
+        &m_slot_priorities);
 }
 
+const unsigned int E131OutputPort::SLOT_PRIORITY_REFRESH_MS;
+
 E131OutputPort::~E131OutputPort() {
   Universe *universe = GetUniverse();
   if (universe) {
@@ -99,9 +104,48 @@ bool E131OutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
 
   m_last_priority = (GetPriorityMode() == PRIORITY_MODE_STATIC) ?
       GetPriority() : priority;
+  const DmxBuffer &slot_priorities = universe->SlotPriorities();
+  if (slot_priorities.Size()) {
+    SendSlotPriorities(universe->UniverseId(), buffer, slot_priorities);
+  } else {
+    m_slot_priorities.Reset();
+  }
   return m_node->SendDMX(universe->UniverseId(), buffer, m_last_priority,
                          m_preview_on);
 }
+
+
+/*
+ * Send the slot priorities of the universe, if they've changed or it's time
+ * to refresh them. They're sent before the data so a receiver has them when
+ * the data arrives.
+ */
+void E131OutputPort::SendSlotPriorities(uint16_t universe,
+                                        const DmxBuffer &buffer,
+                                        const DmxBuffer &slot_priorities) {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  // The priority frame shares the packet template with the data, so keep
+  // it the same size.
+  DmxBuffer priorities(slot_priorities.GetRaw(),
+                       std::min(slot_priorities.Size(), buffer.Size()));
+  if (priorities.Size() < buffer.Size()) {
+    priorities.SetRangeToValue(priorities.Size(),
+                               ola::dmx::SLOT_PRIORITY_NOT_SOURCED,
+                               buffer.Size() - priorities.Size());
+  }
+
+  if (priorities == m_slot_priorities &&
+      now < m_slot_priorities_sent +
+            TimeInterval(0, SLOT_PRIORITY_REFRESH_MS * 1000)) {
+    return;
+  }
+  if (m_node->SendSlotPriorities(universe, priorities, m_last_priority,
+                                 m_preview_on)) {
+    m_slot_priorities = priorities;
+    m_slot_priorities_sent = now;
+  }
+}
 }  // namespace e131
 }  // namespace plugin
 }  // namespace ola
@@ -22,6 +22,7 @@
 #define PLUGINS_E131_E131PORT_H_
 
 #include <string>
+#include "ola/Clock.h"
 #include "olad/Port.h"
 #include "plugins/e131/E131Device.h"
 #include "libs/acn/E131Node.h"
@@ -59,9 +60,13 @@ class E131InputPort: public BasicInputPort {
   const ola::DmxBuffer &ReadDMX() const { return m_buffer; }
   bool SupportsPriorities() const { return true; }
   uint8_t InheritedPriority() const { return m_priority; }
+  const ola::DmxBuffer *InheritedSlotPriorities() const {
+    return &m_slot_priorities;
+  }
 
  private:
   ola::DmxBuffer m_buffer;
+  ola::DmxBuffer m_slot_priorities;
   ola::acn::E131Node *m_node;
   E131PortHelper m_helper;
   uint8_t m_priority;
@@ -99,6 +104,16 @@ class E131OutputPort: public BasicOutputPort {
   ola::DmxBuffer m_buffer;
   ola::acn::E131Node *m_node;
   E131PortHelper m_helper;
+  ola::Clock m_clock;
+  ola::DmxBuffer m_slot_priorities;
+  TimeStamp m_slot_priorities_sent;
+
+  void SendSlotPriorities(uint16_t universe, const DmxBuffer &buffer,
+                          const DmxBuffer &slot_priorities);
+
+  // Unchanged slot priorities are resent at this interval, well inside the
+  // 2.5s a receiver waits before it drops them.
+  static const unsigned int SLOT_PRIORITY_REFRESH_MS = 1000;
 };
 }  // namespace e131
 }  // namespace plugin
@@ -21,12 +21,14 @@
 #include <string.h>
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include "ola/Logging.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/MACAddress.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/UDPPacketBuilder.h"
 #include "plugins/espnet/EspNetNode.h"
 
 
@@ -38,6 +40,7 @@ using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::NetworkToHost;
+using ola::network::UDPPacketBuilder;
 using ola::network::UDPSocket;
 using ola::Callback0;
 using std::map;
@@ -50,7 +53,8 @@ const char EspNetNode::NODE_NAME[] = "OLA Node";
  * @param ip_address the IP address to prefer to listen on, if NULL we choose
  * one.
  */
-EspNetNode::EspNetNode(const string &ip_address)
+EspNetNode::EspNetNode(const string &ip_address,
+                       ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_options(DEFAULT_OPTIONS),
       m_tos(DEFAULT_TOS),
@@ -58,7 +62,8 @@ EspNetNode::EspNetNode(const string &ip_address)
       m_universe(0),
       m_type(ESPNET_NODE_TYPE_IO),
       m_node_name(NODE_NAME),
-      m_preferred_ip(ip_address) {
+      m_preferred_ip(ip_address),
+      m_socket(socket ? socket : new UDPSocket()) {
 }
 
 
@@ -125,7 +130,7 @@ void EspNetNode::SocketReady() {
   ola::network::IPV4SocketAddress source;
 
   ssize_t packet_size = sizeof(packet);
-  if (!m_socket.RecvFrom(reinterpret_cast<uint8_t*>(&packet),
+  if (!m_socket->RecvFrom(reinterpret_cast<uint8_t*>(&packet),
                          &packet_size,
                          &source)) {
     return;
@@ -241,21 +246,22 @@ bool EspNetNode::SendDMX(uint8_t universe, const ola::DmxBuffer &buffer) {
  * Setup the networking components.
  */
 bool EspNetNode::InitNetwork() {
-  if (!m_socket.Init()) {
+  if (!m_socket->Init()) {
     OLA_WARN << "Socket init failed";
     return false;
   }
 
-  if (!m_socket.Bind(IPV4SocketAddress(IPV4Address::WildCard(), ESPNET_PORT))) {
+  if (!m_socket->Bind(IPV4SocketAddress(IPV4Address::WildCard(),
+                                        ESPNET_PORT))) {
     return false;
   }
 
-  if (!m_socket.EnableBroadcast()) {
+  if (!m_socket->EnableBroadcast()) {
     OLA_WARN << "Failed to enable broadcasting";
     return false;
   }
 
-  m_socket.SetOnData(NewCallback(this, &EspNetNode::SocketReady));
+  m_socket->SetOnData(NewCallback(this, &EspNetNode::SocketReady));
   return true;
 }
 
@@ -409,15 +415,21 @@ bool EspNetNode::SendEspData(const IPV4Address &dst,
                              uint8_t universe,
                              const DmxBuffer &buffer) {
   espnet_packet_union_t packet;
-  memset(&packet.dmx, 0, sizeof(packet.dmx));
+  memset(&packet.dmx, 0, sizeof(packet.dmx) - DMX_UNIVERSE_SIZE);
   packet.dmx.head = HostToNetwork((uint32_t) ESPNET_DMX);
   packet.dmx.universe = universe;
   packet.dmx.start = START_CODE;
   packet.dmx.type = DATA_RAW;
-  unsigned int size = DMX_UNIVERSE_SIZE;
-  buffer.Get(packet.dmx.data, &size);
+  unsigned int size = buffer.Size();
   packet.dmx.size = HostToNetwork((uint16_t) size);
-  return SendPacket(dst, packet, sizeof(packet.dmx));
+
+  // Send the DMX data from the buffer, rather than copying it into the
+  // packet. The packet is always a full universe.
+  UDPPacketBuilder builder;
+  builder.Append(&packet, sizeof(packet.dmx) - DMX_UNIVERSE_SIZE);
+  builder.AppendDMX(buffer);
+  builder.AppendPadding(DMX_UNIVERSE_SIZE - size);
+  return builder.SendTo(m_socket.get(), IPV4SocketAddress(dst, ESPNET_PORT));
 }
 
 
@@ -427,7 +439,7 @@ bool EspNetNode::SendEspData(const IPV4Address &dst,
 bool EspNetNode::SendPacket(const IPV4Address &dst,
                             const espnet_packet_union_t &packet,
                             unsigned int size) {
-  ssize_t bytes_sent = m_socket.SendTo(
+  ssize_t bytes_sent = m_socket->SendTo(
       reinterpret_cast<const uint8_t*>(&packet),
       size,
       IPV4SocketAddress(dst, ESPNET_PORT));
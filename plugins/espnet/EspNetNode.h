@@ -21,8 +21,9 @@
 #ifndef PLUGINS_ESPNET_ESPNETNODE_H_
 #define PLUGINS_ESPNET_ESPNETNODE_H_
 
-#include <string>
 #include <map>
+#include <memory>
+#include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
@@ -49,7 +50,12 @@ enum { ESPNET_MAX_UNIVERSES = 512 };
 
 class EspNetNode {
  public:
-    explicit EspNetNode(const std::string &ip_address);
+    /*
+     * Create a new node. If socket is NULL a UDPSocket is created, otherwise
+     * ownership of the socket is transferred.
+     */
+    explicit EspNetNode(const std::string &ip_address,
+                        ola::network::UDPSocketInterface *socket = NULL);
     virtual ~EspNetNode();
 
     bool Start();
@@ -64,7 +70,7 @@ class EspNetNode {
     void SetUniverse(uint8_t universe) { m_universe = universe; }
 
     // IO methods
-    ola::network::UDPSocket* GetSocket() { return &m_socket; }
+    ola::network::UDPSocketInterface* GetSocket() { return m_socket.get(); }
     void SocketReady();
 
     // DMX Receiving methods
@@ -115,7 +121,7 @@ class EspNetNode {
     std::string m_preferred_ip;
     std::map<uint8_t, universe_handler> m_handlers;
     ola::network::Interface m_interface;
-    ola::network::UDPSocket m_socket;
+    std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
     RunLengthDecoder m_decoder;
 
     static const char NODE_NAME[];
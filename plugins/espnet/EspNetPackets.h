@@ -28,6 +28,7 @@
 #endif  // _WIN32
 
 #include "ola/network/MACAddress.h"
+#include "ola/network/WireLayout.h"
 #include "ola/Constants.h"
 
 namespace ola {
@@ -137,6 +138,13 @@ typedef union {
   espnet_ack_t ack;
   espnet_data_t dmx;
 } espnet_packet_union_t;
+
+// Check the layouts match the ESP Net protocol.
+WIRE_SIZE_ASSERT(espnet_poll_t, 5);
+WIRE_SIZE_ASSERT(espnet_node_config_t, 6);
+WIRE_SIZE_ASSERT(espnet_poll_reply_t, 23 + ESPNET_NAME_LENGTH);
+WIRE_SIZE_ASSERT(espnet_ack_t, 6);
+WIRE_SIZE_ASSERT(espnet_data_t, 9 + DMX_UNIVERSE_SIZE);
 }  // namespace espnet
 }  // namespace plugin
 }  // namespace ola
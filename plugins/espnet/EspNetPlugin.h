@@ -42,6 +42,7 @@ class EspNetPlugin: public ola::Plugin {
     std::string Description() const;
     ola_plugin_id Id() const { return OLA_PLUGIN_ESPNET; }
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreading() const { return true; }
 
  private:
     bool StartHook();
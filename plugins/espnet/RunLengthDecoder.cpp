@@ -18,8 +18,10 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <string.h>
 #include <ola/Constants.h>
 #include <ola/base/Macro.h>
+#include <algorithm>
 #include "plugins/espnet/RunLengthDecoder.h"
 
 namespace ola {
@@ -31,32 +33,46 @@ namespace espnet {
  * @param dst the DmxBuffer to store the result
  * @param src_data the data to decode
  * @param length the length of the data to decode
+ *
+ * The frame is decoded into a local array and copied into dst once, rather
+ * than updating dst a slot at a time. A repeat or escape that is cut off by
+ * the end of the data is ignored.
  */
 void RunLengthDecoder::Decode(DmxBuffer *dst,
                               const uint8_t *src_data,
                               unsigned int length) {
-  dst->Reset();
+  uint8_t frame[DMX_UNIVERSE_SIZE];
   unsigned int i = 0;
   const uint8_t *value = src_data;
-  uint8_t count;
-  while (i < DMX_UNIVERSE_SIZE && value < src_data + length) {
+  const uint8_t *end = src_data + length;
+  while (i < DMX_UNIVERSE_SIZE && value < end) {
     switch (*value) {
       case REPEAT_VALUE:
-        value++;
-        count = *(value++);
-        dst->SetRangeToValue(i, *value, count);
-        i+= count;
+        {
+          if (end - value < 3) {
+            value = end;
+            break;
+          }
+          unsigned int count = std::min(static_cast<unsigned int>(value[1]),
+                                        DMX_UNIVERSE_SIZE - i);
+          memset(frame + i, value[2], count);
+          i += count;
+          value += 3;
+        }
         break;
       case ESCAPE_VALUE:
+        if (end - value < 2) {
+          value = end;
+          break;
+        }
         value++;
         // fall through
         OLA_FALLTHROUGH
       default:
-        dst->SetChannel(i, *value);
-        i++;
+        frame[i++] = *value++;
     }
-    value++;
   }
+  dst->Set(frame, i);
 }
 }  // namespace espnet
 }  // namespace plugin
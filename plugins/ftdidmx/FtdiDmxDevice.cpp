@@ -37,10 +37,14 @@ using std::string;
 
 FtdiDmxDevice::FtdiDmxDevice(AbstractPlugin *owner,
                              const FtdiWidgetInfo &widget_info,
-                             unsigned int frequency)
+                             unsigned int frequency,
+                             unsigned int rt_priority,
+                             int cpu)
     : Device(owner, widget_info.Description()),
       m_widget_info(widget_info),
-      m_frequency(frequency) {
+      m_frequency(frequency),
+      m_rt_priority(rt_priority),
+      m_cpu(cpu) {
   m_widget = new FtdiWidget(widget_info.Serial(),
                             widget_info.Name(),
                             widget_info.Id(),
@@ -64,7 +68,8 @@ bool FtdiDmxDevice::StartHook() {
     FtdiInterface *port = new FtdiInterface(m_widget,
                                             static_cast<ftdi_interface>(i));
     if (port->SetupOutput()) {
-      AddPort(new FtdiDmxOutputPort(this, port, i, m_frequency));
+      AddPort(new FtdiDmxOutputPort(this, port, i, m_frequency,
+                                    m_rt_priority, m_cpu));
       successfully_added += 1;
     } else {
       OLA_WARN << "Failed to add interface: " << i;
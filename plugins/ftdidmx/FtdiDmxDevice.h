@@ -41,7 +41,9 @@ class FtdiDmxDevice : public Device {
  public:
   FtdiDmxDevice(AbstractPlugin *owner,
                 const FtdiWidgetInfo &widget_info,
-                unsigned int frequency);
+                unsigned int frequency,
+                unsigned int rt_priority = 0,
+                int cpu = -1);
   ~FtdiDmxDevice();
 
   std::string DeviceId() const { return m_widget->Serial(); }
@@ -59,6 +61,8 @@ class FtdiDmxDevice : public Device {
   FtdiWidget *m_widget;
   const FtdiWidgetInfo m_widget_info;
   unsigned int m_frequency;
+  unsigned int m_rt_priority;
+  int m_cpu;
 };
 }  // namespace ftdidmx
 }  // namespace plugin
@@ -41,7 +41,9 @@ namespace ftdidmx {
 using std::string;
 using std::vector;
 
+const char FtdiDmxPlugin::K_CPU[] = "cpu";
 const char FtdiDmxPlugin::K_FREQUENCY[] = "frequency";
+const char FtdiDmxPlugin::K_RT_PRIORITY[] = "rt_priority";
 const char FtdiDmxPlugin::PLUGIN_NAME[] = "FTDI USB DMX";
 const char FtdiDmxPlugin::PLUGIN_PREFIX[] = "ftdidmx";
 
@@ -72,10 +74,17 @@ bool FtdiDmxPlugin::StartHook() {
   unsigned int frequency = StringToIntOrDefault(
       m_preferences->GetValue(K_FREQUENCY),
       DEFAULT_FREQUENCY);
+  unsigned int rt_priority = StringToIntOrDefault(
+      m_preferences->GetValue(K_RT_PRIORITY),
+      DEFAULT_RT_PRIORITY);
+  int cpu = DEFAULT_CPU;
+  if (!StringToInt(m_preferences->GetValue(K_CPU), &cpu)) {
+    cpu = DEFAULT_CPU;
+  }
 
   FtdiWidgetInfoVector::const_iterator iter;
   for (iter = widgets.begin(); iter != widgets.end(); ++iter) {
-    AddDevice(new FtdiDmxDevice(this, *iter, frequency));
+    AddDevice(new FtdiDmxDevice(this, *iter, frequency, rt_priority, cpu));
   }
   return true;
 }
@@ -112,9 +121,17 @@ bool FtdiDmxPlugin::SetDefaultPreferences() {
     return false;
   }
 
-  if (m_preferences->SetDefaultValue(FtdiDmxPlugin::K_FREQUENCY,
-                                     UIntValidator(1, 44),
-                                     DEFAULT_FREQUENCY)) {
+  bool save = false;
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_FREQUENCY,
+                                         UIntValidator(1, 44),
+                                         DEFAULT_FREQUENCY);
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_RT_PRIORITY,
+                                         UIntValidator(0, 99),
+                                         DEFAULT_RT_PRIORITY);
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_CPU,
+                                         IntValidator(DEFAULT_CPU, MAX_CPU),
+                                         DEFAULT_CPU);
+  if (save) {
     m_preferences->Save();
   }
 
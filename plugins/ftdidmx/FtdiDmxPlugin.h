@@ -64,8 +64,13 @@ class FtdiDmxPlugin : public Plugin {
   bool SetDefaultPreferences();
 
   static const uint8_t DEFAULT_FREQUENCY = 30;
+  static const uint8_t DEFAULT_RT_PRIORITY = 0;
+  static const int DEFAULT_CPU = -1;
+  static const int MAX_CPU = 1023;
 
+  static const char K_CPU[];
   static const char K_FREQUENCY[];
+  static const char K_RT_PRIORITY[];
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
 };
@@ -44,10 +44,12 @@ class FtdiDmxOutputPort : public ola::BasicOutputPort {
     FtdiDmxOutputPort(FtdiDmxDevice *parent,
                       FtdiInterface *interface,
                       unsigned int id,
-                      unsigned int freq)
+                      unsigned int freq,
+                      unsigned int rt_priority,
+                      int cpu)
         : BasicOutputPort(parent, id),
           m_interface(interface),
-          m_thread(interface, freq) {
+          m_thread(interface, freq, rt_priority, cpu) {
       m_thread.Start();
     }
     ~FtdiDmxOutputPort() {
@@ -59,7 +61,10 @@ class FtdiDmxOutputPort : public ola::BasicOutputPort {
       return m_thread.WriteDMX(buffer);
     }
 
-    std::string Description() const { return m_interface->Description(); }
+    std::string Description() const {
+      return m_interface->Description() + " (" +
+          m_thread.Stats().ToString() + ")";
+    }
 
  private:
     FtdiInterface *m_interface;
@@ -23,14 +23,15 @@
  * by E.S. Rosenberg a.k.a. Keeper of the Keys 5774/2014
  */
 
-#include <math.h>
-#include <unistd.h>
+#include <sched.h>
 
 #include <string>
 
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/Utils.h"
+#include "ola/util/StallWatchdog.h"
 #include "plugins/ftdidmx/FtdiWidget.h"
 #include "plugins/ftdidmx/FtdiDmxThread.h"
 
@@ -38,11 +39,16 @@ namespace ola {
 namespace plugin {
 namespace ftdidmx {
 
-FtdiDmxThread::FtdiDmxThread(FtdiInterface *interface, unsigned int frequency)
-  : m_granularity(UNKNOWN),
+using ola::thread::FrameTimer;
+
+FtdiDmxThread::FtdiDmxThread(FtdiInterface *interface, unsigned int frequency,
+                             unsigned int rt_priority, int cpu)
+  : ola::thread::Thread(ola::thread::Thread::Options("ftdidmx")),
     m_interface(interface),
     m_term(false),
-    m_frequency(frequency) {
+    m_rt_priority(rt_priority),
+    m_cpu(cpu),
+    m_timer(TimeInterval(static_cast<int64_t>(1000000 / frequency))) {
 }
 
 FtdiDmxThread::~FtdiDmxThread() {
@@ -64,13 +70,14 @@ bool FtdiDmxThread::Stop() {
 
 /**
  * @brief Copy a DMXBuffer to the output thread
+ *
+ * The data is copied into the writer's slot, rather than shared, so the
+ * output thread never touches the caller's buffer.
  */
 bool FtdiDmxThread::WriteDMX(const DmxBuffer &buffer) {
-  {
-    ola::thread::MutexLocker locker(&m_buffer_mutex);
-    m_buffer.Set(buffer);
-    return true;
-  }
+  m_buffer.Back().Set(buffer);
+  m_buffer.Publish();
+  return true;
 }
 
 
@@ -78,19 +85,16 @@ bool FtdiDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * @brief The method called by the thread
  */
 void *FtdiDmxThread::Run() {
-  TimeStamp ts1, ts2, ts3;
-  Clock clock;
-  CheckTimeGranularity();
-  DmxBuffer buffer;
-
-  int frameTime = static_cast<int>(floor(
-    (static_cast<double>(1000) / m_frequency) + static_cast<double>(0.5)));
+  ConfigureScheduling();
 
   // Setup the interface
   if (!m_interface->IsOpen()) {
     m_interface->SetupOutput();
   }
 
+  // Each frame is supervised by the stall watchdog, if there is one.
+  ola::Heartbeat heartbeat(Name());
+  m_timer.Start();
   while (1) {
     {
       ola::thread::MutexLocker locker(&m_term_mutex);
@@ -99,81 +103,41 @@ void *FtdiDmxThread::Run() {
       }
     }
 
-    {
-      ola::thread::MutexLocker locker(&m_buffer_mutex);
-      buffer.Set(m_buffer);
-    }
-
-    clock.CurrentMonotonicTime(&ts1);
-
-    if (!m_interface->SetBreak(true)) {
-      goto framesleep;
-    }
-
-    if (m_granularity == GOOD) {
-      usleep(DMX_BREAK);
-    }
-
-    if (!m_interface->SetBreak(false)) {
-      goto framesleep;
-    }
-
-    if (m_granularity == GOOD) {
-      usleep(DMX_MAB);
-    }
+    heartbeat.Begin();
+    m_buffer.Update();
 
-    if (!m_interface->Write(buffer)) {
-      goto framesleep;
-    }
-
-  framesleep:
-    // Sleep for the remainder of the DMX frame time
-    clock.CurrentMonotonicTime(&ts2);
-    TimeInterval elapsed = ts2 - ts1;
-
-    if (m_granularity == GOOD) {
-      while (elapsed.InMilliSeconds() < frameTime) {
-        usleep(1000);
-        clock.CurrentMonotonicTime(&ts2);
-        elapsed = ts2 - ts1;
-      }
-    } else {
-      // See if we can drop out of bad mode.
-      usleep(1000);
-      clock.CurrentMonotonicTime(&ts3);
-      TimeInterval interval = ts3 - ts2;
-      if (interval.InMilliSeconds() < BAD_GRANULARITY_LIMIT) {
-        m_granularity = GOOD;
-        OLA_INFO << "Switching from BAD to GOOD granularity for ftdi thread";
-      }
-
-      elapsed = ts3 - ts1;
-      while (elapsed.InMilliSeconds() < frameTime) {
-        clock.CurrentMonotonicTime(&ts2);
-        elapsed = ts2 - ts1;
+    if (m_interface->SetBreak(true)) {
+      FrameTimer::SleepFor(TimeInterval(DMX_BREAK));
+      if (m_interface->SetBreak(false)) {
+        FrameTimer::SleepFor(TimeInterval(DMX_MAB));
+        m_interface->Write(m_buffer.Front());
       }
     }
+    heartbeat.End();
+
+    m_timer.WaitForNextFrame();
   }
+  OLA_INFO << "FTDI output thread for " << m_interface->Description() << ": "
+           << m_timer.Stats().ToString();
   return NULL;
 }
 
 
 /**
- * @brief Check the granularity of usleep.
+ * @brief Apply the real time priority and CPU affinity, if configured.
+ *
+ * Failures are logged but not fatal, the thread just runs with the default
+ * scheduling.
  */
-void FtdiDmxThread::CheckTimeGranularity() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-
-  clock.CurrentMonotonicTime(&ts1);
-  usleep(1000);
-  clock.CurrentMonotonicTime(&ts2);
-
-  TimeInterval interval = ts2 - ts1;
-  m_granularity = (interval.InMilliSeconds() > BAD_GRANULARITY_LIMIT) ?
-      BAD : GOOD;
-  OLA_INFO << "Granularity for FTDI thread is "
-           << ((m_granularity == GOOD) ? "GOOD" : "BAD");
+void FtdiDmxThread::ConfigureScheduling() {
+  if (m_rt_priority) {
+    struct sched_param param;
+    param.sched_priority = m_rt_priority;
+    ola::thread::SetSchedParam(pthread_self(), SCHED_FIFO, param);
+  }
+  if (m_cpu >= 0) {
+    ola::thread::SetThreadAffinity(pthread_self(), m_cpu);
+  }
 }
 }  // namespace ftdidmx
 }  // namespace plugin
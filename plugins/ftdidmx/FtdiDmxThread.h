@@ -27,7 +27,9 @@
 #define PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 
 #include "ola/DmxBuffer.h"
+#include "ola/thread/FrameTimer.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
 
 namespace ola {
 namespace plugin {
@@ -35,29 +37,39 @@ namespace ftdidmx {
 
 class FtdiDmxThread : public ola::thread::Thread {
  public:
-    FtdiDmxThread(FtdiInterface *interface, unsigned int frequency);
+    /**
+     * @brief Create a new output thread.
+     * @param interface the FTDI interface to write to.
+     * @param frequency the number of frames per second.
+     * @param rt_priority if non-0, run the thread with SCHED_FIFO at this
+     *   priority.
+     * @param cpu if non-negative, pin the thread to this CPU.
+     */
+    FtdiDmxThread(FtdiInterface *interface, unsigned int frequency,
+                  unsigned int rt_priority = 0, int cpu = -1);
     ~FtdiDmxThread();
 
     bool Stop();
     void *Run();
     bool WriteDMX(const DmxBuffer &buffer);
 
- private:
-    enum TimerGranularity { UNKNOWN, GOOD, BAD };
+    const ola::thread::FrameTimingStats &Stats() const {
+      return m_timer.Stats();
+    }
 
-    TimerGranularity m_granularity;
+ private:
     FtdiInterface *m_interface;
     bool m_term;
-    unsigned int m_frequency;
-    DmxBuffer m_buffer;
+    const unsigned int m_rt_priority;
+    const int m_cpu;
+    ola::thread::FrameTimer m_timer;
+    ola::thread::TripleBuffer<DmxBuffer> m_buffer;
     ola::thread::Mutex m_term_mutex;
-    ola::thread::Mutex m_buffer_mutex;
 
-    void CheckTimeGranularity();
+    void ConfigureScheduling();
 
     static const uint32_t DMX_MAB = 16;
     static const uint32_t DMX_BREAK = 110;
-    static const uint32_t BAD_GRANULARITY_LIMIT = 3;
 };
 }  // namespace ftdidmx
 }  // namespace plugin
@@ -18,12 +18,20 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include "plugins/gpio/GPIODriver.h"
 
 #include <errno.h>
 #include <fcntl.h>
+#ifdef HAVE_LINUX_GPIO_H
+#include <linux/gpio.h>
+#endif  // HAVE_LINUX_GPIO_H
 #include <stdint.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -34,6 +42,7 @@
 
 #include "ola/io/IOUtils.h"
 #include "ola/Logging.h"
+#include "ola/network/SocketCloser.h"
 #include "ola/thread/Mutex.h"
 
 namespace ola {
@@ -48,6 +57,7 @@ using std::vector;
 
 GPIODriver::GPIODriver(const Options &options)
     : m_options(options),
+      m_gpio_line_fd(-1),
       m_term(false),
       m_dmx_changed(false) {
 }
@@ -117,6 +127,10 @@ void *GPIODriver::Run() {
 }
 
 bool GPIODriver::SetupGPIO() {
+  if (!m_options.gpio_chip.empty()) {
+    return SetupGPIOChip();
+  }
+
   /**
    * This relies on the pins being exported:
    *   echo N > /sys/class/gpio/export
@@ -161,6 +175,52 @@ bool GPIODriver::SetupGPIO() {
   return true;
 }
 
+/*
+ * Request all the pins as outputs from the GPIO character device. This gives
+ * us a single fd which sets all the lines at once.
+ */
+bool GPIODriver::SetupGPIOChip() {
+#ifdef HAVE_LINUX_GPIO_H
+  if (m_options.gpio_pins.size() > GPIOHANDLES_MAX) {
+    OLA_WARN << "Too many GPIO pins for " << m_options.gpio_chip;
+    return false;
+  }
+
+  int chip_fd;
+  if (!ola::io::Open(m_options.gpio_chip, O_RDWR, &chip_fd)) {
+    return false;
+  }
+  ola::network::SocketCloser closer(chip_fd);
+
+  struct gpiohandle_request request;
+  memset(&request, 0, sizeof(request));
+  for (unsigned int i = 0; i < m_options.gpio_pins.size(); i++) {
+    request.lineoffsets[i] = m_options.gpio_pins[i];
+  }
+  request.lines = m_options.gpio_pins.size();
+  request.flags = GPIOHANDLE_REQUEST_OUTPUT;
+  strncpy(request.consumer_label, "olad-gpio",
+          sizeof(request.consumer_label) - 1);
+
+  if (ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &request) < 0) {
+    OLA_WARN << "Failed to request GPIO lines from " << m_options.gpio_chip
+             << ": " << strerror(errno);
+    return false;
+  }
+  m_gpio_line_fd = request.fd;
+
+  for (unsigned int i = 0; i < m_options.gpio_pins.size(); i++) {
+    GPIOPin pin = {-1, UNDEFINED, false};
+    m_gpio_pins.push_back(pin);
+  }
+  return true;
+#else
+  OLA_WARN << "GPIO character device support isn't available, can't use "
+           << m_options.gpio_chip;
+  return false;
+#endif  // HAVE_LINUX_GPIO_H
+}
+
 bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
   enum Action {
     TURN_ON,
@@ -168,6 +228,7 @@ bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
     NO_CHANGE,
   };
   const uint16_t first_slot = m_options.start_address - 1;
+  bool lines_changed = false;
 
   for (uint16_t i = 0;
        i < m_gpio_pins.size() && (i + first_slot < dmx.Size());
@@ -189,8 +250,12 @@ bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
         action = (slot_value >= m_options.turn_on ? TURN_ON : TURN_OFF);
     }
 
-    // Change the pin state if required.
-    if (action != NO_CHANGE) {
+    // Change the pin state if required. With the character device the pins
+    // are written together once we know all the new states.
+    if (action != NO_CHANGE && m_gpio_line_fd >= 0) {
+      m_gpio_pins[i].state = (action == TURN_ON ? ON : OFF);
+      lines_changed = true;
+    } else if (action != NO_CHANGE) {
       char data = (action == TURN_ON ? '1' : '0');
       if (write(m_gpio_pins[i].fd, &data, sizeof(data)) < 0) {
         OLA_WARN << "Failed to toggle GPIO pin " << i << ", fd "
@@ -201,15 +266,51 @@ bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
       m_gpio_pins[i].state = (action == TURN_ON ? ON : OFF);
     }
   }
+
+  if (lines_changed) {
+    return WriteGPIOLines();
+  }
+  return true;
+}
+
+/*
+ * Set all the lines from the pin states in one ioctl.
+ */
+bool GPIODriver::WriteGPIOLines() {
+#ifdef HAVE_LINUX_GPIO_H
+  struct gpiohandle_data data;
+  memset(&data, 0, sizeof(data));
+  for (unsigned int i = 0; i < m_gpio_pins.size(); i++) {
+    data.values[i] = m_gpio_pins[i].state == ON;
+  }
+
+  if (ioctl(m_gpio_line_fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+    OLA_WARN << "Failed to set GPIO lines on " << m_options.gpio_chip << ": "
+             << strerror(errno);
+    // We don't know what state the lines are in, so write them all next time.
+    GPIOPins::iterator iter = m_gpio_pins.begin();
+    for (; iter != m_gpio_pins.end(); ++iter) {
+      iter->state = UNDEFINED;
+    }
+    return false;
+  }
+#endif  // HAVE_LINUX_GPIO_H
   return true;
 }
 
 void GPIODriver::CloseGPIOFDs() {
   GPIOPins::iterator iter = m_gpio_pins.begin();
   for (; iter != m_gpio_pins.end(); ++iter) {
-    close(iter->fd);
+    if (iter->fd >= 0) {
+      close(iter->fd);
+    }
   }
   m_gpio_pins.clear();
+
+  if (m_gpio_line_fd >= 0) {
+    close(m_gpio_line_fd);
+    m_gpio_line_fd = -1;
+  }
 }
 }  // namespace gpio
 }  // namespace plugin
@@ -26,6 +26,7 @@
 #include <ola/base/Macro.h>
 #include <ola/thread/Thread.h>
 
+#include <string>
 #include <vector>
 
 namespace ola {
@@ -63,6 +64,15 @@ class GPIODriver : private ola::thread::Thread {
      * @brief The value below which a pin will be turned off.
      */
     uint8_t turn_off;
+
+    /**
+     * @brief The GPIO character device, e.g. /dev/gpiochip0.
+     *
+     * If set, the pins are line offsets on this chip and all of them are
+     * updated with a single ioctl. Otherwise the pins are controlled using
+     * sysfs.
+     */
+    std::string gpio_chip;
   };
 
   /**
@@ -114,6 +124,7 @@ class GPIODriver : private ola::thread::Thread {
 
   const Options m_options;
   GPIOPins m_gpio_pins;
+  int m_gpio_line_fd;
 
   DmxBuffer m_buffer;
   bool m_term;  // GUARDED_BY(m_mutex);
@@ -122,7 +133,9 @@ class GPIODriver : private ola::thread::Thread {
   ola::thread::ConditionVariable m_cond;
 
   bool SetupGPIO();
+  bool SetupGPIOChip();
   bool UpdateGPIOPins(const DmxBuffer &dmx);
+  bool WriteGPIOLines();
   void CloseGPIOFDs();
 
   static const char GPIO_BASE_DIR[];
@@ -38,6 +38,7 @@ using std::auto_ptr;
 using std::string;
 using std::vector;
 
+const char GPIOPlugin::GPIO_CHIP_KEY[] = "gpio_chip";
 const char GPIOPlugin::GPIO_PINS_KEY[] = "gpio_pins";
 const char GPIOPlugin::GPIO_SLOT_OFFSET_KEY[] = "gpio_slot_offset";
 const char GPIOPlugin::GPIO_TURN_OFF_KEY[] = "gpio_turn_off";
@@ -65,6 +66,8 @@ bool GPIOPlugin::StartHook() {
     return false;
   }
 
+  options.gpio_chip = m_preferences->GetValue(GPIO_CHIP_KEY);
+
   if (options.turn_off >= options.turn_on) {
     OLA_WARN << GPIO_TURN_OFF_KEY << " must be strictly less than "
              << GPIO_TURN_ON_KEY;
@@ -121,6 +124,9 @@ bool GPIOPlugin::SetDefaultPreferences() {
   if (!m_preferences)
     return false;
 
+  save |= m_preferences->SetDefaultValue(GPIO_CHIP_KEY,
+                                         StringValidator(true),
+                                         "");
   save |= m_preferences->SetDefaultValue(GPIO_PINS_KEY,
                                          StringValidator(),
                                          "");
@@ -98,7 +98,8 @@ HardwareBackend::OutputData& HardwareBackend::OutputData::operator=(
 HardwareBackend::HardwareBackend(const Options &options,
                                  I2CWriterInterface *writer,
                                  ExportMap *export_map)
-    : m_i2c_writer(writer),
+    : ola::thread::Thread(ola::thread::Thread::Options("i2c-hw-backend")),
+      m_i2c_writer(writer),
       m_drop_map(NULL),
       m_output_count(1 << options.gpio_pins.size()),
       m_exit(false),
@@ -304,7 +305,8 @@ void HardwareBackend::CloseGPIOFDs() {
 SoftwareBackend::SoftwareBackend(const Options &options,
                                  I2CWriterInterface *writer,
                                  ExportMap *export_map)
-    : m_i2c_writer(writer),
+    : ola::thread::Thread(ola::thread::Thread::Options("i2c-sw-backend")),
+      m_i2c_writer(writer),
       m_drop_map(NULL),
       m_write_pending(false),
       m_exit(false),
@@ -194,6 +194,14 @@ string I2CDevice::I2CCEKey() const {
   return m_i2c_device_name + "-i2c-ce-high";
 }
 
+string I2CDevice::I2CAddressKey() const {
+  return m_i2c_device_name + "-i2c-address";
+}
+
+string I2CDevice::I2CRegisterWritesKey() const {
+  return m_i2c_device_name + "-i2c-register-writes";
+}
+
 string I2CDevice::PortCountKey() const {
   return m_i2c_device_name + "-ports";
 }
@@ -239,6 +247,12 @@ void I2CDevice::SetDefaults() {
   m_preferences->SetDefaultValue(I2CSpeedKey(), UIntValidator(0, MAX_I2C_SPEED),
                                  1000000);
   m_preferences->SetDefaultValue(I2CCEKey(), BoolValidator(), false);
+  m_preferences->SetDefaultValue(
+      I2CAddressKey(),
+      UIntValidator(MIN_I2C_ADDRESS, MAX_I2C_ADDRESS),
+      I2CWriter::DEFAULT_ADDRESS);
+  m_preferences->SetDefaultValue(I2CRegisterWritesKey(), BoolValidator(),
+                                 false);
   m_preferences->SetDefaultValue(PortCountKey(),
                                  UIntValidator(1, MAX_PORT_COUNT), 1);
   m_preferences->SetDefaultValue(SyncPortKey(),
@@ -292,6 +306,15 @@ void I2CDevice::PopulateWriterOptions(I2CWriter::Options *options) {
   if (StringToBool(m_preferences->GetValue(I2CCEKey()), &ce_high)) {
     options->cs_enable_high = ce_high;
   }
+  uint8_t address;
+  if (StringToInt(m_preferences->GetValue(I2CAddressKey()), &address)) {
+    options->address = address;
+  }
+  bool register_writes;
+  if (StringToBool(m_preferences->GetValue(I2CRegisterWritesKey()),
+                   &register_writes)) {
+    options->register_writes = register_writes;
+  }
 }
 }  // namespace i2c
 }  // namespace plugin
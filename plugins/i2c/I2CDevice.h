@@ -68,6 +68,8 @@ class I2CDevice: public ola::Device {
   std::string I2CBackendKey() const;
   std::string I2CSpeedKey() const;
   std::string I2CCEKey() const;
+  std::string I2CAddressKey() const;
+  std::string I2CRegisterWritesKey() const;
   std::string PortCountKey() const;
   std::string SyncPortKey() const;
   std::string GPIOPinKey() const;
@@ -88,6 +90,8 @@ class I2CDevice: public ola::Device {
   static const char HARDWARE_BACKEND[];
   static const char SOFTWARE_BACKEND[];
   static const uint16_t MAX_GPIO_PIN = 1023;
+  static const uint8_t MIN_I2C_ADDRESS = 0x03;
+  static const uint8_t MAX_I2C_ADDRESS = 0x77;
   static const uint32_t MAX_I2C_SPEED = 32000000;
   static const uint16_t MAX_PORT_COUNT = 32;
 };
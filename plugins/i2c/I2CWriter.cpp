@@ -21,15 +21,17 @@
 
 #include <errno.h>
 #include <fcntl.h>
-#include <linux/ioctl.h>
-#include <linux/i2c/i2cdev.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <vector>
 #include "ola/io/IOUtils.h"
 #include "ola/Logging.h"
 #include "ola/network/SocketCloser.h"
@@ -41,11 +43,11 @@ namespace i2c {
 
 using ola::thread::MutexLocker;
 using std::string;
+using std::vector;
 
-const uint8_t I2CWriter::I2C_BITS_PER_WORD = 8;
-const uint8_t I2CWriter::I2C_MODE = 0;
 const char I2CWriter::I2C_DEVICE_KEY[] = "device";
 const char I2CWriter::I2C_ERROR_VAR[] = "i2c-write-errors";
+const char I2CWriter::I2C_SKIP_VAR[] = "i2c-unchanged-frames";
 const char I2CWriter::I2C_WRITE_VAR[] = "i2c-writes";
 
 I2CWriter::I2CWriter(const string &i2c_device,
@@ -54,10 +56,15 @@ I2CWriter::I2CWriter(const string &i2c_device,
     : m_device_path(i2c_device),
       m_i2c_speed(options.i2c_speed),
       m_cs_enable_high(options.cs_enable_high),
+      m_address(options.address),
+      m_register_writes(options.register_writes),
       m_fd(-1),
       m_error_map_var(NULL),
-      m_write_map_var(NULL) {
-  OLA_INFO << "Created I2C Writer " << i2c_device << " with speed "
+      m_write_map_var(NULL),
+      m_skip_map_var(NULL),
+      m_last_frame_valid(false) {
+  OLA_INFO << "Created I2C Writer " << i2c_device << " for address "
+           << static_cast<int>(m_address) << ", speed "
            << options.i2c_speed << ", CE is " << m_cs_enable_high;
   if (export_map) {
     m_error_map_var = export_map->GetUIntMapVar(I2C_ERROR_VAR,
@@ -66,6 +73,9 @@ I2CWriter::I2CWriter(const string &i2c_device,
     m_write_map_var = export_map->GetUIntMapVar(I2C_WRITE_VAR,
                                                 I2C_DEVICE_KEY);
     (*m_write_map_var)[m_device_path] = 0;
+    m_skip_map_var = export_map->GetUIntMapVar(I2C_SKIP_VAR,
+                                               I2C_DEVICE_KEY);
+    (*m_skip_map_var)[m_device_path] = 0;
   }
 }
 
@@ -81,24 +91,17 @@ bool I2CWriter::Init() {
   }
   ola::network::SocketCloser closer(fd);
 
-  uint8_t i2c_mode = I2C_MODE;
-  if (m_cs_enable_high) {
-    i2c_mode |= I2C_CS_HIGH;
-  }
-
-  if (ioctl(fd, I2C_IOC_WR_MODE, &i2c_mode) < 0) {
-    OLA_WARN << "Failed to set I2C_IOC_WR_MODE for " << m_device_path;
-    return false;
-  }
-
-  uint8_t i2c_bits_per_word = I2C_BITS_PER_WORD;
-  if (ioctl(fd, I2C_IOC_WR_BITS_PER_WORD, &i2c_bits_per_word) < 0) {
-    OLA_WARN << "Failed to set I2C_IOC_WR_BITS_PER_WORD for " << m_device_path;
+  // The bus speed is set by the adapter driver, we can only check that it
+  // supports combined transfers.
+  unsigned long functions = 0;  // NOLINT(runtime/int)
+  if (ioctl(fd, I2C_FUNCS, &functions) < 0) {
+    OLA_WARN << "Failed to get I2C_FUNCS for " << m_device_path << ": "
+             << strerror(errno);
     return false;
   }
 
-  if (ioctl(fd, I2C_IOC_WR_MAX_SPEED_HZ, &m_i2c_speed) < 0) {
-    OLA_WARN << "Failed to set I2C_IOC_WR_MAX_SPEED_HZ for " << m_device_path;
+  if (!(functions & I2C_FUNC_I2C)) {
+    OLA_WARN << m_device_path << " doesn't support I2C_RDWR transfers";
     return false;
   }
   m_fd = closer.Release();
@@ -106,17 +109,119 @@ bool I2CWriter::Init() {
 }
 
 bool I2CWriter::WriteI2CData(const uint8_t *data, unsigned int length) {
-  struct i2c_ioc_transfer i2c;
-  memset(&i2c, 0, sizeof(i2c));
-  i2c.tx_buf = reinterpret_cast<__u64>(data);
-  i2c.len = length;
+  if (m_last_frame_valid && m_last_frame.size() == length &&
+      (length == 0 || memcmp(&m_last_frame[0], data, length) == 0)) {
+    if (m_skip_map_var) {
+      (*m_skip_map_var)[m_device_path]++;
+    }
+    return true;
+  }
 
   if (m_write_map_var) {
     (*m_write_map_var)[m_device_path]++;
   }
 
-  int bytes_written = ioctl(m_fd, I2C_IOC_MESSAGE(1), &i2c);
-  if (bytes_written != static_cast<int>(length)) {
+  bool ok;
+  if (m_register_writes && length <= MAX_REGISTER_COUNT) {
+    ok = WriteRegisters(data, length);
+  } else {
+    struct i2c_msg message;
+    memset(&message, 0, sizeof(message));
+    message.addr = m_address;
+    message.len = length;
+    message.buf = const_cast<uint8_t*>(data);
+    ok = Transfer(&message, 1);
+  }
+
+  // If the write failed we don't know what the slave has, so send the whole
+  // frame next time.
+  m_last_frame_valid = ok;
+  if (ok) {
+    m_last_frame.assign(data, data + length);
+  }
+  return ok;
+}
+
+void I2CWriter::ChangedRuns(const uint8_t *old_data,
+                            const uint8_t *new_data,
+                            unsigned int length,
+                            unsigned int max_gap,
+                            Runs *runs) {
+  runs->clear();
+  unsigned int i = 0;
+  while (i < length) {
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+
+    const unsigned int start = i;
+    unsigned int end = i + 1;  // one past the last changed byte
+    i++;
+    while (i < length) {
+      if (old_data[i] != new_data[i]) {
+        end = ++i;
+      } else if (i - end < max_gap) {
+        i++;
+      } else {
+        break;
+      }
+    }
+    runs->push_back(Run(start, end - start));
+  }
+}
+
+/*
+ * Write the registers which changed since the last frame. Each run is a
+ * message of the form [register, data...], and the messages are sent as
+ * combined transfers.
+ */
+bool I2CWriter::WriteRegisters(const uint8_t *data, unsigned int length) {
+  Runs runs;
+  if (m_last_frame_valid && m_last_frame.size() == length) {
+    ChangedRuns(&m_last_frame[0], data, length, MERGE_GAP, &runs);
+  } else if (length) {
+    runs.push_back(Run(0, length));
+  }
+
+  unsigned int message_bytes = 0;
+  Runs::const_iterator iter = runs.begin();
+  for (; iter != runs.end(); ++iter) {
+    message_bytes += iter->second + 1;
+  }
+  m_message_data.resize(message_bytes);
+
+  vector<struct i2c_msg> messages(runs.size());
+  uint8_t *buffer = message_bytes ? &m_message_data[0] : NULL;
+  for (unsigned int i = 0; i < runs.size(); i++) {
+    buffer[0] = static_cast<uint8_t>(runs[i].first);
+    memcpy(buffer + 1, data + runs[i].first, runs[i].second);
+
+    memset(&messages[i], 0, sizeof(messages[i]));
+    messages[i].addr = m_address;
+    messages[i].len = runs[i].second + 1;
+    messages[i].buf = buffer;
+    buffer += runs[i].second + 1;
+  }
+
+  for (unsigned int offset = 0; offset < messages.size();
+       offset += I2C_RDWR_IOCTL_MAX_MSGS) {
+    unsigned int count = std::min(
+        static_cast<unsigned int>(messages.size() - offset),
+        static_cast<unsigned int>(I2C_RDWR_IOCTL_MAX_MSGS));
+    if (!Transfer(&messages[offset], count)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool I2CWriter::Transfer(struct i2c_msg *messages, unsigned int count) {
+  struct i2c_rdwr_ioctl_data transfer;
+  transfer.msgs = messages;
+  transfer.nmsgs = count;
+
+  if (ioctl(m_fd, I2C_RDWR, &transfer) != static_cast<int>(count)) {
     OLA_WARN << "Failed to write all the I2C data: " << strerror(errno);
     if (m_error_map_var) {
       (*m_error_map_var)[m_device_path]++;
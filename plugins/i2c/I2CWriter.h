@@ -26,6 +26,10 @@
 #include <ola/thread/Mutex.h>
 #include <stdint.h>
 #include <string>
+#include <utility>
+#include <vector>
+
+struct i2c_msg;
 
 namespace ola {
 namespace plugin {
@@ -54,10 +58,24 @@ class I2CWriter : public I2CWriterInterface {
   struct Options {
     uint32_t i2c_speed;
     bool cs_enable_high;
+    // The 7-bit address of the slave.
+    uint8_t address;
+    // If true, the data is a register map starting at register 0 and only
+    // the registers which changed are written, each run as a separate message
+    // in a single combined transfer.
+    bool register_writes;
 
-    Options() : i2c_speed(1000000), cs_enable_high(false) {}
+    Options()
+        : i2c_speed(1000000),
+          cs_enable_high(false),
+          address(DEFAULT_ADDRESS),
+          register_writes(false) {}
   };
 
+  // A run of changed bytes, as (offset, length).
+  typedef std::pair<unsigned int, unsigned int> Run;
+  typedef std::vector<Run> Runs;
+
   I2CWriter(const std::string &i2c_device, const Options &options,
             ExportMap *export_map);
   ~I2CWriter();
@@ -72,18 +90,41 @@ class I2CWriter : public I2CWriterInterface {
 
   bool WriteI2CData(const uint8_t *data, unsigned int length);
 
+  /**
+   * Find the bytes which differ between two frames of the same length.
+   * Runs separated by max_gap bytes or fewer are merged, since rewriting a
+   * couple of unchanged bytes is cheaper than starting a new message.
+   */
+  static void ChangedRuns(const uint8_t *old_data,
+                          const uint8_t *new_data,
+                          unsigned int length,
+                          unsigned int max_gap,
+                          Runs *runs);
+
+  static const uint8_t DEFAULT_ADDRESS = 0x40;
+
  private:
   const std::string m_device_path;
   const uint32_t m_i2c_speed;
   const bool m_cs_enable_high;
+  const uint8_t m_address;
+  const bool m_register_writes;
   int m_fd;
   UIntMap *m_error_map_var;
   UIntMap *m_write_map_var;
+  UIntMap *m_skip_map_var;
+  std::vector<uint8_t> m_last_frame;
+  bool m_last_frame_valid;
+  std::vector<uint8_t> m_message_data;
+
+  bool WriteRegisters(const uint8_t *data, unsigned int length);
+  bool Transfer(struct i2c_msg *messages, unsigned int count);
 
-  static const uint8_t I2C_MODE;
-  static const uint8_t I2C_BITS_PER_WORD;
+  static const unsigned int MAX_REGISTER_COUNT = 256;
+  static const unsigned int MERGE_GAP = 2;
   static const char I2C_DEVICE_KEY[];
   static const char I2C_ERROR_VAR[];
+  static const char I2C_SKIP_VAR[];
   static const char I2C_WRITE_VAR[];
 };
 }  // namespace i2c
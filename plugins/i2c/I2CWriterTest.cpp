@@ -0,0 +1,74 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * I2CWriterTest.cpp
+ * Test fixture for the I2CWriter change detection.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/testing/TestUtils.h"
+#include "plugins/i2c/I2CWriter.h"
+
+using ola::plugin::i2c::I2CWriter;
+
+class I2CWriterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(I2CWriterTest);
+  CPPUNIT_TEST(testChangedRuns);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testChangedRuns();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(I2CWriterTest);
+
+
+/**
+ * Check that only the changed registers are picked, and nearby runs merged.
+ */
+void I2CWriterTest::testChangedRuns() {
+  const uint8_t old_data[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  I2CWriter::Runs runs;
+
+  I2CWriter::ChangedRuns(old_data, old_data, sizeof(old_data), 2, &runs);
+  OLA_ASSERT_TRUE(runs.empty());
+
+  // A gap of 2 is merged, a gap of 3 isn't.
+  const uint8_t new_data[] = {1, 0, 0, 1, 0, 0, 0, 1, 1, 0};
+  I2CWriter::ChangedRuns(old_data, new_data, sizeof(old_data), 2, &runs);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), runs.size());
+  OLA_ASSERT_EQ(0u, runs[0].first);
+  OLA_ASSERT_EQ(4u, runs[0].second);
+  OLA_ASSERT_EQ(7u, runs[1].first);
+  OLA_ASSERT_EQ(2u, runs[1].second);
+
+  // With no gap allowed each run stands alone.
+  I2CWriter::ChangedRuns(old_data, new_data, sizeof(old_data), 0, &runs);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), runs.size());
+  OLA_ASSERT_EQ(0u, runs[0].first);
+  OLA_ASSERT_EQ(1u, runs[0].second);
+  OLA_ASSERT_EQ(3u, runs[1].first);
+  OLA_ASSERT_EQ(1u, runs[1].second);
+  OLA_ASSERT_EQ(7u, runs[2].first);
+  OLA_ASSERT_EQ(2u, runs[2].second);
+
+  // A change in the last byte.
+  const uint8_t last_data[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 5};
+  I2CWriter::ChangedRuns(old_data, last_data, sizeof(old_data), 2, &runs);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), runs.size());
+  OLA_ASSERT_EQ(9u, runs[0].first);
+  OLA_ASSERT_EQ(1u, runs[0].second);
+}
@@ -38,6 +38,7 @@ test_programs += plugins/i2c/I2CTester
 plugins_i2c_I2CTester_SOURCES = \
     plugins/i2c/I2CBackendTest.cpp \
     plugins/i2c/I2COutputTest.cpp \
+    plugins/i2c/I2CWriterTest.cpp \
     plugins/i2c/FakeI2CWriter.cpp \
     plugins/i2c/FakeI2CWriter.h
 plugins_i2c_I2CTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
@@ -35,6 +35,7 @@
 #include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/util/StallWatchdog.h"
 #include "plugins/karate/KarateLight.h"
 #include "plugins/karate/KarateThread.h"
 
@@ -50,7 +51,7 @@ using std::string;
  * @brief Create a new KarateThread object
  */
 KarateThread::KarateThread(const string &path)
-    : ola::thread::Thread(),
+    : ola::thread::Thread(ola::thread::Thread::Options("karate")),
       m_path(path),
       m_term(false) {
 }
@@ -65,6 +66,8 @@ void *KarateThread::Run() {
 
   KarateLight k(m_path);
   k.Init();
+  // Each frame is supervised by the stall watchdog, if there is one.
+  ola::Heartbeat heartbeat(Name());
 
   while (true) {
     {
@@ -91,10 +94,12 @@ void *KarateThread::Run() {
       k.Init();
 
     } else {
+      heartbeat.Begin();
       {
         MutexLocker locker(&m_mutex);
         write_success = k.SetColors(m_buffer);
       }
+      heartbeat.End();
       if (!write_success) {
         OLA_WARN << "Failed to write color data";
       }  else {
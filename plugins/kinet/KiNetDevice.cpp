@@ -145,6 +145,9 @@ bool KiNetPortOutDevice::StartHook() {
     OLA_WARN << "Invalid port count value for " << PortCountKey();
   }
 
+  m_node->ConfigurePowerSupply(
+      m_power_supply, m_preferences->GetValueAsBool(SyncKey()));
+
   for (uint8_t i = 1; i <= port_count; i++) {
     AddPort(new KiNetPortOutOutputPort(this, m_power_supply, m_node, i));
   }
@@ -152,11 +155,24 @@ bool KiNetPortOutDevice::StartHook() {
 }
 
 
+/*
+ * Drop any data for the power supply that hasn't been sent.
+ */
+void KiNetPortOutDevice::PostPortStop() {
+  m_node->RemovePowerSupply(m_power_supply);
+}
+
+
 string KiNetPortOutDevice::PortCountKey() const {
   return m_power_supply.ToString() + "-ports";
 }
 
 
+string KiNetPortOutDevice::SyncKey() const {
+  return m_power_supply.ToString() + "-sync";
+}
+
+
 void KiNetPortOutDevice::SetDefaults() {
   // Set port out specific device options
   if (!m_preferences) {
@@ -170,6 +186,8 @@ void KiNetPortOutDevice::SetDefaults() {
       UIntValidator(1, KINET_PORTOUT_MAX_PORT_COUNT),
       KINET_PORTOUT_MAX_PORT_COUNT);
 
+  save |= m_preferences->SetDefaultValue(SyncKey(), BoolValidator(), false);
+
   if (save) {
     m_preferences->Save();
   }
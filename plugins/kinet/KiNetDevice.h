@@ -69,10 +69,12 @@ class KiNetPortOutDevice: public KiNetDevice {
                      class Preferences *preferences);
 
   std::string PortCountKey() const;
+  std::string SyncKey() const;
   void SetDefaults();
 
  protected:
   bool StartHook();
+  void PostPortStop();
 
  private:
   static const char KINET_PORT_OUT_DEVICE_NAME[];
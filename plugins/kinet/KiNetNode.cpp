@@ -18,11 +18,16 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <string.h>
 #include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "ola/Callback.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/SocketAddress.h"
 #include "ola/util/SequenceNumber.h"
@@ -37,6 +42,7 @@ using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::UDPSocket;
 using std::auto_ptr;
+using std::vector;
 
 const uint16_t KiNetNode::KINET_PORT = 6038;
 const uint32_t KiNetNode::KINET_MAGIC_NUMBER = 0x0401dc4a;
@@ -44,6 +50,47 @@ const uint16_t KiNetNode::KINET_VERSION_ONE = 0x0100;
 const uint16_t KiNetNode::KINET_DMX_MSG = 0x0101;
 const uint16_t KiNetNode::KINET_PORTOUT_MSG = 0x0801;
 const uint16_t KiNetNode::KINET_PORTOUT_MIN_BUFFER_SIZE = 24;
+const uint16_t KiNetNode::KINET_SYNC_MSG = 0x0901;
+const uint8_t KiNetNode::KINET_PORTOUT_SYNC_FLAG = 0x01;
+const unsigned int KiNetNode::KINET_HEADER_SIZE = 12;
+const unsigned int KiNetNode::KINET_PORTOUT_HEADER_SIZE = 24;
+// Devices we haven't heard from in this long are dropped from the statistics.
+const TimeInterval KiNetNode::SOURCE_STATS_TIMEOUT(30, 0);
+
+namespace {
+// Offsets into a packet, and the helpers to fill in the little endian fields.
+const unsigned int TRANSACTION_OFFSET = 8;
+const unsigned int PORTOUT_LENGTH_OFFSET = 20;
+
+void WriteLittleEndian16(uint8_t *ptr, uint16_t value) {
+  ptr[0] = value & 0xff;
+  ptr[1] = value >> 8;
+}
+
+void WriteLittleEndian32(uint8_t *ptr, uint32_t value) {
+  ptr[0] = value & 0xff;
+  ptr[1] = (value >> 8) & 0xff;
+  ptr[2] = (value >> 16) & 0xff;
+  ptr[3] = value >> 24;
+}
+
+/*
+ * Write the fixed part of the header, the transaction number is filled in as
+ * each packet is sent.
+ */
+void WriteHeader(uint8_t *ptr, uint32_t magic, uint16_t version,
+                 uint16_t msg_type) {
+  ptr[0] = magic >> 24;
+  ptr[1] = (magic >> 16) & 0xff;
+  ptr[2] = (magic >> 8) & 0xff;
+  ptr[3] = magic & 0xff;
+  ptr[4] = version >> 8;
+  ptr[5] = version & 0xff;
+  ptr[6] = msg_type >> 8;
+  ptr[7] = msg_type & 0xff;
+  memset(ptr + TRANSACTION_OFFSET, 0, sizeof(uint32_t));
+}
+}  // namespace
 
 /*
  * Create a new KiNet node.
@@ -55,7 +102,13 @@ KiNetNode::KiNetNode(ola::io::SelectServerInterface *ss,
     : m_running(false),
       m_ss(ss),
       m_output_stream(&m_output_queue),
-      m_socket(socket) {
+      m_socket(socket),
+      m_stats(NULL),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
+  // The sync packet is a header followed by 4 bytes of padding.
+  m_sync_packet.resize(KINET_HEADER_SIZE + sizeof(uint32_t), 0);
+  WriteHeader(&m_sync_packet[0], KINET_MAGIC_NUMBER, KINET_VERSION_ONE,
+              KINET_SYNC_MSG);
 }
 
 
@@ -64,6 +117,11 @@ KiNetNode::KiNetNode(ola::io::SelectServerInterface *ss,
  */
 KiNetNode::~KiNetNode() {
   Stop();
+  PowerSupplyMap::iterator iter = m_power_supplies.begin();
+  for (; iter != m_power_supplies.end(); ++iter) {
+    DeletePowerSupply(iter->second);
+  }
+  m_power_supplies.clear();
 }
 
 
@@ -88,6 +146,10 @@ bool KiNetNode::Stop() {
   if (!m_running)
     return false;
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
   m_ss->RemoveReadDescriptor(m_socket.get());
   m_socket.reset();
   m_running = false;
@@ -178,6 +240,111 @@ bool KiNetNode::SendPortOut(const IPV4Address &target_ip,
 }
 
 
+/*
+ * Set the options for a power supply.
+ * @param target the power supply
+ * @param sync true to latch the ports with a sync packet after each frame.
+ */
+void KiNetNode::ConfigurePowerSupply(const IPV4Address &target, bool sync) {
+  PowerSupply *power_supply = STLFindOrNull(m_power_supplies, target);
+  if (!power_supply) {
+    power_supply = new PowerSupply();
+    m_power_supplies[target] = power_supply;
+  } else if (power_supply->sync != sync) {
+    // The flags in the cached packets are now out of date.
+    STLDeleteValues(&power_supply->ports);
+  }
+  power_supply->sync = sync;
+}
+
+
+/*
+ * Forget about a power supply, this drops any data that hasn't been sent.
+ */
+void KiNetNode::RemovePowerSupply(const IPV4Address &target) {
+  PowerSupplyMap::iterator iter = m_power_supplies.find(target);
+  if (iter == m_power_supplies.end()) {
+    return;
+  }
+  DeletePowerSupply(iter->second);
+  m_power_supplies.erase(iter);
+}
+
+
+/*
+ * Update the data for a port, it'll be sent on the next flush.
+ */
+bool KiNetNode::UpdatePortOut(const IPV4Address &target,
+                              uint8_t port,
+                              const DmxBuffer &buffer) {
+  if (!buffer.Size()) {
+    OLA_DEBUG << "Not sending 0 length packet";
+    return true;
+  }
+
+  PowerSupply *power_supply = STLFindOrNull(m_power_supplies, target);
+  if (!power_supply) {
+    power_supply = new PowerSupply();
+    power_supply->sync = false;
+    m_power_supplies[target] = power_supply;
+  }
+
+  PortOutPacket *packet = STLFindOrNull(power_supply->ports, port);
+  if (!packet) {
+    packet = new PortOutPacket();
+    BuildPortOutPacket(port, power_supply->sync, packet);
+    power_supply->ports[port] = packet;
+  }
+
+  const uint16_t size = static_cast<uint16_t>(buffer.Size());
+  const uint16_t padded_size = std::max(size, KINET_PORTOUT_MIN_BUFFER_SIZE);
+  packet->data.resize(KINET_PORTOUT_HEADER_SIZE + padded_size);
+  uint8_t *ptr = &packet->data[0];
+  WriteLittleEndian16(ptr + PORTOUT_LENGTH_OFFSET, padded_size);
+  unsigned int length = size;
+  buffer.Get(ptr + KINET_PORTOUT_HEADER_SIZE, &length);
+  memset(ptr + KINET_PORTOUT_HEADER_SIZE + length, 0, padded_size - length);
+  packet->dirty = true;
+
+  if (m_running && m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+    // Timeouts run after all the descriptors that are ready, so every
+    // universe that arrives in this iteration goes out in the same flush.
+    m_flush_timeout = m_ss->RegisterSingleTimeout(
+        0, NewSingleCallback(this, &KiNetNode::FlushTimeout));
+  }
+  return true;
+}
+
+
+/*
+ * Send the ports that have changed since the last flush.
+ */
+void KiNetNode::Flush() {
+  if (!m_running) {
+    return;
+  }
+
+  PowerSupplyMap::iterator iter = m_power_supplies.begin();
+  for (; iter != m_power_supplies.end(); ++iter) {
+    PowerSupply *power_supply = iter->second;
+    bool sent = false;
+    PortOutPacketMap::iterator port_iter = power_supply->ports.begin();
+    for (; port_iter != power_supply->ports.end(); ++port_iter) {
+      PortOutPacket *packet = port_iter->second;
+      if (!packet->dirty) {
+        continue;
+      }
+      packet->dirty = false;
+      sent |= SendPacket(iter->first, &packet->data);
+    }
+
+    if (sent && power_supply->sync) {
+      SendPacket(iter->first, &m_sync_packet);
+    }
+  }
+}
+
+
 /*
  * Called when there is data on this socket. Right now we discard all packets.
  */
@@ -191,10 +358,42 @@ void KiNetNode::SocketReady() {
                           &source))
     return;
 
+  if (m_stats) {
+    const TimeStamp &now = *m_ss->WakeUpTime();
+    SourceStatsMap::iterator iter = m_source_stats.find(source.Host());
+    if (iter == m_source_stats.end()) {
+      ExpireSourceStats(now);
+      SourceStats source_stats;
+      source_stats.stats = m_stats->Get(source.Host().ToString());
+      iter = m_source_stats.insert(
+          std::make_pair(source.Host(), source_stats)).first;
+    }
+    iter->second.last_heard = now;
+    iter->second.stats->PacketReceived(now);
+  }
+
   OLA_INFO << "Received Kinet packet from " << source << ", discarding";
 }
 
 
+/*
+ * Remove the statistics for devices we haven't heard from recently. This is
+ * run before a new device is added, so the map doesn't grow as devices come
+ * and go.
+ */
+void KiNetNode::ExpireSourceStats(const TimeStamp &now) {
+  SourceStatsMap::iterator iter = m_source_stats.begin();
+  while (iter != m_source_stats.end()) {
+    if (now > iter->second.last_heard + SOURCE_STATS_TIMEOUT) {
+      m_stats->Remove(iter->first.ToString());
+      m_source_stats.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+
 /*
  * Fill in the header for a packet
  */
@@ -204,6 +403,55 @@ void KiNetNode::PopulatePacketHeader(uint16_t msg_type) {
 }
 
 
+/*
+ * Build the packet for a port, everything up to the slot data is fixed.
+ */
+void KiNetNode::BuildPortOutPacket(uint8_t port, bool sync,
+                                   PortOutPacket *packet) {
+  static const uint32_t universe = 0xffffffff;
+
+  packet->dirty = false;
+  packet->data.assign(KINET_PORTOUT_HEADER_SIZE, 0);
+  uint8_t *ptr = &packet->data[0];
+  WriteHeader(ptr, KINET_MAGIC_NUMBER, KINET_VERSION_ONE, KINET_PORTOUT_MSG);
+  WriteLittleEndian32(ptr + KINET_HEADER_SIZE, universe);
+  ptr[16] = port;
+  ptr[17] = sync ? KINET_PORTOUT_SYNC_FLAG : 0;
+  // 18 & 19 are flags which are always 0, 20 & 21 the length, which is set
+  // when the data is updated, and 22 & 23 the start code.
+}
+
+
+/*
+ * Fill in the transaction number and send a cached packet.
+ */
+bool KiNetNode::SendPacket(const IPV4Address &target_ip,
+                           vector<uint8_t> *packet) {
+  uint8_t *ptr = &(*packet)[0];
+  WriteLittleEndian32(ptr + TRANSACTION_OFFSET, m_transaction_number.Next());
+
+  IPV4SocketAddress target(target_ip, KINET_PORT);
+  ssize_t bytes_sent = m_socket->SendTo(ptr, packet->size(), target);
+  if (bytes_sent != static_cast<ssize_t>(packet->size())) {
+    OLA_WARN << "Failed to send KiNet packet to " << target_ip;
+    return false;
+  }
+  return true;
+}
+
+
+void KiNetNode::FlushTimeout() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  Flush();
+}
+
+
+void KiNetNode::DeletePowerSupply(PowerSupply *power_supply) {
+  STLDeleteValues(&power_supply->ports);
+  delete power_supply;
+}
+
+
 /*
  * Setup the networking components.
  */
@@ -21,16 +21,22 @@
 #ifndef PLUGINS_KINET_KINETNODE_H_
 #define PLUGINS_KINET_KINETNODE_H_
 
+#include <map>
 #include <memory>
+#include <vector>
 
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/ReceiveStats.h"
 #include "ola/io/BigEndianStream.h"
 #include "ola/io/IOQueue.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/Interface.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Socket.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "ola/util/SequenceNumber.h"
 
 namespace ola {
@@ -55,7 +61,50 @@ class KiNetNode {
                      const uint8_t port,
                      const ola::DmxBuffer &buffer);
 
+    /*
+     * Batched PORTOUT. UpdatePortOut() stores the data for a port and the
+     * changed ports of every power supply are flushed together, once the
+     * current iteration of the select server completes. The packet for each
+     * port is built once and only the data and transaction number change.
+     *
+     * If sync is enabled for a power supply, the PORTOUT packets ask it to
+     * hold the data and a single sync packet follows them, so all the ports
+     * change at the same time.
+     */
+    void ConfigurePowerSupply(const ola::network::IPV4Address &target,
+                              bool sync);
+    void RemovePowerSupply(const ola::network::IPV4Address &target);
+    bool UpdatePortOut(const ola::network::IPV4Address &target,
+                       uint8_t port,
+                       const ola::DmxBuffer &buffer);
+    void Flush();
+
+    /*
+     * Count the packets received from each device, ownership of the map is
+     * not transferred. We don't handle any received packets, so this is only
+     * useful for diagnostics.
+     */
+    void SetReceiveStats(ola::ReceiveStatsMap *stats) { m_stats = stats; }
+
  private:
+    struct SourceStats {
+      ola::dmx::ReceiveStats *stats;
+      TimeStamp last_heard;
+    };
+    typedef std::map<ola::network::IPV4Address, SourceStats> SourceStatsMap;
+
+    struct PortOutPacket {
+      std::vector<uint8_t> data;
+      bool dirty;
+    };
+    typedef std::map<uint8_t, PortOutPacket*> PortOutPacketMap;
+
+    struct PowerSupply {
+      bool sync;
+      PortOutPacketMap ports;
+    };
+    typedef std::map<ola::network::IPV4Address, PowerSupply*> PowerSupplyMap;
+
     bool m_running;
     ola::SequenceNumber<uint32_t> m_transaction_number;
     ola::io::SelectServerInterface *m_ss;
@@ -63,16 +112,32 @@ class KiNetNode {
     ola::io::BigEndianOutputStream m_output_stream;
     ola::network::Interface m_interface;
     std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+    ola::ReceiveStatsMap *m_stats;
+    SourceStatsMap m_source_stats;
+    PowerSupplyMap m_power_supplies;
+    std::vector<uint8_t> m_sync_packet;
+    ola::thread::timeout_id m_flush_timeout;
 
     void SocketReady();
+    void ExpireSourceStats(const TimeStamp &now);
     void PopulatePacketHeader(uint16_t msg_type);
     bool InitNetwork();
+    void FlushTimeout();
+    void BuildPortOutPacket(uint8_t port, bool sync, PortOutPacket *packet);
+    bool SendPacket(const ola::network::IPV4Address &target,
+                    std::vector<uint8_t> *packet);
+    void DeletePowerSupply(PowerSupply *power_supply);
 
     static const uint16_t KINET_PORT;
     static const uint32_t KINET_MAGIC_NUMBER;
     static const uint16_t KINET_VERSION_ONE;
     static const uint16_t KINET_DMX_MSG;
     static const uint16_t KINET_PORTOUT_MSG;
+    static const uint16_t KINET_SYNC_MSG;
+    static const uint8_t KINET_PORTOUT_SYNC_FLAG;
+    static const unsigned int KINET_HEADER_SIZE;
+    static const unsigned int KINET_PORTOUT_HEADER_SIZE;
+    static const TimeInterval SOURCE_STATS_TIMEOUT;
     static const uint16_t KINET_PORTOUT_MIN_BUFFER_SIZE;
 
     DISALLOW_COPY_AND_ASSIGN(KiNetNode);
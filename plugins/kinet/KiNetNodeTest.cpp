@@ -38,6 +38,7 @@ class KiNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(KiNetNodeTest);
   CPPUNIT_TEST(testSendDMX);
   CPPUNIT_TEST(testSendPortOut);
+  CPPUNIT_TEST(testUpdatePortOut);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -52,6 +53,8 @@ class KiNetNodeTest: public CppUnit::TestFixture {
 
     void testSendPortOut();
 
+    void testUpdatePortOut();
+
  private:
     ola::io::SelectServer ss;
     IPV4Address target_ip;
@@ -172,3 +175,95 @@ void KiNetNodeTest::testSendPortOut() {
   m_socket->Verify();
   OLA_ASSERT(node.Stop());
 }
+
+/**
+ * Check batched PORTOUT with a sync packet.
+ */
+void KiNetNodeTest::testUpdatePortOut() {
+  KiNetNode node(&ss, m_socket);
+  OLA_ASSERT_TRUE(node.Start());
+  node.ConfigurePowerSupply(target_ip, true);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,5,8,10,14,45,100,255");
+  OLA_ASSERT_TRUE(node.UpdatePortOut(target_ip, 1, buffer));
+  OLA_ASSERT_TRUE(node.UpdatePortOut(target_ip, 2, buffer));
+  // nothing is sent until the flush
+  m_socket->Verify();
+
+  const uint8_t expected_port_1[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x01, 0x00,  // magic number
+    0x08, 0x01,  // packet type
+    0, 0, 0, 0,  // packet counter
+    0xff, 0xff, 0xff, 0xff,  // universe
+    1,  // port number
+    1, 0, 0,  // flags, hold for sync
+    24, 0,  // buffer size
+    0, 0,  // unknown start code
+    1, 5, 8, 10, 14, 45, 100, 255,  // data
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // data pad to 24 bytes
+  };
+  const uint8_t expected_port_2[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x01, 0x00,  // magic number
+    0x08, 0x01,  // packet type
+    1, 0, 0, 0,  // packet counter
+    0xff, 0xff, 0xff, 0xff,  // universe
+    2,  // port number
+    1, 0, 0,  // flags, hold for sync
+    24, 0,  // buffer size
+    0, 0,  // unknown start code
+    1, 5, 8, 10, 14, 45, 100, 255,  // data
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // data pad to 24 bytes
+  };
+  const uint8_t expected_sync[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x01, 0x00,  // magic number
+    0x09, 0x01,  // packet type
+    2, 0, 0, 0,  // packet counter
+    0, 0, 0, 0,  // padding
+  };
+
+  m_socket->AddExpectedData(expected_port_1, sizeof(expected_port_1),
+                            target_ip, KINET_PORT);
+  m_socket->AddExpectedData(expected_port_2, sizeof(expected_port_2),
+                            target_ip, KINET_PORT);
+  m_socket->AddExpectedData(expected_sync, sizeof(expected_sync),
+                            target_ip, KINET_PORT);
+  node.Flush();
+  m_socket->Verify();
+
+  // Only the changed port is sent on the next flush
+  const uint8_t expected_update[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x01, 0x00,  // magic number
+    0x08, 0x01,  // packet type
+    3, 0, 0, 0,  // packet counter
+    0xff, 0xff, 0xff, 0xff,  // universe
+    2,  // port number
+    1, 0, 0,  // flags, hold for sync
+    25, 0,  // buffer size
+    0, 0,  // unknown start code
+    255, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    255  // data
+  };
+  const uint8_t expected_update_sync[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x01, 0x00,  // magic number
+    0x09, 0x01,  // packet type
+    4, 0, 0, 0,  // packet counter
+    0, 0, 0, 0,  // padding
+  };
+
+  m_socket->AddExpectedData(expected_update, sizeof(expected_update),
+                            target_ip, KINET_PORT);
+  m_socket->AddExpectedData(expected_update_sync,
+                            sizeof(expected_update_sync), target_ip,
+                            KINET_PORT);
+  buffer.SetFromString(
+      "255,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,255");
+  OLA_ASSERT_TRUE(node.UpdatePortOut(target_ip, 2, buffer));
+  node.Flush();
+  m_socket->Verify();
+
+  // and nothing if there are no changes
+  node.Flush();
+  m_socket->Verify();
+  OLA_ASSERT(node.Stop());
+}
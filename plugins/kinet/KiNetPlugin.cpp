@@ -54,6 +54,9 @@ KiNetPlugin::~KiNetPlugin() {}
  */
 bool KiNetPlugin::StartHook() {
   m_node = new KiNetNode(m_plugin_adaptor);
+  m_node->SetReceiveStats(
+      m_plugin_adaptor->GetExportMap()->GetReceiveStatsMapVar(
+          "kinet-receive-stats", "source"));
 
   if (!m_node->Start()) {
     delete m_node;
@@ -40,6 +40,7 @@ class KiNetPlugin : public Plugin {
     ola_plugin_id Id() const { return OLA_PLUGIN_KINET; }
     std::string Description() const;
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreading() const { return true; }
 
  private:
     class KiNetNode *m_node;
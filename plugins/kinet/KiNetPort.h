@@ -86,7 +86,7 @@ class KiNetPortOutOutputPort: public KiNetOutputPort {
       OLA_WARN << "Invalid KiNet port id " << PortId();
       return false;
     }
-    return m_node->SendPortOut(m_target, PortId(), buffer);
+    return m_node->UpdatePortOut(m_target, PortId(), buffer);
   }
 
   std::string Description() const {
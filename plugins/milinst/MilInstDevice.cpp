@@ -49,10 +49,12 @@ const char MilInstDevice::TYPE_1553[] = "1-553";
  * @param owner  the plugin that owns this device
  * @param name  the device name
  * @param dev_path  path to the pro widget
+ * @param export_map  the ExportMap to record the bytes sent in, may be NULL
  */
 MilInstDevice::MilInstDevice(AbstractPlugin *owner,
                              Preferences *preferences,
-                             const string &dev_path)
+                             const string &dev_path,
+                             ola::ExportMap *export_map)
     : Device(owner, MILINST_DEVICE_NAME),
       m_path(dev_path),
       m_preferences(preferences) {
@@ -63,9 +65,10 @@ MilInstDevice::MilInstDevice(AbstractPlugin *owner,
   OLA_DEBUG << "Got type " << type;
 
   if (type.compare(TYPE_1553) == 0) {
-    m_widget.reset(new MilInstWidget1553(m_path, m_preferences));
+    m_widget.reset(new MilInstWidget1553(m_path, m_preferences,
+                                           export_map));
   } else {
-    m_widget.reset(new MilInstWidget1463(m_path));
+    m_widget.reset(new MilInstWidget1463(m_path, export_map));
   }
 }
 
@@ -29,6 +29,7 @@
 namespace ola {
 
 class AbstractPlugin;
+class ExportMap;
 
 namespace plugin {
 namespace milinst {
@@ -37,7 +38,8 @@ class MilInstDevice: public ola::Device {
  public:
   MilInstDevice(AbstractPlugin *owner,
                 class Preferences *preferences,
-                const std::string &dev_path);
+                const std::string &dev_path,
+                ola::ExportMap *export_map = NULL);
   ~MilInstDevice();
 
   std::string DeviceId() const { return m_path; }
@@ -60,7 +60,8 @@ bool MilInstPlugin::StartHook() {
       continue;
     }
 
-    device = new MilInstDevice(this, m_preferences, *it);
+    device = new MilInstDevice(this, m_preferences, *it,
+                               m_plugin_adaptor->GetExportMap());
     OLA_DEBUG << "Adding device " << *it;
 
     if (!device->Start()) {
@@ -30,9 +30,34 @@ namespace milinst {
 
 using std::string;
 
+const unsigned int MilInstWidget::FULL_REFRESH_INTERVAL_MS;
+const char MilInstWidget::BYTES_SENT_VAR[] = "milinst-bytes-sent";
+const char MilInstWidget::UTILIZATION_VAR[] = "milinst-wire-utilization";
+const char MilInstWidget::DEVICE_KEY[] = "device";
+
 /*
  * New widget
  */
+MilInstWidget::MilInstWidget(const string &path, ola::ExportMap *export_map)
+    : m_enabled(false),
+      m_path(path),
+      m_socket(NULL),
+      m_baudrate(0),
+      m_window_bytes(0),
+      m_bytes_sent_var(NULL),
+      m_utilization_var(NULL) {
+  if (export_map) {
+    m_bytes_sent_var = export_map->GetUIntMapVar(BYTES_SENT_VAR, DEVICE_KEY);
+    (*m_bytes_sent_var)[m_path] = 0;
+    m_utilization_var = export_map->GetUIntMapVar(UTILIZATION_VAR,
+                                                  DEVICE_KEY);
+    (*m_utilization_var)[m_path] = 0;
+  }
+}
+
+/*
+ * Destroy the widget
+ */
 MilInstWidget::~MilInstWidget() {
   if (m_socket) {
     m_socket->Close();
@@ -77,6 +102,41 @@ int MilInstWidget::Disconnect() {
   m_socket->Close();
   return 0;
 }
+
+
+/*
+ * Check if it's time for a full refresh. If it is, update the wire
+ * utilization for the period since the last one.
+ */
+bool MilInstWidget::StartFullRefresh() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  if (m_last_full_refresh.IsSet()) {
+    const int64_t elapsed_ms = (now - m_last_full_refresh).InMilliSeconds();
+    if (elapsed_ms < FULL_REFRESH_INTERVAL_MS) {
+      return false;
+    }
+    if (m_utilization_var && m_baudrate) {
+      // 8N1 is 10 bits per byte, this is a percentage.
+      (*m_utilization_var)[m_path] = static_cast<unsigned int>(
+          m_window_bytes * 10 * 100 * 1000ull / (m_baudrate * elapsed_ms));
+    }
+  }
+  m_last_full_refresh = now;
+  m_window_bytes = 0;
+  return true;
+}
+
+
+/*
+ * Record the number of bytes written to the widget.
+ */
+void MilInstWidget::RecordBytesSent(unsigned int bytes) {
+  m_window_bytes += bytes;
+  if (m_bytes_sent_var) {
+    (*m_bytes_sent_var)[m_path] += bytes;
+  }
+}
 }  // namespace milinst
 }  // namespace plugin
 }  // namespace ola
@@ -25,8 +25,10 @@
 #include <termios.h>
 #include <string>
 
-#include "ola/io/SelectServer.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/io/SelectServer.h"
 
 namespace ola {
 namespace plugin {
@@ -36,10 +38,12 @@ class MilInstWidget {
  public:
   static int ConnectToWidget(const std::string &path, speed_t speed = B9600);
 
-  explicit MilInstWidget(const std::string &path)
-      : m_enabled(false),
-        m_path(path),
-        m_socket(NULL) {}
+  /**
+   * @param path the path to the serial device.
+   * @param export_map the ExportMap to record the bytes sent in, may be NULL.
+   */
+  explicit MilInstWidget(const std::string &path,
+                         ola::ExportMap *export_map = NULL);
 
   virtual ~MilInstWidget();
 
@@ -56,16 +60,39 @@ class MilInstWidget {
     return str.str();
   }
 
-  virtual bool SendDmx(const DmxBuffer &buffer) const = 0;
+  /**
+   * @brief Send DMX data to the widget.
+   *
+   * Only the slots that changed since the last call are sent, apart from a
+   * full refresh once a second.
+   */
+  virtual bool SendDmx(const DmxBuffer &buffer) = 0;
   virtual bool DetectDevice() = 0;
 
  protected:
   virtual int SetChannel(unsigned int chan, uint8_t val) const = 0;
 
+  bool StartFullRefresh();
+  void RecordBytesSent(unsigned int bytes);
+
   // instance variables
   bool m_enabled;
   const std::string m_path;
   ola::io::ConnectedDescriptor *m_socket;
+  DmxBuffer m_last_sent;
+  unsigned int m_baudrate;  // Set by the subclass, used for the utilization
+
+ private:
+  ola::Clock m_clock;
+  TimeStamp m_last_full_refresh;
+  unsigned int m_window_bytes;  // sent since m_last_full_refresh
+  UIntMap *m_bytes_sent_var;
+  UIntMap *m_utilization_var;
+
+  static const unsigned int FULL_REFRESH_INTERVAL_MS = 1000;
+  static const char BYTES_SENT_VAR[];
+  static const char UTILIZATION_VAR[];
+  static const char DEVICE_KEY[];
 };
 }  // namespace milinst
 }  // namespace plugin
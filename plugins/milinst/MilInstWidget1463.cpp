@@ -58,10 +58,14 @@ bool MilInstWidget1463::DetectDevice() {
 /*
  * Send a DMX msg.
   */
-bool MilInstWidget1463::SendDmx(const DmxBuffer &buffer) const {
+bool MilInstWidget1463::SendDmx(const DmxBuffer &buffer) {
   // TODO(Peter): Probably add offset in here to send higher channels shifted
   // down
-  int bytes_sent = Send112(buffer);
+  int bytes_sent = Send112(buffer, !StartFullRefresh());
+  m_last_sent.Set(buffer);
+  if (bytes_sent > 0) {
+    RecordBytesSent(bytes_sent);
+  }
   OLA_DEBUG << "Sending DMX, sent " << bytes_sent << " bytes";
   // Should this confirm we've sent more than 0 bytes and return false if not?
   return true;
@@ -87,18 +91,28 @@ int MilInstWidget1463::SetChannel(unsigned int chan, uint8_t val) const {
  * Send 112 channels worth of data
  * @param buffer a DmxBuffer with the data
  */
-int MilInstWidget1463::Send112(const DmxBuffer &buffer) const {
+int MilInstWidget1463::Send112(const DmxBuffer &buffer,
+                               bool changed_only) const {
   unsigned int channels = std::min((unsigned int) DMX_MAX_TRANSMIT_CHANNELS,
                                    buffer.Size());
-  uint8_t msg[channels * 2];
-
-  for (unsigned int i = 0; i <= channels; i++) {
-    msg[i * 2] = i + 1;
-    msg[(i * 2) + 1] = buffer.Get(i);
-    OLA_DEBUG << "Setting " << (i + 1) << " to " <<
-        static_cast<int>(buffer.Get(i));
+  uint8_t msg[DMX_MAX_TRANSMIT_CHANNELS * 2];
+  unsigned int length = 0;
+
+  // Each channel is addressed individually, so skip the ones that haven't
+  // changed. Channels that are new since the last frame are always sent.
+  for (unsigned int i = 0; i < channels; i++) {
+    const uint8_t value = buffer.Get(i);
+    if (changed_only && i < m_last_sent.Size() &&
+        m_last_sent.Get(i) == value) {
+      continue;
+    }
+    msg[length++] = i + 1;
+    msg[length++] = value;
+  }
+  if (!length) {
+    return 0;
   }
-  return m_socket->Send(msg, (channels * 2));
+  return m_socket->Send(msg, length);
 }
 }  // namespace milinst
 }  // namespace plugin
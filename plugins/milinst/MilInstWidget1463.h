@@ -31,20 +31,25 @@ namespace milinst {
 
 class MilInstWidget1463: public MilInstWidget {
  public:
-  explicit MilInstWidget1463(const std::string &path): MilInstWidget(path) {}
+  explicit MilInstWidget1463(const std::string &path,
+                             ola::ExportMap *export_map = NULL)
+      : MilInstWidget(path, export_map) {
+    m_baudrate = BAUDRATE;
+  }
   ~MilInstWidget1463() {}
 
   bool Connect();
   bool DetectDevice();
-  bool SendDmx(const DmxBuffer &buffer) const;
+  bool SendDmx(const DmxBuffer &buffer);
   std::string Type() { return "Milford Instruments 1-463 Widget"; }
 
  protected:
   int SetChannel(unsigned int chan, uint8_t val) const;
-  int Send112(const DmxBuffer &buffer) const;
+  int Send112(const DmxBuffer &buffer, bool changed_only) const;
 
   // This interface can only transmit 112 channels
   enum { DMX_MAX_TRANSMIT_CHANNELS = 112 };
+  enum { BAUDRATE = 9600 };
 };
 }  // namespace milinst
 }  // namespace plugin
@@ -25,6 +25,7 @@
 #include "ola/io/Serial.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/dmx/TrackedDmxBuffer.h"
 #include "ola/util/Utils.h"
 #include "olad/Preferences.h"
 #include "plugins/milinst/MilInstWidget1553.h"
@@ -33,9 +34,12 @@ namespace ola {
 namespace plugin {
 namespace milinst {
 
+using ola::dmx::SlotRange;
+using ola::dmx::TrackedDmxBuffer;
 using std::set;
 using std::string;
 
+const unsigned int MilInstWidget1553::LOAD_HEADER_SIZE;
 const speed_t MilInstWidget1553::DEFAULT_BAUDRATE = B9600;
 
 const uint16_t MilInstWidget1553::CHANNELS_128 = 128;
@@ -45,8 +49,9 @@ const uint16_t MilInstWidget1553::DEFAULT_CHANNELS = CHANNELS_128;
 
 
 MilInstWidget1553::MilInstWidget1553(const string &path,
-                                     Preferences *preferences)
-    : MilInstWidget(path),
+                                     Preferences *preferences,
+                                     ola::ExportMap *export_map)
+    : MilInstWidget(path, export_map),
       m_preferences(preferences) {
   SetWidgetDefaults();
 
@@ -69,7 +74,9 @@ bool MilInstWidget1553::Connect() {
       !ola::io::UIntToSpeedT(baudrate_int, &baudrate)) {
     OLA_DEBUG << "Invalid baudrate, defaulting to 9600";
     baudrate = DEFAULT_BAUDRATE;
+    baudrate_int = ola::io::BAUD_RATE_9600;
   }
+  m_baudrate = baudrate_int;
 
   int fd = ConnectToWidget(m_path, baudrate);
 
@@ -117,10 +124,27 @@ bool MilInstWidget1553::DetectDevice() {
 /*
  * Send a DMX msg.
   */
-bool MilInstWidget1553::SendDmx(const DmxBuffer &buffer) const {
+bool MilInstWidget1553::SendDmx(const DmxBuffer &buffer) {
   // TODO(Peter): Probably add offset in here to send higher channels shifted
   // down
-  int bytes_sent = Send(buffer);
+  const unsigned int channels = std::min(
+      static_cast<unsigned int>(m_channels), buffer.Size());
+  SlotRange range(0, channels);
+  if (!StartFullRefresh()) {
+    range = TrackedDmxBuffer::DifferingRange(
+        m_last_sent.GetRaw(), m_last_sent.Size(),
+        buffer.GetRaw(), buffer.Size());
+    range.end = std::min(range.end, channels);
+  }
+  m_last_sent.Set(buffer);
+
+  int bytes_sent = 0;
+  if (range.first < range.end) {
+    bytes_sent = Send(buffer, range.first, range.end);
+    if (bytes_sent > 0) {
+      RecordBytesSent(bytes_sent);
+    }
+  }
   OLA_DEBUG << "Sending DMX, sent " << bytes_sent << " bytes";
   // Should this confirm we've sent more than 0 bytes and return false if not?
   return true;
@@ -146,18 +170,21 @@ int MilInstWidget1553::SetChannel(unsigned int chan, uint8_t val) const {
 /*
  * Send data
  * @param buffer a DmxBuffer with the data
+ * @param first the first slot to send
+ * @param end one past the last slot to send
  */
-int MilInstWidget1553::Send(const DmxBuffer &buffer) const {
-  unsigned int channels = std::min(static_cast<unsigned int>(m_channels),
-                                   buffer.Size());
-  uint8_t msg[3 + channels];
+int MilInstWidget1553::Send(const DmxBuffer &buffer, unsigned int first,
+                            unsigned int end) const {
+  unsigned int channels = end - first;
+  uint8_t msg[LOAD_HEADER_SIZE + channels];
 
+  // The LOAD command takes the address of the first channel in the message.
   msg[0] = MILINST_1553_LOAD_COMMAND;
-  ola::utils::SplitUInt16(1, &msg[1], &msg[2]);
+  ola::utils::SplitUInt16(first + 1, &msg[1], &msg[2]);
 
-  buffer.Get(msg + 3, &channels);
+  buffer.GetRange(first, msg + LOAD_HEADER_SIZE, &channels);
 
-  return m_socket->Send(msg, sizeof(msg));
+  return m_socket->Send(msg, LOAD_HEADER_SIZE + channels);
 }
 
 
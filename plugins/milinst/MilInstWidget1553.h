@@ -31,21 +31,24 @@ namespace milinst {
 
 class MilInstWidget1553: public MilInstWidget {
  public:
-  explicit MilInstWidget1553(const std::string &path, Preferences *preferences);
+  MilInstWidget1553(const std::string &path, Preferences *preferences,
+                    ola::ExportMap *export_map = NULL);
   ~MilInstWidget1553() {}
 
   bool Connect();
   bool DetectDevice();
-  bool SendDmx(const DmxBuffer &buffer) const;
+  bool SendDmx(const DmxBuffer &buffer);
   std::string Type() { return "Milford Instruments 1-553 Widget"; }
 
   void SocketReady();
 
  protected:
   int SetChannel(unsigned int chan, uint8_t val) const;
-  int Send(const DmxBuffer &buffer) const;
+  int Send(const DmxBuffer &buffer, unsigned int first,
+           unsigned int end) const;
 
   static const uint8_t MILINST_1553_LOAD_COMMAND = 0x01;
+  static const unsigned int LOAD_HEADER_SIZE = 3;
 
   static const speed_t DEFAULT_BAUDRATE;
 
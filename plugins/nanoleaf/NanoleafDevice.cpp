@@ -26,6 +26,7 @@
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/NetworkUtils.h"
@@ -40,6 +41,7 @@ namespace ola {
 namespace plugin {
 namespace nanoleaf {
 
+using ola::dmx::PixelProcessor;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using std::auto_ptr;
@@ -68,7 +70,15 @@ NanoleafDevice::NanoleafDevice(
  * @return true on success, false on failure
  */
 bool NanoleafDevice::StartHook() {
-  vector<uint8_t> panels;
+  unsigned int version_value;
+  if (!StringToInt(m_preferences->GetValue(VersionKey()), &version_value) ||
+      version_value != NanoleafNode::VERSION_V2) {
+    version_value = NanoleafNode::VERSION_V1;
+  }
+  const NanoleafNode::ProtocolVersion version =
+      static_cast<NanoleafNode::ProtocolVersion>(version_value);
+
+  vector<uint16_t> panels;
   vector<string> panel_list;
   StringSplit(m_preferences->GetValue(PanelsKey()), &panel_list, ",");
   vector<string>::const_iterator iter = panel_list.begin();
@@ -77,8 +87,10 @@ bool NanoleafDevice::StartHook() {
       continue;
     }
 
-    uint8_t panel;
-    if (!StringToInt(*iter, &panel)) {
+    uint16_t panel;
+    if (!StringToInt(*iter, &panel) ||
+        (version == NanoleafNode::VERSION_V1 &&
+         panel > std::numeric_limits<uint8_t>::max())) {
       OLA_WARN << "Invalid value for panel: " << *iter;
       return false;
     }
@@ -91,7 +103,10 @@ bool NanoleafDevice::StartHook() {
     return false;
   }
 
-  m_node = new NanoleafNode(m_plugin_adaptor, panels);
+  m_node = new NanoleafNode(m_plugin_adaptor, panels, version);
+  PixelProcessor::Options pixel_processing;
+  PopulatePixelProcessingOptions(&pixel_processing);
+  m_node->SetPixelProcessing(pixel_processing);
 
   if (!m_node->Start()) {
     delete m_node;
@@ -104,7 +119,13 @@ bool NanoleafDevice::StartHook() {
     ip_port = DEFAULT_STREAMING_PORT;
   }
   IPV4SocketAddress socket_address = IPV4SocketAddress(m_controller, ip_port);
-  AddPort(new NanoleafOutputPort(this, socket_address, m_node, 0));
+  unsigned int max_frame_rate;
+  if (!StringToInt(m_preferences->GetValue(MaxFrameRateKey()),
+                   &max_frame_rate)) {
+    max_frame_rate = 0;
+  }
+  AddPort(new NanoleafOutputPort(this, socket_address, m_node, 0,
+                                 m_plugin_adaptor, max_frame_rate));
   return true;
 }
 
@@ -124,6 +145,33 @@ string NanoleafDevice::PanelsKey() const {
 }
 
 
+string NanoleafDevice::VersionKey() const {
+  return m_controller.ToString() + "-version";
+}
+
+
+string NanoleafDevice::MaxFrameRateKey() const {
+  return m_controller.ToString() + "-max-frame-rate";
+}
+
+
+/*
+ * The pixel processing keys are <controller>-<option>, e.g. 10.0.0.1-gamma.
+ */
+void NanoleafDevice::PopulatePixelProcessingOptions(
+    PixelProcessor::Options *options) {
+  const vector<string> &names = PixelProcessor::OptionNames();
+  vector<string>::const_iterator iter = names.begin();
+  for (; iter != names.end(); ++iter) {
+    const string key = m_controller.ToString() + "-" + *iter;
+    if (!PixelProcessor::SetOption(*iter, m_preferences->GetValue(key),
+                                   options)) {
+      OLA_WARN << "Invalid value for " << key;
+    }
+  }
+}
+
+
 void NanoleafDevice::SetDefaults() {
   // Set device options
   m_preferences->SetDefaultValue(PanelsKey(), StringValidator(), "");
@@ -131,6 +179,12 @@ void NanoleafDevice::SetDefaults() {
       IPPortKey(),
       UIntValidator(1, std::numeric_limits<uint16_t>::max()),
       DEFAULT_STREAMING_PORT);
+  m_preferences->SetDefaultValue(
+      VersionKey(),
+      UIntValidator(NanoleafNode::VERSION_V1, NanoleafNode::VERSION_V2),
+      NanoleafNode::VERSION_V1);
+  m_preferences->SetDefaultValue(MaxFrameRateKey(),
+                                 UIntValidator(0, MAX_FRAME_RATE), 0);
   m_preferences->Save();
 }
 
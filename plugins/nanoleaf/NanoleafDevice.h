@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/network/IPV4Address.h"
 #include "olad/Device.h"
 
@@ -54,8 +55,13 @@ class NanoleafDevice: public ola::Device {
     void SetDefaults();
     std::string IPPortKey() const;
     std::string PanelsKey() const;
+    std::string VersionKey() const;
+    std::string MaxFrameRateKey() const;
+    void PopulatePixelProcessingOptions(
+        ola::dmx::PixelProcessor::Options *options);
 
     static const uint16_t DEFAULT_STREAMING_PORT = 60221;
+    static const unsigned int MAX_FRAME_RATE = 1000;
 };
 }  // namespace nanoleaf
 }  // namespace plugin
@@ -18,7 +18,7 @@
  * Copyright (C) 2017 Peter Newman
  */
 
-#include <math.h>
+#include <string.h>
 
 #include <algorithm>
 #include <memory>
@@ -38,19 +38,55 @@ using ola::network::UDPSocket;
 using std::auto_ptr;
 using std::vector;
 
+namespace {
+// Both versions put the colors and the transition time at the same offsets
+// in a panel's record.
+const unsigned int COLOR_OFFSET = 2;
+const unsigned int TRANSITION_OFFSET = 6;
+const unsigned int V1_HEADER_SIZE = 1;
+const unsigned int V1_RECORD_SIZE = 7;
+const unsigned int V2_HEADER_SIZE = 2;
+const unsigned int V2_RECORD_SIZE = 8;
+}  // namespace
+
 /*
  * Create a new Nanoleaf node.
  * @param ss a SelectServerInterface to use
+ * @param panels the IDs of the panels to control, in slot order.
+ * @param version the protocol version to use.
  * @param socket a UDPSocket or Null. Ownership is transferred.
  */
 NanoleafNode::NanoleafNode(ola::io::SelectServerInterface *ss,
-                           std::vector<uint8_t> panels,
+                           const vector<uint16_t> &panels,
+                           ProtocolVersion version,
                            ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_ss(ss),
-      m_panels(panels),
-      m_output_stream(&m_output_queue),
+      m_version(version),
+      m_header_size(version == VERSION_V1 ? V1_HEADER_SIZE : V2_HEADER_SIZE),
+      m_record_size(version == VERSION_V1 ? V1_RECORD_SIZE : V2_RECORD_SIZE),
+      m_panel_count(std::min(
+          static_cast<unsigned int>(panels.size()),
+          static_cast<unsigned int>(DMX_UNIVERSE_SIZE /
+                                    NANOLEAF_SLOTS_PER_PANEL))),
+      m_panels_sent(0),
       m_socket(socket) {
+  // Build the record for each panel now, so sending a frame is just a case of
+  // filling in the colors.
+  m_records.resize(m_panel_count * m_record_size, 0);
+  for (unsigned int i = 0; i < m_panel_count; i++) {
+    uint8_t *record = &m_records[i * m_record_size];
+    if (m_version == VERSION_V1) {
+      record[0] = static_cast<uint8_t>(panels[i]);
+      record[1] = NANOLEAF_FRAME_COUNT;
+    } else {
+      record[0] = panels[i] >> 8;
+      record[1] = panels[i] & 0xff;
+    }
+    record[COLOR_OFFSET + NANOLEAF_SLOTS_PER_PANEL] = NANOLEAF_WHITE_LEVEL;
+    SetTransitionTime(record, MIN_TRANSITION_TIME);
+  }
+  m_packet.resize(m_header_size + m_records.size());
 }
 
 
@@ -94,6 +130,18 @@ bool NanoleafNode::Stop() {
 }
 
 
+/*
+ * Set the processing applied to the panel colors.
+ */
+void NanoleafNode::SetPixelProcessing(
+    const ola::dmx::PixelProcessor::Options &options) {
+  m_pixel_processor.reset(new ola::dmx::PixelProcessor(options));
+  if (m_pixel_processor->IsIdentity()) {
+    m_pixel_processor.reset();
+  }
+}
+
+
 /*
  * Send some DMX data
  */
@@ -107,31 +155,98 @@ bool NanoleafNode::SendDMX(const IPV4SocketAddress &target,
              << ", got " << buffer.Size();
   }
 
-  uint8_t panel_count = std::min(
-      static_cast<uint8_t>(m_panels.size()),
-      static_cast<uint8_t>(floor(buffer.Size() / NANOLEAF_SLOTS_PER_PANEL)));
+  const unsigned int panel_count = std::min(
+      m_panel_count, buffer.Size() / NANOLEAF_SLOTS_PER_PANEL);
+  if (!panel_count) {
+    return true;
+  }
+
+  const uint8_t *colors = buffer.GetRaw();
+  uint8_t processed[DMX_UNIVERSE_SIZE];
+  if (m_pixel_processor.get()) {
+    m_pixel_processor->Process(colors, panel_count, processed);
+    colors = processed;
+  }
+
+  const uint16_t transition_time = TransitionTime();
+  const unsigned int color_size = panel_count * NANOLEAF_SLOTS_PER_PANEL;
+  // Panels that weren't in the last frame always count as changed.
+  const unsigned int known_size = std::min(
+      color_size, m_panels_sent * NANOLEAF_SLOTS_PER_PANEL);
+  m_last_colors.resize(m_panel_count * NANOLEAF_SLOTS_PER_PANEL);
+
+  uint8_t *ptr = &m_packet[m_header_size];
+  unsigned int records = 0;
+  for (unsigned int i = 0; i < panel_count; i++) {
+    const unsigned int offset = i * NANOLEAF_SLOTS_PER_PANEL;
+    const uint8_t *color = colors + offset;
+    bool changed = (offset >= known_size ||
+                    memcmp(&m_last_colors[offset], color,
+                           NANOLEAF_SLOTS_PER_PANEL) != 0);
+    if (!changed && m_version != VERSION_V1) {
+      continue;
+    }
+
+    uint8_t *record = &m_records[i * m_record_size];
+    memcpy(record + COLOR_OFFSET, color, NANOLEAF_SLOTS_PER_PANEL);
+    SetTransitionTime(record, transition_time);
+    memcpy(ptr, record, m_record_size);
+    ptr += m_record_size;
+    records++;
+  }
+  memcpy(&m_last_colors[0], colors, color_size);
+  m_panels_sent = panel_count;
 
-  m_output_queue.Clear();
-  m_output_stream << panel_count;
-  for (uint8_t i = 0; i < panel_count; i++) {
-    m_output_stream << m_panels[i] << NANOLEAF_FRAME_COUNT;
-    m_output_stream.Write(buffer.GetRaw() + (i * NANOLEAF_SLOTS_PER_PANEL),
-                          NANOLEAF_SLOTS_PER_PANEL);
-    m_output_stream << NANOLEAF_WHITE_LEVEL << NANOLEAF_TRANSITION_TIME;
+  if (!records) {
+    return true;
   }
 
-  // m_output_queue.Dump(&std::cerr);
+  if (m_version == VERSION_V1) {
+    m_packet[0] = static_cast<uint8_t>(records);
+  } else {
+    m_packet[0] = records >> 8;
+    m_packet[1] = records & 0xff;
+  }
 
-  bool ok = m_socket->SendTo(&m_output_queue, target);
-  if (!ok) {
+  const unsigned int size = ptr - &m_packet[0];
+  ssize_t bytes_sent = m_socket->SendTo(&m_packet[0], size, target);
+  if (bytes_sent != static_cast<ssize_t>(size)) {
     OLA_WARN << "Failed to send Nanoleaf packet";
+    // Make sure everything is sent next time.
+    m_panels_sent = 0;
+    return false;
   }
+  return true;
+}
+
+
+/*
+ * Work out the transition time from the interval between updates, so the
+ * panels fade smoothly from one update to the next at low update rates.
+ */
+uint16_t NanoleafNode::TransitionTime() {
+  const TimeStamp *now = m_ss->WakeUpTime();
+  uint16_t transition_time = MIN_TRANSITION_TIME;
+  if (m_last_update.IsSet() && now->IsSet() && *now > m_last_update) {
+    const int64_t interval = (*now - m_last_update).InMilliSeconds();
+    transition_time = static_cast<uint16_t>(std::max(
+        static_cast<int64_t>(MIN_TRANSITION_TIME),
+        std::min(static_cast<int64_t>(MAX_TRANSITION_TIME),
+                 interval / TRANSITION_TIME_UNIT_MS)));
+  }
+  m_last_update = *now;
+  return transition_time;
+}
+
 
-  if (!m_output_queue.Empty()) {
-    OLA_WARN << "Failed to send complete Nanoleaf packet";
-    m_output_queue.Clear();
+void NanoleafNode::SetTransitionTime(uint8_t *record,
+                                     uint16_t transition_time) {
+  if (m_version == VERSION_V1) {
+    record[TRANSITION_OFFSET] = static_cast<uint8_t>(transition_time);
+  } else {
+    record[TRANSITION_OFFSET] = transition_time >> 8;
+    record[TRANSITION_OFFSET + 1] = transition_time & 0xff;
   }
-  return ok;
 }
 
 
@@ -24,10 +24,10 @@
 #include <memory>
 #include <vector>
 
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
-#include "ola/io/OutputStream.h"
-#include "ola/io/IOQueue.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/Interface.h"
 #include "ola/network/SocketAddress.h"
@@ -39,34 +39,68 @@ namespace nanoleaf {
 
 class NanoleafNode {
  public:
+    /*
+     * The version of the external control streaming protocol. V1 is used by
+     * the Aurora, V2 by the Canvas and later controllers.
+     */
+    enum ProtocolVersion {
+      VERSION_V1 = 1,
+      VERSION_V2 = 2,
+    };
+
     NanoleafNode(ola::io::SelectServerInterface *ss,
-                 std::vector<uint8_t> panels,
+                 const std::vector<uint16_t> &panels,
+                 ProtocolVersion version = VERSION_V1,
                  ola::network::UDPSocketInterface *socket = NULL);
     virtual ~NanoleafNode();
 
     bool Start();
     bool Stop();
 
-    // The following apply to Input Ports (those which send data)
+    // Set the processing applied to the panel colors.
+    void SetPixelProcessing(const ola::dmx::PixelProcessor::Options &options);
+
+    /*
+     * Send the panel colors. With V1 every panel is sent each time. V2
+     * supports partial frames, so only the panels that have changed since
+     * the last frame are sent, and nothing is sent if none have. The
+     * transition time tracks the interval between updates.
+     */
     bool SendDMX(const ola::network::IPV4SocketAddress &target,
                  const ola::DmxBuffer &buffer);
 
  private:
     bool m_running;
     ola::io::SelectServerInterface *m_ss;
-    std::vector<uint8_t> m_panels;
-    ola::io::IOQueue m_output_queue;
-    ola::io::OutputStream m_output_stream;
+    const ProtocolVersion m_version;
+    const unsigned int m_header_size;
+    const unsigned int m_record_size;
+    const unsigned int m_panel_count;
+    // One pre-built record per panel, only the colors and transition time
+    // change.
+    std::vector<uint8_t> m_records;
+    // The colors last sent to each panel.
+    std::vector<uint8_t> m_last_colors;
+    unsigned int m_panels_sent;
+    std::vector<uint8_t> m_packet;
+    TimeStamp m_last_update;
     ola::network::Interface m_interface;
     std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+    // NULL if the pixel processing doesn't change the data.
+    std::auto_ptr<ola::dmx::PixelProcessor> m_pixel_processor;
 
     void SocketReady();
     bool InitNetwork();
+    uint16_t TransitionTime();
+    void SetTransitionTime(uint8_t *record, uint16_t transition_time);
 
     static const uint8_t NANOLEAF_FRAME_COUNT = 0x01;
     static const uint8_t NANOLEAF_WHITE_LEVEL = 0x00;
-    static const uint8_t NANOLEAF_TRANSITION_TIME = 0x01;
     static const uint8_t NANOLEAF_SLOTS_PER_PANEL = 3;
+    // The transition time is in units of 100ms.
+    static const unsigned int TRANSITION_TIME_UNIT_MS = 100;
+    static const uint16_t MIN_TRANSITION_TIME = 1;
+    static const uint16_t MAX_TRANSITION_TIME = 10;
 
     DISALLOW_COPY_AND_ASSIGN(NanoleafNode);
 };
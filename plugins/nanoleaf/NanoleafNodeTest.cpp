@@ -24,6 +24,7 @@
 
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/SocketAddress.h"
@@ -32,6 +33,7 @@
 #include "ola/testing/TestUtils.h"
 
 using ola::DmxBuffer;
+using ola::dmx::PixelProcessor;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::plugin::nanoleaf::NanoleafNode;
@@ -42,6 +44,8 @@ using std::vector;
 class NanoleafNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(NanoleafNodeTest);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testSendDMXWithPixelProcessing);
+  CPPUNIT_TEST(testSendDMXV2);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -53,6 +57,8 @@ class NanoleafNodeTest: public CppUnit::TestFixture {
     void setUp();
 
     void testSendDMX();
+    void testSendDMXWithPixelProcessing();
+    void testSendDMXV2();
 
  private:
     ola::io::SelectServer ss;
@@ -74,11 +80,11 @@ void NanoleafNodeTest::setUp() {
  * Check sending DMX works.
  */
 void NanoleafNodeTest::testSendDMX() {
-  vector<uint8_t> panels;
+  vector<uint16_t> panels;
   panels.push_back(0x10);
   panels.push_back(0x20);
 
-  NanoleafNode node(&ss, panels, m_socket);
+  NanoleafNode node(&ss, panels, NanoleafNode::VERSION_V1, m_socket);
   OLA_ASSERT_TRUE(node.Start());
 
   const uint8_t expected_data[] = {
@@ -97,3 +103,78 @@ void NanoleafNodeTest::testSendDMX() {
   m_socket->Verify();
   OLA_ASSERT(node.Stop());
 }
+
+/**
+ * Check the pixel processing is applied to the panel colors.
+ */
+void NanoleafNodeTest::testSendDMXWithPixelProcessing() {
+  vector<uint16_t> panels;
+  panels.push_back(0x10);
+  panels.push_back(0x20);
+
+  NanoleafNode node(&ss, panels, NanoleafNode::VERSION_V1, m_socket);
+  PixelProcessor::Options options;
+  options.gamma = 2.0;
+  options.white_balance[2] = 0.5;
+  node.SetPixelProcessing(options);
+  OLA_ASSERT_TRUE(node.Start());
+
+  const uint8_t expected_data[] = {
+    0x02,
+    0x10, 0x01, 255, 64, 128, 0x00, 0x01,
+    0x20, 0x01, 0, 0, 32, 0x00, 0x01
+  };
+
+  m_socket->AddExpectedData(expected_data, sizeof(expected_data), target_ip,
+                            NANOLEAF_PORT);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("255,128,255,0,0,128,7");
+  OLA_ASSERT_TRUE(node.SendDMX(IPV4SocketAddress(target_ip, NANOLEAF_PORT),
+                               buffer));
+  m_socket->Verify();
+  OLA_ASSERT(node.Stop());
+}
+
+/**
+ * Check V2 only sends the panels that have changed.
+ */
+void NanoleafNodeTest::testSendDMXV2() {
+  vector<uint16_t> panels;
+  panels.push_back(0x1234);
+  panels.push_back(0x20);
+
+  NanoleafNode node(&ss, panels, NanoleafNode::VERSION_V2, m_socket);
+  OLA_ASSERT_TRUE(node.Start());
+  const IPV4SocketAddress target(target_ip, NANOLEAF_PORT);
+
+  // The first frame has all the panels.
+  const uint8_t expected_data[] = {
+    0x00, 0x02,
+    0x12, 0x34, 1, 5, 8, 0x00, 0x00, 0x01,
+    0x00, 0x20, 10, 14, 45, 0x00, 0x00, 0x01
+  };
+  m_socket->AddExpectedData(expected_data, sizeof(expected_data), target_ip,
+                            NANOLEAF_PORT);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,5,8,10,14,45");
+  OLA_ASSERT_TRUE(node.SendDMX(target, buffer));
+  m_socket->Verify();
+
+  // Nothing is sent if nothing has changed.
+  OLA_ASSERT_TRUE(node.SendDMX(target, buffer));
+  m_socket->Verify();
+
+  // Only the second panel has changed.
+  const uint8_t expected_update[] = {
+    0x00, 0x01,
+    0x00, 0x20, 10, 14, 46, 0x00, 0x00, 0x01
+  };
+  m_socket->AddExpectedData(expected_update, sizeof(expected_update),
+                            target_ip, NANOLEAF_PORT);
+  buffer.SetChannel(5, 46);
+  OLA_ASSERT_TRUE(node.SendDMX(target, buffer));
+  m_socket->Verify();
+  OLA_ASSERT(node.Stop());
+}
@@ -40,6 +40,7 @@ class NanoleafPlugin : public Plugin {
     ola_plugin_id Id() const { return OLA_PLUGIN_NANOLEAF; }
     std::string Description() const;
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreading() const { return true; }
 
  private:
     std::vector<class NanoleafDevice*> m_devices;
@@ -31,25 +31,29 @@ namespace ola {
 namespace plugin {
 namespace nanoleaf {
 
-class NanoleafOutputPort: public BasicOutputPort {
+class NanoleafOutputPort: public RateLimitedOutputPort {
  public:
   NanoleafOutputPort(NanoleafDevice *device,
                      const ola::network::IPV4SocketAddress &target,
                      NanoleafNode *node,
-                     unsigned int port_id)
-      : BasicOutputPort(device, port_id),
+                     unsigned int port_id,
+                     PluginAdaptor *plugin_adaptor,
+                     unsigned int max_frame_rate)
+      : RateLimitedOutputPort(device, port_id, plugin_adaptor,
+                              max_frame_rate),
         m_node(node),
         m_target(target) {
   }
 
-  bool WriteDMX(const DmxBuffer &buffer, OLA_UNUSED uint8_t priority) {
-    return m_node->SendDMX(m_target, buffer);
-  }
-
   std::string Description() const {
     return "Controller: " + m_target.Host().ToString();
   }
 
+ protected:
+  bool SendDMX(const DmxBuffer &buffer, OLA_UNUSED uint8_t priority) {
+    return m_node->SendDMX(m_target, buffer);
+  }
+
  private:
   NanoleafNode *m_node;
   const ola::network::IPV4SocketAddress m_target;
@@ -35,6 +35,7 @@
 #include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/io/IOUtils.h"
+#include "ola/util/StallWatchdog.h"
 #include "plugins/opendmx/OpenDmxThread.h"
 
 namespace ola {
@@ -49,7 +50,7 @@ using ola::thread::MutexLocker;
  * Create a new OpenDmxThread object
  */
 OpenDmxThread::OpenDmxThread(const string &path)
-    : ola::thread::Thread(),
+    : ola::thread::Thread(ola::thread::Thread::Options("opendmx")),
     m_fd(INVALID_FD),
     m_path(path),
     m_term(false) {
@@ -63,12 +64,14 @@ void *OpenDmxThread::Run() {
   uint8_t buffer[DMX_UNIVERSE_SIZE+1];
   unsigned int length = DMX_UNIVERSE_SIZE;
   Clock clock;
+  // Each frame is supervised by the stall watchdog, if there is one.
+  ola::Heartbeat heartbeat(Name());
 
   // should close other fd here
 
   // start code
   buffer[0] = 0x00;
-  ola::io::Open(m_path, O_WRONLY, &m_fd);
+  OpenDevice();
 
   while (true) {
     {
@@ -77,7 +80,7 @@ void *OpenDmxThread::Run() {
         break;
     }
 
-    if (m_fd == INVALID_FD) {
+    if (!IsOpen()) {
       TimeStamp wake_up;
       // Use real time here because wake_up is passed to pthread_cond_timedwait
       clock.CurrentRealTime(&wake_up);
@@ -90,29 +93,78 @@ void *OpenDmxThread::Run() {
       m_term_cond.TimedWait(&m_term_mutex, wake_up);
       m_term_mutex.Unlock();
 
-      ola::io::Open(m_path, O_WRONLY, &m_fd);
+      OpenDevice();
 
     } else {
+      heartbeat.Begin();
       length = DMX_UNIVERSE_SIZE;
       {
         MutexLocker locker(&m_mutex);
         m_buffer.Get(buffer + 1, &length);
       }
 
-      if (write(m_fd, buffer, length + 1) < 0) {
-        // if you unplug the dongle
-        OLA_WARN << "Error writing to device: " << strerror(errno);
+      bool ok;
+      if (m_line_driver.get()) {
+        // SendFrame() returns once the frame is out, which paces the loop.
+        ok = m_line_driver->SendFrame(buffer, length + 1);
+      } else {
+        ok = write(m_fd, buffer, length + 1) >= 0;
+        if (!ok) {
+          OLA_WARN << "Error writing to device: " << strerror(errno);
+        }
+      }
 
-        if (close(m_fd) < 0)
-          OLA_WARN << "Close failed " << strerror(errno);
-        m_fd = INVALID_FD;
+      if (!ok) {
+        // if you unplug the dongle
+        CloseDevice();
       }
+      heartbeat.End();
     }
   }
+  CloseDevice();
   return NULL;
 }
 
 
+/*
+ * Open the device. The Open DMX kernel module generates the break itself, a
+ * serial port with an RS-485 transceiver is driven with a DmxLineDriver.
+ */
+void OpenDmxThread::OpenDevice() {
+  if (!ola::io::Open(m_path, O_WRONLY | O_NOCTTY, &m_fd)) {
+    m_fd = INVALID_FD;
+    return;
+  }
+
+  if (!isatty(m_fd)) {
+    return;
+  }
+
+  close(m_fd);
+  m_fd = INVALID_FD;
+  m_line_driver.reset(
+      new ola::io::DmxLineDriver(m_path, ola::io::DmxLineDriver::Options()));
+  if (!m_line_driver->Open()) {
+    m_line_driver.reset();
+  }
+}
+
+
+bool OpenDmxThread::IsOpen() const {
+  return m_fd != INVALID_FD || m_line_driver.get();
+}
+
+
+void OpenDmxThread::CloseDevice() {
+  m_line_driver.reset();
+  if (m_fd != INVALID_FD) {
+    if (close(m_fd) < 0)
+      OLA_WARN << "Close failed " << strerror(errno);
+    m_fd = INVALID_FD;
+  }
+}
+
+
 /*
  * Stop the thread
  */
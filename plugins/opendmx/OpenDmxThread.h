@@ -21,8 +21,10 @@
 #ifndef PLUGINS_OPENDMX_OPENDMXTHREAD_H_
 #define PLUGINS_OPENDMX_OPENDMXTHREAD_H_
 
+#include <memory>
 #include <string>
 #include "ola/DmxBuffer.h"
+#include "ola/io/DmxLineDriver.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
@@ -40,6 +42,9 @@ class OpenDmxThread: public ola::thread::Thread {
 
  private:
     int m_fd;
+    // set if the device is a plain serial port rather than the Open DMX
+    // kernel module.
+    std::auto_ptr<ola::io::DmxLineDriver> m_line_driver;
     std::string m_path;
     DmxBuffer m_buffer;
     bool m_term;
@@ -47,6 +52,10 @@ class OpenDmxThread: public ola::thread::Thread {
     ola::thread::Mutex m_term_mutex;
     ola::thread::ConditionVariable m_term_cond;
 
+    void OpenDevice();
+    bool IsOpen() const;
+    void CloseDevice();
+
     static const int INVALID_FD = -1;
 };
 }  // namespace opendmx
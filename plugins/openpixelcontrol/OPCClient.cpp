@@ -20,7 +20,10 @@
 
 #include "plugins/openpixelcontrol/OPCClient.h"
 
+#include <string.h>
+
 #include "ola/Callback.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
 #include "ola/io/BigEndianStream.h"
@@ -35,6 +38,7 @@ namespace plugin {
 namespace openpixelcontrol {
 
 using ola::TimeInterval;
+using ola::dmx::PixelProcessor;
 using ola::network::TCPSocket;
 
 OPCClient::OPCClient(ola::io::SelectServerInterface *ss,
@@ -55,18 +59,47 @@ OPCClient::~OPCClient() {
   }
 }
 
-bool OPCClient::SendDmx(uint8_t channel, const DmxBuffer &buffer) {
+bool OPCClient::SendDmx(uint8_t channel, const DmxBuffer &buffer,
+                        PixelProcessor *processor) {
+  return SendFrame(channel, buffer.GetRaw(), buffer.Size(), processor);
+}
+
+bool OPCClient::SendFrame(uint8_t channel, const uint8_t *data,
+                          unsigned int length, PixelProcessor *processor) {
   if (!m_sender.get()) {
     return false;  // not connected
   }
 
+  if (length > MAX_OPC_DATA_SIZE) {
+    OLA_WARN << "Truncating OPC frame of " << length << " bytes";
+    length = MAX_OPC_DATA_SIZE;
+  }
+
   ola::io::IOQueue queue(&m_pool);
   ola::io::BigEndianOutputStream stream(&queue);
   stream << channel;
   stream << SET_PIXEL_COMMAND;
-  stream << static_cast<uint16_t>(buffer.Size());
-  stream.Write(buffer.GetRaw(), buffer.Size());
-  return m_sender->SendMessage(&queue);
+  stream << static_cast<uint16_t>(length);
+  if (processor && length) {
+    // Any slots after the last complete pixel are sent as is.
+    if (m_processed_data.size() < length) {
+      m_processed_data.resize(length);
+    }
+    uint8_t *processed = &m_processed_data[0];
+    const unsigned int pixels = length / PixelProcessor::SLOTS_PER_PIXEL;
+    const unsigned int pixel_slots = pixels * PixelProcessor::SLOTS_PER_PIXEL;
+    processor->Process(data, pixels, processed);
+    memcpy(processed + pixel_slots, data + pixel_slots,
+           length - pixel_slots);
+    stream.Write(processed, length);
+  } else {
+    stream.Write(data, length);
+  }
+  // Messages are keyed on the channel, so if the server falls behind only the
+  // latest frame for each channel is kept. All the pending channels are
+  // written together once the socket is writable.
+  m_sender->SendLatestMessage(channel, &queue);
+  return true;
 }
 
 void OPCClient::SetSocketCallback(SocketEventCallback *callback) {
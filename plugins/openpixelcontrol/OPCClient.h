@@ -23,8 +23,10 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ola/DmxBuffer.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/io/MemoryBlockPool.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/AdvancedTCPConnector.h"
@@ -45,6 +47,11 @@ namespace openpixelcontrol {
  * @brief An Open Pixel Control client.
  *
  * The OPC client connects to a remote IP:port and sends OPC messages.
+ *
+ * Messages aren't written straight away. Each channel holds at most one
+ * pending message, and all the channels for the server are sent in a single
+ * write when the socket is next writable. If the server can't keep up, newer
+ * frames replace older ones rather than queuing behind them.
  */
 class OPCClient {
  public:
@@ -76,8 +83,23 @@ class OPCClient {
    * @brief Send a DMX frame.
    * @param channel the OPC channel to use.
    * @param buffer the DMX data.
+   * @param processor the PixelProcessor to apply to the data as it's copied
+   *   into the frame, may be NULL.
+   * @returns true if the frame was queued, false if we're not connected.
+   */
+  bool SendDmx(uint8_t channel, const DmxBuffer &buffer,
+               ola::dmx::PixelProcessor *processor = NULL);
+
+  /**
+   * @brief Send a frame of any size, e.g. one assembled from many universes.
+   * @param channel the OPC channel to use.
+   * @param data the pixel data.
+   * @param length the length of the data, at most 65535 bytes.
+   * @param processor the PixelProcessor to apply to the data, may be NULL.
+   * @returns true if the frame was queued, false if we're not connected.
    */
-  bool SendDmx(uint8_t channel, const DmxBuffer &buffer);
+  bool SendFrame(uint8_t channel, const uint8_t *data, unsigned int length,
+                 ola::dmx::PixelProcessor *processor = NULL);
 
   /**
    * @brief Set the callback to be run when the socket state changes.
@@ -97,11 +119,15 @@ class OPCClient {
   std::auto_ptr<ola::network::TCPSocket> m_client_socket;
   std::auto_ptr<ola::io::NonBlockingSender> m_sender;
   std::auto_ptr<SocketEventCallback> m_socket_callback;
+  // Holds the processed pixels, this is reused between frames.
+  std::vector<uint8_t> m_processed_data;
 
   void SocketConnected(ola::network::TCPSocket *socket);
   void NewData();
   void SocketClosed();
 
+  static const unsigned int MAX_OPC_DATA_SIZE = 0xffff;
+
   DISALLOW_COPY_AND_ASSIGN(OPCClient);
 };
 }  // namespace openpixelcontrol
@@ -25,6 +25,7 @@
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/SocketAddress.h"
@@ -35,6 +36,7 @@
 
 
 using ola::DmxBuffer;
+using ola::dmx::PixelProcessor;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::plugin::openpixelcontrol::OPCClient;
@@ -44,6 +46,8 @@ using std::auto_ptr;
 class OPCClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OPCClientTest);
   CPPUNIT_TEST(testTransmit);
+  CPPUNIT_TEST(testTransmitWithPixelProcessor);
+  CPPUNIT_TEST(testLatestFrameWins);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -54,12 +58,18 @@ class OPCClientTest: public CppUnit::TestFixture {
   void setUp();
 
   void testTransmit();
+  void testTransmitWithPixelProcessor();
+  void testLatestFrameWins();
 
  private:
   ola::io::SelectServer m_ss;
   auto_ptr<OPCServer> m_server;
   DmxBuffer m_received_data;
   uint8_t m_command;
+  PixelProcessor *m_processor;
+  DmxBuffer m_received_data2;
+  unsigned int m_frame_count;
+  unsigned int m_frame_count2;
 
   void CaptureData(uint8_t command, const uint8_t *data, unsigned int length) {
     m_received_data.Set(data, length);
@@ -69,13 +79,44 @@ class OPCClientTest: public CppUnit::TestFixture {
 
   void SendDMX(OPCClient *client, DmxBuffer *buffer, bool connected) {
     if (connected) {
-      OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, *buffer));
+      OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, *buffer, m_processor));
     } else {
       m_ss.Terminate();
     }
   }
 
+  void CaptureFrame(uint8_t, const uint8_t *data, unsigned int length) {
+    m_received_data.Set(data, length);
+    m_frame_count++;
+    if (m_frame_count2) {
+      m_ss.Terminate();
+    }
+  }
+
+  void CaptureFrame2(uint8_t, const uint8_t *data, unsigned int length) {
+    m_received_data2.Set(data, length);
+    m_frame_count2++;
+    if (m_frame_count) {
+      m_ss.Terminate();
+    }
+  }
+
+  void SendFrames(OPCClient *client, bool connected) {
+    if (!connected) {
+      m_ss.Terminate();
+      return;
+    }
+    DmxBuffer buffer;
+    buffer.SetFromString("1,2,3");
+    OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, buffer));
+    buffer.SetFromString("4,5,6");
+    OLA_ASSERT_TRUE(client->SendDmx(CHANNEL2, buffer));
+    buffer.SetFromString("7,8,9");
+    OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, buffer));
+  }
+
   static const uint8_t CHANNEL = 1;
+  static const uint8_t CHANNEL2 = 2;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OPCClientTest);
@@ -88,6 +129,9 @@ void OPCClientTest::setUp() {
       ola::NewCallback(this, &OPCClientTest::CaptureData));
 
   OLA_ASSERT_TRUE(m_server->Init());
+  m_processor = NULL;
+  m_frame_count = 0;
+  m_frame_count2 = 0;
 }
 
 void OPCClientTest::testTransmit() {
@@ -111,3 +155,48 @@ void OPCClientTest::testTransmit() {
   // Now sends should fail since there is no connection
   OLA_ASSERT_FALSE(client.SendDmx(CHANNEL, buffer));
 }
+
+void OPCClientTest::testTransmitWithPixelProcessor() {
+  PixelProcessor::Options options;
+  OLA_ASSERT_TRUE(PixelProcessor::SetOption("color-order", "BGR", &options));
+  PixelProcessor processor(options);
+  m_processor = &processor;
+
+  OPCClient client(&m_ss, m_server->ListenAddress());
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5,6,7");
+
+  client.SetSocketCallback(
+      ola::NewCallback(this, &OPCClientTest::SendDMX, &client, &buffer));
+
+  m_ss.Run();
+  DmxBuffer expected;
+  expected.SetFromString("3,2,1,6,5,4,7");
+  OLA_ASSERT_EQ(expected, m_received_data);
+}
+
+/*
+ * Check that an unsent frame is replaced by a newer one for the same channel,
+ * and that frames for other channels are still sent.
+ */
+void OPCClientTest::testLatestFrameWins() {
+  m_server->SetCallback(
+      CHANNEL,
+      ola::NewCallback(this, &OPCClientTest::CaptureFrame));
+  m_server->SetCallback(
+      CHANNEL2,
+      ola::NewCallback(this, &OPCClientTest::CaptureFrame2));
+
+  OPCClient client(&m_ss, m_server->ListenAddress());
+  client.SetSocketCallback(
+      ola::NewCallback(this, &OPCClientTest::SendFrames, &client));
+
+  m_ss.Run();
+  DmxBuffer expected;
+  expected.SetFromString("7,8,9");
+  OLA_ASSERT_EQ(expected, m_received_data);
+  OLA_ASSERT_EQ(1u, m_frame_count);
+  expected.SetFromString("4,5,6");
+  OLA_ASSERT_EQ(expected, m_received_data2);
+  OLA_ASSERT_EQ(1u, m_frame_count2);
+}
@@ -20,12 +20,15 @@
 
 #include "plugins/openpixelcontrol/OPCDevice.h"
 
+#include <algorithm>
 #include <sstream>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/dmx/PixelProcessor.h"
+#include "ola/stl/STLUtils.h"
 #include "olad/Preferences.h"
 #include "plugins/openpixelcontrol/OPCPort.h"
 
@@ -34,6 +37,9 @@ namespace plugin {
 namespace openpixelcontrol {
 
 using ola::AbstractPlugin;
+using ola::PixelMap;
+using ola::PixelMapOutputPort;
+using ola::dmx::PixelProcessor;
 using std::ostringstream;
 using std::set;
 using std::string;
@@ -55,6 +61,39 @@ set<uint8_t> DeDupChannels(const vector<string> &channels) {
   }
   return output;
 }
+
+/*
+ * Read a per-channel option, e.g. listen_<ip:port>_channel_<n>_universes.
+ */
+unsigned int GetChannelOption(Preferences *preferences,
+                              const string &prefix,
+                              uint8_t channel,
+                              const string &option,
+                              unsigned int min,
+                              unsigned int max,
+                              unsigned int default_value) {
+  ostringstream str;
+  str << prefix << "_channel_" << static_cast<int>(channel) << "_" << option;
+  const string value = preferences->GetValue(str.str());
+  if (value.empty()) {
+    return default_value;
+  }
+
+  unsigned int result;
+  if (!StringToInt(value, &result) || result < min || result > max) {
+    OLA_WARN << "Invalid value for " << str.str() << ", using "
+             << default_value;
+    return default_value;
+  }
+  return result;
+}
+
+// Port ids for the extra universes of a channel are channel + n * 256, so the
+// first universe keeps the id it's always had.
+const unsigned int PORT_ID_STRIDE = 256;
+const unsigned int MAX_UNIVERSES_PER_CHANNEL = 128;
+const unsigned int DEFAULT_SLOTS_PER_UNIVERSE = 510;
+const unsigned int MAX_OPC_DATA_SIZE = 0xffff;
 }  // namespace
 
 OPCServerDevice::OPCServerDevice(
@@ -79,18 +118,58 @@ bool OPCServerDevice::StartHook() {
   }
 
   ostringstream str;
-  str << "listen_" << m_listen_addr << "_channel";
+  str << "listen_" << m_listen_addr;
+  const string prefix = str.str();
   set<uint8_t> channels = DeDupChannels(
-      m_preferences->GetMultipleValue(str.str()));
+      m_preferences->GetMultipleValue(prefix + "_channel"));
   set<uint8_t>::const_iterator iter = channels.begin();
   for (; iter != channels.end(); ++iter) {
-    OPCInputPort *port = new OPCInputPort(this, *iter, m_plugin_adaptor,
-                                          m_server.get());
-    AddPort(port);
+    const uint8_t channel = *iter;
+    // A channel can carry more pixels than fit in a single universe, in which
+    // case it's split across consecutive ports.
+    unsigned int universes = GetChannelOption(
+        m_preferences, prefix, channel, "universes", 1,
+        MAX_UNIVERSES_PER_CHANNEL, 1);
+    unsigned int slots_per_universe = DMX_UNIVERSE_SIZE;
+    if (universes > 1) {
+      slots_per_universe = GetChannelOption(
+          m_preferences, prefix, channel, "slots_per_universe", 1,
+          DMX_UNIVERSE_SIZE, DEFAULT_SLOTS_PER_UNIVERSE);
+    }
+
+    vector<OPCInputPort*> &ports = m_channel_ports[channel];
+    for (unsigned int i = 0; i < universes; i++) {
+      OPCInputPort *port = new OPCInputPort(
+          this, channel + i * PORT_ID_STRIDE, channel, m_plugin_adaptor,
+          m_server.get(), i * slots_per_universe, slots_per_universe);
+      if (AddPort(port)) {
+        ports.push_back(port);
+      }
+    }
+    m_server->SetCallback(
+        channel,
+        NewCallback(this, &OPCServerDevice::ChannelData, channel));
   }
   return true;
 }
 
+void OPCServerDevice::PrePortStop() {
+  ChannelPortMap::iterator iter = m_channel_ports.begin();
+  for (; iter != m_channel_ports.end(); ++iter) {
+    m_server->SetCallback(iter->first, NULL);
+  }
+  m_channel_ports.clear();
+}
+
+void OPCServerDevice::ChannelData(uint8_t channel, uint8_t command,
+                                  const uint8_t *data, unsigned int length) {
+  vector<OPCInputPort*> &ports = m_channel_ports[channel];
+  vector<OPCInputPort*>::iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    (*iter)->NewData(command, data, length);
+  }
+}
+
 OPCClientDevice::OPCClientDevice(AbstractPlugin *owner,
                                  PluginAdaptor *plugin_adaptor,
                                  Preferences *preferences,
@@ -108,16 +187,96 @@ string OPCClientDevice::DeviceId() const {
 
 bool OPCClientDevice::StartHook() {
   ostringstream str;
-  str << "target_" << m_target << "_channel";
+  str << "target_" << m_target;
+  const string prefix = str.str();
   set<uint8_t> channels = DeDupChannels(
-      m_preferences->GetMultipleValue(str.str()));
+      m_preferences->GetMultipleValue(prefix + "_channel"));
   set<uint8_t>::const_iterator iter = channels.begin();
   for (; iter != channels.end(); ++iter) {
-    OPCOutputPort *port = new OPCOutputPort(this, *iter, m_client.get());
+    PixelProcessor::Options pixel_processing;
+    PopulatePixelProcessingOptions(*iter, &pixel_processing);
+
+    unsigned int universes = GetChannelOption(
+        m_preferences, prefix, *iter, "universes", 1,
+        MAX_UNIVERSES_PER_CHANNEL, 1);
+    if (universes > 1) {
+      AddPixelMapPorts(*iter, universes, pixel_processing);
+      continue;
+    }
+
+    OPCOutputPort *port = new OPCOutputPort(this, *iter, m_client.get(),
+                                            pixel_processing);
     AddPort(port);
   }
   return true;
 }
+
+void OPCClientDevice::PostPortStop() {
+  STLDeleteValues(&m_pixel_map_channels);
+}
+
+/*
+ * Create a port for each universe of the channel. The universes are
+ * assembled into a single frame which is sent as one OPC message.
+ */
+void OPCClientDevice::AddPixelMapPorts(
+    uint8_t channel,
+    unsigned int universes,
+    const PixelProcessor::Options &pixel_processing) {
+  ostringstream str;
+  str << "target_" << m_target;
+
+  PixelMap::Options options;
+  options.segments = universes;
+  options.slots_per_segment = GetChannelOption(
+      m_preferences, str.str(), channel, "slots_per_universe", 1,
+      DMX_UNIVERSE_SIZE, DEFAULT_SLOTS_PER_UNIVERSE);
+  // Keep the frame within the 16 bit OPC length.
+  options.segments = std::min(
+      options.segments, MAX_OPC_DATA_SIZE / options.slots_per_segment);
+
+  PixelMapChannel *pixel_map_channel = new PixelMapChannel();
+  pixel_map_channel->pixel_map.reset(new PixelMap(
+      m_plugin_adaptor, options,
+      NewCallback(this, &OPCClientDevice::SendFrame, channel)));
+  pixel_map_channel->pixel_processor.reset(
+      new PixelProcessor(pixel_processing));
+  if (pixel_map_channel->pixel_processor->IsIdentity()) {
+    pixel_map_channel->pixel_processor.reset();
+  }
+  STLReplaceAndDelete(&m_pixel_map_channels, channel, pixel_map_channel);
+
+  for (unsigned int i = 0; i < options.segments; i++) {
+    AddPort(new PixelMapOutputPort(this, channel + i * PORT_ID_STRIDE,
+                                   pixel_map_channel->pixel_map.get(), i));
+  }
+}
+
+void OPCClientDevice::SendFrame(uint8_t channel, const uint8_t *data,
+                                unsigned int length) {
+  PixelMapChannel *pixel_map_channel = STLFindOrNull(m_pixel_map_channels,
+                                                     channel);
+  if (pixel_map_channel) {
+    m_client->SendFrame(channel, data, length,
+                        pixel_map_channel->pixel_processor.get());
+  }
+}
+
+void OPCClientDevice::PopulatePixelProcessingOptions(
+    uint8_t channel,
+    PixelProcessor::Options *options) {
+  const vector<string> &names = PixelProcessor::OptionNames();
+  vector<string>::const_iterator iter = names.begin();
+  for (; iter != names.end(); ++iter) {
+    ostringstream str;
+    str << "target_" << m_target << "_channel_" << static_cast<int>(channel)
+        << "_" << *iter;
+    if (!PixelProcessor::SetOption(*iter, m_preferences->GetValue(str.str()),
+                                   options)) {
+      OLA_WARN << "Invalid value for " << str.str();
+    }
+  }
+}
 }  // namespace openpixelcontrol
 }  // namespace plugin
 }  // namespace ola
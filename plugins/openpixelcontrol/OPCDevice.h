@@ -21,11 +21,15 @@
 #ifndef PLUGINS_OPENPIXELCONTROL_OPCDEVICE_H_
 #define PLUGINS_OPENPIXELCONTROL_OPCDEVICE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/network/Socket.h"
 #include "olad/Device.h"
+#include "olad/PixelMap.h"
 #include "plugins/openpixelcontrol/OPCClient.h"
 #include "plugins/openpixelcontrol/OPCServer.h"
 
@@ -56,12 +60,20 @@ class OPCServerDevice: public ola::Device {
 
  protected:
   bool StartHook();
+  void PrePortStop();
 
  private:
   PluginAdaptor* const m_plugin_adaptor;
   Preferences* const m_preferences;
   const ola::network::IPV4SocketAddress m_listen_addr;
   std::auto_ptr<class OPCServer> m_server;
+  typedef std::map<uint8_t, std::vector<class OPCInputPort*> >
+      ChannelPortMap;
+
+  ChannelPortMap m_channel_ports;
+
+  void ChannelData(uint8_t channel, uint8_t command, const uint8_t *data,
+                   unsigned int length);
 
   DISALLOW_COPY_AND_ASSIGN(OPCServerDevice);
 };
@@ -86,12 +98,30 @@ class OPCClientDevice: public ola::Device {
 
  protected:
   bool StartHook();
+  void PostPortStop();
 
  private:
+  // A channel that's fed from several universes.
+  struct PixelMapChannel {
+    std::auto_ptr<ola::PixelMap> pixel_map;
+    // NULL if the pixel processing doesn't change the data.
+    std::auto_ptr<ola::dmx::PixelProcessor> pixel_processor;
+  };
+
+  typedef std::map<uint8_t, PixelMapChannel*> PixelMapChannels;
+
   PluginAdaptor* const m_plugin_adaptor;
   Preferences* const m_preferences;
   const ola::network::IPV4SocketAddress m_target;
   std::auto_ptr<class OPCClient> m_client;
+  PixelMapChannels m_pixel_map_channels;
+
+  void AddPixelMapPorts(uint8_t channel, unsigned int universes,
+                        const ola::dmx::PixelProcessor::Options &options);
+  void SendFrame(uint8_t channel, const uint8_t *data, unsigned int length);
+  void PopulatePixelProcessingOptions(
+      uint8_t channel,
+      ola::dmx::PixelProcessor::Options *options);
 
   DISALLOW_COPY_AND_ASSIGN(OPCClientDevice);
 };
@@ -41,6 +41,7 @@ class OPCPlugin: public Plugin {
   ola_plugin_id Id() const { return OLA_PLUGIN_OPENPIXELCONTROL; }
   std::string Description() const;
   std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+  bool SupportsThreading() const { return true; }
 
  private:
   typedef std::vector<ola::Device*> OPCDevices;
@@ -20,6 +20,7 @@
 
 #include "plugins/openpixelcontrol/OPCPort.h"
 
+#include <algorithm>
 #include <string>
 #include "ola/base/Macro.h"
 #include "plugins/openpixelcontrol/OPCClient.h"
@@ -34,13 +35,17 @@ namespace openpixelcontrol {
 using std::string;
 
 OPCInputPort::OPCInputPort(OPCServerDevice *parent,
+                           unsigned int port_id,
                            uint8_t channel,
                            class PluginAdaptor *plugin_adaptor,
-                           class OPCServer *server)
-    : BasicInputPort(parent, channel, plugin_adaptor),
+                           class OPCServer *server,
+                           unsigned int offset,
+                           unsigned int length)
+    : BasicInputPort(parent, port_id, plugin_adaptor),
       m_channel(channel),
-      m_server(server) {
-  m_server->SetCallback(channel, NewCallback(this, &OPCInputPort::NewData));
+      m_server(server),
+      m_offset(offset),
+      m_length(length) {
 }
 
 void OPCInputPort::NewData(uint8_t command,
@@ -51,7 +56,11 @@ void OPCInputPort::NewData(uint8_t command,
               << static_cast<int>(command);
     return;
   }
-  m_buffer.Set(data, length);
+  if (length <= m_offset) {
+    // The message doesn't reach this port's universe.
+    return;
+  }
+  m_buffer.Set(data + m_offset, std::min(length - m_offset, m_length));
   DmxChanged();
 }
 
@@ -59,20 +68,29 @@ string OPCInputPort::Description() const {
   std::ostringstream str;
   str << m_server->ListenAddress() << ", Channel "
       << static_cast<int>(m_channel);
+  if (m_offset) {
+    str << ", from slot " << m_offset + 1;
+  }
   return str.str();
 }
 
-OPCOutputPort::OPCOutputPort(OPCClientDevice *parent,
-                             uint8_t channel,
-                             OPCClient *client)
+OPCOutputPort::OPCOutputPort(
+    OPCClientDevice *parent,
+    uint8_t channel,
+    OPCClient *client,
+    const ola::dmx::PixelProcessor::Options &pixel_processing)
     : BasicOutputPort(parent, channel),
       m_client(client),
-      m_channel(channel) {
+      m_channel(channel),
+      m_pixel_processor(new ola::dmx::PixelProcessor(pixel_processing)) {
+  if (m_pixel_processor->IsIdentity()) {
+    m_pixel_processor.reset();
+  }
 }
 
 bool OPCOutputPort::WriteDMX(const DmxBuffer &buffer,
                              OLA_UNUSED uint8_t priority) {
-  return m_client->SendDmx(m_channel, buffer);
+  return m_client->SendDmx(m_channel, buffer, m_pixel_processor.get());
 }
 
 string OPCOutputPort::Description() const {
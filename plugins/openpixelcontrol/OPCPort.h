@@ -21,8 +21,10 @@
 #ifndef PLUGINS_OPENPIXELCONTROL_OPCPORT_H_
 #define PLUGINS_OPENPIXELCONTROL_OPCPORT_H_
 
+#include <memory>
 #include <string>
 #include "ola/DmxBuffer.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "olad/Port.h"
 #include "plugins/openpixelcontrol/OPCDevice.h"
 
@@ -40,14 +42,24 @@ class OPCInputPort: public BasicInputPort {
   /**
    * @brief Create a new OPC Input Port.
    * @param parent the OPCDevice this port belongs to
+   * @param port_id the id of the port.
    * @param channel the OPC channel for the port.
    * @param plugin_adaptor the PluginAdaptor to use
    * @param server the OPCServer to use, ownership is not transferred.
+   * @param offset the offset of this port's data within the OPC message.
+   * @param length the maximum number of slots this port takes from the OPC
+   *   message.
+   *
+   * The port doesn't register with the server, the device passes the channel
+   * data to each of the ports for the channel.
    */
   OPCInputPort(OPCServerDevice *parent,
+               unsigned int port_id,
                uint8_t channel,
                class PluginAdaptor *plugin_adaptor,
-               class OPCServer *server);
+               class OPCServer *server,
+               unsigned int offset,
+               unsigned int length);
 
   const DmxBuffer &ReadDMX() const { return m_buffer; }
 
@@ -55,13 +67,18 @@ class OPCInputPort: public BasicInputPort {
 
   std::string Description() const;
 
+  /**
+   * @brief Called when data arrives for this port's channel.
+   */
+  void NewData(uint8_t command, const uint8_t *data, unsigned int length);
+
  private:
   const uint8_t m_channel;
   class OPCServer* const m_server;
+  const unsigned int m_offset;
+  const unsigned int m_length;
   DmxBuffer m_buffer;
 
-  void NewData(uint8_t command, const uint8_t *data, unsigned int length);
-
   DISALLOW_COPY_AND_ASSIGN(OPCInputPort);
 };
 
@@ -76,10 +93,12 @@ class OPCOutputPort: public BasicOutputPort {
    * @param channel the OPC channel for the port.
    * @param client the OPCClient to use for this port, ownership is not
    *   transferred.
+   * @param pixel_processing the processing to apply to the pixel data.
    */
   OPCOutputPort(OPCClientDevice *parent,
                 uint8_t channel,
-                class OPCClient *client);
+                class OPCClient *client,
+                const ola::dmx::PixelProcessor::Options &pixel_processing);
 
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
 
@@ -88,6 +107,8 @@ class OPCOutputPort: public BasicOutputPort {
  private:
   class OPCClient* const m_client;
   const uint8_t m_channel;
+  // NULL if the pixel processing doesn't change the data.
+  std::auto_ptr<ola::dmx::PixelProcessor> m_pixel_processor;
 
   DISALLOW_COPY_AND_ASSIGN(OPCOutputPort);
 };
@@ -20,6 +20,7 @@
 
 #include "plugins/openpixelcontrol/OPCServer.h"
 
+#include <string.h>
 #include <string>
 #include "ola/Callback.h"
 #include "ola/Logging.h"
@@ -45,18 +46,6 @@ void CleanupSocket(TCPSocket *socket) {
 }
 }  // namespace
 
-void OPCServer::RxState::CheckSize() {
-  expected_size = utils::JoinUInt8(data[2], data[3]);
-  if (static_cast<unsigned int>(expected_size) + OPC_HEADER_SIZE >
-      buffer_size) {
-    uint8_t *new_buffer = new uint8_t[expected_size + OPC_HEADER_SIZE];
-    memcpy(new_buffer, data, offset);
-    delete[] data;
-    data = new_buffer;
-    buffer_size = expected_size + OPC_HEADER_SIZE;
-  }
-}
-
 OPCServer::OPCServer(ola::io::SelectServerInterface *ss,
                      const ola::network::IPV4SocketAddress &listen_addr)
     : m_ss(ss),
@@ -124,7 +113,7 @@ void OPCServer::NewTCPConnection(TCPSocket *socket) {
 void OPCServer::SocketReady(TCPSocket *socket, RxState *rx_state) {
   unsigned int data_received = 0;
   if (socket->Receive(rx_state->data + rx_state->offset,
-                      rx_state->buffer_size - rx_state->offset,
+                      RX_BUFFER_SIZE - rx_state->offset,
                       data_received) < 0) {
     OLA_WARN << "Bad read from " << socket->GetPeerAddress();
     SocketClosed(socket);
@@ -132,26 +121,48 @@ void OPCServer::SocketReady(TCPSocket *socket, RxState *rx_state) {
   }
 
   rx_state->offset += data_received;
-  if (rx_state->offset < OPC_HEADER_SIZE) {
-    return;
+
+  unsigned int start = HandleData(rx_state->data, rx_state->offset);
+  if (start) {
+    rx_state->offset -= start;
+    memmove(rx_state->data, rx_state->data + start, rx_state->offset);
   }
+}
 
-  rx_state->CheckSize();
-  if (rx_state->offset <
-      static_cast<unsigned int>(rx_state->expected_size) + OPC_HEADER_SIZE) {
+unsigned int OPCServer::HandleData(const uint8_t *data, unsigned int length) {
+  // A single read can contain many messages, handle all the complete ones.
+  unsigned int start = 0;
+  while (length - start >= OPC_HEADER_SIZE) {
+    const uint8_t *message = data + start;
+    unsigned int message_length = utils::JoinUInt8(message[2], message[3]);
+    if (length - start < message_length + OPC_HEADER_SIZE) {
+      break;
+    }
+    DispatchMessage(message, message_length);
+    start += message_length + OPC_HEADER_SIZE;
+  }
+  return start;
+}
+
+void OPCServer::DispatchMessage(const uint8_t *message, unsigned int length) {
+  const uint8_t channel = message[0];
+  const uint8_t command = message[1];
+  const uint8_t *data = message + OPC_HEADER_SIZE;
+
+  if (channel == BROADCAST_CHANNEL) {
+    std::map<uint8_t, ChannelCallback*>::iterator iter = m_callbacks.begin();
+    for (; iter != m_callbacks.end(); ++iter) {
+      if (iter->second) {
+        iter->second->Run(command, data, length);
+      }
+    }
     return;
   }
 
-  ChannelCallback *cb = STLFindOrNull(m_callbacks, rx_state->data[0]);
+  ChannelCallback *cb = STLFindOrNull(m_callbacks, channel);
   if (cb) {
-    DmxBuffer buffer(rx_state->data + OPC_HEADER_SIZE,
-                     rx_state->offset - OPC_HEADER_SIZE);
-    cb->Run(rx_state->data[1],
-            rx_state->data + OPC_HEADER_SIZE,
-            rx_state->expected_size);
+    cb->Run(command, data, length);
   }
-  rx_state->offset = 0;
-  rx_state->expected_size = 0;
 }
 
 void OPCServer::SocketClosed(TCPSocket *socket) {
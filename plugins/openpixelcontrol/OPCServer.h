@@ -71,7 +71,8 @@ class OPCServer {
 
   /**
    * @brief Set the callback to be run when channel data arrives.
-   * @param channel the OPC channel this callback is for.
+   * @param channel the OPC channel this callback is for. Messages sent to the
+   *   broadcast channel, 0, are passed to every callback.
    * @param callback The callback to run, ownership is transferred and any
    *   previous callbacks for this channel are removed.
    */
@@ -84,26 +85,41 @@ class OPCServer {
    */
   ola::network::IPV4SocketAddress ListenAddress() const;
 
+  /**
+   * @brief Dispatch the complete messages in a block of data.
+   * @param data the data received from a client.
+   * @param length the length of the data.
+   * @returns the number of bytes used. Any partial message at the end of the
+   *   data isn't used.
+   *
+   * This is called with the data read from each client, it's public so the
+   * parser can be benchmarked without a connection.
+   */
+  unsigned int HandleData(const uint8_t *data, unsigned int length);
+
  private:
+  /*
+   * The receive buffer for a client. It's large enough for the biggest OPC
+   * message, so it's never resized. Complete messages are passed to the
+   * callbacks straight from the buffer, and any partial message left at the
+   * end is moved to the front before the next read.
+   */
   struct RxState {
    public:
     unsigned int offset;
-    uint16_t expected_size;
     uint8_t *data;
-    unsigned int buffer_size;
 
     RxState()
         : offset(0),
-          expected_size(0) {
-      buffer_size = OPC_FRAME_SIZE,
-      data = new uint8_t[buffer_size];
+          data(new uint8_t[RX_BUFFER_SIZE]) {
     }
 
     ~RxState() {
       delete[] data;
     }
 
-    void CheckSize();
+   private:
+    DISALLOW_COPY_AND_ASSIGN(RxState);
   };
 
   typedef std::map<ola::network::TCPSocket*, RxState*> ClientMap;
@@ -119,6 +135,10 @@ class OPCServer {
   void NewTCPConnection(ola::network::TCPSocket *socket);
   void SocketReady(ola::network::TCPSocket *socket, RxState *rx_state);
   void SocketClosed(ola::network::TCPSocket *socket);
+  void DispatchMessage(const uint8_t *message, unsigned int length);
+
+  static const uint8_t BROADCAST_CHANNEL = 0;
+  static const unsigned int RX_BUFFER_SIZE = OPC_HEADER_SIZE + 0xffff;
 
   DISALLOW_COPY_AND_ASSIGN(OPCServer);
 };
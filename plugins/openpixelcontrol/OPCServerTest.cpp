@@ -47,12 +47,16 @@ class OPCServerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testUnknownCommand);
   CPPUNIT_TEST(testLargeFrame);
   CPPUNIT_TEST(testHangingFrame);
+  CPPUNIT_TEST(testMultipleMessages);
+  CPPUNIT_TEST(testBroadcast);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   OPCServerTest()
       : CppUnit::TestFixture(),
-        m_ss(NULL) {
+        m_ss(NULL),
+        m_command(0),
+        m_frame_count(0) {
   }
   void setUp();
 
@@ -60,6 +64,8 @@ class OPCServerTest: public CppUnit::TestFixture {
   void testUnknownCommand();
   void testLargeFrame();
   void testHangingFrame();
+  void testMultipleMessages();
+  void testBroadcast();
 
  private:
   ola::io::SelectServer m_ss;
@@ -67,6 +73,7 @@ class OPCServerTest: public CppUnit::TestFixture {
   auto_ptr<TCPSocket> m_client_socket;
   DmxBuffer m_received_data;
   uint8_t m_command;
+  unsigned int m_frame_count;
 
   void SendDataAndCheck(uint8_t channel,
                         const DmxBuffer &data);
@@ -74,6 +81,7 @@ class OPCServerTest: public CppUnit::TestFixture {
   void CaptureData(uint8_t command, const uint8_t *data, unsigned int length) {
     m_received_data.Set(data, length);
     m_command = command;
+    m_frame_count++;
     m_ss.Terminate();
   }
 
@@ -151,3 +159,39 @@ void OPCServerTest::testHangingFrame() {
   uint8_t data[] = {1, 0};
   m_client_socket->Send(data, arraysize(data));
 }
+
+/*
+ * Check that all the messages in a single read are handled, and that a
+ * message split across reads is put back together.
+ */
+void OPCServerTest::testMultipleMessages() {
+  uint8_t data[] = {
+    1, 0, 0, 2, 1, 2,
+    1, 0, 0, 3, 3, 4, 5,
+    1, 0, 0, 2, 6
+  };
+  m_client_socket->Send(data, arraysize(data));
+  m_ss.Run();
+
+  DmxBuffer buffer;
+  buffer.SetFromString("3,4,5");
+  OLA_ASSERT_EQ(2u, m_frame_count);
+  OLA_ASSERT_EQ(m_received_data, buffer);
+
+  uint8_t remainder[] = {7};
+  m_client_socket->Send(remainder, arraysize(remainder));
+  m_ss.Run();
+
+  buffer.SetFromString("6,7");
+  OLA_ASSERT_EQ(3u, m_frame_count);
+  OLA_ASSERT_EQ(m_received_data, buffer);
+}
+
+/*
+ * Check that messages to channel 0 are passed to every channel.
+ */
+void OPCServerTest::testBroadcast() {
+  DmxBuffer buffer;
+  buffer.SetFromString("9,8,7");
+  SendDataAndCheck(0, buffer);
+}
@@ -0,0 +1,181 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OSCAddressTrie.h
+ * Map OSC addresses to values, one trie level per address component.
+ * Copyright (C) 2012 Simon Newton
+ */
+
+#ifndef PLUGINS_OSC_OSCADDRESSTRIE_H_
+#define PLUGINS_OSC_OSCADDRESSTRIE_H_
+
+#include <ola/base/Macro.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace plugin {
+namespace osc {
+
+/**
+ * An OSCAddressTrie maps OSC addresses to pointers. Lookups walk the address
+ * a component at a time, straight from the char buffer liblo hands us, so
+ * dispatching a message doesn't need to copy or split the address.
+ *
+ * The trie doesn't own the values.
+ */
+template <typename T>
+class OSCAddressTrie {
+ public:
+  OSCAddressTrie() : m_root("") {}
+  ~OSCAddressTrie() {}
+
+  /**
+   * Add an address.
+   * @returns false if the address already has a value.
+   */
+  bool Insert(const std::string &address, T *value) {
+    Node *node = &m_root;
+    const char *component = address.c_str();
+    const char *end = component + address.size();
+    while (true) {
+      const char *separator = FindSeparator(component, end);
+      Node *child = node->Child(component, separator - component);
+      if (!child) {
+        child = new Node(std::string(component, separator));
+        node->children.push_back(child);
+      }
+      node = child;
+      if (separator == end) {
+        break;
+      }
+      component = separator + 1;
+    }
+
+    if (node->value) {
+      return false;
+    }
+    node->value = value;
+    return true;
+  }
+
+  /**
+   * Remove an address.
+   * @returns the value the address had, or NULL if it wasn't present.
+   */
+  T *Remove(const std::string &address) {
+    Node *node = Lookup(address.c_str(), address.size());
+    if (!node) {
+      return NULL;
+    }
+    T *value = node->value;
+    node->value = NULL;
+    // Empty branches are left in place, the set of addresses is small and
+    // they're likely to be registered again when a port is re-patched.
+    return value;
+  }
+
+  /**
+   * Find the value for an address.
+   */
+  T *Find(const char *address) const {
+    const Node *node = Lookup(address, strlen(address));
+    return node ? node->value : NULL;
+  }
+
+  /**
+   * Find the value for the parent of an address, i.e. everything before the
+   * last '/'.
+   * @param address the address to look up.
+   * @param[out] leaf set to the last component of the address.
+   */
+  T *FindParent(const char *address, const char **leaf) const {
+    const char *separator = strrchr(address, '/');
+    if (!separator) {
+      return NULL;
+    }
+    const Node *node = Lookup(address, separator - address);
+    if (!node || !node->value) {
+      return NULL;
+    }
+    *leaf = separator + 1;
+    return node->value;
+  }
+
+ private:
+  struct Node {
+    explicit Node(const std::string &component)
+        : component(component),
+          value(NULL) {
+    }
+
+    ~Node() {
+      typename std::vector<Node*>::iterator iter = children.begin();
+      for (; iter != children.end(); ++iter) {
+        delete *iter;
+      }
+    }
+
+    Node *Child(const char *name, size_t length) const {
+      typename std::vector<Node*>::const_iterator iter = children.begin();
+      for (; iter != children.end(); ++iter) {
+        if ((*iter)->component.size() == length &&
+            (*iter)->component.compare(0, length, name, length) == 0) {
+          return *iter;
+        }
+      }
+      return NULL;
+    }
+
+    const std::string component;
+    T *value;
+    std::vector<Node*> children;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Node);
+  };
+
+  Node m_root;
+
+  Node *Lookup(const char *address, size_t length) const {
+    const Node *node = &m_root;
+    const char *component = address;
+    const char *end = address + length;
+    while (node) {
+      const char *separator = FindSeparator(component, end);
+      node = node->Child(component, separator - component);
+      if (separator == end) {
+        break;
+      }
+      component = separator + 1;
+    }
+    return const_cast<Node*>(node);
+  }
+
+  static const char *FindSeparator(const char *start, const char *end) {
+    const char *separator = start;
+    while (separator != end && *separator != '/') {
+      separator++;
+    }
+    return separator;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(OSCAddressTrie);
+};
+}  // namespace osc
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_OSC_OSCADDRESSTRIE_H_
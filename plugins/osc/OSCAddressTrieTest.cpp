@@ -0,0 +1,91 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OSCAddressTrieTest.cpp
+ * Test fixture for the OSCAddressTrie class.
+ * Copyright (C) 2012 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/testing/TestUtils.h"
+#include "plugins/osc/OSCAddressTrie.h"
+
+using ola::plugin::osc::OSCAddressTrie;
+using std::string;
+
+class OSCAddressTrieTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OSCAddressTrieTest);
+  CPPUNIT_TEST(testFind);
+  CPPUNIT_TEST(testFindParent);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testFind();
+    void testFindParent();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OSCAddressTrieTest);
+
+/**
+ * Check that Insert(), Find() and Remove() work.
+ */
+void OSCAddressTrieTest::testFind() {
+  int universe1 = 1, universe2 = 2;
+  OSCAddressTrie<int> trie;
+
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe/1"));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/1", &universe1));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/2", &universe2));
+  OLA_ASSERT_FALSE(trie.Insert("/dmx/universe/1", &universe2));
+
+  OLA_ASSERT_EQ(&universe1, trie.Find("/dmx/universe/1"));
+  OLA_ASSERT_EQ(&universe2, trie.Find("/dmx/universe/2"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe/10"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe/1/1"));
+  OLA_ASSERT_NULL(trie.Find("dmx/universe/1"));
+  OLA_ASSERT_NULL(trie.Find(""));
+
+  OLA_ASSERT_EQ(&universe1, trie.Remove("/dmx/universe/1"));
+  OLA_ASSERT_NULL(trie.Remove("/dmx/universe/1"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe/1"));
+  OLA_ASSERT_EQ(&universe2, trie.Find("/dmx/universe/2"));
+
+  // An address can be registered again once it's removed.
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/1", &universe2));
+  OLA_ASSERT_EQ(&universe2, trie.Find("/dmx/universe/1"));
+}
+
+/**
+ * Check that FindParent() works.
+ */
+void OSCAddressTrieTest::testFindParent() {
+  int universe = 1;
+  OSCAddressTrie<int> trie;
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/1", &universe));
+
+  const char *leaf = NULL;
+  OLA_ASSERT_EQ(&universe, trie.FindParent("/dmx/universe/1/512", &leaf));
+  OLA_ASSERT_EQ(string("512"), string(leaf));
+  OLA_ASSERT_EQ(&universe, trie.FindParent("/dmx/universe/1/", &leaf));
+  OLA_ASSERT_EQ(string(""), string(leaf));
+
+  OLA_ASSERT_NULL(trie.FindParent("/dmx/universe/1", &leaf));
+  OLA_ASSERT_NULL(trie.FindParent("/dmx/universe/2/1", &leaf));
+  OLA_ASSERT_NULL(trie.FindParent("/dmx/universe/1/1/1", &leaf));
+  OLA_ASSERT_NULL(trie.FindParent("1", &leaf));
+}
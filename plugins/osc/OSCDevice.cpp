@@ -39,25 +39,23 @@ const char OSCDevice::DEVICE_NAME[] = "OSC Device";
  * Constructor for the OSCDevice
  * @param owner the plugin which created this device
  * @param plugin_adaptor a pointer to a PluginAdaptor object
- * @param udp_port the UDP port to listen on
+ * @param node_options the options for the OSCNode
  * @param addresses a list of strings to use as OSC addresses for the input
  *   ports.
  * @param port_configs config to use for the ports
  */
 OSCDevice::OSCDevice(AbstractPlugin *owner,
                      PluginAdaptor *plugin_adaptor,
-                     uint16_t udp_port,
+                     const OSCNode::OSCNodeOptions &node_options,
                      const vector<string> &addresses,
                      const PortConfigs &port_configs)
     : Device(owner, DEVICE_NAME),
       m_plugin_adaptor(plugin_adaptor),
       m_port_addresses(addresses),
       m_port_configs(port_configs) {
-  OSCNode::OSCNodeOptions options;
-  options.listen_port = udp_port;
   // allocate a new OSCNode but delay the call to Init() until later
   m_osc_node.reset(new OSCNode(plugin_adaptor, plugin_adaptor->GetExportMap(),
-                               options));
+                               node_options));
 }
 
 /*
@@ -20,13 +20,19 @@
 
 #ifdef _WIN32
 #include <ola/win/CleanWinSock2.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
 #endif  // _WIN32
 
+#include <errno.h>
+#include <string.h>
 #include <ola/Callback.h>
 #include <ola/Constants.h>
 #include <ola/ExportMap.h>
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
+#include <ola/network/NetworkUtils.h>
 #include <ola/stl/STLUtils.h>
 #include <algorithm>
 #include <string>
@@ -55,6 +61,7 @@ class UnmanagedSocketDescriptor : public ola::io::UnmanagedFileDescriptor {
 
 using ola::IntToString;
 using ola::io::SelectServerInterface;
+using ola::network::HostToNetwork;
 using std::make_pair;
 using std::max;
 using std::min;
@@ -79,31 +86,14 @@ void OSCErrorHandler(int error_code, const char *msg, const char *stack) {
 }
 
 
-/**
- * Extract the slot number and group address from an OSC address
- */
-bool ExtractSlotFromPath(const string &osc_address,
-                         string *group_address,
-                         uint16_t *slot) {
-  size_t pos = osc_address.find_last_of("/");
-  if (pos == string::npos) {
-    OLA_WARN << "Got invalid OSC message to " << osc_address;
-    return false;
-  }
-  if (!StringToInt(osc_address.substr(pos + 1), slot, true)) {
-    OLA_WARN << "Unable to extract slot from " << osc_address.substr(pos + 1);
-    return false;
-  }
-
-  if (*slot == 0 || *slot > DMX_UNIVERSE_SIZE) {
-    OLA_WARN << "Ignoring slot " << *slot;
-    return 0;
-  }
-  (*slot)--;
+// A bundle with an immediate time tag.
+static const uint8_t BUNDLE_HEADER[] = {
+  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+  0, 0, 0, 0, 0, 0, 0, 1
+};
 
-  *group_address = osc_address.substr(0, pos);
-  return true;
-}
+static const char INT_TYPE_TAG[] = {',', 'i', 0, 0};
+static const char FLOAT_TYPE_TAG[] = {',', 'f', 0, 0};
 
 /**
  * Extract the slot and value from a tuple (either ii or if)
@@ -158,19 +148,11 @@ int OSCDataHandler(const char *osc_address, const char *types, lo_arg **argv,
       return 0;
     } else if (type == "f") {
       float val = max(0.0f, min(1.0f, argv[0]->f));
-      string group_address;
-      if (!ExtractSlotFromPath(osc_address, &group_address, &slot))
-        return 0;
-
-      node->SetSlot(group_address, slot,  val * DMX_MAX_SLOT_VALUE);
+      node->SetSlotFromPath(osc_address, val * DMX_MAX_SLOT_VALUE);
       return 0;
     } else if (type == "i") {
       int val = min(static_cast<int>(DMX_MAX_SLOT_VALUE), max(0, argv[0]->i));
-      string group_address;
-      if (!ExtractSlotFromPath(osc_address, &group_address, &slot))
-        return 0;
-
-      node->SetSlot(group_address, slot,  val);
+      node->SetSlotFromPath(osc_address, val);
       return 0;
     }
   } else if (argc == 2) {
@@ -199,6 +181,19 @@ OSCNode::NodeOSCTarget::~NodeOSCTarget() {
   lo_address_free(liblo_address);
 }
 
+/**
+ * The address is stored as it appears on the wire, NULL padded to a multiple
+ * of 4 bytes.
+ */
+const string &OSCNode::NodeOSCTarget::SlotAddress(unsigned int slot) {
+  for (unsigned int i = slot_addresses.size(); i <= slot; i++) {
+    string address = osc_address + "/" + IntToString(i + 1);
+    address.append(4 - address.size() % 4, '\0');
+    slot_addresses.push_back(address);
+  }
+  return slot_addresses[slot];
+}
+
 
 /**
  * Create a new OSCNode.
@@ -211,6 +206,7 @@ OSCNode::OSCNode(SelectServerInterface *ss,
                  const OSCNodeOptions &options)
     : m_ss(ss),
       m_listen_port(options.listen_port),
+      m_use_bundles(options.use_bundles),
       m_osc_server(NULL) {
   if (export_map) {
     // export the OSC listening port if we have an export map
@@ -285,6 +281,10 @@ void OSCNode::Stop() {
   m_output_map.clear();
 
   // Delete all the RX callbacks.
+  InputUniverseMap::iterator input_iter = m_input_map.begin();
+  for (; input_iter != m_input_map.end(); ++input_iter) {
+    m_input_trie.Remove(input_iter->first);
+  }
   STLDeleteValues(&m_input_map);
 
   if (m_descriptor.get()) {
@@ -417,12 +417,14 @@ bool OSCNode::RegisterAddress(const string &osc_address,
       return false;
     } else {
       // This is a new registration, insert into the AddressCallbackMap and
-      // register with liblo.
-      m_input_map.insert(
-          make_pair(osc_address, new OSCInputGroup(callback)));
+      // the trie used for dispatching.
+      universe_data = new OSCInputGroup(callback);
+      m_input_map.insert(make_pair(osc_address, universe_data));
+      m_input_trie.Insert(osc_address, universe_data);
     }
   } else {
     // deregister
+    m_input_trie.Remove(osc_address);
     STLRemoveAndDelete(&m_input_map, osc_address);
   }
   return true;
@@ -435,9 +437,9 @@ bool OSCNode::RegisterAddress(const string &osc_address,
  * @param data the DmxBuffer containing the data.
  * @param size the number of slots.
  */
-void OSCNode::SetUniverse(const string &osc_address, const uint8_t *data,
+void OSCNode::SetUniverse(const char *osc_address, const uint8_t *data,
                           unsigned int size) {
-  OSCInputGroup *universe_data = STLFindOrNull(m_input_map, osc_address);
+  OSCInputGroup *universe_data = m_input_trie.Find(osc_address);
   if (!universe_data)
     return;
 
@@ -453,8 +455,8 @@ void OSCNode::SetUniverse(const string &osc_address, const uint8_t *data,
  * @param slot the slot offset to set.
  * @param value the DMX value for the slot
  */
-void OSCNode::SetSlot(const string &osc_address, uint16_t slot, uint8_t value) {
-  OSCInputGroup *universe_data = STLFindOrNull(m_input_map, osc_address);
+void OSCNode::SetSlot(const char *osc_address, uint16_t slot, uint8_t value) {
+  OSCInputGroup *universe_data = m_input_trie.Find(osc_address);
   if (!universe_data)
     return;
 
@@ -465,6 +467,31 @@ void OSCNode::SetSlot(const string &osc_address, uint16_t slot, uint8_t value) {
   }
 }
 
+/**
+ * Called by OSCDataHandler when there is new data for a single slot, where
+ * the slot number is the last component of the address, e.g. /dmx/1/10.
+ * @param osc_address the OSC address this data arrived on
+ * @param value the DMX value for the slot
+ */
+void OSCNode::SetSlotFromPath(const char *osc_address, uint8_t value) {
+  const char *leaf = NULL;
+  OSCInputGroup *universe_data = m_input_trie.FindParent(osc_address, &leaf);
+  if (!universe_data)
+    return;
+
+  uint16_t slot;
+  if (!ParseSlot(leaf, &slot)) {
+    OLA_WARN << "Unable to extract slot from " << osc_address;
+    return;
+  }
+
+  universe_data->dmx.SetChannel(slot, value);
+
+  if (universe_data->callback.get()) {
+    universe_data->callback->Run(universe_data->dmx);
+  }
+}
+
 
 /**
  * Return the listening port. Will be 0 if the node isn't setup.
@@ -477,6 +504,19 @@ uint16_t OSCNode::ListeningPort() const {
 }
 
 
+/**
+ * Pass a packet to liblo's dispatcher, this is the same path a packet read
+ * from the socket takes.
+ */
+bool OSCNode::HandleData(const uint8_t *data, unsigned int length) {
+  if (!m_osc_server) {
+    return false;
+  }
+  return lo_server_dispatch_data(m_osc_server,
+                                 const_cast<uint8_t*>(data), length) >= 0;
+}
+
+
 /**
  * Called when the OSC FD is readable.
  */
@@ -587,55 +627,155 @@ bool OSCNode::SendMessageToTargets(lo_message message,
  * @param dmx_data the DmxBuffer to send
  * @param group the OSCOutputGroup with the targets.
  * @param osc_type the type of OSC message, either "i" or "f"
+ *
+ * The messages are simple enough that we build them ourselves, rather than
+ * allocating an lo_message per slot, and the slot addresses are rendered once
+ * per target.
  */
 bool OSCNode::SendIndividualMessages(const DmxBuffer &dmx_data,
                                      OSCOutputGroup *group,
                                      const string &osc_type) {
   bool ok = true;
   const OSCTargetVector &targets = group->targets;
+  const char *type_tag = osc_type == "i" ? INT_TYPE_TAG : FLOAT_TYPE_TAG;
 
   vector<SlotMessage> messages;
 
   // We only send the slots that have changed.
   for (unsigned int i = 0; i < dmx_data.Size(); ++i) {
-    if (i > group->dmx.Size() || dmx_data.Get(i) != group->dmx.Get(i)) {
-      SlotMessage message = {i, lo_message_new()};
+    if (i >= group->dmx.Size() || dmx_data.Get(i) != group->dmx.Get(i)) {
+      SlotMessage message;
+      message.slot = i;
       if (osc_type == "i") {
-        lo_message_add_int32(message.message, dmx_data.Get(i));
+        message.value = HostToNetwork(static_cast<uint32_t>(dmx_data.Get(i)));
       } else {
-        lo_message_add_float(message.message, dmx_data.Get(i) / 255.0f);
+        float value = dmx_data.Get(i) / 255.0f;
+        uint32_t raw_value;
+        memcpy(&raw_value, &value, sizeof(raw_value));
+        message.value = HostToNetwork(raw_value);
       }
       messages.push_back(message);
     }
   }
   group->dmx.Set(dmx_data);
 
+  if (messages.empty()) {
+    return true;
+  }
+
   // Send all messages to each target.
   OSCTargetVector::const_iterator target_iter = targets.begin();
   for (; target_iter != targets.end(); ++target_iter) {
     OLA_DEBUG << "Sending to " << (*target_iter)->socket_address;
+    ok &= SendSlotMessages(*target_iter, type_tag, messages);
+  }
+  return ok;
+}
+
+/**
+ * Send a set of slot messages to a target. If bundles are enabled the
+ * messages are packed into as few bundles as possible, otherwise each
+ * message is sent in its own packet.
+ */
+bool OSCNode::SendSlotMessages(NodeOSCTarget *target, const char *type_tag,
+                               const vector<SlotMessage> &messages) {
+  bool ok = true;
+  m_packet.clear();
+
+  vector<SlotMessage>::const_iterator iter = messages.begin();
+  for (; iter != messages.end(); ++iter) {
+    const string &address = target->SlotAddress(iter->slot);
+
+    if (m_use_bundles) {
+      const uint32_t message_size = address.size() + TYPE_TAG_SIZE +
+                                    sizeof(iter->value);
+      if (m_packet.size() > sizeof(BUNDLE_HEADER) &&
+          m_packet.size() + sizeof(message_size) + message_size >
+            MAX_BUNDLE_SIZE) {
+        ok &= SendPacket(*target);
+        m_packet.clear();
+      }
+      if (m_packet.empty()) {
+        AppendToPacket(BUNDLE_HEADER, sizeof(BUNDLE_HEADER));
+      }
+      const uint32_t element_size = HostToNetwork(message_size);
+      AppendToPacket(&element_size, sizeof(element_size));
+    }
 
-    vector<SlotMessage>::const_iterator message_iter = messages.begin();
-    for (; message_iter != messages.end(); ++message_iter) {
-      std::ostringstream path;
-      path << (*target_iter)->osc_address << "/" << message_iter->slot + 1;
+    AppendToPacket(address.data(), address.size());
+    AppendToPacket(type_tag, TYPE_TAG_SIZE);
+    AppendToPacket(&iter->value, sizeof(iter->value));
 
-      int ret = lo_send_message_from((*target_iter)->liblo_address,
-                                     m_osc_server,
-                                     path.str().c_str(),
-                                     message_iter->message);
-      ok &= (ret > 0);
+    if (!m_use_bundles) {
+      ok &= SendPacket(*target);
+      m_packet.clear();
     }
   }
 
-  // Clean up the messages.
-  vector<SlotMessage>::iterator message_iter = messages.begin();
-  for (; message_iter != messages.end(); ++message_iter) {
-    lo_message_free(message_iter->message);
+  if (!m_packet.empty()) {
+    ok &= SendPacket(*target);
   }
-
   return ok;
 }
+
+void OSCNode::AppendToPacket(const void *data, unsigned int length) {
+  const uint8_t *ptr = reinterpret_cast<const uint8_t*>(data);
+  m_packet.insert(m_packet.end(), ptr, ptr + length);
+}
+
+/**
+ * Send the contents of m_packet to a target. This uses liblo's socket so the
+ * source port is the same as for the other formats.
+ */
+bool OSCNode::SendPacket(const NodeOSCTarget &target) {
+  if (!m_osc_server) {
+    return false;
+  }
+
+  struct sockaddr_in destination;
+  if (!target.socket_address.ToSockAddr(
+          reinterpret_cast<struct sockaddr*>(&destination),
+          sizeof(destination))) {
+    return false;
+  }
+
+  ssize_t bytes_sent = sendto(
+      lo_server_get_socket_fd(m_osc_server),
+      reinterpret_cast<const char*>(&m_packet[0]),
+      m_packet.size(),
+      0,
+      reinterpret_cast<const struct sockaddr*>(&destination),
+      sizeof(destination));
+  if (bytes_sent < 0 ||
+      static_cast<size_t>(bytes_sent) != m_packet.size()) {
+    OLA_INFO << "Failed to send OSC to " << target.socket_address << ": "
+             << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Parse a slot number from the last component of an address.
+ * @param str the slot number, 1 - 512.
+ * @param[out] slot the slot offset, 0 - 511.
+ */
+bool OSCNode::ParseSlot(const char *str, uint16_t *slot) {
+  unsigned int value = 0;
+  const char *ptr = str;
+  for (; *ptr; ptr++) {
+    if (*ptr < '0' || *ptr > '9' || value > DMX_UNIVERSE_SIZE) {
+      return false;
+    }
+    value = value * 10 + (*ptr - '0');
+  }
+
+  if (ptr == str || value == 0 || value > DMX_UNIVERSE_SIZE) {
+    return false;
+  }
+  *slot = value - 1;
+  return true;
+}
 }  // namespace osc
 }  // namespace plugin
 }  // namespace ola
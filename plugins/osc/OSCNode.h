@@ -33,6 +33,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "plugins/osc/OSCAddressTrie.h"
 #include "plugins/osc/OSCTarget.h"
 
 namespace ola {
@@ -81,8 +82,14 @@ class OSCNode {
   // The options for the OSCNode object.
   struct OSCNodeOptions {
     uint16_t listen_port;  // UDP port to listen on
+    // Send the individual formats as a bundle per target, rather than one
+    // packet per slot.
+    bool use_bundles;
 
-    OSCNodeOptions() : listen_port(DEFAULT_OSC_PORT) {}
+    OSCNodeOptions()
+        : listen_port(DEFAULT_OSC_PORT),
+          use_bundles(true) {
+    }
   };
 
   // The callback run when we receive new DMX data.
@@ -106,13 +113,18 @@ class OSCNode {
   bool RegisterAddress(const std::string &osc_address, DMXCallback *callback);
 
   // Called by the liblo handlers.
-  void SetUniverse(const std::string &osc_address, const uint8_t *data,
+  void SetUniverse(const char *osc_address, const uint8_t *data,
                    unsigned int size);
-  void SetSlot(const std::string &osc_address, uint16_t slot, uint8_t value);
+  void SetSlot(const char *osc_address, uint16_t slot, uint8_t value);
+  void SetSlotFromPath(const char *osc_address, uint8_t value);
 
   // The port OSC is listening on.
   uint16_t ListeningPort() const;
 
+  // Process an OSC packet as if it had been received on the socket. This
+  // allows the message handling to be benchmarked in-process.
+  bool HandleData(const uint8_t *data, unsigned int length);
+
  private:
   class NodeOSCTarget {
    public:
@@ -129,9 +141,14 @@ class OSCNode {
               osc_address == other.osc_address);
     }
 
+    // Return the address for a slot, i.e. osc_address/<slot + 1>.
+    const std::string &SlotAddress(unsigned int slot);
+
     ola::network::IPV4SocketAddress socket_address;
     std::string osc_address;
     lo_address liblo_address;
+    // The rendered slot addresses, built as slots are first sent.
+    std::vector<std::string> slot_addresses;
 
    private:
     DISALLOW_COPY_AND_ASSIGN(NodeOSCTarget);
@@ -153,18 +170,23 @@ class OSCNode {
 
   typedef std::map<unsigned int, OSCOutputGroup*> OutputGroupMap;
   typedef std::map<std::string, OSCInputGroup*> InputUniverseMap;
+  typedef OSCAddressTrie<OSCInputGroup> InputUniverseTrie;
 
   struct SlotMessage {
     unsigned int slot;
-    lo_message message;
+    uint32_t value;  // the int32 or float32 argument, in network byte order
   };
 
   ola::io::SelectServerInterface *m_ss;
   const uint16_t m_listen_port;
+  const bool m_use_bundles;
   std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_descriptor;
   lo_server m_osc_server;
   OutputGroupMap m_output_map;
   InputUniverseMap m_input_map;
+  // Used to dispatch received messages, the map owns the groups.
+  InputUniverseTrie m_input_trie;
+  std::vector<uint8_t> m_packet;
 
   void DescriptorReady();
   bool SendBlob(const DmxBuffer &data, const OSCTargetVector &targets);
@@ -181,8 +203,17 @@ class OSCNode {
   bool SendIndividualMessages(const DmxBuffer &data,
                               OSCOutputGroup *group,
                               const std::string &osc_type);
+  bool SendSlotMessages(NodeOSCTarget *target, const char *type_tag,
+                        const std::vector<SlotMessage> &messages);
+  void AppendToPacket(const void *data, unsigned int length);
+  bool SendPacket(const NodeOSCTarget &target);
+
+  static bool ParseSlot(const char *str, uint16_t *slot);
 
   static const uint16_t DEFAULT_OSC_PORT = 7770;
+  // Keep bundles to something that won't be fragmented too badly.
+  static const size_t MAX_BUNDLE_SIZE = 8192;
+  static const unsigned int TYPE_TAG_SIZE = 4;
   static const char OSC_PORT_VARIABLE[];
 };
 }  // namespace osc
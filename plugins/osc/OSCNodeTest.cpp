@@ -50,6 +50,7 @@ using std::auto_ptr;
 class OSCNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OSCNodeTest);
   CPPUNIT_TEST(testSendBlob);
+  CPPUNIT_TEST(testSendIndividualInts);
   CPPUNIT_TEST(testReceive);
   CPPUNIT_TEST_SUITE_END();
 
@@ -59,7 +60,9 @@ class OSCNodeTest: public CppUnit::TestFixture {
      */
     OSCNodeTest()
         : CppUnit::TestFixture(),
-          m_timeout_id(ola::thread::INVALID_TIMEOUT) {
+          m_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_expected_packet(NULL),
+      m_expected_packet_size(0) {
       OSCNode::OSCNodeOptions options;
       options.listen_port = 0;
       m_osc_node.reset(new OSCNode(&m_ss, NULL, options));
@@ -72,6 +75,7 @@ class OSCNodeTest: public CppUnit::TestFixture {
 
     // our two tests
     void testSendBlob();
+    void testSendIndividualInts();
     void testReceive();
 
     // Called if we don't receive data in ABORT_TIMEOUT_IN_MS
@@ -84,7 +88,10 @@ class OSCNodeTest: public CppUnit::TestFixture {
     ola::thread::timeout_id m_timeout_id;
     DmxBuffer m_dmx_data;
     DmxBuffer m_received_data;
+    const uint8_t *m_expected_packet;
+    unsigned int m_expected_packet_size;
 
+    void BindTestSocket(IPV4SocketAddress *socket_address);
     void UDPSocketReady();
     void DMXHandler(const DmxBuffer &dmx);
 
@@ -92,6 +99,8 @@ class OSCNodeTest: public CppUnit::TestFixture {
     // The number of mseconds to wait before failing the test.
     static const int ABORT_TIMEOUT_IN_MS = 2000;
     static const uint8_t OSC_BLOB_DATA[];
+    static const uint8_t OSC_INT_BUNDLE_DATA[];
+    static const uint8_t OSC_INT_BUNDLE_UPDATE_DATA[];
     static const uint8_t OSC_SINGLE_FLOAT_DATA[];
     static const uint8_t OSC_SINGLE_INT_DATA[];
     static const uint8_t OSC_INT_TUPLE_DATA[];
@@ -116,6 +125,48 @@ const uint8_t OSCNodeTest::OSC_BLOB_DATA[] = {
   8, 9, 0xa, 0
 };
 
+// A bundle of individual int messages for slots 1 - 3
+const uint8_t OSCNodeTest::OSC_INT_BUNDLE_DATA[] = {
+  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+  // time tag
+  0, 0, 0, 0, 0, 0, 0, 1,
+  // slot 1
+  0, 0, 0, 32,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '1', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 10,
+  // slot 2
+  0, 0, 0, 32,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '2', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 20,
+  // slot 3
+  0, 0, 0, 32,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '3', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 30
+};
+
+// The bundle sent when only slot 2 changes
+const uint8_t OSCNodeTest::OSC_INT_BUNDLE_UPDATE_DATA[] = {
+  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+  // time tag
+  0, 0, 0, 0, 0, 0, 0, 1,
+  // slot 2
+  0, 0, 0, 32,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '2', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 25
+};
+
 // An OSC single float packet for slot 1
 const uint8_t OSCNodeTest::OSC_SINGLE_FLOAT_DATA[] = {
   // osc address
@@ -199,7 +250,8 @@ void OSCNodeTest::UDPSocketReady() {
   // Read the received packet into 'data'.
   OLA_ASSERT_TRUE(m_udp_socket.RecvFrom(data, &data_read));
   // Verify it matches the expected packet
-  OLA_ASSERT_DATA_EQUALS(OSC_BLOB_DATA, sizeof(OSC_BLOB_DATA), data, data_read);
+  OLA_ASSERT_DATA_EQUALS(m_expected_packet, m_expected_packet_size, data,
+                         data_read);
   // Stop the SelectServer
   m_ss.Terminate();
 }
@@ -215,19 +267,31 @@ void OSCNodeTest::DMXHandler(const DmxBuffer &dmx) {
 
 
 /**
- * Check that we send OSC messages correctly.
+ * Bind the test socket to a local port and start listening for packets.
+ * @param[out] socket_address the address the socket is bound to.
  */
-void OSCNodeTest::testSendBlob() {
-  // First up create a UDP socket to receive the messages on.
+void OSCNodeTest::BindTestSocket(IPV4SocketAddress *socket_address) {
   // Port 0 means 'ANY'
-  IPV4SocketAddress socket_address(IPV4Address::Loopback(), 0);
+  *socket_address = IPV4SocketAddress(IPV4Address::Loopback(), 0);
   // Bind the socket, set the callback, and register with the select server.
-  OLA_ASSERT_TRUE(m_udp_socket.Bind(socket_address));
+  OLA_ASSERT_TRUE(m_udp_socket.Bind(*socket_address));
   m_udp_socket.SetOnData(NewCallback(this, &OSCNodeTest::UDPSocketReady));
   OLA_ASSERT_TRUE(m_ss.AddReadDescriptor(&m_udp_socket));
   // Store the local address of the UDP socket so we know where to tell the
   // OSCNode to send to.
-  OLA_ASSERT_TRUE(m_udp_socket.GetSocketAddress(&socket_address));
+  OLA_ASSERT_TRUE(m_udp_socket.GetSocketAddress(socket_address));
+}
+
+
+/**
+ * Check that we send OSC messages correctly.
+ */
+void OSCNodeTest::testSendBlob() {
+  // First up create a UDP socket to receive the messages on.
+  IPV4SocketAddress socket_address;
+  BindTestSocket(&socket_address);
+  m_expected_packet = OSC_BLOB_DATA;
+  m_expected_packet_size = sizeof(OSC_BLOB_DATA);
 
   // Setup the OSCTarget pointing to the local socket address
   OSCTarget target(socket_address, TEST_OSC_ADDRESS);
@@ -251,6 +315,36 @@ void OSCNodeTest::testSendBlob() {
 }
 
 
+/**
+ * Check that the individual formats are sent as a single bundle, containing
+ * only the slots that changed.
+ */
+void OSCNodeTest::testSendIndividualInts() {
+  IPV4SocketAddress socket_address;
+  BindTestSocket(&socket_address);
+
+  OSCTarget target(socket_address, TEST_OSC_ADDRESS);
+  m_osc_node->AddTarget(TEST_GROUP, target);
+
+  DmxBuffer dmx;
+  dmx.SetFromString("10,20,30");
+  m_expected_packet = OSC_INT_BUNDLE_DATA;
+  m_expected_packet_size = sizeof(OSC_INT_BUNDLE_DATA);
+  OLA_ASSERT_TRUE(m_osc_node->SendData(TEST_GROUP,
+                                       OSCNode::FORMAT_INT_INDIVIDUAL, dmx));
+  m_ss.Run();
+
+  dmx.SetChannel(1, 25);
+  m_expected_packet = OSC_INT_BUNDLE_UPDATE_DATA;
+  m_expected_packet_size = sizeof(OSC_INT_BUNDLE_UPDATE_DATA);
+  OLA_ASSERT_TRUE(m_osc_node->SendData(TEST_GROUP,
+                                       OSCNode::FORMAT_INT_INDIVIDUAL, dmx));
+  m_ss.Run();
+
+  OLA_ASSERT_TRUE(m_osc_node->RemoveTarget(TEST_GROUP, target));
+}
+
+
 /**
  * Check that we receive OSC messages correctly.
  */
@@ -54,6 +54,7 @@ const char OSCPlugin::PORT_ADDRESS_TEMPLATE[] = "port_%d_address";
 const char OSCPlugin::PORT_TARGETS_TEMPLATE[] = "port_%d_targets";
 const char OSCPlugin::PORT_FORMAT_TEMPLATE[] = "port_%d_output_format";
 const char OSCPlugin::UDP_PORT_KEY[] = "udp_listen_port";
+const char OSCPlugin::USE_BUNDLES_KEY[] = "use_bundles";
 
 const char OSCPlugin::BLOB_FORMAT[] = "blob";
 const char OSCPlugin::FLOAT_ARRAY_FORMAT[] = "float_array";
@@ -66,9 +67,11 @@ const char OSCPlugin::INT_INDIVIDUAL_FORMAT[] = "individual_int";
  */
 bool OSCPlugin::StartHook() {
   // Get the value of UDP_PORT_KEY or use the default value if it isn't valid.
-  uint16_t udp_port = StringToIntOrDefault(
+  OSCNode::OSCNodeOptions node_options;
+  node_options.listen_port = StringToIntOrDefault(
       m_preferences->GetValue(UDP_PORT_KEY),
       DEFAULT_UDP_PORT);
+  node_options.use_bundles = m_preferences->GetValueAsBool(USE_BUNDLES_KEY);
 
   // For each input port, add the address to the vector
   vector<string> port_addresses;
@@ -103,7 +106,7 @@ bool OSCPlugin::StartHook() {
 
   // Finally create the new OSCDevice, start it and register the device.
   std::auto_ptr<OSCDevice> device(
-    new OSCDevice(this, m_plugin_adaptor, udp_port, port_addresses,
+    new OSCDevice(this, m_plugin_adaptor, node_options, port_addresses,
                   port_configs));
   if (!device->Start()) {
     return false;
@@ -156,6 +159,9 @@ bool OSCPlugin::SetDefaultPreferences() {
                                          UIntValidator(1, UINT16_MAX),
                                          DEFAULT_UDP_PORT);
 
+  save |= m_preferences->SetDefaultValue(USE_BUNDLES_KEY, BoolValidator(),
+                                         true);
+
   for (unsigned int i = 0; i < GetPortCount(INPUT_PORT_COUNT_KEY); i++) {
     const string key = ExpandTemplate(PORT_ADDRESS_TEMPLATE, i);
     save |= m_preferences->SetDefaultValue(key, StringValidator(),
@@ -68,6 +68,7 @@ class OSCPlugin: public ola::Plugin {
     static const char PORT_TARGETS_TEMPLATE[];
     static const char PORT_FORMAT_TEMPLATE[];
     static const char UDP_PORT_KEY[];
+    static const char USE_BUNDLES_KEY[];
 
     static const char BLOB_FORMAT[];
     static const char FLOAT_ARRAY_FORMAT[];
@@ -0,0 +1,1390 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * parser_benchmark.cpp
+ * Replay captured or synthetic traffic through the input parsers of the
+ * network plugins.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/IOVecInterface.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Interface.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/util/Utils.h"
+
+#ifdef USE_ARTNET
+#include "plugins/artnet/ArtNetNode.h"
+#endif  // USE_ARTNET
+#ifdef USE_E131
+#include "ola/acn/ACNPort.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/RootInflator.h"
+#include "libs/acn/UDPTransport.h"
+#endif  // USE_E131
+#ifdef USE_ESPNET
+#include "plugins/espnet/EspNetNode.h"
+#endif  // USE_ESPNET
+#ifdef USE_KINET
+#include "plugins/kinet/KiNetNode.h"
+#endif  // USE_KINET
+#ifdef USE_OPENPIXELCONTROL
+#include "plugins/openpixelcontrol/OPCServer.h"
+#endif  // USE_OPENPIXELCONTROL
+#ifdef USE_OSC
+#include "plugins/osc/OSCNode.h"
+#endif  // USE_OSC
+#ifdef USE_SHOWNET
+#include "plugins/shownet/ShowNetNode.h"
+#endif  // USE_SHOWNET
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
+using ola::network::UDPSocketInterface;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::map;
+using std::string;
+using std::vector;
+
+DEFINE_string(pcap, "",
+              "Replay the UDP datagrams from this capture rather than "
+              "synthetic traffic");
+DEFINE_string(protocols, "",
+              "A comma separated list of the protocols to test, defaults to "
+              "all of them");
+DEFINE_s_uint32(packets, p, 200000,
+                "The number of packets to parse for each protocol");
+DEFINE_uint32(universes, 4, "The number of universes in the synthetic traffic");
+DEFINE_default_bool(fuzz, false,
+                    "Corrupt the packets before they're parsed. Warnings are "
+                    "suppressed while fuzzing");
+DEFINE_uint32(seed, 1, "The seed used to corrupt the packets");
+DEFINE_string(baseline, "",
+              "Compare the results with the ones in this file, and exit with "
+              "an error if any protocol is slower or allocates more");
+DEFINE_default_bool(write_baseline, false,
+                    "Write the results to the --baseline file rather than "
+                    "comparing");
+DEFINE_uint32(tolerance, 10,
+              "The percentage a protocol can slow down by before it's "
+              "reported as a regression");
+
+#if __cplusplus >= 201103L
+#define BENCHMARK_THROW_BAD_ALLOC
+#define BENCHMARK_NO_THROW noexcept
+#else
+#define BENCHMARK_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCHMARK_NO_THROW throw()
+#endif  // __cplusplus
+
+/*
+ * Every allocation the process makes is counted, so the allocations made while
+ * parsing can be reported.
+ */
+static uint64_t allocation_count = 0;
+
+void *operator new(size_t size) BENCHMARK_THROW_BAD_ALLOC {
+  allocation_count++;
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) BENCHMARK_THROW_BAD_ALLOC {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) BENCHMARK_NO_THROW {
+  free(ptr);
+}
+
+void operator delete[](void *ptr) BENCHMARK_NO_THROW {
+  free(ptr);
+}
+
+
+/**
+ * A datagram to replay.
+ */
+struct Datagram {
+  IPV4SocketAddress source;
+  uint16_t destination_port;
+  vector<uint8_t> data;
+
+  Datagram() : destination_port(0) {}
+};
+
+typedef vector<Datagram> DatagramList;
+
+/*
+ * The source of the synthetic traffic. This needs to differ from the address
+ * of the interface the nodes pick, since some of them drop their own packets.
+ */
+static const char SYNTHETIC_SOURCE[] = "10.254.0.1";
+
+// The number of frames of synthetic traffic for each universe.
+static const unsigned int SYNTHETIC_FRAMES = 8;
+
+
+/**
+ * A UDPSocket that reads from a list of datagrams rather than the network.
+ *
+ * Each read returns the next datagram, wrapping around at the end of the
+ * list, so the node under test sees a steady stream of traffic. Sent datagrams
+ * are dropped, unless capture is enabled, which allows the synthetic traffic
+ * for a protocol to be built by the node's own sender.
+ */
+class ReplaySocket: public UDPSocketInterface {
+ public:
+  ReplaySocket()
+      : m_handle(ola::io::INVALID_DESCRIPTOR),
+        m_datagrams(NULL),
+        m_next(0),
+        m_delivered(0),
+        m_capture(false) {
+  }
+  ~ReplaySocket() { Close(); }
+
+  void SetDatagrams(const DatagramList *datagrams) {
+    m_datagrams = datagrams;
+    m_next = 0;
+  }
+
+  uint64_t Delivered() const { return m_delivered; }
+
+  void SetCapture(bool capture) { m_capture = capture; }
+  DatagramList *Sent() { return &m_sent; }
+
+  // The SelectServer needs a real descriptor, it's never read from.
+  bool Init() {
+    if (m_handle == ola::io::INVALID_DESCRIPTOR) {
+      m_handle = socket(PF_INET, SOCK_DGRAM, 0);
+    }
+    return m_handle != ola::io::INVALID_DESCRIPTOR;
+  }
+
+  bool Bind(const IPV4SocketAddress&) { return true; }
+
+  bool GetSocketAddress(IPV4SocketAddress *address) const {
+    *address = IPV4SocketAddress(IPV4Address::WildCard(), 0);
+    return true;
+  }
+
+  bool Close() {
+    if (m_handle != ola::io::INVALID_DESCRIPTOR) {
+      close(m_handle);
+      m_handle = ola::io::INVALID_DESCRIPTOR;
+    }
+    return true;
+  }
+
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_handle; }
+  ola::io::DescriptorHandle WriteDescriptor() const { return m_handle; }
+
+  ssize_t SendTo(const uint8_t *buffer,
+                 unsigned int size,
+                 const IPV4Address &ip,
+                 unsigned short port) const {
+    return SendTo(buffer, size, IPV4SocketAddress(ip, port));
+  }
+
+  ssize_t SendTo(const uint8_t *buffer,
+                 unsigned int size,
+                 const IPV4SocketAddress &dest) const {
+    if (m_capture) {
+      m_sent.push_back(Datagram());
+      m_sent.back().destination_port = dest.Port();
+      m_sent.back().data.assign(buffer, buffer + size);
+    }
+    return size;
+  }
+
+  ssize_t SendTo(ola::io::IOVecInterface *data,
+                 const IPV4Address &ip,
+                 unsigned short port) const {
+    return SendTo(data, IPV4SocketAddress(ip, port));
+  }
+
+  ssize_t SendTo(ola::io::IOVecInterface *data,
+                 const IPV4SocketAddress &dest) const {
+    int io_count;
+    const struct ola::io::IOVec *iov = data->AsIOVec(&io_count);
+    vector<uint8_t> packet;
+    for (int i = 0; i < io_count; i++) {
+      const uint8_t *base = reinterpret_cast<const uint8_t*>(iov[i].iov_base);
+      packet.insert(packet.end(), base, base + iov[i].iov_len);
+    }
+    ola::io::IOVecInterface::FreeIOVec(iov);
+    data->Pop(packet.size());
+    return packet.empty() ? 0 : SendTo(&packet[0], packet.size(), dest);
+  }
+
+  ssize_t SendTo(const ola::io::IOVec *iov,
+                 unsigned int iov_count,
+                 const IPV4SocketAddress &dest) const {
+    vector<uint8_t> packet;
+    for (unsigned int i = 0; i < iov_count; i++) {
+      const uint8_t *base = reinterpret_cast<const uint8_t*>(iov[i].iov_base);
+      packet.insert(packet.end(), base, base + iov[i].iov_len);
+    }
+    return packet.empty() ? 0 : SendTo(&packet[0], packet.size(), dest);
+  }
+
+  bool RecvFrom(uint8_t *buffer, ssize_t *data_read) const {
+    IPV4SocketAddress source;
+    return Next(buffer, data_read, &source);
+  }
+
+  bool RecvFrom(uint8_t *buffer,
+                ssize_t *data_read,
+                IPV4Address &source) const {  // NOLINT(runtime/references)
+    IPV4SocketAddress address;
+    if (!Next(buffer, data_read, &address)) {
+      return false;
+    }
+    source = address.Host();
+    return true;
+  }
+
+  bool RecvFrom(uint8_t *buffer,
+                ssize_t *data_read,
+                IPV4Address &source,  // NOLINT(runtime/references)
+                uint16_t &port) const {  // NOLINT(runtime/references)
+    IPV4SocketAddress address;
+    if (!Next(buffer, data_read, &address)) {
+      return false;
+    }
+    source = address.Host();
+    port = address.Port();
+    return true;
+  }
+
+  bool RecvFrom(uint8_t *buffer,
+                ssize_t *data_read,
+                IPV4SocketAddress *source) {
+    return Next(buffer, data_read, source);
+  }
+
+  // A datagram arrives each time the socket is ready, so only one is read.
+  unsigned int RecvMultiple(UDPDatagram *datagrams, unsigned int count) {
+    if (!count) {
+      return 0;
+    }
+    ssize_t size = datagrams[0].buffer.iov_len;
+    if (!Next(reinterpret_cast<uint8_t*>(datagrams[0].buffer.iov_base),
+              &size, &datagrams[0].address)) {
+      return 0;
+    }
+    datagrams[0].buffer.iov_len = size;
+    datagrams[0].timestamp = TimeStamp();
+    return 1;
+  }
+
+  unsigned int SendMultiple(const UDPDatagram *datagrams,
+                            unsigned int count) const {
+    for (unsigned int i = 0; i < count; i++) {
+      if (datagrams[i].iov) {
+        SendTo(datagrams[i].iov, datagrams[i].iov_count,
+               datagrams[i].address);
+      } else {
+        SendTo(reinterpret_cast<const uint8_t*>(datagrams[i].buffer.iov_base),
+               datagrams[i].buffer.iov_len, datagrams[i].address);
+      }
+    }
+    return count;
+  }
+
+  bool EnableBroadcast() { return true; }
+  bool SetMulticastInterface(const IPV4Address&) { return true; }
+  bool JoinMulticast(const IPV4Address&, const IPV4Address&, bool) {
+    return true;
+  }
+  bool LeaveMulticast(const IPV4Address&, const IPV4Address&) {
+    return true;
+  }
+  bool SetTos(uint8_t) { return true; }
+  bool EnableReceiveTimestamps() { return false; }
+
+ private:
+  ola::io::DescriptorHandle m_handle;
+  const DatagramList *m_datagrams;
+  mutable unsigned int m_next;
+  mutable uint64_t m_delivered;
+  bool m_capture;
+  mutable DatagramList m_sent;
+
+  bool Next(uint8_t *buffer, ssize_t *size, IPV4SocketAddress *source) const {
+    if (!m_datagrams || m_datagrams->empty()) {
+      return false;
+    }
+    const Datagram &datagram = (*m_datagrams)[m_next];
+    m_next = (m_next + 1) % m_datagrams->size();
+    m_delivered++;
+
+    ssize_t length = std::min(static_cast<ssize_t>(datagram.data.size()),
+                              *size);
+    if (length) {
+      memcpy(buffer, &datagram.data[0], length);
+    }
+    *size = length;
+    *source = datagram.source;
+    return true;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ReplaySocket);
+};
+
+
+/**
+ * Build the DMX data for a synthetic frame. Half the universe is a ramp that
+ * moves each frame, the rest is dark.
+ */
+void BuildFrame(unsigned int frame, DmxBuffer *buffer) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    data[i] = i < ola::DMX_UNIVERSE_SIZE / 2 ? (i + frame * 7) & 0xff : 0;
+  }
+  buffer->Set(data, sizeof(data));
+}
+
+
+/**
+ * The base class for the parser under test.
+ */
+class ParserBenchmark {
+ public:
+  ParserBenchmark(const string &name, uint16_t port)
+      : m_name(name),
+        m_port(port),
+        m_frames(0) {
+  }
+  virtual ~ParserBenchmark() {}
+
+  const string &Name() const { return m_name; }
+
+  /**
+   * @brief The UDP port the protocol uses, datagrams sent to this port are
+   * replayed from a capture. 0 if the protocol doesn't use UDP.
+   */
+  uint16_t Port() const { return m_port; }
+
+  /**
+   * @brief The number of frames the parser passed to the handlers.
+   */
+  uint64_t Frames() const { return m_frames; }
+
+  /**
+   * @brief Set up the parser, with a handler for each universe.
+   */
+  virtual bool Setup(unsigned int universes) = 0;
+
+  /**
+   * @brief Build SYNTHETIC_FRAMES frames of traffic for each universe.
+   */
+  virtual void Generate(unsigned int universes, DatagramList *datagrams) = 0;
+
+  /**
+   * @brief Parse at least count packets.
+   * @returns the number of packets parsed.
+   */
+  virtual uint64_t Parse(const DatagramList &datagrams, uint64_t count) = 0;
+
+ protected:
+  ola::Callback0<void> *NewFrameCallback() {
+    return ola::NewCallback(this, &ParserBenchmark::FrameReceived);
+  }
+
+  void FrameReceived() { m_frames++; }
+
+ private:
+  const string m_name;
+  const uint16_t m_port;
+  uint64_t m_frames;
+};
+
+
+/**
+ * A parser that reads from a UDPSocket.
+ */
+class UDPParserBenchmark: public ParserBenchmark {
+ public:
+  UDPParserBenchmark(const string &name, uint16_t port)
+      : ParserBenchmark(name, port),
+        m_socket(NULL) {
+  }
+
+  uint64_t Parse(const DatagramList &datagrams, uint64_t count) {
+    if (datagrams.empty()) {
+      return 0;
+    }
+    m_socket->SetDatagrams(&datagrams);
+    const uint64_t start = m_socket->Delivered();
+    while (m_socket->Delivered() - start < count) {
+      m_socket->PerformRead();
+    }
+    m_socket->SetDatagrams(NULL);
+    return m_socket->Delivered() - start;
+  }
+
+ protected:
+  ReplaySocket *m_socket;
+
+  /**
+   * @brief Move the captured datagrams into the list, as if they were sent
+   * from SYNTHETIC_SOURCE.
+   */
+  void TakeSent(DatagramList *datagrams) {
+    const IPV4SocketAddress source(
+        IPV4Address::FromStringOrDie(SYNTHETIC_SOURCE), Port());
+    DatagramList *sent = m_socket->Sent();
+    for (DatagramList::iterator iter = sent->begin(); iter != sent->end();
+         ++iter) {
+      iter->source = source;
+      datagrams->push_back(*iter);
+    }
+    sent->clear();
+  }
+};
+
+
+/**
+ * Build a synthetic datagram.
+ */
+void AddDatagram(uint16_t port, const vector<uint8_t> &data,
+                 DatagramList *datagrams) {
+  datagrams->push_back(Datagram());
+  datagrams->back().source = IPV4SocketAddress(
+      IPV4Address::FromStringOrDie(SYNTHETIC_SOURCE), port);
+  datagrams->back().destination_port = port;
+  datagrams->back().data = data;
+}
+
+
+#ifdef USE_ARTNET
+/**
+ * ArtDmx packets through the ArtNetNode.
+ */
+class ArtNetBenchmark: public UDPParserBenchmark {
+ public:
+  explicit ArtNetBenchmark(SelectServer *ss)
+      : UDPParserBenchmark("artnet", ARTNET_PORT),
+        m_ss(ss) {
+  }
+
+  ~ArtNetBenchmark() {
+    if (m_node.get()) {
+      m_node->Stop();
+    }
+  }
+
+  bool Setup(unsigned int universes) {
+    ola::network::Interface iface;
+    iface.ip_address = IPV4Address::FromStringOrDie("10.0.0.1");
+    iface.bcast_address = IPV4Address::FromStringOrDie("10.255.255.255");
+    iface.subnet_mask = IPV4Address::FromStringOrDie("255.0.0.0");
+
+    ola::plugin::artnet::ArtNetNodeOptions options;
+    m_socket = new ReplaySocket();
+    m_node.reset(new ola::plugin::artnet::ArtNetNode(iface, m_ss, options,
+                                                     m_socket));
+
+    const unsigned int ports = std::min(
+        universes, static_cast<unsigned int>(options.output_port_count));
+    m_buffers.resize(ports);
+    for (unsigned int i = 0; i < ports; i++) {
+      m_node->SetOutputPortUniverse(i, i);
+      m_node->SetDMXHandler(i, &m_buffers[i], NewFrameCallback());
+    }
+    return m_node->Start();
+  }
+
+  void Generate(unsigned int universes, DatagramList *datagrams) {
+    static const uint8_t header[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0,
+      0x00, 0x50,  // OpDmx, little endian
+      0, 14,  // protocol version
+    };
+
+    uint8_t sequence = 0;
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int universe = 0; universe < universes; universe++) {
+        vector<uint8_t> packet(header, header + sizeof(header));
+        packet.push_back(++sequence);
+        packet.push_back(0);  // physical
+        packet.push_back(universe & 0xff);  // sub-net & universe
+        packet.push_back((universe >> 8) & 0x7f);  // net
+        packet.push_back(buffer.Size() >> 8);
+        packet.push_back(buffer.Size() & 0xff);
+        packet.insert(packet.end(), buffer.GetRaw(),
+                      buffer.GetRaw() + buffer.Size());
+        AddDatagram(ARTNET_PORT, packet, datagrams);
+      }
+    }
+  }
+
+ private:
+  SelectServer *m_ss;
+  auto_ptr<ola::plugin::artnet::ArtNetNode> m_node;
+  vector<DmxBuffer> m_buffers;
+
+  static const uint16_t ARTNET_PORT = 6454;
+};
+#endif  // USE_ARTNET
+
+
+#ifdef USE_E131
+/**
+ * E1.31 data packets through the IncomingUDPTransport and inflators. If
+ * fast_path is false, every packet goes through the full inflator chain.
+ */
+class E131Benchmark: public UDPParserBenchmark {
+ public:
+  explicit E131Benchmark(bool fast_path)
+      : UDPParserBenchmark(fast_path ? "e131" : "e131-inflator",
+                           ola::acn::ACN_PORT),
+        m_fast_path(fast_path),
+        m_dmp_inflator(false),
+        m_priority(0) {
+  }
+
+  bool Setup(unsigned int universes) {
+    m_socket = new ReplaySocket();
+    m_replay_socket.reset(m_socket);
+    if (!m_socket->Init()) {
+      return false;
+    }
+
+    m_root_inflator.AddInflator(&m_e131_inflator);
+    m_root_inflator.AddInflator(&m_e131_rev2_inflator);
+    m_e131_inflator.AddInflator(&m_dmp_inflator);
+    m_e131_rev2_inflator.AddInflator(&m_dmp_inflator);
+
+    m_transport.reset(new ola::acn::IncomingUDPTransport(m_socket,
+                                                         &m_root_inflator));
+    if (m_fast_path) {
+      m_transport->SetFastPath(ola::NewCallback(
+          &m_dmp_inflator, &ola::acn::DMPE131Inflator::HandleDataPacket));
+    }
+    m_socket->SetOnData(ola::NewCallback(
+        m_transport.get(), &ola::acn::IncomingUDPTransport::Receive));
+
+    m_buffers.resize(universes);
+    for (unsigned int i = 0; i < universes; i++) {
+      m_dmp_inflator.SetHandler(i + 1, &m_buffers[i], &m_priority,
+                                NewFrameCallback());
+    }
+    return true;
+  }
+
+  void Generate(unsigned int universes, DatagramList *datagrams) {
+    const ola::acn::CID cid = ola::acn::CID::Generate();
+    vector<ola::acn::E131PacketTemplate> templates(universes);
+    for (unsigned int i = 0; i < universes; i++) {
+      templates[i].Build(cid, "parser_benchmark", i + 1, false,
+                         ola::DMX_UNIVERSE_SIZE);
+    }
+
+    uint8_t sequence = 0;
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int i = 0; i < universes; i++) {
+        templates[i].Update(100, sequence++, false, buffer);
+        vector<uint8_t> packet(templates[i].Data(),
+                               templates[i].Data() + templates[i].Size());
+        AddDatagram(ola::acn::ACN_PORT, packet, datagrams);
+      }
+    }
+  }
+
+ private:
+  const bool m_fast_path;
+  ola::acn::RootInflator m_root_inflator;
+  ola::acn::E131Inflator m_e131_inflator;
+  ola::acn::E131InflatorRev2 m_e131_rev2_inflator;
+  ola::acn::DMPE131Inflator m_dmp_inflator;
+  auto_ptr<ReplaySocket> m_replay_socket;
+  auto_ptr<ola::acn::IncomingUDPTransport> m_transport;
+  vector<DmxBuffer> m_buffers;
+  uint8_t m_priority;
+};
+#endif  // USE_E131
+
+
+#ifdef USE_ESPNET
+/**
+ * EspNet DMX packets through the EspNetNode.
+ */
+class EspNetBenchmark: public UDPParserBenchmark {
+ public:
+  EspNetBenchmark()
+      : UDPParserBenchmark("espnet", ESPNET_PORT) {
+  }
+
+  ~EspNetBenchmark() {
+    if (m_node.get()) {
+      m_node->Stop();
+    }
+  }
+
+  bool Setup(unsigned int universes) {
+    m_socket = new ReplaySocket();
+    m_node.reset(new ola::plugin::espnet::EspNetNode("", m_socket));
+    if (!m_node->Start()) {
+      return false;
+    }
+
+    m_buffers.resize(universes);
+    for (unsigned int i = 0; i < universes; i++) {
+      m_node->SetHandler(i, &m_buffers[i], NewFrameCallback());
+    }
+    return true;
+  }
+
+  void Generate(unsigned int universes, DatagramList *datagrams) {
+    m_socket->SetCapture(true);
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int i = 0; i < universes; i++) {
+        m_node->SendDMX(i, buffer);
+      }
+    }
+    m_socket->SetCapture(false);
+    TakeSent(datagrams);
+  }
+
+ private:
+  auto_ptr<ola::plugin::espnet::EspNetNode> m_node;
+  vector<DmxBuffer> m_buffers;
+
+  static const uint16_t ESPNET_PORT = 3333;
+};
+#endif  // USE_ESPNET
+
+
+#ifdef USE_KINET
+/**
+ * KiNet packets through the KiNetNode. KiNet is output only, so this measures
+ * the per packet overhead of the receive statistics.
+ */
+class KiNetBenchmark: public UDPParserBenchmark {
+ public:
+  explicit KiNetBenchmark(SelectServer *ss)
+      : UDPParserBenchmark("kinet", KINET_PORT),
+        m_ss(ss),
+        m_stats("kinet-benchmark", "source") {
+  }
+
+  ~KiNetBenchmark() {
+    if (m_node.get()) {
+      m_node->Stop();
+    }
+  }
+
+  bool Setup(unsigned int) {
+    m_socket = new ReplaySocket();
+    m_node.reset(new ola::plugin::kinet::KiNetNode(m_ss, m_socket));
+    m_node->SetReceiveStats(&m_stats);
+    return m_node->Start();
+  }
+
+  void Generate(unsigned int universes, DatagramList *datagrams) {
+    const IPV4Address target = IPV4Address::FromStringOrDie("10.0.0.2");
+    m_socket->SetCapture(true);
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int i = 0; i < universes; i++) {
+        m_node->SendDMX(target, buffer);
+      }
+    }
+    m_socket->SetCapture(false);
+    TakeSent(datagrams);
+  }
+
+ private:
+  SelectServer *m_ss;
+  ola::ReceiveStatsMap m_stats;
+  auto_ptr<ola::plugin::kinet::KiNetNode> m_node;
+
+  static const uint16_t KINET_PORT = 6038;
+};
+#endif  // USE_KINET
+
+
+#ifdef USE_OPENPIXELCONTROL
+/**
+ * Set Pixel Colors messages through the OPCServer. Each datagram is treated
+ * as a read from a client connection.
+ */
+class OPCBenchmark: public ParserBenchmark {
+ public:
+  explicit OPCBenchmark(SelectServer *ss)
+      : ParserBenchmark("opc", 0),
+        m_server(ss, IPV4SocketAddress(IPV4Address::Loopback(), 0)) {
+  }
+
+  bool Setup(unsigned int universes) {
+    // Channel 0 is the broadcast channel.
+    for (unsigned int i = 0; i < universes && i < 255; i++) {
+      m_server.SetCallback(i + 1, ola::NewCallback(
+          this, &OPCBenchmark::MessageReceived));
+    }
+    return true;
+  }
+
+  void Generate(unsigned int universes, DatagramList *datagrams) {
+    // 170 RGB pixels for each universe.
+    static const unsigned int PIXEL_DATA_SIZE = 510;
+
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int i = 0; i < universes && i < 255; i++) {
+        vector<uint8_t> message;
+        message.push_back(i + 1);
+        message.push_back(0);  // Set Pixel Colors
+        message.push_back(PIXEL_DATA_SIZE >> 8);
+        message.push_back(PIXEL_DATA_SIZE & 0xff);
+        message.insert(message.end(), buffer.GetRaw(),
+                       buffer.GetRaw() + PIXEL_DATA_SIZE);
+        AddDatagram(0, message, datagrams);
+      }
+    }
+  }
+
+  uint64_t Parse(const DatagramList &datagrams, uint64_t count) {
+    if (datagrams.empty()) {
+      return 0;
+    }
+    uint64_t parsed = 0;
+    DatagramList::const_iterator iter = datagrams.begin();
+    while (parsed < count) {
+      if (!iter->data.empty()) {
+        m_server.HandleData(&iter->data[0], iter->data.size());
+      }
+      parsed++;
+      if (++iter == datagrams.end()) {
+        iter = datagrams.begin();
+      }
+    }
+    return parsed;
+  }
+
+ private:
+  ola::plugin::openpixelcontrol::OPCServer m_server;
+
+  void MessageReceived(uint8_t, const uint8_t*, unsigned int) {
+    FrameReceived();
+  }
+};
+#endif  // USE_OPENPIXELCONTROL
+
+
+#ifdef USE_OSC
+/**
+ * OSC messages through the OSCNode. Each frame is sent as a blob for each
+ * universe, along with a few single slot float messages, as a fader would
+ * send.
+ */
+class OSCBenchmark: public ParserBenchmark {
+ public:
+  explicit OSCBenchmark(SelectServer *ss)
+      : ParserBenchmark("osc", OSC_PORT),
+        m_ss(ss) {
+  }
+
+  ~OSCBenchmark() {
+    if (m_node.get()) {
+      m_node->Stop();
+    }
+  }
+
+  bool Setup(unsigned int universes) {
+    ola::plugin::osc::OSCNode::OSCNodeOptions options;
+    options.listen_port = 0;
+    m_node.reset(new ola::plugin::osc::OSCNode(m_ss, NULL, options));
+    if (!m_node->Init()) {
+      return false;
+    }
+
+    for (unsigned int i = 0; i < universes; i++) {
+      m_node->RegisterAddress(UniverseAddress(i), ola::NewCallback(
+          this, &OSCBenchmark::DMXReceived));
+    }
+    return true;
+  }
+
+  void Generate(unsigned int universes, DatagramList *datagrams) {
+    static const unsigned int FADERS = 4;
+
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int i = 0; i < universes; i++) {
+        vector<uint8_t> message;
+        AppendString(UniverseAddress(i), &message);
+        AppendString(",b", &message);
+        AppendUInt32(buffer.Size(), &message);
+        message.insert(message.end(), buffer.GetRaw(),
+                       buffer.GetRaw() + buffer.Size());
+        AddDatagram(OSC_PORT, message, datagrams);
+
+        for (unsigned int slot = 0; slot < FADERS; slot++) {
+          message.clear();
+          AppendString(UniverseAddress(i) + "/" + ola::IntToString(slot + 1),
+                       &message);
+          AppendString(",f", &message);
+          float value = buffer.Get(slot) / 255.0f;
+          uint32_t bits;
+          memcpy(&bits, &value, sizeof(bits));
+          AppendUInt32(bits, &message);
+          AddDatagram(OSC_PORT, message, datagrams);
+        }
+      }
+    }
+  }
+
+  uint64_t Parse(const DatagramList &datagrams, uint64_t count) {
+    if (datagrams.empty()) {
+      return 0;
+    }
+    uint64_t parsed = 0;
+    DatagramList::const_iterator iter = datagrams.begin();
+    while (parsed < count) {
+      if (!iter->data.empty()) {
+        m_node->HandleData(&iter->data[0], iter->data.size());
+      }
+      parsed++;
+      if (++iter == datagrams.end()) {
+        iter = datagrams.begin();
+      }
+    }
+    return parsed;
+  }
+
+ private:
+  SelectServer *m_ss;
+  auto_ptr<ola::plugin::osc::OSCNode> m_node;
+
+  void DMXReceived(const DmxBuffer&) {
+    FrameReceived();
+  }
+
+  static string UniverseAddress(unsigned int universe) {
+    return "/dmx/universe/" + ola::IntToString(universe);
+  }
+
+  // OSC strings are null terminated and padded to a multiple of 4 bytes.
+  static void AppendString(const string &str, vector<uint8_t> *message) {
+    message->insert(message->end(), str.begin(), str.end());
+    do {
+      message->push_back(0);
+    } while (message->size() % 4);
+  }
+
+  static void AppendUInt32(uint32_t value, vector<uint8_t> *message) {
+    message->push_back(value >> 24);
+    message->push_back((value >> 16) & 0xff);
+    message->push_back((value >> 8) & 0xff);
+    message->push_back(value & 0xff);
+  }
+
+  static const uint16_t OSC_PORT = 7770;
+};
+#endif  // USE_OSC
+
+
+#ifdef USE_SHOWNET
+/**
+ * Compressed ShowNet packets through the ShowNetNode.
+ */
+class ShowNetBenchmark: public UDPParserBenchmark {
+ public:
+  ShowNetBenchmark()
+      : UDPParserBenchmark("shownet", SHOWNET_PORT) {
+  }
+
+  ~ShowNetBenchmark() {
+    if (m_node.get()) {
+      m_node->Stop();
+    }
+  }
+
+  bool Setup(unsigned int universes) {
+    typedef ola::plugin::shownet::ShowNetNode ShowNetNode;
+
+    m_socket = new ReplaySocket();
+    m_node.reset(new ShowNetNode("", m_socket));
+    if (!m_node->Start()) {
+      return false;
+    }
+
+    m_universes = std::min(
+        universes, static_cast<unsigned int>(
+            ShowNetNode::SHOWNET_MAX_UNIVERSES));
+    m_buffers.resize(m_universes);
+    for (unsigned int i = 0; i < m_universes; i++) {
+      m_node->SetHandler(i, &m_buffers[i], NewFrameCallback());
+    }
+    return true;
+  }
+
+  void Generate(unsigned int, DatagramList *datagrams) {
+    m_socket->SetCapture(true);
+    DmxBuffer buffer;
+    for (unsigned int frame = 0; frame < SYNTHETIC_FRAMES; frame++) {
+      BuildFrame(frame, &buffer);
+      for (unsigned int i = 0; i < m_universes; i++) {
+        m_node->SendDMX(i, buffer);
+      }
+    }
+    m_socket->SetCapture(false);
+    TakeSent(datagrams);
+  }
+
+ private:
+  auto_ptr<ola::plugin::shownet::ShowNetNode> m_node;
+  vector<DmxBuffer> m_buffers;
+  unsigned int m_universes;
+
+  static const uint16_t SHOWNET_PORT = 2501;
+};
+#endif  // USE_SHOWNET
+
+
+/*
+ * Read a 32 bit value from a capture file header.
+ */
+uint32_t CaptureUInt32(const uint8_t *data, bool swap) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  if (swap) {
+    value = (value >> 24) | ((value >> 8) & 0xff00) |
+            ((value << 8) & 0xff0000) | (value << 24);
+  }
+  return value;
+}
+
+/**
+ * Read the UDP datagrams from a pcap file.
+ *
+ * Ethernet, Linux cooked and raw IP captures are supported. IP fragments are
+ * skipped, since there's no reassembly, as are truncated datagrams.
+ */
+bool ReadCapture(const string &filename, DatagramList *datagrams) {
+  static const unsigned int FILE_HEADER_SIZE = 24;
+  static const unsigned int RECORD_HEADER_SIZE = 16;
+  static const uint32_t LINKTYPE_ETHERNET = 1;
+  static const uint32_t LINKTYPE_RAW = 101;
+  static const uint32_t LINKTYPE_LINUX_SLL = 113;
+  static const uint16_t ETHERTYPE_IPV4 = 0x0800;
+  static const uint16_t ETHERTYPE_VLAN = 0x8100;
+  static const uint8_t IPPROTO_UDP_NUMBER = 17;
+  static const unsigned int UDP_HEADER_SIZE = 8;
+
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+  const vector<uint8_t> capture((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+
+  if (capture.size() < FILE_HEADER_SIZE) {
+    OLA_WARN << filename << " is too short to be a capture";
+    return false;
+  }
+
+  bool swap;
+  const uint32_t magic = CaptureUInt32(&capture[0], false);
+  if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d) {
+    swap = false;
+  } else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1) {
+    swap = true;
+  } else {
+    OLA_WARN << filename << " isn't a pcap file, pcapng isn't supported";
+    return false;
+  }
+
+  const uint32_t link_type = CaptureUInt32(&capture[20], swap);
+  if (link_type != LINKTYPE_ETHERNET && link_type != LINKTYPE_RAW &&
+      link_type != LINKTYPE_LINUX_SLL) {
+    OLA_WARN << "Unsupported link type " << link_type;
+    return false;
+  }
+
+  unsigned int offset = FILE_HEADER_SIZE;
+  while (capture.size() - offset >= RECORD_HEADER_SIZE) {
+    const unsigned int length = CaptureUInt32(&capture[offset + 8], swap);
+    offset += RECORD_HEADER_SIZE;
+    if (capture.size() - offset < length) {
+      break;
+    }
+    const uint8_t *frame = &capture[offset];
+    offset += length;
+
+    // Find the start of the IP header.
+    unsigned int ip_offset = 0;
+    uint16_t ether_type = ETHERTYPE_IPV4;
+    if (link_type == LINKTYPE_ETHERNET) {
+      ip_offset = 14;
+      if (length < ip_offset) {
+        continue;
+      }
+      ether_type = ola::utils::JoinUInt8(frame[12], frame[13]);
+      if (ether_type == ETHERTYPE_VLAN && length >= ip_offset + 4) {
+        ether_type = ola::utils::JoinUInt8(frame[16], frame[17]);
+        ip_offset += 4;
+      }
+    } else if (link_type == LINKTYPE_LINUX_SLL) {
+      ip_offset = 16;
+      if (length < ip_offset) {
+        continue;
+      }
+      ether_type = ola::utils::JoinUInt8(frame[14], frame[15]);
+    }
+
+    if (ether_type != ETHERTYPE_IPV4 || length < ip_offset + 20) {
+      continue;
+    }
+
+    const uint8_t *ip = frame + ip_offset;
+    const unsigned int ip_header_size = (ip[0] & 0x0f) * 4;
+    const uint16_t fragment = ola::utils::JoinUInt8(ip[6], ip[7]);
+    if ((ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP_NUMBER ||
+        (fragment & 0x3fff) ||
+        length < ip_offset + ip_header_size + UDP_HEADER_SIZE) {
+      continue;
+    }
+
+    const uint8_t *udp = ip + ip_header_size;
+    const unsigned int udp_length = ola::utils::JoinUInt8(udp[4], udp[5]);
+    if (udp_length < UDP_HEADER_SIZE ||
+        length < ip_offset + ip_header_size + udp_length) {
+      continue;
+    }
+
+    uint32_t source_ip;
+    memcpy(&source_ip, ip + 12, sizeof(source_ip));
+    datagrams->push_back(Datagram());
+    Datagram &datagram = datagrams->back();
+    datagram.source = IPV4SocketAddress(
+        IPV4Address(source_ip), ola::utils::JoinUInt8(udp[0], udp[1]));
+    datagram.destination_port = ola::utils::JoinUInt8(udp[2], udp[3]);
+    datagram.data.assign(udp + UDP_HEADER_SIZE, udp + udp_length);
+  }
+  return true;
+}
+
+
+/*
+ * Corrupt the datagrams. Each datagram is copied FUZZ_VARIANTS times, and
+ * each copy is truncated or has some bytes changed.
+ */
+void Fuzz(uint32_t seed, DatagramList *datagrams) {
+  static const unsigned int FUZZ_VARIANTS = 16;
+
+  uint32_t state = seed;
+  DatagramList fuzzed;
+  fuzzed.reserve(datagrams->size() * FUZZ_VARIANTS);
+  for (DatagramList::const_iterator iter = datagrams->begin();
+       iter != datagrams->end(); ++iter) {
+    for (unsigned int i = 0; i < FUZZ_VARIANTS; i++) {
+      fuzzed.push_back(*iter);
+      vector<uint8_t> &data = fuzzed.back().data;
+      if (data.empty()) {
+        continue;
+      }
+
+      state = state * 1103515245 + 12345;
+      if ((state >> 16) % 4 == 0) {
+        state = state * 1103515245 + 12345;
+        data.resize((state >> 16) % data.size());
+        continue;
+      }
+
+      state = state * 1103515245 + 12345;
+      const unsigned int changes = 1 + (state >> 16) % 4;
+      for (unsigned int j = 0; j < changes; j++) {
+        state = state * 1103515245 + 12345;
+        const unsigned int offset = (state >> 16) % data.size();
+        state = state * 1103515245 + 12345;
+        data[offset] = (state >> 16) & 0xff;
+      }
+    }
+  }
+  datagrams->swap(fuzzed);
+}
+
+
+struct Result {
+  uint64_t packets;
+  uint64_t frames;
+  double ns_per_packet;
+  double allocations_per_packet;
+};
+
+typedef map<string, Result> Results;
+
+/*
+ * Run a benchmark, after a short warm up.
+ */
+Result RunBenchmark(ParserBenchmark *benchmark,
+                    const DatagramList &datagrams) {
+  benchmark->Parse(datagrams, std::min(static_cast<uint64_t>(datagrams.size()),
+                                       static_cast<uint64_t>(FLAGS_packets)));
+
+  Clock clock;
+  TimeStamp start, end;
+  const uint64_t frames = benchmark->Frames();
+  const uint64_t allocations = allocation_count;
+  clock.CurrentMonotonicTime(&start);
+  const uint64_t packets = benchmark->Parse(datagrams, FLAGS_packets);
+  clock.CurrentMonotonicTime(&end);
+
+  Result result;
+  result.packets = packets;
+  result.frames = benchmark->Frames() - frames;
+  const TimeInterval duration = end - start;
+  result.ns_per_packet = packets ? duration.AsInt() * 1000.0 / packets : 0;
+  result.allocations_per_packet = packets ?
+      static_cast<double>(allocation_count - allocations) / packets : 0;
+  return result;
+}
+
+bool WriteBaseline(const string &filename, const Results &results) {
+  std::ofstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+  file << "# protocol ns/packet allocations/packet" << endl;
+  file << std::fixed << std::setprecision(2);
+  for (Results::const_iterator iter = results.begin(); iter != results.end();
+       ++iter) {
+    file << iter->first << " " << iter->second.ns_per_packet << " "
+         << iter->second.allocations_per_packet << endl;
+  }
+  return true;
+}
+
+/*
+ * Compare the results with a baseline.
+ * @returns false if there was a regression, or the baseline couldn't be read.
+ */
+bool CheckBaseline(const string &filename, const Results &results) {
+  std::ifstream file(filename.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << filename;
+    return false;
+  }
+
+  bool ok = true;
+  string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream str(line);
+    string protocol;
+    double ns_per_packet, allocations_per_packet;
+    if (!(str >> protocol >> ns_per_packet >> allocations_per_packet)) {
+      OLA_WARN << "Invalid baseline line: " << line;
+      ok = false;
+      continue;
+    }
+
+    const Result *result = ola::STLFind(&results, protocol);
+    if (!result) {
+      continue;
+    }
+
+    const double limit = ns_per_packet * (100 + FLAGS_tolerance) / 100;
+    if (result->ns_per_packet > limit) {
+      cout << protocol << ": " << result->ns_per_packet
+           << " ns/packet, the baseline is " << ns_per_packet << endl;
+      ok = false;
+    }
+    // Allocations don't depend on the machine, so any increase is reported.
+    if (result->allocations_per_packet > allocations_per_packet + 0.01) {
+      cout << protocol << ": " << result->allocations_per_packet
+           << " allocations/packet, the baseline is "
+           << allocations_per_packet << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Replay traffic through the input parsers of the network "
+               "plugins, and report the time and allocations per packet.");
+
+  if (FLAGS_fuzz) {
+    ola::SetLogLevel(ola::OLA_LOG_FATAL);
+  }
+
+  vector<string> selected;
+  if (!FLAGS_protocols.str().empty()) {
+    ola::StringSplit(FLAGS_protocols.str(), &selected, ",");
+  }
+
+  DatagramList captured;
+  const bool use_capture = !FLAGS_pcap.str().empty();
+  if (use_capture && !ReadCapture(FLAGS_pcap.str(), &captured)) {
+    return 1;
+  }
+
+  SelectServer ss;
+  vector<ParserBenchmark*> benchmarks;
+#ifdef USE_ARTNET
+  benchmarks.push_back(new ArtNetBenchmark(&ss));
+#endif  // USE_ARTNET
+#ifdef USE_E131
+  benchmarks.push_back(new E131Benchmark(true));
+  benchmarks.push_back(new E131Benchmark(false));
+#endif  // USE_E131
+#ifdef USE_ESPNET
+  benchmarks.push_back(new EspNetBenchmark());
+#endif  // USE_ESPNET
+#ifdef USE_KINET
+  benchmarks.push_back(new KiNetBenchmark(&ss));
+#endif  // USE_KINET
+#ifdef USE_OPENPIXELCONTROL
+  benchmarks.push_back(new OPCBenchmark(&ss));
+#endif  // USE_OPENPIXELCONTROL
+#ifdef USE_OSC
+  benchmarks.push_back(new OSCBenchmark(&ss));
+#endif  // USE_OSC
+#ifdef USE_SHOWNET
+  benchmarks.push_back(new ShowNetBenchmark());
+#endif  // USE_SHOWNET
+
+  cout << std::setw(14) << "protocol" << std::setw(10) << "packets"
+       << std::setw(10) << "frames" << std::setw(12) << "ns/packet"
+       << std::setw(14) << "packets/s" << std::setw(14) << "allocs/packet"
+       << endl;
+
+  Results results;
+  vector<ParserBenchmark*>::iterator iter = benchmarks.begin();
+  for (; iter != benchmarks.end(); ++iter) {
+    ParserBenchmark *benchmark = *iter;
+    if (!selected.empty() &&
+        std::find(selected.begin(), selected.end(), benchmark->Name()) ==
+            selected.end()) {
+      continue;
+    }
+    if (!benchmark->Setup(FLAGS_universes)) {
+      OLA_WARN << "Failed to set up " << benchmark->Name();
+      continue;
+    }
+
+    DatagramList datagrams;
+    if (use_capture) {
+      DatagramList::const_iterator captured_iter = captured.begin();
+      for (; captured_iter != captured.end(); ++captured_iter) {
+        if (benchmark->Port() &&
+            captured_iter->destination_port == benchmark->Port()) {
+          datagrams.push_back(*captured_iter);
+        }
+      }
+    } else {
+      benchmark->Generate(FLAGS_universes, &datagrams);
+    }
+
+    if (datagrams.empty()) {
+      cout << std::setw(14) << benchmark->Name() << "  no packets" << endl;
+      continue;
+    }
+    if (FLAGS_fuzz) {
+      Fuzz(FLAGS_seed, &datagrams);
+    }
+
+    const Result result = RunBenchmark(benchmark, datagrams);
+    results[benchmark->Name()] = result;
+    cout << std::setw(14) << benchmark->Name()
+         << std::setw(10) << result.packets
+         << std::setw(10) << result.frames
+         << std::fixed << std::setprecision(1)
+         << std::setw(12) << result.ns_per_packet
+         << std::setprecision(0)
+         << std::setw(14) << (result.ns_per_packet ?
+                              1e9 / result.ns_per_packet : 0)
+         << std::setprecision(2)
+         << std::setw(14) << result.allocations_per_packet << endl;
+  }
+  ola::STLDeleteElements(&benchmarks);
+
+  if (!FLAGS_baseline.str().empty()) {
+    if (FLAGS_write_baseline) {
+      return WriteBaseline(FLAGS_baseline.str(), results) ? 0 : 1;
+    }
+    return CheckBaseline(FLAGS_baseline.str(), results) ? 0 : 1;
+  }
+  return 0;
+}
@@ -21,12 +21,12 @@
 #include <string.h>
 #include <algorithm>
 #include <string>
-#include <map>
 #include <vector>
 #include "ola/Logging.h"
 #include "ola/Constants.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/UDPPacketBuilder.h"
 #include "plugins/pathport/PathportNode.h"
 
 
@@ -35,12 +35,12 @@ namespace plugin {
 namespace pathport {
 
 using std::string;
-using std::map;
 using std::vector;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::NetworkToHost;
+using ola::network::UDPPacketBuilder;
 using ola::network::UDPSocket;
 using ola::Callback0;
 
@@ -57,6 +57,12 @@ PathportNode::PathportNode(const string &ip_address,
       m_preferred_ip(ip_address),
       m_device_id(device_id),
       m_sequence_number(1) {
+  for (unsigned int i = 0; i <= MAX_UNIVERSES; i++) {
+    m_handlers[i].buffer = NULL;
+    m_handlers[i].closure = NULL;
+    m_handlers[i].updated = false;
+  }
+  m_updated_universes.reserve(MAX_UNIVERSES + 1);
 }
 
 
@@ -66,11 +72,10 @@ PathportNode::PathportNode(const string &ip_address,
 PathportNode::~PathportNode() {
   Stop();
 
-  universe_handlers::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
+  for (unsigned int i = 0; i <= MAX_UNIVERSES; i++) {
+    delete m_handlers[i].closure;
+    m_handlers[i].closure = NULL;
   }
-  m_handlers.clear();
 }
 
 
@@ -161,29 +166,42 @@ void PathportNode::SocketReady(UDPSocket *socket) {
     return;
   }
 
-  // TODO(simon): Handle multiple pdus here
-  pathport_packet_pdu *pdu = &packet.d.pdu;
-
   if (packet_size < static_cast<ssize_t>(sizeof(pathport_pdu_header))) {
     OLA_WARN << "Pathport packet too small to fit a pdu header";
     return;
   }
-  packet_size -= sizeof(pathport_pdu_header);
-
-  switch (NetworkToHost(pdu->head.type)) {
-    case PATHPORT_DATA:
-      HandleDmxData(pdu->d.data, packet_size);
-      break;
-    case PATHPORT_ARP_REQUEST:
-      SendArpReply();
-      break;
-    case PATHPORT_ARP_REPLY:
-      OLA_DEBUG << "Got pathport arp reply";
-      break;
-    default:
-      OLA_INFO << "Unhandled pathport packet with id: "
-               << NetworkToHost(pdu->head.type);
+
+  // A packet can carry several PDUs, e.g. one xDMX block per universe. The
+  // handlers are run once the whole packet has been processed, so a universe
+  // split across blocks is only merged once.
+  const uint8_t *pdu_data = packet.d.data;
+  while (packet_size >= static_cast<ssize_t>(sizeof(pathport_pdu_header))) {
+    const pathport_packet_pdu *pdu =
+        reinterpret_cast<const pathport_packet_pdu*>(pdu_data);
+    packet_size -= sizeof(pathport_pdu_header);
+    unsigned int pdu_size = std::min(
+        static_cast<unsigned int>(NetworkToHost(pdu->head.len)),
+        static_cast<unsigned int>(packet_size));
+
+    switch (NetworkToHost(pdu->head.type)) {
+      case PATHPORT_DATA:
+        HandleDmxData(pdu->d.data, pdu_size);
+        break;
+      case PATHPORT_ARP_REQUEST:
+        SendArpReply();
+        break;
+      case PATHPORT_ARP_REPLY:
+        OLA_DEBUG << "Got pathport arp reply";
+        break;
+      default:
+        OLA_INFO << "Unhandled pathport packet with id: "
+                 << NetworkToHost(pdu->head.type);
+    }
+
+    pdu_data += sizeof(pathport_pdu_header) + pdu_size;
+    packet_size -= pdu_size;
   }
+  RunUpdatedHandlers();
 }
 
 
@@ -196,22 +214,17 @@ void PathportNode::SocketReady(UDPSocket *socket) {
 bool PathportNode::SetHandler(uint8_t universe,
                              DmxBuffer *buffer,
                              Callback0<void> *closure) {
-  if (!closure) {
+  if (!closure || universe > MAX_UNIVERSES) {
     return false;
   }
 
-  universe_handlers::iterator iter = m_handlers.find(universe);
-
-  if (iter == m_handlers.end()) {
-    universe_handler handler;
+  universe_handler &handler = m_handlers[universe];
+  Callback0<void> *old_closure = handler.closure;
+  if (!old_closure) {
     handler.buffer = buffer;
-    handler.closure = closure;
-    m_handlers[universe] = handler;
-  } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    delete old_closure;
   }
+  handler.closure = closure;
+  delete old_closure;
   return true;
 }
 
@@ -222,15 +235,16 @@ bool PathportNode::SetHandler(uint8_t universe,
  * @param true if removed, false if it didn't exist
  */
 bool PathportNode::RemoveHandler(uint8_t universe) {
-  universe_handlers::iterator iter = m_handlers.find(universe);
-
-  if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
-    m_handlers.erase(iter);
-    delete old_closure;
-    return true;
+  if (universe > MAX_UNIVERSES || !m_handlers[universe].closure) {
+    return false;
   }
-  return false;
+
+  universe_handler &handler = m_handlers[universe];
+  Callback0<void> *old_closure = handler.closure;
+  handler.buffer = NULL;
+  handler.closure = NULL;
+  delete old_closure;
+  return true;
 }
 
 
@@ -297,15 +311,16 @@ bool PathportNode::SendDMX(unsigned int universe, const DmxBuffer &buffer) {
   pdu->d.data.offset = HostToNetwork(
       (uint16_t) (DMX_UNIVERSE_SIZE * universe));
 
-  unsigned int length = padded_size;
-  buffer.Get(pdu->d.data.data, &length);
-
-  // pad data to multiple of 4 bytes
-  length = sizeof(pathport_packet_header) +
-           sizeof(pathport_pdu_header) +
-           sizeof(pathport_pdu_data) + padded_size;
-
-  return SendPacket(packet, length, m_data_addr);
+  // Send the DMX data from the buffer, rather than copying it into the
+  // packet.
+  UDPPacketBuilder builder;
+  builder.Append(&packet, sizeof(pathport_packet_header) +
+                          sizeof(pathport_pdu_header) +
+                          sizeof(pathport_pdu_data));
+  builder.AppendDMX(buffer);
+  builder.AppendPadding(padded_size - buffer.Size());
+  return builder.SendTo(&m_socket,
+                        IPV4SocketAddress(m_data_addr, PATHPORT_PORT));
 }
 
 
@@ -410,12 +425,13 @@ void PathportNode::HandleDmxData(const pathport_pdu_data &packet,
     unsigned int channels_for_this_universe =
       std::min(data_size, DMX_UNIVERSE_SIZE - offset);
 
-    universe_handlers::iterator iter = m_handlers.find(universe);
-    if (iter != m_handlers.end()) {
-      iter->second.buffer->SetRange(offset,
-                                    dmx_data,
-                                    channels_for_this_universe);
-      iter->second.closure->Run();
+    universe_handler &handler = m_handlers[universe];
+    if (handler.closure) {
+      handler.buffer->SetRange(offset, dmx_data, channels_for_this_universe);
+      if (!handler.updated) {
+        handler.updated = true;
+        m_updated_universes.push_back(universe);
+      }
     }
     data_size -= channels_for_this_universe;
     dmx_data += channels_for_this_universe;
@@ -425,6 +441,22 @@ void PathportNode::HandleDmxData(const pathport_pdu_data &packet,
 }
 
 
+/*
+ * Run the handlers for the universes updated by the last packet.
+ */
+void PathportNode::RunUpdatedHandlers() {
+  std::vector<uint8_t>::const_iterator iter = m_updated_universes.begin();
+  for (; iter != m_updated_universes.end(); ++iter) {
+    universe_handler &handler = m_handlers[*iter];
+    handler.updated = false;
+    if (handler.closure) {
+      handler.closure->Run();
+    }
+  }
+  m_updated_universes.clear();
+}
+
+
 /*
  * @param destination the destination to target
  */
@@ -21,8 +21,8 @@
 #ifndef PLUGINS_PATHPORT_PATHPORTNODE_H_
 #define PLUGINS_PATHPORT_PATHPORTNODE_H_
 
-#include <map>
 #include <string>
+#include <vector>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/network/IPV4Address.h"
@@ -63,6 +63,7 @@ class PathportNode {
     typedef struct {
       DmxBuffer *buffer;
       Callback0<void> *closure;
+      bool updated;
     } universe_handler;
 
     enum {
@@ -98,13 +99,12 @@ class PathportNode {
       NODE_DEVICE_ONEPORT = 2,
     };
 
-    typedef std::map<uint8_t, universe_handler> universe_handlers;
-
     bool InitNetwork();
     void PopulateHeader(pathport_packet_header *header, uint32_t destination);
     bool ValidateHeader(const pathport_packet_header &header);
     void HandleDmxData(const pathport_pdu_data &packet,
                        unsigned int size);
+    void RunUpdatedHandlers();
     bool SendArpRequest(uint32_t destination = PATHPORT_ID_BROADCAST);
     bool SendPacket(const pathport_packet_s &packet,
                     unsigned int size,
@@ -116,7 +116,10 @@ class PathportNode {
     uint32_t m_device_id;  // the pathport device id
     uint16_t m_sequence_number;
 
-    universe_handlers m_handlers;
+    // Indexed by universe, a NULL closure means there is no handler.
+    universe_handler m_handlers[MAX_UNIVERSES + 1];
+    // The universes updated by the packet being processed.
+    std::vector<uint8_t> m_updated_universes;
     ola::network::Interface m_interface;
     ola::network::UDPSocket m_socket;
     ola::network::IPV4Address m_config_addr;
@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include "ola/network/IPV4Address.h"
+#include "ola/network/WireLayout.h"
 
 namespace ola {
 namespace plugin {
@@ -170,6 +171,14 @@ struct pathport_packet_s {
     pathport_packet_pdu pdu;
   } d;
 });
+
+// Check the layouts match the Pathport protocol.
+WIRE_SIZE_ASSERT(pathport_pdu_data, 8);
+WIRE_SIZE_ASSERT(pathport_pdu_getrep_alv, 4);
+WIRE_SIZE_ASSERT(pathport_pdu_arp_reply, 12);
+WIRE_SIZE_ASSERT(pathport_pdu_header, 4);
+WIRE_SIZE_ASSERT(pathport_packet_header, 20);
+WIRE_OFFSET_ASSERT(pathport_packet_pdu, d, 4);
 }  // namespace pathport
 }  // namespace plugin
 }  // namespace ola
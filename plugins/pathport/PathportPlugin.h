@@ -40,6 +40,7 @@ class PathportPlugin: public ola::Plugin {
     std::string Description() const;
     ola_plugin_id Id() const { return OLA_PLUGIN_PATHPORT; }
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreading() const { return true; }
 
  private:
     bool StartHook();
@@ -54,10 +54,12 @@ const uint32_t RenardDevice::DEFAULT_BAUDRATE = ola::io::BAUD_RATE_57600;
  * @param owner the plugin that owns this device
  * @param preferences config settings
  * @param dev_path path to the pro widget
+ * @param export_map the ExportMap to record the wire stats in
  */
 RenardDevice::RenardDevice(AbstractPlugin *owner,
                            class Preferences *preferences,
-                           const string &dev_path)
+                           const string &dev_path,
+                           ExportMap *export_map)
     : Device(owner, RENARD_DEVICE_NAME),
       m_dev_path(dev_path),
       m_preferences(preferences) {
@@ -83,7 +85,7 @@ RenardDevice::RenardDevice(AbstractPlugin *owner,
   }
 
   m_widget.reset(new RenardWidget(m_dev_path, dmxOffset, channels, baudrate,
-                                  RENARD_START_ADDRESS));
+                                  RENARD_START_ADDRESS, export_map));
 
   OLA_DEBUG << "DMX offset set to " << static_cast<int>(dmxOffset);
   OLA_DEBUG << "Channels set to " << static_cast<int>(channels);
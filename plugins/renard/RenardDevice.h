@@ -29,6 +29,7 @@
 namespace ola {
 
 class AbstractPlugin;
+class ExportMap;
 
 namespace plugin {
 namespace renard {
@@ -37,7 +38,8 @@ class RenardDevice: public ola::Device {
  public:
     RenardDevice(AbstractPlugin *owner,
                  class Preferences *preferences,
-                 const std::string &dev_path);
+                 const std::string &dev_path,
+                 ola::ExportMap *export_map);
     ~RenardDevice();
 
     std::string DeviceId() const { return m_dev_path; }
@@ -60,7 +60,8 @@ bool RenardPlugin::StartHook() {
       continue;
     }
 
-    device = new RenardDevice(this, m_preferences, *it);
+    device = new RenardDevice(this, m_preferences, *it,
+                              m_plugin_adaptor->GetExportMap());
     OLA_DEBUG << "Adding device " << *it;
 
     if (!device->Start()) {
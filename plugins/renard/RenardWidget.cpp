@@ -18,6 +18,7 @@
  * Copyright (C) 2013 Hakan Lindestaf
  */
 
+#include <string.h>
 #include <algorithm>
 #include <string>
 
@@ -43,10 +44,66 @@ const uint8_t RenardWidget::RENARD_ESCAPE_ESCAPE = 0x31;
 const uint8_t RenardWidget::RENARD_CHANNELS_IN_BANK = 8;
 // Discussions on the Renard firmware recommended a padding each 100 bytes or so
 const uint32_t RenardWidget::RENARD_BYTES_BETWEEN_PADDING = 100;
+const unsigned int RenardWidget::FULL_REFRESH_INTERVAL_MS = 1000;
+const char RenardWidget::BYTES_SENT_VAR[] = "renard-bytes-sent";
+const char RenardWidget::UTILIZATION_VAR[] = "renard-wire-utilization";
+const char RenardWidget::DEVICE_KEY[] = "device";
+
+namespace {
+
+// The byte to send after RENARD_COMMAND_ESCAPE for each value, or 0 if the
+// value doesn't need escaping.
+const uint8_t ESCAPED_VALUES[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  // 0x7D (pad), 0x7E (start packet) & 0x7F (escape)
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x2F, 0x30, 0x31,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+}  // namespace
 
 /*
  * New widget
  */
+RenardWidget::RenardWidget(const string &path,
+                           int dmxOffset,
+                           int channels,
+                           uint32_t baudrate,
+                           uint8_t startAddress,
+                           ola::ExportMap *export_map)
+    : m_path(path),
+      m_socket(NULL),
+      m_byteCounter(0),
+      m_dmxOffset(dmxOffset),
+      m_channels(channels),
+      m_baudrate(baudrate),
+      m_startAddress(startAddress),
+      m_last_sent(channels),
+      m_last_sent_channels(0),
+      m_window_bytes(0),
+      m_bytes_sent_var(NULL),
+      m_utilization_var(NULL) {
+  if (export_map) {
+    m_bytes_sent_var = export_map->GetUIntMapVar(BYTES_SENT_VAR, DEVICE_KEY);
+    (*m_bytes_sent_var)[m_path] = 0;
+    m_utilization_var = export_map->GetUIntMapVar(UTILIZATION_VAR,
+                                                  DEVICE_KEY);
+    (*m_utilization_var)[m_path] = 0;
+  }
+}
+
 RenardWidget::~RenardWidget() {
   if (m_socket) {
     m_socket->Close();
@@ -131,72 +188,100 @@ bool RenardWidget::DetectDevice() {
  * Send a DMX msg.
  */
 bool RenardWidget::SendDmx(const DmxBuffer &buffer) {
-  unsigned int channels = std::max((unsigned int)0,
-                                   std::min((unsigned int) m_channels +
-                                            m_dmxOffset, buffer.Size()) -
-                                   m_dmxOffset);
+  unsigned int channels = buffer.Size() > m_dmxOffset ?
+      std::min(m_channels, buffer.Size() - m_dmxOffset) : 0;
+  const uint8_t *data = buffer.GetRaw() + m_dmxOffset;
 
-  OLA_DEBUG << "Sending " << static_cast<int>(channels) << " channels";
+  const bool full_refresh = StartFullRefresh();
+  OLA_DEBUG << "Sending " << static_cast<int>(channels) << " channels"
+            << (full_refresh ? ", full refresh" : "");
 
   // Max buffer size for worst case scenario (escaping + padding)
-  unsigned int bufferSize = channels * 2 + 10;
+  unsigned int bufferSize = channels * 2 + 10 +
+      3 * (channels / RENARD_CHANNELS_IN_BANK);
   uint8_t msg[bufferSize];
 
   int dataToSend = 0;
 
-  for (unsigned int i = 0; i < channels; i++) {
-    if ((i % RENARD_CHANNELS_IN_BANK) == 0) {
-      if (m_byteCounter >= RENARD_BYTES_BETWEEN_PADDING) {
-        // Send PAD every 100 (or so) bytes. Note that the counter is per
-        // device, so the counter should span multiple calls to SendDMX.
-        msg[dataToSend++] = RENARD_COMMAND_PAD;
-        m_byteCounter = 0;
-      }
+  for (unsigned int bank_start = 0; bank_start < channels;
+       bank_start += RENARD_CHANNELS_IN_BANK) {
+    const unsigned int bank_end = std::min(
+        bank_start + RENARD_CHANNELS_IN_BANK, channels);
 
-      // Send address
-      msg[dataToSend++] = RENARD_COMMAND_START_PACKET;
-      msg[dataToSend++] = m_startAddress + (i / RENARD_CHANNELS_IN_BANK);
-      m_byteCounter += 2;
+    // Each bank has its own address, so unchanged banks can be skipped.
+    if (!full_refresh && bank_end <= m_last_sent_channels &&
+        !memcmp(data + bank_start, &m_last_sent[bank_start],
+                bank_end - bank_start)) {
+      continue;
     }
 
-    uint8_t b = buffer.Get(m_dmxOffset + i);
-
-    // Escaping magic bytes
-    switch (b) {
-      case RENARD_COMMAND_PAD:
-        msg[dataToSend++] = RENARD_COMMAND_ESCAPE;
-        msg[dataToSend++] = RENARD_ESCAPE_PAD;
-        m_byteCounter += 2;
-        break;
+    if (m_byteCounter >= RENARD_BYTES_BETWEEN_PADDING) {
+      // Send PAD every 100 (or so) bytes. Note that the counter is per
+      // device, so the counter should span multiple calls to SendDMX.
+      msg[dataToSend++] = RENARD_COMMAND_PAD;
+      m_byteCounter = 0;
+    }
 
-      case RENARD_COMMAND_START_PACKET:
-        msg[dataToSend++] = RENARD_COMMAND_ESCAPE;
-        msg[dataToSend++] = RENARD_ESCAPE_START_PACKET;
-        m_byteCounter += 2;
-        break;
+    // Send address
+    msg[dataToSend++] = RENARD_COMMAND_START_PACKET;
+    msg[dataToSend++] = m_startAddress + (bank_start / RENARD_CHANNELS_IN_BANK);
+    m_byteCounter += 2;
 
-      case RENARD_COMMAND_ESCAPE:
+    for (unsigned int i = bank_start; i < bank_end; i++) {
+      const uint8_t b = data[i];
+      // Escaping magic bytes
+      const uint8_t escaped = ESCAPED_VALUES[b];
+      if (escaped) {
         msg[dataToSend++] = RENARD_COMMAND_ESCAPE;
-        msg[dataToSend++] = RENARD_ESCAPE_ESCAPE;
+        msg[dataToSend++] = escaped;
         m_byteCounter += 2;
-        break;
-
-      default:
+      } else {
         msg[dataToSend++] = b;
         m_byteCounter++;
-        break;
+      }
     }
+  }
 
-    OLA_DEBUG << "Setting Renard " << m_startAddress +
-      (i / RENARD_CHANNELS_IN_BANK) << "/" <<
-      ((i % RENARD_CHANNELS_IN_BANK) + 1) << " to " <<
-      static_cast<int>(b);
+  memcpy(&m_last_sent[0], data, channels);
+  m_last_sent_channels = channels;
+
+  if (!dataToSend) {
+    return true;
   }
 
   int bytes_sent = m_socket->Send(msg, dataToSend);
-
   OLA_DEBUG << "Sending DMX, sent " << bytes_sent << " bytes";
 
+  if (bytes_sent > 0) {
+    m_window_bytes += bytes_sent;
+    if (m_bytes_sent_var) {
+      (*m_bytes_sent_var)[m_path] += bytes_sent;
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Check if it's time for a full refresh. If it is, update the wire
+ * utilization for the period since the last one.
+ */
+bool RenardWidget::StartFullRefresh() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  if (m_last_full_refresh.IsSet()) {
+    const int64_t elapsed_ms = (now - m_last_full_refresh).InMilliSeconds();
+    if (elapsed_ms < FULL_REFRESH_INTERVAL_MS) {
+      return false;
+    }
+    if (m_utilization_var && m_baudrate) {
+      // 8N1 is 10 bits per byte, this is a percentage.
+      (*m_utilization_var)[m_path] = static_cast<unsigned int>(
+          m_window_bytes * 10 * 100 * 1000ull / (m_baudrate * elapsed_ms));
+    }
+  }
+  m_last_full_refresh = now;
+  m_window_bytes = 0;
   return true;
 }
 }  // namespace renard
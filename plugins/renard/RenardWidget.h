@@ -22,12 +22,16 @@
 #define PLUGINS_RENARD_RENARDWIDGET_H_
 
 #include <fcntl.h>
+#include <stdint.h>
 #include <termios.h>
 #include <string>
+#include <vector>
 
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/io/SelectServer.h"
 #include "ola/io/Serial.h"
-#include "ola/DmxBuffer.h"
 
 namespace ola {
 namespace plugin {
@@ -50,18 +54,14 @@ class RenardWidget {
     // default in the standard firmware is 0x80, and it may be a reasonable
     // future feature request to have this configurable for more advanced
     // Renard configurations (using wireless transmitters, etc).
-    explicit RenardWidget(const std::string &path,
-                          int dmxOffset,
-                          int channels,
-                          uint32_t baudrate,
-                          uint8_t startAddress)
-      : m_path(path),
-        m_socket(NULL),
-        m_byteCounter(0),
-        m_dmxOffset(dmxOffset),
-        m_channels(channels),
-        m_baudrate(baudrate),
-        m_startAddress(startAddress) {}
+    // The bytes sent and the wire utilization are recorded in the export map,
+    // which may be NULL.
+    RenardWidget(const std::string &path,
+                 int dmxOffset,
+                 int channels,
+                 uint32_t baudrate,
+                 uint8_t startAddress,
+                 ola::ExportMap *export_map);
     virtual ~RenardWidget();
 
     // these methods are for communicating with the device
@@ -69,6 +69,8 @@ class RenardWidget {
     int Disconnect();
     ola::io::ConnectedDescriptor *GetSocket() { return m_socket; }
     std::string GetPath() { return m_path; }
+    // Only the banks that changed are sent, apart from a full refresh once
+    // a second.
     bool SendDmx(const DmxBuffer &buffer);
     bool DetectDevice();
 
@@ -76,6 +78,7 @@ class RenardWidget {
 
  private:
     int ConnectToWidget(const std::string &path, speed_t speed);
+    bool StartFullRefresh();
 
     // instance variables
     const std::string m_path;
@@ -86,6 +89,15 @@ class RenardWidget {
     uint32_t m_baudrate;
     uint8_t m_startAddress;
 
+    // The channels last sent, and how many of them there were.
+    std::vector<uint8_t> m_last_sent;
+    unsigned int m_last_sent_channels;
+    ola::Clock m_clock;
+    TimeStamp m_last_full_refresh;
+    unsigned int m_window_bytes;  // sent since m_last_full_refresh
+    UIntMap *m_bytes_sent_var;
+    UIntMap *m_utilization_var;
+
     static const uint8_t RENARD_COMMAND_PAD;
     static const uint8_t RENARD_COMMAND_START_PACKET;
     static const uint8_t RENARD_COMMAND_ESCAPE;
@@ -93,6 +105,10 @@ class RenardWidget {
     static const uint8_t RENARD_ESCAPE_START_PACKET;
     static const uint8_t RENARD_ESCAPE_ESCAPE;
     static const uint32_t RENARD_BYTES_BETWEEN_PADDING;
+    static const unsigned int FULL_REFRESH_INTERVAL_MS;
+    static const char BYTES_SENT_VAR[];
+    static const char UTILIZATION_VAR[];
+    static const char DEVICE_KEY[];
 };
 }  // namespace renard
 }  // namespace plugin
@@ -21,12 +21,12 @@
 #include <string.h>
 #include <algorithm>
 #include <string>
-#include <map>
 #include <vector>
 #include "ola/Logging.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/MACAddress.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/UDPPacketBuilder.h"
 #include "plugins/sandnet/SandNetNode.h"
 
 
@@ -35,13 +35,13 @@ namespace plugin {
 namespace sandnet {
 
 using std::string;
-using std::map;
 using std::vector;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::MACAddress;
 using ola::network::NetworkToHost;
+using ola::network::UDPPacketBuilder;
 using ola::network::UDPSocket;
 using ola::Callback0;
 
@@ -64,6 +64,9 @@ SandNetNode::SandNetNode(const string &ip_address)
     m_ports[i].group = 0;
     m_ports[i].universe = i;
   }
+  for (unsigned int i = 0; i < UNIVERSES_PER_GROUP; i++) {
+    m_handlers[i] = NULL;
+  }
 }
 
 
@@ -73,11 +76,16 @@ SandNetNode::SandNetNode(const string &ip_address)
 SandNetNode::~SandNetNode() {
   Stop();
 
-  universe_handlers::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
+  for (unsigned int group = 0; group < UNIVERSES_PER_GROUP; group++) {
+    if (!m_handlers[group]) {
+      continue;
+    }
+    for (unsigned int i = 0; i < UNIVERSES_PER_GROUP; i++) {
+      delete (*m_handlers[group])[i].closure;
+    }
+    delete[] m_handlers[group];
+    m_handlers[group] = NULL;
   }
-  m_handlers.clear();
 }
 
 
@@ -200,19 +208,21 @@ bool SandNetNode::SetHandler(uint8_t group, uint8_t universe,
     return false;
   }
 
-  group_universe_pair key(group, universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
+  if (!m_handlers[group]) {
+    m_handlers[group] = new group_handlers[1];
+    for (unsigned int i = 0; i < UNIVERSES_PER_GROUP; i++) {
+      (*m_handlers[group])[i].buffer = NULL;
+      (*m_handlers[group])[i].closure = NULL;
+    }
+  }
 
-  if (iter == m_handlers.end()) {
-    universe_handler handler;
+  universe_handler &handler = (*m_handlers[group])[universe];
+  Callback0<void> *old_closure = handler.closure;
+  if (!old_closure) {
     handler.buffer = buffer;
-    handler.closure = closure;
-    m_handlers[key] = handler;
-  } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    delete old_closure;
   }
+  handler.closure = closure;
+  delete old_closure;
   return true;
 }
 
@@ -223,16 +233,16 @@ bool SandNetNode::SetHandler(uint8_t group, uint8_t universe,
  * @param true if removed, false if it didn't exist
  */
 bool SandNetNode::RemoveHandler(uint8_t group, uint8_t universe) {
-  group_universe_pair key(group, universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
-    m_handlers.erase(iter);
-    delete old_closure;
-    return true;
+  universe_handler *handler = FindHandler(group, universe);
+  if (!handler) {
+    return false;
   }
-  return false;
+
+  Callback0<void> *old_closure = handler->closure;
+  handler->buffer = NULL;
+  handler->closure = NULL;
+  delete old_closure;
+  return true;
 }
 
 
@@ -376,6 +386,21 @@ bool SandNetNode::InitNetwork() {
 }
 
 
+/*
+ * Find the handler for a group & universe.
+ * @returns the handler, or NULL if there isn't one.
+ */
+SandNetNode::universe_handler *SandNetNode::FindHandler(
+    uint8_t group,
+    uint8_t universe) const {
+  if (!m_handlers[group]) {
+    return NULL;
+  }
+  universe_handler *handler = &(*m_handlers[group])[universe];
+  return handler->closure ? handler : NULL;
+}
+
+
 /*
  * Handle a compressed DMX packet
  */
@@ -389,21 +414,20 @@ bool SandNetNode::HandleCompressedDMX(const sandnet_compressed_dmx &dmx_packet,
     return false;
   }
 
-  group_universe_pair key(dmx_packet.group, dmx_packet.universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter == m_handlers.end()) {
+  universe_handler *handler = FindHandler(dmx_packet.group,
+                                          dmx_packet.universe);
+  if (!handler) {
     return false;
   }
 
   unsigned int data_size = size - header_size;
-  bool r = m_encoder.Decode(0, dmx_packet.dmx, data_size, iter->second.buffer);
+  bool r = m_encoder.Decode(0, dmx_packet.dmx, data_size, handler->buffer);
   if (!r) {
     OLA_WARN << "Failed to decode Sandnet Data";
     return false;
   }
 
-  iter->second.closure->Run();
+  handler->closure->Run();
   return true;
 }
 
@@ -420,16 +444,15 @@ bool SandNetNode::HandleDMX(const sandnet_dmx &dmx_packet,
     return false;
   }
 
-  group_universe_pair key(dmx_packet.group, dmx_packet.universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter == m_handlers.end()) {
+  universe_handler *handler = FindHandler(dmx_packet.group,
+                                          dmx_packet.universe);
+  if (!handler) {
     return false;
   }
 
   unsigned int data_size = size - header_size;
-  iter->second.buffer->Set(dmx_packet.dmx, data_size);
-  iter->second.closure->Run();
+  handler->buffer->Set(dmx_packet.dmx, data_size);
+  handler->closure->Run();
   return true;
 }
 
@@ -447,11 +470,13 @@ bool SandNetNode::SendUncompressedDMX(uint8_t port_id,
   dmx_packet->universe = m_ports[port_id].universe;
   dmx_packet->port = port_id;
 
-  unsigned int length = DMX_UNIVERSE_SIZE;
-  buffer.Get(dmx_packet->dmx, &length);
-
+  // Send the DMX data from the buffer, rather than copying it into the
+  // packet.
   unsigned int header_size = sizeof(sandnet_dmx) - sizeof(dmx_packet->dmx);
-  return SendPacket(packet, sizeof(packet.opcode) + header_size + length);
+  UDPPacketBuilder builder;
+  builder.Append(&packet, sizeof(packet.opcode) + header_size);
+  builder.AppendDMX(buffer);
+  return builder.SendTo(&m_data_socket, m_data_addr);
 }
 
 
@@ -21,10 +21,8 @@
 #ifndef PLUGINS_SANDNET_SANDNETNODE_H_
 #define PLUGINS_SANDNET_SANDNETNODE_H_
 
-#include <map>
 #include <string>
 #include <vector>
-#include <utility>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/network/IPV4Address.h"
@@ -86,10 +84,13 @@ class SandNetNode {
       Callback0<void> *closure;
     } universe_handler;
 
-    typedef std::pair<uint8_t, uint8_t> group_universe_pair;
-    typedef std::map<group_universe_pair, universe_handler> universe_handlers;
+    enum { UNIVERSES_PER_GROUP = 256 };
+
+    // A table of handlers for one group, indexed by universe.
+    typedef universe_handler group_handlers[UNIVERSES_PER_GROUP];
 
     bool InitNetwork();
+    universe_handler *FindHandler(uint8_t group, uint8_t universe) const;
 
     bool HandleCompressedDMX(const sandnet_compressed_dmx &dmx_packet,
                              unsigned int size);
@@ -106,7 +107,9 @@ class SandNetNode {
     std::string m_preferred_ip;
 
     sandnet_port m_ports[SANDNET_MAX_PORTS];
-    universe_handlers m_handlers;
+    // Indexed by group, the tables are allocated when the first handler in a
+    // group is set.
+    group_handlers *m_handlers[UNIVERSES_PER_GROUP];
     ola::network::Interface m_interface;
     ola::network::UDPSocket m_control_socket;
     ola::network::UDPSocket m_data_socket;
@@ -30,6 +30,7 @@
 #include <ola/Constants.h>
 #include "ola/network/IPV4Address.h"
 #include "ola/network/MACAddress.h"
+#include "ola/network/WireLayout.h"
 #include "plugins/sandnet/SandNetCommon.h"
 
 namespace ola {
@@ -226,6 +227,18 @@ struct sandnet_packet {
     sandnet_compressed_dmx  compressed_dmx;
   } contents;
 });
+
+// Check the layouts match what the nodes send.
+WIRE_SIZE_ASSERT(sandnet_packet_advertisement_port_s, 59);
+WIRE_SIZE_ASSERT(sandnet_advertisement,
+                 86 + 59 * SANDNET_MAX_PORTS + SANDNET_NAME_LENGTH);
+WIRE_SIZE_ASSERT(sandnet_dmx, 3 + DMX_UNIVERSE_SIZE);
+WIRE_SIZE_ASSERT(sandnet_port_control, 10 + 59 * SANDNET_MAX_PORTS);
+WIRE_SIZE_ASSERT(sandnet_name, 7 + SANDNET_NAME_LENGTH);
+WIRE_SIZE_ASSERT(sandnet_program, 15);
+WIRE_SIZE_ASSERT(sandnet_led, 7);
+WIRE_SIZE_ASSERT(sandnet_compressed_dmx, 10 + DMX_UNIVERSE_SIZE);
+WIRE_OFFSET_ASSERT(sandnet_packet, contents, 2);
 }  // namespace sandnet
 }  // namespace plugin
 }  // namespace ola
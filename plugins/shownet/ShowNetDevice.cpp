@@ -22,6 +22,7 @@
 #include <string>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/network/NetworkUtils.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
@@ -38,6 +39,7 @@ using std::ostringstream;
 
 const char ShowNetDevice::SHOWNET_DEVICE_NAME[] = "ShowNet";
 const char ShowNetDevice::IP_KEY[] = "ip";
+const char ShowNetDevice::MAX_FRAME_RATE_KEY[] = "max_frame_rate";
 
 
 /*
@@ -58,6 +60,9 @@ ShowNetDevice::ShowNetDevice(ola::Plugin *owner,
 bool ShowNetDevice::StartHook() {
   m_node = new ShowNetNode(m_preferences->GetValue(IP_KEY));
   m_node->SetName(m_preferences->GetValue("name"));
+  m_node->SetReceiveStats(
+      m_plugin_adaptor->GetExportMap()->GetReceiveStatsMapVar(
+          "shownet-receive-stats", "universe"));
 
   if (!m_node->Start()) {
     delete m_node;
@@ -72,6 +77,12 @@ bool ShowNetDevice::StartHook() {
   SetName(str.str());
 
 
+  unsigned int max_frame_rate;
+  if (!StringToInt(m_preferences->GetValue(MAX_FRAME_RATE_KEY),
+                   &max_frame_rate)) {
+    max_frame_rate = 0;
+  }
+
   for (unsigned int i = 0; i < ShowNetNode::SHOWNET_MAX_UNIVERSES; i++) {
     ShowNetInputPort *input_port = new ShowNetInputPort(
         this,
@@ -79,7 +90,8 @@ bool ShowNetDevice::StartHook() {
         m_plugin_adaptor,
         m_node);
     AddPort(input_port);
-    ShowNetOutputPort *output_port = new ShowNetOutputPort(this, i, m_node);
+    ShowNetOutputPort *output_port = new ShowNetOutputPort(
+        this, i, m_node, m_plugin_adaptor, max_frame_rate);
     AddPort(output_port);
   }
 
@@ -41,6 +41,7 @@ class ShowNetDevice: public ola::Device {
     std::string DeviceId() const { return "1"; }
 
     static const char IP_KEY[];
+    static const char MAX_FRAME_RATE_KEY[];
 
  protected:
     bool StartHook();
@@ -20,10 +20,12 @@
 
 #include <string.h>
 #include <algorithm>
+#include <memory>
 #include <map>
 #include <string>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Array.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
@@ -53,12 +55,14 @@ using ola::Callback0;
  * @param ip_address the IP address to prefer to listen on, if NULL we choose
  * one.
  */
-ShowNetNode::ShowNetNode(const std::string &ip_address)
+ShowNetNode::ShowNetNode(const std::string &ip_address,
+                         ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_packet_count(0),
       m_node_name(),
       m_preferred_ip(ip_address),
-      m_socket(NULL) {
+      m_socket(socket),
+      m_stats(NULL) {
 }
 
 
@@ -110,11 +114,7 @@ bool ShowNetNode::Stop() {
     return false;
   }
 
-  if (m_socket) {
-    delete m_socket;
-    m_socket = NULL;
-  }
-
+  m_socket.reset();
   m_running = false;
   return true;
 }
@@ -184,6 +184,7 @@ bool ShowNetNode::SetHandler(unsigned int universe,
     universe_handler handler;
     handler.buffer = buffer;
     handler.closure = closure;
+    handler.stats = m_stats ? m_stats->Get(IntToString(universe)) : NULL;
     m_handlers[universe] = handler;
   } else {
     Callback0<void> *old_closure = iter->second.closure;
@@ -213,6 +214,19 @@ bool ShowNetNode::RemoveHandler(unsigned int universe) {
 }
 
 
+/*
+ * Start recording receive statistics
+ */
+void ShowNetNode::SetReceiveStats(ola::ReceiveStatsMap *stats) {
+  m_stats = stats;
+  map<unsigned int, universe_handler>::iterator iter = m_handlers.begin();
+  for (; iter != m_handlers.end(); ++iter) {
+    iter->second.stats = m_stats ? m_stats->Get(IntToString(iter->first)) :
+                                   NULL;
+  }
+}
+
+
 /*
  * Called when there is data on this socket
  */
@@ -302,6 +316,12 @@ bool ShowNetNode::HandleCompressedPacket(const shownet_compressed_dmx *packet,
     return false;
   }
 
+  if (handler->stats) {
+    TimeStamp now;
+    m_clock.CurrentMonotonicTime(&now);
+    handler->stats->PacketReceived(now);
+  }
+
   if (slot_size != enc_len) {
     m_encoder.Decode(start_channel, packet->data + data_offset,
                      enc_len, handler->buffer);
@@ -355,27 +375,28 @@ unsigned int ShowNetNode::BuildCompressedPacket(shownet_packet *packet,
  * Setup the networking components.
  */
 bool ShowNetNode::InitNetwork() {
-  m_socket = new UDPSocket();
+  std::auto_ptr<ola::network::UDPSocketInterface> socket(m_socket.release());
+  if (!socket.get()) {
+    socket.reset(new UDPSocket());
+  }
 
-  if (!m_socket->Init()) {
+  if (!socket->Init()) {
     OLA_WARN << "Socket init failed";
-    delete m_socket;
     return false;
   }
 
-  if (!m_socket->Bind(IPV4SocketAddress(IPV4Address::WildCard(),
-                                        SHOWNET_PORT))) {
-    delete m_socket;
+  if (!socket->Bind(IPV4SocketAddress(IPV4Address::WildCard(),
+                                      SHOWNET_PORT))) {
     return false;
   }
 
-  if (!m_socket->EnableBroadcast()) {
+  if (!socket->EnableBroadcast()) {
     OLA_WARN << "Failed to enable broadcasting";
-    delete m_socket;
     return false;
   }
 
-  m_socket->SetOnData(NewCallback(this, &ShowNetNode::SocketReady));
+  socket->SetOnData(NewCallback(this, &ShowNetNode::SocketReady));
+  m_socket.reset(socket.release());
   return true;
 }
 }  // namespace shownet
@@ -21,11 +21,15 @@
 #ifndef PLUGINS_SHOWNET_SHOWNETNODE_H_
 #define PLUGINS_SHOWNET_SHOWNETNODE_H_
 
+#include <memory>
 #include <string>
 #include <map>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/ReceiveStats.h"
 #include "ola/dmx/RunLengthEncoder.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
@@ -37,7 +41,12 @@ namespace shownet {
 
 class ShowNetNode {
  public:
-    explicit ShowNetNode(const std::string &ip_address);
+    /*
+     * Create a new node. If socket is NULL a UDPSocket is created, otherwise
+     * ownership of the socket is transferred.
+     */
+    explicit ShowNetNode(const std::string &ip_address,
+                         ola::network::UDPSocketInterface *socket = NULL);
     virtual ~ShowNetNode();
 
     bool Start();
@@ -50,11 +59,18 @@ class ShowNetNode {
                     ola::Callback0<void> *handler);
     bool RemoveHandler(unsigned int universe);
 
+    /*
+     * Record receive statistics for each universe, ownership of the map is
+     * not transferred. ShowNet doesn't use sequence numbers, so only the
+     * packet counts and jitter are tracked.
+     */
+    void SetReceiveStats(ola::ReceiveStatsMap *stats);
+
     const ola::network::Interface &GetInterface() const {
       return m_interface;
     }
 
-    ola::network::UDPSocket* GetSocket() { return m_socket; }
+    ola::network::UDPSocketInterface* GetSocket() { return m_socket.get(); }
     void SocketReady();
 
     static const uint16_t SHOWNET_MAX_UNIVERSES = 8;
@@ -65,6 +81,7 @@ class ShowNetNode {
     typedef struct {
       DmxBuffer *buffer;
       Callback0<void> *closure;
+      ola::dmx::ReceiveStats *stats;
     } universe_handler;
 
     bool m_running;
@@ -74,7 +91,9 @@ class ShowNetNode {
     std::map<unsigned int, universe_handler> m_handlers;
     ola::network::Interface m_interface;
     ola::dmx::RunLengthEncoder m_encoder;
-    ola::network::UDPSocket *m_socket;
+    std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+    ola::ReceiveStatsMap *m_stats;
+    ola::Clock m_clock;
 
     bool HandlePacket(const shownet_packet *packet, unsigned int size);
     bool HandleCompressedPacket(const shownet_compressed_dmx *packet,
@@ -30,6 +30,7 @@
 #include "ola/Constants.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/MACAddress.h"
+#include "ola/network/WireLayout.h"
 
 namespace ola {
 namespace plugin {
@@ -94,6 +95,12 @@ typedef struct {
   } data;
 } shownet_packet;
 
+
+// Check the layouts match what the consoles send.
+WIRE_SIZE_ASSERT(shownet_dmx, 58 + SHOWNET_DMX_DATA_LENGTH);
+WIRE_SIZE_ASSERT(shownet_compressed_dmx, 41 + SHOWNET_COMPRESSED_DATA_LENGTH);
+WIRE_OFFSET_ASSERT(shownet_compressed_dmx, name, 32);
+WIRE_OFFSET_ASSERT(shownet_packet, data, 6);
 }  // namespace shownet
 }  // namespace plugin
 }  // namespace ola
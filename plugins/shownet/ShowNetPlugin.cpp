@@ -91,6 +91,8 @@ bool ShowNetPlugin::SetDefaultPreferences() {
                                          StringValidator(true), "");
   save |= m_preferences->SetDefaultValue(SHOWNET_NAME_KEY, StringValidator(),
                                          SHOWNET_NODE_NAME);
+  save |= m_preferences->SetDefaultValue(ShowNetDevice::MAX_FRAME_RATE_KEY,
+                                         UIntValidator(0, MAX_FRAME_RATE), 0);
 
   if (save) {
     m_preferences->Save();
@@ -42,6 +42,7 @@ class ShowNetPlugin: public Plugin {
     ola_plugin_id Id() const { return OLA_PLUGIN_SHOWNET; }
     std::string Description() const;
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreading() const { return true; }
 
  private:
     bool StartHook();
@@ -53,6 +54,7 @@ class ShowNetPlugin: public Plugin {
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char SHOWNET_NAME_KEY[];
+    static const unsigned int MAX_FRAME_RATE = 1000;
 };
 }  // namespace shownet
 }  // namespace plugin
@@ -95,8 +95,8 @@ bool ShowNetOutputPort::PreSetUniverse(OLA_UNUSED Universe *old_universe,
 }
 
 
-bool ShowNetOutputPort::WriteDMX(const DmxBuffer &buffer,
-                                 OLA_UNUSED uint8_t priority) {
+bool ShowNetOutputPort::SendDMX(const DmxBuffer &buffer,
+                                OLA_UNUSED uint8_t priority) {
   return !m_node->SendDMX(PortId(), buffer);
 }
 }  // namespace shownet
@@ -51,18 +51,22 @@ class ShowNetInputPort: public BasicInputPort {
 };
 
 
-class ShowNetOutputPort: public BasicOutputPort {
+class ShowNetOutputPort: public RateLimitedOutputPort {
  public:
   ShowNetOutputPort(ShowNetDevice *parent,
                     unsigned int id,
-                    ShowNetNode *node):
-    BasicOutputPort(parent, id),
+                    ShowNetNode *node,
+                    PluginAdaptor *plugin_adaptor,
+                    unsigned int max_frame_rate):
+    RateLimitedOutputPort(parent, id, plugin_adaptor, max_frame_rate),
     m_node(node) {}
   ~ShowNetOutputPort() {}
 
   bool PreSetUniverse(Universe *old_universe, Universe *new_universe);
   std::string Description() const;
-  bool WriteDMX(const ola::DmxBuffer &buffer, uint8_t priority);
+
+ protected:
+  bool SendDMX(const ola::DmxBuffer &buffer, uint8_t priority);
 
  private:
   ShowNetNode *m_node;
@@ -0,0 +1,393 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelKernels.cpp
+ * Vectorized conversions from RGB DMX data to the SPI pixel formats.
+ * Copyright (C) 2026 Open Lighting Project
+ *
+ * This follows the same approach as common/dmx/SlotKernels.cpp. The x86
+ * kernels are built with function level target attributes and picked at
+ * runtime, the NEON kernels are selected at compile time.
+ */
+
+#include <stdint.h>
+
+#include "plugins/spi/PixelKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OLA_PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OLA_PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif  // x86 or NEON
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+namespace {
+
+typedef void (*ConversionKernel)(const uint8_t *input, unsigned int pixels,
+                                 uint8_t *output);
+
+typedef struct {
+  PixelKernelImpl impl;
+  ConversionKernel rgb_to_lpd8806;
+  ConversionKernel rgb_to_p9813;
+  ConversionKernel rgb_to_apa102;
+  ConversionKernel brgb_to_apa102;
+} KernelTable;
+
+const uint8_t APA102_START_MARK = 0xe0;
+
+// Scalar implementations, these are also used to handle the tail of the
+// vectorized versions.
+void ScalarLPD8806(const uint8_t *input, unsigned int pixels,
+                   uint8_t *output) {
+  for (unsigned int i = 0; i < pixels; i++) {
+    const uint8_t *in = input + 3 * i;
+    uint8_t *out = output + 3 * i;
+    out[0] = 0x80 | (in[1] >> 1);
+    out[1] = 0x80 | (in[0] >> 1);
+    out[2] = 0x80 | (in[2] >> 1);
+  }
+}
+
+void ScalarP9813(const uint8_t *input, unsigned int pixels,
+                 uint8_t *output) {
+  for (unsigned int i = 0; i < pixels; i++) {
+    const uint8_t *in = input + 3 * i;
+    uint8_t *out = output + 4 * i;
+    out[0] = P9813Flag(in[0], in[1], in[2]);
+    out[1] = in[2];
+    out[2] = in[1];
+    out[3] = in[0];
+  }
+}
+
+void ScalarAPA102(const uint8_t *input, unsigned int pixels,
+                  uint8_t *output) {
+  for (unsigned int i = 0; i < pixels; i++) {
+    const uint8_t *in = input + 3 * i;
+    uint8_t *out = output + 4 * i;
+    out[0] = 0xff;
+    out[1] = in[2];
+    out[2] = in[1];
+    out[3] = in[0];
+  }
+}
+
+void ScalarBRGBToAPA102(const uint8_t *input, unsigned int pixels,
+                        uint8_t *output) {
+  for (unsigned int i = 0; i < pixels; i++) {
+    const uint8_t *in = input + 4 * i;
+    uint8_t *out = output + 4 * i;
+    out[0] = APA102_START_MARK | (in[0] >> 3);
+    out[1] = in[3];
+    out[2] = in[2];
+    out[3] = in[1];
+  }
+}
+
+const KernelTable kScalarKernels = {
+  PIXEL_KERNELS_SCALAR,
+  ScalarLPD8806,
+  ScalarP9813,
+  ScalarAPA102,
+  ScalarBRGBToAPA102,
+};
+
+#ifdef OLA_PIXEL_KERNELS_X86
+/*
+ * The RGB kernels load 16 bytes at a time, so they stop while there are
+ * still at least 16 bytes of input left, and leave the rest to the scalar
+ * version.
+ */
+__attribute__((target("ssse3")))
+void SSSE3LPD8806(const uint8_t *input, unsigned int pixels,
+                  uint8_t *output) {
+  // 5 pixels per block, the last byte is rewritten by the next block.
+  const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 4, 3, 5, 7, 6, 8,
+                                        10, 9, 11, 13, 12, 14, 15);
+  const __m128i low_bits = _mm_set1_epi8(0x7f);
+  const __m128i high_bit = _mm_set1_epi8(static_cast<char>(0x80));
+  unsigned int i = 0;
+  for (; i + 6 <= pixels; i += 5) {
+    __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input + 3 * i));
+    v = _mm_shuffle_epi8(v, shuffle);
+    v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 1), low_bits),
+                     high_bit);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 3 * i), v);
+  }
+  ScalarLPD8806(input + 3 * i, pixels - i, output + 3 * i);
+}
+
+/*
+ * Expand 4 RGB pixels into 4 byte pixels of (0, B, G, R).
+ */
+__attribute__((target("ssse3")))
+inline __m128i SSSE3ExpandBGR(__m128i v) {
+  const __m128i shuffle = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3,
+                                        -1, 8, 7, 6, -1, 11, 10, 9);
+  return _mm_shuffle_epi8(v, shuffle);
+}
+
+__attribute__((target("ssse3")))
+void SSSE3P9813(const uint8_t *input, unsigned int pixels,
+                uint8_t *output) {
+  // Move one of the colors into the first byte of each pixel
+  const __m128i red = _mm_setr_epi8(0, -1, -1, -1, 3, -1, -1, -1,
+                                    6, -1, -1, -1, 9, -1, -1, -1);
+  const __m128i green = _mm_setr_epi8(1, -1, -1, -1, 4, -1, -1, -1,
+                                      7, -1, -1, -1, 10, -1, -1, -1);
+  const __m128i blue = _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1,
+                                     8, -1, -1, -1, 11, -1, -1, -1);
+  const __m128i high_bits = _mm_set1_epi32(0xc0);
+  const __m128i flag_mask = _mm_set1_epi32(0xff);
+
+  unsigned int i = 0;
+  for (; i + 6 <= pixels; i += 4) {
+    __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input + 3 * i));
+    // The other byte in each 16 bit lane is 0, so the shifts don't carry.
+    __m128i flag = _mm_srli_epi16(
+        _mm_and_si128(_mm_shuffle_epi8(v, red), high_bits), 6);
+    flag = _mm_or_si128(flag, _mm_srli_epi16(
+        _mm_and_si128(_mm_shuffle_epi8(v, green), high_bits), 4));
+    flag = _mm_or_si128(flag, _mm_srli_epi16(
+        _mm_and_si128(_mm_shuffle_epi8(v, blue), high_bits), 2));
+    flag = _mm_xor_si128(flag, flag_mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4 * i),
+                     _mm_or_si128(SSSE3ExpandBGR(v), flag));
+  }
+  ScalarP9813(input + 3 * i, pixels - i, output + 4 * i);
+}
+
+__attribute__((target("ssse3")))
+void SSSE3APA102(const uint8_t *input, unsigned int pixels,
+                 uint8_t *output) {
+  const __m128i header = _mm_set1_epi32(0xff);
+  unsigned int i = 0;
+  for (; i + 6 <= pixels; i += 4) {
+    __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input + 3 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4 * i),
+                     _mm_or_si128(SSSE3ExpandBGR(v), header));
+  }
+  ScalarAPA102(input + 3 * i, pixels - i, output + 4 * i);
+}
+
+__attribute__((target("ssse3")))
+void SSSE3BRGBToAPA102(const uint8_t *input, unsigned int pixels,
+                       uint8_t *output) {
+  const __m128i shuffle = _mm_setr_epi8(0, 3, 2, 1, 4, 7, 6, 5,
+                                        8, 11, 10, 9, 12, 15, 14, 13);
+  const __m128i brightness_mask = _mm_set1_epi32(0xff);
+  const __m128i start_mark = _mm_set1_epi32(APA102_START_MARK);
+  unsigned int i = 0;
+  for (; i + 4 <= pixels; i += 4) {
+    __m128i v = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 4 * i)),
+        shuffle);
+    __m128i brightness = _mm_srli_epi16(
+        _mm_and_si128(v, brightness_mask), 3);
+    v = _mm_or_si128(_mm_andnot_si128(brightness_mask, v),
+                     _mm_or_si128(brightness, start_mark));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4 * i), v);
+  }
+  ScalarBRGBToAPA102(input + 4 * i, pixels - i, output + 4 * i);
+}
+
+const KernelTable kSSSE3Kernels = {
+  PIXEL_KERNELS_SSSE3,
+  SSSE3LPD8806,
+  SSSE3P9813,
+  SSSE3APA102,
+  SSSE3BRGBToAPA102,
+};
+#endif  // OLA_PIXEL_KERNELS_X86
+
+#ifdef OLA_PIXEL_KERNELS_NEON
+/*
+ * The NEON kernels use the interleaved loads & stores, which split 16 pixels
+ * into one register per color.
+ */
+void NEONLPD8806(const uint8_t *input, unsigned int pixels,
+                 uint8_t *output) {
+  const uint8x16_t high_bit = vdupq_n_u8(0x80);
+  unsigned int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    uint8x16x3_t in = vld3q_u8(input + 3 * i);
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshrq_n_u8(in.val[1], 1), high_bit);
+    out.val[1] = vorrq_u8(vshrq_n_u8(in.val[0], 1), high_bit);
+    out.val[2] = vorrq_u8(vshrq_n_u8(in.val[2], 1), high_bit);
+    vst3q_u8(output + 3 * i, out);
+  }
+  ScalarLPD8806(input + 3 * i, pixels - i, output + 3 * i);
+}
+
+void NEONP9813(const uint8_t *input, unsigned int pixels, uint8_t *output) {
+  const uint8x16_t high_bits = vdupq_n_u8(0xc0);
+  unsigned int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    uint8x16x3_t in = vld3q_u8(input + 3 * i);
+    uint8x16_t flag = vshrq_n_u8(vandq_u8(in.val[0], high_bits), 6);
+    flag = vorrq_u8(flag, vshrq_n_u8(vandq_u8(in.val[1], high_bits), 4));
+    flag = vorrq_u8(flag, vshrq_n_u8(vandq_u8(in.val[2], high_bits), 2));
+    uint8x16x4_t out;
+    out.val[0] = vmvnq_u8(flag);
+    out.val[1] = in.val[2];
+    out.val[2] = in.val[1];
+    out.val[3] = in.val[0];
+    vst4q_u8(output + 4 * i, out);
+  }
+  ScalarP9813(input + 3 * i, pixels - i, output + 4 * i);
+}
+
+void NEONAPA102(const uint8_t *input, unsigned int pixels, uint8_t *output) {
+  unsigned int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    uint8x16x3_t in = vld3q_u8(input + 3 * i);
+    uint8x16x4_t out;
+    out.val[0] = vdupq_n_u8(0xff);
+    out.val[1] = in.val[2];
+    out.val[2] = in.val[1];
+    out.val[3] = in.val[0];
+    vst4q_u8(output + 4 * i, out);
+  }
+  ScalarAPA102(input + 3 * i, pixels - i, output + 4 * i);
+}
+
+void NEONBRGBToAPA102(const uint8_t *input, unsigned int pixels,
+                      uint8_t *output) {
+  const uint8x16_t start_mark = vdupq_n_u8(APA102_START_MARK);
+  unsigned int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    uint8x16x4_t in = vld4q_u8(input + 4 * i);
+    uint8x16x4_t out;
+    out.val[0] = vorrq_u8(vshrq_n_u8(in.val[0], 3), start_mark);
+    out.val[1] = in.val[3];
+    out.val[2] = in.val[2];
+    out.val[3] = in.val[1];
+    vst4q_u8(output + 4 * i, out);
+  }
+  ScalarBRGBToAPA102(input + 4 * i, pixels - i, output + 4 * i);
+}
+
+const KernelTable kNEONKernels = {
+  PIXEL_KERNELS_NEON,
+  NEONLPD8806,
+  NEONP9813,
+  NEONAPA102,
+  NEONBRGBToAPA102,
+};
+#endif  // OLA_PIXEL_KERNELS_NEON
+
+const KernelTable *TableFor(PixelKernelImpl impl) {
+  switch (impl) {
+    case PIXEL_KERNELS_SCALAR:
+      return &kScalarKernels;
+#ifdef OLA_PIXEL_KERNELS_X86
+    case PIXEL_KERNELS_SSSE3:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("ssse3") ? &kSSSE3Kernels : NULL;
+#endif  // OLA_PIXEL_KERNELS_X86
+#ifdef OLA_PIXEL_KERNELS_NEON
+    case PIXEL_KERNELS_NEON:
+      return &kNEONKernels;
+#endif  // OLA_PIXEL_KERNELS_NEON
+    default:
+      return NULL;
+  }
+}
+
+const KernelTable *DetectKernels() {
+  const PixelKernelImpl preferred[] = {
+    PIXEL_KERNELS_SSSE3,
+    PIXEL_KERNELS_NEON,
+  };
+  for (unsigned int i = 0; i < sizeof(preferred) / sizeof(preferred[0]);
+       i++) {
+    const KernelTable *table = TableFor(preferred[i]);
+    if (table) {
+      return table;
+    }
+  }
+  return &kScalarKernels;
+}
+
+const KernelTable *active_kernels = NULL;
+
+inline const KernelTable *Kernels() {
+  if (!active_kernels) {
+    active_kernels = DetectKernels();
+  }
+  return active_kernels;
+}
+}  // namespace
+
+void RGBToLPD8806(const uint8_t *input, unsigned int pixels,
+                  uint8_t *output) {
+  Kernels()->rgb_to_lpd8806(input, pixels, output);
+}
+
+void RGBToP9813(const uint8_t *input, unsigned int pixels, uint8_t *output) {
+  Kernels()->rgb_to_p9813(input, pixels, output);
+}
+
+void RGBToAPA102(const uint8_t *input, unsigned int pixels, uint8_t *output) {
+  Kernels()->rgb_to_apa102(input, pixels, output);
+}
+
+void BRGBToAPA102(const uint8_t *input, unsigned int pixels,
+                  uint8_t *output) {
+  Kernels()->brgb_to_apa102(input, pixels, output);
+}
+
+bool PixelKernelsSupported(PixelKernelImpl impl) {
+  return TableFor(impl) != NULL;
+}
+
+PixelKernelImpl ActivePixelKernels() {
+  return Kernels()->impl;
+}
+
+bool SetPixelKernels(PixelKernelImpl impl) {
+  const KernelTable *table = TableFor(impl);
+  if (!table) {
+    return false;
+  }
+  active_kernels = table;
+  return true;
+}
+
+const char *PixelKernelName(PixelKernelImpl impl) {
+  switch (impl) {
+    case PIXEL_KERNELS_SCALAR:
+      return "scalar";
+    case PIXEL_KERNELS_SSSE3:
+      return "ssse3";
+    case PIXEL_KERNELS_NEON:
+      return "neon";
+    default:
+      return "unknown";
+  }
+}
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelKernels.h
+ * Vectorized conversions from RGB DMX data to the SPI pixel formats.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef PLUGINS_SPI_PIXELKERNELS_H_
+#define PLUGINS_SPI_PIXELKERNELS_H_
+
+#include <stdint.h>
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+/**
+ * @brief The implementations of the pixel kernels.
+ */
+typedef enum {
+  PIXEL_KERNELS_SCALAR,  /**< Plain C++ loops */
+  PIXEL_KERNELS_SSSE3,  /**< x86 SSSE3 */
+  PIXEL_KERNELS_NEON,  /**< ARM NEON */
+} PixelKernelImpl;
+
+/**
+ * @brief Convert RGB pixels to LPD8806 pixels.
+ *
+ * LPD8806 pixels are 3 bytes, GRB order, with 7 bits of color and the high
+ * bit set.
+ * @param input the RGB data, 3 * pixels bytes.
+ * @param pixels the number of pixels to convert.
+ * @param output the output buffer, 3 * pixels bytes.
+ */
+void RGBToLPD8806(const uint8_t *input, unsigned int pixels,
+                  uint8_t *output);
+
+/**
+ * @brief Convert RGB pixels to P9813 pixels.
+ *
+ * P9813 pixels are 4 bytes, a flag byte made from the inverted high bits of
+ * each color, followed by BGR.
+ * @param input the RGB data, 3 * pixels bytes.
+ * @param pixels the number of pixels to convert.
+ * @param output the output buffer, 4 * pixels bytes.
+ */
+void RGBToP9813(const uint8_t *input, unsigned int pixels, uint8_t *output);
+
+/**
+ * @brief Convert RGB pixels to APA102 pixels at full brightness.
+ *
+ * APA102 pixels are 4 bytes, 0xff followed by BGR.
+ * @param input the RGB data, 3 * pixels bytes.
+ * @param pixels the number of pixels to convert.
+ * @param output the output buffer, 4 * pixels bytes.
+ */
+void RGBToAPA102(const uint8_t *input, unsigned int pixels, uint8_t *output);
+
+/**
+ * @brief Convert brightness + RGB pixels to APA102 pixels.
+ *
+ * The first byte of each output pixel is the start mark (0xe0) combined with
+ * the top 5 bits of the brightness, followed by BGR.
+ * @param input the brightness + RGB data, 4 * pixels bytes.
+ * @param pixels the number of pixels to convert.
+ * @param output the output buffer, 4 * pixels bytes.
+ */
+void BRGBToAPA102(const uint8_t *input, unsigned int pixels,
+                  uint8_t *output);
+
+/**
+ * @brief Calculate the P9813 flag byte for a pixel.
+ */
+inline uint8_t P9813Flag(uint8_t red, uint8_t green, uint8_t blue) {
+  return ~(((red & 0xc0) >> 6) | ((green & 0xc0) >> 4) |
+           ((blue & 0xc0) >> 2));
+}
+
+/**
+ * @brief Check if an implementation can be used on this CPU.
+ */
+bool PixelKernelsSupported(PixelKernelImpl impl);
+
+/**
+ * @brief Return the implementation currently in use.
+ *
+ * The default is picked the first time the kernels are used, based on the
+ * features of the CPU we're running on.
+ */
+PixelKernelImpl ActivePixelKernels();
+
+/**
+ * @brief Force a particular implementation.
+ *
+ * This is used by the tests. It's not thread safe, call it before any other
+ * threads are started.
+ * @returns true if the implementation was selected, false if it isn't
+ *   supported on this CPU.
+ */
+bool SetPixelKernels(PixelKernelImpl impl);
+
+/**
+ * @brief Return the name of an implementation, e.g. "ssse3".
+ */
+const char *PixelKernelName(PixelKernelImpl impl);
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPI_PIXELKERNELS_H_
@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelKernelsTest.cpp
+ * Test fixture for the SPI pixel conversion kernels.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+
+#include "ola/testing/TestUtils.h"
+#include "plugins/spi/PixelKernels.h"
+
+using ola::plugin::spi::BRGBToAPA102;
+using ola::plugin::spi::P9813Flag;
+using ola::plugin::spi::PixelKernelImpl;
+using ola::plugin::spi::RGBToAPA102;
+using ola::plugin::spi::RGBToLPD8806;
+using ola::plugin::spi::RGBToP9813;
+
+// Enough for the vector loops to run a few times.
+static const unsigned int MAX_PIXELS = 40;
+static const uint8_t GUARD = 0x5a;
+
+class PixelKernelsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PixelKernelsTest);
+  CPPUNIT_TEST(testLPD8806);
+  CPPUNIT_TEST(testP9813);
+  CPPUNIT_TEST(testAPA102);
+  CPPUNIT_TEST(testBRGBToAPA102);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void tearDown();
+    void testLPD8806();
+    void testP9813();
+    void testAPA102();
+    void testBRGBToAPA102();
+
+ private:
+    typedef void (*Kernel)(const uint8_t *input, unsigned int pixels,
+                           uint8_t *output);
+    typedef void (*Reference)(const uint8_t *input, uint8_t *output);
+
+    // One extra byte so we can test unaligned access.
+    uint8_t m_input[4 * MAX_PIXELS + 1];
+    PixelKernelImpl m_original_impl;
+
+    void CheckKernel(Kernel kernel, Reference reference,
+                     unsigned int input_size, unsigned int output_size);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelKernelsTest);
+
+static const PixelKernelImpl IMPLS[] = {
+  ola::plugin::spi::PIXEL_KERNELS_SCALAR,
+  ola::plugin::spi::PIXEL_KERNELS_SSSE3,
+  ola::plugin::spi::PIXEL_KERNELS_NEON,
+};
+
+/*
+ * Reference versions of a single pixel.
+ */
+static void LPD8806Pixel(const uint8_t *in, uint8_t *out) {
+  out[0] = 0x80 | (in[1] >> 1);
+  out[1] = 0x80 | (in[0] >> 1);
+  out[2] = 0x80 | (in[2] >> 1);
+}
+
+static void P9813Pixel(const uint8_t *in, uint8_t *out) {
+  out[0] = P9813Flag(in[0], in[1], in[2]);
+  out[1] = in[2];
+  out[2] = in[1];
+  out[3] = in[0];
+}
+
+static void APA102Pixel(const uint8_t *in, uint8_t *out) {
+  out[0] = 0xff;
+  out[1] = in[2];
+  out[2] = in[1];
+  out[3] = in[0];
+}
+
+static void BRGBPixel(const uint8_t *in, uint8_t *out) {
+  out[0] = 0xe0 | (in[0] >> 3);
+  out[1] = in[3];
+  out[2] = in[2];
+  out[3] = in[1];
+}
+
+
+void PixelKernelsTest::setUp() {
+  m_original_impl = ola::plugin::spi::ActivePixelKernels();
+  for (unsigned int i = 0; i < sizeof(m_input); i++) {
+    m_input[i] = (i * 37 + 11) & 0xff;
+  }
+}
+
+
+void PixelKernelsTest::tearDown() {
+  ola::plugin::spi::SetPixelKernels(m_original_impl);
+}
+
+
+/*
+ * Check a kernel against the reference for all lengths & both alignments.
+ * The bytes after the output must not be touched.
+ */
+void PixelKernelsTest::CheckKernel(Kernel kernel, Reference reference,
+                                   unsigned int input_size,
+                                   unsigned int output_size) {
+  for (unsigned int i = 0; i < sizeof(IMPLS) / sizeof(IMPLS[0]); i++) {
+    if (!ola::plugin::spi::SetPixelKernels(IMPLS[i])) {
+      continue;
+    }
+    const std::string name = ola::plugin::spi::PixelKernelName(IMPLS[i]);
+
+    for (unsigned int offset = 0; offset < 2; offset++) {
+      for (unsigned int pixels = 0; pixels <= MAX_PIXELS; pixels++) {
+        uint8_t output[4 * MAX_PIXELS + 1];
+        memset(output, GUARD, sizeof(output));
+        kernel(m_input + offset, pixels, output + offset);
+
+        for (unsigned int j = 0; j < offset; j++) {
+          OLA_ASSERT_EQ_MSG(GUARD, output[j], name);
+        }
+        for (unsigned int pixel = 0; pixel < pixels; pixel++) {
+          uint8_t expected[4];
+          reference(m_input + offset + pixel * input_size, expected);
+          for (unsigned int j = 0; j < output_size; j++) {
+            OLA_ASSERT_EQ_MSG(expected[j],
+                              output[offset + pixel * output_size + j],
+                              name);
+          }
+        }
+        for (unsigned int j = offset + pixels * output_size;
+             j < sizeof(output); j++) {
+          OLA_ASSERT_EQ_MSG(GUARD, output[j], name);
+        }
+      }
+    }
+  }
+}
+
+
+void PixelKernelsTest::testLPD8806() {
+  const uint8_t input[] = {0xff, 0x80, 0x01};
+  uint8_t output[3];
+  RGBToLPD8806(input, 1, output);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xc0), output[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xff), output[1]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0x80), output[2]);
+
+  CheckKernel(RGBToLPD8806, LPD8806Pixel, 3, 3);
+}
+
+
+void PixelKernelsTest::testP9813() {
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xff), P9813Flag(0, 0, 0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xc0), P9813Flag(0xff, 0xff, 0xff));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xfb), P9813Flag(0, 0x40, 0));
+
+  CheckKernel(RGBToP9813, P9813Pixel, 3, 4);
+}
+
+
+void PixelKernelsTest::testAPA102() {
+  CheckKernel(RGBToAPA102, APA102Pixel, 3, 4);
+}
+
+
+void PixelKernelsTest::testBRGBToAPA102() {
+  const uint8_t input[] = {0xff, 1, 2, 3};
+  uint8_t output[4];
+  BRGBToAPA102(input, 1, output);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xff), output[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(3), output[1]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), output[2]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), output[3]);
+
+  CheckKernel(BRGBToAPA102, BRGBPixel, 4, 4);
+}
@@ -19,13 +19,21 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include <errno.h>
 #include <fcntl.h>
+#ifdef HAVE_LINUX_GPIO_H
+#include <linux/gpio.h>
+#endif  // HAVE_LINUX_GPIO_H
 #include <linux/spi/spidev.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -61,13 +69,16 @@ uint8_t *HardwareBackend::OutputData::Resize(unsigned int length) {
     return m_data;
   }
 
-  delete[] m_data;
-  m_data = new uint8_t[length];
+  // Keep the existing data, the caller may only update part of the buffer.
+  uint8_t *data = new uint8_t[length];
   if (m_data) {
-    m_size = m_data ? length : 0;
-    m_actual_size = m_size;
-    memset(m_data, 0, length);
+    memcpy(data, m_data, m_size);
   }
+  memset(data + m_size, 0, length - m_size);
+  delete[] m_data;
+  m_data = data;
+  m_size = length;
+  m_actual_size = length;
   return m_data;
 }
 
@@ -75,34 +86,28 @@ void HardwareBackend::OutputData::SetPending() {
   m_write_pending = true;
 }
 
-void HardwareBackend::OutputData::SetLatchBytes(unsigned int latch_bytes) {
-  m_latch_bytes = latch_bytes;
-}
-
-HardwareBackend::OutputData& HardwareBackend::OutputData::operator=(
-    const HardwareBackend::OutputData &other) {
-  if (this != &other) {
-    uint8_t *data = Resize(other.m_size + other.m_latch_bytes);
-    if (data) {
-      memcpy(data, other.m_data, other.m_size);
-      memset(data + other.m_size, 0, other.m_latch_bytes);
-      m_write_pending = true;
-    } else {
-      m_write_pending = false;
-    }
+void HardwareBackend::OutputData::SyncFrom(const OutputData &other) {
+  uint8_t *data = Resize(other.m_size);
+  if (data && other.m_size) {
+    memcpy(data, other.m_data, other.m_size);
   }
-  return *this;
+  m_needs_sync = false;
 }
 
 HardwareBackend::HardwareBackend(const Options &options,
                                  SPIWriterInterface *writer,
                                  ExportMap *export_map)
-    : m_spi_writer(writer),
+    : ola::thread::Thread(ola::thread::Thread::Options("spi-hw-backend")),
+      m_spi_writer(writer),
       m_drop_map(NULL),
       m_output_count(1 << options.gpio_pins.size()),
       m_exit(false),
-      m_gpio_pins(options.gpio_pins) {
+      m_gpio_pins(options.gpio_pins),
+      m_gpio_chip(options.gpio_chip),
+      m_gpio_line_fd(-1),
+      m_selected_output(-1) {
   SetupOutputs(&m_output_data);
+  SetupOutputs(&m_front_data);
   if (export_map) {
     m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
                                            SPI_DROP_VAR_KEY);
@@ -121,6 +126,7 @@ HardwareBackend::~HardwareBackend() {
   Join();
 
   STLDeleteElements(&m_output_data);
+  STLDeleteElements(&m_front_data);
   CloseGPIOFDs();
 }
 
@@ -144,11 +150,19 @@ uint8_t *HardwareBackend::Checkout(uint8_t output_id,
   }
 
   m_mutex.Lock();
-  uint8_t *output = m_output_data[output_id]->Resize(length);
+  OutputData *output_data = m_output_data[output_id];
+  if (output_data->NeedsSync()) {
+    // The writer thread only reads the front buffer, and can't swap it while
+    // we hold the lock.
+    output_data->SyncFrom(*m_front_data[output_id]);
+  }
+
+  uint8_t *output = output_data->Resize(length + latch_bytes);
   if (!output) {
     m_mutex.Unlock();
+    return NULL;
   }
-  m_output_data[output_id]->SetLatchBytes(latch_bytes);
+  memset(output + length, 0, latch_bytes);
   // We return with the Mutex locked, the caller must then call Commit()
   // coverity[LOCK]
   return output;
@@ -170,15 +184,11 @@ void HardwareBackend::Commit(uint8_t output) {
 }
 
 void *HardwareBackend::Run() {
-  Outputs outputs;
-  SetupOutputs(&outputs);
-
   while (true) {
     m_mutex.Lock();
 
     if (m_exit) {
       m_mutex.Unlock();
-      STLDeleteElements(&outputs);
       return NULL;
     }
 
@@ -196,23 +206,21 @@ void *HardwareBackend::Run() {
 
     if (m_exit) {
       m_mutex.Unlock();
-      STLDeleteElements(&outputs);
       return NULL;
     }
 
     for (unsigned int i = 0; i < m_output_data.size(); i++) {
       if (m_output_data[i]->IsPending()) {
-        // take a copy
-        *outputs[i] = *m_output_data[i];
-        m_output_data[i]->ResetPending();
+        std::swap(m_output_data[i], m_front_data[i]);
+        m_output_data[i]->SetNeedsSync();
       }
     }
     m_mutex.Unlock();
 
-    for (unsigned int i = 0; i < outputs.size(); i++) {
-      if (outputs[i]->IsPending()) {
-        WriteOutput(i, outputs[i]);
-        outputs[i]->ResetPending();
+    for (unsigned int i = 0; i < m_front_data.size(); i++) {
+      if (m_front_data[i]->IsPending()) {
+        WriteOutput(i, m_front_data[i]);
+        m_front_data[i]->ResetPending();
       }
     }
   }
@@ -225,6 +233,34 @@ void HardwareBackend::SetupOutputs(Outputs *outputs) {
 }
 
 void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
+  if (SelectOutput(output_id)) {
+    m_spi_writer->WriteSPIData(output->GetData(), output->Size());
+  }
+}
+
+bool HardwareBackend::SelectOutput(uint8_t output_id) {
+  if (m_gpio_line_fd >= 0) {
+#ifdef HAVE_LINUX_GPIO_H
+    if (m_selected_output == output_id) {
+      return true;
+    }
+
+    struct gpiohandle_data data;
+    memset(&data, 0, sizeof(data));
+    for (unsigned int i = 0; i < m_gpio_pins.size(); i++) {
+      data.values[i] = (output_id >> i) & 1;
+    }
+    if (ioctl(m_gpio_line_fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+      OLA_WARN << "Failed to set SPI GPIO lines on " << m_gpio_chip << ": "
+               << strerror(errno);
+      m_selected_output = -1;
+      return false;
+    }
+    m_selected_output = output_id;
+#endif  // HAVE_LINUX_GPIO_H
+    return true;
+  }
+
   const string on("1");
   const string off("0");
 
@@ -241,16 +277,19 @@ void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
         OLA_WARN << "Failed to toggle SPI GPIO pin "
                  << static_cast<int>(m_gpio_pins[i]) << ": "
                  << strerror(errno);
-        return;
+        return false;
       }
       m_gpio_pin_state[i] = pin;
     }
   }
-
-  m_spi_writer->WriteSPIData(output->GetData(), output->Size());
+  return true;
 }
 
 bool HardwareBackend::SetupGPIO() {
+  if (!m_gpio_chip.empty()) {
+    return SetupGPIOChip();
+  }
+
   /**
    * This relies on the pins being exported:
    *   echo N > /sys/class/gpio/export
@@ -292,18 +331,72 @@ bool HardwareBackend::SetupGPIO() {
   return true;
 }
 
+/*
+ * Request all the pins as outputs from the GPIO character device. This gives
+ * us a single fd which sets all the lines at once.
+ */
+bool HardwareBackend::SetupGPIOChip() {
+  if (m_gpio_pins.empty()) {
+    return true;
+  }
+
+#ifdef HAVE_LINUX_GPIO_H
+  if (m_gpio_pins.size() > GPIOHANDLES_MAX) {
+    OLA_WARN << "Too many GPIO pins for " << m_gpio_chip;
+    return false;
+  }
+
+  int chip_fd;
+  if (!ola::io::Open(m_gpio_chip, O_RDWR, &chip_fd)) {
+    return false;
+  }
+  ola::network::SocketCloser closer(chip_fd);
+
+  struct gpiohandle_request request;
+  memset(&request, 0, sizeof(request));
+  for (unsigned int i = 0; i < m_gpio_pins.size(); i++) {
+    request.lineoffsets[i] = m_gpio_pins[i];
+  }
+  request.lines = m_gpio_pins.size();
+  request.flags = GPIOHANDLE_REQUEST_OUTPUT;
+  strncpy(request.consumer_label, "olad-spi",
+          sizeof(request.consumer_label) - 1);
+
+  if (ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &request) < 0) {
+    OLA_WARN << "Failed to request GPIO lines from " << m_gpio_chip << ": "
+             << strerror(errno);
+    return false;
+  }
+  m_gpio_line_fd = request.fd;
+  // The lines default to 0, which selects output 0.
+  m_selected_output = 0;
+  return true;
+#else
+  OLA_WARN << "GPIO character device support isn't available, can't use "
+           << m_gpio_chip;
+  return false;
+#endif  // HAVE_LINUX_GPIO_H
+}
+
 void HardwareBackend::CloseGPIOFDs() {
   GPIOFds::iterator iter = m_gpio_fds.begin();
   for (; iter != m_gpio_fds.end(); ++iter) {
     close(*iter);
   }
   m_gpio_fds.clear();
+
+  if (m_gpio_line_fd >= 0) {
+    close(m_gpio_line_fd);
+    m_gpio_line_fd = -1;
+  }
+  m_selected_output = -1;
 }
 
 SoftwareBackend::SoftwareBackend(const Options &options,
                                  SPIWriterInterface *writer,
                                  ExportMap *export_map)
-    : m_spi_writer(writer),
+    : ola::thread::Thread(ola::thread::Thread::Options("spi-sw-backend")),
+      m_spi_writer(writer),
       m_drop_map(NULL),
       m_write_pending(false),
       m_exit(false),
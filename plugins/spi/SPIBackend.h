@@ -58,7 +58,12 @@ class SPIBackendInterface {
 
 
 /**
- * A HardwareBackend which uses GPIO pins and an external de-multiplexer
+ * A HardwareBackend which uses GPIO pins and an external de-multiplexer.
+ *
+ * Each output is double buffered. Producers write into the back buffer
+ * between Checkout() and Commit(), and the writer thread swaps the pending
+ * back buffers with the front buffers before writing them to the SPI bus, so
+ * the frame data is never copied while the lock is held.
  */
 class HardwareBackend : public ola::thread::Thread,
                         public SPIBackendInterface {
@@ -67,6 +72,11 @@ class HardwareBackend : public ola::thread::Thread,
     // Which GPIO bits to use to select the output. The number of outputs
     // will be 2 ** gpio_pins.size();
     std::vector<uint16_t> gpio_pins;
+
+    // The GPIO character device, e.g. /dev/gpiochip0. If set the pins are
+    // offsets on this chip and are all updated with a single ioctl, otherwise
+    // the pins are controlled using sysfs.
+    std::string gpio_chip;
   };
 
   HardwareBackend(const Options &options,
@@ -96,31 +106,35 @@ class HardwareBackend : public ola::thread::Thread,
     OutputData()
         : m_data(NULL),
           m_write_pending(false),
+          m_needs_sync(false),
           m_size(0),
-          m_actual_size(0),
-          m_latch_bytes(0) {
+          m_actual_size(0) {
     }
 
     ~OutputData() { delete[] m_data; }
 
     uint8_t *Resize(unsigned int length);
-    void SetLatchBytes(unsigned int latch_bytes);
     void SetPending();
     bool IsPending() const { return m_write_pending; }
     void ResetPending() { m_write_pending = false; }
     const uint8_t *GetData() const { return m_data; }
     unsigned int Size() const { return m_size; }
 
-    OutputData& operator=(const OutputData &other);
+    // Set when this becomes the back buffer, since it then holds an older
+    // frame than the front buffer.
+    void SetNeedsSync() { m_needs_sync = true; }
+    bool NeedsSync() const { return m_needs_sync; }
+    void SyncFrom(const OutputData &other);
 
    private:
     uint8_t *m_data;
     bool m_write_pending;
+    bool m_needs_sync;
     unsigned int m_size;
     unsigned int m_actual_size;
-    unsigned int m_latch_bytes;
 
     OutputData(const OutputData&);
+    OutputData& operator=(const OutputData&);
   };
 
   typedef std::vector<int> GPIOFds;
@@ -133,16 +147,24 @@ class HardwareBackend : public ola::thread::Thread,
   ola::thread::ConditionVariable m_cond_var;
   bool m_exit;
 
+  // The back buffers, these are guarded by m_mutex.
   Outputs m_output_data;
+  // The front buffers, these are only swapped while holding m_mutex.
+  Outputs m_front_data;
 
   // GPIO members
   GPIOFds m_gpio_fds;
   const std::vector<uint16_t> m_gpio_pins;
   std::vector<bool> m_gpio_pin_state;
+  const std::string m_gpio_chip;
+  int m_gpio_line_fd;
+  int m_selected_output;
 
   void SetupOutputs(Outputs *outputs);
   void WriteOutput(uint8_t output_id, OutputData *output);
+  bool SelectOutput(uint8_t output_id);
   bool SetupGPIO();
+  bool SetupGPIOChip();
   void CloseGPIOFDs();
 };
 
@@ -25,6 +25,7 @@
 
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/file/Util.h"
 #include "ola/network/NetworkUtils.h"
 #include "olad/PluginAdaptor.h"
@@ -38,6 +39,7 @@ namespace ola {
 namespace plugin {
 namespace spi {
 
+using ola::dmx::PixelProcessor;
 using ola::rdm::UID;
 using std::auto_ptr;
 using std::ostringstream;
@@ -114,6 +116,7 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
     if (StringToInt(m_preferences->GetValue(PixelCountKey(i)), &pixel_count)) {
       spi_output_options.pixel_count = pixel_count;
     }
+    PopulatePixelProcessingOptions(i, &spi_output_options.pixel_processing);
 
     auto_ptr<UID> uid(uid_allocator->AllocateNext());
     if (!uid.get()) {
@@ -204,6 +207,10 @@ string SPIDevice::GPIOPinKey() const {
   return m_spi_device_name + "-gpio-pin";
 }
 
+string SPIDevice::GPIOChipKey() const {
+  return m_spi_device_name + "-gpio-chip";
+}
+
 string SPIDevice::DeviceLabelKey(uint8_t port) const {
   return GetPortKey("device-label", port);
 }
@@ -263,6 +270,7 @@ void SPIDevice::PopulateHardwareBackendOptions(
 
     options->gpio_pins.push_back(pin);
   }
+  options->gpio_chip = m_preferences->GetValue(GPIOChipKey());
 }
 
 void SPIDevice::PopulateSoftwareBackendOptions(
@@ -281,6 +289,20 @@ void SPIDevice::PopulateSoftwareBackendOptions(
   }
 }
 
+void SPIDevice::PopulatePixelProcessingOptions(
+    uint8_t port,
+    PixelProcessor::Options *options) {
+  const vector<string> &names = PixelProcessor::OptionNames();
+  vector<string>::const_iterator iter = names.begin();
+  for (; iter != names.end(); ++iter) {
+    const string key = GetPortKey(*iter, port);
+    if (!PixelProcessor::SetOption(*iter, m_preferences->GetValue(key),
+                                   options)) {
+      OLA_WARN << "Invalid value for " << key;
+    }
+  }
+}
+
 void SPIDevice::PopulateWriterOptions(SPIWriter::Options *options) {
   uint32_t spi_speed;
   if (StringToInt(m_preferences->GetValue(SPISpeedKey()), &spi_speed)) {
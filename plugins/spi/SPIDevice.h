@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "olad/Device.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/io/SelectServer.h"
 #include "ola/rdm/UIDAllocator.h"
 #include "ola/rdm/UID.h"
@@ -70,6 +71,7 @@ class SPIDevice: public ola::Device {
   std::string PortCountKey() const;
   std::string SyncPortKey() const;
   std::string GPIOPinKey() const;
+  std::string GPIOChipKey() const;
 
   // Per port options
   std::string DeviceLabelKey(uint8_t port) const;
@@ -82,6 +84,9 @@ class SPIDevice: public ola::Device {
   void PopulateHardwareBackendOptions(HardwareBackend::Options *options);
   void PopulateSoftwareBackendOptions(SoftwareBackend::Options *options);
   void PopulateWriterOptions(SPIWriter::Options *options);
+  void PopulatePixelProcessingOptions(
+      uint8_t port,
+      ola::dmx::PixelProcessor::Options *options);
 
   static const char SPI_DEVICE_NAME[];
   static const char HARDWARE_BACKEND[];
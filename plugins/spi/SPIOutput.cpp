@@ -46,6 +46,7 @@
 #include "ola/rdm/UIDSet.h"
 #include "ola/stl/STLUtils.h"
 
+#include "plugins/spi/PixelKernels.h"
 #include "plugins/spi/SPIBackend.h"
 #include "plugins/spi/SPIOutput.h"
 
@@ -53,6 +54,7 @@ namespace ola {
 namespace plugin {
 namespace spi {
 
+using ola::dmx::PixelProcessor;
 using ola::file::FilenameFromPathOrPath;
 using ola::network::HostToNetwork;
 using ola::network::NetworkToHost;
@@ -73,6 +75,23 @@ using std::min;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * Return the number of complete pixels available in the DMX data, capped at
+ * pixel_count.
+ */
+unsigned int CompletePixels(const DmxBuffer &buffer,
+                            unsigned int first_slot,
+                            unsigned int slots_per_pixel,
+                            unsigned int pixel_count) {
+  if (buffer.Size() <= first_slot) {
+    return 0;
+  }
+  return min(pixel_count, (buffer.Size() - first_slot) / slots_per_pixel);
+}
+}  // namespace
+
 const uint16_t SPIOutput::SPI_DELAY = 0;
 const uint8_t SPIOutput::SPI_BITS_PER_WORD = 8;
 const uint8_t SPIOutput::SPI_MODE = 0;
@@ -183,6 +202,11 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
       m_identify_mode(false) {
   m_spi_device_name = FilenameFromPathOrPath(m_backend->DevicePath());
 
+  m_pixel_processor.reset(new PixelProcessor(options.pixel_processing));
+  if (m_pixel_processor->IsIdentity()) {
+    m_pixel_processor.reset();
+  }
+
   PersonalityCollection::PersonalityList personalities;
   // personality description is max 32 characters
 
@@ -356,36 +380,38 @@ void SPIOutput::SendRDMRequest(RDMRequest *request,
 }
 
 bool SPIOutput::InternalWriteDMX(const DmxBuffer &buffer) {
-  switch (m_personality_manager->ActivePersonalityNumber()) {
+  const uint8_t personality = m_personality_manager->ActivePersonalityNumber();
+  const DmxBuffer &data = ProcessPixels(personality, buffer);
+  switch (personality) {
     case PERS_WS2801_INDIVIDUAL:
-      IndividualWS2801Control(buffer);
+      IndividualWS2801Control(data);
       break;
     case PERS_WS2801_COMBINED:
-      CombinedWS2801Control(buffer);
+      CombinedWS2801Control(data);
       break;
     case PERS_LDP8806_INDIVIDUAL:
-      IndividualLPD8806Control(buffer);
+      IndividualLPD8806Control(data);
       break;
     case PERS_LDP8806_COMBINED:
-      CombinedLPD8806Control(buffer);
+      CombinedLPD8806Control(data);
       break;
     case PERS_P9813_INDIVIDUAL:
-      IndividualP9813Control(buffer);
+      IndividualP9813Control(data);
       break;
     case PERS_P9813_COMBINED:
-      CombinedP9813Control(buffer);
+      CombinedP9813Control(data);
       break;
     case PERS_APA102_INDIVIDUAL:
-      IndividualAPA102Control(buffer);
+      IndividualAPA102Control(data);
       break;
     case PERS_APA102_COMBINED:
-      CombinedAPA102Control(buffer);
+      CombinedAPA102Control(data);
       break;
     case PERS_APA102_PB_INDIVIDUAL:
-      IndividualAPA102ControlPixelBrightness(buffer);
+      IndividualAPA102ControlPixelBrightness(data);
       break;
     case PERS_APA102_PB_COMBINED:
-      CombinedAPA102ControlPixelBrightness(buffer);
+      CombinedAPA102ControlPixelBrightness(data);
       break;
     default:
       break;
@@ -393,6 +419,30 @@ bool SPIOutput::InternalWriteDMX(const DmxBuffer &buffer) {
   return true;
 }
 
+/*
+ * Apply the pixel processing to the RGB personalities. The pixel brightness
+ * personalities use 4 slots per pixel and are left as they are.
+ */
+const DmxBuffer &SPIOutput::ProcessPixels(uint8_t personality,
+                                          const DmxBuffer &buffer) {
+  const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  if (!m_pixel_processor.get() ||
+      personality == PERS_APA102_PB_INDIVIDUAL ||
+      personality == PERS_APA102_PB_COMBINED ||
+      buffer.Size() <= first_slot) {
+    return buffer;
+  }
+
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  unsigned int length = sizeof(data);
+  buffer.Get(data, &length);
+  const unsigned int pixels = CompletePixels(
+      buffer, first_slot, PixelProcessor::SLOTS_PER_PIXEL, m_pixel_count);
+  m_pixel_processor->Process(data + first_slot, pixels, data + first_slot);
+  m_processed_buffer.Set(data, length);
+  return m_processed_buffer;
+}
+
 
 void SPIOutput::IndividualWS2801Control(const DmxBuffer &buffer) {
   // We always check out the entire string length, even if we only have data
@@ -447,19 +497,9 @@ void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
   if (!output)
     return;
 
-  const unsigned int length = min(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
-                                       buffer.Size() - first_slot);
-
-  for (unsigned int i = 0; i < length / LPD8806_SLOTS_PER_PIXEL; i++) {
-    // Convert RGB to GRB
-    unsigned int offset = first_slot + i * LPD8806_SLOTS_PER_PIXEL;
-    uint8_t r = buffer.Get(offset);
-    uint8_t g = buffer.Get(offset + 1);
-    uint8_t b = buffer.Get(offset + 2);
-    output[i * LPD8806_SLOTS_PER_PIXEL] = 0x80 | (g >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 1] = 0x80 | (r >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 2] = 0x80 | (b >> 1);
-  }
+  const unsigned int pixels = CompletePixels(
+      buffer, first_slot, LPD8806_SLOTS_PER_PIXEL, m_pixel_count);
+  RGBToLPD8806(buffer.GetRaw() + first_slot, pixels, output);
   m_backend->Commit(m_output_number);
 }
 
@@ -513,24 +553,17 @@ void SPIOutput::IndividualP9813Control(const DmxBuffer &buffer) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to P9813 Pixel
-    unsigned int offset = first_slot + i * P9813_SLOTS_PER_PIXEL;
-    // We need to avoid the first 4 bytes of the buffer since that acts as a
-    // start of frame delimiter
-    unsigned int spi_offset = (i + 1) * P9813_SPI_BYTES_PER_PIXEL;
-    uint8_t r = 0;
-    uint8_t b = 0;
-    uint8_t g = 0;
-    if (buffer.Size() - offset >= P9813_SLOTS_PER_PIXEL) {
-      r = buffer.Get(offset);
-      g = buffer.Get(offset + 1);
-      b = buffer.Get(offset + 2);
-    }
-    output[spi_offset] = P9813CreateFlag(r, g, b);
-    output[spi_offset + 1] = b;
-    output[spi_offset + 2] = g;
-    output[spi_offset + 3] = r;
+  // We need to avoid the first 4 bytes of the buffer since that acts as a
+  // start of frame delimiter
+  uint8_t *pixel_output = output + P9813_SPI_BYTES_PER_PIXEL;
+  const unsigned int pixels = CompletePixels(
+      buffer, first_slot, P9813_SLOTS_PER_PIXEL, m_pixel_count);
+  RGBToP9813(buffer.GetRaw() + first_slot, pixels, pixel_output);
+
+  // Pixels without data are turned off.
+  const uint8_t off[P9813_SPI_BYTES_PER_PIXEL] = {P9813Flag(0, 0, 0), 0, 0, 0};
+  for (unsigned int i = pixels; i < m_pixel_count; i++) {
+    memcpy(pixel_output + i * P9813_SPI_BYTES_PER_PIXEL, off, sizeof(off));
   }
   m_backend->Commit(m_output_number);
 }
@@ -570,11 +603,7 @@ void SPIOutput::CombinedP9813Control(const DmxBuffer &buffer) {
  * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
  */
 uint8_t SPIOutput::P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue) {
-  uint8_t flag = 0;
-  flag =  (red & 0xc0) >> 6;
-  flag |= (green & 0xc0) >> 4;
-  flag |= (blue & 0xc0) >> 2;
-  return ~flag;
+  return P9813Flag(red, green, blue);
 }
 
 
@@ -619,32 +648,26 @@ void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
     memset(output, 0, APA102_START_FRAME_BYTES);
   }
 
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to APA102 Pixel
-    uint16_t offset = first_slot + (i * APA102_SLOTS_PER_PIXEL);
-
+  uint8_t *pixel_output = output;
+  // only skip APA102_START_FRAME_BYTES on the first port!!
+  if (m_output_number == 0) {
+    // We need to avoid the first 4 bytes of the buffer since that acts as a
+    // start of frame delimiter
+    pixel_output += APA102_START_FRAME_BYTES;
+  }
 
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    // only skip APA102_START_FRAME_BYTES on the first port!!
-    if (m_output_number == 0) {
-      // We need to avoid the first 4 bytes of the buffer since that acts as a
-      // start of frame delimiter
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    // set pixel data
-    // first Byte contains:
-    // 3 bits start mark (111) + 5 bits global brightness
-    // set global brightness fixed to 31 --> that reduces flickering
-    // that can be written as 0xE0 & 0x1F
-    output[spi_offset] = 0xFF;
-    // only write pixel data if buffer has complete data for this pixel:
-    if ((buffer.Size() - offset) >= APA102_SLOTS_PER_PIXEL) {
-      // Convert RGB to APA102 Pixel
-      // skip spi_offset + 0 (is already set)
-      output[spi_offset + 1] = buffer.Get(offset + 2);  // blue
-      output[spi_offset + 2] = buffer.Get(offset + 1);  // green
-      output[spi_offset + 3] = buffer.Get(offset);      // red
-    }
+  // The first byte of each pixel contains:
+  // 3 bits start mark (111) + 5 bits global brightness
+  // set global brightness fixed to 31 --> that reduces flickering
+  // that can be written as 0xE0 & 0x1F
+  const unsigned int pixels = CompletePixels(
+      buffer, first_slot, APA102_SLOTS_PER_PIXEL, m_pixel_count);
+  RGBToAPA102(buffer.GetRaw() + first_slot, pixels, pixel_output);
+
+  // only write pixel data if buffer has complete data for this pixel, the
+  // remaining pixels keep their last value.
+  for (unsigned int i = pixels; i < m_pixel_count; i++) {
+    pixel_output[i * APA102_SPI_BYTES_PER_PIXEL] = 0xFF;
   }
 
   // write output back
@@ -696,32 +719,22 @@ void SPIOutput::IndividualAPA102ControlPixelBrightness(
     memset(output, 0, APA102_START_FRAME_BYTES);
   }
 
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to APA102 Pixel
-    uint16_t offset = first_slot + (i * APA102_PB_SLOTS_PER_PIXEL);
-
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    // only skip APA102_START_FRAME_BYTES on the first port!!
-    if (m_output_number == 0) {
-      // We need to avoid the first 4 bytes of the buffer since that acts as a
-      // start of frame delimiter
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    // set pixel data
-    // only write pixel data if buffer has complete data for this pixel:
-    if ((buffer.Size() - offset) >= APA102_PB_SLOTS_PER_PIXEL) {
-      // first Byte:
-      // 3 bits start mark (111) (APA102_LEDFRAME_START_MARK) +
-      // 5 bits pixel brightness (datasheet name: global brightness)
-      output[spi_offset + 0] = (SPIOutput::APA102_LEDFRAME_START_MARK |
-          CalculateAPA102PixelBrightness(buffer.Get(offset + 0)));
-      // Convert RGB to APA102 Pixel
-      output[spi_offset + 1] = buffer.Get(offset + 3);  // blue
-      output[spi_offset + 2] = buffer.Get(offset + 2);  // green
-      output[spi_offset + 3] = buffer.Get(offset + 1);  // red
-    }
+  uint8_t *pixel_output = output;
+  // only skip APA102_START_FRAME_BYTES on the first port!!
+  if (m_output_number == 0) {
+    // We need to avoid the first 4 bytes of the buffer since that acts as a
+    // start of frame delimiter
+    pixel_output += APA102_START_FRAME_BYTES;
   }
 
+  // only write pixel data if buffer has complete data for this pixel.
+  // first Byte:
+  // 3 bits start mark (111) (APA102_LEDFRAME_START_MARK) +
+  // 5 bits pixel brightness (datasheet name: global brightness)
+  const unsigned int pixels = CompletePixels(
+      buffer, first_slot, APA102_PB_SLOTS_PER_PIXEL, m_pixel_count);
+  BRGBToAPA102(buffer.GetRaw() + first_slot, pixels, pixel_output);
+
   // write output back
   m_backend->Commit(m_output_number);
 }
@@ -25,6 +25,7 @@
 #include <string>
 #include "common/rdm/NetworkManager.h"
 #include "ola/DmxBuffer.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
@@ -63,6 +64,8 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
     std::string device_label;
     uint8_t pixel_count;
     uint8_t output_number;
+    // Applied to the RGB personalities before the data is converted.
+    ola::dmx::PixelProcessor::Options pixel_processing;
 
     explicit Options(uint8_t output_number, const std::string &spi_device_name)
         : device_label("SPI Device - " + spi_device_name),
@@ -122,9 +125,13 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   std::auto_ptr<ola::rdm::PersonalityManager> m_personality_manager;
   ola::rdm::Sensors m_sensors;
   std::auto_ptr<ola::rdm::NetworkManagerInterface> m_network_manager;
+  // NULL if the pixel processing doesn't change the data.
+  std::auto_ptr<ola::dmx::PixelProcessor> m_pixel_processor;
+  DmxBuffer m_processed_buffer;
 
   // DMX methods
   bool InternalWriteDMX(const DmxBuffer &buffer);
+  const DmxBuffer &ProcessPixels(uint8_t personality, const DmxBuffer &buffer);
 
   void IndividualWS2801Control(const DmxBuffer &buffer);
   void CombinedWS2801Control(const DmxBuffer &buffer);
@@ -49,6 +49,7 @@ class SPIOutputTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testCombinedAPA102Control);
   CPPUNIT_TEST(testIndividualAPA102ControlPixelBrightness);
   CPPUNIT_TEST(testCombinedAPA102ControlPixelBrightness);
+  CPPUNIT_TEST(testPixelProcessing);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -69,6 +70,7 @@ class SPIOutputTest: public CppUnit::TestFixture {
   void testCombinedAPA102Control();
   void testIndividualAPA102ControlPixelBrightness();
   void testCombinedAPA102ControlPixelBrightness();
+  void testPixelProcessing();
 
  private:
   UID m_uid;
@@ -1139,3 +1141,50 @@ void SPIOutputTest::testCombinedAPA102ControlPixelBrightness() {
   OLA_ASSERT_DATA_EQUALS(EXPECTED8, arraysize(EXPECTED8), data, length);
   OLA_ASSERT_EQ(5u, backend.Writes(0));
 }
+
+
+/**
+ * Check the pixel processing is applied to the RGB personalities.
+ */
+void SPIOutputTest::testPixelProcessing() {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  options.pixel_processing.gamma = 2.0;
+  OLA_ASSERT_TRUE(ola::dmx::PixelProcessor::SetOption(
+      "color-order", "GRB", &options.pixel_processing));
+  SPIOutput output(m_uid, &backend, options);
+  output.SetPersonality(SPIOutput::PERS_WS2801_INDIVIDUAL);
+  output.SetStartAddress(2);
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  // The partial pixel at the end is ignored.
+  buffer.SetFromString("1,255,128,0,0,255,128,7");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED0[] = { 64, 255, 0, 255, 0, 64 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED0, arraysize(EXPECTED0), data, length);
+
+  output.SetPersonality(SPIOutput::PERS_APA102_INDIVIDUAL);
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = { 0, 0, 0, 0,
+                                0xFF, 0, 255, 64,
+                                0xFF, 64, 0, 255,
+                                0 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, length);
+
+  // The pixel brightness personalities are left alone.
+  output.SetPersonality(SPIOutput::PERS_APA102_PB_INDIVIDUAL);
+  buffer.SetFromString("1,255,128,0,0");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED2[] = { 0, 0, 0, 0,
+                                0xFF, 0, 0, 128,
+                                0xFF, 64, 0, 255,
+                                0 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), data, length);
+}
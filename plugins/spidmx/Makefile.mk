@@ -11,10 +11,10 @@ plugins/spidmx/SPIDMXPluginDescription.h: plugins/spidmx/README.md plugins/spidm
 	sh $(top_srcdir)/plugins/convert_README_to_header.sh $(top_srcdir)/plugins/spidmx $(top_builddir)/plugins/spidmx/SPIDMXPluginDescription.h
 
 plugins_spidmx_libolaspidmx_la_SOURCES = \
+    plugins/spidmx/SPIDMXDecoder.cpp \
+    plugins/spidmx/SPIDMXDecoder.h \
     plugins/spidmx/SPIDMXDevice.cpp \
     plugins/spidmx/SPIDMXDevice.h \
-    plugins/spidmx/SPIDMXParser.cpp \
-    plugins/spidmx/SPIDMXParser.h \
     plugins/spidmx/SPIDMXPlugin.cpp \
     plugins/spidmx/SPIDMXPlugin.h \
     plugins/spidmx/SPIDMXPort.h \
@@ -25,6 +25,17 @@ plugins_spidmx_libolaspidmx_la_SOURCES = \
 plugins_spidmx_libolaspidmx_la_LIBADD = \
     common/libolacommon.la \
     olad/plugin_api/libolaserverplugininterface.la
+
+# TESTS
+##################################################
+test_programs += plugins/spidmx/SPIDMXTester
+
+plugins_spidmx_SPIDMXTester_SOURCES = \
+    plugins/spidmx/SPIDMXDecoderTest.cpp \
+    plugins/spidmx/SPIDMXDecoder.cpp
+plugins_spidmx_SPIDMXTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+plugins_spidmx_SPIDMXTester_LDADD = $(COMMON_TESTING_LIBS) \
+                                   common/libolacommon.la
 endif
 
 EXTRA_DIST += plugins/spidmx/README.md
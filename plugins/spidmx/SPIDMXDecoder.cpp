@@ -0,0 +1,275 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SPIDMXDecoder.cpp
+ * Decodes DMX frames from a sampled SPI bit stream.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include "plugins/spidmx/SPIDMXDecoder.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "ola/Constants.h"
+
+namespace ola {
+namespace plugin {
+namespace spidmx {
+
+namespace {
+
+// The number of leading 1 bits in each byte.
+const uint8_t LEADING_ONES[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+  4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 7, 8,
+};
+
+/*
+ * Return the sample at a position.
+ */
+inline bool Sample(const uint8_t *data, unsigned int position) {
+  return (data[position >> 3] >> (7 - (position & 7))) & 1;
+}
+
+/*
+ * Count the samples, starting from position, that are at the given level.
+ * @param data the samples
+ * @param length the length of data in bytes
+ * @param position the sample to start from
+ * @param high true to count 1s, false to count 0s
+ * @returns the length of the run, the run ends at the end of the data if
+ *   position + the returned value == length * 8.
+ */
+unsigned int RunLength(const uint8_t *data, unsigned int length,
+                       unsigned int position, bool high) {
+  const uint8_t invert = high ? 0 : 0xff;
+  const unsigned int start = position;
+  unsigned int offset = position & 7;
+  unsigned int byte = position >> 3;
+
+  // The rest of a partial byte.
+  if (offset) {
+    const uint8_t bits = static_cast<uint8_t>((data[byte] ^ invert) << offset);
+    const unsigned int run = LEADING_ONES[bits];
+    if (run < 8 - offset) {
+      return run;
+    }
+    byte++;
+  }
+
+  // Whole bytes, 8 at a time to start with.
+  const uint64_t word = high ? ~static_cast<uint64_t>(0) : 0;
+  uint64_t block;
+  while (byte + sizeof(block) <= length) {
+    memcpy(&block, data + byte, sizeof(block));
+    if (block != word) {
+      break;
+    }
+    byte += sizeof(block);
+  }
+  const uint8_t full_byte = static_cast<uint8_t>(~invert);
+  while (byte < length && data[byte] == full_byte) {
+    byte++;
+  }
+
+  position = byte * 8;
+  if (byte < length) {
+    position += LEADING_ONES[static_cast<uint8_t>(data[byte] ^ invert)];
+  }
+  return position - start;
+}
+}  // namespace
+
+const unsigned int SPIDMXDecoder::SAMPLES_PER_BIT;
+const unsigned int SPIDMXDecoder::MIN_BREAK_SAMPLES;
+const unsigned int SPIDMXDecoder::MIN_MAB_SAMPLES;
+const unsigned int SPIDMXDecoder::SLOT_SAMPLES;
+
+SPIDMXDecoder::SPIDMXDecoder(FrameCallback *callback)
+    : m_callback(callback),
+      m_state(IDLE),
+      m_run(0),
+      m_slot_count(0),
+      m_frames(0),
+      m_framing_errors(0),
+      m_carry_size(0),
+      m_carry_position(0) {
+}
+
+void SPIDMXDecoder::Decode(const uint8_t *data, unsigned int length) {
+  unsigned int position = 0;
+
+  if (m_carry_size) {
+    const unsigned int carried = m_carry_size * 8;
+    const unsigned int copy = std::min(
+        length,
+        static_cast<unsigned int>(sizeof(m_carry)) - m_carry_size);
+    memcpy(m_carry + m_carry_size, data, copy);
+    m_carry_size += copy;
+    if (m_carry_position + SLOT_SAMPLES > m_carry_size * 8) {
+      // Still not enough, this only happens with tiny blocks.
+      return;
+    }
+    const unsigned int next = DecodeSlot(m_carry, m_carry_position);
+    position = next > carried ? next - carried : 0;
+    m_carry_size = 0;
+  }
+
+  const unsigned int end = length * 8;
+  while (position < end) {
+    unsigned int run;
+    switch (m_state) {
+      case IDLE:
+        position += RunLength(data, length, position, true);
+        if (position < end) {
+          m_state = IN_BREAK;
+          m_run = 0;
+        }
+        break;
+      case IN_BREAK:
+        run = RunLength(data, length, position, false);
+        position += run;
+        m_run += run;
+        if (position < end) {
+          if (m_run >= MIN_BREAK_SAMPLES) {
+            m_state = IN_MAB;
+            m_run = 0;
+          } else {
+            m_state = IDLE;
+          }
+        }
+        break;
+      case IN_MAB:
+        run = RunLength(data, length, position, true);
+        position += run;
+        m_run += run;
+        if (position < end) {
+          if (m_run >= MIN_MAB_SAMPLES) {
+            m_state = IN_SLOT;
+            m_slot_count = 0;
+          } else {
+            m_state = IN_BREAK;
+            m_run = 0;
+          }
+        }
+        break;
+      case IN_MARK:
+        position += RunLength(data, length, position, true);
+        if (position < end) {
+          m_state = IN_SLOT;
+        }
+        break;
+      case IN_SLOT:
+        if (position + SLOT_SAMPLES > end) {
+          const unsigned int byte = position >> 3;
+          m_carry_size = length - byte;
+          m_carry_position = position & 7;
+          memcpy(m_carry, data + byte, m_carry_size);
+          return;
+        }
+        position = DecodeSlot(data, position);
+        break;
+    }
+  }
+}
+
+void SPIDMXDecoder::Reset() {
+  m_state = IDLE;
+  m_slot_count = 0;
+  m_carry_size = 0;
+}
+
+/*
+ * Decode the slot that starts at position, which is the falling edge of the
+ * start bit.
+ * @returns the position of the middle of the stop bit.
+ */
+unsigned int SPIDMXDecoder::DecodeSlot(const uint8_t *data,
+                                       unsigned int position) {
+  const unsigned int middle = position + SAMPLES_PER_BIT / 2;
+  const unsigned int stop_bit = middle + 9 * SAMPLES_PER_BIT;
+
+  if (Sample(data, middle)) {
+    // A glitch rather than a start bit.
+    m_framing_errors++;
+    FrameComplete();
+    m_state = IDLE;
+    return middle;
+  }
+
+  uint8_t value = 0;
+  for (unsigned int i = 0; i < 8; i++) {
+    if (Sample(data, middle + (i + 1) * SAMPLES_PER_BIT)) {
+      value |= static_cast<uint8_t>(1 << i);
+    }
+  }
+
+  if (!Sample(data, stop_bit)) {
+    FrameComplete();
+    if (value == 0) {
+      // This is the break for the next frame.
+      m_state = IN_BREAK;
+      m_run = stop_bit - position;
+    } else {
+      m_framing_errors++;
+      m_state = IDLE;
+    }
+    return stop_bit;
+  }
+
+  if (m_slot_count == 0 && value != DMX512_START_CODE) {
+    // Not DMX data, wait for the next break.
+    m_state = IDLE;
+    return stop_bit;
+  }
+
+  m_slots[m_slot_count++] = value;
+  if (m_slot_count == sizeof(m_slots)) {
+    FrameComplete();
+    m_state = IDLE;
+  } else {
+    m_state = IN_MARK;
+  }
+  return stop_bit;
+}
+
+/*
+ * Pass the slots received so far to the callback.
+ */
+void SPIDMXDecoder::FrameComplete() {
+  if (m_slot_count > 1) {
+    m_frames++;
+    m_callback->Run(m_slots + 1, m_slot_count - 1);
+  }
+  m_slot_count = 0;
+}
+}  // namespace spidmx
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,133 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SPIDMXDecoder.h
+ * Decodes DMX frames from a sampled SPI bit stream.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef PLUGINS_SPIDMX_SPIDMXDECODER_H_
+#define PLUGINS_SPIDMX_SPIDMXDECODER_H_
+
+#include <stdint.h>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+#include "ola/Constants.h"
+
+namespace ola {
+namespace plugin {
+namespace spidmx {
+
+/**
+ * @brief Decodes DMX frames from the MISO line sampled at 2MHz.
+ *
+ * Each SPI byte holds 8 samples, MSB first, so one byte is one DMX bit. Most
+ * of a DMX stream is idle line, the break, or the marks between slots, so
+ * rather than stepping through every sample the decoder looks for the
+ * transitions. Runs of samples at the same level are measured a byte at a
+ * time using a lookup table, and whole bytes (or 8 byte words) of mark or
+ * break are skipped in one go. Once a start bit is found the slot is read by
+ * sampling the middle of each of the following bits.
+ *
+ * State is kept between calls to Decode(), so frames may span blocks.
+ *
+ * This isn't thread safe, it's used from the SPI thread.
+ */
+class SPIDMXDecoder {
+ public:
+  /**
+   * @brief Called with the slot data, not including the start code, of each
+   *   complete frame with a NULL start code.
+   */
+  typedef ola::Callback2<void, const uint8_t*, unsigned int> FrameCallback;
+
+  /**
+   * @brief Create a new decoder.
+   * @param callback the callback to run when a frame is complete, ownership
+   *   is transferred.
+   */
+  explicit SPIDMXDecoder(FrameCallback *callback);
+  ~SPIDMXDecoder() {}
+
+  /**
+   * @brief Decode a block of samples.
+   * @param data the SPI data.
+   * @param length the length of the data.
+   */
+  void Decode(const uint8_t *data, unsigned int length);
+
+  /**
+   * @brief Discard any partial frame and wait for the next break.
+   */
+  void Reset();
+
+  /**
+   * @brief The number of frames passed to the callback.
+   */
+  unsigned int Frames() const { return m_frames; }
+
+  /**
+   * @brief The number of slots that didn't have a valid start or stop bit.
+   */
+  unsigned int FramingErrors() const { return m_framing_errors; }
+
+  // One DMX bit is 8 samples. At 245 - 255kbit/s this is 7.8 - 8.2 samples,
+  // which is close enough that we can sample the middle of all 11 bits of a
+  // slot from the falling edge of the start bit.
+  static const unsigned int SAMPLES_PER_BIT = 8;
+  // 88us
+  static const unsigned int MIN_BREAK_SAMPLES = 165;
+  // 8us
+  static const unsigned int MIN_MAB_SAMPLES = 15;
+
+ private:
+  typedef enum {
+    IDLE,  // waiting for the line to go low
+    IN_BREAK,
+    IN_MAB,
+    IN_SLOT,  // at the falling edge of a start bit
+    IN_MARK,  // waiting for the falling edge of the next start bit
+  } DecoderState;
+
+  // Samples from the falling edge of the start bit to the middle of the stop
+  // bit, inclusive.
+  static const unsigned int SLOT_SAMPLES = 9 * SAMPLES_PER_BIT
+                                           + SAMPLES_PER_BIT / 2 + 1;
+
+  std::auto_ptr<FrameCallback> m_callback;
+  DecoderState m_state;
+  unsigned int m_run;
+  unsigned int m_slot_count;
+  unsigned int m_frames;
+  unsigned int m_framing_errors;
+  uint8_t m_slots[DMX_UNIVERSE_SIZE + 1];
+
+  // A slot that starts near the end of a block is finished using the start of
+  // the next one.
+  uint8_t m_carry[2 * (SLOT_SAMPLES / 8 + 2)];
+  unsigned int m_carry_size;
+  unsigned int m_carry_position;
+
+  unsigned int DecodeSlot(const uint8_t *data, unsigned int position);
+  void FrameComplete();
+
+  DISALLOW_COPY_AND_ASSIGN(SPIDMXDecoder);
+};
+}  // namespace spidmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPIDMX_SPIDMXDECODER_H_
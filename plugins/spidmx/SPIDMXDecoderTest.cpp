@@ -0,0 +1,244 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SPIDMXDecoderTest.cpp
+ * Test fixture for the SPIDMXDecoder class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/spidmx/SPIDMXDecoder.h"
+
+using ola::DmxBuffer;
+using ola::plugin::spidmx::SPIDMXDecoder;
+using std::vector;
+
+/*
+ * Builds a stream of samples, 8 per DMX bit.
+ */
+class SampleWriter {
+ public:
+  SampleWriter() : m_samples(0) {}
+
+  void Mark(unsigned int samples) { Append(true, samples); }
+  void Break(unsigned int samples) { Append(false, samples); }
+
+  void Slot(uint8_t value, bool stop_bit = true) {
+    Append(false, 8);
+    for (unsigned int i = 0; i < 8; i++) {
+      Append((value >> i) & 1, 8);
+    }
+    Append(stop_bit, 16);
+  }
+
+  void Frame(const DmxBuffer &buffer, uint8_t start_code = 0,
+             unsigned int mark_between_slots = 0) {
+    Break(190);
+    Mark(21);
+    Slot(start_code);
+    for (unsigned int i = 0; i < buffer.Size(); i++) {
+      Mark(mark_between_slots);
+      Slot(buffer.Get(i));
+    }
+  }
+
+  // Pad to a whole byte with mark.
+  const vector<uint8_t> &Data() {
+    Mark((8 - m_samples % 8) % 8);
+    return m_data;
+  }
+
+ private:
+  vector<uint8_t> m_data;
+  unsigned int m_samples;
+
+  void Append(bool high, unsigned int samples) {
+    for (unsigned int i = 0; i < samples; i++) {
+      if (m_samples % 8 == 0) {
+        m_data.push_back(0);
+      }
+      if (high) {
+        m_data.back() |= static_cast<uint8_t>(0x80 >> (m_samples % 8));
+      }
+      m_samples++;
+    }
+  }
+};
+
+
+class SPIDMXDecoderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPIDMXDecoderTest);
+  CPPUNIT_TEST(testDecode);
+  CPPUNIT_TEST(testBlocks);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testDecode();
+    void testBlocks();
+    void testInvalid();
+
+ private:
+    vector<DmxBuffer> m_frames;
+
+    void FrameReceived(const uint8_t *data, unsigned int length) {
+      m_frames.push_back(DmxBuffer(data, length));
+    }
+
+    SPIDMXDecoder::FrameCallback *NewFrameCallback() {
+      return ola::NewCallback(this, &SPIDMXDecoderTest::FrameReceived);
+    }
+
+ public:
+    void setUp() { m_frames.clear(); }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPIDMXDecoderTest);
+
+
+/*
+ * Check that full and partial frames are decoded.
+ */
+void SPIDMXDecoderTest::testDecode() {
+  DmxBuffer full;
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    full.SetChannel(i, static_cast<uint8_t>(i * 7));
+  }
+  DmxBuffer partial;
+  partial.SetFromString("0,255,1,128,85,170");
+
+  SampleWriter writer;
+  writer.Mark(1000);
+  writer.Frame(full);
+  writer.Mark(37);
+  writer.Frame(partial, 0, 13);
+  // The next break ends the partial frame.
+  writer.Mark(3);
+  writer.Frame(full, 0, 5);
+  writer.Mark(100);
+  const vector<uint8_t> &data = writer.Data();
+
+  SPIDMXDecoder decoder(NewFrameCallback());
+  decoder.Decode(&data[0], data.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_frames.size());
+  OLA_ASSERT_DMX_EQUALS(full, m_frames[0]);
+  OLA_ASSERT_DMX_EQUALS(partial, m_frames[1]);
+  OLA_ASSERT_DMX_EQUALS(full, m_frames[2]);
+  OLA_ASSERT_EQ(3u, decoder.Frames());
+  OLA_ASSERT_EQ(0u, decoder.FramingErrors());
+}
+
+
+/*
+ * Check that frames split across blocks are decoded.
+ */
+void SPIDMXDecoderTest::testBlocks() {
+  DmxBuffer first;
+  first.SetFromString("1,2,3,4,5,6,7,8,9,10,0,0,0,255,255,255");
+  DmxBuffer second;
+  second.SetFromString("0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0");
+
+  SampleWriter writer;
+  writer.Mark(300);
+  writer.Frame(first, 0, 3);
+  writer.Frame(second, 0, 1);
+  writer.Frame(first);
+  // The last frame isn't complete until the next break.
+  writer.Mark(200);
+  writer.Break(190);
+  writer.Mark(20);
+  const vector<uint8_t> &data = writer.Data();
+
+  const unsigned int block_sizes[] = {1, 2, 5, 9, 10, 11, 12, 64, 1000};
+  for (unsigned int i = 0; i < sizeof(block_sizes) / sizeof(unsigned int);
+       i++) {
+    m_frames.clear();
+    SPIDMXDecoder decoder(NewFrameCallback());
+    for (unsigned int offset = 0; offset < data.size();
+         offset += block_sizes[i]) {
+      decoder.Decode(
+          &data[offset],
+          std::min(block_sizes[i],
+                   static_cast<unsigned int>(data.size()) - offset));
+    }
+    OLA_ASSERT_EQ(static_cast<size_t>(3), m_frames.size());
+    OLA_ASSERT_DMX_EQUALS(first, m_frames[0]);
+    OLA_ASSERT_DMX_EQUALS(second, m_frames[1]);
+    OLA_ASSERT_DMX_EQUALS(first, m_frames[2]);
+  }
+}
+
+
+/*
+ * Check that short breaks, alternate start codes and framing errors are
+ * handled.
+ */
+void SPIDMXDecoderTest::testInvalid() {
+  DmxBuffer buffer;
+  buffer.SetFromString("10,20,30,40");
+
+  SampleWriter writer;
+  writer.Mark(100);
+  // A break that's too short
+  writer.Break(120);
+  writer.Mark(20);
+  writer.Slot(0);
+  writer.Slot(1);
+  writer.Mark(20);
+  // An alternate start code
+  writer.Frame(buffer, 0xcc);
+  writer.Mark(20);
+  // A frame with a bad stop bit after the second slot
+  writer.Break(190);
+  writer.Mark(21);
+  writer.Slot(0);
+  writer.Slot(1);
+  writer.Slot(2, false);
+  writer.Slot(3);
+  writer.Mark(20);
+  writer.Frame(buffer);
+  writer.Mark(20);
+  writer.Break(190);
+  writer.Mark(20);
+  const vector<uint8_t> &data = writer.Data();
+
+  SPIDMXDecoder decoder(NewFrameCallback());
+  decoder.Decode(&data[0], data.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_frames.size());
+  DmxBuffer truncated;
+  truncated.SetFromString("1");
+  OLA_ASSERT_DMX_EQUALS(truncated, m_frames[0]);
+  OLA_ASSERT_DMX_EQUALS(buffer, m_frames[1]);
+  OLA_ASSERT_EQ(1u, decoder.FramingErrors());
+
+  // Reset discards the partial frame.
+  SampleWriter partial;
+  partial.Mark(100);
+  partial.Frame(buffer);
+  const vector<uint8_t> &partial_data = partial.Data();
+  decoder.Decode(&partial_data[0], partial_data.size());
+  decoder.Reset();
+  decoder.Decode(&data[0], data.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(4), m_frames.size());
+  OLA_ASSERT_DMX_EQUALS(truncated, m_frames[2]);
+}
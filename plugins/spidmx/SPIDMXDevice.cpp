@@ -55,7 +55,8 @@ SPIDMXDevice::SPIDMXDevice(AbstractPlugin *owner,
   }
 
   m_widget.reset(new SPIDMXWidget(path));
-  m_thread.reset(new SPIDMXThread(m_widget.get(), m_blocklength));
+  m_thread.reset(new SPIDMXThread(m_widget.get(), m_blocklength,
+                                  m_plugin_adaptor));
 }
 
 SPIDMXDevice::~SPIDMXDevice() {
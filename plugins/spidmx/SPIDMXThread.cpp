@@ -15,27 +15,33 @@
  *
  * SPIDMXThread.cpp
  * This thread runs while one or more ports are registered. It simultaneously
- * reads / writes SPI data and then calls the parser. This is repeated forever.
+ * reads / writes SPI data and then calls the decoder. This is repeated forever.
  * Copyright (C) 2017 Florian Edelmann
  */
 
+#include <string.h>
 #include <string>
 #include "ola/Logging.h"
+#include "plugins/spidmx/SPIDMXDecoder.h"
 #include "plugins/spidmx/SPIDMXWidget.h"
 #include "plugins/spidmx/SPIDMXThread.h"
-#include "plugins/spidmx/SPIDMXParser.h"
 
 namespace ola {
 namespace plugin {
 namespace spidmx {
 
-SPIDMXThread::SPIDMXThread(SPIDMXWidget *widget, unsigned int blocklength)
-  : m_widget(widget),
+SPIDMXThread::SPIDMXThread(SPIDMXWidget *widget, unsigned int blocklength,
+                           ola::thread::ExecutorInterface *executor)
+  : ola::thread::Thread(ola::thread::Thread::Options("spidmx")),
+    m_widget(widget),
     m_blocklength(blocklength),
+    m_executor(executor),
     m_term(false),
     m_registered_ports(0),
+    m_frame_ready_pending(0),
     m_spi_rx_buffer(blocklength),
-    m_spi_tx_buffer(blocklength) {
+    m_spi_tx_buffer(blocklength),
+    m_frame_ready(NewCallback(this, &SPIDMXThread::FrameReady)) {
 }
 
 SPIDMXThread::~SPIDMXThread() {
@@ -132,15 +138,12 @@ void *SPIDMXThread::Run() {
     }
   }
 
-  // Setup the parser
-  SPIDMXParser *parser = new SPIDMXParser(&m_dmx_rx_buffer,
-                                          m_receive_callback.get());
+  SPIDMXDecoder decoder(NewCallback(this, &SPIDMXThread::FrameReceived));
 
   while (1) {
     {
       ola::thread::MutexLocker locker(&m_term_mutex);
       if (m_term) {
-        parser->SetCallback(NULL);
         break;
       }
     }
@@ -163,14 +166,46 @@ void *SPIDMXThread::Run() {
       break;
     }
 
-    parser->ParseDmx(spi_rx_ptr, (uint64_t) m_blocklength);
+    decoder.Decode(spi_rx_ptr, m_blocklength);
   }
 
-  delete parser;
-
   return NULL;
 }
 
+
+/**
+ * Called in this thread when the decoder has a frame. The frame is handed to
+ * the main thread without taking a lock, if the main thread falls behind it
+ * only sees the latest frame.
+ */
+void SPIDMXThread::FrameReceived(const uint8_t *slots, unsigned int length) {
+  Frame &frame = m_rx_frames.Back();
+  memcpy(frame.slots, slots, length);
+  frame.length = length;
+  m_rx_frames.Publish();
+
+  if (!__atomic_exchange_n(&m_frame_ready_pending, 1, __ATOMIC_ACQ_REL)) {
+    m_executor->Execute(m_frame_ready.get());
+  }
+}
+
+
+/**
+ * Called in the main thread once a new frame is available.
+ */
+void SPIDMXThread::FrameReady() {
+  __atomic_store_n(&m_frame_ready_pending, 0, __ATOMIC_RELEASE);
+  if (!m_rx_frames.Update()) {
+    return;
+  }
+
+  const Frame &frame = m_rx_frames.Front();
+  m_dmx_rx_buffer.Set(frame.slots, frame.length);
+  if (m_receive_callback.get()) {
+    m_receive_callback->Run();
+  }
+}
+
 }  // namespace spidmx
 }  // namespace plugin
 }  // namespace ola
@@ -15,19 +15,23 @@
  *
  * SPIDMXThread.h
  * This thread runs while one or more ports are registered. It simultaneously
- * reads / writes SPI data and then calls the parser. This is repeated forever.
+ * reads / writes SPI data and then calls the decoder. This is repeated forever.
  * Copyright (C) 2017 Florian Edelmann
  */
 
 #ifndef PLUGINS_SPIDMX_SPIDMXTHREAD_H_
 #define PLUGINS_SPIDMX_SPIDMXTHREAD_H_
 
+#include <stdint.h>
 #include <memory>
 #include <vector>
 #include "ola/Callback.h"
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
+#include "ola/thread/ExecutorInterface.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
 
 namespace ola {
 namespace plugin {
@@ -35,7 +39,8 @@ namespace spidmx {
 
 class SPIDMXThread : public ola::thread::Thread {
  public:
-  SPIDMXThread(SPIDMXWidget *widget, unsigned int blocklength);
+  SPIDMXThread(SPIDMXWidget *widget, unsigned int blocklength,
+               ola::thread::ExecutorInterface *executor);
   ~SPIDMXThread();
 
   void RegisterPort();
@@ -50,14 +55,24 @@ class SPIDMXThread : public ola::thread::Thread {
   bool SetReceiveCallback(Callback0<void> *callback);
 
  private:
+  struct Frame {
+    uint8_t slots[DMX_UNIVERSE_SIZE];
+    unsigned int length;
+  };
+
   SPIDMXWidget *m_widget;
   unsigned int m_blocklength;
+  ola::thread::ExecutorInterface *m_executor;
 
   bool m_term;
   int m_registered_ports;
 
   /** receive DMX buffer to give to InputPort's callback */
   DmxBuffer m_dmx_rx_buffer;
+  /** frames passed from this thread to the main thread */
+  ola::thread::TripleBuffer<Frame> m_rx_frames;
+  /** non-0 if FrameReady() has been queued but hasn't run yet */
+  int m_frame_ready_pending;
   /** transmit DMX buffer that is set from WriteDMX */
   DmxBuffer m_dmx_tx_buffer;
 
@@ -68,10 +83,14 @@ class SPIDMXThread : public ola::thread::Thread {
 
   /** called when a new m_dmx_rx_buffer is ready */
   std::auto_ptr<Callback0<void> > m_receive_callback;
+  std::auto_ptr<Callback0<void> > m_frame_ready;
 
   ola::thread::Mutex m_term_mutex;
   ola::thread::Mutex m_buffer_mutex;
 
+  void FrameReceived(const uint8_t *slots, unsigned int length);
+  void FrameReady();
+
   DISALLOW_COPY_AND_ASSIGN(SPIDMXThread);
 };
 
@@ -120,7 +120,8 @@ void StageProfiPlugin::NewWidget(const std::string &widget_path,
       new StageProfiWidget(
           m_plugin_adaptor, descriptor, widget_path,
           NewSingleCallback(this, &StageProfiPlugin::DeviceRemoved,
-                            widget_path)),
+                            widget_path),
+          m_plugin_adaptor->GetExportMap()),
       STAGEPROFI_DEVICE_NAME));
 
   if (!device->Start()) {
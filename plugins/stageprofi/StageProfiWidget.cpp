@@ -29,6 +29,7 @@
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
+#include "ola/dmx/TrackedDmxBuffer.h"
 #include "ola/util/Utils.h"
 
 namespace ola {
@@ -37,6 +38,8 @@ namespace stageprofi {
 
 using ola::io::ConnectedDescriptor;
 using ola::TimeInterval;
+using ola::dmx::SlotRange;
+using ola::dmx::TrackedDmxBuffer;
 using ola::thread::INVALID_TIMEOUT;
 using std::string;
 
@@ -49,17 +52,38 @@ enum stageprofi_packet_type_e {
 
 typedef enum stageprofi_packet_type_e stageprofi_packet_type;
 
+const unsigned int StageProfiWidget::FULL_REFRESH_INTERVAL_MS;
+const unsigned int StageProfiWidget::SERIAL_BAUDRATE;
+const char StageProfiWidget::BYTES_SENT_VAR[] = "stageprofi-bytes-sent";
+const char StageProfiWidget::UTILIZATION_VAR[] = "stageprofi-wire-utilization";
+const char StageProfiWidget::DEVICE_KEY[] = "device";
 
 StageProfiWidget::StageProfiWidget(io::SelectServerInterface *ss,
                                    ConnectedDescriptor *descriptor,
                                    const string &widget_path,
-                                   DisconnectCallback *disconnect_cb)
+                                   DisconnectCallback *disconnect_cb,
+                                   ola::ExportMap *export_map)
     : m_ss(ss),
       m_descriptor(descriptor),
       m_widget_path(widget_path),
       m_disconnect_cb(disconnect_cb),
       m_timeout_id(INVALID_TIMEOUT),
-      m_got_response(false) {
+      m_got_response(false),
+      m_window_bytes(0),
+      // Network widgets are identified by their IP address.
+      m_baudrate(!widget_path.empty() && widget_path[0] == '/' ?
+                 SERIAL_BAUDRATE : 0),
+      m_bytes_sent_var(NULL),
+      m_utilization_var(NULL) {
+  if (export_map) {
+    m_bytes_sent_var = export_map->GetUIntMapVar(BYTES_SENT_VAR, DEVICE_KEY);
+    (*m_bytes_sent_var)[m_widget_path] = 0;
+    if (m_baudrate) {
+      m_utilization_var = export_map->GetUIntMapVar(UTILIZATION_VAR,
+                                                    DEVICE_KEY);
+      (*m_utilization_var)[m_widget_path] = 0;
+    }
+  }
   m_descriptor->SetOnData(
       NewCallback<StageProfiWidget>(this, &StageProfiWidget::SocketReady));
   m_ss->AddReadDescriptor(m_descriptor.get());
@@ -88,14 +112,28 @@ bool StageProfiWidget::SendDmx(const DmxBuffer &buffer) {
     return false;
   }
 
-  uint16_t index = 0;
-  while (index < buffer.Size()) {
+  SlotRange range(0, buffer.Size());
+  if (!StartFullRefresh()) {
+    range = TrackedDmxBuffer::DifferingRange(
+        m_last_sent.GetRaw(), m_last_sent.Size(),
+        buffer.GetRaw(), buffer.Size());
+    range.end = std::min(range.end, buffer.Size());
+  }
+  m_last_sent.Set(buffer);
+
+  uint16_t index = range.first;
+  while (index < range.end) {
     unsigned int size = std::min((unsigned int) DMX_MSG_LEN,
-                                 buffer.Size() - index);
+                                 range.end - index);
     bool ok = Send255(index, buffer.GetRaw() + index, size);
     if (!ok) {
       OLA_INFO << "Failed to send StageProfi message, closing socket";
       RunDisconnectHandler();
+    } else {
+      m_window_bytes += size + DMX_HEADER_SIZE;
+      if (m_bytes_sent_var) {
+        (*m_bytes_sent_var)[m_widget_path] += size + DMX_HEADER_SIZE;
+      }
     }
     index += size;
   }
@@ -161,6 +199,29 @@ void StageProfiWidget::RunDisconnectHandler() {
     m_disconnect_cb = NULL;
   }
 }
+
+/*
+ * @brief Check if it's time for a full refresh. If it is, update the wire
+ * utilization for the period since the last one.
+ */
+bool StageProfiWidget::StartFullRefresh() {
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  if (m_last_full_refresh.IsSet()) {
+    const int64_t elapsed_ms = (now - m_last_full_refresh).InMilliSeconds();
+    if (elapsed_ms < FULL_REFRESH_INTERVAL_MS) {
+      return false;
+    }
+    if (m_utilization_var) {
+      // 8N1 is 10 bits per byte, this is a percentage.
+      (*m_utilization_var)[m_widget_path] = static_cast<unsigned int>(
+          m_window_bytes * 10 * 100 * 1000ull / (m_baudrate * elapsed_ms));
+    }
+  }
+  m_last_full_refresh = now;
+  m_window_bytes = 0;
+  return true;
+}
 }  // namespace stageprofi
 }  // namespace plugin
 }  // namespace ola
@@ -23,8 +23,10 @@
 
 #include <memory>
 #include <string>
-#include "ola/DmxBuffer.h"
 #include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/io/Descriptor.h"
 #include "ola/io/SelectServerInterface.h"
 
@@ -44,11 +46,13 @@ class StageProfiWidget {
    *   transferred.
    * @param widget_path the path to the widget.
    * @param disconnect_cb Called if the widget is disconnected.
+   * @param export_map the ExportMap to record the bytes sent in, may be NULL.
    */
   StageProfiWidget(ola::io::SelectServerInterface *ss,
                    ola::io::ConnectedDescriptor *descriptor,
                    const std::string &widget_path,
-                   DisconnectCallback *disconnect_cb);
+                   DisconnectCallback *disconnect_cb,
+                   ola::ExportMap *export_map = NULL);
 
   /**
    * @brief Destructor.
@@ -61,6 +65,12 @@ class StageProfiWidget {
    */
   std::string GetPath() const { return m_widget_path; }
 
+  /**
+   * @brief Send DMX data to the widget.
+   *
+   * Only the slots that changed since the last call are sent, apart from a
+   * full refresh once a second.
+   */
   bool SendDmx(const DmxBuffer &buffer);
 
  private:
@@ -73,12 +83,27 @@ class StageProfiWidget {
   DisconnectCallback *m_disconnect_cb;
   ola::thread::timeout_id m_timeout_id;
   bool m_got_response;
+  DmxBuffer m_last_sent;
+  ola::Clock m_clock;
+  TimeStamp m_last_full_refresh;
+  unsigned int m_window_bytes;  // sent since m_last_full_refresh
+  // 0 if the widget isn't a serial device.
+  const unsigned int m_baudrate;
+  UIntMap *m_bytes_sent_var;
+  UIntMap *m_utilization_var;
 
   void SocketReady();
   void DiscoveryTimeout();
   bool Send255(uint16_t start, const uint8_t *buf, unsigned int len) const;
   void SendQueryPacket();
   void RunDisconnectHandler();
+  bool StartFullRefresh();
+
+  static const unsigned int FULL_REFRESH_INTERVAL_MS = 1000;
+  static const unsigned int SERIAL_BAUDRATE = 38400;
+  static const char BYTES_SENT_VAR[];
+  static const char UTILIZATION_VAR[];
+  static const char DEVICE_KEY[];
 };
 }  // namespace stageprofi
 }  // namespace plugin
@@ -19,6 +19,7 @@
  * Copyright (C) 2014 Richard Ash
  */
 
+#include <set>
 #include <string>
 #include <memory>
 #include "ola/Logging.h"
@@ -30,12 +31,23 @@ namespace ola {
 namespace plugin {
 namespace uartdmx {
 
+using ola::io::DmxLineDriver;
+using std::set;
 using std::string;
 
 const char UartDmxDevice::K_MALF[] = "-malf";
 const char UartDmxDevice::K_BREAK[] = "-break";
 const unsigned int UartDmxDevice::DEFAULT_BREAK = 100;
 const unsigned int UartDmxDevice::DEFAULT_MALF = 100;
+const char UartDmxDevice::K_RT_PRIORITY[] = "-rt-priority";
+const unsigned int UartDmxDevice::DEFAULT_RT_PRIORITY = 0;
+const char UartDmxDevice::K_CPU[] = "-cpu";
+const int UartDmxDevice::DEFAULT_CPU = -1;
+const int UartDmxDevice::MAX_CPU = 1023;
+const char UartDmxDevice::K_RS485[] = "-rs485";
+const char UartDmxDevice::K_BREAK_MODE[] = "-break-mode";
+const char UartDmxDevice::BREAK_MODE_IOCTL[] = "ioctl";
+const char UartDmxDevice::BREAK_MODE_BAUD[] = "baud";
 
 
 UartDmxDevice::UartDmxDevice(AbstractPlugin *owner,
@@ -57,7 +69,25 @@ UartDmxDevice::UartDmxDevice(AbstractPlugin *owner,
   if (!StringToInt(m_preferences->GetValue(DeviceMalfKey()), &m_malft)) {
     m_malft = DEFAULT_MALF;
   }
-  m_widget.reset(new UartWidget(path));
+  // Real time priority for the output thread, 0 to disable
+  if (!StringToInt(m_preferences->GetValue(DeviceRTPriorityKey()),
+                   &m_rt_priority)) {
+    m_rt_priority = DEFAULT_RT_PRIORITY;
+  }
+  // CPU to pin the output thread to, -1 to disable
+  if (!StringToInt(m_preferences->GetValue(DeviceCPUKey()), &m_cpu)) {
+    m_cpu = DEFAULT_CPU;
+  }
+
+  DmxLineDriver::Options options;
+  options.break_time = m_breakt;
+  if (m_preferences->GetValue(DeviceBreakModeKey()) == BREAK_MODE_BAUD) {
+    options.break_mode = DmxLineDriver::BREAK_BAUD;
+  }
+  // Direction control by the kernel, for UARTs wired to an RS-485
+  // transceiver's driver enable through RTS.
+  options.rs485 = m_preferences->GetValueAsBool(DeviceRS485Key());
+  m_widget.reset(new UartWidget(path, options));
 }
 
 UartDmxDevice::~UartDmxDevice() {
@@ -67,7 +97,8 @@ UartDmxDevice::~UartDmxDevice() {
 }
 
 bool UartDmxDevice::StartHook() {
-  AddPort(new UartDmxOutputPort(this, 0, m_widget.get(), m_breakt, m_malft));
+  AddPort(new UartDmxOutputPort(this, 0, m_widget.get(), m_breakt, m_malft,
+                                m_rt_priority, m_cpu));
   return true;
 }
 
@@ -77,6 +108,18 @@ string UartDmxDevice::DeviceMalfKey() const {
 string UartDmxDevice::DeviceBreakKey() const {
   return m_path + K_BREAK;
 }
+string UartDmxDevice::DeviceRTPriorityKey() const {
+  return m_path + K_RT_PRIORITY;
+}
+string UartDmxDevice::DeviceCPUKey() const {
+  return m_path + K_CPU;
+}
+string UartDmxDevice::DeviceRS485Key() const {
+  return m_path + K_RS485;
+}
+string UartDmxDevice::DeviceBreakModeKey() const {
+  return m_path + K_BREAK_MODE;
+}
 
 /**
  * Set the default preferences for this one Device
@@ -94,6 +137,21 @@ void UartDmxDevice::SetDefaults() {
   save |= m_preferences->SetDefaultValue(DeviceMalfKey(),
                                          UIntValidator(8, 1000000),
                                          DEFAULT_MALF);
+  save |= m_preferences->SetDefaultValue(DeviceRTPriorityKey(),
+                                         UIntValidator(0, 99),
+                                         DEFAULT_RT_PRIORITY);
+  save |= m_preferences->SetDefaultValue(DeviceCPUKey(),
+                                         IntValidator(DEFAULT_CPU, MAX_CPU),
+                                         DEFAULT_CPU);
+  save |= m_preferences->SetDefaultValue(DeviceRS485Key(),
+                                         BoolValidator(),
+                                         false);
+  set<string> break_modes;
+  break_modes.insert(BREAK_MODE_IOCTL);
+  break_modes.insert(BREAK_MODE_BAUD);
+  save |= m_preferences->SetDefaultValue(DeviceBreakModeKey(),
+                                         SetValidator<string>(break_modes),
+                                         BREAK_MODE_IOCTL);
   if (save) {
     m_preferences->Save();
   }
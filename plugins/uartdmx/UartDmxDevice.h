@@ -52,6 +52,10 @@ class UartDmxDevice : public Device {
   // Per device options
   std::string DeviceBreakKey() const;
   std::string DeviceMalfKey() const;
+  std::string DeviceRTPriorityKey() const;
+  std::string DeviceCPUKey() const;
+  std::string DeviceRS485Key() const;
+  std::string DeviceBreakModeKey() const;
   void SetDefaults();
 
   std::auto_ptr<UartWidget> m_widget;
@@ -60,11 +64,22 @@ class UartDmxDevice : public Device {
   const std::string m_path;
   unsigned int m_breakt;
   unsigned int m_malft;
+  unsigned int m_rt_priority;
+  int m_cpu;
 
   static const unsigned int DEFAULT_MALF;
   static const char K_MALF[];
   static const unsigned int DEFAULT_BREAK;
   static const char K_BREAK[];
+  static const unsigned int DEFAULT_RT_PRIORITY;
+  static const char K_RT_PRIORITY[];
+  static const int DEFAULT_CPU;
+  static const int MAX_CPU;
+  static const char K_CPU[];
+  static const char K_RS485[];
+  static const char K_BREAK_MODE[];
+  static const char BREAK_MODE_IOCTL[];
+  static const char BREAK_MODE_BAUD[];
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxDevice);
 };
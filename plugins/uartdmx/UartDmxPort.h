@@ -41,10 +41,12 @@ class UartDmxOutputPort : public ola::BasicOutputPort {
                     unsigned int id,
                     UartWidget *widget,
                     unsigned int breakt,
-                    unsigned int malft)
+                    unsigned int malft,
+                    unsigned int rt_priority,
+                    int cpu)
       : BasicOutputPort(parent, id),
         m_widget(widget),
-        m_thread(widget, breakt, malft) {
+        m_thread(widget, breakt, malft, rt_priority, cpu) {
     m_thread.Start();
   }
   ~UartDmxOutputPort() { m_thread.Stop(); }
@@ -53,7 +55,9 @@ class UartDmxOutputPort : public ola::BasicOutputPort {
     return m_thread.WriteDMX(buffer);
   }
 
-  std::string Description() const { return m_widget->Description(); }
+  std::string Description() const {
+    return m_widget->Description() + " (" + m_thread.Stats().ToString() + ")";
+  }
 
  private:
   UartWidget *m_widget;
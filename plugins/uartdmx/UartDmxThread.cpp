@@ -19,12 +19,14 @@
  * Copyright (C) 2014 Richard Ash
  */
 
-#include <math.h>
-#include <unistd.h>
+#include <sched.h>
 #include <string>
 #include "ola/Clock.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/Utils.h"
+#include "ola/util/StallWatchdog.h"
 #include "plugins/uartdmx/UartWidget.h"
 #include "plugins/uartdmx/UartDmxThread.h"
 
@@ -33,12 +35,16 @@ namespace plugin {
 namespace uartdmx {
 
 UartDmxThread::UartDmxThread(UartWidget *widget, unsigned int breakt,
-                             unsigned int malft)
-  : m_granularity(UNKNOWN),
+                             unsigned int malft, unsigned int rt_priority,
+                             int cpu)
+  : ola::thread::Thread(ola::thread::Thread::Options("uartdmx")),
     m_widget(widget),
     m_term(false),
     m_breakt(breakt),
-    m_malft(malft) {
+    m_malft(malft),
+    m_rt_priority(rt_priority),
+    m_cpu(cpu),
+    m_timer(FrameTime(breakt, malft)) {
 }
 
 UartDmxThread::~UartDmxThread() {
@@ -62,8 +68,8 @@ bool UartDmxThread::Stop() {
  * Copy a DMXBuffer to the output thread
  */
 bool UartDmxThread::WriteDMX(const DmxBuffer &buffer) {
-  ola::thread::MutexLocker locker(&m_buffer_mutex);
-  m_buffer.Set(buffer);
+  m_buffer.Back().Set(buffer);
+  m_buffer.Publish();
   return true;
 }
 
@@ -72,15 +78,15 @@ bool UartDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * The method called by the thread
  */
 void *UartDmxThread::Run() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  CheckTimeGranularity();
-  DmxBuffer buffer;
+  ConfigureScheduling();
 
   // Setup the widget
   if (!m_widget->IsOpen())
     m_widget->SetupOutput();
 
+  // Each frame is supervised by the stall watchdog, if there is one.
+  ola::Heartbeat heartbeat(Name());
+  m_timer.Start();
   while (1) {
     {
       ola::thread::MutexLocker locker(&m_term_mutex);
@@ -88,53 +94,46 @@ void *UartDmxThread::Run() {
         break;
     }
 
-    {
-      ola::thread::MutexLocker locker(&m_buffer_mutex);
-      buffer.Set(m_buffer);
-    }
-
-    if (!m_widget->SetBreak(true))
-      goto framesleep;
+    heartbeat.Begin();
+    m_buffer.Update();
 
-    if (m_granularity == GOOD)
-      usleep(m_breakt);
+    // The line driver generates the break and MAB, and returns once the
+    // frame has left the UART.
+    m_widget->SendDmx(m_buffer.Front());
+    heartbeat.End();
 
-    if (!m_widget->SetBreak(false))
-      goto framesleep;
-
-    if (m_granularity == GOOD)
-      usleep(DMX_MAB);
+    // The next break is scheduled a full frame plus the MALF time after the
+    // start of this one.
+    m_timer.WaitForNextFrame();
+  }
+  OLA_INFO << "UART output thread for " << m_widget->Name() << ": "
+           << m_timer.Stats().ToString();
+  return NULL;
+}
 
-    if (!m_widget->Write(buffer))
-      goto framesleep;
 
-  framesleep:
-    // Sleep for the remainder of the DMX frame time
-    usleep(m_malft);
+/**
+ * Apply the real time priority and CPU affinity, if configured.
+ */
+void UartDmxThread::ConfigureScheduling() {
+  if (m_rt_priority) {
+    struct sched_param param;
+    param.sched_priority = m_rt_priority;
+    ola::thread::SetSchedParam(pthread_self(), SCHED_FIFO, param);
+  }
+  if (m_cpu >= 0) {
+    ola::thread::SetThreadAffinity(pthread_self(), m_cpu);
   }
-  return NULL;
 }
 
 
 /**
- * Check the granularity of usleep.
+ * The time between the start of each break, for a full universe.
  */
-void UartDmxThread::CheckTimeGranularity() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  /** If sleeping for 1ms takes longer than this, don't trust
-   * usleep for this session
-   */
-  const int threshold = 3;
-
-  clock.CurrentMonotonicTime(&ts1);
-  usleep(1000);
-  clock.CurrentMonotonicTime(&ts2);
-
-  TimeInterval interval = ts2 - ts1;
-  m_granularity = interval.InMilliSeconds() > threshold ? BAD : GOOD;
-  OLA_INFO << "Granularity for UART thread is "
-           << (m_granularity == GOOD ? "GOOD" : "BAD");
+TimeInterval UartDmxThread::FrameTime(unsigned int breakt,
+                                      unsigned int malft) {
+  return TimeInterval(static_cast<int64_t>(
+      breakt + DMX_MAB + (DMX_UNIVERSE_SIZE + 1) * DMX_SLOT_TIME + malft));
 }
 }  // namespace uartdmx
 }  // namespace plugin
@@ -23,7 +23,9 @@
 #define PLUGINS_UARTDMX_UARTDMXTHREAD_H_
 
 #include "ola/DmxBuffer.h"
+#include "ola/thread/FrameTimer.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
 
 namespace ola {
 namespace plugin {
@@ -31,28 +33,45 @@ namespace uartdmx {
 
 class UartDmxThread : public ola::thread::Thread {
  public:
-  UartDmxThread(UartWidget *widget, unsigned int breakt, unsigned int malft);
+  /**
+   * @brief Create a new output thread.
+   * @param widget the UART to write to.
+   * @param breakt the break time in microseconds.
+   * @param malft the mark after last frame time in microseconds.
+   * @param rt_priority if non-0, run the thread with SCHED_FIFO at this
+   *   priority.
+   * @param cpu if non-negative, pin the thread to this CPU.
+   */
+  UartDmxThread(UartWidget *widget, unsigned int breakt, unsigned int malft,
+                unsigned int rt_priority = 0, int cpu = -1);
   ~UartDmxThread();
 
   bool Stop();
   void *Run();
   bool WriteDMX(const DmxBuffer &buffer);
 
- private:
-  enum TimerGranularity { UNKNOWN, GOOD, BAD };
+  const ola::thread::FrameTimingStats &Stats() const {
+    return m_timer.Stats();
+  }
 
-  TimerGranularity m_granularity;
+ private:
   UartWidget *m_widget;
   bool m_term;
   unsigned int m_breakt;
   unsigned int m_malft;
-  DmxBuffer m_buffer;
+  const unsigned int m_rt_priority;
+  const int m_cpu;
+  ola::thread::FrameTimer m_timer;
+  ola::thread::TripleBuffer<DmxBuffer> m_buffer;
   ola::thread::Mutex m_term_mutex;
-  ola::thread::Mutex m_buffer_mutex;
 
-  void CheckTimeGranularity();
+  void ConfigureScheduling();
+
+  static TimeInterval FrameTime(unsigned int breakt, unsigned int malft);
 
   static const uint32_t DMX_MAB = 16;
+  // The time to send one slot at 250kbps, 1 start, 8 data and 2 stop bits.
+  static const uint32_t DMX_SLOT_TIME = 44;
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxThread);
 };
@@ -28,22 +28,8 @@
  * Copyright (C) 2014 Richard Ash
  */
 
-#include <strings.h>
-#include <assert.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sys/ioctl.h>
-#include <fcntl.h>
-#include <termios.h>
-#include <unistd.h>
-
 #include <string>
-#include <algorithm>
-#include <vector>
 
-#include "ola/Constants.h"
-#include "ola/io/ExtendedSerial.h"
-#include "ola/io/IOUtils.h"
 #include "ola/Logging.h"
 #include "plugins/uartdmx/UartWidget.h"
 
@@ -52,11 +38,11 @@ namespace plugin {
 namespace uartdmx {
 
 using std::string;
-using std::vector;
 
-UartWidget::UartWidget(const string& path)
+UartWidget::UartWidget(const string& path,
+                       const ola::io::DmxLineDriver::Options &options)
     : m_path(path),
-      m_fd(NOT_OPEN) {
+      m_driver(path, options) {
 }
 
 UartWidget::~UartWidget() {
@@ -68,79 +54,34 @@ UartWidget::~UartWidget() {
 
 bool UartWidget::Open() {
   OLA_DEBUG << "Opening serial port " << Name();
-  if (!ola::io::Open(m_path, O_WRONLY, &m_fd)) {
-    m_fd = FAILED_OPEN;
+  if (!m_driver.Open()) {
     OLA_WARN << Name() << " failed to open";
     return false;
-  } else {
-    OLA_DEBUG << "Opened serial port " << Name();
-    return true;
   }
+  OLA_DEBUG << "Opened serial port " << Name();
+  return true;
 }
 
 bool UartWidget::Close() {
-  if (!IsOpen()) {
-    return true;
-  }
-
-  if (close(m_fd) > 0) {
+  if (!m_driver.Close()) {
     OLA_WARN << Name() << " error closing";
-    m_fd = NOT_OPEN;
     return false;
-  } else {
-    m_fd = NOT_OPEN;
-    return true;
   }
+  return true;
 }
 
 bool UartWidget::IsOpen() const {
-  return m_fd >= 0;
-}
-
-bool UartWidget::SetBreak(bool on) {
-  unsigned long request;  /* NOLINT(runtime/int) */
-  /* this is passed to ioctl, which is declared to take
-   * unsigned long as it's second argument
-   */
-  if (on == true) {
-    request = TIOCSBRK;
-  } else {
-    request = TIOCCBRK;
-  }
-
-  if (ioctl(m_fd, request, NULL) < 0) {
-    OLA_WARN << Name() << " ioctl() failed";
-    return false;
-  } else {
-    return true;
-  }
+  return m_driver.IsOpen();
 }
 
-bool UartWidget::Write(const ola::DmxBuffer& data) {
-  unsigned char buffer[DMX_UNIVERSE_SIZE + 1];
-  unsigned int length = DMX_UNIVERSE_SIZE;
-  buffer[0] = DMX512_START_CODE;
-
-  data.Get(buffer + 1, &length);
-
-  if (write(m_fd, buffer, length + 1) <= 0) {
+bool UartWidget::SendDmx(const ola::DmxBuffer& data) {
+  if (!m_driver.SendDmx(data)) {
     // TODO(richardash1981): handle errors better as per the test code,
     // especially if we alter the scheduling!
     OLA_WARN << Name() << " Short or failed write!";
     return false;
-  } else {
-    return true;
-  }
-}
-
-bool UartWidget::Read(unsigned char *buff, int size) {
-  int readb = read(m_fd, buff, size);
-  if (readb <= 0) {
-    OLA_WARN << Name() << " read error";
-    return false;
-  } else {
-    return true;
   }
+  return true;
 }
 
 /**
@@ -149,38 +90,11 @@ bool UartWidget::Read(unsigned char *buff, int size) {
  * before AddDevice()
  */
 bool UartWidget::SetupOutput() {
-  struct termios my_tios;
-  // Setup the Uart for DMX
-  if (Open() == false) {
+  // The line driver sets up 250k 8N2 and the optional RS-485 mode.
+  if (!Open()) {
     OLA_WARN << "Error Opening widget";
     return false;
   }
-  /* do the port settings */
-
-  if (tcgetattr(m_fd, &my_tios) < 0) {  // get current settings
-    OLA_WARN << "Failed to get POSIX port settings";
-    return false;
-  }
-  cfmakeraw(&my_tios);  // make it a binary data port
-
-  my_tios.c_cflag |= CLOCAL;    // port is local, no flow control
-  my_tios.c_cflag &= ~CSIZE;
-  my_tios.c_cflag |= CS8;       // 8 bit chars
-  my_tios.c_cflag &= ~PARENB;   // no parity
-  my_tios.c_cflag |= CSTOPB;    // 2 stop bit for DMX
-  my_tios.c_cflag &= ~CRTSCTS;  // no CTS/RTS flow control
-
-  if (tcsetattr(m_fd, TCSANOW, &my_tios) < 0) {  // apply settings
-    OLA_WARN << "Failed to get POSIX port settings";
-    return false;
-  }
-
-  /* Do the platform-specific initialisation of the UART to 250kbaud */
-  if (!ola::io::LinuxHelper::SetDmxBaud(m_fd)) {
-    OLA_WARN << "Failed to set baud rate to 250k";
-    return false;
-  }
-  /* everything must have worked to get here */
   return true;
 }
 
@@ -32,9 +32,9 @@
 #define PLUGINS_UARTDMX_UARTWIDGET_H_
 
 #include <string>
-#include <vector>
 #include "ola/base/Macro.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/DmxLineDriver.h"
 
 namespace ola {
 namespace plugin {
@@ -48,8 +48,10 @@ class UartWidget {
     /**
      * Construct a new UartWidget instance for one widget.
      * @param path The device file path of the serial port
+     * @param options the line driver options, e.g. the break time.
      */
-    explicit UartWidget(const std::string &path);
+    UartWidget(const std::string &path,
+               const ola::io::DmxLineDriver::Options &options);
 
     /** Destructor */
     virtual ~UartWidget();
@@ -67,36 +69,15 @@ class UartWidget {
     /** Check if the widget is open */
     bool IsOpen() const;
 
-    /** Toggle communications line BREAK condition on/off */
-    bool SetBreak(bool on);
-
-    /** Write data to a previously-opened line */
-    bool Write(const ola::DmxBuffer &data);
-
-    /** Read data from a previously-opened line */
-    bool Read(unsigned char* buff, int size);
+    /** Send a break, MAB and the frame, returns once the frame is sent */
+    bool SendDmx(const ola::DmxBuffer &data);
 
     /** Setup device for DMX Output **/
     bool SetupOutput();
 
  private:
   const std::string m_path;
-
-  /**
-   * variable to hold the Unix file descriptor used to open and manipulate
-   * the port. Set to -2 when port is not open.
-   */
-  int m_fd;
-
-  /**
-   * Constant value for file is not open
-   */
-  static const int NOT_OPEN = -2;
-
-  /**
-   * Constant value for failed to open file
-   */
-  static const int FAILED_OPEN = -1;
+  ola::io::DmxLineDriver m_driver;
 
   DISALLOW_COPY_AND_ASSIGN(UartWidget);
 };
@@ -40,6 +40,10 @@ namespace {
 
 static const unsigned int URB_TIMEOUT_MS = 500;
 static const unsigned int UDMX_SET_CHANNEL_RANGE = 0x0002;
+// The number of frames the async sender keeps in flight.
+static const unsigned int TRANSFER_COUNT = 2;
+static const unsigned int CONTROL_BUFFER_SIZE =
+    LIBUSB_CONTROL_SETUP_SIZE + DMX_UNIVERSE_SIZE;
 
 }  // namespace
 
@@ -118,14 +122,13 @@ bool SynchronousAnymauDMX::SendDMX(const DmxBuffer &buffer) {
 class AnymaAsyncUsbSender : public AsyncUsbSender {
  public:
   AnymaAsyncUsbSender(LibUsbAdaptor *adaptor, libusb_device *usb_device)
-      : AsyncUsbSender(adaptor, usb_device) {
-    m_control_setup_buffer =
-        new uint8_t[LIBUSB_CONTROL_SETUP_SIZE + DMX_UNIVERSE_SIZE];
+      : AsyncUsbSender(adaptor, usb_device, TRANSFER_COUNT) {
+    m_control_setup_buffers = new uint8_t[TRANSFER_COUNT * CONTROL_BUFFER_SIZE];
   }
 
   ~AnymaAsyncUsbSender() {
     CancelTransfer();
-    delete[] m_control_setup_buffer;
+    delete[] m_control_setup_buffers;
   }
 
   libusb_device_handle* SetupHandle() {
@@ -136,8 +139,10 @@ class AnymaAsyncUsbSender : public AsyncUsbSender {
   }
 
   bool PerformTransfer(const DmxBuffer &buffer) {
+    uint8_t *control_setup_buffer =
+        m_control_setup_buffers + TransferSlot() * CONTROL_BUFFER_SIZE;
     m_adaptor->FillControlSetup(
-        m_control_setup_buffer,
+        control_setup_buffer,
         LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE |
         LIBUSB_ENDPOINT_OUT,  // bmRequestType
         UDMX_SET_CHANNEL_RANGE,  // bRequest
@@ -146,14 +151,14 @@ class AnymaAsyncUsbSender : public AsyncUsbSender {
         buffer.Size());  // wLength
 
     unsigned int length = DMX_UNIVERSE_SIZE;
-    buffer.Get(m_control_setup_buffer + LIBUSB_CONTROL_SETUP_SIZE, &length);
+    buffer.Get(control_setup_buffer + LIBUSB_CONTROL_SETUP_SIZE, &length);
 
-    FillControlTransfer(m_control_setup_buffer, URB_TIMEOUT_MS);
+    FillControlTransfer(control_setup_buffer, URB_TIMEOUT_MS);
     return (SubmitTransfer() == 0);
   }
 
  private:
-  uint8_t *m_control_setup_buffer;
+  uint8_t *m_control_setup_buffers;
 
   DISALLOW_COPY_AND_ASSIGN(AnymaAsyncUsbSender);
 };
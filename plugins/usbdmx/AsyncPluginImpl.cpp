@@ -130,7 +130,7 @@ bool AsyncPluginImpl::Start() {
   m_widget_factories.push_back(
       new JaRuleFactory(m_plugin_adaptor, m_usb_adaptor));
   m_widget_factories.push_back(
-      new ScanlimeFadecandyFactory(m_usb_adaptor));
+      new ScanlimeFadecandyFactory(m_usb_adaptor, m_preferences));
   m_widget_factories.push_back(new ShowJockeyDMXU1Factory(m_usb_adaptor));
   m_widget_factories.push_back(new SunliteFactory(m_usb_adaptor));
   m_widget_factories.push_back(new VellemanK8062Factory(m_usb_adaptor));
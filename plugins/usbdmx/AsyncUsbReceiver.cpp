@@ -74,8 +74,7 @@ void AsyncUsbReceiver::TransferComplete(struct libusb_transfer *transfer) {
   }
 
   ola::thread::MutexLocker locker(&m_mutex);
-  m_transfer_state = (transfer->status == LIBUSB_TRANSFER_NO_DEVICE ?
-      DISCONNECTED : IDLE);
+  MarkTransferComplete(transfer);
 
   if (m_suppress_continuation) {
     return;
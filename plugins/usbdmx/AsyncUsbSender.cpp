@@ -30,8 +30,9 @@ namespace usbdmx {
 using ola::usb::LibUsbAdaptor;
 
 AsyncUsbSender::AsyncUsbSender(LibUsbAdaptor *adaptor,
-                               libusb_device *usb_device)
-    : AsyncUsbTransceiverBase(adaptor, usb_device),
+                               libusb_device *usb_device,
+                               unsigned int transfer_count)
+    : AsyncUsbTransceiverBase(adaptor, usb_device, transfer_count),
       m_pending_tx(false) {
 }
 
@@ -45,32 +46,29 @@ bool AsyncUsbSender::SendDMX(const DmxBuffer &buffer) {
     return false;
   }
   ola::thread::MutexLocker locker(&m_mutex);
-  if (m_transfer_state == IDLE) {
+  if (!m_pending_tx && CanSubmitTransfer()) {
     PerformTransfer(buffer);
   } else {
-    // Buffer incoming data so we can send it when the outstanding transfers
-    // complete.
+    // Hold on to the latest frame so we can send it when a transfer
+    // completes. This takes a reference to the frame rather than copying it;
+    // the reference count is only ever touched from this thread.
     m_pending_tx = true;
-    m_tx_buffer.Set(buffer);
+    m_tx_buffer = buffer;
   }
   return true;
 }
 
 void AsyncUsbSender::TransferComplete(struct libusb_transfer *transfer) {
-  if (transfer != m_transfer) {
-    OLA_WARN << "Mismatched libusb transfer: " << transfer << " != "
-             << m_transfer;
-    return;
-  }
-
   if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
     OLA_WARN << "Transfer returned "
              << m_adaptor->ErrorCodeToString(transfer->status);
   }
 
   ola::thread::MutexLocker locker(&m_mutex);
-  m_transfer_state = (transfer->status == LIBUSB_TRANSFER_NO_DEVICE ?
-      DISCONNECTED : IDLE);
+  if (!MarkTransferComplete(transfer)) {
+    OLA_WARN << "Unknown libusb transfer: " << transfer;
+    return;
+  }
 
   if (m_suppress_continuation) {
     return;
@@ -78,7 +76,7 @@ void AsyncUsbSender::TransferComplete(struct libusb_transfer *transfer) {
 
   PostTransferHook();
 
-  if ((m_transfer_state == IDLE) && m_pending_tx) {
+  if (m_pending_tx && CanSubmitTransfer()) {
     m_pending_tx = false;
     PerformTransfer(m_tx_buffer);
   }
@@ -38,6 +38,10 @@ namespace usbdmx {
  *
  * This encapsulates much of the asynchronous libusb logic. Subclasses should
  * implement the SetupHandle() and PerformTransfer() methods.
+ *
+ * Frames which arrive while no transfer can be submitted are coalesced, only
+ * the latest one is sent. The pending frame shares the data of the buffer
+ * passed to SendDMX() rather than copying it.
  */
 class AsyncUsbSender: public AsyncUsbTransceiverBase {
  public:
@@ -45,9 +49,11 @@ class AsyncUsbSender: public AsyncUsbTransceiverBase {
    * @brief Create a new AsyncUsbSender.
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
+   * @param transfer_count the maximum number of frames in flight at once.
    */
   AsyncUsbSender(ola::usb::LibUsbAdaptor* const adaptor,
-                 libusb_device *usb_device);
+                 libusb_device *usb_device,
+                 unsigned int transfer_count = 1);
 
   /**
    * @brief Destructor
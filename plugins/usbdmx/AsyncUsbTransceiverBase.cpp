@@ -20,6 +20,9 @@
 
 #include "plugins/usbdmx/AsyncUsbTransceiverBase.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/Logging.h"
 
@@ -45,20 +48,31 @@ void AsyncCallback(struct libusb_transfer *transfer) {
 }  // namespace
 
 AsyncUsbTransceiverBase::AsyncUsbTransceiverBase(LibUsbAdaptor *adaptor,
-                                                 libusb_device *usb_device)
+                                                 libusb_device *usb_device,
+                                                 unsigned int transfer_count)
     : m_adaptor(adaptor),
       m_usb_device(usb_device),
       m_usb_handle(NULL),
       m_suppress_continuation(false),
-      m_transfer_state(IDLE) {
-  m_transfer = m_adaptor->AllocTransfer(0);
+      m_transfer(NULL),
+      m_transfer_state(IDLE),
+      m_in_flight(std::max(transfer_count, 1u), false),
+      m_in_flight_count(0),
+      m_slot(0) {
+  for (unsigned int i = 0; i < m_in_flight.size(); i++) {
+    m_transfers.push_back(m_adaptor->AllocTransfer(0));
+  }
+  m_transfer = m_transfers[0];
   m_adaptor->RefDevice(usb_device);
 }
 
 AsyncUsbTransceiverBase::~AsyncUsbTransceiverBase() {
   CancelTransfer();
   m_adaptor->UnrefDevice(m_usb_device);
-  m_adaptor->FreeTransfer(m_transfer);
+  std::vector<struct libusb_transfer*>::iterator iter = m_transfers.begin();
+  for (; iter != m_transfers.end(); ++iter) {
+    m_adaptor->FreeTransfer(*iter);
+  }
 }
 
 bool AsyncUsbTransceiverBase::Init() {
@@ -71,25 +85,63 @@ void AsyncUsbTransceiverBase::CancelTransfer() {
     return;
   }
 
-  bool canceled = false;
+  std::vector<bool> canceled(m_transfers.size(), false);
   while (1) {
     ola::thread::MutexLocker locker(&m_mutex);
-    if (m_transfer_state == IDLE || m_transfer_state == DISCONNECTED) {
+    if (m_in_flight_count == 0) {
       break;
     }
-    if (!canceled) {
-      m_suppress_continuation = true;
-      if (m_adaptor->CancelTransfer(m_transfer) == 0) {
-        canceled = true;
-      } else {
-        break;
+    m_suppress_continuation = true;
+    bool failed = false;
+    for (unsigned int i = 0; i < m_transfers.size(); i++) {
+      if (m_in_flight[i] && !canceled[i]) {
+        if (m_adaptor->CancelTransfer(m_transfers[i]) == 0) {
+          canceled[i] = true;
+        } else {
+          failed = true;
+        }
       }
     }
+    if (failed) {
+      break;
+    }
   }
 
   m_suppress_continuation = false;
 }
 
+bool AsyncUsbTransceiverBase::CanSubmitTransfer() const {
+  return (m_transfer_state != DISCONNECTED &&
+          m_in_flight_count < m_transfers.size());
+}
+
+bool AsyncUsbTransceiverBase::MarkTransferComplete(
+    struct libusb_transfer *transfer) {
+  unsigned int i = 0;
+  for (; i < m_transfers.size(); i++) {
+    if (m_transfers[i] == transfer) {
+      break;
+    }
+  }
+  if (i == m_transfers.size() || !m_in_flight[i]) {
+    return false;
+  }
+
+  m_in_flight[i] = false;
+  m_in_flight_count--;
+  if (m_in_flight[m_slot]) {
+    m_slot = i;
+    m_transfer = transfer;
+  }
+
+  if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
+    m_transfer_state = DISCONNECTED;
+  } else if (m_transfer_state != DISCONNECTED) {
+    m_transfer_state = m_in_flight_count ? IN_PROGRESS : IDLE;
+  }
+  return true;
+}
+
 void AsyncUsbTransceiverBase::FillControlTransfer(unsigned char *buffer,
                                                   unsigned int timeout) {
   m_adaptor->FillControlTransfer(m_transfer, m_usb_handle, buffer,
@@ -122,9 +174,26 @@ int AsyncUsbTransceiverBase::SubmitTransfer() {
     }
     return false;
   }
+  m_in_flight[m_slot] = true;
+  m_in_flight_count++;
   m_transfer_state = IN_PROGRESS;
+  SelectFreeTransfer();
   return ret;
 }
+
+/*
+ * Point m_transfer at a transfer that isn't in flight, if there is one.
+ */
+void AsyncUsbTransceiverBase::SelectFreeTransfer() {
+  for (unsigned int i = 1; i < m_transfers.size(); i++) {
+    unsigned int slot = (m_slot + i) % m_transfers.size();
+    if (!m_in_flight[slot]) {
+      m_slot = slot;
+      m_transfer = m_transfers[slot];
+      return;
+    }
+  }
+}
 }  // namespace usbdmx
 }  // namespace plugin
 }  // namespace ola
@@ -22,6 +22,7 @@
 #define PLUGINS_USBDMX_ASYNCUSBTRANSCEIVERBASE_H_
 
 #include <libusb.h>
+#include <vector>
 
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/DmxBuffer.h"
@@ -42,9 +43,13 @@ class AsyncUsbTransceiverBase {
    * @brief Create a new AsyncUsbTransceiverBase.
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
+   * @param transfer_count the maximum number of transfers that may be in
+   *   flight at once. Subclasses that use more than one must keep a separate
+   *   buffer for each, see TransferSlot().
    */
   AsyncUsbTransceiverBase(ola::usb::LibUsbAdaptor* const adaptor,
-                          libusb_device *usb_device);
+                          libusb_device *usb_device,
+                          unsigned int transfer_count = 1);
 
   /**
    * @brief Destructor
@@ -101,6 +106,30 @@ class AsyncUsbTransceiverBase {
    */
   void CancelTransfer();
 
+  /**
+   * @brief Check if another transfer can be submitted.
+   * @returns true if the device is connected and fewer than transfer_count
+   *   transfers are in flight.
+   */
+  bool CanSubmitTransfer() const;  // EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+
+  /**
+   * @brief The index of the transfer the Fill*() methods will use.
+   * @returns a value less than the transfer_count passed to the constructor.
+   *
+   * This is stable from the time a transfer is filled until it completes, so
+   * it can be used to select a per-transfer buffer.
+   */
+  unsigned int TransferSlot() const { return m_slot; }
+
+  /**
+   * @brief Update the transfer state once a transfer has completed.
+   * @param transfer the completed transfer.
+   * @returns false if the transfer doesn't belong to this object.
+   */
+  bool MarkTransferComplete(struct libusb_transfer *transfer);
+  // EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+
   /**
    * @brief Fill a control transfer.
    * @param buffer passed to libusb_fill_control_transfer.
@@ -134,12 +163,21 @@ class AsyncUsbTransceiverBase {
 
   libusb_device_handle *m_usb_handle;
   bool m_suppress_continuation;
+  // The transfer the Fill*() methods use, this is always one that isn't in
+  // flight unless all of them are.
   struct libusb_transfer *m_transfer;
 
   TransferState m_transfer_state;  // GUARDED_BY(m_mutex);
   ola::thread::Mutex m_mutex;
 
  private:
+  std::vector<struct libusb_transfer*> m_transfers;
+  std::vector<bool> m_in_flight;  // GUARDED_BY(m_mutex);
+  unsigned int m_in_flight_count;  // GUARDED_BY(m_mutex);
+  unsigned int m_slot;  // GUARDED_BY(m_mutex);
+
+  void SelectFreeTransfer();
+
   DISALLOW_COPY_AND_ASSIGN(AsyncUsbTransceiverBase);
 };
 }  // namespace usbdmx
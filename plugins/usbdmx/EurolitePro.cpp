@@ -48,6 +48,8 @@ static const uint8_t END_OF_MESSAGE = 0xe7;
 static const unsigned char ENDPOINT = 0x02;
 static const uint8_t MK2_SET_BAUD_RATE = 0x03;
 static const unsigned int MK2_TIMEOUT_MS = 500;
+// The number of frames the async sender keeps in flight.
+enum { TRANSFER_COUNT = 2 };
 enum { EUROLITE_PRO_FRAME_SIZE = 518 };
 
 /*
@@ -219,7 +221,7 @@ class EuroliteProAsyncUsbSender : public AsyncUsbSender {
   EuroliteProAsyncUsbSender(LibUsbAdaptor *adaptor,
                             libusb_device *usb_device,
                             bool is_mk2)
-      : AsyncUsbSender(adaptor, usb_device),
+      : AsyncUsbSender(adaptor, usb_device, TRANSFER_COUNT),
         m_is_mk2(is_mk2) {
   }
 
@@ -264,14 +266,15 @@ class EuroliteProAsyncUsbSender : public AsyncUsbSender {
   }
 
   bool PerformTransfer(const DmxBuffer &buffer) {
-    CreateFrame(buffer, m_tx_frame);
-    FillBulkTransfer(ENDPOINT, m_tx_frame, EUROLITE_PRO_FRAME_SIZE,
+    uint8_t *frame = m_tx_frames[TransferSlot()];
+    CreateFrame(buffer, frame);
+    FillBulkTransfer(ENDPOINT, frame, EUROLITE_PRO_FRAME_SIZE,
                      URB_TIMEOUT_MS);
     return (SubmitTransfer() == 0);
   }
 
  private:
-  uint8_t m_tx_frame[EUROLITE_PRO_FRAME_SIZE];
+  uint8_t m_tx_frames[TRANSFER_COUNT][EUROLITE_PRO_FRAME_SIZE];
   bool m_is_mk2;
 
   DISALLOW_COPY_AND_ASSIGN(EuroliteProAsyncUsbSender);
@@ -40,6 +40,7 @@ namespace ola {
 namespace plugin {
 namespace usbdmx {
 
+using ola::dmx::PixelProcessor;
 using ola::usb::LibUsbAdaptor;
 using std::string;
 
@@ -75,6 +76,8 @@ static const uint8_t PACKETS_PER_UPDATE = 25;
 static const uint8_t LUT_ROWS_PER_PACKET = 31;
 // The padding byte offset
 static const uint8_t LUT_DATA_OFFSET = 1;
+// How long the sender thread sleeps for if the frame hasn't changed.
+static const unsigned int IDLE_SLEEP_US = 2000;
 
 PACK(
 struct fadecandy_packet {
@@ -91,12 +94,33 @@ struct fadecandy_packet {
   }
 });
 
+/*
+ * Return a PixelProcessor which only changes the color order, or NULL if the
+ * order is unchanged. The rest of the processing is done by the device.
+ */
+PixelProcessor *NewColorOrderProcessor(
+    const PixelProcessor::Options &pixel_processing) {
+  PixelProcessor::Options options;
+  std::copy(pixel_processing.color_order,
+            pixel_processing.color_order + PixelProcessor::SLOTS_PER_PIXEL,
+            options.color_order);
+  PixelProcessor *processor = new PixelProcessor(options);
+  if (processor->IsIdentity()) {
+    delete processor;
+    return NULL;
+  }
+  return processor;
+}
+
 bool InitializeWidget(LibUsbAdaptor *adaptor,
-                      libusb_device_handle *usb_handle) {
+                      libusb_device_handle *usb_handle,
+                      const PixelProcessor::Options &pixel_processing) {
   // Set the fadecandy configuration.
   fadecandy_packet packet;
   packet.control = TYPE_CONFIG;
-  packet.data[0] |= OPTION_NO_DITHERING;  // Default to no processing
+  if (!pixel_processing.dither) {
+    packet.data[0] |= OPTION_NO_DITHERING;
+  }
   packet.data[0] |= OPTION_NO_INTERPOLATION;
 
   // packet.data[0] = OPTION_NO_ACTIVITY_LED;  // Manual control of LED
@@ -114,23 +138,16 @@ bool InitializeWidget(LibUsbAdaptor *adaptor,
     return false;
   }
 
-  // Build the Look Up Table
+  // Build the Look Up Table. The device channels are in output order, so
+  // each uses the transfer function of the color that ends up there.
+  PixelProcessor processor(pixel_processing);
   uint16_t lut[NUM_CHANNELS * LUT_ROWS_PER_CHANNEL];
   memset(&lut, 0, sizeof(lut));
   for (unsigned int channel = 0; channel < NUM_CHANNELS; channel++) {
+    const unsigned int color = pixel_processing.color_order[channel];
     for (unsigned int value = 0; value < LUT_ROWS_PER_CHANNEL; value++) {
-      // Fadecandy Python Example as C++
-      // lut[channel][value] = std::min(
-      //     static_cast<int>(std::numeric_limits<uint16_t>::max()),
-      //     int(pow(value / 256.0, 2.2) *
-      //         (std::numeric_limits<uint16_t>::max() + 1)));
-
-      // 1:1 for now
-      // TODO(Peter): Add support for more built in or custom LUTs
       unsigned int overall_lut_row = (channel * LUT_ROWS_PER_CHANNEL) + value;
-      lut[overall_lut_row] = std::min(
-          static_cast<unsigned int>(std::numeric_limits<uint16_t>::max()),
-          (value << 8));
+      lut[overall_lut_row] = processor.Transfer(color, value / 256.0);
       OLA_DEBUG << "Generated LUT for channel " << channel << " value "
                 << value << " with val " << lut[overall_lut_row];
     }
@@ -180,23 +197,97 @@ bool InitializeWidget(LibUsbAdaptor *adaptor,
   return true;
 }
 
-void UpdatePacketsWithDMX(fadecandy_packet packets[PACKETS_PER_UPDATE],
-                          const DmxBuffer &buffer) {
-  for (unsigned int packet_index = 0; packet_index < PACKETS_PER_UPDATE;
-       packet_index++) {
-    packets[packet_index].Reset();
+/*
+ * The framebuffer packets sent to the device.
+ *
+ * The packets are kept between frames, and only the ones whose slots have
+ * changed are rebuilt. The firmware rotates between framebuffers, so every
+ * packet of a frame has to be sent, but a frame that hasn't changed doesn't
+ * need to be sent at all since interpolation is disabled and the device holds
+ * the last frame.
+ */
+class FadecandyFrame {
+ public:
+  FadecandyFrame()
+      : m_valid(false) {
+    for (unsigned int packet_index = 0; packet_index < PACKETS_PER_UPDATE;
+         packet_index++) {
+      m_packets[packet_index].control = TYPE_FRAMEBUFFER | packet_index;
+    }
+    m_packets[PACKETS_PER_UPDATE - 1].control |= FINAL;
+    memset(m_slots, 0, sizeof(m_slots));
+  }
 
-    unsigned int dmx_offset = packet_index * SLOTS_PER_PACKET;
-    unsigned int slots_in_packet = SLOTS_PER_PACKET;
-    buffer.GetRange(dmx_offset, packets[packet_index].data,
-                    &slots_in_packet);
+  /*
+   * Update the packets from a DMX frame. Each packet holds a whole number of
+   * pixels, so the color order can be applied as the data is copied into the
+   * packets.
+   * Returns true if the frame is different from the last one.
+   */
+  bool Update(const DmxBuffer &buffer, PixelProcessor *color_order) {
+    const unsigned int size = std::min(buffer.Size(),
+                                       static_cast<unsigned int>(FRAME_SLOTS));
+    const uint8_t *data = buffer.GetRaw();
+    bool changed = false;
+
+    for (unsigned int packet_index = 0; packet_index < PACKETS_PER_UPDATE;
+         packet_index++) {
+      const unsigned int offset = packet_index * SLOTS_PER_PACKET;
+      const unsigned int length = offset < size ?
+          std::min(static_cast<unsigned int>(SLOTS_PER_PACKET),
+                   size - offset) :
+          0;
+      uint8_t *last = m_slots + offset;
+      if (m_valid && memcmp(last, data + offset, length) == 0 &&
+          IsZero(last + length, SLOTS_PER_PACKET - length)) {
+        continue;
+      }
+
+      memcpy(last, data + offset, length);
+      memset(last + length, 0, SLOTS_PER_PACKET - length);
+
+      uint8_t *packet_data = m_packets[packet_index].data;
+      memset(packet_data, 0, SLOTS_PER_PACKET);
+      if (color_order) {
+        unsigned int pixels = length / PixelProcessor::SLOTS_PER_PIXEL;
+        unsigned int processed = pixels * PixelProcessor::SLOTS_PER_PIXEL;
+        color_order->Process(last, pixels, packet_data);
+        memcpy(packet_data + processed, last + processed,
+               length - processed);
+      } else {
+        memcpy(packet_data, last, length);
+      }
+      changed = true;
+    }
+    m_valid = true;
+    return changed;
+  }
 
-    packets[packet_index].control = TYPE_FRAMEBUFFER | packet_index;
-    if (packet_index == (PACKETS_PER_UPDATE - 1)) {
-      packets[packet_index].control |= FINAL;
+  unsigned char *Data() {
+    return reinterpret_cast<unsigned char*>(m_packets);
+  }
+
+  int Size() const { return sizeof(m_packets); }
+
+ private:
+  enum { FRAME_SLOTS = PACKETS_PER_UPDATE * SLOTS_PER_PACKET };
+
+  bool m_valid;
+  fadecandy_packet m_packets[PACKETS_PER_UPDATE];
+  // The slots used to build the packets, zero padded.
+  uint8_t m_slots[FRAME_SLOTS];
+
+  static bool IsZero(const uint8_t *data, unsigned int length) {
+    for (unsigned int i = 0; i < length; i++) {
+      if (data[i]) {
+        return false;
+      }
     }
+    return true;
   }
-}
+
+  DISALLOW_COPY_AND_ASSIGN(FadecandyFrame);
+};
 
 }  // namespace
 
@@ -210,14 +301,17 @@ class FadecandyThreadedSender: public ThreadedUsbSender {
  public:
   FadecandyThreadedSender(LibUsbAdaptor *adaptor,
                           libusb_device *usb_device,
-                          libusb_device_handle *handle)
+                          libusb_device_handle *handle,
+                          const PixelProcessor::Options &pixel_processing)
       : ThreadedUsbSender(usb_device, handle),
-        m_adaptor(adaptor) {
+        m_adaptor(adaptor),
+        m_color_order(NewColorOrderProcessor(pixel_processing)) {
   }
 
  private:
   LibUsbAdaptor* const m_adaptor;
-  fadecandy_packet m_data_packets[PACKETS_PER_UPDATE];
+  std::auto_ptr<PixelProcessor> m_color_order;
+  FadecandyFrame m_frame;
 
   bool TransmitBuffer(libusb_device_handle *handle,
                       const DmxBuffer &buffer);
@@ -225,15 +319,18 @@ class FadecandyThreadedSender: public ThreadedUsbSender {
 
 bool FadecandyThreadedSender::TransmitBuffer(libusb_device_handle *handle,
                                              const DmxBuffer &buffer) {
-  UpdatePacketsWithDMX(m_data_packets, buffer);
+  if (!m_frame.Update(buffer, m_color_order.get())) {
+    // The device is still showing this frame, leave the bus free for other
+    // devices.
+    usleep(IDLE_SLEEP_US);
+    return true;
+  }
 
   int bytes_sent = 0;
   // We do a single bulk transfer of the entire data, rather than one transfer
   // for each 64 bytes.
   int r = m_adaptor->BulkTransfer(
-      handle, ENDPOINT,
-      reinterpret_cast<unsigned char*>(&m_data_packets),
-      sizeof(m_data_packets), &bytes_sent,
+      handle, ENDPOINT, m_frame.Data(), m_frame.Size(), &bytes_sent,
       URB_TIMEOUT_MS);
   if (r != 0) {
     OLA_WARN << "Data transfer failed with error "
@@ -248,8 +345,9 @@ bool FadecandyThreadedSender::TransmitBuffer(libusb_device_handle *handle,
 SynchronousScanlimeFadecandy::SynchronousScanlimeFadecandy(
     LibUsbAdaptor *adaptor,
     libusb_device *usb_device,
-    const std::string &serial)
-    : ScanlimeFadecandy(adaptor, usb_device, serial) {
+    const std::string &serial,
+    const PixelProcessor::Options &pixel_processing)
+    : ScanlimeFadecandy(adaptor, usb_device, serial, pixel_processing) {
 }
 
 bool SynchronousScanlimeFadecandy::Init() {
@@ -261,13 +359,14 @@ bool SynchronousScanlimeFadecandy::Init() {
     return false;
   }
 
-  if (!InitializeWidget(m_adaptor, usb_handle)) {
+  if (!InitializeWidget(m_adaptor, usb_handle, m_pixel_processing)) {
     m_adaptor->Close(usb_handle);
     return false;
   }
 
   std::auto_ptr<FadecandyThreadedSender> sender(
-      new FadecandyThreadedSender(m_adaptor, m_usb_device, usb_handle));
+      new FadecandyThreadedSender(m_adaptor, m_usb_device, usb_handle,
+                                  m_pixel_processing));
   if (!sender->Start()) {
     return false;
   }
@@ -284,8 +383,11 @@ bool SynchronousScanlimeFadecandy::SendDMX(const DmxBuffer &buffer) {
 class FadecandyAsyncUsbSender : public AsyncUsbSender {
  public:
   FadecandyAsyncUsbSender(LibUsbAdaptor *adaptor,
-                          libusb_device *usb_device)
-      : AsyncUsbSender(adaptor, usb_device) {
+                          libusb_device *usb_device,
+                          const PixelProcessor::Options &pixel_processing)
+      : AsyncUsbSender(adaptor, usb_device),
+        m_pixel_processing(pixel_processing),
+        m_color_order(NewColorOrderProcessor(pixel_processing)) {
   }
 
   libusb_device_handle* SetupHandle();
@@ -293,7 +395,9 @@ class FadecandyAsyncUsbSender : public AsyncUsbSender {
   bool PerformTransfer(const DmxBuffer &buffer);
 
  private:
-  fadecandy_packet m_data_packets[PACKETS_PER_UPDATE];
+  const PixelProcessor::Options m_pixel_processing;
+  std::auto_ptr<PixelProcessor> m_color_order;
+  FadecandyFrame m_frame;
 
   DISALLOW_COPY_AND_ASSIGN(FadecandyAsyncUsbSender);
 };
@@ -305,7 +409,7 @@ libusb_device_handle* FadecandyAsyncUsbSender::SetupHandle() {
     return NULL;
   }
 
-  if (!InitializeWidget(m_adaptor, usb_handle)) {
+  if (!InitializeWidget(m_adaptor, usb_handle, m_pixel_processing)) {
     m_adaptor->Close(usb_handle);
     return NULL;
   }
@@ -313,13 +417,12 @@ libusb_device_handle* FadecandyAsyncUsbSender::SetupHandle() {
 }
 
 bool FadecandyAsyncUsbSender::PerformTransfer(const DmxBuffer &buffer) {
-  UpdatePacketsWithDMX(m_data_packets, buffer);
+  if (!m_frame.Update(buffer, m_color_order.get())) {
+    return true;  // the device already has this frame
+  }
   // We do a single bulk transfer of the entire data, rather than one transfer
   // for each 64 bytes.
-  FillBulkTransfer(ENDPOINT,
-                   reinterpret_cast<unsigned char*>(&m_data_packets),
-                   sizeof(m_data_packets),
-                   URB_TIMEOUT_MS);
+  FillBulkTransfer(ENDPOINT, m_frame.Data(), m_frame.Size(), URB_TIMEOUT_MS);
   return (SubmitTransfer() == 0);
 }
 
@@ -329,9 +432,11 @@ bool FadecandyAsyncUsbSender::PerformTransfer(const DmxBuffer &buffer) {
 AsynchronousScanlimeFadecandy::AsynchronousScanlimeFadecandy(
     LibUsbAdaptor *adaptor,
     libusb_device *usb_device,
-    const std::string &serial)
-    : ScanlimeFadecandy(adaptor, usb_device, serial) {
-  m_sender.reset(new FadecandyAsyncUsbSender(m_adaptor, usb_device));
+    const std::string &serial,
+    const PixelProcessor::Options &pixel_processing)
+    : ScanlimeFadecandy(adaptor, usb_device, serial, pixel_processing) {
+  m_sender.reset(new FadecandyAsyncUsbSender(m_adaptor, usb_device,
+                                             pixel_processing));
 }
 
 bool AsynchronousScanlimeFadecandy::Init() {
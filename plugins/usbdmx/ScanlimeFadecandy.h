@@ -28,6 +28,7 @@
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/PixelProcessor.h"
 #include "ola/thread/Mutex.h"
 #include "plugins/usbdmx/Widget.h"
 
@@ -43,6 +44,10 @@ namespace usbdmx {
  * introduces synchronization issues, since the underlying protocol models all 8
  * ports as a flat pixel array. For now we just expose the first 170 pixels.
  *
+ * The gamma & white balance are loaded into the device's lookup table and
+ * dithering is done by the device, only the color order is applied before
+ * the data is sent.
+ *
  * See https://github.com/scanlime/fadecandy/blob/master/README.md for more
  * information on Fadecandy devices.
  */
@@ -50,8 +55,10 @@ class ScanlimeFadecandy: public SimpleWidget {
  public:
   ScanlimeFadecandy(ola::usb::LibUsbAdaptor *adaptor,
                     libusb_device *usb_device,
-                    const std::string &serial)
+                    const std::string &serial,
+                    const ola::dmx::PixelProcessor::Options &pixel_processing)
       : SimpleWidget(adaptor, usb_device),
+        m_pixel_processing(pixel_processing),
         m_serial(serial) {
   }
 
@@ -63,6 +70,9 @@ class ScanlimeFadecandy: public SimpleWidget {
     return m_serial;
   }
 
+ protected:
+  const ola::dmx::PixelProcessor::Options m_pixel_processing;
+
  private:
   std::string m_serial;
 };
@@ -79,10 +89,13 @@ class SynchronousScanlimeFadecandy: public ScanlimeFadecandy {
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
    * @param serial the serial number of the widget.
+   * @param pixel_processing the processing to apply to the pixel data.
    */
-  SynchronousScanlimeFadecandy(ola::usb::LibUsbAdaptor *adaptor,
-                               libusb_device *usb_device,
-                               const std::string &serial);
+  SynchronousScanlimeFadecandy(
+      ola::usb::LibUsbAdaptor *adaptor,
+      libusb_device *usb_device,
+      const std::string &serial,
+      const ola::dmx::PixelProcessor::Options &pixel_processing);
 
   bool Init();
 
@@ -104,10 +117,13 @@ class AsynchronousScanlimeFadecandy : public ScanlimeFadecandy {
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
    * @param serial the serial number of the widget.
+   * @param pixel_processing the processing to apply to the pixel data.
    */
-  AsynchronousScanlimeFadecandy(ola::usb::LibUsbAdaptor *adaptor,
-                                libusb_device *usb_device,
-                                const std::string &serial);
+  AsynchronousScanlimeFadecandy(
+      ola::usb::LibUsbAdaptor *adaptor,
+      libusb_device *usb_device,
+      const std::string &serial,
+      const ola::dmx::PixelProcessor::Options &pixel_processing);
 
   bool Init();
 
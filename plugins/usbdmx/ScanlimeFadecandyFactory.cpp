@@ -20,6 +20,9 @@
 
 #include "plugins/usbdmx/ScanlimeFadecandyFactory.h"
 
+#include <string>
+#include <vector>
+
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
@@ -31,7 +34,10 @@ namespace ola {
 namespace plugin {
 namespace usbdmx {
 
+using ola::dmx::PixelProcessor;
 using ola::usb::LibUsbAdaptor;
+using std::string;
+using std::vector;
 
 const char ScanlimeFadecandyFactory::EXPECTED_MANUFACTURER[] = "scanlime";
 const char ScanlimeFadecandyFactory::EXPECTED_PRODUCT[] = "Fadecandy";
@@ -77,16 +83,36 @@ bool ScanlimeFadecandyFactory::DeviceAdded(
     }
   }
 
+  PixelProcessor::Options pixel_processing;
+  PopulatePixelProcessingOptions(info.serial, &pixel_processing);
+
   ScanlimeFadecandy *widget = NULL;
   if (FLAGS_use_async_libusb) {
     widget = new AsynchronousScanlimeFadecandy(m_adaptor, usb_device,
-                                               info.serial);
+                                               info.serial, pixel_processing);
   } else {
     widget = new SynchronousScanlimeFadecandy(m_adaptor, usb_device,
-                                              info.serial);
+                                              info.serial, pixel_processing);
   }
   return AddWidget(observer, widget);
 }
+
+/*
+ * The keys are fadecandy-<serial>-<option>, e.g. fadecandy-ABCDEF-gamma.
+ */
+void ScanlimeFadecandyFactory::PopulatePixelProcessingOptions(
+    const string &serial,
+    PixelProcessor::Options *options) {
+  const vector<string> &names = PixelProcessor::OptionNames();
+  vector<string>::const_iterator iter = names.begin();
+  for (; iter != names.end(); ++iter) {
+    const string key = "fadecandy-" + serial + "-" + *iter;
+    if (!PixelProcessor::SetOption(*iter, m_preferences->GetValue(key),
+                                   options)) {
+      OLA_WARN << "Invalid value for " << key;
+    }
+  }
+}
 }  // namespace usbdmx
 }  // namespace plugin
 }  // namespace ola
@@ -21,8 +21,12 @@
 #ifndef PLUGINS_USBDMX_SCANLIMEFADECANDYFACTORY_H_
 #define PLUGINS_USBDMX_SCANLIMEFADECANDYFACTORY_H_
 
+#include <string>
+
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/PixelProcessor.h"
+#include "olad/Preferences.h"
 #include "plugins/usbdmx/WidgetFactory.h"
 
 namespace ola {
@@ -35,10 +39,12 @@ namespace usbdmx {
 class ScanlimeFadecandyFactory
     : public BaseWidgetFactory<class ScanlimeFadecandy> {
  public:
-  explicit ScanlimeFadecandyFactory(ola::usb::LibUsbAdaptor *adaptor)
+  ScanlimeFadecandyFactory(ola::usb::LibUsbAdaptor *adaptor,
+                           Preferences *preferences)
       : BaseWidgetFactory<class ScanlimeFadecandy>("ScanlimeFadecandyFactory"),
         m_missing_serial_number(false),
-        m_adaptor(adaptor) {
+        m_adaptor(adaptor),
+        m_preferences(preferences) {
   }
 
   bool DeviceAdded(
@@ -49,6 +55,11 @@ class ScanlimeFadecandyFactory
  private:
   bool m_missing_serial_number;
   ola::usb::LibUsbAdaptor *m_adaptor;
+  Preferences *m_preferences;
+
+  void PopulatePixelProcessingOptions(
+      const std::string &serial,
+      ola::dmx::PixelProcessor::Options *options);
 
   static const char EXPECTED_MANUFACTURER[];
   static const char EXPECTED_PRODUCT[];
@@ -79,7 +79,8 @@ SyncPluginImpl::SyncPluginImpl(PluginAdaptor *plugin_adaptor,
   m_widget_factories.push_back(new DMXCreator512BasicFactory(&m_usb_adaptor));
   m_widget_factories.push_back(new EuroliteProFactory(&m_usb_adaptor,
       m_preferences));
-  m_widget_factories.push_back(new ScanlimeFadecandyFactory(&m_usb_adaptor));
+  m_widget_factories.push_back(new ScanlimeFadecandyFactory(&m_usb_adaptor,
+                                                            m_preferences));
   m_widget_factories.push_back(new ShowJockeyDMXU1Factory(&m_usb_adaptor));
   m_widget_factories.push_back(new SunliteFactory(&m_usb_adaptor));
   m_widget_factories.push_back(new VellemanK8062Factory(&m_usb_adaptor));
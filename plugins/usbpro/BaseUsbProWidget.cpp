@@ -31,6 +31,7 @@
 #include <string>
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/io/IOQueue.h"
 #include "ola/io/IOUtils.h"
 #include "ola/io/Serial.h"
 #include "ola/base/Macro.h"
@@ -59,10 +60,20 @@ BaseUsbProWidget::BaseUsbProWidget(
 
 
 BaseUsbProWidget::~BaseUsbProWidget() {
+  m_sender.reset();
   m_descriptor->SetOnData(NULL);
 }
 
 
+void BaseUsbProWidget::EnableOutputQueue(
+    ola::io::SelectServerInterface *ss) {
+  m_sender.reset();
+  m_memory_pool.reset(new ola::io::MemoryBlockPool());
+  m_sender.reset(new ola::io::NonBlockingSender(
+      m_descriptor, ss, m_memory_pool.get(), OUTPUT_QUEUE_SIZE));
+}
+
+
 /*
  * Read data from the widget
  */
@@ -113,6 +124,16 @@ bool BaseUsbProWidget::SendMessage(uint8_t label,
   memcpy(frame + sizeof(message_header), data, length);
   frame[frame_size - 1] = EOM;
 
+  if (m_sender.get()) {
+    ola::io::IOQueue queue(m_memory_pool.get());
+    queue.Write(frame, frame_size);
+    if (IsDmxLabel(label)) {
+      m_sender->SendLatestMessage(label, &queue);
+      return true;
+    }
+    return m_sender->SendMessage(&queue);
+  }
+
   ssize_t bytes_sent = m_descriptor->Send(frame, frame_size);
   if (bytes_sent != frame_size)
     // we've probably screwed framing at this point
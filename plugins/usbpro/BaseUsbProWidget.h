@@ -23,10 +23,14 @@
 #define PLUGINS_USBPRO_BASEUSBPROWIDGET_H_
 
 #include <stdint.h>
+#include <memory>
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/io/Descriptor.h"
+#include "ola/io/MemoryBlockPool.h"
+#include "ola/io/NonBlockingSender.h"
+#include "ola/io/SelectServerInterface.h"
 #include "plugins/usbpro/SerialWidgetInterface.h"
 
 namespace ola {
@@ -54,6 +58,16 @@ class BaseUsbProWidget: public SerialWidgetInterface {
                    const uint8_t *data,
                    unsigned int length) const;
 
+  /*
+   * Queue messages rather than writing them directly to the descriptor.
+   * Only the newest unsent frame for each DMX label is kept, other messages
+   * are sent in order. This must be called from the thread that runs ss.
+   */
+  void EnableOutputQueue(ola::io::SelectServerInterface *ss);
+
+  // Drop any queued messages, this should be called from Stop().
+  void DisableOutputQueue() { m_sender.reset(); }
+
   static ola::io::ConnectedDescriptor *OpenDevice(const std::string &path);
 
   static const uint8_t DEVICE_LABEL = 78;
@@ -88,14 +102,22 @@ class BaseUsbProWidget: public SerialWidgetInterface {
   message_header m_header;
   uint8_t m_recv_buffer[MAX_DATA_SIZE];
 
+  std::auto_ptr<ola::io::MemoryBlockPool> m_memory_pool;
+  std::auto_ptr<ola::io::NonBlockingSender> m_sender;
+
   void ReceiveMessage();
   virtual void HandleMessage(uint8_t label,
                              const uint8_t *data,
                              unsigned int length) = 0;
 
+  // Labels where only the latest message matters.
+  virtual bool IsDmxLabel(uint8_t label) const { return label == DMX_LABEL; }
+
   static const uint8_t EOM = 0xe7;
   static const uint8_t SOM = 0x7e;
   static const unsigned int HEADER_SIZE;
+  // Enough for a couple of RDM requests on each port.
+  static const unsigned int OUTPUT_QUEUE_SIZE = 2048;
 };
 
 
@@ -756,6 +756,9 @@ class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
     // We override handle message to catch the messages, and dispatch them to
     // the correct port.
     void HandleMessage(uint8_t label, const uint8_t *data, unsigned int length);
+    bool IsDmxLabel(uint8_t label) const {
+      return label == SEND_DMX_1 || label == SEND_DMX_2;
+    }
     void HandleLabel(EnttecPortImpl *port, const OperationLabels &ops,
                      uint8_t label, const uint8_t *data, unsigned int length);
     void HandlePortAssignment(const uint8_t *data, unsigned int length);
@@ -841,6 +844,7 @@ void EnttecUsbProWidgetImpl::Stop() {
     (*cb_iter)->Run(false, 0, 0);
   }
   m_port_assignment_callbacks.clear();
+  DisableOutputQueue();
 }
 
 
@@ -987,6 +991,11 @@ void EnttecUsbProWidget::Stop() {
   m_impl->Stop();
 }
 
+void EnttecUsbProWidget::EnableOutputQueue(
+    ola::io::SelectServerInterface *ss) {
+  m_impl->EnableOutputQueue(ss);
+}
+
 unsigned int EnttecUsbProWidget::PortCount() const {
   return m_impl->PortCount();
 }
@@ -26,6 +26,7 @@
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/thread/SchedulerInterface.h"
 #include "ola/rdm/DiscoveryAgent.h"
 #include "ola/rdm/QueueingRDMController.h"
@@ -126,6 +127,12 @@ class EnttecUsbProWidget: public SerialWidgetInterface {
     void GetPortAssignments(EnttecUsbProPortAssignmentCallback *callback);
 
     void Stop();
+
+    /*
+     * Queue writes to the widget, see BaseUsbProWidget::EnableOutputQueue().
+     */
+    void EnableOutputQueue(ola::io::SelectServerInterface *ss);
+
     unsigned int PortCount() const;
     EnttecPort *GetPort(unsigned int i);
     ola::io::ConnectedDescriptor *GetDescriptor() const;
@@ -46,6 +46,10 @@ class UltraDMXProWidget: public GenericUsbProWidget {
 
  private:
     bool SendDMXWithLabel(uint8_t label, const DmxBuffer &data);
+    bool IsDmxLabel(uint8_t label) const {
+      return (label == DMX_LABEL || label == DMX_PRIMARY_PORT ||
+              label == DMX_SECONDARY_PORT);
+    }
 
     static const uint8_t DMX_PRIMARY_PORT = 100;
     static const uint8_t DMX_SECONDARY_PORT = 101;
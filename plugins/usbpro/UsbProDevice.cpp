@@ -48,6 +48,10 @@ using std::string;
  * @param owner  the plugin that owns this device
  * @param name  the device name
  * @param dev_path  path to the pro widget
+ * @param refresh_interval_ms if non-0, skip frames which match the last one
+ *   sent, but resend at least this often.
+ * @param input_change_only put the inputs in change of state mode, so the
+ *   widget only sends the slots which changed.
  */
 UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
                            ola::AbstractPlugin *owner,
@@ -55,7 +59,9 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
                            EnttecUsbProWidget *widget,
                            uint32_t serial,
                            uint16_t firmware_version,
-                           unsigned int fps_limit)
+                           unsigned int fps_limit,
+                           unsigned int refresh_interval_ms,
+                           bool input_change_only)
     : UsbSerialDevice(owner, name, widget),
       m_pro_widget(widget),
       m_serial(SerialToString(serial)) {
@@ -87,9 +93,15 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
         this, enttec_port, i, port_description.str(),
         plugin_adaptor->WakeUpTime(),
         5,  // allow up to 5 burst frames
-        fps_limit);  // 200 frames per second seems to be the limit
+        fps_limit,  // 200 frames per second seems to be the limit
+        refresh_interval_ms,
+        input_change_only);
     AddPort(output_port);
 
+    if (input_change_only) {
+      enttec_port->ChangeToReceiveMode(true);
+    }
+
     PortParams port_params = {false, 0, 0, 0};
     m_port_params.push_back(port_params);
     enttec_port->GetParameters(
@@ -47,7 +47,9 @@ class UsbProDevice: public UsbSerialDevice {
                EnttecUsbProWidget *widget,
                uint32_t serial,
                uint16_t firmware_version,
-               unsigned int fps_limit);
+               unsigned int fps_limit,
+               unsigned int refresh_interval_ms = 0,
+               bool input_change_only = false);
 
   std::string DeviceId() const { return m_serial; }
 
@@ -137,7 +139,12 @@ class UsbProInputPort: public BasicInputPort {
 
 
 /*
- * The output port
+ * The output port.
+ *
+ * The widget keeps sending the last frame it was given, so if a refresh
+ * interval is set, frames which match the last one sent are skipped until the
+ * interval has passed. This saves bandwidth when several widgets share a USB
+ * 1.1 hub.
  */
 class UsbProOutputPort: public BasicOutputPort {
  public:
@@ -148,15 +155,28 @@ class UsbProOutputPort: public BasicOutputPort {
                    const std::string &description,
                    const TimeStamp *wake_time,
                    unsigned int max_burst,
-                   unsigned int rate)
+                   unsigned int rate,
+                   unsigned int refresh_interval_ms = 0,
+                   bool input_change_only = false)
       : BasicOutputPort(parent, id, port->SupportsRDM(), port->SupportsRDM()),
         m_description(description),
         m_port(port),
         m_bucket(max_burst, rate, max_burst, *wake_time),
-        m_wake_time(wake_time) {}
+        m_wake_time(wake_time),
+        m_refresh_interval(static_cast<int64_t>(refresh_interval_ms) * 1000),
+        m_input_change_only(input_change_only) {}
 
   bool WriteDMX(const DmxBuffer &buffer, uint8_t) {
+    if (!m_refresh_interval.IsZero() && buffer == m_last_frame &&
+        *m_wake_time < m_next_refresh) {
+      return true;
+    }
+
     if (m_bucket.GetToken(*m_wake_time)) {
+      if (!m_refresh_interval.IsZero()) {
+        m_last_frame.Set(buffer);
+        m_next_refresh = *m_wake_time + m_refresh_interval;
+      }
       return m_port->SendDMX(buffer);
     } else {
       OLA_INFO << "Port rated limited, dropping frame";
@@ -166,7 +186,8 @@ class UsbProOutputPort: public BasicOutputPort {
 
   void PostSetUniverse(Universe*, Universe *new_universe) {
     if (!new_universe) {
-      m_port->ChangeToReceiveMode(false);
+      m_port->ChangeToReceiveMode(m_input_change_only);
+      m_last_frame.Reset();
     }
   }
 
@@ -190,6 +211,10 @@ class UsbProOutputPort: public BasicOutputPort {
   EnttecPort *m_port;
   TokenBucket m_bucket;
   const TimeStamp *m_wake_time;
+  const TimeInterval m_refresh_interval;
+  const bool m_input_change_only;
+  DmxBuffer m_last_frame;
+  TimeStamp m_next_refresh;
 };
 }  // namespace usbpro
 }  // namespace plugin
@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -48,6 +49,7 @@ namespace plugin {
 namespace usbpro {
 
 using std::auto_ptr;
+using std::map;
 using std::string;
 using std::vector;
 
@@ -55,15 +57,22 @@ const char UsbSerialPlugin::DEFAULT_DEVICE_DIR[] = "/dev";
 const char UsbSerialPlugin::DEVICE_DIR_KEY[] = "device_dir";
 const char UsbSerialPlugin::DEVICE_PREFIX_KEY[] = "device_prefix";
 const char UsbSerialPlugin::IGNORED_DEVICES_KEY[] = "ignore_device";
+const char UsbSerialPlugin::KNOWN_DEVICE_KEY[] = "known_device";
 const char UsbSerialPlugin::LINUX_DEVICE_PREFIX[] = "ttyUSB";
 const char UsbSerialPlugin::BSD_DEVICE_PREFIX[] = "ttyU";
 const char UsbSerialPlugin::MAC_DEVICE_PREFIX[] = "cu.usbserial-";
+const char UsbSerialPlugin::MAX_CONCURRENT_PROBES_KEY[] =
+    "max_concurrent_probes";
 const char UsbSerialPlugin::PLUGIN_NAME[] = "Serial USB";
 const char UsbSerialPlugin::PLUGIN_PREFIX[] = "usbserial";
 const char UsbSerialPlugin::ROBE_DEVICE_NAME[] = "Robe Universal Interface";
 const char UsbSerialPlugin::TRI_USE_RAW_RDM_KEY[] = "tri_use_raw_rdm";
 const char UsbSerialPlugin::USBPRO_DEVICE_NAME[] = "Enttec Usb Pro Device";
 const char UsbSerialPlugin::USB_PRO_FPS_LIMIT_KEY[] = "pro_fps_limit";
+const char UsbSerialPlugin::USB_PRO_INPUT_CHANGE_ONLY_KEY[] =
+    "pro_input_change_only";
+const char UsbSerialPlugin::USB_PRO_REFRESH_INTERVAL_KEY[] =
+    "pro_refresh_interval";
 const char UsbSerialPlugin::ULTRA_FPS_LIMIT_KEY[] = "ultra_fps_limit";
 
 UsbSerialPlugin::UsbSerialPlugin(PluginAdaptor *plugin_adaptor)
@@ -130,9 +139,12 @@ void UsbSerialPlugin::NewWidget(
     device_name = USBPRO_DEVICE_NAME;
   }
 
+  widget->EnableOutputQueue(m_plugin_adaptor);
   AddDevice(new UsbProDevice(m_plugin_adaptor, this, device_name, widget,
                              information.serial, information.firmware_version,
-                             GetProFrameLimit()));
+                             GetProFrameLimit(), GetProRefreshInterval(),
+                             m_preferences->GetValueAsBool(
+                                 USB_PRO_INPUT_CHANGE_ONLY_KEY)));
 }
 
 
@@ -189,6 +201,7 @@ void UsbSerialPlugin::NewWidget(
  */
 void UsbSerialPlugin::NewWidget(UltraDMXProWidget *widget,
                                 const UsbProWidgetInformation &information) {
+  widget->EnableOutputQueue(m_plugin_adaptor);
   AddDevice(new UltraDMXProDevice(
       m_plugin_adaptor,
       this,
@@ -206,6 +219,27 @@ void UsbSerialPlugin::NewWidget(UltraDMXProWidget *widget,
  * Add a new device to the list
  * @param device the new UsbSerialDevice
  */
+/**
+ * Remember which detector found the widget at this path, so discovery can try
+ * it first next time.
+ */
+void UsbSerialPlugin::WidgetDetected(const string &path,
+                                     const string &detector) {
+  map<string, string>::const_iterator iter = m_known_devices.find(path);
+  if (iter != m_known_devices.end() && iter->second == detector) {
+    return;
+  }
+  m_known_devices[path] = detector;
+
+  m_preferences->RemoveValue(KNOWN_DEVICE_KEY);
+  for (iter = m_known_devices.begin(); iter != m_known_devices.end(); ++iter) {
+    m_preferences->SetMultipleValue(KNOWN_DEVICE_KEY,
+                                    iter->second + ":" + iter->first);
+  }
+  m_preferences->Save();
+}
+
+
 void UsbSerialPlugin::AddDevice(UsbSerialDevice *device) {
   if (!device->Start()) {
     delete device;
@@ -232,6 +266,9 @@ bool UsbSerialPlugin::StartHook() {
       m_preferences->GetValue(DEVICE_DIR_KEY));
   m_detector_thread.SetDevicePrefixes(
       m_preferences->GetMultipleValue(DEVICE_PREFIX_KEY));
+  LoadKnownDevices();
+  m_detector_thread.SetKnownDevices(m_known_devices);
+  m_detector_thread.SetMaxConcurrentProbes(GetMaxConcurrentProbes());
   if (!m_detector_thread.Start()) {
     OLA_FATAL << "Failed to start the widget discovery thread";
     return false;
@@ -282,6 +319,15 @@ bool UsbSerialPlugin::SetDefaultPreferences() {
                                          UIntValidator(0, MAX_PRO_FPS_LIMIT),
                                          DEFAULT_PRO_FPS_LIMIT);
 
+  save |= m_preferences->SetDefaultValue(
+      USB_PRO_REFRESH_INTERVAL_KEY,
+      UIntValidator(0, MAX_PRO_REFRESH_INTERVAL),
+      DEFAULT_PRO_REFRESH_INTERVAL);
+
+  save |= m_preferences->SetDefaultValue(USB_PRO_INPUT_CHANGE_ONLY_KEY,
+                                         BoolValidator(),
+                                         false);
+
   save |= m_preferences->SetDefaultValue(ULTRA_FPS_LIMIT_KEY,
                                          UIntValidator(0, MAX_ULTRA_FPS_LIMIT),
                                          DEFAULT_ULTRA_FPS_LIMIT);
@@ -290,6 +336,11 @@ bool UsbSerialPlugin::SetDefaultPreferences() {
                                          BoolValidator(),
                                          false);
 
+  save |= m_preferences->SetDefaultValue(
+      MAX_CONCURRENT_PROBES_KEY,
+      UIntValidator(0, MAX_CONCURRENT_PROBES_LIMIT),
+      DEFAULT_MAX_CONCURRENT_PROBES);
+
   if (save) {
     m_preferences->Save();
   }
@@ -339,6 +390,51 @@ unsigned int UsbSerialPlugin::GetProFrameLimit() {
 }
 
 
+/*
+ * Get the minimum refresh interval, in ms, for a pro device
+ */
+unsigned int UsbSerialPlugin::GetProRefreshInterval() {
+  unsigned int interval;
+  if (!StringToInt(m_preferences->GetValue(USB_PRO_REFRESH_INTERVAL_KEY),
+                   &interval)) {
+    return DEFAULT_PRO_REFRESH_INTERVAL;
+  }
+  return interval;
+}
+
+
+/*
+ * Get the number of devices to probe at once.
+ */
+unsigned int UsbSerialPlugin::GetMaxConcurrentProbes() {
+  unsigned int max_probes;
+  if (!StringToInt(m_preferences->GetValue(MAX_CONCURRENT_PROBES_KEY),
+                   &max_probes)) {
+    return DEFAULT_MAX_CONCURRENT_PROBES;
+  }
+  return max_probes;
+}
+
+
+/*
+ * Load the known_device entries, which are of the form detector:path.
+ */
+void UsbSerialPlugin::LoadKnownDevices() {
+  m_known_devices.clear();
+  const vector<string> entries =
+      m_preferences->GetMultipleValue(KNOWN_DEVICE_KEY);
+  vector<string>::const_iterator iter = entries.begin();
+  for (; iter != entries.end(); ++iter) {
+    string::size_type pos = iter->find(':');
+    if (pos == string::npos || pos == 0 || pos + 1 == iter->size()) {
+      OLA_WARN << "Invalid " << KNOWN_DEVICE_KEY << " entry: " << *iter;
+      continue;
+    }
+    m_known_devices[iter->substr(pos + 1)] = iter->substr(0, pos);
+  }
+}
+
+
 /*
  * Get the Frames per second limit for a Ultra DMX Pro Device
  */
@@ -21,6 +21,7 @@
 #ifndef PLUGINS_USBPRO_USBSERIALPLUGIN_H_
 #define PLUGINS_USBPRO_USBSERIALPLUGIN_H_
 
+#include <map>
 #include <string>
 #include <vector>
 #include "ola/io/Descriptor.h"
@@ -55,6 +56,7 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
                    const RobeWidgetInformation &information);
     void NewWidget(UltraDMXProWidget *widget,
                    const UsbProWidgetInformation &information);
+    void WidgetDetected(const std::string &path, const std::string &detector);
 
  private:
     void AddDevice(UsbSerialDevice *device);
@@ -64,31 +66,44 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
     void DeleteDevice(UsbSerialDevice *device);
     std::string GetDeviceName(const UsbProWidgetInformation &information);
     unsigned int GetProFrameLimit();
+    unsigned int GetProRefreshInterval();
     unsigned int GetDmxTriFrameLimit();
     unsigned int GetUltraDMXProFrameLimit();
+    unsigned int GetMaxConcurrentProbes();
+    void LoadKnownDevices();
 
     std::vector<UsbSerialDevice*> m_devices;  // list of our devices
+    // device path to the detector that found it
+    std::map<std::string, std::string> m_known_devices;
     WidgetDetectorThread m_detector_thread;
 
     static const char DEFAULT_DEVICE_DIR[];
     static const char DEVICE_DIR_KEY[];
     static const char DEVICE_PREFIX_KEY[];
     static const char IGNORED_DEVICES_KEY[];
+    static const char KNOWN_DEVICE_KEY[];
     static const char LINUX_DEVICE_PREFIX[];
     static const char BSD_DEVICE_PREFIX[];
     static const char MAC_DEVICE_PREFIX[];
+    static const char MAX_CONCURRENT_PROBES_KEY[];
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char ROBE_DEVICE_NAME[];
     static const char TRI_USE_RAW_RDM_KEY[];
     static const char USBPRO_DEVICE_NAME[];
     static const char USB_PRO_FPS_LIMIT_KEY[];
+    static const char USB_PRO_INPUT_CHANGE_ONLY_KEY[];
+    static const char USB_PRO_REFRESH_INTERVAL_KEY[];
     static const char ULTRA_FPS_LIMIT_KEY[];
 
     static const uint8_t DEFAULT_PRO_FPS_LIMIT = 190;
     static const uint8_t DEFAULT_ULTRA_FPS_LIMIT = 40;
     static const unsigned int MAX_PRO_FPS_LIMIT = 1000;
+    static const unsigned int DEFAULT_PRO_REFRESH_INTERVAL = 0;
+    static const unsigned int MAX_PRO_REFRESH_INTERVAL = 60000;
     static const unsigned int MAX_ULTRA_FPS_LIMIT = 1000;
+    static const unsigned int DEFAULT_MAX_CONCURRENT_PROBES = 4;
+    static const unsigned int MAX_CONCURRENT_PROBES_LIMIT = 64;
 };
 }  // namespace usbpro
 }  // namespace plugin
@@ -21,6 +21,8 @@
 
 
 #include <string.h>
+#include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -48,9 +50,13 @@ namespace plugin {
 namespace usbpro {
 
 using ola::io::ConnectedDescriptor;
+using std::map;
 using std::string;
 using std::vector;
 
+const char WidgetDetectorThread::USB_PRO_DETECTOR_NAME[] = "usbpro";
+const char WidgetDetectorThread::ROBE_DETECTOR_NAME[] = "robe";
+
 
 /**
  * Constructor
@@ -66,8 +72,10 @@ WidgetDetectorThread::WidgetDetectorThread(
   ola::io::SelectServerInterface *ss,
   unsigned int usb_pro_timeout,
   unsigned int robe_timeout)
-    : ola::thread::Thread(),
+    : ola::thread::Thread(ola::thread::Thread::Options("usbpro-detector")),
       m_other_ss(ss),
+      m_max_concurrent_probes(DEFAULT_MAX_CONCURRENT_PROBES),
+      m_probes_in_flight(0),
       m_handler(handler),
       m_is_running(false),
       m_usb_pro_timeout(usb_pro_timeout),
@@ -109,6 +117,31 @@ void WidgetDetectorThread::SetIgnoredDevices(const vector<string> &devices) {
   }
 }
 
+
+/**
+ * Set the devices we've seen before. The detector that found the device last
+ * time is tried first, which avoids waiting for the other detectors to time
+ * out.
+ * @param devices a map of device path to detector name, as passed to
+ *   NewWidgetHandler::WidgetDetected().
+ */
+void WidgetDetectorThread::SetKnownDevices(
+    const map<string, string> &devices) {
+  m_known_devices = devices;
+}
+
+
+/**
+ * Set the maximum number of devices that are probed at once. Opening a large
+ * number of serial devices at the same time can starve the ones that are
+ * real widgets, so the remainder are queued.
+ * @param max_probes the limit, 0 means no limit.
+ */
+void WidgetDetectorThread::SetMaxConcurrentProbes(unsigned int max_probes) {
+  m_max_concurrent_probes = max_probes;
+}
+
+
 /**
  * Run the discovery thread.
  */
@@ -121,11 +154,13 @@ void *WidgetDetectorThread::Run() {
         ola::NewCallback(this, &WidgetDetectorThread::UsbProWidgetReady),
         ola::NewCallback(this, &WidgetDetectorThread::DescriptorFailed),
         m_usb_pro_timeout));
+    m_detector_names.push_back(USB_PRO_DETECTOR_NAME);
     m_widget_detectors.push_back(new RobeWidgetDetector(
         &m_ss,
         ola::NewCallback(this, &WidgetDetectorThread::RobeWidgetReady),
         ola::NewCallback(this, &WidgetDetectorThread::DescriptorFailed),
         m_robe_timeout));
+    m_detector_names.push_back(ROBE_DETECTOR_NAME);
   }
   RunScan();
   m_ss.RegisterRepeatingTimeout(
@@ -147,6 +182,9 @@ void *WidgetDetectorThread::Run() {
     OLA_INFO  << iter->first;
   }
   m_widget_detectors.clear();
+  m_detector_names.clear();
+  m_pending_paths.clear();
+  m_probes_in_flight = 0;
   return NULL;
 }
 
@@ -212,16 +250,37 @@ bool WidgetDetectorThread::RunScan() {
       continue;
     }
 
+    if (std::find(m_pending_paths.begin(), m_pending_paths.end(), *it) !=
+        m_pending_paths.end()) {
+      continue;
+    }
+
     OLA_INFO << "Found potential USB Serial device at " << *it;
-    ConnectedDescriptor *descriptor = BaseUsbProWidget::OpenDevice(*it);
+    m_pending_paths.push_back(*it);
+  }
+  StartPendingProbes();
+  return true;
+}
+
+
+/**
+ * Open queued devices and start discovery, up to the concurrency limit.
+ */
+void WidgetDetectorThread::StartPendingProbes() {
+  while (!m_pending_paths.empty() &&
+         (m_max_concurrent_probes == 0 ||
+          m_probes_in_flight < m_max_concurrent_probes)) {
+    const string path = m_pending_paths.front();
+    m_pending_paths.pop_front();
+
+    ConnectedDescriptor *descriptor = BaseUsbProWidget::OpenDevice(path);
     if (!descriptor) {
       continue;
     }
 
-    OLA_DEBUG << "New descriptor @ " << descriptor << " for " << *it;
-    PerformDiscovery(*it, descriptor);
+    OLA_DEBUG << "New descriptor @ " << descriptor << " for " << path;
+    PerformDiscovery(path, descriptor);
   }
-  return true;
 }
 
 /**
@@ -231,6 +290,7 @@ void WidgetDetectorThread::PerformDiscovery(const string &path,
                                             ConnectedDescriptor *descriptor) {
   m_active_descriptors[descriptor] = DescriptorInfo(path, -1);
   m_active_paths.insert(path);
+  m_probes_in_flight++;
   PerformNextDiscoveryStep(descriptor);
 }
 
@@ -243,6 +303,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
     const UsbProWidgetInformation *information) {
   // we're no longer interested in events from this widget
   m_ss.RemoveReadDescriptor(descriptor);
+  ProbeFinished();
 
   if (!m_handler) {
     OLA_WARN << "No callback defined for new Usb Pro Widgets.";
@@ -345,6 +406,7 @@ void WidgetDetectorThread::RobeWidgetReady(
     const RobeWidgetInformation *info) {
   // we're no longer interested in events from this descriptor
   m_ss.RemoveReadDescriptor(descriptor);
+  ProbeFinished();
   RobeWidget *widget = new RobeWidget(descriptor, info->uid);
 
   if (m_handler) {
@@ -366,7 +428,7 @@ void WidgetDetectorThread::DescriptorFailed(
   if (descriptor->ValidReadDescriptor()) {
     PerformNextDiscoveryStep(descriptor);
   } else {
-    FreeDescriptor(descriptor);
+    DiscoveryFailed(descriptor);
   }
 }
 
@@ -384,20 +446,72 @@ void WidgetDetectorThread::PerformNextDiscoveryStep(
   if (static_cast<unsigned int>(descriptor_info.second) ==
       m_widget_detectors.size()) {
     OLA_INFO << "no more detectors to try for  " << descriptor;
-    FreeDescriptor(descriptor);
+    DiscoveryFailed(descriptor);
   } else {
-    OLA_INFO << "trying stage " << descriptor_info.second << " for " <<
-      descriptor;
+    unsigned int detector = DetectorForStep(descriptor_info.first,
+                                            descriptor_info.second);
+    OLA_INFO << "trying stage " << descriptor_info.second << " ("
+             << m_detector_names[detector] << ") for " << descriptor;
     m_ss.AddReadDescriptor(descriptor);
-    bool ok = m_widget_detectors[descriptor_info.second]->Discover(descriptor);
+    bool ok = m_widget_detectors[detector]->Discover(descriptor);
     if (!ok) {
       m_ss.RemoveReadDescriptor(descriptor);
-      FreeDescriptor(descriptor);
+      DiscoveryFailed(descriptor);
     }
   }
 }
 
 
+/**
+ * Called when no detector claimed a descriptor.
+ */
+void WidgetDetectorThread::DiscoveryFailed(ConnectedDescriptor *descriptor) {
+  FreeDescriptor(descriptor);
+  ProbeFinished();
+}
+
+
+/**
+ * Release a discovery slot. The next probes are started from the select
+ * server since we may be deep inside a detector callback at this point.
+ */
+void WidgetDetectorThread::ProbeFinished() {
+  if (m_probes_in_flight) {
+    m_probes_in_flight--;
+  }
+  if (!m_pending_paths.empty()) {
+    m_ss.Execute(ola::NewSingleCallback(
+        this, &WidgetDetectorThread::StartPendingProbes));
+  }
+}
+
+
+/**
+ * Map a discovery step to the index of the detector to run. If we know which
+ * detector found this path last time it goes first, the rest follow in their
+ * usual order.
+ */
+unsigned int WidgetDetectorThread::DetectorForStep(const string &path,
+                                                   unsigned int step) const {
+  map<string, string>::const_iterator iter = m_known_devices.find(path);
+  if (iter == m_known_devices.end()) {
+    return step;
+  }
+
+  vector<string>::const_iterator name_iter = std::find(
+      m_detector_names.begin(), m_detector_names.end(), iter->second);
+  if (name_iter == m_detector_names.end()) {
+    return step;
+  }
+
+  unsigned int preferred = name_iter - m_detector_names.begin();
+  if (step == 0) {
+    return preferred;
+  }
+  return step <= preferred ? step - 1 : step;
+}
+
+
 /**
  * Free the widget and the associated descriptor.
  */
@@ -437,12 +551,20 @@ void WidgetDetectorThread::DispatchWidget(WidgetType *widget,
         this,
         &WidgetDetectorThread::FreeWidget,
         reinterpret_cast<SerialWidgetInterface*>(widget)));
+  const DescriptorInfo &descriptor_info =
+      m_active_descriptors[widget->GetDescriptor()];
+  const string detector = m_detector_names[
+      DetectorForStep(descriptor_info.first, descriptor_info.second)];
+  m_known_devices[descriptor_info.first] = detector;
+
   ola::SingleUseCallback0<void> *cb =
     ola::NewSingleCallback(
          this,
          &WidgetDetectorThread::SignalNewWidget<WidgetType, InfoType>,
          widget,
-         information);
+         information,
+         descriptor_info.first,
+         detector);
   m_other_ss->Execute(cb);
 }
 
@@ -452,10 +574,13 @@ void WidgetDetectorThread::DispatchWidget(WidgetType *widget,
  */
 template<typename WidgetType, typename InfoType>
 void WidgetDetectorThread::SignalNewWidget(WidgetType *widget,
-                                           const InfoType *information) {
+                                           const InfoType *information,
+                                           string path,
+                                           string detector) {
   const InfoType info(*information);
   delete information;
   m_other_ss->AddReadDescriptor(widget->GetDescriptor());
+  m_handler->WidgetDetected(path, detector);
   m_handler->NewWidget(widget, info);
 }
 
@@ -22,6 +22,7 @@
 #ifndef PLUGINS_USBPRO_WIDGETDETECTORTHREAD_H_
 #define PLUGINS_USBPRO_WIDGETDETECTORTHREAD_H_
 
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
@@ -65,6 +66,17 @@ class NewWidgetHandler {
                            const RobeWidgetInformation &information) = 0;
     virtual void NewWidget(class UltraDMXProWidget *widget,
                            const UsbProWidgetInformation &information) = 0;
+
+    /**
+     * Called before NewWidget() with the path of the widget and the name of
+     * the detector that found it. Implementations can store this and pass it
+     * back via WidgetDetectorThread::SetKnownDevices() on the next start.
+     */
+    virtual void WidgetDetected(const std::string &path,
+                                const std::string &detector) {
+      (void) path;
+      (void) detector;
+    }
 };
 
 
@@ -85,6 +97,10 @@ class WidgetDetectorThread: public ola::thread::Thread {
     void SetDevicePrefixes(const std::vector<std::string> &prefixes);
     // Must be called before Run()
     void SetIgnoredDevices(const std::vector<std::string> &devices);
+    // Must be called before Run()
+    void SetKnownDevices(const std::map<std::string, std::string> &devices);
+    // Must be called before Run()
+    void SetMaxConcurrentProbes(unsigned int max_probes);
 
     // Start the thread, this will call the SuccessHandler whenever a new
     // Widget is located.
@@ -112,6 +128,14 @@ class WidgetDetectorThread: public ola::thread::Thread {
     std::string m_directory;  // directory to look for widgets in
     std::vector<std::string> m_prefixes;  // prefixes to try
     std::set<std::string> m_ignored_devices;  // devices to ignore
+    // path to detector name, for devices we've seen before
+    std::map<std::string, std::string> m_known_devices;
+    // the detector names, in the same order as m_widget_detectors
+    std::vector<std::string> m_detector_names;
+    // paths waiting for a free discovery slot
+    std::deque<std::string> m_pending_paths;
+    unsigned int m_max_concurrent_probes;
+    unsigned int m_probes_in_flight;
     NewWidgetHandler *m_handler;
     bool m_is_running;
     unsigned int m_usb_pro_timeout;
@@ -137,6 +161,11 @@ class WidgetDetectorThread: public ola::thread::Thread {
 
     void DescriptorFailed(ola::io::ConnectedDescriptor *descriptor);
     void PerformNextDiscoveryStep(ola::io::ConnectedDescriptor *descriptor);
+    void DiscoveryFailed(ola::io::ConnectedDescriptor *descriptor);
+    void ProbeFinished();
+    void StartPendingProbes();
+    unsigned int DetectorForStep(const std::string &path,
+                                 unsigned int step) const;
     void InternalFreeWidget(SerialWidgetInterface *widget);
     void FreeDescriptor(ola::io::ConnectedDescriptor *descriptor);
 
@@ -145,11 +174,15 @@ class WidgetDetectorThread: public ola::thread::Thread {
 
     // All of these are called in a separate thread.
     template<typename WidgetType, typename InfoType>
-    void SignalNewWidget(WidgetType *widget, const InfoType *information);
+    void SignalNewWidget(WidgetType *widget, const InfoType *information,
+                         std::string path, std::string detector);
 
     void MarkAsRunning();
 
     static const unsigned int SCAN_INTERVAL_MS = 20000;
+    static const unsigned int DEFAULT_MAX_CONCURRENT_PROBES = 4;
+    static const char USB_PRO_DETECTOR_NAME[];
+    static const char ROBE_DETECTOR_NAME[];
 
     // This is how device identification is done, see
     // https://wiki.openlighting.org/index.php/USB_Protocol_Extensions
@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -95,6 +96,7 @@ class WidgetDetectorThreadTest: public CppUnit::TestFixture,
   CPPUNIT_TEST(testUsbProMkIIWidget);
   CPPUNIT_TEST(testUsbProMkIIBWidget);
   CPPUNIT_TEST(testRobeWidget);
+  CPPUNIT_TEST(testKnownRobeWidget);
   CPPUNIT_TEST(testUltraDmxWidget);
   CPPUNIT_TEST(testTimeout);
   CPPUNIT_TEST(testClose);
@@ -111,6 +113,7 @@ class WidgetDetectorThreadTest: public CppUnit::TestFixture,
     void testUsbProMkIIWidget();
     void testUsbProMkIIBWidget();
     void testRobeWidget();
+    void testKnownRobeWidget();
     void testUltraDmxWidget();
     void testTimeout();
     void testClose();
@@ -132,12 +135,19 @@ class WidgetDetectorThreadTest: public CppUnit::TestFixture,
     auto_ptr<ola::io::UnixSocket> m_other_end;
     WidgetType m_received_widget_type;
     bool m_expect_dual_port_enttec_widget;
+    string m_detected_path;
+    string m_detector;
 
     void Timeout() {
       OLA_INFO << "Timeout triggered";
       m_ss.Terminate();
     }
 
+    void WidgetDetected(const string &path, const string &detector) {
+      m_detected_path = path;
+      m_detector = detector;
+    }
+
     // widget handlers follow
     void NewWidget(ArduinoWidget *widget,
                    const UsbProWidgetInformation &information) {
@@ -486,6 +496,35 @@ void WidgetDetectorThreadTest::testRobeWidget() {
   m_thread->WaitUntilRunning();
   m_ss.Run();
   OLA_ASSERT_EQ(ROBE, m_received_widget_type);
+  OLA_ASSERT_EQ(string("/mock_device"), m_detected_path);
+  OLA_ASSERT_EQ(string("robe"), m_detector);
+}
+
+
+/**
+ * Check that a known device skips straight to the detector that found it
+ * last time.
+ */
+void WidgetDetectorThreadTest::testKnownRobeWidget() {
+  std::map<string, string> known_devices;
+  known_devices["/mock_device"] = "robe";
+  m_thread->SetKnownDevices(known_devices);
+
+  // no usb pro messages this time
+  uint8_t info_data[] = {1, 11, 3, 0, 0};
+  uint8_t uid_data[] = {0x52, 0x53, 2, 0, 0, 10};
+  m_endpoint->AddExpectedRobeDataAndReturn(
+      BaseRobeWidget::INFO_REQUEST, NULL, 0,
+      BaseRobeWidget::INFO_RESPONSE, info_data, sizeof(info_data));
+  m_endpoint->AddExpectedRobeDataAndReturn(
+      BaseRobeWidget::UID_REQUEST, NULL, 0,
+      BaseRobeWidget::UID_RESPONSE, uid_data, sizeof(uid_data));
+
+  m_thread->Start();
+  m_thread->WaitUntilRunning();
+  m_ss.Run();
+  OLA_ASSERT_EQ(ROBE, m_received_widget_type);
+  OLA_ASSERT_EQ(string("robe"), m_detector);
 }
 
 
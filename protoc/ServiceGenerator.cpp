@@ -99,6 +99,13 @@ void ServiceGenerator::GenerateInterface(Printer* printer) {
   printer->PrintRaw("\n");
   printer->Indent();
 
+  GenerateMethodIds(printer);
+
+  // Don't indent blank lines
+  printer->Outdent();
+  printer->PrintRaw("\n");
+  printer->Indent();
+
   GenerateMethodSignatures(VIRTUAL, printer);
 
   // Don't indent blank lines
@@ -124,7 +131,9 @@ void ServiceGenerator::GenerateInterface(Printer* printer) {
     "const ::google::protobuf::Message& GetRequestPrototype(\n"
     "  const ::google::protobuf::MethodDescriptor* method) const;\n"
     "const ::google::protobuf::Message& GetResponsePrototype(\n"
-    "  const ::google::protobuf::MethodDescriptor* method) const;\n");
+    "  const ::google::protobuf::MethodDescriptor* method) const;\n"
+    "const ::google::protobuf::MethodDescriptor* FindMethodById(\n"
+    "  unsigned int method_id);\n");
 
   printer->Outdent();
   printer->Print(vars_,
@@ -202,6 +211,29 @@ void ServiceGenerator::GenerateMethodSignatures(
   }
 }
 
+void ServiceGenerator::GenerateMethodIds(Printer* printer) {
+  printer->Print(
+    "// The ids sent on the wire in place of the method names. These are the\n"
+    "// index of the method in the service, so new methods must be added to\n"
+    "// the end.\n"
+    "enum MethodId {\n");
+
+  for (int i = 0; i < descriptor_->method_count(); i++) {
+    map<string, string> sub_vars;
+    sub_vars["name"] = descriptor_->method(i)->name();
+    sub_vars["index"] = SimpleItoa(i);
+
+    printer->Print(sub_vars,
+      "  k$name$MethodId = $index$,\n");
+  }
+
+  map<string, string> sub_vars;
+  sub_vars["count"] = SimpleItoa(descriptor_->method_count());
+  printer->Print(sub_vars,
+    "  kMethodCount = $count$\n"
+    "};\n");
+}
+
 // ===================================================================
 
 void ServiceGenerator::GenerateDescriptorInitializer(
@@ -235,6 +267,7 @@ void ServiceGenerator::GenerateImplementation(Printer* printer) {
   // Generate methods of the interface.
   GenerateNotImplementedMethods(printer);
   GenerateCallMethod(printer);
+  GenerateFindMethodById(printer);
   GenerateGetPrototype(REQUEST, printer);
   GenerateGetPrototype(RESPONSE, printer);
 
@@ -305,7 +338,7 @@ void ServiceGenerator::GenerateCallMethod(Printer* printer) {
     // Note:  down_cast does not work here because it only works on pointers,
     //   not references.
     printer->Print(sub_vars,
-      "    case $index$:\n"
+      "    case k$name$MethodId:\n"
       "      $name$(\n"
       "          controller,\n"
       "          ::google::protobuf::down_cast<\n"
@@ -326,6 +359,19 @@ void ServiceGenerator::GenerateCallMethod(Printer* printer) {
     "\n");
 }
 
+void ServiceGenerator::GenerateFindMethodById(Printer* printer) {
+  printer->Print(vars_,
+    "const ::google::protobuf::MethodDescriptor* $classname$::FindMethodById(\n"
+    "    unsigned int method_id) {\n"
+    "  if (method_id >= kMethodCount) {\n"
+    "    return NULL;\n"
+    "  }\n"
+    "  protobuf_AssignDescriptorsOnce();\n"
+    "  return $classname$_descriptor_->method(method_id);\n"
+    "}\n"
+    "\n");
+}
+
 void ServiceGenerator::GenerateGetPrototype(RequestOrResponse which,
                                             Printer* printer) {
   if (which == REQUEST) {
@@ -382,7 +428,7 @@ void ServiceGenerator::GenerateStubMethods(Printer* printer) {
       "    const $input_type$* request,\n"
       "    $output_type$* response,\n"
       "    ola::rpc::RpcService::CompletionCallback* done) {\n"
-      "  channel_->CallMethod(descriptor()->method($index$),\n"
+      "  channel_->CallMethod(descriptor()->method(k$name$MethodId),\n"
       "                       controller, request, response, done);\n"
       "}\n");
   }
@@ -96,6 +96,9 @@ class ServiceGenerator {
   void GenerateMethodSignatures(VirtualOrNon virtual_or_non,
                                 Printer* printer);
 
+  // Generate the enum of method ids.
+  void GenerateMethodIds(Printer* printer);
+
   // Source file stuff.
 
   // Generate the default implementations of the service methods, which
@@ -105,6 +108,9 @@ class ServiceGenerator {
   // Generate the CallMethod() method of the service.
   void GenerateCallMethod(Printer* printer);
 
+  // Generate the FindMethodById() method of the service.
+  void GenerateFindMethodById(Printer* printer);
+
   // Generate the Get{Request,Response}Prototype() methods.
   void GenerateGetPrototype(RequestOrResponse which, Printer* printer);
 
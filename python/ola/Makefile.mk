@@ -33,11 +33,25 @@ pkgpython_PYTHON = \
     python/ola/RDMAPI.py \
     python/ola/RDMConstants.py \
     python/ola/PidStore.py \
+    python/ola/StreamingClient.py \
     python/ola/StringUtils.py \
     python/ola/UID.py \
     python/ola/__init__.py
 endif
 
+# The optional native module used by StreamingClient.py
+if BUILD_PYTHON_NATIVE
+pkgpyexec_LTLIBRARIES = python/ola/_NativeClient.la
+python_ola__NativeClient_la_SOURCES = python/ola/NativeClient.cpp
+python_ola__NativeClient_la_CXXFLAGS = $(COMMON_CXXFLAGS) \
+    $(PYTHON_CPPFLAGS)
+python_ola__NativeClient_la_LDFLAGS = -module -avoid-version -shared \
+    $(PYTHON_LDFLAGS)
+python_ola__NativeClient_la_LIBADD = \
+    common/libolacommon.la \
+    ola/libola.la
+endif
+
 python/ola/ArtNetConfigMessages_pb2.py: $(artnet_proto)
 	$(PROTOC) --python_out $(top_builddir)/python/ola/ -I $(artnet_path) $(artnet_proto)
 
@@ -79,6 +93,11 @@ python/ola/RDMTest.sh: python/ola/Makefile.mk
 	echo "PYTHONPATH=${top_builddir}/python PIDSTOREDIR=$(srcdir)/data/rdm $(PYTHON) ${srcdir}/python/ola/RDMTest.py; exit \$$?" > $(top_builddir)/python/ola/RDMTest.sh
 	chmod +x $(top_builddir)/python/ola/RDMTest.sh
 
+python/ola/StreamingClientTest.sh: python/ola/Makefile.mk
+	mkdir -p $(top_builddir)/python/ola
+	echo "PYTHONPATH=${top_builddir}/python $(PYTHON) ${srcdir}/python/ola/StreamingClientTest.py; exit \$$?" > $(top_builddir)/python/ola/StreamingClientTest.sh
+	chmod +x $(top_builddir)/python/ola/StreamingClientTest.sh
+
 dist_check_SCRIPTS += \
     python/ola/DUBDecoderTest.py \
     python/ola/ClientWrapperTest.py \
@@ -86,6 +105,7 @@ dist_check_SCRIPTS += \
     python/ola/OlaClientTest.py \
     python/ola/PidStoreTest.py \
     python/ola/RDMTest.py \
+    python/ola/StreamingClientTest.py \
     python/ola/StringUtilsTest.py \
     python/ola/TestUtils.py \
     python/ola/UIDTest.py
@@ -98,6 +118,7 @@ test_scripts += \
     python/ola/OlaClientTest.sh \
     python/ola/PidStoreTest.sh \
     python/ola/RDMTest.sh \
+    python/ola/StreamingClientTest.sh \
     python/ola/StringUtilsTest.py \
     python/ola/UIDTest.py
 endif
@@ -108,4 +129,5 @@ CLEANFILES += \
     python/ola/OlaClientTest.sh \
     python/ola/PidStoreTest.sh \
     python/ola/RDMTest.sh \
+    python/ola/StreamingClientTest.sh \
     python/ola/__pycache__/*
@@ -0,0 +1,668 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * NativeClient.cpp
+ * The ola._NativeClient Python module, which sends & receives DMX data with
+ * the C++ client. Use it through ola.StreamingClient, which falls back to the
+ * Python client if this module isn't available.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+// Python.h must come first.
+#include <Python.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/client/ClientWrapper.h"
+#include "ola/client/StreamingClient.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/io/SelectServer.h"
+#include "ola/thread/Mutex.h"
+
+namespace {
+
+using ola::DmxBuffer;
+using ola::client::DMXFrameView;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::client::StreamingClient;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using std::auto_ptr;
+using std::vector;
+
+/*
+ * Holds a buffer exported by a Python object, e.g. bytes, bytearray,
+ * memoryview, array.array or a numpy array. The object can't be resized
+ * while the buffer is held, so the data can be read with the GIL released.
+ */
+class BufferView {
+ public:
+  BufferView() : m_held(false) {}
+  ~BufferView() { Release(); }
+
+  bool Get(PyObject *object, bool writable) {
+    Release();
+    int flags = PyBUF_C_CONTIGUOUS;
+    if (writable) {
+      flags |= PyBUF_WRITABLE;
+    }
+    if (PyObject_GetBuffer(object, &m_buffer, flags) < 0) {
+      return false;
+    }
+    m_held = true;
+    return true;
+  }
+
+  void Release() {
+    if (m_held) {
+      PyBuffer_Release(&m_buffer);
+      m_held = false;
+    }
+  }
+
+  uint8_t *Data() { return reinterpret_cast<uint8_t*>(m_buffer.buf); }
+  Py_ssize_t Size() const { return m_buffer.len; }
+
+ private:
+  Py_buffer m_buffer;
+  bool m_held;
+};
+
+
+bool CheckFrameSize(const BufferView &view) {
+  if (view.Size() > ola::DMX_UNIVERSE_SIZE) {
+    PyErr_Format(PyExc_ValueError, "DMX data is %zd bytes, the limit is %u",
+                 view.Size(), ola::DMX_UNIVERSE_SIZE);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * The methods take the object type & keyword arguments, cast them to the
+ * type the method table expects.
+ */
+template <typename Function>
+PyCFunction AsMethod(Function function) {
+  return reinterpret_cast<PyCFunction>(
+      reinterpret_cast<void (*)(void)>(function));
+}
+
+bool CheckPriority(unsigned int priority) {
+  if (priority > ola::dmx::SOURCE_PRIORITY_MAX) {
+    PyErr_Format(PyExc_ValueError, "Priority %u is out of range", priority);
+    return false;
+  }
+  return true;
+}
+
+
+/*
+ * StreamingClient
+ * ---------------
+ * The Python object owns a C++ StreamingClient. The GIL is released while
+ * the data is sent, so other Python threads keep running. The lock stops two
+ * Python threads using the client at once.
+ */
+typedef struct {
+  PyObject_HEAD
+  StreamingClient *client;
+  Mutex *lock;
+} StreamingClientObject;
+
+int StreamingClient_init(StreamingClientObject *self, PyObject *args,
+                         PyObject *kwargs) {
+  static const char *keywords[] = {
+    "auto_start", "server_port", "use_shared_memory", "use_udp",
+    "delta_encoding", "threaded", NULL
+  };
+  StreamingClient::Options options;
+  int auto_start = options.auto_start;
+  unsigned int server_port = options.server_port;
+  int use_shared_memory = options.use_shared_memory;
+  int use_udp = options.use_udp;
+  int delta_encoding = options.delta_encoding;
+  int threaded = options.threaded;
+
+  if (!PyArg_ParseTupleAndKeywords(
+          args, kwargs, "|iIiiii", const_cast<char**>(keywords), &auto_start,
+          &server_port, &use_shared_memory, &use_udp, &delta_encoding,
+          &threaded)) {
+    return -1;
+  }
+  if (server_port > 0xffff) {
+    PyErr_Format(PyExc_ValueError, "Invalid port %u", server_port);
+    return -1;
+  }
+
+  options.auto_start = auto_start;
+  options.server_port = server_port;
+  options.use_shared_memory = use_shared_memory;
+  options.use_udp = use_udp;
+  options.delta_encoding = delta_encoding;
+  options.threaded = threaded;
+
+  delete self->client;
+  self->client = new StreamingClient(options);
+  if (!self->lock) {
+    self->lock = new Mutex();
+  }
+  return 0;
+}
+
+void StreamingClient_dealloc(StreamingClientObject *self) {
+  if (self->client) {
+    Py_BEGIN_ALLOW_THREADS
+    self->client->Stop();
+    Py_END_ALLOW_THREADS
+  }
+  delete self->client;
+  delete self->lock;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+bool CheckClient(StreamingClientObject *self) {
+  if (!self->client) {
+    PyErr_SetString(PyExc_RuntimeError, "StreamingClient isn't initialized");
+    return false;
+  }
+  return true;
+}
+
+PyObject *StreamingClient_Setup(StreamingClientObject *self, PyObject*) {
+  if (!CheckClient(self)) {
+    return NULL;
+  }
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  ok = self->client->Setup();
+  Py_END_ALLOW_THREADS
+  return PyBool_FromLong(ok);
+}
+
+PyObject *StreamingClient_Stop(StreamingClientObject *self, PyObject*) {
+  if (!CheckClient(self)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  self->client->Stop();
+  Py_END_ALLOW_THREADS
+  Py_RETURN_NONE;
+}
+
+PyObject *StreamingClient_SendDmx(StreamingClientObject *self, PyObject *args,
+                                  PyObject *kwargs) {
+  static const char *keywords[] = {"universe", "data", "priority", NULL};
+  unsigned int universe;
+  PyObject *data;
+  unsigned int priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (!CheckClient(self) ||
+      !PyArg_ParseTupleAndKeywords(args, kwargs, "IO|I",
+                                   const_cast<char**>(keywords), &universe,
+                                   &data, &priority) ||
+      !CheckPriority(priority)) {
+    return NULL;
+  }
+
+  BufferView view;
+  if (!view.Get(data, false) || !CheckFrameSize(view)) {
+    return NULL;
+  }
+
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  DmxBuffer buffer(view.Data(), view.Size());
+  StreamingClient::SendArgs send_args;
+  send_args.priority = priority;
+  ok = self->client->SendDMX(universe, buffer, send_args);
+  Py_END_ALLOW_THREADS
+  return PyBool_FromLong(ok);
+}
+
+/*
+ * Frames is a sequence of (universe, data) or (universe, data, priority)
+ * tuples. They're sent to olad in a single message.
+ */
+PyObject *StreamingClient_SendDmxBatch(StreamingClientObject *self,
+                                       PyObject *args) {
+  PyObject *frames;
+  if (!CheckClient(self) || !PyArg_ParseTuple(args, "O", &frames)) {
+    return NULL;
+  }
+
+  PyObject *sequence = PySequence_Fast(frames,
+                                       "frames must be a sequence of tuples");
+  if (!sequence) {
+    return NULL;
+  }
+
+  const Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+  vector<StreamingClient::UniverseData> batch;
+  batch.reserve(count);
+  BufferView view;
+  for (Py_ssize_t i = 0; i < count; i++) {
+    PyObject *frame = PySequence_Fast_GET_ITEM(sequence, i);
+    unsigned int universe;
+    PyObject *data;
+    unsigned int priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+    if (!PyArg_ParseTuple(frame, "IO|I", &universe, &data, &priority) ||
+        !CheckPriority(priority) || !view.Get(data, false) ||
+        !CheckFrameSize(view)) {
+      Py_DECREF(sequence);
+      return NULL;
+    }
+    batch.push_back(StreamingClient::UniverseData(
+        universe, DmxBuffer(view.Data(), view.Size()), priority));
+  }
+  view.Release();
+  Py_DECREF(sequence);
+
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  ok = self->client->SendDmxBatch(batch);
+  Py_END_ALLOW_THREADS
+  return PyBool_FromLong(ok);
+}
+
+PyMethodDef StreamingClient_methods[] = {
+  {"Setup", AsMethod(StreamingClient_Setup),
+   METH_NOARGS, "Connect to olad. Returns True if the connection succeeded."},
+  {"Stop", AsMethod(StreamingClient_Stop),
+   METH_NOARGS, "Close the connection to olad."},
+  {"SendDmx", AsMethod(StreamingClient_SendDmx),
+   METH_VARARGS | METH_KEYWORDS,
+   "SendDmx(universe, data, priority=100)\n\n"
+   "Send DMX data to a universe. data is any object supporting the buffer "
+   "protocol, e.g. bytes, bytearray, array.array('B') or a uint8 numpy "
+   "array."},
+  {"SendDmxBatch", AsMethod(StreamingClient_SendDmxBatch),
+   METH_VARARGS,
+   "SendDmxBatch(frames)\n\n"
+   "Send the data for several universes in a single message. frames is a "
+   "sequence of (universe, data) or (universe, data, priority) tuples."},
+  {NULL, NULL, 0, NULL}
+};
+
+PyTypeObject StreamingClientType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "ola._NativeClient.StreamingClient",
+  sizeof(StreamingClientObject),
+};
+
+
+/*
+ * DmxReceiver
+ * -----------
+ * Receives DMX data for the registered universes with an OlaClientWrapper.
+ * Receive() runs the wrapper's SelectServer, with the GIL released, until a
+ * frame arrives. The frame is copied straight from the RPC message into the
+ * caller's buffer. If more than one frame arrives at once, the others are
+ * queued for the next calls.
+ */
+struct QueuedFrame {
+  unsigned int universe;
+  uint8_t priority;
+  unsigned int length;
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+};
+
+class Receiver {
+ public:
+  Receiver()
+      : m_target(NULL),
+        m_target_size(0),
+        m_received(false),
+        m_register_pending(false),
+        m_register_ok(false),
+        m_waiting(false) {
+  }
+
+  bool Setup() {
+    if (!m_wrapper.Setup()) {
+      return false;
+    }
+    m_wrapper.GetClient()->SetDMXViewCallback(
+        ola::NewCallback(this, &Receiver::NewFrame));
+    return true;
+  }
+
+  /*
+   * Register for a universe and wait for olad to reply.
+   */
+  bool RegisterUniverse(unsigned int universe,
+                        ola::client::RegisterAction action) {
+    if (!m_wrapper.GetClient()) {
+      return false;
+    }
+    m_register_pending = true;
+    m_register_ok = false;
+    m_wrapper.GetClient()->RegisterUniverse(
+        universe, action,
+        ola::NewSingleCallback(this, &Receiver::RegisterComplete));
+    RunUntil(&m_register_pending, REGISTER_TIMEOUT_MS);
+    if (m_register_pending) {
+      OLA_WARN << "Timed out registering for universe " << universe;
+      m_register_pending = false;
+      return false;
+    }
+    return m_register_ok;
+  }
+
+  /*
+   * Wait for a frame, and copy it to data.
+   * @returns false if no frame arrived within the timeout.
+   */
+  bool Receive(uint8_t *data, unsigned int size, unsigned int timeout_ms,
+               QueuedFrame *frame) {
+    if (!m_queue.empty()) {
+      *frame = m_queue.front();
+      m_queue.pop_front();
+      frame->length = std::min(frame->length, size);
+      memcpy(data, frame->data, frame->length);
+      return true;
+    }
+    if (!m_wrapper.GetClient()) {
+      return false;
+    }
+
+    m_target = data;
+    m_target_size = size;
+    m_target_frame = frame;
+    m_received = false;
+    m_waiting = true;
+    RunUntil(&m_waiting, timeout_ms);
+    m_target = NULL;
+    m_waiting = false;
+    return m_received;
+  }
+
+ private:
+  OlaClientWrapper m_wrapper;
+  uint8_t *m_target;
+  unsigned int m_target_size;
+  QueuedFrame *m_target_frame;
+  bool m_received;
+  bool m_register_pending;
+  bool m_register_ok;
+  bool m_waiting;
+  std::deque<QueuedFrame> m_queue;
+
+  /*
+   * Run the SelectServer until *pending is false, or the timeout expires.
+   */
+  void RunUntil(const bool *pending, unsigned int timeout_ms) {
+    ola::Clock clock;
+    ola::TimeStamp now;
+    clock.CurrentMonotonicTime(&now);
+    const ola::TimeStamp deadline = now + ola::TimeInterval(
+        static_cast<int64_t>(timeout_ms) * 1000);
+    ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+    while (*pending && now < deadline) {
+      ss->RunOnce(deadline - now);
+      clock.CurrentMonotonicTime(&now);
+    }
+  }
+
+  void NewFrame(const DMXFrameView &view) {
+    const unsigned int length = std::min(
+        view.length, static_cast<unsigned int>(ola::DMX_UNIVERSE_SIZE));
+    if (m_target && !m_received) {
+      m_target_frame->universe = view.universe;
+      m_target_frame->priority = view.priority;
+      m_target_frame->length = std::min(length, m_target_size);
+      memcpy(m_target, view.data, m_target_frame->length);
+      m_received = true;
+      m_waiting = false;
+      return;
+    }
+    QueuedFrame frame;
+    frame.universe = view.universe;
+    frame.priority = view.priority;
+    frame.length = length;
+    memcpy(frame.data, view.data, length);
+    m_queue.push_back(frame);
+  }
+
+  void RegisterComplete(const Result &result) {
+    if (!result.Success()) {
+      OLA_WARN << "Failed to register: " << result.Error();
+    }
+    m_register_ok = result.Success();
+    m_register_pending = false;
+  }
+
+  static const unsigned int REGISTER_TIMEOUT_MS = 5000;
+};
+
+typedef struct {
+  PyObject_HEAD
+  Receiver *receiver;
+  Mutex *lock;
+} DmxReceiverObject;
+
+int DmxReceiver_init(DmxReceiverObject *self, PyObject *args,
+                     PyObject *kwargs) {
+  static const char *keywords[] = {NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "",
+                                   const_cast<char**>(keywords))) {
+    return -1;
+  }
+  delete self->receiver;
+  self->receiver = new Receiver();
+  if (!self->lock) {
+    self->lock = new Mutex();
+  }
+  return 0;
+}
+
+void DmxReceiver_dealloc(DmxReceiverObject *self) {
+  delete self->receiver;
+  delete self->lock;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+bool CheckReceiver(DmxReceiverObject *self) {
+  if (!self->receiver) {
+    PyErr_SetString(PyExc_RuntimeError, "DmxReceiver isn't initialized");
+    return false;
+  }
+  return true;
+}
+
+PyObject *DmxReceiver_Setup(DmxReceiverObject *self, PyObject*) {
+  if (!CheckReceiver(self)) {
+    return NULL;
+  }
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  ok = self->receiver->Setup();
+  Py_END_ALLOW_THREADS
+  return PyBool_FromLong(ok);
+}
+
+PyObject *Register(DmxReceiverObject *self, PyObject *args,
+                   ola::client::RegisterAction action) {
+  unsigned int universe;
+  if (!CheckReceiver(self) || !PyArg_ParseTuple(args, "I", &universe)) {
+    return NULL;
+  }
+  bool ok;
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  ok = self->receiver->RegisterUniverse(universe, action);
+  Py_END_ALLOW_THREADS
+  return PyBool_FromLong(ok);
+}
+
+PyObject *DmxReceiver_RegisterUniverse(DmxReceiverObject *self,
+                                       PyObject *args) {
+  return Register(self, args, ola::client::REGISTER);
+}
+
+PyObject *DmxReceiver_UnregisterUniverse(DmxReceiverObject *self,
+                                         PyObject *args) {
+  return Register(self, args, ola::client::UNREGISTER);
+}
+
+PyObject *DmxReceiver_Receive(DmxReceiverObject *self, PyObject *args,
+                              PyObject *kwargs) {
+  static const char *keywords[] = {"buffer", "timeout_ms", NULL};
+  PyObject *data;
+  unsigned int timeout_ms = 1000;
+  if (!CheckReceiver(self) ||
+      !PyArg_ParseTupleAndKeywords(args, kwargs, "O|I",
+                                   const_cast<char**>(keywords), &data,
+                                   &timeout_ms)) {
+    return NULL;
+  }
+
+  BufferView view;
+  if (!view.Get(data, true)) {
+    return NULL;
+  }
+
+  QueuedFrame frame;
+  bool received;
+  Py_BEGIN_ALLOW_THREADS
+  MutexLocker locker(self->lock);
+  received = self->receiver->Receive(
+      view.Data(),
+      std::min(view.Size(), static_cast<Py_ssize_t>(ola::DMX_UNIVERSE_SIZE)),
+      timeout_ms, &frame);
+  Py_END_ALLOW_THREADS
+
+  if (!received) {
+    Py_RETURN_NONE;
+  }
+  return Py_BuildValue("(IIk)", frame.universe,
+                       static_cast<unsigned int>(frame.priority),
+                       static_cast<unsigned long>(frame.length));  // NOLINT
+}
+
+PyMethodDef DmxReceiver_methods[] = {
+  {"Setup", AsMethod(DmxReceiver_Setup),
+   METH_NOARGS, "Connect to olad. Returns True if the connection succeeded."},
+  {"RegisterUniverse",
+   AsMethod(DmxReceiver_RegisterUniverse),
+   METH_VARARGS,
+   "RegisterUniverse(universe)\n\n"
+   "Receive the data for a universe. Returns True once olad has confirmed."},
+  {"UnregisterUniverse",
+   AsMethod(DmxReceiver_UnregisterUniverse),
+   METH_VARARGS,
+   "UnregisterUniverse(universe)\n\n"
+   "Stop receiving the data for a universe."},
+  {"Receive", AsMethod(DmxReceiver_Receive),
+   METH_VARARGS | METH_KEYWORDS,
+   "Receive(buffer, timeout_ms=1000)\n\n"
+   "Wait for the next frame from a registered universe, and copy it into "
+   "buffer, which must be writable, e.g. a bytearray or numpy array. "
+   "Returns a (universe, priority, length) tuple, or None if no frame "
+   "arrived within the timeout."},
+  {NULL, NULL, 0, NULL}
+};
+
+PyTypeObject DmxReceiverType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "ola._NativeClient.DmxReceiver",
+  sizeof(DmxReceiverObject),
+};
+
+
+const char MODULE_DOC[] =
+    "Sends & receives DMX data using the C++ client. Use ola.StreamingClient "
+    "rather than this module directly.";
+
+bool InitTypes() {
+  StreamingClientType.tp_flags = Py_TPFLAGS_DEFAULT;
+  StreamingClientType.tp_doc = "Sends DMX data to olad.";
+  StreamingClientType.tp_methods = StreamingClient_methods;
+  StreamingClientType.tp_init = reinterpret_cast<initproc>(
+      StreamingClient_init);
+  StreamingClientType.tp_dealloc = reinterpret_cast<destructor>(
+      StreamingClient_dealloc);
+  StreamingClientType.tp_new = PyType_GenericNew;
+
+  DmxReceiverType.tp_flags = Py_TPFLAGS_DEFAULT;
+  DmxReceiverType.tp_doc = "Receives DMX data from olad.";
+  DmxReceiverType.tp_methods = DmxReceiver_methods;
+  DmxReceiverType.tp_init = reinterpret_cast<initproc>(DmxReceiver_init);
+  DmxReceiverType.tp_dealloc = reinterpret_cast<destructor>(
+      DmxReceiver_dealloc);
+  DmxReceiverType.tp_new = PyType_GenericNew;
+
+  return PyType_Ready(&StreamingClientType) == 0 &&
+         PyType_Ready(&DmxReceiverType) == 0;
+}
+
+void AddTypes(PyObject *module) {
+  Py_INCREF(&StreamingClientType);
+  PyModule_AddObject(module, "StreamingClient",
+                     reinterpret_cast<PyObject*>(&StreamingClientType));
+  Py_INCREF(&DmxReceiverType);
+  PyModule_AddObject(module, "DmxReceiver",
+                     reinterpret_cast<PyObject*>(&DmxReceiverType));
+}
+}  // namespace
+
+
+#if PY_MAJOR_VERSION >= 3
+static PyModuleDef native_module = {
+  PyModuleDef_HEAD_INIT,
+  "_NativeClient",
+  MODULE_DOC,
+  -1,
+  NULL,
+};
+
+PyMODINIT_FUNC PyInit__NativeClient(void) {
+  if (!InitTypes()) {
+    return NULL;
+  }
+  PyObject *module = PyModule_Create(&native_module);
+  if (!module) {
+    return NULL;
+  }
+  AddTypes(module);
+  return module;
+}
+#else
+PyMODINIT_FUNC init_NativeClient(void) {
+  if (!InitTypes()) {
+    return;
+  }
+  PyObject *module = Py_InitModule3("_NativeClient", NULL, MODULE_DOC);
+  if (module) {
+    AddTypes(module);
+  }
+}
+#endif  // PY_MAJOR_VERSION
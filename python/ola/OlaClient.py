@@ -936,7 +936,7 @@ class OlaClient(Ola_pb2.OlaClientService):
       raise OLADNotRunningException()
     return True
 
-  def SendDmx(self, universe, data, callback=None):
+  def SendDmx(self, universe, data, callback=None, priority=None):
     """Send DMX data to the server
 
     Args:
@@ -944,6 +944,8 @@ class OlaClient(Ola_pb2.OlaClientService):
       data: An array object with the DMX data
       callback: The function to call once complete, takes one argument, a
         RequestStatus object.
+      priority: The priority of the data, 1 - 200. If None, olad's default
+        priority is used.
 
     Returns:
       True if the request was sent, False otherwise.
@@ -958,6 +960,8 @@ class OlaClient(Ola_pb2.OlaClientService):
       request.data = data.tobytes()
     else:
       request.data = data.tostring()
+    if priority is not None:
+      request.priority = priority
     try:
       self._stub.UpdateDmxData(
           controller, request,
@@ -1275,6 +1279,45 @@ class OlaClient(Ola_pb2.OlaClientService):
     return self._RDMMessage(universe, uid, sub_device, param_id, callback,
                             data, include_frames, set=True)
 
+  def RDMBatch(self, requests, callback, include_frames=False):
+    """Send a batch of RDM get & set commands.
+
+    The commands are sent to olad in a single message, commands for different
+    universes run concurrently.
+
+    Args:
+      requests: A list of (universe, uid, sub_device, param_id, data, is_set)
+        tuples.
+      callback: The function to call once all the commands are complete, takes
+        a list of RDMResponse objects, in the same order as the requests.
+      include_frames: True if the responses should include the raw frame data.
+
+    Returns:
+      True if the request was sent, False otherwise.
+    """
+    if self._socket is None:
+      return False
+
+    controller = SimpleRpcController()
+    request = Ola_pb2.RDMBatchRequest()
+    for universe, uid, sub_device, param_id, data, is_set in requests:
+      rdm_request = request.request.add()
+      rdm_request.universe = universe
+      rdm_request.uid.esta_id = uid.manufacturer_id
+      rdm_request.uid.device_id = uid.device_id
+      rdm_request.sub_device = sub_device
+      rdm_request.param_id = param_id
+      rdm_request.data = data
+      rdm_request.is_set = is_set
+      rdm_request.include_raw_response = include_frames
+    try:
+      self._stub.RDMCommandBatch(
+          controller, request,
+          lambda x, y: self._RDMBatchComplete(callback, len(requests), x, y))
+    except socket.error:
+      raise OLADNotRunningException()
+    return True
+
   def SendRawRDMDiscovery(self,
                           universe,
                           uid,
@@ -1549,6 +1592,22 @@ class OlaClient(Ola_pb2.OlaClientService):
       return
     callback(RDMResponse(controller, response))
 
+  def _RDMBatchComplete(self, callback, count, controller, response):
+    """Called when a batch of RDM requests completes.
+
+    Args:
+      callback: the callback to run
+      count: the number of requests in the batch
+      controller: an RpcController
+      response: an RDMBatchResponse message.
+    """
+    if not callback:
+      return
+    if controller.Failed():
+      callback([RDMResponse(controller, None) for i in range(count)])
+    else:
+      callback([RDMResponse(controller, r) for r in response.response])
+
 
 # Populate the patch & register actions
 for value in Ola_pb2._PATCHACTION.values:
@@ -0,0 +1,266 @@
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+#
+# StreamingClient.py
+# Copyright (C) 2026 Open Lighting Project
+
+"""Send & receive DMX data with as little overhead as possible.
+
+If OLA was configured with --enable-python-native, StreamingClient and
+DmxReceiver are provided by the ola._NativeClient module, which wraps the C++
+client. The frames are passed using the buffer protocol, so bytes, bytearray,
+array.array('B') and uint8 numpy arrays are used without being copied, and the
+GIL is released while the data is sent & received.
+
+Otherwise the pure Python implementations below, which use OlaClient, are
+used. They have the same interface, so code doesn't need to check which is in
+use, although NATIVE is True if the module was loaded.
+"""
+
+import array
+import select
+import socket
+import time
+
+from ola.OlaClient import OlaClient, OLA_PORT
+
+from ola import Ola_pb2
+
+
+"""The priority used if SendDmx isn't passed one."""
+DEFAULT_PRIORITY = 100
+
+"""The number of slots in a universe."""
+DMX_UNIVERSE_SIZE = 512
+
+
+def _ToArray(data):
+  """Convert any object supporting the buffer protocol to an array('B')."""
+  if isinstance(data, array.array) and data.typecode == 'B':
+    frame = data
+  else:
+    frame = array.array('B', bytearray(memoryview(data)))
+  if len(frame) > DMX_UNIVERSE_SIZE:
+    raise ValueError('DMX data is %d bytes, the limit is %d' %
+                     (len(frame), DMX_UNIVERSE_SIZE))
+  return frame
+
+
+class _RunUntil(object):
+  """Process the messages from olad until a condition is met or a timeout."""
+
+  def __init__(self, our_socket, client):
+    self._socket = our_socket
+    self._client = client
+
+  def Run(self, done, timeout_ms):
+    deadline = time.time() + timeout_ms / 1000.0
+    while not done():
+      remaining = deadline - time.time()
+      if remaining <= 0:
+        return False
+      readable, _, _ = select.select([self._socket], [], [], remaining)
+      if readable:
+        self._client.SocketReady()
+    return True
+
+  def Drain(self):
+    """Process any messages which have already arrived."""
+    while select.select([self._socket], [], [], 0)[0]:
+      self._client.SocketReady()
+
+
+class PyStreamingClient(object):
+  """Sends DMX data to olad using OlaClient.
+
+  The transport options are accepted for compatibility with the native
+  client, and ignored. The data is always sent over the RPC connection.
+  """
+
+  def __init__(self, auto_start=True, server_port=OLA_PORT,
+               use_shared_memory=False, use_udp=False, delta_encoding=False,
+               threaded=False, our_socket=None):
+    self._server_port = server_port
+    self._socket = our_socket
+    self._client = None
+    self._runner = None
+
+  def Setup(self):
+    """Connect to olad. Returns True if the connection succeeded."""
+    if self._client:
+      return True
+    try:
+      if self._socket is None:
+        self._socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._socket.connect(('localhost', self._server_port))
+    except socket.error:
+      self._socket = None
+      return False
+    self._client = OlaClient(self._socket)
+    self._runner = _RunUntil(self._socket, self._client)
+    return True
+
+  def Stop(self):
+    """Close the connection to olad."""
+    if self._socket is not None:
+      self._socket.close()
+    self._socket = None
+    self._client = None
+    self._runner = None
+
+  def SendDmx(self, universe, data, priority=DEFAULT_PRIORITY):
+    """Send DMX data to a universe.
+
+    Args:
+      universe: the universe to send the data for
+      data: an object supporting the buffer protocol, e.g. bytes, bytearray
+        or array.array('B').
+      priority: the priority of the data.
+
+    Returns:
+      True if the data was sent, False otherwise.
+    """
+    if not self._client:
+      return False
+    ok = self._client.SendDmx(universe, _ToArray(data), priority=priority)
+    # Process the acks, so they don't back up on the socket.
+    self._runner.Drain()
+    return ok
+
+  def SendDmxBatch(self, frames):
+    """Send the data for several universes.
+
+    Args:
+      frames: a sequence of (universe, data) or (universe, data, priority)
+        tuples.
+
+    Returns:
+      True if all the data was sent, False otherwise.
+    """
+    ok = True
+    for frame in frames:
+      ok = self.SendDmx(*frame) and ok
+    return ok
+
+
+class _ReceiverClient(OlaClient):
+  """An OlaClient which passes the priority of the data to the callback."""
+
+  def __init__(self, our_socket, frame_callback):
+    super(_ReceiverClient, self).__init__(our_socket)
+    self._frame_callback = frame_callback
+
+  def UpdateDmxData(self, controller, request, callback):
+    priority = DEFAULT_PRIORITY
+    if request.HasField('priority'):
+      priority = request.priority
+    self._frame_callback(request.universe, priority, request.data)
+    callback(Ola_pb2.Ack())
+    return True
+
+
+class PyDmxReceiver(object):
+  """Receives DMX data from olad using OlaClient."""
+
+  """How long to wait for olad to confirm a registration."""
+  REGISTER_TIMEOUT_MS = 5000
+
+  def __init__(self, server_port=OLA_PORT, our_socket=None):
+    self._server_port = server_port
+    self._socket = our_socket
+    self._client = None
+    self._runner = None
+    self._frames = []
+
+  def Setup(self):
+    """Connect to olad. Returns True if the connection succeeded."""
+    if self._client:
+      return True
+    try:
+      if self._socket is None:
+        self._socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._socket.connect(('localhost', self._server_port))
+    except socket.error:
+      self._socket = None
+      return False
+    self._client = _ReceiverClient(self._socket, self._NewFrame)
+    self._runner = _RunUntil(self._socket, self._client)
+    return True
+
+  def RegisterUniverse(self, universe):
+    """Receive the data for a universe. Returns True once olad has confirmed.
+    """
+    return self._Register(universe, OlaClient.REGISTER)
+
+  def UnregisterUniverse(self, universe):
+    """Stop receiving the data for a universe."""
+    return self._Register(universe, OlaClient.UNREGISTER)
+
+  def Receive(self, buffer, timeout_ms=1000):
+    """Wait for the next frame from a registered universe.
+
+    Args:
+      buffer: a writable object supporting the buffer protocol, e.g. a
+        bytearray. The frame is truncated if the buffer is too small.
+      timeout_ms: how long to wait for a frame.
+
+    Returns:
+      A (universe, priority, length) tuple, or None if no frame arrived within
+      the timeout.
+    """
+    if not self._client:
+      return None
+    if not self._frames:
+      self._runner.Run(lambda: self._frames, timeout_ms)
+    if not self._frames:
+      return None
+
+    universe, priority, data = self._frames.pop(0)
+    view = memoryview(buffer)
+    length = min(len(data), len(view))
+    view[0:length] = data[0:length]
+    return (universe, priority, length)
+
+  def _Register(self, universe, action):
+    if not self._client:
+      return False
+
+    class Result(object):
+      done = False
+      ok = False
+
+    def Complete(status):
+      Result.done = True
+      Result.ok = status.Succeeded()
+
+    self._client.RegisterUniverse(universe, action, self._IgnoreData,
+                                  Complete)
+    self._runner.Run(lambda: Result.done, self.REGISTER_TIMEOUT_MS)
+    return Result.ok
+
+  def _IgnoreData(self, data):
+    # The frames are passed to _NewFrame by _ReceiverClient.
+    pass
+
+  def _NewFrame(self, universe, priority, data):
+    self._frames.append((universe, priority, data))
+
+
+try:
+  from ola._NativeClient import StreamingClient, DmxReceiver
+  NATIVE = True
+except ImportError:
+  StreamingClient = PyStreamingClient
+  DmxReceiver = PyDmxReceiver
+  NATIVE = False
@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+#
+# StreamingClientTest.py
+# Copyright (C) 2026 Open Lighting Project
+
+import array
+import socket
+import unittest
+
+from ola.StreamingClient import PyDmxReceiver, PyStreamingClient
+
+"""Test cases for the pure Python StreamingClient & DmxReceiver."""
+
+
+class StreamingClientTest(unittest.TestCase):
+  def setUp(self):
+    # The receiver handles the UpdateDmxData requests the sender makes, so the
+    # two can be connected to each other.
+    self.sockets = socket.socketpair()
+    self.sender = PyStreamingClient(our_socket=self.sockets[0])
+    self.receiver = PyDmxReceiver(our_socket=self.sockets[1])
+    self.assertTrue(self.sender.Setup())
+    self.assertTrue(self.receiver.Setup())
+
+  def tearDown(self):
+    self.sender.Stop()
+    self.sockets[1].close()
+
+  def testSendAndReceive(self):
+    buf = bytearray(512)
+    self.assertTrue(self.sender.SendDmx(1, bytearray([1, 2, 3])))
+    self.assertEqual((1, 100, 3), self.receiver.Receive(buf))
+    self.assertEqual(bytearray([1, 2, 3]), buf[0:3])
+
+    self.assertTrue(self.sender.SendDmx(2, b'\x0a\x0b', priority=150))
+    self.assertEqual((2, 150, 2), self.receiver.Receive(buf))
+    self.assertEqual(bytearray([10, 11, 3]), buf[0:3])
+
+    # Frames are truncated to the size of the buffer.
+    small = bytearray(2)
+    self.assertTrue(self.sender.SendDmx(3, array.array('B', [4, 5, 6])))
+    self.assertEqual((3, 100, 2), self.receiver.Receive(small))
+    self.assertEqual(bytearray([4, 5]), small)
+
+    self.assertEqual(None, self.receiver.Receive(buf, timeout_ms=10))
+
+    self.assertRaises(ValueError, self.sender.SendDmx, 1, bytearray(513))
+
+  def testSendBatch(self):
+    frames = [
+        (1, bytearray([1])),
+        (2, bytes(bytearray([2, 2])), 50),
+        (3, array.array('B', [3, 3, 3])),
+    ]
+    self.assertTrue(self.sender.SendDmxBatch(frames))
+
+    buf = bytearray(512)
+    self.assertEqual((1, 100, 1), self.receiver.Receive(buf))
+    self.assertEqual((2, 50, 2), self.receiver.Receive(buf))
+    self.assertEqual((3, 100, 3), self.receiver.Receive(buf))
+    self.assertEqual(bytearray([3, 3, 3]), buf[0:3])
+
+  def testNotConnected(self):
+    client = PyStreamingClient()
+    self.assertFalse(client.SendDmx(1, bytearray(1)))
+    receiver = PyDmxReceiver()
+    self.assertFalse(receiver.RegisterUniverse(1))
+    self.assertEqual(None, receiver.Receive(bytearray(1)))
+
+
+if __name__ == '__main__':
+  unittest.main()
@@ -285,7 +285,7 @@ class StreamRpcChannel(service.RpcChannel):
     if message.type in self.MESSAGE_HANDLERS:
       self.MESSAGE_HANDLERS[message.type](self, message)
     else:
-      ola_logger.warning('Not sure of message type %d', message.type())
+      ola_logger.warning('Not sure of message type %d', message.type)
 
   def _HandleRequest(self, message):
     """Handle a Request message.
@@ -364,6 +364,17 @@ class StreamRpcChannel(service.RpcChannel):
       response.controller.SetFailed('Not Implemented')
       self._InvokeCallback(response)
 
+  def _HandleStreamCredit(self, message):
+    """Handle a Stream Credit message.
+
+    We don't send stream requests fast enough to need flow control, so this is
+    ignored.
+
+    Args:
+      message: The RpcMessage object.
+    """
+    pass
+
   def _InvokeCallback(self, response):
     """Run the callback and delete the outstanding response.
 
@@ -379,4 +390,5 @@ class StreamRpcChannel(service.RpcChannel):
       Rpc_pb2.RESPONSE_CANCEL: _HandleCanceledResponse,
       Rpc_pb2.RESPONSE_FAILED: _HandleFailedReponse,
       Rpc_pb2.RESPONSE_NOT_IMPLEMENTED: _HandleNotImplemented,
+      Rpc_pb2.STREAM_CREDIT: _HandleStreamCredit,
   }
@@ -32,6 +32,7 @@
 #include <ola/network/TCPSocketFactory.h>
 #include <ola/stl/STLUtils.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,7 +43,6 @@
 
 #include "tools/e133/DeviceManagerImpl.h"
 #include "tools/e133/E133Endpoint.h"
-#include "tools/e133/E133HealthCheckedConnection.h"
 
 namespace ola {
 namespace e133 {
@@ -52,8 +52,10 @@ using ola::NewSingleCallback;
 using ola::STLContains;
 using ola::STLFindOrNull;
 using ola::TimeInterval;
+using ola::TimeStamp;
 using ola::acn::CID;
 using ola::io::NonBlockingSender;
+using ola::network::AdvancedTCPConnector;
 using ola::network::GenericSocketAddress;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
@@ -69,25 +71,31 @@ using std::string;
  */
 class DeviceState {
  public:
-    DeviceState()
-      : socket(NULL),
+    explicit DeviceState(const IPV4Address &ip_address)
+      : ip_address(ip_address),
+        socket(NULL),
         message_queue(NULL),
-        health_checked_connection(NULL),
         in_transport(NULL),
-        am_designated_controller(false) {
+        am_designated_controller(false),
+        wheel_slot(0) {
     }
 
+    const IPV4Address ip_address;
+
     // The following may be NULL.
     // The socket connected to the E1.33 device
     auto_ptr<TCPSocket> socket;
     auto_ptr<NonBlockingSender> message_queue;
-    // The Health Checked connection
-    auto_ptr<E133HealthCheckedConnection> health_checked_connection;
     auto_ptr<IncomingTCPTransport> in_transport;
 
     // True if we're the designated controller.
     bool am_designated_controller;
 
+    // The following are only valid if we're the designated controller.
+    unsigned int wheel_slot;
+    TimeStamp last_heartbeat_sent;
+    TimeStamp last_data_received;
+
  private:
     DISALLOW_COPY_AND_ASSIGN(DeviceState);
 };
@@ -99,6 +107,26 @@ const TimeInterval DeviceManagerImpl::TCP_CONNECT_TIMEOUT(5, 0);
 const TimeInterval DeviceManagerImpl::INITIAL_TCP_RETRY_DELAY(5, 0);
 // we grow the retry interval to a max of 30 seconds
 const TimeInterval DeviceManagerImpl::MAX_TCP_RETRY_DELAY(30, 0);
+// This matches E133HealthCheckedConnection, which the devices use.
+const TimeInterval DeviceManagerImpl::TCP_HEARTBEAT_INTERVAL(5, 0);
+// A connection is unhealthy if nothing arrives for 2.5 heartbeat intervals.
+const TimeInterval DeviceManagerImpl::TCP_RX_TIMEOUT(12, 500000);
+const unsigned int DeviceManagerImpl::TICK_INTERVAL_MS;
+const unsigned int DeviceManagerImpl::MAX_CONNECTS_PER_TICK;
+const unsigned int DeviceManagerImpl::MAX_PENDING_CONNECTS;
+const unsigned int DeviceManagerImpl::TCP_RETRY_JITTER_PERCENT;
+
+
+/*
+ * Spread the retries out, so that devices which drop off together (e.g. when
+ * a switch restarts) don't all reconnect at the same time.
+ */
+AdvancedTCPConnector::Options DeviceManagerImpl::ConnectorOptions() {
+  AdvancedTCPConnector::Options options;
+  options.max_pending_connects = MAX_PENDING_CONNECTS;
+  options.jitter_percent = TCP_RETRY_JITTER_PERCENT;
+  return options;
+}
 
 
 /**
@@ -109,15 +137,23 @@ const TimeInterval DeviceManagerImpl::MAX_TCP_RETRY_DELAY(30, 0);
 DeviceManagerImpl::DeviceManagerImpl(ola::io::SelectServerInterface *ss,
                              ola::e133::MessageBuilder *message_builder)
     : m_ss(ss),
+      m_tick_timeout(ola::thread::INVALID_TIMEOUT),
       m_tcp_socket_factory(NewCallback(this, &DeviceManagerImpl::OnTCPConnect)),
-      m_connector(m_ss, &m_tcp_socket_factory, TCP_CONNECT_TIMEOUT),
+      m_connector(m_ss, &m_tcp_socket_factory, TCP_CONNECT_TIMEOUT,
+                  ConnectorOptions()),
       m_backoff_policy(INITIAL_TCP_RETRY_DELAY, MAX_TCP_RETRY_DELAY),
       m_message_builder(message_builder),
+      m_heartbeat_wheel(TCP_HEARTBEAT_INTERVAL.InMilliSeconds() /
+                        TICK_INTERVAL_MS),
+      m_wheel_position(0),
+      m_next_wheel_slot(0),
       m_root_inflator(NewCallback(this, &DeviceManagerImpl::RLPDataReceived)) {
   m_root_inflator.AddInflator(&m_e133_inflator);
   m_e133_inflator.AddInflator(&m_rdm_inflator);
   m_rdm_inflator.SetRDMHandler(
       NewCallback(this, &DeviceManagerImpl::EndpointRequest));
+  m_tick_timeout = m_ss->RegisterRepeatingTimeout(
+      TICK_INTERVAL_MS, NewCallback(this, &DeviceManagerImpl::Tick));
 }
 
 
@@ -125,6 +161,9 @@ DeviceManagerImpl::DeviceManagerImpl(ola::io::SelectServerInterface *ss,
  * Clean up
  */
 DeviceManagerImpl::~DeviceManagerImpl() {
+  if (m_tick_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_tick_timeout);
+  }
   // close out all tcp sockets and free state
   ola::STLDeleteValues(&m_device_map);
 }
@@ -167,14 +206,12 @@ void DeviceManagerImpl::AddDevice(const IPV4Address &ip_address) {
     return;
   }
 
-  DeviceState *device_state = new DeviceState();
+  DeviceState *device_state = new DeviceState(ip_address);
   m_device_map[ip_address.AsInt()] = device_state;
 
   OLA_INFO << "Adding " << ip_address << ":" << ola::acn::E133_PORT;
-  // start the non-blocking connect
-  m_connector.AddEndpoint(
-      IPV4SocketAddress(ip_address, ola::acn::E133_PORT),
-      &m_backoff_policy);
+  // The connect is started from Tick()
+  m_pending_connects.push_back(ip_address);
 }
 
 
@@ -218,6 +255,100 @@ void DeviceManagerImpl::ListManagedDevices(vector<IPV4Address> *devices) const {
 }
 
 
+/**
+ * Called every TICK_INTERVAL_MS.
+ */
+bool DeviceManagerImpl::Tick() {
+  StartPendingConnects();
+  CheckHeartbeats(*m_ss->WakeUpTime());
+  return true;
+}
+
+
+/**
+ * Start the non-blocking connects for the next batch of devices.
+ */
+void DeviceManagerImpl::StartPendingConnects() {
+  for (unsigned int i = 0;
+       i < MAX_CONNECTS_PER_TICK && !m_pending_connects.empty(); i++) {
+    m_connector.AddEndpoint(
+        IPV4SocketAddress(m_pending_connects.front(), ola::acn::E133_PORT),
+        &m_backoff_policy);
+    m_pending_connects.pop_front();
+  }
+}
+
+
+/**
+ * Service the connections in the current slot of the wheel. Each connection
+ * is visited once per heartbeat interval.
+ */
+void DeviceManagerImpl::CheckHeartbeats(const TimeStamp &now) {
+  const vector<DeviceState*> &slot = m_heartbeat_wheel[m_wheel_position];
+  m_wheel_position = (m_wheel_position + 1) % m_heartbeat_wheel.size();
+
+  vector<IPV4Address> unhealthy_devices;
+  vector<DeviceState*>::const_iterator iter = slot.begin();
+  for (; iter != slot.end(); ++iter) {
+    DeviceState *device_state = *iter;
+    if (now - device_state->last_data_received > TCP_RX_TIMEOUT) {
+      unhealthy_devices.push_back(device_state->ip_address);
+      continue;
+    }
+    // Anything we've sent in the last interval, like an ack, also counts as a
+    // heartbeat.
+    TimeInterval since_sent = now - device_state->last_heartbeat_sent;
+    if (since_sent.InMilliSeconds() + TICK_INTERVAL_MS >=
+        TCP_HEARTBEAT_INTERVAL.InMilliSeconds()) {
+      SendHeartbeat(device_state, now);
+    }
+  }
+
+  // This modifies the slot, so it's done once we've finished with it.
+  vector<IPV4Address>::const_iterator ip_iter = unhealthy_devices.begin();
+  for (; ip_iter != unhealthy_devices.end(); ++ip_iter) {
+    SocketUnhealthy(*ip_iter);
+  }
+}
+
+
+/**
+ * Send a heartbeat to a device.
+ */
+void DeviceManagerImpl::SendHeartbeat(DeviceState *device_state,
+                                      const TimeStamp &now) {
+  ola::io::IOStack packet(m_message_builder->pool());
+  m_message_builder->BuildNullTCPPacket(&packet);
+  device_state->message_queue->SendMessage(&packet);
+  device_state->last_heartbeat_sent = now;
+}
+
+
+/**
+ * Add a connection to the heartbeat wheel. Connections are assigned to slots
+ * in turn, so the heartbeats are spread evenly over the interval.
+ */
+void DeviceManagerImpl::AddToWheel(DeviceState *device_state) {
+  device_state->wheel_slot = m_next_wheel_slot;
+  m_next_wheel_slot = (m_next_wheel_slot + 1) % m_heartbeat_wheel.size();
+  m_heartbeat_wheel[device_state->wheel_slot].push_back(device_state);
+}
+
+
+/**
+ * Remove a connection from the heartbeat wheel.
+ */
+void DeviceManagerImpl::RemoveFromWheel(DeviceState *device_state) {
+  vector<DeviceState*> *slot = &m_heartbeat_wheel[device_state->wheel_slot];
+  vector<DeviceState*>::iterator iter = std::find(slot->begin(), slot->end(),
+                                                  device_state);
+  if (iter != slot->end()) {
+    *iter = slot->back();
+    slot->pop_back();
+  }
+}
+
+
 /**
  * Called when a TCP socket is connected. Note that we're not the designated
  * controller at this point. That only happens if we receive data on the
@@ -241,8 +372,8 @@ void DeviceManagerImpl::OnTCPConnect(TCPSocket *socket_ptr) {
   // setup the incoming transport, we don't need to setup the outgoing one
   // until we've got confirmation that we're the designated controller.
   device_state->socket.reset(socket.release());
-  device_state->in_transport.reset(new IncomingTCPTransport(&m_root_inflator,
-                                                            socket_ptr));
+  device_state->in_transport.reset(new IncomingTCPTransport(
+      &m_root_inflator, socket_ptr, &m_buffer_pool));
 
   device_state->socket->SetOnData(
       NewCallback(this, &DeviceManagerImpl::ReceiveTCPData, v4_address.Host(),
@@ -296,6 +427,7 @@ void DeviceManagerImpl::SocketClosed(IPV4Address ip_address) {
 
   if (device_state->am_designated_controller) {
     device_state->am_designated_controller = false;
+    RemoveFromWheel(device_state);
     if (m_release_device_cb_.get())
       m_release_device_cb_->Run(ip_address);
 
@@ -307,7 +439,6 @@ void DeviceManagerImpl::SocketClosed(IPV4Address ip_address) {
         IPV4SocketAddress(ip_address, ola::acn::E133_PORT), true);
   }
 
-  device_state->health_checked_connection.reset();
   device_state->message_queue.reset();
   device_state->in_transport.reset();
   m_ss->RemoveReadDescriptor(device_state->socket.get());
@@ -316,8 +447,8 @@ void DeviceManagerImpl::SocketClosed(IPV4Address ip_address) {
 
 
 /**
- * Called when we receive E1.33 data. If this arrived over TCP we notify the
- * health checked connection.
+ * Called when we receive E1.33 data. If this arrived over TCP we note the
+ * time, for the receive timeout.
  */
 void DeviceManagerImpl::RLPDataReceived(
     const ola::acn::TransportHeader &header) {
@@ -332,16 +463,15 @@ void DeviceManagerImpl::RLPDataReceived(
     return;
   }
 
-  // If we're already the designated controller, we just need to notify the
-  // HealthChecker.
+  const TimeStamp &now = *m_ss->WakeUpTime();
+  device_state->last_data_received = now;
   if (device_state->am_designated_controller) {
-    device_state->health_checked_connection->HeartbeatReceived();
     return;
   }
 
   // This is the first packet received on this connection, which is a sign
-  // we're now the designated controller. Setup the HealthChecker & outgoing
-  // transports.
+  // we're now the designated controller. Setup the outgoing transport and
+  // start the heartbeats.
   device_state->am_designated_controller = true;
   OLA_INFO << "Now the designated controller for " << header.Source();
   if (m_acquire_device_cb_.get())
@@ -351,22 +481,8 @@ void DeviceManagerImpl::RLPDataReceived(
       new NonBlockingSender(device_state->socket.get(), m_ss,
                             m_message_builder->pool()));
 
-  E133HealthCheckedConnection *health_checked_connection =
-      new E133HealthCheckedConnection(
-          m_message_builder,
-          device_state->message_queue.get(),
-          NewSingleCallback(this, &DeviceManagerImpl::SocketUnhealthy, src_ip),
-          m_ss);
-
-  if (!health_checked_connection->Setup()) {
-    OLA_WARN << "Failed to setup heartbeat controller for " << src_ip;
-    SocketClosed(src_ip);
-    return;
-  }
-
-  if (device_state->health_checked_connection.get())
-    OLA_WARN << "pre-existing health_checked_connection for " << src_ip;
-  device_state->health_checked_connection.reset(health_checked_connection);
+  SendHeartbeat(device_state, now);
+  AddToWheel(device_state);
 }
 
 
@@ -404,6 +520,7 @@ void DeviceManagerImpl::EndpointRequest(
       &packet, e133_header->Sequence(), e133_header->Endpoint(),
       ola::e133::SC_E133_ACK, "OK");
   device_state->message_queue->SendMessage(&packet);
+  device_state->last_heartbeat_sent = *m_ss->WakeUpTime();
 }
 }  // namespace e133
 }  // namespace ola
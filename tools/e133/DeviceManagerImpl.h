@@ -35,6 +35,7 @@
 #include <ola/network/Socket.h>
 #include <ola/network/TCPSocketFactory.h>
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -60,6 +61,18 @@ using std::vector;
 
 /**
  * This class is responsible for maintaining connections to E1.33 devices.
+ *
+ * It's built to manage thousands of devices from a single SelectServer:
+ *  - The receive buffers are shared between connections, an idle connection
+ *    doesn't hold one.
+ *  - Rather than a pair of timers per connection, the heartbeats are driven
+ *    by a single timer. The devices are spread over the slots of a wheel
+ *    that turns once per heartbeat interval, and on each tick the devices in
+ *    one slot are sent a heartbeat and checked for a receive timeout.
+ *  - New devices are queued and at most MAX_CONNECTS_PER_TICK connections
+ *    are started per tick, so adding a large batch of devices doesn't flood
+ *    the network with SYNs.
+ *
  * TODO(simon): Some of this code can be re-used for the controller side. See
  * if we can factor it out.
  */
@@ -103,12 +116,23 @@ class DeviceManagerImpl {
     auto_ptr<ReleaseDeviceCallback> m_release_device_cb_;
 
     ola::io::SelectServerInterface *m_ss;
+    ola::thread::timeout_id m_tick_timeout;
 
     ola::network::TCPSocketFactory m_tcp_socket_factory;
     ola::network::AdvancedTCPConnector m_connector;
     ola::LinearBackoffPolicy m_backoff_policy;
 
     ola::e133::MessageBuilder *m_message_builder;
+    ola::acn::StreamBufferPool m_buffer_pool;
+
+    // Devices waiting for a connect to be started.
+    std::deque<IPV4Address> m_pending_connects;
+
+    // The heartbeat wheel, each slot holds the designated controller
+    // connections serviced on that tick.
+    vector<vector<class DeviceState*> > m_heartbeat_wheel;
+    unsigned int m_wheel_position;
+    unsigned int m_next_wheel_slot;
 
     // inflators
     ola::acn::RootInflator m_root_inflator;
@@ -121,6 +145,13 @@ class DeviceManagerImpl {
      * Maybe this won't be a problem since we'll never delete the entry for a
      * a device we have a connection to. Think about this.
      */
+    bool Tick();
+    void StartPendingConnects();
+    void CheckHeartbeats(const TimeStamp &now);
+    void SendHeartbeat(class DeviceState *device_state, const TimeStamp &now);
+    void AddToWheel(class DeviceState *device_state);
+    void RemoveFromWheel(class DeviceState *device_state);
+
     void OnTCPConnect(TCPSocket *socket);
     void ReceiveTCPData(IPV4Address ip_address,
                         ola::acn::IncomingTCPTransport *transport);
@@ -128,6 +159,8 @@ class DeviceManagerImpl {
     void SocketClosed(IPV4Address address);
     void RLPDataReceived(const ola::acn::TransportHeader &header);
 
+    static ola::network::AdvancedTCPConnector::Options ConnectorOptions();
+
     void EndpointRequest(
         const ola::acn::TransportHeader *transport_header,
         const ola::acn::E133Header *e133_header,
@@ -136,6 +169,13 @@ class DeviceManagerImpl {
     static const TimeInterval TCP_CONNECT_TIMEOUT;
     static const TimeInterval INITIAL_TCP_RETRY_DELAY;
     static const TimeInterval MAX_TCP_RETRY_DELAY;
+    static const TimeInterval TCP_HEARTBEAT_INTERVAL;
+    static const TimeInterval TCP_RX_TIMEOUT;
+    static const unsigned int TICK_INTERVAL_MS = 100;
+    static const unsigned int MAX_CONNECTS_PER_TICK = 25;
+    // The most TCP connects in progress at once.
+    static const unsigned int MAX_PENDING_CONNECTS = 100;
+    static const unsigned int TCP_RETRY_JITTER_PERCENT = 50;
 };
 }  // namespace e133
 }  // namespace ola
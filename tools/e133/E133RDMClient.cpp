@@ -0,0 +1,325 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E133RDMClient.cpp
+ * Sends RDM requests to E1.33 devices, with many in flight at once.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/Callback.h>
+#include <ola/Logging.h>
+#include <ola/acn/ACNPort.h>
+#include <ola/acn/ACNVectors.h>
+#include <ola/e133/E133Enums.h>
+#include <ola/io/IOStack.h>
+#include <ola/rdm/RDMCommandSerializer.h>
+#include <ola/rdm/RDMReply.h>
+#include <ola/rdm/RDMResponseCodes.h>
+#include <ola/stl/STLUtils.h>
+
+#include "libs/acn/RDMPDU.h"
+#include "tools/e133/E133RDMClient.h"
+
+namespace ola {
+namespace e133 {
+
+using ola::io::IOStack;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMStatusCode;
+
+const unsigned int E133RDMClient::DEFAULT_MAX_IN_FLIGHT;
+const TimeInterval E133RDMClient::DEFAULT_TIMEOUT(2, 0);
+
+namespace {
+/*
+ * Convert an E1.33 status code to the RDM status code we return to the
+ * caller. Returns false if the status doesn't complete the request.
+ */
+bool StatusToRDMStatusCode(uint16_t status_code,
+                           RDMStatusCode *rdm_status_code) {
+  switch (status_code) {
+    case SC_E133_ACK:
+    case SC_E133_ACK_OVERFLOW_IN_PROGRESS:
+      return false;
+    case SC_E133_RDM_TIMEOUT:
+      *rdm_status_code = ola::rdm::RDM_TIMEOUT;
+      return true;
+    case SC_E133_RDM_INVALID_RESPONSE:
+      *rdm_status_code = ola::rdm::RDM_INVALID_RESPONSE;
+      return true;
+    case SC_E133_UNKNOWN_UID:
+      *rdm_status_code = ola::rdm::RDM_UNKNOWN_UID;
+      return true;
+    case SC_E133_BROADCAST_COMPLETE:
+      *rdm_status_code = ola::rdm::RDM_WAS_BROADCAST;
+      return true;
+    default:
+      *rdm_status_code = ola::rdm::RDM_FAILED_TO_SEND;
+      return true;
+  }
+}
+}  // namespace
+
+E133RDMClient::E133RDMClient(ola::io::SelectServerInterface *ss,
+                             ola::network::UDPSocket *socket,
+                             MessageBuilder *message_builder,
+                             unsigned int max_in_flight,
+                             const TimeInterval &timeout)
+    : m_ss(ss),
+      m_socket(socket),
+      m_message_builder(message_builder),
+      m_max_in_flight(max_in_flight ? max_in_flight : 1),
+      m_timeout(timeout),
+      m_next_sequence_number(0),
+      m_queued_requests(0),
+      m_status_callback(
+          NewCallback(this, &E133RDMClient::HandleStatusMessage)),
+      m_rdm_callback(NewCallback(this, &E133RDMClient::HandleRDMMessage)),
+      m_receiver(socket, m_status_callback.get(), m_rdm_callback.get()) {
+}
+
+
+E133RDMClient::~E133RDMClient() {
+  DeviceMap::iterator iter = m_devices.begin();
+  for (; iter != m_devices.end(); ++iter) {
+    std::deque<PendingRequest*>::iterator req_iter =
+        iter->second->queue.begin();
+    for (; req_iter != iter->second->queue.end(); ++req_iter) {
+      ola::rdm::RunRDMCallback((*req_iter)->callback,
+                               ola::rdm::RDM_FAILED_TO_SEND);
+      delete (*req_iter)->request;
+      delete *req_iter;
+    }
+    delete iter->second;
+  }
+
+  InFlightMap::iterator in_flight_iter = m_in_flight.begin();
+  for (; in_flight_iter != m_in_flight.end(); ++in_flight_iter) {
+    PendingRequest *pending = in_flight_iter->second;
+    m_ss->RemoveTimeout(pending->timeout);
+    ola::rdm::RunRDMCallback(pending->callback, ola::rdm::RDM_FAILED_TO_SEND);
+    delete pending->request;
+    delete pending;
+  }
+}
+
+
+void E133RDMClient::SendRDMRequest(const IPV4Address &ip,
+                                   uint16_t endpoint,
+                                   RDMRequest *request,
+                                   RDMCallback *callback) {
+  DeviceState *device = STLFindOrNull(m_devices, ip.AsInt());
+  if (!device) {
+    device = new DeviceState();
+    m_devices[ip.AsInt()] = device;
+  }
+
+  PendingRequest *pending = new PendingRequest();
+  pending->ip = ip;
+  pending->endpoint = endpoint;
+  pending->request = request;
+  pending->callback = callback;
+  pending->sequence_number = 0;
+  pending->timeout = ola::thread::INVALID_TIMEOUT;
+
+  device->stats.requests++;
+  device->stats.queued++;
+  device->queue.push_back(pending);
+  m_queued_requests++;
+  SendQueuedRequests(device);
+}
+
+
+bool E133RDMClient::GetDeviceStats(const IPV4Address &ip,
+                                   DeviceStats *stats) const {
+  const DeviceState *device = STLFindOrNull(m_devices, ip.AsInt());
+  if (!device) {
+    return false;
+  }
+  *stats = device->stats;
+  return true;
+}
+
+
+unsigned int E133RDMClient::OutstandingRequests() const {
+  return m_in_flight.size() + m_queued_requests;
+}
+
+
+/*
+ * Send requests from the device's queue until it has max_in_flight
+ * outstanding.
+ */
+void E133RDMClient::SendQueuedRequests(DeviceState *device) {
+  while (!device->queue.empty() &&
+         device->stats.in_flight < m_max_in_flight) {
+    PendingRequest *pending = device->queue.front();
+    device->queue.pop_front();
+    device->stats.queued--;
+    m_queued_requests--;
+
+    if (!Send(pending)) {
+      ola::rdm::RunRDMCallback(pending->callback, ola::rdm::RDM_FAILED_TO_SEND);
+      delete pending->request;
+      delete pending;
+      continue;
+    }
+    device->stats.in_flight++;
+  }
+}
+
+
+/*
+ * Send a request, and start the timer for it.
+ */
+bool E133RDMClient::Send(PendingRequest *pending) {
+  // Skip any sequence numbers still in use after a wrap.
+  while (STLContains(m_in_flight, m_next_sequence_number)) {
+    m_next_sequence_number++;
+  }
+  pending->sequence_number = m_next_sequence_number++;
+
+  IOStack packet(m_message_builder->pool());
+  ola::rdm::RDMCommandSerializer::Write(*pending->request, &packet);
+  ola::acn::RDMPDU::PrependPDU(&packet);
+  m_message_builder->BuildUDPRootE133(
+      &packet, ola::acn::VECTOR_FRAMING_RDMNET, pending->sequence_number,
+      pending->endpoint);
+
+  IPV4SocketAddress target(pending->ip, ola::acn::E133_PORT);
+  m_socket->SendTo(&packet, target);
+  if (!packet.Empty()) {
+    OLA_WARN << "Failed to send E1.33 request to " << target;
+    return false;
+  }
+
+  m_clock.CurrentMonotonicTime(&pending->sent_time);
+  pending->timeout = m_ss->RegisterSingleTimeout(
+      m_timeout,
+      NewSingleCallback(this, &E133RDMClient::RequestTimeout,
+                        pending->sequence_number));
+  m_in_flight[pending->sequence_number] = pending;
+  return true;
+}
+
+
+void E133RDMClient::RequestTimeout(uint32_t sequence_number) {
+  PendingRequest *pending = STLFindOrNull(m_in_flight, sequence_number);
+  if (!pending) {
+    return;
+  }
+
+  m_in_flight.erase(sequence_number);
+  pending->timeout = ola::thread::INVALID_TIMEOUT;
+  DeviceState *device = m_devices[pending->ip.AsInt()];
+  device->stats.timeouts++;
+
+  RDMReply reply(ola::rdm::RDM_TIMEOUT);
+  Complete(pending, &reply);
+}
+
+
+/*
+ * Find the in flight request a message is for, and record the round trip
+ * time. Returns NULL if there isn't one.
+ */
+E133RDMClient::PendingRequest *E133RDMClient::ClaimRequest(
+    const E133Message &message) {
+  PendingRequest *pending = STLFindOrNull(m_in_flight,
+                                          message.sequence_number);
+  if (!pending || pending->ip != message.ip ||
+      pending->endpoint != message.endpoint) {
+    OLA_INFO << "Unexpected E1.33 message from " << message.ip
+             << ", sequence # " << message.sequence_number;
+    return NULL;
+  }
+
+  m_in_flight.erase(message.sequence_number);
+  m_ss->RemoveTimeout(pending->timeout);
+  pending->timeout = ola::thread::INVALID_TIMEOUT;
+
+  TimeStamp now;
+  m_clock.CurrentMonotonicTime(&now);
+  TimeInterval latency = now - pending->sent_time;
+
+  DeviceStats *stats = &m_devices[pending->ip.AsInt()]->stats;
+  if (stats->responses == 0 || latency < stats->min_latency) {
+    stats->min_latency = latency;
+  }
+  if (latency > stats->max_latency) {
+    stats->max_latency = latency;
+  }
+  stats->last_latency = latency;
+  stats->total_latency += latency;
+  stats->responses++;
+  return pending;
+}
+
+
+/*
+ * Run the callback for a request that has left the in flight map, then send
+ * the next request for the device.
+ */
+void E133RDMClient::Complete(PendingRequest *pending, RDMReply *reply) {
+  DeviceState *device = m_devices[pending->ip.AsInt()];
+  device->stats.in_flight--;
+
+  pending->callback->Run(reply);
+  delete pending->request;
+  delete pending;
+
+  SendQueuedRequests(device);
+}
+
+
+void E133RDMClient::HandleStatusMessage(
+    const E133StatusMessage &status_message) {
+  RDMStatusCode rdm_status_code;
+  if (!StatusToRDMStatusCode(status_message.status_code, &rdm_status_code)) {
+    return;
+  }
+
+  PendingRequest *pending = ClaimRequest(status_message);
+  if (!pending) {
+    return;
+  }
+
+  OLA_INFO << "Request " << status_message.sequence_number << " to "
+           << status_message.ip << " failed: "
+           << status_message.status_message;
+  RDMReply reply(rdm_status_code);
+  Complete(pending, &reply);
+}
+
+
+void E133RDMClient::HandleRDMMessage(const E133RDMMessage &rdm_message) {
+  // The E133Receiver passes ownership of the response to us.
+  RDMResponse *response = const_cast<RDMResponse*>(rdm_message.response);
+  PendingRequest *pending = ClaimRequest(rdm_message);
+  if (!pending) {
+    delete response;
+    return;
+  }
+
+  RDMReply reply(rdm_message.status_code, response);
+  Complete(pending, &reply);
+}
+}  // namespace e133
+}  // namespace ola
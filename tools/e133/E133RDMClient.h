@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E133RDMClient.h
+ * Sends RDM requests to E1.33 devices, with many in flight at once.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef TOOLS_E133_E133RDMCLIENT_H_
+#define TOOLS_E133_E133RDMCLIENT_H_
+
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <ola/e133/E133Receiver.h>
+#include <ola/e133/MessageBuilder.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/Socket.h>
+#include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMControllerInterface.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+
+namespace ola {
+namespace e133 {
+
+/**
+ * Sends RDM requests to E1.33 devices over UDP.
+ *
+ * Each request is given its own E1.33 sequence number, which the device
+ * echoes in the response, so many requests can be outstanding at once. Up to
+ * max_in_flight requests are sent to each device, the rest are queued until a
+ * response or timeout frees a slot. The packets are built straight into
+ * blocks from the MessageBuilder's pool.
+ *
+ * The round trip time of each request is recorded per device.
+ */
+class E133RDMClient {
+ public:
+    struct DeviceStats {
+      DeviceStats()
+          : requests(0),
+            responses(0),
+            timeouts(0),
+            in_flight(0),
+            queued(0) {
+      }
+
+      unsigned int requests;
+      unsigned int responses;
+      unsigned int timeouts;
+      unsigned int in_flight;
+      unsigned int queued;
+      // The round trip times of the responses.
+      TimeInterval last_latency;
+      TimeInterval min_latency;
+      TimeInterval max_latency;
+      TimeInterval total_latency;
+    };
+
+    /**
+     * @param ss the SelectServer to use for the timeouts.
+     * @param socket the UDP socket to send and receive on. It should already
+     *   be bound and added to the SelectServer.
+     * @param message_builder the MessageBuilder to use.
+     * @param max_in_flight the maximum outstanding requests per device.
+     * @param timeout how long to wait for a response.
+     */
+    E133RDMClient(ola::io::SelectServerInterface *ss,
+                  ola::network::UDPSocket *socket,
+                  MessageBuilder *message_builder,
+                  unsigned int max_in_flight = DEFAULT_MAX_IN_FLIGHT,
+                  const TimeInterval &timeout = DEFAULT_TIMEOUT);
+
+    /**
+     * @brief Destructor.
+     *
+     * Any outstanding requests are completed with RDM_FAILED_TO_SEND.
+     */
+    ~E133RDMClient();
+
+    /**
+     * @brief Send a RDM request to an endpoint on a device.
+     * @param ip the IP address of the device.
+     * @param endpoint the endpoint to send to.
+     * @param request the request, ownership is transferred.
+     * @param callback the callback to run when the request completes.
+     */
+    void SendRDMRequest(const ola::network::IPV4Address &ip,
+                        uint16_t endpoint,
+                        ola::rdm::RDMRequest *request,
+                        ola::rdm::RDMCallback *callback);
+
+    /**
+     * @brief Get the stats for a device.
+     * @returns false if no requests have been sent to the device.
+     */
+    bool GetDeviceStats(const ola::network::IPV4Address &ip,
+                        DeviceStats *stats) const;
+
+    /**
+     * @brief The number of requests that haven't completed.
+     */
+    unsigned int OutstandingRequests() const;
+
+    static const unsigned int DEFAULT_MAX_IN_FLIGHT = 8;
+    static const TimeInterval DEFAULT_TIMEOUT;
+
+ private:
+    struct PendingRequest {
+      ola::network::IPV4Address ip;
+      uint16_t endpoint;
+      ola::rdm::RDMRequest *request;
+      ola::rdm::RDMCallback *callback;
+      uint32_t sequence_number;
+      TimeStamp sent_time;
+      ola::thread::timeout_id timeout;
+    };
+
+    struct DeviceState {
+      DeviceStats stats;
+      std::deque<PendingRequest*> queue;
+    };
+
+    typedef std::map<uint32_t, PendingRequest*> InFlightMap;
+    typedef std::map<uint32_t, DeviceState*> DeviceMap;
+
+    ola::io::SelectServerInterface *m_ss;
+    ola::network::UDPSocket *m_socket;
+    MessageBuilder *m_message_builder;
+    const unsigned int m_max_in_flight;
+    const TimeInterval m_timeout;
+    ola::Clock m_clock;
+    uint32_t m_next_sequence_number;
+    InFlightMap m_in_flight;
+    DeviceMap m_devices;
+    unsigned int m_queued_requests;
+
+    std::auto_ptr<E133Receiver::StatusCallback> m_status_callback;
+    std::auto_ptr<E133Receiver::RDMCallback> m_rdm_callback;
+    E133Receiver m_receiver;
+
+    void SendQueuedRequests(DeviceState *device);
+    bool Send(PendingRequest *pending);
+    void RequestTimeout(uint32_t sequence_number);
+    PendingRequest *ClaimRequest(const E133Message &message);
+    void Complete(PendingRequest *pending, ola::rdm::RDMReply *reply);
+    void HandleStatusMessage(const E133StatusMessage &status_message);
+    void HandleRDMMessage(const E133RDMMessage &rdm_message);
+
+    DISALLOW_COPY_AND_ASSIGN(E133RDMClient);
+};
+}  // namespace e133
+}  // namespace ola
+#endif  // TOOLS_E133_E133RDMCLIENT_H_
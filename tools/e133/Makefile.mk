@@ -34,7 +34,9 @@ tools_e133_libolae133common_la_LIBADD = libs/acn/libolae131core.la
 tools_e133_libolae133controller_la_SOURCES = \
     tools/e133/DeviceManager.cpp \
     tools/e133/DeviceManagerImpl.cpp \
-    tools/e133/DeviceManagerImpl.h
+    tools/e133/DeviceManagerImpl.h \
+    tools/e133/E133RDMClient.cpp \
+    tools/e133/E133RDMClient.h
 tools_e133_libolae133controller_la_LIBADD = \
     common/libolacommon.la \
     libs/acn/libolae131core.la \
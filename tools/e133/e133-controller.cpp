@@ -16,34 +16,31 @@
  * e133-controller.cpp
  * Copyright (C) 2011 Simon Newton
  *
- * This connects to the device specified in \--target.
- *
- * It then sends some RDM commands to the E1.33 node and waits for the
- * response.
+ * This sends a RDM command to each of the devices specified in \--target and
+ * waits for the responses. Many requests can be outstanding at once, so this
+ * can be used to sweep a large number of devices.
  */
 
 #include <ola/Callback.h>
 #include <ola/Constants.h>
 #include <ola/Logging.h>
+#include <ola/StringUtils.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
 #include <ola/acn/ACNPort.h>
 #include <ola/acn/ACNVectors.h>
 #include <ola/acn/CID.h>
-#include <ola/e133/E133StatusHelper.h>
-#include <ola/e133/E133Receiver.h>
 #include <ola/e133/MessageBuilder.h>
 #include <ola/io/SelectServer.h>
-#include <ola/io/IOStack.h>
 #include <ola/network/IPV4Address.h>
 #include <ola/network/NetworkUtils.h>
 #include <ola/network/Socket.h>
 #include <ola/rdm/CommandPrinter.h>
 #include <ola/rdm/PidStoreHelper.h>
 #include <ola/rdm/RDMCommand.h>
-#include <ola/rdm/RDMCommandSerializer.h>
 #include <ola/rdm/RDMEnums.h>
+#include <ola/rdm/RDMReply.h>
 #include <ola/rdm/UID.h>
 #include <ola/stl/STLUtils.h>
 
@@ -54,26 +51,29 @@
 #include <string>
 #include <vector>
 
-#include "libs/acn/RDMPDU.h"
+#include "tools/e133/E133RDMClient.h"
 
 DEFINE_s_uint16(endpoint, e, 0, "The endpoint to use");
 DEFINE_s_string(target, t, "", "List of IPs to connect to");
+DEFINE_uint32(count, 1, "The number of times to send the request to each "
+              "device");
+DEFINE_uint16(max_in_flight, ola::e133::E133RDMClient::DEFAULT_MAX_IN_FLIGHT,
+              "The maximum number of outstanding requests per device");
 DEFINE_string(listen_ip, "", "The IP address to listen on");
 DEFINE_s_string(pid_location, p, "",
                 "The directory to read PID definitions from");
 DEFINE_s_default_bool(set, s, false, "Perform a SET (default is GET)");
 DEFINE_default_bool(list_pids, false, "Display a list of pids");
-DEFINE_s_string(uid, u, "", "The UID of the device to control.");
+DEFINE_s_string(uid, u, "", "The UIDs of the devices to control, one for "
+                "each target.");
 
-using ola::NewCallback;
-using ola::io::IOStack;
+using ola::NewSingleCallback;
+using ola::e133::E133RDMClient;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::UDPSocket;
-using ola::acn::E133_PORT;
-using ola::acn::RDMPDU;
 using ola::rdm::PidStoreHelper;
-using ola::rdm::RDMCommandSerializer;
+using ola::rdm::RDMReply;
 using ola::rdm::RDMRequest;
 using ola::rdm::RDMResponse;
 using ola::rdm::UID;
@@ -106,9 +106,11 @@ class SimpleE133Controller {
  public:
     struct Options {
       IPV4Address controller_ip;
+      unsigned int max_in_flight;
 
       explicit Options(const IPV4Address &ip)
-          : controller_ip(ip) {
+          : controller_ip(ip),
+            max_in_flight(E133RDMClient::DEFAULT_MAX_IN_FLIGHT) {
       }
     };
 
@@ -120,6 +122,7 @@ class SimpleE133Controller {
     void AddUID(const UID &uid, const IPV4Address &ip);
     void Run();
     void Stop() { m_ss.Terminate(); }
+    void PrintStats();
 
     // very basic methods for sending RDM requests
     void SendGetRequest(const UID &dst_uid,
@@ -141,22 +144,21 @@ class SimpleE133Controller {
 
     // sockets & transports
     UDPSocket m_udp_socket;
-    ola::e133::E133Receiver m_e133_receiver;
+    E133RDMClient m_rdm_client;
 
     // hash_map of UIDs to IPs
     typedef std::map<UID, IPV4Address> uid_to_ip_map;
     uid_to_ip_map m_uid_to_ip;
 
     UID m_src_uid;
+    uint8_t m_transaction_number;
     PidStoreHelper *m_pid_helper;
     ola::rdm::CommandPrinter m_command_printer;
 
     bool SendRequest(const UID &uid, uint16_t endpoint, RDMRequest *request);
-    void HandlePacket(const ola::e133::E133RDMMessage &rdm_message);
+    void HandleReply(IPV4Address ip, RDMReply *reply);
+    void HandleResponse(const RDMResponse *response);
     void HandleNack(const RDMResponse *response);
-
-    void HandleStatusMessage(
-        const ola::e133::E133StatusMessage &status_message);
 };
 
 
@@ -168,11 +170,10 @@ SimpleE133Controller::SimpleE133Controller(
     PidStoreHelper *pid_helper)
     : m_controller_ip(options.controller_ip),
       m_message_builder(ola::acn::CID::Generate(), "E1.33 Controller"),
-      m_e133_receiver(
-          &m_udp_socket,
-          NewCallback(this, &SimpleE133Controller::HandleStatusMessage),
-          NewCallback(this, &SimpleE133Controller::HandlePacket)),
+      m_rdm_client(&m_ss, &m_udp_socket, &m_message_builder,
+                   options.max_in_flight),
       m_src_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0xabcdabcd),
+      m_transaction_number(0),
       m_pid_helper(pid_helper),
       m_command_printer(&cout, m_pid_helper) {
 }
@@ -214,7 +215,31 @@ void SimpleE133Controller::AddUID(const UID &uid, const IPV4Address &ip) {
  * Run the controller and wait for the responses (or timeouts)
  */
 void SimpleE133Controller::Run() {
-  m_ss.Run();
+  if (m_rdm_client.OutstandingRequests())
+    m_ss.Run();
+}
+
+
+/**
+ * Print the round trip times for each device.
+ */
+void SimpleE133Controller::PrintStats() {
+  uid_to_ip_map::const_iterator iter = m_uid_to_ip.begin();
+  for (; iter != m_uid_to_ip.end(); ++iter) {
+    E133RDMClient::DeviceStats stats;
+    if (!m_rdm_client.GetDeviceStats(iter->second, &stats))
+      continue;
+
+    cout << iter->second << ": " << stats.responses << "/" << stats.requests
+         << " replies, " << stats.timeouts << " timeouts";
+    if (stats.responses) {
+      cout << ", rtt min/avg/max " << stats.min_latency.InMilliSeconds()
+           << "/"
+           << stats.total_latency.InMilliSeconds() / stats.responses
+           << "/" << stats.max_latency.InMilliSeconds() << " ms";
+    }
+    cout << endl;
+  }
 }
 
 
@@ -226,11 +251,10 @@ void SimpleE133Controller::SendGetRequest(const UID &dst_uid,
                                           uint16_t pid,
                                           const uint8_t *data,
                                           unsigned int length) {
-  // send a second one
   ola::rdm::RDMGetRequest *command = new ola::rdm::RDMGetRequest(
       m_src_uid,
       dst_uid,
-      0,  // transaction #
+      m_transaction_number++,  // transaction #
       1,  // port id
       ola::rdm::ROOT_RDM_DEVICE,  // sub device
       pid,  // param id
@@ -239,12 +263,6 @@ void SimpleE133Controller::SendGetRequest(const UID &dst_uid,
 
   if (!SendRequest(dst_uid, endpoint, command)) {
     OLA_FATAL << "Failed to send request";
-    m_ss.Terminate();
-  } else if (dst_uid.IsBroadcast()) {
-    OLA_INFO << "Request broadcast";
-    m_ss.Terminate();
-  } else {
-    OLA_INFO << "Request sent, waiting for response";
   }
 }
 
@@ -260,7 +278,7 @@ void SimpleE133Controller::SendSetRequest(const UID &dst_uid,
   ola::rdm::RDMSetRequest *command = new ola::rdm::RDMSetRequest(
       m_src_uid,
       dst_uid,
-      0,  // transaction #
+      m_transaction_number++,  // transaction #
       1,  // port id
       ola::rdm::ROOT_RDM_DEVICE,  // sub device
       pid,  // param id
@@ -269,16 +287,13 @@ void SimpleE133Controller::SendSetRequest(const UID &dst_uid,
 
   if (!SendRequest(dst_uid, endpoint, command)) {
     OLA_FATAL << "Failed to send request";
-    m_ss.Terminate();
-  } else {
-    OLA_INFO << "Request sent";
   }
 }
 
 
 /**
  * Send an RDM Request.
- * This packs the data into a ACN structure and sends it.
+ * The client packs the data into a ACN structure and sends it.
  */
 bool SimpleE133Controller::SendRequest(const UID &uid,
                                        uint16_t endpoint,
@@ -291,50 +306,48 @@ bool SimpleE133Controller::SendRequest(const UID &uid,
     return false;
   }
 
-  IPV4SocketAddress target(*target_address, E133_PORT);
-  OLA_INFO << "Sending to " << target << "/" << uid << "/" << endpoint;
-
-  // Build the E1.33 packet.
-  IOStack packet(m_message_builder.pool());
-  RDMCommandSerializer::Write(*request, &packet);
-  RDMPDU::PrependPDU(&packet);
-  m_message_builder.BuildUDPRootE133(
-      &packet, ola::acn::VECTOR_FRAMING_RDMNET, 0, endpoint);
-
-  // Send the packet
-  m_udp_socket.SendTo(&packet, target);
-  if (!packet.Empty()) {
-    return false;
-  }
-
+  OLA_INFO << "Sending to " << *target_address << "/" << uid << "/"
+           << endpoint;
+  m_rdm_client.SendRDMRequest(
+      *target_address, endpoint, request.release(),
+      NewSingleCallback(this, &SimpleE133Controller::HandleReply,
+                        *target_address));
   return true;
 }
 
 
-
 /**
- * Handle a RDM message.
+ * Handle the reply to a request.
  */
-void SimpleE133Controller::HandlePacket(
-    const ola::e133::E133RDMMessage &rdm_message) {
-  OLA_INFO << "RDM callback executed with code: " <<
-    ola::rdm::StatusCodeToString(rdm_message.status_code);
+void SimpleE133Controller::HandleReply(IPV4Address ip, RDMReply *reply) {
+  OLA_INFO << "RDM callback for " << ip << " executed with code: " <<
+    ola::rdm::StatusCodeToString(reply->StatusCode());
+
+  if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK &&
+      reply->Response()) {
+    HandleResponse(reply->Response());
+  } else {
+    cout << ip << ": "
+         << ola::rdm::StatusCodeToString(reply->StatusCode()) << endl;
+  }
 
-  m_ss.Terminate();
+  if (!m_rdm_client.OutstandingRequests())
+    m_ss.Terminate();
+}
 
-  if (rdm_message.status_code != ola::rdm::RDM_COMPLETED_OK)
-    return;
 
-  switch (rdm_message.response->ResponseType()) {
+/**
+ * Handle a RDM response.
+ */
+void SimpleE133Controller::HandleResponse(const RDMResponse *response) {
+  switch (response->ResponseType()) {
     case ola::rdm::RDM_NACK_REASON:
-      HandleNack(rdm_message.response);
+      HandleNack(response);
       return;
     default:
       break;
   }
 
-  const RDMResponse *response = rdm_message.response;
-
   const ola::rdm::PidDescriptor *pid_descriptor = m_pid_helper->GetDescriptor(
       response->ParamId(),
       response->SourceUID().ManufacturerId());
@@ -387,25 +400,6 @@ void SimpleE133Controller::HandleNack(const RDMResponse *response) {
 }
 
 
-void SimpleE133Controller::HandleStatusMessage(
-    const ola::e133::E133StatusMessage &status_message) {
-  // TODO(simon): match src IP, sequence # etc. here.
-  OLA_INFO << "Got status code from " << status_message.ip;
-
-  ola::e133::E133StatusCode e133_status_code;
-  if (!ola::e133::IntToStatusCode(status_message.status_code,
-                                  &e133_status_code)) {
-    OLA_INFO << "Unknown E1.33 Status code " << status_message.status_code
-             << " : " << status_message.status_message;
-  } else {
-    OLA_INFO << "Device returned code " << status_message.status_code << " : "
-             << ola::e133::StatusCodeToString(e133_status_code)
-             << " : " << status_message.status_message;
-  }
-  Stop();
-}
-
-
 /*
  * Startup a node
  */
@@ -422,29 +416,56 @@ int main(int argc, char *argv[]) {
     exit(ola::EXIT_USAGE);
   }
 
-  // convert the node's IP address if specified
-  IPV4Address target_ip;
-  if (!IPV4Address::FromString(FLAGS_target, &target_ip)) {
-    ola::DisplayUsage();
-    exit(ola::EXIT_USAGE);
+  // convert the nodes' IP addresses
+  vector<string> targets;
+  ola::StringSplit(FLAGS_target.str(), &targets, ",");
+  vector<IPV4Address> target_ips;
+  for (vector<string>::const_iterator iter = targets.begin();
+       iter != targets.end(); ++iter) {
+    IPV4Address target_ip;
+    if (!IPV4Address::FromString(*iter, &target_ip)) {
+      ola::DisplayUsage();
+      exit(ola::EXIT_USAGE);
+    }
+    target_ips.push_back(target_ip);
   }
 
-  auto_ptr<UID> uid(UID::FromString(FLAGS_uid));
+  // and the UIDs, there must be one per target
+  vector<string> uid_strings;
+  ola::StringSplit(FLAGS_uid.str(), &uid_strings, ",");
+  vector<UID> uids;
+  for (vector<string>::const_iterator iter = uid_strings.begin();
+       iter != uid_strings.end(); ++iter) {
+    auto_ptr<UID> uid(UID::FromString(*iter));
+    if (!uid.get()) {
+      OLA_FATAL << "Invalid UID " << *iter << ", try xxxx:yyyyyyyy";
+      ola::DisplayUsage();
+      exit(ola::EXIT_USAGE);
+    }
+    uids.push_back(*uid);
+  }
 
   // Make sure we can load our PIDs
   if (!pid_helper.Init())
     exit(ola::EXIT_OSFILE);
 
   if (FLAGS_list_pids)
-    DisplayPIDsAndExit(uid.get() ? uid->ManufacturerId() : 0, pid_helper);
+    DisplayPIDsAndExit(uids.empty() ? 0 : uids[0].ManufacturerId(),
+                       pid_helper);
 
-  // check the UID
-  if (!uid.get()) {
+  // check the UIDs
+  if (uids.empty()) {
     OLA_FATAL << "Invalid or missing UID, try xxxx:yyyyyyyy";
     ola::DisplayUsage();
     exit(ola::EXIT_USAGE);
   }
 
+  if (uids.size() != target_ips.size()) {
+    OLA_FATAL << "Specify one UID for each target";
+    ola::DisplayUsage();
+    exit(ola::EXIT_USAGE);
+  }
+
   if (argc < 2) {
     ola::DisplayUsage();
     exit(ola::EXIT_USAGE);
@@ -452,7 +473,7 @@ int main(int argc, char *argv[]) {
 
   // get the pid descriptor
   const ola::rdm::PidDescriptor *pid_descriptor = pid_helper.GetDescriptor(
-      argv[1], uid->ManufacturerId());
+      argv[1], uids[0].ManufacturerId());
 
   if (!pid_descriptor) {
     OLA_WARN << "Unknown PID: " << argv[1] << ".";
@@ -484,36 +505,46 @@ int main(int argc, char *argv[]) {
     exit(ola::EXIT_USAGE);
   }
 
-  SimpleE133Controller controller(
-      SimpleE133Controller::Options(controller_ip),
-      &pid_helper);
+  SimpleE133Controller::Options options(controller_ip);
+  options.max_in_flight = FLAGS_max_in_flight;
+  SimpleE133Controller controller(options, &pid_helper);
 
   if (!controller.Init()) {
     OLA_FATAL << "Failed to init controller";
     exit(ola::EXIT_UNAVAILABLE);
   }
 
-  // manually add the responder address
-  controller.AddUID(*uid, target_ip);
+  // manually add the responder addresses
+  for (unsigned int i = 0; i < target_ips.size(); i++) {
+    controller.AddUID(uids[i], target_ips[i]);
+  }
 
   // convert the message to binary form
   unsigned int param_data_length;
   const uint8_t *param_data = pid_helper.SerializeMessage(
       message.get(), &param_data_length);
 
-  // send the message
-  if (FLAGS_set) {
-    controller.SendSetRequest(*uid,
-                              FLAGS_endpoint,
-                              pid_descriptor->Value(),
-                              param_data,
-                              param_data_length);
-  } else {
-    controller.SendGetRequest(*uid,
-                              FLAGS_endpoint,
-                              pid_descriptor->Value(),
-                              param_data,
-                              param_data_length);
+  // send the messages, the client queues them until there's room in flight
+  for (unsigned int count = 0; count < FLAGS_count; count++) {
+    for (unsigned int i = 0; i < target_ips.size(); i++) {
+      const UID &uid = uids[i];
+      if (FLAGS_set) {
+        controller.SendSetRequest(uid,
+                                  FLAGS_endpoint,
+                                  pid_descriptor->Value(),
+                                  param_data,
+                                  param_data_length);
+      } else {
+        controller.SendGetRequest(uid,
+                                  FLAGS_endpoint,
+                                  pid_descriptor->Value(),
+                                  param_data,
+                                  param_data_length);
+      }
+    }
   }
   controller.Run();
+
+  if (FLAGS_count > 1 || target_ips.size() > 1)
+    controller.PrintStats();
 }
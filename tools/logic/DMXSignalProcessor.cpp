@@ -39,9 +39,19 @@
  *  36.72 (9 * 4.08) useconds passes and there was no rising edge it's a break.
  *
  * The implementation is based on a state machine, with a couple of tweaks.
+ *
+ * At high sample rates most samples don't change the state, they just extend
+ * the current one. So the samples are first split into runs of the same
+ * value, which is done a word at a time. Then each run is passed through the
+ * state machine, skipping over the samples that can't cause a transition.
  */
 
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include <ola/Logging.h>
+#include <algorithm>
 #include <vector>
 
 #include "tools/logic/DMXSignalProcessor.h"
@@ -85,8 +95,37 @@ DMXSignalProcessor::DMXSignalProcessor(DataCallback *callback,
  */
 void DMXSignalProcessor::Process(uint8_t *ptr, unsigned int size,
                                  uint8_t mask) {
-  for (unsigned int i = 0 ; i < size; i++) {
-    ProcessSample(ptr[i] & mask);
+  unsigned int i = 0;
+  while (i < size) {
+    bool bit = ptr[i] & mask;
+    unsigned int run = FindEdge(ptr + i, size - i, mask, bit);
+    ProcessRun(bit, run);
+    i += run;
+  }
+}
+
+/**
+ * Process a run of samples that all have the same value. This gives the same
+ * result as calling ProcessSample() for each sample.
+ * @param bit the value of the samples.
+ * @param count the number of samples.
+ */
+void DMXSignalProcessor::ProcessRun(bool bit, unsigned int count) {
+  while (count) {
+    unsigned int quiet = std::min(count, QuietSamples(bit));
+    if (quiet) {
+      if (m_state != UNDEFINED) {
+        m_ticks += quiet;
+      }
+      if (m_may_be_in_break && !bit) {
+        m_ticks_in_break += quiet;
+      }
+      count -= quiet;
+    }
+    if (count) {
+      ProcessSample(bit);
+      count--;
+    }
   }
 }
 
@@ -181,6 +220,7 @@ void DMXSignalProcessor::ProcessSample(bool bit) {
         }
       } else {
         m_may_be_in_break = true;
+        m_ticks_in_break = 1;
         // Assume it's a start bit for now, but flag that we may be in a break.
         SetState(START_BIT);
       }
@@ -190,6 +230,68 @@ void DMXSignalProcessor::ProcessSample(bool bit) {
   }
 }
 
+/**
+ * Return the number of samples of this value that would only extend the
+ * current state. The sample after these may cause a transition.
+ */
+unsigned int DMXSignalProcessor::QuietSamples(bool bit) const {
+  switch (m_state) {
+    case UNDEFINED:
+    case BREAK:
+      return bit ? 0 : UINT_MAX;
+    case IDLE:
+      return bit ? UINT_MAX : 0;
+    case MAB:
+      return bit ? TicksUntil(MAX_MAB_TIME) - 1 : 0;
+    case START_BIT:
+    case BIT_1:
+    case BIT_2:
+    case BIT_3:
+    case BIT_4:
+    case BIT_5:
+    case BIT_6:
+    case BIT_7:
+    case BIT_8:
+      if (bit && m_may_be_in_break) {
+        return 0;
+      }
+      if (m_state != START_BIT) {
+        // The first sample of a data bit sets its value.
+        int offset = m_state - BIT_1;
+        if (!m_bits_defined[offset] || m_current_byte[offset] != bit) {
+          return 0;
+        }
+      } else if (bit) {
+        return 0;
+      }
+      return TicksUntil(MAX_BIT_TIME) - 1;
+    case STOP_BITS:
+      return bit ? TicksUntil(2 * MIN_BIT_TIME) - 1 : 0;
+    case MARK_BETWEEN_SLOTS:
+      return bit ? TicksUntil(MAX_MARK_BETWEEN_SLOTS) - 1 : 0;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Return the number of ticks to add before DurationExceeds(micro_seconds) is
+ * true. This is always at least 1.
+ */
+unsigned int DMXSignalProcessor::TicksUntil(double micro_seconds) const {
+  double ticks = ceil(micro_seconds / m_microseconds_per_tick) - m_ticks;
+  unsigned int count = ticks > 1 ? static_cast<unsigned int>(ticks) : 1;
+  // Correct for any rounding, so this matches DurationExceeds() exactly.
+  while (count > 1 &&
+         (m_ticks + count - 1) * m_microseconds_per_tick >= micro_seconds) {
+    count--;
+  }
+  while ((m_ticks + count) * m_microseconds_per_tick < micro_seconds) {
+    count++;
+  }
+  return count;
+}
+
 /**
  * Process a sample that makes up a bit of data.
  */
@@ -312,3 +414,43 @@ bool DMXSignalProcessor::DurationExceeds(double micro_seconds) {
 double DMXSignalProcessor::TicksAsMicroSeconds() {
   return m_ticks * m_microseconds_per_tick;
 }
+
+/*
+ * Return the number of samples, starting from ptr, that have the same value.
+ * The samples are checked eight at a time, then the edge is found within the
+ * word.
+ * @param ptr the samples, the first of which has the value bit.
+ * @param size the number of samples.
+ * @param mask the mask to apply to each sample.
+ * @param bit the value of the first sample.
+ */
+unsigned int DMXSignalProcessor::FindEdge(const uint8_t *ptr,
+                                          unsigned int size,
+                                          uint8_t mask,
+                                          bool bit) {
+  const uint64_t ONES = 0x0101010101010101ULL;
+  const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+  const uint64_t word_mask = ONES * mask;
+
+  unsigned int i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, ptr + i, sizeof(word));
+    word &= word_mask;
+    if (bit) {
+      // This is non-0 if any of the bytes are 0.
+      if ((word - ONES) & ~word & HIGH_BITS) {
+        break;
+      }
+    } else if (word) {
+      break;
+    }
+  }
+
+  for (; i < size; i++) {
+    if (static_cast<bool>(ptr[i] & mask) != bit) {
+      break;
+    }
+  }
+  return i;
+}
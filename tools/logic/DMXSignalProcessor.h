@@ -44,6 +44,9 @@ class DMXSignalProcessor {
     // Process more data.
     void Process(uint8_t *ptr, unsigned int size, uint8_t mask = 0xff);
 
+    // Process a run of samples that all have the same value.
+    void ProcessRun(bool bit, unsigned int count);
+
  private:
     enum State {
       UNDEFINED,  // when the signal is low and we have no idea where we are.
@@ -85,6 +88,8 @@ class DMXSignalProcessor {
     std::vector<uint8_t> m_dmx_data;
 
     void ProcessSample(bool bit);
+    unsigned int QuietSamples(bool bit) const;
+    unsigned int TicksUntil(double micro_seconds) const;
     void ProcessBit(bool bit);
     bool SetBitIfNotDefined(bool bit);
     void AppendDataByte();
@@ -94,6 +99,9 @@ class DMXSignalProcessor {
     bool DurationExceeds(double micro_seconds);
     double TicksAsMicroSeconds();
 
+    static unsigned int FindEdge(const uint8_t *ptr, unsigned int size,
+                                 uint8_t mask, bool bit);
+
     static const unsigned int DMX_BITRATE = 250000;
     // These are all in microseconds and are the receiver side limits.
     static const double MIN_BREAK_TIME;
@@ -49,13 +49,15 @@
 #include <ola/rdm/RDMResponseCodes.h>
 #include <ola/rdm/UID.h>
 #include <ola/StringUtils.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/SPSCQueue.h>
+#include <ola/thread/Thread.h>
 
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
-#include <queue>
 
 #include "tools/logic/DMXSignalProcessor.h"
 
@@ -75,6 +77,7 @@ using ola::rdm::UID;
 using ola::strings::ToHex;
 
 
+using ola::thread::ConditionVariable;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using ola::NewSingleCallback;
@@ -96,7 +99,136 @@ DEFINE_string(pid_location, "",
 void OnReadData(U64 device_id, U8 *data, uint32_t data_length,
                 void *user_data);
 void OnError(U64 device_id, void *user_data);
-void ProcessData(U8 *data, uint32_t data_length);
+
+/**
+ * Decodes the samples on a separate thread.
+ *
+ * The callback thread hands each block of samples over with a lock-free
+ * queue, so it's never held up by the decoder. If the decoder falls behind and
+ * the queue fills, the block is dropped and the signal processor is reset
+ * before the next one.
+ */
+class DecoderThread : public ola::thread::Thread {
+ public:
+    DecoderThread(DMXSignalProcessor *processor, unsigned int queue_size)
+      : Thread(Thread::Options("logic-decoder")),
+        m_processor(processor),
+        m_queue(queue_size),
+        m_terminate(false),
+        m_missed_samples(false),
+        m_dropped_blocks(0) {
+    }
+
+    bool QueueSamples(U8 *data, uint32_t data_length);
+    void Terminate();
+
+    // Only valid once the device has stopped.
+    uint64_t DroppedBlocks() const { return m_dropped_blocks; }
+
+    static const unsigned int DEFAULT_QUEUE_SIZE = 1024;
+
+ protected:
+    void *Run();
+
+ private:
+    typedef struct {
+      U8 *data;
+      uint32_t length;
+      bool after_gap;
+    } SampleBlock;
+
+    DMXSignalProcessor *m_processor;
+    ola::thread::SPSCQueue<SampleBlock> m_queue;
+    Mutex m_mutex;
+    ConditionVariable m_condition;
+    bool m_terminate;  // GUARDED_BY(m_mutex)
+
+    // Only used by the callback thread.
+    bool m_missed_samples;
+    uint64_t m_dropped_blocks;
+
+    void ProcessBlocks();
+
+    // The longest the decoder sleeps if it misses a wake up.
+    static const unsigned int MAX_WAIT_MS = 10;
+};
+
+const unsigned int DecoderThread::DEFAULT_QUEUE_SIZE;
+const unsigned int DecoderThread::MAX_WAIT_MS;
+
+
+/**
+ * Called by the receive thread when new data arrives.
+ * @param data pointer to the data, ownership is transferred.
+ * @param data_length the size of the data
+ * @returns false if the data was dropped.
+ */
+bool DecoderThread::QueueSamples(U8 *data, uint32_t data_length) {
+  SampleBlock block = {data, data_length, m_missed_samples};
+  if (!m_queue.Push(block)) {
+    DevicesManagerInterface::DeleteU8ArrayPtr(data);
+    m_missed_samples = true;
+    m_dropped_blocks++;
+    return false;
+  }
+  m_missed_samples = false;
+  // This is done without the lock, so the decoder may miss it. In that case
+  // it picks up the block when the wait times out.
+  m_condition.Signal();
+  return true;
+}
+
+
+/**
+ * Stop the thread, once the queued samples have been decoded.
+ */
+void DecoderThread::Terminate() {
+  if (!IsRunning()) {
+    return;
+  }
+  {
+    MutexLocker lock(&m_mutex);
+    m_terminate = true;
+  }
+  m_condition.Signal();
+  Join();
+}
+
+
+void *DecoderThread::Run() {
+  ola::Clock clock;
+  while (true) {
+    ProcessBlocks();
+
+    MutexLocker lock(&m_mutex);
+    if (m_terminate) {
+      break;
+    }
+    if (m_queue.Empty()) {
+      // TimedWait() expects an absolute real time.
+      ola::TimeStamp wake_up_time;
+      clock.CurrentRealTime(&wake_up_time);
+      wake_up_time += ola::TimeInterval(MAX_WAIT_MS * 1000);
+      m_condition.TimedWait(&m_mutex, wake_up_time);
+    }
+  }
+  ProcessBlocks();
+  return NULL;
+}
+
+
+void DecoderThread::ProcessBlocks() {
+  SampleBlock block;
+  while (m_queue.Pop(&block)) {
+    if (block.after_gap) {
+      OLA_WARN << "Samples were dropped, the decoder is too slow";
+      m_processor->Reset();
+    }
+    m_processor->Process(block.data, block.length, 0x01);
+    DevicesManagerInterface::DeleteU8ArrayPtr(block.data);
+  }
+}
+
 
 class LogicReader {
  public:
@@ -107,11 +239,13 @@ class LogicReader {
         m_ss(ss),
         m_signal_processor(ola::NewCallback(this, &LogicReader::FrameReceived),
                            sample_rate),
+        m_decoder(&m_signal_processor, DecoderThread::DEFAULT_QUEUE_SIZE),
         m_pid_helper(FLAGS_pid_location.str(), 4),
         m_command_printer(&cout, &m_pid_helper) {
       if (!m_pid_helper.Init()) {
         OLA_WARN << "Failed to init PidStore";
       }
+      m_decoder.Start();
     }
     ~LogicReader();
 
@@ -134,12 +268,10 @@ class LogicReader {
     mutable Mutex m_mu;
     SelectServer *m_ss;
     DMXSignalProcessor m_signal_processor;
+    DecoderThread m_decoder;
     PidStoreHelper m_pid_helper;
     CommandPrinter m_command_printer;
-    Mutex m_data_mu;
-    std::queue<U8*> m_free_data;
 
-    void ProcessData(U8 *data, uint32_t data_length);
     void DisplayDMXFrame(const uint8_t *data, unsigned int length);
     void DisplayRDMFrame(const uint8_t *data, unsigned int length);
     void DisplayAlternateFrame(const uint8_t *data, unsigned int length);
@@ -147,6 +279,7 @@ class LogicReader {
 };
 
 LogicReader::~LogicReader() {
+  m_decoder.Terminate();
   m_ss->DrainCallbacks();
 }
 
@@ -206,17 +339,7 @@ void LogicReader::DataReceived(U64 device, U8 *data, uint32_t data_length) {
       return;
     }
   }
-  m_ss->Execute(
-      NewSingleCallback(this, &LogicReader::ProcessData, data, data_length));
-
-  {
-    MutexLocker lock(&m_data_mu);
-    while (!m_free_data.empty()) {
-      U8 *data = m_free_data.front();
-      DevicesManagerInterface::DeleteU8ArrayPtr(data);
-      m_free_data.pop();
-    }
-  }
+  m_decoder.QueueSamples(data, data_length);
 }
 
 
@@ -239,33 +362,17 @@ void LogicReader::FrameReceived(const uint8_t *data, unsigned int length) {
 
 
 void LogicReader::Stop() {
-  MutexLocker lock(&m_mu);
-  if (m_logic) {
-    m_logic->Stop();
-  }
-}
-
-
-/**
- * Called in the main thread.
- * @param data pointer to the data, ownership is transferred, use
- *   DeleteU8ArrayPtr to free.
- * @param data_length the size of the data
- */
-void LogicReader::ProcessData(U8 *data, uint32_t data_length) {
-  m_signal_processor.Process(data, data_length, 0x01);
-  DevicesManagerInterface::DeleteU8ArrayPtr(data);
-
-  /*
-   * This is commented out until we get clarification on if DeleteU8ArrayPtr is
-   * thread safe. http://community.saleae.com/node/403
-   */
-  /*
   {
-    MutexLocker lock(&m_data_mu);
-    m_free_data.push(data);
+    MutexLocker lock(&m_mu);
+    if (m_logic) {
+      m_logic->Stop();
+    }
+  }
+  m_decoder.Terminate();
+  if (m_decoder.DroppedBlocks()) {
+    OLA_WARN << m_decoder.DroppedBlocks()
+             << " blocks of samples were dropped";
   }
-  */
 }
 
 
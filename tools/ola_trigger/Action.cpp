@@ -31,8 +31,10 @@
 #include <tchar.h>
 #endif  // _WIN32
 
+#include <ola/base/SysExits.h>
 #include <ola/stl/STLUtils.h>
 #include "tools/ola_trigger/Action.h"
+#include "tools/ola_trigger/ActionExecutor.h"
 #include "tools/ola_trigger/VariableInterpolator.h"
 
 using std::string;
@@ -44,7 +46,7 @@ using std::vector;
  */
 void VariableAssignmentAction::Execute(Context *context, uint8_t) {
   string interpolated_value;
-  bool ok = InterpolateVariables(m_value, &interpolated_value, *context);
+  bool ok = m_value_template.Expand(*context, &interpolated_value);
 
   if (ok) {
     if (context) {
@@ -58,36 +60,22 @@ void VariableAssignmentAction::Execute(Context *context, uint8_t) {
 }
 
 
-/**
- * @brief Execute the command
+namespace {
+/*
+ * Start a command.
+ * @param command the command to run
+ * @param args the NULL terminated argument list, including the command.
  */
-void CommandAction::Execute(Context *context, uint8_t) {
-  char **args = BuildArgList(context);
-
-  if (ola::LogLevel() >= ola::OLA_LOG_INFO) {
-    std::ostringstream str;
-    char **ptr = args;
-    str << "Executing: " << m_command << " : [";
-    ptr++;  // skip over argv[0]
-    while (*ptr) {
-      str << "\"" << *ptr++ << "\"";
-      if (*ptr) {
-        str << ", ";
-      }
-    }
-    str << "]";
-    OLA_INFO << str.str();
-  }
-
+void StartCommand(const string &command, char **args) {
 #ifdef _WIN32
   std::ostringstream command_line_builder;
   char** arg = args;
   // Escape argv[0] if needed
-  if ((m_command.find(" ") != string::npos) &&
-      (m_command.find("\"") != 0)) {
-      command_line_builder << "\"" << m_command << "\" ";
+  if ((command.find(" ") != string::npos) &&
+      (command.find("\"") != 0)) {
+      command_line_builder << "\"" << command << "\" ";
   } else {
-    command_line_builder << m_command << " ";
+    command_line_builder << command << " ";
   }
   ++arg;
   while (*arg) {
@@ -114,7 +102,6 @@ void CommandAction::Execute(Context *context, uint8_t) {
                      &startup_info,
                      &process_information)) {
     OLA_WARN << "Could not launch " << args[0] << ": " << GetLastError();
-    FreeArgList(args);
   } else {
     // Don't leak the handles
     CloseHandle(process_information.hProcess);
@@ -125,38 +112,104 @@ void CommandAction::Execute(Context *context, uint8_t) {
 #else
   pid_t pid;
   if ((pid = fork()) < 0) {
-    OLA_FATAL << "Could not fork to exec " << m_command;
-    FreeArgList(args);
+    OLA_FATAL << "Could not fork to exec " << command;
     return;
   } else if (pid) {
     // parent
-    OLA_DEBUG << "Child for " << m_command << " is " << pid;
-    FreeArgList(args);
+    OLA_DEBUG << "Child for " << command << " is " << pid;
     return;
   }
 
-  execvp(m_command.c_str(), args);
+  execvp(command.c_str(), args);
+  // Only async-signal-safe calls are allowed in the child.
+  _exit(ola::EXIT_OSERR);
 #endif  // _WIN32
 }
 
 
+/*
+ * Delete an argument list built by CommandAction::BuildArgList().
+ */
+void DeleteArgList(char **args) {
+  char **ptr = args;
+  while (*ptr) {
+    delete[] *ptr++;
+  }
+  delete[] args;
+}
+
+
+/*
+ * The job used to start a command from an ActionExecutor.
+ */
+class CommandJob: public ActionJob {
+ public:
+  CommandJob(const string &command, char **args)
+      : m_command(command),
+        m_args(args) {
+  }
+  ~CommandJob() { DeleteArgList(m_args); }
+
+  void Run() { StartCommand(m_command, m_args); }
+
+ private:
+  const string m_command;
+  char **m_args;
+};
+}  // namespace
+
+
+/**
+ * @brief Execute the command
+ */
+void CommandAction::Execute(Context *context, uint8_t) {
+  char **args = BuildArgList(context);
+  if (!args) {
+    return;
+  }
+
+  if (ola::LogLevel() >= ola::OLA_LOG_INFO) {
+    std::ostringstream str;
+    char **ptr = args;
+    str << "Executing: " << m_command << " : [";
+    ptr++;  // skip over argv[0]
+    while (*ptr) {
+      str << "\"" << *ptr++ << "\"";
+      if (*ptr) {
+        str << ", ";
+      }
+    }
+    str << "]";
+    OLA_INFO << str.str();
+  }
+
+  if (m_executor) {
+    m_executor->Execute(this, new CommandJob(m_command, args));
+  } else {
+    StartCommand(m_command, args);
+    FreeArgList(args);
+  }
+}
+
+
 /**
  * Interpolate all the arguments, and return a pointer to an array of char*
  * pointers which can be passed to exec()
  */
 char **CommandAction::BuildArgList(const Context *context) {
   // we need to add the command here as the first arg, also +1 for the NULL
-  unsigned int array_size = m_arguments.size() + 2;
+  unsigned int array_size = m_argument_templates.size() + 2;
   char **args = new char*[array_size];
   memset(args, 0, sizeof(args[0]) * array_size);
 
   args[0] = StringToDynamicChar(m_command);
 
-  vector<string>::const_iterator iter = m_arguments.begin();
+  vector<VariableTemplate>::const_iterator iter =
+      m_argument_templates.begin();
   unsigned int i = 1;
-  for (; iter != m_arguments.end(); i++, iter++) {
+  for (; iter != m_argument_templates.end(); i++, iter++) {
     string result;
-    if (!InterpolateVariables(*iter, &result, *context)) {
+    if (!iter->Expand(*context, &result)) {
       FreeArgList(args);
       return NULL;
     }
@@ -170,11 +223,7 @@ char **CommandAction::BuildArgList(const Context *context) {
  * @brief Free the arg array.
  */
 void CommandAction::FreeArgList(char **args) {
-  char **ptr = args;
-  while (*ptr) {
-    delete[] *ptr++;
-  }
-  delete[] args;
+  DeleteArgList(args);
 }
 
 
@@ -248,6 +297,7 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
       new ValueInterval(interval_arg),
       rising_action,
       falling_action);
+  m_tables_valid = false;
 
   if (m_actions.empty()) {
     m_actions.push_back(action_interval);
@@ -371,15 +421,12 @@ void Slot::TakeAction(Context *context,
     rising = value > m_old_value;
   }
 
-  Action *action = LocateMatchingAction(value, rising);
+  if (!m_tables_valid) {
+    BuildTables();
+  }
+  Action *action = rising ? m_rising_table[value] : m_falling_table[value];
   if (action) {
     action->Execute(context, value);
-  } else {
-    if (rising && m_default_rising_action) {
-      m_default_rising_action->Execute(context, value);
-    } else if (!rising && m_default_falling_action) {
-      m_default_falling_action->Execute(context, value);
-    }
   }
 
   m_old_value_defined = true;
@@ -396,17 +443,6 @@ string Slot::IntervalsAsString() const {
 }
 
 
-/**
- * @brief Given two interval iterators, first and last, return true if the value is
- *   contained within the lower and upper bounds of the intervals.
- */
-bool Slot::ValueWithinIntervals(uint8_t value,
-                                const ValueInterval &lower_interval,
-                                const ValueInterval &upper_interval) {
-  return lower_interval.Lower() <= value && value <= upper_interval.Upper();
-}
-
-
 /**
  * @brief Check if two ValueIntervals intersect.
  */
@@ -420,63 +456,6 @@ bool Slot::IntervalsIntersect(const ValueInterval *a1,
 }
 
 
-/**
- * @brief Given a value, find the matching ValueInterval.
- * @param value the value to search for
- * @param rising, true if the new value is rising, false otherwise.
- * @returns the Action matching the value,  or NULL if there isn't one.
- */
-Action *Slot::LocateMatchingAction(uint8_t value, bool rising) {
-  if (m_actions.empty()) {
-    return NULL;
-  }
-
-  ActionVector::iterator lower = m_actions.begin();
-  ActionVector::iterator upper = m_actions.end();
-  upper--;
-  if (!ValueWithinIntervals(value, *(lower->interval), *(upper->interval))) {
-    return NULL;
-  }
-
-  // ok, we know the value lies between the intervals we have, first exclude
-  // the endpoints
-  if (lower->interval->Contains(value)) {
-    return rising ? lower->rising_action : lower->falling_action;
-  }
-
-  if (upper->interval->Contains(value)) {
-    return rising ? upper->rising_action : upper->falling_action;
-  }
-
-  // value isn't at the lower or upper interval, but lies somewhere between
-  // the two.
-  // @pre lower != upper
-  // @pre !lower.Contains(value) && !upper.Contains(value)
-  while (true) {
-    unsigned int difference = upper - lower;
-    ActionVector::iterator mid = lower + difference / 2;
-
-    if (mid == lower) {
-      // lower doesn't contain the value, so we don't have it
-      return NULL;
-    }
-
-    if (mid->interval->Contains(value)) {
-      return rising ? mid->rising_action : mid->falling_action;
-    } else if (value <= mid->interval->Lower()) {
-      upper = mid;
-    } else if (value >= mid->interval->Upper()) {
-      lower = mid;
-    } else {
-      OLA_WARN << "Inconsistent intervals detected when looking for: "
-               << static_cast<int>(value) << ", intervals: "
-               << IntervalsAsString(lower, upper);
-      return NULL;
-    }
-  }
-}
-
-
 /**
  * @brief Format the intervals between the two iterators as a string
  * @param start an iterator pointing to the first interval
@@ -510,5 +489,34 @@ bool Slot::SetDefaultAction(Action **action_to_set,
     (*action_to_set)->DeRef();
   }
   *action_to_set = new_action;
+  m_tables_valid = false;
   return previous_default_set;
 }
+
+
+/**
+ * @brief Build the tables that map each value to the action to run.
+ *
+ * Values which aren't within an interval, or whose interval doesn't have an
+ * action for the direction, use the default action.
+ */
+void Slot::BuildTables() {
+  for (unsigned int value = 0; value < TABLE_SIZE; value++) {
+    m_rising_table[value] = m_default_rising_action;
+    m_falling_table[value] = m_default_falling_action;
+  }
+
+  ActionVector::const_iterator iter = m_actions.begin();
+  for (; iter != m_actions.end(); ++iter) {
+    for (unsigned int value = iter->interval->Lower();
+         value <= iter->interval->Upper(); value++) {
+      if (iter->rising_action) {
+        m_rising_table[value] = iter->rising_action;
+      }
+      if (iter->falling_action) {
+        m_falling_table[value] = iter->falling_action;
+      }
+    }
+  }
+  m_tables_valid = true;
+}
@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "tools/ola_trigger/Context.h"
+#include "tools/ola_trigger/VariableInterpolator.h"
 
 /*
  * @brief An Action is a behavior that is run when a particular DMX value is received
@@ -67,7 +68,8 @@ class VariableAssignmentAction: public Action {
                            const std::string &value)
       : Action(),
         m_variable(variable),
-        m_value(value) {
+        m_value(value),
+        m_value_template(value) {
   }
 
   void Execute(Context *context, uint8_t slot_value);
@@ -75,18 +77,27 @@ class VariableAssignmentAction: public Action {
  private:
   const std::string m_variable;
   const std::string m_value;
+  const VariableTemplate m_value_template;
 };
 
 
 /**
  * @brief Command Action. This action executes a command.
+ *
+ * If an ActionExecutor is provided the command is started from one of its
+ * threads, otherwise it's started from the thread that calls Execute().
  */
 class CommandAction: public Action {
  public:
   CommandAction(const std::string &command,
-                const std::vector<std::string> &arguments)
+                const std::vector<std::string> &arguments,
+                class ActionExecutor *executor = NULL)
       : m_command(command),
-        m_arguments(arguments) {
+        m_executor(executor) {
+    std::vector<std::string>::const_iterator iter = arguments.begin();
+    for (; iter != arguments.end(); ++iter) {
+      m_argument_templates.push_back(VariableTemplate(*iter));
+    }
   }
   virtual ~CommandAction() {}
 
@@ -94,7 +105,9 @@ class CommandAction: public Action {
 
  protected:
   const std::string m_command;
-  std::vector<std::string> m_arguments;
+  // The arguments, parsed once when the action is created.
+  std::vector<VariableTemplate> m_argument_templates;
+  class ActionExecutor *m_executor;
 
   char **BuildArgList(const Context *context);
   void FreeArgList(char **args);
@@ -147,7 +160,8 @@ class Slot {
       m_default_falling_action(NULL),
       m_slot_offset(slot_offset),
       m_old_value(0),
-      m_old_value_defined(false) {
+      m_old_value_defined(false),
+      m_tables_valid(false) {
   }
   ~Slot();
 
@@ -174,6 +188,15 @@ class Slot {
   uint8_t m_old_value;
   bool m_old_value_defined;
 
+  /*
+   * The action to run for each value, including the defaults. These are
+   * built from the intervals the first time they're needed after a change.
+   */
+  enum { TABLE_SIZE = 256 };
+  bool m_tables_valid;
+  Action *m_rising_table[TABLE_SIZE];
+  Action *m_falling_table[TABLE_SIZE];
+
   /**
    * @brief An interval of DMX values and the action to be taken for matching
    * values.
@@ -246,14 +269,11 @@ class Slot {
   typedef std::vector<ActionInterval> ActionVector;
   ActionVector m_actions;
 
-  bool ValueWithinIntervals(uint8_t value,
-                            const ValueInterval &lower_interval,
-                            const ValueInterval &upper_interval);
   bool IntervalsIntersect(const ValueInterval *a1,
                           const ValueInterval *a2);
-  Action *LocateMatchingAction(uint8_t value, bool rising);
   std::string IntervalsAsString(const ActionVector::const_iterator &start,
                                 const ActionVector::const_iterator &end) const;
   bool SetDefaultAction(Action **action_to_set, Action *new_action);
+  void BuildTables();
 };
 #endif  // TOOLS_OLA_TRIGGER_ACTION_H_
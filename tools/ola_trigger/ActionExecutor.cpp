@@ -0,0 +1,197 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ActionExecutor.cpp
+ * Runs actions on a pool of worker threads.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/Logging.h>
+#include <ola/stl/STLUtils.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/Thread.h>
+#include <string>
+#include <vector>
+
+#include "tools/ola_trigger/ActionExecutor.h"
+
+using ola::thread::MutexLocker;
+using std::deque;
+using std::string;
+
+const unsigned int ActionExecutor::DEFAULT_MAX_QUEUED;
+
+/**
+ * @brief A thread which runs jobs from an ActionExecutor.
+ */
+class WorkerThread : public ola::thread::Thread {
+ public:
+  explicit WorkerThread(ActionExecutor *executor)
+      : Thread(Thread::Options("trigger-action")),
+        m_executor(executor) {
+  }
+
+ protected:
+  void *Run() {
+    ActionJob *job;
+    while (m_executor->NextJob(&job)) {
+      job->Run();
+      delete job;
+    }
+    return NULL;
+  }
+
+ private:
+  ActionExecutor *m_executor;
+};
+
+
+ActionExecutor::ActionExecutor(unsigned int thread_count,
+                               unsigned int max_queued,
+                               Policy policy)
+    : m_thread_count(thread_count),
+      m_max_queued(max_queued),
+      m_policy(policy),
+      m_shutdown(false),
+      m_dropped_jobs(0),
+      m_replaced_jobs(0) {
+}
+
+
+ActionExecutor::~ActionExecutor() {
+  Stop();
+}
+
+
+/**
+ * @brief Start the worker threads.
+ */
+bool ActionExecutor::Start() {
+  for (unsigned int i = 0; i < m_thread_count; i++) {
+    WorkerThread *thread = new WorkerThread(this);
+    if (!thread->Start()) {
+      OLA_WARN << "Failed to start action thread";
+      delete thread;
+      Stop();
+      return false;
+    }
+    m_threads.push_back(thread);
+  }
+  return true;
+}
+
+
+/**
+ * @brief Stop the worker threads.
+ *
+ * Jobs that are running are waited for, jobs that haven't started are
+ * discarded.
+ */
+void ActionExecutor::Stop() {
+  {
+    MutexLocker lock(&m_mutex);
+    m_shutdown = true;
+  }
+  m_condition.Broadcast();
+
+  std::vector<WorkerThread*>::iterator iter = m_threads.begin();
+  for (; iter != m_threads.end(); ++iter) {
+    (*iter)->Join();
+  }
+  ola::STLDeleteElements(&m_threads);
+
+  deque<QueuedJob>::iterator job_iter = m_queue.begin();
+  for (; job_iter != m_queue.end(); ++job_iter) {
+    delete job_iter->job;
+  }
+  m_queue.clear();
+}
+
+
+bool ActionExecutor::Execute(const void *key, ActionJob *job) {
+  {
+    MutexLocker lock(&m_mutex);
+    if (m_policy == LATEST_WINS) {
+      deque<QueuedJob>::iterator iter = m_queue.begin();
+      for (; iter != m_queue.end(); ++iter) {
+        if (iter->key == key) {
+          delete iter->job;
+          iter->job = job;
+          m_replaced_jobs++;
+          return true;
+        }
+      }
+    }
+
+    if (m_shutdown || m_queue.size() >= m_max_queued) {
+      m_dropped_jobs++;
+      delete job;
+      return false;
+    }
+    QueuedJob queued_job = {key, job};
+    m_queue.push_back(queued_job);
+  }
+  m_condition.Signal();
+  return true;
+}
+
+
+uint64_t ActionExecutor::DroppedJobs() const {
+  MutexLocker lock(&m_mutex);
+  return m_dropped_jobs;
+}
+
+
+uint64_t ActionExecutor::ReplacedJobs() const {
+  MutexLocker lock(&m_mutex);
+  return m_replaced_jobs;
+}
+
+
+/**
+ * @brief Convert a string to a Policy.
+ * @param input the string, either "queue" or "latest".
+ * @param[out] policy the Policy.
+ * @returns true if the string was valid, false otherwise.
+ */
+bool ActionExecutor::StringToPolicy(const string &input, Policy *policy) {
+  if (input == "queue") {
+    *policy = QUEUE;
+    return true;
+  } else if (input == "latest") {
+    *policy = LATEST_WINS;
+    return true;
+  }
+  return false;
+}
+
+
+/**
+ * @brief Wait for the next job, called by the worker threads.
+ * @param[out] job the job to run.
+ * @returns false if the thread should exit.
+ */
+bool ActionExecutor::NextJob(ActionJob **job) {
+  MutexLocker lock(&m_mutex);
+  while (m_queue.empty() && !m_shutdown) {
+    m_condition.Wait(&m_mutex);
+  }
+  if (m_shutdown) {
+    return false;
+  }
+  *job = m_queue.front().job;
+  m_queue.pop_front();
+  return true;
+}
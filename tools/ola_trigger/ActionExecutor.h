@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ActionExecutor.h
+ * Runs actions on a pool of worker threads.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef TOOLS_OLA_TRIGGER_ACTIONEXECUTOR_H_
+#define TOOLS_OLA_TRIGGER_ACTIONEXECUTOR_H_
+
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A unit of work for the ActionExecutor.
+ *
+ * Everything the job needs, e.g. the interpolated arguments, must be copied
+ * into it when it's created, since it runs on a different thread.
+ */
+class ActionJob {
+ public:
+  virtual ~ActionJob() {}
+  virtual void Run() = 0;
+};
+
+
+/**
+ * @brief Runs ActionJobs on a bounded pool of worker threads, so slow
+ * actions don't hold up the DMX processing.
+ *
+ * Each job is submitted with a key identifying the action that created it.
+ * With the LATEST_WINS policy, a job replaces any job for the same key that
+ * hasn't started yet, so rapid repeated firings of an action collapse into
+ * one run with the latest values. With the QUEUE policy every job is run.
+ *
+ * If max_queued jobs are waiting, new jobs are dropped.
+ */
+class ActionExecutor {
+ public:
+  typedef enum {
+    QUEUE,
+    LATEST_WINS,
+  } Policy;
+
+  ActionExecutor(unsigned int thread_count,
+                 unsigned int max_queued,
+                 Policy policy);
+  ~ActionExecutor();
+
+  bool Start();
+  void Stop();
+
+  /**
+   * @brief Queue a job, this takes ownership of the job.
+   * @param key identifies the action the job is for.
+   * @param job the job to run.
+   * @returns false if the job was dropped because the queue was full.
+   */
+  bool Execute(const void *key, ActionJob *job);
+
+  uint64_t DroppedJobs() const;
+  uint64_t ReplacedJobs() const;
+
+  static bool StringToPolicy(const std::string &input, Policy *policy);
+
+  static const unsigned int DEFAULT_MAX_QUEUED = 256;
+
+ private:
+  typedef struct {
+    const void *key;
+    ActionJob *job;
+  } QueuedJob;
+
+  const unsigned int m_thread_count;
+  const unsigned int m_max_queued;
+  const Policy m_policy;
+  std::vector<class WorkerThread*> m_threads;
+  std::deque<QueuedJob> m_queue;
+  bool m_shutdown;
+  uint64_t m_dropped_jobs;
+  uint64_t m_replaced_jobs;
+  mutable ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_condition;
+
+  bool NextJob(ActionJob **job);
+
+  friend class WorkerThread;
+
+  DISALLOW_COPY_AND_ASSIGN(ActionExecutor);
+};
+#endif  // TOOLS_OLA_TRIGGER_ACTIONEXECUTOR_H_
@@ -0,0 +1,206 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ActionExecutorTest.cpp
+ * Test fixture for the ActionExecutor class
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <ola/Logging.h>
+#include <ola/thread/Mutex.h>
+#include <vector>
+
+#include "tools/ola_trigger/ActionExecutor.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::ConditionVariable;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using std::vector;
+
+class ActionExecutorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ActionExecutorTest);
+  CPPUNIT_TEST(testQueue);
+  CPPUNIT_TEST(testLatestWins);
+  CPPUNIT_TEST(testMaxQueued);
+  CPPUNIT_TEST(testStringToPolicy);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testQueue();
+  void testLatestWins();
+  void testMaxQueued();
+  void testStringToPolicy();
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ActionExecutorTest);
+
+
+/**
+ * Records the values of the jobs that run. The first job can be held until
+ * Release() is called, so the following jobs stay queued.
+ */
+class JobRecorder {
+ public:
+  explicit JobRecorder(bool hold_first)
+      : m_held(hold_first),
+        m_started(false) {
+  }
+
+  void Run(unsigned int value) {
+    MutexLocker lock(&m_mutex);
+    m_started = true;
+    m_condition.Broadcast();
+    while (m_held) {
+      m_condition.Wait(&m_mutex);
+    }
+    m_values.push_back(value);
+    m_condition.Broadcast();
+  }
+
+  void WaitForStart() {
+    MutexLocker lock(&m_mutex);
+    while (!m_started) {
+      m_condition.Wait(&m_mutex);
+    }
+  }
+
+  void Release() {
+    MutexLocker lock(&m_mutex);
+    m_held = false;
+    m_condition.Broadcast();
+  }
+
+  vector<unsigned int> WaitForValues(unsigned int count) {
+    MutexLocker lock(&m_mutex);
+    while (m_values.size() < count) {
+      m_condition.Wait(&m_mutex);
+    }
+    return m_values;
+  }
+
+ private:
+  Mutex m_mutex;
+  ConditionVariable m_condition;
+  bool m_held;
+  bool m_started;
+  vector<unsigned int> m_values;
+};
+
+
+class RecordingJob: public ActionJob {
+ public:
+  RecordingJob(JobRecorder *recorder, unsigned int value)
+      : m_recorder(recorder),
+        m_value(value) {
+  }
+
+  void Run() { m_recorder->Run(m_value); }
+
+ private:
+  JobRecorder *m_recorder;
+  unsigned int m_value;
+};
+
+
+/**
+ * Check every job runs with the QUEUE policy.
+ */
+void ActionExecutorTest::testQueue() {
+  JobRecorder recorder(true);
+  ActionExecutor executor(1, 10, ActionExecutor::QUEUE);
+  OLA_ASSERT(executor.Start());
+
+  int key = 0;
+  OLA_ASSERT(executor.Execute(&key, new RecordingJob(&recorder, 1)));
+  recorder.WaitForStart();
+  OLA_ASSERT(executor.Execute(&key, new RecordingJob(&recorder, 2)));
+  OLA_ASSERT(executor.Execute(&key, new RecordingJob(&recorder, 3)));
+  recorder.Release();
+
+  vector<unsigned int> expected;
+  expected.push_back(1);
+  expected.push_back(2);
+  expected.push_back(3);
+  OLA_ASSERT_VECTOR_EQ(expected, recorder.WaitForValues(3));
+  executor.Stop();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), executor.ReplacedJobs());
+}
+
+
+/**
+ * Check queued jobs for the same key are replaced with the LATEST_WINS
+ * policy.
+ */
+void ActionExecutorTest::testLatestWins() {
+  JobRecorder recorder(true);
+  ActionExecutor executor(1, 10, ActionExecutor::LATEST_WINS);
+  OLA_ASSERT(executor.Start());
+
+  int key1 = 0, key2 = 0;
+  OLA_ASSERT(executor.Execute(&key1, new RecordingJob(&recorder, 1)));
+  recorder.WaitForStart();
+  OLA_ASSERT(executor.Execute(&key1, new RecordingJob(&recorder, 2)));
+  OLA_ASSERT(executor.Execute(&key2, new RecordingJob(&recorder, 10)));
+  OLA_ASSERT(executor.Execute(&key1, new RecordingJob(&recorder, 3)));
+  OLA_ASSERT(executor.Execute(&key1, new RecordingJob(&recorder, 4)));
+  recorder.Release();
+
+  vector<unsigned int> expected;
+  expected.push_back(1);
+  expected.push_back(4);
+  expected.push_back(10);
+  OLA_ASSERT_VECTOR_EQ(expected, recorder.WaitForValues(3));
+  executor.Stop();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), executor.ReplacedJobs());
+}
+
+
+/**
+ * Check jobs are dropped once the queue is full.
+ */
+void ActionExecutorTest::testMaxQueued() {
+  JobRecorder recorder(true);
+  ActionExecutor executor(1, 2, ActionExecutor::QUEUE);
+  OLA_ASSERT(executor.Start());
+
+  int key = 0;
+  OLA_ASSERT(executor.Execute(&key, new RecordingJob(&recorder, 1)));
+  recorder.WaitForStart();
+  OLA_ASSERT(executor.Execute(&key, new RecordingJob(&recorder, 2)));
+  OLA_ASSERT(executor.Execute(&key, new RecordingJob(&recorder, 3)));
+  OLA_ASSERT_FALSE(executor.Execute(&key, new RecordingJob(&recorder, 4)));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), executor.DroppedJobs());
+  recorder.Release();
+
+  OLA_ASSERT_EQ(static_cast<size_t>(3), recorder.WaitForValues(3).size());
+  executor.Stop();
+}
+
+
+void ActionExecutorTest::testStringToPolicy() {
+  ActionExecutor::Policy policy;
+  OLA_ASSERT(ActionExecutor::StringToPolicy("queue", &policy));
+  OLA_ASSERT_EQ(ActionExecutor::QUEUE, policy);
+  OLA_ASSERT(ActionExecutor::StringToPolicy("latest", &policy));
+  OLA_ASSERT_EQ(ActionExecutor::LATEST_WINS, policy);
+  OLA_ASSERT_FALSE(ActionExecutor::StringToPolicy("foo", &policy));
+}
@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BuiltinActions.cpp
+ * Actions that run in-process, rather than starting a command.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/StringUtils.h>
+#include <ola/network/NetworkUtils.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "tools/ola_trigger/BuiltinActions.h"
+
+using ola::DmxBuffer;
+using ola::network::IPV4SocketAddress;
+using std::string;
+using std::vector;
+
+namespace {
+/*
+ * Append a string to an OSC message, OSC strings are null terminated and
+ * padded to a multiple of 4 bytes.
+ */
+void AppendOSCString(const string &value, string *message) {
+  message->append(value);
+  message->append(4 - value.size() % 4, '\0');
+}
+}  // namespace
+
+
+/**
+ * @brief Set a slot and send the universe.
+ */
+void DmxWriter::SetSlot(unsigned int universe, uint16_t slot, uint8_t value) {
+  DmxBuffer &buffer = m_universes[universe];
+  if (buffer.Size() == 0) {
+    buffer.Blackout();
+  } else if (buffer.Get(slot) == value) {
+    return;
+  }
+  buffer.SetChannel(slot, value);
+  if (m_callback.get()) {
+    m_callback->Run(universe, buffer);
+  }
+}
+
+
+/**
+ * @brief Set the slot.
+ */
+void DmxWriteAction::Execute(Context *context, uint8_t) {
+  string universe_str, slot_str, value_str;
+  if (!context ||
+      !m_universe.Expand(*context, &universe_str) ||
+      !m_slot.Expand(*context, &slot_str) ||
+      !m_value.Expand(*context, &value_str)) {
+    return;
+  }
+
+  unsigned int universe;
+  uint16_t slot;
+  uint8_t value;
+  if (!ola::StringToInt(universe_str, &universe) ||
+      !ola::StringToInt(slot_str, &slot) ||
+      slot == 0 || slot > ola::DMX_UNIVERSE_SIZE ||
+      !ola::StringToInt(value_str, &value)) {
+    OLA_WARN << "Invalid DMX write: universe " << universe_str << ", slot "
+             << slot_str << ", value " << value_str;
+    return;
+  }
+  OLA_INFO << "Setting slot " << slot << " of universe " << universe << " to "
+           << static_cast<int>(value);
+  // Slots are 1 indexed in the config
+  m_writer->SetSlot(universe, slot - 1, value);
+}
+
+
+OSCSendAction::OSCSendAction(const IPV4SocketAddress &destination,
+                             const string &address,
+                             const vector<string> &arguments)
+    : m_destination(destination),
+      m_address(address),
+      m_socket_ready(false) {
+  vector<string>::const_iterator iter = arguments.begin();
+  for (; iter != arguments.end(); ++iter) {
+    m_arguments.push_back(VariableTemplate(*iter));
+  }
+}
+
+
+/**
+ * @brief Send the message.
+ */
+void OSCSendAction::Execute(Context *context, uint8_t) {
+  if (!context) {
+    return;
+  }
+
+  string address;
+  if (!m_address.Expand(*context, &address)) {
+    return;
+  }
+  vector<string> arguments(m_arguments.size());
+  for (unsigned int i = 0; i < m_arguments.size(); i++) {
+    if (!m_arguments[i].Expand(*context, &arguments[i])) {
+      return;
+    }
+  }
+
+  string message;
+  if (!BuildMessage(address, arguments, &message)) {
+    OLA_WARN << "Invalid OSC address " << address;
+    return;
+  }
+
+  if (!m_socket_ready) {
+    if (!m_socket.Init()) {
+      return;
+    }
+    m_socket_ready = true;
+  }
+  OLA_INFO << "Sending OSC message " << address << " to " << m_destination;
+  m_socket.SendTo(reinterpret_cast<const uint8_t*>(message.data()),
+                  message.size(), m_destination);
+}
+
+
+/**
+ * @brief Build an OSC message.
+ * @param address the OSC address, this must start with a /.
+ * @param arguments the arguments, integers are sent as int32, the rest as
+ *   strings.
+ * @param[out] message the encoded message.
+ * @returns true if the message was built, false if the address was invalid.
+ */
+bool OSCSendAction::BuildMessage(const string &address,
+                                 const vector<string> &arguments,
+                                 string *message) {
+  if (address.empty() || address[0] != '/') {
+    return false;
+  }
+
+  message->clear();
+  AppendOSCString(address, message);
+
+  string type_tags(",");
+  string data;
+  vector<string>::const_iterator iter = arguments.begin();
+  for (; iter != arguments.end(); ++iter) {
+    int int_value;
+    if (ola::StringToInt(*iter, &int_value, true)) {
+      type_tags.push_back('i');
+      uint32_t value = ola::network::HostToNetwork(
+          static_cast<uint32_t>(int_value));
+      data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    } else {
+      type_tags.push_back('s');
+      AppendOSCString(*iter, &data);
+    }
+  }
+  AppendOSCString(type_tags, message);
+  message->append(data);
+  return true;
+}
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BuiltinActions.h
+ * Actions that run in-process, rather than starting a command.
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#ifndef TOOLS_OLA_TRIGGER_BUILTINACTIONS_H_
+#define TOOLS_OLA_TRIGGER_BUILTINACTIONS_H_
+
+#include <ola/Callback.h>
+#include <ola/DmxBuffer.h>
+#include <ola/network/Socket.h>
+#include <ola/network/SocketAddress.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tools/ola_trigger/Action.h"
+#include "tools/ola_trigger/VariableInterpolator.h"
+
+/**
+ * @brief Holds the universes set by DmxWriteActions, and sends them when
+ * they change.
+ */
+class DmxWriter {
+ public:
+  typedef ola::Callback2<void, unsigned int, const ola::DmxBuffer&>
+      SendCallback;
+
+  DmxWriter() {}
+  ~DmxWriter() {}
+
+  /**
+   * @brief Set the callback used to send the data, this takes ownership.
+   */
+  void SetSendCallback(SendCallback *callback) { m_callback.reset(callback); }
+
+  void SetSlot(unsigned int universe, uint16_t slot, uint8_t value);
+
+ private:
+  std::auto_ptr<SendCallback> m_callback;
+  std::map<unsigned int, ola::DmxBuffer> m_universes;
+
+  DISALLOW_COPY_AND_ASSIGN(DmxWriter);
+};
+
+
+/**
+ * @brief An action that sets a slot in a universe.
+ */
+class DmxWriteAction: public Action {
+ public:
+  DmxWriteAction(DmxWriter *writer,
+                 const std::string &universe,
+                 const std::string &slot,
+                 const std::string &value)
+      : m_writer(writer),
+        m_universe(universe),
+        m_slot(slot),
+        m_value(value) {
+  }
+
+  void Execute(Context *context, uint8_t slot_value);
+
+ private:
+  DmxWriter *m_writer;
+  const VariableTemplate m_universe;
+  const VariableTemplate m_slot;
+  const VariableTemplate m_value;
+};
+
+
+/**
+ * @brief An action that sends an OSC message.
+ *
+ * Arguments that are integers are sent as int32, the rest as strings.
+ */
+class OSCSendAction: public Action {
+ public:
+  OSCSendAction(const ola::network::IPV4SocketAddress &destination,
+                const std::string &address,
+                const std::vector<std::string> &arguments);
+
+  void Execute(Context *context, uint8_t slot_value);
+
+  static bool BuildMessage(const std::string &address,
+                           const std::vector<std::string> &arguments,
+                           std::string *message);
+
+ private:
+  const ola::network::IPV4SocketAddress m_destination;
+  const VariableTemplate m_address;
+  std::vector<VariableTemplate> m_arguments;
+  ola::network::UDPSocket m_socket;
+  bool m_socket_ready;
+};
+#endif  // TOOLS_OLA_TRIGGER_BUILTINACTIONS_H_
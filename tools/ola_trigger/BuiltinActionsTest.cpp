@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BuiltinActionsTest.cpp
+ * Test fixture for the builtin actions
+ * Copyright (C) 2026 Open Lighting Project
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <ola/Callback.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tools/ola_trigger/BuiltinActions.h"
+#include "tools/ola_trigger/Context.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using std::map;
+using std::string;
+using std::vector;
+
+class BuiltinActionsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(BuiltinActionsTest);
+  CPPUNIT_TEST(testDmxWrite);
+  CPPUNIT_TEST(testOSCMessage);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testDmxWrite();
+  void testOSCMessage();
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void SendDmx(unsigned int universe, const DmxBuffer &data) {
+    m_sent[universe] = data;
+    m_send_count++;
+  }
+
+ private:
+  map<unsigned int, DmxBuffer> m_sent;
+  unsigned int m_send_count;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BuiltinActionsTest);
+
+
+/**
+ * Check the DmxWriteAction sets the slot.
+ */
+void BuiltinActionsTest::testDmxWrite() {
+  m_send_count = 0;
+  DmxWriter writer;
+  writer.SetSendCallback(
+      ola::NewCallback(this, &BuiltinActionsTest::SendDmx));
+
+  Context context;
+  context.SetSlotValue(100);
+  DmxWriteAction action(&writer, "2", "3", "${slot_value}");
+  action.Execute(&context, 100);
+
+  OLA_ASSERT_EQ(1u, m_send_count);
+  DmxBuffer expected;
+  expected.Blackout();
+  expected.SetChannel(2, 100);
+  OLA_ASSERT_DMX_EQUALS(expected, m_sent[2]);
+
+  // the same value isn't sent again
+  action.Execute(&context, 100);
+  OLA_ASSERT_EQ(1u, m_send_count);
+
+  context.SetSlotValue(0);
+  action.Execute(&context, 0);
+  OLA_ASSERT_EQ(2u, m_send_count);
+  expected.SetChannel(2, 0);
+  OLA_ASSERT_DMX_EQUALS(expected, m_sent[2]);
+
+  // invalid slots are ignored
+  DmxWriteAction bad_action(&writer, "2", "513", "1");
+  bad_action.Execute(&context, 0);
+  OLA_ASSERT_EQ(2u, m_send_count);
+}
+
+
+/**
+ * Check OSC messages are built correctly.
+ */
+void BuiltinActionsTest::testOSCMessage() {
+  vector<string> arguments;
+  string message;
+  OLA_ASSERT_FALSE(OSCSendAction::BuildMessage("foo", arguments, &message));
+
+  OLA_ASSERT(OSCSendAction::BuildMessage("/foo", arguments, &message));
+  const char expected1[] = "/foo\0\0\0\0,\0\0\0";
+  OLA_ASSERT_EQ(string(expected1, sizeof(expected1) - 1), message);
+
+  arguments.push_back("258");
+  arguments.push_back("bar");
+  OLA_ASSERT(OSCSendAction::BuildMessage("/abc", arguments, &message));
+  const char expected2[] =
+      "/abc\0\0\0\0,is\0\0\0\x01\x02" "bar\0";
+  OLA_ASSERT_EQ(string(expected2, sizeof(expected2) - 1), message);
+}
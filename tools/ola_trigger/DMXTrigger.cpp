@@ -26,6 +26,12 @@
 
 using ola::DmxBuffer;
 
+namespace {
+bool SlotOffsetLessThan(const Slot *slot1, const Slot *slot2) {
+  return slot1->SlotOffset() < slot2->SlotOffset();
+}
+}  // namespace
+
 
 /**
  * @brief Create a new trigger
@@ -34,7 +40,7 @@ DMXTrigger::DMXTrigger(Context *context,
                        const SlotVector &actions)
     : m_context(context),
       m_slots(actions) {
-  sort(m_slots.begin(), m_slots.end());
+  sort(m_slots.begin(), m_slots.end(), SlotOffsetLessThan);
 }
 
 
@@ -42,6 +48,14 @@ DMXTrigger::DMXTrigger(Context *context,
  * @brief Called when new DMX arrives.
  */
 void DMXTrigger::NewDMX(const DmxBuffer &data) {
+  if (data == m_last_frame) {
+    return;
+  }
+
+  const uint8_t *values = data.GetRaw();
+  const uint8_t *last_values = m_last_frame.GetRaw();
+  const unsigned int last_size = m_last_frame.Size();
+
   SlotVector::iterator iter = m_slots.begin();
   for (; iter != m_slots.end(); iter++) {
     uint16_t slot_number = (*iter)->SlotOffset();
@@ -49,6 +63,11 @@ void DMXTrigger::NewDMX(const DmxBuffer &data) {
       // the DMX frame was too small
       break;
     }
-    (*iter)->TakeAction(m_context, data.Get(slot_number));
+    if (slot_number < last_size &&
+        values[slot_number] == last_values[slot_number]) {
+      continue;
+    }
+    (*iter)->TakeAction(m_context, values[slot_number]);
   }
+  m_last_frame.Set(data);
 }
@@ -18,6 +18,10 @@ lib_LTLIBRARIES += tools/ola_trigger/libolatrigger.la
 tools_ola_trigger_libolatrigger_la_SOURCES = \
     tools/ola_trigger/Action.cpp \
     tools/ola_trigger/Action.h \
+    tools/ola_trigger/ActionExecutor.cpp \
+    tools/ola_trigger/ActionExecutor.h \
+    tools/ola_trigger/BuiltinActions.cpp \
+    tools/ola_trigger/BuiltinActions.h \
     tools/ola_trigger/Context.cpp \
     tools/ola_trigger/Context.h \
     tools/ola_trigger/DMXTrigger.cpp \
@@ -62,7 +66,9 @@ tools/ola_trigger/config.tab.cpp tools/ola_trigger/config.tab.h: tools/ola_trigg
 test_programs += tools/ola_trigger/ActionTester
 
 tools_ola_trigger_ActionTester_SOURCES = \
+    tools/ola_trigger/ActionExecutorTest.cpp \
     tools/ola_trigger/ActionTest.cpp \
+    tools/ola_trigger/BuiltinActionsTest.cpp \
     tools/ola_trigger/ContextTest.cpp \
     tools/ola_trigger/DMXTriggerTest.cpp \
     tools/ola_trigger/IntervalTest.cpp \
@@ -23,12 +23,15 @@
 #define __STDC_LIMIT_MACROS  // for UINT8_MAX & friends
 #include <ola/Constants.h>
 #include <ola/Logging.h>
+#include <ola/StringUtils.h>
 #include <ola/base/SysExits.h>
+#include <ola/network/SocketAddress.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string>
 #include <vector>
 #include "tools/ola_trigger/Action.h"
+#include "tools/ola_trigger/BuiltinActions.h"
 #include "tools/ola_trigger/ConfigCommon.h"
 #include "tools/ola_trigger/Context.h"
 #include "tools/ola_trigger/ParserActions.h"
@@ -39,6 +42,10 @@ using std::vector;
 
 extern int yylineno;  // defined and maintained in lex.yy.cpp
 
+namespace {
+const char BUILTIN_PREFIX[] = "builtin.";
+}  // namespace
+
 
 /**
  * @brief Lookup the Slot objects associated with a slot offset.
@@ -112,12 +119,48 @@ Action *CreateAssignmentAction(vector<string> *input) {
  * @returns a CommandAction object
  */
 Action *CreateCommandAction(const string &command, vector<string> *args) {
-  Action *action = new CommandAction(command, *args);
+  Action *action = NULL;
+  if (ola::StringBeginsWith(command, BUILTIN_PREFIX)) {
+    action = CreateBuiltinAction(command.substr(sizeof(BUILTIN_PREFIX) - 1),
+                                 *args);
+  } else {
+    action = new CommandAction(command, *args, global_executor);
+  }
   delete args;
   return action;
 }
 
 
+/**
+ * @brief Create a new builtin action.
+ * @param name the name of the builtin, without the prefix.
+ * @param args the arguments for the builtin.
+ * @returns a new Action object
+ */
+Action *CreateBuiltinAction(const string &name, const vector<string> &args) {
+  if (name == "dmx") {
+    if (args.size() != 3) {
+      OLA_FATAL << "Line " << yylineno
+                << ": builtin.dmx requires a universe, slot and value";
+      exit(ola::EXIT_DATAERR);
+    }
+    return new DmxWriteAction(global_dmx_writer, args[0], args[1], args[2]);
+  } else if (name == "osc") {
+    ola::network::IPV4SocketAddress destination;
+    if (args.size() < 2 ||
+        !ola::network::IPV4SocketAddress::FromString(args[0], &destination)) {
+      OLA_FATAL << "Line " << yylineno
+                << ": builtin.osc requires an ip:port and an address";
+      exit(ola::EXIT_DATAERR);
+    }
+    vector<string> osc_args(args.begin() + 2, args.end());
+    return new OSCSendAction(destination, args[1], osc_args);
+  }
+  OLA_FATAL << "Line " << yylineno << ": unknown builtin " << name;
+  exit(ola::EXIT_DATAERR);
+}
+
+
 /**
  * @brief Create a new ValueInterval object
  * @param lower the lower bound
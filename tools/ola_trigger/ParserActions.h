@@ -31,6 +31,8 @@ void SetDefaultValue(std::vector<std::string> *input);
 Action *CreateAssignmentAction(std::vector<std::string> *input);
 Action *CreateCommandAction(const std::string &command,
                             std::vector<std::string> *input);
+Action *CreateBuiltinAction(const std::string &name,
+                            const std::vector<std::string> &args);
 ValueInterval *CreateInterval(unsigned int lower, unsigned int upper);
 void SetSlotAction(unsigned int slot,
                    std::vector<class ValueInterval*> *slot_values,
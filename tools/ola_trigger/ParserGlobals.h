@@ -28,6 +28,12 @@
 // The context object
 extern class Context *global_context;
 
+// The executor for command actions, or NULL to run them directly
+extern class ActionExecutor *global_executor;
+
+// The DmxWriter used by the builtin.dmx actions
+extern class DmxWriter *global_dmx_writer;
+
 // A map of slot offsets to SlotAction objects
 typedef std::map<uint16_t, class Slot*> SlotActionMap;
 extern SlotActionMap global_slots;
@@ -19,62 +19,95 @@
 
 #include <ola/Logging.h>
 #include <string>
+#include <vector>
 #include "tools/ola_trigger/VariableInterpolator.h"
 
 using std::string;
+using std::vector;
 
 
-/**
- * @brief Interpolate variables within the Context
- * @param input the input string.
- * @param[out] output the output string.
- * @param context the Context to use.
- */
-bool InterpolateVariables(const string &input,
-                          string *output,
-                          const Context &context) {
-  static const char START_VARIABLE_STRING[] = "${";
-  static const char END_VARIABLE_STRING[] = "}";
-  static const char ESCAPE_CHARACTER = '\\';
+namespace {
+const char START_VARIABLE_STRING[] = "${";
+const char END_VARIABLE_STRING[] = "}";
+const char ESCAPE_CHARACTER = '\\';
+}  // namespace
 
-  *output = input;
 
-  size_t pos = output->size();
-  while (true) {
-    pos = output->rfind(START_VARIABLE_STRING, pos);
-    if (pos == string::npos) {
-      break;
+/**
+ * @brief Parse a string containing variables.
+ * @param input the string to parse.
+ */
+VariableTemplate::VariableTemplate(const string &input)
+    : m_valid(true) {
+  unsigned int depth = 0;
+  string literal;
+  for (size_t i = 0; i < input.size(); i++) {
+    if (input.compare(i, sizeof(START_VARIABLE_STRING) - 1,
+                      START_VARIABLE_STRING) == 0 &&
+        (i == 0 || input[i - 1] != ESCAPE_CHARACTER)) {
+      AddLiteral(&literal);
+      AddOperation(BEGIN_VARIABLE);
+      depth++;
+      i += sizeof(START_VARIABLE_STRING) - 2;
+    } else if (depth && input[i] == END_VARIABLE_STRING[0]) {
+      AddLiteral(&literal);
+      AddOperation(END_VARIABLE);
+      depth--;
+    } else {
+      literal.push_back(input[i]);
     }
+  }
+  AddLiteral(&literal);
 
-    // found a ${
-    if (pos != 0 && (*output)[pos - 1] == ESCAPE_CHARACTER) {
-      // not a real ${
-      pos = pos - 1;
-      continue;
-    }
+  if (depth) {
+    OLA_WARN << "Variable expansion failed for " << input << ", missing "
+             << END_VARIABLE_STRING;
+    m_valid = false;
+  }
+}
 
-    // search forward for the closing brace
-    size_t closing = output->find(END_VARIABLE_STRING, pos);
-    if (closing == string::npos) {
-      // not found
-      OLA_WARN << "Variable expansion failed for " << *output << ", missing "
-               << END_VARIABLE_STRING << " after character " << pos;
-      return false;
-    }
 
-    // lookup
-    size_t variable_name_pos = pos + sizeof(START_VARIABLE_STRING) - 1;
-    const string variable = output->substr(variable_name_pos,
-                                           closing - variable_name_pos);
-    string value;
-    if (!context.Lookup(variable, &value)) {
-      OLA_WARN << "Unknown variable " << variable;
-      return false;
+/**
+ * @brief Expand the variables using the values in a Context
+ * @param context the Context to use.
+ * @param[out] output the output string.
+ * @returns true if all the variables were found, false otherwise.
+ */
+bool VariableTemplate::Expand(const Context &context, string *output) const {
+  if (!m_valid) {
+    return false;
+  }
+
+  output->clear();
+  // The names of the variables being built, innermost last.
+  vector<string> names;
+  vector<Operation>::const_iterator iter = m_operations.begin();
+  for (; iter != m_operations.end(); ++iter) {
+    switch (iter->type) {
+      case LITERAL:
+        (names.empty() ? *output : names.back()).append(iter->literal);
+        break;
+      case BEGIN_VARIABLE:
+        names.push_back(string());
+        break;
+      case END_VARIABLE:
+        {
+          string value;
+          if (!context.Lookup(names.back(), &value)) {
+            OLA_WARN << "Unknown variable " << names.back();
+            return false;
+          }
+          names.pop_back();
+          (names.empty() ? *output : names.back()).append(value);
+        }
+        break;
     }
-    output->replace(pos, closing - pos + 1, value);
   }
 
   // finally unescape any braces
+  if (output->find(ESCAPE_CHARACTER) == string::npos) {
+    return true;
+  }
   for (unsigned i = 0; i < output->size(); i++) {
     char c = (*output)[i];
     if (c == START_VARIABLE_STRING[0] || c == END_VARIABLE_STRING[0]) {
@@ -85,3 +118,32 @@ bool InterpolateVariables(const string &input,
   }
   return true;
 }
+
+
+void VariableTemplate::AddLiteral(string *literal) {
+  if (literal->empty()) {
+    return;
+  }
+  Operation operation = {LITERAL, *literal};
+  m_operations.push_back(operation);
+  literal->clear();
+}
+
+
+void VariableTemplate::AddOperation(OperationType type) {
+  Operation operation = {type, ""};
+  m_operations.push_back(operation);
+}
+
+
+/**
+ * @brief Interpolate variables within the Context
+ * @param input the input string.
+ * @param[out] output the output string.
+ * @param context the Context to use.
+ */
+bool InterpolateVariables(const string &input,
+                          string *output,
+                          const Context &context) {
+  return VariableTemplate(input).Expand(context, output);
+}
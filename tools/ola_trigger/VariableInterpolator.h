@@ -22,8 +22,42 @@
 #define TOOLS_OLA_TRIGGER_VARIABLEINTERPOLATOR_H_
 
 #include <string>
+#include <vector>
 #include "tools/ola_trigger/Context.h"
 
+/**
+ * @brief A string containing variables, parsed once so it can be expanded
+ * many times.
+ *
+ * Variables are written as ${name}, and the name may itself contain variables,
+ * e.g. ${slot_${slot_offset}}. \${ and \} produce a literal ${ and }.
+ */
+class VariableTemplate {
+ public:
+  explicit VariableTemplate(const std::string &input);
+
+  bool Expand(const Context &context, std::string *output) const;
+
+ private:
+  typedef enum {
+    LITERAL,
+    BEGIN_VARIABLE,
+    END_VARIABLE,
+  } OperationType;
+
+  typedef struct {
+    OperationType type;
+    std::string literal;
+  } Operation;
+
+  std::vector<Operation> m_operations;
+  bool m_valid;
+
+  void AddLiteral(std::string *literal);
+  void AddOperation(OperationType type);
+};
+
+
 bool InterpolateVariables(const std::string &input,
                           std::string *output,
                           const Context &context);
@@ -35,6 +35,7 @@ class VariableInterpolatorTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testNestedInterpolation);
   CPPUNIT_TEST(testEscaping);
   CPPUNIT_TEST(testMissingVariables);
+  CPPUNIT_TEST(testTemplateReuse);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -43,6 +44,7 @@ class VariableInterpolatorTest: public CppUnit::TestFixture {
   void testNestedInterpolation();
   void testEscaping();
   void testMissingVariables();
+  void testTemplateReuse();
 
   void setUp() {
     ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
@@ -134,3 +136,29 @@ void VariableInterpolatorTest::testMissingVariables() {
   OLA_ASSERT_FALSE(InterpolateVariables("${one}", &result, context));
   OLA_ASSERT_FALSE(InterpolateVariables("${}", &result, context));
 }
+
+
+/**
+ * Check a template can be expanded many times with different values.
+ */
+void VariableInterpolatorTest::testTemplateReuse() {
+  Context context;
+  context.Update("one", "1");
+  context.Update("slot_1", "foo");
+  context.Update("slot_2", "bar");
+  string result;
+
+  VariableTemplate value_template("a ${slot_${one}} \\${one\\}");
+  OLA_ASSERT(value_template.Expand(context, &result));
+  OLA_ASSERT_EQ(string("a foo ${one}"), result);
+
+  context.Update("one", "2");
+  OLA_ASSERT(value_template.Expand(context, &result));
+  OLA_ASSERT_EQ(string("a bar ${one}"), result);
+
+  context.Update("one", "3");
+  OLA_ASSERT_FALSE(value_template.Expand(context, &result));
+
+  VariableTemplate unterminated("${slot_${one}");
+  OLA_ASSERT_FALSE(unterminated.Expand(context, &result));
+}
@@ -38,10 +38,13 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "tools/ola_trigger/Action.h"
+#include "tools/ola_trigger/ActionExecutor.h"
+#include "tools/ola_trigger/BuiltinActions.h"
 #include "tools/ola_trigger/Context.h"
 #include "tools/ola_trigger/DMXTrigger.h"
 #include "tools/ola_trigger/ParserGlobals.h"
@@ -59,12 +62,24 @@ DEFINE_s_uint16(offset, o, 0,
 DEFINE_s_uint32(universe, u, 0, "The universe to use, defaults to 0.");
 DEFINE_default_bool(validate, false,
                     "Validate the config file, rather than running it.");
+DEFINE_uint16(action_threads, 1,
+              "The number of threads used to start commands, 0 starts them "
+              "from the thread that processes the DMX data.");
+DEFINE_string(action_policy, "queue",
+              "How to handle a command that's triggered again before it "
+              "starts. 'queue' runs every command, 'latest' only runs the "
+              "latest one.");
+DEFINE_uint32(max_queued_actions, ActionExecutor::DEFAULT_MAX_QUEUED,
+              "The maximum number of commands waiting to start, further "
+              "commands are dropped.");
 
 // prototype of bison-generated parser function
 int yyparse();
 
 // globals modified by the config parser
 Context *global_context;
+ActionExecutor *global_executor = NULL;
+DmxWriter *global_dmx_writer = NULL;
 SlotActionMap global_slots;
 
 // The SelectServer to kill when we catch SIGINT
@@ -129,6 +144,16 @@ void NewDmx(unsigned int our_universe,
   }
 }
 
+/**
+ * @brief Send the data from a DmxWriter.
+ */
+void SendDmx(ola::OlaCallbackClient *client,
+             unsigned int universe,
+             const DmxBuffer &data) {
+  client->SendDmx(universe, data);
+}
+
+
 /**
  * @brief Build a vector of Slot from the global_slots map with the
  * offset applied.
@@ -182,6 +207,22 @@ int main(int argc, char *argv[]) {
 
   string config_file = argv[1];
 
+  ActionExecutor::Policy policy;
+  if (!ActionExecutor::StringToPolicy(FLAGS_action_policy.str(), &policy)) {
+    std::cerr << "Invalid action policy: " << FLAGS_action_policy << std::endl;
+    exit(ola::EXIT_USAGE);
+  }
+
+  std::auto_ptr<ActionExecutor> executor;
+  if (FLAGS_action_threads) {
+    executor.reset(new ActionExecutor(FLAGS_action_threads,
+                                      FLAGS_max_queued_actions,
+                                      policy));
+    global_executor = executor.get();
+  }
+  DmxWriter dmx_writer;
+  global_dmx_writer = &dmx_writer;
+
   // setup the default context
   global_context = new Context();
   OLA_INFO << "Loading config from " << config_file;
@@ -222,6 +263,11 @@ int main(int argc, char *argv[]) {
     exit(ola::EXIT_OSERR);
   }
 
+  if (executor.get() && !executor->Start()) {
+    exit(ola::EXIT_OSERR);
+  }
+  dmx_writer.SetSendCallback(ola::NewCallback(&SendDmx, wrapper.GetClient()));
+
   // create the vector of Slot
   SlotList slots;
   if (ApplyOffset(FLAGS_offset, &slots)) {
@@ -241,5 +287,12 @@ int main(int argc, char *argv[]) {
   }
 
   // cleanup
+  if (executor.get()) {
+    executor->Stop();
+    if (executor->DroppedJobs()) {
+      OLA_WARN << executor->DroppedJobs()
+               << " commands were dropped because too many were queued";
+    }
+  }
   STLDeleteElements(&slots);
 }